@@ -4,9 +4,11 @@
 #include <cmath>
 
 #include <core/MapSceneModel2.h>
+#include <util/MemoryTrim.h>
 
 using namespace TAK::Engine::Core;
 using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Util;
 
 JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_opengl_GLBatchGeometryRenderer_fillVertexArrays
   (JNIEnv *env, jclass clazz, jlong scenePtr, jint vertSize, jobject jtranslations, jobject jtexAtlasIndices, jint iconSize, jint textureSize, jobject jvertsTexCoords, jint count)
@@ -205,3 +207,19 @@ JNIEXPORT void JNICALL Java_com_atakmap_opengl_GLText_bufferChar
     texIndices[4] = n*4+2; // LR
     texIndices[5] = n*4+1; // UR
 }
+
+JNIEXPORT void JNICALL Java_com_atakmap_map_EngineLibrary_trimMemory
+  (JNIEnv *env, jclass clazz, jint androidLevel)
+{
+    // android.content.ComponentCallbacks2.TRIM_MEMORY_* constants
+    MemoryTrimLevel level;
+    if(androidLevel >= 20) // TRIM_MEMORY_UI_HIDDEN and background levels
+        level = TETL_Complete;
+    else if(androidLevel >= 15) // TRIM_MEMORY_RUNNING_CRITICAL
+        level = TETL_Critical;
+    else if(androidLevel >= 10) // TRIM_MEMORY_RUNNING_LOW
+        level = TETL_Low;
+    else // TRIM_MEMORY_RUNNING_MODERATE
+        level = TETL_Moderate;
+    ATAKMapEngineJNI_checkOrThrow(env, MemoryTrim_trim(level));
+}
@@ -134,3 +134,22 @@ extern "C" {
 }
 #endif
 #endif
+/* Header for class com_atakmap_map_EngineLibrary */
+
+#ifndef _Included_com_atakmap_map_EngineLibrary
+#define _Included_com_atakmap_map_EngineLibrary
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_atakmap_map_EngineLibrary
+ * Method:    trimMemory
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_map_EngineLibrary_trimMemory
+  (JNIEnv *, jclass, jint);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -46,6 +46,7 @@
 #include "util/Logging2.h"
 #include "util/Memory.h"
 
+#include "interop/JNIClassCache.h"
 #include "interop/Pointer.h"
 #include "interop/java/JNILocalRef.h"
 
@@ -103,6 +104,22 @@ namespace {
 
     JavaVM *vm;
 
+    /**
+     * Native threads are attached to the VM on first use of LocalJNIEnv and
+     * stay attached until they exit, rather than paying an attach/detach
+     * for every callback into Java.
+     */
+    struct ThreadAttachment
+    {
+        ThreadAttachment() NOTHROWS;
+        ~ThreadAttachment() NOTHROWS;
+
+        bool attached;
+        /** number of live LocalJNIEnv instances on the thread */
+        std::size_t depth;
+    };
+    thread_local ThreadAttachment threadAttachment;
+
 #ifdef _MSC_VER
     ULONG_PTR gdiplusToken;
 #endif
@@ -263,6 +280,9 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm_, void *reserved)
     LOAD_EXCEPTION_CLASS(ConcurrentModificationException, util);
     LOAD_EXCEPTION_CLASS(EOFException, io);
 #undef LOAD_EXCEPTION_CLASS
+
+    if(!JNIClassCache_init(*env))
+        return JNI_ERR;
 #ifdef __ANDROID__
     LoggerPtr androidLogger(&getAndroidLogger(), Memory_leaker_const<Logger2>);
     Logger_setLogger(std::move(androidLogger));
@@ -457,7 +477,7 @@ void JavaIntFieldAccess::setMethod(JavaIntFieldAccess *self, JNIEnv *env, jobjec
 
 LocalJNIEnv::LocalJNIEnv() NOTHROWS :
     env(NULL),
-    detach(false)
+    frame(false)
 {
     if(vm) {
         int code = vm->GetEnv((void **)&env, JNI_VERSION_1_6);
@@ -471,7 +491,7 @@ LocalJNIEnv::LocalJNIEnv() NOTHROWS :
 #else
             if(vm->AttachCurrentThread((void **)&env, &args) == 0) {
 #endif
-                detach = true;
+                threadAttachment.attached = true;
             } else {
                 env = NULL;
             }
@@ -479,11 +499,19 @@ LocalJNIEnv::LocalJNIEnv() NOTHROWS :
             env = NULL;
         }
     }
+
+    // local references on a thread attached here are never released by a
+    // return to Java; scope them to the outermost LocalJNIEnv instead
+    if(env && threadAttachment.attached && !threadAttachment.depth++)
+        frame = (env->PushLocalFrame(16) == 0);
 }
 LocalJNIEnv::~LocalJNIEnv() NOTHROWS
 {
-    if(detach && vm)
-        vm->DetachCurrentThread();
+    if(env && threadAttachment.attached) {
+        if(frame)
+            env->PopLocalFrame(NULL);
+        threadAttachment.depth--;
+    }
 }
 bool LocalJNIEnv::valid() NOTHROWS
 {
@@ -622,9 +650,7 @@ bool ATAKMapEngineJNI_equals(JNIEnv *env, jobject a, jobject b) NOTHROWS
     // both are non-null
     if(env->IsSameObject(a, b))
         return true;
-    jclass Object_class = ATAKMapEngineJNI_findClass(env, "java/lang/Object");
-    jmethodID Object_equals = env->GetMethodID(Object_class, "equals", "(Ljava/lang/Object;)Z");
-    return env->CallBooleanMethod(a, Object_equals, b);
+    return env->CallBooleanMethod(a, JNIClassCache.Object.equals, b);
 }
 
 void ATAKMapEngineJNI_registerShutdownHook(void(*hook)(JNIEnv &, void *) NOTHROWS, std::unique_ptr<void, void(*)(const void *)> &&opaque) NOTHROWS
@@ -667,24 +693,30 @@ TAKErr ProgressCallback_dispatchError(jobject jcallback, const char *value) NOTH
 void Thread_dumpStack() NOTHROWS
 {
     LocalJNIEnv env;
-    jclass Thread_class = ATAKMapEngineJNI_findClass(env, "java/lang/Thread");
-    jmethodID dumpStack = env->GetStaticMethodID(Thread_class, "dumpStack", "()V");
-    env->CallStaticVoidMethod(Thread_class, dumpStack);
+    env->CallStaticVoidMethod(JNIClassCache.Thread.id, JNIClassCache.Thread.dumpStack);
 }
 TAK::Engine::Port::String Object_toString(jobject obj) NOTHROWS
 {
     if(!obj)
         return nullptr;
     LocalJNIEnv env;
-    jclass Object_class = ATAKMapEngineJNI_findClass(env, "java/lang/Object");
-    jmethodID toString = env->GetMethodID(Object_class, "toString", "()Ljava/lang/String;");
-    Java::JNILocalRef mstr(*env, env->CallObjectMethod(obj, toString));
+    Java::JNILocalRef mstr(*env, env->CallObjectMethod(obj, JNIClassCache.Object.toString));
     TAK::Engine::Port::String cstr;
     JNIStringUTF_get(cstr, *env, mstr);
     return cstr;
 }
 
 namespace {
+ThreadAttachment::ThreadAttachment() NOTHROWS :
+    attached(false),
+    depth(0u)
+{}
+ThreadAttachment::~ThreadAttachment() NOTHROWS
+{
+    if(attached && vm)
+        vm->DetachCurrentThread();
+}
+
 #ifdef __ANDROID__
 int LogcatLogger::print(const LogLevel lvl, const char *fmt, va_list arg) NOTHROWS
 {
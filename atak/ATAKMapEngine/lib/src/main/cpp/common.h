@@ -114,7 +114,8 @@ public :
     operator JNIEnv*() const NOTHROWS;
 private :
     JNIEnv *env;
-    bool detach;
+    /** 'true' if this instance pushed a local reference frame */
+    bool frame;
 };
 
 /**
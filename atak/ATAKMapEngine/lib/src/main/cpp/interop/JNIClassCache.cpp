@@ -0,0 +1,43 @@
+#include "JNIClassCache.h"
+
+#include "../common.h"
+
+using namespace TAKEngineJNI::Interop;
+
+TAKEngineJNI::Interop::JNIClassCache_defn TAKEngineJNI::Interop::JNIClassCache;
+
+#define CACHE_CLASS(c, name) \
+    JNIClassCache.c.id = ATAKMapEngineJNI_findClass(&env, name); \
+    if(!JNIClassCache.c.id) \
+        return false;
+#define CACHE_METHOD(c, m, name, sig) \
+    JNIClassCache.c.m = env.GetMethodID(JNIClassCache.c.id, name, sig); \
+    if(!JNIClassCache.c.m) \
+        return false;
+#define CACHE_STATIC_METHOD(c, m, name, sig) \
+    JNIClassCache.c.m = env.GetStaticMethodID(JNIClassCache.c.id, name, sig); \
+    if(!JNIClassCache.c.m) \
+        return false;
+
+bool TAKEngineJNI::Interop::JNIClassCache_init(JNIEnv &env) NOTHROWS
+{
+    CACHE_CLASS(Object, "java/lang/Object");
+    CACHE_METHOD(Object, equals, "equals", "(Ljava/lang/Object;)Z");
+    CACHE_METHOD(Object, toString, "toString", "()Ljava/lang/String;");
+
+    CACHE_CLASS(String, "java/lang/String");
+
+    CACHE_CLASS(ByteArray, "[B");
+
+    CACHE_CLASS(File, "java/io/File");
+    CACHE_METHOD(File, ctor__String, "<init>", "(Ljava/lang/String;)V");
+
+    CACHE_CLASS(Thread, "java/lang/Thread");
+    CACHE_STATIC_METHOD(Thread, dumpStack, "dumpStack", "()V");
+
+    return true;
+}
+
+#undef CACHE_CLASS
+#undef CACHE_METHOD
+#undef CACHE_STATIC_METHOD
@@ -0,0 +1,50 @@
+#ifndef TAKENGINEJNI_INTEROP_JNICLASSCACHE_H_INCLUDED
+#define TAKENGINEJNI_INTEROP_JNICLASSCACHE_H_INCLUDED
+
+#include <port/Platform.h>
+
+#include <jni.h>
+
+namespace TAKEngineJNI {
+    namespace Interop {
+        /**
+         * Class, method and field IDs for JDK types that are used on hot
+         * paths throughout the bindings. Populated once from JNI_OnLoad;
+         * class references are global.
+         */
+        extern struct JNIClassCache_defn
+        {
+            struct
+            {
+                jclass id;
+                jmethodID equals;
+                jmethodID toString;
+            } Object;
+            struct
+            {
+                jclass id;
+            } String;
+            struct
+            {
+                jclass id;
+            } ByteArray;
+            struct
+            {
+                jclass id;
+                jmethodID ctor__String;
+            } File;
+            struct
+            {
+                jclass id;
+                jmethodID dumpStack;
+            } Thread;
+        } JNIClassCache;
+
+        /**
+         * Populates JNIClassCache. Returns 'false' if any class or member
+         * could not be resolved.
+         */
+        bool JNIClassCache_init(JNIEnv &env) NOTHROWS;
+    }
+}
+#endif
@@ -1,5 +1,6 @@
 #include "interop/core/ManagedRenderContext.h"
 
+#include <renderer/core/GLMapRenderGlobals.h>
 #include <util/Memory.h>
 
 #include "common.h"
@@ -53,6 +54,8 @@ ManagedRenderContext::ManagedRenderContext(JNIEnv &env_, jobject impl_, jobject
 }
 ManagedRenderContext::~ManagedRenderContext() NOTHROWS
 {
+    // shared render resources may not reference the context once destroyed
+    TAK::Engine::Renderer::Core::GLMapRenderGlobals_releaseContext(*this);
     if(impl) {
         LocalJNIEnv env;
         // if a child context, need to have parent invoke destroy
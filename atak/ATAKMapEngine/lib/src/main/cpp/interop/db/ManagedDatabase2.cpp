@@ -11,6 +11,7 @@
 #include "ManagedStatement.h"
 #include "ManagedQuery.h"
 
+#include "interop/JNIClassCache.h"
 #include "interop/JNIStringUTF.h"
 #include "interop/java/JNILocalRef.h"
 
@@ -66,8 +67,7 @@ namespace
         LocalJNIEnv env;
         JNILocalRef jArgs(*env, NULL);
         if(len) {
-            jclass jstringClass = ATAKMapEngineJNI_findClass(env, "java/lang/String");
-            jArgs = JNILocalRef(*env, env->NewObjectArray(len, jstringClass, NULL));
+            jArgs = JNILocalRef(*env, env->NewObjectArray(len, JNIClassCache.String.id, NULL));
             if (env->ExceptionCheck()) {
                 env->ExceptionClear();
                 return TAKErr::TE_Err;
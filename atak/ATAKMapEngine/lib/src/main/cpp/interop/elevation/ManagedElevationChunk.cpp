@@ -6,6 +6,8 @@
 
 #include <cmath>
 
+#include <thread/Lock.h>
+
 #include "common.h"
 #include "interop/JNIDoubleArray.h"
 #include "interop/JNIStringUTF.h"
@@ -19,6 +21,7 @@ using namespace TAKEngineJNI::Interop::Elevation;
 using namespace TAK::Engine::Elevation;
 using namespace TAK::Engine::Feature;
 using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 using namespace TAKEngineJNI::Interop;
@@ -57,7 +60,9 @@ namespace
 
 ManagedElevationChunk::ManagedElevationChunk(JNIEnv *env_, jobject impl_) NOTHROWS :
     impl(env_->NewGlobalRef(impl_)),
-    bounds(NULL, NULL)
+    bounds(NULL, NULL),
+    sampleBuffer(NULL),
+    sampleBufferLength(0u)
 {
     static bool clinit = ElevationChunk_class_init(env_);
 
@@ -68,6 +73,13 @@ ManagedElevationChunk::ManagedElevationChunk(JNIEnv *env_, jobject impl_) NOTHRO
     JNILocalRef mbounds(*env_, env_->CallObjectMethod(impl, ElevationChunk_class.getBounds));
     Feature::Interop_create(bounds, env_, mbounds);
 
+    // chunk metadata is immutable; capture up front rather than crossing
+    // into Java on every query
+    resolution = env_->CallDoubleMethod(impl, ElevationChunk_class.getResolution);
+    ce = env_->CallDoubleMethod(impl, ElevationChunk_class.getCE);
+    le = env_->CallDoubleMethod(impl, ElevationChunk_class.getLE);
+    authoritative = env_->CallBooleanMethod(impl, ElevationChunk_class.isAuthoritative);
+    flags = env_->CallIntMethod(impl, ElevationChunk_class.getFlags);
 }
 ManagedElevationChunk::~ManagedElevationChunk() NOTHROWS
 {
@@ -75,6 +87,8 @@ ManagedElevationChunk::~ManagedElevationChunk() NOTHROWS
         LocalJNIEnv env;
         env->CallVoidMethod(impl, ElevationChunk_class.dispose);
         env->DeleteGlobalRef(impl);
+        if(sampleBuffer)
+            env->DeleteGlobalRef(sampleBuffer);
         impl = NULL;
     }
 }
@@ -88,8 +102,7 @@ const char *ManagedElevationChunk::getType() const NOTHROWS
 }
 double ManagedElevationChunk::getResolution() const NOTHROWS
 {
-    LocalJNIEnv env;
-    return env->CallDoubleMethod(impl, ElevationChunk_class.getResolution);
+    return resolution;
 }
 const Polygon2 *ManagedElevationChunk::getBounds() const NOTHROWS
 {
@@ -157,22 +170,38 @@ TAKErr ManagedElevationChunk::sample(double *value, const std::size_t count, con
         return TE_InvalidArg;
     if(!value)
         return TE_InvalidArg;
+    if(!count)
+        return TE_Ok;
+
+    Lock lock(mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
     LocalJNIEnv env;
-    jdoubleArray jarr = env->NewDoubleArray(count*3);
+    if(sampleBufferLength < count*3u) {
+        JNILocalRef mbuffer(*env, env->NewDoubleArray(count*3u));
+        if(env->ExceptionCheck())
+            return TE_Err;
+        if(sampleBuffer)
+            env->DeleteGlobalRef(sampleBuffer);
+        sampleBuffer = (jdoubleArray)env->NewGlobalRef(mbuffer);
+        sampleBufferLength = count*3u;
+    }
+
     {
-        JNIDoubleArray jarr_w(*env, jarr, 0);
+        JNIDoubleArray jarr_w(*env, sampleBuffer, 0);
         for (std::size_t i = 0; i < count; i++) {
             jarr_w[i*3] = srcLng[i * srcLngStride];
             jarr_w[i*3+1] = srcLat[i * srcLatStride];
             jarr_w[i*3+2] = value[i*dstStride];
         }
     }
-    const bool done = env->CallBooleanMethod(impl, ElevationChunk_class.sample__1DII, jarr, 0, count);
+    const bool done = env->CallBooleanMethod(impl, ElevationChunk_class.sample__1DII, sampleBuffer, 0, count);
     if(env->ExceptionCheck())
         return TE_Err;
 
     {
-        JNIDoubleArray jarr_w(*env, jarr, JNI_ABORT);
+        JNIDoubleArray jarr_w(*env, sampleBuffer, JNI_ABORT);
         for (std::size_t i = 0; i < count; i++) {
             value[i*dstStride] = jarr_w[i*3+2];
         }
@@ -182,23 +211,19 @@ TAKErr ManagedElevationChunk::sample(double *value, const std::size_t count, con
 }
 double ManagedElevationChunk::getCE() const NOTHROWS
 {
-    LocalJNIEnv env;
-    return env->CallDoubleMethod(impl, ElevationChunk_class.getCE);
+    return ce;
 }
 double ManagedElevationChunk::getLE() const NOTHROWS
 {
-    LocalJNIEnv env;
-    return env->CallDoubleMethod(impl, ElevationChunk_class.getLE);
+    return le;
 }
 bool ManagedElevationChunk::isAuthoritative() const NOTHROWS
 {
-    LocalJNIEnv env;
-    return env->CallBooleanMethod(impl, ElevationChunk_class.isAuthoritative);
+    return authoritative;
 }
 unsigned int ManagedElevationChunk::getFlags() const NOTHROWS
 {
-    LocalJNIEnv env;
-    return env->CallIntMethod(impl, ElevationChunk_class.getFlags);
+    return flags;
 }
 
 namespace
@@ -8,6 +8,7 @@
 #include <jni.h>
 
 #include <elevation/ElevationChunk.h>
+#include <thread/Mutex.h>
 
 namespace TAKEngineJNI {
     namespace Interop {
@@ -35,6 +36,15 @@ namespace TAKEngineJNI {
                 TAK::Engine::Port::String uri;
                 TAK::Engine::Port::String type;
                 TAK::Engine::Feature::Geometry2Ptr_const bounds;
+                double resolution;
+                double ce;
+                double le;
+                bool authoritative;
+                unsigned int flags;
+                /** reusable transfer buffer for batch sampling, guarded by 'mutex' */
+                jdoubleArray sampleBuffer;
+                std::size_t sampleBufferLength;
+                TAK::Engine::Thread::Mutex mutex;
             };
         }
     }
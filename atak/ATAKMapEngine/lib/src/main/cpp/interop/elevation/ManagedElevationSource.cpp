@@ -97,12 +97,28 @@ namespace {
         virtual TAKErr getType(const char **value) NOTHROWS;
         virtual TAKErr getBounds(const Polygon2 **value) NOTHROWS;
         virtual TAKErr getFlags(unsigned int *value) NOTHROWS;
+    private :
+        enum
+        {
+            Row_Resolution = 0x01,
+            Row_Authoritative = 0x02,
+            Row_CE = 0x04,
+            Row_LE = 0x08,
+            Row_Flags = 0x10,
+        };
     public :
         jobject impl;
     private :
         TAK::Engine::Port::String uri;
         TAK::Engine::Port::String type;
         Geometry2Ptr_const bounds;
+        /** bitmask of the row scalars fetched for the current row */
+        unsigned int row;
+        double resolution;
+        bool authoritative;
+        double ce;
+        double le;
+        unsigned int flags;
     };
 
     bool ElevationSource_class_init(JNIEnv *env) NOTHROWS;
@@ -321,7 +337,8 @@ TAKErr ManagedElevationSource::removeOnContentChangedListener(TAK::Engine::Eleva
 namespace {
     ManagedElevationChunkCursor::ManagedElevationChunkCursor(JNIEnv *env_, jobject impl_) NOTHROWS :
         impl(env_->NewGlobalRef(impl_)),
-        bounds(NULL, NULL)
+        bounds(NULL, NULL),
+        row(0u)
     {}
     ManagedElevationChunkCursor::~ManagedElevationChunkCursor() NOTHROWS
     {
@@ -338,6 +355,7 @@ namespace {
         type = NULL;
         uri = NULL;
         bounds.reset();
+        row = 0u;
 
         LocalJNIEnv env;
         return DB::RowIterator_moveToNext(env, impl);
@@ -362,48 +380,64 @@ namespace {
     {
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        *value = env->CallDoubleMethod(impl, ElevationSource_Cursor_class.getResolution);
-        if(env->ExceptionCheck())
-            return TE_Err;
+        if(!(row&Row_Resolution)) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            resolution = env->CallDoubleMethod(impl, ElevationSource_Cursor_class.getResolution);
+            if(env->ExceptionCheck())
+                return TE_Err;
+            row |= Row_Resolution;
+        }
+        *value = resolution;
         return TE_Ok;
     }
     TAKErr ManagedElevationChunkCursor::isAuthoritative(bool *value) NOTHROWS
     {
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        *value = env->CallBooleanMethod(impl, ElevationSource_Cursor_class.isAuthoritative);
-        if(env->ExceptionCheck())
-            return TE_Err;
+        if(!(row&Row_Authoritative)) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            authoritative = env->CallBooleanMethod(impl, ElevationSource_Cursor_class.isAuthoritative);
+            if(env->ExceptionCheck())
+                return TE_Err;
+            row |= Row_Authoritative;
+        }
+        *value = authoritative;
         return TE_Ok;
     }
     TAKErr ManagedElevationChunkCursor::getCE(double *value) NOTHROWS
     {
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        *value = env->CallDoubleMethod(impl, ElevationSource_Cursor_class.getCE);
-        if(env->ExceptionCheck())
-            return TE_Err;
+        if(!(row&Row_CE)) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            ce = env->CallDoubleMethod(impl, ElevationSource_Cursor_class.getCE);
+            if(env->ExceptionCheck())
+                return TE_Err;
+            row |= Row_CE;
+        }
+        *value = ce;
         return TE_Ok;
     }
     TAKErr ManagedElevationChunkCursor::getLE(double *value) NOTHROWS
     {
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        *value = env->CallDoubleMethod(impl, ElevationSource_Cursor_class.getLE);
-        if(env->ExceptionCheck())
-            return TE_Err;
+        if(!(row&Row_LE)) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            le = env->CallDoubleMethod(impl, ElevationSource_Cursor_class.getLE);
+            if(env->ExceptionCheck())
+                return TE_Err;
+            row |= Row_LE;
+        }
+        *value = le;
         return TE_Ok;
     }
     TAKErr ManagedElevationChunkCursor::getUri(const char **value) NOTHROWS
@@ -411,12 +445,14 @@ namespace {
         TAKErr code(TE_Ok);
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        JNILocalRef muri(*env, env->CallObjectMethod(impl, ElevationSource_Cursor_class.getUri));
-        code = JNIStringUTF_get(uri, *env, (jstring)muri);
-        TE_CHECKRETURN_CODE(code);
+        if(!uri) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            JNILocalRef muri(*env, env->CallObjectMethod(impl, ElevationSource_Cursor_class.getUri));
+            code = JNIStringUTF_get(uri, *env, (jstring)muri);
+            TE_CHECKRETURN_CODE(code);
+        }
         *value = uri;
         return code;
     }
@@ -425,13 +461,15 @@ namespace {
         TAKErr code(TE_Ok);
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        JNILocalRef mtype(*env, env->CallObjectMethod(impl, ElevationSource_Cursor_class.getType));
-        code = JNIStringUTF_get(uri, *env, (jstring)mtype);
-        TE_CHECKRETURN_CODE(code);
-        *value = uri;
+        if(!type) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            JNILocalRef mtype(*env, env->CallObjectMethod(impl, ElevationSource_Cursor_class.getType));
+            code = JNIStringUTF_get(type, *env, (jstring)mtype);
+            TE_CHECKRETURN_CODE(code);
+        }
+        *value = type;
         return code;
     }
     TAKErr ManagedElevationChunkCursor::getBounds(const Polygon2 **value) NOTHROWS
@@ -460,12 +498,16 @@ namespace {
     {
         if(!value)
             return TE_InvalidArg;
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        *value = env->CallIntMethod(impl, ElevationSource_Cursor_class.getFlags);
-        if(env->ExceptionCheck())
-            return TE_Err;
+        if(!(row&Row_Flags)) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            flags = env->CallIntMethod(impl, ElevationSource_Cursor_class.getFlags);
+            if(env->ExceptionCheck())
+                return TE_Err;
+            row |= Row_Flags;
+        }
+        *value = flags;
         return TE_Ok;
     }
 
@@ -43,6 +43,19 @@ namespace
         jmethodID ctor__DDDDDD;
     } Envelope_class;
 
+    struct
+    {
+        jclass id;
+        jmethodID createGeometry;
+        jmethodID createStyle;
+    } FeatureInterop_class;
+
+    struct
+    {
+        jclass id;
+        jmethodID ctor__Pointer;
+    } AttributeSet_class;
+
     TAKErr geometry_clone(Geometry2Ptr &value, const Geometry2 &geom) NOTHROWS;
     TAKErr style_clone(TAK::Engine::Feature::StylePtr &value, const Style &style) NOTHROWS;
     TAKErr attributeset_clone(AttributeSetPtr &value, const AttributeSet &attrs) NOTHROWS;
@@ -106,26 +119,26 @@ INTEROP_FN_DEFNS(AttributeSet, attributeSetInterop)
 
 jobject TAKEngineJNI::Interop::Feature::Interop_create(JNIEnv *env, const Geometry2 &cgeom) NOTHROWS
 {
-    jclass Interop_class = ATAKMapEngineJNI_findClass(env, "com/atakmap/map/layer/feature/Interop");
-    jmethodID Interop_createGeometry = env->GetStaticMethodID(Interop_class, "createGeometry", "(Lcom/atakmap/interop/Pointer;Ljava/lang/Object;)Lcom/atakmap/map/layer/feature/geometry/Geometry;");
+    if(!checkInit(*env))
+        return NULL;
     Geometry2Ptr retval(NULL, NULL);
     if(Geometry_clone(retval, cgeom) != TE_Ok)
         return NULL;
-    return env->CallStaticObjectMethod(Interop_class, Interop_createGeometry, NewPointer(env, std::move(retval)), NULL);
+    return env->CallStaticObjectMethod(FeatureInterop_class.id, FeatureInterop_class.createGeometry, NewPointer(env, std::move(retval)), NULL);
 }
 jobject TAKEngineJNI::Interop::Feature::Interop_create(JNIEnv *env, const Style &cstyle) NOTHROWS
 {
-    jclass Interop_class = ATAKMapEngineJNI_findClass(env, "com/atakmap/map/layer/feature/Interop");
-    jmethodID Interop_createStyle = env->GetStaticMethodID(Interop_class, "createStyle", "(Lcom/atakmap/interop/Pointer;Ljava/lang/Object;)Lcom/atakmap/map/layer/feature/style/Style;");
+    if(!checkInit(*env))
+        return NULL;
     TAK::Engine::Feature::StylePtr retval(cstyle.clone(), Style::destructStyle);
-    return env->CallStaticObjectMethod(Interop_class, Interop_createStyle, NewPointer(env, std::move(retval)), NULL);
+    return env->CallStaticObjectMethod(FeatureInterop_class.id, FeatureInterop_class.createStyle, NewPointer(env, std::move(retval)), NULL);
 }
 jobject TAKEngineJNI::Interop::Feature::Interop_create(JNIEnv *env, const AttributeSet &cattr) NOTHROWS
 {
-    jclass AttributeSet_class = ATAKMapEngineJNI_findClass(env, "com/atakmap/map/layer/feature/AttributeSet");
-    jmethodID AttributeSet_ctor = env->GetMethodID(AttributeSet_class, "<init>", "(Lcom/atakmap/interop/Pointer;)V");
+    if(!checkInit(*env))
+        return NULL;
     AttributeSetPtr retval(new AttributeSet(cattr), Memory_deleter_const<AttributeSet>);
-    return env->NewObject(AttributeSet_class, AttributeSet_ctor, NewPointer(env, std::move(retval)));
+    return env->NewObject(AttributeSet_class.id, AttributeSet_class.ctor__Pointer, NewPointer(env, std::move(retval)));
 }
 
 TAKErr TAKEngineJNI::Interop::Feature::Interop_copy(Envelope2 *value, JNIEnv *env, jobject jenvelope) NOTHROWS
@@ -284,6 +297,13 @@ namespace
         Envelope_class.maxZ = env.GetFieldID(Envelope_class.id, "maxZ", "D");
         Envelope_class.ctor__DDDDDD = env.GetMethodID(Envelope_class.id, "<init>", "(DDDDDD)V");
 
+        FeatureInterop_class.id = ATAKMapEngineJNI_findClass(&env, "com/atakmap/map/layer/feature/Interop");
+        FeatureInterop_class.createGeometry = env.GetStaticMethodID(FeatureInterop_class.id, "createGeometry", "(Lcom/atakmap/interop/Pointer;Ljava/lang/Object;)Lcom/atakmap/map/layer/feature/geometry/Geometry;");
+        FeatureInterop_class.createStyle = env.GetStaticMethodID(FeatureInterop_class.id, "createStyle", "(Lcom/atakmap/interop/Pointer;Ljava/lang/Object;)Lcom/atakmap/map/layer/feature/style/Style;");
+
+        AttributeSet_class.id = ATAKMapEngineJNI_findClass(&env, "com/atakmap/map/layer/feature/AttributeSet");
+        AttributeSet_class.ctor__Pointer = env.GetMethodID(AttributeSet_class.id, "<init>", "(Lcom/atakmap/interop/Pointer;)V");
+
         return true;
     }
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "common.h"
 #include "jfeaturedefinition.h"
 #include "interop/JNIByteArray.h"
+#include "interop/JNIClassCache.h"
 #include "interop/JNIStringUTF.h"
 #include "interop/java/JNILocalRef.h"
 #include "interop/feature/Interop.h"
@@ -103,7 +104,11 @@ namespace
         TAKErr get(const Feature2 **values) NOTHROWS;
     private :
         jobject impl;
+        jint geomCoding;
+        jint styleCoding;
         TAK::Engine::Port::String name;
+        const atakmap::util::AttributeSet *attributes;
+        bool attributesValid;
         FeaturePtr_const feature;
         std::unique_ptr<RawData, void(*)(const RawData *)> rawGeom;
         std::unique_ptr<RawData, void(*)(const RawData *)> rawStyle;
@@ -140,14 +145,8 @@ ManagedFeatureDataSource2::~ManagedFeatureDataSource2() NOTHROWS
 TAKErr ManagedFeatureDataSource2::parse(ContentPtr &content, const char *file) NOTHROWS
 {
     LocalJNIEnv env;
-    jclass File_class = ATAKMapEngineJNI_findClass(env, "java/io/File");
-    if(!File_class)
-        return TE_Err;
-    jmethodID File_ctor = env->GetMethodID(File_class, "<init>", "(Ljava/lang/String;)V");
-    if(!File_ctor)
-        return TE_Err;
     jstring jpath = env->NewStringUTF(file);
-    jobject jfile = env->NewObject(File_class, File_ctor, jpath);
+    jobject jfile = env->NewObject(JNIClassCache.File.id, JNIClassCache.File.ctor__String, jpath);
     if(!jfile)
         return TE_Err;
     jobject result = env->CallObjectMethod(impl, FeatureDataSource2_class.parse, jfile);
@@ -311,6 +310,10 @@ namespace
 
     ManagedFeatureDefinition::ManagedFeatureDefinition(JNIEnv *env_, jobject impl_) NOTHROWS :
         impl(env_->NewGlobalRef(impl_)),
+        geomCoding(env_->GetIntField(impl_, FeatureDefinition_class.geomCoding)),
+        styleCoding(env_->GetIntField(impl_, FeatureDefinition_class.styleCoding)),
+        attributes(NULL),
+        attributesValid(false),
         feature(NULL, NULL),
         rawGeom(NULL, NULL),
         rawStyle(NULL, NULL),
@@ -335,7 +338,6 @@ namespace
             LocalJNIEnv env;
             if(env->ExceptionCheck())
                 return TE_Err;
-            jint geomCoding = env->GetIntField(impl, FeatureDefinition_class.geomCoding);
             if(geomCoding == com_atakmap_map_layer_feature_FeatureDefinition_GEOM_WKT) {
                 Java::JNILocalRef result(*env, (jstring)env->GetObjectField(impl, FeatureDefinition_class.rawGeom));
                 if(env->ExceptionCheck())
@@ -405,8 +407,6 @@ namespace
     }
     FeatureDefinition2::GeometryEncoding ManagedFeatureDefinition::getGeomCoding() NOTHROWS
     {
-        LocalJNIEnv env;
-        jint geomCoding = env->GetIntField(impl, FeatureDefinition_class.geomCoding);
         if(geomCoding == com_atakmap_map_layer_feature_FeatureDefinition_GEOM_WKT) {
             return FeatureDefinition2::GeomWkt;
         } else if(geomCoding == com_atakmap_map_layer_feature_FeatureDefinition_GEOM_WKB) {
@@ -446,11 +446,9 @@ namespace
     }
     FeatureDefinition2::StyleEncoding ManagedFeatureDefinition::getStyleCoding() NOTHROWS
     {
-        LocalJNIEnv env;
-        jint geomCoding = env->GetIntField(impl, FeatureDefinition_class.styleCoding);
-        if(geomCoding == com_atakmap_map_layer_feature_FeatureDefinition_STYLE_OGR) {
+        if(styleCoding == com_atakmap_map_layer_feature_FeatureDefinition_STYLE_OGR) {
             return FeatureDefinition2::StyleOgr;
-        } else if(geomCoding == com_atakmap_map_layer_feature_FeatureDefinition_STYLE_ATAK_STYLE) {
+        } else if(styleCoding == com_atakmap_map_layer_feature_FeatureDefinition_STYLE_ATAK_STYLE) {
             return FeatureDefinition2::StyleStyle;
         } else {
             return FeatureDefinition2::StyleStyle;
@@ -463,7 +461,6 @@ namespace
             LocalJNIEnv env;
             if(env->ExceptionCheck())
                 return TE_Err;
-            jint styleCoding = env->GetIntField(impl, FeatureDefinition_class.styleCoding);
             if(styleCoding == com_atakmap_map_layer_feature_FeatureDefinition_STYLE_OGR) {
                 Java::JNILocalRef result(*env,  (jstring)env->GetObjectField(impl, FeatureDefinition_class.rawStyle));
                 if(env->ExceptionCheck())
@@ -499,17 +496,20 @@ namespace
     }
     TAKErr ManagedFeatureDefinition::getAttributes(const atakmap::util::AttributeSet **value) NOTHROWS
     {
-        LocalJNIEnv env;
-        if(env->ExceptionCheck())
-            return TE_Err;
-        Java::JNILocalRef attributes(*env, env->GetObjectField(impl, FeatureDefinition_class.attributes));
-        if(!attributes) {
-            *value = NULL;
-            return TE_Ok;
+        if(!attributesValid) {
+            LocalJNIEnv env;
+            if(env->ExceptionCheck())
+                return TE_Err;
+            Java::JNILocalRef mattributes(*env, env->GetObjectField(impl, FeatureDefinition_class.attributes));
+            if(mattributes) {
+                TAKErr code = Interop_get(&attributes, env, mattributes);
+                TE_CHECKRETURN_CODE(code);
+                managedRefs.push_back(env->NewGlobalRef(mattributes));
+            }
+            attributesValid = true;
         }
-
-        managedRefs.push_back(env->NewGlobalRef(attributes));
-        return Interop_get(value, env, attributes);
+        *value = attributes;
+        return TE_Ok;
     }
     TAKErr ManagedFeatureDefinition::get(const Feature2 **value) NOTHROWS
     {
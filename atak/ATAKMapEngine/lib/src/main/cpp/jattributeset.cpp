@@ -9,6 +9,7 @@
 #include <util/Memory.h>
 
 #include "common.h"
+#include "interop/JNIClassCache.h"
 #include "interop/Pointer.h"
 #include "interop/JNIByteArray.h"
 #include "interop/JNIDoubleArray.h"
@@ -257,7 +258,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_atakmap_map_layer_feature_AttributeSet_g
             return NULL;
 
         const std::size_t count = blob.second-blob.first;
-        jobjectArray retval = env->NewObjectArray(count, ATAKMapEngineJNI_findClass(env, "java/lang/String"), NULL);
+        jobjectArray retval = env->NewObjectArray(count, JNIClassCache.String.id, NULL);
         for(std::size_t i = 0u; i < count; i++) {
             env->SetObjectArrayElement(retval, i, env->NewStringUTF(blob.first[i]));
         }
@@ -286,7 +287,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_atakmap_map_layer_feature_AttributeSet_g
             return NULL;
 
         const std::size_t count = blobArray.second-blobArray.first;
-        jobjectArray retval = env->NewObjectArray(count, ATAKMapEngineJNI_findClass(env, "[B"), NULL);
+        jobjectArray retval = env->NewObjectArray(count, JNIClassCache.ByteArray.id, NULL);
         for(std::size_t i = 0u; i < count; i++) {
             AttributeSet::Blob blob = blobArray.first[i];
             if(!blob.first)
@@ -651,7 +652,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_atakmap_map_layer_feature_AttributeSet_g
 
     try {
         std::vector<const char *> cnames = attr->getAttributeNames();
-        jobjectArray retval = env->NewObjectArray(cnames.size(), ATAKMapEngineJNI_findClass(env, "java/lang/String"), NULL);
+        jobjectArray retval = env->NewObjectArray(cnames.size(), JNIClassCache.String.id, NULL);
         for(std::size_t i = 0u; i < cnames.size(); i++) {
             env->SetObjectArrayElement(retval, i, env->NewStringUTF(cnames[i]));
         }
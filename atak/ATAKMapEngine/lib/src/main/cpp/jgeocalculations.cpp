@@ -1,12 +1,17 @@
 #include "jgeocalculations.h"
 
+#include <vector>
+
 #include <core/GeoPoint2.h>
 
 #include "common.h"
+#include "interop/JNIDoubleArray.h"
 
 using namespace TAK::Engine::Core;
 using namespace TAK::Engine::Util;
 
+using namespace TAKEngineJNI::Interop;
+
 namespace
 {
     struct {
@@ -18,6 +23,12 @@ namespace
     bool init(JNIEnv &env) NOTHROWS;
     jobject NewGeoPoint(JNIEnv &env, double lat, double lng) NOTHROWS;
     jobject NewGeoPoint(JNIEnv &env, double lat, double lng, double alt) NOTHROWS;
+    /**
+     * Unpacks `count` interleaved latitude, longitude, altitude triples.
+     * Returns `false` and raises an exception if the array is too short.
+     */
+    bool unpackLLA(JNIEnv &env, std::vector<GeoPoint2> &value, jdoubleArray jlla, const std::size_t count) NOTHROWS;
+    bool checkResult(JNIEnv &env, jdoubleArray jresult, const std::size_t count) NOTHROWS;
 }
 
 #define TEJNI_GC_HAS_FLAG(b, f) \
@@ -75,6 +86,72 @@ JNIEXPORT jobject JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_p
     GeoPoint2 result = GeoPoint2_pointAtDistance(GeoPoint2(lat, lng), azimuth, distance, false);
     return NewGeoPoint(*env, result.latitude, result.longitude);
 }
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_distanceTo
+  (JNIEnv *env, jclass clazz, jdouble lat, jdouble lng, jdouble alt, jdoubleArray jlla, jdoubleArray jresult, jint count, jint flags)
+{
+    if(count < 0) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return;
+    }
+    std::vector<GeoPoint2> b;
+    if(!unpackLLA(*env, b, jlla, count) || !checkResult(*env, jresult, count))
+        return;
+    const GeoPoint2 a(lat, lng, alt, AltitudeReference::HAE);
+    const bool quick = TEJNI_GC_HAS_FLAG(flags, CALC_QUICK);
+    JNIDoubleArray result(*env, jresult, 0);
+    if(TEJNI_GC_HAS_FLAG(flags, CALC_SLANT))
+        ATAKMapEngineJNI_checkOrThrow(env, GeoPoint2_slantDistance(result.get<double>(), a, b.data(), b.size()));
+    else
+        ATAKMapEngineJNI_checkOrThrow(env, GeoPoint2_distance(result.get<double>(), a, b.data(), b.size(), quick));
+}
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_distances
+  (JNIEnv *env, jclass clazz, jdoubleArray jlla1, jdoubleArray jlla2, jdoubleArray jresult, jint count, jint flags)
+{
+    if(count < 0) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return;
+    }
+    std::vector<GeoPoint2> a;
+    std::vector<GeoPoint2> b;
+    if(!unpackLLA(*env, a, jlla1, count) || !unpackLLA(*env, b, jlla2, count) || !checkResult(*env, jresult, count))
+        return;
+    const bool quick = TEJNI_GC_HAS_FLAG(flags, CALC_QUICK);
+    JNIDoubleArray result(*env, jresult, 0);
+    if(TEJNI_GC_HAS_FLAG(flags, CALC_SLANT))
+        ATAKMapEngineJNI_checkOrThrow(env, GeoPoint2_slantDistance(result.get<double>(), a.data(), b.data(), b.size()));
+    else
+        ATAKMapEngineJNI_checkOrThrow(env, GeoPoint2_distance(result.get<double>(), a.data(), b.data(), b.size(), quick));
+}
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_bearingTo
+  (JNIEnv *env, jclass clazz, jdouble lat, jdouble lng, jdoubleArray jlla, jdoubleArray jresult, jint count, jint flags)
+{
+    if(count < 0) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return;
+    }
+    std::vector<GeoPoint2> b;
+    if(!unpackLLA(*env, b, jlla, count) || !checkResult(*env, jresult, count))
+        return;
+    const GeoPoint2 a(lat, lng);
+    const bool quick = TEJNI_GC_HAS_FLAG(flags, CALC_QUICK);
+    JNIDoubleArray result(*env, jresult, 0);
+    ATAKMapEngineJNI_checkOrThrow(env, GeoPoint2_bearing(result.get<double>(), a, b.data(), b.size(), quick));
+}
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_bearings
+  (JNIEnv *env, jclass clazz, jdoubleArray jlla1, jdoubleArray jlla2, jdoubleArray jresult, jint count, jint flags)
+{
+    if(count < 0) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return;
+    }
+    std::vector<GeoPoint2> a;
+    std::vector<GeoPoint2> b;
+    if(!unpackLLA(*env, a, jlla1, count) || !unpackLLA(*env, b, jlla2, count) || !checkResult(*env, jresult, count))
+        return;
+    const bool quick = TEJNI_GC_HAS_FLAG(flags, CALC_QUICK);
+    JNIDoubleArray result(*env, jresult, 0);
+    ATAKMapEngineJNI_checkOrThrow(env, GeoPoint2_bearing(result.get<double>(), a.data(), b.data(), b.size(), quick));
+}
 
 namespace
 {
@@ -111,4 +188,28 @@ namespace
 
         return env.NewObject(GeoPoint_class.id, GeoPoint_class.ctor__DDD, lat, lng, alt);
     }
+    bool unpackLLA(JNIEnv &env, std::vector<GeoPoint2> &value, jdoubleArray jlla, const std::size_t count) NOTHROWS
+    {
+        if(!jlla) {
+            ATAKMapEngineJNI_checkOrThrow(&env, TE_InvalidArg);
+            return false;
+        }
+        JNIDoubleArray lla(env, jlla, JNI_ABORT);
+        if(lla.length() < (count*3u)) {
+            ATAKMapEngineJNI_checkOrThrow(&env, TE_InvalidArg);
+            return false;
+        }
+        value.reserve(count);
+        for(std::size_t i = 0u; i < count; i++)
+            value.push_back(GeoPoint2(lla[i*3u], lla[i*3u+1u], lla[i*3u+2u], AltitudeReference::HAE));
+        return true;
+    }
+    bool checkResult(JNIEnv &env, jdoubleArray jresult, const std::size_t count) NOTHROWS
+    {
+        if(!jresult || (std::size_t)env.GetArrayLength(jresult) < count) {
+            ATAKMapEngineJNI_checkOrThrow(&env, TE_InvalidArg);
+            return false;
+        }
+        return true;
+    }
 }
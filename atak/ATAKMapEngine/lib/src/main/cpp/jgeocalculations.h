@@ -55,6 +55,38 @@ JNIEXPORT jobject JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_m
 JNIEXPORT jobject JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_pointAtDistance
   (JNIEnv *, jclass, jdouble, jdouble, jdouble, jdouble, jint);
 
+/*
+ * Class:     com_atakmap_coremap_maps_coords_GeoCalculations
+ * Method:    distanceTo
+ * Signature: (DDD[D[DII)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_distanceTo
+  (JNIEnv *, jclass, jdouble, jdouble, jdouble, jdoubleArray, jdoubleArray, jint, jint);
+
+/*
+ * Class:     com_atakmap_coremap_maps_coords_GeoCalculations
+ * Method:    distances
+ * Signature: ([D[D[DII)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_distances
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray, jint, jint);
+
+/*
+ * Class:     com_atakmap_coremap_maps_coords_GeoCalculations
+ * Method:    bearingTo
+ * Signature: (DD[D[DII)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_bearingTo
+  (JNIEnv *, jclass, jdouble, jdouble, jdoubleArray, jdoubleArray, jint, jint);
+
+/*
+ * Class:     com_atakmap_coremap_maps_coords_GeoCalculations
+ * Method:    bearings
+ * Signature: ([D[D[DII)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_coremap_maps_coords_GeoCalculations_bearings
+  (JNIEnv *, jclass, jdoubleArray, jdoubleArray, jdoubleArray, jint, jint);
+
 #ifdef __cplusplus
 }
 #endif
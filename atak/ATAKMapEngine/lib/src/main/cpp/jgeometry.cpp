@@ -24,6 +24,16 @@ using namespace TAK::Engine::Util;
 
 using namespace TAKEngineJNI::Interop;
 
+namespace
+{
+    /**
+     * Returns the memory backing the direct ByteBuffer 'jbuf' as doubles,
+     * or NULL if the buffer is not direct or cannot hold 'count' values.
+     * The buffer must be in native byte order.
+     */
+    double *getDirectDoubles(JNIEnv &env, jobject jbuf, const std::size_t count) NOTHROWS;
+}
+
 /*****************************************************************************/
 // Geometry
 
@@ -357,6 +367,73 @@ JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Line
   if(ATAKMapEngineJNI_checkOrThrow(env, code))
       return;
 }
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1addPointsDirect
+  (JNIEnv *env, jclass clazz, jobject jpointer, jobject jbuf, jint count, jint stride)
+{
+  Geometry2 *geom = Pointer_get<Geometry2>(env, jpointer);
+  if(!geom || count < 0 || stride < 0) {
+      ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+      return;
+  }
+
+  // read straight out of the buffer memory, no JNI array copy
+  const double *pts = getDirectDoubles(*env, jbuf, (std::size_t)count*(std::size_t)stride);
+  if(!pts) {
+      ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+      return;
+  }
+
+  TAKErr code(TE_Ok);
+  LineString2 &linestring = static_cast<LineString2 &>(*geom);
+  code = linestring.addPoints(pts, count, stride);
+  if(ATAKMapEngineJNI_checkOrThrow(env, code))
+      return;
+}
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1getPoints
+  (JNIEnv *env, jclass clazz, jobject jpointer, jdoubleArray jarr, jint off, jint count)
+{
+  Geometry2 *geom = Pointer_get<Geometry2>(env, jpointer);
+  if(!geom || !jarr || off < 0 || count < 0) {
+      ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+      return;
+  }
+
+  LineString2 &linestring = static_cast<LineString2 &>(*geom);
+  if((std::size_t)env->GetArrayLength(jarr) < (std::size_t)count*linestring.getDimension()) {
+      ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+      return;
+  }
+
+  JNIDoubleArray arr(*env, jarr, 0);
+  jdouble *pts = arr;
+
+  TAKErr code(TE_Ok);
+  code = linestring.getPoints(reinterpret_cast<double *>(pts), off, count);
+  if(ATAKMapEngineJNI_checkOrThrow(env, code))
+      return;
+}
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1getPointsDirect
+  (JNIEnv *env, jclass clazz, jobject jpointer, jobject jbuf, jint off, jint count)
+{
+  Geometry2 *geom = Pointer_get<Geometry2>(env, jpointer);
+  if(!geom || off < 0 || count < 0) {
+      ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+      return;
+  }
+
+  LineString2 &linestring = static_cast<LineString2 &>(*geom);
+  // fill the buffer memory in place
+  double *pts = getDirectDoubles(*env, jbuf, (std::size_t)count*linestring.getDimension());
+  if(!pts) {
+      ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+      return;
+  }
+
+  TAKErr code(TE_Ok);
+  code = linestring.getPoints(pts, off, count);
+  if(ATAKMapEngineJNI_checkOrThrow(env, code))
+      return;
+}
 JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1setX
   (JNIEnv *env, jclass clazz, jobject jpointer, jint idx, jdouble x)
 {
@@ -748,3 +825,18 @@ JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Geom
   collection.clear();
 }
 
+namespace
+{
+    double *getDirectDoubles(JNIEnv &env, jobject jbuf, const std::size_t count) NOTHROWS
+    {
+        if(!jbuf)
+            return NULL;
+        void *addr = env.GetDirectBufferAddress(jbuf);
+        if(!addr)
+            return NULL;
+        const jlong capacity = env.GetDirectBufferCapacity(jbuf);
+        if(capacity < 0 || (std::size_t)capacity < count*sizeof(double))
+            return NULL;
+        return static_cast<double *>(addr);
+    }
+}
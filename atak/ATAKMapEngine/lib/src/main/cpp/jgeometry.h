@@ -223,6 +223,30 @@ JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Line
 JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1addPoints
   (JNIEnv *, jclass, jobject, jdoubleArray, jint, jint, jint);
 
+/*
+ * Class:     com_atakmap_map_layer_feature_geometry_Geometry
+ * Method:    Linestring_addPointsDirect
+ * Signature: (Lcom/atakmap/interop/Pointer;Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1addPointsDirect
+  (JNIEnv *, jclass, jobject, jobject, jint, jint);
+
+/*
+ * Class:     com_atakmap_map_layer_feature_geometry_Geometry
+ * Method:    Linestring_getPoints
+ * Signature: (Lcom/atakmap/interop/Pointer;[DII)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1getPoints
+  (JNIEnv *, jclass, jobject, jdoubleArray, jint, jint);
+
+/*
+ * Class:     com_atakmap_map_layer_feature_geometry_Geometry
+ * Method:    Linestring_getPointsDirect
+ * Signature: (Lcom/atakmap/interop/Pointer;Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_geometry_Geometry_Linestring_1getPointsDirect
+  (JNIEnv *, jclass, jobject, jobject, jint, jint);
+
 /*
  * Class:     com_atakmap_map_layer_feature_geometry_Geometry
  * Method:    Linestring_setX
@@ -462,6 +462,36 @@ JNIEXPORT jobject JNICALL Java_com_atakmap_map_layer_feature_geometry_GeometryFa
 
     return Feature::Interop_create(env, *cgeom2Value);
 }
+JNIEXPORT jobject JNICALL Java_com_atakmap_map_layer_feature_geometry_GeometryFactory_extrudePerVertexDirect
+        (JNIEnv *env, jclass clazz, jlong ptr, jobject extrude, jint count, jint hint)
+{
+    TAKErr code(TE_Ok);
+    Geometry2Ptr cgeom2Value(nullptr, nullptr);
+    Geometry2 *cgeomSrc = JLONG_TO_INTPTR(Geometry2, ptr);
+
+    if(!cgeomSrc || !extrude || count < 0) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return NULL;
+    }
+
+    // extrusion values are read in place from the direct buffer (native
+    // byte order) rather than copied out of a Java array
+    const double *cextrude = static_cast<const double *>(env->GetDirectBufferAddress(extrude));
+    const jlong capacity = env->GetDirectBufferCapacity(extrude);
+    if(!cextrude || capacity < 0 || (std::size_t)capacity < (std::size_t)count*sizeof(double)) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return NULL;
+    }
+
+    code = GeometryFactory_extrude(cgeom2Value, *cgeomSrc, cextrude, count, hint);
+    if(code != TE_Ok)
+        return NULL;
+
+    if(!cgeom2Value.get())
+        return NULL;
+
+    return Feature::Interop_create(env, *cgeom2Value);
+}
 
 namespace
 {
@@ -119,6 +119,14 @@ JNIEXPORT jobject JNICALL Java_com_atakmap_map_layer_feature_geometry_GeometryFa
 JNIEXPORT jobject JNICALL Java_com_atakmap_map_layer_feature_geometry_GeometryFactory_extrudePerVertex
   (JNIEnv *, jclass, jlong, jdoubleArray, jint);
 
+/*
+ * Class:     com_atakmap_map_layer_feature_geometry_GeometryFactory
+ * Method:    extrudePerVertexDirect
+ * Signature: (JLjava/nio/ByteBuffer;II)Lcom/atakmap/map/layer/feature/geometry/Geometry;
+ */
+JNIEXPORT jobject JNICALL Java_com_atakmap_map_layer_feature_geometry_GeometryFactory_extrudePerVertexDirect
+  (JNIEnv *, jclass, jlong, jobject, jint, jint);
+
 /*
  * Class:     com_atakmap_map_layer_feature_geometry_GeometryFactory
  * Method:    createRectangle
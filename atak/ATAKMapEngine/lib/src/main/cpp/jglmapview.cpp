@@ -14,6 +14,7 @@
 
 #include "common.h"
 #include "interop/JNIFloatArray.h"
+#include "interop/JNILongArray.h"
 #include "interop/JNIStringUTF.h"
 #include "interop/Pointer.h"
 #include "interop/core/Interop.h"
@@ -36,6 +37,9 @@ namespace
 {
     typedef std::unique_ptr<GLGlobeBase, void(*)(const GLGlobeBase *)> GLGlobeBasePtr;
 
+    /** number of values reported per frame by `getFrameStatistics` */
+    const std::size_t FrameStatisticsStride = 11u;
+
     struct
     {
         jclass id;
@@ -1318,6 +1322,77 @@ JNIEXPORT void JNICALL Java_com_atakmap_map_opengl_GLMapView_addRenderDiagnostic
         // no-op
     }
 }
+JNIEXPORT void JNICALL Java_com_atakmap_map_opengl_GLMapView_setFrameStatisticsEnabled
+  (JNIEnv *env, jclass clazz, jlong ptr, jboolean enabled, jint type)
+{
+    GLGlobeBase *cglobe = JLONG_TO_INTPTR(GLGlobeBase, ptr);
+    if(!cglobe) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return;
+    }
+    if(type == com_atakmap_map_opengl_GLMapView_IMPL_V2) {
+        GLGlobe *cview = static_cast<GLGlobe *>(cglobe);
+        cview->setFrameStatisticsEnabled(enabled);
+    } else {
+        // no-op
+    }
+}
+JNIEXPORT jboolean JNICALL Java_com_atakmap_map_opengl_GLMapView_isFrameStatisticsEnabled
+  (JNIEnv *env, jclass clazz, jlong ptr, jint type)
+{
+    GLGlobeBase *cglobe = JLONG_TO_INTPTR(GLGlobeBase, ptr);
+    if(!cglobe) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return false;
+    }
+    if(type == com_atakmap_map_opengl_GLMapView_IMPL_V2) {
+        GLGlobe *cview = static_cast<GLGlobe *>(cglobe);
+        return cview->isFrameStatisticsEnabled();
+    } else {
+        // no-op
+        return false;
+    }
+}
+JNIEXPORT jlongArray JNICALL Java_com_atakmap_map_opengl_GLMapView_getFrameStatistics
+  (JNIEnv *env, jclass clazz, jlong ptr, jlong since, jint type)
+{
+    TAKErr code(TE_Ok);
+    GLGlobeBase *cglobe = JLONG_TO_INTPTR(GLGlobeBase, ptr);
+    if(!cglobe) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return NULL;
+    }
+    std::vector<GLFrameStatistics::Frame> frames;
+    if(type == com_atakmap_map_opengl_GLMapView_IMPL_V2) {
+        GLGlobe *cview = static_cast<GLGlobe *>(cglobe);
+        code = cview->getFrameStatistics(frames, since);
+        if(ATAKMapEngineJNI_checkOrThrow(env, code))
+            return NULL;
+    }
+
+    // per frame: frame number, timestamp, CPU prepare nanos, CPU submit
+    // nanos, GPU nanos, draw calls, triangles, texture upload bytes, tile
+    // requests issued, tile requests completed, labels placed
+    jlongArray mretval = env->NewLongArray(frames.size()*FrameStatisticsStride);
+    if(!mretval)
+        return NULL;
+    JNILongArray retval(*env, mretval, 0);
+    for(std::size_t i = 0u; i < frames.size(); i++) {
+        const GLFrameStatistics::Frame &frame = frames[i];
+        retval[i*FrameStatisticsStride] = frame.frame;
+        retval[i*FrameStatisticsStride+1u] = frame.timestamp;
+        retval[i*FrameStatisticsStride+2u] = frame.cpuPrepareNanos;
+        retval[i*FrameStatisticsStride+3u] = frame.cpuSubmitNanos;
+        retval[i*FrameStatisticsStride+4u] = frame.gpuNanos;
+        retval[i*FrameStatisticsStride+5u] = (jlong)frame.drawCalls;
+        retval[i*FrameStatisticsStride+6u] = (jlong)frame.triangles;
+        retval[i*FrameStatisticsStride+7u] = (jlong)frame.textureUploadBytes;
+        retval[i*FrameStatisticsStride+8u] = (jlong)frame.tileRequestsIssued;
+        retval[i*FrameStatisticsStride+9u] = (jlong)frame.tileRequestsCompleted;
+        retval[i*FrameStatisticsStride+10u] = (jlong)frame.labelsPlaced;
+    }
+    return mretval;
+}
 
 namespace
 {
@@ -469,6 +469,30 @@ JNIEXPORT void JNICALL Java_com_atakmap_map_opengl_GLMapView_setRenderDiagnostic
 JNIEXPORT jboolean JNICALL Java_com_atakmap_map_opengl_GLMapView_isRenderDiagnosticsEnabled
   (JNIEnv *, jclass, jlong, jint);
 
+/*
+ * Class:     com_atakmap_map_opengl_GLMapView
+ * Method:    setFrameStatisticsEnabled
+ * Signature: (JZI)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_map_opengl_GLMapView_setFrameStatisticsEnabled
+  (JNIEnv *, jclass, jlong, jboolean, jint);
+
+/*
+ * Class:     com_atakmap_map_opengl_GLMapView
+ * Method:    isFrameStatisticsEnabled
+ * Signature: (JI)Z
+ */
+JNIEXPORT jboolean JNICALL Java_com_atakmap_map_opengl_GLMapView_isFrameStatisticsEnabled
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     com_atakmap_map_opengl_GLMapView
+ * Method:    getFrameStatistics
+ * Signature: (JJI)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_com_atakmap_map_opengl_GLMapView_getFrameStatistics
+  (JNIEnv *, jclass, jlong, jlong, jint);
+
 /*
  * Class:     com_atakmap_map_opengl_GLMapView
  * Method:    addRenderDiagnostic
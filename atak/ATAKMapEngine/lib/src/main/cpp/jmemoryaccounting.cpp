@@ -0,0 +1,60 @@
+#include "jmemoryaccounting.h"
+
+#include <util/MemoryAccounting.h>
+
+#include "common.h"
+#include "interop/JNILongArray.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAKEngineJNI::Interop;
+
+namespace
+{
+    /** number of values reported per category by `getSnapshot` */
+    const std::size_t SnapshotStride = 4u;
+}
+
+JNIEXPORT jint JNICALL Java_com_atakmap_util_MemoryAccounting_getNumCategories
+  (JNIEnv *env, jclass clazz)
+{
+    return MemoryAccountingSnapshot::NumCategories;
+}
+JNIEXPORT jstring JNICALL Java_com_atakmap_util_MemoryAccounting_getCategoryName
+  (JNIEnv *env, jclass clazz, jint category)
+{
+    const char *name = MemoryCategory_getName((MemoryCategory)category);
+    if(!name) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return NULL;
+    }
+    return env->NewStringUTF(name);
+}
+JNIEXPORT jlongArray JNICALL Java_com_atakmap_util_MemoryAccounting_getSnapshot
+  (JNIEnv *env, jclass clazz)
+{
+    TAKErr code(TE_Ok);
+    MemoryAccountingSnapshot snapshot;
+    code = MemoryAccounting_getSnapshot(&snapshot);
+    if(ATAKMapEngineJNI_checkOrThrow(env, code))
+        return NULL;
+
+    // per category: bytes, peak bytes, allocations, releases
+    jlongArray mretval = env->NewLongArray(MemoryAccountingSnapshot::NumCategories*SnapshotStride);
+    if(!mretval)
+        return NULL;
+    JNILongArray retval(*env, mretval, 0);
+    for(std::size_t i = 0u; i < MemoryAccountingSnapshot::NumCategories; i++) {
+        const MemoryAccountingSnapshot::Category &category = snapshot.categories[i];
+        retval[i*SnapshotStride] = category.bytes;
+        retval[i*SnapshotStride+1u] = category.peakBytes;
+        retval[i*SnapshotStride+2u] = (jlong)category.allocations;
+        retval[i*SnapshotStride+3u] = (jlong)category.releases;
+    }
+    return mretval;
+}
+JNIEXPORT void JNICALL Java_com_atakmap_util_MemoryAccounting_resetPeaks
+  (JNIEnv *env, jclass clazz)
+{
+    MemoryAccounting_resetPeaks();
+}
@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class com_atakmap_util_MemoryAccounting */
+
+#ifndef _Included_com_atakmap_util_MemoryAccounting
+#define _Included_com_atakmap_util_MemoryAccounting
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     com_atakmap_util_MemoryAccounting
+ * Method:    getNumCategories
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_com_atakmap_util_MemoryAccounting_getNumCategories
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     com_atakmap_util_MemoryAccounting
+ * Method:    getCategoryName
+ * Signature: (I)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_com_atakmap_util_MemoryAccounting_getCategoryName
+  (JNIEnv *, jclass, jint);
+
+/*
+ * Class:     com_atakmap_util_MemoryAccounting
+ * Method:    getSnapshot
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_com_atakmap_util_MemoryAccounting_getSnapshot
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     com_atakmap_util_MemoryAccounting
+ * Method:    resetPeaks
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_util_MemoryAccounting_resetPeaks
+  (JNIEnv *, jclass);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -3,15 +3,20 @@
 #include <feature/FeatureCursor2.h>
 #include <feature/FeatureDataStore2.h>
 #include <feature/Geometry2.h>
+#include <feature/GeometryFactory.h>
 #include <feature/LegacyAdapters.h>
 #include <feature/Style.h>
 #include <util/AttributeSet.h>
+#include <util/DataOutput2.h>
 #include <util/Memory.h>
 
 #include "common.h"
 #include "interop/JNIByteArray.h"
 #include "interop/Pointer.h"
 
+#include <cstring>
+#include <vector>
+
 using namespace TAK::Engine::Feature;
 using namespace TAK::Engine::Util;
 
@@ -20,6 +25,27 @@ using namespace atakmap::util;
 
 using namespace TAKEngineJNI::Interop;
 
+namespace
+{
+    // fetchRows header flags
+    enum
+    {
+        /** the cursor has no more rows */
+        FetchRows_Exhausted = 0x01,
+        /** the cursor's current row did not fit and has not been written */
+        FetchRows_Pending = 0x02,
+    };
+
+    jint toJavaAltitudeMode(const AltitudeMode altMode) NOTHROWS;
+
+    /**
+     * Packs the cursor's current row into 'row'. Style and attribute
+     * handles are written as zero; their offsets are returned so they can
+     * be filled once the row is known to fit.
+     */
+    TAKErr packRow(std::vector<uint8_t> &row, std::size_t *styleHandleOff, std::size_t *attrsHandleOff, FeatureCursor2 &cursor) NOTHROWS;
+}
+
 JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_destruct
   (JNIEnv *env, jclass clazz, jobject jpointer)
 {
@@ -236,15 +262,7 @@ JNIEXPORT jint JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_ge
         return 0LL;
     }
 
-    AltitudeMode altMode =  result->getAltitudeMode();
-    switch(altMode) {
-        case AltitudeMode::TEAM_Relative:
-            return 1;
-        case AltitudeMode::TEAM_Absolute:
-            return 2;
-        default:
-            return 0;
-    }
+    return toJavaAltitudeMode(result->getAltitudeMode());
 }
 
 JNIEXPORT jdouble JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_getExtrude
@@ -258,4 +276,230 @@ JNIEXPORT jdouble JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor
 
     return result->getExtrude();
 }
+/*
+ * Writes up to 'maxRows' rows into the direct ByteBuffer 'jbuf', in native
+ * byte order, advancing the cursor. If 'includeCurrent' is true the first
+ * row written is the cursor's current row (left pending by a previous
+ * call). Returns the number of bytes written.
+ *
+ * Layout:
+ *   int32 numRows, int32 flags (FetchRows_Exhausted, FetchRows_Pending)
+ *   per row:
+ *     int64 fid, int64 fsid, int64 version, int32 altitudeMode, double extrude
+ *     name:     int32 len (-1 if null), UTF-8 bytes
+ *     geometry: int32 coding, int32 len (-1 if null), bytes; geometry
+ *               objects are sent as WKB
+ *     style:    int32 coding, then OGR: int32 len (-1 if null), UTF-8 bytes
+ *                                   Style: int64 pointer, int64 deleter
+ *     attrs:    int64 pointer, int64 deleter
+ *
+ * Non-zero pointer/deleter pairs are owned by the caller and are adopted as
+ * UNIQUE Pointers.
+ */
+JNIEXPORT jint JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_fetchRows
+  (JNIEnv *env, jclass clazz, jlong ptr, jobject jbuf, jint maxRows, jboolean includeCurrent)
+{
+    FeatureCursor2 *result = JLONG_TO_INTPTR(FeatureCursor2, ptr);
+    if(!result || !jbuf || maxRows < 0) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return 0;
+    }
+    uint8_t *buf = static_cast<uint8_t *>(env->GetDirectBufferAddress(jbuf));
+    const jlong capacity = env->GetDirectBufferCapacity(jbuf);
+    if(!buf || capacity < (jlong)(2u*sizeof(int32_t))) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return 0;
+    }
+
+    // header is row count and flags, filled in last
+    std::size_t pos = 2u*sizeof(int32_t);
+    int32_t numRows = 0;
+    int32_t flags = 0;
+
+    // handles are only given up to Java once every row is written
+    std::vector<TAK::Engine::Feature::StylePtr> styles;
+    std::vector<AttributeSetPtr> attrs;
+
+    TAKErr code(TE_Ok);
+    std::vector<uint8_t> row;
+    bool current = !!includeCurrent;
+    while(numRows < maxRows) {
+        if(!current) {
+            code = result->moveToNext();
+            if(code == TE_Done) {
+                flags |= FetchRows_Exhausted;
+                code = TE_Ok;
+                break;
+            }
+            TE_CHECKBREAK_CODE(code);
+        }
+        current = false;
+
+        std::size_t styleHandleOff;
+        std::size_t attrsHandleOff;
+        code = packRow(row, &styleHandleOff, &attrsHandleOff, *result);
+        TE_CHECKBREAK_CODE(code);
+        if(row.size() > (std::size_t)capacity-pos) {
+            // leave the row current for the next call
+            flags |= FetchRows_Pending;
+            break;
+        }
+
+        if(styleHandleOff) {
+            FeatureDefinition2::RawData rawStyle;
+            code = result->getRawStyle(&rawStyle);
+            TE_CHECKBREAK_CODE(code);
+            if(rawStyle.object) {
+                TAK::Engine::Feature::StylePtr cstyle(static_cast<const Style *>(rawStyle.object)->clone(), Style::destructStyle);
+                const int64_t handle[2] = { INTPTR_TO_JLONG(cstyle.get()), INTPTR_TO_JLONG(cstyle.get_deleter()) };
+                memcpy(&row[styleHandleOff], handle, sizeof(handle));
+                styles.push_back(std::move(cstyle));
+            }
+        }
+        const AttributeSet *cattrs;
+        code = result->getAttributes(&cattrs);
+        TE_CHECKBREAK_CODE(code);
+        if(cattrs) {
+            AttributeSetPtr cattrsPtr(new AttributeSet(*cattrs), Memory_deleter_const<AttributeSet>);
+            const int64_t handle[2] = { INTPTR_TO_JLONG(cattrsPtr.get()), INTPTR_TO_JLONG(cattrsPtr.get_deleter()) };
+            memcpy(&row[attrsHandleOff], handle, sizeof(handle));
+            attrs.push_back(std::move(cattrsPtr));
+        }
+
+        memcpy(buf+pos, &row[0], row.size());
+        pos += row.size();
+        numRows++;
+    }
+    if(ATAKMapEngineJNI_checkOrThrow(env, code))
+        return 0;
+
+    memcpy(buf, &numRows, sizeof(int32_t));
+    memcpy(buf+sizeof(int32_t), &flags, sizeof(int32_t));
+    for(std::size_t i = 0u; i < styles.size(); i++)
+        styles[i].release();
+    for(std::size_t i = 0u; i < attrs.size(); i++)
+        attrs[i].release();
+    return (jint)pos;
+}
 
+namespace
+{
+    template<class T>
+    void append(std::vector<uint8_t> &row, const T value) NOTHROWS
+    {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(&value);
+        row.insert(row.end(), p, p+sizeof(T));
+    }
+    void appendBytes(std::vector<uint8_t> &row, const void *data, const std::size_t len) NOTHROWS
+    {
+        append<int32_t>(row, (int32_t)len);
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        row.insert(row.end(), p, p+len);
+    }
+    void appendString(std::vector<uint8_t> &row, const char *str) NOTHROWS
+    {
+        if(str)
+            appendBytes(row, str, strlen(str));
+        else
+            append<int32_t>(row, -1);
+    }
+    std::size_t appendNullHandle(std::vector<uint8_t> &row) NOTHROWS
+    {
+        const std::size_t off = row.size();
+        append<int64_t>(row, 0LL);
+        append<int64_t>(row, 0LL);
+        return off;
+    }
+
+    jint toJavaAltitudeMode(const AltitudeMode altMode) NOTHROWS
+    {
+        switch(altMode) {
+            case AltitudeMode::TEAM_Relative:
+                return 1;
+            case AltitudeMode::TEAM_Absolute:
+                return 2;
+            default:
+                return 0;
+        }
+    }
+
+    TAKErr packRow(std::vector<uint8_t> &row, std::size_t *styleHandleOff, std::size_t *attrsHandleOff, FeatureCursor2 &cursor) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        row.clear();
+
+        int64_t fid;
+        code = cursor.getId(&fid);
+        TE_CHECKRETURN_CODE(code);
+        int64_t fsid;
+        code = cursor.getFeatureSetId(&fsid);
+        TE_CHECKRETURN_CODE(code);
+        int64_t version;
+        code = cursor.getVersion(&version);
+        TE_CHECKRETURN_CODE(code);
+        append<int64_t>(row, fid);
+        append<int64_t>(row, fsid);
+        append<int64_t>(row, version);
+        append<int32_t>(row, toJavaAltitudeMode(cursor.getAltitudeMode()));
+        append<double>(row, cursor.getExtrude());
+
+        const char *cname;
+        code = cursor.getName(&cname);
+        TE_CHECKRETURN_CODE(code);
+        appendString(row, cname);
+
+        // geometry as coding plus bytes; geometry objects go across as WKB
+        FeatureDefinition2::RawData rawGeom;
+        code = cursor.getRawGeometry(&rawGeom);
+        TE_CHECKRETURN_CODE(code);
+        switch(cursor.getGeomCoding()) {
+            case FeatureDefinition2::GeomWkt :
+                append<int32_t>(row, FeatureDefinition2::GeomWkt);
+                appendString(row, rawGeom.text);
+                break;
+            case FeatureDefinition2::GeomWkb :
+            case FeatureDefinition2::GeomBlob :
+                append<int32_t>(row, cursor.getGeomCoding());
+                if(rawGeom.binary.value)
+                    appendBytes(row, rawGeom.binary.value, rawGeom.binary.len);
+                else
+                    append<int32_t>(row, -1);
+                break;
+            case FeatureDefinition2::GeomGeometry :
+                append<int32_t>(row, FeatureDefinition2::GeomWkb);
+                if(rawGeom.object) {
+                    DynamicOutput wkb;
+                    code = wkb.open(1024u);
+                    TE_CHECKRETURN_CODE(code);
+                    code = GeometryFactory_toWkb(wkb, *static_cast<const Geometry2 *>(rawGeom.object));
+                    TE_CHECKRETURN_CODE(code);
+                    const uint8_t *wkbBytes;
+                    std::size_t wkbLen;
+                    code = wkb.get(&wkbBytes, &wkbLen);
+                    TE_CHECKRETURN_CODE(code);
+                    appendBytes(row, wkbBytes, wkbLen);
+                } else {
+                    append<int32_t>(row, -1);
+                }
+                break;
+            default :
+                return TE_IllegalState;
+        }
+
+        // OGR style as text; style objects as a handle to a clone
+        *styleHandleOff = 0u;
+        const FeatureDefinition2::StyleEncoding styleCoding = cursor.getStyleCoding();
+        append<int32_t>(row, styleCoding);
+        if(styleCoding == FeatureDefinition2::StyleOgr) {
+            FeatureDefinition2::RawData rawStyle;
+            code = cursor.getRawStyle(&rawStyle);
+            TE_CHECKRETURN_CODE(code);
+            appendString(row, rawStyle.text);
+        } else {
+            *styleHandleOff = appendNullHandle(row);
+        }
+
+        *attrsHandleOff = appendNullHandle(row);
+        return code;
+    }
+}
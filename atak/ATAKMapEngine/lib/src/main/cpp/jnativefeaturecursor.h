@@ -119,6 +119,14 @@ JNIEXPORT jint JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_ge
 JNIEXPORT jdouble JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_getExtrude
   (JNIEnv *, jclass, jlong);
 
+/*
+ * Class:     com_atakmap_map_layer_feature_NativeFeatureCursor
+ * Method:    fetchRows
+ * Signature: (JLjava/nio/ByteBuffer;IZ)I
+ */
+JNIEXPORT jint JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureCursor_fetchRows
+  (JNIEnv *, jclass, jlong, jobject, jint, jboolean);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,9 @@
 #include "jnativefeaturedatastore.h"
 
 #include <list>
+#include <vector>
 
+#include <feature/AbstractFeatureDataStore2.h>
 #include <feature/Feature2.h>
 #include <feature/FeatureCursor2.h>
 #include <feature/FeatureDataStore2.h>
@@ -24,6 +26,7 @@
 #include "interop/JNIStringUTF.h"
 #include "interop/JNINotifyCallback.h"
 #include "interop/Pointer.h"
+#include "interop/java/JNILocalRef.h"
 
 using namespace TAK::Engine::Feature;
 using namespace TAK::Engine::Util;
@@ -35,6 +38,19 @@ using namespace TAKEngineJNI::Interop;
 
 namespace
 {
+    struct
+    {
+        jclass id;
+        jmethodID onContentChanged;
+    } ContentChangedCallback_class;
+
+    bool CallbackForwarder_class_init(JNIEnv &env) NOTHROWS;
+
+    /**
+     * Forwards to a `NotifyCallback`. If the callback also implements
+     * `NativeFeatureDataStore2.ContentChangedCallback`, stores that describe
+     * their changes have the `ContentChange` forwarded to it instead.
+     */
     class CallbackForwarder : public FeatureDataStore2::OnDataStoreContentChangedListener
     {
     public :
@@ -42,8 +58,12 @@ namespace
         ~CallbackForwarder() NOTHROWS;
     public :
         void onDataStoreContentChanged(FeatureDataStore2 &dataStore) NOTHROWS;
+        void onDataStoreContentChanged(FeatureDataStore2 &dataStore, const FeatureDataStore2::ContentChange &change) NOTHROWS;
+    private :
+        void release(JNIEnv &env) NOTHROWS;
     private :
         jobject impl;
+        bool contentChangedCallback;
     };
 
     TAKErr AttributeSet_merge(AttributeSet &target, const AttributeSet &update)
@@ -1110,6 +1130,25 @@ JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataStore
 
     Pointer_destruct_iface<FeatureDataStore2::OnDataStoreContentChangedListener>(env, jnotifyCallbackPointer);
 }
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataStore2_setContentChangedCoalescingWindow
+  (JNIEnv *env, jclass clazz, jlong ptr, jlong millis)
+{
+    FeatureDataStore2 *dataStore = JLONG_TO_INTPTR(FeatureDataStore2, ptr);
+    if(!dataStore) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_InvalidArg);
+        return;
+    }
+    // coalescing is implemented by `AbstractFeatureDataStore2`
+    auto *abstractDataStore = dynamic_cast<AbstractFeatureDataStore2 *>(dataStore);
+    if(!abstractDataStore) {
+        ATAKMapEngineJNI_checkOrThrow(env, TE_Unsupported);
+        return;
+    }
+    TAKErr code(TE_Ok);
+    code = abstractDataStore->setContentChangedCoalescingWindow(millis);
+    if(ATAKMapEngineJNI_checkOrThrow(env, code))
+        return;
+}
 JNIEXPORT jint JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataStore2_getFEATURE_1ID_1NONE
   (JNIEnv *env, jclass clazz)
 {
@@ -1304,14 +1343,17 @@ JNIEXPORT jint JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataStore
 namespace
 {
     CallbackForwarder::CallbackForwarder(JNIEnv *env_, jobject impl_) NOTHROWS :
-        impl(env_->NewGlobalRef(impl_))
-    {}
+        impl(env_->NewGlobalRef(impl_)),
+        contentChangedCallback(false)
+    {
+        static bool clinit = CallbackForwarder_class_init(*env_);
+        contentChangedCallback = ContentChangedCallback_class.id && env_->IsInstanceOf(impl_, ContentChangedCallback_class.id);
+    }
     CallbackForwarder::~CallbackForwarder() NOTHROWS
     {
         if(impl) {
             LocalJNIEnv env;
-            env->DeleteGlobalRef(impl);
-            impl = NULL;
+            release(*env);
         }
     }
     void CallbackForwarder::onDataStoreContentChanged(FeatureDataStore2 &dataStore) NOTHROWS
@@ -1321,8 +1363,55 @@ namespace
         const TAKErr code = JNINotifyCallback_eventOccurred(impl);
         if(code == TE_Done) {
             LocalJNIEnv env;
-            env->DeleteGlobalRef(impl);
-            impl = NULL;
+            release(*env);
+        }
+    }
+    void CallbackForwarder::onDataStoreContentChanged(FeatureDataStore2 &dataStore, const FeatureDataStore2::ContentChange &change) NOTHROWS
+    {
+        if(!contentChangedCallback) {
+            onDataStoreContentChanged(dataStore);
+            return;
+        }
+        if(!impl)
+            return;
+
+        LocalJNIEnv env;
+        // if there is a pending exception, return
+        if(env->ExceptionCheck())
+            return;
+
+        std::vector<jlong> fids(change.fids.begin(), change.fids.end());
+        Java::JNILocalRef mfids(*env, JNILongArray_newLongArray(env, fids.data(), fids.size()));
+        std::vector<jlong> fsids(change.fsids.begin(), change.fsids.end());
+        Java::JNILocalRef mfsids(*env, JNILongArray_newLongArray(env, fsids.data(), fsids.size()));
+
+        const bool result = env->CallBooleanMethod(impl, ContentChangedCallback_class.onContentChanged,
+                mfids.get(), change.fidsComplete,
+                mfsids.get(),
+                change.hasBounds,
+                change.bounds.minX, change.bounds.minY, change.bounds.minZ,
+                change.bounds.maxX, change.bounds.maxY, change.bounds.maxZ,
+                change.unbounded);
+        if(!env->ExceptionCheck() && !result)
+            release(*env);
+    }
+    void CallbackForwarder::release(JNIEnv &env) NOTHROWS
+    {
+        env.DeleteGlobalRef(impl);
+        impl = NULL;
+    }
+
+    bool CallbackForwarder_class_init(JNIEnv &env) NOTHROWS
+    {
+        ContentChangedCallback_class.id = ATAKMapEngineJNI_findClass(&env, "com/atakmap/map/layer/feature/NativeFeatureDataStore2$ContentChangedCallback");
+        if(!ContentChangedCallback_class.id) {
+            // payload forwarding is unavailable to older managed code
+            if(env.ExceptionCheck())
+                env.ExceptionClear();
+            ContentChangedCallback_class.onContentChanged = NULL;
+            return false;
         }
+        ContentChangedCallback_class.onContentChanged = env.GetMethodID(ContentChangedCallback_class.id, "onContentChanged", "([JZ[JZDDDDDDZ)Z");
+        return true;
     }
 }
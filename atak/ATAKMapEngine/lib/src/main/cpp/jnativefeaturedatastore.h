@@ -335,6 +335,14 @@ JNIEXPORT jobject JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataSt
 JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataStore2_removeOnDataStoreContentChangedListener
   (JNIEnv *, jclass, jlong, jobject);
 
+/*
+ * Class:     com_atakmap_map_layer_feature_NativeFeatureDataStore2
+ * Method:    setContentChangedCoalescingWindow
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_com_atakmap_map_layer_feature_NativeFeatureDataStore2_setContentChangedCoalescingWindow
+  (JNIEnv *, jclass, jlong, jlong);
+
 /*
  * Class:     com_atakmap_map_layer_feature_NativeFeatureDataStore2
  * Method:    getFEATURE_ID_NONE
@@ -3,6 +3,7 @@
 #include <db/Query.h>
 
 #include "common.h"
+#include "interop/JNIClassCache.h"
 #include "interop/Pointer.h"
 #include "interop/JNIByteArray.h"
 #include "interop/JNIStringUTF.h"
@@ -180,7 +181,7 @@ JNIEXPORT jobjectArray JNICALL Java_com_atakmap_database_impl_QueryImpl_getColum
     if(ATAKMapEngineJNI_checkOrThrow(env, code))
         return NULL;
 
-    jobjectArray retval = env->NewObjectArray(count, ATAKMapEngineJNI_findClass(env, "java/lang/String"), NULL);
+    jobjectArray retval = env->NewObjectArray(count, JNIClassCache.String.id, NULL);
     for(std::size_t i = 0u; i < count; i++) {
         const char *colName;
         code = query->getColumnName(&colName, i);
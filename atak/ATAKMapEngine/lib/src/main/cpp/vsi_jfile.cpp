@@ -14,6 +14,10 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -27,6 +31,9 @@
 #include <jni.h>
 #include <sys/stat.h>
 
+#include <thread/Lock.h>
+#include <thread/Mutex.h>
+
 #include "interop/JNIStringUTF.h"
 #include "interop/JNIByteArray.h"
 #include "interop/java/JNILocalRef.h"
@@ -35,6 +42,12 @@
 using namespace TAKEngineJNI::Interop;
 using namespace TAKEngineJNI::Interop::Java;
 
+using namespace TAK::Engine::Thread;
+
+#define VSIJFILE_BLOCK_SIZE         (64u*1024u)
+#define VSIJFILE_MAX_READ_AHEAD     8u
+#define VSIJFILE_CACHE_BLOCKS       256u
+
 namespace
 {
     struct {
@@ -64,11 +77,50 @@ namespace
         jmethodID closeMethodId;
         jmethodID writeMethodId;
         jmethodID readMethodId;
+        jmethodID readAtMethodId;
         jmethodID tellMethodId;
         jmethodID seekMethodId;
         jmethodID sizeMethodId;
     } FileHandle_class;
 
+    /**
+     * Block cache shared by all read-only handles. Blocks are
+     * VSIJFILE_BLOCK_SIZE aligned and evicted least-recently-used across
+     * handles once VSIJFILE_CACHE_BLOCKS are resident.
+     */
+    class BlockCache
+    {
+    private :
+        struct Block
+        {
+            unsigned handle;
+            vsi_l_offset index;
+            std::vector<uint8_t> data;
+        };
+        typedef std::pair<unsigned, vsi_l_offset> Key;
+    public :
+        BlockCache(const std::size_t capacity) NOTHROWS;
+    public :
+        /**
+         * Copies up to `len` bytes from the block starting at `off`.
+         *
+         * @return  the number of bytes copied or `-1` if the block is not
+         *          resident
+         */
+        int64_t read(uint8_t *dst, const unsigned handle, const vsi_l_offset index, const std::size_t off, const std::size_t len) NOTHROWS;
+        void put(const unsigned handle, const vsi_l_offset index, const uint8_t *data, const std::size_t len) NOTHROWS;
+        void evict(const unsigned handle) NOTHROWS;
+    private :
+        std::size_t capacity;
+        std::list<Block> lru;
+        std::map<Key, std::list<Block>::iterator> blocks;
+        Mutex mutex;
+    };
+
+    BlockCache &blockCache() NOTHROWS;
+
+    std::atomic<unsigned> nextHandleId(1u);
+
     bool Handler_Managed_class_init(JNIEnv &env) NOTHROWS;
 
     bool Handle_Managed_class_init(JNIEnv &env) NOTHROWS;
@@ -97,7 +149,7 @@ public:
 class VSIJFileHandle : public VSIVirtualHandle
 {
 public:
-    VSIJFileHandle(JNIEnv &env, jobject instance);
+    VSIJFileHandle(JNIEnv &env, jobject instance, const bool cached);
     virtual ~VSIJFileHandle();
 
     virtual int       Seek( vsi_l_offset nOffset,
@@ -119,24 +171,71 @@ public:
 
 private:
     virtual size_t size();
-
+    /**
+     * Positional read from the channel into `dst`; does not move the
+     * channel position. Returns the number of bytes read.
+     */
+    size_t readAt(JNIEnv &env, uint8_t *dst, const size_t len, const vsi_l_offset offset);
+    /**
+     * Loads the block at `index` into the cache, reading ahead when access
+     * is sequential.
+     */
+    bool fill(JNIEnv &env, const vsi_l_offset index);
+
+    /** when 'true', reads are served via the block cache and position is tracked natively */
+    bool m_cached;
+    unsigned m_id;
+    vsi_l_offset m_offset;
+    vsi_l_offset m_size;
+    /** last block loaded on a miss, used to detect sequential access */
+    vsi_l_offset m_lastMiss;
+    unsigned m_readAhead;
 };
 
-VSIJFileHandle::VSIJFileHandle(JNIEnv &env, jobject instance)
+VSIJFileHandle::VSIJFileHandle(JNIEnv &env, jobject instance, const bool cached) :
+    m_cached(cached),
+    m_id(nextHandleId++),
+    m_offset(0u),
+    m_size(0u),
+    m_lastMiss(~(vsi_l_offset)0u),
+    m_readAhead(1u)
 {
     static bool clinit = Handle_Managed_class_init(env);
     m_instance = env.NewGlobalRef(instance);
+    if(m_cached) {
+        // the content of a read-only handle is not expected to change
+        m_size = env.CallLongMethod(m_instance, FileHandle_class.sizeMethodId);
+        if(env.ExceptionCheck()) {
+            env.ExceptionClear();
+            m_cached = false;
+        }
+    }
 }
 
 VSIJFileHandle::~VSIJFileHandle()
 {
     LocalJNIEnv env;
 
+    if(m_cached)
+        blockCache().evict(m_id);
     env->DeleteGlobalRef(m_instance);
 }
 
 int VSIJFileHandle::Seek(vsi_l_offset nOffset, int nWhence)
 {
+    if(m_cached)
+    {
+        if(nWhence == SEEK_SET)
+            m_offset = nOffset;
+        else if(nWhence == SEEK_CUR)
+            m_offset += nOffset;
+        else if(nWhence == SEEK_END)
+            m_offset = m_size + nOffset;
+        else
+            return -1;
+        return 0;
+    }
+
     LocalJNIEnv env;
 
     jlong startPos(0);
@@ -173,6 +272,9 @@ int VSIJFileHandle::Seek(vsi_l_offset nOffset, int nWhence)
 
 vsi_l_offset VSIJFileHandle::Tell()
 {
+    if(m_cached)
+        return m_offset;
+
     LocalJNIEnv env;
 
     jlong n = env->CallLongMethod(m_instance, FileHandle_class.tellMethodId);
@@ -194,6 +296,40 @@ size_t VSIJFileHandle::Read(void * pBuffer, size_t nSize, size_t nCount)
     if(!length)
         return 0u;
 
+    if(m_cached)
+    {
+        uint8_t *dst = static_cast<uint8_t *>(pBuffer);
+        size_t n = 0u;
+        if((size_t)length >= VSIJFILE_BLOCK_SIZE*VSIJFILE_MAX_READ_AHEAD)
+        {
+            // large reads go straight to the caller's buffer
+            n = readAt(*env, dst, length, m_offset);
+        }
+        else
+        {
+            BlockCache &cache = blockCache();
+            while(n < (size_t)length && (m_offset+n) < m_size)
+            {
+                const vsi_l_offset index = (m_offset+n) / VSIJFILE_BLOCK_SIZE;
+                const std::size_t off = (m_offset+n) % VSIJFILE_BLOCK_SIZE;
+                const int64_t copied = cache.read(dst+n, m_id, index, off, length-n);
+                if(copied < 0)
+                {
+                    if(!fill(*env, index))
+                        break;
+                    continue;
+                }
+                else if(!copied)
+                {
+                    break;
+                }
+                n += (size_t)copied;
+            }
+        }
+        m_offset += n;
+        return n/nSize;
+    }
+
     JNILocalRef buf(*env, env->NewDirectByteBuffer(pBuffer, length));
 
     if (env->ExceptionCheck()) {
@@ -217,6 +353,10 @@ size_t VSIJFileHandle::Write(
     size_t nSize,
     size_t nCount)
 {
+    // cached handles are only created for read-only access
+    if(m_cached)
+        return 0u;
+
     LocalJNIEnv env;
 
     size_t length = nSize*nCount;
@@ -243,6 +383,9 @@ size_t VSIJFileHandle::Write(
 
 int VSIJFileHandle::Eof()
 {
+    if(m_cached)
+        return (m_offset >= m_size) ? EOF : 0;
+
     LocalJNIEnv env;
 
     // shenanigans
@@ -275,11 +418,63 @@ int VSIJFileHandle::Close()
 
 size_t VSIJFileHandle::size()
 {
+    if(m_cached)
+        return m_size;
+
     LocalJNIEnv env;
 
     return env->CallLongMethod(m_instance, FileHandle_class.sizeMethodId);
 }
 
+size_t VSIJFileHandle::readAt(JNIEnv &env, uint8_t *dst, const size_t len, const vsi_l_offset offset)
+{
+    size_t n = 0u;
+    while(n < len)
+    {
+        JNILocalRef buf(env, env.NewDirectByteBuffer(dst+n, len-n));
+        if(env.ExceptionCheck())
+        {
+            env.ExceptionClear();
+            break;
+        }
+        const jint read = env.CallIntMethod(m_instance, FileHandle_class.readAtMethodId, buf.get(), (jlong)(offset+n));
+        if(env.ExceptionCheck())
+        {
+            env.ExceptionClear();
+            break;
+        }
+        if(read <= 0)
+            break;
+        n += read;
+    }
+    return n;
+}
+
+bool VSIJFileHandle::fill(JNIEnv &env, const vsi_l_offset index)
+{
+    // grow the read-ahead window while misses are sequential
+    if(index == m_lastMiss+1u)
+        m_readAhead = std::min(m_readAhead*2u, VSIJFILE_MAX_READ_AHEAD);
+    else
+        m_readAhead = 1u;
+
+    const vsi_l_offset numBlocks = (m_size+VSIJFILE_BLOCK_SIZE-1u) / VSIJFILE_BLOCK_SIZE;
+    if(index >= numBlocks)
+        return false;
+    const unsigned count = (unsigned)std::min((vsi_l_offset)m_readAhead, numBlocks-index);
+
+    std::vector<uint8_t> data(count*VSIJFILE_BLOCK_SIZE);
+    const size_t n = readAt(env, data.data(), data.size(), index*VSIJFILE_BLOCK_SIZE);
+    if(!n)
+        return false;
+
+    BlockCache &cache = blockCache();
+    for(size_t off = 0u; off < n; off += VSIJFILE_BLOCK_SIZE)
+        cache.put(m_id, index+(off/VSIJFILE_BLOCK_SIZE), data.data()+off, std::min((size_t)VSIJFILE_BLOCK_SIZE, n-off));
+    m_lastMiss = index+count-1u;
+    return true;
+}
+
 VSIJFileFilesystemHandler::VSIJFileFilesystemHandler(JNIEnv& env, jobject instance)
 {
     static bool clinit = Handler_Managed_class_init(env);
@@ -312,7 +507,9 @@ VSIJFileFilesystemHandler::Open(
 
     if(handle)
     {
-        return new VSIJFileHandle(*env, handle);
+        // only read-only access is served through the block cache
+        const bool cached = !strpbrk(pszAccess, "wa+");
+        return new VSIJFileHandle(*env, handle, cached);
     }
 
     env->ExceptionClear();
@@ -385,6 +582,66 @@ Java_com_atakmap_map_gdal_VSIJFileFilesystemHandler_installFilesystemHandler(JNI
 
 namespace
 {
+    BlockCache::BlockCache(const std::size_t capacity_) NOTHROWS :
+        capacity(capacity_)
+    {}
+    int64_t BlockCache::read(uint8_t *dst, const unsigned handle, const vsi_l_offset index, const std::size_t off, const std::size_t len) NOTHROWS
+    {
+        Lock lock(mutex);
+        if(lock.status != TAK::Engine::Util::TE_Ok)
+            return -1;
+        auto entry = blocks.find(Key(handle, index));
+        if(entry == blocks.end())
+            return -1;
+        // mark most recently used
+        lru.splice(lru.begin(), lru, entry->second);
+        const std::vector<uint8_t> &data = entry->second->data;
+        if(off >= data.size())
+            return 0;
+        const std::size_t n = std::min(len, data.size()-off);
+        memcpy(dst, data.data()+off, n);
+        return n;
+    }
+    void BlockCache::put(const unsigned handle, const vsi_l_offset index, const uint8_t *data, const std::size_t len) NOTHROWS
+    {
+        Lock lock(mutex);
+        if(lock.status != TAK::Engine::Util::TE_Ok)
+            return;
+        const Key key(handle, index);
+        auto entry = blocks.find(key);
+        if(entry != blocks.end()) {
+            lru.erase(entry->second);
+            blocks.erase(entry);
+        }
+        while(lru.size() >= capacity) {
+            blocks.erase(Key(lru.back().handle, lru.back().index));
+            lru.pop_back();
+        }
+        Block block;
+        block.handle = handle;
+        block.index = index;
+        block.data.assign(data, data+len);
+        lru.push_front(std::move(block));
+        blocks[key] = lru.begin();
+    }
+    void BlockCache::evict(const unsigned handle) NOTHROWS
+    {
+        Lock lock(mutex);
+        if(lock.status != TAK::Engine::Util::TE_Ok)
+            return;
+        auto it = blocks.lower_bound(Key(handle, 0u));
+        while(it != blocks.end() && it->first.first == handle) {
+            lru.erase(it->second);
+            it = blocks.erase(it);
+        }
+    }
+
+    BlockCache &blockCache() NOTHROWS
+    {
+        static BlockCache cache(VSIJFILE_CACHE_BLOCKS);
+        return cache;
+    }
+
     bool Handler_Managed_class_init(JNIEnv &env) NOTHROWS
     {
         FilesystemHandler_class.id      = ATAKMapEngineJNI_findClass(&env, "com/atakmap/map/gdal/VSIJFileFilesystemHandler");
@@ -418,6 +675,7 @@ namespace
         FileHandle_class.closeMethodId = env.GetMethodID(FileHandle_class.id, "close", "()V");
         FileHandle_class.writeMethodId = env.GetMethodID(FileHandle_class.id, "write", "(Ljava/nio/ByteBuffer;)I");
         FileHandle_class.readMethodId  = env.GetMethodID(FileHandle_class.id, "read",  "(Ljava/nio/ByteBuffer;)I");
+        FileHandle_class.readAtMethodId = env.GetMethodID(FileHandle_class.id, "read",  "(Ljava/nio/ByteBuffer;J)I");
         FileHandle_class.tellMethodId  = env.GetMethodID(FileHandle_class.id, "position",  "()J");
         FileHandle_class.seekMethodId  = env.GetMethodID(FileHandle_class.id, "position",  "(J)Ljava/nio/channels/FileChannel;");
         FileHandle_class.sizeMethodId  = env.GetMethodID(FileHandle_class.id, "size",  "()J");
@@ -12,6 +12,7 @@
 #include "simplefileiomanager.h"
 #include "cloudiomanager.h"
 #include "cryptoutil.h"
+#include "metricsregistry.h"
 
 #include <string.h>
 #include <Mutex.h>
@@ -39,11 +40,11 @@ class CoTListenerManagement : public ThreadedHandler, public DatagramListener,
 {
 
 public:
-    CoTListenerManagement(CommoLogger *logger) :
+    CoTListenerManagement(CommoLogger *logger, MetricsRegistry *metrics) :
             ThreadedHandler(1, COTL_THREAD_NAMES),
             DatagramListener(),
             InterfaceStatusListener(),
-            StreamingMessageListener(), logger(logger),
+            StreamingMessageListener(), logger(logger), metrics(metrics),
             queueMutex(), queueMonitor(), queue(), listenerMutex(),
             listeners(), genListeners(),
             ifaceListeners(), ifaceListenersMutex()
@@ -100,6 +101,13 @@ public:
         queueMonitor.broadcast(*lock);
     }
 
+    size_t getQueueDepth()
+    {
+        PGSC::Thread::LockPtr lock(NULL, NULL);
+        PGSC::Thread::Lock_create(lock, queueMutex);
+        return queue.size();
+    }
+
     virtual void threadEntry(size_t threadNum)
     {
         while (!threadShouldStop(threadNum)) {
@@ -114,6 +122,7 @@ public:
                 qitem = queue.back();
                 queue.pop_back();
             }
+            metrics->addDispatch(qitem->queuedTime, CommoTime::now());
             {
                 PGSC::Thread::LockPtr lock(NULL, NULL);
                 PGSC::Thread::Lock_create(lock, listenerMutex);
@@ -259,15 +268,18 @@ private:
         size_t length;
         char *endpointId;
         bool generic;
+        CommoTime queuedTime;
         
         QItem(uint8_t *message, char *endpointId) :
                   message(message), length(0),
-                  endpointId(endpointId), generic(false)
+                  endpointId(endpointId), generic(false),
+                  queuedTime(CommoTime::now())
         {
         }
         QItem(uint8_t *data, size_t length, char *endpointId) :
                   message(data), length(length),
-                  endpointId(endpointId), generic(true)
+                  endpointId(endpointId), generic(true),
+                  queuedTime(CommoTime::now())
         {
         }
         ~QItem()
@@ -281,6 +293,7 @@ private:
     };
 
     CommoLogger *logger;
+    MetricsRegistry *metrics;
     PGSC::Thread::Mutex queueMutex;
     PGSC::Thread::CondVar queueMonitor;
     std::deque<QItem *> queue;
@@ -305,7 +318,7 @@ struct CommoImpl
     CommoImpl(CommoLogger *logger, const ContactUID *ourUID,
             const char *ourCallsign, netinterfaceenums::NetInterfaceAddressMode addrMode) :
                 logger(logger), ourUID(NULL), ourCallsign(ourCallsign),
-                scanner(NULL),
+                metrics(NULL), scanner(NULL),
                 dgMgmt(NULL), tcpMgmt(NULL), streamMgmt(NULL),
                 contactMgmt(NULL), listenerMgmt(NULL),
                 mpMutex(),
@@ -318,14 +331,16 @@ struct CommoImpl
                 providerTracker(NULL)
     {
         this->ourUID = new InternalContactUID(ourUID);
+        metrics = new MetricsRegistry();
         scanner = new HWIFScanner(logger, addrMode);
-        dgMgmt = new DatagramSocketManagement(logger, this->ourUID, scanner);
-        tcpMgmt = new TcpSocketManagement(logger, this->ourUID);
+        dgMgmt = new DatagramSocketManagement(logger, this->ourUID, scanner,
+                                              metrics);
+        tcpMgmt = new TcpSocketManagement(logger, this->ourUID, metrics);
         streamMgmt = new StreamingSocketManagement(logger,
                 std::string((const char *)ourUID->contactUID,
-                            ourUID->contactUIDLen));
+                            ourUID->contactUIDLen), metrics);
         contactMgmt = new ContactManager(logger, dgMgmt, tcpMgmt, streamMgmt);
-        listenerMgmt = new CoTListenerManagement(logger);
+        listenerMgmt = new CoTListenerManagement(logger, metrics);
         crypto = new CryptoUtil(logger);
         providerTracker = new FileIOProviderTracker();
         urlMgmt = new URLRequestManager(logger, providerTracker);
@@ -369,6 +384,7 @@ struct CommoImpl
         delete tcpMgmt;
         delete streamMgmt;
         delete scanner;
+        delete metrics;
         delete ourUID;
     };
 
@@ -435,11 +451,24 @@ struct CommoImpl
         }
     }
 
+    CommoMetrics *getMetrics() {
+        std::map<std::string, size_t> txDepths;
+        streamMgmt->getTxQueueDepths(&txDepths);
+        CommoMetrics *ret = metrics->snapshot(txDepths);
+        dgMgmt->getQueueDepths(&ret->datagramRxQueueDepth,
+                               &ret->datagramTxQueueDepth);
+        ret->tcpRxQueueDepth = tcpMgmt->getRxQueueDepth();
+        ret->streamingRxQueueDepth = streamMgmt->getRxQueueDepth();
+        ret->dispatchQueueDepth = listenerMgmt->getQueueDepth();
+        return ret;
+    }
+
 
 
     CommoLogger *logger;
     InternalContactUID *ourUID;
     std::string ourCallsign;
+    MetricsRegistry *metrics;
     HWIFScanner *scanner;
     DatagramSocketManagement *dgMgmt;
     TcpSocketManagement *tcpMgmt;
@@ -814,6 +843,16 @@ void Commo::freeContactList(const ContactList *contactList)
     ContactManager::freeContactList(contactList);
 }
 
+const CommoMetrics *Commo::getMetrics()
+{
+    return impl->getMetrics();
+}
+
+void Commo::freeMetrics(const CommoMetrics *metrics)
+{
+    MetricsRegistry::freeMetrics(metrics);
+}
+
 CommoResult Commo::configKnownEndpointContact(const ContactUID *contact,
                                               const char *callsign,
                                               const char *ipAddr,
@@ -31,7 +31,7 @@ ContactManager::ContactManager(CommoLogger* logger,
                 StreamingMessageListener(),
                 logger(logger),
                 dgMgr(dgMgmt), tcpMgmt(tcpMgmt), streamMgmt(streamMgmt),
-                contacts(), contactMapMutex(PGSC::Thread::TERW_Fair),
+                shards(),
                 protoVMutex(), protoVMonitor(),
                 protoVersion(TakProtoInfo::SELF_MAX),
                 protoVDirty(false),
@@ -58,10 +58,12 @@ ContactManager::~ContactManager()
     stopThreads();
 
     // Clean up all the contact states
-    ContactMap::iterator iter;
-    for (iter = contacts.begin(); iter != contacts.end(); iter++) {
-        delete iter->second;
-        delete (const InternalContactUID *)iter->first;
+    for (size_t i = 0; i < NUM_CONTACT_SHARDS; ++i) {
+        ContactMap::iterator iter;
+        for (iter = shards[i].contacts.begin(); iter != shards[i].contacts.end(); iter++) {
+            delete iter->second;
+            delete (const InternalContactUID *)iter->first.uid;
+        }
     }
 
     // Clean any remaining queue items
@@ -71,6 +73,27 @@ ContactManager::~ContactManager()
 }
 
 
+ContactKey::ContactKey(const ContactUID *uid) : uid(uid), hash(2166136261u)
+{
+    // FNV-1a
+    for (size_t i = 0; i < uid->contactUIDLen; ++i) {
+        hash ^= uid->contactUID[i];
+        hash *= 16777619u;
+    }
+}
+
+ContactManager::ContactShard::ContactShard() : contacts(),
+                mutex(PGSC::Thread::TERW_Fair)
+{
+}
+
+ContactManager::ContactShard &ContactManager::shardFor(const ContactKey &key)
+{
+    // Fold in high bits; the maps themselves bucket on the low ones
+    return shards[(key.hash ^ (key.hash >> 16)) % NUM_CONTACT_SHARDS];
+}
+
+
 /**********************************************************************/
 // ThreadedHandler stuff
 
@@ -124,18 +147,18 @@ void ContactManager::protoVThreadProcess()
             unsigned int uberMin = TakProtoInfo::SELF_MIN;
             unsigned int uberMax = TakProtoInfo::SELF_MAX;
             int newProtoV = uberMax;
-            {
+            for (size_t i = 0; i < NUM_CONTACT_SHARDS; ++i) {
                 PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-                PGSC::Thread::ReadLock_create(lock, contactMapMutex);
+                PGSC::Thread::ReadLock_create(lock, shards[i].mutex);
                 
                 ContactMap::iterator iter;
-                for (iter = contacts.begin(); iter != contacts.end(); iter++) {
+                for (iter = shards[i].contacts.begin(); iter != shards[i].contacts.end(); iter++) {
                     ContactState *state = iter->second;
                     PGSC::Thread::LockPtr stateLock(NULL, NULL);
                     PGSC::Thread::Lock_create(stateLock, state->mutex);
                     
-                    std::string dbgUid((const char *)iter->first->contactUID,
-                                       iter->first->contactUIDLen);
+                    std::string dbgUid((const char *)iter->first.uid->contactUID,
+                                       iter->first.uid->contactUIDLen);
                     bool epStale = nowTime >= state->meshEndpointExpireTime;
 #if 0
                     InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG,
@@ -326,14 +349,16 @@ CommoResult ContactManager::processContactUpdate(
     if (knownEP && type != CoTEndpoint::DATAGRAM)
         return COMMO_ILLEGAL_ARGUMENT;
 
+    ContactKey key(uid);
+    ContactShard &shard = shardFor(key);
     ContactState *state = NULL;
     bool isOk = true;
     bool protoNeedsRefresh = false;
     {
         PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-        PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-        ContactMap::iterator iter = contacts.find(uid);
-        if (iter != contacts.end()) {
+        PGSC::Thread::ReadLock_create(lock, shard.mutex);
+        ContactMap::iterator iter = shard.contacts.find(key);
+        if (iter != shard.contacts.end()) {
             state = iter->second;
             isOk = processContactStateUpdate(state, &protoNeedsRefresh,
                                              protoInfOnly,
@@ -346,9 +371,9 @@ CommoResult ContactManager::processContactUpdate(
     if (!protoInfOnly && !state) {
         // Retry with the write lock so we can add new if needed
         PGSC::Thread::WriteLockPtr lock(NULL, NULL);
-        PGSC::Thread::WriteLock_create(lock, contactMapMutex);
-        ContactMap::iterator iter = contacts.find(uid);
-        bool isNew = (iter == contacts.end());
+        PGSC::Thread::WriteLock_create(lock, shard.mutex);
+        ContactMap::iterator iter = shard.contacts.find(key);
+        bool isNew = (iter == shard.contacts.end());
         if (!isNew) {
             state = iter->second;
         } else {
@@ -366,7 +391,9 @@ CommoResult ContactManager::processContactUpdate(
                 delete state;
             } else {
                 ContactUID *intUID = new InternalContactUID(uid);
-                contacts[intUID] = state;
+                ContactKey intKey = key;
+                intKey.uid = intUID;
+                shard.contacts[intKey] = state;
                 queueContactPresenceChange(intUID, true);
                 protoNeedsRefresh = true;
             }
@@ -468,11 +495,11 @@ void ContactManager::removeStream(const std::string &epString)
     // We only presently listen to streams
     std::set<ContactUID *> removedUids;
 
-    {
+    for (size_t i = 0; i < NUM_CONTACT_SHARDS; ++i) {
         PGSC::Thread::WriteLockPtr lock(NULL, NULL);
-        PGSC::Thread::WriteLock_create(lock, contactMapMutex);
-        ContactMap::iterator iter = contacts.begin();
-        while (iter != contacts.end()) {
+        PGSC::Thread::WriteLock_create(lock, shards[i].mutex);
+        ContactMap::iterator iter = shards[i].contacts.begin();
+        while (iter != shards[i].contacts.end()) {
             ContactMap::iterator curIter = iter;
             iter++;
             bool killState = false;
@@ -483,9 +510,9 @@ void ContactManager::removeStream(const std::string &epString)
                 if (state->streamEndpoint &&
                             state->streamEndpoint->getEndpointString() == epString) {
                     if (!state->datagramEndpoint && !state->tcpEndpoint) {
-                        queueContactPresenceChange(curIter->first, false);
-                        delete (const InternalContactUID *)curIter->first;
-                        contacts.erase(curIter);
+                        queueContactPresenceChange(curIter->first.uid, false);
+                        delete (const InternalContactUID *)curIter->first.uid;
+                        shards[i].contacts.erase(curIter);
                         killState = true;
                     } else {
                         // Don't delete this one - still has other EPs
@@ -528,14 +555,16 @@ CommoResult ContactManager::sendCoT(
     typedef std::pair<std::vector<std::string>, std::vector<const ContactUID *> > CallContactPair;
     std::map<std::string, CallContactPair > streamMap;
     {
-        PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-        PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-
         std::map<std::string, CallContactPair >::iterator smIter;
         std::vector<const ContactUID *>::iterator iter;
         for (iter = destinations->begin(); iter != destinations->end(); ++iter) {
-            ContactMap::iterator contactIter = contacts.find(*iter);
-            if (contactIter == contacts.end()) {
+            ContactKey key(*iter);
+            ContactShard &shard = shardFor(key);
+            PGSC::Thread::ReadLockPtr lock(NULL, NULL);
+            PGSC::Thread::ReadLock_create(lock, shard.mutex);
+
+            ContactMap::iterator contactIter = shard.contacts.find(key);
+            if (contactIter == shard.contacts.end()) {
                 // This contact is gone
                 ret.push_back(*iter);
                 continue;
@@ -554,8 +583,8 @@ CommoResult ContactManager::sendCoT(
                         throw std::invalid_argument("");
 
                     std::string contactUidStr(
-                            (const char *)contactIter->first->contactUID,
-                            contactIter->first->contactUIDLen);
+                            (const char *)contactIter->first.uid->contactUID,
+                            contactIter->first.uid->contactUIDLen);
 
                     switch (ep->getType()) {
                     case CoTEndpoint::DATAGRAM:
@@ -722,57 +751,58 @@ void ContactManager::setPreferStreamEndpoint(bool preferStream)
  */
 std::map<std::string, std::string> ContactManager::getAllContactsIP()
 {
-    PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-    PGSC::Thread::ReadLock_create(lock, contactMapMutex);
     std::map<std::string, std::string> cmap;
-    ContactMap::iterator iter;
-    int i;
-    for (i = 0, iter = contacts.begin(); iter != contacts.end(); i++, iter++) {
-        CoTEndpoint *ep = getCurrentEndpoint(iter->second, CoTSendMethod(SEND_POINT_TO_POINT));
-
-        std::string contactUidStr(
-            (const char *)iter->first->contactUID,
-            iter->first->contactUIDLen);
-        try
-        {
-            if (!ep)
-                throw std::invalid_argument("");
-            switch (ep->getType())
-            {
-            case CoTEndpoint::DATAGRAM:
+    for (size_t i = 0; i < NUM_CONTACT_SHARDS; ++i) {
+        PGSC::Thread::ReadLockPtr lock(NULL, NULL);
+        PGSC::Thread::ReadLock_create(lock, shards[i].mutex);
+        ContactMap::iterator iter;
+        for (iter = shards[i].contacts.begin(); iter != shards[i].contacts.end(); iter++) {
+            CoTEndpoint *ep = getCurrentEndpoint(iter->second, CoTSendMethod(SEND_POINT_TO_POINT));
+
+            std::string contactUidStr(
+                (const char *)iter->first.uid->contactUID,
+                iter->first.uid->contactUIDLen);
+            try
             {
-                DatagramCoTEndpoint *dgce = (DatagramCoTEndpoint *)ep;
-                std::string endpoint;
-                dgce->getBaseAddr()->getIPString(&endpoint);
+                if (!ep)
+                    throw std::invalid_argument("");
+                switch (ep->getType())
+                {
+                case CoTEndpoint::DATAGRAM:
+                {
+                    DatagramCoTEndpoint *dgce = (DatagramCoTEndpoint *)ep;
+                    std::string endpoint;
+                    dgce->getBaseAddr()->getIPString(&endpoint);
                 
-                InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Found contact %s using datagram endpoint %s and protocol version %d", contactUidStr.c_str(), endpoint.c_str(), 0);
-
-                cmap.emplace(contactUidStr, endpoint);
-                break;
-            }
-            case CoTEndpoint::TCP:
-            {
-                TcpCoTEndpoint *tcpce = (TcpCoTEndpoint *)ep;
-                std::string host = tcpce->getHostString();
-                int version = getSendProtoVersion(iter->second);
-                InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Sending CoT to contact %s using tcp endpoint %s and protocol version %d", contactUidStr.c_str(), host.c_str(), version);
+                    InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Found contact %s using datagram endpoint %s and protocol version %d", contactUidStr.c_str(), endpoint.c_str(), 0);
 
-                cmap.emplace(contactUidStr, host);
-                break;
+                    cmap.emplace(contactUidStr, endpoint);
+                    break;
+                }
+                case CoTEndpoint::TCP:
+                {
+                    TcpCoTEndpoint *tcpce = (TcpCoTEndpoint *)ep;
+                    std::string host = tcpce->getHostString();
+                    int version = getSendProtoVersion(iter->second);
+                    InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Sending CoT to contact %s using tcp endpoint %s and protocol version %d", contactUidStr.c_str(), host.c_str(), version);
+
+                    cmap.emplace(contactUidStr, host);
+                    break;
+                }
+                case CoTEndpoint::STREAMING:
+                {
+                    // we don't handle TAK server messages
+                    InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "TAK Server endpoint requested!");
+                    throw std::invalid_argument("");
+                }
+                default:
+                    throw std::invalid_argument("");
+                } 
             }
-            case CoTEndpoint::STREAMING:
+            catch(const std::invalid_argument&)
             {
-                // we don't handle TAK server messages
-                InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "TAK Server endpoint requested!");
-                throw std::invalid_argument("");
+                InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Endpoint could not be parsed for contact %s", contactUidStr.c_str());
             }
-            default:
-                throw std::invalid_argument("");
-            } 
-        }
-        catch(const std::invalid_argument&)
-        {
-            InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Endpoint could not be parsed for contact %s", contactUidStr.c_str());
         }
     }
     return cmap;
@@ -780,14 +810,18 @@ std::map<std::string, std::string> ContactManager::getAllContactsIP()
 
 const ContactList *ContactManager::getAllContacts()
 {
-    PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-    PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-    size_t n = contacts.size();
+    std::vector<const ContactUID *> v;
+    for (size_t i = 0; i < NUM_CONTACT_SHARDS; ++i) {
+        PGSC::Thread::ReadLockPtr lock(NULL, NULL);
+        PGSC::Thread::ReadLock_create(lock, shards[i].mutex);
+        ContactMap::iterator iter;
+        for (iter = shards[i].contacts.begin(); iter != shards[i].contacts.end(); iter++)
+            v.push_back(new InternalContactUID(iter->first.uid));
+    }
+    size_t n = v.size();
     const ContactUID **extContacts = new const ContactUID*[n];
-    ContactMap::iterator iter;
-    int i;
-    for (i = 0, iter = contacts.begin(); iter != contacts.end(); i++, iter++)
-        extContacts[i] = new InternalContactUID(iter->first);
+    for (size_t i = 0; i < n; ++i)
+        extContacts[i] = v[i];
     return new ContactList(n, extContacts);
 }
 
@@ -811,17 +845,19 @@ CommoResult ContactManager::configKnownEndpointContact(
 
     if (!ipAddr && !callsign) {
         // Delete this "known" contact
+        ContactKey key(contact);
+        ContactShard &shard = shardFor(key);
         PGSC::Thread::WriteLockPtr lock(NULL, NULL);
-        PGSC::Thread::WriteLock_create(lock, contactMapMutex);
-        ContactMap::iterator iter = contacts.find(contact);
-        if (iter == contacts.end())
+        PGSC::Thread::WriteLock_create(lock, shard.mutex);
+        ContactMap::iterator iter = shard.contacts.find(key);
+        if (iter == shard.contacts.end())
             return COMMO_ILLEGAL_ARGUMENT;
 
         ContactState *state = iter->second;
         if (!state->knownEndpoint)
             return COMMO_ILLEGAL_ARGUMENT;
 
-        contacts.erase(iter);
+        shard.contacts.erase(iter);
         delete state;
         return COMMO_SUCCESS;
         
@@ -843,10 +879,12 @@ CommoResult ContactManager::configKnownEndpointContact(
 
 std::string ContactManager::getActiveEndpointHost(const ContactUID *contact)
 {
+    ContactKey key(contact);
+    ContactShard &shard = shardFor(key);
     PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-    PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-    ContactMap::iterator iter = contacts.find(contact);
-    if (iter == contacts.end())
+    PGSC::Thread::ReadLock_create(lock, shard.mutex);
+    ContactMap::iterator iter = shard.contacts.find(key);
+    if (iter == shard.contacts.end())
         return "";
 
     {
@@ -868,18 +906,21 @@ std::string ContactManager::getActiveEndpointHost(const ContactUID *contact)
 
 bool ContactManager::hasContact(const ContactUID *contact)
 {
+    ContactKey key(contact);
+    ContactShard &shard = shardFor(key);
     PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-    PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-    ContactMap::iterator iter = contacts.find(contact);
-    return iter != contacts.end();
+    PGSC::Thread::ReadLock_create(lock, shard.mutex);
+    return shard.contacts.find(key) != shard.contacts.end();
 }
 
 bool ContactManager::hasStreamingEndpoint(const ContactUID *contact)
 {
+    ContactKey key(contact);
+    ContactShard &shard = shardFor(key);
     PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-    PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-    ContactMap::iterator iter = contacts.find(contact);
-    if (iter == contacts.end())
+    PGSC::Thread::ReadLock_create(lock, shard.mutex);
+    ContactMap::iterator iter = shard.contacts.find(key);
+    if (iter == shard.contacts.end())
         return false;
 
     {
@@ -891,10 +932,12 @@ bool ContactManager::hasStreamingEndpoint(const ContactUID *contact)
 
 std::string ContactManager::getStreamEndpointIdentifier(const ContactUID *contact, bool ifActive) COMMO_THROW (std::invalid_argument)
 {
+    ContactKey key(contact);
+    ContactShard &shard = shardFor(key);
     PGSC::Thread::ReadLockPtr lock(NULL, NULL);
-    PGSC::Thread::ReadLock_create(lock, contactMapMutex);
-    ContactMap::iterator iter = contacts.find(contact);
-    if (iter == contacts.end())
+    PGSC::Thread::ReadLock_create(lock, shard.mutex);
+    ContactMap::iterator iter = shard.contacts.find(key);
+    if (iter == shard.contacts.end())
         throw std::invalid_argument("Specified contact is not known");
 
     {
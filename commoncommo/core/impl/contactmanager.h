@@ -19,6 +19,8 @@
 #include <stdexcept>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <string.h>
 
 
 namespace atakmap {
@@ -166,17 +168,30 @@ struct ContactState
 };
 
 
-struct ContactUIDComp
+// A ContactUID together with its hash, computed once up front so that
+// picking a shard and probing that shard's map hash the bytes only once
+struct ContactKey
 {
-    bool operator()(const ContactUID * const &a, const ContactUID * const &b) const {
-        const size_t n = a->contactUIDLen < b->contactUIDLen ? a->contactUIDLen : b->contactUIDLen;
-        for (size_t i = 0; i < n; ++i) {
-            if (a->contactUID[i] < b->contactUID[i])
-                return true;
-            if (a->contactUID[i] > b->contactUID[i])
-                return false;
-        }
-        return a->contactUIDLen < b->contactUIDLen;
+    const ContactUID *uid;
+    size_t hash;
+
+    explicit ContactKey(const ContactUID *uid);
+};
+
+struct ContactKeyHash
+{
+    size_t operator()(const ContactKey &k) const {
+        return k.hash;
+    }
+};
+
+struct ContactKeyEq
+{
+    bool operator()(const ContactKey &a, const ContactKey &b) const {
+        return a.hash == b.hash &&
+               a.uid->contactUIDLen == b.uid->contactUIDLen &&
+               memcmp(a.uid->contactUID, b.uid->contactUID,
+                      a.uid->contactUIDLen) == 0;
     }
 };
 
@@ -289,9 +304,23 @@ private:
     DatagramSocketManagement *dgMgr;
     TcpSocketManagement *tcpMgmt;
     StreamingSocketManagement *streamMgmt;
-    typedef std::map<const ContactUID *, ContactState *, ContactUIDComp> ContactMap;
-    ContactMap contacts;
-    PGSC::Thread::RWMutex contactMapMutex;
+    // Contacts are spread over independently locked shards by UID hash
+    // so that updates for one contact do not serialize behind
+    // lookups or updates for unrelated ones.  Where more than one shard
+    // lock is needed, they are taken one at a time, never nested.
+    static const size_t NUM_CONTACT_SHARDS = 16;
+    typedef std::unordered_map<ContactKey, ContactState *, ContactKeyHash, ContactKeyEq> ContactMap;
+    struct ContactShard {
+        ContactMap contacts;
+        PGSC::Thread::RWMutex mutex;
+
+        ContactShard();
+    private:
+        COMMO_DISALLOW_COPY(ContactShard);
+    };
+    ContactShard shards[NUM_CONTACT_SHARDS];
+
+    ContactShard &shardFor(const ContactKey &key);
     
     PGSC::Thread::Mutex protoVMutex;
     PGSC::Thread::CondVar protoVMonitor; // Fire when dirty set = true
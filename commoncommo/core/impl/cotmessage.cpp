@@ -1,5 +1,6 @@
 #define __STDC_LIMIT_MACROS
 #include "cotmessage.h"
+#include "cotscanner.h"
 #include "commotime.h"
 #include "internalutils.h"
 #include "cryptoutil.h"
@@ -72,6 +73,23 @@ namespace {
             xmlNewProp(node, (const xmlChar *)"endpoint", (const xmlChar *)epStr.c_str());
     }
 
+    // Strip any <_flow-tags_ elements under <detail>
+    // These are added in transit by TAK server to control routing.
+    // If this exists in the message and matches the server's tag,
+    // TAK server will drop the message thinking it was routed in a loop.
+    // See WTK-1434
+    void removeFlowTags(xmlNode *detailsElement)
+    {
+        for (xmlNode *child = detailsElement->children; child; ) {
+            xmlNode *curChild = child;
+            child = child->next;
+            if (xmlStrEqual(curChild->name, (const xmlChar *)"_flow-tags_")) {
+                xmlUnlinkNode(curChild);
+                xmlFreeNode(curChild);
+            }
+        }
+    }
+
     std::string checkedGetProp(xmlNode *node, const char *name) COMMO_THROW (std::invalid_argument)
     {
         xmlChar *p = xmlGetProp(node, (const xmlChar *)name);
@@ -145,6 +163,25 @@ namespace impl
 
 struct CoTMessageImpl
 {
+    // Elements of interest, located either in the DOM or,
+    // for messages that have not been modified since being parsed,
+    // in the scanned source
+    typedef enum {
+        EVENT_ELEMENT,
+        CONTACT_ELEMENT,
+        FILESHARE_ELEMENT,
+        ACKREQUEST_ELEMENT,
+        ACKRESPONSE_ELEMENT
+    } KnownElement;
+
+    // Messages parsed from a buffer keep a copy of the source and are
+    // only scanned; doc remains NULL until the message is modified.
+    // Once doc exists it is authoritative and source is released.
+    std::string source;
+    CoTScanner scanner;
+    // Receives parse diagnostics; may be NULL
+    CommoLogger *logger;
+
     xmlDoc *doc;
     xmlNode *eventElement;
     xmlNode *detailsElement;
@@ -175,6 +212,7 @@ struct CoTMessageImpl
                                    const std::string &how,
                                    float staleSeconds,
                                    const CoTPointData &point) :
+                                        logger(NULL),
                                         doc(NULL), eventElement(NULL),
                                         detailsElement(NULL),
                                         contactElement(NULL),
@@ -210,6 +248,7 @@ struct CoTMessageImpl
                                    const std::string &opex,
                                    const CoTPointData &point,
                                    xmlNode *details) :
+                                        logger(NULL),
                                         doc(NULL), eventElement(NULL),
                                         detailsElement(NULL),
                                         contactElement(NULL),
@@ -250,6 +289,7 @@ struct CoTMessageImpl
                                    const ContactUID *receiveruid,
                                    const bool failed,
                                    const std::string &message) :
+                                        logger(NULL),
                                         doc(NULL), eventElement(NULL),
                                         detailsElement(NULL),
                                         contactElement(NULL),
@@ -300,6 +340,7 @@ struct CoTMessageImpl
                                    float staleSeconds,
                                    const CoTPointData &point,
                                    CoTFileTransferRequest fileTransferRequest) :
+                                        logger(NULL),
                                         doc(NULL), eventElement(NULL),
                                         detailsElement(NULL),
                                         contactElement(NULL),
@@ -364,7 +405,8 @@ struct CoTMessageImpl
         xferReq = new CoTFileTransferRequest(fileTransferRequest);
     }
 
-    CoTMessageImpl(const uint8_t* data, const size_t len) COMMO_THROW (std::invalid_argument) :
+    CoTMessageImpl(CommoLogger *logger, const uint8_t* data, const size_t len) COMMO_THROW (std::invalid_argument) :
+            logger(logger),
             doc(NULL), eventElement(NULL), detailsElement(NULL),
             contactElement(NULL), fileShareElement(NULL),
             fileShareAckElement(NULL),
@@ -382,6 +424,15 @@ struct CoTMessageImpl
             ce(0),
             le(0)
     {
+        source.assign((const char *)data, len);
+        if (scanner.scan(source.data(), source.length()) &&
+                scanner.detail.present) {
+            scannedInit();
+            return;
+        }
+
+        // Not something the scanner handles - let libxml sort it out
+        std::string().swap(source);
         doc = xmlReadMemory((const char *)data, (int)len, "mbuf:", NULL, XML_PARSE_NONET);
         if (!doc)
             throw std::invalid_argument("Unable to parse XML");
@@ -390,6 +441,7 @@ struct CoTMessageImpl
     }
 
     CoTMessageImpl(const CoTMessageImpl *src) COMMO_THROW (std::invalid_argument) :
+            logger(src->logger),
             doc(NULL), eventElement(NULL), detailsElement(NULL),
             contactElement(NULL), fileShareElement(NULL),
             fileShareAckElement(NULL), ackRequestElement(NULL),
@@ -406,6 +458,13 @@ struct CoTMessageImpl
             ce(src->ce),
             le(src->le)
     {
+        if (!src->doc) {
+            source = src->source;
+            scanner = src->scanner;
+            scannedInit();
+            return;
+        }
+
         doc = xmlCopyDoc(src->doc, 1);
         if (!doc)
             throw std::invalid_argument("Unable to copy existing document tree");
@@ -423,9 +482,187 @@ struct CoTMessageImpl
             delete uid;
         }
     }
+
+    bool hasElement(KnownElement e) const
+    {
+        if (doc)
+            return getNode(e) != NULL;
+        return getScanned(e).present;
+    }
+
+    // Returns false if the element or the attribute is absent
+    bool getProp(KnownElement e, const char *name, std::string *value) const
+    {
+        if (!doc) {
+            const CoTScanner::Element &se = getScanned(e);
+            return se.present &&
+                   scanner.getAttribute(source.data(), se, name, value);
+        }
+
+        xmlNode *node = getNode(e);
+        if (!node)
+            return false;
+        xmlChar *p = xmlGetProp(node, (const xmlChar *)name);
+        if (!p)
+            return false;
+        *value = (const char *)p;
+        xmlFree(p);
+        return true;
+    }
+
+    std::string checkedProp(KnownElement e, const char *name) const
+                                COMMO_THROW (std::invalid_argument)
+    {
+        std::string ret;
+        if (!getProp(e, name, &ret))
+            throw std::invalid_argument("");
+        return ret;
+    }
+
+    // Parses the retained source into a new document, less flow tags,
+    // without disturbing this message.  NULL if there is no source
+    // or it cannot be parsed.  Caller owns the result.
+    xmlDoc *parseSource() const
+    {
+        if (doc || source.empty())
+            return NULL;
+        xmlDoc *ret = xmlReadMemory(source.data(), (int)source.length(),
+                                    "mbuf:", NULL, XML_PARSE_NONET);
+        if (!ret)
+            return NULL;
+        xmlNode *root = xmlDocGetRootElement(ret);
+        xmlNode *details = root ?
+                getFirstChildElementByName(root, (const xmlChar *)"detail") :
+                NULL;
+        if (details)
+            removeFlowTags(details);
+        return ret;
+    }
+
+    // Builds the DOM for a message that so far was only scanned,
+    // in preparation for modifying it.  Returns false if the DOM is
+    // unavailable, in which case the message is left untouched.
+    bool buildDoc()
+    {
+        if (doc)
+            return true;
+
+        xmlDoc *newDoc = parseSource();
+        if (!newDoc)
+            return false;
+
+        // init() recreates these; hang on to them in case it fails
+        xmlChar *oldUidBacking = uidBacking;
+        ContactUID *oldUid = uid;
+        CoTFileTransferRequest *oldXferReq = xferReq;
+        uid = NULL;
+        xferReq = NULL;
+        doc = newDoc;
+        try {
+            init();
+        } catch (std::invalid_argument &) {
+            if (uid) {
+                xmlFree(uidBacking);
+                delete uid;
+            }
+            if (xferReq)
+                delete xferReq;
+            uidBacking = oldUidBacking;
+            uid = oldUid;
+            xferReq = oldXferReq;
+            return false;
+        }
+
+        xmlFree(oldUidBacking);
+        delete oldUid;
+        if (oldXferReq)
+            delete oldXferReq;
+        std::string().swap(source);
+        return true;
+    }
+
 private:
     COMMO_DISALLOW_COPY(CoTMessageImpl);
 
+    xmlNode *getNode(KnownElement e) const
+    {
+        switch (e) {
+        case EVENT_ELEMENT:
+            return eventElement;
+        case CONTACT_ELEMENT:
+            return contactElement;
+        case FILESHARE_ELEMENT:
+            return fileShareElement;
+        case ACKREQUEST_ELEMENT:
+            return ackRequestElement;
+        case ACKRESPONSE_ELEMENT:
+            return fileShareAckElement;
+        }
+        return NULL;
+    }
+
+    const CoTScanner::Element &getScanned(KnownElement e) const
+    {
+        switch (e) {
+        case EVENT_ELEMENT:
+            break;
+        case CONTACT_ELEMENT:
+            return scanner.contact;
+        case FILESHARE_ELEMENT:
+            return scanner.fileShare;
+        case ACKREQUEST_ELEMENT:
+            return scanner.ackRequest;
+        case ACKRESPONSE_ELEMENT:
+            return scanner.ackResponse;
+        }
+        return scanner.event;
+    }
+
+    void logBadParse(const std::invalid_argument &e) {
+        if (logger)
+            InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG,
+                                     "Bad parse: %s", e.what());
+    }
+
+    // Counterpart of init() for scanned messages
+    void scannedInit() COMMO_THROW (std::invalid_argument) {
+        if (!scanner.event.present)
+            throw std::invalid_argument("Invalid root node for CoT message");
+
+        if (!getProp(EVENT_ELEMENT, "uid", &uidString))
+            throw std::invalid_argument("Missing uid in CoT event");
+
+        try {
+            howString = checkedProp(EVENT_ELEMENT, "how");
+            typeString = checkedProp(EVENT_ELEMENT, "type");
+            timeMillis = millisFromCotTime(checkedProp(EVENT_ELEMENT, "time"));
+            startTimeMillis = millisFromCotTime(checkedProp(EVENT_ELEMENT, "start"));
+            staleTimeMillis = millisFromCotTime(checkedProp(EVENT_ELEMENT, "stale"));
+
+            const CoTScanner::Element &pointElement = scanner.point;
+            if (!pointElement.present)
+                throw std::invalid_argument("");
+            std::string s;
+            const char *pointAttrs[] = { "lat", "lon", "hae", "ce", "le" };
+            double *pointValues[] = { &latitude, &longitude, &hae, &ce, &le };
+            for (size_t i = 0; i < 5; ++i) {
+                if (!scanner.getAttribute(source.data(), pointElement,
+                                          pointAttrs[i], &s))
+                    throw std::invalid_argument("");
+                *pointValues[i] = InternalUtils::doubleFromString(s.c_str());
+            }
+        } catch (std::invalid_argument &e) {
+            logBadParse(e);
+            throw std::invalid_argument("Missing or invalid CoT event and/or point attributes");
+        }
+
+        uidBacking = xmlStrdup((const xmlChar *)uidString.c_str());
+        uid = new ContactUID(uidBacking, uidString.length());
+
+        type = scanner.chat.present ? CHAT : SITUATIONAL_AWARENESS;
+        transferInit();
+    }
+
     void init() COMMO_THROW (std::invalid_argument) {
         // Try to extract the base CoT elements
         eventElement = xmlDocGetRootElement(doc);
@@ -466,7 +703,7 @@ private:
             le = InternalUtils::doubleFromString(
                     checkedGetProp(pointElement, "le").c_str());
         } catch (std::invalid_argument &e) {
-            fprintf(stderr, "Bad parse: %s\n", e.what());
+            logBadParse(e);
             xmlFreeDoc(doc);
             doc = NULL;
             throw std::invalid_argument("Missing or invalid CoT event and/or point attributes");
@@ -486,19 +723,7 @@ private:
     
     void detailsInit()
     {
-        // Strip any <_flow-tags_ elements under <detail>
-        // These are added in transit by TAK server to control routing.
-        // If this exists in the message and matches the server's tag,
-        // TAK server will drop the message thinking it was routed in a loop.
-        // See WTK-1434
-        for (xmlNode *child = detailsElement->children; child; ) {
-            xmlNode *curChild = child;
-            child = child->next;
-            if (xmlStrEqual(curChild->name, (const xmlChar *)"_flow-tags_")) {
-                xmlUnlinkNode(curChild);
-                xmlFreeNode(curChild);
-            }
-        }
+        removeFlowTags(detailsElement);
 
         // OK if this is NULL
         contactElement = getFirstChildElementByName(detailsElement, (const xmlChar *)"contact");
@@ -512,40 +737,39 @@ private:
         xmlNode *chatNode = getFirstChildElementByName(detailsElement, (const xmlChar *)"__chat");
         type = chatNode ? CHAT : SITUATIONAL_AWARENESS;
 
-        if (fileShareElement) {
+        transferInit();
+    }
+
+    void transferInit()
+    {
+        if (hasElement(FILESHARE_ELEMENT)) {
             try {
-                std::string sha256 = checkedGetProp(fileShareElement, "sha256");
-                std::string name = checkedGetProp(fileShareElement, "name");
-                std::string senderFilename = checkedGetProp(fileShareElement, "filename");
-                std::string senderUrl= checkedGetProp(fileShareElement, "senderUrl");
-                std::string sizeInBytesStr = checkedGetProp(fileShareElement, "sizeInBytes");
+                std::string sha256 = checkedProp(FILESHARE_ELEMENT, "sha256");
+                std::string name = checkedProp(FILESHARE_ELEMENT, "name");
+                std::string senderFilename = checkedProp(FILESHARE_ELEMENT, "filename");
+                std::string senderUrl= checkedProp(FILESHARE_ELEMENT, "senderUrl");
+                std::string sizeInBytesStr = checkedProp(FILESHARE_ELEMENT, "sizeInBytes");
                 uint64_t sizeInBytes = atoll(sizeInBytesStr.c_str());
-                std::string senderUidStr = checkedGetProp(fileShareElement, "senderUid");
+                std::string senderUidStr = checkedProp(FILESHARE_ELEMENT, "senderUid");
                 ContactUID senderuid((const uint8_t *)senderUidStr.c_str(),
                                      senderUidStr.length());
-                std::string senderCallsign = checkedGetProp(fileShareElement, "senderCallsign");
+                std::string senderCallsign = checkedProp(FILESHARE_ELEMENT, "senderCallsign");
 
                 bool peerHosted = false;
-                xmlChar *xmlProp = xmlGetProp(fileShareElement, (const xmlChar *)"peerHosted");
-                if (xmlProp) {
-                    std::string peerHostedStr = (char *)xmlProp;
-                    xmlFree(xmlProp);
-                    peerHosted = peerHostedStr == "true";
-                }
+                std::string prop;
+                if (getProp(FILESHARE_ELEMENT, "peerHosted", &prop))
+                    peerHosted = prop == "true";
                 int httpsPort = MP_LOCAL_PORT_DISABLE;
-                xmlProp = xmlGetProp(fileShareElement, (const xmlChar *)"httpsPort");
-                if (xmlProp) {
-                    std::string httpsPortStr = (char *)xmlProp;
-                    xmlFree(xmlProp);
-                    httpsPort = InternalUtils::intFromString(httpsPortStr.c_str(), 1, 65535);
-                }
+                if (getProp(FILESHARE_ELEMENT, "httpsPort", &prop))
+                    httpsPort = InternalUtils::intFromString(prop.c_str(), 1, 65535);
 
                 std::string ackuid;
-                ackRequestElement = getFirstChildElementByName(detailsElement, (const xmlChar *)"ackrequest");
-                if (ackRequestElement) {
-                    std::string ackReq = checkedGetProp(ackRequestElement, "ackrequested");
+                if (doc)
+                    ackRequestElement = getFirstChildElementByName(detailsElement, (const xmlChar *)"ackrequest");
+                if (hasElement(ACKREQUEST_ELEMENT)) {
+                    std::string ackReq = checkedProp(ACKREQUEST_ELEMENT, "ackrequested");
                     if (ackReq == "true")
-                        ackuid = checkedGetProp(ackRequestElement, "uid");
+                        ackuid = checkedProp(ACKREQUEST_ELEMENT, "uid");
                 }
 
                 xferReq = new CoTFileTransferRequest(sha256, name,
@@ -669,7 +893,9 @@ CoTMessage::CoTMessage(CommoLogger *logger,
 
 CoTMessage::CoTMessage(CommoLogger *logger, 
                        const std::string &uid,
-                       int version) : internalState(NULL),
+                       int version,
+                       const std::string &compression) :
+                                      internalState(NULL),
                                       logger(logger)
 {
     internalState = new CoTMessageImpl(uid, 
@@ -683,6 +909,9 @@ CoTMessage::CoTMessage(CommoLogger *logger,
     std::string vs = InternalUtils::intToString(version);
     xmlNewProp(n, (const xmlChar *)"version",
                (const xmlChar *)vs.c_str());
+    if (!compression.empty())
+        xmlNewProp(n, (const xmlChar *)"compression",
+                   (const xmlChar *)compression.c_str());
 }
 
 CoTMessage::CoTMessage(CommoLogger *logger, 
@@ -740,7 +969,7 @@ CoTMessage::~CoTMessage()
 void CoTMessage::reinitFrom(
         const uint8_t* data, const size_t len) COMMO_THROW (std::invalid_argument)
 {
-    CoTMessageImpl *newImpl = new CoTMessageImpl(data, len);
+    CoTMessageImpl *newImpl = new CoTMessageImpl(logger, data, len);
 
     // Wipe any old impl
     if (internalState)
@@ -752,15 +981,16 @@ void CoTMessage::reinitFrom(
 void CoTMessage::reinitFromProtobuf(
         const protobuf::v1::CotEvent &ev) COMMO_THROW (std::invalid_argument)
 {
-    const std::string uid = ev.uid();
-    const std::string type = ev.type();
-    const std::string how = ev.how();
+    // References into ev, not copies; ev outlives this call
+    const std::string &uid = ev.uid();
+    const std::string &type = ev.type();
+    const std::string &how = ev.how();
     uint64_t timeMillis = ev.sendtime();
     uint64_t startTimeMillis = ev.starttime();
     uint64_t staleTimeMillis = ev.staletime();
-    const std::string access = ev.access();
-    const std::string qos = ev.qos();
-    const std::string opex = ev.opex();
+    const std::string &access = ev.access();
+    const std::string &qos = ev.qos();
+    const std::string &opex = ev.opex();
     double lat = ev.lat();
     double lon = ev.lon();
     double hae = ev.hae();
@@ -770,11 +1000,17 @@ void CoTMessage::reinitFromProtobuf(
     
     xmlNode *detailsNode = NULL;
     if (ev.has_detail()) {
-        const protobuf::v1::Detail detail = ev.detail();
+        const protobuf::v1::Detail &detail = ev.detail();
         
-        std::string xmlDetail = 
-            "<?xml version=\"1.0\" encoding=\"UTF-8\"?><detail>" +
-            detail.xmldetail() + "</detail>";
+        static const char DETAIL_PREFIX[] =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?><detail>";
+        static const char DETAIL_SUFFIX[] = "</detail>";
+        std::string xmlDetail;
+        xmlDetail.reserve(sizeof(DETAIL_PREFIX) + detail.xmldetail().size() +
+                          sizeof(DETAIL_SUFFIX));
+        xmlDetail.append(DETAIL_PREFIX);
+        xmlDetail.append(detail.xmldetail());
+        xmlDetail.append(DETAIL_SUFFIX);
         size_t detailSize = xmlDetail.size();
         if (detailSize > INT_MAX)
             throw std::invalid_argument("Details string too long");
@@ -869,9 +1105,23 @@ void CoTMessage::reinitFromProtobuf(
 
 size_t CoTMessage::serialize(uint8_t **buf, bool prettyFormat) const COMMO_THROW (std::invalid_argument)
 {
+    xmlDoc *doc = internalState->doc;
+    xmlDoc *tempDoc = NULL;
+    if (!doc) {
+        // Unmodified since parsed; the source, less flow tags, will do
+        if (!prettyFormat)
+            return internalState->scanner.serialize(
+                    internalState->source.data(), buf);
+        doc = tempDoc = internalState->parseSource();
+        if (!doc)
+            throw std::invalid_argument("Unknown error serializing CoTMessage");
+    }
+
     xmlChar *outPtr = NULL;
     int outSize;
-    xmlDocDumpFormatMemory(internalState->doc, &outPtr, &outSize, prettyFormat ? 1 : 0);
+    xmlDocDumpFormatMemory(doc, &outPtr, &outSize, prettyFormat ? 1 : 0);
+    if (tempDoc)
+        xmlFreeDoc(tempDoc);
     if (outPtr == NULL)
         throw std::invalid_argument("Unknown error serializing CoTMessage");
     if (!prettyFormat && outSize > 0 && outPtr[outSize - 1] == '\n')
@@ -889,7 +1139,10 @@ void CoTMessage::serializeAsProtobuf(
         protobuf::v1::CotEvent *ev)
             const COMMO_THROW (std::invalid_argument)
 {
-    xmlDoc *doc = xmlCopyDoc(internalState->doc, 1);
+    xmlDoc *doc = internalState->doc ?
+            xmlCopyDoc(internalState->doc, 1) : internalState->parseSource();
+    if (!doc)
+        throw std::invalid_argument("Error converting cot to protobuf");
     
     try {
         xmlNode *eventElement = xmlDocGetRootElement(doc);
@@ -1129,6 +1382,11 @@ std::string CoTMessage::getEventUid() const
     return internalState->uidString;
 }
 
+std::string CoTMessage::getEventType() const
+{
+    return internalState->typeString;
+}
+
 CoTMessageType CoTMessage::getType() const
 {
     return internalState->type;
@@ -1137,15 +1395,11 @@ CoTMessageType CoTMessage::getType() const
 TakControlType CoTMessage::getTakControlType() const
 {
     TakControlType ret = TakControlType::TYPE_NONE;
-    xmlChar *p = xmlGetProp(internalState->eventElement, (const xmlChar *)"type");
-    if (p) {
-        for (int i = 0; i < TakControlType::TYPE_NONE; ++i) {
-            if (strcmp((const char *)p, TAKCONTROL_TYPE_STRINGS[i]) == 0) {
-                ret = (TakControlType)i;
-                break;
-            }
+    for (int i = 0; i < TakControlType::TYPE_NONE; ++i) {
+        if (internalState->typeString == TAKCONTROL_TYPE_STRINGS[i]) {
+            ret = (TakControlType)i;
+            break;
         }
-        xmlFree(p);
     }
     return ret;
 }
@@ -1153,7 +1407,25 @@ TakControlType CoTMessage::getTakControlType() const
 std::set<int> CoTMessage::getTakControlSupportedVersions() const
 {
     std::set<int> ret;
-    if (internalState->detailsElement) {
+    if (!internalState->doc) {
+        const CoTScanner &scanner = internalState->scanner;
+        std::vector<CoTScanner::Element>::const_iterator iter;
+        for (iter = scanner.takProtocolSupport.begin();
+                iter != scanner.takProtocolSupport.end(); ++iter) {
+            try {
+                std::string vs;
+                if (!scanner.getAttribute(internalState->source.data(),
+                                          *iter, "version", &vs))
+                    throw std::invalid_argument("");
+                int v = InternalUtils::intFromString(vs.c_str());
+                ret.insert(v);
+            } catch (std::invalid_argument &) {
+                InternalUtils::logprintf(logger,
+                    CommoLogger::LEVEL_WARNING,
+                    "Version tag in TakProtocolSupport message is missing or has invalid value");
+            }
+        }
+    } else if (internalState->detailsElement) {
         xmlNode *c = getFirstChildElementByName(internalState->detailsElement, (const xmlChar *)"TakControl");
         if (c) {
             for (xmlNode *child = c->children; child; child = child->next) {
@@ -1177,7 +1449,18 @@ std::set<int> CoTMessage::getTakControlSupportedVersions() const
 bool CoTMessage::getTakControlResponseStatus() const
 {
     bool ret = false;
-    if (internalState->detailsElement) {
+    if (!internalState->doc) {
+        const CoTScanner &scanner = internalState->scanner;
+        if (scanner.takResponse.present) {
+            std::string s;
+            if (!scanner.getAttribute(internalState->source.data(),
+                                      scanner.takResponse, "status", &s))
+                InternalUtils::logprintf(logger, CommoLogger::LEVEL_WARNING,
+                    "Status tag in TakResponse message is missing");
+            else if (s == "true")
+                ret = true;
+        }
+    } else if (internalState->detailsElement) {
         xmlNode *c = getFirstChildElementByName(internalState->detailsElement,
                                                 (const xmlChar *)"TakControl");
         if (c) {
@@ -1198,18 +1481,68 @@ bool CoTMessage::getTakControlResponseStatus() const
     return ret;
 }
 
+std::set<std::string> CoTMessage::getTakControlSupportedCompression() const
+{
+    std::set<std::string> ret;
+    if (!internalState->doc) {
+        const CoTScanner &scanner = internalState->scanner;
+        std::vector<CoTScanner::Element>::const_iterator iter;
+        for (iter = scanner.takCompressionSupport.begin();
+                iter != scanner.takCompressionSupport.end(); ++iter) {
+            std::string s;
+            if (scanner.getAttribute(internalState->source.data(),
+                                     *iter, "algorithm", &s))
+                ret.insert(s);
+        }
+    } else if (internalState->detailsElement) {
+        xmlNode *c = getFirstChildElementByName(internalState->detailsElement,
+                                                (const xmlChar *)"TakControl");
+        if (c) {
+            for (xmlNode *child = c->children; child; child = child->next) {
+                if (xmlStrEqual(child->name,
+                                (const xmlChar *)"TakCompressionSupport")) {
+                    try {
+                        ret.insert(checkedGetProp(child, "algorithm"));
+                    } catch (std::invalid_argument &) {
+                    }
+                }
+            }
+        }
+    }
+    return ret;
+}
 
-bool CoTMessage::isPong() const
+std::string CoTMessage::getTakControlResponseCompression() const
 {
-    bool ret = false;
-    xmlChar *p = xmlGetProp(internalState->eventElement, (const xmlChar *)"type");
-    if (p) {
-        ret = strcmp((const char *)p, TYPE_PONG) == 0;
-        xmlFree(p);
+    std::string ret;
+    if (!internalState->doc) {
+        const CoTScanner &scanner = internalState->scanner;
+        if (scanner.takResponse.present)
+            scanner.getAttribute(internalState->source.data(),
+                                 scanner.takResponse, "compression", &ret);
+    } else if (internalState->detailsElement) {
+        xmlNode *c = getFirstChildElementByName(internalState->detailsElement,
+                                                (const xmlChar *)"TakControl");
+        if (c) {
+            xmlNode *r = getFirstChildElementByName(c,
+                                              (const xmlChar *)"TakResponse");
+            if (r) {
+                try {
+                    ret = checkedGetProp(r, "compression");
+                } catch (std::invalid_argument &) {
+                }
+            }
+        }
     }
     return ret;
 }
 
+
+bool CoTMessage::isPong() const
+{
+    return internalState->typeString == TYPE_PONG;
+}
+
 const CoTFileTransferRequest *CoTMessage::getFileTransferRequest() const
 {
     return internalState->xferReq;
@@ -1217,81 +1550,45 @@ const CoTFileTransferRequest *CoTMessage::getFileTransferRequest() const
 
 std::string CoTMessage::getFileTransferAckSenderUid() const
 {
-    if (!internalState->fileShareAckElement)
-        return std::string("");
-
-    xmlChar *p = xmlGetProp(internalState->fileShareAckElement, (const xmlChar *)"senderUid");
-    if (!p)
-        return std::string("");
-    std::string ret = (char *)p;
-    xmlFree(p);
+    std::string ret;
+    internalState->getProp(CoTMessageImpl::ACKRESPONSE_ELEMENT, "senderUid", &ret);
     return ret;
 }
 
 std::string CoTMessage::getFileTransferAckUid() const
 {
-    if (!internalState->fileShareAckElement)
-        return std::string("");
-
-    xmlChar *p = xmlGetProp(internalState->fileShareAckElement, (const xmlChar *)"uid");
-    if (!p)
-        return std::string("");
-    std::string ret = (char *)p;
-    xmlFree(p);
+    std::string ret;
+    internalState->getProp(CoTMessageImpl::ACKRESPONSE_ELEMENT, "uid", &ret);
     return ret;
 }
 
 uint64_t CoTMessage::getFileTransferAckSize() const
 {
-    if (!internalState->fileShareAckElement)
-        return 0;
-
-    xmlChar *p = xmlGetProp(internalState->fileShareAckElement, (const xmlChar *)"sizeInBytes");
-    if (!p)
+    std::string s;
+    if (!internalState->getProp(CoTMessageImpl::ACKRESPONSE_ELEMENT, "sizeInBytes", &s))
         return 0;
-    uint64_t ret = atoll((char *)p);
-    xmlFree(p);
-    return ret;
+    return atoll(s.c_str());
 }
 
 bool CoTMessage::getFileTransferSucceeded() const
 {
-    if (!internalState->fileShareAckElement)
-        return false;
-
-    xmlChar *p = xmlGetProp(internalState->fileShareAckElement, (const xmlChar *)"success");
-    bool yes = p && strcmp((char *)p, "true") == 0;
-    if (p)
-        xmlFree(p);
-    return yes;
+    std::string s;
+    return internalState->getProp(CoTMessageImpl::ACKRESPONSE_ELEMENT, "success", &s) &&
+           s == "true";
 }
 
 
 std::string CoTMessage::getFileTransferReason() const
 {
-    if (!internalState->fileShareAckElement)
-        return std::string("");
-
-    xmlChar *p = xmlGetProp(internalState->fileShareAckElement, (const xmlChar *)"reason");
-    if (!p)
-        return std::string("");
-    std::string ret = (char *)p;
-    xmlFree(p);
+    std::string ret;
+    internalState->getProp(CoTMessageImpl::ACKRESPONSE_ELEMENT, "reason", &ret);
     return ret;
 }
 
 std::string CoTMessage::endpointAsString() const
 {
     std::string s("");
-    if (internalState->contactElement == NULL)
-        return s;
-    xmlChar *ep = xmlGetProp(internalState->contactElement, (const xmlChar *)"endpoint");
-    if (!ep)
-        return s;
-
-    s = (char *)ep;
-    xmlFree(ep);
-
+    internalState->getProp(CoTMessageImpl::CONTACT_ELEMENT, "endpoint", &s);
     return s;
 }
 
@@ -1351,8 +1648,13 @@ EndpointType CoTMessage::getEndpointType() const
 
 void CoTMessage::setEndpoint(EndpointType type, const std::string &s)
 {
-    if (!internalState->contactElement)
+    if (!internalState->hasElement(CoTMessageImpl::CONTACT_ELEMENT))
+        return;
+    if (!internalState->buildDoc()) {
+        InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR,
+                "Unable to build document to set endpoint");
         return;
+    }
 
     std::string epStr;
     std::string protoStr;
@@ -1403,15 +1705,7 @@ void CoTMessage::setEndpoint(EndpointType type, const std::string &s)
 std::string CoTMessage::getCallsign() const
 {
     std::string s("");
-    if (internalState->contactElement == NULL)
-        return s;
-    xmlChar *ep = xmlGetProp(internalState->contactElement, (const xmlChar *)"callsign");
-    if (!ep)
-        return s;
-
-    s = (char *)ep;
-    xmlFree(ep);
-
+    internalState->getProp(CoTMessageImpl::CONTACT_ELEMENT, "callsign", &s);
     return s;
 }
 
@@ -1427,7 +1721,8 @@ const ContactUID* CoTMessage::getContactUID() const
     // of the actual callsign!  This fouls up callsign tracking of
     // a contact, so we want to say we have no contact for ack messages.
     // See WTK-2132 for more background.
-    if (internalState->contactElement && !internalState->fileShareAckElement)
+    if (internalState->hasElement(CoTMessageImpl::CONTACT_ELEMENT) &&
+            !internalState->hasElement(CoTMessageImpl::ACKRESPONSE_ELEMENT))
         return internalState->uid;
     else
         return NULL;
@@ -1436,6 +1731,12 @@ const ContactUID* CoTMessage::getContactUID() const
 void CoTMessage::setTAKServerRecipients(
         const std::vector<std::string>* recipients)
 {
+    if (!internalState->buildDoc()) {
+        InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR,
+                "Unable to build document to set TAK server recipients");
+        return;
+    }
+
     const xmlChar *martiNodeName = (const xmlChar *)"marti";
     xmlNode *martiNode = getFirstChildElementByName(internalState->detailsElement, martiNodeName);
 
@@ -1465,6 +1766,12 @@ void CoTMessage::setTAKServerRecipients(
 
 void CoTMessage::setTAKServerMissionRecipient(const std::string &mission)
 {
+    if (!internalState->buildDoc()) {
+        InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR,
+                "Unable to build document to set TAK server mission");
+        return;
+    }
+
     const xmlChar *martiNodeName = (const xmlChar *)"marti";
     xmlNode *martiNode = getFirstChildElementByName(internalState->detailsElement, martiNodeName);
 
@@ -109,9 +109,11 @@ public:
     CoTMessage(CommoLogger *logger, const std::string &uid);
     
     // Init a new TakControl/TakResponse message indicating
-    // desire to use the specified version of TAK protocol
+    // desire to use the specified version of TAK protocol and, if
+    // compression is non-empty, the named stream compression
     CoTMessage(CommoLogger *logger, const std::string &uid,
-               int version);
+               int version,
+               const std::string &compression = std::string());
 
     // Init a new file transfer request CoTMessage
     CoTMessage(CommoLogger *logger, 
@@ -168,6 +170,9 @@ public:
     // Gets the uid string from the event
     std::string getEventUid() const;
 
+    // Gets the type string from the event, such as "a-f-G-U-C"
+    std::string getEventType() const;
+
     // "endpoints" are simply stringified network addresses of the sender.
     // Endpoint host includes only the host - it does not include anything else
     // (port #'s, protocol info), just IP or host.
@@ -215,6 +220,15 @@ public:
     
     // If this is a TYPE_RESPONSE message, returns the status of the response
     bool getTakControlResponseStatus() const;
+
+    // If this is a TYPE_SUPPORT message, returns the set of stream
+    // compression schemes advertised as being supported in the message.
+    // If not a TYPE_SUPPORT message, returns empty set.
+    std::set<std::string> getTakControlSupportedCompression() const;
+
+    // If this is a TYPE_RESPONSE message, returns the stream compression
+    // scheme the response accepts, or the empty string if none
+    std::string getTakControlResponseCompression() const;
     
     // True if this message is a "pong" message
     bool isPong() const;
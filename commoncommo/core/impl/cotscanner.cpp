@@ -0,0 +1,653 @@
+#include "cotscanner.h"
+
+#include <string.h>
+
+using namespace atakmap::commoncommo::impl;
+
+
+namespace {
+    bool isWhitespace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    bool isNameStartChar(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    bool isNameChar(char c)
+    {
+        return isNameStartChar(c) || (c >= '0' && c <= '9') ||
+               c == '-' || c == '.';
+    }
+
+    // True if c is allowed by the Char production of the XML spec
+    bool isXmlChar(uint32_t c)
+    {
+        return c == 0x9 || c == 0xA || c == 0xD ||
+               (c >= 0x20 && c <= 0xD7FF) ||
+               (c >= 0xE000 && c <= 0xFFFD) ||
+               (c >= 0x10000 && c <= 0x10FFFF);
+    }
+
+    // Checks that all of data is well formed UTF-8 consisting solely
+    // of valid XML characters
+    bool validateChars(const char *data, size_t len)
+    {
+        const uint8_t *p = (const uint8_t *)data;
+        const uint8_t *end = p + len;
+        while (p < end) {
+            uint8_t b = *p;
+            if (b < 0x80) {
+                if (b < 0x20 && b != '\t' && b != '\n' && b != '\r')
+                    return false;
+                p++;
+                continue;
+            }
+
+            size_t n;
+            uint32_t c;
+            uint32_t min;
+            if ((b & 0xE0) == 0xC0) {
+                n = 1;
+                c = b & 0x1F;
+                min = 0x80;
+            } else if ((b & 0xF0) == 0xE0) {
+                n = 2;
+                c = b & 0x0F;
+                min = 0x800;
+            } else if ((b & 0xF8) == 0xF0) {
+                n = 3;
+                c = b & 0x07;
+                min = 0x10000;
+            } else {
+                return false;
+            }
+            if ((size_t)(end - p) <= n)
+                return false;
+            for (size_t i = 1; i <= n; ++i) {
+                if ((p[i] & 0xC0) != 0x80)
+                    return false;
+                c = (c << 6) | (p[i] & 0x3F);
+            }
+            // Rejects overlong forms and surrogates as well
+            if (c < min || !isXmlChar(c))
+                return false;
+            p += n + 1;
+        }
+        return true;
+    }
+
+    void appendUtf8(std::string *s, uint32_t c)
+    {
+        if (c < 0x80) {
+            s->push_back((char)c);
+        } else if (c < 0x800) {
+            s->push_back((char)(0xC0 | (c >> 6)));
+            s->push_back((char)(0x80 | (c & 0x3F)));
+        } else if (c < 0x10000) {
+            s->push_back((char)(0xE0 | (c >> 12)));
+            s->push_back((char)(0x80 | ((c >> 6) & 0x3F)));
+            s->push_back((char)(0x80 | (c & 0x3F)));
+        } else {
+            s->push_back((char)(0xF0 | (c >> 18)));
+            s->push_back((char)(0x80 | ((c >> 12) & 0x3F)));
+            s->push_back((char)(0x80 | ((c >> 6) & 0x3F)));
+            s->push_back((char)(0x80 | (c & 0x3F)));
+        }
+    }
+
+    // Parses the character or predefined entity reference starting
+    // at the '&' at data[*pos].  On success, the referenced character
+    // is stored in c and pos is advanced past the terminating ';'
+    bool parseReference(const char *data, size_t len, size_t *pos,
+                        uint32_t *c)
+    {
+        size_t p = *pos + 1;
+        if (p < len && data[p] == '#') {
+            p++;
+            uint32_t base = 10;
+            if (p < len && data[p] == 'x') {
+                base = 16;
+                p++;
+            }
+            uint32_t v = 0;
+            size_t digits = 0;
+            for (; p < len && data[p] != ';'; ++p, ++digits) {
+                char d = data[p];
+                uint32_t dv;
+                if (d >= '0' && d <= '9')
+                    dv = d - '0';
+                else if (base == 16 && d >= 'a' && d <= 'f')
+                    dv = d - 'a' + 10;
+                else if (base == 16 && d >= 'A' && d <= 'F')
+                    dv = d - 'A' + 10;
+                else
+                    return false;
+                v = v * base + dv;
+                if (v > 0x10FFFF)
+                    return false;
+            }
+            if (p >= len || !digits || !isXmlChar(v))
+                return false;
+            *c = v;
+            *pos = p + 1;
+            return true;
+        }
+
+        static const struct {
+            const char *name;
+            size_t len;
+            char c;
+        } entities[] = {
+            { "lt;", 3, '<' },
+            { "gt;", 3, '>' },
+            { "amp;", 4, '&' },
+            { "quot;", 5, '"' },
+            { "apos;", 5, '\'' }
+        };
+        for (size_t i = 0; i < sizeof(entities) / sizeof(entities[0]); ++i) {
+            if (len - p >= entities[i].len &&
+                    memcmp(data + p, entities[i].name, entities[i].len) == 0) {
+                *c = (uint32_t)entities[i].c;
+                *pos = p + entities[i].len;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char FLOW_TAGS_NAME[] = "_flow-tags_";
+}
+
+
+CoTScanner::CoTScanner() : event(), point(), detail(), contact(),
+        fileShare(), ackRequest(), ackResponse(), chat(), takControl(),
+        takProtocolSupport(), takCompressionSupport(), takResponse(),
+        flowTags(),
+        hasDecl(false), declEncoding(), declStandalone(-1),
+        data(NULL), len(0), pos(0), stack()
+{
+}
+
+void CoTScanner::reset()
+{
+    event = Element();
+    point = Element();
+    detail = Element();
+    contact = Element();
+    fileShare = Element();
+    ackRequest = Element();
+    ackResponse = Element();
+    chat = Element();
+    takControl = Element();
+    takProtocolSupport.clear();
+    takCompressionSupport.clear();
+    takResponse = Element();
+    flowTags.clear();
+    hasDecl = false;
+    declEncoding = Span();
+    declStandalone = -1;
+    pos = 0;
+    stack.clear();
+}
+
+bool CoTScanner::scan(const char *data, size_t len)
+{
+    reset();
+    this->data = data;
+    this->len = len;
+
+    if (!validateChars(data, len))
+        return false;
+
+    if (len > 5 && startsWith("<?xml") && isWhitespace(data[5])) {
+        if (!scanDeclaration())
+            return false;
+    }
+    skipWhitespace();
+
+    // Root element - anything else in the prolog goes to the full parser
+    if (pos >= len || data[pos] != '<' || startsWith("<!") || startsWith("<?"))
+        return false;
+
+    // Scratch space for the attributes of elements not being recorded;
+    // still collected so duplicates can be detected
+    std::vector<std::pair<Span, Span> > attrs;
+    bool root = true;
+    do {
+        if (!root) {
+            if (pos >= len)
+                return false;
+            if (data[pos] != '<') {
+                if (!scanText())
+                    return false;
+                continue;
+            } else if (startsWith("</")) {
+                if (!scanEndTag())
+                    return false;
+                continue;
+            } else if (startsWith("<!--")) {
+                if (!scanComment())
+                    return false;
+                continue;
+            } else if (startsWith("<![CDATA[")) {
+                if (!scanCData())
+                    return false;
+                continue;
+            } else if (startsWith("<?")) {
+                if (!scanPI())
+                    return false;
+                continue;
+            } else if (startsWith("<!")) {
+                return false;
+            }
+        }
+
+        size_t begin = pos;
+        bool empty = false;
+        Span name;
+        attrs.clear();
+        if (!scanStartTag(&empty, &name, &attrs))
+            return false;
+
+        int depth = root ? 0 : stack.back().depth + 1;
+        Element *record = NULL;
+        if (root)
+            record = nameEquals(name, "event") ? &event : NULL;
+        else if (stack.back().record)
+            record = recordFor(name);
+        root = false;
+
+        if (record) {
+            record->present = true;
+            record->extent.begin = begin;
+            record->attributes = attrs;
+        }
+        if (empty) {
+            if (record)
+                record->extent.end = pos;
+            if (depth == 2 && stack.back().record == &detail &&
+                    nameEquals(name, FLOW_TAGS_NAME))
+                flowTags.push_back(Span(begin, pos));
+        } else {
+            OpenElement open;
+            open.name = name;
+            open.record = record;
+            open.begin = begin;
+            open.depth = depth;
+            stack.push_back(open);
+        }
+    } while (!stack.empty());
+
+    skipWhitespace();
+    return pos == len;
+}
+
+bool CoTScanner::getAttribute(const char *data, const Element &e,
+                              const char *name, std::string *value) const
+{
+    size_t nameLen = strlen(name);
+    std::vector<std::pair<Span, Span> >::const_iterator iter;
+    for (iter = e.attributes.begin(); iter != e.attributes.end(); ++iter) {
+        const Span &n = iter->first;
+        if (n.end - n.begin != nameLen || memcmp(data + n.begin, name, nameLen) != 0)
+            continue;
+
+        // Decode references and normalize whitespace as a conforming
+        // parser does for attributes of undeclared (CDATA) type
+        const Span &v = iter->second;
+        value->clear();
+        value->reserve(v.end - v.begin);
+        for (size_t i = v.begin; i < v.end; ) {
+            char c = data[i];
+            uint32_t ref;
+            if (c == '&' && parseReference(data, v.end, &i, &ref)) {
+                appendUtf8(value, ref);
+                continue;
+            }
+            if (c == '\r' && i + 1 < v.end && data[i + 1] == '\n')
+                i++;
+            value->push_back(isWhitespace(c) ? ' ' : c);
+            i++;
+        }
+        return true;
+    }
+    return false;
+}
+
+size_t CoTScanner::serialize(const char *data, uint8_t **buf) const
+{
+    std::string decl = "<?xml version=\"1.0\"";
+    if (hasDecl && declEncoding.end > declEncoding.begin) {
+        decl += " encoding=\"";
+        decl.append(data + declEncoding.begin, declEncoding.end - declEncoding.begin);
+        decl += "\"";
+    }
+    if (declStandalone == 1)
+        decl += " standalone=\"yes\"";
+    else if (declStandalone == 0)
+        decl += " standalone=\"no\"";
+    decl += "?>\n";
+
+    size_t outSize = decl.size() + event.extent.end - event.extent.begin;
+    std::vector<Span>::const_iterator iter;
+    for (iter = flowTags.begin(); iter != flowTags.end(); ++iter)
+        outSize -= iter->end - iter->begin;
+
+    uint8_t *p = new uint8_t[outSize + 1];
+    uint8_t *out = p;
+    memcpy(out, decl.data(), decl.size());
+    out += decl.size();
+    size_t copyPos = event.extent.begin;
+    for (iter = flowTags.begin(); iter != flowTags.end(); ++iter) {
+        memcpy(out, data + copyPos, iter->begin - copyPos);
+        out += iter->begin - copyPos;
+        copyPos = iter->end;
+    }
+    memcpy(out, data + copyPos, event.extent.end - copyPos);
+    p[outSize] = '\0';
+    *buf = p;
+    return outSize;
+}
+
+bool CoTScanner::scanDeclaration()
+{
+    pos = 5;
+    skipWhitespace();
+
+    Span name;
+    Span value;
+    if (!scanName(&name) || !nameEquals(name, "version"))
+        return false;
+    skipWhitespace();
+    if (pos >= len || data[pos] != '=')
+        return false;
+    pos++;
+    skipWhitespace();
+    if (!scanAttributeValue(&value) || value.end - value.begin != 3 ||
+            memcmp(data + value.begin, "1.0", 3) != 0)
+        return false;
+
+    bool ws = skipWhitespace();
+    if (ws && startsWith("encoding")) {
+        if (!scanName(&name) || !nameEquals(name, "encoding"))
+            return false;
+        skipWhitespace();
+        if (pos >= len || data[pos] != '=')
+            return false;
+        pos++;
+        skipWhitespace();
+        if (!scanAttributeValue(&value) || value.end - value.begin != 5 ||
+                strncasecmp(data + value.begin, "utf-8", 5) != 0)
+            return false;
+        declEncoding = value;
+        ws = skipWhitespace();
+    }
+    if (ws && startsWith("standalone")) {
+        if (!scanName(&name) || !nameEquals(name, "standalone"))
+            return false;
+        skipWhitespace();
+        if (pos >= len || data[pos] != '=')
+            return false;
+        pos++;
+        skipWhitespace();
+        if (!scanAttributeValue(&value))
+            return false;
+        Span v = value;
+        if (v.end - v.begin == 3 && memcmp(data + v.begin, "yes", 3) == 0)
+            declStandalone = 1;
+        else if (v.end - v.begin == 2 && memcmp(data + v.begin, "no", 2) == 0)
+            declStandalone = 0;
+        else
+            return false;
+        skipWhitespace();
+    }
+    if (!startsWith("?>"))
+        return false;
+    pos += 2;
+    hasDecl = true;
+    return true;
+}
+
+bool CoTScanner::scanComment()
+{
+    pos += 4;
+    for (; pos + 1 < len; ++pos) {
+        if (data[pos] == '-' && data[pos + 1] == '-') {
+            // "--" may only appear as part of the terminator
+            if (pos + 2 >= len || data[pos + 2] != '>')
+                return false;
+            pos += 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CoTScanner::scanPI()
+{
+    pos += 2;
+    Span target;
+    if (!scanName(&target))
+        return false;
+    if (target.end - target.begin == 3 &&
+            strncasecmp(data + target.begin, "xml", 3) == 0)
+        return false;
+    if (!skipWhitespace() && !startsWith("?>"))
+        return false;
+    for (; pos + 1 < len; ++pos) {
+        if (data[pos] == '?' && data[pos + 1] == '>') {
+            pos += 2;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CoTScanner::scanCData()
+{
+    pos += 9;
+    for (; pos + 2 < len; ++pos) {
+        if (data[pos] == ']' && data[pos + 1] == ']' && data[pos + 2] == '>') {
+            pos += 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CoTScanner::scanText()
+{
+    while (pos < len && data[pos] != '<') {
+        if (data[pos] == '&') {
+            uint32_t c;
+            if (!scanReference(&c))
+                return false;
+        } else if (data[pos] == ']' && startsWith("]]>")) {
+            return false;
+        } else {
+            pos++;
+        }
+    }
+    return true;
+}
+
+bool CoTScanner::scanReference(uint32_t *c)
+{
+    return parseReference(data, len, &pos, c);
+}
+
+bool CoTScanner::scanName(Span *name)
+{
+    if (pos >= len || !isNameStartChar(data[pos]))
+        return false;
+    name->begin = pos;
+    while (pos < len && isNameChar(data[pos]))
+        pos++;
+    name->end = pos;
+
+    // Anything else that may legitimately appear in a name (namespace
+    // prefixes, non-ASCII) is left to the full parser
+    return pos < len && (isWhitespace(data[pos]) || data[pos] == '>' ||
+                         data[pos] == '/' || data[pos] == '=' ||
+                         data[pos] == '?');
+}
+
+bool CoTScanner::scanAttributeValue(Span *value)
+{
+    if (pos >= len || (data[pos] != '"' && data[pos] != '\''))
+        return false;
+    char quote = data[pos++];
+    value->begin = pos;
+    while (pos < len && data[pos] != quote) {
+        if (data[pos] == '<') {
+            return false;
+        } else if (data[pos] == '&') {
+            uint32_t c;
+            if (!scanReference(&c))
+                return false;
+        } else {
+            pos++;
+        }
+    }
+    if (pos >= len)
+        return false;
+    value->end = pos++;
+    return true;
+}
+
+bool CoTScanner::scanStartTag(bool *empty, Span *name,
+                              std::vector<std::pair<Span, Span> > *attrs)
+{
+    pos++;
+    if (!scanName(name))
+        return false;
+
+    while (true) {
+        bool ws = skipWhitespace();
+        if (startsWith("/>")) {
+            pos += 2;
+            *empty = true;
+            return true;
+        }
+        if (pos < len && data[pos] == '>') {
+            pos++;
+            *empty = false;
+            return true;
+        }
+        if (!ws)
+            return false;
+
+        Span attrName;
+        Span attrValue;
+        if (!scanName(&attrName))
+            return false;
+        // Namespace declarations go to the full parser
+        if (attrName.end - attrName.begin >= 5 &&
+                memcmp(data + attrName.begin, "xmlns", 5) == 0)
+            return false;
+        skipWhitespace();
+        if (pos >= len || data[pos] != '=')
+            return false;
+        pos++;
+        skipWhitespace();
+        if (!scanAttributeValue(&attrValue))
+            return false;
+
+        size_t n = attrName.end - attrName.begin;
+        std::vector<std::pair<Span, Span> >::const_iterator iter;
+        for (iter = attrs->begin(); iter != attrs->end(); ++iter) {
+            if (iter->first.end - iter->first.begin == n &&
+                    memcmp(data + iter->first.begin, data + attrName.begin, n) == 0)
+                return false;
+        }
+        attrs->push_back(std::pair<Span, Span>(attrName, attrValue));
+    }
+}
+
+bool CoTScanner::scanEndTag()
+{
+    pos += 2;
+    Span name;
+    if (!scanName(&name))
+        return false;
+    const OpenElement &open = stack.back();
+    size_t n = name.end - name.begin;
+    if (open.name.end - open.name.begin != n ||
+            memcmp(data + open.name.begin, data + name.begin, n) != 0)
+        return false;
+    skipWhitespace();
+    if (pos >= len || data[pos] != '>')
+        return false;
+    pos++;
+
+    if (open.record)
+        open.record->extent.end = pos;
+    if (open.depth == 2 && stack[stack.size() - 2].record == &detail &&
+            nameEquals(open.name, FLOW_TAGS_NAME))
+        flowTags.push_back(Span(open.begin, pos));
+    stack.pop_back();
+    return true;
+}
+
+bool CoTScanner::skipWhitespace()
+{
+    size_t start = pos;
+    while (pos < len && isWhitespace(data[pos]))
+        pos++;
+    return pos != start;
+}
+
+bool CoTScanner::startsWith(const char *s) const
+{
+    size_t n = strlen(s);
+    return len - pos >= n && memcmp(data + pos, s, n) == 0;
+}
+
+bool CoTScanner::nameEquals(const Span &name, const char *s) const
+{
+    size_t n = strlen(s);
+    return name.end - name.begin == n && memcmp(data + name.begin, s, n) == 0;
+}
+
+CoTScanner::Element *CoTScanner::recordFor(const Span &name)
+{
+    const Element *parent = stack.back().record;
+    Element *ret = NULL;
+    if (parent == &event) {
+        if (nameEquals(name, "point"))
+            ret = &point;
+        else if (nameEquals(name, "detail"))
+            ret = &detail;
+    } else if (parent == &detail) {
+        if (nameEquals(name, "contact"))
+            ret = &contact;
+        else if (nameEquals(name, "fileshare"))
+            ret = &fileShare;
+        else if (nameEquals(name, "ackrequest"))
+            ret = &ackRequest;
+        else if (nameEquals(name, "ackresponse"))
+            ret = &ackResponse;
+        else if (nameEquals(name, "__chat"))
+            ret = &chat;
+        else if (nameEquals(name, "TakControl"))
+            ret = &takControl;
+    } else if (parent == &takControl) {
+        if (nameEquals(name, "TakProtocolSupport")) {
+            takProtocolSupport.push_back(Element());
+            return &takProtocolSupport.back();
+        } else if (nameEquals(name, "TakCompressionSupport")) {
+            takCompressionSupport.push_back(Element());
+            return &takCompressionSupport.back();
+        } else if (nameEquals(name, "TakResponse")) {
+            ret = &takResponse;
+        }
+    }
+
+    // Only the first occurrence of each is of interest
+    if (ret && ret->present)
+        ret = NULL;
+    return ret;
+}
@@ -0,0 +1,128 @@
+#ifndef IMPL_COTSCANNER_H_
+#define IMPL_COTSCANNER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace atakmap {
+namespace commoncommo {
+namespace impl
+{
+
+// Single forward pass over a serialized CoT event that records where
+// the elements commo itself looks at live in the source buffer, without
+// building a document tree.  Only offsets into the scanned buffer are
+// kept; attribute values are decoded (and thus copied) when read.
+//
+// Only a conservative subset of XML is accepted: UTF-8 only, no DTD,
+// no namespace prefixes and nothing but whitespace around the root
+// element.  Anything outside of that subset, malformed input included,
+// causes scan() to return false; callers are expected to fall back
+// to a full parser, which then has the final say on validity.
+class CoTScanner
+{
+public:
+    struct Span {
+        size_t begin;
+        size_t end;
+
+        Span() : begin(0), end(0) {}
+        Span(size_t begin, size_t end) : begin(begin), end(end) {}
+    };
+
+    struct Element {
+        bool present;
+        // Start of the start tag through the end of the end tag
+        Span extent;
+        // Name and raw (undecoded, unquoted) value of each attribute
+        std::vector<std::pair<Span, Span> > attributes;
+
+        Element() : present(false), extent(), attributes() {}
+    };
+
+    // The root <event> and its first <point> and <detail> children
+    Element event;
+    Element point;
+    Element detail;
+
+    // First occurrence of each of these directly under the first <detail>
+    Element contact;
+    Element fileShare;
+    Element ackRequest;
+    Element ackResponse;
+    Element chat;
+    Element takControl;
+
+    // Children of takControl: every <TakProtocolSupport>, every
+    // <TakCompressionSupport>, first <TakResponse>
+    std::vector<Element> takProtocolSupport;
+    std::vector<Element> takCompressionSupport;
+    Element takResponse;
+
+    // Every <_flow-tags_> element directly under the first <detail>
+    std::vector<Span> flowTags;
+
+    CoTScanner();
+
+    // Scans len bytes at data, replacing any prior results.
+    // Returns false if the input is not (or may not be) well formed
+    // within the subset of XML described above.
+    bool scan(const char *data, size_t len);
+
+    // Looks up the named attribute of e, which must come from the last
+    // scan of data.  If found, the decoded value is stored in value
+    // and true is returned.
+    bool getAttribute(const char *data, const Element &e,
+                      const char *name, std::string *value) const;
+
+    // Produces the equivalent of the scanned document as serialized by
+    // libxml2: the XML declaration, a newline, then the root element,
+    // less any flow tags.  No trailing newline is written.
+    // The returned buffer is allocated with new[] and nul terminated;
+    // the return value is its length, excluding the terminator.
+    size_t serialize(const char *data, uint8_t **buf) const;
+
+private:
+    struct OpenElement {
+        Span name;
+        Element *record;
+        size_t begin;
+        int depth;
+    };
+
+    // Declaration, as found in the source
+    bool hasDecl;
+    Span declEncoding;
+    int declStandalone;
+
+    const char *data;
+    size_t len;
+    size_t pos;
+    std::vector<OpenElement> stack;
+
+    void reset();
+    bool scanDeclaration();
+    bool scanComment();
+    bool scanPI();
+    bool scanCData();
+    bool scanText();
+    bool scanReference(uint32_t *c);
+    bool scanName(Span *name);
+    bool scanAttributeValue(Span *value);
+    bool scanStartTag(bool *empty, Span *name,
+                      std::vector<std::pair<Span, Span> > *attrs);
+    bool scanEndTag();
+    bool skipWhitespace();
+    bool startsWith(const char *s) const;
+    bool nameEquals(const Span &name, const char *s) const;
+    Element *recordFor(const Span &name);
+};
+
+}
+}
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "commologger.h"
 #include "datagramsocketmanagement.h"
 #include "internalutils.h"
+#include "duplicatefilter.h"
 #include <RWMutex.h>
 #include <Lock.h>
 #include <string.h>
@@ -9,6 +10,13 @@ using namespace atakmap::commoncommo;
 using namespace atakmap::commoncommo::impl;
 
 namespace {
+    // Most datagrams read from a socket per receive call
+    const size_t RX_BATCH_SIZE = 16;
+    // Byte-identical CoT datagrams received within this many seconds of
+    // each other (e.g. the same multicast on several interfaces)
+    // are processed only once
+    const float RX_DUPLICATE_WINDOW_SECONDS = 1.0f;
+    const size_t RX_DUPLICATE_CAPACITY = 4096;
     // Controls how long we let an RX socket persist without seeing data come
     // in.
     const int DEFAULT_RX_NO_DATA_REBUILD_TIME = 30;
@@ -43,11 +51,14 @@ namespace {
 
 DatagramSocketManagement::DatagramSocketManagement(CommoLogger *logger,
         ContactUID *ourUid,
-        HWIFScanner *scanner) :
+        HWIFScanner *scanner,
+        MetricsRegistry *metrics) :
         HWIFScannerListener(), ThreadedHandler(3, THREAD_NAMES),
         logger(logger),
         ourUid(ourUid),
         scanner(scanner),
+        metrics(metrics),
+        txMetrics(metrics->getEndpoint(MetricsRegistry::DATAGRAM_TX_ENDPOINT)),
         unicastBroadcastContexts(),
         interfaceContexts(),
         socketContexts(),
@@ -90,11 +101,8 @@ DatagramSocketManagement::~DatagramSocketManagement()
         rxQueue.pop_back();
         rxi.implode();
     }
-    while (!txQueue.empty()) {
-        TxQueueItem txi = txQueue.back();
-        txQueue.pop_back();
-        txi.implode();
-    }
+    while (!txQueue.empty())
+        txQueue.pop().implode();
     InterfaceMap::iterator iter;
     for (iter = interfaceContexts.begin(); iter != interfaceContexts.end(); ++iter) {
         delete iter->second;
@@ -177,6 +185,21 @@ void DatagramSocketManagement::setRxTimeoutSecs(int seconds)
     }
 }
 
+void DatagramSocketManagement::getQueueDepths(size_t *rxDepth,
+                                              size_t *txDepth)
+{
+    {
+        PGSC::Thread::LockPtr lock(NULL, NULL);
+        PGSC::Thread::Lock_create(lock, rxQueueMutex);
+        *rxDepth = rxQueue.size();
+    }
+    {
+        PGSC::Thread::LockPtr lock(NULL, NULL);
+        PGSC::Thread::Lock_create(lock, txQueueMutex);
+        *txDepth = txQueue.size();
+    }
+}
+
 
 void DatagramSocketManagement::setTTL(int ttl)
 {
@@ -326,7 +349,7 @@ bool DatagramSocketManagement::getOrAllocSocketContext(int port, bool forGeneric
     SharedSocketMap::iterator iter = socketContexts.find(port);
     bool isNewCtx;
     if (iter == socketContexts.end()) {
-        *ctx = new SharedSocketContext(port, forGeneric);
+        *ctx = new SharedSocketContext(port, forGeneric, metrics);
         isNewCtx = true;
     } else {
         *ctx = iter->second;
@@ -558,7 +581,8 @@ void DatagramSocketManagement::sendDatagram(
 {
     PGSC::Thread::LockPtr qlock(NULL, NULL);
     PGSC::Thread::Lock_create(qlock, txQueueMutex);
-    txQueue.push_front(TxQueueItem(dest, msg, protoVersion));
+    txQueue.push(TxQueueItem(dest, msg, protoVersion), txPriorityFor(msg),
+                 std::string(), NULL);
     txQueueMonitor.broadcast(*qlock);
 }
 
@@ -566,7 +590,11 @@ void DatagramSocketManagement::sendMulticast(const CoTMessage *msg) COMMO_THROW
 {
     PGSC::Thread::LockPtr qlock(NULL, NULL);
     PGSC::Thread::Lock_create(qlock, txQueueMutex);
-    txQueue.push_front(TxQueueItem(msg));
+    // A newer position update obsoletes one still queued
+    TxQueueItem replaced;
+    if (txQueue.push(TxQueueItem(msg), txPriorityFor(msg),
+                     txStaleKeyFor(msg), &replaced))
+        replaced.implode();
     txQueueMonitor.broadcast(*qlock);
 }
 
@@ -670,7 +698,11 @@ void DatagramSocketManagement::recvThreadProcess()
     NetAddress *wildcardAddr = NetAddress::createWildcard(NA_TYPE_INET4);
     std::vector<SharedSocketContext *> rxCtxList;
     const size_t rxBufLen0 = maxUDPMessageSize;
-    uint8_t rxBuf[rxBufLen0];
+    // Ring of receive buffers, reused for each batch of datagrams
+    std::vector<uint8_t> rxRing(rxBufLen0 * RX_BATCH_SIZE);
+    uint8_t *rxBufs[RX_BATCH_SIZE];
+    for (size_t i = 0; i < RX_BATCH_SIZE; ++i)
+        rxBufs[i] = &rxRing[i * rxBufLen0];
     int rebuildTimeoutSecs;
 
     while (!threadShouldStop(RX_THREADID)) {
@@ -798,21 +830,27 @@ void DatagramSocketManagement::recvThreadProcess()
                 int count = 0;
                 try {
                     do {
-                        size_t len = rxBufLen0;
-                        NetAddress *rxAddr;
+                        size_t lens[RX_BATCH_SIZE];
+                        NetAddress *rxAddrs[RX_BATCH_SIZE];
+                        size_t n = RX_BATCH_SIZE;
+                        for (size_t i = 0; i < n; ++i)
+                            lens[i] = rxBufLen0;
 
                         // Read until error or would block
-                        rxCtx->socket->recvfrom(&rxAddr, rxBuf, &len);
-                        count++;
+                        rxCtx->socket->recvfromMulti(rxAddrs, rxBufs, lens, &n);
+                        count += (int)n;
+                        for (size_t i = 0; i < n; ++i)
+                            rxCtx->metrics->addRx(lens[i]);
 
                         // Now push on to queue
                         {
                             PGSC::Thread::LockPtr qLock(NULL, NULL);
                             PGSC::Thread::Lock_create(qLock, rxQueueMutex);
-                            rxQueue.push_front(RxQueueItem(rxAddr, 
+                            for (size_t i = 0; i < n; ++i)
+                                rxQueue.push_front(RxQueueItem(rxAddrs[i],
                                                            rxCtx->endpointStr,
                                                            rxCtx->generic, 
-                                                           rxBuf, len));
+                                                           rxBufs[i], lens[i]));
                             rxQueueMonitor.broadcast(*qLock);
                         }
                     } while (true);
@@ -842,6 +880,9 @@ void DatagramSocketManagement::recvThreadProcess()
 
 void DatagramSocketManagement::recvQueueThreadProcess()
 {
+    DuplicateFilter dupFilter(RX_DUPLICATE_WINDOW_SECONDS,
+                              RX_DUPLICATE_CAPACITY);
+
     while (!threadShouldStop(RX_QUEUE_THREADID)) {
         PGSC::Thread::LockPtr qLock(NULL, NULL);
         PGSC::Thread::Lock_create(qLock, rxQueueMutex);
@@ -860,6 +901,9 @@ void DatagramSocketManagement::recvQueueThreadProcess()
                 DatagramListener *l = *iter;
                 l->datagramReceivedGeneric(&qItem.endpointId, qItem.data, qItem.dataLen);
             }
+        } else if (dupFilter.isDuplicate(qItem.data, qItem.dataLen,
+                                         CommoTime::now())) {
+            // Already handled a copy of this one; skip decrypt and decode
         } else {
 
             bool decrypted = false;
@@ -882,6 +926,7 @@ void DatagramSocketManagement::recvQueueThreadProcess()
             } catch (std::invalid_argument &e) {
                 // Drop this item
                 InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR, "Invalid CoT Message received; dropping (%s)", e.what());
+                metrics->getEndpoint(qItem.endpointId)->rxParseFailures++;
             }
             if (decrypted)
                 delete[] data;
@@ -948,7 +993,8 @@ void DatagramSocketManagement::outQueueThreadProcess()
             }
             
             if (!wakeMillis) {
-                txQueue.push_front(TxQueueItem());
+                txQueue.push(TxQueueItem(), TX_PRIORITY_NORMAL, std::string(),
+                             NULL);
             } else if (txQueue.empty()) {
                 txQueueMonitor.wait(*qLock, wakeMillis);
                 continue;
@@ -968,8 +1014,7 @@ void DatagramSocketManagement::outQueueThreadProcess()
                     PGSC::Thread::Lock_create(qLock, txQueueMutex);
                     if (txQueue.empty())
                         continue;
-                    qitem = txQueue.back();
-                    txQueue.pop_back();
+                    qitem = txQueue.pop();
                     localTTL = ttl;
                     localProtoVersion = protoVersion;
                 }
@@ -1128,29 +1173,46 @@ void DatagramSocketManagement::outQueueThreadProcess()
                     delete[] origData;
                 }
 
-                std::vector<NetAddress *>::iterator addrIter;
-                for (addrIter = iter->second.dests.begin(); addrIter != iter->second.dests.end(); ++addrIter) {
-                    UdpSocket **sock = iter->first ? &iter->first->outboundSocket : &txSocket;
-                    try {
-                        if (iter->first && !magtabEnabled) {
-                            (*sock)->multicastto(*addrIter, data, s, localTTL);
+                // Send to the destinations in batches
+                UdpSocket **sock = iter->first ? &iter->first->outboundSocket : &txSocket;
+                const bool magtab = magtabEnabled && iter->first;
+                const std::vector<NetAddress *> &dests = iter->second.dests;
+                const NetAddress *batch[PlatformNet::DATAGRAM_BATCH_MAX];
+                NetAddress *mtAddrs[PlatformNet::DATAGRAM_BATCH_MAX];
+                size_t i = 0;
+                while (i < dests.size()) {
+                    size_t n = dests.size() - i;
+                    if (n > PlatformNet::DATAGRAM_BATCH_MAX)
+                        n = PlatformNet::DATAGRAM_BATCH_MAX;
+                    for (size_t j = 0; j < n; ++j) {
+                        if (magtab) {
+                            mtAddrs[j] = dests[i + j]->deriveMagtabAddress();
+                            batch[j] = mtAddrs[j];
                         } else {
-                            if (magtabEnabled && iter->first) {
-                                NetAddress *addr = *addrIter;
-                                NetAddress *mtAddr = addr->deriveMagtabAddress();
-                                (*sock)->sendto(mtAddr, data, s);
-                                delete mtAddr;
-                            
-                            } else {
-                                (*sock)->sendto(*addrIter, data, s);
-                            }
+                            batch[j] = dests[i + j];
                         }
+                    }
+                    i += n;
+
+                    bool sendOk = true;
+                    try {
+                        if (iter->first && !magtabEnabled)
+                            (*sock)->multicasttoMulti(batch, n, data, s, localTTL);
+                        else
+                            (*sock)->sendtoMulti(batch, n, data, s);
+                        txMetrics->addTx(n, n * s);
                     } catch (SocketException &) {
                         logger->log(CommoLogger::LEVEL_ERROR, "Socket error sending UDP message");
                         delete *sock;
                         *sock = NULL;
-                        break;
+                        sendOk = false;
                     }
+                    if (magtab) {
+                        for (size_t j = 0; j < n; ++j)
+                            delete mtAddrs[j];
+                    }
+                    if (!sendOk)
+                        break;
                 }
                 delete[] data;
             }
@@ -1322,14 +1384,16 @@ DatagramSocketManagement::InterfaceContext::~InterfaceContext()
 }
 
 DatagramSocketManagement::SharedSocketContext::SharedSocketContext(int port,
-                                                    bool generic) :
+                                                    bool generic,
+                                                    MetricsRegistry *metrics) :
         joinedAddrs(), pendingAddrs(), socket(NULL),
         lastRxTime(CommoTime::ZERO_TIME), endpointStr(),
-        port(port), generic(generic)
+        port(port), generic(generic), metrics(NULL)
 {
     endpointStr = "*:";
     endpointStr += InternalUtils::intToString(port);
     endpointStr += ":udp";
+    this->metrics = metrics->getEndpoint(endpointStr);
 }
 DatagramSocketManagement::SharedSocketContext::~SharedSocketContext()
 {
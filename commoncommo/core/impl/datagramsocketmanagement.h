@@ -10,6 +10,8 @@
 #include "commoresult.h"
 #include "commotime.h"
 #include "cryptoutil.h"
+#include "metricsregistry.h"
+#include "txpriorityqueue.h"
 #include <set>
 #include <map>
 #include <deque>
@@ -42,7 +44,8 @@ class DatagramSocketManagement : public HWIFScannerListener,
                                  public ThreadedHandler
 {
 public:
-    DatagramSocketManagement(CommoLogger *logger, ContactUID *ourUid, HWIFScanner *scanner);
+    DatagramSocketManagement(CommoLogger *logger, ContactUID *ourUid,
+                             HWIFScanner *scanner, MetricsRegistry *metrics);
     virtual ~DatagramSocketManagement();
 
 
@@ -84,6 +87,9 @@ public:
     // 0 for "never timeout and issue rejoins"
     void setRxTimeoutSecs(int seconds);
 
+    // Current number of items in the rx and tx queues
+    void getQueueDepths(size_t *rxDepth, size_t *txDepth);
+
 
 protected:
     // ThreadedHandler impl
@@ -162,8 +168,9 @@ private:
         std::string endpointStr;
         const int port;
         const bool generic;
+        MetricsRegistry::EndpointCounters *metrics;
 
-        SharedSocketContext(int port, bool generic);
+        SharedSocketContext(int port, bool generic, MetricsRegistry *metrics);
         ~SharedSocketContext();
     private:
         COMMO_DISALLOW_COPY(SharedSocketContext);
@@ -207,6 +214,8 @@ private:
     CommoLogger *logger;
     ContactUID *ourUid;
     HWIFScanner *scanner;
+    MetricsRegistry *metrics;
+    MetricsRegistry::EndpointCounters *txMetrics;
 
     typedef std::map<const HwAddress *, InterfaceContext *, HwComp> InterfaceMap;
     typedef std::map<int, SharedSocketContext *> SharedSocketMap;
@@ -241,7 +250,7 @@ private:
     PGSC::Thread::CondVar rxQueueMonitor;
 
     // TX Queue - new items on front
-    std::deque<TxQueueItem> txQueue;
+    TxPriorityQueue<TxQueueItem> txQueue;
     PGSC::Thread::Mutex txQueueMutex;
     PGSC::Thread::CondVar txQueueMonitor;
 
@@ -0,0 +1,77 @@
+#include "duplicatefilter.h"
+#include <algorithm>
+
+using namespace atakmap::commoncommo;
+using namespace atakmap::commoncommo::impl;
+
+
+namespace {
+    // FNV-1a; 0 is reserved to mark empty slots
+    uint64_t hashBytes(const uint8_t *data, size_t len)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for (size_t i = 0; i < len; ++i) {
+            h ^= data[i];
+            h *= 1099511628211ULL;
+        }
+        return h ? h : 1;
+    }
+}
+
+
+DuplicateFilter::DuplicateFilter(float windowSeconds, size_t capacity) :
+        windowSeconds(windowSeconds), mask(0), generations(), current(0),
+        generationStart(CommoTime::now())
+{
+    size_t n = 1;
+    while (n < capacity)
+        n <<= 1;
+    mask = n - 1;
+    generations[0].resize(n, 0);
+    generations[1].resize(n, 0);
+}
+
+bool DuplicateFilter::isDuplicate(const uint8_t *data, size_t len,
+                                  const CommoTime &now)
+{
+    if (now.minus(generationStart) >= windowSeconds || now < generationStart) {
+        // Retire the older generation and start filling it anew
+        current ^= 1;
+        std::fill(generations[current].begin(), generations[current].end(), 0);
+        generationStart = now;
+    }
+
+    uint64_t hash = hashBytes(data, len);
+    if (contains(generations[current], hash) ||
+            contains(generations[current ^ 1], hash))
+        return true;
+
+    insert(generations[current], hash);
+    return false;
+}
+
+bool DuplicateFilter::contains(const std::vector<uint64_t> &gen,
+                               uint64_t hash) const
+{
+    for (size_t i = 0; i < MAX_PROBES; ++i) {
+        uint64_t v = gen[(hash + i) & mask];
+        if (v == hash)
+            return true;
+        if (!v)
+            return false;
+    }
+    return false;
+}
+
+void DuplicateFilter::insert(std::vector<uint64_t> &gen, uint64_t hash)
+{
+    for (size_t i = 0; i < MAX_PROBES; ++i) {
+        uint64_t &v = gen[(hash + i) & mask];
+        if (!v) {
+            v = hash;
+            return;
+        }
+    }
+    // Neighbourhood is full; give up whatever sits in the home slot
+    gen[hash & mask] = hash;
+}
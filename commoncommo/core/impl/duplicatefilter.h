@@ -0,0 +1,50 @@
+#ifndef IMPL_DUPLICATEFILTER_H_
+#define IMPL_DUPLICATEFILTER_H_
+
+#include "commotime.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace atakmap {
+namespace commoncommo {
+namespace impl
+{
+
+// Remembers a hash of each message seen over a short window so that
+// further byte-identical copies (the same multicast arriving on several
+// interfaces, for example) can be dropped before they are decrypted
+// and decoded.
+// Hashes are kept in two fixed-size generations; the older generation
+// is discarded each time a window elapses, so a message is remembered
+// for between one and two windows.  Lookups never allocate.
+// Not thread safe; intended for use by a single receiving thread.
+class DuplicateFilter
+{
+public:
+    // capacity is the number of hashes held per generation and is
+    // rounded up to a power of two
+    DuplicateFilter(float windowSeconds, size_t capacity);
+
+    // Returns true if an identical message was seen within the window.
+    // Otherwise records this one and returns false.
+    bool isDuplicate(const uint8_t *data, size_t len, const CommoTime &now);
+
+private:
+    static const size_t MAX_PROBES = 8;
+
+    const float windowSeconds;
+    size_t mask;
+    std::vector<uint64_t> generations[2];
+    size_t current;
+    CommoTime generationStart;
+
+    bool contains(const std::vector<uint64_t> &gen, uint64_t hash) const;
+    void insert(std::vector<uint64_t> &gen, uint64_t hash);
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "metricsregistry.h"
+
+#include <Lock.h>
+#include <string.h>
+
+using namespace atakmap::commoncommo;
+using namespace atakmap::commoncommo::impl;
+
+
+namespace {
+    uint64_t elapsedMillis(const CommoTime &start, const CommoTime &end)
+    {
+        // Subtraction clamps at zero if the clock stepped backwards
+        CommoTime d = end - start;
+        return (uint64_t)d.getSeconds() * 1000 + d.getMillis();
+    }
+}
+
+
+const char * const MetricsRegistry::DATAGRAM_TX_ENDPOINT = "*:*:udp";
+const char * const MetricsRegistry::TCP_TX_ENDPOINT = "*:*:tcp";
+
+
+MetricsRegistry::MetricsRegistry() : endpoints(), endpointsMutex(),
+        dispatchedMessages(0), dispatchLatencyTotalMillis(0),
+        dispatchLatencyMaxMillis(0)
+{
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    EndpointMap::iterator iter;
+    for (iter = endpoints.begin(); iter != endpoints.end(); ++iter)
+        delete iter->second;
+}
+
+MetricsRegistry::EndpointCounters *MetricsRegistry::getEndpoint(
+        const std::string &endpointId)
+{
+    PGSC::Thread::LockPtr lock(NULL, NULL);
+    PGSC::Thread::Lock_create(lock, endpointsMutex);
+    EndpointMap::iterator iter = endpoints.find(endpointId);
+    if (iter != endpoints.end())
+        return iter->second;
+    EndpointCounters *ret = new EndpointCounters();
+    endpoints[endpointId] = ret;
+    return ret;
+}
+
+void MetricsRegistry::addDispatch(const CommoTime &queuedTime,
+                                  const CommoTime &now)
+{
+    uint64_t ms = elapsedMillis(queuedTime, now);
+    dispatchedMessages++;
+    dispatchLatencyTotalMillis += ms;
+    uint64_t max = dispatchLatencyMaxMillis.load();
+    while (ms > max && !dispatchLatencyMaxMillis.compare_exchange_weak(max, ms))
+        ;
+}
+
+CommoMetrics *MetricsRegistry::snapshot(
+        const std::map<std::string, size_t> &txQueueDepths)
+{
+    CommoMetrics *ret = new CommoMetrics();
+    ret->dispatchedMessages = dispatchedMessages;
+    ret->dispatchLatencyTotalMillis = dispatchLatencyTotalMillis;
+    ret->dispatchLatencyMaxMillis = dispatchLatencyMaxMillis;
+
+    PGSC::Thread::LockPtr lock(NULL, NULL);
+    PGSC::Thread::Lock_create(lock, endpointsMutex);
+    EndpointMetrics *eps = new EndpointMetrics[endpoints.size()];
+    size_t i = 0;
+    EndpointMap::iterator iter;
+    for (iter = endpoints.begin(); iter != endpoints.end(); ++iter, ++i) {
+        const EndpointCounters *c = iter->second;
+        EndpointMetrics *m = eps + i;
+
+        char *id = new char[iter->first.length() + 1];
+        strcpy(id, iter->first.c_str());
+        m->endpointId = id;
+        m->rxMessages = c->rxMessages;
+        m->rxBytes = c->rxBytes;
+        m->txMessages = c->txMessages;
+        m->txBytes = c->txBytes;
+        m->rxParseFailures = c->rxParseFailures;
+        uint64_t connects = c->connects;
+        m->reconnects = connects ? connects - 1 : 0;
+        m->tlsHandshakes = c->tlsHandshakes;
+        m->tlsHandshakeLastMillis = c->tlsHandshakeLastMillis;
+        m->tlsHandshakeTotalMillis = c->tlsHandshakeTotalMillis;
+
+        std::map<std::string, size_t>::const_iterator depthIter =
+                txQueueDepths.find(iter->first);
+        m->txQueueDepth = depthIter == txQueueDepths.end() ? 0 :
+                                                          depthIter->second;
+    }
+    ret->nEndpoints = endpoints.size();
+    ret->endpoints = eps;
+    return ret;
+}
+
+void MetricsRegistry::freeMetrics(const CommoMetrics *metrics)
+{
+    for (size_t i = 0; i < metrics->nEndpoints; ++i)
+        delete[] metrics->endpoints[i].endpointId;
+    delete[] metrics->endpoints;
+    delete metrics;
+}
+
+
+MetricsRegistry::EndpointCounters::EndpointCounters() :
+        rxMessages(0), rxBytes(0), txMessages(0), txBytes(0),
+        rxParseFailures(0), connects(0), tlsHandshakes(0),
+        tlsHandshakeLastMillis(0), tlsHandshakeTotalMillis(0)
+{
+}
+
+void MetricsRegistry::EndpointCounters::addRx(size_t bytes)
+{
+    rxMessages++;
+    rxBytes += bytes;
+}
+
+void MetricsRegistry::EndpointCounters::addTx(size_t nMessages, size_t bytes)
+{
+    txMessages += nMessages;
+    txBytes += bytes;
+}
+
+void MetricsRegistry::EndpointCounters::addTlsHandshake(
+        const CommoTime &start, const CommoTime &end)
+{
+    uint64_t ms = elapsedMillis(start, end);
+    tlsHandshakes++;
+    tlsHandshakeLastMillis = ms;
+    tlsHandshakeTotalMillis += ms;
+}
@@ -0,0 +1,84 @@
+#ifndef IMPL_METRICSREGISTRY_H_
+#define IMPL_METRICSREGISTRY_H_
+
+#include "commometrics.h"
+#include "commotime.h"
+
+#include <Mutex.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+
+namespace atakmap {
+namespace commoncommo {
+namespace impl
+{
+
+// Runtime counters shared by the network managers and reported through
+// Commo::getMetrics().  Looking up an endpoint takes a lock, so callers
+// on i/o paths should look it up once and keep the returned pointer;
+// updating counters never locks.
+class MetricsRegistry
+{
+public:
+    // Endpoint ids for outbound mesh traffic
+    static const char * const DATAGRAM_TX_ENDPOINT;
+    static const char * const TCP_TX_ENDPOINT;
+
+    struct EndpointCounters
+    {
+        std::atomic<uint64_t> rxMessages;
+        std::atomic<uint64_t> rxBytes;
+        std::atomic<uint64_t> txMessages;
+        std::atomic<uint64_t> txBytes;
+        std::atomic<uint64_t> rxParseFailures;
+        std::atomic<uint64_t> connects;
+        std::atomic<uint64_t> tlsHandshakes;
+        std::atomic<uint64_t> tlsHandshakeLastMillis;
+        std::atomic<uint64_t> tlsHandshakeTotalMillis;
+
+        EndpointCounters();
+
+        void addRx(size_t bytes);
+        void addTx(size_t nMessages, size_t bytes);
+        void addTlsHandshake(const CommoTime &start, const CommoTime &end);
+    private:
+        COMMO_DISALLOW_COPY(EndpointCounters);
+    };
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    // Returns the counters for the given endpoint, creating them on
+    // first use.  The counters remain valid for the life of the registry.
+    EndpointCounters *getEndpoint(const std::string &endpointId);
+
+    // Records a message handed to listeners after waiting in the
+    // dispatch queue since queuedTime
+    void addDispatch(const CommoTime &queuedTime, const CommoTime &now);
+
+    // Returns a new CommoMetrics holding the current counter values.
+    // txQueueDepths gives the tx queue depth by endpoint id; the
+    // queue depth gauges are left zero for the caller to fill in.
+    // Free with freeMetrics().
+    CommoMetrics *snapshot(const std::map<std::string, size_t> &txQueueDepths);
+    static void freeMetrics(const CommoMetrics *metrics);
+
+private:
+    COMMO_DISALLOW_COPY(MetricsRegistry);
+
+    typedef std::map<std::string, EndpointCounters *> EndpointMap;
+    EndpointMap endpoints;
+    PGSC::Thread::Mutex endpointsMutex;
+
+    std::atomic<uint64_t> dispatchedMessages;
+    std::atomic<uint64_t> dispatchLatencyTotalMillis;
+    std::atomic<uint64_t> dispatchLatencyMaxMillis;
+};
+
+}
+}
+}
+
+#endif /* IMPL_METRICSREGISTRY_H_ */
@@ -4,6 +4,8 @@
 #include <utility>
 #include <sstream>
 #include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
 #include <memory>
 
 using namespace atakmap::commoncommo;
@@ -30,6 +32,18 @@ namespace {
     // Seconds before a fail transfer is retried
     const float RETRY_SECONDS = 10.0f;
 
+    // Case-insensitive comparison of hex hash strings
+    bool hashEquals(const std::string &a, const std::string &b)
+    {
+        if (a.length() != b.length())
+            return false;
+        for (size_t i = 0; i < a.length(); ++i) {
+            if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+                return false;
+        }
+        return true;
+    }
+
     struct WebserverFileContext{
         FileHandle* handle;
         std::shared_ptr<FileIOProvider> provider;
@@ -1422,12 +1436,29 @@ size_t MissionPackageManager::curlWriteCallback(char *buf, size_t size, size_t n
 {
     FileTransferContext *ftc = (FileTransferContext *)userCtx;
     if (!ftc->outputFile) {
-        ftc->outputFile = ftc->provider->open(ftc->localFilename.c_str(), "wb");
+        long httpRc = 0;
+        curl_easy_getinfo(ftc->curlCtx, CURLINFO_RESPONSE_CODE, &httpRc);
+        if (httpRc != 200 && httpRc != 206)
+            // Error body; don't let it clobber what we have so far.
+            // The transfer is failed on completion.
+            return nmemb * size;
+
+        const char *mode = "wb";
+        if (ftc->resumeOffset && httpRc == 206) {
+            mode = "ab";
+            ftc->resumed = true;
+        } else {
+            // Server is sending the whole thing (again)
+            ftc->resumeOffset = 0;
+        }
+        ftc->bytesOnDisk = ftc->resumeOffset;
+        ftc->outputFile = ftc->provider->open(ftc->localFilename.c_str(), mode);
         if (!ftc->outputFile)
             return 0;
     }
 
     size_t n = ftc->provider->write(buf, size, nmemb, ftc->outputFile);
+    ftc->bytesOnDisk += n * size;
     if (n != nmemb)
         return 0;
     return nmemb * size;
@@ -1442,7 +1473,7 @@ CURLcode MissionPackageManager::curlXferCallback(void *privData,
     MissionPackageManager::FileTransferContext *ftc =
             (MissionPackageManager::FileTransferContext *)privData;
     uint64_t oldVal = ftc->bytesTransferred;
-    ftc->bytesTransferred = dlNow;
+    ftc->bytesTransferred = ftc->resumeOffset + dlNow;
 
     // Queue an update if #'s changed
     if (ftc->bytesTransferred != oldVal) {
@@ -1628,7 +1659,12 @@ void MissionPackageManager::receiveThreadProcess()
                             ftc->settings.getNumTries());
 
             ftc->curlCtx = curl_easy_init();
-            ftc->bytesTransferred = 0;
+            // Pick up where any earlier attempt left off
+            ftc->resumeOffset = ftc->bytesOnDisk;
+            if (ftc->request->sizeInBytes &&
+                    ftc->resumeOffset >= ftc->request->sizeInBytes)
+                ftc->resumeOffset = 0;
+            ftc->bytesTransferred = ftc->resumeOffset;
 
             queueRxEvent(ftc, MP_TRANSFER_ATTEMPT_IN_PROGRESS,
                          NULL);
@@ -1655,6 +1691,13 @@ void MissionPackageManager::receiveThreadProcess()
             curl_easy_setopt(ftc->curlCtx, CURLOPT_XFERINFODATA,
                                         ftc);
             curl_easy_setopt(ftc->curlCtx, CURLOPT_NOPROGRESS, 0L);
+            if (ftc->resumeOffset) {
+                InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG,
+                            "Resuming download of %s at byte %" PRIu64,
+                            ftc->request->name.c_str(), ftc->resumeOffset);
+                curl_easy_setopt(ftc->curlCtx, CURLOPT_RESUME_FROM_LARGE,
+                                 (curl_off_t)ftc->resumeOffset);
+            }
             ftc->curlErrBuf[0] = 0;
 
             if (url.length() > 6 && url.substr(0, 6) == "https:") {
@@ -1742,7 +1785,8 @@ void MissionPackageManager::receiveThreadProcess()
                     long httpRc;
                     curl_easy_getinfo(easyHandle, CURLINFO_RESPONSE_CODE, &httpRc);
 
-                    if (httpRc != 200) {
+                    std::string hash;
+                    if (httpRc != 200 && (httpRc != 206 || !ftc->resumeOffset)) {
                         InternalUtils::logprintf(logger, 
                                         CommoLogger::LEVEL_DEBUG, 
                                         "Download of %s from %s "
@@ -1753,6 +1797,21 @@ void MissionPackageManager::receiveThreadProcess()
                                         httpRc);
                         errorDetail = "Received unexpected http response code";
 
+                    } else if (ftc->resumed && !ftc->request->sha256hash.empty() &&
+                            (!InternalUtils::computeSha256Hash(&hash,
+                                    ftc->localFilename.c_str(), ftc->provider) ||
+                             !hashEquals(hash, ftc->request->sha256hash))) {
+                        InternalUtils::logprintf(logger, 
+                                        CommoLogger::LEVEL_DEBUG, 
+                                        "Download of %s from %s "
+                                        "failed; resumed file does not match "
+                                        "sender's hash, will start over",
+                                        ftc->request->name.c_str(),
+                                        ftc->request->senderCallsign.c_str());
+                        errorDetail = "Resumed transfer failed hash verification";
+                        ftc->bytesOnDisk = 0;
+                        ftc->resumed = false;
+
                     } else {
                         static const char successMsg[] = "File transferred successfully";
                         InternalUtils::logprintf(logger, 
@@ -2070,7 +2129,8 @@ MissionPackageManager::FileTransferContext::FileTransferContext(
                 adjustedSenderUrl(request->senderUrl),
                 usingSenderURL(true), senderURLIsTAKServer(false),
                 nextRetryTime(CommoTime::ZERO_TIME),
-                currentRetryCount(1), bytesTransferred(0), outputFile(NULL),
+                currentRetryCount(1), bytesTransferred(0), bytesOnDisk(0),
+                resumeOffset(0), resumed(false), outputFile(NULL),
                 provider(provider)
 {
     if (request->peerHosted && request->httpsPort != MP_LOCAL_PORT_DISABLE) {
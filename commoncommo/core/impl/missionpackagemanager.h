@@ -304,6 +304,16 @@ private:
         
         uint64_t bytesTransferred;
 
+        // Bytes of the file at localFilename received intact so far,
+        // across all attempts
+        uint64_t bytesOnDisk;
+        // Offset the current attempt asked the server to resume from;
+        // zero if the current attempt is fetching the whole file
+        uint64_t resumeOffset;
+        // True if the file on disk was assembled from more than one
+        // attempt and so needs checking against the sender's hash
+        bool resumed;
+
         FileHandle *outputFile;
 
         std::shared_ptr<FileIOProvider> provider;
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <sys/types.h>
 #include <stdint.h>
+#include <atomic>
 
 using namespace atakmap::commoncommo;
 using namespace atakmap::commoncommo::impl;
@@ -368,7 +369,11 @@ const struct sockaddr* NetAddress::getSockAddr() const
 
 
 
-Socket::Socket() : fd(PlatformNet::BAD_SOCKET)
+namespace {
+    std::atomic<uint64_t> nextSocketSerial(0);
+}
+
+Socket::Socket() : fd(PlatformNet::BAD_SOCKET), serial(nextSocketSerial++)
 {
 }
 
@@ -390,6 +395,11 @@ PlatformNet::SocketFD Socket::getFD()
     return fd;
 }
 
+uint64_t Socket::getSerial()
+{
+    return serial;
+}
+
 bool Socket::isSocketErrored(netinterfaceenums::NetInterfaceErrorCode *errCode)
 {
     PlatformNet::ErrorCode err = PlatformNet::socketCheckErrored(fd);
@@ -517,6 +527,68 @@ void UdpSocket::sendto(const NetAddress* dest,
 }
 
 void UdpSocket::multicastto(const NetAddress *dest, const uint8_t *data, size_t len, int ttl) COMMO_THROW (SocketException)
+{
+    mcastPrepare(ttl);
+    this->sendto(dest, data, len);
+}
+
+void UdpSocket::recvfromMulti(NetAddress **sources, uint8_t * const *data,
+        size_t *lens, size_t *count) COMMO_THROW (SocketException)
+{
+    struct sockaddr_storage saddrs[PlatformNet::DATAGRAM_BATCH_MAX];
+
+    switch (PlatformNet::socketReadFromMulti(fd, data, lens, saddrs, count)) {
+    case PlatformNet::SUCCESS:
+        break;
+    case PlatformNet::IO_WOULD_BLOCK:
+        throw SocketWouldBlockException();
+    default:
+        throw SocketException();
+    }
+
+    size_t i = 0;
+    try {
+        for (; i < *count; ++i)
+            sources[i] = NetAddress::create((struct sockaddr *)&saddrs[i]);
+    } catch (std::invalid_argument &) {
+        // As for recvfrom(), should never happen
+        while (i > 0)
+            delete sources[--i];
+        throw SocketException();
+    }
+}
+
+void UdpSocket::sendtoMulti(const NetAddress * const *dests, size_t count,
+        const uint8_t *data, size_t len) COMMO_THROW (SocketException)
+{
+    const struct sockaddr *saddrs[PlatformNet::DATAGRAM_BATCH_MAX];
+    socklen_t slens[PlatformNet::DATAGRAM_BATCH_MAX];
+    if (count > PlatformNet::DATAGRAM_BATCH_MAX)
+        throw SocketException();
+    for (size_t i = 0; i < count; ++i) {
+        checkAddr(dests[i]);
+        saddrs[i] = dests[i]->getSockAddr();
+        slens[i] = dests[i]->getSockAddrLen();
+    }
+
+    switch (PlatformNet::socketWriteToMulti(fd, data, len, saddrs, slens, &count)) {
+    case PlatformNet::SUCCESS:
+        break;
+    case PlatformNet::IO_WOULD_BLOCK:
+        throw SocketWouldBlockException();
+    default:
+        throw SocketException();
+    }
+}
+
+void UdpSocket::multicasttoMulti(const NetAddress * const *dests, size_t count,
+        const uint8_t *data, size_t len, int ttl) COMMO_THROW (SocketException)
+{
+    mcastPrepare(ttl);
+    sendtoMulti(dests, count, data, len);
+}
+
+void UdpSocket::mcastPrepare(int ttl) COMMO_THROW (SocketException)
 {
     if (!outboundMcastIfSet) {
         if (PlatformNet::socketSetMcastIf(fd, boundAddr) != PlatformNet::SUCCESS)
@@ -534,8 +606,6 @@ void UdpSocket::multicastto(const NetAddress *dest, const uint8_t *data, size_t
                                                        != PlatformNet::SUCCESS)
             throw SocketException();
     }
-
-    this->sendto(dest, data, len);
 }
 
 void UdpSocket::mcastMembershipChange(CommoLogger *logger, const NetAddress *ifaceAddr, const NetAddress *mcastAddr, bool add)
@@ -688,6 +758,20 @@ size_t TcpSocket::write(const uint8_t *data, const size_t len)
     }
 }
 
+size_t TcpSocket::writev(const uint8_t * const *bufs, const size_t *lens,
+                         const size_t count) COMMO_THROW (SocketException)
+{
+    size_t ret = 0;
+    switch (PlatformNet::socketWriteV(fd, bufs, lens, count, &ret)) {
+    case PlatformNet::SUCCESS:
+        return ret;
+    case PlatformNet::IO_WOULD_BLOCK:
+        return 0;
+    default:
+        throw SocketException();
+    }
+}
+
 size_t TcpSocket::read(uint8_t *data, const size_t len)
         COMMO_THROW (SocketException)
 {
@@ -129,6 +129,9 @@ public:
     // Obtain raw FD. Care must be taken by caller to avoid
     // external use at same time as any internal I/O functions.
     PlatformNet::SocketFD getFD();
+    // Obtain a value uniquely identifying this Socket among all Sockets
+    // created by the process. Unlike the FD, it is never reused.
+    uint64_t getSerial();
 
     // Checks the socket-level error flag (generally sockopt SO_ERROR).
     // Clears any pending error if underlying implementation allows.
@@ -142,6 +145,9 @@ public:
 protected:
     Socket();
     PlatformNet::SocketFD fd;
+
+private:
+    const uint64_t serial;
 };
 
 
@@ -186,6 +192,10 @@ public:
     // condition, an exception is thrown. Trying to write 0 bytes is
     // acceptable
     size_t write(const uint8_t *data, const size_t len) COMMO_THROW (SocketException);
+    // As write(), but gathers from count buffers in a single call.
+    // count must not exceed PlatformNet::WRITEV_MAX_BUFS.
+    size_t writev(const uint8_t * const *bufs, const size_t *lens,
+                  const size_t count) COMMO_THROW (SocketException);
 
     // Attempt to read up to 'len' bytes into the buffer 'data'.
     // Actual number of bytes read is returned (which can be zero if either
@@ -242,6 +252,24 @@ public:
     // Currently only supports IPv4
     void multicastto(const NetAddress *dest, const uint8_t *data, size_t len, int ttl) COMMO_THROW (SocketException);
 
+    // Batched recvfrom(): receives up to *count (at most
+    // PlatformNet::DATAGRAM_BATCH_MAX) datagrams, the i'th into data[i],
+    // a buffer of size lens[i].  On return *count is the number received
+    // and, for each of those, sources[i] and lens[i] are as recvfrom()
+    // would have set them.
+    // Throws as recvfrom() does; SocketWouldBlockException is only thrown
+    // if no data at all was available.
+    void recvfromMulti(NetAddress **sources, uint8_t * const *data,
+                       size_t *lens, size_t *count) COMMO_THROW (SocketException);
+
+    // Sends the same data to each of count destinations, as sendto() or
+    // multicastto() would, but in as few system calls as the platform
+    // allows.  count may not exceed PlatformNet::DATAGRAM_BATCH_MAX.
+    void sendtoMulti(const NetAddress * const *dests, size_t count,
+                     const uint8_t *data, size_t len) COMMO_THROW (SocketException);
+    void multicasttoMulti(const NetAddress * const *dests, size_t count,
+                          const uint8_t *data, size_t len, int ttl) COMMO_THROW (SocketException);
+
     // Issue a multicast join for the multicast addr in mcastAddr on
     // the local interface specified by ifaceAddr.
     // The port setting in mcastAddr, if any, is ignored.
@@ -261,6 +289,10 @@ private:
 
     void mcastMembershipChange(CommoLogger *logger, const NetAddress *ifaceAddr, const NetAddress *mcastAddr, bool add);
 
+    // Sets the outbound multicast interface and TTL, if not already
+    // set, in preparation to multicast. Throws on failure
+    void mcastPrepare(int ttl) COMMO_THROW (SocketException);
+
     NetAddress *boundAddr;
     int currentTTL;
     bool outboundMcastIfSet;
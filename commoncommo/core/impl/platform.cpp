@@ -22,6 +22,7 @@
  #include <fcntl.h>
  #include <errno.h>
  #include <unistd.h>
+ #include <sys/uio.h>
  #ifdef __linux__
   #include <sys/ioctl.h>
   #include <netinet/in.h>
@@ -393,6 +394,51 @@ PlatformNet::ErrorCode PlatformNet::socketWrite(SocketFD fd, const uint8_t *data
 #endif
 }
 
+PlatformNet::ErrorCode PlatformNet::socketWriteV(SocketFD fd,
+        const uint8_t * const *bufs, const size_t *lens, size_t count,
+        size_t *len)
+{
+    *len = 0;
+    if (count > WRITEV_MAX_BUFS)
+        return OTHER_ERROR;
+#ifdef WIN32
+    WSABUF wsaBufs[WRITEV_MAX_BUFS];
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (lens[i] > (size_t)INT_MAX - total)
+            return OTHER_ERROR;
+        total += lens[i];
+        wsaBufs[i].buf = (char *)bufs[i];
+        wsaBufs[i].len = (ULONG)lens[i];
+    }
+    DWORD n = 0;
+    if (::WSASend(fd, wsaBufs, (DWORD)count, &n, 0, NULL, NULL) == SOCKET_ERROR) {
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+            return IO_WOULD_BLOCK;
+        else
+            return OTHER_ERROR;
+    }
+    *len = n;
+    return SUCCESS;
+#else
+    struct iovec iov[WRITEV_MAX_BUFS];
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = (void *)bufs[i];
+        iov[i].iov_len = lens[i];
+    }
+    ssize_t n = ::writev(fd, iov, (int)count);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return IO_WOULD_BLOCK;
+        else
+            return OTHER_ERROR;
+    }
+    // Cast is safe; checked above
+    *len = (size_t)n;
+    return SUCCESS;
+#endif
+}
+
 PlatformNet::ErrorCode PlatformNet::socketRead(SocketFD fd, uint8_t *data, size_t *len)
 {
 #ifdef WIN32
@@ -500,6 +546,97 @@ PlatformNet::ErrorCode PlatformNet::socketReadFrom(SocketFD fd, uint8_t *data, s
 }
 
 
+PlatformNet::ErrorCode PlatformNet::socketReadFromMulti(SocketFD fd,
+        uint8_t * const *data, size_t *lens, struct sockaddr_storage *addrs,
+        size_t *count)
+{
+    size_t n = *count;
+    *count = 0;
+    if (n > DATAGRAM_BATCH_MAX)
+        return OTHER_ERROR;
+#ifdef COMMO_DATAGRAM_MMSG
+    struct mmsghdr msgs[DATAGRAM_BATCH_MAX];
+    struct iovec iov[DATAGRAM_BATCH_MAX];
+    memset(msgs, 0, sizeof(struct mmsghdr) * n);
+    for (size_t i = 0; i < n; ++i) {
+        iov[i].iov_base = data[i];
+        iov[i].iov_len = lens[i];
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+    int r = ::recvmmsg(fd, msgs, (unsigned int)n, 0, NULL);
+    if (r <= 0) {
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return IO_WOULD_BLOCK;
+        return OTHER_ERROR;
+    }
+    for (int i = 0; i < r; ++i)
+        lens[i] = msgs[i].msg_len;
+    *count = (size_t)r;
+    return SUCCESS;
+#else
+    for (size_t i = 0; i < n; ++i) {
+        socklen_t slen = sizeof(struct sockaddr_storage);
+        ErrorCode rc = socketReadFrom(fd, data[i], &lens[i],
+                                      (struct sockaddr *)&addrs[i], &slen);
+        if (rc != SUCCESS) {
+            if (i == 0)
+                return rc;
+            break;
+        }
+        *count = i + 1;
+    }
+    return SUCCESS;
+#endif
+}
+
+PlatformNet::ErrorCode PlatformNet::socketWriteToMulti(SocketFD fd,
+        const uint8_t *data, size_t len,
+        const struct sockaddr * const *addrs, const socklen_t *slens,
+        size_t *count)
+{
+    size_t n = *count;
+    *count = 0;
+    if (n > DATAGRAM_BATCH_MAX)
+        return OTHER_ERROR;
+#ifdef COMMO_DATAGRAM_MMSG
+    struct mmsghdr msgs[DATAGRAM_BATCH_MAX];
+    struct iovec iov;
+    iov.iov_base = (void *)data;
+    iov.iov_len = len;
+    memset(msgs, 0, sizeof(struct mmsghdr) * n);
+    for (size_t i = 0; i < n; ++i) {
+        msgs[i].msg_hdr.msg_iov = &iov;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = (void *)addrs[i];
+        msgs[i].msg_hdr.msg_namelen = slens[i];
+    }
+    // sendmmsg() stops short at the first failing message; resume
+    // from there so that the failure itself gets reported
+    while (*count < n) {
+        int r = ::sendmmsg(fd, msgs + *count, (unsigned int)(n - *count), 0);
+        if (r <= 0) {
+            if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return IO_WOULD_BLOCK;
+            return OTHER_ERROR;
+        }
+        *count += (size_t)r;
+    }
+    return SUCCESS;
+#else
+    for (size_t i = 0; i < n; ++i) {
+        size_t l = len;
+        ErrorCode rc = socketWriteTo(fd, data, &l, addrs[i], slens[i]);
+        if (rc != SUCCESS)
+            return rc;
+        *count = i + 1;
+    }
+    return SUCCESS;
+#endif
+}
+
 PlatformNet::ErrorCode PlatformNet::socketAccept(SocketFD *clientFD,
                                   SocketFD fd,
                                   struct sockaddr *addr, socklen_t *slen)
@@ -1414,6 +1551,386 @@ const std::map<const HwAddress*, const NetAddress*, HwComp>* InterfaceEnumerator
 
 
 
+#ifdef COMMO_NETSELECTOR_EVENTS
+
+NetSelector::NetSelector() : registrations(), lastReady(),
+                             registrationFailed(false)
+#ifdef COMMO_NETSELECTOR_WSAPOLL
+                             , pollFDs(), connectFDs()
+#else
+                             , queueFD(-1), events()
+#endif
+{
+#if defined(COMMO_NETSELECTOR_EPOLL)
+    queueFD = epoll_create1(EPOLL_CLOEXEC);
+#elif defined(COMMO_NETSELECTOR_KQUEUE)
+    queueFD = kqueue();
+#endif
+}
+
+NetSelector::~NetSelector()
+{
+#ifndef COMMO_NETSELECTOR_WSAPOLL
+    if (queueFD != -1)
+        ::close(queueFD);
+#endif
+}
+
+void NetSelector::addInterest(RegistrationMap *regs,
+                              const std::vector<Socket *> *sockets,
+                              int interest)
+{
+    if (sockets == NULL)
+        return;
+
+    std::vector<Socket *>::const_iterator iter;
+    for (iter = sockets->begin(); iter != sockets->end(); ++iter) {
+        Socket *s = *iter;
+        PlatformNet::SocketFD fd = s->getFD();
+        if (fd == PlatformNet::BAD_SOCKET)
+            continue;
+        Registration &reg = (*regs)[fd];
+        reg.serial = s->getSerial();
+        reg.interest |= interest;
+    }
+}
+
+bool NetSelector::updateRegistration(PlatformNet::SocketFD fd,
+                                     const Registration *oldReg,
+                                     const Registration *newReg)
+{
+#if defined(COMMO_NETSELECTOR_EPOLL)
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.data.fd = fd;
+    if (newReg == NULL) {
+        // Failure means the FD was closed and is already gone
+        epoll_ctl(queueFD, EPOLL_CTL_DEL, fd, &ev);
+        return true;
+    }
+
+    if (newReg->interest & INTEREST_READ)
+        ev.events |= EPOLLIN;
+    if (newReg->interest & (INTEREST_WRITE | INTEREST_CONNECT))
+        ev.events |= EPOLLOUT;
+    int op = oldReg ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(queueFD, op, fd, &ev) == 0)
+        return true;
+    // Our view of the registration may be stale; try the other op
+    if (op == EPOLL_CTL_MOD && errno == ENOENT)
+        op = EPOLL_CTL_ADD;
+    else if (op == EPOLL_CTL_ADD && errno == EEXIST)
+        op = EPOLL_CTL_MOD;
+    else
+        return false;
+    return epoll_ctl(queueFD, op, fd, &ev) == 0;
+#elif defined(COMMO_NETSELECTOR_KQUEUE)
+    const int oldInterest = oldReg ? oldReg->interest : 0;
+    const int newInterest = newReg ? newReg->interest : 0;
+    const int writeMask = INTEREST_WRITE | INTEREST_CONNECT;
+    bool ret = true;
+
+    const bool oldRead = (oldInterest & INTEREST_READ) != 0;
+    const bool newRead = (newInterest & INTEREST_READ) != 0;
+    if (oldRead != newRead) {
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_READ, newRead ? EV_ADD : EV_DELETE, 0, 0, NULL);
+        // Delete failures mean the FD was closed and is already gone
+        if (kevent(queueFD, &ev, 1, NULL, 0, NULL) == -1 && newRead)
+            ret = false;
+    }
+    const bool oldWrite = (oldInterest & writeMask) != 0;
+    const bool newWrite = (newInterest & writeMask) != 0;
+    if (oldWrite != newWrite) {
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_WRITE, newWrite ? EV_ADD : EV_DELETE, 0, 0, NULL);
+        if (kevent(queueFD, &ev, 1, NULL, 0, NULL) == -1 && newWrite)
+            ret = false;
+    }
+    return ret;
+#else
+    // The poll set is rebuilt from the registrations in setSockets()
+    return true;
+#endif
+}
+
+void NetSelector::setSockets(
+    const std::vector<Socket *> *readSockets,
+    const std::vector<Socket *> *writeSockets)
+{
+    setSockets(readSockets, writeSockets, NULL);
+}
+
+void NetSelector::setSockets(
+    const std::vector<Socket *> *readSockets,
+    const std::vector<Socket *> *writeSockets,
+    const std::vector<Socket *> *connectingSockets)
+{
+    RegistrationMap newRegs;
+    addInterest(&newRegs, readSockets, INTEREST_READ);
+    addInterest(&newRegs, writeSockets, INTEREST_WRITE);
+    addInterest(&newRegs, connectingSockets, INTEREST_CONNECT);
+
+    // Walk the old and new registrations together, only touching FDs
+    // whose registration changed
+    registrationFailed = false;
+    RegistrationMap::iterator oldIter = registrations.begin();
+    RegistrationMap::iterator newIter = newRegs.begin();
+    while (oldIter != registrations.end() || newIter != newRegs.end()) {
+        if (newIter == newRegs.end() ||
+                (oldIter != registrations.end() && oldIter->first < newIter->first)) {
+            updateRegistration(oldIter->first, &oldIter->second, NULL);
+            ++oldIter;
+            continue;
+        }
+
+        bool ok = true;
+        if (oldIter == registrations.end() || newIter->first < oldIter->first) {
+            ok = updateRegistration(newIter->first, NULL, &newIter->second);
+        } else {
+            if (oldIter->second.serial != newIter->second.serial)
+                // FD was closed and reused; old registration is gone
+                ok = updateRegistration(newIter->first, NULL, &newIter->second);
+            else if (oldIter->second.interest != newIter->second.interest)
+                ok = updateRegistration(newIter->first, &oldIter->second,
+                                        &newIter->second);
+            ++oldIter;
+        }
+
+        if (ok) {
+            ++newIter;
+        } else {
+            // Forget it so the next setSockets() retries
+            registrationFailed = true;
+            newRegs.erase(newIter++);
+        }
+    }
+    registrations.swap(newRegs);
+    lastReady.clear();
+
+#ifdef COMMO_NETSELECTOR_WSAPOLL
+    pollFDs.clear();
+    connectFDs.clear();
+    RegistrationMap::iterator iter;
+    for (iter = registrations.begin(); iter != registrations.end(); ++iter) {
+        int interest = iter->second.interest;
+        if ((interest & INTEREST_CONNECT) && connectFDs.size() < FD_SETSIZE) {
+            connectFDs.push_back(iter->first);
+            interest &= ~INTEREST_CONNECT;
+        }
+        if (interest == 0)
+            continue;
+
+        WSAPOLLFD pfd;
+        memset(&pfd, 0, sizeof(pfd));
+        pfd.fd = iter->first;
+        if (interest & INTEREST_READ)
+            pfd.events |= POLLRDNORM;
+        if (interest & (INTEREST_WRITE | INTEREST_CONNECT))
+            pfd.events |= POLLWRNORM;
+        pollFDs.push_back(pfd);
+    }
+#endif
+}
+
+bool NetSelector::doSelect(long timeoutMillis) COMMO_THROW (SocketException, std::invalid_argument)
+{
+    if (timeoutMillis == NO_TIMEOUT && registrations.empty())
+        throw std::invalid_argument("Cannot specify no FDs and no timeout for select!");
+    if (registrationFailed)
+        throw SocketException();
+
+    lastReady.clear();
+
+    // Readiness, as INTEREST_READ/INTEREST_WRITE, of each FD reported
+    // by the kernel.  Errors and hangups count as both, as with select()
+    std::vector<std::pair<PlatformNet::SocketFD, int> > ready;
+#if defined(COMMO_NETSELECTOR_WSAPOLL)
+    // WSAPoll with no FDs causes error return immediately instead of
+    // sleeping, same as select
+    if (pollFDs.empty() && connectFDs.empty()) {
+        Sleep(timeoutMillis);
+        return false;
+    }
+
+    // WSAPoll and select() cannot wait together, so while connects are
+    // pending the wait is split into slices of at most this length,
+    // each checking both
+    static const long CONNECT_SLICE_MILLIS = 100;
+    const DWORD start = GetTickCount();
+    while (true) {
+        long waitMillis = timeoutMillis;
+        if (!connectFDs.empty()) {
+            waitMillis = CONNECT_SLICE_MILLIS;
+            if (timeoutMillis != NO_TIMEOUT) {
+                const long remaining = timeoutMillis - (long)(GetTickCount() - start);
+                if (remaining < waitMillis)
+                    waitMillis = remaining < 0 ? 0 : remaining;
+            }
+        }
+
+        if (!pollFDs.empty()) {
+            int r = WSAPoll(&pollFDs[0], (ULONG)pollFDs.size(),
+                            waitMillis == NO_TIMEOUT ? -1 : (INT)waitMillis);
+            if (r == SOCKET_ERROR)
+                throw SocketException();
+            for (size_t i = 0; r > 0 && i < pollFDs.size(); ++i) {
+                const SHORT revents = pollFDs[i].revents;
+                if (revents == 0)
+                    continue;
+                if (revents & POLLNVAL)
+                    throw SocketException();
+                int flags = 0;
+                if (revents & (POLLRDNORM | POLLRDBAND))
+                    flags |= INTEREST_READ;
+                if (revents & POLLWRNORM)
+                    flags |= INTEREST_WRITE;
+                if (revents & (POLLERR | POLLHUP))
+                    flags |= INTEREST_READ | INTEREST_WRITE;
+                ready.push_back(std::make_pair(pollFDs[i].fd, flags));
+            }
+            // The slice was spent in WSAPoll; only check the connects
+            waitMillis = 0;
+        }
+
+        if (!connectFDs.empty()) {
+            // A failed connect is reported in exceptfds
+            fd_set wSet;
+            fd_set exSet;
+            FD_ZERO(&wSet);
+            FD_ZERO(&exSet);
+            for (size_t i = 0; i < connectFDs.size(); ++i) {
+                FD_SET(connectFDs[i], &wSet);
+                FD_SET(connectFDs[i], &exSet);
+            }
+            struct timeval tv;
+            tv.tv_sec = waitMillis / 1000;
+            tv.tv_usec = (waitMillis % 1000) * 1000;
+            if (select(0, NULL, &wSet, &exSet, &tv) == SOCKET_ERROR)
+                throw SocketException();
+            for (size_t i = 0; i < connectFDs.size(); ++i) {
+                int flags = 0;
+                if (FD_ISSET(connectFDs[i], &wSet))
+                    flags |= INTEREST_WRITE;
+                if (FD_ISSET(connectFDs[i], &exSet))
+                    flags |= INTEREST_READ | INTEREST_WRITE;
+                if (flags)
+                    ready.push_back(std::make_pair(connectFDs[i], flags));
+            }
+        }
+
+        if (!ready.empty() || connectFDs.empty())
+            break;
+        if (timeoutMillis != NO_TIMEOUT &&
+                (long)(GetTickCount() - start) >= timeoutMillis)
+            break;
+    }
+    const int r = (int)ready.size();
+#elif defined(COMMO_NETSELECTOR_EPOLL)
+    if (queueFD == -1)
+        throw SocketException();
+    if (events.size() < registrations.size() || events.empty())
+        events.resize(registrations.empty() ? 1 : registrations.size());
+
+    int r = epoll_wait(queueFD, &events[0], (int)events.size(),
+                       timeoutMillis == NO_TIMEOUT ? -1 : (int)timeoutMillis);
+    if (r == -1)
+        throw SocketException();
+    for (int i = 0; i < r; ++i) {
+        int flags = 0;
+        if (events[i].events & EPOLLIN)
+            flags |= INTEREST_READ;
+        if (events[i].events & EPOLLOUT)
+            flags |= INTEREST_WRITE;
+        if (events[i].events & (EPOLLERR | EPOLLHUP))
+            flags |= INTEREST_READ | INTEREST_WRITE;
+        const PlatformNet::SocketFD fd = events[i].data.fd;
+        ready.push_back(std::make_pair(fd, flags));
+    }
+#else
+    if (queueFD == -1)
+        throw SocketException();
+    // Read and write are separate filters, so up to 2 events per FD
+    if (events.size() < registrations.size() * 2 || events.empty())
+        events.resize(registrations.empty() ? 1 : registrations.size() * 2);
+
+    struct timespec ts;
+    struct timespec *tsptr = &ts;
+    if (timeoutMillis == NO_TIMEOUT) {
+        tsptr = NULL;
+    } else {
+        ts.tv_sec = timeoutMillis / 1000;
+        ts.tv_nsec = (timeoutMillis % 1000) * 1000000;
+    }
+
+    int r = kevent(queueFD, NULL, 0, &events[0], (int)events.size(), tsptr);
+    if (r == -1)
+        throw SocketException();
+    for (int i = 0; i < r; ++i) {
+        int flags = 0;
+        if (events[i].filter == EVFILT_READ)
+            flags |= INTEREST_READ;
+        else if (events[i].filter == EVFILT_WRITE)
+            flags |= INTEREST_WRITE;
+        if (events[i].flags & EV_ERROR)
+            flags |= INTEREST_READ | INTEREST_WRITE;
+        ready.push_back(std::make_pair((PlatformNet::SocketFD)events[i].ident, flags));
+    }
+#endif
+
+    // Only report what was asked for, as select() would
+    for (size_t i = 0; i < ready.size(); ++i) {
+        RegistrationMap::iterator reg = registrations.find(ready[i].first);
+        if (reg == registrations.end())
+            continue;
+        int mask = 0;
+        if (reg->second.interest & INTEREST_READ)
+            mask |= INTEREST_READ;
+        if (reg->second.interest & (INTEREST_WRITE | INTEREST_CONNECT))
+            mask |= INTEREST_WRITE;
+        if (ready[i].second & mask)
+            lastReady[ready[i].first] |= ready[i].second & mask;
+    }
+
+    return r != 0;
+}
+
+int NetSelector::getLastReady(Socket *s)
+{
+    std::map<PlatformNet::SocketFD, int>::iterator iter =
+            lastReady.find(s->getFD());
+    return iter == lastReady.end() ? 0 : iter->second;
+}
+
+NetSelector::SelectState NetSelector::getLastState(Socket *s)
+{
+    const int flags = getLastReady(s);
+    SelectState ret = NO_IO;
+    if (flags & INTEREST_READ)
+        ret = READABLE;
+    else if (flags & INTEREST_WRITE)
+        ret = WRITABLE;
+
+    return ret;
+}
+
+NetSelector::SelectState NetSelector::getLastReadState(Socket *s)
+{
+    return (getLastReady(s) & INTEREST_READ) ? READABLE : NO_IO;
+}
+
+NetSelector::SelectState NetSelector::getLastWriteState(Socket *s)
+{
+    return (getLastReady(s) & INTEREST_WRITE) ? WRITABLE : NO_IO;
+}
+
+NetSelector::SelectState NetSelector::getLastConnectState(Socket *s)
+{
+    return (getLastReady(s) & INTEREST_WRITE) ? WRITABLE : NO_IO;
+}
+
+#else
+
 NetSelector::NetSelector() : rSetPtr(NULL), wSetPtr(NULL), exSetPtr(NULL), maxfd(PlatformNet::BAD_SOCKET)
 {
     FD_ZERO(&baseReadSet);
@@ -1570,6 +2087,8 @@ NetSelector::SelectState NetSelector::getLastConnectState(Socket *s)
     return ret;
 }
 
+#endif
+
 
 
 
@@ -20,6 +20,33 @@
 #include <sys/select.h>
 #endif
 
+// Select the event notification mechanism used by NetSelector.
+// Platforms with none of these fall back to select(), which cannot
+// watch FDs at or above FD_SETSIZE.
+#if defined(__linux__) || defined(__ANDROID__)
+#define COMMO_NETSELECTOR_EPOLL 1
+#elif defined(__APPLE__)
+#define COMMO_NETSELECTOR_KQUEUE 1
+#elif defined(WIN32)
+#define COMMO_NETSELECTOR_WSAPOLL 1
+#endif
+
+#if defined(COMMO_NETSELECTOR_EPOLL) || defined(COMMO_NETSELECTOR_KQUEUE) || defined(COMMO_NETSELECTOR_WSAPOLL)
+#define COMMO_NETSELECTOR_EVENTS 1
+#endif
+
+// Batched datagram I/O via recvmmsg()/sendmmsg().  Elsewhere the
+// batched PlatformNet calls loop over the single datagram calls.
+#if defined(__linux__) && (!defined(__ANDROID__) || __ANDROID_API__ >= 21)
+#define COMMO_DATAGRAM_MMSG 1
+#endif
+
+#if defined(COMMO_NETSELECTOR_EPOLL)
+#include <sys/epoll.h>
+#elif defined(COMMO_NETSELECTOR_KQUEUE)
+#include <sys/event.h>
+#endif
+
 
 
 #ifdef WIN32
@@ -124,12 +151,39 @@ struct PlatformNet {
     // which is always 0 for returns not equal to SUCCESS
     static ErrorCode socketWrite(SocketFD fd, const uint8_t *data, size_t *len);
     static ErrorCode socketRead(SocketFD fd, uint8_t *data, size_t *len);
+    // Gathering variant of socketWrite; writes the count buffers in order
+    // as if they were one.  count must not exceed WRITEV_MAX_BUFS.
+    // len is updated as for socketWrite with the total # bytes written.
+    static const size_t WRITEV_MAX_BUFS = 64;
+    static ErrorCode socketWriteV(SocketFD fd, const uint8_t * const *bufs,
+                                  const size_t *lens, size_t count,
+                                  size_t *len);
 
     static ErrorCode socketWriteTo(SocketFD fd, const uint8_t *data, size_t *len,
                                     const struct sockaddr *addr, socklen_t slen);
     static ErrorCode socketReadFrom(SocketFD fd, uint8_t *data, size_t *len,
                                     struct sockaddr *addr, socklen_t *slen);
 
+    // Batched forms of socketReadFrom/socketWriteTo; count may not
+    // exceed DATAGRAM_BATCH_MAX.
+    // socketReadFromMulti receives up to *count datagrams, the i'th into
+    // data[i] (of size lens[i]) with its source in addrs[i].  On SUCCESS,
+    // *count and the corresponding lens are updated to what was received,
+    // which is at least one datagram.  Errors after the first datagram
+    // are deferred to the next call.
+    // socketWriteToMulti sends the same data to each of the *count
+    // addresses, in order.  *count is updated to the number of
+    // addresses sent to, which is always all of them for SUCCESS.
+    static const size_t DATAGRAM_BATCH_MAX = 32;
+    static ErrorCode socketReadFromMulti(SocketFD fd, uint8_t * const *data,
+                                    size_t *lens,
+                                    struct sockaddr_storage *addrs,
+                                    size_t *count);
+    static ErrorCode socketWriteToMulti(SocketFD fd, const uint8_t *data,
+                                    size_t len,
+                                    const struct sockaddr * const *addrs,
+                                    const socklen_t *slens, size_t *count);
+
     static ErrorCode socketAccept(SocketFD *clientFD, SocketFD fd,
                                   struct sockaddr *addr, socklen_t *slen);
 
@@ -176,6 +230,12 @@ private:
 
 
 // No thread sync - assumes single thread access
+// Where available (see COMMO_NETSELECTOR_EVENTS), sockets are registered
+// with a kernel event queue (epoll, kqueue or WSAPoll) that persists
+// across doSelect() calls; setSockets() only updates the registrations of
+// sockets that were added, removed or changed.  Notification is level
+// triggered, matching select(), so callers need not drain a socket when it
+// is reported ready.
 class NetSelector {
 public:
     static const long NO_TIMEOUT = -1L;
@@ -227,6 +287,53 @@ public:
 
 private:
     COMMO_DISALLOW_COPY(NetSelector);
+#ifdef COMMO_NETSELECTOR_EVENTS
+    enum {
+        INTEREST_READ = 1,
+        INTEREST_WRITE = 2,
+        INTEREST_CONNECT = 4
+    };
+
+    struct Registration {
+        // Socket::getSerial() of the registered socket.  Closing an
+        // FD silently drops it from the kernel event queue, so a
+        // changed serial means the FD was reused and must be
+        // registered anew.
+        uint64_t serial;
+        int interest;
+    };
+    typedef std::map<PlatformNet::SocketFD, Registration> RegistrationMap;
+
+    void addInterest(RegistrationMap *regs,
+                     const std::vector<Socket *> *sockets, int interest);
+    // oldReg and/or newReg may be NULL for FDs being added or removed.
+    // Returns false if the registration could not be applied.
+    bool updateRegistration(PlatformNet::SocketFD fd,
+                            const Registration *oldReg,
+                            const Registration *newReg);
+    // INTEREST_* flags reported for fd by the most recent doSelect()
+    int getLastReady(Socket *s);
+
+    RegistrationMap registrations;
+    std::map<PlatformNet::SocketFD, int> lastReady;
+    // True if a registration could not be applied; the next doSelect()
+    // fails, as select() would for a bad FD
+    bool registrationFailed;
+#ifdef COMMO_NETSELECTOR_WSAPOLL
+    std::vector<WSAPOLLFD> pollFDs;
+    // Sockets with INTEREST_CONNECT, watched with select() rather than
+    // WSAPoll; older Windows builds do not report failed non-blocking
+    // connects through WSAPoll.  Limited to FD_SETSIZE; any further
+    // connecting sockets are left to WSAPoll.
+    std::vector<PlatformNet::SocketFD> connectFDs;
+#elif defined(COMMO_NETSELECTOR_EPOLL)
+    int queueFD;
+    std::vector<struct epoll_event> events;
+#else
+    int queueFD;
+    std::vector<struct kevent> events;
+#endif
+#else
     void buildSet(fd_set *set, fd_set **sptr, const std::vector<Socket *> *sockets);
     bool growSet(fd_set *set, fd_set **sptr, const std::vector<Socket *> *sockets);
 
@@ -241,6 +348,7 @@ private:
     fd_set exSet;
 
     PlatformNet::SocketFD maxfd;
+#endif
 };
 
 
@@ -13,6 +13,7 @@
   #pragma warning( disable : 4800 )  
 #endif
 
+#include "google/protobuf/arena.h"
 #include "protobuf/cotevent.pb.h"
 #include "protobuf/takmessage.pb.h"
 
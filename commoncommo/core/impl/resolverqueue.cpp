@@ -13,15 +13,19 @@ using namespace atakmap::commoncommo::impl;
 /*************************************************************************/
 // ResolverQueue constructor/destructor
 
+const float ResolverQueue::CACHE_FRESH_SECONDS = 60.0f;
+const float ResolverQueue::CACHE_STALE_SECONDS = 600.0f;
+
 
 ResolverQueue::ResolverQueue(CommoLogger *logger, ResolverListener *listener,
                              float retrySeconds, int nTries) :
-        ThreadedHandler(2), logger(logger),
+        ThreadedHandler(RESOLUTION_THREADID_BASE + RESOLUTION_THREADS),
+        logger(logger),
         listener(listener),
         retrySeconds(retrySeconds),
         nTries(nTries),
         requests(), requestsMutex(),
-        requestsMonitor(),
+        requestsMonitor(), cache(),
         doneQueue(), dispatchMutex(),
         dispatchMonitor()
 {
@@ -42,6 +46,10 @@ ResolverQueue::~ResolverQueue()
     RequestSet::iterator iter;
     for (iter = requests.begin(); iter != requests.end(); ++iter)
         delete *iter;
+
+    ResolutionCache::iterator cIter;
+    for (cIter = cache.begin(); cIter != cache.end(); ++cIter)
+        delete cIter->second.addr;
 }
 
 
@@ -53,7 +61,29 @@ ResolverQueue::Request *ResolverQueue::queueForResolution(
 {
     PGSC::Thread::LockPtr rLock(NULL, NULL);
     Lock_create(rLock, requestsMutex);
-    RequestImpl *r = new RequestImpl(name);
+    RequestImpl *r = new RequestImpl(name, false);
+
+    ResolutionCache::iterator cIter = cache.find(name);
+    if (cIter != cache.end()) {
+        float age = CommoTime::now().minus(cIter->second.resolvedTime);
+        if (age < CACHE_STALE_SECONDS) {
+            r->result = NetAddress::duplicateAddress(cIter->second.addr);
+            if (age >= CACHE_FRESH_SECONDS && !cIter->second.revalidating) {
+                // Serve the stale result now, refresh it for next time
+                cIter->second.revalidating = true;
+                requests.insert(new RequestImpl(name, true));
+                requestsMonitor.broadcast(*rLock);
+            }
+            PGSC::Thread::LockPtr dLock(NULL, NULL);
+            Lock_create(dLock, dispatchMutex);
+            doneQueue.push_front(r);
+            dispatchMonitor.broadcast(*dLock);
+            return r;
+        }
+        delete cIter->second.addr;
+        cache.erase(cIter);
+    }
+
     requests.insert(r);
     requestsMonitor.broadcast(*rLock);
     return r;
@@ -76,34 +106,22 @@ void ResolverQueue::cancelResolution(ResolverQueue::Request *request)
 void ResolverQueue::threadEntry(
         size_t threadNum)
 {
-    switch (threadNum) {
-    case DISPATCH_THREADID:
+    if (threadNum == DISPATCH_THREADID)
         dispatchThreadProcess();
-        break;
-    case RESOLUTION_THREADID:
-        resolutionThreadProcess();
-        break;
-    }
+    else
+        resolutionThreadProcess(threadNum);
 }
 
 void ResolverQueue::threadStopSignal(size_t threadNum)
 {
-    switch (threadNum) {
-    case DISPATCH_THREADID:
-        {
-            PGSC::Thread::LockPtr dLock(NULL, NULL);
-            Lock_create(dLock, dispatchMutex);
-            dispatchMonitor.broadcast(*dLock);
-            break;
-        }
-        break;
-    case RESOLUTION_THREADID:
-        {
-            PGSC::Thread::LockPtr rLock(NULL, NULL);
-            Lock_create(rLock, requestsMutex);
-            requestsMonitor.broadcast(*rLock);
-            break;
-        }
+    if (threadNum == DISPATCH_THREADID) {
+        PGSC::Thread::LockPtr dLock(NULL, NULL);
+        Lock_create(dLock, dispatchMutex);
+        dispatchMonitor.broadcast(*dLock);
+    } else {
+        PGSC::Thread::LockPtr rLock(NULL, NULL);
+        Lock_create(rLock, requestsMutex);
+        requestsMonitor.broadcast(*rLock);
     }
 }
 
@@ -160,12 +178,13 @@ void ResolverQueue::dispatchThreadProcess()
 /*************************************************************************/
 // ResolverQueue - name resolution processing thread
 
-void ResolverQueue::resolutionThreadProcess()
+void ResolverQueue::resolutionThreadProcess(size_t threadNum)
 {
     std::string resolveMe;
 
-    while (!threadShouldStop(RESOLUTION_THREADID)) {
-        // Get context with lowest retry time that is past "now"
+    while (!threadShouldStop(threadNum)) {
+        // Get context with lowest retry time that is past "now" and not
+        // already being worked on by another thread
         RequestImpl *resolveMeRequest = NULL;
         {
             PGSC::Thread::LockPtr lock(NULL, NULL);
@@ -178,6 +197,8 @@ void ResolverQueue::resolutionThreadProcess()
             RequestImpl *lowestTimeCtx = NULL;
             for (iter = requests.begin(); iter != requests.end(); ++iter) {
                 RequestImpl *ctx = *iter;
+                if (ctx->inProgress)
+                    continue;
                 if (!lowestTimeCtx || ctx->retryTime < earliestTime) {
                     earliestTime = ctx->retryTime;
                     lowestTimeCtx = ctx;
@@ -204,6 +225,7 @@ void ResolverQueue::resolutionThreadProcess()
                     // our time has come. Process this item!
                     resolveMe = lowestTimeCtx->host;
                     resolveMeRequest = lowestTimeCtx;
+                    resolveMeRequest->inProgress = true;
                 }
             } // else we have nothing - we'll wait until we are told we have something
 
@@ -238,9 +260,24 @@ void ResolverQueue::resolutionThreadProcess()
             PGSC::Thread::LockPtr lock(NULL, NULL);
             Lock_create(lock, requestsMutex);
 
+            if (addr)
+                cacheResult(resolveMe, addr);
+
             RequestSet::iterator iter = requests.find(resolveMeRequest);
-            if (iter != requests.end()) {
+            if (iter != requests.end() && resolveMeRequest->revalidation) {
+                // Background refresh; the cache is all it updates.
+                // On failure the stale entry stands until it expires
+                if (!addr) {
+                    ResolutionCache::iterator cIter = cache.find(resolveMe);
+                    if (cIter != cache.end())
+                        cIter->second.revalidating = false;
+                }
+                requests.erase(iter);
+                delete resolveMeRequest;
+                delete addr;
+            } else if (iter != requests.end()) {
                 // Still valid
+                resolveMeRequest->inProgress = false;
                 if (addr || (nTries > 0 && ++resolveMeRequest->tryCount > nTries)) {
                     // Success or failure on last retry - call it quits
                     resolveMeRequest->result = addr;
@@ -261,6 +298,8 @@ void ResolverQueue::resolutionThreadProcess()
                     // retry count above (if it matters).
                     // Set next time.
                     resolveMeRequest->retryTime = CommoTime::now() + retrySeconds;
+                    // Idle threads may be waiting without a wake time
+                    requestsMonitor.broadcast(*lock);
 
                     // Copy over to error list - note that we retain
                     // ownership in requests list
@@ -281,15 +320,32 @@ void ResolverQueue::resolutionThreadProcess()
 }
 
 
+void ResolverQueue::cacheResult(const std::string &host,
+                                const NetAddress *addr)
+{
+    ResolutionCache::iterator iter = cache.find(host);
+    if (iter == cache.end())
+        iter = cache.insert(ResolutionCache::value_type(host,
+                                                        CacheEntry())).first;
+    else
+        delete iter->second.addr;
+    iter->second.addr = NetAddress::duplicateAddress(addr);
+    iter->second.resolvedTime = CommoTime::now();
+    iter->second.revalidating = false;
+}
+
+
+
 
 
 /*************************************************************************/
 // Internal utility classes
 
-ResolverQueue::RequestImpl::RequestImpl(const std::string &host) :
+ResolverQueue::RequestImpl::RequestImpl(const std::string &host,
+                                        bool revalidation) :
         Request(), retryTime(CommoTime::now()),
         tryCount(0), host(host),
-        result(NULL)
+        result(NULL), inProgress(false), revalidation(revalidation)
 {
 }
 
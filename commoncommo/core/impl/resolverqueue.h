@@ -14,6 +14,7 @@
 #include <Cond.h>
 
 #include <set>
+#include <map>
 #include <deque>
 
 namespace atakmap {
@@ -24,6 +25,11 @@ namespace impl {
 class ResolverListener;
 
 
+// Resolves host names on a small pool of threads so that a slow lookup
+// does not hold up others.  Successful results are cached: a request for a
+// name resolved within the last CACHE_FRESH_SECONDS completes straight from
+// the cache, and one resolved within CACHE_STALE_SECONDS also completes
+// from the cache while the name is re-resolved in the background.
 class ResolverQueue : public ThreadedHandler
 {
 public:
@@ -53,7 +59,12 @@ protected:
     virtual void threadStopSignal(size_t threadNum);
 
 private:
-    enum { RESOLUTION_THREADID, DISPATCH_THREADID };
+    enum { DISPATCH_THREADID, RESOLUTION_THREADID_BASE };
+    static const size_t RESOLUTION_THREADS = 3;
+    // The system resolver does not expose record TTLs, so results are
+    // held for a fixed time
+    static const float CACHE_FRESH_SECONDS;
+    static const float CACHE_STALE_SECONDS;
 
     class RequestImpl : public Request {
     public:
@@ -61,13 +72,29 @@ private:
         int tryCount;
         const std::string host;
         NetAddress *result;
+        // True while a resolution thread is working on this request
+        bool inProgress;
+        // True for internal background refreshes of a stale cache entry;
+        // these only update the cache and are never dispatched
+        const bool revalidation;
 
-        RequestImpl(const std::string &host);
+        RequestImpl(const std::string &host, bool revalidation);
         virtual ~RequestImpl();
     };
 
+    struct CacheEntry {
+        NetAddress *addr;
+        CommoTime resolvedTime;
+        // True if a background revalidation request is outstanding
+        bool revalidating;
+
+        CacheEntry() : addr(NULL), resolvedTime(CommoTime::ZERO_TIME),
+                       revalidating(false) {}
+    };
+
     typedef std::set<RequestImpl *> RequestSet;
     typedef std::deque<RequestImpl *> RequestQueue;
+    typedef std::map<std::string, CacheEntry> ResolutionCache;
 
     CommoLogger *logger;
     ResolverListener *listener;
@@ -77,6 +104,8 @@ private:
     RequestSet requests;
     PGSC::Thread::Mutex requestsMutex;
     PGSC::Thread::CondVar requestsMonitor;
+    // Protected by requestsMutex
+    ResolutionCache cache;
 
     RequestQueue errQueue;
     RequestQueue doneQueue;
@@ -86,8 +115,10 @@ private:
 
 
     COMMO_DISALLOW_COPY(ResolverQueue);
-    void resolutionThreadProcess();
+    void resolutionThreadProcess(size_t threadNum);
     void dispatchThreadProcess();
+    // Must hold requestsMutex
+    void cacheResult(const std::string &host, const NetAddress *addr);
 };
 
 
@@ -0,0 +1,90 @@
+#include "streamcompressor.h"
+
+#include <string.h>
+
+using namespace atakmap::commoncommo;
+using namespace atakmap::commoncommo::impl;
+
+
+namespace {
+    // Negative for raw deflate, no zlib header or trailer
+    const int RAW_WINDOW_BITS = -15;
+    const int MEM_LEVEL = 8;
+}
+
+const char * const atakmap::commoncommo::impl::STREAM_COMPRESSION_DEFLATE =
+        "deflate";
+
+
+StreamDeflater::StreamDeflater() COMMO_THROW (std::invalid_argument)
+{
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     RAW_WINDOW_BITS, MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw std::invalid_argument("Unable to initialize deflate stream");
+}
+
+StreamDeflater::~StreamDeflater()
+{
+    deflateEnd(&zs);
+}
+
+uint8_t *StreamDeflater::compress(const uint8_t *data, size_t len,
+                                  size_t *outLen)
+        COMMO_THROW (std::invalid_argument)
+{
+    // Bound for one flushed chunk: deflateBound() covers the data itself,
+    // plus room for the sync flush marker
+    size_t cap = deflateBound(&zs, (uLong)len) + 16;
+    uint8_t *out = new uint8_t[cap];
+
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+    zs.next_out = out;
+    zs.avail_out = (uInt)cap;
+    int r = deflate(&zs, Z_SYNC_FLUSH);
+    if (r != Z_OK || zs.avail_in != 0) {
+        delete[] out;
+        throw std::invalid_argument("Error compressing stream data");
+    }
+    *outLen = cap - zs.avail_out;
+    return out;
+}
+
+
+StreamInflater::StreamInflater() COMMO_THROW (std::invalid_argument)
+{
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, RAW_WINDOW_BITS) != Z_OK)
+        throw std::invalid_argument("Unable to initialize inflate stream");
+}
+
+StreamInflater::~StreamInflater()
+{
+    inflateEnd(&zs);
+}
+
+bool StreamInflater::needsInput() const
+{
+    return zs.avail_in == 0;
+}
+
+void StreamInflater::setInput(const uint8_t *data, size_t len)
+{
+    zs.next_in = (Bytef *)data;
+    zs.avail_in = (uInt)len;
+}
+
+size_t StreamInflater::inflate(uint8_t *out, size_t outLen)
+        COMMO_THROW (std::invalid_argument)
+{
+    if (!zs.avail_in || !outLen)
+        return 0;
+    zs.next_out = out;
+    zs.avail_out = (uInt)outLen;
+    int r = ::inflate(&zs, Z_SYNC_FLUSH);
+    // Z_BUF_ERROR only means no progress was possible
+    if (r != Z_OK && r != Z_BUF_ERROR)
+        throw std::invalid_argument("Corrupt compressed stream data");
+    return outLen - zs.avail_out;
+}
@@ -0,0 +1,73 @@
+#ifndef IMPL_STREAMCOMPRESSOR_H_
+#define IMPL_STREAMCOMPRESSOR_H_
+
+#include "commoutils.h"
+#include "internalutils.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace atakmap {
+namespace commoncommo {
+namespace impl
+{
+
+// Name of the stream compression scheme as used in protocol negotiation:
+// raw deflate (RFC 1951) with one context per direction per connection,
+// each message ending on a sync flush so it can be decoded as soon as it
+// arrives
+extern const char * const STREAM_COMPRESSION_DEFLATE;
+
+// Compressing half of a deflate stream. History is kept across
+// messages, so repeated tags and detail blocks in later messages
+// cost only a back reference.
+class StreamDeflater
+{
+public:
+    StreamDeflater() COMMO_THROW (std::invalid_argument);
+    ~StreamDeflater();
+
+    // Compresses len bytes of data and flushes so the receiver can
+    // decode them fully. Returns a new[]'d buffer owned by the caller,
+    // with its length in *outLen.
+    uint8_t *compress(const uint8_t *data, size_t len, size_t *outLen)
+            COMMO_THROW (std::invalid_argument);
+
+private:
+    z_stream zs;
+
+    COMMO_DISALLOW_COPY(StreamDeflater);
+};
+
+// Decompressing half of a deflate stream
+class StreamInflater
+{
+public:
+    StreamInflater() COMMO_THROW (std::invalid_argument);
+    ~StreamInflater();
+
+    // True if all input given to setInput() has been consumed
+    bool needsInput() const;
+
+    // Supplies more compressed input. The data must stay valid until
+    // needsInput() returns true.
+    void setInput(const uint8_t *data, size_t len);
+
+    // Decompresses as much pending input as fits in out; returns the
+    // number of bytes produced, which may be zero. Throws if the
+    // stream is corrupt.
+    size_t inflate(uint8_t *out, size_t outLen)
+            COMMO_THROW (std::invalid_argument);
+
+private:
+    z_stream zs;
+
+    COMMO_DISALLOW_COPY(StreamInflater);
+};
+
+}
+}
+}
+
+#endif
@@ -30,6 +30,16 @@ namespace {
     const char MESSAGE_END_TOKEN[] = "</event>";
     const size_t MESSAGE_END_TOKEN_LEN = sizeof(MESSAGE_END_TOKEN) - 1;
     const char *PING_UID_SUFFIX = "-ping";
+    // Most bytes gathered into a single writev() on plain TCP streams
+    const size_t TX_GATHER_BYTES = 64 * 1024;
+    // Small tx items are coalesced until this many bytes so a TLS record
+    // carrying them fits in a typical Ethernet MTU
+    const size_t SSL_TX_RECORD_BYTES = 1400;
+    // Most items committed to a connection's send order ahead of time;
+    // the rest wait in their priority class
+    const size_t TX_COMMIT_ITEMS = 16;
+    // Size of reads from a compressed stream, before inflation
+    const size_t RX_ZBUF_BYTES = 16 * 1024;
 
     char *copyString(const std::string &s)
     {
@@ -51,8 +61,10 @@ namespace {
 
 
 StreamingSocketManagement::StreamingSocketManagement(CommoLogger *logger,
-                                                const std::string &myuid) :
+                                                const std::string &myuid,
+                                                MetricsRegistry *metrics) :
         ThreadedHandler(3, THREAD_NAMES), logger(logger),
+        metrics(metrics),
         resolver(new ResolverQueue(logger, this, RESOLVE_RETRY_SECONDS, RESQ_INFINITE_TRIES)),
         connTimeoutSec(DEFAULT_CONN_TIMEOUT_SECONDS),
         monitor(true),
@@ -69,12 +81,17 @@ StreamingSocketManagement::StreamingSocketManagement(CommoLogger *logger,
         listeners(), listenersMutex()
 {
     sslCtx = SSL_CTX_new(SSLv23_client_method());
-    if (sslCtx)
+    if (sslCtx) {
         // Be certain openssl doesn't do anything with its internal
         // verification as we will do our own (internal verify cannot be made
         // to work with in-memory certs)
         SSL_CTX_set_verify(sslCtx, SSL_VERIFY_NONE, NULL);
-    else {
+        // Sessions are cached per connection, not in the shared context;
+        // each connection has its own client cert and trust store
+        SSL_CTX_set_session_cache_mode(sslCtx, SSL_SESS_CACHE_CLIENT |
+                                       SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(sslCtx, sslNewSession);
+    } else {
         unsigned long errCode = ERR_get_error();
         char ebuf[1024];
         ERR_error_string_n(errCode, ebuf, 1024);
@@ -173,7 +190,8 @@ StreamingNetInterface *StreamingSocketManagement::addStreamingInterface(
         }
 
         ConnectionContext *ctx = new ConnectionContext(epString, addr, sport,
-                                                       endpoint, connType, ssl);
+                                                       endpoint, connType, ssl,
+                                                       metrics->getEndpoint(epString));
         contexts.insert(ContextMap::value_type(epString, ctx));
 
         ctx->broadcastCoTTypes.insert(types, types + nTypes);
@@ -270,6 +288,10 @@ void StreamingSocketManagement::resetConnection(ConnectionContext *ctx, CommoTim
     if (ctx->connType == CONN_TYPE_SSL) {
         ctx->ssl->writeState = SSLConnectionContext::WANT_NONE;
         ctx->ssl->readState = SSLConnectionContext::WANT_NONE;
+        // Any staged write dies with the session; the items themselves
+        // are still queued and get restaged on the next connection
+        ctx->ssl->txBuf.clear();
+        ctx->ssl->txItems = 0;
         if (ctx->ssl->ssl) {
             SSL_shutdown(ctx->ssl->ssl);
             SSL_free(ctx->ssl->ssl);
@@ -287,12 +309,20 @@ void StreamingSocketManagement::resetConnection(ConnectionContext *ctx, CommoTim
             txi.implode();
             ctx->txQueue.pop_back();
         }
+        while (!ctx->txPending.empty())
+            ctx->txPending.pop().implode();
         ctx->txQueueProtoVersion = 0;
         ctx->rxBufOffset = 0;
         ctx->rxBufStart = 0;
         ctx->protoState = ConnectionContext::PROTO_XML_NEGOTIATE;
         ctx->protoLen = 0;
         ctx->protoBlockedForResponse = false;
+        ctx->compressionRequested = false;
+        delete ctx->txDeflater;
+        ctx->txDeflater = NULL;
+        delete ctx->rxInflater;
+        ctx->rxInflater = NULL;
+        ctx->rxZBuf.clear();
     }
 }
 
@@ -372,6 +402,24 @@ void StreamingSocketManagement::setMonitor(bool en)
     this->monitor = en;
 }
 
+size_t StreamingSocketManagement::getRxQueueDepth()
+{
+    PGSC::Thread::LockPtr lock(NULL, NULL);
+    Lock_create(lock, rxQueueMutex);
+    return rxQueue.size();
+}
+
+void StreamingSocketManagement::getTxQueueDepths(
+        std::map<std::string, size_t> *depths)
+{
+    PGSC::Thread::LockPtr lock(NULL, NULL);
+    Lock_create(lock, upMutex);
+    ContextSet::iterator iter;
+    for (iter = upContexts.begin(); iter != upContexts.end(); ++iter)
+        (*depths)[(*iter)->remoteEndpoint] = (*iter)->txQueue.size() +
+                                             (*iter)->txPending.size();
+}
+
 
 /*************************************************************************/
 // StreamingSocketManagement public api: SSL config access
@@ -464,8 +512,9 @@ void StreamingSocketManagement::sendMessage(
         //std::string dbgStr((const char *)msgBytes, len);
         //InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Stream CoT message to ep %s is: {%s}", streamingEndpoint.c_str(), dbgStr.c_str());
         try {
-            ctx->txQueue.push_front(TxQueueItem(ctx, msgCopy, 
-                                                ctx->txQueueProtoVersion));
+            ctx->txPending.push(TxQueueItem(ctx, msgCopy,
+                                            ctx->txQueueProtoVersion),
+                                txPriorityFor(msgCopy), std::string(), NULL);
         } catch (std::invalid_argument &e) {
             delete msgCopy;
             throw e;
@@ -491,8 +540,13 @@ void StreamingSocketManagement::sendBroadcast(
                                               ctx->broadcastCoTTypes.end()) {
             CoTMessage *msgCopy = new CoTMessage(*msg);
             try {
-                ctx->txQueue.push_front(TxQueueItem(ctx, msgCopy, 
-                                                    ctx->txQueueProtoVersion));
+                // A newer position update obsoletes one still queued
+                TxQueueItem replaced;
+                if (ctx->txPending.push(TxQueueItem(ctx, msgCopy,
+                                                    ctx->txQueueProtoVersion),
+                                        txPriorityFor(msgCopy),
+                                        txStaleKeyFor(msgCopy), &replaced))
+                    replaced.implode();
             } catch (std::invalid_argument &e) {
                 delete msgCopy;
                 throw e;
@@ -585,6 +639,12 @@ bool StreamingSocketManagement::connectionThreadCheckSsl(ConnectionContext *ctx)
         if (SSL_set_fd(ctx->ssl->ssl, (int)ctx->socket->getFD()) != 1)
             throw SocketException(netinterfaceenums::ERR_INTERNAL,
                                   "associating fd with ssl context failed");
+        SSL_set_app_data(ctx->ssl->ssl, ctx->ssl);
+        // Offer the last session; the server falls back to a full
+        // handshake if it no longer knows it
+        if (ctx->ssl->session)
+            SSL_set_session(ctx->ssl->ssl, ctx->ssl->session);
+        ctx->ssl->handshakeStart = CommoTime::now();
     }
 
     int r = SSL_connect(ctx->ssl->ssl);
@@ -605,6 +665,11 @@ bool StreamingSocketManagement::connectionThreadCheckSsl(ConnectionContext *ctx)
         X509_free(cert);
 
         if (!certOk) {
+            // Never resume a session with an untrusted server
+            if (ctx->ssl->session) {
+                SSL_SESSION_free(ctx->ssl->session);
+                ctx->ssl->session = NULL;
+            }
             int vResult = ctx->ssl->certChecker->getLastErrorCode();
             InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Server cert verification failed: %d - check truststore for this connection", vResult);
             throw SocketException(netinterfaceenums::ERR_CONN_SSL_PEER_CERT_NOT_TRUSTED,
@@ -613,6 +678,10 @@ bool StreamingSocketManagement::connectionThreadCheckSsl(ConnectionContext *ctx)
 
         // Clear writeState now that we are connected!
         ctx->ssl->writeState = SSLConnectionContext::WANT_NONE;
+        ctx->metrics->addTlsHandshake(ctx->ssl->handshakeStart,
+                                      CommoTime::now());
+        if (SSL_session_reused(ctx->ssl->ssl))
+            InternalUtils::logprintf(logger, CommoLogger::LEVEL_DEBUG, "Resumed SSL session with %s", ctx->remoteEndpoint.c_str());
 
         // If there is an auth document, push it on to the tx queue to get sent
         if (!ctx->ssl->authMessage.empty()) {
@@ -656,6 +725,19 @@ bool StreamingSocketManagement::connectionThreadCheckSsl(ConnectionContext *ctx)
     }
 }
 
+int StreamingSocketManagement::sslNewSession(SSL *ssl, SSL_SESSION *session)
+{
+    SSLConnectionContext *sslCtx =
+            (SSLConnectionContext *)SSL_get_app_data(ssl);
+    if (!sslCtx)
+        return 0;
+    if (sslCtx->session)
+        SSL_SESSION_free(sslCtx->session);
+    // Returning 1 takes ownership of session
+    sslCtx->session = session;
+    return 1;
+}
+
 void StreamingSocketManagement::connectionThreadProcess()
 {
     ContextSet pendingContexts;
@@ -859,6 +941,7 @@ void StreamingSocketManagement::connectionThreadProcess()
                 CommoTime now = CommoTime::now();
                 for (ctxIter = newlyConnectedCtxs.begin(); ctxIter != newlyConnectedCtxs.end(); ++ctxIter) {
                     InternalUtils::logprintf(logger, CommoLogger::LEVEL_INFO, "Stream connection to %s is up!", (*ctxIter)->remoteEndpoint.c_str());
+                    (*ctxIter)->metrics->connects++;
                     (*ctxIter)->retryTime = now;
                     (*ctxIter)->lastRxTime = now;
                     (*ctxIter)->protoTimeout = now + PROTO_TIMEOUT_SECONDS;
@@ -879,9 +962,9 @@ void StreamingSocketManagement::connectionThreadProcess()
 /*************************************************************************/
 // StreamingSocketManagement - I/O thread
 
-size_t StreamingSocketManagement::ioThreadSslRead(ConnectionContext *ctx) COMMO_THROW (SocketException)
+size_t StreamingSocketManagement::ioThreadSslRead(ConnectionContext *ctx, uint8_t *buf, size_t len) COMMO_THROW (SocketException)
 {
-    int n = SSL_read(ctx->ssl->ssl, ctx->rxBuf + ctx->rxBufOffset, (int)(ConnectionContext::rxBufSize - ctx->rxBufOffset));
+    int n = SSL_read(ctx->ssl->ssl, buf, (int)len);
     SSLConnectionContext::SSLWantState newState = SSLConnectionContext::WANT_NONE;
     if (n <= 0) {
         int n0 = n;
@@ -941,11 +1024,192 @@ size_t StreamingSocketManagement::ioThreadSslWrite(ConnectionContext *ctx, const
     return n;
 }
 
-size_t StreamingSocketManagement::ioThreadWrite(ConnectionContext *ctx, const uint8_t *data, size_t n) COMMO_THROW (SocketException)
+
+size_t StreamingSocketManagement::ioThreadRead(ConnectionContext *ctx) COMMO_THROW (SocketException)
+{
+    uint8_t *out = ctx->rxBuf + ctx->rxBufOffset;
+    size_t outLen = ConnectionContext::rxBufSize - ctx->rxBufOffset;
+    bool isSSL = ctx->connType == CONN_TYPE_SSL;
+    if (!ctx->rxInflater)
+        return isSSL ? ioThreadSslRead(ctx, out, outLen) :
+                       ctx->socket->read(out, outLen);
+
+    while (true) {
+        try {
+            size_t n = ctx->rxInflater->inflate(out, outLen);
+            if (n)
+                return n;
+        } catch (std::invalid_argument &e) {
+            InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR,
+                "TakServer %s: %s", ctx->remoteEndpoint.c_str(), e.what());
+            throw SocketException();
+        }
+        if (!ctx->rxInflater->needsInput())
+            return 0;
+
+        // All pending input consumed; read more.  Keep going until
+        // something inflates or the connection runs dry, as SSL may be
+        // holding decrypted data that select() will not report
+        ctx->rxZBuf.resize(RX_ZBUF_BYTES);
+        size_t r = isSSL ? ioThreadSslRead(ctx, &ctx->rxZBuf[0], RX_ZBUF_BYTES) :
+                           ctx->socket->read(&ctx->rxZBuf[0], RX_ZBUF_BYTES);
+        if (!r)
+            return 0;
+        ctx->rxInflater->setInput(&ctx->rxZBuf[0], r);
+    }
+}
+
+void StreamingSocketManagement::ioThreadCompressTx(ConnectionContext *ctx,
+        TxQueueItem &item) COMMO_THROW (SocketException)
 {
-    return ctx->socket->write(data, n);
+    if (!ctx->txDeflater || item.compressed)
+        return;
+    try {
+        size_t len;
+        uint8_t *zdata = ctx->txDeflater->compress(item.data, item.dataLen,
+                                                   &len);
+        delete[] item.data;
+        item.data = zdata;
+        item.dataLen = len;
+        item.compressed = true;
+    } catch (std::invalid_argument &e) {
+        throw SocketException(netinterfaceenums::ERR_INTERNAL, e.what());
+    }
+}
+
+void StreamingSocketManagement::ioThreadRefillTx(ConnectionContext *ctx)
+{
+    while (ctx->txQueue.size() < TX_COMMIT_ITEMS && !ctx->txPending.empty())
+        ctx->txQueue.push_front(ctx->txPending.pop());
+}
+
+void StreamingSocketManagement::ioThreadFlushTx(ConnectionContext *ctx) COMMO_THROW (SocketException)
+{
+    const uint8_t *bufs[PlatformNet::WRITEV_MAX_BUFS];
+    size_t lens[PlatformNet::WRITEV_MAX_BUFS];
+
+    while (true) {
+        ioThreadRefillTx(ctx);
+        if (ctx->txQueue.empty() || ctx->protoBlockedForResponse)
+            break;
+        // Gather from the oldest item forward.  Nothing beyond a
+        // proto swap request may go out until it is answered.
+        size_t count = 0;
+        size_t total = 0;
+        TxQueue::reverse_iterator iter;
+        for (iter = ctx->txQueue.rbegin(); iter != ctx->txQueue.rend() &&
+                count < PlatformNet::WRITEV_MAX_BUFS &&
+                total < TX_GATHER_BYTES; ++iter) {
+            ioThreadCompressTx(ctx, *iter);
+            bufs[count] = iter->data + iter->bytesSent;
+            lens[count] = iter->dataLen - iter->bytesSent;
+            total += lens[count];
+            count++;
+            if (iter->protoSwapRequest)
+                break;
+        }
+
+        size_t w = ctx->socket->writev(bufs, lens, count);
+        bool complete = w == total;
+
+        // Retire what was fully sent, advance a partially sent item
+        for (size_t i = 0; i < count; ++i) {
+            TxQueueItem &item = ctx->txQueue.back();
+            size_t r = item.dataLen - item.bytesSent;
+            if (w < r) {
+                item.bytesSent += w;
+                break;
+            }
+            w -= r;
+            if (item.protoSwapRequest)
+                // No more sending on this guy until
+                // we get a response to this proto swap
+                // request (in rx handling)
+                ctx->protoBlockedForResponse = true;
+            ctx->metrics->addTx(1, item.dataLen);
+            item.implode();
+            ctx->txQueue.pop_back();
+        }
+
+        if (!complete)
+            // socket tx queue is full
+            break;
+    }
 }
 
+void StreamingSocketManagement::ioThreadFlushSslTx(ConnectionContext *ctx) COMMO_THROW (SocketException)
+{
+    SSLConnectionContext *ssl = ctx->ssl;
+
+    while (true) {
+        if (!ssl->txItems) {
+            ioThreadRefillTx(ctx);
+            if (ctx->txQueue.empty() || ctx->protoBlockedForResponse)
+                break;
+
+            TxQueueItem &item = ctx->txQueue.back();
+            ioThreadCompressTx(ctx, item);
+            size_t r = item.dataLen - item.bytesSent;
+            if (r >= SSL_TX_RECORD_BYTES) {
+                // Too big to benefit from coalescing; send in place.
+                // This choice is stable across retries as the oldest
+                // item does not change until it is sent.
+                while (r > 0) {
+                    size_t w = ioThreadSslWrite(ctx, item.data + item.bytesSent, r);
+                    if (!w)
+                        break;
+                    r -= w;
+                    item.bytesSent += w;
+                }
+                if (r)
+                    // some input or output needed before finishing
+                    // this item. Leave queue item intact
+                    break;
+                if (item.protoSwapRequest)
+                    ctx->protoBlockedForResponse = true;
+                ctx->metrics->addTx(1, item.dataLen);
+                item.implode();
+                ctx->txQueue.pop_back();
+                continue;
+            }
+
+            // Stage whole items, oldest first, up to one record's worth
+            TxQueue::reverse_iterator iter;
+            for (iter = ctx->txQueue.rbegin(); iter != ctx->txQueue.rend(); ++iter) {
+                ioThreadCompressTx(ctx, *iter);
+                r = iter->dataLen - iter->bytesSent;
+                if (ssl->txItems && ssl->txBuf.size() + r > SSL_TX_RECORD_BYTES)
+                    break;
+                ssl->txBuf.insert(ssl->txBuf.end(),
+                                  iter->data + iter->bytesSent,
+                                  iter->data + iter->dataLen);
+                ssl->txItems++;
+                if (iter->protoSwapRequest)
+                    break;
+            }
+        }
+
+        // SSL_write() without partial writes either sends all of the
+        // buffer or nothing
+        if (!ssl->txBuf.empty() &&
+                !ioThreadSslWrite(ctx, &ssl->txBuf[0], ssl->txBuf.size()))
+            break;
+
+        for (size_t i = 0; i < ssl->txItems; ++i) {
+            TxQueueItem &item = ctx->txQueue.back();
+            if (item.protoSwapRequest)
+                // No more sending on this guy until
+                // we get a response to this proto swap
+                // request (in rx handling)
+                ctx->protoBlockedForResponse = true;
+            item.implode();
+            ctx->txQueue.pop_back();
+        }
+        ctx->metrics->addTx(ssl->txItems, ssl->txBuf.size());
+        ssl->txBuf.clear();
+        ssl->txItems = 0;
+    }
+}
 
 void StreamingSocketManagement::ioThreadProcess()
 {
@@ -985,48 +1249,23 @@ void StreamingSocketManagement::ioThreadProcess()
                 ctx = *ctxIter;
                 bool inTxSelection = txSet.find(ctx) != txSet.end();
 
-                size_t (StreamingSocketManagement::*writeFunc)(ConnectionContext *ctx, const uint8_t *, size_t);
                 bool isSSL = ctx->connType == CONN_TYPE_SSL;
                 bool doTx;
                 if (isSSL) {
                     doTx = ctx->ssl->writeState == SSLConnectionContext::WANT_NONE ||
                             (!ioNeedsRebuild && ((ctx->ssl->writeState == SSLConnectionContext::WANT_WRITE && selector.getLastWriteState(ctx->socket) == NetSelector::WRITABLE) ||
                             (ctx->ssl->writeState == SSLConnectionContext::WANT_READ && selector.getLastReadState(ctx->socket) == NetSelector::READABLE)));
-                    writeFunc = &StreamingSocketManagement::ioThreadSslWrite;
                 } else {
                     doTx = !inTxSelection || selector.getLastWriteState(ctx->socket) == NetSelector::WRITABLE;
-                    writeFunc = &StreamingSocketManagement::ioThreadWrite;
                 }
 
                 try {
                     if (doTx) {
                         // Tx might have room
-                        while (!ctx->txQueue.empty() && !ctx->protoBlockedForResponse) {
-                            TxQueueItem &item = ctx->txQueue.back();
-                            size_t r = item.dataLen - item.bytesSent;
-                            while (r > 0) {
-                                size_t w = (this->*writeFunc)(ctx, item.data + item.bytesSent, r);
-                                if (!w)
-                                    break;
-                                r -= w;
-                                item.bytesSent += w;
-                            }
-                            if (r) {
-                                // socket tx queue is full (non-SSL) or
-                                // some input or output needed (SSL)
-                                // before finishing this item.
-                                // break out and leave queue item intact
-                                break;
-                            } else {
-                                if (item.protoSwapRequest)
-                                    // No more sending on this guy until
-                                    // we get a response to this proto swap
-                                    // request (in rx handling)
-                                    ctx->protoBlockedForResponse = true;
-                                item.implode();
-                                ctx->txQueue.pop_back();
-                            }
-                        }
+                        if (isSSL)
+                            ioThreadFlushSslTx(ctx);
+                        else
+                            ioThreadFlushTx(ctx);
                     }
 
                     if (!inTxSelection) {
@@ -1095,7 +1334,7 @@ void StreamingSocketManagement::ioThreadProcess()
                     if (ctx->connType == CONN_TYPE_SSL) {
                         if ((ctx->ssl->readState == SSLConnectionContext::WANT_WRITE && selector.getLastWriteState(ctx->socket) == NetSelector::WRITABLE) || (ctx->ssl->readState != SSLConnectionContext::WANT_WRITE && selector.getLastReadState(ctx->socket) == NetSelector::READABLE)) {
                             while (true) {
-                                size_t r = ioThreadSslRead(ctx);
+                                size_t r = ioThreadRead(ctx);
                                 if (!r)
                                     break;
                                 bool f = scanStreamData(ctx, r);
@@ -1106,7 +1345,7 @@ void StreamingSocketManagement::ioThreadProcess()
                         if (selector.getLastReadState(ctx->socket) == NetSelector::READABLE) {
                             // Read until there is nothing available
                             while (true) {
-                                size_t r = ctx->socket->read(ctx->rxBuf + ctx->rxBufOffset, ConnectionContext::rxBufSize - ctx->rxBufOffset);
+                                size_t r = ioThreadRead(ctx);
                                 if (!r)
                                     break;
                                 bool f = scanStreamData(ctx, r);
@@ -1214,6 +1453,20 @@ void StreamingSocketManagement::convertTxToProtoVersion(ConnectionContext *ctx,
             ctx->txQueue.erase(curIter);
         }
     }
+    for (int pri = 0; pri < TX_PRIORITY_COUNT; ++pri) {
+        TxPendingQueue::iterator pIter = ctx->txPending.begin(pri);
+        while (pIter != ctx->txPending.end(pri)) {
+            try {
+                pIter->item.reserialize(protoVersion);
+                pIter++;
+            } catch (std::invalid_argument &ex) {
+                InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR,
+                    "Unexpected error reserializing message! %s", ex.what());
+                pIter->item.implode();
+                pIter = ctx->txPending.erase(pri, pIter);
+            }
+        }
+    }
     ctx->txQueueProtoVersion = protoVersion;
 
 }
@@ -1258,8 +1511,14 @@ bool StreamingSocketManagement::protoNegotiation(ConnectionContext *ctx,
                 {
                     PGSC::Thread::LockPtr uplock(NULL, NULL);
                     Lock_create(uplock, upMutex);
+                    std::set<std::string> cs =
+                            msg->getTakControlSupportedCompression();
+                    ctx->compressionRequested =
+                            cs.count(STREAM_COMPRESSION_DEFLATE) != 0;
                     CoTMessage *rmsg = new CoTMessage(logger, 
-                                                      msg->getEventUid(), 1);
+                            msg->getEventUid(), 1,
+                            ctx->compressionRequested ?
+                                STREAM_COMPRESSION_DEFLATE : std::string());
                     try {
                         TxQueueItem qi(ctx, rmsg);
                         qi.protoSwapRequest = true;
@@ -1276,7 +1535,7 @@ bool StreamingSocketManagement::protoNegotiation(ConnectionContext *ctx,
                 ctx->protoState = ConnectionContext::PROTO_WAITRESPONSE;
                 ctx->protoTimeout = CommoTime::now() + PROTO_TIMEOUT_SECONDS;
                 InternalUtils::logprintf(logger, CommoLogger::LEVEL_INFO,
-                    "TakServer %s Proto Negotiate: Requesting transition to protocol version 1", ctx->remoteEndpoint.c_str());
+                    "TakServer %s Proto Negotiate: Requesting transition to protocol version 1%s", ctx->remoteEndpoint.c_str(), ctx->compressionRequested ? " with deflate compression" : "");
             }
         } else {
             InternalUtils::logprintf(logger, CommoLogger::LEVEL_WARNING,
@@ -1291,6 +1550,20 @@ bool StreamingSocketManagement::protoNegotiation(ConnectionContext *ctx,
                 ctx->protoState = ConnectionContext::PROTO_HDR_MAGIC;
                 ret = true;
                 convertTxToProtoVersion(ctx, 1);
+                if (ctx->compressionRequested &&
+                        msg->getTakControlResponseCompression() ==
+                                STREAM_COMPRESSION_DEFLATE) {
+                    try {
+                        ctx->txDeflater = new StreamDeflater();
+                        ctx->rxInflater = new StreamInflater();
+                        InternalUtils::logprintf(logger, CommoLogger::LEVEL_INFO,
+                            "TakServer %s Proto Negotiate: Stream compression accepted, compressing both directions", ctx->remoteEndpoint.c_str());
+                    } catch (std::invalid_argument &e) {
+                        // Stream will fail to decode and be reset
+                        InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR,
+                            "TakServer %s Proto Negotiate: %s", ctx->remoteEndpoint.c_str(), e.what());
+                    }
+                }
 
             } else {
                 InternalUtils::logprintf(logger, CommoLogger::LEVEL_INFO,
@@ -1316,6 +1589,8 @@ bool StreamingSocketManagement::dispatchRxMessage(ConnectionContext *ctx,
 {
     bool ret = false;
 
+    ctx->metrics->addRx(len);
+
     // Convert the data to a CoTMessage
     try {
         TakMessage takmsg(logger, ctx->rxBuf + ctx->rxBufStart,
@@ -1341,6 +1616,7 @@ bool StreamingSocketManagement::dispatchRxMessage(ConnectionContext *ctx,
     } catch (std::invalid_argument &e) {
         std::string s((const char *)ctx->rxBuf + ctx->rxBufStart, len);
         InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR, "Invalid CoT message received from stream: {%s} -- %s", s.c_str(), e.what() == NULL ? "" : e.what());
+        ctx->metrics->rxParseFailures++;
     }
     
     return ret;
@@ -1372,6 +1648,16 @@ bool StreamingSocketManagement::scanStreamData(
                         // transition to protobuf immediately
                         // State already updated by dispatch
                         protoIsXml = false;
+                        if (ctx->rxInflater) {
+                            // Everything after the response is compressed;
+                            // hand it to the inflater to be read back in
+                            ctx->rxZBuf.assign(ctx->rxBuf + ctx->rxBufStart,
+                                               ctx->rxBuf + scanEnd);
+                            if (!ctx->rxZBuf.empty())
+                                ctx->rxInflater->setInput(&ctx->rxZBuf[0],
+                                                          ctx->rxZBuf.size());
+                            scanEnd = ctx->rxBufStart;
+                        }
                         scanStart = ctx->rxBufStart;
                         break;
                     }
@@ -1607,7 +1893,7 @@ bool StreamingSocketManagement::resolutionComplete(
 
 StreamingSocketManagement::TxQueueItem::TxQueueItem() :
         ctx(NULL), msg(NULL), data(NULL), dataLen(0), 
-        bytesSent(0), protoSwapRequest(false)
+        bytesSent(0), protoSwapRequest(false), compressed(false)
 {
 }
 
@@ -1615,7 +1901,7 @@ StreamingSocketManagement::TxQueueItem::TxQueueItem(
         ConnectionContext *ctx, CoTMessage *msg, int protoVersion)
             COMMO_THROW (std::invalid_argument) :
                 ctx(ctx), msg(msg), data(NULL), dataLen(0), bytesSent(0),
-                protoSwapRequest(false)
+                protoSwapRequest(false), compressed(false)
 {
     reserialize(protoVersion);
 }
@@ -1624,7 +1910,7 @@ StreamingSocketManagement::TxQueueItem::TxQueueItem(
 StreamingSocketManagement::TxQueueItem::TxQueueItem(
         ConnectionContext *ctx, const std::string &rawMessage) :
             ctx(ctx), msg(NULL), data(NULL), dataLen(0), bytesSent(0),
-            protoSwapRequest(false)
+            protoSwapRequest(false), compressed(false)
 {
     dataLen = rawMessage.length();
     uint8_t *ndata = new uint8_t[dataLen];
@@ -1664,6 +1950,7 @@ void StreamingSocketManagement::TxQueueItem::reserialize(int protoVersion)
     delete data;
     data = ndata;
     dataLen = len;
+    compressed = false;
 }
 
 
@@ -1691,20 +1978,25 @@ void StreamingSocketManagement::RxQueueItem::implode()
 StreamingSocketManagement::ConnectionContext::ConnectionContext(
         const std::string &epString, const std::string &epAddrString,
         unsigned short int port, NetAddress *ep, ConnType type,
-        SSLConnectionContext *ssl) :
+        SSLConnectionContext *ssl,
+        MetricsRegistry::EndpointCounters *metrics) :
         StreamingNetInterface(copyString(epString), epString.length()),
         remoteEndpoint(epString), remoteEndpointAddrString(epAddrString),
         remotePort(port),
         remoteEndpointAddr(ep), broadcastCoTTypes(),
-        connType(type), ssl(ssl),
+        connType(type), metrics(metrics), ssl(ssl),
         socket(NULL), resolverRequest(NULL), retryTime(CommoTime::ZERO_TIME),
         lastRxTime(CommoTime::ZERO_TIME),
-        txQueue(), txQueueProtoVersion(0), rxBufStart(0), rxBufOffset(0),
+        txQueue(), txPending(), txQueueProtoVersion(0), rxBufStart(0), rxBufOffset(0),
         protoState(PROTO_XML_NEGOTIATE),
         protoMagicSearchCount(0),
         protoLen(0),
         protoBlockedForResponse(false),
-        protoTimeout(CommoTime::now() + PROTO_TIMEOUT_SECONDS)
+        protoTimeout(CommoTime::now() + PROTO_TIMEOUT_SECONDS),
+        compressionRequested(false),
+        txDeflater(NULL),
+        rxInflater(NULL),
+        rxZBuf()
 {
 }
 
@@ -1715,6 +2007,10 @@ StreamingSocketManagement::ConnectionContext::~ConnectionContext()
         txQueue.pop_back();
         txi.implode();
     }
+    while (!txPending.empty())
+        txPending.pop().implode();
+    delete txDeflater;
+    delete rxInflater;
     delete ssl;
     delete remoteEndpointAddr;
     delete socket;
@@ -1734,6 +2030,10 @@ StreamingSocketManagement::SSLConnectionContext::SSLConnectionContext(
                 ssl(NULL),
                 writeState(WANT_NONE),
                 readState(WANT_NONE),
+                handshakeStart(CommoTime::ZERO_TIME),
+                session(NULL),
+                txBuf(),
+                txItems(0),
                 cert(NULL),
                 key(NULL),
                 certChecker(),
@@ -1817,4 +2117,6 @@ StreamingSocketManagement::SSLConnectionContext::~SSLConnectionContext()
         SSL_free(ssl);
         ssl = NULL;
     }
+    if (session)
+        SSL_SESSION_free(session);
 }
@@ -13,6 +13,9 @@
 #include "cotmessage.h"
 #include "resolverqueue.h"
 #include "internalutils.h"
+#include "metricsregistry.h"
+#include "txpriorityqueue.h"
+#include "streamcompressor.h"
 
 #include <Mutex.h>
 #include <RWMutex.h>
@@ -23,6 +26,7 @@
 #include <map>
 #include <set>
 #include <deque>
+#include <vector>
 
 namespace atakmap {
 namespace commoncommo {
@@ -49,12 +53,19 @@ private:
 class StreamingSocketManagement : public ThreadedHandler, public ResolverListener
 {
 public:
-    StreamingSocketManagement(CommoLogger *logger, const std::string &myuid);
+    StreamingSocketManagement(CommoLogger *logger, const std::string &myuid,
+                              MetricsRegistry *metrics);
     virtual ~StreamingSocketManagement();
 
     void setMonitor(bool enable);
     void setConnTimeout(float sec);
 
+    // Current number of items in the rx queue
+    size_t getRxQueueDepth();
+    // Adds the tx queue depth of each connection that is up,
+    // keyed by remote endpoint id
+    void getTxQueueDepths(std::map<std::string, size_t> *depths);
+
     StreamingNetInterface *addStreamingInterface(const char *hostname, int port,
                                                  const CoTMessageType *types,
                                                  size_t nTypes,
@@ -115,6 +126,8 @@ private:
         size_t dataLen;
         size_t bytesSent;
         bool protoSwapRequest;
+        // True once data holds the compressed form of the item
+        bool compressed;
         TxQueueItem();
         // Takes ownership of msg. Will be delete'd on implosion.
         TxQueueItem(ConnectionContext *ctx, CoTMessage *msg,
@@ -145,6 +158,7 @@ private:
     typedef std::map<ResolverQueue::Request *, ConnectionContext *> ResolverMap;
     typedef std::deque<RxQueueItem> RxQueue;
     typedef std::deque<TxQueueItem> TxQueue;
+    typedef TxPriorityQueue<TxQueueItem> TxPendingQueue;
     typedef std::set<CoTMessageType> MessageTypeSet;
 
     struct SSLConnectionContext {
@@ -177,6 +191,24 @@ private:
         //        is in progress, but needs data to read/write
         SSLWantState readState;
 
+        // When the handshake on the current ssl object began
+        CommoTime handshakeStart;
+
+        // Most recent session established with the server, offered for
+        // resumption on the next connect so that reconnects skip the
+        // full handshake. NULL if none. Set on whichever thread owns
+        // the ssl object (connection thread while connecting, io thread
+        // once up)
+        SSL_SESSION *session;
+
+        // Copies of the oldest txItems tx queue items, coalesced so
+        // that several small messages go out in one TLS record.
+        // Empty (and txItems zero) when no write is staged.  Once
+        // SSL_write() has been attempted on it the buffer must be
+        // retried unchanged until it completes.
+        std::vector<uint8_t> txBuf;
+        size_t txItems;
+
         // The client's certificate
         X509 *cert;
 
@@ -226,6 +258,7 @@ private:
         NetAddress *remoteEndpointAddr;
         MessageTypeSet broadcastCoTTypes;
         ConnType connType;
+        MetricsRegistry::EndpointCounters *metrics;
 
         // non-NULL for ssl connections in any state
         SSLConnectionContext *ssl;
@@ -250,8 +283,13 @@ private:
         CommoTime lastRxTime;
         
         // Valid when "up" only; this is empty otherwise. Protected by main
-        // upMutex
+        // upMutex.  Items committed for sending, in send order; kept short
+        // so that urgent messages queued in txPending are not stuck behind
+        // a long backlog
         TxQueue txQueue;
+        // Valid when "up" only; this is empty otherwise. Protected by main
+        // upMutex.  Messages waiting to be committed to txQueue
+        TxPendingQueue txPending;
         // Valid when "up"; indicates if this connection's tx queue is
         // protobuf (>0) or xml (0). Protected by main upMutex
         int txQueueProtoVersion;
@@ -286,11 +324,21 @@ private:
         //                          for proto version support message
         //    PROTO_WAITRESPONSE - time when we give up waiting for response
         CommoTime protoTimeout;
+        // Stream compression state; all valid only when "up" and only on
+        // io thread.  True if compression was asked for along with the
+        // protocol swap request
+        bool compressionRequested;
+        // Non-NULL once the server has accepted compression
+        StreamDeflater *txDeflater;
+        StreamInflater *rxInflater;
+        // Compressed input not yet inflated into rxBuf
+        std::vector<uint8_t> rxZBuf;
 
         ConnectionContext(const std::string &epString,
                 const std::string &epAddrString,
                 uint16_t port,
-                NetAddress *ep, ConnType type, SSLConnectionContext *ssl);
+                NetAddress *ep, ConnType type, SSLConnectionContext *ssl,
+                MetricsRegistry::EndpointCounters *metrics);
         ~ConnectionContext();
 
     private:
@@ -299,6 +347,7 @@ private:
     };
 
     CommoLogger *logger;
+    MetricsRegistry *metrics;
     ResolverQueue *resolver;
     float connTimeoutSec;
     bool monitor;
@@ -332,6 +381,8 @@ private:
 
     COMMO_DISALLOW_COPY(StreamingSocketManagement);
     void connectionThreadProcess();
+    // OpenSSL new session callback; keeps the session for resumption
+    static int sslNewSession(SSL *ssl, SSL_SESSION *session);
     void ioThreadProcess();
     void recvQueueThreadProcess();
     void resolutionThreadProcess();
@@ -349,9 +400,21 @@ private:
     void resetConnection(ConnectionContext *ctx, CommoTime nextConnTime, bool clearIo);
 
     bool connectionThreadCheckSsl(ConnectionContext *ctx) COMMO_THROW (SocketException);
-    size_t ioThreadSslRead(ConnectionContext *ctx) COMMO_THROW (SocketException);
+    size_t ioThreadSslRead(ConnectionContext *ctx, uint8_t *buf, size_t len) COMMO_THROW (SocketException);
+    // Read into the free part of ctx->rxBuf, inflating if the stream is
+    // compressed. Returns 0 if nothing more is available right now
+    size_t ioThreadRead(ConnectionContext *ctx) COMMO_THROW (SocketException);
+    // Compress item for sending if the stream is compressed and it
+    // hasn't been already. Items must be passed in send order
+    void ioThreadCompressTx(ConnectionContext *ctx, TxQueueItem &item) COMMO_THROW (SocketException);
     size_t ioThreadSslWrite(ConnectionContext *ctx, const uint8_t *data, size_t n) COMMO_THROW (SocketException);
-    size_t ioThreadWrite(ConnectionContext *ctx, const uint8_t *data, size_t n) COMMO_THROW (SocketException);
+    // Move pending tx items into the committed tx queue, most urgent
+    // class first, until it holds a small backlog. Must hold upMutex
+    void ioThreadRefillTx(ConnectionContext *ctx);
+    // Send as much of the tx queue as possible without blocking,
+    // gathering several queued items per write call.
+    void ioThreadFlushTx(ConnectionContext *ctx) COMMO_THROW (SocketException);
+    void ioThreadFlushSslTx(ConnectionContext *ctx) COMMO_THROW (SocketException);
 
     void fireInterfaceChange(ConnectionContext *ctx, bool up);
     void fireInterfaceErr(ConnectionContext *ctx,
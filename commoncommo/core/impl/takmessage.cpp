@@ -12,6 +12,20 @@ namespace {
     const unsigned TAKPROTO_VERSION = 1;
 
     const uint8_t TAKPROTO_MAGIC = 0xbf;
+
+    // Size of the initial arena block used when encoding and decoding.
+    // The object graph of a typical CoT event fits in this without any
+    // heap allocation; larger ones spill over into blocks the arena
+    // allocates (and frees) itself.
+    const size_t ARENA_BLOCK_SIZE = 4096;
+
+    google::protobuf::ArenaOptions arenaOptions(uint64_t *block)
+    {
+        google::protobuf::ArenaOptions opts;
+        opts.initial_block = (char *)block;
+        opts.initial_block_size = ARENA_BLOCK_SIZE;
+        return opts;
+    }
 }
 
 
@@ -144,7 +158,6 @@ size_t TakMessage::serializeAsProtobuf(int protoVersion,
     if (protoVersion != TAKPROTO_VERSION)
         throw std::invalid_argument("Protocol version not supported");
 
-    protobuf::v1::TakMessage takm;
     if (!protoInfo)
         useProtoInf = false;
     if (!cot)
@@ -155,8 +168,14 @@ size_t TakMessage::serializeAsProtobuf(int protoVersion,
         return 0;
     }
     
+    // Arena on the stack; 8-byte aligned as protobuf requires
+    uint64_t arenaBlock[ARENA_BLOCK_SIZE / sizeof(uint64_t)];
+    google::protobuf::Arena arena(arenaOptions(arenaBlock));
+    protobuf::v1::TakMessage *takm = google::protobuf::Arena::
+            CreateMessage<protobuf::v1::TakMessage>(&arena);
+
     if (useProtoInf) {
-        protobuf::v1::TakControl *c = takm.mutable_takcontrol();
+        protobuf::v1::TakControl *c = takm->mutable_takcontrol();
         // Don't send 1's 
         // XXXXXXXXX - verify that both 1's still sends a message!
         if (protoInfo->getMin() != 1)
@@ -173,11 +192,11 @@ size_t TakMessage::serializeAsProtobuf(int protoVersion,
     }
     
     if (useCot) {
-        protobuf::v1::CotEvent *ev = takm.mutable_cotevent();
+        protobuf::v1::CotEvent *ev = takm->mutable_cotevent();
         cot->serializeAsProtobuf(ev);
     }
 
-    size_t len = takm.ByteSizeLong();
+    size_t len = takm->ByteSizeLong();
     size_t headerlen = InternalUtils::VARINT_MAXBUF + 2;
     uint8_t headerBuf[InternalUtils::VARINT_MAXBUF + 2];
     
@@ -206,7 +225,9 @@ size_t TakMessage::serializeAsProtobuf(int protoVersion,
     
     uint8_t *ret = new uint8_t[len + headerlen];
     memcpy(ret, headerBuf, headerlen);
-    if (len > INT_MAX || !takm.SerializeToArray(ret + headerlen, (int)len)) {
+    // Sizes were cached by ByteSizeLong() above
+    if (len > INT_MAX || takm->SerializeWithCachedSizesToArray(ret + headerlen) !=
+                             ret + headerlen + len) {
         delete[] ret;
         InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR, 
                 "Severe error serializing protobuf to output bytes");
@@ -259,19 +280,22 @@ void TakMessage::initFromXml(const uint8_t *data, size_t len)
 void TakMessage::initFromProtobuf(const uint8_t *data, size_t len)
                         COMMO_THROW (std::invalid_argument)
 {
-    protobuf::v1::TakMessage takm;
+    uint64_t arenaBlock[ARENA_BLOCK_SIZE / sizeof(uint64_t)];
+    google::protobuf::Arena arena(arenaOptions(arenaBlock));
+    protobuf::v1::TakMessage *takm = google::protobuf::Arena::
+            CreateMessage<protobuf::v1::TakMessage>(&arena);
     
-    if (len > INT_MAX || !takm.ParseFromArray(data, (int)len))
+    if (len > INT_MAX || !takm->ParseFromArray(data, (int)len))
         throw std::invalid_argument("Failed to parse protobuf from supplied data");
 
-    if (takm.has_cotevent()) {
-        const protobuf::v1::CotEvent &ev = takm.cotevent();
+    if (takm->has_cotevent()) {
+        const protobuf::v1::CotEvent &ev = takm->cotevent();
         ownedCot = new CoTMessage(logger, ev);
         cot = ownedCot;
     }
     
-    if (takm.has_takcontrol()) {
-        const protobuf::v1::TakControl &tc = takm.takcontrol();
+    if (takm->has_takcontrol()) {
+        const protobuf::v1::TakControl &tc = takm->takcontrol();
         int min = tc.minprotoversion();
         int max = tc.maxprotoversion();
         if (min == 0) min = 1;
@@ -283,7 +307,7 @@ void TakMessage::initFromProtobuf(const uint8_t *data, size_t len)
             cot = ownedCot = NULL;
             throw e;
         }
-        std::string cuid = tc.contactuid();
+        const std::string &cuid = tc.contactuid();
         if (cuid.length()) {
             ownedUid = new InternalContactUID((const uint8_t *)cuid.c_str(), 
                                               cuid.length());
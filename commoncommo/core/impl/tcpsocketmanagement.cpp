@@ -26,10 +26,13 @@ namespace {
 
 
 TcpSocketManagement::TcpSocketManagement(CommoLogger *logger, 
-                                         ContactUID *ourUid) :
+                                         ContactUID *ourUid,
+                                         MetricsRegistry *metrics) :
         ThreadedHandler(3, THREAD_NAMES),
         logger(logger),
         ourUid(ourUid),
+        metrics(metrics),
+        txMetrics(metrics->getEndpoint(MetricsRegistry::TCP_TX_ENDPOINT)),
         resolver(NULL),
         connTimeoutSec(DEFAULT_CONN_TIMEOUT_SEC),
         rxCrypto(NULL),
@@ -203,6 +206,13 @@ void TcpSocketManagement::setCryptoKeys(const uint8_t *authKey,
     }
 }
 
+size_t TcpSocketManagement::getRxQueueDepth()
+{
+    PGSC::Thread::LockPtr lock(NULL, NULL);
+    PGSC::Thread::Lock_create(lock, rxQueueMutex);
+    return rxQueue.size();
+}
+
 void TcpSocketManagement::sendMessage(const std::string &host, int port,
                                       const CoTMessage *msg, int protoVersion)
                                                COMMO_THROW (std::invalid_argument)
@@ -231,7 +241,6 @@ void TcpSocketManagement::sendMessage(const std::string &host, int port,
         // Needs name resolution
         PGSC::Thread::LockPtr lock(NULL, NULL);
         Lock_create(lock, resolverContextsMutex);
-        ResolverReqMap resolverContexts;
         ResolverQueue::Request *r = resolver->queueForResolution(host);
         resolverContexts.insert(ResolverReqMap::value_type(r, ctx));
     }
@@ -540,7 +549,8 @@ void TcpSocketManagement::ioThreadProcess()
 
                         ClientContext *cctx = new ClientContext(clientSock,
                                                                 clientAddr,
-                                                                ctx->endpoint);
+                                                                ctx->endpoint,
+                                                                metrics->getEndpoint(ctx->endpoint));
                         clientContexts.insert(cctx);
                         inboundNeedsRebuild = true;
                     }
@@ -596,6 +606,7 @@ void TcpSocketManagement::ioThreadProcess()
                         }
                         if (ctx->dataLen == 0) {
                             // all sent, all done
+                            txMetrics->addTx(1, ctx->data - ctx->origData);
                             killTxCtx(ctx, true);
                         }
                     } catch (SocketException &) {
@@ -645,6 +656,7 @@ void TcpSocketManagement::recvQueueThreadProcess()
         } catch (std::invalid_argument &e) {
             // Drop this item
             InternalUtils::logprintf(logger, CommoLogger::LEVEL_ERROR, "Invalid CoT message received: %s", e.what() == NULL ? "unknown error" : e.what());
+            metrics->getEndpoint(qItem.endpoint)->rxParseFailures++;
         }
         if (decrypted)
             delete[] data;
@@ -738,6 +750,7 @@ void TcpSocketManagement::ioThreadQueueRx(ClientContext *ctx)
         PGSC::Thread::LockPtr lock(NULL, NULL);
         Lock_create(lock, rxQueueMutex);
         RxQueueItem rx(ctx->clientAddr, ctx->endpoint, ctx->data, ctx->len);
+        ctx->metrics->addRx(ctx->len);
         ctx->clearBuffers();
         rxQueue.push_front(rx);
         rxQueueMonitor.broadcast(*lock);
@@ -825,9 +838,11 @@ void TcpSocketManagement::InboundContext::initSocket() COMMO_THROW (SocketExcept
 
 TcpSocketManagement::ClientContext::ClientContext(TcpSocket *socket,
                                                   NetAddress *clientAddr,
-                                                  const std::string &endpoint) :
+                                                  const std::string &endpoint,
+                                                  MetricsRegistry::EndpointCounters *metrics) :
         clientAddr(clientAddr),
         endpoint(endpoint),
+        metrics(metrics),
         socket(socket),
         data(NULL),
         len(0),
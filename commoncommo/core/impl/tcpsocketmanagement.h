@@ -9,6 +9,7 @@
 #include "commotime.h"
 #include "resolverqueue.h"
 #include "cryptoutil.h"
+#include "metricsregistry.h"
 #include <set>
 #include <map>
 #include <deque>
@@ -39,7 +40,8 @@ private:
 class TcpSocketManagement : public ThreadedHandler, public ResolverListener
 {
 public:
-    TcpSocketManagement(CommoLogger *logger, ContactUID *ourUid);
+    TcpSocketManagement(CommoLogger *logger, ContactUID *ourUid,
+                        MetricsRegistry *metrics);
     virtual ~TcpSocketManagement();
 
 
@@ -50,6 +52,9 @@ public:
     void setConnTimeout(float seconds);
     void setCryptoKeys(const uint8_t *authKey, const uint8_t *cryptoKey);
 
+    // Current number of items in the rx queue
+    size_t getRxQueueDepth();
+
     // Uses protoVersion = 0 if supplied version not supported
     void sendMessage(const std::string &host, int port,
                      const CoTMessage *msg, int protoVersion) 
@@ -114,6 +119,7 @@ private:
     {
         NetAddress *clientAddr;
         std::string endpoint;
+        MetricsRegistry::EndpointCounters *metrics;
 
         TcpSocket *socket;
         uint8_t *data;
@@ -121,7 +127,8 @@ private:
         size_t bufLen;
         
         ClientContext(TcpSocket *socket, NetAddress *clientAddr,
-                      const std::string &endpoint);
+                      const std::string &endpoint,
+                      MetricsRegistry::EndpointCounters *metrics);
         ~ClientContext();
         
         void growCapacity(size_t n);
@@ -198,6 +205,8 @@ private:
 
     CommoLogger *logger;
     ContactUID *ourUid;
+    MetricsRegistry *metrics;
+    MetricsRegistry::EndpointCounters *txMetrics;
     ResolverQueue *resolver;
     float connTimeoutSec;
     
@@ -0,0 +1,45 @@
+#include "txpriorityqueue.h"
+
+#include <string.h>
+
+using namespace atakmap::commoncommo;
+using namespace atakmap::commoncommo::impl;
+
+
+namespace {
+    // Event types sent ahead of everything else: alarms (emergency
+    // beacons, troops in contact, ...) and 9-line requests
+    const char *HIGH_PRIORITY_TYPE_PREFIXES[] = {
+        "b-a-",
+        "b-r-f-h-c",
+    };
+    // Event type prefix of position reports
+    const char *POSITION_TYPE_PREFIX = "a-";
+
+    bool hasPrefix(const std::string &s, const char *prefix)
+    {
+        return s.compare(0, strlen(prefix), prefix) == 0;
+    }
+}
+
+
+TxPriority atakmap::commoncommo::impl::txPriorityFor(const CoTMessage *msg)
+{
+    std::string type = msg->getEventType();
+    const size_t n = sizeof(HIGH_PRIORITY_TYPE_PREFIXES) /
+                     sizeof(HIGH_PRIORITY_TYPE_PREFIXES[0]);
+    for (size_t i = 0; i < n; ++i) {
+        if (hasPrefix(type, HIGH_PRIORITY_TYPE_PREFIXES[i]))
+            return TX_PRIORITY_HIGH;
+    }
+    if (msg->getType() == CHAT || msg->getFileTransferRequest())
+        return TX_PRIORITY_LOW;
+    return TX_PRIORITY_NORMAL;
+}
+
+std::string atakmap::commoncommo::impl::txStaleKeyFor(const CoTMessage *msg)
+{
+    if (!hasPrefix(msg->getEventType(), POSITION_TYPE_PREFIX))
+        return std::string();
+    return msg->getEventUid();
+}
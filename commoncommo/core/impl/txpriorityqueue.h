@@ -0,0 +1,144 @@
+#ifndef IMPL_TXPRIORITYQUEUE_H_
+#define IMPL_TXPRIORITYQUEUE_H_
+
+#include "cotmessage.h"
+
+#include <list>
+#include <map>
+#include <string>
+
+namespace atakmap {
+namespace commoncommo {
+namespace impl
+{
+
+// Outbound message classes, most urgent first
+enum TxPriority {
+    // Emergency beacons, 9-line requests
+    TX_PRIORITY_HIGH,
+    // Position updates and anything not otherwise classified
+    TX_PRIORITY_NORMAL,
+    // Chat, file transfer announcements
+    TX_PRIORITY_LOW,
+    TX_PRIORITY_COUNT
+};
+
+// Returns the class the given message should be sent in
+TxPriority txPriorityFor(const CoTMessage *msg);
+
+// Returns a key identifying what the given message reports on, such that
+// a newer message with the same key makes a queued older one obsolete.
+// Only position updates have such a key; for anything else the empty
+// string is returned.
+std::string txStaleKeyFor(const CoTMessage *msg);
+
+
+// Queue of outbound items split by TxPriority.  Classes are served
+// weighted round robin so that a backlog in one class delays, but does
+// not stop, the others.  Items pushed with a stale key replace any
+// still-queued item with the same key rather than queueing behind it.
+// Not thread safe; callers supply their own locking.
+template <typename T>
+class TxPriorityQueue
+{
+public:
+    struct Entry {
+        T item;
+        std::string staleKey;
+
+        Entry(const T &item, const std::string &staleKey) :
+                item(item), staleKey(staleKey) {}
+    };
+    typedef typename std::list<Entry>::iterator iterator;
+
+    TxPriorityQueue() : count(0), current(0), credit(WEIGHTS[0]), stale()
+    {
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // Queues item in class pri.  If staleKey is non-empty and an item
+    // pushed with the same key is still queued, that item is replaced in
+    // place, copied to *replaced for the caller to release, and true
+    // is returned.  replaced may be NULL if staleKey is empty.
+    bool push(const T &item, TxPriority pri, const std::string &staleKey,
+              T *replaced)
+    {
+        if (!staleKey.empty()) {
+            typename StaleMap::iterator staleIter = stale.find(staleKey);
+            if (staleIter != stale.end()) {
+                *replaced = staleIter->second->item;
+                staleIter->second->item = item;
+                return true;
+            }
+        }
+        classes[pri].push_back(Entry(item, staleKey));
+        if (!staleKey.empty())
+            stale[staleKey] = --classes[pri].end();
+        count++;
+        return false;
+    }
+
+    // Removes and returns the next item to send.  Queue must not be empty.
+    T pop()
+    {
+        while (classes[current].empty() || !credit) {
+            current = (current + 1) % TX_PRIORITY_COUNT;
+            credit = WEIGHTS[current];
+        }
+        credit--;
+        iterator iter = classes[current].begin();
+        T ret = iter->item;
+        erase(current, iter);
+        return ret;
+    }
+
+    // Iteration over the items of one class, oldest first, for in-place
+    // updates.  Use erase() to remove items while iterating.
+    iterator begin(int pri)
+    {
+        return classes[pri].begin();
+    }
+
+    iterator end(int pri)
+    {
+        return classes[pri].end();
+    }
+
+    iterator erase(int pri, iterator iter)
+    {
+        if (!iter->staleKey.empty())
+            stale.erase(iter->staleKey);
+        count--;
+        return classes[pri].erase(iter);
+    }
+
+private:
+    typedef std::map<std::string, iterator> StaleMap;
+
+    // Items taken from each class per round
+    static const size_t WEIGHTS[TX_PRIORITY_COUNT];
+
+    std::list<Entry> classes[TX_PRIORITY_COUNT];
+    size_t count;
+    int current;
+    size_t credit;
+    StaleMap stale;
+};
+
+template <typename T>
+const size_t TxPriorityQueue<T>::WEIGHTS[TX_PRIORITY_COUNT] = { 8, 4, 1 };
+
+}
+}
+}
+
+#endif /* IMPL_TXPRIORITYQUEUE_H_ */
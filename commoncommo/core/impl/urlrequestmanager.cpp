@@ -19,6 +19,12 @@ namespace {
         "urlreq.io",
         "urlreq.stat"
     };
+
+    // Transfers beyond these limits are queued by curl until a
+    // connection frees up, at which point the idle (kept-alive)
+    // connection is reused rather than a new one opened
+    const long MAX_HOST_CONNECTIONS = 6;
+    const long MAX_TOTAL_CONNECTIONS = 24;
 }
 
 URLRequestManager::URLRequestManager(CommoLogger *logger,
@@ -39,6 +45,16 @@ URLRequestManager::URLRequestManager(CommoLogger *logger,
                 providerTracker(factory)
 {
     curlMultiCtx = curl_multi_init();
+    curl_multi_setopt(curlMultiCtx, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(curlMultiCtx, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                      MAX_TOTAL_CONNECTIONS);
+    curl_multi_setopt(curlMultiCtx, CURLMOPT_MAXCONNECTS,
+                      MAX_TOTAL_CONNECTIONS);
+#ifdef CURLPIPE_MULTIPLEX
+    // Share a connection among transfers where the server speaks HTTP/2
+    curl_multi_setopt(curlMultiCtx, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
 
     startThreads();
 }
@@ -12,6 +12,7 @@
 #include "simplefileio.h"
 #include "cloudio.h"
 #include "fileioprovider.h"
+#include "commometrics.h"
 
 #include <memory>
 #include <map>
@@ -424,6 +425,13 @@ public:
     // previously obtained via getContactList().
     static void freeContactList(const ContactList *contactList);
 
+    // Obtains a snapshot of traffic counters and queue depths for this
+    // Commo instance.  Caller must release the result by passing it to
+    // freeMetrics() when done with it.
+    const CommoMetrics *getMetrics();
+    // Frees metrics previously obtained via getMetrics().
+    static void freeMetrics(const CommoMetrics *metrics);
+
 
     // Configure a "known endpoint" contact. This is 
     // a non-discoverable contact for whom we already know an endpoint.
@@ -0,0 +1,74 @@
+#ifndef COMMOMETRICS_H_
+#define COMMOMETRICS_H_
+
+
+#include "commoutils.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace atakmap {
+namespace commoncommo {
+
+
+// Traffic counters for a single network endpoint.  Counters are
+// cumulative over the life of the Commo instance; queue depths are
+// a snapshot at the time the metrics were obtained.
+struct COMMONCOMMO_API EndpointMetrics
+{
+    // Identifies the endpoint.  For streaming connections this is the
+    // StreamingNetInterface's remote endpoint id.  For inbound mesh
+    // ports it is the local port and protocol, as in "*:6969:udp".
+    // Outbound mesh traffic, which is not tied to any one port, is
+    // counted under "*:*:udp" and "*:*:tcp".
+    const char *endpointId;
+
+    uint64_t rxMessages;
+    uint64_t rxBytes;
+    uint64_t txMessages;
+    uint64_t txBytes;
+
+    // Received messages that could not be decrypted or parsed
+    uint64_t rxParseFailures;
+
+    // Streaming only: number of times the connection came back up
+    // after the first successful connection
+    uint64_t reconnects;
+
+    // Streaming SSL only: number of completed handshakes, and the
+    // duration of the most recent one and of all of them combined,
+    // in milliseconds
+    uint64_t tlsHandshakes;
+    uint64_t tlsHandshakeLastMillis;
+    uint64_t tlsHandshakeTotalMillis;
+
+    // Streaming only: messages queued for transmission
+    size_t txQueueDepth;
+};
+
+struct COMMONCOMMO_API CommoMetrics
+{
+    size_t nEndpoints;
+    const EndpointMetrics *endpoints;
+
+    // Received messages waiting to be decoded, by transport
+    size_t datagramRxQueueDepth;
+    size_t tcpRxQueueDepth;
+    size_t streamingRxQueueDepth;
+    // Outbound mesh datagrams waiting to be sent
+    size_t datagramTxQueueDepth;
+    // Decoded CoT messages waiting to be passed to CoTMessageListeners
+    size_t dispatchQueueDepth;
+
+    // Time each message spent in the dispatch queue above, in
+    // milliseconds, over all messages dispatched so far
+    uint64_t dispatchedMessages;
+    uint64_t dispatchLatencyTotalMillis;
+    uint64_t dispatchLatencyMaxMillis;
+};
+
+
+}
+}
+
+
+#endif /* COMMOMETRICS_H_ */
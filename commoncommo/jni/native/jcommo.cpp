@@ -3300,6 +3300,69 @@ Java_com_atakmap_commoncommo_Commo_getContactsNative
     return contactsRet;
 }
 
+namespace {
+    void putMetric(JNIEnv *env, jobject map, jmethodID mapPut,
+                   jclass longClass, jmethodID longValueOf,
+                   const std::string &name, uint64_t value)
+    {
+        jstring jname = env->NewStringUTF(name.c_str());
+        jobject jvalue = env->CallStaticObjectMethod(longClass, longValueOf,
+                                                     (jlong)value);
+        env->CallObjectMethod(map, mapPut, jname, jvalue);
+        env->DeleteLocalRef(jvalue);
+        env->DeleteLocalRef(jname);
+    }
+}
+
+// Returns a HashMap<String, Long> of metric name to value.  Per-endpoint
+// metrics are named "<metric>/<endpoint id>".
+JNIEXPORT jobject JNICALL
+Java_com_atakmap_commoncommo_Commo_getMetricsNative
+    (JNIEnv *env, jclass selfCls, jlong nativePtr)
+{
+    CommoJNI *c = JLONG_TO_PTR(CommoJNI, nativePtr);
+    const CommoMetrics *m = c->commo->getMetrics();
+
+    jclass hashMapClass = env->FindClass("java/util/HashMap");
+    jmethodID hashMapInit = env->GetMethodID(hashMapClass, "<init>", "()V");
+    jmethodID hashMapPut = env->GetMethodID(hashMapClass, "put",
+                                            "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
+    jclass longClass = env->FindClass("java/lang/Long");
+    jmethodID longValueOf = env->GetStaticMethodID(longClass, "valueOf",
+                                                   "(J)Ljava/lang/Long;");
+    jobject ret = env->NewObject(hashMapClass, hashMapInit);
+    if (ret) {
+#define PUT_METRIC(name, value) putMetric(env, ret, hashMapPut, longClass, longValueOf, name, value)
+        PUT_METRIC("datagramRxQueueDepth", m->datagramRxQueueDepth);
+        PUT_METRIC("tcpRxQueueDepth", m->tcpRxQueueDepth);
+        PUT_METRIC("streamingRxQueueDepth", m->streamingRxQueueDepth);
+        PUT_METRIC("datagramTxQueueDepth", m->datagramTxQueueDepth);
+        PUT_METRIC("dispatchQueueDepth", m->dispatchQueueDepth);
+        PUT_METRIC("dispatchedMessages", m->dispatchedMessages);
+        PUT_METRIC("dispatchLatencyTotalMillis", m->dispatchLatencyTotalMillis);
+        PUT_METRIC("dispatchLatencyMaxMillis", m->dispatchLatencyMaxMillis);
+        for (size_t i = 0; i < m->nEndpoints; ++i) {
+            const EndpointMetrics &ep = m->endpoints[i];
+            std::string suffix("/");
+            suffix += ep.endpointId;
+            PUT_METRIC("rxMessages" + suffix, ep.rxMessages);
+            PUT_METRIC("rxBytes" + suffix, ep.rxBytes);
+            PUT_METRIC("txMessages" + suffix, ep.txMessages);
+            PUT_METRIC("txBytes" + suffix, ep.txBytes);
+            PUT_METRIC("rxParseFailures" + suffix, ep.rxParseFailures);
+            PUT_METRIC("reconnects" + suffix, ep.reconnects);
+            PUT_METRIC("tlsHandshakes" + suffix, ep.tlsHandshakes);
+            PUT_METRIC("tlsHandshakeLastMillis" + suffix, ep.tlsHandshakeLastMillis);
+            PUT_METRIC("tlsHandshakeTotalMillis" + suffix, ep.tlsHandshakeTotalMillis);
+            PUT_METRIC("txQueueDepth" + suffix, ep.txQueueDepth);
+        }
+#undef PUT_METRIC
+    }
+    c->commo->freeMetrics(m);
+
+    return ret;
+}
+
 
 
 JNIEXPORT jboolean JNICALL
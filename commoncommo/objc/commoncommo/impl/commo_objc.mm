@@ -768,6 +768,40 @@ const int MPIO_LOCAL_PORT_DISABLE = -1;
     return objcStrings;
 }
 
+// Obtains a snapshot of runtime metrics, keyed by metric name.
+// Per-endpoint metrics are named "<metric>/<endpoint id>".
+-(NSDictionary<NSString *, NSNumber *> *) getMetrics
+{
+    const CommoMetrics *m = nativeCommo->getMetrics();
+    NSMutableDictionary<NSString *, NSNumber *> *ret = [NSMutableDictionary dictionary];
+    ret[@"datagramRxQueueDepth"] = @(m->datagramRxQueueDepth);
+    ret[@"tcpRxQueueDepth"] = @(m->tcpRxQueueDepth);
+    ret[@"streamingRxQueueDepth"] = @(m->streamingRxQueueDepth);
+    ret[@"datagramTxQueueDepth"] = @(m->datagramTxQueueDepth);
+    ret[@"dispatchQueueDepth"] = @(m->dispatchQueueDepth);
+    ret[@"dispatchedMessages"] = @(m->dispatchedMessages);
+    ret[@"dispatchLatencyTotalMillis"] = @(m->dispatchLatencyTotalMillis);
+    ret[@"dispatchLatencyMaxMillis"] = @(m->dispatchLatencyMaxMillis);
+    for (size_t i = 0; i < m->nEndpoints; ++i) {
+        const EndpointMetrics &ep = m->endpoints[i];
+        NSString *epId = [NSString stringWithUTF8String:ep.endpointId];
+#define SET_EP_METRIC(name) ret[[NSString stringWithFormat:@"%s/%@", #name, epId]] = @(ep.name)
+        SET_EP_METRIC(rxMessages);
+        SET_EP_METRIC(rxBytes);
+        SET_EP_METRIC(txMessages);
+        SET_EP_METRIC(txBytes);
+        SET_EP_METRIC(rxParseFailures);
+        SET_EP_METRIC(reconnects);
+        SET_EP_METRIC(tlsHandshakes);
+        SET_EP_METRIC(tlsHandshakeLastMillis);
+        SET_EP_METRIC(tlsHandshakeTotalMillis);
+        SET_EP_METRIC(txQueueDepth);
+#undef SET_EP_METRIC
+    }
+    nativeCommo->freeMetrics(m);
+    return ret;
+}
+
 -(::CommoResult) configKnownEndpointContactWithUid:(NSString *) uid callsign:(NSString *) callsign ipAddr:(NSString *) ipAddr port:(int) destPort
 {
     if (uid == nil)
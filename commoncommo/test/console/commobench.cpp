@@ -0,0 +1,1079 @@
+// Throughput and latency benchmark for the Commo API over loopback.
+//
+// Stands up a sending and a receiving Commo instance in one process and
+// pushes CoT between them at a fixed rate, or at a doubling rate until
+// delivery falls off to find the maximum sustained rate.  Reports
+// delivered counts, achieved rates, end to end latency percentiles and
+// process memory per step.
+//
+// Paths:
+//   tcp     sendCoTTcpDirect() into a TCP inbound interface
+//   udp     unicast broadcast interface into an inbound interface; the
+//           receiving interface's hardware address must be given with -i
+//   stream  both instances stream through a small in-process relay
+//           standing in for a TAK server; optionally over TLS (-t) and
+//           with the relay offering protobuf (-p)
+//
+// Linux/POSIX only.  Run commobench -h for options.
+
+#include "commo.h"
+#include "commologger.h"
+#include "contactuid.h"
+#include "cotmessageio.h"
+#include "netinterface.h"
+
+#include "libxml/parser.h"
+#include "openssl/ssl.h"
+#include "openssl/err.h"
+#include "openssl/pkcs12.h"
+#include "curl/curl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+
+using namespace atakmap::commoncommo;
+
+
+namespace {
+    const char CERT_PASSWORD[] = "benchpass";
+    const double RAMP_START_RATE = 250.0;
+    // A ramp step fails if more than this fraction is lost...
+    const double RAMP_MAX_LOSS = 0.01;
+    // ...or the 99th percentile latency exceeds this
+    const double RAMP_MAX_P99_MILLIS = 500.0;
+    // Time allowed after the last send of a step for stragglers
+    const int DRAIN_SECONDS = 2;
+    const int IFACE_UP_TIMEOUT_SECONDS = 15;
+    // Relay drops frames for a client whose unsent data exceeds this
+    const size_t RELAY_MAX_BACKLOG = 64 * 1024 * 1024;
+
+    const char SEQ_TAG[] = "<__bench seq=\"";
+
+    typedef enum {
+        MSG_SA,
+        MSG_CHAT,
+        MSG_ALARM,
+        MSG_KIND_COUNT
+    } MessageKind;
+
+    int64_t nowMicros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string isoTime(time_t t)
+    {
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        char buf[64];
+        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S.000Z", &tm);
+        return buf;
+    }
+
+    // Current and peak resident set size, in MiB
+    void memoryUse(double *rssMb, double *peakMb)
+    {
+        *rssMb = 0;
+        FILE *f = fopen("/proc/self/statm", "r");
+        if (f) {
+            long size, resident;
+            if (fscanf(f, "%ld %ld", &size, &resident) == 2)
+                *rssMb = resident * (double)sysconf(_SC_PAGESIZE) /
+                         (1024.0 * 1024.0);
+            fclose(f);
+        }
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        // ru_maxrss is in KiB on Linux
+        *peakMb = ru.ru_maxrss / 1024.0;
+    }
+}
+
+
+/*************************************************************************/
+// Options
+
+struct Options {
+    std::string mode;
+    int contacts;
+    double rate;
+    int seconds;
+    int port;
+    bool proto;
+    bool tls;
+    std::string hwAddr;
+    int mix[MSG_KIND_COUNT];
+    bool verbose;
+
+    Options() : mode("tcp"), contacts(10), rate(1000.0), seconds(10),
+                port(18087), proto(false), tls(false), hwAddr(),
+                verbose(false)
+    {
+        mix[MSG_SA] = 100;
+        mix[MSG_CHAT] = 0;
+        mix[MSG_ALARM] = 0;
+    }
+};
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -m tcp|udp|stream  transport to exercise (default tcp)\n"
+        "  -c N               number of simulated contacts (default 10)\n"
+        "  -r RATE            messages per second; 0 ramps up from %.0f,\n"
+        "                     doubling each step, to find the max\n"
+        "                     sustained rate (default 1000)\n"
+        "  -d SECONDS         duration of each step (default 10)\n"
+        "  -x SA,CHAT,ALARM   message mix weights (default 100,0,0)\n"
+        "  -P PORT            loopback port to use (default 18087)\n"
+        "  -i HWADDR          hex hardware address of the receiving\n"
+        "                     interface, e.g. 0a1b2c3d4e5f (udp only)\n"
+        "  -t                 use TLS (stream only)\n"
+        "  -p                 negotiate protobuf (stream only)\n"
+        "  -v                 show commo warnings and info logging\n",
+        prog, RAMP_START_RATE);
+}
+
+static bool parseOptions(int argc, char *argv[], Options *opts)
+{
+    int c;
+    while ((c = getopt(argc, argv, "m:c:r:d:x:P:i:tpvh")) != -1) {
+        switch (c) {
+        case 'm':
+            opts->mode = optarg;
+            break;
+        case 'c':
+            opts->contacts = atoi(optarg);
+            break;
+        case 'r':
+            opts->rate = atof(optarg);
+            break;
+        case 'd':
+            opts->seconds = atoi(optarg);
+            break;
+        case 'x':
+            if (sscanf(optarg, "%d,%d,%d", &opts->mix[MSG_SA],
+                       &opts->mix[MSG_CHAT], &opts->mix[MSG_ALARM]) != 3)
+                return false;
+            break;
+        case 'P':
+            opts->port = atoi(optarg);
+            break;
+        case 'i':
+            opts->hwAddr = optarg;
+            break;
+        case 't':
+            opts->tls = true;
+            break;
+        case 'p':
+            opts->proto = true;
+            break;
+        case 'v':
+            opts->verbose = true;
+            break;
+        default:
+            return false;
+        }
+    }
+    if (opts->mode != "tcp" && opts->mode != "udp" && opts->mode != "stream")
+        return false;
+    if ((opts->tls || opts->proto) && opts->mode != "stream") {
+        fprintf(stderr, "-t and -p apply to stream mode only\n");
+        return false;
+    }
+    if (opts->mode == "udp" && opts->hwAddr.length() < 2) {
+        fprintf(stderr, "udp mode needs the receiving interface (-i)\n");
+        return false;
+    }
+    if (opts->contacts < 1 || opts->seconds < 1 || opts->rate < 0 ||
+            opts->mix[MSG_SA] + opts->mix[MSG_CHAT] + opts->mix[MSG_ALARM] <= 0)
+        return false;
+    return true;
+}
+
+
+/*************************************************************************/
+// Message generation
+
+class MessageFactory
+{
+public:
+    MessageFactory(const Options &opts) : opts(opts), timeSecond(0),
+            timeStr(), staleStr()
+    {
+        int total = 0;
+        for (int i = 0; i < MSG_KIND_COUNT; ++i) {
+            total += opts.mix[i];
+            cumulative[i] = total;
+        }
+    }
+
+    // seq is embedded so the receiver can match the message to its
+    // send time
+    std::string build(uint64_t seq)
+    {
+        time_t now = time(NULL);
+        if (now != timeSecond) {
+            timeSecond = now;
+            timeStr = isoTime(now);
+            staleStr = isoTime(now + 120);
+        }
+
+        int contact = (int)(seq % opts.contacts);
+        char callsign[32];
+        snprintf(callsign, sizeof(callsign), "BENCH%d", contact);
+        char uid[96];
+        const char *type;
+        std::string detail;
+
+        switch (kindFor(seq)) {
+        case MSG_CHAT:
+            type = "b-t-f";
+            snprintf(uid, sizeof(uid), "GeoChat.bench-%d.All Chat Rooms.%" PRIu64,
+                     contact, seq);
+            detail = "<__chat chatroom=\"All Chat Rooms\" id=\"All Chat Rooms\" senderCallsign=\"";
+            detail += callsign;
+            detail += "\"><chatgrp uid0=\"bench-";
+            detail += std::to_string(contact);
+            detail += "\" uid1=\"All Chat Rooms\" id=\"All Chat Rooms\"/></__chat>"
+                      "<remarks source=\"BENCH\" time=\"";
+            detail += timeStr;
+            detail += "\">benchmark chat message</remarks>";
+            break;
+        case MSG_ALARM:
+            type = "b-a-o-tbl";
+            snprintf(uid, sizeof(uid), "bench-%d-9-1-1", contact);
+            detail = "<emergency type=\"911 Alert\">";
+            detail += callsign;
+            detail += "</emergency>";
+            break;
+        default:
+            type = "a-f-G-U-C";
+            snprintf(uid, sizeof(uid), "bench-%d", contact);
+            detail = "<contact endpoint=\"*:-1:stcp\" callsign=\"";
+            detail += callsign;
+            detail += "\"/><__group name=\"Cyan\" role=\"Team Member\"/>"
+                      "<status battery=\"100\"/>"
+                      "<track speed=\"0.0\" course=\"56.2\"/>";
+            break;
+        }
+
+        std::string s = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                        "<event version=\"2.0\" uid=\"";
+        s += uid;
+        s += "\" type=\"";
+        s += type;
+        s += "\" how=\"h-e\" time=\"";
+        s += timeStr;
+        s += "\" start=\"";
+        s += timeStr;
+        s += "\" stale=\"";
+        s += staleStr;
+        s += "\"><point lat=\"36.5261810013514\" lon=\"-77.3862509255614\" "
+             "hae=\"9999999.0\" ce=\"9999999\" le=\"9999999\"/><detail>";
+        s += detail;
+        s += SEQ_TAG;
+        s += std::to_string(seq);
+        s += "\"/></detail></event>";
+        return s;
+    }
+
+private:
+    const Options &opts;
+    int cumulative[MSG_KIND_COUNT];
+    time_t timeSecond;
+    std::string timeStr;
+    std::string staleStr;
+
+    // Deterministic spread of kinds according to the mix weights
+    MessageKind kindFor(uint64_t seq) const
+    {
+        int slot = (int)((seq * 7919) % cumulative[MSG_KIND_COUNT - 1]);
+        for (int i = 0; i < MSG_KIND_COUNT; ++i) {
+            if (slot < cumulative[i])
+                return (MessageKind)i;
+        }
+        return MSG_SA;
+    }
+};
+
+
+/*************************************************************************/
+// Commo callbacks
+
+class BenchLogger : public CommoLogger
+{
+public:
+    BenchLogger(bool verbose) : verbose(verbose) {}
+
+    virtual void log(Level level, const char *message)
+    {
+        if (level == LEVEL_ERROR || (verbose && level >= LEVEL_WARNING))
+            fprintf(stderr, "commo: %s\n", message);
+    }
+
+private:
+    bool verbose;
+};
+
+class BenchReceiver : public CoTMessageListener,
+                      public InterfaceStatusListener
+{
+public:
+    BenchReceiver() : upCount(0), mutex(), sendTimes(NULL), received(),
+                      latencies(), unmatched(0)
+    {
+    }
+
+    virtual void cotMessageReceived(const char *msg, const char *rxEndpoint)
+    {
+        int64_t now = nowMicros();
+        const char *p = strstr(msg, SEQ_TAG);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!p || !sendTimes) {
+            unmatched++;
+            return;
+        }
+        uint64_t seq = strtoull(p + sizeof(SEQ_TAG) - 1, NULL, 10);
+        if (seq >= received.size() || received[seq]) {
+            // From an earlier step, or a duplicate
+            unmatched++;
+            return;
+        }
+        received[seq] = 1;
+        latencies.push_back(now - (*sendTimes)[seq]);
+    }
+
+    virtual void interfaceUp(NetInterface *iface)
+    {
+        upCount++;
+    }
+
+    virtual void interfaceDown(NetInterface *iface)
+    {
+        upCount--;
+    }
+
+    void beginStep(const std::vector<int64_t> *times, size_t n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sendTimes = times;
+        received.assign(n, 0);
+        latencies.clear();
+        unmatched = 0;
+    }
+
+    size_t receivedCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return latencies.size();
+    }
+
+    // Ends the step, returning latencies in microseconds, sorted
+    std::vector<int64_t> endStep(size_t *nUnmatched)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sendTimes = NULL;
+        std::vector<int64_t> ret;
+        ret.swap(latencies);
+        std::sort(ret.begin(), ret.end());
+        *nUnmatched = unmatched;
+        return ret;
+    }
+
+    std::atomic<int> upCount;
+
+private:
+    std::mutex mutex;
+    const std::vector<int64_t> *sendTimes;
+    std::vector<char> received;
+    std::vector<int64_t> latencies;
+    size_t unmatched;
+};
+
+
+/*************************************************************************/
+// Loopback relay standing in for a TAK server in stream mode.
+// Forwards each complete message from one client to all the others
+// that are using the same encoding.  When offering protobuf it runs the
+// server side of TAK protocol negotiation.
+
+class RelayServer
+{
+public:
+    RelayServer(int port, SSL_CTX *sslCtx, bool offerProto) : port(port),
+            sslCtx(sslCtx), offerProto(offerProto), listenFd(-1),
+            stopFlag(false), thread(), clients(), dropped(0)
+    {
+    }
+
+    ~RelayServer()
+    {
+        stop();
+    }
+
+    bool start()
+    {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd < 0)
+            return false;
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+                listen(listenFd, 16) != 0) {
+            close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        setNonBlocking(listenFd);
+        thread = std::thread(&RelayServer::run, this);
+        return true;
+    }
+
+    void stop()
+    {
+        if (listenFd < 0)
+            return;
+        stopFlag = true;
+        thread.join();
+        for (size_t i = 0; i < clients.size(); ++i)
+            closeClient(clients[i]);
+        clients.clear();
+        close(listenFd);
+        listenFd = -1;
+    }
+
+    size_t droppedFrames() const
+    {
+        return dropped;
+    }
+
+private:
+    struct Client {
+        int fd;
+        SSL *ssl;
+        bool ready;
+        // Encoding of what this client sends / is sent
+        bool protoRx;
+        bool protoTx;
+        std::string in;
+        std::string out;
+        bool dead;
+
+        Client() : fd(-1), ssl(NULL), ready(false), protoRx(false),
+                   protoTx(false), in(), out(), dead(false) {}
+    };
+
+    const int port;
+    SSL_CTX *sslCtx;
+    const bool offerProto;
+    int listenFd;
+    std::atomic<bool> stopFlag;
+    std::thread thread;
+    std::vector<Client *> clients;
+    std::atomic<size_t> dropped;
+
+    static void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    static std::string controlMessage(const char *type, const char *body)
+    {
+        time_t now = time(NULL);
+        std::string s = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                        "<event version=\"2.0\" uid=\"benchrelay\" type=\"";
+        s += type;
+        s += "\" how=\"m-g\" time=\"";
+        s += isoTime(now);
+        s += "\" start=\"";
+        s += isoTime(now);
+        s += "\" stale=\"";
+        s += isoTime(now + 60);
+        s += "\"><point lat=\"0.0\" lon=\"0.0\" hae=\"0.0\" ce=\"999999\" "
+             "le=\"999999\"/><detail><TakControl>";
+        s += body;
+        s += "</TakControl></detail></event>";
+        return s;
+    }
+
+    void closeClient(Client *c)
+    {
+        if (c->ssl)
+            SSL_free(c->ssl);
+        close(c->fd);
+        delete c;
+    }
+
+    void clientReady(Client *c)
+    {
+        c->ready = true;
+        if (offerProto)
+            c->out += controlMessage("t-x-takp-v",
+                                     "<TakProtocolSupport version=\"1\"/>");
+    }
+
+    void acceptClients()
+    {
+        while (true) {
+            int fd = accept(listenFd, NULL, NULL);
+            if (fd < 0)
+                return;
+            setNonBlocking(fd);
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            Client *c = new Client();
+            c->fd = fd;
+            if (sslCtx) {
+                c->ssl = SSL_new(sslCtx);
+                SSL_set_fd(c->ssl, fd);
+                SSL_set_accept_state(c->ssl);
+            } else {
+                clientReady(c);
+            }
+            clients.push_back(c);
+        }
+    }
+
+    // Returns bytes read, 0 if nothing now; marks client dead on error/EOF
+    ssize_t readSome(Client *c, char *buf, size_t len)
+    {
+        if (c->ssl) {
+            int n = SSL_read(c->ssl, buf, (int)len);
+            if (n > 0)
+                return n;
+            int err = SSL_get_error(c->ssl, n);
+            if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE)
+                c->dead = true;
+            return 0;
+        }
+        ssize_t n = recv(c->fd, buf, len, 0);
+        if (n > 0)
+            return n;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            c->dead = true;
+        return 0;
+    }
+
+    void flushOut(Client *c)
+    {
+        while (!c->out.empty()) {
+            ssize_t n;
+            if (c->ssl) {
+                n = SSL_write(c->ssl, c->out.data(), (int)c->out.size());
+                if (n <= 0) {
+                    int err = SSL_get_error(c->ssl, (int)n);
+                    if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE)
+                        c->dead = true;
+                    return;
+                }
+            } else {
+                n = send(c->fd, c->out.data(), c->out.size(), MSG_NOSIGNAL);
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK)
+                        c->dead = true;
+                    return;
+                }
+            }
+            c->out.erase(0, n);
+        }
+    }
+
+    void relay(Client *from, const char *frame, size_t len)
+    {
+        for (size_t i = 0; i < clients.size(); ++i) {
+            Client *c = clients[i];
+            if (c == from || !c->ready || c->protoTx != from->protoRx)
+                continue;
+            if (c->out.size() > RELAY_MAX_BACKLOG) {
+                dropped++;
+                continue;
+            }
+            c->out.append(frame, len);
+        }
+    }
+
+    // Splits c->in into frames and handles each
+    void processInput(Client *c)
+    {
+        static const char END_TOKEN[] = "</event>";
+        size_t start = 0;
+        while (start < c->in.size()) {
+            if (!c->protoRx) {
+                size_t end = c->in.find(END_TOKEN, start);
+                if (end == std::string::npos)
+                    break;
+                end += sizeof(END_TOKEN) - 1;
+                const char *frame = c->in.data() + start;
+                size_t len = end - start;
+                std::string msg(frame, len);
+                if (msg.find("type=\"t-x-takp-q\"") != std::string::npos) {
+                    // Accept whatever version was asked for; from here on
+                    // both directions are framed protobuf
+                    c->out += controlMessage("t-x-takp-r",
+                                             "<TakResponse status=\"true\"/>");
+                    c->protoTx = true;
+                    c->protoRx = true;
+                } else {
+                    relay(c, frame, len);
+                }
+                start = end;
+            } else {
+                // 0xbf, varint length, message
+                const uint8_t *p = (const uint8_t *)c->in.data() + start;
+                size_t avail = c->in.size() - start;
+                if (p[0] != 0xbf) {
+                    c->dead = true;
+                    return;
+                }
+                uint64_t msgLen = 0;
+                size_t i = 1;
+                int shift = 0;
+                bool haveLen = false;
+                for (; i < avail && i < 11; ++i) {
+                    msgLen |= (uint64_t)(p[i] & 0x7f) << shift;
+                    shift += 7;
+                    if (!(p[i] & 0x80)) {
+                        haveLen = true;
+                        ++i;
+                        break;
+                    }
+                }
+                if (!haveLen || avail - i < msgLen)
+                    break;
+                size_t frameLen = i + (size_t)msgLen;
+                relay(c, (const char *)p, frameLen);
+                start += frameLen;
+            }
+        }
+        c->in.erase(0, start);
+    }
+
+    void run()
+    {
+        char buf[64 * 1024];
+        std::vector<struct pollfd> fds;
+        while (!stopFlag) {
+            fds.clear();
+            struct pollfd lp = { listenFd, POLLIN, 0 };
+            fds.push_back(lp);
+            for (size_t i = 0; i < clients.size(); ++i) {
+                struct pollfd cp = { clients[i]->fd, POLLIN, 0 };
+                if (!clients[i]->out.empty() || !clients[i]->ready)
+                    cp.events |= POLLOUT;
+                fds.push_back(cp);
+            }
+            if (poll(&fds[0], fds.size(), 100) < 0 && errno != EINTR)
+                break;
+
+            if (fds[0].revents & POLLIN)
+                acceptClients();
+
+            for (size_t i = 0; i < clients.size(); ++i) {
+                Client *c = clients[i];
+                if (!c->ready) {
+                    int r = SSL_accept(c->ssl);
+                    if (r == 1) {
+                        clientReady(c);
+                    } else {
+                        int err = SSL_get_error(c->ssl, r);
+                        if (err != SSL_ERROR_WANT_READ &&
+                                err != SSL_ERROR_WANT_WRITE)
+                            c->dead = true;
+                        continue;
+                    }
+                }
+                while (!c->dead) {
+                    ssize_t n = readSome(c, buf, sizeof(buf));
+                    if (n <= 0)
+                        break;
+                    c->in.append(buf, n);
+                    processInput(c);
+                }
+            }
+            for (size_t i = 0; i < clients.size(); ++i)
+                flushOut(clients[i]);
+
+            for (size_t i = 0; i < clients.size(); ) {
+                if (clients[i]->dead) {
+                    closeClient(clients[i]);
+                    clients.erase(clients.begin() + i);
+                } else {
+                    ++i;
+                }
+            }
+        }
+    }
+};
+
+
+/*************************************************************************/
+// TLS material for stream mode
+
+struct TlsMaterial {
+    std::vector<uint8_t> clientCert;
+    std::vector<uint8_t> trustStore;
+    SSL_CTX *serverCtx;
+
+    TlsMaterial() : clientCert(), trustStore(), serverCtx(NULL) {}
+    ~TlsMaterial()
+    {
+        if (serverCtx)
+            SSL_CTX_free(serverCtx);
+    }
+};
+
+// One self signed certificate serves as client cert, server cert and
+// the clients' trust store
+static bool makeTlsMaterial(Commo *commo, TlsMaterial *tls)
+{
+    uint8_t *certBuf = NULL;
+    size_t certLen = commo->generateSelfSignedCert(&certBuf, CERT_PASSWORD);
+    if (!certLen)
+        return false;
+    tls->clientCert.assign(certBuf, certBuf + certLen);
+    commo->freeSelfSignedCert(certBuf);
+
+    const unsigned char *p = &tls->clientCert[0];
+    PKCS12 *p12 = d2i_PKCS12(NULL, &p, (long)certLen);
+    EVP_PKEY *key = NULL;
+    X509 *cert = NULL;
+    if (!p12 || !PKCS12_parse(p12, CERT_PASSWORD, &key, &cert, NULL)) {
+        if (p12)
+            PKCS12_free(p12);
+        return false;
+    }
+    PKCS12_free(p12);
+
+    // Trust store: the same certificate as the sole CA entry
+    STACK_OF(X509) *cas = sk_X509_new_null();
+    sk_X509_push(cas, cert);
+    PKCS12 *ts = PKCS12_create(CERT_PASSWORD, NULL, NULL, NULL, cas,
+                               0, 0, 0, 0, 0);
+    sk_X509_free(cas);
+    bool ok = false;
+    if (ts) {
+        unsigned char *der = NULL;
+        int len = i2d_PKCS12(ts, &der);
+        if (len > 0) {
+            tls->trustStore.assign(der, der + len);
+            OPENSSL_free(der);
+            ok = true;
+        }
+        PKCS12_free(ts);
+    }
+
+    tls->serverCtx = SSL_CTX_new(TLS_server_method());
+    if (ok && tls->serverCtx) {
+        // Generated certificates are SHA-1 signed
+        SSL_CTX_set_security_level(tls->serverCtx, 0);
+        SSL_CTX_set_mode(tls->serverCtx, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                                         SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        ok = SSL_CTX_use_certificate(tls->serverCtx, cert) == 1 &&
+             SSL_CTX_use_PrivateKey(tls->serverCtx, key) == 1;
+    } else {
+        ok = false;
+    }
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ok;
+}
+
+
+/*************************************************************************/
+// Benchmark driver
+
+struct StepResult {
+    double targetRate;
+    size_t sent;
+    size_t received;
+    size_t unmatched;
+    double txRate;
+    double rxRate;
+    double p50Millis;
+    double p90Millis;
+    double p99Millis;
+    double maxMillis;
+    double rssMb;
+    double peakMb;
+};
+
+class Bench
+{
+public:
+    Bench(const Options &opts) : opts(opts), logger(opts.verbose),
+            rxUid("benchreceiver"), txUid("benchsender"),
+            rxContact((const uint8_t *)rxUid.c_str(), rxUid.length()),
+            txContact((const uint8_t *)txUid.c_str(), txUid.length()),
+            receiver(), sender(NULL), rxCommo(NULL), relay(NULL), tls(),
+            factory(opts), nextSeq(0)
+    {
+    }
+
+    ~Bench()
+    {
+        delete sender;
+        delete rxCommo;
+        delete relay;
+    }
+
+    bool setup();
+    StepResult runStep(double rate);
+
+private:
+    const Options &opts;
+    BenchLogger logger;
+    std::string rxUid;
+    std::string txUid;
+    ContactUID rxContact;
+    ContactUID txContact;
+    BenchReceiver receiver;
+    Commo *sender;
+    Commo *rxCommo;
+    RelayServer *relay;
+    TlsMaterial tls;
+    MessageFactory factory;
+    uint64_t nextSeq;
+
+    bool send(const std::string &msg);
+};
+
+bool Bench::setup()
+{
+    sender = new Commo(&logger, &txContact, "BENCHTX");
+    rxCommo = new Commo(&logger, &rxContact, "BENCHRX");
+    rxCommo->addCoTMessageListener(&receiver);
+
+    CoTMessageType types[] = { SITUATIONAL_AWARENESS, CHAT };
+    const size_t nTypes = sizeof(types) / sizeof(types[0]);
+
+    if (opts.mode == "tcp") {
+        if (!rxCommo->addTcpInboundInterface(opts.port)) {
+            fprintf(stderr, "Unable to listen on tcp port %d\n", opts.port);
+            return false;
+        }
+    } else if (opts.mode == "udp") {
+        std::vector<uint8_t> hw;
+        for (size_t i = 0; i + 1 < opts.hwAddr.length(); i += 2) {
+            unsigned int b;
+            sscanf(opts.hwAddr.c_str() + i, "%2x", &b);
+            hw.push_back((uint8_t)b);
+        }
+        HwAddress addr(&hw[0], hw.size());
+        if (!rxCommo->addInboundInterface(&addr, opts.port, NULL, 0, false)) {
+            fprintf(stderr, "Unable to add udp inbound interface\n");
+            return false;
+        }
+        if (!sender->addBroadcastInterface(types, nTypes, "127.0.0.1",
+                                           opts.port)) {
+            fprintf(stderr, "Unable to add udp broadcast interface\n");
+            return false;
+        }
+    } else {
+        if (opts.tls && !makeTlsMaterial(sender, &tls)) {
+            fprintf(stderr, "Unable to create TLS certificates\n");
+            return false;
+        }
+        relay = new RelayServer(opts.port, tls.serverCtx, opts.proto);
+        if (!relay->start()) {
+            fprintf(stderr, "Unable to start relay on port %d\n", opts.port);
+            return false;
+        }
+        Commo *both[] = { sender, rxCommo };
+        for (int i = 0; i < 2; ++i) {
+            // No pings: the relay doesn't answer them
+            both[i]->setStreamMonitorEnabled(false);
+            both[i]->addInterfaceStatusListener(&receiver);
+            CommoResult rc;
+            StreamingNetInterface *iface = both[i]->addStreamingInterface(
+                    "127.0.0.1", opts.port, types, nTypes,
+                    opts.tls ? &tls.clientCert[0] : NULL,
+                    opts.tls ? tls.clientCert.size() : 0,
+                    opts.tls ? &tls.trustStore[0] : NULL,
+                    opts.tls ? tls.trustStore.size() : 0,
+                    opts.tls ? CERT_PASSWORD : NULL,
+                    opts.tls ? CERT_PASSWORD : NULL,
+                    NULL, NULL, &rc);
+            if (!iface) {
+                fprintf(stderr, "Unable to add streaming interface (%d)\n",
+                        (int)rc);
+                return false;
+            }
+        }
+        int waited = 0;
+        while (receiver.upCount < 2) {
+            if (++waited > IFACE_UP_TIMEOUT_SECONDS * 10) {
+                fprintf(stderr, "Streams did not come up\n");
+                return false;
+            }
+            usleep(100 * 1000);
+        }
+        // Let protocol negotiation finish before measuring
+        if (opts.proto)
+            sleep(2);
+    }
+    return true;
+}
+
+bool Bench::send(const std::string &msg)
+{
+    CommoResult rc;
+    if (opts.mode == "tcp")
+        rc = sender->sendCoTTcpDirect("127.0.0.1", opts.port, msg.c_str());
+    else
+        rc = sender->broadcastCoT(msg.c_str());
+    return rc == COMMO_SUCCESS;
+}
+
+StepResult Bench::runStep(double rate)
+{
+    StepResult r;
+    memset(&r, 0, sizeof(r));
+    r.targetRate = rate;
+
+    size_t n = (size_t)(rate * opts.seconds);
+    std::vector<int64_t> sendTimes(nextSeq + n, 0);
+    receiver.beginStep(&sendTimes, sendTimes.size());
+
+    // Pace sends against the schedule rather than sleeping a fixed
+    // interval, so slow sends are caught up and show as a lower tx rate
+    int64_t start = nowMicros();
+    size_t failures = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int64_t due = start + (int64_t)(i * 1000000.0 / rate);
+        int64_t now = nowMicros();
+        if (due > now)
+            usleep((useconds_t)(due - now));
+
+        uint64_t seq = nextSeq++;
+        std::string msg = factory.build(seq);
+        sendTimes[seq] = nowMicros();
+        if (!send(msg))
+            failures++;
+    }
+    int64_t sendEnd = nowMicros();
+    r.sent = n - failures;
+
+    int64_t drainEnd = sendEnd + DRAIN_SECONDS * 1000000LL;
+    while (receiver.receivedCount() < r.sent && nowMicros() < drainEnd)
+        usleep(10 * 1000);
+    int64_t rxEnd = nowMicros();
+
+    std::vector<int64_t> lat = receiver.endStep(&r.unmatched);
+    r.received = lat.size();
+    r.txRate = r.sent / ((sendEnd - start) / 1e6);
+    r.rxRate = r.received / ((rxEnd - start) / 1e6);
+    if (!lat.empty()) {
+        r.p50Millis = lat[lat.size() * 50 / 100] / 1000.0;
+        r.p90Millis = lat[lat.size() * 90 / 100] / 1000.0;
+        r.p99Millis = lat[lat.size() * 99 / 100] / 1000.0;
+        r.maxMillis = lat.back() / 1000.0;
+    }
+    memoryUse(&r.rssMb, &r.peakMb);
+    return r;
+}
+
+static void printHeader()
+{
+    printf("%10s %9s %9s %6s %9s %9s %8s %8s %8s %8s %8s %8s\n",
+           "target/s", "sent", "received", "loss%", "tx/s", "rx/s",
+           "p50ms", "p90ms", "p99ms", "maxms", "rssMB", "peakMB");
+}
+
+static void printStep(const StepResult &r)
+{
+    double loss = r.sent ? 100.0 * (r.sent - r.received) / r.sent : 0.0;
+    printf("%10.0f %9zu %9zu %6.2f %9.0f %9.0f %8.2f %8.2f %8.2f %8.2f %8.1f %8.1f\n",
+           r.targetRate, r.sent, r.received, loss, r.txRate, r.rxRate,
+           r.p50Millis, r.p90Millis, r.p99Millis, r.maxMillis,
+           r.rssMb, r.peakMb);
+    fflush(stdout);
+}
+
+static bool stepSustained(const StepResult &r)
+{
+    if (!r.sent)
+        return false;
+    double loss = (double)(r.sent - r.received) / r.sent;
+    return loss <= RAMP_MAX_LOSS && r.p99Millis <= RAMP_MAX_P99_MILLIS &&
+           r.txRate >= 0.9 * r.targetRate;
+}
+
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    if (!parseOptions(argc, argv, &opts)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    xmlInitParser();
+    OPENSSL_init_ssl(0, NULL);
+    SSL_load_error_strings();
+    curl_global_init(CURL_GLOBAL_NOTHING);
+
+    int ret = 0;
+    {
+        Bench bench(opts);
+        printf("mode %s%s%s, %d contacts, mix sa/chat/alarm %d/%d/%d, "
+               "%d s steps\n", opts.mode.c_str(),
+               opts.tls ? " tls" : "", opts.proto ? " protobuf" : "",
+               opts.contacts, opts.mix[MSG_SA], opts.mix[MSG_CHAT],
+               opts.mix[MSG_ALARM], opts.seconds);
+        if (!bench.setup()) {
+            ret = 1;
+        } else if (opts.rate > 0) {
+            printHeader();
+            printStep(bench.runStep(opts.rate));
+        } else {
+            printHeader();
+            double best = 0;
+            for (double rate = RAMP_START_RATE; ; rate *= 2) {
+                StepResult r = bench.runStep(rate);
+                printStep(r);
+                if (!stepSustained(r))
+                    break;
+                best = rate;
+            }
+            if (best > 0)
+                printf("max sustained rate: %.0f msg/s\n", best);
+            else
+                printf("could not sustain %.0f msg/s\n", RAMP_START_RATE);
+        }
+    }
+
+    curl_global_cleanup();
+    xmlCleanupParser();
+    return ret;
+}
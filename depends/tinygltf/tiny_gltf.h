@@ -3841,8 +3841,21 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
   buffer->uri.clear();
   ParseStringProperty(&buffer->uri, err, o, "uri", false, "Buffer");
 
+  // EXT_meshopt_compression fallback buffers may have no data; their
+  // contents are decoded from compressed buffer views by the application
+  bool meshopt_fallback = false;
+  if (buffer->uri.empty()) {
+    json_const_iterator ext;
+    json_const_iterator meshopt;
+    if (FindMember(o, "extensions", ext) &&
+        FindMember(GetValue(ext), "EXT_meshopt_compression", meshopt)) {
+      ParseBooleanProperty(&meshopt_fallback, nullptr, GetValue(meshopt),
+                           "fallback", false);
+    }
+  }
+
   // having an empty uri for a non embedded image should not be valid
-  if (!is_binary && buffer->uri.empty()) {
+  if (!is_binary && buffer->uri.empty() && !meshopt_fallback) {
     if (err) {
       (*err) += "'uri' is missing from non binary glTF file buffer.\n";
     }
@@ -3858,7 +3871,9 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
     }
   }
 
-  if (is_binary) {
+  if (meshopt_fallback) {
+    // no data
+  } else if (is_binary) {
     // Still binary glTF accepts external dataURI.
     if (!buffer->uri.empty()) {
       // First try embedded data URI.
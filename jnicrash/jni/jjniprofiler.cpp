@@ -0,0 +1,502 @@
+#include "jjnicrash.h"
+
+// Sampling CPU profiler.
+//
+// Each thread in the process is given a timer on its own CPU time clock that
+// delivers SIGPROF to that thread at the requested rate. The signal handler
+// only copies the interrupted register state and the top of the stack into
+// a fixed ring of slots; it does not allocate, lock or unwind. A collector
+// thread drains the ring, unwinds each snapshot with libunwindstack and
+// aggregates identical stacks. Profiles are written in collapsed-stack
+// format (one `thread;root;...;leaf count` line per unique stack), either
+// symbolized on device or as `module+0xoffset` frames for symbolizing
+// offline against unstripped libraries.
+
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <string.h>
+#include <string>
+#include <signal.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <ucontext.h>
+#include <cxxabi.h>
+#include <android/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <unwindstack/Elf.h>
+#include <unwindstack/MapInfo.h>
+#include <unwindstack/Maps.h>
+#include <unwindstack/Memory.h>
+#include <unwindstack/Regs.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+// Per-thread CPU time clock, as computed by pthread_getcpuclockid
+#define THREAD_CPUCLOCK(tid) ((~(clockid_t)(tid) << 3) | 6)
+
+// Bytes of stack captured from the interrupted stack pointer
+#define STACK_SNAPSHOT_SIZE (16 * 1024)
+// Stack reads beyond the snapshot but within this distance of the stack
+// pointer are assumed to be stack and are not read from live memory
+#define STACK_REGION_SIZE (8 * 1024 * 1024)
+#define SAMPLE_SLOTS 64
+#define MAX_FRAMES 64
+
+#define MIN_SAMPLE_RATE 1
+#define MAX_SAMPLE_RATE 1000
+
+#define PROFILER_TAG "JNIProfiler"
+
+namespace {
+    enum SlotState {
+        SLOT_FREE,
+        SLOT_WRITING,
+        SLOT_READY,
+    };
+
+    struct SampleSlot {
+        std::atomic<int> state;
+        pid_t tid;
+        ucontext_t context;
+        uint64_t sp;
+        size_t stack_len;
+        uint8_t stack[STACK_SNAPSHOT_SIZE];
+    };
+
+    typedef std::pair<std::string, std::vector<uint64_t> > StackKey;
+
+    SampleSlot *sample_slots = NULL;
+    std::atomic<unsigned> next_slot(0u);
+    std::atomic<bool> sampling(false);
+    std::atomic<uint64_t> dropped_samples(0u);
+    bool sighandler_installed = false;
+
+    pthread_mutex_t profiler_lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_t collector_thread;
+    bool collector_running = false;
+    volatile bool collector_stop = false;
+    pid_t collector_tid = 0;
+    long sample_interval_ns = 0;
+
+    // guarded by profiler_lock
+    std::map<pid_t, timer_t> thread_timers;
+    std::map<pid_t, std::string> thread_names;
+    std::map<StackKey, uint64_t> stacks;
+    std::unique_ptr<unwindstack::LocalMaps> maps;
+    std::shared_ptr<unwindstack::Memory> process_memory;
+
+    pid_t current_tid()
+    {
+        return (pid_t)syscall(__NR_gettid);
+    }
+
+    uint64_t context_sp(const ucontext_t *uc)
+    {
+#if defined(__aarch64__)
+        return uc->uc_mcontext.sp;
+#elif defined(__arm__)
+        return uc->uc_mcontext.arm_sp;
+#elif defined(__x86_64__)
+        return uc->uc_mcontext.gregs[REG_RSP];
+#elif defined(__i386__)
+        return uc->uc_mcontext.gregs[REG_ESP];
+#else
+        return 0;
+#endif
+    }
+
+    // Async-signal-safe copy from our own address space that stops at the
+    // first unmapped page rather than faulting.
+    size_t safe_read(uint64_t addr, uint8_t *dst, size_t len)
+    {
+        const uint64_t page = 4096;
+        struct iovec local_iov;
+        struct iovec remote_iovs[STACK_SNAPSHOT_SIZE / 4096 + 1];
+        size_t n = 0;
+        uint64_t cur = addr;
+        while (cur < addr + len && n < sizeof(remote_iovs) / sizeof(remote_iovs[0])) {
+            const uint64_t end = std::min<uint64_t>((cur & ~(page - 1)) + page, addr + len);
+            remote_iovs[n].iov_base = (void *)(uintptr_t)cur;
+            remote_iovs[n].iov_len = (size_t)(end - cur);
+            cur = end;
+            n++;
+        }
+        local_iov.iov_base = dst;
+        local_iov.iov_len = len;
+        const ssize_t r = syscall(__NR_process_vm_readv, getpid(), &local_iov, 1, remote_iovs, n, 0);
+        return (r > 0) ? (size_t)r : 0;
+    }
+
+    void profsig(int sig, siginfo_t *si, void *arg)
+    {
+        if (!sampling.load(std::memory_order_relaxed) || !arg)
+            return;
+        const int saved_errno = errno;
+
+        SampleSlot &slot = sample_slots[next_slot.fetch_add(1u, std::memory_order_relaxed) % SAMPLE_SLOTS];
+        int expected = SLOT_FREE;
+        if (!slot.state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acquire)) {
+            // collector has fallen behind
+            dropped_samples.fetch_add(1u, std::memory_order_relaxed);
+            errno = saved_errno;
+            return;
+        }
+
+        slot.tid = current_tid();
+        memcpy(&slot.context, arg, sizeof(ucontext_t));
+        slot.sp = context_sp(&slot.context);
+        slot.stack_len = slot.sp ? safe_read(slot.sp, slot.stack, STACK_SNAPSHOT_SIZE) : 0;
+        slot.state.store(SLOT_READY, std::memory_order_release);
+
+        errno = saved_errno;
+    }
+
+    // Process memory as seen at the time of the sample: stack reads are
+    // served from the snapshot, everything else from live memory.
+    class StackSnapshotMemory : public unwindstack::Memory {
+    public:
+        StackSnapshotMemory(unwindstack::Memory *process_, const SampleSlot &slot_) :
+            process(process_),
+            slot(slot_)
+        {}
+        size_t Read(uint64_t addr, void *dst, size_t size) override
+        {
+            if (addr >= slot.sp && addr < slot.sp + STACK_REGION_SIZE) {
+                if (addr >= slot.sp + slot.stack_len)
+                    return 0;
+                const size_t n = std::min<size_t>(size, (size_t)(slot.sp + slot.stack_len - addr));
+                memcpy(dst, slot.stack + (addr - slot.sp), n);
+                return n;
+            }
+            return process->Read(addr, dst, size);
+        }
+    private:
+        unwindstack::Memory *process;
+        const SampleSlot &slot;
+    };
+
+    // requires profiler_lock
+    bool unwind_sample(std::vector<uint64_t> &pcs, const SampleSlot &slot, bool &maps_refreshed)
+    {
+        std::unique_ptr<unwindstack::Regs> regs(unwindstack::Regs::CreateFromUcontext(
+                unwindstack::Regs::CurrentArch(),
+                (void *)&slot.context));
+        if (!regs)
+            return false;
+
+        StackSnapshotMemory memory(process_memory.get(), slot);
+        while (pcs.size() < MAX_FRAMES) {
+            const uint64_t pc = regs->pc();
+            unwindstack::MapInfo *map_info = maps->Find(pc);
+            if (!map_info && !maps_refreshed) {
+                // library loaded since the maps were last parsed
+                std::unique_ptr<unwindstack::LocalMaps> refreshed(new unwindstack::LocalMaps());
+                if (refreshed->Parse())
+                    maps = std::move(refreshed);
+                maps_refreshed = true;
+                map_info = maps->Find(pc);
+            }
+            pcs.push_back(pc);
+            if (!map_info)
+                break;
+            unwindstack::Elf *const elf = map_info->GetElf(process_memory, false);
+            if (!elf)
+                break;
+
+            const uint64_t rel_pc = elf->GetRelPc(pc, map_info);
+            uint64_t adjusted_rel_pc = rel_pc;
+            if (pcs.size() > 1)
+                adjusted_rel_pc -= regs->GetPcAdjustment(rel_pc, elf);
+
+            bool finished = false;
+            if (!elf->Step(rel_pc, adjusted_rel_pc, map_info->elf_offset, regs.get(),
+                           &memory, &finished) || finished)
+                break;
+        }
+        return !pcs.empty();
+    }
+
+    void read_thread_name(std::string &name, pid_t tid)
+    {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%d/comm", (int)tid);
+        char buf[32];
+        FILE *f = fopen(path, "r");
+        if (f) {
+            if (fgets(buf, sizeof(buf), f)) {
+                buf[strcspn(buf, "\n")] = '\0';
+                name = buf;
+            }
+            fclose(f);
+        }
+        if (name.empty()) {
+            snprintf(buf, sizeof(buf), "thread-%d", (int)tid);
+            name = buf;
+        }
+        // ';' delimits frames in collapsed stacks
+        for (size_t i = 0; i < name.length(); i++)
+            if (name[i] == ';' || name[i] == ' ')
+                name[i] = '_';
+    }
+
+    // requires profiler_lock. Starts timers on new threads and releases
+    // those of exited threads.
+    void scan_threads()
+    {
+        std::set<pid_t> live;
+        DIR *dir = opendir("/proc/self/task");
+        if (!dir)
+            return;
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            const pid_t tid = (pid_t)atoi(entry->d_name);
+            if (tid <= 0 || tid == collector_tid)
+                continue;
+            live.insert(tid);
+            if (thread_timers.find(tid) != thread_timers.end())
+                continue;
+
+            struct sigevent sev;
+            memset(&sev, 0, sizeof(sev));
+            sev.sigev_notify = SIGEV_THREAD_ID;
+            sev.sigev_signo = SIGPROF;
+            sev.sigev_notify_thread_id = tid;
+            timer_t timer;
+            if (timer_create(THREAD_CPUCLOCK(tid), &sev, &timer) != 0)
+                continue;
+            struct itimerspec its;
+            its.it_interval.tv_sec = sample_interval_ns / 1000000000L;
+            its.it_interval.tv_nsec = sample_interval_ns % 1000000000L;
+            its.it_value = its.it_interval;
+            if (timer_settime(timer, 0, &its, NULL) != 0) {
+                timer_delete(timer);
+                continue;
+            }
+            thread_timers[tid] = timer;
+            read_thread_name(thread_names[tid], tid);
+        }
+        closedir(dir);
+
+        for (std::map<pid_t, timer_t>::iterator it = thread_timers.begin(); it != thread_timers.end();) {
+            if (live.find(it->first) == live.end()) {
+                timer_delete(it->second);
+                thread_timers.erase(it++);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    // requires profiler_lock
+    void drain_samples()
+    {
+        // reparse the maps at most once per pass
+        bool maps_refreshed = false;
+        for (size_t i = 0; i < SAMPLE_SLOTS; i++) {
+            SampleSlot &slot = sample_slots[i];
+            if (slot.state.load(std::memory_order_acquire) != SLOT_READY)
+                continue;
+
+            StackKey key;
+            if (unwind_sample(key.second, slot, maps_refreshed)) {
+                std::map<pid_t, std::string>::const_iterator name = thread_names.find(slot.tid);
+                if (name != thread_names.end())
+                    key.first = name->second;
+                else
+                    read_thread_name(key.first, slot.tid);
+                stacks[key]++;
+            }
+            slot.state.store(SLOT_FREE, std::memory_order_release);
+        }
+    }
+
+    void *collector_main(void *)
+    {
+        collector_tid = current_tid();
+
+        // drain often enough that the ring does not overflow at the
+        // highest rate, rescan for new threads about once a second
+        const long drain_interval_ns = 5000000L;
+        unsigned ticks = 0;
+        while (!collector_stop) {
+            pthread_mutex_lock(&profiler_lock);
+            if ((ticks++ % 200u) == 0u)
+                scan_threads();
+            drain_samples();
+            pthread_mutex_unlock(&profiler_lock);
+
+            struct timespec ts;
+            ts.tv_sec = 0;
+            ts.tv_nsec = drain_interval_ns;
+            nanosleep(&ts, NULL);
+        }
+
+        pthread_mutex_lock(&profiler_lock);
+        for (std::map<pid_t, timer_t>::iterator it = thread_timers.begin(); it != thread_timers.end(); it++)
+            timer_delete(it->second);
+        thread_timers.clear();
+        drain_samples();
+        pthread_mutex_unlock(&profiler_lock);
+        return NULL;
+    }
+
+    const char *base_name(const std::string &path)
+    {
+        const size_t sep = path.find_last_of('/');
+        return path.c_str() + ((sep == std::string::npos) ? 0 : sep + 1);
+    }
+
+    // requires profiler_lock
+    void write_frame(FILE *f, uint64_t pc, bool caller, bool symbolize)
+    {
+        unwindstack::MapInfo *const map_info = maps->Find(pc);
+        unwindstack::Elf *const elf = map_info ? map_info->GetElf(process_memory, false) : NULL;
+        if (!elf) {
+            fprintf(f, "[unknown]+0x%llx", (unsigned long long)pc);
+            return;
+        }
+        // return addresses resolve to the call instruction
+        const uint64_t rel_pc = elf->GetRelPc(pc, map_info) - (caller ? 1 : 0);
+        std::string name;
+        uint64_t offset;
+        if (symbolize && elf->GetFunctionName(rel_pc, &name, &offset)) {
+            int status = -1;
+            char *demangled = abi::__cxa_demangle(name.c_str(), NULL, NULL, &status);
+            fputs((status == 0 && demangled) ? demangled : name.c_str(), f);
+            free(demangled);
+        } else {
+            fprintf(f, "%s+0x%llx", map_info->name.empty() ? "[anon]" : base_name(map_info->name), (unsigned long long)rel_pc);
+        }
+    }
+
+    bool write_collapsed(const char *path, bool symbolize)
+    {
+        FILE *f = fopen(path, "w");
+        if (!f)
+            return false;
+        for (std::map<StackKey, uint64_t>::const_iterator it = stacks.begin(); it != stacks.end(); it++) {
+            fputs(it->first.first.c_str(), f);
+            const std::vector<uint64_t> &pcs = it->first.second;
+            for (size_t i = pcs.size(); i > 0; i--) {
+                fputc(';', f);
+                write_frame(f, pcs[i - 1], (i - 1) > 0, symbolize);
+            }
+            fprintf(f, " %llu\n", (unsigned long long)it->second);
+        }
+        const bool ok = !ferror(f);
+        return (fclose(f) == 0) && ok;
+    }
+}
+
+extern "C" {
+
+JNIEXPORT jboolean JNICALL Java_com_atakmap_jnicrash_JNICrash_startProfiler
+  (JNIEnv *env, jclass selfCls, jint samplesPerSecond)
+{
+    if (samplesPerSecond < MIN_SAMPLE_RATE || samplesPerSecond > MAX_SAMPLE_RATE)
+        return JNI_FALSE;
+
+    pthread_mutex_lock(&profiler_lock);
+    if (collector_running) {
+        pthread_mutex_unlock(&profiler_lock);
+        return JNI_FALSE;
+    }
+
+    if (!sample_slots)
+        sample_slots = new SampleSlot[SAMPLE_SLOTS];
+    // discard samples that arrived after the previous run was collected
+    for (size_t i = 0; i < SAMPLE_SLOTS; i++)
+        sample_slots[i].state.store(SLOT_FREE, std::memory_order_relaxed);
+    if (!process_memory)
+        process_memory.reset(new unwindstack::MemoryLocal());
+    maps.reset(new unwindstack::LocalMaps());
+    if (!maps->Parse()) {
+        pthread_mutex_unlock(&profiler_lock);
+        return JNI_FALSE;
+    }
+
+    // the handler is never uninstalled; signals from timers deleted
+    // while a sample is pending must not take the default action
+    if (!sighandler_installed) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(struct sigaction));
+        sigemptyset(&sa.sa_mask);
+        sa.sa_sigaction = profsig;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+        if (sigaction(SIGPROF, &sa, NULL) != 0) {
+            pthread_mutex_unlock(&profiler_lock);
+            return JNI_FALSE;
+        }
+        sighandler_installed = true;
+    }
+
+    stacks.clear();
+    thread_names.clear();
+    dropped_samples.store(0u);
+    sample_interval_ns = 1000000000L / samplesPerSecond;
+    collector_stop = false;
+    sampling.store(true);
+    collector_running = (pthread_create(&collector_thread, NULL, collector_main, NULL) == 0);
+    if (!collector_running)
+        sampling.store(false);
+    pthread_mutex_unlock(&profiler_lock);
+    return collector_running ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_atakmap_jnicrash_JNICrash_stopProfiler
+  (JNIEnv *env, jclass selfCls)
+{
+    pthread_mutex_lock(&profiler_lock);
+    const bool running = collector_running;
+    collector_stop = true;
+    pthread_mutex_unlock(&profiler_lock);
+    if (!running)
+        return;
+
+    sampling.store(false);
+    pthread_join(collector_thread, NULL);
+
+    pthread_mutex_lock(&profiler_lock);
+    collector_running = false;
+    const uint64_t dropped = dropped_samples.load();
+    if (dropped)
+        __android_log_print(ANDROID_LOG_WARN, PROFILER_TAG, "%llu samples dropped", (unsigned long long)dropped);
+    pthread_mutex_unlock(&profiler_lock);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_atakmap_jnicrash_JNICrash_writeProfile
+  (JNIEnv *env, jclass selfCls, jstring jpath, jboolean symbolize)
+{
+    // NULL will crash the VM
+    if (jpath == NULL)
+        return JNI_FALSE;
+
+    const char *path = env->GetStringUTFChars(jpath, NULL);
+    if (!path)
+        return JNI_FALSE;
+
+    pthread_mutex_lock(&profiler_lock);
+    const bool ok = maps && write_collapsed(path, symbolize == JNI_TRUE);
+    pthread_mutex_unlock(&profiler_lock);
+
+    env->ReleaseStringUTFChars(jpath, path);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+} // end extern "C"
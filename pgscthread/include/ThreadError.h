@@ -13,7 +13,9 @@ namespace PGSC {
             Thread_IllegalState,
             Thread_Interrupted,
             Thread_TimedOut,
-            Thread_Done
+            Thread_Done,
+            /** The operation was refused due to lack of capacity */
+            Thread_Busy
         };
     
         template<class Iface, class Impl = Iface>
@@ -1,35 +1,92 @@
 #ifndef PGSCTHREAD_THREADPOOL_H_INCLUDED
 #define PGSCTHREAD_THREADPOOL_H_INCLUDED
 
+#include <deque>
 #include <set>
 #include "ThreadPlatform.h"
 #include "ThreadError.h"
+#include "Monitor.h"
 #include "Mutex.h"
 #include "Thread.h"
 #include "Lock.h"
 
 namespace PGSC {
     namespace Thread {
+
+        /**
+         * Behavior of a bounded ThreadPool when a task is queued while
+         * the queue is at capacity.
+         */
+        enum ThreadPoolOverflowPolicy
+        {
+            /** The producer blocks until capacity is available */
+            TEPO_Block,
+            /** The oldest queued task is discarded to make room */
+            TEPO_DropOldest,
+            /** The new task is rejected with Thread_Busy */
+            TEPO_Reject,
+        };
+
         class PGSCTHREAD_API ThreadPool{
+            struct Task
+            {
+                void (*run)(void *);
+                void (*discard)(void *);
+                void *opaque;
+            };
+
             std::set<PGSC::Thread::ThreadPtr> threads;
             PGSC::Thread::Mutex threadsMutex;
+
+            PGSC::Thread::Monitor queueMonitor;
+            std::deque<Task> queue;
+            std::size_t queueCapacity;
+            ThreadPoolOverflowPolicy overflowPolicy;
+            bool queued;
+            bool shutdown;
         private:
             ThreadPool() PGSCT_NOTHROWS;
         public :
             ~ThreadPool() PGSCT_NOTHROWS;
         public :
 	    /**
-	     * Detaches all threads.
+	     * Detaches all threads. Threads servicing a queued pool reference
+	     * the pool; it must outlive them.
 	     *
 	     * @return  Thread_Ok on success, various codes on failure
 	     */
             PGSC::Util::ThreadErr detachAll() PGSCT_NOTHROWS;
 	    /**
-	     * Joins all threads.
+	     * Joins all threads. For a queued pool, tasks already queued are
+	     * run before the threads exit; no new tasks are accepted.
 	     *
 	     * @return  Thread_Ok on success, various codes on failure.
 	     */
             PGSC::Util::ThreadErr joinAll() PGSCT_NOTHROWS;
+	    /**
+	     * Queues a task for execution on the pool. Only valid for pools
+	     * created with a queue.
+	     *
+	     * @param run       The task function
+	     * @param opaque    The data passed to `run` and `discard`
+	     * @param discard   If non-NULL, invoked in place of `run` if the
+	     *                  task is dropped by the TEPO_DropOldest policy
+	     *
+	     * @return  Thread_Ok on success, Thread_Busy if the queue is at
+	     *          capacity and the policy is TEPO_Reject,
+	     *          Thread_IllegalState if the pool is not queued or is
+	     *          shutting down, various codes on failure
+	     */
+            PGSC::Util::ThreadErr queueTask(void (*run)(void *), void *opaque, void (*discard)(void *) = NULL) PGSCT_NOTHROWS;
+	    /**
+	     * Returns the number of tasks queued and not yet started.
+	     */
+            std::size_t getQueueDepth() PGSCT_NOTHROWS;
+	    /**
+	     * Returns the maximum number of queued tasks, or zero if the
+	     * queue is unbounded.
+	     */
+            std::size_t getQueueCapacity() const PGSCT_NOTHROWS;
         private :
 	    /**
 	     * Initializes the thread pool.
@@ -41,14 +98,32 @@ namespace PGSC {
 	     * @return  Thread_Ok on success, various codes on failure
 	     */
             PGSC::Util::ThreadErr initPool(const std::size_t threadCount, void *(*entry)(void *), void* threadData) PGSCT_NOTHROWS;
+            PGSC::Util::ThreadErr stopQueue() PGSCT_NOTHROWS;
+            static void *queueEntry(void *opaque);
         private :
             friend PGSCTHREAD_API Util::ThreadErr ThreadPool_create(std::unique_ptr<ThreadPool, void(*)(const ThreadPool *)> &, const std::size_t, void *(*entry)(void *), void*) PGSCT_NOTHROWS;;
+            friend PGSCTHREAD_API Util::ThreadErr ThreadPool_create(std::unique_ptr<ThreadPool, void(*)(const ThreadPool *)> &, const std::size_t, const std::size_t, const ThreadPoolOverflowPolicy) PGSCT_NOTHROWS;
         }; // Close Class ThreadPool
 
         typedef std::unique_ptr<ThreadPool, void(*)(const ThreadPool *)> ThreadPoolPtr;
 
         PGSCTHREAD_API Util::ThreadErr ThreadPool_create(ThreadPoolPtr &value, const std::size_t threadCount, void *(*entry)(void *), void* threadData) PGSCT_NOTHROWS;
 
+        /**
+         * Creates a thread pool that services a task queue. Tasks are
+         * submitted via ThreadPool::queueTask.
+         *
+         * @param value             Returns the pool
+         * @param threadCount       The number of threads in the pool
+         * @param queueCapacity     The maximum number of queued tasks, or
+         *                          zero for an unbounded queue
+         * @param overflowPolicy    The behavior when a task is queued
+         *                          while the queue is at capacity
+         *
+         * @return  Thread_Ok on success, various codes on failure
+         */
+        PGSCTHREAD_API Util::ThreadErr ThreadPool_create(ThreadPoolPtr &value, const std::size_t threadCount, const std::size_t queueCapacity, const ThreadPoolOverflowPolicy overflowPolicy = TEPO_Block) PGSCT_NOTHROWS;
+
     } // Close Namespace Thread
 } // Close Namespace TAK
 #endif
@@ -5,7 +5,11 @@ using namespace PGSC::Thread;
 using namespace PGSC::Thread::Impl;
 using namespace PGSC::Util;
 
-ThreadPool::ThreadPool() PGSCT_NOTHROWS
+ThreadPool::ThreadPool() PGSCT_NOTHROWS :
+    queueCapacity(0u),
+    overflowPolicy(TEPO_Block),
+    queued(false),
+    shutdown(false)
 {
 }
 ThreadPool::~ThreadPool() PGSCT_NOTHROWS
@@ -16,6 +20,9 @@ ThreadErr ThreadPool::detachAll() PGSCT_NOTHROWS
 {
     ThreadErr rc(Thread_Ok);
 
+    rc = stopQueue();
+    THREAD_CHECKRETURN_CODE(rc);
+
     LockPtr lock(NULL, NULL);
     rc = Lock_create(lock, threadsMutex);
     THREAD_CHECKRETURN_CODE(rc);
@@ -34,6 +41,10 @@ ThreadErr ThreadPool::detachAll() PGSCT_NOTHROWS
 ThreadErr ThreadPool::joinAll() PGSCT_NOTHROWS
 {
     ThreadErr code(Thread_Ok);
+
+    code = stopQueue();
+    THREAD_CHECKRETURN_CODE(code);
+
     LockPtr lock(NULL, NULL);
     code = Lock_create(lock, threadsMutex);
     THREAD_CHECKRETURN_CODE(code);
@@ -68,6 +79,121 @@ ThreadErr ThreadPool::initPool(const std::size_t threadCount, void *(*entry)(voi
 
     return code;
 }
+ThreadErr ThreadPool::queueTask(void (*run)(void *), void *opaque, void (*discard)(void *)) PGSCT_NOTHROWS
+{
+    ThreadErr code(Thread_Ok);
+    if (!run)
+        return Thread_Err;
+
+    Task dropped;
+    dropped.discard = NULL;
+    {
+        MonitorLockPtr lock(NULL, NULL);
+        code = MonitorLock_create(lock, queueMonitor);
+        THREAD_CHECKRETURN_CODE(code);
+
+        if (!queued || shutdown)
+            return Thread_IllegalState;
+
+        if (queueCapacity && queue.size() >= queueCapacity) {
+            switch (overflowPolicy) {
+            case TEPO_Block :
+                while (!shutdown && queue.size() >= queueCapacity) {
+                    code = lock->wait();
+                    if (code == Thread_Interrupted)
+                        code = Thread_Ok;
+                    THREAD_CHECKBREAK_CODE(code);
+                }
+                THREAD_CHECKRETURN_CODE(code);
+                if (shutdown)
+                    return Thread_IllegalState;
+                break;
+            case TEPO_DropOldest :
+                dropped = queue.front();
+                queue.pop_front();
+                break;
+            case TEPO_Reject :
+            default :
+                return Thread_Busy;
+            }
+        }
+
+        Task task;
+        task.run = run;
+        task.discard = discard;
+        task.opaque = opaque;
+        queue.push_back(task);
+
+        // producers and workers share the monitor; wake everyone so that
+        // a blocked producer cannot absorb the signal meant for a worker
+        code = lock->broadcast();
+        THREAD_CHECKRETURN_CODE(code);
+    }
+
+    // discard outside of the lock
+    if (dropped.discard)
+        dropped.discard(dropped.opaque);
+
+    return code;
+}
+std::size_t ThreadPool::getQueueDepth() PGSCT_NOTHROWS
+{
+    MonitorLockPtr lock(NULL, NULL);
+    if (MonitorLock_create(lock, queueMonitor) != Thread_Ok)
+        return 0u;
+    return queue.size();
+}
+std::size_t ThreadPool::getQueueCapacity() const PGSCT_NOTHROWS
+{
+    return queueCapacity;
+}
+ThreadErr ThreadPool::stopQueue() PGSCT_NOTHROWS
+{
+    ThreadErr code(Thread_Ok);
+    if (!queued)
+        return code;
+
+    MonitorLockPtr lock(NULL, NULL);
+    code = MonitorLock_create(lock, queueMonitor);
+    THREAD_CHECKRETURN_CODE(code);
+
+    shutdown = true;
+    code = lock->broadcast();
+    THREAD_CHECKRETURN_CODE(code);
+
+    return code;
+}
+void *ThreadPool::queueEntry(void *opaque)
+{
+    ThreadPool &pool = *static_cast<ThreadPool *>(opaque);
+    while (true) {
+        Task task;
+        {
+            MonitorLockPtr lock(NULL, NULL);
+            if (MonitorLock_create(lock, pool.queueMonitor) != Thread_Ok)
+                break;
+
+            // queued tasks are drained before exiting on shutdown
+            while (pool.queue.empty() && !pool.shutdown) {
+                const ThreadErr code = lock->wait();
+                if (code != Thread_Ok && code != Thread_Interrupted)
+                    return NULL;
+            }
+            if (pool.queue.empty())
+                break;
+
+            task = pool.queue.front();
+            pool.queue.pop_front();
+
+            // capacity is available for blocked producers
+            if (pool.queueCapacity && pool.overflowPolicy == TEPO_Block)
+                lock->broadcast();
+        }
+
+        task.run(task.opaque);
+    }
+    return NULL;
+}
 
 PGSCTHREAD_API ThreadErr PGSC::Thread::ThreadPool_create(ThreadPoolPtr &value, const std::size_t threadCount, void *(*entry)(void *), void* threadData) PGSCT_NOTHROWS
 {
@@ -79,3 +205,19 @@ PGSCTHREAD_API ThreadErr PGSC::Thread::ThreadPool_create(ThreadPoolPtr &value, c
     value = std::move(pool);
     return code;
 }
+PGSCTHREAD_API ThreadErr PGSC::Thread::ThreadPool_create(ThreadPoolPtr &value, const std::size_t threadCount, const std::size_t queueCapacity, const ThreadPoolOverflowPolicy overflowPolicy) PGSCT_NOTHROWS
+{
+    ThreadErr code(Thread_Ok);
+    if (!threadCount)
+        return Thread_Err;
+
+    ThreadPoolPtr pool(new ThreadPool(), Memory_deleter_const<ThreadPool>);
+    pool->queueCapacity = queueCapacity;
+    pool->overflowPolicy = overflowPolicy;
+    pool->queued = true;
+    code = pool->initPool(threadCount, ThreadPool::queueEntry, pool.get());
+    THREAD_CHECKRETURN_CODE(code);
+
+    value = std::move(pool);
+    return code;
+}
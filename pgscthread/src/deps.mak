@@ -27,6 +27,7 @@ deps_RWMutex_h                     = $(deps_ThreadPlatform_h)                \
                                      $(deps_ThreadError_h)                   \
                                      $(PUBINCDIR)/RWMutex.h
 deps_ThreadPool_h                  = $(deps_ThreadPlatform_h)                \
+                                     $(deps_Monitor_h)                       \
                                      $(deps_Mutex_h)                         \
                                      $(deps_Thread_h)                        \
                                      $(deps_Lock_h)                          \
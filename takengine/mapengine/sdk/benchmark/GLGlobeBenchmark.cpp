@@ -0,0 +1,1110 @@
+// Headless GLGlobe rendering benchmark.
+//
+// Builds a GLGlobe over synthetic content (point tracks, polylines, an
+// imagery pyramid and a terrain source), replays a scripted camera path and
+// reports the CPU/GPU cost of each render phase plus heap allocation counts
+// as tab separated lines suitable for diffing between engine releases.
+//
+// When the engine is configured with `TAKENGINE_BENCHMARK_GL_STUB` it links
+// the no-op GL shim in `gl/stub`, every GL call is a no-op and the numbers
+// isolate engine CPU cost. Otherwise the harness is built with
+// `TE_BENCHMARK_EGL` and the frames are rendered into an offscreen EGL
+// pbuffer on the host driver.
+//
+// Usage:
+//   GLGlobeBenchmark [--points N] [--lines N] [--line-vertices N]
+//                    [--imagery-levels N] [--no-terrain] [--frames N]
+//                    [--warmup N] [--width N] [--height N] [--path FILE]
+//                    [--recording FILE] [--fps N]
+//
+// The camera path file contains one keyframe per line,
+//   latitude longitude resolution azimuth tilt frames
+// where `frames` is the number of frames over which the camera is
+// interpolated from the previous keyframe. Lines starting with '#' are
+// ignored.
+//
+// Alternatively, `--recording` replays a `MapViewRecorder` capture, such as
+// one taken on a device, advancing replay time by a fixed 1/fps seconds per
+// frame; `--frames` is then ignored and the run lasts for the duration of
+// the recording.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef TE_BENCHMARK_EGL
+// headless; keep Xlib macros out of the engine headers
+#ifndef EGL_NO_X11
+#define EGL_NO_X11
+#endif
+#include <EGL/egl.h>
+#endif
+#include <GLES3/gl3.h>
+
+#include "core/AbstractLayer2.h"
+#include "core/AtakMapView.h"
+#include "core/GeoPoint.h"
+#include "core/GeoPoint2.h"
+#include "core/LegacyAdapters.h"
+#include "core/MapViewRecorder.h"
+#include "core/RenderContext.h"
+#include "core/RenderSurface.h"
+#include "elevation/ElevationChunkCursor.h"
+#include "elevation/ElevationChunkFactory.h"
+#include "elevation/ElevationData.h"
+#include "elevation/ElevationSource.h"
+#include "elevation/ElevationSourceManager.h"
+#include "feature/FeatureDataStore2.h"
+#include "feature/LineString.h"
+#include "feature/LineString2.h"
+#include "feature/Point.h"
+#include "feature/Polygon2.h"
+#include "feature/RuntimeFeatureDataStore2.h"
+#include "feature/Style.h"
+#include "port/String.h"
+#include "raster/ImageDatasetDescriptor.h"
+#include "raster/tilematrix/TileMatrix.h"
+#include "renderer/Bitmap2.h"
+#include "renderer/core/GLDiagnostics.h"
+#include "renderer/core/GLGlobe.h"
+#include "renderer/core/GLGlobeReplay.h"
+#include "renderer/core/GLLayerFactory2.h"
+#include "renderer/core/GLLayerSpi2.h"
+#include "renderer/core/GLMapRenderGlobals.h"
+#include "renderer/feature/GLBatchGeometryFeatureDataStoreRenderer2.h"
+#include "renderer/raster/tilematrix/GLTileMatrixLayer.h"
+#include "util/AttributeSet.h"
+#include "util/DataInput2.h"
+#include "util/MemoryAccounting.h"
+
+using namespace TAK::Engine;
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Elevation;
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Raster::TileMatrix;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Renderer::Core;
+using namespace TAK::Engine::Renderer::Feature;
+using namespace TAK::Engine::Renderer::Raster::TileMatrix;
+using namespace TAK::Engine::Util;
+
+// Heap allocation counters. Replacing the global allocation functions in the
+// executable also captures engine allocations on platforms where the shared
+// library binds `operator new` at load time (ELF); on Windows only
+// allocations made by the benchmark itself are observed.
+namespace
+{
+    std::atomic<uint64_t> allocationCount(0u);
+    std::atomic<uint64_t> allocationBytes(0u);
+    std::atomic<uint64_t> releaseCount(0u);
+}
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1u, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1u);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    allocationCount.fetch_add(1u, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1u);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+void operator delete(void *p) noexcept
+{
+    if (!p)
+        return;
+    releaseCount.fetch_add(1u, std::memory_order_relaxed);
+    std::free(p);
+}
+void operator delete[](void *p) noexcept
+{
+    ::operator delete(p);
+}
+void operator delete(void *p, std::size_t) noexcept
+{
+    ::operator delete(p);
+}
+void operator delete[](void *p, std::size_t) noexcept
+{
+    ::operator delete(p);
+}
+
+namespace
+{
+    struct Options
+    {
+        std::size_t points{ 1000u };
+        std::size_t lines{ 100u };
+        std::size_t lineVertices{ 64u };
+        std::size_t imageryLevels{ 12u };
+        bool terrain{ true };
+        std::size_t frames{ 600u };
+        std::size_t warmup{ 60u };
+        std::size_t width{ 1920u };
+        std::size_t height{ 1080u };
+        std::string path;
+        std::string recording;
+        std::size_t fps{ 60u };
+    };
+
+    struct Keyframe
+    {
+        double latitude;
+        double longitude;
+        double resolution;
+        double azimuth;
+        double tilt;
+        std::size_t frames;
+    };
+
+    struct FrameStats
+    {
+        std::vector<int64_t> nanos;
+        uint64_t allocations{ 0u };
+        uint64_t allocatedBytes{ 0u };
+        uint64_t releases{ 0u };
+    };
+
+    class BenchmarkSurface : public RenderSurface
+    {
+    public :
+        BenchmarkSurface(const std::size_t width, const std::size_t height) NOTHROWS;
+    public :
+        double getDpi() const NOTHROWS override;
+        std::size_t getWidth() const NOTHROWS override;
+        std::size_t getHeight() const NOTHROWS override;
+        void addOnSizeChangedListener(OnSizeChangedListener *l) NOTHROWS override;
+        void removeOnSizedChangedListener(const OnSizeChangedListener &l) NOTHROWS override;
+    private :
+        std::size_t width;
+        std::size_t height;
+    };
+
+    /**
+     * Single threaded render context. Events queued from any thread are
+     * run at the start of the next frame on the thread that created the
+     * context.
+     */
+    class BenchmarkContext : public RenderContext
+    {
+    public :
+        BenchmarkContext(const std::size_t width, const std::size_t height) NOTHROWS;
+        ~BenchmarkContext() NOTHROWS override;
+    public :
+        TAKErr init() NOTHROWS;
+        void pumpEvents() NOTHROWS;
+        void swapBuffers() NOTHROWS;
+    public :
+        bool isRenderThread() const NOTHROWS override;
+        TAKErr queueEvent(void(*runnable)(void *) NOTHROWS, std::unique_ptr<void, void(*)(const void *)> &&opaque) NOTHROWS override;
+        void requestRefresh() NOTHROWS override;
+        TAKErr setFrameRate(const float rate) NOTHROWS override;
+        float getFrameRate() const NOTHROWS override;
+        void setContinuousRenderEnabled(const bool enabled) NOTHROWS override;
+        bool isContinuousRenderEnabled() NOTHROWS override;
+        bool supportsChildContext() const NOTHROWS override;
+        TAKErr createChildContext(std::unique_ptr<RenderContext, void(*)(const RenderContext *)> &value) NOTHROWS override;
+        bool isAttached() const NOTHROWS override;
+        bool attach() NOTHROWS override;
+        bool detach() NOTHROWS override;
+        bool isMainContext() const NOTHROWS override;
+        RenderSurface *getRenderSurface() const NOTHROWS override;
+    private :
+        struct Event
+        {
+            void(*runnable)(void *) NOTHROWS;
+            std::shared_ptr<void> opaque;
+        };
+    private :
+        std::thread::id renderThread;
+        std::mutex mutex;
+        std::deque<Event> events;
+        float frameRate;
+        bool continuous;
+        mutable BenchmarkSurface surface;
+#ifdef TE_BENCHMARK_EGL
+        EGLDisplay display;
+        EGLSurface pbuffer;
+        EGLContext context;
+#endif
+    };
+
+    /** Layer presenting a feature data store to the benchmark SPI */
+    class FeaturesLayer : public AbstractLayer2
+    {
+    public :
+        FeaturesLayer(const char *name, FeatureDataStore2 &store) NOTHROWS;
+        ~FeaturesLayer() NOTHROWS override;
+    public :
+        FeatureDataStore2 &store;
+    };
+
+    class FeaturesLayerSpi : public GLLayerSpi2
+    {
+    public :
+        ~FeaturesLayerSpi() NOTHROWS override;
+        TAKErr create(GLLayer2Ptr &value, GLGlobeBase &renderer, Layer2 &subject) NOTHROWS override;
+    };
+
+    /** Quadtree pyramid in EPSG:4326 returning solid color tiles */
+    class SyntheticTileMatrix : public TileMatrix
+    {
+    public :
+        SyntheticTileMatrix(const std::size_t numLevels) NOTHROWS;
+        ~SyntheticTileMatrix() NOTHROWS override;
+    public :
+        const char* getName() const NOTHROWS override;
+        int getSRID() const NOTHROWS override;
+        TAKErr getZoomLevel(Port::Collection<ZoomLevel>& value) const NOTHROWS override;
+        double getOriginX() const NOTHROWS override;
+        double getOriginY() const NOTHROWS override;
+        TAKErr getTile(BitmapPtr& result, const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS override;
+        TAKErr getTileData(std::unique_ptr<const uint8_t, void (*)(const uint8_t*)>& value, std::size_t* len,
+                           const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS override;
+        TAKErr getBounds(Envelope2 *value) const NOTHROWS override;
+    private :
+        std::vector<ZoomLevel> levels;
+    };
+
+    /** Analytic terrain; a sum of sinusoids with a few km of relief */
+    class SyntheticTerrainSampler : public Sampler
+    {
+    public :
+        ~SyntheticTerrainSampler() NOTHROWS override;
+        TAKErr sample(double *value, const double latitude, const double longitude) NOTHROWS override;
+    };
+
+    class SyntheticTerrainCursor : public ElevationChunkCursor
+    {
+    public :
+        SyntheticTerrainCursor(const Polygon2 &bounds) NOTHROWS;
+        ~SyntheticTerrainCursor() NOTHROWS override;
+    public :
+        TAKErr moveToNext() NOTHROWS override;
+        TAKErr get(ElevationChunkPtr &value) NOTHROWS override;
+        TAKErr getResolution(double *value) NOTHROWS override;
+        TAKErr isAuthoritative(bool *value) NOTHROWS override;
+        TAKErr getCE(double *value) NOTHROWS override;
+        TAKErr getLE(double *value) NOTHROWS override;
+        TAKErr getUri(const char **value) NOTHROWS override;
+        TAKErr getType(const char **value) NOTHROWS override;
+        TAKErr getBounds(const Polygon2 **value) NOTHROWS override;
+        TAKErr getFlags(unsigned int *value) NOTHROWS override;
+    private :
+        const Polygon2 &bounds;
+        bool consumed;
+    };
+
+    class SyntheticTerrainSource : public ElevationSource
+    {
+    public :
+        SyntheticTerrainSource() NOTHROWS;
+        ~SyntheticTerrainSource() NOTHROWS override;
+    public :
+        const char *getName() const NOTHROWS override;
+        TAKErr query(ElevationChunkCursorPtr &value, const QueryParameters &params) NOTHROWS override;
+        Envelope2 getBounds() const NOTHROWS override;
+        TAKErr addOnContentChangedListener(OnContentChangedListener *l) NOTHROWS override;
+        TAKErr removeOnContentChangedListener(OnContentChangedListener *l) NOTHROWS override;
+    private :
+        Polygon2 bounds;
+    };
+
+    const char *TERRAIN_URI = "benchmark://terrain";
+    const char *TERRAIN_TYPE = "benchmark";
+    const double TERRAIN_RESOLUTION = 30.0;
+
+    TAKErr parseOptions(Options *value, int argc, char **argv) NOTHROWS;
+    TAKErr loadCameraPath(std::vector<Keyframe> &value, const char *path) NOTHROWS;
+    void defaultCameraPath(std::vector<Keyframe> &value) NOTHROWS;
+    void interpolate(Keyframe *value, const Keyframe &a, const Keyframe &b, const double t) NOTHROWS;
+    TAKErr populateFeatures(FeatureDataStore2 &store, const Options &opts) NOTHROWS;
+    int64_t percentile(const std::vector<int64_t> &sorted, const double p) NOTHROWS;
+}
+
+int main(int argc, char **argv)
+{
+    TAKErr code(TE_Ok);
+
+    Options opts;
+    code = parseOptions(&opts, argc, argv);
+    if (code != TE_Ok)
+        return 1;
+
+    std::vector<Keyframe> path;
+    if (!opts.path.empty()) {
+        code = loadCameraPath(path, opts.path.c_str());
+        if (code != TE_Ok) {
+            std::fprintf(stderr, "failed to load camera path %s\n", opts.path.c_str());
+            return 1;
+        }
+    } else {
+        defaultCameraPath(path);
+    }
+
+    std::vector<MapViewEvent> recording;
+    if (!opts.recording.empty()) {
+        FileInput2 input;
+        code = input.open(opts.recording.c_str());
+        if (code == TE_Ok)
+            code = MapViewRecording_read(recording, input);
+        if (code != TE_Ok || recording.empty()) {
+            std::fprintf(stderr, "failed to load recording %s\n", opts.recording.c_str());
+            return 1;
+        }
+    }
+
+    BenchmarkContext ctx(opts.width, opts.height);
+    code = ctx.init();
+    if (code != TE_Ok) {
+        std::fprintf(stderr, "failed to initialize render context\n");
+        return 1;
+    }
+
+    std::unique_ptr<atakmap::core::AtakMapView> view(new atakmap::core::AtakMapView((float)opts.width, (float)opts.height, 96.0));
+    std::unique_ptr<GLGlobe> globe(new GLGlobe(ctx, *view, 0, 0, (int)opts.width, (int)opts.height));
+
+    // imagery
+    std::shared_ptr<TileMatrix> matrix(new SyntheticTileMatrix(opts.imageryLevels));
+    std::unique_ptr<atakmap::raster::ImageDatasetDescriptor> imagery;
+    if (opts.imageryLevels) {
+        std::map<Port::String, Port::String, Port::StringLess> extraData;
+        imagery.reset(new atakmap::raster::ImageDatasetDescriptor(
+            "benchmark", "benchmark://imagery", "benchmark", "benchmark", "benchmark",
+            (256u << (opts.imageryLevels - 1u)) * 2u, 256u << (opts.imageryLevels - 1u),
+            180.0 / (double)(256u << (opts.imageryLevels - 1u)) * 111319.9, opts.imageryLevels,
+            atakmap::core::GeoPoint(90.0, -180.0), atakmap::core::GeoPoint(90.0, 180.0),
+            atakmap::core::GeoPoint(-90.0, 180.0), atakmap::core::GeoPoint(-90.0, -180.0),
+            4326, false, false, nullptr, extraData));
+        globe->setBaseMap(GLMapRenderable2Ptr(new GLTileMatrixLayer(&ctx, imagery.get(), matrix), Memory_deleter_const<GLMapRenderable2, GLTileMatrixLayer>));
+    }
+
+    // terrain
+    std::shared_ptr<ElevationSource> terrain;
+    if (opts.terrain) {
+        terrain.reset(new SyntheticTerrainSource());
+        ElevationSourceManager_attach(terrain);
+    }
+
+    // features
+    std::shared_ptr<GLLayerSpi2> spi(new FeaturesLayerSpi());
+    GLLayerFactory2_registerSpi(spi, 1000);
+
+    RuntimeFeatureDataStore2 store;
+    code = populateFeatures(store, opts);
+    if (code != TE_Ok) {
+        std::fprintf(stderr, "failed to populate features\n");
+        return 1;
+    }
+    std::shared_ptr<Layer2> featuresLayer(new FeaturesLayer("benchmark features", store));
+    std::shared_ptr<atakmap::core::Layer> legacyFeaturesLayer;
+    LegacyAdapters_adapt(legacyFeaturesLayer, featuresLayer);
+    view->addLayer(legacyFeaturesLayer.get());
+
+    globe->start();
+
+    std::unique_ptr<GLGlobeReplay> replay;
+    if (!recording.empty()) {
+        replay.reset(new GLGlobeReplay(*globe, *view, recording));
+        opts.frames = (std::size_t)(replay->getDuration() * (int64_t)opts.fps / 1000LL) + 1u;
+    }
+
+    // frame loop
+    std::size_t totalFrames = opts.warmup + opts.frames;
+    std::size_t keyframe = 0u;
+    std::size_t keyframeFrame = 0u;
+
+    FrameStats stats;
+    stats.nanos.reserve(opts.frames);
+
+    for (std::size_t frame = 0u; frame < totalFrames; frame++) {
+        if (frame == opts.warmup) {
+            globe->setRenderProfilingEnabled(true);
+            globe->resetRenderProfile();
+            stats.allocations = allocationCount.load();
+            stats.allocatedBytes = allocationBytes.load();
+            stats.releases = releaseCount.load();
+        }
+
+        if (replay) {
+            // warmup renders the initial state of the recording
+            if (frame == 0u) {
+                replay->start();
+            } else if (frame > opts.warmup) {
+                const std::size_t measured = frame - opts.warmup;
+                replay->advance((int64_t)(measured * 1000u / opts.fps) - (int64_t)((measured - 1u) * 1000u / opts.fps));
+            }
+        } else {
+            // advance the camera along the path, looping at the end
+            Keyframe camera = path[keyframe];
+            if (path.size() > 1u) {
+                const Keyframe &next = path[(keyframe + 1u) % path.size()];
+                const double t = next.frames ? (double)keyframeFrame / (double)next.frames : 1.0;
+                interpolate(&camera, path[keyframe], next, t);
+                if (++keyframeFrame >= next.frames) {
+                    keyframeFrame = 0u;
+                    keyframe = (keyframe + 1u) % path.size();
+                }
+            }
+            globe->lookAt(GeoPoint2(camera.latitude, camera.longitude), camera.resolution, camera.azimuth, camera.tilt, MapRenderer::CameraCollision::Ignore, false);
+        }
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        ctx.pumpEvents();
+        globe->render();
+        ctx.swapBuffers();
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        if (frame >= opts.warmup)
+            stats.nanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    stats.allocations = allocationCount.load() - stats.allocations;
+    stats.allocatedBytes = allocationBytes.load() - stats.allocatedBytes;
+    stats.releases = releaseCount.load() - stats.releases;
+
+    std::vector<GLDiagnostics::Timing> timings;
+    globe->getRenderProfile(timings);
+
+    std::vector<GLFrameStatistics::Frame> replayFrames;
+    if (replay)
+        replay->getFrameStatistics(replayFrames);
+
+    globe->stop();
+
+    // report. Lines are `section<TAB>key<TAB>values...` so that runs from
+    // different releases can be compared with `diff` or joined on the key.
+#ifdef TE_BENCHMARK_EGL
+    std::printf("config\tgl\tegl\n");
+#else
+    std::printf("config\tgl\tstub\n");
+#endif
+    std::printf("config\tsurface\t%zux%zu\n", opts.width, opts.height);
+    std::printf("config\tpoints\t%zu\n", opts.points);
+    std::printf("config\tlines\t%zu\t%zu\n", opts.lines, opts.lineVertices);
+    std::printf("config\timagery_levels\t%zu\n", opts.imageryLevels);
+    std::printf("config\tterrain\t%d\n", opts.terrain ? 1 : 0);
+    std::printf("config\tframes\t%zu\t%zu\n", opts.warmup, opts.frames);
+    if (replay) {
+        std::printf("replay\tduration_ms\t%" PRId64 "\n", replay->getDuration());
+        std::printf("replay\tfps\t%zu\n", opts.fps);
+        std::printf("replay\tskipped_events\t%zu\n", replay->getSkippedEvents());
+        if (!replayFrames.empty()) {
+            // engine frame statistics over the replay, including warmup
+            double prepare = 0.0, submit = 0.0, drawCalls = 0.0, triangles = 0.0, uploadBytes = 0.0;
+            for (std::size_t i = 0u; i < replayFrames.size(); i++) {
+                prepare += (double)replayFrames[i].cpuPrepareNanos;
+                submit += (double)replayFrames[i].cpuSubmitNanos;
+                drawCalls += (double)replayFrames[i].drawCalls;
+                triangles += (double)replayFrames[i].triangles;
+                uploadBytes += (double)replayFrames[i].textureUploadBytes;
+            }
+            const double n = (double)replayFrames.size();
+            std::printf("replay\tframes\t%zu\n", replayFrames.size());
+            std::printf("replay\tcpu_prepare_us\t%.1f\n", prepare / n / 1000.0);
+            std::printf("replay\tcpu_submit_us\t%.1f\n", submit / n / 1000.0);
+            std::printf("replay\tdraw_calls\t%.1f\n", drawCalls / n);
+            std::printf("replay\ttriangles\t%.1f\n", triangles / n);
+            std::printf("replay\ttexture_upload_bytes\t%.1f\n", uploadBytes / n);
+        }
+    }
+
+    if (!stats.nanos.empty()) {
+        std::vector<int64_t> sorted(stats.nanos);
+        std::sort(sorted.begin(), sorted.end());
+        int64_t total = 0LL;
+        for (std::size_t i = 0u; i < sorted.size(); i++)
+            total += sorted[i];
+        const double frames = (double)sorted.size();
+        std::printf("frame\tmean_us\t%.1f\n", (double)total / frames / 1000.0);
+        std::printf("frame\tp50_us\t%.1f\n", (double)percentile(sorted, 0.5) / 1000.0);
+        std::printf("frame\tp95_us\t%.1f\n", (double)percentile(sorted, 0.95) / 1000.0);
+        std::printf("frame\tmax_us\t%.1f\n", (double)sorted.back() / 1000.0);
+        std::printf("alloc\tper_frame\t%.1f\n", (double)stats.allocations / frames);
+        std::printf("alloc\tbytes_per_frame\t%.1f\n", (double)stats.allocatedBytes / frames);
+        std::printf("alloc\treleases_per_frame\t%.1f\n", (double)stats.releases / frames);
+
+        // phases are reported as `phase<TAB>path<TAB>calls/frame<TAB>cpu us/frame<TAB>gpu us/frame`
+        std::vector<std::string> stack;
+        for (std::size_t i = 0u; i < timings.size(); i++) {
+            const GLDiagnostics::Timing &timing = timings[i];
+            stack.resize(timing.depth);
+            stack.push_back(timing.name);
+            std::ostringstream phase;
+            for (std::size_t j = 0u; j < stack.size(); j++) {
+                if (j)
+                    phase << '/';
+                phase << stack[j];
+            }
+            std::printf("phase\t%s\t%.2f\t%.1f\t%.1f\n",
+                phase.str().c_str(),
+                (double)timing.count / frames,
+                (double)timing.cpuNanos / frames / 1000.0,
+                timing.gpuCount ? (double)timing.gpuNanos / frames / 1000.0 : 0.0);
+        }
+    }
+
+    MemoryAccountingSnapshot memory;
+    if (MemoryAccounting_getSnapshot(&memory) == TE_Ok) {
+        for (std::size_t i = 0u; i < MemoryAccountingSnapshot::NumCategories; i++)
+            std::printf("memory\tcategory%zu\t%" PRId64 "\t%" PRId64 "\n", i, memory.categories[i].bytes, memory.categories[i].peakBytes);
+    }
+
+    replay.reset();
+    globe.reset();
+    view->removeLayer(legacyFeaturesLayer.get());
+    view.reset();
+    if (terrain)
+        ElevationSourceManager_detach(*terrain);
+    GLLayerFactory2_unregisterSpi(*spi);
+
+    return 0;
+}
+
+namespace
+{
+    BenchmarkSurface::BenchmarkSurface(const std::size_t width_, const std::size_t height_) NOTHROWS :
+        width(width_),
+        height(height_)
+    {}
+    double BenchmarkSurface::getDpi() const NOTHROWS
+    {
+        return 96.0;
+    }
+    std::size_t BenchmarkSurface::getWidth() const NOTHROWS
+    {
+        return width;
+    }
+    std::size_t BenchmarkSurface::getHeight() const NOTHROWS
+    {
+        return height;
+    }
+    void BenchmarkSurface::addOnSizeChangedListener(OnSizeChangedListener *l) NOTHROWS
+    {
+        // surface is never resized
+    }
+    void BenchmarkSurface::removeOnSizedChangedListener(const OnSizeChangedListener &l) NOTHROWS
+    {}
+
+    BenchmarkContext::BenchmarkContext(const std::size_t width, const std::size_t height) NOTHROWS :
+        renderThread(std::this_thread::get_id()),
+        frameRate(0.f),
+        continuous(true),
+        surface(width, height)
+#ifdef TE_BENCHMARK_EGL
+        ,
+        display(EGL_NO_DISPLAY),
+        pbuffer(EGL_NO_SURFACE),
+        context(EGL_NO_CONTEXT)
+#endif
+    {}
+    BenchmarkContext::~BenchmarkContext() NOTHROWS
+    {
+        // release shared render resources while the GL context is current
+        GLMapRenderGlobals_releaseContext(*this);
+#ifdef TE_BENCHMARK_EGL
+        if (display != EGL_NO_DISPLAY) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT)
+                eglDestroyContext(display, context);
+            if (pbuffer != EGL_NO_SURFACE)
+                eglDestroySurface(display, pbuffer);
+            eglTerminate(display);
+        }
+#endif
+    }
+    TAKErr BenchmarkContext::init() NOTHROWS
+    {
+#ifdef TE_BENCHMARK_EGL
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY)
+            return TE_Err;
+        if (!eglInitialize(display, nullptr, nullptr))
+            return TE_Err;
+        if (!eglBindAPI(EGL_OPENGL_ES_API))
+            return TE_Err;
+
+        const EGLint configAttribs[] =
+        {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, 0x40, // EGL_OPENGL_ES3_BIT
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_STENCIL_SIZE, 8,
+            EGL_NONE,
+        };
+        EGLConfig config;
+        EGLint numConfigs = 0;
+        if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || !numConfigs)
+            return TE_Err;
+
+        const EGLint pbufferAttribs[] =
+        {
+            EGL_WIDTH, (EGLint)surface.getWidth(),
+            EGL_HEIGHT, (EGLint)surface.getHeight(),
+            EGL_NONE,
+        };
+        pbuffer = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (pbuffer == EGL_NO_SURFACE)
+            return TE_Err;
+
+        const EGLint contextAttribs[] =
+        {
+            EGL_CONTEXT_CLIENT_VERSION, 3,
+            EGL_NONE,
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context == EGL_NO_CONTEXT)
+            return TE_Err;
+        if (!eglMakeCurrent(display, pbuffer, pbuffer, context))
+            return TE_Err;
+#endif
+        return TE_Ok;
+    }
+    void BenchmarkContext::pumpEvents() NOTHROWS
+    {
+        std::deque<Event> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.swap(events);
+        }
+        for (auto it = pending.begin(); it != pending.end(); it++)
+            it->runnable(it->opaque.get());
+    }
+    void BenchmarkContext::swapBuffers() NOTHROWS
+    {
+        // wait for the frame to complete so that the frame time includes
+        // the GPU work. no-op on stub GL
+        glFinish();
+    }
+    bool BenchmarkContext::isRenderThread() const NOTHROWS
+    {
+        return std::this_thread::get_id() == renderThread;
+    }
+    TAKErr BenchmarkContext::queueEvent(void(*runnable)(void *) NOTHROWS, std::unique_ptr<void, void(*)(const void *)> &&opaque) NOTHROWS
+    {
+        if (!runnable)
+            return TE_InvalidArg;
+        Event event;
+        event.runnable = runnable;
+        event.opaque = std::shared_ptr<void>(opaque.release(), opaque.get_deleter());
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+        return TE_Ok;
+    }
+    void BenchmarkContext::requestRefresh() NOTHROWS
+    {
+        // frames are driven by the benchmark loop
+    }
+    TAKErr BenchmarkContext::setFrameRate(const float rate) NOTHROWS
+    {
+        frameRate = rate;
+        return TE_Ok;
+    }
+    float BenchmarkContext::getFrameRate() const NOTHROWS
+    {
+        return frameRate;
+    }
+    void BenchmarkContext::setContinuousRenderEnabled(const bool enabled) NOTHROWS
+    {
+        continuous = enabled;
+    }
+    bool BenchmarkContext::isContinuousRenderEnabled() NOTHROWS
+    {
+        return continuous;
+    }
+    bool BenchmarkContext::supportsChildContext() const NOTHROWS
+    {
+        return false;
+    }
+    TAKErr BenchmarkContext::createChildContext(std::unique_ptr<RenderContext, void(*)(const RenderContext *)> &value) NOTHROWS
+    {
+        return TE_Unsupported;
+    }
+    bool BenchmarkContext::isAttached() const NOTHROWS
+    {
+        return isRenderThread();
+    }
+    bool BenchmarkContext::attach() NOTHROWS
+    {
+        return isRenderThread();
+    }
+    bool BenchmarkContext::detach() NOTHROWS
+    {
+        return isRenderThread();
+    }
+    bool BenchmarkContext::isMainContext() const NOTHROWS
+    {
+        return true;
+    }
+    RenderSurface *BenchmarkContext::getRenderSurface() const NOTHROWS
+    {
+        return &surface;
+    }
+
+    FeaturesLayer::FeaturesLayer(const char *name, FeatureDataStore2 &store_) NOTHROWS :
+        AbstractLayer2(name),
+        store(store_)
+    {}
+    FeaturesLayer::~FeaturesLayer() NOTHROWS
+    {}
+
+    FeaturesLayerSpi::~FeaturesLayerSpi() NOTHROWS
+    {}
+    TAKErr FeaturesLayerSpi::create(GLLayer2Ptr &value, GLGlobeBase &renderer, Layer2 &subject) NOTHROWS
+    {
+        auto *layer = dynamic_cast<FeaturesLayer *>(&subject);
+        if (!layer)
+            return TE_InvalidArg;
+        return GLLayerFactory2_create(value, subject, GLMapRenderable2Ptr(new GLBatchGeometryFeatureDataStoreRenderer2(renderer.context, layer->store), Memory_deleter_const<GLMapRenderable2, GLBatchGeometryFeatureDataStoreRenderer2>));
+    }
+
+    SyntheticTileMatrix::SyntheticTileMatrix(const std::size_t numLevels) NOTHROWS
+    {
+        // level 0 is two 256x256 tiles spanning the globe
+        for (std::size_t i = 0u; i < numLevels; i++) {
+            ZoomLevel level;
+            level.level = (int)i;
+            level.pixelSizeX = 180.0 / (double)(256u << i);
+            level.pixelSizeY = level.pixelSizeX;
+            level.resolution = level.pixelSizeX * 111319.9;
+            level.tileWidth = 256;
+            level.tileHeight = 256;
+            levels.push_back(level);
+        }
+    }
+    SyntheticTileMatrix::~SyntheticTileMatrix() NOTHROWS
+    {}
+    const char* SyntheticTileMatrix::getName() const NOTHROWS
+    {
+        return "benchmark";
+    }
+    int SyntheticTileMatrix::getSRID() const NOTHROWS
+    {
+        return 4326;
+    }
+    TAKErr SyntheticTileMatrix::getZoomLevel(Port::Collection<ZoomLevel>& value) const NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        for (std::size_t i = 0u; i < levels.size(); i++) {
+            code = value.add(levels[i]);
+            TE_CHECKBREAK_CODE(code);
+        }
+        return code;
+    }
+    double SyntheticTileMatrix::getOriginX() const NOTHROWS
+    {
+        return -180.0;
+    }
+    double SyntheticTileMatrix::getOriginY() const NOTHROWS
+    {
+        return 90.0;
+    }
+    TAKErr SyntheticTileMatrix::getTile(BitmapPtr& result, const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        if (zoom >= levels.size())
+            return TE_InvalidArg;
+        result = BitmapPtr(new Bitmap2(256u, 256u, Bitmap2::RGB565), Memory_deleter_const<Bitmap2>);
+        // checker the tiles so adjacent tiles differ
+        const uint16_t color = ((x + y + zoom) & 0x1u) ? 0x07E0u : 0x001Fu;
+        uint16_t *px = reinterpret_cast<uint16_t *>(result->getData());
+        std::fill(px, px + (256u * 256u), color);
+        return TE_Ok;
+    }
+    TAKErr SyntheticTileMatrix::getTileData(std::unique_ptr<const uint8_t, void (*)(const uint8_t*)>& value, std::size_t* len,
+                                            const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        return TE_Unsupported;
+    }
+    TAKErr SyntheticTileMatrix::getBounds(Envelope2 *value) const NOTHROWS
+    {
+        if (!value)
+            return TE_InvalidArg;
+        *value = Envelope2(-180.0, -90.0, 180.0, 90.0);
+        return TE_Ok;
+    }
+
+    SyntheticTerrainSampler::~SyntheticTerrainSampler() NOTHROWS
+    {}
+    TAKErr SyntheticTerrainSampler::sample(double *value, const double latitude, const double longitude) NOTHROWS
+    {
+        *value = 1500.0 +
+            1000.0 * std::sin(latitude * 0.7) * std::cos(longitude * 0.9) +
+            250.0 * std::sin(latitude * 13.0 + longitude * 7.0);
+        return TE_Ok;
+    }
+
+    SyntheticTerrainCursor::SyntheticTerrainCursor(const Polygon2 &bounds_) NOTHROWS :
+        bounds(bounds_),
+        consumed(false)
+    {}
+    SyntheticTerrainCursor::~SyntheticTerrainCursor() NOTHROWS
+    {}
+    TAKErr SyntheticTerrainCursor::moveToNext() NOTHROWS
+    {
+        if (consumed)
+            return TE_Done;
+        consumed = true;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::get(ElevationChunkPtr &value) NOTHROWS
+    {
+        return ElevationChunkFactory_create(value,
+                                            TERRAIN_TYPE,
+                                            TERRAIN_URI,
+                                            ElevationData::MODEL_TERRAIN,
+                                            TERRAIN_RESOLUTION,
+                                            bounds,
+                                            NAN,
+                                            NAN,
+                                            false,
+                                            SamplerPtr(new SyntheticTerrainSampler(), Memory_deleter_const<Sampler, SyntheticTerrainSampler>));
+    }
+    TAKErr SyntheticTerrainCursor::getResolution(double *value) NOTHROWS
+    {
+        *value = TERRAIN_RESOLUTION;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::isAuthoritative(bool *value) NOTHROWS
+    {
+        *value = false;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getCE(double *value) NOTHROWS
+    {
+        *value = NAN;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getLE(double *value) NOTHROWS
+    {
+        *value = NAN;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getUri(const char **value) NOTHROWS
+    {
+        *value = TERRAIN_URI;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getType(const char **value) NOTHROWS
+    {
+        *value = TERRAIN_TYPE;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getBounds(const Polygon2 **value) NOTHROWS
+    {
+        *value = &bounds;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getFlags(unsigned int *value) NOTHROWS
+    {
+        *value = ElevationData::MODEL_TERRAIN;
+        return TE_Ok;
+    }
+
+    SyntheticTerrainSource::SyntheticTerrainSource() NOTHROWS
+    {
+        LineString2 ring;
+        ring.addPoint(-180.0, 90.0);
+        ring.addPoint(180.0, 90.0);
+        ring.addPoint(180.0, -90.0);
+        ring.addPoint(-180.0, -90.0);
+        ring.addPoint(-180.0, 90.0);
+        bounds = Polygon2(ring);
+    }
+    SyntheticTerrainSource::~SyntheticTerrainSource() NOTHROWS
+    {}
+    const char *SyntheticTerrainSource::getName() const NOTHROWS
+    {
+        return "benchmark";
+    }
+    TAKErr SyntheticTerrainSource::query(ElevationChunkCursorPtr &value, const QueryParameters &params) NOTHROWS
+    {
+        // single global chunk; spatial and resolution filters always pass
+        value = ElevationChunkCursorPtr(new SyntheticTerrainCursor(bounds), Memory_deleter_const<ElevationChunkCursor, SyntheticTerrainCursor>);
+        return TE_Ok;
+    }
+    Envelope2 SyntheticTerrainSource::getBounds() const NOTHROWS
+    {
+        return Envelope2(-180.0, -90.0, 180.0, 90.0);
+    }
+    TAKErr SyntheticTerrainSource::addOnContentChangedListener(OnContentChangedListener *l) NOTHROWS
+    {
+        // content never changes
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainSource::removeOnContentChangedListener(OnContentChangedListener *l) NOTHROWS
+    {
+        return TE_Ok;
+    }
+
+    TAKErr parseOptions(Options *value, int argc, char **argv) NOTHROWS
+    {
+        for (int i = 1; i < argc; i++) {
+            const char *arg = argv[i];
+            const bool hasNext = (i + 1) < argc;
+            if (!strcmp(arg, "--no-terrain")) {
+                value->terrain = false;
+            } else if (!strcmp(arg, "--path") && hasNext) {
+                value->path = argv[++i];
+            } else if (!strcmp(arg, "--recording") && hasNext) {
+                value->recording = argv[++i];
+            } else if (hasNext && arg[0] == '-' && arg[1] == '-') {
+                const std::size_t n = (std::size_t)std::strtoul(argv[++i], nullptr, 10);
+                if (!strcmp(arg, "--points"))
+                    value->points = n;
+                else if (!strcmp(arg, "--lines"))
+                    value->lines = n;
+                else if (!strcmp(arg, "--line-vertices"))
+                    value->lineVertices = std::max(n, (std::size_t)2u);
+                else if (!strcmp(arg, "--imagery-levels"))
+                    value->imageryLevels = std::min(n, (std::size_t)20u);
+                else if (!strcmp(arg, "--frames"))
+                    value->frames = n;
+                else if (!strcmp(arg, "--warmup"))
+                    value->warmup = n;
+                else if (!strcmp(arg, "--width"))
+                    value->width = std::max(n, (std::size_t)1u);
+                else if (!strcmp(arg, "--height"))
+                    value->height = std::max(n, (std::size_t)1u);
+                else if (!strcmp(arg, "--fps"))
+                    value->fps = std::max(n, (std::size_t)1u);
+                else
+                    goto usage;
+            } else {
+                goto usage;
+            }
+        }
+        return TE_Ok;
+    usage :
+        std::fprintf(stderr,
+            "usage: %s [--points N] [--lines N] [--line-vertices N] [--imagery-levels N]\n"
+            "          [--no-terrain] [--frames N] [--warmup N] [--width N] [--height N] [--path FILE]\n"
+            "          [--recording FILE] [--fps N]\n",
+            argv[0]);
+        return TE_InvalidArg;
+    }
+    TAKErr loadCameraPath(std::vector<Keyframe> &value, const char *path) NOTHROWS
+    {
+        std::ifstream in(path);
+        if (!in)
+            return TE_IO;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream strm(line);
+            Keyframe kf;
+            if (!(strm >> kf.latitude >> kf.longitude >> kf.resolution >> kf.azimuth >> kf.tilt >> kf.frames))
+                return TE_InvalidArg;
+            value.push_back(kf);
+        }
+        return value.empty() ? TE_InvalidArg : TE_Ok;
+    }
+    void defaultCameraPath(std::vector<Keyframe> &value) NOTHROWS
+    {
+        // global view, zoom into terrain, tilt and pan, rotate, zoom out
+        value.push_back(Keyframe{ 38.0, -77.0, 10000.0, 0.0, 0.0, 0u });
+        value.push_back(Keyframe{ 38.0, -77.0, 50.0, 0.0, 0.0, 120u });
+        value.push_back(Keyframe{ 38.5, -76.5, 20.0, 0.0, 60.0, 120u });
+        value.push_back(Keyframe{ 38.5, -76.5, 20.0, 180.0, 60.0, 120u });
+        value.push_back(Keyframe{ 37.5, -78.0, 500.0, 270.0, 30.0, 120u });
+        value.push_back(Keyframe{ 38.0, -77.0, 10000.0, 0.0, 0.0, 120u });
+    }
+    void interpolate(Keyframe *value, const Keyframe &a, const Keyframe &b, const double t) NOTHROWS
+    {
+        value->latitude = a.latitude + (b.latitude - a.latitude) * t;
+        value->longitude = a.longitude + (b.longitude - a.longitude) * t;
+        // interpolate zoom geometrically
+        value->resolution = a.resolution * std::pow(b.resolution / a.resolution, t);
+        double dAzimuth = std::fmod(b.azimuth - a.azimuth + 540.0, 360.0) - 180.0;
+        value->azimuth = std::fmod(a.azimuth + dAzimuth * t + 360.0, 360.0);
+        value->tilt = a.tilt + (b.tilt - a.tilt) * t;
+    }
+    TAKErr populateFeatures(FeatureDataStore2 &store, const Options &opts) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        FeatureSetPtr_const fs(nullptr, nullptr);
+        code = store.insertFeatureSet(&fs, "benchmark", "benchmark", "benchmark", 0.0, 0.0);
+        TE_CHECKRETURN_CODE(code);
+        const int64_t fsid = fs->getId();
+
+        // deterministic LCG so that every run renders identical content
+        uint32_t seed = 0x2545F491u;
+        auto next = [&seed]() -> double
+        {
+            seed = seed * 1664525u + 1013904223u;
+            return (double)(seed >> 8u) / (double)(1u << 24u);
+        };
+
+        const atakmap::util::AttributeSet attrs;
+        const atakmap::feature::BasicPointStyle pointStyle(0xFFFF0000u, 32.f);
+        const atakmap::feature::BasicStrokeStyle strokeStyle(0xFF00FFFFu, 3.f);
+
+        char name[32u];
+        for (std::size_t i = 0u; i < opts.points; i++) {
+            const double lat = 36.0 + next() * 4.0;
+            const double lng = -79.0 + next() * 4.0;
+            atakmap::feature::Point pt(lng, lat);
+            snprintf(name, sizeof(name), "track%zu", i);
+            code = store.insertFeature(nullptr, fsid, name, pt, TEAM_ClampToGround, 0.0, &pointStyle, attrs);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        for (std::size_t i = 0u; i < opts.lines; i++) {
+            atakmap::feature::LineString line;
+            double lat = 36.0 + next() * 4.0;
+            double lng = -79.0 + next() * 4.0;
+            for (std::size_t j = 0u; j < opts.lineVertices; j++) {
+                line.addPoint(lng, lat);
+                lat += (next() - 0.5) * 0.02;
+                lng += (next() - 0.5) * 0.02;
+            }
+            snprintf(name, sizeof(name), "line%zu", i);
+            code = store.insertFeature(nullptr, fsid, name, line, TEAM_ClampToGround, 0.0, &strokeStyle, attrs);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        return code;
+    }
+    int64_t percentile(const std::vector<int64_t> &sorted, const double p) NOTHROWS
+    {
+        if (sorted.empty())
+            return 0LL;
+        const std::size_t idx = std::min((std::size_t)(p * (double)(sorted.size() - 1u) + 0.5), sorted.size() - 1u);
+        return sorted[idx];
+    }
+}
@@ -0,0 +1,936 @@
+// Engine kernel microbenchmarks.
+//
+// Times the CPU kernels that dominate content ingest and frame preparation --
+// tessellation, triangulation, geometry blob parsing, feature database
+// insert/query, scene projection, bitmap conversion, quantized-mesh and glTF
+// decode, batch elevation sampling, KML parsing and task scheduling -- over
+// synthetic inputs so that results are comparable between engine releases.
+//
+// Built on Google Benchmark; all of its options apply. For results suitable
+// for tracking across versions, emit JSON:
+//
+//   KernelBenchmark --benchmark_format=json > kernels.json
+//   KernelBenchmark --benchmark_out=kernels.json --benchmark_out_format=json
+//
+// `--benchmark_filter=<regex>` restricts the run to matching kernels.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/GeoPoint2.h"
+#include "core/MapSceneModel2.h"
+#include "elevation/ElevationChunkCursor.h"
+#include "elevation/ElevationChunkFactory.h"
+#include "elevation/ElevationData.h"
+#include "elevation/ElevationManager.h"
+#include "elevation/ElevationSource.h"
+#include "elevation/ElevationSourceManager.h"
+#include "feature/FeatureDataStore2.h"
+#include "feature/FeatureSetDatabase.h"
+#include "feature/GeometryFactory.h"
+#include "feature/KMLParser.h"
+#include "feature/LineString.h"
+#include "feature/LineString2.h"
+#include "feature/Point.h"
+#include "feature/Polygon.h"
+#include "feature/Polygon2.h"
+#include "formats/gltf/GLTF.h"
+#include "formats/quantizedmesh/QuantizedMeshDecode.h"
+#include "math/Point2.h"
+#include "model/Scene.h"
+#include "port/String.h"
+#include "renderer/Bitmap2.h"
+#include "renderer/GLTriangulate2.h"
+#include "renderer/Tessellate.h"
+#include "util/AttributeSet.h"
+#include "util/DataInput2.h"
+#include "util/DataOutput2.h"
+#include "util/IO2.h"
+#include "util/Memory.h"
+#include "util/Tasking.h"
+#include "util/Work.h"
+
+using namespace TAK::Engine;
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Elevation;
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Formats::QuantizedMesh;
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    /** Deterministic LCG; inputs must not vary between runs */
+    class Random
+    {
+    public :
+        Random(const uint32_t seed) NOTHROWS :
+            state(seed)
+        {}
+    public :
+        double next() NOTHROWS
+        {
+            state = state * 1664525u + 1013904223u;
+            return (double)(state >> 8u) / (double)(1u << 24u);
+        }
+        double next(const double min, const double max) NOTHROWS
+        {
+            return min + (max - min) * next();
+        }
+    private :
+        uint32_t state;
+    };
+
+    /**
+     * Returns a simple, non-convex polygon of `count` vertices ordered
+     * x,y approximately one degree across, centered at the origin.
+     */
+    std::vector<double> starPolygon(const std::size_t count) NOTHROWS
+    {
+        std::vector<double> xy;
+        xy.reserve(count * 2u);
+        for (std::size_t i = 0u; i < count; i++) {
+            const double theta = (2.0 * M_PI * (double)i) / (double)count;
+            const double r = (i % 2u) ? 0.5 : 0.3;
+            xy.push_back(r * std::cos(theta));
+            xy.push_back(r * std::sin(theta));
+        }
+        return xy;
+    }
+
+    /** Returns a random walk of `count` vertices ordered x,y */
+    std::vector<double> walk(const std::size_t count, const double step) NOTHROWS
+    {
+        Random r(42u);
+        std::vector<double> xy;
+        xy.reserve(count * 2u);
+        double x = -77.0;
+        double y = 38.0;
+        for (std::size_t i = 0u; i < count; i++) {
+            xy.push_back(x);
+            xy.push_back(y);
+            x += r.next(-step, step);
+            y += r.next(-step, step);
+        }
+        return xy;
+    }
+
+    /** Analytic terrain; a sum of sinusoids with a few km of relief */
+    class SyntheticTerrainSampler : public Sampler
+    {
+    public :
+        ~SyntheticTerrainSampler() NOTHROWS override;
+        TAKErr sample(double *value, const double latitude, const double longitude) NOTHROWS override;
+    };
+
+    class SyntheticTerrainCursor : public ElevationChunkCursor
+    {
+    public :
+        SyntheticTerrainCursor(const Polygon2 &bounds) NOTHROWS;
+        ~SyntheticTerrainCursor() NOTHROWS override;
+    public :
+        TAKErr moveToNext() NOTHROWS override;
+        TAKErr get(ElevationChunkPtr &value) NOTHROWS override;
+        TAKErr getResolution(double *value) NOTHROWS override;
+        TAKErr isAuthoritative(bool *value) NOTHROWS override;
+        TAKErr getCE(double *value) NOTHROWS override;
+        TAKErr getLE(double *value) NOTHROWS override;
+        TAKErr getUri(const char **value) NOTHROWS override;
+        TAKErr getType(const char **value) NOTHROWS override;
+        TAKErr getBounds(const Polygon2 **value) NOTHROWS override;
+        TAKErr getFlags(unsigned int *value) NOTHROWS override;
+    private :
+        const Polygon2 &bounds;
+        bool consumed;
+    };
+
+    class SyntheticTerrainSource : public ElevationSource
+    {
+    public :
+        SyntheticTerrainSource() NOTHROWS;
+        ~SyntheticTerrainSource() NOTHROWS override;
+    public :
+        const char *getName() const NOTHROWS override;
+        TAKErr query(ElevationChunkCursorPtr &value, const QueryParameters &params) NOTHROWS override;
+        Envelope2 getBounds() const NOTHROWS override;
+        TAKErr addOnContentChangedListener(OnContentChangedListener *l) NOTHROWS override;
+        TAKErr removeOnContentChangedListener(OnContentChangedListener *l) NOTHROWS override;
+    private :
+        Polygon2 bounds;
+    };
+
+    const char *TERRAIN_URI = "benchmark://terrain";
+    const char *TERRAIN_TYPE = "benchmark";
+    const double TERRAIN_RESOLUTION = 30.0;
+
+    /**
+     * Returns a binary glTF 2.0 asset containing a single `n` x `n`
+     * vertex grid mesh with 16-bit indices.
+     */
+    std::vector<uint8_t> gridGlb(const std::size_t n) NOTHROWS;
+    /** Returns a KML document with `count` point and linestring placemarks */
+    std::string placemarkKml(const std::size_t count) NOTHROWS;
+
+    TAKErr value42(int &result) NOTHROWS
+    {
+        result = 42;
+        return TE_Ok;
+    }
+    TAKErr add1(int &output, int input) NOTHROWS
+    {
+        output = input + 1;
+        return TE_Ok;
+    }
+    TAKErr sum(int &output, const std::vector<int> &input) NOTHROWS
+    {
+        output = 0;
+        for (int v : input)
+            output += v;
+        return TE_Ok;
+    }
+}
+
+// Tessellation
+
+static void BM_Tessellate_polygon(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    std::vector<double> xy(starPolygon(count));
+    VertexData src;
+    src.data = xy.data();
+    src.size = 2u;
+    src.stride = 16u;
+
+    std::size_t emitted = 0u;
+    for (auto _ : state) {
+        VertexDataPtr result(nullptr, nullptr);
+        std::size_t resultCount = 0u;
+        if (Tessellate_polygon<double>(result, &resultCount, src, count, 5000.0, Tessellate_WGS84Algorithm()) != TE_Ok) {
+            state.SkipWithError("Tessellate_polygon failed");
+            break;
+        }
+        benchmark::DoNotOptimize(result.get());
+        emitted = resultCount;
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+    state.counters["vertices_out"] = (double)emitted;
+}
+BENCHMARK(BM_Tessellate_polygon)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_Tessellate_linestring(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    std::vector<double> xy(walk(count, 0.05));
+    VertexData src;
+    src.data = xy.data();
+    src.size = 2u;
+    src.stride = 16u;
+
+    std::size_t emitted = 0u;
+    for (auto _ : state) {
+        VertexDataPtr result(nullptr, nullptr);
+        std::size_t resultCount = 0u;
+        if (Tessellate_linestring<double>(result, &resultCount, src, count, 500.0, Tessellate_WGS84Algorithm()) != TE_Ok) {
+            state.SkipWithError("Tessellate_linestring failed");
+            break;
+        }
+        benchmark::DoNotOptimize(result.get());
+        emitted = resultCount;
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+    state.counters["vertices_out"] = (double)emitted;
+}
+BENCHMARK(BM_Tessellate_linestring)->Arg(64)->Arg(1024)->Arg(16384);
+
+// Triangulation
+
+static void BM_GLTriangulate2_triangulate(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    std::vector<double> xy(starPolygon(count));
+    std::vector<uint16_t> indices((count - 2u) * 3u);
+
+    for (auto _ : state) {
+        std::size_t idxCount = 0u;
+        if (GLTriangulate2_triangulate(indices.data(), &idxCount, xy.data(), 2u, count) != TE_Ok) {
+            state.SkipWithError("GLTriangulate2_triangulate failed");
+            break;
+        }
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_GLTriangulate2_triangulate)->Arg(16)->Arg(256)->Arg(2048);
+
+// Geometry blobs
+
+static void BM_GeometryFactory_fromSpatiaLiteBlob(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    std::vector<double> xy(walk(count, 0.01));
+    LineString2 linestring;
+    for (std::size_t i = 0u; i < count; i++)
+        linestring.addPoint(xy[i*2u], xy[i*2u+1u]);
+
+    DynamicOutput blob;
+    blob.open(count * 16u + 64u);
+    if (GeometryFactory_toSpatiaLiteBlob(blob, linestring, 4326) != TE_Ok) {
+        state.SkipWithError("GeometryFactory_toSpatiaLiteBlob failed");
+        return;
+    }
+    const uint8_t *data;
+    std::size_t len;
+    blob.get(&data, &len);
+
+    for (auto _ : state) {
+        Geometry2Ptr geom(nullptr, nullptr);
+        int srid;
+        if (GeometryFactory_fromSpatiaLiteBlob(geom, &srid, data, len) != TE_Ok) {
+            state.SkipWithError("GeometryFactory_fromSpatiaLiteBlob failed");
+            break;
+        }
+        benchmark::DoNotOptimize(geom.get());
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)len);
+}
+BENCHMARK(BM_GeometryFactory_fromSpatiaLiteBlob)->Arg(1)->Arg(64)->Arg(4096);
+
+static void BM_GeometryFactory_fromWkb(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    std::vector<double> xy(walk(count, 0.01));
+    LineString2 ring;
+    for (std::size_t i = 0u; i < count; i++)
+        ring.addPoint(xy[i*2u], xy[i*2u+1u]);
+    ring.addPoint(xy[0], xy[1]);
+    Polygon2 polygon(ring);
+
+    DynamicOutput wkb;
+    wkb.open(count * 16u + 64u);
+    if (GeometryFactory_toWkb(wkb, polygon) != TE_Ok) {
+        state.SkipWithError("GeometryFactory_toWkb failed");
+        return;
+    }
+    const uint8_t *data;
+    std::size_t len;
+    wkb.get(&data, &len);
+
+    for (auto _ : state) {
+        Geometry2Ptr geom(nullptr, nullptr);
+        if (GeometryFactory_fromWkb(geom, data, len) != TE_Ok) {
+            state.SkipWithError("GeometryFactory_fromWkb failed");
+            break;
+        }
+        benchmark::DoNotOptimize(geom.get());
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)len);
+}
+BENCHMARK(BM_GeometryFactory_fromWkb)->Arg(4)->Arg(256)->Arg(4096);
+
+// Feature database
+
+static void BM_FDB_insert(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    atakmap::util::AttributeSet attrs;
+    attrs.setInt("index", 0);
+    attrs.setString("callsign", "benchmark");
+    Random r(7u);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        Port::String path;
+        if (IO_createTempFile(path, "fdbbench", ".sqlite", nullptr) != TE_Ok) {
+            state.SkipWithError("IO_createTempFile failed");
+            break;
+        }
+        IO_delete(path);
+        std::unique_ptr<FeatureSetDatabase::Builder> builder(new FeatureSetDatabase::Builder());
+        int64_t fsid = 0LL;
+        if (builder->create(path) != TE_Ok || builder->insertFeatureSet(&fsid, "benchmark", "benchmark", "points", 0.0, 0.0) != TE_Ok) {
+            state.SkipWithError("FeatureSetDatabase create failed");
+            break;
+        }
+        state.ResumeTiming();
+
+        TAKErr code = builder->beginBulkInsertion();
+        for (std::size_t i = 0u; code == TE_Ok && i < count; i++) {
+            atakmap::feature::Point p(r.next(-180.0, 180.0), r.next(-85.0, 85.0));
+            code = builder->insertFeature(fsid, "point", p, TEAM_ClampToGround, 0.0, nullptr, attrs);
+        }
+        builder->endBulkInsertion(code == TE_Ok);
+
+        state.PauseTiming();
+        builder->close();
+        builder.reset();
+        IO_delete(path);
+        state.ResumeTiming();
+
+        if (code != TE_Ok) {
+            state.SkipWithError("FeatureSetDatabase insertFeature failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_FDB_insert)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void BM_FDB_query(benchmark::State &state)
+{
+    const std::size_t count = 20000u;
+    Port::String path;
+    if (IO_createTempFile(path, "fdbbench", ".sqlite", nullptr) != TE_Ok) {
+        state.SkipWithError("IO_createTempFile failed");
+        return;
+    }
+    IO_delete(path);
+    {
+        FeatureSetDatabase::Builder builder;
+        int64_t fsid = 0LL;
+        if (builder.create(path) != TE_Ok || builder.insertFeatureSet(&fsid, "benchmark", "benchmark", "points", 0.0, 0.0) != TE_Ok) {
+            state.SkipWithError("FeatureSetDatabase create failed");
+            return;
+        }
+        atakmap::util::AttributeSet attrs;
+        Random r(11u);
+        builder.beginBulkInsertion();
+        for (std::size_t i = 0u; i < count; i++) {
+            atakmap::feature::Point p(r.next(-180.0, 180.0), r.next(-85.0, 85.0));
+            builder.insertFeature(fsid, "point", p, TEAM_ClampToGround, 0.0, nullptr, attrs);
+        }
+        builder.endBulkInsertion(true);
+        builder.createIndices();
+        builder.close();
+    }
+    {
+        FeatureSetDatabase fdb;
+        if (fdb.open(path) != TE_Ok) {
+            state.SkipWithError("FeatureSetDatabase open failed");
+            return;
+        }
+
+        // query region covering `range(0)` percent of the populated extent
+        const double f = std::sqrt((double)state.range(0) / 100.0);
+        atakmap::feature::LineString ring(atakmap::feature::Geometry::_2D);
+        ring.addPoint(-180.0 * f, 85.0 * f);
+        ring.addPoint(180.0 * f, 85.0 * f);
+        ring.addPoint(180.0 * f, -85.0 * f);
+        ring.addPoint(-180.0 * f, -85.0 * f);
+        ring.addPoint(-180.0 * f, 85.0 * f);
+
+        FeatureDataStore2::FeatureQueryParameters params;
+        params.spatialFilter = GeometryPtr_const(new atakmap::feature::Polygon(ring), Memory_deleter_const<atakmap::feature::Geometry>);
+
+        std::size_t results = 0u;
+        for (auto _ : state) {
+            FeatureCursorPtr cursor(nullptr, nullptr);
+            if (fdb.queryFeatures(cursor, params) != TE_Ok) {
+                state.SkipWithError("FeatureSetDatabase queryFeatures failed");
+                break;
+            }
+            results = 0u;
+            while (cursor->moveToNext() == TE_Ok) {
+                int64_t fid;
+                cursor->getId(&fid);
+                results++;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * (int64_t)results);
+        state.counters["results"] = (double)results;
+    }
+    IO_delete(path);
+}
+BENCHMARK(BM_FDB_query)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+// Scene projection
+
+static void BM_MapSceneModel2_forward(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    MapSceneModel2 sm(96.0, 1920u, 1080u, 4978, GeoPoint2(38.0, -77.0), 960.0f, 540.0f, 30.0, 45.0, 50.0);
+
+    Random r(3u);
+    std::vector<GeoPoint2> geos;
+    geos.reserve(count);
+    for (std::size_t i = 0u; i < count; i++)
+        geos.push_back(GeoPoint2(r.next(37.9, 38.1), r.next(-77.1, -76.9), r.next(0.0, 500.0), AltitudeReference::HAE));
+    std::vector<TAK::Engine::Math::Point2<double>> points(count);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0u; i < count; i++)
+            sm.forward(&points[i], geos[i]);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_MapSceneModel2_forward)->Arg(1)->Arg(4096);
+
+static void BM_MapSceneModel2_forwardBatch(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    MapSceneModel2 sm(96.0, 1920u, 1080u, 4978, GeoPoint2(38.0, -77.0), 960.0f, 540.0f, 30.0, 45.0, 50.0);
+
+    Random r(3u);
+    std::vector<GeoPoint2> geos;
+    geos.reserve(count);
+    for (std::size_t i = 0u; i < count; i++)
+        geos.push_back(GeoPoint2(r.next(37.9, 38.1), r.next(-77.1, -76.9), r.next(0.0, 500.0), AltitudeReference::HAE));
+    std::vector<TAK::Engine::Math::Point2<double>> points(count);
+
+    for (auto _ : state) {
+        sm.forward(points.data(), geos.data(), count);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_MapSceneModel2_forwardBatch)->Arg(64)->Arg(4096);
+
+// Bitmap conversion
+
+static void BM_Bitmap2_convert(benchmark::State &state)
+{
+    const Bitmap2::Format srcFormat = (Bitmap2::Format)state.range(0);
+    const Bitmap2::Format dstFormat = (Bitmap2::Format)state.range(1);
+    const std::size_t dim = 512u;
+
+    Bitmap2 src(dim, dim, srcFormat);
+    Random r(5u);
+    uint8_t *data = src.getData();
+    const std::size_t len = src.getStride() * dim;
+    for (std::size_t i = 0u; i < len; i++)
+        data[i] = (uint8_t)(r.next() * 255.0);
+
+    for (auto _ : state) {
+        Bitmap2 dst(src, dstFormat);
+        benchmark::DoNotOptimize(dst.getData());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)(dim * dim));
+}
+BENCHMARK(BM_Bitmap2_convert)
+    ->Args({Bitmap2::ARGB32, Bitmap2::RGBA32})
+    ->Args({Bitmap2::RGBA32, Bitmap2::ARGB32})
+    ->Args({Bitmap2::RGB24, Bitmap2::RGBA32})
+    ->Args({Bitmap2::ARGB32, Bitmap2::RGB565})
+    ->Args({Bitmap2::RGB565, Bitmap2::RGBA32});
+
+// Quantized mesh
+
+static void BM_QuantizedMesh_decodeVertices(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+
+    // zig-zag, delta encoded u, v, height streams
+    Random r(9u);
+    std::vector<uint8_t> encoded;
+    encoded.reserve(count * 6u);
+    for (std::size_t s = 0u; s < 3u; s++) {
+        int prev = 0;
+        for (std::size_t i = 0u; i < count; i++) {
+            const int v = (int)(r.next() * 32767.0);
+            const int d = v - prev;
+            const uint16_t zz = (uint16_t)((d << 1) ^ (d >> 31));
+            encoded.push_back((uint8_t)(zz & 0xFFu));
+            encoded.push_back((uint8_t)(zz >> 8u));
+            prev = v;
+        }
+    }
+
+    std::vector<uint16_t> positions(count * 3u);
+    for (auto _ : state) {
+        for (std::size_t s = 0u; s < 3u; s++)
+            QuantizedMesh_decodeZigZagDelta(positions.data() + s, 3u, encoded.data() + (s * count * 2u), count);
+        benchmark::DoNotOptimize(positions.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+    state.SetBytesProcessed(state.iterations() * (int64_t)encoded.size());
+}
+BENCHMARK(BM_QuantizedMesh_decodeVertices)->Arg(1024)->Arg(65536);
+
+static void BM_QuantizedMesh_decodeHighWaterMark(benchmark::State &state)
+{
+    const std::size_t n = (std::size_t)state.range(0);
+    const std::size_t numVertices = n * n;
+
+    // row-major grid triangles, high-water mark encoded
+    std::vector<uint8_t> encoded;
+    uint32_t highest = 0u;
+    auto emit = [&](const uint32_t index)
+    {
+        const uint32_t code = highest - index;
+        if (!code)
+            highest++;
+        for (std::size_t b = 0u; b < 4u; b++)
+            encoded.push_back((uint8_t)(code >> (b * 8u)));
+    };
+    for (std::size_t y = 0u; y < n - 1u; y++) {
+        for (std::size_t x = 0u; x < n - 1u; x++) {
+            const uint32_t i = (uint32_t)(y * n + x);
+            emit(i);
+            emit(i + 1u);
+            emit(i + (uint32_t)n);
+            emit(i + 1u);
+            emit(i + (uint32_t)n + 1u);
+            emit(i + (uint32_t)n);
+        }
+    }
+    const std::size_t count = encoded.size() / 4u;
+
+    std::vector<uint32_t> indices(count);
+    for (auto _ : state) {
+        if (QuantizedMesh_decodeHighWaterMark(indices.data(), encoded.data(), count, numVertices) != TE_Ok) {
+            state.SkipWithError("QuantizedMesh_decodeHighWaterMark failed");
+            break;
+        }
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_QuantizedMesh_decodeHighWaterMark)->Arg(65)->Arg(257);
+
+// glTF
+
+static void BM_GLTF_load(benchmark::State &state)
+{
+    const std::vector<uint8_t> glb(gridGlb((std::size_t)state.range(0)));
+
+    for (auto _ : state) {
+        ScenePtr scene(nullptr, nullptr);
+        if (TAK::Engine::Formats::GLTF::GLTF_load(scene, glb.data(), glb.size(), "benchmark://") != TE_Ok) {
+            state.SkipWithError("GLTF_load failed");
+            break;
+        }
+        benchmark::DoNotOptimize(scene.get());
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)glb.size());
+}
+BENCHMARK(BM_GLTF_load)->Arg(16)->Arg(128)->Unit(benchmark::kMicrosecond);
+
+// Elevation
+
+static void BM_ElevationManager_getElevation(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    std::shared_ptr<ElevationSource> terrain(new SyntheticTerrainSource());
+    if (ElevationSourceManager_attach(terrain) != TE_Ok) {
+        state.SkipWithError("ElevationSourceManager_attach failed");
+        return;
+    }
+
+    Random r(13u);
+    std::vector<double> lla;
+    lla.reserve(count * 3u);
+    for (std::size_t i = 0u; i < count; i++) {
+        lla.push_back(r.next(37.5, 38.5));
+        lla.push_back(r.next(-77.5, -76.5));
+        lla.push_back(NAN);
+    }
+
+    ElevationSource::QueryParameters params;
+    for (auto _ : state) {
+        for (std::size_t i = 0u; i < count; i++)
+            lla[i*3u+2u] = NAN;
+        if (ElevationManager_getElevation(lla.data() + 2u, count, lla.data(), lla.data() + 1u, 3u, 3u, 3u, params) != TE_Ok) {
+            state.SkipWithError("ElevationManager_getElevation failed");
+            break;
+        }
+        benchmark::DoNotOptimize(lla.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+
+    ElevationSourceManager_detach(*terrain);
+}
+BENCHMARK(BM_ElevationManager_getElevation)->Arg(64)->Arg(4096);
+
+// KML
+
+static void BM_KMLParser_parse(benchmark::State &state)
+{
+    const std::string kml(placemarkKml((std::size_t)state.range(0)));
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(kml.data());
+
+    for (auto _ : state) {
+        MemoryInput2 input;
+        input.open(bytes, kml.length());
+        KMLParser parser;
+        if (parser.open(input, "benchmark.kml") != TE_Ok) {
+            state.SkipWithError("KMLParser open failed");
+            break;
+        }
+        parser.enableStore(true);
+        std::size_t steps = 0u;
+        while (parser.step() == TE_Ok)
+            steps++;
+        parser.close();
+        benchmark::DoNotOptimize(steps);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)kml.length());
+}
+BENCHMARK(BM_KMLParser_parse)->Arg(100)->Arg(5000)->Unit(benchmark::kMillisecond);
+
+// Work scheduling
+
+static void BM_Task_roundTrip(benchmark::State &state)
+{
+    const SharedWorkerPtr &worker = GeneralWorkers_flex();
+    for (auto _ : state) {
+        FutureTask<int> f = Task_begin(worker, value42).then(add1);
+        int v = 0;
+        TAKErr err = TE_Err;
+        if (f.await(v, err) != TE_Ok || err != TE_Ok) {
+            state.SkipWithError("Task await failed");
+            break;
+        }
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(BM_Task_roundTrip)->UseRealTime();
+
+static void BM_Task_fanOut(benchmark::State &state)
+{
+    const std::size_t count = (std::size_t)state.range(0);
+    const SharedWorkerPtr &worker = GeneralWorkers_flex();
+    for (auto _ : state) {
+        std::vector<Future<int>> futures;
+        futures.reserve(count);
+        for (std::size_t i = 0u; i < count; i++)
+            futures.push_back(Task_begin(worker, value42).then(add1));
+        Future<int> f = Task_whenAll(futures).thenOn(worker, sum);
+        int v = 0;
+        TAKErr err = TE_Err;
+        if (f.await(v, err) != TE_Ok || err != TE_Ok) {
+            state.SkipWithError("Task await failed");
+            break;
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+}
+BENCHMARK(BM_Task_fanOut)->Arg(16)->Arg(256)->UseRealTime();
+
+BENCHMARK_MAIN();
+
+namespace
+{
+    SyntheticTerrainSampler::~SyntheticTerrainSampler() NOTHROWS
+    {}
+    TAKErr SyntheticTerrainSampler::sample(double *value, const double latitude, const double longitude) NOTHROWS
+    {
+        *value = 1500.0 +
+            1000.0 * std::sin(latitude * 0.7) * std::cos(longitude * 0.9) +
+            250.0 * std::sin(latitude * 13.0 + longitude * 7.0);
+        return TE_Ok;
+    }
+
+    SyntheticTerrainCursor::SyntheticTerrainCursor(const Polygon2 &bounds_) NOTHROWS :
+        bounds(bounds_),
+        consumed(false)
+    {}
+    SyntheticTerrainCursor::~SyntheticTerrainCursor() NOTHROWS
+    {}
+    TAKErr SyntheticTerrainCursor::moveToNext() NOTHROWS
+    {
+        if (consumed)
+            return TE_Done;
+        consumed = true;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::get(ElevationChunkPtr &value) NOTHROWS
+    {
+        return ElevationChunkFactory_create(value,
+                                            TERRAIN_TYPE,
+                                            TERRAIN_URI,
+                                            ElevationData::MODEL_TERRAIN,
+                                            TERRAIN_RESOLUTION,
+                                            bounds,
+                                            NAN,
+                                            NAN,
+                                            false,
+                                            SamplerPtr(new SyntheticTerrainSampler(), Memory_deleter_const<Sampler, SyntheticTerrainSampler>));
+    }
+    TAKErr SyntheticTerrainCursor::getResolution(double *value) NOTHROWS
+    {
+        *value = TERRAIN_RESOLUTION;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::isAuthoritative(bool *value) NOTHROWS
+    {
+        *value = false;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getCE(double *value) NOTHROWS
+    {
+        *value = NAN;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getLE(double *value) NOTHROWS
+    {
+        *value = NAN;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getUri(const char **value) NOTHROWS
+    {
+        *value = TERRAIN_URI;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getType(const char **value) NOTHROWS
+    {
+        *value = TERRAIN_TYPE;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getBounds(const Polygon2 **value) NOTHROWS
+    {
+        *value = &bounds;
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainCursor::getFlags(unsigned int *value) NOTHROWS
+    {
+        *value = ElevationData::MODEL_TERRAIN;
+        return TE_Ok;
+    }
+
+    SyntheticTerrainSource::SyntheticTerrainSource() NOTHROWS
+    {
+        LineString2 ring;
+        ring.addPoint(-180.0, 90.0);
+        ring.addPoint(180.0, 90.0);
+        ring.addPoint(180.0, -90.0);
+        ring.addPoint(-180.0, -90.0);
+        ring.addPoint(-180.0, 90.0);
+        bounds = Polygon2(ring);
+    }
+    SyntheticTerrainSource::~SyntheticTerrainSource() NOTHROWS
+    {}
+    const char *SyntheticTerrainSource::getName() const NOTHROWS
+    {
+        return "benchmark";
+    }
+    TAKErr SyntheticTerrainSource::query(ElevationChunkCursorPtr &value, const QueryParameters &params) NOTHROWS
+    {
+        // single global chunk; spatial and resolution filters always pass
+        value = ElevationChunkCursorPtr(new SyntheticTerrainCursor(bounds), Memory_deleter_const<ElevationChunkCursor, SyntheticTerrainCursor>);
+        return TE_Ok;
+    }
+    Envelope2 SyntheticTerrainSource::getBounds() const NOTHROWS
+    {
+        return Envelope2(-180.0, -90.0, 180.0, 90.0);
+    }
+    TAKErr SyntheticTerrainSource::addOnContentChangedListener(OnContentChangedListener *l) NOTHROWS
+    {
+        // content never changes
+        return TE_Ok;
+    }
+    TAKErr SyntheticTerrainSource::removeOnContentChangedListener(OnContentChangedListener *l) NOTHROWS
+    {
+        return TE_Ok;
+    }
+
+    std::vector<uint8_t> gridGlb(const std::size_t n) NOTHROWS
+    {
+        // binary chunk: float positions followed by uint16 indices
+        std::vector<float> positions;
+        positions.reserve(n * n * 3u);
+        for (std::size_t y = 0u; y < n; y++) {
+            for (std::size_t x = 0u; x < n; x++) {
+                positions.push_back((float)x);
+                positions.push_back((float)y);
+                positions.push_back((float)(std::sin((double)x * 0.2) * std::cos((double)y * 0.2)));
+            }
+        }
+        std::vector<uint16_t> indices;
+        indices.reserve((n - 1u) * (n - 1u) * 6u);
+        for (std::size_t y = 0u; y < n - 1u; y++) {
+            for (std::size_t x = 0u; x < n - 1u; x++) {
+                const uint16_t i = (uint16_t)(y * n + x);
+                indices.push_back(i);
+                indices.push_back((uint16_t)(i + 1u));
+                indices.push_back((uint16_t)(i + n));
+                indices.push_back((uint16_t)(i + 1u));
+                indices.push_back((uint16_t)(i + n + 1u));
+                indices.push_back((uint16_t)(i + n));
+            }
+        }
+        const std::size_t positionsLen = positions.size() * sizeof(float);
+        const std::size_t indicesLen = indices.size() * sizeof(uint16_t);
+        std::vector<uint8_t> bin(positionsLen + indicesLen);
+        memcpy(bin.data(), positions.data(), positionsLen);
+        memcpy(bin.data() + positionsLen, indices.data(), indicesLen);
+        while (bin.size() % 4u)
+            bin.push_back(0u);
+
+        char json[1024];
+        snprintf(json, sizeof(json),
+            "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+            "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}],"
+            "\"buffers\":[{\"byteLength\":%u}],"
+            "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%u,\"target\":34962},"
+            "{\"buffer\":0,\"byteOffset\":%u,\"byteLength\":%u,\"target\":34963}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%u,\"type\":\"VEC3\",\"min\":[0,0,-1],\"max\":[%u,%u,1]},"
+            "{\"bufferView\":1,\"componentType\":5123,\"count\":%u,\"type\":\"SCALAR\"}]}",
+            (unsigned)bin.size(),
+            (unsigned)positionsLen,
+            (unsigned)positionsLen, (unsigned)indicesLen,
+            (unsigned)(n * n), (unsigned)(n - 1u), (unsigned)(n - 1u),
+            (unsigned)indices.size());
+        std::string jsonChunk(json);
+        while (jsonChunk.length() % 4u)
+            jsonChunk.push_back(' ');
+
+        std::vector<uint8_t> glb;
+        auto writeU32 = [&glb](const uint32_t v)
+        {
+            for (std::size_t b = 0u; b < 4u; b++)
+                glb.push_back((uint8_t)(v >> (b * 8u)));
+        };
+        writeU32(0x46546C67u); // "glTF"
+        writeU32(2u);
+        writeU32((uint32_t)(12u + 8u + jsonChunk.length() + 8u + bin.size()));
+        writeU32((uint32_t)jsonChunk.length());
+        writeU32(0x4E4F534Au); // JSON
+        glb.insert(glb.end(), jsonChunk.begin(), jsonChunk.end());
+        writeU32((uint32_t)bin.size());
+        writeU32(0x004E4942u); // BIN
+        glb.insert(glb.end(), bin.begin(), bin.end());
+        return glb;
+    }
+
+    std::string placemarkKml(const std::size_t count) NOTHROWS
+    {
+        Random r(17u);
+        std::string kml;
+        kml.reserve(count * 256u);
+        kml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+               "<Document><name>benchmark</name>\n"
+               "<Style id=\"s\"><LineStyle><color>ff0000ff</color><width>2</width></LineStyle></Style>\n"
+               "<Folder><name>placemarks</name>\n";
+        char buf[128];
+        for (std::size_t i = 0u; i < count; i++) {
+            snprintf(buf, sizeof(buf), "<Placemark><name>p%u</name><styleUrl>#s</styleUrl>", (unsigned)i);
+            kml += buf;
+            if (i % 2u) {
+                kml += "<LineString><coordinates>";
+                for (std::size_t j = 0u; j < 8u; j++) {
+                    snprintf(buf, sizeof(buf), "%.6f,%.6f,0 ", r.next(-180.0, 180.0), r.next(-85.0, 85.0));
+                    kml += buf;
+                }
+                kml += "</coordinates></LineString>";
+            } else {
+                snprintf(buf, sizeof(buf), "<Point><coordinates>%.6f,%.6f,0</coordinates></Point>", r.next(-180.0, 180.0), r.next(-85.0, 85.0));
+                kml += buf;
+            }
+            kml += "</Placemark>\n";
+        }
+        kml += "</Folder></Document></kml>\n";
+        return kml;
+    }
+}
@@ -0,0 +1,115 @@
+#include "core/CameraMotionPredictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util/MathUtils.h"
+
+using namespace TAK::Engine::Core;
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    /** minimum focus displacement over the horizon, as a fraction of the viewport, to predict */
+    const double MIN_PAN_FRACTION = 1.0 / 16.0;
+    /** minimum resolution change over the horizon to predict */
+    const double MIN_ZOOM_RATIO = 1.25;
+    /** limits the extrapolated change in resolution */
+    const double MAX_ZOOM_RATIO = 4.0;
+
+    double wrapLongitude(double lng) NOTHROWS
+    {
+        if (lng > 180.0)
+            lng -= 360.0;
+        else if (lng < -180.0)
+            lng += 360.0;
+        return lng;
+    }
+}
+
+CameraMotionPredictor::CameraMotionPredictor(const int64_t historyMillis_) NOTHROWS :
+    historyMillis(historyMillis_)
+{}
+
+void CameraMotionPredictor::update(const MapSceneModel2 &scene_, const int64_t timestamp) NOTHROWS
+{
+    if (!scene_.projection)
+        return;
+    // history is not comparable across projections or viewport changes
+    if (!history.empty() &&
+        (scene.projection->getSpatialReferenceID() != scene_.projection->getSpatialReferenceID() ||
+         scene.width != scene_.width ||
+         scene.height != scene_.height ||
+         timestamp < history.back().timestamp)) {
+
+        history.clear();
+    }
+
+    Sample sample;
+    sample.timestamp = timestamp;
+    if (scene_.projection->inverse(&sample.focus, scene_.camera.target) != TE_Ok)
+        return;
+    sample.gsd = scene_.gsd;
+
+    // multiple updates within the same frame replace the sample
+    if (!history.empty() && history.back().timestamp == timestamp)
+        history.back() = sample;
+    else
+        history.push_back(sample);
+    while (!history.empty() && history.front().timestamp < (timestamp - historyMillis))
+        history.pop_front();
+
+    scene = scene_;
+}
+
+TAKErr CameraMotionPredictor::predict(MapSceneModel2 *value, const int64_t horizon) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (history.size() < 2u || horizon <= 0LL)
+        return TE_Done;
+
+    const Sample &oldest = history.front();
+    const Sample &newest = history.back();
+    const double dt = (double)(newest.timestamp - oldest.timestamp);
+    if (dt <= 0.0)
+        return TE_Done;
+    const double t = (double)horizon / dt;
+
+    const double dlat = newest.focus.latitude - oldest.focus.latitude;
+    const double dlng = wrapLongitude(newest.focus.longitude - oldest.focus.longitude);
+    GeoPoint2 focus(newest.focus);
+    focus.latitude = MathUtils_clamp(newest.focus.latitude + (dlat * t), -90.0, 90.0);
+    focus.longitude = wrapLongitude(newest.focus.longitude + (dlng * t));
+
+    double zoom = 1.0;
+    if (oldest.gsd > 0.0 && newest.gsd > 0.0)
+        zoom = MathUtils_clamp(pow(newest.gsd / oldest.gsd, t), 1.0 / MAX_ZOOM_RATIO, MAX_ZOOM_RATIO);
+
+    // don't predict if the camera is effectively still
+    const double pan = GeoPoint2_distance(newest.focus, focus, true) / newest.gsd;
+    const double viewport = (double)std::min(scene.width, scene.height);
+    if (pan < (viewport * MIN_PAN_FRACTION) && zoom < MIN_ZOOM_RATIO && zoom > (1.0 / MIN_ZOOM_RATIO))
+        return TE_Done;
+
+    *value = scene;
+    return value->set(scene.displayDpi,
+                      scene.width,
+                      scene.height,
+                      scene.projection->getSpatialReferenceID(),
+                      focus,
+                      scene.focusX,
+                      scene.focusY,
+                      scene.camera.azimuth,
+                      scene.camera.elevation + 90.0,
+                      newest.gsd * zoom,
+                      scene.camera.nearMeters,
+                      scene.camera.farMeters,
+                      scene.camera.mode);
+}
+
+void CameraMotionPredictor::reset() NOTHROWS
+{
+    history.clear();
+}
@@ -0,0 +1,72 @@
+#ifndef TAK_ENGINE_CORE_CAMERAMOTIONPREDICTOR_H_INCLUDED
+#define TAK_ENGINE_CORE_CAMERAMOTIONPREDICTOR_H_INCLUDED
+
+#include <cstdint>
+#include <deque>
+
+#include "core/GeoPoint2.h"
+#include "core/MapSceneModel2.h"
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Core {
+            /**
+             * Extrapolates camera motion from a short history of scenes.
+             * Renderers feed the scene each frame and may request the scene
+             * expected some time in the future in order to load data ahead
+             * of a pan or zoom.
+             *
+             * <P>The focus point is extrapolated linearly and the resolution
+             * geometrically; rotation and tilt are held. This class is not
+             * thread-safe.
+             */
+            class ENGINE_API CameraMotionPredictor
+            {
+            public :
+                /**
+                 * @param historyMillis The window of scene history used to
+                 *                      estimate velocity
+                 */
+                CameraMotionPredictor(const int64_t historyMillis = 250LL) NOTHROWS;
+            public :
+                /**
+                 * Records the scene for the current frame.
+                 *
+                 * @param scene     The current scene
+                 * @param timestamp The frame time, in milliseconds
+                 */
+                void update(const MapSceneModel2 &scene, const int64_t timestamp) NOTHROWS;
+                /**
+                 * Returns the scene expected after the specified interval
+                 * has elapsed since the most recent update.
+                 *
+                 * @param value     Returns the predicted scene
+                 * @param horizon   The prediction interval, in milliseconds
+                 *
+                 * @return  TE_Ok on success, TE_Done if the camera is not
+                 *          moving enough to warrant a prediction
+                 */
+                Util::TAKErr predict(MapSceneModel2 *value, const int64_t horizon) const NOTHROWS;
+                /**
+                 * Discards the scene history.
+                 */
+                void reset() NOTHROWS;
+            private :
+                struct Sample
+                {
+                    int64_t timestamp;
+                    GeoPoint2 focus;
+                    double gsd;
+                };
+            private :
+                int64_t historyMillis;
+                std::deque<Sample> history;
+                MapSceneModel2 scene;
+            };
+        }
+    }
+}
+
+#endif
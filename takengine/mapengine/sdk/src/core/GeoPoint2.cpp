@@ -64,6 +64,18 @@ namespace
         return GeoPoint2(rlat2 / M_PI * 180.0, rlng2 / M_PI * 180.0);
     }
 
+    // number of points projected to ECEF per batch by the array slant
+    // distance functions
+    const std::size_t slantBatchSize = 64u;
+
+    double slantDistance(const Point2<double> &a, const Point2<double> &b) NOTHROWS
+    {
+        const double dx = b.x - a.x;
+        const double dy = b.y - a.y;
+        const double dz = b.z - a.z;
+        return std::sqrt((dx*dx) + (dy*dy) + (dz*dz));
+    }
+
     GeoPoint2 hae(const GeoPoint2 &p) NOTHROWS
     {
         GeoPoint2 retval(p);
@@ -243,6 +255,131 @@ double TAK::Engine::Core::GeoPoint2_bearing(const GeoPoint2 &a, const GeoPoint2
         return result[1];
     return greatCircleBearing(a.latitude, a.longitude, b.latitude, b.longitude);
 }
+TAKErr TAK::Engine::Core::GeoPoint2_distance(double *value, const GeoPoint2 &a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS
+{
+    if (!count)
+        return TE_Ok;
+    if (!value || !b)
+        return TE_InvalidArg;
+    if (quick) {
+        // hoist the terms that depend only on the origin
+        const double R = Datum2::WGS84.reference.semiMajorAxis;
+        const double rlat1 = a.latitude / 180.0*M_PI;
+        const double rlng1 = a.longitude / 180.0*M_PI;
+        const double cos_rlat1 = cos(rlat1);
+        for (std::size_t i = 0u; i < count; i++) {
+            const double rlat2 = b[i].latitude / 180.0*M_PI;
+            const double rlng2 = b[i].longitude / 180.0*M_PI;
+            const double sin_dlat_div_2 = sin((rlat2 - rlat1) / 2.0);
+            const double sin_dlng_div_2 = sin((rlng2 - rlng1) / 2.0);
+            const double h = (sin_dlat_div_2*sin_dlat_div_2) + (cos_rlat1*cos(rlat2)*(sin_dlng_div_2*sin_dlng_div_2));
+            value[i] = R * (2 * atan2(sqrt(h), sqrt(1.0-h)));
+        }
+    } else {
+        const atakmap::core::GeoPoint from(a);
+        for (std::size_t i = 0u; i < count; i++)
+            value[i] = atakmap::util::distance::calculateRange(from, atakmap::core::GeoPoint(b[i]));
+    }
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Core::GeoPoint2_distance(double *value, const GeoPoint2 *a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS
+{
+    if (!count)
+        return TE_Ok;
+    if (!value || !a || !b)
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < count; i++)
+        value[i] = GeoPoint2_distance(a[i], b[i], quick);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Core::GeoPoint2_bearing(double *value, const GeoPoint2 &a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS
+{
+    if (!count)
+        return TE_Ok;
+    if (!value || !b)
+        return TE_InvalidArg;
+    if (quick) {
+        const double rlat1 = a.latitude / 180.0*M_PI;
+        const double rlng1 = a.longitude / 180.0*M_PI;
+        const double sin_rlat1 = sin(rlat1);
+        const double cos_rlat1 = cos(rlat1);
+        for (std::size_t i = 0u; i < count; i++) {
+            const double rlat2 = b[i].latitude / 180.0*M_PI;
+            const double rlng2 = b[i].longitude / 180.0*M_PI;
+            const double cos_rlat2 = cos(rlat2);
+            const double rbrng = atan2(sin(rlng2 - rlng1) * cos_rlat2, (cos_rlat1*sin(rlat2)) - (sin_rlat1*cos_rlat2*cos(rlng2-rlng1)));
+            value[i] = rbrng / M_PI*180.0;
+        }
+    } else {
+        const atakmap::core::GeoPoint from(a);
+        for (std::size_t i = 0u; i < count; i++) {
+            double result[2];
+            if (atakmap::util::distance::computeDirection(from, atakmap::core::GeoPoint(b[i]), result))
+                value[i] = result[1];
+            else
+                value[i] = greatCircleBearing(a.latitude, a.longitude, b[i].latitude, b[i].longitude);
+        }
+    }
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Core::GeoPoint2_bearing(double *value, const GeoPoint2 *a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS
+{
+    if (!count)
+        return TE_Ok;
+    if (!value || !a || !b)
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < count; i++)
+        value[i] = GeoPoint2_bearing(a[i], b[i], quick);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Core::GeoPoint2_slantDistance(double *value, const GeoPoint2 &a, const GeoPoint2 *b, const std::size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!count)
+        return TE_Ok;
+    if (!value || !b)
+        return TE_InvalidArg;
+    Projection2Ptr ecef(nullptr, nullptr);
+    code = ProjectionFactory3_create(ecef, 4978);
+    TE_CHECKRETURN_CODE(code);
+
+    Point2<double> ptA;
+    code = ecef->forward(&ptA, a);
+    TE_CHECKRETURN_CODE(code);
+    Point2<double> ptB[slantBatchSize];
+    for (std::size_t off = 0u; off < count; off += slantBatchSize) {
+        const std::size_t n = std::min(count - off, slantBatchSize);
+        code = ecef->forward(ptB, b + off, n);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < n; i++)
+            value[off + i] = slantDistance(ptA, ptB[i]);
+    }
+    return code;
+}
+TAKErr TAK::Engine::Core::GeoPoint2_slantDistance(double *value, const GeoPoint2 *a, const GeoPoint2 *b, const std::size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!count)
+        return TE_Ok;
+    if (!value || !a || !b)
+        return TE_InvalidArg;
+    Projection2Ptr ecef(nullptr, nullptr);
+    code = ProjectionFactory3_create(ecef, 4978);
+    TE_CHECKRETURN_CODE(code);
+
+    Point2<double> ptA[slantBatchSize];
+    Point2<double> ptB[slantBatchSize];
+    for (std::size_t off = 0u; off < count; off += slantBatchSize) {
+        const std::size_t n = std::min(count - off, slantBatchSize);
+        code = ecef->forward(ptA, a + off, n);
+        TE_CHECKRETURN_CODE(code);
+        code = ecef->forward(ptB, b + off, n);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < n; i++)
+            value[off + i] = slantDistance(ptA[i], ptB[i]);
+    }
+    return code;
+}
 GeoPoint2 TAK::Engine::Core::GeoPoint2_midpoint(const GeoPoint2 &a, const GeoPoint2 &b, const bool quick) NOTHROWS
 {
     return GeoPoint2_pointAtDistance(a, GeoPoint2_bearing(a, b, quick), GeoPoint2_distance(a, b, quick) / 2.0, quick);
@@ -1,6 +1,8 @@
 #ifndef TAK_ENGINE_CORE_GEOPOINT2_H_INCLUDED
 #define TAK_ENGINE_CORE_GEOPOINT2_H_INCLUDED
 
+#include <cstddef>
+
 #include "port/Platform.h"
 #include "util/Error.h"
 
@@ -45,6 +47,43 @@ namespace TAK
 
             ENGINE_API double GeoPoint2_distance(const GeoPoint2 &a, const GeoPoint2 &b, const bool quick) NOTHROWS;
             ENGINE_API double GeoPoint2_bearing(const GeoPoint2 &a, const GeoPoint2 &b, const bool quick) NOTHROWS;
+
+            /**
+             * Computes the distance from `a` to each of the `count` points
+             * in `b`, as though by invoking `GeoPoint2_distance` for each.
+             *
+             * @param value Returns the distances, in meters
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr GeoPoint2_distance(double *value, const GeoPoint2 &a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS;
+            /**
+             * Computes the distance between each of the `count` pairs
+             * `a[i]` and `b[i]`.
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr GeoPoint2_distance(double *value, const GeoPoint2 *a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS;
+            /**
+             * Computes the bearing from `a` to each of the `count` points
+             * in `b`, as though by invoking `GeoPoint2_bearing` for each.
+             *
+             * @param value Returns the bearings, in degrees
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr GeoPoint2_bearing(double *value, const GeoPoint2 &a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS;
+            /**
+             * Computes the bearing from `a[i]` to `b[i]` for each of the
+             * `count` pairs.
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr GeoPoint2_bearing(double *value, const GeoPoint2 *a, const GeoPoint2 *b, const std::size_t count, const bool quick) NOTHROWS;
+            /**
+             * Computes the slant distance from `a` to each of the `count`
+             * points in `b`, as though by invoking
+             * `GeoPoint2_slantDistance` for each.
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr GeoPoint2_slantDistance(double *value, const GeoPoint2 &a, const GeoPoint2 *b, const std::size_t count) NOTHROWS;
+            /**
+             * Computes the slant distance between each of the `count` pairs
+             * `a[i]` and `b[i]`.
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr GeoPoint2_slantDistance(double *value, const GeoPoint2 *a, const GeoPoint2 *b, const std::size_t count) NOTHROWS;
+
             ENGINE_API GeoPoint2 GeoPoint2_midpoint(const GeoPoint2 &a, const GeoPoint2 &b, const bool quick) NOTHROWS;
             ENGINE_API GeoPoint2 GeoPoint2_pointAtDistance(const GeoPoint2 &a, const double az, const double distance, const bool quick) NOTHROWS;
             ENGINE_API GeoPoint2 GeoPoint2_pointAtDistance(const GeoPoint2 &a, const double az, const double distance, const double inclination, const bool quick) NOTHROWS;
@@ -68,6 +68,8 @@ TAKErr Globe::addLayer(const std::shared_ptr<Layer2> &layer) NOTHROWS
     TE_CHECKRETURN_CODE(code);
 
     layers_.push_back(layer);
+    code = publishLayers();
+    TE_CHECKRETURN_CODE(code);
     dispatchLayerAdded(layer);
     return code;
 }
@@ -81,6 +83,8 @@ TAKErr Globe::insertLayer(const std::size_t idx, const std::shared_ptr<Layer2> &
         return TE_BadIndex;
 
     layers_.insert(layers_.begin() + idx, layer);
+    code = publishLayers();
+    TE_CHECKRETURN_CODE(code);
 
     dispatchLayerAdded(layer);
 
@@ -104,6 +108,8 @@ TAKErr Globe::removeLayer(const Layer2 &layer) NOTHROWS
         }
     }
     TE_CHECKRETURN_CODE(code);
+    code = publishLayers();
+    TE_CHECKRETURN_CODE(code);
 
     if (!removed.empty())
         dispatchLayersRemoved(removed);
@@ -121,6 +127,8 @@ TAKErr Globe::removeAllLayers() NOTHROWS
     for (std::size_t i = 0u; i < layers_.size(); i++)
         removed.push_back(layers_[i]);
     layers_.clear();
+    code = publishLayers();
+    TE_CHECKRETURN_CODE(code);
     if (!removed.empty())
         dispatchLayersRemoved(removed);
     return code;
@@ -160,44 +168,59 @@ TAKErr Globe::setLayerPosition(const Layer2 &layer, const std::size_t position)
     } else {
         return TE_IllegalState;
     }
+    code = publishLayers();
+    TE_CHECKRETURN_CODE(code);
         
     this->dispatchLayerPositionChanged(layerPtr, oldPos, position);
     return code;
 }
 std::size_t Globe::getNumLayers() const NOTHROWS
 {
-    LockPtr lock(nullptr, nullptr);
-    Lock_create(lock, map_mutex_);
-    return layers_.size();
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    return layers->size();
 }
 TAKErr Globe::getLayer(std::shared_ptr<Layer2> &value, const std::size_t position) const NOTHROWS
 {
-    TAKErr code(TE_Ok);
-    LockPtr lock(nullptr, nullptr);
-    code = Lock_create(lock, map_mutex_);
-    TE_CHECKRETURN_CODE(code);
-
-    if (position >= layers_.size())
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    if (position >= layers->size())
         return TE_BadIndex;
 
-    value = this->layers_[position];
-    return code;
+    value = (*layers)[position];
+    return TE_Ok;
 }
 TAKErr Globe::getLayers(TAK::Engine::Port::Collection<std::shared_ptr<Layer2>> &retLayers) const NOTHROWS
 {
     TAKErr code(TE_Ok);
-    LockPtr lock(nullptr, nullptr);
-    code = Lock_create(lock, map_mutex_);
-    TE_CHECKRETURN_CODE(code);
-
-    for (std::size_t i = 0u; i < this->layers_.size(); i++) {
-        code = retLayers.add(this->layers_[i]);
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    for (auto it = layers->begin(); it != layers->end(); it++) {
+        code = retLayers.add(*it);
         TE_CHECKBREAK_CODE(code);
     }
     TE_CHECKRETURN_CODE(code);
 
     return code;
 }
+TAKErr Globe::visitLayers(TAKErr(*visitor)(void *opaque, Layer2& layer) NOTHROWS, void *opaque) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!visitor)
+        return TE_InvalidArg;
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    for (auto it = layers->begin(); it != layers->end(); it++) {
+        code = visitor(opaque, **it);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+TAKErr Globe::publishLayers() NOTHROWS
+{
+    const std::vector<std::shared_ptr<Layer2>> &layers = this->layers_;
+    return layers_snapshot_.update([&layers](std::vector<std::shared_ptr<Layer2>> &value) -> TAKErr
+    {
+        value = layers;
+        return TE_Ok;
+    });
+}
 TAKErr Globe::addLayersChangedListener(LayersChangedListener &listener) NOTHROWS
 {
     TAKErr code(TE_Ok);
@@ -13,6 +13,7 @@
 #include "port/Collection.h"
 #include "port/Platform.h"
 #include "thread/Mutex.h"
+#include "thread/ReadCopyUpdate.h"
 #include "util/Error.h"
 
 namespace TAK {
@@ -39,6 +40,13 @@ namespace TAK {
                 std::size_t getNumLayers() const NOTHROWS;
                 Util::TAKErr getLayer(std::shared_ptr<Layer2> &value, const std::size_t position) const NOTHROWS;
                 Util::TAKErr getLayers(Port::Collection<std::shared_ptr<Layer2>> &value) const NOTHROWS;
+                /**
+                 * Visits a snapshot of the current layer stack, bottom to
+                 * top. No lock is held during the visit, so the render
+                 * thread is never blocked by modification of the stack.
+                 * Visitation stops if the visitor returns a code other than
+                 * `TE_Ok`.
+                 */
                 Util::TAKErr visitLayers(Util::TAKErr(*visitor)(void *opaque, Layer2& layer) NOTHROWS, void *opaque) const NOTHROWS;
 
                 Util::TAKErr addLayersChangedListener(LayersChangedListener &listener) NOTHROWS;
@@ -93,6 +101,9 @@ namespace TAK {
             private: // member functions
                 void updateView(const GeoPoint2 &c, double mapScale, double rot, double ptilt, bool anim) NOTHROWS;
 
+                /** publishes `layers_` to readers; must hold `map_mutex_` */
+                Util::TAKErr publishLayers() NOTHROWS;
+
                 void dispatchMapResized(const std::size_t width, const std::size_t height) const NOTHROWS;
 
                 void dispatchMapMoved(const bool animate) const NOTHROWS;
@@ -120,6 +131,8 @@ namespace TAK {
                 TAK::Engine::Core::ProjectionPtr2 projection_;
 
                 std::vector<std::shared_ptr<TAK::Engine::Core::Layer2>> layers_;
+                /** read-side copy of `layers_`; queried without `map_mutex_` */
+                TAK::Engine::Thread::ReadCopyUpdate<std::vector<std::shared_ptr<TAK::Engine::Core::Layer2>>> layers_snapshot_;
 
                 // callbacks
                 std::set<LayersChangedListener *> layers_changed_listeners_;
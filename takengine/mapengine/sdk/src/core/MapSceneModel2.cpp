@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <map>
+#include <type_traits>
 
 #include "core/Datum2.h"
 #include "core/GeoPoint.h"
@@ -78,6 +80,23 @@ namespace
     TAKErr rotateAboutImpl(MapSceneModel2Ptr &value, const MapSceneModel2 &scene, const GeoPoint2 &point, const double theta, const double ax, const double ay, const double az) NOTHROWS;
     TAKErr createTargetTransform(Matrix2 *xformTarget, const GeoPoint2 &focusGeo, Projection2 &mapProjection, const double mapRotation, const double mapTilt) NOTHROWS;
     MapCamera2::Mode &defaultCameraMode() NOTHROWS;
+
+    /** number of points processed per pass by the batch transforms */
+    const std::size_t batchSize = 64u;
+
+    template<class T>
+    TAKErr forwardBatch(Point2<T> *points, const GeoPoint2 *geos, const std::size_t count, const std::size_t pointStride, const std::size_t geoStride, const Projection2 &projection, const Matrix2 &forwardTransform) NOTHROWS;
+    /**
+     * Intersects the ray from `org` through `tgt`, both in the projected
+     * coordinate space, with the model.
+     */
+    bool intersectScreenRay(Point2<double> *value, const Point2<double> &org, const Point2<double> &tgt, const GeometryModel2 &model, const bool nearestIfOffWorld) NOTHROWS;
+    template<class T>
+    inline T &strided(T *base, const std::size_t stride, const std::size_t i) NOTHROWS
+    {
+        typedef typename std::conditional<std::is_const<T>::value, const uint8_t, uint8_t>::type Byte;
+        return *reinterpret_cast<T *>(reinterpret_cast<Byte *>(base) + (i * stride));
+    }
 }
 
 MapSceneModel2::MapSceneModel2() NOTHROWS :
@@ -196,21 +215,8 @@ TAKErr MapSceneModel2::inverse(GeoPoint2 *value, const Point2<float> &point,
     code = inverseTransform.transform(&tgt, tgt);
     TE_CHECKRETURN_CODE(code);
 
-    Vector4<double> dir(tgt.x - org.x, tgt.y - org.y, tgt.z - org.z);
-    dir.normalize(&dir);
-
     Point2<double> pt;
-
-    Ray2<double> onWorld(org, dir);
-    bool isect = model.intersect(&pt, onWorld);
-    if (!isect && nearestIfOffWorld)
-    {
-        Vector4<double> owv(-tgt.x, -tgt.y, -tgt.z);
-        owv.normalize(&owv);
-        Ray2<double> offWorld(tgt, owv);
-        isect = model.intersect(&pt, offWorld);
-    }
-    if (isect)
+    if (intersectScreenRay(&pt, org, tgt, model, nearestIfOffWorld))
     {
         projection->inverse(value, pt);
         return TE_Ok;
@@ -219,6 +225,71 @@ TAKErr MapSceneModel2::inverse(GeoPoint2 *value, const Point2<float> &point,
     return TE_Err;
 }
 
+TAKErr MapSceneModel2::forward(Point2<float> *points, const GeoPoint2 *geos, const std::size_t count, const std::size_t pointStride, const std::size_t geoStride) const NOTHROWS
+{
+    if (!projection)
+        return TE_IllegalState;
+    return forwardBatch(points, geos, count, pointStride, geoStride, *projection, forwardTransform);
+}
+
+TAKErr MapSceneModel2::forward(Point2<double> *points, const GeoPoint2 *geos, const std::size_t count, const std::size_t pointStride, const std::size_t geoStride) const NOTHROWS
+{
+    if (!projection)
+        return TE_IllegalState;
+    return forwardBatch(points, geos, count, pointStride, geoStride, *projection, forwardTransform);
+}
+
+TAKErr MapSceneModel2::inverse(GeoPoint2 *geos, const Point2<float> *points, const std::size_t count, const bool nearestIfOffWorld, const std::size_t geoStride_, const std::size_t pointStride_) const NOTHROWS
+{
+    if (!projection || !earth)
+        return TE_IllegalState;
+    if (!count)
+        return TE_Ok;
+    if (!geos || !points)
+        return TE_InvalidArg;
+    const std::size_t geoStride = geoStride_ ? geoStride_ : sizeof(GeoPoint2);
+    const std::size_t pointStride = pointStride_ ? pointStride_ : sizeof(Point2<float>);
+    const bool perspective = (camera.mode == MapCamera2::Perspective);
+
+    TAKErr code(TE_Ok);
+    Point2<double> org[batchSize];
+    Point2<double> tgt[batchSize];
+    Point2<double> isect[batchSize];
+    std::size_t isectIdx[batchSize];
+    GeoPoint2 lla[batchSize];
+    for (std::size_t off = 0u; off < count; off += batchSize) {
+        const std::size_t n = std::min(batchSize, count - off);
+        for (std::size_t i = 0u; i < n; i++) {
+            const Point2<float> &point = strided(points, pointStride, off + i);
+            tgt[i] = Point2<double>(point.x, point.y, 1.0);
+            org[i] = perspective ? camera.location : Point2<double>(point.x, point.y, -1.0);
+        }
+        if (inverseTransform.transform(&tgt[0].x, &tgt[0].x, n, 3u) != TE_Ok ||
+            (!perspective && inverseTransform.transform(&org[0].x, &org[0].x, n, 3u) != TE_Ok)) {
+
+            // the batch cannot distinguish which points failed
+            for (std::size_t i = 0u; i < n; i++) {
+                if (this->inverse(&strided(geos, geoStride, off + i), strided(points, pointStride, off + i), *earth, nearestIfOffWorld) != TE_Ok)
+                    code = TE_Err;
+            }
+            continue;
+        }
+
+        std::size_t numIsect = 0u;
+        for (std::size_t i = 0u; i < n; i++) {
+            if (intersectScreenRay(&isect[numIsect], org[i], tgt[i], *earth, nearestIfOffWorld))
+                isectIdx[numIsect++] = i;
+            else
+                code = TE_Err;
+        }
+        if (Projection2_inverse(lla, *projection, isect, numIsect) != TE_Ok)
+            return TE_Err;
+        for (std::size_t i = 0u; i < numIsect; i++)
+            strided(geos, geoStride, off + isectIdx[i]) = lla[i];
+    }
+    return code;
+}
+
 TAKErr MapSceneModel2::init(double display_dpi, std::size_t map_width, std::size_t map_height, int srid, const GeoPoint2 &focusGeo, float focus_x,
     float focus_y, double rotation, double tilt, double resolution, const double nearMeters, const double farMeters, const MapCamera2::Mode mode) NOTHROWS
 {
@@ -1522,4 +1593,51 @@ namespace
 #endif
         return m;
     }
+
+    template<class T>
+    TAKErr forwardBatch(Point2<T> *points, const GeoPoint2 *geos, const std::size_t count, const std::size_t pointStride_, const std::size_t geoStride_, const Projection2 &projection, const Matrix2 &forwardTransform) NOTHROWS
+    {
+        static_assert(sizeof(Point2<double>) == 3u * sizeof(double), "Point2<double> must be packed");
+
+        if (!count)
+            return TE_Ok;
+        if (!points || !geos)
+            return TE_InvalidArg;
+        const std::size_t pointStride = pointStride_ ? pointStride_ : sizeof(Point2<T>);
+        const std::size_t geoStride = geoStride_ ? geoStride_ : sizeof(GeoPoint2);
+
+        TAKErr code(TE_Ok);
+        Point2<double> xyz[batchSize];
+        for (std::size_t off = 0u; off < count; off += batchSize) {
+            const std::size_t n = std::min(batchSize, count - off);
+            code = Projection2_forward(xyz, projection, &strided(geos, geoStride, off), n, 0u, geoStride);
+            TE_CHECKRETURN_CODE(code);
+            if (forwardTransform.transform(&xyz[0].x, &xyz[0].x, n, 3u) != TE_Ok)
+                code = TE_Err;
+            for (std::size_t i = 0u; i < n; i++) {
+                Point2<T> &point = strided(points, pointStride, off + i);
+                point.x = (T)xyz[i].x;
+                point.y = (T)xyz[i].y;
+                point.z = (T)xyz[i].z;
+            }
+        }
+        return code;
+    }
+
+    bool intersectScreenRay(Point2<double> *value, const Point2<double> &org, const Point2<double> &tgt, const GeometryModel2 &model, const bool nearestIfOffWorld) NOTHROWS
+    {
+        Vector4<double> dir(tgt.x - org.x, tgt.y - org.y, tgt.z - org.z);
+        dir.normalize(&dir);
+
+        Ray2<double> onWorld(org, dir);
+        bool isect = model.intersect(value, onWorld);
+        if (!isect && nearestIfOffWorld)
+        {
+            Vector4<double> owv(-tgt.x, -tgt.y, -tgt.z);
+            owv.normalize(&owv);
+            Ray2<double> offWorld(tgt, owv);
+            isect = model.intersect(value, offWorld);
+        }
+        return isect;
+    }
 }
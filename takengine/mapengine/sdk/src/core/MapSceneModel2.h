@@ -43,6 +43,34 @@ namespace TAK {
                 Util::TAKErr inverse(GeoPoint2 *geo, const Math::Point2<float> &point) const NOTHROWS;
                 Util::TAKErr inverse(GeoPoint2 *geo, const Math::Point2<float> &point, const bool nearestIfOffWorld) const NOTHROWS;
                 Util::TAKErr inverse(GeoPoint2  *geo, const Math::Point2<float> &point, const Math::GeometryModel2& model) const NOTHROWS;
+                /**
+                 * Transforms `count` points from LLA to screen coordinates.
+                 * The projection and the forward transform are each applied
+                 * over the whole batch.
+                 *
+                 * @param pointStride   The number of bytes between
+                 *                      consecutive screen points; `0` if
+                 *                      tightly packed
+                 * @param geoStride     The number of bytes between
+                 *                      consecutive LLA points; `0` if
+                 *                      tightly packed
+                 *
+                 * @return  TE_Ok on success; TE_Err if any point could not
+                 *          be transformed, in which case the values of
+                 *          those points are undefined
+                 */
+                Util::TAKErr forward(Math::Point2<float> *points, const GeoPoint2 *geos, const std::size_t count, const std::size_t pointStride = 0u, const std::size_t geoStride = 0u) const NOTHROWS;
+                Util::TAKErr forward(Math::Point2<double> *points, const GeoPoint2 *geos, const std::size_t count, const std::size_t pointStride = 0u, const std::size_t geoStride = 0u) const NOTHROWS;
+                /**
+                 * Transforms `count` screen coordinates to LLA via ray
+                 * intersection with the earth. Strides are as for the
+                 * batch `forward`.
+                 *
+                 * @return  TE_Ok on success; TE_Err if any point does not
+                 *          intersect, in which case those points are left
+                 *          unmodified
+                 */
+                Util::TAKErr inverse(GeoPoint2 *geos, const Math::Point2<float> *points, const std::size_t count, const bool nearestIfOffWorld, const std::size_t geoStride = 0u, const std::size_t pointStride = 0u) const NOTHROWS;
             public:
                 MapSceneModel2 &operator=(const MapSceneModel2 &other) NOTHROWS;
             private:
@@ -0,0 +1,359 @@
+#include "core/MapViewRecorder.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+
+#include "core/GeoPoint.h"
+#include "thread/Lock.h"
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Port;
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    const char *typeName(const MapViewEvent::Type type) NOTHROWS
+    {
+        switch (type) {
+        case MapViewEvent::Camera :
+            return "camera";
+        case MapViewEvent::Resized :
+            return "resized";
+        case MapViewEvent::LayerAdded :
+            return "layer_added";
+        case MapViewEvent::LayerRemoved :
+            return "layer_removed";
+        case MapViewEvent::LayerMoved :
+            return "layer_moved";
+        case MapViewEvent::LayerVisible :
+            return "layer_visible";
+        default :
+            return nullptr;
+        }
+    }
+
+    TAKErr parseLine(MapViewEvent &value, const char *line) NOTHROWS
+    {
+        char *end;
+        value.timestamp = strtoll(line, &end, 10);
+        if (end == line)
+            return TE_InvalidArg;
+        line = end;
+        while (*line == ' ')
+            line++;
+        const char *sep = strchr(line, ' ');
+        const std::size_t typeLen = sep ? (std::size_t)(sep - line) : strlen(line);
+        const char *args = sep ? sep + 1 : "";
+
+        auto is = [line, typeLen](const char *name) { return strlen(name) == typeLen && !strncmp(line, name, typeLen); };
+        // layer names are the remainder of the line and may contain spaces
+        int nameOffset = -1;
+        if (is("camera")) {
+            value.type = MapViewEvent::Camera;
+            double lat, lng, alt;
+            int animate;
+            if (sscanf(args, "%lf %lf %lf %lf %lf %lf %d", &lat, &lng, &alt, &value.resolution, &value.rotation, &value.tilt, &animate) != 7)
+                return TE_InvalidArg;
+            value.focus = GeoPoint2(lat, lng, alt, AltitudeReference::HAE);
+            value.animate = !!animate;
+        } else if (is("resized")) {
+            value.type = MapViewEvent::Resized;
+            if (sscanf(args, "%f %f", &value.width, &value.height) != 2)
+                return TE_InvalidArg;
+        } else if (is("layer_added")) {
+            value.type = MapViewEvent::LayerAdded;
+            if (sscanf(args, "%d %n", &value.position, &nameOffset) != 1)
+                return TE_InvalidArg;
+        } else if (is("layer_removed")) {
+            value.type = MapViewEvent::LayerRemoved;
+            nameOffset = 0;
+        } else if (is("layer_moved")) {
+            value.type = MapViewEvent::LayerMoved;
+            if (sscanf(args, "%d %d %n", &value.oldPosition, &value.position, &nameOffset) != 2)
+                return TE_InvalidArg;
+        } else if (is("layer_visible")) {
+            value.type = MapViewEvent::LayerVisible;
+            int visible;
+            if (sscanf(args, "%d %n", &visible, &nameOffset) != 1)
+                return TE_InvalidArg;
+            value.visible = !!visible;
+        } else {
+            return TE_InvalidArg;
+        }
+        if (value.type != MapViewEvent::Camera && value.type != MapViewEvent::Resized) {
+            if (nameOffset < 0)
+                return TE_InvalidArg;
+            value.layer = args + nameOffset;
+        }
+        return TE_Ok;
+    }
+}
+
+MapViewEvent::MapViewEvent() NOTHROWS :
+    timestamp(0LL),
+    type(Camera),
+    resolution(NAN),
+    rotation(0.0),
+    tilt(0.0),
+    animate(false),
+    width(0.f),
+    height(0.f),
+    position(-1),
+    oldPosition(-1),
+    visible(true)
+{}
+
+MapViewRecorder::MapViewRecorder(atakmap::core::AtakMapView &view_) NOTHROWS :
+    view(view_),
+    recording(false),
+    startTime(0LL)
+{}
+MapViewRecorder::~MapViewRecorder() NOTHROWS
+{
+    stop();
+}
+TAKErr MapViewRecorder::start() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    code = stop();
+    TE_CHECKRETURN_CODE(code);
+    {
+        Lock lock(mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        events.clear();
+        startTime = Platform_systime_millis();
+        recording = true;
+    }
+
+    // listeners are registered without holding `mutex`; callbacks are
+    // dispatched while the view holds its own lock
+    view.addMapMovedListener(this);
+    view.addLayersChangedListener(this);
+    view.addMapResizedListener(this);
+
+    // initial state
+    recordCamera(false);
+    std::list<atakmap::core::Layer *> layers;
+    view.getLayers(layers);
+    for (auto it = layers.begin(); it != layers.end(); it++) {
+        (*it)->addVisibilityListener(this);
+        recordLayer(MapViewEvent::LayerVisible, **it, -1, -1);
+    }
+    return code;
+}
+TAKErr MapViewRecorder::stop() NOTHROWS
+{
+    std::set<atakmap::core::Layer *> layers;
+    {
+        Lock lock(mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        if (!recording)
+            return TE_Ok;
+        recording = false;
+        layers.swap(observed);
+    }
+
+    view.removeMapMovedListener(this);
+    view.removeLayersChangedListener(this);
+    view.removeMapResizedListener(this);
+    for (auto it = layers.begin(); it != layers.end(); it++)
+        (*it)->removeVisibilityListener(this);
+    return TE_Ok;
+}
+bool MapViewRecorder::isRecording() const NOTHROWS
+{
+    Lock lock(mutex);
+    return recording;
+}
+TAKErr MapViewRecorder::getEvents(std::vector<MapViewEvent> &value) const NOTHROWS
+{
+    Lock lock(mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+    value = events;
+    return TE_Ok;
+}
+void MapViewRecorder::mapMoved(atakmap::core::AtakMapView *map_view, const bool animate)
+{
+    recordCamera(animate);
+}
+void MapViewRecorder::mapLayerAdded(atakmap::core::AtakMapView *map_view, atakmap::core::Layer *layer)
+{
+    if (!layer)
+        return;
+    int position = -1;
+    std::list<atakmap::core::Layer *> layers;
+    view.getLayers(layers);
+    int idx = 0;
+    for (auto it = layers.begin(); it != layers.end(); it++, idx++) {
+        if (*it == layer) {
+            position = idx;
+            break;
+        }
+    }
+    layer->addVisibilityListener(this);
+    recordLayer(MapViewEvent::LayerAdded, *layer, -1, position);
+}
+void MapViewRecorder::mapLayerRemoved(atakmap::core::AtakMapView *map_view, atakmap::core::Layer *layer)
+{
+    if (!layer)
+        return;
+    layer->removeVisibilityListener(this);
+    recordLayer(MapViewEvent::LayerRemoved, *layer, -1, -1);
+}
+void MapViewRecorder::mapLayerPositionChanged(atakmap::core::AtakMapView *map_view, atakmap::core::Layer *layer, const int oldPos, const int newPos)
+{
+    if (!layer)
+        return;
+    recordLayer(MapViewEvent::LayerMoved, *layer, oldPos, newPos);
+}
+void MapViewRecorder::mapResized(atakmap::core::AtakMapView *map_view)
+{
+    MapViewEvent event;
+    event.type = MapViewEvent::Resized;
+    event.width = view.getWidth();
+    event.height = view.getHeight();
+
+    Lock lock(mutex);
+    if (!recording)
+        return;
+    event.timestamp = elapsed();
+    events.push_back(event);
+}
+void MapViewRecorder::visibilityChanged(atakmap::core::Layer &layer)
+{
+    recordLayer(MapViewEvent::LayerVisible, layer, -1, -1);
+}
+int64_t MapViewRecorder::elapsed() const NOTHROWS
+{
+    return Platform_systime_millis() - startTime;
+}
+void MapViewRecorder::recordCamera(const bool animate) NOTHROWS
+{
+    // same state that `GLGlobe` follows
+    atakmap::core::GeoPoint p;
+    view.getPoint(&p);
+
+    MapViewEvent event;
+    event.type = MapViewEvent::Camera;
+    event.focus = GeoPoint2(p.latitude, p.longitude, p.altitude, AltitudeReference::HAE);
+    event.resolution = view.getMapResolution();
+    event.rotation = view.getMapRotation();
+    event.tilt = view.getMapTilt();
+    event.animate = animate;
+
+    Lock lock(mutex);
+    if (!recording)
+        return;
+    event.timestamp = elapsed();
+    events.push_back(event);
+}
+void MapViewRecorder::recordLayer(const MapViewEvent::Type type, atakmap::core::Layer &layer, const int oldPosition, const int position) NOTHROWS
+{
+    MapViewEvent event;
+    event.type = type;
+    event.layer = layer.getName() ? layer.getName() : "";
+    event.oldPosition = oldPosition;
+    event.position = position;
+    event.visible = layer.isVisible();
+
+    Lock lock(mutex);
+    if (!recording)
+        return;
+    if (type == MapViewEvent::LayerRemoved)
+        observed.erase(&layer);
+    else
+        observed.insert(&layer);
+    event.timestamp = elapsed();
+    events.push_back(event);
+}
+
+TAKErr TAK::Engine::Core::MapViewRecording_write(DataOutput2 &sink, const std::vector<MapViewEvent> &events) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    static const char header[] = "# map view recording\n";
+    code = sink.write(reinterpret_cast<const uint8_t *>(header), sizeof(header)-1u);
+    TE_CHECKRETURN_CODE(code);
+
+    char buf[256];
+    for (auto it = events.begin(); it != events.end(); it++) {
+        const MapViewEvent &e = *it;
+        const char *type = typeName(e.type);
+        if (!type)
+            return TE_InvalidArg;
+        int len;
+        switch (e.type) {
+        case MapViewEvent::Camera :
+            len = snprintf(buf, sizeof(buf), "%" PRId64 " %s %.9f %.9f %.3f %.9g %.6f %.6f %d\n",
+                e.timestamp, type, e.focus.latitude, e.focus.longitude, std::isnan(e.focus.altitude) ? 0.0 : e.focus.altitude,
+                e.resolution, e.rotation, e.tilt, e.animate ? 1 : 0);
+            break;
+        case MapViewEvent::Resized :
+            len = snprintf(buf, sizeof(buf), "%" PRId64 " %s %.1f %.1f\n", e.timestamp, type, e.width, e.height);
+            break;
+        case MapViewEvent::LayerAdded :
+            len = snprintf(buf, sizeof(buf), "%" PRId64 " %s %d ", e.timestamp, type, e.position);
+            break;
+        case MapViewEvent::LayerMoved :
+            len = snprintf(buf, sizeof(buf), "%" PRId64 " %s %d %d ", e.timestamp, type, e.oldPosition, e.position);
+            break;
+        case MapViewEvent::LayerVisible :
+            len = snprintf(buf, sizeof(buf), "%" PRId64 " %s %d ", e.timestamp, type, e.visible ? 1 : 0);
+            break;
+        default :
+            len = snprintf(buf, sizeof(buf), "%" PRId64 " %s ", e.timestamp, type);
+            break;
+        }
+        code = sink.write(reinterpret_cast<const uint8_t *>(buf), (std::size_t)len);
+        TE_CHECKBREAK_CODE(code);
+        if (e.type != MapViewEvent::Camera && e.type != MapViewEvent::Resized) {
+            // names are written to the end of the line
+            std::string name(e.layer);
+            for (std::size_t i = 0u; i < name.length(); i++)
+                if (name[i] == '\n' || name[i] == '\r')
+                    name[i] = ' ';
+            name.push_back('\n');
+            code = sink.write(reinterpret_cast<const uint8_t *>(name.c_str()), name.length());
+            TE_CHECKBREAK_CODE(code);
+        }
+    }
+    return code;
+}
+TAKErr TAK::Engine::Core::MapViewRecording_read(std::vector<MapViewEvent> &events, DataInput2 &src) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    std::string content;
+    uint8_t buf[4096];
+    do {
+        std::size_t numRead = 0u;
+        code = src.read(buf, &numRead, sizeof(buf));
+        if (code == TE_EOF || (code == TE_Ok && !numRead))
+            break;
+        TE_CHECKRETURN_CODE(code);
+        content.append(reinterpret_cast<const char *>(buf), numRead);
+    } while (true);
+
+    std::size_t lineStart = 0u;
+    while (lineStart < content.length()) {
+        std::size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = content.length();
+        std::string line(content, lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1u;
+        if (!line.empty() && line[line.length()-1u] == '\r')
+            line.resize(line.length()-1u);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        MapViewEvent event;
+        code = parseLine(event, line.c_str());
+        TE_CHECKRETURN_CODE(code);
+        events.push_back(event);
+    }
+    return TE_Ok;
+}
@@ -0,0 +1,135 @@
+#ifndef TAK_ENGINE_CORE_MAPVIEWRECORDER_H_INCLUDED
+#define TAK_ENGINE_CORE_MAPVIEWRECORDER_H_INCLUDED
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "core/AtakMapView.h"
+#include "core/GeoPoint2.h"
+#include "core/Layer.h"
+#include "port/Platform.h"
+#include "thread/Mutex.h"
+#include "util/DataInput2.h"
+#include "util/DataOutput2.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Core {
+            /**
+             * A camera or layer state change observed on an `AtakMapView`.
+             */
+            struct ENGINE_API MapViewEvent
+            {
+                enum Type
+                {
+                    Camera,
+                    Resized,
+                    LayerAdded,
+                    LayerRemoved,
+                    LayerMoved,
+                    LayerVisible,
+                };
+
+                MapViewEvent() NOTHROWS;
+
+                /** milliseconds since the start of the recording */
+                int64_t timestamp;
+                Type type;
+
+                // Camera
+                GeoPoint2 focus;
+                double resolution;
+                double rotation;
+                double tilt;
+                bool animate;
+
+                // Resized
+                float width;
+                float height;
+
+                // LayerAdded, LayerRemoved, LayerMoved, LayerVisible
+                std::string layer;
+                /** new position for LayerAdded and LayerMoved */
+                int position;
+                /** previous position for LayerMoved */
+                int oldPosition;
+                bool visible;
+            };
+
+            /**
+             * Records camera and layer state changes on an `AtakMapView`
+             * with timestamps, for deterministic playback via
+             * `GLGlobeReplay`.
+             *
+             * <P>On `start`, the current camera and the visibility of every
+             * layer are recorded at time zero so that playback begins from
+             * the same state. Layers are identified by name.
+             *
+             * <P>This class is thread-safe.
+             */
+            class ENGINE_API MapViewRecorder : public atakmap::core::AtakMapView::MapMovedListener,
+                                               public atakmap::core::AtakMapView::MapLayersChangedListener,
+                                               public atakmap::core::AtakMapView::MapResizedListener,
+                                               public atakmap::core::Layer::VisibilityListener
+            {
+            public :
+                MapViewRecorder(atakmap::core::AtakMapView &view) NOTHROWS;
+                ~MapViewRecorder() NOTHROWS;
+            public :
+                /**
+                 * Discards any previously recorded events and begins
+                 * recording.
+                 */
+                Util::TAKErr start() NOTHROWS;
+                Util::TAKErr stop() NOTHROWS;
+                bool isRecording() const NOTHROWS;
+                Util::TAKErr getEvents(std::vector<MapViewEvent> &value) const NOTHROWS;
+            public : // MapMovedListener
+                void mapMoved(atakmap::core::AtakMapView *view, const bool animate) override;
+            public : // MapLayersChangedListener
+                void mapLayerAdded(atakmap::core::AtakMapView *view, atakmap::core::Layer *layer) override;
+                void mapLayerRemoved(atakmap::core::AtakMapView *view, atakmap::core::Layer *layer) override;
+                void mapLayerPositionChanged(atakmap::core::AtakMapView *view, atakmap::core::Layer *layer, const int oldPos, const int newPos) override;
+            public : // MapResizedListener
+                void mapResized(atakmap::core::AtakMapView *view) override;
+            public : // VisibilityListener
+                void visibilityChanged(atakmap::core::Layer &layer) override;
+            private :
+                int64_t elapsed() const NOTHROWS;
+                void recordCamera(const bool animate) NOTHROWS;
+                void recordLayer(const MapViewEvent::Type type, atakmap::core::Layer &layer, const int oldPosition, const int position) NOTHROWS;
+            private :
+                atakmap::core::AtakMapView &view;
+                mutable Thread::Mutex mutex;
+                bool recording;
+                int64_t startTime;
+                std::vector<MapViewEvent> events;
+                std::set<atakmap::core::Layer *> observed;
+            };
+
+            /**
+             * Writes the events as text, one event per line:
+             *
+             * <pre>
+             *   time camera latitude longitude altitude resolution rotation tilt animate
+             *   time resized width height
+             *   time layer_added position name
+             *   time layer_removed name
+             *   time layer_moved oldPosition newPosition name
+             *   time layer_visible visible name
+             * </pre>
+             */
+            ENGINE_API Util::TAKErr MapViewRecording_write(Util::DataOutput2 &sink, const std::vector<MapViewEvent> &events) NOTHROWS;
+            /**
+             * Reads events previously written with `MapViewRecording_write`.
+             * Blank lines and lines starting with '#' are ignored.
+             */
+            ENGINE_API Util::TAKErr MapViewRecording_read(std::vector<MapViewEvent> &events, Util::DataInput2 &src) NOTHROWS;
+        }
+    }
+}
+
+#endif
@@ -64,6 +64,8 @@ TAKErr MultiLayer2::addLayerNoSync(const std::size_t position, const std::shared
         this->layers_.push_back(layer);
     else
         this->layers_.insert(this->layers_.begin() + position, layer);
+    const TAKErr code = this->publishLayersNoSync();
+    TE_CHECKRETURN_CODE(code);
 
     this->dispatchOnLayerAddedNoSync(layer);
         
@@ -89,6 +91,8 @@ TAKErr MultiLayer2::removeLayer(const Layer2 &layer) NOTHROWS
         std::shared_ptr<Layer2> layerPtr = this->layers_[i];
         if (layerPtr.get() == &layer) {
             this->layers_.erase(this->layers_.begin()+i);
+            code = this->publishLayersNoSync();
+            TE_CHECKRETURN_CODE(code);
             STLVectorAdapter<std::shared_ptr<Layer2>> singleton;
             singleton.add(layerPtr);
             this->dispatchOnLayerRemovedNoSync(singleton);
@@ -110,6 +114,8 @@ TAKErr MultiLayer2::removeAllLayers() NOTHROWS
     for (std::size_t i = 0u; i < this->layers_.size(); i++)
         this->layers_[i]->removeVisibilityListener(this->visibility_updater_.get());
     this->layers_.clear();
+    code = this->publishLayersNoSync();
+    TE_CHECKRETURN_CODE(code);
 
     STLVectorAdapter<std::shared_ptr<Layer2>> scratchC(scratch);
     this->dispatchOnLayerRemovedNoSync(scratchC);
@@ -154,47 +160,52 @@ TAKErr MultiLayer2::setLayerPosition(const Layer2 &layer, const std::size_t posi
     } else {
         return TE_IllegalState;
     }
+    code = this->publishLayersNoSync();
+    TE_CHECKRETURN_CODE(code);
         
     this->dispatchOnLayerPositionChanged(layerPtr, oldPos, position);
     return code;
 }
 std::size_t MultiLayer2::getNumLayers() const NOTHROWS
 {
-    TAKErr code(TE_Ok);
-    Lock lock(mutex_);
-    code = lock.status;
-    // XXX - no failover
-
-    return this->layers_.size();
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    return layers->size();
 }
 TAKErr MultiLayer2::getLayer(std::shared_ptr<Layer2> &value, const std::size_t i) const NOTHROWS
 {
-    TAKErr code(TE_Ok);
-    Lock lock(mutex_);
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
-    if (i >= this->layers_.size())
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    if (i >= layers->size())
         return TE_BadIndex;
 
-    value = this->layers_[i];
-    return code;
+    value = (*layers)[i];
+    return TE_Ok;
 }
 TAKErr MultiLayer2::getLayers(Collection<std::shared_ptr<Layer2>> &value) const NOTHROWS
 {
     TAKErr code(TE_Ok);
-    Lock lock(mutex_);
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
-    for (std::size_t i = 0u; i < this->layers_.size(); i++) {
-        code = value.add(this->layers_[i]);
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    for (auto it = layers->begin(); it != layers->end(); it++) {
+        code = value.add(*it);
         TE_CHECKBREAK_CODE(code);
     }
     TE_CHECKRETURN_CODE(code);
 
     return code;
 }
+TAKErr MultiLayer2::visitLayers(TAKErr(*visitor)(void *opaque, Layer2 &layer) NOTHROWS, void *opaque) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!visitor)
+        return TE_InvalidArg;
+    // the snapshot retains references to the layers for the duration of the
+    // visit
+    ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>>::ReadGuard layers(layers_snapshot_);
+    for (auto it = layers->begin(); it != layers->end(); it++) {
+        code = visitor(opaque, **it);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
 TAKErr MultiLayer2::addLayersChangedListener(LayersChangedListener *l) NOTHROWS
 {
     TAKErr code(TE_Ok);
@@ -260,6 +271,15 @@ TAKErr MultiLayer2::dispatchOnLayerPositionChanged(const std::shared_ptr<Layer2>
     return code;
 }
     
+TAKErr MultiLayer2::publishLayersNoSync() NOTHROWS
+{
+    const std::vector<std::shared_ptr<Layer2>> &layers = this->layers_;
+    return this->layers_snapshot_.update([&layers](std::vector<std::shared_ptr<Layer2>> &value) -> TAKErr
+    {
+        value = layers;
+        return TE_Ok;
+    });
+}
 void MultiLayer2::updateVisibility() NOTHROWS
 {
     TAKErr code(TE_Ok);
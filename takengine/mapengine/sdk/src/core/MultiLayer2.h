@@ -7,6 +7,7 @@
 #include "core/Layer2.h"
 #include "port/Collection.h"
 #include "port/Platform.h"
+#include "thread/ReadCopyUpdate.h"
 
 namespace TAK {
     namespace Engine {
@@ -111,6 +112,14 @@ namespace TAK {
                  * @return  The current layer stack.
                  */
                 Util::TAKErr getLayers(Port::Collection<std::shared_ptr<Layer2>> &value) const NOTHROWS;
+                /**
+                 * Visits a snapshot of the current layer stack, bottom to
+                 * top. The snapshot is not affected by concurrent
+                 * modification and no lock is held during the visit.
+                 * Visitation stops if the visitor returns a code other than
+                 * `TE_Ok`.
+                 */
+                Util::TAKErr visitLayers(Util::TAKErr(*visitor)(void *opaque, Layer2 &layer) NOTHROWS, void *opaque) const NOTHROWS;
 
                 /**
                  * Adds the specified {@link OnLayersChangedListener}.
@@ -134,9 +143,14 @@ namespace TAK {
                 Util::TAKErr dispatchOnLayerPositionChanged(const std::shared_ptr<Layer2> &l, const std::size_t oldPos, const std::size_t newPos) NOTHROWS;
 
                 void updateVisibility() NOTHROWS;
+            private :
+                /** publishes `layers_` to readers; must hold `mutex_` */
+                Util::TAKErr publishLayersNoSync() NOTHROWS;
             private :
                 std::set<LayersChangedListener *> layers_changed_listeners_;
                 std::vector<std::shared_ptr<Layer2>> layers_;
+                /** read-side copy of `layers_`; queried without `mutex_` */
+                Thread::ReadCopyUpdate<std::vector<std::shared_ptr<Layer2>>> layers_snapshot_;
 
                 std::unique_ptr<VisibilityUpdater> visibility_updater_;
             };
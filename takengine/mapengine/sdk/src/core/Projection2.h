@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_CORE_PROJECTION2_H_INCLUDED
 #define TAK_ENGINE_CORE_PROJECTION2_H_INCLUDED
 
+#include <cstddef>
 #include <memory>
 
 #include "core/GeoPoint2.h"
@@ -20,6 +21,21 @@ namespace TAK {
 
                 virtual Util::TAKErr forward(TAK::Engine::Math::Point2<double> *proj, const GeoPoint2 &geo) const NOTHROWS = 0;
                 virtual Util::TAKErr inverse(GeoPoint2 *geo, const TAK::Engine::Math::Point2<double> &proj) const NOTHROWS = 0;
+                /**
+                 * Projects `count` tightly packed points. The default
+                 * implementation invokes the single point `forward` for
+                 * each; implementations should override where the
+                 * underlying projection can transform in bulk.
+                 *
+                 * @return  TE_Ok on success; otherwise the first error
+                 *          encountered
+                 */
+                virtual Util::TAKErr forward(TAK::Engine::Math::Point2<double> *proj, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS;
+                /**
+                 * Unprojects `count` tightly packed points. See the batch
+                 * `forward`.
+                 */
+                virtual Util::TAKErr inverse(GeoPoint2 *geo, const TAK::Engine::Math::Point2<double> *proj, const std::size_t count) const NOTHROWS;
                 virtual double getMinLatitude() const NOTHROWS = 0;
                 virtual double getMaxLatitude() const NOTHROWS = 0;
                 virtual double getMinLongitude() const NOTHROWS = 0;
@@ -29,6 +45,28 @@ namespace TAK {
             }; // end class Projection
 
             typedef std::unique_ptr<Projection2, void(*)(const Projection2 *)> Projection2Ptr;
+
+            /**
+             * Projects `count` points, as though by invoking
+             * `Projection2::forward` for each. Tightly packed points are
+             * passed to the projection's batch `forward`; for strided
+             * points, the SDK's built-in 4326, 3857 and 4978 projections
+             * are evaluated with non-virtual batch kernels.
+             *
+             * @param projStride    The number of bytes between consecutive
+             *                      projected points; `0` if tightly packed
+             * @param geoStride     The number of bytes between consecutive
+             *                      geodetic points; `0` if tightly packed
+             *
+             * @return  TE_Ok on success; otherwise the first error returned
+             *          by the projection
+             */
+            ENGINE_API Util::TAKErr Projection2_forward(TAK::Engine::Math::Point2<double> *proj, const Projection2 &projection, const GeoPoint2 *geo, const std::size_t count, const std::size_t projStride = 0u, const std::size_t geoStride = 0u) NOTHROWS;
+            /**
+             * Unprojects `count` points, as though by invoking
+             * `Projection2::inverse` for each. See Projection2_forward.
+             */
+            ENGINE_API Util::TAKErr Projection2_inverse(GeoPoint2 *geo, const Projection2 &projection, const TAK::Engine::Math::Point2<double> *proj, const std::size_t count, const std::size_t geoStride = 0u, const std::size_t projStride = 0u) NOTHROWS;
         }
     }
 }
@@ -1,14 +1,17 @@
 
 #include "core/ProjectionFactory3.h"
 
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <set>
+#include <type_traits>
 
 #include "core/Datum2.h"
 #include "core/GeoPoint2.h"
 #include "elevation/ElevationManager.h"
 #include "math/Point2.h"
-#include "thread/Lock.h"
+#include "thread/ReadCopyUpdate.h"
 #include "util/Error.h"
 #include "util/Memory.h"
 
@@ -29,6 +32,8 @@ namespace // unnamed namespace
         virtual int getSpatialReferenceID() const NOTHROWS; \
         virtual TAKErr forward(Point2<double> *value, const GeoPoint2 &geo) const NOTHROWS; \
         virtual TAKErr inverse(GeoPoint2 *value, const Point2<double> &proj) const NOTHROWS; \
+        virtual TAKErr forward(Point2<double> *value, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS; \
+        virtual TAKErr inverse(GeoPoint2 *value, const Point2<double> *proj, const std::size_t count) const NOTHROWS; \
         virtual double getMinLatitude() const NOTHROWS; \
         virtual double getMaxLatitude() const NOTHROWS; \
         virtual double getMinLongitude() const NOTHROWS; \
@@ -52,6 +57,21 @@ namespace // unnamed namespace
 
     InternalProjectionSpi sdkSpi;
 
+    // batch kernels for the SDK projections; strides are in bytes
+    void forward4326(Point2<double> *proj, const std::size_t projStride, const GeoPoint2 *geo, const std::size_t geoStride, const std::size_t count) NOTHROWS;
+    void forward3857(Point2<double> *proj, const std::size_t projStride, const GeoPoint2 *geo, const std::size_t geoStride, const std::size_t count) NOTHROWS;
+    void forward4978(Point2<double> *proj, const std::size_t projStride, const GeoPoint2 *geo, const std::size_t geoStride, const std::size_t count) NOTHROWS;
+    void inverse4326(GeoPoint2 *geo, const std::size_t geoStride, const Point2<double> *proj, const std::size_t projStride, const std::size_t count) NOTHROWS;
+    void inverse3857(GeoPoint2 *geo, const std::size_t geoStride, const Point2<double> *proj, const std::size_t projStride, const std::size_t count) NOTHROWS;
+    void inverse4978(GeoPoint2 *geo, const std::size_t geoStride, const Point2<double> *proj, const std::size_t projStride, const std::size_t count) NOTHROWS;
+
+    template<class T>
+    inline T &strided(T *base, const std::size_t stride, const std::size_t i) NOTHROWS
+    {
+        typedef typename std::conditional<std::is_const<T>::value, const uint8_t, uint8_t>::type Byte;
+        return *reinterpret_cast<T *>(reinterpret_cast<Byte *>(base) + (i * stride));
+    }
+
 }; // end unnamed namespace
 
 
@@ -76,42 +96,37 @@ namespace
         }
     };
 
-    std::set<SpiRegistryEntry, SpiRegistryComparator> &spis() NOTHROWS
+    typedef std::set<SpiRegistryEntry, SpiRegistryComparator> SpiRegistry;
+
+    ReadCopyUpdate<SpiRegistry> &spis() NOTHROWS
     {
-        static std::set<SpiRegistryEntry, SpiRegistryComparator> s;
+        static ReadCopyUpdate<SpiRegistry> s;
         return s;
     }
-    Mutex &factoryMutex() NOTHROWS
-    {
-        static Mutex m;
-        return m;
-    }
 
-    bool sdkPreferred = true;
+    std::atomic<bool> sdkPreferred(true);
 }
 
 TAKErr TAK::Engine::Core::ProjectionFactory3_create(Projection2Ptr &value, const int srid) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-
-    Lock lock(factoryMutex());
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
+    const bool preferSdk = sdkPreferred;
 
     // if the SDK implementations are preferred, see if the projection can be
     // created before deferring to the client-registered SPIs
-    if (sdkPreferred && (sdkSpi.create(value, srid) == TE_Ok))
+    if (preferSdk && (sdkSpi.create(value, srid) == TE_Ok))
         return TE_Ok;
 
-    std::set<SpiRegistryEntry, SpiRegistryComparator> &registry = spis();
-    std::set<SpiRegistryEntry, SpiRegistryComparator>::iterator it;
-    for (it = registry.begin(); it != registry.end(); it++) {
-        if ((*it).spi->create(value, srid) == TE_Ok)
-            return TE_Ok;
+    {
+        ReadCopyUpdate<SpiRegistry>::ReadGuard registry(spis());
+        SpiRegistry::const_iterator it;
+        for (it = registry->begin(); it != registry->end(); it++) {
+            if ((*it).spi->create(value, srid) == TE_Ok)
+                return TE_Ok;
+        }
     }
     // if the SDK implementations are not preferred, try to obtain the
     // projection if none of the other SPIs could provide
-    if (!sdkPreferred && (sdkSpi.create(value, srid) == TE_Ok))
+    if (!preferSdk && (sdkSpi.create(value, srid) == TE_Ok))
         return TE_Ok;
 
     return TE_InvalidArg;
@@ -123,54 +138,118 @@ TAKErr TAK::Engine::Core::ProjectionFactory3_registerSpi(ProjectionSpi3Ptr &&spi
 }
 TAKErr TAK::Engine::Core::ProjectionFactory3_registerSpi(const std::shared_ptr<ProjectionSpi3> &spi, const int priority) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-
-    Lock lock(factoryMutex());
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
     SpiRegistryEntry entry;
     entry.spi = spi;
     entry.priority = priority;
 
     // XXX - need to check for pointer collision on different priority???
-    spis().insert(entry);
-
-    return TE_Ok;
+    return spis().update([&entry](SpiRegistry &registry) -> TAKErr
+    {
+        registry.insert(entry);
+        return TE_Ok;
+    });
 }
 
 TAKErr TAK::Engine::Core::ProjectionFactory3_unregisterSpi(const ProjectionSpi3 &spi) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-
-    Lock lock(factoryMutex());
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
-    std::set<SpiRegistryEntry, SpiRegistryComparator> &registry = spis();
-    std::set<SpiRegistryEntry, SpiRegistryComparator>::iterator it;
-    for (it = registry.begin(); it != registry.end(); it++) {
-        if ((*it).spi.get() == &spi) {
-            registry.erase(it);
-            return TE_Ok;
+    return spis().update([&spi](SpiRegistry &registry) -> TAKErr
+    {
+        SpiRegistry::iterator it;
+        for (it = registry.begin(); it != registry.end(); it++) {
+            if ((*it).spi.get() == &spi) {
+                registry.erase(it);
+                return TE_Ok;
+            }
         }
-    }
-
-    return TE_InvalidArg;
+        return TE_InvalidArg;
+    });
 }
 
 TAKErr TAK::Engine::Core::ProjectionFactory3_setPreferSdkProjections(const bool sdk) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-    Lock lock(factoryMutex());
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
     sdkPreferred = sdk;
 
     return TE_Ok;
 }
 
+TAKErr TAK::Engine::Core::Projection2_forward(Point2<double> *proj, const Projection2 &projection, const GeoPoint2 *geo, const std::size_t count, const std::size_t projStride_, const std::size_t geoStride_) NOTHROWS
+{
+    if (!count)
+        return TE_Ok;
+    if (!proj || !geo)
+        return TE_InvalidArg;
+    const std::size_t projStride = projStride_ ? projStride_ : sizeof(Point2<double>);
+    const std::size_t geoStride = geoStride_ ? geoStride_ : sizeof(GeoPoint2);
+    if (projStride == sizeof(Point2<double>) && geoStride == sizeof(GeoPoint2))
+        return projection.forward(proj, geo, count);
+
+    if (dynamic_cast<const EquirectangularProjection *>(&projection)) {
+        forward4326(proj, projStride, geo, geoStride, count);
+        return TE_Ok;
+    } else if (dynamic_cast<const WebMercatorProjection *>(&projection)) {
+        forward3857(proj, projStride, geo, geoStride, count);
+        return TE_Ok;
+    } else if (dynamic_cast<const EcefWGS84 *>(&projection)) {
+        forward4978(proj, projStride, geo, geoStride, count);
+        return TE_Ok;
+    }
+
+    TAKErr code(TE_Ok);
+    for (std::size_t i = 0u; i < count; i++) {
+        code = projection.forward(&strided(proj, projStride, i), strided(geo, geoStride, i));
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+TAKErr TAK::Engine::Core::Projection2_inverse(GeoPoint2 *geo, const Projection2 &projection, const Point2<double> *proj, const std::size_t count, const std::size_t geoStride_, const std::size_t projStride_) NOTHROWS
+{
+    if (!count)
+        return TE_Ok;
+    if (!proj || !geo)
+        return TE_InvalidArg;
+    const std::size_t projStride = projStride_ ? projStride_ : sizeof(Point2<double>);
+    const std::size_t geoStride = geoStride_ ? geoStride_ : sizeof(GeoPoint2);
+    if (projStride == sizeof(Point2<double>) && geoStride == sizeof(GeoPoint2))
+        return projection.inverse(geo, proj, count);
+
+    if (dynamic_cast<const EquirectangularProjection *>(&projection)) {
+        inverse4326(geo, geoStride, proj, projStride, count);
+        return TE_Ok;
+    } else if (dynamic_cast<const WebMercatorProjection *>(&projection)) {
+        inverse3857(geo, geoStride, proj, projStride, count);
+        return TE_Ok;
+    } else if (dynamic_cast<const EcefWGS84 *>(&projection)) {
+        inverse4978(geo, geoStride, proj, projStride, count);
+        return TE_Ok;
+    }
+
+    TAKErr code(TE_Ok);
+    for (std::size_t i = 0u; i < count; i++) {
+        code = projection.inverse(&strided(geo, geoStride, i), strided(proj, projStride, i));
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
+TAKErr Projection2::forward(Point2<double> *proj, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    for (std::size_t i = 0u; i < count; i++) {
+        code = forward(proj + i, geo[i]);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+TAKErr Projection2::inverse(GeoPoint2 *geo, const Point2<double> *proj, const std::size_t count) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    for (std::size_t i = 0u; i < count; i++) {
+        code = inverse(geo + i, proj[i]);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
 /*****************************************************************************/
 
 namespace
@@ -182,33 +261,26 @@ namespace
     }
     TAKErr EquirectangularProjection::forward(Point2<double> *value, const GeoPoint2 &geo) const NOTHROWS
     {
-        value->x = geo.longitude;
-        value->y = geo.latitude;
-        if (isnan(geo.altitude)) {
-            value->z = 0;
-        } else if(geo.altitudeRef == AltitudeReference::HAE) {
-            value->z = geo.altitude;
-        } /*else if(geo.altitudeRef == AltitudeReference::MSL) {
-            double offset;
-            if(ElevationManager_getGeoidHeight(&offset, geo.latitude, geo.longitude) == TE_Ok) {
-                value->z = geo.altitude + offset;
-            } else {
-                value->z = 0.0;
-            }
-        }*/ else {
-            // XXX - AGL
-            value->z = 0;
-        }
+        forward4326(value, sizeof(Point2<double>), &geo, sizeof(GeoPoint2), 1u);
         return TE_Ok;
     }
     TAKErr EquirectangularProjection::inverse(GeoPoint2 *value, const Point2<double> &proj) const NOTHROWS
     {
-        value->latitude = proj.y;
-        value->longitude = proj.x;
-        value->altitude = proj.z;
-        value->altitudeRef = AltitudeReference::HAE;
-        value->ce90 = NAN;
-        value->le90 = NAN;
+        inverse4326(value, sizeof(GeoPoint2), &proj, sizeof(Point2<double>), 1u);
+        return TE_Ok;
+    }
+    TAKErr EquirectangularProjection::forward(Point2<double> *value, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS
+    {
+        if (count && (!value || !geo))
+            return TE_InvalidArg;
+        forward4326(value, sizeof(Point2<double>), geo, sizeof(GeoPoint2), count);
+        return TE_Ok;
+    }
+    TAKErr EquirectangularProjection::inverse(GeoPoint2 *value, const Point2<double> *proj, const std::size_t count) const NOTHROWS
+    {
+        if (count && (!value || !proj))
+            return TE_InvalidArg;
+        inverse4326(value, sizeof(GeoPoint2), proj, sizeof(Point2<double>), count);
         return TE_Ok;
     }
     double EquirectangularProjection::getMinLatitude() const NOTHROWS
@@ -238,38 +310,26 @@ namespace
     }
     TAKErr WebMercatorProjection::forward(Point2<double> *value, const GeoPoint2 &geo) const NOTHROWS
     {
-#define TO_RADIANS(x) ((x)*(M_PI/180.0))
-        value->x = Datum2::WGS84.reference.semiMajorAxis * TO_RADIANS(geo.longitude);
-        value->y = Datum2::WGS84.reference.semiMajorAxis * log(tan(M_PI / 4.0 + TO_RADIANS(geo.latitude) / 2.0));
-#undef TO_RADIANS
-        if (isnan(geo.altitude)) {
-            value->z = 0;
-        } else if(geo.altitudeRef == AltitudeReference::HAE) {
-            value->z = geo.altitude;
-        } /*else if(geo.altitudeRef == AltitudeReference::MSL) {
-            double offset;
-            if(ElevationManager_getGeoidHeight(&offset, geo.latitude, geo.longitude) == TE_Ok) {
-                value->z = geo.altitude + offset;
-            } else {
-                value->z = 0.0;
-            }
-        }*/ else {
-            // XXX - AGL
-            value->z = 0;
-        }
-
+        forward3857(value, sizeof(Point2<double>), &geo, sizeof(GeoPoint2), 1u);
         return TE_Ok;
     }
     TAKErr WebMercatorProjection::inverse(GeoPoint2 *value, const Point2<double> &proj) const NOTHROWS
     {
-#define TO_DEGREES(x) ((x)*(180.0/M_PI))
-        value->latitude = TO_DEGREES((M_PI / 2.0) - (2.0*atan(exp(-proj.y / Datum2::WGS84.reference.semiMajorAxis))));
-        value->longitude = TO_DEGREES(proj.x / Datum2::WGS84.reference.semiMajorAxis);
-#undef TO_DEGREES
-        value->altitude = proj.z;
-        value->altitudeRef = AltitudeReference::HAE;
-        value->ce90 = NAN;
-        value->le90 = NAN;
+        inverse3857(value, sizeof(GeoPoint2), &proj, sizeof(Point2<double>), 1u);
+        return TE_Ok;
+    }
+    TAKErr WebMercatorProjection::forward(Point2<double> *value, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS
+    {
+        if (count && (!value || !geo))
+            return TE_InvalidArg;
+        forward3857(value, sizeof(Point2<double>), geo, sizeof(GeoPoint2), count);
+        return TE_Ok;
+    }
+    TAKErr WebMercatorProjection::inverse(GeoPoint2 *value, const Point2<double> *proj, const std::size_t count) const NOTHROWS
+    {
+        if (count && (!value || !proj))
+            return TE_InvalidArg;
+        inverse3857(value, sizeof(GeoPoint2), proj, sizeof(Point2<double>), count);
         return TE_Ok;
     }
     double WebMercatorProjection::getMinLatitude() const NOTHROWS
@@ -300,88 +360,26 @@ namespace
     }
     TAKErr EcefWGS84::forward(Point2<double> *value, const GeoPoint2 &geo) const NOTHROWS
     {
-        const double a = Datum2::WGS84.reference.semiMajorAxis;
-        const double b = Datum2::WGS84.reference.semiMinorAxis;
-#define TO_RADIANS(x) ((x)*(M_PI / 180.0))
-        const double latRad = TO_RADIANS(geo.latitude);
-        const double cosLat = cos(latRad);
-        const double sinLat = sin(latRad);
-        const double lonRad = TO_RADIANS(geo.longitude);
-#undef TO_RADIANS
-        const double cosLon = cos(lonRad);
-        const double sinLon = sin(lonRad);
-
-        const double a2_b2 = (a*a) / (b*b);
-        const double b2_a2 = (b*b) / (a*a);
-
-        const double cden = sqrt((cosLat*cosLat) + (b2_a2 * (sinLat*sinLat)));
-        const double lden = sqrt((a2_b2 * (cosLat*cosLat)) + (sinLat*sinLat));
-
-        double altitude;
-        if (isnan(geo.altitude)) {
-            altitude = 0.0;
-        } else if(geo.altitudeRef == AltitudeReference::HAE) {
-            altitude = geo.altitude;
-        //} else if(geo.altitudeRef == AltitudeReference::MSL) {
-        //    double offset;
-        //    if(ElevationManager_getGeoidHeight(&offset, geo.latitude, geo.longitude) == TE_Ok) {
-        //        altitude = geo.altitude + offset;
-        //    } else {
-        //        // XXX - ? what's the failover here???
-        //        altitude = 0.0;
-        //    }
-        //} else {
-            // XXX - AGL, do we bother handling
-        } else
-            altitude = 0.0;
-
-        const double X = ((a / cden) + altitude) * (cosLat*cosLon);
-        const double Y = ((a / cden) + altitude) * (cosLat*sinLon);
-        const double Z = ((b / lden) + altitude) * sinLat;
-
-        value->x = X;
-        value->y = Y;
-        value->z = Z;
-
+        forward4978(value, sizeof(Point2<double>), &geo, sizeof(GeoPoint2), 1u);
         return TE_Ok;
     }
     TAKErr EcefWGS84::inverse(GeoPoint2 *value, const Point2<double> &proj) const NOTHROWS
     {
-        const double a = Datum2::WGS84.reference.semiMajorAxis;
-        const double b = Datum2::WGS84.reference.semiMinorAxis;
-
-#define TO_DEGREES(x) (((x)*180.0)/M_PI)
-        const double e = sqrt(1 - ((b*b) / (a*a)));
-        const double ep = sqrt((a*a - b*b) / (b*b));
-
-        const double e_sq = e*e;
-        const double ep_sq = ep*ep;
-        const double p = sqrt(proj.x*proj.x + proj.y*proj.y);
-        const double th = atan2(a*proj.z, b*p);
-        const double th_sin = sin(th);
-        const double th_cos = cos(th);
-        const double rlon = atan2(proj.y, proj.x);
-        const double rlat = atan2(
-            (proj.z + ep_sq*b*th_sin*th_sin*th_sin),
-            (p - e_sq*a*th_cos*th_cos*th_cos));
-        const double N = a / sqrt(1 - e_sq*sin(rlat)*sin(rlat));
-        const double h = p / cos(rlat) - N;
-
-        double lat = TO_DEGREES(rlat);
-        double lon = TO_DEGREES(rlon);
-
-        if (lat < -90) lat = -180 - lat;
-        if (lat > 90) lat = 180 - lat;
-
-        // XXX - why are we getting NaN for 'h' on startup???
-
-        value->latitude = lat;
-        value->longitude = lon;
-        value->altitude = h;
-        value->altitudeRef = AltitudeReference::HAE;
-        value->ce90 = NAN;
-        value->le90 = NAN;
-
+        inverse4978(value, sizeof(GeoPoint2), &proj, sizeof(Point2<double>), 1u);
+        return TE_Ok;
+    }
+    TAKErr EcefWGS84::forward(Point2<double> *value, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS
+    {
+        if (count && (!value || !geo))
+            return TE_InvalidArg;
+        forward4978(value, sizeof(Point2<double>), geo, sizeof(GeoPoint2), count);
+        return TE_Ok;
+    }
+    TAKErr EcefWGS84::inverse(GeoPoint2 *value, const Point2<double> *proj, const std::size_t count) const NOTHROWS
+    {
+        if (count && (!value || !proj))
+            return TE_InvalidArg;
+        inverse4978(value, sizeof(GeoPoint2), proj, sizeof(Point2<double>), count);
         return TE_Ok;
     }
     double EcefWGS84::getMinLatitude() const NOTHROWS
@@ -426,4 +424,131 @@ namespace
         return TE_Ok;
     }
 
+    /**
+     * The z value for the point. Only HAE altitudes are honored; MSL would
+     * require a geoid lookup per point and AGL the terrain.
+     */
+    inline double projectedAltitude(const GeoPoint2 &geo) NOTHROWS
+    {
+        if (isnan(geo.altitude))
+            return 0.0;
+        else if (geo.altitudeRef == AltitudeReference::HAE)
+            return geo.altitude;
+        else
+            return 0.0;
+    }
+    inline void setInverse(GeoPoint2 &value, const double latitude, const double longitude, const double altitude) NOTHROWS
+    {
+        value.latitude = latitude;
+        value.longitude = longitude;
+        value.altitude = altitude;
+        value.altitudeRef = AltitudeReference::HAE;
+        value.ce90 = NAN;
+        value.le90 = NAN;
+    }
+
+#define TO_RADIANS(x) ((x)*(M_PI/180.0))
+#define TO_DEGREES(x) ((x)*(180.0/M_PI))
+    void forward4326(Point2<double> *proj, const std::size_t projStride, const GeoPoint2 *geo, const std::size_t geoStride, const std::size_t count) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < count; i++) {
+            const GeoPoint2 &g = strided(geo, geoStride, i);
+            Point2<double> &p = strided(proj, projStride, i);
+            p.x = g.longitude;
+            p.y = g.latitude;
+            p.z = projectedAltitude(g);
+        }
+    }
+    void forward3857(Point2<double> *proj, const std::size_t projStride, const GeoPoint2 *geo, const std::size_t geoStride, const std::size_t count) NOTHROWS
+    {
+        const double a = Datum2::WGS84.reference.semiMajorAxis;
+        for (std::size_t i = 0u; i < count; i++) {
+            const GeoPoint2 &g = strided(geo, geoStride, i);
+            Point2<double> &p = strided(proj, projStride, i);
+            p.x = a * TO_RADIANS(g.longitude);
+            p.y = a * log(tan(M_PI / 4.0 + TO_RADIANS(g.latitude) / 2.0));
+            p.z = projectedAltitude(g);
+        }
+    }
+    void forward4978(Point2<double> *proj, const std::size_t projStride, const GeoPoint2 *geo, const std::size_t geoStride, const std::size_t count) NOTHROWS
+    {
+        const double a = Datum2::WGS84.reference.semiMajorAxis;
+        const double b = Datum2::WGS84.reference.semiMinorAxis;
+        const double a2_b2 = (a*a) / (b*b);
+        const double b2_a2 = (b*b) / (a*a);
+        for (std::size_t i = 0u; i < count; i++) {
+            const GeoPoint2 &g = strided(geo, geoStride, i);
+            const double latRad = TO_RADIANS(g.latitude);
+            const double cosLat = cos(latRad);
+            const double sinLat = sin(latRad);
+            const double lonRad = TO_RADIANS(g.longitude);
+            const double cosLon = cos(lonRad);
+            const double sinLon = sin(lonRad);
+
+            const double cden = sqrt((cosLat*cosLat) + (b2_a2 * (sinLat*sinLat)));
+            const double lden = sqrt((a2_b2 * (cosLat*cosLat)) + (sinLat*sinLat));
+
+            const double altitude = projectedAltitude(g);
+
+            Point2<double> &p = strided(proj, projStride, i);
+            p.x = ((a / cden) + altitude) * (cosLat*cosLon);
+            p.y = ((a / cden) + altitude) * (cosLat*sinLon);
+            p.z = ((b / lden) + altitude) * sinLat;
+        }
+    }
+    void inverse4326(GeoPoint2 *geo, const std::size_t geoStride, const Point2<double> *proj, const std::size_t projStride, const std::size_t count) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < count; i++) {
+            const Point2<double> &p = strided(proj, projStride, i);
+            setInverse(strided(geo, geoStride, i), p.y, p.x, p.z);
+        }
+    }
+    void inverse3857(GeoPoint2 *geo, const std::size_t geoStride, const Point2<double> *proj, const std::size_t projStride, const std::size_t count) NOTHROWS
+    {
+        const double a = Datum2::WGS84.reference.semiMajorAxis;
+        for (std::size_t i = 0u; i < count; i++) {
+            const Point2<double> &p = strided(proj, projStride, i);
+            setInverse(strided(geo, geoStride, i),
+                TO_DEGREES((M_PI / 2.0) - (2.0*atan(exp(-p.y / a)))),
+                TO_DEGREES(p.x / a),
+                p.z);
+        }
+    }
+    void inverse4978(GeoPoint2 *geo, const std::size_t geoStride, const Point2<double> *proj, const std::size_t projStride, const std::size_t count) NOTHROWS
+    {
+        const double a = Datum2::WGS84.reference.semiMajorAxis;
+        const double b = Datum2::WGS84.reference.semiMinorAxis;
+
+        const double e = sqrt(1 - ((b*b) / (a*a)));
+        const double ep = sqrt((a*a - b*b) / (b*b));
+
+        const double e_sq = e*e;
+        const double ep_sq = ep*ep;
+        for (std::size_t i = 0u; i < count; i++) {
+            const Point2<double> &p = strided(proj, projStride, i);
+            const double r = sqrt(p.x*p.x + p.y*p.y);
+            const double th = atan2(a*p.z, b*r);
+            const double th_sin = sin(th);
+            const double th_cos = cos(th);
+            const double rlon = atan2(p.y, p.x);
+            const double rlat = atan2(
+                (p.z + ep_sq*b*th_sin*th_sin*th_sin),
+                (r - e_sq*a*th_cos*th_cos*th_cos));
+            const double N = a / sqrt(1 - e_sq*sin(rlat)*sin(rlat));
+            const double h = r / cos(rlat) - N;
+
+            double lat = (rlat*180.0) / M_PI;
+            const double lon = (rlon*180.0) / M_PI;
+
+            if (lat < -90) lat = -180 - lat;
+            if (lat > 90) lat = 180 - lat;
+
+            // XXX - why are we getting NaN for 'h' on startup???
+
+            setInverse(strided(geo, geoStride, i), lat, lon, h);
+        }
+    }
+#undef TO_DEGREES
+#undef TO_RADIANS
+
 } // end unnamed namespace
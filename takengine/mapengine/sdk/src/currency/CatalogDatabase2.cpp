@@ -119,7 +119,7 @@ TAKErr CatalogDatabase2::open(const char *databasePath) NOTHROWS
     TE_CHECKRETURN_CODE(code);
 
     DatabasePtr db(nullptr, nullptr);
-    DatabaseInformation info(databasePath, nullptr, DATABASE_OPTIONS_READONLY);
+    DatabaseInformation info(databasePath, nullptr, DATABASE_OPTIONS_READONLY, TEDP_ReadMostly);
     code = DatabaseFactory_create(db, info);
     TE_CHECKRETURN_CODE(code);
 
@@ -2,11 +2,15 @@
 
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <list>
+#include <memory>
 #include <sstream>
 #include <string>
 #ifndef MSVC
 #include <strings.h>
 #endif
+#include <unordered_map>
 #include <vector>
 
 
@@ -19,6 +23,7 @@
 #include "db/Statement2.h"
 #include "thread/Lock.h"
 #include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
 #include "util/Logging.h"
 #include "util/NonCopyable.h"
 
@@ -43,12 +48,43 @@ using namespace atakmap::util;
 
 #define MEM_FN( fn )    "TAK::Engine::DB::SpatiaLiteDB::" fn ": "
 
+// maximum number of idle prepared statements retained per connection
+#define STATEMENT_CACHE_LIMIT 32u
+
 TAK::Engine::Util::TAKErr Database2::getErrorMessage(TAK::Engine::Port::String &value) NOTHROWS {
     return TAK::Engine::Util::TE_Unsupported;
 }
 
 namespace
 {
+    /**
+     * LRU of idle prepared statements for a single connection, keyed by SQL.
+     * Statements are checked out on compile and returned when the owning
+     * `Statement2` or `Query` is destructed. Statements returned after the
+     * cache has been cleared (i.e. the connection is closing) are finalized.
+     */
+    class StatementCache : TAK::Engine::Util::NonCopyable
+    {
+    private :
+        typedef std::list<std::pair<std::string, sqlite3_stmt *>> Entries;
+    public :
+        StatementCache(const std::size_t limit) NOTHROWS;
+        ~StatementCache() NOTHROWS;
+    public :
+        /** returns an idle statement for the SQL, or `nullptr` if none */
+        sqlite3_stmt *acquire(const char *sql) NOTHROWS;
+        /** resets the statement and returns it to the cache */
+        void release(sqlite3_stmt *stmt) NOTHROWS;
+        /** finalizes all idle statements; subsequently released statements are finalized */
+        void clear() NOTHROWS;
+    private :
+        Mutex mutex;
+        std::size_t limit;
+        bool closed;
+        Entries entries;
+        std::unordered_multimap<std::string, Entries::iterator> index;
+    };
+
     class SpatiaLiteDB : public Database2,
                          TAK::Engine::Util::NonCopyable
     {
@@ -87,6 +123,7 @@ namespace
         Mutex mutex;
         struct sqlite3* connection;
         void* cache;
+        std::shared_ptr<StatementCache> statements;
         bool inTrans;
         bool successfulTrans;
         bool readOnly;
@@ -95,7 +132,7 @@ namespace
     class StatementImpl : public Statement2
     {
     public:
-        StatementImpl(sqlite3_stmt* stmt) NOTHROWS; // Must not be NULL.
+        StatementImpl(sqlite3_stmt* stmt, const std::shared_ptr<StatementCache> &cache) NOTHROWS; // Must not be NULL.
     public :
         ~StatementImpl() NOTHROWS override;
     public :
@@ -110,12 +147,13 @@ namespace
         TAK::Engine::Util::TAKErr clearBindings() NOTHROWS override;
     private:
         sqlite3_stmt* impl;
+        std::shared_ptr<StatementCache> cache;
     };
 
     class QueryImpl : public Query
     {
     public:
-        QueryImpl(sqlite3_stmt* stmt) NOTHROWS; // Must not be NULL.
+        QueryImpl(sqlite3_stmt* stmt, const std::shared_ptr<StatementCache> &cache) NOTHROWS; // Must not be NULL.
     public :
         ~QueryImpl() NOTHROWS override;
 #if 0
@@ -151,6 +189,7 @@ namespace
         TAK::Engine::Util::TAKErr validate(std::size_t colIndex) const NOTHROWS;
     private :
         sqlite3_stmt* impl;
+        std::shared_ptr<StatementCache> cache;
         std::size_t colCount;
         mutable std::vector<String> columnNames;
         bool valid;
@@ -354,6 +393,85 @@ TAK::Engine::Util::TAKErr TAK::Engine::DB::Databases_openDatabase(DatabasePtr &d
     }
 }
 
+TAK::Engine::Util::TAKErr TAK::Engine::DB::Databases_applyProfile(Database2 &db, const DatabaseProfile profile) NOTHROWS
+{
+    const char *name;
+    // negative values retain the SQLite default
+    int mmapSizeMB;
+    int cacheSizeKB;
+    int pageSize;
+    int tempStore;
+    int synchronous;
+    switch (profile) {
+    case TEDP_Default :
+        return TE_Ok;
+    case TEDP_ReadMostly :
+        name = "read-mostly";
+        mmapSizeMB = 256;
+        cacheSizeKB = 16384;
+        pageSize = -1;
+        tempStore = 2; // MEMORY
+        synchronous = 1; // NORMAL
+        break;
+    case TEDP_BulkIngest :
+        name = "bulk-ingest";
+        mmapSizeMB = 64;
+        cacheSizeKB = 65536;
+        pageSize = -1;
+        tempStore = 2; // MEMORY
+        synchronous = 0; // OFF
+        break;
+    case TEDP_TileCache :
+        name = "tile-cache";
+        mmapSizeMB = 128;
+        cacheSizeKB = 8192;
+        pageSize = 8192;
+        tempStore = 2; // MEMORY
+        synchronous = 1; // NORMAL
+        break;
+    default :
+        return TE_InvalidArg;
+    }
+
+    struct {
+        const char *option;
+        const char *pragma;
+        int value;
+        int64_t scale;
+    } settings[] = {
+        // page size must precede any access that creates the schema
+        { "page-size", "page_size", pageSize, 1LL },
+        { "mmap-size-mb", "mmap_size", mmapSizeMB, 1024LL * 1024LL },
+        // negative cache_size is interpreted by SQLite as KiB
+        { "cache-size-kb", "cache_size", cacheSizeKB, -1LL },
+        { "temp-store", "temp_store", tempStore, 1LL },
+        { "synchronous", "synchronous", synchronous, 1LL },
+    };
+
+    TAKErr code(TE_Ok);
+    for (std::size_t i = 0u; i < sizeof(settings) / sizeof(settings[0]); i++) {
+        StringBuilder option;
+        StringBuilder_combine(option, "database.", name, ".", settings[i].option);
+        const int value = ConfigOptions_getIntOptionOrDefault(option.c_str(), settings[i].value);
+        if (value < 0)
+            continue;
+
+        StringBuilder pragma;
+        StringBuilder_combine(pragma, "PRAGMA ", settings[i].pragma, " = ", static_cast<long long>(value * settings[i].scale));
+        // some pragmas report the new value; step through any result
+        QueryPtr result(nullptr, nullptr);
+        code = db.query(result, pragma.c_str());
+        TE_CHECKBREAK_CODE(code);
+        do {
+            code = result->moveToNext();
+        } while (code == TE_Ok);
+        if (code == TE_Done)
+            code = TE_Ok;
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
 void TAK::Engine::DB::Databases_enableDebug(bool v) NOTHROWS
 {
     dbdbg = v;
@@ -366,6 +484,7 @@ namespace
         mutex(TEMT_Recursive),
         connection(nullptr),
         cache(nullptr),
+        statements(new StatementCache(STATEMENT_CACHE_LIMIT)),
         inTrans(false),
         successfulTrans(false),
         readOnly(ro)
@@ -434,6 +553,8 @@ namespace
         if (code == TE_Ok) {
             if (connection)
             {
+                // outstanding statements are finalized on release
+                statements->clear();
                 int response(sqlite3_close_v2(connection));
 
                 connection = nullptr;
@@ -452,6 +573,7 @@ namespace
             // Make a last-ditch effort.
             //
 
+            statements->clear();
             sqlite3_close_v2(connection);
             connection = nullptr;
             spatialite_cleanup_ex(cache);
@@ -496,11 +618,12 @@ namespace
         code = lock.status;
         TE_CHECKRETURN_CODE(code);
 
-        sqlite3_stmt *stmt(nullptr);
-
-        code = prepareStatement(&stmt, sql, connection);
-        CHECKRETURN_CODE(code);
-        result = StatementPtr(new StatementImpl(stmt), deleteImpl<Statement2, StatementImpl>);
+        sqlite3_stmt *stmt(statements->acquire(sql));
+        if (!stmt) {
+            code = prepareStatement(&stmt, sql, connection);
+            CHECKRETURN_CODE(code);
+        }
+        result = StatementPtr(new StatementImpl(stmt, statements), deleteImpl<Statement2, StatementImpl>);
 
         return code;
     }
@@ -514,11 +637,12 @@ namespace
         code = lock.status;
         TE_CHECKRETURN_CODE(code);
 
-        sqlite3_stmt *stmt(nullptr);
-
-        code = prepareStatement(&stmt, sql, connection);
-        CHECKRETURN_CODE(code);
-        result = QueryPtr(new QueryImpl(stmt), deleteImpl<Query, QueryImpl>);
+        sqlite3_stmt *stmt(statements->acquire(sql));
+        if (!stmt) {
+            code = prepareStatement(&stmt, sql, connection);
+            CHECKRETURN_CODE(code);
+        }
+        result = QueryPtr(new QueryImpl(stmt, statements), deleteImpl<Query, QueryImpl>);
         return code;
     }
 
@@ -665,17 +789,102 @@ namespace
         return TAK::Engine::Util::TE_Ok;
     }
 
+    /*************************************************************************/
+    // Statement Cache
+
+    StatementCache::StatementCache(const std::size_t limit_) NOTHROWS :
+        limit(limit_),
+        closed(false)
+    {}
+
+    StatementCache::~StatementCache() NOTHROWS
+    {
+        clear();
+    }
+
+    sqlite3_stmt *StatementCache::acquire(const char *sql) NOTHROWS
+    {
+        if (!sql)
+            return nullptr;
+
+        Lock lock(mutex);
+        if (lock.status != TE_Ok || closed)
+            return nullptr;
+
+        auto entry = index.find(sql);
+        if (entry == index.end())
+            return nullptr;
+
+        sqlite3_stmt *stmt = entry->second->second;
+        entries.erase(entry->second);
+        index.erase(entry);
+        return stmt;
+    }
+
+    void StatementCache::release(sqlite3_stmt *stmt) NOTHROWS
+    {
+        // the reset status reflects the last evaluation, which has already
+        // been reported to the client
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+
+        const char *sql = sqlite3_sql(stmt);
+
+        sqlite3_stmt *evicted(nullptr);
+        {
+            Lock lock(mutex);
+            if (lock.status != TE_Ok || closed || !sql || !limit) {
+                evicted = stmt;
+            } else {
+                entries.push_front(std::make_pair(std::string(sql), stmt));
+                index.insert(std::make_pair(entries.front().first, entries.begin()));
+                if (entries.size() > limit) {
+                    auto lru = std::prev(entries.end());
+                    auto range = index.equal_range(lru->first);
+                    for (auto it = range.first; it != range.second; it++) {
+                        if (it->second == lru) {
+                            index.erase(it);
+                            break;
+                        }
+                    }
+                    evicted = lru->second;
+                    entries.erase(lru);
+                }
+            }
+        }
+        if (evicted)
+            sqlite3_finalize(evicted);
+    }
+
+    void StatementCache::clear() NOTHROWS
+    {
+        Entries finalize;
+        {
+            Lock lock(mutex);
+            closed = true;
+            index.clear();
+            finalize.swap(entries);
+        }
+        for (auto it = finalize.begin(); it != finalize.end(); it++)
+            sqlite3_finalize(it->second);
+    }
+
     /*************************************************************************/
     // Query Implementation
 
-    QueryImpl::QueryImpl(sqlite3_stmt* stmt) NOTHROWS :
+    QueryImpl::QueryImpl(sqlite3_stmt* stmt, const std::shared_ptr<StatementCache> &cache_) NOTHROWS :
         impl(stmt),
+        cache(cache_),
         colCount(sqlite3_column_count(impl)),
         valid(false)
     { }
 
     QueryImpl::~QueryImpl() NOTHROWS
     {
+        if (cache) {
+            cache->release(impl);
+            return;
+        }
         int response(sqlite3_finalize(impl));
 
         if (response != SQLITE_OK)
@@ -873,12 +1082,17 @@ namespace
     /*************************************************************************/
     // Statement Implementation
 
-    StatementImpl::StatementImpl(sqlite3_stmt *stmt) NOTHROWS:
-        impl(stmt)
+    StatementImpl::StatementImpl(sqlite3_stmt *stmt, const std::shared_ptr<StatementCache> &cache_) NOTHROWS:
+        impl(stmt),
+        cache(cache_)
     {}
 
     StatementImpl::~StatementImpl() NOTHROWS
     {
+        if (cache) {
+            cache->release(impl);
+            return;
+        }
         int response(sqlite3_finalize(impl));
 
         if (response != SQLITE_OK)
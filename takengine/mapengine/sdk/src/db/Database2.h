@@ -54,6 +54,23 @@ namespace TAK {
 
             typedef std::unique_ptr<Database2, void(*)(const Database2 *)> DatabasePtr;
 
+            /**
+             * Connection tuning profiles. Each profile sets the page cache
+             * size, memory-mapped I/O size, temp store and synchronous mode
+             * for the connection; see Databases_applyProfile.
+             */
+            enum DatabaseProfile
+            {
+                /** SQLite defaults */
+                TEDP_Default,
+                /** read-mostly catalogs; memory-mapped I/O and a larger page cache */
+                TEDP_ReadMostly,
+                /** bulk ingest; relaxed durability and a large page cache */
+                TEDP_BulkIngest,
+                /** tile caches; memory-mapped I/O and larger pages for blob reads */
+                TEDP_TileCache,
+            };
+
             ///=============================================================================
             ///
             ///  class atakmap::db::Database::Transaction
@@ -101,6 +118,19 @@ namespace TAK {
 			 */
 			ENGINE_API TAK::Engine::Util::TAKErr Databases_openDatabase(DatabasePtr &db, const char* databaseFilePath, const uint8_t *key, const std::size_t keylen, const bool readOnly = false) NOTHROWS;
 
+			/**
+			 * Applies the tuning profile to the connection. Individual
+			 * settings may be overridden via the ConfigOptions
+			 * `database.<profile>.<setting>`, where `<profile>` is one of
+			 * `read-mostly`, `bulk-ingest` or `tile-cache` and `<setting>`
+			 * is one of `mmap-size-mb`, `cache-size-kb`, `page-size`,
+			 * `temp-store` or `synchronous`. A negative value leaves the
+			 * setting at the SQLite default.
+			 *
+			 * <P>`page-size` only takes effect for newly created databases.
+			 */
+			ENGINE_API TAK::Engine::Util::TAKErr Databases_applyProfile(Database2 &db, const DatabaseProfile profile) NOTHROWS;
+
 			ENGINE_API void Databases_enableDebug(bool v) NOTHROWS;
 
         }
@@ -3,6 +3,7 @@
 #include <map>
 #include <vector>
 
+#include "db/DatabaseProfiler.h"
 #include "db/DefaultDatabaseProvider.h"
 #include "util/CopyOnWrite.h"
 
@@ -41,6 +42,8 @@ TAKErr TAK::Engine::DB::DatabaseFactory_create(DatabasePtr &result, const Databa
         if(registry->priority_map.size())
             code = registry->priority_map[registry->priority_map.size()-1u]->create(result, dbInformation);
     }
+    if(code == TE_Ok && DatabaseProfiler_isEnabled())
+        code = DatabaseProfiler_instrument(result);
     return code;
 }
 
@@ -3,10 +3,13 @@
 using namespace TAK::Engine::DB;
 using namespace TAK::Engine::Util;
 
-DatabaseInformation::DatabaseInformation(const char* uri) : uri_(uri), passphrase_(nullptr), options_(DATABASE_OPTIONS_NONE) {}
+DatabaseInformation::DatabaseInformation(const char* uri) : uri_(uri), passphrase_(nullptr), options_(DATABASE_OPTIONS_NONE), profile_(TEDP_Default) {}
 
 DatabaseInformation::DatabaseInformation(const char* uri, const char* passphrase, int options)
-    : uri_(uri), passphrase_(passphrase), options_(options) {}
+    : uri_(uri), passphrase_(passphrase), options_(options), profile_(TEDP_Default) {}
+
+DatabaseInformation::DatabaseInformation(const char* uri, const char* passphrase, int options, DatabaseProfile profile)
+    : uri_(uri), passphrase_(passphrase), options_(options), profile_(profile) {}
 
 TAKErr DatabaseInformation::getUri(const char** value) const NOTHROWS {
     if (value)
@@ -24,4 +27,10 @@ TAKErr DatabaseInformation::getOptions(int* value) const NOTHROWS {
     if (value)
         *value = this->options_;
     return TE_Ok;
-}
\ No newline at end of file
+}
+
+TAKErr DatabaseInformation::getProfile(DatabaseProfile* value) const NOTHROWS {
+    if (value)
+        *value = this->profile_;
+    return TE_Ok;
+}
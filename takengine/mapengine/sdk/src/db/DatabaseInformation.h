@@ -11,21 +11,29 @@ namespace DB {
 enum {
     DATABASE_OPTIONS_NONE = 0,
 
-    DATABASE_OPTIONS_READONLY = 0x000001
+    DATABASE_OPTIONS_READONLY = 0x000001,
+    /** queries are served by a pool of read-only connections; see `PooledDatabase_open` */
+    DATABASE_OPTIONS_POOLED = 0x000002,
 };
 struct ENGINE_API DatabaseInformation {
    public:
     DatabaseInformation(const char* uri);
     DatabaseInformation(const char* uri, const char* passphrase, int options);
+    /**
+     * @param profile   The tuning profile applied to the connection(s) on open
+     */
+    DatabaseInformation(const char* uri, const char* passphrase, int options, DatabaseProfile profile);
 
     Util::TAKErr getUri(const char** value) const NOTHROWS;
     Util::TAKErr getPassphrase(const char** value) const NOTHROWS;
     Util::TAKErr getOptions(int* value) const NOTHROWS;
+    Util::TAKErr getProfile(DatabaseProfile* value) const NOTHROWS;
 
    private:
     Port::String uri_;
     Port::String passphrase_;
     int options_;
+    DatabaseProfile profile_;
 };
 }  // namespace DB
 }  // namespace Engine
@@ -0,0 +1,556 @@
+#include "db/DatabaseProfiler.h"
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "db/Query.h"
+#include "db/Statement2.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/Logging2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::DB;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    struct Statistics
+    {
+        uint64_t count {0u};
+        uint64_t totalTime {0u};
+        uint64_t maxTime {0u};
+        uint64_t rows {0u};
+    };
+
+    struct StatisticsRegistry
+    {
+        Mutex mutex;
+        std::map<std::string, Statistics> statistics;
+    };
+
+    /** the SQL for a compiled statement or query */
+    struct ProfiledSql
+    {
+        std::string sql;
+        std::string normalized;
+    };
+
+    class ProfiledQuery : public Query
+    {
+    public :
+        ProfiledQuery(QueryPtr &&impl, const std::shared_ptr<Database2> &db, const std::shared_ptr<const ProfiledSql> &sql, const int64_t compileTime) NOTHROWS;
+        ~ProfiledQuery() NOTHROWS override;
+    public :
+        TAKErr moveToNext() NOTHROWS override;
+    public :
+        TAKErr getColumnIndex(std::size_t *value, const char *columnName) NOTHROWS override;
+        TAKErr getColumnName(const char **value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getColumnCount(std::size_t *value) NOTHROWS override;
+        TAKErr getBlob(const uint8_t **value, std::size_t *len, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getString(const char **value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getInt(int32_t *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getLong(int64_t *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getDouble(double *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getType(FieldType *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr isNull(bool *value, const std::size_t columnIndex) NOTHROWS override;
+    public :
+        TAKErr bindBlob(const std::size_t idx, const uint8_t *blob, const std::size_t size) NOTHROWS override;
+        TAKErr bindInt(const std::size_t idx, const int32_t value) NOTHROWS override;
+        TAKErr bindLong(const std::size_t idx, const int64_t value) NOTHROWS override;
+        TAKErr bindDouble(const std::size_t idx, const double value) NOTHROWS override;
+        TAKErr bindString(const std::size_t idx, const char *value) NOTHROWS override;
+        TAKErr bindNull(const std::size_t idx) NOTHROWS override;
+        TAKErr clearBindings() NOTHROWS override;
+    private :
+        /** records the current execution, if the query has been stepped */
+        void flush() NOTHROWS;
+    private :
+        QueryPtr impl;
+        std::weak_ptr<Database2> db;
+        std::shared_ptr<const ProfiledSql> sql;
+        int64_t elapsed;
+        uint64_t rows;
+        bool stepped;
+    };
+
+    class ProfiledStatement : public Statement2
+    {
+    public :
+        ProfiledStatement(StatementPtr &&impl, const std::shared_ptr<Database2> &db, const std::shared_ptr<const ProfiledSql> &sql, const int64_t compileTime) NOTHROWS;
+        ~ProfiledStatement() NOTHROWS override;
+    public :
+        TAKErr execute() NOTHROWS override;
+    public :
+        TAKErr bindBlob(const std::size_t idx, const uint8_t *blob, const std::size_t size) NOTHROWS override;
+        TAKErr bindInt(const std::size_t idx, const int32_t value) NOTHROWS override;
+        TAKErr bindLong(const std::size_t idx, const int64_t value) NOTHROWS override;
+        TAKErr bindDouble(const std::size_t idx, const double value) NOTHROWS override;
+        TAKErr bindString(const std::size_t idx, const char *value) NOTHROWS override;
+        TAKErr bindNull(const std::size_t idx) NOTHROWS override;
+        TAKErr clearBindings() NOTHROWS override;
+    private :
+        StatementPtr impl;
+        std::weak_ptr<Database2> db;
+        std::shared_ptr<const ProfiledSql> sql;
+        /** compile time, charged to the first execution */
+        int64_t compileTime;
+    };
+
+    class ProfiledDatabase : public Database2
+    {
+    public :
+        ProfiledDatabase(DatabasePtr &&impl) NOTHROWS;
+    public :
+        ~ProfiledDatabase() NOTHROWS override;
+    public :
+        TAKErr execute(const char *sql, const char **args, const std::size_t len) NOTHROWS override;
+        TAKErr query(QueryPtr &query, const char *sql) NOTHROWS override;
+        TAKErr compileStatement(StatementPtr &stmt, const char *sql) NOTHROWS override;
+        TAKErr compileQuery(QueryPtr &query, const char *sql) NOTHROWS override;
+
+        TAKErr isReadOnly(bool *value) NOTHROWS override;
+        TAKErr getVersion(int *value) NOTHROWS override;
+        TAKErr setVersion(const int version) NOTHROWS override;
+
+        TAKErr beginTransaction() NOTHROWS override;
+        TAKErr setTransactionSuccessful() NOTHROWS override;
+        TAKErr endTransaction() NOTHROWS override;
+
+        TAKErr inTransaction(bool *value) NOTHROWS override;
+
+        TAKErr getErrorMessage(String &value) NOTHROWS override;
+    private :
+        TAKErr profiledQuery(QueryPtr &value, const char *sql, const bool compile) NOTHROWS;
+    private :
+        std::shared_ptr<Database2> impl;
+    };
+
+    std::atomic<bool> &enabled() NOTHROWS
+    {
+        static std::atomic<bool> e(false);
+        return e;
+    }
+    std::atomic<int64_t> &slowQueryThreshold() NOTHROWS
+    {
+        static std::atomic<int64_t> t(100000LL);
+        return t;
+    }
+    StatisticsRegistry &registry() NOTHROWS
+    {
+        static StatisticsRegistry r;
+        return r;
+    }
+    int64_t now_micros() NOTHROWS
+    {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Collapses whitespace and replaces string and numeric literals with
+     * `?` so that statements differing only in their literals are
+     * aggregated.
+     */
+    std::string normalize(const char *sql) NOTHROWS;
+    std::shared_ptr<const ProfiledSql> profiledSql(const char *sql) NOTHROWS;
+    /**
+     * Records a single execution, logging its query plan if it exceeded
+     * the slow query threshold.
+     */
+    void record(const ProfiledSql &sql, const int64_t elapsed, const uint64_t rows, const std::weak_ptr<Database2> &db) NOTHROWS;
+}
+
+QueryProfile::QueryProfile() NOTHROWS :
+    count(0u),
+    totalTime(0u),
+    maxTime(0u),
+    rows(0u)
+{}
+
+void TAK::Engine::DB::DatabaseProfiler_setEnabled(const bool e) NOTHROWS
+{
+    enabled() = e;
+}
+bool TAK::Engine::DB::DatabaseProfiler_isEnabled() NOTHROWS
+{
+    return enabled();
+}
+void TAK::Engine::DB::DatabaseProfiler_setSlowQueryThreshold(const int64_t micros) NOTHROWS
+{
+    slowQueryThreshold() = micros;
+}
+TAKErr TAK::Engine::DB::DatabaseProfiler_instrument(DatabasePtr &db) NOTHROWS
+{
+    if (!db)
+        return TE_InvalidArg;
+    db = DatabasePtr(new ProfiledDatabase(std::move(db)), Memory_deleter_const<Database2, ProfiledDatabase>);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::DB::DatabaseProfiler_snapshot(Collection<std::shared_ptr<QueryProfile>> &value) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    StatisticsRegistry &r = registry();
+    Lock lock(r.mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    for (auto it = r.statistics.begin(); it != r.statistics.end(); it++) {
+        std::shared_ptr<QueryProfile> profile(std::make_shared<QueryProfile>());
+        profile->sql = it->first.c_str();
+        profile->count = it->second.count;
+        profile->totalTime = it->second.totalTime;
+        profile->maxTime = it->second.maxTime;
+        profile->rows = it->second.rows;
+        code = value.add(profile);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+TAKErr TAK::Engine::DB::DatabaseProfiler_reset() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    StatisticsRegistry &r = registry();
+    Lock lock(r.mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    r.statistics.clear();
+    return code;
+}
+
+namespace
+{
+    ProfiledQuery::ProfiledQuery(QueryPtr &&impl_, const std::shared_ptr<Database2> &db_, const std::shared_ptr<const ProfiledSql> &sql_, const int64_t compileTime) NOTHROWS :
+        impl(std::move(impl_)),
+        db(db_),
+        sql(sql_),
+        elapsed(compileTime),
+        rows(0u),
+        stepped(false)
+    {}
+    ProfiledQuery::~ProfiledQuery() NOTHROWS
+    {
+        flush();
+    }
+    void ProfiledQuery::flush() NOTHROWS
+    {
+        if (!stepped)
+            return;
+        record(*sql, elapsed, rows, db);
+        elapsed = 0LL;
+        rows = 0u;
+        stepped = false;
+    }
+    TAKErr ProfiledQuery::moveToNext() NOTHROWS
+    {
+        const int64_t start = now_micros();
+        const TAKErr code = impl->moveToNext();
+        elapsed += now_micros() - start;
+        stepped = true;
+        if (code == TE_Ok)
+            rows++;
+        return code;
+    }
+    TAKErr ProfiledQuery::getColumnIndex(std::size_t *value, const char *columnName) NOTHROWS
+    {
+        return impl->getColumnIndex(value, columnName);
+    }
+    TAKErr ProfiledQuery::getColumnName(const char **value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getColumnName(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::getColumnCount(std::size_t *value) NOTHROWS
+    {
+        return impl->getColumnCount(value);
+    }
+    TAKErr ProfiledQuery::getBlob(const uint8_t **value, std::size_t *len, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getBlob(value, len, columnIndex);
+    }
+    TAKErr ProfiledQuery::getString(const char **value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getString(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::getInt(int32_t *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getInt(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::getLong(int64_t *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getLong(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::getDouble(double *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getDouble(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::getType(FieldType *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getType(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::isNull(bool *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->isNull(value, columnIndex);
+    }
+    TAKErr ProfiledQuery::bindBlob(const std::size_t idx, const uint8_t *blob, const std::size_t size) NOTHROWS
+    {
+        return impl->bindBlob(idx, blob, size);
+    }
+    TAKErr ProfiledQuery::bindInt(const std::size_t idx, const int32_t value) NOTHROWS
+    {
+        return impl->bindInt(idx, value);
+    }
+    TAKErr ProfiledQuery::bindLong(const std::size_t idx, const int64_t value) NOTHROWS
+    {
+        return impl->bindLong(idx, value);
+    }
+    TAKErr ProfiledQuery::bindDouble(const std::size_t idx, const double value) NOTHROWS
+    {
+        return impl->bindDouble(idx, value);
+    }
+    TAKErr ProfiledQuery::bindString(const std::size_t idx, const char *value) NOTHROWS
+    {
+        return impl->bindString(idx, value);
+    }
+    TAKErr ProfiledQuery::bindNull(const std::size_t idx) NOTHROWS
+    {
+        return impl->bindNull(idx);
+    }
+    TAKErr ProfiledQuery::clearBindings() NOTHROWS
+    {
+        // clearing the bindings resets the query for another execution
+        flush();
+        return impl->clearBindings();
+    }
+
+    ProfiledStatement::ProfiledStatement(StatementPtr &&impl_, const std::shared_ptr<Database2> &db_, const std::shared_ptr<const ProfiledSql> &sql_, const int64_t compileTime_) NOTHROWS :
+        impl(std::move(impl_)),
+        db(db_),
+        sql(sql_),
+        compileTime(compileTime_)
+    {}
+    ProfiledStatement::~ProfiledStatement() NOTHROWS
+    {}
+    TAKErr ProfiledStatement::execute() NOTHROWS
+    {
+        const int64_t start = now_micros();
+        const TAKErr code = impl->execute();
+        record(*sql, (now_micros() - start) + compileTime, 0u, db);
+        compileTime = 0LL;
+        return code;
+    }
+    TAKErr ProfiledStatement::bindBlob(const std::size_t idx, const uint8_t *blob, const std::size_t size) NOTHROWS
+    {
+        return impl->bindBlob(idx, blob, size);
+    }
+    TAKErr ProfiledStatement::bindInt(const std::size_t idx, const int32_t value) NOTHROWS
+    {
+        return impl->bindInt(idx, value);
+    }
+    TAKErr ProfiledStatement::bindLong(const std::size_t idx, const int64_t value) NOTHROWS
+    {
+        return impl->bindLong(idx, value);
+    }
+    TAKErr ProfiledStatement::bindDouble(const std::size_t idx, const double value) NOTHROWS
+    {
+        return impl->bindDouble(idx, value);
+    }
+    TAKErr ProfiledStatement::bindString(const std::size_t idx, const char *value) NOTHROWS
+    {
+        return impl->bindString(idx, value);
+    }
+    TAKErr ProfiledStatement::bindNull(const std::size_t idx) NOTHROWS
+    {
+        return impl->bindNull(idx);
+    }
+    TAKErr ProfiledStatement::clearBindings() NOTHROWS
+    {
+        return impl->clearBindings();
+    }
+
+    ProfiledDatabase::ProfiledDatabase(DatabasePtr &&impl_) NOTHROWS :
+        impl(std::move(impl_))
+    {}
+    ProfiledDatabase::~ProfiledDatabase() NOTHROWS
+    {}
+    TAKErr ProfiledDatabase::execute(const char *sql, const char **args, const std::size_t len) NOTHROWS
+    {
+        const int64_t start = now_micros();
+        const TAKErr code = impl->execute(sql, args, len);
+        const int64_t elapsed = now_micros() - start;
+        if (code == TE_Ok) {
+            std::shared_ptr<const ProfiledSql> profiled(profiledSql(sql));
+            if (profiled)
+                record(*profiled, elapsed, 0u, impl);
+        }
+        return code;
+    }
+    TAKErr ProfiledDatabase::query(QueryPtr &value, const char *sql) NOTHROWS
+    {
+        return profiledQuery(value, sql, false);
+    }
+    TAKErr ProfiledDatabase::compileStatement(StatementPtr &stmt, const char *sql) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const int64_t start = now_micros();
+        StatementPtr compiled(nullptr, nullptr);
+        code = impl->compileStatement(compiled, sql);
+        TE_CHECKRETURN_CODE(code);
+        const int64_t compileTime = now_micros() - start;
+
+        std::shared_ptr<const ProfiledSql> profiled(profiledSql(sql));
+        if (!profiled) {
+            stmt = std::move(compiled);
+            return code;
+        }
+        stmt = StatementPtr(new ProfiledStatement(std::move(compiled), impl, profiled, compileTime), Memory_deleter_const<Statement2, ProfiledStatement>);
+        return code;
+    }
+    TAKErr ProfiledDatabase::compileQuery(QueryPtr &value, const char *sql) NOTHROWS
+    {
+        return profiledQuery(value, sql, true);
+    }
+    TAKErr ProfiledDatabase::profiledQuery(QueryPtr &value, const char *sql, const bool compile) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const int64_t start = now_micros();
+        QueryPtr compiled(nullptr, nullptr);
+        code = compile ? impl->compileQuery(compiled, sql) : impl->query(compiled, sql);
+        TE_CHECKRETURN_CODE(code);
+        const int64_t compileTime = now_micros() - start;
+
+        std::shared_ptr<const ProfiledSql> profiled(profiledSql(sql));
+        if (!profiled) {
+            value = std::move(compiled);
+            return code;
+        }
+        value = QueryPtr(new ProfiledQuery(std::move(compiled), impl, profiled, compileTime), Memory_deleter_const<Query, ProfiledQuery>);
+        return code;
+    }
+    TAKErr ProfiledDatabase::isReadOnly(bool *value) NOTHROWS
+    {
+        return impl->isReadOnly(value);
+    }
+    TAKErr ProfiledDatabase::getVersion(int *value) NOTHROWS
+    {
+        return impl->getVersion(value);
+    }
+    TAKErr ProfiledDatabase::setVersion(const int version) NOTHROWS
+    {
+        return impl->setVersion(version);
+    }
+    TAKErr ProfiledDatabase::beginTransaction() NOTHROWS
+    {
+        return impl->beginTransaction();
+    }
+    TAKErr ProfiledDatabase::setTransactionSuccessful() NOTHROWS
+    {
+        return impl->setTransactionSuccessful();
+    }
+    TAKErr ProfiledDatabase::endTransaction() NOTHROWS
+    {
+        return impl->endTransaction();
+    }
+    TAKErr ProfiledDatabase::inTransaction(bool *value) NOTHROWS
+    {
+        return impl->inTransaction(value);
+    }
+    TAKErr ProfiledDatabase::getErrorMessage(String &value) NOTHROWS
+    {
+        return impl->getErrorMessage(value);
+    }
+
+    std::string normalize(const char *sql) NOTHROWS
+    {
+        std::string normalized;
+        bool space = false;
+        for (const char *c = sql; *c; c++) {
+            if (isspace(static_cast<unsigned char>(*c))) {
+                space = true;
+                continue;
+            }
+            if (space && !normalized.empty())
+                normalized.push_back(' ');
+            space = false;
+
+            const char prev = normalized.empty() ? ' ' : normalized.back();
+            if (*c == '\'') {
+                // string literal, quotes are escaped by doubling
+                c++;
+                while (*c && !(*c == '\'' && c[1] != '\''))
+                    c += (*c == '\'') ? 2 : 1;
+                normalized.push_back('?');
+                if (!*c)
+                    break;
+            } else if (isdigit(static_cast<unsigned char>(*c)) && !isalnum(static_cast<unsigned char>(prev)) && prev != '_' && prev != '"') {
+                // numeric literal, including decimal, exponent and hex forms
+                while (isalnum(static_cast<unsigned char>(c[1])) || c[1] == '.')
+                    c++;
+                normalized.push_back('?');
+            } else {
+                normalized.push_back(*c);
+            }
+        }
+        return normalized;
+    }
+    std::shared_ptr<const ProfiledSql> profiledSql(const char *sql) NOTHROWS
+    {
+        if (!sql)
+            return std::shared_ptr<const ProfiledSql>();
+        std::shared_ptr<ProfiledSql> profiled(std::make_shared<ProfiledSql>());
+        profiled->sql = sql;
+        profiled->normalized = normalize(sql);
+        return profiled;
+    }
+    void record(const ProfiledSql &sql, const int64_t elapsed, const uint64_t rows, const std::weak_ptr<Database2> &db) NOTHROWS
+    {
+        const uint64_t micros = elapsed > 0LL ? static_cast<uint64_t>(elapsed) : 0u;
+        {
+            StatisticsRegistry &r = registry();
+            Lock lock(r.mutex);
+            if (lock.status != TE_Ok)
+                return;
+            Statistics &statistics = r.statistics[sql.normalized];
+            statistics.count++;
+            statistics.totalTime += micros;
+            if (micros > statistics.maxTime)
+                statistics.maxTime = micros;
+            statistics.rows += rows;
+        }
+
+        const int64_t threshold = slowQueryThreshold();
+        if (!threshold || elapsed < threshold)
+            return;
+
+        // explain outside of the registry lock; parameters are unbound
+        std::ostringstream plan;
+        std::shared_ptr<Database2> explainDb(db.lock());
+        if (explainDb) {
+            std::string explain("EXPLAIN QUERY PLAN ");
+            explain += sql.sql;
+            QueryPtr result(nullptr, nullptr);
+            if (explainDb->query(result, explain.c_str()) == TE_Ok) {
+                while (result->moveToNext() == TE_Ok) {
+                    const char *detail = nullptr;
+                    if (result->getString(&detail, 3u) != TE_Ok || !detail)
+                        continue;
+                    if (plan.tellp() > 0)
+                        plan << "; ";
+                    plan << detail;
+                }
+            }
+        }
+        const std::string planStr(plan.str());
+        Logger_log(TELL_Warning, "DatabaseProfiler: slow query (%lldus, %llu rows): %s [plan: %s]",
+            static_cast<long long>(elapsed), static_cast<unsigned long long>(rows), sql.normalized.c_str(),
+            planStr.empty() ? "n/a" : planStr.c_str());
+    }
+}
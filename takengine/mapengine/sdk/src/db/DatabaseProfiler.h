@@ -0,0 +1,73 @@
+#ifndef TAK_ENGINE_DB_DATABASEPROFILER_H_INCLUDED
+#define TAK_ENGINE_DB_DATABASEPROFILER_H_INCLUDED
+
+#include <cstdint>
+#include <memory>
+
+#include "db/Database2.h"
+#include "port/Collection.h"
+#include "port/Platform.h"
+#include "port/String.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace DB {
+            /**
+             * Point-in-time copy of the statistics recorded for a single
+             * normalized SQL string. SQL is normalized by collapsing
+             * whitespace and replacing literals with `?`.
+             */
+            struct ENGINE_API QueryProfile
+            {
+                QueryProfile() NOTHROWS;
+
+                /** The normalized SQL */
+                Port::String sql;
+                /** Number of executions */
+                uint64_t count;
+                /** Total time spent compiling, executing and stepping, microseconds */
+                uint64_t totalTime;
+                /** Longest single execution, microseconds */
+                uint64_t maxTime;
+                /** Total number of result rows stepped */
+                uint64_t rows;
+            };
+
+            /**
+             * Enables or disables profiling. Only databases created via
+             * DatabaseFactory_create while profiling is enabled, or
+             * explicitly instrumented via DatabaseProfiler_instrument, are
+             * profiled. Disabled by default.
+             */
+            ENGINE_API void DatabaseProfiler_setEnabled(const bool enabled) NOTHROWS;
+            ENGINE_API bool DatabaseProfiler_isEnabled() NOTHROWS;
+
+            /**
+             * Sets the execution time, in microseconds, above which queries
+             * are logged along with their `EXPLAIN QUERY PLAN`. A value of
+             * `0` disables the slow query log. Defaults to 100ms.
+             */
+            ENGINE_API void DatabaseProfiler_setSlowQueryThreshold(const int64_t micros) NOTHROWS;
+
+            /**
+             * Replaces `db` with a profiled view of the same database. All
+             * statements and queries compiled through the returned
+             * database are recorded.
+             */
+            ENGINE_API Util::TAKErr DatabaseProfiler_instrument(DatabasePtr &db) NOTHROWS;
+
+            /**
+             * Captures the statistics recorded for all profiled databases.
+             */
+            ENGINE_API Util::TAKErr DatabaseProfiler_snapshot(Port::Collection<std::shared_ptr<QueryProfile>> &value) NOTHROWS;
+
+            /**
+             * Clears all recorded statistics.
+             */
+            ENGINE_API Util::TAKErr DatabaseProfiler_reset() NOTHROWS;
+        }
+    }
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "db/DefaultDatabaseProvider.h"
 
+#include "db/PooledDatabase.h"
+#include "util/ConfigOptions.h"
+#include "util/Logging2.h"
+
 using namespace TAK::Engine::DB;
 using namespace TAK::Engine::Util;
 
@@ -8,8 +12,19 @@ TAKErr DefaultDatabaseProvider::create(DatabasePtr& result, const DatabaseInform
     information.getUri(&uri);
     int options;
     information.getOptions(&options);
+    DatabaseProfile profile;
+    information.getProfile(&profile);
     bool read_only = (options & DATABASE_OPTIONS_READONLY) == DATABASE_OPTIONS_READONLY;
-    return Databases_openDatabase(result, uri, read_only);
+    if (!read_only && uri && (options & DATABASE_OPTIONS_POOLED)) {
+        const int num_readers = ConfigOptions_getIntOptionOrDefault("database.pooled-readers", 2);
+        return PooledDatabase_open(result, uri, nullptr, num_readers > 0 ? static_cast<std::size_t>(num_readers) : 0u, profile);
+    }
+    TAKErr code = Databases_openDatabase(result, uri, read_only);
+    TE_CHECKRETURN_CODE(code);
+    // tuning is best effort
+    if (Databases_applyProfile(*result, profile) != TE_Ok)
+        Logger_log(TELL_Warning, "DefaultDatabaseProvider: failed to apply profile to %s", uri ? uri : "temporary database");
+    return code;
 }
 
 TAKErr DefaultDatabaseProvider::getType(const char** value) NOTHROWS {
@@ -0,0 +1,372 @@
+#include "db/PooledDatabase.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "db/Query.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "thread/Thread.h"
+#include "util/Logging2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::DB;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    struct Reader
+    {
+        DatabasePtr db {nullptr, nullptr};
+        /** number of outstanding queries */
+        std::size_t queries {0u};
+    };
+
+    /** the reader connections; shared with the outstanding queries */
+    struct ReaderPool
+    {
+        Mutex mutex;
+        String path;
+        String passphrase;
+        DatabaseProfile profile {TEDP_Default};
+        std::size_t maxReaders {0u};
+        std::vector<std::unique_ptr<Reader>> readers;
+    };
+
+    /** returns the reader to the pool once the query is destroyed */
+    class PooledQuery : public Query
+    {
+    public :
+        PooledQuery(QueryPtr &&impl, const std::shared_ptr<ReaderPool> &pool, Reader &reader) NOTHROWS;
+        ~PooledQuery() NOTHROWS override;
+    public :
+        TAKErr moveToNext() NOTHROWS override;
+    public :
+        TAKErr getColumnIndex(std::size_t *value, const char *columnName) NOTHROWS override;
+        TAKErr getColumnName(const char **value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getColumnCount(std::size_t *value) NOTHROWS override;
+        TAKErr getBlob(const uint8_t **value, std::size_t *len, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getString(const char **value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getInt(int32_t *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getLong(int64_t *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getDouble(double *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr getType(FieldType *value, const std::size_t columnIndex) NOTHROWS override;
+        TAKErr isNull(bool *value, const std::size_t columnIndex) NOTHROWS override;
+    public :
+        TAKErr bindBlob(const std::size_t idx, const uint8_t *blob, const std::size_t size) NOTHROWS override;
+        TAKErr bindInt(const std::size_t idx, const int32_t value) NOTHROWS override;
+        TAKErr bindLong(const std::size_t idx, const int64_t value) NOTHROWS override;
+        TAKErr bindDouble(const std::size_t idx, const double value) NOTHROWS override;
+        TAKErr bindString(const std::size_t idx, const char *value) NOTHROWS override;
+        TAKErr bindNull(const std::size_t idx) NOTHROWS override;
+        TAKErr clearBindings() NOTHROWS override;
+    private :
+        QueryPtr impl;
+        std::shared_ptr<ReaderPool> pool;
+        Reader &reader;
+    };
+
+    class PooledDatabase : public Database2
+    {
+    public :
+        PooledDatabase(DatabasePtr &&writer, const std::shared_ptr<ReaderPool> &pool) NOTHROWS;
+    public :
+        ~PooledDatabase() NOTHROWS override;
+    public :
+        TAKErr execute(const char *sql, const char **args, const std::size_t len) NOTHROWS override;
+        TAKErr query(QueryPtr &query, const char *sql) NOTHROWS override;
+        TAKErr compileStatement(StatementPtr &stmt, const char *sql) NOTHROWS override;
+        TAKErr compileQuery(QueryPtr &query, const char *sql) NOTHROWS override;
+
+        TAKErr isReadOnly(bool *value) NOTHROWS override;
+        TAKErr getVersion(int *value) NOTHROWS override;
+        TAKErr setVersion(const int version) NOTHROWS override;
+
+        TAKErr beginTransaction() NOTHROWS override;
+        TAKErr setTransactionSuccessful() NOTHROWS override;
+        TAKErr endTransaction() NOTHROWS override;
+
+        TAKErr inTransaction(bool *value) NOTHROWS override;
+
+        TAKErr getErrorMessage(String &value) NOTHROWS override;
+    private :
+        /**
+         * Compiles the query on a reader.
+         *
+         * @return  TE_Ok on success; TE_Done if the query should be
+         *          compiled on the writer
+         */
+        TAKErr readerQuery(QueryPtr &value, const char *sql, const bool compile) NOTHROWS;
+    private :
+        DatabasePtr writer;
+        std::shared_ptr<ReaderPool> pool;
+        Mutex transactionMutex;
+        /** the thread that began the current transaction */
+        ThreadID transactionThread;
+        bool transactionOpen;
+    };
+
+    /**
+     * Returns `true` if the SQL is a `SELECT` whose result does not depend
+     * on the connection it executes on.
+     */
+    bool isReadQuery(const char *sql) NOTHROWS;
+}
+
+TAKErr TAK::Engine::DB::PooledDatabase_open(DatabasePtr &db, const char *databaseFilePath, const char *passphrase, const std::size_t numReaders) NOTHROWS
+{
+    return PooledDatabase_open(db, databaseFilePath, passphrase, numReaders, TEDP_Default);
+}
+TAKErr TAK::Engine::DB::PooledDatabase_open(DatabasePtr &db, const char *databaseFilePath, const char *passphrase, const std::size_t numReaders, const DatabaseProfile profile) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    DatabasePtr writer(nullptr, nullptr);
+    code = Databases_openDatabase(writer, databaseFilePath, passphrase, false);
+    TE_CHECKRETURN_CODE(code);
+    // tuning is best effort; the page size must be set prior to entering WAL
+    if (Databases_applyProfile(*writer, profile) != TE_Ok)
+        Logger_log(TELL_Warning, "PooledDatabase: failed to apply profile to %s", databaseFilePath);
+
+    std::shared_ptr<ReaderPool> pool(std::make_shared<ReaderPool>());
+    pool->path = databaseFilePath;
+    pool->passphrase = passphrase;
+    pool->profile = profile;
+
+    // readers may only run concurrently with the writer in WAL mode
+    if (databaseFilePath && numReaders) {
+        QueryPtr journal(nullptr, nullptr);
+        if (writer->query(journal, "PRAGMA journal_mode=WAL") == TE_Ok && journal->moveToNext() == TE_Ok) {
+            const char *mode = nullptr;
+            if (journal->getString(&mode, 0u) == TE_Ok && mode && !String_strcasecmp(mode, "wal"))
+                pool->maxReaders = numReaders;
+        }
+        if (!pool->maxReaders)
+            Logger_log(TELL_Warning, "PooledDatabase: WAL unavailable for %s, readers disabled", databaseFilePath);
+    }
+
+    db = DatabasePtr(new PooledDatabase(std::move(writer), pool), Memory_deleter_const<Database2, PooledDatabase>);
+    return code;
+}
+
+namespace
+{
+    PooledQuery::PooledQuery(QueryPtr &&impl_, const std::shared_ptr<ReaderPool> &pool_, Reader &reader_) NOTHROWS :
+        impl(std::move(impl_)),
+        pool(pool_),
+        reader(reader_)
+    {}
+    PooledQuery::~PooledQuery() NOTHROWS
+    {
+        // finalize the statement before releasing the connection
+        impl.reset();
+
+        Lock lock(pool->mutex);
+        reader.queries--;
+    }
+    TAKErr PooledQuery::moveToNext() NOTHROWS
+    {
+        return impl->moveToNext();
+    }
+    TAKErr PooledQuery::getColumnIndex(std::size_t *value, const char *columnName) NOTHROWS
+    {
+        return impl->getColumnIndex(value, columnName);
+    }
+    TAKErr PooledQuery::getColumnName(const char **value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getColumnName(value, columnIndex);
+    }
+    TAKErr PooledQuery::getColumnCount(std::size_t *value) NOTHROWS
+    {
+        return impl->getColumnCount(value);
+    }
+    TAKErr PooledQuery::getBlob(const uint8_t **value, std::size_t *len, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getBlob(value, len, columnIndex);
+    }
+    TAKErr PooledQuery::getString(const char **value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getString(value, columnIndex);
+    }
+    TAKErr PooledQuery::getInt(int32_t *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getInt(value, columnIndex);
+    }
+    TAKErr PooledQuery::getLong(int64_t *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getLong(value, columnIndex);
+    }
+    TAKErr PooledQuery::getDouble(double *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getDouble(value, columnIndex);
+    }
+    TAKErr PooledQuery::getType(FieldType *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->getType(value, columnIndex);
+    }
+    TAKErr PooledQuery::isNull(bool *value, const std::size_t columnIndex) NOTHROWS
+    {
+        return impl->isNull(value, columnIndex);
+    }
+    TAKErr PooledQuery::bindBlob(const std::size_t idx, const uint8_t *blob, const std::size_t size) NOTHROWS
+    {
+        return impl->bindBlob(idx, blob, size);
+    }
+    TAKErr PooledQuery::bindInt(const std::size_t idx, const int32_t value) NOTHROWS
+    {
+        return impl->bindInt(idx, value);
+    }
+    TAKErr PooledQuery::bindLong(const std::size_t idx, const int64_t value) NOTHROWS
+    {
+        return impl->bindLong(idx, value);
+    }
+    TAKErr PooledQuery::bindDouble(const std::size_t idx, const double value) NOTHROWS
+    {
+        return impl->bindDouble(idx, value);
+    }
+    TAKErr PooledQuery::bindString(const std::size_t idx, const char *value) NOTHROWS
+    {
+        return impl->bindString(idx, value);
+    }
+    TAKErr PooledQuery::bindNull(const std::size_t idx) NOTHROWS
+    {
+        return impl->bindNull(idx);
+    }
+    TAKErr PooledQuery::clearBindings() NOTHROWS
+    {
+        return impl->clearBindings();
+    }
+
+    PooledDatabase::PooledDatabase(DatabasePtr &&writer_, const std::shared_ptr<ReaderPool> &pool_) NOTHROWS :
+        writer(std::move(writer_)),
+        pool(pool_),
+        transactionOpen(false)
+    {}
+    PooledDatabase::~PooledDatabase() NOTHROWS
+    {}
+    TAKErr PooledDatabase::execute(const char *sql, const char **args, const std::size_t len) NOTHROWS
+    {
+        return writer->execute(sql, args, len);
+    }
+    TAKErr PooledDatabase::query(QueryPtr &value, const char *sql) NOTHROWS
+    {
+        if (readerQuery(value, sql, false) == TE_Ok)
+            return TE_Ok;
+        return writer->query(value, sql);
+    }
+    TAKErr PooledDatabase::compileStatement(StatementPtr &stmt, const char *sql) NOTHROWS
+    {
+        return writer->compileStatement(stmt, sql);
+    }
+    TAKErr PooledDatabase::compileQuery(QueryPtr &value, const char *sql) NOTHROWS
+    {
+        if (readerQuery(value, sql, true) == TE_Ok)
+            return TE_Ok;
+        return writer->compileQuery(value, sql);
+    }
+    TAKErr PooledDatabase::isReadOnly(bool *value) NOTHROWS
+    {
+        return writer->isReadOnly(value);
+    }
+    TAKErr PooledDatabase::getVersion(int *value) NOTHROWS
+    {
+        return writer->getVersion(value);
+    }
+    TAKErr PooledDatabase::setVersion(const int version) NOTHROWS
+    {
+        return writer->setVersion(version);
+    }
+    TAKErr PooledDatabase::beginTransaction() NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = writer->beginTransaction();
+        TE_CHECKRETURN_CODE(code);
+
+        Lock lock(transactionMutex);
+        transactionThread = Thread_currentThreadID();
+        transactionOpen = true;
+        return code;
+    }
+    TAKErr PooledDatabase::setTransactionSuccessful() NOTHROWS
+    {
+        return writer->setTransactionSuccessful();
+    }
+    TAKErr PooledDatabase::endTransaction() NOTHROWS
+    {
+        {
+            Lock lock(transactionMutex);
+            transactionOpen = false;
+        }
+        return writer->endTransaction();
+    }
+    TAKErr PooledDatabase::inTransaction(bool *value) NOTHROWS
+    {
+        return writer->inTransaction(value);
+    }
+    TAKErr PooledDatabase::getErrorMessage(String &value) NOTHROWS
+    {
+        return writer->getErrorMessage(value);
+    }
+    TAKErr PooledDatabase::readerQuery(QueryPtr &value, const char *sql, const bool compile) NOTHROWS
+    {
+        if (!pool->maxReaders || !isReadQuery(sql))
+            return TE_Done;
+        {
+            // the transaction's own reads must observe its uncommitted writes
+            Lock lock(transactionMutex);
+            if (transactionOpen && transactionThread == Thread_currentThreadID())
+                return TE_Done;
+        }
+
+        Reader *reader = nullptr;
+        {
+            Lock lock(pool->mutex);
+            for (auto &r : pool->readers) {
+                if (!reader || r->queries < reader->queries)
+                    reader = r.get();
+            }
+            if ((!reader || reader->queries) && pool->readers.size() < pool->maxReaders) {
+                std::unique_ptr<Reader> opened(new Reader());
+                if (Databases_openDatabase(opened->db, pool->path, pool->passphrase, true) == TE_Ok) {
+                    Databases_applyProfile(*opened->db, pool->profile);
+                    reader = opened.get();
+                    pool->readers.push_back(std::move(opened));
+                } else if (pool->readers.empty()) {
+                    // the file may not exist yet; retry on a later query
+                    return TE_Done;
+                }
+            }
+            reader->queries++;
+        }
+
+        QueryPtr impl(nullptr, nullptr);
+        const TAKErr code = compile ? reader->db->compileQuery(impl, sql) : reader->db->query(impl, sql);
+        if (code != TE_Ok) {
+            Lock lock(pool->mutex);
+            reader->queries--;
+            return TE_Done;
+        }
+        value = QueryPtr(new PooledQuery(std::move(impl), pool, *reader), Memory_deleter_const<Query, PooledQuery>);
+        return TE_Ok;
+    }
+
+    bool isReadQuery(const char *sql) NOTHROWS
+    {
+        if (!sql)
+            return false;
+        std::string s(sql);
+        for (auto &c : s)
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        const std::size_t start = s.find_first_not_of(" \t\r\n(");
+        if (start == std::string::npos || s.compare(start, 6u, "select") != 0)
+            return false;
+        if (s.size() > start + 6u && (isalnum(static_cast<unsigned char>(s[start + 6u])) || s[start + 6u] == '_'))
+            return false;
+        // results that are local to the connection
+        return s.find("last_insert_rowid") == std::string::npos &&
+            s.find("changes(") == std::string::npos;
+    }
+}
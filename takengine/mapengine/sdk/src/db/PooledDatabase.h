@@ -0,0 +1,48 @@
+#ifndef TAK_ENGINE_DB_POOLEDDATABASE_H_INCLUDED
+#define TAK_ENGINE_DB_POOLEDDATABASE_H_INCLUDED
+
+#include <cstddef>
+
+#include "db/Database2.h"
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace DB {
+            /**
+             * Opens a database with a single writer connection plus a pool
+             * of up to `numReaders` read-only connections. The database is
+             * placed in WAL mode so readers do not block on, nor are
+             * blocked by, the writer.
+             *
+             * <P>`SELECT` queries are routed to the least busy reader,
+             * opening readers on demand. All other statements, transactions
+             * and queries issued by the thread that owns the current
+             * transaction are bound to the writer. Readers observe the most
+             * recently committed state of the database.
+             *
+             * <P>If the database cannot be placed in WAL mode (e.g. a
+             * temporary database), all access goes through the writer.
+             *
+             * @param db                Returns the database
+             * @param databaseFilePath  The path to the database file
+             * @param passphrase        The passphrase as a C-string,
+             *                          `nullptr` if no passphrase
+             * @param numReaders        The maximum number of reader
+             *                          connections
+             */
+            ENGINE_API Util::TAKErr PooledDatabase_open(DatabasePtr &db, const char *databaseFilePath, const char *passphrase, const std::size_t numReaders) NOTHROWS;
+            /**
+             * Opens a pooled database, applying the tuning profile to the
+             * writer and each reader connection.
+             *
+             * @param profile           The tuning profile, see
+             *                          Databases_applyProfile
+             */
+            ENGINE_API Util::TAKErr PooledDatabase_open(DatabasePtr &db, const char *databaseFilePath, const char *passphrase, const std::size_t numReaders, const DatabaseProfile profile) NOTHROWS;
+        }
+    }
+}
+
+#endif
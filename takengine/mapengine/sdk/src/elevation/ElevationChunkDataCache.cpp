@@ -0,0 +1,198 @@
+#include "elevation/ElevationChunkDataCache.h"
+
+#include "util/ConfigOptions.h"
+
+using namespace TAK::Engine::Elevation;
+
+using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    const VertexAttribute vertexAttributes[] =
+    {
+        TEVA_Position,
+        TEVA_Normal,
+        TEVA_Color,
+        TEVA_TexCoord0,
+        TEVA_TexCoord1,
+        TEVA_TexCoord2,
+        TEVA_TexCoord3,
+        TEVA_TexCoord4,
+        TEVA_TexCoord5,
+        TEVA_TexCoord6,
+        TEVA_TexCoord7,
+    };
+
+    std::size_t sizeOf(const ElevationChunk::Data &data) NOTHROWS
+    {
+        if (!data.value)
+            return 0u;
+        const Mesh &mesh = *data.value;
+        const VertexDataLayout &layout = mesh.getVertexDataLayout();
+        std::size_t size = 0u;
+        if (layout.interleaved) {
+            VertexDataLayout_requiredInterleavedDataSize(&size, layout, mesh.getNumVertices());
+        } else {
+            for (std::size_t i = 0u; i < sizeof(vertexAttributes) / sizeof(VertexAttribute); i++) {
+                if (!(layout.attributes & vertexAttributes[i]))
+                    continue;
+                std::size_t attrSize = 0u;
+                if (VertexDataLayout_requiredDataSize(&attrSize, layout, vertexAttributes[i], mesh.getNumVertices()) == TE_Ok)
+                    size += attrSize;
+            }
+        }
+        DataType indexType;
+        if (mesh.isIndexed() && mesh.getIndexType(&indexType) == TE_Ok)
+            size += mesh.getNumIndices() * DataType_size(indexType);
+        return size;
+    }
+}
+
+ElevationChunkDataCache::ElevationChunkDataCache(const std::size_t maxSize_) NOTHROWS :
+    maxSize(maxSize_),
+    size(0u)
+{}
+
+ElevationChunkDataCache::~ElevationChunkDataCache() NOTHROWS
+{}
+
+TAKErr ElevationChunkDataCache::acquire(std::shared_ptr<const ElevationChunk::Data> &value, const char *uri) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!uri)
+        return TE_InvalidArg;
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    const std::string key(uri);
+    while (true) {
+        auto entry = entries.find(key);
+        if (entry == entries.end()) {
+            // caller is responsible for the load
+            Entry pending;
+            pending.size = 0u;
+            pending.pending = true;
+            pending.order = order.end();
+            entries.insert(EntryMap::value_type(key, pending));
+            return TE_Done;
+        }
+        if (entry->second.pending) {
+            code = lock.wait();
+            TE_CHECKRETURN_CODE(code);
+            continue;
+        }
+        // move to most recently used
+        order.splice(order.end(), order, entry->second.order);
+        value = entry->second.data;
+        return TE_Ok;
+    }
+}
+
+void ElevationChunkDataCache::put(const char *uri, const std::shared_ptr<const ElevationChunk::Data> &data) NOTHROWS
+{
+    if (!uri)
+        return;
+    Monitor::Lock lock(monitor);
+    auto entry = entries.find(uri);
+    if (entry == entries.end() || !entry->second.pending)
+        return;
+
+    const std::size_t dataSize = data ? sizeOf(*data) : 0u;
+    if (!data || (dataSize > maxSize && !pins.count(entry->first))) {
+        entries.erase(entry);
+    } else {
+        entry->second.data = data;
+        entry->second.size = dataSize;
+        entry->second.pending = false;
+        entry->second.order = order.insert(order.end(), entry->first);
+        size += dataSize;
+        trimLocked();
+    }
+    lock.broadcast();
+}
+
+void ElevationChunkDataCache::abandon(const char *uri) NOTHROWS
+{
+    if (!uri)
+        return;
+    Monitor::Lock lock(monitor);
+    auto entry = entries.find(uri);
+    if (entry == entries.end() || !entry->second.pending)
+        return;
+    entries.erase(entry);
+    lock.broadcast();
+}
+
+void ElevationChunkDataCache::pin(const char *uri) NOTHROWS
+{
+    if (!uri)
+        return;
+    Monitor::Lock lock(monitor);
+    pins[uri]++;
+}
+
+void ElevationChunkDataCache::unpin(const char *uri) NOTHROWS
+{
+    if (!uri)
+        return;
+    Monitor::Lock lock(monitor);
+    auto pin = pins.find(uri);
+    if (pin == pins.end())
+        return;
+    if (--pin->second)
+        return;
+    pins.erase(pin);
+    // data retained only by the pin may now be in excess of the budget
+    trimLocked();
+}
+
+void ElevationChunkDataCache::clear() NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    auto it = order.begin();
+    while (it != order.end()) {
+        const std::string &uri = *it++;
+        if (!pins.count(uri))
+            eraseLocked(entries.find(uri));
+    }
+}
+
+std::size_t ElevationChunkDataCache::getSize() const NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    return size;
+}
+
+std::size_t ElevationChunkDataCache::getMaxSize() const NOTHROWS
+{
+    return maxSize;
+}
+
+void ElevationChunkDataCache::trimLocked() NOTHROWS
+{
+    auto it = order.begin();
+    while (size > maxSize && it != order.end()) {
+        const std::string &uri = *it++;
+        if (!pins.count(uri))
+            eraseLocked(entries.find(uri));
+    }
+}
+
+void ElevationChunkDataCache::eraseLocked(EntryMap::iterator entry) NOTHROWS
+{
+    size -= entry->second.size;
+    if (entry->second.order != order.end())
+        order.erase(entry->second.order);
+    entries.erase(entry);
+}
+
+ElevationChunkDataCache &TAK::Engine::Elevation::ElevationChunkDataCache_get() NOTHROWS
+{
+    static ElevationChunkDataCache cache(
+        (std::size_t)ConfigOptions_getIntOptionOrDefault("elevation.chunk-data-cache-size", 64 * 1024 * 1024));
+    return cache;
+}
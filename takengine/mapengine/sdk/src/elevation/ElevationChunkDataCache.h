@@ -0,0 +1,115 @@
+#ifndef TAK_ENGINE_ELEVATION_ELEVATIONCHUNKDATACACHE_H_INCLUDED
+#define TAK_ENGINE_ELEVATION_ELEVATIONCHUNKDATACACHE_H_INCLUDED
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "elevation/ElevationChunk.h"
+#include "port/Platform.h"
+#include "thread/Monitor.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Elevation {
+            /**
+             * Cache of loaded elevation chunk data, shared by all chunks
+             * with the same URI. Data is retained within a byte budget and
+             * evicted least recently used first.
+             *
+             * <P>Only one load is performed for concurrent requests of the
+             * same chunk: the first requester is directed to load the data
+             * and publish it via `put`, or to `abandon` it on failure;
+             * subsequent requesters block until the data is published or
+             * abandoned.
+             *
+             * <P>Pinned data, such as the chunks covering the current view,
+             * is never evicted and may cause the cache to exceed its
+             * budget.
+             *
+             * <P>This class is thread-safe.
+             */
+            class ENGINE_API ElevationChunkDataCache
+            {
+            public :
+                /**
+                 * @param maxSize   The maximum bytes of unpinned data
+                 *                  retained
+                 */
+                ElevationChunkDataCache(const std::size_t maxSize) NOTHROWS;
+                ~ElevationChunkDataCache() NOTHROWS;
+            private :
+                ElevationChunkDataCache(const ElevationChunkDataCache &) NOTHROWS;
+            public :
+                /**
+                 * Obtains the data for the chunk with the specified URI.
+                 *
+                 * @return  TE_Ok if the data was cached or loaded by a
+                 *          concurrent request; TE_Done if the caller must
+                 *          load the data and subsequently invoke `put` or
+                 *          `abandon` with the same URI
+                 */
+                Util::TAKErr acquire(std::shared_ptr<const ElevationChunk::Data> &value, const char *uri) NOTHROWS;
+                /**
+                 * Publishes the data loaded following a call to `acquire`
+                 * that returned TE_Done.
+                 */
+                void put(const char *uri, const std::shared_ptr<const ElevationChunk::Data> &data) NOTHROWS;
+                /**
+                 * Signals that the data could not be loaded following a
+                 * call to `acquire` that returned TE_Done. A blocked
+                 * requester will be directed to load the data.
+                 */
+                void abandon(const char *uri) NOTHROWS;
+                /**
+                 * Pins the data for the chunk with the specified URI,
+                 * exempting it from eviction until a matching call to
+                 * `unpin`. Pins are counted and may be placed before the
+                 * data is loaded.
+                 */
+                void pin(const char *uri) NOTHROWS;
+                void unpin(const char *uri) NOTHROWS;
+                /**
+                 * Releases all retained, unpinned data. In-progress loads
+                 * are unaffected.
+                 */
+                void clear() NOTHROWS;
+                /** returns the bytes of data retained, including pinned data */
+                std::size_t getSize() const NOTHROWS;
+                std::size_t getMaxSize() const NOTHROWS;
+            private :
+                struct Entry
+                {
+                    std::shared_ptr<const ElevationChunk::Data> data;
+                    std::size_t size;
+                    bool pending;
+                    std::list<std::string>::iterator order;
+                };
+                typedef std::map<std::string, Entry> EntryMap;
+            private :
+                /** evicts unpinned data in excess of the budget */
+                void trimLocked() NOTHROWS;
+                void eraseLocked(EntryMap::iterator entry) NOTHROWS;
+            private :
+                const std::size_t maxSize;
+                std::size_t size;
+                EntryMap entries;
+                /** retained URIs, least recently used first */
+                std::list<std::string> order;
+                std::map<std::string, std::size_t> pins;
+                mutable Thread::Monitor monitor;
+            };
+
+            /**
+             * Returns the process-wide chunk data cache. The budget is
+             * specified by the "elevation.chunk-data-cache-size" (bytes)
+             * config option; a budget of zero disables the cache.
+             */
+            ENGINE_API ElevationChunkDataCache &ElevationChunkDataCache_get() NOTHROWS;
+        }
+    }
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "core/GeoPoint2.h"
 #include "core/Projection2.h"
 #include "core/ProjectionFactory3.h"
+#include "elevation/ElevationChunkDataCache.h"
 #include "math/GeometryModel2.h"
 #include "math/Mesh.h"
 #include "model/MeshBuilder.h"
@@ -61,11 +62,18 @@ namespace
     public :
         TAKErr createData(ElevationChunkDataPtr &value) NOTHROWS override;
         TAKErr sample(double *value, const double latitude, const double longitude) NOTHROWS override;
+    private :
+        /**
+         * Obtains the loaded data, via the shared chunk data cache if
+         * enabled
+         */
+        TAKErr loadData(std::shared_ptr<const ElevationChunk::Data> &value) NOTHROWS;
     private :
         DataLoaderPtr data_loader_;
-        ElevationChunkDataPtr data_;
-        GeometryModel2Ptr geom_model_;
+        /** retained only if the shared chunk data cache is disabled */
+        std::shared_ptr<const ElevationChunk::Data> data_;
         Projection2Ptr proj_;
+        bool proj_init_;
         Mutex mutex_;
     };
 
@@ -187,42 +195,91 @@ namespace
     DataElevationChunk::DataElevationChunk(const char *type, const char *uri, const unsigned int flags, const double resolution, const Polygon2 &bounds, const double ce, const double le, const bool authoritative, DataLoaderPtr &&dataLoader) NOTHROWS :
         AbstractElevationChunk(type, uri, flags, resolution, bounds, ce, le, authoritative),
         data_loader_(std::move(dataLoader)),
-        data_(nullptr, nullptr),
-        geom_model_(nullptr, nullptr),
-        proj_(nullptr, nullptr)
+        proj_(nullptr, nullptr),
+        proj_init_(false)
     {}
     TAKErr DataElevationChunk::createData(ElevationChunkDataPtr &value) NOTHROWS
     {
-        return data_loader_->createData(value);
+        TAKErr code(TE_Ok);
+        std::shared_ptr<const ElevationChunk::Data> data;
+        code = loadData(data);
+        TE_CHECKRETURN_CODE(code);
+        if (!data->value.get())
+            return TE_Err;
+
+        // the loaded data is shared; the caller receives a copy
+        value = ElevationChunkDataPtr(new ElevationChunk::Data(), Memory_deleter_const<ElevationChunk::Data>);
+        MeshPtr copy(nullptr, nullptr);
+        code = Mesh_transform(copy, *data->value, data->value->getVertexDataLayout());
+        TE_CHECKRETURN_CODE(code);
+
+        value->value = std::move(copy);
+        value->srid = data->srid;
+        value->interpolated = data->interpolated;
+        value->localFrame.set(data->localFrame);
+
+        return code;
+    }
+    TAKErr DataElevationChunk::loadData(std::shared_ptr<const ElevationChunk::Data> &value) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        ElevationChunkDataCache &cache = ElevationChunkDataCache_get();
+        const char *uri = this->getUri();
+        if (!cache.getMaxSize() || !uri || !*uri) {
+            Lock lock(mutex_);
+            code = lock.status;
+            TE_CHECKRETURN_CODE(code);
+            if (!this->data_.get()) {
+                ElevationChunkDataPtr loaded(nullptr, nullptr);
+                code = data_loader_->createData(loaded);
+                TE_CHECKRETURN_CODE(code);
+                if (!loaded.get())
+                    return TE_Err;
+                this->data_ = std::move(loaded);
+            }
+            value = this->data_;
+            return code;
+        }
+
+        code = cache.acquire(value, uri);
+        if (code != TE_Done)
+            return code;
+
+        ElevationChunkDataPtr loaded(nullptr, nullptr);
+        code = data_loader_->createData(loaded);
+        if (code != TE_Ok || !loaded.get()) {
+            cache.abandon(uri);
+            return (code != TE_Ok) ? code : TE_Err;
+        }
+        value = std::move(loaded);
+        cache.put(uri, value);
+        return TE_Ok;
     }
     TAKErr DataElevationChunk::sample(double *value, const double latitude, const double longitude) NOTHROWS
     {
         TAKErr code(TE_Ok);
+        std::shared_ptr<const ElevationChunk::Data> data;
+        code = loadData(data);
+        TE_CHECKRETURN_CODE(code);
+        if (!data->value.get())
+            return TE_Err;
         {
             Lock lock(mutex_);
             code = lock.status;
             TE_CHECKRETURN_CODE(code);
 
-            if (!this->geom_model_.get()) {
-                // initialize data if necessary
-                if (!this->data_.get()) {
-                    code = this->createData(this->data_);
-                    TE_CHECKRETURN_CODE(code);
-                }
-                if (!data_.get() || !data_->value.get())
-                    return TE_Err;
-                // initialize projection if necessary
-                if (data_->srid != 4326 && ProjectionFactory3_create(this->proj_, data_->srid) != TE_Ok)
-                    return TE_Err;
-
-                //this->geomModel = Models.createGeometryModel(data.value, data.localFrame);
-                this->geom_model_ = GeometryModel2Ptr(new TAK::Engine::Math::Mesh(data_->value, &data_->localFrame), Memory_deleter_const<GeometryModel2, TAK::Engine::Math::Mesh>);
-                if (!this->geom_model_.get())
+            // initialize projection if necessary
+            if (!proj_init_) {
+                if (data->srid != 4326 && ProjectionFactory3_create(this->proj_, data->srid) != TE_Ok)
                     return TE_Err;
+                proj_init_ = true;
             }
-
         }
 
+        // the geometry model only references the shared data; it is
+        // constructed per sample so that evicted data is released
+        const TAK::Engine::Math::Mesh geomModel(data->value, &data->localFrame);
+
         TAK::Engine::Math::Point2<double> rayOrg;
         TAK::Engine::Math::Point2<double> rayTgt;
         if (this->proj_.get()) {
@@ -236,7 +293,7 @@ namespace
         }
 
         TAK::Engine::Math::Point2<double> isect;
-        if (!this->geom_model_->intersect(&isect, Ray2<double>(rayOrg, Vector4<double>(rayTgt.x - rayOrg.x, rayTgt.y - rayOrg.y, rayTgt.z - rayOrg.z)))) {
+        if (!geomModel.intersect(&isect, Ray2<double>(rayOrg, Vector4<double>(rayTgt.x - rayOrg.x, rayTgt.y - rayOrg.y, rayTgt.z - rayOrg.z)))) {
             *value = NAN;
             return TE_InvalidArg;
         }
@@ -403,8 +460,6 @@ namespace
                 // XXX - break on errors here???
                 if (source.sample(el, lat, lng) != TE_Ok)
                     code = TE_Done; // failed to fill atleast one sample
-                if (value)
-                    *value = isnan(*el);
             }
         }
         TE_CHECKRETURN_CODE(code);
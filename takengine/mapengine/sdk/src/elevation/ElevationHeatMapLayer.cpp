@@ -5,6 +5,7 @@
 using namespace TAK::Engine::Elevation;
 
 using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
@@ -98,6 +99,27 @@ TAKErr ElevationHeatMapLayer::getAbsoluteRange(double* min, double* max) const N
     *max = max_el_;
     return TE_Ok;
 }
+TAKErr ElevationHeatMapLayer::setColorRamp(const uint32_t *argb, const std::size_t count) NOTHROWS
+{
+    if (!argb && count)
+        return TE_InvalidArg;
+    Lock lock(mutex_);
+    TE_CHECKRETURN_CODE(lock.status);
+    color_ramp_.assign(argb, argb + count);
+    dispatchColorRampChanged();
+    return TE_Ok;
+}
+TAKErr ElevationHeatMapLayer::getColorRamp(Collection<uint32_t> &value) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    Lock lock(mutex_);
+    TE_CHECKRETURN_CODE(lock.status);
+    for (auto color : color_ramp_) {
+        code = value.add(color);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
 TAKErr ElevationHeatMapLayer::addListener(HeatMapListener &l) NOTHROWS
 {
     Lock lock(mutex_);
@@ -139,6 +161,20 @@ void ElevationHeatMapLayer::dispatchRangeChanged() NOTHROWS
             it++;
     }
 }
+void ElevationHeatMapLayer::dispatchColorRampChanged() NOTHROWS
+{
+    auto it = listeners_.begin();
+    while (it != listeners_.end()) {
+        if ((*it)->onColorRampChanged(*this, color_ramp_.data(), color_ramp_.size()) == TE_Done)
+            it = listeners_.erase(it);
+        else
+            it++;
+    }
+}
 
 ElevationHeatMapLayer::HeatMapListener::~HeatMapListener() NOTHROWS
 {}
+TAKErr ElevationHeatMapLayer::HeatMapListener::onColorRampChanged(const ElevationHeatMapLayer&, const uint32_t *, const std::size_t) NOTHROWS
+{
+    return TE_Ok;
+}
@@ -1,7 +1,10 @@
 #ifndef TAK_ENGINE_ELEVATION_ELEVATIONHEATMAPLAYER_H_INCLUDED
 #define TAK_ENGINE_ELEVATION_ELEVATIONHEATMAPLAYER_H_INCLUDED
 
+#include <vector>
+
 #include "core/AbstractLayer2.h"
+#include "port/Collection.h"
 #include "port/Platform.h"
 #include "util/Error.h"
 
@@ -26,17 +29,32 @@ namespace TAK {
                 Util::TAKErr setAbsoluteRange(const double min, const double max) NOTHROWS;
                 bool isDynamicRange() const NOTHROWS;
                 Util::TAKErr getAbsoluteRange(double* min, double* max) const NOTHROWS;
+                /**
+                 * Sets the colors, packed ARGB, that elevations are mapped to,
+                 * from the minimum to the maximum of the range. Colors are
+                 * evenly spaced and linearly interpolated. Specifying no
+                 * colors restores the default hue ramp, derived from the
+                 * saturation and value.
+                 */
+                Util::TAKErr setColorRamp(const uint32_t *argb, const std::size_t count) NOTHROWS;
+                /**
+                 * Returns the colors of the ramp; empty if the default hue
+                 * ramp is in use.
+                 */
+                Util::TAKErr getColorRamp(Port::Collection<uint32_t> &value) const NOTHROWS;
                 Util::TAKErr addListener(HeatMapListener &l) NOTHROWS;
                 Util::TAKErr removeListener(const HeatMapListener &l) NOTHROWS;
             private :
                 void dispatchColorChanged() NOTHROWS;
                 void dispatchRangeChanged() NOTHROWS;
+                void dispatchColorRampChanged() NOTHROWS;
             private :
                 float saturation_;
                 float value_;
                 float alpha_;
                 double min_el_;
                 double max_el_;
+                std::vector<uint32_t> color_ramp_;
                 std::set<HeatMapListener *> listeners_;
             };
 
@@ -47,6 +65,11 @@ namespace TAK {
             public :
                 virtual Util::TAKErr onColorChanged(const ElevationHeatMapLayer& subject, const float saturation, const float value, const float alpha) NOTHROWS = 0;
                 virtual Util::TAKErr onRangeChanged(const ElevationHeatMapLayer& subject, const double minEl, const double maxEl, const bool dynamicRange) NOTHROWS = 0;
+                /**
+                 * Invoked when the color ramp changes. `count` is `0` if the
+                 * default hue ramp is in use.
+                 */
+                virtual Util::TAKErr onColorRampChanged(const ElevationHeatMapLayer& subject, const uint32_t *argb, const std::size_t count) NOTHROWS;
             };
         }
     }
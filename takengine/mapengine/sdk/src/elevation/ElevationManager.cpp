@@ -1,6 +1,8 @@
 #include "elevation/ElevationManager.h"
 
+#include <algorithm>
 #include <list>
+#include <vector>
 
 #include "elevation/ElevationSourceManager.h"
 #include "elevation/MultiplexingElevationChunkCursor.h"
@@ -100,6 +102,11 @@ namespace
         bool dirty;
     } GeoidContext;
 
+    /** must be invoked while holding `GeoidContext.mutex` */
+    void validateGeoid() NOTHROWS;
+    /** must be invoked while holding `GeoidContext.mutex` */
+    TAKErr getGeoidHeight(double *height, const double latitude, const double longitude) NOTHROWS;
+
     class MosaicDbStub : public ElevationSource
     {
     public:
@@ -388,6 +395,9 @@ TAKErr TAK::Engine::Elevation::ElevationManager_getElevation(double *value, Port
 
     ElevationSource::QueryParameters filter(filter_);
     filter.spatialFilter = TAK::Engine::Feature::Geometry2Ptr(new TAK::Engine::Feature::Point2(longitude, latitude), Memory_deleter_const<TAK::Engine::Feature::Geometry2, TAK::Engine::Feature::Point2>);
+    // the highest priority chunk will typically satisfy the point
+    if(!filter.limitHint)
+        filter.limitHint = 1u;
 
     ElevationChunkCursorPtr result(nullptr, nullptr);
     code = ElevationManager_queryElevationSources(result, filter);
@@ -594,6 +604,25 @@ TAKErr TAK::Engine::Elevation::ElevationManager_getElevation(double *value, cons
     for(std::size_t i = 0u; i < count; i++)
         value[i*dstStride] = NAN;
 
+    // points not yet filled, ordered by longitude so that the points within
+    // the bounds of each chunk may be found by binary search
+    std::vector<std::size_t> pending;
+    pending.reserve(count);
+    for (std::size_t i = 0u; i < count; i++) {
+        if (!isnan(srcLat[i*srcLatStride]) && !isnan(srcLng[i*srcLngStride]))
+            pending.push_back(i);
+    }
+    std::sort(pending.begin(), pending.end(), [srcLng, srcLngStride](const std::size_t a, const std::size_t b)
+    {
+        return srcLng[a*srcLngStride] < srcLng[b*srcLngStride];
+    });
+
+    std::vector<std::size_t> binned;
+    std::vector<double> binLat;
+    std::vector<double> binLng;
+    std::vector<double> binEl;
+    // chunks are visited in priority order; each fills the holes left by
+    // the chunks before it
     do {
         code = result->moveToNext();
         TE_CHECKBREAK_CODE(code);
@@ -601,7 +630,54 @@ TAKErr TAK::Engine::Elevation::ElevationManager_getElevation(double *value, cons
         ElevationChunkPtr data(nullptr, nullptr);
         if(result->get(data) != TE_Ok)
             continue;
-        if(data->sample(value, count, srcLat, srcLng, srcLatStride, srcLngStride, dstStride) == TE_Ok)
+        const TAK::Engine::Feature::Polygon2 *bounds = data->getBounds();
+        TAK::Engine::Feature::Envelope2 mbr;
+        if (!bounds || bounds->getEnvelope(&mbr) != TE_Ok)
+            continue;
+
+        // bin the pending points that fall within the chunk's bounds
+        auto first = std::lower_bound(pending.begin(), pending.end(), mbr.minX, [srcLng, srcLngStride](const std::size_t idx, const double lng)
+        {
+            return srcLng[idx*srcLngStride] < lng;
+        });
+        auto last = std::upper_bound(first, pending.end(), mbr.maxX, [srcLng, srcLngStride](const double lng, const std::size_t idx)
+        {
+            return lng < srcLng[idx*srcLngStride];
+        });
+        binned.clear();
+        binLat.clear();
+        binLng.clear();
+        for (auto it = first; it != last; it++) {
+            const double lat = srcLat[(*it)*srcLatStride];
+            if (lat < mbr.minY || lat > mbr.maxY)
+                continue;
+            binned.push_back(*it);
+            binLat.push_back(lat);
+            binLng.push_back(srcLng[(*it)*srcLngStride]);
+        }
+        if (binned.empty())
+            continue;
+
+        // sample the bin as a single batch
+        binEl.assign(binned.size(), NAN);
+        data->sample(&binEl.at(0), binned.size(), &binLat.at(0), &binLng.at(0), 1u, 1u, 1u);
+
+        bool filled = false;
+        for (std::size_t i = 0u; i < binned.size(); i++) {
+            if (isnan(binEl[i]))
+                continue;
+            value[binned[i]*dstStride] = binEl[i];
+            filled = true;
+        }
+        if (!filled)
+            continue;
+
+        // retire the filled points, preserving order
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [value, dstStride](const std::size_t idx)
+        {
+            return !isnan(value[idx*dstStride]);
+        }), pending.end());
+        if (pending.empty())
             return TE_Ok;
     } while(true);
 
@@ -657,14 +733,45 @@ Util::TAKErr TAK::Engine::Elevation::ElevationManager_unregisterDataSpi(std::sha
 
 Util::TAKErr TAK::Engine::Elevation::ElevationManager_getGeoidHeight(double *height, const double latitude, const double longitude) NOTHROWS
 {
-    do {
-        TAKErr code(TE_Ok);
-        Lock lock(GeoidContext.mutex);
-        code = lock.status;
-        TE_CHECKBREAK_CODE(code);
-        if(GeoidContext.dirty) {
-            GeoidContext.dirty = false;
+    TAKErr code(TE_Ok);
+    if(!height)
+        return TE_InvalidArg;
+    Lock lock(GeoidContext.mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    validateGeoid();
+    return getGeoidHeight(height, latitude, longitude);
+}
+Util::TAKErr TAK::Engine::Elevation::ElevationManager_getGeoidHeight(double *value, const std::size_t count, const double *srcLat, const double *srcLng, const std::size_t srcLatStride, const std::size_t srcLngStride, const std::size_t dstStride) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if(!value || !srcLat || !srcLng)
+        return TE_InvalidArg;
+    Lock lock(GeoidContext.mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    validateGeoid();
+
+    bool done = false;
+    for(std::size_t i = 0u; i < count; i++) {
+        double &height = value[i*dstStride];
+        if(getGeoidHeight(&height, srcLat[i*srcLatStride], srcLng[i*srcLngStride]) != TE_Ok || isnan(height)) {
+            height = NAN;
+            done = true;
+        }
+    }
+    return done ? TE_Done : TE_Ok;
+}
 
+namespace
+{
+    void validateGeoid() NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if(!GeoidContext.dirty)
+            return;
+        GeoidContext.dirty = false;
+        do {
             // initialize from the EGM96 file
             TAK::Engine::Port::String egmFilePath;
             code = ConfigOptions_getOption(egmFilePath, "egm96-file");
@@ -690,37 +797,33 @@ Util::TAKErr TAK::Engine::Elevation::ElevationManager_getGeoidHeight(double *hei
                 break;
             }
 
-            array_ptr<uint8_t> egmData(new uint8_t[(std::size_t)fileLen]);
-
-            FileInput2 file;
-            code = file.open(egmFilePath);
+            // the grid is copied by `EGM96::open`; map rather than stage
+            // through an intermediate buffer
+            MappedFileInput2 file;
+            code = file.open(egmFilePath, TEMA_Sequential);
             TE_CHECKBREAK_CODE(code);
-            std::size_t egmDataLen;
-            code = file.read(egmData.get(), &egmDataLen, (std::size_t)fileLen);
+            const uint8_t *egmData;
+            code = file.getData(&egmData);
             TE_CHECKBREAK_CODE(code);
 
             std::unique_ptr<EGM96> egm96(new EGM96());
-            code = egm96->open(egmData.get(), egmDataLen);
+            code = egm96->open(egmData, (std::size_t)file.length());
             TE_CHECKBREAK_CODE(code);
 
             GeoidContext.egm96 = std::move(egm96);
-        }
-        if(GeoidContext.egm96.get()) {
-            code = GeoidContext.egm96->getHeight(height, GeoPoint2(latitude, longitude));
-            TE_CHECKBREAK_CODE(code);
-
-            return code;
-        }
-    } while(false);
+        } while(false);
+    }
+    TAKErr getGeoidHeight(double *height, const double latitude, const double longitude) NOTHROWS
+    {
+        if(GeoidContext.egm96.get() && GeoidContext.egm96->getHeight(height, GeoPoint2(latitude, longitude)) == TE_Ok)
+            return TE_Ok;
 
-    // drop through to WMM EGM96 dataset
-    if(MAG_GetGeoidHeight(latitude, longitude, height, &GeoidContext.geomag.geoid) != TRUE)
-      return Util::TE_InvalidArg;
-    return TE_Ok;
-}
+        // drop through to WMM EGM96 dataset
+        if(MAG_GetGeoidHeight(latitude, longitude, height, &GeoidContext.geomag.geoid) != TRUE)
+            return Util::TE_InvalidArg;
+        return TE_Ok;
+    }
 
-namespace
-{
     ElevationModelFilter::ElevationModelFilter(int model_) NOTHROWS :
         model(model_)
     {}
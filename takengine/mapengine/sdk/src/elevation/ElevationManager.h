@@ -121,6 +121,14 @@ namespace TAK {
                     const ElevationManagerQueryParameters &filter,
                     const ElevationData::Hints &hint) NOTHROWS;
 
+            /**
+             * Returns elevation values for a batch of points. A single query is
+             * issued for the bounds of all points; each chunk, in priority
+             * order, is sampled once for the unfilled points within its bounds.
+             *
+             * @return  TE_Ok if all values were filled, TE_Done if one or more
+             *          values are <code>NaN</code>
+             */
             ENGINE_API Util::TAKErr ElevationManager_getElevation(double *value, const std::size_t count, const double *srcLat, const double *srcLng, const std::size_t srcLatStride, const std::size_t srcLngStride, const std::size_t dstStride, const ElevationSource::QueryParameters &filter) NOTHROWS;
 
             /**
@@ -130,6 +138,14 @@ namespace TAK {
                     double *height,
                     const double latitude,
                     const double longitude) NOTHROWS;
+            /**
+             * Returns the Geoid height for a batch of points, acquiring the
+             * geoid model once for all points.
+             *
+             * @return  TE_Ok if all values were filled, TE_Done if one or more
+             *          values are <code>NaN</code>
+             */
+            ENGINE_API Util::TAKErr ElevationManager_getGeoidHeight(double *value, const std::size_t count, const double *srcLat, const double *srcLng, const std::size_t srcLatStride, const std::size_t srcLngStride, const std::size_t dstStride) NOTHROWS;
 
             /**
             * Given a result for a MosaicDatabase query, generate a new ElevationData object.
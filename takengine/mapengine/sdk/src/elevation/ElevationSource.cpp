@@ -32,7 +32,8 @@ ElevationSource::QueryParameters::QueryParameters() NOTHROWS :
     minCE(NAN),
     minLE(NAN),
     order(nullptr, nullptr),
-    flags(nullptr, nullptr)
+    flags(nullptr, nullptr),
+    limitHint(0u)
 {}
 
 ElevationSource::QueryParameters::QueryParameters(const QueryParameters &other) NOTHROWS :
@@ -45,7 +46,8 @@ ElevationSource::QueryParameters::QueryParameters(const QueryParameters &other)
     minCE(other.minCE),
     minLE(other.minLE),
     order(nullptr, nullptr),
-    flags(nullptr, nullptr)
+    flags(nullptr, nullptr),
+    limitHint(other.limitHint)
 {
     if(other.spatialFilter)
         Geometry_clone(this->spatialFilter, *other.spatialFilter);
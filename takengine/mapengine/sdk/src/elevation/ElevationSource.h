@@ -71,6 +71,13 @@ namespace TAK {
                 double minLE;
                 Port::Collection<Order>::Ptr order;
                 std::unique_ptr<unsigned int, void(*)(const unsigned int *)> flags;
+                /**
+                 * Hint for the number of chunks the client expects to
+                 * consume, `0` if unknown. Sources may defer or page work
+                 * beyond the first `limitHint` chunks, but must still return
+                 * all matching chunks if the client continues iterating.
+                 */
+                std::size_t limitHint;
             };
         }
     }
@@ -4,6 +4,7 @@
 
 #include "thread/Mutex.h"
 #include "thread/Lock.h"
+#include "thread/ReadCopyUpdate.h"
 
 using namespace TAK::Engine::Elevation;
 
@@ -22,9 +23,13 @@ namespace
         static std::set<ElevationSourcesChangedListener *> l;
         return l;
     }
-    std::set<std::shared_ptr<ElevationSource>> &sources() NOTHROWS
+    typedef std::set<std::shared_ptr<ElevationSource>> SourceSet;
+
+    // sources are read on every elevation query; mutation is serialized
+    // with listener dispatch by `mutex()`
+    ReadCopyUpdate<SourceSet> &sources() NOTHROWS
     {
-        static std::set<std::shared_ptr<ElevationSource>> s;
+        static ReadCopyUpdate<SourceSet> s;
         return s;
     }
 }
@@ -57,7 +62,12 @@ TAKErr TAK::Engine::Elevation::ElevationSourceManager_attach(const std::shared_p
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
-    sources().insert(source);
+    code = sources().update([&source](SourceSet &s) -> TAKErr
+    {
+        s.insert(source);
+        return TE_Ok;
+    });
+    TE_CHECKRETURN_CODE(code);
 
     std::set<ElevationSourcesChangedListener *> &l = listeners();
     auto it = l.begin();
@@ -77,38 +87,36 @@ TAKErr TAK::Engine::Elevation::ElevationSourceManager_detach(const ElevationSour
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
     
-    std::set<std::shared_ptr<ElevationSource>> &s = sources();
-    std::set<std::shared_ptr<ElevationSource>>::iterator sourceIter;
-    for (sourceIter = s.begin(); sourceIter != s.end(); sourceIter++) {
-        if (&source == (*sourceIter).get()) {
-            std::shared_ptr<ElevationSource> detached(*sourceIter);
-            s.erase(sourceIter);
-
-            std::set<ElevationSourcesChangedListener *> &l = listeners();
-            auto it = l.begin();
-            while (it != l.end()) {
-                if ((*it)->onSourceDetached(*detached) == TE_Done)
-                    it = l.erase(it);
-                else
-                    it++;
+    std::shared_ptr<ElevationSource> detached;
+    code = sources().update([&source, &detached](SourceSet &s) -> TAKErr
+    {
+        for (auto sourceIter = s.begin(); sourceIter != s.end(); sourceIter++) {
+            if (&source == (*sourceIter).get()) {
+                detached = *sourceIter;
+                s.erase(sourceIter);
+                return TE_Ok;
             }
-
-            return TE_Ok;
         }
+        return TE_InvalidArg;
+    });
+    TE_CHECKRETURN_CODE(code);
+
+    std::set<ElevationSourcesChangedListener *> &l = listeners();
+    auto it = l.begin();
+    while (it != l.end()) {
+        if ((*it)->onSourceDetached(*detached) == TE_Done)
+            it = l.erase(it);
+        else
+            it++;
     }
 
-    return TE_InvalidArg;
+    return code;
 }
 TAKErr TAK::Engine::Elevation::ElevationSourceManager_findSource(std::shared_ptr<ElevationSource> &value, const char *name) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-    Lock lock(mutex());
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
-    std::set<std::shared_ptr<ElevationSource>> &s = sources();
-    std::set<std::shared_ptr<ElevationSource>>::iterator it;
-    for (it = s.begin(); it != s.end(); it++) {
+    ReadCopyUpdate<SourceSet>::ReadGuard s(sources());
+    SourceSet::const_iterator it;
+    for (it = s->begin(); it != s->end(); it++) {
         const char *srcName = (*it)->getName();
         if (!srcName ^ !name)
             continue;
@@ -123,13 +131,9 @@ TAKErr TAK::Engine::Elevation::ElevationSourceManager_findSource(std::shared_ptr
 TAKErr TAK::Engine::Elevation::ElevationSourceManager_getSources(TAK::Engine::Port::Collection<std::shared_ptr<ElevationSource>> &value) NOTHROWS
 {
     TAKErr code(TE_Ok);
-    Lock lock(mutex());
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
-    std::set<std::shared_ptr<ElevationSource>> &s = sources();
-    std::set<std::shared_ptr<ElevationSource>>::iterator it;
-    for (it = s.begin(); it != s.end(); it++) {
+    ReadCopyUpdate<SourceSet>::ReadGuard s(sources());
+    SourceSet::const_iterator it;
+    for (it = s->begin(); it != s->end(); it++) {
         code = value.add(*it);
         TE_CHECKBREAK_CODE(code);
     }
@@ -140,13 +144,9 @@ TAKErr TAK::Engine::Elevation::ElevationSourceManager_getSources(TAK::Engine::Po
 TAKErr TAK::Engine::Elevation::ElevationSourceManager_visitSources(TAKErr(*visitor)(void *opaque, ElevationSource &src) NOTHROWS, void *opaque) NOTHROWS
 {
     TAKErr code(TE_Ok);
-    LockPtr lock(nullptr, nullptr);
-    code = Lock_create(lock, mutex());
-    TE_CHECKRETURN_CODE(code);
-
-    std::set<std::shared_ptr<ElevationSource>> &s = sources();
-    std::set<std::shared_ptr<ElevationSource>>::iterator it;
-    for (it = s.begin(); it != s.end(); it++) {
+    ReadCopyUpdate<SourceSet>::ReadGuard s(sources());
+    SourceSet::const_iterator it;
+    for (it = s->begin(); it != s->end(); it++) {
         code = visitor(opaque, **it);
         TE_CHECKBREAK_CODE(code);
     }
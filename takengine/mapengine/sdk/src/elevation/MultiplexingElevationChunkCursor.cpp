@@ -34,6 +34,24 @@ namespace
 
         std::vector<bool(*)(ElevationChunkCursor &, ElevationChunkCursor &) NOTHROWS> &impl;
     };
+
+    /**
+     * Orders the cursors as a heap with the highest priority row at the
+     * front.
+     */
+    struct HeapComparator
+    {
+        HeapComparator(std::vector<bool(*)(ElevationChunkCursor &, ElevationChunkCursor &)> &impl_) :
+            impl(impl_)
+        {}
+
+        bool operator()(const std::shared_ptr<ElevationChunkCursor> &a, const std::shared_ptr<ElevationChunkCursor> &b)
+        {
+            return impl(b, a);
+        }
+
+        CursorComparator impl;
+    };
 }
 
 MultiplexingElevationChunkCursor::MultiplexingElevationChunkCursor(Collection<std::shared_ptr<ElevationChunkCursor>> &cursors_) NOTHROWS
@@ -63,8 +81,8 @@ MultiplexingElevationChunkCursor::MultiplexingElevationChunkCursor(Collection<st
         }
 
         if (!this->cursors.empty()) {
-            CursorComparator comp(this->order);
-            std::sort(this->cursors.begin(), this->cursors.end(), comp);
+            HeapComparator comp(this->order);
+            std::make_heap(this->cursors.begin(), this->cursors.end(), comp);
         }
     } while (false);
 }
@@ -100,8 +118,8 @@ MultiplexingElevationChunkCursor::MultiplexingElevationChunkCursor(Collection<st
         }
 
         if (!this->cursors.empty()) {
-            CursorComparator comp(this->order);
-            std::sort(this->cursors.begin(), this->cursors.end(), comp);
+            HeapComparator comp(this->order);
+            std::make_heap(this->cursors.begin(), this->cursors.end(), comp);
         }
     } while (false);
 }
@@ -151,8 +169,8 @@ MultiplexingElevationChunkCursor::MultiplexingElevationChunkCursor(Collection<st
         }
 
         if (!this->cursors.empty()) {
-            CursorComparator comp(this->order);
-            std::sort(this->cursors.begin(), this->cursors.end(), comp);
+            HeapComparator comp(this->order);
+            std::make_heap(this->cursors.begin(), this->cursors.end(), comp);
         }
     } while (false);
 }
@@ -195,15 +213,20 @@ TAKErr MultiplexingElevationChunkCursor::getFlags(unsigned int *value) NOTHROWS
 }
 TAKErr MultiplexingElevationChunkCursor::moveToNext() NOTHROWS
 {
+    // rows are merged lazily; only the cursor that supplied the current row
+    // is advanced, and is restored into the heap if it has more rows
+    HeapComparator comp(this->order);
     if(this->row.get()) {
-        if(this->row->moveToNext() != TE_Ok)
-            this->cursors.erase(this->cursors.begin());
-        
-        CursorComparator comp(this->order);
-        std::sort(this->cursors.begin(), this->cursors.end(), comp);
+        if(this->row->moveToNext() == TE_Ok) {
+            this->cursors.push_back(this->row);
+            std::push_heap(this->cursors.begin(), this->cursors.end(), comp);
+        }
+        this->row.reset();
     }
     if(this->cursors.empty())
         return TE_Done;
-    this->row = this->cursors[0];
+    std::pop_heap(this->cursors.begin(), this->cursors.end(), comp);
+    this->row = this->cursors.back();
+    this->cursors.pop_back();
     return TE_Ok;
 }
@@ -9,6 +9,12 @@
 namespace TAK {
     namespace Engine {
         namespace Elevation {
+            /**
+             * Merges the rows of several cursors in priority order. Each
+             * cursor is advanced only as its rows are consumed, so a client
+             * that stops iterating early, e.g. once a point query has been
+             * satisfied, does not pay for the remaining rows of each source.
+             */
             class MultiplexingElevationChunkCursor : public ElevationChunkCursor
             {
             public :
@@ -27,6 +33,7 @@ namespace TAK {
                 Util::TAKErr getBounds(const Feature::Polygon2 **value) NOTHROWS;
                 Util::TAKErr getFlags(unsigned int *value) NOTHROWS;
             private :
+                /** heap of the cursors with pending rows, excluding `row` */
                 std::vector<std::shared_ptr<ElevationChunkCursor>> cursors;
                 std::vector<bool(*)(ElevationChunkCursor &, ElevationChunkCursor &) NOTHROWS> order;
                 std::shared_ptr<ElevationChunkCursor> row;
@@ -0,0 +1,303 @@
+#include "elevation/Viewshed.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "elevation/ElevationManager.h"
+#include "thread/Monitor.h"
+#include "util/Tasking.h"
+#include "util/Work.h"
+
+using namespace TAK::Engine::Elevation;
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    /** mean radius of the earth, in meters */
+    const double EARTH_RADIUS = 6371008.8;
+    /** number of rays sampled by a single elevation query */
+    const std::size_t RAYS_PER_SLICE = 64u;
+
+    /**
+     * Rays of a single viewshed, claimed in slices by the calling thread
+     * and the CPU workers. A slice is only ever waited on once it has been
+     * claimed, so the viewshed completes even if no worker is available.
+     */
+    struct RaySplit
+    {
+        GeoPoint2 observer;
+        const ViewshedParameters *params {nullptr};
+        double observerElevation {NAN};
+        /** cells from the observer to the raster edge */
+        int n {0};
+        double cellLat {0.0};
+        double cellLng {0.0};
+        /** `(2n+1)*(2n+1)` cells; each is written only by the ray that owns it */
+        uint8_t *raster {nullptr};
+        std::size_t numRays {0u};
+        std::size_t slices {0u};
+        std::atomic<std::size_t> next {0u};
+        ProcessingCallback *callback {nullptr};
+
+        Monitor monitor;
+        std::size_t pending {0u};
+        std::size_t completedRays {0u};
+        TAKErr code {TE_Ok};
+    };
+
+    /** returns the perimeter cell, relative to the observer, of the ray */
+    void getRayEnd(int *x, int *y, const int n, const std::size_t ray) NOTHROWS
+    {
+        const int k = static_cast<int>(ray % (2u*n));
+        switch (ray / (2u*n)) {
+            case 0u : *x = -n + k; *y = n; break;
+            case 1u : *x = n; *y = n - k; break;
+            case 2u : *x = n - k; *y = -n; break;
+            default : *x = -n; *y = -n + k; break;
+        }
+    }
+
+    /**
+     * Returns the cell visited by the ray to `(px, py)` at Chebyshev
+     * distance `i` from the observer. Every cell is visited by the ray
+     * whose end is the projection of the cell onto the raster perimeter;
+     * that ray owns the cell.
+     */
+    inline void getRayCell(int *x, int *y, const int n, const int px, const int py, const int i) NOTHROWS
+    {
+        *x = static_cast<int>(std::lround(static_cast<double>(i)*px / n));
+        *y = static_cast<int>(std::lround(static_cast<double>(i)*py / n));
+    }
+    inline bool isRayCellOwner(const int n, const int px, const int py, const int x, const int y, const int i) NOTHROWS
+    {
+        return std::lround(static_cast<double>(x)*n / i) == px &&
+               std::lround(static_cast<double>(y)*n / i) == py;
+    }
+
+    TAKErr sweepRays(RaySplit &split, const std::size_t ray0, const std::size_t ray1) NOTHROWS
+    {
+        const int n = split.n;
+        const int width = 2*n + 1;
+        const double radius2 = split.params->radius*split.params->radius;
+
+        // sample all cells within the radius along the rays
+        std::vector<double> lat;
+        std::vector<double> lng;
+        std::vector<double> distance;
+        std::vector<std::size_t> rayOffset;
+        lat.reserve((ray1-ray0)*n);
+        lng.reserve((ray1-ray0)*n);
+        distance.reserve((ray1-ray0)*n);
+        rayOffset.reserve((ray1-ray0) + 1u);
+        for (std::size_t ray = ray0; ray < ray1; ray++) {
+            rayOffset.push_back(lat.size());
+            int px, py;
+            getRayEnd(&px, &py, n, ray);
+            for (int i = 1; i <= n; i++) {
+                int x, y;
+                getRayCell(&x, &y, n, px, py, i);
+                const double d2 = (static_cast<double>(x)*x + static_cast<double>(y)*y) * split.params->resolution*split.params->resolution;
+                if (d2 > radius2)
+                    break;
+                lat.push_back(split.observer.latitude + y*split.cellLat);
+                lng.push_back(split.observer.longitude + x*split.cellLng);
+                distance.push_back(sqrt(d2));
+            }
+        }
+        rayOffset.push_back(lat.size());
+        if (lat.empty())
+            return TE_Ok;
+
+        std::vector<double> els(lat.size());
+        TAKErr code = ElevationManager_getElevation(els.data(), els.size(), lat.data(), lng.data(), 1u, 1u, 1u, split.params->filter);
+        if (code == TE_Done)
+            code = TE_Ok;
+        TE_CHECKRETURN_CODE(code);
+
+        std::vector<uint8_t> visibility(lat.size());
+        for (std::size_t r = 0u; r < (ray1-ray0); r++) {
+            const std::size_t off = rayOffset[r];
+            const std::size_t count = rayOffset[r+1u] - off;
+            Viewshed_sweep(visibility.data() + off, els.data() + off, distance.data() + off, count, split.observerElevation, *split.params);
+
+            int px, py;
+            getRayEnd(&px, &py, n, ray0 + r);
+            for (std::size_t j = 0u; j < count; j++) {
+                const int i = static_cast<int>(j) + 1;
+                int x, y;
+                getRayCell(&x, &y, n, px, py, i);
+                if (isRayCellOwner(n, px, py, x, y, i))
+                    split.raster[(n - y)*width + (n + x)] = visibility[off + j];
+            }
+        }
+        return code;
+    }
+
+    bool RaySplit_runSlice(RaySplit &split) NOTHROWS
+    {
+        const std::size_t slice = split.next.fetch_add(1u);
+        if (slice >= split.slices)
+            return false;
+        const std::size_t ray0 = slice * RAYS_PER_SLICE;
+        const std::size_t ray1 = std::min(ray0 + RAYS_PER_SLICE, split.numRays);
+
+        TAKErr code(TE_Ok);
+        if (ProcessingCallback_isCanceled(split.callback))
+            code = TE_Canceled;
+        else
+            code = sweepRays(split, ray0, ray1);
+
+        Monitor::Lock lock(split.monitor);
+        if (code != TE_Ok && split.code == TE_Ok)
+            split.code = code;
+        split.completedRays += (ray1 - ray0);
+        if (split.callback && split.callback->progress)
+            split.callback->progress(split.callback->opaque, static_cast<int>(split.completedRays), static_cast<int>(split.numRays));
+        if (--split.pending == 0u)
+            lock.broadcast();
+        return true;
+    }
+
+    TAKErr RaySplit_task(bool &, const std::shared_ptr<RaySplit> &split) NOTHROWS
+    {
+        while (RaySplit_runSlice(*split))
+            ;
+        return TE_Ok;
+    }
+}
+
+ViewshedParameters::ViewshedParameters() NOTHROWS :
+    observerHeight(2.0),
+    targetHeight(0.0),
+    radius(5000.0),
+    resolution(30.0),
+    earthCurvature(true),
+    refraction(0.13)
+{}
+
+void TAK::Engine::Elevation::Viewshed_sweep(uint8_t *value, const double *elevations, const double *distances, const std::size_t count, const double observerElevation, const ViewshedParameters &params) NOTHROWS
+{
+    const double eye = observerElevation + params.observerHeight;
+    // drop of the surface per square meter of distance
+    const double curvature = params.earthCurvature ? (1.0 - params.refraction) / (2.0*EARTH_RADIUS) : 0.0;
+
+    // a sample is visible if the sight line to the target at the sample
+    // clears the steepest sight line to the surface of all nearer samples
+    double maxSlope = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0u; i < count; i++) {
+        const double d = distances[i];
+        if (isnan(elevations[i])) {
+            value[i] = TEVV_NoData;
+            continue;
+        } else if (d <= 0.0) {
+            value[i] = TEVV_Visible;
+            continue;
+        }
+        const double z = elevations[i] - curvature*d*d;
+        const double targetSlope = (z + params.targetHeight - eye) / d;
+        value[i] = (targetSlope >= maxSlope) ? TEVV_Visible : TEVV_Hidden;
+        const double slope = (z - eye) / d;
+        if (slope > maxSlope)
+            maxSlope = slope;
+    }
+}
+
+TAKErr TAK::Engine::Elevation::Viewshed_compute(ViewshedRaster &value, const GeoPoint2 &observer, const ViewshedParameters &params, ProcessingCallback *callback) NOTHROWS
+{
+    if (isnan(observer.latitude) || isnan(observer.longitude))
+        return TE_InvalidArg;
+    if (!(params.radius > 0.0) || !(params.resolution > 0.0))
+        return TE_InvalidArg;
+
+    std::shared_ptr<RaySplit> split(new RaySplit());
+    if (ElevationManager_getElevation(&split->observerElevation, nullptr, observer.latitude, observer.longitude, params.filter) != TE_Ok)
+        return TE_Done;
+
+    split->observer = observer;
+    split->params = &params;
+    split->n = static_cast<int>(ceil(params.radius / params.resolution));
+    split->cellLat = params.resolution / GeoPoint2_approximateMetersPerDegreeLatitude(observer.latitude);
+    split->cellLng = params.resolution / std::max(GeoPoint2_approximateMetersPerDegreeLongitude(observer.latitude), 1.0);
+    split->callback = callback;
+
+    const std::size_t width = 2u*split->n + 1u;
+    value.width = width;
+    value.height = width;
+    value.bounds.minX = observer.longitude - (split->n + 0.5)*split->cellLng;
+    value.bounds.minY = observer.latitude - (split->n + 0.5)*split->cellLat;
+    value.bounds.maxX = observer.longitude + (split->n + 0.5)*split->cellLng;
+    value.bounds.maxY = observer.latitude + (split->n + 0.5)*split->cellLat;
+    value.bounds.minZ = 0.0;
+    value.bounds.maxZ = 0.0;
+    value.data.reset(new(std::nothrow) uint8_t[width*width]);
+    if (!value.data)
+        return TE_OutOfMemory;
+    memset(value.data.get(), TEVV_NoData, width*width);
+    // the observer
+    value.data[split->n*width + split->n] = TEVV_Visible;
+
+    split->raster = value.data.get();
+    split->numRays = 8u*split->n;
+    split->slices = (split->numRays + RAYS_PER_SLICE - 1u) / RAYS_PER_SLICE;
+    split->pending = split->slices;
+
+    const std::size_t workers = std::min(Platform_processorCount(), split->slices);
+    for (std::size_t i = 1u; i < workers; i++)
+        Task_begin(GeneralWorkers_cpu(), RaySplit_task, split);
+    while (RaySplit_runSlice(*split))
+        ;
+
+    Monitor::Lock lock(split->monitor);
+    while (split->pending)
+        lock.wait();
+    return split->code;
+}
+
+TAKErr TAK::Engine::Elevation::Viewshed_lineOfSight(bool *value, const GeoPoint2 &observer, const GeoPoint2 &target, const ViewshedParameters &params) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value)
+        return TE_InvalidArg;
+    if (!(params.resolution > 0.0))
+        return TE_InvalidArg;
+
+    double observerElevation;
+    if (ElevationManager_getElevation(&observerElevation, nullptr, observer.latitude, observer.longitude, params.filter) != TE_Ok)
+        return TE_Done;
+
+    const double range = GeoPoint2_distance(observer, target, true);
+    const double azimuth = GeoPoint2_bearing(observer, target, true);
+    const std::size_t count = std::max(static_cast<std::size_t>(ceil(range / params.resolution)), static_cast<std::size_t>(1u));
+
+    // sample the profile, ending at the target
+    std::vector<double> lat(count);
+    std::vector<double> lng(count);
+    std::vector<double> distance(count);
+    for (std::size_t i = 0u; i < count; i++) {
+        distance[i] = range * static_cast<double>(i + 1u) / static_cast<double>(count);
+        const GeoPoint2 p = (i + 1u) < count ? GeoPoint2_pointAtDistance(observer, azimuth, distance[i], true) : target;
+        lat[i] = p.latitude;
+        lng[i] = p.longitude;
+    }
+
+    std::vector<double> els(count);
+    code = ElevationManager_getElevation(els.data(), count, lat.data(), lng.data(), 1u, 1u, 1u, params.filter);
+    if (code == TE_Done)
+        code = TE_Ok;
+    TE_CHECKRETURN_CODE(code);
+    if (isnan(els[count - 1u]))
+        return TE_Done;
+
+    std::vector<uint8_t> visibility(count);
+    Viewshed_sweep(visibility.data(), els.data(), distance.data(), count, observerElevation, params);
+    *value = (visibility[count - 1u] == TEVV_Visible);
+    return code;
+}
@@ -0,0 +1,107 @@
+#ifndef TAK_ENGINE_ELEVATION_VIEWSHED_H_INCLUDED
+#define TAK_ENGINE_ELEVATION_VIEWSHED_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/GeoPoint2.h"
+#include "elevation/ElevationSource.h"
+#include "feature/Envelope2.h"
+#include "port/Platform.h"
+#include "util/Error.h"
+#include "util/ProcessingCallback.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Elevation {
+            enum ViewshedVisibility
+            {
+                /** outside of the analysis radius, or no elevation data */
+                TEVV_NoData = 0u,
+                TEVV_Hidden = 1u,
+                TEVV_Visible = 2u,
+            };
+
+            struct ENGINE_API ViewshedParameters
+            {
+            public :
+                ViewshedParameters() NOTHROWS;
+            public :
+                /** observer height above the surface, in meters */
+                double observerHeight;
+                /** target height above the surface, in meters */
+                double targetHeight;
+                /** radius of the analysis, in meters */
+                double radius;
+                /** raster cell size and profile sample spacing, in meters */
+                double resolution;
+                /** if `true`, elevations fall away with the curvature of the earth */
+                bool earthCurvature;
+                /** atmospheric refraction coefficient, applied with `earthCurvature` */
+                double refraction;
+                /** filters the elevation sources sampled */
+                ElevationSource::QueryParameters filter;
+            };
+
+            /**
+             * Visibility raster, centered on the observer. Cells are evenly
+             * spaced in latitude and longitude; row `0` is the northern
+             * edge.
+             */
+            struct ENGINE_API ViewshedRaster
+            {
+                Feature::Envelope2 bounds;
+                std::size_t width {0u};
+                std::size_t height {0u};
+                /** `width*height` `ViewshedVisibility` values */
+                std::unique_ptr<uint8_t[]> data;
+            };
+
+            /**
+             * Computes the visibility of each sample of a radial elevation
+             * profile from an observer at the start of the profile.
+             *
+             * @param value             Returns the `ViewshedVisibility` of
+             *                          each sample
+             * @param elevations        The surface elevation, meters HAE, of
+             *                          each sample. `NaN` samples are
+             *                          `TEVV_NoData` and do not occlude.
+             * @param distances         The distance, in meters, of each
+             *                          sample from the observer, ascending
+             * @param count             The number of samples
+             * @param observerElevation The surface elevation, meters HAE, at
+             *                          the observer
+             */
+            ENGINE_API void Viewshed_sweep(uint8_t *value, const double *elevations, const double *distances, const std::size_t count, const double observerElevation, const ViewshedParameters &params) NOTHROWS;
+
+            /**
+             * Computes the viewshed of an observer. Rays are cast from the
+             * observer to each cell on the perimeter of the raster; groups
+             * of rays are sampled via a single batched elevation query and
+             * swept concurrently on the CPU workers and the calling thread.
+             *
+             * <P>Progress is reported as the number of rays completed and
+             * may be reported from any of the threads computing the
+             * viewshed.
+             *
+             * @return  TE_Ok on success, TE_Canceled if canceled via
+             *          `callback`, TE_Done if there is no elevation at the
+             *          observer
+             */
+            ENGINE_API Util::TAKErr Viewshed_compute(ViewshedRaster &value, const Core::GeoPoint2 &observer, const ViewshedParameters &params, Util::ProcessingCallback *callback) NOTHROWS;
+
+            /**
+             * Determines whether the target is visible from the observer.
+             * The profile between the two is sampled every
+             * `params.resolution` meters; `params.radius` is ignored.
+             *
+             * @return  TE_Ok on success, TE_Done if there is no elevation at
+             *          the observer or target
+             */
+            ENGINE_API Util::TAKErr Viewshed_lineOfSight(bool *value, const Core::GeoPoint2 &observer, const Core::GeoPoint2 &target, const ViewshedParameters &params) NOTHROWS;
+        }
+    }
+}
+
+#endif
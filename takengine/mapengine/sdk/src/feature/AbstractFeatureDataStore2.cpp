@@ -5,6 +5,7 @@
 #include "feature/FeatureCursor2.h"
 #include "thread/Lock.h"
 #include "util/Logging.h"
+#include "util/Memory.h"
 
 using namespace TAK::Engine::Feature;
 
@@ -15,6 +16,56 @@ using namespace atakmap::util;
 
 namespace
 {
+    // beyond this many features, the IDs of the features in a change are not reported
+    const std::size_t MAX_CHANGE_FIDS = 4096u;
+
+    struct ScopedCount
+    {
+        ScopedCount(int &count_) NOTHROWS : count(count_) { count++; }
+        ~ScopedCount() NOTHROWS { count--; }
+        int &count;
+    };
+
+    void includeBounds(FeatureDataStore2::ContentChange &change, const Envelope2 &bounds) NOTHROWS
+    {
+        if (!change.hasBounds) {
+            change.bounds = bounds;
+            change.hasBounds = true;
+        } else {
+            change.bounds.minX = std::min(change.bounds.minX, bounds.minX);
+            change.bounds.minY = std::min(change.bounds.minY, bounds.minY);
+            change.bounds.minZ = std::min(change.bounds.minZ, bounds.minZ);
+            change.bounds.maxX = std::max(change.bounds.maxX, bounds.maxX);
+            change.bounds.maxY = std::max(change.bounds.maxY, bounds.maxY);
+            change.bounds.maxZ = std::max(change.bounds.maxZ, bounds.maxZ);
+        }
+    }
+    void includeBounds(FeatureDataStore2::ContentChange &change, const atakmap::feature::Geometry *geom) NOTHROWS
+    {
+        if (!geom)
+            return;
+        try {
+            const atakmap::feature::Envelope mbb = geom->getEnvelope();
+            includeBounds(change, Envelope2(mbb.minX, mbb.minY, mbb.minZ, mbb.maxX, mbb.maxY, mbb.maxZ));
+        } catch (...) {
+            change.unbounded = true;
+        }
+    }
+    void merge(FeatureDataStore2::ContentChange &dst, const FeatureDataStore2::ContentChange &src) NOTHROWS
+    {
+        dst.fidsComplete &= src.fidsComplete;
+        if (dst.fidsComplete && (dst.fids.size() + src.fids.size()) <= MAX_CHANGE_FIDS) {
+            dst.fids.insert(src.fids.begin(), src.fids.end());
+        } else {
+            dst.fids.clear();
+            dst.fidsComplete = false;
+        }
+        dst.fsids.insert(src.fsids.begin(), src.fsids.end());
+        if (src.hasBounds)
+            includeBounds(dst, src.bounds);
+        dst.unbounded |= src.unbounded;
+    }
+
     std::string replace(const std::string &src, const char old, const char *cnew)
     {
         std::string dst = src;
@@ -72,8 +123,44 @@ AbstractFeatureDataStore2::AbstractFeatureDataStore2(int modification_flags, int
     visibility_flags_(visibility_flags),
     in_bulk_modification_(0),
     content_changed_(false),
+    recording_change_(0),
+    coalesce_window_(0LL),
+    coalesced_pending_(false),
+    last_notify_(0LL),
+    coalesce_stopped_(false),
+    coalesce_thread_(nullptr, nullptr),
     mutex_(TEMT_Recursive)
 {}
+
+AbstractFeatureDataStore2::~AbstractFeatureDataStore2() NOTHROWS
+{
+    stopContentChangedCoalescing();
+}
+
+TAKErr AbstractFeatureDataStore2::setContentChangedCoalescingWindow(const int64_t millis) NOTHROWS
+{
+    if (millis < 0LL)
+        return TE_InvalidArg;
+
+    TAKErr code(TE_Ok);
+    Lock lock(mutex_);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    Monitor::Lock mlock(coalesce_monitor_);
+    code = mlock.status;
+    TE_CHECKRETURN_CODE(code);
+    coalesce_window_ = millis;
+    if (millis && !coalesce_thread_.get()) {
+        ThreadCreateParams params;
+        params.name = "FeatureDataStore-notify";
+        code = Thread_start(coalesce_thread_, coalesceThreadRun, this, params);
+        TE_CHECKRETURN_CODE(code);
+    }
+    // any pending change is delivered per the new window
+    mlock.broadcast();
+    return code;
+}
     
 TAKErr AbstractFeatureDataStore2::addOnDataStoreContentChangedListener(OnDataStoreContentChangedListener *l) NOTHROWS
 {
@@ -101,6 +188,10 @@ TAKErr AbstractFeatureDataStore2::removeOnDataStoreContentChangedListener(OnData
 void AbstractFeatureDataStore2::setContentChanged() NOTHROWS
 {
     this->content_changed_ = true;
+    // a change made outside of the methods of this class, the extent of
+    // which was not recorded
+    if (!this->recording_change_)
+        this->pending_change_.unbounded = true;
 }
 
 void AbstractFeatureDataStore2::dispatchDataStoreContentChangedNoSync(bool force) NOTHROWS
@@ -110,12 +201,156 @@ void AbstractFeatureDataStore2::dispatchDataStoreContentChangedNoSync(bool force
     if (this->content_changed_ || force) {
         this->content_changed_ = false;
 
-        std::set<OnDataStoreContentChangedListener *>::iterator it;
-        for (it = this->content_changed_listeners_.begin(); it != this->content_changed_listeners_.end(); it++)
-            (*it)->onDataStoreContentChanged(*this);
+        if (force)
+            this->pending_change_.unbounded = true;
+        this->resolvePendingChangeNoSync();
+
+        ContentChange change;
+        std::swap(change, this->pending_change_);
+
+        {
+            Monitor::Lock lock(coalesce_monitor_);
+            if (lock.status == TE_Ok && coalesce_window_) {
+                // delivered by the coalescing thread
+                merge(coalesced_change_, change);
+                coalesced_pending_ = true;
+                lock.signal();
+                return;
+            }
+        }
+
+        this->notifyListenersNoSync(change);
     }
 }
 
+void AbstractFeatureDataStore2::stopContentChangedCoalescing() NOTHROWS
+{
+    {
+        Monitor::Lock lock(coalesce_monitor_);
+        coalesce_stopped_ = true;
+        // subsequent changes are delivered synchronously
+        coalesce_window_ = 0LL;
+        lock.broadcast();
+    }
+    if (coalesce_thread_.get()) {
+        coalesce_thread_->join();
+        coalesce_thread_.reset();
+    }
+}
+
+void AbstractFeatureDataStore2::recordFeatureChangeNoSync(const int64_t fid) NOTHROWS
+{
+    if (this->content_changed_listeners_.empty())
+        return;
+
+    if (this->pending_change_.fidsComplete && this->pending_change_.fids.size() < MAX_CHANGE_FIDS) {
+        this->pending_change_.fids.insert(fid);
+    } else {
+        this->pending_change_.fids.clear();
+        this->pending_change_.fidsComplete = false;
+    }
+
+    // the geometry is unchanged; the feature is looked up once per
+    // notification rather than once per modification
+    if (this->pending_change_.unbounded)
+        return;
+    if (this->unresolved_fids_.size() < MAX_CHANGE_FIDS) {
+        this->unresolved_fids_.insert(fid);
+    } else {
+        this->unresolved_fids_.clear();
+        this->pending_change_.unbounded = true;
+    }
+}
+
+void AbstractFeatureDataStore2::recordFeatureReplacementNoSync(const int64_t fid, const atakmap::feature::Geometry *geom) NOTHROWS
+{
+    if (this->content_changed_listeners_.empty())
+        return;
+
+    if (this->pending_change_.fidsComplete && this->pending_change_.fids.size() < MAX_CHANGE_FIDS) {
+        this->pending_change_.fids.insert(fid);
+    } else {
+        this->pending_change_.fids.clear();
+        this->pending_change_.fidsComplete = false;
+    }
+    if (this->pending_change_.unbounded)
+        return;
+
+    // the change covers the geometry being replaced
+    FeaturePtr_const feature(nullptr, nullptr);
+    if (this->getFeature(feature, fid) == TE_Ok && feature.get()) {
+        this->pending_change_.fsids.insert(feature->getFeatureSetId());
+        includeBounds(this->pending_change_, feature->getGeometry());
+    } else {
+        this->pending_change_.unbounded = true;
+    }
+    includeBounds(this->pending_change_, geom);
+}
+
+void AbstractFeatureDataStore2::resolvePendingChangeNoSync() NOTHROWS
+{
+    if (!this->pending_change_.unbounded) {
+        std::set<int64_t>::iterator it;
+        for (it = this->unresolved_fids_.begin(); it != this->unresolved_fids_.end(); it++) {
+            FeaturePtr_const feature(nullptr, nullptr);
+            // a feature no longer present was deleted, which recorded its extent
+            if (this->getFeature(feature, *it) != TE_Ok || !feature.get())
+                continue;
+            this->pending_change_.fsids.insert(feature->getFeatureSetId());
+            includeBounds(this->pending_change_, feature->getGeometry());
+        }
+    }
+    this->unresolved_fids_.clear();
+}
+
+void AbstractFeatureDataStore2::recordFeatureSetChangeNoSync(const int64_t fsid) NOTHROWS
+{
+    this->pending_change_.fsids.insert(fsid);
+    this->pending_change_.unbounded = true;
+}
+
+void AbstractFeatureDataStore2::notifyListenersNoSync(const ContentChange &change) NOTHROWS
+{
+    std::set<OnDataStoreContentChangedListener *>::iterator it;
+    for (it = this->content_changed_listeners_.begin(); it != this->content_changed_listeners_.end(); it++)
+        (*it)->onDataStoreContentChanged(*this, change);
+}
+
+void *AbstractFeatureDataStore2::coalesceThreadRun(void *opaque)
+{
+    auto &store = *static_cast<AbstractFeatureDataStore2 *>(opaque);
+    do {
+        ContentChange change;
+        {
+            Monitor::Lock lock(store.coalesce_monitor_);
+            if (lock.status != TE_Ok || store.coalesce_stopped_)
+                break;
+            if (!store.coalesced_pending_) {
+                lock.wait();
+                continue;
+            }
+            // the first change after an idle period is delivered
+            // immediately, subsequent changes at most once per window
+            const int64_t now = Port::Platform_systime_millis();
+            const int64_t due = store.last_notify_ + store.coalesce_window_;
+            if (store.coalesce_window_ && now < due) {
+                lock.wait(due - now);
+                continue;
+            }
+            std::swap(change, store.coalesced_change_);
+            store.coalesced_change_ = ContentChange();
+            store.coalesced_pending_ = false;
+            store.last_notify_ = now;
+        }
+
+        Lock lock(store.mutex_);
+        if (lock.status != TE_Ok)
+            continue;
+        store.notifyListenersNoSync(change);
+    } while (true);
+    return nullptr;
+}
+
     
 TAKErr AbstractFeatureDataStore2::getVisibilitySettingsFlags(int *value) NOTHROWS
 {
@@ -132,6 +367,8 @@ TAKErr AbstractFeatureDataStore2::setFeatureVisible(const int64_t fid, const boo
     Lock lock(mutex_);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureChangeNoSync(fid);
     code = this->setFeatureVisibleImpl(fid, visible);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -146,6 +383,8 @@ TAKErr AbstractFeatureDataStore2::setFeaturesVisible(const FeatureQueryParameter
     Lock lock(mutex_);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
+    ScopedCount recording(this->recording_change_);
+    this->pending_change_.unbounded = true;
     code = this->setFeaturesVisibleImpl(params, visible);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -160,6 +399,8 @@ TAKErr AbstractFeatureDataStore2::setFeatureSetVisible(const int64_t setId, cons
     Lock lock(mutex_);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureSetChangeNoSync(setId);
     code = this->setFeatureSetVisibleImpl(setId, visible);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -174,6 +415,8 @@ TAKErr AbstractFeatureDataStore2::setFeatureSetsVisible(const FeatureSetQueryPar
     Lock lock(mutex_);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
+    ScopedCount recording(this->recording_change_);
+    this->pending_change_.unbounded = true;
     code = this->setFeatureSetsVisibleImpl(params, visible);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -282,9 +525,16 @@ TAKErr AbstractFeatureDataStore2::insertFeatureSet(FeatureSetPtr_const *featureS
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
     code = this->insertFeatureSetImpl(featureSet, provider, type, name, minResolution, maxResolution);
-    if (code == TE_Ok)
+    if (code == TE_Ok) {
+        // the new feature set is empty; only the set itself changed
+        if (featureSet && featureSet->get())
+            this->pending_change_.fsids.insert((*featureSet)->getId());
+        else
+            this->pending_change_.unbounded = true;
         this->dispatchDataStoreContentChangedNoSync(false);
+    }
     return code;
 }
 
@@ -300,6 +550,8 @@ TAKErr AbstractFeatureDataStore2::updateFeatureSet(const int64_t fsid, const cha
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureSetChangeNoSync(fsid);
     code = this->updateFeatureSetImpl(fsid, name);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -318,6 +570,8 @@ TAKErr AbstractFeatureDataStore2::updateFeatureSet(const int64_t fsid, const dou
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureSetChangeNoSync(fsid);
     code = this->updateFeatureSetImpl(fsid, minResolution, maxResolution);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -336,6 +590,8 @@ TAKErr AbstractFeatureDataStore2::updateFeatureSet(const int64_t fsid, const cha
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureSetChangeNoSync(fsid);
     code = this->updateFeatureSetImpl(fsid, name, minResolution, maxResolution);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -354,6 +610,8 @@ TAKErr AbstractFeatureDataStore2::deleteFeatureSet(const int64_t fsid) NOTHROWS
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureSetChangeNoSync(fsid);
     code = this->deleteFeatureSetImpl(fsid);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -370,6 +628,8 @@ TAKErr AbstractFeatureDataStore2::deleteAllFeatureSets() NOTHROWS
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->pending_change_.unbounded = true;
     code = this->deleteAllFeatureSetsImpl();
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -388,9 +648,17 @@ TAKErr AbstractFeatureDataStore2::insertFeature(FeaturePtr_const *feature, const
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
     code = this->insertFeatureImpl(feature, fsid, name, geom, altitudeMode, extrude, style, attributes);
-    if (code == TE_Ok)
+    if (code == TE_Ok) {
+        this->pending_change_.fsids.insert(fsid);
+        if (feature && feature->get())
+            this->pending_change_.fids.insert((*feature)->getId());
+        else
+            this->pending_change_.fidsComplete = false;
+        includeBounds(this->pending_change_, &geom);
         this->dispatchDataStoreContentChangedNoSync(false);
+    }
     return code;
 }
 
@@ -404,6 +672,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const char *n
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureChangeNoSync(fid);
     code = this->updateFeatureImpl(fid, name);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -420,6 +690,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const atakmap
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureReplacementNoSync(fid, &geom);
     code = this->updateFeatureImpl(fid, geom);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -435,6 +707,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const atakmap
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureReplacementNoSync(fid, &geom);
     code = this->updateFeatureImpl(fid, geom);
     code = this->updateFeatureImpl(fid, altitudeMode, extrude);
     if (code == TE_Ok)
@@ -451,6 +725,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const TAK::En
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureChangeNoSync(fid);
     code = this->updateFeatureImpl(fid, altitudeMode, extrude);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -466,6 +742,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const atakmap
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureChangeNoSync(fid);
     code = this->updateFeatureImpl(fid, style);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -482,6 +760,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const atakmap
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureChangeNoSync(fid);
     code = this->updateFeatureImpl(fid, attributes);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -498,6 +778,8 @@ TAKErr AbstractFeatureDataStore2::updateFeature(const int64_t fid, const char *n
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureReplacementNoSync(fid, &geom);
     code = this->updateFeatureImpl(fid, name, geom, style, attributes);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -514,6 +796,8 @@ TAKErr AbstractFeatureDataStore2::deleteFeature(const int64_t fid) NOTHROWS
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureReplacementNoSync(fid, nullptr);
     code = this->deleteFeatureImpl(fid);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -530,6 +814,8 @@ TAKErr AbstractFeatureDataStore2::deleteAllFeatures(const int64_t fsid) NOTHROWS
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    ScopedCount recording(this->recording_change_);
+    this->recordFeatureSetChangeNoSync(fsid);
     code = this->deleteAllFeaturesImpl(fsid);
     if (code == TE_Ok)
         this->dispatchDataStoreContentChangedNoSync(false);
@@ -6,7 +6,9 @@
 
 #include "feature/FeatureDataStore2.h"
 #include "port/Collection.h"
+#include "thread/Monitor.h"
 #include "thread/Mutex.h"
+#include "thread/Thread.h"
 
 namespace atakmap {
     namespace feature {
@@ -21,7 +23,22 @@ namespace TAK {
             {
             protected :
                 AbstractFeatureDataStore2(int modificationFlags, int visibilityFlags);
+                virtual ~AbstractFeatureDataStore2() NOTHROWS;
             public :
+                /**
+                 * Sets the window over which content changed notifications
+                 * are coalesced. When non-zero, listeners are notified on a
+                 * dedicated thread, no more than once per window, with a
+                 * `ContentChange` describing all changes since the previous
+                 * notification. Listeners must be removed before the store
+                 * is destroyed. Subclasses must invoke
+                 * `stopContentChangedCoalescing` from their destructors.
+                 *
+                 * @param millis    The window, in milliseconds. If zero, the
+                 *                  default, listeners are notified
+                 *                  synchronously with each change.
+                 */
+                Util::TAKErr setContentChangedCoalescingWindow(const int64_t millis) NOTHROWS;
                 virtual Util::TAKErr addOnDataStoreContentChangedListener(OnDataStoreContentChangedListener *l) NOTHROWS override;
                 virtual Util::TAKErr removeOnDataStoreContentChangedListener(OnDataStoreContentChangedListener *l) NOTHROWS override;
                 virtual Util::TAKErr getModificationFlags(int *value) NOTHROWS override;
@@ -79,6 +96,14 @@ namespace TAK {
                 TAK::Engine::Util::TAKErr checkModificationFlags(const int capability) NOTHROWS;
                 void setContentChanged() NOTHROWS;
                 void dispatchDataStoreContentChangedNoSync(bool force) NOTHROWS;
+                /**
+                 * Stops and joins the thread delivering coalesced
+                 * notifications; any pending notification is discarded.
+                 * Subclasses must invoke from their destructors, so that
+                 * no notification is delivered while the subclass is
+                 * being destroyed. May be invoked more than once.
+                 */
+                void stopContentChangedCoalescing() NOTHROWS;
             public :
                 static Util::TAKErr matches(bool *matched, const char *ctest, const char *value, const char wildcard) NOTHROWS;
                 static Util::TAKErr matches(bool *matched, Port::Collection<Port::String> &test, const char *value, const char wildcard) NOTHROWS;
@@ -86,6 +111,25 @@ namespace TAK {
                 static Util::TAKErr queryFeaturesCount(int *value, FeatureDataStore2 &dataStore, const FeatureQueryParameters &params) NOTHROWS;
             private:
                 Util::TAKErr checkFeatureSetReadOnly(const int64_t fsid) NOTHROWS;
+                /**
+                 * Records a change to the feature that does not affect its
+                 * geometry. The feature set and extent of the feature are
+                 * resolved when the notification is built.
+                 */
+                void recordFeatureChangeNoSync(const int64_t fid) NOTHROWS;
+                /**
+                 * Records a change that replaces the geometry of the
+                 * feature with `geom`, or deletes the feature if
+                 * `nullptr`. Invoked before the change is applied; the
+                 * previous geometry is not observable afterwards.
+                 */
+                void recordFeatureReplacementNoSync(const int64_t fid, const atakmap::feature::Geometry *geom) NOTHROWS;
+                /** resolves the features recorded by `recordFeatureChangeNoSync` into the pending change */
+                void resolvePendingChangeNoSync() NOTHROWS;
+                /** Records a change to the feature set whose extent is not known */
+                void recordFeatureSetChangeNoSync(const int64_t fsid) NOTHROWS;
+                void notifyListenersNoSync(const ContentChange &change) NOTHROWS;
+                static void *coalesceThreadRun(void *opaque);
             private :
                 std::set<OnDataStoreContentChangedListener *> content_changed_listeners_;
                 int visibility_flags_;
@@ -93,6 +137,21 @@ namespace TAK {
                 int in_bulk_modification_;
                 bool content_changed_;
                 std::map<int64_t, bool> read_only_map_;
+                /** changes recorded since the last notification */
+                ContentChange pending_change_;
+                /** features changed in place, whose feature set and extent are not yet resolved */
+                std::set<int64_t> unresolved_fids_;
+                /** non-zero while a change made through this class is being applied */
+                int recording_change_;
+
+                /** guards the coalescing state */
+                TAK::Engine::Thread::Monitor coalesce_monitor_;
+                int64_t coalesce_window_;
+                ContentChange coalesced_change_;
+                bool coalesced_pending_;
+                int64_t last_notify_;
+                bool coalesce_stopped_;
+                TAK::Engine::Thread::ThreadPtr coalesce_thread_;
             protected :
                 TAK::Engine::Thread::Mutex mutex_;
             };
@@ -16,6 +16,7 @@
 #include "port/STLSetAdapter.h"
 #include "port/STLVectorAdapter.h"
 #include "thread/Lock.h"
+#include "util/ConfigOptions.h"
 #include "util/IO.h"
 #include "util/Logging.h"
 #include "util/MathUtils.h"
@@ -38,8 +39,61 @@ using namespace TAK::Engine::Port;
 
 #define FEATURE_DATABASE_VERSION 5  // Added support for read_only property
 
+// attribute blobs of version 1 are fixed width; version 2 blobs are the
+// compact coding, with varint integers and dictionary coded strings
+#define COMPACT_ATTRIBUTES_VERSION 2
+// string values are only dictionary coded while the key has fewer distinct
+// values than this, and only if the value is no longer than the limit
+#define MAX_ATTRIBUTE_DICTIONARY_SIZE 256u
+#define MAX_ATTRIBUTE_DICTIONARY_VALUE_LENGTH 64u
+
+// maximum number of feature sets filtered via their in-memory spatial indices
+#define MAX_MEMORY_INDEXED_FEATURE_SETS 16u
+
+// the tolerance, in degrees, of simplified level `n` is
+// `SIMPLIFIED_BASE_TOLERANCE * SIMPLIFIED_LEVEL_STEP^n`
+#define SIMPLIFIED_BASE_TOLERANCE 0.00001
+#define SIMPLIFIED_LEVEL_STEP 4.0
+#define MAX_SIMPLIFIED_LEVELS 8u
+// geometries with no more points than this are not simplified further
+#define SIMPLIFIED_MIN_POINTS 32
+
 namespace
 {
+    double getSimplifiedTolerance(const int level) NOTHROWS
+    {
+        return SIMPLIFIED_BASE_TOLERANCE * pow(SIMPLIFIED_LEVEL_STEP, level);
+    }
+
+    /**
+     * Returns the coarsest simplified level whose tolerance does not exceed
+     * the tolerance requested by the query, or `-1` if no level applies.
+     * The tolerance is that of a leading simplification op, if present,
+     * else one pixel at the maximum resolution.
+     */
+    int getSimplifiedLevel(const TAK::Engine::Feature::FeatureDataStore2::FeatureQueryParameters &params, const std::size_t levels) NOTHROWS
+    {
+        double tolerance = NAN;
+        if (!params.ops->empty()) {
+            TAK::Engine::Port::Collection<TAK::Engine::Feature::FeatureDataStore2::FeatureQueryParameters::SpatialOp>::IteratorPtr opsIter(nullptr, nullptr);
+            TAK::Engine::Feature::FeatureDataStore2::FeatureQueryParameters::SpatialOp op;
+            if (params.ops->iterator(opsIter) != TAK::Engine::Util::TE_Ok || opsIter->get(op) != TAK::Engine::Util::TE_Ok)
+                return -1;
+            if (op.type != TAK::Engine::Feature::FeatureDataStore2::FeatureQueryParameters::SpatialOp::Simplify)
+                return -1;
+            tolerance = op.args.simplify.distance;
+        } else if (!isnan(params.maxResolution)) {
+            tolerance = params.maxResolution / 111319.49;
+        }
+        if (!(tolerance >= SIMPLIFIED_BASE_TOLERANCE))
+            return -1;
+
+        int level = 0;
+        while ((level + 1) < static_cast<int>(levels) && getSimplifiedTolerance(level + 1) <= tolerance)
+            level++;
+        return level;
+    }
+
     template<class Iface, class Impl = Iface>
     void deleter(Iface *obj)
     {
@@ -66,8 +120,8 @@ namespace
 
     // attribute coders
 #define DECL_CODER(type) \
-    TAKErr encode##type(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS; \
-    TAKErr decode##type(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS;
+    TAKErr encode##type(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS; \
+    TAKErr decode##type(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS;
 
     DECL_CODER(Int);
     DECL_CODER(Long);
@@ -83,6 +137,11 @@ namespace
 
     std::map<atakmap::util::AttributeSet::Type, int> ATTRIB_TYPES;
 
+    TAKErr writeVarint(DataOutput2 &dos, uint64_t value) NOTHROWS;
+    TAKErr writeZigZag(DataOutput2 &dos, const int64_t value) NOTHROWS;
+    TAKErr readVarint(uint64_t *value, DataInput2 &dis) NOTHROWS;
+    TAKErr readZigZag(int64_t *value, DataInput2 &dis) NOTHROWS;
+
     template<class T>
     class PointerContainerMgr : NonCopyable,
                                 NonHeapAllocatable
@@ -130,13 +189,22 @@ FDB::FDB(int modificationFlags, int visibilityFlags) NOTHROWS :
     max_lod_(0x7FFFFFFF),
     lod_check_(true),
     read_only_(false),
-    attr_schema_dirty_(true)
+    attr_schema_dirty_(true),
+    attr_values_table_(false),
+    compact_attributes_(ConfigOptions_getIntOptionOrDefault("fdb.compact-attributes", 1) != 0),
+    feature_cache_(new FeatureCache((std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("fdb.feature-cache-size", 16 * 1024 * 1024), 0))),
+    memory_spatial_index_limit_((std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("fdb.memory-spatial-index-limit", 4096), 0)),
+    next_spatial_filter_id_(1LL),
+    simplified_levels_(std::min((std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("fdb.simplified-levels", 0), 0), (std::size_t)MAX_SIMPLIFIED_LEVELS)),
+    simplified_geometries_(false)
 {
     static TAKErr attrSpecCodersInitialized = AttributeSpec::initCoders();
 }
 
 FDB::~FDB() NOTHROWS
-{}
+{
+    stopContentChangedCoalescing();
+}
 
 TAKErr FDB::open(const char *path) NOTHROWS
 {
@@ -157,7 +225,8 @@ TAKErr FDB::open(const char *path, int* dbVersion, bool buildIndices) NOTHROWS
     this->database_file_ = path;
     const bool creating = (!atakmap::util::pathExists(this->database_file_) || atakmap::util::getFileSize(this->database_file_) == 0LL);
 
-    DatabaseInformation info(this->database_file_);
+    // renderer queries are served by readers while ingest holds the writer
+    DatabaseInformation info(this->database_file_, nullptr, DATABASE_OPTIONS_POOLED, TEDP_ReadMostly);
     code = DatabaseFactory_create(this->database_, info);
     TE_CHECKRETURN_CODE(code);
 
@@ -208,6 +277,9 @@ TAKErr FDB::open(const char *path, int* dbVersion, bool buildIndices) NOTHROWS
         this->upgradeTables(dbVersion);
     }
 
+    code = this->validateSimplifiedGeometriesNoSync();
+    TE_CHECKRETURN_CODE(code);
+
     code = this->refresh();
     TE_CHECKRETURN_CODE(code);
 
@@ -383,6 +455,8 @@ TAKErr FDB::dropIndicesNoSync() NOTHROWS
     TE_CHECKRETURN_CODE(code);
     code = this->database_->execute("DROP INDEX IF EXISTS IdxFeaturesGroupIdName", nullptr, 0);
     TE_CHECKRETURN_CODE(code);
+    code = this->database_->execute("DROP INDEX IF EXISTS IdxFeaturesName", nullptr, 0);
+    TE_CHECKRETURN_CODE(code);
 
     std::vector<Port::String> tableNames;
     Port::STLVectorAdapter<Port::String> tableNamesV(tableNames);
@@ -605,6 +679,50 @@ TAKErr FDB::validateAttributeSchema() NOTHROWS
 
         result.reset();
 
+        // string value dictionaries
+        std::vector<Port::String> tableNames;
+        Port::STLVectorAdapter<Port::String> tableNamesV(tableNames);
+        code = Databases_getTableNames(tableNamesV, *this->database_);
+        TE_CHECKRETURN_CODE(code);
+        Port::String attribValuesStr("attribs_values");
+        code = tableNamesV.contains(&this->attr_values_table_, attribValuesStr);
+        TE_CHECKRETURN_CODE(code);
+
+        if (this->attr_values_table_) {
+            code = this->database_->query(result, "SELECT schema_id, code, value FROM attribs_values");
+            TE_CHECKRETURN_CODE(code);
+
+            do {
+                code = result->moveToNext();
+                TE_CHECKBREAK_CODE(code);
+
+                int64_t schemaId;
+                code = result->getLong(&schemaId, 0);
+                TE_CHECKBREAK_CODE(code);
+                int valueCode;
+                code = result->getInt(&valueCode, 1);
+                TE_CHECKBREAK_CODE(code);
+                const char *value;
+                code = result->getString(&value, 2);
+                TE_CHECKBREAK_CODE(code);
+
+                IdAttrSchemaMap::iterator schemaSpec;
+                schemaSpec = this->id_to_attr_schema_.find(schemaId);
+                if (schemaSpec == this->id_to_attr_schema_.end() || valueCode < 0 || !value)
+                    continue;
+                AttributeSpec &spec = *schemaSpec->second;
+                if (static_cast<std::size_t>(valueCode) >= spec.values.size())
+                    spec.values.resize(static_cast<std::size_t>(valueCode) + 1u);
+                spec.values[valueCode] = value;
+                spec.valueCodes[spec.values[valueCode]] = static_cast<std::size_t>(valueCode);
+            } while (true);
+            if (code == TE_Done)
+                code = TE_Ok;
+            TE_CHECKRETURN_CODE(code);
+
+            result.reset();
+        }
+
         this->attr_schema_dirty_ = false;
     }
 
@@ -797,6 +915,7 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result) NOTHROWS
     int attribsCol = -1;
     int altitudeModeCol = -1;
     int extrudeCol = -1;
+    int styleIdCol = -1;
 
     std::ostringstream sql;
     sql << "SELECT features.fid, features.fsid, features.version";
@@ -810,6 +929,8 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result) NOTHROWS
     extrudeCol = extrasCol++;
     sql << ", styles.value";
     styleCol = extrasCol++;
+    sql << ", features.style_id";
+    styleIdCol = extrasCol++;
     sql << ", attributes.value";
     attribsCol = extrasCol++;
     sql << " FROM features";
@@ -822,7 +943,7 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result) NOTHROWS
     TE_CHECKRETURN_CODE(code);
 
     result = FeatureCursorPtr(new FeatureCursorImpl(*this, std::move(cursor), idCol, fsidCol, versionCol, nameCol, geomCol, styleCol,
-                                                    attribsCol, altitudeModeCol, extrudeCol),
+                                                    attribsCol, altitudeModeCol, extrudeCol, styleIdCol, true, nullptr),
                               deleter_const<FeatureCursor2, FeatureCursorImpl>);
     cursor.release();
     cursor.reset();
@@ -845,6 +966,8 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
     this->database_->getVersion(&dbVersion);
 
     const int ignoredFields = params.ignoredFields;
+    // rows missing fields, or with modified geometry, must not be shared
+    bool cacheRows = !ignoredFields && params.ops->empty();
 
     const int idCol = 0;
     const int fsidCol = 1;
@@ -857,6 +980,7 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
     int attribsCol = -1;
     int altitudeModeCol = -1;
     int extrudeCol = -1;
+    int styleIdCol = -1;
 
     std::list<BindArgument> args;
 
@@ -868,34 +992,52 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
         nameCol = extrasCol++;
     }
     if (!MathUtils_hasBits(ignoredFields, FeatureQueryParameters::GeometryField)) {
-        if (!params.ops->empty()) {
+        // levels previously generated are used even if generation is disabled
+        const int simplifiedLevel = this->simplified_geometries_ ?
+            getSimplifiedLevel(params, this->simplified_levels_ ? this->simplified_levels_ : MAX_SIMPLIFIED_LEVELS) : -1;
+        if (!params.ops->empty() || simplifiedLevel >= 0) {
             std::ostringstream geomStr;
-            geomStr << "features.geometry";
+            if (simplifiedLevel >= 0) {
+                // the coarsest stored level within the requested tolerance
+                geomStr << "COALESCE((SELECT geometry FROM simplified_geometries WHERE fid = features.fid AND level <= ? ORDER BY level DESC LIMIT 1), features.geometry)";
+                args.push_back(BindArgument(simplifiedLevel));
+                cacheRows = false;
+            } else {
+                geomStr << "features.geometry";
+            }
 
-            Collection<FeatureQueryParameters::SpatialOp>::IteratorPtr opsIter(nullptr, nullptr);
-            code = params.ops->iterator(opsIter);
-            TE_CHECKRETURN_CODE(code);
-            do {
-                FeatureQueryParameters::SpatialOp op;
-                code = opsIter->get(op);
-                TE_CHECKBREAK_CODE(code);
+            if (!params.ops->empty()) {
+                Collection<FeatureQueryParameters::SpatialOp>::IteratorPtr opsIter(nullptr, nullptr);
+                code = params.ops->iterator(opsIter);
+                TE_CHECKRETURN_CODE(code);
+                bool first = true;
+                do {
+                    FeatureQueryParameters::SpatialOp op;
+                    code = opsIter->get(op);
+                    TE_CHECKBREAK_CODE(code);
 
-                if (op.type == FeatureQueryParameters::SpatialOp::Simplify) {
-                    insert(geomStr, "SimplifyPreserveTopology(");
-                    geomStr << ", ?)";
+                    if (op.type == FeatureQueryParameters::SpatialOp::Simplify) {
+                        // a leading simplification within a level of the stored
+                        // tolerance is already satisfied by the stored level
+                        if (!first || simplifiedLevel < 0 || op.args.simplify.distance >= getSimplifiedTolerance(simplifiedLevel + 1)) {
+                            insert(geomStr, "SimplifyPreserveTopology(");
+                            geomStr << ", ?)";
 
-                    args.push_back(BindArgument(op.args.simplify.distance));
-                } else if (op.type == FeatureQueryParameters::SpatialOp::Buffer) {
-                    insert(geomStr, "Buffer(");
-                    geomStr << ", ?)";
+                            args.push_back(BindArgument(op.args.simplify.distance));
+                        }
+                    } else if (op.type == FeatureQueryParameters::SpatialOp::Buffer) {
+                        insert(geomStr, "Buffer(");
+                        geomStr << ", ?)";
 
-                    args.push_back(BindArgument(op.args.buffer.distance));
-                }
-                code = opsIter->next();
-                TE_CHECKBREAK_CODE(code);
-            } while (true);
-            if (code == TE_Done)
-                code = TE_Ok;
+                        args.push_back(BindArgument(op.args.buffer.distance));
+                    }
+                    first = false;
+                    code = opsIter->next();
+                    TE_CHECKBREAK_CODE(code);
+                } while (true);
+                if (code == TE_Done)
+                    code = TE_Ok;
+            }
             sql << ", ";
             sql << geomStr.str();
         } else {
@@ -910,6 +1052,8 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
     if (!MathUtils_hasBits(ignoredFields, FeatureQueryParameters::StyleField)) {
         sql << ", styles.value";
         styleCol = extrasCol++;
+        sql << ", features.style_id";
+        styleIdCol = extrasCol++;
     }
     if (!MathUtils_hasBits(ignoredFields, FeatureQueryParameters::AttributesField)) {
         sql << ", attributes.value";
@@ -972,9 +1116,10 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
             std::ostringstream subsql;
             std::list<BindArgument> subargs;
             WhereClauseBuilder2 where;
+            SpatialFilterRef filterRef;
 
             bool emptyResults;
-            code = this->buildParamsWhereClauseCheck(&emptyResults, params, *fs, where);
+            code = this->buildParamsWhereClauseCheck(&emptyResults, params, *fs, where, filterRef);
             TE_CHECKBREAK_CODE(code);
             if (emptyResults)
                 continue;
@@ -1039,7 +1184,7 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
             TE_CHECKBREAK_CODE(code);
 
             retval.push_back(new FeatureCursorImpl(*this, std::move(queryResult), idCol, fsidCol, versionCol, nameCol, geomCol, styleCol,
-                                                   attribsCol, altitudeModeCol, extrudeCol));
+                                                   attribsCol, altitudeModeCol, extrudeCol, styleIdCol, cacheRows, filterRef));
             queryResult.reset();
         }
     }
@@ -1049,10 +1194,11 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
             std::ostringstream subsql;
             std::list<BindArgument> subargs;
             WhereClauseBuilder2 where;
+            SpatialFilterRef filterRef;
 
             bool emptyResults;
             STLSetAdapter<std::shared_ptr<const FeatureSetDefn>> fsNoCheckAdapter(fsNoCheck);
-            code = this->buildParamsWhereClauseNoCheck(&emptyResults, params, fsNoCheckAdapter, where);
+            code = this->buildParamsWhereClauseNoCheck(&emptyResults, params, fsNoCheckAdapter, where, filterRef);
             TE_CHECKBREAK_CODE(code);
             if (emptyResults)
                 continue;
@@ -1116,7 +1262,7 @@ TAKErr FDB::queryFeatures(FeatureCursorPtr &result, const FeatureQueryParameters
             TE_CHECKBREAK_CODE(code);
 
             retval.push_back(new FeatureCursorImpl(*this, std::move(queryResult), idCol, fsidCol, versionCol, nameCol, geomCol, styleCol,
-                                                   attribsCol, altitudeModeCol, extrudeCol));
+                                                   attribsCol, altitudeModeCol, extrudeCol, styleIdCol, cacheRows, filterRef));
             queryResult.reset();
         } while (false);
     }
@@ -1250,9 +1396,10 @@ TAKErr FDB::queryFeaturesCount(int *value, const FeatureQueryParameters &params)
             std::ostringstream subsql;
             std::list<BindArgument> subargs;
             WhereClauseBuilder2 where;
+            SpatialFilterRef filterRef;
 
             bool emptyResults;
-            code = this->buildParamsWhereClauseCheck(&emptyResults, params, **fs, where);
+            code = this->buildParamsWhereClauseCheck(&emptyResults, params, **fs, where, filterRef);
             TE_CHECKBREAK_CODE(code);
             if (emptyResults)
                 continue;
@@ -1345,10 +1492,11 @@ TAKErr FDB::queryFeaturesCount(int *value, const FeatureQueryParameters &params)
             std::ostringstream subsql;
             std::list<BindArgument> subargs;
             WhereClauseBuilder2 where;
+            SpatialFilterRef filterRef;
 
             bool emptyResults;
             STLSetAdapter<std::shared_ptr<const FeatureSetDefn>> fsNoCheckAdapter(fsNoCheck);
-            code = this->buildParamsWhereClauseNoCheck(&emptyResults, params, fsNoCheckAdapter, where);
+            code = this->buildParamsWhereClauseNoCheck(&emptyResults, params, fsNoCheckAdapter, where, filterRef);
             TE_CHECKBREAK_CODE(code);
             if (emptyResults)
                 continue;
@@ -2143,6 +2291,10 @@ TAKErr FDB::closeImpl() NOTHROWS
         this->id_to_attr_schema_.clear();
         this->info_dirty_ = true;
         this->key_to_attr_schema_.clear();
+        this->feature_cache_->clear();
+        this->spatial_indices_.clear();
+        // the staged filter rows are discarded with the connection
+        this->spatial_filters_.clear();
         this->database_.reset();
     }
 
@@ -2331,11 +2483,12 @@ TAKErr FDB::setFeaturesVisibleImpl(const FeatureQueryParameters &paramsRef, cons
                 std::ostringstream sql;
                 std::list<BindArgument> args;
                 WhereClauseBuilder2 where;
+                SpatialFilterRef filterRef;
 
                 sql << "UPDATE features SET visible = ?";
                 args.push_back(BindArgument(visible ? 1 : 0));
                 bool emptyResults;
-                code = this->buildParamsWhereClauseCheck(&emptyResults, *params, **fs, where);
+                code = this->buildParamsWhereClauseCheck(&emptyResults, *params, **fs, where, filterRef);
                 if (emptyResults)
                     continue;
 
@@ -2374,12 +2527,13 @@ TAKErr FDB::setFeaturesVisibleImpl(const FeatureQueryParameters &paramsRef, cons
                 std::ostringstream sql;
                 std::list<BindArgument> args;
                 WhereClauseBuilder2 where;
+                SpatialFilterRef filterRef;
 
                 sql << "UPDATE features SET visible = ?";
                 args.push_back(BindArgument(visible ? 1 : 0));
                 bool emptyResults;
                 STLSetAdapter<std::shared_ptr<const FeatureSetDefn>> fsNoCheckAdapter(fsNoCheck);
-                code = this->buildParamsWhereClauseNoCheck(&emptyResults, *params, fsNoCheckAdapter, where);
+                code = this->buildParamsWhereClauseNoCheck(&emptyResults, *params, fsNoCheckAdapter, where, filterRef);
                 TE_CHECKBREAK_CODE(code);
                 if (emptyResults)
                     continue;
@@ -2543,6 +2697,9 @@ TAKErr FDB::setFeatureVersionImpl(const int64_t featureID, const int64_t version
 
     stmt.reset();
 
+    // the version may be rolled back to that of a cached feature
+    this->feature_cache_->evict(featureID);
+
     this->info_dirty_ = true;
 
     return code;
@@ -2558,7 +2715,9 @@ TAKErr FDB::beginBulkModificationImpl() NOTHROWS
 //protected boolean endBulkModificationImpl(boolean successful) {
 TAKErr FDB::endBulkModificationImpl(const bool successful) NOTHROWS
 {
-    // no-op
+    // in-memory state may reflect modifications that were rolled back
+    if (!successful)
+        this->invalidateMemoryStateNoSync();
     return TE_Ok;
 }
 
@@ -2870,6 +3029,10 @@ TAKErr FDB::deleteFeatureSetImpl(const int64_t fsid) NOTHROWS
     // remove from featureSets
     this->feature_sets_.erase(featureSet);
 
+    // FIDs may be reused
+    this->feature_cache_->clear();
+    this->spatial_indices_.erase(fsid);
+
     return code;
 }
 
@@ -2885,6 +3048,9 @@ TAKErr FDB::deleteAllFeatureSetsImpl() NOTHROWS
     code = this->database_->execute("DELETE FROM featuresets", nullptr, 0);
     TE_CHECKRETURN_CODE(code);
 
+    this->feature_cache_->clear();
+    this->spatial_indices_.clear();
+
     return code;
 }
 
@@ -3217,6 +3383,11 @@ TAKErr FDB::insertFeatureImpl(int64_t *fid, InsertContext &ctx, const int64_t fs
     code = Databases_lastInsertRowID(fid, *this->database_);
     TE_CHECKRETURN_CODE(code);
 
+    code = this->updateSpatialIndexNoSync(*fid);
+    TE_CHECKRETURN_CODE(code);
+    code = this->updateSimplifiedGeometriesNoSync(*fid);
+    TE_CHECKRETURN_CODE(code);
+
     return code;
 }
 
@@ -3263,6 +3434,11 @@ TAKErr FDB::updateFeatureImpl(const int64_t fid, const atakmap::feature::Geometr
 
     stmt.reset();
 
+    code = this->updateSpatialIndexNoSync(fid);
+    TE_CHECKRETURN_CODE(code);
+    code = this->updateSimplifiedGeometriesNoSync(fid);
+    TE_CHECKRETURN_CODE(code);
+
     return code;
 }
 
@@ -3532,6 +3708,11 @@ TAKErr FDB::updateFeatureImpl(const int64_t fid, const char *name, const atakmap
 
     stmt.reset();
 
+    code = this->updateSpatialIndexNoSync(fid);
+    TE_CHECKRETURN_CODE(code);
+    code = this->updateSimplifiedGeometriesNoSync(fid);
+    TE_CHECKRETURN_CODE(code);
+
     return code;
 }
 
@@ -3550,6 +3731,11 @@ TAKErr FDB::deleteFeatureImpl(const int64_t fid) NOTHROWS
 
     stmt.reset();
 
+    // FIDs may be reused
+    this->feature_cache_->evict(fid);
+    for (auto it = this->spatial_indices_.begin(); it != this->spatial_indices_.end(); it++)
+        it->second->fids.remove(fid);
+
     // XXX -
     //return (Databases.lastChangeCount(this->database)>0);
     return code;
@@ -3574,6 +3760,9 @@ TAKErr FDB::deleteAllFeaturesImpl(const int64_t fsid) NOTHROWS
 
     stmt.reset();
 
+    this->feature_cache_->clear();
+    this->spatial_indices_.erase(fsid);
+
     // XXX -
     //return (Databases.lastChangeCount(this->database)>0);
     return code;
@@ -3582,7 +3771,7 @@ TAKErr FDB::deleteAllFeaturesImpl(const int64_t fsid) NOTHROWS
 /**************************************************************************/
 
 //private boolean buildParamsWhereClauseNoCheck(FeatureQueryParameters params, Collection<FeatureSetDefn> fs, WhereClauseBuilder whereClause) {
-TAKErr FDB::buildParamsWhereClauseNoCheck(bool *emptyResults, const FeatureQueryParameters &params, Collection<std::shared_ptr<const FeatureSetDefn>> &fs, WhereClauseBuilder2 &whereClause) NOTHROWS
+TAKErr FDB::buildParamsWhereClauseNoCheck(bool *emptyResults, const FeatureQueryParameters &params, Collection<std::shared_ptr<const FeatureSetDefn>> &fs, WhereClauseBuilder2 &whereClause, SpatialFilterRef &filterRef) NOTHROWS
 {
     TAKErr code;
 
@@ -3678,11 +3867,37 @@ TAKErr FDB::buildParamsWhereClauseNoCheck(bool *emptyResults, const FeatureQuery
         }
     }
     if (params.spatialFilter.get()) {
-        code = appendSpatialFilter(*params.spatialFilter,
-            whereClause,
-            indexedSpatialFilter &&
-            this->spatial_index_enabled_);
-        TE_CHECKRETURN_CODE(code);
+        bool memoryFilter = false;
+        if (!fs.empty() && fs.size() <= MAX_MEMORY_INDEXED_FEATURE_SETS) {
+            std::vector<int64_t> fsids;
+            Collection<std::shared_ptr<const FeatureSetDefn>>::IteratorPtr fsIter(nullptr, nullptr);
+            code = fs.iterator(fsIter);
+            TE_CHECKRETURN_CODE(code);
+            do {
+                std::shared_ptr<const FeatureSetDefn> defn;
+                code = fsIter->get(defn);
+                TE_CHECKBREAK_CODE(code);
+                fsids.push_back(defn->fsid);
+                code = fsIter->next();
+                TE_CHECKBREAK_CODE(code);
+            } while (true);
+            if (code == TE_Done)
+                code = TE_Ok;
+            TE_CHECKRETURN_CODE(code);
+
+            *emptyResults = false;
+            code = this->appendMemorySpatialFilter(&memoryFilter, emptyResults, *params.spatialFilter, fsids.data(), fsids.size(), whereClause, filterRef);
+            TE_CHECKRETURN_CODE(code);
+            if (*emptyResults)
+                return code;
+        }
+        if (!memoryFilter) {
+            code = appendSpatialFilter(*params.spatialFilter,
+                whereClause,
+                indexedSpatialFilter &&
+                this->spatial_index_enabled_);
+            TE_CHECKRETURN_CODE(code);
+        }
     }
 
     *emptyResults = false;
@@ -3690,7 +3905,7 @@ TAKErr FDB::buildParamsWhereClauseNoCheck(bool *emptyResults, const FeatureQuery
 }
 
 //private boolean buildParamsWhereClauseCheck(FeatureQueryParameters params, FeatureSetDefn defn, WhereClauseBuilder whereClause) {
-TAKErr FDB::buildParamsWhereClauseCheck(bool *emptyResults, const FeatureQueryParameters &params, const FeatureSetDefn &defn, WhereClauseBuilder2 &whereClause) NOTHROWS
+TAKErr FDB::buildParamsWhereClauseCheck(bool *emptyResults, const FeatureQueryParameters &params, const FeatureSetDefn &defn, WhereClauseBuilder2 &whereClause, SpatialFilterRef &filterRef) NOTHROWS
 {
     using namespace atakmap::raster::osm;
 
@@ -3842,11 +4057,19 @@ TAKErr FDB::buildParamsWhereClauseCheck(bool *emptyResults, const FeatureQueryPa
         }
     }
     if (params.spatialFilter.get()) {
-        code = appendSpatialFilter(*params.spatialFilter,
-            whereClause,
-            indexedSpatialFilter &&
-            this->spatial_index_enabled_);
+        bool memoryFilter = false;
+        *emptyResults = false;
+        code = this->appendMemorySpatialFilter(&memoryFilter, emptyResults, *params.spatialFilter, &defn.fsid, 1u, whereClause, filterRef);
         TE_CHECKRETURN_CODE(code);
+        if (*emptyResults)
+            return code;
+        if (!memoryFilter) {
+            code = appendSpatialFilter(*params.spatialFilter,
+                whereClause,
+                indexedSpatialFilter &&
+                this->spatial_index_enabled_);
+            TE_CHECKRETURN_CODE(code);
+        }
     }
 
     whereClause.beginCondition();
@@ -3857,6 +4080,356 @@ TAKErr FDB::buildParamsWhereClauseCheck(bool *emptyResults, const FeatureQueryPa
     return code;
 }
 
+TAKErr FDB::appendMemorySpatialFilter(bool *applied, bool *emptyResults, const atakmap::feature::Geometry &filter, const int64_t *fsids, const std::size_t count, WhereClauseBuilder2 &whereClause, SpatialFilterRef &filterRef) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    *applied = false;
+    if (!this->memory_spatial_index_limit_ || count > MAX_MEMORY_INDEXED_FEATURE_SETS)
+        return code;
+
+    std::shared_ptr<FeatureSetSpatialIndex> indices[MAX_MEMORY_INDEXED_FEATURE_SETS];
+    for (std::size_t i = 0u; i < count; i++) {
+        code = this->validateSpatialIndexNoSync(indices[i], fsids[i]);
+        TE_CHECKRETURN_CODE(code);
+        if (indices[i]->oversize)
+            return code;
+    }
+
+    atakmap::feature::Envelope mbb;
+    try {
+        mbb = filter.getEnvelope();
+    } catch (...) {
+        return TE_Err;
+    }
+
+    std::vector<int64_t> fids;
+    for (std::size_t i = 0u; i < count; i++) {
+        code = indices[i]->fids.query(fids, mbb.minX, mbb.minY, mbb.maxX, mbb.maxY);
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    *applied = true;
+    if (fids.empty()) {
+        *emptyResults = true;
+        return code;
+    }
+
+    // the FIDs are staged in a temporary table, rather than inlined into
+    // the query, so that the query text is constant and the host parameter
+    // limit does not apply. the table is created on demand as it does not
+    // survive the rollback of the transaction that created it
+    code = this->database_->execute("CREATE TEMP TABLE IF NOT EXISTS spatial_filter_fids (filter_id INTEGER, fid INTEGER, PRIMARY KEY (filter_id, fid))", nullptr, 0);
+    TE_CHECKRETURN_CODE(code);
+    code = this->purgeSpatialFiltersNoSync();
+    TE_CHECKRETURN_CODE(code);
+
+    const int64_t filterId = this->next_spatial_filter_id_++;
+
+    bool inTransaction;
+    code = this->database_->inTransaction(&inTransaction);
+    TE_CHECKRETURN_CODE(code);
+    const bool transaction = !inTransaction && (this->database_->beginTransaction() == TE_Ok);
+    do {
+        StatementPtr stmt(nullptr, nullptr);
+        code = this->database_->compileStatement(stmt, "INSERT OR IGNORE INTO temp.spatial_filter_fids (filter_id, fid) VALUES (?, ?)");
+        TE_CHECKBREAK_CODE(code);
+        for (std::size_t i = 0u; i < fids.size(); i++) {
+            code = stmt->clearBindings();
+            TE_CHECKBREAK_CODE(code);
+            code = stmt->bindLong(1, filterId);
+            TE_CHECKBREAK_CODE(code);
+            code = stmt->bindLong(2, fids[i]);
+            TE_CHECKBREAK_CODE(code);
+            code = stmt->execute();
+            TE_CHECKBREAK_CODE(code);
+        }
+    } while (false);
+    if (transaction) {
+        if (code == TE_Ok)
+            code = this->database_->setTransactionSuccessful();
+        const TAKErr endCode = this->database_->endTransaction();
+        if (code == TE_Ok)
+            code = endCode;
+    }
+    if (code != TE_Ok) {
+        // any rows staged before the failure are purged with the next filter
+        this->spatial_filters_[filterId] = std::weak_ptr<const int64_t>();
+        return code;
+    }
+
+    filterRef = SpatialFilterRef(new int64_t(filterId));
+    this->spatial_filters_[filterId] = filterRef;
+
+    whereClause.beginCondition();
+    code = whereClause.append("features.fid IN (SELECT fid FROM temp.spatial_filter_fids WHERE filter_id = ?)");
+    TE_CHECKRETURN_CODE(code);
+    code = whereClause.addArg(BindArgument(filterId));
+    TE_CHECKRETURN_CODE(code);
+
+    return code;
+}
+
+TAKErr FDB::purgeSpatialFiltersNoSync() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    StatementPtr stmt(nullptr, nullptr);
+    for (auto it = this->spatial_filters_.begin(); it != this->spatial_filters_.end(); ) {
+        if (!it->second.expired()) {
+            it++;
+            continue;
+        }
+        if (!stmt.get()) {
+            code = this->database_->compileStatement(stmt, "DELETE FROM temp.spatial_filter_fids WHERE filter_id = ?");
+            TE_CHECKRETURN_CODE(code);
+        }
+        code = stmt->clearBindings();
+        TE_CHECKRETURN_CODE(code);
+        code = stmt->bindLong(1, it->first);
+        TE_CHECKRETURN_CODE(code);
+        code = stmt->execute();
+        TE_CHECKRETURN_CODE(code);
+        it = this->spatial_filters_.erase(it);
+    }
+    return code;
+}
+
+void FDB::invalidateMemoryStateNoSync() NOTHROWS
+{
+    this->feature_cache_->clear();
+    this->spatial_indices_.clear();
+}
+
+TAKErr FDB::validateSpatialIndexNoSync(std::shared_ptr<FeatureSetSpatialIndex> &value, const int64_t fsid) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    auto entry = this->spatial_indices_.find(fsid);
+    if (entry != this->spatial_indices_.end()) {
+        value = entry->second;
+        return code;
+    }
+
+    std::shared_ptr<FeatureSetSpatialIndex> index(new FeatureSetSpatialIndex());
+
+    QueryPtr query(nullptr, nullptr);
+    code = this->database_->compileQuery(query,
+                                         "SELECT fid, MbrMinX(geometry), MbrMinY(geometry), MbrMaxX(geometry), MbrMaxY(geometry) "
+                                         "FROM features WHERE fsid = ? LIMIT ?");
+    TE_CHECKRETURN_CODE(code);
+    code = query->bindLong(1, fsid);
+    TE_CHECKRETURN_CODE(code);
+    // one more than the limit to detect oversize feature sets
+    code = query->bindLong(2, static_cast<int64_t>(this->memory_spatial_index_limit_) + 1LL);
+    TE_CHECKRETURN_CODE(code);
+
+    std::vector<int64_t> fids;
+    std::vector<PackedRTree<int64_t>::Bounds> bounds;
+    std::size_t rows = 0u;
+    do {
+        code = query->moveToNext();
+        TE_CHECKBREAK_CODE(code);
+        if (++rows > this->memory_spatial_index_limit_) {
+            index->oversize = true;
+            break;
+        }
+
+        // no geometry
+        bool isNull;
+        code = query->isNull(&isNull, 1u);
+        TE_CHECKBREAK_CODE(code);
+        if (isNull)
+            continue;
+
+        int64_t fid;
+        code = query->getLong(&fid, 0u);
+        TE_CHECKBREAK_CODE(code);
+        PackedRTree<int64_t>::Bounds mbb;
+        code = query->getDouble(&mbb.minX, 1u);
+        TE_CHECKBREAK_CODE(code);
+        code = query->getDouble(&mbb.minY, 2u);
+        TE_CHECKBREAK_CODE(code);
+        code = query->getDouble(&mbb.maxX, 3u);
+        TE_CHECKBREAK_CODE(code);
+        code = query->getDouble(&mbb.maxY, 4u);
+        TE_CHECKBREAK_CODE(code);
+
+        fids.push_back(fid);
+        bounds.push_back(mbb);
+    } while (true);
+    if (code == TE_Done)
+        code = TE_Ok;
+    TE_CHECKRETURN_CODE(code);
+    query.reset();
+
+    if (!index->oversize) {
+        code = index->fids.load(fids.data(), bounds.data(), fids.size());
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    this->spatial_indices_[fsid] = index;
+    value = index;
+    return code;
+}
+
+TAKErr FDB::updateSpatialIndexNoSync(const int64_t fid) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (this->spatial_indices_.empty())
+        return code;
+
+    QueryPtr query(nullptr, nullptr);
+    code = this->database_->compileQuery(query,
+                                         "SELECT fsid, MbrMinX(geometry), MbrMinY(geometry), MbrMaxX(geometry), MbrMaxY(geometry) "
+                                         "FROM features WHERE fid = ?");
+    TE_CHECKRETURN_CODE(code);
+    code = query->bindLong(1, fid);
+    TE_CHECKRETURN_CODE(code);
+    code = query->moveToNext();
+    if (code == TE_Done) {
+        for (auto it = this->spatial_indices_.begin(); it != this->spatial_indices_.end(); it++)
+            it->second->fids.remove(fid);
+        return TE_Ok;
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    int64_t fsid;
+    code = query->getLong(&fsid, 0u);
+    TE_CHECKRETURN_CODE(code);
+    auto entry = this->spatial_indices_.find(fsid);
+    if (entry == this->spatial_indices_.end() || entry->second->oversize)
+        return code;
+
+    FeatureSetSpatialIndex &index = *entry->second;
+    index.fids.remove(fid);
+
+    bool isNull;
+    code = query->isNull(&isNull, 1u);
+    TE_CHECKRETURN_CODE(code);
+    if (isNull)
+        return code;
+
+    PackedRTree<int64_t>::Bounds mbb;
+    code = query->getDouble(&mbb.minX, 1u);
+    TE_CHECKRETURN_CODE(code);
+    code = query->getDouble(&mbb.minY, 2u);
+    TE_CHECKRETURN_CODE(code);
+    code = query->getDouble(&mbb.maxX, 3u);
+    TE_CHECKRETURN_CODE(code);
+    code = query->getDouble(&mbb.maxY, 4u);
+    TE_CHECKRETURN_CODE(code);
+
+    if (index.fids.size() >= this->memory_spatial_index_limit_) {
+        // the feature set has outgrown the in-memory index
+        index.oversize = true;
+        index.fids.clear();
+        return code;
+    }
+    code = index.fids.insert(fid, mbb);
+    TE_CHECKRETURN_CODE(code);
+
+    return code;
+}
+
+TAKErr FDB::validateSimplifiedGeometriesNoSync() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    std::vector<Port::String> tableNames;
+    Port::STLVectorAdapter<Port::String> tableNamesV(tableNames);
+    code = Databases_getTableNames(tableNamesV, *this->database_);
+    TE_CHECKRETURN_CODE(code);
+
+    Port::String simplifiedStr("simplified_geometries");
+    code = tableNamesV.contains(&this->simplified_geometries_, simplifiedStr);
+    TE_CHECKRETURN_CODE(code);
+    if (this->simplified_geometries_ || !this->simplified_levels_)
+        return code;
+
+    code = this->database_->execute(
+        "CREATE TABLE simplified_geometries"
+        "    (fid INTEGER,"
+        "     level INTEGER,"
+        "     geometry BLOB,"
+        "     PRIMARY KEY (fid, level))",
+        nullptr, 0);
+    TE_CHECKRETURN_CODE(code);
+    // the triggers keep the table consistent with the features, even if
+    // the database is later opened with simplification disabled
+    code = this->database_->execute(
+        "CREATE TRIGGER IF NOT EXISTS features_geometry_simplified_update AFTER UPDATE OF geometry ON features "
+        "BEGIN "
+        "DELETE FROM simplified_geometries WHERE fid = OLD.fid; "
+        "END;", nullptr, 0);
+    TE_CHECKRETURN_CODE(code);
+    code = this->database_->execute(
+        "CREATE TRIGGER IF NOT EXISTS features_simplified_delete AFTER DELETE ON features "
+        "FOR EACH ROW "
+        "BEGIN "
+        "DELETE FROM simplified_geometries WHERE fid = OLD.fid; "
+        "END;", nullptr, 0);
+    TE_CHECKRETURN_CODE(code);
+
+    this->simplified_geometries_ = true;
+    return code;
+}
+
+TAKErr FDB::updateSimplifiedGeometriesNoSync(const int64_t fid) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!this->simplified_levels_ || !this->simplified_geometries_)
+        return code;
+
+    // each level is simplified from the previous, finer, level. a level is
+    // only stored while the geometry has enough points to be worth reducing
+    StatementPtr fromFeature(nullptr, nullptr);
+    code = this->database_->compileStatement(fromFeature,
+        "INSERT OR REPLACE INTO simplified_geometries (fid, level, geometry) "
+        "SELECT fid, 0, SimplifyPreserveTopology(geometry, ?) FROM features "
+        "WHERE fid = ? AND ST_NPoints(geometry) > ?");
+    TE_CHECKRETURN_CODE(code);
+    code = fromFeature->bindDouble(1, SIMPLIFIED_BASE_TOLERANCE);
+    TE_CHECKRETURN_CODE(code);
+    code = fromFeature->bindLong(2, fid);
+    TE_CHECKRETURN_CODE(code);
+    code = fromFeature->bindInt(3, SIMPLIFIED_MIN_POINTS);
+    TE_CHECKRETURN_CODE(code);
+    code = fromFeature->execute();
+    TE_CHECK_CODE_LOG_DB_ERRMSG(code, this->database_);
+    TE_CHECKRETURN_CODE(code);
+    fromFeature.reset();
+
+    StatementPtr fromLevel(nullptr, nullptr);
+    double tolerance = SIMPLIFIED_BASE_TOLERANCE;
+    for (std::size_t level = 1u; level < this->simplified_levels_; level++) {
+        tolerance *= SIMPLIFIED_LEVEL_STEP;
+        if (!fromLevel.get()) {
+            code = this->database_->compileStatement(fromLevel,
+                "INSERT OR REPLACE INTO simplified_geometries (fid, level, geometry) "
+                "SELECT fid, ?, SimplifyPreserveTopology(geometry, ?) FROM simplified_geometries "
+                "WHERE fid = ? AND level = ? AND ST_NPoints(geometry) > ?");
+            TE_CHECKBREAK_CODE(code);
+        } else {
+            code = fromLevel->clearBindings();
+            TE_CHECKBREAK_CODE(code);
+        }
+        code = fromLevel->bindInt(1, static_cast<int>(level));
+        TE_CHECKBREAK_CODE(code);
+        code = fromLevel->bindDouble(2, tolerance);
+        TE_CHECKBREAK_CODE(code);
+        code = fromLevel->bindLong(3, fid);
+        TE_CHECKBREAK_CODE(code);
+        code = fromLevel->bindInt(4, static_cast<int>(level - 1u));
+        TE_CHECKBREAK_CODE(code);
+        code = fromLevel->bindInt(5, SIMPLIFIED_MIN_POINTS);
+        TE_CHECKBREAK_CODE(code);
+        code = fromLevel->execute();
+        TE_CHECK_CODE_LOG_DB_ERRMSG(code, this->database_);
+        TE_CHECKBREAK_CODE(code);
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    return code;
+}
+
 /**************************************************************************/
 
 //private static AttributeSpec insertAttrSchema(InsertContext ctx, DatabaseIface database, String key, AttributeSet metadata) {
@@ -3915,13 +4488,21 @@ TAKErr FDB::encodeAttributes(FDB &impl, InsertContext &ctx, const atakmap::util:
     code = ctx.codedAttribs.reset();
     TE_CHECKRETURN_CODE(code);
 
+    // the dictionaries must be current before any values are added
+    code = impl.validateAttributeSchema();
+    TE_CHECKRETURN_CODE(code);
+
     DynamicOutput &dos = ctx.codedAttribs;
 
     std::vector<const char *> keys = metadata.getAttributeNames();
 
-    code = dos.writeInt(1); // version
+    const bool compact = impl.compact_attributes_;
+    code = dos.writeInt(compact ? COMPACT_ATTRIBUTES_VERSION : 1); // version
     TE_CHECKRETURN_CODE(code);
-    code = dos.writeInt(static_cast<int32_t>(keys.size())); // number of entries
+    if (compact)
+        code = writeVarint(dos, keys.size()); // number of entries
+    else
+        code = dos.writeInt(static_cast<int32_t>(keys.size())); // number of entries
     TE_CHECKRETURN_CODE(code);
 
     std::vector<const char *>::iterator key;
@@ -3965,9 +4546,18 @@ TAKErr FDB::encodeAttributes(FDB &impl, InsertContext &ctx, const atakmap::util:
             }
         }
 
-        code = dos.writeInt((int)schemaSpec->id);
+        if (compact)
+            code = writeVarint(dos, static_cast<uint64_t>(schemaSpec->id));
+        else
+            code = dos.writeInt((int)schemaSpec->id);
         TE_CHECKBREAK_CODE(code);
-        if (schemaSpec->type != 5) {
+        if (compact && (schemaSpec->type == 0 || schemaSpec->type == 1)) {
+            code = writeZigZag(dos, (schemaSpec->type == 0) ? metadata.getInt(*key) : metadata.getLong(*key));
+            TE_CHECKBREAK_CODE(code);
+        } else if (compact && schemaSpec->type == 3) {
+            code = encodeStringValue(impl, ctx, dos, *schemaSpec, metadata.getString(*key));
+            TE_CHECKBREAK_CODE(code);
+        } else if (schemaSpec->type != 5) {
             code = schemaSpec->coder.encode(dos, metadata, *key);
             TE_CHECKBREAK_CODE(code);
         } else {
@@ -3998,17 +4588,17 @@ TAKErr FDB::decodeAttributes(AttributeSetPtr_const &result, const uint8_t *blob,
         return TE_Ok;
     }
 
-    std::unique_ptr<MemoryInput2> dis(new MemoryInput2());
-    code = dis->open(blob, blobLen);
+    MemoryInput2 dis;
+    code = dis.open(blob, blobLen);
     TE_CHECKRETURN_CODE(code);
 
-    code = decodeAttributesImpl(result, *dis, schema);
+    code = decodeAttributesImpl(result, dis, schema);
     TE_CHECKRETURN_CODE(code);
 
     return code;
 }
 
-TAKErr FDB::decodeAttributesImpl(AttributeSetPtr_const &result , DataInput2 &dis, FDB::IdAttrSchemaMap &schema) NOTHROWS
+TAKErr FDB::decodeAttributesImpl(AttributeSetPtr_const &result , MemoryInput2 &dis, FDB::IdAttrSchemaMap &schema) NOTHROWS
 {
     using namespace atakmap::util;
 
@@ -4018,31 +4608,61 @@ TAKErr FDB::decodeAttributesImpl(AttributeSetPtr_const &result , DataInput2 &dis
     code = dis.readInt(&version);
     TE_CHECKRETURN_CODE(code);
 
-    if (version != 1) {
+    if (version != 1 && version != COMPACT_ATTRIBUTES_VERSION) {
         Logger::log(Logger::Error, ABS_TAG ": Bad AttributeSet coding version: %d", version);
         return TE_InvalidArg;
     }
+    const bool compact = (version == COMPACT_ATTRIBUTES_VERSION);
 
-    int numKeys;
-    code = dis.readInt(&numKeys); // number of entries
+    uint64_t numKeys;
+    if (compact) {
+        code = readVarint(&numKeys, dis); // number of entries
+    } else {
+        int numKeys32;
+        code = dis.readInt(&numKeys32); // number of entries
+        numKeys = static_cast<uint64_t>(std::max(numKeys32, 0));
+    }
     TE_CHECKRETURN_CODE(code);
 
     std::unique_ptr<AttributeSet> retval(new AttributeSet());
 
 
-    for (int i = 0; i < numKeys; i++) {
-        int schemaSpecId;
-        code = dis.readInt(&schemaSpecId);
+    for (uint64_t i = 0u; i < numKeys; i++) {
+        int64_t schemaSpecId;
+        if (compact) {
+            uint64_t id;
+            code = readVarint(&id, dis);
+            schemaSpecId = static_cast<int64_t>(id);
+        } else {
+            int id;
+            code = dis.readInt(&id);
+            schemaSpecId = id;
+        }
         TE_CHECKBREAK_CODE(code);
 
         IdAttrSchemaMap::iterator schemaSpec;
         schemaSpec = schema.find(schemaSpecId);
         if (schemaSpec == schema.end()) {
-            Logger::log(Logger::Error, ABS_TAG ": Unable to located AttributeSpec schema ID %d", schemaSpecId);
+            Logger::log(Logger::Error, ABS_TAG ": Unable to located AttributeSpec schema ID %lld", static_cast<long long>(schemaSpecId));
             return TE_InvalidArg;
         }
 
-        if (schemaSpec->second->type != 5) {
+        if (compact && (schemaSpec->second->type == 0 || schemaSpec->second->type == 1)) {
+            int64_t value;
+            code = readZigZag(&value, dis);
+            TE_CHECKBREAK_CODE(code);
+            try {
+                if (schemaSpec->second->type == 0)
+                    retval->setInt(schemaSpec->second->key, static_cast<int>(value));
+                else
+                    retval->setLong(schemaSpec->second->key, value);
+            } catch (...) {
+                return TE_Err;
+            }
+        } else if (compact && schemaSpec->second->type == 3) {
+            code = decodeStringValue(*retval, dis, *schemaSpec->second);
+            TE_CHECKBREAK_CODE(code);
+        } else if (schemaSpec->second->type != 5) {
             code = schemaSpec->second->coder.decode(*retval, dis, schemaSpec->second->key);
             TE_CHECKBREAK_CODE(code);
         } else {
@@ -4060,6 +4680,96 @@ TAKErr FDB::decodeAttributesImpl(AttributeSetPtr_const &result , DataInput2 &dis
     return code;
 }
 
+TAKErr FDB::encodeStringValue(FDB &impl, InsertContext &ctx, DynamicOutput &dos, AttributeSpec &spec, const char *value) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    // code 0 is the empty string, which the fixed width coding also reads
+    // back as null; code 1 is an inline value; codes 2+ index the dictionary
+    const std::size_t len = value ? strlen(value) : 0u;
+    if (!len)
+        return writeVarint(dos, 0u);
+
+    auto entry = spec.valueCodes.find(value);
+    if (entry != spec.valueCodes.end())
+        return writeVarint(dos, entry->second + 2u);
+
+    if (spec.values.size() < MAX_ATTRIBUTE_DICTIONARY_SIZE && len <= MAX_ATTRIBUTE_DICTIONARY_VALUE_LENGTH) {
+        if (!impl.attr_values_table_) {
+            code = impl.database_->execute(
+                "CREATE TABLE IF NOT EXISTS attribs_values"
+                "    (schema_id INTEGER,"
+                "     code INTEGER,"
+                "     value TEXT,"
+                "     PRIMARY KEY (schema_id, code))",
+                nullptr, 0);
+            TE_CHECKRETURN_CODE(code);
+            impl.attr_values_table_ = true;
+        }
+        if (!ctx.insertAttributeValueStatement.get()) {
+            code = impl.database_->compileStatement(ctx.insertAttributeValueStatement, "INSERT INTO attribs_values (schema_id, code, value) VALUES (?, ?, ?)");
+            TE_CHECKRETURN_CODE(code);
+        }
+        const std::size_t valueCode = spec.values.size();
+        code = ctx.insertAttributeValueStatement->bindLong(1, spec.id);
+        TE_CHECKRETURN_CODE(code);
+        code = ctx.insertAttributeValueStatement->bindInt(2, static_cast<int>(valueCode));
+        TE_CHECKRETURN_CODE(code);
+        code = ctx.insertAttributeValueStatement->bindString(3, value);
+        TE_CHECKRETURN_CODE(code);
+        code = ctx.insertAttributeValueStatement->execute();
+        TE_CHECKRETURN_CODE(code);
+        code = ctx.insertAttributeValueStatement->clearBindings();
+        TE_CHECKRETURN_CODE(code);
+
+        spec.values.push_back(value);
+        spec.valueCodes[spec.values.back()] = valueCode;
+        return writeVarint(dos, valueCode + 2u);
+    }
+
+    code = writeVarint(dos, 1u);
+    TE_CHECKRETURN_CODE(code);
+    code = writeVarint(dos, len);
+    TE_CHECKRETURN_CODE(code);
+    code = dos.write(reinterpret_cast<const uint8_t *>(value), len);
+    TE_CHECKRETURN_CODE(code);
+    return code;
+}
+
+TAKErr FDB::decodeStringValue(atakmap::util::AttributeSet &attr, MemoryInput2 &dis, const AttributeSpec &spec) NOTHROWS
+{
+    TAKErr code;
+    uint64_t valueCode;
+    code = readVarint(&valueCode, dis);
+    TE_CHECKRETURN_CODE(code);
+    try {
+        if (!valueCode) {
+            attr.setString(spec.key, nullptr);
+        } else if (valueCode == 1u) {
+            uint64_t len;
+            code = readVarint(&len, dis);
+            TE_CHECKRETURN_CODE(code);
+            std::size_t remaining;
+            code = dis.remaining(&remaining);
+            TE_CHECKRETURN_CODE(code);
+            if (len > remaining)
+                return TE_IO;
+            const uint8_t *value;
+            code = dis.readSpan(&value, static_cast<std::size_t>(len));
+            TE_CHECKRETURN_CODE(code);
+            attr.setString(spec.key, std::string(reinterpret_cast<const char *>(value), static_cast<std::size_t>(len)).c_str());
+        } else if ((valueCode - 2u) < spec.values.size()) {
+            attr.setString(spec.key, spec.values[static_cast<std::size_t>(valueCode - 2u)]);
+        } else {
+            atakmap::util::Logger::log(atakmap::util::Logger::Error, ABS_TAG ": Unable to locate value %llu for attribute %s", static_cast<unsigned long long>(valueCode - 2u), spec.key.get());
+            return TE_InvalidArg;
+        }
+    } catch (...) {
+        return TE_Err;
+    }
+    return code;
+}
+
 /*****************************************************************/
 // AttributeSpec
 
@@ -4111,12 +4821,94 @@ TAKErr FDB::AttributeSpec::initCoders() NOTHROWS
     return TE_Ok;
 }
 
+/**************************************************************************/
+// FeatureCache
+
+FDB::FeatureCache::FeatureCache(const std::size_t limit_) NOTHROWS :
+    limit(limit_),
+    size(0u)
+{}
+
+std::shared_ptr<const Feature2> FDB::FeatureCache::get(const int64_t fid, const int64_t version) NOTHROWS
+{
+    if (!limit)
+        return std::shared_ptr<const Feature2>();
+    Lock lock(mutex);
+    if (lock.status != TE_Ok)
+        return std::shared_ptr<const Feature2>();
+    auto entry = index.find(fid);
+    if (entry == index.end() || entry->second->version != version)
+        return std::shared_ptr<const Feature2>();
+    // move to most recently used
+    entries.splice(entries.begin(), entries, entry->second);
+    return entry->second->feature;
+}
+
+void FDB::FeatureCache::put(const std::shared_ptr<const Feature2> &feature, const std::size_t featureSize) NOTHROWS
+{
+    if (featureSize > limit)
+        return;
+    Lock lock(mutex);
+    if (lock.status != TE_Ok)
+        return;
+    auto entry = index.find(feature->getId());
+    if (entry != index.end()) {
+        size -= entry->second->size;
+        entries.erase(entry->second);
+        index.erase(entry);
+    }
+
+    Entry e;
+    e.fid = feature->getId();
+    e.version = feature->getVersion();
+    e.size = featureSize;
+    e.feature = feature;
+    entries.push_front(e);
+    index[e.fid] = entries.begin();
+    size += featureSize;
+
+    trimNoSync();
+}
+
+void FDB::FeatureCache::evict(const int64_t fid) NOTHROWS
+{
+    Lock lock(mutex);
+    if (lock.status != TE_Ok)
+        return;
+    auto entry = index.find(fid);
+    if (entry == index.end())
+        return;
+    size -= entry->second->size;
+    entries.erase(entry->second);
+    index.erase(entry);
+}
+
+void FDB::FeatureCache::clear() NOTHROWS
+{
+    Lock lock(mutex);
+    if (lock.status != TE_Ok)
+        return;
+    index.clear();
+    entries.clear();
+    size = 0u;
+}
+
+void FDB::FeatureCache::trimNoSync() NOTHROWS
+{
+    while (size > limit && !entries.empty()) {
+        size -= entries.back().size;
+        index.erase(entries.back().fid);
+        entries.pop_back();
+    }
+}
+
 /**************************************************************************/
 // FeatureCursorImpl
 
 FDB::FeatureCursorImpl::FeatureCursorImpl(FDB &owner_, QueryPtr &&filter_, const int idCol_, const int fsidCol_, const int versionCol_,
                                           const int nameCol_, const int geomCol_, const int styleCol_, const int attribsCol_,
-                                          const int altitudeModeCol_, const int extrudeCol_) NOTHROWS : CursorWrapper2(std::move(filter_)),
+                                          const int altitudeModeCol_, const int extrudeCol_, const int styleIdCol_, const bool cacheRows_,
+                                          const SpatialFilterRef &filterRef_) NOTHROWS : CursorWrapper2(std::move(filter_)),
                                                                                                         owner(owner_),
                                                                                                         idCol(idCol_),
                                                                                                         fsidCol(fsidCol_),
@@ -4127,8 +4919,11 @@ FDB::FeatureCursorImpl::FeatureCursorImpl(FDB &owner_, QueryPtr &&filter_, const
                                                                                                         versionCol(versionCol_),
                                                                                                         altitudeModeCol(altitudeModeCol_),
                                                                                                         extrudeCol(extrudeCol_),
-                                                                                                        rowFeature(nullptr, nullptr),
-                                                                                                        rowAttribs(nullptr, nullptr) {}
+                                                                                                        styleIdCol(styleIdCol_),
+                                                                                                        cacheRows(cacheRows_),
+                                                                                                        filterRef(filterRef_),
+                                                                                                        rowAttribs(nullptr, nullptr),
+                                                                                                        rowCacheChecked(false) {}
 
 TAKErr FDB::FeatureCursorImpl::getId(int64_t *value) NOTHROWS
 {
@@ -4215,6 +5010,14 @@ TAKErr FDB::FeatureCursorImpl::getAttributes(const atakmap::util::AttributeSet *
         return TE_Ok;
     }
 
+    // don't decode if the feature has already been decoded
+    code = this->validateCachedRow();
+    TE_CHECKRETURN_CODE(code);
+    if (this->rowFeature.get()) {
+        *value = this->rowFeature->getAttributes();
+        return TE_Ok;
+    }
+
     const uint8_t *attribsBlob;
     std::size_t attribsBlobLen;
     code = this->filter->getBlob(&attribsBlob, &attribsBlobLen, this->attribsCol);
@@ -4237,6 +5040,8 @@ TAKErr FDB::FeatureCursorImpl::getAttributes(const atakmap::util::AttributeSet *
 TAKErr FDB::FeatureCursorImpl::get(const Feature2 **feature) NOTHROWS
 {
     TAKErr code;
+    code = this->validateCachedRow();
+    TE_CHECKRETURN_CODE(code);
     if (!this->rowFeature.get()) {
         int64_t fid;
         code = this->getId(&fid);
@@ -4248,8 +5053,27 @@ TAKErr FDB::FeatureCursorImpl::get(const Feature2 **feature) NOTHROWS
         code = this->getVersion(&version);
         TE_CHECKRETURN_CODE(code);
 
-        code = Feature_create(rowFeature, fid, fsid, *this, version);
+        FeaturePtr_const decoded(nullptr, nullptr);
+        code = Feature_create(decoded, fid, fsid, *this, version);
         TE_CHECKRETURN_CODE(code);
+        this->rowFeature = std::move(decoded);
+
+        if (this->cacheRows) {
+            // estimate the decoded size from the encoded row
+            std::size_t featureSize = sizeof(Feature2);
+            const uint8_t *blob;
+            std::size_t blobLen;
+            if (this->geomCol >= 0 && this->filter->getBlob(&blob, &blobLen, this->geomCol) == TE_Ok)
+                featureSize += 2u*blobLen;
+            if (this->attribsCol >= 0 && this->filter->getBlob(&blob, &blobLen, this->attribsCol) == TE_Ok)
+                featureSize += 4u*blobLen;
+            const char *text;
+            if (this->styleCol >= 0 && this->filter->getString(&text, this->styleCol) == TE_Ok && text)
+                featureSize += 2u*strlen(text);
+            if (this->nameCol >= 0 && this->filter->getString(&text, this->nameCol) == TE_Ok && text)
+                featureSize += strlen(text);
+            owner.feature_cache_->put(this->rowFeature, featureSize);
+        }
     }
     *feature = this->rowFeature.get();
     code = TE_Ok;
@@ -4266,9 +5090,102 @@ TAKErr FDB::FeatureCursorImpl::moveToNext() NOTHROWS
 {
     rowFeature.reset();
     rowAttribs.reset();
+    rowCacheChecked = false;
     return this->filter->moveToNext();
 }
 
+TAKErr FDB::FeatureCursorImpl::fetch(std::size_t *count, FeatureColumns &columns, const std::size_t limit) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!count)
+        return TE_InvalidArg;
+    *count = 0u;
+    if (columns.geometries && !columns.geometryData)
+        return TE_InvalidArg;
+    if (columns.geometries) {
+        code = columns.geometryData->reset();
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    rowFeature.reset();
+    rowAttribs.reset();
+    rowCacheChecked = false;
+
+    // read the columns directly from the query
+    std::size_t row = 0u;
+    for ( ; row < limit; row++) {
+        code = this->filter->moveToNext();
+        TE_CHECKBREAK_CODE(code);
+
+        if (columns.ids) {
+            code = this->filter->getLong(columns.ids + row, this->idCol);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.featureSetIds) {
+            code = this->filter->getLong(columns.featureSetIds + row, this->fsidCol);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.versions) {
+            code = this->filter->getLong(columns.versions + row, this->versionCol);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.geometries) {
+            RawData raw;
+            raw.binary.value = nullptr;
+            raw.binary.len = 0u;
+            if (this->geomCol >= 0) {
+                code = this->filter->getBlob(&raw.binary.value, &raw.binary.len, this->geomCol);
+                TE_CHECKBREAK_CODE(code);
+            }
+            code = FeatureColumns_setGeometry(columns, row, GeomBlob, raw);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.styleIds) {
+            bool isNull = true;
+            if (this->styleIdCol >= 0) {
+                code = this->filter->isNull(&isNull, this->styleIdCol);
+                TE_CHECKBREAK_CODE(code);
+            }
+            if (isNull) {
+                columns.styleIds[row] = -1LL;
+            } else {
+                code = this->filter->getLong(columns.styleIds + row, this->styleIdCol);
+                TE_CHECKBREAK_CODE(code);
+            }
+        }
+    }
+    if (code == TE_Done)
+        code = TE_Ok;
+    TE_CHECKRETURN_CODE(code);
+
+    if (columns.geometries) {
+        code = FeatureColumns_resolveGeometries(columns, GeomBlob, row);
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    *count = row;
+    return row ? TE_Ok : TE_Done;
+}
+
+TAKErr FDB::FeatureCursorImpl::validateCachedRow() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (this->rowCacheChecked)
+        return code;
+    this->rowCacheChecked = true;
+    if (!this->cacheRows)
+        return code;
+
+    int64_t fid;
+    code = this->getId(&fid);
+    TE_CHECKRETURN_CODE(code);
+    int64_t version;
+    code = this->getVersion(&version);
+    TE_CHECKRETURN_CODE(code);
+    this->rowFeature = owner.feature_cache_->get(fid, version);
+    return code;
+}
+
 /**************************************************************************/
 // FeatureSetCursorImpl
 
@@ -4317,6 +5234,7 @@ FDB::InsertContext::InsertContext() NOTHROWS :
     insertStyleStatement(nullptr, nullptr),
     insertAttributesStatement(nullptr, nullptr),
     insertAttributeSchemaStatement(nullptr, nullptr),
+    insertAttributeValueStatement(nullptr, nullptr),
     insertGeomArg(nullptr, 0u)
 {
     codedAttribs.open(512);
@@ -4327,7 +5245,8 @@ FDB::InsertContext::~InsertContext() NOTHROWS
 
 
 FDB::Builder::Builder(FDB &db_) NOTHROWS :
-    db(db_)
+    db(db_),
+    rebuildIndices(false)
 {}
 
 FDB::Builder::~Builder() NOTHROWS
@@ -4346,7 +5265,21 @@ TAKErr FDB::Builder::beginBulkInsertion() NOTHROWS
     TE_CHECKRETURN_CODE(code);
     if (!db.database_)
         return TE_IllegalState;
-    return db.database_->beginTransaction();
+    code = db.database_->beginTransaction();
+    TE_CHECKRETURN_CODE(code);
+
+    // maintaining the indices per feature dominates the cost of ingest;
+    // drop them for the duration and rebuild once on commit
+    if (db.spatial_index_enabled_) {
+        code = db.dropIndicesNoSync();
+        if (code != TE_Ok) {
+            db.database_->endTransaction();
+            return code;
+        }
+        db.spatial_index_enabled_ = false;
+        rebuildIndices = true;
+    }
+    return code;
 }
 
 TAKErr FDB::Builder::endBulkInsertion(const bool commit) NOTHROWS
@@ -4358,12 +5291,26 @@ TAKErr FDB::Builder::endBulkInsertion(const bool commit) NOTHROWS
     if (!db.database_)
         return TE_IllegalState;
 
-    if (commit) {
+    bool successful = commit;
+    if (successful && rebuildIndices) {
+        code = db.createIndicesNoSync();
+        successful = (code == TE_Ok);
+    }
+    if (successful) {
         code = db.database_->setTransactionSuccessful();
-        TE_CHECKRETURN_CODE(code);
+        successful = (code == TE_Ok);
     }
-    code = db.database_->endTransaction();
+    const TAKErr endCode = db.database_->endTransaction();
+    // the indices are restored by either the rebuild or the rollback
+    if (rebuildIndices) {
+        db.spatial_index_enabled_ = true;
+        rebuildIndices = false;
+    }
+    // in-memory state may reflect rows that were rolled back
+    if (!successful)
+        db.invalidateMemoryStateNoSync();
     TE_CHECKRETURN_CODE(code);
+    TE_CHECKRETURN_CODE(endCode);
 
     return code;
 }
@@ -4387,12 +5334,22 @@ TAKErr FDB::Builder::insertFeatureSet(const int64_t fsid, const char *provider,
 
 TAKErr FDB::Builder::insertFeature(int64_t* fid, const int64_t fsid, FeatureDefinition2 &def) NOTHROWS
 {
-    return db.insertFeatureImpl(nullptr, fid, fsid, def);
+    if (db.feature_sets_.find(fsid) == db.feature_sets_.end())
+        return TE_InvalidArg;
+    // the context is shared across features, reusing the compiled insert
+    // statements and the previously inserted styles
+    return db.insertFeatureImpl(fid, ctx, fsid, def);
 }
 
 TAKErr FDB::Builder::insertFeature(const int64_t fsid, const char *name, const atakmap::feature::Geometry &geometry, const AltitudeMode altitudeMode, const double extrude, const atakmap::feature::Style *style, const atakmap::util::AttributeSet &attribs) NOTHROWS
 {
-    return db.insertFeatureImpl(nullptr, fsid, name, geometry, altitudeMode, extrude, style, attribs);
+    Feature2 f(
+        FeatureDataStore2::FEATURE_ID_NONE, fsid, name, std::move(GeometryPtr_const(&geometry, leaker_const<atakmap::feature::Geometry>)),
+        altitudeMode, extrude, std::move(StylePtr_const(style, leaker_const<atakmap::feature::Style>)),
+        std::move(AttributeSetPtr_const(&attribs, leaker_const<atakmap::util::AttributeSet>)), FeatureDataStore2::FEATURE_VERSION_NONE);
+    DefaultFeatureDefinition fDef(f);
+    int64_t fid;
+    return insertFeature(&fid, fsid, fDef);
 }
 
 TAKErr FDB::Builder::setFeatureSetVisible(const int64_t fsid, const bool& visible) NOTHROWS
@@ -4503,7 +5460,7 @@ TAKErr appendSpatialFilter(const atakmap::feature::Geometry &filter, WhereClause
 }
 
 #define DEFN_PRIMITIVE_CODER(name, type) \
-    TAKErr encode##name(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS \
+    TAKErr encode##name(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS \
     { \
         TAKErr code; \
         if(!attr.containsAttribute(key)) return TE_InvalidArg; \
@@ -4512,7 +5469,7 @@ TAKErr appendSpatialFilter(const atakmap::feature::Geometry &filter, WhereClause
         TE_CHECKRETURN_CODE(code); \
         return code; \
     } \
-    TAKErr decode##name(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS \
+    TAKErr decode##name(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS \
     { \
         TAKErr code; \
         type value; \
@@ -4532,16 +5489,16 @@ DEFN_PRIMITIVE_CODER(Double, double);
 
 #undef DEFN_PRIMITIVE_CODER
 
-TAKErr encodeString(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
+TAKErr encodeString(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
 {
     TAKErr code;
     if(!attr.containsAttribute(key)) return TE_InvalidArg;
     const char *value = attr.getString(key);
     const std::size_t valLen = strlen(value);
     if (valLen > 0) {
-        code = dos.writeInt(static_cast<int32_t>(strlen(value)));
+        code = dos.writeInt(static_cast<int32_t>(valLen));
         TE_CHECKRETURN_CODE(code);
-        code = dos.writeString(value);
+        code = dos.write(reinterpret_cast<const uint8_t *>(value), valLen);
         TE_CHECKRETURN_CODE(code);
     } else {
         code = dos.writeInt(-1);
@@ -4550,23 +5507,18 @@ TAKErr encodeString(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, c
 
     return code;
 }
-TAKErr decodeString(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS
+TAKErr decodeString(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS
 {
     TAKErr code;
     int len;
-    std::size_t numRead;
-    array_ptr<char> value;
     code = dos.readInt(&len);
+    TE_CHECKRETURN_CODE(code);
     if (len >= 0) {
+        const uint8_t *value;
+        code = dos.readSpan(&value, len);
         TE_CHECKRETURN_CODE(code);
-        value.reset(new char[len + 1]);
-        memset(value.get(), 0x00, len + 1);
-        code = dos.readString(value.get(), &numRead, len);
-        TE_CHECKRETURN_CODE(code);
-        if (numRead < static_cast<std::size_t>(len))
-            return TE_IO;
         try {
-            attr.setString(key, value.get());
+            attr.setString(key, std::string(reinterpret_cast<const char *>(value), len).c_str());
         } catch (...) {
             return TE_Err;
         }
@@ -4580,7 +5532,7 @@ TAKErr decodeString(atakmap::util::AttributeSet &attr, DataInput2 &dos, const ch
     return code;
 }
 
-TAKErr encodeBinary(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
+TAKErr encodeBinary(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
 {
     TAKErr code;
     if (!attr.containsAttribute(key)) return TE_InvalidArg;
@@ -4596,22 +5548,19 @@ TAKErr encodeBinary(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, c
     }
     return code;
 }
-TAKErr decodeBinary(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS
+TAKErr decodeBinary(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS
 {
     TAKErr code;
     int len;
-    std::size_t numRead;
-    array_ptr<uint8_t> value;
     code = dos.readInt(&len);
+    TE_CHECKRETURN_CODE(code);
     if (len >= 0) {
+        // the attribute set copies the blob, decode directly from the source
+        const uint8_t *value;
+        code = dos.readSpan(&value, len);
         TE_CHECKRETURN_CODE(code);
-        value.reset(new uint8_t[len]);
-        code = dos.read(value.get(), &numRead, len);
-        TE_CHECKRETURN_CODE(code);
-        if (numRead < static_cast<std::size_t>(len))
-            return TE_IO;
         try {
-            attr.setBlob(key, atakmap::util::AttributeSet::Blob(value.get(), value.get()+len));
+            attr.setBlob(key, atakmap::util::AttributeSet::Blob(value, value+len));
         } catch (...) {
             return TE_Err;
         }
@@ -4625,8 +5574,9 @@ TAKErr decodeBinary(atakmap::util::AttributeSet &attr, DataInput2 &dos, const ch
     return code;
 }
 
+// when no byte swapping is required, array content is transferred in bulk
 #define DEFN_PRIMITIVE_ARRAY_CODER(name, type) \
-    TAKErr encode##name##Array(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS \
+    TAKErr encode##name##Array(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS \
     { \
         TAKErr code; \
         if(!attr.containsAttribute(key)) return TE_InvalidArg; \
@@ -4638,15 +5588,20 @@ TAKErr decodeBinary(atakmap::util::AttributeSet &attr, DataInput2 &dos, const ch
             std::size_t len = (value.second-value.first); \
             code = dos.writeInt(static_cast<int32_t>(len)); \
             TE_CHECKRETURN_CODE(code); \
-            for(std::size_t i = 0; i < len; i++) { \
-                code = dos.write##name(value.first[i]); \
-                TE_CHECKBREAK_CODE(code); \
+            if(dos.getSourceEndian() == TE_PlatformEndian) { \
+                code = dos.write(reinterpret_cast<const uint8_t *>(value.first), len*sizeof(type)); \
+                TE_CHECKRETURN_CODE(code); \
+            } else { \
+                for(std::size_t i = 0; i < len; i++) { \
+                    code = dos.write##name(value.first[i]); \
+                    TE_CHECKBREAK_CODE(code); \
+                } \
+                TE_CHECKRETURN_CODE(code); \
             } \
-            TE_CHECKRETURN_CODE(code); \
         } \
         return code; \
     } \
-    TAKErr decode##name##Array(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS \
+    TAKErr decode##name##Array(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS \
     { \
         TAKErr code; \
         int len; \
@@ -4654,11 +5609,18 @@ TAKErr decodeBinary(atakmap::util::AttributeSet &attr, DataInput2 &dos, const ch
         TE_CHECKRETURN_CODE(code); \
         if(len > 0) { \
             array_ptr<type> value(new type[len]); \
-            for(std::size_t i = 0; i < static_cast<std::size_t>(len); i++) { \
-                code = dos.read##name(value.get()+i); \
-                TE_CHECKBREAK_CODE(code); \
+            if(dos.getSourceEndian() == TE_PlatformEndian) { \
+                const uint8_t *src; \
+                code = dos.readSpan(&src, len*sizeof(type)); \
+                TE_CHECKRETURN_CODE(code); \
+                memcpy(value.get(), src, len*sizeof(type)); \
+            } else { \
+                for(std::size_t i = 0; i < static_cast<std::size_t>(len); i++) { \
+                    code = dos.read##name(value.get()+i); \
+                    TE_CHECKBREAK_CODE(code); \
+                } \
+                TE_CHECKRETURN_CODE(code); \
             } \
-            TE_CHECKRETURN_CODE(code); \
             try { \
                 attr.set##name##Array(key, atakmap::util::AttributeSet::name##Array(value.get(), value.get()+len)); \
             } catch(...) { \
@@ -4681,7 +5643,7 @@ DEFN_PRIMITIVE_ARRAY_CODER(Double, double);
 #undef DEFN_PRIMITIVE_ARRAY_CODER
 
 
-TAKErr encodeStringArray(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
+TAKErr encodeStringArray(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
 {
     TAKErr code;
     if (!attr.containsAttribute(key)) return TE_InvalidArg;
@@ -4695,7 +5657,7 @@ TAKErr encodeStringArray(DataOutput2 &dos, const atakmap::util::AttributeSet &at
         if (valLen > 0) {
             code = dos.writeInt(static_cast<int32_t>(valLen));
             TE_CHECKBREAK_CODE(code);
-            code = dos.writeString(value);
+            code = dos.write(reinterpret_cast<const uint8_t *>(value), valLen);
             TE_CHECKBREAK_CODE(code);
         }
         else {
@@ -4707,26 +5669,37 @@ TAKErr encodeStringArray(DataOutput2 &dos, const atakmap::util::AttributeSet &at
 
     return code;
 }
-TAKErr decodeStringArray(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS
+TAKErr decodeStringArray(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS
 {
     TAKErr code;
     int arrLen;
     code = dos.readInt(&arrLen);
     TE_CHECKRETURN_CODE(code);
     if (arrLen > 0) {
-        array_ptr<array_ptr<char>> arr(new array_ptr<char>[arrLen]);
+        std::vector<std::string> arr;
         array_ptr<const char *> sarr(new const char *[arrLen]);
+        try {
+            arr.resize(arrLen);
+        } catch (...) {
+            return TE_OutOfMemory;
+        }
         for (int i = 0; i < arrLen; i++) {
             int len;
             code = dos.readInt(&len);
             TE_CHECKBREAK_CODE(code);
-            if (!len)
-                continue;
-            arr.get()[i].reset(new char[len + 1]);
-            std::size_t nread;
-            code = dos.readString(arr.get()[i].get(), &nread, len);
-            TE_CHECKBREAK_CODE(code);
-            sarr.get()[i] = arr.get()[i].get();
+            // empty strings are encoded with a negative length
+            if (len > 0) {
+                const uint8_t *value;
+                code = dos.readSpan(&value, len);
+                TE_CHECKBREAK_CODE(code);
+                try {
+                    arr[i].assign(reinterpret_cast<const char *>(value), len);
+                } catch (...) {
+                    code = TE_OutOfMemory;
+                    break;
+                }
+            }
+            sarr.get()[i] = arr[i].c_str();
         }
         TE_CHECKRETURN_CODE(code);
 
@@ -4746,7 +5719,7 @@ TAKErr decodeStringArray(atakmap::util::AttributeSet &attr, DataInput2 &dos, con
     return code;
 }
 
-TAKErr encodeBinaryArray(DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
+TAKErr encodeBinaryArray(DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key) NOTHROWS
 {
     TAKErr code;
     if (!attr.containsAttribute(key)) return TE_InvalidArg;
@@ -4771,27 +5744,26 @@ TAKErr encodeBinaryArray(DataOutput2 &dos, const atakmap::util::AttributeSet &at
 
     return code;
 }
-TAKErr decodeBinaryArray(atakmap::util::AttributeSet &attr, DataInput2 &dos, const char *key) NOTHROWS
+TAKErr decodeBinaryArray(atakmap::util::AttributeSet &attr, MemoryInput2 &dos, const char *key) NOTHROWS
 {
     TAKErr code;
     int arrLen;
     code = dos.readInt(&arrLen);
     TE_CHECKRETURN_CODE(code);
     if (arrLen > 0) {
-        array_ptr<array_ptr<uint8_t>> arr(new array_ptr<uint8_t>[arrLen]);
+        // elements reference the source directly; the attribute set copies
         array_ptr<atakmap::util::AttributeSet::Blob> barr(new atakmap::util::AttributeSet::Blob[arrLen]);
         for (int i = 0; i < arrLen; i++) {
             int len;
             code = dos.readInt(&len);
             TE_CHECKBREAK_CODE(code);
-            if (!len)
+            if (len <= 0)
                 continue;
-            arr.get()[i].reset(new uint8_t[len + 1]);
-            std::size_t nread;
-            code = dos.read(arr.get()[i].get(), &nread, len);
+            const uint8_t *value;
+            code = dos.readSpan(&value, len);
             TE_CHECKBREAK_CODE(code);
-            barr.get()[i] = std::pair<const uint8_t *, const uint8_t *>(arr.get()[i].get(), arr.get()[i].get() + nread);
-    }
+            barr.get()[i] = std::pair<const uint8_t *, const uint8_t *>(value, value + len);
+        }
         TE_CHECKRETURN_CODE(code);
 
         attr.setBlobArray(key, atakmap::util::AttributeSet::BlobArray(barr.get(), barr.get() + arrLen));
@@ -4803,6 +5775,49 @@ TAKErr decodeBinaryArray(atakmap::util::AttributeSet &attr, DataInput2 &dos, con
     return code;
 }
 
+TAKErr writeVarint(DataOutput2 &dos, uint64_t value) NOTHROWS
+{
+    uint8_t buf[10u];
+    std::size_t len = 0u;
+    do {
+        uint8_t b = static_cast<uint8_t>(value & 0x7Fu);
+        value >>= 7u;
+        if (value)
+            b |= 0x80u;
+        buf[len++] = b;
+    } while (value);
+    return dos.write(buf, len);
+}
+TAKErr writeZigZag(DataOutput2 &dos, const int64_t value) NOTHROWS
+{
+    return writeVarint(dos, (static_cast<uint64_t>(value) << 1u) ^ static_cast<uint64_t>(value >> 63));
+}
+TAKErr readVarint(uint64_t *value, DataInput2 &dis) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    uint64_t v = 0u;
+    for (std::size_t shift = 0u; shift < 64u; shift += 7u) {
+        uint8_t b;
+        code = dis.readByte(&b);
+        TE_CHECKRETURN_CODE(code);
+        v |= static_cast<uint64_t>(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) {
+            *value = v;
+            return TE_Ok;
+        }
+    }
+    // overlong encoding
+    return TE_IO;
+}
+TAKErr readZigZag(int64_t *value, DataInput2 &dis) NOTHROWS
+{
+    uint64_t v;
+    TAKErr code = readVarint(&v, dis);
+    TE_CHECKRETURN_CODE(code);
+    *value = static_cast<int64_t>(v >> 1u) ^ -static_cast<int64_t>(v & 1u);
+    return code;
+}
+
 
 template<class T>
 PointerContainerMgr<T>::PointerContainerMgr(T &c) NOTHROWS :
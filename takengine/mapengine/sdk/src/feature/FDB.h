@@ -1,6 +1,11 @@
 #ifndef TAK_ENGINE_FEATURE_FDB_H_INCLUDED
 #define TAK_ENGINE_FEATURE_FDB_H_INCLUDED
 
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
 #include "db/BindArgument.h"
 #include "db/CursorWrapper2.h"
 #include "db/Database2.h"
@@ -10,9 +15,11 @@
 #include "feature/FeatureDefinition2.h"
 #include "feature/FeatureSetCursor2.h"
 #include "port/Platform.h"
+#include "thread/Mutex.h"
 #include "util/DataInput2.h"
 #include "util/DataOutput2.h"
 #include "util/NonHeapAllocatable.h"
+#include "util/PackedRTree.h"
 
 namespace TAK {
     namespace Engine {
@@ -20,19 +27,23 @@ namespace TAK {
             class ENGINE_API FDB : public AbstractFeatureDataStore2
             {
             private :
-                typedef Util::TAKErr (*AttributeEncode)(Util::DataOutput2 &dos, const atakmap::util::AttributeSet &attr, const char *key);
-                typedef Util::TAKErr (*AttributeDecode)(atakmap::util::AttributeSet &attr, Util::DataInput2 &dos, const char *key);
+                typedef Util::TAKErr (*AttributeEncode)(Util::DynamicOutput &dos, const atakmap::util::AttributeSet &attr, const char *key);
+                typedef Util::TAKErr (*AttributeDecode)(atakmap::util::AttributeSet &attr, Util::MemoryInput2 &dos, const char *key);
             private :
                 struct FeatureSetDefn;
+                struct FeatureSetSpatialIndex;
                 struct AttributeCoder;
                 class AttributeSpec;
                 class Builder;
                 class InsertContext;
                 class FeatureCursorImpl;
                 class FeatureSetCursorImpl;
+                class FeatureCache;
             private :
                 typedef std::map<int64_t, std::shared_ptr<AttributeSpec>> IdAttrSchemaMap;
                 typedef std::map<Port::String, std::shared_ptr<AttributeSpec>, Port::StringLess> KeyAttrSchemaMap;
+                /** holds the rows of an in-memory spatial filter for the lifetime of the query using them */
+                typedef std::shared_ptr<const int64_t> SpatialFilterRef;
             private :
                 FDB(int modificationFlags, int visibilityFlags) NOTHROWS;
                 
@@ -157,19 +168,51 @@ namespace TAK {
 
                 /**************************************************************************/
             private :
-                Util::TAKErr buildParamsWhereClauseNoCheck(bool *emptyResults, const FeatureQueryParameters &params, Port::Collection<std::shared_ptr<const FeatureSetDefn>> &fs, DB::WhereClauseBuilder2 &whereClause) NOTHROWS;
-                Util::TAKErr buildParamsWhereClauseCheck(bool *emptyResults, const FeatureQueryParameters &params, const FeatureSetDefn &fs, DB::WhereClauseBuilder2 &whereClause) NOTHROWS;
+                Util::TAKErr buildParamsWhereClauseNoCheck(bool *emptyResults, const FeatureQueryParameters &params, Port::Collection<std::shared_ptr<const FeatureSetDefn>> &fs, DB::WhereClauseBuilder2 &whereClause, SpatialFilterRef &filterRef) NOTHROWS;
+                Util::TAKErr buildParamsWhereClauseCheck(bool *emptyResults, const FeatureQueryParameters &params, const FeatureSetDefn &fs, DB::WhereClauseBuilder2 &whereClause, SpatialFilterRef &filterRef) NOTHROWS;
 
                 Util::TAKErr getMaxFeatureVersion(const int64_t fsid, int64_t *version) NOTHROWS;
+
+                /**
+                 * Appends the spatial filter as a set of FIDs obtained from
+                 * the in-memory spatial indices of the feature sets. The
+                 * FIDs are staged in a temporary table, whose rows remain
+                 * until `filterRef` is released. If any of the feature sets
+                 * is not eligible for in-memory indexing, `applied` is
+                 * `false` and the clause is not modified.
+                 */
+                Util::TAKErr appendMemorySpatialFilter(bool *applied, bool *emptyResults, const atakmap::feature::Geometry &filter, const int64_t *fsids, const std::size_t count, DB::WhereClauseBuilder2 &whereClause, SpatialFilterRef &filterRef) NOTHROWS;
+                /** deletes the staged rows of in-memory spatial filters that are no longer referenced */
+                Util::TAKErr purgeSpatialFiltersNoSync() NOTHROWS;
+                /** discards in-memory state that may reflect rows that were rolled back */
+                void invalidateMemoryStateNoSync() NOTHROWS;
+                Util::TAKErr validateSpatialIndexNoSync(std::shared_ptr<FeatureSetSpatialIndex> &value, const int64_t fsid) NOTHROWS;
+                /** synchronizes the in-memory spatial index with the current geometry of the feature */
+                Util::TAKErr updateSpatialIndexNoSync(const int64_t fid) NOTHROWS;
+
+                /**
+                 * Creates the simplified geometries table, if simplification
+                 * is enabled, and records whether the table is present.
+                 */
+                Util::TAKErr validateSimplifiedGeometriesNoSync() NOTHROWS;
+                /** (re)generates the simplified levels for the current geometry of the feature */
+                Util::TAKErr updateSimplifiedGeometriesNoSync(const int64_t fid) NOTHROWS;
                 /**************************************************************************/
             protected :
                 static Util::TAKErr encodeAttributes(FDB &impl, InsertContext &ctx, const atakmap::util::AttributeSet &metadata) NOTHROWS;
 
             private :
                 static Util::TAKErr decodeAttributes(AttributeSetPtr_const &result, const uint8_t *blob, const std::size_t blobLen, IdAttrSchemaMap &schema) NOTHROWS;
-                static Util::TAKErr decodeAttributesImpl(AttributeSetPtr_const &result, Util::DataInput2 &dis, IdAttrSchemaMap &schema) NOTHROWS;
+                static Util::TAKErr decodeAttributesImpl(AttributeSetPtr_const &result, Util::MemoryInput2 &dis, IdAttrSchemaMap &schema) NOTHROWS;
 
                 static Util::TAKErr insertAttrSchema(std::shared_ptr<AttributeSpec> &retval, InsertContext &ctx, DB::Database2 &database, const char *key, const atakmap::util::AttributeSet &metadata) NOTHROWS;
+                /**
+                 * Writes a string attribute value in the compact coding,
+                 * adding the value to the dictionary of `spec` if it is
+                 * short and the dictionary is not yet full.
+                 */
+                static Util::TAKErr encodeStringValue(FDB &impl, InsertContext &ctx, Util::DynamicOutput &dos, AttributeSpec &spec, const char *value) NOTHROWS;
+                static Util::TAKErr decodeStringValue(atakmap::util::AttributeSet &attr, Util::MemoryInput2 &dis, const AttributeSpec &spec) NOTHROWS;
 
                 /**************************************************************************/
 
@@ -194,6 +237,24 @@ namespace TAK {
                 IdAttrSchemaMap id_to_attr_schema_;
                 KeyAttrSchemaMap key_to_attr_schema_;
                 bool attr_schema_dirty_;
+                /** `true` if the database has an attribute value dictionary table */
+                bool attr_values_table_;
+                /** if `true`, attributes are written in the compact coding, per the `fdb.compact-attributes` option */
+                bool compact_attributes_;
+
+                std::unique_ptr<FeatureCache> feature_cache_;
+
+                /** feature set ID to in-memory spatial index */
+                std::map<int64_t, std::shared_ptr<FeatureSetSpatialIndex>> spatial_indices_;
+                std::size_t memory_spatial_index_limit_;
+                /** filter ID to the reference held by the queries using the staged FIDs */
+                std::map<int64_t, std::weak_ptr<const int64_t>> spatial_filters_;
+                int64_t next_spatial_filter_id_;
+
+                /** number of simplified levels generated per geometry on insert and update, per the `fdb.simplified-levels` option */
+                std::size_t simplified_levels_;
+                /** `true` if the database has a simplified geometries table */
+                bool simplified_geometries_;
 
                 friend class FeatureSetDatabase;
                 friend class PersistentDataSourceFeatureDataStore2;
@@ -216,6 +277,18 @@ namespace TAK {
                 bool readOnly{false};
             };
 
+            /**
+             * In-memory spatial index over the feature MBRs of a feature set
+             * that is small enough that querying the index and selecting
+             * by FID is cheaper than the SpatiaLite spatial index.
+             */
+            struct FDB::FeatureSetSpatialIndex
+            {
+                /** if `true`, the feature set exceeds the size limit and is not indexed */
+                bool oversize {false};
+                Util::PackedRTree<int64_t> fids;
+            };
+
             struct FDB::AttributeCoder
             {
             public:
@@ -240,6 +313,9 @@ namespace TAK {
                 const AttributeCoder coder;
 
                 std::map<int, std::shared_ptr<AttributeSpec>> secondaryDefs;
+                /** dictionary of the string values of the key, indexed by their codes */
+                std::vector<Port::String> values;
+                std::map<Port::String, std::size_t, Port::StringLess> valueCodes;
             };
 
             /**************************************************************************/
@@ -258,6 +334,7 @@ namespace TAK {
                 DB::StatementPtr insertStyleStatement;
                 DB::StatementPtr insertAttributesStatement;
                 DB::StatementPtr insertAttributeSchemaStatement;
+                DB::StatementPtr insertAttributeValueStatement;
                 DB::BindArgument insertGeomArg;
                 Util::DynamicOutput codedAttribs;
             };
@@ -273,6 +350,11 @@ namespace TAK {
                 ~Builder() NOTHROWS;
             public :
                 Util::TAKErr createIndices() NOTHROWS;
+                /**
+                 * Begins a transaction for bulk ingest. If the database is
+                 * indexed, the indices are dropped for the duration of the
+                 * transaction and rebuilt in a single pass on commit.
+                 */
                 Util::TAKErr beginBulkInsertion() NOTHROWS;
                 Util::TAKErr endBulkInsertion(const bool commit) NOTHROWS;
                 Util::TAKErr insertFeatureSet(int64_t *fsid, const char *provider, const char *type, const char *name, const double minResolution, const double maxResolution) NOTHROWS;
@@ -287,6 +369,47 @@ namespace TAK {
             private :
                 InsertContext ctx;
                 FDB &db;
+                bool rebuildIndices;
+            };
+
+            /**************************************************************************/
+            // FeatureCache
+
+            /**
+             * LRU cache of decoded features, keyed by FID and version. Any
+             * modification to a feature increments its version, so a cached
+             * instance is only returned while the row it was decoded from is
+             * unchanged. The cache is bounded by the estimated size of the
+             * decoded features, per the `fdb.feature-cache-size` option
+             * (bytes, `0` to disable).
+             */
+            class FDB::FeatureCache
+            {
+            private :
+                struct Entry
+                {
+                    int64_t fid;
+                    int64_t version;
+                    std::size_t size;
+                    std::shared_ptr<const Feature2> feature;
+                };
+            public :
+                FeatureCache(const std::size_t limit) NOTHROWS;
+            public :
+                /** returns `nullptr` if no feature with the version is cached */
+                std::shared_ptr<const Feature2> get(const int64_t fid, const int64_t version) NOTHROWS;
+                void put(const std::shared_ptr<const Feature2> &feature, const std::size_t size) NOTHROWS;
+                void evict(const int64_t fid) NOTHROWS;
+                void clear() NOTHROWS;
+            private :
+                void trimNoSync() NOTHROWS;
+            public :
+                const std::size_t limit;
+            private :
+                Thread::Mutex mutex;
+                std::list<Entry> entries;
+                std::map<int64_t, std::list<Entry>::iterator> index;
+                std::size_t size;
             };
 
             /**************************************************************************/
@@ -296,7 +419,7 @@ namespace TAK {
                                            public FeatureCursor2
             {
             public :
-                FeatureCursorImpl(FDB &owner, DB::QueryPtr &&filter, const int idCol, const int fsidCol, const int versionCol, const int nameCol, const int geomCol, const int styleCol, const int attribsCol, const int altitudeModeCol, const int extrudeCol) NOTHROWS;
+                FeatureCursorImpl(FDB &owner, DB::QueryPtr &&filter, const int idCol, const int fsidCol, const int versionCol, const int nameCol, const int geomCol, const int styleCol, const int attribsCol, const int altitudeModeCol, const int extrudeCol, const int styleIdCol, const bool cacheRows, const SpatialFilterRef &filterRef) NOTHROWS;
             public: // FeatureCursor2
                 virtual TAK::Engine::Util::TAKErr getId(int64_t *value) NOTHROWS override;
                 virtual TAK::Engine::Util::TAKErr getVersion(int64_t *value) NOTHROWS override;
@@ -311,8 +434,12 @@ namespace TAK {
                 virtual TAK::Engine::Util::TAKErr getAttributes(const atakmap::util::AttributeSet **value) NOTHROWS override;
                 virtual TAK::Engine::Util::TAKErr get(const Feature2 **feature) NOTHROWS override;
                 virtual Util::TAKErr getFeatureSetId(int64_t *value) NOTHROWS override;
+                virtual Util::TAKErr fetch(std::size_t *count, FeatureColumns &columns, const std::size_t limit) NOTHROWS override;
             public : // RowIterator
                 virtual TAK::Engine::Util::TAKErr moveToNext() NOTHROWS override;
+            private :
+                /** looks up the current row in the owner's feature cache */
+                Util::TAKErr validateCachedRow() NOTHROWS;
             private :
                 FDB &owner;
                 const int idCol;
@@ -324,9 +451,15 @@ namespace TAK {
                 const int versionCol;
                 const int altitudeModeCol;
                 const int extrudeCol;
+                const int styleIdCol;
+                /** `true` if rows carry every field, unmodified, and may be shared via the feature cache */
+                const bool cacheRows;
+                /** keeps the staged FIDs of an in-memory spatial filter alive for the query */
+                const SpatialFilterRef filterRef;
 
-                FeaturePtr_const rowFeature;
+                std::shared_ptr<const Feature2> rowFeature;
                 AttributeSetPtr_const rowAttribs;
+                bool rowCacheChecked;
             };
 
             /**************************************************************************/
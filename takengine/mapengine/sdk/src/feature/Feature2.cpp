@@ -225,11 +225,9 @@ TAKErr TAK::Engine::Feature::Feature_create(FeaturePtr_const &feature, FeatureDe
     case FeatureDefinition2::StyleOgr:
     {
         if (raw.text) {
-            try {
-                style = StylePtr_const(atakmap::feature::Style::parseStyle(raw.text), atakmap::feature::Style::destructStyle);
-            } catch (...) {
-                return TE_Err;
-            }
+            // features commonly share a few distinct style strings
+            code = atakmap::feature::Style_parseStyleShared(style, raw.text);
+            TE_CHECKRETURN_CODE(code);
         }
         break;
     }
@@ -345,9 +343,7 @@ TAKErr TAK::Engine::Feature::Feature_create(FeaturePtr_const &feature, const int
     case FeatureDefinition2::StyleOgr:
     {
         if (raw.text) {
-            try {
-                style = StylePtr_const(atakmap::feature::Style::parseStyle(raw.text), atakmap::feature::Style::destructStyle);
-            } catch (...) {
+            if (atakmap::feature::Style_parseStyleShared(style, raw.text) != TE_Ok) {
                 // XXX - encountering KML with style "links", just return NULL
                 style = StylePtr_const(nullptr, atakmap::feature::Style::destructStyle);
                 //return TE_Err;
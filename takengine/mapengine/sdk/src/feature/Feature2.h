@@ -11,6 +11,7 @@
 #include "port/String.h"
 //#include "util/AttributeSet.h"
 #include "util/Error.h"
+#include "util/SlabAllocator.h"
 
 namespace atakmap {
     namespace feature {
@@ -43,6 +44,7 @@ namespace TAK {
             */
             class ENGINE_API Feature2
             {
+                TE_SLAB_ALLOCATED()
             public :
                 Feature2(const Feature2 &other) NOTHROWS;
                 Feature2(const int64_t fid, const int64_t fsid, const char *name, const atakmap::feature::Geometry &geom,
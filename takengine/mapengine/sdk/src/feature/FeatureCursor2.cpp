@@ -1,6 +1,127 @@
 #include "feature/FeatureCursor2.h"
 
+#include <cstring>
+
 using namespace TAK::Engine::Feature;
 
+using namespace TAK::Engine::Util;
+
 FeatureCursor2::~FeatureCursor2() NOTHROWS
 {}
+
+TAKErr FeatureCursor2::fetch(std::size_t *count, FeatureColumns &columns, const std::size_t limit) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!count)
+        return TE_InvalidArg;
+    *count = 0u;
+    if (columns.geometries && !columns.geometryData)
+        return TE_InvalidArg;
+
+    const GeometryEncoding coding = this->getGeomCoding();
+    if (columns.geometries) {
+        if (coding == GeomGeometry)
+            return TE_Unsupported;
+        code = columns.geometryData->reset();
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    std::size_t row = 0u;
+    for ( ; row < limit; row++) {
+        code = this->moveToNext();
+        TE_CHECKBREAK_CODE(code);
+
+        if (columns.ids) {
+            code = this->getId(columns.ids + row);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.featureSetIds) {
+            code = this->getFeatureSetId(columns.featureSetIds + row);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.versions) {
+            code = this->getVersion(columns.versions + row);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.geometries) {
+            RawData raw;
+            code = this->getRawGeometry(&raw);
+            TE_CHECKBREAK_CODE(code);
+            code = FeatureColumns_setGeometry(columns, row, coding, raw);
+            TE_CHECKBREAK_CODE(code);
+        }
+        if (columns.styleIds)
+            columns.styleIds[row] = -1LL;
+    }
+    if (code == TE_Done)
+        code = TE_Ok;
+    TE_CHECKRETURN_CODE(code);
+
+    if (columns.geometries) {
+        code = FeatureColumns_resolveGeometries(columns, coding, row);
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    *count = row;
+    return row ? TE_Ok : TE_Done;
+}
+
+TAKErr TAK::Engine::Feature::FeatureColumns_setGeometry(FeatureColumns &columns, const std::size_t row, const FeatureDefinition2::GeometryEncoding coding, const FeatureDefinition2::RawData &raw) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!columns.geometries || !columns.geometryData)
+        return TE_InvalidArg;
+
+    // spans are recorded as lengths until resolved; data for successive
+    // rows is contiguous in `geometryData`
+    FeatureDefinition2::RawData &span = columns.geometries[row];
+    span.binary.value = nullptr;
+    span.binary.len = 0u;
+    switch (coding) {
+        case FeatureDefinition2::GeomWkt :
+            if (raw.text) {
+                // include the terminator
+                span.binary.len = strlen(raw.text) + 1u;
+                code = columns.geometryData->write(reinterpret_cast<const uint8_t *>(raw.text), span.binary.len);
+            }
+            break;
+        case FeatureDefinition2::GeomWkb :
+        case FeatureDefinition2::GeomBlob :
+            if (raw.binary.value && raw.binary.len) {
+                span.binary.len = raw.binary.len;
+                code = columns.geometryData->write(raw.binary.value, raw.binary.len);
+            }
+            break;
+        default :
+            return TE_Unsupported;
+    }
+    return code;
+}
+
+TAKErr TAK::Engine::Feature::FeatureColumns_resolveGeometries(FeatureColumns &columns, const FeatureDefinition2::GeometryEncoding coding, const std::size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!columns.geometries || !columns.geometryData)
+        return TE_InvalidArg;
+
+    const uint8_t *data;
+    std::size_t len;
+    code = columns.geometryData->get(&data, &len);
+    TE_CHECKRETURN_CODE(code);
+
+    std::size_t off = 0u;
+    for (std::size_t i = 0u; i < count; i++) {
+        FeatureDefinition2::RawData &span = columns.geometries[i];
+        const std::size_t spanLen = span.binary.len;
+        if (off + spanLen > len)
+            return TE_IllegalState;
+        if (coding == FeatureDefinition2::GeomWkt) {
+            span.text = spanLen ? reinterpret_cast<const char *>(data + off) : nullptr;
+        } else {
+            span.binary.value = spanLen ? data + off : nullptr;
+            span.binary.len = spanLen;
+        }
+        off += spanLen;
+    }
+    return code;
+}
@@ -1,14 +1,45 @@
 #ifndef TAK_ENGINE_FEATURE_FEATURECURSOR2_H_INCLUDED
 #define TAK_ENGINE_FEATURE_FEATURECURSOR2_H_INCLUDED
 
+#include <cstddef>
 #include <cstdint>
 
 #include "db/RowIterator.h"
 #include "feature/FeatureDefinition2.h"
+#include "util/DataOutput2.h"
 
 namespace TAK {
     namespace Engine {
         namespace Feature {
+            /**
+             * Caller allocated column arrays filled by
+             * `FeatureCursor2::fetch`. Each non-`nullptr` array must have
+             * capacity for the requested number of rows; columns that are
+             * `nullptr` are not fetched.
+             */
+            struct ENGINE_API FeatureColumns
+            {
+                int64_t *ids {nullptr};
+                int64_t *featureSetIds {nullptr};
+                int64_t *versions {nullptr};
+                /**
+                 * The raw geometry of each row, per the cursor's
+                 * `getGeomCoding()`. Binary and text geometries are copied
+                 * into `geometryData`; the spans remain valid until
+                 * `geometryData` is next modified. Cursors with
+                 * `GeomGeometry` coding do not support fetching geometry.
+                 */
+                FeatureDefinition2::RawData *geometries {nullptr};
+                /** opened by the caller; required if `geometries` is not `nullptr` */
+                Util::DynamicOutput *geometryData {nullptr};
+                /**
+                 * The ID of the style of each row in its store; rows
+                 * without a style, or from a cursor that does not expose
+                 * style IDs, are `-1`.
+                 */
+                int64_t *styleIds {nullptr};
+            };
+
             class ENGINE_API FeatureCursor2 : public TAK::Engine::DB::RowIterator,
                                    public FeatureDefinition2
             {
@@ -18,7 +49,40 @@ namespace TAK {
                 virtual TAK::Engine::Util::TAKErr getId(int64_t *value) NOTHROWS = 0;
                 virtual TAK::Engine::Util::TAKErr getFeatureSetId(int64_t *value) NOTHROWS = 0;
                 virtual TAK::Engine::Util::TAKErr getVersion(int64_t *value) NOTHROWS = 0;
+
+                /**
+                 * Advances the cursor by up to `limit` rows, filling the
+                 * requested columns for each. On return the cursor is
+                 * positioned as if `moveToNext` had been invoked once per
+                 * row fetched, and once more if fewer than `limit` rows
+                 * remained.
+                 *
+                 * <P>The default implementation iterates the per row
+                 * accessors; cursors backed by a store may fill the columns
+                 * directly.
+                 *
+                 * @param count     Returns the number of rows fetched
+                 * @param columns   The columns to fill
+                 * @param limit     The maximum number of rows to fetch
+                 *
+                 * @return  TE_Ok if at least one row was fetched, TE_Done if
+                 *          the cursor is exhausted
+                 */
+                virtual TAK::Engine::Util::TAKErr fetch(std::size_t *count, FeatureColumns &columns, const std::size_t limit) NOTHROWS;
             }; // FeatureCursor
+
+            /**
+             * Copies the raw geometry for the row at index `row` into
+             * `columns.geometryData`. Geometry spans are only valid once
+             * the batch is complete and `FeatureColumns_resolveGeometries`
+             * has been invoked.
+             */
+            ENGINE_API Util::TAKErr FeatureColumns_setGeometry(FeatureColumns &columns, const std::size_t row, const FeatureDefinition2::GeometryEncoding coding, const FeatureDefinition2::RawData &raw) NOTHROWS;
+            /**
+             * Resolves the geometry spans for the first `count` rows
+             * against `columns.geometryData`.
+             */
+            ENGINE_API Util::TAKErr FeatureColumns_resolveGeometries(FeatureColumns &columns, const FeatureDefinition2::GeometryEncoding coding, const std::size_t count) NOTHROWS;
         }
     }
 }
@@ -153,6 +153,10 @@ FeatureDataStore2::FeatureSetQueryParameters::~FeatureSetQueryParameters() NOTHR
 
 FeatureDataStore2::OnDataStoreContentChangedListener::~OnDataStoreContentChangedListener() NOTHROWS
 {}
+void FeatureDataStore2::OnDataStoreContentChangedListener::onDataStoreContentChanged(FeatureDataStore2 &dataStore, const ContentChange &change) NOTHROWS
+{
+    onDataStoreContentChanged(dataStore);
+}
 
 namespace
 {
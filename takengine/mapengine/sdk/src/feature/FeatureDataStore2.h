@@ -3,7 +3,9 @@
 
 #include <limits>
 #include <memory>
+#include <set>
 
+#include "feature/Envelope2.h"
 #include "feature/Geometry.h"
 #include "feature/Feature2.h"
 #include "feature/FeatureSet2.h"
@@ -74,6 +76,7 @@ namespace TAK {
                     AddUpdate,
                 };
             public :
+                struct ENGINE_API ContentChange;
                 class ENGINE_API OnDataStoreContentChangedListener;
                 class ENGINE_API FeatureQueryParameters;
                 class ENGINE_API FeatureSetQueryParameters;
@@ -148,12 +151,47 @@ namespace TAK {
 
             /**************************************************************************/
 
+            /**
+             * Describes the content changed since the previous notification.
+             * Listeners may use the extent of the change to skip refreshes
+             * that do not affect them.
+             */
+            struct ENGINE_API FeatureDataStore2::ContentChange
+            {
+                /**
+                 * The IDs of the features that were inserted, updated or
+                 * deleted. Only complete if `fidsComplete` is `true`.
+                 */
+                std::set<int64_t> fids;
+                bool fidsComplete {true};
+                /** The IDs of the feature sets that were modified or contain modified features */
+                std::set<int64_t> fsids;
+                /**
+                 * The WGS84 extent of the change, covering both the previous
+                 * and the new geometries of the affected features. Only valid
+                 * if `hasBounds` is `true`.
+                 */
+                Envelope2 bounds;
+                bool hasBounds {false};
+                /**
+                 * If `true`, the extent of the change is not known and all
+                 * content should be considered changed.
+                 */
+                bool unbounded {false};
+            };
+
             class ENGINE_API FeatureDataStore2::OnDataStoreContentChangedListener
             {
             protected :
                 virtual ~OnDataStoreContentChangedListener() NOTHROWS = 0;
             public :
                 virtual void onDataStoreContentChanged(FeatureDataStore2 &dataStore) NOTHROWS = 0;
+                /**
+                 * Invoked in place of `onDataStoreContentChanged(FeatureDataStore2 &)`
+                 * by stores that report the extent of changes. The default
+                 * implementation forwards to that method.
+                 */
+                virtual void onDataStoreContentChanged(FeatureDataStore2 &dataStore, const ContentChange &change) NOTHROWS;
             };
 
             /**************************************************************************/
@@ -103,7 +103,8 @@ TAKErr FeatureSetDatabase::Builder::close() NOTHROWS
         return TE_IllegalState;
     TAKErr code(TAKErr::TE_Ok);
 
-    impl.release();
+    // finalize the builder's statements before closing
+    impl.reset();
     db->close();
     db.release();
 
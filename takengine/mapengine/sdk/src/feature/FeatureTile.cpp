@@ -0,0 +1,1024 @@
+#include "feature/FeatureTile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "feature/Feature2.h"
+#include "feature/GeometryCollection2.h"
+#include "feature/GeometryFactory.h"
+#include "feature/LegacyAdapters.h"
+#include "feature/LineString2.h"
+#include "feature/Point2.h"
+#include "feature/Polygon2.h"
+#include "feature/Style.h"
+#include "raster/osm/OSMUtils.h"
+#include "util/DataInput2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Feature;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+using namespace atakmap::raster::osm;
+
+#define TILE_FORMAT_VERSION 1u
+#define TILE_SRID 4326
+// maximum depth of nested geometry collections
+#define MAX_COLLECTION_DEPTH 8
+
+namespace
+{
+    const uint8_t TILE_MAGIC[4] = { 'T', 'E', 'F', 'T' };
+
+    enum GeometryTag
+    {
+        GT_None = 0u,
+        GT_Point = 1u,
+        GT_LineString = 2u,
+        GT_Polygon = 3u,
+        GT_Collection = 4u,
+    };
+    // set on the tag for geometries with z-coordinates
+    const uint8_t GT_3D = 0x80u;
+
+    struct Quantizer
+    {
+        Quantizer(const Envelope2 &bounds, const std::size_t extent) NOTHROWS;
+
+        double originX;
+        double originY;
+        double scaleX;
+        double scaleY;
+        int64_t lastX {0};
+        int64_t lastY {0};
+        int64_t lastZ {0};
+    };
+
+    /**
+     * The decoded geometry of a record; the tags and element counts in
+     * encoding order, and the coordinates.
+     */
+    struct GeometryLayout
+    {
+        std::vector<std::size_t> tokens;
+        std::vector<double> coords;
+        Envelope2 mbr;
+    };
+
+    class FeatureTileCursor : public FeatureCursor2
+    {
+    public :
+        FeatureTileCursor(const FeatureTileData &data) NOTHROWS;
+    public :
+        TAKErr open() NOTHROWS;
+    public: // FeatureCursor2
+        TAKErr getId(int64_t *value) NOTHROWS override;
+        TAKErr getFeatureSetId(int64_t *value) NOTHROWS override;
+        TAKErr getVersion(int64_t *value) NOTHROWS override;
+    public: // FeatureDefinition2
+        TAKErr getRawGeometry(FeatureDefinition2::RawData *value) NOTHROWS override;
+        FeatureDefinition2::GeometryEncoding getGeomCoding() NOTHROWS override;
+        AltitudeMode getAltitudeMode() NOTHROWS override;
+        double getExtrude() NOTHROWS override;
+        TAKErr getName(const char **value) NOTHROWS override;
+        FeatureDefinition2::StyleEncoding getStyleCoding() NOTHROWS override;
+        TAKErr getRawStyle(FeatureDefinition2::RawData *value) NOTHROWS override;
+        TAKErr getAttributes(const atakmap::util::AttributeSet **value) NOTHROWS override;
+        TAKErr get(const Feature2 **feature) NOTHROWS override;
+    public: // RowIterator
+        TAKErr moveToNext() NOTHROWS override;
+    private :
+        FeatureTileData data;
+        MemoryInput2 input;
+        FeatureTileKey key;
+        Envelope2 bounds;
+        std::size_t extent;
+        std::vector<std::string> styles;
+        std::size_t remaining;
+
+        int64_t fid;
+        int64_t version;
+        std::size_t style;
+        std::string name;
+        AltitudeMode altitudeMode;
+        double extrude;
+        bool hasGeometry;
+        GeometryLayout layout;
+        DynamicOutput blob;
+        FeaturePtr_const feature;
+        atakmap::util::AttributeSet attributes;
+    };
+
+    TAKErr writeVarint(DataOutput2 &sink, uint64_t value) NOTHROWS;
+    TAKErr writeZigZag(DataOutput2 &sink, const int64_t value) NOTHROWS;
+    TAKErr writeDouble(DataOutput2 &sink, const double value) NOTHROWS;
+    TAKErr writeString(DataOutput2 &sink, const char *value) NOTHROWS;
+    TAKErr writeGeometry(DataOutput2 &sink, Quantizer &q, const Geometry2 &geometry) NOTHROWS;
+    TAKErr writeLeaves(DataOutput2 &sink, Quantizer &q, const GeometryCollection2 &collection, const std::size_t depth) NOTHROWS;
+    TAKErr countLeaves(std::size_t *value, const GeometryCollection2 &collection, const std::size_t depth) NOTHROWS;
+    TAKErr writePoint(DataOutput2 &sink, Quantizer &q, const double x, const double y, const double z, const bool is3D) NOTHROWS;
+    TAKErr writeRing(DataOutput2 &sink, Quantizer &q, const LineString2 &ring) NOTHROWS;
+
+    TAKErr readVarint(uint64_t *value, DataInput2 &src) NOTHROWS;
+    TAKErr readCount(std::size_t *value, DataInput2 &src) NOTHROWS;
+    TAKErr readZigZag(int64_t *value, DataInput2 &src) NOTHROWS;
+    TAKErr readDouble(double *value, DataInput2 &src) NOTHROWS;
+    TAKErr readString(std::string &value, DataInput2 &src) NOTHROWS;
+    TAKErr readHeader(FeatureTileKey *key, std::size_t *extent, DataInput2 &src) NOTHROWS;
+    TAKErr decodeGeometry(GeometryLayout &layout, DataInput2 &src, Quantizer &q, const bool member) NOTHROWS;
+    TAKErr decodeRing(GeometryLayout &layout, DataInput2 &src, Quantizer &q, const bool is3D) NOTHROWS;
+    TAKErr writeBlob(DynamicOutput &blob, const GeometryLayout &layout) NOTHROWS;
+
+    TAKErr getGeometry(Geometry2Ptr &value, FeatureCursor2 &features) NOTHROWS;
+    TAKErr getStyle(std::string &value, FeatureCursor2 &features) NOTHROWS;
+}
+
+TAKErr TAK::Engine::Feature::FeatureTile_encode(DataOutput2 &sink, const FeatureTileKey &key, const std::size_t extent, FeatureCursor2 &features) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!extent)
+        return TE_InvalidArg;
+
+    Envelope2 bounds;
+    code = FeatureTile_getBounds(&bounds, key.level, key.x, key.y);
+    TE_CHECKRETURN_CODE(code);
+
+    // the style table is only known once all features have been visited;
+    // records are buffered and emitted following the header
+    std::map<std::string, std::size_t> styleIndex;
+    std::vector<const std::string *> styles;
+    std::size_t count = 0u;
+
+    DynamicOutput records;
+    code = records.open(64u * 1024u);
+    TE_CHECKRETURN_CODE(code);
+
+    std::string ogr;
+    do {
+        code = features.moveToNext();
+        TE_CHECKBREAK_CODE(code);
+
+        int64_t fid;
+        code = features.getId(&fid);
+        TE_CHECKBREAK_CODE(code);
+        int64_t version;
+        code = features.getVersion(&version);
+        TE_CHECKBREAK_CODE(code);
+
+        Geometry2Ptr geometry(nullptr, nullptr);
+        code = getGeometry(geometry, features);
+        TE_CHECKBREAK_CODE(code);
+
+        code = getStyle(ogr, features);
+        TE_CHECKBREAK_CODE(code);
+        std::size_t style = 0u;
+        if (!ogr.empty()) {
+            auto entry = styleIndex.find(ogr);
+            if (entry == styleIndex.end()) {
+                entry = styleIndex.insert(std::make_pair(ogr, styles.size())).first;
+                styles.push_back(&entry->first);
+            }
+            style = entry->second + 1u;
+        }
+
+        const char *name = nullptr;
+        code = features.getName(&name);
+        TE_CHECKBREAK_CODE(code);
+
+        code = writeZigZag(records, fid);
+        TE_CHECKBREAK_CODE(code);
+        code = writeZigZag(records, version);
+        TE_CHECKBREAK_CODE(code);
+        code = writeVarint(records, style);
+        TE_CHECKBREAK_CODE(code);
+        code = writeString(records, name);
+        TE_CHECKBREAK_CODE(code);
+        code = records.writeByte(static_cast<uint8_t>(features.getAltitudeMode()));
+        TE_CHECKBREAK_CODE(code);
+        code = writeDouble(records, features.getExtrude());
+        TE_CHECKBREAK_CODE(code);
+
+        // coordinates are delta coded per feature so that each record may
+        // be decoded independently
+        Quantizer q(bounds, extent);
+        if (geometry.get())
+            code = writeGeometry(records, q, *geometry);
+        else
+            code = records.writeByte(GT_None);
+        TE_CHECKBREAK_CODE(code);
+
+        count++;
+    } while (true);
+    if (code == TE_Done)
+        code = TE_Ok;
+    TE_CHECKRETURN_CODE(code);
+
+    // header
+    code = sink.write(TILE_MAGIC, sizeof(TILE_MAGIC));
+    TE_CHECKRETURN_CODE(code);
+    code = sink.writeByte(TILE_FORMAT_VERSION);
+    TE_CHECKRETURN_CODE(code);
+    code = writeVarint(sink, static_cast<uint64_t>(key.level));
+    TE_CHECKRETURN_CODE(code);
+    code = writeVarint(sink, static_cast<uint64_t>(key.x));
+    TE_CHECKRETURN_CODE(code);
+    code = writeVarint(sink, static_cast<uint64_t>(key.y));
+    TE_CHECKRETURN_CODE(code);
+    code = writeZigZag(sink, key.fsid);
+    TE_CHECKRETURN_CODE(code);
+    code = writeZigZag(sink, key.fsVersion);
+    TE_CHECKRETURN_CODE(code);
+    code = writeVarint(sink, extent);
+    TE_CHECKRETURN_CODE(code);
+
+    // style table
+    code = writeVarint(sink, styles.size());
+    TE_CHECKRETURN_CODE(code);
+    for (std::size_t i = 0u; i < styles.size(); i++) {
+        code = writeString(sink, styles[i]->c_str());
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    // features
+    code = writeVarint(sink, count);
+    TE_CHECKRETURN_CODE(code);
+    const uint8_t *buf;
+    std::size_t len;
+    code = records.get(&buf, &len);
+    TE_CHECKRETURN_CODE(code);
+    if (len) {
+        code = sink.write(buf, len);
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    return code;
+}
+
+TAKErr TAK::Engine::Feature::FeatureTile_getKey(FeatureTileKey *value, const uint8_t *data, const std::size_t len) NOTHROWS
+{
+    if (!value || !data)
+        return TE_InvalidArg;
+    MemoryInput2 src;
+    TAKErr code = src.open(data, len);
+    TE_CHECKRETURN_CODE(code);
+    std::size_t extent;
+    return readHeader(value, &extent, src);
+}
+
+TAKErr TAK::Engine::Feature::FeatureTile_decode(FeatureCursorPtr &value, const FeatureTileData &data) NOTHROWS
+{
+    if (!data.get())
+        return TE_InvalidArg;
+    std::unique_ptr<FeatureTileCursor> cursor(new(std::nothrow) FeatureTileCursor(data));
+    if (!cursor.get())
+        return TE_OutOfMemory;
+    TAKErr code = cursor->open();
+    TE_CHECKRETURN_CODE(code);
+    value = FeatureCursorPtr(cursor.release(), Memory_deleter_const<FeatureCursor2, FeatureTileCursor>);
+    return TE_Ok;
+}
+
+TAKErr TAK::Engine::Feature::FeatureTile_getBounds(Envelope2 *value, const int level, const int x, const int y) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (level < 0 || level > 30)
+        return TE_InvalidArg;
+    const int dim = 1 << level;
+    if (x < 0 || x >= dim || y < 0 || y >= dim)
+        return TE_InvalidArg;
+    value->minX = OSMUtils::mapnikTileLng(level, x);
+    value->maxX = OSMUtils::mapnikTileLng(level, x + 1);
+    value->minY = OSMUtils::mapnikTileLat(level, y + 1);
+    value->maxY = OSMUtils::mapnikTileLat(level, y);
+    value->minZ = 0.0;
+    value->maxZ = 0.0;
+    return TE_Ok;
+}
+
+namespace
+{
+    Quantizer::Quantizer(const Envelope2 &bounds, const std::size_t extent) NOTHROWS :
+        originX(bounds.minX),
+        originY(bounds.maxY),
+        scaleX((double)extent / (bounds.maxX - bounds.minX)),
+        scaleY((double)extent / (bounds.maxY - bounds.minY))
+    {}
+
+    FeatureTileCursor::FeatureTileCursor(const FeatureTileData &data_) NOTHROWS :
+        data(data_),
+        extent(0u),
+        remaining(0u),
+        fid(0LL),
+        version(0LL),
+        style(0u),
+        altitudeMode(TEAM_ClampToGround),
+        extrude(0.0),
+        hasGeometry(false),
+        feature(nullptr, nullptr)
+    {}
+
+    TAKErr FeatureTileCursor::open() NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = input.open(data->empty() ? nullptr : &data->at(0), data->size());
+        TE_CHECKRETURN_CODE(code);
+        code = readHeader(&key, &extent, input);
+        TE_CHECKRETURN_CODE(code);
+        code = FeatureTile_getBounds(&bounds, key.level, key.x, key.y);
+        TE_CHECKRETURN_CODE(code);
+
+        std::size_t numStyles;
+        code = readCount(&numStyles, input);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < numStyles; i++) {
+            std::string ogr;
+            code = readString(ogr, input);
+            TE_CHECKRETURN_CODE(code);
+            styles.push_back(std::move(ogr));
+        }
+
+        code = readCount(&remaining, input);
+        TE_CHECKRETURN_CODE(code);
+
+        code = blob.open(1024u);
+        TE_CHECKRETURN_CODE(code);
+        return code;
+    }
+
+    TAKErr FeatureTileCursor::getId(int64_t *value) NOTHROWS
+    {
+        *value = fid;
+        return TE_Ok;
+    }
+    TAKErr FeatureTileCursor::getFeatureSetId(int64_t *value) NOTHROWS
+    {
+        *value = key.fsid;
+        return TE_Ok;
+    }
+    TAKErr FeatureTileCursor::getVersion(int64_t *value) NOTHROWS
+    {
+        *value = version;
+        return TE_Ok;
+    }
+    TAKErr FeatureTileCursor::getRawGeometry(FeatureDefinition2::RawData *value) NOTHROWS
+    {
+        if (!hasGeometry) {
+            value->binary.value = nullptr;
+            value->binary.len = 0u;
+            return TE_Ok;
+        }
+        return blob.get(&value->binary.value, &value->binary.len);
+    }
+    FeatureDefinition2::GeometryEncoding FeatureTileCursor::getGeomCoding() NOTHROWS
+    {
+        return FeatureDefinition2::GeomBlob;
+    }
+    AltitudeMode FeatureTileCursor::getAltitudeMode() NOTHROWS
+    {
+        return altitudeMode;
+    }
+    double FeatureTileCursor::getExtrude() NOTHROWS
+    {
+        return extrude;
+    }
+    TAKErr FeatureTileCursor::getName(const char **value) NOTHROWS
+    {
+        *value = name.c_str();
+        return TE_Ok;
+    }
+    FeatureDefinition2::StyleEncoding FeatureTileCursor::getStyleCoding() NOTHROWS
+    {
+        return FeatureDefinition2::StyleOgr;
+    }
+    TAKErr FeatureTileCursor::getRawStyle(FeatureDefinition2::RawData *value) NOTHROWS
+    {
+        value->text = style ? styles[style - 1u].c_str() : nullptr;
+        return TE_Ok;
+    }
+    TAKErr FeatureTileCursor::getAttributes(const atakmap::util::AttributeSet **value) NOTHROWS
+    {
+        *value = &attributes;
+        return TE_Ok;
+    }
+    TAKErr FeatureTileCursor::get(const Feature2 **value) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (!feature.get()) {
+            GeometryPtr legacyGeometry(nullptr, nullptr);
+            if (hasGeometry) {
+                const uint8_t *buf;
+                std::size_t len;
+                code = blob.get(&buf, &len);
+                TE_CHECKRETURN_CODE(code);
+                Geometry2Ptr geometry(nullptr, nullptr);
+                code = GeometryFactory_fromSpatiaLiteBlob(geometry, buf, len);
+                TE_CHECKRETURN_CODE(code);
+                code = LegacyAdapters_adapt(legacyGeometry, *geometry);
+                TE_CHECKRETURN_CODE(code);
+            }
+            StylePtr_const legacyStyle(nullptr, nullptr);
+            if (style) {
+                code = atakmap::feature::Style_parseStyleShared(legacyStyle, styles[style - 1u].c_str());
+                TE_CHECKRETURN_CODE(code);
+            }
+            feature = FeaturePtr_const(
+                new Feature2(fid, key.fsid, name.c_str(), GeometryPtr_const(std::move(legacyGeometry)), altitudeMode, extrude, std::move(legacyStyle),
+                             AttributeSetPtr_const(new atakmap::util::AttributeSet(), Memory_deleter_const<atakmap::util::AttributeSet>), version),
+                Memory_deleter_const<Feature2>);
+        }
+        *value = feature.get();
+        return code;
+    }
+    TAKErr FeatureTileCursor::moveToNext() NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (!remaining)
+            return TE_Done;
+
+        feature.reset();
+        hasGeometry = false;
+
+        code = readZigZag(&fid, input);
+        TE_CHECKRETURN_CODE(code);
+        code = readZigZag(&version, input);
+        TE_CHECKRETURN_CODE(code);
+        uint64_t styleIndex;
+        code = readVarint(&styleIndex, input);
+        TE_CHECKRETURN_CODE(code);
+        if (styleIndex > styles.size())
+            return TE_IO;
+        style = static_cast<std::size_t>(styleIndex);
+        code = readString(name, input);
+        TE_CHECKRETURN_CODE(code);
+        uint8_t b;
+        code = input.readByte(&b);
+        TE_CHECKRETURN_CODE(code);
+        if (b > TEAM_Absolute)
+            return TE_IO;
+        altitudeMode = static_cast<AltitudeMode>(b);
+        code = readDouble(&extrude, input);
+        TE_CHECKRETURN_CODE(code);
+
+        // the geometry is decoded and then written directly as a SpatiaLite
+        // blob, avoiding construction of an intermediate geometry
+        layout.tokens.clear();
+        layout.coords.clear();
+        Quantizer q(bounds, extent);
+        code = decodeGeometry(layout, input, q, false);
+        TE_CHECKRETURN_CODE(code);
+
+        if (layout.tokens[0u] != GT_None) {
+            code = blob.reset();
+            TE_CHECKRETURN_CODE(code);
+            code = writeBlob(blob, layout);
+            TE_CHECKRETURN_CODE(code);
+            hasGeometry = true;
+        }
+
+        remaining--;
+        return code;
+    }
+
+    TAKErr writeVarint(DataOutput2 &sink, uint64_t value) NOTHROWS
+    {
+        uint8_t buf[10u];
+        std::size_t len = 0u;
+        do {
+            uint8_t b = static_cast<uint8_t>(value & 0x7Fu);
+            value >>= 7u;
+            if (value)
+                b |= 0x80u;
+            buf[len++] = b;
+        } while (value);
+        return sink.write(buf, len);
+    }
+    TAKErr writeZigZag(DataOutput2 &sink, const int64_t value) NOTHROWS
+    {
+        return writeVarint(sink, (static_cast<uint64_t>(value) << 1u) ^ static_cast<uint64_t>(value >> 63));
+    }
+    TAKErr writeDouble(DataOutput2 &sink, const double value) NOTHROWS
+    {
+        // little endian, independent of the host
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint8_t buf[8u];
+        for (std::size_t i = 0u; i < 8u; i++)
+            buf[i] = static_cast<uint8_t>((bits >> (8u * i)) & 0xFFu);
+        return sink.write(buf, 8u);
+    }
+    TAKErr writeString(DataOutput2 &sink, const char *value) NOTHROWS
+    {
+        const std::size_t len = value ? strlen(value) : 0u;
+        TAKErr code = writeVarint(sink, len);
+        TE_CHECKRETURN_CODE(code);
+        if (len)
+            code = sink.write(reinterpret_cast<const uint8_t *>(value), len);
+        return code;
+    }
+    TAKErr writePoint(DataOutput2 &sink, Quantizer &q, const double x, const double y, const double z, const bool is3D) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const int64_t qx = llround((x - q.originX) * q.scaleX);
+        const int64_t qy = llround((q.originY - y) * q.scaleY);
+        code = writeZigZag(sink, qx - q.lastX);
+        TE_CHECKRETURN_CODE(code);
+        code = writeZigZag(sink, qy - q.lastY);
+        TE_CHECKRETURN_CODE(code);
+        q.lastX = qx;
+        q.lastY = qy;
+        if (is3D) {
+            // centimeter precision
+            const int64_t qz = llround(z * 100.0);
+            code = writeZigZag(sink, qz - q.lastZ);
+            TE_CHECKRETURN_CODE(code);
+            q.lastZ = qz;
+        }
+        return code;
+    }
+    TAKErr writeRing(DataOutput2 &sink, Quantizer &q, const LineString2 &ring) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const bool is3D = (ring.getDimension() == 3u);
+        const std::size_t numPoints = ring.getNumPoints();
+        code = writeVarint(sink, numPoints);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < numPoints; i++) {
+            double x, y, z = 0.0;
+            code = ring.getX(&x, i);
+            TE_CHECKRETURN_CODE(code);
+            code = ring.getY(&y, i);
+            TE_CHECKRETURN_CODE(code);
+            if (is3D) {
+                code = ring.getZ(&z, i);
+                TE_CHECKRETURN_CODE(code);
+            }
+            code = writePoint(sink, q, x, y, z, is3D);
+            TE_CHECKRETURN_CODE(code);
+        }
+        return code;
+    }
+    TAKErr writeGeometry(DataOutput2 &sink, Quantizer &q, const Geometry2 &geometry) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const bool is3D = (geometry.getDimension() == 3u);
+        const uint8_t dimFlag = is3D ? GT_3D : 0u;
+        switch (geometry.getClass()) {
+        case TEGC_Point :
+        {
+            const auto &point = static_cast<const Point2 &>(geometry);
+            code = sink.writeByte(GT_Point | dimFlag);
+            TE_CHECKRETURN_CODE(code);
+            code = writePoint(sink, q, point.x, point.y, point.z, is3D);
+            break;
+        }
+        case TEGC_LineString :
+            code = sink.writeByte(GT_LineString | dimFlag);
+            TE_CHECKRETURN_CODE(code);
+            code = writeRing(sink, q, static_cast<const LineString2 &>(geometry));
+            break;
+        case TEGC_Polygon :
+        {
+            const auto &polygon = static_cast<const Polygon2 &>(geometry);
+            code = sink.writeByte(GT_Polygon | dimFlag);
+            TE_CHECKRETURN_CODE(code);
+            const std::size_t numInteriorRings = polygon.getNumInteriorRings();
+            code = writeVarint(sink, numInteriorRings);
+            TE_CHECKRETURN_CODE(code);
+            std::shared_ptr<LineString2> ring;
+            code = polygon.getExteriorRing(ring);
+            TE_CHECKRETURN_CODE(code);
+            code = writeRing(sink, q, *ring);
+            TE_CHECKRETURN_CODE(code);
+            for (std::size_t i = 0u; i < numInteriorRings; i++) {
+                code = polygon.getInteriorRing(ring, i);
+                TE_CHECKRETURN_CODE(code);
+                code = writeRing(sink, q, *ring);
+                TE_CHECKRETURN_CODE(code);
+            }
+            break;
+        }
+        case TEGC_GeometryCollection :
+        {
+            // SpatiaLite does not support nested collections; members of
+            // nested collections are written as members of the outermost
+            const auto &collection = static_cast<const GeometryCollection2 &>(geometry);
+            std::size_t numLeaves;
+            code = countLeaves(&numLeaves, collection, 0u);
+            TE_CHECKRETURN_CODE(code);
+            code = sink.writeByte(GT_Collection | dimFlag);
+            TE_CHECKRETURN_CODE(code);
+            code = writeVarint(sink, numLeaves);
+            TE_CHECKRETURN_CODE(code);
+            code = writeLeaves(sink, q, collection, 0u);
+            break;
+        }
+        default :
+            return TE_IllegalState;
+        }
+        return code;
+    }
+    TAKErr countLeaves(std::size_t *value, const GeometryCollection2 &collection, const std::size_t depth) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (depth >= MAX_COLLECTION_DEPTH)
+            return TE_InvalidArg;
+        *value = 0u;
+        const std::size_t numChildren = collection.getNumGeometries();
+        for (std::size_t i = 0u; i < numChildren; i++) {
+            std::shared_ptr<Geometry2> child;
+            code = collection.getGeometry(child, i);
+            TE_CHECKRETURN_CODE(code);
+            if (child->getClass() == TEGC_GeometryCollection) {
+                std::size_t n;
+                code = countLeaves(&n, static_cast<const GeometryCollection2 &>(*child), depth + 1u);
+                TE_CHECKRETURN_CODE(code);
+                *value += n;
+            } else {
+                (*value)++;
+            }
+        }
+        return code;
+    }
+    TAKErr writeLeaves(DataOutput2 &sink, Quantizer &q, const GeometryCollection2 &collection, const std::size_t depth) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const std::size_t numChildren = collection.getNumGeometries();
+        for (std::size_t i = 0u; i < numChildren; i++) {
+            std::shared_ptr<Geometry2> child;
+            code = collection.getGeometry(child, i);
+            TE_CHECKRETURN_CODE(code);
+            if (child->getClass() == TEGC_GeometryCollection)
+                code = writeLeaves(sink, q, static_cast<const GeometryCollection2 &>(*child), depth + 1u);
+            else
+                code = writeGeometry(sink, q, *child);
+            TE_CHECKRETURN_CODE(code);
+        }
+        return code;
+    }
+
+    TAKErr readVarint(uint64_t *value, DataInput2 &src) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        uint64_t v = 0u;
+        for (std::size_t shift = 0u; shift < 64u; shift += 7u) {
+            uint8_t b;
+            code = src.readByte(&b);
+            TE_CHECKRETURN_CODE(code);
+            v |= static_cast<uint64_t>(b & 0x7Fu) << shift;
+            if (!(b & 0x80u)) {
+                *value = v;
+                return TE_Ok;
+            }
+        }
+        // overlong encoding
+        return TE_IO;
+    }
+    TAKErr readCount(std::size_t *value, DataInput2 &src) NOTHROWS
+    {
+        uint64_t v;
+        TAKErr code = readVarint(&v, src);
+        TE_CHECKRETURN_CODE(code);
+        // a count may not exceed the number of bytes remaining
+        const uint8_t *next;
+        std::size_t avail;
+        if (src.peek(&next, &avail) == TE_Ok && v > avail)
+            return TE_IO;
+        *value = static_cast<std::size_t>(v);
+        return code;
+    }
+    TAKErr readZigZag(int64_t *value, DataInput2 &src) NOTHROWS
+    {
+        uint64_t v;
+        TAKErr code = readVarint(&v, src);
+        TE_CHECKRETURN_CODE(code);
+        *value = static_cast<int64_t>(v >> 1u) ^ -static_cast<int64_t>(v & 1u);
+        return code;
+    }
+    TAKErr readDouble(double *value, DataInput2 &src) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        uint64_t bits = 0u;
+        for (std::size_t i = 0u; i < 8u; i++) {
+            uint8_t b;
+            code = src.readByte(&b);
+            TE_CHECKRETURN_CODE(code);
+            bits |= static_cast<uint64_t>(b) << (8u * i);
+        }
+        memcpy(value, &bits, sizeof(bits));
+        return code;
+    }
+    TAKErr readString(std::string &value, DataInput2 &src) NOTHROWS
+    {
+        std::size_t len;
+        TAKErr code = readCount(&len, src);
+        TE_CHECKRETURN_CODE(code);
+        if (!len) {
+            value.clear();
+            return code;
+        }
+        const uint8_t *span;
+        code = src.readSpan(&span, len);
+        TE_CHECKRETURN_CODE(code);
+        value.assign(reinterpret_cast<const char *>(span), len);
+        return code;
+    }
+    TAKErr readHeader(FeatureTileKey *key, std::size_t *extent, DataInput2 &src) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        uint8_t magic[sizeof(TILE_MAGIC)];
+        std::size_t numRead;
+        code = src.read(magic, &numRead, sizeof(magic));
+        if (code != TE_Ok || numRead != sizeof(magic) || memcmp(magic, TILE_MAGIC, sizeof(magic)))
+            return TE_InvalidArg;
+        uint8_t formatVersion;
+        code = src.readByte(&formatVersion);
+        if (code != TE_Ok || formatVersion != TILE_FORMAT_VERSION)
+            return TE_InvalidArg;
+
+        uint64_t v;
+        code = readVarint(&v, src);
+        TE_CHECKRETURN_CODE(code);
+        if (v > 30u)
+            return TE_InvalidArg;
+        key->level = static_cast<int>(v);
+        code = readVarint(&v, src);
+        TE_CHECKRETURN_CODE(code);
+        if (v >= (1u << key->level))
+            return TE_InvalidArg;
+        key->x = static_cast<int>(v);
+        code = readVarint(&v, src);
+        TE_CHECKRETURN_CODE(code);
+        if (v >= (1u << key->level))
+            return TE_InvalidArg;
+        key->y = static_cast<int>(v);
+        code = readZigZag(&key->fsid, src);
+        TE_CHECKRETURN_CODE(code);
+        code = readZigZag(&key->fsVersion, src);
+        TE_CHECKRETURN_CODE(code);
+        code = readVarint(&v, src);
+        TE_CHECKRETURN_CODE(code);
+        if (!v || v > 0x7FFFFFFFu)
+            return TE_InvalidArg;
+        *extent = static_cast<std::size_t>(v);
+        return code;
+    }
+    TAKErr decodePoint(GeometryLayout &layout, DataInput2 &src, Quantizer &q, const bool is3D) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        int64_t dx, dy;
+        code = readZigZag(&dx, src);
+        TE_CHECKRETURN_CODE(code);
+        code = readZigZag(&dy, src);
+        TE_CHECKRETURN_CODE(code);
+        q.lastX += dx;
+        q.lastY += dy;
+        const double x = q.originX + (double)q.lastX / q.scaleX;
+        const double y = q.originY - (double)q.lastY / q.scaleY;
+        if (layout.coords.empty()) {
+            layout.mbr.minX = layout.mbr.maxX = x;
+            layout.mbr.minY = layout.mbr.maxY = y;
+        } else {
+            layout.mbr.minX = std::min(layout.mbr.minX, x);
+            layout.mbr.minY = std::min(layout.mbr.minY, y);
+            layout.mbr.maxX = std::max(layout.mbr.maxX, x);
+            layout.mbr.maxY = std::max(layout.mbr.maxY, y);
+        }
+        layout.coords.push_back(x);
+        layout.coords.push_back(y);
+        if (is3D) {
+            int64_t dz;
+            code = readZigZag(&dz, src);
+            TE_CHECKRETURN_CODE(code);
+            q.lastZ += dz;
+            layout.coords.push_back((double)q.lastZ / 100.0);
+        }
+        return code;
+    }
+    TAKErr decodeRing(GeometryLayout &layout, DataInput2 &src, Quantizer &q, const bool is3D) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        std::size_t numPoints;
+        code = readCount(&numPoints, src);
+        TE_CHECKRETURN_CODE(code);
+        layout.tokens.push_back(numPoints);
+        layout.coords.reserve(layout.coords.size() + numPoints * (is3D ? 3u : 2u));
+        for (std::size_t i = 0u; i < numPoints; i++) {
+            code = decodePoint(layout, src, q, is3D);
+            TE_CHECKRETURN_CODE(code);
+        }
+        return code;
+    }
+    TAKErr decodeGeometry(GeometryLayout &layout, DataInput2 &src, Quantizer &q, const bool member) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        uint8_t tag;
+        code = src.readByte(&tag);
+        TE_CHECKRETURN_CODE(code);
+        layout.tokens.push_back(tag);
+        const bool is3D = !!(tag & GT_3D);
+        switch (tag & ~GT_3D) {
+        case GT_None :
+            if (member || is3D)
+                return TE_IO;
+            break;
+        case GT_Point :
+            code = decodePoint(layout, src, q, is3D);
+            break;
+        case GT_LineString :
+            code = decodeRing(layout, src, q, is3D);
+            break;
+        case GT_Polygon :
+        {
+            std::size_t numInteriorRings;
+            code = readCount(&numInteriorRings, src);
+            TE_CHECKRETURN_CODE(code);
+            layout.tokens.push_back(numInteriorRings + 1u);
+            for (std::size_t i = 0u; i <= numInteriorRings; i++) {
+                code = decodeRing(layout, src, q, is3D);
+                TE_CHECKRETURN_CODE(code);
+            }
+            break;
+        }
+        case GT_Collection :
+        {
+            if (member)
+                return TE_IO;
+            std::size_t numChildren;
+            code = readCount(&numChildren, src);
+            TE_CHECKRETURN_CODE(code);
+            layout.tokens.push_back(numChildren);
+            for (std::size_t i = 0u; i < numChildren; i++) {
+                code = decodeGeometry(layout, src, q, true);
+                TE_CHECKRETURN_CODE(code);
+            }
+            break;
+        }
+        default :
+            return TE_IO;
+        }
+        return code;
+    }
+    TAKErr writeBlobInt(DynamicOutput &blob, const uint32_t value) NOTHROWS
+    {
+        return blob.write(reinterpret_cast<const uint8_t *>(&value), sizeof(value));
+    }
+    TAKErr writeBlobCoords(DynamicOutput &blob, const double *coords, const std::size_t count) NOTHROWS
+    {
+        if (!count)
+            return TE_Ok;
+        return blob.write(reinterpret_cast<const uint8_t *>(coords), count * sizeof(double));
+    }
+    TAKErr writeBlobBody(DynamicOutput &blob, std::size_t &token, std::size_t &coord, const GeometryLayout &layout) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const std::size_t tag = layout.tokens[token++];
+        const bool is3D = !!(tag & GT_3D);
+        const std::size_t dim = is3D ? 3u : 2u;
+        const uint32_t dimOffset = is3D ? 1000u : 0u;
+        switch (tag & ~GT_3D) {
+        case GT_Point :
+            code = writeBlobInt(blob, 1u + dimOffset);
+            TE_CHECKRETURN_CODE(code);
+            code = writeBlobCoords(blob, &layout.coords[coord], dim);
+            coord += dim;
+            break;
+        case GT_LineString :
+        {
+            code = writeBlobInt(blob, 2u + dimOffset);
+            TE_CHECKRETURN_CODE(code);
+            const std::size_t numPoints = layout.tokens[token++];
+            code = writeBlobInt(blob, static_cast<uint32_t>(numPoints));
+            TE_CHECKRETURN_CODE(code);
+            code = writeBlobCoords(blob, numPoints ? &layout.coords[coord] : nullptr, numPoints * dim);
+            coord += numPoints * dim;
+            break;
+        }
+        case GT_Polygon :
+        {
+            code = writeBlobInt(blob, 3u + dimOffset);
+            TE_CHECKRETURN_CODE(code);
+            const std::size_t numRings = layout.tokens[token++];
+            code = writeBlobInt(blob, static_cast<uint32_t>(numRings));
+            TE_CHECKRETURN_CODE(code);
+            for (std::size_t i = 0u; i < numRings; i++) {
+                const std::size_t numPoints = layout.tokens[token++];
+                code = writeBlobInt(blob, static_cast<uint32_t>(numPoints));
+                TE_CHECKRETURN_CODE(code);
+                code = writeBlobCoords(blob, numPoints ? &layout.coords[coord] : nullptr, numPoints * dim);
+                TE_CHECKRETURN_CODE(code);
+                coord += numPoints * dim;
+            }
+            break;
+        }
+        case GT_Collection :
+        {
+            code = writeBlobInt(blob, 7u + dimOffset);
+            TE_CHECKRETURN_CODE(code);
+            const std::size_t numChildren = layout.tokens[token++];
+            code = writeBlobInt(blob, static_cast<uint32_t>(numChildren));
+            TE_CHECKRETURN_CODE(code);
+            for (std::size_t i = 0u; i < numChildren; i++) {
+                // entity marker
+                code = blob.writeByte(0x69u);
+                TE_CHECKRETURN_CODE(code);
+                code = writeBlobBody(blob, token, coord, layout);
+                TE_CHECKRETURN_CODE(code);
+            }
+            break;
+        }
+        default :
+            return TE_IllegalState;
+        }
+        return code;
+    }
+    TAKErr writeBlob(DynamicOutput &blob, const GeometryLayout &layout) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        // start, endian
+        code = blob.writeByte(0x00u);
+        TE_CHECKRETURN_CODE(code);
+        code = blob.writeByte(TE_PlatformEndian == TE_LittleEndian ? 0x01u : 0x00u);
+        TE_CHECKRETURN_CODE(code);
+        code = writeBlobInt(blob, TILE_SRID);
+        TE_CHECKRETURN_CODE(code);
+        double mbr[4u] = { 0.0, 0.0, 0.0, 0.0 };
+        if (!layout.coords.empty()) {
+            mbr[0u] = layout.mbr.minX;
+            mbr[1u] = layout.mbr.minY;
+            mbr[2u] = layout.mbr.maxX;
+            mbr[3u] = layout.mbr.maxY;
+        }
+        code = writeBlobCoords(blob, mbr, 4u);
+        TE_CHECKRETURN_CODE(code);
+        // MBR end
+        code = blob.writeByte(0x7Cu);
+        TE_CHECKRETURN_CODE(code);
+        std::size_t token = 0u;
+        std::size_t coord = 0u;
+        code = writeBlobBody(blob, token, coord, layout);
+        TE_CHECKRETURN_CODE(code);
+        // end
+        code = blob.writeByte(0xFEu);
+        TE_CHECKRETURN_CODE(code);
+        return code;
+    }
+
+    TAKErr getGeometry(Geometry2Ptr &value, FeatureCursor2 &features) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        FeatureDefinition2::RawData raw;
+        switch (features.getGeomCoding()) {
+        case FeatureDefinition2::GeomBlob :
+            code = features.getRawGeometry(&raw);
+            TE_CHECKRETURN_CODE(code);
+            if (!raw.binary.value || !raw.binary.len)
+                return TE_Ok;
+            return GeometryFactory_fromSpatiaLiteBlob(value, raw.binary.value, raw.binary.len);
+        case FeatureDefinition2::GeomWkb :
+            code = features.getRawGeometry(&raw);
+            TE_CHECKRETURN_CODE(code);
+            if (!raw.binary.value || !raw.binary.len)
+                return TE_Ok;
+            return GeometryFactory_fromWkb(value, raw.binary.value, raw.binary.len);
+        case FeatureDefinition2::GeomGeometry :
+            code = features.getRawGeometry(&raw);
+            TE_CHECKRETURN_CODE(code);
+            if (!raw.object)
+                return TE_Ok;
+            return LegacyAdapters_adapt(value, *static_cast<const atakmap::feature::Geometry *>(raw.object));
+        default :
+        {
+            const Feature2 *feature;
+            code = features.get(&feature);
+            TE_CHECKRETURN_CODE(code);
+            if (!feature->getGeometry())
+                return TE_Ok;
+            return LegacyAdapters_adapt(value, *feature->getGeometry());
+        }
+        }
+    }
+    TAKErr getStyle(std::string &value, FeatureCursor2 &features) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        value.clear();
+        FeatureDefinition2::RawData raw;
+        code = features.getRawStyle(&raw);
+        TE_CHECKRETURN_CODE(code);
+        if (features.getStyleCoding() == FeatureDefinition2::StyleOgr) {
+            if (raw.text)
+                value = raw.text;
+        } else if (raw.object) {
+            TAK::Engine::Port::String ogr;
+            code = static_cast<const atakmap::feature::Style *>(raw.object)->toOGR(ogr);
+            TE_CHECKRETURN_CODE(code);
+            if (ogr.get())
+                value = ogr.get();
+        }
+        return code;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef TAK_ENGINE_FEATURE_FEATURETILE_H_INCLUDED
+#define TAK_ENGINE_FEATURE_FEATURETILE_H_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "feature/Envelope2.h"
+#include "feature/FeatureCursor2.h"
+#include "feature/FeatureDataStore2.h"
+#include "port/Platform.h"
+#include "util/DataOutput2.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Feature {
+            /**
+             * Identifies the content of a feature tile: the features of a
+             * single feature set, at a given version of that feature set,
+             * that intersect an OSM (mapnik) tile.
+             */
+            struct ENGINE_API FeatureTileKey
+            {
+                int level {0};
+                int x {0};
+                int y {0};
+                int64_t fsid {0};
+                int64_t fsVersion {0};
+            };
+
+            /** The encoded tile bytes; immutable once produced. */
+            typedef std::shared_ptr<const std::vector<uint8_t>> FeatureTileData;
+
+            /**
+             * Encodes the features of `features` into a compact binary tile.
+             *
+             * <P>The tile is a header (magic, `key`, quantization extent),
+             * a table of the distinct OGR styles, then one record per
+             * feature holding its ID, version, style index, name, altitude
+             * mode, extrude and geometry. Coordinates are quantized to
+             * `extent` units across the tile bounds and written as
+             * zig-zag, delta coded varints. Geometries are not clipped to
+             * the tile; coordinates beyond the tile bounds are encoded
+             * relative to the tile origin.
+             *
+             * <P>Feature attributes are not retained.
+             *
+             * @param sink      The encoded tile is written to the sink
+             * @param key       The tile key
+             * @param extent    The number of quantization units across the tile
+             * @param features  The features to be encoded; consumed
+             *
+             * @return  TE_Ok on success, various codes on failure
+             */
+            ENGINE_API Util::TAKErr FeatureTile_encode(Util::DataOutput2 &sink, const FeatureTileKey &key, const std::size_t extent, FeatureCursor2 &features) NOTHROWS;
+            /**
+             * Reads the key from the header of an encoded tile.
+             *
+             * @return  TE_Ok on success, TE_InvalidArg if `data` is not an
+             *          encoded tile
+             */
+            ENGINE_API Util::TAKErr FeatureTile_getKey(FeatureTileKey *value, const uint8_t *data, const std::size_t len) NOTHROWS;
+            /**
+             * Opens a cursor over the features of an encoded tile. The
+             * cursor reports geometry as SpatiaLite blobs and style as OGR
+             * strings. The cursor shares ownership of `data`.
+             */
+            ENGINE_API Util::TAKErr FeatureTile_decode(FeatureCursorPtr &value, const FeatureTileData &data) NOTHROWS;
+            /**
+             * Returns the WGS84 bounds of the specified OSM (mapnik) tile.
+             */
+            ENGINE_API Util::TAKErr FeatureTile_getBounds(Envelope2 *value, const int level, const int x, const int y) NOTHROWS;
+        }
+    }
+}
+
+#endif
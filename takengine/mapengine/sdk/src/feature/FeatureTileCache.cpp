@@ -0,0 +1,377 @@
+#include "feature/FeatureTileCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "feature/FeatureSet2.h"
+#include "feature/FeatureSetCursor2.h"
+#include "feature/LineString.h"
+#include "feature/MultiplexingFeatureCursor.h"
+#include "feature/Polygon.h"
+#include "port/StringBuilder.h"
+#include "raster/osm/OSMUtils.h"
+#include "thread/Lock.h"
+#include "util/DataInput2.h"
+#include "util/DataOutput2.h"
+#include "util/IO2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Feature;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+using namespace atakmap::raster::osm;
+
+// quantization units across a tile; 1/16 pixel for 256 pixel tiles
+#define FEATURE_TILE_EXTENT 4096u
+// queries spanning more tiles are rejected; the caller should query the
+// store directly
+#define MAX_QUERY_TILES 256
+// limit of the OSM tiling, in degrees latitude
+#define MAX_TILE_LATITUDE 85.0511
+
+namespace
+{
+    TAKErr generateTile(FeatureTileData &value, FeatureDataStore2 &store, const FeatureTileKey &key) NOTHROWS;
+    TAKErr readFile(FeatureTileData &value, const char *path) NOTHROWS;
+    TAKErr writeFile(const char *path, const FeatureTileData &data) NOTHROWS;
+}
+
+FeatureTileCache::FeatureTileCache(const std::size_t maxMemory_, const char *directory_) NOTHROWS :
+    maxMemory(maxMemory_),
+    memory(0u),
+    directory(directory_)
+{}
+
+FeatureTileCache::~FeatureTileCache() NOTHROWS
+{}
+
+TAKErr FeatureTileCache::get(FeatureTileData &value, const FeatureTileKey &key) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    {
+        Lock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+
+        auto entry = index.find(key);
+        if (entry != index.end()) {
+            // move to the front of the LRU list
+            entries.splice(entries.begin(), entries, entry->second);
+            value = entry->second->second;
+            return TE_Ok;
+        }
+    }
+
+    if (!directory)
+        return TE_Done;
+
+    String path;
+    code = getPath(path, key);
+    TE_CHECKRETURN_CODE(code);
+
+    FeatureTileData data;
+    if (readFile(data, path) != TE_Ok)
+        return TE_Done;
+
+    // the file may hold a tile for a different feature set version
+    FeatureTileKey fileKey;
+    if (FeatureTile_getKey(&fileKey, data->empty() ? nullptr : &data->at(0), data->size()) != TE_Ok)
+        return TE_Done;
+    if (KeyComp()(fileKey, key) || KeyComp()(key, fileKey))
+        return TE_Done;
+
+    {
+        Lock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        putImpl(key, data);
+    }
+    value = data;
+    return TE_Ok;
+}
+
+TAKErr FeatureTileCache::put(const FeatureTileKey &key, const FeatureTileData &data) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!data.get())
+        return TE_InvalidArg;
+    {
+        Lock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        putImpl(key, data);
+    }
+
+    if (directory) {
+        String path;
+        code = getPath(path, key);
+        TE_CHECKRETURN_CODE(code);
+        code = writeFile(path, data);
+        TE_CHECKRETURN_CODE(code);
+    }
+    return code;
+}
+
+TAKErr FeatureTileCache::clear() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    Lock lock(mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    index.clear();
+    entries.clear();
+    memory = 0u;
+
+    if (directory) {
+        bool exists;
+        if (IO_exists(&exists, directory) == TE_Ok && exists)
+            code = IO_delete(directory);
+    }
+    return code;
+}
+
+TAKErr FeatureTileCache::query(FeatureCursorPtr &value, FeatureDataStore2 &store, const Envelope2 &region, const int level) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (level < 0 || level > 30)
+        return TE_InvalidArg;
+
+    const int maxTile = (1 << level) - 1;
+    const int minTileX = std::max(OSMUtils::mapnikTileX(level, region.minX), 0);
+    const int maxTileX = std::min(OSMUtils::mapnikTileX(level, region.maxX), maxTile);
+    const int minTileY = std::max(OSMUtils::mapnikTileY(level, std::min(region.maxY, MAX_TILE_LATITUDE)), 0);
+    const int maxTileY = std::min(OSMUtils::mapnikTileY(level, std::max(region.minY, -MAX_TILE_LATITUDE)), maxTile);
+    if (maxTileX < minTileX || maxTileY < minTileY)
+        return TE_InvalidArg;
+    if ((int64_t)(maxTileX - minTileX + 1) * (int64_t)(maxTileY - minTileY + 1) > MAX_QUERY_TILES)
+        return TE_Unsupported;
+
+    // tiles are generated per visible feature set
+    std::vector<std::pair<int64_t, int64_t>> featureSets;
+    {
+        FeatureDataStore2::FeatureSetQueryParameters params;
+        params.visibleOnly = true;
+        FeatureSetCursorPtr result(nullptr, nullptr);
+        code = store.queryFeatureSets(result, params);
+        TE_CHECKRETURN_CODE(code);
+        do {
+            code = result->moveToNext();
+            TE_CHECKBREAK_CODE(code);
+            const FeatureSet2 *fs;
+            code = result->get(&fs);
+            TE_CHECKBREAK_CODE(code);
+            featureSets.push_back(std::make_pair(fs->getId(), fs->getVersion()));
+        } while (true);
+        if (code == TE_Done)
+            code = TE_Ok;
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    std::unique_ptr<MultiplexingFeatureCursor> retval(new MultiplexingFeatureCursor());
+    for (std::size_t i = 0u; i < featureSets.size(); i++) {
+        for (int y = minTileY; y <= maxTileY; y++) {
+            for (int x = minTileX; x <= maxTileX; x++) {
+                FeatureTileKey key;
+                key.level = level;
+                key.x = x;
+                key.y = y;
+                key.fsid = featureSets[i].first;
+                key.fsVersion = featureSets[i].second;
+
+                FeatureTileData data;
+                code = this->get(data, key);
+                if (code == TE_Done) {
+                    code = generateTile(data, store, key);
+                    TE_CHECKRETURN_CODE(code);
+                    code = this->put(key, data);
+                    // failing to persist the tile does not fail the query
+                    if (code == TE_IO)
+                        code = TE_Ok;
+                }
+                TE_CHECKRETURN_CODE(code);
+
+                FeatureCursorPtr tile(nullptr, nullptr);
+                code = FeatureTile_decode(tile, data);
+                TE_CHECKRETURN_CODE(code);
+                code = retval->add(std::move(tile));
+                TE_CHECKRETURN_CODE(code);
+            }
+        }
+    }
+
+    value = FeatureCursorPtr(retval.release(), Memory_deleter_const<FeatureCursor2, MultiplexingFeatureCursor>);
+    return code;
+}
+
+TAKErr FeatureTileCache::getPath(String &value, const FeatureTileKey &key) const NOTHROWS
+{
+    const char sep = Platform_pathSep();
+    StringBuilder strm;
+    strm << directory << sep << key.fsid << sep << key.level << sep << key.x << sep << key.y << ".tile";
+    value = strm.c_str();
+    return TE_Ok;
+}
+
+void FeatureTileCache::putImpl(const FeatureTileKey &key, const FeatureTileData &data) NOTHROWS
+{
+    auto entry = index.find(key);
+    if (entry != index.end()) {
+        memory -= entry->second->second->size();
+        entries.erase(entry->second);
+        index.erase(entry);
+    }
+    entries.push_front(std::make_pair(key, data));
+    index[key] = entries.begin();
+    memory += data->size();
+
+    // evict least recently used tiles; the most recent is always retained
+    while (memory > maxMemory && entries.size() > 1u) {
+        const auto &lru = entries.back();
+        memory -= lru.second->size();
+        index.erase(lru.first);
+        entries.pop_back();
+    }
+}
+
+bool FeatureTileCache::KeyComp::operator()(const FeatureTileKey &a, const FeatureTileKey &b) const NOTHROWS
+{
+    if (a.fsid != b.fsid)
+        return a.fsid < b.fsid;
+    if (a.level != b.level)
+        return a.level < b.level;
+    if (a.x != b.x)
+        return a.x < b.x;
+    if (a.y != b.y)
+        return a.y < b.y;
+    return a.fsVersion < b.fsVersion;
+}
+
+namespace
+{
+    TAKErr generateTile(FeatureTileData &value, FeatureDataStore2 &store, const FeatureTileKey &key) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        Envelope2 bounds;
+        code = FeatureTile_getBounds(&bounds, key.level, key.x, key.y);
+        TE_CHECKRETURN_CODE(code);
+
+        FeatureDataStore2::FeatureQueryParameters params;
+        params.featureSetIds->add(key.fsid);
+        params.visibleOnly = true;
+
+        atakmap::feature::LineString mbb(atakmap::feature::Geometry::_2D);
+        mbb.addPoint(bounds.minX, bounds.maxY);
+        mbb.addPoint(bounds.maxX, bounds.maxY);
+        mbb.addPoint(bounds.maxX, bounds.minY);
+        mbb.addPoint(bounds.minX, bounds.minY);
+        mbb.addPoint(bounds.minX, bounds.maxY);
+        params.spatialFilter = GeometryPtr_const(new atakmap::feature::Polygon(mbb), Memory_deleter_const<atakmap::feature::Geometry>);
+
+        // consistent with a view of the tile at its native resolution
+        params.maxResolution = OSMUtils::mapnikTileResolution(key.level);
+        params.minResolution = params.maxResolution * 0.5;
+
+        FeatureDataStore2::FeatureQueryParameters::SpatialOp simplify;
+        simplify.type = FeatureDataStore2::FeatureQueryParameters::SpatialOp::Simplify;
+        simplify.args.simplify.distance = (bounds.maxX - bounds.minX) / 256.0 * 2.0;
+        params.ops->add(simplify);
+
+        params.ignoredFields = FeatureDataStore2::FeatureQueryParameters::AttributesField;
+
+        FeatureCursorPtr result(nullptr, nullptr);
+        code = store.queryFeatures(result, params);
+        TE_CHECKRETURN_CODE(code);
+
+        DynamicOutput sink;
+        code = sink.open(64u * 1024u);
+        TE_CHECKRETURN_CODE(code);
+        code = FeatureTile_encode(sink, key, FEATURE_TILE_EXTENT, *result);
+        TE_CHECKRETURN_CODE(code);
+
+        const uint8_t *buf;
+        std::size_t len;
+        code = sink.get(&buf, &len);
+        TE_CHECKRETURN_CODE(code);
+        TE_BEGIN_TRAP() {
+            value = std::make_shared<const std::vector<uint8_t>>(buf, buf + len);
+        } TE_END_TRAP(code);
+        return code;
+    }
+
+    TAKErr readFile(FeatureTileData &value, const char *path) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        int64_t len;
+        code = IO_length(&len, path);
+        TE_CHECKRETURN_CODE(code);
+        if (len <= 0)
+            return TE_IO;
+
+        std::unique_ptr<DataInput2, void(*)(const DataInput2 *)> input(nullptr, nullptr);
+        code = IO_openFile(input, path);
+        TE_CHECKRETURN_CODE(code);
+
+        std::shared_ptr<std::vector<uint8_t>> data;
+        TE_BEGIN_TRAP() {
+            data = std::make_shared<std::vector<uint8_t>>(static_cast<std::size_t>(len));
+        } TE_END_TRAP(code);
+        TE_CHECKRETURN_CODE(code);
+
+        std::size_t off = 0u;
+        while (off < data->size()) {
+            std::size_t numRead;
+            code = input->read(&data->at(off), &numRead, data->size() - off);
+            TE_CHECKBREAK_CODE(code);
+            if (!numRead) {
+                code = TE_EOF;
+                break;
+            }
+            off += numRead;
+        }
+        input->close();
+        TE_CHECKRETURN_CODE(code);
+
+        value = data;
+        return code;
+    }
+
+    TAKErr writeFile(const char *path, const FeatureTileData &data) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        String parent;
+        code = IO_getParentFile(parent, path);
+        TE_CHECKRETURN_CODE(code);
+        code = IO_mkdirs(parent);
+        TE_CHECKRETURN_CODE(code);
+
+        StringBuilder partialPath;
+        partialPath << path << ".partial";
+
+        FileOutput2 output;
+        code = output.open(partialPath.c_str());
+        TE_CHECKRETURN_CODE(code);
+        if (!data->empty())
+            code = output.write(&data->at(0), data->size());
+        output.close();
+        if (code != TE_Ok) {
+            IO_delete(partialPath.c_str());
+            return TE_IO;
+        }
+
+        // readers of the previous content are unaffected by the replace
+        if (std::rename(partialPath.c_str(), path) != 0) {
+            IO_delete(path);
+            if (std::rename(partialPath.c_str(), path) != 0) {
+                IO_delete(partialPath.c_str());
+                return TE_IO;
+            }
+        }
+        return code;
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef TAK_ENGINE_FEATURE_FEATURETILECACHE_H_INCLUDED
+#define TAK_ENGINE_FEATURE_FEATURETILECACHE_H_INCLUDED
+
+#include <list>
+#include <map>
+
+#include "feature/Envelope2.h"
+#include "feature/FeatureDataStore2.h"
+#include "feature/FeatureTile.h"
+#include "port/Platform.h"
+#include "port/String.h"
+#include "thread/Mutex.h"
+#include "util/Error.h"
+#include "util/NonCopyable.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Feature {
+            /**
+             * Cache of encoded feature tiles (see `FeatureTile_encode`).
+             * Tiles are held in memory, least recently used tiles being
+             * evicted once the memory limit is exceeded, and optionally
+             * persisted to a directory so that they survive restarts.
+             *
+             * <P>Tiles are keyed on the feature set version; a tile for a
+             * stale version is never returned. Changes to the visibility
+             * of individual features do not change the feature set
+             * version, so the cache should be cleared when the store
+             * reports that its content has changed.
+             *
+             * <P>A persistent cache directory must be dedicated to a single
+             * data store whose feature set IDs and versions are stable
+             * across restarts.
+             *
+             * <P>This class is thread-safe.
+             */
+            class ENGINE_API FeatureTileCache : TAK::Engine::Util::NonCopyable
+            {
+            public :
+                /**
+                 * @param maxMemory The maximum number of bytes of encoded
+                 *                  tiles held in memory
+                 * @param directory If non-`nullptr`, the directory that tiles
+                 *                  are persisted to
+                 */
+                FeatureTileCache(const std::size_t maxMemory, const char *directory = nullptr) NOTHROWS;
+                ~FeatureTileCache() NOTHROWS;
+            public :
+                /**
+                 * Returns the cached tile for the specified key.
+                 *
+                 * @return  TE_Ok if the tile was cached, TE_Done otherwise
+                 */
+                Util::TAKErr get(FeatureTileData &value, const FeatureTileKey &key) NOTHROWS;
+                Util::TAKErr put(const FeatureTileKey &key, const FeatureTileData &data) NOTHROWS;
+                /** Evicts all tiles, both from memory and the directory. */
+                Util::TAKErr clear() NOTHROWS;
+                /**
+                 * Queries the visible features of `store` that intersect
+                 * `region` via the tiles at `level`, generating and caching
+                 * any tiles that are missing. Features are returned once per
+                 * tile that they intersect. The features are simplified and
+                 * filtered for the resolution of the tile level.
+                 *
+                 * <P>Only the latitudes representable by OSM tiles (about
+                 * +/-85 degrees) are covered.
+                 *
+                 * @return  TE_Ok on success; TE_Unsupported if the region
+                 *          spans an excessive number of tiles at `level`;
+                 *          various codes on failure
+                 */
+                Util::TAKErr query(FeatureCursorPtr &value, FeatureDataStore2 &store, const Envelope2 &region, const int level) NOTHROWS;
+            private :
+                Util::TAKErr getPath(Port::String &value, const FeatureTileKey &key) const NOTHROWS;
+                void putImpl(const FeatureTileKey &key, const FeatureTileData &data) NOTHROWS;
+            private :
+                struct KeyComp
+                {
+                    bool operator()(const FeatureTileKey &a, const FeatureTileKey &b) const NOTHROWS;
+                };
+                typedef std::list<std::pair<FeatureTileKey, FeatureTileData>> EntryList;
+
+                Thread::Mutex mutex;
+                std::size_t maxMemory;
+                std::size_t memory;
+                Port::String directory;
+                EntryList entries;
+                std::map<FeatureTileKey, EntryList::iterator, KeyComp> index;
+            };
+        }
+    }
+}
+
+#endif
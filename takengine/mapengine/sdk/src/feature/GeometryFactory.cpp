@@ -1,6 +1,7 @@
 #include "feature/GeometryFactory.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 
 #include "feature/LegacyAdapters.h"
@@ -22,6 +23,19 @@ using namespace TAK::Engine::Util;
 
 namespace
 {
+    /** reads an unaligned value encoded with the specified endian */
+    template<class T>
+    void readValue(T *value, const uint8_t *src, const TAKEndian endian) NOTHROWS
+    {
+        if (endian != TE_PlatformEndian) {
+            uint8_t *dst = reinterpret_cast<uint8_t *>(value);
+            for (std::size_t i = 0u; i < sizeof(T); i++)
+                dst[i] = src[sizeof(T) - 1u - i];
+        } else {
+            memcpy(value, src, sizeof(T));
+        }
+    }
+
     TAKErr parseSpatiaLiteGeometry(Geometry2Ptr &value,
                                    DataInput2 &strm,
                                    const size_t dimension,
@@ -546,6 +560,128 @@ TAKErr TAK::Engine::Feature::GeometryFactory_fromSpatiaLiteBlob(Geometry2Ptr &va
     return GeometryFactory_fromSpatiaLiteBlob(value, srid, strm);
 }
 
+TAKErr TAK::Engine::Feature::GeometryFactory_getLineStringView(LineStringView &value, std::size_t *len, const uint8_t *data, const std::size_t dataLen, const int type, const TAKEndian endian) NOTHROWS
+{
+    if (!len || (dataLen && !data))
+        return TE_InvalidArg;
+    if (type < 0)
+        return TE_InvalidArg;
+    const int hi = (type / 1000) % 1000;
+    if (hi > 3)
+        return TE_InvalidArg;
+
+    LineStringView view;
+    view.hasZ = (hi == 1 || hi == 3);
+    view.ordinates = 2u + (view.hasZ ? 1u : 0u) + (hi > 1 ? 1u : 0u);
+    view.compressed = ((type / 1000000) == 1);
+    view.endian = endian;
+
+    int32_t count;
+    if (dataLen < sizeof(count))
+        return TE_EOF;
+    readValue(&count, data, endian);
+    if (count < 0)
+        return TE_InvalidArg;
+    view.numPoints = static_cast<std::size_t>(count);
+    view.data = data + sizeof(count);
+
+    std::size_t pointsLen;
+    if (!view.numPoints)
+        pointsLen = 0u;
+    else if (!view.compressed)
+        pointsLen = view.numPoints * view.ordinates * sizeof(double);
+    else
+        pointsLen = view.ordinates * sizeof(double) + (view.numPoints - 1u) * view.ordinates * sizeof(float);
+    // guard against a bad count overflowing
+    if (view.numPoints > dataLen || pointsLen > (dataLen - sizeof(count)))
+        return TE_EOF;
+
+    value = view;
+    *len = sizeof(count) + pointsLen;
+    return TE_Ok;
+}
+
+TAKErr TAK::Engine::Feature::GeometryFactory_getPolygonView(LineStringView *rings, std::size_t *numRings, const std::size_t capacity, std::size_t *len, const uint8_t *data, const std::size_t dataLen, const int type, const TAKEndian endian) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!numRings || !len || (capacity && !rings) || (dataLen && !data))
+        return TE_InvalidArg;
+
+    int32_t count;
+    if (dataLen < sizeof(count))
+        return TE_EOF;
+    readValue(&count, data, endian);
+    if (count < 0)
+        return TE_InvalidArg;
+
+    std::size_t off = sizeof(count);
+    for (int32_t i = 0; i < count; i++) {
+        LineStringView ring;
+        std::size_t ringLen;
+        code = GeometryFactory_getLineStringView(ring, &ringLen, data + off, dataLen - off, type, endian);
+        TE_CHECKRETURN_CODE(code);
+        if (static_cast<std::size_t>(i) < capacity)
+            rings[i] = ring;
+        off += ringLen;
+    }
+
+    *numRings = static_cast<std::size_t>(count);
+    *len = off;
+    return code;
+}
+
+void TAK::Engine::Feature::LineStringView_getPoints(double *xyz, const LineStringView &view) NOTHROWS
+{
+    if (!view.numPoints)
+        return;
+
+    const uint8_t *src = view.data;
+    double x, y, z = 0.0;
+    readValue(&x, src, view.endian);
+    readValue(&y, src + sizeof(double), view.endian);
+    if (view.hasZ)
+        readValue(&z, src + 2u*sizeof(double), view.endian);
+    xyz[0] = x;
+    xyz[1] = y;
+    xyz[2] = z;
+    src += view.ordinates * sizeof(double);
+
+    if (!view.compressed) {
+        const std::size_t pointLen = view.ordinates * sizeof(double);
+        if (view.endian == TE_PlatformEndian && view.ordinates == 3u && view.hasZ) {
+            // layout matches the output
+            memcpy(xyz + 3u, src, (view.numPoints - 1u) * pointLen);
+            return;
+        }
+        for (std::size_t i = 1u; i < view.numPoints; i++) {
+            readValue(xyz + i*3u, src, view.endian);
+            readValue(xyz + i*3u + 1u, src + sizeof(double), view.endian);
+            if (view.hasZ)
+                readValue(xyz + i*3u + 2u, src + 2u*sizeof(double), view.endian);
+            else
+                xyz[i*3u + 2u] = 0.0;
+            src += pointLen;
+        }
+    } else {
+        // points following the first are offsets from the previous point
+        const std::size_t pointLen = view.ordinates * sizeof(float);
+        for (std::size_t i = 1u; i < view.numPoints; i++) {
+            float dx, dy, dz = 0.0f;
+            readValue(&dx, src, view.endian);
+            readValue(&dy, src + sizeof(float), view.endian);
+            if (view.hasZ)
+                readValue(&dz, src + 2u*sizeof(float), view.endian);
+            x += dx;
+            y += dy;
+            z += dz;
+            xyz[i*3u] = x;
+            xyz[i*3u + 1u] = y;
+            xyz[i*3u + 2u] = z;
+            src += pointLen;
+        }
+    }
+}
+
 TAKErr TAK::Engine::Feature::GeometryFactory_toWkb(DataOutput2 &sink, const Geometry2 &geometry) NOTHROWS
 {
     return GeometryFactory_toWkb(sink, geometry, TE_PlatformEndian);
@@ -587,10 +723,7 @@ TAKErr TAK::Engine::Feature::GeometryFactory_toSpatiaLiteBlob(DataOutput2 &sink,
             std::ostringstream strstream;
             legacy->toBlob(strstream);
             std::string s = strstream.str();
-            for (std::size_t i = 0u; i < s.length(); ++i) {
-                code = sink.writeByte(s[i]);
-                TE_CHECKBREAK_CODE(code);
-            }
+            code = sink.write(reinterpret_cast<const uint8_t *>(s.data()), s.length());
             TE_CHECKRETURN_CODE(code);
         } catch (...) {
             return TE_Err;
@@ -1538,7 +1671,30 @@ namespace
 		const std::size_t dimension = linestring.getDimension();
 		code = strm.writeInt(static_cast<int32_t>(numPoints));
 		TE_CHECKRETURN_CODE(code);
-		if (dimension == 3u) {
+		if ((dimension == 2u || dimension == 3u) && strm.getSourceEndian() == TE_PlatformEndian) {
+			// no byte swapping required; stage coordinates and emit in bulk
+			double staged[96u];
+			const std::size_t pointsPerBatch = (sizeof(staged) / sizeof(double)) / dimension;
+			for (std::size_t i = 0; i < numPoints; i += pointsPerBatch) {
+				const std::size_t batch = std::min(pointsPerBatch, numPoints - i);
+				double *v = staged;
+				for (std::size_t j = 0; j < batch; j++) {
+					code = linestring.getX(v++, i + j);
+					TE_CHECKBREAK_CODE(code);
+					code = linestring.getY(v++, i + j);
+					TE_CHECKBREAK_CODE(code);
+					if (dimension == 3u) {
+						code = linestring.getZ(v++, i + j);
+						TE_CHECKBREAK_CODE(code);
+					}
+				}
+				TE_CHECKBREAK_CODE(code);
+				code = strm.write(reinterpret_cast<const uint8_t *>(staged), (v - staged) * sizeof(double));
+				TE_CHECKBREAK_CODE(code);
+			}
+			TE_CHECKRETURN_CODE(code);
+		}
+		else if (dimension == 3u) {
 			for (std::size_t i = 0; i < numPoints; i++) {
 				double v;
 
@@ -92,6 +92,65 @@ namespace TAK {
              */
             ENGINE_API Util::TAKErr GeometryFactory_fromSpatiaLiteBlob(Geometry2Ptr &value, int *srid, const uint8_t *wkb, const std::size_t wkbLen) NOTHROWS;
 
+            /**
+             * Read-only view of the points of a linestring, or polygon ring,
+             * encoded as SpatiaLite blob or WKB. The view references the
+             * encoded data in place and is only valid for the lifetime of
+             * that data.
+             */
+            struct ENGINE_API LineStringView
+            {
+                /** the first point */
+                const uint8_t *data {nullptr};
+                std::size_t numPoints {0u};
+                /** number of ordinates per point, including any measure */
+                std::size_t ordinates {2u};
+                bool hasZ {false};
+                /** SpatiaLite compressed; points following the first are `float` offsets */
+                bool compressed {false};
+                Util::TAKEndian endian {Util::TE_PlatformEndian};
+            };
+
+            /**
+             * Obtains a view of the linestring encoded at `data`, starting
+             * with the point count.
+             *
+             * @param value     Returns the view
+             * @param len       Returns the number of bytes spanned by the
+             *                  linestring
+             * @param data      The encoded linestring
+             * @param dataLen   The number of bytes available
+             * @param type      The SpatiaLite or WKB geometry class type
+             * @param endian    The endian of the encoded data
+             *
+             * @return  TE_Ok on success, TE_EOF if the data is truncated,
+             *          TE_InvalidArg if `type` is not supported
+             */
+            ENGINE_API Util::TAKErr GeometryFactory_getLineStringView(LineStringView &value, std::size_t *len, const uint8_t *data, const std::size_t dataLen, const int type, const Util::TAKEndian endian) NOTHROWS;
+            /**
+             * Obtains views of the rings of the polygon encoded at `data`,
+             * starting with the ring count.
+             *
+             * @param rings     Returns the views of the rings; the exterior
+             *                  ring is first
+             * @param numRings  Returns the number of rings in the polygon.
+             *                  If greater than `capacity`, only the first
+             *                  `capacity` rings are returned.
+             * @param capacity  The capacity of `rings`
+             * @param len       Returns the number of bytes spanned by the
+             *                  polygon
+             *
+             * @return  TE_Ok on success, TE_EOF if the data is truncated,
+             *          TE_InvalidArg if `type` is not supported
+             */
+            ENGINE_API Util::TAKErr GeometryFactory_getPolygonView(LineStringView *rings, std::size_t *numRings, const std::size_t capacity, std::size_t *len, const uint8_t *data, const std::size_t dataLen, const int type, const Util::TAKEndian endian) NOTHROWS;
+            /**
+             * Decodes the points of the view as `x,y,z` triplets into `xyz`,
+             * which must have capacity for `3*view.numPoints` values. `z`
+             * is `0` if the view has no `z` ordinate.
+             */
+            ENGINE_API void LineStringView_getPoints(double *xyz, const LineStringView &view) NOTHROWS;
+
             /**
              * Serializes the specified geometry as OGC WKB (Well Known Binary)
              * format. The host platform endian is used.
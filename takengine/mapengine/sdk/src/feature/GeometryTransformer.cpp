@@ -1,5 +1,9 @@
 #include "feature/GeometryTransformer.h"
 
+#include <map>
+#include <utility>
+#include <vector>
+
 #include "core/ProjectionFactory3.h"
 #include "feature/GeometryCollection2.h"
 #include "feature/LineString2.h"
@@ -13,6 +17,20 @@ using namespace TAK::Engine::Util;
 
 namespace
 {
+    // bounds the number of cached transformers per thread
+    const std::size_t MAX_CACHED_TRANSFORMERS = 16u;
+
+    struct Transformer
+    {
+        Transformer() NOTHROWS;
+
+        Projection2Ptr src;
+        Projection2Ptr dst;
+    };
+
+    TAKErr getTransformer(const Transformer **value, const int srcSrid, const int dstSrid) NOTHROWS;
+    TAKErr transformPoints(double *coords, const std::size_t count, const std::size_t dimension, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS;
+
     TAKErr Geometry_transform_2D(Geometry2Ptr &value, const Geometry2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS;
     TAKErr Geometry_transform_3D(Geometry2Ptr &value, const Geometry2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS;
     TAKErr Point_transform_2D(Point2 *value, const Point2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS;
@@ -31,18 +49,14 @@ TAKErr TAK::Engine::Feature::GeometryTransformer_transform(Geometry2Ptr &value,
     if (srcSrid == dstSrid)
         return Geometry_clone(value, src);
 
-    Projection2Ptr srcProj(nullptr, nullptr);
-    code = ProjectionFactory3_create(srcProj, srcSrid);
-    TE_CHECKRETURN_CODE(code);
-
-    Projection2Ptr dstProj(nullptr, nullptr);
-    code = ProjectionFactory3_create(dstProj, dstSrid);
+    const Transformer *xform;
+    code = getTransformer(&xform, srcSrid, dstSrid);
     TE_CHECKRETURN_CODE(code);
 
     if (src.getDimension() == 2u)
-        return Geometry_transform_2D(value, src, *srcProj, *dstProj);
+        return Geometry_transform_2D(value, src, *xform->src, *xform->dst);
     else if (src.getDimension() == 3u)
-        return Geometry_transform_3D(value, src, *srcProj, *dstProj);
+        return Geometry_transform_3D(value, src, *xform->src, *xform->dst);
     else
         return TE_IllegalState;
 
@@ -69,55 +83,129 @@ TAKErr TAK::Engine::Feature::GeometryTransformer_transform(Envelope2 *value, con
         return TE_Ok;
     }
 
-    Projection2Ptr srcProj(nullptr, nullptr);
-    code = ProjectionFactory3_create(srcProj, srcSrid);
+    const Transformer *xform;
+    code = getTransformer(&xform, srcSrid, dstSrid);
     TE_CHECKRETURN_CODE(code);
 
-    Projection2Ptr dstProj(nullptr, nullptr);
-    code = ProjectionFactory3_create(dstProj, dstSrid);
-    TE_CHECKRETURN_CODE(code);
-
-    TAK::Engine::Feature::Point2 pts[8u] =
+    double pts[24u] =
     {
-        TAK::Engine::Feature::Point2(src.minX, src.minY, src.minZ),
-        TAK::Engine::Feature::Point2(src.maxX, src.minY, src.minZ),
-        TAK::Engine::Feature::Point2(src.minX, src.maxY, src.minZ),
-        TAK::Engine::Feature::Point2(src.maxX, src.maxY, src.minZ),
-        TAK::Engine::Feature::Point2(src.minX, src.minY, src.maxZ),
-        TAK::Engine::Feature::Point2(src.maxX, src.minY, src.maxZ),
-        TAK::Engine::Feature::Point2(src.minX, src.maxY, src.maxZ),
-        TAK::Engine::Feature::Point2(src.maxX, src.maxY, src.maxZ)
+        src.minX, src.minY, src.minZ,
+        src.maxX, src.minY, src.minZ,
+        src.minX, src.maxY, src.minZ,
+        src.maxX, src.maxY, src.minZ,
+        src.minX, src.minY, src.maxZ,
+        src.maxX, src.minY, src.maxZ,
+        src.minX, src.maxY, src.maxZ,
+        src.maxX, src.maxY, src.maxZ,
     };
 
-    Point_transform_3D(&pts[0u], pts[0u], *srcProj, *dstProj);
-    value->minX = pts[0].x;
-    value->minY = pts[0].y;
-    value->minZ = pts[0].z;
-    value->maxX = pts[0].x;
-    value->maxY = pts[0].y;
-    value->maxZ = pts[0].z;
+    // per-corner failures are ignored, consistent with the prior behavior;
+    // failed corners retain their source coordinates
+    for (std::size_t i = 0u; i < 8u; i++)
+        transformPoints(pts + (i * 3u), 1u, 3u, *xform->src, *xform->dst);
+
+    value->minX = pts[0];
+    value->minY = pts[1];
+    value->minZ = pts[2];
+    value->maxX = pts[0];
+    value->maxY = pts[1];
+    value->maxZ = pts[2];
 
     for (std::size_t i = 1u; i < 8u; i++) {
-        Point_transform_3D(&pts[i], pts[i], *srcProj, *dstProj);
-        if(pts[i].x < value->minX)
-            value->minX = pts[i].x;
-        if(pts[i].y < value->minY)
-            value->minY = pts[i].y;
-        if(pts[i].z < value->minZ)
-            value->minZ = pts[i].z;
-        if(pts[i].x > value->maxX)
-            value->maxX = pts[i].x;
-        if(pts[i].y > value->maxY)
-            value->maxY = pts[i].y;
-        if(pts[i].z > value->maxZ)
-            value->maxZ = pts[i].z;
+        const double *pt = pts + (i * 3u);
+        if(pt[0] < value->minX)
+            value->minX = pt[0];
+        if(pt[1] < value->minY)
+            value->minY = pt[1];
+        if(pt[2] < value->minZ)
+            value->minZ = pt[2];
+        if(pt[0] > value->maxX)
+            value->maxX = pt[0];
+        if(pt[1] > value->maxY)
+            value->maxY = pt[1];
+        if(pt[2] > value->maxZ)
+            value->maxZ = pt[2];
     }
 
     return code;
 }
+TAKErr TAK::Engine::Feature::GeometryTransformer_transform(double *coords, const std::size_t count, const std::size_t dimension, const int srcSrid, const int dstSrid) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!coords && count)
+        return TE_InvalidArg;
+    if (dimension != 2u && dimension != 3u)
+        return TE_InvalidArg;
+    if (srcSrid == dstSrid || !count)
+        return TE_Ok;
+
+    const Transformer *xform;
+    code = getTransformer(&xform, srcSrid, dstSrid);
+    TE_CHECKRETURN_CODE(code);
+
+    return transformPoints(coords, count, dimension, *xform->src, *xform->dst);
+}
 
 namespace
 {
+    Transformer::Transformer() NOTHROWS :
+        src(nullptr, nullptr),
+        dst(nullptr, nullptr)
+    {}
+
+    TAKErr getTransformer(const Transformer **value, const int srcSrid, const int dstSrid) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        // projections are not guaranteed to be safe for concurrent use, so
+        // the cache is per thread
+        thread_local static std::map<std::pair<int, int>, Transformer> cache;
+
+        const std::pair<int, int> key(srcSrid, dstSrid);
+        auto entry = cache.find(key);
+        if (entry != cache.end()) {
+            *value = &entry->second;
+            return code;
+        }
+
+        Transformer xform;
+        code = ProjectionFactory3_create(xform.src, srcSrid);
+        TE_CHECKRETURN_CODE(code);
+        code = ProjectionFactory3_create(xform.dst, dstSrid);
+        TE_CHECKRETURN_CODE(code);
+
+        if (cache.size() >= MAX_CACHED_TRANSFORMERS)
+            cache.clear();
+        *value = &(cache[key] = std::move(xform));
+        return code;
+    }
+    TAKErr transformPoints(double *coords, const std::size_t count, const std::size_t dimension, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        GeoPoint2 g;
+        TAK::Engine::Math::Point2<double> p;
+
+        double *pt = coords;
+        for (std::size_t i = 0u; i < count; i++) {
+            p.x = pt[0];
+            p.y = pt[1];
+            p.z = (dimension == 3u) ? pt[2] : 0.0;
+
+            code = srcProj.inverse(&g, p);
+            TE_CHECKBREAK_CODE(code);
+            code = dstProj.forward(&p, g);
+            TE_CHECKBREAK_CODE(code);
+
+            pt[0] = p.x;
+            pt[1] = p.y;
+            if (dimension == 3u)
+                pt[2] = p.z;
+            pt += dimension;
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        return code;
+    }
+
     TAKErr Geometry_transform_2D(Geometry2Ptr &value, const Geometry2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS
     {
         TAKErr code(TE_Ok);
@@ -208,52 +296,48 @@ namespace
     TAKErr LineString_transform_2D(LineString2 *value, const LineString2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS
     {
         TAKErr code(TE_Ok);
-        GeoPoint2 g;
-        TAK::Engine::Math::Point2<double> p;
-
-        for (std::size_t i = 0; i < src.getNumPoints(); i++) {
-            code = src.getX(&p.x, i);
+        const std::size_t numPoints = src.getNumPoints();
+        if (!numPoints)
+            return code;
+
+        std::vector<double> coords(numPoints * 2u);
+        double *pt = &coords[0];
+        for (std::size_t i = 0; i < numPoints; i++) {
+            code = src.getX(pt++, i);
             TE_CHECKBREAK_CODE(code);
-            code = src.getY(&p.y, i);
-            TE_CHECKBREAK_CODE(code);
-
-            code = srcProj.inverse(&g, p);
-            TE_CHECKRETURN_CODE(code);
-            code = dstProj.forward(&p, g);
-            TE_CHECKRETURN_CODE(code);
-
-            code = value->addPoint(p.x, p.y);
+            code = src.getY(pt++, i);
             TE_CHECKBREAK_CODE(code);
         }
         TE_CHECKRETURN_CODE(code);
 
-        return code;
+        code = transformPoints(&coords[0], numPoints, 2u, srcProj, dstProj);
+        TE_CHECKRETURN_CODE(code);
+
+        return value->addPoints(&coords[0], numPoints, 2u);
     }
     TAKErr LineString_transform_3D(LineString2 *value, const LineString2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS
     {
         TAKErr code(TE_Ok);
-        GeoPoint2 g;
-        TAK::Engine::Math::Point2<double> p;
-
-        for (std::size_t i = 0; i < src.getNumPoints(); i++) {
-            code = src.getX(&p.x, i);
+        const std::size_t numPoints = src.getNumPoints();
+        if (!numPoints)
+            return code;
+
+        std::vector<double> coords(numPoints * 3u);
+        double *pt = &coords[0];
+        for (std::size_t i = 0; i < numPoints; i++) {
+            code = src.getX(pt++, i);
             TE_CHECKBREAK_CODE(code);
-            code = src.getY(&p.y, i);
+            code = src.getY(pt++, i);
             TE_CHECKBREAK_CODE(code);
-            code = src.getZ(&p.z, i);
-            TE_CHECKBREAK_CODE(code);
-
-            code = srcProj.inverse(&g, p);
-            TE_CHECKRETURN_CODE(code);
-            code = dstProj.forward(&p, g);
-            TE_CHECKRETURN_CODE(code);
-
-            code = value->addPoint(p.x, p.y, p.z);
+            code = src.getZ(pt++, i);
             TE_CHECKBREAK_CODE(code);
         }
         TE_CHECKRETURN_CODE(code);
 
-        return code;
+        code = transformPoints(&coords[0], numPoints, 3u, srcProj, dstProj);
+        TE_CHECKRETURN_CODE(code);
+
+        return value->addPoints(&coords[0], numPoints, 3u);
     }
 
     TAKErr Polygon_transform_2D(Polygon2 *value, const Polygon2 &src, const Projection2 &srcProj, const Projection2 &dstProj) NOTHROWS
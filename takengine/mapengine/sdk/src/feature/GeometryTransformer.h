@@ -1,6 +1,8 @@
 #ifndef TAK_ENGINE_FEATURE_GEOMETRYTRANSFORMER_H_INCLUDED
 #define TAK_ENGINE_FEATURE_GEOMETRYTRANSFORMER_H_INCLUDED
 
+#include <cstddef>
+
 #include "feature/Geometry2.h"
 #include "port/Platform.h"
 #include "util/Error.h"
@@ -11,6 +13,24 @@ namespace TAK {
             ENGINE_API Util::TAKErr GeometryTransformer_transform(Geometry2Ptr &value, const Geometry2 &src, const int srcSrid, const int dstSrid) NOTHROWS;
             ENGINE_API Util::TAKErr GeometryTransformer_transform(Geometry2Ptr_const &value, const Geometry2 &src, const int srcSrid, const int dstSrid) NOTHROWS;
             ENGINE_API Util::TAKErr GeometryTransformer_transform(Envelope2 *value, const Envelope2 &src, const int srcSrid, const int dstSrid) NOTHROWS;
+            /**
+             * Transforms an array of interleaved coordinates in place.
+             *
+             * <P>The projections for a given source and destination SRID
+             * pair are created on first use and cached per thread, for all
+             * of the `GeometryTransformer_transform` functions.
+             *
+             * @param coords    The coordinates, `count * dimension` values
+             * @param count     The number of points
+             * @param dimension The point dimension, 2 or 3. For 2D points,
+             *                  any altitude produced by the destination
+             *                  projection is discarded.
+             *
+             * @return  TE_Ok on success; TE_InvalidArg if `dimension` is
+             *          not supported; various codes on failure, in which
+             *          case the content of `coords` is undefined
+             */
+            ENGINE_API Util::TAKErr GeometryTransformer_transform(double *coords, const std::size_t count, const std::size_t dimension, const int srcSrid, const int dstSrid) NOTHROWS;
         }
     }
 }
@@ -1,6 +1,8 @@
 
 #include "feature/KMLFeatureDataSource2.h"
+#include <algorithm>
 #include <deque>
+#include <memory>
 #include <regex>
 #include "feature/Geometry.h"
 #include "feature/GeometryCollection.h"
@@ -11,8 +13,11 @@
 #include "feature/Style.h"
 #include "port/STLVectorAdapter.h"
 #include "port/String.h"
+#include "thread/Monitor.h"
 #include "util/IO2.h"
 #include "util/Memory.h"
+#include "util/Tasking.h"
+#include "util/Work.h"
 
 #include "ogr_core.h"
 
@@ -33,12 +38,38 @@ const double MAX_RESOLUTION = 0.0;
 using namespace TAK::Engine::Feature;
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
 
 #define KML_FULL_3D 1
 
 namespace {
 
+/** maximum number of Placemarks parsed ahead of the consumer for concurrent conversion */
+const std::size_t PREFETCH_PLACEMARKS = 256u;
+
 struct Container;
+class KMLPlacemarkFeatureDef;
+
+enum ConversionState {
+    Conversion_Queued,
+    Conversion_Running,
+    Conversion_Done,
+};
+
+/**
+ * Placemarks cut out of the document by the parser, awaiting conversion
+ * of geometry, style and attributes. Conversion is claimed by either a
+ * CPU worker or the consumer, whichever gets there first, so ingest
+ * completes even if no worker is available.
+ */
+struct ConversionQueue {
+    Monitor monitor;
+    std::deque<KMLPlacemarkFeatureDef *> pending;
+    std::size_t workers {0u};
+    std::size_t maxWorkers {0u};
+};
+
+TAKErr ConversionQueue_task(bool &, const std::shared_ptr<ConversionQueue> &queue) NOTHROWS;
 
 atakmap::feature::Style *convertStyleSelector(
     const KMLStyleSelector &styleSelector, const std::string &file,
@@ -93,6 +124,8 @@ class KMLPlacemarkFeatureDef : public FeatureDefinition2 {
     TAKErr applyStyle() NOTHROWS;
     TAKErr createAttrs() NOTHROWS;
     TAKErr applyGeom() NOTHROWS;
+    /** converts the geometry, style and attributes of the Placemark */
+    void convert() NOTHROWS;
 
     std::string file;
     Container *container;
@@ -103,6 +136,8 @@ class KMLPlacemarkFeatureDef : public FeatureDefinition2 {
     AltitudeMode altitudeMode;
     double extrude;
     std::unique_ptr<atakmap::util::AttributeSet> attrs;
+    /** guarded by the monitor of the owning ConversionQueue */
+    ConversionState conversion;
 };
 
 struct Container {
@@ -187,8 +222,7 @@ class KMLContent2 : public FeatureDataSource2::Content {
         if (!hasFeature()) return false;
         
         auto featureDef = containerQueue.front()->featureDefs.front().get();
-
-        if (!featureDef->geometry) featureDef->applyGeom();
+        awaitConversion(*featureDef);
 
         return featureDef->geometry.get() != nullptr;
     }
@@ -206,6 +240,16 @@ class KMLContent2 : public FeatureDataSource2::Content {
 
    private:
     TAK::Engine::Util::TAKErr moveToNextFeatureInner() NOTHROWS;
+    void enqueueConversion(KMLPlacemarkFeatureDef &featureDef) NOTHROWS;
+    void awaitConversion(KMLPlacemarkFeatureDef &featureDef) const NOTHROWS;
+    /**
+     * Withdraws the Placemark from the conversion queue, waiting for a
+     * conversion already running on a worker. Must be invoked before the
+     * Placemark is destroyed.
+     */
+    void cancelConversion(KMLPlacemarkFeatureDef &featureDef) const NOTHROWS;
+    /** returns the number of Placemarks parsed but not yet consumed */
+    std::size_t getReadAhead() const NOTHROWS;
 
     DataInput2Ptr inputPtr;
     std::string file;
@@ -224,6 +268,8 @@ class KMLContent2 : public FeatureDataSource2::Content {
 
     bool atFrontContainer;
     bool atFrontFeature;
+
+    std::shared_ptr<ConversionQueue> conversionQueue;
 };
 
 }  // namespace
@@ -280,7 +326,8 @@ KMLPlacemarkFeatureDef::KMLPlacemarkFeatureDef(KMLPtr<KMLPlacemark> &&placemark,
       container(nullptr),
       altitudeMode(AltitudeMode::TEAM_ClampToGround),
       extrude(0.0),
-      styleEncoding(StyleStyle) {}
+      styleEncoding(StyleStyle),
+      conversion(Conversion_Done) {}
 
 KMLPlacemarkFeatureDef::~KMLPlacemarkFeatureDef() NOTHROWS {}
 
@@ -438,6 +485,13 @@ TAKErr KMLPlacemarkFeatureDef::applyStyle() NOTHROWS {
     return code;
 }
 
+void KMLPlacemarkFeatureDef::convert() NOTHROWS {
+    // failures are left for the lazy accessors to report
+    if (!this->geometry) this->applyGeom();
+    if (!this->style && this->styleEncoding == StyleStyle) this->applyStyle();
+    if (!this->attrs) this->createAttrs();
+}
+
 TAKErr KMLPlacemarkFeatureDef::applyGeom() NOTHROWS {
     TAKErr code(TE_Ok);
 
@@ -481,9 +535,18 @@ KMLContent2::KMLContent2(const char *file)
       nextForwardContainerIndex(0),
       forwardContainer(nullptr),
       atFrontContainer(false),
-      atFrontFeature(false) {}
+      atFrontFeature(false),
+      conversionQueue(new ConversionQueue()) {
+    conversionQueue->maxWorkers = std::max(Platform_processorCount(), (std::size_t)2u) - 1u;
+}
 
-KMLContent2::~KMLContent2() {}
+KMLContent2::~KMLContent2() {
+    // Placemarks in flight are owned by the containers
+    Monitor::Lock lock(conversionQueue->monitor);
+    conversionQueue->pending.clear();
+    while (conversionQueue->workers)
+        lock.wait();
+}
 
 bool hasExt(const char *file, const char *matchExt) {
     const char *ext = strrchr(file, '.');
@@ -696,6 +759,7 @@ TAKErr KMLContent2::stepSecondPass() NOTHROWS {
                                 this->file));
                         featureDef->container = container;
                         container->featureDefs.push_back(std::move(featureDef));
+                        enqueueConversion(*container->featureDefs.back());
 
                         // certainly has Placemark and ready for processing
                         if (std::find(containerQueue.begin(),
@@ -759,6 +823,64 @@ TAKErr KMLContent2::handleFirstPassStyleSelector(
     return code;
 }
 
+void KMLContent2::enqueueConversion(KMLPlacemarkFeatureDef &featureDef) NOTHROWS {
+    TAKErr code(TE_Ok);
+    bool spawn = false;
+    {
+        Monitor::Lock lock(conversionQueue->monitor);
+        TE_BEGIN_TRAP() {
+            conversionQueue->pending.push_back(&featureDef);
+            featureDef.conversion = Conversion_Queued;
+        } TE_END_TRAP(code);
+        // on failure, the consumer converts on demand
+        if (code != TE_Ok)
+            return;
+        if (conversionQueue->workers < conversionQueue->maxWorkers) {
+            conversionQueue->workers++;
+            spawn = true;
+        }
+    }
+    if (spawn)
+        Task_begin(GeneralWorkers_cpu(), ConversionQueue_task, conversionQueue);
+}
+
+void KMLContent2::awaitConversion(KMLPlacemarkFeatureDef &featureDef) const NOTHROWS {
+    {
+        Monitor::Lock lock(conversionQueue->monitor);
+        while (featureDef.conversion == Conversion_Running)
+            lock.wait();
+        if (featureDef.conversion == Conversion_Done)
+            return;
+        // claim; the consumer is typically at the front of the queue
+        auto it = std::find(conversionQueue->pending.begin(), conversionQueue->pending.end(), &featureDef);
+        if (it != conversionQueue->pending.end())
+            conversionQueue->pending.erase(it);
+        featureDef.conversion = Conversion_Running;
+    }
+    featureDef.convert();
+    Monitor::Lock lock(conversionQueue->monitor);
+    featureDef.conversion = Conversion_Done;
+}
+
+void KMLContent2::cancelConversion(KMLPlacemarkFeatureDef &featureDef) const NOTHROWS {
+    Monitor::Lock lock(conversionQueue->monitor);
+    while (featureDef.conversion == Conversion_Running)
+        lock.wait();
+    if (featureDef.conversion == Conversion_Queued) {
+        auto it = std::find(conversionQueue->pending.begin(), conversionQueue->pending.end(), &featureDef);
+        if (it != conversionQueue->pending.end())
+            conversionQueue->pending.erase(it);
+        featureDef.conversion = Conversion_Done;
+    }
+}
+
+std::size_t KMLContent2::getReadAhead() const NOTHROWS {
+    std::size_t count = 0u;
+    for (const Container *container : containerQueue)
+        count += container->featureDefs.size();
+    return count;
+}
+
 const char *KMLContent2::getType() const NOTHROWS { return "kml"; }
 
 const char *KMLContent2::getProvider() const NOTHROWS { return "KML"; }
@@ -779,12 +901,17 @@ TAKErr KMLContent2::moveToNextFeatureInner() NOTHROWS {
     if (!atFrontContainer) return TE_IllegalState;
 
     if (atFrontFeature && this->containerQueue.front()->featureDefs.size()) {
+        // a Placemark skipped by the consumer may still be queued or
+        // converting on a worker
+        cancelConversion(*this->containerQueue.front()->featureDefs.front());
         this->containerQueue.front()->featureDefs.pop_front();
     }
     atFrontFeature = false;
 
-    while (this->containerQueue.front()->featureDefs.size() == 0 &&
-           !this->containerQueue.front()->finished) {
+    // parse ahead of the consumer while the workers convert
+    while (!this->containerQueue.front()->finished &&
+           (this->containerQueue.front()->featureDefs.size() == 0 ||
+            getReadAhead() < PREFETCH_PLACEMARKS)) {
         code = this->stepSecondPass();
         if (code == TE_Done) break;
         TE_CHECKRETURN_CODE(code);
@@ -868,6 +995,27 @@ TAKErr KMLContent2::getVisible(bool *visible) const NOTHROWS {
 }
 
 namespace {
+TAKErr ConversionQueue_task(bool &, const std::shared_ptr<ConversionQueue> &queue) NOTHROWS {
+    while (true) {
+        KMLPlacemarkFeatureDef *featureDef;
+        {
+            Monitor::Lock lock(queue->monitor);
+            if (queue->pending.empty()) {
+                queue->workers--;
+                lock.broadcast();
+                return TE_Ok;
+            }
+            featureDef = queue->pending.front();
+            queue->pending.pop_front();
+            featureDef->conversion = Conversion_Running;
+        }
+        featureDef->convert();
+        Monitor::Lock lock(queue->monitor);
+        featureDef->conversion = Conversion_Done;
+        lock.broadcast();
+    }
+}
+
 Container::~Container() {}
 
 void Container::getFullName(std::ostringstream &ss) const {
@@ -1,5 +1,6 @@
 
 #include <string.h>
+#include <cstdint>
 #include <vector>
 #include <libxml/xmlreader.h>
 #include "feature/KMLParser.h"
@@ -261,6 +262,73 @@ TAKErr stringToFloat(const char *str, double &value) NOTHROWS {
     return str != end ? TE_Ok : TE_Err;
 }
 
+namespace {
+    const double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    /**
+     * Parses a decimal number of the form `[+-]digits[.digits][(e|E)[+-]digits]`,
+     * returning the end of the number, as `strtod`. The result is exact when
+     * the significand fits in 53 bits and the exponent magnitude is at most 22,
+     * which covers practically all coordinates; other input is deferred to
+     * `strtod`. Unlike `strtod`, the parse is not locale sensitive.
+     */
+    const char *parseCoordinateValue(double *value, const char *str) NOTHROWS
+    {
+        const char *p = str;
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+            p++;
+        bool negative = false;
+        if (*p == '-' || *p == '+')
+            negative = (*p++ == '-');
+
+        uint64_t significand = 0u;
+        int significantDigits = 0;
+        int digits = 0;
+        int exponent = 0;
+        for (; *p >= '0' && *p <= '9'; p++, digits++) {
+            significand = significand * 10u + (*p - '0');
+            if (significand)
+                significantDigits++;
+        }
+        if (*p == '.') {
+            for (p++; *p >= '0' && *p <= '9'; p++, digits++) {
+                significand = significand * 10u + (*p - '0');
+                if (significand)
+                    significantDigits++;
+                exponent--;
+            }
+        }
+        if (digits && (*p == 'e' || *p == 'E')) {
+            const char *e = p + 1;
+            bool negativeExponent = false;
+            if (*e == '-' || *e == '+')
+                negativeExponent = (*e++ == '-');
+            if (*e >= '0' && *e <= '9') {
+                int exp = 0;
+                for (; *e >= '0' && *e <= '9'; e++)
+                    exp = std::min(exp * 10 + (*e - '0'), 10000);
+                exponent += negativeExponent ? -exp : exp;
+                p = e;
+            }
+        }
+
+        if (!digits || significantDigits > 19 || significand > (1ull << 53u) ||
+            exponent < -22 || exponent > 22 || *p == 'x' || *p == 'X') {
+            char *end;
+            *value = strtod(str, &end);
+            return end;
+        }
+
+        double v = (double)significand;
+        v = (exponent < 0) ? v / POW10[-exponent] : v * POW10[exponent];
+        *value = negative ? -v : v;
+        return p;
+    }
+}
+
 TAKErr KMLParser::parseVec2(KMLVec2 &vec2) NOTHROWS {
     vec2 = KMLVec2();
 
@@ -349,7 +417,8 @@ TAKErr KMLParser::parseCoordinates(KMLCoordinates &coords) NOTHROWS {
             }
             break;
         default: {
-            double v = strtod(pos, &delim);
+            double v;
+            delim = const_cast<char *>(parseCoordinateValue(&v, pos));
             if (pos == delim)
                 ++pos;
             else
@@ -580,7 +649,7 @@ TAKErr KMLParser::parsegxcoord(std::vector<KMLgxcoord> &coords) NOTHROWS {
 
     while (pos != end && vi < 3) {
         char *delim = nullptr;
-        vals[vi++] = strtod(pos, &delim);
+        delim = const_cast<char *>(parseCoordinateValue(&vals[vi++], pos));
         if (pos == delim)
             return TE_Err;
 
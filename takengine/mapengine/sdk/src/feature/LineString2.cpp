@@ -67,7 +67,7 @@ TAKErr LineString2::addPoints(const double *pts, const std::size_t numPts, const
     if ((this->numPoints + numPts)*this->dimension > this->pointsLength)
         this->growPoints(this->numPoints + numPts);
     if (ptsDim == this->dimension) {
-        memcpy(this->points.get(), pts, numPts*ptsDim*sizeof(double));
+        memcpy(this->points.get() + (this->numPoints*this->dimension), pts, numPts*ptsDim*sizeof(double));
         this->numPoints += numPts;
     } else {
         if (ptsDim < this->dimension) {
@@ -175,6 +175,16 @@ TAKErr LineString2::get(Point2 *value, const std::size_t i) const NOTHROWS
     return code;
 }
 
+TAKErr LineString2::getPoints(double *value, const std::size_t offset, const std::size_t count) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (offset > this->numPoints || count > (this->numPoints - offset))
+        return TE_BadIndex;
+    memcpy(value, this->points.get() + (offset*this->dimension), count*this->dimension*sizeof(double));
+    return TE_Ok;
+}
+
 TAKErr LineString2::setX(const std::size_t i, const double x) NOTHROWS
 {
     if (i >= this->numPoints)
@@ -5,12 +5,14 @@
 #include "feature/Point2.h"
 #include "port/Platform.h"
 #include "util/Memory.h"
+#include "util/SlabAllocator.h"
 
 namespace TAK {
     namespace Engine {
         namespace Feature {
             class ENGINE_API LineString2 : public Geometry2
             {
+                TE_SLAB_ALLOCATED()
             public :
                 /**
                  * Creates a new LineString2 with a default dimension of '2'.
@@ -123,6 +125,20 @@ namespace TAK {
                  * @return  TE_Ok on success; various codes on failure.
                  */
                 Util::TAKErr get(Point2 *value, const std::size_t i) const NOTHROWS;
+                /**
+                 * Copies a range of points out of the linestring in a single
+                 * operation. Points are written interleaved by component, with
+                 * the dimension of this linestring.
+                 *
+                 * @param value     Returns the points; must have room for
+                 *                  'count' * getDimension() values
+                 * @param offset    The index of the first point to copy
+                 * @param count     The number of points to copy
+                 *
+                 * @return  TE_Ok on success; TE_BadIndex if the range exceeds
+                 *          the points in the linestring.
+                 */
+                Util::TAKErr getPoints(double *value, const std::size_t offset, const std::size_t count) const NOTHROWS;
 
                 /**
                  * Sets the x-coordinate of the specified point.
@@ -132,6 +132,7 @@ PersistentDataSourceFeatureDataStore2::PersistentDataSourceFeatureDataStore2() N
 
 PersistentDataSourceFeatureDataStore2::~PersistentDataSourceFeatureDataStore2() NOTHROWS
 {
+    stopContentChangedCoalescing();
     closeImpl();
 }
 
@@ -17,7 +17,7 @@
 using namespace TAK::Engine::Feature;
 
 PersistentFeatureDataStore2::~PersistentFeatureDataStore2() NOTHROWS {
-    
+    stopContentChangedCoalescing();
 }
 
 TAK::Engine::Util::TAKErr PersistentFeatureDataStore2::setFeatureVisibleImpl(const int64_t fid, const bool visible) NOTHROWS {
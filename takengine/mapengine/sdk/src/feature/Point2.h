@@ -3,12 +3,14 @@
 
 #include "feature/Geometry2.h"
 #include "port/Platform.h"
+#include "util/SlabAllocator.h"
 
 namespace TAK {
     namespace Engine {
         namespace Feature {
             class ENGINE_API Point2 : public Geometry2
             {
+                TE_SLAB_ALLOCATED()
             public:
                 /**
                  * Creates a new 2D point.
@@ -0,0 +1,325 @@
+#include "feature/PointClusterer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace TAK::Engine::Feature;
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    // nodes not yet absorbed at the level being built
+    const int UNCLAIMED = INT_MAX;
+
+    /** longitude to Web Mercator X, normalized to [0, 1] */
+    double lngX(const double lng) NOTHROWS;
+    /** latitude to Web Mercator Y, normalized to [0, 1], north up */
+    double latY(const double lat) NOTHROWS;
+    double xLng(const double x) NOTHROWS;
+    double yLat(const double y) NOTHROWS;
+}
+
+PointClusterer::Options::Options() NOTHROWS :
+    radius(40.0),
+    tileSize(256.0),
+    minZoom(0),
+    maxZoom(16),
+    minPoints(2u)
+{}
+
+PointClusterer::PointClusterer() NOTHROWS :
+    PointClusterer(Options())
+{}
+PointClusterer::PointClusterer(const Options &opts_) NOTHROWS :
+    opts(opts_)
+{
+    if (opts.maxZoom < opts.minZoom)
+        opts.maxZoom = opts.minZoom;
+    if (opts.minPoints < 2u)
+        opts.minPoints = 2u;
+    validZoom = opts.maxZoom + 2;
+}
+PointClusterer::~PointClusterer() NOTHROWS
+{}
+
+TAKErr PointClusterer::insert(const int64_t id, const double latitude, const double longitude) NOTHROWS
+{
+    if (std::isnan(latitude) || std::isnan(longitude))
+        return TE_InvalidArg;
+    Point p;
+    p.x = lngX(longitude);
+    p.y = latY(latitude);
+
+    TAKErr code(TE_Ok);
+    TE_BEGIN_TRAP() {
+        auto entry = points.find(id);
+        if (entry == points.end()) {
+            points[id] = p;
+        } else if (entry->second.x != p.x || entry->second.y != p.y) {
+            entry->second = p;
+        } else {
+            // unchanged
+            return code;
+        }
+    } TE_END_TRAP(code);
+    TE_CHECKRETURN_CODE(code);
+
+    validZoom = opts.maxZoom + 2;
+    return code;
+}
+bool PointClusterer::remove(const int64_t id) NOTHROWS
+{
+    if (!points.erase(id))
+        return false;
+    validZoom = opts.maxZoom + 2;
+    return true;
+}
+void PointClusterer::clear() NOTHROWS
+{
+    points.clear();
+    levels.clear();
+    validZoom = opts.maxZoom + 2;
+}
+std::size_t PointClusterer::size() const NOTHROWS
+{
+    return points.size();
+}
+TAKErr PointClusterer::getClusters(std::vector<Cluster> &value, const Envelope2 &region, const int zoom) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    const int z = clampZoom(zoom);
+    code = validate(z);
+    TE_CHECKRETURN_CODE(code);
+
+    const Level &level = getLevel(z);
+    const double minY = latY(region.maxY);
+    const double maxY = latY(region.minY);
+    TE_BEGIN_TRAP() {
+        if (region.minX > region.maxX) {
+            query(value, level, lngX(region.minX), minY, 1.0, maxY);
+            query(value, level, 0.0, minY, lngX(region.maxX), maxY);
+        } else {
+            query(value, level, lngX(region.minX), minY, lngX(region.maxX), maxY);
+        }
+    } TE_END_TRAP(code);
+    return code;
+}
+TAKErr PointClusterer::getLeaves(std::vector<int64_t> &value, const int64_t id, const int zoom) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    const int z = clampZoom(zoom);
+    code = validate(z);
+    TE_CHECKRETURN_CODE(code);
+
+    TE_BEGIN_TRAP() {
+        const std::vector<Node> &nodes = getLevel(z).nodes;
+        std::vector<bool> members(nodes.size(), false);
+        bool found = false;
+        for (std::size_t i = 0u; i < nodes.size(); i++) {
+            if (nodes[i].id == id) {
+                members[i] = true;
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return TE_InvalidArg;
+
+        // descend, collecting the nodes absorbed by the members
+        for (int lz = z + 1; lz <= opts.maxZoom + 1; lz++) {
+            const std::vector<Node> &children = getLevel(lz).nodes;
+            std::vector<bool> childMembers(children.size(), false);
+            for (std::size_t i = 0u; i < children.size(); i++)
+                childMembers[i] = members[children[i].parent];
+            members.swap(childMembers);
+        }
+
+        const std::vector<Node> &leaves = getLevel(opts.maxZoom + 1).nodes;
+        for (std::size_t i = 0u; i < leaves.size(); i++) {
+            if (members[i])
+                value.push_back(leaves[i].id);
+        }
+    } TE_END_TRAP(code);
+    return code;
+}
+TAKErr PointClusterer::validate(const int zoom) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (validZoom > opts.maxZoom + 1) {
+        code = buildLeaves();
+        TE_CHECKRETURN_CODE(code);
+        validZoom = opts.maxZoom + 1;
+    }
+    while (validZoom > zoom) {
+        code = buildLevel(validZoom - 1);
+        TE_CHECKRETURN_CODE(code);
+        validZoom--;
+    }
+    return code;
+}
+TAKErr PointClusterer::buildLeaves() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    TE_BEGIN_TRAP() {
+        if (levels.empty())
+            levels.resize(static_cast<std::size_t>(opts.maxZoom - opts.minZoom + 2));
+        Level &leaves = getLevel(opts.maxZoom + 1);
+        leaves.nodes.clear();
+        leaves.nodes.reserve(points.size());
+        for (auto it = points.begin(); it != points.end(); it++) {
+            Node node;
+            node.x = it->second.x;
+            node.y = it->second.y;
+            node.count = 1u;
+            node.id = it->first;
+            node.zoom = UNCLAIMED;
+            node.parent = 0u;
+            leaves.nodes.push_back(node);
+        }
+        // the greedy pass is order dependent; order by ID so that the
+        // clustering is stable for a given set of points
+        std::sort(leaves.nodes.begin(), leaves.nodes.end(), [](const Node &a, const Node &b)
+        {
+            return a.id < b.id;
+        });
+
+        std::vector<std::size_t> indices(leaves.nodes.size());
+        std::vector<PackedRTree<std::size_t>::Bounds> bounds(leaves.nodes.size());
+        for (std::size_t i = 0u; i < leaves.nodes.size(); i++) {
+            indices[i] = i;
+            bounds[i].minX = bounds[i].maxX = leaves.nodes[i].x;
+            bounds[i].minY = bounds[i].maxY = leaves.nodes[i].y;
+        }
+        code = leaves.index.load(indices.data(), bounds.data(), indices.size());
+    } TE_END_TRAP(code);
+    return code;
+}
+TAKErr PointClusterer::buildLevel(const int zoom) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    TE_BEGIN_TRAP() {
+        Level &src = getLevel(zoom + 1);
+        Level &dst = getLevel(zoom);
+        dst.nodes.clear();
+
+        for (std::size_t i = 0u; i < src.nodes.size(); i++)
+            src.nodes[i].zoom = UNCLAIMED;
+
+        const double r = opts.radius / (opts.tileSize * std::ldexp(1.0, zoom));
+        const double r2 = r * r;
+        std::vector<std::size_t> neighbors;
+        for (std::size_t i = 0u; i < src.nodes.size(); i++) {
+            Node &p = src.nodes[i];
+            if (p.zoom <= zoom)
+                continue;
+            p.zoom = zoom;
+
+            neighbors.clear();
+            std::size_t count = p.count;
+            src.index.visit(p.x - r, p.y - r, p.x + r, p.y + r, [&](const std::size_t &j) -> bool
+            {
+                const Node &n = src.nodes[j];
+                if (n.zoom > zoom) {
+                    const double dx = n.x - p.x;
+                    const double dy = n.y - p.y;
+                    if ((dx * dx + dy * dy) <= r2) {
+                        neighbors.push_back(j);
+                        count += n.count;
+                    }
+                }
+                return true;
+            });
+
+            const std::size_t parent = dst.nodes.size();
+            p.parent = parent;
+            if (count > p.count && count >= opts.minPoints) {
+                double wx = p.x * p.count;
+                double wy = p.y * p.count;
+                for (std::size_t j : neighbors) {
+                    Node &n = src.nodes[j];
+                    n.zoom = zoom;
+                    n.parent = parent;
+                    wx += n.x * n.count;
+                    wy += n.y * n.count;
+                }
+                Node cluster;
+                cluster.x = wx / count;
+                cluster.y = wy / count;
+                cluster.count = count;
+                cluster.id = p.id;
+                cluster.zoom = UNCLAIMED;
+                cluster.parent = 0u;
+                dst.nodes.push_back(cluster);
+            } else {
+                // too few points to cluster; carry the nodes to the next
+                // level individually
+                dst.nodes.push_back(p);
+                dst.nodes.back().zoom = UNCLAIMED;
+                for (std::size_t j : neighbors) {
+                    Node &n = src.nodes[j];
+                    n.zoom = zoom;
+                    n.parent = dst.nodes.size();
+                    dst.nodes.push_back(n);
+                    dst.nodes.back().zoom = UNCLAIMED;
+                }
+            }
+        }
+
+        std::vector<std::size_t> indices(dst.nodes.size());
+        std::vector<PackedRTree<std::size_t>::Bounds> bounds(dst.nodes.size());
+        for (std::size_t i = 0u; i < dst.nodes.size(); i++) {
+            indices[i] = i;
+            bounds[i].minX = bounds[i].maxX = dst.nodes[i].x;
+            bounds[i].minY = bounds[i].maxY = dst.nodes[i].y;
+        }
+        code = dst.index.load(indices.data(), bounds.data(), indices.size());
+    } TE_END_TRAP(code);
+    return code;
+}
+PointClusterer::Level &PointClusterer::getLevel(const int zoom) NOTHROWS
+{
+    return levels[static_cast<std::size_t>(zoom - opts.minZoom)];
+}
+int PointClusterer::clampZoom(const int zoom) const NOTHROWS
+{
+    return std::max(opts.minZoom, std::min(zoom, opts.maxZoom + 1));
+}
+void PointClusterer::query(std::vector<Cluster> &value, const Level &level, const double minX, const double minY, const double maxX, const double maxY) const
+{
+    level.index.visit(minX, minY, maxX, maxY, [&](const std::size_t &i) -> bool
+    {
+        const Node &node = level.nodes[i];
+        Cluster c;
+        c.longitude = xLng(node.x);
+        c.latitude = yLat(node.y);
+        c.count = node.count;
+        c.id = node.id;
+        value.push_back(c);
+        return true;
+    });
+}
+
+namespace
+{
+    double lngX(const double lng) NOTHROWS
+    {
+        return lng / 360.0 + 0.5;
+    }
+    double latY(const double lat) NOTHROWS
+    {
+        const double s = sin(lat * M_PI / 180.0);
+        const double y = 0.5 - 0.25 * log((1.0 + s) / (1.0 - s)) / M_PI;
+        return (y < 0.0) ? 0.0 : ((y > 1.0) ? 1.0 : y);
+    }
+    double xLng(const double x) NOTHROWS
+    {
+        return (x - 0.5) * 360.0;
+    }
+    double yLat(const double y) NOTHROWS
+    {
+        const double y2 = (180.0 - y * 360.0) * M_PI / 180.0;
+        return 360.0 * atan(exp(y2)) / M_PI - 90.0;
+    }
+}
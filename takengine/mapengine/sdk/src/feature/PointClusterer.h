@@ -0,0 +1,142 @@
+#ifndef TAK_ENGINE_FEATURE_POINTCLUSTERER_H_INCLUDED
+#define TAK_ENGINE_FEATURE_POINTCLUSTERER_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "feature/Envelope2.h"
+#include "port/Platform.h"
+#include "util/Error.h"
+#include "util/NonCopyable.h"
+#include "util/PackedRTree.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Feature {
+            /**
+             * Hierarchical greedy clustering of points per OSM (mapnik)
+             * zoom level.
+             *
+             * <P>Points are projected to Web Mercator. Starting at the
+             * maximum zoom, each point or cluster not yet claimed absorbs
+             * its unclaimed neighbors within `radius` pixels; if the
+             * resulting group holds at least `minPoints` points, it is
+             * replaced by a cluster at its weighted centroid. The clusters
+             * of a zoom seed the next lower zoom. Each level is indexed by
+             * a `PackedRTree`.
+             *
+             * <P>Modifications only update the point set; the levels are
+             * recomputed lazily, down to the lowest zoom that has been
+             * queried, on the next query. Re-inserting a point at its
+             * current location does not invalidate the levels.
+             *
+             * <P>This class is not thread-safe.
+             */
+            class ENGINE_API PointClusterer : TAK::Engine::Util::NonCopyable
+            {
+            public :
+                struct ENGINE_API Options
+                {
+                    Options() NOTHROWS;
+
+                    /** the cluster radius, in pixels */
+                    double radius;
+                    /** the size of a tile, in pixels */
+                    double tileSize;
+                    /** the lowest zoom level that is clustered */
+                    int minZoom;
+                    /** points are not clustered beyond this zoom level */
+                    int maxZoom;
+                    /** the minimum number of points that form a cluster */
+                    std::size_t minPoints;
+                };
+                struct ENGINE_API Cluster
+                {
+                    double longitude;
+                    double latitude;
+                    /** the number of points; `1` for unclustered points */
+                    std::size_t count;
+                    /**
+                     * The ID of the point, or, for clusters, the ID of the
+                     * point that seeded the cluster
+                     */
+                    int64_t id;
+                };
+            public :
+                PointClusterer() NOTHROWS;
+                PointClusterer(const Options &opts) NOTHROWS;
+                ~PointClusterer() NOTHROWS;
+            public :
+                /**
+                 * Inserts the point, or moves it if a point with the same ID
+                 * is present.
+                 */
+                Util::TAKErr insert(const int64_t id, const double latitude, const double longitude) NOTHROWS;
+                /**
+                 * @return  `true` if the point was removed, `false` if it is
+                 *          not present
+                 */
+                bool remove(const int64_t id) NOTHROWS;
+                void clear() NOTHROWS;
+                std::size_t size() const NOTHROWS;
+                /**
+                 * Appends the clusters and unclustered points at `zoom` that
+                 * fall within `region` (WGS84) to `value`. The region may
+                 * cross the IDL, indicated by `minX > maxX`.
+                 *
+                 * @return  TE_Ok on success, various codes on failure
+                 */
+                Util::TAKErr getClusters(std::vector<Cluster> &value, const Envelope2 &region, const int zoom) NOTHROWS;
+                /**
+                 * Appends the IDs of the points of the cluster seeded by
+                 * `id` at `zoom` to `value`.
+                 *
+                 * @return  TE_Ok on success, TE_InvalidArg if there is no
+                 *          such cluster or point
+                 */
+                Util::TAKErr getLeaves(std::vector<int64_t> &value, const int64_t id, const int zoom) NOTHROWS;
+            private :
+                struct Node
+                {
+                    double x;
+                    double y;
+                    std::size_t count;
+                    /** the point ID, or the seed point ID for clusters */
+                    int64_t id;
+                    /** the lowest zoom at which the node was absorbed */
+                    int zoom;
+                    /** index of the cluster absorbing the node, in the next lower level */
+                    std::size_t parent;
+                };
+                struct Level
+                {
+                    std::vector<Node> nodes;
+                    Util::PackedRTree<std::size_t> index;
+                };
+                struct Point
+                {
+                    double x;
+                    double y;
+                };
+            private :
+                Util::TAKErr validate(const int zoom) NOTHROWS;
+                Util::TAKErr buildLeaves() NOTHROWS;
+                Util::TAKErr buildLevel(const int zoom) NOTHROWS;
+                Level &getLevel(const int zoom) NOTHROWS;
+                int clampZoom(const int zoom) const NOTHROWS;
+                void query(std::vector<Cluster> &value, const Level &level, const double minX, const double minY, const double maxX, const double maxY) const;
+            private :
+                Options opts;
+                std::unordered_map<int64_t, Point> points;
+                /** `maxZoom - minZoom + 2` levels, the last holding the points */
+                std::vector<Level> levels;
+                /** the lowest zoom for which the levels are valid */
+                int validZoom;
+            };
+        }
+    }
+}
+
+#endif
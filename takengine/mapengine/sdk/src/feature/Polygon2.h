@@ -7,6 +7,7 @@
 #include "feature/LineString2.h"
 #include "port/Collection.h"
 #include "port/Platform.h"
+#include "util/SlabAllocator.h"
 
 namespace TAK {
     namespace Engine {
@@ -17,6 +18,7 @@ namespace TAK {
              */
             class ENGINE_API Polygon2 : public Geometry2
             {
+                TE_SLAB_ALLOCATED()
             public :
                 /**
                  * Creates a new polygon with a default dimension of '2'.
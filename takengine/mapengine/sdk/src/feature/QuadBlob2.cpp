@@ -46,54 +46,40 @@ TAK::Engine::Util::TAKErr TAK::Engine::Feature::QuadBlob2_get(uint8_t *value, co
     const double &dlat = d.y;
     const double &dlng = d.x;
 
-    const double mbrMinX = min4(alng, blng, clng, dlng);
-    const double mbrMinY = min4(alat, blat, clat, dlat);
-    const double mbrMaxX = max4(alng, blng, clng, dlng);
-    const double mbrMaxY = max4(alat, blat, clat, dlat);
-
-    code = output.writeByte(0x00);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeByte(blobEndian);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeInt(4326);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(mbrMinX);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(mbrMinY);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(mbrMaxX);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(mbrMaxY);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeByte(0x7c);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeInt(0x03);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeInt(1);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeInt(5);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(alng);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(alat);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(blng);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(blat);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(clng);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(clat);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(dlng);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(dlat);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(alng);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeDouble(alat);
-    TE_CHECKRETURN_CODE(code);
-    code = output.writeByte(0xfe);
+    // quantities are written in platform byte order
+    const uint8_t header[2u] = { 0x00, blobEndian };
+    const int32_t srid = 4326;
+    const double mbr[4u] =
+    {
+        min4(alng, blng, clng, dlng),
+        min4(alat, blat, clat, dlat),
+        max4(alng, blng, clng, dlng),
+        max4(alat, blat, clat, dlat),
+    };
+    const uint8_t classMarker = 0x7c;
+    // geometry type (polygon), ring count, point count
+    const int32_t polygon[3u] = { 0x03, 1, 5 };
+    const double ring[10u] =
+    {
+        alng, alat,
+        blng, blat,
+        clng, clat,
+        dlng, dlat,
+        alng, alat,
+    };
+    const uint8_t endMarker = 0xfe;
+
+    const DataOutput2::Segment segments[] =
+    {
+        { header, sizeof(header) },
+        { reinterpret_cast<const uint8_t *>(&srid), sizeof(srid) },
+        { reinterpret_cast<const uint8_t *>(mbr), sizeof(mbr) },
+        { &classMarker, 1u },
+        { reinterpret_cast<const uint8_t *>(polygon), sizeof(polygon) },
+        { reinterpret_cast<const uint8_t *>(ring), sizeof(ring) },
+        { &endMarker, 1u },
+    };
+    code = output.writev(segments, sizeof(segments) / sizeof(segments[0u]));
 
     return code;
 }
@@ -12,6 +12,7 @@
 #include "thread/Lock.h"
 
 #include "util/Memory.h"
+#include "util/MemoryAccounting.h"
 
 using namespace TAK::Engine;
 using namespace TAK::Engine::Feature;
@@ -33,15 +34,6 @@ namespace {
     void noopDeleterFunc(const T *)
     { }
     
-    template <typename T>
-    void featureRecordQuadtreeFunction(const std::shared_ptr<T> &object, atakmap::math::Point<double> &min, atakmap::math::Point<double> &max) {
-        atakmap::feature::Envelope mbb = object->geom->getEnvelope();
-        min.x = mbb.minX;
-        min.y = mbb.minY;
-        max.x = mbb.maxX;
-        max.y = mbb.maxY;
-    }
-    
     template <typename MapType, typename ItemType>
     void insertNameindex(MapType &index, ItemType *item);
     
@@ -103,7 +95,7 @@ namespace {
     }
     
     template <typename T, typename SetIndexType>
-    bool secondaryParamsFilter(const T &feature, const SetIndexType &setIndex, const TAK::Engine::Feature::FeatureDataStore2::FeatureQueryParameters &params) {
+    bool secondaryParamsFilter(const T &feature, const int64_t visibleGeneration, const bool visible, const SetIndexType &setIndex, const TAK::Engine::Feature::FeatureDataStore2::FeatureQueryParameters &params) {
         
         if (!::collectionFilter(params.featureNames, feature.name) ||
             !::collectionFilter(params.geometryTypes, feature.geom->getType()))
@@ -127,8 +119,8 @@ namespace {
             }
             
             if (params.visibleOnly) {
-                if ((setIt->second.visibleGeneration >= feature.visibleGeneration && !setIt->second.visible) ||
-                    (feature.visibleGeneration > setIt->second.visibleGeneration && !feature.visible)) {
+                if ((setIt->second.visibleGeneration >= visibleGeneration && !setIt->second.visible) ||
+                    (visibleGeneration > setIt->second.visibleGeneration && !visible)) {
                     return false;
                 }
             }
@@ -210,15 +202,16 @@ struct RuntimeFeatureDataStore2::FeatureSetRecord {
 
 struct RuntimeFeatureDataStore2::FeatureRecord {
        
-    // avoids overhead of copying temp shared_ptrs
+    // records are immutable once indexed, excepting visibility; updates
+    // share the unmodified members of the replaced record
     inline FeatureRecord(int64_t id,
                          int64_t featureSetId,
                          const char *name,
-                         std::shared_ptr<atakmap::feature::Style> &&style,
-                         std::shared_ptr<atakmap::feature::Geometry> &&geom,
+                         std::shared_ptr<atakmap::feature::Style> style,
+                         std::shared_ptr<atakmap::feature::Geometry> geom,
                          const AltitudeMode altitudeMode,
                          const double extrude,
-                         std::shared_ptr<atakmap::util::AttributeSet> &&attrs,
+                         std::shared_ptr<atakmap::util::AttributeSet> attrs,
                          int64_t version) :
     id(id),
     setId(featureSetId),
@@ -230,8 +223,21 @@ struct RuntimeFeatureDataStore2::FeatureRecord {
     attrs(std::move(attrs)),
     version(version),
     visibleGeneration(0),
-    visible(true)
-    { }
+    visible(true),
+    accountedSize(sizeof(FeatureRecord))
+    {
+        if (this->geom) {
+            accountedSize += this->geom->computeWKB_Size();
+            mbb = this->geom->getEnvelope();
+        }
+        if (name)
+            accountedSize += strlen(name);
+        MemoryAccounting_allocate(TEMC_FeatureStore, accountedSize);
+    }
+    inline ~FeatureRecord()
+    {
+        MemoryAccounting_release(TEMC_FeatureStore, accountedSize);
+    }
 
     inline const char *getName() const { return name; }
     
@@ -246,6 +252,37 @@ struct RuntimeFeatureDataStore2::FeatureRecord {
     std::shared_ptr<atakmap::util::AttributeSet> attrs;
     int64_t visibleGeneration;
     bool visible;
+    /** bytes recorded against `TEMC_FeatureStore` */
+    std::size_t accountedSize;
+    atakmap::feature::Envelope mbb;
+};
+
+/**
+ * Immutable view of the features of the store. Records are shared with the
+ * live indices; the visibility state, which is modified in place on the
+ * records, is captured.
+ */
+struct RuntimeFeatureDataStore2::Snapshot {
+    struct FeatureEntry {
+        std::shared_ptr<FeatureRecord> record;
+        int64_t visibleGeneration;
+        bool visible;
+    };
+    struct FeatureSetEntry {
+        std::shared_ptr<FeatureSet2> current;
+        int64_t visibleGeneration;
+        bool visible;
+        /** indices into `features` */
+        std::vector<std::size_t> features;
+    };
+
+    int64_t version {0};
+    /** ascending feature ID */
+    std::vector<FeatureEntry> features;
+    std::unordered_map<int64_t, std::size_t> featureIdIndex;
+    std::unordered_map<int64_t, FeatureSetEntry> featureSetIdIndex;
+    /** indices into `features` */
+    Util::PackedRTree<std::size_t> featureSpatialIndex;
 };
 
 RuntimeFeatureDataStore2::RuntimeFeatureDataStore2() NOTHROWS :
@@ -268,16 +305,23 @@ RuntimeFeatureDataStore2(FeatureDataStore2::MODIFY_BULK_MODIFICATIONS |
 { }
 
 RuntimeFeatureDataStore2::RuntimeFeatureDataStore2(int modificationFlags, int visibilityFlags) NOTHROWS :
+RuntimeFeatureDataStore2(modificationFlags, visibilityFlags, false)
+{ }
+
+RuntimeFeatureDataStore2::RuntimeFeatureDataStore2(int modificationFlags, int visibilityFlags, const bool snapshotReads_) NOTHROWS :
 AbstractFeatureDataStore2(modificationFlags, visibilityFlags),
-featureSpatialIndex(::featureRecordQuadtreeFunction<FeatureRecord>, -180.0, -90.0, 180.0, 90.0),
 nextFeatureSetId(1),
 nextFeatureId(1),
 inBulkModify(false),
-visibleGeneration(1)
+visibleGeneration(1),
+snapshotReads(snapshotReads_),
+modificationCount(0)
 { }
 
 RuntimeFeatureDataStore2::~RuntimeFeatureDataStore2() NOTHROWS
-{ }
+{
+    stopContentChangedCoalescing();
+}
 
 Util::TAKErr RuntimeFeatureDataStore2::getFeature(FeaturePtr_const &feature, const int64_t fid) NOTHROWS {
     TAKErr code(TE_Ok);
@@ -292,8 +336,13 @@ Util::TAKErr RuntimeFeatureDataStore2::getFeature(FeaturePtr_const &feature, con
     
     //XXX-- avoid full copy of details?
     const FeatureRecord *record = featureIt->second.get();
-    feature = FeaturePtr_const(new Feature2(record->id, record->setId, record->name, *record->geom, record->altitudeMode, record->extrude,
-                                            *record->style, *record->attrs, record->version),
+    // features may be inserted without style or attributes
+    feature = FeaturePtr_const(new Feature2(record->id, record->setId, record->name,
+                                            GeometryPtr_const(record->geom ? record->geom->clone() : nullptr, atakmap::feature::destructGeometry),
+                                            record->altitudeMode, record->extrude,
+                                            StylePtr_const(record->style ? record->style->clone() : nullptr, atakmap::feature::Style::destructStyle),
+                                            AttributeSetPtr_const(record->attrs ? new atakmap::util::AttributeSet(*record->attrs) : nullptr, Memory_deleter_const<atakmap::util::AttributeSet>),
+                                            record->version),
                                ::deleteDeleterFunc<Feature2>);
     
     return Util::TE_Ok;
@@ -302,6 +351,22 @@ Util::TAKErr RuntimeFeatureDataStore2::getFeature(FeaturePtr_const &feature, con
 Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor) NOTHROWS {
     
     TAKErr code(TE_Ok);
+    if (this->snapshotReads) {
+        std::shared_ptr<const Snapshot> snap;
+        code = this->getSnapshot(snap);
+        TE_CHECKRETURN_CODE(code);
+
+        std::vector<std::shared_ptr<FeatureRecord>> items;
+        items.reserve(snap->features.size());
+        for (auto &entry : snap->features) {
+            items.push_back(entry.record);
+        }
+
+        cursor = FeatureCursorPtr(new ::RuntimeFeatureCursor2<FeatureRecord>(std::move(items)),
+                                  ::castDeleteDeleterFunc<FeatureCursor2, ::RuntimeFeatureCursor2<FeatureRecord>>);
+        return Util::TE_Ok;
+    }
+
     Lock lock(mutex_);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
@@ -321,10 +386,23 @@ Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor) N
 Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor, const FeatureQueryParameters &params) NOTHROWS {
 
     TAKErr code(TE_Ok);
+    if (this->snapshotReads) {
+        std::shared_ptr<const Snapshot> snap;
+        code = this->getSnapshot(snap);
+        TE_CHECKRETURN_CODE(code);
+        return querySnapshot(cursor, *snap, params);
+    }
+
     Lock lock(mutex_);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    
+
+    return this->queryFeaturesNoSync(cursor, params);
+}
+
+Util::TAKErr RuntimeFeatureDataStore2::queryFeaturesNoSync(FeatureCursorPtr &cursor, const FeatureQueryParameters &params) NOTHROWS {
+
+    TAKErr code(TE_Ok);
     std::vector<std::shared_ptr<FeatureRecord>> items;
     int offset = params.offset;
     size_t limit = params.limit ? params.limit : SIZE_MAX;
@@ -333,16 +411,31 @@ Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor, c
         //XXX-- for now use the envelope
         atakmap::feature::Envelope env = params.spatialFilter->getEnvelope();
         
-        this->featureSpatialIndex.get(env.minX, env.minY, env.maxX, env.maxY,
-                                      featureSpatialIndexVisitor, &items);
-    }
-    
-    if (params.featureIds && params.featureIds->size()) {
+        std::vector<std::shared_ptr<FeatureRecord> *> candidates;
+        code = this->featureSpatialIndex.query(candidates, env.minX, env.minY, env.maxX, env.maxY);
+        TE_CHECKRETURN_CODE(code);
+        
+        for (std::shared_ptr<FeatureRecord> *candidate : candidates) {
+            const FeatureRecord &rec = **candidate;
+            if (::collectionFilter(params.featureIds, rec.id) &&
+                ::collectionFilter(params.featureSetIds, rec.setId) &&
+                ::secondaryParamsFilter(rec, rec.visibleGeneration, rec.visible, this->featureSetIdIndex, params)) {
+                
+                if (offset) {
+                    --offset;
+                } else {
+                    items.push_back(*candidate);
+                    if (items.size() == limit)
+                        break;
+                }
+            }
+        }
+    } else if (params.featureIds && params.featureIds->size()) {
         Port::Collections_forEach(*params.featureIds, [&](int64_t featureId) {
             auto featureIt = this->featureIdIndex.find(featureId);
             if (featureIt != this->featureIdIndex.end() &&
                 ::collectionFilter(params.featureSetIds, featureIt->second->setId) &&
-                ::secondaryParamsFilter(*featureIt->second, this->featureSetIdIndex, params)) {
+                ::secondaryParamsFilter(*featureIt->second, featureIt->second->visibleGeneration, featureIt->second->visible, this->featureSetIdIndex, params)) {
                 
                 if (offset) {
                     --offset;
@@ -359,7 +452,7 @@ Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor, c
             auto featureSetIt = this->featureSetIdIndex.find(featureSetId);
             if (featureSetIt != this->featureSetIdIndex.end()) {
                 for (const FeatureRecord *rec : featureSetIt->second.features) {
-                    if (::secondaryParamsFilter(*rec, this->featureSetIdIndex, params)) {
+                    if (::secondaryParamsFilter(*rec, rec->visibleGeneration, rec->visible, this->featureSetIdIndex, params)) {
                         if (offset) {
                             --offset;
                         } else {
@@ -375,7 +468,7 @@ Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor, c
         });
     } else {
         for (auto &pair : this->featureIdIndex) {
-            if (::secondaryParamsFilter(*pair.second, this->featureSetIdIndex, params)) {
+            if (::secondaryParamsFilter(*pair.second, pair.second->visibleGeneration, pair.second->visible, this->featureSetIdIndex, params)) {
                 if (offset) {
                     --offset;
                 } else {
@@ -399,8 +492,173 @@ Util::TAKErr RuntimeFeatureDataStore2::queryFeatures(FeatureCursorPtr &cursor, c
     return Util::TE_Ok;
 }
 
-void RuntimeFeatureDataStore2::featureSpatialIndexVisitor(std::shared_ptr<TAK::Engine::Feature::RuntimeFeatureDataStore2::FeatureRecord> *record, void *opaque) {
-    //auto *items = static_cast<std::vector<std::shared_ptr<FeatureRecord>> *>(opaque);    
+void RuntimeFeatureDataStore2::insertSpatialIndex(FeatureSpatialIndex &index, std::shared_ptr<FeatureRecord> *record) NOTHROWS {
+    if (!(*record)->geom)
+        return;
+    const atakmap::feature::Envelope &mbb = (*record)->mbb;
+    index.insert(record, mbb.minX, mbb.minY, mbb.maxX, mbb.maxY);
+}
+
+void RuntimeFeatureDataStore2::setModifiedNoSync() NOTHROWS {
+    this->setContentChanged();
+    this->modificationCount++;
+}
+
+Util::TAKErr RuntimeFeatureDataStore2::getSnapshot(std::shared_ptr<const Snapshot> &value) NOTHROWS {
+    TAKErr code(TE_Ok);
+    {
+        Lock lock(snapshotMutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        if (this->snapshot && this->snapshot->version == this->modificationCount.load()) {
+            value = this->snapshot;
+            return code;
+        }
+    }
+
+    // the snapshot mutex is never held while acquiring the writer lock;
+    // listeners may query from within a content changed dispatch
+    std::shared_ptr<Snapshot> next;
+    TE_BEGIN_TRAP() {
+        next = std::make_shared<Snapshot>();
+        {
+            // only the records are captured under the writer lock; the
+            // indices are built outside of it
+            Lock lock(mutex_);
+            code = lock.status;
+            TE_CHECKRETURN_CODE(code);
+
+            next->version = this->modificationCount.load();
+            next->features.reserve(this->featureIdIndex.size());
+            for (auto &pair : this->featureIdIndex) {
+                Snapshot::FeatureEntry entry;
+                entry.record = pair.second;
+                entry.visibleGeneration = pair.second->visibleGeneration;
+                entry.visible = pair.second->visible;
+                next->features.push_back(std::move(entry));
+            }
+            for (auto &pair : this->featureSetIdIndex) {
+                Snapshot::FeatureSetEntry &entry = next->featureSetIdIndex[pair.first];
+                entry.current = pair.second.current;
+                entry.visibleGeneration = pair.second.visibleGeneration;
+                entry.visible = pair.second.visible;
+            }
+        }
+
+        std::sort(next->features.begin(), next->features.end(), [](const Snapshot::FeatureEntry &a, const Snapshot::FeatureEntry &b) {
+            return a.record->id < b.record->id;
+        });
+
+        std::vector<std::size_t> values;
+        std::vector<Util::PackedRTree<std::size_t>::Bounds> bounds;
+        values.reserve(next->features.size());
+        bounds.reserve(next->features.size());
+        next->featureIdIndex.reserve(next->features.size());
+        for (std::size_t i = 0u; i < next->features.size(); i++) {
+            const FeatureRecord &record = *next->features[i].record;
+            next->featureIdIndex[record.id] = i;
+            auto setIt = next->featureSetIdIndex.find(record.setId);
+            if (setIt != next->featureSetIdIndex.end())
+                setIt->second.features.push_back(i);
+            if (record.geom) {
+                Util::PackedRTree<std::size_t>::Bounds b;
+                b.minX = record.mbb.minX;
+                b.minY = record.mbb.minY;
+                b.maxX = record.mbb.maxX;
+                b.maxY = record.mbb.maxY;
+                values.push_back(i);
+                bounds.push_back(b);
+            }
+        }
+        code = next->featureSpatialIndex.load(values.data(), bounds.data(), values.size());
+    } TE_END_TRAP(code);
+    TE_CHECKRETURN_CODE(code);
+
+    Lock lock(snapshotMutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    // a concurrent query may have published a more recent snapshot
+    if (!this->snapshot || this->snapshot->version < next->version)
+        this->snapshot = next;
+    value = next;
+    return code;
+}
+
+Util::TAKErr RuntimeFeatureDataStore2::querySnapshot(FeatureCursorPtr &cursor, const Snapshot &snapshot, const FeatureQueryParameters &params) NOTHROWS {
+    TAKErr code(TE_Ok);
+
+    std::vector<std::shared_ptr<FeatureRecord>> items;
+    int offset = params.offset;
+    size_t limit = params.limit ? params.limit : SIZE_MAX;
+
+    // returns `false` once the limit is reached
+    auto accept = [&](const Snapshot::FeatureEntry &entry) {
+        if (!::secondaryParamsFilter(*entry.record, entry.visibleGeneration, entry.visible, snapshot.featureSetIdIndex, params))
+            return true;
+        if (offset) {
+            --offset;
+            return true;
+        }
+        items.push_back(entry.record);
+        return (items.size() < limit);
+    };
+
+    if (params.spatialFilter) {
+        //XXX-- for now use the envelope
+        atakmap::feature::Envelope env = params.spatialFilter->getEnvelope();
+
+        std::vector<std::size_t> candidates;
+        code = snapshot.featureSpatialIndex.query(candidates, env.minX, env.minY, env.maxX, env.maxY);
+        TE_CHECKRETURN_CODE(code);
+        // visit in ID order so that offset and limit are deterministic
+        std::sort(candidates.begin(), candidates.end());
+
+        for (std::size_t candidate : candidates) {
+            const Snapshot::FeatureEntry &entry = snapshot.features[candidate];
+            if (!::collectionFilter(params.featureIds, entry.record->id) ||
+                !::collectionFilter(params.featureSetIds, entry.record->setId))
+                continue;
+            if (!accept(entry))
+                break;
+        }
+    } else if (params.featureIds && params.featureIds->size()) {
+        Port::Collections_forEach(*params.featureIds, [&](int64_t featureId) {
+            auto featureIt = snapshot.featureIdIndex.find(featureId);
+            if (featureIt != snapshot.featureIdIndex.end() &&
+                ::collectionFilter(params.featureSetIds, snapshot.features[featureIt->second].record->setId) &&
+                !accept(snapshot.features[featureIt->second])) {
+
+                return Util::TE_Done;
+            }
+            return Util::TE_Ok;
+        });
+    } else if (params.featureSetIds && params.featureSetIds->size()) {
+        Port::Collections_forEach(*params.featureSetIds, [&](int64_t featureSetId) {
+            auto featureSetIt = snapshot.featureSetIdIndex.find(featureSetId);
+            if (featureSetIt != snapshot.featureSetIdIndex.end()) {
+                for (std::size_t idx : featureSetIt->second.features) {
+                    if (!accept(snapshot.features[idx]))
+                        return Util::TE_Done;
+                }
+            }
+            return Util::TE_Ok;
+        });
+    } else {
+        for (const Snapshot::FeatureEntry &entry : snapshot.features) {
+            if (!accept(entry))
+                break;
+        }
+    }
+
+    // sort by ID
+    std::sort(items.begin(), items.end(), [](const std::shared_ptr<FeatureRecord> &a, const std::shared_ptr<FeatureRecord> &b) {
+        return a->id < b->id;
+    });
+
+    cursor = FeatureCursorPtr(new ::RuntimeFeatureCursor2<FeatureRecord>(std::move(items)),
+                              ::castDeleteDeleterFunc<FeatureCursor2, ::RuntimeFeatureCursor2<FeatureRecord>>);
+
+    return code;
 }
 
 Util::TAKErr RuntimeFeatureDataStore2::queryFeaturesCount(int *value) NOTHROWS {
@@ -686,7 +944,7 @@ Util::TAKErr RuntimeFeatureDataStore2::insertFeatureSetImpl(FeatureSetPtr_const
     if (inserted)
         *inserted = FeatureSetPtr_const(new FeatureSet2(*idIt->second.current), ::deleteDeleterFunc<FeatureSet2>);
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -709,7 +967,7 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureSetImpl(const int64_t fsid,
         ::insertNameindex(this->featureSetNameIndex, &idIt->second);
     }
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -725,7 +983,7 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureSetImpl(const int64_t fsid,
     
     idIt->second.current = std::make_shared<FeatureSet2>(fsid, old->getProvider(), old->getType(), old->getName(), minResolution, maxResolution, old->getVersion() + 1);
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -747,7 +1005,7 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureSetImpl(const int64_t fsid,
         nameIt->second.erase(listIt);
         ::insertNameindex(this->featureSetNameIndex, &idIt->second);
     }
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -770,7 +1028,7 @@ Util::TAKErr RuntimeFeatureDataStore2::deleteFeatureSetImpl(const int64_t fsid)
     
     this->featureSetIdIndex.erase(idIt);
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -782,7 +1040,7 @@ Util::TAKErr RuntimeFeatureDataStore2::deleteAllFeatureSetsImpl() NOTHROWS {
     this->featureSetIdIndex.clear();
     this->featureSpatialIndex.clear();
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -857,14 +1115,14 @@ Util::TAKErr RuntimeFeatureDataStore2::insertFeatureImpl(FeaturePtr_const *inser
     
     setIdIt->second.features.push_back(featureIdIt->second.get());
     ::insertNameindex(this->featureNameIndex, featureIdIt->second);
-    this->featureSpatialIndex.add(&featureIdIt->second);
+    insertSpatialIndex(this->featureSpatialIndex, &featureIdIt->second);
     
+    this->setModifiedNoSync();
+
     if (inserted) {
         return this->getFeature(*inserted, fid);
     }
     
-    this->setContentChanged();
-    
     return Util::TE_Ok;
 }
 
@@ -876,13 +1134,13 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureImpl(const int64_t fid, cons
     }
     
     std::shared_ptr<FeatureRecord> old = featureIt->second;
-    featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, name, std::move(old->style), std::move(old->geom), old->altitudeMode, old->extrude,
-                                                        std::move(old->attrs), old->version + 1);
+    featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, name, old->style, old->geom, old->altitudeMode, old->extrude,
+                                                        old->attrs, old->version + 1);
     
     ::updateNameindex2(this->featureNameIndex, featureIt->second, old->getName());
     ::updateFeatureSetList(this->featureSetIdIndex, old.get(), featureIt->second.get());
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -897,14 +1155,14 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureImpl(const int64_t fid, cons
     this->featureSpatialIndex.remove(&featureIt->second);
     
     std::shared_ptr<FeatureRecord> old = featureIt->second;
-    featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, old->getName(), std::move(old->style),
+    featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, old->getName(), old->style,
                                                         std::shared_ptr<atakmap::feature::Geometry>(geom.clone()), old->altitudeMode,
-                                                        old->extrude, std::move(old->attrs), old->version + 1);
+                                                        old->extrude, old->attrs, old->version + 1);
     
-    this->featureSpatialIndex.add(&featureIt->second);
+    insertSpatialIndex(this->featureSpatialIndex, &featureIt->second);
     ::updateFeatureSetList(this->featureSetIdIndex, old.get(), featureIt->second.get());
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -919,13 +1177,13 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureImpl(const int64_t fid, cons
     this->featureSpatialIndex.remove(&featureIt->second);
 
     std::shared_ptr<FeatureRecord> old = featureIt->second;
-    featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, old->name, std::move(old->style), std::move(old->geom), altitudeMode, extrude,
-                                                        std::move(old->attrs), old->version + 1);
+    featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, old->name, old->style, old->geom, altitudeMode, extrude,
+                                                        old->attrs, old->version + 1);
 
-    this->featureSpatialIndex.add(&featureIt->second);
+    insertSpatialIndex(this->featureSpatialIndex, &featureIt->second);
     ::updateFeatureSetList(this->featureSetIdIndex, old.get(), featureIt->second.get());
 
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -940,11 +1198,11 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureImpl(const int64_t fid, cons
     std::shared_ptr<FeatureRecord> old = featureIt->second;
     featureIt->second = std::make_shared<FeatureRecord>(fid, old->setId, old->getName(),
                                                         std::shared_ptr<atakmap::feature::Style>(style ? style->clone() : nullptr),
-                                                        std::move(old->geom), old->altitudeMode, old->extrude, std::move(old->attrs), old->version + 1);
+                                                        old->geom, old->altitudeMode, old->extrude, old->attrs, old->version + 1);
     
     ::updateFeatureSetList(this->featureSetIdIndex, old.get(), featureIt->second.get());
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -958,12 +1216,12 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureImpl(const int64_t fid, cons
     
     std::shared_ptr<FeatureRecord> old = featureIt->second;
     featureIt->second = std::make_shared<FeatureRecord>(
-        fid, old->setId, old->getName(), std::move(old->style), std::move(old->geom), old->altitudeMode, old->extrude,
+        fid, old->setId, old->getName(), old->style, old->geom, old->altitudeMode, old->extrude,
         std::shared_ptr<atakmap::util::AttributeSet>(new atakmap::util::AttributeSet(attributes)), old->version + 1);
     
     ::updateFeatureSetList(this->featureSetIdIndex, old.get(), featureIt->second.get());
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
 
     return Util::TE_Ok;
 }
@@ -983,11 +1241,11 @@ Util::TAKErr RuntimeFeatureDataStore2::updateFeatureImpl(const int64_t fid, cons
         std::shared_ptr<atakmap::feature::Geometry>(geom.clone()), old->altitudeMode, old->extrude,
         std::shared_ptr<atakmap::util::AttributeSet>(new atakmap::util::AttributeSet(attributes)), old->version + 1);
     
-    this->featureSpatialIndex.add(&featureIt->second);
+    insertSpatialIndex(this->featureSpatialIndex, &featureIt->second);
     ::updateNameindex2(this->featureNameIndex, featureIt->second, old->getName());
     ::updateFeatureSetList(this->featureSetIdIndex, old.get(), featureIt->second.get());
 
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -1005,7 +1263,7 @@ Util::TAKErr RuntimeFeatureDataStore2::deleteFeatureImpl(const int64_t fid) NOTH
     ::removeNameindex(this->featureNameIndex, featureIt->second);
     this->featureIdIndex.erase(featureIt);
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Unsupported;
 }
@@ -1026,7 +1284,7 @@ Util::TAKErr RuntimeFeatureDataStore2::deleteAllFeaturesImpl(const int64_t fsid)
     
     idIt->second.features.clear();
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -1041,7 +1299,7 @@ Util::TAKErr RuntimeFeatureDataStore2::setFeatureVisibleImpl(const int64_t fid,
     featureIt->second->visible = visible;
     featureIt->second->visibleGeneration = this->visibleGeneration++;
     
-    this->setContentChanged();
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -1051,7 +1309,7 @@ Util::TAKErr RuntimeFeatureDataStore2::setFeaturesVisibleImpl(const FeatureQuery
     int64_t vg = this->visibleGeneration++;
     
     FeatureCursorPtr cursor(nullptr, nullptr);
-    Util::TAKErr code = this->queryFeatures(cursor, params);
+    Util::TAKErr code = this->queryFeaturesNoSync(cursor, params);
     TE_CHECKRETURN_CODE(code);
     
     while ((code = cursor->moveToNext()) == Util::TE_Ok) {
@@ -1062,6 +1320,7 @@ Util::TAKErr RuntimeFeatureDataStore2::setFeaturesVisibleImpl(const FeatureQuery
         featureIt->second->visibleGeneration = vg;
         featureIt->second->visible = visible;
     }
+    this->setModifiedNoSync();
     
     return code == Util::TE_Done ? Util::TE_Ok : code;
 }
@@ -1075,6 +1334,7 @@ Util::TAKErr RuntimeFeatureDataStore2::setFeatureSetVisibleImpl(const int64_t se
     
     featureSetIt->second.visibleGeneration = this->visibleGeneration++;
     featureSetIt->second.visible = visible;
+    this->setModifiedNoSync();
     
     return Util::TE_Ok;
 }
@@ -1095,6 +1355,7 @@ Util::TAKErr RuntimeFeatureDataStore2::setFeatureSetsVisibleImpl(const FeatureSe
         featureSetIt->second.visibleGeneration = vg;
         featureSetIt->second.visible = visible;
     }
+    this->setModifiedNoSync();
     
     return code == Util::TE_Done ? Util::TE_Ok : code;
 }
@@ -2,14 +2,18 @@
 #ifndef TAK_ENGINE_FEATURE_RUNTIMEFEATUREDATASTORE2_H_INCLUDED
 #define TAK_ENGINE_FEATURE_RUNTIMEFEATUREDATASTORE2_H_INCLUDED
 
+#include <atomic>
+#include <cctype>
 #include <unordered_map>
 #include <map>
 #include <list>
+#include <memory>
 
 #include "feature/AbstractFeatureDataStore2.h"
 #include "feature/FeatureDefinition2.h"
 
-#include "util/Quadtree.h"
+#include "thread/Mutex.h"
+#include "util/PackedRTree.h"
 
 namespace TAK {
     namespace Engine {
@@ -36,9 +40,52 @@ namespace TAK {
                         }
                     }
                 };
+                struct StringCaseInsensitiveWithNULL_EQ
+                {
+                    bool operator()(const char *a, const char *b) const
+                    {
+                        if (a && b) {
+#ifdef MSVC
+                            return _stricmp(a, b) == 0;
+#else
+                            return strcasecmp(a, b) == 0;
+#endif
+                        } else {
+                            return !a && !b;
+                        }
+                    }
+                };
+                struct StringCaseInsensitiveWithNULL_Hash
+                {
+                    std::size_t operator()(const char *s) const
+                    {
+                        if (!s)
+                            return 0u;
+                        // FNV-1a over the lower-case characters
+                        std::size_t hash = 2166136261u;
+                        for (; *s; s++) {
+                            hash ^= static_cast<std::size_t>(tolower(static_cast<unsigned char>(*s)));
+                            hash *= 16777619u;
+                        }
+                        return hash;
+                    }
+                };
             public:
                 RuntimeFeatureDataStore2() NOTHROWS;
                 RuntimeFeatureDataStore2(int modificationFlags, int visibilityFlags) NOTHROWS;
+                /**
+                 * @param snapshotReads If `true`, feature queries are
+                 *                      serviced from an immutable snapshot
+                 *                      of the store and do not contend
+                 *                      with writers. The snapshot is
+                 *                      rebuilt by the first query following
+                 *                      a modification; the writer lock is
+                 *                      only held while the records are
+                 *                      captured. Suited to stores that are
+                 *                      updated at a high rate while being
+                 *                      queried by multiple renderers.
+                 */
+                RuntimeFeatureDataStore2(int modificationFlags, int visibilityFlags, const bool snapshotReads) NOTHROWS;
                 virtual ~RuntimeFeatureDataStore2() NOTHROWS;
             public :
                 using AbstractFeatureDataStore2::insertFeature;
@@ -94,16 +141,26 @@ namespace TAK {
             private:
                 struct FeatureSetRecord;
                 struct FeatureRecord;
+                struct Snapshot;
                 
                 typedef std::unordered_map<int64_t, std::shared_ptr<FeatureRecord>> FeatureIdMap;
                 typedef std::unordered_map<int64_t, FeatureSetRecord> FeatureSetIdMap;
-                typedef std::map<Port::String, std::list<std::shared_ptr<FeatureRecord> *>, StringCaseInsensitiveWithNULL_LT> FeatureNameMap;
-                typedef std::map<Port::String, std::list<FeatureSetRecord *>, StringCaseInsensitiveWithNULL_LT> FeatureSetNameMap;
+                typedef std::unordered_map<Port::String, std::list<std::shared_ptr<FeatureRecord> *>, StringCaseInsensitiveWithNULL_Hash, StringCaseInsensitiveWithNULL_EQ> FeatureNameMap;
+                typedef std::unordered_map<Port::String, std::list<FeatureSetRecord *>, StringCaseInsensitiveWithNULL_Hash, StringCaseInsensitiveWithNULL_EQ> FeatureSetNameMap;
+                
+                typedef Util::PackedRTree<std::shared_ptr<FeatureRecord> *> FeatureSpatialIndex;
                 
-                static void featureSpatialIndexVisitor(std::shared_ptr<FeatureRecord> *record, void *opaque);
+                static void insertSpatialIndex(FeatureSpatialIndex &index, std::shared_ptr<FeatureRecord> *record) NOTHROWS;
+
+                Util::TAKErr queryFeaturesNoSync(FeatureCursorPtr &cursor, const FeatureQueryParameters &params) NOTHROWS;
+                /** marks the content changed and invalidates the snapshot */
+                void setModifiedNoSync() NOTHROWS;
+                /** returns a snapshot reflecting all modifications made prior to the call */
+                Util::TAKErr getSnapshot(std::shared_ptr<const Snapshot> &value) NOTHROWS;
+                static Util::TAKErr querySnapshot(FeatureCursorPtr &cursor, const Snapshot &snapshot, const FeatureQueryParameters &params) NOTHROWS;
                 
             private:
-                atakmap::util::Quadtree<std::shared_ptr<FeatureRecord>> featureSpatialIndex;
+                FeatureSpatialIndex featureSpatialIndex;
                 
                 FeatureIdMap featureIdIndex;
                 FeatureSetIdMap featureSetIdIndex;
@@ -116,6 +173,12 @@ namespace TAK {
                 int64_t visibleGeneration;
                 
                 bool inBulkModify;
+
+                const bool snapshotReads;
+                /** incremented on every modification; read without the writer lock */
+                std::atomic<int64_t> modificationCount;
+                Thread::Mutex snapshotMutex;
+                std::shared_ptr<const Snapshot> snapshot;
             };
             
             
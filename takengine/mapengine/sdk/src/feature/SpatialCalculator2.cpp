@@ -3,6 +3,8 @@
 #include <cstdio>
 #include <cinttypes>
 
+#include <geos_c.h>
+
 #ifdef MSVC
 #include "vscompat.h"
 #endif
@@ -20,6 +22,7 @@
 #include "math/Rectangle.h"
 #include "util/DataInput2.h"
 #include "util/DataOutput2.h"
+#include "util/Memory.h"
 
 using namespace TAK::Engine::Feature;
 using namespace TAK::Engine::DB;
@@ -51,9 +54,61 @@ namespace {
     };
 }
 
+struct SpatialCalculator2::GEOSMemory
+{
+public :
+    struct Entry
+    {
+        GEOSGeometry *geom {nullptr};
+        const GEOSPreparedGeometry *prepared {nullptr};
+    };
+public :
+    GEOSMemory() NOTHROWS;
+    ~GEOSMemory() NOTHROWS;
+public :
+    TAKErr get(const GEOSGeometry **value, const int64_t handle) NOTHROWS;
+    TAKErr getPrepared(const GEOSPreparedGeometry **value, const int64_t handle) NOTHROWS;
+    /** assumes ownership of `geom` */
+    TAKErr insert(int64_t *handle, GEOSGeometry *geom) NOTHROWS;
+    /** assumes ownership of `geom` */
+    TAKErr update(const int64_t handle, GEOSGeometry *geom) NOTHROWS;
+    TAKErr remove(const int64_t handle) NOTHROWS;
+    void clear() NOTHROWS;
+    void beginBatch() NOTHROWS;
+    void endBatch(const bool commit) NOTHROWS;
+
+    TAKErr read(GEOSGeometry **value, const Geometry2 &geom) NOTHROWS;
+    TAKErr readBlob(GEOSGeometry **value, const uint8_t *blob, const std::size_t len) NOTHROWS;
+    TAKErr write(Geometry2Ptr &value, const GEOSGeometry &geom) NOTHROWS;
+private :
+    /** releases the entry's geometry, retaining it in the journal if batched */
+    void release(const int64_t handle, Entry &entry) NOTHROWS;
+public :
+    GEOSContextHandle_t ctx;
+    GEOSWKBReader *wkbReader;
+    GEOSWKBWriter *wkbWriter;
+    GEOSWKTReader *wktReader;
+    GEOSWKTWriter *wktWriter;
+private :
+    std::map<int64_t, Entry> geoms;
+    int64_t nextHandle;
+    bool batch;
+    int64_t batchNextHandle;
+    /** state of each handle prior to the batch; `nullptr` if the handle was created */
+    std::map<int64_t, GEOSGeometry *> journal;
+};
 
 SpatialCalculator2::SpatialCalculator2(const char * path) :
+    SpatialCalculator2(path, SpatiaLiteStorage)
+{}
+
+SpatialCalculator2::SpatialCalculator2(const StorageMode mode) :
+    SpatialCalculator2(nullptr, mode)
+{}
+
+SpatialCalculator2::SpatialCalculator2(const char *path, const StorageMode mode) :
     database(nullptr, nullptr),
+    geos(nullptr, nullptr),
     insertGeomWkb(nullptr, nullptr),
     insertGeomWkt(nullptr, nullptr),
     insertGeomBlob(nullptr, nullptr),
@@ -79,6 +134,11 @@ SpatialCalculator2::SpatialCalculator2(const char * path) :
 {
     TAKErr code(TE_Ok);
 
+    if (mode == GEOSStorage) {
+        geos = std::unique_ptr<GEOSMemory, void(*)(const GEOSMemory *)>(new GEOSMemory(), Memory_deleter_const<GEOSMemory>);
+        return;
+    }
+
     if (!path)
         path = ":memory:";
 
@@ -161,6 +221,10 @@ void SpatialCalculator2::clearCache()
 
 void SpatialCalculator2::clear()
 {
+    if (geos.get()) {
+        geos->clear();
+        return;
+    }
     if (!this->clearMem)
         this->database->compileStatement(this->clearMem, "DELETE FROM Calculator");
     this->clearMem->execute();
@@ -168,11 +232,19 @@ void SpatialCalculator2::clear()
 
 void SpatialCalculator2::beginBatch()
 {
+    if (geos.get()) {
+        geos->beginBatch();
+        return;
+    }
     this->database->beginTransaction();
 }
 
 void SpatialCalculator2::endBatch(bool commit)
 {
+    if (geos.get()) {
+        geos->endBatch(commit);
+        return;
+    }
     if (commit)
         this->database->setTransactionSuccessful();
     this->database->endTransaction();
@@ -182,6 +254,13 @@ TAKErr SpatialCalculator2::createGeometry(int64_t *handle, const Geometry2 &geom
 {
     Util::TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        GEOSGeometry *value(nullptr);
+        code = geos->read(&value, geom);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(handle, value);
+    }
+
     Geometry2Ptr flattened(nullptr, nullptr);
     if (geom.getClass() == TEGC_GeometryCollection) {
         code = GeometryCollection_flatten(flattened, *(static_cast<const GeometryCollection2 *>(&geom)));
@@ -214,6 +293,9 @@ TAKErr SpatialCalculator2::createGeometryFromWkb(int64_t *handle, const uint8_t
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get())
+        return geos->insert(handle, GEOSWKBReader_read_r(geos->ctx, geos->wkbReader, wkb, len));
+
     if (!this->insertGeomWkb.get()) {
         code = this->database->compileStatement(this->insertGeomWkb, "INSERT INTO Calculator (geom) VALUES(GeomFromWKB(?, 4326))");
         TE_CHECKRETURN_CODE(code);
@@ -237,6 +319,9 @@ TAKErr SpatialCalculator2::createGeometryFromWkt(int64_t *handle, const char *wk
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get())
+        return geos->insert(handle, GEOSWKTReader_read_r(geos->ctx, geos->wktReader, wkt));
+
     if (!this->insertGeomWkt.get()) {
         code = this->database->compileStatement(this->insertGeomWkt, "INSERT INTO Calculator (geom) VALUES(GeomFromText(?, 4326))");
         TE_CHECKRETURN_CODE(code);
@@ -273,6 +358,9 @@ TAKErr SpatialCalculator2::deleteGeometry(const int64_t &handle)
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get())
+        return geos->remove(handle);
+
     if (!this->deleteGeom.get()) {
         code = this->database->compileStatement(this->deleteGeom, "DELETE FROM Calculator WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -293,6 +381,33 @@ TAKErr SpatialCalculator2::getGeometryType(GeometryClass *geom_type, const int64
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *geom(nullptr);
+        code = geos->get(&geom, handle);
+        TE_CHECKRETURN_CODE(code);
+        switch (GEOSGeomTypeId_r(geos->ctx, geom)) {
+        case GEOS_POINT :
+            *geom_type = TEGC_Point;
+            break;
+        case GEOS_LINESTRING :
+        case GEOS_LINEARRING :
+            *geom_type = TEGC_LineString;
+            break;
+        case GEOS_POLYGON :
+            *geom_type = TEGC_Polygon;
+            break;
+        case GEOS_MULTIPOINT :
+        case GEOS_MULTILINESTRING :
+        case GEOS_MULTIPOLYGON :
+        case GEOS_GEOMETRYCOLLECTION :
+            *geom_type = TEGC_GeometryCollection;
+            break;
+        default :
+            return Util::TE_BadIndex;
+        }
+        return code;
+    }
+
     QueryPtr query(nullptr, nullptr);
 
     code = this->database->compileQuery(query, "SELECT GeometryType((SELECT geom FROM Calculator WHERE id = ?))");
@@ -324,6 +439,25 @@ TAKErr SpatialCalculator2::getGeometryAsBlob(BlobPtr &blob, std::size_t *len, co
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        Geometry2Ptr geom(nullptr, nullptr);
+        code = this->getGeometry(geom, handle);
+        TE_CHECKRETURN_CODE(code);
+
+        Util::DynamicOutput sink;
+        sink.open(128); // arbitrary size
+        code = GeometryFactory_toSpatiaLiteBlob(sink, *geom, 4326);
+        TE_CHECKRETURN_CODE(code);
+
+        const uint8_t *buf(nullptr);
+        code = sink.get(&buf, len);
+        TE_CHECKRETURN_CODE(code);
+
+        blob = BlobPtr(new uint8_t[*len], Memory_array_deleter_const<uint8_t>);
+        memcpy(const_cast<uint8_t*>(blob.get()), buf, *len);
+        return code;
+    }
+
     QueryPtr query(nullptr, nullptr);
 
     code = this->database->compileQuery(query, "SELECT geom FROM Calculator WHERE id = ?");
@@ -354,6 +488,18 @@ TAKErr SpatialCalculator2::getGeometryAsWkt(TAK::Engine::Port::String *wkt, cons
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *geom(nullptr);
+        code = geos->get(&geom, handle);
+        TE_CHECKRETURN_CODE(code);
+        char *result = GEOSWKTWriter_write_r(geos->ctx, geos->wktWriter, geom);
+        if (!result)
+            return TE_Err;
+        *wkt = result;
+        GEOSFree_r(geos->ctx, result);
+        return code;
+    }
+
     QueryPtr query(nullptr, nullptr);
 
     code = this->database->compileQuery(query, "SELECT AsText(geom) FROM Calculator WHERE id = ?");
@@ -378,6 +524,13 @@ TAKErr SpatialCalculator2::getGeometry(Geometry2Ptr &geom, const int64_t &handle
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *value(nullptr);
+        code = geos->get(&value, handle);
+        TE_CHECKRETURN_CODE(code);
+        return geos->write(geom, *value);
+    }
+
     BlobPtr blob(nullptr, nullptr);
     std::size_t len(0);
 
@@ -404,6 +557,9 @@ TAKErr SpatialCalculator2::intersects(bool *intersected, const int64_t &geom1, c
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get())
+        return this->intersects(intersected, geom1, &geom2, 1u);
+
     QueryPtr query(nullptr, nullptr);
 
     code = this->database->compileQuery(query, "SELECT Intersects((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?))");
@@ -432,6 +588,9 @@ TAKErr SpatialCalculator2::contains(bool *contained, const int64_t &geom1, const
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get())
+        return this->contains(contained, geom1, &geom2, 1u);
+
     QueryPtr query(nullptr, nullptr);
 
     code = this->database->compileQuery(query, "SELECT Contains((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?))");
@@ -455,10 +614,88 @@ TAKErr SpatialCalculator2::contains(bool *contained, const int64_t &geom1, const
     return code;
 }
 
+TAKErr SpatialCalculator2::intersects(bool *intersected, const int64_t &geom, const int64_t *geoms, const std::size_t count)
+{
+    TAKErr code(TE_Ok);
+
+    if (!count)
+        return code;
+    if (!intersected || !geoms)
+        return TE_InvalidArg;
+
+    if (geos.get()) {
+        const GEOSPreparedGeometry *prepared(nullptr);
+        code = geos->getPrepared(&prepared, geom);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < count; i++) {
+            const GEOSGeometry *other(nullptr);
+            code = geos->get(&other, geoms[i]);
+            TE_CHECKBREAK_CODE(code);
+            const char result = GEOSPreparedIntersects_r(geos->ctx, prepared, other);
+            if (result == 2) {
+                code = TE_Err;
+                break;
+            }
+            intersected[i] = !!result;
+        }
+        return code;
+    }
+
+    for (std::size_t i = 0u; i < count; i++) {
+        code = this->intersects(intersected + i, geom, geoms[i]);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
+TAKErr SpatialCalculator2::contains(bool *contained, const int64_t &geom, const int64_t *geoms, const std::size_t count)
+{
+    TAKErr code(TE_Ok);
+
+    if (!count)
+        return code;
+    if (!contained || !geoms)
+        return TE_InvalidArg;
+
+    if (geos.get()) {
+        const GEOSPreparedGeometry *prepared(nullptr);
+        code = geos->getPrepared(&prepared, geom);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < count; i++) {
+            const GEOSGeometry *other(nullptr);
+            code = geos->get(&other, geoms[i]);
+            TE_CHECKBREAK_CODE(code);
+            const char result = GEOSPreparedContains_r(geos->ctx, prepared, other);
+            if (result == 2) {
+                code = TE_Err;
+                break;
+            }
+            contained[i] = !!result;
+        }
+        return code;
+    }
+
+    for (std::size_t i = 0u; i < count; i++) {
+        code = this->contains(contained + i, geom, geoms[i]);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
 TAKErr SpatialCalculator2::createIntersection(int64_t *handle, const int64_t& geom1, const int64_t& geom2)
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom1);
+        TE_CHECKRETURN_CODE(code);
+        const GEOSGeometry *b(nullptr);
+        code = geos->get(&b, geom2);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(handle, GEOSIntersection_r(geos->ctx, a, b));
+    }
+
     if (!this->intersectionInsert.get()) {
         code = this->database->compileStatement(this->intersectionInsert, "INSERT INTO Calculator (geom) SELECT Intersection((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?))");
         TE_CHECKRETURN_CODE(code);
@@ -485,6 +722,16 @@ TAKErr SpatialCalculator2::updateIntersection(const int64_t &geom1, const int64_
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom1);
+        TE_CHECKRETURN_CODE(code);
+        const GEOSGeometry *b(nullptr);
+        code = geos->get(&b, geom2);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(result, GEOSIntersection_r(geos->ctx, a, b));
+    }
+
     if (!this->intersectionUpdate.get()) {
         code = this->database->compileStatement(this->intersectionUpdate, "UPDATE Calculator SET geom = Intersection((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?)) WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -511,6 +758,16 @@ TAKErr SpatialCalculator2::createUnion(int64_t *result, const int64_t &geom1, co
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom1);
+        TE_CHECKRETURN_CODE(code);
+        const GEOSGeometry *b(nullptr);
+        code = geos->get(&b, geom2);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(result, GEOSUnion_r(geos->ctx, a, b));
+    }
+
     if (!this->unionInsert.get()) {
         code = this->database->compileStatement(this->unionInsert, "INSERT INTO Calculator (geom) SELECT GUnion(geom) FROM Calculator WHERE id IN (?, ?)");
         TE_CHECKRETURN_CODE(code);
@@ -534,6 +791,16 @@ TAKErr SpatialCalculator2::createUnion(int64_t *result, const int64_t &geom1, co
 TAKErr SpatialCalculator2::updateUnion(const int64_t &geom1, const int64_t &geom2, const int64_t &result)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom1);
+        TE_CHECKRETURN_CODE(code);
+        const GEOSGeometry *b(nullptr);
+        code = geos->get(&b, geom2);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(result, GEOSUnion_r(geos->ctx, a, b));
+    }
     if (!this->unionUpdate.get()) {
         code = this->database->compileStatement(this->unionUpdate, "UPDATE Calculator SET geom = GUnion((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?)) WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -556,6 +823,13 @@ TAKErr SpatialCalculator2::updateUnion(const int64_t &geom1, const int64_t &geom
 TAKErr SpatialCalculator2::createUnaryUnion(int64_t *result, const int64_t &geom)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(result, GEOSUnaryUnion_r(geos->ctx, a));
+    }
     if (!this->unaryUnionInsert.get()) {
         code = this->database->compileStatement(this->unaryUnionInsert, "INSERT INTO Calculator (geom) SELECT UnaryUnion(geom) FROM Calculator WHERE id  = ?");
         TE_CHECKRETURN_CODE(code);
@@ -576,6 +850,13 @@ TAKErr SpatialCalculator2::createUnaryUnion(int64_t *result, const int64_t &geom
 TAKErr SpatialCalculator2::updateUnaryUnion(const int64_t &geom, const int64_t &result)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(result, GEOSUnaryUnion_r(geos->ctx, a));
+    }
     if (!this->unaryUnionUpdate.get()) {
         code = this->database->compileStatement(this->unaryUnionUpdate, "UPDATE Calculator SET geom = UnaryUnion((SELECT geom FROM Calculator WHERE id = ?)) WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -596,6 +877,16 @@ TAKErr SpatialCalculator2::updateUnaryUnion(const int64_t &geom, const int64_t &
 TAKErr SpatialCalculator2::createDifference(int64_t *result, const int64_t &geom1, const int64_t &geom2)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom1);
+        TE_CHECKRETURN_CODE(code);
+        const GEOSGeometry *b(nullptr);
+        code = geos->get(&b, geom2);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(result, GEOSDifference_r(geos->ctx, a, b));
+    }
     if (!this->differenceInsert.get()) {
         code = this->database->compileStatement(this->differenceInsert, "INSERT INTO Calculator (geom) SELECT Difference((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?))");
         TE_CHECKRETURN_CODE(code);
@@ -619,6 +910,16 @@ TAKErr SpatialCalculator2::createDifference(int64_t *result, const int64_t &geom
 TAKErr SpatialCalculator2::updateDifference(const int64_t &geom1, const int64_t &geom2, const int64_t &result)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, geom1);
+        TE_CHECKRETURN_CODE(code);
+        const GEOSGeometry *b(nullptr);
+        code = geos->get(&b, geom2);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(result, GEOSDifference_r(geos->ctx, a, b));
+    }
     if (!this->differenceUpdate.get()) {
         code = this->database->compileStatement(this->differenceUpdate, "UPDATE Calculator SET geom = Difference((SELECT geom FROM Calculator WHERE id = ?), (SELECT geom FROM Calculator WHERE id = ?)) WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -640,6 +941,13 @@ TAKErr SpatialCalculator2::updateDifference(const int64_t &geom1, const int64_t
 TAKErr SpatialCalculator2::createSimplify(int64_t *result, const int64_t &handle, const double &tolerance, const bool &preserveTopology)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, handle);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(result, preserveTopology ? GEOSTopologyPreserveSimplify_r(geos->ctx, a, tolerance) : GEOSSimplify_r(geos->ctx, a, tolerance));
+    }
     Statement2 *stmt = nullptr;
 
     if (preserveTopology) {
@@ -675,6 +983,13 @@ TAKErr SpatialCalculator2::createSimplify(int64_t *result, const int64_t &handle
 TAKErr SpatialCalculator2::updateSimplify(const int64_t &handle, const double &tolerance, const bool &preserveTopology, const int64_t &result)
 {
     TAKErr code(TE_Ok);
+
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, handle);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(result, preserveTopology ? GEOSTopologyPreserveSimplify_r(geos->ctx, a, tolerance) : GEOSSimplify_r(geos->ctx, a, tolerance));
+    }
     Statement2 *stmt = nullptr;
 
     if (preserveTopology) {
@@ -743,6 +1058,13 @@ TAKErr SpatialCalculator2::createBuffer(int64_t *result, const int64_t &handle,
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, handle);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(result, GEOSBuffer_r(geos->ctx, a, dist, 8));
+    }
+
     if (!this->bufferInsert.get()) {
         code = this->database->compileStatement(this->bufferInsert, "INSERT INTO Calculator (geom) SELECT Buffer((SELECT geom FROM Calculator WHERE id = ?), ?)");
         TE_CHECKRETURN_CODE(code);
@@ -767,6 +1089,13 @@ TAKErr SpatialCalculator2::updateBuffer(const int64_t &handle, const double &dis
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        const GEOSGeometry *a(nullptr);
+        code = geos->get(&a, handle);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(result, GEOSBuffer_r(geos->ctx, a, dist, 8));
+    }
+
     if (!this->bufferUpdate.get()) {
         code = this->database->compileStatement(this->bufferUpdate, "UPDATE Calculator SET geom = Buffer((SELECT geom FROM Calculator WHERE id = ?), ?) WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -791,6 +1120,13 @@ TAKErr SpatialCalculator2::createGeometry(int64_t *handle, const uint8_t *blob,
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        GEOSGeometry *value(nullptr);
+        code = geos->readBlob(&value, blob, len);
+        TE_CHECKRETURN_CODE(code);
+        return geos->insert(handle, value);
+    }
+
     if (!this->insertGeomBlob.get()) {
         code = this->database->compileStatement(this->insertGeomBlob, "INSERT INTO Calculator (geom) VALUES(?)");
         TE_CHECKRETURN_CODE(code);
@@ -813,6 +1149,13 @@ TAKErr SpatialCalculator2::updateGeometry(const uint8_t *blob, const std::size_t
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        GEOSGeometry *value(nullptr);
+        code = geos->readBlob(&value, blob, len);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(handle, value);
+    }
+
     if (!this->updateGeomBlob.get()) {
         code = this->database->compileStatement(this->updateGeomBlob, "UPDATE Calculator SET geom = ? WHERE id = ?");
         TE_CHECKRETURN_CODE(code);
@@ -834,12 +1177,32 @@ TAKErr SpatialCalculator2::updateGeometry(const Geometry2 &geom, const int64_t &
 {
     TAKErr code(TE_Ok);
 
-    BlobPtr blob(nullptr, nullptr);
-    std::size_t len(0);
-    code = this->getGeometryAsBlob(blob, &len, handle);
+    if (geos.get()) {
+        GEOSGeometry *value(nullptr);
+        code = geos->read(&value, geom);
+        TE_CHECKRETURN_CODE(code);
+        return geos->update(handle, value);
+    }
+
+    Geometry2Ptr flattened(nullptr, nullptr);
+    if (geom.getClass() == TEGC_GeometryCollection) {
+        code = GeometryCollection_flatten(flattened, *(static_cast<const GeometryCollection2 *>(&geom)));
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    const Geometry2 &resolved = flattened ? *flattened : geom;
+
+    Util::DynamicOutput sink;
+    sink.open(128); // arbitrary size
+    code = GeometryFactory_toSpatiaLiteBlob(sink, resolved, 4326);
     TE_CHECKRETURN_CODE(code);
 
-    code = this->updateGeometry(blob.get(), len, handle);
+    const uint8_t *blob(nullptr);
+    std::size_t len(0u);
+    code = sink.get(&blob, &len);
+    TE_CHECKRETURN_CODE(code);
+
+    code = this->updateGeometry(blob, len, handle);
     TE_CHECKRETURN_CODE(code);
 
     return code;
@@ -849,6 +1212,11 @@ TAKErr SpatialCalculator2::getGEOSVersion(TAK::Engine::Port::String *version)
 {
     TAKErr code(TE_Ok);
 
+    if (geos.get()) {
+        *version = GEOSversion();
+        return code;
+    }
+
     QueryPtr query(nullptr, nullptr);
 
     code = this->database->compileQuery(query, "SELECT geos_version()");
@@ -869,6 +1237,190 @@ TAKErr SpatialCalculator2::getGEOSVersion(TAK::Engine::Port::String *version)
     return code;
 }
 
+SpatialCalculator2::GEOSMemory::GEOSMemory() NOTHROWS :
+    ctx(GEOS_init_r()),
+    wkbReader(nullptr),
+    wkbWriter(nullptr),
+    wktReader(nullptr),
+    wktWriter(nullptr),
+    nextHandle(1LL),
+    batch(false),
+    batchNextHandle(1LL)
+{
+    if (ctx) {
+        wkbReader = GEOSWKBReader_create_r(ctx);
+        wkbWriter = GEOSWKBWriter_create_r(ctx);
+        wktReader = GEOSWKTReader_create_r(ctx);
+        wktWriter = GEOSWKTWriter_create_r(ctx);
+        if (wktWriter)
+            GEOSWKTWriter_setTrim_r(ctx, wktWriter, 1);
+    }
+}
+SpatialCalculator2::GEOSMemory::~GEOSMemory() NOTHROWS
+{
+    if (!ctx)
+        return;
+    if (batch)
+        endBatch(true);
+    clear();
+    if (wkbReader)
+        GEOSWKBReader_destroy_r(ctx, wkbReader);
+    if (wkbWriter)
+        GEOSWKBWriter_destroy_r(ctx, wkbWriter);
+    if (wktReader)
+        GEOSWKTReader_destroy_r(ctx, wktReader);
+    if (wktWriter)
+        GEOSWKTWriter_destroy_r(ctx, wktWriter);
+    GEOS_finish_r(ctx);
+}
+TAKErr SpatialCalculator2::GEOSMemory::get(const GEOSGeometry **value, const int64_t handle) NOTHROWS
+{
+    auto entry = geoms.find(handle);
+    if (entry == geoms.end())
+        return TE_InvalidArg;
+    *value = entry->second.geom;
+    return TE_Ok;
+}
+TAKErr SpatialCalculator2::GEOSMemory::getPrepared(const GEOSPreparedGeometry **value, const int64_t handle) NOTHROWS
+{
+    auto entry = geoms.find(handle);
+    if (entry == geoms.end())
+        return TE_InvalidArg;
+    // prepared on first use as the subject of a predicate
+    if (!entry->second.prepared) {
+        entry->second.prepared = GEOSPrepare_r(ctx, entry->second.geom);
+        if (!entry->second.prepared)
+            return TE_Err;
+    }
+    *value = entry->second.prepared;
+    return TE_Ok;
+}
+TAKErr SpatialCalculator2::GEOSMemory::insert(int64_t *handle, GEOSGeometry *geom) NOTHROWS
+{
+    if (!geom)
+        return TE_Err;
+    Entry entry;
+    entry.geom = geom;
+    *handle = nextHandle++;
+    geoms[*handle] = entry;
+    if (batch && journal.find(*handle) == journal.end())
+        journal[*handle] = nullptr;
+    return TE_Ok;
+}
+TAKErr SpatialCalculator2::GEOSMemory::update(const int64_t handle, GEOSGeometry *geom) NOTHROWS
+{
+    if (!geom)
+        return TE_Err;
+    auto entry = geoms.find(handle);
+    if (entry == geoms.end()) {
+        GEOSGeom_destroy_r(ctx, geom);
+        return TE_InvalidArg;
+    }
+    release(handle, entry->second);
+    entry->second.geom = geom;
+    return TE_Ok;
+}
+TAKErr SpatialCalculator2::GEOSMemory::remove(const int64_t handle) NOTHROWS
+{
+    auto entry = geoms.find(handle);
+    if (entry == geoms.end())
+        return TE_Ok;
+    release(handle, entry->second);
+    geoms.erase(entry);
+    return TE_Ok;
+}
+void SpatialCalculator2::GEOSMemory::clear() NOTHROWS
+{
+    for (auto entry = geoms.begin(); entry != geoms.end(); entry++)
+        release(entry->first, entry->second);
+    geoms.clear();
+}
+void SpatialCalculator2::GEOSMemory::beginBatch() NOTHROWS
+{
+    batch = true;
+    batchNextHandle = nextHandle;
+}
+void SpatialCalculator2::GEOSMemory::endBatch(const bool commit) NOTHROWS
+{
+    batch = false;
+    if (commit) {
+        for (auto it = journal.begin(); it != journal.end(); it++) {
+            if (it->second)
+                GEOSGeom_destroy_r(ctx, it->second);
+        }
+    } else {
+        // restore the state of each handle touched during the batch
+        for (auto it = journal.begin(); it != journal.end(); it++) {
+            auto entry = geoms.find(it->first);
+            if (entry != geoms.end()) {
+                release(entry->first, entry->second);
+                geoms.erase(entry);
+            }
+            if (it->second) {
+                Entry restored;
+                restored.geom = it->second;
+                geoms[it->first] = restored;
+            }
+        }
+        nextHandle = batchNextHandle;
+    }
+    journal.clear();
+}
+TAKErr SpatialCalculator2::GEOSMemory::read(GEOSGeometry **value, const Geometry2 &geom) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    Geometry2Ptr flattened(nullptr, nullptr);
+    if (geom.getClass() == TEGC_GeometryCollection) {
+        code = GeometryCollection_flatten(flattened, *(static_cast<const GeometryCollection2 *>(&geom)));
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    const Geometry2 &resolved = flattened ? *flattened : geom;
+
+    Util::DynamicOutput sink;
+    sink.open(128); // arbitrary size
+    code = GeometryFactory_toWkb(sink, resolved);
+    TE_CHECKRETURN_CODE(code);
+
+    const uint8_t *wkb(nullptr);
+    std::size_t len(0u);
+    code = sink.get(&wkb, &len);
+    TE_CHECKRETURN_CODE(code);
+
+    *value = GEOSWKBReader_read_r(ctx, wkbReader, wkb, len);
+    return *value ? TE_Ok : TE_InvalidArg;
+}
+TAKErr SpatialCalculator2::GEOSMemory::readBlob(GEOSGeometry **value, const uint8_t *blob, const std::size_t len) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    Geometry2Ptr geom(nullptr, nullptr);
+    code = GeometryFactory_fromSpatiaLiteBlob(geom, blob, len);
+    TE_CHECKRETURN_CODE(code);
+    return read(value, *geom);
+}
+TAKErr SpatialCalculator2::GEOSMemory::write(Geometry2Ptr &value, const GEOSGeometry &geom) NOTHROWS
+{
+    std::size_t len(0u);
+    unsigned char *wkb = GEOSWKBWriter_write_r(ctx, wkbWriter, &geom, &len);
+    if (!wkb)
+        return TE_Err;
+    const TAKErr code = GeometryFactory_fromWkb(value, wkb, len);
+    GEOSFree_r(ctx, wkb);
+    return code;
+}
+void SpatialCalculator2::GEOSMemory::release(const int64_t handle, Entry &entry) NOTHROWS
+{
+    if (entry.prepared)
+        GEOSPreparedGeom_destroy_r(ctx, entry.prepared);
+    entry.prepared = nullptr;
+    if (batch && journal.find(handle) == journal.end())
+        journal[handle] = entry.geom;
+    else
+        GEOSGeom_destroy_r(ctx, entry.geom);
+    entry.geom = nullptr;
+}
+
 SpatialCalculator2::Batch::Batch(SpatialCalculator2 &calc_) :
     calc(calc_),
     success(false)
@@ -60,6 +60,18 @@ namespace TAK {
              * batch mode, instructions may only be issued to the calculator on the thread
              * that the batch was started in.
              *
+             * <H2>Storage</H2>
+             *
+             * <P>By default, the calculator's memory is a SpatiaLite database and
+             * every instruction is a SQL statement. A calculator constructed with
+             * {@link #GEOSStorage} instead keeps its geometries in process as GEOS
+             * geometries, avoiding the statement and blob serialization overhead.
+             * Geometries in GEOS storage are prepared on first use as the subject of a
+             * predicate, so repeated predicates against the same geometry (e.g.
+             * geofences) only pay for the preparation once. The WKT produced by
+             * {@link #getGeometryAsWkt(Port::String *, const int64_t &)} is formatted
+             * by GEOS rather than SpatiaLite.
+             *
              * @author Developer
              */
             class ENGINE_API SpatialCalculator2
@@ -68,6 +80,15 @@ namespace TAK {
             class ENGINE_API Batch;
             public :
             typedef std::unique_ptr<const uint8_t, void(*)(const uint8_t *)> BlobPtr;
+            enum StorageMode
+            {
+                /** geometries reside in a SpatiaLite database */
+                SpatiaLiteStorage,
+                /** geometries reside in process memory as GEOS geometries */
+                GEOSStorage,
+            };
+            private :
+            struct GEOSMemory;
             public:
             /**
              * Creates a new instance. If path is non-NULL, the calculator will
@@ -75,6 +96,11 @@ namespace TAK {
              * the calculator will be stored in memory.
              */
             SpatialCalculator2(const char *path = nullptr);
+            /**
+             * Creates a new instance with the specified storage. The
+             * SpatiaLite storage is always in memory.
+             */
+            SpatialCalculator2(const StorageMode mode);
             public:
             ~SpatialCalculator2();
             public:
@@ -215,6 +241,38 @@ namespace TAK {
              */
             Util::TAKErr contains(bool *contained, const int64_t &geom1, const int64_t &geom2);
 
+            /**
+             * Tests a geometry for intersection with each of a set of geometries.
+             * With GEOS storage, the geometry is prepared once for all tests.
+             *
+             * @param intersected   Returns <code>true</code> for each geometry in
+             *                      <code>geoms</code> that intersects
+             *                      <code>geom</code>; must hold <code>count</code>
+             *                      elements
+             * @param geom          A handle to the geometry in the calculator's memory
+             * @param geoms         Handles to the geometries in the calculator's memory
+             * @param count         The number of handles in <code>geoms</code>
+             *
+             * @return TE_Ok on success, other on error.
+             */
+            Util::TAKErr intersects(bool *intersected, const int64_t &geom, const int64_t *geoms, const std::size_t count);
+
+            /**
+             * Tests a geometry for containment of each of a set of geometries.
+             * With GEOS storage, the geometry is prepared once for all tests.
+             *
+             * @param contained     Returns <code>true</code> for each geometry in
+             *                      <code>geoms</code> that is contained by
+             *                      <code>geom</code>; must hold <code>count</code>
+             *                      elements
+             * @param geom          A handle to the geometry in the calculator's memory
+             * @param geoms         Handles to the geometries in the calculator's memory
+             * @param count         The number of handles in <code>geoms</code>
+             *
+             * @return TE_Ok on success, other on error.
+             */
+            Util::TAKErr contains(bool *contained, const int64_t &geom, const int64_t *geoms, const std::size_t count);
+
             /**
              * Returns the intersection of the specified geometries as a new geometry in
              * the calculator's memory.
@@ -433,9 +491,12 @@ namespace TAK {
             Util::TAKErr getGEOSVersion(TAK::Engine::Port::String *version);
 
             private:
+            SpatialCalculator2(const char *path, const StorageMode mode);
             Util::TAKErr createGeometry(int64_t *handle, const uint8_t *blob, const std::size_t &len);
             private:
             DB::DatabasePtr database;
+            /** non-NULL for GEOS storage */
+            std::unique_ptr<GEOSMemory, void(*)(const GEOSMemory *)> geos;
 
             DB::StatementPtr insertGeomWkb;
             DB::StatementPtr insertGeomWkt;
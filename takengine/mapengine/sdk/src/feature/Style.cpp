@@ -6,10 +6,13 @@
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <sstream>
 
 #include "feature/DrawingTool.h"
 #include "math/Utils.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
 #include "util/Memory.h"
 #include "util/MathUtils.h"
 
@@ -73,6 +76,21 @@ namespace
 
 namespace
 {
+    // maximum number of distinct style strings retained by `Style_parseStyleShared`
+    const std::size_t MAX_SHARED_STYLES = 4096u;
+
+    typedef std::map<std::string, atakmap::feature::StylePtr_Const, std::less<>> SharedStyleMap;
+
+    Thread::Mutex &sharedStylesMutex() NOTHROWS
+    {
+        static Thread::Mutex m;
+        return m;
+    }
+    SharedStyleMap &sharedStyles() NOTHROWS
+    {
+        static SharedStyleMap styles;
+        return styles;
+    }
 
     bool isNULL (const void* ptr)
     { return !ptr; }
@@ -921,6 +939,59 @@ TAKErr atakmap::feature::Style_parseStyle(StylePtr &value, const char *ogr) NOTH
         return TE_Err;
     }
 }
+TAKErr atakmap::feature::Style_parseStyleShared(StylePtr_Const &value, const char *ogr) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!ogr)
+        return TE_InvalidArg;
+
+    SharedStyleMap &styles = sharedStyles();
+    {
+        Thread::Lock lock(sharedStylesMutex());
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+
+        auto entry = styles.find(ogr);
+        if (entry != styles.end()) {
+            value = StylePtr_Const(entry->second.get(), Memory_leaker_const<Style>);
+            return TE_Ok;
+        }
+    }
+
+    // parse outside of the lock; a concurrent parse of the same string
+    // yields to whichever instance is cached first
+    StylePtr_Const parsed(nullptr, nullptr);
+    try {
+        parsed = StylePtr_Const(Style::parseStyle(ogr), Style::destructStyle);
+    } catch(const std::invalid_argument &) {
+        return TE_InvalidArg;
+    } catch(const std::bad_alloc &) {
+        return TE_OutOfMemory;
+    } catch(...) {
+        return TE_Err;
+    }
+    if (!parsed) {
+        value = StylePtr_Const(nullptr, Style::destructStyle);
+        return TE_Ok;
+    }
+
+    Thread::Lock lock(sharedStylesMutex());
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    if (styles.size() >= MAX_SHARED_STYLES) {
+        value = std::move(parsed);
+        return TE_Ok;
+    }
+    try {
+        auto entry = styles.insert(std::make_pair(std::string(ogr), StylePtr_Const(nullptr, Style::destructStyle))).first;
+        if (!entry->second)
+            entry->second = std::move(parsed);
+        value = StylePtr_Const(entry->second.get(), Memory_leaker_const<Style>);
+    } catch(...) {
+        value = std::move(parsed);
+    }
+    return code;
+}
 TAKErr atakmap::feature::BasicFillStyle_create(StylePtr &value, const unsigned int color) NOTHROWS
 {
     try {
@@ -578,6 +578,21 @@ namespace atakmap                       // Open atakmap namespace.
         };
 
         ENGINE_API TAK::Engine::Util::TAKErr Style_parseStyle(StylePtr &value, const char *ogr) NOTHROWS;
+        /**
+         * Parses the OGR style string, returning an instance shared with all
+         * other callers that parse the same string. Shared instances are
+         * retained for the life of the process and must not be modified;
+         * `value` does not own them. Once the maximum number of distinct
+         * strings has been cached, a newly parsed instance owned by `value`
+         * is returned instead.
+         *
+         * <P>This function is thread-safe.
+         *
+         * @return  TE_Ok on success, `value` being `nullptr` if the string
+         *          specifies no style; TE_InvalidArg if the string is
+         *          malformed
+         */
+        ENGINE_API TAK::Engine::Util::TAKErr Style_parseStyleShared(StylePtr_Const &value, const char *ogr) NOTHROWS;
 
         ENGINE_API TAK::Engine::Util::TAKErr BasicFillStyle_create(StylePtr &value, const unsigned int color) NOTHROWS;
         ENGINE_API TAK::Engine::Util::TAKErr BasicPointStyle_create(StylePtr &value, const unsigned int color, const float size) NOTHROWS;
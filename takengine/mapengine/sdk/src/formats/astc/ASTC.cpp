@@ -0,0 +1,202 @@
+#include "formats/astc/ASTC.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "util/DataOutput2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Formats::ASTC;
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+#define ASTC_BLOCK_SIZE 16u
+
+// 4x4 weight grid (A=2, B=0), single plane; the weight range is encoded by
+// R0 (bit 4) and R2:R1 (bits 1:0)
+// 8 weight levels (3 bits); R=111b
+#define ASTC_BLOCK_MODE_4x4_W8 0x53u
+// 4 weight levels (2 bits); R=100b
+#define ASTC_BLOCK_MODE_4x4_W4 0x42u
+
+// color endpoint modes
+#define ASTC_CEM_LDR_RGB_DIRECT 8u
+#define ASTC_CEM_LDR_RGBA_DIRECT 12u
+
+namespace
+{
+    TAKErr extractBlock(uint8_t *value, const Bitmap2 &bitmap, const std::size_t blockX, const std::size_t blockY) NOTHROWS;
+    void compressBlock(uint8_t *value, const uint8_t *block) NOTHROWS;
+    void setBits(uint8_t *value, const std::size_t offset, const std::size_t count, const unsigned bits) NOTHROWS;
+
+    // unquantized weights, by number of weight levels
+    const int weights4[4] = { 0, 21, 43, 64 };
+    const int weights8[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+}
+
+TAKErr TAK::Engine::Formats::ASTC::ASTC_compress(DataOutput2 &value, std::size_t *compressedSize, const Bitmap2 &bitmap) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (compressedSize) {
+        code = ASTC_getCompressedSize(compressedSize, bitmap.getWidth(), bitmap.getHeight());
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    const std::size_t numBlocksX = (bitmap.getWidth() + 3u) / 4u;
+    const std::size_t numBlocksY = (bitmap.getHeight() + 3u) / 4u;
+
+    uint8_t block[64];
+    uint8_t block_compressed[ASTC_BLOCK_SIZE];
+    for (std::size_t blockY = 0u; blockY < numBlocksY; blockY++) {
+        for (std::size_t blockX = 0u; blockX < numBlocksX; blockX++) {
+            code = extractBlock(block, bitmap, blockX, blockY);
+            TE_CHECKBREAK_CODE(code);
+            compressBlock(block_compressed, block);
+            code = value.write(block_compressed, ASTC_BLOCK_SIZE);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKBREAK_CODE(code);
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    return code;
+}
+std::size_t TAK::Engine::Formats::ASTC::ASTC_getCompressedSize(const Bitmap2 &bitmap) NOTHROWS
+{
+    std::size_t compressedSize;
+    ASTC_getCompressedSize(&compressedSize, bitmap.getWidth(), bitmap.getHeight());
+    return compressedSize;
+}
+TAKErr TAK::Engine::Formats::ASTC::ASTC_getCompressedSize(std::size_t *value, const std::size_t width, const std::size_t height) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    const std::size_t numBlocksX = (width+3u) / 4u;
+    const std::size_t numBlocksY = (height+3u) / 4u;
+    *value = (numBlocksX*numBlocksY*ASTC_BLOCK_SIZE);
+    return TE_Ok;
+}
+
+namespace
+{
+    TAKErr extractBlock(uint8_t *value, const Bitmap2 &bitmap, const std::size_t blockX, const std::size_t blockY) NOTHROWS
+    {
+        const std::size_t srcX = blockX * 4u;
+        const std::size_t srcY = blockY * 4u;
+        const std::size_t srcW = std::min(bitmap.getWidth()-srcX, (std::size_t)4u);
+        const std::size_t srcH = std::min(bitmap.getHeight()-srcY, (std::size_t)4u);
+
+        memset(value, 0xFFu, 64u);
+        Bitmap2 block(std::move(Bitmap2::DataPtr(value, Memory_leaker_const<uint8_t>)), 4u, 4u, Bitmap2::RGBA32);
+        return block.setRegion(bitmap, 0u, 0u, srcX, srcY, srcW, srcH);
+    }
+
+    void compressBlock(uint8_t *value, const uint8_t *block) NOTHROWS
+    {
+        bool opaque = true;
+        for (std::size_t i = 0u; i < 16u; i++)
+            opaque &= (block[i * 4u + 3u] == 0xFFu);
+        const std::size_t numChannels = opaque ? 3u : 4u;
+
+        // endpoints lie on the principal axis through the mean of the block
+        double mean[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for (std::size_t i = 0u; i < 16u; i++)
+            for (std::size_t c = 0u; c < numChannels; c++)
+                mean[c] += block[i * 4u + c] / 16.0;
+        double cov[4][4];
+        memset(cov, 0, sizeof(cov));
+        for (std::size_t i = 0u; i < 16u; i++) {
+            for (std::size_t r = 0u; r < numChannels; r++)
+                for (std::size_t c = 0u; c < numChannels; c++)
+                    cov[r][c] += (block[i * 4u + r] - mean[r]) * (block[i * 4u + c] - mean[c]);
+        }
+        // power iteration, seeded with the channel of greatest variance
+        double axis[4] = { 0.0, 0.0, 0.0, 0.0 };
+        std::size_t seed = 0u;
+        for (std::size_t c = 1u; c < numChannels; c++)
+            if (cov[c][c] > cov[seed][seed])
+                seed = c;
+        axis[seed] = 1.0;
+        for (std::size_t iter = 0u; iter < 8u; iter++) {
+            double next[4] = { 0.0, 0.0, 0.0, 0.0 };
+            double len = 0.0;
+            for (std::size_t r = 0u; r < numChannels; r++) {
+                for (std::size_t c = 0u; c < numChannels; c++)
+                    next[r] += cov[r][c] * axis[c];
+                len += next[r] * next[r];
+            }
+            len = sqrt(len);
+            if (len < 1e-9)
+                break;
+            for (std::size_t c = 0u; c < numChannels; c++)
+                axis[c] = next[c] / len;
+        }
+        double tmin = 0.0;
+        double tmax = 0.0;
+        for (std::size_t i = 0u; i < 16u; i++) {
+            double t = 0.0;
+            for (std::size_t c = 0u; c < numChannels; c++)
+                t += (block[i * 4u + c] - mean[c]) * axis[c];
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+
+        int e0[4] = { 255, 255, 255, 255 };
+        int e1[4] = { 255, 255, 255, 255 };
+        for (std::size_t c = 0u; c < numChannels; c++) {
+            e0[c] = std::min(std::max((int)floor(mean[c] + axis[c] * tmin + 0.5), 0), 255);
+            e1[c] = std::min(std::max((int)floor(mean[c] + axis[c] * tmax + 0.5), 0), 255);
+        }
+        // the decoder applies blue-contraction when the second endpoint is
+        // darker than the first
+        if ((e1[0] + e1[1] + e1[2]) < (e0[0] + e0[1] + e0[2]))
+            std::swap(e0, e1);
+
+        const std::size_t numLevels = opaque ? 8u : 4u;
+        const int *levels = opaque ? weights8 : weights4;
+        unsigned weights[16];
+        for (std::size_t i = 0u; i < 16u; i++) {
+            unsigned bestErr = ~0u;
+            for (std::size_t j = 0u; j < numLevels; j++) {
+                unsigned err = 0u;
+                for (std::size_t c = 0u; c < numChannels; c++) {
+                    // LDR interpolation is carried out at 16 bits
+                    const int v = (((e0[c] * 257) * (64 - levels[j]) + (e1[c] * 257) * levels[j] + 32) >> 6) >> 8;
+                    const int d = v - block[i * 4u + c];
+                    err += (unsigned)(d * d);
+                }
+                if (err < bestErr) {
+                    bestErr = err;
+                    weights[i] = (unsigned)j;
+                }
+            }
+        }
+
+        memset(value, 0u, ASTC_BLOCK_SIZE);
+        // block mode, single partition, endpoint mode
+        setBits(value, 0u, 11u, opaque ? ASTC_BLOCK_MODE_4x4_W8 : ASTC_BLOCK_MODE_4x4_W4);
+        setBits(value, 13u, 4u, opaque ? ASTC_CEM_LDR_RGB_DIRECT : ASTC_CEM_LDR_RGBA_DIRECT);
+        // the remaining bits afford 256 endpoint levels, encoded as plain
+        // bytes: r0 r1 g0 g1 b0 b1 [a0 a1]
+        for (std::size_t c = 0u; c < numChannels; c++) {
+            setBits(value, 17u + c * 16u, 8u, (unsigned)e0[c]);
+            setBits(value, 25u + c * 16u, 8u, (unsigned)e1[c]);
+        }
+        // weights are stored bit-reversed from the end of the block
+        const std::size_t weightBits = opaque ? 3u : 2u;
+        for (std::size_t i = 0u; i < 16u; i++) {
+            for (std::size_t b = 0u; b < weightBits; b++)
+                setBits(value, 127u - (i * weightBits + b), 1u, (weights[i] >> b) & 0x1u);
+        }
+    }
+
+    void setBits(uint8_t *value, const std::size_t offset, const std::size_t count, const unsigned bits) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < count; i++) {
+            if ((bits >> i) & 0x1u)
+                value[(offset + i) / 8u] |= (uint8_t)(1u << ((offset + i) % 8u));
+        }
+    }
+}
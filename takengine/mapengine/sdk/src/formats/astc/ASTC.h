@@ -0,0 +1,28 @@
+#ifndef TAK_ENGINE_FORMATS_ASTC_ASTC_H_INCLUDED
+#define TAK_ENGINE_FORMATS_ASTC_ASTC_H_INCLUDED
+
+#include "port/Platform.h"
+#include "renderer/Bitmap2.h"
+#include "util/Error.h"
+#include "util/IO2.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Formats {
+            namespace ASTC {
+                /**
+                 * Compresses the bitmap as LDR ASTC with a 4x4 block
+                 * footprint (8bpp). Each block is encoded as a single
+                 * partition, single plane; opaque blocks use RGB endpoints
+                 * with 8 weight levels, translucent blocks RGBA endpoints
+                 * with 4 weight levels.
+                 */
+                ENGINE_API Util::TAKErr ASTC_compress(Util::DataOutput2 &value, std::size_t *compressedSize, const Renderer::Bitmap2 &bitmap) NOTHROWS;
+                ENGINE_API std::size_t ASTC_getCompressedSize(const Renderer::Bitmap2 &bitmap) NOTHROWS;
+                ENGINE_API Util::TAKErr ASTC_getCompressedSize(std::size_t *value, const std::size_t width, const std::size_t height) NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
@@ -39,6 +39,8 @@ namespace {
         TAKErr safe() NOTHROWS;
         TAKErr rewind(size_t count) NOTHROWS;
         size_t numRecorded() const NOTHROWS;
+        /** returns the number of recorded bytes not yet re-read */
+        size_t numBuffered() const NOTHROWS;
         TAKErr enableRewind(bool enabled) NOTHROWS;
 
     private:
@@ -213,7 +215,10 @@ TAKErr parseImpl(ParseData *impl, bool fullParse, DataInput2* innerInput, const
     }
 
     if (fullParse) {
-        code = GLTF_load(impl->glTFScene, &rewindInput, baseURI);
+        // if the header has been fully consumed, the source is positioned
+        // at the glTF content; hand it off directly so that memory backed
+        // inputs are parsed in place
+        code = GLTF_load(impl->glTFScene, rewindInput.numBuffered() ? &rewindInput : innerInput, baseURI);
         if (code != TE_Ok)
             return code;
 
@@ -362,6 +367,10 @@ namespace {
         return pos;
     }
 
+    size_t RewindDataInput2::numBuffered() const NOTHROWS {
+        return rbuf.size() - pos;
+    }
+
     TAKErr RewindDataInput2::enableRewind(bool enabled) NOTHROWS {
         this->record = enabled;
         return TE_Ok;
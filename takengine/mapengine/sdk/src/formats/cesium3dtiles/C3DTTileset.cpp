@@ -14,6 +14,7 @@
 #include "math/Ellipsoid2.h"
 #include "model/MeshTransformer.h"
 #include "feature/Envelope2.h"
+#include "util/Logging2.h"
 
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Port;
@@ -30,18 +31,41 @@ using namespace TAK::Engine::Feature;
 using json = nlohmann::json;
 
 namespace {
-    // Adapt to DataInput2 to std::streambuf
-    class DataInput2Streambuf : public std::streambuf {
-    public:
-        DataInput2Streambuf(TAK::Engine::Util::DataInput2* input);
+    /** A span of raw JSON text */
+    struct JsonSpan {
+        const char *begin;
+        const char *end;
+    };
+
+    struct TilesetHeader;
+    struct ImplicitTiling;
+    struct ImplicitSubtree;
 
-        int_type underflow() override;
+    struct ImplicitCoord {
+        std::size_t level;
+        uint32_t x;
+        uint32_t y;
+        uint32_t z;
+    };
 
-    private:
-        TAK::Engine::Util::DataInput2* input;
-        char curr;
+    struct ParseContext {
+        std::shared_ptr<const TilesetHeader> header;
+        std::shared_ptr<const std::vector<char>> source;
+        std::size_t maxDepth;
+        void *opaque;
+        C3DTTilesetVisitor visitor;
     };
 
+    TAKErr readAll(std::vector<char> &result, DataInput2 &input) NOTHROWS;
+
+    const char *skipWhitespace(const char *p, const char *end) NOTHROWS;
+    const char *skipString(const char *p, const char *end) NOTHROWS;
+    const char *skipValue(const char *p, const char *end) NOTHROWS;
+    template<class Fn>
+    TAKErr forEachMember(const JsonSpan &obj, Fn fn) NOTHROWS;
+    template<class Fn>
+    TAKErr forEachElement(const JsonSpan &arr, Fn fn) NOTHROWS;
+
     double parseDouble(const json& obj, const char* name, double def) NOTHROWS;
 
     std::string parseString(const json& obj, const char* name, const char* def);
@@ -50,7 +74,15 @@ namespace {
 
     TAKErr parseContent(C3DTContent* result, const json& obj) NOTHROWS;
 
-    TAKErr parseTile(const C3DTTileset *tileset, const C3DTTile *parent, const json& obj, void* opaque, C3DTTilesetVisitor visitor) NOTHROWS;
+    TAKErr parseTileProperties(C3DTTile *tile, const C3DTTile *parent, const json& obj) NOTHROWS;
+
+    TAKErr parseTile(const ParseContext &ctx, const C3DTTile *parent, const JsonSpan &span, const std::size_t depth) NOTHROWS;
+
+    TAKErr parseImplicitTiling(std::shared_ptr<ImplicitTiling> &result, const C3DTTile &tile, const json &obj) NOTHROWS;
+    TAKErr parseImplicitChildren(const C3DTTile &parent, const char *baseURI, void *opaque, C3DTTilesetVisitor visitor) NOTHROWS;
+    TAKErr loadImplicitSubtree(std::shared_ptr<ImplicitSubtree> &result, const ImplicitTiling &implicit, const ImplicitCoord &coord, const char *baseURI) NOTHROWS;
+    TAKErr subdivideVolume(C3DTVolume *result, const ImplicitTiling &implicit, const ImplicitCoord &coord) NOTHROWS;
+    std::string expandTemplate(const std::string &uri, const ImplicitCoord &coord) NOTHROWS;
 
     bool isFileSystemTileset(
         TAK::Engine::Port::String* filePath,
@@ -77,6 +109,68 @@ struct C3DTExtras::Impl {
     json::iterator end;
 };
 
+namespace {
+    /** The tileset level properties, shared by the deferred subtrees */
+    struct TilesetHeader {
+        C3DTTileset tileset;
+        json doc;
+        C3DTExtras::Impl extras;
+    };
+
+    /** An availability bitstream, or a constant */
+    struct Availability {
+        Availability() NOTHROWS :
+            constant(0)
+        {}
+
+        bool get(const uint64_t index) const NOTHROWS {
+            if (bits.empty())
+                return !!constant;
+            return (index >> 3u) < bits.size() && ((bits[static_cast<std::size_t>(index >> 3u)] >> (index & 7u)) & 1u);
+        }
+
+        int constant;
+        std::vector<uint8_t> bits;
+    };
+
+    /** The availability of the tiles in a subtree of an implicit tileset */
+    struct ImplicitSubtree {
+        ImplicitCoord root;
+        Availability tiles;
+        Availability content;
+        Availability childSubtrees;
+    };
+
+    /** The properties of an implicitly tiled root tile */
+    struct ImplicitTiling {
+        bool octree;
+        std::size_t subtreeLevels;
+        std::size_t availableLevels;
+        std::string subtreeUri;
+        std::string contentUri;
+        C3DTVolume boundingVolume;
+        double geometricError;
+        C3DTRefine refine;
+    };
+}
+
+struct TAK::Engine::Formats::Cesium3DTiles::C3DTSubtree {
+    std::shared_ptr<const TilesetHeader> header;
+
+    // explicit children; the `children` array within the retained source
+    std::shared_ptr<const std::vector<char>> source;
+    std::size_t offset;
+    std::size_t length;
+    std::size_t maxDepth;
+
+    // implicit children; `availability` is the subtree containing the parent
+    std::shared_ptr<const ImplicitTiling> implicit;
+    std::shared_ptr<const ImplicitSubtree> availability;
+    ImplicitCoord coord;
+    /** if `true`, the only child is the implicit root */
+    bool implicitRoot;
+};
+
 TAKErr C3DTExtras::getString(String* result, const char* name) const NOTHROWS {
     
     if (!result)
@@ -109,18 +203,47 @@ C3DTTileset::C3DTTileset()
 {}
 
 TAKErr TAK::Engine::Formats::Cesium3DTiles::C3DTTileset_parse(DataInput2 *input, void *opaque, C3DTTilesetVisitor visitor) NOTHROWS {
+    return C3DTTileset_parse(input, opaque, visitor, SIZE_MAX);
+}
+
+TAKErr TAK::Engine::Formats::Cesium3DTiles::C3DTTileset_parse(DataInput2 *input, void *opaque, C3DTTilesetVisitor visitor, const std::size_t maxDepth) NOTHROWS {
 
-    if (!input)
+    if (!input || !visitor)
         return TE_InvalidArg;
 
-    DataInput2Streambuf buf(input);
-    std::istream in(&buf);
-    json obj = json::parse(in, nullptr, false);
-    if (obj.is_discarded())
+    TAKErr code = TE_Ok;
+
+    // the source is retained for any deferred subtrees
+    std::shared_ptr<std::vector<char>> source(new std::vector<char>());
+    code = readAll(*source, *input);
+    TE_CHECKRETURN_CODE(code);
+
+    // only the tileset properties are parsed up front; the tiles are parsed
+    // individually as they are visited
+    std::shared_ptr<TilesetHeader> header(new TilesetHeader());
+    header->doc = json::object();
+    JsonSpan root = { nullptr, nullptr };
+    JsonSpan doc = { source->data(), source->data() + source->size() };
+    code = forEachMember(doc, [&header, &root](const std::string &key, const JsonSpan &value) {
+        if (key == "root") {
+            root = value;
+            return TE_Ok;
+        }
+        if (key != "asset" && key != "geometricError" && key != "extras")
+            return TE_Ok;
+        json member = json::parse(value.begin, value.end, nullptr, false);
+        if (member.is_discarded())
+            return TE_Err;
+        header->doc[key] = std::move(member);
+        return TE_Ok;
+    });
+    if (code != TE_Ok)
+        return TE_Err;
+    if (!root.begin)
         return TE_Err;
 
-    TAKErr code = TE_Ok;
-    C3DTTileset tileset;
+    json &obj = header->doc;
+    C3DTTileset &tileset = header->tileset;
 
     auto asset = obj.find("asset");
     if (asset != obj.end()) {
@@ -129,19 +252,51 @@ TAKErr TAK::Engine::Formats::Cesium3DTiles::C3DTTileset_parse(DataInput2 *input,
     }
     tileset.geometricError = parseDouble(obj, "geometricError", 0.0);
 
-    C3DTExtras::Impl extrasImpl;
-    extrasImpl.it = obj.find("extras");
-    extrasImpl.end = obj.end();
-    tileset.extras.impl = &extrasImpl;
+    header->extras.it = obj.find("extras");
+    header->extras.end = obj.end();
+    tileset.extras.impl = &header->extras;
+
+    ParseContext ctx;
+    ctx.header = header;
+    ctx.source = source;
+    ctx.maxDepth = maxDepth;
+    ctx.opaque = opaque;
+    ctx.visitor = visitor;
+
+    code = parseTile(ctx, nullptr, root, 0u);
+    if (code == TE_Done)
+        code = TE_Ok;
+
+    return code;
+}
+
+TAKErr TAK::Engine::Formats::Cesium3DTiles::C3DTTileset_parseChildren(const C3DTTile &parent, const char *baseURI, void *opaque, C3DTTilesetVisitor visitor) NOTHROWS {
 
-    auto root = obj.find("root");
-    if (root != obj.end()) {
-        code = parseTile(&tileset, nullptr, *root, opaque, visitor);
-        if (code == TE_Done)
-            code = TE_Ok;
+    if (!visitor)
+        return TE_InvalidArg;
+    if (!parent.unparsedChildren)
+        return TE_Ok;
+
+    TAKErr code = TE_Ok;
+    const C3DTSubtree &subtree = *parent.unparsedChildren;
+    if (subtree.implicit) {
+        code = parseImplicitChildren(parent, baseURI, opaque, visitor);
     } else {
-        code = TE_Err;
+        ParseContext ctx;
+        ctx.header = subtree.header;
+        ctx.source = subtree.source;
+        ctx.maxDepth = subtree.maxDepth;
+        ctx.opaque = opaque;
+        ctx.visitor = visitor;
+
+        const char *children = subtree.source->data() + subtree.offset;
+        JsonSpan span = { children, children + subtree.length };
+        code = forEachElement(span, [&ctx, &parent](const JsonSpan &child) {
+            return parseTile(ctx, &parent, child, 1u);
+        });
     }
+    if (code == TE_Done)
+        code = TE_Ok;
 
     return code;
 }
@@ -502,20 +657,152 @@ TAKErr TAK::Engine::Formats::Cesium3DTiles::C3DTRegion_calcAux(C3DTRegionAux* au
 }
 
 namespace {
-    DataInput2Streambuf::DataInput2Streambuf(TAK::Engine::Util::DataInput2* input)
-            : input(input),
-            curr(std::char_traits<char>::eof()) {}
+    TAKErr readAll(std::vector<char> &result, DataInput2 &input) NOTHROWS {
+        const int64_t length = input.length();
+        result.resize(length > 0 ? static_cast<std::size_t>(length) : 64u * 1024u);
+        std::size_t size = 0u;
+        while (true) {
+            if (size == result.size()) {
+                if (length > 0)
+                    break;
+                result.resize(size * 2u);
+            }
+            std::size_t numRead = 0u;
+            TAKErr code = input.read(reinterpret_cast<uint8_t *>(&result[size]), &numRead, result.size() - size);
+            if (code == TE_EOF || (code == TE_Ok && !numRead))
+                break;
+            TE_CHECKRETURN_CODE(code);
+            size += numRead;
+        }
+        result.resize(size);
+        return TE_Ok;
+    }
+
+    const char *skipWhitespace(const char *p, const char *end) NOTHROWS {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+            p++;
+        return p;
+    }
+
+    const char *skipString(const char *p, const char *end) NOTHROWS {
+        // `p` is at the opening quote
+        for (p++; p < end; p++) {
+            if (*p == '\\')
+                p++;
+            else if (*p == '"')
+                return p + 1;
+        }
+        return nullptr;
+    }
+
+    const char *skipValue(const char *p, const char *end) NOTHROWS {
+        if (p >= end)
+            return nullptr;
+        if (*p == '"')
+            return skipString(p, end);
+        if (*p != '{' && *p != '[') {
+            // number or literal
+            const char *start = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                p++;
+            return (p > start) ? p : nullptr;
+        }
+        // brackets are only matched by depth; the values are validated when parsed
+        std::size_t depth = 0u;
+        while (p < end) {
+            switch (*p) {
+            case '"':
+                p = skipString(p, end);
+                if (!p)
+                    return nullptr;
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (!--depth)
+                    return p + 1;
+                break;
+            default:
+                break;
+            }
+            p++;
+        }
+        return nullptr;
+    }
+
+    template<class Fn>
+    TAKErr forEachMember(const JsonSpan &obj, Fn fn) NOTHROWS {
+        const char *p = skipWhitespace(obj.begin, obj.end);
+        if (p >= obj.end || *p != '{')
+            return TE_Err;
+        p = skipWhitespace(p + 1, obj.end);
+        if (p < obj.end && *p == '}')
+            return TE_Ok;
+        while (p < obj.end) {
+            if (*p != '"')
+                return TE_Err;
+            const char *keyEnd = skipString(p, obj.end);
+            if (!keyEnd)
+                return TE_Err;
+            std::string key(p + 1, keyEnd - 1);
+            if (key.find('\\') != std::string::npos) {
+                json escaped = json::parse(p, keyEnd, nullptr, false);
+                if (!escaped.is_string())
+                    return TE_Err;
+                key = escaped.get<std::string>();
+            }
+            p = skipWhitespace(keyEnd, obj.end);
+            if (p >= obj.end || *p != ':')
+                return TE_Err;
+
+            JsonSpan value;
+            value.begin = skipWhitespace(p + 1, obj.end);
+            value.end = skipValue(value.begin, obj.end);
+            if (!value.end)
+                return TE_Err;
+            TAKErr code = fn(key, value);
+            if (code != TE_Ok)
+                return code;
+
+            p = skipWhitespace(value.end, obj.end);
+            if (p < obj.end && *p == '}')
+                return TE_Ok;
+            if (p >= obj.end || *p != ',')
+                return TE_Err;
+            p = skipWhitespace(p + 1, obj.end);
+        }
+        return TE_Err;
+    }
+
+    template<class Fn>
+    TAKErr forEachElement(const JsonSpan &arr, Fn fn) NOTHROWS {
+        const char *p = skipWhitespace(arr.begin, arr.end);
+        if (p >= arr.end || *p != '[')
+            return TE_Err;
+        p = skipWhitespace(p + 1, arr.end);
+        if (p < arr.end && *p == ']')
+            return TE_Ok;
+        while (p < arr.end) {
+            JsonSpan value;
+            value.begin = p;
+            value.end = skipValue(value.begin, arr.end);
+            if (!value.end)
+                return TE_Err;
+            TAKErr code = fn(value);
+            if (code != TE_Ok)
+                return code;
 
-    DataInput2Streambuf::int_type DataInput2Streambuf::underflow() {
-        size_t nr = 0;
-        char ch;
-        input->read((uint8_t*)&ch, &nr, 1);
-        if (nr == 1) {
-            curr = ch;
-            setg(&curr, &curr, &curr);
-            return std::char_traits<char>::to_int_type(static_cast<char>(curr));
+            p = skipWhitespace(value.end, arr.end);
+            if (p < arr.end && *p == ']')
+                return TE_Ok;
+            if (p >= arr.end || *p != ',')
+                return TE_Err;
+            p = skipWhitespace(p + 1, arr.end);
         }
-        return std::char_traits<char>::eof();
+        return TE_Err;
     }
 
     double parseDouble(const json& obj, const char* name, double def) NOTHROWS {
@@ -588,9 +875,9 @@ namespace {
         return code;
     }
 
-    TAKErr parseTile(const C3DTTileset* tileset, const C3DTTile* parent, const json& obj, void* opaque, C3DTTilesetVisitor visitor) NOTHROWS {
+    TAKErr parseTileProperties(C3DTTile *result, const C3DTTile *parent, const json& obj) NOTHROWS {
 
-        C3DTTile tile;
+        C3DTTile &tile = *result;
         TAKErr code = TE_Ok;
 
         tile.parent = parent;
@@ -638,25 +925,433 @@ namespace {
                 return code;
         }
 
-        auto children = obj.find("children");
-        if (children != obj.end())
-            tile.childCount = children->size();
+        return code;
+    }
+
+    TAKErr parseTile(const ParseContext &ctx, const C3DTTile *parent, const JsonSpan &span, const std::size_t depth) NOTHROWS {
+
+        // parse everything but the children
+        json obj = json::object();
+        JsonSpan children = { nullptr, nullptr };
+        TAKErr code = forEachMember(span, [&obj, &children](const std::string &key, const JsonSpan &value) {
+            if (key == "children") {
+                children = value;
+                return TE_Ok;
+            }
+            json member = json::parse(value.begin, value.end, nullptr, false);
+            if (member.is_discarded())
+                return TE_Err;
+            obj[key] = std::move(member);
+            return TE_Ok;
+        });
+        if (code != TE_Ok)
+            return code;
+
+        C3DTTile tile;
+        code = parseTileProperties(&tile, parent, obj);
+        if (code != TE_Ok)
+            return code;
 
-        code = visitor(opaque, tileset, &tile);
+        bool visitChildren = false;
+        std::shared_ptr<ImplicitTiling> implicit;
+        code = parseImplicitTiling(implicit, tile, obj);
+        if (code == TE_Ok) {
+            // the content is a template; the implicit root is visited as the only child
+            std::shared_ptr<C3DTSubtree> subtree(new C3DTSubtree());
+            subtree->header = ctx.header;
+            subtree->implicit = std::move(implicit);
+            subtree->implicitRoot = true;
+            tile.content = C3DTContent();
+            tile.childCount = 1u;
+            tile.unparsedChildren = std::move(subtree);
+        } else if (code == TE_Unsupported) {
+            Logger_log(TELL_Warning, "C3DTTileset: unsupported implicit tiling, tile content is ignored");
+            tile.content = C3DTContent();
+        } else if (children.begin) {
+            code = forEachElement(children, [&tile](const JsonSpan &) {
+                tile.childCount++;
+                return TE_Ok;
+            });
+            if (code != TE_Ok)
+                return code;
+
+            if (tile.childCount && depth >= ctx.maxDepth) {
+                std::shared_ptr<C3DTSubtree> subtree(new C3DTSubtree());
+                subtree->header = ctx.header;
+                subtree->source = ctx.source;
+                subtree->offset = static_cast<std::size_t>(children.begin - ctx.source->data());
+                subtree->length = static_cast<std::size_t>(children.end - children.begin);
+                subtree->maxDepth = ctx.maxDepth;
+                subtree->implicitRoot = false;
+                tile.unparsedChildren = std::move(subtree);
+            } else {
+                visitChildren = true;
+            }
+        }
+
+        code = ctx.visitor(ctx.opaque, &ctx.header->tileset, &tile);
         if (code != TE_Ok)
             return code;
 
-        if (children != obj.end()) {
-            for (auto child = children->begin(); child != children->end(); ++child) {
-                code = parseTile(tileset, &tile, *child, opaque, visitor);
-                if (code != TE_Ok)
-                    return code;
+        if (visitChildren) {
+            code = forEachElement(children, [&ctx, &tile, depth](const JsonSpan &child) {
+                return parseTile(ctx, &tile, child, depth + 1u);
+            });
+        }
+
+        return code;
+    }
+
+    TAKErr parseImplicitTiling(std::shared_ptr<ImplicitTiling> &result, const C3DTTile &tile, const json &obj) NOTHROWS {
+        // 3D Tiles 1.1, or the 1.0 extension
+        auto it = obj.find("implicitTiling");
+        if (it == obj.end()) {
+            auto extensions = obj.find("extensions");
+            if (extensions == obj.end() || !extensions->is_object())
+                return TE_InvalidArg;
+            it = extensions->find("3DTILES_implicit_tiling");
+            if (it == extensions->end())
+                return TE_InvalidArg;
+        }
+        if (!it->is_object())
+            return TE_InvalidArg;
+
+        std::shared_ptr<ImplicitTiling> implicit(new ImplicitTiling());
+
+        const std::string scheme = parseString(*it, "subdivisionScheme", "");
+        if (scheme == "QUADTREE")
+            implicit->octree = false;
+        else if (scheme == "OCTREE")
+            implicit->octree = true;
+        else
+            return TE_Unsupported;
+
+        implicit->subtreeLevels = static_cast<std::size_t>(parseDouble(*it, "subtreeLevels", 0.0));
+        implicit->availableLevels = static_cast<std::size_t>(parseDouble(*it, "availableLevels", parseDouble(*it, "maximumLevel", -1.0) + 1.0));
+        // coordinates must fit the morton index
+        implicit->availableLevels = std::min<std::size_t>(implicit->availableLevels, implicit->octree ? 21u : 32u);
+        auto subtrees = it->find("subtrees");
+        if (subtrees != it->end() && subtrees->is_object())
+            implicit->subtreeUri = parseString(*subtrees, "uri", "");
+        if (!implicit->subtreeLevels || !implicit->availableLevels || implicit->subtreeUri.empty())
+            return TE_Unsupported;
+
+        if (tile.boundingVolume.type != C3DTVolume::Box && tile.boundingVolume.type != C3DTVolume::Region)
+            return TE_Unsupported;
+
+        implicit->contentUri = tile.content.uri ? tile.content.uri.get() : "";
+        implicit->boundingVolume = tile.boundingVolume;
+        implicit->geometricError = tile.geometricError;
+        implicit->refine = tile.refine;
+
+        result = std::move(implicit);
+        return TE_Ok;
+    }
+
+    uint64_t mortonIndex(const ImplicitCoord &local, const bool octree) NOTHROWS {
+        uint64_t index = 0u;
+        for (std::size_t bit = 0u; bit < 32u; bit++) {
+            if (octree) {
+                index |= static_cast<uint64_t>((local.x >> bit) & 1u) << (3u * bit);
+                index |= static_cast<uint64_t>((local.y >> bit) & 1u) << (3u * bit + 1u);
+                index |= static_cast<uint64_t>((local.z >> bit) & 1u) << (3u * bit + 2u);
+            } else {
+                index |= static_cast<uint64_t>((local.x >> bit) & 1u) << (2u * bit);
+                index |= static_cast<uint64_t>((local.y >> bit) & 1u) << (2u * bit + 1u);
             }
         }
+        return index;
+    }
+
+    /** the coordinate relative to the root of the subtree containing it */
+    ImplicitCoord localCoord(const ImplicitCoord &coord, const ImplicitCoord &root) NOTHROWS {
+        const std::size_t levels = coord.level - root.level;
+        ImplicitCoord local;
+        local.level = levels;
+        local.x = coord.x - (root.x << levels);
+        local.y = coord.y - (root.y << levels);
+        local.z = coord.z - (root.z << levels);
+        return local;
+    }
+
+    /** the index of the first tile of a level within the subtree's availability */
+    uint64_t levelOffset(const std::size_t level, const bool octree) NOTHROWS {
+        return octree ?
+            ((uint64_t(1u) << (3u * level)) - 1u) / 7u :
+            ((uint64_t(1u) << (2u * level)) - 1u) / 3u;
+    }
+
+    TAKErr parseImplicitChildren(const C3DTTile &parent, const char *baseURI, void *opaque, C3DTTilesetVisitor visitor) NOTHROWS {
+
+        TAKErr code = TE_Ok;
+        const C3DTSubtree &subtree = *parent.unparsedChildren;
+        const ImplicitTiling &implicit = *subtree.implicit;
+        const std::size_t numChildren = implicit.octree ? 8u : 4u;
+
+        ImplicitCoord first;
+        std::size_t count;
+        if (subtree.implicitRoot) {
+            first.level = 0u;
+            first.x = 0u;
+            first.y = 0u;
+            first.z = 0u;
+            count = 1u;
+        } else {
+            first.level = subtree.coord.level + 1u;
+            first.x = subtree.coord.x << 1u;
+            first.y = subtree.coord.y << 1u;
+            first.z = subtree.coord.z << 1u;
+            count = numChildren;
+        }
+        if (first.level >= implicit.availableLevels)
+            return code;
+
+        // children are visited in morton order
+        for (std::size_t i = 0u; i < count; i++) {
+            ImplicitCoord coord = first;
+            coord.x += static_cast<uint32_t>(i & 1u);
+            coord.y += static_cast<uint32_t>((i >> 1u) & 1u);
+            coord.z += static_cast<uint32_t>((i >> 2u) & 1u);
+
+            std::shared_ptr<const ImplicitSubtree> availability = subtree.availability;
+            if (!(coord.level % implicit.subtreeLevels)) {
+                // the child is the root of another subtree
+                if (!subtree.implicitRoot &&
+                    !availability->childSubtrees.get(mortonIndex(localCoord(coord, availability->root), implicit.octree))) {
+
+                    continue;
+                }
+                std::shared_ptr<ImplicitSubtree> loaded;
+                code = loadImplicitSubtree(loaded, implicit, coord, baseURI);
+                if (code != TE_Ok) {
+                    Logger_log(TELL_Warning, "C3DTTileset: failed to load implicit subtree %u/%u/%u/%u", (unsigned)coord.level, coord.x, coord.y, coord.z);
+                    continue;
+                }
+                availability = std::move(loaded);
+            }
+
+            const ImplicitCoord local = localCoord(coord, availability->root);
+            const uint64_t index = levelOffset(local.level, implicit.octree) + mortonIndex(local, implicit.octree);
+            if (!availability->tiles.get(index))
+                continue;
+
+            C3DTTile tile;
+            tile.parent = &parent;
+            code = subdivideVolume(&tile.boundingVolume, implicit, coord);
+            TE_CHECKRETURN_CODE(code);
+            tile.geometricError = std::ldexp(implicit.geometricError, -static_cast<int>(coord.level));
+            tile.refine = implicit.refine;
+            if (!implicit.contentUri.empty() && availability->content.get(index))
+                tile.content.uri = expandTemplate(implicit.contentUri, coord).c_str();
+            if (coord.level + 1u < implicit.availableLevels) {
+                std::shared_ptr<C3DTSubtree> children(new C3DTSubtree());
+                children->header = subtree.header;
+                children->implicit = subtree.implicit;
+                children->availability = availability;
+                children->coord = coord;
+                children->implicitRoot = false;
+                tile.childCount = numChildren;
+                tile.unparsedChildren = std::move(children);
+            }
 
+            code = visitor(opaque, &subtree.header->tileset, &tile);
+            if (code != TE_Ok)
+                return code;
+        }
+
+        return TE_Ok;
+    }
+
+    uint64_t readUInt64LE(const uint8_t *src) NOTHROWS {
+        uint64_t value = 0u;
+        for (std::size_t i = 8u; i > 0u; i--)
+            value = (value << 8u) | src[i - 1u];
+        return value;
+    }
+
+    TAKErr loadImplicitSubtree(std::shared_ptr<ImplicitSubtree> &result, const ImplicitTiling &implicit, const ImplicitCoord &coord, const char *baseURI) NOTHROWS {
+
+        TAKErr code = TE_Ok;
+
+        String uri;
+        code = URI_combine(&uri, baseURI, expandTemplate(implicit.subtreeUri, coord).c_str());
+        TE_CHECKRETURN_CODE(code);
+
+        std::vector<char> data;
+        {
+            DataInput2Ptr input(nullptr, nullptr);
+            code = URI_open(input, uri);
+            TE_CHECKRETURN_CODE(code);
+            code = readAll(data, *input);
+            input->close();
+            TE_CHECKRETURN_CODE(code);
+        }
+
+        // binary subtrees carry a JSON chunk and an optional internal buffer
+        JsonSpan doc = { data.data(), data.data() + data.size() };
+        const uint8_t *internal = nullptr;
+        uint64_t internalLength = 0u;
+        if (data.size() >= 24u && memcmp(data.data(), "subt", 4u) == 0) {
+            const uint8_t *header = reinterpret_cast<const uint8_t *>(data.data());
+            const uint64_t jsonLength = readUInt64LE(header + 8u);
+            internalLength = readUInt64LE(header + 16u);
+            if (jsonLength > data.size() - 24u || internalLength > data.size() - 24u - jsonLength)
+                return TE_Err;
+            doc.begin = data.data() + 24u;
+            doc.end = doc.begin + jsonLength;
+            internal = header + 24u + jsonLength;
+        }
+
+        json obj = json::parse(doc.begin, doc.end, nullptr, false);
+        if (obj.is_discarded() || !obj.is_object())
+            return TE_Err;
+
+        std::vector<std::vector<char>> external;
+        std::vector<std::pair<const uint8_t *, uint64_t>> buffers;
+        auto it = obj.find("buffers");
+        if (it != obj.end() && it->is_array()) {
+            external.reserve(it->size());
+            for (auto buffer = it->begin(); buffer != it->end(); ++buffer) {
+                const std::string bufferUri = parseString(*buffer, "uri", "");
+                if (bufferUri.empty()) {
+                    buffers.push_back(std::make_pair(internal, internalLength));
+                    continue;
+                }
+                // external buffers are relative to the subtree
+                String parentUri;
+                String resolved;
+                code = URI_getParent(&parentUri, uri);
+                TE_CHECKRETURN_CODE(code);
+                code = URI_combine(&resolved, parentUri, bufferUri.c_str());
+                TE_CHECKRETURN_CODE(code);
+                DataInput2Ptr input(nullptr, nullptr);
+                code = URI_open(input, resolved);
+                TE_CHECKRETURN_CODE(code);
+                external.push_back(std::vector<char>());
+                code = readAll(external.back(), *input);
+                input->close();
+                TE_CHECKRETURN_CODE(code);
+                buffers.push_back(std::make_pair(reinterpret_cast<const uint8_t *>(external.back().data()), static_cast<uint64_t>(external.back().size())));
+            }
+        }
+        auto bufferViews = obj.find("bufferViews");
+
+        auto parseAvailability = [&obj, &buffers, &bufferViews](Availability &value, const json &availability) {
+            if (!availability.is_object())
+                return TE_Ok;
+            value.constant = static_cast<int>(parseDouble(availability, "constant", 0.0));
+            double bitstream = parseDouble(availability, "bitstream", parseDouble(availability, "bufferView", -1.0));
+            if (bitstream < 0.0)
+                return TE_Ok;
+            if (bufferViews == obj.end() || !bufferViews->is_array() || bitstream >= bufferViews->size())
+                return TE_Err;
+            const json &view = (*bufferViews)[static_cast<std::size_t>(bitstream)];
+            const double buffer = parseDouble(view, "buffer", -1.0);
+            const uint64_t offset = static_cast<uint64_t>(parseDouble(view, "byteOffset", 0.0));
+            const uint64_t length = static_cast<uint64_t>(parseDouble(view, "byteLength", 0.0));
+            if (buffer < 0.0 || buffer >= buffers.size())
+                return TE_Err;
+            const std::pair<const uint8_t *, uint64_t> &src = buffers[static_cast<std::size_t>(buffer)];
+            if (!src.first || offset > src.second || length > src.second - offset)
+                return TE_Err;
+            value.bits.assign(src.first + offset, src.first + offset + length);
+            return TE_Ok;
+        };
+
+        std::shared_ptr<ImplicitSubtree> subtree(new ImplicitSubtree());
+        subtree->root = coord;
+
+        it = obj.find("tileAvailability");
+        if (it != obj.end()) {
+            code = parseAvailability(subtree->tiles, *it);
+            TE_CHECKRETURN_CODE(code);
+        }
+        it = obj.find("contentAvailability");
+        if (it != obj.end()) {
+            // 1.1 allows multiple contents; only the first is used
+            if (it->is_array() && !it->empty())
+                code = parseAvailability(subtree->content, (*it)[0]);
+            else
+                code = parseAvailability(subtree->content, *it);
+            TE_CHECKRETURN_CODE(code);
+        }
+        it = obj.find("childSubtreeAvailability");
+        if (it != obj.end()) {
+            code = parseAvailability(subtree->childSubtrees, *it);
+            TE_CHECKRETURN_CODE(code);
+        }
+
+        result = std::move(subtree);
         return code;
     }
 
+    TAKErr subdivideVolume(C3DTVolume *result, const ImplicitTiling &implicit, const ImplicitCoord &coord) NOTHROWS {
+        const double scale = std::ldexp(1.0, -static_cast<int>(coord.level));
+        *result = implicit.boundingVolume;
+        switch (implicit.boundingVolume.type) {
+        case C3DTVolume::Region: {
+            const C3DTRegion &r = implicit.boundingVolume.object.region;
+            C3DTRegion &child = result->object.region;
+            const double dx = (r.east - r.west) * scale;
+            const double dy = (r.north - r.south) * scale;
+            child.west = r.west + dx * coord.x;
+            child.east = child.west + dx;
+            child.south = r.south + dy * coord.y;
+            child.north = child.south + dy;
+            if (implicit.octree) {
+                const double dz = (r.maximumHeight - r.minimumHeight) * scale;
+                child.minimumHeight = r.minimumHeight + dz * coord.z;
+                child.maximumHeight = child.minimumHeight + dz;
+            }
+            return TE_Ok;
+        }
+        case C3DTVolume::Box: {
+            const C3DTBox &b = implicit.boundingVolume.object.box;
+            C3DTBox &child = result->object.box;
+            // offsets of the child center along each half axis, in [-1, 1]
+            const double u = 2.0 * (coord.x + 0.5) * scale - 1.0;
+            const double v = 2.0 * (coord.y + 0.5) * scale - 1.0;
+            const double w = implicit.octree ? 2.0 * (coord.z + 0.5) * scale - 1.0 : 0.0;
+            child.center = Vector2_add(b.center,
+                Vector2_add(Vector2_multiply(b.xDirHalfLen, u),
+                    Vector2_add(Vector2_multiply(b.yDirHalfLen, v), Vector2_multiply(b.zDirHalfLen, w))));
+            child.xDirHalfLen = Vector2_multiply(b.xDirHalfLen, scale);
+            child.yDirHalfLen = Vector2_multiply(b.yDirHalfLen, scale);
+            if (implicit.octree)
+                child.zDirHalfLen = Vector2_multiply(b.zDirHalfLen, scale);
+            return TE_Ok;
+        }
+        default:
+            return TE_Unsupported;
+        }
+    }
+
+    std::string expandTemplate(const std::string &uri, const ImplicitCoord &coord) NOTHROWS {
+        std::string result;
+        result.reserve(uri.size() + 16u);
+        std::size_t i = 0u;
+        while (i < uri.size()) {
+            const std::size_t close = (uri[i] == '{') ? uri.find('}', i) : std::string::npos;
+            if (close == std::string::npos) {
+                result.push_back(uri[i++]);
+                continue;
+            }
+            const std::string name = uri.substr(i + 1u, close - i - 1u);
+            if (name == "level")
+                result += std::to_string(coord.level);
+            else if (name == "x")
+                result += std::to_string(coord.x);
+            else if (name == "y")
+                result += std::to_string(coord.y);
+            else if (name == "z")
+                result += std::to_string(coord.z);
+            else
+                result += uri.substr(i, close - i + 1u);
+            i = close + 1u;
+        }
+        return result;
+    }
+
     bool isZipURI(const char* URI) NOTHROWS {
         
         size_t len = strlen(URI);
@@ -1,6 +1,9 @@
 #ifndef TAK_ENGINE_FORMATS_CESIUM3DTILES_C3DTTILESET_H_INCLUDED
 #define TAK_ENGINE_FORMATS_CESIUM3DTILES_C3DTTILESET_H_INCLUDED
 
+#include <cstddef>
+#include <memory>
+
 #include "util/Error.h"
 #include "port/String.h"
 #include "util/DataInput2.h"
@@ -105,6 +108,12 @@ namespace TAK {
                     Port::String uri;
                 };
 
+                /**
+                 * The children of a tile whose parsing has been deferred;
+                 * see `C3DTTileset_parseChildren`.
+                 */
+                struct C3DTSubtree;
+
                 struct C3DTTile {
                     
                     C3DTTile();
@@ -116,8 +125,19 @@ namespace TAK {
                     C3DTRefine refine;
                     C3DTContent content;
                     Math::Matrix2 transform;
+                    /**
+                     * The number of children. If the children are
+                     * unparsed, this is an upper bound on the number of
+                     * children that will be visited.
+                     */
                     size_t childCount;
                     bool hasTransform;
+                    /**
+                     * If non-null, the children were not visited and may
+                     * be visited later via `C3DTTileset_parseChildren`.
+                     * Implicitly tiled children are always deferred.
+                     */
+                    std::shared_ptr<const C3DTSubtree> unparsedChildren;
                 };
 
                 struct C3DTExtras {
@@ -156,6 +176,39 @@ namespace TAK {
                  */
                 ENGINE_API Util::TAKErr C3DTTileset_parse(Util::DataInput2 *input, void *opaque, C3DTTilesetVisitor visitor) NOTHROWS;
 
+                /**
+                 * Parses a tileset.json, deferring the children of tiles
+                 * deeper than `maxDepth`. Only the JSON for the visited
+                 * tiles is parsed; the unparsed subtrees are retained as
+                 * raw text until visited via `C3DTTileset_parseChildren`.
+                 *
+                 * @param input byte stream for tileset.json
+                 * @param opaque user defined pointer passed to visitor
+                 * @param visitor callback function pointer called for each tile
+                 * @param maxDepth the depth of the deepest tile whose
+                 *                 children are visited; `0` visits only
+                 *                 the root
+                 */
+                ENGINE_API Util::TAKErr C3DTTileset_parse(Util::DataInput2 *input, void *opaque, C3DTTilesetVisitor visitor, const std::size_t maxDepth) NOTHROWS;
+
+                /**
+                 * Visits the unparsed children of a tile, depth-first. The
+                 * children's descendants are deferred at the same relative
+                 * depth as the original parse. Implicitly tiled children
+                 * may require their subtree availability files to be
+                 * fetched, relative to `baseURI`.
+                 *
+                 * <P>Each child's `parent` is `&parent`; `parent` only
+                 * needs to carry the `refine` and `unparsedChildren` of
+                 * the originally visited tile.
+                 *
+                 * @param parent    the tile whose children are visited
+                 * @param baseURI   the base URI of the tileset
+                 * @param opaque    user defined pointer passed to visitor
+                 * @param visitor   callback function pointer called for each tile
+                 */
+                ENGINE_API Util::TAKErr C3DTTileset_parseChildren(const C3DTTile &parent, const char *baseURI, void *opaque, C3DTTilesetVisitor visitor) NOTHROWS;
+
                 enum C3DTFileType {
                     C3DTFileType_TilesetJSON,
                     C3DTFileType_B3DM,
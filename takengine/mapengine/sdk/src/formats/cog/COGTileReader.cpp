@@ -0,0 +1,1219 @@
+#include "formats/cog/COGTileReader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+#include "math/Matrix2.h"
+#include "port/String.h"
+#include "renderer/BitmapFactory2.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/DataInput2.h"
+#include "util/IO2.h"
+#include "util/Logging2.h"
+#include "util/Memory.h"
+#include "util/URI.h"
+
+using namespace TAK::Engine::Formats::COG;
+
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Raster;
+using namespace TAK::Engine::Raster::TileReader;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    /** number of bytes fetched for the TIFF header and IFDs */
+    const std::size_t HEADER_FETCH_SIZE = 16u * 1024u;
+    /** maximum number of unrequested bytes between tiles fetched in a single request */
+    const int64_t MAX_COALESCE_GAP = 16LL * 1024LL;
+    /** maximum size of a coalesced request */
+    const int64_t MAX_COALESCE_SIZE = 4LL * 1024LL * 1024LL;
+    /** maximum number of IFDs traversed */
+    const std::size_t MAX_IFDS = 64u;
+    /** tiles are not expected to change; cached tiles are renewed daily */
+    const int64_t TILE_RENEW_SECONDS = 24LL * 60LL * 60LL;
+
+    enum TiffTag
+    {
+        NewSubfileType = 254,
+        ImageWidth = 256,
+        ImageLength = 257,
+        BitsPerSample = 258,
+        Compression = 259,
+        PhotometricInterpretation = 262,
+        SamplesPerPixel = 277,
+        PlanarConfiguration = 284,
+        Predictor = 317,
+        TileWidth = 322,
+        TileLength = 323,
+        TileOffsets = 324,
+        TileByteCounts = 325,
+        SampleFormat = 339,
+        JPEGTables = 347,
+        ModelPixelScale = 33550,
+        ModelTiepoint = 33922,
+        ModelTransformation = 34264,
+        GeoKeyDirectory = 34735,
+    };
+
+    enum GeoKey
+    {
+        GTModelType = 1024,
+        GTRasterType = 1025,
+        GeographicType = 2048,
+        ProjectedCSType = 3072,
+    };
+
+    enum TiffCompression
+    {
+        None = 1,
+        JPEG = 7,
+        AdobeDeflate = 8,
+        Deflate = 32946,
+    };
+
+    class ByteSource
+    {
+    public :
+        virtual ~ByteSource() NOTHROWS = default;
+    public :
+        /**
+         * Reads up to <code>len</code> bytes at the specified offset. Fewer
+         * bytes are only returned when the end of the source is reached.
+         */
+        virtual TAKErr read(uint8_t *dst, std::size_t *numRead, const int64_t offset, const std::size_t len) NOTHROWS = 0;
+        /** returns the length of the source or <code>-1</code> if unknown */
+        virtual int64_t length() const NOTHROWS = 0;
+        virtual bool isRemote() const NOTHROWS = 0;
+    };
+
+    class FileByteSource : public ByteSource
+    {
+    public :
+        TAKErr open(const char *path) NOTHROWS;
+    public :
+        TAKErr read(uint8_t *dst, std::size_t *numRead, const int64_t offset, const std::size_t len) NOTHROWS override;
+        int64_t length() const NOTHROWS override;
+        bool isRemote() const NOTHROWS override;
+    private :
+        FileInput2 file;
+        TAK::Engine::Thread::Mutex mutex;
+    };
+
+    /**
+     * Reads byte ranges through the registered protocol handlers.
+     */
+    class RemoteByteSource : public ByteSource
+    {
+    public :
+        RemoteByteSource(const char *uri) NOTHROWS;
+    public :
+        TAKErr read(uint8_t *dst, std::size_t *numRead, const int64_t offset, const std::size_t len) NOTHROWS override;
+        int64_t length() const NOTHROWS override;
+        bool isRemote() const NOTHROWS override;
+    private :
+        String uri;
+    };
+
+    struct Image
+    {
+        int64_t width {0};
+        int64_t height {0};
+        std::size_t tileWidth {0u};
+        std::size_t tileHeight {0u};
+        std::size_t tilesAcross {0u};
+        std::size_t tilesDown {0u};
+        unsigned compression {None};
+        unsigned predictor {1u};
+        unsigned samplesPerPixel {1u};
+        std::vector<uint64_t> tileOffsets;
+        std::vector<uint64_t> tileByteCounts;
+        std::vector<uint8_t> jpegTables;
+        // GeoTIFF tags; only consulted for the full resolution image
+        std::vector<double> pixelScale;
+        std::vector<double> tiepoints;
+        std::vector<double> transformation;
+        std::vector<uint16_t> geoKeys;
+    };
+
+    struct Tile
+    {
+        std::size_t column;
+        std::size_t row;
+        int64_t offset;
+        int64_t size;
+    };
+
+    /** the source and destination bounds of a read */
+    struct ReadBounds
+    {
+        int64_t srcX;
+        int64_t srcY;
+        int64_t srcW;
+        int64_t srcH;
+        std::size_t dstW;
+        std::size_t dstH;
+    };
+
+    /** the source tiles of an image covering a read */
+    struct Region
+    {
+        std::size_t level;
+        int64_t ix0;
+        int64_t iy0;
+        int64_t ix1;
+        int64_t iy1;
+        std::size_t tx0;
+        std::size_t ty0;
+        std::size_t tx1;
+        std::size_t ty1;
+    };
+
+    class TiffParser
+    {
+    public :
+        TiffParser(ByteSource &source) NOTHROWS;
+    public :
+        TAKErr parse(std::vector<Image> &images) NOTHROWS;
+    private :
+        TAKErr getBytes(const uint8_t **value, std::vector<uint8_t> &scratch, const int64_t offset, const std::size_t len) NOTHROWS;
+        uint64_t getUInt(const uint8_t *data, const std::size_t size) const NOTHROWS;
+        double getDouble(const uint8_t *data) const NOTHROWS;
+        TAKErr parseImage(Image *image, bool *supported, uint32_t *subfileType, const int64_t ifdOffset, int64_t *nextIfd) NOTHROWS;
+    private :
+        ByteSource &source;
+        std::vector<uint8_t> header;
+        bool bigEndian;
+        bool bigTiff;
+    };
+
+    std::size_t typeSize(const unsigned type) NOTHROWS
+    {
+        switch (type) {
+        case 1u : // BYTE
+        case 2u : // ASCII
+        case 6u : // SBYTE
+        case 7u : // UNDEFINED
+            return 1u;
+        case 3u : // SHORT
+        case 8u : // SSHORT
+            return 2u;
+        case 4u : // LONG
+        case 9u : // SLONG
+        case 11u : // FLOAT
+        case 13u : // IFD
+            return 4u;
+        case 5u : // RATIONAL
+        case 10u : // SRATIONAL
+        case 12u : // DOUBLE
+        case 16u : // LONG8
+        case 17u : // SLONG8
+        case 18u : // IFD8
+            return 8u;
+        default :
+            return 0u;
+        }
+    }
+
+    TAKErr readFully(uint8_t *dst, std::size_t *numRead, DataInput2 &input, const std::size_t len) NOTHROWS
+    {
+        *numRead = 0u;
+        while (*numRead < len) {
+            std::size_t n = 0u;
+            const TAKErr code = input.read(dst + *numRead, &n, len - *numRead);
+            if (code == TE_EOF || (code == TE_Ok && !n))
+                break;
+            TE_CHECKRETURN_CODE(code);
+            *numRead += n;
+        }
+        return TE_Ok;
+    }
+
+    TAKErr readFully(uint8_t *dst, ByteSource &source, const int64_t offset, const std::size_t len) NOTHROWS
+    {
+        std::size_t numRead;
+        const TAKErr code = source.read(dst, &numRead, offset, len);
+        TE_CHECKRETURN_CODE(code);
+        return (numRead == len) ? TE_Ok : TE_EOF;
+    }
+
+    bool isRemoteUri(const char *uri) NOTHROWS
+    {
+        return (strncmp(uri, "http://", 7u) == 0) || (strncmp(uri, "https://", 8u) == 0);
+    }
+
+    /** returns the cache key for the tile; the URI qualified by the tile's byte range */
+    String getTileKey(const char *uri, const int64_t offset, const int64_t size) NOTHROWS
+    {
+        std::ostringstream strm;
+        strm << uri << "#bytes=" << offset << "-" << (offset + size - 1LL);
+        return strm.str().c_str();
+    }
+
+    TAKErr decodeTile(uint8_t *dst, const Image &image, const Bitmap2::Format format, const std::size_t pixelSize, const uint8_t *data, const std::size_t len) NOTHROWS;
+    /**
+     * Derives the spatial reference and the image-to-projected transform
+     * from the GeoTIFF tags of the image.
+     *
+     * @return  TE_Ok on success, TE_Unsupported if the image is not
+     *          georeferenced or its coordinate system is not identified by
+     *          an EPSG code
+     */
+    TAKErr getGeoReference(int *srid, Matrix2 *img2proj, const Image &image) NOTHROWS;
+}
+
+struct COGTileReader::Impl
+{
+    String uri;
+    std::unique_ptr<ByteSource> source;
+    std::shared_ptr<URIOfflineCache> cache;
+    std::vector<Image> images;
+    Bitmap2::Format format {Bitmap2::RGBA32};
+    std::size_t pixelSize {4u};
+    bool georeferenced {false};
+    int srid {-1};
+    Matrix2 img2proj;
+    std::atomic<bool> canceled {false};
+
+    TAKErr getRegion(Region *value, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const size_t dstW, const size_t dstH) const NOTHROWS;
+    void getTiles(std::vector<Tile> &value, const Region &region) const NOTHROWS;
+    TAKErr fetchTiles(std::vector<std::vector<uint8_t>> &value, const std::vector<Tile> &tiles) NOTHROWS;
+    /**
+     * Resamples the decoded tiles of the region into the destination. Tiles
+     * are ordered row-major; <code>nullptr</code> entries are empty.
+     */
+    void resample(uint8_t *buf, const Region &region, const std::vector<const uint8_t *> &tiles, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const size_t dstW, const size_t dstH) const NOTHROWS;
+};
+
+COGTileReader::COGTileReader(const char *uri_, std::unique_ptr<Impl> &&impl_) NOTHROWS :
+    TileReader2(uri_),
+    impl(std::move(impl_))
+{}
+
+COGTileReader::~COGTileReader() NOTHROWS
+{}
+
+TAKErr COGTileReader::getWidth(int64_t *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = impl->images[0].width;
+    return TE_Ok;
+}
+TAKErr COGTileReader::getHeight(int64_t *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = impl->images[0].height;
+    return TE_Ok;
+}
+TAKErr COGTileReader::getTileWidth(size_t *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = impl->images[0].tileWidth;
+    return TE_Ok;
+}
+TAKErr COGTileReader::getTileHeight(size_t *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = impl->images[0].tileHeight;
+    return TE_Ok;
+}
+TAKErr COGTileReader::read(uint8_t *buf, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const size_t dstW, const size_t dstH) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!buf)
+        return TE_InvalidArg;
+    Region region;
+    code = impl->getRegion(&region, srcX, srcY, srcW, srcH, dstW, dstH);
+    TE_CHECKRETURN_CODE(code);
+
+    impl->canceled = false;
+
+    const Image &image = impl->images[region.level];
+    std::vector<Tile> tiles;
+    impl->getTiles(tiles, region);
+
+    std::vector<std::vector<uint8_t>> tileData;
+    code = impl->fetchTiles(tileData, tiles);
+    TE_CHECKRETURN_CODE(code);
+
+    const std::size_t tileSize = image.tileWidth * image.tileHeight * impl->pixelSize;
+    std::vector<uint8_t> decoded(tileSize * tiles.size());
+    std::vector<const uint8_t *> decodedTiles(tiles.size(), nullptr);
+    for (std::size_t i = 0u; i < tiles.size(); i++) {
+        if (impl->canceled)
+            return TE_Canceled;
+        // sparse tiles are empty
+        if (tileData[i].empty())
+            continue;
+        code = decodeTile(&decoded.at(0) + (i * tileSize), image, impl->format, impl->pixelSize, &tileData[i].at(0), tileData[i].size());
+        TE_CHECKRETURN_CODE(code);
+        decodedTiles[i] = &decoded.at(0) + (i * tileSize);
+    }
+
+    impl->resample(buf, region, decodedTiles, srcX, srcY, srcW, srcH, dstW, dstH);
+    return code;
+}
+TAKErr COGTileReader::readTiles(TileRead *reads, const size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!reads && count)
+        return TE_InvalidArg;
+
+    TAK::Engine::Thread::Lock lock(readLock);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    impl->canceled = false;
+
+    // gather the distinct source tiles for all reads, so that tiles shared by
+    // reads are fetched and decoded once and all fetches are coalesced
+    std::vector<ReadBounds> readBounds(count);
+    std::vector<Region> regions(count);
+    std::vector<std::vector<std::size_t>> readTiles(count);
+    std::vector<Tile> tiles;
+    std::vector<std::size_t> tileLevels;
+    std::map<std::pair<std::size_t, std::size_t>, std::size_t> tileIndices;
+    for (std::size_t i = 0u; i < count; i++) {
+        TileRead &tile = reads[i];
+        ReadBounds &b = readBounds[i];
+        tile.code = tile.data ? TE_Ok : TE_InvalidArg;
+        if (tile.code == TE_Ok)
+            tile.code = this->getTileSourceX(&b.srcX, tile.level, tile.tileColumn);
+        if (tile.code == TE_Ok)
+            tile.code = this->getTileSourceY(&b.srcY, tile.level, tile.tileRow);
+        if (tile.code == TE_Ok)
+            tile.code = this->getTileSourceWidth(&b.srcW, tile.level, tile.tileColumn);
+        if (tile.code == TE_Ok)
+            tile.code = this->getTileSourceHeight(&b.srcH, tile.level, tile.tileRow);
+        if (tile.code == TE_Ok)
+            tile.code = TileReader2::getTileWidth(&b.dstW, tile.level, tile.tileColumn);
+        if (tile.code == TE_Ok)
+            tile.code = TileReader2::getTileHeight(&b.dstH, tile.level, tile.tileRow);
+        if (tile.code == TE_Ok)
+            tile.code = impl->getRegion(&regions[i], b.srcX, b.srcY, b.srcW, b.srcH, b.dstW, b.dstH);
+        if (tile.code != TE_Ok)
+            continue;
+
+        std::vector<Tile> regionTiles;
+        impl->getTiles(regionTiles, regions[i]);
+        const Image &image = impl->images[regions[i].level];
+        for (const Tile &regionTile : regionTiles) {
+            const std::pair<std::size_t, std::size_t> key(regions[i].level, (regionTile.row * image.tilesAcross) + regionTile.column);
+            auto entry = tileIndices.find(key);
+            if (entry == tileIndices.end()) {
+                entry = tileIndices.insert(std::make_pair(key, tiles.size())).first;
+                tiles.push_back(regionTile);
+                tileLevels.push_back(regions[i].level);
+            }
+            readTiles[i].push_back(entry->second);
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> tileData;
+    code = impl->fetchTiles(tileData, tiles);
+    if (code != TE_Ok) {
+        for (std::size_t i = 0u; i < count; i++)
+            if (reads[i].code == TE_Ok)
+                reads[i].code = code;
+        return TE_Ok;
+    }
+
+    // decode each source tile once
+    std::vector<std::vector<uint8_t>> decoded(tiles.size());
+    std::vector<TAKErr> decodeCodes(tiles.size(), TE_Ok);
+    for (std::size_t i = 0u; i < tiles.size(); i++) {
+        if (impl->canceled) {
+            decodeCodes[i] = TE_Canceled;
+            continue;
+        }
+        // sparse tiles are empty
+        if (tileData[i].empty())
+            continue;
+        const Image &image = impl->images[tileLevels[i]];
+        decoded[i].resize(image.tileWidth * image.tileHeight * impl->pixelSize);
+        decodeCodes[i] = decodeTile(&decoded[i].at(0), image, impl->format, impl->pixelSize, &tileData[i].at(0), tileData[i].size());
+        // release the encoded data as it is consumed
+        std::vector<uint8_t>().swap(tileData[i]);
+    }
+
+    std::vector<const uint8_t *> decodedTiles;
+    for (std::size_t i = 0u; i < count; i++) {
+        TileRead &tile = reads[i];
+        if (tile.code != TE_Ok)
+            continue;
+        decodedTiles.clear();
+        for (const std::size_t idx : readTiles[i]) {
+            if (decodeCodes[idx] != TE_Ok) {
+                tile.code = decodeCodes[idx];
+                break;
+            }
+            decodedTiles.push_back(decoded[idx].empty() ? nullptr : &decoded[idx].at(0));
+        }
+        if (tile.code != TE_Ok)
+            continue;
+
+        const ReadBounds &b = readBounds[i];
+        impl->resample(tile.data, regions[i], decodedTiles, b.srcX, b.srcY, b.srcW, b.srcH, b.dstW, b.dstH);
+    }
+
+    return code;
+}
+TAKErr COGTileReader::getFormat(Bitmap2::Format *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = impl->format;
+    return TE_Ok;
+}
+TAKErr COGTileReader::isMultiResolution(bool *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = true;
+    return TE_Ok;
+}
+TAKErr COGTileReader::cancel() NOTHROWS
+{
+    impl->canceled = true;
+    return TE_Ok;
+}
+TAKErr COGTileReader::getSpatialReferenceID(int *value) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (!impl->georeferenced)
+        return TE_Unsupported;
+    *value = impl->srid;
+    return TE_Ok;
+}
+TAKErr COGTileReader::getDatasetProjection(DatasetProjection2Ptr &value) const NOTHROWS
+{
+    if (!impl->georeferenced)
+        return TE_Unsupported;
+    return DatasetProjection2_create(value, impl->srid, impl->img2proj);
+}
+
+TAKErr COGTileReader::Impl::getRegion(Region *value, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const size_t dstW, const size_t dstH) const NOTHROWS
+{
+    const Image &full = images[0];
+    if (srcX < 0LL || srcY < 0LL || srcW <= 0LL || srcH <= 0LL || !dstW || !dstH)
+        return TE_InvalidArg;
+    if ((srcX + srcW) > full.width || (srcY + srcH) > full.height)
+        return TE_InvalidArg;
+
+    // select the coarsest image that satisfies the requested resolution
+    const double decimation = std::min((double)srcW / (double)dstW, (double)srcH / (double)dstH);
+    value->level = 0u;
+    for (std::size_t i = 1u; i < images.size(); i++) {
+        if (((double)full.width / (double)images[i].width) > decimation)
+            break;
+        value->level = i;
+    }
+    const Image &image = images[value->level];
+    const double scaleX = (double)full.width / (double)image.width;
+    const double scaleY = (double)full.height / (double)image.height;
+
+    // region of interest in the selected image
+    value->ix0 = std::min((int64_t)((double)srcX / scaleX), image.width - (int64_t)1);
+    value->iy0 = std::min((int64_t)((double)srcY / scaleY), image.height - (int64_t)1);
+    value->ix1 = std::max(std::min((int64_t)ceil((double)(srcX + srcW) / scaleX), image.width), value->ix0 + (int64_t)1);
+    value->iy1 = std::max(std::min((int64_t)ceil((double)(srcY + srcH) / scaleY), image.height), value->iy0 + (int64_t)1);
+
+    value->tx0 = (std::size_t)value->ix0 / image.tileWidth;
+    value->ty0 = (std::size_t)value->iy0 / image.tileHeight;
+    value->tx1 = (std::size_t)(value->ix1 - 1LL) / image.tileWidth;
+    value->ty1 = (std::size_t)(value->iy1 - 1LL) / image.tileHeight;
+    return TE_Ok;
+}
+void COGTileReader::Impl::getTiles(std::vector<Tile> &value, const Region &region) const NOTHROWS
+{
+    const Image &image = images[region.level];
+    value.reserve(value.size() + ((region.tx1 - region.tx0 + 1u) * (region.ty1 - region.ty0 + 1u)));
+    for (std::size_t ty = region.ty0; ty <= region.ty1; ty++) {
+        for (std::size_t tx = region.tx0; tx <= region.tx1; tx++) {
+            const std::size_t idx = (ty * image.tilesAcross) + tx;
+            Tile tile;
+            tile.column = tx;
+            tile.row = ty;
+            tile.offset = (int64_t)image.tileOffsets[idx];
+            tile.size = (int64_t)image.tileByteCounts[idx];
+            value.push_back(tile);
+        }
+    }
+}
+void COGTileReader::Impl::resample(uint8_t *buf, const Region &region, const std::vector<const uint8_t *> &tiles, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const size_t dstW, const size_t dstH) const NOTHROWS
+{
+    const Image &full = images[0];
+    const Image &image = images[region.level];
+    const double scaleX = (double)full.width / (double)image.width;
+    const double scaleY = (double)full.height / (double)image.height;
+
+    // assemble the tiles into a window covering the region of interest
+    const std::size_t windowWidth = (region.tx1 - region.tx0 + 1u) * image.tileWidth;
+    const std::size_t windowHeight = (region.ty1 - region.ty0 + 1u) * image.tileHeight;
+    const std::size_t windowStride = windowWidth * pixelSize;
+    const std::size_t tileStride = image.tileWidth * pixelSize;
+    std::vector<uint8_t> window(windowStride * windowHeight, 0u);
+    std::size_t i = 0u;
+    for (std::size_t ty = region.ty0; ty <= region.ty1; ty++) {
+        for (std::size_t tx = region.tx0; tx <= region.tx1; tx++, i++) {
+            if (!tiles[i])
+                continue;
+            uint8_t *dst = &window.at(0) + ((ty - region.ty0) * image.tileHeight * windowStride) + ((tx - region.tx0) * tileStride);
+            for (std::size_t y = 0u; y < image.tileHeight; y++)
+                memcpy(dst + (y * windowStride), tiles[i] + (y * tileStride), tileStride);
+        }
+    }
+
+    // nearest neighbor resample into the destination
+    const int64_t windowX = (int64_t)(region.tx0 * image.tileWidth);
+    const int64_t windowY = (int64_t)(region.ty0 * image.tileHeight);
+    std::vector<std::size_t> columns(dstW);
+    for (std::size_t x = 0u; x < dstW; x++) {
+        const double sx = (double)srcX + (((double)x + 0.5) * (double)srcW / (double)dstW);
+        const int64_t ix = std::max(std::min((int64_t)(sx / scaleX), region.ix1 - (int64_t)1), region.ix0);
+        columns[x] = (std::size_t)(ix - windowX) * pixelSize;
+    }
+    for (std::size_t y = 0u; y < dstH; y++) {
+        const double sy = (double)srcY + (((double)y + 0.5) * (double)srcH / (double)dstH);
+        const int64_t iy = std::max(std::min((int64_t)(sy / scaleY), region.iy1 - (int64_t)1), region.iy0);
+        const uint8_t *srcRow = &window.at(0) + ((std::size_t)(iy - windowY) * windowStride);
+        uint8_t *dstRow = buf + (y * dstW * pixelSize);
+        for (std::size_t x = 0u; x < dstW; x++)
+            memcpy(dstRow + (x * pixelSize), srcRow + columns[x], pixelSize);
+    }
+}
+TAKErr COGTileReader::Impl::fetchTiles(std::vector<std::vector<uint8_t>> &value, const std::vector<Tile> &tiles) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    value.clear();
+    value.resize(tiles.size());
+
+    std::vector<std::size_t> pending;
+    pending.reserve(tiles.size());
+    for (std::size_t i = 0u; i < tiles.size(); i++) {
+        if (tiles[i].size <= 0LL)
+            continue;
+        if (cache && source->isRemote()) {
+            DataInput2Ptr input(nullptr, nullptr);
+            if (cache->openCached(input, getTileKey(uri, tiles[i].offset, tiles[i].size), TILE_RENEW_SECONDS) == TE_Ok) {
+                value[i].resize((std::size_t)tiles[i].size);
+                std::size_t numRead;
+                if (readFully(&value[i].at(0), &numRead, *input, value[i].size()) == TE_Ok && numRead == value[i].size())
+                    continue;
+                value[i].clear();
+            }
+        }
+        pending.push_back(i);
+    }
+    if (pending.empty())
+        return code;
+
+    std::sort(pending.begin(), pending.end(), [&tiles](const std::size_t a, const std::size_t b)
+    {
+        return tiles[a].offset < tiles[b].offset;
+    });
+
+    // coalesce tiles that are adjacent, or nearly so, into a single request
+    std::vector<uint8_t> buffer;
+    std::size_t first = 0u;
+    while (first < pending.size()) {
+        if (canceled)
+            return TE_Canceled;
+
+        const int64_t start = tiles[pending[first]].offset;
+        int64_t end = start + tiles[pending[first]].size;
+        std::size_t last = first + 1u;
+        while (last < pending.size()) {
+            const Tile &next = tiles[pending[last]];
+            const int64_t nextEnd = std::max(end, next.offset + next.size);
+            if ((next.offset - end) > MAX_COALESCE_GAP || (nextEnd - start) > MAX_COALESCE_SIZE)
+                break;
+            end = nextEnd;
+            last++;
+        }
+
+        buffer.resize((std::size_t)(end - start));
+        code = readFully(&buffer.at(0), *source, start, buffer.size());
+        TE_CHECKRETURN_CODE(code);
+
+        for (std::size_t i = first; i < last; i++) {
+            const Tile &tile = tiles[pending[i]];
+            const uint8_t *data = &buffer.at(0) + (tile.offset - start);
+            value[pending[i]].assign(data, data + tile.size);
+            if (cache && source->isRemote())
+                cache->put(getTileKey(uri, tile.offset, tile.size), data, (std::size_t)tile.size);
+        }
+        first = last;
+    }
+
+    return code;
+}
+
+TAKErr TAK::Engine::Formats::COG::COGTileReader_open(TileReader2Ptr &value, const char *uri, const std::shared_ptr<URIOfflineCache> &cache) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!uri)
+        return TE_InvalidArg;
+
+    std::unique_ptr<COGTileReader::Impl> impl(new COGTileReader::Impl());
+    impl->uri = uri;
+    impl->cache = cache;
+    if (isRemoteUri(uri)) {
+        impl->source.reset(new RemoteByteSource(uri));
+    } else {
+        std::unique_ptr<FileByteSource> file(new FileByteSource());
+        code = file->open(uri);
+        TE_CHECKRETURN_CODE(code);
+        impl->source = std::move(file);
+    }
+
+    TiffParser parser(*impl->source);
+    code = parser.parse(impl->images);
+    TE_CHECKRETURN_CODE(code);
+
+    const Image &full = impl->images[0];
+    switch (full.samplesPerPixel) {
+    case 1u :
+        impl->format = Bitmap2::MONOCHROME;
+        break;
+    case 2u :
+        impl->format = Bitmap2::MONOCHROME_ALPHA;
+        break;
+    case 3u :
+        impl->format = Bitmap2::RGB24;
+        break;
+    case 4u :
+        impl->format = Bitmap2::RGBA32;
+        break;
+    default :
+        return TE_Unsupported;
+    }
+    impl->pixelSize = full.samplesPerPixel;
+    // imagery without georeferencing remains readable
+    impl->georeferenced = (getGeoReference(&impl->srid, &impl->img2proj, full) == TE_Ok);
+
+    value = TileReader2Ptr(new COGTileReader(uri, std::move(impl)), Memory_deleter_const<TileReader2, COGTileReader>);
+    return code;
+}
+
+COGTileReaderSpi::COGTileReaderSpi(const std::shared_ptr<URIOfflineCache> &cache_) NOTHROWS :
+    cache(cache_)
+{}
+COGTileReaderSpi::~COGTileReaderSpi() NOTHROWS
+{}
+const char *COGTileReaderSpi::getName() const NOTHROWS
+{
+    return "cog";
+}
+TAKErr COGTileReaderSpi::create(TileReader2Ptr &reader, const char *uri, const TileReaderFactory2Options *options) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    code = isSupported(uri);
+    TE_CHECKRETURN_CODE(code);
+
+    std::shared_ptr<URIOfflineCache> tileCache(cache);
+    if (!tileCache && options && options->cacheUri && isRemoteUri(uri))
+        tileCache.reset(new URIOfflineCache(options->cacheUri, 64u * 1024u * 1024u));
+
+    return COGTileReader_open(reader, uri, tileCache);
+}
+TAKErr COGTileReaderSpi::isSupported(const char *uri) const NOTHROWS
+{
+    if (!uri)
+        return TE_InvalidArg;
+    // ignore any query or fragment
+    std::string path(uri);
+    const std::size_t suffix = path.find_first_of("?#");
+    if (suffix != std::string::npos)
+        path.resize(suffix);
+    int cmp = -1;
+    for (const char *ext : { ".tif", ".tiff" }) {
+        if (path.length() >= strlen(ext) && String_compareIgnoreCase(&cmp, path.c_str() + (path.length() - strlen(ext)), ext) == TE_Ok && !cmp)
+            return TE_Ok;
+    }
+    return TE_Unsupported;
+}
+int COGTileReaderSpi::getPriority() const NOTHROWS
+{
+    return 1;
+}
+
+namespace
+{
+    TAKErr FileByteSource::open(const char *path) NOTHROWS
+    {
+        return file.open(path);
+    }
+    TAKErr FileByteSource::read(uint8_t *dst, std::size_t *numRead, const int64_t offset, const std::size_t len) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        TAK::Engine::Thread::Lock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        code = file.seek(offset);
+        TE_CHECKRETURN_CODE(code);
+        return readFully(dst, numRead, file, len);
+    }
+    int64_t FileByteSource::length() const NOTHROWS
+    {
+        return file.length();
+    }
+    bool FileByteSource::isRemote() const NOTHROWS
+    {
+        return false;
+    }
+
+    RemoteByteSource::RemoteByteSource(const char *uri_) NOTHROWS :
+        uri(uri_)
+    {}
+    TAKErr RemoteByteSource::read(uint8_t *dst, std::size_t *numRead, const int64_t offset, const std::size_t len) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        *numRead = 0u;
+        if (!len)
+            return code;
+        DataInput2Ptr input(nullptr, nullptr);
+        code = URI_openRange(input, uri, offset, len);
+        TE_CHECKRETURN_CODE(code);
+        code = readFully(dst, numRead, *input, len);
+        input->close();
+        return code;
+    }
+    int64_t RemoteByteSource::length() const NOTHROWS
+    {
+        return -1LL;
+    }
+    bool RemoteByteSource::isRemote() const NOTHROWS
+    {
+        return true;
+    }
+
+    TiffParser::TiffParser(ByteSource &source_) NOTHROWS :
+        source(source_),
+        bigEndian(false),
+        bigTiff(false)
+    {}
+    TAKErr TiffParser::parse(std::vector<Image> &images) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        images.clear();
+
+        std::size_t headerSize = HEADER_FETCH_SIZE;
+        if (source.length() >= 0LL)
+            headerSize = (std::size_t)std::min((int64_t)headerSize, source.length());
+        if (headerSize < 8u)
+            return TE_Unsupported;
+        header.resize(headerSize);
+        // a remote file may be shorter than the speculative fetch
+        code = source.read(&header.at(0), &headerSize, 0LL, headerSize);
+        TE_CHECKRETURN_CODE(code);
+        if (headerSize < 8u)
+            return TE_Unsupported;
+        header.resize(headerSize);
+
+        if (header[0] == 'I' && header[1] == 'I')
+            bigEndian = false;
+        else if (header[0] == 'M' && header[1] == 'M')
+            bigEndian = true;
+        else
+            return TE_Unsupported;
+
+        const uint64_t version = getUInt(&header.at(2), 2u);
+        int64_t ifd;
+        if (version == 42u) {
+            bigTiff = false;
+            ifd = (int64_t)getUInt(&header.at(4), 4u);
+        } else if (version == 43u && headerSize >= 16u) {
+            bigTiff = true;
+            if (getUInt(&header.at(4), 2u) != 8u)
+                return TE_Unsupported;
+            ifd = (int64_t)getUInt(&header.at(8), 8u);
+        } else {
+            return TE_Unsupported;
+        }
+
+        for (std::size_t i = 0u; ifd && i < MAX_IFDS; i++) {
+            Image image;
+            bool supported;
+            uint32_t subfileType;
+            int64_t next;
+            code = parseImage(&image, &supported, &subfileType, ifd, &next);
+            TE_CHECKRETURN_CODE(code);
+            ifd = next;
+
+            // the full resolution image must be readable
+            if (images.empty() && (!supported || (subfileType & 0x5u)))
+                return TE_Unsupported;
+            // skip masks and anything that is not an overview of the same layout
+            if (!supported || (subfileType & 0x4u))
+                continue;
+            if (!images.empty()) {
+                if (!(subfileType & 0x1u) || image.samplesPerPixel != images[0].samplesPerPixel)
+                    continue;
+                if (image.width >= images[0].width || image.height >= images[0].height)
+                    continue;
+            }
+            images.push_back(std::move(image));
+        }
+        if (images.empty())
+            return TE_Unsupported;
+
+        // order overviews from finest to coarsest
+        std::sort(images.begin() + 1u, images.end(), [](const Image &a, const Image &b)
+        {
+            return a.width > b.width;
+        });
+
+        return code;
+    }
+    TAKErr TiffParser::getBytes(const uint8_t **value, std::vector<uint8_t> &scratch, const int64_t offset, const std::size_t len) NOTHROWS
+    {
+        if (offset < 0LL)
+            return TE_InvalidArg;
+        if ((offset + (int64_t)len) <= (int64_t)header.size()) {
+            *value = &header.at(0) + offset;
+            return TE_Ok;
+        }
+        scratch.resize(std::max(len, (std::size_t)1u));
+        const TAKErr code = readFully(&scratch.at(0), source, offset, len);
+        TE_CHECKRETURN_CODE(code);
+        *value = &scratch.at(0);
+        return code;
+    }
+    uint64_t TiffParser::getUInt(const uint8_t *data, const std::size_t size) const NOTHROWS
+    {
+        uint64_t v = 0u;
+        for (std::size_t i = 0u; i < size; i++) {
+            const uint8_t b = bigEndian ? data[i] : data[size - 1u - i];
+            v = (v << 8u) | b;
+        }
+        return v;
+    }
+    double TiffParser::getDouble(const uint8_t *data) const NOTHROWS
+    {
+        const uint64_t bits = getUInt(data, 8u);
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    TAKErr TiffParser::parseImage(Image *image, bool *supported, uint32_t *subfileType, const int64_t ifdOffset, int64_t *nextIfd) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        const std::size_t countSize = bigTiff ? 8u : 2u;
+        const std::size_t entrySize = bigTiff ? 20u : 12u;
+        const std::size_t valueSize = bigTiff ? 8u : 4u;
+
+        std::vector<uint8_t> scratch;
+        const uint8_t *data;
+        code = getBytes(&data, scratch, ifdOffset, countSize);
+        TE_CHECKRETURN_CODE(code);
+        const uint64_t numEntries = getUInt(data, countSize);
+        if (!numEntries || numEntries > 4096u)
+            return TE_Unsupported;
+
+        std::vector<uint8_t> ifd;
+        code = getBytes(&data, ifd, ifdOffset + (int64_t)countSize, ((std::size_t)numEntries * entrySize) + valueSize);
+        TE_CHECKRETURN_CODE(code);
+        // entries are retained while values are fetched
+        if (ifd.empty())
+            ifd.assign(data, data + ((std::size_t)numEntries * entrySize) + valueSize);
+
+        *supported = true;
+        *subfileType = 0u;
+        *nextIfd = (int64_t)getUInt(&ifd.at(0) + (numEntries * entrySize), valueSize);
+
+        unsigned bitsPerSample = 8u;
+        unsigned planarConfiguration = 1u;
+        unsigned photometric = 1u;
+        unsigned sampleFormat = 1u;
+        bool tiled = false;
+
+        for (std::size_t i = 0u; i < numEntries; i++) {
+            const uint8_t *entry = &ifd.at(0) + (i * entrySize);
+            const unsigned tag = (unsigned)getUInt(entry, 2u);
+            const unsigned type = (unsigned)getUInt(entry + 2u, 2u);
+            const uint64_t count = getUInt(entry + 4u, bigTiff ? 8u : 4u);
+            const uint8_t *field = entry + (bigTiff ? 12u : 8u);
+
+            const std::size_t size = typeSize(type);
+            if (!size || !count)
+                continue;
+            // values are integral for all tags of interest, other than the
+            // GeoTIFF model tags
+            const bool modelTag = (tag == ModelPixelScale || tag == ModelTiepoint || tag == ModelTransformation);
+            if (modelTag != (type == 12u))
+                continue;
+            if (type == 5u || type == 10u || type == 11u)
+                continue;
+
+            const uint8_t *values = field;
+            std::vector<uint8_t> valuesScratch;
+            if ((count * size) > valueSize) {
+                if (count > (256u * 1024u * 1024u))
+                    return TE_Unsupported;
+                code = getBytes(&values, valuesScratch, (int64_t)getUInt(field, valueSize), (std::size_t)(count * size));
+                TE_CHECKRETURN_CODE(code);
+            }
+
+            switch (tag) {
+            case NewSubfileType :
+                *subfileType = (uint32_t)getUInt(values, size);
+                break;
+            case ImageWidth :
+                image->width = (int64_t)getUInt(values, size);
+                break;
+            case ImageLength :
+                image->height = (int64_t)getUInt(values, size);
+                break;
+            case BitsPerSample :
+                for (std::size_t j = 0u; j < count; j++)
+                    if (getUInt(values + (j * size), size) != 8u)
+                        bitsPerSample = (unsigned)getUInt(values + (j * size), size);
+                break;
+            case Compression :
+                image->compression = (unsigned)getUInt(values, size);
+                break;
+            case PhotometricInterpretation :
+                photometric = (unsigned)getUInt(values, size);
+                break;
+            case SamplesPerPixel :
+                image->samplesPerPixel = (unsigned)getUInt(values, size);
+                break;
+            case PlanarConfiguration :
+                planarConfiguration = (unsigned)getUInt(values, size);
+                break;
+            case Predictor :
+                image->predictor = (unsigned)getUInt(values, size);
+                break;
+            case TileWidth :
+                image->tileWidth = (std::size_t)getUInt(values, size);
+                tiled = true;
+                break;
+            case TileLength :
+                image->tileHeight = (std::size_t)getUInt(values, size);
+                break;
+            case TileOffsets :
+                image->tileOffsets.resize((std::size_t)count);
+                for (std::size_t j = 0u; j < count; j++)
+                    image->tileOffsets[j] = getUInt(values + (j * size), size);
+                break;
+            case TileByteCounts :
+                image->tileByteCounts.resize((std::size_t)count);
+                for (std::size_t j = 0u; j < count; j++)
+                    image->tileByteCounts[j] = getUInt(values + (j * size), size);
+                break;
+            case SampleFormat :
+                sampleFormat = (unsigned)getUInt(values, size);
+                break;
+            case JPEGTables :
+                image->jpegTables.assign(values, values + (std::size_t)(count * size));
+                break;
+            case ModelPixelScale :
+            case ModelTiepoint :
+            case ModelTransformation :
+            {
+                std::vector<double> &model = (tag == ModelPixelScale) ? image->pixelScale : (tag == ModelTiepoint) ? image->tiepoints : image->transformation;
+                model.resize((std::size_t)count);
+                for (std::size_t j = 0u; j < count; j++)
+                    model[j] = getDouble(values + (j * size));
+                break;
+            }
+            case GeoKeyDirectory :
+                image->geoKeys.resize((std::size_t)count);
+                for (std::size_t j = 0u; j < count; j++)
+                    image->geoKeys[j] = (uint16_t)getUInt(values + (j * size), size);
+                break;
+            default :
+                break;
+            }
+        }
+
+        if (!tiled || !image->width || !image->height || !image->tileWidth || !image->tileHeight) {
+            *supported = false;
+            return code;
+        }
+        image->tilesAcross = (std::size_t)((image->width + (int64_t)image->tileWidth - 1LL) / (int64_t)image->tileWidth);
+        image->tilesDown = (std::size_t)((image->height + (int64_t)image->tileHeight - 1LL) / (int64_t)image->tileHeight);
+        if (image->tileOffsets.size() < (image->tilesAcross * image->tilesDown) ||
+            image->tileByteCounts.size() < (image->tilesAcross * image->tilesDown)) {
+            *supported = false;
+            return code;
+        }
+
+        if (bitsPerSample != 8u || sampleFormat != 1u)
+            *supported = false;
+        else if (image->samplesPerPixel < 1u || image->samplesPerPixel > 4u)
+            *supported = false;
+        else if (planarConfiguration != 1u && image->samplesPerPixel > 1u)
+            *supported = false;
+        else if (image->predictor != 1u && image->predictor != 2u)
+            *supported = false;
+
+        switch (image->compression) {
+        case None :
+        case AdobeDeflate :
+        case Deflate :
+            // palette and subsampled YCbCr are not supported
+            if (photometric > 2u)
+                *supported = false;
+            break;
+        case JPEG :
+            // the decoder converts YCbCr to RGB
+            if (image->samplesPerPixel != 1u && image->samplesPerPixel != 3u)
+                *supported = false;
+            break;
+        default :
+            *supported = false;
+            break;
+        }
+
+        return code;
+    }
+
+    TAKErr getGeoReference(int *srid, Matrix2 *img2proj, const Image &image) NOTHROWS
+    {
+        // the directory header is {version, revision, minor revision, number of keys}
+        const std::vector<uint16_t> &keys = image.geoKeys;
+        if (keys.size() < 4u)
+            return TE_Unsupported;
+        unsigned modelType = 0u;
+        unsigned rasterType = 1u;
+        int geographic = 0;
+        int projected = 0;
+        const std::size_t numKeys = std::min((std::size_t)keys[3], (keys.size() - 4u) / 4u);
+        for (std::size_t i = 0u; i < numKeys; i++) {
+            // {key, tag location, count, value}; only values stored in the
+            // directory itself are of interest
+            const uint16_t *key = &keys[4u + (i * 4u)];
+            if (key[1] != 0u || key[2] != 1u)
+                continue;
+            switch (key[0]) {
+            case GTModelType :
+                modelType = key[3];
+                break;
+            case GTRasterType :
+                rasterType = key[3];
+                break;
+            case GeographicType :
+                geographic = key[3];
+                break;
+            case ProjectedCSType :
+                projected = key[3];
+                break;
+            default :
+                break;
+            }
+        }
+        const int code = (modelType == 2u || (modelType != 1u && !projected)) ? geographic : projected;
+        // 32767 denotes a user-defined coordinate system
+        if (code <= 0 || code >= 32767)
+            return TE_Unsupported;
+
+        if (image.transformation.size() >= 16u) {
+            const double *m = &image.transformation[0];
+            *img2proj = Matrix2(m[0], m[1], m[2], m[3],
+                                m[4], m[5], m[6], m[7],
+                                m[8], m[9], m[10], m[11],
+                                m[12], m[13], m[14], m[15]);
+        } else if (image.pixelScale.size() >= 2u && image.tiepoints.size() >= 6u) {
+            // {I, J, K, X, Y, Z}; raster rows increase as Y decreases
+            const double *s = &image.pixelScale[0];
+            const double *t = &image.tiepoints[0];
+            *img2proj = Matrix2(s[0], 0.0, 0.0, t[3] - (s[0] * t[0]),
+                                0.0, -s[1], 0.0, t[4] + (s[1] * t[1]),
+                                0.0, 0.0, 1.0, 0.0,
+                                0.0, 0.0, 0.0, 1.0);
+        } else {
+            return TE_Unsupported;
+        }
+        // image coordinates are pixel-is-area; with pixel-is-point, the
+        // model space is referenced to the pixel center
+        if (rasterType == 2u)
+            img2proj->translate(-0.5, -0.5);
+
+        *srid = code;
+        return TE_Ok;
+    }
+    TAKErr decodeTile(uint8_t *dst, const Image &image, const Bitmap2::Format format, const std::size_t pixelSize, const uint8_t *data, const std::size_t len) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const std::size_t tileStride = image.tileWidth * pixelSize;
+        const std::size_t tileSize = tileStride * image.tileHeight;
+
+        switch (image.compression) {
+        case None :
+            memcpy(dst, data, std::min(len, tileSize));
+            if (len < tileSize)
+                memset(dst + len, 0, tileSize - len);
+            break;
+        case AdobeDeflate :
+        case Deflate :
+        {
+            uLongf decodedSize = (uLongf)tileSize;
+            const int err = uncompress(dst, &decodedSize, data, (uLong)len);
+            if (err != Z_OK) {
+                Logger_log(TELL_Error, "COGTileReader: failed to inflate tile, err=%d", err);
+                return TE_Err;
+            }
+            if (decodedSize < tileSize)
+                memset(dst + decodedSize, 0, tileSize - decodedSize);
+            break;
+        }
+        case JPEG :
+        {
+            // abbreviated streams reference the shared tables; drop the
+            // tables' EOI and the tile's SOI to form a complete stream
+            std::vector<uint8_t> stream;
+            if (image.jpegTables.size() > 4u && len > 2u) {
+                stream.reserve(image.jpegTables.size() + len - 4u);
+                stream.insert(stream.end(), image.jpegTables.begin(), image.jpegTables.end() - 2u);
+                stream.insert(stream.end(), data + 2u, data + len);
+                data = &stream.at(0);
+            }
+            const std::size_t streamLen = stream.empty() ? len : stream.size();
+
+            BitmapPtr decoded(nullptr, nullptr);
+            code = BitmapFactory2_decode(decoded, data, streamLen, nullptr);
+            TE_CHECKRETURN_CODE(code);
+
+            memset(dst, 0, tileSize);
+            const Bitmap2 converted(*decoded, format);
+            const std::size_t rows = std::min(converted.getHeight(), image.tileHeight);
+            const std::size_t rowSize = std::min(converted.getWidth(), image.tileWidth) * pixelSize;
+            for (std::size_t y = 0u; y < rows; y++)
+                memcpy(dst + (y * tileStride), converted.getData() + (y * converted.getStride()), rowSize);
+            // JPEG is not used with a predictor
+            return code;
+        }
+        default :
+            return TE_Unsupported;
+        }
+
+        // horizontal differencing
+        if (image.predictor == 2u) {
+            for (std::size_t y = 0u; y < image.tileHeight; y++) {
+                uint8_t *row = dst + (y * tileStride);
+                for (std::size_t i = pixelSize; i < tileStride; i++)
+                    row[i] = (uint8_t)(row[i] + row[i - pixelSize]);
+            }
+        }
+
+        return code;
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef TAK_ENGINE_FORMATS_COG_COGTILEREADER_H_INCLUDED
+#define TAK_ENGINE_FORMATS_COG_COGTILEREADER_H_INCLUDED
+
+#include <memory>
+
+#include "port/Platform.h"
+#include "raster/DatasetProjection2.h"
+#include "raster/tilereader/TileReader2.h"
+#include "raster/tilereader/TileReaderFactory2.h"
+#include "util/Error.h"
+#include "util/URIOfflineCache.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Formats {
+            namespace COG {
+                /**
+                 * Reader for tiled GeoTIFF, including Cloud-Optimized
+                 * GeoTIFF. For remote (http/https) sources, only the IFDs
+                 * and the tiles covering a read are fetched, using HTTP
+                 * range requests; neighboring tiles are coalesced into a
+                 * single request. Internal overviews are used to service
+                 * subsampled reads.
+                 *
+                 * <P>Supports 8-bit, pixel interleaved imagery with one to
+                 * four samples that is uncompressed, deflate or JPEG
+                 * compressed.
+                 */
+                class ENGINE_API COGTileReader : public Raster::TileReader::TileReader2
+                {
+                private :
+                    struct Impl;
+                public :
+                    COGTileReader(const char *uri, std::unique_ptr<Impl> &&impl) NOTHROWS;
+                    ~COGTileReader() NOTHROWS;
+                public :
+                    Util::TAKErr getWidth(int64_t *value) NOTHROWS override;
+                    Util::TAKErr getHeight(int64_t *value) NOTHROWS override;
+                    Util::TAKErr getTileWidth(size_t *value) NOTHROWS override;
+                    Util::TAKErr getTileHeight(size_t *value) NOTHROWS override;
+                    Util::TAKErr read(uint8_t *buf, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH,
+                                      const size_t dstW, const size_t dstH) NOTHROWS override;
+                    /**
+                     * Source tiles shared by the reads are fetched and decoded
+                     * once, and the fetches for all reads are ordered by file
+                     * offset and coalesced.
+                     */
+                    Util::TAKErr readTiles(TileRead *tiles, const size_t count) NOTHROWS override;
+                    Util::TAKErr getFormat(Renderer::Bitmap2::Format *format) NOTHROWS override;
+                    Util::TAKErr isMultiResolution(bool *value) NOTHROWS override;
+                    /**
+                     * Returns the EPSG code of the coordinate system
+                     * described by the GeoTIFF keys.
+                     *
+                     * @return  TE_Ok on success, TE_Unsupported if the image
+                     *          is not georeferenced
+                     */
+                    Util::TAKErr getSpatialReferenceID(int *value) const NOTHROWS;
+                    /**
+                     * Returns the image-to-ground function described by the
+                     * GeoTIFF model tags.
+                     *
+                     * @return  TE_Ok on success, TE_Unsupported if the image
+                     *          is not georeferenced
+                     */
+                    Util::TAKErr getDatasetProjection(Raster::DatasetProjection2Ptr &value) const NOTHROWS;
+                protected :
+                    Util::TAKErr cancel() NOTHROWS override;
+                private :
+                    std::unique_ptr<Impl> impl;
+
+                    friend Util::TAKErr COGTileReader_open(Raster::TileReader::TileReader2Ptr &, const char *, const std::shared_ptr<Util::URIOfflineCache> &) NOTHROWS;
+                };
+
+                /**
+                 * Opens the GeoTIFF at the specified URI.
+                 *
+                 * @param cache If non-<code>null</code>, tiles fetched from
+                 *              remote sources are stored in and served from
+                 *              the cache
+                 *
+                 * @return  TE_Ok on success, TE_Unsupported if the file is
+                 *          not a tiled TIFF or uses an unsupported layout
+                 */
+                ENGINE_API Util::TAKErr COGTileReader_open(Raster::TileReader::TileReader2Ptr &value, const char *uri, const std::shared_ptr<Util::URIOfflineCache> &cache) NOTHROWS;
+
+                class ENGINE_API COGTileReaderSpi : public Raster::TileReader::TileReaderSpi2
+                {
+                public :
+                    /**
+                     * @param cache The tile cache shared by created readers.
+                     *              If <code>null</code>, a cache is created
+                     *              per reader when the options specify a
+                     *              <code>cacheUri</code>.
+                     */
+                    COGTileReaderSpi(const std::shared_ptr<Util::URIOfflineCache> &cache = std::shared_ptr<Util::URIOfflineCache>()) NOTHROWS;
+                    ~COGTileReaderSpi() NOTHROWS override;
+                public :
+                    const char *getName() const NOTHROWS override;
+                    Util::TAKErr create(Raster::TileReader::TileReader2Ptr &reader, const char *uri,
+                                        const Raster::TileReader::TileReaderFactory2Options *options) const NOTHROWS override;
+                    Util::TAKErr isSupported(const char *uri) const NOTHROWS override;
+                    int getPriority() const NOTHROWS override;
+                private :
+                    std::shared_ptr<Util::URIOfflineCache> cache;
+                };
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,350 @@
+#include "formats/etc2/ETC2.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/DataOutput2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Formats::ETC2;
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    TAKErr extractBlock(uint8_t *value, const Bitmap2 &bitmap, const std::size_t blockX, const std::size_t blockY) NOTHROWS;
+    void compressColorBlock(uint8_t *value, const uint8_t *block) NOTHROWS;
+    void compressAlphaBlock(uint8_t *value, const uint8_t *block) NOTHROWS;
+    unsigned fitSubblock(unsigned *table, uint8_t *indices, const int *base, const uint8_t *block, const std::size_t *pixels) NOTHROWS;
+
+    struct Candidate
+    {
+        /** quantized base color */
+        int q[3];
+        unsigned table;
+        uint8_t indices[8];
+        unsigned err;
+    };
+
+    // ETC1 intensity modifiers, by table codeword and pixel index
+    const int colorModifiers[8][4] =
+    {
+        {  2,   8,  -2,   -8 },
+        {  5,  17,  -5,  -17 },
+        {  9,  29,  -9,  -29 },
+        { 13,  42, -13,  -42 },
+        { 18,  60, -18,  -60 },
+        { 24,  80, -24,  -80 },
+        { 33, 106, -33, -106 },
+        { 47, 183, -47, -183 },
+    };
+
+    // EAC modifiers, by table index and pixel index
+    const int alphaModifiers[16][8] =
+    {
+        { -3, -6,  -9, -15, 2, 5, 8, 14 },
+        { -3, -7, -10, -13, 2, 6, 9, 12 },
+        { -2, -5,  -8, -13, 1, 4, 7, 12 },
+        { -2, -4,  -6, -13, 1, 3, 5, 12 },
+        { -3, -6,  -8, -12, 2, 5, 7, 11 },
+        { -3, -7,  -9, -11, 2, 6, 8, 10 },
+        { -4, -7,  -8, -11, 3, 6, 7, 10 },
+        { -3, -5,  -8, -11, 2, 4, 7, 10 },
+        { -2, -6,  -8, -10, 1, 5, 7,  9 },
+        { -2, -5,  -8, -10, 1, 4, 7,  9 },
+        { -2, -4,  -8, -10, 1, 3, 7,  9 },
+        { -2, -5,  -7, -10, 1, 4, 6,  9 },
+        { -3, -4,  -7, -10, 2, 3, 6,  9 },
+        { -1, -2,  -3, -10, 0, 1, 2,  9 },
+        { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+        { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+    };
+
+    int clamp255(const int v) NOTHROWS
+    {
+        return std::min(std::max(v, 0), 255);
+    }
+}
+
+TAKErr TAK::Engine::Formats::ETC2::ETC2_compress(DataOutput2 &value, std::size_t *compressedSize, ETC2Algorithm *algv, const Bitmap2 &bitmap) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    const ETC2Algorithm alg = ETC2_getDefaultAlgorithm(bitmap.getFormat());
+    if (algv)
+        *algv = alg;
+    if (compressedSize) {
+        code = ETC2_getCompressedSize(compressedSize, alg, bitmap.getWidth(), bitmap.getHeight());
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    const std::size_t numBlocksX = (bitmap.getWidth() + 3u) / 4u;
+    const std::size_t numBlocksY = (bitmap.getHeight() + 3u) / 4u;
+
+    uint8_t block[64];
+    uint8_t block_compressed[16u];
+    for (std::size_t blockY = 0u; blockY < numBlocksY; blockY++) {
+        for (std::size_t blockX = 0u; blockX < numBlocksX; blockX++) {
+            code = extractBlock(block, bitmap, blockX, blockY);
+            TE_CHECKBREAK_CODE(code);
+            std::size_t compressedBlockSize = 8u;
+            if (alg == TECA_ETC2_RGBA8) {
+                compressAlphaBlock(block_compressed, block);
+                compressColorBlock(block_compressed + 8u, block);
+                compressedBlockSize = 16u;
+            } else {
+                compressColorBlock(block_compressed, block);
+            }
+            code = value.write(block_compressed, compressedBlockSize);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKBREAK_CODE(code);
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    return code;
+}
+std::size_t TAK::Engine::Formats::ETC2::ETC2_getCompressedSize(const Bitmap2 &bitmap) NOTHROWS
+{
+    const ETC2Algorithm alg = ETC2_getDefaultAlgorithm(bitmap.getFormat());
+    std::size_t compressedSize;
+    ETC2_getCompressedSize(&compressedSize, alg, bitmap.getWidth(), bitmap.getHeight());
+    return compressedSize;
+}
+TAKErr TAK::Engine::Formats::ETC2::ETC2_getCompressedSize(std::size_t *value, const ETC2Algorithm alg, const std::size_t width, const std::size_t height) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    std::size_t compressedBlockSize;
+    switch (alg) {
+    case TECA_ETC2_RGB8 :
+        compressedBlockSize = 8u;
+        break;
+    case TECA_ETC2_RGBA8 :
+        compressedBlockSize = 16u;
+        break;
+    default :
+        return TE_InvalidArg;
+    }
+    const std::size_t numBlocksX = (width+3u) / 4u;
+    const std::size_t numBlocksY = (height+3u) / 4u;
+    *value = (numBlocksX*numBlocksY*compressedBlockSize);
+    return TE_Ok;
+}
+ETC2Algorithm TAK::Engine::Formats::ETC2::ETC2_getDefaultAlgorithm(const Bitmap2::Format fmt) NOTHROWS
+{
+    switch (fmt)
+    {
+    case Bitmap2::ARGB32 :
+    case Bitmap2::BGRA32 :
+    case Bitmap2::MONOCHROME_ALPHA :
+    case Bitmap2::RGBA32 :
+    case Bitmap2::RGBA5551 :
+        return TECA_ETC2_RGBA8;
+    default :
+        return TECA_ETC2_RGB8;
+    }
+}
+
+namespace
+{
+    TAKErr extractBlock(uint8_t *value, const Bitmap2 &bitmap, const std::size_t blockX, const std::size_t blockY) NOTHROWS
+    {
+        const std::size_t srcX = blockX * 4u;
+        const std::size_t srcY = blockY * 4u;
+        const std::size_t srcW = std::min(bitmap.getWidth()-srcX, (std::size_t)4u);
+        const std::size_t srcH = std::min(bitmap.getHeight()-srcY, (std::size_t)4u);
+
+        memset(value, 0xFFu, 64u);
+        Bitmap2 block(std::move(Bitmap2::DataPtr(value, Memory_leaker_const<uint8_t>)), 4u, 4u, Bitmap2::RGBA32);
+        return block.setRegion(bitmap, 0u, 0u, srcX, srcY, srcW, srcH);
+    }
+
+    /**
+     * Encodes the RGB of the 4x4 RGBA32 block in individual or differential
+     * mode. The differential offsets never overflow, so the block decodes
+     * identically as ETC1 and ETC2.
+     */
+    void compressColorBlock(uint8_t *value, const uint8_t *block) NOTHROWS
+    {
+        unsigned bestErr = ~0u;
+        for (unsigned flip = 0u; flip < 2u; flip++) {
+            // pixel offsets for each subblock; flipped subblocks are 4x2,
+            // otherwise 2x4
+            std::size_t pixels[2][8];
+            int avg[2][3];
+            for (std::size_t s = 0u; s < 2u; s++) {
+                int sum[3] = { 0, 0, 0 };
+                std::size_t n = 0u;
+                for (std::size_t y = 0u; y < 4u; y++) {
+                    for (std::size_t x = 0u; x < 4u; x++) {
+                        if ((flip ? (y / 2u) : (x / 2u)) != s)
+                            continue;
+                        pixels[s][n++] = (y * 4u + x);
+                        for (std::size_t c = 0u; c < 3u; c++)
+                            sum[c] += block[(y * 4u + x) * 4u + c];
+                    }
+                }
+                for (std::size_t c = 0u; c < 3u; c++)
+                    avg[s][c] = (sum[c] + 4) / 8;
+            }
+
+            // candidate base colors round each channel of the subblock
+            // average down or up; 4-bit for individual mode, 5-bit for
+            // differential mode
+            Candidate candidates[2][2][8];
+            for (unsigned diff = 0u; diff < 2u; diff++) {
+                const int maxq = diff ? 31 : 15;
+                for (std::size_t s = 0u; s < 2u; s++) {
+                    for (unsigned k = 0u; k < 8u; k++) {
+                        Candidate &candidate = candidates[diff][s][k];
+                        int base[3];
+                        for (std::size_t c = 0u; c < 3u; c++) {
+                            const int q = std::min((avg[s][c] * maxq) / 255 + (int)((k >> c) & 0x1u), maxq);
+                            candidate.q[c] = q;
+                            base[c] = diff ? ((q << 3) | (q >> 2)) : ((q << 4) | q);
+                        }
+                        candidate.err = fitSubblock(&candidate.table, candidate.indices, base, block, pixels[s]);
+                    }
+                }
+            }
+
+            for (unsigned diff = 0u; diff < 2u; diff++) {
+                // select the best pair; differential offsets are 3-bit signed
+                const Candidate *selected[2] = { nullptr, nullptr };
+                unsigned err = ~0u;
+                for (unsigned i = 0u; i < 8u; i++) {
+                    for (unsigned j = 0u; j < 8u; j++) {
+                        const Candidate &c0 = candidates[diff][0u][i];
+                        const Candidate &c1 = candidates[diff][1u][j];
+                        bool valid = true;
+                        for (std::size_t c = 0u; c < 3u && diff; c++)
+                            valid &= ((c1.q[c] - c0.q[c]) >= -4 && (c1.q[c] - c0.q[c]) <= 3);
+                        if (valid && (c0.err + c1.err) < err) {
+                            err = c0.err + c1.err;
+                            selected[0] = &c0;
+                            selected[1] = &c1;
+                        }
+                    }
+                }
+                if (!selected[0] || err >= bestErr)
+                    continue;
+                bestErr = err;
+
+                if (diff) {
+                    for (std::size_t c = 0u; c < 3u; c++)
+                        value[c] = (uint8_t)((selected[0]->q[c] << 3) | ((selected[1]->q[c] - selected[0]->q[c]) & 0x7));
+                } else {
+                    for (std::size_t c = 0u; c < 3u; c++)
+                        value[c] = (uint8_t)((selected[0]->q[c] << 4) | selected[1]->q[c]);
+                }
+                value[3] = (uint8_t)((selected[0]->table << 5u) | (selected[1]->table << 2u) | (diff << 1u) | flip);
+
+                // pixel indices are stored in column-major order, MSBs in
+                // the upper half-word
+                uint32_t bits = 0u;
+                for (std::size_t s = 0u; s < 2u; s++) {
+                    for (std::size_t i = 0u; i < 8u; i++) {
+                        const std::size_t p = pixels[s][i];
+                        const unsigned bit = (unsigned)((p % 4u) * 4u + (p / 4u));
+                        const uint8_t index = selected[s]->indices[i];
+                        bits |= ((uint32_t)(index >> 1u) << (16u + bit)) | ((uint32_t)(index & 0x1u) << bit);
+                    }
+                }
+                value[4] = (uint8_t)(bits >> 24u);
+                value[5] = (uint8_t)(bits >> 16u);
+                value[6] = (uint8_t)(bits >> 8u);
+                value[7] = (uint8_t)bits;
+            }
+        }
+    }
+
+    void compressAlphaBlock(uint8_t *value, const uint8_t *block) NOTHROWS
+    {
+        int amin = 255;
+        int amax = 0;
+        for (std::size_t i = 0u; i < 16u; i++) {
+            amin = std::min(amin, (int)block[i * 4u + 3u]);
+            amax = std::max(amax, (int)block[i * 4u + 3u]);
+        }
+
+        // uniform alpha is exact via the zero modifier of table 13
+        int bestBase = amin;
+        int bestMul = 1;
+        unsigned bestTable = 13u;
+        uint8_t bestIndices[16];
+        memset(bestIndices, 4u, 16u);
+        if (amin != amax) {
+            unsigned bestErr = ~0u;
+            for (unsigned t = 0u; t < 16u; t++) {
+                const int lo = alphaModifiers[t][3];
+                const int hi = alphaModifiers[t][7];
+                const int m0 = ((amax - amin) + (hi - lo) / 2) / (hi - lo);
+                for (int m = std::max(m0 - 1, 1); m <= std::min(m0 + 1, 15); m++) {
+                    const int base = clamp255(((amin + amax) - (lo + hi) * m + 1) / 2);
+                    uint8_t indices[16];
+                    unsigned err = 0u;
+                    for (std::size_t i = 0u; i < 16u && err < bestErr; i++) {
+                        const int a = block[i * 4u + 3u];
+                        unsigned pixelErr = ~0u;
+                        for (uint8_t j = 0u; j < 8u; j++) {
+                            const int d = clamp255(base + alphaModifiers[t][j] * m) - a;
+                            if ((unsigned)(d * d) < pixelErr) {
+                                pixelErr = (unsigned)(d * d);
+                                indices[i] = j;
+                            }
+                        }
+                        err += pixelErr;
+                    }
+                    if (err < bestErr) {
+                        bestErr = err;
+                        bestBase = base;
+                        bestMul = m;
+                        bestTable = t;
+                        memcpy(bestIndices, indices, 16u);
+                    }
+                }
+            }
+        }
+
+        uint64_t bits = ((uint64_t)bestBase << 56u) | ((uint64_t)bestMul << 52u) | ((uint64_t)bestTable << 48u);
+        for (std::size_t i = 0u; i < 16u; i++) {
+            // column-major, first pixel in the most significant bits
+            const std::size_t p = (i % 4u) * 4u + (i / 4u);
+            bits |= (uint64_t)bestIndices[i] << (45u - 3u * p);
+        }
+        for (std::size_t i = 0u; i < 8u; i++)
+            value[i] = (uint8_t)(bits >> (56u - 8u * i));
+    }
+
+    unsigned fitSubblock(unsigned *table, uint8_t *indices, const int *base, const uint8_t *block, const std::size_t *pixels) NOTHROWS
+    {
+        unsigned bestErr = ~0u;
+        for (unsigned t = 0u; t < 8u; t++) {
+            uint8_t tindices[8];
+            unsigned err = 0u;
+            for (std::size_t i = 0u; i < 8u && err < bestErr; i++) {
+                const uint8_t *px = block + pixels[i] * 4u;
+                unsigned pixelErr = ~0u;
+                for (uint8_t j = 0u; j < 4u; j++) {
+                    const int m = colorModifiers[t][j];
+                    const int dr = clamp255(base[0] + m) - px[0];
+                    const int dg = clamp255(base[1] + m) - px[1];
+                    const int db = clamp255(base[2] + m) - px[2];
+                    const unsigned e = (unsigned)(dr * dr + dg * dg + db * db);
+                    if (e < pixelErr) {
+                        pixelErr = e;
+                        tindices[i] = j;
+                    }
+                }
+                err += pixelErr;
+            }
+            if (err < bestErr) {
+                bestErr = err;
+                *table = t;
+                memcpy(indices, tindices, 8u);
+            }
+        }
+        return bestErr;
+    }
+}
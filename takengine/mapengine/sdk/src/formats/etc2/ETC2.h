@@ -0,0 +1,30 @@
+#ifndef TAK_ENGINE_FORMATS_ETC2_ETC2_H_INCLUDED
+#define TAK_ENGINE_FORMATS_ETC2_ETC2_H_INCLUDED
+
+#include "port/Platform.h"
+#include "renderer/Bitmap2.h"
+#include "util/Error.h"
+#include "util/IO2.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Formats {
+            namespace ETC2 {
+                enum ETC2Algorithm
+                {
+                    /** 4bpp RGB; blocks are ETC1 compatible */
+                    TECA_ETC2_RGB8,
+                    /** 8bpp RGBA; EAC alpha block followed by RGB block */
+                    TECA_ETC2_RGBA8,
+                };
+
+                ENGINE_API Util::TAKErr ETC2_compress(Util::DataOutput2 &value, std::size_t *compressedSize, ETC2Algorithm *alg, const Renderer::Bitmap2 &bitmap) NOTHROWS;
+                ENGINE_API std::size_t ETC2_getCompressedSize(const Renderer::Bitmap2 &bitmap) NOTHROWS;
+                ENGINE_API Util::TAKErr ETC2_getCompressedSize(std::size_t *value, const ETC2Algorithm alg, const std::size_t width, const std::size_t height) NOTHROWS;
+                ENGINE_API ETC2Algorithm ETC2_getDefaultAlgorithm(const Renderer::Bitmap2::Format fmt) NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
@@ -2,14 +2,82 @@
 #include "GdalBitmapReader.h"
 
 #include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include "raster/gdal/GdalLibrary.h"
+#include "raster/gdal/GdalOverviewBuilder.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
 #include "util/Logging2.h"
 
 
 using namespace TAK::Engine::Formats::GDAL;
+using namespace TAK::Engine::Thread;
+
+using namespace atakmap::raster::gdal;
 using namespace TAK::Engine::Util;
 
 namespace
 {
+    struct BlockKey
+    {
+        int64_t reader;
+        int band;
+        int overview;
+        int blockX;
+        int blockY;
+        GDALDataType type;
+
+        bool operator<(const BlockKey &other) const NOTHROWS
+        {
+            if (reader != other.reader)
+                return reader < other.reader;
+            if (band != other.band)
+                return band < other.band;
+            if (overview != other.overview)
+                return overview < other.overview;
+            if (blockY != other.blockY)
+                return blockY < other.blockY;
+            if (blockX != other.blockX)
+                return blockX < other.blockX;
+            return type < other.type;
+        }
+    };
+
+    typedef std::shared_ptr<const std::vector<uint8_t>> BlockData;
+
+    /**
+     * Process-wide LRU cache of native source blocks. Blocks are held by
+     * shared pointer so that a reader may continue to sample a block that
+     * has been evicted.
+     */
+    class BlockCache
+    {
+    public:
+        BlockCache() NOTHROWS;
+    public:
+        BlockData get(const BlockKey &key) NOTHROWS;
+        void put(const BlockKey &key, const BlockData &data) NOTHROWS;
+        void setLimit(const std::size_t value) NOTHROWS;
+        /** evicts all blocks for the specified reader */
+        void purge(const int64_t reader) NOTHROWS;
+    private:
+        void evict() NOTHROWS;
+    private:
+        Mutex mutex;
+        std::list<std::pair<BlockKey, BlockData>> lru;
+        std::map<BlockKey, std::list<std::pair<BlockKey, BlockData>>::iterator> index;
+        std::size_t size;
+        std::size_t limit;
+    };
+
+    BlockCache &blockCache() NOTHROWS;
+
+    std::atomic<int64_t> nextBlockCacheId(1LL);
+
     class ColorTableInfo
     {
     public:
@@ -41,11 +109,30 @@ namespace
 
         std::vector<int> *bandRequest;
 
+        /** identifies the reader's blocks in the shared block cache */
+        int64_t blockCacheId;
+
         AbstractReaderImpl(GdalBitmapReader *gdalReader, std::vector<int> *bandRequest);
 
+        /**
+         * Returns the index of the coarsest overview that still provides
+         * at least the requested resolution, or <code>-1</code> for the
+         * full resolution bands.
+         */
+        int selectOverview(int srcW, int srcH, int dstW, int dstH) const;
+
+        /**
+         * Reads the requested bands, with the same semantics as
+         * <code>GDALDataset::RasterIO</code>. The window is mapped onto the
+         * selected overview and sampled from native blocks held in the
+         * shared block cache.
+         */
+        CPLErr readBlocks(int srcX, int srcY, int srcW, int srcH, void *data, int dstW, int dstH,
+                          GDALDataType bufType, int nPixelSpace, int nLineSpace, int nBandSpace);
+
     public:
         CPLErr read(int srcX, int srcY, int srcW, int srcH, int dstW, int dstH, uint8_t *data) override = 0;
-        virtual ~AbstractReaderImpl() = default;
+        virtual ~AbstractReaderImpl();
     };
 
     class ByteReaderImpl : public AbstractReaderImpl
@@ -123,23 +210,38 @@ namespace
     TAKErr getPixelSize(int &pixelSize, GdalBitmapReader::Format format);
 
     std::vector<GDALColorEntry> getPalette(GDALColorTable *colorTable);
+
+    GDALDataset *openDataset(const char *uri) NOTHROWS
+    {
+        GdalLibrary::ensureInitialized();
+        return (GDALDataset *) GDALOpen(uri, GA_ReadOnly);
+    }
 }
 
 GdalBitmapReader::GdalBitmapReader(const char *uri) NOTHROWS :
-    dataset((GDALDataset *) GDALOpen(uri, GA_ReadOnly)),
+    dataset(openDataset(uri)),
     width(0),
     height(0),
     numDataElements(0),
     alphaOrder(Format::ARGB),
     format(RGB), // guess, will be assigned
     impl(nullptr),
-    colorTable(nullptr)
+    colorTable(nullptr),
+    overviewGeneration(GdalOverviewBuilder::getGeneration())
 {
     if (nullptr != this->dataset) {
 
         this->width = this->dataset->GetRasterXSize();
         this->height = this->dataset->GetRasterYSize();
 
+        // low resolution reads of large imagery without overviews must
+        // sample the full resolution source; build them in the background.
+        // the reader picks them up once complete
+        if (ConfigOptions_getIntOptionOrDefault("gdal.build-overviews", 1) &&
+            GdalOverviewBuilder::isRequired(*this->dataset)) {
+            GdalOverviewBuilder::schedule(uri, nullptr);
+        }
+
         const int numBands = GDALGetRasterCount(this->dataset);
 
         int alphaBand = 0;
@@ -320,6 +422,7 @@ TAKErr GdalBitmapReader::read(int srcX, int srcY, int srcW, int srcH, int dstW,
 
     auto *data = static_cast<uint8_t *>(buf);
 
+    this->refreshOverviews();
     CPLErr success = this->impl->read(srcX, srcY, srcW, srcH, dstW, dstH, data);
 
     // expand lookup table values
@@ -397,9 +500,112 @@ TAKErr GdalBitmapReader::read(int srcX, int srcY, int srcW, int srcH, int dstW,
     return (success == CE_None) ? TE_Ok : TE_Err;
 }
 
+void GdalBitmapReader::setBlockCacheSize(std::size_t size) NOTHROWS {
+    blockCache().setLimit(size);
+}
+
+void GdalBitmapReader::refreshOverviews() NOTHROWS {
+    const int64_t generation = GdalOverviewBuilder::getGeneration();
+    if (generation == this->overviewGeneration)
+        return;
+    this->overviewGeneration = generation;
+    if (this->dataset->GetRasterBand(1)->GetOverviewCount() > 0)
+        return;
+
+    // overviews are discovered when the dataset is opened. blocks cached
+    // for the full resolution bands remain valid for the reopened dataset
+    GDALDataset *reopened = openDataset(this->dataset->GetDescription());
+    if (nullptr == reopened)
+        return;
+    if (reopened->GetRasterXSize() != this->width || reopened->GetRasterYSize() != this->height ||
+        reopened->GetRasterBand(1)->GetOverviewCount() == 0) {
+
+        GDALClose(reopened);
+        return;
+    }
+    GDALClose(this->dataset);
+    this->dataset = reopened;
+}
+
 
 namespace
 {
+    BlockCache::BlockCache() NOTHROWS :
+        size(0u),
+        limit(64u * 1024u * 1024u)
+    {}
+
+    BlockData BlockCache::get(const BlockKey &key) NOTHROWS {
+        Lock lock(mutex);
+        auto entry = index.find(key);
+        if (entry == index.end())
+            return BlockData();
+        lru.splice(lru.begin(), lru, entry->second);
+        return entry->second->second;
+    }
+
+    void BlockCache::put(const BlockKey &key, const BlockData &data) NOTHROWS {
+        Lock lock(mutex);
+        if (index.find(key) != index.end())
+            return;
+        lru.push_front(std::make_pair(key, data));
+        index[key] = lru.begin();
+        size += data->size();
+        evict();
+    }
+
+    void BlockCache::setLimit(const std::size_t value) NOTHROWS {
+        Lock lock(mutex);
+        limit = value;
+        evict();
+    }
+
+    void BlockCache::purge(const int64_t reader) NOTHROWS {
+        Lock lock(mutex);
+        for (auto it = lru.begin(); it != lru.end();) {
+            if (it->first.reader == reader) {
+                size -= it->second->size();
+                index.erase(it->first);
+                it = lru.erase(it);
+            }
+            else {
+                it++;
+            }
+        }
+    }
+
+    void BlockCache::evict() NOTHROWS {
+        while (size > limit && !lru.empty()) {
+            size -= lru.back().second->size();
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+
+    BlockCache &blockCache() NOTHROWS {
+        static BlockCache cache;
+        return cache;
+    }
+
+    CPLErr getBlock(BlockData &value, GDALRasterBand &band, const BlockKey &key, int blockW, int blockH, int typeSize) {
+        value = blockCache().get(key);
+        if (value)
+            return CE_None;
+
+        // edge blocks are clipped to the raster
+        const int x = key.blockX * blockW;
+        const int y = key.blockY * blockH;
+        const int w = std::min(blockW, band.GetXSize() - x);
+        const int h = std::min(blockH, band.GetYSize() - y);
+        std::shared_ptr<std::vector<uint8_t>> block(new std::vector<uint8_t>((std::size_t)w * (std::size_t)h * (std::size_t)typeSize));
+        CPLErr err = band.RasterIO(GF_Read, x, y, w, h, block->data(), w, h, key.type, 0, 0, nullptr);
+        if (err != CE_None)
+            return err;
+        value = block;
+        blockCache().put(key, value);
+        return CE_None;
+    }
+
     ColorTableInfo::ColorTableInfo(const GDALColorEntry *lut, size_t count)
         : transparentPixel(-999),
           format(GdalBitmapReader::ARGB),
@@ -497,7 +703,8 @@ namespace
 
     AbstractReaderImpl::AbstractReaderImpl(GdalBitmapReader *gdalReader, std::vector<int> *bandRequest)
         : gdalReader(gdalReader),
-          bandRequest(bandRequest) {
+          bandRequest(bandRequest),
+          blockCacheId(nextBlockCacheId++) {
 
         this->nbpp = GDALGetDataTypeSize(gdalReader->getDataset()->GetRasterBand(1)->GetRasterDataType());
         if (strcmp(gdalReader->getDataset()->GetDriver()->GetDescription(), "NITF") == 0) {
@@ -510,6 +717,104 @@ namespace
         this->scaleMaxValue = (double)(0xFFFFFFFFUL >> (32 - this->abpp));
     }
 
+    AbstractReaderImpl::~AbstractReaderImpl() {
+        blockCache().purge(this->blockCacheId);
+    }
+
+    int AbstractReaderImpl::selectOverview(int srcW, int srcH, int dstW, int dstH) const {
+        GDALDataset *dataset = gdalReader->getDataset();
+        const double decimation = std::min((double)srcW / (double)dstW, (double)srcH / (double)dstH);
+        GDALRasterBand *first = dataset->GetRasterBand((*this->bandRequest)[0]);
+
+        int retval = -1;
+        double selected = 1.0;
+        for (int i = 0; i < first->GetOverviewCount(); i++) {
+            GDALRasterBand *overview = first->GetOverview(i);
+            if (overview == nullptr || overview->GetXSize() <= 0)
+                continue;
+            // overviews are not required to be ordered
+            const double overviewDecimation = (double)gdalReader->getWidth() / (double)overview->GetXSize();
+            if (overviewDecimation > decimation || overviewDecimation <= selected)
+                continue;
+
+            // the overview must be consistent across all of the requested bands
+            bool consistent = true;
+            for (std::size_t b = 1u; b < this->bandRequest->size(); b++) {
+                GDALRasterBand *band = dataset->GetRasterBand((*this->bandRequest)[b]);
+                GDALRasterBand *bandOverview = (i < band->GetOverviewCount()) ? band->GetOverview(i) : nullptr;
+                consistent &= (bandOverview != nullptr &&
+                               bandOverview->GetXSize() == overview->GetXSize() &&
+                               bandOverview->GetYSize() == overview->GetYSize());
+            }
+            if (!consistent)
+                continue;
+
+            retval = i;
+            selected = overviewDecimation;
+        }
+        return retval;
+    }
+
+    CPLErr AbstractReaderImpl::readBlocks(int srcX, int srcY, int srcW, int srcH, void *data, int dstW, int dstH,
+                                          GDALDataType bufType, int nPixelSpace, int nLineSpace, int nBandSpace) {
+        GDALDataset *dataset = gdalReader->getDataset();
+        const int typeSize = GDALGetDataTypeSize(bufType) / 8;
+        const int overview = this->selectOverview(srcW, srcH, dstW, dstH);
+
+        std::vector<int> columns(dstW);
+        for (std::size_t b = 0u; b < this->bandRequest->size(); b++) {
+            GDALRasterBand *band = dataset->GetRasterBand((*this->bandRequest)[b]);
+            if (overview >= 0)
+                band = band->GetOverview(overview);
+
+            const int bandW = band->GetXSize();
+            const int bandH = band->GetYSize();
+            const double scaleX = (double)bandW / (double)gdalReader->getWidth();
+            const double scaleY = (double)bandH / (double)gdalReader->getHeight();
+            int blockW;
+            int blockH;
+            band->GetBlockSize(&blockW, &blockH);
+
+            // nearest neighbor, sampling at destination pixel centers
+            for (int x = 0; x < dstW; x++) {
+                const int sx = (int)((srcX + (((double)x + 0.5) * (double)srcW / (double)dstW)) * scaleX);
+                columns[x] = std::max(0, std::min(sx, bandW - 1));
+            }
+
+            BlockKey key;
+            key.reader = this->blockCacheId;
+            key.band = (*this->bandRequest)[b];
+            key.overview = overview;
+            key.type = bufType;
+
+            uint8_t *bandData = static_cast<uint8_t *>(data) + (b * nBandSpace);
+            for (int y = 0; y < dstH; y++) {
+                int sy = (int)((srcY + (((double)y + 0.5) * (double)srcH / (double)dstH)) * scaleY);
+                sy = std::max(0, std::min(sy, bandH - 1));
+                key.blockY = sy / blockH;
+                key.blockX = -1;
+
+                BlockData block;
+                int blockCols = 0;
+                const uint8_t *blockRow = nullptr;
+                uint8_t *dst = bandData + (y * nLineSpace);
+                for (int x = 0; x < dstW; x++) {
+                    const int sx = columns[x];
+                    if ((sx / blockW) != key.blockX) {
+                        key.blockX = sx / blockW;
+                        CPLErr err = getBlock(block, *band, key, blockW, blockH, typeSize);
+                        if (err != CE_None)
+                            return err;
+                        blockCols = std::min(blockW, bandW - (key.blockX * blockW));
+                        blockRow = block->data() + ((std::size_t)(sy - (key.blockY * blockH)) * blockCols * typeSize);
+                    }
+                    memcpy(dst + (x * nPixelSpace), blockRow + ((sx - (key.blockX * blockW)) * typeSize), typeSize);
+                }
+            }
+        }
+        return CE_None;
+    }
+
     ByteReaderImpl::ByteReaderImpl(GdalBitmapReader *gdalReader, std::vector<int> *bandRequest)
         : AbstractReaderImpl(gdalReader, bandRequest) { }
 
@@ -540,12 +845,10 @@ namespace
           )
         */
 
-        CPLErr success = gdalReader->getDataset()->RasterIO(GF_Read,
-                                                            srcX, srcY, srcW, srcH, data,
-                                                            dstW, dstH,
-                                                            GDT_Byte,
-                                                            static_cast<int>(this->bandRequest->size()), this->bandRequest->data(),
-                                                            nPixelSpace, nLineSpace, nBandSpace);
+        CPLErr success = this->readBlocks(srcX, srcY, srcW, srcH, data,
+                                          dstW, dstH,
+                                          GDT_Byte,
+                                          nPixelSpace, nLineSpace, nBandSpace);
         // scale if necessary
         if (success == CE_None && this->abpp < this->nbpp)
             scaleABPP(data, dstW * dstH * numDataElements, this->scaleMaxValue);
@@ -567,11 +870,10 @@ namespace
 
         std::vector<int16_t> arr(numSamples, 0);
 
-        CPLErr success = gdalReader->getDataset()->RasterIO(GF_Read, srcX, srcY, srcW, srcH, data,
-                                                            dstW, dstH,
-                                                            GDT_Int16,
-                                                            static_cast<int>(this->bandRequest->size()), this->bandRequest->data(),
-                                                            nPixelSpace, nLineSpace, nBandSpace);
+        CPLErr success = this->readBlocks(srcX, srcY, srcW, srcH, &arr[0],
+                                          dstW, dstH,
+                                          GDT_Int16,
+                                          nPixelSpace, nLineSpace, nBandSpace);
         if (success == CE_None) {
             if (this->abpp < this->nbpp)
                 scaleABPP(&arr[0], data, numSamples, this->scaleMaxValue);
@@ -596,11 +898,10 @@ namespace
 
         std::vector<int32_t> arr(numSamples);
 
-        CPLErr success = gdalReader->getDataset()->RasterIO(GF_Read, srcX, srcY, srcW, srcH, data,
-                                                            dstW, dstH,
-                                                            GDT_Int32,
-                                                            static_cast<int>(this->bandRequest->size()), this->bandRequest->data(),
-                                                            nPixelSpace, nLineSpace, nBandSpace);
+        CPLErr success = this->readBlocks(srcX, srcY, srcW, srcH, &arr[0],
+                                          dstW, dstH,
+                                          GDT_Int32,
+                                          nPixelSpace, nLineSpace, nBandSpace);
         if (success == CPLErr::CE_None) {
             if (this->abpp < this->nbpp)
                 scaleABPP(&arr[0], data, numSamples, this->scaleMaxValue);
@@ -625,11 +926,10 @@ namespace
 
         std::vector<float> arr(numSamples, 0.f);
 
-        CPLErr success = gdalReader->getDataset()->RasterIO(GF_Read, srcX, srcY, srcW, srcH, data,
-                                                            dstW, dstH,
-                                                            GDT_Float32,
-                                                            static_cast<int>(this->bandRequest->size()), this->bandRequest->data(),
-                                                            nPixelSpace, nLineSpace, nBandSpace);
+        CPLErr success = this->readBlocks(srcX, srcY, srcW, srcH, &arr[0],
+                                          dstW, dstH,
+                                          GDT_Float32,
+                                          nPixelSpace, nLineSpace, nBandSpace);
         if (success == CPLErr::CE_None)
             scale(&arr[0], data, numSamples);
         return success;
@@ -650,11 +950,10 @@ namespace
 
         std::vector<double> arr(numSamples, 0.0);
 
-        CPLErr success = gdalReader->getDataset()->RasterIO(GF_Read, srcX, srcY, srcW, srcH, data,
-                                                            dstW, dstH,
-                                                            GDT_Float64,
-                                                            static_cast<int>(this->bandRequest->size()), this->bandRequest->data(),
-                                                            nPixelSpace, nLineSpace, nBandSpace);
+        CPLErr success = this->readBlocks(srcX, srcY, srcW, srcH, &arr[0],
+                                          dstW, dstH,
+                                          GDT_Float64,
+                                          nPixelSpace, nLineSpace, nBandSpace);
         if (success == CPLErr::CE_None)
             scale(&arr[0], data, numSamples);
         return success;
@@ -3,6 +3,7 @@
 
 #include "gdal_priv.h"
 
+#include <cstddef>
 #include <cstdint>
 
 #include "port/Platform.h"
@@ -55,6 +56,20 @@ namespace TAK {
                 Util::TAKErr read(int srcX, int srcY, int srcW, int srcH, int dstW,
                                   int dstH, void *buf, size_t byteCount) NOTHROWS;
 
+                /**
+                 * Sets the budget, in bytes, for the source block cache
+                 * shared by all readers in the process. Blocks are evicted
+                 * least recently used first.
+                 */
+                static void setBlockCacheSize(std::size_t size) NOTHROWS;
+
+                private:
+                /**
+                 * Reopens the dataset if overviews have been built for it
+                 * since it was opened.
+                 */
+                void refreshOverviews() NOTHROWS;
+
                 protected:
                 GDALDataset *dataset;
                 int width;
@@ -71,6 +86,9 @@ namespace TAK {
 
                 ColorTableInfo *colorTable;
 
+                /** the overview builder generation last observed */
+                int64_t overviewGeneration;
+
                 };
             }
         }
@@ -5,6 +5,7 @@
 #include <gdal.h>
 
 #include "raster/gdal/GdalDatasetProjection.h"
+#include "raster/gdal/GdalLibrary.h"
 #include "util/Memory.h"
 
 using namespace TAK::Engine::Core;
@@ -32,6 +33,7 @@ namespace
 TAKErr TAK::Engine::Formats::GDAL::GdalDatasetProjection2_create(DatasetProjection2Ptr &value, const char *path) NOTHROWS
 {
     TAKErr code(TE_Ok);
+    atakmap::raster::gdal::GdalLibrary::ensureInitialized();
     GDALDatasetHPtr dataset(GDALOpen(path, GA_ReadOnly), GDALClose);
     if (!dataset.get())
         return TE_InvalidArg;
@@ -13,6 +13,20 @@ namespace {
 
 TAKErr TAK::Engine::Formats::GLTF::GLTF_load(ScenePtr& scenePtr, DataInput2* input, const char* baseURI) NOTHROWS {
 
+    // memory backed input is parsed in place
+    if (auto *meminput = dynamic_cast<MemoryInput2 *>(input)) {
+        const uint8_t *data;
+        std::size_t off;
+        std::size_t rem;
+        if (meminput->getData(&data) == TE_Ok && meminput->tell(&off) == TE_Ok && meminput->remaining(&rem) == TE_Ok) {
+            if (!rem)
+                return TE_Unsupported;
+            TAKErr code = GLTF_load(scenePtr, data + off, rem, baseURI);
+            meminput->skip(rem);
+            return code;
+        }
+    }
+
     std::vector<uint8_t> binary;
     TAKErr code = readFully(binary, input);
     if (code != TE_Ok)
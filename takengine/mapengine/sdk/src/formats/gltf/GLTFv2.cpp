@@ -2,7 +2,9 @@
 #include "formats/gltf/GLTF.h"
 #include "model/Scene.h"
 #include "formats/gltf/GLTF.h"
+#include "formats/gltf/MeshoptDecoder.h"
 #include "port/STLVectorAdapter.h"
+#include "util/Logging2.h"
 #include "util/MemBuffer2.h"
 #include "model/MeshBuilder.h"
 #include "port/StringBuilder.h"
@@ -97,11 +99,23 @@ namespace {
         std::set<int> usedImages;
         std::vector<MemBufferArg> memBufferArgs;
         std::vector<MemBufferArg> meshBufferArgs;
+        // vertex data packed from attributes that could not be used in place
+        std::vector<std::vector<uint8_t>> packedBuffers;
     };
 
+    struct AttributeSource {
+        VertexArray* array;
+        const tinygltf::Accessor* accessor;
+        int buffer;
+        std::size_t elementSize;
+    };
+
+    TAKErr checkExtensions(const tinygltf::Model &model) NOTHROWS;
+    TAKErr decodeMeshopt(tinygltf::Model &model) NOTHROWS;
     TAKErr buildScene(ScenePtr &result, const char *baseURI, tinygltf::Model &model) NOTHROWS;
     TAKErr buildNode(std::shared_ptr<GLTFSceneNode> &result, BuildState &state, GLTFSceneNode*parent, tinygltf::Model &model, tinygltf::Scene &scene, tinygltf::Node &node) NOTHROWS;
     TAKErr buildMesh(std::shared_ptr<Mesh> &result, BuildState& state, tinygltf::Model& model, tinygltf::Scene& scene, tinygltf::Node& node, tinygltf::Mesh &mesh, tinygltf::Primitive &prim) NOTHROWS;
+    TAKErr packAttributes(const void** result, BuildState& state, const tinygltf::Model& model, const std::vector<AttributeSource>& sources, const std::size_t vertCount) NOTHROWS;
     void mergeAABB(Envelope2& dst, const Envelope2& src) NOTHROWS;
 }
 
@@ -268,6 +282,11 @@ TAKErr TAK::Engine::Formats::GLTF::GLTF_loadV2(ScenePtr &result, const uint8_t *
     std::string err;
     std::string warn;
     if (gltf.LoadBinaryFromMemory(&model, &err, &warn, binary, static_cast<unsigned int>(len), baseURI)) {
+        code = checkExtensions(model);
+        TE_CHECKRETURN_CODE(code);
+        // compressed buffer views are decoded into buffers that the meshes reference in place
+        code = decodeMeshopt(model);
+        TE_CHECKRETURN_CODE(code);
         code = buildScene(result, baseURI, model);
     }
     //__android_log_print(ANDROID_LOG_VERBOSE, "Cesium3DTiles", "err=%s warn=%s", err.c_str(), warn.c_str());
@@ -469,6 +488,92 @@ unsigned int GLTFScene::getProperties() const NOTHROWS {
 
 namespace {
 
+    TAKErr checkExtensions(const tinygltf::Model &model) NOTHROWS {
+        for (const std::string &ext : model.extensionsRequired) {
+#ifndef TINYGLTF_ENABLE_DRACO
+            // Draco primitives are decoded by tinygltf when built against the Draco library
+            if (ext == "KHR_draco_mesh_compression") {
+                Logger_log(TELL_Warning, "GLTF: KHR_draco_mesh_compression is not supported in this build");
+                return TE_Unsupported;
+            }
+#endif
+            (void)ext;
+        }
+        return TE_Ok;
+    }
+
+    TAKErr decodeMeshopt(tinygltf::Model &model) NOTHROWS {
+        TAKErr code = TE_Ok;
+        const std::size_t numBufferViews = model.bufferViews.size();
+        for (std::size_t i = 0u; i < numBufferViews; i++) {
+            auto ext = model.bufferViews[i].extensions.find("EXT_meshopt_compression");
+            if (ext == model.bufferViews[i].extensions.end() || !ext->second.IsObject())
+                continue;
+
+            const tinygltf::Value &meshopt = ext->second;
+            if (!meshopt.Get("buffer").IsNumber() || !meshopt.Get("byteLength").IsNumber() ||
+                !meshopt.Get("byteStride").IsNumber() || !meshopt.Get("count").IsNumber() ||
+                !meshopt.Get("mode").IsString()) {
+
+                return TE_InvalidArg;
+            }
+
+            const int buffer = static_cast<int>(meshopt.Get("buffer").GetNumberAsInt());
+            const auto byteOffset = meshopt.Get("byteOffset").IsNumber() ? static_cast<std::size_t>(meshopt.Get("byteOffset").GetNumberAsDouble()) : 0u;
+            const auto byteLength = static_cast<std::size_t>(meshopt.Get("byteLength").GetNumberAsDouble());
+            const auto byteStride = static_cast<std::size_t>(meshopt.Get("byteStride").GetNumberAsInt());
+            const auto count = static_cast<std::size_t>(meshopt.Get("count").GetNumberAsDouble());
+            if (buffer < 0 || buffer >= static_cast<int>(model.buffers.size()))
+                return TE_InvalidArg;
+            if (byteOffset + byteLength > model.buffers[buffer].data.size())
+                return TE_InvalidArg;
+
+            MeshoptMode mode;
+            const std::string &modeStr = meshopt.Get("mode").Get<std::string>();
+            if (modeStr == "ATTRIBUTES")
+                mode = TEMM_Attributes;
+            else if (modeStr == "TRIANGLES")
+                mode = TEMM_Triangles;
+            else if (modeStr == "INDICES")
+                mode = TEMM_Indices;
+            else
+                return TE_Unsupported;
+
+            MeshoptFilter filter = TEMF_None;
+            if (meshopt.Get("filter").IsString()) {
+                const std::string &filterStr = meshopt.Get("filter").Get<std::string>();
+                if (filterStr == "OCTAHEDRAL")
+                    filter = TEMF_Octahedral;
+                else if (filterStr == "QUATERNION")
+                    filter = TEMF_Quaternion;
+                else if (filterStr == "EXPONENTIAL")
+                    filter = TEMF_Exponential;
+                else if (filterStr != "NONE")
+                    return TE_Unsupported;
+            }
+
+            TE_BEGIN_TRAP() {
+                tinygltf::Buffer decoded;
+                decoded.data.resize(count * byteStride);
+                if (!decoded.data.empty()) {
+                    code = MeshoptDecoder_decode(&decoded.data[0], count, byteStride, &model.buffers[buffer].data[0] + byteOffset, byteLength, mode, filter);
+                    if (code != TE_Ok)
+                        Logger_log(TELL_Warning, "GLTF: failed to decode EXT_meshopt_compression buffer view %u", (unsigned)i);
+                }
+                if (code == TE_Ok) {
+                    // the view now addresses the decoded data
+                    tinygltf::BufferView &bv = model.bufferViews[i];
+                    bv.buffer = static_cast<int>(model.buffers.size());
+                    bv.byteOffset = 0u;
+                    bv.byteLength = decoded.data.size();
+                    model.buffers.push_back(std::move(decoded));
+                }
+            } TE_END_TRAP(code);
+            TE_CHECKRETURN_CODE(code);
+        }
+        return code;
+    }
+
     void mergeAABB(Envelope2& dst, const Envelope2& src) NOTHROWS {
         if (src.minX < dst.minX)
             dst.minX = src.minX;
@@ -525,6 +630,9 @@ namespace {
         for (int image : state.usedImages) {
             buffers.push_back(std::move(model.images[image].image));
         }
+        for (std::vector<uint8_t>& packed : state.packedBuffers) {
+            buffers.push_back(std::move(packed));
+        }
 
         return GLTFScene_create(result, root, std::move(buffers));
     }
@@ -648,11 +756,14 @@ namespace {
             if (code != TE_Ok)
                 return code;
 
-            indicesData = &b.data[0] + bv.byteOffset;
+            indicesData = &b.data[0] + bv.byteOffset + indices.byteOffset;
             indexCount = indices.count;
+            state.usedBuffers.insert(bv.buffer);
         }
 
         size_t numBuffers = 0;
+        std::vector<AttributeSource> sources;
+        int vertsBuffer = -1;
 
         for (const std::pair<std::string, int>& attr : prim.attributes) {
 
@@ -670,22 +781,44 @@ namespace {
             if (vertArray == nullptr)
                 continue;
 
-            VertexAttribute vertAttr = vertArrayPair.first;
+            if (accessor.sparse.isSparse)
+                return TE_Unsupported;
+
             code = GLTF_dataTypeForAccessorComponentTypeV2(vertArray->type, accessor.componentType);
             if (code != TE_Ok)
                 return code;
 
-            int accessorComponentCount = GLTF_componentCountForAccessorType(accessor.type);
-            vertArray->stride = accessor.ByteStride(bv);
+            const int stride = accessor.ByteStride(bv);
+            if (stride <= 0)
+                return TE_Unsupported;
+            vertArray->stride = static_cast<std::size_t>(stride);
             vertArray->offset = bv.byteOffset + accessor.byteOffset;
+            sources.push_back(AttributeSource { vertArray, &accessor, bv.buffer,
+                DataType_size(vertArray->type) * static_cast<std::size_t>(GLTF_componentCountForAccessorType(accessor.type)) });
 
             if (vertArray == &vertLayout.position) {
-                verts = &b.data[0];
+                vertsBuffer = bv.buffer;
                 vertCount = accessor.count;
                 GLTF_setAABBMinMax(aabb, accessor.minValues, accessor.maxValues);
             }
         }
 
+        if (vertsBuffer >= 0) {
+            // the accessors are used in place when they all address the position buffer, which is
+            // the common case; otherwise the attributes are packed into a buffer owned by the scene
+            bool inPlace = true;
+            for (const AttributeSource& src : sources) {
+                const std::size_t end = src.array->offset + src.array->stride * (vertCount ? vertCount - 1u : 0u) + src.elementSize;
+                inPlace &= (src.buffer == vertsBuffer) && (src.accessor->count >= vertCount) && (end <= model.buffers[src.buffer].data.size());
+            }
+            if (inPlace) {
+                verts = &model.buffers[vertsBuffer].data[0];
+            } else {
+                code = packAttributes(&verts, state, model, sources, vertCount);
+                TE_CHECKRETURN_CODE(code);
+            }
+        }
+
         vertLayout.interleaved = true;
         
         MeshPtr meshPtr(nullptr, nullptr);
@@ -702,4 +835,32 @@ namespace {
         }
         return code;
     }
+
+    TAKErr packAttributes(const void** result, BuildState& state, const tinygltf::Model& model, const std::vector<AttributeSource>& sources, const std::size_t vertCount) NOTHROWS {
+        // attribute blocks are 4-byte aligned
+        std::size_t size = 0u;
+        for (const AttributeSource& src : sources)
+            size += (src.elementSize * vertCount + 3u) & ~static_cast<std::size_t>(3u);
+
+        TAKErr code = TE_Ok;
+        TE_BEGIN_TRAP() {
+            std::vector<uint8_t> packed(size);
+            std::size_t offset = 0u;
+            for (const AttributeSource& src : sources) {
+                const std::vector<uint8_t>& data = model.buffers[src.buffer].data;
+                const std::size_t count = std::min(vertCount, src.accessor->count);
+                if (count && src.array->offset + src.array->stride * (count - 1u) + src.elementSize > data.size())
+                    return TE_IllegalState;
+                for (std::size_t i = 0u; i < count; i++)
+                    memcpy(&packed[offset + i * src.elementSize], &data[src.array->offset + i * src.array->stride], src.elementSize);
+
+                src.array->offset = offset;
+                src.array->stride = src.elementSize;
+                offset += (src.elementSize * vertCount + 3u) & ~static_cast<std::size_t>(3u);
+            }
+            state.packedBuffers.push_back(std::move(packed));
+            *result = state.packedBuffers.back().empty() ? nullptr : &state.packedBuffers.back()[0];
+        } TE_END_TRAP(code);
+        return code;
+    }
 }
@@ -0,0 +1,438 @@
+#include "formats/gltf/MeshoptDecoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace TAK::Engine::Formats::GLTF;
+
+using namespace TAK::Engine::Util;
+
+// codec constants per the meshoptimizer bitstream specification
+#define MESHOPT_VERTEX_HEADER 0xA0u
+#define MESHOPT_TRIANGLES_HEADER 0xE0u
+#define MESHOPT_INDICES_HEADER 0xD0u
+#define MESHOPT_VERTEX_BLOCK_SIZE_BYTES 8192u
+#define MESHOPT_VERTEX_BLOCK_MAX_SIZE 256u
+#define MESHOPT_BYTE_GROUP_SIZE 16u
+// a byte group reads at most 24 bytes; the encoded tail guarantees this many remain
+#define MESHOPT_BYTE_GROUP_DECODE_LIMIT 24u
+#define MESHOPT_VERTEX_TAIL_MIN_SIZE 32u
+#define MESHOPT_TRIANGLES_TAIL_SIZE 16u
+#define MESHOPT_INDICES_TAIL_SIZE 4u
+
+namespace {
+    TAKErr decodeVertexBuffer(uint8_t *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen) NOTHROWS;
+    const uint8_t *decodeVertexBlock(const uint8_t *data, const uint8_t *end, uint8_t *dst, const std::size_t count, const std::size_t stride, uint8_t *last) NOTHROWS;
+    const uint8_t *decodeBytes(const uint8_t *data, const uint8_t *end, uint8_t *dst, const std::size_t len) NOTHROWS;
+    const uint8_t *decodeBytesGroup(const uint8_t *data, uint8_t *dst, const int bitslog2) NOTHROWS;
+
+    TAKErr decodeTriangles(uint8_t *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen) NOTHROWS;
+    TAKErr decodeIndices(uint8_t *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen) NOTHROWS;
+
+    template<typename T>
+    void filterOctahedral(uint8_t *data, const std::size_t count) NOTHROWS;
+    void filterQuaternion(uint8_t *data, const std::size_t count) NOTHROWS;
+    void filterExponential(uint8_t *data, const std::size_t count) NOTHROWS;
+
+    inline uint32_t decodeVByte(const uint8_t *&data) NOTHROWS
+    {
+        const uint8_t lead = *data++;
+        if (lead < 128u)
+            return lead;
+        uint32_t result = lead & 127u;
+        uint32_t shift = 7u;
+        for (int i = 0; i < 4; i++) {
+            const uint8_t group = *data++;
+            result |= static_cast<uint32_t>(group & 127u) << shift;
+            shift += 7u;
+            if (group < 128u)
+                break;
+        }
+        return result;
+    }
+    inline uint32_t decodeIndex(const uint8_t *&data, const uint32_t last) NOTHROWS
+    {
+        const uint32_t v = decodeVByte(data);
+        const uint32_t d = (v >> 1u) ^ static_cast<uint32_t>(-static_cast<int32_t>(v & 1u));
+        return last + d;
+    }
+    inline void writeIndex(uint8_t *dst, const std::size_t i, const std::size_t stride, const uint32_t index) NOTHROWS
+    {
+        if (stride == 2u) {
+            const auto v = static_cast<uint16_t>(index);
+            memcpy(dst + i * 2u, &v, 2u);
+        } else {
+            memcpy(dst + i * 4u, &index, 4u);
+        }
+    }
+    inline void pushEdge(uint32_t (&fifo)[16][2], const uint32_t a, const uint32_t b, std::size_t &offset) NOTHROWS
+    {
+        fifo[offset][0] = a;
+        fifo[offset][1] = b;
+        offset = (offset + 1u) & 15u;
+    }
+    inline void pushVertex(uint32_t (&fifo)[16], const uint32_t v, std::size_t &offset, const bool cond = true) NOTHROWS
+    {
+        fifo[offset] = v;
+        offset = (offset + (cond ? 1u : 0u)) & 15u;
+    }
+}
+
+TAKErr TAK::Engine::Formats::GLTF::MeshoptDecoder_decode(void *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen, const MeshoptMode mode, const MeshoptFilter filter) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!dst || !src)
+        return TE_InvalidArg;
+
+    auto *data = static_cast<uint8_t *>(dst);
+    switch (mode) {
+    case TEMM_Attributes :
+        if (!stride || stride > MESHOPT_VERTEX_BLOCK_MAX_SIZE || (stride % 4u))
+            return TE_InvalidArg;
+        code = decodeVertexBuffer(data, count, stride, src, srcLen);
+        break;
+    case TEMM_Triangles :
+        if ((stride != 2u && stride != 4u) || (count % 3u) || filter != TEMF_None)
+            return TE_InvalidArg;
+        code = decodeTriangles(data, count, stride, src, srcLen);
+        break;
+    case TEMM_Indices :
+        if ((stride != 2u && stride != 4u) || filter != TEMF_None)
+            return TE_InvalidArg;
+        code = decodeIndices(data, count, stride, src, srcLen);
+        break;
+    default :
+        return TE_InvalidArg;
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    switch (filter) {
+    case TEMF_None :
+        break;
+    case TEMF_Octahedral :
+        if (stride == 4u)
+            filterOctahedral<int8_t>(data, count);
+        else if (stride == 8u)
+            filterOctahedral<int16_t>(data, count);
+        else
+            return TE_InvalidArg;
+        break;
+    case TEMF_Quaternion :
+        if (stride != 8u)
+            return TE_InvalidArg;
+        filterQuaternion(data, count);
+        break;
+    case TEMF_Exponential :
+        filterExponential(data, count * (stride / 4u));
+        break;
+    default :
+        return TE_InvalidArg;
+    }
+
+    return code;
+}
+
+namespace {
+    TAKErr decodeVertexBuffer(uint8_t *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen) NOTHROWS
+    {
+        if (srcLen < 1u)
+            return TE_IllegalState;
+        if ((src[0] & 0xF0u) != MESHOPT_VERTEX_HEADER)
+            return TE_IllegalState;
+        if (src[0] & 0x0Fu)
+            return TE_Unsupported;
+
+        const uint8_t *data = src + 1u;
+        const uint8_t *end = src + srcLen;
+
+        // the first vertex is stored at the end of the padded tail
+        const std::size_t tailSize = std::max<std::size_t>(stride, MESHOPT_VERTEX_TAIL_MIN_SIZE);
+        if (static_cast<std::size_t>(end - data) < tailSize)
+            return TE_IllegalState;
+        uint8_t last[MESHOPT_VERTEX_BLOCK_MAX_SIZE];
+        memcpy(last, end - stride, stride);
+
+        // blocks fit the transpose buffer and are a multiple of the byte group size
+        std::size_t blockSize = (MESHOPT_VERTEX_BLOCK_SIZE_BYTES / stride) & ~static_cast<std::size_t>(MESHOPT_BYTE_GROUP_SIZE - 1u);
+        blockSize = std::min<std::size_t>(blockSize, MESHOPT_VERTEX_BLOCK_MAX_SIZE);
+
+        for (std::size_t i = 0u; i < count; i += blockSize) {
+            data = decodeVertexBlock(data, end, dst + i * stride, std::min(blockSize, count - i), stride, last);
+            if (!data)
+                return TE_IllegalState;
+        }
+
+        if (static_cast<std::size_t>(end - data) != tailSize)
+            return TE_IllegalState;
+        return TE_Ok;
+    }
+    const uint8_t *decodeVertexBlock(const uint8_t *data, const uint8_t *end, uint8_t *dst, const std::size_t count, const std::size_t stride, uint8_t *last) NOTHROWS
+    {
+        uint8_t deltas[MESHOPT_VERTEX_BLOCK_MAX_SIZE];
+        const std::size_t alignedCount = (count + MESHOPT_BYTE_GROUP_SIZE - 1u) & ~static_cast<std::size_t>(MESHOPT_BYTE_GROUP_SIZE - 1u);
+
+        // each byte of the vertex is stored as a separate stream of zigzag deltas
+        for (std::size_t k = 0u; k < stride; k++) {
+            data = decodeBytes(data, end, deltas, alignedCount);
+            if (!data)
+                return nullptr;
+
+            uint8_t p = last[k];
+            for (std::size_t i = 0u; i < count; i++) {
+                const uint8_t d = deltas[i];
+                const auto v = static_cast<uint8_t>(((d & 1u) ? ~(d >> 1u) : (d >> 1u)) + p);
+                dst[i * stride + k] = v;
+                p = v;
+            }
+        }
+
+        memcpy(last, dst + (count - 1u) * stride, stride);
+        return data;
+    }
+    const uint8_t *decodeBytes(const uint8_t *data, const uint8_t *end, uint8_t *dst, const std::size_t len) NOTHROWS
+    {
+        // 2-bit width codes for each group, four per byte
+        const uint8_t *header = data;
+        const std::size_t headerSize = (len / MESHOPT_BYTE_GROUP_SIZE + 3u) / 4u;
+        if (static_cast<std::size_t>(end - data) < headerSize)
+            return nullptr;
+        data += headerSize;
+
+        for (std::size_t i = 0u; i < len; i += MESHOPT_BYTE_GROUP_SIZE) {
+            if (static_cast<std::size_t>(end - data) < MESHOPT_BYTE_GROUP_DECODE_LIMIT)
+                return nullptr;
+            const std::size_t group = i / MESHOPT_BYTE_GROUP_SIZE;
+            const int bitslog2 = (header[group / 4u] >> ((group % 4u) * 2u)) & 3;
+            data = decodeBytesGroup(data, dst + i, bitslog2);
+        }
+        return data;
+    }
+    const uint8_t *decodeBytesGroup(const uint8_t *data, uint8_t *dst, const int bitslog2) NOTHROWS
+    {
+        switch (bitslog2) {
+        case 0 :
+            memset(dst, 0, MESHOPT_BYTE_GROUP_SIZE);
+            return data;
+        case 1 :
+        case 2 :
+        {
+            // packed 2 or 4 bit values, most significant first; the all
+            // ones value escapes to a full byte following the packed values
+            const unsigned bits = bitslog2 == 1 ? 2u : 4u;
+            const unsigned escape = (1u << bits) - 1u;
+            const std::size_t packedSize = MESHOPT_BYTE_GROUP_SIZE * bits / 8u;
+            const uint8_t *escaped = data + packedSize;
+            for (std::size_t i = 0u; i < MESHOPT_BYTE_GROUP_SIZE; i++) {
+                const unsigned shift = 8u - bits - static_cast<unsigned>((i * bits) % 8u);
+                const unsigned enc = (data[(i * bits) / 8u] >> shift) & escape;
+                dst[i] = (enc == escape) ? *escaped++ : static_cast<uint8_t>(enc);
+            }
+            return escaped;
+        }
+        default :
+            memcpy(dst, data, MESHOPT_BYTE_GROUP_SIZE);
+            return data + MESHOPT_BYTE_GROUP_SIZE;
+        }
+    }
+
+    TAKErr decodeTriangles(uint8_t *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen) NOTHROWS
+    {
+        if (srcLen < 1u + count / 3u + MESHOPT_TRIANGLES_TAIL_SIZE)
+            return TE_IllegalState;
+        if ((src[0] & 0xF0u) != MESHOPT_TRIANGLES_HEADER)
+            return TE_IllegalState;
+        const int version = src[0] & 0x0F;
+        if (version > 1)
+            return TE_Unsupported;
+
+        // one code per triangle, followed by the free indices and the
+        // auxiliary code table
+        const uint8_t *codes = src + 1u;
+        const uint8_t *data = codes + count / 3u;
+        const uint8_t *safeEnd = src + srcLen - MESHOPT_TRIANGLES_TAIL_SIZE;
+        const uint8_t *codeaux = safeEnd;
+
+        uint32_t edges[16][2];
+        uint32_t vertices[16];
+        memset(edges, 0xFF, sizeof(edges));
+        memset(vertices, 0xFF, sizeof(vertices));
+        std::size_t edgeOffset = 0u;
+        std::size_t vertexOffset = 0u;
+
+        uint32_t next = 0u;
+        uint32_t last = 0u;
+        // version 1 encodes small deltas from the last free index
+        const int fecmax = version >= 1 ? 13 : 15;
+
+        for (std::size_t i = 0u; i < count; i += 3u) {
+            // a triangle reads at most 16 bytes; the tail guarantees this
+            if (data > safeEnd)
+                return TE_IllegalState;
+
+            const uint8_t codetri = *codes++;
+            if (codetri < 0xF0u) {
+                // an edge from the fifo, and a new, cached or free vertex
+                const int fe = codetri >> 4;
+                const uint32_t a = edges[(edgeOffset - 1u - fe) & 15u][0];
+                const uint32_t b = edges[(edgeOffset - 1u - fe) & 15u][1];
+
+                const int fec = codetri & 15;
+                uint32_t c;
+                if (fec < fecmax) {
+                    const bool isNext = (fec == 0);
+                    c = isNext ? next : vertices[(vertexOffset - 1u - fec) & 15u];
+                    if (isNext)
+                        next++;
+                    pushVertex(vertices, c, vertexOffset, isNext);
+                } else {
+                    // 13 and 14 are deltas of -1 and 1
+                    last = c = (fec != 15) ? last + static_cast<uint32_t>(fec - (fec ^ 3)) : decodeIndex(data, last);
+                    pushVertex(vertices, c, vertexOffset);
+                }
+
+                writeIndex(dst, i, stride, a);
+                writeIndex(dst, i + 1u, stride, b);
+                writeIndex(dst, i + 2u, stride, c);
+                pushEdge(edges, c, b, edgeOffset);
+                pushEdge(edges, a, c, edgeOffset);
+            } else {
+                // three vertices, each new, cached or free
+                int fea, feb, fec;
+                if (codetri < 0xFEu) {
+                    const uint8_t aux = codeaux[codetri & 15u];
+                    fea = 0;
+                    feb = aux >> 4;
+                    fec = aux & 15;
+                } else {
+                    const uint8_t aux = *data++;
+                    fea = codetri == 0xFEu ? 0 : 15;
+                    feb = aux >> 4;
+                    fec = aux & 15;
+                    if (aux == 0u)
+                        next = 0u;
+                }
+
+                uint32_t a = (fea == 0) ? next++ : 0u;
+                uint32_t b = (feb == 0) ? next++ : vertices[(vertexOffset - feb) & 15u];
+                uint32_t c = (fec == 0) ? next++ : vertices[(vertexOffset - fec) & 15u];
+                if (fea == 15)
+                    last = a = decodeIndex(data, last);
+                if (feb == 15)
+                    last = b = decodeIndex(data, last);
+                if (fec == 15)
+                    last = c = decodeIndex(data, last);
+
+                writeIndex(dst, i, stride, a);
+                writeIndex(dst, i + 1u, stride, b);
+                writeIndex(dst, i + 2u, stride, c);
+                pushVertex(vertices, a, vertexOffset);
+                pushVertex(vertices, b, vertexOffset, feb == 0 || feb == 15);
+                pushVertex(vertices, c, vertexOffset, fec == 0 || fec == 15);
+                pushEdge(edges, b, a, edgeOffset);
+                pushEdge(edges, c, b, edgeOffset);
+                pushEdge(edges, a, c, edgeOffset);
+            }
+        }
+
+        // all data is consumed, up to the code table
+        if (data != safeEnd)
+            return TE_IllegalState;
+        return TE_Ok;
+    }
+    TAKErr decodeIndices(uint8_t *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen) NOTHROWS
+    {
+        if (srcLen < 1u + count + MESHOPT_INDICES_TAIL_SIZE)
+            return TE_IllegalState;
+        if ((src[0] & 0xF0u) != MESHOPT_INDICES_HEADER)
+            return TE_IllegalState;
+        if ((src[0] & 0x0Fu) > 1u)
+            return TE_Unsupported;
+
+        const uint8_t *data = src + 1u;
+        const uint8_t *safeEnd = src + srcLen - MESHOPT_INDICES_TAIL_SIZE;
+
+        // deltas against one of two baselines, selected by the low bit
+        uint32_t last[2] = { 0u, 0u };
+        for (std::size_t i = 0u; i < count; i++) {
+            // an index reads at most 5 bytes; the tail guarantees this
+            if (data >= safeEnd)
+                return TE_IllegalState;
+            uint32_t v = decodeVByte(data);
+            const uint32_t baseline = v & 1u;
+            v >>= 1u;
+            const uint32_t d = (v >> 1u) ^ static_cast<uint32_t>(-static_cast<int32_t>(v & 1u));
+            last[baseline] += d;
+            writeIndex(dst, i, stride, last[baseline]);
+        }
+
+        if (data != safeEnd)
+            return TE_IllegalState;
+        return TE_Ok;
+    }
+
+    template<typename T>
+    void filterOctahedral(uint8_t *data, const std::size_t count) NOTHROWS
+    {
+        const float max = static_cast<float>((1 << (sizeof(T) * 8u - 1u)) - 1);
+        for (std::size_t i = 0u; i < count; i++) {
+            T v[4u];
+            memcpy(v, data + i * sizeof(v), sizeof(v));
+
+            // reconstruct z; the fourth component encodes 1.0 at the same scale
+            float x = static_cast<float>(v[0]);
+            float y = static_cast<float>(v[1]);
+            const float z = static_cast<float>(v[2]) - fabsf(x) - fabsf(y);
+
+            // fold the lower hemisphere
+            const float t = (z < 0.f) ? z : 0.f;
+            x += (x >= 0.f) ? t : -t;
+            y += (y >= 0.f) ? t : -t;
+
+            const float s = max / sqrtf(x * x + y * y + z * z);
+            v[0] = static_cast<T>(static_cast<int>(x * s + (x >= 0.f ? 0.5f : -0.5f)));
+            v[1] = static_cast<T>(static_cast<int>(y * s + (y >= 0.f ? 0.5f : -0.5f)));
+            v[2] = static_cast<T>(static_cast<int>(z * s + (z >= 0.f ? 0.5f : -0.5f)));
+            memcpy(data + i * sizeof(v), v, sizeof(v));
+        }
+    }
+    void filterQuaternion(uint8_t *data, const std::size_t count) NOTHROWS
+    {
+        const float scale = 1.f / sqrtf(2.f);
+        for (std::size_t i = 0u; i < count; i++) {
+            int16_t v[4u];
+            memcpy(v, data + i * sizeof(v), sizeof(v));
+
+            // the fourth component holds the scale and the index of the
+            // largest component, which is reconstructed
+            const int sf = v[3] | 3;
+            const float ss = scale / static_cast<float>(sf);
+            const float x = static_cast<float>(v[0]) * ss;
+            const float y = static_cast<float>(v[1]) * ss;
+            const float z = static_cast<float>(v[2]) * ss;
+            const float ww = 1.f - x * x - y * y - z * z;
+            const float w = sqrtf(ww >= 0.f ? ww : 0.f);
+
+            const int qc = v[3] & 3;
+            int16_t q[4u];
+            q[(qc + 1) & 3] = static_cast<int16_t>(static_cast<int>(x * 32767.f + (x >= 0.f ? 0.5f : -0.5f)));
+            q[(qc + 2) & 3] = static_cast<int16_t>(static_cast<int>(y * 32767.f + (y >= 0.f ? 0.5f : -0.5f)));
+            q[(qc + 3) & 3] = static_cast<int16_t>(static_cast<int>(z * 32767.f + (z >= 0.f ? 0.5f : -0.5f)));
+            q[qc] = static_cast<int16_t>(static_cast<int>(w * 32767.f + 0.5f));
+            memcpy(data + i * sizeof(q), q, sizeof(q));
+        }
+    }
+    void filterExponential(uint8_t *data, const std::size_t count) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < count; i++) {
+            uint32_t v;
+            memcpy(&v, data + i * 4u, 4u);
+
+            // 24-bit signed mantissa and 8-bit signed exponent
+            const int32_t m = static_cast<int32_t>(v << 8u) >> 8;
+            const int32_t e = static_cast<int32_t>(v) >> 24;
+            const float f = ldexpf(static_cast<float>(m), e);
+            memcpy(data + i * 4u, &f, 4u);
+        }
+    }
+}
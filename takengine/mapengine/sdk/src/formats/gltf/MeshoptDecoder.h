@@ -0,0 +1,68 @@
+#ifndef TAK_ENGINE_FORMATS_GLTF_MESHOPTDECODER_H_INCLUDED
+#define TAK_ENGINE_FORMATS_GLTF_MESHOPTDECODER_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Formats {
+            namespace GLTF {
+                /**
+                 * Compression modes of an `EXT_meshopt_compression` buffer
+                 * view.
+                 */
+                enum MeshoptMode
+                {
+                    /** vertex attributes */
+                    TEMM_Attributes,
+                    /** triangle list indices */
+                    TEMM_Triangles,
+                    /** indices of any other primitive type */
+                    TEMM_Indices,
+                };
+
+                /**
+                 * Filters that are applied to the decoded data of an
+                 * `EXT_meshopt_compression` buffer view.
+                 */
+                enum MeshoptFilter
+                {
+                    TEMF_None,
+                    /** octahedral encoded normals or tangents; stride 4 or 8 */
+                    TEMF_Octahedral,
+                    /** 16-bit quaternions; stride 8 */
+                    TEMF_Quaternion,
+                    /** 32-bit exponent/mantissa encoded floats */
+                    TEMF_Exponential,
+                };
+
+                /**
+                 * Decodes a buffer view compressed per
+                 * `EXT_meshopt_compression`.
+                 *
+                 * @param dst       Receives the decoded data; must be at
+                 *                  least `count * stride` bytes
+                 * @param count     The number of elements
+                 * @param stride    The element size, in bytes
+                 * @param src       The compressed data
+                 * @param srcLen    The length of the compressed data
+                 * @param mode      The compression mode
+                 * @param filter    The filter applied to the decoded data
+                 *
+                 * @return  TE_Ok on success; TE_InvalidArg if the parameters
+                 *          are not valid for the mode and filter;
+                 *          TE_Unsupported if the data was encoded with an
+                 *          unsupported codec version; TE_IllegalState if the
+                 *          data is malformed
+                 */
+                ENGINE_API Util::TAKErr MeshoptDecoder_decode(void *dst, const std::size_t count, const std::size_t stride, const uint8_t *src, const std::size_t srcLen, const MeshoptMode mode, const MeshoptFilter filter) NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
@@ -12,6 +12,7 @@
 using namespace TAK::Engine::Formats::MBTiles;
 
 using namespace TAK::Engine::DB;
+using namespace TAK::Engine::Raster::TileMatrix;
 using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Util;
 
@@ -241,3 +242,32 @@ TAKErr TAK::Engine::Formats::MBTiles::MBTilesInfo_get(MBTilesInfo *info, DB::Dat
     return code;
 }
 
+TAKErr TAK::Engine::Formats::MBTiles::MBTiles_buildTilePresenceIndex(TilePresenceIndex &index, DB::Database2 &database) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    QueryPtr result(nullptr, nullptr);
+    code = database.query(result, "SELECT zoom_level, tile_column, tile_row FROM tiles");
+    TE_CHECKRETURN_CODE(code);
+    do {
+        code = result->moveToNext();
+        TE_CHECKBREAK_CODE(code);
+        int level;
+        code = result->getInt(&level, 0);
+        TE_CHECKBREAK_CODE(code);
+        int column;
+        code = result->getInt(&column, 1);
+        TE_CHECKBREAK_CODE(code);
+        int row;
+        code = result->getInt(&row, 2);
+        TE_CHECKBREAK_CODE(code);
+        if (level < 0 || level > 31 || column < 0 || row < 0)
+            continue;
+        const int64_t flipped = ((int64_t)1 << level) - 1 - row;
+        if (flipped < 0)
+            continue;
+        index.add((std::size_t)level, (std::size_t)column, (std::size_t)flipped);
+    } while (true);
+    if (code == TE_Done)
+        code = TE_Ok;
+    return code;
+}
@@ -6,6 +6,7 @@
 #include "db/Database2.h"
 #include "port/Platform.h"
 #include "port/String.h"
+#include "raster/tilematrix/TilePresenceIndex.h"
 #include "util/Error.h"
 
 namespace TAK {
@@ -27,6 +28,13 @@ namespace TAK {
                 };
 
                 ENGINE_API Util::TAKErr MBTilesInfo_get(MBTilesInfo *value, DB::Database2 &database) NOTHROWS;
+                /**
+                 * Adds all tiles in the <code>tiles</code> table to the index.
+                 * MBTiles rows are numbered from the bottom of the grid; they
+                 * are flipped to the top-down rows used by
+                 * <code>TileMatrix</code>.
+                 */
+                ENGINE_API Util::TAKErr MBTiles_buildTilePresenceIndex(Raster::TileMatrix::TilePresenceIndex &index, DB::Database2 &database) NOTHROWS;
             }
         }
     }
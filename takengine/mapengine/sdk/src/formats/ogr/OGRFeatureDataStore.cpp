@@ -1,6 +1,8 @@
 #include "formats/ogr/OGRFeatureDataStore.h"
 
+#include <deque>
 #include <sstream>
+#include <vector>
 
 #include <gdal_priv.h>
 #include <ogrsf_frmts.h>
@@ -20,8 +22,12 @@
 #include "port/Platform.h"
 #include "port/StringBuilder.h"
 #include "thread/Lock.h"
+#include "thread/Monitor.h"
+#include "util/ConfigOptions.h"
 #include "util/IO2.h"
 #include "util/Memory.h"
+#include "util/Tasking.h"
+#include "util/Work.h"
 
 using namespace TAK::Engine::Formats::OGR;
 
@@ -31,6 +37,15 @@ using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 #define CONNECTION_POOL_LIMIT 3
+#define LAYER_READ_BATCH_SIZE 256u
+#define LAYER_READ_AHEAD_BATCHES 2u
+
+// the tolerance, in degrees, of simplification tier `n` is
+// `SIMPLIFIED_BASE_TOLERANCE * SIMPLIFIED_LEVEL_STEP^n`; matches the levels
+// persisted by FDB
+#define SIMPLIFIED_BASE_TOLERANCE 0.00001
+#define SIMPLIFIED_LEVEL_STEP 4.0
+#define MAX_SIMPLIFIED_LEVELS 8u
 
 namespace
 {
@@ -98,6 +113,7 @@ namespace
     {
     public :
         OgrFeatureCursorRowData() NOTHROWS;
+        ~OgrFeatureCursorRowData() NOTHROWS;
     public :
         OGRFeatureH ogrFeature;
         int64_t version;
@@ -119,12 +135,47 @@ namespace
     typedef std::shared_ptr<void> OGRSpatialReference_shared_ptr;
 
     typedef std::unique_ptr<void, void(*)(OGRGeometryH)> OGRGeometry_unique_ptr;
+
+    TAKErr OgrFeatureCursorRowData_exportWkb(OgrFeatureCursorRowData &row, OGRCoordinateTransformationH layer2lla, const double simplifyTolerance) NOTHROWS;
+    TAKErr wkb2geom(GeometryPtr_const &value, const uint8_t *wkb, const int wkbSize) NOTHROWS;
+    double getSimplifyTolerance(const FeatureDataStore2::FeatureQueryParameters &params, const std::size_t levels) NOTHROWS;
+
+    /**
+     * Reads the features of a layer in batches on a worker, ahead of the
+     * consuming cursor. Each reader has exclusive use of its connection,
+     * so the layers of a query are read concurrently.
+     */
+    struct OgrLayerReader
+    {
+    public :
+        OgrLayerReader(const GDALDataset_shared_ptr &conn, OGRLayerH layer) NOTHROWS;
+    public :
+        Monitor monitor;
+        GDALDataset_shared_ptr conn;
+        OGRLayerH layer;
+        /** owned by the reader; transformations are not thread-safe */
+        OGRCoordinateTransformation_unique_ptr layer2lla;
+        double simplifyTolerance;
+        std::deque<std::vector<std::unique_ptr<OgrFeatureCursorRowData>>> batches;
+        bool running;
+        bool done;
+        bool canceled;
+    };
+
+    TAKErr OgrLayerReader_run(bool &, const std::shared_ptr<OgrLayerReader> &reader) NOTHROWS;
 }
 
 class OGRFeatureDataStore::OgrLayerFeatureCursor : public FeatureCursor2
 {
 public:
     OgrLayerFeatureCursor(OGRFeatureDataStore &owner, const FeatureSetDefn &defn, OGRLayerH layer, const GDALDataset_shared_ptr &conn) NOTHROWS;
+    ~OgrLayerFeatureCursor() NOTHROWS override;
+public :
+    /**
+     * Starts reading the layer on a worker. The layer must not be accessed
+     * by the caller other than through this cursor after invocation.
+     */
+    Util::TAKErr readAhead() NOTHROWS;
 public: // FeatureCursor2
     Util::TAKErr getId(int64_t *value) NOTHROWS override;
     Util::TAKErr getFeatureSetId(int64_t *value) NOTHROWS override;
@@ -148,6 +199,9 @@ private:
     OGRLayerH layer;
     std::unique_ptr<OgrFeatureCursorRowData> rowData;
     OGRSpatialReference_unique_ptr layer2lla;
+    std::shared_ptr<OgrLayerReader> reader;
+    std::vector<std::unique_ptr<OgrFeatureCursorRowData>> batch;
+    std::size_t batchIndex;
 };
 
 class OGRFeatureDataStore::FeatureSetCursorImpl : public FeatureSetCursor2
@@ -192,11 +246,8 @@ public :
         code = impl->getStyle(ogrStyle, *feature, *feature->GetGeometryRef());
         TE_CHECKRETURN_CODE(code);
         if (ogrStyle) {
-            try {
-                value = StylePtr_const(atakmap::feature::Style::parseStyle(ogrStyle), atakmap::feature::Style::destructStyle);
-            } catch (...) {
-                return TE_Err;
-            }
+            code = atakmap::feature::Style_parseStyleShared(value, ogrStyle);
+            TE_CHECKRETURN_CODE(code);
         } else {
             value.reset();
         }
@@ -285,7 +336,8 @@ OGRFeatureDataStore::FeatureSetDefn::FeatureSetDefn() :
     visible(true),
     lla2layer(nullptr),
     minResolution(NAN),
-    maxResolution(NAN)
+    maxResolution(NAN),
+    simplifyTolerance(0.0)
 {}
 
 OGRFeatureDataStore::OGRFeatureDataStore(const char *uri_, const char *workingDir_, const bool asyncRefresh_) NOTHROWS :
@@ -298,7 +350,8 @@ OGRFeatureDataStore::OGRFeatureDataStore(const char *uri_, const char *workingDi
     disposing(false),
     backgroundRefresh(asyncRefresh_),
     provider("ogr"),
-    type("ogr)")
+    type("ogr)"),
+    simplifiedLevels(std::min((std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("ogr.simplified-levels", 0), 0), (std::size_t)MAX_SIMPLIFIED_LEVELS))
 {
     bool exists;
     IO_exists(&exists, workingDir);
@@ -328,7 +381,8 @@ OGRFeatureDataStore::OGRFeatureDataStore(const char *uri_, const char *workingDi
     backgroundRefresh(asyncRefresh_),
     userSchema(std::move(schema_)),
     provider("ogr"),
-    type("ogr")
+    type("ogr"),
+    simplifiedLevels(std::min((std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("ogr.simplified-levels", 0), 0), (std::size_t)MAX_SIMPLIFIED_LEVELS))
 {
     bool exists;
     IO_exists(&exists, workingDir);
@@ -349,6 +403,7 @@ OGRFeatureDataStore::OGRFeatureDataStore(const char *uri_, const char *workingDi
 
 OGRFeatureDataStore::~OGRFeatureDataStore() NOTHROWS
 {
+    stopContentChangedCoalescing();
     this->close();
 }
 
@@ -779,6 +834,9 @@ TAKErr OGRFeatureDataStore::Filter(FeatureQueryParameters *value, const FeatureS
 TAKErr OGRFeatureDataStore::PrepareQuery(std::list<std::pair<FeatureSetDefn, FeatureQueryParameters>> &value, const FeatureQueryParameters &params) NOTHROWS
 {
     TAKErr code(TE_Ok);
+    // OGR sources have no persisted levels; select the simplification tier
+    // once for all layers and simplify as the rows are read
+    const double simplifyTolerance = getSimplifyTolerance(params, this->simplifiedLevels);
     std::map<int64_t, std::shared_ptr<FeatureSetDefn>>::iterator it;
     for (it = this->fsidToFeatureDb.begin(); it != this->fsidToFeatureDb.end(); it++) {
         if (matches(*it->second, params)) {
@@ -786,6 +844,7 @@ TAKErr OGRFeatureDataStore::PrepareQuery(std::list<std::pair<FeatureSetDefn, Fea
             code = Filter(&innerParams, *it->second, params);
             TE_CHECKBREAK_CODE(code);
             value.push_back(std::make_pair(*it->second, innerParams));
+            value.back().first.simplifyTolerance = simplifyTolerance;
         }
     }
     TE_CHECKRETURN_CODE(code);
@@ -839,26 +898,42 @@ TAKErr OGRFeatureDataStore::queryFeatures(FeatureCursorPtr &value, const Feature
 
         std::list<FeatureCursorPtr> cursors;
 
+        // when multiple layers are queried, each is read ahead on a worker
+        // through a dedicated connection
+        const bool readAhead = (dbs.size() > 1u);
+
         std::list<std::pair<FeatureSetDefn, FeatureDataStore2::FeatureQueryParameters>>::iterator db;
         std::shared_ptr<void> shared_wfs;
         for(db = dbs.begin(); db != dbs.end(); db++) {
-            OGRLayerH layer = GDALDatasetGetLayerByName(dataset, (*db).first.layerName);
+            GDALDataset_shared_ptr conn(shared_wfs);
+            if (readAhead && shared_wfs.get()) {
+                GDALDataset_unique_ptr layerConn(nullptr, nullptr);
+                if (OpenConnection(layerConn) == TE_Ok)
+                    conn = std::move(layerConn);
+            }
+
+            OGRLayerH layer = GDALDatasetGetLayerByName(conn.get() ? conn.get() : dataset, (*db).first.layerName);
             if (!layer)
             {
                 Logger_log(TELL_Warning, "WFSClient: Failed to find layer %s", (*db).first.layerName.get());
                 continue;
             }
 
-            if (!shared_wfs.get())
+            if (!shared_wfs.get()) {
                 shared_wfs = std::move(wfs);
+                conn = shared_wfs;
+            }
 
             if (ConfigureForQuery(layer, (*db).first, params) != TE_Ok) {
                 Logger_log(TELL_Warning, "WFSClient: Failed to configure layer %s for query", (*db).first.layerName.get());
                 continue;
             }
 
+            std::unique_ptr<OgrLayerFeatureCursor> cursor(new OgrLayerFeatureCursor(*this, (*db).first, layer, conn));
+            if (readAhead && cursor->readAhead() != TE_Ok)
+                Logger_log(TELL_Warning, "WFSClient: Failed to read ahead layer %s", (*db).first.layerName.get());
             cursors.push_back(std::move(FeatureCursorPtr(
-                new OgrLayerFeatureCursor(*this, (*db).first, layer, shared_wfs),
+                cursor.release(),
                 Memory_deleter_const<FeatureCursor2, OgrLayerFeatureCursor>)));
         }
 
@@ -1610,7 +1685,8 @@ OGRFeatureDataStore::OgrLayerFeatureCursor::OgrLayerFeatureCursor(OGRFeatureData
     defn(defn_),
     layer(layer_),
     conn(conn_),
-    layer2lla(nullptr, nullptr)
+    layer2lla(nullptr, nullptr),
+    batchIndex(0u)
 {
     OGRSpatialReferenceH layerSpatialRef = OGR_L_GetSpatialRef(this->layer);
     if (layerSpatialRef && GetSpatialReferenceID(layerSpatialRef) != 4326)
@@ -1620,6 +1696,39 @@ OGRFeatureDataStore::OgrLayerFeatureCursor::OgrLayerFeatureCursor(OGRFeatureData
     }
 }
 
+OGRFeatureDataStore::OgrLayerFeatureCursor::~OgrLayerFeatureCursor() NOTHROWS
+{
+    if (this->reader.get()) {
+        Monitor::Lock lock(this->reader->monitor);
+        this->reader->canceled = true;
+        lock.broadcast();
+        while (this->reader->running)
+            lock.wait();
+    }
+}
+
+TAKErr OGRFeatureDataStore::OgrLayerFeatureCursor::readAhead() NOTHROWS
+{
+    if (this->reader.get())
+        return TE_IllegalState;
+
+    std::shared_ptr<OgrLayerReader> layerReader(new(std::nothrow) OgrLayerReader(this->conn, this->layer));
+    if (!layerReader.get())
+        return TE_OutOfMemory;
+    if (this->layer2lla.get()) {
+        OGRSpatialReferenceH layerSpatialRef = OGR_L_GetSpatialRef(this->layer);
+        layerReader->layer2lla = OGRCoordinateTransformation_unique_ptr(OCTNewCoordinateTransformation(layerSpatialRef, GetSR4326()), OGRCoordinateTransformation_delete);
+        if (!layerReader->layer2lla.get())
+            return TE_Err;
+    }
+    layerReader->simplifyTolerance = this->defn.simplifyTolerance;
+
+    layerReader->running = true;
+    this->reader = layerReader;
+    Task_begin(GeneralWorkers_flex(), OgrLayerReader_run, layerReader);
+    return TE_Ok;
+}
+
 TAKErr OGRFeatureDataStore::OgrLayerFeatureCursor::get(const Feature2 **feature) NOTHROWS
 {
     TAKErr code(TE_Ok);
@@ -1641,7 +1750,15 @@ TAKErr OGRFeatureDataStore::OgrLayerFeatureCursor::get(const Feature2 **feature)
         TE_CHECKRETURN_CODE(code);
 
         GeometryPtr_const geom(nullptr, nullptr);
-        code = ogr2geom(geom, this->rowData->ogrFeature);
+        if (this->defn.simplifyTolerance > 0.0) {
+            // the simplified geometry is only available as WKB
+            RawData rawGeom;
+            code = this->getRawGeometry(&rawGeom);
+            TE_CHECKRETURN_CODE(code);
+            code = wkb2geom(geom, rawGeom.binary.value, rawGeom.binary.len);
+        } else {
+            code = ogr2geom(geom, this->rowData->ogrFeature);
+        }
         TE_CHECKRETURN_CODE(code);
 
         AltitudeMode altitudeMode = this->getAltitudeMode();
@@ -1733,29 +1850,8 @@ TAKErr OGRFeatureDataStore::OgrLayerFeatureCursor::getRawGeometry(FeatureDefinit
         return TE_IllegalState;
 
     if(!this->rowData->wkb.get()) {
-        OGRGeometry_unique_ptr geometry(OGR_F_GetGeometryRef(this->rowData->ogrFeature), Memory_leaker<void>);
-        if (!geometry.get())
-            return TE_Err;
-
-        if (this->layer2lla.get()) {
-            geometry = OGRGeometry_unique_ptr(OGR_G_Clone(geometry.get()), OGR_G_DestroyGeometry);
-            if (!geometry.get())
-                return TE_IllegalState;
-            if (OGR_G_Transform(geometry.get(), this->layer2lla.get()) != CE_None)
-                return TE_Err;
-        }
-
-        this->rowData->wkbSize = OGR_G_WkbSize(geometry.get());
-        if (this->rowData->wkbSize < 0)
-            return TE_Err;
-        
-        this->rowData->wkb.reset(new uint8_t[this->rowData->wkbSize]);
-        if(OGR_G_ExportToWkb(geometry.get(),
-                             (TE_PlatformEndian == TE_LittleEndian) ? wkbNDR : wkbXDR,
-                             this->rowData->wkb.get()) != CE_None) {
-
-            return TE_Err;
-        }
+        TAKErr code = OgrFeatureCursorRowData_exportWkb(*this->rowData, this->layer2lla.get(), this->defn.simplifyTolerance);
+        TE_CHECKRETURN_CODE(code);
     }
 
     value->binary.len = this->rowData->wkbSize;
@@ -1809,6 +1905,23 @@ TAKErr OGRFeatureDataStore::OgrLayerFeatureCursor::moveToNext() NOTHROWS
 {
 #if 1
     this->rowData.reset();
+    if (this->reader.get()) {
+        if (this->batchIndex == this->batch.size()) {
+            this->batch.clear();
+            this->batchIndex = 0u;
+
+            Monitor::Lock lock(this->reader->monitor);
+            while (this->reader->batches.empty() && !this->reader->done)
+                lock.wait();
+            if (this->reader->batches.empty())
+                return TE_Done;
+            this->batch = std::move(this->reader->batches.front());
+            this->reader->batches.pop_front();
+            lock.broadcast();
+        }
+        this->rowData = std::move(this->batch[this->batchIndex++]);
+        return TE_Ok;
+    }
     OGRFeatureH ogrFeature = OGR_L_GetNextFeature(this->layer);
     if (!ogrFeature)
         return TE_Done;
@@ -1831,6 +1944,106 @@ namespace
         style(nullptr, nullptr),
         feature(nullptr, nullptr)
     {}
+    OgrFeatureCursorRowData::~OgrFeatureCursorRowData() NOTHROWS
+    {
+        if (ogrFeature)
+            OGR_F_Destroy(ogrFeature);
+    }
+
+    TAKErr OgrFeatureCursorRowData_exportWkb(OgrFeatureCursorRowData &row, OGRCoordinateTransformationH layer2lla, const double simplifyTolerance) NOTHROWS
+    {
+        OGRGeometry_unique_ptr geometry(OGR_F_GetGeometryRef(row.ogrFeature), Memory_leaker<void>);
+        if (!geometry.get())
+            return TE_Err;
+
+        if (layer2lla) {
+            geometry = OGRGeometry_unique_ptr(OGR_G_Clone(geometry.get()), OGR_G_DestroyGeometry);
+            if (!geometry.get())
+                return TE_IllegalState;
+            if (OGR_G_Transform(geometry.get(), layer2lla) != CE_None)
+                return TE_Err;
+        }
+        if (simplifyTolerance > 0.0) {
+            // simplification is unavailable without GEOS; fall back on the
+            // full resolution geometry
+            OGRGeometry_unique_ptr simplified(OGR_G_Simplify(geometry.get(), simplifyTolerance), OGR_G_DestroyGeometry);
+            if (simplified.get() && !OGR_G_IsEmpty(simplified.get()))
+                geometry = std::move(simplified);
+        }
+
+        const int wkbSize = OGR_G_WkbSize(geometry.get());
+        if (wkbSize < 0)
+            return TE_Err;
+
+        array_ptr<uint8_t> wkb(new(std::nothrow) uint8_t[wkbSize]);
+        if (!wkb.get())
+            return TE_OutOfMemory;
+        if(OGR_G_ExportToWkb(geometry.get(),
+                             (TE_PlatformEndian == TE_LittleEndian) ? wkbNDR : wkbXDR,
+                             wkb.get()) != CE_None) {
+
+            return TE_Err;
+        }
+        row.wkb.reset(wkb.release());
+        row.wkbSize = wkbSize;
+        return TE_Ok;
+    }
+
+    OgrLayerReader::OgrLayerReader(const GDALDataset_shared_ptr &conn_, OGRLayerH layer_) NOTHROWS :
+        conn(conn_),
+        layer(layer_),
+        layer2lla(nullptr, nullptr),
+        simplifyTolerance(0.0),
+        running(false),
+        done(false),
+        canceled(false)
+    {}
+
+    TAKErr OgrLayerReader_run(bool &, const std::shared_ptr<OgrLayerReader> &reader) NOTHROWS
+    {
+        bool exhausted = false;
+        while (!exhausted) {
+            {
+                Monitor::Lock lock(reader->monitor);
+                while (!reader->canceled && reader->batches.size() >= LAYER_READ_AHEAD_BATCHES)
+                    lock.wait();
+                if (reader->canceled)
+                    break;
+            }
+
+            std::vector<std::unique_ptr<OgrFeatureCursorRowData>> batch;
+            batch.reserve(LAYER_READ_BATCH_SIZE);
+            while (batch.size() < LAYER_READ_BATCH_SIZE) {
+                OGRFeatureH ogrFeature = OGR_L_GetNextFeature(reader->layer);
+                if (!ogrFeature) {
+                    exhausted = true;
+                    break;
+                }
+                std::unique_ptr<OgrFeatureCursorRowData> row(new(std::nothrow) OgrFeatureCursorRowData());
+                if (!row.get()) {
+                    OGR_F_Destroy(ogrFeature);
+                    exhausted = true;
+                    break;
+                }
+                row->ogrFeature = ogrFeature;
+                // export is the dominant per-feature cost; on failure, the
+                // cursor retries on demand and reports the error
+                OgrFeatureCursorRowData_exportWkb(*row, reader->layer2lla.get(), reader->simplifyTolerance);
+                batch.push_back(std::move(row));
+            }
+
+            Monitor::Lock lock(reader->monitor);
+            if (!batch.empty())
+                reader->batches.push_back(std::move(batch));
+            lock.broadcast();
+        }
+
+        Monitor::Lock lock(reader->monitor);
+        reader->done = true;
+        reader->running = false;
+        lock.broadcast();
+        return TE_Ok;
+    }
 
     double min(double a, double b, double c, double d) NOTHROWS
     {
@@ -2014,6 +2227,50 @@ namespace
 
         return code;
     }
+    TAKErr wkb2geom(GeometryPtr_const &value, const uint8_t *wkb, const int wkbSize) NOTHROWS
+    {
+        if (!wkb || wkbSize <= 0)
+            return TE_InvalidArg;
+        atakmap::feature::ByteBuffer wkb_bb(wkb, wkb + wkbSize);
+        try {
+            value = GeometryPtr_const(atakmap::feature::parseWKB(wkb_bb), atakmap::feature::destructGeometry);
+            if (!value.get())
+                return TE_Err;
+        } catch (...) {
+            return TE_Err;
+        }
+        return TE_Ok;
+    }
+    /**
+     * Returns the tolerance of the coarsest simplification tier that does not
+     * exceed the tolerance requested by the query, or `0` if no tier applies.
+     * The tolerance is that of a leading simplification op, if present, else
+     * one pixel at the maximum resolution.
+     */
+    double getSimplifyTolerance(const FeatureDataStore2::FeatureQueryParameters &params, const std::size_t levels) NOTHROWS
+    {
+        if (!levels)
+            return 0.0;
+        double tolerance = NAN;
+        if (!params.ops->empty()) {
+            TAK::Engine::Port::Collection<FeatureDataStore2::FeatureQueryParameters::SpatialOp>::IteratorPtr opsIter(nullptr, nullptr);
+            FeatureDataStore2::FeatureQueryParameters::SpatialOp op;
+            if (params.ops->iterator(opsIter) != TE_Ok || opsIter->get(op) != TE_Ok)
+                return 0.0;
+            if (op.type != FeatureDataStore2::FeatureQueryParameters::SpatialOp::Simplify)
+                return 0.0;
+            tolerance = op.args.simplify.distance;
+        } else if (!isnan(params.maxResolution)) {
+            tolerance = params.maxResolution / 111319.49;
+        }
+        if (!(tolerance >= SIMPLIFIED_BASE_TOLERANCE))
+            return 0.0;
+
+        double tier = SIMPLIFIED_BASE_TOLERANCE;
+        for (std::size_t level = 1u; level < levels && (tier * SIMPLIFIED_LEVEL_STEP) <= tolerance; level++)
+            tier *= SIMPLIFIED_LEVEL_STEP;
+        return tier;
+    }
     TAKErr ogr2attr(atakmap::util::AttributeSet *value, OGRFeatureH feature) NOTHROWS
     {
         int fieldCount = OGR_F_GetFieldCount(feature);
@@ -41,6 +41,11 @@ namespace TAK {
                         std::shared_ptr<void> lla2layer;
                         double minResolution;
                         double maxResolution;
+                        /**
+                         * tolerance, in degrees, to which geometries are
+                         * simplified; `0` for full resolution. Set per query.
+                         */
+                        double simplifyTolerance;
 
                         Port::String type;
                         Port::String provider;
@@ -151,6 +156,9 @@ namespace TAK {
 
                     std::shared_ptr<SchemaHandler> userSchema;
                     std::shared_ptr<SchemaHandler> schema;
+
+                    /** number of simplification tiers available to queries, per the `ogr.simplified-levels` option */
+                    std::size_t simplifiedLevels;
                 };
 
                 class ENGINE_API OGRFeatureDataStore::SchemaHandler
@@ -1,33 +1,44 @@
 #include "formats/osr/OSRProjectionSpi.h"
 
+#include <algorithm>
+#include <list>
+#include <map>
 #include <memory>
+#include <thread>
+#include <tuple>
 
 #include <ogr_srs_api.h>
 
 #include "core/Projection2.h"
 #include "core/ProjectionFactory3.h"
+#include "raster/gdal/GdalLibrary.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
 #include "util/Memory.h"
 
 using namespace TAK::Engine::Formats::OSR;
 
 using namespace TAK::Engine::Core;
 using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 namespace
 {
-    typedef std::unique_ptr<void, void(*)(OGRCoordinateTransformationH)> OGRCoordinateTransformationPtr;
+    class SpiImpl;
 
     class GdalProjection : public Projection2
     {
     public:
-        GdalProjection(OGRSpatialReferenceH srs, const int srid) NOTHROWS;
+        GdalProjection(SpiImpl &spi, const int srid) NOTHROWS;
         ~GdalProjection() NOTHROWS override;
     public:
         int getSpatialReferenceID() const NOTHROWS override;
 
         TAKErr forward(Point2<double> *proj, const GeoPoint2 &geo) const NOTHROWS override;
         TAKErr inverse(GeoPoint2 *geo, const TAK::Engine::Math::Point2<double> &proj) const NOTHROWS override;
+        TAKErr forward(Point2<double> *proj, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS override;
+        TAKErr inverse(GeoPoint2 *geo, const TAK::Engine::Math::Point2<double> *proj, const std::size_t count) const NOTHROWS override;
         double getMinLatitude() const NOTHROWS override;
         double getMaxLatitude() const NOTHROWS override;
         double getMinLongitude() const NOTHROWS override;
@@ -35,44 +46,72 @@ namespace
 
         bool is3D() const NOTHROWS override;
     private :
-        std::unique_ptr<void, void(*)(OGRCoordinateTransformationH)> forwardImpl;
-        std::unique_ptr<void, void(*)(OGRCoordinateTransformationH)> inverseImpl;
+        SpiImpl &spi;
         int srid;
     }; // end class Projection
 
     class SpiImpl : public ProjectionSpi3
     {
+    public :
+        SpiImpl() NOTHROWS;
     public :
         TAKErr create(Projection2Ptr &value, const int srid) NOTHROWS override;
+        /**
+         * Obtains the transformation from `srcSrid` to `dstSrid` for use
+         * on the calling thread. Transformations are not thread-safe, so
+         * each thread is given its own instance.
+         */
+        TAKErr getTransform(std::shared_ptr<void> &value, const int srcSrid, const int dstSrid) NOTHROWS;
+        void setTransformCacheLimit(const std::size_t limit) NOTHROWS;
+    private :
+        TAKErr getSpatialReferenceNoSync(OGRSpatialReferenceH *value, const int srid) NOTHROWS;
+    private :
+        typedef std::tuple<int, int, std::thread::id> TransformKey;
+        typedef std::list<std::pair<TransformKey, std::shared_ptr<void>>> TransformList;
+
+        // spatial references are imported once per SRID; importing from
+        // the EPSG definitions dominates the cost of creating a projection
+        Mutex mutex;
+        std::map<int, std::shared_ptr<void>> srs;
+        // most recently used transformations at the front. Evicted
+        // transformations remain valid for any thread still using them.
+        TransformList transforms;
+        std::map<TransformKey, TransformList::iterator> transformIndex;
+        std::size_t transformLimit;
     };
 
     void OGRSpatialReference_deleter(OGRSpatialReferenceH handle);
     void OGRCoordinateTransformation_deleter(OGRCoordinateTransformationH handle);
 
+    // number of points passed to each OCTTransform call by the batch methods
+    const std::size_t transformBatchSize = 256u;
+
+    SpiImpl &spiInstance() NOTHROWS
+    {
+        static SpiImpl spi;
+        return spi;
+    }
 }
 
 ProjectionSpi3 &TAK::Engine::Formats::OSR::OSRProjectionSpi_get() NOTHROWS
 {
-    static SpiImpl spi;
-    return spi;
+    return spiInstance();
+}
+TAKErr TAK::Engine::Formats::OSR::OSRProjectionSpi_getTransform(std::shared_ptr<void> &value, const int srcSrid, const int dstSrid) NOTHROWS
+{
+    return spiInstance().getTransform(value, srcSrid, dstSrid);
+}
+void TAK::Engine::Formats::OSR::OSRProjectionSpi_setTransformCacheLimit(const std::size_t limit) NOTHROWS
+{
+    spiInstance().setTransformCacheLimit(limit);
 }
 
 namespace
 {
-    GdalProjection::GdalProjection(OGRSpatialReferenceH srs, const int srid_) NOTHROWS :
-        forwardImpl(nullptr, nullptr),
-        inverseImpl(nullptr, nullptr),
+    GdalProjection::GdalProjection(SpiImpl &spi_, const int srid_) NOTHROWS :
+        spi(spi_),
         srid(srid_)
-    {
-        std::unique_ptr<void, void(*)(OGRSpatialReferenceH)> wgs84(OSRNewSpatialReference(nullptr), OGRSpatialReference_deleter);
-        if(!wgs84.get())
-            return;
-        if(OSRImportFromEPSG(wgs84.get(), 4326) != OGRERR_NONE)
-            return;
-
-        forwardImpl = OGRCoordinateTransformationPtr(OCTNewCoordinateTransformation(wgs84.get(), srs), OGRCoordinateTransformation_deleter);
-        inverseImpl = OGRCoordinateTransformationPtr(OCTNewCoordinateTransformation(srs, wgs84.get()), OGRCoordinateTransformation_deleter);
-    }
+    {}
     GdalProjection::~GdalProjection() NOTHROWS
     {}
     int GdalProjection::getSpatialReferenceID() const NOTHROWS
@@ -81,7 +120,8 @@ namespace
     }
     TAKErr GdalProjection::forward(Point2<double> *proj, const GeoPoint2 &geo) const NOTHROWS
     {
-        if(!forwardImpl.get())
+        std::shared_ptr<void> forwardImpl;
+        if(spi.getTransform(forwardImpl, 4326, srid) != TE_Ok)
             return TE_IllegalState;
         double x = geo.longitude;
         double y = geo.latitude;
@@ -95,7 +135,8 @@ namespace
     }
     TAKErr GdalProjection::inverse(GeoPoint2 *geo, const TAK::Engine::Math::Point2<double> &proj) const NOTHROWS
     {
-        if(!inverseImpl.get())
+        std::shared_ptr<void> inverseImpl;
+        if(spi.getTransform(inverseImpl, srid, 4326) != TE_Ok)
             return TE_IllegalState;
         double x = proj.x;
         double y = proj.y;
@@ -108,6 +149,65 @@ namespace
         geo->altitudeRef = AltitudeReference::HAE;
         return TE_Ok;
     }
+    TAKErr GdalProjection::forward(Point2<double> *proj, const GeoPoint2 *geo, const std::size_t count) const NOTHROWS
+    {
+        std::shared_ptr<void> forwardImpl;
+        if(spi.getTransform(forwardImpl, 4326, srid) != TE_Ok)
+            return TE_IllegalState;
+        if(count && (!proj || !geo))
+            return TE_InvalidArg;
+        double x[transformBatchSize];
+        double y[transformBatchSize];
+        double z[transformBatchSize];
+        for(std::size_t off = 0u; off < count; off += transformBatchSize) {
+            const std::size_t n = std::min(count - off, transformBatchSize);
+            for(std::size_t i = 0u; i < n; i++) {
+                const GeoPoint2 &g = geo[off + i];
+                x[i] = g.longitude;
+                y[i] = g.latitude;
+                z[i] = ::isnan(g.altitude) ? 0.0 : g.altitude;
+            }
+            if(!OCTTransform(forwardImpl.get(), static_cast<int>(n), x, y, z))
+                return TE_Err;
+            for(std::size_t i = 0u; i < n; i++) {
+                Point2<double> &p = proj[off + i];
+                p.x = x[i];
+                p.y = y[i];
+                p.z = z[i];
+            }
+        }
+        return TE_Ok;
+    }
+    TAKErr GdalProjection::inverse(GeoPoint2 *geo, const TAK::Engine::Math::Point2<double> *proj, const std::size_t count) const NOTHROWS
+    {
+        std::shared_ptr<void> inverseImpl;
+        if(spi.getTransform(inverseImpl, srid, 4326) != TE_Ok)
+            return TE_IllegalState;
+        if(count && (!proj || !geo))
+            return TE_InvalidArg;
+        double x[transformBatchSize];
+        double y[transformBatchSize];
+        double z[transformBatchSize];
+        for(std::size_t off = 0u; off < count; off += transformBatchSize) {
+            const std::size_t n = std::min(count - off, transformBatchSize);
+            for(std::size_t i = 0u; i < n; i++) {
+                const Point2<double> &p = proj[off + i];
+                x[i] = p.x;
+                y[i] = p.y;
+                z[i] = p.z;
+            }
+            if(!OCTTransform(inverseImpl.get(), static_cast<int>(n), x, y, z))
+                return TE_Err;
+            for(std::size_t i = 0u; i < n; i++) {
+                GeoPoint2 &g = geo[off + i];
+                g.longitude = x[i];
+                g.latitude = y[i];
+                g.altitude = z[i];
+                g.altitudeRef = AltitudeReference::HAE;
+            }
+        }
+        return TE_Ok;
+    }
     double GdalProjection::getMinLatitude() const NOTHROWS
     {
         return -90.0;
@@ -129,14 +229,93 @@ namespace
         return false;
     }
 
+    SpiImpl::SpiImpl() NOTHROWS :
+        transformLimit(64u)
+    {}
     TAKErr SpiImpl::create(Projection2Ptr &value, const int srid) NOTHROWS
     {
-        std::unique_ptr<void, void(*)(OGRSpatialReferenceH)> srs(OSRNewSpatialReference(nullptr), OGRSpatialReference_deleter);
-        if(!srs.get())
+        TAKErr code(TE_Ok);
+        {
+            Lock lock(mutex);
+            code = lock.status;
+            TE_CHECKRETURN_CODE(code);
+
+            OGRSpatialReferenceH wgs84;
+            code = getSpatialReferenceNoSync(&wgs84, 4326);
+            TE_CHECKRETURN_CODE(code);
+            OGRSpatialReferenceH sr;
+            code = getSpatialReferenceNoSync(&sr, srid);
+            TE_CHECKRETURN_CODE(code);
+        }
+
+        // transformations are obtained from the cache on use
+        value = Projection2Ptr(new GdalProjection(*this, srid), Memory_deleter_const<Projection2, GdalProjection>);
+        return code;
+    }
+    TAKErr SpiImpl::getTransform(std::shared_ptr<void> &value, const int srcSrid, const int dstSrid) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        Lock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+
+        const TransformKey key(srcSrid, dstSrid, std::this_thread::get_id());
+        auto entry = transformIndex.find(key);
+        if(entry != transformIndex.end()) {
+            transforms.splice(transforms.begin(), transforms, entry->second);
+            value = entry->second->second;
+            return TE_Ok;
+        }
+
+        OGRSpatialReferenceH src;
+        code = getSpatialReferenceNoSync(&src, srcSrid);
+        TE_CHECKRETURN_CODE(code);
+        OGRSpatialReferenceH dst;
+        code = getSpatialReferenceNoSync(&dst, dstSrid);
+        TE_CHECKRETURN_CODE(code);
+
+        // the transformation copies what it needs from the references
+        std::shared_ptr<void> transform(OCTNewCoordinateTransformation(src, dst), OGRCoordinateTransformation_deleter);
+        if(!transform.get())
+            return TE_Err;
+
+        transforms.push_front(std::make_pair(key, transform));
+        transformIndex[key] = transforms.begin();
+        while(transforms.size() > transformLimit) {
+            transformIndex.erase(transforms.back().first);
+            transforms.pop_back();
+        }
+
+        value = transform;
+        return code;
+    }
+    void SpiImpl::setTransformCacheLimit(const std::size_t limit) NOTHROWS
+    {
+        Lock lock(mutex);
+        transformLimit = std::max(limit, (std::size_t)1u);
+        while(transforms.size() > transformLimit) {
+            transformIndex.erase(transforms.back().first);
+            transforms.pop_back();
+        }
+    }
+    TAKErr SpiImpl::getSpatialReferenceNoSync(OGRSpatialReferenceH *value, const int srid) NOTHROWS
+    {
+        auto entry = srs.find(srid);
+        if(entry != srs.end()) {
+            *value = entry->second.get();
+            return TE_Ok;
+        }
+
+        // EPSG import requires GDAL_DATA to have been configured
+        atakmap::raster::gdal::GdalLibrary::ensureInitialized();
+
+        std::shared_ptr<void> sr(OSRNewSpatialReference(nullptr), OGRSpatialReference_deleter);
+        if(!sr.get())
             return TE_Err;
-        if(OSRImportFromEPSG(srs.get(), srid) != OGRERR_NONE)
+        if(OSRImportFromEPSG(sr.get(), srid) != OGRERR_NONE)
             return TE_InvalidArg;
-        value = Projection2Ptr(new GdalProjection(srs.get(), srid), Memory_deleter_const<Projection2, GdalProjection>);
+        srs[srid] = sr;
+        *value = sr.get();
         return TE_Ok;
     }
 
@@ -1,14 +1,32 @@
 #ifndef TAK_ENGINE_FORMATS_OSR_OSRPROJECTIONSPI_H_INCLUDED
 #define TAK_ENGINE_FORMATS_OSR_OSRPROJECTIONSPI_H_INCLUDED
 
+#include <cstddef>
+#include <memory>
+
 #include "core/ProjectionSpi3.h"
 #include "port/Platform.h"
+#include "util/Error.h"
 
 namespace TAK {
     namespace Engine {
         namespace Formats {
             namespace OSR {
                 ENGINE_API Core::ProjectionSpi3 &OSRProjectionSpi_get() NOTHROWS;
+                /**
+                 * Obtains an `OGRCoordinateTransformationH` from `srcSrid`
+                 * to `dstSrid` for use on the calling thread.
+                 * Transformations are cached per source, destination and
+                 * thread; the returned instance must not be shared with
+                 * other threads. The spatial references are imported from
+                 * the EPSG definitions.
+                 */
+                ENGINE_API Util::TAKErr OSRProjectionSpi_getTransform(std::shared_ptr<void> &value, const int srcSrid, const int dstSrid) NOTHROWS;
+                /**
+                 * Sets the maximum number of cached transformations.
+                 * Defaults to `64`.
+                 */
+                ENGINE_API void OSRProjectionSpi_setTransformCacheLimit(const std::size_t limit) NOTHROWS;
             }
         }
     }
@@ -15,28 +15,26 @@ namespace QuantizedMesh {
         static const int WEST = 3;
 
         long totalSize;
+        Util::TAKErr status;
 
         Indices edges[4];
 
-        EdgeIndicies(VertexData * /*vertexData*/, bool is32bit, Util::FileInput2 *buffer) {
-
-            int south;
-            int east;
-            int north;
-            int west;
-            
-            buffer->readInt(&west);
-            edges[WEST] = Indices(west, is32bit, buffer);
-            
-            buffer->readInt(&south);
-            edges[SOUTH] = Indices(south, is32bit, buffer);
-            
-            buffer->readInt(&east);
-            edges[EAST] = Indices(east, is32bit, buffer);
-            
-            buffer->readInt(&north);
-            edges[NORTH] = Indices(north, is32bit, buffer);
-            
+        EdgeIndicies(VertexData * /*vertexData*/, bool is32bit, Util::DataInput2 *buffer) :
+            totalSize(0),
+            status(Util::TE_Ok)
+        {
+            // edges are stored west, south, east, north
+            const int order[4] = { WEST, SOUTH, EAST, NORTH };
+            for(int i = 0; i < 4; i++) {
+                int count;
+                status = buffer->readInt(&count);
+                if(status != Util::TE_Ok)
+                    return;
+                edges[order[i]] = Indices(count, is32bit, buffer);
+                status = edges[order[i]].status;
+                if(status != Util::TE_Ok)
+                    return;
+            }
         }
 
         Indices* get(int edge) {
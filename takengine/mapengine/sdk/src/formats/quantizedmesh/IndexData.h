@@ -15,10 +15,16 @@ struct IndexData {
     long totalSize;
     int triangleCount;
     bool is32bit;
+    Util::TAKErr status;
 
     int get(int i) {
         return indices->get(i);
     }
+
+    /** returns the decoded indices, `uint16_t` or `uint32_t` per `is32bit` */
+    const void *data() const {
+        return indices->data();
+    }
     
 private:
     std::unique_ptr<Indices> indices;
@@ -35,20 +41,41 @@ private:
 
 public:
     
-    IndexData(VertexData* vData, Util::FileInput2* buffer) {
+    IndexData(VertexData* vData, Util::DataInput2 *buffer) :
+        totalSize(0),
+        triangleCount(0),
+        is32bit(false),
+        status(Util::TE_Ok)
+    {
 
         sizes = std::vector<int>(TriangleIndices::LEVEL_COUNT);
         for(int i=0; i < TriangleIndices::LEVEL_COUNT; i++) {
             sizes[i] = 1 << (MAX_LEVEL - i);
         }
 
-        buffer->readInt(&triangleCount);
-        triangleCount = static_cast<unsigned>(triangleCount);
-        
         is32bit = vData->vertexCount > 65536;
+
+        // 32-bit index data is 4-byte aligned; the header and vertex count
+        // are 92 bytes, followed by 6 bytes per vertex
+        if(is32bit && (vData->vertexCount % 2)) {
+            status = buffer->skip(2u);
+            if(status != Util::TE_Ok)
+                return;
+        }
+
+        status = buffer->readInt(&triangleCount);
+        if(status != Util::TE_Ok)
+            return;
+        if(triangleCount < 0) {
+            status = Util::TE_InvalidArg;
+            return;
+        }
         int length = triangleCount * 3;
 
-        indices = std::make_unique<Indices>(length, is32bit, true, buffer);
+        indices = std::make_unique<Indices>(length, is32bit, true, vData->vertexCount, buffer);
+        status = indices->status;
+        if(status != Util::TE_Ok)
+            return;
 
         quadtree.resize(TriangleIndices::LEVEL_COUNT);
         for(int l = 0; l < TriangleIndices::LEVEL_COUNT; l++) {
@@ -87,8 +114,8 @@ public:
         for (int i = 0; i < length; ++i) {
             int index = indices->get(i);
 
-            int x = vData->u[index];
-            int y = vData->v[index];
+            int x = vData->u(index);
+            int y = vData->v(index);
 
 
             minX = min(x, minX);
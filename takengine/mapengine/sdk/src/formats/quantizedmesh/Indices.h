@@ -1,4 +1,10 @@
 #pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "QuantizedMeshDecode.h"
 #include "util/DataInput2.h"
 #include "util/DataOutput2.h"
 
@@ -11,89 +17,74 @@ namespace QuantizedMesh {
 
         int length;
         bool is32bit;
+        Util::TAKErr status;
 
-        std::unique_ptr<Util::FileInput2> buffer;
-        // std::unique_ptr<Util::DynamicOutput> indexBuffer;
-
-        unsigned int *indexArray32;
-        unsigned short *indexArray16;
+        std::vector<uint32_t> indexArray32;
+        std::vector<uint16_t> indexArray16;
 
         Indices()
             : length(0),
-              is32bit(false) {
+              is32bit(false),
+              status(Util::TE_Ok) {
 
         }
 
-        Indices(int length, bool is32bit, Util::FileInput2 *buffer) : Indices(length, is32bit, false, buffer){
+        Indices(int length, bool is32bit, Util::DataInput2 *buffer) : Indices(length, is32bit, false, 0, buffer){
         }
-        
-        Indices(int length, bool is32bit, bool compressed, Util::FileInput2 *buffer) {
-            this->length = length;
+
+        /**
+         * @param compressed    If `true`, the indices are high-water mark
+         *                      encoded
+         * @param numVertices   The number of vertices, for validation of
+         *                      compressed indices
+         */
+        Indices(int length, bool is32bit, bool compressed, int numVertices, Util::DataInput2 *buffer) : Indices() {
             this->is32bit = is32bit;
-            this->indexArray32 = new unsigned int[length];
-            this->indexArray16 = new unsigned short[length];
+            if(length < 0) {
+                status = Util::TE_InvalidArg;
+                return;
+            }
+            this->length = length;
+
+            const std::size_t count = static_cast<std::size_t>(length);
+            const uint8_t *block;
+            std::unique_ptr<uint8_t[]> blockBuf;
+            status = QuantizedMesh_readBlock(&block, blockBuf, *buffer, count * (is32bit ? 4u : 2u));
+            if(status != Util::TE_Ok)
+                return;
+
+            if(is32bit)
+                indexArray32.resize(count);
+            else
+                indexArray16.resize(count);
 
             if(compressed) {
-                int highest = 0;
-                for( int i=0; i < length; ++i) {
-                    if(is32bit) {
-                        int code;
-                        buffer->readInt(&code);
-                        int index = highest - code;
-                        
-                        if(code == 0)
-                            ++highest;
-                        
-                        // indexBuffer->writeInt(index);
-                        indexArray32[i] = static_cast<unsigned>(index);
-                    }
-                    else {
-                        short code;
-                        buffer->readShort(&code);
-                        unsigned short codes = static_cast<unsigned>(code);
-                        short index = highest - codes;
-                        if(codes == 0) 
-                            ++highest;
-
-                        // indexBuffer->writeShort(index);
-                        unsigned short t = static_cast<unsigned>(index);
-                        indexArray16[i] = t;
-                    }
-                }
+                if(is32bit)
+                    status = QuantizedMesh_decodeHighWaterMark(indexArray32.data(), block, count, static_cast<std::size_t>(numVertices));
+                else
+                    status = QuantizedMesh_decodeHighWaterMark(indexArray16.data(), block, count, static_cast<std::size_t>(numVertices));
             }
             //not compressed
             else {
-                for(int i=0; i<length; ++i) {
-                    if(is32bit) {
-                        int value;
-                        buffer->readInt(&value);
-                        // indexBuffer->writeInt(value);
-                        indexArray32[i] = static_cast<unsigned>(value);
-                    }
-                    else {
-                        short value;
-                        buffer->readShort(&value);
-                        // indexBuffer->writeShort(value);
-                        indexArray16[i] = static_cast<unsigned>(value);
-                    }
-                }
+                if(is32bit)
+                    QuantizedMesh_decodeIndices(indexArray32.data(), block, count);
+                else
+                    QuantizedMesh_decodeIndices(indexArray16.data(), block, count);
             }
         }
 
         int get(int i) {
-            
-            // indexBuffer->reset();
-            // indexBuffer->skip(i);
-            // const uint8_t* data(nullptr);
-            // size_t len;
-            // indexBuffer->get(&data, &len );
-            //
-            // return static_cast<int>(*data);
             if (this->is32bit)
                 return this->indexArray32[i];
             else
                 return this->indexArray16[i];
-            return 0;
+        }
+
+        /** returns the decoded indices, `uint16_t` or `uint32_t` per `is32bit` */
+        const void *data() const {
+            return is32bit ?
+                static_cast<const void *>(indexArray32.data()) :
+                static_cast<const void *>(indexArray16.data());
         }
         
     };
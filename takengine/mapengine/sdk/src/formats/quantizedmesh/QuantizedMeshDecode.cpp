@@ -0,0 +1,170 @@
+#include "QuantizedMeshDecode.h"
+
+#include <cstring>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TE_QUANTIZEDMESH_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TE_QUANTIZEDMESH_NEON
+#endif
+
+using namespace TAK::Engine::Formats::QuantizedMesh;
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    inline uint16_t readUInt16(const uint8_t *src) NOTHROWS
+    {
+        return (uint16_t)(src[0] | (src[1] << 8u));
+    }
+    inline uint32_t readUInt32(const uint8_t *src) NOTHROWS
+    {
+        return (uint32_t)src[0] | ((uint32_t)src[1] << 8u) | ((uint32_t)src[2] << 16u) | ((uint32_t)src[3] << 24u);
+    }
+    inline uint16_t zigZagDecode(const uint16_t value) NOTHROWS
+    {
+        return (uint16_t)((value >> 1u) ^ (uint16_t)(-(int)(value & 1u)));
+    }
+
+    template<class T>
+    TAKErr decodeHighWaterMark(T *dst, const uint8_t *src, const std::size_t count, const std::size_t numVertices) NOTHROWS
+    {
+        // each index is relative to the highest index yet seen; the
+        // dependency is serial, but decoding from the raw block avoids the
+        // per-value virtual read
+        uint32_t highest = 0u;
+        for (std::size_t i = 0u; i < count; i++) {
+            const uint32_t code = (sizeof(T) == 2u) ? readUInt16(src + (i*2u)) : readUInt32(src + (i*4u));
+            const uint32_t index = highest - code;
+            if (index >= numVertices)
+                return TE_InvalidArg;
+            dst[i] = (T)index;
+            if (!code)
+                highest++;
+        }
+        return TE_Ok;
+    }
+}
+
+void TAK::Engine::Formats::QuantizedMesh::QuantizedMesh_decodeZigZagDelta(uint16_t *dst, const std::size_t stride, const uint8_t *src, const std::size_t count) NOTHROWS
+{
+    uint16_t previous = 0u;
+    std::size_t i = 0u;
+#if defined(TE_QUANTIZEDMESH_SSE2)
+    if (TE_PlatformEndian == TE_LittleEndian) {
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i zero = _mm_setzero_si128();
+        alignas(16) uint16_t decoded[8u];
+        __m128i carry = _mm_setzero_si128();
+        for (; (i + 8u) <= count; i += 8u) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (i*2u)));
+            // zig-zag
+            __m128i d = _mm_xor_si128(_mm_srli_epi16(v, 1), _mm_sub_epi16(zero, _mm_and_si128(v, one)));
+            // inclusive prefix sum of the deltas
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 2));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 4));
+            d = _mm_add_epi16(d, _mm_slli_si128(d, 8));
+            d = _mm_add_epi16(d, carry);
+            // broadcast the last sum
+            carry = _mm_shuffle_epi32(_mm_shufflehi_epi16(d, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            if (stride == 1u) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), d);
+            } else {
+                _mm_store_si128(reinterpret_cast<__m128i *>(decoded), d);
+                for (std::size_t j = 0u; j < 8u; j++)
+                    dst[(i+j)*stride] = decoded[j];
+            }
+        }
+        if (i)
+            previous = (uint16_t)_mm_extract_epi16(carry, 0);
+    }
+#elif defined(TE_QUANTIZEDMESH_NEON)
+    if (TE_PlatformEndian == TE_LittleEndian) {
+        const uint16x8_t zero = vdupq_n_u16(0u);
+        uint16x8_t carry = vdupq_n_u16(0u);
+        for (; (i + 8u) <= count; i += 8u) {
+            const uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src + (i*2u)));
+            // zig-zag
+            uint16x8_t d = veorq_u16(vshrq_n_u16(v, 1), vsubq_u16(zero, vandq_u16(v, vdupq_n_u16(1u))));
+            // inclusive prefix sum of the deltas
+            d = vaddq_u16(d, vextq_u16(zero, d, 7));
+            d = vaddq_u16(d, vextq_u16(zero, d, 6));
+            d = vaddq_u16(d, vextq_u16(zero, d, 4));
+            d = vaddq_u16(d, carry);
+            carry = vdupq_n_u16(vgetq_lane_u16(d, 7));
+            if (stride == 1u) {
+                vst1q_u16(dst + i, d);
+            } else {
+                uint16_t decoded[8u];
+                vst1q_u16(decoded, d);
+                for (std::size_t j = 0u; j < 8u; j++)
+                    dst[(i+j)*stride] = decoded[j];
+            }
+        }
+        if (i)
+            previous = vgetq_lane_u16(carry, 0);
+    }
+#endif
+    for (; i < count; i++) {
+        previous = (uint16_t)(previous + zigZagDecode(readUInt16(src + (i*2u))));
+        dst[i*stride] = previous;
+    }
+}
+TAKErr TAK::Engine::Formats::QuantizedMesh::QuantizedMesh_decodeHighWaterMark(uint16_t *dst, const uint8_t *src, const std::size_t count, const std::size_t numVertices) NOTHROWS
+{
+    return decodeHighWaterMark<uint16_t>(dst, src, count, numVertices);
+}
+TAKErr TAK::Engine::Formats::QuantizedMesh::QuantizedMesh_decodeHighWaterMark(uint32_t *dst, const uint8_t *src, const std::size_t count, const std::size_t numVertices) NOTHROWS
+{
+    return decodeHighWaterMark<uint32_t>(dst, src, count, numVertices);
+}
+void TAK::Engine::Formats::QuantizedMesh::QuantizedMesh_decodeIndices(uint16_t *dst, const uint8_t *src, const std::size_t count) NOTHROWS
+{
+    if (TE_PlatformEndian == TE_LittleEndian) {
+        memcpy(dst, src, count*2u);
+        return;
+    }
+    for (std::size_t i = 0u; i < count; i++)
+        dst[i] = readUInt16(src + (i*2u));
+}
+void TAK::Engine::Formats::QuantizedMesh::QuantizedMesh_decodeIndices(uint32_t *dst, const uint8_t *src, const std::size_t count) NOTHROWS
+{
+    if (TE_PlatformEndian == TE_LittleEndian) {
+        memcpy(dst, src, count*4u);
+        return;
+    }
+    for (std::size_t i = 0u; i < count; i++)
+        dst[i] = readUInt32(src + (i*4u));
+}
+TAKErr TAK::Engine::Formats::QuantizedMesh::QuantizedMesh_readBlock(const uint8_t **value, std::unique_ptr<uint8_t[]> &buf, DataInput2 &input, const std::size_t len) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value)
+        return TE_InvalidArg;
+    if (!len) {
+        *value = nullptr;
+        return TE_Ok;
+    }
+    code = input.readSpan(value, len);
+    if (code != TE_Unsupported)
+        return code;
+
+    buf.reset(new(std::nothrow) uint8_t[len]);
+    if (!buf)
+        return TE_OutOfMemory;
+    std::size_t off = 0u;
+    while (off < len) {
+        std::size_t numRead;
+        code = input.read(buf.get() + off, &numRead, len - off);
+        TE_CHECKRETURN_CODE(code);
+        if (!numRead)
+            return TE_IO;
+        off += numRead;
+    }
+    *value = buf.get();
+    return code;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/DataInput2.h"
+#include "util/Error.h"
+
+namespace TAK {
+namespace Engine {
+namespace Formats {
+namespace QuantizedMesh {
+
+    /**
+     * Decodes `count` zig-zag, delta encoded little-endian 16-bit values
+     * from `src`. Decoded values are written to every `stride`th element
+     * of `dst`, allowing the u, v and height streams to be decoded
+     * directly into interleaved positions.
+     */
+    ENGINE_API void QuantizedMesh_decodeZigZagDelta(uint16_t *dst, const std::size_t stride, const uint8_t *src, const std::size_t count) NOTHROWS;
+    /**
+     * Decodes `count` high-water mark encoded little-endian indices from
+     * `src`.
+     *
+     * @return  TE_Ok on success, TE_InvalidArg if an index exceeds
+     *          `numVertices`
+     */
+    ENGINE_API Util::TAKErr QuantizedMesh_decodeHighWaterMark(uint16_t *dst, const uint8_t *src, const std::size_t count, const std::size_t numVertices) NOTHROWS;
+    ENGINE_API Util::TAKErr QuantizedMesh_decodeHighWaterMark(uint32_t *dst, const uint8_t *src, const std::size_t count, const std::size_t numVertices) NOTHROWS;
+    /**
+     * Decodes `count` unencoded little-endian indices from `src`.
+     */
+    ENGINE_API void QuantizedMesh_decodeIndices(uint16_t *dst, const uint8_t *src, const std::size_t count) NOTHROWS;
+    ENGINE_API void QuantizedMesh_decodeIndices(uint32_t *dst, const uint8_t *src, const std::size_t count) NOTHROWS;
+
+    /**
+     * Obtains a view of the next `len` bytes of the input, for bulk
+     * decoding. The view is of the input content in place if the input
+     * supports `readSpan`, otherwise the bytes are read into `buf`.
+     */
+    ENGINE_API Util::TAKErr QuantizedMesh_readBlock(const uint8_t **value, std::unique_ptr<uint8_t[]> &buf, Util::DataInput2 &input, const std::size_t len) NOTHROWS;
+
+}
+}
+}
+}
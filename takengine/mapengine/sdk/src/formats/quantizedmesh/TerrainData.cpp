@@ -6,9 +6,11 @@
 #include "formats/egm/EGM96.h"
 #include "math/Triangle.h"
 #include "math/Vector4.h"
+#include "model/MeshBuilder.h"
 #include "util/DataInput2.h"
 #include "util/IO.h"
 #include "util/IO2.h"
+#include "util/Memory.h"
 
 using namespace TAK::Engine::Util;
 
@@ -34,19 +36,64 @@ struct LastState {
     }
 };
 
+namespace
+{
+    struct MeshDataRef
+    {
+        std::shared_ptr<TAK::Engine::Formats::QuantizedMesh::VertexData> vertexData;
+        std::shared_ptr<TAK::Engine::Formats::QuantizedMesh::IndexData> indexData;
+    };
+}
+
 TAKErr TAK::Engine::Formats::QuantizedMesh::TerrainData::parseTerrainFile(const char* filename, int zlevel) NOTHROWS 
 {
+    TAKErr code(TE_Ok);
+    MappedFileInput2 finput;
+    code = finput.open(filename, TEMA_Sequential);
+    TE_CHECKRETURN_CODE(code);
+
+    return parseTerrainData(finput, zlevel);
+}
+
+TAKErr TAK::Engine::Formats::QuantizedMesh::TerrainData::parseTerrainData(const uint8_t *data, const std::size_t len, int zlevel) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    MemoryInput2 input;
+    code = input.open(data, len);
+    TE_CHECKRETURN_CODE(code);
+
+    return parseTerrainData(input, zlevel);
+}
+
+TAKErr TAK::Engine::Formats::QuantizedMesh::TerrainData::parseTerrainData(DataInput2 &input, int zlevel) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if(zlevel < 0 || zlevel >= 32)
+        return TE_InvalidArg;
     this->_level = zlevel;
-    std::unique_ptr<FileInput2> finput = std::make_unique<FileInput2>();
-    if(TE_PlatformEndian == TE_BigEndian)
-        finput->setSourceEndian(atakmap::util::LITTLE_ENDIAN);
-    
-    finput->open(filename);
 
-    header = std::make_unique<TileHeader>(finput.get());
-    vertexData = std::make_unique<VertexData>(finput.get());
-    indexData = std::make_unique<IndexData>(vertexData.get(), finput.get());
-    edgeIndices = std::make_unique<EdgeIndicies>(vertexData.get(), indexData->is32bit, finput.get());
+    // all quantities are little-endian
+    const TAKEndian srcEndian = input.getSourceEndian();
+    input.setSourceEndian2(TE_LittleEndian);
+
+    header = std::make_unique<TileHeader>(&input);
+    vertexData = std::make_shared<VertexData>(&input);
+    code = vertexData->status;
+    if(code == TE_Ok) {
+        indexData = std::make_shared<IndexData>(vertexData.get(), &input);
+        code = indexData->status;
+    }
+    if(code == TE_Ok) {
+        edgeIndices = std::make_unique<EdgeIndicies>(vertexData.get(), indexData->is32bit, &input);
+        code = edgeIndices->status;
+    }
+    input.setSourceEndian2(srcEndian);
+    if(code != TE_Ok) {
+        vertexData.reset();
+        indexData.reset();
+        edgeIndices.reset();
+        return code;
+    }
 
     Core::GeoPoint2 g(0.0, 0.0);
 
@@ -65,6 +112,59 @@ TAKErr TAK::Engine::Formats::QuantizedMesh::TerrainData::parseTerrainFile(const
     return TE_Ok;
 }
 
+TAKErr TAK::Engine::Formats::QuantizedMesh::TerrainData::getMeshData(Elevation::ElevationChunk::Data &value) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if(!vertexData || !indexData || !header)
+        return TE_IllegalState;
+
+    const double spacing = geodetic_spacing[_level];
+    const double west = (_x * spacing) - 180.0;
+    const double south = (_y * spacing) - 90.0;
+
+    // heights are relative to the geoid
+    double geoidHeight = 0.0;
+    if(Elevation::ElevationManager_getGeoidHeight(&geoidHeight, south + (spacing / 2.0), west + (spacing / 2.0)) != TE_Ok || isnan(geoidHeight))
+        geoidHeight = 0.0;
+
+    Model::VertexDataLayout layout;
+    layout.interleaved = true;
+    layout.attributes = Model::TEVA_Position;
+    layout.position.offset = 0u;
+    layout.position.stride = 3u * sizeof(uint16_t);
+    layout.position.type = Port::TEDT_UInt16;
+
+    const Feature::Envelope2 aabb(0.0, 0.0, 0.0, MAX_RANGE, MAX_RANGE, MAX_RANGE);
+
+    // the mesh references the decoded data
+    std::unique_ptr<void, void(*)(const void *)> ref(new MeshDataRef{vertexData, indexData}, Memory_void_deleter_const<MeshDataRef>);
+
+    Model::MeshPtr mesh(nullptr, nullptr);
+    code = Model::MeshBuilder_buildInterleavedMesh(
+        mesh,
+        Model::TEDM_Triangles,
+        Model::TEWO_CounterClockwise,
+        layout,
+        0u,
+        nullptr,
+        aabb,
+        static_cast<std::size_t>(vertexData->vertexCount),
+        vertexData->positions.data(),
+        indexData->is32bit ? Port::TEDT_UInt32 : Port::TEDT_UInt16,
+        static_cast<std::size_t>(indexData->getLength()),
+        indexData->data(),
+        std::move(ref));
+    TE_CHECKRETURN_CODE(code);
+
+    value.value = std::move(mesh);
+    value.srid = 4326;
+    value.interpolated = false;
+    value.localFrame.setToTranslate(west, south, header->minimumHeight + geoidHeight);
+    value.localFrame.scale(spacing / MAX_RANGE, spacing / MAX_RANGE, header->getHeight() / MAX_RANGE);
+
+    return code;
+}
+
 TAK::Engine::Formats::QuantizedMesh::TerrainData::TerrainData(int level)
 {
     double div = 1;
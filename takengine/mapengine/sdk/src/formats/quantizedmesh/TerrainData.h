@@ -4,7 +4,9 @@
 #include "TileHeader.h"
 #include "VertexData.h"
 #include "core/Projection2.h"
+#include "elevation/ElevationChunk.h"
 #include "math/Triangle.h"
+#include "util/DataInput2.h"
 
 namespace TAK {
 namespace Engine {
@@ -46,6 +48,25 @@ public:
     TerrainData(int level);
     
     Util::TAKErr parseTerrainFile(const char* filename, int level) NOTHROWS;
+    /**
+     * Parses a tile from the input, which must be positioned at the start
+     * of the tile. Inputs that provide `readSpan`, such as `MemoryInput2`,
+     * are decoded in place.
+     */
+    Util::TAKErr parseTerrainData(Util::DataInput2 &input, int level) NOTHROWS;
+    /**
+     * Parses a tile from memory, e.g. a tile received over the network.
+     * The memory need not remain valid after the call returns.
+     */
+    Util::TAKErr parseTerrainData(const uint8_t *data, const std::size_t len, int level) NOTHROWS;
+    /**
+     * Returns the tile mesh, suitable for use as `TerrainTile::data`. The
+     * mesh shares the decoded vertex and index data; positions are the
+     * quantized u, v and height values, which the local frame transforms
+     * to longitude, latitude and HAE. The geoid offset is applied at the
+     * tile center.
+     */
+    Util::TAKErr getMeshData(TAK::Engine::Elevation::ElevationChunk::Data &value) const NOTHROWS;
     Util::TAKErr getElevation(double lat, double lon, double *elevationHae) NOTHROWS;
 
     bool seamsResolved();
@@ -61,8 +82,8 @@ private:
     std::vector<Triangle> skirts;
 
     std::unique_ptr<TileHeader> header;
-    std::unique_ptr<VertexData> vertexData;
-    std::unique_ptr<IndexData> indexData;
+    std::shared_ptr<VertexData> vertexData;
+    std::shared_ptr<IndexData> indexData;
     std::unique_ptr<EdgeIndicies> edgeIndices;
 
     bool isValid();
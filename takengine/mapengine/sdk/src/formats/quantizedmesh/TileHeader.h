@@ -34,7 +34,7 @@ struct TileHeader {
     double horizonOcclusionPointY;
     double horizonOcclusionPointZ;
 
-    TileHeader(TAK::Engine::Util::FileInput2* buffer) {
+    TileHeader(TAK::Engine::Util::DataInput2 *buffer) {
         buffer->readDouble(&centerX);
         buffer->readDouble(&centerY);
         buffer->readDouble(&centerZ);
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <vector>
 
+#include "QuantizedMeshDecode.h"
 #include "math/Vector.h"
 #include "math/Vector4.h"
 #include "util/DataInput2.h"
@@ -13,54 +16,52 @@ namespace QuantizedMesh {
 
 struct VertexData {
     int vertexCount;
-    unsigned short *u;
-    unsigned short *v;
-    unsigned short *height;
+    /** interleaved u, v, height */
+    std::vector<uint16_t> positions;
     int totalSize;
+    Util::TAKErr status;
 
-    VertexData(Util::FileInput2 *buffer) {
-        
-        buffer->readInt(&vertexCount);
+    VertexData(Util::DataInput2 *buffer) :
+        vertexCount(0),
+        totalSize(0),
+        status(Util::TE_Ok)
+    {
+        status = buffer->readInt(&vertexCount);
+        if(status != Util::TE_Ok)
+            return;
+        if(vertexCount < 0) {
+            status = Util::TE_InvalidArg;
+            return;
+        }
         totalSize = 8 + 4 + (vertexCount * 6);
 
-        u = new unsigned short[vertexCount*2];
-        v = new unsigned short[vertexCount*2];
-        height = new unsigned short[vertexCount*2];
-
-        short utmp = 0;
-        short vtmp = 0;
-        short htmp = 0;
-        for (int i = 0; i < vertexCount; i++) {
-            utmp = zzDec(buffer, u, utmp, i);
-        }
-        
-        for (int i = 0; i < vertexCount; i++) {
-            vtmp = zzDec(buffer, v, vtmp, i);
-        }
-        
-        for (int i = 0; i < vertexCount; i++) {
-            htmp =  zzDec(buffer, height, htmp, i);
-        }
+        // the u, v and height streams are each decoded in bulk directly
+        // into the interleaved positions
+        const std::size_t count = static_cast<std::size_t>(vertexCount);
+        positions.resize(count * 3u);
+        const uint8_t *block;
+        std::unique_ptr<uint8_t[]> blockBuf;
+        status = QuantizedMesh_readBlock(&block, blockBuf, *buffer, count * 6u);
+        if(status != Util::TE_Ok)
+            return;
+        for(std::size_t i = 0; i < 3u; i++)
+            QuantizedMesh_decodeZigZagDelta(positions.data() + i, 3u, block + (i * count * 2u), count);
     }
 
-    int zzDec(int value) {
-        return (value >> 1) ^ (-(value & 1));
+    uint16_t u(int index) const {
+        return positions[index*3];
     }
-
-    int zzDec(Util::FileInput2  * buffer, unsigned short *arr, int previous, int index) {
-        short s;
-        buffer->readShort(&s);
-
-        unsigned short ss = static_cast<unsigned>(s);
-        previous += zzDec(ss);
-        arr[index] = previous;
-        return previous;
+    uint16_t v(int index) const {
+        return positions[index*3+1];
+    }
+    uint16_t height(int index) const {
+        return positions[index*3+2];
     }
 
     void get(int index, TAK::Engine::Math::Vector4<double> *vec) {
-        vec->x = u[index];
-        vec->y = v[index];
-        vec->z = height[index];
+        vec->x = u(index);
+        vec->y = v(index);
+        vec->z = height(index);
     }
 
 };
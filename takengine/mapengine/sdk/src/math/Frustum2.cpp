@@ -1,9 +1,205 @@
 #include "math/Frustum2.h"
 
+#include <cmath>
+
 #include "math/Vector4.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TE_FRUSTUM2_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TE_FRUSTUM2_NEON
+#endif
+
 using namespace TAK::Engine::Math;
 
+namespace
+{
+    struct PlaneSet
+    {
+        double nx[6u];
+        double ny[6u];
+        double nz[6u];
+        // absolute values of the normal, for box radius
+        double ax[6u];
+        double ay[6u];
+        double az[6u];
+        double d[6u];
+    };
+
+    template<class Plane>
+    void PlaneSet_set(PlaneSet *value, const Plane *frustum) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < 6u; i++) {
+            value->nx[i] = frustum[i].normal.x;
+            value->ny[i] = frustum[i].normal.y;
+            value->nz[i] = frustum[i].normal.z;
+            value->ax[i] = fabs(frustum[i].normal.x);
+            value->ay[i] = fabs(frustum[i].normal.y);
+            value->az[i] = fabs(frustum[i].normal.z);
+            value->d[i] = frustum[i].dist;
+        }
+    }
+
+    struct ScalarOps
+    {
+        typedef double type;
+        enum { width = 1u };
+        static type load(const double *v) NOTHROWS { return *v; }
+        static type set1(const double v) NOTHROWS { return v; }
+        static type add(const type a, const type b) NOTHROWS { return a + b; }
+        static type sub(const type a, const type b) NOTHROWS { return a - b; }
+        static type mul(const type a, const type b) NOTHROWS { return a * b; }
+        // lane bitmasks of the comparison
+        static unsigned lt(const type a, const type b) NOTHROWS { return (a < b) ? 1u : 0u; }
+        static unsigned ge(const type a, const type b) NOTHROWS { return (a >= b) ? 1u : 0u; }
+    };
+#if defined(TE_FRUSTUM2_SSE2)
+    struct SimdOps
+    {
+        typedef __m128d type;
+        enum { width = 2u };
+        static type load(const double *v) NOTHROWS { return _mm_loadu_pd(v); }
+        static type set1(const double v) NOTHROWS { return _mm_set1_pd(v); }
+        static type add(const type a, const type b) NOTHROWS { return _mm_add_pd(a, b); }
+        static type sub(const type a, const type b) NOTHROWS { return _mm_sub_pd(a, b); }
+        static type mul(const type a, const type b) NOTHROWS { return _mm_mul_pd(a, b); }
+        static unsigned lt(const type a, const type b) NOTHROWS { return (unsigned)_mm_movemask_pd(_mm_cmplt_pd(a, b)); }
+        static unsigned ge(const type a, const type b) NOTHROWS { return (unsigned)_mm_movemask_pd(_mm_cmpge_pd(a, b)); }
+    };
+#elif defined(TE_FRUSTUM2_NEON)
+    struct SimdOps
+    {
+        typedef float64x2_t type;
+        enum { width = 2u };
+        static type load(const double *v) NOTHROWS { return vld1q_f64(v); }
+        static type set1(const double v) NOTHROWS { return vdupq_n_f64(v); }
+        static type add(const type a, const type b) NOTHROWS { return vaddq_f64(a, b); }
+        static type sub(const type a, const type b) NOTHROWS { return vsubq_f64(a, b); }
+        static type mul(const type a, const type b) NOTHROWS { return vmulq_f64(a, b); }
+        static unsigned lt(const type a, const type b) NOTHROWS { return movemask(vcltq_f64(a, b)); }
+        static unsigned ge(const type a, const type b) NOTHROWS { return movemask(vcgeq_f64(a, b)); }
+    private :
+        static unsigned movemask(const uint64x2_t m) NOTHROWS
+        {
+            return (unsigned)((vgetq_lane_u64(m, 0) & 0x1u) | ((vgetq_lane_u64(m, 1) & 0x1u) << 1u));
+        }
+    };
+#endif
+
+    template<class Ops>
+    struct BoxLanes
+    {
+        typedef typename Ops::type V;
+
+        BoxLanes(const double *minX, const double *minY, const double *minZ, const double *maxX, const double *maxY, const double *maxZ) NOTHROWS
+        {
+            const V half = Ops::set1(0.5);
+            const V x0 = Ops::load(minX), y0 = Ops::load(minY), z0 = Ops::load(minZ);
+            const V x1 = Ops::load(maxX), y1 = Ops::load(maxY), z1 = Ops::load(maxZ);
+            cx = Ops::mul(Ops::add(x1, x0), half);
+            cy = Ops::mul(Ops::add(y1, y0), half);
+            cz = Ops::mul(Ops::add(z1, z0), half);
+            ex = Ops::mul(Ops::sub(x1, x0), half);
+            ey = Ops::mul(Ops::sub(y1, y0), half);
+            ez = Ops::mul(Ops::sub(z1, z0), half);
+        }
+
+        // signed distance of the center and the radius relative to plane `i`
+        void eval(V *dist, V *r, const PlaneSet &p, const std::size_t i) const NOTHROWS
+        {
+            *dist = Ops::add(Ops::add(Ops::mul(Ops::set1(p.nx[i]), cx), Ops::mul(Ops::set1(p.ny[i]), cy)),
+                             Ops::add(Ops::mul(Ops::set1(p.nz[i]), cz), Ops::set1(p.d[i])));
+            *r = Ops::add(Ops::add(Ops::mul(Ops::set1(p.ax[i]), ex), Ops::mul(Ops::set1(p.ay[i]), ey)),
+                          Ops::mul(Ops::set1(p.az[i]), ez));
+        }
+
+        V cx, cy, cz;
+        V ex, ey, ez;
+    };
+
+    template<class Ops>
+    struct SphereLanes
+    {
+        typedef typename Ops::type V;
+
+        SphereLanes(const double *centerX, const double *centerY, const double *centerZ, const double *radius) NOTHROWS :
+            cx(Ops::load(centerX)),
+            cy(Ops::load(centerY)),
+            cz(Ops::load(centerZ)),
+            rad(Ops::load(radius))
+        {}
+
+        void eval(V *dist, V *r, const PlaneSet &p, const std::size_t i) const NOTHROWS
+        {
+            *dist = Ops::add(Ops::add(Ops::mul(Ops::set1(p.nx[i]), cx), Ops::mul(Ops::set1(p.ny[i]), cy)),
+                             Ops::add(Ops::mul(Ops::set1(p.nz[i]), cz), Ops::set1(p.d[i])));
+            *r = rad;
+        }
+
+        V cx, cy, cz;
+        V rad;
+    };
+
+    /**
+     * @return  lane bitmask of the volumes that are outside of any plane
+     */
+    template<class Ops, class Lanes>
+    unsigned outside(const PlaneSet &planes, const Lanes &lanes) NOTHROWS
+    {
+        const unsigned all = (1u << Ops::width) - 1u;
+        const typename Ops::type zero = Ops::set1(0.0);
+        unsigned out = 0u;
+        for (std::size_t i = 0u; i < 6u; i++) {
+            typename Ops::type dist, r;
+            lanes.eval(&dist, &r, planes, i);
+            out |= Ops::lt(dist, Ops::sub(zero, r));
+            if (out == all)
+                break;
+        }
+        return out;
+    }
+
+    template<class Ops, class Lanes>
+    void classify(uint8_t *masks, const PlaneSet &planes, const Lanes &lanes) NOTHROWS
+    {
+        const typename Ops::type zero = Ops::set1(0.0);
+        // planes remaining to be tested per lane
+        unsigned test[Ops::width];
+        unsigned pending = 0u;
+        for (std::size_t l = 0u; l < Ops::width; l++) {
+            test[l] = (masks[l] & TAK::Engine::Math::Frustum2::Outside) ? 0u : (masks[l] & TAK::Engine::Math::Frustum2::AllPlanes);
+            pending |= test[l];
+        }
+        for (std::size_t i = 0u; i < 6u && pending; i++) {
+            const unsigned bit = 1u << i;
+            if (!(pending & bit))
+                continue;
+            typename Ops::type dist, r;
+            lanes.eval(&dist, &r, planes, i);
+            const unsigned out = Ops::lt(dist, Ops::sub(zero, r));
+            const unsigned in = Ops::ge(dist, r);
+            pending = 0u;
+            for (std::size_t l = 0u; l < Ops::width; l++) {
+                if (test[l] & bit) {
+                    if (out & (1u << l)) {
+                        masks[l] = TAK::Engine::Math::Frustum2::Outside;
+                        test[l] = 0u;
+                    } else if (in & (1u << l)) {
+                        test[l] &= ~bit;
+                    }
+                }
+                pending |= test[l];
+            }
+        }
+        for (std::size_t l = 0u; l < Ops::width; l++) {
+            if (!(masks[l] & TAK::Engine::Math::Frustum2::Outside))
+                masks[l] = (uint8_t)test[l];
+        }
+    }
+}
+
 
 Frustum2::Plane::Plane() :
     normal(0, 0, 1),
@@ -123,6 +319,64 @@ Frustum2::Plane::Plane(const Vector4<double> &normal_, double dist_) :
                 return true;
             }
 
+            void Frustum2::intersects(bool *result, const double *minX, const double *minY, const double *minZ, const double *maxX, const double *maxY, const double *maxZ, const std::size_t count) const NOTHROWS
+            {
+                PlaneSet planes;
+                PlaneSet_set(&planes, frustum);
+                std::size_t i = 0u;
+#if defined(TE_FRUSTUM2_SSE2) || defined(TE_FRUSTUM2_NEON)
+                for (; (i + SimdOps::width) <= count; i += SimdOps::width) {
+                    const unsigned out = outside<SimdOps>(planes, BoxLanes<SimdOps>(minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i));
+                    for (std::size_t l = 0u; l < SimdOps::width; l++)
+                        result[i + l] = !(out & (1u << l));
+                }
+#endif
+                for (; i < count; i++)
+                    result[i] = !outside<ScalarOps>(planes, BoxLanes<ScalarOps>(minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i));
+            }
+
+            void Frustum2::intersects(bool *result, const double *centerX, const double *centerY, const double *centerZ, const double *radius, const std::size_t count) const NOTHROWS
+            {
+                PlaneSet planes;
+                PlaneSet_set(&planes, frustum);
+                std::size_t i = 0u;
+#if defined(TE_FRUSTUM2_SSE2) || defined(TE_FRUSTUM2_NEON)
+                for (; (i + SimdOps::width) <= count; i += SimdOps::width) {
+                    const unsigned out = outside<SimdOps>(planes, SphereLanes<SimdOps>(centerX + i, centerY + i, centerZ + i, radius + i));
+                    for (std::size_t l = 0u; l < SimdOps::width; l++)
+                        result[i + l] = !(out & (1u << l));
+                }
+#endif
+                for (; i < count; i++)
+                    result[i] = !outside<ScalarOps>(planes, SphereLanes<ScalarOps>(centerX + i, centerY + i, centerZ + i, radius + i));
+            }
+
+            void Frustum2::classify(uint8_t *masks, const double *minX, const double *minY, const double *minZ, const double *maxX, const double *maxY, const double *maxZ, const std::size_t count) const NOTHROWS
+            {
+                PlaneSet planes;
+                PlaneSet_set(&planes, frustum);
+                std::size_t i = 0u;
+#if defined(TE_FRUSTUM2_SSE2) || defined(TE_FRUSTUM2_NEON)
+                for (; (i + SimdOps::width) <= count; i += SimdOps::width)
+                    ::classify<SimdOps>(masks + i, planes, BoxLanes<SimdOps>(minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i));
+#endif
+                for (; i < count; i++)
+                    ::classify<ScalarOps>(masks + i, planes, BoxLanes<ScalarOps>(minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i));
+            }
+
+            void Frustum2::classify(uint8_t *masks, const double *centerX, const double *centerY, const double *centerZ, const double *radius, const std::size_t count) const NOTHROWS
+            {
+                PlaneSet planes;
+                PlaneSet_set(&planes, frustum);
+                std::size_t i = 0u;
+#if defined(TE_FRUSTUM2_SSE2) || defined(TE_FRUSTUM2_NEON)
+                for (; (i + SimdOps::width) <= count; i += SimdOps::width)
+                    ::classify<SimdOps>(masks + i, planes, SphereLanes<SimdOps>(centerX + i, centerY + i, centerZ + i, radius + i));
+#endif
+                for (; i < count; i++)
+                    ::classify<ScalarOps>(masks + i, planes, SphereLanes<ScalarOps>(centerX + i, centerY + i, centerZ + i, radius + i));
+            }
+
             double Frustum2::depthIfInside(const Sphere2& s) const NOTHROWS
             {
                 double dist = NAN;
@@ -1,6 +1,9 @@
 #ifndef ATAKMAP_MATH_FRUSTUM2_H_INCLUDED
 #define ATAKMAP_MATH_FRUSTUM2_H_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+
 #include "math/AABB.h"
 #include "math/Matrix2.h"
 #include "math/Sphere2.h"
@@ -23,6 +26,18 @@ namespace TAK
                     Vector4<double> normal;
                     double dist;
                 };
+            public :
+                /**
+                 * Plane masks used by the hierarchical tests. Bit `i` is set
+                 * if plane `i` still needs to be tested.
+                 */
+                enum : uint8_t
+                {
+                    /** All six planes must be tested */
+                    AllPlanes = 0x3Fu,
+                    /** The volume is fully outside of the frustum */
+                    Outside = 0x80u,
+                };
             public:
                 Frustum2(const Matrix2 &proj, const Matrix2 &model) NOTHROWS;
                 Frustum2(const Matrix2 &clip) NOTHROWS;
@@ -30,6 +45,37 @@ namespace TAK
                 void update(const Matrix2 &proj, const Matrix2 &model) NOTHROWS;
                 bool intersects(const Sphere2 &s) const NOTHROWS;
                 bool intersects(const AABB &a) const NOTHROWS;
+                /**
+                 * Tests `count` axis-aligned boxes, in structure-of-arrays
+                 * layout, against the frustum. Boxes are tested in parallel
+                 * where SIMD is available.
+                 *
+                 * @param result    Returns, per box, `true` if the box
+                 *                  intersects the frustum
+                 */
+                void intersects(bool *result, const double *minX, const double *minY, const double *minZ, const double *maxX, const double *maxY, const double *maxZ, const std::size_t count) const NOTHROWS;
+                /**
+                 * Tests `count` spheres, in structure-of-arrays layout,
+                 * against the frustum.
+                 *
+                 * @param result    Returns, per sphere, `true` if the sphere
+                 *                  intersects the frustum
+                 */
+                void intersects(bool *result, const double *centerX, const double *centerY, const double *centerZ, const double *radius, const std::size_t count) const NOTHROWS;
+                /**
+                 * Hierarchical variant of the batch box test. On input,
+                 * `planes` holds, per box, the mask of planes to test;
+                 * `AllPlanes` for a root and the parent's output for a child.
+                 * On output it holds the planes the box straddles, `0` if the
+                 * box is fully inside or `Outside` if it is culled. Planes
+                 * already known to contain the box are skipped.
+                 */
+                void classify(uint8_t *planes, const double *minX, const double *minY, const double *minZ, const double *maxX, const double *maxY, const double *maxZ, const std::size_t count) const NOTHROWS;
+                /**
+                 * Hierarchical variant of the batch sphere test. See
+                 * `classify` for boxes for the interpretation of `planes`.
+                 */
+                void classify(uint8_t *planes, const double *centerX, const double *centerY, const double *centerZ, const double *radius, const std::size_t count) const NOTHROWS;
                 double depthIfInside(const Sphere2 &s) const NOTHROWS;
                 Matrix2 getClip() const NOTHROWS;
             private :
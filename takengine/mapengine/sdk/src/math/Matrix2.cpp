@@ -3,6 +3,17 @@
 #include <cmath>
 #include "util/Error.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TE_MATRIX2_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TE_MATRIX2_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TE_MATRIX2_NEON
+#endif
+
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Math;
 
@@ -26,6 +37,9 @@ namespace // unnamed namespace
 
     bool isEquivalentToZero(const double n);
 
+    template<class T>
+    TAKErr transformImpl(T *dst, const T *src, const std::size_t count, const std::size_t size, const std::size_t dstStride, const std::size_t srcStride, const double *m, const bool affine) NOTHROWS;
+
 } // end unnamed namespace
 
 
@@ -65,6 +79,28 @@ TAKErr Matrix2::transform(Point2<double> *dst, const Point2<double> &src) const
     return TE_Ok;
 }
 
+TAKErr Matrix2::transform(double *dst, const double *src, const std::size_t count, const std::size_t size, const std::size_t dstStride, const std::size_t srcStride) const NOTHROWS
+{
+    if (!dst || !src)
+        return TE_InvalidArg;
+    if (size != 2u && size != 3u)
+        return TE_InvalidArg;
+    double m[16u];
+    get(m, COLUMN_MAJOR);
+    return transformImpl(dst, src, count, size, dstStride ? dstStride : size, srcStride ? srcStride : size, m, isAffine());
+}
+
+TAKErr Matrix2::transform(float *dst, const float *src, const std::size_t count, const std::size_t size, const std::size_t dstStride, const std::size_t srcStride) const NOTHROWS
+{
+    if (!dst || !src)
+        return TE_InvalidArg;
+    if (size != 2u && size != 3u)
+        return TE_InvalidArg;
+    double m[16u];
+    get(m, COLUMN_MAJOR);
+    return transformImpl(dst, src, count, size, dstStride ? dstStride : size, srcStride ? srcStride : size, m, isAffine());
+}
+
 TAKErr Matrix2::createInverse(Matrix2 *t) const NOTHROWS//const throw (NonInvertibleTransformException)
 {
     const double determinant = (m00*m11*m22*m33) + (m00*m12*m23*m31) + (m00*m13*m21*m32)
@@ -688,4 +724,81 @@ namespace // unnamed namespace
         return ((n < 1e-13) && (n > -1e-13));
     }
 
+    template<class T>
+    TAKErr transformImpl(T *dst, const T *src, const std::size_t count, const std::size_t size, const std::size_t dstStride, const std::size_t srcStride, const double *m, const bool affine) NOTHROWS
+    {
+        // `m` is column major; each point is the sum of the first three
+        // columns scaled by x, y and z, plus the fourth column. Sums are
+        // evaluated in the same order as the single point transform.
+        TAKErr code(TE_Ok);
+#if defined(TE_MATRIX2_AVX)
+        const __m256d c0 = _mm256_loadu_pd(m);
+        const __m256d c1 = _mm256_loadu_pd(m + 4u);
+        const __m256d c2 = _mm256_loadu_pd(m + 8u);
+        const __m256d c3 = _mm256_loadu_pd(m + 12u);
+#elif defined(TE_MATRIX2_SSE2)
+        const __m128d c0xy = _mm_loadu_pd(m), c0zw = _mm_loadu_pd(m + 2u);
+        const __m128d c1xy = _mm_loadu_pd(m + 4u), c1zw = _mm_loadu_pd(m + 6u);
+        const __m128d c2xy = _mm_loadu_pd(m + 8u), c2zw = _mm_loadu_pd(m + 10u);
+        const __m128d c3xy = _mm_loadu_pd(m + 12u), c3zw = _mm_loadu_pd(m + 14u);
+#elif defined(TE_MATRIX2_NEON)
+        const float64x2_t c0xy = vld1q_f64(m), c0zw = vld1q_f64(m + 2u);
+        const float64x2_t c1xy = vld1q_f64(m + 4u), c1zw = vld1q_f64(m + 6u);
+        const float64x2_t c2xy = vld1q_f64(m + 8u), c2zw = vld1q_f64(m + 10u);
+        const float64x2_t c3xy = vld1q_f64(m + 12u), c3zw = vld1q_f64(m + 14u);
+#endif
+        for (std::size_t i = 0u; i < count; i++) {
+            const T *s = src + (i * srcStride);
+            const double x = (double)s[0];
+            const double y = (double)s[1];
+            const double z = (size > 2u) ? (double)s[2] : 0.0;
+            double r[4u];
+#if defined(TE_MATRIX2_AVX)
+            __m256d acc = _mm256_mul_pd(_mm256_set1_pd(x), c0);
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(y), c1));
+            acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_set1_pd(z), c2));
+            acc = _mm256_add_pd(acc, c3);
+            _mm256_storeu_pd(r, acc);
+#elif defined(TE_MATRIX2_SSE2)
+            const __m128d vx = _mm_set1_pd(x), vy = _mm_set1_pd(y), vz = _mm_set1_pd(z);
+            __m128d xy = _mm_mul_pd(vx, c0xy);
+            __m128d zw = _mm_mul_pd(vx, c0zw);
+            xy = _mm_add_pd(xy, _mm_mul_pd(vy, c1xy));
+            zw = _mm_add_pd(zw, _mm_mul_pd(vy, c1zw));
+            xy = _mm_add_pd(xy, _mm_mul_pd(vz, c2xy));
+            zw = _mm_add_pd(zw, _mm_mul_pd(vz, c2zw));
+            _mm_storeu_pd(r, _mm_add_pd(xy, c3xy));
+            _mm_storeu_pd(r + 2u, _mm_add_pd(zw, c3zw));
+#elif defined(TE_MATRIX2_NEON)
+            const float64x2_t vx = vdupq_n_f64(x), vy = vdupq_n_f64(y), vz = vdupq_n_f64(z);
+            float64x2_t xy = vmulq_f64(vx, c0xy);
+            float64x2_t zw = vmulq_f64(vx, c0zw);
+            xy = vaddq_f64(xy, vmulq_f64(vy, c1xy));
+            zw = vaddq_f64(zw, vmulq_f64(vy, c1zw));
+            xy = vaddq_f64(xy, vmulq_f64(vz, c2xy));
+            zw = vaddq_f64(zw, vmulq_f64(vz, c2zw));
+            vst1q_f64(r, vaddq_f64(xy, c3xy));
+            vst1q_f64(r + 2u, vaddq_f64(zw, c3zw));
+#else
+            for (std::size_t j = 0u; j < 4u; j++)
+                r[j] = x * m[j] + y * m[4u + j] + z * m[8u + j] + m[12u + j];
+#endif
+            T *d = dst + (i * dstStride);
+            if (affine) {
+                d[0] = (T)r[0];
+                d[1] = (T)r[1];
+                if (size > 2u)
+                    d[2] = (T)r[2];
+            } else if (r[3] == 0.0) {
+                code = TE_Err;
+            } else {
+                d[0] = (T)(r[0] / r[3]);
+                d[1] = (T)(r[1] / r[3]);
+                if (size > 2u)
+                    d[2] = (T)(r[2] / r[3]);
+            }
+        }
+        return code;
+    }
+
 }; // end unnamed namespace
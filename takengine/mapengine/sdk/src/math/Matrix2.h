@@ -1,6 +1,8 @@
 #ifndef TAK_ENGINE_MATH_MATRIX2_H_INCLUDED
 #define TAK_ENGINE_MATH_MATRIX2_H_INCLUDED
 
+#include <cstddef>
+
 #include "math/Point2.h"
 #include "port/Platform.h"
 #include "util/Error.h"
@@ -28,7 +30,37 @@ namespace TAK
                 ~Matrix2() NOTHROWS;
             public:
                 TAK::Engine::Util::TAKErr transform(TAK::Engine::Math::Point2<double> *dst, const TAK::Engine::Math::Point2<double> &src) const NOTHROWS;
+                /**
+                 * Transforms `count` points. Each point is `size` (2 or 3)
+                 * consecutive components; when `size` is 2, z is taken as
+                 * zero and is not written. Strides are the number of elements
+                 * between consecutive points, with `0` meaning tightly packed.
+                 * `dst` may be the same as `src` if the layouts match.
+                 *
+                 * @return  TE_Ok on success; TE_Err if any point has a `w`
+                 *          of zero, in which case those points are left
+                 *          unmodified and the remainder are transformed
+                 */
+                TAK::Engine::Util::TAKErr transform(double *dst, const double *src, const std::size_t count, const std::size_t size = 3u, const std::size_t dstStride = 0u, const std::size_t srcStride = 0u) const NOTHROWS;
+                /**
+                 * Transforms `count` single precision points. Computation is
+                 * performed in double precision. See the `double` overload.
+                 */
+                TAK::Engine::Util::TAKErr transform(float *dst, const float *src, const std::size_t count, const std::size_t size = 3u, const std::size_t dstStride = 0u, const std::size_t srcStride = 0u) const NOTHROWS;
                 TAK::Engine::Util::TAKErr createInverse(Matrix2 *t) const NOTHROWS;
+                /**
+                 * Computes the inverse, using the cheaper 3x3 inverse when
+                 * the matrix is affine. Non-affine matrices are inverted via
+                 * `createInverse`. `value` must not be this matrix.
+                 */
+                inline TAK::Engine::Util::TAKErr createAffineInverse(Matrix2 *value) const NOTHROWS;
+                /**
+                 * Computes `this * t` into `value`, without modifying this
+                 * matrix. `value` must not be this matrix or `t`.
+                 */
+                inline void multiply(Matrix2 *value, const Matrix2 &t) const NOTHROWS;
+                /** @return `true` if the last row is `0 0 0 1` */
+                inline bool isAffine() const NOTHROWS;
                 void concatenate(const Matrix2 &t) NOTHROWS;
                 void preConcatenate(const Matrix2 &t) NOTHROWS;
                 void set(const Matrix2 &t) NOTHROWS;
@@ -82,6 +114,70 @@ namespace TAK
                 double m33;
             };
 
+            inline bool Matrix2::isAffine() const NOTHROWS
+            {
+                return (m30 == 0.0 && m31 == 0.0 && m32 == 0.0 && m33 == 1.0);
+            }
+
+            inline void Matrix2::multiply(Matrix2 *value, const Matrix2 &t) const NOTHROWS
+            {
+                value->m00 = m00*t.m00 + m01*t.m10 + m02*t.m20 + m03*t.m30;
+                value->m01 = m00*t.m01 + m01*t.m11 + m02*t.m21 + m03*t.m31;
+                value->m02 = m00*t.m02 + m01*t.m12 + m02*t.m22 + m03*t.m32;
+                value->m03 = m00*t.m03 + m01*t.m13 + m02*t.m23 + m03*t.m33;
+                value->m10 = m10*t.m00 + m11*t.m10 + m12*t.m20 + m13*t.m30;
+                value->m11 = m10*t.m01 + m11*t.m11 + m12*t.m21 + m13*t.m31;
+                value->m12 = m10*t.m02 + m11*t.m12 + m12*t.m22 + m13*t.m32;
+                value->m13 = m10*t.m03 + m11*t.m13 + m12*t.m23 + m13*t.m33;
+                value->m20 = m20*t.m00 + m21*t.m10 + m22*t.m20 + m23*t.m30;
+                value->m21 = m20*t.m01 + m21*t.m11 + m22*t.m21 + m23*t.m31;
+                value->m22 = m20*t.m02 + m21*t.m12 + m22*t.m22 + m23*t.m32;
+                value->m23 = m20*t.m03 + m21*t.m13 + m22*t.m23 + m23*t.m33;
+                value->m30 = m30*t.m00 + m31*t.m10 + m32*t.m20 + m33*t.m30;
+                value->m31 = m30*t.m01 + m31*t.m11 + m32*t.m21 + m33*t.m31;
+                value->m32 = m30*t.m02 + m31*t.m12 + m32*t.m22 + m33*t.m32;
+                value->m33 = m30*t.m03 + m31*t.m13 + m32*t.m23 + m33*t.m33;
+            }
+
+            inline TAK::Engine::Util::TAKErr Matrix2::createAffineInverse(Matrix2 *value) const NOTHROWS
+            {
+                if (!isAffine())
+                    return createInverse(value);
+
+                // cofactors of the upper-left 3x3
+                const double c00 = m11*m22 - m12*m21;
+                const double c01 = m12*m20 - m10*m22;
+                const double c02 = m10*m21 - m11*m20;
+                const double determinant = m00*c00 + m01*c01 + m02*c02;
+                if (determinant == 0.0)
+                    return TAK::Engine::Util::TE_Err;
+                const double recipDet = 1.0 / determinant;
+
+                value->m00 = c00 * recipDet;
+                value->m01 = (m02*m21 - m01*m22) * recipDet;
+                value->m02 = (m01*m12 - m02*m11) * recipDet;
+                value->m10 = c01 * recipDet;
+                value->m11 = (m00*m22 - m02*m20) * recipDet;
+                value->m12 = (m02*m10 - m00*m12) * recipDet;
+                value->m20 = c02 * recipDet;
+                value->m21 = (m01*m20 - m00*m21) * recipDet;
+                value->m22 = (m00*m11 - m01*m10) * recipDet;
+
+                // translation is the negated, inverse transformed translation
+                const double tx = m03;
+                const double ty = m13;
+                const double tz = m23;
+                value->m03 = -(value->m00*tx + value->m01*ty + value->m02*tz);
+                value->m13 = -(value->m10*tx + value->m11*ty + value->m12*tz);
+                value->m23 = -(value->m20*tx + value->m21*ty + value->m22*tz);
+
+                value->m30 = 0.0;
+                value->m31 = 0.0;
+                value->m32 = 0.0;
+                value->m33 = 1.0;
+                return TAK::Engine::Util::TE_Ok;
+            }
+
             typedef std::unique_ptr<Matrix2, void(*)(const Matrix2 *)> Matrix2Ptr;
             typedef std::unique_ptr<const Matrix2, void(*)(const Matrix2 *)> Matrix2Ptr_const;
 
@@ -2,8 +2,10 @@
 #include "model/ASSIMPSceneSpi.h"
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <sstream>
+#include <vector>
 
 #include "assimp/Importer.hpp"
 #include "assimp/IOSystem.hpp"
@@ -14,15 +16,24 @@
 #include "util/IO2.h"
 #include "model/SceneBuilder.h"
 #include "model/MeshBuilder.h"
+#include "model/MeshSimplifier.h"
 #include "math/Matrix2.h"
+#include "port/Platform.h"
+#include "thread/Lock.h"
+#include "thread/Monitor.h"
+#include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine::Model;
 
 using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 #define __EXP_PRETRANSFORM_VERTICES
 #define __EXP_MESH_VERTEX_LIMIT (0xFFFF*3u) // 64k triangles
+#define __EXP_LOD_MIN_FACES 256u
 
 namespace {
     class TAKAssimpIOStream : public Assimp::IOStream {
@@ -243,6 +254,39 @@ namespace {
         float fileStageMult;
     };
 
+    /**
+     * A run of vertices of an `aiMesh` to be appended to a `MeshBuilder`.
+     */
+    struct MeshConversion
+    {
+        const aiMesh *mesh;
+        std::size_t begin;
+        std::size_t end;
+        /** pre-transform for the vertices, if `transformed` */
+        Matrix2 transform;
+        bool transformed;
+        /** material color, applied to the vertex colors */
+        float color[4];
+    };
+
+    /**
+     * An output mesh and the vertex runs from which it is built. Segments
+     * are independent of one another, so the conversion of the vertices
+     * is deferred until the node graph has been traversed and then
+     * performed for all segments in parallel.
+     */
+    struct MeshSegment
+    {
+        MeshSegment(MeshBuilder *builder_) NOTHROWS :
+            builder(builder_),
+            mesh(nullptr, nullptr)
+        {}
+
+        std::unique_ptr<MeshBuilder> builder;
+        std::vector<MeshConversion> conversions;
+        MeshPtr mesh;
+    };
+
     class MultiMeshBuilder
     {
     public :
@@ -254,18 +298,19 @@ namespace {
             builderVerts(0u)
         {}
     public :
-        MeshBuilder &push(std::size_t numVerts = __EXP_MESH_VERTEX_LIMIT) NOTHROWS
+        MeshSegment &push(std::size_t numVerts = __EXP_MESH_VERTEX_LIMIT) NOTHROWS
         {
-            builders.push_back(std::move(std::unique_ptr<MeshBuilder>(new MeshBuilder(tedm, attr))));
+            builders.push_back(std::move(std::unique_ptr<MeshSegment>(new MeshSegment(new MeshBuilder(tedm, attr)))));
             builderVerts = 0u;
+            MeshBuilder &builder = *builders.back()->builder;
             for(std::size_t i = 0u; i < mats.size(); i++)
-                builders.back()->addMaterial(mats[i]);
-            builders.back()->setWindingOrder(tewo);
-            builders.back()->reserveVertices(numVerts);
+                builder.addMaterial(mats[i]);
+            builder.setWindingOrder(tewo);
+            builder.reserveVertices(numVerts);
             return *builders.back();
         }
     public :
-        std::list<std::unique_ptr<MeshBuilder>> builders;
+        std::list<std::unique_ptr<MeshSegment>> builders;
         std::size_t totalVerts;
         std::size_t builderVerts;
         DrawMode tedm;
@@ -275,6 +320,125 @@ namespace {
         
     };
 
+    /**
+     * Generates simplified LODs for the meshes of a scene. Each worker
+     * claims the next unprocessed mesh until all have been processed or
+     * the import is canceled.
+     */
+    struct LODGenerator
+    {
+        /** per mesh, the full resolution mesh followed by its simplified LODs */
+        std::vector<std::vector<std::shared_ptr<const Mesh>>> meshes;
+        std::size_t maxLevels;
+        ProcessingCallback *callbacks;
+        std::atomic<std::size_t> next;
+    };
+
+    void generateLODs(std::vector<std::shared_ptr<const Mesh>> &lods, const std::size_t maxLevels) NOTHROWS
+    {
+        for (std::size_t level = 0u; level < maxLevels; level++) {
+            const Mesh &src = *lods.back();
+            const std::size_t srcFaces = src.getNumFaces();
+            // each LOD is rendered at half the resolution of the previous
+            const std::size_t targetFaces = srcFaces / 4u;
+            if (targetFaces < __EXP_LOD_MIN_FACES)
+                break;
+            MeshPtr simplified(nullptr, nullptr);
+            if (MeshSimplifier_simplify(simplified, src, targetFaces) != TE_Ok)
+                break;
+            // locked borders and seams may prevent meaningful reduction
+            if (simplified->getNumFaces() > (srcFaces * 3u) / 4u)
+                break;
+            lods.push_back(std::shared_ptr<const Mesh>(std::move(simplified)));
+        }
+    }
+
+    void *generateLODsThreadFn(void *opaque)
+    {
+        LODGenerator &generator = *static_cast<LODGenerator *>(opaque);
+        while (!ProcessingCallback_isCanceled(generator.callbacks)) {
+            const std::size_t idx = generator.next++;
+            if (idx >= generator.meshes.size())
+                break;
+            generateLODs(generator.meshes[idx], generator.maxLevels);
+        }
+        return nullptr;
+    }
+
+    /**
+     * State shared between `runParallel` and its helpers. Helpers that are
+     * not started before the caller finishes exit without invoking `fn`.
+     */
+    struct ParallelState
+    {
+        void *(*fn)(void *);
+        void *opaque;
+        Monitor monitor;
+        std::size_t active {0u};
+        bool closed {false};
+    };
+
+    class ParallelWork : public Work
+    {
+    public :
+        ParallelWork(const std::shared_ptr<ParallelState> &state_) NOTHROWS :
+            state(state_)
+        {}
+    protected :
+        TAKErr onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS override
+        {
+            lockPtr.reset();
+            {
+                Monitor::Lock lock(state->monitor);
+                TE_CHECKRETURN_CODE(lock.status);
+                if (state->closed)
+                    return TE_Ok;
+                state->active++;
+            }
+            state->fn(state->opaque);
+
+            Monitor::Lock lock(state->monitor);
+            TE_CHECKRETURN_CODE(lock.status);
+            state->active--;
+            lock.broadcast();
+            return TE_Ok;
+        }
+    private :
+        std::shared_ptr<ParallelState> state;
+    };
+
+    /**
+     * Runs `fn` on the calling thread and on up to `numTasks-1` of the
+     * engine CPU workers. `fn` is expected to claim tasks until none
+     * remain; as the calling thread participates, completion does not
+     * depend on the availability of the shared workers.
+     */
+    void runParallel(void *(*fn)(void *), void *opaque, const std::size_t numTasks) NOTHROWS
+    {
+        const std::size_t numThreads = std::min(TAK::Engine::Port::Platform_processorCount(), numTasks);
+        std::shared_ptr<ParallelState> state;
+        SharedWorkerPtr worker;
+        if (numThreads > 1u && WorkerRegistry_borrow(worker, TEWC_CPUDecode, "assimp-import", numThreads - 1u) == TE_Ok) {
+            state = std::make_shared<ParallelState>();
+            state->fn = fn;
+            state->opaque = opaque;
+            for (std::size_t i = 1u; i < numThreads; i++) {
+                if (worker->scheduleWork(std::make_shared<ParallelWork>(state)) != TE_Ok)
+                    break;
+            }
+        }
+
+        fn(opaque);
+        if (state) {
+            // wait out helpers that are still running; any not yet started
+            // will observe `closed`
+            Monitor::Lock lock(state->monitor);
+            state->closed = true;
+            while (lock.status == TE_Ok && state->active)
+                lock.wait();
+        }
+    }
+
 	bool isXUpTransform(const aiMatrix4x4 &t) {
 		const aiMatrix4x4 xUp(
 			0, -1, 0, 0,
@@ -300,6 +464,13 @@ namespace {
         return code;
     }
 
+    struct MeshInstance {
+        std::size_t meshId;
+        Matrix2 transform;
+        bool hasTransform;
+        const MultiMeshBuilder *data;
+    };
+
     struct SceneProcessInfo {
 
         SceneProcessInfo(const aiScene& scene, ProcessingCallback* callbacks)
@@ -324,6 +495,8 @@ namespace {
 
         void reportVertexProgress() {
             if (callbacks && callbacks->progress) {
+                // vertices are converted on multiple threads
+                Lock lock(progressMutex);
                 const double vertProgress = (double)this->numVerticesProcessed / (double)this->totalVertexCount;
                 callbacks->progress(callbacks->opaque, 50 + (int)(vertProgress * 50.0), 100);
             }
@@ -331,13 +504,21 @@ namespace {
 
         size_t totalVertexCount;
         size_t numMeshesProcessed;
-        size_t numVerticesProcessed;
+        std::atomic<size_t> numVerticesProcessed;
+        Mutex progressMutex;
         std::map<std::string, int> meshVertCounts;
         std::vector<int> meshInstanceCount;
         std::vector<bool> meshDataPushed;
         ProcessingCallback* callbacks;
         SceneBuilder builder;
         std::map<std::string, MultiMeshBuilder> builders;
+        /** builders for the data of instanced meshes */
+        std::list<std::unique_ptr<MultiMeshBuilder>> instanceBuilders;
+        /**
+         * The instances, in traversal order. The first instance of a mesh
+         * references the builder for its data.
+         */
+        std::vector<MeshInstance> instances;
     };
 
     TAKErr preprocessMesh(SceneProcessInfo &info, size_t &totalVertexCount, std::map<std::string, int> &meshVertCounts, std::vector<int> &meshInstanceCount, const char *uri, const aiScene &scene, const aiMesh &mesh) NOTHROWS
@@ -414,18 +595,13 @@ namespace {
 
         TAKErr code(TE_Ok);
         
-        std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)> mmbuilder(nullptr, nullptr);
+        MultiMeshBuilder *mmbuilder = nullptr;
 
         float matr = 1.f;
         float matg = 1.f;
         float matb = 1.f;
         float mata = 1.f;
 
-        std::size_t numTexCoords = 0u;
-        for (unsigned int i = 0u; i < 8u; ++i)
-            if (mesh.HasTextureCoords(i))
-                ++numTexCoords;
-
         int meshVertCount = 0;
 
         unsigned int materialIndex = mesh.mMaterialIndex;
@@ -466,10 +642,12 @@ namespace {
                 if (!isInstanced || mesh.HasVertexColors(0))
                     vertexAttr |= TEVA_Color;
 
-                if (isInstanced)
-                    mmbuilder = std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)>(new MultiMeshBuilder(), Memory_deleter_const<MultiMeshBuilder>);
-                else
-                    mmbuilder = std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)>(&p.builders[key], Memory_leaker_const<MultiMeshBuilder>);
+                if (isInstanced) {
+                    p.instanceBuilders.push_back(std::unique_ptr<MultiMeshBuilder>(new MultiMeshBuilder()));
+                    mmbuilder = p.instanceBuilders.back().get();
+                } else {
+                    mmbuilder = &p.builders[key];
+                }
                 mmbuilder->tedm = TEDM_Triangles;
                 mmbuilder->attr = vertexAttr;
                 mmbuilder->tewo = !twoSided ? TEWO_CounterClockwise : TEWO_Undefined;
@@ -525,7 +703,7 @@ namespace {
 
                 mmbuilder->push();
             } else {
-                mmbuilder = std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)>(&entry->second, Memory_leaker_const<MultiMeshBuilder>);
+                mmbuilder = &entry->second;
             }
         } else {
             auto entry = p.builders.find("");
@@ -536,10 +714,12 @@ namespace {
                 if (!isInstanced || mesh.HasVertexColors(0))
                     vertexAttr |= TEVA_Color;
 
-                if (isInstanced)
-                    mmbuilder = std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)>(new MultiMeshBuilder(), Memory_deleter_const<MultiMeshBuilder>);
-                else
-                    mmbuilder = std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)>(&p.builders[""], Memory_leaker_const<MultiMeshBuilder>);
+                if (isInstanced) {
+                    p.instanceBuilders.push_back(std::unique_ptr<MultiMeshBuilder>(new MultiMeshBuilder()));
+                    mmbuilder = p.instanceBuilders.back().get();
+                } else {
+                    mmbuilder = &p.builders[""];
+                }
                 mmbuilder->tedm = TEDM_Triangles;
                 mmbuilder->tewo = TEWO_Undefined;
                 mmbuilder->attr = vertexAttr;
@@ -564,7 +744,7 @@ namespace {
 
                 mmbuilder->push();
             } else {
-                mmbuilder = std::unique_ptr<MultiMeshBuilder, void(*)(const MultiMeshBuilder*)>(&entry->second, Memory_leaker_const<MultiMeshBuilder>);
+                mmbuilder = &entry->second;
             }
         }
 
@@ -573,12 +753,64 @@ namespace {
 
 
         //TODO-- other types points, etc.
-        MeshBuilder *builder = mmbuilder->builders.back().get();
-        aiVector3D *verts = mesh.mVertices;
-        aiVector3D *norms = mesh.mNormals;
+        MeshConversion conversion;
+        conversion.mesh = &mesh;
+#ifdef __EXP_PRETRANSFORM_VERTICES
+        conversion.transformed = (!isInstanced && transform);
+        if (conversion.transformed)
+            conversion.transform = *transform;
+#else
+        conversion.transformed = false;
+#endif
+        conversion.color[0] = matr;
+        conversion.color[1] = matg;
+        conversion.color[2] = matb;
+        conversion.color[3] = mata;
+
+        // assign the vertices to the output meshes; the vertices are
+        // converted once the node graph has been traversed
         const std::size_t vertCount = mesh.mNumVertices/3u*3u;
-        const std::size_t updateInterval = vertCount/100u;
-        for(std::size_t i = 0u; i < vertCount; i++, ++p.numVerticesProcessed) {
+        for (std::size_t i = 0u; i < vertCount; ) {
+            if (mmbuilder->builderVerts == __EXP_MESH_VERTEX_LIMIT)
+                mmbuilder->push();
+            const std::size_t count = std::min<std::size_t>(vertCount - i, __EXP_MESH_VERTEX_LIMIT - mmbuilder->builderVerts);
+            conversion.begin = i;
+            conversion.end = i + count;
+            mmbuilder->builders.back()->conversions.push_back(conversion);
+            mmbuilder->builderVerts += count;
+            mmbuilder->totalVerts += count;
+            i += count;
+        }
+
+        if (isInstanced) {
+            MeshInstance instance;
+            instance.meshId = meshId;
+            instance.hasTransform = !!transform;
+            if (transform)
+                instance.transform = *transform;
+            instance.data = mmbuilder;
+            p.instances.push_back(instance);
+        }
+        p.numMeshesProcessed++;
+
+        return code;
+    }
+
+    TAKErr appendVertices(SceneProcessInfo &p, MeshBuilder &builder, const MeshConversion &conversion) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const aiMesh &mesh = *conversion.mesh;
+        const aiVector3D *verts = mesh.mVertices;
+        const aiVector3D *norms = mesh.mNormals;
+
+        std::size_t numTexCoords = 0u;
+        for (unsigned int i = 0u; i < 8u; ++i)
+            if (mesh.HasTextureCoords(i))
+                ++numTexCoords;
+
+        const std::size_t updateInterval = (mesh.mNumVertices/3u*3u)/100u;
+        std::size_t reported = conversion.begin;
+        for(std::size_t i = conversion.begin; i < conversion.end; i++) {
             if (ProcessingCallback_isCanceled(p.callbacks))
                 return TE_Canceled;
 
@@ -586,11 +818,9 @@ namespace {
                 verts[i].y,
                 verts[i].z);
 
-#ifdef __EXP_PRETRANSFORM_VERTICES
-            if (!isInstanced && transform) {
-                transform->transform(&xyz, xyz);
+            if (conversion.transformed) {
+                conversion.transform.transform(&xyz, xyz);
             }
-#endif
 
             float nx = 0.f,
                 ny = 0.f,
@@ -613,10 +843,10 @@ namespace {
                 a = mesh.mColors[0][i].a;
             }
 
-            r *= matr;
-            g *= matg;
-            b *= matb;
-            a *= mata;
+            r *= conversion.color[0];
+            g *= conversion.color[1];
+            b *= conversion.color[2];
+            a *= conversion.color[3];
 
             float uv[16];
             for (size_t j = 0; j < numTexCoords; ++j) { 
@@ -624,31 +854,108 @@ namespace {
                 uv[j * 2 + 1] = 1.f - mesh.mTextureCoords[j][i].y;
             }
 
-            if (mmbuilder->builderVerts == __EXP_MESH_VERTEX_LIMIT)
-                builder = &mmbuilder->push();
-            code = builder->addVertex(xyz.x, xyz.y, xyz.z, uv, nx, ny, nz, r, g, b, a);
+            code = builder.addVertex(xyz.x, xyz.y, xyz.z, uv, nx, ny, nz, r, g, b, a);
             TE_CHECKRETURN_CODE(code);
 
-            mmbuilder->builderVerts++;
-            mmbuilder->totalVerts++;
-
-            // push progress update on progress interval
+            // push progress update on progress interval; the shared count
+            // is only updated at the interval to limit contention
             if (updateInterval > 0 && (i % updateInterval) == 0) {
+                p.numVerticesProcessed += (i + 1u - reported);
+                reported = i + 1u;
                 p.reportVertexProgress();
             }
         }
+        p.numVerticesProcessed += (conversion.end - reported);
 
-        if (isInstanced) {
-            for (auto j = mmbuilder->builders.begin(); j != mmbuilder->builders.end(); j++) {
-                MeshPtr built_mesh(nullptr, nullptr);
-                code = (*j)->build(built_mesh);
+        return code;
+    }
+
+    /**
+     * Converts the vertices of the output meshes. Each worker claims the
+     * next unconverted segment until all have been converted, a
+     * conversion fails or the import is canceled.
+     */
+    struct MeshConverter
+    {
+        SceneProcessInfo *info;
+        std::vector<MeshSegment *> segments;
+        std::vector<TAKErr> results;
+        std::atomic<std::size_t> next;
+        std::atomic<bool> failed;
+    };
+
+    TAKErr convertSegment(SceneProcessInfo &p, MeshSegment &segment) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        for (auto it = segment.conversions.begin(); it != segment.conversions.end(); it++) {
+            code = appendVertices(p, *segment.builder, *it);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        code = segment.builder->build(segment.mesh);
+        TE_CHECKRETURN_CODE(code);
+        // release the source data
+        segment.builder.reset();
+        return code;
+    }
+
+    void *convertSegmentsThreadFn(void *opaque)
+    {
+        MeshConverter &converter = *static_cast<MeshConverter *>(opaque);
+        while (!converter.failed && !ProcessingCallback_isCanceled(converter.info->callbacks)) {
+            const std::size_t idx = converter.next++;
+            if (idx >= converter.segments.size())
+                break;
+            converter.results[idx] = convertSegment(*converter.info, *converter.segments[idx]);
+            if (converter.results[idx] != TE_Ok)
+                converter.failed = true;
+        }
+        return nullptr;
+    }
+
+    TAKErr convertMeshes(SceneProcessInfo &p) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        MeshConverter converter;
+        converter.info = &p;
+        converter.next = 0u;
+        converter.failed = false;
+        TE_BEGIN_TRAP() {
+            for (auto i = p.builders.begin(); i != p.builders.end(); i++)
+                for (auto j = i->second.builders.begin(); j != i->second.builders.end(); j++)
+                    converter.segments.push_back(j->get());
+            for (auto i = p.instanceBuilders.begin(); i != p.instanceBuilders.end(); i++)
+                for (auto j = (*i)->builders.begin(); j != (*i)->builders.end(); j++)
+                    converter.segments.push_back(j->get());
+            converter.results.resize(converter.segments.size(), TE_Ok);
+        } TE_END_TRAP(code);
+        TE_CHECKRETURN_CODE(code);
+
+        runParallel(convertSegmentsThreadFn, &converter, converter.segments.size());
+        if (ProcessingCallback_isCanceled(p.callbacks))
+            return TE_Canceled;
+        for (auto it = converter.results.begin(); it != converter.results.end(); it++) {
+            code = *it;
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        // add the instances in traversal order
+        for (auto it = p.instances.begin(); it != p.instances.end(); it++) {
+            const Matrix2 *transform = it->hasTransform ? &it->transform : nullptr;
+            if (!it->data) {
+                code = p.builder.addMesh(it->meshId, transform);
                 TE_CHECKBREAK_CODE(code);
-                code = p.builder.addMesh(std::move(built_mesh), meshId, transform);
+                continue;
+            }
+            for (auto j = it->data->builders.begin(); j != it->data->builders.end(); j++) {
+                code = p.builder.addMesh(std::move((*j)->mesh), it->meshId, transform);
                 TE_CHECKBREAK_CODE(code);
             }
-            TE_CHECKRETURN_CODE(code);
+            TE_CHECKBREAK_CODE(code);
         }
-        p.numMeshesProcessed++;
+        TE_CHECKRETURN_CODE(code);
 
         return code;
     }
@@ -665,8 +972,13 @@ namespace {
                 continue;
             if (isInstanced && p.meshDataPushed[node.mMeshes[i]]) {
                 // if the node mesh is an instance mesh and the mesh data is pushed to the scene builder, just add the instance ID
-                code = p.builder.addMesh(node.mMeshes[i] + 1u, transform);
-                TE_CHECKBREAK_CODE(code);
+                MeshInstance instance;
+                instance.meshId = node.mMeshes[i] + 1u;
+                instance.hasTransform = !!transform;
+                if (transform)
+                    instance.transform = *transform;
+                instance.data = nullptr;
+                p.instances.push_back(instance);
             } else {
                 const aiMesh *mesh = scene.mMeshes[node.mMeshes[i]];
                 code = addMesh(p, URI, scene, node.mMeshes[i]+1u, *mesh, transform, resourceMapper, isInstanced);
@@ -855,14 +1167,33 @@ TAKErr ASSIMPSceneSpi::create(ScenePtr &scene, const char *URI, ProcessingCallba
     code = buildScene(procInfo, URI, *assimpScene, *rootNode, isIdentity ? nullptr : &rootTransform, ioSys.resourceMapper);
     TE_CHECKRETURN_CODE(code);
 
-    for (auto i = procInfo.builders.begin(); i != procInfo.builders.end(); i++) {
-        for (auto j = i->second.builders.begin(); j != i->second.builders.end(); j++) {
-            MeshPtr mesh(nullptr, nullptr);
-            code = (*j)->build(mesh);
-            TE_CHECKBREAK_CODE(code);
-            code = procInfo.builder.addMesh(std::move(mesh), nullptr);
-            TE_CHECKBREAK_CODE(code);
+    code = convertMeshes(procInfo);
+    TE_CHECKRETURN_CODE(code);
+
+    // maximum number of simplified LODs generated per mesh; `0` disables
+    const int maxLevels = ConfigOptions_getIntOptionOrDefault("assimp.generate-lods", 0);
+
+    LODGenerator lodGenerator;
+    lodGenerator.maxLevels = (maxLevels > 0) ? static_cast<std::size_t>(maxLevels) : 0u;
+    lodGenerator.callbacks = callbacks;
+    lodGenerator.next = 0u;
+    TE_BEGIN_TRAP() {
+        for (auto i = procInfo.builders.begin(); i != procInfo.builders.end(); i++) {
+            for (auto j = i->second.builders.begin(); j != i->second.builders.end(); j++)
+                lodGenerator.meshes.push_back(std::vector<std::shared_ptr<const Mesh>>(1u, std::shared_ptr<const Mesh>(std::move((*j)->mesh))));
         }
+    } TE_END_TRAP(code);
+    TE_CHECKRETURN_CODE(code);
+
+    if (lodGenerator.maxLevels && !lodGenerator.meshes.empty()) {
+        runParallel(generateLODsThreadFn, &lodGenerator, lodGenerator.meshes.size());
+        if (ProcessingCallback_isCanceled(callbacks))
+            return TE_Canceled;
+    }
+
+    for (auto i = lodGenerator.meshes.begin(); i != lodGenerator.meshes.end(); i++) {
+        code = procInfo.builder.addMesh(i->data(), i->size(), nullptr);
+        TE_CHECKBREAK_CODE(code);
     }
     TE_CHECKRETURN_CODE(code);
 
@@ -1,5 +1,7 @@
 #include "model/Mesh.h"
 
+#include <cstring>
+
 #include "model/MeshBuilder.h"
 
 using namespace TAK::Engine::Model;
@@ -8,6 +10,123 @@ using namespace TAK::Engine::Math;
 using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Util;
 
+namespace
+{
+    /** maximum number of distinct data blocks; one per attribute plus indices */
+    const std::size_t maxDataBlocks = 12u;
+
+    struct DataBlock
+    {
+        const uint8_t *data;
+        std::size_t size;
+    };
+
+    struct MeshDescriptor
+    {
+        std::size_t numVertices;
+        std::size_t numIndices;
+        int drawMode;
+        int winding;
+        int indexType;
+        unsigned int attributes;
+        bool interleaved;
+        VertexArray arrays[11u];
+    };
+
+    TAKErr getDescriptor(MeshDescriptor *value, const Mesh &mesh) NOTHROWS
+    {
+        // zero fill so that padding bytes compare and hash consistently
+        memset(value, 0, sizeof(MeshDescriptor));
+
+        const VertexDataLayout &layout = mesh.getVertexDataLayout();
+        value->numVertices = mesh.getNumVertices();
+        value->drawMode = mesh.getDrawMode();
+        value->winding = mesh.getFaceWindingOrder();
+        value->attributes = layout.attributes;
+        value->interleaved = layout.interleaved;
+        const VertexArray *arrays[11u] =
+        {
+            &layout.normal, &layout.color, &layout.position,
+            &layout.texCoord0, &layout.texCoord1, &layout.texCoord2, &layout.texCoord3,
+            &layout.texCoord4, &layout.texCoord5, &layout.texCoord6, &layout.texCoord7,
+        };
+        for (std::size_t i = 0u; i < 11u; i++) {
+            if (!(layout.attributes&(1u << i)))
+                continue;
+            value->arrays[i].type = arrays[i]->type;
+            value->arrays[i].offset = arrays[i]->offset;
+            value->arrays[i].stride = arrays[i]->stride;
+        }
+        if (mesh.isIndexed()) {
+            DataType indexType;
+            TAKErr code = mesh.getIndexType(&indexType);
+            TE_CHECKRETURN_CODE(code);
+            value->indexType = indexType;
+            value->numIndices = mesh.getNumIndices();
+        }
+        return TE_Ok;
+    }
+
+    TAKErr getDataBlocks(DataBlock *blocks, std::size_t *count, const Mesh &mesh) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        *count = 0u;
+        const VertexDataLayout &layout = mesh.getVertexDataLayout();
+        if (layout.interleaved) {
+            const void *base;
+            code = mesh.getVertices(&base, TEVA_Position);
+            TE_CHECKRETURN_CODE(code);
+            std::size_t size;
+            code = VertexDataLayout_requiredInterleavedDataSize(&size, layout, mesh.getNumVertices());
+            TE_CHECKRETURN_CODE(code);
+            blocks[(*count)++] = DataBlock{ static_cast<const uint8_t *>(base), base ? size : 0u };
+        } else {
+            for (unsigned int attr = TEVA_Normal; attr <= TEVA_TexCoord7; attr <<= 1u) {
+                if (!(layout.attributes&attr))
+                    continue;
+                const void *base;
+                code = mesh.getVertices(&base, attr);
+                TE_CHECKBREAK_CODE(code);
+                std::size_t size;
+                code = VertexDataLayout_requiredDataSize(&size, layout, (VertexAttribute)attr, mesh.getNumVertices());
+                TE_CHECKBREAK_CODE(code);
+                blocks[(*count)++] = DataBlock{ static_cast<const uint8_t *>(base), base ? size : 0u };
+            }
+            TE_CHECKRETURN_CODE(code);
+        }
+        if (mesh.isIndexed()) {
+            DataType indexType;
+            code = mesh.getIndexType(&indexType);
+            TE_CHECKRETURN_CODE(code);
+            const uint8_t *indices = static_cast<const uint8_t *>(mesh.getIndices());
+            if (indices)
+                indices += mesh.getIndexOffset();
+            blocks[(*count)++] = DataBlock{ indices, indices ? mesh.getNumIndices() * DataType_size(indexType) : 0u };
+        }
+        return code;
+    }
+
+    // 64-bit FNV-1a, narrowed to std::size_t
+    void hashBytes(uint64_t &h, const void *data, const std::size_t len) NOTHROWS
+    {
+        const uint8_t *p = static_cast<const uint8_t *>(data);
+        for (std::size_t i = 0u; i < len; i++) {
+            h ^= p[i];
+            h *= 0x100000001b3ULL;
+        }
+    }
+
+    bool materialEquals(const Material &a, const Material &b) NOTHROWS
+    {
+        return a.propertyType == b.propertyType &&
+               a.color == b.color &&
+               a.textureCoordIndex == b.textureCoordIndex &&
+               a.twoSided == b.twoSided &&
+               (!a.textureUri == !b.textureUri) &&
+               (!a.textureUri || String_equal(a.textureUri, b.textureUri));
+    }
+}
+
 Mesh::~Mesh() NOTHROWS
 {}
 
@@ -98,3 +217,130 @@ TAKErr TAK::Engine::Model::Mesh_transform(MeshPtr &value, const Mesh &src, const
     TE_CHECKRETURN_CODE(code);
     return code;
 }
+
+TAKErr TAK::Engine::Model::Mesh_getDataSize(std::size_t *value, const Mesh &mesh) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value)
+        return TE_InvalidArg;
+
+    const VertexDataLayout &layout = mesh.getVertexDataLayout();
+    std::size_t size = 0u;
+    if (layout.interleaved) {
+        code = VertexDataLayout_requiredInterleavedDataSize(&size, layout, mesh.getNumVertices());
+        TE_CHECKRETURN_CODE(code);
+    } else {
+        for (unsigned int attr = TEVA_Normal; attr <= TEVA_TexCoord7; attr <<= 1u) {
+            if (!(layout.attributes&attr))
+                continue;
+            std::size_t attrSize;
+            code = VertexDataLayout_requiredDataSize(&attrSize, layout, (VertexAttribute)attr, mesh.getNumVertices());
+            TE_CHECKBREAK_CODE(code);
+            size += attrSize;
+        }
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    if (mesh.isIndexed()) {
+        DataType indexType;
+        code = mesh.getIndexType(&indexType);
+        TE_CHECKRETURN_CODE(code);
+        size += mesh.getNumIndices() * DataType_size(indexType);
+    }
+
+    *value = size;
+    return code;
+}
+
+TAKErr TAK::Engine::Model::Mesh_hash(std::size_t *value, const Mesh &mesh) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value)
+        return TE_InvalidArg;
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    MeshDescriptor desc;
+    code = getDescriptor(&desc, mesh);
+    TE_CHECKRETURN_CODE(code);
+    hashBytes(h, &desc, sizeof(desc));
+
+    DataBlock blocks[maxDataBlocks];
+    std::size_t numBlocks;
+    code = getDataBlocks(blocks, &numBlocks, mesh);
+    TE_CHECKRETURN_CODE(code);
+    for (std::size_t i = 0u; i < numBlocks; i++)
+        hashBytes(h, blocks[i].data, blocks[i].size);
+
+    for (std::size_t i = 0u; i < mesh.getNumMaterials(); i++) {
+        Material material;
+        code = mesh.getMaterial(&material, i);
+        TE_CHECKBREAK_CODE(code);
+        const int32_t props[4u] = { material.propertyType, (int32_t)material.color, material.textureCoordIndex, material.twoSided ? 1 : 0 };
+        hashBytes(h, props, sizeof(props));
+        if (material.textureUri)
+            hashBytes(h, material.textureUri.get(), strlen(material.textureUri));
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    *value = (std::size_t)(h ^ (h >> 32u));
+    return code;
+}
+
+TAKErr TAK::Engine::Model::Mesh_equals(bool *value, const Mesh &a, const Mesh &b) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value)
+        return TE_InvalidArg;
+    *value = false;
+    if (&a == &b) {
+        *value = true;
+        return code;
+    }
+
+    MeshDescriptor adesc;
+    code = getDescriptor(&adesc, a);
+    TE_CHECKRETURN_CODE(code);
+    MeshDescriptor bdesc;
+    code = getDescriptor(&bdesc, b);
+    TE_CHECKRETURN_CODE(code);
+    if (memcmp(&adesc, &bdesc, sizeof(MeshDescriptor)))
+        return code;
+    if (a.getNumMaterials() != b.getNumMaterials())
+        return code;
+
+    DataBlock ablocks[maxDataBlocks];
+    std::size_t numABlocks;
+    code = getDataBlocks(ablocks, &numABlocks, a);
+    TE_CHECKRETURN_CODE(code);
+    DataBlock bblocks[maxDataBlocks];
+    std::size_t numBBlocks;
+    code = getDataBlocks(bblocks, &numBBlocks, b);
+    TE_CHECKRETURN_CODE(code);
+    if (numABlocks != numBBlocks)
+        return code;
+    for (std::size_t i = 0u; i < numABlocks; i++) {
+        if (ablocks[i].size != bblocks[i].size)
+            return code;
+        if (ablocks[i].data == bblocks[i].data)
+            continue;
+        if (!ablocks[i].data || !bblocks[i].data)
+            return code;
+        if (memcmp(ablocks[i].data, bblocks[i].data, ablocks[i].size))
+            return code;
+    }
+
+    for (std::size_t i = 0u; i < a.getNumMaterials(); i++) {
+        Material amat;
+        code = a.getMaterial(&amat, i);
+        TE_CHECKRETURN_CODE(code);
+        Material bmat;
+        code = b.getMaterial(&bmat, i);
+        TE_CHECKRETURN_CODE(code);
+        if (!materialEquals(amat, bmat))
+            return code;
+    }
+
+    *value = true;
+    return code;
+}
@@ -188,6 +188,24 @@ namespace TAK {
             typedef std::unique_ptr<const Mesh, void(*)(const Mesh *)> MeshPtr_const;
 
             Util::TAKErr Mesh_transform(MeshPtr &value, const Mesh &src, const VertexDataLayout &dstLayout) NOTHROWS;
+            /**
+             * Computes the number of bytes required to store the vertex and
+             * index data of the specified mesh.
+             */
+            ENGINE_API Util::TAKErr Mesh_getDataSize(std::size_t *value, const Mesh &mesh) NOTHROWS;
+            /**
+             * Computes a hash over the geometry of the specified mesh: the
+             * vertex data layout, draw mode, winding order, vertex and index
+             * data, and materials. Meshes that compare equal per
+             * `Mesh_equals` will produce the same hash, allowing identical
+             * geometry to share GPU resources.
+             */
+            ENGINE_API Util::TAKErr Mesh_hash(std::size_t *value, const Mesh &mesh) NOTHROWS;
+            /**
+             * Returns `true` via `value` if the two meshes have byte-identical
+             * layouts, vertex and index data and equivalent materials.
+             */
+            ENGINE_API Util::TAKErr Mesh_equals(bool *value, const Mesh &a, const Mesh &b) NOTHROWS;
         }
     }
 }
@@ -131,8 +131,11 @@ namespace
                                  const float nx, const float ny, const float nz,
                                  const float r, const float g, const float b, const float a) NOTHROWS = 0;
         virtual TAKErr reserveVertices(const std::size_t count) NOTHROWS = 0;
+        virtual TAKErr addVertices(const void *data, const std::size_t count) NOTHROWS = 0;
+        virtual TAKErr setVertices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS = 0;
     public : // ModelImplBase interface
         TAKErr reserveIndices(const std::size_t count) NOTHROWS;
+        TAKErr setIndices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS;
         TAKErr addIndex(const std::size_t index) NOTHROWS;
         TAKErr addIndices(const uint32_t *added_indices, const std::size_t count) NOTHROWS;
         TAKErr addIndices(const uint16_t *added_indices, const std::size_t count) NOTHROWS;
@@ -197,8 +200,13 @@ namespace
                                  const float nx, const float ny, const float nz,
                                  const float r, const float g, const float b, const float a) NOTHROWS override = 0;
         TAKErr reserveVertices(const std::size_t count) NOTHROWS override;
+        TAKErr addVertices(const void *data, const std::size_t count) NOTHROWS override;
+        TAKErr setVertices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS override;
     public :
         TAKErr getVertices(const void **value, const std::size_t attr) const NOTHROWS override;
+    private :
+        /** expands the AABB by the positions of vertices `[first, first+count)` */
+        TAKErr expandAABB(const std::size_t first, const std::size_t count) NOTHROWS;
     public:
         std::unique_ptr<MemBuffer2> vertices;
     };
@@ -251,6 +259,8 @@ namespace
                          const float nx, const float ny, const float nz,
                          const float r, const float g, const float b, const float a) NOTHROWS override;
         TAKErr reserveVertices(const std::size_t count) NOTHROWS override;
+        TAKErr addVertices(const void *data, const std::size_t count) NOTHROWS override;
+        TAKErr setVertices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS override;
     public :
         TAKErr getVertices(const void **value, const std::size_t attr) const NOTHROWS override;
     public :
@@ -263,6 +273,14 @@ namespace
 
     TAKErr checkInitParams(const DrawMode &mode, const VertexDataLayout &layout, const DataType &indexType) NOTHROWS;
     TAKErr resize(std::unique_ptr<MemBuffer2> &buf, const std::size_t newSize) NOTHROWS;
+    /** the number of elements to grow a buffer holding `count` elements by */
+    std::size_t growCount(const std::size_t count) NOTHROWS;
+    /**
+     * Obtains the stride shared by all attributes of an interleaved layout.
+     * Returns TE_Unsupported if the attributes do not share a stride or an
+     * attribute does not lie within it.
+     */
+    TAKErr getInterleavedStride(std::size_t *value, const VertexDataLayout &layout) NOTHROWS;
     template<class T>
     TAKErr createElementAccess(std::unique_ptr<ElementAccess<T>> &value, const DataType &type, const bool normalized) NOTHROWS;
     template<class T>
@@ -399,6 +417,26 @@ TAKErr MeshBuilder::addVertex(double posx, double posy, double posz,
     auto &mimpl = static_cast<ModelImplBase &>(*impl);
     return mimpl.addVertex(posx, posy, posz, texCoords, nx, ny, nz, r, g, b, a);
 }
+TAKErr MeshBuilder::addVertices(const void *vertices, const std::size_t count) NOTHROWS
+{
+    TE_CHECKRETURN_CODE(initErr);
+    if(!impl.get())
+        return TE_IllegalState;
+    if(!vertices && count)
+        return TE_InvalidArg;
+    auto &mimpl = static_cast<ModelImplBase &>(*impl);
+    return mimpl.addVertices(vertices, count);
+}
+TAKErr MeshBuilder::setVertices(std::unique_ptr<const void, void(*)(const void*)> &&vertices, const std::size_t count) NOTHROWS
+{
+    TE_CHECKRETURN_CODE(initErr);
+    if(!impl.get())
+        return TE_IllegalState;
+    if(!vertices.get() && count)
+        return TE_InvalidArg;
+    auto &mimpl = static_cast<ModelImplBase &>(*impl);
+    return mimpl.setVertices(std::move(vertices), count);
+}
 
 TAKErr MeshBuilder::addIndex(const std::size_t index) NOTHROWS
 {
@@ -432,6 +470,16 @@ TAKErr MeshBuilder::addIndices(const uint8_t *indices, const std::size_t count)
     auto &mimpl = static_cast<ModelImplBase &>(*impl);
     return mimpl.addIndices(indices, count);
 }
+TAKErr MeshBuilder::setIndices(std::unique_ptr<const void, void(*)(const void*)> &&indices, const std::size_t count) NOTHROWS
+{
+    TE_CHECKRETURN_CODE(initErr);
+    if(!impl.get())
+        return TE_IllegalState;
+    if(!indices.get() && count)
+        return TE_InvalidArg;
+    auto &mimpl = static_cast<ModelImplBase &>(*impl);
+    return mimpl.setIndices(std::move(indices), count);
+}
 
 TAKErr MeshBuilder::addBuffer(std::unique_ptr<const void, void(*)(const void*)>&& buffer, size_t bufferSize) NOTHROWS {
     TE_CHECKRETURN_CODE(initErr);
@@ -1154,11 +1202,30 @@ namespace
         if(!indices.get() || indices->remaining() < indexAccess->transferSize(1u)) {
             std::size_t newSize = indexAccess->transferSize(1024u);
             if(indices.get())
-                newSize += indices->size();
-            resize(indices, newSize);
+                newSize = indices->size() + std::max(newSize, indices->size());
+            TAKErr code = resize(indices, newSize);
+            TE_CHECKRETURN_CODE(code);
         }
         return indexAccess->put(*indices, index);
     }
+    TAKErr ModelImplBase::setIndices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS
+    {
+        if(!indexed_)
+            return TE_IllegalState;
+        if(indices.get() && indices->position())
+            return TE_IllegalState;
+        if(!indexAccess.get())
+            return TE_IllegalState;
+        const std::size_t size = indexAccess->transferSize(count);
+        std::unique_ptr<MemBuffer2> adopted(new(std::nothrow) MemBuffer2(std::move(data), size));
+        if(!adopted.get())
+            return TE_OutOfMemory;
+        // position at the end, per the builder's convention; `build` flips
+        TAKErr code = adopted->position(size);
+        TE_CHECKRETURN_CODE(code);
+        indices = std::move(adopted);
+        return code;
+    }
     TAKErr ModelImplBase::addIndices(const uint32_t *added_indices, const std::size_t count) NOTHROWS
     {
         if(!indexed_) return TE_IllegalState;
@@ -1167,7 +1234,7 @@ namespace
         if(!this->indices.get() || this->indices->remaining() < indexAccess->transferSize(count)) {
             std::size_t newSize = indexAccess->transferSize(count);
             if(this->indices.get())
-                newSize += this->indices->size();
+                newSize = this->indices->size() + std::max(newSize, this->indices->size());
             code = resize(this->indices, newSize);
             TE_CHECKRETURN_CODE(code);
         }
@@ -1187,7 +1254,7 @@ namespace
         if(!this->indices.get() || this->indices->remaining() < indexAccess->transferSize(count)) {
             std::size_t newSize = indexAccess->transferSize(count);
             if(this->indices.get())
-                newSize += this->indices->size();
+                newSize = this->indices->size() + std::max(newSize, this->indices->size());
             code = resize(this->indices, newSize);
             TE_CHECKRETURN_CODE(code);
         }
@@ -1205,7 +1272,10 @@ namespace
             return TE_IllegalState;
         TAKErr code(TE_Ok);
         if(!this->indices.get() || this->indices->remaining() < indexAccess->transferSize(count)) {
-            code = resize(this->indices, this->indices->size() + indexAccess->transferSize(count));
+            std::size_t newSize = indexAccess->transferSize(count);
+            if(this->indices.get())
+                newSize = this->indices->size() + std::max(newSize, this->indices->size());
+            code = resize(this->indices, newSize);
             TE_CHECKRETURN_CODE(code);
         }
         for(std::size_t i = 0u; i < count; i++) {
@@ -1499,6 +1569,104 @@ namespace
 
         return resize(vertices, size);
     }
+    TAKErr InterleavedModelBase::addVertices(const void *data, const std::size_t count) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if(!count)
+            return code;
+        const VertexDataLayout layout = getVertexDataLayout();
+        std::size_t stride;
+        code = getInterleavedStride(&stride, layout);
+        TE_CHECKRETURN_CODE(code);
+        std::size_t dataSize;
+        code = VertexDataLayout_requiredInterleavedDataSize(&dataSize, layout, count);
+        TE_CHECKRETURN_CODE(code);
+        std::size_t required;
+        code = VertexDataLayout_requiredInterleavedDataSize(&required, layout, vertexCount+count);
+        TE_CHECKRETURN_CODE(code);
+        if(!vertices.get() || vertices->size() < required) {
+            if(vertices.get()) {
+                // mark the end of the existing data for the copy
+                std::size_t existing;
+                code = VertexDataLayout_requiredInterleavedDataSize(&existing, layout, vertexCount);
+                TE_CHECKRETURN_CODE(code);
+                code = vertices->position(existing);
+                TE_CHECKRETURN_CODE(code);
+            }
+            std::size_t capacity;
+            code = VertexDataLayout_requiredInterleavedDataSize(&capacity, layout, vertexCount+std::max(count, growCount(vertexCount)));
+            TE_CHECKRETURN_CODE(code);
+            code = resize(vertices, capacity);
+            TE_CHECKRETURN_CODE(code);
+        }
+        code = vertices->limit(vertices->size());
+        TE_CHECKRETURN_CODE(code);
+        code = vertices->position(stride*vertexCount);
+        TE_CHECKRETURN_CODE(code);
+        code = vertices->put(static_cast<const uint8_t *>(data), dataSize);
+        TE_CHECKRETURN_CODE(code);
+
+        code = expandAABB(vertexCount, count);
+        TE_CHECKRETURN_CODE(code);
+        vertexCount += count;
+
+        // position for the next `addVertex`
+        return vertices->position(std::min(layout.position.offset+(stride*vertexCount), vertices->size()));
+    }
+    TAKErr InterleavedModelBase::setVertices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if(vertexCount)
+            return TE_IllegalState;
+        const VertexDataLayout layout = getVertexDataLayout();
+        std::size_t stride;
+        code = getInterleavedStride(&stride, layout);
+        TE_CHECKRETURN_CODE(code);
+        std::size_t size;
+        code = VertexDataLayout_requiredInterleavedDataSize(&size, layout, count);
+        TE_CHECKRETURN_CODE(code);
+
+        std::unique_ptr<MemBuffer2> adopted(new(std::nothrow) MemBuffer2(std::move(data), size));
+        if(!adopted.get())
+            return TE_OutOfMemory;
+        vertices = std::move(adopted);
+        code = expandAABB(0u, count);
+        TE_CHECKRETURN_CODE(code);
+        vertexCount = count;
+
+        // the buffer is read-only; the next add copies into a new buffer
+        return vertices->position(std::min(layout.position.offset+(stride*vertexCount), size));
+    }
+    TAKErr InterleavedModelBase::expandAABB(const std::size_t first, const std::size_t count) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const VertexDataLayout &layout = getVertexDataLayout();
+        if(!(layout.attributes&TEVA_Position) || !position_access_.get())
+            return code;
+        for(std::size_t i = first; i < (first+count); i++) {
+            code = vertices->position(layout.position.offset+(layout.position.stride*i));
+            TE_CHECKBREAK_CODE(code);
+            double x, y, z;
+            code = position_access_->get(&x, &y, &z, *vertices);
+            TE_CHECKBREAK_CODE(code);
+            if(!i) {
+                aabb_.minX = x;
+                aabb_.minY = y;
+                aabb_.minZ = z;
+                aabb_.maxX = x;
+                aabb_.maxY = y;
+                aabb_.maxZ = z;
+            } else {
+                if(x < aabb_.minX)        aabb_.minX = x;
+                else if(x > aabb_.maxX)   aabb_.maxX = x;
+                if(y < aabb_.minY)        aabb_.minY = y;
+                else if(y > aabb_.maxY)   aabb_.maxY = y;
+                if(z < aabb_.minZ)        aabb_.minZ = z;
+                else if(z > aabb_.maxZ)   aabb_.maxZ = z;
+            }
+        }
+        return code;
+    }
 
     //************************************************************************//
     // DefaultInterleavedModel
@@ -1516,7 +1684,7 @@ namespace
                                               const float r, const float g, const float b, const float a) NOTHROWS
     {
         TAKErr code(TE_Ok);
-#define GROW_SIZE 1024u
+#define GROW_SIZE growCount(vertexCount)
         if(!vertices.get()) {
             code = reserveVertices(GROW_SIZE);
             TE_CHECKRETURN_CODE(code);
@@ -1584,7 +1752,7 @@ namespace
                                               const float r, const float g, const float b, const float a) NOTHROWS
     {
         TAKErr code(TE_Ok);
-#define GROW_SIZE 1024u
+#define GROW_SIZE growCount(vertexCount)
         if(!vertices.get()) {
             code = reserveVertices(GROW_SIZE);
             TE_CHECKRETURN_CODE(code);
@@ -1675,7 +1843,7 @@ namespace
                                               const float r, const float g, const float b, const float a) NOTHROWS
     {
         TAKErr code(TE_Ok);
-#define GROW_SIZE 1024u
+#define GROW_SIZE growCount(vertexCount)
         if(!vertices.get()) {
             code = reserveVertices(GROW_SIZE);
             TE_CHECKRETURN_CODE(code);
@@ -1762,7 +1930,7 @@ namespace
                                               const float r, const float g, const float b, const float a) NOTHROWS
     {
         TAKErr code(TE_Ok);
-#define GROW_SIZE 1024u
+#define GROW_SIZE growCount(vertexCount)
         if(!vertices.get()) {
             code = reserveVertices(GROW_SIZE);
             TE_CHECKRETURN_CODE(code);
@@ -1859,7 +2027,7 @@ namespace
                                           const float r, const float g, const float b, const float a) NOTHROWS
     {
         TAKErr code(TE_Ok);
-#define GROW_SIZE 1024u
+#define GROW_SIZE growCount(vertexCount)
         if(!positions_.get()) {
             code = reserveVertices(GROW_SIZE);
             TE_CHECKRETURN_CODE(code);
@@ -1967,7 +2135,7 @@ namespace
                                           const float r, const float g, const float b, const float a) NOTHROWS
     {
         TAKErr code(TE_Ok);
-#define GROW_SIZE 1024u
+#define GROW_SIZE growCount(vertexCount)
         if(!positions_.get()) {
             code = reserveVertices(GROW_SIZE);
             TE_CHECKRETURN_CODE(code);
@@ -2123,6 +2291,14 @@ namespace
         }
         return code;
     }
+    TAKErr NonInterleavedModel::addVertices(const void *data, const std::size_t count) NOTHROWS
+    {
+        return TE_Unsupported;
+    }
+    TAKErr NonInterleavedModel::setVertices(VertexArrayPtr &&data, const std::size_t count) NOTHROWS
+    {
+        return TE_Unsupported;
+    }
     TAKErr NonInterleavedModel::getVertices(const void **vertices, const std::size_t attrs) const NOTHROWS
     {
         if(!(attrs&getVertexDataLayout().attributes))
@@ -2197,6 +2373,41 @@ namespace
         return TE_Ok;
     }
 
+    std::size_t growCount(const std::size_t count) NOTHROWS
+    {
+        // grow geometrically so that incremental building is linear
+        return std::max(count, (std::size_t)1024u);
+    }
+    TAKErr getInterleavedStride(std::size_t *value, const VertexDataLayout &layout) NOTHROWS
+    {
+        if(!layout.interleaved)
+            return TE_Unsupported;
+        std::size_t stride = 0u;
+#define CHECK_STRIDE(vao, teva, elems) \
+    if(layout.attributes&teva) { \
+        if(!stride) \
+            stride = layout.vao.stride; \
+        if(layout.vao.stride != stride || (layout.vao.offset + DataType_size(layout.vao.type)*elems) > stride) \
+            return TE_Unsupported; \
+    }
+
+        CHECK_STRIDE(position, TEVA_Position, 3u);
+        CHECK_STRIDE(texCoord0, TEVA_TexCoord0, 2u);
+        CHECK_STRIDE(texCoord1, TEVA_TexCoord1, 2u);
+        CHECK_STRIDE(texCoord2, TEVA_TexCoord2, 2u);
+        CHECK_STRIDE(texCoord3, TEVA_TexCoord3, 2u);
+        CHECK_STRIDE(texCoord4, TEVA_TexCoord4, 2u);
+        CHECK_STRIDE(texCoord5, TEVA_TexCoord5, 2u);
+        CHECK_STRIDE(texCoord6, TEVA_TexCoord6, 2u);
+        CHECK_STRIDE(texCoord7, TEVA_TexCoord7, 2u);
+        CHECK_STRIDE(normal, TEVA_Normal, 3u);
+        CHECK_STRIDE(color, TEVA_Color, 4u);
+#undef CHECK_STRIDE
+        if(!stride)
+            return TE_Unsupported;
+        *value = stride;
+        return TE_Ok;
+    }
     TAKErr resize(std::unique_ptr<MemBuffer2> &buf, const std::size_t newSize) NOTHROWS
     {
         TAKErr code(TE_Ok);
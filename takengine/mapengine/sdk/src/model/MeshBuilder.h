@@ -32,6 +32,29 @@ namespace TAK {
                                        const float *texCoords,
                                        const float nx, const float ny, const float nz,
                                        const float r, const float g, const float b, const float a) NOTHROWS;
+                /**
+                 * Appends `count` vertices that are already in the
+                 * builder's interleaved layout; vertex `i` starts at byte
+                 * `i*stride` of `vertices`. Capacity grows geometrically,
+                 * so a prior `reserveVertices` makes the append a single
+                 * copy.
+                 *
+                 * @return  TE_Ok on success, TE_Unsupported if the layout
+                 *          is not interleaved with a common stride
+                 */
+                Util::TAKErr addVertices(const void *vertices, const std::size_t count) NOTHROWS;
+                /**
+                 * Adopts `vertices`, holding `count` vertices in the
+                 * builder's interleaved layout, as the vertex data without
+                 * copying. Must be called before any vertices are added;
+                 * vertices added afterwards copy the data into a new
+                 * buffer.
+                 *
+                 * @return  TE_Ok on success, TE_IllegalState if vertices
+                 *          were already added, TE_Unsupported if the layout
+                 *          is not interleaved with a common stride
+                 */
+                Util::TAKErr setVertices(std::unique_ptr<const void, void(*)(const void*)> &&vertices, const std::size_t count) NOTHROWS;
 
                 Util::TAKErr addIndex(const std::size_t index) NOTHROWS;
                 /**
@@ -43,6 +66,15 @@ namespace TAK {
                 Util::TAKErr addIndices(const uint32_t *indices, const std::size_t count) NOTHROWS;
                 Util::TAKErr addIndices(const uint16_t *indices, const std::size_t count) NOTHROWS;
                 Util::TAKErr addIndices(const uint8_t *indices, const std::size_t count) NOTHROWS;
+                /**
+                 * Adopts `indices`, holding `count` indices of the
+                 * builder's index type, as the index data without copying.
+                 * Must be called before any indices are added.
+                 *
+                 * @return  TE_Ok on success, TE_IllegalState if the builder
+                 *          is not indexed or indices were already added
+                 */
+                Util::TAKErr setIndices(std::unique_ptr<const void, void(*)(const void*)> &&indices, const std::size_t count) NOTHROWS;
 
                 Util::TAKErr addBuffer(std::unique_ptr<const void, void(*)(const void*)>&& buffer, size_t bufferSize) NOTHROWS;
 
@@ -0,0 +1,547 @@
+#include "model/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "model/MeshBuilder.h"
+
+using namespace TAK::Engine::Model;
+
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    /** symmetric 4x4 error quadric; upper triangle, row major */
+    struct Quadric
+    {
+        double m[10u];
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+    };
+
+    struct CollapseOrder
+    {
+        bool operator()(const Collapse &a, const Collapse &b) const NOTHROWS
+        {
+            return a.cost > b.cost;
+        }
+    };
+
+    /**
+     * Triangle mesh over welded vertices. Collapsed vertices and
+     * triangles are flagged rather than erased; the per-vertex triangle
+     * lists may reference removed triangles.
+     */
+    class Simplifier
+    {
+    public :
+        /**
+         * @param rowWidth  the number of values per vertex in `rows`; the
+         *                  first three are the position
+         */
+        Simplifier(std::vector<double> &&rows, const std::size_t rowWidth, std::vector<uint32_t> &&triangles);
+    public :
+        void run(const std::size_t targetFaces);
+    private :
+        void neighbors(std::vector<uint32_t> &value, const uint32_t v) const;
+        bool canCollapse(const uint32_t from, const uint32_t to) const;
+        void collapse(const uint32_t from, const uint32_t to);
+        void pushBest(const uint32_t v);
+        const double *position(const uint32_t v) const NOTHROWS;
+    public :
+        std::vector<double> rows;
+        std::size_t rowWidth;
+        std::vector<uint32_t> triangles;
+        std::vector<bool> triangleRemoved;
+        std::size_t numFaces;
+    private :
+        std::vector<Quadric> quadrics;
+        std::vector<std::vector<uint32_t>> vertexTriangles;
+        std::vector<bool> locked;
+        std::vector<bool> removed;
+        std::vector<uint32_t> versions;
+        std::priority_queue<Collapse, std::vector<Collapse>, CollapseOrder> queue;
+        mutable std::vector<uint32_t> scratchA;
+        mutable std::vector<uint32_t> scratchB;
+    };
+
+    void Quadric_addPlane(Quadric &q, const double a, const double b, const double c, const double d, const double w) NOTHROWS;
+    void Quadric_add(Quadric &q, const Quadric &other) NOTHROWS;
+    double Quadric_eval(const Quadric &q, const double *p) NOTHROWS;
+    /** returns the unnormalized face normal */
+    void faceNormal(double *n, const double *a, const double *b, const double *c) NOTHROWS;
+
+    std::size_t getRowWidth(const unsigned int attrs) NOTHROWS;
+    TAKErr readRow(double *row, const Mesh &mesh, const unsigned int attrs, const std::size_t index) NOTHROWS;
+    TAKErr addVertex(MeshBuilder &builder, const unsigned int attrs, const double *row) NOTHROWS;
+}
+
+TAKErr TAK::Engine::Model::MeshSimplifier_simplify(MeshPtr &value, const Mesh &mesh, const std::size_t targetFaces) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (mesh.getDrawMode() != TEDM_Triangles)
+        return TE_Unsupported;
+    const unsigned int attrs = mesh.getVertexDataLayout().attributes;
+    if (!(attrs&TEVA_Position))
+        return TE_InvalidArg;
+
+    const std::size_t numVertices = mesh.getNumVertices();
+    const std::size_t rowWidth = getRowWidth(attrs);
+
+    std::unique_ptr<Simplifier> simplifier;
+    TE_BEGIN_TRAP() {
+        // read the vertices
+        std::vector<double> source(numVertices*rowWidth);
+        for (std::size_t i = 0u; i < numVertices; i++) {
+            code = readRow(&source[i*rowWidth], mesh, attrs, i);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        // weld vertices with identical attributes
+        std::vector<uint32_t> order(numVertices);
+        for (std::size_t i = 0u; i < numVertices; i++)
+            order[i] = static_cast<uint32_t>(i);
+        std::sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b)
+        {
+            return std::lexicographical_compare(&source[a*rowWidth], &source[(a+1u)*rowWidth], &source[b*rowWidth], &source[(b+1u)*rowWidth]);
+        });
+        std::vector<uint32_t> welded(numVertices);
+        std::vector<double> rows;
+        rows.reserve(source.size());
+        for (std::size_t i = 0u; i < numVertices; i++) {
+            const double *row = &source[order[i]*rowWidth];
+            if (!i || !std::equal(row, row+rowWidth, &source[order[i-1u]*rowWidth]))
+                rows.insert(rows.end(), row, row+rowWidth);
+            welded[order[i]] = static_cast<uint32_t>(rows.size()/rowWidth - 1u);
+        }
+        std::vector<double>().swap(source);
+
+        // gather the triangles, dropping any that are degenerate after welding
+        const std::size_t numIndices = mesh.isIndexed() ? mesh.getNumIndices() : numVertices;
+        std::vector<uint32_t> triangles;
+        triangles.reserve(numIndices);
+        for (std::size_t i = 0u; (i+3u) <= numIndices; i += 3u) {
+            uint32_t tri[3u];
+            for (std::size_t j = 0u; j < 3u; j++) {
+                std::size_t idx = i+j;
+                if (mesh.isIndexed()) {
+                    code = mesh.getIndex(&idx, i+j);
+                    TE_CHECKBREAK_CODE(code);
+                }
+                if (idx >= numVertices) {
+                    code = TE_BadIndex;
+                    break;
+                }
+                tri[j] = welded[idx];
+            }
+            TE_CHECKBREAK_CODE(code);
+            if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2])
+                continue;
+            triangles.insert(triangles.end(), tri, tri+3u);
+        }
+        TE_CHECKRETURN_CODE(code);
+        if (triangles.empty())
+            return TE_InvalidArg;
+
+        simplifier.reset(new Simplifier(std::move(rows), rowWidth, std::move(triangles)));
+        simplifier->run(targetFaces);
+    } TE_END_TRAP(code);
+    TE_CHECKRETURN_CODE(code);
+
+    TE_BEGIN_TRAP() {
+        const Simplifier &s = *simplifier;
+
+        // assign output vertices in order of first use
+        std::vector<uint32_t> remap(s.rows.size()/rowWidth, UINT32_MAX);
+        std::vector<uint32_t> outputRows;
+        std::vector<uint32_t> indices;
+        indices.reserve(s.numFaces*3u);
+        for (std::size_t i = 0u; i < s.triangleRemoved.size(); i++) {
+            if (s.triangleRemoved[i])
+                continue;
+            for (std::size_t j = 0u; j < 3u; j++) {
+                const uint32_t v = s.triangles[i*3u+j];
+                if (remap[v] == UINT32_MAX) {
+                    remap[v] = static_cast<uint32_t>(outputRows.size());
+                    outputRows.push_back(v);
+                }
+                indices.push_back(remap[v]);
+            }
+        }
+
+        // the renderer draws 16-bit indices; expand larger results
+        const bool indexed = (outputRows.size() <= 0xFFFFu);
+        std::unique_ptr<MeshBuilder> builder(indexed ?
+            new MeshBuilder(TEDM_Triangles, attrs, TEDT_UInt16) :
+            new MeshBuilder(TEDM_Triangles, attrs));
+        code = builder->setWindingOrder(mesh.getFaceWindingOrder());
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < mesh.getNumMaterials(); i++) {
+            Material material;
+            code = mesh.getMaterial(&material, i);
+            TE_CHECKBREAK_CODE(code);
+            code = builder->addMaterial(material);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        if (indexed) {
+            code = builder->reserveVertices(outputRows.size());
+            TE_CHECKRETURN_CODE(code);
+            for (std::size_t i = 0u; i < outputRows.size(); i++) {
+                code = addVertex(*builder, attrs, &s.rows[outputRows[i]*rowWidth]);
+                TE_CHECKBREAK_CODE(code);
+            }
+            TE_CHECKRETURN_CODE(code);
+            std::vector<uint16_t> indices16(indices.begin(), indices.end());
+            code = builder->reserveIndices(indices16.size());
+            TE_CHECKRETURN_CODE(code);
+            code = builder->addIndices(indices16.data(), indices16.size());
+            TE_CHECKRETURN_CODE(code);
+        } else {
+            code = builder->reserveVertices(indices.size());
+            TE_CHECKRETURN_CODE(code);
+            for (std::size_t i = 0u; i < indices.size(); i++) {
+                code = addVertex(*builder, attrs, &s.rows[outputRows[indices[i]]*rowWidth]);
+                TE_CHECKBREAK_CODE(code);
+            }
+            TE_CHECKRETURN_CODE(code);
+        }
+
+        code = builder->build(value);
+    } TE_END_TRAP(code);
+    return code;
+}
+
+namespace
+{
+    Simplifier::Simplifier(std::vector<double> &&rows_, const std::size_t rowWidth_, std::vector<uint32_t> &&triangles_) :
+        rows(std::move(rows_)),
+        rowWidth(rowWidth_),
+        triangles(std::move(triangles_)),
+        triangleRemoved(triangles.size()/3u, false),
+        numFaces(triangles.size()/3u)
+    {
+        const std::size_t numVertices = rows.size()/rowWidth;
+        Quadric zero;
+        for (std::size_t i = 0u; i < 10u; i++)
+            zero.m[i] = 0.0;
+        quadrics.assign(numVertices, zero);
+        vertexTriangles.resize(numVertices);
+        locked.assign(numVertices, false);
+        removed.assign(numVertices, false);
+        versions.assign(numVertices, 0u);
+
+        // count the faces sharing each edge; vertices on an edge that is
+        // not shared by exactly two faces are on a border or seam
+        std::unordered_map<uint64_t, uint32_t> edges;
+        edges.reserve(triangles.size());
+        for (std::size_t i = 0u; i < numFaces; i++) {
+            const uint32_t *tri = &triangles[i*3u];
+            for (std::size_t j = 0u; j < 3u; j++) {
+                const uint32_t a = std::min(tri[j], tri[(j+1u)%3u]);
+                const uint32_t b = std::max(tri[j], tri[(j+1u)%3u]);
+                edges[((uint64_t)a << 32u) | b]++;
+                vertexTriangles[tri[j]].push_back(static_cast<uint32_t>(i));
+            }
+
+            // area weighted plane quadric
+            double n[3u];
+            faceNormal(n, position(tri[0]), position(tri[1]), position(tri[2]));
+            const double len = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+            if (len <= 0.0)
+                continue;
+            const double a = n[0]/len;
+            const double b = n[1]/len;
+            const double c = n[2]/len;
+            const double *p = position(tri[0]);
+            const double d = -(a*p[0] + b*p[1] + c*p[2]);
+            for (std::size_t j = 0u; j < 3u; j++)
+                Quadric_addPlane(quadrics[tri[j]], a, b, c, d, len/2.0);
+        }
+        for (auto it = edges.begin(); it != edges.end(); it++) {
+            if (it->second != 2u) {
+                locked[(uint32_t)(it->first >> 32u)] = true;
+                locked[(uint32_t)(it->first & 0xFFFFFFFFu)] = true;
+            }
+        }
+    }
+    void Simplifier::run(const std::size_t targetFaces)
+    {
+        for (uint32_t v = 0u; v < static_cast<uint32_t>(vertexTriangles.size()); v++)
+            pushBest(v);
+
+        std::vector<uint32_t> affected;
+        while (numFaces > targetFaces && !queue.empty()) {
+            const Collapse c = queue.top();
+            queue.pop();
+            if (removed[c.from] || removed[c.to] || versions[c.from] != c.fromVersion || versions[c.to] != c.toVersion)
+                continue;
+            if (!canCollapse(c.from, c.to)) {
+                pushBest(c.from);
+                continue;
+            }
+            collapse(c.from, c.to);
+
+            // the neighborhood of the target changed; re-evaluate it
+            neighbors(affected, c.to);
+            versions[c.to]++;
+            for (std::size_t i = 0u; i < affected.size(); i++)
+                versions[affected[i]]++;
+            pushBest(c.to);
+            for (std::size_t i = 0u; i < affected.size(); i++)
+                pushBest(affected[i]);
+        }
+    }
+    void Simplifier::neighbors(std::vector<uint32_t> &value, const uint32_t v) const
+    {
+        value.clear();
+        const std::vector<uint32_t> &tris = vertexTriangles[v];
+        for (std::size_t i = 0u; i < tris.size(); i++) {
+            if (triangleRemoved[tris[i]])
+                continue;
+            const uint32_t *tri = &triangles[tris[i]*3u];
+            for (std::size_t j = 0u; j < 3u; j++) {
+                if (tri[j] != v)
+                    value.push_back(tri[j]);
+            }
+        }
+        std::sort(value.begin(), value.end());
+        value.erase(std::unique(value.begin(), value.end()), value.end());
+    }
+    bool Simplifier::canCollapse(const uint32_t from, const uint32_t to) const
+    {
+        if (locked[from])
+            return false;
+
+        // link condition; the vertices may only share the vertices opposite
+        // the collapsed edge, otherwise the result is non-manifold
+        std::size_t edgeFaces = 0u;
+        const std::vector<uint32_t> &tris = vertexTriangles[from];
+        for (std::size_t i = 0u; i < tris.size(); i++) {
+            if (triangleRemoved[tris[i]])
+                continue;
+            const uint32_t *tri = &triangles[tris[i]*3u];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                edgeFaces++;
+        }
+        if (!edgeFaces)
+            return false;
+        neighbors(scratchA, from);
+        neighbors(scratchB, to);
+        std::size_t shared = 0u;
+        for (auto a = scratchA.begin(), b = scratchB.begin(); a != scratchA.end() && b != scratchB.end(); ) {
+            if (*a < *b) {
+                a++;
+            } else if (*b < *a) {
+                b++;
+            } else {
+                shared++;
+                a++;
+                b++;
+            }
+        }
+        if (shared != edgeFaces)
+            return false;
+
+        // reject collapses that fold or degenerate a remaining face
+        const double *dst = position(to);
+        for (std::size_t i = 0u; i < tris.size(); i++) {
+            if (triangleRemoved[tris[i]])
+                continue;
+            const uint32_t *tri = &triangles[tris[i]*3u];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;
+            const double *p[3u];
+            const double *q[3u];
+            for (std::size_t j = 0u; j < 3u; j++) {
+                p[j] = position(tri[j]);
+                q[j] = (tri[j] == from) ? dst : p[j];
+            }
+            double before[3u];
+            double after[3u];
+            faceNormal(before, p[0], p[1], p[2]);
+            faceNormal(after, q[0], q[1], q[2]);
+            const double dot = before[0]*after[0] + before[1]*after[1] + before[2]*after[2];
+            if (dot <= 0.0 && (before[0] != 0.0 || before[1] != 0.0 || before[2] != 0.0))
+                return false;
+        }
+        return true;
+    }
+    void Simplifier::collapse(const uint32_t from, const uint32_t to)
+    {
+        std::vector<uint32_t> &tris = vertexTriangles[from];
+        std::vector<uint32_t> &dst = vertexTriangles[to];
+        for (std::size_t i = 0u; i < tris.size(); i++) {
+            if (triangleRemoved[tris[i]])
+                continue;
+            uint32_t *tri = &triangles[tris[i]*3u];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                triangleRemoved[tris[i]] = true;
+                numFaces--;
+                continue;
+            }
+            for (std::size_t j = 0u; j < 3u; j++) {
+                if (tri[j] == from)
+                    tri[j] = to;
+            }
+            dst.push_back(tris[i]);
+        }
+        std::vector<uint32_t>().swap(tris);
+        dst.erase(std::remove_if(dst.begin(), dst.end(), [&](const uint32_t t) { return triangleRemoved[t]; }), dst.end());
+
+        Quadric_add(quadrics[to], quadrics[from]);
+        removed[from] = true;
+    }
+    void Simplifier::pushBest(const uint32_t v)
+    {
+        if (locked[v] || removed[v])
+            return;
+        std::vector<uint32_t> candidates;
+        neighbors(candidates, v);
+        Collapse best;
+        best.cost = -1.0;
+        for (std::size_t i = 0u; i < candidates.size(); i++) {
+            const uint32_t to = candidates[i];
+            Quadric q = quadrics[v];
+            Quadric_add(q, quadrics[to]);
+            const double cost = Quadric_eval(q, position(to));
+            if (best.cost >= 0.0 && cost >= best.cost)
+                continue;
+            if (!canCollapse(v, to))
+                continue;
+            best.cost = std::max(cost, 0.0);
+            best.to = to;
+        }
+        if (best.cost < 0.0)
+            return;
+        best.from = v;
+        best.fromVersion = versions[v];
+        best.toVersion = versions[best.to];
+        queue.push(best);
+    }
+    const double *Simplifier::position(const uint32_t v) const NOTHROWS
+    {
+        return &rows[v*rowWidth];
+    }
+
+    void Quadric_addPlane(Quadric &q, const double a, const double b, const double c, const double d, const double w) NOTHROWS
+    {
+        q.m[0] += w*a*a; q.m[1] += w*a*b; q.m[2] += w*a*c; q.m[3] += w*a*d;
+        q.m[4] += w*b*b; q.m[5] += w*b*c; q.m[6] += w*b*d;
+        q.m[7] += w*c*c; q.m[8] += w*c*d;
+        q.m[9] += w*d*d;
+    }
+    void Quadric_add(Quadric &q, const Quadric &other) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < 10u; i++)
+            q.m[i] += other.m[i];
+    }
+    double Quadric_eval(const Quadric &q, const double *p) NOTHROWS
+    {
+        const double x = p[0];
+        const double y = p[1];
+        const double z = p[2];
+        return q.m[0]*x*x + 2.0*q.m[1]*x*y + 2.0*q.m[2]*x*z + 2.0*q.m[3]*x +
+               q.m[4]*y*y + 2.0*q.m[5]*y*z + 2.0*q.m[6]*y +
+               q.m[7]*z*z + 2.0*q.m[8]*z +
+               q.m[9];
+    }
+    void faceNormal(double *n, const double *a, const double *b, const double *c) NOTHROWS
+    {
+        const double ux = b[0]-a[0], uy = b[1]-a[1], uz = b[2]-a[2];
+        const double vx = c[0]-a[0], vy = c[1]-a[1], vz = c[2]-a[2];
+        n[0] = uy*vz - uz*vy;
+        n[1] = uz*vx - ux*vz;
+        n[2] = ux*vy - uy*vx;
+    }
+
+    std::size_t getRowWidth(const unsigned int attrs) NOTHROWS
+    {
+        std::size_t width = 3u;
+        for (std::size_t i = 0u; i < 8u; i++) {
+            if (attrs&(TEVA_TexCoord0 << i))
+                width += 2u;
+        }
+        if (attrs&TEVA_Normal)
+            width += 3u;
+        if (attrs&TEVA_Color)
+            width += 1u;
+        return width;
+    }
+    TAKErr readRow(double *row, const Mesh &mesh, const unsigned int attrs, const std::size_t index) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        Point2<double> p;
+        code = mesh.getPosition(&p, index);
+        TE_CHECKRETURN_CODE(code);
+        *row++ = p.x;
+        *row++ = p.y;
+        *row++ = p.z;
+        for (std::size_t i = 0u; i < 8u; i++) {
+            if (!(attrs&(TEVA_TexCoord0 << i)))
+                continue;
+            Point2<float> uv;
+            code = mesh.getTextureCoordinate(&uv, static_cast<VertexAttribute>(TEVA_TexCoord0 << i), index);
+            TE_CHECKRETURN_CODE(code);
+            *row++ = uv.x;
+            *row++ = uv.y;
+        }
+        if (attrs&TEVA_Normal) {
+            Point2<float> n;
+            code = mesh.getNormal(&n, index);
+            TE_CHECKRETURN_CODE(code);
+            *row++ = n.x;
+            *row++ = n.y;
+            *row++ = n.z;
+        }
+        if (attrs&TEVA_Color) {
+            unsigned int argb;
+            code = mesh.getColor(&argb, index);
+            TE_CHECKRETURN_CODE(code);
+            *row++ = argb;
+        }
+        return code;
+    }
+    TAKErr addVertex(MeshBuilder &builder, const unsigned int attrs, const double *row) NOTHROWS
+    {
+        const double *p = row;
+        row += 3u;
+        float texCoords[16u];
+        std::size_t numTexCoords = 0u;
+        for (std::size_t i = 0u; i < 8u; i++) {
+            if (!(attrs&(TEVA_TexCoord0 << i)))
+                continue;
+            texCoords[numTexCoords++] = static_cast<float>(*row++);
+            texCoords[numTexCoords++] = static_cast<float>(*row++);
+        }
+        float nx = 0.f, ny = 0.f, nz = 0.f;
+        if (attrs&TEVA_Normal) {
+            nx = static_cast<float>(*row++);
+            ny = static_cast<float>(*row++);
+            nz = static_cast<float>(*row++);
+        }
+        float r = 1.f, g = 1.f, b = 1.f, a = 1.f;
+        if (attrs&TEVA_Color) {
+            const auto argb = static_cast<unsigned int>(*row++);
+            a = ((argb >> 24u)&0xFFu) / 255.f;
+            r = ((argb >> 16u)&0xFFu) / 255.f;
+            g = ((argb >> 8u)&0xFFu) / 255.f;
+            b = (argb&0xFFu) / 255.f;
+        }
+        return builder.addVertex(p[0], p[1], p[2], texCoords, nx, ny, nz, r, g, b, a);
+    }
+}
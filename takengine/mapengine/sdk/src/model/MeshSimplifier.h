@@ -0,0 +1,39 @@
+#ifndef TAK_ENGINE_MODEL_MESHSIMPLIFIER_H_INCLUDED
+#define TAK_ENGINE_MODEL_MESHSIMPLIFIER_H_INCLUDED
+
+#include "model/Mesh.h"
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Model {
+            /**
+             * Simplifies a triangle mesh via quadric error metric edge
+             * collapse.
+             *
+             * <P>Vertices are welded when all of their attributes are
+             * equal. Edges are collapsed onto one of their endpoints,
+             * cheapest first, so vertex attributes are never interpolated.
+             * Vertices on open borders, including texture and normal
+             * seams, are not moved, preserving the mesh outline and its
+             * texture mapping. Collapses that would fold a triangle or
+             * make the mesh non-manifold are rejected, so the target may
+             * not be reached.
+             *
+             * <P>The result is indexed if it has no more than 65535
+             * vertices. Materials and winding order are preserved.
+             *
+             * @param value         Returns the simplified mesh
+             * @param mesh          The source mesh; must be `TEDM_Triangles`
+             * @param targetFaces   The desired number of faces
+             *
+             * @return  TE_Ok on success, TE_Unsupported if the mesh is not
+             *          a triangle list, various codes on failure
+             */
+            ENGINE_API Util::TAKErr MeshSimplifier_simplify(MeshPtr &value, const Mesh &mesh, const std::size_t targetFaces) NOTHROWS;
+        }
+    }
+}
+
+#endif
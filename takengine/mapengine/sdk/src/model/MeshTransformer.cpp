@@ -326,10 +326,8 @@ TAKErr TAK::Engine::Model::Mesh_transform(Envelope2 *dstAABB, const Envelope2 &s
     pts[6] = Point2<double>(srcAABB.maxX, srcAABB.maxY, srcAABB.maxZ);
     pts[7] = Point2<double>(srcAABB.minX, srcAABB.maxY, srcAABB.maxZ);
     if(srcInfo.localFrame.get()) {
-        for (std::size_t i = 0; i < 8u; i++) {
-            code = srcInfo.localFrame->transform(&pts[i], pts[i]);
-            TE_CHECKBREAK_CODE(code);
-        }
+        static_assert(sizeof(Point2<double>) == 3u*sizeof(double), "Point2<double> is not packed");
+        code = srcInfo.localFrame->transform(&pts[0].x, &pts[0].x, 8u);
         TE_CHECKRETURN_CODE(code);
     }
     if(srcInfo.srid != dstInfo.srid) {
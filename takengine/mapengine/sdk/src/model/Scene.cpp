@@ -8,9 +8,11 @@
 #include "model/SceneBuilder.h"
 #include "port/STLIteratorAdapter.h"
 #include "util/CopyOnWrite.h"
+#include "util/IO2.h"
 
 
 #define TE_SERIALIZED_MESH_HEADER_RESERVED 7u
+#define TE_SERIALIZED_SCENE_VERSION 0x3u
 
 using namespace TAK::Engine::Model;
 
@@ -50,6 +52,18 @@ namespace {
         std::multimap<int, std::shared_ptr<SceneSpi>> priority_sorted;
     };
 
+    class LazySceneSpi : public SceneSpi {
+    public:
+        LazySceneSpi(const LazySpiDescriptor &descriptor, std::shared_ptr<SceneSpi>(*factory)()) NOTHROWS;
+    public:
+        const char *getType() const NOTHROWS override;
+        int getPriority() const NOTHROWS override;
+        TAK::Engine::Util::TAKErr create(ScenePtr &scene, const char *URI, ProcessingCallback *callbacks,
+            const TAK::Engine::Port::Collection<ResourceAlias> *resourceAliases) const NOTHROWS override;
+    private:
+        mutable LazySpi<SceneSpi> impl;
+    };
+
     class StreamingSceneNode : public SceneNode
     {
     public :
@@ -117,14 +131,84 @@ namespace {
 
     TAKErr prepareEncode(std::unique_ptr<StreamingSceneNode> &value, int64_t &dataOff, SceneNode &src, std::map<std::size_t, int64_t> &instanceOffsets, const StreamingSceneNode *parent) NOTHROWS;
 
+    /**
+     * Reads the mesh records that the node records of an encoded scene
+     * reference by offset and length.
+     */
+    class MeshRecordReader
+    {
+    public :
+        virtual ~MeshRecordReader() NOTHROWS {}
+        virtual TAKErr read(MeshPtr_const &value, const int64_t offset, const std::size_t length) NOTHROWS = 0;
+    };
+    class FileMeshRecordReader : public MeshRecordReader
+    {
+    public :
+        FileMeshRecordReader(FileInput2 &src, const uint8_t version) NOTHROWS;
+        TAKErr read(MeshPtr_const &value, const int64_t offset, const std::size_t length) NOTHROWS override;
+    private :
+        FileInput2 &src;
+        uint8_t version;
+    };
+    /** Decodes the mesh records in place from a mapped file */
+    class MappedMeshRecordReader : public MeshRecordReader
+    {
+    public :
+        MappedMeshRecordReader(const std::shared_ptr<MappedFileInput2> &src) NOTHROWS;
+        TAKErr read(MeshPtr_const &value, const int64_t offset, const std::size_t length) NOTHROWS override;
+    private :
+        std::shared_ptr<MappedFileInput2> src;
+    };
+
+    /** Retains the mapping that a decoded mesh references in place */
+    struct MappedMeshData
+    {
+        std::shared_ptr<const void> backing;
+        /** the indices, if they could not be referenced in place */
+        array_ptr<uint8_t> indices;
+    };
+
+    /** Identifies the content that an encoded scene was created from */
+    struct SourceKey
+    {
+        TAK::Engine::Port::String uri;
+        int64_t lastModified {0LL};
+        int64_t length {0LL};
+    };
+
+    TAKErr SourceKey_get(SourceKey &value, const char *uri) NOTHROWS;
+    TAKErr SourceKey_encode(DataOutput2 &dst, const SourceKey &key) NOTHROWS;
+    TAKErr SourceKey_decode(SourceKey &value, DataInput2 &src) NOTHROWS;
+    std::size_t SourceKey_encodeLength(const SourceKey &key) NOTHROWS;
+
+    TAKErr encodeImpl(const char *path, const Scene &scene, const SourceKey &key) NOTHROWS;
+
     TAKErr encodeMesh(DataOutput2 &dst, const Mesh &mesh) NOTHROWS;
-    TAKErr computeMeshEncodeLength(std::size_t *value, const Mesh &mesh) NOTHROWS;
-    TAKErr decodeMesh(MeshPtr_const &value, DataInput2 &src) NOTHROWS;
+    /**
+     * @param vertexDataOffset  If non-`nullptr`, returns the offset of the
+     *                          vertex data within the encoded mesh
+     */
+    TAKErr computeMeshEncodeLength(std::size_t *value, const Mesh &mesh, std::size_t *vertexDataOffset = nullptr) NOTHROWS;
+    /**
+     * @param backing   If non-`nullptr`, `src` is a view of memory kept alive
+     *                  by `backing`, and interleaved vertex data and indices
+     *                  are referenced in place
+     */
+    TAKErr decodeMesh(MeshPtr_const &value, DataInput2 &src, const std::shared_ptr<const void> &backing, const uint8_t version) NOTHROWS;
 
     TAKErr encodeSceneNode(FileOutput2 &dst, std::map<std::size_t, bool> &meshInstanceEncoded, const StreamingSceneNode &node) NOTHROWS;
-    TAKErr decodeSceneNode(std::unique_ptr<StreamingSceneNode> &value, FileInput2 &src, std::map<std::size_t, std::shared_ptr<const Mesh>> &instanceMeshes, const uint8_t version) NOTHROWS;
+    TAKErr decodeSceneNode(std::unique_ptr<StreamingSceneNode> &value, DataInput2 &src, MeshRecordReader &meshes, std::map<std::size_t, std::shared_ptr<const Mesh>> &instanceMeshes, const uint8_t version) NOTHROWS;
 
     int64_t computeMeshDataOffsetShift(StreamingSceneNode &node) NOTHROWS;
+    /**
+     * Returns the number of padding bytes preceding interleaved index data
+     * (v3+), which align the indices to 4 bytes relative to the vertex data
+     */
+    std::size_t getIndexDataPadding(const std::size_t vertexDataLen) NOTHROWS
+    {
+        // vertex data is followed by the index flag, type and count
+        return (4u - ((vertexDataLen + 9u) % 4u)) % 4u;
+    }
     void shiftMeshDataOffsets(StreamingSceneNode &node, const int64_t shift) NOTHROWS;
 
     std::size_t getDataTypeSize(const DataType &type) NOTHROWS
@@ -135,7 +219,7 @@ namespace {
             return 1u;
         case TEDT_Int16 :
         case TEDT_UInt16 :
-            return 1u;
+            return 2u;
         case TEDT_Int32 :
         case TEDT_UInt32 :
         case TEDT_Float32 :
@@ -152,6 +236,19 @@ ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneFactory_registerSp
     return sharedSceneRegistry().invokeWrite(&SceneSpiRegistry::registerSpi, spiPtr);
 }
 
+ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneFactory_registerSpi(const LazySpiDescriptor &descriptor, std::shared_ptr<SceneSpi>(*factory)(), std::shared_ptr<SceneSpi> *value) NOTHROWS {
+    if (!descriptor.name || !factory)
+        return TE_InvalidArg;
+    std::shared_ptr<SceneSpi> spi(new(std::nothrow) LazySceneSpi(descriptor, factory));
+    if (!spi)
+        return TE_OutOfMemory;
+    TAKErr code = SceneFactory_registerSpi(spi);
+    TE_CHECKRETURN_CODE(code);
+    if (value)
+        *value = spi;
+    return code;
+}
+
 ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneFactory_unregisterSpi(const std::shared_ptr<SceneSpi> &spiPtr) NOTHROWS {
     return sharedSceneRegistry().invokeWrite(&SceneSpiRegistry::unregisterSpi, spiPtr);
 }
@@ -166,33 +263,18 @@ ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneFactory_create(Sce
 }
 
 TAKErr TAK::Engine::Model::SceneFactory_encode(const char *path, const Scene &scene) NOTHROWS
+{
+    return encodeImpl(path, scene, SourceKey());
+}
+TAKErr TAK::Engine::Model::SceneFactory_encode(const char *path, const Scene &scene, const char *sourceUri) NOTHROWS
 {
     TAKErr code(TE_Ok);
-
-    // compute header
-    // we will traverse the source graph, populating the streaming
-    // representation (records basic data model data and offset/length for
-    // meshes).
-    std::unique_ptr<StreamingSceneNode> stream;
-    int64_t dataOff = 0LL;
-    std::map<std::size_t, int64_t> instanceOffsets;
-    code = prepareEncode(stream, dataOff, scene.getRootNode(), instanceOffsets, nullptr);
-
-    // write header
-    FileOutput2 sink;
-    code = sink.open(path);
-    TE_CHECKRETURN_CODE(code);
-    
-    uint8_t header[7u] = { /*magic*/ 'T', 'A', 'K', 'B', 'S', 'G', /*version*/ 0x2u };
-    // header
-    sink.write(header, 7u);
-
-    // recurse stream nodes, writing data records
-    std::map<std::size_t, bool> meshInstanceEncoded;
-    code = encodeSceneNode(sink, meshInstanceEncoded, *stream);
+    if (!sourceUri)
+        return TE_InvalidArg;
+    SourceKey key;
+    code = SourceKey_get(key, sourceUri);
     TE_CHECKRETURN_CODE(code);
-
-    return TE_Ok;
+    return encodeImpl(path, scene, key);
 }
 TAKErr TAK::Engine::Model::SceneFactory_decode(ScenePtr &value, const char *file, const bool streaming) NOTHROWS
 {
@@ -205,16 +287,71 @@ TAKErr TAK::Engine::Model::SceneFactory_decode(ScenePtr &value, const char *file
     std::size_t numRead;
     code = src.read(header, &numRead, 7u);
     TE_CHECKRETURN_CODE(code);
+    if (numRead < 7u)
+        return TE_EOF;
 
-    uint8_t v1header[7u] = { /*magic*/ 'T', 'A', 'K', 'B', 'S', 'G', /*version*/ 0x1u };
-    uint8_t v2header[7u] = { /*magic*/ 'T', 'A', 'K', 'B', 'S', 'G', /*version*/ 0x2u };
+    const uint8_t magic[6u] = { 'T', 'A', 'K', 'B', 'S', 'G' };
+    if (memcmp(header, magic, 6u) != 0 || header[6u] < 0x1u || header[6u] > TE_SERIALIZED_SCENE_VERSION)
+        return TE_InvalidArg;
+
+    // v3 records the source; not needed here
+    if (header[6u] > 0x2u) {
+        SourceKey key;
+        code = SourceKey_decode(key, src);
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    FileMeshRecordReader meshes(src, header[6u]);
+    std::unique_ptr<StreamingSceneNode> root;
+    std::map<std::size_t, std::shared_ptr<const Mesh>> instanceMeshes;
+    code = decodeSceneNode(root, src, meshes, instanceMeshes, header[6u]);
+    TE_CHECKRETURN_CODE(code);
 
-    if (memcmp(header, v1header, 7u) != 0 && memcmp(header, v2header, 7u) != 0)
+    code = SceneBuilder_build(value, std::move(SceneNodePtr(root.release(), Memory_deleter_const<SceneNode, StreamingSceneNode>)), true);
+    TE_CHECKRETURN_CODE(code);
+
+    return code;
+}
+TAKErr TAK::Engine::Model::SceneFactory_decodeCached(ScenePtr &value, const char *path, const char *sourceUri) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!path || !sourceUri)
         return TE_InvalidArg;
 
+    std::shared_ptr<MappedFileInput2> src(new(std::nothrow) MappedFileInput2());
+    if (!src)
+        return TE_OutOfMemory;
+    code = src->open(path, TEMA_Random);
+    TE_CHECKRETURN_CODE(code);
+
+    uint8_t header[7u];
+    std::size_t numRead;
+    code = src->read(header, &numRead, 7u);
+    if (code == TE_EOF || (code == TE_Ok && numRead < 7u))
+        return TE_Done;
+    TE_CHECKRETURN_CODE(code);
+
+    const uint8_t current[7u] = { /*magic*/ 'T', 'A', 'K', 'B', 'S', 'G', /*version*/ TE_SERIALIZED_SCENE_VERSION };
+    if (memcmp(header, current, 7u) != 0)
+        return TE_Done;
+
+    SourceKey cached;
+    code = SourceKey_decode(cached, *src);
+    TE_CHECKRETURN_CODE(code);
+    SourceKey source;
+    if (SourceKey_get(source, sourceUri) != TE_Ok)
+        return TE_Done;
+    if (!cached.uri || strcmp(cached.uri, source.uri) != 0 ||
+        cached.lastModified != source.lastModified ||
+        cached.length != source.length) {
+
+        return TE_Done;
+    }
+
+    MappedMeshRecordReader meshes(src);
     std::unique_ptr<StreamingSceneNode> root;
     std::map<std::size_t, std::shared_ptr<const Mesh>> instanceMeshes;
-    code = decodeSceneNode(root, src, instanceMeshes, header[6u]);
+    code = decodeSceneNode(root, *src, meshes, instanceMeshes, header[6u]);
     TE_CHECKRETURN_CODE(code);
 
     code = SceneBuilder_build(value, std::move(SceneNodePtr(root.release(), Memory_deleter_const<SceneNode, StreamingSceneNode>)), true);
@@ -271,6 +408,25 @@ namespace {
         return createImpl(priority_sorted.begin(), priority_sorted.end(), scene, URI, callbacks, resourceAliases);
     }
 
+    LazySceneSpi::LazySceneSpi(const LazySpiDescriptor &descriptor, std::shared_ptr<SceneSpi>(*factory)()) NOTHROWS :
+        impl(descriptor, factory)
+    {}
+    const char *LazySceneSpi::getType() const NOTHROWS {
+        return impl.getName();
+    }
+    int LazySceneSpi::getPriority() const NOTHROWS {
+        return impl.getPriority();
+    }
+    TAK::Engine::Util::TAKErr LazySceneSpi::create(ScenePtr &scene, const char *URI, ProcessingCallback *callbacks,
+        const TAK::Engine::Port::Collection<ResourceAlias> *resourceAliases) const NOTHROWS {
+        if (!impl.matches(URI))
+            return TE_Unsupported;
+        std::shared_ptr<SceneSpi> spi;
+        TAKErr code = impl.get(spi);
+        TE_CHECKRETURN_CODE(code);
+        return spi->create(scene, URI, callbacks, resourceAliases);
+    }
+
     StreamingSceneNode::StreamingSceneNode() NOTHROWS :
         parent(nullptr),
         hasLocalFrame(false),
@@ -435,10 +591,13 @@ namespace {
                 code = src.loadMesh(mesh, i, nullptr);
                 TE_CHECKRETURN_CODE(code);
 
-                code = computeMeshEncodeLength(&lod.meshDataLength, *mesh);
+                std::size_t vertexDataOffset;
+                code = computeMeshEncodeLength(&lod.meshDataLength, *mesh, &vertexDataOffset);
                 TE_CHECKRETURN_CODE(code);
 
                 if (lod.instanceId == SceneNode::InstanceID_None || (instanceOffsets.find(lod.instanceId) == instanceOffsets.end())) {
+                    // pad so that the vertex data falls on an 8 byte boundary
+                    dataOff += (8LL - ((dataOff + (int64_t)vertexDataOffset) % 8LL)) % 8LL;
                     lod.meshDataOffset = dataOff;
                     dataOff += lod.meshDataLength;
                     instanceOffsets[lod.instanceId] = lod.meshDataOffset;
@@ -484,13 +643,6 @@ namespace {
             TE_CHECKRETURN_CODE(code);
         }
 
-        // if completing recursion the root, apply the header data offset to the mesh data offsets
-        if (!parent) {
-            const int64_t headerDataLen = computeMeshDataOffsetShift(*value);
-            // XXX - do we want to align the mesh data???
-            shiftMeshDataOffsets(*value, TE_SERIALIZED_MESH_HEADER_RESERVED+headerDataLen);
-        }
-
         return code;
     }
 
@@ -718,13 +870,21 @@ namespace {
             TE_CHECKRETURN_CODE(code);
             code = dst.writeInt(static_cast<int32_t>(mesh.getNumIndices()));
             TE_CHECKRETURN_CODE(code);
+            if (dstLayout.interleaved) {
+                std::size_t dataLen;
+                code = VertexDataLayout_requiredInterleavedDataSize(&dataLen, dstLayout, mesh.getNumVertices());
+                TE_CHECKRETURN_CODE(code);
+                const uint8_t padding[4u] = { 0u, 0u, 0u, 0u };
+                code = dst.write(padding, getIndexDataPadding(dataLen));
+                TE_CHECKRETURN_CODE(code);
+            }
             code = dst.write((const uint8_t *)indices + mesh.getIndexOffset(), mesh.getNumIndices()*getDataTypeSize(indexType));
             TE_CHECKRETURN_CODE(code);
         }
 
         return code;
     }
-    TAKErr computeMeshEncodeLength(std::size_t *value, const Mesh &mesh) NOTHROWS
+    TAKErr computeMeshEncodeLength(std::size_t *value, const Mesh &mesh, std::size_t *vertexDataOffset) NOTHROWS
     {
         TAKErr code(TE_Ok);
 
@@ -854,6 +1014,8 @@ namespace {
 
             //code = dst.writeLong(dataLen);
             *value += 8u;
+            if (vertexDataOffset)
+                *vertexDataOffset = *value;
             //code = dst.write((const uint8_t *)data + (srcLayout.position.offset-dstLayout.position.offset), dataLen);
             *value += dataLen;
         } else {
@@ -888,6 +1050,8 @@ namespace {
 
                 //code = dst.writeLong(dataLen);
                 *value += 8u;
+                if (vertexDataOffset && i == 0u)
+                    *vertexDataOffset = *value;
 
                 //code = dst.write((const uint8_t *)data+records[i].srcArr.offset, dataLen);
                 *value += dataLen;
@@ -907,6 +1071,12 @@ namespace {
             //code = dst.writeInt(indexType);
             //code = dst.writeInt(mesh.getNumIndices());
             *value += 8u;
+            if (dstLayout.interleaved) {
+                std::size_t dataLen;
+                code = VertexDataLayout_requiredInterleavedDataSize(&dataLen, dstLayout, mesh.getNumVertices());
+                TE_CHECKRETURN_CODE(code);
+                *value += getIndexDataPadding(dataLen);
+            }
 
             //code = dst.write((const uint8_t *)indices + mesh.getIndexOffset(), mesh.getNumIndices());
             *value += mesh.getNumIndices()*getDataTypeSize(indexType);
@@ -914,7 +1084,7 @@ namespace {
 
         return code;
     }
-    TAKErr decodeMesh(MeshPtr_const &value, DataInput2 &src) NOTHROWS
+    TAKErr decodeMesh(MeshPtr_const &value, DataInput2 &src, const std::shared_ptr<const void> &backing, const uint8_t version) NOTHROWS
     {
         TAKErr code(TE_Ok);
         int intval;
@@ -940,6 +1110,8 @@ namespace {
         VoidPtr_const texCoord5(nullptr, nullptr);
         VoidPtr_const texCoord6(nullptr, nullptr);
         VoidPtr_const texCoord7(nullptr, nullptr);
+        // interleaved vertex data referenced in place
+        const uint8_t *mappedVertices = nullptr;
 
         MeshPtr retval(nullptr, nullptr);
 
@@ -1033,21 +1205,32 @@ namespace {
         if (intval < 0)
             return TE_IllegalState;
         numVertices = intval;
+        std::size_t interleavedDataLen = 0u;
         if (layout.interleaved) {
             code = src.readLong(&longval);
             TE_CHECKRETURN_CODE(code);
             if (longval > 0xFFFFFFFFLL)
                 return TE_IllegalState;
             const auto dataLen = static_cast<std::size_t>(longval);
+            interleavedDataLen = dataLen;
 
-            VoidPtr data(te_alloc_v(dataLen), te_free_v);
-            if (!data.get())
-                return TE_OutOfMemory;
-            code = src.read((uint8_t *)data.get(), &numRead, dataLen);
-            TE_CHECKRETURN_CODE(code);
-            if (numRead < dataLen)
-                return TE_EOF;
-            position = VoidPtr_const(data.release(), data.get_deleter());
+            const uint8_t *span = nullptr;
+            if (backing && src.readSpan(&span, dataLen) == TE_Ok && !((intptr_t)span % 4)) {
+                mappedVertices = span;
+            } else {
+                VoidPtr data(te_alloc_v(dataLen), te_free_v);
+                if (!data.get())
+                    return TE_OutOfMemory;
+                if (span) {
+                    memcpy(data.get(), span, dataLen);
+                } else {
+                    code = src.read((uint8_t *)data.get(), &numRead, dataLen);
+                    TE_CHECKRETURN_CODE(code);
+                    if (numRead < dataLen)
+                        return TE_EOF;
+                }
+                position = VoidPtr_const(data.release(), data.get_deleter());
+            }
         } else {
             struct VertexDataRecord
             {
@@ -1106,15 +1289,49 @@ namespace {
             if (intval < 0)
                 return TE_IllegalState;
             const std::size_t numIndices = intval;
+            const std::size_t indicesLen = numIndices*getDataTypeSize(indexType);
+            if (layout.interleaved && version > 0x2u) {
+                code = src.skip(getIndexDataPadding(interleavedDataLen));
+                TE_CHECKRETURN_CODE(code);
+            }
 
-            array_ptr<uint8_t> indices(new uint8_t[numIndices*getDataTypeSize(indexType)]);
-            code = src.read(indices.get(), &numRead, numIndices*getDataTypeSize(indexType));
-            TE_CHECKRETURN_CODE(code);
-            if (numRead < (numIndices*getDataTypeSize(indexType)))
-                return TE_EOF;
-
+            const uint8_t *mappedIndices = nullptr;
+            array_ptr<uint8_t> indices;
+            if (mappedVertices && src.readSpan(&mappedIndices, indicesLen) == TE_Ok && !((intptr_t)mappedIndices % getDataTypeSize(indexType))) {
+                // referenced in place
+            } else {
+                indices.reset(new uint8_t[indicesLen]);
+                if (mappedIndices) {
+                    memcpy(indices.get(), mappedIndices, indicesLen);
+                    mappedIndices = nullptr;
+                } else {
+                    code = src.read(indices.get(), &numRead, indicesLen);
+                    TE_CHECKRETURN_CODE(code);
+                    if (numRead < indicesLen)
+                        return TE_EOF;
+                }
+            }
 
-            if(layout.interleaved)
+            if (mappedVertices) {
+                std::unique_ptr<MappedMeshData> retain(new MappedMeshData());
+                retain->backing = backing;
+                retain->indices.reset(indices.release());
+                const void *indexData = mappedIndices ? static_cast<const void *>(mappedIndices) : static_cast<const void *>(retain->indices.get());
+                code = MeshBuilder_buildInterleavedMesh(
+                    retval,
+                    drawMode,
+                    windingOrder,
+                    layout,
+                    numMaterials,
+                    materials.data(),
+                    TAK::Engine::Feature::Envelope2(aabb[0], aabb[1], aabb[2], aabb[3], aabb[4], aabb[5]),
+                    numVertices,
+                    mappedVertices,
+                    indexType,
+                    numIndices,
+                    indexData,
+                    std::unique_ptr<void, void(*)(const void *)>(retain.release(), Memory_void_deleter_const<MappedMeshData>));
+            } else if(layout.interleaved)
                 code = MeshBuilder_buildInterleavedMesh(
                     retval,
                     drawMode,
@@ -1153,6 +1370,21 @@ namespace {
                     numIndices,
                     std::move(VoidPtr_const(indices.release(), Memory_void_array_deleter_const<uint8_t>)));
             TE_CHECKRETURN_CODE(code);
+        } else if (mappedVertices) {
+            std::unique_ptr<MappedMeshData> retain(new MappedMeshData());
+            retain->backing = backing;
+            code = MeshBuilder_buildInterleavedMesh(
+                retval,
+                drawMode,
+                windingOrder,
+                layout,
+                numMaterials,
+                materials.data(),
+                TAK::Engine::Feature::Envelope2(aabb[0], aabb[1], aabb[2], aabb[3], aabb[4], aabb[5]),
+                numVertices,
+                mappedVertices,
+                std::unique_ptr<void, void(*)(const void *)>(retain.release(), Memory_void_deleter_const<MappedMeshData>));
+            TE_CHECKRETURN_CODE(code);
         } else if (layout.interleaved) {
             code = MeshBuilder_buildInterleavedMesh(
                 retval,
@@ -1273,7 +1505,7 @@ namespace {
 
         return code;
     }
-    TAKErr decodeSceneNode(std::unique_ptr<StreamingSceneNode> &value, FileInput2 &src, std::map<std::size_t, std::shared_ptr<const Mesh>> &instanceMeshes, const uint8_t version) NOTHROWS
+    TAKErr decodeSceneNode(std::unique_ptr<StreamingSceneNode> &value, DataInput2 &src, MeshRecordReader &meshes, std::map<std::size_t, std::shared_ptr<const Mesh>> &instanceMeshes, const uint8_t version) NOTHROWS
     {
         TAKErr code(TE_Ok);
         uint8_t bit;
@@ -1346,12 +1578,8 @@ namespace {
 
             // mark the current write pointer to automatically restore after we write the mesh
             if (node->lods[i].instanceId == SceneNode::InstanceID_None || (instanceMeshes.find(node->lods[i].instanceId) == instanceMeshes.end())) {
-                FileMark<FileInput2> mark(src);
-                // seek to the offset
-                code = src.seek(node->lods[i].meshDataOffset);
-                TE_CHECKBREAK_CODE(code);
                 MeshPtr_const mesh(nullptr, nullptr);
-                code = decodeMesh(mesh, src);
+                code = meshes.read(mesh, node->lods[i].meshDataOffset, node->lods[i].meshDataLength);
                 TE_CHECKBREAK_CODE(code);
 
                 // XXX - enable possibility to stream from file on demand rather than allocating
@@ -1377,7 +1605,7 @@ namespace {
         node->children.reserve(numChildren);
         for (std::size_t i = 0u; i < static_cast<std::size_t>(numChildren); i++) {
             std::unique_ptr<StreamingSceneNode> child;
-            code = decodeSceneNode(child, src, instanceMeshes, version);
+            code = decodeSceneNode(child, src, meshes, instanceMeshes, version);
             TE_CHECKBREAK_CODE(code);
 
             child->parent = node.get();
@@ -1389,4 +1617,147 @@ namespace {
 
         return code;
     }
+
+    TAKErr encodeImpl(const char *path, const Scene &scene, const SourceKey &key) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        // compute header
+        // we will traverse the source graph, populating the streaming
+        // representation (records basic data model data and offset/length for
+        // meshes).
+        std::unique_ptr<StreamingSceneNode> stream;
+        int64_t dataOff = 0LL;
+        std::map<std::size_t, int64_t> instanceOffsets;
+        code = prepareEncode(stream, dataOff, scene.getRootNode(), instanceOffsets, nullptr);
+        TE_CHECKRETURN_CODE(code);
+
+        // the mesh data follows the header, source key and node records.
+        // `prepareEncode` aligns the mesh records relative to the start of
+        // the mesh data, which is itself placed on an 8 byte boundary
+        const int64_t headerDataLen = TE_SERIALIZED_MESH_HEADER_RESERVED + SourceKey_encodeLength(key) + computeMeshDataOffsetShift(*stream);
+        shiftMeshDataOffsets(*stream, (headerDataLen + 7LL) & ~7LL);
+
+        // an existing file may be mapped by a previously decoded scene;
+        // truncating it would invalidate the mapping
+        bool exists;
+        if (IO_exists(&exists, path) == TE_Ok && exists)
+            IO_delete(path);
+
+        // write header
+        FileOutput2 sink;
+        code = sink.open(path);
+        TE_CHECKRETURN_CODE(code);
+
+        uint8_t header[7u] = { /*magic*/ 'T', 'A', 'K', 'B', 'S', 'G', /*version*/ TE_SERIALIZED_SCENE_VERSION };
+        // header
+        code = sink.write(header, 7u);
+        TE_CHECKRETURN_CODE(code);
+        code = SourceKey_encode(sink, key);
+        TE_CHECKRETURN_CODE(code);
+
+        // recurse stream nodes, writing data records
+        std::map<std::size_t, bool> meshInstanceEncoded;
+        code = encodeSceneNode(sink, meshInstanceEncoded, *stream);
+        TE_CHECKRETURN_CODE(code);
+
+        return code;
+    }
+
+    FileMeshRecordReader::FileMeshRecordReader(FileInput2 &src_, const uint8_t version_) NOTHROWS :
+        src(src_),
+        version(version_)
+    {}
+    TAKErr FileMeshRecordReader::read(MeshPtr_const &value, const int64_t offset, const std::size_t length) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        // mark the current read pointer to automatically restore after we read the mesh
+        FileMark<FileInput2> mark(src);
+        // seek to the offset
+        code = src.seek(offset);
+        TE_CHECKRETURN_CODE(code);
+        return decodeMesh(value, src, std::shared_ptr<const void>(), version);
+    }
+
+    MappedMeshRecordReader::MappedMeshRecordReader(const std::shared_ptr<MappedFileInput2> &src_) NOTHROWS :
+        src(src_)
+    {}
+    TAKErr MappedMeshRecordReader::read(MeshPtr_const &value, const int64_t offset, const std::size_t length) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (offset < 0LL || (offset + (int64_t)length) > src->length())
+            return TE_EOF;
+        const uint8_t *data;
+        code = src->getData(&data);
+        TE_CHECKRETURN_CODE(code);
+        MemoryInput2 record;
+        code = record.open(data + offset, length);
+        TE_CHECKRETURN_CODE(code);
+        return decodeMesh(value, record, src, TE_SERIALIZED_SCENE_VERSION);
+    }
+
+    TAKErr SourceKey_get(SourceKey &value, const char *uri) NOTHROWS
+    {
+        // content within an archive is keyed on the archive
+        TAK::Engine::Port::String path(uri);
+        while (path) {
+            bool exists;
+            if (IO_exists(&exists, path) == TE_Ok && exists) {
+                TAKErr code(TE_Ok);
+                code = IO_getLastModified(&value.lastModified, path);
+                TE_CHECKRETURN_CODE(code);
+                code = IO_length(&value.length, path);
+                TE_CHECKRETURN_CODE(code);
+                value.uri = uri;
+                return code;
+            }
+            TAK::Engine::Port::String parent;
+            if (IO_getParentFile(parent, path) != TE_Ok || !parent || strcmp(parent, path) == 0)
+                break;
+            path = parent;
+        }
+        return TE_InvalidArg;
+    }
+    TAKErr SourceKey_encode(DataOutput2 &dst, const SourceKey &key) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = dst.writeInt(key.uri ? static_cast<int32_t>(strlen(key.uri)) : 0);
+        TE_CHECKRETURN_CODE(code);
+        if (key.uri) {
+            code = dst.writeString(key.uri);
+            TE_CHECKRETURN_CODE(code);
+        }
+        code = dst.writeLong(key.lastModified);
+        TE_CHECKRETURN_CODE(code);
+        code = dst.writeLong(key.length);
+        TE_CHECKRETURN_CODE(code);
+        return code;
+    }
+    TAKErr SourceKey_decode(SourceKey &value, DataInput2 &src) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        int intval;
+        code = src.readInt(&intval);
+        TE_CHECKRETURN_CODE(code);
+        if (intval < 0)
+            return TE_IllegalState;
+        if (intval) {
+            std::size_t numRead;
+            array_ptr<char> uri(new char[intval+1]);
+            code = src.readString(uri.get(), &numRead, intval);
+            TE_CHECKRETURN_CODE(code);
+            if (numRead < static_cast<std::size_t>(intval))
+                return TE_EOF;
+            value.uri = uri.get();
+        }
+        code = src.readLong(&value.lastModified);
+        TE_CHECKRETURN_CODE(code);
+        code = src.readLong(&value.length);
+        TE_CHECKRETURN_CODE(code);
+        return code;
+    }
+    std::size_t SourceKey_encodeLength(const SourceKey &key) NOTHROWS
+    {
+        return 4u + (key.uri ? strlen(key.uri) : 0u) + 16u;
+    }
 }
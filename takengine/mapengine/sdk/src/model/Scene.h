@@ -13,6 +13,7 @@
 #include "util/DataInput2.h"
 #include "util/DataOutput2.h"
 #include "util/Error.h"
+#include "util/LazySpi.h"
 #include "util/ProcessingCallback.h"
 
 namespace TAK {
@@ -80,6 +81,16 @@ namespace TAK {
             };
 
             ENGINE_API TAK::Engine::Util::TAKErr SceneFactory_registerSpi(const std::shared_ptr<SceneSpi> &spiPtr) NOTHROWS;
+            /**
+             * Registers an SPI that is instantiated on the first request
+             * whose URI matches the descriptor's extensions. The
+             * descriptor's name is the SPI type.
+             *
+             * @param value Returns the registered SPI, which may be
+             *              passed to `SceneFactory_unregisterSpi`; may be
+             *              `nullptr`
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr SceneFactory_registerSpi(const Util::LazySpiDescriptor &descriptor, std::shared_ptr<SceneSpi>(*factory)(), std::shared_ptr<SceneSpi> *value = nullptr) NOTHROWS;
             ENGINE_API TAK::Engine::Util::TAKErr SceneFactory_unregisterSpi(const std::shared_ptr<SceneSpi> &spiPtr) NOTHROWS;
 
             ENGINE_API TAK::Engine::Util::TAKErr SceneFactory_create(ScenePtr &scene, 
@@ -89,7 +100,28 @@ namespace TAK {
                 const TAK::Engine::Port::Collection<ResourceAlias> *resourceAliases) NOTHROWS;
 
             ENGINE_API Util::TAKErr SceneFactory_encode(const char *path, const Scene &scene) NOTHROWS;
+            /**
+             * Encodes the scene as a cache of the content at `sourceUri`.
+             * The source URI, its modification time and length, and the
+             * encoding version are recorded with the scene; see
+             * `SceneFactory_decodeCached`. Mesh data is aligned so that
+             * it may be accessed in place when the file is mapped.
+             */
+            ENGINE_API Util::TAKErr SceneFactory_encode(const char *path, const Scene &scene, const char *sourceUri) NOTHROWS;
             ENGINE_API Util::TAKErr SceneFactory_decode(ScenePtr &scene, const char *path, const bool streaming) NOTHROWS;
+            /**
+             * Decodes a scene cached via
+             * `SceneFactory_encode(path, scene, sourceUri)`. The file is
+             * memory mapped and interleaved vertex data is referenced in
+             * place; the mapping is retained by the meshes.
+             *
+             * @return  TE_Ok on success; TE_Done if the cache is stale,
+             *          i.e. it was encoded from a different URI, the source
+             *          has since been modified, or it was encoded by a
+             *          different version of the engine; various codes on
+             *          failure
+             */
+            ENGINE_API Util::TAKErr SceneFactory_decodeCached(ScenePtr &scene, const char *path, const char *sourceUri) NOTHROWS;
         }
     }
 }
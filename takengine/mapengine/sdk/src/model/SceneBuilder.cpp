@@ -152,6 +152,36 @@ TAKErr SceneBuilder::addMesh(const std::shared_ptr<const Mesh> &mesh, const Matr
     return code;
 }
 
+TAKErr SceneBuilder::addMesh(const std::shared_ptr<const Mesh> *lods, const std::size_t numLods, const Matrix2 *localFrame) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!impl)
+        return TE_IllegalState;
+    if (!lods || !numLods || !lods[0])
+        return TE_InvalidArg;
+    BuilderSceneImpl &scene = *static_cast<BuilderSceneImpl *>(impl.get());
+    const std::shared_ptr<const Mesh> &mesh = lods[0];
+    SceneNode *ignored;
+    code = scene.graph.addNode(&ignored, *scene.node, localFrame, mesh->getAABB(), lods, numLods);
+    TE_CHECKRETURN_CODE(code);
+    // the scene meshes are the most detailed representation
+    scene.meshes.push_back(mesh);
+
+    Envelope2 meshaabb = mesh->getAABB();
+    code = transform(meshaabb, localFrame);
+    if (!scene.aabb.get()) {
+        scene.aabb.reset(new Envelope2(meshaabb));
+    } else {
+        scene.aabb->minX = std::min(meshaabb.minX, scene.aabb->minX);
+        scene.aabb->minY = std::min(meshaabb.minY, scene.aabb->minY);
+        scene.aabb->minZ = std::min(meshaabb.minZ, scene.aabb->minZ);
+        scene.aabb->maxX = std::max(meshaabb.maxX, scene.aabb->maxX);
+        scene.aabb->maxY = std::max(meshaabb.maxY, scene.aabb->maxY);
+        scene.aabb->maxZ = std::max(meshaabb.maxZ, scene.aabb->maxZ);
+    }
+    return code;
+}
+
 TAKErr SceneBuilder::addMesh(const std::size_t instanceId, const Matrix2 *localFrame) NOTHROWS
 {
     TAKErr code(TE_Ok);
@@ -21,6 +21,12 @@ namespace TAK {
                 Util::TAKErr addMesh(MeshPtr &&mesh, const Math::Matrix2 *localFrame) NOTHROWS;
                 Util::TAKErr addMesh(const std::shared_ptr<Mesh> &mesh, const Math::Matrix2 *localFrame) NOTHROWS;
                 Util::TAKErr addMesh(const std::shared_ptr<const Mesh> &mesh, const Math::Matrix2 *localFrame) NOTHROWS;
+                /**
+                 * Adds a mesh with multiple levels of detail. `lods[0]` is
+                 * the most detailed mesh; each successive mesh shall
+                 * approximately halve the detail of its predecessor.
+                 */
+                Util::TAKErr addMesh(const std::shared_ptr<const Mesh> *lods, const std::size_t numLods, const Math::Matrix2 *localFrame) NOTHROWS;
                 
                 // instanced meshes
                 Util::TAKErr addMesh(MeshPtr_const &&mesh, const std::size_t instanceId, const Math::Matrix2 *localFrame) NOTHROWS;
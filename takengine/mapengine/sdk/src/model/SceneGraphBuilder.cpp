@@ -1,6 +1,8 @@
 #include "model/SceneGraphBuilder.h"
 
+#include <cmath>
 #include <list>
+#include <vector>
 
 #include "port/STLListAdapter.h"
 #include "util/Memory.h"
@@ -19,6 +21,7 @@ namespace
     public :
         SceneNodeImpl(SceneNodeImpl *parent, const Matrix2 *rootLocalFrame) NOTHROWS;
         SceneNodeImpl(SceneNodeImpl *parent, const Matrix2 *rootLocalFrame, const Envelope2 &aabb, const std::shared_ptr<const Mesh> &mesh, const std::size_t instanceId) NOTHROWS;
+        SceneNodeImpl(SceneNodeImpl *parent, const Matrix2 *rootLocalFrame, const Envelope2 &aabb, std::vector<std::shared_ptr<const Mesh>> &&lods) NOTHROWS;
         ~SceneNodeImpl() NOTHROWS override;
     public :
         bool isRoot() const NOTHROWS override;
@@ -44,7 +47,8 @@ namespace
         SceneNodeImpl *parent;
         std::size_t instanceId;
     private :
-        std::shared_ptr<const Mesh> mesh;
+        /** the mesh per LOD, most detailed first */
+        std::vector<std::shared_ptr<const Mesh>> meshes;
         std::unique_ptr<Matrix2> localFrame;
         Matrix2 accummulatedTransform;
     };
@@ -178,6 +182,38 @@ TAKErr SceneGraphBuilder::addNode(SceneNode **value, const SceneNode &parent, co
         *value = valueResult;
     return code;
 }
+TAKErr SceneGraphBuilder::addNode(SceneNode **value, const SceneNode &parent, const Matrix2 *localFrame, const Envelope2 &aabb, const std::shared_ptr<const Mesh> *lods, const std::size_t numLods) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!lods || !numLods)
+        return TE_InvalidArg;
+    // make sure the graph has not yet been built
+    if (!root.get())
+        return TE_IllegalState;
+    // ensure the specified parent is in the build graph
+    std::set<const SceneNode *>::iterator entry;
+    entry = nodes.find(&parent);
+    if (entry == nodes.end())
+        return TE_InvalidArg;
+    // cast the parent
+    auto &parentImpl = const_cast<SceneNodeImpl &>(static_cast<const SceneNodeImpl &>(parent));
+    TE_BEGIN_TRAP() {
+        std::vector<std::shared_ptr<const Mesh>> meshes(lods, lods+numLods);
+        for (std::size_t i = 0u; i < numLods; i++) {
+            if (!meshes[i])
+                return TE_InvalidArg;
+        }
+        // create the new child
+        SceneNodePtr child(new SceneNodeImpl(&parentImpl, localFrame, aabb, std::move(meshes)), Memory_deleter_const<SceneNode, SceneNodeImpl>);
+        SceneNode *valueResult = child.get();
+        // add the child to the parent
+        nodes.insert(child.get());
+        parentImpl.children.push_back(std::move(child));
+        if (value)
+            *value = valueResult;
+    } TE_END_TRAP(code);
+    return code;
+}
 TAKErr SceneGraphBuilder::build(SceneNodePtr &value) NOTHROWS
 {
     if (!root.get())
@@ -190,15 +226,24 @@ TAKErr SceneGraphBuilder::build(SceneNodePtr &value) NOTHROWS
 namespace
 {
     SceneNodeImpl::SceneNodeImpl(SceneNodeImpl *parent_, const Matrix2 *localFrame_) NOTHROWS :
-    parent(parent_),
-        localFrame(localFrame_ ? new Matrix2(*localFrame_) : nullptr),
-        instanceId(SceneNode::InstanceID_None)
+        parent(parent_),
+        instanceId(SceneNode::InstanceID_None),
+        localFrame(localFrame_ ? new Matrix2(*localFrame_) : nullptr)
     {}
     SceneNodeImpl::SceneNodeImpl(SceneNodeImpl *parent_, const Matrix2 *localFrame_, const Envelope2 &aabb_,  const std::shared_ptr<const Mesh> &mesh_, const std::size_t instanceId_) NOTHROWS :
         parent(parent_),
-        localFrame(localFrame_ ? new Matrix2(*localFrame_) : nullptr),
-        mesh(mesh_),
-        instanceId(instanceId_)
+        instanceId(instanceId_),
+        localFrame(localFrame_ ? new Matrix2(*localFrame_) : nullptr)
+    {
+        if (mesh_)
+            meshes.push_back(mesh_);
+        updateBounds(*this, aabb_);
+    }
+    SceneNodeImpl::SceneNodeImpl(SceneNodeImpl *parent_, const Matrix2 *localFrame_, const Envelope2 &aabb_, std::vector<std::shared_ptr<const Mesh>> &&lods_) NOTHROWS :
+        parent(parent_),
+        instanceId(SceneNode::InstanceID_None),
+        meshes(std::move(lods_)),
+        localFrame(localFrame_ ? new Matrix2(*localFrame_) : nullptr)
     {
         updateBounds(*this, aabb_);
     }
@@ -231,7 +276,7 @@ namespace
     }
     bool SceneNodeImpl::hasMesh() const NOTHROWS
     {
-        return !!mesh.get();
+        return !meshes.empty();
     }
     const Envelope2 &SceneNodeImpl::getAABB() const NOTHROWS
     {
@@ -239,33 +284,45 @@ namespace
     }
     std::size_t SceneNodeImpl::getNumLODs() const NOTHROWS
     {
-        return 1u;
+        return meshes.empty() ? 1u : meshes.size();
     }
     TAKErr SceneNodeImpl::loadMesh(std::shared_ptr<const Mesh> &value, const std::size_t lod, ProcessingCallback *callback) NOTHROWS
     {
-        if (lod != 0u)
+        if (lod >= getNumLODs())
             return TE_InvalidArg;
-        if (!mesh.get())
+        if (meshes.empty())
             return TE_IllegalState;
-        value = mesh;
+        value = meshes[lod];
         return TE_Ok;
     }
     TAKErr SceneNodeImpl::getLevelOfDetail(std::size_t *value, const std::size_t lodIdx) const NOTHROWS
     {
-        if (lodIdx != 0u)
+        if (lodIdx >= getNumLODs())
             return TE_InvalidArg;
-        *value = 0u;
+        // LODs are dense
+        *value = lodIdx;
         return TE_Ok;
     }
     TAKErr SceneNodeImpl::getLODIndex(std::size_t *value, const double clod, const int round) const NOTHROWS
     {
-        // only single LOD
-        *value = 0u;
+        double lod;
+        if (round > 0)
+            lod = ceil(clod);
+        else if (round < 0)
+            lod = floor(clod);
+        else
+            lod = floor(clod + 0.5);
+        const auto maxLod = static_cast<double>(getNumLODs() - 1u);
+        if (std::isnan(lod) || lod < 0.0)
+            lod = 0.0;
+        else if (lod > maxLod)
+            lod = maxLod;
+        *value = static_cast<std::size_t>(lod);
         return TE_Ok;
     }
     TAKErr SceneNodeImpl::getInstanceID(std::size_t *value, const std::size_t lodIdx) const NOTHROWS
     {
-        if (lodIdx != 0u)
+        if (lodIdx >= getNumLODs())
             return TE_InvalidArg;
         *value = instanceId;
         return TE_Ok;
@@ -27,6 +27,12 @@ namespace TAK {
                 Util::TAKErr addNode(SceneNode **value, const SceneNode &parent, const Math::Matrix2 *localFrame, const Feature::Envelope2 &aabb, const std::shared_ptr<const Mesh> &mesh) NOTHROWS;
 
                 Util::TAKErr addNode(SceneNode **value, const SceneNode &parent, const Math::Matrix2 *localFrame, const Feature::Envelope2 &aabb, const std::shared_ptr<const Mesh> &mesh, const std::size_t instanceId) NOTHROWS;
+                /**
+                 * Adds a node with multiple levels of detail. `lods[0]` is
+                 * the most detailed mesh; each successive mesh shall
+                 * approximately halve the detail of its predecessor.
+                 */
+                Util::TAKErr addNode(SceneNode **value, const SceneNode &parent, const Math::Matrix2 *localFrame, const Feature::Envelope2 &aabb, const std::shared_ptr<const Mesh> *lods, const std::size_t numLods) NOTHROWS;
 
                 Util::TAKErr build(SceneNodePtr &value) NOTHROWS;
             private :
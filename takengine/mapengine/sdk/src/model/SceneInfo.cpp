@@ -230,6 +230,18 @@ namespace {
         std::multimap<int, std::shared_ptr<SceneInfoSpi>> priority_sorted;
     };
 
+    class LazySceneInfoSpi : public SceneInfoSpi {
+    public:
+        LazySceneInfoSpi(const LazySpiDescriptor &descriptor, std::shared_ptr<SceneInfoSpi>(*factory)()) NOTHROWS;
+    public:
+        int getPriority() const NOTHROWS override;
+        const char *getName() const NOTHROWS override;
+        bool isSupported(const char *path) NOTHROWS override;
+        TAK::Engine::Util::TAKErr create(TAK::Engine::Port::Collection<SceneInfoPtr> &scenes, const char *path) NOTHROWS override;
+    private:
+        LazySpi<SceneInfoSpi> impl;
+    };
+
     CopyOnWrite<SceneInfoFactoryRegistry> &sharedSceneInfoSpiRegistry() {
         static CopyOnWrite<SceneInfoFactoryRegistry> impl;
         return impl;
@@ -255,6 +267,19 @@ ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneInfoFactory_regist
     return sharedSceneInfoSpiRegistry().invokeWrite(&SceneInfoFactoryRegistry::registerSpi, spiPtr);
 }
 
+ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneInfoFactory_registerSpi(const LazySpiDescriptor &descriptor, std::shared_ptr<SceneInfoSpi>(*factory)(), std::shared_ptr<SceneInfoSpi> *value) NOTHROWS {
+    if (!descriptor.name || !factory)
+        return TE_InvalidArg;
+    std::shared_ptr<SceneInfoSpi> spi(new(std::nothrow) LazySceneInfoSpi(descriptor, factory));
+    if (!spi)
+        return TE_OutOfMemory;
+    TAKErr code = SceneInfoFactory_registerSpi(spi);
+    TE_CHECKRETURN_CODE(code);
+    if (value)
+        *value = spi;
+    return code;
+}
+
 ENGINE_API TAK::Engine::Util::TAKErr TAK::Engine::Model::SceneInfoFactory_unregisterSpi(const std::shared_ptr<SceneInfoSpi> &spiPtr) NOTHROWS {
     return sharedSceneInfoSpiRegistry().invokeWrite(&SceneInfoFactoryRegistry::unregisterSpi, spiPtr);
 }
@@ -403,3 +428,31 @@ namespace {
         return TE_Unsupported;
     }
 }
+
+namespace {
+    LazySceneInfoSpi::LazySceneInfoSpi(const LazySpiDescriptor &descriptor, std::shared_ptr<SceneInfoSpi>(*factory)()) NOTHROWS :
+        impl(descriptor, factory)
+    {}
+    int LazySceneInfoSpi::getPriority() const NOTHROWS {
+        return impl.getPriority();
+    }
+    const char *LazySceneInfoSpi::getName() const NOTHROWS {
+        return impl.getName();
+    }
+    bool LazySceneInfoSpi::isSupported(const char *path) NOTHROWS {
+        if (!impl.matches(path))
+            return false;
+        std::shared_ptr<SceneInfoSpi> spi;
+        if (impl.get(spi) != TE_Ok)
+            return false;
+        return spi->isSupported(path);
+    }
+    TAK::Engine::Util::TAKErr LazySceneInfoSpi::create(TAK::Engine::Port::Collection<SceneInfoPtr> &scenes, const char *path) NOTHROWS {
+        if (!impl.matches(path))
+            return TE_Unsupported;
+        std::shared_ptr<SceneInfoSpi> spi;
+        TAKErr code = impl.get(spi);
+        TE_CHECKRETURN_CODE(code);
+        return spi->create(scenes, path);
+    }
+}
@@ -10,6 +10,7 @@
 #include "math/Matrix2.h"
 #include "model/ResourceMapper.h"
 #include "port/Collection.h"
+#include "util/LazySpi.h"
 
 namespace TAK {
     namespace Engine {
@@ -91,6 +92,15 @@ namespace TAK {
             };
 
             ENGINE_API TAK::Engine::Util::TAKErr SceneInfoFactory_registerSpi(const std::shared_ptr<SceneInfoSpi> &spiPtr) NOTHROWS;
+            /**
+             * Registers an SPI that is instantiated on the first query
+             * whose path matches the descriptor's extensions.
+             *
+             * @param value Returns the registered SPI, which may be
+             *              passed to `SceneInfoFactory_unregisterSpi`;
+             *              may be `nullptr`
+             */
+            ENGINE_API TAK::Engine::Util::TAKErr SceneInfoFactory_registerSpi(const Util::LazySpiDescriptor &descriptor, std::shared_ptr<SceneInfoSpi>(*factory)(), std::shared_ptr<SceneInfoSpi> *value = nullptr) NOTHROWS;
             ENGINE_API TAK::Engine::Util::TAKErr SceneInfoFactory_unregisterSpi(const std::shared_ptr<SceneInfoSpi> &spiPtr) NOTHROWS;
             ENGINE_API TAK::Engine::Util::TAKErr SceneInfoFactory_create(TAK::Engine::Port::Collection<SceneInfoPtr> &scenes, const char *path, const char *hint) NOTHROWS;
             ENGINE_API bool SceneInfoFactory_isSupported(const char *path, const char *hint) NOTHROWS;
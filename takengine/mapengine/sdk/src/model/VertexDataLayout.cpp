@@ -1,5 +1,9 @@
 #include "model/VertexDataLayout.h"
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 using namespace TAK::Engine::Model;
 
 using namespace TAK::Engine::Port;
@@ -15,7 +19,7 @@ namespace
             return 1u;
         case TEDT_Int16 :
         case TEDT_UInt16 :
-            return 1u;
+            return 2u;
         case TEDT_Int32 :
         case TEDT_UInt32 :
         case TEDT_Float32 :
@@ -26,6 +30,77 @@ namespace
 
         return 0u;
     }
+
+    std::size_t getNormalElements(const VertexDataLayout &layout) NOTHROWS
+    {
+        // octahedral encoded normals have two components
+        return (layout.normal.type == TEDT_UInt8) ? 2u : 3u;
+    }
+
+    void setStride(VertexDataLayout &value, const std::size_t stride) NOTHROWS
+    {
+        value.position.stride = stride;
+        value.normal.stride = stride;
+        value.color.stride = stride;
+        value.texCoord0.stride = stride;
+        value.texCoord1.stride = stride;
+        value.texCoord2.stride = stride;
+        value.texCoord3.stride = stride;
+        value.texCoord4.stride = stride;
+        value.texCoord5.stride = stride;
+        value.texCoord6.stride = stride;
+        value.texCoord7.stride = stride;
+    }
+
+    float readFloat(const uint8_t *src) NOTHROWS
+    {
+        float v;
+        memcpy(&v, src, sizeof(v));
+        return v;
+    }
+
+    /** normalizes each component of a float array to 16 bits over its range */
+    void quantizeArray(uint8_t *dst, const VertexArray &dstArray, const uint8_t *src, const VertexArray &srcArray, const std::size_t elems, const std::size_t numVertices, double *offset, double *scale) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < elems; i++) {
+            double mn = INFINITY;
+            double mx = -INFINITY;
+            for (std::size_t j = 0u; j < numVertices; j++) {
+                const double v = readFloat(src + srcArray.offset + (j*srcArray.stride) + (i*4u));
+                if (v < mn) mn = v;
+                if (v > mx) mx = v;
+            }
+            offset[i] = numVertices ? mn : 0.0;
+            scale[i] = numVertices ? (mx - mn) : 0.0;
+        }
+
+        for (std::size_t j = 0u; j < numVertices; j++) {
+            for (std::size_t i = 0u; i < elems; i++) {
+                const double v = readFloat(src + srcArray.offset + (j*srcArray.stride) + (i*4u));
+                const uint16_t q = scale[i] > 0.0 ? static_cast<uint16_t>(std::lround((v - offset[i]) / scale[i] * 65535.0)) : 0u;
+                memcpy(dst + dstArray.offset + (j*dstArray.stride) + (i*2u), &q, 2u);
+            }
+        }
+    }
+
+    void octEncode(uint8_t *dst, const float x, const float y, const float z) NOTHROWS
+    {
+        const float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+        float u = 0.f;
+        float v = 0.f;
+        if (l1 > 0.f) {
+            u = x / l1;
+            v = y / l1;
+            // fold the lower hemisphere over the diagonals
+            if (z < 0.f) {
+                const float ou = u;
+                u = (1.f - fabsf(v)) * (ou >= 0.f ? 1.f : -1.f);
+                v = (1.f - fabsf(ou)) * (v >= 0.f ? 1.f : -1.f);
+            }
+        }
+        dst[0] = static_cast<uint8_t>(std::lround((u*0.5f + 0.5f) * 255.f));
+        dst[1] = static_cast<uint8_t>(std::lround((v*0.5f + 0.5f) * 255.f));
+    }
 }
 
 TAKErr TAK::Engine::Model::VertexDataLayout_createDefaultInterleaved(VertexDataLayout *value, const unsigned int attrs) NOTHROWS
@@ -35,7 +110,7 @@ TAKErr TAK::Engine::Model::VertexDataLayout_createDefaultInterleaved(VertexDataL
     if(!attrs)
         return TE_InvalidArg;
 
-    memset(value, 0u, sizeof(*value));
+    *value = VertexDataLayout();
 
     std::size_t off = 0;
 #define DEFAULT_INTERLEAVE_PARAMS_SET_PARAMS(vao, teva, t, e) \
@@ -60,21 +135,101 @@ TAKErr TAK::Engine::Model::VertexDataLayout_createDefaultInterleaved(VertexDataL
  #undef DEFAULT_INTERLEAVE_PARAMS_SET_PARAMS
 
     value->attributes = attrs;
-    value->position.stride = off;
-    value->normal.stride = off;
-    value->color.stride = off;
-    value->texCoord0.stride = off;
-    value->texCoord1.stride = off;
-    value->texCoord2.stride = off;
-    value->texCoord3.stride = off;
-    value->texCoord4.stride = off;
-    value->texCoord5.stride = off;
-    value->texCoord6.stride = off;
-    value->texCoord7.stride = off;
+    setStride(*value, off);
+    value->interleaved = true;
+    return TE_Ok;
+}
+
+TAKErr TAK::Engine::Model::VertexDataLayout_createQuantizedInterleaved(VertexDataLayout *value, const unsigned int attrs) NOTHROWS
+{
+    if(!value)
+        return TE_InvalidArg;
+    if(!(attrs&TEVA_Position))
+        return TE_InvalidArg;
+
+    *value = VertexDataLayout();
+
+    std::size_t off = 0;
+#define QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(vao, teva, t, e) \
+    if(attrs&teva) { \
+        value->vao.type = t; \
+        value->vao.offset = off; \
+        off += (getDataTypeSize(t)*e + 3u) & ~static_cast<std::size_t>(3u); \
+    }
+
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(position, TEVA_Position, TEDT_UInt16, 3u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord0, TEVA_TexCoord0, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord1, TEVA_TexCoord1, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord2, TEVA_TexCoord2, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord3, TEVA_TexCoord3, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord4, TEVA_TexCoord4, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord5, TEVA_TexCoord5, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord6, TEVA_TexCoord6, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(texCoord7, TEVA_TexCoord7, TEDT_UInt16, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(normal, TEVA_Normal, TEDT_UInt8, 2u);
+    QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS(color, TEVA_Color, TEDT_UInt8, 4u);
+
+#undef QUANTIZED_INTERLEAVE_PARAMS_SET_PARAMS
+
+    value->attributes = attrs;
+    setStride(*value, off);
     value->interleaved = true;
     return TE_Ok;
 }
 
+bool TAK::Engine::Model::VertexDataLayout_isQuantized(const VertexDataLayout &layout) NOTHROWS
+{
+    return (layout.attributes&TEVA_Position) && layout.position.type == TEDT_UInt16;
+}
+
+TAKErr TAK::Engine::Model::VertexDataLayout_quantize(void *dst, VertexQuantization *quantization, const VertexDataLayout &dstLayout, const void *src, const VertexDataLayout &srcLayout, const std::size_t numVertices) NOTHROWS
+{
+    if(!dst || !quantization || !src)
+        return TE_InvalidArg;
+    if(!dstLayout.interleaved || !srcLayout.interleaved)
+        return TE_InvalidArg;
+    if(!VertexDataLayout_isQuantized(dstLayout))
+        return TE_InvalidArg;
+    if((srcLayout.attributes&dstLayout.attributes) != dstLayout.attributes)
+        return TE_InvalidArg;
+    if(srcLayout.position.type != TEDT_Float32)
+        return TE_InvalidArg;
+    if((dstLayout.attributes&TEVA_Normal) && srcLayout.normal.type != TEDT_Float32)
+        return TE_InvalidArg;
+    if((dstLayout.attributes&TEVA_Color) && srcLayout.color.type != dstLayout.color.type)
+        return TE_InvalidArg;
+
+    const auto *srcBytes = static_cast<const uint8_t *>(src);
+    auto *dstBytes = static_cast<uint8_t *>(dst);
+
+    memset(quantization, 0u, sizeof(*quantization));
+
+    quantizeArray(dstBytes, dstLayout.position, srcBytes, srcLayout.position, 3u, numVertices, quantization->positionOffset, quantization->positionScale);
+    for(int i = 0; i < 8; i++) {
+        if(!(dstLayout.attributes&(TEVA_TexCoord0<<i)))
+            continue;
+        VertexArray srcArray;
+        VertexArray dstArray;
+        VertexDataLayout_getTexCoordArray(&srcArray, srcLayout, i);
+        VertexDataLayout_getTexCoordArray(&dstArray, dstLayout, i);
+        if(srcArray.type != TEDT_Float32)
+            return TE_InvalidArg;
+        quantizeArray(dstBytes, dstArray, srcBytes, srcArray, 2u, numVertices, quantization->texCoordOffset[i], quantization->texCoordScale[i]);
+    }
+    if(dstLayout.attributes&TEVA_Normal) {
+        for(std::size_t j = 0u; j < numVertices; j++) {
+            const uint8_t *n = srcBytes + srcLayout.normal.offset + (j*srcLayout.normal.stride);
+            octEncode(dstBytes + dstLayout.normal.offset + (j*dstLayout.normal.stride), readFloat(n), readFloat(n+4u), readFloat(n+8u));
+        }
+    }
+    if(dstLayout.attributes&TEVA_Color) {
+        for(std::size_t j = 0u; j < numVertices; j++)
+            memcpy(dstBytes + dstLayout.color.offset + (j*dstLayout.color.stride), srcBytes + srcLayout.color.offset + (j*srcLayout.color.stride), getDataTypeSize(dstLayout.color.type)*4u);
+    }
+
+    return TE_Ok;
+}
+
 TAKErr TAK::Engine::Model::VertexDataLayout_requiredDataSize(std::size_t *value, const VertexDataLayout &layout, const VertexAttribute attr, const std::size_t numVertices) NOTHROWS
 {
     *value = 0u;
@@ -95,7 +250,7 @@ TAKErr TAK::Engine::Model::VertexDataLayout_requiredDataSize(std::size_t *value,
             TEVA_CASE(texCoord5, TEVA_TexCoord5, 2u);
             TEVA_CASE(texCoord6, TEVA_TexCoord6, 2u);
             TEVA_CASE(texCoord7, TEVA_TexCoord7, 2u);
-            TEVA_CASE(normal, TEVA_Normal, 3u);
+            TEVA_CASE(normal, TEVA_Normal, getNormalElements(layout));
             TEVA_CASE(color, TEVA_Color, 4u);
 #undef CHECK_SIZE
             default :
@@ -128,7 +283,7 @@ TAKErr TAK::Engine::Model::VertexDataLayout_requiredInterleavedDataSize(std::siz
         CHECK_SIZE(texCoord5, TEVA_TexCoord5, 2u);
         CHECK_SIZE(texCoord6, TEVA_TexCoord6, 2u);
         CHECK_SIZE(texCoord7, TEVA_TexCoord7, 2u);
-        CHECK_SIZE(normal, TEVA_Normal, 3u);
+        CHECK_SIZE(normal, TEVA_Normal, getNormalElements(layout));
         CHECK_SIZE(color, TEVA_Color, 4u);
 #undef CHECK_SIZE
     }
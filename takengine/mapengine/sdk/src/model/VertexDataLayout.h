@@ -23,6 +23,20 @@ namespace TAK {
                 TEVA_TexCoord7 =    0x400u,
             };
 
+            /**
+             * Describes the layout of the vertex attributes of a mesh.
+             *
+             * <P>Attributes are generally 32-bit floats, with the exception
+             * of colors. A layout may instead be quantized (see
+             * `VertexDataLayout_createQuantizedInterleaved`):
+             * <UL>
+             *   <LI>`TEDT_UInt16` positions and texture coordinates are
+             *       normalized to the bounds of the vertex data, per
+             *       `VertexQuantization`
+             *   <LI>`TEDT_UInt8` normals are octahedral encoded with two
+             *       components
+             * </UL>
+             */
             struct VertexDataLayout
             {
                 unsigned int attributes{ 0u };
@@ -42,10 +56,55 @@ namespace TAK {
                 bool interleaved;
             };
 
+            /**
+             * The parameters to dequantize vertex data. Each component is
+             * recovered as `offset + scale * q`, where `q` is the
+             * normalized quantized value in the range [0, 1].
+             */
+            struct VertexQuantization
+            {
+                double positionOffset[3u];
+                double positionScale[3u];
+                /** indexed by texture coordinate set */
+                double texCoordOffset[8u][2u];
+                double texCoordScale[8u][2u];
+            };
+
             typedef std::unique_ptr<VertexDataLayout, void(*)(const VertexDataLayout *)> VertexDataLayoutPtr;
             typedef std::unique_ptr<const VertexDataLayout, void(*)(const VertexDataLayout *)> VertexDataLayoutPtr_const;
 
             ENGINE_API Util::TAKErr VertexDataLayout_createDefaultInterleaved(VertexDataLayout *value, const unsigned int attrs) NOTHROWS;
+            /**
+             * Creates an interleaved layout with quantized positions,
+             * normals and texture coordinates. Each attribute is aligned
+             * on four bytes.
+             */
+            ENGINE_API Util::TAKErr VertexDataLayout_createQuantizedInterleaved(VertexDataLayout *value, const unsigned int attrs) NOTHROWS;
+            /**
+             * Returns `true` if the layout's positions are quantized.
+             */
+            ENGINE_API bool VertexDataLayout_isQuantized(const VertexDataLayout &layout) NOTHROWS;
+            /**
+             * Quantizes interleaved vertex data. Positions and texture
+             * coordinates are normalized to the bounds of the source data.
+             *
+             * @param dst           Receives the quantized data; must be at
+             *                      least the required interleaved data size
+             *                      for `dstLayout`
+             * @param quantization  Returns the dequantization parameters
+             * @param dstLayout     A layout created via
+             *                      `VertexDataLayout_createQuantizedInterleaved`
+             * @param src           The source vertex data
+             * @param srcLayout     The source layout; must be interleaved
+             *                      with 32-bit float attributes and
+             *                      contain all of the attributes of
+             *                      `dstLayout`
+             * @param numVertices   The number of vertices
+             *
+             * @return  TE_Ok on success; TE_InvalidArg if the layouts are
+             *          not compatible
+             */
+            ENGINE_API Util::TAKErr VertexDataLayout_quantize(void *dst, VertexQuantization *quantization, const VertexDataLayout &dstLayout, const void *src, const VertexDataLayout &srcLayout, const std::size_t numVertices) NOTHROWS;
             ENGINE_API Util::TAKErr VertexDataLayout_requiredDataSize(std::size_t *value, const VertexDataLayout &layout, const VertexAttribute attr, const std::size_t numVertices) NOTHROWS;
             ENGINE_API Util::TAKErr VertexDataLayout_requiredInterleavedDataSize(std::size_t *value, const VertexDataLayout &layout, const std::size_t numVertices) NOTHROWS;
 
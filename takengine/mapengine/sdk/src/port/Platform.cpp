@@ -15,6 +15,7 @@
 #endif
 
 #include <cstring>
+#include <thread>
 
 using namespace TAK::Engine::Port;
 
@@ -208,4 +209,9 @@ char TAK::Engine::Port::Platform_pathSep() NOTHROWS {
 #else
     return '/';
 #endif
-}
\ No newline at end of file
+}
+std::size_t TAK::Engine::Port::Platform_processorCount() NOTHROWS
+{
+    static const std::size_t count = std::thread::hardware_concurrency();
+    return count ? count : 1u;
+}
@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_PORT_PLATFORM_H_INCLUDED
 #define TAK_ENGINE_PORT_PLATFORM_H_INCLUDED
 
+#include <cstddef>
 #include <cstdint>
 
 #if __cplusplus >= 201103L || _MSC_VER >= 1900
@@ -61,6 +62,12 @@ namespace TAK {
             ENGINE_API int64_t Platform_systime_millis() NOTHROWS;
 
             ENGINE_API char Platform_pathSep() NOTHROWS;
+
+            /**
+             * Returns the number of hardware threads (logical processors)
+             * available to the process. Always returns at least `1`.
+             */
+            ENGINE_API std::size_t Platform_processorCount() NOTHROWS;
         }
     }
 }
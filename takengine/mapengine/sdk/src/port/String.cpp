@@ -7,33 +7,85 @@
 #include <cstring>
 #include <memory>
 #include <sstream>
+#include <unordered_map>
+#include <utility>
 
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
 #include "util/Memory.h"
 
 using namespace TAK::Engine::Port;
 
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 namespace
 {
+    /** prefixes the content of an interned string */
+    const std::size_t InternHeaderSize = sizeof(std::size_t);
+
+    struct InternTable
+    {
+        Mutex mutex;
+        /** content hash to interned content */
+        std::unordered_multimap<std::size_t, const char *> entries;
+    };
+
+    InternTable &internTable() NOTHROWS
+    {
+        // intentionally leaked; interned content is never released
+        static InternTable *t = new InternTable();
+        return *t;
+    }
+
+    std::size_t hashString(const char *str) NOTHROWS
+    {
+        // FNV-1a
+        uint64_t h = 14695981039346656037ull;
+        while (*str) {
+            h ^= (uint8_t)*str++;
+            h *= 1099511628211ull;
+        }
+        return (std::size_t)h;
+    }
+
     char *dupString(const char *str);
 }
 
 String::String() NOTHROWS :
-    data(nullptr)
+    data(nullptr),
+    interned(false)
 { }
 
 String::String(const char* s) NOTHROWS :
-    data(dupString(s))
-{ }
+    data(nullptr),
+    interned(false)
+{
+    assign(s);
+}
 
 String::String(const String& rhs) NOTHROWS :
-    data(dupString(rhs.data))
-{ }
+    data(nullptr),
+    interned(false)
+{
+    if (rhs.interned) {
+        data = rhs.data;
+        interned = true;
+    } else {
+        assign(rhs.data);
+    }
+}
+
+String::String(String&& rhs) NOTHROWS :
+    data(nullptr),
+    interned(false)
+{
+    *this = std::move(rhs);
+}
 
 String::~String() NOTHROWS
 {
-    delete[] data;
+    release();
 }
 
 
@@ -41,9 +93,8 @@ String& String::operator= (const String& rhs) NOTHROWS
 {
     if (data != rhs.data)
     {
-        // Delete the old, copy the new.
-        delete[] data;
-        data = dupString(rhs.data);
+        String copy(rhs);
+        *this = std::move(copy);
     }
 
     return *this;
@@ -53,19 +104,43 @@ String& String::operator= (const char* rhs) NOTHROWS
 {
     if (data != rhs)
     {
-        // Delete the old, copy the new.
-        delete[] data;
-        data = dupString(rhs);
+        // copy first; `rhs` may reference this String's content
+        String copy(rhs);
+        *this = std::move(copy);
     }
 
     return *this;
 }
 
+String& String::operator= (String&& rhs) NOTHROWS
+{
+    if (this == &rhs)
+        return *this;
+
+    release();
+    interned = rhs.interned;
+    if (rhs.data == rhs.storage) {
+        memcpy(storage, rhs.storage, sizeof(storage));
+        data = storage;
+    } else {
+        data = rhs.data;
+    }
+    rhs.data = nullptr;
+    rhs.interned = false;
+    return *this;
+}
+
 bool String::operator== (const String& rhs) const NOTHROWS
 {
-    return data
-        ? rhs.data && !std::strcmp(data, rhs.data)
-        : !rhs.data;
+    if (data == rhs.data)
+        return true;
+    else if (!data || !rhs.data)
+        return false;
+    else if (interned && rhs.interned)
+        // interned content is unique
+        return false;
+    else
+        return !std::strcmp(data, rhs.data);
 }
 
 bool String::operator!= (const String& rhs) const NOTHROWS
@@ -92,6 +167,7 @@ String::operator const char* () const NOTHROWS
 
 char& String::operator[] (int index) NOTHROWS
 {
+    detach();
     return data[index];
 }
 
@@ -102,6 +178,7 @@ char String::operator[] (int index) const NOTHROWS
 
 char* String::get() NOTHROWS
 {
+    detach();
     return data;
 }
 
@@ -110,6 +187,98 @@ const char *String::get() const NOTHROWS
     return data;
 }
 
+bool String::isInterned() const NOTHROWS
+{
+    return interned;
+}
+
+void String::assign(const char *str) NOTHROWS
+{
+    if (!str) {
+        data = nullptr;
+        return;
+    }
+    const std::size_t len = strlen(str);
+    if (len <= InlineCapacity) {
+        memcpy(storage, str, len + 1u);
+        data = storage;
+    } else {
+        data = dupString(str);
+    }
+}
+
+void String::release() NOTHROWS
+{
+    if (data != storage && !interned)
+        delete[] data;
+    data = nullptr;
+    interned = false;
+}
+
+void String::detach() NOTHROWS
+{
+    if (!interned)
+        return;
+    const char *shared = data;
+    interned = false;
+    assign(shared);
+}
+
+String TAK::Engine::Port::String_intern(const char *str) NOTHROWS
+{
+    String retval;
+    if (!str)
+        return retval;
+
+    const std::size_t hash = hashString(str);
+    InternTable &t = internTable();
+    Lock lock(t.mutex);
+    if (lock.status != TE_Ok) {
+        // fall back on a private copy
+        retval = str;
+        return retval;
+    }
+    auto range = t.entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++) {
+        if (!strcmp(it->second, str)) {
+            retval.data = const_cast<char *>(it->second);
+            retval.interned = true;
+            return retval;
+        }
+    }
+
+    const std::size_t len = strlen(str);
+    std::unique_ptr<char[]> block(new(std::nothrow) char[InternHeaderSize + len + 1u]);
+    if (!block) {
+        retval = str;
+        return retval;
+    }
+    memcpy(block.get(), &hash, InternHeaderSize);
+    memcpy(block.get() + InternHeaderSize, str, len + 1u);
+    try {
+        t.entries.insert(std::make_pair(hash, block.get() + InternHeaderSize));
+    } catch (...) {
+        retval = str;
+        return retval;
+    }
+    retval.data = block.release() + InternHeaderSize;
+    retval.interned = true;
+    return retval;
+}
+
+std::size_t StringHash::operator()(const String &str) const NOTHROWS
+{
+    const char *cstr = str.get();
+    if (!cstr)
+        return 0u;
+    if (str.isInterned()) {
+        std::size_t hash;
+        memcpy(&hash, cstr - InternHeaderSize, InternHeaderSize);
+        return hash;
+    }
+    return hashString(cstr);
+}
+
 TAKErr TAK::Engine::Port::String_parseDouble(double *value, const char *str) NOTHROWS
 {
     char *end;
@@ -1,18 +1,45 @@
 #ifndef TAK_ENGINE_PORT_STRING_H_INCLUDED
 #define TAK_ENGINE_PORT_STRING_H_INCLUDED
 
+#include <cstddef>
+
 #include "port/Platform.h"
 #include "util/Error.h"
 
 namespace TAK {
     namespace Engine {
         namespace Port {
+            class ENGINE_API String;
+
+            /**
+             * Returns a `String` referencing the canonical copy of the
+             * supplied C string in the process-wide intern table. All
+             * interned instances with the same content share storage;
+             * equality between interned instances is a pointer comparison
+             * and hashing does not inspect the content. Interned content is
+             * never released.
+             */
+            ENGINE_API String String_intern(const char *str) NOTHROWS;
+
+            /**
+             * Strings of up to `String::InlineCapacity` characters are
+             * stored within the instance; longer strings are allocated on
+             * the heap. Copies of interned strings share the interned
+             * storage until modified through `get()` or `operator[]`.
+             */
             class ENGINE_API String
             {
+            public :
+                enum
+                {
+                    /** The maximum length of a string stored inline */
+                    InlineCapacity = 22,
+                };
             public: // constructors
                 String() NOTHROWS;
                 String(const char*) NOTHROWS;          // Copies supplied C string.
                 String(const String&) NOTHROWS;        // Copies supplied String.
+                String(String&&) NOTHROWS;             // Takes ownership of supplied String's content.
             public: // destructors
                 ~String() NOTHROWS;
             public: // operator overload
@@ -20,6 +47,7 @@ namespace TAK {
                 String& operator= (const String&)NOTHROWS;
                 // Deletes old, copies C string.
                 String& operator= (const char*)NOTHROWS;
+                String& operator= (String&&)NOTHROWS;
                 // Uses string comparison.  NULL Strings compare equal.
                 bool operator== (const String&) const NOTHROWS;
                 // Inverse of operator==.
@@ -35,8 +63,19 @@ namespace TAK {
                 // Returns a non-const pointer to the wrapped C string.  The String still manages the memory.
                 char* get() NOTHROWS;
                 const char *get() const NOTHROWS;
+                // Returns true if the String references interned content.
+                bool isInterned() const NOTHROWS;
+            private:
+                void assign(const char *str) NOTHROWS;
+                void release() NOTHROWS;
+                // Replaces shared interned content with a private copy.
+                void detach() NOTHROWS;
             private:
                 char* data;
+                char storage[InlineCapacity + 1];
+                bool interned;
+
+                friend String String_intern(const char *str) NOTHROWS;
             };
 
             ENGINE_API Util::TAKErr String_parseDouble(double *value, const char *str) NOTHROWS;
@@ -64,6 +103,16 @@ namespace TAK {
                 }
             };
 
+            /**
+             * Content hash for `String`, suitable for unordered containers.
+             * Interned strings hash in constant time; other strings hash
+             * to the same value as their interned equivalent.
+             */
+            struct ENGINE_API StringHash
+            {
+                std::size_t operator()(const String &str) const NOTHROWS;
+            };
+
             struct ENGINE_API StringEqual
             {
                 StringEqual(const char *cstr) NOTHROWS :
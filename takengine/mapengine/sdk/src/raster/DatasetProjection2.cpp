@@ -1,5 +1,7 @@
 #include "raster/DatasetProjection2.h"
 
+#include <vector>
+
 #include "core/Projection2.h"
 #include "core/ProjectionFactory3.h"
 #include "util/Memory.h"
@@ -19,6 +21,8 @@ namespace
     public :
         TAKErr imageToGround(GeoPoint2 *ground, const Point2<double> &image) const NOTHROWS override;
 		TAKErr groundToImage(Point2<double> *image, const GeoPoint2 &ground) const NOTHROWS override;
+        TAKErr imageToGround(GeoPoint2 *ground, const Point2<double> *image, const std::size_t count) const NOTHROWS override;
+        TAKErr groundToImage(Point2<double> *image, const GeoPoint2 *ground, const std::size_t count) const NOTHROWS override;
     private :
         Matrix2 img2proj_;
         Matrix2 proj2img_;
@@ -31,6 +35,8 @@ namespace
     public :
         TAKErr imageToGround(GeoPoint2 *ground, const Point2<double> &image) const NOTHROWS override;
 		TAKErr groundToImage(Point2<double> *image, const GeoPoint2 &ground) const NOTHROWS override;
+        TAKErr imageToGround(GeoPoint2 *ground, const Point2<double> *image, const std::size_t count) const NOTHROWS override;
+        TAKErr groundToImage(Point2<double> *image, const GeoPoint2 *ground, const std::size_t count) const NOTHROWS override;
     private :
         Projection2Ptr proj_;
         CartesianProjectiveTransformProjection2 impl_;
@@ -44,6 +50,27 @@ DatasetProjection2::DatasetProjection2() NOTHROWS
 DatasetProjection2::~DatasetProjection2() NOTHROWS
 { }
 
+TAKErr DatasetProjection2::imageToGround(GeoPoint2 *ground, const Point2<double> *image, const std::size_t count) const NOTHROWS
+{
+    if (!ground || (count && !image))
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < count; i++) {
+        if (imageToGround(ground + i, image[i]) != TE_Ok)
+            ground[i] = GeoPoint2(NAN, NAN);
+    }
+    return TE_Ok;
+}
+TAKErr DatasetProjection2::groundToImage(Point2<double> *image, const GeoPoint2 *ground, const std::size_t count) const NOTHROWS
+{
+    if (!image || (count && !ground))
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < count; i++) {
+        if (groundToImage(image + i, ground[i]) != TE_Ok)
+            image[i] = Point2<double>(NAN, NAN);
+    }
+    return TE_Ok;
+}
+
 TAKErr TAK::Engine::Raster::DatasetProjection2_create(DatasetProjection2Ptr &value, const int srid, const Math::Matrix2 &img2proj) NOTHROWS
 {
     TAKErr code(TE_Ok);
@@ -157,6 +184,34 @@ namespace
             gp.z = ground.altitude;
         return proj2img_.transform(image, gp);
     }
+    TAKErr CartesianProjectiveTransformProjection2::imageToGround(GeoPoint2 *ground, const Point2<double> *image, const std::size_t count) const NOTHROWS
+    {
+        if (!ground || (count && !image))
+            return TE_InvalidArg;
+        for (std::size_t i = 0u; i < count; i++) {
+            Point2<double> proj;
+            if (img2proj_.transform(&proj, image[i]) != TE_Ok) {
+                ground[i] = GeoPoint2(NAN, NAN);
+                continue;
+            }
+            ground[i].latitude = proj.y;
+            ground[i].longitude = proj.x;
+            ground[i].altitude = proj.z;
+            ground[i].altitudeRef = AltitudeReference::HAE;
+        }
+        return TE_Ok;
+    }
+    TAKErr CartesianProjectiveTransformProjection2::groundToImage(Point2<double> *image, const GeoPoint2 *ground, const std::size_t count) const NOTHROWS
+    {
+        if (!image || (count && !ground))
+            return TE_InvalidArg;
+        for (std::size_t i = 0u; i < count; i++) {
+            const Point2<double> gp(ground[i].longitude, ground[i].latitude, isnan(ground[i].altitude) ? 0.0 : ground[i].altitude);
+            if (proj2img_.transform(image + i, gp) != TE_Ok)
+                image[i] = Point2<double>(NAN, NAN);
+        }
+        return TE_Ok;
+    }
 
     GeoProjectiveTransformProjection2::GeoProjectiveTransformProjection2(Projection2Ptr &&proj_, const Matrix2 &img2proj_, const Matrix2 &proj2img_) NOTHROWS :
         proj_(std::move(proj_)),
@@ -184,4 +239,43 @@ namespace
         TE_CHECKRETURN_CODE(code);
         return impl_.groundToImage(image, GeoPoint2(proj.y, proj.x, proj.z, AltitudeReference::HAE));
     }
+    TAKErr GeoProjectiveTransformProjection2::imageToGround(GeoPoint2 *ground, const Point2<double> *image, const std::size_t count) const NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        // convert to map projection CS
+        code = impl_.imageToGround(ground, image, count);
+        TE_CHECKRETURN_CODE(code);
+        std::vector<Point2<double>> proj(count);
+        for (std::size_t i = 0u; i < count; i++)
+            proj[i] = Point2<double>(ground[i].longitude, ground[i].latitude, ground[i].altitude);
+        // convert to WGS84; on failure, fall back on per point conversion
+        // so that only the offending points are invalidated
+        if (proj_->inverse(ground, proj.data(), count) == TE_Ok)
+            return TE_Ok;
+        for (std::size_t i = 0u; i < count; i++) {
+            if (proj_->inverse(ground + i, proj[i]) != TE_Ok)
+                ground[i] = GeoPoint2(NAN, NAN);
+        }
+        return TE_Ok;
+    }
+    TAKErr GeoProjectiveTransformProjection2::groundToImage(Point2<double> *image, const GeoPoint2 *ground, const std::size_t count) const NOTHROWS
+    {
+        if (!image || (count && !ground))
+            return TE_InvalidArg;
+        // convert to map projection CS
+        std::vector<GeoPoint2> proj(count);
+        if (this->proj_->forward(image, ground, count) == TE_Ok) {
+            for (std::size_t i = 0u; i < count; i++)
+                proj[i] = GeoPoint2(image[i].y, image[i].x, image[i].z, AltitudeReference::HAE);
+        } else {
+            for (std::size_t i = 0u; i < count; i++) {
+                Point2<double> xyz;
+                if (this->proj_->forward(&xyz, ground[i]) == TE_Ok)
+                    proj[i] = GeoPoint2(xyz.y, xyz.x, xyz.z, AltitudeReference::HAE);
+                else
+                    proj[i] = GeoPoint2(NAN, NAN);
+            }
+        }
+        return impl_.groundToImage(image, proj.data(), count);
+    }
 }
@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_RASTER_DATASETPROJECTION2_H_INCLUDED
 #define TAK_ENGINE_RASTER_DATASETPROJECTION2_H_INCLUDED
 
+#include <cstddef>
 #include <memory>
 
 #include "util/Error.h"
@@ -44,6 +45,33 @@ namespace TAK {
 				 *          is updated and returned.
 				 */
 				virtual Util::TAKErr groundToImage(Math::Point2<double> *image, const Core::GeoPoint2 &ground) const NOTHROWS = 0;
+
+				/**
+				 * Performs the image-to-ground function for a batch of pixels.
+				 * Pixels that cannot be converted are returned with
+				 * <code>NaN</code> latitude and longitude.
+				 *
+				 * <P>The default implementation invokes the single point
+				 * function for each pixel; implementations whose
+				 * image-to-ground function is iterative should override to
+				 * solve all pixels together.
+				 *
+				 * @param ground    Returns the geodetic coordinates
+				 * @param image     The image pixels
+				 * @param count     The number of pixels
+				 */
+				virtual Util::TAKErr imageToGround(Core::GeoPoint2 *ground, const Math::Point2<double> *image, const std::size_t count) const NOTHROWS;
+
+				/**
+				 * Performs the ground-to-image function for a batch of
+				 * geodetic coordinates. Coordinates that cannot be converted
+				 * are returned with <code>NaN</code> x and y.
+				 *
+				 * @param image     Returns the pixel coordinates
+				 * @param ground    The geodetic coordinates
+				 * @param count     The number of coordinates
+				 */
+				virtual Util::TAKErr groundToImage(Math::Point2<double> *image, const Core::GeoPoint2 *ground, const std::size_t count) const NOTHROWS;
 			};
 
 			typedef std::unique_ptr<DatasetProjection2, void(*)(const DatasetProjection2 *)> DatasetProjection2Ptr;
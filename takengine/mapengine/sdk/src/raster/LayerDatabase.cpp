@@ -626,6 +626,31 @@ LayerDatabase::addLayers (const char* filePath,
   }
 
 
+void
+LayerDatabase::addLayers (const FileLayersVector& files)
+  {
+    Lock lock(getMutex());
+    db::Database::Transaction transaction (getDatabase ());
+
+    auto end (files.end ());
+
+    for (auto iter (files.begin ()); iter != end; ++iter)
+      {
+        if (!iter->currency)
+          {
+            throw std::invalid_argument (MEM_FN ("addLayers")
+                                         "Received NULL currency");
+          }
+        addLayers (iter->filePath,
+                   iter->descriptors,
+                   iter->workingDir,
+                   *iter->currency);
+      }
+
+    getDatabase ().setTransactionSuccessful ();
+  }
+
+
 LayerDatabase*
 LayerDatabase::createDatabase (const char* filePath)
   {
@@ -107,6 +107,20 @@ class LayerDatabase
     class Cursor;
     typedef std::vector<DatasetDescriptor*>     DescriptorVector;
 
+    //
+    // The layers derived from a single file, for use with the batched form of
+    // addLayers.
+    //
+    struct FileLayers
+      {
+        const char* filePath;
+        DescriptorVector descriptors;
+        const char* workingDir;
+        Currency* currency;
+      };
+
+    typedef std::vector<FileLayers>             FileLayersVector;
+
 
     //==================================
     //  PUBLIC INTERFACE
@@ -142,6 +156,19 @@ class LayerDatabase
                const char* workingDir,
                Currency&);
 
+    //
+    // Adds the layers for each of the supplied files within a single
+    // transaction.  If the layers for any file cannot be added, the
+    // transaction is rolled back and the exception is propagated; no layers
+    // are added.
+    //
+    // Throws std::invalid_argument if any filePath is NULL.
+    // Throws std::runtime_error if a layer for any filePath is already in the
+    // database.
+    //
+    void
+    addLayers (const FileLayersVector& files);
+
     static
     LayerDatabase*
     createDatabase (const char* filePath);
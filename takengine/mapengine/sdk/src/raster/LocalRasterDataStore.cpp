@@ -28,10 +28,21 @@
 
 #include "raster/LocalRasterDataStore.h"
 
+#include <algorithm>
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
 #include "port/String.h"
 #include "thread/Lock.h"
+#include "thread/Monitor.h"
+#include "util/ConfigOptions.h"
 #include "util/IO.h"
+#include "util/IO2.h"
+#include "util/Logging.h"
 #include "util/Memory.h"
+#include "util/WorkerRegistry.h"
 
 
 #define MEM_FN( fn )    "atakmap::raster::LocalRasterDataStore::" fn ": "
@@ -45,6 +56,7 @@
 
 
 using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
 
 ////========================================================================////
 ////                                                                        ////
@@ -58,6 +70,126 @@ using namespace TAK::Engine::Thread;
 ////                                                                        ////
 ////========================================================================////
 
+
+namespace
+{
+
+
+typedef atakmap::raster::DatasetDescriptor::DescriptorSet   DescriptorSet;
+
+
+///=============================================================================
+///
+///  struct IngestResult
+///
+///     The layers derived from a file by an ingest worker.  Unless committed,
+///     the layer working directory is removed on destruction.
+///
+///=============================================================================
+
+
+struct IngestResult
+  {
+    IngestResult ()
+      : committed (false)
+      { }
+
+    ~IngestResult ()
+      {
+        if (layers.get ())
+          {
+            for (auto it = layers->begin (); it != layers->end (); ++it)
+              {
+                delete *it;
+              }
+          }
+        if (!committed && !layerDir.empty ())
+          {
+            atakmap::util::removeDir (layerDir.c_str ());
+          }
+      }
+
+    std::string filePath;
+    std::string layerDir;
+    std::unique_ptr<DescriptorSet> layers;
+    bool committed;
+  };
+
+
+///=============================================================================
+///
+///  struct IngestContext
+///
+///     State shared between the ingest work items and the writer.  All mutable
+///     members are guarded by the monitor.
+///
+///=============================================================================
+
+
+struct IngestContext
+  {
+    IngestContext (const char* workingDir_,
+                   const char* typeHint_,
+                   std::size_t maxPending_)
+      : workingDir (workingDir_),
+        typeHint (typeHint_),
+        maxPending (maxPending_),
+        scheduled (0),
+        processed (0),
+        active (0),
+        canceled (false)
+      { }
+
+    Monitor monitor;
+    const char* workingDir;
+    const char* typeHint;
+    std::size_t maxPending;             // Bound on files scheduled but not
+                                        // yet taken by the writer.
+    std::vector<std::string> files;
+    std::size_t scheduled;              // Number of files scheduled.
+    std::size_t processed;              // Number of files opened.
+    std::size_t active;                 // Number of work items not yet run.
+    std::deque<std::unique_ptr<IngestResult>> results;
+    bool canceled;
+  };
+
+
+///=============================================================================
+///
+///  class IngestWork
+///
+///     Derives the layers for a single file on a borrowed IO worker.
+///
+///=============================================================================
+
+
+class IngestWork
+  : public Work
+  {
+  public :
+
+    IngestWork (IngestContext& context_,
+                std::size_t idx_)
+      : context (context_),
+        idx (idx_)
+      { }
+
+  protected :
+
+    TAKErr
+    onSignalWork (MonitorLockPtr& lockPtr)
+        NOTHROWS override;
+
+  private :
+
+    IngestContext& context;
+    std::size_t idx;
+  };
+
+
+}                                       // Close unnamed namespace.
+
+
 ////========================================================================////
 ////                                                                        ////
 ////    EXTERN VARIABLE DEFINITIONS                                         ////
@@ -76,6 +208,144 @@ using namespace TAK::Engine::Thread;
 ////                                                                        ////
 ////========================================================================////
 
+
+namespace
+{
+
+
+TAKErr
+collectFile (void* opaque,
+             const char* filePath)
+  {
+    static_cast<std::vector<std::string>*> (opaque)->push_back (filePath);
+    return TE_Ok;
+  }
+
+
+void
+deriveLayers (IngestResult& result,
+              const IngestContext& context)
+  {
+    TAK::Engine::Util::array_ptr<const char> layerDir
+        (atakmap::util::createTempDir (context.workingDir, "layer", "priv"));
+
+    if (!layerDir.get ())
+      {
+        return;
+      }
+    result.layerDir = layerDir.get ();
+
+    try
+      {
+        result.layers.reset
+            (atakmap::raster::DatasetDescriptor::create (result.filePath.c_str (),
+                                                         layerDir.get (),
+                                                         context.typeHint,
+                                                         nullptr));
+      }
+    catch (const std::exception& exc)
+      {
+        atakmap::util::Logger::log (atakmap::util::Logger::Warning,
+                                    MEM_FN ("addDirectory")
+                                    "Failed to open %s: %s",
+                                    result.filePath.c_str (),
+                                    exc.what ());
+      }
+    catch (...)
+      {
+        atakmap::util::Logger::log (atakmap::util::Logger::Warning,
+                                    MEM_FN ("addDirectory")
+                                    "Failed to open %s",
+                                    result.filePath.c_str ());
+      }
+  }
+
+
+TAKErr
+IngestWork::onSignalWork (MonitorLockPtr& lockPtr)
+    NOTHROWS
+  {
+    lockPtr.reset ();
+
+    std::unique_ptr<IngestResult> result;
+
+      {
+        Monitor::Lock lock (context.monitor);
+
+        if (!context.canceled)
+          {
+            result.reset (new IngestResult ());
+            result->filePath = context.files[idx];
+          }
+      }
+
+    if (result.get ())
+      {
+        deriveLayers (*result, context);
+      }
+
+    Monitor::Lock lock (context.monitor);
+
+    context.processed++;
+    if (result.get () && result->layers.get () && !context.canceled)
+      {
+        context.results.push_back (std::move (result));
+      }
+    context.active--;
+    lock.broadcast ();
+
+    return TE_Ok;
+  }
+
+
+//
+// Schedules ingest of the next files, keeping at most maxPending files
+// scheduled but not yet taken by the writer.  The lock must be held.
+//
+TAKErr
+scheduleIngest (IngestContext& context,
+                Worker& worker)
+  {
+    while (!context.canceled
+           && context.scheduled < context.files.size ()
+           && (context.scheduled - context.processed + context.results.size ())
+                < context.maxPending)
+      {
+        context.active++;
+
+        TAKErr code (worker.scheduleWork
+                         (std::make_shared<IngestWork> (context,
+                                                        context.scheduled)));
+
+        if (code != TE_Ok)
+          {
+            context.active--;
+            return code;
+          }
+        context.scheduled++;
+      }
+
+    return TE_Ok;
+  }
+
+
+void
+reportProgress (ProcessingCallback* callback,
+                std::size_t current,
+                std::size_t max)
+  {
+    if (callback && callback->progress)
+      {
+        callback->progress (callback->opaque,
+                            static_cast<int> (current),
+                            static_cast<int> (max));
+      }
+  }
+
+
+}                                       // Close unnamed namespace.
+
+
 ////========================================================================////
 ////                                                                        ////
 ////    EXTERN FUNCTION DEFINITIONS                                         ////
@@ -122,6 +392,176 @@ LocalRasterDataStore::addFile2 (const char* filePath,
   }
 
 
+std::size_t
+LocalRasterDataStore::addDirectory (const char* dirPath,
+                                    const char* typeHint,
+                                    ProcessingCallback* callback)
+  {
+    if (!dirPath)
+      {
+        throw std::invalid_argument (MEM_FN ("addDirectory")
+                                     "Received NULL dirPath");
+      }
+    if (!isMutable ())
+      {
+        return 0;
+      }
+
+    const int threadOpt
+        (ConfigOptions_getIntOptionOrDefault ("localrasterdatastore.ingest-threads",
+                                              static_cast<int> (TAK::Engine::Port::Platform_processorCount ())));
+    const std::size_t threadCount (static_cast<std::size_t> (std::max (threadOpt, 1)));
+    IngestContext context (getWorkingDir (), typeHint, 2 * threadCount);
+
+    //
+    // Scan the directory tree, skipping any files already in the data store.
+    //
+
+    std::vector<std::string> scanned;
+
+    if (IO_visitFiles (collectFile, &scanned, dirPath, TELFM_RecursiveFiles)
+        != TE_Ok)
+      {
+        return 0;
+      }
+
+      {
+        Lock lock(getMutex());
+
+        for (auto it = scanned.begin (); it != scanned.end (); ++it)
+          {
+            if (!containsFileImpl (it->c_str ()))
+              {
+                context.files.push_back (*it);
+              }
+          }
+      }
+
+    const std::size_t total (context.files.size ());
+
+    if (!total || ProcessingCallback_isCanceled (callback))
+      {
+        return 0;
+      }
+    reportProgress (callback, 0, total);
+
+    SharedWorkerPtr worker;
+
+    if (WorkerRegistry_borrow (worker, TEWC_IO, "localrasterdatastore-ingest",
+                               std::min (threadCount, total))
+        != TE_Ok)
+      {
+        throw std::runtime_error (MEM_FN ("addDirectory")
+                                  "Failed to borrow ingest workers");
+      }
+
+    //
+    // Waits for the scheduled work on exit, including exceptional exit.  Work
+    // that has not yet started returns without opening its file.  Any layers
+    // derived but not added are discarded with the context.
+    //
+    class WorkJoiner
+    {
+    public :
+        WorkJoiner(IngestContext &c_) : c(c_) {}
+        ~WorkJoiner()
+        {
+            Monitor::Lock lock(c.monitor);
+            c.canceled = true;
+            lock.broadcast();
+            while (c.active)
+                lock.wait();
+        }
+    private :
+        IngestContext &c;
+    };
+    WorkJoiner joiner (context);
+
+    std::size_t added (0);
+
+    while (true)
+      {
+        std::vector<std::unique_ptr<IngestResult>> batch;
+        std::size_t processed (0);
+
+          {
+            Monitor::Lock lock (context.monitor);
+
+            if (scheduleIngest (context, *worker) != TE_Ok)
+              {
+                throw std::runtime_error (MEM_FN ("addDirectory")
+                                          "Failed to schedule ingest");
+              }
+            while (context.results.empty () && context.processed < total
+                   && !ProcessingCallback_isCanceled (callback))
+              {
+                lock.wait (100LL);
+              }
+            if (ProcessingCallback_isCanceled (callback))
+              {
+                break;
+              }
+            while (!context.results.empty ())
+              {
+                batch.push_back (std::move (context.results.front ()));
+                context.results.pop_front ();
+              }
+            processed = context.processed;
+            lock.broadcast ();
+          }
+
+        if (!batch.empty ())
+          {
+            std::vector<FileLayers> files;
+            std::vector<IngestResult*> sources;
+
+            Lock lock(getMutex());
+
+            for (auto it = batch.begin (); it != batch.end (); ++it)
+              {
+                IngestResult& result (**it);
+
+                if (containsFileImpl (result.filePath.c_str ()))
+                  {
+                    continue;
+                  }
+
+                FileLayers file;
+
+                file.filePath = result.filePath.c_str ();
+                file.layers = result.layers.get ();
+                file.workingDir = result.layerDir.c_str ();
+                file.added = false;
+                files.push_back (file);
+                sources.push_back (&result);
+              }
+            addFilesImpl (files);
+            for (std::size_t i (0); i < files.size (); ++i)
+              {
+                if (files[i].added)
+                  {
+                    sources[i]->committed = true;
+                    ++added;
+                  }
+              }
+          }
+
+        reportProgress (callback, processed, total);
+        if (batch.empty () && processed == total)
+          {
+            break;
+          }
+      }
+
+    if (added)
+      {
+        notifyContentListeners ();
+      }
+
+    return added;
+  }
+
+
 void
 LocalRasterDataStore::beginBatch ()
   {
@@ -291,6 +731,27 @@ namespace raster                        // Open raster namespace.
 {
 
 
+void
+LocalRasterDataStore::addFilesImpl (std::vector<FileLayers>& files)
+  {
+    for (auto it = files.begin (); it != files.end (); ++it)
+      {
+        try
+          {
+            it->added = addFileImpl (it->filePath, *it->layers, it->workingDir);
+          }
+        catch (const std::exception& exc)
+          {
+            atakmap::util::Logger::log (atakmap::util::Logger::Warning,
+                                        MEM_FN ("addFilesImpl")
+                                        "Failed to add %s: %s",
+                                        it->filePath,
+                                        exc.what ());
+          }
+      }
+  }
+
+
 bool
 LocalRasterDataStore::addFileInternal (const char* filePath,
                                         const char* typeHint,
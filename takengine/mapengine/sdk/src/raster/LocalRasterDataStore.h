@@ -31,10 +31,13 @@
 ////========================================================================////
 
 
+#include <vector>
+
 #include "port/Platform.h"
 #include "port/String.h"
 #include "raster/DatasetDescriptor.h"
 #include "raster/RasterDataStore.h"
+#include "util/ProcessingCallback.h"
 
 
 ////========================================================================////
@@ -128,6 +131,27 @@ class ENGINE_API LocalRasterDataStore
               const char* typeHint = nullptr,
               DatasetDescriptor::CreationCallback *callback = nullptr);
 
+    //
+    // Adds the layers for every file in the directory tree rooted at dirPath
+    // that is not already in the data store.  Files are opened and their
+    // layers derived on the engine's shared IO workers (the number of files
+    // opened concurrently may be limited via the
+    // "localrasterdatastore.ingest-threads" config option); the derived layers
+    // are written to the data store in batches from the calling thread.
+    // ContentListeners are notified once, after all files have been
+    // processed.  Returns the number of files for which layers were added.
+    //
+    // Progress is reported to the callback, if supplied, as the number of
+    // files processed.  If the callback is canceled, files not yet opened are
+    // skipped and layers already derived are not added.
+    //
+    // Throws std::invalid_argument if dirPath is NULL.
+    //
+    std::size_t
+    addDirectory (const char* dirPath,
+                  const char* typeHint = nullptr,
+                  TAK::Engine::Util::ProcessingCallback* callback = nullptr);
+
     //
     // Begins a batch operation on the data store.  Dispatch of ContentListener
     // notifications will be deferred until the batch is signaled to be complete
@@ -212,6 +236,17 @@ class ENGINE_API LocalRasterDataStore
 
     typedef DatasetDescriptor::DescriptorSet    DescriptorSet;
 
+    //
+    // The layers derived from a single file, for use with addFilesImpl.
+    //
+    struct FileLayers
+      {
+        const char* filePath;
+        const DescriptorSet* layers;
+        const char* workingDir;
+        bool added;                     // Set by addFilesImpl.
+      };
+
 
     //==================================
     //  PROTECTED INTERFACE
@@ -261,6 +296,18 @@ class ENGINE_API LocalRasterDataStore
                  const char* workingDir)
         = 0;
 
+    //
+    // Adds the supplied layers for each of the files to the data store,
+    // setting the added flag for each file whose layers were successfully
+    // added.  Called with the RasterDataStore's mutex locked; the data store
+    // does not contain any of the files.  The default implementation invokes
+    // addFileImpl for each file; derived classes may override to write the
+    // files in a single batch.
+    //
+    virtual
+    void
+    addFilesImpl (std::vector<FileLayers>& files);
+
     bool
     addFileInternal (const char* filePath,      // Not NULL.
                      const char* typeHint,      // May be NULL
@@ -1443,6 +1443,66 @@ PersistentRasterDataStore::addFileImpl (const char* filePath,
   }
 
 
+void
+PersistentRasterDataStore::addFilesImpl (std::vector<FileLayers>& files)
+  {
+    try
+      {
+        std::vector<std::unique_ptr<GenerateCurrency>> currencies;
+        LayerDatabase::FileLayersVector batch;
+
+        for (auto iter (files.begin ()); iter != files.end (); ++iter)
+          {
+            currencies.emplace_back (new GenerateCurrency (*iter->layers));
+
+            LayerDatabase::FileLayers layers;
+
+            layers.filePath = iter->filePath;
+            layers.descriptors.assign (iter->layers->begin (),
+                                       iter->layers->end ());
+            layers.workingDir = iter->workingDir;
+            layers.currency = currencies.back ().get ();
+            batch.push_back (layers);
+          }
+
+        layerDB->addLayers (batch);
+      }
+    catch (const std::exception& exc)
+      {
+        atakmap::util::Logger::log (atakmap::util::Logger::Warning,
+                                    MEM_FN ("addFilesImpl")
+                                    "Batch of %u files failed, adding individually: %s",
+                                    static_cast<unsigned> (files.size ()),
+                                    exc.what ());
+
+        for (auto iter (files.begin ()); iter != files.end (); ++iter)
+          {
+            try
+              {
+                iter->added = addFileImpl (iter->filePath,
+                                           *iter->layers,
+                                           iter->workingDir);
+              }
+            catch (const std::exception& fileExc)
+              {
+                atakmap::util::Logger::log (atakmap::util::Logger::Warning,
+                                            MEM_FN ("addFilesImpl")
+                                            "Failed to add %s: %s",
+                                            iter->filePath,
+                                            fileExc.what ());
+              }
+          }
+        return;
+      }
+
+    for (auto iter (files.begin ()); iter != files.end (); ++iter)
+      {
+        iter->added = true;
+        invalidateCacheInfo (*iter->layers, false);
+      }
+  }
+
+
 bool
 PersistentRasterDataStore::clearImpl ()
   {
@@ -320,6 +320,14 @@ class ENGINE_API PersistentRasterDataStore
                  const DescriptorSet&,
                  const char* workingDir);
 
+    //
+    // Adds the supplied files to the layer database in a single transaction.
+    // Should the batch fail, the files are added individually so that one
+    // unusable file does not prevent the others from being added.
+    //
+    void
+    addFilesImpl (std::vector<FileLayers>& files);
+
     //
     // Removes all layers from the data store.  Returns true if the data store
     // contents changed.
@@ -299,10 +299,17 @@ namespace {
             0.5, (double)dataset->GetRasterYSize() - 0.5
         };
 
+        math::PointD corners[4];
+        for (int i = 0; i < 4; i++)
+            corners[i] = math::PointD(pixel[((i + (i / 2)) % 2)], line[(i / 2)]);
+        core::GeoPoint p[4];
+        rpc00b.inverse(p, corners, nullptr, 4u);
+
         for (int i = 0; i < 4; i++) {
-            core::GeoPoint p = rpc00b.inverse(math::PointD(pixel[((i + (i / 2)) % 2)], line[(i / 2)]));
+            if (std::isnan(p[i].latitude) || std::isnan(p[i].longitude))
+                throw std::invalid_argument("");
 
-            gcps.push_back(new GCPHolder(p.longitude, p.latitude, pixel[((i + (i / 2)) % 2)],
+            gcps.push_back(new GCPHolder(p[i].longitude, p[i].latitude, pixel[((i + (i / 2)) % 2)],
                 line[(i / 2)], "RPC00B", ids[i]));
         }
 
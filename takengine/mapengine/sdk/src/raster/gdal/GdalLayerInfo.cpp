@@ -7,6 +7,7 @@
 #include "raster/ImageDatasetDescriptor.h"
 #include "raster/pfps/PfpsMapTypeFrame.h"
 #include "GdalDatasetProjection.h"
+#include "GdalLibrary.h"
 #include "GdalTileReader.h"
 #include "raster/ImageryFileType.h"
 #include "util/IO.h"
@@ -320,6 +321,7 @@ namespace atakmap {
                         return false;
 #endif
                     
+                    GdalLibrary::ensureInitialized();
                     GDALDatasetH dataset = GDALOpen(atakmap::util::getFileAsAbsolute(file).c_str(), GA_ReadOnly);
                     if (dataset == nullptr) {
                         return false;
@@ -619,6 +621,7 @@ namespace {
 #endif
         GDALDatasetH dataset = nullptr;
         try {
+            GdalLibrary::ensureInitialized();
             dataset = GDALOpen(uri, GDALAccess::GA_ReadOnly);
             if (!dataset) {
                 atakmap::util::Logger::log(atakmap::util::Logger::Error, "failed to open dataset %s", uri);
@@ -1,10 +1,17 @@
 #include "GdalLibrary.h"
 
+#include <algorithm>
+
 #include <platformstl/filesystem/path.hpp>
 
+#include "thread/Lock.h"
+#include "util/ConfigOptions.h"
 #include "util/IO.h"
+#include "util/MemoryTrim.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
 
 namespace atakmap {
     namespace raster {
@@ -13,10 +20,51 @@ namespace atakmap {
             Mutex GdalLibrary::mutex;
             bool GdalLibrary::initialized = false;
             bool GdalLibrary::initSuccess = false;
+            bool GdalLibrary::initDeferred = false;
+            std::string GdalLibrary::deferredDataDir;
             OGRSpatialReference *GdalLibrary::EPSG_4326 = nullptr;
 
 
             namespace {
+                /**
+                 * Releases GDAL's block cache in response to memory
+                 * pressure. The cache limit is restored once trimmed.
+                 */
+                class BlockCacheTrimmable : public MemoryTrimmable
+                {
+                public:
+                    BlockCacheTrimmable(const std::size_t maxSize_) NOTHROWS :
+                        maxSize(maxSize_)
+                    {}
+                public: // MemoryTrimmable
+                    void trim(const MemoryTrimLevel level) NOTHROWS override
+                    {
+                        // lowering the limit flushes blocks in excess of it
+                        GDALSetCacheMax64((GIntBig)MemoryTrimLevel_getBudget(level, maxSize));
+                        GDALSetCacheMax64((GIntBig)maxSize);
+                    }
+                private:
+                    const std::size_t maxSize;
+                };
+
+                Mutex &reservationMutex()
+                {
+                    static Mutex mutex;
+                    return mutex;
+                }
+
+                int reservedThreads = 0;
+
+                void configureResources()
+                {
+                    // GDAL's default of 5% of physical memory competes with
+                    // the renderer's caches
+                    const std::size_t cacheSize = (std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("gdal.block-cache-size", 32 * 1024 * 1024), 0);
+                    GDALSetCacheMax64((GIntBig)cacheSize);
+                    static BlockCacheTrimmable trimmable(cacheSize);
+                    MemoryTrim_registerTrimmable(trimmable);
+                }
+
                 bool initImpl(const char *gdalDir)
                 {
                     // NOTE: AllRegister automatically loads the shared libraries
@@ -28,6 +76,8 @@ namespace atakmap {
 
                     CPLSetConfigOption("GDAL_DISABLE_READDIR_ON_OPEN", "TRUE");
 
+                    configureResources();
+
                     if (!util::pathExists(gdalDir))
                         util::createDir(gdalDir);
                     platformstl::basic_path<char> gdalDataVer(gdalDir);
@@ -152,6 +202,32 @@ namespace atakmap {
                 return ret;
             }
 
+            void GdalLibrary::initLazy(const char *gdalDataDir)
+            {
+                mutex.lock();
+                if (!initialized && gdalDataDir) {
+                    deferredDataDir = gdalDataDir;
+                    initDeferred = true;
+                }
+                mutex.unlock();
+            }
+
+            bool GdalLibrary::ensureInitialized()
+            {
+                bool ret;
+                mutex.lock();
+                if (!initialized && initDeferred) {
+                    try {
+                        initSuccess = initImpl(deferredDataDir.c_str());
+                    } catch (...) {
+                    }
+                    initialized = true;
+                }
+                ret = initSuccess;
+                mutex.unlock();
+                return ret;
+            }
+
             bool GdalLibrary::isInitialized()
             {
                 mutex.lock();
@@ -181,6 +257,38 @@ namespace atakmap {
                 return (int)v;
             }
             
+            int GdalLibrary::getThreadBudget()
+            {
+                const int configured = ConfigOptions_getIntOptionOrDefault("gdal.num-threads", 0);
+                if (configured > 0)
+                    return configured;
+                std::size_t limit = 1u;
+                if (WorkerRegistry_getConcurrencyLimit(&limit, TEWC_CPUDecode) != TE_Ok)
+                    return 1;
+                return std::max((int)limit - 1, 1);
+            }
+
+            GdalLibrary::ThreadReservation::ThreadReservation(const int requested) :
+                count(1)
+            {
+                Lock lock(reservationMutex());
+                const int budget = getThreadBudget();
+                const int available = budget - reservedThreads;
+                count = std::max(std::min((requested > 0) ? requested : budget, available), 1);
+                reservedThreads += count;
+            }
+
+            GdalLibrary::ThreadReservation::~ThreadReservation()
+            {
+                Lock lock(reservationMutex());
+                reservedThreads -= count;
+            }
+
+            int GdalLibrary::ThreadReservation::getThreadCount() const
+            {
+                return count;
+            }
+
             std::shared_ptr<atakmap::raster::tilereader::TileReader::AsynchronousIO> GdalLibrary::getMasterIOThread() {
                 //XXX-- init once
                 static std::shared_ptr<atakmap::raster::tilereader::TileReader::AsynchronousIO> asyncIO(new atakmap::raster::tilereader::TileReader::AsynchronousIO());
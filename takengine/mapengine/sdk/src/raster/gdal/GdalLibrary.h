@@ -1,6 +1,8 @@
 #ifndef ATAKMAP_RASTER_GDAL_GDALLIBRARY_H_INCLUDED
 #define ATAKMAP_RASTER_GDAL_GDALLIBRARY_H_INCLUDED
 
+#include <string>
+
 #include "gdal_priv.h"
 #include "ogr_spatialref.h"
 #include "thread/Mutex.h"
@@ -12,22 +14,75 @@ namespace atakmap {
             
             class GdalLibrary
             {
+            public:
+                class ThreadReservation;
             private:
                 static TAK::Engine::Thread::Mutex mutex;
                 static bool initialized;
                 static bool initSuccess;
+                static bool initDeferred;
+                static std::string deferredDataDir;
 
             public:
                 static OGRSpatialReference *EPSG_4326;
                 static bool init(const char *gdalDataDir);
+                /**
+                 * Records the GDAL data directory without registering the
+                 * drivers. Initialization is performed by the first call
+                 * to `ensureInitialized`, which the SDK makes before
+                 * opening a dataset. Driver registration loads all of the
+                 * GDAL drivers and is a significant part of startup time.
+                 */
+                static void initLazy(const char *gdalDataDir);
+                /**
+                 * Performs any initialization deferred by `initLazy`.
+                 *
+                 * @return  `true` if the library has been successfully
+                 *          initialized
+                 */
+                static bool ensureInitialized();
 
                 static bool isInitialized();
 
                 static int getSpatialReferenceID(OGRSpatialReference *srs);
+
+                /**
+                 * Returns the total number of threads that multithreaded
+                 * GDAL operations (warping, compression of GeoTIFF blocks)
+                 * may use, per the `gdal.num-threads` option. By default,
+                 * one less than the concurrency limit of the
+                 * `TEWC_CPUDecode` worker class, leaving capacity for the
+                 * renderer's decode work.
+                 */
+                static int getThreadBudget();
                 
                 static std::shared_ptr<atakmap::raster::tilereader::TileReader::AsynchronousIO> getMasterIOThread();
             };
 
+            /**
+             * Reserves threads from the budget for the lifetime of a
+             * multithreaded GDAL operation, so that concurrent operations
+             * share the budget rather than each using all cores. A
+             * reservation never blocks and always receives at least one
+             * thread.
+             */
+            class GdalLibrary::ThreadReservation
+            {
+            public:
+                /**
+                 * @param requested The number of threads desired; if not
+                 *                  positive, the full budget
+                 */
+                ThreadReservation(const int requested);
+                ~ThreadReservation();
+            private:
+                ThreadReservation(const ThreadReservation &);
+            public:
+                int getThreadCount() const;
+            private:
+                int count;
+            };
+
         }
     }
 }
@@ -0,0 +1,182 @@
+#include "raster/gdal/GdalOverviewBuilder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "cpl_conv.h"
+#include "cpl_vsi.h"
+#include "port/String.h"
+#include "raster/gdal/GdalLibrary.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
+#include "util/Tasking.h"
+#include "util/Work.h"
+#include "util/WorkerRegistry.h"
+
+using namespace atakmap::raster::gdal;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace {
+    /** overviews are generated until the coarsest fits within a tile of this size */
+    const int MIN_OVERVIEW_SIZE = 256;
+
+    std::atomic<int64_t> generation(0LL);
+
+    Mutex &pendingMutex() {
+        static Mutex mutex;
+        return mutex;
+    }
+
+    std::set<std::string> &pendingBuilds() {
+        static std::set<std::string> pending;
+        return pending;
+    }
+
+    SharedWorkerPtr createBuilderWorker() {
+        // builds are dominated by resampling; they share the engine's CPU
+        // workers rather than competing with them from a private pool
+        SharedWorkerPtr worker;
+        const int threads = ConfigOptions_getIntOptionOrDefault("gdal.overview-builder-threads", 2);
+        if (WorkerRegistry_borrow(worker, TEWC_CPUDecode, "gdal-overview-builder", (std::size_t)std::max(threads, 1)) != TE_Ok)
+            worker = GeneralWorkers_flex();
+        return worker;
+    }
+
+    const SharedWorkerPtr &builderWorker() {
+        static SharedWorkerPtr worker(createBuilderWorker());
+        return worker;
+    }
+
+    struct ProgressContext {
+        const char *uri;
+        GdalOverviewBuilder::Callback *callback;
+        bool canceled;
+    };
+
+    int CPL_STDCALL progressCallback(double complete, const char *, void *opaque) {
+        ProgressContext &ctx = *static_cast<ProgressContext *>(opaque);
+        if (ctx.callback && !ctx.callback->overviewProgress(ctx.uri, complete)) {
+            ctx.canceled = true;
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    TAKErr buildTask(bool &, const String &uri, const std::shared_ptr<GdalOverviewBuilder::Callback> &callback) NOTHROWS {
+        const TAKErr code = GdalOverviewBuilder::build(uri, callback.get());
+        {
+            Lock lock(pendingMutex());
+            pendingBuilds().erase(uri.get());
+        }
+        if (callback)
+            callback->overviewsBuilt(uri, code);
+        return code;
+    }
+}
+
+GdalOverviewBuilder::Callback::~Callback() NOTHROWS {}
+
+TAKErr GdalOverviewBuilder::build(const char *uri, Callback *callback) NOTHROWS {
+    if (!uri)
+        return TE_InvalidArg;
+
+    // the dataset is opened exclusively for the build; handles are not
+    // safe for use from multiple threads
+    GdalLibrary::ensureInitialized();
+    GDALDataset *dataset = static_cast<GDALDataset *>(GDALOpen(uri, GA_ReadOnly));
+    if (!dataset)
+        return TE_IO;
+    if (!isRequired(*dataset)) {
+        GDALClose(dataset);
+        return TE_Done;
+    }
+
+    const int width = dataset->GetRasterXSize();
+    const int height = dataset->GetRasterYSize();
+    std::vector<int> factors;
+    for (int factor = 2; ; factor *= 2) {
+        factors.push_back(factor);
+        if ((std::max(width, height) / factor) <= MIN_OVERVIEW_SIZE)
+            break;
+    }
+
+    std::vector<GDALRasterBand *> bands;
+    for (int i = 1; i <= dataset->GetRasterCount(); i++)
+        bands.push_back(dataset->GetRasterBand(i));
+
+    // averaging palette indices does not produce meaningful values
+    const char *resampling = (bands[0]->GetColorInterpretation() == GCI_PaletteIndex) ? "NEAREST" : "AVERAGE";
+
+    const std::string ovrPath = std::string(uri) + ".ovr";
+    const std::string partialPath = ovrPath + ".part";
+
+    ProgressContext ctx;
+    ctx.uri = uri;
+    ctx.callback = callback;
+    ctx.canceled = false;
+
+    // resampling is single threaded; DEFLATE compression of the overview
+    // blocks is distributed over the reserved threads
+    GdalLibrary::ThreadReservation threads(0);
+    const std::string numThreads = std::to_string(threads.getThreadCount());
+
+    CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", "DEFLATE");
+    CPLSetThreadLocalConfigOption("GDAL_NUM_THREADS", numThreads.c_str());
+    CPLErr err = GTIFFBuildOverviews(partialPath.c_str(),
+                                     (int)bands.size(), bands.data(),
+                                     (int)factors.size(), factors.data(),
+                                     resampling,
+                                     progressCallback, &ctx);
+    CPLSetThreadLocalConfigOption("GDAL_NUM_THREADS", nullptr);
+    CPLSetThreadLocalConfigOption("COMPRESS_OVERVIEW", nullptr);
+    GDALClose(dataset);
+
+    TAKErr code = TE_Ok;
+    if (ctx.canceled)
+        code = TE_Canceled;
+    else if (err != CE_None)
+        code = TE_IO;
+    else if (VSIRename(partialPath.c_str(), ovrPath.c_str()) != 0)
+        code = TE_IO;
+
+    if (code != TE_Ok) {
+        VSIUnlink(partialPath.c_str());
+        return code;
+    }
+
+    generation++;
+    return TE_Ok;
+}
+
+TAKErr GdalOverviewBuilder::schedule(const char *uri, const std::shared_ptr<Callback> &callback) NOTHROWS {
+    if (!uri)
+        return TE_InvalidArg;
+    const SharedWorkerPtr &worker = builderWorker();
+    {
+        Lock lock(pendingMutex());
+        if (!pendingBuilds().insert(uri).second)
+            return TE_Done;
+    }
+    Task_begin(worker, buildTask, String(uri), callback);
+    return TE_Ok;
+}
+
+bool GdalOverviewBuilder::isRequired(GDALDataset &dataset) NOTHROWS {
+    if (dataset.GetRasterCount() < 1)
+        return false;
+    if (dataset.GetRasterBand(1)->GetOverviewCount() > 0)
+        return false;
+    const int minDimension = ConfigOptions_getIntOptionOrDefault("gdal.overview-min-dimension", 4096);
+    return std::max(dataset.GetRasterXSize(), dataset.GetRasterYSize()) >= minDimension;
+}
+
+int64_t GdalOverviewBuilder::getGeneration() NOTHROWS {
+    return generation;
+}
@@ -0,0 +1,94 @@
+#ifndef ATAKMAP_RASTER_GDAL_GDALOVERVIEWBUILDER_H_INCLUDED
+#define ATAKMAP_RASTER_GDAL_GDALOVERVIEWBUILDER_H_INCLUDED
+
+#include <cstdint>
+#include <memory>
+
+#include "gdal_priv.h"
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace atakmap {
+    namespace raster {
+        namespace gdal {
+
+            /**
+             * Generates external overviews (a GeoTIFF <code>.ovr</code>
+             * sidecar) for local imagery that lacks them. Without
+             * overviews, reads at low resolution must sample the full
+             * resolution source.
+             *
+             * <P>The sidecar is written under a temporary name and renamed
+             * once complete, so a dataset opened while a build is in
+             * progress never observes partial overviews.
+             */
+            class GdalOverviewBuilder
+            {
+            public:
+                class Callback;
+            private:
+                GdalOverviewBuilder();
+            public:
+                /**
+                 * Builds the overviews for the dataset on the calling
+                 * thread.
+                 *
+                 * @param callback  Receives progress; may be
+                 *                  <code>nullptr</code>
+                 *
+                 * @return  <code>TE_Ok</code> if the overviews were built,
+                 *          <code>TE_Done</code> if the dataset does not
+                 *          require overviews, <code>TE_Canceled</code> if
+                 *          the callback canceled the build
+                 */
+                static TAK::Engine::Util::TAKErr build(const char *uri, Callback *callback) NOTHROWS;
+                /**
+                 * Schedules a build on the background builder. Builds for
+                 * different datasets run in parallel, with the number of
+                 * concurrent builds per the
+                 * <code>gdal.overview-builder-threads</code> option.
+                 *
+                 * @param callback  Receives progress and completion; may be
+                 *                  <code>nullptr</code>
+                 *
+                 * @return  <code>TE_Ok</code> if scheduled,
+                 *          <code>TE_Done</code> if a build for the dataset
+                 *          is already pending
+                 */
+                static TAK::Engine::Util::TAKErr schedule(const char *uri, const std::shared_ptr<Callback> &callback) NOTHROWS;
+                /**
+                 * Returns <code>true</code> if the dataset has no overviews
+                 * and is large enough to benefit from them, per the
+                 * <code>gdal.overview-min-dimension</code> option.
+                 */
+                static bool isRequired(GDALDataset &dataset) NOTHROWS;
+                /**
+                 * Returns a counter that is incremented each time a build
+                 * completes. Readers may compare against a previously
+                 * observed value to cheaply detect newly available
+                 * overviews.
+                 */
+                static int64_t getGeneration() NOTHROWS;
+            };
+
+            class GdalOverviewBuilder::Callback
+            {
+            public:
+                virtual ~Callback() NOTHROWS;
+                /**
+                 * Invoked periodically during the build.
+                 *
+                 * @param progress  The fraction complete, <code>0</code>
+                 *                  through <code>1</code>
+                 *
+                 * @return  <code>false</code> to cancel the build
+                 */
+                virtual bool overviewProgress(const char *uri, const double progress) NOTHROWS = 0;
+                /** invoked when a scheduled build completes */
+                virtual void overviewsBuilt(const char *uri, const TAK::Engine::Util::TAKErr code) NOTHROWS = 0;
+            };
+        }
+    }
+}
+
+#endif
@@ -1,5 +1,6 @@
 
 #include <algorithm>
+#include "raster/gdal/GdalLibrary.h"
 #include "raster/gdal/GdalTileReader.h"
 
 using namespace atakmap::raster;
@@ -74,6 +75,7 @@ const char *GdalTileReader::GdalTileReaderSpi::getName() const {
 }
 
 atakmap::raster::tilereader::TileReader *GdalTileReader::GdalTileReaderSpi::create(const char *uri, const tilereader::TileReaderFactory::Options *opts) {
+    GdalLibrary::ensureInitialized();
     GDALDatasetH dataset = GDALOpen(uri, GA_ReadOnly);
     if (dataset != nullptr) {
         int tileWidth = 0;
@@ -0,0 +1,191 @@
+#include "raster/gdal/GdalWarper.h"
+
+#include <string>
+
+#include "cpl_string.h"
+#include "cpl_vsi.h"
+#include "gdal_alg.h"
+#include "gdal_priv.h"
+#include "gdalwarper.h"
+#include "ogr_spatialref.h"
+#include "raster/gdal/GdalLibrary.h"
+#include "util/ConfigOptions.h"
+
+using namespace atakmap::raster::gdal;
+
+using namespace TAK::Engine::Util;
+
+namespace {
+    struct ProgressContext {
+        const char *uri;
+        GdalWarper::Callback *callback;
+        bool canceled;
+    };
+
+    int CPL_STDCALL progressCallback(double complete, const char *, void *opaque) {
+        ProgressContext &ctx = *static_cast<ProgressContext *>(opaque);
+        if (ctx.callback && !ctx.callback->warpProgress(ctx.uri, complete)) {
+            ctx.canceled = true;
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    TAKErr getWkt(std::string &value, const int srid) NOTHROWS {
+        OGRSpatialReference srs;
+        if (srs.importFromEPSG(srid) != OGRERR_NONE)
+            return TE_InvalidArg;
+        char *wkt = nullptr;
+        if (srs.exportToWkt(&wkt) != OGRERR_NONE) {
+            CPLFree(wkt);
+            return TE_Err;
+        }
+        value = wkt;
+        CPLFree(wkt);
+        return TE_Ok;
+    }
+
+    /** creates the tiled output, matching the band layout of the source */
+    GDALDataset *createOutput(GDALDataset &src, const char *path, const char *wkt, const int width, const int height, const double *geoTransform, const int threads) NOTHROWS {
+        GDALDriver *driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+        if (!driver)
+            return nullptr;
+
+        GDALRasterBand *srcBand = src.GetRasterBand(1);
+        const std::string numThreads = std::to_string(threads);
+        char **options = nullptr;
+        options = CSLSetNameValue(options, "TILED", "YES");
+        options = CSLSetNameValue(options, "COMPRESS", "DEFLATE");
+        options = CSLSetNameValue(options, "BIGTIFF", "IF_SAFER");
+        options = CSLSetNameValue(options, "NUM_THREADS", numThreads.c_str());
+        GDALDataset *dst = driver->Create(path, width, height, src.GetRasterCount(), srcBand->GetRasterDataType(), options);
+        CSLDestroy(options);
+        if (!dst)
+            return nullptr;
+
+        dst->SetProjection(wkt);
+        dst->SetGeoTransform(const_cast<double *>(geoTransform));
+        for (int i = 1; i <= src.GetRasterCount(); i++) {
+            GDALRasterBand *s = src.GetRasterBand(i);
+            GDALRasterBand *d = dst->GetRasterBand(i);
+            d->SetColorInterpretation(s->GetColorInterpretation());
+            int hasNoData = FALSE;
+            const double noData = s->GetNoDataValue(&hasNoData);
+            if (hasNoData)
+                d->SetNoDataValue(noData);
+            if (s->GetColorTable())
+                d->SetColorTable(s->GetColorTable());
+        }
+        return dst;
+    }
+
+    TAKErr warp(GDALDataset &src, GDALDataset &dst, const int threads, ProgressContext &ctx) NOTHROWS {
+        void *transformer = GDALCreateGenImgProjTransformer2(&src, &dst, nullptr);
+        if (!transformer)
+            return TE_Err;
+
+        const std::string numThreads = std::to_string(threads);
+        GDALWarpOptions *options = GDALCreateWarpOptions();
+        options->hSrcDS = &src;
+        options->hDstDS = &dst;
+        GDALWarpInitDefaultBandMapping(options, src.GetRasterCount());
+        options->papszWarpOptions = CSLSetNameValue(options->papszWarpOptions, "NUM_THREADS", numThreads.c_str());
+        options->papszWarpOptions = CSLSetNameValue(options->papszWarpOptions, "INIT_DEST", "NO_DATA");
+        options->dfWarpMemoryLimit = ConfigOptions_getIntOptionOrDefault("gdal.warp-memory-limit", 64 * 1024 * 1024);
+        // interpolating palette indices does not produce meaningful values
+        options->eResampleAlg = (src.GetRasterBand(1)->GetColorInterpretation() == GCI_PaletteIndex) ? GRA_NearestNeighbour : GRA_Bilinear;
+        options->pfnTransformer = GDALGenImgProjTransform;
+        options->pTransformerArg = transformer;
+        options->pfnProgress = progressCallback;
+        options->pProgressArg = &ctx;
+
+        int hasNoData = FALSE;
+        const double noData = src.GetRasterBand(1)->GetNoDataValue(&hasNoData);
+        if (hasNoData) {
+            GDALWarpInitSrcNoDataReal(options, noData);
+            GDALWarpInitDstNoDataReal(options, noData);
+        }
+
+        TAKErr code = TE_Ok;
+        GDALWarpOperation operation;
+        if (operation.Initialize(options) != CE_None)
+            code = TE_Err;
+        // I/O is performed on the calling thread while the warp kernel of
+        // the previous chunk runs on the reserved threads
+        else if (operation.ChunkAndWarpMulti(0, 0, dst.GetRasterXSize(), dst.GetRasterYSize()) != CE_None)
+            code = TE_IO;
+
+        GDALDestroyWarpOptions(options);
+        GDALDestroyGenImgProjTransformer(transformer);
+        return code;
+    }
+}
+
+GdalWarper::Callback::~Callback() NOTHROWS {}
+
+TAKErr GdalWarper::reproject(const char *srcUri, const char *dstPath, const int dstSrid, const int threads, Callback *callback) NOTHROWS {
+    TAKErr code(TE_Ok);
+    if (!srcUri || !dstPath)
+        return TE_InvalidArg;
+
+    std::string dstWkt;
+    code = getWkt(dstWkt, dstSrid);
+    TE_CHECKRETURN_CODE(code);
+
+    GdalLibrary::ensureInitialized();
+    GDALDataset *src = static_cast<GDALDataset *>(GDALOpen(srcUri, GA_ReadOnly));
+    if (!src)
+        return TE_IO;
+    if (src->GetRasterCount() < 1) {
+        GDALClose(src);
+        return TE_InvalidArg;
+    }
+
+    // derive the output grid from the source footprint in the target projection
+    double geoTransform[6];
+    int width;
+    int height;
+    {
+        char **transformerOptions = CSLSetNameValue(nullptr, "DST_SRS", dstWkt.c_str());
+        void *transformer = GDALCreateGenImgProjTransformer2(src, nullptr, transformerOptions);
+        CSLDestroy(transformerOptions);
+        if (!transformer) {
+            GDALClose(src);
+            return TE_Err;
+        }
+        const CPLErr err = GDALSuggestedWarpOutput(src, GDALGenImgProjTransform, transformer, geoTransform, &width, &height);
+        GDALDestroyGenImgProjTransformer(transformer);
+        if (err != CE_None) {
+            GDALClose(src);
+            return TE_Err;
+        }
+    }
+
+    GdalLibrary::ThreadReservation reservation(threads);
+
+    const std::string partialPath = std::string(dstPath) + ".part";
+    GDALDataset *dst = createOutput(*src, partialPath.c_str(), dstWkt.c_str(), width, height, geoTransform, reservation.getThreadCount());
+    if (!dst) {
+        GDALClose(src);
+        return TE_IO;
+    }
+
+    ProgressContext ctx;
+    ctx.uri = srcUri;
+    ctx.callback = callback;
+    ctx.canceled = false;
+
+    code = warp(*src, *dst, reservation.getThreadCount(), ctx);
+    // closing flushes the remaining blocks
+    GDALClose(dst);
+    GDALClose(src);
+
+    if (ctx.canceled)
+        code = TE_Canceled;
+    else if (code == TE_Ok && VSIRename(partialPath.c_str(), dstPath) != 0)
+        code = TE_IO;
+
+    if (code != TE_Ok)
+        VSIUnlink(partialPath.c_str());
+    return code;
+}
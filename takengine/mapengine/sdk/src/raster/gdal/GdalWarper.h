@@ -0,0 +1,69 @@
+#ifndef ATAKMAP_RASTER_GDAL_GDALWARPER_H_INCLUDED
+#define ATAKMAP_RASTER_GDAL_GDALWARPER_H_INCLUDED
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace atakmap {
+    namespace raster {
+        namespace gdal {
+
+            /**
+             * Reprojects imagery into a tiled GeoTIFF on import, so that
+             * subsequent reads do not incur the cost of an on-the-fly
+             * projection.
+             *
+             * <P>Warping of the output chunks and compression of the
+             * output blocks are distributed over threads reserved from
+             * the GDAL thread budget (see
+             * <code>GdalLibrary::getThreadBudget()</code>); I/O overlaps
+             * the warp computation. Memory used per chunk is bounded by
+             * the <code>gdal.warp-memory-limit</code> option.
+             *
+             * <P>The output is written under a temporary name and renamed
+             * once complete.
+             */
+            class GdalWarper
+            {
+            public:
+                class Callback;
+            private:
+                GdalWarper();
+            public:
+                /**
+                 * Reprojects the dataset on the calling thread.
+                 *
+                 * @param srcUri    The source dataset
+                 * @param dstPath   The path of the GeoTIFF to be created
+                 * @param dstSrid   The EPSG code of the output projection
+                 * @param threads   The number of threads desired; if not
+                 *                  positive, the full GDAL thread budget
+                 * @param callback  Receives progress; may be
+                 *                  <code>nullptr</code>
+                 *
+                 * @return  <code>TE_Ok</code> if the output was created,
+                 *          <code>TE_Canceled</code> if the callback
+                 *          canceled the warp
+                 */
+                static TAK::Engine::Util::TAKErr reproject(const char *srcUri, const char *dstPath, const int dstSrid, const int threads, Callback *callback) NOTHROWS;
+            };
+
+            class GdalWarper::Callback
+            {
+            public:
+                virtual ~Callback() NOTHROWS;
+                /**
+                 * Invoked periodically during the warp.
+                 *
+                 * @param progress  The fraction complete, <code>0</code>
+                 *                  through <code>1</code>
+                 *
+                 * @return  <code>false</code> to cancel the warp
+                 */
+                virtual bool warpProgress(const char *srcUri, const double progress) NOTHROWS = 0;
+            };
+        }
+    }
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "RapidPositioningControlB.h"
+#include "elevation/ElevationManager.h"
 #include "util/IO.h"
 
 namespace atakmap {
@@ -210,6 +211,57 @@ namespace atakmap {
                     return retval;
                 }
 
+                /**
+                 * The terms of the polynomial, and of its partial
+                 * derivatives with respect to latitude and longitude, for a
+                 * single ground position. The terms are identical to those
+                 * evaluated by `polynomial`, `partialDerivativeP` and
+                 * `partialDerivativeL`, but are computed once per position
+                 * and shared across the coefficient sets.
+                 */
+                struct Terms {
+                    double value[RapidPositioningControlB::numCoeffs];
+                    double wrtP[RapidPositioningControlB::numCoeffs];
+                    double wrtL[RapidPositioningControlB::numCoeffs];
+                };
+
+                void computeTerms(Terms &terms, double normalizedLatitude,
+                                  double normalizedLongitude, double normalizedElevation) {
+                    const double lat2 = normalizedLatitude * normalizedLatitude;
+                    const double lon2 = normalizedLongitude * normalizedLongitude;
+                    const double ele2 = normalizedElevation * normalizedElevation;
+
+                    const double vars[][4] = {
+                        { 1.0, normalizedLatitude, lat2, lat2 * normalizedLatitude },
+                        { 1.0, normalizedLongitude, lon2, lon2 * normalizedLongitude },
+                        { 1.0, normalizedElevation, ele2, ele2 * normalizedElevation },
+                    };
+                    const double derivP[4] = { 1.0, 1.0, normalizedLatitude, lat2 };
+                    const double derivL[4] = { 1.0, 1.0, normalizedLongitude, lon2 };
+
+                    for (int i = 0; i < RapidPositioningControlB::numCoeffs; i++) {
+                        terms.value[i] = vars[P][EXPONENTS[i][P]]
+                            * vars[L][EXPONENTS[i][L]] * vars[H][EXPONENTS[i][H]];
+                        terms.wrtP[i] = 0.0;
+                        terms.wrtL[i] = 0.0;
+                    }
+                    for (int i = 0; i < PARTIAL_DERIVATIVE_COEFF_COUNT; i++) {
+                        const int p = PARTIAL_DERIVATIVE_COEFF_P[i];
+                        terms.wrtP[p] = derivP[EXPONENTS[p][P]]
+                            * vars[L][EXPONENTS[p][L]] * vars[H][EXPONENTS[p][H]];
+                        const int l = PARTIAL_DERIVATIVE_COEFF_L[i];
+                        terms.wrtL[l] = vars[P][EXPONENTS[l][P]]
+                            * derivL[EXPONENTS[l][L]] * vars[H][EXPONENTS[l][H]];
+                    }
+                }
+
+                double evaluate(const double *terms, const double *coeff) {
+                    double retval = 0;
+                    for (int i = 0; i < RapidPositioningControlB::numCoeffs; i++)
+                        retval += coeff[i] * terms[i];
+                    return retval;
+                }
+
                 double determinant2x2(const double matrix[2][2]) {
                     return (matrix[0][0] * matrix[1][1]) - (matrix[0][1] * matrix[1][0]);
                 }
@@ -501,6 +553,222 @@ namespace atakmap {
                     longitude_scale_));
 
             }
+
+            void RapidPositioningControlB::forward(math::PointD *dst, const core::GeoPoint *src, const double *elevations, const std::size_t count)
+            {
+                Terms terms;
+                for (std::size_t i = 0u; i < count; i++) {
+                    // normalize the ground position
+                    const double normLat = normalize(src[i].latitude, latitude_offset_,
+                                                     latitude_scale_);
+                    const double normLon = normalize(src[i].longitude,
+                                                     longitude_offset_, longitude_scale_);
+                    const double normEle = normalize(elevations ? elevations[i] : default_elevation_,
+                                                     height_offset_, height_scale_);
+
+                    computeTerms(terms, normLat, normLon, normEle);
+
+                    // compute the normalized row and column
+                    const double normRow = evaluate(terms.value, line_num_coeff_)
+                                           / evaluate(terms.value, line_den_coeff_);
+                    const double normCol = evaluate(terms.value, sample_num_coeff_)
+                                           / evaluate(terms.value, sample_den_coeff_);
+
+                    dst[i] = math::PointD(unnormalize(normCol, sample_offset_,
+                        sample_scale_), unnormalize(normRow, line_offset_,
+                        line_scale_));
+                }
+            }
+
+            void RapidPositioningControlB::inverse(core::GeoPoint *dst, const math::PointD *src, const double *elevations, const std::size_t count)
+            {
+                struct Solution {
+                    // the normalized image position
+                    double normRow;
+                    double normCol;
+                    // the normalized ground position
+                    double normEle;
+                    double normLat;
+                    double normLon;
+                    // the derived coordinate with the minimum test value
+                    double minTest;
+                    double minNormLat;
+                    double minNormLon;
+                    bool converged;
+                    bool failed;
+                };
+
+                std::vector<Solution> solutions(count);
+                // the indices of the points that have not yet converged
+                std::vector<std::size_t> active;
+                active.reserve(count);
+                for (std::size_t i = 0u; i < count; i++) {
+                    Solution &s = solutions[i];
+                    s.normRow = normalize(src[i].y, line_offset_, line_scale_);
+                    s.normCol = normalize(src[i].x, sample_offset_, sample_scale_);
+                    s.normEle = normalize(elevations ? elevations[i] : default_elevation_,
+                                          height_offset_, height_scale_);
+                    s.normLat = 0.0;
+                    s.normLon = 0.0;
+                    s.minTest = HUGE_VAL;
+                    s.minNormLat = NAN;
+                    s.minNormLon = NAN;
+                    s.converged = false;
+                    s.failed = false;
+                    active.push_back(i);
+                }
+
+                Terms terms;
+                double pdMatrix[2][2];
+                for (int iteration = 0; iteration <= max_iterations_ && !active.empty(); iteration++) {
+                    std::size_t numActive = 0u;
+                    for (std::size_t a = 0u; a < active.size(); a++) {
+                        Solution &s = solutions[active[a]];
+
+                        computeTerms(terms, s.normLat, s.normLon, s.normEle);
+
+                        const double numRowEst = evaluate(terms.value, line_num_coeff_);
+                        const double denRowEst = evaluate(terms.value, line_den_coeff_);
+                        const double numColEst = evaluate(terms.value, sample_num_coeff_);
+                        const double denColEst = evaluate(terms.value, sample_den_coeff_);
+
+                        const double deltaRow = s.normRow - (numRowEst / denRowEst);
+                        const double deltaCol = s.normCol - (numColEst / denColEst);
+
+                        const double test = sqrt(deltaRow * deltaRow + deltaCol * deltaCol);
+                        if (test < s.minTest) {
+                            s.minTest = test;
+                            s.minNormLat = s.normLat;
+                            s.minNormLon = s.normLon;
+                        }
+
+                        // check for convergence
+                        s.converged = (test <= this->convergence_criteria_);
+                        if (s.converged)
+                            continue;
+
+                        // partial derivatives of the numerator/denominator for
+                        // the row and column; see the single point inverse
+                        const double derivRowNumer_wrtLatitude = evaluate(terms.wrtP, line_num_coeff_);
+                        const double derivRowDenom_wrtLatitude = evaluate(terms.wrtP, line_den_coeff_);
+                        const double derivColNumer_wrtLatitude = evaluate(terms.wrtP, sample_num_coeff_);
+                        const double derivColDenom_wrtLatitude = evaluate(terms.wrtP, sample_num_coeff_);
+
+                        const double derivRowNumer_wrtLongitude = evaluate(terms.wrtL, line_num_coeff_);
+                        const double derivRowDenom_wrtLongitude = evaluate(terms.wrtL, line_den_coeff_);
+                        const double derivColNumer_wrtLongitude = evaluate(terms.wrtL, sample_num_coeff_);
+                        const double derivColDenom_wrtLongitude = evaluate(terms.wrtL, sample_num_coeff_);
+
+                        const double derivMatrix[2][2] = {
+                            {
+                                (denRowEst * derivRowNumer_wrtLongitude - numRowEst * derivRowDenom_wrtLongitude) / (denRowEst * denRowEst),
+                                (denRowEst * derivRowNumer_wrtLatitude - numRowEst * derivRowDenom_wrtLatitude) / (denRowEst * denRowEst)
+                            },
+                            {
+                                (denColEst * derivColNumer_wrtLongitude - numColEst * derivColDenom_wrtLongitude) / (denColEst * denColEst),
+                                (denColEst * derivColNumer_wrtLatitude - numColEst * derivColDenom_wrtLatitude) / (denColEst * denColEst)
+                            }
+                        };
+                        if (!inverse2x2(derivMatrix, pdMatrix)) {
+                            s.failed = true;
+                            continue;
+                        }
+
+                        // adjust the normalized lat/lon
+                        s.normLon += pdMatrix[0][0] * deltaRow + pdMatrix[0][1] * deltaCol;
+                        s.normLat += pdMatrix[1][0] * deltaRow + pdMatrix[1][1] * deltaCol;
+
+                        active[numActive++] = active[a];
+                    }
+                    active.resize(numActive);
+                }
+
+                for (std::size_t i = 0u; i < count; i++) {
+                    const Solution &s = solutions[i];
+                    double normLat = s.normLat;
+                    double normLon = s.normLon;
+                    if (s.failed || (!s.converged && s.minTest == HUGE_VAL)) {
+                        dst[i] = core::GeoPoint(NAN, NAN);
+                        continue;
+                    } else if (!s.converged) {
+                        // return the derived coordinate that resulted in our
+                        // minimum test value
+                        normLat = s.minNormLat;
+                        normLon = s.minNormLon;
+                    }
+
+                    dst[i] = core::GeoPoint(unnormalize(normLat, latitude_offset_,
+                        latitude_scale_), unnormalize(normLon, longitude_offset_,
+                        longitude_scale_));
+                }
+            }
+
+            void RapidPositioningControlB::inverseOnTerrain(core::GeoPoint *dst, const math::PointD *src, const std::size_t count, const std::size_t maxPasses)
+            {
+                // refinement stops once the sampled elevation is within this
+                // many meters of the elevation used to compute the position
+                const double elevationConvergence = 1.0;
+
+                std::vector<double> elevations(count, default_elevation_);
+                inverse(dst, src, elevations.data(), count);
+
+                std::vector<std::size_t> indices;
+                std::vector<double> lat;
+                std::vector<double> lng;
+                std::vector<double> sampled;
+                std::vector<math::PointD> refineSrc;
+                std::vector<core::GeoPoint> refineDst;
+                std::vector<double> refineElevations;
+
+                TAK::Engine::Elevation::ElevationSource::QueryParameters params;
+                for (std::size_t pass = 0u; pass < maxPasses; pass++) {
+                    // sample the terrain at all valid positions
+                    indices.clear();
+                    lat.clear();
+                    lng.clear();
+                    for (std::size_t i = 0u; i < count; i++) {
+                        if (std::isnan(dst[i].latitude) || std::isnan(dst[i].longitude))
+                            continue;
+                        indices.push_back(i);
+                        lat.push_back(dst[i].latitude);
+                        lng.push_back(dst[i].longitude);
+                    }
+                    if (indices.empty())
+                        break;
+                    sampled.assign(indices.size(), NAN);
+                    const TAK::Engine::Util::TAKErr code = TAK::Engine::Elevation::ElevationManager_getElevation(
+                        sampled.data(), indices.size(), lat.data(), lng.data(), 1u, 1u, 1u, params);
+                    if (code != TAK::Engine::Util::TE_Ok && code != TAK::Engine::Util::TE_Done)
+                        break;
+
+                    // recompute the positions whose elevation has changed
+                    refineSrc.clear();
+                    refineElevations.clear();
+                    std::size_t numRefined = 0u;
+                    for (std::size_t j = 0u; j < indices.size(); j++) {
+                        if (std::isnan(sampled[j]) || fabs(sampled[j] - elevations[indices[j]]) <= elevationConvergence)
+                            continue;
+                        indices[numRefined++] = indices[j];
+                        refineSrc.push_back(src[indices[j]]);
+                        refineElevations.push_back(sampled[j]);
+                    }
+                    if (!numRefined)
+                        break;
+                    refineDst.resize(numRefined);
+                    inverse(refineDst.data(), refineSrc.data(), refineElevations.data(), numRefined);
+                    for (std::size_t j = 0u; j < numRefined; j++) {
+                        if (std::isnan(refineDst[j].latitude) || std::isnan(refineDst[j].longitude))
+                            continue;
+                        dst[indices[j]] = refineDst[j];
+                        elevations[indices[j]] = refineElevations[j];
+                    }
+                }
+
+                for (std::size_t i = 0u; i < count; i++) {
+                    dst[i].altitude = elevations[i];
+                    dst[i].altitudeRef = core::AltitudeReference::HAE;
+                }
+            }
         }
     }
 }
@@ -4,6 +4,7 @@
 #include "math/Point.h"
 #include "gdal_priv.h"
 #include "core/GeoPoint.h"
+#include <cstddef>
 #include <vector>
 #include <stdexcept>
 
@@ -22,6 +23,35 @@ namespace atakmap {
                 core::GeoPoint inverse(const math::PointD &p) throw (std::invalid_argument);
                 core::GeoPoint inverse(const math::PointD point, const double elevation) throw (std::invalid_argument);
 
+                /**
+                 * Batch forward. If `elevations` is `nullptr`, the default
+                 * elevation is used for all points.
+                 */
+                void forward(math::PointD *dst, const core::GeoPoint *src, const double *elevations, const std::size_t count);
+                /**
+                 * Batch inverse. The Newton iterations for all points are
+                 * stepped together, with the polynomial terms for each point
+                 * evaluated once per iteration and shared across the four
+                 * coefficient sets. Points whose ground position cannot be
+                 * computed are returned with `NaN` latitude and longitude
+                 * rather than raising an exception.
+                 *
+                 * If `elevations` is `nullptr`, the default elevation is
+                 * used for all points.
+                 */
+                void inverse(core::GeoPoint *dst, const math::PointD *src, const double *elevations, const std::size_t count);
+                /**
+                 * Batch inverse against the terrain. The ground positions are
+                 * computed at the default elevation, then repeatedly refined
+                 * using elevations sampled for all points in a single
+                 * `ElevationManager` query per pass. Points without terrain
+                 * retain the default elevation. The elevation used for each
+                 * point is returned as its HAE altitude.
+                 *
+                 * @param maxPasses The maximum number of refinement passes
+                 */
+                void inverseOnTerrain(core::GeoPoint *dst, const math::PointD *src, const std::size_t count, const std::size_t maxPasses = 3u);
+
                 static const int numCoeffs = 20;
             private:
                 double line_num_coeff_[numCoeffs];
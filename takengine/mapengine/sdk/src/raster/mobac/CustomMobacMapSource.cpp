@@ -1,6 +1,7 @@
 #include "raster/mobac/CustomMobacMapSource.h"
 
 #include <sstream>
+#include <vector>
 
 #include "util/HttpClient.h"
 
@@ -202,6 +203,19 @@ bool CustomMobacMapSource::loadTile(MobacMapTile *tile, int zoom, int x, int y/*
     return retval;
 }
 
+bool CustomMobacMapSource::getTileUrl(std::string *urlOut, int zoom, int x, int y)
+{
+    if (this->authFailed)
+        return false;
+    if (this->invertYCoordinate)
+        y = ((1 << zoom) - 1) - y;
+
+    std::vector<char> url(getUrl(NULL, zoom, x, y) + 1);
+    getUrl(url.data(), zoom, x, y);
+    *urlOut = url.data();
+    return true;
+}
+
 namespace
 {
     std::string replaceFirst(std::string &s, std::string oldVal, std::string newVal)
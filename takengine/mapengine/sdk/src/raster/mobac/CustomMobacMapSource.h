@@ -25,6 +25,7 @@ namespace atakmap {
                 virtual void clearAuthFailed();
                 virtual void checkConnectivity();
                 virtual bool loadTile(MobacMapTile *tile, int zoom, int x, int y/*, Options opts*/) /*throws IOException*/;
+                virtual bool getTileUrl(std::string *url, int zoom, int x, int y);
             private :
                 //AsynchronousInetAddressResolver ^ dnsCheck;
             protected :
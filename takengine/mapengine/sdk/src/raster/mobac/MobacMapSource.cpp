@@ -6,4 +6,9 @@ MobacMapSource::Config::Config() :
     dnsLookupTimeout(1L)
 {}
 
-MobacMapSource::~MobacMapSource() { }
\ No newline at end of file
+MobacMapSource::~MobacMapSource() { }
+
+bool MobacMapSource::getTileUrl(std::string *url, int zoom, int x, int y)
+{
+    return false;
+}
@@ -1,6 +1,8 @@
 #ifndef ATAKMAP_RASTER_MOBAC_MOBACMAPSOURCE_H_INCLUDED
 #define ATAKMAP_RASTER_MOBAC_MOBACMAPSOURCE_H_INCLUDED
 
+#include <string>
+
 namespace atakmap {
     namespace feature {
         class Envelope;
@@ -22,6 +24,13 @@ namespace atakmap {
                 virtual const char *getTileType() = 0;
                 virtual int getTileSize() = 0;
                 virtual bool loadTile(MobacMapTile *tile, int zoom, int x, int y/*, BitmapFactory.Options opts */) /*throws IOException*/ = 0;
+                /**
+                 * Obtains the URL for the tile, allowing the tile to be
+                 * fetched asynchronously rather than through `loadTile`.
+                 * Returns false if the source does not load tiles from a
+                 * URL.
+                 */
+                virtual bool getTileUrl(std::string *url, int zoom, int x, int y);
                 virtual void checkConnectivity() = 0;
                 virtual void setConfig(MobacMapSource::Config c) = 0;
                 virtual void clearAuthFailed() = 0;
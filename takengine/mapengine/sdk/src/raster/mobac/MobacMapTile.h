@@ -2,6 +2,7 @@
 #define ATAKMAP_RASTER_MOBAC_MOBACMAPTILE_H_INCLUDED
 
 #include <cstdint>
+#include <string>
 
 #include "renderer/Bitmap.h"
 
@@ -17,6 +18,9 @@ namespace atakmap {
                 uint8_t *data;
                 size_t dataLength;
                 int64_t expiration;
+                /** cache validators from the response, empty if none */
+                std::string etag;
+                std::string lastModified;
 
                 void (*releaseData)(MobacMapTile tile);
             };
@@ -1,6 +1,8 @@
 #include "raster/mobac/MobacTileClient.h"
 
 #include <cinttypes>
+#include <map>
+#include <vector>
 
 #ifdef WIN32
 #include "private/Util.h"
@@ -20,6 +22,8 @@
 #include "thread/Lock.h"
 
 #include "renderer/BitmapFactory.h"
+#include "renderer/BitmapFactory2.h"
+#include "util/ConfigOptions.h"
 
 #ifdef WIN32
 #include "renderer/Bitmap_CLI.h"
@@ -36,6 +40,7 @@ using namespace atakmap::raster::osm;
 using namespace atakmap::renderer;
 using namespace atakmap::util;
 
+using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
@@ -61,6 +66,9 @@ namespace
         static int64_t currentTimeMillis();
     };
 
+    /** decodes the tile data and delivers it to the callback */
+    bool deliverTile(MobacTileClient::TileCallback &callback, const MobacTileClient::TileIndex &index, const uint8_t *data, const size_t dataLength);
+
     void releaseNativeImpl(atakmap::renderer::Bitmap b) {
 #ifdef WIN32
         delete[] b.data;
@@ -92,15 +100,53 @@ MobacTileClient::MobacTileClient(MobacMapSource *s, const char *offlineCachePath
     updateTileStmt(true),
     queryTileStmt(true)
 #endif
-    offlineCache(NULL)
+    offlineCache(NULL),
+    haveValidators(false)
 {
     // XXX - if not properly created in SPI, we'll fail
     if (offlineCachePath && pathExists(offlineCachePath))
         this->offlineCache = new SpatiaLiteDB(offlineCachePath);//Database::openDatabase(offlineCachePath);
+
+    // caches created before validators were recorded lack the table
+    if (this->offlineCache) {
+        try {
+            this->offlineCache->execute("CREATE TABLE IF NOT EXISTS ATAK_validators (key INTEGER PRIMARY KEY, etag TEXT, last_modified TEXT)");
+            this->haveValidators = true;
+        } catch (std::exception &e) {
+            Logger::log(Logger::Warning, "%s: Offline cache does not support validators, %s", TAG, e.what());
+        }
+    }
 }
 
+class MobacTileClient::TileBatch : public AsyncHttpClient::Callback
+{
+public :
+    struct Entry
+    {
+        TileIndex index;
+        bool haveCatalogEntry;
+        /** expired cache data, delivered if the download fails or the tile is unchanged */
+        std::vector<uint8_t> stale;
+        /** validators received with the response */
+        std::string etag;
+        std::string lastModified;
+    };
+public :
+    TileBatch(MobacTileClient &owner, MobacTileClient::TileCallback &callback);
+public :
+    void requestCompleted(const int64_t id, const TAKErr code, const int responseCode, const uint8_t *data, const std::size_t dataLen) NOTHROWS override;
+    void validatorsReceived(const int64_t id, const char *etag, const char *lastModified) NOTHROWS override;
+public :
+    MobacTileClient &owner;
+    MobacTileClient::TileCallback &callback;
+    std::map<int64_t, Entry> entries;
+    Mutex mutex;
+};
+
 MobacTileClient::~MobacTileClient()
 {
+    // outstanding downloads complete against the offline cache
+    this->downloader.reset();
     if(this->offlineCache)
         delete this->offlineCache;
 }
@@ -340,6 +386,202 @@ bool MobacTileClient::cacheTile(int zoom, int x, int y, MobacTileClient::Downloa
     return true;
 }
     
+void MobacTileClient::loadTiles(const TileIndex *tiles, size_t count, MobacTileClient::TileCallback &callback)
+{
+    std::unique_ptr<TileBatch> batch(new TileBatch(*this, callback));
+    std::vector<std::string> urls;
+    // validators for the cached data; expired tiles are revalidated
+    std::vector<std::pair<std::string, std::string>> validators;
+    const int64_t currentTimeMillis = SystemClock::currentTimeMillis();
+    for (size_t i = 0; i < count; i++) {
+        const TileIndex &index = tiles[i];
+        TileRecord record;
+        bool haveCatalogEntry;
+        {
+            TAKErr code(TE_Ok);
+            LockPtr lock(NULL, NULL);
+            code = Lock_create(lock, mutex);
+            if (code != TE_Ok)
+                throw std::runtime_error("MobacTileClient::loadTiles: Failed to acquire mutex");
+            haveCatalogEntry = this->checkTile(index.zoom, index.x, index.y, &record);
+        }
+
+        // cached tiles are delivered immediately
+        std::string url;
+        if (this->offlineMode || !this->mapSource || currentTimeMillis <= record.expiration) {
+            if (!record.data || !deliverTile(callback, index, record.data, record.dataLength))
+                callback.tileLoadFailed(index.zoom, index.x, index.y, "Tile not available");
+            continue;
+        }
+
+        // sources that do not load from a URL are loaded synchronously
+        if (!this->mapSource->getTileUrl(&url, index.zoom, index.x, index.y)) {
+            MobacMapTile tile;
+            MobacMapTileCleaner tileCleaner(&tile);
+            bool loaded = false;
+            try {
+                loaded = this->mapSource->loadTile(&tile, index.zoom, index.x, index.y) && tile.dataLength &&
+                         deliverTile(callback, index, tile.data, tile.dataLength);
+            } catch (std::exception &e) {
+                Logger::log(Logger::Error, "%s: IO Error during tile download, %s (%d, %d, %d)", TAG, this->mapSource->getName(), index.zoom, index.x, index.y);
+            }
+            if (!loaded && !(record.data && deliverTile(callback, index, record.data, record.dataLength)))
+                callback.tileLoadFailed(index.zoom, index.x, index.y, "Failed to load tile");
+            continue;
+        }
+
+        TileBatch::Entry entry;
+        entry.index = index;
+        entry.haveCatalogEntry = haveCatalogEntry;
+        if (record.data)
+            entry.stale.assign(record.data, record.data + record.dataLength);
+        // key is assigned on submit
+        batch->entries.insert(std::make_pair(-(int64_t)urls.size() - 1LL, entry));
+        urls.push_back(url);
+        if (record.data)
+            validators.push_back(std::make_pair(record.etag, record.lastModified));
+        else
+            validators.push_back(std::make_pair(std::string(), std::string()));
+    }
+
+    if (urls.empty())
+        return;
+
+    {
+        TAKErr code(TE_Ok);
+        LockPtr lock(NULL, NULL);
+        code = Lock_create(lock, mutex);
+        if (code != TE_Ok)
+            throw std::runtime_error("MobacTileClient::loadTiles: Failed to acquire mutex");
+        if (!this->downloader) {
+            AsyncHttpClient::Options opts;
+            opts.maxHostConnections = (std::size_t)ConfigOptions_getIntOptionOrDefault("mobac.max-host-connections", 6);
+            opts.connectTimeout = 3000LL;
+            this->downloader.reset(new AsyncHttpClient(opts));
+        }
+    }
+
+    std::vector<const char *> curls;
+    std::vector<AsyncHttpClient::Validators> cvalidators(urls.size());
+    curls.reserve(urls.size());
+    for (size_t i = 0; i < urls.size(); i++) {
+        curls.push_back(urls[i].c_str());
+        if (!validators[i].first.empty())
+            cvalidators[i].etag = validators[i].first.c_str();
+        if (!validators[i].second.empty())
+            cvalidators[i].lastModified = validators[i].second.c_str();
+    }
+    std::vector<int64_t> ids(urls.size());
+
+    // completions are held off until the entries are keyed by request ID
+    TAKErr code(TE_Ok);
+    LockPtr batchLock(NULL, NULL);
+    code = Lock_create(batchLock, batch->mutex);
+    if (code != TE_Ok)
+        throw std::runtime_error("MobacTileClient::loadTiles: Failed to acquire mutex");
+    code = this->downloader->submit(ids.data(), curls.data(), cvalidators.data(), curls.size(), *batch);
+    std::map<int64_t, TileBatch::Entry> keyed;
+    std::vector<TileBatch::Entry> failed;
+    for (size_t i = 0; i < ids.size(); i++) {
+        TileBatch::Entry &entry = batch->entries[-(int64_t)i - 1LL];
+        if (ids[i])
+            keyed[ids[i]] = std::move(entry);
+        else
+            failed.push_back(std::move(entry));
+    }
+    batch->entries.swap(keyed);
+    if (code != TE_Ok) {
+        // any downloads that were queued hold a reference to the batch;
+        // cancel them and let the batch be deleted on their completion
+        for (auto &entry : batch->entries)
+            this->downloader->cancel(entry.first);
+    }
+    const bool queued = !batch->entries.empty();
+    batchLock.reset();
+    // the batch deletes itself once all downloads have completed
+    if (queued)
+        batch.release();
+
+    for (auto &entry : failed) {
+        const TileIndex &index = entry.index;
+        if (entry.stale.empty() || !deliverTile(callback, index, entry.stale.data(), entry.stale.size()))
+            callback.tileLoadFailed(index.zoom, index.x, index.y, "Failed to submit tile download");
+    }
+}
+
+MobacTileClient::TileBatch::TileBatch(MobacTileClient &owner_, MobacTileClient::TileCallback &callback_) :
+    owner(owner_),
+    callback(callback_)
+{}
+
+void MobacTileClient::TileBatch::requestCompleted(const int64_t id, const TAKErr code, const int responseCode, const uint8_t *data, const std::size_t dataLen) NOTHROWS
+{
+    Entry entry;
+    bool done;
+    {
+        Lock lock(mutex);
+        auto it = entries.find(id);
+        if (it == entries.end())
+            return;
+        entry = std::move(it->second);
+        entries.erase(it);
+        done = entries.empty();
+    }
+
+    const TileIndex &index = entry.index;
+    bool delivered = false;
+    if (code == TE_Ok && data && deliverTile(callback, index, data, dataLen)) {
+        delivered = true;
+        // update cache with downloaded data
+        MobacMapTile tile;
+        tile.data = const_cast<uint8_t *>(data);
+        tile.dataLength = dataLen;
+        tile.etag = entry.etag;
+        tile.lastModified = entry.lastModified;
+        Lock lock(owner.mutex);
+        if (owner.offlineCache) {
+            try {
+                owner.updateCache(OSMUtils::getOSMDroidSQLiteIndex(index.zoom, index.x, index.y), &tile, entry.haveCatalogEntry);
+            } catch (std::exception &e) {
+                Logger::log(Logger::Error, "Exception occurred updating cache, message=%s", e.what());
+            }
+        }
+    } else if (code == TE_Done) {
+        // not modified; the cached tile is delivered below
+        Lock lock(owner.mutex);
+        if (owner.offlineCache) {
+            try {
+                owner.refreshCache(OSMUtils::getOSMDroidSQLiteIndex(index.zoom, index.x, index.y),
+                                   entry.etag.empty() ? nullptr : entry.etag.c_str(),
+                                   entry.lastModified.empty() ? nullptr : entry.lastModified.c_str());
+            } catch (std::exception &e) {
+                Logger::log(Logger::Error, "Exception occurred updating cache, message=%s", e.what());
+            }
+        }
+    } else if (code != TE_Canceled) {
+        if (responseCode == 401)
+            Logger::log(Logger::Error, "%s: Not authorized, %s (%d, %d, %d)", TAG, owner.mapSource->getName(), index.zoom, index.x, index.y);
+        else
+            Logger::log(Logger::Error, "%s: IO Error during tile download, %s (%d, %d, %d)", TAG, owner.mapSource->getName(), index.zoom, index.x, index.y);
+    }
+
+    if (!delivered && !(entry.stale.size() && deliverTile(callback, index, entry.stale.data(), entry.stale.size())))
+        callback.tileLoadFailed(index.zoom, index.x, index.y, code == TE_Canceled ? "Tile download canceled" : "Tile download failed");
+
+    if (done)
+        delete this;
+}
+
+void MobacTileClient::TileBatch::validatorsReceived(const int64_t id, const char *etag, const char *lastModified) NOTHROWS
+{
+    Lock lock(mutex);
+    auto it = entries.find(id);
+    if (it == entries.end())
+        return;
+    it->second.etag = etag ? etag : "";
+    it->second.lastModified = lastModified ? lastModified : "";
+}
+
 // should always be invoked while holding lock on 'this'
 bool MobacTileClient::checkTile(int zoom, int x, int y, TileRecord *record)
 {
@@ -348,9 +590,12 @@ bool MobacTileClient::checkTile(int zoom, int x, int y, TileRecord *record)
     // query cache for expiration of target tile
     if (this->offlineCache) {
         try {
-            char sql[181];
-            sprintf(sql, "SELECT ATAK_catalog.expiration, tiles.tile FROM ATAK_catalog LEFT JOIN tiles ON ATAK_catalog.key = tiles.key WHERE ATAK_catalog.key = %" PRId64, tileIndex);
-            std::auto_ptr<Cursor> result(offlineCache->query(sql));
+            char sql[320];
+            if (this->haveValidators)
+                sprintf(sql, "SELECT ATAK_catalog.expiration, tiles.tile, ATAK_validators.etag, ATAK_validators.last_modified FROM ATAK_catalog LEFT JOIN tiles ON ATAK_catalog.key = tiles.key LEFT JOIN ATAK_validators ON ATAK_catalog.key = ATAK_validators.key WHERE ATAK_catalog.key = %" PRId64, tileIndex);
+            else
+                sprintf(sql, "SELECT ATAK_catalog.expiration, tiles.tile FROM ATAK_catalog LEFT JOIN tiles ON ATAK_catalog.key = tiles.key WHERE ATAK_catalog.key = %" PRId64, tileIndex);
+            std::unique_ptr<Cursor> result(offlineCache->query(sql));
                
             // if we have an entry and it's not expired, return
             if (!result->moveToNext())
@@ -361,6 +606,12 @@ bool MobacTileClient::checkTile(int zoom, int x, int y, TileRecord *record)
             record->dataLength = (data.second - data.first);
             record->data = new uint8_t[record->dataLength];
             memcpy(record->data, data.first, record->dataLength);
+            if (this->haveValidators) {
+                if (!result->isNull(2))
+                    record->etag = result->getString(2);
+                if (!result->isNull(3))
+                    record->lastModified = result->getString(3);
+            }
 
             return true;
         } catch (std::exception &e) {
@@ -381,14 +632,14 @@ void MobacTileClient::updateCache(int64_t index, MobacMapTile *tile, bool update
         expiration = tile->expiration;
 
     if (update) {
-        std::auto_ptr<Statement> updateTileStmt(this->offlineCache->compileStatement("UPDATE tiles SET tile = ? WHERE key = ?"));
+        std::unique_ptr<Statement> updateTileStmt(this->offlineCache->compileStatement("UPDATE tiles SET tile = ? WHERE key = ?"));
         updateTileStmt->clearBindings();
         updateTileStmt->bind(1, Statement::Blob(tile->data, tile->data+tile->dataLength));
         updateTileStmt->bind(2, static_cast<int64_t>(index));
         updateTileStmt->execute();
         updateTileStmt.reset(NULL);
 
-        std::auto_ptr<Statement> updateCatalogStmt(this->offlineCache->compileStatement("UPDATE ATAK_catalog SET access = ?, expiration = ?, size = ? WHERE key = ?"));
+        std::unique_ptr<Statement> updateCatalogStmt(this->offlineCache->compileStatement("UPDATE ATAK_catalog SET access = ?, expiration = ?, size = ? WHERE key = ?"));
         updateCatalogStmt->clearBindings();
         updateCatalogStmt->bind(1, static_cast<int64_t>(currentTimeMillis));
         updateCatalogStmt->bind(2, static_cast<int64_t>(expiration));
@@ -397,7 +648,7 @@ void MobacTileClient::updateCache(int64_t index, MobacMapTile *tile, bool update
         updateCatalogStmt->execute();
         updateCatalogStmt.reset(NULL);
     } else {
-        std::auto_ptr<Statement> insertTileStmt(this->offlineCache->compileStatement("INSERT INTO tiles(key, provider, tile) VALUES(?, ?, ?)"));
+        std::unique_ptr<Statement> insertTileStmt(this->offlineCache->compileStatement("INSERT INTO tiles(key, provider, tile) VALUES(?, ?, ?)"));
         insertTileStmt->clearBindings();
         insertTileStmt->bind(1, static_cast<int64_t>(index));
         insertTileStmt->bind(2, this->mapSource->getName());
@@ -405,7 +656,7 @@ void MobacTileClient::updateCache(int64_t index, MobacMapTile *tile, bool update
         insertTileStmt->execute();
         insertTileStmt.reset(NULL);
 
-        std::auto_ptr<Statement> insertCatalogStmt(this->offlineCache->compileStatement("INSERT INTO ATAK_catalog(key, access, expiration, size) VALUES(?, ?, ?, ?)"));
+        std::unique_ptr<Statement> insertCatalogStmt(this->offlineCache->compileStatement("INSERT INTO ATAK_catalog(key, access, expiration, size) VALUES(?, ?, ?, ?)"));
         insertCatalogStmt->clearBindings();
         insertCatalogStmt->bind(1, static_cast<int64_t>(index));
         insertCatalogStmt->bind(2, static_cast<int64_t>(currentTimeMillis));
@@ -414,6 +665,54 @@ void MobacTileClient::updateCache(int64_t index, MobacMapTile *tile, bool update
         insertCatalogStmt->execute();
         insertCatalogStmt.reset(NULL);
     }
+
+    // validators describe the previous content, if any
+    this->updateValidators(index,
+                           tile->etag.empty() ? NULL : tile->etag.c_str(),
+                           tile->lastModified.empty() ? NULL : tile->lastModified.c_str());
+}
+
+// should always be invoked while holding lock on 'this'
+void MobacTileClient::refreshCache(int64_t index, const char *etag, const char *lastModified)
+{
+    const int64_t currentTimeMillis = SystemClock::currentTimeMillis();
+
+    std::unique_ptr<Statement> updateCatalogStmt(this->offlineCache->compileStatement("UPDATE ATAK_catalog SET access = ?, expiration = ? WHERE key = ?"));
+    updateCatalogStmt->bind(1, static_cast<int64_t>(currentTimeMillis));
+    updateCatalogStmt->bind(2, static_cast<int64_t>(currentTimeMillis + ONE_WEEK_MILLIS));
+    updateCatalogStmt->bind(3, static_cast<int64_t>(index));
+    updateCatalogStmt->execute();
+    updateCatalogStmt.reset(NULL);
+
+    // a 304 may carry updated validators; otherwise the recorded ones remain valid
+    if (etag || lastModified)
+        this->updateValidators(index, etag, lastModified);
+}
+
+// should always be invoked while holding lock on 'this'
+void MobacTileClient::updateValidators(int64_t index, const char *etag, const char *lastModified)
+{
+    if (!this->haveValidators)
+        return;
+
+    if (!etag && !lastModified) {
+        std::unique_ptr<Statement> deleteStmt(this->offlineCache->compileStatement("DELETE FROM ATAK_validators WHERE key = ?"));
+        deleteStmt->bind(1, static_cast<int64_t>(index));
+        deleteStmt->execute();
+        return;
+    }
+
+    std::unique_ptr<Statement> upsertStmt(this->offlineCache->compileStatement("INSERT OR REPLACE INTO ATAK_validators(key, etag, last_modified) VALUES(?, ?, ?)"));
+    upsertStmt->bind(1, static_cast<int64_t>(index));
+    if (etag)
+        upsertStmt->bind(2, etag);
+    else
+        upsertStmt->bindNULL(2);
+    if (lastModified)
+        upsertStmt->bind(3, lastModified);
+    else
+        upsertStmt->bindNULL(3);
+    upsertStmt->execute();
 }
 
 MobacTileClient::TileRecord::TileRecord() :
@@ -433,6 +732,19 @@ MobacTileClient::TileRecord::~TileRecord()
 
 namespace
 {
+    bool deliverTile(MobacTileClient::TileCallback &callback, const MobacTileClient::TileIndex &index, const uint8_t *data, const size_t dataLength)
+    {
+        BitmapPtr decoded(NULL, NULL);
+        if (BitmapFactory2_decode(decoded, data, dataLength, NULL) != TE_Ok || !decoded.get())
+            return false;
+        // XXX - resize to 256x256, consistent with loadTile
+        if (decoded->getWidth() != 256 || decoded->getHeight() != 256)
+            callback.tileLoaded(index.zoom, index.x, index.y, Bitmap2(*decoded, 256, 256));
+        else
+            callback.tileLoaded(index.zoom, index.x, index.y, *decoded);
+        return true;
+    }
+
     MobacMapTileCleaner::MobacMapTileCleaner(MobacMapTile *tile_) :
         tile(tile_)
     {
@@ -2,9 +2,13 @@
 #define ATAKMAP_RASTER_MOBAC_MOBACTILECLIENT_H_INCLUDED
 
 #include <cstdint>
+#include <memory>
 #include <set>
+#include <string>
 
+#include "renderer/Bitmap2.h"
 #include "thread/Mutex.h"
+#include "util/AsyncHttpClient.h"
 
 namespace atakmap {
     namespace db {
@@ -31,9 +35,22 @@ namespace atakmap {
                     int64_t expiration;
                     uint8_t *data;
                     size_t dataLength;
+                    /** cache validators for `data`, empty if none */
+                    std::string etag;
+                    std::string lastModified;
                 };
             public :
                 class DownloadErrorCallback;
+                class TileCallback;
+
+                struct TileIndex
+                {
+                    int zoom;
+                    int x;
+                    int y;
+                };
+            private :
+                class TileBatch;
             private :
                 //static MobacTileClient();
             public :
@@ -45,10 +62,27 @@ namespace atakmap {
                 void close();
                 bool loadTile(atakmap::renderer::Bitmap *tile, int zoom, int x, int y/*, BitmapFactory.Options opts*/, MobacTileClient::DownloadErrorCallback *callback);
                 bool cacheTile(int zoom, int x, int y, MobacTileClient::DownloadErrorCallback *callback);
+                /**
+                 * Loads the specified tiles without blocking on the network.
+                 * Tiles that must be downloaded are requested concurrently
+                 * and delivered as each download completes; cached tiles are
+                 * delivered before this method returns. The callback is
+                 * invoked exactly once per tile and must remain valid until
+                 * every tile has been delivered.
+                 *
+                 * <P>Expired tiles with cache validators are revalidated
+                 * with a conditional request; if the tile has not changed,
+                 * the cached tile is delivered and its expiration extended
+                 * without rewriting the cached data.
+                 */
+                void loadTiles(const TileIndex *tiles, size_t count, MobacTileClient::TileCallback &callback);
             private :
                 /** library allocates record->data, caller must free */
                 bool checkTile(int zoom, int x, int y, TileRecord *record);
                 void updateCache(int64_t index, MobacMapTile *tile, bool update);
+                /** extends the expiration of an unchanged cached tile */
+                void refreshCache(int64_t index, const char *etag, const char *lastModified);
+                void updateValidators(int64_t index, const char *etag, const char *lastModified);
             public :
 #if 0
                 static const char *TAG = "MobacTileClient";
@@ -61,6 +95,8 @@ namespace atakmap {
             private :
                 MobacMapSource *mapSource;
                 atakmap::db::Database *offlineCache;
+                /** true if the offline cache can record cache validators */
+                bool haveValidators;
 #if 0
                 System::Threading::ThreadLocal<atakmap::db::Statement ^> updateAccessStmt;
                 System::Threading::ThreadLocal<atakmap::db::Statement ^> updateCatalogStmt;
@@ -75,6 +111,8 @@ namespace atakmap {
                 std::set<int64_t> pendingCacheUpdates;
 
                 TAK::Engine::Thread::Mutex mutex;
+                /** lazily created on the first call to `loadTiles` */
+                std::unique_ptr<TAK::Engine::Util::AsyncHttpClient> downloader;
             };
 
             class MobacTileClient::DownloadErrorCallback
@@ -82,6 +120,15 @@ namespace atakmap {
             public:
                 virtual void tileDownloadError(int zoom, int x, int y, const char *msg) = 0;
             };
+
+            class MobacTileClient::TileCallback
+            {
+            public:
+                virtual ~TileCallback() {}
+                /** invoked with the decoded tile, resized to 256x256 */
+                virtual void tileLoaded(int zoom, int x, int y, const TAK::Engine::Renderer::Bitmap2 &tile) = 0;
+                virtual void tileLoadFailed(int zoom, int x, int y, const char *msg) = 0;
+            };
         }
     }
 }
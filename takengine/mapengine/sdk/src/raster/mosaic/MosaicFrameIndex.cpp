@@ -0,0 +1,422 @@
+#include "raster/mosaic/MosaicFrameIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Raster::Mosaic;
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    typedef std::vector<MosaicDatabase2::Frame> FrameVector;
+
+    double getGsd(const MosaicDatabase2::Frame &frame, const MosaicDatabase2::QueryParameters::GsdCompare compare) NOTHROWS
+    {
+        return (compare == MosaicDatabase2::QueryParameters::MinimumGsd) ? frame.minGsd : frame.maxGsd;
+    }
+
+    bool accept(const MosaicDatabase2::Frame &frame, const MosaicDatabase2::QueryParameters &params) NOTHROWS
+    {
+        if (params.path && strcmp(params.path, frame.path) != 0)
+            return false;
+        if (!std::isnan(params.minGsd) && !(getGsd(frame, params.minGsdCompare) <= params.minGsd))
+            return false;
+        if (!std::isnan(params.maxGsd) && !(getGsd(frame, params.maxGsdCompare) >= params.maxGsd))
+            return false;
+        if (params.srid != -1 && params.srid != frame.srid)
+            return false;
+        if (params.imagery == MosaicDatabase2::QueryParameters::PreciseImagery && !frame.precisionImagery)
+            return false;
+        if (params.imagery == MosaicDatabase2::QueryParameters::ImpreciseImagery && frame.precisionImagery)
+            return false;
+        if (params.types.get()) {
+            bool contains = false;
+            TAK::Engine::Port::String type(frame.type);
+            if (params.types->contains(&contains, type) != TE_Ok || !contains)
+                return false;
+        }
+        return true;
+    }
+
+    class FrameCursor : public MosaicDatabase2::Cursor
+    {
+    public :
+        FrameCursor(const std::shared_ptr<const FrameVector> &frames, std::vector<std::size_t> &&selected) NOTHROWS;
+        ~FrameCursor() NOTHROWS override;
+    public : // MosaicDatabase2::Cursor
+        TAKErr getUpperLeft(GeoPoint2 *value) NOTHROWS override;
+        TAKErr getUpperRight(GeoPoint2 *value) NOTHROWS override;
+        TAKErr getLowerRight(GeoPoint2 *value) NOTHROWS override;
+        TAKErr getLowerLeft(GeoPoint2 *value) NOTHROWS override;
+        TAKErr getMinLat(double *value) NOTHROWS override;
+        TAKErr getMinLon(double *value) NOTHROWS override;
+        TAKErr getMaxLat(double *value) NOTHROWS override;
+        TAKErr getMaxLon(double *value) NOTHROWS override;
+        TAKErr getPath(const char **value) NOTHROWS override;
+        TAKErr getType(const char **value) NOTHROWS override;
+        TAKErr getMinGSD(double *value) NOTHROWS override;
+        TAKErr getMaxGSD(double *value) NOTHROWS override;
+        TAKErr getWidth(int *value) NOTHROWS override;
+        TAKErr getHeight(int *value) NOTHROWS override;
+        TAKErr getId(int *value) NOTHROWS override;
+        TAKErr getSrid(int *value) NOTHROWS override;
+        TAKErr isPrecisionImagery(bool *value) NOTHROWS override;
+    public : // RowIterator
+        TAKErr moveToNext() NOTHROWS override;
+    private :
+        const MosaicDatabase2::Frame &row() const NOTHROWS;
+    private :
+        std::shared_ptr<const FrameVector> frames;
+        std::vector<std::size_t> selected;
+        std::size_t pos;
+    };
+
+    class IndexedMosaicDatabase2 : public MosaicDatabase2
+    {
+    public :
+        IndexedMosaicDatabase2(MosaicDatabase2Ptr &&impl) NOTHROWS;
+        ~IndexedMosaicDatabase2() NOTHROWS override;
+    public :
+        const char *getType() NOTHROWS override;
+        TAKErr open(const char *path) NOTHROWS override;
+        TAKErr close() NOTHROWS override;
+        TAKErr getCoverage(std::shared_ptr<const Coverage> &value) NOTHROWS override;
+        TAKErr getCoverages(TAK::Engine::Port::Collection<std::pair<TAK::Engine::Port::String, std::shared_ptr<const Coverage>>> &coverages) NOTHROWS override;
+        TAKErr getCoverage(std::shared_ptr<const Coverage> &value, const char *type) NOTHROWS override;
+        TAKErr query(CursorPtr &value, const QueryParameters &params) NOTHROWS override;
+    private :
+        MosaicDatabase2Ptr impl;
+        MosaicFrameIndex index;
+    };
+}
+
+MosaicFrameIndex::Selection::Selection() NOTHROWS
+{}
+
+void MosaicFrameIndex::Selection::clear() NOTHROWS
+{
+    frames.clear();
+    generation.reset();
+}
+
+MosaicFrameIndex::MosaicFrameIndex() NOTHROWS :
+    frames(std::make_shared<FrameVector>())
+{}
+
+MosaicFrameIndex::~MosaicFrameIndex() NOTHROWS
+{}
+
+TAKErr MosaicFrameIndex::build(MosaicDatabase2 &database) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    MosaicDatabase2::CursorPtr result(nullptr, nullptr);
+    code = database.query(result, MosaicDatabase2::QueryParameters());
+    TE_CHECKRETURN_CODE(code);
+    return build(*result);
+}
+
+TAKErr MosaicFrameIndex::build(MosaicDatabase2::Cursor &cursor) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    std::shared_ptr<FrameVector> built(std::make_shared<FrameVector>());
+    std::vector<PackedRTree<std::size_t>::Bounds> bounds;
+    do {
+        code = cursor.moveToNext();
+        TE_CHECKBREAK_CODE(code);
+
+        MosaicDatabase2::FramePtr_const frame(nullptr, nullptr);
+        code = MosaicDatabase2::Frame::createFrame(frame, cursor);
+        TE_CHECKBREAK_CODE(code);
+
+        PackedRTree<std::size_t>::Bounds mbr;
+        mbr.minX = frame->minLon;
+        mbr.minY = frame->minLat;
+        mbr.maxX = frame->maxLon;
+        mbr.maxY = frame->maxLat;
+        bounds.push_back(mbr);
+        built->push_back(*frame);
+    } while (true);
+    if (code == TE_Done)
+        code = TE_Ok;
+    TE_CHECKRETURN_CODE(code);
+
+    std::vector<std::size_t> ids;
+    ids.reserve(built->size());
+    for (std::size_t i = 0u; i < built->size(); i++)
+        ids.push_back(i);
+    code = footprints.load(ids.empty() ? nullptr : &ids[0], bounds.empty() ? nullptr : &bounds[0], ids.size());
+    TE_CHECKRETURN_CODE(code);
+
+    frames = built;
+    return code;
+}
+
+TAKErr MosaicFrameIndex::query(std::vector<const MosaicDatabase2::Frame *> &value, const MosaicDatabase2::QueryParameters &params) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    std::vector<std::size_t> selected;
+    code = queryImpl(selected, params);
+    TE_CHECKRETURN_CODE(code);
+    value.reserve(value.size() + selected.size());
+    for (auto it = selected.begin(); it != selected.end(); it++)
+        value.push_back(&(*frames)[*it]);
+    return code;
+}
+
+TAKErr MosaicFrameIndex::queryDelta(std::vector<const MosaicDatabase2::Frame *> &entering, std::vector<const MosaicDatabase2::Frame *> &leaving, Selection &selection, const MosaicDatabase2::QueryParameters &params) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    std::vector<std::size_t> selected;
+    code = queryImpl(selected, params);
+    TE_CHECKRETURN_CODE(code);
+
+    // frames from a previous build are not comparable
+    if (selection.generation != frames)
+        selection.frames.clear();
+
+    std::unordered_set<std::size_t> current(selected.begin(), selected.end());
+    for (auto it = selected.begin(); it != selected.end(); it++) {
+        if (selection.frames.find(*it) == selection.frames.end())
+            entering.push_back(&(*frames)[*it]);
+    }
+    for (auto it = selection.frames.begin(); it != selection.frames.end(); it++) {
+        if (current.find(*it) == current.end())
+            leaving.push_back(&(*frames)[*it]);
+    }
+
+    selection.frames.swap(current);
+    selection.generation = frames;
+    return code;
+}
+
+TAKErr MosaicFrameIndex::query(MosaicDatabase2::CursorPtr &value, const MosaicDatabase2::QueryParameters &params) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    std::vector<std::size_t> selected;
+    code = queryImpl(selected, params);
+    TE_CHECKRETURN_CODE(code);
+    value = MosaicDatabase2::CursorPtr(new FrameCursor(frames, std::move(selected)), Memory_deleter_const<MosaicDatabase2::Cursor, FrameCursor>);
+    return code;
+}
+
+std::size_t MosaicFrameIndex::size() const NOTHROWS
+{
+    return frames->size();
+}
+
+void MosaicFrameIndex::clear() NOTHROWS
+{
+    frames = std::make_shared<FrameVector>();
+    footprints.clear();
+}
+
+TAKErr MosaicFrameIndex::queryImpl(std::vector<std::size_t> &value, const MosaicDatabase2::QueryParameters &params) const NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    const FrameVector &all = *frames;
+    if (params.spatialFilter.get()) {
+        Envelope2 mbb;
+        code = params.spatialFilter->getEnvelope(&mbb);
+        TE_CHECKRETURN_CODE(code);
+        footprints.visit(mbb.minX, mbb.minY, mbb.maxX, mbb.maxY, [&](const std::size_t &id)
+        {
+            if (accept(all[id], params))
+                value.push_back(id);
+            return true;
+        });
+    } else {
+        for (std::size_t i = 0u; i < all.size(); i++) {
+            if (accept(all[i], params))
+                value.push_back(i);
+        }
+    }
+
+    // order by the requested GSD, breaking ties by insertion order for
+    // stable results across queries
+    const MosaicDatabase2::QueryParameters::Order order = params.order;
+    std::sort(value.begin(), value.end(), [&](const std::size_t a, const std::size_t b)
+    {
+        double ga, gb;
+        bool desc;
+        switch (order) {
+        case MosaicDatabase2::QueryParameters::MinGsdAsc :
+            ga = all[a].minGsd; gb = all[b].minGsd; desc = false;
+            break;
+        case MosaicDatabase2::QueryParameters::MinGsdDesc :
+            ga = all[a].minGsd; gb = all[b].minGsd; desc = true;
+            break;
+        case MosaicDatabase2::QueryParameters::MaxGsdAsc :
+            ga = all[a].maxGsd; gb = all[b].maxGsd; desc = false;
+            break;
+        case MosaicDatabase2::QueryParameters::MaxGsdDesc :
+        default :
+            ga = all[a].maxGsd; gb = all[b].maxGsd; desc = true;
+            break;
+        }
+        if (ga != gb)
+            return desc ? (ga > gb) : (ga < gb);
+        return a < b;
+    });
+    return code;
+}
+
+TAKErr TAK::Engine::Raster::Mosaic::MosaicDatabase2_createIndexed(MosaicDatabase2Ptr &value, MosaicDatabase2Ptr &&impl) NOTHROWS
+{
+    if (!impl)
+        return TE_InvalidArg;
+    value = MosaicDatabase2Ptr(new IndexedMosaicDatabase2(std::move(impl)), Memory_deleter_const<MosaicDatabase2, IndexedMosaicDatabase2>);
+    return TE_Ok;
+}
+
+namespace
+{
+    FrameCursor::FrameCursor(const std::shared_ptr<const FrameVector> &frames_, std::vector<std::size_t> &&selected_) NOTHROWS :
+        frames(frames_),
+        selected(std::move(selected_)),
+        pos(0u)
+    {}
+    FrameCursor::~FrameCursor() NOTHROWS
+    {}
+    TAKErr FrameCursor::getUpperLeft(GeoPoint2 *value) NOTHROWS
+    {
+        *value = row().upperLeft;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getUpperRight(GeoPoint2 *value) NOTHROWS
+    {
+        *value = row().upperRight;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getLowerRight(GeoPoint2 *value) NOTHROWS
+    {
+        *value = row().lowerRight;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getLowerLeft(GeoPoint2 *value) NOTHROWS
+    {
+        *value = row().lowerLeft;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getMinLat(double *value) NOTHROWS
+    {
+        *value = row().minLat;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getMinLon(double *value) NOTHROWS
+    {
+        *value = row().minLon;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getMaxLat(double *value) NOTHROWS
+    {
+        *value = row().maxLat;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getMaxLon(double *value) NOTHROWS
+    {
+        *value = row().maxLon;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getPath(const char **value) NOTHROWS
+    {
+        *value = row().path;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getType(const char **value) NOTHROWS
+    {
+        *value = row().type;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getMinGSD(double *value) NOTHROWS
+    {
+        *value = row().minGsd;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getMaxGSD(double *value) NOTHROWS
+    {
+        *value = row().maxGsd;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getWidth(int *value) NOTHROWS
+    {
+        *value = row().width;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getHeight(int *value) NOTHROWS
+    {
+        *value = row().height;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getId(int *value) NOTHROWS
+    {
+        *value = row().id;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::getSrid(int *value) NOTHROWS
+    {
+        *value = row().srid;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::isPrecisionImagery(bool *value) NOTHROWS
+    {
+        *value = row().precisionImagery;
+        return TE_Ok;
+    }
+    TAKErr FrameCursor::moveToNext() NOTHROWS
+    {
+        if (pos >= selected.size())
+            return TE_Done;
+        pos++;
+        return TE_Ok;
+    }
+    const MosaicDatabase2::Frame &FrameCursor::row() const NOTHROWS
+    {
+        return (*frames)[selected[pos - 1u]];
+    }
+
+    IndexedMosaicDatabase2::IndexedMosaicDatabase2(MosaicDatabase2Ptr &&impl_) NOTHROWS :
+        impl(std::move(impl_))
+    {}
+    IndexedMosaicDatabase2::~IndexedMosaicDatabase2() NOTHROWS
+    {}
+    const char *IndexedMosaicDatabase2::getType() NOTHROWS
+    {
+        return impl->getType();
+    }
+    TAKErr IndexedMosaicDatabase2::open(const char *path) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = impl->open(path);
+        TE_CHECKRETURN_CODE(code);
+        code = index.build(*impl);
+        TE_CHECKRETURN_CODE(code);
+        return code;
+    }
+    TAKErr IndexedMosaicDatabase2::close() NOTHROWS
+    {
+        index.clear();
+        return impl->close();
+    }
+    TAKErr IndexedMosaicDatabase2::getCoverage(std::shared_ptr<const Coverage> &value) NOTHROWS
+    {
+        return impl->getCoverage(value);
+    }
+    TAKErr IndexedMosaicDatabase2::getCoverages(TAK::Engine::Port::Collection<std::pair<TAK::Engine::Port::String, std::shared_ptr<const Coverage>>> &coverages) NOTHROWS
+    {
+        return impl->getCoverages(coverages);
+    }
+    TAKErr IndexedMosaicDatabase2::getCoverage(std::shared_ptr<const Coverage> &value, const char *type) NOTHROWS
+    {
+        return impl->getCoverage(value, type);
+    }
+    TAKErr IndexedMosaicDatabase2::query(CursorPtr &value, const QueryParameters &params) NOTHROWS
+    {
+        return index.query(value, params);
+    }
+}
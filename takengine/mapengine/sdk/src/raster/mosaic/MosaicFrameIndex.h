@@ -0,0 +1,111 @@
+#ifndef TAK_ENGINE_RASTER_MOSAIC_MOSAICFRAMEINDEX_H_INCLUDED
+#define TAK_ENGINE_RASTER_MOSAIC_MOSAICFRAMEINDEX_H_INCLUDED
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "port/Platform.h"
+#include "raster/mosaic/MosaicDatabase2.h"
+#include "util/Error.h"
+#include "util/PackedRTree.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Raster {
+            namespace Mosaic {
+                /**
+                 * In-memory index of the frames of a mosaic database,
+                 * supporting spatial and GSD selection without querying the
+                 * database.
+                 *
+                 * <P>Queries are evaluated against the minimum bounding
+                 * rectangle of the frame footprint and of the spatial
+                 * filter. GSD constraints follow the database semantics:
+                 * `minGsd` selects frames whose compared GSD is less than or
+                 * equal to the value, `maxGsd` selects frames whose compared
+                 * GSD is greater than or equal to the value.
+                 *
+                 * <P>This class is not thread-safe.
+                 */
+                class ENGINE_API MosaicFrameIndex
+                {
+                public :
+                    /**
+                     * The frames returned by the previous query of a client;
+                     * used to compute the frames entering and leaving the
+                     * selection between successive queries.
+                     */
+                    class ENGINE_API Selection
+                    {
+                    public :
+                        Selection() NOTHROWS;
+                    public :
+                        void clear() NOTHROWS;
+                    private :
+                        std::unordered_set<std::size_t> frames;
+                        /** the index contents the selection refers to */
+                        std::shared_ptr<const std::vector<MosaicDatabase2::Frame>> generation;
+                        friend class MosaicFrameIndex;
+                    };
+                public :
+                    MosaicFrameIndex() NOTHROWS;
+                    ~MosaicFrameIndex() NOTHROWS;
+                public :
+                    /**
+                     * Replaces the contents of the index with all frames in
+                     * the database.
+                     */
+                    Util::TAKErr build(MosaicDatabase2 &database) NOTHROWS;
+                    /**
+                     * Replaces the contents of the index with the frames in
+                     * the cursor.
+                     */
+                    Util::TAKErr build(MosaicDatabase2::Cursor &cursor) NOTHROWS;
+                    /**
+                     * Selects the frames matching the specified parameters,
+                     * in the requested order. The returned frames remain
+                     * valid until the index is rebuilt.
+                     */
+                    Util::TAKErr query(std::vector<const MosaicDatabase2::Frame *> &value, const MosaicDatabase2::QueryParameters &params) const NOTHROWS;
+                    /**
+                     * Selects the frames matching the specified parameters and
+                     * reports the changes relative to the previous selection.
+                     * `selection` is updated to the frames now selected; if
+                     * the index has been rebuilt since `selection` was last
+                     * updated, all selected frames are reported as entering.
+                     *
+                     * @param entering  Returns the frames that were not
+                     *                  previously selected
+                     * @param leaving   Returns the frames that are no longer
+                     *                  selected
+                     */
+                    Util::TAKErr queryDelta(std::vector<const MosaicDatabase2::Frame *> &entering, std::vector<const MosaicDatabase2::Frame *> &leaving, Selection &selection, const MosaicDatabase2::QueryParameters &params) const NOTHROWS;
+                    /**
+                     * Returns a cursor over the frames matching the specified
+                     * parameters. The cursor remains valid if the index is
+                     * subsequently rebuilt or destroyed.
+                     */
+                    Util::TAKErr query(MosaicDatabase2::CursorPtr &value, const MosaicDatabase2::QueryParameters &params) const NOTHROWS;
+                    std::size_t size() const NOTHROWS;
+                    void clear() NOTHROWS;
+                private :
+                    Util::TAKErr queryImpl(std::vector<std::size_t> &value, const MosaicDatabase2::QueryParameters &params) const NOTHROWS;
+                private :
+                    std::shared_ptr<const std::vector<MosaicDatabase2::Frame>> frames;
+                    Util::PackedRTree<std::size_t> footprints;
+                };
+
+                /**
+                 * Wraps the specified database with a `MosaicFrameIndex`
+                 * that is built when the database is opened. Queries are
+                 * answered from the index; the database is only accessed
+                 * for coverages.
+                 */
+                ENGINE_API Util::TAKErr MosaicDatabase2_createIndexed(MosaicDatabase2Ptr &value, MosaicDatabase2Ptr &&impl) NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
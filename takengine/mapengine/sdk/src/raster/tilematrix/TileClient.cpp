@@ -12,7 +12,8 @@ CacheRequest::CacheRequest()
     canceled(false),
     countOnly(0),
     maxThreads(0),
-    expirationOffset(0) {}
+    expirationOffset(0),
+    durability(TECD_Normal) {}
 
 CacheRequest::CacheRequest(const CacheRequest &other)
     : minResolution(other.minResolution),
@@ -24,7 +25,8 @@ CacheRequest::CacheRequest(const CacheRequest &other)
     canceled(other.canceled),
     countOnly(other.countOnly),
     maxThreads(other.maxThreads),
-    expirationOffset(other.expirationOffset)
+    expirationOffset(other.expirationOffset),
+    durability(other.durability)
 {
     TAK::Engine::Feature::Geometry_clone(region, *other.region);
 }
@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_RASTER_TILECLIENT_H_INCLUDED
 #define TAK_ENGINE_RASTER_TILECLIENT_H_INCLUDED
 
+#include "raster/tilematrix/TileContainer.h"
 #include "raster/tilematrix/TileMatrix.h"
 #include "port/String.h"
 #include "feature/Geometry2.h"
@@ -33,6 +34,8 @@ namespace TAK {
                     int maxThreads;
                     int64_t expirationOffset;
                     Port::String preferredContainerProvider;
+                    /** durability of the batched writes to the cache container */
+                    TileContainerDurability durability;
                 };
 
                 class ENGINE_API CacheRequestListener {
@@ -8,12 +8,45 @@ namespace TAK {
         namespace Raster {
             namespace TileMatrix {
 
+                /**
+                 * Specifies how a batch of tiles written to a container is
+                 * synchronized with storage.
+                 */
+                enum TileContainerDurability
+                {
+                    /** the batch is synced to storage before the write returns */
+                    TECD_Full,
+                    /** the batch is committed; syncing to storage may be deferred */
+                    TECD_Normal,
+                    /** no explicit syncing; recent batches may be lost on a crash or power loss */
+                    TECD_Off,
+                };
+
+                struct ENGINE_API TileWrite
+                {
+                    std::size_t level;
+                    std::size_t x;
+                    std::size_t y;
+                    const uint8_t *data;
+                    std::size_t len;
+                    int64_t expiration;
+                };
+
                 class ENGINE_API TileContainer : public TileMatrix {
                    public:
                     virtual ~TileContainer() NOTHROWS;
                     virtual Util::TAKErr isReadOnly(bool* value) NOTHROWS = 0;
                     virtual Util::TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t* value, const std::size_t len, const int64_t expiration) NOTHROWS = 0;
                     virtual Util::TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const Renderer::Bitmap2* data, const int64_t expiration) NOTHROWS = 0;
+                    /**
+                     * Writes the tiles as a single batch. Containers backed by
+                     * a transactional store should commit the batch as one
+                     * transaction, synchronized per <code>durability</code>.
+                     *
+                     * <P>The default implementation invokes
+                     * <code>setTile</code> for each tile.
+                     */
+                    virtual Util::TAKErr setTiles(const TileWrite *tiles, const std::size_t count, const TileContainerDurability durability) NOTHROWS;
 
                     virtual bool hasTileExpirationMetadata() NOTHROWS = 0;
                     virtual int64_t getTileExpiration(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS = 0;
@@ -16,6 +16,18 @@ using namespace TAK::Engine::Raster::TileMatrix;
 TileContainer::~TileContainer() NOTHROWS
 {}
 
+TAKErr TileContainer::setTiles(const TileWrite *tiles, const std::size_t count, const TileContainerDurability durability) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!tiles && count)
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < count; i++) {
+        code = setTile(tiles[i].level, tiles[i].x, tiles[i].y, tiles[i].data, tiles[i].len, tiles[i].expiration);
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
 //
 // TileContainerSpi
 //
@@ -0,0 +1,164 @@
+#include "raster/tilematrix/TileContainerWriter.h"
+
+#include <algorithm>
+
+#include "port/Platform.h"
+#include "util/Logging2.h"
+
+using namespace TAK::Engine::Raster::TileMatrix;
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+TileContainerWriterOptions::TileContainerWriterOptions() NOTHROWS :
+    batchSize(256u),
+    maxBatchLatency(1000LL),
+    maxPending(1024u),
+    durability(TECD_Normal)
+{}
+
+TileContainerWriter::TileContainerWriter(TileContainer &sink_, const TileContainerWriterOptions &opts_) NOTHROWS :
+    sink(sink_),
+    opts(opts_),
+    oldest(0LL),
+    writing(0u),
+    flushing(0u),
+    shutdown(false),
+    error(TE_Ok),
+    thread(nullptr, nullptr)
+{
+    ThreadCreateParams params;
+    params.name = "TileContainerWriter";
+    if (Thread_start(thread, threadStart, this, params) != TE_Ok) {
+        // tiles will be written synchronously
+        Logger_log(TELL_Warning, "TileContainerWriter: failed to start writer thread");
+        thread.reset();
+    }
+}
+
+TileContainerWriter::~TileContainerWriter() NOTHROWS
+{
+    if (!thread)
+        return;
+    flush();
+    {
+        Monitor::Lock lock(monitor);
+        shutdown = true;
+        lock.broadcast();
+    }
+    thread->join();
+}
+
+TAKErr TileContainerWriter::setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t *value, const std::size_t len, const int64_t expiration) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value && len)
+        return TE_InvalidArg;
+    if (!thread)
+        return sink.setTile(level, x, y, value, len, expiration);
+
+    PendingTile tile;
+    tile.level = level;
+    tile.x = x;
+    tile.y = y;
+    tile.data.assign(value, value + len);
+    tile.expiration = expiration;
+
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    while (pending.size() >= std::max(opts.maxPending, (std::size_t)1u))
+        lock.wait();
+    if (pending.empty())
+        oldest = Port::Platform_systime_millis();
+    pending.push_back(std::move(tile));
+    lock.broadcast();
+    return code;
+}
+
+TAKErr TileContainerWriter::flush() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!thread)
+        return code;
+
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    flushing++;
+    lock.broadcast();
+    while (!pending.empty() || writing)
+        lock.wait();
+    flushing--;
+
+    code = error;
+    error = TE_Ok;
+    return code;
+}
+
+void *TileContainerWriter::threadStart(void *opaque)
+{
+    static_cast<TileContainerWriter *>(opaque)->threadRun();
+    return nullptr;
+}
+
+void TileContainerWriter::threadRun() NOTHROWS
+{
+    const std::size_t batchSize = std::max(opts.batchSize, (std::size_t)1u);
+    std::vector<PendingTile> batch;
+    std::vector<TileWrite> writes;
+    while (true) {
+        {
+            Monitor::Lock lock(monitor);
+            while (true) {
+                if (pending.empty()) {
+                    if (shutdown)
+                        return;
+                    lock.wait();
+                    continue;
+                }
+                if (pending.size() >= batchSize || flushing || shutdown)
+                    break;
+                const int64_t remaining = (oldest + opts.maxBatchLatency) - Port::Platform_systime_millis();
+                if (remaining <= 0LL)
+                    break;
+                lock.wait(remaining);
+            }
+
+            const std::size_t count = std::min(pending.size(), batchSize);
+            batch.reserve(count);
+            for (std::size_t i = 0u; i < count; i++) {
+                batch.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+            // the age of the remainder is approximated from the start of this batch
+            if (!pending.empty())
+                oldest = Port::Platform_systime_millis();
+            writing = count;
+            // wake producers blocked on a full queue
+            lock.broadcast();
+        }
+
+        writes.resize(batch.size());
+        for (std::size_t i = 0u; i < batch.size(); i++) {
+            writes[i].level = batch[i].level;
+            writes[i].x = batch[i].x;
+            writes[i].y = batch[i].y;
+            writes[i].data = batch[i].data.empty() ? nullptr : &batch[i].data.at(0);
+            writes[i].len = batch[i].data.size();
+            writes[i].expiration = batch[i].expiration;
+        }
+        const TAKErr code = sink.setTiles(&writes.at(0), writes.size(), opts.durability);
+        if (code != TE_Ok)
+            Logger_log(TELL_Error, "TileContainerWriter: failed to write batch of %u tiles, code=%d", (unsigned)writes.size(), (int)code);
+        batch.clear();
+
+        {
+            Monitor::Lock lock(monitor);
+            writing = 0u;
+            if (code != TE_Ok && error == TE_Ok)
+                error = code;
+            lock.broadcast();
+        }
+    }
+}
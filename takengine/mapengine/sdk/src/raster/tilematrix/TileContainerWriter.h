@@ -0,0 +1,93 @@
+#ifndef TAK_ENGINE_RASTER_TILEMATRIX_TILECONTAINERWRITER_H_INCLUDED
+#define TAK_ENGINE_RASTER_TILEMATRIX_TILECONTAINERWRITER_H_INCLUDED
+
+#include <deque>
+#include <vector>
+
+#include "port/Platform.h"
+#include "raster/tilematrix/TileContainer.h"
+#include "thread/Monitor.h"
+#include "thread/Thread.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Raster {
+            namespace TileMatrix {
+                struct ENGINE_API TileContainerWriterOptions
+                {
+                    TileContainerWriterOptions() NOTHROWS;
+
+                    /** the number of tiles that triggers a batch write */
+                    std::size_t batchSize;
+                    /** the maximum time, in milliseconds, that a tile is held before it is written */
+                    int64_t maxBatchLatency;
+                    /** the number of tiles that may be queued before <code>setTile</code> blocks */
+                    std::size_t maxPending;
+                    TileContainerDurability durability;
+                };
+
+                /**
+                 * Groups tiles written to a container into batches that are
+                 * committed via <code>TileContainer::setTiles</code> on a
+                 * dedicated thread. A batch is written once it reaches
+                 * <code>batchSize</code> tiles or its oldest tile has been
+                 * pending for <code>maxBatchLatency</code> milliseconds.
+                 *
+                 * <P>Pending tiles are written on <code>flush</code> and on
+                 * destruction.
+                 */
+                class ENGINE_API TileContainerWriter
+                {
+                private :
+                    struct PendingTile
+                    {
+                        std::size_t level;
+                        std::size_t x;
+                        std::size_t y;
+                        std::vector<uint8_t> data;
+                        int64_t expiration;
+                    };
+                public :
+                    TileContainerWriter(TileContainer &sink, const TileContainerWriterOptions &opts = TileContainerWriterOptions()) NOTHROWS;
+                    ~TileContainerWriter() NOTHROWS;
+                private :
+                    TileContainerWriter(const TileContainerWriter &) NOTHROWS;
+                public :
+                    /**
+                     * Queues the tile for writing. The data is copied. Blocks
+                     * while <code>maxPending</code> tiles are queued.
+                     */
+                    Util::TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t *value, const std::size_t len, const int64_t expiration) NOTHROWS;
+                    /**
+                     * Writes all queued tiles and waits for the writes to
+                     * complete.
+                     *
+                     * @return  TE_Ok if all batches since the last flush
+                     *          were written successfully, otherwise the
+                     *          first error encountered
+                     */
+                    Util::TAKErr flush() NOTHROWS;
+                private :
+                    static void *threadStart(void *opaque);
+                    void threadRun() NOTHROWS;
+                private :
+                    TileContainer &sink;
+                    const TileContainerWriterOptions opts;
+                    Thread::Monitor monitor;
+                    std::deque<PendingTile> pending;
+                    /** time that the oldest pending tile was queued */
+                    int64_t oldest;
+                    /** number of tiles in the batch currently being written */
+                    std::size_t writing;
+                    std::size_t flushing;
+                    bool shutdown;
+                    Util::TAKErr error;
+                    Thread::ThreadPtr thread;
+                };
+            }
+        }
+    }
+}
+
+#endif
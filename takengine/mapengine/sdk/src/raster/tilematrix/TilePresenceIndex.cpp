@@ -0,0 +1,242 @@
+#include "raster/tilematrix/TilePresenceIndex.h"
+
+#include "thread/RWMutex.h"
+#include "util/Logging2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Raster::TileMatrix;
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    uint64_t tileKey(const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        return ((uint64_t)x << 32u) | (uint64_t)(y & 0xFFFFFFFFu);
+    }
+
+    enum IndexState
+    {
+        Unbuilt,
+        Built,
+        Failed,
+    };
+
+    class IndexedTileContainer : public TileContainer
+    {
+    public :
+        IndexedTileContainer(TileContainerPtr &&impl, TilePresenceIndexBuilder builder, void *opaque) NOTHROWS;
+        ~IndexedTileContainer() NOTHROWS override;
+    public : // TileMatrix
+        const char* getName() const NOTHROWS override;
+        int getSRID() const NOTHROWS override;
+        TAKErr getZoomLevel(TAK::Engine::Port::Collection<ZoomLevel>& value) const NOTHROWS override;
+        double getOriginX() const NOTHROWS override;
+        double getOriginY() const NOTHROWS override;
+        TAKErr getTile(TAK::Engine::Renderer::BitmapPtr& result, const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS override;
+        TAKErr getTileData(std::unique_ptr<const uint8_t, void(*)(const uint8_t*)>& value, std::size_t* len,
+            const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS override;
+        TAKErr getBounds(TAK::Engine::Feature::Envelope2 *value) const NOTHROWS override;
+    public : // TileContainer
+        TAKErr isReadOnly(bool* value) NOTHROWS override;
+        TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t* value, const std::size_t len, const int64_t expiration) NOTHROWS override;
+        TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const TAK::Engine::Renderer::Bitmap2* data, const int64_t expiration) NOTHROWS override;
+        TAKErr setTiles(const TileWrite *tiles, const std::size_t count, const TileContainerDurability durability) NOTHROWS override;
+        bool hasTileExpirationMetadata() NOTHROWS override;
+        int64_t getTileExpiration(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS override;
+    private :
+        /**
+         * Returns <code>true</code> if the tile may be present in the
+         * underlying container, building the index if necessary.
+         */
+        bool mayContain(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS;
+        void markPresent(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS;
+    private :
+        TileContainerPtr impl;
+        TilePresenceIndexBuilder builder;
+        void *opaque;
+        RWMutex mutex;
+        TilePresenceIndex index;
+        IndexState state;
+    };
+}
+
+TilePresenceIndex::TilePresenceIndex() NOTHROWS :
+    count(0u)
+{}
+
+TilePresenceIndex::~TilePresenceIndex() NOTHROWS
+{}
+
+void TilePresenceIndex::add(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS
+{
+    if (level >= levels.size())
+        levels.resize(level + 1u);
+    if (levels[level].insert(tileKey(x, y)).second)
+        count++;
+}
+
+void TilePresenceIndex::remove(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS
+{
+    if (level >= levels.size())
+        return;
+    count -= levels[level].erase(tileKey(x, y));
+}
+
+bool TilePresenceIndex::contains(const std::size_t level, const std::size_t x, const std::size_t y) const NOTHROWS
+{
+    if (level >= levels.size())
+        return false;
+    return levels[level].find(tileKey(x, y)) != levels[level].end();
+}
+
+std::size_t TilePresenceIndex::size() const NOTHROWS
+{
+    return count;
+}
+
+void TilePresenceIndex::clear() NOTHROWS
+{
+    levels.clear();
+    count = 0u;
+}
+
+TAKErr TAK::Engine::Raster::TileMatrix::TileContainer_createIndexed(TileContainerPtr &value, TileContainerPtr &&impl, TilePresenceIndexBuilder builder, void *opaque) NOTHROWS
+{
+    if (!impl)
+        return TE_InvalidArg;
+    if (!builder)
+        return TE_InvalidArg;
+    value = TileContainerPtr(new IndexedTileContainer(std::move(impl), builder, opaque), Memory_deleter_const<TileContainer, IndexedTileContainer>);
+    return TE_Ok;
+}
+
+namespace
+{
+    IndexedTileContainer::IndexedTileContainer(TileContainerPtr &&impl_, TilePresenceIndexBuilder builder_, void *opaque_) NOTHROWS :
+        impl(std::move(impl_)),
+        builder(builder_),
+        opaque(opaque_),
+        state(Unbuilt)
+    {}
+    IndexedTileContainer::~IndexedTileContainer() NOTHROWS
+    {}
+    const char* IndexedTileContainer::getName() const NOTHROWS
+    {
+        return impl->getName();
+    }
+    int IndexedTileContainer::getSRID() const NOTHROWS
+    {
+        return impl->getSRID();
+    }
+    TAKErr IndexedTileContainer::getZoomLevel(TAK::Engine::Port::Collection<ZoomLevel>& value) const NOTHROWS
+    {
+        return impl->getZoomLevel(value);
+    }
+    double IndexedTileContainer::getOriginX() const NOTHROWS
+    {
+        return impl->getOriginX();
+    }
+    double IndexedTileContainer::getOriginY() const NOTHROWS
+    {
+        return impl->getOriginY();
+    }
+    TAKErr IndexedTileContainer::getTile(TAK::Engine::Renderer::BitmapPtr& result, const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        if (!mayContain(zoom, x, y))
+            return TE_Done;
+        return impl->getTile(result, zoom, x, y);
+    }
+    TAKErr IndexedTileContainer::getTileData(std::unique_ptr<const uint8_t, void(*)(const uint8_t*)>& value, std::size_t* len,
+        const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        if (!mayContain(zoom, x, y))
+            return TE_Done;
+        return impl->getTileData(value, len, zoom, x, y);
+    }
+    TAKErr IndexedTileContainer::getBounds(TAK::Engine::Feature::Envelope2 *value) const NOTHROWS
+    {
+        return impl->getBounds(value);
+    }
+    TAKErr IndexedTileContainer::isReadOnly(bool* value) NOTHROWS
+    {
+        return impl->isReadOnly(value);
+    }
+    TAKErr IndexedTileContainer::setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t* value, const std::size_t len, const int64_t expiration) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = impl->setTile(level, x, y, value, len, expiration);
+        TE_CHECKRETURN_CODE(code);
+        markPresent(level, x, y);
+        return code;
+    }
+    TAKErr IndexedTileContainer::setTile(const std::size_t level, const std::size_t x, const std::size_t y, const TAK::Engine::Renderer::Bitmap2* data, const int64_t expiration) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = impl->setTile(level, x, y, data, expiration);
+        TE_CHECKRETURN_CODE(code);
+        markPresent(level, x, y);
+        return code;
+    }
+    TAKErr IndexedTileContainer::setTiles(const TileWrite *tiles, const std::size_t count, const TileContainerDurability durability) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = impl->setTiles(tiles, count, durability);
+        TE_CHECKRETURN_CODE(code);
+        WriteLock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        if (state == Built) {
+            for (std::size_t i = 0u; i < count; i++)
+                index.add(tiles[i].level, tiles[i].x, tiles[i].y);
+        }
+        return code;
+    }
+    bool IndexedTileContainer::hasTileExpirationMetadata() NOTHROWS
+    {
+        return impl->hasTileExpirationMetadata();
+    }
+    int64_t IndexedTileContainer::getTileExpiration(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        if (!mayContain(level, x, y))
+            return -1LL;
+        return impl->getTileExpiration(level, x, y);
+    }
+    bool IndexedTileContainer::mayContain(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        {
+            ReadLock lock(mutex);
+            if (lock.status != TE_Ok)
+                return true;
+            if (state == Built)
+                return index.contains(level, x, y);
+            else if (state == Failed)
+                return true;
+        }
+
+        WriteLock lock(mutex);
+        if (lock.status != TE_Ok)
+            return true;
+        if (state == Unbuilt) {
+            const TAKErr code = builder(index, *impl, opaque);
+            if (code == TE_Ok) {
+                state = Built;
+            } else {
+                Logger_log(TELL_Warning, "TilePresenceIndex: failed to index %s, code=%d", impl->getName(), (int)code);
+                index.clear();
+                state = Failed;
+            }
+        }
+        return (state != Built) || index.contains(level, x, y);
+    }
+    void IndexedTileContainer::markPresent(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS
+    {
+        WriteLock lock(mutex);
+        if (lock.status != TE_Ok)
+            return;
+        // if not yet built, the builder will observe the tile
+        if (state == Built)
+            index.add(level, x, y);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef TAK_ENGINE_RASTER_TILEMATRIX_TILEPRESENCEINDEX_H_INCLUDED
+#define TAK_ENGINE_RASTER_TILEMATRIX_TILEPRESENCEINDEX_H_INCLUDED
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "port/Platform.h"
+#include "raster/tilematrix/TileContainer.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Raster {
+            namespace TileMatrix {
+                /**
+                 * Records which tiles are present in a tile matrix, keyed by
+                 * level and tile index. Storage is proportional to the
+                 * number of tiles present.
+                 *
+                 * <P>This class is not thread-safe.
+                 */
+                class ENGINE_API TilePresenceIndex
+                {
+                public :
+                    TilePresenceIndex() NOTHROWS;
+                    ~TilePresenceIndex() NOTHROWS;
+                public :
+                    void add(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS;
+                    void remove(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS;
+                    bool contains(const std::size_t level, const std::size_t x, const std::size_t y) const NOTHROWS;
+                    /**
+                     * Returns the number of tiles present.
+                     */
+                    std::size_t size() const NOTHROWS;
+                    void clear() NOTHROWS;
+                private :
+                    std::vector<std::unordered_set<uint64_t>> levels;
+                    std::size_t count;
+                };
+
+                /**
+                 * Populates the index with the tiles present in the
+                 * container.
+                 *
+                 * @param index     The index to populate
+                 * @param container The container being indexed
+                 * @param opaque    The user specified callback data
+                 */
+                typedef Util::TAKErr (*TilePresenceIndexBuilder)(TilePresenceIndex &index, TileContainer &container, void *opaque);
+
+                /**
+                 * Wraps the specified container with an in-memory index of the
+                 * tiles that it contains. Requests for tiles that are not
+                 * present are answered from the index, without accessing the
+                 * underlying container, and fail with <code>TE_Done</code>.
+                 *
+                 * <P>The index is populated by <code>builder</code> on the
+                 * first tile request and is updated as tiles are written
+                 * through the returned container. If the builder fails, all
+                 * requests are passed through to the underlying container.
+                 * Tiles written to the underlying container by other means
+                 * are not reflected in the index.
+                 *
+                 * @param value     Returns the indexed container
+                 * @param impl      The underlying container
+                 * @param builder   Populates the index from the contents of
+                 *                  <code>impl</code>
+                 * @param opaque    Passed to <code>builder</code>; must
+                 *                  remain valid for the lifetime of the
+                 *                  returned container
+                 */
+                ENGINE_API Util::TAKErr TileContainer_createIndexed(TileContainerPtr &value, TileContainerPtr &&impl, TilePresenceIndexBuilder builder, void *opaque) NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
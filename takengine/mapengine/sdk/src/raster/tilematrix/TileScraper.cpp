@@ -6,6 +6,7 @@
 #include "math/Vector4.h"
 #include "thread/Lock.h"
 #include "thread/Thread.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine;
 using namespace TAK::Engine::Raster::TileMatrix;
@@ -14,6 +15,8 @@ namespace {
     const char *TAG = "TileScraper";
     const int MAX_TILES = 300000;
     const int DOWNLOAD_ATTEMPTS = 2;
+    // number of times a throttled tile is retried before it is treated as an error
+    const int MAX_BUSY_ATTEMPTS = 10;
 }
 
 Util::TAKErr TAK::Engine::Raster::TileMatrix::TileScraper_create(TileScraperPtr &value, std::shared_ptr<TileMatrix> client, 
@@ -76,7 +79,7 @@ TileScraper::TilePoint::TilePoint(int row, int column) : r(row), c(column)
 
 /**************************************************************************/
 
-TileScraper::DownloadTask::DownloadTask(std::shared_ptr<ScrapeContext> context, size_t tileZ, size_t tileX, size_t tileY) : context(context), tileX(tileX), tileY(tileY), tileZ(tileZ)
+TileScraper::DownloadTask::DownloadTask(std::shared_ptr<ScrapeContext> context, size_t tileZ, size_t tileX, size_t tileY) : context(context), tileX(tileX), tileY(tileY), tileZ(tileZ), busyAttempts(0)
 {
 }
 
@@ -98,13 +101,19 @@ Util::TAKErr TileScraper::DownloadTask::run()
 
         if (err == Util::TE_Ok && d.get() != nullptr) {
             // valid entry in cache
-            this->context->sink->setTile(this->tileZ, this->tileX, this->tileY, d.get(), len, TAK::Engine::Port::Platform_systime_millis() + context->request->expirationOffset);
+            this->context->writer->setTile(this->tileZ, this->tileX, this->tileY, d.get(), len, TAK::Engine::Port::Platform_systime_millis() + context->request->expirationOffset);
             success = true;
             break;
         } else if (err == Util::TE_Ok) {
             // there was no exception raised during which means that
             // the client is unable to download
             break;
+        } else if (err == Util::TE_Busy) {
+            // the server is throttling requests; the downloader will back
+            // off and retry the task
+            if (++this->busyAttempts < MAX_BUSY_ATTEMPTS)
+                return err;
+            break;
         } else {
             attempts++;
         }
@@ -194,7 +203,7 @@ Util::TAKErr TileScraper::ScrapeContext::create(std::unique_ptr<TileScraper::Scr
 
 
 TileScraper::ScrapeContext::ScrapeContext(TileMatrix *client, TileContainer *container, CacheRequest *request) : 
-    client(client), sink(container), request(request), uri(client->getName()),
+    client(client), sink(container), writer(), request(request), uri(client->getName()),
     levels(), currentLevelIdx(0), totalTilesCurrentLevel(0), totalTiles(0),
     downloadError(false), tilesDownloaded(0),
     tiles(), minLevel(0), maxLevel(0), zooms(),
@@ -211,6 +220,11 @@ TileScraper::ScrapeContext::ScrapeContext(TileMatrix *client, TileContainer *con
     },
     closed(false)
 {
+    if (container) {
+        TileContainerWriterOptions opts;
+        opts.durability = request->durability;
+        writer.reset(new TileContainerWriter(*container, opts));
+    }
 }
 
 void TileScraper::ScrapeContext::getTiles(int col, int row, int level, int max)
@@ -433,9 +447,18 @@ bool TileScraper::Downloader::download(std::shared_ptr<ScrapeContext> downloadCo
                 code = downloadTileImpl(downloadContext, currentLevel, tilesIter->c - tile180X, tilesIter->r);
             else
                 code = downloadTileImpl(downloadContext, currentLevel, tilesIter->c, tilesIter->r);
-
-            this->onLevelDownloadComplete(downloadContext);
         }
+
+        this->onLevelDownloadComplete(downloadContext);
+    }
+
+    this->onDownloadExit(downloadContext, 0);
+
+    // commit any tiles still batched for the container before reporting
+    if (downloadContext->writer.get() != nullptr) {
+        Util::TAKErr writeCode = downloadContext->writer->flush();
+        if (code == Util::TE_Ok)
+            code = writeCode;
     }
 
     bool retval;
@@ -447,15 +470,15 @@ bool TileScraper::Downloader::download(std::shared_ptr<ScrapeContext> downloadCo
         Util::Logger_log(Util::LogLevel::TELL_Error, "%s Error while trying to download from %s", TAG, downloadContext->uri);
         retval = false;
     }
-    this->onDownloadExit(downloadContext, 0);
     return retval;
 }
 
 
 TileScraper::MultiThreadDownloader::MultiThreadDownloader(std::shared_ptr<CacheRequestListener> callback, int numDownloadThreads) : 
-    Downloader(callback), queue(), shutdown(false), terminate(false), queueMonitor(), poolSize(numDownloadThreads), pool(NULL, NULL)
+    Downloader(callback), queue(), shutdown(false), terminate(false), queueMonitor(), poolSize(numDownloadThreads),
+    limiter(1u, static_cast<std::size_t>(numDownloadThreads), static_cast<std::size_t>(numDownloadThreads)), worker(), activeWork(0u)
 {
-    Thread::ThreadPool_create(pool, poolSize, TileScraper::MultiThreadDownloader::threadEntry, this);
+    Util::WorkerRegistry_borrow(worker, Util::TEWC_IO, "tilescraper", static_cast<std::size_t>(poolSize));
 }
 
 TileScraper::MultiThreadDownloader::~MultiThreadDownloader()
@@ -465,7 +488,8 @@ TileScraper::MultiThreadDownloader::~MultiThreadDownloader()
         terminate = true;
         mLock.broadcast();
     }
-    pool->joinAll();
+    limiter.interrupt();
+    awaitIdle();
 }
 
 void TileScraper::MultiThreadDownloader::flush(std::shared_ptr<ScrapeContext> context, bool reportStatus)
@@ -490,14 +514,19 @@ void TileScraper::MultiThreadDownloader::onDownloadExit(std::shared_ptr<ScrapeCo
     {
         Thread::Monitor::Lock mLock(queueMonitor);
         shutdown = true;
+        terminate |= context->request->canceled;
         mLock.broadcast();
     }
+    if (context->request->canceled)
+        limiter.interrupt();
+    // wait for in-flight tasks so that their tiles are queued for writing
+    awaitIdle();
 }
 
 bool TileScraper::MultiThreadDownloader::checkReadyForDownload(std::shared_ptr<ScrapeContext> context)
 {
     Thread::Monitor::Lock mLock(queueMonitor);
-    return (this->queue.size() < (3u * static_cast<std::size_t>(poolSize)));
+    return (this->queue.size() < (3u * limiter.getLimit()));
 }
 
 void TileScraper::MultiThreadDownloader::onLevelDownloadComplete(std::shared_ptr<ScrapeContext> context) {
@@ -509,42 +538,91 @@ Util::TAKErr TileScraper::MultiThreadDownloader::downloadTileImpl(std::shared_pt
 {
     Thread::Monitor::Lock mLock(queueMonitor);
     queue.push_back(std::unique_ptr<DownloadTask>(new DownloadTask(context, tileLevel, tileX, tileY)));
-    mLock.broadcast();
-    return Util::TE_Ok;
-}
-
-void *TileScraper::MultiThreadDownloader::threadEntry(void *selfPtr)
-{
-    TileScraper::MultiThreadDownloader *self = (TileScraper::MultiThreadDownloader *)selfPtr;
-    self->threadRun();
-    return nullptr;
+    Util::TAKErr code = scheduleTask(mLock);
+    if (code != Util::TE_Ok)
+        queue.pop_back();
+    return code;
+}
+
+/**
+ * Services a single queued download task on a borrowed IO worker. One work
+ * item is scheduled per queued task so that the registry may interleave
+ * tile downloads with the work of other subsystems.
+ */
+class TileScraper::MultiThreadDownloader::TaskWork : public Util::Work
+{
+public :
+    TaskWork(MultiThreadDownloader &owner_) NOTHROWS :
+        owner(owner_)
+    {}
+protected :
+    Util::TAKErr onSignalWork(Thread::MonitorLockPtr &lockPtr) NOTHROWS override
+    {
+        lockPtr.reset();
+        owner.runTask();
+        return Util::TE_Ok;
+    }
+private :
+    MultiThreadDownloader &owner;
+};
+
+Util::TAKErr TileScraper::MultiThreadDownloader::scheduleTask(Thread::Monitor::Lock &mLock)
+{
+    if (!worker)
+        return Util::TE_IllegalState;
+    activeWork++;
+    Util::TAKErr code = worker->scheduleWork(std::make_shared<TaskWork>(*this));
+    if (code != Util::TE_Ok) {
+        activeWork--;
+        mLock.broadcast();
+    }
+    return code;
 }
 
-void TileScraper::MultiThreadDownloader::threadRun()
+void TileScraper::MultiThreadDownloader::runTask()
 {
-    while (true) {
-        std::unique_ptr<DownloadTask> task;
-        {
-            Thread::Monitor::Lock mLock(queueMonitor);
-            if (terminate)
-                break;
-            if (queue.empty()) {
-                if (shutdown)
-                    break;
-                mLock.wait();
-                continue;
-            }
+    std::unique_ptr<DownloadTask> task;
+    {
+        Thread::Monitor::Lock mLock(queueMonitor);
+        if (!terminate && !queue.empty()) {
             task = std::move(queue.front());
             queue.pop_front();
         }
-        task->run();
-        task.reset();
     }
+    // wait for capacity, which may be reduced if the server is slow or
+    // throttling requests
+    if (task.get() != nullptr && limiter.acquire() == Util::TE_Ok) {
+        const int64_t start = Port::Platform_systime_millis();
+        const Util::TAKErr code = task->run();
+        limiter.release(code, Port::Platform_systime_millis() - start);
+        if (code == Util::TE_Busy) {
+            // requeue at the front with a fresh work item; the limiter delays
+            // the retry
+            Thread::Monitor::Lock mLock(queueMonitor);
+            if (!terminate) {
+                queue.push_front(std::move(task));
+                if (scheduleTask(mLock) != Util::TE_Ok)
+                    queue.pop_front();
+            }
+        }
+    }
+    task.reset();
+
+    Thread::Monitor::Lock mLock(queueMonitor);
+    activeWork--;
+    mLock.broadcast();
 }
 
+void TileScraper::MultiThreadDownloader::awaitIdle()
+{
+    Thread::Monitor::Lock mLock(queueMonitor);
+    while (activeWork)
+        mLock.wait();
+}
 
 
-TileScraper::LegacyDownloader::LegacyDownloader(std::shared_ptr<CacheRequestListener> callback) : Downloader(callback)
+
+TileScraper::LegacyDownloader::LegacyDownloader(std::shared_ptr<CacheRequestListener> callback) : Downloader(callback), limiter(1u, 1u, 1u)
 {
 }
 
@@ -556,5 +634,13 @@ Util::TAKErr TileScraper::LegacyDownloader::downloadTileImpl(std::shared_ptr<Scr
                 int tileX, int tileY)
 {
     DownloadTask t(context, tileLevel, tileX, tileY);
-    return t.run();
+    Util::TAKErr code;
+    do {
+        code = limiter.acquire();
+        TE_CHECKRETURN_CODE(code);
+        const int64_t start = Port::Platform_systime_millis();
+        code = t.run();
+        limiter.release(code, Port::Platform_systime_millis() - start);
+    } while (code == Util::TE_Busy && !context->request->canceled);
+    return code;
 }
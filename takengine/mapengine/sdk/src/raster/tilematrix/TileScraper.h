@@ -3,13 +3,15 @@
 
 #include "raster/tilematrix/TileMatrix.h"
 #include "raster/tilematrix/TileContainer.h"
+#include "raster/tilematrix/TileContainerWriter.h"
 #include "raster/tilematrix/TileClient.h"
 #include "port/String.h"
 #include "port/Platform.h"
 #include "feature/Geometry2.h"
 #include "thread/Mutex.h"
 #include "thread/Monitor.h"
-#include "thread/ThreadPool.h"
+#include "util/ConcurrencyLimiter.h"
+#include "util/Work.h"
 #include <vector>
 #include <string>
 #include <map>
@@ -61,6 +63,8 @@ namespace TAK {
                     public:
                         TileMatrix * const client;
                         TileContainer * const sink;
+                        /** batches writes to the sink; <code>nullptr</code> if there is no sink */
+                        std::unique_ptr<TileContainerWriter> writer;
                         const CacheRequest *request;
                         std::string uri;
                         std::vector<int> levels;
@@ -120,11 +124,19 @@ namespace TAK {
                         const size_t tileX;
                         const size_t tileY;
                         const size_t tileZ;
+                        // number of times the server has throttled the request
+                        int busyAttempts;
 
                     public:
                         DownloadTask(std::shared_ptr<ScrapeContext> context, size_t tileZ, size_t tileX,
                             size_t tileY);
 
+                        /**
+                        * Downloads the tile and queues it for writing. Returns
+                        * <code>TE_Busy</code>, without recording an error, if
+                        * the server is throttling requests and the task should
+                        * be retried after backing off.
+                        */
                         Util::TAKErr run();
                     };
 
@@ -179,7 +191,12 @@ namespace TAK {
                         bool terminate;
                         Thread::Monitor queueMonitor;
                         int poolSize;
-                        Thread::ThreadPoolPtr pool;
+                        // bounds the number of requests in flight; at most poolSize
+                        Util::ConcurrencyLimiter limiter;
+                        // borrowed from the engine-wide IO class; at most poolSize concurrent
+                        Util::SharedWorkerPtr worker;
+                        // number of scheduled task work items not yet retired
+                        std::size_t activeWork;
 
                     public:
                         MultiThreadDownloader(std::shared_ptr<CacheRequestListener> callback, int numDownloadThreads);
@@ -194,8 +211,11 @@ namespace TAK {
                         virtual Util::TAKErr downloadTileImpl(std::shared_ptr<ScrapeContext> context, int tileLevel,
                             int tileX, int tileY);
                     private:
-                        static void *threadEntry(void *selfPtr);
-                        void threadRun();
+                        class TaskWork;
+
+                        Util::TAKErr scheduleTask(Thread::Monitor::Lock &mLock);
+                        void runTask();
+                        void awaitIdle();
                     };
 
                     class LegacyDownloader : public Downloader {
@@ -205,6 +225,9 @@ namespace TAK {
                     protected:
                         virtual Util::TAKErr downloadTileImpl(std::shared_ptr<ScrapeContext> context, int tileLevel,
                             int tileX, int tileY);
+                    private:
+                        // applies backoff when the server is throttling
+                        Util::ConcurrencyLimiter limiter;
                     };
 
 
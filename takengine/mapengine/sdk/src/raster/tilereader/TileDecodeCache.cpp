@@ -0,0 +1,158 @@
+#include "raster/tilereader/TileDecodeCache.h"
+
+#include <tuple>
+
+#include "port/Platform.h"
+#include "util/ConfigOptions.h"
+
+using namespace TAK::Engine::Raster::TileReader;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    std::size_t sizeOf(const Bitmap2 &tile) NOTHROWS
+    {
+        return tile.getStride() * tile.getHeight();
+    }
+}
+
+TileDecodeCache::Key::Key() NOTHROWS :
+    level(0u),
+    column(0LL),
+    row(0LL),
+    version(0LL),
+    width(0u),
+    height(0u),
+    format(0)
+{}
+
+TileDecodeCache::TileDecodeCache(const std::size_t maxSize_, const int64_t ttl_) NOTHROWS :
+    maxSize(maxSize_),
+    ttl(ttl_),
+    size(0u)
+{}
+
+TileDecodeCache::~TileDecodeCache() NOTHROWS
+{}
+
+TAKErr TileDecodeCache::acquire(std::shared_ptr<const Bitmap2> &value, const Key &key) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    while (true) {
+        auto entry = entries.find(key);
+        if (entry == entries.end()) {
+            // caller is responsible for the decode
+            Entry pending;
+            pending.expires = 0LL;
+            pending.size = 0u;
+            pending.pending = true;
+            pending.order = order.end();
+            entries.insert(EntryMap::value_type(key, pending));
+            return TE_Done;
+        }
+        if (entry->second.pending) {
+            code = lock.wait();
+            TE_CHECKRETURN_CODE(code);
+            continue;
+        }
+        if (entry->second.expires < Platform_systime_millis()) {
+            eraseLocked(entry);
+            continue;
+        }
+        value = entry->second.tile;
+        return TE_Ok;
+    }
+}
+
+void TileDecodeCache::put(const Key &key, const std::shared_ptr<const Bitmap2> &tile) NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    auto entry = entries.find(key);
+    if (entry == entries.end() || !entry->second.pending)
+        return;
+
+    const std::size_t tileSize = tile ? sizeOf(*tile) : 0u;
+    if (!tile || tileSize > maxSize) {
+        entries.erase(entry);
+    } else {
+        const int64_t now = Platform_systime_millis();
+        entry->second.tile = tile;
+        entry->second.expires = now + ttl;
+        entry->second.size = tileSize;
+        entry->second.pending = false;
+        entry->second.order = order.insert(order.end(), key);
+        size += tileSize;
+        trimLocked(now);
+    }
+    lock.broadcast();
+}
+
+void TileDecodeCache::abandon(const Key &key) NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    auto entry = entries.find(key);
+    if (entry == entries.end() || !entry->second.pending)
+        return;
+    entries.erase(entry);
+    lock.broadcast();
+}
+
+void TileDecodeCache::clear() NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    while (!order.empty())
+        eraseLocked(entries.find(order.front()));
+}
+
+std::size_t TileDecodeCache::getSize() const NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    return size;
+}
+
+std::size_t TileDecodeCache::getMaxSize() const NOTHROWS
+{
+    return maxSize;
+}
+
+void TileDecodeCache::trimLocked(const int64_t now) NOTHROWS
+{
+    // tiles are retained for a fixed period, so publication order is also
+    // expiration order
+    while (!order.empty()) {
+        auto oldest = entries.find(order.front());
+        if (size <= maxSize && oldest->second.expires >= now)
+            break;
+        eraseLocked(oldest);
+    }
+}
+
+void TileDecodeCache::eraseLocked(EntryMap::iterator entry) NOTHROWS
+{
+    size -= entry->second.size;
+    if (entry->second.order != order.end())
+        order.erase(entry->second.order);
+    entries.erase(entry);
+}
+
+bool TileDecodeCache::KeyLess::operator()(const Key &a, const Key &b) const NOTHROWS
+{
+    return std::tie(a.level, a.column, a.row, a.version, a.width, a.height, a.format, a.uri) <
+           std::tie(b.level, b.column, b.row, b.version, b.width, b.height, b.format, b.uri);
+}
+
+TileDecodeCache &TAK::Engine::Raster::TileReader::TileDecodeCache_get() NOTHROWS
+{
+    static TileDecodeCache cache(
+        (std::size_t)ConfigOptions_getIntOptionOrDefault("tilereader2.shared-decode-cache-size", 16 * 1024 * 1024),
+        (int64_t)ConfigOptions_getIntOptionOrDefault("tilereader2.shared-decode-ttl", 2000));
+    return cache;
+}
@@ -0,0 +1,131 @@
+#ifndef TAK_ENGINE_RASTER_TILEREADER_TILEDECODECACHE_H_INCLUDED
+#define TAK_ENGINE_RASTER_TILEREADER_TILEDECODECACHE_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "port/Platform.h"
+#include "renderer/Bitmap2.h"
+#include "thread/Monitor.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Raster {
+            namespace TileReader {
+                /**
+                 * Short-lived cache of decoded tiles, shared by all readers
+                 * of the same source. Tiles are keyed by source URI, tile
+                 * index, tile version and output dimensions and format.
+                 *
+                 * <P>Only one decode is performed for concurrent requests of
+                 * the same tile: the first requester is directed to decode
+                 * the tile and publish it via `put`, or to `abandon` it on
+                 * failure; subsequent requesters block until the tile is
+                 * published or abandoned.
+                 *
+                 * <P>This class is thread-safe.
+                 */
+                class ENGINE_API TileDecodeCache
+                {
+                public :
+                    struct ENGINE_API Key
+                    {
+                        Key() NOTHROWS;
+
+                        std::string uri;
+                        std::size_t level;
+                        int64_t column;
+                        int64_t row;
+                        int64_t version;
+                        std::size_t width;
+                        std::size_t height;
+                        int format;
+                    };
+                public :
+                    /**
+                     * @param maxSize   The maximum bytes of decoded tiles
+                     *                  retained
+                     * @param ttl       The period, in milliseconds, that a
+                     *                  decoded tile is retained
+                     */
+                    TileDecodeCache(const std::size_t maxSize, const int64_t ttl) NOTHROWS;
+                    ~TileDecodeCache() NOTHROWS;
+                private :
+                    TileDecodeCache(const TileDecodeCache &) NOTHROWS;
+                public :
+                    /**
+                     * Obtains the decoded tile for the specified key.
+                     *
+                     * @return  TE_Ok if the tile was cached or decoded by a
+                     *          concurrent request; TE_Done if the caller
+                     *          must decode the tile and subsequently invoke
+                     *          `put` or `abandon` with the same key
+                     */
+                    Util::TAKErr acquire(std::shared_ptr<const Renderer::Bitmap2> &value, const Key &key) NOTHROWS;
+                    /**
+                     * Publishes the tile decoded following a call to
+                     * `acquire` that returned TE_Done.
+                     */
+                    void put(const Key &key, const std::shared_ptr<const Renderer::Bitmap2> &tile) NOTHROWS;
+                    /**
+                     * Signals that the tile could not be decoded following a
+                     * call to `acquire` that returned TE_Done. A blocked
+                     * requester will be directed to decode the tile.
+                     */
+                    void abandon(const Key &key) NOTHROWS;
+                    /**
+                     * Releases all retained tiles. In-progress decodes are
+                     * unaffected.
+                     */
+                    void clear() NOTHROWS;
+                    /** returns the bytes of decoded tiles retained */
+                    std::size_t getSize() const NOTHROWS;
+                    std::size_t getMaxSize() const NOTHROWS;
+                private :
+                    struct KeyLess
+                    {
+                        bool operator()(const Key &a, const Key &b) const NOTHROWS;
+                    };
+                    struct Entry
+                    {
+                        std::shared_ptr<const Renderer::Bitmap2> tile;
+                        /** expiration, milliseconds since epoch */
+                        int64_t expires;
+                        std::size_t size;
+                        bool pending;
+                        std::list<Key>::iterator order;
+                    };
+                    typedef std::map<Key, Entry, KeyLess> EntryMap;
+                private :
+                    /** evicts expired tiles and tiles in excess of the budget */
+                    void trimLocked(const int64_t now) NOTHROWS;
+                    void eraseLocked(EntryMap::iterator entry) NOTHROWS;
+                private :
+                    const std::size_t maxSize;
+                    const int64_t ttl;
+                    std::size_t size;
+                    EntryMap entries;
+                    /** retained keys, in order of publication */
+                    std::list<Key> order;
+                    mutable Thread::Monitor monitor;
+                };
+
+                /**
+                 * Returns the process-wide decode cache. The budget and
+                 * retention are specified by the
+                 * "tilereader2.shared-decode-cache-size" (bytes) and
+                 * "tilereader2.shared-decode-ttl" (milliseconds) config
+                 * options; a budget of zero disables the cache.
+                 */
+                ENGINE_API TileDecodeCache &TileDecodeCache_get() NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
@@ -1,11 +1,18 @@
 #include "raster/tilereader/TileReader2.h"
 
 #include <algorithm>
-#include <chrono>
+#include <cstring>
+#include <tuple>
 
+#include "raster/tilereader/TileDecodeCache.h"
 #include "thread/Lock.h"
 
+#include "util/AllocationTagging.h"
+#include "util/ConfigOptions.h"
 #include "util/Memory.h"
+#include "util/PerformanceCounters.h"
+#include "util/Trace.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine::Raster::TileReader;
 
@@ -14,6 +21,11 @@ using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Util;
 
 #define TAG "TileReader2"
+#define ASYNCIO_MAX_CONCURRENCY 5
+// reads are serialized on the reader's lock; additional concurrency would
+// only block IO threads
+#define ASYNCIO_DEFAULT_READER_CONCURRENCY 1u
+#define ASYNCIO_DEFAULT_BATCH_SIZE 8
 
 namespace {
 
@@ -22,8 +34,143 @@ namespace {
         auto *io = (TileReader2::AsynchronousIO *)opaque;
         io->release();
     }
+
+    struct RequestComparator
+    {
+        TileReader2::ReadRequestPrioritizer* cmp{ nullptr };
+        bool operator()(const std::shared_ptr<TileReader2::ReadRequest>& a, const std::shared_ptr<TileReader2::ReadRequest>& b) NOTHROWS
+        {
+            // REMEMBER: requests are pulled of the _tail_ of the queue
+
+            // canceled requests bubble to the top
+            if (a->canceled && b->canceled)
+                return a->id > b->id;
+            else if (a->canceled)
+                return false;
+            else if (b->canceled)
+                return true;
+
+            // if a prioritizer is defined, use it
+            if (cmp) {
+                const bool a_b = cmp->compare(*a, *b);
+                const bool b_a = cmp->compare(*b, *a);
+                // if not equal, return priorization
+                if (a_b != b_a)
+                    return a_b;
+            }
+
+            // prioritize high resolution tiles over low resolution tiles
+            if(a->level < b->level)
+                return false;
+            else if(a->level > b->level)
+                return true;
+            else
+                return a->id<b->id; // LIFO on read requests
+        }
+    };
+
+    /**
+     * Populates the decode cache key for the request. Returns `false` if the
+     * decode cache does not apply to the request.
+     */
+    bool getDecodeKey(TileDecodeCache::Key &key, TileReader2 &reader, const char *uri, const TileReader2::ReadRequest &request, const Bitmap2::Format format) NOTHROWS
+    {
+        if (!TileDecodeCache_get().getMaxSize() || request.level < 0 || request.tileColumn < 0 || request.tileRow < 0 || !uri || !*uri)
+            return false;
+        if (reader.getTileVersion(&key.version, (size_t)request.level, request.tileColumn, request.tileRow) != TE_Ok)
+            return false;
+        key.uri = uri;
+        key.level = (size_t)request.level;
+        key.column = request.tileColumn;
+        key.row = request.tileRow;
+        key.width = request.dstW;
+        key.height = request.dstH;
+        key.format = format;
+        return true;
+    }
+
+    bool decodeKeyLess(const TileDecodeCache::Key &a, const TileDecodeCache::Key &b) NOTHROWS
+    {
+        return std::tie(a.uri, a.level, a.column, a.row, a.version, a.width, a.height, a.format) <
+               std::tie(b.uri, b.level, b.column, b.row, b.version, b.width, b.height, b.format);
+    }
+
+    /**
+     * Returns TE_Ok if the tile was copied from the decode cache into the
+     * buffer, TE_Done if the caller must read the tile and subsequently
+     * publish or abandon it, other codes if the tile must be read.
+     */
+    TAKErr acquireDecoded(uint8_t *buffer, const TileDecodeCache::Key &key) NOTHROWS
+    {
+        std::shared_ptr<const Bitmap2> shared;
+        const TAKErr code = TileDecodeCache_get().acquire(shared, key);
+        if (code == TE_Ok) {
+            if (!shared->getData())
+                return TE_IllegalState;
+            memcpy(buffer, shared->getData(), shared->getStride() * shared->getHeight());
+        }
+        return code;
+    }
+
+    void releaseDecoded(const TileDecodeCache::Key &key, const TAKErr code, uint8_t *buffer, const TileReader2::ReadRequest &request, const Bitmap2::Format format) NOTHROWS
+    {
+        TileDecodeCache &decodeCache = TileDecodeCache_get();
+        if (code == TE_Ok)
+            decodeCache.put(key, std::make_shared<const Bitmap2>(Bitmap2(Bitmap2::DataPtr(buffer, Memory_leaker_const<uint8_t>), request.dstW, request.dstH, format)));
+        else
+            decodeCache.abandon(key);
+    }
+
+    void notifyUpdate(TileReader2::ReadRequest &request, uint8_t *buffer, const Bitmap2::Format format) NOTHROWS
+    {
+        Bitmap2::DataPtr data(buffer, Memory_leaker_const<uint8_t>);
+        TAK::Engine::Thread::Lock cb_lock(request.lock);
+        if(request.callback)
+            request.callback->requestUpdate(request.id, Bitmap2(std::move(data), request.dstW, request.dstH, format));
+    }
+
+    /**
+     * Returns `true` if the request is for exactly the tile identified by its
+     * level, column and row.
+     */
+    bool isTileRequest(TileReader2 &reader, const TileReader2::ReadRequest &request) NOTHROWS
+    {
+        if (request.level < 0 || request.tileColumn < 0 || request.tileRow < 0)
+            return false;
+        const size_t level = (size_t)request.level;
+        int64_t v;
+        size_t s;
+        return reader.getTileSourceX(&v, level, request.tileColumn) == TE_Ok && v == request.srcX &&
+               reader.getTileSourceY(&v, level, request.tileRow) == TE_Ok && v == request.srcY &&
+               reader.getTileSourceWidth(&v, level, request.tileColumn) == TE_Ok && v == request.srcW &&
+               reader.getTileSourceHeight(&v, level, request.tileRow) == TE_Ok && v == request.srcH &&
+               reader.getTileWidth(&s, level, request.tileColumn) == TE_Ok && s == request.dstW &&
+               reader.getTileHeight(&s, level, request.tileRow) == TE_Ok && s == request.dstH;
+    }
 }
 
+/**
+ * Services a batch of read requests on a borrowed IO worker. The work is
+ * requeued after each batch, rather than draining the owning
+ * AsynchronousIO, so that other borrowers of the IO class are serviced in
+ * between.
+ */
+class TileReader2::AsynchronousIO::DrainWork : public Work
+{
+public :
+    DrainWork(AsynchronousIO &owner_) NOTHROWS :
+        owner(owner_)
+    {}
+protected :
+    TAKErr onSignalWork(Thread::MonitorLockPtr &lockPtr) NOTHROWS override
+    {
+        lockPtr.reset();
+        return owner.runImpl();
+    }
+private :
+    AsynchronousIO &owner;
+};
+
 
 TileReader2::TileReader2(const char *uri_) NOTHROWS
     : uri(uri_),
@@ -139,6 +286,22 @@ TAKErr TileReader2::read(uint8_t *data, const size_t level, const int64_t tileCo
     return code;
 }
 
+TAKErr TileReader2::readTiles(TileRead *tiles, const size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!tiles && count)
+        return TE_InvalidArg;
+
+    Thread::Lock lock(readLock);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    for (size_t i = 0u; i < count; i++)
+        tiles[i].code = this->read(tiles[i].data, tiles[i].level, tiles[i].tileColumn, tiles[i].tileRow);
+
+    return code;
+}
+
 int TileReader2::nextRequestId() NOTHROWS
 {
     TAK::Engine::Thread::Lock lock(this->idLock);
@@ -166,18 +329,128 @@ TAKErr TileReader2::fill(uint8_t *buffer, ReadRequest &request) NOTHROWS
             return request.canceled ? TE_Canceled : code;
         }
 
-        code = this->read(buffer, request.srcX, request.srcY, request.srcW, request.srcH, request.dstW, request.dstH);
+        Bitmap2::Format format;
+        getFormat(&format);
+
+        // tiles are shared with other readers of the same source
+        TileDecodeCache::Key decodeKey;
+        TAKErr acquired = TE_Unsupported;
+        if (getDecodeKey(decodeKey, *this, this->uri.get(), request, format))
+            acquired = acquireDecoded(buffer, decodeKey);
+
+        if (acquired != TE_Ok)
+            code = this->read(buffer, request.srcX, request.srcY, request.srcW, request.srcH, request.dstW, request.dstH);
+        if (acquired == TE_Done)
+            releaseDecoded(decodeKey, code, buffer, request, format);
+
         // minimize debugging
-        if (code == TE_Ok) {
-            Bitmap2::DataPtr data(buffer, Memory_leaker_const<uint8_t>);
-            Bitmap2::Format format;
-            getFormat(&format);
-            {
-                TAK::Engine::Thread::Lock cb_lock(request.lock);
-                if(request.callback)
-                    request.callback->requestUpdate(request.id, Bitmap2(std::move(data), request.dstW, request.dstH, format));
+        if (code == TE_Ok)
+            notifyUpdate(request, buffer, format);
+    }
+
+    return code;
+}
+
+TAKErr TileReader2::fill(uint8_t **buffers, ReadRequest **requests, TAKErr *codes, const size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!count)
+        return code;
+    if (!buffers || !requests || !codes)
+        return TE_InvalidArg;
+    if (count == 1u) {
+        codes[0] = this->fill(buffers[0], *requests[0]);
+        return code;
+    }
+
+    Thread::Lock lock(readLock);
+
+    Bitmap2::Format format;
+    getFormat(&format);
+
+    // TE_Ok if serviced from the decode cache, TE_Done if read and published
+    // to the decode cache, TE_Unsupported if read only, TE_Canceled if not
+    // serviced
+    std::vector<TAKErr> acquired(count, TE_Unsupported);
+    std::vector<TileDecodeCache::Key> decodeKeys(count);
+    std::vector<size_t> cacheable;
+    for (size_t i = 0u; i < count; i++) {
+        ReadRequest &request = *requests[i];
+        if (!this->valid)
+            request.canceled = true;
+
+        codes[i] = TE_Ok;
+        // if the request was asynchronously canceled or if the ROI is empty
+        // ignore
+        if (request.canceled || request.srcW == 0 || request.srcH == 0 || request.dstW == 0 || request.dstH == 0) {
+            if (request.canceled)
+                codes[i] = TE_Canceled;
+            acquired[i] = TE_Canceled;
+            continue;
+        }
+        if (getDecodeKey(decodeKeys[i], *this, this->uri.get(), request, format))
+            cacheable.push_back(i);
+    }
+
+    // a decode in progress blocks other requesters of the same tile; acquire
+    // in a consistent order so that concurrent batches against readers of the
+    // same source cannot deadlock. Duplicates within the batch are read
+    // without the cache.
+    std::sort(cacheable.begin(), cacheable.end(), [&decodeKeys](const size_t a, const size_t b)
+    {
+        return decodeKeyLess(decodeKeys[a], decodeKeys[b]);
+    });
+    for (size_t i = 0u; i < cacheable.size(); i++) {
+        if (i && !decodeKeyLess(decodeKeys[cacheable[i-1u]], decodeKeys[cacheable[i]]))
+            continue;
+        acquired[cacheable[i]] = acquireDecoded(buffers[cacheable[i]], decodeKeys[cacheable[i]]);
+    }
+
+    // tiles not available from the cache are read as a batch
+    std::vector<TileRead> tiles;
+    std::vector<size_t> tileRequests;
+    for (size_t i = 0u; i < count; i++) {
+        if (acquired[i] == TE_Ok || acquired[i] == TE_Canceled)
+            continue;
+        const ReadRequest &request = *requests[i];
+        if (isTileRequest(*this, request)) {
+            TileRead tile;
+            tile.level = (size_t)request.level;
+            tile.tileColumn = request.tileColumn;
+            tile.tileRow = request.tileRow;
+            tile.data = buffers[i];
+            tile.code = TE_Ok;
+            tiles.push_back(tile);
+            tileRequests.push_back(i);
+        } else {
+            codes[i] = this->read(buffers[i], request.srcX, request.srcY, request.srcW, request.srcH, request.dstW, request.dstH);
+        }
+    }
+    if (tiles.size() > 1u) {
+        code = this->readTiles(&tiles.at(0), tiles.size());
+        for (size_t i = 0u; i < tiles.size(); i++) {
+            const size_t idx = tileRequests[i];
+            codes[idx] = (code == TE_Ok) ? tiles[i].code : code;
+            // the batch is aborted when any one of its requests is canceled;
+            // read the remaining requests individually
+            if (codes[idx] == TE_Canceled && !requests[idx]->canceled) {
+                const ReadRequest &request = *requests[idx];
+                codes[idx] = this->read(buffers[idx], request.srcX, request.srcY, request.srcW, request.srcH, request.dstW, request.dstH);
             }
         }
+        code = TE_Ok;
+    } else if (!tiles.empty()) {
+        const ReadRequest &request = *requests[tileRequests[0]];
+        codes[tileRequests[0]] = this->read(buffers[tileRequests[0]], request.srcX, request.srcY, request.srcW, request.srcH, request.dstW, request.dstH);
+    }
+
+    for (size_t i = 0u; i < count; i++) {
+        if (acquired[i] == TE_Canceled)
+            continue;
+        if (acquired[i] == TE_Done)
+            releaseDecoded(decodeKeys[i], codes[i], buffers[i], *requests[i], format);
+        if (codes[i] == TE_Ok)
+            notifyUpdate(*requests[i], buffers[i], format);
     }
 
     return code;
@@ -485,6 +758,41 @@ void TileReader2::ReadRequest_run(uint8_t *readBuffer, ReadRequest &request) NOT
     // Log.d(TAG, "read request (" + level + "," + tileColumn + "," +
     // tileRow + ") in " + (e-s) + "ms");
 
+    ReadRequest_complete(request, code);
+}
+
+void TileReader2::ReadRequest_run(uint8_t **readBuffers, ReadRequest **requests, const std::size_t count) NOTHROWS
+{
+    std::vector<uint8_t *> buffers;
+    std::vector<ReadRequest *> started;
+    buffers.reserve(count);
+    started.reserve(count);
+    for (std::size_t i = 0u; i < count; i++) {
+        ReadRequest &request = *requests[i];
+        Thread::Lock lock(request.lock);
+        if (!request.callback)
+            // Aborted
+            continue;
+
+        request.servicing = true;
+        request.callback->requestStarted(request.id);
+        buffers.push_back(readBuffers[i]);
+        started.push_back(&request);
+    }
+    if (started.empty())
+        return;
+
+    TE_TRACE_SCOPE("tilereader", "TileReader2::read");
+    TE_ALLOCATION_TAG(TEAT_TileDecode);
+    std::vector<TAKErr> codes(started.size(), TE_Ok);
+    const TAKErr code = started[0]->owner->fill(&buffers.at(0), &started.at(0), &codes.at(0), started.size());
+
+    for (std::size_t i = 0u; i < started.size(); i++)
+        ReadRequest_complete(*started[i], (code == TE_Ok) ? codes[i] : code);
+}
+
+void TileReader2::ReadRequest_complete(ReadRequest &request, const TAKErr code) NOTHROWS
+{
     {
         Thread::Lock lock(request.lock);
         if (!request.callback)
@@ -499,6 +807,10 @@ void TileReader2::ReadRequest_run(uint8_t *readBuffer, ReadRequest &request) NOT
             cb->requestCanceled(request.id);
             break;
         case TE_Ok:
+            // completion is on an IO thread; attribute to the requester
+            if (request.counters)
+                request.counters->add(TEPC_TileRequestsCompleted, 1u);
+            TE_TRACE_FLOW_END("tilereader", "TileReader2::request", reinterpret_cast<uintptr_t>(&request));
             cb->requestCompleted(request.id);
             break;
         default:
@@ -621,7 +933,8 @@ TileReader2::ReadRequest::ReadRequest(const std::shared_ptr<TileReader2> &owner_
                                                                                              tileColumn(tileColumn_),
                                                                                              level(level_),
                                                                                              lock(Thread::TEMT_Recursive),
-                                                                                             callback(callback_)
+                                                                                             callback(callback_),
+                                                                                             counters(PerformanceCounters_getCurrent())
 {}
 
 void TileReader2::ReadRequest::cancel() NOTHROWS
@@ -653,11 +966,14 @@ TileReader2::AsynchronousIO::AsynchronousIO() NOTHROWS :
     AsynchronousIO(0LL)
 {}
 
-TileReader2::AsynchronousIO::AsynchronousIO(const int64_t maxIdle_) NOTHROWS : tasks(),
-                                                                               currentTask(nullptr),
+TileReader2::AsynchronousIO::AsynchronousIO(const int64_t maxIdle_) NOTHROWS : globalPrioritizer(nullptr, Memory_leaker_const<ReadRequestPrioritizer>),
+                                                                               tasks(),
+                                                                               dispatchCount(0u),
                                                                                syncOn(Thread::TEMT_Recursive),
                                                                                cv(),
-                                                                               thread(nullptr, nullptr),
+                                                                               maxConcurrency(ASYNCIO_MAX_CONCURRENCY),
+                                                                               batchSize(ASYNCIO_DEFAULT_BATCH_SIZE),
+                                                                               activeDrains(0u),
                                                                                dead(true),
                                                                                started(false),
                                                                                maxIdle(maxIdle_)
@@ -666,6 +982,11 @@ TileReader2::AsynchronousIO::AsynchronousIO(const int64_t maxIdle_) NOTHROWS : t
 TileReader2::AsynchronousIO::~AsynchronousIO() NOTHROWS
 {
     release();
+
+    // wait for any in flight drains to observe `dead` and exit
+    Thread::Lock lock(syncOn);
+    while (this->activeDrains)
+        this->cv.wait(lock);
 }
 
 TAKErr TileReader2::AsynchronousIO::release() NOTHROWS
@@ -687,18 +1008,27 @@ TAKErr TileReader2::AsynchronousIO::abortRequests(TileReader2 *reader) NOTHROWS
     {
         Thread::Lock lock(syncOn);
 
-        auto requests = this->tasks.find(reader);
-        if (requests != this->tasks.end()) {
-            requests->second.clear();
-            for (auto request : requests->second)
+        for (auto it = this->tasks.begin(); it != this->tasks.end(); ) {
+            if (reader && it->first != reader) {
+                it++;
+                continue;
+            }
+            for (auto request : it->second.requests)
                 ReadRequest_abort(*request);
-            this->tasks.erase(requests);
+            it->second.requests.clear();
+            // retain the entry while requests are in flight to track the
+            // reader's concurrency
+            if (it->second.active)
+                it++;
+            else
+                it = this->tasks.erase(it);
         }
 
-        if (currentTask && (!reader || currentTask->owner.get() == reader)) {
-            // leave currentTask alone; it belongs to the io thread and that will clean it up
-            ReadRequest_abort(*currentTask);
-            code = TE_Ok;
+        // requests in flight belong to the servicing threads, which will clean
+        // them up
+        for (auto request : this->servicing) {
+            if (!reader || request->owner.get() == reader)
+                ReadRequest_abort(*request);
         }
     }
     return code;
@@ -708,68 +1038,39 @@ TAKErr TileReader2::AsynchronousIO::asyncRead(const std::shared_ptr<ReadRequest>
 {
     TAKErr code(TE_Ok);
 
+    TE_TRACE_SCOPE("tilereader", "TileReader2::asyncRead");
     rr->callback->requestCreated(rr->id);
+    if (rr->counters)
+        rr->counters->add(TEPC_TileRequestsIssued, 1u);
+    TE_TRACE_FLOW_BEGIN("tilereader", "TileReader2::request", reinterpret_cast<uintptr_t>(rr.get()));
     {
         Thread::Lock lock(syncOn);
 
         this->dead = false;
         if (!this->started) {
-            // std::string threadName("tilereader-async-io-thread@" + std::to_string(this->hashCode(), 16));
-            Thread::ThreadCreateParams param;
-            param.name = "tilereader-async-io-thread";
-            param.priority = Thread::TETP_Lowest;
-
-            code = TAK::Engine::Thread::ThreadPool_create(this->thread, 5, threadRun, this);
-
-            if (code == TE_Ok) {
-                this->started = true;
-            } else {
-                this->started = false;
-            }
+            // threads are borrowed from the engine-wide IO class rather than owned
+            this->maxConcurrency = (std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("tilereader.async-io.concurrency", ASYNCIO_MAX_CONCURRENCY), 1);
+            this->batchSize = (std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("tilereader.async-io.batch-size", ASYNCIO_DEFAULT_BATCH_SIZE), 1);
+            code = WorkerRegistry_borrow(this->worker, TEWC_IO, "tilereader-async-io", this->maxConcurrency);
+            this->started = (code == TE_Ok);
         }
         if (this->started) {
-            std::vector<std::shared_ptr<ReadRequest>> &requests = this->tasks[rr->owner.get()];
+            std::vector<std::shared_ptr<ReadRequest>> &requests = this->tasks[rr->owner.get()].requests;
             requests.push_back(rr);
-            struct Cmp
-            {
-                ReadRequestPrioritizer* cmp{ nullptr };
-                bool operator()(const std::shared_ptr<ReadRequest>& a, const std::shared_ptr<ReadRequest>& b) NOTHROWS
-                {
-                    // REMEMBER: requests are pulled of the _tail_ of the queue
-
-                    // canceled requests bubble to the top
-                    if (a->canceled && b->canceled)
-                        return a->id > b->id;
-                    else if (a->canceled)
-                        return false;
-                    else if (b->canceled)
-                        return true;
-
-                    // if a prioritizer is defined, use it
-                    if (cmp) {
-                        const bool a_b = cmp->compare(*a, *b);
-                        const bool b_a = cmp->compare(*b, *a);
-                        // if not equal, return priorization
-                        if (a_b != b_a)
-                            return a_b;
-                    }
-
-                    // prioritize high resolution tiles over low resolution tiles
-                    if(a->level < b->level)
-                        return false;
-                    else if(a->level > b->level)
-                        return true;
-                    else
-                        return a->id<b->id; // LIFO on read requests
-                }
-            };
-            Cmp cmp;
+            RequestComparator cmp;
             auto prioritizer = this->requestPrioritizers.find(rr->owner.get());
             if (prioritizer != this->requestPrioritizers.end())
                 cmp.cmp = prioritizer->second.get();
+            else
+                cmp.cmp = this->globalPrioritizer.get();
             std::sort(requests.begin(), requests.end(), cmp);
 
-            this->cv.signal(lock);
+            if (this->activeDrains < this->maxConcurrency) {
+                this->activeDrains++;
+                code = this->worker->scheduleWork(std::make_shared<DrainWork>(*this));
+                if (code != TE_Ok)
+                    this->activeDrains--;
+            }
         }
     }
     return code;
@@ -785,75 +1086,176 @@ void TileReader2::AsynchronousIO::setReadRequestPrioritizer(const TileReader2& r
     }
 }
 
-TAKErr TileReader2::AsynchronousIO::runImpl() NOTHROWS
+void TileReader2::AsynchronousIO::setReadRequestPrioritizer(ReadRequestPrioritizerPtr&& prioritizer) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-    struct {
-        array_ptr<uint8_t> data;
-        std::size_t length{ 0u };
-    } readBuffer;
+    Thread::Lock lock(syncOn);
+    this->globalPrioritizer = std::move(prioritizer);
+}
 
-    while (true) {
-        std::shared_ptr<ReadRequest> task;
-        // synchronized (this->syncOn)
-        {
-            Thread::Lock lock(syncOn);
+void TileReader2::AsynchronousIO::setReaderConcurrency(const TileReader2& reader, const std::size_t limit) NOTHROWS
+{
+    Thread::Lock lock(syncOn);
+    if (!limit)
+        this->readerConcurrency.erase(&reader);
+    else
+        this->readerConcurrency[&reader] = limit;
+}
 
-            // Clear executing reference
-            currentTask.reset();
+std::size_t TileReader2::AsynchronousIO::getReaderConcurrency(const TileReader2 *reader) const NOTHROWS
+{
+    auto limit = this->readerConcurrency.find(reader);
+    return (limit != this->readerConcurrency.end()) ? limit->second : ASYNCIO_DEFAULT_READER_CONCURRENCY;
+}
 
-            if (this->dead) {
-                this->started = false;
-                break;
+void TileReader2::AsynchronousIO::dispatch(std::vector<std::shared_ptr<TileReader2::ReadRequest>> &value) NOTHROWS
+{
+    value.clear();
+    ReaderQueue *next = nullptr;
+    for (auto it = this->tasks.begin(); it != this->tasks.end(); it++) {
+        ReaderQueue &candidate = it->second;
+        if (candidate.requests.empty())
+            continue;
+        const ReadRequest &head = *candidate.requests.back();
+        // canceled requests complete immediately; drain them first, without
+        // regard to the cap
+        if (head.canceled) {
+            next = &candidate;
+            break;
+        }
+        if (candidate.active >= getReaderConcurrency(it->first))
+            continue;
+        if (!next) {
+            next = &candidate;
+            continue;
+        }
+
+        // order by global priority; consistent with the queue sort, the
+        // request that would sort last is serviced first
+        if (this->globalPrioritizer) {
+            const ReadRequest &best = *next->requests.back();
+            const bool c_b = this->globalPrioritizer->compare(head, best);
+            const bool b_c = this->globalPrioritizer->compare(best, head);
+            if (c_b != b_c) {
+                if (b_c)
+                    next = &candidate;
+                continue;
             }
+        }
+        // round-robin, favoring readers with the fewest requests in flight
+        if (candidate.active < next->active ||
+            (candidate.active == next->active && candidate.lastDispatch < next->lastDispatch)) {
 
-            if (this->tasks.size() < 1) {
-                auto start = std::chrono::high_resolution_clock::now();
+            next = &candidate;
+        }
+    }
+    if (!next)
+        return;
 
-                code = this->cv.wait(lock, this->maxIdle);
-                TE_CHECKBREAK_CODE(code);
+    std::shared_ptr<ReadRequest> task(next->requests.back());
+    next->requests.pop_back();
+    next->active++;
+    next->lastDispatch = ++this->dispatchCount;
+    this->servicing.push_back(task);
+    value.push_back(task);
+
+    // the next highest priority tile requests for the same reader are
+    // serviced with the dispatched request, allowing the reader to coalesce
+    // its IO
+    if (task->canceled || task->level < 0)
+        return;
+    while (value.size() < this->batchSize && !next->requests.empty()) {
+        std::shared_ptr<ReadRequest> batched(next->requests.back());
+        if (batched->canceled || batched->level < 0)
+            break;
+        next->requests.pop_back();
+        this->servicing.push_back(batched);
+        value.push_back(batched);
+    }
+}
 
-                auto end = std::chrono::high_resolution_clock::now();
-                auto timSpan = end - start;
-                // check if the thread has idle'd out
-                if (this->maxIdle > 0L && (timSpan.count()) > this->maxIdle)
-                    this->dead = true;
-                // wake up and re-run the sync block
-                continue;
-            }
+TAKErr TileReader2::AsynchronousIO::runImpl() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    struct {
+        array_ptr<uint8_t> data;
+        std::size_t length{ 0u };
+    } readBuffer;
 
-            std::vector<std::shared_ptr<ReadRequest>>* requests = &this->tasks.begin()->second;
-            for (auto it = this->tasks.begin(); it != this->tasks.end(); it++) {
-                if (it->second.back()->id < requests->back()->id)
-                    requests = &it->second;
-            }
+    std::vector<std::shared_ptr<ReadRequest>> batch;
+    std::vector<ReadRequest *> requests;
+    std::vector<std::size_t> offsets;
+    std::vector<uint8_t *> buffers;
+    // synchronized (this->syncOn)
+    {
+        Thread::Lock lock(syncOn);
 
-            task = requests->back();
-            requests->pop_back();
-            if (requests->empty())
-                this->tasks.erase(task->owner.get());
-            currentTask = task;
+        // the drain returns its thread to the pool once there is no work
+        // it may service; idle threads are retired by the worker registry.
+        // Drains servicing capped readers will pick up any remaining work
+        // as their requests complete.
+        if (!this->dead)
+            dispatch(batch);
+        if (batch.empty()) {
+            this->activeDrains--;
+            this->cv.broadcast(lock);
+            return code;
         }
+    }
 
-        do {
+    do {
+        // the requests in the batch are read into a single buffer
+        requests.clear();
+        offsets.clear();
+        std::size_t total = 0u;
+        for (const auto &task : batch) {
             std::size_t req;
             if (task->owner->getTransferSize(&req, task->dstW, task->dstH) != TE_Ok)
+                continue;
+            requests.push_back(task.get());
+            offsets.push_back(total);
+            total += req;
+        }
+        if (requests.empty())
+            break;
+        if (readBuffer.length < total) {
+            readBuffer.length = 0u;
+            readBuffer.data.reset(new(std::nothrow) uint8_t[total]);
+            if (!readBuffer.data.get())
                 break;
-            if (readBuffer.length < req) {
-                readBuffer.length = 0u;
-                readBuffer.data.reset(new(std::nothrow) uint8_t[req]);
-                if (!readBuffer.data.get())
-                    break;
-                readBuffer.length = req;
-            }
-            ReadRequest_run(readBuffer.data.get(), *task);
-        } while (false);
+            readBuffer.length = total;
+        }
+        if (requests.size() == 1u) {
+            ReadRequest_run(readBuffer.data.get(), *requests[0]);
+            break;
+        }
+        buffers.resize(requests.size());
+        for (std::size_t i = 0u; i < requests.size(); i++)
+            buffers[i] = readBuffer.data.get() + offsets[i];
+        ReadRequest_run(&buffers.at(0), &requests.at(0), requests.size());
+    } while (false);
+
+    // synchronized (this->syncOn)
+    {
+        Thread::Lock lock(syncOn);
+
+        // retire the serviced requests
+        for (const auto &task : batch) {
+            auto it = std::find(this->servicing.begin(), this->servicing.end(), task);
+            if (it != this->servicing.end())
+                this->servicing.erase(it);
+        }
+        auto queue = this->tasks.find(batch[0]->owner.get());
+        if (queue != this->tasks.end()) {
+            queue->second.active--;
+            if (!queue->second.active && queue->second.requests.empty())
+                this->tasks.erase(queue);
+        }
+
+        // requeue behind any other work scheduled on the IO class
+        if (!this->dead && this->worker->scheduleWork(std::make_shared<DrainWork>(*this)) == TE_Ok)
+            return code;
+        this->activeDrains--;
+        this->cv.broadcast(lock);
     }
     return code;
 }
-
-void *TileReader2::AsynchronousIO::threadRun(void *threadData)
-{
-    static_cast<TileReader2::AsynchronousIO *>(threadData)->runImpl();
-    return nullptr;
-}
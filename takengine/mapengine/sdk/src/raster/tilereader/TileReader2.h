@@ -9,7 +9,6 @@
 
 #include "thread/Cond.h"
 #include "thread/Mutex.h"
-#include "thread/ThreadPool.h"
 
 #include "port/Platform.h"
 #include "port/Collection.h"
@@ -17,6 +16,8 @@
 #include "renderer/Bitmap2.h"
 #include "core/Control.h"
 #include "util/Error.h"
+#include "util/PerformanceCounters.h"
+#include "util/Work.h"
 
 namespace TAK {
     namespace Engine {
@@ -38,6 +39,7 @@ namespace TAK {
                     class AsynchronousReadRequestListener;
                     class AsynchronousIO;
                     class ReadRequestPrioritizer;
+                    struct TileRead;
                     /**************************************************************************/
                    protected:
                     /**
@@ -149,6 +151,25 @@ namespace TAK {
                      */
                     virtual Util::TAKErr read(uint8_t *buf, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH,
                                               const size_t dstW, const size_t dstH) NOTHROWS = 0;
+                    /**
+                     * Reads a batch of tiles. Each tile is read as if by
+                     * read(uint8_t *, const size_t, const int64_t, const int64_t) and
+                     * the result of each read is recorded in the tile's
+                     * <code>code</code>.
+                     *
+                     * <P>The default implementation acquires the read lock once and
+                     * reads the tiles in order. Readers may override to order the
+                     * reads by location in the source, coalesce I/O and share
+                     * decoded source blocks between tiles.
+                     *
+                     * @param tiles The tiles to be read
+                     * @param count The number of tiles
+                     *
+                     * @return TE_Ok if the batch was serviced, in which case the
+                     *         result for each tile is recorded in the tile; various
+                     *         codes on failure of the whole batch
+                     */
+                    virtual Util::TAKErr readTiles(TileRead *tiles, const size_t count) NOTHROWS;
 
                    private:
                     int nextRequestId() NOTHROWS;
@@ -172,6 +193,19 @@ namespace TAK {
                      * @return TE_Ok on success, various codes on failure
                      */
                     Util::TAKErr fill(uint8_t *buffer, ReadRequest &request) NOTHROWS;
+                    /**
+                     * Fills the specified asynchronous ReadRequests as a batch. The
+                     * read lock is acquired once for the batch and the tile
+                     * requests not available from the decode cache are serviced via
+                     * readTiles().
+                     *
+                     * @param buffers   The output buffer for each request
+                     * @param requests  The requests to be filled
+                     * @param codes     Returns the result for each request
+                     * @param count     The number of requests
+                     * @return TE_Ok if the batch was serviced, various codes on failure
+                     */
+                    Util::TAKErr fill(uint8_t **buffers, ReadRequest **requests, Util::TAKErr *codes, const size_t count) NOTHROWS;
 
                    public:
                     /**
@@ -358,6 +392,8 @@ namespace TAK {
                     /**************************************************************************/
                    private:
                     static void ReadRequest_run(uint8_t *readBuffer, ReadRequest &request) NOTHROWS;
+                    static void ReadRequest_run(uint8_t **readBuffers, ReadRequest **requests, const std::size_t count) NOTHROWS;
+                    static void ReadRequest_complete(ReadRequest &request, const Util::TAKErr code) NOTHROWS;
                     static void ReadRequest_abort(ReadRequest &request) NOTHROWS;
 
                    protected:
@@ -388,6 +424,23 @@ namespace TAK {
 
                 typedef std::unique_ptr<TileReader2, void (*)(const TileReader2 *)> TileReader2Ptr;
 
+                /**
+                 * A tile to be read by TileReader2::readTiles().
+                 */
+                struct TileReader2::TileRead
+                {
+                    /** The resolution level */
+                    size_t level;
+                    /** The tile column */
+                    int64_t tileColumn;
+                    /** The tile row */
+                    int64_t tileRow;
+                    /** Output buffer for the data of the tile */
+                    uint8_t *data;
+                    /** output - the result of the read */
+                    Util::TAKErr code;
+                };
+
                 /**
                  * An asynchronous read request. Defines the region or tile to be read and
                  * provides a mechanism to cancel the request asynchronously.
@@ -462,6 +515,9 @@ namespace TAK {
                     AsynchronousReadRequestListener *callback;
 
                 private :
+                    /** the counters bound to the requesting thread at creation */
+                    std::shared_ptr<Util::PerformanceCounters> counters;
+
                     friend class TileReader2;
                     friend class TileReader2::AsynchronousIO;
                 };
@@ -547,13 +603,27 @@ namespace TAK {
                 typedef std::unique_ptr<TileReader2::ReadRequestPrioritizer, void(*)(const TileReader2::ReadRequestPrioritizer *)> ReadRequestPrioritizerPtr;
 
                 /**
-                 * The asynchronous I/O thread for use by one or more
-                 * <code>TileReader</code> instances. The same instance can be utilized by
-                 * multiple <code>TileReader</code> objects to ensure data reading and
-                 * delivery in series rather than in parallel. Forcing request servicing
-                 * into series rather than in parallel can be advantageous in memory
-                 * constrained environments when trying to render virtual mosaics from
-                 * multiple files/tile readers onto a single canvas.
+                 * The asynchronous I/O scheduler for use by one or more
+                 * <code>TileReader</code> instances. Requests are serviced on
+                 * threads borrowed from the engine IO worker class. Requests
+                 * for different readers are serviced in parallel; the number
+                 * of requests serviced concurrently for any one reader is
+                 * capped so that a slow reader cannot occupy every thread and
+                 * stall the others.
+                 *
+                 * <P>When a thread becomes available, the highest priority
+                 * pending request of each reader below its cap is a
+                 * candidate. Candidates are ordered by the global
+                 * prioritizer, if set; candidates it considers equal are
+                 * serviced round-robin, favoring readers with the fewest
+                 * requests in flight.
+                 *
+                 * <P>When a tile request is dispatched, the next highest
+                 * priority tile requests pending for the same reader are
+                 * dispatched with it, up to the
+                 * <code>tilereader.async-io.batch-size</code> option, and
+                 * filled as a single batch. The batch counts as one
+                 * request against the reader's cap.
                  *
                  * @author Developer
                  */
@@ -591,21 +661,65 @@ namespace TAK {
                      */
                     Util::TAKErr asyncRead(const std::shared_ptr<ReadRequest> &request) NOTHROWS;
 
+                    /**
+                     * Sets the prioritizer used to order the pending requests
+                     * of the specified reader. If not set, the global
+                     * prioritizer is used.
+                     */
                     void setReadRequestPrioritizer(const TileReader2& reader, ReadRequestPrioritizerPtr&& prioritizer) NOTHROWS;
+                    /**
+                     * Sets the prioritizer used to order requests across all
+                     * readers. The prioritizer will be invoked with requests
+                     * from different readers.
+                     */
+                    void setReadRequestPrioritizer(ReadRequestPrioritizerPtr&& prioritizer) NOTHROWS;
+                    /**
+                     * Sets the maximum number of requests for the specified
+                     * reader that may be serviced concurrently. A value of
+                     * `0` restores the default of `1`; reads against a single
+                     * reader are serialized on its read lock, so larger
+                     * values are only useful if the reader services requests
+                     * without contention.
+                     */
+                    void setReaderConcurrency(const TileReader2& reader, const std::size_t limit) NOTHROWS;
                    private:
+                    struct ReaderQueue
+                    {
+                        /** pending requests, highest priority at the tail */
+                        std::vector<std::shared_ptr<TileReader2::ReadRequest>> requests;
+                        /** number of requests currently being serviced */
+                        std::size_t active{0u};
+                        /** dispatch sequence of the most recently serviced request */
+                        uint64_t lastDispatch{0u};
+                    };
+
+                    class DrainWork;
 
                     Util::TAKErr runImpl() NOTHROWS;
-
-                    static void *threadRun(void *threadData);
+                    /**
+                     * Removes the next batch of requests to be serviced from
+                     * the queues. The batch is empty if no reader below its
+                     * cap has pending requests. Must be invoked while holding
+                     * `syncOn`.
+                     */
+                    void dispatch(std::vector<std::shared_ptr<TileReader2::ReadRequest>> &value) NOTHROWS;
+                    std::size_t getReaderConcurrency(const TileReader2 *reader) const NOTHROWS;
 
                    private:
+                    ReadRequestPrioritizerPtr globalPrioritizer;
                     std::map<const TileReader2 *, ReadRequestPrioritizerPtr> requestPrioritizers;
-                    std::map<const TileReader2 *, std::vector<std::shared_ptr<TileReader2::ReadRequest>>> tasks;
+                    std::map<const TileReader2 *, std::size_t> readerConcurrency;
+                    /** entries are retained while requests are pending or in flight */
+                    std::map<const TileReader2 *, ReaderQueue> tasks;
                     // Valid only when holding lock
-                    std::shared_ptr<TileReader2::ReadRequest> currentTask;
+                    std::vector<std::shared_ptr<TileReader2::ReadRequest>> servicing;
+                    uint64_t dispatchCount;
                     Thread::Mutex syncOn;
                     Thread::CondVar cv;
-                    Thread::ThreadPoolPtr thread;
+                    Util::SharedWorkerPtr worker;
+                    std::size_t maxConcurrency;
+                    std::size_t batchSize;
+                    std::size_t activeDrains;
                     bool dead;
                     bool started;
                     const int64_t maxIdle;
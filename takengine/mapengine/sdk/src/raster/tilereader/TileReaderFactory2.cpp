@@ -1,8 +1,10 @@
 #include "raster/tilereader/TileReaderFactory2.h"
+#include "formats/cog/COGTileReader.h"
 #include "util/CopyOnWrite.h"
 #include <map>
 #include <functional>
 
+using namespace TAK::Engine::Formats::COG;
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Raster::TileReader;
 
@@ -23,6 +25,19 @@ namespace {
     };
 
     CopyOnWrite<TileReaderSpi2Registry> &sharedTileReader2Registry();
+
+    class LazyTileReaderSpi2 : public TileReaderSpi2
+    {
+       public:
+        LazyTileReaderSpi2(const LazySpiDescriptor &descriptor, std::shared_ptr<TileReaderSpi2>(*factory)()) NOTHROWS;
+        const char *getName() const NOTHROWS override;
+        TAKErr create(TileReader2Ptr &reader, const char *uri, const TileReaderFactory2Options *options) const NOTHROWS override;
+        TAKErr isSupported(const char *uri) const NOTHROWS override;
+        int getPriority() const NOTHROWS override;
+
+       private:
+        mutable LazySpi<TileReaderSpi2> impl;
+    };
 }
 
 
@@ -42,6 +57,20 @@ TAKErr TAK::Engine::Raster::TileReader::TileReaderFactory2_register(const std::s
     return sharedTileReader2Registry().invokeWrite(&TileReaderSpi2Registry::registerSpi, spi);
 }
 
+TAKErr TAK::Engine::Raster::TileReader::TileReaderFactory2_register(const LazySpiDescriptor &descriptor, std::shared_ptr<TileReaderSpi2>(*factory)(), std::shared_ptr<TileReaderSpi2> *value) NOTHROWS
+{
+    if (!descriptor.name || !factory)
+        return TE_InvalidArg;
+    std::shared_ptr<TileReaderSpi2> spi(new(std::nothrow) LazyTileReaderSpi2(descriptor, factory));
+    if (!spi)
+        return TE_OutOfMemory;
+    TAKErr code = TileReaderFactory2_register(spi);
+    TE_CHECKRETURN_CODE(code);
+    if (value)
+        *value = spi;
+    return code;
+}
+
 TAKErr TAK::Engine::Raster::TileReader::TileReaderFactory2_unregister(const std::shared_ptr<TileReaderSpi2> &spi) NOTHROWS
 {
     return sharedTileReader2Registry().invokeWrite(&TileReaderSpi2Registry::unregisterSpi, spi);
@@ -79,9 +108,55 @@ TileReaderSpi2::~TileReaderSpi2() {}
 
 namespace {
 
+    LazyTileReaderSpi2::LazyTileReaderSpi2(const LazySpiDescriptor &descriptor, std::shared_ptr<TileReaderSpi2>(*factory)()) NOTHROWS :
+        impl(descriptor, factory)
+    {}
+    const char *LazyTileReaderSpi2::getName() const NOTHROWS
+    {
+        return impl.getName();
+    }
+    TAKErr LazyTileReaderSpi2::create(TileReader2Ptr &reader, const char *uri, const TileReaderFactory2Options *options) const NOTHROWS
+    {
+        if (!impl.matches(uri))
+            return TE_Unsupported;
+        std::shared_ptr<TileReaderSpi2> spi;
+        TAKErr code = impl.get(spi);
+        TE_CHECKRETURN_CODE(code);
+        return spi->create(reader, uri, options);
+    }
+    TAKErr LazyTileReaderSpi2::isSupported(const char *uri) const NOTHROWS
+    {
+        if (!impl.matches(uri))
+            return TE_Unsupported;
+        std::shared_ptr<TileReaderSpi2> spi;
+        TAKErr code = impl.get(spi);
+        TE_CHECKRETURN_CODE(code);
+        return spi->isSupported(uri);
+    }
+    int LazyTileReaderSpi2::getPriority() const NOTHROWS
+    {
+        return impl.getPriority();
+    }
+
+    std::shared_ptr<TileReaderSpi2> createCOGTileReaderSpi()
+    {
+        return std::make_shared<COGTileReaderSpi>();
+    }
+
+    /** registers the SDK readers; each is instantiated on first use */
+    bool registerDefaultSpis(CopyOnWrite<TileReaderSpi2Registry> &registry) NOTHROWS
+    {
+        static const char *const cogExtensions[] = { ".tif", ".tiff" };
+        const LazySpiDescriptor cog { "cog", 1, cogExtensions, 2u };
+        const std::shared_ptr<TileReaderSpi2> spi(new(std::nothrow) LazyTileReaderSpi2(cog, createCOGTileReaderSpi));
+        return spi && registry.invokeWrite(&TileReaderSpi2Registry::registerSpi, spi) == TE_Ok;
+    }
+
     CopyOnWrite<TileReaderSpi2Registry> &sharedTileReader2Registry()
     {
         static CopyOnWrite<TileReaderSpi2Registry> registry;
+        static const bool defaultSpis = registerDefaultSpis(registry);
+        (void)defaultSpis;
         return registry;
     }
 
@@ -5,6 +5,7 @@
 #include "port/Collection.h"
 #include "raster/tilereader/TileReader2.h"
 #include "util/Error.h"
+#include "util/LazySpi.h"
 
 namespace TAK {
     namespace Engine {
@@ -38,6 +39,15 @@ namespace TAK {
                 ENGINE_API Util::TAKErr TileReaderFactory2_create(TileReader2Ptr &reader, const char *uri) NOTHROWS;
                 ENGINE_API Util::TAKErr TileReaderFactory2_create(TileReader2Ptr &reader, const char *uri, const TileReaderFactory2Options *options) NOTHROWS;
                 ENGINE_API Util::TAKErr TileReaderFactory2_register(const std::shared_ptr<TileReaderSpi2> &spi) NOTHROWS;
+                /**
+                 * Registers an SPI that is instantiated on the first
+                 * request whose URI matches the descriptor's extensions.
+                 *
+                 * @param value Returns the registered SPI, which may be
+                 *              passed to `TileReaderFactory2_unregister`;
+                 *              may be `nullptr`
+                 */
+                ENGINE_API Util::TAKErr TileReaderFactory2_register(const Util::LazySpiDescriptor &descriptor, std::shared_ptr<TileReaderSpi2>(*factory)(), std::shared_ptr<TileReaderSpi2> *value = nullptr) NOTHROWS;
                 ENGINE_API Util::TAKErr TileReaderFactory2_unregister(const std::shared_ptr<TileReaderSpi2> &spi) NOTHROWS;
                 ENGINE_API Util::TAKErr TileReaderFactory2_isSupported(const char *uri) NOTHROWS;
                 ENGINE_API Util::TAKErr TileReaderFactory2_isSupported(const char *uri, const char *hint) NOTHROWS;
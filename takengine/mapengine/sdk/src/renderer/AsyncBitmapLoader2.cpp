@@ -3,8 +3,10 @@
 
 #include "renderer/BitmapFactory2.h"
 #include "thread/Lock.h"
+#include "util/ConfigOptions.h"
 #include "util/NonHeapAllocatable.h"
 #include "util/ProtocolHandler.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine::Renderer;
 
@@ -16,6 +18,21 @@ using namespace atakmap::util;
 
 namespace
 {
+    struct DecodeRequest
+    {
+        std::string uri;
+        BitmapDecodeOptions opts;
+        bool hasOpts;
+        /** cache shared by requests for the URI; `nullptr` if not cached */
+        std::shared_ptr<BitmapCache> cache;
+        /** the previously decoded bitmap, if cached when requested */
+        std::shared_ptr<Bitmap2> bitmap;
+    };
+
+    /** prefixes URIs without a protocol with the file protocol */
+    std::string normalizeUri(const char *uri) NOTHROWS;
+    TAKErr decodeUri(std::shared_ptr<Bitmap2> &value, const char **message, const DecodeRequest &request) NOTHROWS;
+
     FileProtocolHandler fileHandler;
     ZipProtocolHandler zipHandler;
 
@@ -28,13 +45,50 @@ namespace
     }
 }
 
+/**
+ * Runs the job at the head of a queue on a borrowed IO worker. One work
+ * item is scheduled per job, so the worker registry may interleave the
+ * jobs with those of other subsystems.
+ */
+class AsyncBitmapLoader2::QueueWork : public Work
+{
+public :
+    QueueWork(const std::shared_ptr<Queue> &queue_) NOTHROWS :
+        queue(queue_)
+    {}
+protected :
+    TAKErr onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS override
+    {
+        lockPtr.reset();
+
+        Task job;
+        {
+            Lock lock(queue->jobMutex);
+            if (!queue->shouldTerminate && !queue->jobQueue.empty()) {
+                job = queue->jobQueue.front();
+                queue->jobQueue.pop_front();
+            }
+        }
+        if (job)
+            threadTryDecode(job);
+
+        Lock lock(queue->jobMutex);
+        queue->activeWork--;
+        queue->jobCond.broadcast(lock);
+        return TE_Ok;
+    }
+private :
+    std::shared_ptr<Queue> queue;
+};
+
 RWMutex AsyncBitmapLoader2::decoderHandlerMutex;
 std::map<std::string, std::string> AsyncBitmapLoader2::protoSchemeQueueHints;
 
 AsyncBitmapLoader2::AsyncBitmapLoader2(const std::size_t threadCount, bool notifyThreadsOnDestruct) NOTHROWS :
     threadCount(threadCount),
     notifyThreadsOnDestruct(notifyThreadsOnDestruct),
-    shouldTerminate(false)
+    shouldTerminate(false),
+    cache(std::make_shared<BitmapCache>((std::size_t)ConfigOptions_getIntOptionOrDefault("asyncbitmaploader2.decoded-cache-size", 8 * 1024 * 1024)))
 {
     static bool rh = registerHandlers();
 }
@@ -46,32 +100,26 @@ AsyncBitmapLoader2::~AsyncBitmapLoader2() NOTHROWS
     // Firstly, mark as terminated so nothing new is accepted
     shouldTerminate = true;
 
-    std::map<std::string, Queue *>::iterator iter;
-    for (iter = queues.begin(); iter != queues.end(); iter++)
-        delete iter->second;
+    for (auto iter = queues.begin(); iter != queues.end(); iter++)
+        terminate(*iter->second);
     queues.clear();
 }
 
 
 TAKErr AsyncBitmapLoader2::loadBitmapUri(Task &task, const char *curi) NOTHROWS
+{
+    return loadBitmapUri(task, curi, nullptr);
+}
+
+TAKErr AsyncBitmapLoader2::loadBitmapUri(Task &task, const char *curi, const BitmapDecodeOptions *opts) NOTHROWS
 {
     if (!curi)
         return TE_InvalidArg;
 
     Lock lock(queuesMutex);
 
-    std::string uri(curi);
-
-    std::size_t cloc = uri.find_first_of(':');
-    // if the URI does not have a protocol, assume it's a file
-    if (cloc == std::string::npos) {
-        std::ostringstream strm;
-        strm << "file://";
-        strm << uri;
-
-        uri = strm.str();
-        cloc = 4;
-    }
+    const std::string uri(normalizeUri(curi));
+    const std::size_t cloc = uri.find_first_of(':');
 
     std::string scheme = uri.substr(0, cloc);
     if (!ProtocolHandler_isHandlerRegistered(scheme.c_str())) {
@@ -86,13 +134,29 @@ TAKErr AsyncBitmapLoader2::loadBitmapUri(Task &task, const char *curi) NOTHROWS
         return TE_IllegalState;
     }
 
-    task.reset(new FutureTask<std::shared_ptr<Bitmap2>>(decodeUriFn, (void*)new std::string(uri)));
+    std::unique_ptr<DecodeRequest> request(new DecodeRequest());
+    request->uri = uri;
+    request->hasOpts = !!opts;
+    if (opts)
+        request->opts = *opts;
+    else
+        request->cache = cache;
+    const bool cached = request->cache && (request->cache->get(request->bitmap, uri.c_str()) == TE_Ok);
+    task.reset(new FutureTask<std::shared_ptr<Bitmap2>>(decodeUriFn, (void*)request.release()));
+    if (cached) {
+        // no decode is required; complete without queuing
+        task->run();
+        return TE_Ok;
+    }
 
-    Queue *queue = queues[queueHint];
-    Lock queueLock(queue->jobMutex);
-    queue->jobQueue.push_back(Task(task));
-    queue->jobCond.signal(queueLock);
-    return TE_Ok;
+    return enqueue(queues[queueHint], task);
+}
+
+TAKErr AsyncBitmapLoader2::getCachedBitmap(std::shared_ptr<Bitmap2> &value, const char *curi) NOTHROWS
+{
+    if (!curi)
+        return TE_InvalidArg;
+    return cache->get(value, normalizeUri(curi).c_str());
 }
 
 TAKErr AsyncBitmapLoader2::loadBitmapTask(const Task &task, const char *queueHint) NOTHROWS
@@ -107,11 +171,7 @@ TAKErr AsyncBitmapLoader2::loadBitmapTask(const Task &task, const char *queueHin
         return TE_IllegalState;
     }
 
-    Queue *queue = queues[std::string(queueHint ? queueHint : "")];
-    Lock queueLock(queue->jobMutex);
-    queue->jobQueue.push_back(Task(task));
-    queue->jobCond.signal(queueLock);
-    return TE_Ok;
+    return enqueue(queues[std::string(queueHint ? queueHint : "")], task);
 }
 
 
@@ -153,51 +213,54 @@ bool AsyncBitmapLoader2::ensureThread(const char *queueHint)
     if (shouldTerminate)
         return false;
 
-    Queue *queue;
+    std::shared_ptr<Queue> &queue = queues[std::string(queueHint ? queueHint : "")];
+    if (!queue)
+        queue = std::make_shared<Queue>();
 
-    std::map<std::string, Queue *>::iterator entry;
-    entry = queues.find(std::string(queueHint ? queueHint : ""));
-    if (entry == queues.end()) {
-        std::unique_ptr<Queue> queuePtr(queue=new Queue(*this));
-        queues[std::string(queueHint ? queueHint : "")] = queuePtr.release();
-    } else {
-        queue = entry->second;
-    }
-
-    if (queue->threadPool.get() == nullptr) {
-
-        // init threads
-        return ( ThreadPool_create(queue->threadPool, threadCount, threadProcessEntry, queue) == TE_Ok );
+    if (!queue->worker) {
+        // threads are borrowed from the engine-wide IO class rather than owned
+        return (WorkerRegistry_borrow(queue->worker, TEWC_IO, "asyncbitmaploader2", threadCount) == TE_Ok);
     }
 
     return true;
 }
 
-void *AsyncBitmapLoader2::threadProcessEntry(void *opaque)
+TAKErr AsyncBitmapLoader2::enqueue(const std::shared_ptr<Queue> &queue, const Task &job) NOTHROWS
 {
-    auto *obj = (Queue *)opaque;
-    obj->owner.threadProcess(*obj);
-    return nullptr;
+    TAKErr code(TE_Ok);
+    Lock lock(queue->jobMutex);
+    queue->jobQueue.push_back(job);
+    queue->activeWork++;
+    code = queue->worker->scheduleWork(std::make_shared<QueueWork>(queue));
+    if (code != TE_Ok) {
+        queue->activeWork--;
+        queue->jobQueue.pop_back();
+    }
+    return code;
 }
 
-void AsyncBitmapLoader2::threadProcess(Queue &queue)
+void AsyncBitmapLoader2::terminate(Queue &queue) NOTHROWS
 {
-    while (true) {
-        Task job;
-        {
-            Lock lock(queue.jobMutex);
-            if (shouldTerminate)
-                break;
-
-            if (queue.jobQueue.empty()) {
-                queue.jobCond.wait(lock);
-                continue;
-            }
+    Lock lock(queue.jobMutex);
+
+    // Firstly, mark as terminated so nothing new is started
+    queue.shouldTerminate = true;
+
+    // Unstarted jobs are canceled with a callback indicating they are dead
+    // due to termination of the loader; their work items complete without
+    // running them
+    while (!queue.jobQueue.empty()) {
+        Task job = queue.jobQueue.front();
+        job->getFuture().cancel();
+        queue.jobQueue.pop_front();
+    }
 
-            job = queue.jobQueue.front();
-            queue.jobQueue.pop_front();
-        }
-        threadTryDecode(job);
+    // In-progress jobs may complete. The work items retain the queue, so
+    // they may safely run after the loader is destroyed when not waiting
+    // on them
+    if (notifyThreadsOnDestruct) {
+        while (queue.activeWork)
+            queue.jobCond.wait(lock);
     }
 }
 
@@ -215,71 +278,93 @@ std::shared_ptr<Bitmap2> AsyncBitmapLoader2::decodeUriFn(void *opaque)
 {
     TAKErr code;
 
-    std::unique_ptr<std::string> uri(static_cast<std::string *>(opaque));
-
-    // First try to handle the protocol
-    size_t cloc = uri->find_first_of(':');
-    if (cloc == std::string::npos)
-        throw std::invalid_argument("no protocol defined");
+    std::unique_ptr<DecodeRequest> request(static_cast<DecodeRequest *>(opaque));
+    if (request->bitmap)
+        return request->bitmap;
 
-    std::string scheme = uri->substr(0, cloc);
+    std::shared_ptr<Bitmap2> bitmap;
 
-    DataInput2Ptr ctx(nullptr, nullptr);
-    code = ProtocolHandler_handleURI(ctx, uri->c_str());
-    if (code != TE_Ok)
-        throw std::runtime_error("failed to handle URI");
+    // join any decode of the same URI that is already in progress
+    BitmapCache *cache = request->cache.get();
+    if (cache) {
+        code = cache->acquire(bitmap, request->uri.c_str());
+        if (code == TE_Ok)
+            return bitmap;
+        else if (code != TE_Done)
+            cache = nullptr;
+    }
 
-    BitmapPtr b(nullptr, nullptr);
-    code = BitmapFactory2_decode(b, *ctx, nullptr);
-    const bool success = (code == TE_Ok && b.get());
-    ctx.reset();
+    const char *message = nullptr;
+    code = decodeUri(bitmap, &message, *request);
+    if (cache) {
+        if (code == TE_Ok)
+            cache->put(request->uri.c_str(), bitmap);
+        else
+            cache->abandon(request->uri.c_str());
+    }
 
-    if (!success)
-        throw std::runtime_error("failed to decode bitmap");
+    if (code == TE_InvalidArg)
+        throw std::invalid_argument(message);
+    else if (code != TE_Ok)
+        throw std::runtime_error(message);
 
-    return std::shared_ptr<Bitmap2>(std::move(b));
+    return bitmap;
 }
 
-AsyncBitmapLoader2::Queue::Queue(AsyncBitmapLoader2 &owner_) NOTHROWS :
-    owner(owner_),
-    shouldTerminate(false),
-    threadPool(nullptr, nullptr)
-{}
-
-AsyncBitmapLoader2::Queue::~Queue() NOTHROWS
+namespace
 {
-    TAK::Engine::Thread::ThreadPoolPtr ltp(nullptr, nullptr);
+    std::string normalizeUri(const char *curi) NOTHROWS
     {
-        Lock lock(jobMutex);
-
-        // Firstly, mark as terminated so nothing new is accepted
-        shouldTerminate = true;
+        std::string uri(curi);
+        // if the URI does not have a protocol, assume it's a file
+        if (uri.find_first_of(':') == std::string::npos) {
+            std::ostringstream strm;
+            strm << "file://";
+            strm << uri;
+
+            uri = strm.str();
+        }
+        return uri;
+    }
 
-        if (threadPool.get()) {
-            ltp = std::move(threadPool);
-            threadPool.reset();
+    TAKErr decodeUri(std::shared_ptr<Bitmap2> &value, const char **message, const DecodeRequest &request) NOTHROWS
+    {
+        TAKErr code;
+        const std::string *uri = &request.uri;
+
+        // First try to handle the protocol
+        size_t cloc = uri->find_first_of(':');
+        if (cloc == std::string::npos) {
+            *message = "no protocol defined";
+            return TE_InvalidArg;
+        }
 
-            // kill threads first - release lock and join
-            // In-progress jobs may complete; unstarted jobs will linger in queue
-            if (owner.notifyThreadsOnDestruct)
-                jobCond.broadcast(lock);           
+        DataInput2Ptr ctx(nullptr, nullptr);
+        code = ProtocolHandler_handleURI(ctx, uri->c_str());
+        if (code != TE_Ok) {
+            *message = "failed to handle URI";
+            return code;
         }
-    }
 
-    // wait for threads to exit
-    if (owner.notifyThreadsOnDestruct && ltp.get())
-        ltp->joinAll();
+        BitmapPtr b(nullptr, nullptr);
+        code = BitmapFactory2_decode(b, *ctx, request.hasOpts ? &request.opts : nullptr);
+        const bool success = (code == TE_Ok && b.get());
+        ctx.reset();
 
-    {
-        Lock lock(jobMutex);
-        ltp.reset();
-
-        // Now look at remaining jobs and clean them out with callback indicating
-        // they are dead due to termination of the loader
-        while (!jobQueue.empty()) {
-            Task job = jobQueue.front();
-            job->getFuture().cancel();
-            jobQueue.pop_front();
+        if (!success) {
+            *message = "failed to decode bitmap";
+            return TE_Err;
         }
+
+        value = std::shared_ptr<Bitmap2>(std::move(b));
+        return TE_Ok;
     }
 }
+
+AsyncBitmapLoader2::Queue::Queue() NOTHROWS :
+    shouldTerminate(false),
+    activeWork(0u)
+{}
+
+AsyncBitmapLoader2::Queue::~Queue() NOTHROWS
+{}
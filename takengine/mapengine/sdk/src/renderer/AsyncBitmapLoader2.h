@@ -12,6 +12,8 @@
 
 #include "port/Platform.h"
 #include "renderer/Bitmap2.h"
+#include "renderer/BitmapCache.h"
+#include "renderer/BitmapFactory2.h"
 #include "thread/Mutex.h"
 #include "thread/Lock.h"
 #include "thread/Cond.h"
@@ -20,6 +22,7 @@
 #include "util/Error.h"
 #include "util/FutureTask.h"
 #include "util/NonCopyable.h"
+#include "util/Work.h"
 
 namespace TAK
 {
@@ -37,6 +40,7 @@ namespace TAK
                 typedef std::shared_ptr<atakmap::util::FutureTask<std::shared_ptr<Bitmap2>>> Task;
             private :
                 struct Queue;
+                class QueueWork;
 
             public :
                 // Normally deleting the loader will wait on queue threads to exit, but
@@ -55,7 +59,21 @@ namespace TAK
                 // this bitmap loader is already in shutdown mode
                 // Listener is assumed valid until either the job is completed or
                 // this bitmaploader is destroyed.
+                // Concurrent requests for the same URI share a single decode,
+                // and decoded bitmaps are retained in a cache bounded by the
+                // "asyncbitmaploader2.decoded-cache-size" config option
+                // (bytes). A request for a cached bitmap completes before
+                // returning. Bitmaps may be shared between requests and must
+                // not be modified.
                 Util::TAKErr loadBitmapUri(Task &task, const char *uri) NOTHROWS;
+                // As above, decoding with the specified options. Options
+                // specifying a target size or region allow oversized
+                // sources to be decoded without a full resolution decode.
+                // Requests with options bypass the cache.
+                Util::TAKErr loadBitmapUri(Task &task, const char *uri, const BitmapDecodeOptions *opts) NOTHROWS;
+                // Obtains the decoded bitmap for the URI if it is cached,
+                // without blocking. Returns TE_Done if not cached.
+                Util::TAKErr getCachedBitmap(std::shared_ptr<Bitmap2> &value, const char *uri) NOTHROWS;
 
                 // Returns a job identifier or JOB_REJECTED if
                 // this bitmap loader is already in shutdown mode
@@ -77,26 +95,32 @@ namespace TAK
 
                 Thread::Mutex queuesMutex;
                 bool shouldTerminate;
-                std::map<std::string, Queue *> queues;
+                /** queues are shared with their scheduled work */
+                std::map<std::string, std::shared_ptr<Queue>> queues;
+                /** shared with pending requests */
+                std::shared_ptr<BitmapCache> cache;
 
-                static void *threadProcessEntry(void *opaque);
-                void threadProcess(Queue &queue);
-                void threadTryDecode(const Task &job);
+                /** enqueues the job and schedules a work item to run it */
+                static Util::TAKErr enqueue(const std::shared_ptr<Queue> &queue, const Task &job) NOTHROWS;
+                void terminate(Queue &queue) NOTHROWS;
+                static void threadTryDecode(const Task &job);
 
                 static std::shared_ptr<Bitmap2> decodeUriFn(void *opaque);
             };
 
             struct AsyncBitmapLoader2::Queue : TAK::Engine::Util::NonCopyable
             {
-                AsyncBitmapLoader2 &owner;
                 Thread::Mutex jobMutex;
                 Thread::CondVar jobCond;
                 bool shouldTerminate;
                 std::deque<AsyncBitmapLoader2::Task> jobQueue;
 
-                Thread::ThreadPoolPtr threadPool;
+                /** borrowed from the engine-wide IO worker class */
+                Util::SharedWorkerPtr worker;
+                /** number of scheduled work items that have not completed */
+                std::size_t activeWork;
 
-                Queue(AsyncBitmapLoader2 &owner) NOTHROWS;
+                Queue() NOTHROWS;
                 ~Queue() NOTHROWS;
             };
         }
@@ -43,9 +43,9 @@ Bitmap atakmap::renderer::Bitmap_adapt(BitmapPtr_const &&other) NOTHROWS
     else if (compatible->getStride() != (compatible->getWidth()*pixelSize))
         compatible = BitmapPtr_const(new Bitmap2(*compatible), Memory_deleter_const<Bitmap2>);
 
-    // create a new data buffer
-    Bitmap2::DataPtr data(nullptr, nullptr);
-    Bitmap2_createBuffer(data, compatible->getWidth(), compatible->getHeight(), compatible->getFormat());
+    // create a new data buffer; ownership is transferred to the legacy
+    // bitmap which releases it with `delete[]`, so it is not pooled
+    Bitmap2::DataPtr data(new(std::nothrow) uint8_t[compatible->getWidth()*compatible->getHeight()*pixelSize], Memory_array_deleter_const<uint8_t>);
 
     // create the copy using a leaker
     Bitmap2 copy(std::move(Bitmap2::DataPtr(data.get(), Memory_leaker_const<uint8_t>)),
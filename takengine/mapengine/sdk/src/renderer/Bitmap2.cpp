@@ -1,7 +1,26 @@
 #include "renderer/Bitmap2.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TE_BITMAP2_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TE_BITMAP2_NEON
+#endif
+
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
 #include "util/IO.h"
 #include "util/Memory.h"
+#include "util/MemoryAccounting.h"
+#include "util/MemoryTrim.h"
 
 /*
 ARGB32, 4
@@ -17,12 +36,159 @@ BGR32 3
 
 using namespace TAK::Engine::Renderer;
 
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 #define NUM_FORMATS 9
 
 namespace
 {
+    /** buffers smaller than this are not worth pooling */
+    const std::size_t MinPooledBufferSize = 16u * 1024u;
+
+    /**
+     * Retains released pixel buffers for reuse, bucketed by exact size.
+     * Bitmaps of a given dimension and format always request the same size,
+     * so tiles and icons of a common size recycle the same buffers.
+     *
+     * Buffers are plain `new[]` allocations; the size of each outstanding
+     * buffer is tracked in a side table so that ownership of a buffer may be
+     * transferred to code that releases it with `delete[]`.
+     */
+    class BufferPool : public MemoryTrimmable
+    {
+    public :
+        BufferPool(const std::size_t maxSize_) NOTHROWS :
+            maxSize(maxSize_),
+            size(0u),
+            count(0u),
+            hits(0u),
+            misses(0u)
+        {
+            MemoryTrim_registerTrimmable(*this);
+        }
+    public :
+        /** returns a pooled or newly allocated block of the specified size, or NULL */
+        uint8_t *acquire(const std::size_t bufferSize) NOTHROWS
+        {
+            uint8_t *block = nullptr;
+            {
+                Lock lock(mutex);
+                if (maxSize && bufferSize >= MinPooledBufferSize) {
+                    auto bucket = buckets.find(bufferSize);
+                    if (bucket == buckets.end() || bucket->second.empty()) {
+                        misses++;
+                    } else {
+                        block = bucket->second.back();
+                        bucket->second.pop_back();
+                        size -= bufferSize;
+                        count--;
+                        hits++;
+                        MemoryAccounting_release(TEMC_BitmapPool, bufferSize);
+                    }
+                }
+            }
+            if (!block)
+                block = new(std::nothrow) uint8_t[bufferSize];
+            if (!block)
+                return nullptr;
+
+            Lock lock(mutex);
+            TAKErr code(TE_Ok);
+            TE_BEGIN_TRAP() {
+                live[block] = bufferSize;
+            } TE_END_TRAP(code);
+            if (code != TE_Ok) {
+                delete[] block;
+                return nullptr;
+            }
+            return block;
+        }
+        /** releases a block obtained from `acquire`, retaining it if there is capacity */
+        void release(const uint8_t *data) NOTHROWS
+        {
+            uint8_t *block = const_cast<uint8_t *>(data);
+            {
+                Lock lock(mutex);
+                auto entry = live.find(data);
+                if (entry == live.end()) {
+                    // not tracked; only possible if allocation accounting failed
+                    delete[] block;
+                    return;
+                }
+                const std::size_t bufferSize = entry->second;
+                live.erase(entry);
+                MemoryAccounting_release(TEMC_Bitmap, bufferSize);
+                if (maxSize && bufferSize >= MinPooledBufferSize && size + bufferSize <= maxSize) {
+                    TAKErr code(TE_Ok);
+                    TE_BEGIN_TRAP() {
+                        buckets[bufferSize].push_back(block);
+                    } TE_END_TRAP(code);
+                    if (code == TE_Ok) {
+                        size += bufferSize;
+                        count++;
+                        MemoryAccounting_allocate(TEMC_BitmapPool, bufferSize);
+                        return;
+                    }
+                }
+            }
+            delete[] block;
+        }
+        void trimTo(const std::size_t budget) NOTHROWS
+        {
+            Lock lock(mutex);
+            auto bucket = buckets.begin();
+            while (size > budget && bucket != buckets.end()) {
+                if (bucket->second.empty()) {
+                    bucket = buckets.erase(bucket);
+                    continue;
+                }
+                delete[] bucket->second.back();
+                bucket->second.pop_back();
+                size -= bucket->first;
+                count--;
+                MemoryAccounting_release(TEMC_BitmapPool, bucket->first);
+            }
+        }
+        void getStats(Bitmap2BufferPoolStats &value) NOTHROWS
+        {
+            Lock lock(mutex);
+            value.hits = hits;
+            value.misses = misses;
+            value.size = size;
+            value.count = count;
+            value.maxSize = maxSize;
+        }
+    public : // MemoryTrimmable
+        void trim(const MemoryTrimLevel level) NOTHROWS override
+        {
+            trimTo(MemoryTrimLevel_getBudget(level, maxSize));
+        }
+    private :
+        const std::size_t maxSize;
+        std::size_t size;
+        std::size_t count;
+        uint64_t hits;
+        uint64_t misses;
+        std::map<std::size_t, std::vector<uint8_t *>> buckets;
+        /** outstanding blocks to their size */
+        std::unordered_map<const uint8_t *, std::size_t> live;
+        Mutex mutex;
+    };
+
+    BufferPool &bufferPool() NOTHROWS
+    {
+        // intentionally leaked; bitmaps may be released after static
+        // destruction
+        static BufferPool *pool = new BufferPool((std::size_t)std::max(ConfigOptions_getIntOptionOrDefault("bitmap2.buffer-pool-size", 16 * 1024 * 1024), 0));
+        return *pool;
+    }
+
+    void accountedBufferDeleter(const uint8_t *data)
+    {
+        bufferPool().release(data);
+    }
+
     // format conversion functions
     typedef void(*FormatConverter)(uint8_t *, const std::size_t, const uint8_t *, const std::size_t, const std::size_t, const std::size_t);
 
@@ -55,6 +221,16 @@ namespace
 
     void resize(uint8_t *dst, const std::size_t dstW, const std::size_t dstH, const std::size_t dstStride, const uint8_t *src, const std::size_t srcW, const std::size_t srcH, const std::size_t srcStride, const std::size_t pixelBytes) NOTHROWS;
 
+    /** returns the converter for the format pair, preferring a vectorized kernel */
+    FormatConverter converter(const Bitmap2::Format srcFmt, const Bitmap2::Format dstFmt) NOTHROWS;
+    /** converts and premultiplies; returns NULL if the pair has no single pass kernel */
+    FormatConverter premultiplyingConverter(const Bitmap2::Format srcFmt, const Bitmap2::Format dstFmt) NOTHROWS;
+    /** premultiplies in place; returns NULL if the format has no alpha component */
+    FormatConverter premultiplier(const Bitmap2::Format fmt) NOTHROWS;
+    void convert(uint8_t *dst, const Bitmap2::Format dstFmt, const std::size_t dstStride, const uint8_t *src, const Bitmap2::Format srcFmt, const std::size_t srcStride, const std::size_t w, const std::size_t h, const bool premultiply) NOTHROWS;
+    /** 2x2 box filters two RGBA32 rows into a row of dstW pixels */
+    void downsampleRow(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, const std::size_t srcW, const std::size_t dstW) NOTHROWS;
+
     std::size_t formatSize[NUM_FORMATS] =
     { 4,  // ARGB32
       4,  // RGBA32
@@ -128,7 +304,7 @@ Bitmap2::Bitmap2(const Bitmap2 &other) NOTHROWS :
 {
     Bitmap2_createBuffer(dataPtr, width, height, format);
 
-    conversionFunctions[other.format*NUM_FORMATS + this->format](this->dataPtr.get(), this->stride, other.dataPtr.get(), other.stride, this->width, this->height);
+    converter(other.format, this->format)(this->dataPtr.get(), this->stride, other.dataPtr.get(), other.stride, this->width, this->height);
 }
 
 Bitmap2::Bitmap2(const Bitmap2 &other, const std::size_t width_, const std::size_t height_) NOTHROWS :
@@ -165,7 +341,7 @@ Bitmap2::Bitmap2(const Bitmap2 &other, const std::size_t width_, const std::size
     Bitmap2 otherResized(other, this->width, this->height);
 
     // format conversion
-    conversionFunctions[otherResized.format*NUM_FORMATS + this->format](this->dataPtr.get(), this->stride, otherResized.dataPtr.get(), otherResized.stride, this->width, this->height);
+    converter(otherResized.format, this->format)(this->dataPtr.get(), this->stride, otherResized.dataPtr.get(), otherResized.stride, this->width, this->height);
 }
 
 Bitmap2::Bitmap2(const Bitmap2 &other, const Format format_) NOTHROWS :
@@ -177,7 +353,7 @@ Bitmap2::Bitmap2(const Bitmap2 &other, const Format format_) NOTHROWS :
 {
     Bitmap2_createBuffer(dataPtr, width, height, format);
 
-    conversionFunctions[other.format*NUM_FORMATS + this->format](this->dataPtr.get(), this->stride, other.dataPtr.get(), other.stride, this->width, this->height);
+    converter(other.format, this->format)(this->dataPtr.get(), this->stride, other.dataPtr.get(), other.stride, this->width, this->height);
 }
 
 TAKErr Bitmap2::subimage(BitmapPtr &value, const std::size_t x, const std::size_t y, const std::size_t w, const std::size_t h, const bool share) NOTHROWS
@@ -235,7 +411,7 @@ TAKErr Bitmap2::setRegion(const Bitmap2 &other, const std::size_t dstX, const st
         // use format conversion as copy
         const std::size_t dstOff = (dstY*this->stride) + (dstX*formatSize[this->format]);
         const std::size_t srcOff = (srcY*other.stride) + (srcX*formatSize[other.format]);
-        conversionFunctions[other.format*NUM_FORMATS + this->format](this->dataPtr.get() + dstOff, this->stride, other.dataPtr.get() + srcOff, other.stride, w, h);
+        converter(other.format, this->format)(this->dataPtr.get() + dstOff, this->stride, other.dataPtr.get() + srcOff, other.stride, w, h);
     }
 
     return TE_Ok;
@@ -273,7 +449,7 @@ Bitmap2 &Bitmap2::operator=(const Bitmap2 &other)
     this->format = other.format;
     this->stride = this->width*formatSize[this->format];
     Bitmap2_createBuffer(this->dataPtr, this->width, this->height, this->format);
-    conversionFunctions[(other.format*NUM_FORMATS) + this->format](this->dataPtr.get(), this->stride, other.dataPtr.get(), other.stride, this->width, this->height);
+    converter(other.format, this->format)(this->dataPtr.get(), this->stride, other.dataPtr.get(), other.stride, this->width, this->height);
 
     return *this;
 }
@@ -286,11 +462,29 @@ TAKErr TAK::Engine::Renderer::Bitmap2_createBuffer(Bitmap2::DataPtr &value, std:
     } else if (width == 0 || height == 0) {
         return TE_InvalidArg;
     } else {
-        value = Bitmap2::DataPtr(new uint8_t[width*height*formatSize[format]], Memory_array_deleter_const<uint8_t>);
+        const std::size_t size = width*height*formatSize[format];
+        uint8_t *block = bufferPool().acquire(size);
+        if (!block)
+            return TE_OutOfMemory;
+        MemoryAccounting_allocate(TEMC_Bitmap, size);
+        value = Bitmap2::DataPtr(block, accountedBufferDeleter);
         return TE_Ok;
     }
 }
 
+TAKErr TAK::Engine::Renderer::Bitmap2_getBufferPoolStats(Bitmap2BufferPoolStats *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    bufferPool().getStats(*value);
+    return TE_Ok;
+}
+
+void TAK::Engine::Renderer::Bitmap2_trimBufferPool(const std::size_t budget) NOTHROWS
+{
+    bufferPool().trimTo(budget);
+}
+
 TAKErr TAK::Engine::Renderer::Bitmap2_formatPixelSize(std::size_t *value, const Bitmap2::Format format) NOTHROWS
 {
     if ((int)format < 0 || (int)format >= NUM_FORMATS)
@@ -299,6 +493,61 @@ TAKErr TAK::Engine::Renderer::Bitmap2_formatPixelSize(std::size_t *value, const
     return TE_Ok;
 }
 
+TAKErr TAK::Engine::Renderer::Bitmap2_premultiply(Bitmap2 &bitmap) NOTHROWS
+{
+    FormatConverter fn = premultiplier(bitmap.getFormat());
+    if (!fn || !bitmap.getData())
+        return TE_Ok;
+    fn(bitmap.getData(), bitmap.getStride(), bitmap.getData(), bitmap.getStride(), bitmap.getWidth(), bitmap.getHeight());
+    return TE_Ok;
+}
+
+TAKErr TAK::Engine::Renderer::Bitmap2_premultiply(BitmapPtr &value, const Bitmap2 &bitmap, const Bitmap2::Format format) NOTHROWS
+{
+    if ((int)format < 0 || (int)format >= NUM_FORMATS)
+        return TE_InvalidArg;
+
+    BitmapPtr result(new Bitmap2(bitmap.getWidth(), bitmap.getHeight(), format), Memory_deleter_const<Bitmap2>);
+    if (bitmap.getData())
+        convert(result->getData(), format, result->getStride(), bitmap.getData(), bitmap.getFormat(), bitmap.getStride(), bitmap.getWidth(), bitmap.getHeight(), true);
+    value = std::move(result);
+    return TE_Ok;
+}
+
+TAKErr TAK::Engine::Renderer::Bitmap2_downsample(BitmapPtr &value, const Bitmap2 &bitmap, const Bitmap2::Format format, const bool premultiply) NOTHROWS
+{
+    if ((int)format < 0 || (int)format >= NUM_FORMATS)
+        return TE_InvalidArg;
+    if (!bitmap.getData())
+        return TE_InvalidArg;
+
+    const std::size_t srcW = bitmap.getWidth();
+    const std::size_t srcH = bitmap.getHeight();
+    const std::size_t dstW = std::max(srcW / 2u, (std::size_t)1u);
+    const std::size_t dstH = std::max(srcH / 2u, (std::size_t)1u);
+
+    // source row pair and filtered row, as RGBA32
+    std::unique_ptr<uint8_t[]> rows(new(std::nothrow) uint8_t[((srcW * 2u) + dstW) * 4u]);
+    if (!rows)
+        return TE_OutOfMemory;
+    uint8_t *row0 = rows.get();
+    uint8_t *row1 = row0 + (srcW * 4u);
+    uint8_t *filtered = row1 + (srcW * 4u);
+
+    BitmapPtr result(new Bitmap2(dstW, dstH, format), Memory_deleter_const<Bitmap2>);
+    for (std::size_t y = 0u; y < dstH; y++) {
+        const std::size_t y0 = std::min(y * 2u, srcH - 1u);
+        const std::size_t y1 = std::min((y * 2u) + 1u, srcH - 1u);
+        convert(row0, Bitmap2::RGBA32, srcW * 4u, bitmap.getData() + (y0 * bitmap.getStride()), bitmap.getFormat(), bitmap.getStride(), srcW, 1u, premultiply);
+        convert(row1, Bitmap2::RGBA32, srcW * 4u, bitmap.getData() + (y1 * bitmap.getStride()), bitmap.getFormat(), bitmap.getStride(), srcW, 1u, premultiply);
+        downsampleRow(filtered, row0, row1, srcW, dstW);
+        converter(Bitmap2::RGBA32, format)(result->getData() + (y * result->getStride()), result->getStride(), filtered, dstW * 4u, dstW, 1u);
+    }
+
+    value = std::move(result);
+    return TE_Ok;
+}
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4101)
@@ -474,6 +723,334 @@ CONVERSION_FN_DEFNS(BGR24,
             }
         }
     }
+
+    // vectorized kernels. Each kernel processes as many pixels as possible in
+    // vector registers and finishes the row with the scalar equivalent, so
+    // results are identical regardless of the instruction set.
+
+    /** returns round(c*a/255) */
+    inline uint8_t mul255(const unsigned c, const unsigned a) NOTHROWS
+    {
+        const unsigned t = (c * a) + 128u;
+        return (uint8_t)((t + (t >> 8u)) >> 8u);
+    }
+
+    inline uint8_t toMono(const unsigned r, const unsigned g, const unsigned b) NOTHROWS
+    {
+        return (uint8_t)((((r * 66u + g * 129u + b * 25u) + 128u) >> 8u) + 16u);
+    }
+
+#if defined(TE_BITMAP2_NEON)
+    inline uint8x16_t mul255(const uint8x16_t c, const uint8x16_t a) NOTHROWS
+    {
+        const uint16x8_t lo = vmull_u8(vget_low_u8(c), vget_low_u8(a));
+        const uint16x8_t hi = vmull_u8(vget_high_u8(c), vget_high_u8(a));
+        return vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)), vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+    }
+#endif
+
+    /**
+     * Reorders the components of 32-bit pixels such that dst[i] = src[Pi].
+     * If A is non-negative, the color components are multiplied by the
+     * alpha component at destination index A.
+     */
+    template<int P0, int P1, int P2, int P3, int A>
+    void swizzle4(uint8_t *dst, const uint8_t *src, const std::size_t n) NOTHROWS
+    {
+        enum { AI = (A < 0) ? 0 : A };
+        std::size_t i = 0u;
+#if defined(TE_BITMAP2_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bias = _mm_set1_epi16(128);
+        const __m128i opaque = _mm_set1_epi16(255);
+        int16_t alphaLanes[8u] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        alphaLanes[AI] = -1;
+        alphaLanes[AI + 4] = -1;
+        const __m128i alphaMask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(alphaLanes));
+        for (; (i + 4u) <= n; i += 4u) {
+            const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + (i * 4u)));
+            // widen to 16-bit lanes; each 64-bit half holds one pixel
+            __m128i v[2] = { _mm_unpacklo_epi8(px, zero), _mm_unpackhi_epi8(px, zero) };
+            for (std::size_t j = 0u; j < 2u; j++) {
+                v[j] = _mm_shufflelo_epi16(v[j], _MM_SHUFFLE(P3, P2, P1, P0));
+                v[j] = _mm_shufflehi_epi16(v[j], _MM_SHUFFLE(P3, P2, P1, P0));
+                if (A >= 0) {
+                    __m128i alpha = _mm_shufflelo_epi16(v[j], _MM_SHUFFLE(AI, AI, AI, AI));
+                    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(AI, AI, AI, AI));
+                    // alpha is scaled by 255 to preserve it
+                    alpha = _mm_or_si128(_mm_andnot_si128(alphaMask, alpha), _mm_and_si128(alphaMask, opaque));
+                    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(v[j], alpha), bias);
+                    v[j] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+                }
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (i * 4u)), _mm_packus_epi16(v[0], v[1]));
+        }
+#elif defined(TE_BITMAP2_NEON)
+        for (; (i + 16u) <= n; i += 16u) {
+            const uint8x16x4_t s = vld4q_u8(src + (i * 4u));
+            uint8x16x4_t d;
+            d.val[0] = s.val[P0];
+            d.val[1] = s.val[P1];
+            d.val[2] = s.val[P2];
+            d.val[3] = s.val[P3];
+            if (A >= 0) {
+                const uint8x16_t alpha = d.val[AI];
+                for (int c = 0; c < 4; c++)
+                    if (c != A)
+                        d.val[c] = mul255(d.val[c], alpha);
+            }
+            vst4q_u8(dst + (i * 4u), d);
+        }
+#endif
+        for (; i < n; i++) {
+            const uint8_t *s = src + (i * 4u);
+            uint8_t px[4u] = { s[P0], s[P1], s[P2], s[P3] };
+            if (A >= 0) {
+                for (int c = 0; c < 4; c++)
+                    if (c != A)
+                        px[c] = mul255(px[c], px[AI]);
+            }
+            memcpy(dst + (i * 4u), px, 4u);
+        }
+    }
+
+    /**
+     * Converts 32-bit pixels with the color components at the specified
+     * indices to MONOCHROME or, if A is non-negative, MONOCHROME_ALPHA.
+     */
+    template<int R, int G, int B, int A>
+    void mono4(uint8_t *dst, const uint8_t *src, const std::size_t n) NOTHROWS
+    {
+        enum { AI = (A < 0) ? 0 : A };
+        const std::size_t dstStep = (A < 0) ? 1u : 2u;
+        std::size_t i = 0u;
+#if defined(TE_BITMAP2_SSE2)
+        const __m128i mask = _mm_set1_epi32(0xFF);
+        const __m128i wr = _mm_set1_epi32(66);
+        const __m128i wg = _mm_set1_epi32(129);
+        const __m128i wb = _mm_set1_epi32(25);
+        const __m128i bias = _mm_set1_epi32(128);
+        const __m128i offset = _mm_set1_epi32(16);
+        for (; (i + 16u) <= n; i += 16u) {
+            __m128i m[4u];
+            for (std::size_t j = 0u; j < 4u; j++) {
+                // one pixel per 32-bit lane; weighted sums fit in 16 bits
+                const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + ((i + (j * 4u)) * 4u)));
+                __m128i y = _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(px, R * 8), mask), wr);
+                y = _mm_add_epi32(y, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(px, G * 8), mask), wg));
+                y = _mm_add_epi32(y, _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(px, B * 8), mask), wb));
+                y = _mm_add_epi32(_mm_srli_epi32(_mm_add_epi32(y, bias), 8), offset);
+                if (A >= 0) {
+                    y = _mm_or_si128(y, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(px, AI * 8), mask), 8));
+                    // sign extend so that the saturating pack preserves the bits
+                    y = _mm_srai_epi32(_mm_slli_epi32(y, 16), 16);
+                }
+                m[j] = y;
+            }
+            const __m128i lo = _mm_packs_epi32(m[0], m[1]);
+            const __m128i hi = _mm_packs_epi32(m[2], m[3]);
+            if (A >= 0) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (i * 2u)), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (i * 2u) + 16u), hi);
+            } else {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+            }
+        }
+#elif defined(TE_BITMAP2_NEON)
+        const uint8x8_t wr = vdup_n_u8(66);
+        const uint8x8_t wg = vdup_n_u8(129);
+        const uint8x8_t wb = vdup_n_u8(25);
+        const uint8x8_t offset = vdup_n_u8(16);
+        for (; (i + 16u) <= n; i += 16u) {
+            const uint8x16x4_t s = vld4q_u8(src + (i * 4u));
+            uint16x8_t lo = vmull_u8(vget_low_u8(s.val[R]), wr);
+            lo = vmlal_u8(lo, vget_low_u8(s.val[G]), wg);
+            lo = vmlal_u8(lo, vget_low_u8(s.val[B]), wb);
+            uint16x8_t hi = vmull_u8(vget_high_u8(s.val[R]), wr);
+            hi = vmlal_u8(hi, vget_high_u8(s.val[G]), wg);
+            hi = vmlal_u8(hi, vget_high_u8(s.val[B]), wb);
+            const uint8x16_t y = vcombine_u8(vadd_u8(vrshrn_n_u16(lo, 8), offset), vadd_u8(vrshrn_n_u16(hi, 8), offset));
+            if (A >= 0) {
+                uint8x16x2_t d;
+                d.val[0] = y;
+                d.val[1] = s.val[AI];
+                vst2q_u8(dst + (i * 2u), d);
+            } else {
+                vst1q_u8(dst + i, y);
+            }
+        }
+#endif
+        for (; i < n; i++) {
+            const uint8_t *s = src + (i * 4u);
+            uint8_t *d = dst + (i * dstStep);
+            d[0] = toMono(s[R], s[G], s[B]);
+            if (A >= 0)
+                d[1] = s[AI];
+        }
+    }
+
+    template<int P0, int P1, int P2, int P3, int A>
+    void swizzle4Rows(uint8_t *dst, const std::size_t dstStride, const uint8_t *src, const std::size_t srcStride, const std::size_t w, const std::size_t h)
+    {
+        for (std::size_t y = 0u; y < h; y++)
+            swizzle4<P0, P1, P2, P3, A>(dst + (y * dstStride), src + (y * srcStride), w);
+    }
+
+    template<int R, int G, int B, int A>
+    void mono4Rows(uint8_t *dst, const std::size_t dstStride, const uint8_t *src, const std::size_t srcStride, const std::size_t w, const std::size_t h)
+    {
+        for (std::size_t y = 0u; y < h; y++)
+            mono4<R, G, B, A>(dst + (y * dstStride), src + (y * srcStride), w);
+    }
+
+    void premultiplyMONOCHROME_ALPHA(uint8_t *dst, const std::size_t dstStride, const uint8_t *src, const std::size_t srcStride, const std::size_t w, const std::size_t h)
+    {
+        for (std::size_t y = 0u; y < h; y++) {
+            const uint8_t *s = src + (y * srcStride);
+            uint8_t *d = dst + (y * dstStride);
+            for (std::size_t x = 0u; x < w; x++) {
+                d[0] = mul255(s[0], s[1]);
+                d[1] = s[1];
+                s += 2u;
+                d += 2u;
+            }
+        }
+    }
+
+    void premultiplyRGBA5551(uint8_t *dst, const std::size_t dstStride, const uint8_t *src, const std::size_t srcStride, const std::size_t w, const std::size_t h)
+    {
+        // one bit alpha; transparent pixels are cleared
+        const uint8_t endianXor = (atakmap::util::PlatformEndian == atakmap::util::LITTLE_ENDIAN) ? 0x01u : 0x00u;
+        for (std::size_t y = 0u; y < h; y++) {
+            const uint8_t *s = src + (y * srcStride);
+            uint8_t *d = dst + (y * dstStride);
+            for (std::size_t x = 0u; x < w; x++) {
+                const bool opaque = !!(s[1u ^ endianXor] & 0x1u);
+                d[0] = opaque ? s[0] : 0x00u;
+                d[1] = opaque ? s[1] : 0x00u;
+                s += 2u;
+                d += 2u;
+            }
+        }
+    }
+
+#define FORMAT_PAIR(srcFmt, dstFmt) ((Bitmap2::srcFmt*NUM_FORMATS) + Bitmap2::dstFmt)
+
+    FormatConverter converter(const Bitmap2::Format srcFmt, const Bitmap2::Format dstFmt) NOTHROWS
+    {
+#if defined(TE_BITMAP2_SSE2) || defined(TE_BITMAP2_NEON)
+        // the 32-bit and monochrome conversions cover the texture loading
+        // paths; packed 16-bit and 24-bit formats use the scalar converters
+        switch ((srcFmt*NUM_FORMATS) + dstFmt) {
+            case FORMAT_PAIR(ARGB32, RGBA32) : return swizzle4Rows<1, 2, 3, 0, -1>;
+            case FORMAT_PAIR(ARGB32, BGRA32) : return swizzle4Rows<3, 2, 1, 0, -1>;
+            case FORMAT_PAIR(RGBA32, ARGB32) : return swizzle4Rows<3, 0, 1, 2, -1>;
+            case FORMAT_PAIR(RGBA32, BGRA32) : return swizzle4Rows<2, 1, 0, 3, -1>;
+            case FORMAT_PAIR(BGRA32, ARGB32) : return swizzle4Rows<3, 2, 1, 0, -1>;
+            case FORMAT_PAIR(BGRA32, RGBA32) : return swizzle4Rows<2, 1, 0, 3, -1>;
+            case FORMAT_PAIR(ARGB32, MONOCHROME) : return mono4Rows<1, 2, 3, -1>;
+            case FORMAT_PAIR(RGBA32, MONOCHROME) : return mono4Rows<0, 1, 2, -1>;
+            case FORMAT_PAIR(BGRA32, MONOCHROME) : return mono4Rows<2, 1, 0, -1>;
+            case FORMAT_PAIR(ARGB32, MONOCHROME_ALPHA) : return mono4Rows<1, 2, 3, 0>;
+            case FORMAT_PAIR(RGBA32, MONOCHROME_ALPHA) : return mono4Rows<0, 1, 2, 3>;
+            case FORMAT_PAIR(BGRA32, MONOCHROME_ALPHA) : return mono4Rows<2, 1, 0, 3>;
+            default :
+                break;
+        }
+#endif
+        return conversionFunctions[(srcFmt*NUM_FORMATS) + dstFmt];
+    }
+
+    FormatConverter premultiplyingConverter(const Bitmap2::Format srcFmt, const Bitmap2::Format dstFmt) NOTHROWS
+    {
+        switch ((srcFmt*NUM_FORMATS) + dstFmt) {
+            case FORMAT_PAIR(ARGB32, ARGB32) : return swizzle4Rows<0, 1, 2, 3, 0>;
+            case FORMAT_PAIR(ARGB32, RGBA32) : return swizzle4Rows<1, 2, 3, 0, 3>;
+            case FORMAT_PAIR(ARGB32, BGRA32) : return swizzle4Rows<3, 2, 1, 0, 3>;
+            case FORMAT_PAIR(RGBA32, ARGB32) : return swizzle4Rows<3, 0, 1, 2, 0>;
+            case FORMAT_PAIR(RGBA32, RGBA32) : return swizzle4Rows<0, 1, 2, 3, 3>;
+            case FORMAT_PAIR(RGBA32, BGRA32) : return swizzle4Rows<2, 1, 0, 3, 3>;
+            case FORMAT_PAIR(BGRA32, ARGB32) : return swizzle4Rows<3, 2, 1, 0, 0>;
+            case FORMAT_PAIR(BGRA32, RGBA32) : return swizzle4Rows<2, 1, 0, 3, 3>;
+            case FORMAT_PAIR(BGRA32, BGRA32) : return swizzle4Rows<0, 1, 2, 3, 3>;
+            default :
+                return nullptr;
+        }
+    }
+
+#undef FORMAT_PAIR
+
+    FormatConverter premultiplier(const Bitmap2::Format fmt) NOTHROWS
+    {
+        switch (fmt) {
+            case Bitmap2::ARGB32 :
+            case Bitmap2::RGBA32 :
+            case Bitmap2::BGRA32 :
+                return premultiplyingConverter(fmt, fmt);
+            case Bitmap2::MONOCHROME_ALPHA :
+                return premultiplyMONOCHROME_ALPHA;
+            case Bitmap2::RGBA5551 :
+                return premultiplyRGBA5551;
+            default :
+                return nullptr;
+        }
+    }
+
+    void convert(uint8_t *dst, const Bitmap2::Format dstFmt, const std::size_t dstStride, const uint8_t *src, const Bitmap2::Format srcFmt, const std::size_t srcStride, const std::size_t w, const std::size_t h, const bool premultiply) NOTHROWS
+    {
+        if (premultiply) {
+            FormatConverter fused = premultiplyingConverter(srcFmt, dstFmt);
+            if (fused) {
+                fused(dst, dstStride, src, srcStride, w, h);
+                return;
+            }
+        }
+        converter(srcFmt, dstFmt)(dst, dstStride, src, srcStride, w, h);
+        FormatConverter fn = premultiply ? premultiplier(dstFmt) : nullptr;
+        if (fn)
+            fn(dst, dstStride, dst, dstStride, w, h);
+    }
+
+    void downsampleRow(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, const std::size_t srcW, const std::size_t dstW) NOTHROWS
+    {
+        std::size_t x = 0u;
+        if (srcW > 1u) {
+#if defined(TE_BITMAP2_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi16(2);
+            for (; (x + 4u) <= dstW; x += 4u) {
+                __m128i out[2u];
+                for (std::size_t j = 0u; j < 2u; j++) {
+                    const std::size_t off = ((x * 2u) + (j * 4u)) * 4u;
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + off));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + off));
+                    // vertical sums, one pixel per 64-bit half
+                    const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                    const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                    // horizontal sums in the low halves
+                    const __m128i sum = _mm_unpacklo_epi64(_mm_add_epi16(lo, _mm_srli_si128(lo, 8)), _mm_add_epi16(hi, _mm_srli_si128(hi, 8)));
+                    out[j] = _mm_srli_epi16(_mm_add_epi16(sum, bias), 2);
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (x * 4u)), _mm_packus_epi16(out[0], out[1]));
+            }
+#elif defined(TE_BITMAP2_NEON)
+            for (; (x + 8u) <= dstW; x += 8u) {
+                const uint8x16x4_t a = vld4q_u8(row0 + (x * 8u));
+                const uint8x16x4_t b = vld4q_u8(row1 + (x * 8u));
+                uint8x8x4_t d;
+                for (int c = 0; c < 4; c++)
+                    d.val[c] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(a.val[c]), b.val[c]), 2);
+                vst4_u8(dst + (x * 4u), d);
+            }
+#endif
+        }
+        for (; x < dstW; x++) {
+            const std::size_t x0 = std::min(x * 2u, srcW - 1u) * 4u;
+            const std::size_t x1 = std::min((x * 2u) + 1u, srcW - 1u) * 4u;
+            for (std::size_t c = 0u; c < 4u; c++)
+                dst[(x * 4u) + c] = (uint8_t)(((unsigned)row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2u) >> 2u);
+        }
+    }
 }
 
 #ifdef _MSC_VER
@@ -1,6 +1,8 @@
 #ifndef TAK_ENGINE_RENDERER_BITMAP2_H_INCLUDED
 #define TAK_ENGINE_RENDERER_BITMAP2_H_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 #include "port/Platform.h"
@@ -65,8 +67,61 @@ namespace TAK {
             typedef std::unique_ptr<Bitmap2, void(*)(const Bitmap2 *)> BitmapPtr;
             typedef std::unique_ptr<const Bitmap2, void(*)(const Bitmap2 *)> BitmapPtr_const;
 
+            /**
+             * Statistics for the pool of pixel buffers shared by all
+             * `Bitmap2` allocations.
+             */
+            struct ENGINE_API Bitmap2BufferPoolStats
+            {
+                /** allocations satisfied by a pooled buffer */
+                uint64_t hits;
+                /** allocations eligible for pooling that were not */
+                uint64_t misses;
+                /** bytes currently retained by the pool */
+                std::size_t size;
+                /** buffers currently retained by the pool */
+                std::size_t count;
+                /** the maximum bytes retained by the pool */
+                std::size_t maxSize;
+            };
+
+            /**
+             * Allocates a pixel buffer for a bitmap of the specified
+             * dimensions and format. Buffers of at least 16KB are recycled
+             * through a process-wide pool, bucketed by size; the pool budget
+             * is specified by the "bitmap2.buffer-pool-size" config option
+             * (bytes, default 16MB; zero disables pooling).
+             */
             ENGINE_API Util::TAKErr Bitmap2_createBuffer(Bitmap2::DataPtr &value, std::size_t width, std::size_t height, Bitmap2::Format format);
+            ENGINE_API Util::TAKErr Bitmap2_getBufferPoolStats(Bitmap2BufferPoolStats *value) NOTHROWS;
+            /**
+             * Releases pooled buffers until the pool retains no more than
+             * the specified number of bytes.
+             */
+            ENGINE_API void Bitmap2_trimBufferPool(const std::size_t budget) NOTHROWS;
             ENGINE_API Util::TAKErr Bitmap2_formatPixelSize(std::size_t *value, const Bitmap2::Format format) NOTHROWS;
+            /**
+             * Multiplies the color components of the bitmap by its alpha
+             * component, in place. Bitmaps without an alpha component are not
+             * modified.
+             */
+            ENGINE_API Util::TAKErr Bitmap2_premultiply(Bitmap2 &bitmap) NOTHROWS;
+            /**
+             * Converts the bitmap to the specified format, multiplying the
+             * color components by the alpha component. For 32-bit source and
+             * destination formats, conversion and premultiplication are
+             * performed in a single pass.
+             */
+            ENGINE_API Util::TAKErr Bitmap2_premultiply(BitmapPtr &value, const Bitmap2 &bitmap, const Bitmap2::Format format) NOTHROWS;
+            /**
+             * Creates a half resolution copy of the bitmap in the specified
+             * format, averaging each 2x2 block of source pixels. A trailing
+             * odd row or column is dropped; a dimension of one is preserved.
+             *
+             * @param premultiply   If <code>true</code>, the color components
+             *                      are multiplied by alpha before averaging
+             */
+            ENGINE_API Util::TAKErr Bitmap2_downsample(BitmapPtr &value, const Bitmap2 &bitmap, const Bitmap2::Format format, const bool premultiply) NOTHROWS;
         }
     }
 }
@@ -0,0 +1,139 @@
+#include "renderer/BitmapCache.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    std::size_t sizeOf(const Bitmap2 &bitmap) NOTHROWS
+    {
+        return bitmap.getStride() * bitmap.getHeight();
+    }
+}
+
+BitmapCache::BitmapCache(const std::size_t maxSize_) NOTHROWS :
+    maxSize(maxSize_),
+    size(0u)
+{}
+
+BitmapCache::~BitmapCache() NOTHROWS
+{}
+
+TAKErr BitmapCache::acquire(std::shared_ptr<Bitmap2> &value, const char *uri) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!uri)
+        return TE_InvalidArg;
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    const std::string key(uri);
+    while (true) {
+        auto entry = entries.find(key);
+        if (entry == entries.end()) {
+            // caller is responsible for the decode
+            Entry pending;
+            pending.size = 0u;
+            pending.pending = true;
+            pending.order = order.end();
+            entries.insert(EntryMap::value_type(key, pending));
+            return TE_Done;
+        }
+        if (entry->second.pending) {
+            code = lock.wait();
+            TE_CHECKRETURN_CODE(code);
+            continue;
+        }
+        // mark most recently used
+        order.splice(order.end(), order, entry->second.order);
+        value = entry->second.bitmap;
+        return TE_Ok;
+    }
+}
+
+TAKErr BitmapCache::get(std::shared_ptr<Bitmap2> &value, const char *uri) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!uri)
+        return TE_InvalidArg;
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    auto entry = entries.find(std::string(uri));
+    if (entry == entries.end() || entry->second.pending)
+        return TE_Done;
+    order.splice(order.end(), order, entry->second.order);
+    value = entry->second.bitmap;
+    return TE_Ok;
+}
+
+void BitmapCache::put(const char *uri, const std::shared_ptr<Bitmap2> &bitmap) NOTHROWS
+{
+    if (!uri)
+        return;
+    Monitor::Lock lock(monitor);
+    auto entry = entries.find(std::string(uri));
+    if (entry == entries.end() || !entry->second.pending)
+        return;
+
+    const std::size_t bitmapSize = bitmap ? sizeOf(*bitmap) : 0u;
+    if (!bitmap || bitmapSize > maxSize) {
+        entries.erase(entry);
+    } else {
+        entry->second.bitmap = bitmap;
+        entry->second.size = bitmapSize;
+        entry->second.pending = false;
+        entry->second.order = order.insert(order.end(), entry->first);
+        size += bitmapSize;
+        trimLocked();
+    }
+    lock.broadcast();
+}
+
+void BitmapCache::abandon(const char *uri) NOTHROWS
+{
+    if (!uri)
+        return;
+    Monitor::Lock lock(monitor);
+    auto entry = entries.find(std::string(uri));
+    if (entry == entries.end() || !entry->second.pending)
+        return;
+    entries.erase(entry);
+    lock.broadcast();
+}
+
+void BitmapCache::clear() NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    while (!order.empty())
+        eraseLocked(entries.find(order.front()));
+}
+
+std::size_t BitmapCache::getSize() const NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    return size;
+}
+
+std::size_t BitmapCache::getMaxSize() const NOTHROWS
+{
+    return maxSize;
+}
+
+void BitmapCache::trimLocked() NOTHROWS
+{
+    while (size > maxSize && !order.empty())
+        eraseLocked(entries.find(order.front()));
+}
+
+void BitmapCache::eraseLocked(EntryMap::iterator entry) NOTHROWS
+{
+    size -= entry->second.size;
+    if (entry->second.order != order.end())
+        order.erase(entry->second.order);
+    entries.erase(entry);
+}
@@ -0,0 +1,106 @@
+#ifndef TAK_ENGINE_RENDERER_BITMAPCACHE_H_INCLUDED
+#define TAK_ENGINE_RENDERER_BITMAPCACHE_H_INCLUDED
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "port/Platform.h"
+#include "renderer/Bitmap2.h"
+#include "thread/Monitor.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Cache of decoded bitmaps, keyed by URI, retaining the most
+             * recently used bitmaps up to a byte budget.
+             *
+             * <P>Only one decode is performed for concurrent requests of
+             * the same URI: the first requester is directed to decode the
+             * bitmap and publish it via `put`, or to `abandon` it on
+             * failure; subsequent requesters block until the bitmap is
+             * published or abandoned.
+             *
+             * <P>Cached bitmaps are shared between requesters and must not
+             * be modified.
+             *
+             * <P>This class is thread-safe.
+             */
+            class ENGINE_API BitmapCache
+            {
+            public :
+                /**
+                 * @param maxSize   The maximum bytes of decoded bitmaps
+                 *                  retained
+                 */
+                BitmapCache(const std::size_t maxSize) NOTHROWS;
+                ~BitmapCache() NOTHROWS;
+            private :
+                BitmapCache(const BitmapCache &) NOTHROWS;
+            public :
+                /**
+                 * Obtains the decoded bitmap for the specified URI.
+                 *
+                 * @return  TE_Ok if the bitmap was cached or decoded by a
+                 *          concurrent request; TE_Done if the caller must
+                 *          decode the bitmap and subsequently invoke `put`
+                 *          or `abandon` with the same URI
+                 */
+                Util::TAKErr acquire(std::shared_ptr<Bitmap2> &value, const char *uri) NOTHROWS;
+                /**
+                 * Obtains the decoded bitmap for the specified URI without
+                 * blocking.
+                 *
+                 * @return  TE_Ok if the bitmap is cached, TE_Done otherwise
+                 */
+                Util::TAKErr get(std::shared_ptr<Bitmap2> &value, const char *uri) NOTHROWS;
+                /**
+                 * Publishes the bitmap decoded following a call to
+                 * `acquire` that returned TE_Done. Bitmaps larger than the
+                 * budget are not retained.
+                 */
+                void put(const char *uri, const std::shared_ptr<Bitmap2> &bitmap) NOTHROWS;
+                /**
+                 * Signals that the bitmap could not be decoded following a
+                 * call to `acquire` that returned TE_Done. A blocked
+                 * requester will be directed to decode the bitmap.
+                 */
+                void abandon(const char *uri) NOTHROWS;
+                /**
+                 * Releases all retained bitmaps. In-progress decodes are
+                 * unaffected.
+                 */
+                void clear() NOTHROWS;
+                /** returns the bytes of decoded bitmaps retained */
+                std::size_t getSize() const NOTHROWS;
+                std::size_t getMaxSize() const NOTHROWS;
+            private :
+                struct Entry
+                {
+                    std::shared_ptr<Bitmap2> bitmap;
+                    std::size_t size;
+                    bool pending;
+                    std::list<std::string>::iterator order;
+                };
+                typedef std::map<std::string, Entry> EntryMap;
+            private :
+                /** evicts least recently used bitmaps in excess of the budget */
+                void trimLocked() NOTHROWS;
+                void eraseLocked(EntryMap::iterator entry) NOTHROWS;
+            private :
+                const std::size_t maxSize;
+                std::size_t size;
+                EntryMap entries;
+                /** retained URIs, least recently used first */
+                std::list<std::string> order;
+                mutable Thread::Monitor monitor;
+            };
+        }
+    }
+}
+
+#endif
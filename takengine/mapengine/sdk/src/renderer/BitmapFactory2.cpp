@@ -4,9 +4,11 @@
 #include <sstream>
 
 #include "formats/gdal/GdalBitmapReader.h"
+#include "util/AllocationTagging.h"
 #include "util/DataOutput2.h"
 #include "util/Memory.h"
 #include "util/Logging2.h"
+#include "util/Trace.h"
 
 #include "gdal_priv.h"
 
@@ -14,8 +16,26 @@ using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Formats::GDAL;
 
+namespace
+{
+    /** reduces the dimensions to fit within the target, preserving aspect ratio */
+    void fitWithin(int &width, int &height, const std::size_t targetWidth, const std::size_t targetHeight) NOTHROWS
+    {
+        double scale = 1.0;
+        if (targetWidth && targetWidth < (std::size_t)width)
+            scale = std::min(scale, (double)targetWidth / (double)width);
+        if (targetHeight && targetHeight < (std::size_t)height)
+            scale = std::min(scale, (double)targetHeight / (double)height);
+        if (scale < 1.0) {
+            width = std::max((int)((double)width * scale), 1);
+            height = std::max((int)((double)height * scale), 1);
+        }
+    }
+}
+
 TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, DataInput2 &input, const BitmapDecodeOptions *opts) NOTHROWS
 {
+    TE_ALLOCATION_TAG(TEAT_TileDecode);
     TAKErr code(TE_Ok);
     if (input.length() <= 0LL) {
         DynamicOutput membuf;
@@ -43,6 +63,7 @@ TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, DataInput
 }
 TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, const uint8_t *data, const std::size_t dataLen, const BitmapDecodeOptions *opts) NOTHROWS
 {
+    TE_ALLOCATION_TAG(TEAT_TileDecode);
     TAKErr code(TE_Ok);
 
     std::ostringstream os;
@@ -66,22 +87,44 @@ TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, const uin
 }
 TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, const char *bitmapFilePath, const BitmapDecodeOptions *opts) NOTHROWS
 {
+    TE_TRACE_SCOPE("bitmap", "BitmapFactory2::decode");
+    TE_ALLOCATION_TAG(TEAT_TileDecode);
     TAKErr code(TE_Ok);
     GdalBitmapReader reader(bitmapFilePath);
     // check if the dataset could be opened
     if (nullptr == reader.getDataset())
         return TE_InvalidArg;
 
-    const int srcWidth = reader.getWidth();
-    const int srcHeight = reader.getHeight();
+    int srcX = 0;
+    int srcY = 0;
+    int srcWidth = reader.getWidth();
+    int srcHeight = reader.getHeight();
+    if (opts && opts->regionWidth && opts->regionHeight) {
+        if (opts->regionX + opts->regionWidth > (std::size_t)srcWidth ||
+            opts->regionY + opts->regionHeight > (std::size_t)srcHeight) {
+
+            return TE_InvalidArg;
+        }
+        srcX = (int)opts->regionX;
+        srcY = (int)opts->regionY;
+        srcWidth = (int)opts->regionWidth;
+        srcHeight = (int)opts->regionHeight;
+    }
+
     int dstWidth = srcWidth;
     int dstHeight = srcHeight;
+    if (opts) {
+        // GDAL satisfies reduced resolution reads from overviews, including
+        // the DCT scaled overviews the JPEG driver exposes, so the full
+        // resolution image is not decoded
+        fitWithin(dstWidth, dstHeight, opts->targetWidth, opts->targetHeight);
+    }
 
 #if 1
     // XXX - force subsampling
     if (dstWidth > 2048 || dstHeight > 2048) {
-        double sampleX = 2048.0 / (double)srcWidth;
-        double sampleY = 2048.0 / (double)srcHeight;
+        double sampleX = 2048.0 / (double)dstWidth;
+        double sampleY = 2048.0 / (double)dstHeight;
         double sample = std::min(sampleX, sampleY);
         dstWidth = static_cast<int>((double)dstWidth * sample);
         dstHeight = static_cast<int>((double)dstHeight * sample);
@@ -124,7 +167,9 @@ TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, const cha
 
             // nothing to do
         } else{
-            Bitmap2::DataPtr data = Bitmap2::DataPtr(new(std::nothrow) uint8_t[byteCount], Util::Memory_array_deleter_const<uint8_t>);
+            Bitmap2::DataPtr data(nullptr, nullptr);
+            code = Bitmap2_createBuffer(data, dstWidth, dstHeight, bitmapFormat);
+            TE_CHECKRETURN_CODE(code);
             if (!data.get())
                 return TE_OutOfMemory;
             result = BitmapPtr(new(std::nothrow) Bitmap2(std::move(data), dstWidth, dstHeight, bitmapFormat), Memory_deleter_const<Bitmap2>);
@@ -132,7 +177,7 @@ TAKErr TAK::Engine::Renderer::BitmapFactory2_decode(BitmapPtr &result, const cha
                 return TE_OutOfMemory;
         }
 
-        code = reader.read(0, 0, srcWidth, srcHeight, dstWidth, dstHeight, result->getData(), byteCount);
+        code = reader.read(srcX, srcY, srcWidth, srcHeight, dstWidth, dstHeight, result->getData(), byteCount);
         TE_CHECKRETURN_CODE(code);
     }
 
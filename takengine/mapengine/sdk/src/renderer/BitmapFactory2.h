@@ -14,7 +14,13 @@ namespace TAK {
             struct ENGINE_API BitmapDecodeOptions
             {
                 inline BitmapDecodeOptions() NOTHROWS
-                    : emplaceData(false) { }
+                    : emplaceData(false),
+                      targetWidth(0u),
+                      targetHeight(0u),
+                      regionX(0u),
+                      regionY(0u),
+                      regionWidth(0u),
+                      regionHeight(0u) { }
 
                 /**
                  * An informal hint as to which image format the input data is. Format hints
@@ -28,6 +34,27 @@ namespace TAK {
                  * may return BitmapFactory::Unsupported if this is not supported.
                  */
                 bool emplaceData;
+
+                /**
+                 * If non-zero, the decoded bitmap is reduced to fit within
+                 * the specified dimensions, preserving aspect ratio. Images
+                 * are never enlarged. Decoders that support reduced
+                 * resolution decode (e.g. JPEG DCT scaling) will not decode
+                 * the full resolution image.
+                 */
+                std::size_t targetWidth;
+                std::size_t targetHeight;
+
+                /**
+                 * The region of the source image to decode, in source
+                 * pixels. If either `regionWidth` or `regionHeight` is
+                 * zero, the full image is decoded. Any target size is
+                 * applied to the region.
+                 */
+                std::size_t regionX;
+                std::size_t regionY;
+                std::size_t regionWidth;
+                std::size_t regionHeight;
             };
 
             ENGINE_API Util::TAKErr BitmapFactory2_decode(BitmapPtr &result, Util::DataInput2 &input, const BitmapDecodeOptions *opts) NOTHROWS;
@@ -0,0 +1,86 @@
+#include "renderer/DepthPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Util;
+
+DepthPyramid::DepthPyramid() NOTHROWS
+{}
+
+TAKErr DepthPyramid::build(const float *depth, const std::size_t width, const std::size_t height) NOTHROWS
+{
+    if (!depth || !width || !height)
+        return TE_InvalidArg;
+
+    levels_.clear();
+    levels_.resize(1u);
+    levels_[0u].width = width;
+    levels_[0u].height = height;
+    levels_[0u].depth.assign(depth, depth + (width*height));
+
+    while (levels_.back().width > 1u || levels_.back().height > 1u) {
+        Level level;
+        {
+            const Level &src = levels_.back();
+            level.width = (src.width + 1u) / 2u;
+            level.height = (src.height + 1u) / 2u;
+            level.depth.resize(level.width*level.height);
+            for (std::size_t y = 0u; y < level.height; y++) {
+                const std::size_t sy0 = y * 2u;
+                const std::size_t sy1 = std::min(sy0 + 1u, src.height - 1u);
+                for (std::size_t x = 0u; x < level.width; x++) {
+                    const std::size_t sx0 = x * 2u;
+                    const std::size_t sx1 = std::min(sx0 + 1u, src.width - 1u);
+                    level.depth[(y*level.width) + x] = std::max(
+                        std::max(src.depth[(sy0*src.width) + sx0], src.depth[(sy0*src.width) + sx1]),
+                        std::max(src.depth[(sy1*src.width) + sx0], src.depth[(sy1*src.width) + sx1]));
+                }
+            }
+        }
+        levels_.push_back(std::move(level));
+    }
+
+    return TE_Ok;
+}
+
+float DepthPyramid::getFarthest(const int x0, const int y0, const int x1, const int y1) const NOTHROWS
+{
+    if (levels_.empty())
+        return NAN;
+
+    const int width = (int)levels_[0u].width;
+    const int height = (int)levels_[0u].height;
+    if (x1 < 0 || y1 < 0 || x0 >= width || y0 >= height || x1 < x0 || y1 < y0)
+        return NAN;
+
+    const unsigned cx0 = (unsigned)std::max(x0, 0);
+    const unsigned cy0 = (unsigned)std::max(y0, 0);
+    const unsigned cx1 = (unsigned)std::min(x1, width - 1);
+    const unsigned cy1 = (unsigned)std::min(y1, height - 1);
+
+    // select the level where the rectangle spans no more than 2x2 cells
+    std::size_t lod = 0u;
+    while (lod + 1u < levels_.size() && (((cx1 >> lod) - (cx0 >> lod)) > 1u || ((cy1 >> lod) - (cy0 >> lod)) > 1u))
+        lod++;
+
+    const Level &level = levels_[lod];
+    float farthest = -INFINITY;
+    for (std::size_t y = (cy0 >> lod); y <= (cy1 >> lod); y++) {
+        for (std::size_t x = (cx0 >> lod); x <= (cx1 >> lod); x++)
+            farthest = std::max(farthest, level.depth[(y*level.width) + x]);
+    }
+    return farthest;
+}
+
+std::size_t DepthPyramid::getWidth() const NOTHROWS
+{
+    return levels_.empty() ? 0u : levels_[0u].width;
+}
+
+std::size_t DepthPyramid::getHeight() const NOTHROWS
+{
+    return levels_.empty() ? 0u : levels_[0u].height;
+}
@@ -0,0 +1,52 @@
+#ifndef TAK_ENGINE_RENDERER_DEPTHPYRAMID_H_INCLUDED
+#define TAK_ENGINE_RENDERER_DEPTHPYRAMID_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * A hierarchical depth buffer. Each level holds the farthest
+             * depth of each 2x2 block of the level below it, so the
+             * farthest depth over any rectangle may be obtained by reading
+             * at most four values.
+             */
+            class ENGINE_API DepthPyramid
+            {
+            private :
+                struct Level
+                {
+                    std::size_t width;
+                    std::size_t height;
+                    std::vector<float> depth;
+                };
+            public :
+                DepthPyramid() NOTHROWS;
+            public :
+                /**
+                 * Builds the pyramid from the specified depth values, in
+                 * row-major order. Greater values are farther.
+                 */
+                Util::TAKErr build(const float *depth, const std::size_t width, const std::size_t height) NOTHROWS;
+                /**
+                 * Returns the farthest depth within the specified pixel
+                 * rectangle, inclusive. The rectangle is clamped to the
+                 * pyramid; returns `NAN` if it lies entirely outside or the
+                 * pyramid is empty.
+                 */
+                float getFarthest(const int x0, const int y0, const int x1, const int y1) const NOTHROWS;
+                std::size_t getWidth() const NOTHROWS;
+                std::size_t getHeight() const NOTHROWS;
+            private :
+                std::vector<Level> levels_;
+            };
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "renderer/DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Util;
+
+// larger than any offset within a bitmap; squared sum does not overflow
+#define DISTANCEFIELD_FAR 0x4000
+
+namespace
+{
+    struct Offset
+    {
+        int dx;
+        int dy;
+    };
+
+    void encodeChannels(Bitmap2 &value, const std::size_t channel, const std::size_t numChannels, const std::vector<uint8_t> &mask, const std::size_t spread) NOTHROWS;
+    void distanceTransform(std::vector<float> &value, const std::vector<uint8_t> &mask, const std::size_t width, const std::size_t height, const uint8_t target) NOTHROWS;
+    void propagate(std::vector<Offset> &grid, const std::size_t width, const std::size_t height, const std::size_t x, const std::size_t y, const int offx, const int offy) NOTHROWS;
+}
+
+TAKErr TAK::Engine::Renderer::DistanceField_create(BitmapPtr &value, const Bitmap2 &bitmap, const std::size_t spread) NOTHROWS
+{
+    if (!bitmap.getWidth() || !bitmap.getHeight() || !spread)
+        return TE_InvalidArg;
+
+    BitmapPtr_const rgba(&bitmap, Memory_leaker_const<Bitmap2>);
+    if (bitmap.getFormat() != Bitmap2::RGBA32)
+        rgba = BitmapPtr_const(new Bitmap2(bitmap, Bitmap2::RGBA32), Memory_deleter_const<Bitmap2>);
+
+    const std::size_t width = bitmap.getWidth() + 2u*spread;
+    const std::size_t height = bitmap.getHeight() + 2u*spread;
+
+    // classify the source pixels; the padding is outside
+    std::vector<uint8_t> shape(width*height, 0u);
+    std::vector<uint8_t> fill(width*height, 0u);
+    for (std::size_t y = 0u; y < bitmap.getHeight(); y++) {
+        const uint8_t *px = rgba->getData() + (y*rgba->getStride());
+        for (std::size_t x = 0u; x < bitmap.getWidth(); x++) {
+            const std::size_t idx = ((y + spread)*width) + (x + spread);
+            const bool opaque = (px[3] >= 0x80u);
+            const unsigned luminance = ((px[0] * 299u) + (px[1] * 587u) + (px[2] * 114u)) / 1000u;
+            shape[idx] = opaque ? 1u : 0u;
+            fill[idx] = (opaque && luminance >= 0x80u) ? 1u : 0u;
+            px += 4u;
+        }
+    }
+
+    value = BitmapPtr(new Bitmap2(width, height, Bitmap2::RGBA32), Memory_deleter_const<Bitmap2>);
+    encodeChannels(*value, 0u, 3u, fill, spread);
+    encodeChannels(*value, 3u, 1u, shape, spread);
+
+    return TE_Ok;
+}
+
+namespace
+{
+    void encodeChannels(Bitmap2 &value, const std::size_t channel, const std::size_t numChannels, const std::vector<uint8_t> &mask, const std::size_t spread) NOTHROWS
+    {
+        const std::size_t width = value.getWidth();
+        const std::size_t height = value.getHeight();
+
+        std::vector<float> toInside;
+        distanceTransform(toInside, mask, width, height, 1u);
+        std::vector<float> toOutside;
+        distanceTransform(toOutside, mask, width, height, 0u);
+
+        const float scale = 128.f / (float)spread;
+        for (std::size_t y = 0u; y < height; y++) {
+            uint8_t *px = value.getData() + (y*value.getStride()) + channel;
+            for (std::size_t x = 0u; x < width; x++) {
+                const std::size_t idx = (y*width) + x;
+                // the edge lies halfway between pixel centers
+                const float d = mask[idx] ? (toOutside[idx] - 0.5f) : -(toInside[idx] - 0.5f);
+                const float v = std::min(std::max(128.f + (d*scale), 0.f), 255.f);
+                for (std::size_t c = 0u; c < numChannels; c++)
+                    px[c] = (uint8_t)v;
+                px += 4u;
+            }
+        }
+    }
+
+    // 8-point sequential Euclidean distance transform
+    void distanceTransform(std::vector<float> &value, const std::vector<uint8_t> &mask, const std::size_t width, const std::size_t height, const uint8_t target) NOTHROWS
+    {
+        std::vector<Offset> grid(width*height);
+        for (std::size_t i = 0u; i < grid.size(); i++) {
+            grid[i].dx = (mask[i] == target) ? 0 : DISTANCEFIELD_FAR;
+            grid[i].dy = grid[i].dx;
+        }
+
+        for (std::size_t y = 0u; y < height; y++) {
+            for (std::size_t x = 0u; x < width; x++) {
+                propagate(grid, width, height, x, y, -1, 0);
+                propagate(grid, width, height, x, y, 0, -1);
+                propagate(grid, width, height, x, y, -1, -1);
+                propagate(grid, width, height, x, y, 1, -1);
+            }
+            for (std::size_t x = width; x > 0u; x--)
+                propagate(grid, width, height, x - 1u, y, 1, 0);
+        }
+        for (std::size_t y = height; y > 0u; y--) {
+            for (std::size_t x = width; x > 0u; x--) {
+                propagate(grid, width, height, x - 1u, y - 1u, 1, 0);
+                propagate(grid, width, height, x - 1u, y - 1u, 0, 1);
+                propagate(grid, width, height, x - 1u, y - 1u, -1, 1);
+                propagate(grid, width, height, x - 1u, y - 1u, 1, 1);
+            }
+            for (std::size_t x = 0u; x < width; x++)
+                propagate(grid, width, height, x, y - 1u, -1, 0);
+        }
+
+        value.resize(grid.size());
+        for (std::size_t i = 0u; i < grid.size(); i++)
+            value[i] = sqrt((float)((grid[i].dx*grid[i].dx) + (grid[i].dy*grid[i].dy)));
+    }
+
+    void propagate(std::vector<Offset> &grid, const std::size_t width, const std::size_t height, const std::size_t x, const std::size_t y, const int offx, const int offy) NOTHROWS
+    {
+        const int nx = (int)x + offx;
+        const int ny = (int)y + offy;
+        if (nx < 0 || ny < 0 || nx >= (int)width || ny >= (int)height)
+            return;
+
+        Offset &p = grid[(y*width) + x];
+        Offset other = grid[((std::size_t)ny*width) + (std::size_t)nx];
+        if (other.dx == DISTANCEFIELD_FAR)
+            return;
+        other.dx += offx;
+        other.dy += offy;
+        if (((other.dx*other.dx) + (other.dy*other.dy)) < ((p.dx*p.dx) + (p.dy*p.dy)))
+            p = other;
+    }
+}
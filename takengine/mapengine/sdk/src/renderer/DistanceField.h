@@ -0,0 +1,26 @@
+#ifndef TAK_ENGINE_RENDERER_DISTANCEFIELD_H_INCLUDED
+#define TAK_ENGINE_RENDERER_DISTANCEFIELD_H_INCLUDED
+
+#include "port/Platform.h"
+#include "renderer/Bitmap2.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Creates a signed distance field from the specified bitmap.
+             * The result is an RGBA32 bitmap padded by `spread` pixels on
+             * each side. The alpha channel holds the distance to the edge
+             * of the opaque pixels. The color channels hold the distance to
+             * the edge of the light, opaque pixels, so text rasterized with
+             * a dark outline keeps its outline. Distances in
+             * `[-spread, spread]` are mapped to `[0, 255]`; the edge is at
+             * `128` and inside is greater.
+             */
+            ENGINE_API Util::TAKErr DistanceField_create(BitmapPtr &value, const Bitmap2 &bitmap, const std::size_t spread) NOTHROWS;
+        }
+    }
+}
+
+#endif
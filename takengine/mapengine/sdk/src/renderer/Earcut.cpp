@@ -0,0 +1,887 @@
+#include "renderer/Earcut.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "util/ScratchArena.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    // polygons with fewer vertices are clipped without the z-order hash
+    const std::size_t HASH_THRESHOLD = 80u;
+
+    struct Node
+    {
+        Node(const std::size_t i_, const double x_, const double y_) NOTHROWS :
+            i(i_),
+            x(x_),
+            y(y_),
+            prev(nullptr),
+            next(nullptr),
+            z(0),
+            prevZ(nullptr),
+            nextZ(nullptr),
+            steiner(false)
+        {}
+
+        // vertex index in the source data
+        std::size_t i;
+        double x;
+        double y;
+        // previous and next vertex in the ring
+        Node *prev;
+        Node *next;
+        // z-order curve value
+        int32_t z;
+        // previous and next vertex in z-order
+        Node *prevZ;
+        Node *nextZ;
+        // indicates a single vertex hole
+        bool steiner;
+    };
+
+    class Earcut
+    {
+    public :
+        Earcut(std::size_t *indices, const std::size_t capacity, ScratchArena &arena) NOTHROWS;
+    public :
+        TAKErr triangulate(const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings) NOTHROWS;
+    public :
+        std::size_t count;
+    private :
+        Node *linkedList(const double *vertices, const std::size_t stride, const std::size_t start, const std::size_t end, const bool clockwise) NOTHROWS;
+        Node *filterPoints(Node *start, Node *end = nullptr) NOTHROWS;
+        void earcutLinked(Node *ear, const int pass) NOTHROWS;
+        bool isEar(const Node *ear) const NOTHROWS;
+        bool isEarHashed(const Node *ear) const NOTHROWS;
+        Node *cureLocalIntersections(Node *start) NOTHROWS;
+        void splitEarcut(Node *start) NOTHROWS;
+        Node *eliminateHoles(const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings, Node *outerNode) NOTHROWS;
+        Node *eliminateHole(Node *hole, Node *outerNode) NOTHROWS;
+        Node *findHoleBridge(Node *hole, Node *outerNode) const NOTHROWS;
+        void indexCurve(Node *start) const NOTHROWS;
+        int32_t zOrder(const double x, const double y) const NOTHROWS;
+        Node *splitPolygon(Node *a, Node *b) NOTHROWS;
+        Node *insertNode(const std::size_t i, const double x, const double y, Node *last) NOTHROWS;
+        void emit(const Node *a, const Node *b, const Node *c) NOTHROWS;
+    private :
+        std::size_t *indices;
+        std::size_t capacity;
+        ScratchArena &arena;
+        double minX;
+        double minY;
+        double invSize;
+        bool error;
+    };
+
+    double signedArea(const double *vertices, const std::size_t stride, const std::size_t start, const std::size_t end) NOTHROWS;
+    double area(const Node *p, const Node *q, const Node *r) NOTHROWS;
+    bool equals(const Node *a, const Node *b) NOTHROWS;
+    bool pointInTriangle(const double ax, const double ay, const double bx, const double by, const double cx, const double cy, const double px, const double py) NOTHROWS;
+    bool intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2) NOTHROWS;
+    bool onSegment(const Node *p, const Node *q, const Node *r) NOTHROWS;
+    int sign(const double v) NOTHROWS;
+    bool intersectsPolygon(const Node *a, const Node *b) NOTHROWS;
+    bool locallyInside(const Node *a, const Node *b) NOTHROWS;
+    bool middleInside(const Node *a, const Node *b) NOTHROWS;
+    bool isValidDiagonal(const Node *a, const Node *b) NOTHROWS;
+    bool sectorContainsSector(const Node *m, const Node *p) NOTHROWS;
+    Node *getLeftmost(Node *start) NOTHROWS;
+    Node *sortLinked(Node *list) NOTHROWS;
+    void removeNode(Node *p) NOTHROWS;
+}
+
+TAKErr TAK::Engine::Renderer::Earcut_triangulate(std::size_t *indices, std::size_t *idxCount, const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    if (!indices || !idxCount || !vertices || !ringCounts)
+        return TE_InvalidArg;
+    if (stride < 2u)
+        return TE_InvalidArg;
+    if (!numRings || ringCounts[0] < 3u)
+        return TE_InvalidArg;
+
+    std::size_t numVerts = 0u;
+    for (std::size_t i = 0u; i < numRings; i++)
+        numVerts += ringCounts[i];
+
+    // all nodes are released when the scope exits
+    ScratchArenaScope scratch;
+
+    Earcut earcut(indices, Earcut_maxIndexCount(numVerts, numRings), scratch.arena);
+    code = earcut.triangulate(vertices, stride, ringCounts, numRings);
+    TE_CHECKRETURN_CODE(code);
+
+    *idxCount = earcut.count;
+    return code;
+}
+
+std::size_t TAK::Engine::Renderer::Earcut_maxIndexCount(const std::size_t numVerts, const std::size_t numRings) NOTHROWS
+{
+    // each hole bridge introduces two vertices
+    const std::size_t bridged = numVerts + (numRings ? 2u * (numRings - 1u) : 0u);
+    return (bridged > 2u) ? (bridged - 2u) * 3u : 0u;
+}
+
+TAKErr TAK::Engine::Renderer::Earcut_deviation(double *value, const std::size_t *indices, const std::size_t idxCount, const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings) NOTHROWS
+{
+    if (!value || (idxCount && !indices) || !vertices || !ringCounts)
+        return TE_InvalidArg;
+    if (stride < 2u)
+        return TE_InvalidArg;
+    if (!numRings)
+        return TE_InvalidArg;
+
+    std::size_t start = 0u;
+    double polygonArea = 0.0;
+    for (std::size_t i = 0u; i < numRings; i++) {
+        const double ringArea = std::fabs(signedArea(vertices, stride, start * stride, (start + ringCounts[i]) * stride));
+        polygonArea += i ? -ringArea : ringArea;
+        start += ringCounts[i];
+    }
+
+    double trianglesArea = 0.0;
+    for (std::size_t i = 0u; (i + 2u) < idxCount; i += 3u) {
+        const double *a = vertices + indices[i] * stride;
+        const double *b = vertices + indices[i + 1u] * stride;
+        const double *c = vertices + indices[i + 2u] * stride;
+        trianglesArea += std::fabs((a[0] - c[0]) * (b[1] - a[1]) - (a[0] - b[0]) * (c[1] - a[1]));
+    }
+
+    if (polygonArea == 0.0 && trianglesArea == 0.0)
+        *value = 0.0;
+    else
+        *value = std::fabs((trianglesArea - polygonArea) / polygonArea);
+    return TE_Ok;
+}
+
+namespace
+{
+    Earcut::Earcut(std::size_t *indices_, const std::size_t capacity_, ScratchArena &arena_) NOTHROWS :
+        count(0u),
+        indices(indices_),
+        capacity(capacity_),
+        arena(arena_),
+        minX(0.0),
+        minY(0.0),
+        invSize(0.0),
+        error(false)
+    {}
+
+    TAKErr Earcut::triangulate(const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings) NOTHROWS
+    {
+        const std::size_t outerLen = ringCounts[0] * stride;
+        Node *outerNode = linkedList(vertices, stride, 0u, outerLen, true);
+        if (error)
+            return TE_OutOfMemory;
+        if (!outerNode || outerNode->next == outerNode->prev)
+            return TE_Ok;
+
+        if (numRings > 1u) {
+            outerNode = eliminateHoles(vertices, stride, ringCounts, numRings, outerNode);
+            if (error)
+                return TE_OutOfMemory;
+        }
+
+        // if the shape is not too simple, use z-order curve hash
+        std::size_t numVerts = 0u;
+        for (std::size_t i = 0u; i < numRings; i++)
+            numVerts += ringCounts[i];
+        if (numVerts > HASH_THRESHOLD) {
+            minX = vertices[0];
+            minY = vertices[1];
+            double maxX = minX;
+            double maxY = minY;
+            for (std::size_t i = stride; i < outerLen; i += stride) {
+                const double x = vertices[i];
+                const double y = vertices[i + 1u];
+                if (x < minX) minX = x;
+                if (y < minY) minY = y;
+                if (x > maxX) maxX = x;
+                if (y > maxY) maxY = y;
+            }
+
+            // minX, minY and invSize are used to transform coords into
+            // integers for z-order calculation
+            invSize = std::max(maxX - minX, maxY - minY);
+            invSize = (invSize != 0.0) ? 32767.0 / invSize : 0.0;
+        }
+
+        earcutLinked(outerNode, 0);
+        return error ? TE_Err : TE_Ok;
+    }
+
+    Node *Earcut::linkedList(const double *vertices, const std::size_t stride, const std::size_t start, const std::size_t end, const bool clockwise) NOTHROWS
+    {
+        Node *last = nullptr;
+
+        // link the points in the specified winding order
+        if (clockwise == (signedArea(vertices, stride, start, end) > 0.0)) {
+            for (std::size_t i = start; i < end; i += stride) {
+                last = insertNode(i / stride, vertices[i], vertices[i + 1u], last);
+                if (!last)
+                    return nullptr;
+            }
+        } else {
+            for (std::size_t i = end; i > start; i -= stride) {
+                last = insertNode((i - stride) / stride, vertices[i - stride], vertices[i - stride + 1u], last);
+                if (!last)
+                    return nullptr;
+            }
+        }
+
+        // drop the closing vertex
+        if (last && equals(last, last->next)) {
+            removeNode(last);
+            last = last->next;
+        }
+
+        return last;
+    }
+
+    Node *Earcut::filterPoints(Node *start, Node *end) NOTHROWS
+    {
+        if (!start)
+            return start;
+        if (!end)
+            end = start;
+
+        // eliminate colinear or duplicate points
+        Node *p = start;
+        bool again;
+        do {
+            again = false;
+
+            if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0.0)) {
+                removeNode(p);
+                p = end = p->prev;
+                if (p == p->next)
+                    break;
+                again = true;
+            } else {
+                p = p->next;
+            }
+        } while (again || p != end);
+
+        return end;
+    }
+
+    void Earcut::earcutLinked(Node *ear, const int pass) NOTHROWS
+    {
+        if (!ear || error)
+            return;
+
+        // interlink polygon nodes in z-order
+        if (!pass && invSize)
+            indexCurve(ear);
+
+        Node *stop = ear;
+
+        // iterate through ears, slicing them one by one
+        while (ear->prev != ear->next) {
+            Node *prev = ear->prev;
+            Node *next = ear->next;
+
+            if (invSize ? isEarHashed(ear) : isEar(ear)) {
+                // cut off the triangle
+                emit(prev, ear, next);
+
+                removeNode(ear);
+
+                // skipping the next vertex leads to less sliver triangles
+                ear = next->next;
+                stop = next->next;
+
+                continue;
+            }
+
+            ear = next;
+
+            // if we looped through the whole remaining polygon and can't
+            // find any more ears
+            if (ear == stop) {
+                if (!pass) {
+                    // try filtering points and slicing again
+                    earcutLinked(filterPoints(ear), 1);
+                } else if (pass == 1) {
+                    // if this didn't work, try curing all small
+                    // self-intersections locally
+                    ear = cureLocalIntersections(filterPoints(ear));
+                    earcutLinked(ear, 2);
+                } else if (pass == 2) {
+                    // as a last resort, try splitting the remaining polygon
+                    // into two
+                    splitEarcut(ear);
+                }
+
+                break;
+            }
+        }
+    }
+
+    bool Earcut::isEar(const Node *ear) const NOTHROWS
+    {
+        const Node *a = ear->prev;
+        const Node *b = ear;
+        const Node *c = ear->next;
+
+        // reflex, can't be an ear
+        if (area(a, b, c) >= 0.0)
+            return false;
+
+        const double ax = a->x, bx = b->x, cx = c->x, ay = a->y, by = b->y, cy = c->y;
+
+        // triangle bbox
+        const double x0 = std::min(ax, std::min(bx, cx));
+        const double y0 = std::min(ay, std::min(by, cy));
+        const double x1 = std::max(ax, std::max(bx, cx));
+        const double y1 = std::max(ay, std::max(by, cy));
+
+        // now make sure we don't have other points inside the potential ear
+        const Node *p = c->next;
+        while (p != a) {
+            if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+                pointInTriangle(ax, ay, bx, by, cx, cy, p->x, p->y) &&
+                area(p->prev, p, p->next) >= 0.0) {
+
+                return false;
+            }
+            p = p->next;
+        }
+
+        return true;
+    }
+
+    bool Earcut::isEarHashed(const Node *ear) const NOTHROWS
+    {
+        const Node *a = ear->prev;
+        const Node *b = ear;
+        const Node *c = ear->next;
+
+        // reflex, can't be an ear
+        if (area(a, b, c) >= 0.0)
+            return false;
+
+        const double ax = a->x, bx = b->x, cx = c->x, ay = a->y, by = b->y, cy = c->y;
+
+        // triangle bbox
+        const double x0 = std::min(ax, std::min(bx, cx));
+        const double y0 = std::min(ay, std::min(by, cy));
+        const double x1 = std::max(ax, std::max(bx, cx));
+        const double y1 = std::max(ay, std::max(by, cy));
+
+        // z-order range for the current triangle bbox
+        const int32_t minZ = zOrder(x0, y0);
+        const int32_t maxZ = zOrder(x1, y1);
+
+#define __TE_EARCUT_IN_EAR(n) \
+    ((n)->x >= x0 && (n)->x <= x1 && (n)->y >= y0 && (n)->y <= y1 && (n) != a && (n) != c && \
+     pointInTriangle(ax, ay, bx, by, cx, cy, (n)->x, (n)->y) && area((n)->prev, (n), (n)->next) >= 0.0)
+
+        const Node *p = ear->prevZ;
+        const Node *n = ear->nextZ;
+
+        // look for points inside the triangle in both directions
+        while (p && p->z >= minZ && n && n->z <= maxZ) {
+            if (__TE_EARCUT_IN_EAR(p))
+                return false;
+            p = p->prevZ;
+
+            if (__TE_EARCUT_IN_EAR(n))
+                return false;
+            n = n->nextZ;
+        }
+
+        // look for remaining points in decreasing z-order
+        while (p && p->z >= minZ) {
+            if (__TE_EARCUT_IN_EAR(p))
+                return false;
+            p = p->prevZ;
+        }
+
+        // look for remaining points in increasing z-order
+        while (n && n->z <= maxZ) {
+            if (__TE_EARCUT_IN_EAR(n))
+                return false;
+            n = n->nextZ;
+        }
+#undef __TE_EARCUT_IN_EAR
+
+        return true;
+    }
+
+    Node *Earcut::cureLocalIntersections(Node *start) NOTHROWS
+    {
+        Node *p = start;
+        do {
+            Node *a = p->prev;
+            Node *b = p->next->next;
+
+            if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+                emit(a, p, b);
+
+                // remove two nodes involved
+                removeNode(p);
+                removeNode(p->next);
+
+                p = start = b;
+            }
+            p = p->next;
+        } while (p != start);
+
+        return filterPoints(p);
+    }
+
+    void Earcut::splitEarcut(Node *start) NOTHROWS
+    {
+        // look for a valid diagonal that divides the polygon into two
+        Node *a = start;
+        do {
+            Node *b = a->next->next;
+            while (b != a->prev) {
+                if (a->i != b->i && isValidDiagonal(a, b)) {
+                    // split the polygon in two by the diagonal
+                    Node *c = splitPolygon(a, b);
+                    if (!c)
+                        return;
+
+                    // filter colinear points around the cuts
+                    a = filterPoints(a, a->next);
+                    c = filterPoints(c, c->next);
+
+                    // run earcut on each half
+                    earcutLinked(a, 0);
+                    earcutLinked(c, 0);
+                    return;
+                }
+                b = b->next;
+            }
+            a = a->next;
+        } while (a != start);
+    }
+
+    Node *Earcut::eliminateHoles(const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings, Node *outerNode) NOTHROWS
+    {
+        std::vector<Node *, ScratchAllocator<Node *>> queue{ScratchAllocator<Node *>(arena)};
+        try {
+            queue.reserve(numRings - 1u);
+        } catch (...) {
+            error = true;
+            return outerNode;
+        }
+
+        std::size_t start = ringCounts[0];
+        for (std::size_t i = 1u; i < numRings; i++) {
+            const std::size_t end = start + ringCounts[i];
+            Node *list = linkedList(vertices, stride, start * stride, end * stride, false);
+            start = end;
+            if (error)
+                return outerNode;
+            if (!list)
+                continue;
+            if (list == list->next)
+                list->steiner = true;
+            queue.push_back(getLeftmost(list));
+        }
+
+        std::sort(queue.begin(), queue.end(), [](const Node *a, const Node *b) { return a->x < b->x; });
+
+        // process holes from left to right
+        for (std::size_t i = 0u; i < queue.size(); i++) {
+            outerNode = eliminateHole(queue[i], outerNode);
+            if (error)
+                break;
+        }
+
+        return outerNode;
+    }
+
+    Node *Earcut::eliminateHole(Node *hole, Node *outerNode) NOTHROWS
+    {
+        Node *bridge = findHoleBridge(hole, outerNode);
+        if (!bridge)
+            return outerNode;
+
+        Node *bridgeReverse = splitPolygon(bridge, hole);
+        if (!bridgeReverse)
+            return outerNode;
+
+        // filter colinear points around the cuts
+        filterPoints(bridgeReverse, bridgeReverse->next);
+        return filterPoints(bridge, bridge->next);
+    }
+
+    Node *Earcut::findHoleBridge(Node *hole, Node *outerNode) const NOTHROWS
+    {
+        Node *p = outerNode;
+        const double hx = hole->x;
+        const double hy = hole->y;
+        double qx = -std::numeric_limits<double>::infinity();
+        Node *m = nullptr;
+
+        // find a segment intersected by a ray from the hole's leftmost
+        // point to the left; segment's endpoint with lesser x will be
+        // potential connection point
+        do {
+            if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+                const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+                if (x <= hx && x > qx) {
+                    qx = x;
+                    m = (p->x < p->next->x) ? p : p->next;
+                    // hole touches outer segment; pick leftmost endpoint
+                    if (x == hx)
+                        return m;
+                }
+            }
+            p = p->next;
+        } while (p != outerNode);
+
+        if (!m)
+            return nullptr;
+
+        // look for points inside the triangle of hole point, segment
+        // intersection and endpoint; if there are no points found, we have
+        // a valid connection; otherwise choose the point of the minimum
+        // angle with the ray as connection point
+        const Node *stop = m;
+        const double mx = m->x;
+        const double my = m->y;
+        double tanMin = std::numeric_limits<double>::infinity();
+
+        p = m;
+        do {
+            if (hx >= p->x && p->x >= mx && hx != p->x &&
+                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+
+                const double tan = std::fabs(hy - p->y) / (hx - p->x);
+
+                if (locallyInside(p, hole) &&
+                    (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+
+            p = p->next;
+        } while (p != stop);
+
+        return m;
+    }
+
+    void Earcut::indexCurve(Node *start) const NOTHROWS
+    {
+        Node *p = start;
+        do {
+            if (p->z == 0)
+                p->z = zOrder(p->x, p->y);
+            p->prevZ = p->prev;
+            p->nextZ = p->next;
+            p = p->next;
+        } while (p != start);
+
+        p->prevZ->nextZ = nullptr;
+        p->prevZ = nullptr;
+
+        sortLinked(p);
+    }
+
+    int32_t Earcut::zOrder(const double x_, const double y_) const NOTHROWS
+    {
+        // coords are transformed into non-negative 15-bit integer range;
+        // hole vertices outside of the exterior ring's bounds are clamped
+        auto x = static_cast<uint32_t>(std::max(0.0, std::min((x_ - minX) * invSize, 32767.0)));
+        auto y = static_cast<uint32_t>(std::max(0.0, std::min((y_ - minY) * invSize, 32767.0)));
+
+        x = (x | (x << 8u)) & 0x00FF00FFu;
+        x = (x | (x << 4u)) & 0x0F0F0F0Fu;
+        x = (x | (x << 2u)) & 0x33333333u;
+        x = (x | (x << 1u)) & 0x55555555u;
+
+        y = (y | (y << 8u)) & 0x00FF00FFu;
+        y = (y | (y << 4u)) & 0x0F0F0F0Fu;
+        y = (y | (y << 2u)) & 0x33333333u;
+        y = (y | (y << 1u)) & 0x55555555u;
+
+        return static_cast<int32_t>(x | (y << 1u));
+    }
+
+    Node *Earcut::splitPolygon(Node *a, Node *b) NOTHROWS
+    {
+        // link two polygon vertices with a bridge; if the vertices belong
+        // to the same ring, it splits polygon into two; if one belongs to
+        // the outer ring and another to a hole, it merges it into a single
+        // ring
+        void *a2mem = arena.allocate(sizeof(Node), alignof(Node));
+        void *b2mem = arena.allocate(sizeof(Node), alignof(Node));
+        if (!a2mem || !b2mem) {
+            error = true;
+            return nullptr;
+        }
+
+        Node *a2 = new(a2mem) Node(a->i, a->x, a->y);
+        Node *b2 = new(b2mem) Node(b->i, b->x, b->y);
+        Node *an = a->next;
+        Node *bp = b->prev;
+
+        a->next = b;
+        b->prev = a;
+
+        a2->next = an;
+        an->prev = a2;
+
+        b2->next = a2;
+        a2->prev = b2;
+
+        bp->next = b2;
+        b2->prev = bp;
+
+        return b2;
+    }
+
+    Node *Earcut::insertNode(const std::size_t i, const double x, const double y, Node *last) NOTHROWS
+    {
+        void *mem = arena.allocate(sizeof(Node), alignof(Node));
+        if (!mem) {
+            error = true;
+            return nullptr;
+        }
+
+        // create a node and optionally link it with previous one (in a
+        // circular doubly linked list)
+        Node *p = new(mem) Node(i, x, y);
+        if (!last) {
+            p->prev = p;
+            p->next = p;
+        } else {
+            p->next = last->next;
+            p->prev = last;
+            last->next->prev = p;
+            last->next = p;
+        }
+        return p;
+    }
+
+    void Earcut::emit(const Node *a, const Node *b, const Node *c) NOTHROWS
+    {
+        if ((count + 3u) > capacity) {
+            error = true;
+            return;
+        }
+        indices[count++] = a->i;
+        indices[count++] = b->i;
+        indices[count++] = c->i;
+    }
+
+    double signedArea(const double *vertices, const std::size_t stride, const std::size_t start, const std::size_t end) NOTHROWS
+    {
+        double sum = 0.0;
+        if (end <= start)
+            return sum;
+        for (std::size_t i = start, j = end - stride; i < end; i += stride) {
+            sum += (vertices[j] - vertices[i]) * (vertices[i + 1u] + vertices[j + 1u]);
+            j = i;
+        }
+        return sum;
+    }
+
+    double area(const Node *p, const Node *q, const Node *r) NOTHROWS
+    {
+        // signed area of a triangle
+        return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+    }
+
+    bool equals(const Node *a, const Node *b) NOTHROWS
+    {
+        return a->x == b->x && a->y == b->y;
+    }
+
+    bool pointInTriangle(const double ax, const double ay, const double bx, const double by, const double cx, const double cy, const double px, const double py) NOTHROWS
+    {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    bool intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2) NOTHROWS
+    {
+        const int o1 = sign(area(p1, q1, p2));
+        const int o2 = sign(area(p1, q1, q2));
+        const int o3 = sign(area(p2, q2, p1));
+        const int o4 = sign(area(p2, q2, q1));
+
+        // general case
+        if (o1 != o2 && o3 != o4)
+            return true;
+
+        // colinear cases
+        if (o1 == 0 && onSegment(p1, p2, q1)) return true;
+        if (o2 == 0 && onSegment(p1, q2, q1)) return true;
+        if (o3 == 0 && onSegment(p2, p1, q2)) return true;
+        if (o4 == 0 && onSegment(p2, q1, q2)) return true;
+
+        return false;
+    }
+
+    bool onSegment(const Node *p, const Node *q, const Node *r) NOTHROWS
+    {
+        // for colinear points p, q, r, check if point q lies on segment pr
+        return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+               q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+    }
+
+    int sign(const double v) NOTHROWS
+    {
+        return (v > 0.0) ? 1 : ((v < 0.0) ? -1 : 0);
+    }
+
+    bool intersectsPolygon(const Node *a, const Node *b) NOTHROWS
+    {
+        // check if a polygon diagonal intersects any polygon segments
+        const Node *p = a;
+        do {
+            if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+                intersects(p, p->next, a, b)) {
+
+                return true;
+            }
+            p = p->next;
+        } while (p != a);
+
+        return false;
+    }
+
+    bool locallyInside(const Node *a, const Node *b) NOTHROWS
+    {
+        // check if a polygon diagonal is locally inside the polygon
+        return (area(a->prev, a, a->next) < 0.0) ?
+            (area(a, b, a->next) >= 0.0 && area(a, a->prev, b) >= 0.0) :
+            (area(a, b, a->prev) < 0.0 || area(a, a->next, b) < 0.0);
+    }
+
+    bool middleInside(const Node *a, const Node *b) NOTHROWS
+    {
+        // check if the middle point of a polygon diagonal is inside the
+        // polygon
+        const Node *p = a;
+        bool inside = false;
+        const double px = (a->x + b->x) / 2.0;
+        const double py = (a->y + b->y) / 2.0;
+        do {
+            if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+                (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)) {
+
+                inside = !inside;
+            }
+            p = p->next;
+        } while (p != a);
+
+        return inside;
+    }
+
+    bool isValidDiagonal(const Node *a, const Node *b) NOTHROWS
+    {
+        // check if a diagonal between two polygon nodes is valid (lies in
+        // polygon interior)
+        return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+            // locally visible
+            ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+              // does not create opposite-facing sectors
+              (area(a->prev, a, b->prev) != 0.0 || area(a, b->prev, b) != 0.0)) ||
+             // special zero-length case
+             (equals(a, b) && area(a->prev, a, a->next) > 0.0 && area(b->prev, b, b->next) > 0.0));
+    }
+
+    bool sectorContainsSector(const Node *m, const Node *p) NOTHROWS
+    {
+        // whether sector in vertex m contains sector in vertex p in the same
+        // coordinates
+        return area(m->prev, m, p->prev) < 0.0 && area(p->next, m, m->next) < 0.0;
+    }
+
+    Node *getLeftmost(Node *start) NOTHROWS
+    {
+        // find the leftmost node of a polygon ring
+        Node *p = start;
+        Node *leftmost = start;
+        do {
+            if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y))
+                leftmost = p;
+            p = p->next;
+        } while (p != start);
+
+        return leftmost;
+    }
+
+    Node *sortLinked(Node *list) NOTHROWS
+    {
+        // linked list merge sort on z-order
+        std::size_t inSize = 1u;
+        std::size_t numMerges;
+        do {
+            Node *p = list;
+            Node *tail = nullptr;
+            list = nullptr;
+            numMerges = 0u;
+
+            while (p) {
+                numMerges++;
+                Node *q = p;
+                std::size_t pSize = 0u;
+                for (std::size_t i = 0u; i < inSize; i++) {
+                    pSize++;
+                    q = q->nextZ;
+                    if (!q)
+                        break;
+                }
+                std::size_t qSize = inSize;
+
+                while (pSize > 0u || (qSize > 0u && q)) {
+                    Node *e;
+                    if (pSize != 0u && (qSize == 0u || !q || p->z <= q->z)) {
+                        e = p;
+                        p = p->nextZ;
+                        pSize--;
+                    } else {
+                        e = q;
+                        q = q->nextZ;
+                        qSize--;
+                    }
+
+                    if (tail)
+                        tail->nextZ = e;
+                    else
+                        list = e;
+
+                    e->prevZ = tail;
+                    tail = e;
+                }
+
+                p = q;
+            }
+
+            tail->nextZ = nullptr;
+            inSize *= 2u;
+        } while (numMerges > 1u);
+
+        return list;
+    }
+
+    void removeNode(Node *p) NOTHROWS
+    {
+        p->next->prev = p->prev;
+        p->prev->next = p->next;
+
+        if (p->prevZ)
+            p->prevZ->nextZ = p->nextZ;
+        if (p->nextZ)
+            p->nextZ->prevZ = p->prevZ;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef TAK_ENGINE_RENDERER_EARCUT_H_INCLUDED
+#define TAK_ENGINE_RENDERER_EARCUT_H_INCLUDED
+
+#include <cstdlib>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Performs a 2D triangulation of the specified polygon via ear
+             * clipping. The first ring is the exterior ring; any subsequent
+             * rings are holes, which are bridged into the exterior ring
+             * prior to clipping. For larger polygons, candidate ears are
+             * only tested against vertices that are nearby on a z-order
+             * curve.
+             *
+             * <P>Self-intersecting input is not detected and will produce
+             * triangles that do not cover the polygon;
+             * {@link #Earcut_deviation} may be used to test the result.
+             *
+             * @param indices       Returns the indices, must have a capacity of at least <code>Earcut_maxIndexCount(numVerts, numRings)</code> elements
+             * @param idxCount      Returns the number of indices computed
+             * @param vertices      The vertices buffer, ordered x,y. The vertices for each ring are contiguous, with the rings in order.
+             * @param stride        The stride, in elements between coordinate pairs
+             * @param ringCounts    The number of vertices in each ring
+             * @param numRings      The number of rings
+             *
+             * @return  TE_Ok on success
+             */
+            ENGINE_API Util::TAKErr Earcut_triangulate(std::size_t *indices, std::size_t *idxCount, const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings) NOTHROWS;
+
+            /**
+             * Returns the maximum number of indices that may be produced by
+             * {@link #Earcut_triangulate} for a polygon with the specified
+             * total number of vertices and rings.
+             */
+            ENGINE_API std::size_t Earcut_maxIndexCount(const std::size_t numVerts, const std::size_t numRings) NOTHROWS;
+
+            /**
+             * Computes the relative difference between the area of the
+             * polygon and the total area of the triangles produced by
+             * {@link #Earcut_triangulate}. A value near zero indicates that
+             * the triangulation is correct.
+             *
+             * @param value         Returns the deviation
+             * @param indices       The triangle indices
+             * @param idxCount      The number of triangle indices
+             * @param vertices      The vertices buffer, as passed to <code>Earcut_triangulate</code>
+             * @param stride        The stride, in elements between coordinate pairs
+             * @param ringCounts    The number of vertices in each ring
+             * @param numRings      The number of rings
+             *
+             * @return  TE_Ok on success
+             */
+            ENGINE_API Util::TAKErr Earcut_deviation(double *value, const std::size_t *indices, const std::size_t idxCount, const double *vertices, const std::size_t stride, const std::size_t *ringCounts, const std::size_t numRings) NOTHROWS;
+        }
+    }
+}
+#endif
@@ -9,6 +9,8 @@
 #include "core/MapSceneModel2.h"
 #include "renderer/RenderState.h"
 
+#include <algorithm>
+
 #define PROFILE_DEPTH_TESTS 0
 
 #if PROFILE_DEPTH_TESTS
@@ -91,6 +93,12 @@ namespace {
 
     const int VIEWPORT_WIDTH = 4;
     const int VIEWPORT_HEIGHT = 4;
+    // the tile that may be sampled with the default viewport
+    const std::size_t DEFAULT_TILE_SIZE = 3u;
+
+    double decodeDepth(const uint8_t *px) NOTHROWS;
+    uint32_t decodeId(const uint8_t *px) NOTHROWS;
+    void decodeTile(GLDepthSampler::Sample &sample, const uint8_t *pixels, const bool depth, const bool ids, const std::vector<GLDepthSamplerDrawable*> &drawables) NOTHROWS;
 
     std::shared_ptr<const Shader2> get_shared_id_encoding_program(const TAK::Engine::Core::RenderContext& ctx) {
         static std::shared_ptr<const Shader2> inst;
@@ -119,12 +127,20 @@ GLDepthSampler::GLDepthSampler()
 fullscreen_quad_fbo_(nullptr, nullptr),
 bound_fbo_(0),
 method_(ENCODED_DEPTH_ENCODED_ID),
+tile_size_(DEFAULT_TILE_SIZE),
 x_(0),
 y_(0)
 {
 }
 
 GLDepthSampler::~GLDepthSampler() {
+    while (!pending_samples_.empty()) {
+        PendingSample pending(std::move(pending_samples_.front()));
+        pending_samples_.erase(pending_samples_.begin());
+        deliver(pending, TE_Canceled);
+    }
+    if (!pbos_.empty())
+        glDeleteBuffers((GLsizei)pbos_.size(), pbos_.data());
 }
 
 void GLDepthSampler::beginProj(const TAK::Engine::Core::MapSceneModel2& sceneModel) NOTHROWS {
@@ -188,8 +204,10 @@ void GLDepthSampler::enableEncodingState(const std::shared_ptr<const Shader2>& s
     fbo_->bind();
     glViewport(-(int)x_ + fbo_->width / 2, -(int)y_ + fbo_->height / 2, viewport_[2], viewport_[3]);
 
+    // cover the largest tile that may be sampled
+    const int extent = (int)std::max(tile_size_, DEFAULT_TILE_SIZE);
     glEnable(GL_SCISSOR_TEST);
-    glScissor(fbo_->width / 2 - 1, fbo_->height / 2 - 1, 3, 3);
+    glScissor(fbo_->width / 2 - extent / 2, fbo_->height / 2 - extent / 2, extent, extent);
 
     glDisable(GL_BLEND);
 
@@ -303,18 +321,188 @@ TAKErr GLDepthSampler::performDepthSample(double* resultZ, TAK::Engine::Math::Ma
         code = performDoublePassDepthSample(resultZ, resultDrawable, drawable, sceneModel, x, y);
     }
 
-    if (code == TE_Ok && proj) {
-        float mxf[16];
-        atakmap::renderer::GLES20FixedPipeline::getInstance()->readMatrix(atakmap::renderer::GLES20FixedPipeline::MM_GL_PROJECTION, mxf);
-        for (std::size_t i = 0u; i < 16u; i++)
-            proj->set(i % 4u, i / 4u, mxf[i]);
+    if (code == TE_Ok && proj)
+        readProjection(*proj);
+
+    this->endProj();
+
+    return code;
+}
+
+TAKErr GLDepthSampler::performDepthSample(Sample &result, GLDepthSamplerDrawable &drawable, const TAK::Engine::Core::MapSceneModel2& sceneModel,
+    float x, float y, std::size_t tileSize, bool depth, bool ids) NOTHROWS {
+
+    std::vector<uint8_t> pixels(tileSize * tileSize * 4u * ((depth ? 1u : 0u) + (ids ? 1u : 0u)));
+
+    this->beginProj(sceneModel);
+    TAKErr code = drawTile(depth_sampler_drawables_, drawable, sceneModel, x, y, tileSize, depth, ids, pixels.data());
+    if (code == TE_Ok)
+        readProjection(result.proj);
+    this->endProj();
+    TE_CHECKRETURN_CODE(code);
+
+    result.tileSize = tileSize;
+    decodeTile(result, pixels.data(), depth, ids, depth_sampler_drawables_);
+    return code;
+}
+
+TAKErr GLDepthSampler::requestDepthSample(SampleCallback callback, void *opaque, GLDepthSamplerDrawable &drawable, const TAK::Engine::Core::MapSceneModel2& sceneModel,
+    float x, float y, std::size_t tileSize, bool depth, bool ids) NOTHROWS {
+
+    if (!callback)
+        return TE_InvalidArg;
+
+    PendingSample pending;
+    pending.sample.tileSize = tileSize;
+    pending.depth = depth;
+    pending.ids = ids;
+    pending.callback = callback;
+    pending.opaque = opaque;
+    pending.fence = nullptr;
+    if (pbos_.empty()) {
+        pending.pbo = GL_NONE;
+        glGenBuffers(1u, &pending.pbo);
+        if (!pending.pbo)
+            return TE_OutOfMemory;
+    } else {
+        pending.pbo = pbos_.back();
+        pbos_.pop_back();
     }
 
+    // orphan any previous contents
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pending.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, tileSize * tileSize * 4u * ((depth ? 1u : 0u) + (ids ? 1u : 0u)), nullptr, GL_STREAM_READ);
+
+    this->beginProj(sceneModel);
+    // with a pack buffer bound, the destination is an offset into the buffer
+    TAKErr code = drawTile(pending.drawables, drawable, sceneModel, x, y, tileSize, depth, ids, nullptr);
+    if (code == TE_Ok)
+        readProjection(pending.sample.proj);
     this->endProj();
 
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    if (code != TE_Ok) {
+        pbos_.push_back(pending.pbo);
+        return code;
+    }
+
+    pending.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pending_samples_.push_back(std::move(pending));
     return code;
 }
 
+void GLDepthSampler::processPendingSamples(bool wait) NOTHROWS {
+    // samples complete in the order they were issued
+    while (!pending_samples_.empty()) {
+        GLsync fence = pending_samples_.front().fence;
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000u : 0u);
+        } while (wait && status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_TIMEOUT_EXPIRED)
+            break;
+
+        // the callback may issue new requests
+        PendingSample pending(std::move(pending_samples_.front()));
+        pending_samples_.erase(pending_samples_.begin());
+        deliver(pending, (status == GL_WAIT_FAILED) ? TE_Err : TE_Ok);
+    }
+}
+
+void GLDepthSampler::deliver(PendingSample &pending, TAKErr code) NOTHROWS {
+    if (code == TE_Ok) {
+        const std::size_t size = pending.sample.tileSize * pending.sample.tileSize * 4u * ((pending.depth ? 1u : 0u) + (pending.ids ? 1u : 0u));
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pending.pbo);
+        const auto *pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT));
+        if (pixels) {
+            decodeTile(pending.sample, pixels, pending.depth, pending.ids, pending.drawables);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            code = TE_Err;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    }
+
+    if (pending.fence)
+        glDeleteSync(pending.fence);
+    pending.fence = nullptr;
+    pbos_.push_back(pending.pbo);
+
+    pending.callback(pending.opaque, code, pending.sample);
+}
+
+std::size_t GLDepthSampler::getMaxTileSize() const NOTHROWS {
+    return tile_size_;
+}
+
+TAKErr GLDepthSampler::drawTile(std::vector<GLDepthSamplerDrawable*> &drawables, GLDepthSamplerDrawable& drawable,
+    const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y, std::size_t tileSize, bool depth, bool ids, uint8_t *dst) NOTHROWS {
+
+    if (!(tileSize & 0x1u) || tileSize > tile_size_)
+        return TE_InvalidArg;
+    if (!depth && !ids)
+        return TE_InvalidArg;
+
+    drawables.clear();
+
+    // all the way to the leaves
+    TAKErr code = drawable.gatherDepthSamplerDrawables(drawables, INT_MAX, sceneModel, x, y);
+    if (code != TE_Ok)
+        return code;
+
+    size_t drawableCount = drawables.size();
+
+    // Very unlikely, but check for it anyway
+    if (ids && drawableCount > (GLDepthSampler::MAX_DRAW_ID - 1))
+        return TE_Unsupported;
+
+    if (drawableCount == 0)
+        return TE_Done;
+
+    RenderState restore = RenderState_getCurrent();
+
+    this->begin(x, y, sceneModel);
+
+    const GLint tileX = fbo_->width / 2 - (GLint)(tileSize / 2u);
+    const GLint tileY = fbo_->height / 2 - (GLint)(tileSize / 2u);
+    const auto tileDim = (GLsizei)tileSize;
+
+    if (depth) {
+        glClearColor(1.0f, 0.0f, 0.0f, 0.0f);
+        this->enableEncodingState(this->cached_depth_program_);
+        for (size_t i = 0; i < drawableCount; ++i) {
+            drawables[i]->depthSamplerDraw(*this, sceneModel);
+        }
+        glReadPixels(tileX, tileY, tileDim, tileDim, GL_RGBA, GL_UNSIGNED_BYTE, dst);
+        dst += tileSize * tileSize * 4u;
+    }
+
+    if (ids) {
+        glClearColor(1.0f, 1.0f, 0.0f, 0.0f);
+        this->enableEncodingState(this->cached_id_program_);
+        for (size_t i = 0; i < drawableCount; ++i) {
+            // id 0 is reserved for "nothing"
+            setDrawId(static_cast<uint32_t>(i + 1));
+            drawables[i]->depthSamplerDraw(*this, sceneModel);
+        }
+        glReadPixels(tileX, tileY, tileDim, tileDim, GL_RGBA, GL_UNSIGNED_BYTE, dst);
+    }
+
+    this->end();
+
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    RenderState_makeCurrent(restore);
+
+    return code;
+}
+
+void GLDepthSampler::readProjection(TAK::Engine::Math::Matrix2 &proj) const NOTHROWS {
+    float mxf[16];
+    atakmap::renderer::GLES20FixedPipeline::getInstance()->readMatrix(atakmap::renderer::GLES20FixedPipeline::MM_GL_PROJECTION, mxf);
+    for (std::size_t i = 0u; i < 16u; i++)
+        proj.set(i % 4u, i / 4u, mxf[i]);
+}
+
 TAK::Engine::Util::TAKErr GLDepthSampler::performDoublePassDepthSample(
     double* resultZ,
     class GLDepthSamplerDrawable** resultDrawable,
@@ -442,6 +630,13 @@ TAK::Engine::Util::TAKErr GLDepthSampler::performSinglePassDepthSample(
 }
 
 TAKErr TAK::Engine::Renderer::GLDepthSampler_create(GLDepthSamplerPtr& resultOut, const TAK::Engine::Core::RenderContext& ctx, GLDepthSampler::Method method) NOTHROWS {
+    return GLDepthSampler_create(resultOut, ctx, method, DEFAULT_TILE_SIZE);
+}
+
+TAKErr TAK::Engine::Renderer::GLDepthSampler_create(GLDepthSamplerPtr& resultOut, const TAK::Engine::Core::RenderContext& ctx, GLDepthSampler::Method method, std::size_t maxTileSize) NOTHROWS {
+
+    if (!(maxTileSize & 0x1u))
+        return TE_InvalidArg;
 
     GLDepthSamplerPtr result(new (std::nothrow) GLDepthSampler(), Memory_deleter<GLDepthSampler>);
     if (!result)
@@ -484,20 +679,25 @@ TAKErr TAK::Engine::Renderer::GLDepthSampler_create(GLDepthSamplerPtr& resultOut
         opts.depthType = GL_UNSIGNED_INT;
     }
 
-    code = GLOffscreenFramebuffer_create(result->fbo_, VIEWPORT_WIDTH, VIEWPORT_HEIGHT, opts);
+    // the sample location is at the center; leave room for the tile on either side
+    const int viewportWidth = std::max(VIEWPORT_WIDTH, (int)maxTileSize + 1);
+    const int viewportHeight = std::max(VIEWPORT_HEIGHT, (int)maxTileSize + 1);
+
+    code = GLOffscreenFramebuffer_borrow(result->fbo_, ctx, viewportWidth, viewportHeight, opts);
     if (code != TE_Ok && opts.depthType != GL_NONE) {
 
         // attempt a 16-bit depth depth texture
         opts.depthFormat = GL_DEPTH_COMPONENT;
         opts.depthInternalFormat = GL_DEPTH_COMPONENT16;
         opts.depthType = GL_UNSIGNED_INT;
-        code = GLOffscreenFramebuffer_create(result->fbo_, VIEWPORT_WIDTH, VIEWPORT_HEIGHT, opts);
+        code = GLOffscreenFramebuffer_borrow(result->fbo_, ctx, viewportWidth, viewportHeight, opts);
     }
 
     if (code != TE_Ok)
         return code;
 
     result->method_ = method;
+    result->tile_size_ = maxTileSize;
 
     resultOut = std::move(result);
     return TE_Ok;
@@ -514,3 +714,39 @@ TAKErr GLDepthSamplerDrawable::gatherDepthSamplerDrawables(std::vector<GLDepthSa
 void GLDepthSamplerDrawable::depthSamplerDraw(GLDepthSampler& sampler, const TAK::Engine::Core::MapSceneModel2& sceneModel) NOTHROWS {
 
 }
+
+namespace {
+    double decodeDepth(const uint8_t *px) NOTHROWS {
+        const float r = px[0] / 255.f;
+        const float g = px[1] / 255.f;
+        const float b = px[2] / 255.f;
+        const float a = px[3] / 255.f;
+
+        return r + g * (1.f / 255.f) + b * (1.f / 65025.f) + a * (1.f / 16581375.f);
+    }
+
+    uint32_t decodeId(const uint8_t *px) NOTHROWS {
+        return (uint32_t)px[0] | ((uint32_t)px[1] << 8u) | ((uint32_t)px[2] << 16u) | ((uint32_t)px[3] << 24u);
+    }
+
+    void decodeTile(GLDepthSampler::Sample &sample, const uint8_t *pixels, const bool depth, const bool ids, const std::vector<GLDepthSamplerDrawable*> &drawables) NOTHROWS {
+        const std::size_t count = sample.tileSize * sample.tileSize;
+        sample.z.clear();
+        sample.drawables.clear();
+        if (depth) {
+            sample.z.reserve(count);
+            for (std::size_t i = 0u; i < count; i++) {
+                const double d = decodeDepth(pixels + (i * 4u));
+                sample.z.push_back((d < 1.0) ? (d * 2.0 - 1.0) : 1.0);
+            }
+            pixels += count * 4u;
+        }
+        if (ids) {
+            sample.drawables.reserve(count);
+            for (std::size_t i = 0u; i < count; i++) {
+                const uint32_t id = decodeId(pixels + (i * 4u));
+                sample.drawables.push_back((id > 0u && id <= drawables.size()) ? drawables[id - 1u] : nullptr);
+            }
+        }
+    }
+}
@@ -8,6 +8,7 @@
 
 #include <vector>
 #include "util/Error.h"
+#include "renderer/GL.h"
 #include "renderer/Shader.h"
 #include "core/RenderContext.h"
 #include "renderer/GLOffscreenFramebuffer.h"
@@ -52,6 +53,35 @@ namespace TAK {
                     MAX_DRAW_ID = 0x00ffffff // 24-bit (also works as mask)
                 };
 
+                /**
+                 * The result of sampling a tile of pixels centered on the
+                 * sample location. Pixels are in row-major order, starting
+                 * at the bottom-left.
+                 */
+                struct Sample
+                {
+                    /** the tile dimension, in pixels */
+                    std::size_t tileSize;
+                    /** clip space Z per pixel, `1.0` where nothing was drawn; empty if not requested */
+                    std::vector<double> z;
+                    /** nearest drawable per pixel, `nullptr` where nothing was drawn; empty if not requested */
+                    std::vector<GLDepthSamplerDrawable *> drawables;
+                    /** the projection the sample was drawn with */
+                    TAK::Engine::Math::Matrix2 proj;
+                };
+
+                /**
+                 * Receives the result of an asynchronous sample on the GL
+                 * thread.
+                 *
+                 * @param opaque    The opaque pointer supplied with the request
+                 * @param code      `TE_Ok` on success, `TE_Done` if there was
+                 *                  nothing to draw, `TE_Canceled` if the
+                 *                  sampler was destroyed first
+                 * @param sample    The sample
+                 */
+                typedef void (*SampleCallback)(void *opaque, const TAK::Engine::Util::TAKErr code, const Sample &sample);
+
                 /**
                  * Perform a depth sample draw procedure.
                  *
@@ -67,6 +97,58 @@ namespace TAK {
                 TAK::Engine::Util::TAKErr performDepthSample(double* resultZ, TAK::Engine::Math::Matrix2* proj, class GLDepthSamplerDrawable** resultDrawable,
                     GLDepthSamplerDrawable &drawable, const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y) NOTHROWS;
 
+                /**
+                 * Samples a tile of pixels centered on the specified
+                 * location in a single draw per pass.
+                 *
+                 * @param result    Returns the sample
+                 * @param drawable  the drawable to sample on
+                 * @param sceneModel    the desired scene model
+                 * @param x the x location in GL pixel space
+                 * @param y the y location in GL pixel space (bottom = 0)
+                 * @param tileSize  The tile dimension; must be odd and no
+                 *                  greater than `getMaxTileSize()`
+                 * @param depth     If `true`, samples depth
+                 * @param ids       If `true`, samples the nearest drawables
+                 *
+                 * @return TE_Ok on success, TE_Done if there was nothing to draw
+                 */
+                TAK::Engine::Util::TAKErr performDepthSample(Sample &result, GLDepthSamplerDrawable &drawable, const TAK::Engine::Core::MapSceneModel2& sceneModel,
+                    float x, float y, std::size_t tileSize, bool depth, bool ids) NOTHROWS;
+
+                /**
+                 * Issues a tile sample whose pixels are read back into a
+                 * pixel buffer behind a fence rather than stalling the
+                 * pipeline. The result is delivered by
+                 * `processPendingSamples()` once the GPU has completed,
+                 * typically one or two frames later.
+                 *
+                 * <P>Drawables are gathered when the sample is requested;
+                 * the caller must ensure that they remain valid until the
+                 * result is delivered, or only compare them by identity.
+                 *
+                 * @return TE_Ok if the sample was issued, TE_Done if there
+                 *         was nothing to draw; the callback is only invoked
+                 *         if the sample was issued
+                 */
+                TAK::Engine::Util::TAKErr requestDepthSample(SampleCallback callback, void *opaque, GLDepthSamplerDrawable &drawable, const TAK::Engine::Core::MapSceneModel2& sceneModel,
+                    float x, float y, std::size_t tileSize, bool depth, bool ids) NOTHROWS;
+
+                /**
+                 * Delivers the asynchronous samples whose readback has
+                 * completed. Must be invoked on the GL thread, typically once
+                 * per frame.
+                 *
+                 * @param wait  If `true`, blocks until all pending samples
+                 *              have been delivered
+                 */
+                void processPendingSamples(bool wait) NOTHROWS;
+
+                /**
+                 * Returns the maximum tile dimension that may be sampled.
+                 */
+                std::size_t getMaxTileSize() const NOTHROWS;
+
                 /**
                  * Get the sampling method
                  */
@@ -114,9 +196,21 @@ namespace TAK {
                     GLDepthSamplerDrawable& drawable,
                     const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y) NOTHROWS;
 
+                /**
+                 * Draws the depth and/or ID passes for a tile, reading each
+                 * back to `dst`, which is an offset into the bound pixel pack
+                 * buffer if one is bound. The depth pass is read to the
+                 * front, the ID pass follows it.
+                 */
+                TAK::Engine::Util::TAKErr drawTile(std::vector<GLDepthSamplerDrawable*> &drawables, GLDepthSamplerDrawable& drawable,
+                    const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y, std::size_t tileSize, bool depth, bool ids, uint8_t *dst) NOTHROWS;
+                void readProjection(TAK::Engine::Math::Matrix2 &proj) const NOTHROWS;
+
             private:
                 friend TAK::Engine::Util::TAKErr GLDepthSampler_create(std::unique_ptr<GLDepthSampler, void (*)(GLDepthSampler*)>& result, const TAK::Engine::Core::RenderContext& ctx,
                     Method method) NOTHROWS;
+                friend TAK::Engine::Util::TAKErr GLDepthSampler_create(std::unique_ptr<GLDepthSampler, void (*)(GLDepthSampler*)>& result, const TAK::Engine::Core::RenderContext& ctx,
+                    Method method, std::size_t maxTileSize) NOTHROWS;
 
             private:
                 void drawDepthToColor() NOTHROWS;
@@ -125,6 +219,22 @@ namespace TAK {
 
                 void enableEncodingState(const std::shared_ptr<const Shader2>& shader) NOTHROWS;
 
+            private:
+                struct PendingSample
+                {
+                    Sample sample;
+                    bool depth;
+                    bool ids;
+                    std::vector<GLDepthSamplerDrawable*> drawables;
+                    SampleCallback callback;
+                    void *opaque;
+                    GLuint pbo;
+#if TE_GLES_VERSION >= 3
+                    GLsync fence;
+#endif
+                };
+
+                void deliver(PendingSample &pending, TAK::Engine::Util::TAKErr code) NOTHROWS;
 
             private:
                 GLDepthSampler();
@@ -141,7 +251,12 @@ namespace TAK {
                 std::shared_ptr<const Shader2> cached_depth_program_;
                 std::shared_ptr<const Shader2> cached_fs_program_;
 
+                std::vector<PendingSample> pending_samples_;
+                /** pixel pack buffers available for reuse */
+                std::vector<GLuint> pbos_;
+
                 Method method_;
+                std::size_t tile_size_;
                 GLuint bound_fbo_;
                 int viewport_[4];
                 float x_;
@@ -157,6 +272,13 @@ namespace TAK {
             TAK::Engine::Util::TAKErr GLDepthSampler_create(GLDepthSamplerPtr &result, const TAK::Engine::Core::RenderContext &ctx,
                 GLDepthSampler::Method method) NOTHROWS;
 
+            /**
+             * Create a depth sampler with a given method that may sample
+             * tiles of up to `maxTileSize` pixels square
+             */
+            TAK::Engine::Util::TAKErr GLDepthSampler_create(GLDepthSamplerPtr &result, const TAK::Engine::Core::RenderContext &ctx,
+                GLDepthSampler::Method method, std::size_t maxTileSize) NOTHROWS;
+
             /**
              * Interface for any renderable that can contribute to the depth sampler process.
              */
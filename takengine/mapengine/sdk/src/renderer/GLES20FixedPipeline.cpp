@@ -5,6 +5,8 @@
 
 #include "renderer/GLES20FixedPipeline.h"
 #include "renderer/GL.h"
+#include "renderer/GLPerformanceCounters.h"
+#include "renderer/GLSLUtil.h"
 
 #include "core/AtakMapView.h"
 
@@ -662,6 +664,7 @@ namespace atakmap
             }
 
             ::glDrawArrays(mode, first, count);
+            TAK::Engine::Renderer::GLPerformanceCounters_draw(mode, count);
 
             glDisableVertexAttribArray(aVertexCoordsHandle);
             if (useColorPtr)
@@ -705,6 +708,7 @@ namespace atakmap
             CHECKERRS();
 
             ::glDrawElements(mode, count, type, indices);
+            TAK::Engine::Renderer::GLPerformanceCounters_draw(mode, count);
 
             glDisableVertexAttribArray(aVertexCoordsHandle);
             if (useColorPtr)
@@ -766,6 +770,7 @@ namespace atakmap
             CHECKERRS();
 
             ::glDrawArrays(mode, first, count);
+            TAK::Engine::Renderer::GLPerformanceCounters_draw(mode, count);
             CHECKERRS();
 
             glDisableVertexAttribArray(aVertexCoordsHandle);
@@ -817,6 +822,7 @@ namespace atakmap
             glEnableVertexAttribArray(aTextureCoordsHandle);
 
             ::glDrawElements(mode, count, type, indices);
+            TAK::Engine::Renderer::GLPerformanceCounters_draw(mode, count);
 
             glDisableVertexAttribArray(aVertexCoordsHandle);
             glDisableVertexAttribArray(aTextureCoordsHandle);
@@ -879,6 +885,7 @@ namespace atakmap
             }
 
             ::glDrawArrays(GL_POINTS, first, count);
+            TAK::Engine::Renderer::GLPerformanceCounters_draw(GL_POINTS, count);
             CHECKERRS();
 
             glDisableVertexAttribArray(aVertexCoordsHandle);
@@ -934,6 +941,7 @@ namespace atakmap
             }
 
             ::glDrawElements(GL_POINTS, count, type, indices);
+            TAK::Engine::Renderer::GLPerformanceCounters_draw(GL_POINTS, count);
 
             glDisableVertexAttribArray(aVertexCoordsHandle);
             if (texCoordPointer.enabled) {
@@ -1115,23 +1123,13 @@ namespace atakmap
 
         bool Program::create(const char *vertSrc, const char *fragSrc)
         {
-            vertShader = loadShader(vertSrc, GL_VERTEX_SHADER);
-            if (vertShader == GL_FALSE)
+            // shared with the program cache
+            TAK::Engine::Renderer::ShaderProgram p;
+            if (TAK::Engine::Renderer::GLSLUtil_createProgram(&p, vertSrc, fragSrc) != TAK::Engine::Util::TE_Ok)
                 return false;
-            fragShader = loadShader(fragSrc, GL_FRAGMENT_SHADER);
-            if (fragShader == GL_FALSE) {
-                glDeleteShader(vertShader);
-                vertShader = GL_FALSE;
-                return false;
-            }
-
-            program = createProgram();
-            if (program == GL_FALSE) {
-                glDeleteShader(fragShader);
-                glDeleteShader(vertShader);
-                fragShader = vertShader = GL_FALSE;
-                return false;
-            }
+            program = p.program;
+            vertShader = p.vertShader;
+            fragShader = p.fragShader;
             return true;
         }
 
@@ -5,6 +5,7 @@
 #include <cstdlib>
 
 #include "renderer/GL.h"
+#include "renderer/GLPerformanceCounters.h"
 
 
 using namespace atakmap::renderer;
@@ -183,6 +184,7 @@ namespace
 
     void flush(const size_t numSegments, const uint16_t *idxBuffer) {
         glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(numSegments * 6), GL_UNSIGNED_SHORT, idxBuffer);
+        TAK::Engine::Renderer::GLPerformanceCounters_draw(GL_TRIANGLES, numSegments * 6);
     }
 
     void vertex(uint8_t *vertices, const void *p0, const void *p1, const size_t vertexCoordSize, const float dir)
@@ -1,20 +1,136 @@
 #include "renderer/GLMegaTexture.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <set>
+
+#include "renderer/GLSLUtil.h"
+#include "renderer/GLWorkers.h"
+#include "renderer/RenderState.h"
+#include "util/Memory.h"
+#include "util/PerformanceCounters.h"
+#include "util/Tasking.h"
 
 #define MT_POOL_LIMIT (2u*1024u*1024u)
+// the feedback target is reduced by this factor relative to the viewport
+#define MT_FEEDBACK_SUBSAMPLE 8u
 
 using namespace TAK::Engine::Renderer;
 
+using namespace TAK::Engine::Raster::TileReader;
 using namespace TAK::Engine::Util;
 
+struct GLMegaTexture::Streaming
+{
+    Streaming(const std::shared_ptr<TileReader2> &source, const std::shared_ptr<PageCache> &cache) NOTHROWS;
+    ~Streaming() NOTHROWS;
+
+    std::shared_ptr<TileReader2> source;
+    std::shared_ptr<PageCache> cache;
+    int64_t sourceWidth {0};
+    int64_t sourceHeight {0};
+    std::size_t numLevels {0u};
+    /** tile index to page cache slot */
+    std::map<TileIndex, std::size_t, TileIndexComp> resident;
+    std::set<TileIndex, TileIndexComp> requested;
+    std::set<TileIndex, TileIndexComp> loading;
+    /** tiles that could not be read */
+    std::set<TileIndex, TileIndexComp> failed;
+    /** value of the cache frame at the last update */
+    int64_t frame {-1};
+    struct
+    {
+        GLOffscreenFramebufferPtr fbo {nullptr, nullptr};
+        GLuint pbo {GL_NONE};
+#if TE_GLES_VERSION >= 3
+        GLsync fence {nullptr};
+#endif
+        ShaderProgram program {0, 0, 0};
+        FeedbackShader shader;
+        GLint uSize {-1};
+        GLint uLevels {-1};
+        GLint uTileSize {-1};
+        GLint uBias {-1};
+        // state to restore on `endFeedback`
+        GLint boundFbo {0};
+        GLint viewport[4];
+        GLint boundProgram {0};
+        std::unique_ptr<RenderState> restore;
+    } feedback;
+};
+
+namespace
+{
+    struct PageRead
+    {
+        GLMegaTexture::TileIndex index;
+        int64_t srcX;
+        int64_t srcY;
+        int64_t srcW;
+        int64_t srcH;
+        std::size_t dstW;
+        std::size_t dstH;
+        std::size_t tileSize;
+        bool hasAlpha;
+    };
+
+    const char *FEEDBACK_VERT_SHADER_SRC =
+        "#version 300 es\n"
+        "uniform mat4 uMVP;\n"
+        "in vec3 aVertexCoords;\n"
+        "in vec2 aTexCoords;\n"
+        "out vec2 vTexCoord;\n"
+        "void main() {\n"
+        "  vTexCoord = aTexCoords;\n"
+        "  gl_Position = uMVP * vec4(aVertexCoords.xyz, 1.0);\n"
+        "}";
+    // emits `(level + 1, column, row)` of the sampled tile; the clear value
+    // of `0` indicates no sample
+    const char *FEEDBACK_FRAG_SHADER_SRC =
+        "#version 300 es\n"
+        "precision highp float;\n"
+        "uniform vec2 uSize;\n"
+        "uniform float uLevels;\n"
+        "uniform float uTileSize;\n"
+        "uniform float uBias;\n"
+        "in vec2 vTexCoord;\n"
+        "layout(location = 0) out uvec4 vFragColor;\n"
+        "void main() {\n"
+        "  vec2 px = vTexCoord * uSize;\n"
+        "  float lod = log2(max(max(length(dFdx(px)), length(dFdy(px))), 1e-6)) - uBias;\n"
+        "  float level = clamp(uLevels - 1.0 - floor(max(lod, 0.0)), 0.0, uLevels - 1.0);\n"
+        "  float span = uTileSize * exp2(uLevels - 1.0 - level);\n"
+        "  vec2 tile = floor(clamp(vTexCoord, 0.0, 1.0) * uSize / span);\n"
+        "  tile = min(tile, ceil(uSize / span) - 1.0);\n"
+        "  vFragColor = uvec4(uint(level) + 1u, uint(tile.x), uint(tile.y), 1u);\n"
+        "}";
+
+    TAKErr readPage(std::shared_ptr<Bitmap2> &value, const std::shared_ptr<TileReader2> &source, const PageRead &page) NOTHROWS;
+    void initFormat(GLenum *format, GLenum *type, const bool hasAlpha) NOTHROWS;
+}
+
 GLMegaTexture::GLMegaTexture(const std::size_t width_, const std::size_t height_, const std::size_t tileSize_, const bool hasAlpha_) NOTHROWS :
+    tileSize(tileSize_),
     width(width_),
     height(height_),
-    tileSize(tileSize_),
     hasAlpha(hasAlpha_),
     shareWith(nullptr)
 {}
+GLMegaTexture::GLMegaTexture(const std::shared_ptr<TileReader2> &source, const std::shared_ptr<PageCache> &cache) NOTHROWS :
+    tileSize(cache ? cache->getTileSize() : 0u),
+    width(0u),
+    height(0u),
+    hasAlpha(cache ? cache->hasAlpha() : false),
+    shareWith(nullptr),
+    streaming(std::make_shared<Streaming>(source, cache))
+{
+    if (tileSize) {
+        width = tileSize << (streaming->numLevels - 1u);
+        height = width;
+    }
+}
 GLMegaTexture::~GLMegaTexture() NOTHROWS
 {}
 std::size_t GLMegaTexture::getWidth() const NOTHROWS
@@ -29,8 +145,16 @@ std::size_t GLMegaTexture::getTileSize() const NOTHROWS
 {
     return tileSize;
 }
+std::size_t GLMegaTexture::getNumLevels() const NOTHROWS
+{
+    if (streaming)
+        return streaming->numLevels;
+    return GLMegaTexture_getNumLevels((int64_t)width, (int64_t)height, tileSize);
+}
 std::size_t GLMegaTexture::getTileSize(const TileIndex &key) const NOTHROWS
 {
+    if (streaming)
+        return tileSize;
     auto entry = tiles.find(key);
     if (entry == tiles.end())
         return tileSize;
@@ -47,6 +171,10 @@ GLuint GLMegaTexture::getTile(const std::size_t level, const std::size_t column,
 }
 GLuint GLMegaTexture::getTile(const TileIndex &key) const NOTHROWS
 {
+    if (streaming) {
+        auto page = streaming->resident.find(key);
+        return (page != streaming->resident.end()) ? streaming->cache->pages[page->second].texture : GL_NONE;
+    }
     auto entry = tiles.find(key);
     if (entry == tiles.end())
         return GL_NONE;
@@ -55,10 +183,18 @@ GLuint GLMegaTexture::getTile(const TileIndex &key) const NOTHROWS
 }
 std::size_t GLMegaTexture::getNumAvailableTiles() const NOTHROWS
 {
-    return tiles.size();
+    return streaming ? streaming->resident.size() : tiles.size();
 }
 TAKErr GLMegaTexture::getAvailableTiles(TileIndex* value, const std::size_t size) const NOTHROWS
 {
+    if (streaming) {
+        if (size < streaming->resident.size())
+            return TE_InvalidArg;
+        std::size_t idx = 0;
+        for (auto it = streaming->resident.begin(); it != streaming->resident.end(); it++)
+            value[idx++] = it->first;
+        return TE_Ok;
+    }
     if (size < tiles.size())
         return TE_InvalidArg;
     std::size_t idx = 0;
@@ -76,6 +212,9 @@ TAKErr GLMegaTexture::bindTile(const std::size_t level, const std::size_t column
 }
 TAKErr GLMegaTexture::bindTile(const TileIndex &key, const std::size_t mip) NOTHROWS
 {
+    // streaming tiles are read from the source
+    if (streaming)
+        return TE_IllegalState;
     auto entry = tiles.find(key);
     if (entry != tiles.end()) {
         do {
@@ -130,6 +269,14 @@ TAKErr GLMegaTexture::bindTile(const TileIndex &key, const std::size_t mip) NOTH
 }
 void GLMegaTexture::clear() NOTHROWS
 {
+    if (streaming) {
+        for (auto it = streaming->resident.begin(); it != streaming->resident.end(); it++)
+            streaming->cache->evict(it->second);
+        streaming->resident.clear();
+        streaming->requested.clear();
+        streaming->failed.clear();
+        return;
+    }
     if(tiles.empty())
         return;
     if (pool.capacity() < tiles.size())
@@ -141,6 +288,28 @@ void GLMegaTexture::clear() NOTHROWS
 }
 void GLMegaTexture::release() NOTHROWS
 {
+    if (streaming) {
+        clear();
+#if TE_GLES_VERSION >= 3
+        if (streaming->feedback.fence) {
+            glDeleteSync(streaming->feedback.fence);
+            streaming->feedback.fence = nullptr;
+        }
+#endif
+        if (streaming->feedback.pbo) {
+            glDeleteBuffers(1u, &streaming->feedback.pbo);
+            streaming->feedback.pbo = GL_NONE;
+        }
+        streaming->feedback.fbo.reset();
+        if (streaming->feedback.program.program) {
+            glDeleteProgram(streaming->feedback.program.program);
+            glDeleteShader(streaming->feedback.program.vertShader);
+            glDeleteShader(streaming->feedback.program.fragShader);
+            streaming->feedback.program = ShaderProgram{0, 0, 0};
+            streaming->feedback.shader = FeedbackShader();
+        }
+        return;
+    }
     for (auto it = tiles.begin(); it != tiles.end(); it++)
         releaseTile(it->first, false);
     tiles.clear();
@@ -150,6 +319,9 @@ void GLMegaTexture::release() NOTHROWS
 }
 TAKErr GLMegaTexture::shareTile(GLMegaTexture &other, const TileIndex& tile) NOTHROWS
 {
+    // streaming pages are shared via the page cache
+    if (streaming || other.streaming)
+        return TE_IllegalState;
     // get the tile
     const auto entry = tiles.find(tile);
     // if the tile isn't available, we can't share
@@ -190,6 +362,8 @@ TAKErr GLMegaTexture::shareTile(GLMegaTexture &other, const TileIndex& tile) NOT
 }
 TAKErr GLMegaTexture::transferTile(GLMegaTexture &other, const TileIndex& tile) NOTHROWS
 {
+    if (streaming || other.streaming)
+        return TE_IllegalState;
     // get the tile
     const auto entry = tiles.find(tile);
     // if the tile isn't available, we can't transfer
@@ -216,6 +390,8 @@ TAKErr GLMegaTexture::transferTile(GLMegaTexture &other, const TileIndex& tile)
 TAKErr GLMegaTexture::compressTile(const TileIndex &tile, const std::size_t mip) NOTHROWS
 {
     TAKErr code(TE_Ok);
+    if (streaming)
+        return TE_IllegalState;
     // get the tile
     const auto entry = tiles.find(tile);
     // if the tile isn't available, we can't compress
@@ -259,6 +435,14 @@ TAKErr GLMegaTexture::compressTile(const TileIndex &tile, const std::size_t mip)
 }
 void GLMegaTexture::releaseTile(const TileIndex& tile, const bool sendToPool) NOTHROWS
 {
+    if (streaming) {
+        auto page = streaming->resident.find(tile);
+        if (page == streaming->resident.end())
+            return;
+        streaming->cache->evict(page->second);
+        streaming->resident.erase(page);
+        return;
+    }
     auto entry = tiles.find(tile);
     if (entry == tiles.end())
         return;
@@ -287,6 +471,364 @@ void GLMegaTexture::releaseTile(const TileIndex& tile, const bool sendToPool) NO
     tiles.erase(entry);
 }
 
+bool GLMegaTexture::isStreaming() const NOTHROWS
+{
+    return !!streaming;
+}
+void GLMegaTexture::requestTile(const TileIndex &tile) NOTHROWS
+{
+    if (streaming && tile.level < streaming->numLevels)
+        streaming->requested.insert(tile);
+}
+TAKErr GLMegaTexture::getResidentTile(TileIndex *value, const TileIndex &tile) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    TileIndex key(tile);
+    do {
+        if (getTile(key)) {
+            *value = key;
+            return TE_Ok;
+        }
+        if (!key.level)
+            break;
+        key.level--;
+        key.column >>= 1u;
+        key.row >>= 1u;
+    } while (true);
+    return TE_Done;
+}
+bool GLMegaTexture::isLoading() const NOTHROWS
+{
+    return streaming && !streaming->loading.empty();
+}
+TAKErr GLMegaTexture::beginFeedback(FeedbackShader *value, const TAK::Engine::Core::RenderContext &ctx, const std::size_t viewportWidth, const std::size_t viewportHeight) NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    TAKErr code(TE_Ok);
+    if (!streaming)
+        return TE_IllegalState;
+    if (!value || !viewportWidth || !viewportHeight)
+        return TE_InvalidArg;
+    auto &feedback = streaming->feedback;
+    if (feedback.fence || feedback.restore)
+        return TE_Busy;
+
+    if (!feedback.program.program) {
+        code = GLSLUtil_createProgram(&feedback.program, FEEDBACK_VERT_SHADER_SRC, FEEDBACK_FRAG_SHADER_SRC);
+        TE_CHECKRETURN_CODE(code);
+        feedback.shader.handle = (GLuint)feedback.program.program;
+        feedback.shader.uMVP = glGetUniformLocation(feedback.shader.handle, "uMVP");
+        feedback.shader.aVertexCoords = glGetAttribLocation(feedback.shader.handle, "aVertexCoords");
+        feedback.shader.aTexCoords = glGetAttribLocation(feedback.shader.handle, "aTexCoords");
+        feedback.uSize = glGetUniformLocation(feedback.shader.handle, "uSize");
+        feedback.uLevels = glGetUniformLocation(feedback.shader.handle, "uLevels");
+        feedback.uTileSize = glGetUniformLocation(feedback.shader.handle, "uTileSize");
+        feedback.uBias = glGetUniformLocation(feedback.shader.handle, "uBias");
+    }
+
+    const std::size_t w = std::max(viewportWidth / MT_FEEDBACK_SUBSAMPLE, (std::size_t)1u);
+    const std::size_t h = std::max(viewportHeight / MT_FEEDBACK_SUBSAMPLE, (std::size_t)1u);
+    if (!feedback.fbo || feedback.fbo->width != (int)w || feedback.fbo->height != (int)h) {
+        GLOffscreenFramebuffer::Options opts;
+        opts.colorFormat = GL_RGBA_INTEGER;
+        opts.colorInternalFormat = GL_RGBA16UI;
+        opts.colorType = GL_UNSIGNED_SHORT;
+        opts.depthFormat = GL_DEPTH_COMPONENT;
+        opts.depthInternalFormat = GL_DEPTH_COMPONENT16;
+        opts.depthType = GL_UNSIGNED_SHORT;
+        feedback.fbo.reset();
+        code = GLOffscreenFramebuffer_borrow(feedback.fbo, ctx, (int)w, (int)h, opts);
+        TE_CHECKRETURN_CODE(code);
+
+        if (!feedback.pbo)
+            glGenBuffers(1u, &feedback.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, feedback.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)(w*h*4u*sizeof(GLuint)), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    }
+
+    feedback.restore.reset(new RenderState(RenderState_getCurrent()));
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &feedback.boundFbo);
+    glGetIntegerv(GL_VIEWPORT, feedback.viewport);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &feedback.boundProgram);
+
+    // integer color buffers may not be cleared with `glClear`
+    feedback.fbo->bind(false);
+    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
+    const GLuint clearColor[4u] = { 0u, 0u, 0u, 0u };
+    glClearBufferuiv(GL_COLOR, 0, clearColor);
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDisable(GL_BLEND);
+
+    glUseProgram(feedback.shader.handle);
+    glUniform2f(feedback.uSize, (float)width, (float)height);
+    glUniform1f(feedback.uLevels, (float)streaming->numLevels);
+    glUniform1f(feedback.uTileSize, (float)tileSize);
+    // derivatives are taken at the reduced resolution
+    glUniform1f(feedback.uBias, (float)log2((double)viewportWidth / (double)w));
+
+    *value = feedback.shader;
+    return code;
+#else
+    return TE_Unsupported;
+#endif
+}
+void GLMegaTexture::endFeedback() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    if (!streaming || !streaming->feedback.restore)
+        return;
+    auto &feedback = streaming->feedback;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedback.pbo);
+    glReadPixels(0, 0, (GLsizei)feedback.fbo->width, (GLsizei)feedback.fbo->height, GL_RGBA_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    feedback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, feedback.boundFbo);
+    glViewport(feedback.viewport[0], feedback.viewport[1], feedback.viewport[2], feedback.viewport[3]);
+    glUseProgram(feedback.boundProgram);
+    RenderState_makeCurrent(*feedback.restore);
+    feedback.restore.reset();
+#endif
+}
+TAKErr GLMegaTexture::update(const std::size_t limit) NOTHROWS
+{
+    if (!streaming)
+        return TE_IllegalState;
+    PageCache &cache = *streaming->cache;
+    cache.beginUpdate(*streaming);
+
+#if TE_GLES_VERSION >= 3
+    // collect the feedback, if complete
+    auto &feedback = streaming->feedback;
+    if (feedback.fence) {
+        const GLenum status = glClientWaitSync(feedback.fence, 0, 0u);
+        if (status != GL_TIMEOUT_EXPIRED) {
+            glDeleteSync(feedback.fence);
+            feedback.fence = nullptr;
+        }
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            const auto numPixels = (std::size_t)(feedback.fbo->width*feedback.fbo->height);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, feedback.pbo);
+            const auto *px = static_cast<const GLuint *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)(numPixels*4u*sizeof(GLuint)), GL_MAP_READ_BIT));
+            if (px) {
+                TileIndex last{ (std::size_t)-1, 0u, 0u };
+                for (std::size_t i = 0u; i < numPixels; i++, px += 4u) {
+                    if (!px[0])
+                        continue;
+                    const TileIndex key{ (std::size_t)(px[0] - 1u), (std::size_t)px[1], (std::size_t)px[2] };
+                    // neighboring samples are usually from the same tile
+                    if (key.level == last.level && key.column == last.column && key.row == last.row)
+                        continue;
+                    requestTile(key);
+                    last = key;
+                }
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+        }
+    }
+#endif
+
+    // retain the ancestors as fallbacks
+    std::set<TileIndex, TileIndexComp> wanted;
+    for (auto it = streaming->requested.begin(); it != streaming->requested.end(); it++) {
+        TileIndex key(*it);
+        while (wanted.insert(key).second && key.level) {
+            key.level--;
+            key.column >>= 1u;
+            key.row >>= 1u;
+        }
+    }
+    streaming->requested.clear();
+
+    // coarsest first, per the index ordering
+    std::size_t issued = 0u;
+    for (auto it = wanted.begin(); it != wanted.end(); it++) {
+        auto page = streaming->resident.find(*it);
+        if (page != streaming->resident.end()) {
+            cache.touch(page->second);
+            continue;
+        }
+        if (issued >= limit || streaming->loading.find(*it) != streaming->loading.end() || streaming->failed.find(*it) != streaming->failed.end())
+            continue;
+
+        PageRead read;
+        read.index = *it;
+        read.tileSize = tileSize;
+        read.hasAlpha = hasAlpha;
+        const int64_t scale = (int64_t)1 << (streaming->numLevels - 1u - it->level);
+        const int64_t span = (int64_t)tileSize*scale;
+        read.srcX = (int64_t)it->column*span;
+        read.srcY = (int64_t)it->row*span;
+        if (read.srcX >= streaming->sourceWidth || read.srcY >= streaming->sourceHeight)
+            continue;
+        read.srcW = std::min(span, streaming->sourceWidth - read.srcX);
+        read.srcH = std::min(span, streaming->sourceHeight - read.srcY);
+        read.dstW = (std::size_t)((read.srcW + scale - 1) / scale);
+        read.dstH = (std::size_t)((read.srcH + scale - 1) / scale);
+
+        streaming->loading.insert(*it);
+        Task_begin(GeneralWorkers_cpu(), readPage, streaming->source, read)
+            .thenOn(GLWorkers_glThread(), uploadPage, std::weak_ptr<Streaming>(streaming), *it);
+        issued++;
+    }
+
+    return TE_Ok;
+}
+
+GLMegaTexture::Streaming::Streaming(const std::shared_ptr<TileReader2> &source_, const std::shared_ptr<PageCache> &cache_) NOTHROWS :
+    source(source_),
+    cache(cache_)
+{
+    numLevels = 1u;
+    if (!source || !cache || !cache->getTileSize())
+        return;
+    if (source->getWidth(&sourceWidth) != TE_Ok || source->getHeight(&sourceHeight) != TE_Ok)
+        return;
+    numLevels = GLMegaTexture_getNumLevels(sourceWidth, sourceHeight, cache->getTileSize());
+}
+GLMegaTexture::Streaming::~Streaming() NOTHROWS
+{
+    // return the pages; textures are retained by the cache
+    if (cache) {
+        for (auto it = resident.begin(); it != resident.end(); it++)
+            cache->evict(it->second);
+    }
+}
+
+GLMegaTexture::PageCache::PageCache(const std::size_t tileSize_, const bool hasAlpha_, const std::size_t capacity_) NOTHROWS :
+    tileSize(tileSize_),
+    alpha(hasAlpha_),
+    capacity(capacity_),
+    frame(0LL)
+{}
+GLMegaTexture::PageCache::~PageCache() NOTHROWS
+{}
+std::size_t GLMegaTexture::PageCache::getTileSize() const NOTHROWS
+{
+    return tileSize;
+}
+bool GLMegaTexture::PageCache::hasAlpha() const NOTHROWS
+{
+    return alpha;
+}
+std::size_t GLMegaTexture::PageCache::getCapacity() const NOTHROWS
+{
+    return capacity;
+}
+std::size_t GLMegaTexture::PageCache::getNumResidentPages() const NOTHROWS
+{
+    std::size_t n = 0u;
+    for (auto it = pages.begin(); it != pages.end(); it++)
+        if (it->owner)
+            n++;
+    return n;
+}
+void GLMegaTexture::PageCache::release() NOTHROWS
+{
+    for (std::size_t i = 0u; i < pages.size(); i++) {
+        if (pages[i].owner)
+            pages[i].owner->resident.erase(pages[i].index);
+        glDeleteTextures(1u, &pages[i].texture);
+    }
+    pages.clear();
+}
+TAKErr GLMegaTexture::PageCache::acquire(std::size_t *slot, Streaming &owner, const TileIndex &index) NOTHROWS
+{
+    if (pages.size() < capacity) {
+        Page page;
+        glGenTextures(1u, &page.texture);
+        if (!page.texture)
+            return TE_OutOfMemory;
+        GLenum format;
+        GLenum type;
+        initFormat(&format, &type, alpha);
+        glBindTexture(GL_TEXTURE_2D, page.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, (GLsizei)tileSize, (GLsizei)tileSize, 0, format, type, nullptr);
+        glBindTexture(GL_TEXTURE_2D, GL_NONE);
+        pages.push_back(page);
+        *slot = pages.size() - 1u;
+    } else {
+        // least recently requested; pages requested this frame are in use
+        std::size_t lru = pages.size();
+        for (std::size_t i = 0u; i < pages.size(); i++) {
+            if (pages[i].owner && pages[i].lastRequested >= frame)
+                continue;
+            if (lru == pages.size() || !pages[i].owner ||
+                (pages[lru].owner && pages[i].lastRequested < pages[lru].lastRequested)) {
+                lru = i;
+                if (!pages[i].owner)
+                    break;
+            }
+        }
+        if (lru == pages.size())
+            return TE_Busy;
+        if (pages[lru].owner)
+            pages[lru].owner->resident.erase(pages[lru].index);
+        *slot = lru;
+    }
+    pages[*slot].owner = &owner;
+    pages[*slot].index = index;
+    pages[*slot].lastRequested = frame;
+    return TE_Ok;
+}
+void GLMegaTexture::PageCache::touch(const std::size_t slot) NOTHROWS
+{
+    pages[slot].lastRequested = frame;
+}
+void GLMegaTexture::PageCache::evict(const std::size_t slot) NOTHROWS
+{
+    pages[slot].owner = nullptr;
+    pages[slot].lastRequested = -1LL;
+}
+void GLMegaTexture::PageCache::beginUpdate(Streaming &owner) NOTHROWS
+{
+    if (owner.frame == frame)
+        frame++;
+    owner.frame = frame;
+}
+
+TAKErr GLMegaTexture::uploadPage(bool &value, std::shared_ptr<Bitmap2> &bitmap, const std::weak_ptr<Streaming> &weak, const TileIndex &index) NOTHROWS
+{
+    value = false;
+    std::shared_ptr<Streaming> streaming(weak.lock());
+    if (!streaming)
+        return TE_Ok;
+    streaming->loading.erase(index);
+    if (!bitmap) {
+        streaming->failed.insert(index);
+        return TE_Ok;
+    }
+
+    std::size_t slot;
+    // the cache is exhausted by tiles in use; the tile will be requested again
+    if (streaming->cache->acquire(&slot, *streaming, index) != TE_Ok)
+        return TE_Ok;
+
+    GLenum format;
+    GLenum type;
+    initFormat(&format, &type, streaming->cache->hasAlpha());
+    glBindTexture(GL_TEXTURE_2D, streaming->cache->pages[slot].texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)bitmap->getWidth(), (GLsizei)bitmap->getHeight(), format, type, bitmap->getData());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    PerformanceCounters_add(TEPC_TextureUploadBytes, bitmap->getStride()*bitmap->getHeight());
+    glBindTexture(GL_TEXTURE_2D, GL_NONE);
+
+    streaming->resident[index] = slot;
+    value = true;
+    return TE_Ok;
+}
 bool GLMegaTexture::TileIndexComp::operator()(const TileIndex& a, const TileIndex& b) const
 {
     if (a.level < b.level)
@@ -304,3 +846,82 @@ bool GLMegaTexture::TileIndexComp::operator()(const TileIndex& a, const TileInde
     else
         return false;
 }
+
+std::size_t TAK::Engine::Renderer::GLMegaTexture_getNumLevels(const int64_t width, const int64_t height, const std::size_t tileSize) NOTHROWS
+{
+    std::size_t numLevels = 1u;
+    if (!tileSize)
+        return numLevels;
+    const int64_t extent = std::max(width, height);
+    while (((int64_t)tileSize << (numLevels - 1u)) < extent)
+        numLevels++;
+    return numLevels;
+}
+TAKErr TAK::Engine::Renderer::GLMegaTexture_getTileIndex(GLMegaTexture::TileIndex *value, const std::size_t numLevels, const std::size_t readerLevel, const int64_t column, const int64_t row) NOTHROWS
+{
+    if (!value || !numLevels || column < 0 || row < 0)
+        return TE_InvalidArg;
+    // reader levels coarser than the single tile level map onto it
+    const std::size_t shift = (readerLevel > (numLevels - 1u)) ? readerLevel - (numLevels - 1u) : 0u;
+    value->level = (numLevels - 1u) - (readerLevel - shift);
+    value->column = (std::size_t)column >> shift;
+    value->row = (std::size_t)row >> shift;
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Renderer::GLMegaTexture_getTexCoords(float *value, const GLMegaTexture::TileIndex &tile, const std::size_t numLevels, const std::size_t tileSize, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const std::size_t gridWidth, const std::size_t gridHeight) NOTHROWS
+{
+    if (!value || !tileSize || !gridWidth || !gridHeight || tile.level >= numLevels)
+        return TE_InvalidArg;
+    // source pixels spanned by the page
+    const int64_t span = (int64_t)tileSize << (numLevels - 1u - tile.level);
+    const int64_t originX = (int64_t)tile.column*span;
+    const int64_t originY = (int64_t)tile.row*span;
+    if (srcX < originX || srcY < originY || (srcX + srcW) > (originX + span) || (srcY + srcH) > (originY + span))
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i <= gridHeight; i++) {
+        const double y = (double)(srcY - originY) + ((double)srcH * (double)i) / (double)gridHeight;
+        for (std::size_t j = 0u; j <= gridWidth; j++) {
+            const double x = (double)(srcX - originX) + ((double)srcW * (double)j) / (double)gridWidth;
+            *value++ = (float)(x / (double)span);
+            *value++ = (float)(y / (double)span);
+        }
+    }
+    return TE_Ok;
+}
+
+namespace
+{
+    TAKErr readPage(std::shared_ptr<Bitmap2> &value, const std::shared_ptr<TileReader2> &source, const PageRead &page) NOTHROWS
+    {
+        // failures are delivered as an empty result so that the request
+        // is no longer considered in flight
+        Bitmap2::Format format;
+        std::size_t pixelSize;
+        if (source->getFormat(&format) != TE_Ok || Bitmap2_formatPixelSize(&pixelSize, format) != TE_Ok)
+            return TE_Ok;
+        Bitmap2 data(page.dstW, page.dstH, format);
+        if (source->read(data.getData(), page.srcX, page.srcY, page.srcW, page.srcH, page.dstW, page.dstH) != TE_Ok)
+            return TE_Ok;
+
+        // pad to the page size; the page texture is reused
+        const Bitmap2::Format pageFormat = page.hasAlpha ? Bitmap2::RGBA32 : Bitmap2::RGB565;
+        const Bitmap2 converted(data, pageFormat);
+        std::size_t pagePixelSize;
+        Bitmap2_formatPixelSize(&pagePixelSize, pageFormat);
+        value = std::make_shared<Bitmap2>(page.tileSize, page.tileSize, pageFormat);
+        memset(value->getData(), 0, value->getStride()*value->getHeight());
+        for (std::size_t y = 0u; y < page.dstH; y++)
+            memcpy(value->getData() + (y*value->getStride()), converted.getData() + (y*converted.getStride()), page.dstW*pagePixelSize);
+        return TE_Ok;
+    }
+    void initFormat(GLenum *format, GLenum *type, const bool hasAlpha) NOTHROWS
+    {
+        if (hasAlpha) {
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_BYTE;
+        } else {
+            *format = GL_RGB;
+            *type = GL_UNSIGNED_SHORT_5_6_5;
+        }
+    }
+}
@@ -2,8 +2,10 @@
 #define TAK_ENGINE_RENDERER_GLMEGATEXTURE_H_INCLUDED
 
 #include <map>
+#include <memory>
 #include <vector>
 
+#include "raster/tilereader/TileReader2.h"
 #include "renderer/GL.h"
 #include "renderer/GLOffscreenFramebuffer.h"
 #include "port/Platform.h"
@@ -21,6 +23,14 @@ namespace TAK {
              *   tile size.
              *   <LI>Level 0 corresponds to the lowest resolution level. The lowest resolution level is the level past which further subsampling would result in a tile that is less than the defined file size.
              * </UL>
+             *
+             * <P>Instances created from a `TileReader2` are streaming. Tiles
+             * are not drawn to, but read asynchronously from the source on
+             * request and stored in a fixed size `PageCache` that may be
+             * shared by any number of streaming instances. Requests are
+             * made explicitly via `requestTile` or by rendering the virtual
+             * texture coordinates of the drawn geometry in a feedback pass,
+             * and are serviced by `update`.
              */
             class ENGINE_API GLMegaTexture
             {
@@ -31,13 +41,40 @@ namespace TAK {
                     std::size_t column;
                     std::size_t row;
                 };
+                class PageCache;
+                /**
+                 * The feedback program. Geometry is drawn with its
+                 * position in `aVertexCoords`, transformed by `uMVP`, and
+                 * its virtual texture coordinate in `aTexCoords`, where
+                 * `(0, 0)` is the origin of the column and row `0` tile and
+                 * `(1, 1)` is the extent of the megatexture.
+                 */
+                struct FeedbackShader
+                {
+                    GLuint handle {GL_NONE};
+                    GLint uMVP {-1};
+                    GLint aVertexCoords {-1};
+                    GLint aTexCoords {-1};
+                };
             private :
                 struct TileIndexComp
                 {
                     bool operator()(const TileIndex& a, const TileIndex& b) const;
                 };
+                struct Streaming;
+            private :
+                static Util::TAKErr uploadPage(bool &value, std::shared_ptr<Bitmap2> &bitmap, const std::weak_ptr<Streaming> &streaming, const TileIndex &index) NOTHROWS;
             public :
                 GLMegaTexture(const std::size_t width, const std::size_t height, const std::size_t tileSize, const bool hasAlpha) NOTHROWS;
+                /**
+                 * Creates a streaming megatexture over the specified
+                 * source. The tile size and format are those of `cache`;
+                 * the dimensions are the source dimensions rounded up to a
+                 * power-of-two multiple of the tile size, so source pixel
+                 * `(x, y)` has virtual texture coordinate
+                 * `(x / getWidth(), y / getHeight())`.
+                 */
+                GLMegaTexture(const std::shared_ptr<TAK::Engine::Raster::TileReader::TileReader2> &source, const std::shared_ptr<PageCache> &cache) NOTHROWS;
                 ~GLMegaTexture() NOTHROWS;
             public :
                 /**
@@ -58,6 +95,11 @@ namespace TAK {
                  */
                 std::size_t getTileSize() const NOTHROWS;
                 std::size_t getTileSize(const TileIndex &idx) const NOTHROWS;
+                /**
+                 * Returns the number of levels; level `getNumLevels()-1`
+                 * is the full resolution level.
+                 */
+                std::size_t getNumLevels() const NOTHROWS;
                 /**
                  * Returns the texture ID for the specified tile.
                  * 
@@ -123,10 +165,74 @@ namespace TAK {
                 Util::TAKErr shareTile(GLMegaTexture &shareWith, const TileIndex &tile) NOTHROWS;
                 Util::TAKErr transferTile(GLMegaTexture &transferTo, const TileIndex &tile) NOTHROWS;
                 Util::TAKErr compressTile(const TileIndex &tile, const std::size_t mip) NOTHROWS;
+            public : // streaming
+                /**
+                 * Returns `true` if tiles are read from a source rather
+                 * than drawn to.
+                 */
+                bool isStreaming() const NOTHROWS;
+                /**
+                 * Requests that the specified tile be made available. The
+                 * request is serviced by the next call to `update`.
+                 */
+                void requestTile(const TileIndex &tile) NOTHROWS;
+                /**
+                 * Obtains the specified tile or, if it is not available,
+                 * its nearest available ancestor.
+                 *
+                 * @return  TE_Ok on success, TE_Done if neither the tile
+                 *          nor any ancestor is available
+                 */
+                Util::TAKErr getResidentTile(TileIndex *value, const TileIndex &tile) const NOTHROWS;
+                /**
+                 * Returns `true` if reads issued by `update` are
+                 * outstanding.
+                 */
+                bool isLoading() const NOTHROWS;
+                /**
+                 * Begins the feedback pass. The feedback target is bound
+                 * at reduced resolution and the feedback program is made
+                 * current; the caller draws the geometry textured by this
+                 * megatexture with `value` and invokes `endFeedback`. The
+                 * tiles sampled are requested once the results are read
+                 * back, a frame or more later.
+                 *
+                 * @param value             Returns the feedback program
+                 * @param ctx               The current render context
+                 * @param viewportWidth     The width of the viewport
+                 * @param viewportHeight    The height of the viewport
+                 *
+                 * @return  TE_Ok on success; TE_Busy if the previous
+                 *          feedback has not yet been read back;
+                 *          TE_IllegalState if not streaming
+                 */
+                Util::TAKErr beginFeedback(FeedbackShader *value, const TAK::Engine::Core::RenderContext &ctx, const std::size_t viewportWidth, const std::size_t viewportHeight) NOTHROWS;
+                /**
+                 * Ends the feedback pass, issues the readback and restores
+                 * the framebuffer, viewport, program and depth state.
+                 */
+                void endFeedback() NOTHROWS;
+                /**
+                 * Services the tile requests made since the last update.
+                 * Requested tiles that are available are retained in the
+                 * page cache; up to `limit` reads are issued for those
+                 * that are not, coarsest first. Tiles that fail to read
+                 * are not requested again until `clear`. Must be invoked
+                 * on the GL thread, once per frame.
+                 */
+                Util::TAKErr update(const std::size_t limit) NOTHROWS;
 
                 void getStats(std::size_t *tileStorage, std::size_t *sharedStorage, std::size_t *poolStorage, std::size_t *totalSharedStorage) NOTHROWS
                 {
                     const std::size_t pixelSize = (hasAlpha ? 4u : 2u);
+                    if(streaming) {
+                        // pages are accounted by the cache
+                        *tileStorage = getNumAvailableTiles()*(tileSize*tileSize)*pixelSize;
+                        *sharedStorage = 0u;
+                        *poolStorage = 0u;
+                        *totalSharedStorage = 0u;
+                        return;
+                    }
                     if(tiles.empty()) {
                         *tileStorage = 0;
                         *sharedStorage = 0;
@@ -189,7 +295,84 @@ namespace TAK {
                 std::vector<GLOffscreenFramebuffer> pool;
                 std::shared_ptr<std::map<GLuint, std::size_t>> sharedTiles;
                 const GLMegaTexture *shareWith;
+                std::shared_ptr<Streaming> streaming;
             };
+
+            /**
+             * A fixed number of tile textures shared by streaming
+             * megatextures with the same tile size and format. GPU memory
+             * is bounded by the capacity regardless of the number of
+             * megatextures. When full, the least recently requested tile
+             * not requested in the current frame is evicted. Must only be
+             * accessed on the GL thread.
+             */
+            class ENGINE_API GLMegaTexture::PageCache
+            {
+            private :
+                struct Page
+                {
+                    GLuint texture;
+                    GLMegaTexture::Streaming *owner;
+                    GLMegaTexture::TileIndex index;
+                    int64_t lastRequested;
+                };
+            public :
+                PageCache(const std::size_t tileSize, const bool hasAlpha, const std::size_t capacity) NOTHROWS;
+                ~PageCache() NOTHROWS;
+            public :
+                std::size_t getTileSize() const NOTHROWS;
+                bool hasAlpha() const NOTHROWS;
+                /** Returns the maximum number of pages */
+                std::size_t getCapacity() const NOTHROWS;
+                /** Returns the number of pages holding a tile */
+                std::size_t getNumResidentPages() const NOTHROWS;
+                /**
+                 * Evicts all tiles and deletes the page textures.
+                 */
+                void release() NOTHROWS;
+            private :
+                Util::TAKErr acquire(std::size_t *slot, GLMegaTexture::Streaming &owner, const GLMegaTexture::TileIndex &index) NOTHROWS;
+                void touch(const std::size_t slot) NOTHROWS;
+                void evict(const std::size_t slot) NOTHROWS;
+                /** advances the frame when `owner` updates a second time */
+                void beginUpdate(GLMegaTexture::Streaming &owner) NOTHROWS;
+            private :
+                std::size_t tileSize;
+                bool alpha;
+                std::size_t capacity;
+                std::vector<Page> pages;
+                int64_t frame;
+
+                friend class GLMegaTexture;
+            };
+
+            /**
+             * Returns the number of megatexture levels required for an
+             * image of the specified dimensions, such that the single
+             * level `0` tile covers the image.
+             */
+            ENGINE_API std::size_t GLMegaTexture_getNumLevels(const int64_t width, const int64_t height, const std::size_t tileSize) NOTHROWS;
+            /**
+             * Obtains the megatexture tile for the specified tile of a
+             * `TileReader2` with the same tile size. Reader level `0` is
+             * full resolution, where megatexture level `0` is the lowest
+             * resolution.
+             *
+             * @param numLevels The number of megatexture levels
+             */
+            ENGINE_API Util::TAKErr GLMegaTexture_getTileIndex(GLMegaTexture::TileIndex *value, const std::size_t numLevels, const std::size_t readerLevel, const int64_t column, const int64_t row) NOTHROWS;
+            /**
+             * Computes the texture coordinates within the page for `tile`
+             * of a `(gridWidth+1)*(gridHeight+1)` vertex grid, in row
+             * major order, over the source region `srcX, srcY, srcW,
+             * srcH`. The region must be contained by `tile`, which may be
+             * an ancestor of the tile that was requested.
+             *
+             * @param value     Returns the texture coordinates; must have
+             *                  capacity for `2*(gridWidth+1)*(gridHeight+1)`
+             *                  elements
+             */
+            ENGINE_API Util::TAKErr GLMegaTexture_getTexCoords(float *value, const GLMegaTexture::TileIndex &tile, const std::size_t numLevels, const std::size_t tileSize, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH, const std::size_t gridWidth, const std::size_t gridHeight) NOTHROWS;
         }
     }
 }
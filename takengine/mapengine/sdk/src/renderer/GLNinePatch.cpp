@@ -2,6 +2,7 @@
 #include "renderer/GLNinePatch.h"
 
 #include <cmath>
+#include <cstring>
 
 #include "renderer/GLES20FixedPipeline.h"
 #include "renderer/Bitmap.h"
@@ -17,6 +18,44 @@ namespace atakmap {
             const int NUM_VERTS_PER_CORNER = 8;
             const int NUM_VERTS_PER_PATCH = (NUM_VERTS_PER_CORNER * 4) + 1;
             const double RADIANS_PER_VERT = (M_PI / 2.0) / NUM_VERTS_PER_CORNER;
+            const int NUM_TEX_VERTS = 16;
+
+            /** unit offsets of the rounded corner vertices, computed once */
+            struct CornerArc
+            {
+                CornerArc() NOTHROWS
+                {
+                    for (int i = 0; i < (NUM_VERTS_PER_CORNER * 4); i++) {
+                        cosines[i] = (float)cos(RADIANS_PER_VERT*i);
+                        sines[i] = (float)sin(RADIANS_PER_VERT*i);
+                    }
+                }
+                float cosines[NUM_VERTS_PER_CORNER * 4];
+                float sines[NUM_VERTS_PER_CORNER * 4];
+            };
+            const CornerArc &getCornerArc() NOTHROWS
+            {
+                static CornerArc arc;
+                return arc;
+            }
+
+            std::size_t getGeometrySlot(const float width, const float height, const std::size_t numSlots) NOTHROWS
+            {
+                uint32_t w;
+                uint32_t h;
+                memcpy(&w, &width, sizeof(float));
+                memcpy(&h, &height, sizeof(float));
+                return ((w * 31u) ^ h) % numSlots;
+            }
+
+            void translateVerts(float *dst, const float *src, const int count, const float x, const float y, const float z) NOTHROWS
+            {
+                for (int i = 0; i < count; i++) {
+                    (*dst++) = (*src++) + x;
+                    (*dst++) = (*src++) + y;
+                    (*dst++) = (*src++) + z;
+                }
+            }
 
             const size_t TEX_INDICES_COUNT = 54;
             short TEX_INDICES[TEX_INDICES_COUNT] = {
@@ -1185,13 +1224,26 @@ namespace atakmap {
             delete[] tex_verts_;
             delete[] tex_coords_;
             delete[] triangle_verts_;
+            delete[] fan_cache_verts_;
+            delete[] tex_cache_verts_;
         }
 
         void GLNinePatch::commonInit(GLTextureAtlas2 *texAtlas,
                                      float width, float height,
                                      float x0, float y0, float x1, float y1)
         {
-            triangle_verts_ = new float[NUM_VERTS_PER_PATCH * 2];
+            triangle_verts_ = new float[NUM_VERTS_PER_PATCH * 3];
+
+            fan_cache_verts_ = new float[GEOMETRY_CACHE_SIZE * NUM_VERTS_PER_PATCH * 3];
+            tex_cache_verts_ = new float[GEOMETRY_CACHE_SIZE * NUM_TEX_VERTS * 3];
+            for (std::size_t i = 0u; i < GEOMETRY_CACHE_SIZE; i++) {
+                fan_cache_[i].width = -1;
+                fan_cache_[i].height = -1;
+                fan_cache_[i].verts = fan_cache_verts_ + (i * NUM_VERTS_PER_PATCH * 3);
+                tex_cache_[i].width = -1;
+                tex_cache_[i].height = -1;
+                tex_cache_[i].verts = tex_cache_verts_ + (i * NUM_TEX_VERTS * 3);
+            }
 
             last_triangle_x_ = -1;
             last_triangle_y_ = -1;
@@ -1377,18 +1429,17 @@ namespace atakmap {
         // Vertex computation
 
 
-        void GLNinePatch::buildPatchVerts(float *verts, int numVertsPerCorner,
-                                          float radius, double radiansPerVert,
-                                          float x, float y, float z, float width, float height)
+        void GLNinePatch::buildPatchVerts(float *verts, float radius, float width, float height)
         {
+            const CornerArc &arc = getCornerArc();
             float *pVerts = verts;
 
-            const int limit = (numVertsPerCorner * 4);
+            const int limit = (NUM_VERTS_PER_CORNER * 4);
             float tx = 0.0f;
             float ty = 0.0f;
             for (int i = 0; i < limit; i++) {
-                if ((i%numVertsPerCorner) == 0) {
-                    switch (i / numVertsPerCorner) {
+                if ((i%NUM_VERTS_PER_CORNER) == 0) {
+                    switch (i / NUM_VERTS_PER_CORNER) {
                     case 0:
                         tx = width - (radius*1.0f);
                         ty = height - (radius*1.0f);
@@ -1410,17 +1461,48 @@ namespace atakmap {
                         break;
                     }
                 }
-                (*pVerts++) = x + tx + (radius*(float)cos(radiansPerVert*i));
-                (*pVerts++) = y + ty + (radius*(float)sin(radiansPerVert*i));
-                (*pVerts++) = z;
+                (*pVerts++) = tx + (radius*arc.cosines[i]);
+                (*pVerts++) = ty + (radius*arc.sines[i]);
+                (*pVerts++) = 0.0f;
             }
 
             (*pVerts++) = verts[0];
             (*pVerts++) = verts[1];
-            (*pVerts++) = z;
+            (*pVerts++) = 0.0f;
 
         }
 
+        const float *GLNinePatch::getFanGeometry(float width, float height)
+        {
+            PatchGeometry &geom = fan_cache_[getGeometrySlot(width, height, GEOMETRY_CACHE_SIZE)];
+            if (geom.width != width || geom.height != height) {
+                buildPatchVerts(geom.verts, radius_, width, height);
+                geom.width = width;
+                geom.height = height;
+            }
+            return geom.verts;
+        }
+
+        const float *GLNinePatch::getTexGeometry(float width, float height)
+        {
+            PatchGeometry &geom = tex_cache_[getGeometrySlot(width, height, GEOMETRY_CACHE_SIZE)];
+            if (geom.width != width || geom.height != height) {
+                float scalingWidth = width - (x0_ + (texture_data_width_ - x1_));
+                float scalingHeight = height - (y0_ + (texture_data_height_ - y1_));
+
+                fillCoordsBuffer(3u,
+                    0.0f, 0.0f,
+                    x0_, y0_,
+                    x0_ + scalingWidth, y0_ + scalingHeight,
+                    width, height,
+                    0.0f,
+                    geom.verts);
+                geom.width = width;
+                geom.height = height;
+            }
+            return geom.verts;
+        }
+
         
         void GLNinePatch::fillCoordsBuffer(const std::size_t size,
                                            float texPatchCol0, float texPatchRow0,
@@ -1471,16 +1553,7 @@ namespace atakmap {
                 last_texture_width_ != width ||
                 last_texture_height_ != height) {
 
-                float scalingWidth = width - (x0_ + (texture_data_width_ - x1_));
-                float scalingHeight = height - (y0_ + (texture_data_height_ - y1_));
-
-                fillCoordsBuffer(3u,
-                    x + 0.0f, y + 0.0f,
-                    x + x0_, y + y0_,
-                    x + x0_ + scalingWidth, y + y0_ + scalingHeight,
-                    x + width, y + height,
-                    z,
-                    tex_verts_);
+                translateVerts(tex_verts_, getTexGeometry(width, height), NUM_TEX_VERTS, x, y, z);
 
                 last_texture_x_ = x;
                 last_texture_y_ = y;
@@ -1510,8 +1583,7 @@ namespace atakmap {
                 last_triangle_width_ != width ||
                 last_triangle_height_ != height) {
 
-                buildPatchVerts(triangle_verts_, NUM_VERTS_PER_CORNER, radius_,
-                    RADIANS_PER_VERT, x, y, z, width, height);
+                translateVerts(triangle_verts_, getFanGeometry(width, height), NUM_VERTS_PER_PATCH, x, y, z);
                 last_triangle_x_ = x;
                 last_triangle_y_ = y;
                 last_triangle_z_ = z;
@@ -1539,8 +1611,7 @@ namespace atakmap {
                 last_triangle_width_ != width ||
                 last_triangle_height_ != height) {
 
-                buildPatchVerts(triangle_verts_, NUM_VERTS_PER_CORNER, radius_,
-                                RADIANS_PER_VERT, x, y, z, width, height);
+                translateVerts(triangle_verts_, getFanGeometry(width, height), NUM_VERTS_PER_PATCH, x, y, z);
                 last_triangle_x_ = x;
                 last_triangle_y_ = y;
                 last_triangle_z_ = z;
@@ -1571,16 +1642,7 @@ namespace atakmap {
                 last_texture_width_ != width ||
                 last_texture_height_ != height) {
 
-                float scalingWidth = width - (x0_ + (texture_data_width_ - x1_));
-                float scalingHeight = height - (y0_ + (texture_data_height_ - y1_));
-
-                fillCoordsBuffer(3u,
-                                 x + 0.0f, y + 0.0f,
-                                 x + x0_, y + y0_,
-                                 x + x0_ + scalingWidth, y + y0_ + scalingHeight,
-                                 x + width, y + height,
-                                 z,
-                                 tex_verts_);
+                translateVerts(tex_verts_, getTexGeometry(width, height), NUM_TEX_VERTS, x, y, z);
 
                 last_texture_x_ = x;
                 last_texture_y_ = y;
@@ -34,6 +34,15 @@ namespace atakmap {
 
 
         private:
+            /** patch geometry relative to the patch origin, for a given size */
+            struct PatchGeometry
+            {
+                float width;
+                float height;
+                float *verts;
+            };
+            static const std::size_t GEOMETRY_CACHE_SIZE = 32u;
+
             float *triangle_verts_;
             
             float last_triangle_x_;
@@ -65,6 +74,14 @@ namespace atakmap {
             float *tex_verts_;
             float *tex_coords_;
 
+            // size-keyed, direct mapped caches of the local geometry; only
+            // a resize rebuilds, moves are a translation of the cached
+            // vertices
+            PatchGeometry fan_cache_[GEOMETRY_CACHE_SIZE];
+            float *fan_cache_verts_;
+            PatchGeometry tex_cache_[GEOMETRY_CACHE_SIZE];
+            float *tex_cache_verts_;
+
 
             void commonInit(TAK::Engine::Renderer::GLTextureAtlas2 *texAtlas, 
                             float width, float height,
@@ -87,9 +104,9 @@ namespace atakmap {
             void drawTexture(float x, float y, float z, float width, float height);
             void initTexBuffers();
 
-            void buildPatchVerts(float *verts, int numVertsPerCorner,
-                                 float radius, double radiansPerVert,
-                                 float x, float y, float z, float width, float height);
+            void buildPatchVerts(float *verts, float radius, float width, float height);
+            const float *getFanGeometry(float width, float height);
+            const float *getTexGeometry(float width, float height);
 
             void fillCoordsBuffer(const std::size_t size,
                                   float texPatchCol0, float texPatchRow0,
@@ -1,13 +1,26 @@
 
 #include <GLES3/gl3.h>
 #include "renderer/GLOffscreenFramebuffer.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
 #include "util/Memory.h"
 #include "util/MathUtils.h"
 
 using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
+// number of frames an idle framebuffer is retained by the pool
+#define GLOFFSCREENFRAMEBUFFER_POOL_IDLE_FRAMES 120u
+#define GLOFFSCREENFRAMEBUFFER_POOL_BUDGET (32u*1024u*1024u)
+
 namespace {
     struct GLFBOGuard {
         GLFBOGuard() { glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, (GLint*)&currentFbo); }
@@ -36,6 +49,50 @@ namespace {
 
         return tex;
     }
+
+    struct RenderTargetPool;
+
+    struct PooledFramebuffer : GLOffscreenFramebuffer
+    {
+        GLOffscreenFramebuffer::Options opts;
+        std::size_t size {0u};
+        std::size_t frame {0u};
+        /** the pool of the context the framebuffer was created on */
+        std::shared_ptr<RenderTargetPool> pool;
+    };
+
+    /** framebuffer objects are not shared between contexts; one per context */
+    struct RenderTargetPool
+    {
+        RenderTargetPool(const std::size_t budget) NOTHROWS;
+
+        Mutex mutex;
+        /** idle framebuffers, ordered by return */
+        std::vector<PooledFramebuffer *> idle;
+        std::size_t idleSize {0u};
+        std::size_t budget;
+        std::size_t frame {0u};
+        /** if `true`, the context is released and returned framebuffers are deleted */
+        bool released {false};
+    };
+
+    struct PoolRegistry
+    {
+        PoolRegistry() NOTHROWS;
+
+        Mutex mutex;
+        std::map<const RenderContext *, std::shared_ptr<RenderTargetPool>> pools;
+        std::size_t budget;
+    };
+
+    PoolRegistry &registry() NOTHROWS;
+    std::shared_ptr<RenderTargetPool> getPool(const RenderContext &ctx, const bool create) NOTHROWS;
+    bool isCompatible(const GLOffscreenFramebuffer::Options &a, const GLOffscreenFramebuffer::Options &b) NOTHROWS;
+    std::size_t getBytesPerPixel(const int format, const int internalFormat) NOTHROWS;
+    std::size_t getStorageSize(const PooledFramebuffer &fbo) NOTHROWS;
+    void destroyPooled(PooledFramebuffer *fbo) NOTHROWS;
+    void evictIdle(RenderTargetPool &pool, const std::size_t budget, const std::size_t minFrame) NOTHROWS;
+    void returnToPool(GLOffscreenFramebuffer *fbo);
 }
 
 TAKErr TAK::Engine::Renderer::GLOffscreenFramebuffer_create(GLOffscreenFramebufferPtr& resultOut, int width, int height, GLOffscreenFramebuffer::Options options) NOTHROWS
@@ -175,3 +232,223 @@ void GLOffscreenFramebuffer::bind(const bool clear) NOTHROWS
     if(clear)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
+
+TAKErr TAK::Engine::Renderer::GLOffscreenFramebuffer_borrow(GLOffscreenFramebufferPtr &resultOut, const RenderContext &ctx, int width, int height, GLOffscreenFramebuffer::Options opts) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (width <= 0 || height <= 0)
+        return TE_InvalidArg;
+    std::shared_ptr<RenderTargetPool> pool(getPool(ctx, true));
+    if (!pool)
+        return TE_OutOfMemory;
+
+    const int textureWidth = MathUtils_isPowerOf2(width) ? width : 1 << MathUtils_nextPowerOf2(width);
+    const int textureHeight = MathUtils_isPowerOf2(height) ? height : 1 << MathUtils_nextPowerOf2(height);
+
+    PooledFramebuffer *result = nullptr;
+    {
+        RenderTargetPool &p = *pool;
+        Lock lock(p.mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+
+        // prefer the most recently returned
+        for (auto it = p.idle.rbegin(); it != p.idle.rend(); it++) {
+            if ((*it)->textureWidth != textureWidth || (*it)->textureHeight != textureHeight)
+                continue;
+            if (!isCompatible((*it)->opts, opts))
+                continue;
+            result = *it;
+            p.idleSize -= result->size;
+            p.idle.erase(std::next(it).base());
+            break;
+        }
+    }
+
+    if (!result) {
+        result = new (std::nothrow) PooledFramebuffer();
+        if (!result)
+            return TE_OutOfMemory;
+        code = GLOffscreenFramebuffer_create(result, width, height, opts);
+        if (code != TE_Ok) {
+            delete result;
+            return code;
+        }
+        result->opts = opts;
+        result->size = getStorageSize(*result);
+        result->pool = pool;
+    }
+
+    result->width = width;
+    result->height = height;
+    resultOut = GLOffscreenFramebufferPtr(result, returnToPool);
+    return code;
+}
+TAKErr TAK::Engine::Renderer::GLOffscreenFramebuffer_recyclePool(const RenderContext &ctx) NOTHROWS
+{
+    std::shared_ptr<RenderTargetPool> pool(getPool(ctx, false));
+    if (!pool)
+        return TE_Ok;
+    RenderTargetPool &p = *pool;
+    Lock lock(p.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    p.frame++;
+    if (p.frame > GLOFFSCREENFRAMEBUFFER_POOL_IDLE_FRAMES)
+        evictIdle(p, p.budget, p.frame - GLOFFSCREENFRAMEBUFFER_POOL_IDLE_FRAMES);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Renderer::GLOffscreenFramebuffer_setPoolBudget(const std::size_t bytes) NOTHROWS
+{
+    PoolRegistry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    r.budget = bytes;
+    for (auto it = r.pools.begin(); it != r.pools.end(); it++) {
+        Lock plock(it->second->mutex);
+        TE_CHECKRETURN_CODE(plock.status);
+        it->second->budget = bytes;
+    }
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Renderer::GLOffscreenFramebuffer_releasePool(const RenderContext &ctx) NOTHROWS
+{
+    std::shared_ptr<RenderTargetPool> pool;
+    {
+        PoolRegistry &r = registry();
+        Lock lock(r.mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        auto entry = r.pools.find(&ctx);
+        if (entry == r.pools.end())
+            return TE_Ok;
+        pool = std::move(entry->second);
+        r.pools.erase(entry);
+    }
+
+    RenderTargetPool &p = *pool;
+    Lock lock(p.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    p.released = true;
+    evictIdle(p, 0u, 0u);
+    return TE_Ok;
+}
+
+namespace {
+    RenderTargetPool::RenderTargetPool(const std::size_t budget_) NOTHROWS :
+        budget(budget_)
+    {}
+
+    PoolRegistry::PoolRegistry() NOTHROWS :
+        budget((std::size_t)ConfigOptions_getIntOptionOrDefault("gloffscreenframebuffer.pool-budget", GLOFFSCREENFRAMEBUFFER_POOL_BUDGET))
+    {}
+
+    PoolRegistry &registry() NOTHROWS
+    {
+        static PoolRegistry r;
+        return r;
+    }
+    std::shared_ptr<RenderTargetPool> getPool(const RenderContext &ctx, const bool create) NOTHROWS
+    {
+        PoolRegistry &r = registry();
+        Lock lock(r.mutex);
+        if (lock.status != TE_Ok)
+            return std::shared_ptr<RenderTargetPool>();
+        auto entry = r.pools.find(&ctx);
+        if (entry != r.pools.end())
+            return entry->second;
+        if (!create)
+            return std::shared_ptr<RenderTargetPool>();
+        std::shared_ptr<RenderTargetPool> pool(new(std::nothrow) RenderTargetPool(r.budget));
+        if (pool)
+            r.pools[&ctx] = pool;
+        return pool;
+    }
+    bool isCompatible(const GLOffscreenFramebuffer::Options &a, const GLOffscreenFramebuffer::Options &b) NOTHROWS
+    {
+        return a.depthFormat == b.depthFormat &&
+               a.depthInternalFormat == b.depthInternalFormat &&
+               a.depthType == b.depthType &&
+               a.colorFormat == b.colorFormat &&
+               a.colorInternalFormat == b.colorInternalFormat &&
+               a.colorType == b.colorType &&
+               a.stencilFormat == b.stencilFormat &&
+               a.stencilInternalFormat == b.stencilInternalFormat &&
+               a.stencilType == b.stencilType &&
+               a.bufferMask == b.bufferMask;
+    }
+    std::size_t getBytesPerPixel(const int format, const int internalFormat) NOTHROWS
+    {
+        switch (internalFormat != GL_NONE ? internalFormat : format) {
+            case GL_NONE :
+                return 0u;
+            case GL_R8 :
+            case GL_ALPHA :
+            case GL_LUMINANCE :
+            case GL_STENCIL_INDEX8 :
+                return 1u;
+            case GL_RGB565 :
+            case GL_RGBA4 :
+            case GL_RGB5_A1 :
+            case GL_DEPTH_COMPONENT16 :
+            case GL_LUMINANCE_ALPHA :
+                return 2u;
+            case GL_RGBA16UI :
+            case GL_RGBA16F :
+            case GL_DEPTH32F_STENCIL8 :
+                return 8u;
+            case GL_RGBA32UI :
+            case GL_RGBA32F :
+                return 16u;
+            default :
+                return 4u;
+        }
+    }
+    std::size_t getStorageSize(const PooledFramebuffer &fbo) NOTHROWS
+    {
+        std::size_t bpp = getBytesPerPixel(fbo.opts.colorFormat, fbo.opts.colorInternalFormat) +
+                          getBytesPerPixel(fbo.opts.stencilFormat, fbo.opts.stencilInternalFormat);
+        // depth render buffer is allocated as 24-bit
+        if (fbo.opts.depthFormat != GL_NONE)
+            bpp += getBytesPerPixel(fbo.opts.depthFormat, fbo.opts.depthInternalFormat);
+        else if (fbo.opts.bufferMask&GL_DEPTH_BUFFER_BIT)
+            bpp += 4u;
+        return (std::size_t)fbo.textureWidth*(std::size_t)fbo.textureHeight*bpp;
+    }
+    void destroyPooled(PooledFramebuffer *fbo) NOTHROWS
+    {
+        GLOffscreenFramebuffer_release(*fbo);
+        delete fbo;
+    }
+    void evictIdle(RenderTargetPool &p, const std::size_t budget, const std::size_t minFrame) NOTHROWS
+    {
+        std::size_t evicted = 0u;
+        for (auto it = p.idle.begin(); it != p.idle.end(); it++) {
+            if (p.idleSize <= budget && (*it)->frame >= minFrame)
+                break;
+            p.idleSize -= (*it)->size;
+            destroyPooled(*it);
+            evicted++;
+        }
+        p.idle.erase(p.idle.begin(), p.idle.begin() + evicted);
+    }
+    void returnToPool(GLOffscreenFramebuffer *value)
+    {
+        if (!value)
+            return;
+        auto *fbo = static_cast<PooledFramebuffer *>(value);
+
+        // hold the pool; deleting the framebuffer releases its reference
+        std::shared_ptr<RenderTargetPool> pool(fbo->pool);
+        RenderTargetPool &p = *pool;
+        Lock lock(p.mutex);
+        if (lock.status != TE_Ok || p.released || fbo->size > p.budget) {
+            destroyPooled(fbo);
+            return;
+        }
+        fbo->frame = p.frame;
+        p.idle.push_back(fbo);
+        p.idleSize += fbo->size;
+        evictIdle(p, p.budget, 0u);
+    }
+}
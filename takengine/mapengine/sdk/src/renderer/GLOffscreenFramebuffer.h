@@ -54,6 +54,36 @@ namespace TAK {
             TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_create(GLOffscreenFramebufferPtr& result, int width, int height, GLOffscreenFramebuffer::Options opts) NOTHROWS;
             TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_create(GLOffscreenFramebuffer *result, int width, int height, GLOffscreenFramebuffer::Options opts) NOTHROWS;
             TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_release(GLOffscreenFramebuffer &offscreen) NOTHROWS;
+
+            /**
+             * Borrows a framebuffer from the render target pool of the
+             * specified context. An idle framebuffer with the same options
+             * and texture size is reused if available, otherwise a new one
+             * is created. The framebuffer is returned to the pool when
+             * `result` is reset or destroyed, which must occur on the GL
+             * thread. The contents of a borrowed framebuffer are undefined.
+             */
+            TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_borrow(GLOffscreenFramebufferPtr &result, const TAK::Engine::Core::RenderContext &ctx, int width, int height, GLOffscreenFramebuffer::Options opts) NOTHROWS;
+            /**
+             * Advances the frame of the render target pool of the
+             * specified context. Idle framebuffers that have not been
+             * borrowed for a number of frames are released. Should be
+             * invoked once per frame on the GL thread.
+             */
+            TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_recyclePool(const TAK::Engine::Core::RenderContext &ctx) NOTHROWS;
+            /**
+             * Sets the maximum number of bytes retained by idle
+             * framebuffers in each render target pool; the least recently
+             * returned are released first.
+             */
+            TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_setPoolBudget(const std::size_t bytes) NOTHROWS;
+            /**
+             * Releases the render target pool of the specified context,
+             * deleting all idle framebuffers. Framebuffers still borrowed
+             * are deleted when returned. Must be invoked on the GL thread,
+             * before the context is destroyed.
+             */
+            TAK::Engine::Util::TAKErr GLOffscreenFramebuffer_releasePool(const TAK::Engine::Core::RenderContext &ctx) NOTHROWS;
         }
     }
 }
@@ -0,0 +1,26 @@
+#include "renderer/GLPerformanceCounters.h"
+
+#include "util/PerformanceCounters.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Util;
+
+void TAK::Engine::Renderer::GLPerformanceCounters_draw(const GLenum mode, const std::size_t count, const std::size_t instances) NOTHROWS
+{
+    PerformanceCounters_add(TEPC_DrawCalls, 1u);
+    std::size_t triangles = 0u;
+    switch (mode) {
+    case GL_TRIANGLES :
+        triangles = count / 3u;
+        break;
+    case GL_TRIANGLE_STRIP :
+    case GL_TRIANGLE_FAN :
+        triangles = (count > 2u) ? count - 2u : 0u;
+        break;
+    default :
+        break;
+    }
+    if (triangles)
+        PerformanceCounters_add(TEPC_Triangles, triangles * instances);
+}
@@ -0,0 +1,28 @@
+#ifndef TAK_ENGINE_RENDERER_GLPERFORMANCECOUNTERS_H_INCLUDED
+#define TAK_ENGINE_RENDERER_GLPERFORMANCECOUNTERS_H_INCLUDED
+
+#include <cstddef>
+
+#include "port/Platform.h"
+#include "renderer/GL.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Records a draw call against the performance counters bound to
+             * the current thread (see <code>Util::PerformanceCounters</code>).
+             * Should be
+             * invoked immediately following <code>glDrawArrays</code>,
+             * <code>glDrawElements</code> or their instanced variants.
+             *
+             * @param mode      The primitive mode of the draw
+             * @param count     The number of vertices or indices drawn
+             * @param instances The number of instances drawn
+             */
+            ENGINE_API void GLPerformanceCounters_draw(const GLenum mode, const std::size_t count, const std::size_t instances = 1u) NOTHROWS;
+        }
+    }
+}
+
+#endif
@@ -4,10 +4,13 @@
 #include <sstream>
 
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 
 #ifndef __ANDROID__
 #include "renderer/GLES20FixedPipeline.h"
 #include "renderer/core/GLMapRenderGlobals.h"
+#include "renderer/GLPerformanceCounters.h"
 #endif
 
 #include "port/StringBuilder.h"
@@ -101,6 +104,11 @@ using namespace atakmap::renderer;
                            // 4 rgba
                            // 4 texture unit
 #define VERTICES_PER_SPRITE 6u
+// number of full buffer flushes the stream rings hold before reuse must
+// wait on the GPU
+#define STREAM_BUFFER_FLUSHES 3u
+// maximum number of vertices addressable with 16-bit indices
+#define MAX_VERTICES_16 0xFFFFu
 
 #if 1
 #define NEEDS_STRIDE(c) \
@@ -165,9 +173,9 @@ namespace
     template<typename T>
     bool isDegenerate3d(const T *triangle, const std::size_t stride) NOTHROWS;
 
-    TAKErr addLine2d_2dImpl(MemBuffer2 &pfRenderBuffer, MemBuffer2 &indexBuffer, const std::size_t indexOff, const uint64_t vertexConst, const float widthX, const float widthY, const float x0, const float y0, const float x1, const float y1) NOTHROWS;
-    TAKErr addLine2d_3dImpl(MemBuffer2 &pfRenderBuffer, MemBuffer2 &indexBuffer, const std::size_t indexOff, const uint64_t vertexConst, const float widthX, const float widthY, const float x0, const float y0, const float x1, const float y1) NOTHROWS;
-    TAKErr addLine3dImpl(MemBuffer2 &pfRenderBuffer, MemBuffer2 &indexBuffer, const std::size_t indexOff, const uint64_t vertexConst, const float widthX, const float widthY, const float x0, const float y0, const float z0, const float x1, const float y1, const float z1) NOTHROWS;
+    TAKErr addLine2d_2dImpl(MemBuffer2 &pfRenderBuffer, MemBuffer2 &indexBuffer, const std::size_t indexSize, const std::size_t indexOff, const uint64_t vertexConst, const float widthX, const float widthY, const float x0, const float y0, const float x1, const float y1) NOTHROWS;
+    TAKErr addLine2d_3dImpl(MemBuffer2 &pfRenderBuffer, MemBuffer2 &indexBuffer, const std::size_t indexSize, const std::size_t indexOff, const uint64_t vertexConst, const float widthX, const float widthY, const float x0, const float y0, const float x1, const float y1) NOTHROWS;
+    TAKErr addLine3dImpl(MemBuffer2 &pfRenderBuffer, MemBuffer2 &indexBuffer, const std::size_t indexSize, const std::size_t indexOff, const uint64_t vertexConst, const float widthX, const float widthY, const float x0, const float y0, const float z0, const float x1, const float y1, const float z1) NOTHROWS;
 
     TAKErr addTexturedVertex2d_2d(MemBuffer2 &pfRenderBuffer, const float *pfVertexCoords, const float *pfTexCoords, const uint64_t vertexConst, const float *mx) NOTHROWS;
     TAKErr addTexturedVertex2d_3d(MemBuffer2 &pfRenderBuffer, const float *pfVertexCoords, const float *pfTexCoords, const uint64_t vertexConst, const float *mx) NOTHROWS;
@@ -195,6 +203,11 @@ namespace
 
     TAKErr getAddVertexFunction(addVertexFn *value, const std::size_t size, const bool texCoords, const int hints) NOTHROWS;
 
+    /** returns the index size required to address `cap` vertices */
+    std::size_t maxIndexSize(const std::size_t cap) NOTHROWS;
+    bool isUintIndexSupported() NOTHROWS;
+    TAKErr putIndex(MemBuffer2 &indexBuffer, const std::size_t indexSize, const std::size_t index) NOTHROWS;
+
 #ifdef __ANDROID__
     std::size_t GLRenderBatch_textureUnitLimit = 32;
 
@@ -206,22 +219,29 @@ namespace
 // Constructor/Destructor/other init
 
 GLRenderBatch2::GLRenderBatch2(const std::size_t cap) NOTHROWS :
-    numActiveTexUnits(0),
-    originalTextureUnit(0),
-    batchHints(0),
-    renderBuffer(std::min((std::size_t)0xFFFFu, cap) * VERTEX_SIZE_3D),
-    indexBuffer(std::min((std::size_t)0xFFFFu, cap) * VERTICES_PER_SPRITE * 2u),
-    untexturedProgram2d(2u),
-    texturedProgram2d(2u),
-    untexturedProgram3d(3u),
-    texturedProgram3d(3u),
-    texUnitIdxToTexId(new int[INTERNAL_TEXTURE_UNIT_LIMIT]),
+    vertexCapacity(cap),
+    indexType(GL_NONE),
+    indexSize(2u),
+    renderBuffer(cap * VERTEX_SIZE_3D),
+    indexBuffer(cap * VERTICES_PER_SPRITE * maxIndexSize(cap)),
+    vertexStream(GL_ARRAY_BUFFER, cap * VERTEX_SIZE_3D * STREAM_BUFFER_FLUSHES),
+    indexStream(GL_ELEMENT_ARRAY_BUFFER, cap * VERTICES_PER_SPRITE * maxIndexSize(cap) * STREAM_BUFFER_FLUSHES),
     projection(2),
     modelView(32),
     texture(16),
     lineWidth(1),
     viewportWidth(1),
     viewportHeight(1),
+    untexturedProgram2d(2u),
+    texturedProgram2d(2u),
+    untexturedProgram3d(3u),
+    texturedProgram3d(3u),
+    texUnitIdxToTexId(new int[INTERNAL_TEXTURE_UNIT_LIMIT]),
+    texUnitIdxIsDistanceField(new bool[INTERNAL_TEXTURE_UNIT_LIMIT]),
+    numActiveTexUnits(0),
+    originalTextureUnit(0),
+    batchHints(0),
+    distanceField(false),
     mvpDirty(true)
 {
     memset(projection.pointer, 0u, sizeof(float)*16);
@@ -249,30 +269,37 @@ TAKErr GLRenderBatch2::initPrograms() NOTHROWS
 {
     TAKErr code(TE_Ok);
 
-    code = batchProgramInit(&untexturedProgram2d,
-                            false,
-                            UNTEXTURED_VERTEX_SHADER_2D_SRC,
-                            UNTEXTURED_FRAGMENT_SHADER_SRC);
+    std::string texturedFragShaderSrc = getFragmentShaderSrc();
+
+    // create as a single batch so the driver may compile concurrently
+    const char *vertShaderSrcs[4u] =
+    {
+        UNTEXTURED_VERTEX_SHADER_2D_SRC,
+        UNTEXTURED_VERTEX_SHADER_3D_SRC,
+        SPRITE_BATCH_VERTEX_SHADER_2D_SRC,
+        SPRITE_BATCH_VERTEX_SHADER_3D_SRC,
+    };
+    const char *fragShaderSrcs[4u] =
+    {
+        UNTEXTURED_FRAGMENT_SHADER_SRC,
+        UNTEXTURED_FRAGMENT_SHADER_SRC,
+        texturedFragShaderSrc.c_str(),
+        texturedFragShaderSrc.c_str(),
+    };
+    ShaderProgram programs[4u];
+    code = GLSLUtil_createPrograms(programs, vertShaderSrcs, fragShaderSrcs, 4u);
     TE_CHECKRETURN_CODE(code);
 
-    code = batchProgramInit(&untexturedProgram3d,
-                            false,
-                            UNTEXTURED_VERTEX_SHADER_3D_SRC,
-                            UNTEXTURED_FRAGMENT_SHADER_SRC);
+    code = batchProgramInit(&untexturedProgram2d, false, programs[0u]);
     TE_CHECKRETURN_CODE(code);
 
-    std::string texturedFragShaderSrc = getFragmentShaderSrc();
+    code = batchProgramInit(&untexturedProgram3d, false, programs[1u]);
+    TE_CHECKRETURN_CODE(code);
 
-    code = batchProgramInit(&texturedProgram2d,
-                            true,
-                            SPRITE_BATCH_VERTEX_SHADER_2D_SRC,
-                            texturedFragShaderSrc.c_str());
+    code = batchProgramInit(&texturedProgram2d, true, programs[2u]);
     TE_CHECKRETURN_CODE(code);
 
-    code = batchProgramInit(&texturedProgram3d,
-                            true,
-                            SPRITE_BATCH_VERTEX_SHADER_3D_SRC,
-                            texturedFragShaderSrc.c_str());
+    code = batchProgramInit(&texturedProgram3d, true, programs[3u]);
     TE_CHECKRETURN_CODE(code);
 
     return code;
@@ -283,10 +310,28 @@ std::string GLRenderBatch2::getFragmentShaderSrc() NOTHROWS
     StringBuilder stringBuilder;
     const std::size_t textureUnitLimit = GLRenderBatch2_getBatchTextureUnitLimit();
 
+    // derivatives scale the distance field threshold with the on-screen
+    // size of the glyph
+    stringBuilder << "#ifdef GL_OES_standard_derivatives\n"
+            << "#extension GL_OES_standard_derivatives : enable\n"
+            << "#endif\n";
     stringBuilder << "precision mediump float;\n";
     for (std::size_t i = 0; i < textureUnitLimit; i++)
         stringBuilder << "uniform sampler2D uTexture" << i << ";\n";
 
+    // the alpha channel holds the distance to the edge of the shape, the
+    // color channels the distance to the edge of the fill
+    stringBuilder << "vec4 distanceField(vec4 d)\n"
+            << "{\n"
+            << "#ifdef GL_OES_standard_derivatives\n"
+            << "  float w = clamp(fwidth(d.a) * 0.75, 0.01, 0.5);\n"
+            << "#else\n"
+            << "  float w = 0.08;\n"
+            << "#endif\n"
+            << "  float fill = smoothstep(0.5 - w, 0.5 + w, d.r);\n"
+            << "  return vec4(fill, fill, fill, smoothstep(0.5 - w, 0.5 + w, d.a));\n"
+            << "}\n";
+
 //#define TE_EXP_NOSWITCHBATCHFRAG
 
 #ifdef TE_EXP_NOSWITCHBATCHFRAG
@@ -304,8 +349,10 @@ std::string GLRenderBatch2::getFragmentShaderSrc() NOTHROWS
     stringBuilder << "void main(void) {\n";
 
 #ifdef TE_EXP_NOSWITCHBATCHFRAG
-    for (std::size_t i = 0; i < textureUnitLimit; i++)
+    for (std::size_t i = 0; i < textureUnitLimit; i++) {
         stringBuilder << "    gl_FragColor += vColor * getContribution(vTexUnit, " << i << ".0) * texture2D(uTexture" << i << ", vTexPos);\n";
+        stringBuilder << "    gl_FragColor += vColor * getContribution(vTexUnit, -" << (i + 2u) << ".0) * distanceField(texture2D(uTexture" << i << ", vTexPos));\n";
+    }
 
     stringBuilder << "    gl_FragColor += vColor * getContribution(vTexUnit, -1.0);\n";
 #else
@@ -316,6 +363,10 @@ std::string GLRenderBatch2::getFragmentShaderSrc() NOTHROWS
             stringBuilder << "    else if(vTexUnit == " << i << ".0)\n";
             stringBuilder << "        gl_FragColor = vColor * texture2D(uTexture" << i << ", vTexPos);\n";
         }
+        for (std::size_t i = 0; i < textureUnitLimit; i++) {
+            stringBuilder << "    else if(vTexUnit == -" << (i + 2u) << ".0)\n";
+            stringBuilder << "        gl_FragColor = vColor * distanceField(texture2D(uTexture" << i << ", vTexPos));\n";
+        }
         stringBuilder << "    else if(vTexUnit == -1.0) \n";
     }
 
@@ -346,16 +397,19 @@ TAKErr GLRenderBatch2::begin(const int hints) NOTHROWS
 #else
     glGetIntegerv(GL_ACTIVE_TEXTURE, &originalTextureUnit);
 #endif
-    renderBuffer.position(0u);
-    if (hasBits(this->batchHints, GLRenderBatch2::TwoDimension)) {
-        // reset the limit to the maximum possible number of 2D vertices given
-        // the buffer capacity
-        renderBuffer.limit(std::min(renderBuffer.size() / VERTEX_SIZE_2D, (size_t)0xFFFFu) * VERTEX_SIZE_2D);
-    } else {
-        // reset the limit to allow for the maximum number of batched 3D
-        // vertices
-        renderBuffer.limit(renderBuffer.size());
+    if (indexType == GL_NONE) {
+        // 32-bit indices are only used if the capacity exceeds what may be
+        // addressed with 16-bit indices; only query support in that case
+        indexType = GLRenderBatch2_getIndexType(vertexCapacity, (vertexCapacity > MAX_VERTICES_16) && isUintIndexSupported());
+        indexSize = (indexType == GL_UNSIGNED_INT) ? 4u : 2u;
     }
+
+    // reset the limit to the maximum possible number of vertices given the
+    // buffer capacity and index type
+    const std::size_t maxVertices = GLRenderBatch2_getMaxVertices(vertexCapacity, indexType);
+    const std::size_t vertexSize = hasBits(this->batchHints, GLRenderBatch2::TwoDimension) ? VERTEX_SIZE_2D : VERTEX_SIZE_3D;
+    renderBuffer.position(0u);
+    renderBuffer.limit(std::min(renderBuffer.size() / vertexSize, maxVertices) * vertexSize);
     indexBuffer.position(0u);
     numActiveTexUnits = 0;
 
@@ -407,6 +461,8 @@ TAKErr GLRenderBatch2::release() NOTHROWS
         glDeleteProgram(texturedProgram3d.handle);
         texturedProgram3d.handle = 0;
     }
+    vertexStream.release();
+    indexStream.release();
     return code;
 }
 
@@ -440,13 +496,33 @@ TAKErr GLRenderBatch2::flush() NOTHROWS
 
         const std::size_t vertexSize = buffer2d ? VERTEX_SIZE_2D : VERTEX_SIZE_3D;
 
+        // stream the client buffers through the VBO rings; if either upload
+        // fails, that buffer is sourced from client memory
+        const uint8_t *vertices;
+        const uint8_t *indices;
+        std::size_t streamOffset;
+        const bool vertexStreamed = (vertexStream.upload(&streamOffset, renderBuffer.get(), renderBuffer.position()) == TE_Ok);
+        if (vertexStreamed) {
+            vertices = reinterpret_cast<const uint8_t *>(streamOffset);
+        } else {
+            glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+            vertices = renderBuffer.get();
+        }
+        const bool indexStreamed = (indexStream.upload(&streamOffset, indexBuffer.get(), indexBuffer.position()) == TE_Ok);
+        if (indexStreamed) {
+            indices = reinterpret_cast<const uint8_t *>(streamOffset);
+        } else {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
+            indices = indexBuffer.get();
+        }
+
         glVertexAttribPointer(
             program->aVertexCoordsHandle,
             static_cast<GLint>(program->size),
             GL_FLOAT,
             false,
             static_cast<GLsizei>(vertexSize),
-            renderBuffer.get());
+            vertices);
 
         if (program->aTextureCoordsHandle+1)
             glVertexAttribPointer(
@@ -455,7 +531,7 @@ TAKErr GLRenderBatch2::flush() NOTHROWS
                 GL_FLOAT,
                 false,
                 static_cast<GLsizei>(vertexSize),
-                renderBuffer.get() + (program->size*4));
+                vertices + (program->size*4));
 
         glVertexAttribPointer(
             program->aColorHandle,
@@ -463,7 +539,7 @@ TAKErr GLRenderBatch2::flush() NOTHROWS
             GL_UNSIGNED_BYTE,
             true,
             static_cast<GLsizei>(vertexSize),
-            renderBuffer.get() + (program->size*4) + 8);
+            vertices + (program->size*4) + 8);
 
         if (program->aTexUnitHandle+1)
             glVertexAttribPointer(
@@ -472,7 +548,7 @@ TAKErr GLRenderBatch2::flush() NOTHROWS
                 GL_FLOAT,
                 false,
                 static_cast<GLsizei>(vertexSize),
-                renderBuffer.get() + (program->size*4) + 12);
+                vertices + (program->size*4) + 12);
 
         glEnableVertexAttribArray(program->aVertexCoordsHandle);
         if (program->aTextureCoordsHandle+1)
@@ -482,9 +558,10 @@ TAKErr GLRenderBatch2::flush() NOTHROWS
             glEnableVertexAttribArray(program->aTexUnitHandle);
 
         glDrawElements(GL_TRIANGLES,
-            static_cast<GLsizei>(indexBuffer.position()/2u),
-            GL_UNSIGNED_SHORT,
-            indexBuffer.get());
+            static_cast<GLsizei>(indexBuffer.position()/indexSize),
+            indexType,
+            indices);
+        GLPerformanceCounters_draw(GL_TRIANGLES, indexBuffer.position()/indexSize);
 
         glDisableVertexAttribArray(program->aVertexCoordsHandle);
         if (program->aTextureCoordsHandle+1)
@@ -492,6 +569,15 @@ TAKErr GLRenderBatch2::flush() NOTHROWS
         glDisableVertexAttribArray(program->aColorHandle);
         if (program->aTexUnitHandle+1)
             glDisableVertexAttribArray(program->aTexUnitHandle);
+
+        // restore the bindings expected by renderers that draw from client
+        // memory
+        glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
+        if (vertexStreamed)
+            vertexStream.fence();
+        if (indexStreamed)
+            indexStream.fence();
     }
 
     numActiveTexUnits = 0;
@@ -605,6 +691,12 @@ TAKErr GLRenderBatch2::setLineWidth(float width) NOTHROWS
     return TE_Ok;
 }
 
+TAKErr GLRenderBatch2::setDistanceField(const bool value) NOTHROWS
+{
+    distanceField = value;
+    return TE_Ok;
+}
+
 TAKErr GLRenderBatch2::batch(const int texId,
                              const int mode,
                              const std::size_t count,
@@ -955,7 +1047,7 @@ TAKErr GLRenderBatch2::addLinesImpl(const std::size_t size, const float width, c
         float y1;
         for (std::size_t i = 0u; i < numLines; i++) {
             if (renderBuffer.remaining() < (vertexSize * 4) ||
-                indexBuffer.remaining()/2u < VERTICES_PER_SPRITE) {
+                indexBuffer.remaining()/indexSize < VERTICES_PER_SPRITE) {
 
                 code = flush();
                 TE_CHECKRETURN_CODE(code);
@@ -973,6 +1065,7 @@ TAKErr GLRenderBatch2::addLinesImpl(const std::size_t size, const float width, c
 
             addLine2d_2dImpl(renderBuffer,
                              indexBuffer,
+                             indexSize,
                              renderBuffer.position() / vertexSize,
                              vertexConst,
                              width / viewportHeight,
@@ -990,7 +1083,7 @@ TAKErr GLRenderBatch2::addLinesImpl(const std::size_t size, const float width, c
         float z1;
         for (std::size_t i = 0u; i < numLines; i++) {
             if (renderBuffer.remaining() < (vertexSize * 4) ||
-                indexBuffer.remaining()/2u < VERTICES_PER_SPRITE) {
+                indexBuffer.remaining()/indexSize < VERTICES_PER_SPRITE) {
 
                 code = flush();
                 TE_CHECKRETURN_CODE(code);
@@ -1008,6 +1101,7 @@ TAKErr GLRenderBatch2::addLinesImpl(const std::size_t size, const float width, c
 
             addLine3dImpl(renderBuffer,
                           indexBuffer,
+                          indexSize,
                           renderBuffer.position() / vertexSize,
                           vertexConst,
                           width / viewportHeight,
@@ -1025,7 +1119,7 @@ TAKErr GLRenderBatch2::addLinesImpl(const std::size_t size, const float width, c
         float z1;
         for (std::size_t i = 0u; i < numLines; i++) {
             if (renderBuffer.remaining() < (vertexSize * 4) ||
-                indexBuffer.remaining()/2u < VERTICES_PER_SPRITE) {
+                indexBuffer.remaining()/indexSize < VERTICES_PER_SPRITE) {
 
                 code = flush();
                 TE_CHECKRETURN_CODE(code);
@@ -1045,6 +1139,7 @@ TAKErr GLRenderBatch2::addLinesImpl(const std::size_t size, const float width, c
 
             addLine3dImpl(renderBuffer,
                           indexBuffer,
+                          indexSize,
                           renderBuffer.position() / vertexSize,
                           vertexConst,
                           width / viewportHeight,
@@ -1082,7 +1177,7 @@ TAKErr GLRenderBatch2::addTrianglesImpl(const std::size_t size, const std::size_
     ((unsigned char *)&vertexConst)[1] = (unsigned char)(g*255.0f);
     ((unsigned char *)&vertexConst)[2] = (unsigned char)(b*255.0f);
     ((unsigned char *)&vertexConst)[3] = (unsigned char)(a*255.0f);
-    (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+    (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
 
     const auto *vertexCoordsPtr = reinterpret_cast<const uint8_t *>(vertexCoords);
     const auto *texCoordsPtr = reinterpret_cast<const uint8_t *>(texCoords);
@@ -1090,7 +1185,7 @@ TAKErr GLRenderBatch2::addTrianglesImpl(const std::size_t size, const std::size_
     std::size_t numTriangles = count / (3u * size);
     for (std::size_t i = 0; i < numTriangles; i++) {
         if (renderBuffer.remaining() < (vertexSize * 3) ||
-            indexBuffer.remaining()/2u < 3) {
+            indexBuffer.remaining()/indexSize < 3) {
 
             const int texId = texCoords ? texUnitIdxToTexId[texUnitIdx] : 0;
 
@@ -1101,7 +1196,7 @@ TAKErr GLRenderBatch2::addTrianglesImpl(const std::size_t size, const std::size_
             if(texId) {
                 code = bindTexture(&texUnitIdx, texId);
                 TE_CHECKBREAK_CODE(code);
-                (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+                (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
             }
         }
 
@@ -1119,7 +1214,7 @@ TAKErr GLRenderBatch2::addTrianglesImpl(const std::size_t size, const std::size_
             texCoordsPtr += tcStride;
 
             // index
-            code = indexBuffer.put(static_cast<uint16_t>(indexOff));
+            code = putIndex(indexBuffer, indexSize, indexOff);
             TE_CHECKBREAK_CODE(code);
 
             indexOff++;
@@ -1145,7 +1240,7 @@ TAKErr GLRenderBatch2::addIndexedTrianglesImpl(const std::size_t size, const std
     std::size_t indexOff = renderBuffer.position() / vertexSize;
 
     if (renderBuffer.remaining() < ((count/size) * vertexSize) ||
-        indexBuffer.remaining()/2u < indexCount) {
+        indexBuffer.remaining()/indexSize < indexCount) {
 
           const int texId = texCoords ? texUnitIdxToTexId[texUnitIdx] : 0;
 
@@ -1168,7 +1263,7 @@ TAKErr GLRenderBatch2::addIndexedTrianglesImpl(const std::size_t size, const std
     ((unsigned char *)&vertexConst)[1] = (unsigned char)(g*255.0f);
     ((unsigned char *)&vertexConst)[2] = (unsigned char)(b*255.0f);
     ((unsigned char *)&vertexConst)[3] = (unsigned char)(a*255.0f);
-    (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+    (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
 
     const auto *vertexCoordsPtr = reinterpret_cast<const uint8_t *>(vertexCoords);
     const auto *texCoordsPtr = reinterpret_cast<const uint8_t *>(texCoords);
@@ -1188,12 +1283,12 @@ TAKErr GLRenderBatch2::addIndexedTrianglesImpl(const std::size_t size, const std
     }
     TE_CHECKRETURN_CODE(code);
 
-    if (indexOff == 0) {
+    if (indexOff == 0 && indexSize == 2u) {
         code = indexBuffer.put(indices, indexCount);
         TE_CHECKRETURN_CODE(code);
     } else {
         for (size_t i = 0; i < indexCount; i++) {
-            code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[i]));
+            code = putIndex(indexBuffer, indexSize, indexOff + indices[i]);
             TE_CHECKBREAK_CODE(code);
         }
         TE_CHECKRETURN_CODE(code);
@@ -1213,7 +1308,7 @@ TAKErr GLRenderBatch2::addTriangleStripImpl(const std::size_t size, const std::s
     ((unsigned char *)&vertexConst)[1] = (unsigned char)(g*255.0f);
     ((unsigned char *)&vertexConst)[2] = (unsigned char)(b*255.0f);
     ((unsigned char *)&vertexConst)[3] = (unsigned char)(a*255.0f);
-    (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+    (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
 
     const bool transformPoints = hasBits(this->batchHints, GLRenderBatch2::SoftwareTransforms);
     if(transformPoints)
@@ -1252,7 +1347,7 @@ TAKErr GLRenderBatch2::addTriangleStripImpl(const std::size_t size, const std::s
         }
 
         if (renderBuffer.remaining() < (vertexSize * 3) ||
-            indexBuffer.remaining()/2u < 3) {
+            indexBuffer.remaining()/indexSize < 3) {
 
             const int texId = texCoords ? texUnitIdxToTexId[texUnitIdx] : 0;
 
@@ -1263,7 +1358,7 @@ TAKErr GLRenderBatch2::addTriangleStripImpl(const std::size_t size, const std::s
             if(texId) {
                 code = bindTexture(&texUnitIdx, texId);
                 TE_CHECKBREAK_CODE(code);
-                (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+                (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
             }
         }
 
@@ -1298,11 +1393,11 @@ TAKErr GLRenderBatch2::addTriangleStripImpl(const std::size_t size, const std::s
         texCoordsPtr += tcStride;
 
         // indices
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff - 2u));
+        code = putIndex(indexBuffer, indexSize, indexOff - 2u);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff - 1u));
+        code = putIndex(indexBuffer, indexSize, indexOff - 1u);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff));
+        code = putIndex(indexBuffer, indexSize, indexOff);
         TE_CHECKBREAK_CODE(code);
 
         indexOff++;
@@ -1331,7 +1426,7 @@ TAKErr GLRenderBatch2::addIndexedTriangleStripImpl(const std::size_t size, const
     std::size_t indexOff = renderBuffer.position() / vertexSize;
 
     if (renderBuffer.remaining() < ((count/size) * vertexSize) ||
-        indexBuffer.remaining()/2u < ((indexCount-2) * 3u)) {
+        indexBuffer.remaining()/indexSize < ((indexCount-2) * 3u)) {
 
         const int texId = texCoords ? texUnitIdxToTexId[texUnitIdx] : 0;
 
@@ -1350,7 +1445,7 @@ TAKErr GLRenderBatch2::addIndexedTriangleStripImpl(const std::size_t size, const
     ((unsigned char *)&vertexConst)[1] = (unsigned char)(g*255.0f);
     ((unsigned char *)&vertexConst)[2] = (unsigned char)(b*255.0f);
     ((unsigned char *)&vertexConst)[3] = (unsigned char)(a*255.0f);
-    (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+    (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
 
     const auto *vertexCoordsPtr = reinterpret_cast<const uint8_t *>(vertexCoords);
     const auto *texCoordsPtr = reinterpret_cast<const uint8_t *>(texCoords);
@@ -1378,11 +1473,11 @@ TAKErr GLRenderBatch2::addIndexedTriangleStripImpl(const std::size_t size, const
             continue;
         }
 
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[i - 2]));
+        code = putIndex(indexBuffer, indexSize, indexOff + indices[i - 2]);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[i - 1]));
+        code = putIndex(indexBuffer, indexSize, indexOff + indices[i - 1]);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[i]));
+        code = putIndex(indexBuffer, indexSize, indexOff + indices[i]);
         TE_CHECKBREAK_CODE(code);
     }
     TE_CHECKRETURN_CODE(code);
@@ -1403,7 +1498,7 @@ TAKErr GLRenderBatch2::addTriangleFanImpl(const std::size_t size, const std::siz
     ((unsigned char *)&vertexConst)[1] = (unsigned char)(g*255.0f);
     ((unsigned char *)&vertexConst)[2] = (unsigned char)(b*255.0f);
     ((unsigned char *)&vertexConst)[3] = (unsigned char)(a*255.0f);
-    (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+    (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
 
     const bool transformPoints = hasBits(this->batchHints, GLRenderBatch2::SoftwareTransforms);
     if(transformPoints)
@@ -1430,7 +1525,7 @@ TAKErr GLRenderBatch2::addTriangleFanImpl(const std::size_t size, const std::siz
     bool isFirstTriangle = true;
     for (std::size_t i = 0; i < numTriangles; i++) {
         if (renderBuffer.remaining() < (vertexSize * 3) ||
-            indexBuffer.remaining()/2u < 3) {
+            indexBuffer.remaining()/indexSize < 3) {
 
             // flush the buffer, taking care to record and rebind the texture
             // ID.
@@ -1443,7 +1538,7 @@ TAKErr GLRenderBatch2::addTriangleFanImpl(const std::size_t size, const std::siz
                 code = bindTexture(&texUnitIdx, texId);
                 TE_CHECKBREAK_CODE(code);
                 // update vertex const data
-                (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+                (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
             }
         }
 
@@ -1481,11 +1576,11 @@ TAKErr GLRenderBatch2::addTriangleFanImpl(const std::size_t size, const std::siz
         texCoordsPtr += tcStride;
 
         // indices
-        code = indexBuffer.put(static_cast<uint16_t>(firstOff));
+        code = putIndex(indexBuffer, indexSize, firstOff);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff - 1u));
+        code = putIndex(indexBuffer, indexSize, indexOff - 1u);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff));
+        code = putIndex(indexBuffer, indexSize, indexOff);
         TE_CHECKBREAK_CODE(code);
 
         indexOff++;
@@ -1516,7 +1611,7 @@ TAKErr GLRenderBatch2::addIndexedTriangleFanImpl(const std::size_t size, const s
     std::size_t indexOff = renderBuffer.position() / vertexSize;
 
     if (renderBuffer.remaining() < ((count/size) * vertexSize) ||
-        indexBuffer.remaining()/2u < ((indexCount - 2u) * 3u)) {
+        indexBuffer.remaining()/indexSize < ((indexCount - 2u) * 3u)) {
 
         const int texId = texCoords ? texUnitIdxToTexId[texUnitIdx] : 0;
 
@@ -1535,7 +1630,7 @@ TAKErr GLRenderBatch2::addIndexedTriangleFanImpl(const std::size_t size, const s
     ((unsigned char *)&vertexConst)[1] = (unsigned char)(g*255.0f);
     ((unsigned char *)&vertexConst)[2] = (unsigned char)(b*255.0f);
     ((unsigned char *)&vertexConst)[3] = (unsigned char)(a*255.0f);
-    (*(float *)(((unsigned char *)&vertexConst) + 4)) = (float)texUnitIdx;
+    (*(float *)(((unsigned char *)&vertexConst) + 4)) = getVertexTexUnit(texUnitIdx);
 
     const auto *vertexCoordsPtr = reinterpret_cast<const uint8_t *>(vertexCoords);
     const auto *texCoordsPtr = reinterpret_cast<const uint8_t *>(texCoords);
@@ -1558,11 +1653,11 @@ TAKErr GLRenderBatch2::addIndexedTriangleFanImpl(const std::size_t size, const s
 
     const std::size_t numTriangles = indexCount - 2u;
     for (std::size_t i = 0; i < numTriangles; i++) {
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[0]));
+        code = putIndex(indexBuffer, indexSize, indexOff + indices[0]);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[i - 1u]));
+        code = putIndex(indexBuffer, indexSize, indexOff + indices[i - 1u]);
         TE_CHECKBREAK_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + indices[i]));
+        code = putIndex(indexBuffer, indexSize, indexOff + indices[i]);
         TE_CHECKBREAK_CODE(code);
     }
     TE_CHECKRETURN_CODE(code);
@@ -1646,7 +1741,7 @@ TAKErr GLRenderBatch2::addLineLoop(const std::size_t size, const std::size_t vSt
 
     if (numLines > 0) {
         if (renderBuffer.remaining() < (vertexSize * 4) ||
-            indexBuffer.remaining()/2u < VERTICES_PER_SPRITE) {
+            indexBuffer.remaining()/indexSize < VERTICES_PER_SPRITE) {
 
             code = flush();
             TE_CHECKRETURN_CODE(code);
@@ -1677,6 +1772,7 @@ TAKErr GLRenderBatch2::addLineLoop(const std::size_t size, const std::size_t vSt
 
             addLine2d_2dImpl(renderBuffer,
                              indexBuffer,
+                             indexSize,
                              renderBuffer.position() / vertexSize,
                              vertexConst,
                              width / viewportHeight,
@@ -1689,6 +1785,7 @@ TAKErr GLRenderBatch2::addLineLoop(const std::size_t size, const std::size_t vSt
 
             addLine3dImpl(renderBuffer,
                           indexBuffer,
+                          indexSize,
                           renderBuffer.position() / vertexSize,
                           vertexConst,
                           width / viewportHeight,
@@ -1715,7 +1812,7 @@ TAKErr GLRenderBatch2::addTriangles(const std::size_t size, const std::size_t vS
 {
     TAKErr code(TE_Ok);
 
-    if (indexCount > indexBuffer.limit()/2u) {
+    if (indexCount > indexBuffer.limit()/indexSize) {
         Logger_log(TELL_Error, "Too many indices");
         return TE_InvalidArg;
     }
@@ -1727,7 +1824,7 @@ TAKErr GLRenderBatch2::addTriangles(const std::size_t size, const std::size_t vS
         return TE_InvalidArg;
     }
 
-    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/2u < indexCount) {
+    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/indexSize < indexCount) {
         code = flush();
         TE_CHECKRETURN_CODE(code);
     }
@@ -1775,7 +1872,7 @@ TAKErr GLRenderBatch2::addTrianglesSprite(const std::size_t size, const std::siz
     TAKErr code(TE_Ok);
 
     const std::size_t requiredIndices = indexCount;
-    if (requiredIndices > indexBuffer.limit()/2u) {
+    if (requiredIndices > indexBuffer.limit()/indexSize) {
         Logger_log(TELL_Error, "too many indices specified");
         return TE_InvalidArg;
     }
@@ -1787,7 +1884,7 @@ TAKErr GLRenderBatch2::addTrianglesSprite(const std::size_t size, const std::siz
         return TE_InvalidArg;
     }
 
-    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/2u < requiredIndices) {
+    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/indexSize < requiredIndices) {
         code = flush();
         TE_CHECKRETURN_CODE(code);
     }
@@ -1829,7 +1926,7 @@ TAKErr GLRenderBatch2::addTriangleStripSprite(const std::size_t size, const std:
     TAKErr code(TE_Ok);
 
     const std::size_t requiredIndices = (indexCount - 2) * 3;
-    if (requiredIndices > indexBuffer.limit()/2u) {
+    if (requiredIndices > indexBuffer.limit()/indexSize) {
         Logger_log(TELL_Error, "Too many indices");
         return TE_InvalidArg;
     }
@@ -1841,7 +1938,7 @@ TAKErr GLRenderBatch2::addTriangleStripSprite(const std::size_t size, const std:
         return TE_InvalidArg;
     }
 
-    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/2u < requiredIndices) {
+    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/indexSize < requiredIndices) {
         code = flush();
         TE_CHECKRETURN_CODE(code);
     }
@@ -1866,7 +1963,7 @@ TAKErr GLRenderBatch2::addTriangleFan(const std::size_t size, const std::size_t
     TAKErr code(TE_Ok);
 
     const std::size_t requiredIndices = (count - 2) * 3;
-    if (requiredIndices > indexBuffer.limit()/2u) {
+    if (requiredIndices > indexBuffer.limit()/indexSize) {
         Logger_log(TELL_Error, "Too many indices");
         return TE_InvalidArg;
     }
@@ -1878,7 +1975,7 @@ TAKErr GLRenderBatch2::addTriangleFan(const std::size_t size, const std::size_t
         return TE_InvalidArg;
     }
 
-    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/2u < requiredIndices) {
+    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/indexSize < requiredIndices) {
         code = flush();
         TE_CHECKRETURN_CODE(code);
     }
@@ -1917,7 +2014,7 @@ TAKErr GLRenderBatch2::addTriangleFanSprite(const std::size_t size, const std::s
     TAKErr code(TE_Ok);
 
     const std::size_t requiredIndices = (indexCount - 2) * 3;
-    if (requiredIndices > indexBuffer.limit()/2u) {
+    if (requiredIndices > indexBuffer.limit()/indexSize) {
         Logger_log(TELL_Error, "Too many indices");
         return TE_InvalidArg;
     }
@@ -1929,7 +2026,7 @@ TAKErr GLRenderBatch2::addTriangleFanSprite(const std::size_t size, const std::s
         return TE_InvalidArg;
     }
 
-    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/2u < requiredIndices) {
+    if (renderBuffer.remaining() < requiredVertexSize || indexBuffer.remaining()/indexSize < requiredIndices) {
         code = flush();
         TE_CHECKRETURN_CODE(code);
     }
@@ -1968,6 +2065,16 @@ void TAK::Engine::Renderer::GLRenderBatch2_setBatchTextureUnitLimit(const std::s
 #endif
 }
 
+GLenum TAK::Engine::Renderer::GLRenderBatch2_getIndexType(const std::size_t vertexCapacity, const bool uintIndexSupported) NOTHROWS
+{
+    return (vertexCapacity > MAX_VERTICES_16 && uintIndexSupported) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+}
+
+std::size_t TAK::Engine::Renderer::GLRenderBatch2_getMaxVertices(const std::size_t vertexCapacity, const GLenum indexType) NOTHROWS
+{
+    return (indexType == GL_UNSIGNED_INT) ? vertexCapacity : std::min(vertexCapacity, (std::size_t)MAX_VERTICES_16);
+}
+
 /*********************************************************************/
 // Other private utilties
 
@@ -1986,9 +2093,10 @@ TAKErr GLRenderBatch2::bindTexture(int *value, const int textureId) NOTHROWS
     }
 
     int * const texUnitTexIds = texUnitIdxToTexId.get();
+    bool * const texUnitDistanceField = texUnitIdxIsDistanceField.get();
 
     for (int i = numActiveTexUnits; i > 0; i--) {
-        if (texUnitTexIds[i-1u] == textureId) {
+        if (texUnitTexIds[i-1u] == textureId && texUnitDistanceField[i-1u] == distanceField) {
             *value = i-1;
             return code;
         }
@@ -2008,12 +2116,20 @@ TAKErr GLRenderBatch2::bindTexture(int *value, const int textureId) NOTHROWS
     glActiveTexture(GL_TEXTURE_UNITS[retval]);
 #endif
     glBindTexture(GL_TEXTURE_2D, textureId);
+    texUnitDistanceField[numActiveTexUnits] = distanceField;
     texUnitTexIds[numActiveTexUnits++] = textureId;
 
     *value = retval;
     return code;
 }
 
+float GLRenderBatch2::getVertexTexUnit(const int texUnitIdx) const NOTHROWS
+{
+    if (texUnitIdx >= 0 && texUnitIdxIsDistanceField[texUnitIdx])
+        return (float)(-(texUnitIdx + 2));
+    return (float)texUnitIdx;
+}
+
 void GLRenderBatch2::validateMVP() NOTHROWS
 {
     if(!mvpDirty)
@@ -2074,14 +2190,10 @@ void GLRenderBatch2::validateMVP() NOTHROWS
     mvpDirty = false;
 }
 
-TAKErr GLRenderBatch2::batchProgramInit(batch_render_program_t *program, const bool textured, const char *vertShaderSrc, const char *fragShaderSrc) NOTHROWS
+TAKErr GLRenderBatch2::batchProgramInit(batch_render_program_t *program, const bool textured, const ShaderProgram &p) NOTHROWS
 {
     TAKErr code(TE_Ok);
 
-    ShaderProgram p;
-    code = GLSLUtil_createProgram(&p, vertShaderSrc, fragShaderSrc);
-    TE_CHECKRETURN_CODE(code);
-
     program->handle = p.program;
     glUseProgram(p.program);
 
@@ -2107,7 +2219,6 @@ TAKErr GLRenderBatch2::batchProgramInit(batch_render_program_t *program, const b
 
     glDeleteShader(p.vertShader);
     glDeleteShader(p.fragShader);
-    p.program = GL_FALSE;
 
     return code;
 }
@@ -2217,6 +2328,7 @@ namespace
 
     TAKErr addLine2d_2dImpl(MemBuffer2 &pfRenderBuffer,
                             MemBuffer2 &indexBuffer,
+                            const std::size_t indexSize,
                             const std::size_t indexOff,
                             const uint64_t vertexConst,
                             const float normalizedWidthX,
@@ -2319,38 +2431,38 @@ namespace
 
         // indices
 
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 0)); // A
+        code = putIndex(indexBuffer, indexSize, indexOff + 0); // A
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 3)); // D
+        code = putIndex(indexBuffer, indexSize, indexOff + 3); // D
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 1)); // B
+        code = putIndex(indexBuffer, indexSize, indexOff + 1); // B
         TE_CHECKRETURN_CODE(code);
 
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 3)); // D
+        code = putIndex(indexBuffer, indexSize, indexOff + 3); // D
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 1)); // B
+        code = putIndex(indexBuffer, indexSize, indexOff + 1); // B
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 2)); // C
+        code = putIndex(indexBuffer, indexSize, indexOff + 2); // C
         TE_CHECKRETURN_CODE(code);
 
         return code;
     }
 
-    void addLine2d_3dImpl(MemBuffer2 &pfRenderBuffer,
+    TAKErr addLine2d_3dImpl(MemBuffer2 &pfRenderBuffer,
                        MemBuffer2 &indexBuffer,
+                       const std::size_t indexSize,
                        const std::size_t indexOff,
                        const uint64_t vertexConst,
                        const float widthX,
                        const float widthY,
                        const float x0,
                        const float y0,
-                       const float z0,
                        const float x1,
-                       const float y1,
-                       const float z1) NOTHROWS
+                       const float y1) NOTHROWS
     {
-        addLine3dImpl(pfRenderBuffer,
+        return addLine3dImpl(pfRenderBuffer,
                       indexBuffer,
+                      indexSize,
                       indexOff,
                       vertexConst,
                       widthX, widthY,
@@ -2360,6 +2472,7 @@ namespace
 
     TAKErr addLine3dImpl(MemBuffer2 &pfRenderBuffer,
                          MemBuffer2 &indexBuffer,
+                         const std::size_t indexSize,
                          const std::size_t indexOff,
                          const uint64_t vertexConst,
                          const float normalizedWidthX,
@@ -2472,18 +2585,18 @@ namespace
 
         // indices
 
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 0)); // A
+        code = putIndex(indexBuffer, indexSize, indexOff + 0); // A
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 3)); // D
+        code = putIndex(indexBuffer, indexSize, indexOff + 3); // D
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 1)); // B
+        code = putIndex(indexBuffer, indexSize, indexOff + 1); // B
         TE_CHECKRETURN_CODE(code);
 
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 3)); // D
+        code = putIndex(indexBuffer, indexSize, indexOff + 3); // D
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 1)); // B
+        code = putIndex(indexBuffer, indexSize, indexOff + 1); // B
         TE_CHECKRETURN_CODE(code);
-        code = indexBuffer.put(static_cast<uint16_t>(indexOff + 2)); // C
+        code = putIndex(indexBuffer, indexSize, indexOff + 2); // C
         TE_CHECKRETURN_CODE(code);
 
         return code;
@@ -2740,6 +2853,30 @@ namespace
         return i;
     }
 
+    std::size_t maxIndexSize(const std::size_t cap) NOTHROWS
+    {
+        return (cap > MAX_VERTICES_16) ? 4u : 2u;
+    }
+
+    bool isUintIndexSupported() NOTHROWS
+    {
+        // core in GLES3, otherwise requires OES_element_index_uint
+        const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+        int major = 0;
+        if (version && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3)
+            return true;
+        const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+        return extensions && strstr(extensions, "GL_OES_element_index_uint");
+    }
+
+    TAKErr putIndex(MemBuffer2 &indexBuffer, const std::size_t indexSize, const std::size_t index) NOTHROWS
+    {
+        if (indexSize == 4u)
+            return indexBuffer.put(static_cast<uint32_t>(index));
+        else
+            return indexBuffer.put(static_cast<uint16_t>(index));
+    }
+
     TAKErr getAddVertexFunction(addVertexFn *value, const std::size_t size, const bool texCoords, const int hints) NOTHROWS
     {
         TAKErr code(TE_Ok);
@@ -7,6 +7,7 @@
 
 #include "port/Platform.h"
 #include "renderer/GL.h"
+#include "renderer/GLStreamBuffer.h"
 #include "util/Error.h"
 #include "util/MemBuffer2.h"
 #include "util/Memory.h"
@@ -26,7 +27,7 @@
 namespace TAK {
     namespace Engine {
         namespace Renderer {
-
+            struct ShaderProgram;
 
             class ENGINE_API GLRenderBatch2
             {
@@ -73,6 +74,14 @@ namespace TAK {
                 };
 
             public:
+                /**
+                 * @param capacity  The maximum number of vertices batched
+                 *                  before a flush. Capacities over 65535
+                 *                  use 32-bit indices if the context
+                 *                  supports them (GLES3 or
+                 *                  `GL_OES_element_index_uint`), otherwise
+                 *                  the batch is limited to 65535 vertices.
+                 */
                 GLRenderBatch2(const std::size_t capacity) NOTHROWS;
                 ~GLRenderBatch2() NOTHROWS;
             private :
@@ -88,6 +97,14 @@ namespace TAK {
                 Util::TAKErr popMatrix(const int mode) NOTHROWS;
             public :
                 Util::TAKErr setLineWidth(const float width) NOTHROWS;
+                /**
+                 * Specifies whether subsequently batched textures hold
+                 * signed distance fields, as produced by
+                 * `DistanceField_create`. Distance field textures are
+                 * thresholded in the shader, so they stay sharp at any
+                 * scale.
+                 */
+                Util::TAKErr setDistanceField(const bool distanceField) NOTHROWS;
             public :
                 Util::TAKErr batch(const int texId,
                                    const int mode,
@@ -162,6 +179,8 @@ namespace TAK {
                 Util::TAKErr flush() NOTHROWS;
 
                 Util::TAKErr bindTexture(int *value, const int textureId) NOTHROWS;
+                /** returns the texture unit attribute value for the vertex; distance field units are encoded as `-(unit+2)` */
+                float getVertexTexUnit(const int texUnitIdx) const NOTHROWS;
                 Util::TAKErr addLinesImpl(const std::size_t size, const float width, const std::size_t numLines, const std::size_t vStride, const float *lines, const int step, const uint64_t vertexConst) NOTHROWS;
                 Util::TAKErr addTrianglesImpl(const std::size_t size, const std::size_t vStride, const float *vertexCoords, const std::size_t count, const std::size_t tcStride, const float *texCoords, int texUnitIdx, const float r, const float g, const float b, const float a) NOTHROWS;
                 Util::TAKErr addIndexedTrianglesImpl(const std::size_t size, const std::size_t vStride, const float *vertexCoords, const std::size_t count, const unsigned short *indices, const std::size_t indexCount, const std::size_t tcStride, const float *texCoords, int texUnitIdx, const float r, const float g, const float b, const float a) NOTHROWS;
@@ -171,10 +190,19 @@ namespace TAK {
                 Util::TAKErr addIndexedTriangleFanImpl(const std::size_t size, const std::size_t vStride, const float *vertexCoords, const std::size_t count, const unsigned short *indices, const std::size_t indexCount, const std::size_t tcStride, const float *texCoords, int texUnitIdx, const float r, const float g, const float b, const float a) NOTHROWS;
                 void validateMVP() NOTHROWS;
             private :
-                static Util::TAKErr batchProgramInit(batch_render_program_t *program, const bool textured, const char *vertShaderSrc, const char *fragShaderSrc) NOTHROWS;
+                static Util::TAKErr batchProgramInit(batch_render_program_t *program, const bool textured, const ShaderProgram &p) NOTHROWS;
             private:
+                /** maximum number of batched vertices, as requested on construction */
+                const std::size_t vertexCapacity;
+                /** `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`; determined on first `begin()` */
+                GLenum indexType;
+                /** size of an index, in bytes */
+                std::size_t indexSize;
                 Util::MemBuffer2 renderBuffer;
                 Util::MemBuffer2 indexBuffer;
+                /** VBO ring buffers that `renderBuffer` and `indexBuffer` are streamed through on flush */
+                GLStreamBuffer vertexStream;
+                GLStreamBuffer indexStream;
                 MatrixStack projection;
                 MatrixStack modelView;
                 MatrixStack texture;
@@ -188,10 +216,12 @@ namespace TAK {
                 batch_render_program_t texturedProgram3d;
 
                 Util::array_ptr<int> texUnitIdxToTexId;
+                Util::array_ptr<bool> texUnitIdxIsDistanceField;
                 int numActiveTexUnits;
                 int originalTextureUnit;
 
                 int batchHints;
+                bool distanceField;
 
                 float modelViewProjection[16];
                 bool mvpDirty;
@@ -199,6 +229,20 @@ namespace TAK {
 
             ENGINE_API std::size_t GLRenderBatch2_getBatchTextureUnitLimit() NOTHROWS;
             ENGINE_API void GLRenderBatch2_setBatchTextureUnitLimit(const std::size_t limit) NOTHROWS;
+
+            /**
+             * Returns the index type a batch of the specified vertex
+             * capacity draws with: `GL_UNSIGNED_INT` if the capacity exceeds
+             * what may be addressed with 16-bit indices and 32-bit indices
+             * are supported, `GL_UNSIGNED_SHORT` otherwise.
+             */
+            ENGINE_API GLenum GLRenderBatch2_getIndexType(const std::size_t vertexCapacity, const bool uintIndexSupported) NOTHROWS;
+            /**
+             * Returns the number of vertices a batch of the specified vertex
+             * capacity may hold before flushing when drawing with the
+             * specified index type.
+             */
+            ENGINE_API std::size_t GLRenderBatch2_getMaxVertices(const std::size_t vertexCapacity, const GLenum indexType) NOTHROWS;
         }
     }
 }
@@ -2,6 +2,7 @@
 #include "renderer/GLES20FixedPipeline.h"
 #include "renderer/core/GLMapRenderGlobals.h"
 #include "renderer/GL.h"
+#include "renderer/GLPerformanceCounters.h"
 #include <sstream>
 
 #include <cmath>
@@ -360,6 +361,7 @@ namespace atakmap {
                     static_cast<GLsizei>(indexBuffer->used()),
                     GL_UNSIGNED_SHORT,
                     indexBuffer->base);
+                TAK::Engine::Renderer::GLPerformanceCounters_draw(GL_TRIANGLES, indexBuffer->used());
 
                 glDisableVertexAttribArray(aVertexCoordsHandle);
                 if (textured)
@@ -1,12 +1,25 @@
 #include "renderer/GLSLUtil.h"
 
-#include "renderer/GL.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
 
+#include "port/STLVectorAdapter.h"
+#include "port/String.h"
+#include "renderer/GL.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/DataInput2.h"
+#include "util/DataOutput2.h"
+#include "util/IO2.h"
 #include "util/Logging2.h"
 #include "util/Memory.h"
 
 using namespace TAK::Engine::Renderer;
 
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
 // Use the following for debugging
@@ -14,9 +27,41 @@ using namespace TAK::Engine::Util;
 // Use this for production
 #define CHECKERRS()
 
+#define GLSLUTIL_PROGRAM_CACHE_MAGIC 0x42505445u // 'ETPB'
+#define GLSLUTIL_PROGRAM_CACHE_VERSION 1u
+// prefix for the per driver subdirectories; only these are ever purged
+#define GLSLUTIL_PROGRAM_CACHE_DIR_PREFIX "glprogram-"
+
 namespace
 {
+    struct ProgramCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t vertLength;
+        uint32_t fragLength;
+        uint32_t binaryFormat;
+        uint32_t binaryLength;
+    };
+
+    struct ProgramCache
+    {
+        Mutex mutex;
+        std::string directory;
+        /** the directory for the current driver, resolved on first use */
+        std::string driverDirectory;
+        bool resolved {false};
+    };
+
     void checkGLErrors(int line) NOTHROWS;
+    TAKErr checkCompileStatus(const int shader, const char *src) NOTHROWS;
+    TAKErr checkLinkStatus(const int program, const int vertShader, const int fragShader) NOTHROWS;
+    uint64_t hash(uint64_t seed, const char *str) NOTHROWS;
+    ProgramCache &programCache() NOTHROWS;
+    TAKErr getProgramCacheDirectory(std::string &value) NOTHROWS;
+    TAKErr loadProgram(int *value, const char *path, const ProgramCacheHeader &key) NOTHROWS;
+    void storeProgram(const char *path, const int program, const ProgramCacheHeader &key) NOTHROWS;
 }
 
 TAKErr TAK::Engine::Renderer::GLSLUtil_loadShader(int *value, const char *src, const int type) NOTHROWS
@@ -31,43 +76,15 @@ TAKErr TAK::Engine::Renderer::GLSLUtil_loadShader(int *value, const char *src, c
     CHECKERRS();
     glCompileShader(n);
     CHECKERRS();
-    int rc = 0;
-    glGetShaderiv(n, GL_COMPILE_STATUS, &rc);
-    CHECKERRS();
-    if (rc == 0) {
-        array_ptr<char> msg(nullptr);
-        int msgLen;
-        glGetShaderiv(n, GL_INFO_LOG_LENGTH, &msgLen);
-        if(msgLen) {
-            msg.reset(new char[msgLen+1]);
-            glGetShaderInfoLog(n, msgLen+1, nullptr, msg.get());
-        }
-        Logger_log(LogLevel::TELL_Error, "Failed to compile shader %d, msg: %s", n, msg.get());
-        Logger_log(LogLevel::TELL_Error, "Failed to compile shader %d, src:\n%s", n, src);
-        msg.reset();
-        glDeleteShader(n);
-        return TE_Err;
-    }
+    code = checkCompileStatus(n, src);
+    TE_CHECKRETURN_CODE(code);
     *value = n;
     return code;
 }
 
 TAKErr TAK::Engine::Renderer::GLSLUtil_createProgram(ShaderProgram *program, const char *vertSrc, const char *fragSrc) NOTHROWS
 {
-    TAKErr code(TE_Ok);
-
-    int vertShader;
-    code = GLSLUtil_loadShader(&vertShader, vertSrc, GL_VERTEX_SHADER);
-    TE_CHECKRETURN_CODE(code);
-
-    int fragShader;
-    code = GLSLUtil_loadShader(&fragShader, fragSrc, GL_FRAGMENT_SHADER);
-    TE_CHECKRETURN_CODE(code);
-
-    code = GLSLUtil_createProgram(program, vertShader, fragShader);
-    TE_CHECKRETURN_CODE(code);
-
-    return code;
+    return GLSLUtil_createPrograms(program, &vertSrc, &fragSrc, 1u);
 }
 
 TAKErr TAK::Engine::Renderer::GLSLUtil_createProgram(ShaderProgram *program, const int vertShader, const int fragShader) NOTHROWS
@@ -84,22 +101,8 @@ TAKErr TAK::Engine::Renderer::GLSLUtil_createProgram(ShaderProgram *program, con
     CHECKERRS();
     glLinkProgram(n);
     CHECKERRS();
-    int ok = 0;
-    glGetProgramiv(n, GL_LINK_STATUS, &ok);
-    CHECKERRS();
-    if (ok == 0) {
-        array_ptr<char> msg(nullptr);
-        int msgLen;
-        glGetProgramiv(n, GL_INFO_LOG_LENGTH, &msgLen);
-        if(msgLen) {
-            msg.reset(new char[msgLen+1]);
-            glGetProgramInfoLog(n, msgLen+1, nullptr, msg.get());
-        }
-        Logger_log(TELL_Error, "Failed to create program, vertShader=%d fragShader=%d\nmsg: %s", vertShader, fragShader, msg.get());
-        msg.reset();
-        glDeleteProgram(n);
-        return TE_Err;
-    }
+    code = checkLinkStatus(n, vertShader, fragShader);
+    TE_CHECKRETURN_CODE(code);
 
     program->program = n;
     program->vertShader = vertShader;
@@ -107,6 +110,138 @@ TAKErr TAK::Engine::Renderer::GLSLUtil_createProgram(ShaderProgram *program, con
     return code;
 }
 
+TAKErr TAK::Engine::Renderer::GLSLUtil_createPrograms(ShaderProgram *programs, const char * const *vertSrcs, const char * const *fragSrcs, const std::size_t count) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!programs || !vertSrcs || !fragSrcs)
+        return TE_InvalidArg;
+
+    std::string cacheDir;
+    const bool cached = (getProgramCacheDirectory(cacheDir) == TE_Ok);
+
+    std::vector<ProgramCacheHeader> keys(count);
+    std::vector<std::string> paths(count);
+    std::vector<bool> loaded(count, false);
+
+    // load cached binaries and submit all remaining shaders for compilation
+    // before blocking on any status query
+    for (std::size_t i = 0u; i < count; i++) {
+        programs[i].program = GL_NONE;
+        programs[i].vertShader = GL_NONE;
+        programs[i].fragShader = GL_NONE;
+        if (!vertSrcs[i] || !fragSrcs[i]) {
+            code = TE_InvalidArg;
+            break;
+        }
+
+        if (cached) {
+            keys[i].key = hash(hash(0xcbf29ce484222325ULL, vertSrcs[i]) ^ 0xFFu, fragSrcs[i]);
+            keys[i].vertLength = (uint32_t)strlen(vertSrcs[i]);
+            keys[i].fragLength = (uint32_t)strlen(fragSrcs[i]);
+
+            char name[32];
+            snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)keys[i].key);
+            paths[i] = cacheDir + Platform_pathSep() + name;
+            loaded[i] = (loadProgram(&programs[i].program, paths[i].c_str(), keys[i]) == TE_Ok);
+            if (loaded[i])
+                continue;
+        }
+
+        programs[i].vertShader = glCreateShader(GL_VERTEX_SHADER);
+        programs[i].fragShader = glCreateShader(GL_FRAGMENT_SHADER);
+        CHECKERRS();
+        if (programs[i].vertShader == GL_FALSE || programs[i].fragShader == GL_FALSE) {
+            code = TE_Err;
+            break;
+        }
+        glShaderSource(programs[i].vertShader, 1, &vertSrcs[i], nullptr);
+        glCompileShader(programs[i].vertShader);
+        glShaderSource(programs[i].fragShader, 1, &fragSrcs[i], nullptr);
+        glCompileShader(programs[i].fragShader);
+        CHECKERRS();
+    }
+
+    // link
+    for (std::size_t i = 0u; i < count && code == TE_Ok; i++) {
+        if (loaded[i])
+            continue;
+
+        // the shader has been deleted on failure
+        code = checkCompileStatus(programs[i].vertShader, vertSrcs[i]);
+        if (code != TE_Ok) {
+            programs[i].vertShader = GL_NONE;
+            break;
+        }
+        code = checkCompileStatus(programs[i].fragShader, fragSrcs[i]);
+        if (code != TE_Ok) {
+            programs[i].fragShader = GL_NONE;
+            break;
+        }
+
+        programs[i].program = glCreateProgram();
+        CHECKERRS();
+        if (programs[i].program == GL_FALSE) {
+            code = TE_Err;
+            break;
+        }
+        glAttachShader(programs[i].program, programs[i].vertShader);
+        glAttachShader(programs[i].program, programs[i].fragShader);
+#if TE_GLES_VERSION >= 3
+        if (cached)
+            glProgramParameteri(programs[i].program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+        glLinkProgram(programs[i].program);
+        CHECKERRS();
+    }
+
+    for (std::size_t i = 0u; i < count && code == TE_Ok; i++) {
+        if (loaded[i])
+            continue;
+
+        code = checkLinkStatus(programs[i].program, programs[i].vertShader, programs[i].fragShader);
+        if (code != TE_Ok) {
+            // the program has been deleted on failure
+            programs[i].program = GL_NONE;
+            break;
+        }
+        if (cached)
+            storeProgram(paths[i].c_str(), programs[i].program, keys[i]);
+    }
+
+    if (code != TE_Ok) {
+        for (std::size_t i = 0u; i < count; i++) {
+            if (programs[i].program != GL_NONE)
+                glDeleteProgram(programs[i].program);
+            if (programs[i].vertShader != GL_NONE)
+                glDeleteShader(programs[i].vertShader);
+            if (programs[i].fragShader != GL_NONE)
+                glDeleteShader(programs[i].fragShader);
+            programs[i].program = GL_NONE;
+            programs[i].vertShader = GL_NONE;
+            programs[i].fragShader = GL_NONE;
+        }
+    }
+
+    return code;
+}
+
+TAKErr TAK::Engine::Renderer::GLSLUtil_setProgramCacheDirectory(const char *path) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    ProgramCache &cache = programCache();
+    Lock lock(cache.mutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    const std::string directory(path ? path : "");
+    if (directory == cache.directory)
+        return code;
+    cache.directory = directory;
+    cache.driverDirectory.clear();
+    cache.resolved = false;
+    return code;
+}
+
 namespace
 {
     void checkGLErrors(int line) NOTHROWS
@@ -125,4 +260,225 @@ namespace
             }
         }
     }
+
+    TAKErr checkCompileStatus(const int shader, const char *src) NOTHROWS
+    {
+        int rc = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &rc);
+        CHECKERRS();
+        if (rc == 0) {
+            array_ptr<char> msg(nullptr);
+            int msgLen;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &msgLen);
+            if(msgLen) {
+                msg.reset(new char[msgLen+1]);
+                glGetShaderInfoLog(shader, msgLen+1, nullptr, msg.get());
+            }
+            Logger_log(LogLevel::TELL_Error, "Failed to compile shader %d, msg: %s", shader, msg.get());
+            Logger_log(LogLevel::TELL_Error, "Failed to compile shader %d, src:\n%s", shader, src);
+            msg.reset();
+            glDeleteShader(shader);
+            return TE_Err;
+        }
+        return TE_Ok;
+    }
+
+    TAKErr checkLinkStatus(const int program, const int vertShader, const int fragShader) NOTHROWS
+    {
+        int ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        CHECKERRS();
+        if (ok == 0) {
+            array_ptr<char> msg(nullptr);
+            int msgLen;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &msgLen);
+            if(msgLen) {
+                msg.reset(new char[msgLen+1]);
+                glGetProgramInfoLog(program, msgLen+1, nullptr, msg.get());
+            }
+            Logger_log(TELL_Error, "Failed to create program, vertShader=%d fragShader=%d\nmsg: %s", vertShader, fragShader, msg.get());
+            msg.reset();
+            glDeleteProgram(program);
+            return TE_Err;
+        }
+        return TE_Ok;
+    }
+
+    // FNV-1a
+    uint64_t hash(uint64_t seed, const char *str) NOTHROWS
+    {
+        uint64_t value = seed;
+        if (str) {
+            for (const char *c = str; *c; c++) {
+                value ^= (uint8_t)*c;
+                value *= 0x100000001b3ULL;
+            }
+        }
+        return value;
+    }
+
+    ProgramCache &programCache() NOTHROWS
+    {
+        static ProgramCache cache;
+        return cache;
+    }
+
+    TAKErr getProgramCacheDirectory(std::string &value) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        ProgramCache &cache = programCache();
+        Lock lock(cache.mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+
+        if (cache.directory.empty())
+            return TE_Unsupported;
+        if (!cache.resolved) {
+            cache.resolved = true;
+#if TE_GLES_VERSION >= 3
+            int numFormats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+            if (numFormats < 1)
+                return TE_Unsupported;
+
+            // any change to the driver selects a new directory
+            uint64_t driver = 0xcbf29ce484222325ULL;
+            const GLenum strings[4u] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+            for (std::size_t i = 0u; i < 4u; i++)
+                driver = hash(driver, reinterpret_cast<const char *>(glGetString(strings[i])));
+            char name[32];
+            snprintf(name, sizeof(name), GLSLUTIL_PROGRAM_CACHE_DIR_PREFIX "%016llx", (unsigned long long)driver);
+
+            // purge the binaries for other drivers. the directory may be
+            // shared with other content; anything not created by the cache
+            // is left alone
+            const std::size_t prefixLength = strlen(GLSLUTIL_PROGRAM_CACHE_DIR_PREFIX);
+            std::vector<String> files;
+            STLVectorAdapter<String> filesAdapter(files);
+            if (IO_listFiles(filesAdapter, cache.directory.c_str()) == TE_Ok) {
+                for (std::size_t i = 0u; i < files.size(); i++) {
+                    String fileName;
+                    if (IO_getName(fileName, files[i]) != TE_Ok || !fileName)
+                        continue;
+                    if (strncmp(fileName, GLSLUTIL_PROGRAM_CACHE_DIR_PREFIX, prefixLength) != 0 || strcmp(fileName, name) == 0)
+                        continue;
+                    bool isDir = false;
+                    IO_isDirectory(&isDir, files[i]);
+                    if (isDir)
+                        IO_delete(files[i]);
+                }
+            }
+
+            const std::string driverDirectory = cache.directory + Platform_pathSep() + name;
+            if (IO_mkdirs(driverDirectory.c_str()) == TE_Ok)
+                cache.driverDirectory = driverDirectory;
+            else
+                Logger_log(TELL_Warning, "GLSLUtil: failed to create program cache directory %s", driverDirectory.c_str());
+#endif
+        }
+        if (cache.driverDirectory.empty())
+            return TE_Unsupported;
+        value = cache.driverDirectory;
+        return code;
+    }
+
+    TAKErr loadProgram(int *value, const char *path, const ProgramCacheHeader &key) NOTHROWS
+    {
+#if TE_GLES_VERSION >= 3
+        TAKErr code(TE_Ok);
+        bool exists = false;
+        if (IO_exists(&exists, path) != TE_Ok || !exists)
+            return TE_InvalidArg;
+
+        std::vector<uint8_t> data;
+        {
+            FileInput2 file;
+            code = file.open(path);
+            TE_CHECKRETURN_CODE(code);
+            const int64_t length = file.length();
+            if (length < (int64_t)sizeof(ProgramCacheHeader))
+                code = TE_Err;
+            if (code == TE_Ok)
+                data.resize((std::size_t)length);
+            std::size_t off = 0u;
+            while (code == TE_Ok && off < data.size()) {
+                std::size_t numRead = 0u;
+                code = file.read(data.data() + off, &numRead, data.size() - off);
+                off += numRead;
+            }
+            file.close();
+        }
+
+        ProgramCacheHeader header;
+        if (code == TE_Ok) {
+            memcpy(&header, data.data(), sizeof(ProgramCacheHeader));
+            if (header.magic != GLSLUTIL_PROGRAM_CACHE_MAGIC ||
+                header.version != GLSLUTIL_PROGRAM_CACHE_VERSION ||
+                header.key != key.key ||
+                header.vertLength != key.vertLength ||
+                header.fragLength != key.fragLength ||
+                header.binaryLength != data.size() - sizeof(ProgramCacheHeader)) {
+
+                code = TE_Err;
+            }
+        }
+
+        int program = GL_NONE;
+        if (code == TE_Ok) {
+            program = glCreateProgram();
+            glProgramBinary(program, header.binaryFormat, data.data() + sizeof(ProgramCacheHeader), header.binaryLength);
+            int ok = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &ok);
+            if (!ok) {
+                glDeleteProgram(program);
+                code = TE_Err;
+            }
+        }
+
+        // the binary is stale or corrupt; it is replaced when the program is relinked
+        if (code != TE_Ok) {
+            IO_delete(path);
+            return code;
+        }
+
+        *value = program;
+        return code;
+#else
+        return TE_Unsupported;
+#endif
+    }
+
+    void storeProgram(const char *path, const int program, const ProgramCacheHeader &key) NOTHROWS
+    {
+#if TE_GLES_VERSION >= 3
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<uint8_t> data(sizeof(ProgramCacheHeader) + (std::size_t)length);
+        GLsizei numWritten = 0;
+        GLenum binaryFormat = GL_NONE;
+        glGetProgramBinary(program, length, &numWritten, &binaryFormat, data.data() + sizeof(ProgramCacheHeader));
+        if (numWritten <= 0)
+            return;
+
+        ProgramCacheHeader header(key);
+        header.magic = GLSLUTIL_PROGRAM_CACHE_MAGIC;
+        header.version = GLSLUTIL_PROGRAM_CACHE_VERSION;
+        header.binaryFormat = binaryFormat;
+        header.binaryLength = (uint32_t)numWritten;
+        memcpy(data.data(), &header, sizeof(ProgramCacheHeader));
+
+        FileOutput2 file;
+        TAKErr code = file.open(path);
+        if (code == TE_Ok)
+            code = file.write(data.data(), sizeof(ProgramCacheHeader) + (std::size_t)numWritten);
+        file.close();
+        if (code != TE_Ok) {
+            Logger_log(TELL_Warning, "GLSLUtil: failed to write program cache entry %s", path);
+            IO_delete(path);
+        }
+#endif
+    }
 }
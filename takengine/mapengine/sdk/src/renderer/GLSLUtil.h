@@ -1,6 +1,8 @@
 #ifndef TAK_ENGINE_RENDERER_GLSLUTIL_H_INCLUDED
 #define TAK_ENGINE_RENDERER_GLSLUTIL_H_INCLUDED
 
+#include <cstddef>
+
 #include "port/Platform.h"
 #include "util/Error.h"
 
@@ -17,6 +19,29 @@ namespace TAK {
             Util::TAKErr GLSLUtil_loadShader(int *value, const char *src, const int type) NOTHROWS;
             Util::TAKErr GLSLUtil_createProgram(ShaderProgram *program, const char *vertSrc, const char *fragSrc) NOTHROWS;
             Util::TAKErr GLSLUtil_createProgram(ShaderProgram *program, const int vertShader, const int fragShader) NOTHROWS;
+            /**
+             * Creates `count` programs from the specified sources. All
+             * shaders are submitted for compilation before any status is
+             * queried, allowing the driver to compile them concurrently.
+             * Programs found in the program cache are loaded from their
+             * binaries; the shaders for those programs are `GL_NONE`. On
+             * failure, no programs are returned.
+             */
+            Util::TAKErr GLSLUtil_createPrograms(ShaderProgram *programs, const char * const *vertSrcs, const char * const *fragSrcs, const std::size_t count) NOTHROWS;
+            /**
+             * Sets the directory where linked program binaries are
+             * cached. Binaries are keyed on their sources and stored per
+             * driver; binaries for any other driver are deleted the first
+             * time a program is created after the directory is set. Only
+             * the per driver subdirectories created by the cache are
+             * deleted, other content in `path` is untouched. If
+             * `nullptr`, caching is disabled.
+             *
+             * `GLMapRenderGlobals` applies the `glslutil.program-cache-dir`
+             * configuration option, if set, when a render context is first
+             * used.
+             */
+            ENGINE_API Util::TAKErr GLSLUtil_setProgramCacheDirectory(const char *path) NOTHROWS;
         }
     }
 }
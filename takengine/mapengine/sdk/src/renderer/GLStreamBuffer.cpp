@@ -0,0 +1,217 @@
+#include "renderer/GLStreamBuffer.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Util;
+
+#define TE_GLSB_ALIGNMENT 16u
+// nanoseconds
+#define TE_GLSB_WAIT_TIMEOUT 1000000000ull
+
+namespace
+{
+    bool overlaps(const std::size_t aBegin, const std::size_t aEnd, const std::size_t bBegin, const std::size_t bEnd) NOTHROWS
+    {
+        return aBegin < bEnd && bBegin < aEnd;
+    }
+
+    bool isES3Context() NOTHROWS
+    {
+#if TE_GLES_VERSION >= 3
+        const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+        if (!version)
+            return false;
+        int major = 0;
+        if (sscanf(version, "OpenGL ES %d", &major) != 1)
+            return false;
+        return major >= 3;
+#else
+        return false;
+#endif
+    }
+}
+
+GLStreamBuffer::GLStreamBuffer(const GLenum target_, const std::size_t capacity_) NOTHROWS :
+    target(target_),
+    capacity(capacity_),
+    handle(GL_NONE),
+    mode(Uninitialized),
+    head(0u),
+    pendingBegin(0u)
+{}
+
+GLStreamBuffer::~GLStreamBuffer() NOTHROWS
+{
+    // GL resources must be released on the GL thread via `release()`
+}
+
+TAKErr GLStreamBuffer::init() NOTHROWS
+{
+    glGenBuffers(1, &handle);
+    if (!handle)
+        return TE_Err;
+    glBindBuffer(target, handle);
+    glBufferData(target, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    mode = isES3Context() ? Mapped : Orphaned;
+    head = 0u;
+    pendingBegin = 0u;
+    return TE_Ok;
+}
+
+TAKErr GLStreamBuffer::upload(std::size_t *offset, const void *data, const std::size_t size) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!offset || (!data && size))
+        return TE_InvalidArg;
+    if (size > capacity)
+        return TE_Unsupported;
+
+    if (mode == Uninitialized) {
+        code = init();
+        TE_CHECKRETURN_CODE(code);
+    } else {
+        glBindBuffer(target, handle);
+    }
+
+    std::size_t off = (head + (TE_GLSB_ALIGNMENT - 1u)) & ~(std::size_t)(TE_GLSB_ALIGNMENT - 1u);
+    const bool wrap = (off + size > capacity);
+    if (wrap)
+        off = 0u;
+
+    if (mode == Mapped) {
+        // never overwrite data that the pending draws have yet to source
+        if (wrap) {
+            if (overlaps(off, off + size, pendingBegin, head))
+                return TE_Unsupported;
+            if (pendingBegin != head) {
+                Fence f;
+                f.begin = pendingBegin;
+                f.end = head;
+#if TE_GLES_VERSION >= 3
+                f.sync = nullptr;
+#endif
+                fences.push_back(f);
+            }
+            pendingBegin = 0u;
+        }
+        code = waitFences(off, off + size);
+        if (code == TE_Ok) {
+#if TE_GLES_VERSION >= 3
+            void *dst = glMapBufferRange(target, static_cast<GLintptr>(off), static_cast<GLsizeiptr>(size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (dst) {
+                memcpy(dst, data, size);
+                if (!glUnmapBuffer(target)) {
+                    // contents were lost; respecify the range
+                    glBufferSubData(target, static_cast<GLintptr>(off), static_cast<GLsizeiptr>(size), data);
+                }
+                head = off + size;
+                *offset = off;
+                return TE_Ok;
+            }
+#endif
+        } else if (code == TE_IllegalState) {
+            // range is still awaiting its fence
+            return TE_Unsupported;
+        } else if (code != TE_Unsupported) {
+            return code;
+        }
+
+        // mapping is not available; discard the fences and orphan from here
+        // on out
+        while (!fences.empty())
+            popFence();
+        mode = Orphaned;
+        off = 0u;
+        glBufferData(target, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    } else if (wrap) {
+        // the driver will allocate new storage; the old storage is freed
+        // once any pending draws have completed
+        glBufferData(target, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    }
+
+    glBufferSubData(target, static_cast<GLintptr>(off), static_cast<GLsizeiptr>(size), data);
+    head = off + size;
+    pendingBegin = off;
+    *offset = off;
+    return TE_Ok;
+}
+
+void GLStreamBuffer::fence() NOTHROWS
+{
+    if (mode != Mapped)
+        return;
+    if (pendingBegin != head) {
+        Fence f;
+        f.begin = pendingBegin;
+        f.end = head;
+#if TE_GLES_VERSION >= 3
+        f.sync = nullptr;
+#endif
+        fences.push_back(f);
+        pendingBegin = head;
+    }
+#if TE_GLES_VERSION >= 3
+    // a single sync covers all ranges awaiting a fence
+    if (fences.empty() || fences.back().sync)
+        return;
+    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    for (auto it = fences.rbegin(); it != fences.rend() && !it->sync; it++)
+        it->sync = sync;
+#endif
+}
+
+void GLStreamBuffer::release() NOTHROWS
+{
+    while (!fences.empty())
+        popFence();
+    if (handle) {
+        glDeleteBuffers(1, &handle);
+        handle = GL_NONE;
+    }
+    mode = Uninitialized;
+    head = 0u;
+    pendingBegin = 0u;
+}
+
+TAKErr GLStreamBuffer::waitFences(const std::size_t begin, const std::size_t end) NOTHROWS
+{
+    // fences signal in order; waiting on the newest overlapping fence
+    // retires every fence before it
+    std::size_t count = 0u;
+    for (std::size_t i = 0u; i < fences.size(); i++) {
+        if (overlaps(begin, end, fences[i].begin, fences[i].end))
+            count = i + 1u;
+    }
+    if (!count)
+        return TE_Ok;
+#if TE_GLES_VERSION >= 3
+    GLsync sync = fences[count - 1u].sync;
+    if (!sync)
+        return TE_IllegalState;
+    GLenum result;
+    do {
+        result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, TE_GLSB_WAIT_TIMEOUT);
+    } while (result == GL_TIMEOUT_EXPIRED);
+    if (result == GL_WAIT_FAILED)
+        return TE_Unsupported;
+#endif
+    for (std::size_t i = 0u; i < count; i++)
+        popFence();
+    return TE_Ok;
+}
+
+void GLStreamBuffer::popFence() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    GLsync sync = fences.front().sync;
+    fences.pop_front();
+    // ranges fenced together share a sync object
+    if (sync && (fences.empty() || fences.front().sync != sync))
+        glDeleteSync(sync);
+#else
+    fences.pop_front();
+#endif
+}
@@ -0,0 +1,92 @@
+#ifndef TAK_ENGINE_RENDERER_GLSTREAMBUFFER_H_INCLUDED
+#define TAK_ENGINE_RENDERER_GLSTREAMBUFFER_H_INCLUDED
+
+#include <cstddef>
+#include <deque>
+
+#include "port/Platform.h"
+#include "renderer/GL.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Ring buffer VBO for streaming per-frame vertex and index data.
+             *
+             * <P>On GLES3, uploads are sub-allocated from a single buffer
+             * object and written via `glMapBufferRange` with the
+             * unsynchronized and invalidate flags. A fence is inserted after
+             * the draws sourcing each upload; a range is only rewritten once
+             * its fence has signaled. On GLES2, or if mapping fails, the
+             * buffer is orphaned each time the ring wraps and data is
+             * written via `glBufferSubData`.
+             *
+             * <P>All methods must be invoked on the GL thread.
+             */
+            class ENGINE_API GLStreamBuffer
+            {
+            private :
+                enum Mode
+                {
+                    Uninitialized,
+                    Mapped,
+                    Orphaned,
+                };
+
+                struct Fence
+                {
+                    std::size_t begin;
+                    std::size_t end;
+#if TE_GLES_VERSION >= 3
+                    /** `nullptr` until the draws sourcing the range have been issued */
+                    GLsync sync;
+#endif
+                };
+            public :
+                GLStreamBuffer(const GLenum target, const std::size_t capacity) NOTHROWS;
+                ~GLStreamBuffer() NOTHROWS;
+            private :
+                GLStreamBuffer(const GLStreamBuffer &) NOTHROWS;
+            public :
+                /**
+                 * Copies the data into the buffer. On success, the buffer is
+                 * left bound to the target and `offset` holds the byte offset
+                 * of the data within the buffer.
+                 *
+                 * @return  `TE_Ok` on success; `TE_Unsupported` if `size`
+                 *          exceeds the capacity or the data cannot be written
+                 *          without overwriting data that has not yet been
+                 *          fenced. On failure the caller should source the
+                 *          data from client memory.
+                 */
+                Util::TAKErr upload(std::size_t *offset, const void *data, const std::size_t size) NOTHROWS;
+                /**
+                 * Marks all data uploaded since the previous call as in use
+                 * by the GL. Must be invoked after the draw calls sourcing
+                 * that data have been issued.
+                 */
+                void fence() NOTHROWS;
+                /**
+                 * Releases the buffer object and any outstanding fences.
+                 */
+                void release() NOTHROWS;
+            private :
+                Util::TAKErr init() NOTHROWS;
+                Util::TAKErr waitFences(const std::size_t begin, const std::size_t end) NOTHROWS;
+                void popFence() NOTHROWS;
+            private :
+                const GLenum target;
+                const std::size_t capacity;
+                GLuint handle;
+                Mode mode;
+                std::size_t head;
+                /** start of the range uploaded since the last `fence()` */
+                std::size_t pendingBegin;
+                std::deque<Fence> fences;
+            };
+        }
+    }
+}
+
+#endif
@@ -4,9 +4,11 @@
 #include <limits>
 #include "core/AtakMapView.h"
 #include "math/Utils.h"
+#include "renderer/DistanceField.h"
 #include "renderer/GLES20FixedPipeline.h"
 #include "thread/Lock.h"
 #include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
 
 using namespace TAK::Engine::Renderer;
 
@@ -26,6 +28,11 @@ using namespace TAK::Engine::Util;
 #define GLTEXT2_CHAR_BATCH_SIZE 80
 #define GLTEXT2_NUM_COMMON_CHARS ((GLTEXT2_CHAR_END) - (GLTEXT2_CHAR_START) + 1)
 
+// glyphs are rasterized once at the reference size and scaled from there
+#define GLTEXT2_DISTANCE_FIELD_FONT_SIZE 32.0f
+#define GLTEXT2_DISTANCE_FIELD_SPREAD 6u
+#define GLTEXT2_DISTANCE_FIELD_ATLAS_SIZE 512u
+
 #define TE_RED(argb) (((argb)>>16)&0xFF)
 #define TE_GREEN(argb) (((argb)>>8)&0xFF)
 #define TE_BLUE(argb) ((argb)&0xFF)
@@ -37,6 +44,10 @@ namespace {
     Mutex cacheMutex;
     std::map<std::shared_ptr<TextFormat2>, std::unique_ptr<GLText2>> glTextCache;
 
+    Mutex distanceFieldMutex;
+
+    GLText2 *intern(std::shared_ptr<TextFormat2> textFormat, const TextFormatParams *distanceFieldParams) NOTHROWS;
+    void encodeUtf8(char *value, const unsigned int c) NOTHROWS;
     TAKErr bufferChar(const std::size_t size,
                       float *texVerts,
                       float *texCoords,
@@ -48,6 +59,28 @@ namespace {
                       const float u1, const float v1) NOTHROWS;
 }
 
+/**
+ * Signed distance field glyphs for a font, independent of its size. Must
+ * only be accessed on the GL thread.
+ */
+struct GLText2::DistanceFieldGlyphs
+{
+public :
+    DistanceFieldGlyphs(TextFormat2Ptr &&format) NOTHROWS;
+public :
+    /**
+     * Returns the texture and normalized glyph cell bounds, as
+     * `u0, v0, u1, v1`, loading the glyph if necessary.
+     */
+    TAKErr getGlyph(int *texId, float *uv, const unsigned int c) NOTHROWS;
+    TAKErr release() NOTHROWS;
+public :
+    TextFormat2Ptr format;
+    GLTextureAtlas2 atlas;
+    /** incremented when glyphs are released */
+    std::size_t generation;
+};
+
 TextFormat2::~TextFormat2() NOTHROWS
 {}
 
@@ -70,31 +103,16 @@ TextFormatParams::TextFormatParams(const char *name_, const float size_) NOTHROW
 
 GLText2 *TAK::Engine::Renderer::GLText2_intern(std::shared_ptr<TextFormat2> textFormat) NOTHROWS
 {
-    Lock lock(cacheMutex);
-
-    if (!SPRITE_BATCH.get())
-        SPRITE_BATCH.reset(new atakmap::renderer::GLRenderBatch(GLTEXT2_CHAR_BATCH_SIZE));
-
-    // performs safe volatile double checked locking
-    GLText2 *customGLText = nullptr;
-    auto entry = glTextCache.find(textFormat);
-    if (entry != glTextCache.end()) {
-        customGLText = entry->second.get();
-    } else {
-        std::unique_ptr<GLText2> retval(new GLText2(std::move(TextFormat2Ptr(textFormat.get(), Memory_leaker_const<TextFormat2>))));
-        customGLText = retval.get();
-        glTextCache.insert(std::pair<std::shared_ptr<TextFormat2>, std::unique_ptr<GLText2>>(textFormat, std::move(retval)));
-    }
-
-    return customGLText;
-
+    return intern(textFormat, nullptr);
 }
 GLText2 *TAK::Engine::Renderer::GLText2_intern(const TextFormatParams &params) NOTHROWS
 {
 
     TextFormat2Ptr fmt(nullptr, nullptr);
-    if (TextFormat2_createTextFormat(fmt, params) == TE_Ok)
-        return GLText2_intern(std::move(fmt));
+    if (TextFormat2_createTextFormat(fmt, params) == TE_Ok) {
+        const bool distanceField = (ConfigOptions_getIntOptionOrDefault("gltext2.distance-field-glyphs", 0) != 0);
+        return intern(std::move(fmt), distanceField ? &params : nullptr);
+    }
 #ifdef __ANDROID__
     Lock lock(cacheMutex);
     if(glTextCache.empty())
@@ -109,6 +127,20 @@ GLText2 *TAK::Engine::Renderer::GLText2_intern(const TextFormatParams &params) N
     return nullptr;
 }
 
+TAKErr TAK::Engine::Renderer::GLText2_releaseGlyphs() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    Lock lock(cacheMutex);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    for (auto entry = glTextCache.begin(); entry != glTextCache.end(); entry++) {
+        code = entry->second->releaseGlyphs();
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+
 /**********************************************************************/
 // Constructor/destructor (private)
 
@@ -116,11 +148,24 @@ GLText2 *TAK::Engine::Renderer::GLText2_intern(const TextFormatParams &params) N
 GLText2::GLText2(TextFormat2Ptr &&textFormat_) NOTHROWS :
     textFormat(std::move(textFormat_)),
     glyphAtlas(std::max(256u, (unsigned)(textFormat->getCharHeight()*2u)), true),
+    distanceFieldGeneration(0u),
     charMaxHeight(textFormat->getCharHeight())
 {
     memset(commonCharTexId, 0u, sizeof(commonCharTexId));
 }
 
+GLText2::GLText2(TextFormat2Ptr &&textFormat_, const TextFormatParams &params) NOTHROWS :
+    textFormat(std::move(textFormat_)),
+    glyphAtlas(std::max(256u, (unsigned)(textFormat->getCharHeight()*2u)), true),
+    distanceFieldGlyphs(internDistanceFieldGlyphs(params)),
+    distanceFieldGeneration(0u),
+    charMaxHeight(textFormat->getCharHeight())
+{
+    memset(commonCharTexId, 0u, sizeof(commonCharTexId));
+    if (distanceFieldGlyphs)
+        distanceFieldGeneration = distanceFieldGlyphs->generation;
+}
+
 GLText2::~GLText2()
 {}
 
@@ -478,6 +523,18 @@ TextFormat2 &GLText2::getTextFormat() const NOTHROWS
     return *textFormat;
 }
 
+TAKErr GLText2::releaseGlyphs() NOTHROWS
+{
+    // invalidate the common character LUT; texture IDs are no longer valid
+    memset(commonCharTexId, 0u, sizeof(commonCharTexId));
+    if (distanceFieldGlyphs) {
+        TAKErr code = distanceFieldGlyphs->release();
+        TE_CHECKRETURN_CODE(code);
+        distanceFieldGeneration = distanceFieldGlyphs->generation;
+    }
+    return glyphAtlas.release();
+}
+
 std::size_t GLText2::getLineCount(const char *text) NOTHROWS
 {
     std::size_t numLines = 1;
@@ -558,6 +615,15 @@ TAKErr GLText2::batchImpl(GLRenderBatch2 &batch,
     float u1;
     float v1;
 
+    if (distanceFieldGlyphs) {
+        // the shared glyphs were released by another instance
+        if (distanceFieldGeneration != distanceFieldGlyphs->generation) {
+            memset(commonCharTexId, 0u, sizeof(commonCharTexId));
+            distanceFieldGeneration = distanceFieldGlyphs->generation;
+        }
+        batch.setDistanceField(true);
+    }
+
     for (std::size_t i = 0; i < len; i++) { // for each character in string
         unsigned int c = (unsigned int)text[i + off] & 0xFFu;
         // skip non-printable
@@ -617,7 +683,13 @@ TAKErr GLText2::batchImpl(GLRenderBatch2 &batch,
         if (c >= GLTEXT2_CHAR_START && c <= GLTEXT2_CHAR_END) {
             const std::size_t ccidx = c - GLTEXT2_CHAR_START;
             texId = commonCharTexId[ccidx];
-            if (texId == 0) {
+            if (texId == 0 && distanceFieldGlyphs) {
+                code = distanceFieldGlyphs->getGlyph(&texId, commonCharUV + (ccidx * 4), c);
+                TE_CHECKBREAK_CODE(code);
+
+                commonCharWidth[ccidx] = (float)textFormat->getCharWidth(c);
+                commonCharTexId[ccidx] = texId;
+            } else if (texId == 0) {
                 code = loadGlyph(&key, c);
                 TE_CHECKBREAK_CODE(code);
 
@@ -643,6 +715,17 @@ TAKErr GLText2::batchImpl(GLRenderBatch2 &batch,
             v0 = commonCharUV[ccidx * 4 + 1];
             u1 = commonCharUV[ccidx * 4 + 2];
             v1 = commonCharUV[ccidx * 4 + 3];
+        } else if (distanceFieldGlyphs) {
+            float uv[4u];
+            code = distanceFieldGlyphs->getGlyph(&texId, uv, c);
+            TE_CHECKBREAK_CODE(code);
+
+            charWidth = textFormat->getCharWidth(c);
+
+            u0 = uv[0];
+            v0 = uv[1];
+            u1 = uv[2];
+            v1 = uv[3];
         } else {
             code = glyphAtlas.getTextureKey(&key, uri);
             if (code == TE_InvalidArg) {
@@ -678,13 +761,15 @@ TAKErr GLText2::batchImpl(GLRenderBatch2 &batch,
             float y1 = charAdjY + letterY + cellHeight / 2.0f;
 
             // adjust the vertex and text coordinates to account for
-            // scissoring
+            // scissoring. distance field glyphs are scaled from the
+            // reference size
+            const float uPerX = (distanceFieldGlyphs && x1 > x0) ? ((u1 - u0) / (x1 - x0)) : (1.0f / texSize);
             if (letterX < scissorX0) {
-                u0 += (scissorX0 - x0) / texSize;
+                u0 += (scissorX0 - x0) * uPerX;
                 x0 = scissorX0;
             }
             if ((letterX + charWidth) > scissorX1) {
-                u1 -= (x1 - scissorX1) / texSize;
+                u1 -= (x1 - scissorX1) * uPerX;
                 x1 = scissorX1;
             }
 
@@ -712,7 +797,7 @@ TAKErr GLText2::batchImpl(GLRenderBatch2 &batch,
                         trianglesIndices,
                         r, g, b, a);
         }
-        TE_CHECKRETURN_CODE(code);
+        TE_CHECKBREAK_CODE(code);
 
         // advance X position by scaled character width
 #if 1
@@ -724,6 +809,9 @@ TAKErr GLText2::batchImpl(GLRenderBatch2 &batch,
             break;
     }
 
+    if (distanceFieldGlyphs)
+        batch.setDistanceField(false);
+
     return code;
 }
 
@@ -739,37 +827,150 @@ TAKErr GLText2::loadGlyph(int64_t *key, const unsigned int c) NOTHROWS
     TE_CHECKRETURN_CODE(code);
 
     char buf[5u];
-    if(c < 128u) {
-        // 7 bits, emit
-        buf[0] = c;
-        buf[1] = '\0';
-    } else if(c < 0x800) {
-        // 11 bits
-        buf[0] = 0xC0 | ((c >> 6)&0x1F);
-        buf[1] = 0x80 | (c&0x3F);
-        buf[2] = '\0';
-    } else if(c < 0x10000) {
-        // 16 bits
-        buf[0] = 0xE0 | ((c >> 12)&0x0F);
-        buf[1] = 0x80 | ((c>>6)&0x3F);
-        buf[2] = 0x80 | (c&0x3F);
-        buf[3] = '\0';
-    } else {
-        // truncated to 21 bits
-        buf[0] = 0xF0 | ((c >> 18)&0x07);
-        buf[1] = 0x80 | ((c>>12)&0x3F);
-        buf[2] = 0x80 | ((c>>6)&0x3F);
-        buf[3] = 0x80 | (c&0x3F);
-        buf[4] = '\0';
-    }
+    encodeUtf8(buf, c);
     code = glyphAtlas.addImage(key, buf, *b);
     TE_CHECKRETURN_CODE(code);
     
     return code;
 }
 
+std::shared_ptr<GLText2::DistanceFieldGlyphs> GLText2::internDistanceFieldGlyphs(const TextFormatParams &params) NOTHROWS
+{
+    static std::map<std::string, std::shared_ptr<DistanceFieldGlyphs>> distanceFieldGlyphs;
+
+    Lock lock(distanceFieldMutex);
+    if (lock.status != TE_Ok)
+        return std::shared_ptr<DistanceFieldGlyphs>();
+
+    // glyphs are shared across sizes of the same font and style
+    std::string key(params.fontName ? params.fontName : "");
+    key += params.bold ? ":b" : ":-";
+    key += params.italic ? "i" : "-";
+    key += params.underline ? "u" : "-";
+    key += params.strikethrough ? "s" : "-";
+
+    auto entry = distanceFieldGlyphs.find(key);
+    if (entry != distanceFieldGlyphs.end())
+        return entry->second;
+
+    TextFormatParams reference(params);
+    reference.size = GLTEXT2_DISTANCE_FIELD_FONT_SIZE;
+    TextFormat2Ptr format(nullptr, nullptr);
+    if (TextFormat2_createTextFormat(format, reference) != TE_Ok)
+        return std::shared_ptr<DistanceFieldGlyphs>();
+
+    std::shared_ptr<DistanceFieldGlyphs> retval(new DistanceFieldGlyphs(std::move(format)));
+    distanceFieldGlyphs[key] = retval;
+    return retval;
+}
+
+GLText2::DistanceFieldGlyphs::DistanceFieldGlyphs(TextFormat2Ptr &&format_) NOTHROWS :
+    format(std::move(format_)),
+    atlas(GLTEXT2_DISTANCE_FIELD_ATLAS_SIZE, true),
+    generation(0u)
+{}
+
+TAKErr GLText2::DistanceFieldGlyphs::getGlyph(int *texId, float *uv, const unsigned int c) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    char uri[5u];
+    encodeUtf8(uri, c);
+
+    int64_t key = 0LL;
+    if (atlas.getTextureKey(&key, uri) != TE_Ok) {
+        BitmapPtr glyph(nullptr, nullptr);
+        code = format->loadGlyph(glyph, c);
+        // if the glyph fails to load, show unknown character to allow the entire string to render
+        if (code != TE_Ok)
+            code = format->loadGlyph(glyph, '?');
+        TE_CHECKRETURN_CODE(code);
+
+        BitmapPtr field(nullptr, nullptr);
+        code = DistanceField_create(field, *glyph, GLTEXT2_DISTANCE_FIELD_SPREAD);
+        TE_CHECKRETURN_CODE(code);
+
+        code = atlas.addImage(&key, uri, *field);
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    code = atlas.getTexId(texId, key);
+    TE_CHECKRETURN_CODE(code);
+
+    atakmap::math::Rectangle<float> bounds;
+    code = atlas.getImageRect(&bounds, key, false);
+    TE_CHECKRETURN_CODE(code);
+
+    // exclude the padding so that the glyph cell maps onto the quad
+    const auto texSize = (float)atlas.getTextureSize();
+    const auto pad = (float)GLTEXT2_DISTANCE_FIELD_SPREAD;
+    uv[0] = (bounds.x + pad) / texSize;
+    uv[1] = (bounds.y + bounds.height - pad) / texSize;
+    uv[2] = (bounds.x + bounds.width - pad) / texSize;
+    uv[3] = (bounds.y + pad) / texSize;
+
+    return code;
+}
+
+TAKErr GLText2::DistanceFieldGlyphs::release() NOTHROWS
+{
+    generation++;
+    return atlas.release();
+}
+
 namespace
 {
+    GLText2 *intern(std::shared_ptr<TextFormat2> textFormat, const TextFormatParams *distanceFieldParams) NOTHROWS
+    {
+        Lock lock(cacheMutex);
+
+        if (!SPRITE_BATCH.get())
+            SPRITE_BATCH.reset(new atakmap::renderer::GLRenderBatch(GLTEXT2_CHAR_BATCH_SIZE));
+
+        // performs safe volatile double checked locking
+        GLText2 *customGLText = nullptr;
+        auto entry = glTextCache.find(textFormat);
+        if (entry != glTextCache.end()) {
+            customGLText = entry->second.get();
+        } else {
+            TextFormat2Ptr fmt(textFormat.get(), Memory_leaker_const<TextFormat2>);
+            std::unique_ptr<GLText2> retval(distanceFieldParams ?
+                new GLText2(std::move(fmt), *distanceFieldParams) :
+                new GLText2(std::move(fmt)));
+            customGLText = retval.get();
+            glTextCache.insert(std::pair<std::shared_ptr<TextFormat2>, std::unique_ptr<GLText2>>(textFormat, std::move(retval)));
+        }
+
+        return customGLText;
+    }
+
+    void encodeUtf8(char *buf, const unsigned int c) NOTHROWS
+    {
+        if(c < 128u) {
+            // 7 bits, emit
+            buf[0] = c;
+            buf[1] = '\0';
+        } else if(c < 0x800) {
+            // 11 bits
+            buf[0] = 0xC0 | ((c >> 6)&0x1F);
+            buf[1] = 0x80 | (c&0x3F);
+            buf[2] = '\0';
+        } else if(c < 0x10000) {
+            // 16 bits
+            buf[0] = 0xE0 | ((c >> 12)&0x0F);
+            buf[1] = 0x80 | ((c>>6)&0x3F);
+            buf[2] = 0x80 | (c&0x3F);
+            buf[3] = '\0';
+        } else {
+            // truncated to 21 bits
+            buf[0] = 0xF0 | ((c >> 18)&0x07);
+            buf[1] = 0x80 | ((c>>12)&0x3F);
+            buf[2] = 0x80 | ((c>>6)&0x3F);
+            buf[3] = 0x80 | (c&0x3F);
+            buf[4] = '\0';
+        }
+    }
+
     TAKErr bufferChar(const std::size_t size,
                       float *texVerts,
                       float *texCoords,
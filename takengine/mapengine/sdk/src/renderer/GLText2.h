@@ -2,6 +2,7 @@
 #define TAK_ENGINE_RENDERER_GLTEXT2_H_INCLUDED
 
 #include <map>
+#include <memory>
 
 #include "math/Rectangle.h"
 #include "port/Platform.h"
@@ -60,8 +61,18 @@ namespace TAK {
 
             class ENGINE_API GLText2
             {
+            private :
+                struct DistanceFieldGlyphs;
             public:
                 GLText2(TextFormat2Ptr &&textFormat) NOTHROWS;
+                /**
+                 * Creates an instance that renders glyphs from a signed
+                 * distance field atlas. The atlas is shared by all
+                 * instances with the same font and style as `params`;
+                 * each glyph is rasterized once at a reference size and
+                 * scaled to the size of `textFormat` when batched.
+                 */
+                GLText2(TextFormat2Ptr &&textFormat, const TextFormatParams &params) NOTHROWS;
                 ~GLText2() NOTHROWS;
             public:
                 // draw
@@ -114,6 +125,12 @@ namespace TAK {
                     const float r, const float g, const float b, const float a,
                     const float scissorX0, const float scissorX1) NOTHROWS;
                 TextFormat2 &getTextFormat() const NOTHROWS;
+                /**
+                 * Releases all cached glyphs; glyphs are reloaded on demand.
+                 * Must be invoked on the GL thread, outside of any batch
+                 * that may reference glyph textures.
+                 */
+                Util::TAKErr releaseGlyphs() NOTHROWS;
             public :
                 static std::size_t getLineCount(const char *text) NOTHROWS;
             private:
@@ -145,10 +162,15 @@ namespace TAK {
                     const float scissorX0, const float scissorX1) NOTHROWS;
 
                 Util::TAKErr loadGlyph(int64_t *atlasKey, const unsigned int c) NOTHROWS;
+            private :
+                static std::shared_ptr<DistanceFieldGlyphs> internDistanceFieldGlyphs(const TextFormatParams &params) NOTHROWS;
             private :
                 TextFormat2Ptr textFormat;
 
                 GLTextureAtlas2 glyphAtlas;
+                std::shared_ptr<DistanceFieldGlyphs> distanceFieldGlyphs;
+                /** generation of `distanceFieldGlyphs` the common character LUT was populated from */
+                std::size_t distanceFieldGeneration;
 
                 float charMaxHeight;
 #define GLTEXT2_NUM_COMMON_CHARS (((254u) - (32u) + 1u))
@@ -159,7 +181,18 @@ namespace TAK {
             };
 
             ENGINE_API GLText2 *GLText2_intern(std::shared_ptr<TextFormat2> textFormat) NOTHROWS;
+            /**
+             * Interns an instance for the specified font. If the
+             * `gltext2.distance-field-glyphs` option is non-zero, the
+             * instance renders glyphs from a signed distance field atlas
+             * shared across all sizes of the font.
+             */
             ENGINE_API GLText2 *GLText2_intern(const TextFormatParams &fmt) NOTHROWS;
+            /**
+             * Releases the cached glyphs for all interned instances. Must be
+             * invoked on the GL thread between frames.
+             */
+            ENGINE_API Util::TAKErr GLText2_releaseGlyphs() NOTHROWS;
         }
     }
 }
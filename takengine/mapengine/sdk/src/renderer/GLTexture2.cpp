@@ -1,23 +1,52 @@
 #include "renderer/GLTexture2.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
 
 #include <GLES2/gl2ext.h>
 
+#include "formats/astc/ASTC.h"
+#include "formats/etc2/ETC2.h"
 #include "formats/s3tc/S3TC.h"
 #include "math/Matrix.h"
+#include "port/String.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "util/ConfigOptions.h"
 #include "util/DataOutput2.h"
 #include "util/MemBuffer2.h"
 #include "util/Memory.h"
+#include "util/MemoryAccounting.h"
+#include "util/PerformanceCounters.h"
+#include "util/Trace.h"
+
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
 
 using namespace TAK::Engine::Renderer;
 
+using namespace TAK::Engine::Formats::ASTC;
+using namespace TAK::Engine::Formats::ETC2;
 using namespace TAK::Engine::Formats::S3TC;
+using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Util;
 
 namespace {
+    /** bitwise-OR of `GLTextureCompression`; `-1` if not yet detected */
+    std::atomic<int> supportedCompression(-1);
+
+    GLTextureCompression selectCompression(const unsigned supported) NOTHROWS;
+    bool hasAlpha(const Bitmap2::Format fmt) NOTHROWS;
+
     size_t nextPowerOf2(const size_t v) NOTHROWS
     {
         size_t value = v;
@@ -43,6 +72,24 @@ namespace {
         return retval;
     }
 
+    std::size_t textureDataSize(const int format, const int type, const std::size_t width, const std::size_t height) NOTHROWS
+    {
+        Bitmap2::Format bitmapFormat;
+        std::size_t pixelSize = 4u;
+        if (GLTexture2_getBitmapFormat(&bitmapFormat, format, type) == TE_Ok)
+            Bitmap2_formatPixelSize(&pixelSize, bitmapFormat);
+        return width * height * pixelSize;
+    }
+
+    void accountTexture(std::size_t &accounted, const std::size_t size) NOTHROWS
+    {
+        if (accounted)
+            MemoryAccounting_release(TEMC_Texture, accounted);
+        accounted = size;
+        if (accounted)
+            MemoryAccounting_allocate(TEMC_Texture, accounted);
+    }
+
     template<class T>
     TAKErr createQuadMeshIndexBufferImpl(MemBuffer2 &value, const std::size_t numCellsX, const std::size_t numCellsY) NOTHROWS;
 }
@@ -80,7 +127,9 @@ GLTexture2::GLTexture2(const size_t w, const size_t h, const int format, const i
     wrap_s_(GL_CLAMP_TO_EDGE),
     wrap_t_(GL_CLAMP_TO_EDGE),
     needs_apply_(false),
-    compressed_(false)
+    compressed_(false),
+    compressed_size_(0u),
+    accounted_size_(0u)
 {}
 
 GLTexture2::GLTexture2(const size_t w, const size_t h, Bitmap2::Format f) NOTHROWS :
@@ -94,7 +143,9 @@ GLTexture2::GLTexture2(const size_t w, const size_t h, Bitmap2::Format f) NOTHRO
     wrap_s_(GL_CLAMP_TO_EDGE),
     wrap_t_(GL_CLAMP_TO_EDGE),
     needs_apply_(false),
-    compressed_(false)
+    compressed_(false),
+    compressed_size_(0u),
+    accounted_size_(0u)
 {
     if (f == Bitmap2::ARGB32)
         f = Bitmap2::RGBA32;
@@ -133,6 +184,9 @@ void GLTexture2::init() NOTHROWS
             }
         }
 
+        if (id_)
+            accountTexture(accounted_size_, textureDataSize(format_, type_, width_, height_));
+
         // drop through to bind original texture
         glBindTexture(GL_TEXTURE_2D, t);
 
@@ -141,6 +195,9 @@ void GLTexture2::init() NOTHROWS
 }
 bool GLTexture2::initInternal() NOTHROWS
 {
+    // capture the supported formats for compression on worker threads
+    GLTexture2_detectSupportedCompression();
+
     // generate the texture
     glGenTextures(1, &id_);
 
@@ -169,6 +226,7 @@ void GLTexture2::release() NOTHROWS
         glDeleteTextures(1, &id_);
         id_ = 0;
     }
+    accountTexture(accounted_size_, 0u);
 }
 
 
@@ -187,6 +245,10 @@ bool GLTexture2::isCompressed() const NOTHROWS
 {
     return compressed_;
 }
+std::size_t GLTexture2::getCompressedSize() const NOTHROWS
+{
+    return compressed_size_;
+}
 int GLTexture2::getTexId() NOTHROWS
 {
     if (needs_apply_) {
@@ -260,6 +322,7 @@ void GLTexture2::setMagFilter(int magFilter) NOTHROWS
 
 TAKErr GLTexture2::load(const Bitmap2 &bitmap, const int x, const int y) NOTHROWS
 {
+    TE_TRACE_SCOPE("gl", "GLTexture2::loadBitmap");
     TAKErr code;
     Bitmap2::Format tgtFmt;
     
@@ -296,6 +359,7 @@ void GLTexture2::load(const atakmap::renderer::Bitmap &bitmap) NOTHROWS
 
 void GLTexture2::load(const void *data, const int x, const int y, const size_t w, const size_t h) NOTHROWS 
 {
+    TE_TRACE_SCOPE("gl", "GLTexture2::upload");
     if (!id_ && x == 0 && y == 0 && w == width_ && h == height_) {
         if (!initInternal())
             return;
@@ -305,6 +369,8 @@ void GLTexture2::load(const void *data, const int x, const int y, const size_t w
                      static_cast<GLsizei>(width_), static_cast<GLsizei>(height_), 0,
                      format_, type_, data);
         glBindTexture(GL_TEXTURE_2D, 0);
+        accountTexture(accounted_size_, textureDataSize(format_, type_, width_, height_));
+        PerformanceCounters_add(TEPC_TextureUploadBytes, textureDataSize(format_, type_, width_, height_));
         return;
     }
 
@@ -343,6 +409,7 @@ void GLTexture2::load(const void *data, const int x, const int y, const size_t w
             glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, static_cast<GLsizei>(w), static_cast<GLsizei>(h),
                     format_, type_, data);
 			glBindTexture(GL_TEXTURE_2D, 0);
+            PerformanceCounters_add(TEPC_TextureUploadBytes, textureDataSize(format_, type_, w, h));
 		}
 		catch (...)
 		{
@@ -351,6 +418,24 @@ void GLTexture2::load(const void *data, const int x, const int y, const size_t w
     }
 }
 
+TAKErr GLTexture2::load(const GLuint unpackBuffer, const std::size_t offset, const int x, const int y, const std::size_t w, const std::size_t h) NOTHROWS
+{
+    TE_TRACE_SCOPE("gl", "GLTexture2::upload");
+#if TE_GLES_VERSION >= 3
+    if (!unpackBuffer)
+        return TE_InvalidArg;
+    // allocate storage before binding; a `nullptr` source for the
+    // allocation would otherwise be sourced from the buffer
+    if (!(x == 0 && y == 0 && w == width_ && h == height_))
+        init();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+    load(reinterpret_cast<const void *>(offset), x, y, w, h);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+    return id_ ? TE_Ok : TE_Err;
+#else
+    return TE_Unsupported;
+#endif
+}
 
 
 /*************************************************************************/
@@ -657,30 +742,91 @@ TAKErr TAK::Engine::Renderer::GLTexture2_getBitmapFormat(Bitmap2::Format *value,
     return TE_Ok;
 }
 
+unsigned TAK::Engine::Renderer::GLTexture2_detectSupportedCompression() NOTHROWS
+{
+    const int detected = supportedCompression.load();
+    if (detected >= 0)
+        return (unsigned)detected;
+
+    const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+    // no current context
+    if (!extensions && !version)
+        return TEGLTC_None;
+
+    unsigned value = TEGLTC_None;
+    if (extensions) {
+        if (strstr(extensions, "GL_EXT_texture_compression_s3tc") || strstr(extensions, "GL_ANGLE_texture_compression_dxt5"))
+            value |= TEGLTC_S3TC;
+        if (strstr(extensions, "GL_KHR_texture_compression_astc_ldr") || strstr(extensions, "GL_OES_texture_compression_astc"))
+            value |= TEGLTC_ASTC;
+    }
+    // ETC2 is mandated by GLES3
+    int major = 0;
+    if (version && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3)
+        value |= TEGLTC_ETC2;
+
+    supportedCompression = (int)value;
+    return value;
+}
+
+TAKErr TAK::Engine::Renderer::GLTexture2_getSupportedCompression(unsigned *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    const int detected = supportedCompression.load();
+    if (detected < 0)
+        return TE_IllegalState;
+    *value = (unsigned)detected;
+    return TE_Ok;
+}
+
 TAKErr TAK::Engine::Renderer::GLTexture2_createCompressedTextureData(std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData *)> &data, const Bitmap2 &bitmap) NOTHROWS {
 	TAKErr code(TE_Ok);
-	const S3TCAlgorithm alg = S3TC_getDefaultAlgorithm(bitmap.getFormat());
-	const std::size_t compressedSize = S3TC_getCompressedSize(bitmap);
+	unsigned supported;
+	// prior to detection, retain the legacy behavior
+	if (GLTexture2_getSupportedCompression(&supported) != TE_Ok)
+		supported = TEGLTC_S3TC;
+	const GLTextureCompression compression = selectCompression(supported);
+
+	std::size_t compressedSize;
+	GLenum glalg;
+	const Bitmap2::Format cbfmt = hasAlpha(bitmap.getFormat()) ? Bitmap2::RGBA32 : Bitmap2::RGB24;
+	switch (compression) {
+	case TEGLTC_S3TC:
+		compressedSize = S3TC_getCompressedSize(bitmap);
+		glalg = (S3TC_getDefaultAlgorithm(bitmap.getFormat()) == TECA_DXT5) ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		break;
+	case TEGLTC_ETC2:
+		compressedSize = ETC2_getCompressedSize(bitmap);
+		glalg = (ETC2_getDefaultAlgorithm(bitmap.getFormat()) == TECA_ETC2_RGBA8) ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+		break;
+	case TEGLTC_ASTC:
+		// opaque blocks decode with full alpha
+		compressedSize = ASTC_getCompressedSize(bitmap);
+		glalg = GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+		break;
+	default:
+		return TE_Unsupported;
+	}
+
 	array_ptr<uint8_t> compressedData(new uint8_t[compressedSize]);
 	MemoryOutput2 dst;
 	dst.open(compressedData.get(), compressedSize);
-	code = S3TC_compress(dst, nullptr, nullptr, bitmap);
-	TE_CHECKRETURN_CODE(code);
-
-	GLenum glalg;
-	Bitmap2::Format cbfmt;
-	switch (alg) {
-	case TECA_DXT1:
-		glalg = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
-		cbfmt = Bitmap2::RGB24;
+	switch (compression) {
+	case TEGLTC_S3TC:
+		code = S3TC_compress(dst, nullptr, nullptr, bitmap);
+		break;
+	case TEGLTC_ETC2:
+		code = ETC2_compress(dst, nullptr, nullptr, bitmap);
 		break;
-	case TECA_DXT5:
-		glalg = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-		cbfmt = Bitmap2::RGBA32;
+	case TEGLTC_ASTC:
+		code = ASTC_compress(dst, nullptr, bitmap);
 		break;
 	default:
 		return TE_IllegalState;
 	}
+	TE_CHECKRETURN_CODE(code);
 
 	std::size_t alignedW = (bitmap.getWidth() + 3u) / 4u * 4u;
 	std::size_t alignedH = (bitmap.getHeight() + 3u) / 4u * 4u;
@@ -710,7 +856,10 @@ TAKErr TAK::Engine::Renderer::GLTexture2_createCompressedTexture(GLTexture2Ptr &
 
 TAKErr TAK::Engine::Renderer::GLTexture2_createCompressedTexture(GLTexture2Ptr &value, const GLCompressedTextureData &data) NOTHROWS {
 	TAKErr code(TE_Ok);
-        GLTexture2 tex(static_cast<int>(data.alignedW), static_cast<int>(data.alignedH), data.cbfmt);
+	GLTexture2Ptr texPtr(new(std::nothrow) GLTexture2(static_cast<int>(data.alignedW), static_cast<int>(data.alignedH), data.cbfmt), Memory_deleter_const<GLTexture2>);
+	if (!texPtr)
+		return TE_OutOfMemory;
+	GLTexture2 &tex = *texPtr;
 	tex.initInternal();
 	if (!tex.id_)
 		return TE_OutOfMemory;
@@ -727,8 +876,10 @@ TAKErr TAK::Engine::Renderer::GLTexture2_createCompressedTexture(GLTexture2Ptr &
 		return TE_Err;
 	}
 	tex.compressed_ = true;
-	value = GLTexture2Ptr(new GLTexture2(tex), Memory_deleter_const<GLTexture2>);
-	tex.id_ = 0;
+	tex.compressed_size_ = data.compressedSize;
+	accountTexture(tex.accounted_size_, data.compressedSize);
+	PerformanceCounters_add(TEPC_TextureUploadBytes, data.compressedSize);
+	value = std::move(texPtr);
 	return code;
 }
 
@@ -739,6 +890,8 @@ TAKErr TAK::Engine::Renderer::GLTexture2_orphan(GLuint* result, GLTexture2& text
 
     *result = texture.id_;
     texture.id_ = 0;
+    // the caller assumes ownership of the storage
+    accountTexture(texture.accounted_size_, 0u);
     return TE_Ok;
 }
 
@@ -778,4 +931,42 @@ namespace
 
         return code;
     }
+
+    GLTextureCompression selectCompression(const unsigned supported) NOTHROWS
+    {
+        String preferred;
+        if (ConfigOptions_getOption(preferred, "gltexture2.compression-format") == TE_Ok) {
+            if (String_strcasecmp(preferred, "s3tc") == 0 && (supported & TEGLTC_S3TC))
+                return TEGLTC_S3TC;
+            else if (String_strcasecmp(preferred, "etc2") == 0 && (supported & TEGLTC_ETC2))
+                return TEGLTC_ETC2;
+            else if (String_strcasecmp(preferred, "astc") == 0 && (supported & TEGLTC_ASTC))
+                return TEGLTC_ASTC;
+        }
+        // S3TC is preferred where available as ETC2 is frequently emulated
+        // on desktop drivers
+        if (supported & TEGLTC_S3TC)
+            return TEGLTC_S3TC;
+        else if (supported & TEGLTC_ETC2)
+            return TEGLTC_ETC2;
+        else if (supported & TEGLTC_ASTC)
+            return TEGLTC_ASTC;
+        else
+            return TEGLTC_None;
+    }
+
+    bool hasAlpha(const Bitmap2::Format fmt) NOTHROWS
+    {
+        switch (fmt)
+        {
+        case Bitmap2::ARGB32 :
+        case Bitmap2::BGRA32 :
+        case Bitmap2::MONOCHROME_ALPHA :
+        case Bitmap2::RGBA32 :
+        case Bitmap2::RGBA5551 :
+            return true;
+        default :
+            return false;
+        }
+    }
 }
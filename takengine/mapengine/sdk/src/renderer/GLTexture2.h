@@ -23,10 +23,19 @@ namespace TAK
                 GLTexture2(const size_t width, const size_t height, int format, int type) NOTHROWS;
                 GLTexture2(const size_t width, const size_t height, Bitmap2::Format format) NOTHROWS;
                 ~GLTexture2() NOTHROWS;
+            private :
+                // a copy would alias the texture ID and its accounted size
+                GLTexture2(const GLTexture2 &) = delete;
+                GLTexture2 &operator=(const GLTexture2 &) = delete;
             public :
                 int getType() const NOTHROWS;
                 int getFormat() const NOTHROWS;
                 bool isCompressed() const NOTHROWS;
+                /**
+                 * Returns the size of the compressed texture data, in bytes,
+                 * or `0` if the texture is not compressed.
+                 */
+                std::size_t getCompressedSize() const NOTHROWS;
 
                 /**
                  * Returns the texture ID, possibly applying any outstanding state changes
@@ -55,6 +64,15 @@ namespace TAK
                 Util::TAKErr load(const Bitmap2 &bitmap, const int x, const int y) NOTHROWS;
                 Util::TAKErr load(const Bitmap2 &bitmap) NOTHROWS;
                 void load(const void *data, const int x, const int y, const size_t w, const size_t h) NOTHROWS;
+                /**
+                 * Loads the texture from a pixel unpack buffer. The data must
+                 * be in the texture's format and type. The buffer must not be
+                 * mapped. Requires GLES3.
+                 *
+                 * @param unpackBuffer  The buffer object
+                 * @param offset        The byte offset of the data in the buffer
+                 */
+                Util::TAKErr load(const GLuint unpackBuffer, const std::size_t offset, const int x, const int y, const std::size_t w, const std::size_t h) NOTHROWS;
 
                 // XXX - 
                 void load(const atakmap::renderer::Bitmap &bitmap, const int x, const int y) NOTHROWS;
@@ -78,6 +96,9 @@ namespace TAK
                 int wrap_t_;
                 bool needs_apply_;
                 bool compressed_;
+                std::size_t compressed_size_;
+                /** bytes recorded against `TEMC_Texture` */
+                std::size_t accounted_size_;
 
                 void apply() NOTHROWS;
 
@@ -160,6 +181,37 @@ namespace TAK
 
 			ENGINE_API Util::TAKErr GLTexture2_getBitmapFormat(Bitmap2::Format *value, const int format, const int dataType) NOTHROWS;
 
+            /**
+             * Compressed texture formats that may be supported by the context
+             */
+            enum GLTextureCompression
+            {
+                TEGLTC_None = 0x0u,
+                TEGLTC_S3TC = 0x1u,
+                TEGLTC_ETC2 = 0x2u,
+                /** LDR, 4x4 block footprint */
+                TEGLTC_ASTC = 0x4u,
+            };
+
+            /**
+             * Detects the compressed texture formats supported by the
+             * current context, returning the bitwise-OR of the supported
+             * `GLTextureCompression` values. Detection is performed once;
+             * subsequent invocations return the cached result.
+             *
+             * <P>Must be invoked on thread with valid GL context
+             */
+            ENGINE_API unsigned GLTexture2_detectSupportedCompression() NOTHROWS;
+            /**
+             * Returns the compressed texture formats previously detected via
+             * `GLTexture2_detectSupportedCompression()`. May be invoked on
+             * any thread.
+             *
+             * @return  `TE_Ok` on success, `TE_IllegalState` if the formats
+             *          have not yet been detected
+             */
+            ENGINE_API Util::TAKErr GLTexture2_getSupportedCompression(unsigned *value) NOTHROWS;
+
 			struct GLCompressedTextureData {
 				TAK::Engine::Util::array_ptr<unsigned char> compressedData;
 				std::size_t compressedSize {0};
@@ -169,6 +221,18 @@ namespace TAK
 				Bitmap2::Format cbfmt {};
 			};
 
+            /**
+             * Compresses the bitmap for upload via
+             * `GLTexture2_createCompressedTexture`. The data is compressed
+             * using the preferred format supported by the context; the
+             * preference may be overridden via the
+             * `gltexture2.compression-format` option (`s3tc`, `etc2` or
+             * `astc`). If the supported formats have not yet been detected,
+             * S3TC is used. May be invoked on any thread.
+             *
+             * @return  `TE_Ok` on success, `TE_Unsupported` if the context
+             *          does not support any of the formats
+             */
 			ENGINE_API Util::TAKErr GLTexture2_createCompressedTextureData(std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData *)> &data, const Bitmap2 &bitmap) NOTHROWS;
 			ENGINE_API Util::TAKErr GLTexture2_createCompressedTexture(GLTexture2Ptr &value, const GLCompressedTextureData &data) NOTHROWS;
 
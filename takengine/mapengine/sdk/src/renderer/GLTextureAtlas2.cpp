@@ -1,9 +1,11 @@
 #include "renderer/GLTextureAtlas2.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "renderer/GLTexture2.h"
 #include "util/Memory.h"
+#include "util/PerformanceCounters.h"
 
 using namespace TAK::Engine::Renderer;
 
@@ -11,6 +13,11 @@ using namespace TAK::Engine::Util;
 
 #define RECT_SHEET_SIZE 256
 
+namespace
+{
+    TAKErr createTexture(int *value, const std::size_t texSize) NOTHROWS;
+}
+
 GLTextureAtlas2::Rect::Rect() :
     x(0),
     y(0),
@@ -60,7 +67,11 @@ GLTextureAtlas2::GLTextureAtlas2(const std::size_t texSize_) NOTHROWS :
     freeIndex(0),
     currentTexId(0),
     splitFreeHorizontal(false),
-    currentSheetRects(nullptr)
+    currentSheetRects(nullptr),
+    dynamic(false),
+    nextKey(1LL),
+    unreferencedArea(0u),
+    generation(0u)
 {}
 
 GLTextureAtlas2::GLTextureAtlas2(const std::size_t texSize_, const bool splitHorizontal_) NOTHROWS :
@@ -70,7 +81,11 @@ GLTextureAtlas2::GLTextureAtlas2(const std::size_t texSize_, const bool splitHor
     freeIndex(0),
     currentTexId(0),
     splitFreeHorizontal(splitHorizontal_),
-    currentSheetRects(nullptr)
+    currentSheetRects(nullptr),
+    dynamic(false),
+    nextKey(1LL),
+    unreferencedArea(0u),
+    generation(0u)
 {}
 
 GLTextureAtlas2::GLTextureAtlas2(const std::size_t texSize_, const std::size_t iconSize_) NOTHROWS :
@@ -80,7 +95,25 @@ GLTextureAtlas2::GLTextureAtlas2(const std::size_t texSize_, const std::size_t i
     freeIndex(0),
     currentTexId(0),
     splitFreeHorizontal(false),
-    currentSheetRects(nullptr)
+    currentSheetRects(nullptr),
+    dynamic(false),
+    nextKey(1LL),
+    unreferencedArea(0u),
+    generation(0u)
+{}
+
+GLTextureAtlas2::GLTextureAtlas2(const std::size_t texSize_, const std::size_t iconSize_, const bool dynamic_) NOTHROWS :
+    iconSize(iconSize_),
+    texSize(((std::size_t)1) << (int)ceil(log(texSize_) / log(2))),
+    fixedIconSize(iconSize_ > 0),
+    freeIndex(0),
+    currentTexId(0),
+    splitFreeHorizontal(false),
+    currentSheetRects(nullptr),
+    dynamic(dynamic_),
+    nextKey(1LL),
+    unreferencedArea(0u),
+    generation(0u)
 {}
 
 GLTextureAtlas2::~GLTextureAtlas2() NOTHROWS
@@ -88,6 +121,19 @@ GLTextureAtlas2::~GLTextureAtlas2() NOTHROWS
 
 TAKErr GLTextureAtlas2::release() NOTHROWS
 {
+    if (dynamic) {
+        for (auto it = pages.begin(); it != pages.end(); it++) {
+            GLuint tid = (*it)->texid;
+            glDeleteTextures(1, &tid);
+        }
+        pages.clear();
+        regions.clear();
+        uriToKey.clear();
+        unreferencedArea = 0u;
+        generation++;
+        return TE_Ok;
+    }
+
     std::set<int> texIds;
     std::map<std::string, int64_t>::iterator iter;
     for (iter = uriToKey.begin(); iter != uriToKey.end(); ++iter) {
@@ -110,6 +156,30 @@ TAKErr GLTextureAtlas2::release() NOTHROWS
 
 TAKErr GLTextureAtlas2::releaseTexture(const int textureId) NOTHROWS
 {
+    if (dynamic) {
+        for (auto it = regions.begin(); it != regions.end();) {
+            if (it->second.texid == textureId) {
+                if (!it->second.references)
+                    unreferencedArea -= (it->second.width*it->second.height);
+                uriToKey.erase(it->second.uri);
+                it = regions.erase(it);
+            } else {
+                it++;
+            }
+        }
+        for (auto it = pages.begin(); it != pages.end(); it++) {
+            if ((*it)->texid == textureId) {
+                pages.erase(it);
+                break;
+            }
+        }
+        generation++;
+
+        GLuint tid = textureId;
+        glDeleteTextures(1, &tid);
+        return TE_Ok;
+    }
+
     int64_t key;
     std::map<std::string, int64_t>::iterator iter;
     for (iter = uriToKey.begin(); iter != uriToKey.end();) {
@@ -173,7 +243,15 @@ TAKErr GLTextureAtlas2::getImageRect(atakmap::math::Rectangle<float> *value, con
     TAKErr code;
 
     code = TE_Ok;
-    if (fixedIconSize) {
+    if (dynamic) {
+        const Region *region = getRegion(key);
+        if (!region)
+            return TE_InvalidArg;
+        value->x = (float)region->x;
+        value->y = (float)region->y;
+        value->width = (float)region->width;
+        value->height = (float)region->height;
+    } else if (fixedIconSize) {
         int index;
         code = getIndex(&index, key);
         TE_CHECKRETURN_CODE(code);
@@ -271,6 +349,13 @@ std::size_t GLTextureAtlas2::getTextureSize() const NOTHROWS
 
 TAKErr GLTextureAtlas2::getTexId(int *value, const int64_t key) const NOTHROWS
 {
+    if (dynamic) {
+        const Region *region = getRegion(key);
+        if (!region)
+            return TE_InvalidArg;
+        *value = region->texid;
+        return TE_Ok;
+    }
     *value = (int)((key >> 32L) & 0xFFFFFFFFL);
     return TE_Ok;
 }
@@ -287,7 +372,7 @@ TAKErr GLTextureAtlas2::getImageTextureOffsetX(std::size_t *value, const int64_t
 
     code = TE_Ok;
 
-    if (fixedIconSize) {
+    if (fixedIconSize && !dynamic) {
         int index;
         code = getIndex(&index, key);
         TE_CHECKRETURN_CODE(code);
@@ -310,7 +395,7 @@ TAKErr GLTextureAtlas2::getImageTextureOffsetY(std::size_t *value, const int64_t
 
     code = TE_Ok;
 
-    if (fixedIconSize) {
+    if (fixedIconSize && !dynamic) {
         int index;
         code = getIndex(&index, key);
         TE_CHECKRETURN_CODE(code);
@@ -346,6 +431,9 @@ TAKErr GLTextureAtlas2::addImage(int64_t *value, const char *uri, const Bitmap2
     if (bitmap->getFormat() != Bitmap2::RGBA32)
         bitmap = BitmapPtr_const(new Bitmap2(*bitmap, Bitmap2::RGBA32), Memory_deleter_const<Bitmap2>);
 
+    if (dynamic)
+        return addDynamicImage(value, uri, *bitmap);
+
     // allocate a new texture if the current is filled
     if (fixedIconSize) {
         size_t numIcons = (texSize / iconSize);
@@ -486,6 +574,297 @@ TAKErr GLTextureAtlas2::addImage(int64_t *value, const char *uri, const Bitmap2
     return TE_Ok;
 }
 
+bool GLTextureAtlas2::isDynamic() const NOTHROWS
+{
+    return dynamic;
+}
+
+TAKErr GLTextureAtlas2::retainImage(const int64_t key) NOTHROWS
+{
+    if (!dynamic)
+        return TE_Ok;
+    auto entry = regions.find(key);
+    if (entry == regions.end())
+        return TE_InvalidArg;
+    if (!entry->second.references)
+        unreferencedArea -= (entry->second.width*entry->second.height);
+    entry->second.references++;
+    return TE_Ok;
+}
+
+TAKErr GLTextureAtlas2::releaseImage(const int64_t key) NOTHROWS
+{
+    if (!dynamic)
+        return TE_Ok;
+    auto entry = regions.find(key);
+    if (entry == regions.end())
+        return TE_InvalidArg;
+    if (!entry->second.references)
+        return TE_IllegalState;
+    entry->second.references--;
+    if (!entry->second.references)
+        unreferencedArea += (entry->second.width*entry->second.height);
+    return TE_Ok;
+}
+
+TAKErr GLTextureAtlas2::compact() NOTHROWS
+{
+    if (!dynamic)
+        return TE_Ok;
+    // repacking cannot free a texture unless at least a texture's worth of
+    // pixels is unreferenced
+    if (pages.size() < 2u || unreferencedArea < (texSize*texSize))
+        return TE_Ok;
+
+    std::vector<std::unique_ptr<Page>> packed;
+    std::vector<Placement> placements;
+    packReferenced(packed, placements, 0u, 0u);
+    if (packed.size() >= pages.size())
+        return TE_Ok;
+    return repack(packed, placements);
+}
+
+std::size_t GLTextureAtlas2::getGeneration() const NOTHROWS
+{
+    return generation;
+}
+
+TAKErr GLTextureAtlas2::addDynamicImage(int64_t *value, const char *uri, const Bitmap2 &bitmap) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    Region region;
+    region.texid = 0;
+    region.x = 0;
+    region.y = 0;
+    region.width = bitmap.getWidth();
+    region.height = bitmap.getHeight();
+    region.references = 1u;
+    region.uri = uri;
+
+    for (auto it = pages.begin(); it != pages.end(); it++) {
+        if ((*it)->allocate(&region.x, &region.y, region.width, region.height)) {
+            region.texid = (*it)->texid;
+            break;
+        }
+    }
+
+    // the atlas is full; evict unreferenced images if that makes room for
+    // the new image without growing
+    if (!region.texid && unreferencedArea >= (region.width*region.height)) {
+        std::vector<std::unique_ptr<Page>> packed;
+        std::vector<Placement> placements;
+        packReferenced(packed, placements, region.width, region.height);
+        if (packed.size() <= pages.size()) {
+            code = repack(packed, placements);
+            TE_CHECKRETURN_CODE(code);
+            for (auto it = placements.begin(); it != placements.end(); it++) {
+                if (!it->key) {
+                    region.texid = pages[it->page]->texid;
+                    region.x = it->x;
+                    region.y = it->y;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!region.texid) {
+        std::unique_ptr<Page> page(new Page(texSize));
+        code = createTexture(&page->texid, texSize);
+        if (code != TE_Ok) {
+            atakmap::util::Logger::log(atakmap::util::Logger::Error, "GLTextureAtlas2: failed to generate new texture id: %s", uri);
+            return code;
+        }
+        page->allocate(&region.x, &region.y, region.width, region.height);
+        region.texid = page->texid;
+        pages.push_back(std::move(page));
+    }
+
+    glBindTexture(GL_TEXTURE_2D, region.texid);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, static_cast<GLsizei>(region.width), static_cast<GLsizei>(region.height),
+        GL_RGBA, GL_UNSIGNED_BYTE, bitmap.getData());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    PerformanceCounters_add(TEPC_TextureUploadBytes, region.width*region.height*4u);
+
+    // keys are independent of the texture so that they survive repacking
+    const int64_t key = nextKey++;
+    regions[key] = region;
+    uriToKey[uri] = key;
+
+    *value = key;
+    return code;
+}
+
+const GLTextureAtlas2::Region *GLTextureAtlas2::getRegion(const int64_t key) const NOTHROWS
+{
+    auto entry = regions.find(key);
+    if (entry == regions.end())
+        return nullptr;
+    return &entry->second;
+}
+
+void GLTextureAtlas2::packReferenced(std::vector<std::unique_ptr<Page>> &packed, std::vector<Placement> &placements, const std::size_t pendingWidth, const std::size_t pendingHeight) const NOTHROWS
+{
+    struct Pending
+    {
+        int64_t key;
+        std::size_t width;
+        std::size_t height;
+    };
+
+    std::vector<Pending> order;
+    order.reserve(regions.size() + 1u);
+    for (auto it = regions.begin(); it != regions.end(); it++) {
+        if (it->second.references)
+            order.push_back(Pending{ it->first, it->second.width, it->second.height });
+    }
+    if (pendingWidth && pendingHeight)
+        order.push_back(Pending{ 0LL, pendingWidth, pendingHeight });
+
+    // tallest first keeps shelf waste low
+    std::sort(order.begin(), order.end(), [](const Pending &a, const Pending &b)
+    {
+        if (a.height != b.height)
+            return a.height > b.height;
+        return a.key < b.key;
+    });
+
+    placements.reserve(order.size());
+    for (auto it = order.begin(); it != order.end(); it++) {
+        Placement placement;
+        placement.key = it->key;
+        placement.page = 0u;
+        for (; placement.page < packed.size(); placement.page++) {
+            if (packed[placement.page]->allocate(&placement.x, &placement.y, it->width, it->height))
+                break;
+        }
+        if (placement.page == packed.size()) {
+            packed.push_back(std::unique_ptr<Page>(new Page(texSize)));
+            packed.back()->allocate(&placement.x, &placement.y, it->width, it->height);
+        }
+        placements.push_back(placement);
+    }
+}
+
+TAKErr GLTextureAtlas2::repack(std::vector<std::unique_ptr<Page>> &packed, const std::vector<Placement> &placements) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    for (auto it = packed.begin(); it != packed.end(); it++) {
+        code = createTexture(&(*it)->texid, texSize);
+        TE_CHECKBREAK_CODE(code);
+    }
+
+    // copy the referenced images by attaching each existing texture to a
+    // framebuffer as the read source
+    GLint boundFbo = 0;
+    GLuint fbo = 0u;
+    if (code == TE_Ok) {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFbo);
+        glGenFramebuffers(1, &fbo);
+        if (!fbo)
+            code = TE_Err;
+    }
+    if (code == TE_Ok) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        for (auto src = pages.begin(); src != pages.end(); src++) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, (*src)->texid, 0);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                code = TE_Err;
+                break;
+            }
+            for (auto it = placements.begin(); it != placements.end(); it++) {
+                if (!it->key)
+                    continue;
+                const Region &region = regions[it->key];
+                if (region.texid != (*src)->texid)
+                    continue;
+                glBindTexture(GL_TEXTURE_2D, packed[it->page]->texid);
+                glCopyTexSubImage2D(GL_TEXTURE_2D, 0, it->x, it->y, region.x, region.y, static_cast<GLsizei>(region.width), static_cast<GLsizei>(region.height));
+            }
+        }
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, boundFbo);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (fbo)
+        glDeleteFramebuffers(1, &fbo);
+
+    if (code != TE_Ok) {
+        atakmap::util::Logger::log(atakmap::util::Logger::Error, "GLTextureAtlas2: failed to repack atlas");
+        for (auto it = packed.begin(); it != packed.end(); it++) {
+            GLuint tid = (*it)->texid;
+            if (tid)
+                glDeleteTextures(1, &tid);
+        }
+        return code;
+    }
+
+    // evict the unreferenced images
+    for (auto it = regions.begin(); it != regions.end();) {
+        if (!it->second.references) {
+            uriToKey.erase(it->second.uri);
+            it = regions.erase(it);
+        } else {
+            it++;
+        }
+    }
+    unreferencedArea = 0u;
+
+    for (auto it = placements.begin(); it != placements.end(); it++) {
+        if (!it->key)
+            continue;
+        Region &region = regions[it->key];
+        region.texid = packed[it->page]->texid;
+        region.x = it->x;
+        region.y = it->y;
+    }
+
+    for (auto it = pages.begin(); it != pages.end(); it++) {
+        GLuint tid = (*it)->texid;
+        glDeleteTextures(1, &tid);
+    }
+    pages.swap(packed);
+    generation++;
+
+    return code;
+}
+
+GLTextureAtlas2::Page::Page(const std::size_t size_) NOTHROWS :
+    size(size_),
+    texid(0),
+    height(0u)
+{}
+
+bool GLTextureAtlas2::Page::allocate(int *x, int *y, const std::size_t w, const std::size_t h) NOTHROWS
+{
+    Shelf *fit = nullptr;
+    for (auto it = shelves.begin(); it != shelves.end(); it++) {
+        if (it->height < h || (size - it->width) < w)
+            continue;
+        if (!fit || it->height < fit->height)
+            fit = &(*it);
+    }
+
+    // prefer a new shelf over wasting more than half the image height
+    if ((!fit || fit->height > (h + h / 2u)) && (size - height) >= h) {
+        Shelf shelf;
+        shelf.y = static_cast<int>(height);
+        shelf.height = h;
+        shelf.width = 0u;
+        shelves.push_back(shelf);
+        height += h;
+        fit = &shelves.back();
+    }
+    if (!fit)
+        return false;
+
+    *x = static_cast<int>(fit->width);
+    *y = fit->y;
+    fit->width += w;
+    return true;
+}
 
 bool GLTextureAtlas2::GLTextureAtlasRectComp::operator() (const GLTextureAtlas2::Rect &x, const GLTextureAtlas2::Rect &y) const
 {
@@ -506,3 +885,27 @@ bool GLTextureAtlas2::GLTextureAtlasRectComp::operator() (const GLTextureAtlas2:
     else
         return x.instance > y.instance;
 }
+
+namespace
+{
+    TAKErr createTexture(int *value, const std::size_t texSize) NOTHROWS
+    {
+        GLuint id = 0u;
+        glGenTextures(1, &id);
+        if (id == 0u)
+            return TE_Err;
+
+        glBindTexture(GL_TEXTURE_2D, id);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+            static_cast<GLsizei>(texSize), static_cast<GLsizei>(texSize), 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        *value = (int)id;
+        return TE_Ok;
+    }
+}
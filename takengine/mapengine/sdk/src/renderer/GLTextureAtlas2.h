@@ -2,8 +2,10 @@
 #define TAK_ENGINE_RENDERER_GLTEXTUREATLAS2_H_INCLUDED
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 #include "math/Rectangle.h"
@@ -22,6 +24,9 @@ namespace TAK {
             private :
                 struct Rect;
                 struct SheetRects;
+                struct Page;
+                struct Region;
+                struct Placement;
             private :
                 struct GLTextureAtlasRectComp
                 {
@@ -31,6 +36,21 @@ namespace TAK {
                 GLTextureAtlas2(const std::size_t texSize) NOTHROWS;
                 GLTextureAtlas2(const std::size_t texSize, const bool splitHorizontal) NOTHROWS;
                 GLTextureAtlas2(const std::size_t texSize, const std::size_t iconSize) NOTHROWS;
+                /**
+                 * Creates a new atlas. If `dynamic` is `true`, images are
+                 * shelf packed and reference counted via `retainImage` and
+                 * `releaseImage`. Unreferenced images remain available via
+                 * `getTextureKey` until evicted; eviction happens when the
+                 * atlas is out of space or on `compact()`, at which point
+                 * the referenced images are repacked into as few textures as
+                 * possible. Repacking preserves the key of an image but may
+                 * change its texture ID and offsets; clients should
+                 * re-query those whenever `getGeneration()` changes.
+                 *
+                 * @param iconSize  If non-zero, all images are scaled to
+                 *                  `iconSize` x `iconSize`
+                 */
+                GLTextureAtlas2(const std::size_t texSize, const std::size_t iconSize, const bool dynamic) NOTHROWS;
             public :
                 ~GLTextureAtlas2() NOTHROWS;
             public :
@@ -49,7 +69,52 @@ namespace TAK {
                 Util::TAKErr getIndex(int * value, const int64_t key) const NOTHROWS;
                 Util::TAKErr getImageTextureOffsetX(std::size_t *value, const int64_t key) const NOTHROWS;
                 Util::TAKErr getImageTextureOffsetY(std::size_t *value, const int64_t key) const NOTHROWS;
+                /**
+                 * Adds the image to the atlas. For a dynamic atlas, the
+                 * returned key holds one reference on behalf of the caller.
+                 */
                 Util::TAKErr addImage(int64_t *value, const char *uri, const Bitmap2 &bitmap) NOTHROWS;
+
+                bool isDynamic() const NOTHROWS;
+                /**
+                 * Acquires a reference on the image. Images obtained via
+                 * `getTextureKey` must be retained before use. No-op if the
+                 * atlas is not dynamic.
+                 */
+                Util::TAKErr retainImage(const int64_t key) NOTHROWS;
+                /**
+                 * Releases a reference on the image. The image becomes
+                 * eligible for eviction once it is no longer referenced.
+                 * No-op if the atlas is not dynamic.
+                 */
+                Util::TAKErr releaseImage(const int64_t key) NOTHROWS;
+                /**
+                 * Evicts unreferenced images and repacks the referenced
+                 * images if doing so would free at least one texture. No-op
+                 * if the atlas is not dynamic. Must be invoked on the GL
+                 * thread.
+                 */
+                Util::TAKErr compact() NOTHROWS;
+                /**
+                 * Returns a counter that is incremented whenever images are
+                 * relocated or the atlas is released.
+                 */
+                std::size_t getGeneration() const NOTHROWS;
+            private:
+                Util::TAKErr addDynamicImage(int64_t *value, const char *uri, const Bitmap2 &bitmap) NOTHROWS;
+                const Region *getRegion(const int64_t key) const NOTHROWS;
+                /**
+                 * Shelf packs the referenced images, plus an optional
+                 * pending image (key `0`), into new pages. No textures are
+                 * created.
+                 */
+                void packReferenced(std::vector<std::unique_ptr<Page>> &packed, std::vector<Placement> &placements, const std::size_t pendingWidth, const std::size_t pendingHeight) const NOTHROWS;
+                /**
+                 * Creates the textures for `packed`, copies the referenced
+                 * images into their new locations and evicts the
+                 * unreferenced images.
+                 */
+                Util::TAKErr repack(std::vector<std::unique_ptr<Page>> &packed, const std::vector<Placement> &placements) NOTHROWS;
             private:
                 std::map<std::string, int64_t> uriToKey;
                 const std::size_t texSize;
@@ -65,6 +130,13 @@ namespace TAK {
 
                 std::unique_ptr<SheetRects> sheetRects;
                 SheetRects *currentSheetRects;
+
+                const bool dynamic;
+                std::map<int64_t, Region> regions;
+                std::vector<std::unique_ptr<Page>> pages;
+                int64_t nextKey;
+                std::size_t unreferencedArea;
+                std::size_t generation;
             };
 
             struct GLTextureAtlas2::Rect
@@ -101,6 +173,50 @@ namespace TAK {
 
                 
             };
+
+            struct GLTextureAtlas2::Page : TAK::Engine::Util::NonCopyable
+            {
+            public :
+                Page(const std::size_t size) NOTHROWS;
+            public :
+                /**
+                 * Allocates a region on the first shelf that fits with
+                 * limited waste, opening a new shelf if necessary. Returns
+                 * `false` if the page cannot accommodate the region.
+                 */
+                bool allocate(int *x, int *y, const std::size_t width, const std::size_t height) NOTHROWS;
+            public :
+                const std::size_t size;
+                int texid;
+            private :
+                struct Shelf
+                {
+                    int y;
+                    std::size_t height;
+                    std::size_t width;
+                };
+                std::vector<Shelf> shelves;
+                std::size_t height;
+            };
+
+            struct GLTextureAtlas2::Region
+            {
+                int texid;
+                int x;
+                int y;
+                std::size_t width;
+                std::size_t height;
+                std::size_t references;
+                std::string uri;
+            };
+
+            struct GLTextureAtlas2::Placement
+            {
+                int64_t key;
+                std::size_t page;
+                int x;
+                int y;
+            };
         }
     }
 }
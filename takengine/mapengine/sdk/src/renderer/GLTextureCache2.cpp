@@ -1,17 +1,56 @@
 #include "renderer/GLTextureCache2.h"
 
 #include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/Memory.h"
+#include "util/MemoryAccounting.h"
 
 using namespace TAK::Engine::Renderer;
 
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
+/**
+ * Texture IDs evicted from the cache, pending deletion on the GL thread.
+ * Shared with the queued flush event so the queue outlives the cache if
+ * the cache is destroyed while a flush is pending.
+ */
+struct GLTextureCache2::ReleaseQueue
+{
+    Mutex mutex;
+    std::vector<GLuint> textures;
+    bool scheduled {false};
+
+    static void glFlush(void *opaque) NOTHROWS;
+};
+
 GLTextureCache2::GLTextureCache2(const std::size_t maxSize_) NOTHROWS :
     head(nullptr),
     tail(nullptr),
     maxSize(maxSize_),
-    size(0u),
-    count(0u)
+    maxResidentSize(maxSize_),
+    maxCpuSize(maxSize_),
+    residentSize(0u),
+    cpuSize(0u),
+    count(0u),
+    ctx(nullptr)
+{}
+
+GLTextureCache2::GLTextureCache2(const std::size_t maxResidentSize_, const std::size_t maxCpuSize_, TAK::Engine::Core::RenderContext &ctx_) NOTHROWS :
+    head(nullptr),
+    tail(nullptr),
+    maxSize(maxResidentSize_ + maxCpuSize_),
+    maxResidentSize(maxResidentSize_),
+    maxCpuSize(maxCpuSize_),
+    residentSize(0u),
+    cpuSize(0u),
+    count(0u),
+    ctx(&ctx_),
+    releaseQueue(std::make_shared<ReleaseQueue>())
 {}
 
 GLTextureCache2::~GLTextureCache2()
@@ -26,43 +65,71 @@ GLTextureCache2::~GLTextureCache2()
         count--;
     }
     tail = nullptr;
-    size = 0u;
+    MemoryAccounting_release(TEMC_TextureCache, residentSize + cpuSize);
+    residentSize = 0u;
+    cpuSize = 0u;
 }
 
 TAKErr GLTextureCache2::get(const GLTextureCache2::Entry **value, const char *key) const NOTHROWS
+{
+    BidirectionalNode *node = find(key);
+    if (!node)
+        return TE_InvalidArg;
+    *value = node->value.get();
+    return TE_Ok;
+}
+
+TAKErr GLTextureCache2::get(const GLTextureCache2::Entry **value, const uint64_t key) const NOTHROWS
 {
     auto entry = nodeMap.find(key);
     if (entry == nodeMap.end())
         return TE_InvalidArg;
 
-    BidirectionalNode *node = entry->second;
-    *value = node->value.get();
+    *value = entry->second->value.get();
     return TE_Ok;
 }
 
 TAKErr GLTextureCache2::deleteEntry(const char *key) NOTHROWS
+{
+    BidirectionalNode *node = find(key);
+    if (!node)
+        return TE_InvalidArg;
+    return deleteEntry(node->key);
+}
+
+TAKErr GLTextureCache2::deleteEntry(const uint64_t key) NOTHROWS
 {
     TAKErr code;
     GLTextureCache2::EntryPtr entry(nullptr, nullptr);
     code = this->remove(entry, key);
     TE_CHECKRETURN_CODE(code);
     if (entry->texture.get())
-        entry->texture->release();
+        releaseTexture(*entry->texture);
     return code;
 }
 
 TAKErr GLTextureCache2::remove(GLTextureCache2::EntryPtr &val, const char *key) NOTHROWS
 {
-    TAKErr code;
-
-    code = TE_Ok;
+    BidirectionalNode *node = find(key);
+    if (!node)
+        return TE_InvalidArg;
+    nodeMap.erase(node->key);
+    return removeImpl(val, node);
+}
 
+TAKErr GLTextureCache2::remove(GLTextureCache2::EntryPtr &val, const uint64_t key) NOTHROWS
+{
     auto entry = nodeMap.find(key);
     if (entry == nodeMap.end())
         return TE_InvalidArg;
 
     BidirectionalNode *node = entry->second;
     nodeMap.erase(entry);
+    return removeImpl(val, node);
+}
+
+TAKErr GLTextureCache2::removeImpl(GLTextureCache2::EntryPtr &val, BidirectionalNode *node) NOTHROWS
+{
     val = std::move(node->value);
 
     if (node->prev != nullptr) {
@@ -81,24 +148,36 @@ TAKErr GLTextureCache2::remove(GLTextureCache2::EntryPtr &val, const char *key)
             tail->next = nullptr;
     }
 
+    residentSize -= node->residentSize;
+    cpuSize -= node->cpuSize;
+    MemoryAccounting_release(TEMC_TextureCache, node->residentSize + node->cpuSize);
+
     delete node;
 
     count--;
-    
-    if (val->texture.get()) {
-        std::size_t texSize;
-        code = sizeOf(&texSize, *val->texture);
-        TE_CHECKRETURN_CODE(code);
-        size -= texSize + val->opaqueSize;
-    }
 
-    return code;
+    return TE_Ok;
 }
 
 TAKErr GLTextureCache2::put(const char *key, EntryPtr &&value) NOTHROWS
+{
+    if (!key)
+        return TE_InvalidArg;
+    return putImpl(hashKey(key), key, std::move(value));
+}
+
+TAKErr GLTextureCache2::put(const uint64_t key, EntryPtr &&value) NOTHROWS
+{
+    return putImpl(key, nullptr, std::move(value));
+}
+
+TAKErr GLTextureCache2::putImpl(const uint64_t key, const char *name, EntryPtr &&value) NOTHROWS
 {
     TAKErr code;
 
+    if (!value.get())
+        return TE_InvalidArg;
+
     // if there is already an entry we will replace it
     if (this->nodeMap.find(key) != this->nodeMap.end()) {
         code = deleteEntry(key);
@@ -113,15 +192,17 @@ TAKErr GLTextureCache2::put(const char *key, EntryPtr &&value) NOTHROWS
         TE_CHECKRETURN_CODE(code);
     }
 
-    std::unique_ptr<BidirectionalNode> nodePtr(new BidirectionalNode(tail, key, std::move(value)));
+    std::unique_ptr<BidirectionalNode> nodePtr(new BidirectionalNode(tail, key, name, std::move(value), texSize));
     BidirectionalNode *node = nodePtr.get();
-    nodeMap.insert(std::pair<std::string, BidirectionalNode *>(key, nodePtr.release()));
+    nodeMap.insert(std::make_pair(node->key, nodePtr.release()));
     if (head == nullptr)
         head = node;
     tail = node;
 
     count++;
-    size += texSize + tail->value->opaqueSize;
+    residentSize += node->residentSize;
+    cpuSize += node->cpuSize;
+    MemoryAccounting_allocate(TEMC_TextureCache, node->residentSize + node->cpuSize);
 
     code = trimToSize();
     TE_CHECKRETURN_CODE(code);
@@ -137,48 +218,116 @@ TAKErr GLTextureCache2::clear() NOTHROWS
 
         head = head->next;
         if (n->value->texture.get())
-            n->value->texture->release();
+            releaseTexture(*n->value->texture);
         delete n;
         count--;
     }
     tail = nullptr;
-    size = 0u;
+    MemoryAccounting_release(TEMC_TextureCache, residentSize + cpuSize);
+    residentSize = 0u;
+    cpuSize = 0u;
 
     return TE_Ok;
 }
 
-TAKErr GLTextureCache2::trimToSize() NOTHROWS
+TAKErr GLTextureCache2::trim(const std::size_t budget) NOTHROWS
 {
-    TAKErr code;
+    return trimImpl(budget, 0u);
+}
 
-    code = TE_Ok;
+std::size_t GLTextureCache2::getMaxSize() const NOTHROWS
+{
+    return maxSize;
+}
+
+std::size_t GLTextureCache2::getResidentSize() const NOTHROWS
+{
+    return residentSize;
+}
+
+std::size_t GLTextureCache2::getCpuSize() const NOTHROWS
+{
+    return cpuSize;
+}
+
+TAKErr GLTextureCache2::trimToSize() NOTHROWS
+{
+    // always retain the most recently added entry
+    return trimImpl(maxSize, 1u);
+}
 
-    std::size_t releasedSize;
-    while (size > maxSize && nodeMap.size() > 1) {
+TAKErr GLTextureCache2::trimImpl(const std::size_t limit, const std::size_t minCount) NOTHROWS
+{
+    while ((residentSize > maxResidentSize || cpuSize > maxCpuSize || (residentSize + cpuSize) > limit) && count > minCount) {
         BidirectionalNode *n = head;
-        if (n->value->texture.get()) {
-            code = sizeOf(&releasedSize, *n->value->texture);
-            TE_CHECKBREAK_CODE(code);
-            releasedSize += n->value->opaqueSize;
-        } else {
-            releasedSize = n->value->opaqueSize;
-        }
-        nodeMap.erase(head->key);
+        nodeMap.erase(n->key);
         head = head->next;
-        head->prev = nullptr;
+        if (head)
+            head->prev = nullptr;
+        else
+            tail = nullptr;
         count--;
         if (n->value->texture.get())
-            n->value->texture->release();
+            releaseTexture(*n->value->texture);
+        residentSize -= n->residentSize;
+        cpuSize -= n->cpuSize;
+        MemoryAccounting_release(TEMC_TextureCache, n->residentSize + n->cpuSize);
         delete n;
-        size -= releasedSize;
     }
-    TE_CHECKRETURN_CODE(code);
 
-    return code;
+    return TE_Ok;
+}
+
+void GLTextureCache2::releaseTexture(GLTexture2 &texture) NOTHROWS
+{
+    if (!releaseQueue) {
+        texture.release();
+        return;
+    }
+
+    GLuint id = 0u;
+    if (GLTexture2_orphan(&id, texture) != TE_Ok || !id)
+        return;
+
+    Lock lock(releaseQueue->mutex);
+    if (lock.status != TE_Ok) {
+        glDeleteTextures(1, &id);
+        return;
+    }
+    releaseQueue->textures.push_back(id);
+    if (releaseQueue->scheduled)
+        return;
+    std::unique_ptr<void, void(*)(const void *)> opaque(new std::shared_ptr<ReleaseQueue>(releaseQueue), Memory_void_deleter_const<std::shared_ptr<ReleaseQueue>>);
+    if (ctx->queueEvent(ReleaseQueue::glFlush, std::move(opaque)) == TE_Ok) {
+        releaseQueue->scheduled = true;
+    } else {
+        // unable to defer, release everything outstanding immediately
+        glDeleteTextures((GLsizei)releaseQueue->textures.size(), releaseQueue->textures.data());
+        releaseQueue->textures.clear();
+    }
+}
+
+GLTextureCache2::BidirectionalNode *GLTextureCache2::find(const char *key) const NOTHROWS
+{
+    if (!key)
+        return nullptr;
+    auto entry = nodeMap.find(hashKey(key));
+    if (entry == nodeMap.end())
+        return nullptr;
+    // verify the key to guard against hash collisions
+    const char *name = entry->second->name.get();
+    if (!name || strcmp(name, key))
+        return nullptr;
+    return entry->second;
 }
 
 TAKErr GLTextureCache2::sizeOf(std::size_t *value, const GLTexture2 &texture) NOTHROWS
 {
+    if (texture.isCompressed()) {
+        *value = texture.getCompressedSize();
+        return TE_Ok;
+    }
+
     int bytesPerPixel;
     switch (texture.getType()) {
     case GL_UNSIGNED_BYTE:
@@ -211,11 +360,52 @@ TAKErr GLTextureCache2::sizeOf(std::size_t *value, const GLTexture2 &texture) NO
 }
 
 
-GLTextureCache2::BidirectionalNode::BidirectionalNode(BidirectionalNode *prev_, std::string key_, EntryPtr &&value_) NOTHROWS :
+uint64_t GLTextureCache2::hashKey(const char *key, const uint64_t seed) NOTHROWS
+{
+    // FNV-1a
+    uint64_t hash = seed;
+    if (key) {
+        for (const char *c = key; *c; c++) {
+            hash ^= (uint8_t)*c;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+uint64_t GLTextureCache2::hashKey(const uint64_t seed, const int64_t value) NOTHROWS
+{
+    uint64_t hash = seed;
+    for (std::size_t i = 0u; i < 8u; i++) {
+        hash ^= ((uint64_t)value >> (i * 8u)) & 0xFFu;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void GLTextureCache2::ReleaseQueue::glFlush(void *opaque) NOTHROWS
+{
+    ReleaseQueue &queue = **static_cast<std::shared_ptr<ReleaseQueue> *>(opaque);
+    std::vector<GLuint> textures;
+    {
+        Lock lock(queue.mutex);
+        if (lock.status != TE_Ok)
+            return;
+        textures.swap(queue.textures);
+        queue.scheduled = false;
+    }
+    if (!textures.empty())
+        glDeleteTextures((GLsizei)textures.size(), textures.data());
+}
+
+GLTextureCache2::BidirectionalNode::BidirectionalNode(BidirectionalNode *prev_, const uint64_t key_, const char *name_, EntryPtr &&value_, const std::size_t residentSize_) NOTHROWS :
     prev(prev_),
     next(nullptr),
     key(key_),
-    value(std::move(value_))
+    name(name_),
+    value(std::move(value_)),
+    residentSize(residentSize_),
+    cpuSize(value->opaqueSize)
 {
     if (prev != nullptr)
         prev->next = this;
@@ -1,12 +1,15 @@
 #ifndef TAK_ENGINE_RENDERER_GLTEXTURECACHE2_H_INCLUDED
 #define TAK_ENGINE_RENDERER_GLTEXTURECACHE2_H_INCLUDED
 
-#include <map>
-#include <string>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
 
 #include "renderer/GL.h"
 
+#include "core/RenderContext.h"
 #include "port/Platform.h"
+#include "port/String.h"
 #include "renderer/GLTexture2.h"
 #include "renderer/Bitmap2.h"
 
@@ -14,6 +17,21 @@ namespace TAK {
     namespace Engine {
         namespace Renderer {
 
+            /**
+             * LRU cache of GL textures and associated data.
+             *
+             * <P>Entries may be keyed by string or by 64-bit hash; string
+             * keys are hashed internally and verified on lookup, while
+             * hashed keys avoid building and comparing a string per query.
+             * Callers should not mix the two for the same entry.
+             *
+             * <P>The cache accounts for two tiers separately: GPU resident
+             * texture storage and CPU side data (`Entry::opaqueSize`).
+             * Least recently used entries are evicted until both tiers are
+             * within budget.
+             *
+             * <P>All methods must be invoked on the GL thread.
+             */
             class ENGINE_API GLTextureCache2
             {
             public:
@@ -21,37 +39,89 @@ namespace TAK {
                 typedef std::unique_ptr<Entry, void(*)(const Entry *)> EntryPtr;
             private :
                 struct BidirectionalNode;
+                struct ReleaseQueue;
             public:
+                /**
+                 * Creates a cache with a single budget shared by both
+                 * tiers. Evicted textures are released immediately.
+                 */
                 GLTextureCache2(const std::size_t maxSize) NOTHROWS;
+                /**
+                 * Creates a cache with separate budgets for each tier.
+                 * Textures evicted on insert are queued and deleted as a
+                 * batch by an event on `ctx`, outside of the frame that
+                 * caused the eviction.
+                 */
+                GLTextureCache2(const std::size_t maxResidentSize, const std::size_t maxCpuSize, TAK::Engine::Core::RenderContext &ctx) NOTHROWS;
             public :
                 ~GLTextureCache2() NOTHROWS;
             public :
                 Util::TAKErr get(const Entry **value, const char *key) const NOTHROWS;
+                Util::TAKErr get(const Entry **value, const uint64_t key) const NOTHROWS;
                 Util::TAKErr remove(EntryPtr &value, const char *key) NOTHROWS;
+                Util::TAKErr remove(EntryPtr &value, const uint64_t key) NOTHROWS;
                 Util::TAKErr put(const char *key, EntryPtr &&value) NOTHROWS;
+                Util::TAKErr put(const uint64_t key, EntryPtr &&value) NOTHROWS;
                 Util::TAKErr clear() NOTHROWS;
                 Util::TAKErr deleteEntry(const char *key) NOTHROWS;
+                Util::TAKErr deleteEntry(const uint64_t key) NOTHROWS;
+                /**
+                 * Evicts least recently used entries, releasing their GL
+                 * resources, until the cache size does not exceed the
+                 * specified budget. Must be invoked on the GL thread.
+                 */
+                Util::TAKErr trim(const std::size_t budget) NOTHROWS;
+                std::size_t getMaxSize() const NOTHROWS;
+                /** returns the bytes of GPU texture storage retained */
+                std::size_t getResidentSize() const NOTHROWS;
+                /** returns the bytes of CPU side data retained */
+                std::size_t getCpuSize() const NOTHROWS;
             public :
                 static Util::TAKErr sizeOf(std::size_t *value, const GLTexture2 &texture) NOTHROWS;
+                /**
+                 * Computes a 64-bit key for the specified string, optionally
+                 * chained from a previously computed key.
+                 */
+                static uint64_t hashKey(const char *key, const uint64_t seed = 0xcbf29ce484222325ULL) NOTHROWS;
+                /**
+                 * Computes a 64-bit key chaining `value` on to `seed`.
+                 */
+                static uint64_t hashKey(const uint64_t seed, const int64_t value) NOTHROWS;
             private:
+                Util::TAKErr putImpl(const uint64_t key, const char *name, EntryPtr &&value) NOTHROWS;
+                Util::TAKErr removeImpl(EntryPtr &value, BidirectionalNode *node) NOTHROWS;
                 Util::TAKErr trimToSize() NOTHROWS;
+                Util::TAKErr trimImpl(const std::size_t limit, const std::size_t minCount) NOTHROWS;
+                void releaseTexture(GLTexture2 &texture) NOTHROWS;
+                BidirectionalNode *find(const char *key) const NOTHROWS;
             private :
-                std::map<std::string, BidirectionalNode *> nodeMap;
+                std::unordered_map<uint64_t, BidirectionalNode *> nodeMap;
                 BidirectionalNode *head;
                 BidirectionalNode *tail;
                 std::size_t maxSize;
-                std::size_t size;
+                std::size_t maxResidentSize;
+                std::size_t maxCpuSize;
+                std::size_t residentSize;
+                std::size_t cpuSize;
                 std::size_t count;
+                TAK::Engine::Core::RenderContext *ctx;
+                std::shared_ptr<ReleaseQueue> releaseQueue;
             };
 
             struct GLTextureCache2::BidirectionalNode
             {
                 BidirectionalNode *prev;
                 BidirectionalNode *next;
-                std::string key;
+                uint64_t key;
+                /** the string key, if the entry was inserted with one */
+                Port::String name;
                 GLTextureCache2::EntryPtr value;
+                /** bytes recorded against the resident tier */
+                std::size_t residentSize;
+                /** bytes recorded against the CPU tier */
+                std::size_t cpuSize;
 
-                BidirectionalNode(BidirectionalNode *prev, std::string key, EntryPtr &&value) NOTHROWS;
+                BidirectionalNode(BidirectionalNode *prev, const uint64_t key, const char *name, EntryPtr &&value, const std::size_t residentSize) NOTHROWS;
             };
 
             struct ENGINE_API GLTextureCache2::Entry
@@ -0,0 +1,127 @@
+#include "renderer/GLTexturePool.h"
+
+#include "renderer/GLTextureCache2.h"
+#include "util/MemoryAccounting.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    bool isCompatible(const GLTexture2 &a, const GLTexture2 &b) NOTHROWS
+    {
+        return a.getTexWidth() == b.getTexWidth() &&
+               a.getTexHeight() == b.getTexHeight() &&
+               a.getFormat() == b.getFormat() &&
+               a.getType() == b.getType();
+    }
+}
+
+GLTexturePool::GLTexturePool(const std::size_t maxSize_) NOTHROWS :
+    maxSize(maxSize_),
+    size(0u)
+{}
+
+GLTexturePool::~GLTexturePool() NOTHROWS
+{
+    // GL resources must be released on the GL thread via `release()`
+    for (auto it = textures.begin(); it != textures.end(); it++) {
+        for (auto tex = it->second.begin(); tex != it->second.end(); tex++) {
+            GLuint id;
+            GLTexture2_orphan(&id, **tex);
+        }
+    }
+    MemoryAccounting_release(TEMC_TexturePool, size);
+}
+
+TAKErr GLTexturePool::acquire(GLTexture2Ptr &value, const std::size_t width, const std::size_t height, const int format, const int type) NOTHROWS
+{
+    GLTexture2Ptr result(new(std::nothrow) GLTexture2(width, height, format, type), Memory_deleter_const<GLTexture2>);
+    if (!result)
+        return TE_OutOfMemory;
+
+    auto entry = textures.find(key(*result));
+    if (entry != textures.end()) {
+        std::vector<GLTexture2Ptr> &bucket = entry->second;
+        for (std::size_t i = bucket.size(); i > 0u; i--) {
+            if (!isCompatible(*bucket[i - 1u], *result))
+                continue;
+            std::size_t texSize;
+            GLTextureCache2::sizeOf(&texSize, *bucket[i - 1u]);
+            size -= texSize;
+            MemoryAccounting_release(TEMC_TexturePool, texSize);
+            result = std::move(bucket[i - 1u]);
+            bucket.erase(bucket.begin() + (i - 1u));
+            if (bucket.empty())
+                textures.erase(entry);
+            break;
+        }
+    }
+
+    value = std::move(result);
+    return TE_Ok;
+}
+
+void GLTexturePool::recycle(GLTexture2Ptr &&texture) NOTHROWS
+{
+    if (!texture)
+        return;
+    std::size_t texSize = 0u;
+    const bool retain = !texture->isCompressed() &&
+                        static_cast<const GLTexture2 &>(*texture).getTexId() &&
+                        GLTextureCache2::sizeOf(&texSize, *texture) == TE_Ok &&
+                        (size + texSize) <= maxSize;
+    if (!retain) {
+        texture->release();
+        texture.reset();
+        return;
+    }
+
+    size += texSize;
+    MemoryAccounting_allocate(TEMC_TexturePool, texSize);
+    textures[key(*texture)].push_back(std::move(texture));
+}
+
+void GLTexturePool::trim(const std::size_t budget) NOTHROWS
+{
+    auto it = textures.begin();
+    while (size > budget && it != textures.end()) {
+        std::vector<GLTexture2Ptr> &bucket = it->second;
+        while (size > budget && !bucket.empty()) {
+            std::size_t texSize;
+            GLTextureCache2::sizeOf(&texSize, *bucket.back());
+            size -= texSize;
+            MemoryAccounting_release(TEMC_TexturePool, texSize);
+            bucket.back()->release();
+            bucket.pop_back();
+        }
+        if (bucket.empty())
+            it = textures.erase(it);
+        else
+            it++;
+    }
+}
+
+void GLTexturePool::release() NOTHROWS
+{
+    trim(0u);
+}
+
+std::size_t GLTexturePool::getSize() const NOTHROWS
+{
+    return size;
+}
+
+std::size_t GLTexturePool::getMaxSize() const NOTHROWS
+{
+    return maxSize;
+}
+
+uint64_t GLTexturePool::key(const GLTexture2 &texture) NOTHROWS
+{
+    uint64_t value = GLTextureCache2::hashKey(0xcbf29ce484222325ULL, (int64_t)texture.getTexWidth());
+    value = GLTextureCache2::hashKey(value, (int64_t)texture.getTexHeight());
+    value = GLTextureCache2::hashKey(value, texture.getFormat());
+    return GLTextureCache2::hashKey(value, texture.getType());
+}
@@ -0,0 +1,75 @@
+#ifndef TAK_ENGINE_RENDERER_GLTEXTUREPOOL_H_INCLUDED
+#define TAK_ENGINE_RENDERER_GLTEXTUREPOOL_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "port/Platform.h"
+#include "renderer/GLTexture2.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Pool of uncompressed textures with allocated storage, keyed by
+             * dimensions, format and type. A texture acquired from the pool
+             * may be loaded via `glTexSubImage2D` without reallocating its
+             * storage.
+             *
+             * <P>Retained textures are recorded against `TEMC_TexturePool`,
+             * in addition to `TEMC_Texture`. Textures recycled while the
+             * pool is at its budget are released.
+             *
+             * <P>All methods must be invoked on the GL thread.
+             */
+            class ENGINE_API GLTexturePool
+            {
+            public :
+                /**
+                 * @param maxSize   The maximum bytes of texture storage
+                 *                  retained by the pool
+                 */
+                GLTexturePool(const std::size_t maxSize) NOTHROWS;
+                ~GLTexturePool() NOTHROWS;
+            private :
+                GLTexturePool(const GLTexturePool &) NOTHROWS;
+            public :
+                /**
+                 * Acquires a texture of the specified dimensions, format and
+                 * type. A pooled texture is returned if available, otherwise
+                 * a new, uninitialized texture is created.
+                 */
+                Util::TAKErr acquire(GLTexture2Ptr &value, const std::size_t width, const std::size_t height, const int format, const int type) NOTHROWS;
+                /**
+                 * Returns the texture to the pool. Compressed or
+                 * uninitialized textures, and textures that would exceed the
+                 * budget, are released.
+                 */
+                void recycle(GLTexture2Ptr &&texture) NOTHROWS;
+                /**
+                 * Releases pooled textures until the retained size does not
+                 * exceed the specified budget.
+                 */
+                void trim(const std::size_t budget) NOTHROWS;
+                /**
+                 * Releases all pooled textures.
+                 */
+                void release() NOTHROWS;
+                /** returns the bytes of texture storage retained */
+                std::size_t getSize() const NOTHROWS;
+                std::size_t getMaxSize() const NOTHROWS;
+            private :
+                static uint64_t key(const GLTexture2 &texture) NOTHROWS;
+            private :
+                const std::size_t maxSize;
+                std::size_t size;
+                std::unordered_map<uint64_t, std::vector<GLTexture2Ptr>> textures;
+            };
+        }
+    }
+}
+
+#endif
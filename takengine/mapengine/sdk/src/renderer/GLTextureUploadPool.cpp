@@ -0,0 +1,197 @@
+#include "renderer/GLTextureUploadPool.h"
+
+#include <cstdio>
+
+#include "thread/Lock.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    bool isES3Context() NOTHROWS;
+}
+
+GLTextureUploadPool::GLTextureUploadPool(const std::size_t bufferSize_, const std::size_t limit_) NOTHROWS :
+    bufferSize(bufferSize_),
+    limit(limit_),
+    released(false),
+    supported(-1)
+{}
+
+GLTextureUploadPool::~GLTextureUploadPool() NOTHROWS
+{
+    // GL resources must be released on the GL thread via `release()`
+}
+
+void GLTextureUploadPool::prepare() NOTHROWS
+{
+    if (supported < 0)
+        supported = isES3Context() ? 1 : 0;
+    if (!supported)
+        return;
+#if TE_GLES_VERSION >= 3
+    Lock lock(mutex);
+    TE_CHECKRETURN(lock.status);
+
+    released = false;
+
+    // fences signal in order; retire completed uploads for re-mapping
+    std::vector<Buffer *> remap;
+    while (!pending.empty()) {
+        Buffer *buffer = pending.front();
+        if (buffer->fence) {
+            const GLenum result = glClientWaitSync(buffer->fence, 0, 0);
+            if (result == GL_TIMEOUT_EXPIRED)
+                break;
+            glDeleteSync(buffer->fence);
+            buffer->fence = nullptr;
+        }
+        pending.pop_front();
+        remap.push_back(buffer);
+    }
+    while (buffers.size() < limit) {
+        std::unique_ptr<Buffer> buffer(new(std::nothrow) Buffer());
+        if (!buffer)
+            break;
+        buffer->data = nullptr;
+        buffer->capacity = bufferSize;
+        buffer->handle = GL_NONE;
+        buffer->fence = nullptr;
+        glGenBuffers(1u, &buffer->handle);
+        if (!buffer->handle)
+            break;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->handle);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bufferSize), nullptr, GL_STREAM_DRAW);
+        remap.push_back(buffer.get());
+        buffers.push_back(std::move(buffer));
+    }
+
+    for (auto it = remap.begin(); it != remap.end(); it++) {
+        Buffer &buffer = **it;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+        buffer.data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bufferSize), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (buffer.data)
+            mapped.push_back(&buffer);
+        else
+            destroy(buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+#endif
+}
+
+std::size_t GLTextureUploadPool::getBufferSize() const NOTHROWS
+{
+    return bufferSize;
+}
+
+GLTextureUploadPool::Buffer *GLTextureUploadPool::acquire() NOTHROWS
+{
+    Lock lock(mutex);
+    if (lock.status != TE_Ok || mapped.empty())
+        return nullptr;
+    Buffer *buffer = mapped.front();
+    mapped.pop_front();
+    return buffer;
+}
+
+TAKErr GLTextureUploadPool::upload(GLTexture2 &texture, Buffer &buffer, const int x, const int y, const std::size_t w, const std::size_t h) NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    TAKErr code(TE_Ok);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+    // contents are undefined if unmapping fails
+    const bool intact = (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+    buffer.data = nullptr;
+
+    code = intact ? texture.load(buffer.handle, 0u, x, y, w, h) : TE_Err;
+
+    Lock lock(mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+    if (released) {
+        destroy(buffer);
+    } else {
+        buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pending.push_back(&buffer);
+    }
+    return code;
+#else
+    recycle(buffer);
+    return TE_Unsupported;
+#endif
+}
+
+void GLTextureUploadPool::recycle(Buffer &buffer) NOTHROWS
+{
+    Lock lock(mutex);
+    TE_CHECKRETURN(lock.status);
+    if (released)
+        destroy(buffer);
+    else
+        mapped.push_back(&buffer);
+}
+
+void GLTextureUploadPool::release() NOTHROWS
+{
+    Lock lock(mutex);
+    TE_CHECKRETURN(lock.status);
+    while (!mapped.empty()) {
+        Buffer *buffer = mapped.front();
+        mapped.pop_front();
+        destroy(*buffer);
+    }
+    while (!pending.empty()) {
+        Buffer *buffer = pending.front();
+        pending.pop_front();
+        destroy(*buffer);
+    }
+    released = true;
+}
+
+void GLTextureUploadPool::destroy(Buffer &buffer) NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    if (buffer.data) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.handle);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GL_NONE);
+        buffer.data = nullptr;
+    }
+    if (buffer.fence) {
+        glDeleteSync(buffer.fence);
+        buffer.fence = nullptr;
+    }
+#endif
+    if (buffer.handle) {
+        glDeleteBuffers(1u, &buffer.handle);
+        buffer.handle = GL_NONE;
+    }
+    for (auto it = buffers.begin(); it != buffers.end(); it++) {
+        if ((*it).get() == &buffer) {
+            buffers.erase(it);
+            break;
+        }
+    }
+}
+
+namespace
+{
+    bool isES3Context() NOTHROWS
+    {
+#if TE_GLES_VERSION >= 3
+        const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+        if (!version)
+            return false;
+        int major = 0;
+        if (sscanf(version, "OpenGL ES %d", &major) != 1)
+            return false;
+        return major >= 3;
+#else
+        return false;
+#endif
+    }
+}
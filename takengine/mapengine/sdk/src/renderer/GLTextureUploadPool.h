@@ -0,0 +1,112 @@
+#ifndef TAK_ENGINE_RENDERER_GLTEXTUREUPLOADPOOL_H_INCLUDED
+#define TAK_ENGINE_RENDERER_GLTEXTUREUPLOADPOOL_H_INCLUDED
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "port/Platform.h"
+#include "renderer/GL.h"
+#include "renderer/GLTexture2.h"
+#include "thread/Mutex.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Pool of pixel unpack buffers for staging texture uploads off of
+             * the GL thread.
+             *
+             * <P>Buffers are mapped on the GL thread by `prepare()`. A mapped
+             * buffer may be acquired and filled with texel data on any
+             * thread; the GL thread then only issues the buffer-to-texture
+             * copy via `upload()`, which the driver may perform
+             * asynchronously. A buffer is re-mapped once the fence inserted
+             * after its copy has signaled.
+             *
+             * <P>Requires GLES3; on other contexts no buffers are made
+             * available and `acquire()` always returns `nullptr`.
+             */
+            class ENGINE_API GLTextureUploadPool
+            {
+            public :
+                struct Buffer
+                {
+                    /** mapped memory; valid until the buffer is uploaded or recycled */
+                    void *data;
+                    std::size_t capacity;
+                private :
+                    GLuint handle;
+#if TE_GLES_VERSION >= 3
+                    GLsync fence;
+#endif
+                    friend class GLTextureUploadPool;
+                };
+            public :
+                /**
+                 * @param bufferSize    The capacity of each buffer, in bytes
+                 * @param limit         The maximum number of buffers, mapped
+                 *                      or awaiting their upload fence
+                 */
+                GLTextureUploadPool(const std::size_t bufferSize, const std::size_t limit) NOTHROWS;
+                ~GLTextureUploadPool() NOTHROWS;
+            private :
+                GLTextureUploadPool(const GLTextureUploadPool &) NOTHROWS;
+            public :
+                /**
+                 * Retires buffers whose uploads have completed and maps
+                 * buffers up to the limit. Must be invoked on the GL thread.
+                 */
+                void prepare() NOTHROWS;
+                /**
+                 * Returns the capacity of each buffer, in bytes.
+                 */
+                std::size_t getBufferSize() const NOTHROWS;
+                /**
+                 * Acquires a mapped buffer. May be invoked on any thread.
+                 *
+                 * @return  A mapped buffer or `nullptr` if none is available.
+                 *          The buffer must subsequently be passed to either
+                 *          `upload` or `recycle`.
+                 */
+                Buffer *acquire() NOTHROWS;
+                /**
+                 * Copies the contents of the buffer, which must be in the
+                 * format and type of the texture, into the texture. The
+                 * buffer is relinquished regardless of the result. Must be
+                 * invoked on the GL thread.
+                 */
+                Util::TAKErr upload(GLTexture2 &texture, Buffer &buffer, const int x, const int y, const std::size_t w, const std::size_t h) NOTHROWS;
+                /**
+                 * Returns an acquired buffer to the pool without uploading.
+                 * Must be invoked on the GL thread.
+                 */
+                void recycle(Buffer &buffer) NOTHROWS;
+                /**
+                 * Releases all buffers not currently acquired. Acquired
+                 * buffers are released when subsequently uploaded or
+                 * recycled. Must be invoked on the GL thread.
+                 */
+                void release() NOTHROWS;
+            private :
+                void destroy(Buffer &buffer) NOTHROWS;
+            private :
+                const std::size_t bufferSize;
+                const std::size_t limit;
+                Thread::Mutex mutex;
+                /** all buffers owned by the pool */
+                std::vector<std::unique_ptr<Buffer>> buffers;
+                /** mapped, available for `acquire` */
+                std::deque<Buffer *> mapped;
+                /** unmapped, awaiting their upload fence */
+                std::deque<Buffer *> pending;
+                bool released;
+                int supported;
+            };
+        }
+    }
+}
+
+#endif
@@ -21,7 +21,7 @@ namespace TAK {
              *
              * @return  TE_Ok on success
              */
-            Util::TAKErr GLTriangulate2_triangulate(uint16_t *indices, std::size_t *idxCount, const float *vertices, const std::size_t stride, const std::size_t numVerts) NOTHROWS;
+            ENGINE_API Util::TAKErr GLTriangulate2_triangulate(uint16_t *indices, std::size_t *idxCount, const float *vertices, const std::size_t stride, const std::size_t numVerts) NOTHROWS;
 
             /**
              * Performs a 2D tessellation of the specified polygon.
@@ -34,7 +34,7 @@ namespace TAK {
              *
              * @return  TE_Ok on success
              */
-            Util::TAKErr GLTriangulate2_triangulate(uint16_t *indices, std::size_t *idxCount, const double *vertices, const std::size_t stride, const std::size_t numVerts) NOTHROWS;
+            ENGINE_API Util::TAKErr GLTriangulate2_triangulate(uint16_t *indices, std::size_t *idxCount, const double *vertices, const std::size_t stride, const std::size_t numVerts) NOTHROWS;
         }
     }
 }
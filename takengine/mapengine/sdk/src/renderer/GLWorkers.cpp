@@ -1,22 +1,27 @@
 
 #include "renderer/GLWorkers.h"
 
+#include "util/WorkerMetrics.h"
+
 using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Util;
 
-static std::shared_ptr<ControlWorker> makeGLControlWorker() NOTHROWS {
+static std::shared_ptr<ControlWorker> makeGLControlWorker(const char *name) NOTHROWS {
+	// loaders post from many threads while the render thread drains; the lock-free queue
+	// keeps the render thread from contending with producers
 	std::shared_ptr<ControlWorker> worker;
-	Worker_createControlWorker(worker);
+	if (Worker_createLockFreeControlWorker(worker) == TE_Ok)
+		WorkerMetrics_setName(*worker, name);
 	return worker;
 }
 
 static std::shared_ptr<ControlWorker> globalGLResourceControlWorker() NOTHROWS {
-	static std::shared_ptr<ControlWorker> inst(makeGLControlWorker());
+	static std::shared_ptr<ControlWorker> inst(makeGLControlWorker("gl-resource-load"));
 	return inst;
 }
 
 static std::shared_ptr<ControlWorker> globalGLThreadWorker() NOTHROWS {
-	static std::shared_ptr<ControlWorker> inst(makeGLControlWorker());
+	static std::shared_ptr<ControlWorker> inst(makeGLControlWorker("gl-thread"));
 	return inst;
 }
 
@@ -37,9 +42,13 @@ SharedWorkerPtr TAK::Engine::Renderer::GLWorkers_glThread() NOTHROWS {
 }
 
 TAKErr TAK::Engine::Renderer::GLWorkers_doGLThreadWork() NOTHROWS {
+	return GLWorkers_doGLThreadWork(INT64_MAX);
+}
+
+TAKErr TAK::Engine::Renderer::GLWorkers_doGLThreadWork(int64_t millisecondLimit) NOTHROWS {
 	std::shared_ptr<ControlWorker> worker = globalGLThreadWorker();
 	if (!worker)
 		return TE_Err;
-	worker->doAnyWork(INT64_MAX);
+	worker->doAnyWork(millisecondLimit);
 	return TE_Ok;
 }
\ No newline at end of file
@@ -21,8 +21,17 @@ namespace TAK {
 
 			ENGINE_API TAK::Engine::Util::SharedWorkerPtr GLWorkers_glThread() NOTHROWS;
 
+			/**
+			 * Do all pending GL thread work.
+			 */
 			ENGINE_API TAK::Engine::Util::TAKErr GLWorkers_doGLThreadWork() NOTHROWS;
 
+			/**
+			 * Do pending GL thread work with an upper time limit. Any work remaining when the
+			 * limit is reached is left for a subsequent call.
+			 */
+			ENGINE_API TAK::Engine::Util::TAKErr GLWorkers_doGLThreadWork(int64_t millisecondLimit) NOTHROWS;
+
 
 		}
 	}
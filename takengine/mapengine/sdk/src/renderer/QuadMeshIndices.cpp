@@ -0,0 +1,180 @@
+#include "renderer/QuadMeshIndices.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "renderer/GL.h"
+#include "renderer/GLTexture2.h"
+#include "renderer/Skirt.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/MemBuffer2.h"
+
+using namespace TAK::Engine::Renderer;
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    struct Entry
+    {
+        QuadMeshIndices value;
+        std::vector<uint16_t> indices;
+        std::vector<uint16_t> edgeIndices;
+    };
+
+    struct Key
+    {
+        std::size_t numCellsX;
+        std::size_t numCellsY;
+        bool skirt;
+
+        bool operator<(const Key &other) const NOTHROWS
+        {
+            if (numCellsX != other.numCellsX)
+                return numCellsX < other.numCellsX;
+            if (numCellsY != other.numCellsY)
+                return numCellsY < other.numCellsY;
+            return skirt < other.skirt;
+        }
+    };
+
+    Mutex &cacheMutex() NOTHROWS
+    {
+        static Mutex m;
+        return m;
+    }
+    std::map<Key, std::unique_ptr<Entry>> &cache() NOTHROWS
+    {
+        static std::map<Key, std::unique_ptr<Entry>> m;
+        return m;
+    }
+
+    TAKErr createEdgeIndices(MemBuffer2 &edgeIndices, const std::size_t numPostsX, const std::size_t numPostsY) NOTHROWS
+    {
+        // NOTE: edges are computed in CCW order
+
+        TAKErr code(TE_Ok);
+        // top edge (right-to-left), exclude last
+        for(int i = static_cast<int>(numPostsX)-1; i > 0; i--) {
+            code = edgeIndices.put<uint16_t>((uint16_t) i);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+        // left edge (bottom-to-top), exclude last
+        for(int i = 0; i < static_cast<int>(numPostsY-1u); i++) {
+            const std::size_t idx = (static_cast<std::size_t>(i)*numPostsX);
+            code = edgeIndices.put<uint16_t>((uint16_t)idx);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+        // bottom edge (left-to-right), exclude last
+        for(int i = 0; i < static_cast<int>(numPostsX-1u); i++) {
+            const std::size_t idx = ((numPostsY-1u)*numPostsX)+static_cast<std::size_t>(i);
+            code = edgeIndices.put<uint16_t>((uint16_t)idx);
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+        // right edge (top-to-bottom), exclude last
+        for(int i = static_cast<int>(numPostsY-1); i > 0; i--) {
+            code = edgeIndices.put<uint16_t>((uint16_t) ((i * numPostsX) + (numPostsX - 1)));
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        // close the loop by adding first-point-as-last
+        code = edgeIndices.put<uint16_t>((uint16_t)(numPostsX-1u));
+        TE_CHECKRETURN_CODE(code);
+
+        edgeIndices.flip();
+        return code;
+    }
+
+    TAKErr createEntry(Entry &entry, const std::size_t numCellsX, const std::size_t numCellsY, const bool skirt) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        const std::size_t numPostsX = numCellsX + 1u;
+        const std::size_t numPostsY = numCellsY + 1u;
+        // number of edge vertices is equal to perimeter length, plus one, to
+        // close the linestring
+        const std::size_t numEdgeVertices = skirt ? ((numPostsY-1u)*2u)+((numPostsX-1u)*2u) + 1u : 0u;
+
+        // all grid and skirt vertices must be addressable with 16-bit indices
+        if ((numPostsX*numPostsY) + Skirt_getNumOutputVertices(numEdgeVertices) > 0xFFFFu)
+            return TE_InvalidArg;
+
+        const std::size_t skirtOffset = GLTexture2_getNumQuadMeshIndices(numCellsX, numCellsY);
+        std::size_t numSkirtIndices = 0u;
+        if (skirt) {
+            code = Skirt_getNumOutputIndices(&numSkirtIndices, GL_TRIANGLE_STRIP, numEdgeVertices);
+            TE_CHECKRETURN_CODE(code);
+            numSkirtIndices += 2u; // degenerate link to skirt
+        }
+
+        entry.indices.resize(skirtOffset + numSkirtIndices);
+        MemBuffer2 indices(entry.indices.data(), entry.indices.size());
+        code = GLTexture2_createQuadMeshIndexBuffer(indices, GL_UNSIGNED_SHORT, numCellsX, numCellsY);
+        TE_CHECKRETURN_CODE(code);
+
+        if (skirt) {
+            entry.edgeIndices.resize(numEdgeVertices);
+            MemBuffer2 edgeIndices(entry.edgeIndices.data(), entry.edgeIndices.size());
+            code = createEdgeIndices(edgeIndices, numPostsX, numPostsY);
+            TE_CHECKRETURN_CODE(code);
+
+            // insert the degenerate, last index of the mesh and first index
+            // for the skirt
+            code = indices.put<uint16_t>(entry.indices[skirtOffset-1u]);
+            TE_CHECKRETURN_CODE(code);
+            code = indices.put<uint16_t>(entry.edgeIndices[0u]);
+            TE_CHECKRETURN_CODE(code);
+
+            code = Skirt_createIndices<uint16_t>(
+                    indices,
+                    GL_TRIANGLE_STRIP,
+                    &edgeIndices,
+                    numEdgeVertices,
+                    static_cast<uint16_t>(numPostsX*numPostsY));
+            TE_CHECKRETURN_CODE(code);
+        }
+
+        entry.value.indices = entry.indices.data();
+        entry.value.numIndices = entry.indices.size();
+        entry.value.skirtOffset = skirtOffset;
+        entry.value.edgeIndices = skirt ? entry.edgeIndices.data() : nullptr;
+        entry.value.numEdgeIndices = entry.edgeIndices.size();
+        entry.value.numCellsX = numCellsX;
+        entry.value.numCellsY = numCellsY;
+
+        return code;
+    }
+}
+
+TAKErr TAK::Engine::Renderer::QuadMeshIndices_get(const QuadMeshIndices **value, const std::size_t numCellsX, const std::size_t numCellsY, const bool skirt) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!value)
+        return TE_InvalidArg;
+    if (!numCellsX || !numCellsY)
+        return TE_InvalidArg;
+
+    Lock lock(cacheMutex());
+    TE_CHECKRETURN_CODE(lock.status);
+
+    const Key key{ numCellsX, numCellsY, skirt };
+    auto entry = cache().find(key);
+    if (entry == cache().end()) {
+        std::unique_ptr<Entry> created(new(std::nothrow) Entry());
+        if (!created)
+            return TE_OutOfMemory;
+        code = createEntry(*created, numCellsX, numCellsY, skirt);
+        TE_CHECKRETURN_CODE(code);
+        entry = cache().insert(std::make_pair(key, std::move(created))).first;
+    }
+
+    *value = &entry->second->value;
+    return code;
+}
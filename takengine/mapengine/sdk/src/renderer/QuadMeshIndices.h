@@ -0,0 +1,57 @@
+#ifndef TAK_ENGINE_RENDERER_QUADMESHINDICES_H_INCLUDED
+#define TAK_ENGINE_RENDERER_QUADMESHINDICES_H_INCLUDED
+
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            /**
+             * Immutable index data for a regular grid of quads, drawn as a
+             * <code>GL_TRIANGLE_STRIP</code> of <code>GL_UNSIGNED_SHORT</code>
+             * indices. The topology of a grid depends only on its dimensions,
+             * so a single instance is shared by every mesh of the same size;
+             * only the vertex positions are per mesh.
+             *
+             * <P>Grid vertices are expected in row-major order,
+             * <code>(numCellsX+1)*(numCellsY+1)</code> vertices. If the grid
+             * has a skirt, the skirt vertices immediately follow the grid
+             * vertices, one per edge index (see <code>Skirt_createVertices</code>).
+             */
+            struct ENGINE_API QuadMeshIndices
+            {
+                /** grid surface indices, followed by the degenerate link and skirt indices, if present */
+                const uint16_t *indices;
+                std::size_t numIndices;
+                /** the number of grid surface indices; skirt indices begin at this offset */
+                std::size_t skirtOffset;
+                /** the closed, counter-clockwise perimeter of the grid; <code>nullptr</code> if no skirt */
+                const uint16_t *edgeIndices;
+                std::size_t numEdgeIndices;
+                std::size_t numCellsX;
+                std::size_t numCellsY;
+            };
+
+            /**
+             * Returns the shared index data for a grid of the specified
+             * dimensions. The data is built on first request and retained for
+             * the lifetime of the process, so meshes may reference it
+             * directly rather than copying.
+             *
+             * @param value     Returns the shared index data
+             * @param numCellsX The number of grid cells along the x-axis
+             * @param numCellsY The number of grid cells along the y-axis
+             * @param skirt     If <code>true</code>, the indices include a skirt around the grid perimeter
+             *
+             * @return  TE_Ok on success, TE_InvalidArg if the grid cannot be
+             *          addressed with 16-bit indices
+             */
+            ENGINE_API Util::TAKErr QuadMeshIndices_get(const QuadMeshIndices **value, const std::size_t numCellsX, const std::size_t numCellsY, const bool skirt) NOTHROWS;
+        }
+    }
+}
+
+#endif
@@ -9,6 +9,8 @@ RenderAttributes::RenderAttributes() NOTHROWS :
     colorPointer(false),
     normals(false),
     lighting(false),
+    instanced(false),
+    quantized(false),
     windingOrder(TEWO_Undefined)
 {
     for (std::size_t i = 0u; i < 8u; i++)
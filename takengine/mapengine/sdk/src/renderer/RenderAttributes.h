@@ -18,6 +18,10 @@ namespace TAK {
                 bool colorPointer;
                 bool normals;
                 bool lighting;
+                /** if 'true' the model-view is composited with a per-instance transform attribute */
+                bool instanced;
+                /** if 'true' vertex data is quantized */
+                bool quantized;
                 TAK::Engine::Model::WindingOrder windingOrder;
             };
         }
@@ -1,5 +1,6 @@
 #include "renderer/Shader.h"
 
+#include <array>
 #include <map>
 #include <sstream>
 
@@ -15,21 +16,17 @@ using namespace TAK::Engine::Util;
 
 namespace
 {
-    enum ShaderFlags {
-        FLAG_TEXTURED = 0x01u,
-        FLAG_ALPHA_DISCARD = 0x02u,
-        FLAG_COLOR_POINTER = 0x04u,
-        FLAG_NORMAL = 0x08u,
-    };
-
-    std::map<const RenderContext *, std::map<unsigned, std::shared_ptr<const Shader>>> &shaders() NOTHROWS
+    typedef std::array<std::shared_ptr<const Shader>, TESF_NumVariants> ShaderVariants;
+    typedef std::array<std::shared_ptr<const Shader2>, TESF_NumVariants> Shader2Variants;
+
+    std::map<const RenderContext *, ShaderVariants> &shaders() NOTHROWS
     {
-        static std::map<const RenderContext *, std::map<unsigned, std::shared_ptr<const Shader>>> m;
+        static std::map<const RenderContext *, ShaderVariants> m;
         return m;
     }
-    std::map<const RenderContext*, std::map<unsigned, std::shared_ptr<const Shader2>>>& shaders2() NOTHROWS
+    std::map<const RenderContext*, Shader2Variants>& shaders2() NOTHROWS
     {
-        static std::map<const RenderContext*, std::map<unsigned, std::shared_ptr<const Shader2>>> m;
+        static std::map<const RenderContext*, Shader2Variants> m;
         return m;
     }
     Mutex &shadersMutex() NOTHROWS
@@ -133,10 +130,12 @@ namespace
 
 Shader::Shader(const unsigned flags) NOTHROWS
 {
-    this->textured = (flags & ShaderFlags::FLAG_TEXTURED) != 0;
-    this->alphaDiscard = (flags & ShaderFlags::FLAG_ALPHA_DISCARD) != 0;
-    this->colorPointer = (flags & ShaderFlags::FLAG_COLOR_POINTER) != 0;
-    this->lighting = (flags & ShaderFlags::FLAG_NORMAL) != 0;
+    this->textured = (flags & TESF_Textured) != 0;
+    this->alphaDiscard = (flags & TESF_AlphaDiscard) != 0;
+    this->colorPointer = (flags & TESF_ColorPointer) != 0;
+    this->lighting = (flags & TESF_Lighting) != 0;
+    this->instanced = (flags & TESF_Instanced) != 0;
+    this->quantized = (flags & TESF_Quantized) != 0;
 
     // vertex shader source
     std::ostringstream vshsrc;
@@ -148,24 +147,49 @@ Shader::Shader(const unsigned flags) NOTHROWS
         vshsrc << "varying vec2 vTexPos;\n";
     }
     vshsrc << "attribute vec3 aVertexCoords;\n";
+    if(quantized) {
+        vshsrc << "uniform vec3 uPositionOffset;\n";
+        vshsrc << "uniform vec3 uPositionScale;\n";
+    }
     if(colorPointer) {
         vshsrc << "attribute vec4 aColorPointer;\n";
         vshsrc << "varying vec4 vColor;\n";
     }
-    if(lighting) {
+    if(lighting && quantized) {
+        // octahedral encoded
+        vshsrc << "attribute vec2 aNormals;\n";
+        vshsrc << "varying vec3 vNormal;\n";
+    } else if(lighting) {
         vshsrc << "attribute vec3 aNormals;\n";
         vshsrc << "varying vec3 vNormal;\n";
     }
+    if(instanced)
+        vshsrc << "attribute mat4 aInstanceTransform;\n";
     vshsrc << "void main() {\n";
+    if(quantized)
+        vshsrc << "  vec3 position = uPositionOffset + uPositionScale * aVertexCoords;\n";
+    else
+        vshsrc << "  vec3 position = aVertexCoords;\n";
+    if(instanced)
+        vshsrc << "  mat4 modelView = uModelView * aInstanceTransform;\n";
+    else
+        vshsrc << "  mat4 modelView = uModelView;\n";
     if(textured) {
         vshsrc << "  vec4 texCoords = uTextureMx * vec4(aTextureCoords.xy, 0.0, 1.0);\n";
         vshsrc << "  vTexPos = texCoords.xy;\n";
     }
     if(colorPointer)
         vshsrc << "  vColor = aColorPointer;\n";
-    if(lighting)
-        vshsrc << "  vNormal = normalize(mat3(uProjection * uModelView) * aNormals);\n";
-    vshsrc << "  gl_Position = uProjection * uModelView * vec4(aVertexCoords.xyz, 1.0);\n";
+    if(lighting && quantized) {
+        vshsrc << "  vec2 e = aNormals * 2.0 - 1.0;\n";
+        vshsrc << "  vec3 normal = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));\n";
+        vshsrc << "  if(normal.z < 0.0)\n";
+        vshsrc << "    normal.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);\n";
+        vshsrc << "  vNormal = normalize(mat3(uProjection * modelView) * normalize(normal));\n";
+    } else if(lighting) {
+        vshsrc << "  vNormal = normalize(mat3(uProjection * modelView) * aNormals);\n";
+    }
+    vshsrc << "  gl_Position = uProjection * modelView * vec4(position, 1.0);\n";
     vshsrc << "}";
 
     // fragment shader source
@@ -227,44 +251,41 @@ Shader::Shader(const unsigned flags) NOTHROWS
     uTexture = glGetUniformLocation(handle, "uTexture");
     uAlphaDiscard = glGetUniformLocation(handle, "uAlphaDiscard");
     uColor = glGetUniformLocation(handle, "uColor");
+    uPositionOffset = glGetUniformLocation(handle, "uPositionOffset");
+    uPositionScale = glGetUniformLocation(handle, "uPositionScale");
     aVertexCoords = glGetAttribLocation(handle, "aVertexCoords");
     aTextureCoords = glGetAttribLocation(handle, "aTextureCoords");
     aColorPointer = glGetAttribLocation(handle, "aColorPointer");
     aNormals = glGetAttribLocation(handle, "aNormals");
+    aInstanceTransform = glGetAttribLocation(handle, "aInstanceTransform");
 
-    numAttribs = 1 + (colorPointer ? 1 : 0) + (textured ? 1 : 0) + (lighting ? 1 : 0);
+    // a mat4 attribute consumes one location per column
+    numAttribs = 1 + (colorPointer ? 1 : 0) + (textured ? 1 : 0) + (lighting ? 1 : 0) + (instanced ? 4 : 0);
 }
 
 void TAK::Engine::Renderer::Shader_get(std::shared_ptr<const Shader> &value, const RenderContext &ctx, const RenderAttributes &attrs) NOTHROWS
 {
-    unsigned int flags = 0u;
-    if (attrs.colorPointer)
-        flags |= ShaderFlags::FLAG_COLOR_POINTER;
-    if (!attrs.opaque)
-        flags |= ShaderFlags::FLAG_ALPHA_DISCARD;
-    for (std::size_t i = 0u; i < 8u; i++) {
-        if (!attrs.textureIds[i])
-            continue;
-        flags |= ShaderFlags::FLAG_TEXTURED;
-        break;
+    Shader_get(value, ctx, Shader_getFlags(attrs));
+}
+
+void TAK::Engine::Renderer::Shader_get(std::shared_ptr<const Shader> &value, const RenderContext &ctx, const unsigned flags) NOTHROWS
+{
+    if (flags >= TESF_NumVariants) {
+        value.reset();
+        return;
     }
-    if (attrs.normals)
-        flags |= ShaderFlags::FLAG_NORMAL;
 
     do {
         Lock lock(shadersMutex());
         TE_CHECKBREAK_CODE(lock.status);
 
         // obtain or insert the shaders for the specified context
-        std::map<unsigned, std::shared_ptr<const Shader>> &ctxShaders = shaders()[&ctx];
-
-        auto retval = ctxShaders.find(flags);
-        if (retval == ctxShaders.end()) {
-            value.reset(new Shader(flags));
-            ctxShaders[flags] = std::shared_ptr<const Shader>(value);
-        } else {
-            value = retval->second;
-        }
+        ShaderVariants &ctxShaders = shaders()[&ctx];
+
+        std::shared_ptr<const Shader> &variant = ctxShaders[flags];
+        if (!variant)
+            variant.reset(new Shader(flags));
+        value = variant;
 
         return;
     } while (false);
@@ -273,6 +294,28 @@ void TAK::Engine::Renderer::Shader_get(std::shared_ptr<const Shader> &value, con
     value = std::shared_ptr<const Shader>(new(std::nothrow) Shader(flags));
 }
 
+unsigned TAK::Engine::Renderer::Shader_getFlags(const RenderAttributes &attrs) NOTHROWS
+{
+    unsigned int flags = TESF_None;
+    if (attrs.colorPointer)
+        flags |= TESF_ColorPointer;
+    if (!attrs.opaque)
+        flags |= TESF_AlphaDiscard;
+    for (std::size_t i = 0u; i < 8u; i++) {
+        if (!attrs.textureIds[i])
+            continue;
+        flags |= TESF_Textured;
+        break;
+    }
+    if (attrs.normals)
+        flags |= TESF_Lighting;
+    if (attrs.instanced)
+        flags |= TESF_Instanced;
+    if (attrs.quantized)
+        flags |= TESF_Quantized;
+    return flags;
+}
+
 TAKErr TAK::Engine::Renderer::Shader_get(std::shared_ptr<const Shader2> &value, const TAK::Engine::Core::RenderContext& ctx, const RenderAttributes& attrs) NOTHROWS {
 
     bool textured = false;
@@ -282,16 +325,20 @@ TAKErr TAK::Engine::Renderer::Shader_get(std::shared_ptr<const Shader2> &value,
         return TE_Unsupported;
     if (!attrs.opaque)
         return TE_Unsupported;
+    if (attrs.instanced)
+        return TE_Unsupported;
+    if (attrs.quantized)
+        return TE_Unsupported;
     for (std::size_t i = 0u; i < 8u; i++) {
         if (!attrs.textureIds[i])
             continue;
         textured = true;
-        flags |= ShaderFlags::FLAG_TEXTURED;
+        flags |= TESF_Textured;
         break;
     }
     if (attrs.normals) {
         lighting = true;
-        flags |= ShaderFlags::FLAG_NORMAL;
+        flags |= TESF_Lighting;
     }
 
     do {
@@ -299,20 +346,17 @@ TAKErr TAK::Engine::Renderer::Shader_get(std::shared_ptr<const Shader2> &value,
         TE_CHECKBREAK_CODE(lock.status);
 
         // obtain or insert the shaders for the specified context
-        std::map<unsigned, std::shared_ptr<const Shader2>>& ctxShaders = shaders2()[&ctx];
+        Shader2Variants& ctxShaders = shaders2()[&ctx];
 
-        auto retval = ctxShaders.find(flags);
-        if (retval == ctxShaders.end()) {
+        std::shared_ptr<const Shader2>& variant = ctxShaders[flags];
+        if (!variant) {
             std::shared_ptr<Shader2> shader(new Shader2(), deleteShader2);
             TAKErr code = makeDefaultShader2(shader.get(), textured, lighting);
             if (code != TE_Ok)
                 return code;
-            value = shader;
-            ctxShaders[flags] = std::shared_ptr<const Shader2>(value);
-        }
-        else {
-            value = retval->second;
+            variant = shader;
         }
+        value = variant;
 
         return TE_Ok;
     } while (false);
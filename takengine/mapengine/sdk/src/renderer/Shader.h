@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_RENDERER_SHADER_H_INCLUDED
 #define TAK_ENGINE_RENDERER_SHADER_H_INCLUDED
 
+#include <memory>
 #include <string>
 
 #include "renderer/GL.h"
@@ -13,6 +14,34 @@
 namespace TAK {
     namespace Engine {
         namespace Renderer {
+            /**
+             * Feature flags selecting a `Shader` variant. Each distinct
+             * combination is compiled as its own specialized program.
+             */
+            enum ShaderFlags
+            {
+                TESF_None = 0x00u,
+                TESF_Textured = 0x01u,
+                TESF_AlphaDiscard = 0x02u,
+                TESF_ColorPointer = 0x04u,
+                TESF_Lighting = 0x08u,
+                /**
+                 * Vertices are additionally transformed by the per-instance
+                 * `aInstanceTransform` attribute, occupying four consecutive
+                 * attribute locations (one per column)
+                 */
+                TESF_Instanced = 0x10u,
+                /**
+                 * Vertex data is quantized per
+                 * `VertexDataLayout_createQuantizedInterleaved`. Positions
+                 * are dequantized by `uPositionOffset` and `uPositionScale`;
+                 * texture coordinates are dequantized by `uTextureMx`.
+                 */
+                TESF_Quantized = 0x20u,
+                /** number of distinct flag combinations */
+                TESF_NumVariants = 0x40u,
+            };
+
             struct ENGINE_API Shader2
             {
                 GLuint handle;
@@ -41,21 +70,26 @@ namespace TAK {
                 GLint uTexture;
                 GLint uAlphaDiscard;
                 GLint uColor;
+                GLint uPositionOffset;
+                GLint uPositionScale;
                 GLint aVertexCoords;
                 GLint aTextureCoords;
                 GLint aColorPointer;
                 GLint aNormals;
+                GLint aInstanceTransform;
 
                 bool textured;
                 bool alphaDiscard;
                 bool colorPointer;
                 bool lighting;
+                bool instanced;
+                bool quantized;
                 std::size_t numAttribs;
             private :
                 std::string vsh_;
                 std::string fsh_;
 
-                friend void Shader_get(std::shared_ptr<const Shader> &, const TAK::Engine::Core::RenderContext &, const RenderAttributes &attrs) NOTHROWS;
+                friend void Shader_get(std::shared_ptr<const Shader> &, const TAK::Engine::Core::RenderContext &, const unsigned flags) NOTHROWS;
             };
 
             /**
@@ -66,6 +100,38 @@ namespace TAK {
                 * @return
                 */
             void Shader_get(std::shared_ptr<const Shader> &value, const TAK::Engine::Core::RenderContext &ctx, const RenderAttributes &attrs) NOTHROWS;
+            /**
+             * Returns the variant for the specified bitwise combination of
+             * `ShaderFlags`.
+             *
+             * <P>MUST be invoked on render thread
+             */
+            void Shader_get(std::shared_ptr<const Shader> &value, const TAK::Engine::Core::RenderContext &ctx, const unsigned flags) NOTHROWS;
+            /**
+             * Returns the bitwise combination of `ShaderFlags` required to
+             * render content with the specified attributes.
+             */
+            unsigned Shader_getFlags(const RenderAttributes &attrs) NOTHROWS;
+            /**
+             * Returns the variant for flags known at compile time. The
+             * variant is retained per thread for the most recently
+             * specified context, so repeated calls against the same
+             * context do not perform a lookup.
+             *
+             * <P>MUST be invoked on render thread
+             */
+            template<unsigned Flags>
+            std::shared_ptr<const Shader> Shader_get(const TAK::Engine::Core::RenderContext &ctx) NOTHROWS
+            {
+                static_assert(Flags < TESF_NumVariants, "invalid shader flags");
+                static thread_local const TAK::Engine::Core::RenderContext *variantCtx = nullptr;
+                static thread_local std::shared_ptr<const Shader> variant;
+                if (variantCtx != &ctx || !variant) {
+                    Shader_get(variant, ctx, Flags);
+                    variantCtx = &ctx;
+                }
+                return variant;
+            }
 
 
             TAK::Engine::Util::TAKErr Shader_get(std::shared_ptr<const Shader2>&, const TAK::Engine::Core::RenderContext& ctx, const RenderAttributes& attrs) NOTHROWS;
@@ -3,11 +3,14 @@
 #include <algorithm>
 #include <cmath>
 #include <list>
+#include <new>
 #include <vector>
 
 #include "core/GeoPoint2.h"
 #include "formats/glues/glues.h"
 #include "math/Vector4.h"
+#include "renderer/Earcut.h"
+#include "util/ScratchArena.h"
 
 using namespace TAK::Engine::Renderer;
 
@@ -20,18 +23,19 @@ namespace
     struct TessCallback
     {
     public :
-        TessCallback(const VertexData &layout, const std::size_t count) NOTHROWS;
+        TessCallback(const VertexData &layout, const std::size_t count, ScratchArena &scratch) NOTHROWS;
     public :
         Point2<double> origin;
         bool error;
         std::size_t srcCount;
         std::size_t dstCount;
         std::size_t combineCount;
-        std::vector<std::size_t> indices;
-        std::vector<Point2<double>> combinedVertices;
+        std::vector<std::size_t, ScratchAllocator<std::size_t>> indices;
+        std::vector<Point2<double>, ScratchAllocator<Point2<double>>> combinedVertices;
     };
 
     void VertexData_deleter(const VertexData *value);
+    void VertexData_arenaDeleter(const VertexData *value);
 
     Algorithm wgs84() NOTHROWS;
     double WGS84_distance(const Point2<double> &a, const Point2<double> &b);
@@ -121,14 +125,26 @@ namespace
 
     struct VertexSink
     {
-#define __te_vertexsink_buffer_size 2048000u
+#define __te_vertexsink_buffer_size 256000u
 
-        VertexSink(WriteVertexFn vertWrite_, const VertexData &layout_) NOTHROWS :
-            buf(new MemBuffer2(__te_vertexsink_buffer_size)),
+        VertexSink(WriteVertexFn vertWrite_, const VertexData &layout_, ScratchArena &scratch_) NOTHROWS :
+            scratch(scratch_),
             vertWrite(vertWrite_),
             layout(layout_),
+            bufs(ScratchAllocator<std::unique_ptr<MemBuffer2>>(scratch_)),
             count(0u)
-        {}
+        {
+            buf = newBuffer();
+        }
+
+        std::unique_ptr<MemBuffer2> newBuffer() NOTHROWS
+        {
+            // draw from the scratch arena, falling back on the heap
+            void *mem = scratch.allocate(__te_vertexsink_buffer_size);
+            if (mem)
+                return std::unique_ptr<MemBuffer2>(new MemBuffer2(static_cast<uint8_t *>(mem), __te_vertexsink_buffer_size));
+            return std::unique_ptr<MemBuffer2>(new MemBuffer2(__te_vertexsink_buffer_size));
+        }
 
         TAKErr writeTriangle(const Point2<double> &a, const Point2<double> &b, const Point2<double> &c) NOTHROWS
         {
@@ -136,7 +152,7 @@ namespace
             if (buf->remaining() < (layout.stride*3u)) {
                 buf->flip();
                 bufs.push_back(std::move(buf));
-                buf.reset(new MemBuffer2(__te_vertexsink_buffer_size));
+                buf = newBuffer();
             }
 
             code = vertWrite(*buf, layout, a);
@@ -171,13 +187,19 @@ namespace
             return code;
         }
 
+        ScratchArena &scratch;
         const VertexData &layout;
         std::unique_ptr<MemBuffer2> buf;
         WriteVertexFn vertWrite;
-        std::list<std::unique_ptr<MemBuffer2>> bufs;
+        std::list<std::unique_ptr<MemBuffer2>, ScratchAllocator<std::unique_ptr<MemBuffer2>>> bufs;
         std::size_t count;
     };
 
+    // relative difference between the polygon and triangle areas beyond
+    // which the ear clipping result is considered invalid
+    const double EARCUT_MAX_DEVIATION = 1e-6;
+
+    TAKErr earcut(TessCallback *value, const VertexData &src, const std::size_t totalVertexCount, const int *counts, const int *startIndices, const std::size_t numPolygons, ReadVertexFn it, ScratchArena &scratch) NOTHROWS;
     TAKErr polygon(TessCallback *value, const VertexData &src, const std::size_t totalVertexCount, const int *counts, const int *startIndices, const std::size_t numPolygons, ReadVertexFn it, _GLUfuncptr vertexDataCallback, _GLUfuncptr combineCallback) NOTHROWS;
 
     TAKErr triangle_r(VertexSink &sink, const Point2<double> &a, const Point2<double> &b, const Point2<double> &c, const double dab, const double dbc, const double dca, const double threshold, Algorithm alg, std::size_t depth) NOTHROWS;
@@ -195,6 +217,12 @@ namespace
 
             // index exceeds source count, points to combined vertex
             *xyz = cb.combinedVertices[cmbidx];
+        } else if (vertRead == readVertexImpl_nostride<double>) {
+            // packed doubles, read in place
+            const double *v = static_cast<const double *>(src.data) + (idx*src.size);
+            xyz->x = v[0u];
+            xyz->y = v[1u];
+            xyz->z = (src.size == 3u) ? v[2u] : 0.0;
         } else {
             // index point to source data
 
@@ -220,6 +248,19 @@ TAKErr TAK::Engine::Renderer::VertexData_allocate(VertexDataPtr &value, const st
     return TE_Ok;
 }
 
+TAKErr TAK::Engine::Renderer::VertexData_allocate(VertexDataPtr &value, const std::size_t stride, const std::size_t size, const std::size_t count, ScratchArena &arena) NOTHROWS
+{
+    void *header = arena.allocate(sizeof(VertexData), alignof(VertexData));
+    void *data = arena.allocate(stride*count, alignof(double));
+    if (!header || !data)
+        return TE_OutOfMemory;
+    value = VertexDataPtr(new(header) VertexData(), VertexData_arenaDeleter);
+    value->data = data;
+    value->stride = stride;
+    value->size = size;
+    return TE_Ok;
+}
+
 Algorithm &TAK::Engine::Renderer::Tessellate_CartesianAlgorithm() NOTHROWS
 {
     static Algorithm a = cartesian();
@@ -257,23 +298,36 @@ TAKErr TAK::Engine::Renderer::Tessellate_polygon(VertexDataPtr &value, std::size
             return TE_InvalidArg;
     }
 
-    // count the number of output vertices (original+combined)
-    TessCallback cb(src, totalVertexCount);
-    code = polygon(&cb, src, totalVertexCount, counts, startIndices, numPolygons, vertRead, (_GLUfuncptr)TessCallback_vertexData_count, (_GLUfuncptr)TessCallback_combinData_count);
-    TE_CHECKRETURN_CODE(code);
+    // all intermediate state is released when the scope exits; only the
+    // output is allocated on the heap
+    ScratchArenaScope scratch;
+
+    TessCallback cb(src, totalVertexCount, scratch.arena);
+
+    // ear clipping handles simple polygons and polygons with holes without
+    // introducing new vertices. the GLU tessellator is only used for input
+    // that ear clipping cannot triangulate (e.g. self-intersecting rings)
+    if (earcut(&cb, src, totalVertexCount, counts, startIndices, numPolygons, vertRead, scratch.arena) != TE_Ok) {
+        cb.indices.clear();
+        cb.dstCount = 0u;
+
+        // count the number of output vertices (original+combined)
+        code = polygon(&cb, src, totalVertexCount, counts, startIndices, numPolygons, vertRead, (_GLUfuncptr)TessCallback_vertexData_count, (_GLUfuncptr)TessCallback_combinData_count);
+        TE_CHECKRETURN_CODE(code);
 
-    // store all output vertices (original+combined)
-    cb.indices.reserve(cb.dstCount);
-    cb.combinedVertices.reserve(cb.combineCount);
-    cb.dstCount = 0u;
-    cb.combineCount = 0u;
-    code = polygon(&cb, src, totalVertexCount, counts, startIndices, numPolygons, vertRead, (_GLUfuncptr)TessCallback_vertexData_assemble, (_GLUfuncptr)TessCallback_combinData_assemble);
-    TE_CHECKRETURN_CODE(code);
+        // store all output vertices (original+combined)
+        cb.indices.reserve(cb.dstCount);
+        cb.combinedVertices.reserve(cb.combineCount);
+        cb.dstCount = 0u;
+        cb.combineCount = 0u;
+        code = polygon(&cb, src, totalVertexCount, counts, startIndices, numPolygons, vertRead, (_GLUfuncptr)TessCallback_vertexData_assemble, (_GLUfuncptr)TessCallback_combinData_assemble);
+        TE_CHECKRETURN_CODE(code);
+    }
 
     // iterate tessellation indices, subdividing triangles as necessary and aggregating into output
 
     if (threshold) {
-        VertexSink sink(vertWrite, src);
+        VertexSink sink(vertWrite, src, scratch.arena);
 
         for (std::size_t idx = 0u; idx < cb.indices.size(); idx += 3) {
             Point2<double> a;
@@ -324,12 +378,14 @@ TAKErr TAK::Engine::Renderer::Tessellate_polygon(VertexDataPtr &value, std::size
 
 namespace
 {
-    TessCallback::TessCallback(const VertexData &layout_, const std::size_t count_) NOTHROWS :
+    TessCallback::TessCallback(const VertexData &layout_, const std::size_t count_, ScratchArena &scratch) NOTHROWS :
         origin(0.0, 0.0, 0.0),
         error(false),
         srcCount(count_),
         dstCount(0u),
-        combineCount(0u)
+        combineCount(0u),
+        indices(ScratchAllocator<std::size_t>(scratch)),
+        combinedVertices(ScratchAllocator<Point2<double>>(scratch))
     {}
 
     void VertexData_deleter(const VertexData *value)
@@ -340,6 +396,10 @@ namespace
             delete value;
         }
     }
+    void VertexData_arenaDeleter(const VertexData *value)
+    {
+        // memory is reclaimed with the arena scope
+    }
 
     Algorithm wgs84() NOTHROWS
     {
@@ -534,6 +594,65 @@ namespace
         cb.error = true;
     }
 
+    TAKErr earcut(TessCallback *value, const VertexData &src, const std::size_t totalVertexCount, const int *counts, const int *startIndices, const std::size_t numPolygons, ReadVertexFn it, ScratchArena &scratch) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        if (!value)
+            return TE_InvalidArg;
+        if (!it)
+            return TE_InvalidArg;
+
+        try {
+            // flatten the rings to x,y; vertices are read sequentially,
+            // consistent with the GLU path
+            std::vector<double, ScratchAllocator<double>> xy{ScratchAllocator<double>(scratch)};
+            xy.resize(totalVertexCount * 2u);
+            std::vector<std::size_t, ScratchAllocator<std::size_t>> ringCounts{ScratchAllocator<std::size_t>(scratch)};
+            ringCounts.resize(numPolygons);
+            std::vector<std::size_t, ScratchAllocator<std::size_t>> srcIndices{ScratchAllocator<std::size_t>(scratch)};
+            srcIndices.resize(totalVertexCount);
+
+            MemBuffer2 data((const uint8_t *)src.data, src.stride * totalVertexCount);
+            std::size_t n = 0u;
+            for (std::size_t i = 0; i < numPolygons; i++) {
+                ringCounts[i] = counts[i];
+                for (std::size_t idx = 0u; idx < static_cast<std::size_t>(counts[i]); idx++) {
+                    Point2<double> xyz;
+                    code = it(&xyz, data, src);
+                    TE_CHECKBREAK_CODE(code);
+                    xy[n * 2u] = xyz.x;
+                    xy[n * 2u + 1u] = xyz.y;
+                    srcIndices[n] = idx + startIndices[i];
+                    n++;
+                }
+                TE_CHECKBREAK_CODE(code);
+            }
+            TE_CHECKRETURN_CODE(code);
+
+            value->indices.resize(Earcut_maxIndexCount(totalVertexCount, numPolygons));
+            std::size_t idxCount;
+            code = Earcut_triangulate(value->indices.data(), &idxCount, xy.data(), 2u, ringCounts.data(), numPolygons);
+            TE_CHECKRETURN_CODE(code);
+            value->indices.resize(idxCount);
+
+            double deviation;
+            code = Earcut_deviation(&deviation, value->indices.data(), idxCount, xy.data(), 2u, ringCounts.data(), numPolygons);
+            TE_CHECKRETURN_CODE(code);
+            if (deviation > EARCUT_MAX_DEVIATION)
+                return TE_Err;
+
+            // map back to the source vertices
+            for (std::size_t i = 0u; i < idxCount; i++)
+                value->indices[i] = srcIndices[value->indices[i]];
+            value->dstCount = idxCount;
+        } catch (...) {
+            return TE_OutOfMemory;
+        }
+
+        return code;
+    }
+
     TAKErr polygon(TessCallback *value, const VertexData &src, const std::size_t totalVertexCount, const int *counts, const int *startIndices, const std::size_t numPolygons, ReadVertexFn it, _GLUfuncptr vertexDataCallback, _GLUfuncptr combineCallback) NOTHROWS
     {
         TAKErr code(TE_Ok);
@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_RENDERER_TESSELLATE_H_INCLUDED
 #define TAK_ENGINE_RENDERER_TESSELLATE_H_INCLUDED
 
+#include <cmath>
 #include <memory>
 
 #include "math/Point2.h"
@@ -8,6 +9,7 @@
 #include "util/Error.h"
 #include "util/Memory.h"
 #include "util/MemBuffer2.h"
+#include "util/ScratchArena.h"
 
 namespace TAK {
     namespace Engine {
@@ -21,6 +23,13 @@ namespace TAK {
             typedef std::unique_ptr<VertexData, void(*)(const VertexData *)> VertexDataPtr_const;
 
             ENGINE_API Util::TAKErr VertexData_allocate(VertexDataPtr &value, const std::size_t stride, const std::size_t size, const std::size_t count) NOTHROWS;
+            /**
+             * Allocates the vertex data from the specified arena. The data
+             * is valid until the <code>ScratchArenaScope</code> active on
+             * the arena at the time of the call exits; the returned pointer
+             * does not free the data.
+             */
+            ENGINE_API Util::TAKErr VertexData_allocate(VertexDataPtr &value, const std::size_t stride, const std::size_t size, const std::size_t count, Util::ScratchArena &arena) NOTHROWS;
 
             /**
              * Reads the next vertex, advancing the pointer through the full vertex stride
@@ -109,141 +118,184 @@ namespace TAK {
             ENGINE_API Algorithm &Tessellate_CartesianAlgorithm() NOTHROWS;
             ENGINE_API Algorithm &Tessellate_WGS84Algorithm() NOTHROWS;
 
-            /**
-             * Tessellates the input linestring
-             *
-             * @param value
-             * @param dstCount
-             * @param src
-             * @param count
-             * @param threshold
-             * @param algorithm
-             */
-            template<class T>
-            Util::TAKErr Tessellate_linestring(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const std::size_t count, const double threshold, Algorithm &algorithm) NOTHROWS
-            {
-                if(!dstCount)
-                    return Util::TE_InvalidArg;
-                if(!src.data)
-                    return Util::TE_InvalidArg;
-                if(count < 2u)
-                    return Util::TE_Done;
-                if(sizeof(T)*src.size > src.stride)
-                    return Util::TE_InvalidArg;
-
-                Util::TAKErr code(Util::TE_Ok);
-                const uint8_t *srcData = reinterpret_cast<const uint8_t *>(src.data);
-
-                *dstCount = count;
-#define __TE_TESSELLATE_COMPUTE_DST_COUNT(axv, ayv, azv, bxv, byv, bzv) \
-    for(std::size_t i = 1u; i < count; i++) { \
-        const T *srca = reinterpret_cast<const T *>(srcData + (src.stride*(i-1u))); \
-        const Math::Point2<double> a(axv, ayv, azv); \
-        const T *srcb = reinterpret_cast<const T *>(srcData + (src.stride*i)); \
-        const Math::Point2<double> b(bxv, byv, bzv); \
-        const double distance = algorithm.distance(a, b); \
-        *dstCount += (std::size_t)(distance/threshold); \
-    }
-
-                if(src.size == 2u) {
-                    __TE_TESSELLATE_COMPUTE_DST_COUNT(srca[0], srca[1], 0.0, srcb[0], srcb[1], 0.0)
-                } else if(src.size == 3u) {
-                    __TE_TESSELLATE_COMPUTE_DST_COUNT(srca[0], srca[1], srca[2], srcb[0], srcb[1], srcb[2])
-                } else {
-                    return Util::TE_IllegalState;
+            namespace Impl {
+                template<class T, std::size_t N>
+                void Tessellate_cartesianLengths(double *lengths, const T *data, const std::size_t count) NOTHROWS
+                {
+                    // packed coordinates, no calls in the loop body
+                    for (std::size_t i = 1u; i < count; i++) {
+                        const T *a = data + ((i-1u)*N);
+                        const T *b = data + (i*N);
+                        double d2 = 0.0;
+                        for (std::size_t j = 0u; j < N; j++) {
+                            const double d = static_cast<double>(b[j]) - static_cast<double>(a[j]);
+                            d2 += d*d;
+                        }
+                        lengths[i-1u] = ::sqrt(d2);
+                    }
                 }
-#undef __TE_TESSELLATE_COMPUTE_DST_COUNT
-
-                if(*dstCount == count)
-                    return Util::TE_Done;
 
-                code = VertexData_allocate(value, src.stride, src.size, *dstCount);
-                uint8_t *dst = reinterpret_cast<uint8_t *>(value->data);
+                template<class T>
+                Math::Point2<double> Tessellate_point(const T *xyz, const std::size_t size) NOTHROWS
+                {
+                    return Math::Point2<double>(xyz[0u], xyz[1u], (size == 3u) ? static_cast<double>(xyz[2u]) : 0.0);
+                }
 
-                if(src.size == 2u) {
-                    for(std::size_t i = 1u; i < count; i++) {
-                        const T *srca = reinterpret_cast<const T *>(srcData + (src.stride*(i-1u)));
-                        const Math::Point2<double> a(srca[0], srca[1], 0.0);
-                        const T *srcb = reinterpret_cast<const T *>(srcData + (src.stride*i));
-                        const Math::Point2<double> b(srcb[0], srcb[1], 0.0);
-                        /* emit 'a' */
-                        T *dstt = reinterpret_cast<T *>(dst);
-                        dstt[0] = srca[0];
-                        dstt[1] = srca[1];
-                        /* advance 'dst' */
-                        dst += value->stride;
-                        const double distance = algorithm.distance(a, b);
-                        if(distance > threshold) {
-                            /* interpolate between 'a' and 'b' */
-                            const std::size_t numPts = (std::size_t)(distance / threshold);
-                            const Math::Point2<double> dir = algorithm.direction(a, b);
-                            for(std::size_t j = 0u; j < numPts; j++) {
-                                Math::Point2<double> p;
-                                p = algorithm.interpolate(a, dir, (j+1u)*(distance/(numPts+1u)));
-
-                                /* emit interpolated point */
-                                dstt = reinterpret_cast<T *>(dst);
-                                dstt[0] = static_cast<T>(p.x);
-                                dstt[1] = static_cast<T>(p.y);
-                                /* advance 'dst' */
-                                dst += value->stride;
-                            }
+                template<class T>
+                Util::TAKErr Tessellate_linestring(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const std::size_t count, const double threshold, Algorithm &algorithm, double *lengths, Util::ScratchArena *output) NOTHROWS
+                {
+                    Util::TAKErr code(Util::TE_Ok);
+                    const uint8_t *srcData = reinterpret_cast<const uint8_t *>(src.data);
+                    const bool cartesian = (algorithm.distance == Tessellate_CartesianAlgorithm().distance);
+
+                    // segment lengths are computed once and shared by the
+                    // count and emit passes
+                    if(cartesian && src.stride == sizeof(T)*src.size) {
+                        if(src.size == 2u)
+                            Tessellate_cartesianLengths<T, 2u>(lengths, reinterpret_cast<const T *>(srcData), count);
+                        else
+                            Tessellate_cartesianLengths<T, 3u>(lengths, reinterpret_cast<const T *>(srcData), count);
+                    } else {
+                        for(std::size_t i = 1u; i < count; i++) {
+                            const Math::Point2<double> a = Tessellate_point(reinterpret_cast<const T *>(srcData + (src.stride*(i-1u))), src.size);
+                            const Math::Point2<double> b = Tessellate_point(reinterpret_cast<const T *>(srcData + (src.stride*i)), src.size);
+                            lengths[i-1u] = algorithm.distance(a, b);
                         }
                     }
 
-                    const T *srcb = reinterpret_cast<const T *>(srcData + (src.stride*(count-1u)));
+                    *dstCount = count;
+                    for(std::size_t i = 1u; i < count; i++)
+                        *dstCount += (std::size_t)(lengths[i-1u]/threshold);
+
+                    if(*dstCount == count)
+                        return Util::TE_Done;
+
+                    if(output)
+                        code = VertexData_allocate(value, src.stride, src.size, *dstCount, *output);
+                    else
+                        code = VertexData_allocate(value, src.stride, src.size, *dstCount);
+                    TE_CHECKRETURN_CODE(code);
+                    uint8_t *dst = reinterpret_cast<uint8_t *>(value->data);
 
-                    // emit last point
-                    T *dstt = reinterpret_cast<T *>(dst);
-                    dstt[0] = srcb[0];
-                    dstt[1] = srcb[1];
-                } else if(src.size == 3u) {
                     for(std::size_t i = 1u; i < count; i++) {
                         const T *srca = reinterpret_cast<const T *>(srcData + (src.stride*(i-1u)));
-                        const Math::Point2<double> a(srca[0], srca[1], srca[2]);
                         const T *srcb = reinterpret_cast<const T *>(srcData + (src.stride*i));
-                        const Math::Point2<double> b(srcb[0], srcb[1], srcb[2]);
                         /* emit 'a' */
                         T *dstt = reinterpret_cast<T *>(dst);
-                        dstt[0u] = srca[0u];
-                        dstt[1u] = srca[1u];
-                        dstt[2u] = srca[2u];
+                        for(std::size_t k = 0u; k < src.size; k++)
+                            dstt[k] = srca[k];
                         /* advance 'dst' */
                         dst += value->stride;
-                        const double distance = algorithm.distance(a, b);
+                        const double distance = lengths[i-1u];
                         if(distance > threshold) {
                             /* interpolate between 'a' and 'b' */
                             const std::size_t numPts = (std::size_t)(distance / threshold);
-                            const Math::Point2<double> dir = algorithm.direction(a, b);
-                            for(std::size_t j = 0u; j < numPts; j++) {
-                                Math::Point2<double> p;
-                                p = algorithm.interpolate(a, dir, (j+1u)*(distance/(numPts+1u)));
-
-                                /* emit interpolated point */
-                                dstt = reinterpret_cast<T *>(dst);
-                                dstt[0u] = static_cast<T>(p.x);
-                                dstt[1u] = static_cast<T>(p.y);
-                                dstt[2u] = static_cast<T>(p.z);
-                                /* advance 'dst' */
-                                dst += value->stride;
+                            if(cartesian) {
+                                // linear interpolation, evaluated inline
+                                const double step = 1.0 / (double)(numPts+1u);
+                                for(std::size_t j = 0u; j < numPts; j++) {
+                                    const double t = (double)(j+1u)*step;
+                                    dstt = reinterpret_cast<T *>(dst);
+                                    for(std::size_t k = 0u; k < src.size; k++)
+                                        dstt[k] = static_cast<T>(srca[k] + (srcb[k]-srca[k])*t);
+                                    dst += value->stride;
+                                }
+                            } else {
+                                const Math::Point2<double> a = Tessellate_point(srca, src.size);
+                                const Math::Point2<double> dir = algorithm.direction(a, Tessellate_point(srcb, src.size));
+                                for(std::size_t j = 0u; j < numPts; j++) {
+                                    Math::Point2<double> p;
+                                    p = algorithm.interpolate(a, dir, (j+1u)*(distance/(numPts+1u)));
+
+                                    /* emit interpolated point */
+                                    dstt = reinterpret_cast<T *>(dst);
+                                    dstt[0u] = static_cast<T>(p.x);
+                                    dstt[1u] = static_cast<T>(p.y);
+                                    if(src.size == 3u)
+                                        dstt[2u] = static_cast<T>(p.z);
+                                    /* advance 'dst' */
+                                    dst += value->stride;
+                                }
                             }
                         }
                     }
 
-                    const T *srcb = reinterpret_cast<const T *>(srcData + (src.stride*(count-1u)));
-
                     // emit last point
+                    const T *srcb = reinterpret_cast<const T *>(srcData + (src.stride*(count-1u)));
                     T *dstt = reinterpret_cast<T *>(dst);
-                    dstt[0] = srcb[0];
-                    dstt[1] = srcb[1];
-                    dstt[2] = srcb[2];
-                } else {
-                    return Util::TE_IllegalState;
+                    for(std::size_t k = 0u; k < src.size; k++)
+                        dstt[k] = srcb[k];
+
+                    return Util::TE_Ok;
+                }
+
+                template<class T>
+                Util::TAKErr Tessellate_linestring(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const std::size_t count, const double threshold, Algorithm &algorithm, Util::ScratchArena *output) NOTHROWS
+                {
+                    if(!dstCount)
+                        return Util::TE_InvalidArg;
+                    if(!src.data)
+                        return Util::TE_InvalidArg;
+                    if(count < 2u)
+                        return Util::TE_Done;
+                    if(sizeof(T)*src.size > src.stride)
+                        return Util::TE_InvalidArg;
+                    if(src.size != 2u && src.size != 3u)
+                        return Util::TE_IllegalState;
+
+                    if(output) {
+                        // a nested scope on the output arena would release
+                        // the output; the lengths are held with the output
+                        auto *lengths = static_cast<double *>(output->allocate(sizeof(double)*(count-1u), alignof(double)));
+                        if(!lengths)
+                            return Util::TE_OutOfMemory;
+                        return Tessellate_linestring<T>(value, dstCount, src, count, threshold, algorithm, lengths, output);
+                    } else {
+                        Util::ScratchArenaScope scratch;
+                        auto *lengths = static_cast<double *>(scratch.arena.allocate(sizeof(double)*(count-1u), alignof(double)));
+                        if(!lengths)
+                            return Util::TE_OutOfMemory;
+                        return Tessellate_linestring<T>(value, dstCount, src, count, threshold, algorithm, lengths, nullptr);
+                    }
                 }
+            }
 
-                return Util::TE_Ok;
+            /**
+             * Tessellates the input linestring
+             *
+             * @param value
+             * @param dstCount
+             * @param src
+             * @param count
+             * @param threshold
+             * @param algorithm
+             */
+            template<class T>
+            Util::TAKErr Tessellate_linestring(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const std::size_t count, const double threshold, Algorithm &algorithm) NOTHROWS
+            {
+                return Impl::Tessellate_linestring<T>(value, dstCount, src, count, threshold, algorithm, nullptr);
             } // Tessellate_linestring
 
+            /**
+             * Tessellates the input linestring, allocating the output from
+             * the specified arena. The output is valid until the
+             * <code>ScratchArenaScope</code> active on the arena at the
+             * time of the call exits.
+             *
+             * @param value
+             * @param dstCount
+             * @param src
+             * @param count
+             * @param threshold
+             * @param algorithm
+             * @param arena
+             */
+            template<class T>
+            Util::TAKErr Tessellate_linestring(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const std::size_t count, const double threshold, Algorithm &algorithm, Util::ScratchArena &arena) NOTHROWS
+            {
+                return Impl::Tessellate_linestring<T>(value, dstCount, src, count, threshold, algorithm, &arena);
+            }
+
             ENGINE_API Util::TAKErr Tessellate_polygon(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const std::size_t count, const double threshold, Algorithm &algorithm, ReadVertexFn vertRead, WriteVertexFn vertWrite) NOTHROWS;
             ENGINE_API Util::TAKErr Tessellate_polygon(VertexDataPtr &value, std::size_t *dstCount, const VertexData &src, const int *counts, const int *startIndices, const int numPolygons, const double threshold, Algorithm &algorithm, ReadVertexFn vertRead, WriteVertexFn vertWrite) NOTHROWS;
 
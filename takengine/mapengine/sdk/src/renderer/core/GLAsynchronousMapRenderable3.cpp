@@ -1,6 +1,9 @@
 #include "renderer/core/GLAsynchronousMapRenderable3.h"
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <vector>
 
 #include "feature/SpatialCalculator2.h"
 #include "util/Memory.h"
@@ -12,6 +15,17 @@ using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
+// relative difference in resolution at which a prepared result may be reused
+#define REUSE_RESOLUTION_TOLERANCE 0.01
+
+namespace
+{
+    /** expands the bounds of `state` by `margin` times the extent of the bounds on each side */
+    void expandBounds(GLGlobeBase::State &state, const double margin) NOTHROWS;
+    /** returns `true` if a result prepared for `prepared` may be drawn for `target` */
+    bool covers(const GLGlobeBase::State &prepared, const GLGlobeBase::State &target) NOTHROWS;
+}
+
 GLAsynchronousMapRenderable3::GLAsynchronousMapRenderable3() NOTHROWS :
     thread_(nullptr, nullptr),
     initialized_(false),
@@ -44,15 +58,26 @@ TAKErr GLAsynchronousMapRenderable3::getBackgroundThreadName(TAK::Engine::Port::
     return TE_Ok;
 }
 
+double GLAsynchronousMapRenderable3::getQueryMargin() const NOTHROWS
+{
+    return 0.0;
+}
+
 bool GLAsynchronousMapRenderable3::shouldQuery() NOTHROWS
 {
-    return invalid_ ||
-        (prepared_state_.drawVersion != target_state_.drawVersion);
+    if (invalid_)
+        return true;
+    if (prepared_state_.drawVersion == target_state_.drawVersion)
+        return false;
+    // view changes within the over-fetched bounds reuse the prepared result
+    return !(getQueryMargin() > 0.0 && covers(prepared_state_, target_state_));
 }
 
 bool GLAsynchronousMapRenderable3::shouldCancel() NOTHROWS
 {
-    return false;
+    // the query in progress remains useful as long as its result covers the
+    // target
+    return query_state_ && getQueryMargin() > 0.0 && !covers(*query_state_, target_state_);
 }
 
 void GLAsynchronousMapRenderable3::initImpl(const GLGlobeBase &view) NOTHROWS
@@ -88,6 +113,8 @@ void GLAsynchronousMapRenderable3::draw(const GLGlobeBase &view, int renderPass)
         // force refresh
         prepared_state_.drawVersion = ~view.renderPasses[0u].drawVersion;
         target_state_.drawVersion = ~view.renderPasses[0u].drawVersion;
+        target_snapshot_.reset();
+        query_state_.reset();
         invalid_ = true;
 
         background_worker_.reset(new WorkerThread(*this));
@@ -111,16 +138,15 @@ void GLAsynchronousMapRenderable3::draw(const GLGlobeBase &view, int renderPass)
     // if the target state has not already been computed for the pump and
     // it is a sprite pass if there is any sprite content or there is a pass
     // match and there is not any sprite content, update the target state
-    if ((target_state_.drawVersion != view.renderPasses[0u].drawVersion) && (passTest & renderPass) != 0)
-        target_state_ = view.renderPasses[0u];
-    if (shouldQuery()) {
-        if (!servicing_request_) {
-            lock.signal();
-        } else if (shouldCancel()){
-            cancelled_ = true;
-            lock.signal();
-        }
+    if ((target_state_.drawVersion != view.renderPasses[0u].drawVersion) && (passTest & renderPass) != 0) {
+        // prefer the frame's published snapshot; it may be handed to the
+        // query thread without copying
+        target_snapshot_ = view.getRenderState();
+        if (!target_snapshot_ || target_snapshot_->drawVersion != view.renderPasses[0u].drawVersion)
+            target_snapshot_ = std::make_shared<const GLGlobeBase::State>(view.renderPasses[0u]);
+        target_state_ = *target_snapshot_;
     }
+    requestQueryNoSync(lock);
 
     // if surface only pass, ignore outside of current AOI
     if ((renderPass & ~(GLGlobeBase::Surface | GLGlobeBase::Surface2)) == 0) {
@@ -164,6 +190,34 @@ void GLAsynchronousMapRenderable3::draw(const GLGlobeBase &view, int renderPass)
     iter.reset();
 }
 
+void GLAsynchronousMapRenderable3::prepare(const std::shared_ptr<const GLGlobeBase::State> &state) NOTHROWS
+{
+    Monitor::Lock lock(monitor_);
+    if (lock.status != TE_Ok)
+        return;
+    // the query thread is started on the first draw
+    if (!initialized_)
+        return;
+
+    if (target_state_.drawVersion != state->drawVersion) {
+        target_snapshot_ = state;
+        target_state_ = *target_snapshot_;
+    }
+    requestQueryNoSync(lock);
+}
+
+void GLAsynchronousMapRenderable3::requestQueryNoSync(Monitor::Lock &lock) NOTHROWS
+{
+    if (shouldQuery()) {
+        if (!servicing_request_) {
+            lock.signal();
+        } else if (shouldCancel()){
+            cancelled_ = true;
+            lock.signal();
+        }
+    }
+}
+
 void GLAsynchronousMapRenderable3::release() NOTHROWS
 {
     std::unique_ptr<WorkerThread> deadWorker(background_worker_.release());
@@ -206,6 +260,11 @@ TAKErr GLAsynchronousMapRenderable3::releaseImpl() NOTHROWS
     return TE_Ok;
 }
 
+TAKErr GLAsynchronousMapRenderable3::getSurfaceDirtyRegion(GLDirtyRegion &value, QueryContext &pendingData) NOTHROWS
+{
+    return TE_Unsupported;
+}
+
 /*****************************************************************************/
 // Worker Thread
 
@@ -230,7 +289,12 @@ void GLAsynchronousMapRenderable3::WorkerThread::asyncRunImpl() {
     QueryContextPtr pendingData(nullptr, nullptr);
     try {
         code = owner_.createQueryContext(pendingData);
-        GLGlobeBase::State queryState;
+        TE_CHECKRETURN(code);
+        pendingData->cancelled_ = &owner_.cancelled_;
+        std::shared_ptr<const GLGlobeBase::State> queryState;
+        TAKErr queryCode(TE_Ok);
+        GLDirtyRegion dirtyRegion;
+        std::vector<Envelope2> dirtyRegions;
         while (true) {
             {
                 Monitor::Lock lock(owner_.monitor_);
@@ -244,9 +308,20 @@ void GLAsynchronousMapRenderable3::WorkerThread::asyncRunImpl() {
                     code = wlock.status;
                     TE_CHECKBREAK_CODE(code);
                     if (owner_.servicing_request_ && owner_.updateRenderableLists(*pendingData) == TE_Ok) {
-                        owner_.prepared_state_ = queryState;
+                        owner_.prepared_state_ = *queryState;
+                        // a partial result does not satisfy the state it
+                        // was queried for
+                        if (queryCode == TE_Canceled)
+                            owner_.invalid_ = true;
+                        dirtyRegion.clear();
                         if (owner_.surface_ctrl_ && (owner_.getRenderPass()&(GLGlobeBase::Surface|GLGlobeBase::Surface2))) {
-                            if (owner_.prepared_state_.crossesIDL) {
+                            if (owner_.getSurfaceDirtyRegion(dirtyRegion, *pendingData) == TE_Ok) {
+                                // only the changed content needs to be redrawn
+                                dirtyRegions.clear();
+                                dirtyRegion.getRegions(dirtyRegions);
+                                for (const auto &region : dirtyRegions)
+                                    owner_.surface_ctrl_->markDirty(region, false);
+                            } else if (owner_.prepared_state_.crossesIDL) {
                                 owner_.surface_ctrl_->markDirty(Envelope2(owner_.prepared_state_.westBound, owner_.prepared_state_.southBound, 0.0, 180.0, owner_.prepared_state_.northBound, 0.0), false);
                                 owner_.surface_ctrl_->markDirty(Envelope2(-180.0, owner_.prepared_state_.southBound, 0.0, owner_.prepared_state_.eastBound, owner_.prepared_state_.northBound, 0.0), false);
                             } else {
@@ -258,6 +333,7 @@ void GLAsynchronousMapRenderable3::WorkerThread::asyncRunImpl() {
 
                 owner_.resetQueryContext(*pendingData);
                 owner_.servicing_request_ = false;
+                owner_.query_state_.reset();
 
                 // check the state and wait if appropriate
                 if (!owner_.shouldQuery()) {
@@ -265,20 +341,92 @@ void GLAsynchronousMapRenderable3::WorkerThread::asyncRunImpl() {
                     continue;
                 }
 
-                // copy the target state to query outside of the
-                // synchronized block
-                queryState = owner_.target_state_;
+                // take a reference to the target state to query outside of
+                // the synchronized block. Intermediate states observed while
+                // the previous query was being serviced are never queried;
+                // only the latest is.
+                queryState = owner_.target_snapshot_;
+                if (!queryState || queryState->drawVersion != owner_.target_state_.drawVersion)
+                    queryState = std::make_shared<const GLGlobeBase::State>(owner_.target_state_);
+                const double margin = owner_.getQueryMargin();
+                if (margin > 0.0) {
+                    std::shared_ptr<GLGlobeBase::State> expanded(std::make_shared<GLGlobeBase::State>(*queryState));
+                    expandBounds(*expanded, margin);
+                    queryState = expanded;
+                }
+                owner_.query_state_ = queryState;
                 owner_.invalid_ = false;
                 owner_.servicing_request_ = true;
                 owner_.cancelled_ = false;
             }
 
-            code = owner_.query(*pendingData, queryState);
+            queryCode = owner_.query(*pendingData, *queryState);
         }
     }
     catch (...) { }
     owner_.servicing_request_ = false;
 }
 
+/*****************************************************************************/
+// Query Context
+
+GLAsynchronousMapRenderable3::QueryContext::QueryContext() NOTHROWS :
+    cancelled_(nullptr)
+{}
+
 GLAsynchronousMapRenderable3::QueryContext::~QueryContext() { }
 
+bool GLAsynchronousMapRenderable3::QueryContext::isCancelled() const NOTHROWS
+{
+    return cancelled_ && cancelled_->load(std::memory_order_relaxed);
+}
+
+namespace
+{
+    void expandBounds(GLGlobeBase::State &state, const double margin) NOTHROWS
+    {
+        const double spanLat = state.northBound - state.southBound;
+        const double spanLng = state.crossesIDL ? (state.eastBound + 360.0 - state.westBound) : (state.eastBound - state.westBound);
+
+        state.northBound = std::min(state.northBound + spanLat * margin, 90.0);
+        state.southBound = std::max(state.southBound - spanLat * margin, -90.0);
+        if (spanLng * (1.0 + 2.0 * margin) >= 360.0) {
+            state.westBound = -180.0;
+            state.eastBound = 180.0;
+            state.crossesIDL = false;
+            return;
+        }
+        double west = state.westBound - spanLng * margin;
+        double east = (state.crossesIDL ? state.eastBound + 360.0 : state.eastBound) + spanLng * margin;
+        if (west < -180.0) {
+            west += 360.0;
+            east += 360.0;
+        }
+        state.westBound = west;
+        state.eastBound = (east > 180.0) ? east - 360.0 : east;
+        state.crossesIDL = (east > 180.0);
+    }
+    bool covers(const GLGlobeBase::State &prepared, const GLGlobeBase::State &target) NOTHROWS
+    {
+        if (prepared.drawSrid != target.drawSrid)
+            return false;
+        if (std::abs(target.drawMapResolution - prepared.drawMapResolution) > prepared.drawMapResolution * REUSE_RESOLUTION_TOLERANCE)
+            return false;
+        if (target.northBound > prepared.northBound || target.southBound < prepared.southBound)
+            return false;
+        if (!prepared.crossesIDL && prepared.westBound <= -180.0 && prepared.eastBound >= 180.0)
+            return true;
+
+        // compare over a continuous longitude range, east of the western
+        // bound of the prepared state
+        const double preparedEast = prepared.crossesIDL ? prepared.eastBound + 360.0 : prepared.eastBound;
+        double targetWest = target.westBound;
+        double targetEast = target.crossesIDL ? target.eastBound + 360.0 : target.eastBound;
+        if (targetWest < prepared.westBound) {
+            targetWest += 360.0;
+            targetEast += 360.0;
+        }
+        return targetWest >= prepared.westBound && targetEast <= preparedEast;
+    }
+}
+
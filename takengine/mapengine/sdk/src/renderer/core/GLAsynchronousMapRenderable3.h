@@ -8,8 +8,10 @@
 #include "port/Collection.h"
 #include "port/Platform.h"
 #include "port/String.h"
+#include "renderer/core/GLDirtyRegion.h"
 #include "renderer/core/GLMapRenderable2.h"
 #include "renderer/core/GLGlobeBase.h"
+#include "renderer/core/GLPreparable.h"
 #include "renderer/core/controls/SurfaceRendererControl.h"
 #include "thread/Monitor.h"
 #include "thread/RWMutex.h"
@@ -21,7 +23,8 @@ namespace TAK {
         namespace Renderer {
             namespace Core {
 
-                class ENGINE_API GLAsynchronousMapRenderable3 : public virtual GLMapRenderable2
+                class ENGINE_API GLAsynchronousMapRenderable3 : public virtual GLMapRenderable2,
+                                                                public GLPreparable
                 {
                 public:
                     class ENGINE_API QueryContext;
@@ -51,6 +54,13 @@ namespace TAK {
                     // on the rendering thread.
                     virtual Util::TAKErr updateRenderableLists(QueryContext &pendingData) NOTHROWS = 0;
 
+                    // Called by asynchronous processing thread immediately
+                    // following a successful updateRenderableLists(). Returns
+                    // the regions of the surface whose content changed with
+                    // the update. If TE_Unsupported is returned, the full
+                    // prepared bounds are marked dirty.
+                    virtual Util::TAKErr getSurfaceDirtyRegion(GLDirtyRegion &value, QueryContext &pendingData) NOTHROWS;
+
                     // Called on rendering thread while holding mutex during release()
                     // to notify subclasses that the worker thread has been terminated
                     // and that any rendering items should be released at this time.
@@ -62,7 +72,31 @@ namespace TAK {
 
                     virtual Util::TAKErr getBackgroundThreadName(TAK::Engine::Port::String &value) NOTHROWS;
 
+                    /**
+                     * Returns the margin by which the bounds of the state
+                     * passed to `query` are expanded, as a fraction of the
+                     * extent of the view on each side. Only the bounds
+                     * (`northBound`, `westBound`, `southBound`, `eastBound`
+                     * and `crossesIDL`) are expanded; the corners and
+                     * viewport continue to describe the view.
+                     *
+                     * <P>If positive, view changes at the same resolution
+                     * that remain within the bounds of the prepared state
+                     * reuse the previous result rather than issuing a new
+                     * query, and a query in progress is cancelled once the
+                     * target view leaves the bounds being queried. The
+                     * default is `0.0`, in which every view change issues a
+                     * query.
+                     */
+                    virtual double getQueryMargin() const NOTHROWS;
+
                     virtual bool shouldQuery() NOTHROWS;
+                    /**
+                     * Invoked while holding the monitor, on the render thread
+                     * or a prepare worker, when the target state changes
+                     * during a query. If `true` is returned, the query is cancelled;
+                     * see `QueryContext::isCancelled()`.
+                     */
                     virtual bool shouldCancel() NOTHROWS;
                     virtual void initImpl(const GLGlobeBase &view) NOTHROWS;
                     void invalidateNoSync() NOTHROWS;
@@ -74,10 +108,23 @@ namespace TAK {
                     virtual void release() NOTHROWS override;
                     virtual void start() NOTHROWS override = 0;
                     virtual void stop() NOTHROWS override = 0;
+                public : // GLPreparable
+                    /**
+                     * Updates the target state and requests a query if
+                     * needed, ahead of `draw`.
+                     */
+                    virtual void prepare(const std::shared_ptr<const GLGlobeBase::State> &state) NOTHROWS override;
+                private :
+                    /** signals or cancels the query thread per the target state; requires the monitor */
+                    void requestQueryNoSync(TAK::Engine::Thread::Monitor::Lock &lock) NOTHROWS;
                 protected :
                     GLGlobeBase::State prepared_state_;
                     GLGlobeBase::State target_state_;
                 private :
+                    /** immutable snapshot of `target_state_`; shared with the query thread */
+                    std::shared_ptr<const GLGlobeBase::State> target_snapshot_;
+                    /** the state of the query being serviced, if any */
+                    std::shared_ptr<const GLGlobeBase::State> query_state_;
                     TAK::Engine::Thread::ThreadPtr thread_;
                     std::unique_ptr<WorkerThread> background_worker_;
                 protected :
@@ -94,7 +141,25 @@ namespace TAK {
                 class ENGINE_API GLAsynchronousMapRenderable3::QueryContext
                 {
                 protected:
+                    QueryContext() NOTHROWS;
                     virtual ~QueryContext() = 0;
+                public :
+                    /**
+                     * Returns `true` if the query being serviced with this
+                     * context has been cancelled. Implementations of
+                     * `query` should check periodically and return
+                     * `TE_Canceled` as soon as practical; the target state
+                     * has moved on and a query for the latest state will
+                     * be issued on return.
+                     *
+                     * <P>Any results left in the context are still passed
+                     * to `updateRenderableLists`, which may decline them.
+                     */
+                    bool isCancelled() const NOTHROWS;
+                private :
+                    const std::atomic<bool> *cancelled_;
+
+                    friend class GLAsynchronousMapRenderable3::WorkerThread;
                 };
 
                 class ENGINE_API GLAsynchronousMapRenderable3::WorkerThread
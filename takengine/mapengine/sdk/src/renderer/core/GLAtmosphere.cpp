@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <vector>
 
@@ -8,19 +10,27 @@
 #include "math/Point2.h"
 #include "math/Matrix2.h"
 #include "renderer/GL.h"
+#include "renderer/GLPerformanceCounters.h"
 #include "renderer/Shader.h"
 #include "renderer/RenderAttributes.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "util/ConfigOptions.h"
+#include "util/Work.h"
 
 using namespace TAK::Engine::Renderer::Core;
 using namespace TAK::Engine::Core;
 using namespace TAK::Engine::Math;
 using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
 
 const char *FRAG_SHADER =
 #include "GLAtmosphere.frag"
 ;
 
+const char *LUT_FRAG_SHADER =
+#include "GLAtmosphereLut.frag"
+;
+
 const char * VERT_SHADER = R"(
 attribute vec4 aVertexCoords;
 attribute vec3 aEyeRay;
@@ -33,6 +43,198 @@ void main() {
 }
 )";
 
+namespace
+{
+    // constants must match GLAtmosphere.frag
+    constexpr double planetRadius = 6356752.3142;
+    constexpr double planetEllipsoid = 6378137.0;
+    constexpr double atmosphereHeight = 100e3;
+    constexpr double kRlh[3u] = { 5.5e-6, 13.0e-6, 22.4e-6 };
+    constexpr double kMie = 21e-6;
+    constexpr double shRlh = 8e3;
+    constexpr double shMie = 1.2e3;
+    constexpr std::size_t iSteps = 16u;
+
+    void getLutSize(std::size_t *width, std::size_t *height, const GLAtmosphere::Quality quality) NOTHROWS
+    {
+        switch(quality) {
+            case GLAtmosphere::LutLow :
+                *width = 64u;
+                break;
+            case GLAtmosphere::LutHigh :
+                *width = 256u;
+                break;
+            case GLAtmosphere::LutMedium :
+            default :
+                *width = 128u;
+                break;
+        }
+        *height = *width / 2u;
+    }
+
+    uint8_t encodeLut(const double v) NOTHROWS
+    {
+        // square root encoding preserves precision for the thin atmosphere
+        // viewed from the ground
+        return (uint8_t)(std::sqrt(std::min(std::max(v, 0.0), 1.0)) * 255.0 + 0.5);
+    }
+
+    /**
+     * Computes the Rayleigh and Mie in-scattering tables, indexed by the
+     * cosine of the view zenith angle (s) and the square root of the
+     * normalized altitude (t) of a ray origin inside the atmosphere. The
+     * sun is at the camera, so the integral is symmetric about the origin
+     * and the phase functions are applied in the shader. Rays that hit the
+     * planet are rejected by the shader; they are integrated through the
+     * planet here so that filtering at the horizon is continuous.
+     */
+    TAKErr computeLut(std::shared_ptr<std::vector<uint8_t>> &value, const std::size_t width, const std::size_t height) NOTHROWS
+    {
+        const std::size_t tableSize = width*height*3u;
+        value = std::make_shared<std::vector<uint8_t>>(tableSize*2u);
+        uint8_t *rayleigh = value->data();
+        uint8_t *mie = value->data() + tableSize;
+
+        const double rAtmos = planetRadius + atmosphereHeight;
+        for(std::size_t j = 0u; j < height; j++) {
+            const double t = ((double)j + 0.5) / (double)height;
+            const double rc = planetRadius + (t*t)*atmosphereHeight;
+            for(std::size_t i = 0u; i < width; i++) {
+                const double mu = 2.0*(((double)i + 0.5) / (double)width) - 1.0;
+                const double sinTheta = std::sqrt(std::max(1.0 - mu*mu, 0.0));
+
+                // exit from the atmosphere; origin is inside
+                const double b = 2.0*mu*rc;
+                const double c = (rc*rc) - (rAtmos*rAtmos);
+                const double d = std::max((b*b) - 4.0*c, 0.0);
+                const double exit = std::max((-b + std::sqrt(d)) / 2.0, 0.0);
+
+                const double iStepSize = exit / (double)iSteps;
+                double iOdRlh = 0.0;
+                double iOdMie = 0.0;
+                double totalRlh[3u] = { 0.0, 0.0, 0.0 };
+                double totalMie[3u] = { 0.0, 0.0, 0.0 };
+                for(std::size_t k = 0u; k < iSteps; k++) {
+                    const double s = iStepSize*((double)k + 0.5);
+                    const double x = sinTheta*s;
+                    const double y = rc + mu*s;
+                    const double iHeight = std::max(5000.0, std::sqrt(x*x + y*y) - planetEllipsoid);
+
+                    const double odStepRlh = std::exp(-iHeight / shRlh) * iStepSize;
+                    const double odStepMie = std::exp(-iHeight / shMie) * iStepSize;
+                    iOdRlh += odStepRlh;
+                    iOdMie += odStepMie;
+                    for(std::size_t ch = 0u; ch < 3u; ch++) {
+                        const double attn = std::exp(-(kMie*iOdMie + kRlh[ch]*iOdRlh));
+                        totalRlh[ch] += odStepRlh*attn;
+                        totalMie[ch] += odStepMie*attn;
+                    }
+                }
+
+                const std::size_t idx = ((j*width) + i)*3u;
+                for(std::size_t ch = 0u; ch < 3u; ch++) {
+                    rayleigh[idx+ch] = encodeLut(kRlh[ch]*totalRlh[ch]);
+                    mie[idx+ch] = encodeLut(kMie*totalMie[ch]);
+                }
+            }
+        }
+        return TE_Ok;
+    }
+}
+
+GLAtmosphere::GLAtmosphere() NOTHROWS
+{
+    const int q = ConfigOptions_getIntOptionOrDefault("glatmosphere.quality", LutMedium);
+    quality = (q >= PerFragment && q <= LutHigh) ? (Quality)q : LutMedium;
+}
+GLAtmosphere::~GLAtmosphere() NOTHROWS
+{
+    if(lut.pending)
+        lut.pending.cancel();
+    if(lut.textures[0u])
+        glDeleteTextures(2u, lut.textures);
+}
+
+void GLAtmosphere::setQuality(const Quality quality_) NOTHROWS
+{
+    quality = quality_;
+}
+GLAtmosphere::Quality GLAtmosphere::getQuality() const NOTHROWS
+{
+    return quality;
+}
+
+bool GLAtmosphere::validateLut() NOTHROWS
+{
+    if(quality == PerFragment)
+        return false;
+    if(lut.quality == quality && lut.textures[0u])
+        return true;
+
+    // any tables already uploaded remain in use until their replacement is
+    // ready
+    const bool current = !!lut.textures[0u];
+    if(lut.pending && lut.pendingQuality != quality) {
+        lut.pending.cancel();
+        lut.pending = Future<std::shared_ptr<std::vector<uint8_t>>>();
+    }
+    if(!lut.pending) {
+        std::size_t width;
+        std::size_t height;
+        getLutSize(&width, &height, quality);
+        lut.pending = Task_begin(GeneralWorkers_cpu(), computeLut, width, height);
+        lut.pendingQuality = quality;
+        return current;
+    }
+
+    bool ready = false;
+    if(lut.pending.isReady(ready) != TE_Ok || !ready)
+        return current;
+    std::shared_ptr<std::vector<uint8_t>> data;
+    TAKErr code(TE_Ok);
+    lut.pending.await(data, code);
+    lut.pending.detach();
+    if(code != TE_Ok || !data) {
+        quality = PerFragment;
+        return false;
+    }
+
+    if(!lut.program) {
+        lut.program = std::make_shared<atakmap::renderer::Program>();
+        lut.program->create(VERT_SHADER, LUT_FRAG_SHADER);
+        if(lut.program->program == 0) {
+            lut.program.reset();
+            quality = PerFragment;
+            return false;
+        }
+        lut.uCampos = glGetUniformLocation(lut.program->program, "campos");
+        lut.uRayleighLut = glGetUniformLocation(lut.program->program, "uRayleighLut");
+        lut.uMieLut = glGetUniformLocation(lut.program->program, "uMieLut");
+        lut.aVertexCoordsHandle = glGetAttribLocation(lut.program->program, "aVertexCoords");
+        lut.aEyeRayHandle = glGetAttribLocation(lut.program->program, "aEyeRay");
+    }
+
+    std::size_t width;
+    std::size_t height;
+    getLutSize(&width, &height, lut.pendingQuality);
+    if(!lut.textures[0u])
+        glGenTextures(2u, lut.textures);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for(std::size_t i = 0u; i < 2u; i++) {
+        glBindTexture(GL_TEXTURE_2D, lut.textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, (GLsizei)width, (GLsizei)height, 0, GL_RGB, GL_UNSIGNED_BYTE, data->data() + (i*width*height*3u));
+    }
+    glBindTexture(GL_TEXTURE_2D, GL_NONE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    lut.quality = lut.pendingQuality;
+
+    return true;
+}
+
 void GLAtmosphere::init() NOTHROWS
 {
     const char* vertShaderSource = VERT_SHADER;
@@ -69,7 +271,7 @@ Matrix2 ComputeInverse(const TAK::Engine::Core::MapSceneModel2& mapSceneModel2)
     return imvp;
 }
 
-void GLAtmosphere::DrawAtmosphere(const GLGlobeBase& view) const NOTHROWS
+void GLAtmosphere::DrawAtmosphere(const GLGlobeBase& view) NOTHROWS
 {
     const MapSceneModel2& scene = view.renderPasses[0].scene;
     bool isFlat = scene.displayModel->earth->getGeomClass() == GeometryModel2::PLANE;
@@ -135,20 +337,39 @@ void GLAtmosphere::DrawAtmosphere(const GLGlobeBase& view) const NOTHROWS
     }
 
     Matrix2 inv = ComputeInverse(globe);
-    glUseProgram(program->program);
-
-    glUniform3f(uCampos, (float)campos.x, (float)campos.y, (float)campos.z);
-    glUniform3f(uSunpos,  (float)campos.x, (float)campos.y, (float)campos.z);
-
     glDisable(GL_DEPTH_TEST);
     glDisable(GL_BLEND);
-    DrawQuad(inv, campos);
-    
+    if(validateLut()) {
+        glUseProgram(lut.program->program);
+
+        glUniform3f(lut.uCampos, (float)campos.x, (float)campos.y, (float)campos.z);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, lut.textures[1u]);
+        glUniform1i(lut.uMieLut, 1);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, lut.textures[0u]);
+        glUniform1i(lut.uRayleighLut, 0);
+
+        DrawQuad(inv, campos, lut.aVertexCoordsHandle, lut.aEyeRayHandle);
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, GL_NONE);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, GL_NONE);
+    } else {
+        glUseProgram(program->program);
+
+        glUniform3f(uCampos, (float)campos.x, (float)campos.y, (float)campos.z);
+        glUniform3f(uSunpos,  (float)campos.x, (float)campos.y, (float)campos.z);
+
+        DrawQuad(inv, campos, aVertexCoordsHandle, aEyeRayHandle);
+    }
+
     glEnable(GL_DEPTH_TEST);
 }
 
 
-void GLAtmosphere::DrawQuad(const Matrix2& inv, const Vector4<double>& camposv) const NOTHROWS
+void GLAtmosphere::DrawQuad(const Matrix2& inv, const Vector4<double>& camposv, const int vertexCoordsHandle, const int eyeRayHandle) const NOTHROWS
 {
     const float minx = -1;
     const float miny = -1;
@@ -199,13 +420,14 @@ void GLAtmosphere::DrawQuad(const Matrix2& inv, const Vector4<double>& camposv)
         }
     }
 
-    glEnableVertexAttribArray(aVertexCoordsHandle);
-    glVertexAttribPointer(aVertexCoordsHandle, 4, GL_FLOAT, GL_FALSE, 28, (float*)&verts[0]);
+    glEnableVertexAttribArray(vertexCoordsHandle);
+    glVertexAttribPointer(vertexCoordsHandle, 4, GL_FLOAT, GL_FALSE, 28, (float*)&verts[0]);
 
-    glEnableVertexAttribArray(aEyeRayHandle);
-    glVertexAttribPointer(aEyeRayHandle, 3, GL_FLOAT, GL_FALSE, 28, (float*)&verts[0] + 4);
+    glEnableVertexAttribArray(eyeRayHandle);
+    glVertexAttribPointer(eyeRayHandle, 3, GL_FLOAT, GL_FALSE, 28, (float*)&verts[0] + 4);
 
     glDrawArrays(GL_TRIANGLES, 0, vertsSize / 7);
+    GLPerformanceCounters_draw(GL_TRIANGLES, vertsSize / 7);
 }
 
 TAK::Engine::Util::TAKErr TAK::Engine::Renderer::Core::GLAtmosphere::draw(const GLGlobeBase &view) NOTHROWS
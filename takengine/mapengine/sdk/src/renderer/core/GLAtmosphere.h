@@ -5,10 +5,15 @@
 #ifndef TAK_ENGINE_RENDERER_CORE_GLATMOSPHERE_H_INCLUDED
 #define TAK_ENGINE_RENDERER_CORE_GLATMOSPHERE_H_INCLUDED
 
+#include <memory>
+#include <vector>
+
 #include <renderer/RenderAttributes.h>
 #include "port/Platform.h"
 #include "math/Vector4.h"
+#include "renderer/GL.h"
 #include "renderer/core/GLGlobeBase.h"
+#include "util/Tasking.h"
 namespace atakmap
 {
     namespace renderer
@@ -30,12 +35,41 @@ namespace TAK {
                 class ENGINE_API GLAtmosphere
                 {
                 public:
-                    GLAtmosphere() = default;
+                    /**
+                     * Scattering evaluation mode. The lookup table modes
+                     * replace the per fragment ray march with two texture
+                     * fetches; the tables are computed on a worker thread
+                     * and per fragment evaluation is used until they are
+                     * available.
+                     */
+                    enum Quality
+                    {
+                        /** Ray march the scattering integral per fragment */
+                        PerFragment,
+                        /** 64x32 lookup tables */
+                        LutLow,
+                        /** 128x64 lookup tables */
+                        LutMedium,
+                        /** 256x128 lookup tables */
+                        LutHigh,
+                    };
+                public:
+                    /**
+                     * Quality is initialized from the
+                     * <code>glatmosphere.quality</code> configuration option,
+                     * defaulting to <code>LutMedium</code>.
+                     */
+                    GLAtmosphere() NOTHROWS;
+                    ~GLAtmosphere() NOTHROWS;
+                public:
                     Util::TAKErr draw(const GLGlobeBase &view) NOTHROWS;
+                    void setQuality(const Quality quality) NOTHROWS;
+                    Quality getQuality() const NOTHROWS;
                 private:
-                    void DrawAtmosphere(const GLGlobeBase& view) const NOTHROWS;
-                    void DrawQuad(const TAK::Engine::Math::Matrix2 &inv, const TAK::Engine::Math::Vector4<double>&cameraPos) const NOTHROWS;
+                    void DrawAtmosphere(const GLGlobeBase& view) NOTHROWS;
+                    void DrawQuad(const TAK::Engine::Math::Matrix2 &inv, const TAK::Engine::Math::Vector4<double>&cameraPos, const int vertexCoordsHandle, const int eyeRayHandle) const NOTHROWS;
                     void init() NOTHROWS;
+                    bool validateLut() NOTHROWS;
 
                     std::shared_ptr<atakmap::renderer::Program> program;
 
@@ -44,6 +78,22 @@ namespace TAK {
                     int aVertexCoordsHandle;
                     int aEyeRayHandle;
 
+                    Quality quality;
+                    struct {
+                        std::shared_ptr<atakmap::renderer::Program> program;
+                        int uCampos;
+                        int uRayleighLut;
+                        int uMieLut;
+                        int aVertexCoordsHandle;
+                        int aEyeRayHandle;
+                        /** Rayleigh and Mie tables */
+                        GLuint textures[2u] {GL_NONE, GL_NONE};
+                        /** quality of the uploaded tables */
+                        Quality quality {PerFragment};
+                        /** RGB Rayleigh table followed by RGB Mie table */
+                        Util::Future<std::shared_ptr<std::vector<uint8_t>>> pending;
+                        Quality pendingQuality {PerFragment};
+                    } lut;
                 };
             }
         }
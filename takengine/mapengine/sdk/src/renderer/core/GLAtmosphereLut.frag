@@ -0,0 +1,85 @@
+R"(
+
+precision highp float;
+varying highp vec3 eyeRay;
+uniform highp vec3 campos;
+uniform sampler2D uRayleighLut;
+uniform sampler2D uMieLut;
+#define PI 3.141592
+#define planetRadius 6356752.3142
+#define atmosphereHeight 100e3
+#define g 0.758			// Mie preferred scattering direction
+
+// In-scattering is precomputed by GLAtmosphere into two lookup tables,
+// indexed by the cosine of the view zenith angle (s) and the normalized
+// altitude (t, square root mapped) of the ray origin inside the atmosphere.
+// The tables hold the Rayleigh and Mie coefficients multiplied by the
+// attenuated optical depth, square root encoded. The sun is at the camera,
+// so only the phase functions are evaluated here.
+
+highp vec2 rsi(highp vec3 r0, highp vec3 ray_dir, highp float sr) {
+   // ray-sphere intersection that assumes
+   // the sphere is centered at the origin.
+   // No intersection when result.x > result.y
+   highp float a = dot(ray_dir, ray_dir);
+   highp float b = 2.0 * dot(ray_dir, r0);
+   highp float c = dot(r0, r0) - (sr * sr);
+   highp float d = (b*b) - 4.0*a*c;
+   if (d < 0.0) return vec2(1e15,-1e15);
+   return vec2(
+   (-b - sqrt(d))/(2.0*a),
+   (-b + sqrt(d))/(2.0*a)
+   );
+}
+
+highp vec2 atmosphere_intersect(highp vec3 ray_dir, highp vec3 r0, highp float rPlanet, highp float rAtmos)
+{
+	highp vec2 no_intersect = vec2(1e15, -1e15);
+	highp float foutside = max(sign(length(r0) - (rAtmos)), 0.0); //0 inside atmosphere, 1 outside
+    highp vec2 p = rsi(r0, ray_dir, rAtmos);
+    if (p.x > p.y) return no_intersect;
+	if(p.y < 0.0) return no_intersect;
+	highp vec2 planet_p = rsi(r0, ray_dir, rPlanet);
+	if(planet_p.x < 0.0)
+	   planet_p.x = 1e15;
+
+	if(planet_p.y > planet_p.x)
+		return no_intersect;
+
+    p.y = min(p.y, planet_p.x);
+	p.x = p.x * foutside;
+
+	return p;
+}
+
+void main(void) {
+	vec3 col = vec3(0,0,0);
+
+	highp vec3 ray_dir = normalize(eyeRay);
+	highp vec2 intersection = atmosphere_intersect(ray_dir, campos, planetRadius, planetRadius + atmosphereHeight);
+	if(intersection.x < intersection.y)
+	{
+		// move the origin to where the ray enters the atmosphere
+		highp vec3 r0 = campos + ray_dir * intersection.x;
+		highp float rc = length(r0);
+		highp vec2 st = vec2(
+				dot(ray_dir, r0 / rc) * 0.5 + 0.5,
+				sqrt(clamp((rc - planetRadius) / atmosphereHeight, 0.0, 1.0)));
+		highp vec3 rlh = texture2D(uRayleighLut, st).rgb;
+		highp vec3 mie = texture2D(uMieLut, st).rgb;
+		rlh *= rlh;
+		mie *= mie;
+
+		// Calculate the Rayleigh and Mie phases.
+		highp float mu = dot(ray_dir, normalize(campos));
+		highp float mumu = mu * mu;
+		highp float gg = g * g;
+		highp float pRlh = 3.0 / (16.0 * PI) * (1.0 + mumu);
+		highp float pMie = 3.0 / (8.0 * PI) * ((1.0 - gg) * (mumu + 1.0)) / (pow(1.0 + gg - 2.0 * mu * g, 1.5) * (2.0 + gg));
+
+		col = 33.0 * (pRlh * rlh + pMie * mie);
+		col = 1.0 - exp(-1.0 * col);
+	}
+    gl_FragColor = vec4(col.x, col.y, col.z, 1.0);
+}
+)"
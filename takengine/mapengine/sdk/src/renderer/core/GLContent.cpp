@@ -13,7 +13,9 @@ using namespace TAK::Engine::Port;
 //
 
 GLContentContext::GLPendingContent::~GLPendingContent() NOTHROWS {
-    this->future_.cancel(); // does nothing if already detached
+    // do nothing if already detached
+    this->future_.cancel();
+    this->load_future_.cancel();
 }
 
 void GLContentContext::GLPendingContent::draw(const TAK::Engine::Renderer::Core::GLGlobeBase& view, const int renderPass) NOTHROWS {
@@ -91,9 +93,11 @@ Future<Core::GLMapRenderable2*> GLContentContext::loadImpl_(const std::shared_pt
     node->prev->next = node;
 
     // schedule call on load_worker_ to loadTask_
-    // if success pass result to updateTask_ on the GL thread
-    node->pending_content_.future_ = Task_begin(load_worker_, loadTask_, loader_, &ctx_, String(URI))
-        .thenOn(GLWorkers_glThread(), updateTask_, holder);
+    // if success pass result to updateTask_ on the GL thread, otherwise mark the holder with failTask_
+    node->pending_content_.load_future_ = Task_begin(load_worker_, loadTask_, loader_, &ctx_, String(URI));
+    node->pending_content_.future_ = node->pending_content_.load_future_
+        .thenOn(GLWorkers_glThread(), updateTask_, holder)
+        .trapOn(GLWorkers_glThread(), failTask_, holder);
 
     return node->pending_content_.future_;
 }
@@ -126,17 +130,8 @@ TAKErr GLContentContext::updateTask_(Core::GLMapRenderable2*& output, GLMapRende
     if (!holder->content_)
         return TE_Ok;
 
-    if (holder->state_.load() == GLContentHolder::LOADING) {
-        GLPendingContent* pending = static_cast<GLPendingContent*>(holder->content_.release());
-
-        // prevent cancel for doing anything when PendingContent releases
-        pending->future_.detach();
-
-        // remove node
-        PendingNode_* node = PendingNode_::fromPendingContent(pending);
-        node->selfRemove();
-        delete node;
-    }
+    if (holder->state_.load() == GLContentHolder::LOADING)
+        releasePending_(*holder);
 
     // update the holder
     holder->content_ = std::move(input);
@@ -146,6 +141,35 @@ TAKErr GLContentContext::updateTask_(Core::GLMapRenderable2*& output, GLMapRende
     return TE_Ok;
 }
 
+TAKErr GLContentContext::failTask_(Core::GLMapRenderable2*&, TAKErr err, const std::shared_ptr<HolderImpl_>& holder) NOTHROWS {
+
+    // in the GLThread
+
+    // canceled loads were already released by the holder or context
+    if (err == TE_Canceled || !holder->content_)
+        return err;
+
+    if (holder->state_.load() == GLContentHolder::LOADING) {
+        releasePending_(*holder);
+        holder->state_.store(GLContentHolder::ERROR, std::memory_order_release);
+    }
+
+    return err;
+}
+
+void GLContentContext::releasePending_(HolderImpl_& holder) NOTHROWS {
+    GLPendingContent* pending = static_cast<GLPendingContent*>(holder.content_.release());
+
+    // prevent cancel for doing anything when PendingContent releases
+    pending->future_.detach();
+    pending->load_future_.detach();
+
+    // remove node
+    PendingNode_* node = PendingNode_::fromPendingContent(pending);
+    node->selfRemove();
+    delete node;
+}
+
 void GLContentContext::cancelAll() NOTHROWS {
     Node_* node = pending_list_.next; //  head
     while (node != &pending_list_) { // end
@@ -181,6 +205,10 @@ Future<GLMapRenderable2*> GLContentHolder::load(GLContentContext& context, const
 }
 
 void GLContentHolder::unload() {
+    if (getLoadState() == LOADING && impl_->content_) {
+        // cancels the load
+        static_cast<GLContentContext::GLPendingContent*>(impl_->content_.release())->release();
+    }
     impl_->content_.reset();
     impl_->state_.store(EMPTY, std::memory_order_release);
 }
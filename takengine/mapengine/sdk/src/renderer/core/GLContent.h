@@ -82,6 +82,8 @@ namespace TAK {
                         virtual void start() NOTHROWS;
                         virtual void stop() NOTHROWS;
                         TAK::Engine::Util::Future<TAK::Engine::Renderer::Core::GLMapRenderable2*> future_;
+                        // the load itself; canceled with future_ so that a queued load never runs
+                        TAK::Engine::Util::Future<TAK::Engine::Renderer::Core::GLMapRenderable2Ptr> load_future_;
                     };
 
                     struct HolderImpl_ {
@@ -109,6 +111,8 @@ namespace TAK {
                         const char* URI) NOTHROWS;
 
                     static Util::TAKErr updateTask_(TAK::Engine::Renderer::Core::GLMapRenderable2*&, TAK::Engine::Renderer::Core::GLMapRenderable2Ptr& content, const std::shared_ptr<HolderImpl_>& holder) NOTHROWS;
+                    static Util::TAKErr failTask_(TAK::Engine::Renderer::Core::GLMapRenderable2*&, Util::TAKErr err, const std::shared_ptr<HolderImpl_>& holder) NOTHROWS;
+                    static void releasePending_(HolderImpl_& holder) NOTHROWS;
 
                     struct Node_ {
                         Node_* next;
@@ -163,7 +167,7 @@ namespace TAK {
                     TAK::Engine::Util::Future<TAK::Engine::Renderer::Core::GLMapRenderable2*> load(GLContentContext& context, const char* URI);
 
                     /**
-                     * Unload any current loaded content.
+                     * Unload any current loaded content. A load in progress is canceled.
                      * 
                      * NOTE: Only call on the GLThread
                      */
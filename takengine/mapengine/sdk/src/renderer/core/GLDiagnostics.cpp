@@ -2,16 +2,42 @@
 // Created by GeoDev on 12/15/2020.
 //
 
+#include <algorithm>
 #include <chrono>
 
 #include "renderer/core/GLDiagnostics.h"
 
+#if !defined(_MSC_VER) && TE_GLES_VERSION >= 3
+#include <EGL/egl.h>
+#endif
+
+#include "renderer/core/GLGlobe.h"
+#include "thread/Lock.h"
+
 using namespace TAK::Engine::Renderer::Core;
 
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
+// bounds outstanding queries if results are never collected
+#define TE_GLDIAGNOSTICS_MAX_PENDING_GPU_TIMINGS 4096u
+
 namespace
 {
+#if TE_GLES_VERSION >= 3 && defined(GL_EXT_disjoint_timer_query)
+    struct TimerQueryExt
+    {
+        bool supported {false};
+        PFNGLQUERYCOUNTEREXTPROC glQueryCounter {nullptr};
+        PFNGLGETQUERYIVEXTPROC glGetQueryiv {nullptr};
+        PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64v {nullptr};
+    };
+
+    const TimerQueryExt &timerQueryExt() NOTHROWS;
+#endif
+    GLuint queryTimestamp(std::vector<GLuint> &pool) NOTHROWS;
+
     int64_t System_nanoTime() NOTHROWS
     {
         static const auto up = std::chrono::high_resolution_clock::now();
@@ -21,7 +47,8 @@ namespace
     }
 }
 
-GLDiagnostics::GLDiagnostics() NOTHROWS
+GLDiagnostics::GLDiagnostics() NOTHROWS :
+    gpuTimingEnabled(false)
 {
     profile.push_back(&root);
 }
@@ -80,7 +107,9 @@ TAKErr GLDiagnostics::push(const char *name) NOTHROWS
     }
     profile.push_back(m);
 
-    // start the timer
+    // start the timers
+    if (gpuTimingEnabled && !m->gpuTimerStart)
+        m->gpuTimerStart = queryTimestamp();
     m->timerStart = System_nanoTime();
     return TE_Ok;
 }
@@ -94,6 +123,18 @@ TAKErr GLDiagnostics::pop() NOTHROWS
         auto timerStop = System_nanoTime();
         profile.back()->duration += (timerStop-profile.back()->timerStart);
         profile.back()->count++;
+
+        if (profile.back()->gpuTimerStart) {
+            GpuTiming timing;
+            timing.diagnostic = profile.back();
+            timing.start = profile.back()->gpuTimerStart;
+            timing.stop = queryTimestamp();
+            profile.back()->gpuTimerStart = GL_NONE;
+            if (timing.stop)
+                gpuPending.push_back(timing);
+            else
+                recycleGpuTiming(timing);
+        }
     }
     // pop the diagnostic off the stack
     profile.pop_back();
@@ -108,6 +149,8 @@ void GLDiagnostics::reset()  NOTHROWS
         {
             d.count = 0u;
             d.duration = 0LL;
+            d.gpuCount = 0u;
+            d.gpuDuration = 0LL;
             for(auto &c : d.children)
                 (*this)(c.second);
         }
@@ -115,6 +158,250 @@ void GLDiagnostics::reset()  NOTHROWS
     Resetter r;
     r(*profile[0u]);
 }
+void GLDiagnostics::getTimings(std::vector<Timing> &value) const NOTHROWS
+{
+    struct Collector
+    {
+        void operator()(std::vector<Timing> &timings, const Diagnostic &d, const std::size_t depth) NOTHROWS
+        {
+            Timing t;
+            t.name = d.name;
+            t.depth = depth;
+            t.count = d.count;
+            t.cpuNanos = d.duration;
+            t.gpuCount = d.gpuCount;
+            t.gpuNanos = d.gpuDuration;
+            timings.push_back(t);
+            for(const auto &c : d.children)
+                (*this)(timings, c.second, depth+1u);
+        }
+    };
+    Collector c;
+    for(const auto &m : root.children)
+        c(value, m.second, 0u);
+}
+void GLDiagnostics::setGpuTimingEnabled(const bool enabled) NOTHROWS
+{
+    gpuTimingEnabled = enabled;
+}
+bool GLDiagnostics::isGpuTimingEnabled() const NOTHROWS
+{
+    return gpuTimingEnabled;
+}
+void GLDiagnostics::collectGpuTimings() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3 && defined(GL_EXT_disjoint_timer_query)
+    if (gpuPending.empty())
+        return;
+    const TimerQueryExt &ext = timerQueryExt();
+
+    // a disjoint operation (e.g. frequency change) invalidates all results
+    // in flight
+    GLint disjoint = GL_FALSE;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (disjoint) {
+        while (!gpuPending.empty()) {
+            recycleGpuTiming(gpuPending.front());
+            gpuPending.pop_front();
+        }
+        return;
+    }
+
+    // queries complete in issue order
+    while (!gpuPending.empty()) {
+        const GpuTiming &timing = gpuPending.front();
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(timing.stop, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+        GLuint64 start = 0u;
+        GLuint64 stop = 0u;
+        ext.glGetQueryObjectui64v(timing.start, GL_QUERY_RESULT, &start);
+        ext.glGetQueryObjectui64v(timing.stop, GL_QUERY_RESULT, &stop);
+        if (stop > start) {
+            timing.diagnostic->gpuDuration += static_cast<int64_t>(stop - start);
+            timing.diagnostic->gpuCount++;
+        }
+        recycleGpuTiming(timing);
+        gpuPending.pop_front();
+    }
+#endif
+}
+void GLDiagnostics::release() NOTHROWS
+{
+    while (!gpuPending.empty()) {
+        recycleGpuTiming(gpuPending.front());
+        gpuPending.pop_front();
+    }
+    for (auto d : profile) {
+        if (d->gpuTimerStart) {
+            gpuQueryPool.push_back(d->gpuTimerStart);
+            d->gpuTimerStart = GL_NONE;
+        }
+    }
+#if TE_GLES_VERSION >= 3
+    if (!gpuQueryPool.empty())
+        glDeleteQueries(static_cast<GLsizei>(gpuQueryPool.size()), gpuQueryPool.data());
+#endif
+    gpuQueryPool.clear();
+}
+GLuint GLDiagnostics::queryTimestamp() NOTHROWS
+{
+    if (gpuPending.size() >= TE_GLDIAGNOSTICS_MAX_PENDING_GPU_TIMINGS)
+        return GL_NONE;
+    return ::queryTimestamp(gpuQueryPool);
+}
+void GLDiagnostics::recycleGpuTiming(const GpuTiming &timing) NOTHROWS
+{
+    if (timing.start)
+        gpuQueryPool.push_back(timing.start);
+    if (timing.stop)
+        gpuQueryPool.push_back(timing.stop);
+}
+
+GLFrameStatistics::GLFrameStatistics(const std::size_t capacity) NOTHROWS :
+    frames(std::max(capacity, (std::size_t)1u)),
+    frameCount(0LL),
+    enabled(false),
+    inFrame(false),
+    gpuTimerStart(GL_NONE)
+{}
+GLFrameStatistics::~GLFrameStatistics() NOTHROWS
+{}
+void GLFrameStatistics::setEnabled(const bool enabled_) NOTHROWS
+{
+    enabled = enabled_;
+}
+bool GLFrameStatistics::isEnabled() const NOTHROWS
+{
+    return enabled;
+}
+void GLFrameStatistics::beginFrame(const PerformanceCounters &frameCounters) NOTHROWS
+{
+    inFrame = enabled;
+    if (!inFrame)
+        return;
+    // results are typically available a few frames after issue
+    collectGpuTimings();
+
+    current = Frame();
+    current.timestamp = Platform_systime_millis();
+    frameCounters.getSnapshot(&counters);
+    // bound the outstanding queries if results are slow to arrive
+    if (!gpuTimerStart && gpuPending.size() < frames.size())
+        gpuTimerStart = queryTimestamp(gpuQueryPool);
+}
+void GLFrameStatistics::endFrame(const PerformanceCounters &frameCounters, const int64_t cpuPrepareNanos, const int64_t cpuSubmitNanos) NOTHROWS
+{
+    if (!inFrame)
+        return;
+    inFrame = false;
+
+    PerformanceCountersSnapshot end;
+    frameCounters.getSnapshot(&end);
+    current.cpuPrepareNanos = cpuPrepareNanos;
+    current.cpuSubmitNanos = cpuSubmitNanos;
+    current.drawCalls = end.counters[TEPC_DrawCalls] - counters.counters[TEPC_DrawCalls];
+    current.triangles = end.counters[TEPC_Triangles] - counters.counters[TEPC_Triangles];
+    current.textureUploadBytes = end.counters[TEPC_TextureUploadBytes] - counters.counters[TEPC_TextureUploadBytes];
+    current.tileRequestsIssued = end.counters[TEPC_TileRequestsIssued] - counters.counters[TEPC_TileRequestsIssued];
+    current.tileRequestsCompleted = end.counters[TEPC_TileRequestsCompleted] - counters.counters[TEPC_TileRequestsCompleted];
+    current.labelsPlaced = end.counters[TEPC_LabelsPlaced] - counters.counters[TEPC_LabelsPlaced];
+
+    {
+        Lock lock(mutex);
+        current.frame = ++frameCount;
+        frames[static_cast<std::size_t>(current.frame - 1LL) % frames.size()] = current;
+    }
+
+    if (gpuTimerStart) {
+        GpuTiming timing;
+        timing.frame = current.frame;
+        timing.start = gpuTimerStart;
+        timing.stop = queryTimestamp(gpuQueryPool);
+        gpuTimerStart = GL_NONE;
+        if (timing.stop)
+            gpuPending.push_back(timing);
+        else
+            recycleGpuTiming(timing);
+    }
+}
+TAKErr GLFrameStatistics::getFrames(std::vector<Frame> &value, const int64_t since) const NOTHROWS
+{
+    Lock lock(mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    const int64_t capacity = static_cast<int64_t>(frames.size());
+    const int64_t oldest = std::max(std::max(since, frameCount - capacity), (int64_t)0) + 1;
+    for (int64_t frame = oldest; frame <= frameCount; frame++)
+        value.push_back(frames[static_cast<std::size_t>(frame - 1LL) % frames.size()]);
+    return TE_Ok;
+}
+void GLFrameStatistics::release() NOTHROWS
+{
+    while (!gpuPending.empty()) {
+        recycleGpuTiming(gpuPending.front());
+        gpuPending.pop_front();
+    }
+    if (gpuTimerStart) {
+        gpuQueryPool.push_back(gpuTimerStart);
+        gpuTimerStart = GL_NONE;
+    }
+#if TE_GLES_VERSION >= 3
+    if (!gpuQueryPool.empty())
+        glDeleteQueries(static_cast<GLsizei>(gpuQueryPool.size()), gpuQueryPool.data());
+#endif
+    gpuQueryPool.clear();
+}
+void GLFrameStatistics::collectGpuTimings() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3 && defined(GL_EXT_disjoint_timer_query)
+    if (gpuPending.empty())
+        return;
+    const TimerQueryExt &ext = timerQueryExt();
+
+    // a disjoint operation invalidates all results in flight; the frames
+    // retain a GPU time of `-1`
+    GLint disjoint = GL_FALSE;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (disjoint) {
+        while (!gpuPending.empty()) {
+            recycleGpuTiming(gpuPending.front());
+            gpuPending.pop_front();
+        }
+        return;
+    }
+
+    // queries complete in issue order
+    while (!gpuPending.empty()) {
+        const GpuTiming &timing = gpuPending.front();
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(timing.stop, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+        GLuint64 start = 0u;
+        GLuint64 stop = 0u;
+        ext.glGetQueryObjectui64v(timing.start, GL_QUERY_RESULT, &start);
+        ext.glGetQueryObjectui64v(timing.stop, GL_QUERY_RESULT, &stop);
+        if (stop > start) {
+            Lock lock(mutex);
+            // the frame may have been evicted from the history
+            Frame &frame = frames[static_cast<std::size_t>(timing.frame - 1LL) % frames.size()];
+            if (frame.frame == timing.frame)
+                frame.gpuNanos = static_cast<int64_t>(stop - start);
+        }
+        recycleGpuTiming(timing);
+        gpuPending.pop_front();
+    }
+#endif
+}
+void GLFrameStatistics::recycleGpuTiming(const GpuTiming &timing) NOTHROWS
+{
+    if (timing.start)
+        gpuQueryPool.push_back(timing.start);
+    if (timing.stop)
+        gpuQueryPool.push_back(timing.stop);
+}
 
 void GLDiagnostics::flushDiagnostics(GLGlobe &view, const Diagnostic &m, const std::size_t indentCount, const int64_t total) NOTHROWS
 {
@@ -123,10 +410,69 @@ void GLDiagnostics::flushDiagnostics(GLGlobe &view, const Diagnostic &m, const s
     indent[std::min(indentCount, (std::size_t)32u)] = '\0';
 
     char msg[512];
-    const int result = snprintf(msg, 512, "%s%s count %3u duration %7dus %03.1lf", indent, m.name.c_str(), (unsigned)m.count, (unsigned)(m.duration/1000LL), (double)m.duration/(double)total*100.0);
+    int result;
+    if (m.gpuCount)
+        result = snprintf(msg, 512, "%s%s count %3u duration %7dus %03.1lf gpu %7dus", indent, m.name.c_str(), (unsigned)m.count, (unsigned)(m.duration/1000LL), (double)m.duration/(double)total*100.0, (unsigned)(m.gpuDuration/1000LL));
+    else
+        result = snprintf(msg, 512, "%s%s count %3u duration %7dus %03.1lf", indent, m.name.c_str(), (unsigned)m.count, (unsigned)(m.duration/1000LL), (double)m.duration/(double)total*100.0);
     if(result > 0)
         view.addRenderDiagnosticMessage(msg);
     // recurse over children
     for(const auto &c : m.children)
         flushDiagnostics(view, c.second, indentCount+2u, total);
 }
+
+namespace
+{
+#if TE_GLES_VERSION >= 3 && defined(GL_EXT_disjoint_timer_query)
+    const TimerQueryExt &timerQueryExt() NOTHROWS
+    {
+        // resolved on first use on the GL thread
+        static const TimerQueryExt ext = []()
+        {
+            TimerQueryExt value;
+            const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+            if (!extensions || !strstr(extensions, "GL_EXT_disjoint_timer_query"))
+                return value;
+#ifdef _MSC_VER
+            value.glQueryCounter = glQueryCounterEXT;
+            value.glGetQueryiv = glGetQueryivEXT;
+            value.glGetQueryObjectui64v = glGetQueryObjectui64vEXT;
+#else
+            value.glQueryCounter = reinterpret_cast<PFNGLQUERYCOUNTEREXTPROC>(eglGetProcAddress("glQueryCounterEXT"));
+            value.glGetQueryiv = reinterpret_cast<PFNGLGETQUERYIVEXTPROC>(eglGetProcAddress("glGetQueryivEXT"));
+            value.glGetQueryObjectui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(eglGetProcAddress("glGetQueryObjectui64vEXT"));
+#endif
+            if (!value.glQueryCounter || !value.glGetQueryiv || !value.glGetQueryObjectui64v)
+                return value;
+            // some implementations advertise the extension without timestamp
+            // support
+            GLint bits = 0;
+            value.glGetQueryiv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &bits);
+            value.supported = (bits > 0);
+            return value;
+        }();
+        return ext;
+    }
+#endif
+    GLuint queryTimestamp(std::vector<GLuint> &pool) NOTHROWS
+    {
+#if TE_GLES_VERSION >= 3 && defined(GL_EXT_disjoint_timer_query)
+        const TimerQueryExt &ext = timerQueryExt();
+        if (!ext.supported)
+            return GL_NONE;
+        GLuint query = GL_NONE;
+        if (!pool.empty()) {
+            query = pool.back();
+            pool.pop_back();
+        } else {
+            glGenQueries(1u, &query);
+        }
+        if (query)
+            ext.glQueryCounter(query, GL_TIMESTAMP_EXT);
+        return query;
+#else
+        return GL_NONE;
+#endif
+    }
+}
@@ -5,18 +5,26 @@
 #ifndef TAK_ENGINE_RENDERER_CORE_GLDIAGNOSTICS_H
 #define TAK_ENGINE_RENDERER_CORE_GLDIAGNOSTICS_H
 
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <map>
+#include <string>
+#include <vector>
 
 #include "port/Platform.h"
 #include "port/String.h"
-#include "renderer/core/GLGlobe.h"
+#include "renderer/GL.h"
+#include "thread/Mutex.h"
 #include "util/Error.h"
+#include "util/PerformanceCounters.h"
 
 namespace TAK {
     namespace Engine {
         namespace Renderer {
             namespace Core {
+                class GLGlobe;
+
                 class ENGINE_API GLDiagnostics
                 {
                 private :
@@ -25,9 +33,31 @@ namespace TAK {
                         int64_t timerStart;
                         std::size_t count{0u};
                         int64_t duration{0LL};
+                        /** timestamp query issued on `push`, if GPU timing */
+                        GLuint gpuTimerStart{GL_NONE};
+                        std::size_t gpuCount{0u};
+                        int64_t gpuDuration{0LL};
                         std::string name;
                         std::map<std::string, struct Diagnostic> children;
                     };
+                    struct GpuTiming
+                    {
+                        Diagnostic *diagnostic;
+                        GLuint start;
+                        GLuint stop;
+                    };
+                public :
+                    /** Accumulated timings for one node of the profile */
+                    struct Timing
+                    {
+                        std::string name;
+                        /** depth in the profile; top level nodes are `0` */
+                        std::size_t depth{0u};
+                        std::size_t count{0u};
+                        int64_t cpuNanos{0LL};
+                        std::size_t gpuCount{0u};
+                        int64_t gpuNanos{0LL};
+                    };
                 public :
                     GLDiagnostics() NOTHROWS;
                     ~GLDiagnostics() NOTHROWS;
@@ -39,11 +69,46 @@ namespace TAK {
                     Util::TAKErr push(const char *name) NOTHROWS;
                     Util::TAKErr pop() NOTHROWS;
                     void reset()  NOTHROWS;
+                    /**
+                     * Returns the timings accumulated since the last `reset`,
+                     * depth first. Children of a node are ordered by name.
+                     */
+                    void getTimings(std::vector<Timing> &value) const NOTHROWS;
+                public :
+                    /**
+                     * Enables or disables GPU timing. When enabled, `push` and
+                     * `pop` also issue GPU timestamp queries via
+                     * `GL_EXT_disjoint_timer_query`; the GPU durations are
+                     * accumulated by `collectGpuTimings` once the results
+                     * become available, typically a few frames later. Has no
+                     * effect if the extension is not supported.
+                     */
+                    void setGpuTimingEnabled(const bool enabled) NOTHROWS;
+                    bool isGpuTimingEnabled() const NOTHROWS;
+                    /**
+                     * Accumulates the results of all completed GPU timings.
+                     * Results are discarded if the GPU reports a disjoint
+                     * operation. Must be invoked on the GL thread, typically
+                     * once per frame.
+                     */
+                    void collectGpuTimings() NOTHROWS;
+                    /**
+                     * Releases all GL query objects. Must be invoked on the GL
+                     * thread.
+                     */
+                    void release() NOTHROWS;
+                private :
+                    GLuint queryTimestamp() NOTHROWS;
+                    void recycleGpuTiming(const GpuTiming &timing) NOTHROWS;
                 private :
                     static void flushDiagnostics(GLGlobe &view, const Diagnostic &m, const std::size_t indent, const int64_t total) NOTHROWS;
                 private :
                     Diagnostic root;
                     std::vector<Diagnostic *> profile;
+                    bool gpuTimingEnabled;
+                    /** issued timings awaiting results, in issue order */
+                    std::deque<GpuTiming> gpuPending;
+                    std::vector<GLuint> gpuQueryPool;
 
                     int64_t targetMillisPerFrame;
                     int64_t timeCall;
@@ -53,6 +118,92 @@ namespace TAK {
                     int64_t count;
                     double currentFramerate;
                 };
+
+                /**
+                 * Fixed capacity history of per-frame statistics. Frames are
+                 * recorded on the GL thread via `beginFrame` and `endFrame`;
+                 * the history may be polled from any thread.
+                 */
+                class ENGINE_API GLFrameStatistics
+                {
+                public :
+                    struct Frame
+                    {
+                        /** frame number, starting at `1` */
+                        int64_t frame{0LL};
+                        /** system time at the start of the frame, in milliseconds */
+                        int64_t timestamp{0LL};
+                        /** CPU time spent preparing the scene and renderables */
+                        int64_t cpuPrepareNanos{0LL};
+                        /** CPU time spent issuing draw commands */
+                        int64_t cpuSubmitNanos{0LL};
+                        /**
+                         * GPU time for the frame; `-1` if GPU timing is not
+                         * supported or the result is not yet available
+                         */
+                        int64_t gpuNanos{-1LL};
+                        uint64_t drawCalls{0u};
+                        uint64_t triangles{0u};
+                        uint64_t textureUploadBytes{0u};
+                        uint64_t tileRequestsIssued{0u};
+                        uint64_t tileRequestsCompleted{0u};
+                        uint64_t labelsPlaced{0u};
+                    };
+                private :
+                    struct GpuTiming
+                    {
+                        int64_t frame;
+                        GLuint start;
+                        GLuint stop;
+                    };
+                public :
+                    GLFrameStatistics(const std::size_t capacity) NOTHROWS;
+                    ~GLFrameStatistics() NOTHROWS;
+                public :
+                    /**
+                     * Enables or disables recording. GPU time is measured via
+                     * `GL_EXT_disjoint_timer_query` timestamps when
+                     * supported; results typically lag by a few frames and
+                     * are filled into the history as they become available.
+                     */
+                    void setEnabled(const bool enabled) NOTHROWS;
+                    bool isEnabled() const NOTHROWS;
+                    /**
+                     * Must be invoked on the GL thread. The counter deltas
+                     * for the frame are taken from `counters`, which must be
+                     * the same instance passed to `endFrame`.
+                     */
+                    void beginFrame(const Util::PerformanceCounters &counters) NOTHROWS;
+                    /** Must be invoked on the GL thread. */
+                    void endFrame(const Util::PerformanceCounters &counters, const int64_t cpuPrepareNanos, const int64_t cpuSubmitNanos) NOTHROWS;
+                    /**
+                     * Appends the retained frames with a frame number greater
+                     * than `since`, oldest first.
+                     */
+                    Util::TAKErr getFrames(std::vector<Frame> &value, const int64_t since) const NOTHROWS;
+                    /**
+                     * Releases all GL query objects. Must be invoked on the GL
+                     * thread.
+                     */
+                    void release() NOTHROWS;
+                private :
+                    void collectGpuTimings() NOTHROWS;
+                    void recycleGpuTiming(const GpuTiming &timing) NOTHROWS;
+                private :
+                    /** guards `frames` and `frameCount` */
+                    mutable Thread::Mutex mutex;
+                    /** ring buffer, frame `n` is at index `(n-1)%frames.size()` */
+                    std::vector<Frame> frames;
+                    int64_t frameCount;
+                    std::atomic<bool> enabled;
+                    /** GL thread only */
+                    bool inFrame;
+                    Frame current;
+                    Util::PerformanceCountersSnapshot counters;
+                    GLuint gpuTimerStart;
+                    std::deque<GpuTiming> gpuPending;
+                    std::vector<GLuint> gpuQueryPool;
+                };
             }
         }
     }
@@ -1,5 +1,7 @@
 #include "renderer/core/GLDirtyRegion.h"
 
+#include <algorithm>
+
 #include "feature/SpatialCalculator2.h"
 
 using namespace TAK::Engine::Renderer::Core;
@@ -70,12 +72,29 @@ std::size_t GLDirtyRegion::size() const NOTHROWS
 }
 void GLDirtyRegion::compact() NOTHROWS
 {
-    if (empty())
-        return;
-    west.regions.clear();
-    west.regions.push_back(west.mbb);
-    east.regions.clear();
-    east.regions.push_back(east.mbb);
+    // an empty hemisphere has no valid MBB
+    if (!west.regions.empty()) {
+        west.regions.clear();
+        west.regions.push_back(west.mbb);
+    }
+    if (!east.regions.empty()) {
+        east.regions.clear();
+        east.regions.push_back(east.mbb);
+    }
+}
+void GLDirtyRegion::getRegions(std::vector<Envelope2> &value) const NOTHROWS
+{
+    value.reserve(value.size() + size());
+    // regions spanning the prime meridian are recorded in both hemispheres;
+    // report the portion in each
+    for (const auto &region : west.regions) {
+        value.push_back(region);
+        value.back().maxX = std::min(region.maxX, 0.0);
+    }
+    for (const auto &region : east.regions) {
+        value.push_back(region);
+        value.back().minX = std::max(region.minX, 0.0);
+    }
 }
 GLDirtyRegion& GLDirtyRegion::operator =(const GLDirtyRegion& other) NOTHROWS
 {
@@ -30,6 +30,11 @@ namespace TAK {
                     bool empty() const NOTHROWS;
                     std::size_t size() const NOTHROWS;
                     void compact() NOTHROWS;
+                    /**
+                     * Adds the regions to `value`. Regions spanning the prime
+                     * meridian are reported as one region per hemisphere.
+                     */
+                    void getRegions(std::vector<TAK::Engine::Feature::Envelope2> &value) const NOTHROWS;
                 public :
                     GLDirtyRegion& operator =(const GLDirtyRegion &other) NOTHROWS;
                 private :
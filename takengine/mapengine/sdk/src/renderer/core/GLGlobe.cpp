@@ -38,10 +38,12 @@
 #include "renderer/GLSLUtil.h"
 #include "renderer/GLWireframe.h"
 #include "renderer/GLWorkers.h"
+#include "renderer/QuadMeshIndices.h"
 #include "renderer/Shader.h"
 #include "renderer/core/GLAtmosphere.h"
 #include "renderer/core/GLGlobeSurfaceRenderer.h"
 #include "renderer/core/GLOffscreenVertex.h"
+#include "renderer/core/GLLayer2.h"
 #include "renderer/core/GLLayerFactory2.h"
 #include "renderer/core/GLLabelManager.h"
 #include "renderer/core/GLMapViewDebug.h"
@@ -51,6 +53,8 @@
 #include "util/ConfigOptions.h"
 #include "util/Memory.h"
 #include "util/MathUtils.h"
+#include "util/ScratchArena.h"
+#include "util/Trace.h"
 #include "util/Distance.h"
 #include "GLGlobe.h"
 
@@ -78,6 +82,8 @@ using namespace atakmap::renderer;
 #define DEFAULT_TILT_SKEW_MULT 4.0
 
 #define SAMPLER_SIZE 8u
+// number of frames retained by the frame statistics history
+#define FRAME_STATISTICS_CAPACITY 256u
 
 namespace {
 
@@ -134,8 +140,8 @@ namespace {
     {
     public :
         DebugTimer(const char *text, GLGlobe &view_, const bool enabled_) NOTHROWS:
-            start(Platform_systime_millis()),
             view(view_),
+            start(Platform_systime_millis()),
             enabled(enabled_)
         {
             if(enabled)
@@ -156,6 +162,36 @@ namespace {
         bool enabled;
     };
 
+    class ProfileScope
+    {
+    public :
+        ProfileScope(GLDiagnostics &profile_, const char *name, const bool enabled_) NOTHROWS :
+            profile(profile_),
+            enabled(enabled_ && (profile_.push(name) == TE_Ok))
+        {}
+        ~ProfileScope() NOTHROWS
+        {
+            if(enabled)
+                profile.pop();
+        }
+    private :
+        GLDiagnostics &profile;
+        bool enabled;
+    };
+
+    std::string getRenderPassName(const int renderPass) NOTHROWS
+    {
+        std::ostringstream strm;
+        strm << "Pass";
+        if(renderPass&GLGlobeBase::Surface) strm << " Surface";
+        if(renderPass&GLGlobeBase::Surface2) strm << " Surface2";
+        if(renderPass&GLGlobeBase::Sprites) strm << " Sprites";
+        if(renderPass&GLGlobeBase::Scenes) strm << " Scenes";
+        if(renderPass&GLGlobeBase::XRay) strm << " XRay";
+        if(renderPass&GLGlobeBase::UserInterface) strm << " UI";
+        return strm.str();
+    }
+
     GeoPoint2 getPoint(const AtakMapView &view) NOTHROWS
     {
         GeoPoint legacy;
@@ -263,13 +299,164 @@ namespace {
         {1.0f, 0.5f, 1.0f, 1.f},
     };
 
-    void bindTerrainTile(GLTerrainTile &gltile) NOTHROWS
+    /**
+     * Returns the shared IBO for the tile if its indices are the common
+     * heightmap grid topology, creating it on first use. Returns
+     * <code>GL_NONE</code> if the tile's indices are unique to it.
+     */
+    GLuint getSharedIbo(std::map<const QuadMeshIndices *, GLuint> &sharedIbos, const TerrainTile &tile) NOTHROWS
     {
-        GLuint bufs[2u];
-        glGenBuffers(2u, bufs);
+        if(!tile.heightmap || tile.posts_x < 2u || tile.posts_y < 2u)
+            return GL_NONE;
+        const TAK::Engine::Model::Mesh &mesh = *tile.data.value;
+        DataType indexType;
+        if(!mesh.isIndexed() || mesh.getIndexType(&indexType) != TE_Ok || indexType != TEDT_UInt16)
+            return GL_NONE;
+        const QuadMeshIndices *grid;
+        if(QuadMeshIndices_get(&grid, tile.posts_x-1u, tile.posts_y-1u, true) != TE_Ok)
+            return GL_NONE;
+        if(mesh.getNumIndices() != grid->numIndices || tile.skirtIndexOffset != grid->skirtOffset)
+            return GL_NONE;
+        // meshes transformed to another SRID carry a copy of the indices
+        const uint16_t *indices = reinterpret_cast<const uint16_t *>(static_cast<const uint8_t *>(mesh.getIndices()) + mesh.getIndexOffset());
+        if(indices != grid->indices && memcmp(indices, grid->indices, grid->numIndices*sizeof(uint16_t)))
+            return GL_NONE;
+
+        auto entry = sharedIbos.find(grid);
+        if(entry != sharedIbos.end())
+            return entry->second;
+
+        GLuint ibo = GL_NONE;
+        glGenBuffers(1u, &ibo);
+        if(!ibo)
+            return GL_NONE;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, grid->numIndices*sizeof(uint16_t), grid->indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
+        sharedIbos[grid] = ibo;
+        return ibo;
+    }
+
+    /**
+     * Uploads the quantized heights of the tile vertices as a texture and
+     * assigns the shared grid that the texture displaces. Returns
+     * <code>false</code> if the tile does not have compact positions.
+     */
+    bool bindHeightmap(GLTerrainTile &gltile, std::map<const QuadMeshIndices *, GLuint> &sharedGrids) NOTHROWS
+    {
+        const TerrainTile &tile = *gltile.tile;
+        const TAK::Engine::Model::Mesh &mesh = *tile.data.value;
+        const VertexDataLayout layout = mesh.getVertexDataLayout();
+        if(layout.position.type != TEDT_UInt16)
+            return false;
+        const void *buf = nullptr;
+        if(mesh.getVertices(&buf, TEVA_Position) != TE_Ok)
+            return false;
+        const QuadMeshIndices *grid;
+        if(QuadMeshIndices_get(&grid, tile.posts_x-1u, tile.posts_y-1u, true) != TE_Ok)
+            return false;
+
+        const uint8_t *positions = static_cast<const uint8_t *>(buf) + layout.position.offset;
+        const std::size_t numVertices = mesh.getNumVertices();
+        // one texel per vertex; skirt vertices follow the grid rows
+        const std::size_t width = tile.posts_x;
+        const std::size_t height = (numVertices + width - 1u) / width;
+
+        GLuint vbo = GL_NONE;
+        auto entry = sharedGrids.find(grid);
+        if(entry != sharedGrids.end()) {
+            vbo = entry->second;
+        } else {
+            // the grid XY is common to all tiles of the same dimensions;
+            // each vertex carries the heightmap texel it is displaced by
+            std::vector<uint16_t> gridVertices(numVertices*4u);
+            for(std::size_t i = 0u; i < numVertices; i++) {
+                const uint16_t *xyz = reinterpret_cast<const uint16_t *>(positions + (i*layout.position.stride));
+                gridVertices[i*4u] = xyz[0u];
+                gridVertices[i*4u+1u] = xyz[1u];
+                gridVertices[i*4u+2u] = static_cast<uint16_t>(i%width);
+                gridVertices[i*4u+3u] = static_cast<uint16_t>(i/width);
+            }
+            glGenBuffers(1u, &vbo);
+            if(!vbo)
+                return false;
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, gridVertices.size()*sizeof(uint16_t), gridVertices.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+            sharedGrids[grid] = vbo;
+        }
+
+        // heights are split over luminance (low byte) and alpha (high byte)
+        std::vector<uint8_t> heights(width*height*2u, 0u);
+        for(std::size_t i = 0u; i < numVertices; i++) {
+            const uint16_t z = reinterpret_cast<const uint16_t *>(positions + (i*layout.position.stride))[2u];
+            heights[i*2u] = static_cast<uint8_t>(z&0xFFu);
+            heights[i*2u+1u] = static_cast<uint8_t>(z>>8u);
+        }
 
+        GLuint tex = GL_NONE;
+        glGenTextures(1u, &tex);
+        if(!tex)
+            return false;
+        GLint boundTexture;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+        GLint unpackAlignment;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA, static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, heights.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+        glBindTexture(GL_TEXTURE_2D, boundTexture);
+
+        gltile.vbo = vbo;
+        gltile.heightmap = tex;
+        return true;
+    }
+
+    /**
+     * Drops a tile's reference on a shared buffer. Returns
+     * <code>true</code> if it was the last reference, in which case the
+     * buffer is removed from <code>shared</code> and should be deleted.
+     */
+    bool releaseSharedBuffer(std::map<const QuadMeshIndices *, GLuint> &shared, std::map<GLuint, std::size_t> &refs, const GLuint id) NOTHROWS
+    {
+        auto ref = refs.find(id);
+        if(ref == refs.end() || --ref->second)
+            return false;
+        refs.erase(ref);
+        for(auto it = shared.begin(); it != shared.end(); it++) {
+            if(it->second == id) {
+                shared.erase(it);
+                break;
+            }
+        }
+        return true;
+    }
+
+    void bindTerrainTile(GLTerrainTile &gltile, std::map<const QuadMeshIndices *, GLuint> &sharedIbos, std::map<const QuadMeshIndices *, GLuint> *sharedGrids, std::map<GLuint, std::size_t> &sharedRefs) NOTHROWS
+    {
         const TAK::Engine::Model::Mesh &mesh =  *gltile.tile->data.value;
 
+        // IBO
+        gltile.ibo = getSharedIbo(sharedIbos, *gltile.tile);
+        gltile.sharedIbo = !!gltile.ibo;
+        if(gltile.sharedIbo)
+            sharedRefs[gltile.ibo]++;
+
+        // heightmap tiles with the shared topology may upload only their
+        // heights, displacing the shared grid
+        if(gltile.sharedIbo && sharedGrids && bindHeightmap(gltile, *sharedGrids)) {
+            sharedRefs[gltile.vbo]++;
+            return;
+        }
+
+        GLuint bufs[2u];
+        glGenBuffers(2u, bufs);
+
         // VBO
         do {
             const void* buf = nullptr;
@@ -289,8 +476,7 @@ namespace {
             bufs[0u] = GL_NONE;
         } while(false);
 
-        // IBO
-        if(mesh.isIndexed()) {
+        if(mesh.isIndexed() && !gltile.sharedIbo) {
             do {
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufs[1u]);
                 DataType indexType;
@@ -317,18 +503,31 @@ namespace {
      * @param tile
      * @return
      */
+    bool cull(const MapSceneModel2 &scene, const Frustum2 &frustum, const int drawSrid, const bool handleIdlCrossing, const double drawLng, const TAK::Engine::Feature::Envelope2 &aabbWCS, const bool aabbIsect) NOTHROWS;
+
     bool cull(const MapSceneModel2 &scene, const Frustum2 &frustum, const int drawSrid, const bool handleIdlCrossing, const double drawLng, const TerrainTile &tile) NOTHROWS
     {
         TAK::Engine::Feature::Envelope2 aabbWCS(tile.aabb_wgs84);
         TAK::Engine::Feature::GeometryTransformer_transform(&aabbWCS, aabbWCS, 4326, drawSrid);
 
+        const bool aabbIsect =
+            frustum.intersects(AABB(Point2<double>(aabbWCS.minX, aabbWCS.minY, aabbWCS.minZ),
+                                    Point2<double>(aabbWCS.maxX, aabbWCS.maxY, aabbWCS.maxZ)));
+        return cull(scene, frustum, drawSrid, handleIdlCrossing, drawLng, aabbWCS, aabbIsect);
+    }
+
+    /**
+     * @param aabbWCS   The tile bounds, in the draw SRID
+     * @param aabbIsect The result of testing `aabbWCS` against `frustum`
+     */
+    bool cull(const MapSceneModel2 &scene, const Frustum2 &frustum, const int drawSrid, const bool handleIdlCrossing, const double drawLng, const TAK::Engine::Feature::Envelope2 &aabbWCS, const bool aabbIsect) NOTHROWS
+    {
         const bool isect =
-            (frustum.intersects(AABB(Point2<double>(aabbWCS.minX, aabbWCS.minY, aabbWCS.minZ),
-                                     Point2<double>(aabbWCS.maxX, aabbWCS.maxY, aabbWCS.maxZ))) ||
+            aabbIsect ||
             (handleIdlCrossing && drawLng * ((aabbWCS.minX + aabbWCS.maxX) / 2.0) < 0 &&
                 frustum.intersects(
                     AABB(Point2<double>(aabbWCS.minX - (360.0 * sgn((aabbWCS.minX + aabbWCS.maxX) / 2.0)), aabbWCS.minY, aabbWCS.minZ),
-                        Point2<double>(aabbWCS.maxX - (360.0 * sgn((aabbWCS.minX + aabbWCS.maxX) / 2.0)), aabbWCS.maxY, aabbWCS.maxZ)))));
+                        Point2<double>(aabbWCS.maxX - (360.0 * sgn((aabbWCS.minX + aabbWCS.maxX) / 2.0)), aabbWCS.maxY, aabbWCS.maxZ))));
 
         // does not intersect frustum
         if(!isect)
@@ -564,8 +763,34 @@ void GLGlobe::cullTerrainTiles_cpu() NOTHROWS
     m.set(offscreen.computeScene.camera.projection);
     m.concatenate(offscreen.computeScene.camera.modelView);
     Frustum2 frustum(m);
-    for (std::size_t i = 0u; i < offscreen.computeContext[read_idx].terrainTiles.size(); i++) {
-        if (!cull(offscreen.computeScene, frustum, srid, handleIdlCrossing, focus.longitude, *offscreen.computeContext[read_idx].terrainTiles[i])) {
+
+    // transform the tile bounds and test them against the frustum as a batch
+    const std::size_t numTiles = offscreen.computeContext[read_idx].terrainTiles.size();
+    std::vector<TAK::Engine::Feature::Envelope2> aabbsWCS;
+    aabbsWCS.reserve(numTiles);
+    std::vector<double> aabbsSoa(numTiles * 6u);
+    double *const minX = aabbsSoa.data();
+    double *const minY = minX + numTiles;
+    double *const minZ = minY + numTiles;
+    double *const maxX = minZ + numTiles;
+    double *const maxY = maxX + numTiles;
+    double *const maxZ = maxY + numTiles;
+    for (std::size_t i = 0u; i < numTiles; i++) {
+        TAK::Engine::Feature::Envelope2 aabbWCS(offscreen.computeContext[read_idx].terrainTiles[i]->aabb_wgs84);
+        TAK::Engine::Feature::GeometryTransformer_transform(&aabbWCS, aabbWCS, 4326, srid);
+        minX[i] = aabbWCS.minX;
+        minY[i] = aabbWCS.minY;
+        minZ[i] = aabbWCS.minZ;
+        maxX[i] = aabbWCS.maxX;
+        maxY[i] = aabbWCS.maxY;
+        maxZ[i] = aabbWCS.maxZ;
+        aabbsWCS.push_back(aabbWCS);
+    }
+    std::unique_ptr<bool[]> aabbIsect(new bool[numTiles]);
+    frustum.intersects(aabbIsect.get(), minX, minY, minZ, maxX, maxY, maxZ, numTiles);
+
+    for (std::size_t i = 0u; i < numTiles; i++) {
+        if (!cull(offscreen.computeScene, frustum, srid, handleIdlCrossing, focus.longitude, aabbsWCS[i], aabbIsect[i])) {
             const auto &tile = offscreen.computeContext[read_idx].terrainTiles[i];
             const intptr_t p = (intptr_t)(void*)tile.get();
             if (vis.find(p) == vis.end())
@@ -576,7 +801,7 @@ void GLGlobe::cullTerrainTiles_cpu() NOTHROWS
                 GLTerrainTile gltile;
                 gltile.tile = tile;
 
-                bindTerrainTile(gltile);
+                bindTerrainTile(gltile, offscreen.sharedIbos, offscreen.gpuHeightmap ? &offscreen.sharedGrids : nullptr, offscreen.sharedBufferRefs);
                 offscreen.visibleTiles.value.push_back(gltile);
                 offscreen.gltiles[tile.get()] = gltile;
             } else {
@@ -599,34 +824,35 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
     const std::size_t read_idx = offscreen.tileCullFboReadIdx % 2u;
     const std::size_t write_idx = (offscreen.tileCullFboReadIdx + 1u) % 2u;
 
-    GLOffscreenFramebuffer &fbo_r = offscreen.computeContext[read_idx].tileCullFbo;
-    GLOffscreenFramebuffer &fbo_w = offscreen.computeContext[write_idx].tileCullFbo;
+    GLOffscreenFramebufferPtr &fbo_r = offscreen.computeContext[read_idx].tileCullFbo;
+    GLOffscreenFramebufferPtr &fbo_w = offscreen.computeContext[write_idx].tileCullFbo;
     GLuint &pbo_r = offscreen.computeContext[read_idx].tileCullPbo;
     GLuint &pbo_w = offscreen.computeContext[write_idx].tileCullPbo;
 
     // ensure FBO is sufficiently large
-    if (fbo_w.handle && (fbo_w.textureWidth < render_width || fbo_w.textureHeight < render_height)) {
-        GLOffscreenFramebuffer_release(fbo_w);
+    if (fbo_w && (fbo_w->textureWidth < render_width || fbo_w->textureHeight < render_height)) {
+        fbo_w.reset();
         glDeleteBuffers(1u, &pbo_w);
         pbo_w = GL_NONE;
     }
 
     // initialize as necessary
-    if (!fbo_w.handle) {
+    if (!fbo_w) {
         GLOffscreenFramebuffer::Options fbo_opts;
         fbo_opts.colorFormat = GL_RGBA;
         fbo_opts.colorType = GL_UNSIGNED_BYTE;
 
-        GLOffscreenFramebuffer_create(&fbo_w, (int)render_width, (int)render_height, fbo_opts);
+        if (GLOffscreenFramebuffer_borrow(fbo_w, context, (int)render_width, (int)render_height, fbo_opts) != TE_Ok)
+            return;
 
         glGenBuffers(1u, &pbo_w);
         glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_w);
-        glBufferData(GL_PIXEL_PACK_BUFFER, fbo_w.textureWidth*fbo_w.textureHeight*sizeof(uint32_t), nullptr, GL_DYNAMIC_READ);
+        glBufferData(GL_PIXEL_PACK_BUFFER, fbo_w->textureWidth*fbo_w->textureHeight*sizeof(uint32_t), nullptr, GL_DYNAMIC_READ);
         glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
     }
 
-    fbo_w.width = (int)render_width;
-    fbo_w.height = (int)render_height;
+    fbo_w->width = (int)render_width;
+    fbo_w->height = (int)render_height;
 
     GLES20FixedPipeline::getInstance()->glMatrixMode(GLES20FixedPipeline::MatrixMode::MM_GL_PROJECTION);
     GLES20FixedPipeline::getInstance()->glOrthof(0.f, 0.f, (float)offscreen.computeScene.width, (float)offscreen.computeScene.height, (float)offscreen.computeScene.camera.near, (float)offscreen.computeScene.camera.far);
@@ -646,9 +872,9 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
     // clear to zero
     glClearColor(0.f, 0.f, 0.f, 0.f);
 
-    fbo_w.bind();
+    fbo_w->bind();
 
-    glViewport(0, 0, (GLsizei)fbo_w.width, (GLsizei)fbo_w.height);
+    glViewport(0, 0, (GLsizei)fbo_w->width, (GLsizei)fbo_w->height);
 
     glDisable(GL_BLEND);
 
@@ -715,7 +941,7 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
         GLTerrainTile &gltt = offscreen.gltiles[tile.get()];
         if(!gltt.tile) {
             gltt.tile = tile;
-            bindTerrainTile(gltt);
+            bindTerrainTile(gltt, offscreen.sharedIbos, offscreen.gpuHeightmap ? &offscreen.sharedGrids : nullptr, offscreen.sharedBufferRefs);
         }
         GLTerrainTile_drawTerrainTiles(ctx, lla2tex, &gltt, 1u, r, g, b, a);
         // mark visible
@@ -727,11 +953,11 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
     const std::vector<std::size_t> *visIndices = &offscreen.computeContext[write_idx].visIndices;
     bool confirmed = true;
 
-    if (fbo_r.handle) { // read from the back buffer
+    if (fbo_r) { // read from the back buffer
         // read the pixels
         DebugTimer mb("Cull [map buffer]", *this, diagnosticMessagesEnabled);
         glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_r);
-        const uint32_t *rgba = (const uint32_t *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t)*(fbo_r.textureWidth*fbo_r.height), GL_MAP_READ_BIT);
+        const uint32_t *rgba = (const uint32_t *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t)*(fbo_r->textureWidth*fbo_r->height), GL_MAP_READ_BIT);
         mb.stop();
         if (rgba) {
             DebugTimer pt("Cull [process texture]", *this, diagnosticMessagesEnabled);
@@ -744,14 +970,14 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
             memset(visb+idReservedOff, 0u, idReserved*sizeof(uint32_t));
 
             // scan the readback buffer and toggle indices that are present (offset by one)
-            const std::size_t readbackLimit = (fbo_r.width*fbo_r.height);
+            const std::size_t readbackLimit = (fbo_r->width*fbo_r->height);
             // compute the maximum number of pixels that can be processed per
             // pass -- this is the amount of room in our process buffer, minus
             // the section reserved for IDs
             const std::size_t maxProcessPerPass = std::min((std::size_t)PROCESS_BUF_SIZE-idReserved, readbackLimit);
             // number of pixels remaining to be processed
             std::size_t rem = readbackLimit;
-            if(fbo_r.width == fbo_r.textureWidth) {
+            if(fbo_r->width == fbo_r->textureWidth) {
                 while (rem) {
                     // compute the number of pixels to be processed this pass
                     const std::size_t processThisPass = std::min(maxProcessPerPass, rem);
@@ -768,21 +994,21 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
                     }
                 }
             } else {
-                const std::size_t numScansPerProcess = (maxProcessPerPass/fbo_r.textureWidth);
-                while (rem > fbo_r.textureWidth) {
+                const std::size_t numScansPerProcess = (maxProcessPerPass/fbo_r->textureWidth);
+                while (rem > fbo_r->textureWidth) {
                     // compute the number of pixels to be processed this pass
                     const std::size_t numScansThisPass = std::min(
                             numScansPerProcess,
-                            (rem/fbo_r.textureWidth));
+                            (rem/fbo_r->textureWidth));
                     // copy scans from the pixel buffer into the process buffer
                     for(std::size_t i = 0u; i < numScansThisPass; i++) {
-                        memcpy(visb+(fbo_r.width*i), rgba, fbo_r.width*sizeof(uint32_t));
-                        rgba += fbo_r.textureWidth;
+                        memcpy(visb+(fbo_r->width*i), rgba, fbo_r->width*sizeof(uint32_t));
+                        rgba += fbo_r->textureWidth;
                     }
                     // bump the pixel buffer pointer; update the remaining count
-                    rem -= (numScansThisPass*fbo_r.width);
+                    rem -= (numScansThisPass*fbo_r->width);
                     // process the pixels for this pass
-                    const std::size_t processThisPass = numScansThisPass*fbo_r.width;
+                    const std::size_t processThisPass = numScansThisPass*fbo_r->width;
                     for (std::size_t i = 0u; i < processThisPass; i++) {
                         const auto id = visb[i];
                         // toggle the ID in the reserved section
@@ -802,7 +1028,7 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
             }
             pt.stop();
             DebugTimer vi("Cull [compute visindices]", *this, diagnosticMessagesEnabled);
-            std::vector<std::size_t> visResolved;
+            std::vector<std::size_t, ScratchAllocator<std::size_t>> visResolved{ScratchAllocator<std::size_t>(getFrameArena())};
             visResolved.reserve(idReserved-1u);
             // iterate the ID section and update the front, omitting ID 0
             for(std::size_t i = 1u; i < idReserved; i++) {
@@ -858,7 +1084,7 @@ void GLGlobe::cullTerrainTiles_pbo() NOTHROWS
     DebugTimer rp("Cull [read pixels]", *this, diagnosticMessagesEnabled);
     glReadBuffer(GL_COLOR_ATTACHMENT0);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_w);
-    glReadPixels(0, 0, fbo_w.textureWidth, fbo_w.textureHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glReadPixels(0, 0, fbo_w->textureWidth, fbo_w->textureHeight, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
     glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
     rp.stop();
 
@@ -889,7 +1115,7 @@ void GLGlobe::setVisibleTerrainTiles(const std::size_t* visIndices, const std::s
             GLTerrainTile gltile;
             gltile.tile = offscreen.computeContext[read_idx].terrainTiles[visidx];
 
-            bindTerrainTile(gltile);
+            bindTerrainTile(gltile, offscreen.sharedIbos, offscreen.gpuHeightmap ? &offscreen.sharedGrids : nullptr, offscreen.sharedBufferRefs);
             offscreen.visibleTiles.value.push_back(gltile);
             offscreen.gltiles[offscreen.computeContext[read_idx].terrainTiles[visidx].get()] = gltile;
         } else {
@@ -903,16 +1129,38 @@ void GLGlobe::setVisibleTerrainTiles(const std::size_t* visIndices, const std::s
     offscreen.computeContext[read_idx].processed = true;
 }
 
+class GLGlobe::SurfaceControlImpl : public Controls::SurfaceRendererControl
+{
+public :
+    SurfaceControlImpl(GLGlobe &owner) NOTHROWS;
+public :
+    void markDirty() NOTHROWS override;
+    void markDirty(const Feature::Envelope2 region, const bool streaming) NOTHROWS override;
+    TAKErr enableDrawMode(const DrawMode mode) NOTHROWS override;
+    TAKErr disableDrawMode(const DrawMode mode) NOTHROWS override;
+    bool isDrawModeEnabled(const DrawMode mode) const NOTHROWS override;
+    TAKErr setColor(const DrawMode drawMode, const unsigned int color, const ColorControl::Mode colorMode) NOTHROWS override;
+    unsigned int getColor(const DrawMode mode) const NOTHROWS override;
+    TAKErr getColorMode(ColorControl::Mode *value, const DrawMode mode) const NOTHROWS override;
+    TAKErr setCameraCollisionRadius(double radius) NOTHROWS override;
+    double getCameraCollisionRadius() const NOTHROWS override;
+    TAKErr getSurfaceBounds(Collection<Feature::Envelope2> &value) const NOTHROWS override;
+    void setMinimumRefreshInterval(const int64_t millis) NOTHROWS override;
+    int64_t getMinimumRefreshInterval() const NOTHROWS override;
+private :
+    GLGlobe &owner;
+    double collisionRadius;
+};
+
 GLGlobe::GLGlobe(RenderContext &ctx, AtakMapView &aview,
                        int left, int bottom,
                        int right, int top) NOTHROWS :
     GLGlobeBase(ctx, aview.getDisplayDpi(), MapCamera2::Perspective),
-    terrain(new ElMgrTerrainRenderService(ctx), Memory_deleter_const<TerrainRenderService, ElMgrTerrainRenderService>),
-    view(aview),
-    enableMultiPassRendering(true),
-    debugDrawBounds(false),
     numRenderPasses(0u),
     terrainBlendFactor(1.0f),
+    enableMultiPassRendering(true),
+    debugDrawBounds(false),
+    terrain(new ElMgrTerrainRenderService(ctx), Memory_deleter_const<TerrainRenderService, ElMgrTerrainRenderService>),
     debugDrawOffscreen(false),
     dbgdrawflags(4),
     debugDrawMesh(false),
@@ -920,8 +1168,12 @@ GLGlobe::GLGlobe(RenderContext &ctx, AtakMapView &aview,
     suspendMeshFetch(false),
     tiltSkewOffset(DEFAULT_TILT_SKEW_OFFSET),
     tiltSkewMult(DEFAULT_TILT_SKEW_MULT),
+    inRenderPump(false),
     diagnosticMessagesEnabled(false),
-    inRenderPump(false)
+    renderProfilingEnabled(false),
+    frameStatistics(FRAME_STATISTICS_CAPACITY),
+    performanceCounters(std::make_shared<PerformanceCounters>()),
+    view(aview)
 {
     elevationScaleFactor = aview.getElevationExaggerationFactor();
 
@@ -1005,6 +1257,7 @@ GLGlobe::GLGlobe(RenderContext &ctx, AtakMapView &aview,
     state.height = (renderPasses[0].top-renderPasses[0].bottom);
 
     this->diagnosticMessagesEnabled = !!ConfigOptions_getIntOptionOrDefault("glmapview.render-diagnostics", 0);
+    this->renderProfile.setGpuTimingEnabled(this->diagnosticMessagesEnabled);
 #ifdef __ANDROID__
     this->gpuTerrainIntersect = !!ConfigOptions_getIntOptionOrDefault("glmapview.surface-rendering-v2", 0);
 #else
@@ -1012,6 +1265,9 @@ GLGlobe::GLGlobe(RenderContext &ctx, AtakMapView &aview,
 #endif
 
     surfaceRenderer.reset(new GLGlobeSurfaceRenderer(*this));
+    surfaceControl.reset(new SurfaceControlImpl(*this));
+    if (ConfigOptions_getIntOptionOrDefault("glglobe.terrain-occlusion", 1))
+        terrainOcclusion.reset(new GLTerrainOcclusion(ctx));
 
     MeshColor triangles; triangles.mode = TEDM_Triangles; triangles.enabled = true;
     MeshColor lines; lines.mode = TEDM_Lines; lines.enabled = false;
@@ -1089,6 +1345,40 @@ bool GLGlobe::isRenderDiagnosticsEnabled() const NOTHROWS
 void GLGlobe::setRenderDiagnosticsEnabled(const bool enabled) NOTHROWS
 {
     diagnosticMessagesEnabled = enabled;
+    renderProfile.setGpuTimingEnabled(isProfiling());
+}
+void GLGlobe::setRenderProfilingEnabled(const bool enabled) NOTHROWS
+{
+    renderProfilingEnabled = enabled;
+    renderProfile.setGpuTimingEnabled(isProfiling());
+}
+bool GLGlobe::isRenderProfilingEnabled() const NOTHROWS
+{
+    return renderProfilingEnabled;
+}
+void GLGlobe::getRenderProfile(std::vector<GLDiagnostics::Timing> &value) const NOTHROWS
+{
+    renderProfile.getTimings(value);
+}
+void GLGlobe::resetRenderProfile() NOTHROWS
+{
+    renderProfile.reset();
+}
+void GLGlobe::setFrameStatisticsEnabled(const bool enabled) NOTHROWS
+{
+    frameStatistics.setEnabled(enabled);
+}
+bool GLGlobe::isFrameStatisticsEnabled() const NOTHROWS
+{
+    return frameStatistics.isEnabled();
+}
+TAKErr GLGlobe::getFrameStatistics(std::vector<GLFrameStatistics::Frame> &value, const int64_t since) const NOTHROWS
+{
+    return frameStatistics.getFrames(value, since);
+}
+bool GLGlobe::isProfiling() const NOTHROWS
+{
+    return diagnosticMessagesEnabled || renderProfilingEnabled;
 }
 void GLGlobe::addRenderDiagnosticMessage(const char *msg) NOTHROWS
 {
@@ -1121,6 +1411,9 @@ void GLGlobe::initOffscreenShaders() NOTHROWS
     offscreen.ecef.depth = GLTerrainTile_getDepthShader(this->context, 4978);
     offscreen.planar.color = GLTerrainTile_getColorShader(this->context, 4326);
     offscreen.planar.depth = GLTerrainTile_getDepthShader(this->context, 4326);
+
+    // heightmap displacement is available if the shaders support it
+    offscreen.gpuHeightmap = offscreen.ecef.color.heightmap.lo.base.handle && offscreen.planar.color.heightmap.hi.base.handle;
 }
 void GLGlobe::mapMoved(atakmap::core::AtakMapView* map_view, bool animate)
 {
@@ -1187,9 +1480,17 @@ void GLGlobe::glElevationExaggerationFactorChanged(void *opaque) NOTHROWS
 
 void GLGlobe::render() NOTHROWS
 {
+    TE_TRACE_SCOPE("frame", "GLGlobe::render");
+    // activity on the render thread during the pump is charged to this globe
+    PerformanceCountersScope countersScope(performanceCounters);
     const int64_t tick = Platform_systime_millis();
     this->renderPasses[0].renderPump++;
+    // results are typically available a few frames after issue
+    if (isProfiling())
+        renderProfile.collectGpuTimings();
+    frameStatistics.beginFrame(*performanceCounters);
     GLGlobeBase::render();
+    frameStatistics.endFrame(*performanceCounters, frameTiming.prepareNanos, frameTiming.submitNanos);
     const int64_t renderPumpElapsed = Platform_systime_millis()-tick;
 
     if (diagnosticMessagesEnabled) {
@@ -1229,6 +1530,10 @@ void GLGlobe::render() NOTHROWS
             addRenderDiagnosticMessage(gldbgGenerateReport());
         }
 #endif
+        // per pass and per renderable timings; GPU timings lag by the
+        // latency of the queries
+        renderProfile.flush(*this);
+        renderProfile.reset();
         GLText2 *text = GLText2_intern(TextFormatParams(14));
         if (text) {
             TextFormat2 &fmt = text->getTextFormat();
@@ -1251,10 +1556,23 @@ void GLGlobe::release() NOTHROWS
 {
     GLGlobeBase::release();
     surfaceRenderer->release();
+    renderProfile.release();
+    frameStatistics.release();
+    if (terrainOcclusion)
+        terrainOcclusion->release();
+    // return the tile cull targets to the pool
+    for (std::size_t i = 0u; i < 2u; i++) {
+        offscreen.computeContext[i].tileCullFbo.reset();
+        if (offscreen.computeContext[i].tileCullPbo) {
+            glDeleteBuffers(1u, &offscreen.computeContext[i].tileCullPbo);
+            offscreen.computeContext[i].tileCullPbo = GL_NONE;
+        }
+    }
 }
 
 void GLGlobe::prepareScene() NOTHROWS
 {
+    TE_TRACE_SCOPE("frame", "GLGlobe::prepareScene");
     GLGlobeBase::prepareScene();
 
     GLES20FixedPipeline *fixedPipe = GLES20FixedPipeline::getInstance();
@@ -1282,6 +1600,10 @@ int GLGlobe::getTerrainVersion() const NOTHROWS
 
     return 0;
 }
+std::shared_ptr<const TerrainOcclusion> GLGlobe::getTerrainOcclusion() const NOTHROWS
+{
+    return terrainOcclusion ? terrainOcclusion->get() : std::shared_ptr<const TerrainOcclusion>();
+}
 
 TAKErr GLGlobe::visitTerrainTiles(TAKErr(*visitor)(void *opaque, const std::shared_ptr<const TerrainTile> &tile) NOTHROWS, void *opaque) NOTHROWS
 {
@@ -1301,6 +1623,10 @@ GLGlobeSurfaceRenderer& GLGlobe::getSurfaceRenderer() const NOTHROWS
 {
     return *surfaceRenderer;
 }
+Controls::SurfaceRendererControl* GLGlobe::getSurfaceRendererControl() const NOTHROWS
+{
+    return surfaceControl.get();
+}
 TAKErr GLGlobe::getSurfaceBounds(Port::Collection<Feature::Envelope2> &value) const NOTHROWS
 {
     if(!context.isRenderThread())
@@ -1324,6 +1650,7 @@ void GLGlobe::setAtmosphereEnabled(const bool enabled) NOTHROWS
 }
 void GLGlobe::drawRenderables() NOTHROWS
 {
+    TE_TRACE_SCOPE("frame", "GLGlobe::drawRenderables");
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     this->numRenderPasses = 0u;
@@ -1404,9 +1731,18 @@ void GLGlobe::drawRenderables() NOTHROWS
 
     // update the surface
     DebugTimer sru_timer("Surface Update", *this, diagnosticMessagesEnabled);
-    surfaceRenderer->update(5LL);
+    {
+        ProfileScope scope(renderProfile, "Surface Update", isProfiling());
+        surfaceRenderer->update(5LL);
+    }
     sru_timer.stop();
 
+    // capture the terrain depth for occlusion culling by the scene passes
+    if (terrainOcclusion) {
+        ProfileScope scope(renderProfile, "Terrain Occlusion", isProfiling());
+        terrainOcclusion->update(renderPasses[0u].scene, offscreen.visibleTiles.value.data(), offscreen.visibleTiles.value.size(), offscreen.lastVersion.terrain, (float)elevationScaleFactor);
+    }
+
     // record depth state before rendering skybox
     GLint depthFunc;
     glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
@@ -1445,6 +1781,7 @@ void GLGlobe::drawRenderables() NOTHROWS
 
         {
             DebugTimer terrainDepth_timer("Render Terrain", *this, diagnosticMessagesEnabled);
+            ProfileScope scope(renderProfile, "Render Terrain", isProfiling());
             // XXX - implement points drawing
             if(offscreen.debugFrustum.enabled) {
                 drawTerrainMeshes();
@@ -1488,8 +1825,10 @@ void GLGlobe::drawRenderables() NOTHROWS
     onscreenPasses_timer.stop();
 
     DebugTimer labels_timer("Labels", *this, diagnosticMessagesEnabled);
-    if (getLabelManager())
+    if (getLabelManager()) {
+        ProfileScope scope(renderProfile, "Labels", isProfiling());
         getLabelManager()->draw(*this, RenderPass::Sprites);
+    }
     labels_timer.stop();
 
     DebugTimer uipass_timer("UI Pass", *this, diagnosticMessagesEnabled);
@@ -1516,12 +1855,27 @@ void GLGlobe::drawRenderables(const GLGlobe::State &renderState) NOTHROWS
     this->renderPass = &renderState;
     this->idlHelper.update(*this);
 
-    GLGlobeBase::drawRenderables(renderState);
+    {
+        ProfileScope scope(renderProfile, isProfiling() ? getRenderPassName(renderState.renderPass).c_str() : nullptr, isProfiling());
+        GLGlobeBase::drawRenderables(renderState);
+    }
 
     // restore the view state
     this->renderPass = renderPasses;
     this->idlHelper.update(*this);
 }
+void GLGlobe::drawRenderable(GLMapRenderable2 &renderable, const int renderPass) NOTHROWS
+{
+    if (!isProfiling()) {
+        GLGlobeBase::drawRenderable(renderable, renderPass);
+        return;
+    }
+
+    const auto layer = dynamic_cast<GLLayer2 *>(&renderable);
+    const char *name = layer ? layer->getSubject().getName() : nullptr;
+    ProfileScope scope(renderProfile, name ? name : "Renderable", true);
+    GLGlobeBase::drawRenderable(renderable, renderPass);
+}
 void GLGlobe::drawTerrainTiles(const GLTexture2 &tex, const std::size_t drawSurfaceWidth, const std::size_t drawSurfaceHeight) NOTHROWS
 {
     TerrainTileShaders *shaders = 
@@ -1721,8 +2075,9 @@ bool GLGlobe::animate() NOTHROWS {
 
     DebugTimer te_timer("Terrain Update", *this, diagnosticMessagesEnabled);
     if (terrainUpdate) {
-        std::list<std::shared_ptr<const TerrainTile>> terrainTiles;
-        STLListAdapter<std::shared_ptr<const TerrainTile>> tta(terrainTiles);
+        typedef ScratchAllocator<std::shared_ptr<const TerrainTile>> TileAllocator;
+        std::list<std::shared_ptr<const TerrainTile>, TileAllocator> terrainTiles{TileAllocator(getFrameArena())};
+        STLListAdapter<std::shared_ptr<const TerrainTile>, TileAllocator> tta(terrainTiles);
         const int terrainTilesVersion = terrain->getTerrainVersion();
 
         // lock terrain using target of animation
@@ -1750,7 +2105,7 @@ bool GLGlobe::animate() NOTHROWS {
 
             this->offscreen.computeContext[terrain_write_idx].terrainTiles.clear();
             this->offscreen.computeContext[terrain_write_idx].terrainTiles.reserve(terrainTiles.size());
-            for (const auto tile : terrainTiles) {
+            for (const auto &tile : terrainTiles) {
                 this->offscreen.computeContext[terrain_write_idx].terrainTiles.push_back(tile);
                 staleTiles.erase(tile.get());
             }
@@ -1769,18 +2124,26 @@ bool GLGlobe::animate() NOTHROWS {
         }
 
         // evict all stale tiles
-        std::vector<GLuint> ids;
+        std::vector<GLuint, ScratchAllocator<GLuint>> ids{ScratchAllocator<GLuint>(getFrameArena())};
         ids.reserve(staleTiles.size()*2u);
+        std::vector<GLuint, ScratchAllocator<GLuint>> texids{ScratchAllocator<GLuint>(getFrameArena())};
         for(auto it = staleTiles.begin(); it != staleTiles.end(); it++) {
             offscreen.gltiles.erase(it->first);
-            if(it->second.vbo)
+            if(it->second.heightmap) {
+                texids.push_back(it->second.heightmap);
+                if(releaseSharedBuffer(offscreen.sharedGrids, offscreen.sharedBufferRefs, it->second.vbo))
+                    ids.push_back(it->second.vbo);
+            } else if(it->second.vbo) {
                 ids.push_back(it->second.vbo);
-            if(it->second.ibo)
+            }
+            if(it->second.ibo && (!it->second.sharedIbo || releaseSharedBuffer(offscreen.sharedIbos, offscreen.sharedBufferRefs, it->second.ibo)))
                 ids.push_back(it->second.ibo);
         }
 
         if(ids.size())
             glDeleteBuffers((GLsizei)ids.size(), &ids.at(0));
+        if(texids.size())
+            glDeleteTextures((GLsizei)texids.size(), &texids.at(0));
 
         // terrain updated, mark dirty
         offscreen.computeContext[terrain_write_idx].processed = false;
@@ -1977,11 +2340,14 @@ TAKErr GLGlobe::inverse(MapRenderer::InverseResult *result, GeoPoint2 *value, co
     if(!value)
         return TE_InvalidArg;
     Point2<double> xyz(screen);
-    MapSceneModel2 sm;
-    {
+    // the scene as of the last published frame; no copy required
+    const std::shared_ptr<const State> published(getRenderState());
+    MapSceneModel2 unpublished;
+    if (!published) {
         ReadLock rlock(renderPasses0Mutex);
-        sm = renderPasses[0].scene;
+        unpublished = renderPasses[0].scene;
     }
+    const MapSceneModel2 &sm = published ? published->scene : unpublished;
     if(origin == MapRenderer::UpperLeft)
         xyz.y = (sm.height - xyz.y);
     switch(mode) {
@@ -2327,6 +2693,71 @@ ColorControl::Mode GLGlobe::getColorMode(const TAK::Engine::Model::DrawMode mode
     return ColorControl::Modulate;
 }
 
+GLGlobe::SurfaceControlImpl::SurfaceControlImpl(GLGlobe &owner_) NOTHROWS :
+    owner(owner_),
+    collisionRadius(0.0)
+{}
+void GLGlobe::SurfaceControlImpl::markDirty() NOTHROWS
+{
+    owner.surfaceRenderer->markDirty();
+}
+void GLGlobe::SurfaceControlImpl::markDirty(const Feature::Envelope2 region, const bool streaming) NOTHROWS
+{
+    owner.surfaceRenderer->markDirty(region, streaming);
+}
+TAKErr GLGlobe::SurfaceControlImpl::enableDrawMode(const DrawMode mode) NOTHROWS
+{
+    owner.enableDrawMode(mode);
+    return TE_Ok;
+}
+TAKErr GLGlobe::SurfaceControlImpl::disableDrawMode(const DrawMode mode) NOTHROWS
+{
+    owner.disableDrawMode(mode);
+    return TE_Ok;
+}
+bool GLGlobe::SurfaceControlImpl::isDrawModeEnabled(const DrawMode mode) const NOTHROWS
+{
+    return owner.isDrawModeEnabled(mode);
+}
+TAKErr GLGlobe::SurfaceControlImpl::setColor(const DrawMode drawMode, const unsigned int color, const ColorControl::Mode colorMode) NOTHROWS
+{
+    owner.setColor(drawMode, color, colorMode);
+    return TE_Ok;
+}
+unsigned int GLGlobe::SurfaceControlImpl::getColor(const DrawMode mode) const NOTHROWS
+{
+    return owner.getColor(mode);
+}
+TAKErr GLGlobe::SurfaceControlImpl::getColorMode(ColorControl::Mode *value, const DrawMode mode) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    *value = owner.getColorMode(mode);
+    return TE_Ok;
+}
+TAKErr GLGlobe::SurfaceControlImpl::setCameraCollisionRadius(double radius) NOTHROWS
+{
+    // XXX - recorded only; collision is specified per camera operation
+    collisionRadius = radius;
+    return TE_Ok;
+}
+double GLGlobe::SurfaceControlImpl::getCameraCollisionRadius() const NOTHROWS
+{
+    return collisionRadius;
+}
+TAKErr GLGlobe::SurfaceControlImpl::getSurfaceBounds(Collection<Feature::Envelope2> &value) const NOTHROWS
+{
+    return owner.getSurfaceBounds(value);
+}
+void GLGlobe::SurfaceControlImpl::setMinimumRefreshInterval(const int64_t millis) NOTHROWS
+{
+    owner.surfaceRenderer->setMinimumRefreshInterval(millis > 0LL ? (std::size_t)millis : 0u);
+}
+int64_t GLGlobe::SurfaceControlImpl::getMinimumRefreshInterval() const NOTHROWS
+{
+    return (int64_t)owner.surfaceRenderer->getMinimumRefreshInterval();
+}
+
 double GLGlobe::getRecommendedGridSampleDistance() NOTHROWS
 {
     return recommendedGridSampleDistance;
@@ -2969,10 +3400,10 @@ namespace
         // render offscreen texture
         const VertexDataLayout &layout = tile.data.value->getVertexDataLayout();
 
-        if(gltile.vbo) {
+        if(gltile.vbo && !gltile.heightmap) {
             // VBO
             glBindBuffer(GL_ARRAY_BUFFER, gltile.vbo);
-            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GL_FLOAT, false, static_cast<GLsizei>(layout.position.stride), (void *)layout.position.offset);
+            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GLTerrainTile_getPositionType(tile), false, static_cast<GLsizei>(layout.position.stride), (void *)layout.position.offset);
             glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
         } else {
             const void *vertexCoords;
@@ -2982,7 +3413,7 @@ namespace
                 return;
             }
 
-            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GL_FLOAT, false, static_cast<GLsizei>(layout.position.stride), static_cast<const uint8_t *>(vertexCoords) + layout.position.offset);
+            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GLTerrainTile_getPositionType(tile), false, static_cast<GLsizei>(layout.position.stride), static_cast<const uint8_t *>(vertexCoords) + layout.position.offset);
         }
 
         std::size_t numIndicesWireframe = 0u;
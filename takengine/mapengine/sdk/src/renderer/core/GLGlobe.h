@@ -18,9 +18,12 @@
 #include "model/VertexDataLayout.h"
 #include "port/Platform.h"
 #include "renderer/GLOffscreenFramebuffer.h"
+#include "renderer/QuadMeshIndices.h"
 #include "renderer/core/ColorControl.h"
 #include "renderer/core/GLAntiMeridianHelper.h"
+#include "renderer/core/GLDiagnostics.h"
 #include "renderer/core/GLGlobeBase.h"
+#include "renderer/core/GLTerrainOcclusion.h"
 #include "renderer/elevation/GLTerrainTile_decls.h"
 #include "renderer/elevation/TerrainRenderService.h"
 #include "thread/RWMutex.h"
@@ -43,6 +46,7 @@ namespace TAK {
                     public atakmap::core::MapControllerFocusPointChangedListener
                 {
                 private:
+                    class SurfaceControlImpl;
                     struct MeshColor
                     {
                         TAK::Engine::Model::DrawMode mode {TAK::Engine::Model::TEDM_Triangles};
@@ -90,6 +94,31 @@ namespace TAK {
                     void setRenderDiagnosticsEnabled(const bool enabled) NOTHROWS;
                     void addRenderDiagnosticMessage(const char *msg) NOTHROWS;
                     bool isContinuousScrollEnabled() const NOTHROWS;
+                    /**
+                     * Enables or disables recording of the per pass and per
+                     * renderable render profile, without the diagnostics
+                     * overlay. While enabled, timings accumulate across
+                     * frames until `resetRenderProfile` is invoked.
+                     */
+                    void setRenderProfilingEnabled(const bool enabled) NOTHROWS;
+                    bool isRenderProfilingEnabled() const NOTHROWS;
+                    /** Must be invoked on the render thread */
+                    void getRenderProfile(std::vector<GLDiagnostics::Timing> &value) const NOTHROWS;
+                    /** Must be invoked on the render thread */
+                    void resetRenderProfile() NOTHROWS;
+                    /**
+                     * Enables or disables recording of per frame statistics.
+                     * While enabled, the most recent frames are retained for
+                     * polling via `getFrameStatistics`.
+                     */
+                    void setFrameStatisticsEnabled(const bool enabled) NOTHROWS;
+                    bool isFrameStatisticsEnabled() const NOTHROWS;
+                    /**
+                     * Appends the retained frame statistics with a frame
+                     * number greater than `since`, oldest first. May be
+                     * invoked from any thread.
+                     */
+                    Util::TAKErr getFrameStatistics(std::vector<GLFrameStatistics::Frame> &value, const int64_t since) const NOTHROWS;
                 public: // MapMovedListener
                     void mapMoved(atakmap::core::AtakMapView *map_, const bool animate) override;
                 public: // MapProjectionChangedListener
@@ -126,6 +155,7 @@ namespace TAK {
                     /** renders the current scene */
                     virtual void drawRenderables() NOTHROWS override;
                     virtual void drawRenderables(const State &state) NOTHROWS override;
+                    virtual void drawRenderable(GLMapRenderable2 &renderable, const int renderPass) NOTHROWS override;
                 protected :
                     virtual bool animate() NOTHROWS override;
                 private :
@@ -139,6 +169,8 @@ namespace TAK {
 
                 public:
                     virtual int getTerrainVersion() const NOTHROWS override;
+                    virtual std::shared_ptr<const TerrainOcclusion> getTerrainOcclusion() const NOTHROWS override;
+                    virtual Controls::SurfaceRendererControl* getSurfaceRendererControl() const NOTHROWS override;
                     void updateTerrainMesh(Math::Statistics *meshStats) NOTHROWS;
                     Util::TAKErr visitTerrainTiles(Util::TAKErr(*visitor)(void *opaque, const std::shared_ptr<const Elevation::TerrainTile> &tile) NOTHROWS, void *opaque) NOTHROWS;
                     GLGlobeSurfaceRenderer& getSurfaceRenderer() const NOTHROWS;
@@ -190,7 +222,7 @@ namespace TAK {
                         int64_t lastElevationQuery{ 0LL };
 
                         struct {
-                            TAK::Engine::Renderer::GLOffscreenFramebuffer tileCullFbo;
+                            TAK::Engine::Renderer::GLOffscreenFramebufferPtr tileCullFbo { nullptr, nullptr };
                             GLuint tileCullPbo { GL_NONE };
                             std::vector<std::shared_ptr<const TAK::Engine::Renderer::Elevation::TerrainTile>> terrainTiles;
                             std::vector<std::size_t> visIndices;
@@ -205,6 +237,14 @@ namespace TAK {
                             std::vector<intptr_t> lastConfirmed;
                         } visibleTiles;
                         std::unordered_map<const TAK::Engine::Renderer::Elevation::TerrainTile *, TAK::Engine::Renderer::Elevation::GLTerrainTile> gltiles;
+                        /** IBOs shared by all tiles with the same grid topology, see `QuadMeshIndices_get` */
+                        std::map<const TAK::Engine::Renderer::QuadMeshIndices *, GLuint> sharedIbos;
+                        /** grid VBOs for heightmap displacement, shared by all tiles with the same grid topology */
+                        std::map<const TAK::Engine::Renderer::QuadMeshIndices *, GLuint> sharedGrids;
+                        /** number of tiles in `gltiles` referencing each buffer in `sharedIbos` and `sharedGrids` */
+                        std::map<GLuint, std::size_t> sharedBufferRefs;
+                        /** if `true`, heightmap tiles are uploaded as textures that displace the shared grid */
+                        bool gpuHeightmap{ false };
                         TAK::Engine::Renderer::GLOffscreenFramebuffer depthSamplerFbo;
                         std::size_t tileCullFboReadIdx{ 0u };
                         Util::array_ptr<uint32_t> rgba;
@@ -237,12 +277,25 @@ namespace TAK {
                         bool enabled{true};
                     } atmosphere;
 
+                    /** @return `true` if the render profile is being recorded */
+                    bool isProfiling() const NOTHROWS;
+
                     bool gpuTerrainIntersect;
                     bool diagnosticMessagesEnabled;
                     std::vector<std::string> diagnosticMessages;
+                    /** CPU and GPU timings per render pass and renderable; only recorded while diagnostics or profiling are enabled */
+                    GLDiagnostics renderProfile;
+                    bool renderProfilingEnabled;
+                    GLFrameStatistics frameStatistics;
+                    /** draw, upload, tile and label activity attributed to this globe */
+                    std::shared_ptr<Util::PerformanceCounters> performanceCounters;
 
                     std::vector<MeshColor> meshDrawModes;
                     std::unique_ptr<GLGlobeSurfaceRenderer> surfaceRenderer;
+                    /** forwards surface invalidation from renderables to `surfaceRenderer` */
+                    std::unique_ptr<SurfaceControlImpl> surfaceControl;
+                    /** `nullptr` if `glglobe.terrain-occlusion` is disabled */
+                    std::unique_ptr<GLTerrainOcclusion> terrainOcclusion;
                 public :
                     atakmap::core::AtakMapView &view; //COVERED
                 private:
@@ -4,14 +4,21 @@
 
 #include "renderer/core/GLGlobeBase.h"
 
+#include <atomic>
+#include <chrono>
+
 #include "core/LegacyAdapters.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "renderer/GLOffscreenFramebuffer.h"
 #include "renderer/GLWorkers.h"
 #include "renderer/core/GLLabelManager.h"
 #include "renderer/core/GLLayer2.h"
 #include "renderer/core/GLMapRenderable2.h"
+#include "renderer/core/GLPreparable.h"
 #include "thread/Lock.h"
+#include "util/ConfigOptions.h"
 #include "util/Memory.h"
+#include "util/Tasking.h"
 
 using namespace TAK::Engine::Renderer::Core;
 
@@ -30,6 +37,12 @@ using namespace atakmap::renderer;
     (std::abs(v) <= _EPSILON)
 #define IS_TINYF(v) \
     (std::abs(v) <= _EPSILON_F)
+// per-frame time budgets for draining the GL workers; remaining work carries
+// over to the next frame
+#define RESOURCE_LOAD_BUDGET_MILLIS 30u
+#define GL_THREAD_WORK_BUDGET_MILLIS 8LL
+// maximum age, in milliseconds, of a cached frame before it is redrawn
+#define TE_GLGLOBEBASE_FRAME_CACHE_MAX_AGE 1000LL
 
 namespace {
     void asyncSetBaseMap(void *opaque) NOTHROWS;
@@ -37,6 +50,8 @@ namespace {
     bool hasSettled(double dlat, double dlng, double dscale, double drot, double dtilt, double dfocusX, double dfocusY) NOTHROWS;
     void State_save(GLGlobeBase::State *value, const GLGlobeBase& view) NOTHROWS;
     void validateAltitude(GeoPoint2 &geo) NOTHROWS;
+    TAKErr prepareTask(bool &value, GLPreparable *preparable, const std::shared_ptr<const GLGlobeBase::State> *state) NOTHROWS;
+    int64_t elapsedNanos(const std::chrono::steady_clock::time_point &start) NOTHROWS;
 }
 
 struct GLGlobeBase::AsyncRunnable
@@ -84,8 +99,125 @@ struct GLGlobeBase::AsyncRunnable
     {}
 };
 
+// forwards to the host context; refresh requests and queued events issued by
+// renderables through this context (or any child created from it) bump the
+// shared content version that validates the frame cache
+class GLGlobeBase::InvalidatingRenderContext : public RenderContext
+{
+private :
+    struct QueuedEvent
+    {
+        void(*runnable)(void *) NOTHROWS;
+        std::unique_ptr<void, void(*)(const void *)> opaque;
+        std::shared_ptr<std::atomic<unsigned int>> version;
+    };
+public :
+    InvalidatingRenderContext(RenderContext &impl_, const std::shared_ptr<std::atomic<unsigned int>> &version_) NOTHROWS :
+        impl(impl_),
+        owned(nullptr, nullptr),
+        version(version_)
+    {}
+    InvalidatingRenderContext(RenderContextPtr &&child_, const std::shared_ptr<std::atomic<unsigned int>> &version_) NOTHROWS :
+        impl(*child_),
+        owned(std::move(child_)),
+        version(version_)
+    {}
+    ~InvalidatingRenderContext() NOTHROWS override
+    {}
+public :
+    void invalidate() NOTHROWS
+    {
+        (*version)++;
+    }
+    unsigned int getVersion() const NOTHROWS
+    {
+        return version->load();
+    }
+public : // RenderContext
+    bool isRenderThread() const NOTHROWS override
+    {
+        return impl.isRenderThread();
+    }
+    TAKErr queueEvent(void(*runnable)(void *) NOTHROWS, std::unique_ptr<void, void(*)(const void *)> &&opaque) NOTHROWS override
+    {
+        invalidate();
+        // the event may mutate renderable state; invalidate again once it has
+        // run so that a frame captured in between is not reused
+        std::unique_ptr<void, void(*)(const void *)> event(new QueuedEvent{ runnable, std::move(opaque), version }, Memory_deleter_const<void, QueuedEvent>);
+        return impl.queueEvent(runQueuedEvent, std::move(event));
+    }
+    void requestRefresh() NOTHROWS override
+    {
+        invalidate();
+        impl.requestRefresh();
+    }
+    TAKErr setFrameRate(const float rate) NOTHROWS override
+    {
+        return impl.setFrameRate(rate);
+    }
+    float getFrameRate() const NOTHROWS override
+    {
+        return impl.getFrameRate();
+    }
+    void setContinuousRenderEnabled(const bool enabled) NOTHROWS override
+    {
+        impl.setContinuousRenderEnabled(enabled);
+    }
+    bool isContinuousRenderEnabled() NOTHROWS override
+    {
+        return impl.isContinuousRenderEnabled();
+    }
+    bool supportsChildContext() const NOTHROWS override
+    {
+        return impl.supportsChildContext();
+    }
+    TAKErr createChildContext(RenderContextPtr &value) NOTHROWS override
+    {
+        TAKErr code(TE_Ok);
+        RenderContextPtr child(nullptr, nullptr);
+        code = impl.createChildContext(child);
+        TE_CHECKRETURN_CODE(code);
+        if (!child)
+            return TE_IllegalState;
+        value = RenderContextPtr(new InvalidatingRenderContext(std::move(child), version), Memory_deleter_const<RenderContext, InvalidatingRenderContext>);
+        return code;
+    }
+    bool isAttached() const NOTHROWS override
+    {
+        return impl.isAttached();
+    }
+    bool attach() NOTHROWS override
+    {
+        return impl.attach();
+    }
+    bool detach() NOTHROWS override
+    {
+        return impl.detach();
+    }
+    bool isMainContext() const NOTHROWS override
+    {
+        return impl.isMainContext();
+    }
+    RenderSurface *getRenderSurface() const NOTHROWS override
+    {
+        return impl.getRenderSurface();
+    }
+private :
+    static void runQueuedEvent(void *opaque) NOTHROWS
+    {
+        auto &event = *static_cast<QueuedEvent *>(opaque);
+        event.runnable(event.opaque.get());
+        (*event.version)++;
+    }
+private :
+    RenderContext &impl;
+    RenderContextPtr owned;
+    std::shared_ptr<std::atomic<unsigned int>> version;
+};
+
 GLGlobeBase::GLGlobeBase(RenderContext &ctx, const double dpi, const MapCamera2::Mode mode) NOTHROWS :
-    context(ctx),
+    invalidatingContext(new InvalidatingRenderContext(ctx, std::make_shared<std::atomic<unsigned int>>(0u))),
+    context(*invalidatingContext),
     displayDpi(dpi),
     animationFactor(1.0),
     targeting(false),
@@ -112,6 +244,8 @@ GLGlobeBase::GLGlobeBase(RenderContext &ctx, const double dpi, const MapCamera2:
     state.height = (renderPasses[0].top-renderPasses[0].bottom);
 
     this->renderPass = this->renderPasses;
+
+    frameCache.enabled = !!ConfigOptions_getIntOptionOrDefault("glglobe.frame-cache", 0);
 }
 GLGlobeBase::~GLGlobeBase() NOTHROWS
 {
@@ -158,10 +292,201 @@ void GLGlobeBase::render() NOTHROWS
         glGetError();
     this->animationLastTick = tick;
 
+    // all frame allocations are released on exit
+    ScratchArenaScope frame(this->frameArena);
+
+    // idle pooled render targets age by frame
+    GLOffscreenFramebuffer_recyclePool(context);
+
+    const auto prepareStart = std::chrono::steady_clock::now();
+    frameTiming.prepareNanos = 0LL;
+    frameTiming.submitNanos = 0LL;
+
     this->prepareScene();
+    this->publishRenderState();
+    // when rendering on demand, every frame is the result of a refresh
+    // request and there is nothing to reuse
+    const bool cacheFrame = frameCache.enabled && context.isContinuousRenderEnabled();
+    if (!cacheFrame && frameCache.fbo)
+        releaseFrameCache();
+    if (cacheFrame && presentFrameCache()) {
+        frameTiming.prepareNanos = elapsedNanos(prepareStart);
+        return;
+    }
+
+    // capture the version prior to drawing; changes made while drawing
+    // invalidate the captured frame
+    const unsigned int version = invalidatingContext->getVersion();
+    this->prepareRenderables();
+    frameTiming.prepareNanos = elapsedNanos(prepareStart);
+
+    const auto submitStart = std::chrono::steady_clock::now();
     this->renderPass = &this->renderPasses[0];
     this->drawRenderables();
     this->renderPass = &this->renderPasses[0];
+    frameTiming.submitNanos = elapsedNanos(submitStart);
+
+    if (cacheFrame)
+        updateFrameCache(version);
+}
+void GLGlobeBase::prepareRenderables() NOTHROWS
+{
+    if (preparables.empty())
+        return;
+
+    // the published snapshot; the workers never observe the live state
+    const std::shared_ptr<const State> snapshot(getRenderState());
+
+    const SharedWorkerPtr &worker = GeneralWorkers_cpu();
+    if (!worker || preparables.size() == 1u) {
+        for (auto it = preparables.begin(); it != preparables.end(); it++)
+            (*it)->prepare(snapshot);
+        return;
+    }
+
+    std::vector<FutureTask<bool>> pending;
+    pending.reserve(preparables.size() - 1u);
+    for (std::size_t i = 1u; i < preparables.size(); i++)
+        pending.push_back(Task_begin(worker, prepareTask, preparables[i], &snapshot));
+    // the GL thread takes a share of the work rather than idling
+    preparables[0]->prepare(snapshot);
+    // `snapshot` must outlive all tasks
+    for (auto it = pending.begin(); it != pending.end(); it++) {
+        bool done;
+        TAKErr code;
+        it->await(done, code);
+    }
+}
+void GLGlobeBase::refreshPreparables() NOTHROWS
+{
+    preparables.clear();
+    if (basemap) {
+        if (auto preparable = dynamic_cast<GLPreparable *>(basemap.get()))
+            preparables.push_back(preparable);
+    }
+    for (auto it = renderables.begin(); it != renderables.end(); it++) {
+        if (auto preparable = dynamic_cast<GLPreparable *>(it->get()))
+            preparables.push_back(preparable);
+    }
+}
+void GLGlobeBase::setFrameCacheEnabled(const bool enabled) NOTHROWS
+{
+    frameCache.enabled = enabled;
+    frameCache.valid = false;
+}
+bool GLGlobeBase::isFrameCacheEnabled() const NOTHROWS
+{
+    return frameCache.enabled;
+}
+void GLGlobeBase::invalidate() const NOTHROWS
+{
+    invalidatingContext->invalidate();
+}
+bool GLGlobeBase::presentFrameCache() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    if (!frameCache.valid)
+        return false;
+    // any change in the draw parameters or content requires a redraw
+    if (!settled ||
+        frameCache.drawVersion != renderPasses[0].drawVersion ||
+        frameCache.terrainVersion != getTerrainVersion() ||
+        frameCache.contentVersion != invalidatingContext->getVersion() ||
+        frameCache.width != static_cast<GLsizei>(renderPasses[0].right - renderPasses[0].left) ||
+        frameCache.height != static_cast<GLsizei>(renderPasses[0].top - renderPasses[0].bottom)) {
+
+        frameCache.valid = false;
+        return false;
+    }
+    // periodically redraw to pick up changes from renderables that do not
+    // invalidate
+    if ((Platform_systime_millis() - frameCache.drawn) > TE_GLGLOBEBASE_FRAME_CACHE_MAX_AGE) {
+        frameCache.valid = false;
+        return false;
+    }
+
+    GLint readFbo = GL_NONE;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, frameCache.fbo);
+    glBlitFramebuffer(0, 0, frameCache.width, frameCache.height, 0, 0, frameCache.width, frameCache.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(readFbo));
+    return true;
+#else
+    return false;
+#endif
+}
+void GLGlobeBase::updateFrameCache(const unsigned int version) NOTHROWS
+{
+    frameCache.valid = false;
+#if TE_GLES_VERSION >= 3
+    // frames captured mid-animation are unlikely to be reused
+    if (!settled)
+        return;
+
+    const GLsizei width = static_cast<GLsizei>(renderPasses[0].right - renderPasses[0].left);
+    const GLsizei height = static_cast<GLsizei>(renderPasses[0].top - renderPasses[0].bottom);
+    if (width <= 0 || height <= 0)
+        return;
+
+    // cannot blit into a multisampled framebuffer
+    GLint samples = 0;
+    glGetIntegerv(GL_SAMPLES, &samples);
+    if (samples > 0)
+        return;
+
+    GLint drawFbo = GL_NONE;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+    GLint readFbo = GL_NONE;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFbo);
+
+    if (!frameCache.fbo)
+        glGenFramebuffers(1u, &frameCache.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frameCache.fbo);
+    if (!frameCache.color || frameCache.width != width || frameCache.height != height) {
+        if (frameCache.color)
+            glDeleteRenderbuffers(1u, &frameCache.color);
+        glGenRenderbuffers(1u, &frameCache.color);
+        glBindRenderbuffer(GL_RENDERBUFFER, frameCache.color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, GL_NONE);
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, frameCache.color);
+        frameCache.width = width;
+        frameCache.height = height;
+    }
+
+    const bool complete = (glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    if (complete) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(drawFbo));
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(drawFbo));
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(readFbo));
+
+    if (!complete) {
+        releaseFrameCache();
+        return;
+    }
+
+    frameCache.drawVersion = renderPasses[0].drawVersion;
+    frameCache.terrainVersion = getTerrainVersion();
+    frameCache.contentVersion = version;
+    frameCache.drawn = Platform_systime_millis();
+    frameCache.valid = true;
+#endif
+}
+void GLGlobeBase::releaseFrameCache() NOTHROWS
+{
+    if (frameCache.color) {
+        glDeleteRenderbuffers(1u, &frameCache.color);
+        frameCache.color = GL_NONE;
+    }
+    if (frameCache.fbo) {
+        glDeleteFramebuffers(1u, &frameCache.fbo);
+        frameCache.fbo = GL_NONE;
+    }
+    frameCache.width = 0;
+    frameCache.height = 0;
+    frameCache.valid = false;
 }
 void GLGlobeBase::setBaseMap(GLMapRenderable2Ptr &&map) NOTHROWS
 {
@@ -170,6 +495,8 @@ void GLGlobeBase::setBaseMap(GLMapRenderable2Ptr &&map) NOTHROWS
         context.queueEvent(asyncSetBaseMap, std::unique_ptr<void, void(*)(const void *)>(p.release(), Memory_leaker_const<void>));
     } else {
         basemap = std::move(map);
+        refreshPreparables();
+        invalidate();
     }
 }
 void GLGlobeBase::setLabelManager(GLLabelManager* labelMan) NOTHROWS
@@ -180,6 +507,7 @@ void GLGlobeBase::setLabelManager(GLLabelManager* labelMan) NOTHROWS
     }
     else {
         labelManager = std::move(labelMan);
+        invalidate();
     }
 }
 void GLGlobeBase::release() NOTHROWS
@@ -188,6 +516,7 @@ void GLGlobeBase::release() NOTHROWS
         (*it)->release();
     if(basemap)
         basemap->release();
+    releaseFrameCache();
 }
 void GLGlobeBase::prepareScene() NOTHROWS
 {
@@ -220,8 +549,8 @@ void GLGlobeBase::prepareScene() NOTHROWS
     glDepthMask(GL_TRUE);
     glEnable(GL_DEPTH_TEST);
 
-    GLWorkers_doResourceLoadingWork(30);
-    GLWorkers_doGLThreadWork();
+    GLWorkers_doResourceLoadingWork(RESOURCE_LOAD_BUDGET_MILLIS);
+    GLWorkers_doGLThreadWork(GL_THREAD_WORK_BUDGET_MILLIS);
 }
 void GLGlobeBase::drawRenderables(const GLMapView2::State &renderState) NOTHROWS
 {
@@ -238,7 +567,7 @@ void GLGlobeBase::drawRenderables(const GLMapView2::State &renderState) NOTHROWS
     GLES20FixedPipeline::getInstance()->glPushMatrix();
 
     if (renderState.basemap && basemap)
-        basemap->draw(*this, renderState.renderPass);
+        this->drawRenderable(*basemap, renderState.renderPass);
 
     std::list<std::shared_ptr<GLLayer2>>::iterator it;
     for (it = this->renderables.begin(); it != this->renderables.end(); it++) {
@@ -246,7 +575,7 @@ void GLGlobeBase::drawRenderables(const GLMapView2::State &renderState) NOTHROWS
         GLES20FixedPipeline::getInstance()->glMatrixMode(GLES20FixedPipeline::MatrixMode::MM_GL_MODELVIEW);
 #endif
         if ((*it)->getRenderPass()&renderState.renderPass)
-            (*it)->draw(*this, renderState.renderPass);
+            this->drawRenderable(**it, renderState.renderPass);
     }
 
     // restore the transforms
@@ -267,6 +596,57 @@ GLLabelManager* GLGlobeBase::getLabelManager() const NOTHROWS
 {
     return labelManager;
 }
+ScratchArena &GLGlobeBase::getFrameArena() const NOTHROWS
+{
+    return frameArena;
+}
+std::shared_ptr<const GLGlobeBase::State> GLGlobeBase::getRenderState() const NOTHROWS
+{
+    Lock lock(renderState.mutex);
+    if (!renderState.published)
+        return std::shared_ptr<const State>();
+    // the reader count is acquired while the slot is published, so the GL
+    // thread cannot select it for reuse until the handle is released
+    std::shared_ptr<RenderStateSlot> slot(renderState.published);
+    slot->readers.fetch_add(1u, std::memory_order_relaxed);
+    return std::shared_ptr<const State>(&slot->state, [slot](const State *) NOTHROWS
+    {
+        slot->readers.fetch_sub(1u, std::memory_order_release);
+    });
+}
+void GLGlobeBase::publishRenderState() NOTHROWS
+{
+    // select a slot that is neither published nor held by any reader. Only
+    // the published slot can gain readers, and `published` is only changed
+    // here, so an unpublished slot with no readers stays free. The acquire
+    // pairs with the release by the last reader. If readers are holding
+    // every slot, the slot is replaced and the old state is freed with the
+    // last handle.
+    std::shared_ptr<RenderStateSlot> *slot = nullptr;
+    for (std::size_t i = 0u; i < 3u; i++) {
+        std::shared_ptr<RenderStateSlot> &candidate = renderState.slots[i];
+        if (!candidate || (candidate != renderState.published && !candidate->readers.load(std::memory_order_acquire))) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (!slot) {
+        slot = &renderState.slots[0u];
+        if (renderState.slots[0u] == renderState.published)
+            slot = &renderState.slots[1u];
+        slot->reset();
+    }
+    if (!*slot)
+        *slot = std::make_shared<RenderStateSlot>();
+
+    {
+        ReadLock rlock(renderPasses0Mutex);
+        (*slot)->state = renderPasses[0];
+    }
+
+    Lock lock(renderState.mutex);
+    renderState.published = *slot;
+}
 TAKErr GLGlobeBase::registerControl(const Layer2 &layer, const char *type, void *ctrl) NOTHROWS
 {
     if (!type)
@@ -749,6 +1129,9 @@ void GLGlobeBase::refreshLayersImpl(const std::list<std::shared_ptr<GLLayer2>> &
 
     for (it = toRelease.begin(); it != toRelease.end(); it++)
         (*it)->release();
+
+    refreshPreparables();
+    invalidate();
 }
 void GLGlobeBase::refreshLayers(const std::list<atakmap::core::Layer *> &layers) NOTHROWS
 {
@@ -849,6 +1232,10 @@ SurfaceRendererControl* GLGlobeBase::getSurfaceRendererControl() const NOTHROWS
 {
     return nullptr;
 }
+std::shared_ptr<const TerrainOcclusion> GLGlobeBase::getTerrainOcclusion() const NOTHROWS
+{
+    return std::shared_ptr<const TerrainOcclusion>();
+}
 void GLGlobeBase::asyncRefreshLayers(void *opaque) NOTHROWS
 {
     std::unique_ptr<AsyncRunnable> runnable(static_cast<AsyncRunnable *>(opaque));
@@ -1046,6 +1433,16 @@ namespace {
         std::unique_ptr<std::pair<GLGlobeBase&, GLLabelManager*>> p(static_cast<std::pair<GLGlobeBase&, GLLabelManager*>*>(opaque));
         p->first.setLabelManager(std::move(p->second));
     }
+    TAKErr prepareTask(bool &value, GLPreparable *preparable, const std::shared_ptr<const GLGlobeBase::State> *state) NOTHROWS
+    {
+        preparable->prepare(*state);
+        value = true;
+        return TE_Ok;
+    }
+    int64_t elapsedNanos(const std::chrono::steady_clock::time_point &start) NOTHROWS
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
 
     bool hasSettled(double dlat, double dlng, double dscale, double drot, double dtilt, double dfocusX, double dfocusY) NOTHROWS
     {
@@ -12,17 +12,22 @@
 #undef far
 #endif
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "core/AtakMapView.h"
 #include "core/MapRenderer.h"
 #include "core/MapSceneModel2.h"
 #include "port/Platform.h"
+#include "renderer/GL.h"
 #include "renderer/core/controls/SurfaceRendererControl.h"
 #include "thread/Mutex.h"
 #include "thread/RWMutex.h"
 #include "util/Error.h"
+#include "util/ScratchArena.h"
 
 namespace TAK {
     namespace Engine {
@@ -35,6 +40,8 @@ namespace TAK {
                 class GLLabelManager;
                 class GLLayer2;
                 class GLMapRenderable2;
+                class GLPreparable;
+                class TerrainOcclusion;
 
                 class ENGINE_API GLGlobeBase :
                         public TAK::Engine::Core::MapRenderer,
@@ -144,6 +151,28 @@ namespace TAK {
                     void setBaseMap(std::unique_ptr<GLMapRenderable2, void(*)(const GLMapRenderable2 *)> &&map) NOTHROWS;
                     void setLabelManager(GLLabelManager* labelManager) NOTHROWS;
                     GLLabelManager* getLabelManager() const NOTHROWS;
+                    /**
+                     * Returns the arena for memory that is only needed for
+                     * the duration of the current render pump. The arena is
+                     * reset when `render()` returns; allocations must not be
+                     * retained across frames. Only valid on the GL thread
+                     * while rendering.
+                     */
+                    Util::ScratchArena &getFrameArena() const NOTHROWS;
+                    /**
+                     * Returns the snapshot of `renderPasses[0]` published at
+                     * the start of the most recent frame, once the scene has
+                     * been validated and the bounds computed. The snapshot is
+                     * immutable and remains valid for as long as a reference
+                     * is held, so it may be consumed by worker, loader and UI
+                     * threads while the next frame is being prepared.
+                     *
+                     * <P>May be invoked from any thread.
+                     *
+                     * @return  The most recently published snapshot or
+                     *          `nullptr` if no frame has been rendered
+                     */
+                    std::shared_ptr<const State> getRenderState() const NOTHROWS;
                     /**
                      * Invokes `release()` on all renderables; subsequent call
                      * to `render()` will force per-renderable
@@ -174,6 +203,48 @@ namespace TAK {
                     virtual void drawRenderables() NOTHROWS = 0;
                     virtual void drawRenderables(const State &state) NOTHROWS;
                     virtual void drawRenderable(GLMapRenderable2 &renderable, const int renderPass) NOTHROWS;
+                private :
+                    /** publishes `renderPasses[0]` as the render state for the frame */
+                    void publishRenderState() NOTHROWS;
+                public : // frame cache
+                    /**
+                     * Enables or disables the frame cache. When enabled and
+                     * continuous rendering is on, the composited frame is
+                     * retained in an offscreen framebuffer and presented in
+                     * place of drawing the renderables if neither the draw
+                     * parameters nor the content have changed since it was
+                     * captured. Defaults to the `glglobe.frame-cache` option.
+                     *
+                     * <P>Content changes are observed through `context`: any
+                     * `requestRefresh()` or `queueEvent()` on it, or on a child
+                     * context created from it, invalidates the cached frame.
+                     * Renderables driven through another context must invoke
+                     * `invalidate()`; as a backstop, the cached frame is
+                     * redrawn at least once per second.
+                     *
+                     * <P>Requires GLES3; ignored if the display framebuffer is
+                     * multisampled. Must be invoked on the GL thread.
+                     */
+                    void setFrameCacheEnabled(const bool enabled) NOTHROWS;
+                    bool isFrameCacheEnabled() const NOTHROWS;
+                    /**
+                     * Marks the content as changed; the next frame will draw
+                     * all renderables. May be invoked from any thread.
+                     */
+                    void invalidate() const NOTHROWS;
+                private :
+                    /**
+                     * Runs the CPU prepare phase for all `GLPreparable`
+                     * renderables concurrently on the CPU workers, returning
+                     * once all have completed.
+                     */
+                    void prepareRenderables() NOTHROWS;
+                    void refreshPreparables() NOTHROWS;
+                    bool presentFrameCache() NOTHROWS;
+                    void updateFrameCache(const unsigned int version) NOTHROWS;
+                    void releaseFrameCache() NOTHROWS;
+                private :
+                    class InvalidatingRenderContext;
                 public : // MapRenderer
                     virtual Util::TAKErr registerControl(const TAK::Engine::Core::Layer2 &layer, const char *type, void *ctrl) NOTHROWS override;
                     virtual Util::TAKErr unregisterControl(const TAK::Engine::Core::Layer2 &layer, const char *type, void *ctrl) NOTHROWS override;
@@ -213,6 +284,15 @@ namespace TAK {
                     virtual Util::TAKErr getTerrainMeshElevation(double *value, const double latitude, const double longitude) const NOTHROWS;
                     virtual Elevation::TerrainRenderService &getTerrainRenderService() const NOTHROWS = 0;
                     virtual Controls::SurfaceRendererControl* getSurfaceRendererControl() const NOTHROWS;
+                    /**
+                     * Returns the most recent terrain depth capture, or
+                     * `nullptr` if occlusion culling is not available. The
+                     * capture may lag the current scene; see
+                     * `TerrainOcclusion::isCurrent`.
+                     *
+                     * <P>May only be invoked on the render thread.
+                     */
+                    virtual std::shared_ptr<const TerrainOcclusion> getTerrainOcclusion() const NOTHROWS;
                 protected :
                     static Util::TAKErr validateSceneModel(GLGlobeBase *view, const std::size_t width, const std::size_t height, const TAK::Engine::Core::MapCamera2::Mode mode, const double nearMeters = NAN, const double farMeters = NAN) NOTHROWS;
                 private :
@@ -221,6 +301,13 @@ namespace TAK {
                     static void asyncProjUpdate(void *opaque) NOTHROWS;
                     static void asyncAnimateFocus(void *opaque) NOTHROWS;
                     static void glMapResized(void *opaque) NOTHROWS;
+                private :
+                    /**
+                     * Wraps the host context, marking the content as changed
+                     * on refresh requests and queued events. Declared ahead
+                     * of `context`, which refers to it.
+                     */
+                    std::unique_ptr<InvalidatingRenderContext> invalidatingContext;
                 public:
                     /** The current animation factor for transitions */
                     double animationFactor;// override.3; //COVERED
@@ -269,6 +356,14 @@ namespace TAK {
                         std::size_t height;
                     } state;
                     TAK::Engine::Core::MapCamera2::Mode cammode;
+                    /** CPU time of the most recent frame; GL thread only */
+                    struct
+                    {
+                        /** scene and renderable preparation, in nanoseconds */
+                        int64_t prepareNanos {0LL};
+                        /** draw submission, in nanoseconds */
+                        int64_t submitNanos {0LL};
+                    } frameTiming;
                 private : // layers management
                     std::shared_ptr<Thread::Mutex> asyncRunnablesMutex;
                     std::shared_ptr<bool> disposed;
@@ -288,6 +383,48 @@ namespace TAK {
                 private :
                     std::unique_ptr<GLMapRenderable2, void(*)(const GLMapRenderable2 *)> basemap; //COVERED
                     GLLabelManager* labelManager;
+                    /** the subset of `basemap` and `renderables` that are `GLPreparable`; GL thread only */
+                    std::vector<GLPreparable *> preparables;
+                    /** access is only thread-safe on the GL thread */
+                    mutable Util::ScratchArena frameArena;
+                    struct RenderStateSlot
+                    {
+                        State state;
+                        /**
+                         * Number of outstanding `getRenderState` handles.
+                         * Incremented under `renderState.mutex` while the slot
+                         * is published; released when a handle is destroyed.
+                         */
+                        std::atomic<std::size_t> readers{ 0u };
+                    };
+                    /**
+                     * Per-frame render state snapshots. Slots are recycled
+                     * once their reader count drops to zero, so in steady
+                     * state the states are triple buffered without
+                     * allocation.
+                     */
+                    struct
+                    {
+                        /** guards `published` */
+                        mutable Thread::Mutex mutex;
+                        std::shared_ptr<RenderStateSlot> published;
+                        /** GL thread only */
+                        std::shared_ptr<RenderStateSlot> slots[3u];
+                    } renderState;
+                    /** access is only thread-safe on the GL thread */
+                    struct
+                    {
+                        bool enabled {false};
+                        bool valid {false};
+                        GLuint fbo {GL_NONE};
+                        GLuint color {GL_NONE};
+                        GLsizei width {0};
+                        GLsizei height {0};
+                        int drawVersion {0};
+                        int terrainVersion {0};
+                        unsigned int contentVersion {0u};
+                        int64_t drawn {0LL};
+                    } frameCache;
                 private : // controls
                     Thread::Mutex controlsMutex;
                     std::map<const TAK::Engine::Core::Layer2 *, std::map<std::string, std::set<void *>>> controls;
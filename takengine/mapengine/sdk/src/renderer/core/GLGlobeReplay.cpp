@@ -0,0 +1,159 @@
+#include "renderer/core/GLGlobeReplay.h"
+
+#include <algorithm>
+#include <list>
+
+#include "renderer/core/GLGlobe.h"
+
+using namespace TAK::Engine::Renderer::Core;
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Util;
+
+GLGlobeReplay::GLGlobeReplay(GLGlobe &globe_, atakmap::core::AtakMapView &view_, const std::vector<MapViewEvent> &events_) NOTHROWS :
+    globe(globe_),
+    view(view_),
+    events(events_),
+    next(0u),
+    time(0LL),
+    skipped(0u),
+    lastFrame(0LL),
+    started(false),
+    statisticsEnabled(false)
+{
+    std::stable_sort(events.begin(), events.end(), [](const MapViewEvent &a, const MapViewEvent &b) { return a.timestamp < b.timestamp; });
+}
+GLGlobeReplay::~GLGlobeReplay() NOTHROWS
+{
+    if (started)
+        globe.setFrameStatisticsEnabled(statisticsEnabled);
+}
+TAKErr GLGlobeReplay::start() NOTHROWS
+{
+    if (!started)
+        statisticsEnabled = globe.isFrameStatisticsEnabled();
+    started = true;
+    next = 0u;
+    time = 0LL;
+    skipped = 0u;
+
+    // discard frames rendered prior to playback
+    globe.setFrameStatisticsEnabled(true);
+    frames.clear();
+    std::vector<GLFrameStatistics::Frame> prior;
+    globe.getFrameStatistics(prior, 0LL);
+    lastFrame = prior.empty() ? 0LL : prior.back().frame;
+
+    return advance(0LL);
+}
+TAKErr GLGlobeReplay::advance(const int64_t millis) NOTHROWS
+{
+    if (!started || millis < 0LL)
+        return TE_IllegalState;
+    collectFrames();
+    time += millis;
+    while (next < events.size() && events[next].timestamp <= time)
+        apply(events[next++]);
+    return isFinished() ? TE_Done : TE_Ok;
+}
+int64_t GLGlobeReplay::getTime() const NOTHROWS
+{
+    return time;
+}
+int64_t GLGlobeReplay::getDuration() const NOTHROWS
+{
+    return events.empty() ? 0LL : events.back().timestamp;
+}
+bool GLGlobeReplay::isFinished() const NOTHROWS
+{
+    return next >= events.size();
+}
+std::size_t GLGlobeReplay::getSkippedEvents() const NOTHROWS
+{
+    return skipped;
+}
+TAKErr GLGlobeReplay::getFrameStatistics(std::vector<GLFrameStatistics::Frame> &value) NOTHROWS
+{
+    collectFrames();
+    value.insert(value.end(), frames.begin(), frames.end());
+    return TE_Ok;
+}
+void GLGlobeReplay::apply(const MapViewEvent &event) NOTHROWS
+{
+    atakmap::core::Layer *layer = nullptr;
+    switch (event.type) {
+    case MapViewEvent::Camera :
+        if (globe.lookAt(event.focus, event.resolution, event.rotation, event.tilt, MapRenderer::CameraCollision::Ignore, event.animate) != TE_Ok)
+            skipped++;
+        break;
+    case MapViewEvent::Resized :
+        view.setSize(event.width, event.height);
+        break;
+    case MapViewEvent::LayerAdded :
+    {
+        auto entry = removed.find(event.layer);
+        if (entry == removed.end()) {
+            // present at the start of playback or created elsewhere
+            if (!findLayer(event.layer))
+                skipped++;
+            break;
+        }
+        layer = entry->second;
+        removed.erase(entry);
+        const int numLayers = (int)view.getNumLayers();
+        if (event.position >= 0 && event.position < numLayers)
+            view.addLayer(event.position, layer);
+        else
+            view.addLayer(layer);
+        break;
+    }
+    case MapViewEvent::LayerRemoved :
+        layer = findLayer(event.layer);
+        if (!layer) {
+            skipped++;
+            break;
+        }
+        view.removeLayer(layer);
+        removed[event.layer] = layer;
+        break;
+    case MapViewEvent::LayerMoved :
+        layer = findLayer(event.layer);
+        if (!layer) {
+            skipped++;
+            break;
+        }
+        view.setLayerPosition(layer, event.position);
+        break;
+    case MapViewEvent::LayerVisible :
+        layer = findLayer(event.layer);
+        if (!layer) {
+            skipped++;
+            break;
+        }
+        if (layer->isVisible() != event.visible)
+            layer->setVisible(event.visible);
+        break;
+    default :
+        skipped++;
+        break;
+    }
+}
+atakmap::core::Layer *GLGlobeReplay::findLayer(const std::string &name) NOTHROWS
+{
+    std::list<atakmap::core::Layer *> layers;
+    view.getLayers(layers);
+    for (auto it = layers.begin(); it != layers.end(); it++) {
+        const char *layerName = (*it)->getName();
+        if (layerName && name == layerName)
+            return *it;
+    }
+    return nullptr;
+}
+void GLGlobeReplay::collectFrames() NOTHROWS
+{
+    const std::size_t count = frames.size();
+    if (globe.getFrameStatistics(frames, lastFrame) != TE_Ok)
+        return;
+    if (frames.size() > count)
+        lastFrame = frames.back().frame;
+}
@@ -0,0 +1,99 @@
+#ifndef TAK_ENGINE_RENDERER_CORE_GLGLOBEREPLAY_H_INCLUDED
+#define TAK_ENGINE_RENDERER_CORE_GLGLOBEREPLAY_H_INCLUDED
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/AtakMapView.h"
+#include "core/Layer.h"
+#include "core/MapViewRecorder.h"
+#include "port/Platform.h"
+#include "renderer/core/GLDiagnostics.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            namespace Core {
+                class GLGlobe;
+
+                /**
+                 * Plays back events captured by `MapViewRecorder` into a
+                 * `GLGlobe`.
+                 *
+                 * <P>Replay time is driven by the caller through `advance`
+                 * rather than by the system clock. When advanced by a fixed
+                 * step once per rendered frame, the same recording produces
+                 * the same sequence of scenes on every run, which allows a
+                 * field recording to be used as a repeatable benchmark on
+                 * device or in the headless harness.
+                 *
+                 * <P>Layer events are applied to the layers of the view by
+                 * name. Layers removed during playback are retained and
+                 * restored by a subsequent add; adds for layers that were
+                 * never present in the view are skipped.
+                 *
+                 * <P>Frame statistics are recorded on the globe for the
+                 * duration of playback and collected via
+                 * `getFrameStatistics`.
+                 *
+                 * <P>This class is not thread-safe.
+                 */
+                class ENGINE_API GLGlobeReplay
+                {
+                public :
+                    GLGlobeReplay(GLGlobe &globe, atakmap::core::AtakMapView &view, const std::vector<TAK::Engine::Core::MapViewEvent> &events) NOTHROWS;
+                    ~GLGlobeReplay() NOTHROWS;
+                public :
+                    /**
+                     * Rewinds to time zero, applies the events at time zero
+                     * and begins collecting frame statistics.
+                     */
+                    Util::TAKErr start() NOTHROWS;
+                    /**
+                     * Advances replay time, applying all events that occur
+                     * up to and including the new time.
+                     *
+                     * @return  TE_Ok on success, TE_Done if all events have
+                     *          been applied
+                     */
+                    Util::TAKErr advance(const int64_t millis) NOTHROWS;
+                    /** Returns the current replay time, in milliseconds */
+                    int64_t getTime() const NOTHROWS;
+                    /** Returns the timestamp of the last event, in milliseconds */
+                    int64_t getDuration() const NOTHROWS;
+                    bool isFinished() const NOTHROWS;
+                    /** Returns the number of events that could not be applied */
+                    std::size_t getSkippedEvents() const NOTHROWS;
+                    /**
+                     * Appends the statistics for all frames rendered since
+                     * `start`, oldest first. Frames evicted from the globe's
+                     * history between calls to `advance` are not reported.
+                     */
+                    Util::TAKErr getFrameStatistics(std::vector<GLFrameStatistics::Frame> &value) NOTHROWS;
+                private :
+                    void apply(const TAK::Engine::Core::MapViewEvent &event) NOTHROWS;
+                    atakmap::core::Layer *findLayer(const std::string &name) NOTHROWS;
+                    void collectFrames() NOTHROWS;
+                private :
+                    GLGlobe &globe;
+                    atakmap::core::AtakMapView &view;
+                    std::vector<TAK::Engine::Core::MapViewEvent> events;
+                    std::size_t next;
+                    int64_t time;
+                    std::size_t skipped;
+                    /** layers removed by playback, by name */
+                    std::map<std::string, atakmap::core::Layer *> removed;
+                    std::vector<GLFrameStatistics::Frame> frames;
+                    int64_t lastFrame;
+                    bool started;
+                    bool statisticsEnabled;
+                };
+            }
+        }
+    }
+}
+
+#endif
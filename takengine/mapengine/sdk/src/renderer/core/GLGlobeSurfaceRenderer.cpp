@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <sstream>
 
 #include "core/Datum2.h"
@@ -14,6 +15,7 @@
 #include "renderer/core/GLGlobe.h"
 #include "renderer/elevation/TerrainRenderService.h"
 #include "thread/Lock.h"
+#include "util/ConfigOptions.h"
 
 using namespace TAK::Engine::Renderer::Core;
 
@@ -30,6 +32,9 @@ using namespace TAK::Engine::Util;
 #define MT_TILE_SIZE 512
 #define DEFAULT_SURFACE_REFRESH_INTERVAL 3000
 #define FORCE_PAUSE 0
+#define DEFAULT_SURFACE_UPDATE_BUDGET 16
+// queued dirty regions beyond this count are merged
+#define MAX_DIRTY_REGIONS 256u
 
 namespace
 {
@@ -92,7 +97,8 @@ GLGlobeSurfaceRenderer::GLGlobeSurfaceRenderer(GLGlobe &owner_) NOTHROWS :
     dirty(true),
     streamDirty(false),
     refreshInterval(DEFAULT_SURFACE_REFRESH_INTERVAL),
-    lastRefresh(Platform_systime_millis())
+    lastRefresh(Platform_systime_millis()),
+    updateBudget((std::size_t)ConfigOptions_getIntOptionOrDefault("glglobe.surface-update-budget", DEFAULT_SURFACE_UPDATE_BUDGET))
 {}
 GLGlobeSurfaceRenderer::~GLGlobeSurfaceRenderer() NOTHROWS
 {}
@@ -266,12 +272,14 @@ void GLGlobeSurfaceRenderer::update(const std::size_t limitMillis) NOTHROWS
     restore.drawVersion = owner.drawVersion;
 
     const int64_t timesup = limitMillis ? (Platform_systime_millis()+limitMillis) : 0LL;
+    // large updates converge over several frames
+    std::size_t budget = updateBudget ? updateBudget : std::numeric_limits<std::size_t>::max();
 
     bool transfer = false;
     if(updateContext.pc.visible.pc < updateContext.dirtyTiles.visible.size())
-        transfer |= updateTiles(updateContext.pc.visible, updateContext.dirtyTiles.visible, false, !updateContext.stream ? timesup : 0LL);
-    if((timesup && Platform_systime_millis() < timesup) && updateContext.pc.offscreen.pc < updateContext.dirtyTiles.offscreen.size())
-        transfer |= updateTiles(updateContext.pc.offscreen, updateContext.dirtyTiles.offscreen, true, timesup);
+        transfer |= updateTiles(updateContext.pc.visible, updateContext.dirtyTiles.visible, false, !updateContext.stream ? timesup : 0LL, budget);
+    if(budget && (timesup && Platform_systime_millis() < timesup) && updateContext.pc.offscreen.pc < updateContext.dirtyTiles.offscreen.size())
+        transfer |= updateTiles(updateContext.pc.offscreen, updateContext.dirtyTiles.offscreen, true, timesup, budget);
 
     // reset the map render state
     owner.renderPasses[1u] = restore.renderPass1;
@@ -327,7 +335,7 @@ void GLGlobeSurfaceRenderer::update(const std::size_t limitMillis) NOTHROWS
             owner.context.requestRefresh();
     }
 }
-bool GLGlobeSurfaceRenderer::updateTiles(ProgramCounter &pc, const std::vector<std::size_t> &updateIndices, const bool allowInterrupt, const int64_t limit) NOTHROWS
+bool GLGlobeSurfaceRenderer::updateTiles(ProgramCounter &pc, const std::vector<std::size_t> &updateIndices, const bool allowInterrupt, const int64_t limit, std::size_t &budget) NOTHROWS
 {
     const GLMapView2::State &rp0 = owner.renderPasses[0];
     GLMapView2::State pumpState(owner);
@@ -437,9 +445,9 @@ bool GLGlobeSurfaceRenderer::updateTiles(ProgramCounter &pc, const std::vector<s
         atakmap::renderer::GLES20FixedPipeline::getInstance()->glOrthof((float)pumpState.left, (float)pumpState.right, (float)pumpState.bottom, (float)pumpState.top, (float)pumpState.scene.camera.near, (float)pumpState.scene.camera.far);
         atakmap::renderer::GLES20FixedPipeline::getInstance()->glMatrixMode(atakmap::renderer::GLES20FixedPipeline::MM_GL_MODELVIEW);
         if(owner.basemap)
-            owner.basemap->draw(owner, GLMapView2::Surface2|GLMapView2::Surface);
+            owner.drawRenderable(*owner.basemap, GLMapView2::Surface2|GLMapView2::Surface);
         for(auto r : owner.renderables)
-            (*r).draw(owner, GLMapView2::Surface2|GLMapView2::Surface);
+            owner.drawRenderable(*r, GLMapView2::Surface2|GLMapView2::Surface);
         atakmap::renderer::GLES20FixedPipeline::getInstance()->glMatrixMode(atakmap::renderer::GLES20FixedPipeline::MM_GL_PROJECTION);
         atakmap::renderer::GLES20FixedPipeline::getInstance()->glPopMatrix();
         atakmap::renderer::GLES20FixedPipeline::getInstance()->glMatrixMode(atakmap::renderer::GLES20FixedPipeline::MM_GL_MODELVIEW);
@@ -480,8 +488,10 @@ bool GLGlobeSurfaceRenderer::updateTiles(ProgramCounter &pc, const std::vector<s
         // don't bother incurring the overhead if no limit
         tick = limit ? TAK::Engine::Port::Platform_systime_millis() : tick;
 
-        // if the limit is exhausted or we're interrupted, yield
-        if ((limit && (tick > limit)) || pc.interrupted)
+        budget--;
+
+        // if the limit or budget is exhausted or we're interrupted, yield
+        if ((limit && (tick > limit)) || !budget || pc.interrupted)
             break;
     }
 
@@ -783,10 +793,11 @@ void GLGlobeSurfaceRenderer::markDirty(const Envelope2& region, const bool strea
         return;
     }
 
-    // XXX - 
-    //dirtyRegions.push_back(region);
+    // only the tiles intersecting the region are updated
+    dirtyRegions.push_back(region);
+    if (dirtyRegions.size() > MAX_DIRTY_REGIONS)
+        dirtyRegions.compact();
     streamDirty |= streaming;
-    dirty = true;
     owner.context.requestRefresh();
 }
 void GLGlobeSurfaceRenderer::setMinimumRefreshInterval(const std::size_t millis) NOTHROWS
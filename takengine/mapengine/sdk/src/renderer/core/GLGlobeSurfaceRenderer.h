@@ -55,7 +55,13 @@ namespace TAK {
                      *                      `0` is specified.
                      */
                     void update(const std::size_t limitMillis) NOTHROWS;
-                    bool updateTiles(ProgramCounter &pc, const std::vector<std::size_t> &updateIndices, const bool allowInterrupt, const int64_t limit) NOTHROWS;
+                    /**
+                     * @param budget    The number of tiles that may be
+                     *                  rendered; decremented for each tile
+                     *                  rendered. The update yields once
+                     *                  exhausted.
+                     */
+                    bool updateTiles(ProgramCounter &pc, const std::vector<std::size_t> &updateIndices, const bool allowInterrupt, const int64_t limit, std::size_t &budget) NOTHROWS;
                     void syncTexture(const bool evictStale) NOTHROWS;
                     void draw() NOTHROWS;
                     void release() NOTHROWS;
@@ -76,6 +82,8 @@ namespace TAK {
 
                     std::size_t refreshInterval;
                     int64_t lastRefresh;
+                    /** maximum number of tiles rendered per frame; `0` if unlimited */
+                    std::size_t updateBudget;
 
                     /**
                      * Guards following resources:
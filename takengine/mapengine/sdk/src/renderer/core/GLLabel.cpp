@@ -28,6 +28,10 @@ using namespace atakmap::renderer;
 #define ONE_EIGHTY_OVER_PI 57.295779513082320876798154814105
 #define LABEL_PADDING_X 10
 #define LABEL_PADDING_Y 5
+// cell dimension of the placement grid, in pixels
+#define PLACEMENTS_CELL_SIZE 64.0
+#define PLACEMENTS_MAX_CELLS 128
+#define PLACEMENTS_NO_NODE 0xFFFFFFFFu
 
 atakmap::renderer::GLNinePatch* GLLabel::small_nine_patch_ = nullptr;
 
@@ -37,6 +41,17 @@ static float DistanceSquared(float ax, float ay, float bx, float by) {
     return dx * dx + dy * dy;
 }
 
+// overlap test between label bounds; pads to the right and top and insets by the descent
+static bool IntersectsPadded(const atakmap::math::Rectangle<double>& a, const atakmap::math::Rectangle<double>& b, const double descent) {
+    return atakmap::math::Rectangle<double>::intersects(
+        a.x, a.y + descent,
+        a.x + a.width + LABEL_PADDING_X,
+        a.y + a.height - (2.0 * descent) + LABEL_PADDING_Y,
+        b.x, b.y + descent,
+        b.x + b.width + LABEL_PADDING_X,
+        b.y + b.height - (2.0 * descent) + LABEL_PADDING_Y);
+}
+
 static bool IntersectLine(TAK::Engine::Math::Point2<float>& pIntersection, float a1x, float a1y, float a2x, float a2y, float b1x, float b1y,
                           float b2x, float b2y) {
     // code from
@@ -141,6 +156,9 @@ GLLabel::GLLabel()
       projected_size_(std::numeric_limits<double>::quiet_NaN()),   
       mark_dirty_(true),
       draw_version_(-1),
+      layout_version_(-1),
+      text_width_(0.0f),
+      text_height_(0.0f),
       gltext_(nullptr)
 {
     rotation_.angle_ = 0.0f;
@@ -173,6 +191,9 @@ GLLabel::GLLabel(const GLLabel& rhs) : GLLabel() {
     back_color_b_ = rhs.back_color_b_;
     fill_ = rhs.fill_;
     gltext_ = rhs.gltext_;
+    layout_version_ = rhs.layout_version_;
+    text_width_ = rhs.text_width_;
+    text_height_ = rhs.text_height_;
 }
 
 GLLabel::GLLabel(GLLabel&& rhs) NOTHROWS : GLLabel() {
@@ -200,6 +221,9 @@ GLLabel::GLLabel(GLLabel&& rhs) NOTHROWS : GLLabel() {
     back_color_b_ = rhs.back_color_b_;
     fill_ = rhs.fill_;
     gltext_ = rhs.gltext_;
+    layout_version_ = rhs.layout_version_;
+    text_width_ = rhs.text_width_;
+    text_height_ = rhs.text_height_;
 }
 
 GLLabel::GLLabel(Feature::Geometry2Ptr_const&& geometry, TAK::Engine::Port::String text, Point2<double> desired_offset,
@@ -228,6 +252,9 @@ GLLabel::GLLabel(Feature::Geometry2Ptr_const&& geometry, TAK::Engine::Port::Stri
       projected_size_(std::numeric_limits<double>::quiet_NaN()),
       mark_dirty_(true),
       draw_version_(-1),
+      layout_version_(-1),
+      text_width_(0.0f),
+      text_height_(0.0f),
       gltext_(nullptr)
 {
     rotation_.angle_ = 0.0f;
@@ -308,6 +335,9 @@ GLLabel& GLLabel::operator=(GLLabel&& rhs) NOTHROWS {
         back_color_b_ = rhs.back_color_b_;
         fill_ = rhs.fill_;
         gltext_ = rhs.gltext_;
+        layout_version_ = rhs.layout_version_;
+        text_width_ = rhs.text_width_;
+        text_height_ = rhs.text_height_;
     }
 
     return *this;
@@ -381,7 +411,7 @@ bool GLLabel::shouldRenderAtResolution(const double draw_resolution) const NOTHR
     return true;
 }
 
-void GLLabel::place(const GLGlobeBase& view, GLText2& gl_text, std::vector<atakmap::math::Rectangle<double>>& label_rects) NOTHROWS {
+void GLLabel::place(const GLGlobeBase& view, GLText2& gl_text, Placements& label_rects) NOTHROWS {
     view.renderPass->scene.forwardTransform.transform(&transformed_anchor_, pos_projected_);
 
     const auto xpos = static_cast<float>(transformed_anchor_.x);
@@ -397,12 +427,18 @@ void GLLabel::place(const GLGlobeBase& view, GLText2& gl_text, std::vector<atakm
         const char* text = text_.c_str();
         float offy = 0;
         float offtx = 0;
-        float textWidth = std::min(gl_text.getTextFormat().getStringWidth(text), (float)(view.renderPass->right - 20));
-        float textHeight = gl_text.getTextFormat().getStringHeight(text);
+        // metrics are only measured once the label has changed
+        if (layout_version_ == -1) {
+            text_width_ = gl_text.getTextFormat().getStringWidth(text);
+            text_height_ = gl_text.getTextFormat().getStringHeight(text);
+        }
+        float textWidth = std::min(text_width_, (float)(view.renderPass->right - 20));
+        float textHeight = text_height_;
 
         if (!std::isnan(projected_size_)) {
             double availableWidth = projected_size_ / view.renderPass->drawMapResolution;
             if (availableWidth < textWidth) {
+                layout_version_ = view.drawVersion;
                 canDraw = false;
                 return;
             }
@@ -432,58 +468,86 @@ void GLLabel::place(const GLGlobeBase& view, GLText2& gl_text, std::vector<atakm
         labelRect.height = textHeight;
     }
 
+    // the overlap test pads the bounds to the right and top and insets by
+    // the descent; query with a margin covering both
+    const double margin = std::max(LABEL_PADDING_X, LABEL_PADDING_Y) + 3.0 * std::abs(textDescent);
+
+    // find the first label drawn that overlaps
     bool overlaps = false;
     bool rePlaced = false;
-    int replace_idx = -1;
-    int itr_idx = 0;
-    for (auto itr = label_rects.begin(); itr != label_rects.end(); itr++) {
-        overlaps = atakmap::math::Rectangle<double>::intersects(
-            labelRect.x, labelRect.y + textDescent, 
-            labelRect.x + labelRect.width + LABEL_PADDING_X,
-            labelRect.y + labelRect.height - (2.0 * textDescent) + LABEL_PADDING_Y, 
-            itr->x, itr->y + textDescent, 
-            itr->x + itr->width + LABEL_PADDING_X,
-            itr->y + itr->height - (2.0 * textDescent) + LABEL_PADDING_Y);
-
-        if (overlaps && !rePlaced) {
-            replace_idx = itr_idx;
-            rePlaced = true;
-            double leftShift = abs((labelRect.x + labelRect.width) - itr->x);
-            double rightShift = abs(labelRect.x - (itr->x + itr->width));
-            if (rightShift < leftShift && rightShift < (labelRect.width / 2.0f)) {
-                // shift right of compared label rect
-                labelRect.x = itr->x + itr->width + LABEL_PADDING_X;
-            } else if (leftShift < (labelRect.width / 2.0f)) {
-                // shift left of compared label rect
-                labelRect.x = itr->x - labelRect.width - LABEL_PADDING_X;
-            } else {
+    std::size_t replace_idx = 0u;
+    {
+        const auto &candidates = label_rects.query(labelRect.x - margin, labelRect.y - margin,
+                                                   labelRect.x + labelRect.width + margin, labelRect.y + labelRect.height + margin);
+        for (auto itr = candidates.begin(); itr != candidates.end(); itr++) {
+            const atakmap::math::Rectangle<double> &rect = label_rects[*itr];
+            overlaps = IntersectsPadded(labelRect, rect, textDescent);
+            if (overlaps) {
+                replace_idx = *itr;
                 break;
             }
-            overlaps = atakmap::math::Rectangle<double>::intersects(
-                labelRect.x, labelRect.y + textDescent, labelRect.x + labelRect.width,
-                labelRect.y + labelRect.height - (2.0 * textDescent), itr->x + 1.0, itr->y + textDescent, itr->x + itr->width,
-                itr->y + itr->height - (2.0 * textDescent));
         }
+    }
 
-        itr_idx++;
-        if (overlaps) break;
+    if (overlaps) {
+        rePlaced = true;
+        const atakmap::math::Rectangle<double> &rect = label_rects[replace_idx];
+        double leftShift = abs((labelRect.x + labelRect.width) - rect.x);
+        double rightShift = abs(labelRect.x - (rect.x + rect.width));
+        if (rightShift < leftShift && rightShift < (labelRect.width / 2.0f)) {
+            // shift right of compared label rect
+            labelRect.x = rect.x + rect.width + LABEL_PADDING_X;
+        } else if (leftShift < (labelRect.width / 2.0f)) {
+            // shift left of compared label rect
+            labelRect.x = rect.x - labelRect.width - LABEL_PADDING_X;
+        } else {
+            layout_version_ = view.drawVersion;
+            canDraw = false;
+            return;
+        }
+        overlaps = atakmap::math::Rectangle<double>::intersects(
+            labelRect.x, labelRect.y + textDescent, labelRect.x + labelRect.width,
+            labelRect.y + labelRect.height - (2.0 * textDescent), rect.x + 1.0, rect.y + textDescent, rect.x + rect.width,
+            rect.y + rect.height - (2.0 * textDescent));
     }
 
+    // verify the shifted bounds against all other labels drawn
     if (!overlaps && rePlaced) {
-        for (auto reverse_itr = (label_rects.rbegin() + replace_idx); reverse_itr != label_rects.rbegin(); --reverse_itr) {
-            overlaps = atakmap::math::Rectangle<double>::intersects(
-                labelRect.x, labelRect.y + textDescent, labelRect.x + labelRect.width + LABEL_PADDING_Y,
-                labelRect.y + labelRect.height - (2.0 * textDescent) + LABEL_PADDING_X, reverse_itr->x, reverse_itr->y + textDescent,
-                reverse_itr->x + reverse_itr->width + LABEL_PADDING_X,
-                reverse_itr->y + reverse_itr->height - (2.0 * textDescent) + LABEL_PADDING_Y);
-
+        const auto &candidates = label_rects.query(labelRect.x - margin, labelRect.y - margin,
+                                                   labelRect.x + labelRect.width + margin, labelRect.y + labelRect.height + margin);
+        for (auto itr = candidates.begin(); itr != candidates.end(); itr++) {
+            if (*itr == replace_idx) continue;
+            const atakmap::math::Rectangle<double> &rect = label_rects[*itr];
+            overlaps = IntersectsPadded(labelRect, rect, textDescent);
             if (overlaps) break;
         }
     }
-
+    layout_version_ = view.drawVersion;
     canDraw = !overlaps;
 }
 
+void GLLabel::reproject(const GLGlobeBase& view) NOTHROWS {
+    Math::Point2<double> anchor;
+    view.renderPass->scene.forwardTransform.transform(&anchor, pos_projected_);
+
+    labelRect.x += anchor.x - transformed_anchor_.x;
+    labelRect.y += anchor.y - transformed_anchor_.y;
+    transformed_anchor_ = anchor;
+}
+
+bool GLLabel::overlaps(GLText2& gl_text, Placements& label_rects) NOTHROWS {
+    const auto textDescent = gl_text.getTextFormat().getDescent();
+    const double margin = std::max(LABEL_PADDING_X, LABEL_PADDING_Y) + 3.0 * std::abs(textDescent);
+
+    const auto &candidates = label_rects.query(labelRect.x - margin, labelRect.y - margin,
+                                               labelRect.x + labelRect.width + margin, labelRect.y + labelRect.height + margin);
+    for (auto itr = candidates.begin(); itr != candidates.end(); itr++) {
+        if (IntersectsPadded(labelRect, label_rects[*itr], textDescent))
+            return true;
+    }
+    return false;
+}
+
 void GLLabel::draw(const GLGlobeBase& view, GLText2& gl_text) NOTHROWS {
     if (!text_.empty()) {
         const char* text = text_.c_str();
@@ -858,3 +922,91 @@ void GLLabel::validateProjectedLocation(const GLGlobeBase& view) NOTHROWS {
 
     view.renderPass->scene.projection->forward(&pos_projected_, scratchGeo);
 }
+
+GLLabel::Placements::Placements(ScratchArena &arena, const double minX, const double minY, const double maxX, const double maxY) NOTHROWS :
+    rects(ScratchAllocator<atakmap::math::Rectangle<double>>(arena)),
+    visited(ScratchAllocator<uint32_t>(arena)),
+    cells(ScratchAllocator<uint32_t>(arena)),
+    nodes(ScratchAllocator<Node>(arena)),
+    candidates(ScratchAllocator<std::size_t>(arena)),
+    originX(minX),
+    originY(minY),
+    cellSize(PLACEMENTS_CELL_SIZE),
+    numColumns(1),
+    numRows(1),
+    queryId(0u)
+{
+    // grow the cells for very large surfaces to bound the grid
+    const double width = std::max(maxX - minX, 1.0);
+    const double height = std::max(maxY - minY, 1.0);
+    cellSize = std::max(cellSize, std::max(width, height) / PLACEMENTS_MAX_CELLS);
+    numColumns = std::max((int)ceil(width / cellSize), 1);
+    numRows = std::max((int)ceil(height / cellSize), 1);
+    cells.resize((std::size_t)numColumns * (std::size_t)numRows, PLACEMENTS_NO_NODE);
+}
+
+void GLLabel::Placements::push_back(const atakmap::math::Rectangle<double> &rect) NOTHROWS {
+    const auto placement = (uint32_t)rects.size();
+    rects.push_back(rect);
+    visited.push_back(0u);
+
+    int col0, row0, col1, row1;
+    getCells(&col0, &row0, &col1, &row1, rect.x, rect.y, rect.x + rect.width, rect.y + rect.height);
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            uint32_t &head = cells[(std::size_t)(row * numColumns + col)];
+            Node node;
+            node.placement = placement;
+            node.next = head;
+            head = (uint32_t)nodes.size();
+            nodes.push_back(node);
+        }
+    }
+}
+
+const GLLabel::Placements::Candidates &GLLabel::Placements::query(const double minX, const double minY, const double maxX, const double maxY) NOTHROWS {
+    candidates.clear();
+    if (rects.empty()) return candidates;
+
+    // placements spanning several cells are reported once
+    if (++queryId == 0u) {
+        std::fill(visited.begin(), visited.end(), 0u);
+        queryId = 1u;
+    }
+
+    int col0, row0, col1, row1;
+    getCells(&col0, &row0, &col1, &row1, minX, minY, maxX, maxY);
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            for (uint32_t n = cells[(std::size_t)(row * numColumns + col)]; n != PLACEMENTS_NO_NODE; n = nodes[n].next) {
+                const uint32_t placement = nodes[n].placement;
+                if (visited[placement] == queryId) continue;
+                visited[placement] = queryId;
+                candidates.push_back(placement);
+            }
+        }
+    }
+    // report in placement order
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+}
+
+const atakmap::math::Rectangle<double> &GLLabel::Placements::operator[](const std::size_t idx) const NOTHROWS {
+    return rects[idx];
+}
+
+std::size_t GLLabel::Placements::size() const NOTHROWS {
+    return rects.size();
+}
+
+void GLLabel::Placements::getCells(int *col0, int *row0, int *col1, int *row1, const double minX, const double minY, const double maxX, const double maxY) const NOTHROWS {
+    auto toCell = [this](const double v, const double origin, const int count) {
+        const double cell = floor((v - origin) / cellSize);
+        if (!(cell >= 0.0)) return 0;
+        return (int)std::min(cell, (double)(count - 1));
+    };
+    *col0 = toCell(minX, originX, numColumns);
+    *col1 = toCell(maxX, originX, numColumns);
+    *row0 = toCell(minY, originY, numRows);
+    *row1 = toCell(maxY, originY, numRows);
+}
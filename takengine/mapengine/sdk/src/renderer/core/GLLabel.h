@@ -11,6 +11,7 @@
 #include "renderer/core/GLMapView2.h"
 #include "renderer/GLNinePatch.h"
 #include "renderer/GLText2.h"
+#include "util/ScratchArena.h"
 
 namespace TAK
 {
@@ -39,6 +40,58 @@ namespace TAK
 
                 class ENGINE_API GLLabel
                 {
+                public:
+                    /**
+                     * Placements of labels drawn in the current frame. Bounds
+                     * are binned into a uniform screen-space grid so that a
+                     * candidate is only tested against the labels sharing
+                     * its cells. Storage is allocated from the frame arena.
+                     */
+                    class Placements
+                    {
+                    public :
+                        typedef std::vector<std::size_t, Util::ScratchAllocator<std::size_t>> Candidates;
+                    public :
+                        /**
+                         * @param arena The arena for the frame
+                         * @param minX, minY, maxX, maxY    The screen bounds;
+                         *              placements outside are binned into
+                         *              the edge cells
+                         */
+                        Placements(Util::ScratchArena &arena, const double minX, const double minY, const double maxX, const double maxY) NOTHROWS;
+                    public :
+                        void push_back(const atakmap::math::Rectangle<double> &rect) NOTHROWS;
+                        /**
+                         * Returns the indices, in ascending order, of the
+                         * placements sharing a cell with the specified
+                         * bounds. The result is valid until the next query.
+                         */
+                        const Candidates &query(const double minX, const double minY, const double maxX, const double maxY) NOTHROWS;
+                        const atakmap::math::Rectangle<double> &operator[](const std::size_t idx) const NOTHROWS;
+                        std::size_t size() const NOTHROWS;
+                    private :
+                        void getCells(int *col0, int *row0, int *col1, int *row1, const double minX, const double minY, const double maxX, const double maxY) const NOTHROWS;
+                    private :
+                        struct Node
+                        {
+                            uint32_t placement;
+                            uint32_t next;
+                        };
+
+                        std::vector<atakmap::math::Rectangle<double>, Util::ScratchAllocator<atakmap::math::Rectangle<double>>> rects;
+                        /** the last query that visited each placement */
+                        std::vector<uint32_t, Util::ScratchAllocator<uint32_t>> visited;
+                        /** head node per cell */
+                        std::vector<uint32_t, Util::ScratchAllocator<uint32_t>> cells;
+                        std::vector<Node, Util::ScratchAllocator<Node>> nodes;
+                        Candidates candidates;
+                        double originX;
+                        double originY;
+                        double cellSize;
+                        int numColumns;
+                        int numRows;
+                        uint32_t queryId;
+                    };
                 public:
                     GLLabel();
                     GLLabel(GLLabel&&) NOTHROWS;
@@ -92,7 +145,14 @@ namespace TAK
                     bool shouldRenderAtResolution(const double draw_resolution) const NOTHROWS;
                     void validateProjectedLocation(const TAK::Engine::Renderer::Core::GLGlobeBase& view) NOTHROWS;
                 private:
-                    void place(const GLGlobeBase& view, GLText2& gl_text, std::vector<atakmap::math::Rectangle<double>>& label_rects) NOTHROWS;
+                    void place(const GLGlobeBase& view, GLText2& gl_text, Placements& label_rects) NOTHROWS;
+                    /**
+                     * Moves the placement computed for a previous scene to
+                     * the current scene, retaining the overlap result.
+                     */
+                    void reproject(const GLGlobeBase& view) NOTHROWS;
+                    /** returns `true` if the current placement overlaps any of `label_rects` */
+                    bool overlaps(GLText2& gl_text, Placements& label_rects) NOTHROWS;
                     void draw(const GLGlobeBase& view, GLText2& gl_text) NOTHROWS;
                     void batch(const GLGlobeBase& view, GLText2& gl_text, GLRenderBatch2& batch) NOTHROWS;
                     atakmap::renderer::GLNinePatch* getSmallNinePatch(TAK::Engine::Core::RenderContext &surface) NOTHROWS;
@@ -131,6 +191,11 @@ namespace TAK
                     } rotation_;
                     bool mark_dirty_;
                     int draw_version_;
+                    /** draw version the placement was computed for; `-1` if the label has changed */
+                    int layout_version_;
+                    /** text metrics, valid while `layout_version_` is not `-1` */
+                    float text_width_;
+                    float text_height_;
                     /** if `nullptr`, uses system default */
                     GLText2 *gltext_;
 
@@ -1,5 +1,8 @@
 #include "renderer/core/GLLabelManager.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "core/Ellipsoid.h"
 #include "feature/LegacyAdapters.h"
 #include "math/Vector4.h"
@@ -11,6 +14,7 @@
 #include "renderer/core/GLMapView2.h"
 #include "thread/Mutex.h"
 #include "util/ConfigOptions.h"
+#include "util/PerformanceCounters.h"
 
 using namespace TAK::Engine::Renderer::Core;
 
@@ -22,6 +26,9 @@ using namespace TAK::Engine::Util;
 
 using namespace atakmap::renderer;
 
+// compacts the labels once this many have been removed
+#define GLLABELMANAGER_COMPACT_THRESHOLD 64u
+
 namespace {
 GLText2* defaultText(nullptr);
 }  // namespace
@@ -32,34 +39,40 @@ GLLabelManager::GLLabelManager()
     : labelRotation(0.0),
       absoluteLabelRotation(false),
       labelFadeTimer(-1LL),
+      placementBudget((std::size_t)ConfigOptions_getIntOptionOrDefault("gllabelmanager.placement-budget", 0)),
+      relayoutInterval((std::size_t)ConfigOptions_getIntOptionOrDefault("gllabelmanager.relayout-interval", 1)),
+      num_removed_(0u),
+      priorities_valid_(true),
       map_idx_(0),
       always_render_idx_(NO_ID),
       draw_version_(-1),
       replace_labels_(true),
-      visible_(true) {
-    label_priorities_.insert(std::make_pair(Priority::TEP_High, std::set<uint32_t>()));
-    label_priorities_.insert(std::make_pair(Priority::TEP_Standard, std::set<uint32_t>()));
-    label_priorities_.insert(std::make_pair(Priority::TEP_Low, std::set<uint32_t>()));
-}
+      layout_frame_(0u),
+      visible_(true) {}
 
 GLLabelManager::~GLLabelManager() { this->stop(); }
 
 void GLLabelManager::resetFont() NOTHROWS {
     Lock lock(mutex_);
 
-    draw_version_ = -1;
     defaultFontSize = 0;
     defaultText = nullptr;
+
+    // text metrics are invalid
+    for (auto it = labels_.begin(); it != labels_.end(); it++)
+        invalidateLayout(*it);
 }
 
 uint32_t GLLabelManager::addLabel(GLLabel& label) NOTHROWS {
     Lock lock(mutex_);
 
-    draw_version_ = -1;
-
     replace_labels_ = true;
-    label_priorities_[label.priority_].insert(map_idx_);
-    labels_[map_idx_] = std::move(label);
+    // IDs are monotonic; appending preserves ordering
+    if (priorities_valid_)
+        label_priorities_[label.priority_].push_back((uint32_t)labels_.size());
+    label_ids_.push_back(map_idx_);
+    labels_.push_back(std::move(label));
+    label_removed_.push_back(false);
     return map_idx_++;
 }
 
@@ -68,85 +81,101 @@ void GLLabelManager::removeLabel(const uint32_t id) NOTHROWS {
 
     if (map_idx_ <= id) return;
 
-    draw_version_ = -1;
+    auto it = std::lower_bound(label_ids_.begin(), label_ids_.end(), id);
+    if (it == label_ids_.end() || *it != id) return;
+    const auto idx = static_cast<std::size_t>(it - label_ids_.begin());
+    if (label_removed_[idx]) return;
 
     replace_labels_ = true;
-    label_priorities_[labels_[id].priority_].erase(id);
-    labels_.erase(id);
+    label_removed_[idx] = true;
+    labels_[idx] = GLLabel();
+    num_removed_++;
 
     if (always_render_idx_ == id) always_render_idx_ = NO_ID;
+
+    // compact once the removed labels dominate
+    if (num_removed_ >= GLLABELMANAGER_COMPACT_THRESHOLD && (num_removed_ * 2u) >= labels_.size()) {
+        std::size_t live = 0u;
+        for (std::size_t i = 0u; i < labels_.size(); i++) {
+            if (label_removed_[i]) continue;
+            if (live != i) {
+                label_ids_[live] = label_ids_[i];
+                labels_[live] = std::move(labels_[i]);
+            }
+            live++;
+        }
+        label_ids_.resize(live);
+        labels_.erase(labels_.begin() + live, labels_.end());
+        label_removed_.assign(live, false);
+        num_removed_ = 0u;
+        priorities_valid_ = false;
+    }
 }
 
 void GLLabelManager::setGeometry(const uint32_t id, const TAK::Engine::Feature::Geometry2& geometry) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
-    labels_[id].setGeometry(geometry);
+    invalidateLayout(*label);
+    label->setGeometry(geometry);
 }
 
 void GLLabelManager::setAltitudeMode(const uint32_t id, const TAK::Engine::Feature::AltitudeMode altitude_mode) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
-    labels_[id].setAltitudeMode(altitude_mode);
+    invalidateLayout(*label);
+    label->setAltitudeMode(altitude_mode);
 }
 
 void GLLabelManager::setText(const uint32_t id, TAK::Engine::Port::String text) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
-    labels_[id].setText(text);
+    invalidateLayout(*label);
+    label->setText(text);
 }
 
 void GLLabelManager::setTextFormat(const uint32_t id, const TextFormatParams* fmt) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
+    invalidateLayout(*label);
 
     // RWI - If it's the default font just reset to null
     if (fmt == nullptr ||
         (fmt->size == defaultFontSize && fmt->fontName == nullptr && !fmt->bold && !fmt->italic && !fmt->underline && !fmt->strikethrough))
-        labels_[id].setTextFormat(nullptr);
+        label->setTextFormat(nullptr);
     else
-        labels_[id].setTextFormat(fmt);
+        label->setTextFormat(fmt);
 }
 
 void GLLabelManager::setVisible(const uint32_t id, bool visible) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
-    labels_[id].setVisible(visible);
+    invalidateLayout(*label);
+    label->setVisible(visible);
 }
 
 void GLLabelManager::setAlwaysRender(const uint32_t id, bool always_render) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
-    labels_[id].setAlwaysRender(always_render);
+    invalidateLayout(*label);
+    label->setAlwaysRender(always_render);
     if (always_render)
         always_render_idx_ = id;
     else if (always_render_idx_ == id)
@@ -156,98 +185,95 @@ void GLLabelManager::setAlwaysRender(const uint32_t id, bool always_render) NOTH
 void GLLabelManager::setMaxDrawResolution(const uint32_t id, double max_draw_resolution) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    replace_labels_ = true;
-    labels_[id].setMaxDrawResolution(max_draw_resolution);
+    invalidateLayout(*label);
+    label->setMaxDrawResolution(max_draw_resolution);
 }
 
 void GLLabelManager::setAlignment(const uint32_t id, TextAlignment alignment) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    labels_[id].setAlignment(alignment);
+    label->setAlignment(alignment);
 }
 
 void GLLabelManager::setVerticalAlignment(const uint32_t id, VerticalAlignment vertical_alignment) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    draw_version_ = -1;
+    invalidateLayout(*label);
 
-    labels_[id].setVerticalAlignment(vertical_alignment);
+    label->setVerticalAlignment(vertical_alignment);
 }
 
 void GLLabelManager::setDesiredOffset(const uint32_t id, const TAK::Engine::Math::Point2<double>& desired_offset) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    draw_version_ = -1;
+    invalidateLayout(*label);
 
-    labels_[id].setDesiredOffset(desired_offset);
+    label->setDesiredOffset(desired_offset);
 }
 
 void GLLabelManager::setColor(const uint32_t id, int color) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    labels_[id].setColor(color);
+    label->setColor(color);
 }
 
 void GLLabelManager::setBackColor(const uint32_t id, int color) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    labels_[id].setBackColor(color);
+    label->setBackColor(color);
 }
 
 void GLLabelManager::setFill(const uint32_t id, bool fill) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    labels_[id].setFill(fill);
+    label->setFill(fill);
 }
 
 void GLLabelManager::setRotation(const uint32_t id, const float rotation, const bool absolute) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
-
-    draw_version_ = -1;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    labels_[id].setRotation(rotation, absolute);
+    label->setRotation(rotation, absolute);
 }
 
 void GLLabelManager::getSize(const uint32_t id, atakmap::math::Rectangle<double>& size_rect) NOTHROWS {
     Lock lock(mutex_);
 
-    if (map_idx_ <= id) return;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-    size_rect = labels_[id].labelRect;
+    size_rect = label->labelRect;
 
     if (size_rect.width == 0 && size_rect.height == 0) {
-        GLText2* gltext = labels_[id].gltext_;
+        GLText2* gltext = label->gltext_;
         if (!gltext)
             gltext = getDefaultText();
         if (gltext) {
-            size_rect.width = gltext->getTextFormat().getStringWidth(labels_[id].text_.c_str());
-            size_rect.height = gltext->getTextFormat().getStringHeight(labels_[id].text_.c_str());
+            size_rect.width = gltext->getTextFormat().getStringWidth(label->text_.c_str());
+            size_rect.height = gltext->getTextFormat().getStringHeight(label->text_.c_str());
         }
     }
 }
@@ -255,16 +281,14 @@ void GLLabelManager::getSize(const uint32_t id, atakmap::math::Rectangle<double>
 void GLLabelManager::setPriority(const uint32_t id, const Priority priority) NOTHROWS {
     Lock lock(mutex_);
 
-    for (auto it = label_priorities_.begin(); it != label_priorities_.end(); it++) {
-        if (it->first == priority) continue;
+    GLLabel* label = getLabel(id);
+    if (!label) return;
 
-        if (it->second.find(id) != it->second.end()) {
-            it->second.erase(id);
-        }
+    if (label->priority_ != priority) {
+        priorities_valid_ = false;
+        replace_labels_ = true;
     }
-    label_priorities_[priority].insert(id);
-
-    labels_[id].setPriority(priority);
+    label->setPriority(priority);
 }
 
 void GLLabelManager::setVisible(bool visible) NOTHROWS {
@@ -281,7 +305,10 @@ void GLLabelManager::draw(const GLGlobeBase& view, const int render_pass) NOTHRO
     defaultText = getDefaultText();
 
     if (this->batch_.get() == nullptr) {
-        this->batch_.reset(new GLRenderBatch2(0xFFFF));
+        // dense label views exceed the 16-bit index range; the batch will
+        // draw with 32-bit indices where supported and flush every 0xFFFF
+        // vertices otherwise
+        this->batch_.reset(new GLRenderBatch2(0x20000));
     }
 
     try {
@@ -302,14 +329,24 @@ void GLLabelManager::draw(const GLGlobeBase& view, const int render_pass) NOTHRO
             this->batch_->setMatrix(GL_MODELVIEW, mx);
         }
 
-        std::vector<atakmap::math::Rectangle<double>> label_placements;
-
-        if (draw_version_ != view.drawVersion) {
+        GLLabel::Placements label_placements(view.getFrameArena(), view.renderPass->left, view.renderPass->bottom, view.renderPass->right,
+                                             view.renderPass->top);
+        validatePriorities();
+
+        LayoutState layout;
+        layout.budget = placementBudget ? placementBudget : SIZE_MAX;
+        layout.deferred = false;
+        layout.placed = 0u;
+        // the camera has moved since the last frame
+        layout.motion = (draw_version_ != view.drawVersion);
+        if (layout.motion) {
             draw_version_ = view.drawVersion;
             replace_labels_ = true;
         }
-        if (always_render_idx_ != NO_ID) {
-            GLLabel& label = labels_[always_render_idx_];
+        if (replace_labels_) layout_frame_++;
+        GLLabel* always_render = (always_render_idx_ != NO_ID) ? getLabel(always_render_idx_) : nullptr;
+        if (always_render) {
+            GLLabel& label = *always_render;
 
             const Feature::Geometry2* geometry = label.getGeometry();
             if (geometry != nullptr) {
@@ -320,12 +357,18 @@ void GLLabelManager::draw(const GLGlobeBase& view, const int render_pass) NOTHRO
                 label.place(view, *gltext, label_placements);
                 label.batch(view, *gltext, *(batch_.get()));
                 label_placements.push_back(label.labelRect);
+                layout.placed++;
             }
         }
 
-        draw(view, Priority::TEP_High, label_placements);
-        draw(view, Priority::TEP_Standard, label_placements);
-        draw(view, Priority::TEP_Low, label_placements);
+        draw(view, Priority::TEP_High, label_placements, layout);
+        draw(view, Priority::TEP_Standard, label_placements, layout);
+        draw(view, Priority::TEP_Low, label_placements, layout);
+
+        // labels that were moved rather than placed are placed once the
+        // camera settles
+        replace_labels_ = layout.deferred;
+        PerformanceCounters_add(TEPC_LabelsPlaced, layout.placed);
 
         batch_->end();
 
@@ -337,24 +380,18 @@ void GLLabelManager::draw(const GLGlobeBase& view, const int render_pass) NOTHRO
     } catch (...) {
         // ignored
     }
-
-    replace_labels_ = false;
 }
 
 void GLLabelManager::draw(const GLGlobeBase& view, const Priority priority,
-                          std::vector<atakmap::math::Rectangle<double>>& label_placements) NOTHROWS {
-    auto ids_it = label_priorities_.find(priority);
-    if (ids_it == label_priorities_.end()) return;
-    auto ids = ids_it->second;
-
-    for (auto it = ids.begin(); it != ids.end(); it++) {
-        const uint32_t label_id = *it;
-        if (label_id == always_render_idx_) continue;
+                          GLLabel::Placements& label_placements, LayoutState &layout) NOTHROWS {
+    const auto &indices = label_priorities_[priority];
 
-        auto label_it = labels_.find(label_id);
-        if (label_it == labels_.end()) continue;
+    for (auto it = indices.begin(); it != indices.end(); it++) {
+        const uint32_t label_idx = *it;
+        if (label_removed_[label_idx]) continue;
+        if (label_ids_[label_idx] == always_render_idx_) continue;
 
-        GLLabel& label = label_it->second;
+        GLLabel& label = labels_[label_idx];
 
         if (label.text_.empty()) continue;
         if (!label.shouldRenderAtResolution(view.renderPass->drawMapResolution)) continue;
@@ -377,16 +414,54 @@ void GLLabelManager::draw(const GLGlobeBase& view, const Priority priority,
         GLText2* gltext = label.gltext_;
         if (!gltext) gltext = defaultText;
         if (replace_labels_) {
-            label.place(view, *gltext, label_placements);
+            if (label.layout_version_ == view.drawVersion && label.canDraw && !label.overlaps(*gltext, label_placements)) {
+                // the placement is current and remains clear
+            } else if (layout.motion && relayoutInterval > 1u && label.layout_version_ != -1 && label.layout_version_ != view.drawVersion &&
+                       ((layout_frame_ + label_idx) % relayoutInterval) != 0u) {
+                // while the camera moves, unchanged labels are placed on
+                // every `relayoutInterval` frame and moved otherwise
+                label.reproject(view);
+                layout.deferred = true;
+            } else if (layout.budget) {
+                // lower priority labels are dropped once the budget is spent
+                label.place(view, *gltext, label_placements);
+                layout.budget--;
+            } else {
+                label.canDraw = false;
+            }
         }
         if (label.canDraw) {
             label.batch(view, *gltext, *(batch_.get()));
             label_placements.push_back(label.labelRect);
+            layout.placed++;
         }
     }
 }
 
 
+GLLabel* GLLabelManager::getLabel(const uint32_t id) NOTHROWS {
+    auto it = std::lower_bound(label_ids_.begin(), label_ids_.end(), id);
+    if (it == label_ids_.end() || *it != id) return nullptr;
+    const auto idx = static_cast<std::size_t>(it - label_ids_.begin());
+    return label_removed_[idx] ? nullptr : &labels_[idx];
+}
+
+void GLLabelManager::invalidateLayout(GLLabel& label) NOTHROWS {
+    label.layout_version_ = -1;
+    replace_labels_ = true;
+}
+
+void GLLabelManager::validatePriorities() NOTHROWS {
+    if (priorities_valid_) return;
+
+    for (std::size_t i = 0u; i < 3u; i++) label_priorities_[i].clear();
+    for (std::size_t i = 0u; i < labels_.size(); i++) {
+        if (label_removed_[i]) continue;
+        label_priorities_[labels_[i].priority_].push_back((uint32_t)i);
+    }
+    priorities_valid_ = true;
+}
+
 void GLLabelManager::release() NOTHROWS {}
 
 int GLLabelManager::getRenderPass() NOTHROWS { return GLMapView2::Sprites; }
@@ -396,7 +471,13 @@ void GLLabelManager::start() NOTHROWS {}
 void GLLabelManager::stop() NOTHROWS {
     Lock lock(mutex_);
 
+    label_ids_.clear();
     labels_.clear();
+    label_removed_.clear();
+    num_removed_ = 0u;
+    for (std::size_t i = 0u; i < 3u; i++) label_priorities_[i].clear();
+    priorities_valid_ = true;
+    always_render_idx_ = NO_ID;
 }
 
 GLText2* GLLabelManager::getDefaultText() NOTHROWS {
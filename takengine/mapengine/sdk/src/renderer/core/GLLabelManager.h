@@ -61,9 +61,26 @@ namespace TAK
                     int getRenderPass() NOTHROWS override;
                     void start() NOTHROWS override;
                     void stop() NOTHROWS override;
+                private:
+                    struct LayoutState
+                    {
+                        /** remaining number of labels that may be placed */
+                        std::size_t budget;
+                        /** the camera has moved since the last frame */
+                        bool motion;
+                        /** some labels were moved rather than placed */
+                        bool deferred;
+                        /** number of labels placed for rendering this frame */
+                        std::size_t placed;
+                    };
                 private:
                     void draw(const GLGlobeBase& view, const Priority priority,
-                              std::vector<atakmap::math::Rectangle<double>>& label_placements) NOTHROWS;
+                              GLLabel::Placements& label_placements, LayoutState &layout) NOTHROWS;
+                    /** marks the placement of the label as invalid */
+                    void invalidateLayout(GLLabel& label) NOTHROWS;
+                    /** returns the label with the specified ID or `nullptr` if it does not exist */
+                    GLLabel* getLabel(const uint32_t id) NOTHROWS;
+                    void validatePriorities() NOTHROWS;
                 private:
                     static float defaultFontSize;
                     static GLText2* getDefaultText() NOTHROWS;
@@ -71,13 +88,36 @@ namespace TAK
                     float labelRotation;
                     bool absoluteLabelRotation;
                     int64_t labelFadeTimer;
+                    /**
+                     * The maximum number of labels placed per frame, in
+                     * priority order; `0` for no limit. Labels beyond the
+                     * budget are not drawn.
+                     */
+                    std::size_t placementBudget;
+                    /**
+                     * While the camera moves, each unchanged label is placed
+                     * on one of every `relayoutInterval` frames; otherwise
+                     * its previous placement is moved with the scene. `1`
+                     * places all labels on every frame.
+                     */
+                    std::size_t relayoutInterval;
                 private:
-                    std::map<uint32_t, GLLabel> labels_;
-                    std::map<Priority, std::set<uint32_t>> label_priorities_;
+                    /** IDs of `labels_`, ascending; IDs are assigned monotonically */
+                    std::vector<uint32_t> label_ids_;
+                    std::vector<GLLabel> labels_;
+                    /** removed labels are compacted lazily */
+                    std::vector<bool> label_removed_;
+                    std::size_t num_removed_;
+                    /** indices into `labels_`, ascending, per priority */
+                    std::vector<uint32_t> label_priorities_[3u];
+                    bool priorities_valid_;
                     uint32_t map_idx_;
                     uint32_t always_render_idx_;
                     int draw_version_;
+                    /** labels need placement */
                     bool replace_labels_;
+                    /** counts frames in which labels were placed; staggers relayout */
+                    uint32_t layout_frame_;
                     Thread::Mutex mutex_;
                     std::unique_ptr<TAK::Engine::Renderer::GLRenderBatch2> batch_;
                     bool visible_;
@@ -1,6 +1,7 @@
 #include "renderer/core/GLLayerFactory2.h"
 
-#include "thread/RWMutex.h"
+#include "renderer/core/GLPreparable.h"
+#include "thread/ReadCopyUpdate.h"
 
 using namespace TAK::Engine::Renderer::Core;
 
@@ -44,24 +45,33 @@ namespace
         Layer2 &getSubject() NOTHROWS override;
     public :
         TAKErr layerVisibilityChanged(const Layer2 &layer_subject, const bool visible) NOTHROWS override;
-    private :
+    protected :
         Layer2 &subject_;
         GLMapRenderable2Ptr impl_;
         bool visible_;
     };
 
-    std::set<Spi2Entry, Spi2EntryComp> &spis()
+    /** forwards the prepare phase to a `GLPreparable` renderer */
+    class PreparableGLMapRenderable2Layer : public GLMapRenderable2Layer,
+                                            public GLPreparable
     {
-        static std::set<Spi2Entry, Spi2EntryComp> s;
-        return s;
-    }
+    public :
+        PreparableGLMapRenderable2Layer(Layer2 &subject, GLMapRenderable2Ptr &&impl, GLPreparable &preparable) NOTHROWS;
+    public :
+        void prepare(const std::shared_ptr<const GLGlobeBase::State> &state) NOTHROWS override;
+    private :
+        GLPreparable &preparable_;
+    };
 
-    RWMutex &mutex()
+    typedef std::set<Spi2Entry, Spi2EntryComp> Spi2Registry;
+
+    ReadCopyUpdate<Spi2Registry> &spis()
     {
-        static RWMutex m;
-        return m;
+        static ReadCopyUpdate<Spi2Registry> s;
+        return s;
     }
 
+    // only accessed by writers, which are serialized by `spis()`
     std::size_t &inserts()
     {
         static std::size_t i;
@@ -71,41 +81,38 @@ namespace
 
 TAKErr TAK::Engine::Renderer::Core::GLLayerFactory2_registerSpi(const std::shared_ptr<GLLayerSpi2> &spi, const int priority) NOTHROWS
 {
-    WriteLock lock(mutex());
-
-    std::set<Spi2Entry, Spi2EntryComp> &registry = spis();
-
     Spi2Entry entry;
     entry.spi = spi;
     entry.priority = priority;
-    entry.insert = inserts()++;
 
-    registry.insert(entry);
-    return TE_Ok;
+    return spis().update([&entry](Spi2Registry &registry) -> TAKErr
+    {
+        entry.insert = inserts()++;
+        registry.insert(entry);
+        return TE_Ok;
+    });
 }
 TAKErr TAK::Engine::Renderer::Core::GLLayerFactory2_unregisterSpi(const GLLayerSpi2 &spi) NOTHROWS
 {
-    WriteLock lock(mutex());
-
-    std::set<Spi2Entry, Spi2EntryComp> &registry = spis();
-    std::set<Spi2Entry, Spi2EntryComp>::iterator it;
-    for (it = registry.begin(); it != registry.end(); it++)
+    return spis().update([&spi](Spi2Registry &registry) -> TAKErr
     {
-        if ((*it).spi.get() == &spi)
+        Spi2Registry::iterator it;
+        for (it = registry.begin(); it != registry.end(); it++)
         {
-            registry.erase(it);
-            return TE_Ok;
+            if ((*it).spi.get() == &spi)
+            {
+                registry.erase(it);
+                return TE_Ok;
+            }
         }
-    }
-    return TE_InvalidArg;
+        return TE_InvalidArg;
+    });
 }
 TAKErr TAK::Engine::Renderer::Core::GLLayerFactory2_create(GLLayer2Ptr &value, GLGlobeBase& view, TAK::Engine::Core::Layer2 &subject) NOTHROWS
 {
-    ReadLock lock(mutex());
-
-    std::set<Spi2Entry, Spi2EntryComp> &registry = spis();
-    std::set<Spi2Entry, Spi2EntryComp>::iterator it;
-    for (it = registry.begin(); it != registry.end(); it++)
+    ReadCopyUpdate<Spi2Registry>::ReadGuard registry(spis());
+    Spi2Registry::const_iterator it;
+    for (it = registry->begin(); it != registry->end(); it++)
     {
         if ((*it).spi->create(value, view, subject) == TE_Ok)
             return TE_Ok;
@@ -118,7 +125,12 @@ TAKErr TAK::Engine::Renderer::Core::GLLayerFactory2_create(GLLayer2Ptr &value, L
 {
     if (!renderer.get())
         return TE_InvalidArg;
-    value = GLLayer2Ptr(new GLMapRenderable2Layer(subject, std::move(renderer)), Memory_deleter_const<GLLayer2, GLMapRenderable2Layer>);
+    // `GLGlobeBase` discovers preparables by type; the wrapper must expose
+    // the interface of the renderer it adapts
+    if (auto preparable = dynamic_cast<GLPreparable *>(renderer.get()))
+        value = GLLayer2Ptr(new PreparableGLMapRenderable2Layer(subject, std::move(renderer), *preparable), Memory_deleter_const<GLLayer2, PreparableGLMapRenderable2Layer>);
+    else
+        value = GLLayer2Ptr(new GLMapRenderable2Layer(subject, std::move(renderer)), Memory_deleter_const<GLLayer2, GLMapRenderable2Layer>);
     return TE_Ok;
 }
 
@@ -164,4 +176,16 @@ namespace
         this->visible_ = visible;
         return TE_Ok;
     }
+
+    PreparableGLMapRenderable2Layer::PreparableGLMapRenderable2Layer(Layer2 &subject_, GLMapRenderable2Ptr &&impl_, GLPreparable &preparable_) NOTHROWS :
+        GLMapRenderable2Layer(subject_, std::move(impl_)),
+        preparable_(preparable_)
+    {}
+
+    void PreparableGLMapRenderable2Layer::prepare(const std::shared_ptr<const GLGlobeBase::State> &state) NOTHROWS
+    {
+        if (!visible_)
+            return;
+        preparable_.prepare(state);
+    }
 }
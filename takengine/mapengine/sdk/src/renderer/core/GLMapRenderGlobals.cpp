@@ -1,13 +1,18 @@
 #include "renderer/core/GLMapRenderGlobals.h"
+#include "renderer/GLText2.h"
 #ifndef __ANDROID__
 #include "renderer/core/GLLabelManager.h"
 #endif
 #include <util/NonCopyable.h>
 
 #include "core/AtakMapView.h"
+#include "renderer/GLOffscreenFramebuffer.h"
+#include "renderer/GLSLUtil.h"
 #include "thread/Lock.h"
 #include "thread/Mutex.h"
 #include "util/ConfigOptions.h"
+#include "util/Memory.h"
+#include "util/MemoryTrim.h"
 
 using namespace TAK::Engine::Renderer;
 
@@ -19,6 +24,7 @@ using namespace atakmap::renderer;
 
 // defaults
 #define TE_GLMRG_TEXTURE_CACHE_SIZE (100*1024*1024)
+#define TE_GLMRG_TEXTURE_CACHE_CPU_SIZE (16*1024*1024)
 #define TE_GLMRG_TEXTURE_ATLAS_SIZE 1024
 #define TE_GLMRG_ASYNC_BITMAP_LOADER_THREADS 8
 
@@ -30,6 +36,40 @@ using namespace atakmap::renderer;
 
 namespace
 {
+    struct Context;
+
+    /**
+     * Trims the GL resident caches shared by a context. Releasing textures
+     * must happen on the render thread, so trimming is queued as an event
+     * that executes between frames.
+     *
+     * The trimmer is unregistered when its context is released via
+     * `GLMapRenderGlobals_releaseContext`, which must occur before the
+     * `RenderContext` is destroyed. Queued requests only hold a weak
+     * reference to the context.
+     */
+    class ContextTrimmer : public MemoryTrimmable
+    {
+    private :
+        struct TrimRequest
+        {
+            std::weak_ptr<Context> context;
+            MemoryTrimLevel level;
+        };
+    public :
+        ContextTrimmer(RenderContext &ctx) NOTHROWS;
+        ~ContextTrimmer() NOTHROWS override;
+    public :
+        void trim(const MemoryTrimLevel level) NOTHROWS override;
+    private :
+        static void glTrim(void *opaque) NOTHROWS;
+    private :
+        RenderContext &ctx;
+    public :
+        /** assigned once the owning context has been created */
+        std::weak_ptr<Context> context;
+    };
+
     struct Context : TAK::Engine::Util::NonCopyable
     {
         std::unique_ptr<GLTextureAtlas> atlas;
@@ -42,9 +82,27 @@ namespace
         std::unique_ptr<GLTextureAtlas2> atlas2;
         std::unique_ptr<GLTextureAtlas2> iconAtlas2;
         std::unique_ptr<GLTextureCache2> cache2;
+
+        Context(const RenderContext &ctx) NOTHROWS :
+            trimmer(const_cast<RenderContext &>(ctx))
+        {}
+
+        ContextTrimmer trimmer;
     };
 
-    std::map<const RenderContext *, std::unique_ptr<Context>> contextMap;
+    std::shared_ptr<Context> createContext(const RenderContext &ctx)
+    {
+        std::shared_ptr<Context> context(new Context(ctx));
+        context->trimmer.context = context;
+
+        // the program cache is process wide; no-op if the directory is unchanged
+        TAK::Engine::Port::String programCacheDir;
+        if (ConfigOptions_getOption(programCacheDir, "glslutil.program-cache-dir") == TE_Ok && programCacheDir)
+            GLSLUtil_setProgramCacheDirectory(programCacheDir);
+        return context;
+    }
+
+    std::map<const RenderContext *, std::shared_ptr<Context>> contextMap;
     Mutex contextMapMutex;
 
     std::size_t maxTextureUnits(0);
@@ -59,11 +117,11 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getTextureAtlas(GLTexture
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
@@ -81,11 +139,11 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getIconAtlas(GLTextureAtl
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
@@ -103,11 +161,11 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getTextureCache(GLTexture
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
@@ -152,11 +210,11 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getBitmapLoader(TAK::Engi
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
@@ -180,11 +238,11 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getTextureAtlas2(GLTextur
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
@@ -202,18 +260,21 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getIconAtlas2(GLTextureAt
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
     } while (true);
 
     if (!entry->second->iconAtlas2.get()) {
-        entry->second->iconAtlas2.reset(new GLTextureAtlas2(TE_GLMRG_TEXTURE_ATLAS_SIZE, static_cast<std::size_t>(GLMapRenderGlobals_getNominalIconSize()*atakmap::core::AtakMapView::DENSITY)));
+        // the dynamic atlas evicts unused icons, keeping the icons in view on
+        // as few textures as possible
+        const bool dynamic = (ConfigOptions_getIntOptionOrDefault("glmaprenderglobals.dynamic-icon-atlas", 1) != 0);
+        entry->second->iconAtlas2.reset(new GLTextureAtlas2(TE_GLMRG_TEXTURE_ATLAS_SIZE, static_cast<std::size_t>(GLMapRenderGlobals_getNominalIconSize()*atakmap::core::AtakMapView::DENSITY), dynamic));
     }
     *value = entry->second->iconAtlas2.get();
     return TE_Ok;
@@ -226,18 +287,18 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getTextureCache2(GLTextur
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext *, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext *, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
     } while (true);
 
     if (!entry->second->cache2.get())
-        entry->second->cache2.reset(new GLTextureCache2(TE_GLMRG_TEXTURE_CACHE_SIZE));
+        entry->second->cache2.reset(new GLTextureCache2(TE_GLMRG_TEXTURE_CACHE_SIZE, TE_GLMRG_TEXTURE_CACHE_CPU_SIZE, const_cast<RenderContext &>(ctx)));
     *value = entry->second->cache2.get();
     return TE_Ok;
 }
@@ -249,11 +310,11 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_getLabelManager(TAK::Engi
     Lock lock(contextMapMutex);
     code = lock.status;
     TE_CHECKRETURN_CODE(code);
-    std::map<const RenderContext*, std::unique_ptr<Context>>::iterator entry;
+    std::map<const RenderContext*, std::shared_ptr<Context>>::iterator entry;
     do {
         entry = contextMap.find(&ctx);
         if (entry == contextMap.end()) {
-            contextMap[&ctx] = std::unique_ptr<Context>(new Context);
+            contextMap[&ctx] = createContext(ctx);
             continue;
         }
         break;
@@ -296,3 +357,66 @@ TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_setTextureUnitLimit(const
     textureUnitLimit = limit;
     return TE_Ok;
 }
+
+TAKErr TAK::Engine::Renderer::Core::GLMapRenderGlobals_releaseContext(const RenderContext &ctx) NOTHROWS
+{
+    std::shared_ptr<Context> context;
+    {
+        Lock lock(contextMapMutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        auto entry = contextMap.find(&ctx);
+        if (entry != contextMap.end()) {
+            context = std::move(entry->second);
+            contextMap.erase(entry);
+        }
+    }
+    // destruct outside of the lock; unregistering the trimmer waits on any
+    // trim that is in progress
+    context.reset();
+    // framebuffer objects belong to the context
+    GLOffscreenFramebuffer_releasePool(ctx);
+    return TE_Ok;
+}
+
+namespace
+{
+    ContextTrimmer::ContextTrimmer(RenderContext &ctx_) NOTHROWS :
+        ctx(ctx_)
+    {
+        MemoryTrim_registerTrimmable(*this);
+    }
+    ContextTrimmer::~ContextTrimmer() NOTHROWS
+    {
+        MemoryTrim_unregisterTrimmable(*this);
+    }
+    void ContextTrimmer::trim(const MemoryTrimLevel level) NOTHROWS
+    {
+        std::unique_ptr<TrimRequest> request(new(std::nothrow) TrimRequest());
+        if (!request)
+            return;
+        request->context = context;
+        request->level = level;
+        // always deferred, even on the render thread; the request may hold
+        // the last reference to a concurrently released context, which must
+        // not be destructed while the trim registry is locked
+        ctx.queueEvent(glTrim, std::unique_ptr<void, void(*)(const void *)>(request.release(), Memory_void_deleter_const<TrimRequest>));
+    }
+    void ContextTrimmer::glTrim(void *opaque) NOTHROWS
+    {
+        const TrimRequest &request = *static_cast<const TrimRequest *>(opaque);
+        std::shared_ptr<Context> context(request.context.lock());
+        // the context was released after the request was queued
+        if (!context)
+            return;
+        GLTextureCache2 *cache2 = context->cache2.get();
+        if (cache2)
+            cache2->trim(MemoryTrimLevel_getBudget(request.level, cache2->getMaxSize()));
+        GLTextureAtlas2 *iconAtlas2 = context->iconAtlas2.get();
+        if (iconAtlas2)
+            iconAtlas2->compact();
+        // glyphs are cheap to reload, but reloading every glyph in view
+        // introduces a frame hitch; only release under severe pressure
+        if (request.level >= TETL_Critical)
+            GLText2_releaseGlyphs();
+    }
+}
@@ -34,6 +34,15 @@ namespace TAK {
 
 				ENGINE_API TAK::Engine::Util::TAKErr GLMapRenderGlobals_getTextureUnitLimit(std::size_t *limit) NOTHROWS;
 				ENGINE_API TAK::Engine::Util::TAKErr GLMapRenderGlobals_setTextureUnitLimit(const std::size_t limit) NOTHROWS;
+
+				/**
+				 * Releases the globals associated with the specified context.
+				 * Must be invoked before the context is destroyed, once all
+				 * renderers using the context have been released; should be
+				 * invoked on the render thread so that GL resources may be
+				 * deleted.
+				 */
+				ENGINE_API TAK::Engine::Util::TAKErr GLMapRenderGlobals_releaseContext(const TAK::Engine::Core::RenderContext &ctx) NOTHROWS;
             }
         }
     }
@@ -45,6 +45,7 @@
 #include "util/ConfigOptions.h"
 #include "util/Memory.h"
 #include "util/MathUtils.h"
+#include "util/ScratchArena.h"
 #include "util/Distance.h"
 
 using namespace TAK::Engine::Renderer::Core;
@@ -897,10 +898,11 @@ void GLMapView2::drawRenderables() NOTHROWS
     if (terrainUpdate) {
         DebugTimer te_timer("Terrain Update", *this, diagnosticMessagesEnabled);
 
-        std::list<std::shared_ptr<const TerrainTile>> terrainTiles;
+        typedef ScratchAllocator<std::shared_ptr<const TerrainTile>> TileAllocator;
+        std::list<std::shared_ptr<const TerrainTile>, TileAllocator> terrainTiles{TileAllocator(getFrameArena())};
         int terrainTilesVersion = -1;
 
-        STLListAdapter<std::shared_ptr<const TerrainTile>> tta(terrainTiles);
+        STLListAdapter<std::shared_ptr<const TerrainTile>, TileAllocator> tta(terrainTiles);
         terrainTilesVersion = terrain->getTerrainVersion();
         terrain->lock(tta, this->renderPasses[0u].scene, 4326, this->renderPasses[0u].drawVersion);
         if (!this->offscreen.get()) {
@@ -937,7 +939,7 @@ void GLMapView2::drawRenderables() NOTHROWS
             this->offscreen->lastTerrainVersion = terrainTilesVersion;
         }
 
-        std::vector<GLuint> ids;
+        std::vector<GLuint, ScratchAllocator<GLuint>> ids{ScratchAllocator<GLuint>(getFrameArena())};
         ids.reserve(staleTiles.size()*2u);
 
         for(auto it = staleTiles.begin(); it != staleTiles.end(); it++) {
@@ -1615,11 +1617,14 @@ TAKErr GLMapView2::inverse(MapRenderer::InverseResult *result, GeoPoint2 *value,
     if(!value)
         return TE_InvalidArg;
     Point2<double> xyz(screen);
-    MapSceneModel2 sm;
-    {
+    // the scene as of the last published frame; no copy required
+    const std::shared_ptr<const State> published(getRenderState());
+    MapSceneModel2 unpublished;
+    if (!published) {
         ReadLock rlock(renderPasses0Mutex);
-        sm = renderPasses[0].scene;
+        unpublished = renderPasses[0].scene;
     }
+    const MapSceneModel2 &sm = published ? published->scene : unpublished;
     if(origin == MapRenderer::UpperLeft)
         xyz.y = (sm.height - xyz.y);
     switch(mode) {
@@ -3246,7 +3251,7 @@ namespace
         if(gltile.vbo) {
             // VBO
             glBindBuffer(GL_ARRAY_BUFFER, gltile.vbo);
-            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GL_FLOAT, false, static_cast<GLsizei>(layout.position.stride), (void *)layout.position.offset);
+            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GLTerrainTile_getPositionType(tile), false, static_cast<GLsizei>(layout.position.stride), (void *)layout.position.offset);
             glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
         } else {
             const void *vertexCoords;
@@ -3256,7 +3261,7 @@ namespace
                 return;
             }
 
-            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GL_FLOAT, false, static_cast<GLsizei>(layout.position.stride), static_cast<const uint8_t *>(vertexCoords) + layout.position.offset);
+            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GLTerrainTile_getPositionType(tile), false, static_cast<GLsizei>(layout.position.stride), static_cast<const uint8_t *>(vertexCoords) + layout.position.offset);
         }
 
         std::size_t numIndicesWireframe = 0u;
@@ -0,0 +1,6 @@
+#include "renderer/core/GLPreparable.h"
+
+using namespace TAK::Engine::Renderer::Core;
+
+GLPreparable::~GLPreparable() NOTHROWS
+{}
@@ -0,0 +1,54 @@
+#ifndef TAK_ENGINE_RENDERER_CORE_GLPREPARABLE_H_INCLUDED
+#define TAK_ENGINE_RENDERER_CORE_GLPREPARABLE_H_INCLUDED
+
+#include <memory>
+
+#include "port/Platform.h"
+#include "renderer/core/GLGlobeBase.h"
+#include "util/Error.h"
+
+namespace TAK
+{
+    namespace Engine
+    {
+        namespace Renderer
+        {
+            namespace Core
+            {
+                /**
+                 * Optional interface for layer renderers that can split the
+                 * CPU work for a frame (culling, level of detail selection,
+                 * draw list construction) from the GL submission performed in
+                 * `draw`.
+                 *
+                 * <P>Each frame, `GLGlobeBase` invokes `prepare` on all
+                 * preparable renderables concurrently, on worker threads,
+                 * before any renderable is drawn. `draw` is not invoked until
+                 * all `prepare` calls for the frame have returned.
+                 */
+                class ENGINE_API GLPreparable
+                {
+                protected :
+                    virtual ~GLPreparable() NOTHROWS = 0;
+                public :
+                    /**
+                     * Prepares the renderable for the next `draw`.
+                     *
+                     * <P>Invoked on a worker thread. Implementations must not
+                     * issue GL calls, access the view or block on the GL
+                     * thread.
+                     *
+                     * @param state The render state published for the
+                     *              frame (see `GLGlobeBase::getRenderState`).
+                     *              It is immutable; implementations that need
+                     *              it beyond the call should retain the
+                     *              shared snapshot rather than copying.
+                     */
+                    virtual void prepare(const std::shared_ptr<const GLGlobeBase::State> &state) NOTHROWS = 0;
+                };
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,333 @@
+#include "renderer/core/GLTerrainOcclusion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "renderer/GLMatrix.h"
+#include "renderer/RenderState.h"
+#include "renderer/elevation/GLTerrainTile.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Renderer::Core;
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Renderer::Elevation;
+using namespace TAK::Engine::Util;
+
+// the capture is reduced by this factor relative to the scene
+#define TERRAIN_OCCLUSION_SUBSAMPLE 8u
+#define TERRAIN_OCCLUSION_MAX_SIZE 256u
+// depth tolerance, in window depth, for the terrain surface
+#define TERRAIN_OCCLUSION_BIAS 1e-6f
+
+namespace
+{
+    float decodeDepth(const uint8_t *px) NOTHROWS;
+    void setOrtho(Matrix2 *value, const double left, const double right, const double bottom, const double top, const double zNear, const double zFar) NOTHROWS;
+}
+
+TerrainOcclusion::TerrainOcclusion(const MapSceneModel2 &scene, DepthPyramid &&depth_) NOTHROWS :
+    depth(std::move(depth_)),
+    location(scene.camera.location),
+    target(scene.camera.target),
+    width(scene.width),
+    height(scene.height),
+    srid(scene.projection ? scene.projection->getSpatialReferenceID() : -1)
+{
+    // mirror the MVP selected by `GLTerrainTile_begin`
+    if (scene.camera.mode == MapCamera2::Perspective) {
+        mvp = scene.camera.projection;
+        mvp.concatenate(scene.camera.modelView);
+    } else {
+        setOrtho(&mvp, 0.0, (double)scene.width, 0.0, (double)scene.height, scene.camera.near, scene.camera.far);
+        mvp.concatenate(scene.forwardTransform);
+    }
+}
+
+bool TerrainOcclusion::isOccluded(const AABB &aabb) const NOTHROWS
+{
+    if (!depth.getWidth() || !depth.getHeight())
+        return false;
+
+    double mx[16u];
+    mvp.get(mx, Matrix2::ROW_MAJOR);
+
+    double minX = INFINITY;
+    double minY = INFINITY;
+    double maxX = -INFINITY;
+    double maxY = -INFINITY;
+    double nearest = INFINITY;
+    for (std::size_t i = 0u; i < 8u; i++) {
+        const double x = (i & 0x1u) ? aabb.maxX : aabb.minX;
+        const double y = (i & 0x2u) ? aabb.maxY : aabb.minY;
+        const double z = (i & 0x4u) ? aabb.maxZ : aabb.minZ;
+
+        const double cw = (x * mx[12]) + (y * mx[13]) + (z * mx[14]) + mx[15];
+        // any part of the box at or behind the eye is visible
+        if (cw <= 0.0)
+            return false;
+        const double cx = (x * mx[0]) + (y * mx[1]) + (z * mx[2]) + mx[3];
+        const double cy = (x * mx[4]) + (y * mx[5]) + (z * mx[6]) + mx[7];
+        const double cz = (x * mx[8]) + (y * mx[9]) + (z * mx[10]) + mx[11];
+
+        const double px = ((cx / cw) * 0.5 + 0.5) * (double)depth.getWidth();
+        const double py = ((cy / cw) * 0.5 + 0.5) * (double)depth.getHeight();
+        minX = std::min(minX, px);
+        minY = std::min(minY, py);
+        maxX = std::max(maxX, px);
+        maxY = std::max(maxY, py);
+        // eye depth is affine over the box, so its nearest point is a corner
+        nearest = std::min(nearest, (cz / cw) * 0.5 + 0.5);
+    }
+    if (nearest < 0.0)
+        return false;
+
+    // expand by a pixel; the capture samples only pixel centers
+    const float farthest = depth.getFarthest(
+        (int)floor(minX) - 1, (int)floor(minY) - 1,
+        (int)ceil(maxX) + 1, (int)ceil(maxY) + 1);
+    if (isnan(farthest))
+        return false;
+    return (farthest + TERRAIN_OCCLUSION_BIAS) < (float)nearest;
+}
+
+bool TerrainOcclusion::isCurrent(const MapSceneModel2 &scene) const NOTHROWS
+{
+    return scene.camera.location == location &&
+        scene.camera.target == target &&
+        scene.width == width &&
+        scene.height == height &&
+        scene.projection && scene.projection->getSpatialReferenceID() == srid;
+}
+
+GLTerrainOcclusion::GLTerrainOcclusion(const RenderContext &ctx_) NOTHROWS :
+    ctx(ctx_),
+    fbo(nullptr, nullptr),
+    pbo(GL_NONE)
+#if TE_GLES_VERSION >= 3
+    , fence(nullptr)
+#endif
+{
+    captured.width = 0u;
+    captured.height = 0u;
+    captured.terrainVersion = -1;
+    captured.elevationScale = 1.f;
+    captured.valid = false;
+}
+
+GLTerrainOcclusion::~GLTerrainOcclusion() NOTHROWS
+{
+    release();
+}
+
+TAKErr GLTerrainOcclusion::update(const MapSceneModel2 &scene, const GLTerrainTile *tiles, const std::size_t numTiles, const int terrainVersion, const float elevationScale) NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    TAKErr code(TE_Ok);
+    if (!scene.projection || !scene.width || !scene.height)
+        return TE_InvalidArg;
+
+    if (fence) {
+        code = collect();
+        // the previous capture is still in flight
+        if (code == TE_Busy)
+            return TE_Ok;
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    if (captured.valid &&
+        captured.location == scene.camera.location &&
+        captured.target == scene.camera.target &&
+        captured.width == scene.width &&
+        captured.height == scene.height &&
+        captured.terrainVersion == terrainVersion &&
+        captured.elevationScale == elevationScale) {
+
+        return TE_Ok;
+    }
+
+    if (!numTiles) {
+        occlusion.reset();
+        return TE_Ok;
+    }
+
+    code = render(scene, tiles, numTiles, elevationScale);
+    TE_CHECKRETURN_CODE(code);
+
+    captured.location = scene.camera.location;
+    captured.target = scene.camera.target;
+    captured.width = scene.width;
+    captured.height = scene.height;
+    captured.terrainVersion = terrainVersion;
+    captured.elevationScale = elevationScale;
+    captured.valid = true;
+
+    return code;
+#else
+    return TE_Unsupported;
+#endif
+}
+
+std::shared_ptr<const TerrainOcclusion> GLTerrainOcclusion::get() const NOTHROWS
+{
+    return occlusion;
+}
+
+void GLTerrainOcclusion::release() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    if (fence) {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+#endif
+    if (pbo) {
+        glDeleteBuffers(1u, &pbo);
+        pbo = GL_NONE;
+    }
+    fbo.reset();
+    occlusion.reset();
+    captured.valid = false;
+}
+
+TAKErr GLTerrainOcclusion::collect() NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    const GLenum status = glClientWaitSync(fence, 0, 0u);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return TE_Busy;
+    glDeleteSync(fence);
+    fence = nullptr;
+    if (status == GL_WAIT_FAILED)
+        return TE_Err;
+
+    const auto w = (std::size_t)fbo->width;
+    const auto h = (std::size_t)fbo->height;
+    std::vector<float> depth(w*h);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    const auto *pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)(w*h*4u), GL_MAP_READ_BIT));
+    if (pixels) {
+        for (std::size_t i = 0u; i < depth.size(); i++)
+            depth[i] = decodeDepth(pixels + (i*4u));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    if (!pixels)
+        return TE_Err;
+
+    DepthPyramid pyramid;
+    TAKErr code = pyramid.build(depth.data(), w, h);
+    TE_CHECKRETURN_CODE(code);
+    occlusion = std::make_shared<TerrainOcclusion>(pendingScene, std::move(pyramid));
+    return code;
+#else
+    return TE_Unsupported;
+#endif
+}
+
+TAKErr GLTerrainOcclusion::render(const MapSceneModel2 &scene, const GLTerrainTile *tiles, const std::size_t numTiles, const float elevationScale) NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    TAKErr code(TE_Ok);
+
+    const TerrainTileShaders shaders = GLTerrainTile_getOcclusionShader(ctx, scene.projection->getSpatialReferenceID());
+    if (!shaders.lo.base.handle)
+        return TE_Unsupported;
+
+    // size the capture
+    std::size_t w = std::max(scene.width / TERRAIN_OCCLUSION_SUBSAMPLE, (std::size_t)1u);
+    std::size_t h = std::max(scene.height / TERRAIN_OCCLUSION_SUBSAMPLE, (std::size_t)1u);
+    if (std::max(w, h) > TERRAIN_OCCLUSION_MAX_SIZE) {
+        const double scale = (double)TERRAIN_OCCLUSION_MAX_SIZE / (double)std::max(w, h);
+        w = std::max((std::size_t)(w*scale), (std::size_t)1u);
+        h = std::max((std::size_t)(h*scale), (std::size_t)1u);
+    }
+
+    if (!fbo || fbo->width != (int)w || fbo->height != (int)h) {
+        GLOffscreenFramebuffer::Options opts;
+        opts.colorFormat = GL_RGBA;
+        opts.colorInternalFormat = GL_RGBA8;
+        opts.colorType = GL_UNSIGNED_BYTE;
+        opts.depthFormat = GL_DEPTH_COMPONENT;
+        opts.depthInternalFormat = GL_DEPTH_COMPONENT16;
+        opts.depthType = GL_UNSIGNED_SHORT;
+        fbo.reset();
+        code = GLOffscreenFramebuffer_borrow(fbo, ctx, (int)w, (int)h, opts);
+        TE_CHECKRETURN_CODE(code);
+
+        if (!pbo)
+            glGenBuffers(1u, &pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)(w*h*4u), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    }
+
+    RenderState restore = RenderState_getCurrent();
+    GLint boundFbo;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFbo);
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+    // clear to beyond the far plane; nothing drawn never occludes
+    glClearColor(1.f, 1.f, 1.f, 1.f);
+    glDepthMask(GL_TRUE);
+    fbo->bind();
+    glViewport(0, 0, (GLsizei)w, (GLsizei)h);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDisable(GL_BLEND);
+
+    Matrix2 lla2tex(0.0, 0.0, 0.0, 0.5,
+                    0.0, 0.0, 0.0, 0.5,
+                    0.0, 0.0, 0.0, 0.0,
+                    0.0, 0.0, 0.0, 1.0);
+    auto tctx = GLTerrainTile_begin(scene, shaders);
+    GLTerrainTile_setElevationScale(tctx, elevationScale);
+    GLTerrainTile_drawTerrainTiles(tctx, lla2tex, tiles, numTiles, 1.f, 1.f, 1.f, 1.f);
+    GLTerrainTile_end(tctx);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glReadPixels(0, 0, (GLsizei)w, (GLsizei)h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pendingScene = scene;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFbo);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    RenderState_makeCurrent(restore);
+
+    return code;
+#else
+    return TE_Unsupported;
+#endif
+}
+
+namespace
+{
+    // inverse of `PackDepth` in the occlusion shader
+    float decodeDepth(const uint8_t *px) NOTHROWS
+    {
+        return (px[0] / 255.f) +
+            (px[1] / 255.f) / 255.f +
+            (px[2] / 255.f) / 65025.f +
+            (px[3] / 255.f) / 16581375.f;
+    }
+
+    void setOrtho(Matrix2 *value, const double left, const double right, const double bottom, const double top, const double zNear, const double zFar) NOTHROWS
+    {
+        float mxf[16u];
+        atakmap::renderer::GLMatrix::orthoM(mxf,
+            static_cast<float>(left), static_cast<float>(right),
+            static_cast<float>(bottom), static_cast<float>(top),
+            static_cast<float>(zNear), static_cast<float>(zFar));
+        for(std::size_t i = 0u; i < 16u; i++)
+            value->set(i%4, i/4, mxf[i]);
+    }
+}
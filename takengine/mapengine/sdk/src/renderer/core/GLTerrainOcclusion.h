@@ -0,0 +1,111 @@
+#ifndef TAK_ENGINE_RENDERER_CORE_GLTERRAINOCCLUSION_H_INCLUDED
+#define TAK_ENGINE_RENDERER_CORE_GLTERRAINOCCLUSION_H_INCLUDED
+
+#include <memory>
+
+#include "core/MapSceneModel2.h"
+#include "core/RenderContext.h"
+#include "math/AABB.h"
+#include "math/Matrix2.h"
+#include "port/Platform.h"
+#include "renderer/DepthPyramid.h"
+#include "renderer/GL.h"
+#include "renderer/GLOffscreenFramebuffer.h"
+#include "renderer/elevation/GLTerrainTile_decls.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Renderer {
+            namespace Core {
+                /**
+                 * A low resolution terrain depth buffer captured from a
+                 * scene. Instances are immutable and may be shared with
+                 * worker threads.
+                 */
+                class ENGINE_API TerrainOcclusion
+                {
+                public :
+                    TerrainOcclusion(const TAK::Engine::Core::MapSceneModel2 &scene, DepthPyramid &&depth) NOTHROWS;
+                public :
+                    /**
+                     * Returns `true` if the specified box, in the
+                     * coordinates of the scene projection, is entirely
+                     * behind the terrain as seen from the captured scene.
+                     */
+                    bool isOccluded(const TAK::Engine::Math::AABB &aabb) const NOTHROWS;
+                    /**
+                     * Returns `true` if the depth was captured from the
+                     * camera of the specified scene. Stale results lag the
+                     * camera and should only inform load prioritization.
+                     */
+                    bool isCurrent(const TAK::Engine::Core::MapSceneModel2 &scene) const NOTHROWS;
+                private :
+                    DepthPyramid depth;
+                    TAK::Engine::Math::Matrix2 mvp;
+                    TAK::Engine::Math::Point2<double> location;
+                    TAK::Engine::Math::Point2<double> target;
+                    std::size_t width;
+                    std::size_t height;
+                    int srid;
+                };
+
+                /**
+                 * Renders the terrain depth at reduced resolution and
+                 * reads it back asynchronously, producing a
+                 * `TerrainOcclusion` one or two frames later.
+                 */
+                class GLTerrainOcclusion
+                {
+                public :
+                    GLTerrainOcclusion(const TAK::Engine::Core::RenderContext &ctx) NOTHROWS;
+                    ~GLTerrainOcclusion() NOTHROWS;
+                public :
+                    /**
+                     * Collects the completed readback, if any, then renders
+                     * the specified tiles if the camera or terrain have
+                     * changed since the last capture. Must be invoked on
+                     * the GL thread outside of a render pass; the bound
+                     * framebuffer and viewport are restored.
+                     */
+                    Util::TAKErr update(const TAK::Engine::Core::MapSceneModel2 &scene, const Elevation::GLTerrainTile *tiles, const std::size_t numTiles, const int terrainVersion, const float elevationScale) NOTHROWS;
+                    /**
+                     * Returns the most recent capture, or `nullptr` if none
+                     * is available.
+                     */
+                    std::shared_ptr<const TerrainOcclusion> get() const NOTHROWS;
+                    /**
+                     * Releases all GL resources. Must be invoked on the GL
+                     * thread.
+                     */
+                    void release() NOTHROWS;
+                private :
+                    Util::TAKErr collect() NOTHROWS;
+                    Util::TAKErr render(const TAK::Engine::Core::MapSceneModel2 &scene, const Elevation::GLTerrainTile *tiles, const std::size_t numTiles, const float elevationScale) NOTHROWS;
+                private :
+                    const TAK::Engine::Core::RenderContext &ctx;
+                    GLOffscreenFramebufferPtr fbo;
+                    GLuint pbo;
+#if TE_GLES_VERSION >= 3
+                    GLsync fence;
+#endif
+                    /** the scene the pending readback was rendered from */
+                    TAK::Engine::Core::MapSceneModel2 pendingScene;
+                    std::shared_ptr<const TerrainOcclusion> occlusion;
+                    struct
+                    {
+                        TAK::Engine::Math::Point2<double> location;
+                        TAK::Engine::Math::Point2<double> target;
+                        std::size_t width;
+                        std::size_t height;
+                        int terrainVersion;
+                        float elevationScale;
+                        bool valid;
+                    } captured;
+                };
+            }
+        }
+    }
+}
+
+#endif // TAK_ENGINE_RENDERER_CORE_GLTERRAINOCCLUSION_H_INCLUDED
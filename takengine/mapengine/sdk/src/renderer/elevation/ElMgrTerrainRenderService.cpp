@@ -19,15 +19,21 @@
 #include "model/MeshBuilder.h"
 #include "model/MeshTransformer.h"
 #include "model/SceneBuilder.h"
+#include "port/Platform.h"
 #include "port/STLVectorAdapter.h"
 #include "raster/osm/OSMUtils.h"
 #include "renderer/GLTexture2.h"
+#include "renderer/QuadMeshIndices.h"
 #include "renderer/Skirt.h"
 #include "thread/Lock.h"
 #include "thread/Mutex.h"
 #include "util/ConfigOptions.h"
 #include "util/BlockPoolAllocator.h"
 #include "util/MathUtils.h"
+#include "util/MemoryAccounting.h"
+#include "util/MemoryTrim.h"
+#include "util/Trace.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine::Renderer::Elevation;
 
@@ -46,6 +52,7 @@ using namespace atakmap::math;
 using namespace atakmap::renderer;
 
 #define TERRAIN_LEVEL 8
+// fallback if the CPU decode concurrency limit is not available
 #define NUM_TILE_FETCH_WORKERS 4u
 #define MAX_LEVEL 19.0
 #define USE_SSE_SELECT 1
@@ -53,9 +60,65 @@ using namespace atakmap::renderer;
 // is most frequently circa 150-200 tiles. queue limit of 225 would assume that
 // we are loading circa 75% of the upper-limit mesh.
 #define MAX_TILE_QUEUE_SIZE 225u
+// prefetch nodes may only occupy part of the queue, leaving room for the
+// current scene
+#define MAX_PREFETCH_QUEUE_SIZE (MAX_TILE_QUEUE_SIZE/2u)
 
 namespace
 {
+    /** Runs a fetcher entry on a borrowed worker thread */
+    class FetchWork : public Work
+    {
+    public :
+        FetchWork(void *(*entry_)(void *), void *opaque_) NOTHROWS :
+            entry(entry_),
+            opaque(opaque_)
+        {}
+    protected :
+        TAKErr onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS override
+        {
+            lockPtr.reset();
+            entry(opaque);
+            return TE_Ok;
+        }
+    private :
+        void *(*entry)(void *);
+        void *opaque;
+    };
+
+    /** Returns the tile to the pool, releasing the accounted tile memory */
+    struct TerrainTileDeleter
+    {
+        void(*deleter)(const TerrainTile *);
+        std::size_t accounted;
+
+        void operator()(TerrainTile *tile) const NOTHROWS
+        {
+            if (accounted)
+                MemoryAccounting_release(TEMC_TerrainTile, accounted);
+            deleter(tile);
+        }
+    };
+
+    /**
+     * Records the memory of a completed tile allocated with a
+     * `TerrainTileDeleter`
+     */
+    void accountTerrainTile(const std::shared_ptr<TerrainTile> &tile) NOTHROWS
+    {
+        TerrainTileDeleter *deleter = std::get_deleter<TerrainTileDeleter>(tile);
+        if (!deleter || deleter->accounted)
+            return;
+        std::size_t size = sizeof(TerrainTile);
+        std::size_t meshSize;
+        if (tile->data.value && Mesh_getDataSize(&meshSize, *tile->data.value) == TE_Ok)
+            size += meshSize;
+        if (tile->data_proj.value && Mesh_getDataSize(&meshSize, *tile->data_proj.value) == TE_Ok)
+            size += meshSize;
+        MemoryAccounting_allocate(TEMC_TerrainTile, size);
+        deleter->accounted = size;
+    }
+
     struct DeriveSource
     {
         std::size_t level{0u};
@@ -153,103 +216,101 @@ namespace
 
         return level;
     }
+    /** returns `true` if the node should be refined for the scene */
+    bool shouldRecurse(const MapSceneModel2 &s, const std::size_t l, const Envelope2 &b) NOTHROWS
+    {
+        if(l >= MAX_LEVEL)
+            return false;
+        double reslat = 0.0;
+        // if non-planar projection, start adapting the geometric error per
+        // the actual resolution at the edge of the tile closest to the
+        // equator
+        if(s.displayModel->earth->getGeomClass() != GeometryModel2::PLANE &&
+            std::min(fabs(b.minY), fabs(b.maxY)) > 67.0) {
+
+            // fudge the value we're feeding into the resolution
+            // computation by doubling the distance (in degrees latitude)
+            // from the centroid to the respective pole
+            if(b.minY < 0.0) {
+                const double dpole = 90.0 + ((b.minY+b.maxY)/2.0);
+                reslat = -90.0 + (2.0*dpole);
+            } else {
+                const double dpole = 90.0 - ((b.minY+b.maxY)/2.0);
+                reslat = 90.0 - (2.0*dpole);
+            }
+        }
+        const double geometricError = atakmap::raster::osm::OSMUtils::mapnikTileResolution((int)l, reslat);
+        const double sse = computeSSE(s, b, geometricError);
+#ifdef __ANDROID__
+        bool recurse = (sse > 5.0);
+#else
+        bool recurse = (sse > 2.0);
+#endif
+        if(recurse) {
+            bool isect = false;
+            if(MapSceneModel2_intersects(&isect, s, b.minX, b.minY, b.minZ, b.maxX, b.maxY, b.maxZ) == TE_Ok)
+                recurse &= isect;
+        }
+        return recurse;
+    }
     std::size_t getNumEdgeVertices(const std::size_t numPostsLat, const std::size_t numPostsLng) NOTHROWS
     {
         // number of edge vertices is equal to perimeter length, plus one, to
         // close the linestring
         return ((numPostsLat-1u)*2u)+((numPostsLng-1u)*2u) + 1u;
     }
-    TAKErr createEdgeIndices(MemBuffer2 &edgeIndices, const std::size_t numPostsLat, const std::size_t numPostsLng) NOTHROWS
-    {
-        // NOTE: edges are computed in CCW order
+    bool intersects(const Frustum2& frustum, const TAK::Engine::Feature::Envelope2& aabbWCS, const int srid, const double lng) NOTHROWS;
 
-        TAKErr code(TE_Ok);
-        // top edge (right-to-left), exclude last
-        for(int i = static_cast<int>(numPostsLng)-1; i > 0; i--) {
-            code = edgeIndices.put<uint16_t>((uint16_t) i);
-            TE_CHECKBREAK_CODE(code);
-        }
-        TE_CHECKRETURN_CODE(code);
-        // left edge (bottom-to-top), exclude last
-        for(int i = 0; i < static_cast<int>(numPostsLat-1u); i++) {
-            const std::size_t idx = (static_cast<std::size_t>(i)*numPostsLng);
-            code = edgeIndices.put<uint16_t>((uint16_t)idx);
-            TE_CHECKBREAK_CODE(code);
+    /** Visibility and fetch priority of nodes for a scene */
+    class FetchScene
+    {
+    public :
+        FetchScene(const MapSceneModel2 &scene_) NOTHROWS :
+            scene(scene_),
+            frustum(scene_.camera.projection, scene_.camera.modelView),
+            srid(scene_.projection->getSpatialReferenceID())
+        {
+            scene.projection->inverse(&focus, scene.camera.target);
+            GeoPoint2 camera;
+            scene.projection->inverse(&camera, scene.camera.location);
+            focusDistance = std::max(GeoPoint2_slantDistance(camera, focus), 1.0);
         }
-        TE_CHECKRETURN_CODE(code);
-        // bottom edge (left-to-right), exclude last
-        for(int i = 0; i < static_cast<int>(numPostsLng-1u); i++) {
-            const std::size_t idx = ((numPostsLat-1u)*numPostsLng)+static_cast<std::size_t>(i);
-            code = edgeIndices.put<uint16_t>((uint16_t)idx);
-            TE_CHECKBREAK_CODE(code);
+    public :
+        bool isVisible(const Envelope2 &aabbWGS84) const NOTHROWS
+        {
+            // compute AABB in WCS and check for intersection with the frustum
+            TAK::Engine::Feature::Envelope2 aabbWCS(aabbWGS84);
+            TAK::Engine::Feature::GeometryTransformer_transform(&aabbWCS, aabbWCS, 4326, srid);
+            return intersects(frustum, aabbWCS, srid, focus.longitude);
         }
-        TE_CHECKRETURN_CODE(code);
-        // right edge (top-to-bottom), exclude last
-        for(int i = static_cast<int>(numPostsLat-1); i > 0; i--) {
-            code = edgeIndices.put<uint16_t>((uint16_t) ((i * numPostsLng) + (numPostsLng - 1)));
-            TE_CHECKBREAK_CODE(code);
+        /**
+         * Returns the screen-space error of the node, weighted by the
+         * distance of the node from the focus relative to the distance of
+         * the camera from the focus.
+         */
+        double getPriority(const Envelope2 &aabbWGS84, const std::size_t level) const NOTHROWS
+        {
+            const double sse = computeSSE(scene, aabbWGS84, atakmap::raster::osm::OSMUtils::mapnikTileResolution((int)level));
+            const GeoPoint2 closest(
+                    clamp(focus.latitude, aabbWGS84.minY, aabbWGS84.maxY),
+                    clamp(focus.longitude, aabbWGS84.minX, aabbWGS84.maxX));
+            const double d = GeoPoint2_distance(focus, closest, true);
+            return sse / (1.0 + (d / focusDistance));
         }
-        TE_CHECKRETURN_CODE(code);
-
-        // close the loop by adding first-point-as-last
-        code = edgeIndices.put<uint16_t>((uint16_t)(numPostsLng-1u));
-        TE_CHECKRETURN_CODE(code);
-
-        edgeIndices.flip();
-        return code;
-    }
-    TAKErr createHeightmapMeshIndices(MemBuffer2 &indices, const MemBuffer2 &edgeIndices, const std::size_t numPostsLat, const std::size_t numPostsLng) NOTHROWS
-    {
-        TAKErr code(TE_Ok);
-
-        const std::size_t numEdgeVertices = getNumEdgeVertices(numPostsLat, numPostsLng);
-
-        std::size_t numSkirtIndices;
-        code = Skirt_getNumOutputIndices(&numSkirtIndices, GL_TRIANGLE_STRIP, numEdgeVertices);
-        const std::size_t numIndices = GLTexture2_getNumQuadMeshIndices(numPostsLat - 1u, numPostsLng - 1u)
-                               + 2u // degenerate link to skirt
-                               + numSkirtIndices;
-
-        code = GLTexture2_createQuadMeshIndexBuffer(indices, GL_UNSIGNED_SHORT, numPostsLat - 1u, numPostsLng - 1u);
-        TE_CHECKRETURN_CODE(code);
-
-        const std::size_t skirtOffset = GLTexture2_getNumQuadMeshIndices(numPostsLat - 1u, numPostsLng - 1u);
-
-        // insert the degenerate, last index of the mesh and first index
-        // for the skirt
-        code = indices.put<uint16_t>(*reinterpret_cast<const uint16_t *>(indices.get()+indices.position()-sizeof(uint16_t)));
-        TE_CHECKRETURN_CODE(code);
-        code = indices.put<uint16_t>(reinterpret_cast<const uint16_t *>(edgeIndices.get())[0u]);
-        TE_CHECKRETURN_CODE(code);
-
-        code = Skirt_createIndices<uint16_t>(
-                indices,
-                GL_TRIANGLE_STRIP,
-                &edgeIndices,
-                numEdgeVertices,
-                static_cast<uint16_t>(numPostsLat*numPostsLng));
-        TE_CHECKRETURN_CODE(code);
-
-        return code;
-    }
-
-    bool intersects(const Frustum2& frustum, const TAK::Engine::Feature::Envelope2& aabbWCS, const int srid, const double lng) NOTHROWS;
+    public :
+        const MapSceneModel2 &scene;
+        Frustum2 frustum;
+        const int srid;
+        GeoPoint2 focus;
+        double focusDistance;
+    };
 
-    std::size_t getTerrainMeshSize(const std::size_t numPosts) NOTHROWS
+    std::size_t getTerrainMeshSize(const std::size_t numPosts, const bool compactVertices) NOTHROWS
     {
+        // indices are shared, see `QuadMeshIndices_get`; only vertices are per tile
         const std::size_t numEdgeVertices = getNumEdgeVertices(numPosts, numPosts);
-        std::size_t numSkirtIndices;
-        Skirt_getNumOutputIndices(&numSkirtIndices, GL_TRIANGLE_STRIP, numEdgeVertices);
-        const std::size_t numIndices = GLTexture2_getNumQuadMeshIndices(numPosts - 1u, numPosts - 1u)
-                               + 2u // degenerate link to skirt
-                               + numSkirtIndices;
-
-        const std::size_t skirtOffset = GLTexture2_getNumQuadMeshIndices(numPosts - 1u, numPosts - 1u);
-
-        const std::size_t ib_size = numIndices * sizeof(uint16_t);
-        const std::size_t vb_size = (numPosts*numPosts*3u + Skirt_getNumOutputVertices(numEdgeVertices) * 3u) * sizeof(float);
-        const std::size_t buf_size = ib_size + vb_size;
-        return buf_size;
+        const std::size_t vb_size = (numPosts*numPosts*3u + Skirt_getNumOutputVertices(numEdgeVertices) * 3u) * (compactVertices ? sizeof(uint16_t) : sizeof(float));
+        return vb_size;
     }
 }
 
@@ -270,13 +331,35 @@ private :
     std::set<ElevationSource *> sources;
 };
 
+/**
+ * The quadtree only retains tiles for the current scene, plus the ancestors
+ * needed for derivation, so there is nothing to release while the map is
+ * visible without causing a reload. When the application is hidden the tree
+ * is rebuilt, releasing all but the root tiles.
+ */
+class ElMgrTerrainRenderService::MemoryTrimmer : public MemoryTrimmable
+{
+public :
+    MemoryTrimmer(ElMgrTerrainRenderService &service) NOTHROWS;
+    ~MemoryTrimmer() NOTHROWS override;
+public :
+    void trim(const MemoryTrimLevel level) NOTHROWS override;
+private :
+    ElMgrTerrainRenderService &service;
+};
+
 class ElMgrTerrainRenderService::QuadNode
 {
 public:
     QuadNode(ElMgrTerrainRenderService &service, const std::weak_ptr<QuadNode> &parent, int srid, double minX, double minY, double maxX, double maxY) NOTHROWS;
 public :
     static bool needsFetch(const std::weak_ptr<QuadNode> &node, const int srid, const int sourceVersion) NOTHROWS;
-    bool collect(ElMgrTerrainRenderService::WorldTerrain &value, const GeoPoint2 &focus, const MapSceneModel2 &view, DeriveSource deriveFrom, const bool derive, const bool allowFetch) NOTHROWS;
+    bool collect(ElMgrTerrainRenderService::WorldTerrain &value, const GeoPoint2 &focus, const MapSceneModel2 &view, DeriveSource deriveFrom, const bool derive, const bool allowFetch, const MapSceneModel2 *predicted) NOTHROWS;
+    /**
+     * Retains and fetches the descendents needed for the predicted scene,
+     * without modifying the mesh for the current scene.
+     */
+    void prefetch(const ElMgrTerrainRenderService::WorldTerrain &value, const MapSceneModel2 &predicted) NOTHROWS;
     void reset(const bool data) NOTHROWS;
     void derive(const int srid, const DeriveSource &deriveFrom) NOTHROWS;
 public :
@@ -302,6 +385,10 @@ public :
 
     std::shared_ptr<TerrainTile> tile;
     bool queued;
+    /** `true` if queued only for the predicted scene */
+    bool prefetchOnly {false};
+    /** assigned when the fetch queue is prioritized */
+    double fetchPriority {0.0};
 
     int sourceVersion {-1};
     int srid {-1};
@@ -348,26 +435,39 @@ namespace
         return defaultValue;
     }
 
-    TAKErr fetch(std::shared_ptr<TerrainTile> &value, double *els, const double resolution, const Envelope2 &mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices, const bool fetchEl, const bool legacyEl, const bool constrainQueryRes, const bool fillWithHiRes, BlockPoolAllocator &allocator, PoolAllocator<TerrainTile> &tileAllocator) NOTHROWS;
-    TAKErr derive(std::shared_ptr<TerrainTile> &value, const Envelope2 &mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices, const TerrainTile &deriveFrom, BlockPoolAllocator &allocator, PoolAllocator<TerrainTile> &tileAllocator) NOTHROWS;
+    TAKErr fetch(std::shared_ptr<TerrainTile> &value, double *els, const double resolution, const Envelope2 &mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices, const bool fetchEl, const bool legacyEl, const bool constrainQueryRes, const bool fillWithHiRes, const bool compactVertices, BlockPoolAllocator &allocator, PoolAllocator<TerrainTile> &tileAllocator) NOTHROWS;
+    TAKErr derive(std::shared_ptr<TerrainTile> &value, const Envelope2 &mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices, const TerrainTile &deriveFrom, const bool compactVertices, BlockPoolAllocator &allocator, PoolAllocator<TerrainTile> &tileAllocator) NOTHROWS;
+    /**
+     * Builds the heightmap mesh for the tile over `mbb`.
+     *
+     * @param els               The post elevations, row-major from the
+     *                          minimum latitude. Missing values are treated
+     *                          as `0`; if `nullptr`, all posts are `0`.
+     * @param compactVertices   If `true`, positions are quantized to 16 bits
+     *                          over the mesh AABB
+     */
+    TAKErr createHeightmapMesh(TerrainTile &value, const Envelope2 &mbb, const double *els, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices, const bool compactVertices, BlockPoolAllocator &allocator) NOTHROWS;
+    /** layout for positions in the destination SRID of `Mesh_transform` */
+    VertexDataLayout getTransformedLayout() NOTHROWS;
     double estimateResolution(const GeoPoint2 &focus, const MapSceneModel2 &scene, const double ullat, const double ullng, const double lrlat, const double lrlng, GeoPoint2 *closest) NOTHROWS;
     TAKErr subscribeOnContentChangedListener(void *opaque, ElevationSource &src) NOTHROWS;
 }
 
 ElMgrTerrainRenderService::ElMgrTerrainRenderService(RenderContext &renderer_) NOTHROWS :
-    renderer(renderer_),
+    prefetchHorizon(0LL),
     requestWorker(nullptr, nullptr),
     nodeCount(0u),
+    sticky(true),
     reset(false),
     numPosts(32),
     fetchResolutionAdjustment(10.0),
     nodeSelectResolutionAdjustment(8.0),
-    monitor(TEMT_Recursive),
-    sticky(true),
-    terminate(false),
-    meshAllocator(getTerrainMeshSize(numPosts), 512),
+    meshAllocator(getTerrainMeshSize(numPosts, getBoolOpt("terrain.compact-vertices", true)), 512),
     tileAllocator(256),
-    edgeIndices(getNumEdgeVertices(numPosts, numPosts)*sizeof(uint16_t))
+    terminate(false),
+    edgeIndices(getNumEdgeVertices(numPosts, numPosts)*sizeof(uint16_t)),
+    monitor(TEMT_Recursive),
+    renderer(renderer_)
 {
     east.reset(new QuadNode(*this, std::shared_ptr<QuadNode>(nullptr), -1, 0.0, -90.0, 180.0, 90.0));
     east->self = east;
@@ -395,6 +495,7 @@ ElMgrTerrainRenderService::ElMgrTerrainRenderService(RenderContext &renderer_) N
     worldTerrain->sceneVersion = -1;
 
     sourceRefresh.reset(new SourceRefresh(*this));
+    memoryTrimmer.reset(new MemoryTrimmer(*this));
 
     request.srid = -1;
     request.sceneVersion = -1;
@@ -425,14 +526,28 @@ ElMgrTerrainRenderService::ElMgrTerrainRenderService(RenderContext &renderer_) N
     fetchOptions.legacyElevationApi = getBoolOpt("terrain.legacy-elevation-api", false);
 #endif
     fetchOptions.fillWithHiRes = getBoolOpt("terrain.fill-with-hi-res", true);
+    fetchOptions.compactVertices = getBoolOpt("terrain.compact-vertices", true);
 
-    queue.entries.reserve(MAX_TILE_QUEUE_SIZE);
+    prefetchHorizon = ConfigOptions_getIntOptionOrDefault("terrain.prefetch-horizon", 500);
 
-    createEdgeIndices(edgeIndices, numPosts, numPosts);
+    queue.entries.reserve(MAX_TILE_QUEUE_SIZE);
+    // by default, fetchers may occupy the full CPU decode class; the borrowed
+    // view bounds the actual concurrency
+    queue.maxFetchers = (std::size_t)ConfigOptions_getIntOptionOrDefault("terrain.fetch-workers", 0);
+    if (!queue.maxFetchers && WorkerRegistry_getConcurrencyLimit(&queue.maxFetchers, TEWC_CPUDecode) != TE_Ok)
+        queue.maxFetchers = NUM_TILE_FETCH_WORKERS;
+    queue.maxFetchers = std::max(queue.maxFetchers, (std::size_t)1u);
+
+    const QuadMeshIndices *gridIndices;
+    if (QuadMeshIndices_get(&gridIndices, numPosts-1u, numPosts-1u, true) == TE_Ok) {
+        edgeIndices.put<uint16_t>(gridIndices->edgeIndices, gridIndices->numEdgeIndices);
+        edgeIndices.flip();
+    }
 }
 
 ElMgrTerrainRenderService::~ElMgrTerrainRenderService() NOTHROWS
 {
+    memoryTrimmer.reset();
     stop();
 
     // release `roots`
@@ -454,6 +569,10 @@ TAKErr ElMgrTerrainRenderService::lock(TAK::Engine::Port::Collection<std::shared
     request.sceneVersion = sceneVersion;
     request.scene = view;
     request.derive = derive;
+    if (prefetchHorizon > 0LL) {
+        motionPredictor.update(view, Platform_systime_millis());
+        request.predict = (motionPredictor.predict(&request.predicted, prefetchHorizon) == TE_Ok);
+    }
 
     // data is invalid if SRID changed
     bool invalid = (worldTerrain->srid != srid);
@@ -477,6 +596,7 @@ TAKErr ElMgrTerrainRenderService::lock(TAK::Engine::Port::Collection<std::shared
                          fetchOptions.legacyElevationApi,
                          fetchOptions.constrainQueryRes,
                          fetchOptions.fillWithHiRes,
+                         fetchOptions.compactVertices,
                          meshAllocator,
                          tileAllocator);
             if(code != TE_Ok) {
@@ -579,46 +699,108 @@ TAKErr ElMgrTerrainRenderService::stop() NOTHROWS
         mlock.broadcast();
     }
 
+    // wait for the fetchers to observe termination and return their threads
+    {
+        Monitor::Lock mlock(queue.monitor);
+        while (queue.activeFetchers)
+            mlock.wait();
+    }
     // wait for the worker thread to die
-    queue.worker.reset();
     requestWorker.reset();
 
     return TE_Ok;
 }
 
 //synchronized void enqueue(QuadNode node)
-TAKErr ElMgrTerrainRenderService::enqueue(const std::shared_ptr<QuadNode> &node) NOTHROWS
+TAKErr ElMgrTerrainRenderService::enqueue(const std::shared_ptr<QuadNode> &node, const bool prefetch) NOTHROWS
 {
     TAKErr code(TE_Ok);
     Monitor::Lock mlock(queue.monitor);
     TE_CHECKRETURN_CODE(mlock.status);
 
-    // already queued
-    if(node->queued)
+    // already queued; promote if now needed for the current scene
+    if(node->queued) {
+        if(!prefetch && node->prefetchOnly) {
+            node->prefetchOnly = false;
+            queue.sorted = false;
+        }
         return code;
+    }
 
-    // queue is at max capacity
-    if(queue.entries.size() == MAX_TILE_QUEUE_SIZE)
+    if(prefetch && queue.entries.size() >= MAX_PREFETCH_QUEUE_SIZE)
         return TE_Busy;
+    // queue is at max capacity; the current scene displaces a prefetch
+    // request, if any
+    if(queue.entries.size() == MAX_TILE_QUEUE_SIZE) {
+        auto displaced = prefetch ?
+            queue.entries.end() :
+            std::find_if(queue.entries.begin(), queue.entries.end(), [](const std::shared_ptr<QuadNode> &entry) { return entry->prefetchOnly; });
+        if(displaced == queue.entries.end())
+            return TE_Busy;
+        (*displaced)->queued = false;
+        (*displaced)->prefetchOnly = false;
+        queue.entries.erase(displaced);
+    }
 
-    if (!queue.worker.get()) {
-        //ThreadCreateParams params;
-        //params.name = "ElMgrTerrainRenderServiceBackgroundWorker-fetch-thread";
-        //params.priority = TETP_Normal;
-        code = ThreadPool_create(queue.worker, NUM_TILE_FETCH_WORKERS, fetchWorkerThread, this);
+    if (!queue.worker) {
+        // fetch threads are borrowed from the engine-wide CPU class
+        code = WorkerRegistry_borrow(queue.worker, TEWC_CPUDecode, "elmgr-terrain-fetch", queue.maxFetchers);
         TE_CHECKRETURN_CODE(code);
     }
 
     // enqueue the node
     node->queued = true;
+    node->prefetchOnly = prefetch;
     queue.entries.push_back(node);
     queue.sorted = false;
-    code = mlock.signal();
-    TE_CHECKRETURN_CODE(code);
+
+    // start another fetcher if under budget
+    if (queue.activeFetchers < queue.maxFetchers) {
+        queue.activeFetchers++;
+        code = queue.worker->scheduleWork(std::make_shared<FetchWork>(fetchWorkerThread, this));
+        if (code != TE_Ok)
+            queue.activeFetchers--;
+        TE_CHECKRETURN_CODE(code);
+    }
 
     return code;
 }
 
+void ElMgrTerrainRenderService::prioritizeQueue(const MapSceneModel2 &scene, const MapSceneModel2 *predicted) NOTHROWS
+{
+    const FetchScene current(scene);
+    std::unique_ptr<FetchScene> future(predicted ? new FetchScene(*predicted) : nullptr);
+
+    std::size_t retained = 0u;
+    for (std::size_t i = 0u; i < queue.entries.size(); i++) {
+        std::shared_ptr<QuadNode> node(std::move(queue.entries[i]));
+        const FetchScene *fetchScene = node->prefetchOnly ? future.get() : &current;
+        // the fetched tile's bounds are inherited from the parent
+        std::shared_ptr<QuadNode> parent(node->parent.lock());
+        if (!fetchScene || !fetchScene->isVisible(parent ? parent->bounds : node->bounds)) {
+            node->queued = false;
+            node->prefetchOnly = false;
+            continue;
+        }
+        node->fetchPriority = fetchScene->getPriority(node->bounds, node->level);
+        queue.entries[retained++] = std::move(node);
+    }
+    queue.entries.resize(retained);
+
+    // NOTE: sort into LIFO order
+    std::sort(queue.entries.begin(), queue.entries.end(), [](const std::shared_ptr<QuadNode> &a, const std::shared_ptr<QuadNode> &b)
+    {
+        // prefetch after the current scene
+        if(a->prefetchOnly != b->prefetchOnly)
+            return a->prefetchOnly;
+        if(a->fetchPriority != b->fetchPriority)
+            return a->fetchPriority < b->fetchPriority;
+        // coarser first
+        return a->level > b->level;
+    });
+    queue.sorted = true;
+}
+
 void *ElMgrTerrainRenderService::requestWorkerThread(void *opaque)
 {
     ElMgrTerrainRenderService &owner = *static_cast<ElMgrTerrainRenderService *>(opaque);
@@ -673,9 +855,13 @@ void *ElMgrTerrainRenderService::requestWorkerThread(void *opaque)
             fetch.srid = owner.request.srid;
             fetch.scene = owner.request.scene;
             fetch.derive = owner.request.derive;
+            fetch.predict = owner.request.predict;
+            if (fetch.predict)
+                fetch.predicted = owner.request.predicted;
 #endif
             const bool invalid = owner.east->srid != owner.request.srid;
-            reset |= invalid;
+            reset |= invalid || owner.reset;
+            owner.reset = false;
 
             // synchronize quadtree SRID with current scene
             if(reset) {
@@ -705,6 +891,14 @@ void *ElMgrTerrainRenderService::requestWorkerThread(void *opaque)
             owner.renderer.requestRefresh();
         }
 
+        // cancel requests for the previous scene before collecting; the queue
+        // would otherwise reject the nodes for the current scene
+        {
+            Monitor::Lock qlock(owner.queue.monitor);
+            if (!owner.queue.sorted)
+                owner.prioritizeQueue(fetch.scene, fetch.predict ? &fetch.predicted : nullptr);
+        }
+
         GeoPoint2 focus;
         fetch.scene.projection->inverse(&focus, fetch.scene.camera.target);
 
@@ -721,7 +915,7 @@ void *ElMgrTerrainRenderService::requestWorkerThread(void *opaque)
             TAK::Engine::Feature::Envelope2 aabbWCS(owner.roots[i]->bounds);
             TAK::Engine::Feature::GeometryTransformer_transform(&aabbWCS, aabbWCS, 4326, srid);
             if(intersects(frustum, aabbWCS, srid, focus.longitude)) {
-                owner.roots[i]->collect(*fetchBuffer, focus, fetch.scene, DeriveSource(), fetch.derive, true);
+                owner.roots[i]->collect(*fetchBuffer, focus, fetch.scene, DeriveSource(), fetch.derive, true, fetch.predict ? &fetch.predicted : nullptr);
             } else {
                 // no intersection
                 if(!owner.roots[i]->tile.get()) {
@@ -738,6 +932,7 @@ void *ElMgrTerrainRenderService::requestWorkerThread(void *opaque)
                             owner.fetchOptions.legacyElevationApi,
                             owner.fetchOptions.constrainQueryRes,
                             owner.fetchOptions.fillWithHiRes,
+                            owner.fetchOptions.compactVertices,
                             owner.meshAllocator,
                             owner.tileAllocator);
                     owner.roots[i]->sourceVersion = fetchBuffer->sourceVersion;
@@ -764,6 +959,11 @@ void *ElMgrTerrainRenderService::fetchWorkerThread(void *opaque)
     int fetchSrcVersion = ~service.version.source;
     array_ptr<double> els(new double[service.numPosts*service.numPosts*3u]);
     MapSceneModel2 cmodel;
+    MapSceneModel2 pmodel;
+    bool predicted = false;
+    bool prefetchOnly = false;
+    // set once the active fetcher count has been released for this fetcher
+    bool detached = false;
     while(true) {
         Envelope2 bounds;
 
@@ -802,8 +1002,12 @@ void *ElMgrTerrainRenderService::fetchWorkerThread(void *opaque)
                 Monitor::Lock slock(service.monitor);
                 code = slock.status;
 
-                if (service.terminate)
+                if (service.terminate) {
+                    service.queue.activeFetchers--;
+                    qlock.broadcast();
+                    detached = true;
                     break;
+                }
 
                 if(quadtreeUpdate) {
                     service.version.quadtree++;
@@ -811,91 +1015,59 @@ void *ElMgrTerrainRenderService::fetchWorkerThread(void *opaque)
                 }
 
                 cmodel = service.request.scene;
+                predicted = service.request.predict;
+                if (predicted)
+                    pmodel = service.request.predicted;
                 fetchSrcVersion = service.version.source;
             }
 
-            if(service.queue.entries.empty()) {
-                code = qlock.wait();
-                if (code == TE_Interrupted)
-                    code = TE_Ok;
-                TE_CHECKBREAK_CODE(code);
+            // prioritize the queue if necessary; requests that are out of
+            // view are canceled
+            if(!service.queue.sorted)
+                service.prioritizeQueue(cmodel, predicted ? &pmodel : nullptr);
 
-                continue;
+            // queue is drained; return the thread to the pool. release under the
+            // queue lock so a concurrent `enqueue` will start a new fetcher
+            if(service.queue.entries.empty()) {
+                service.queue.activeFetchers--;
+                qlock.broadcast();
+                detached = true;
+                break;
             }
 
-            // sort the queue if necessary
-            if(!service.queue.sorted) {
-                GeoPoint2 cam;
-                cmodel.projection->inverse(&cam, cmodel.camera.location);
-
-                // NOTE: sort into LIFO order
-                struct TT_cmp
-                {
-                    TT_cmp(const GeoPoint2 &c) : cam(c) {}
-                    bool operator()(const std::shared_ptr<ElMgrTerrainRenderService::QuadNode> &a, const std::shared_ptr<ElMgrTerrainRenderService::QuadNode> &b) NOTHROWS
-                    {
-                        // sort low to high resolution, then sort based on distance from camera
-                        if(a->level < b->level)
-                            return false;
-                        else if(a->level > b->level)
-                            return true;
-
-                        double calat = (a->bounds.minY+a->bounds.maxY)/2.0;
-                        double calng = (a->bounds.minX+a->bounds.maxX)/2.0;
-                        if(cam.longitude*calng < 0 && fabs(cam.longitude-calng) > 180.0)
-                            calng += (cam.longitude < 0.0) ? -360.0 : 360.0;
-
-                        const double dalat = cam.latitude-calat;
-                        const double dalng = cam.longitude-calng;
-                        const double da2 = (dalat*dalat)+(dalng*dalng);
-
-                        double cblat = (b->bounds.minY+b->bounds.maxY)/2.0;
-                        double cblng = (b->bounds.minX+b->bounds.maxX)/2.0;
-                        if(cam.longitude*cblng < 0 && fabs(cam.longitude-cblng) > 180.0)
-                            cblng += (cam.longitude < 0.0) ? -360.0 : 360.0;
-
-                        const double dblat = cam.latitude-cblat;
-                        const double dblng = cam.longitude-cblng;
-                        const double db2 = (dblat*dblat)+(dblng*dblng);
-
-                        if(da2 < db2)
-                            return false;
-                        else if(da2 > db2)
-                            return true;
-
-                        // don't expect this to happen
-                        return (intptr_t)a.get() < (intptr_t)b.get();
-                    }
-                    const GeoPoint2 cam;
-                };
-                std::sort(service.queue.entries.begin(), service.queue.entries.end(), TT_cmp(cam));
-                service.queue.sorted = true;
+            // requeue after each fetched tile, rather than draining the queue,
+            // so that other borrowers of the CPU class are serviced in
+            // between. The requeued work assumes this fetcher's slot.
+            if (fetchedNodes && service.queue.worker->scheduleWork(std::make_shared<FetchWork>(fetchWorkerThread, &service)) == TE_Ok) {
+                detached = true;
+                break;
             }
 
             node = service.queue.entries.back();
             service.queue.entries.pop_back();
+            prefetchOnly = node->prefetchOnly;
+            node->prefetchOnly = false;
 
             std::shared_ptr<QuadNode> parent(node->parent.lock());
             bounds = parent ? parent->bounds : node->bounds;
         }
 
-        GeoPoint2 focus;
-        cmodel.projection->inverse(&focus, cmodel.camera.target);
-        Matrix2 m(cmodel.camera.projection);
-        m.concatenate(cmodel.camera.modelView);
-        Frustum2 frustum(m);
-        // compute AABB in WCS and check for intersection with the frustum
-        TAK::Engine::Feature::Envelope2 aabbWCS(bounds);
-        const int srid = cmodel.projection->getSpatialReferenceID();
-        TAK::Engine::Feature::GeometryTransformer_transform(&aabbWCS, aabbWCS, 4326, srid);
-        if (!intersects(frustum, aabbWCS, srid, focus.longitude)) {
+        // prefetch nodes are retained only while predicted; a node in neither
+        // the current nor the predicted scene is dropped
+        if (prefetchOnly && !predicted) {
+            node->queued = false;
+            node.reset();
+            continue;
+        }
+        const FetchScene scene(prefetchOnly ? pmodel : cmodel);
+        if (!scene.isVisible(bounds)) {
             node->queued = false;
             node.reset();
             continue;
         }
 
         const double res = atakmap::raster::osm::OSMUtils::mapnikTileResolution(static_cast<int>(node->level))*service.fetchResolutionAdjustment;
-        TAKErr code = fetch(tile, els.get(), res, node->bounds, node->srid, service.numPosts, service.numPosts, service.edgeIndices, node->level >= TERRAIN_LEVEL, service.fetchOptions.legacyElevationApi, service.fetchOptions.constrainQueryRes, service.fetchOptions.fillWithHiRes, service.meshAllocator, service.tileAllocator);
+        TAKErr code = fetch(tile, els.get(), res, node->bounds, node->srid, service.numPosts, service.numPosts, service.edgeIndices, node->level >= TERRAIN_LEVEL, service.fetchOptions.legacyElevationApi, service.fetchOptions.constrainQueryRes, service.fetchOptions.fillWithHiRes, service.fetchOptions.compactVertices, service.meshAllocator, service.tileAllocator);
         TE_CHECKBREAK_CODE(code);
 
         fetchedNodes++;
@@ -903,6 +1075,11 @@ void *ElMgrTerrainRenderService::fetchWorkerThread(void *opaque)
         //Log.i("ElMgrTerrainRenderService", "fetched node, count=" + fetchedNodes);
     }
 
+    if (!detached) {
+        Monitor::Lock qlock(service.queue.monitor);
+        service.queue.activeFetchers--;
+        qlock.broadcast();
+    }
 
     return nullptr;
 }
@@ -965,14 +1142,38 @@ TAKErr ElMgrTerrainRenderService::SourceRefresh::onSourceDetached(const Elevatio
     return TE_Ok;
 }
 
+ElMgrTerrainRenderService::MemoryTrimmer::MemoryTrimmer(ElMgrTerrainRenderService &service_) NOTHROWS :
+    service(service_)
+{
+    MemoryTrim_registerTrimmable(*this);
+}
+ElMgrTerrainRenderService::MemoryTrimmer::~MemoryTrimmer() NOTHROWS
+{
+    MemoryTrim_unregisterTrimmable(*this);
+}
+void ElMgrTerrainRenderService::MemoryTrimmer::trim(const MemoryTrimLevel level) NOTHROWS
+{
+    if (level < TETL_Complete)
+        return;
+
+    Monitor::Lock mlock(service.monitor);
+    if (mlock.status != TE_Ok)
+        return;
+    // request a rebuild of the quadtree; bump the version to wake the request
+    // worker even if the scene is unchanged
+    service.reset = true;
+    service.version.quadtree++;
+    mlock.signal();
+}
+
 ElMgrTerrainRenderService::QuadNode::QuadNode(ElMgrTerrainRenderService &service_, const std::weak_ptr<QuadNode> &parent_, int srid_, double minX, double minY, double maxX, double maxY) NOTHROWS :
     service(service_),
-    parent(parent_),
     bounds(minX, minY, -415.0, maxX, maxY, 8850.0),
     level(0u),
     lastRequestLevel(0u),
     queued(false),
-    srid(srid_)
+    srid(srid_),
+    parent(parent_)
 {
     std::shared_ptr<QuadNode> p(parent.lock());
     if(p)
@@ -996,48 +1197,9 @@ bool ElMgrTerrainRenderService::QuadNode::needsFetch(const std::weak_ptr<QuadNod
         (!node->tile || node->tile->data.srid != srid));
 }
 
-bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::WorldTerrain &value, const GeoPoint2 &focus, const MapSceneModel2 &scene, DeriveSource deriveFrom, const bool allowDerive, const bool allowFetch) NOTHROWS
+bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::WorldTerrain &value, const GeoPoint2 &focus, const MapSceneModel2 &scene, DeriveSource deriveFrom, const bool allowDerive, const bool allowFetch, const MapSceneModel2 *predicted) NOTHROWS
 {
 #if USE_SSE_SELECT
-    struct {
-        bool operator()(const MapSceneModel2 &s, const std::size_t l, const Envelope2 &b) NOTHROWS
-        {
-            if(l >= MAX_LEVEL)
-                return false;
-            double reslat = 0.0;
-            // if non-planar projection, start adapting the geometric error per
-            // the actual resolution at the edge of the tile closest to the
-            // equator
-            if(s.displayModel->earth->getGeomClass() != GeometryModel2::PLANE &&
-                std::min(fabs(b.minY), fabs(b.maxY)) > 67.0) {
-
-                // fudge the value we're feeding into the resolution
-                // computation by doubling the distance (in degrees latitude)
-                // from the centroid to the respective pole
-                if(b.minY < 0.0) {
-                    const double dpole = 90.0 + ((b.minY+b.maxY)/2.0);
-                    reslat = -90.0 + (2.0*dpole);
-                } else {
-                    const double dpole = 90.0 - ((b.minY+b.maxY)/2.0);
-                    reslat = 90.0 - (2.0*dpole);
-                }
-            }
-            const double geometricError = atakmap::raster::osm::OSMUtils::mapnikTileResolution((int)l, reslat);
-            const double sse = computeSSE(s, b, geometricError);
-#ifdef __ANDROID__
-            bool recurse = (sse > 5.0);
-#else
-            bool recurse = (sse > 2.0);
-#endif
-            if(recurse) {
-                bool isect = false;
-                if(MapSceneModel2_intersects(&isect, s, b.minX, b.minY, b.minZ, b.maxX, b.maxY, b.maxZ) == TE_Ok)
-                    recurse &= isect;
-            }
-            return recurse;
-        }
-    } shouldRecurse;
-
     if(shouldRecurse(scene, this->level, this->bounds)) {
 #else
     const double selectResAdj = (MapSceneModel2_getCameraMode() == MapCamera2::Scale) ? service.nodeSelectResolutionAdjustment : service.nodeSelectResolutionAdjustment / 2.0;
@@ -1078,7 +1240,7 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
         }
 
         // fetch tile nodes
-        if(fetchll && !fetchingll) {
+        if(fetchll && (!fetchingll || ll->prefetchOnly)) {
             if(!ll.get()) {
                 ll.reset(new QuadNode(service, self, this->srid, this->bounds.minX, this->bounds.minY, centerX, centerY));
                 ll->self = ll;
@@ -1086,7 +1248,7 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
             if(allowFetch)
                 service.enqueue(ll);
         }
-        if(fetchlr && !fetchinglr) {
+        if(fetchlr && (!fetchinglr || lr->prefetchOnly)) {
             if(!lr.get()) {
                 lr.reset(new QuadNode(service, self, this->srid, centerX, this->bounds.minY, this->bounds.maxX, centerY));
                 lr->self = lr;
@@ -1094,7 +1256,7 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
             if(allowFetch)
                 service.enqueue(lr);
         }
-        if(fetchur && !fetchingur) {
+        if(fetchur && (!fetchingur || ur->prefetchOnly)) {
             if(!ur.get()) {
                 ur.reset(new QuadNode(service, self, this->srid, centerX, centerY, this->bounds.maxX, this->bounds.maxY));
                 ur->self = ur;
@@ -1102,7 +1264,7 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
             if(allowFetch)
                 service.enqueue(ur);
         }
-        if(fetchul && !fetchingul) {
+        if(fetchul && (!fetchingul || ul->prefetchOnly)) {
             if(!ul.get()) {
                 ul.reset(new QuadNode(service, self, this->srid, this->bounds.minX, centerY, centerX, this->bounds.maxY));
                 ul->self = ul;
@@ -1146,10 +1308,14 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
 
         if(recurseLL) {
             if(recurse) {
-                ll->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch);
+                ll->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch, predicted);
             }
         } else if(ll.get()) {
-            ll->reset(false);
+            // retain descendents needed for the predicted scene
+            if(predicted && shouldRecurse(*predicted, ll->level, ll->bounds))
+                ll->prefetch(value, *predicted);
+            else
+                ll->reset(false);
             if (recurse) {
                 if (!ll->tile || (deriveFrom.tile && ll->sourceVersion < getDerivedSourceVersion(*ll, deriveFrom)))
                     ll->derive(value.srid, deriveFrom);
@@ -1158,10 +1324,14 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
         }
         if(recurseLR) {
             if(recurse) {
-                lr->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch);
+                lr->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch, predicted);
             }
         } else if(lr.get()) {
-            lr->reset(false);
+            // retain descendents needed for the predicted scene
+            if(predicted && shouldRecurse(*predicted, lr->level, lr->bounds))
+                lr->prefetch(value, *predicted);
+            else
+                lr->reset(false);
             if (recurse) {
                 if (!lr->tile || (deriveFrom.tile && lr->sourceVersion < getDerivedSourceVersion(*lr, deriveFrom)))
                     lr->derive(value.srid, deriveFrom);
@@ -1170,10 +1340,14 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
         }
         if(recurseUR) {
             if(recurse) {
-                ur->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch);
+                ur->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch, predicted);
             }
         } else if(ur.get()) {
-            ur->reset(false);
+            // retain descendents needed for the predicted scene
+            if(predicted && shouldRecurse(*predicted, ur->level, ur->bounds))
+                ur->prefetch(value, *predicted);
+            else
+                ur->reset(false);
             if (recurse) {
                 if (!ur->tile || (deriveFrom.tile && ll->sourceVersion < getDerivedSourceVersion(*ur, deriveFrom)))
                     ur->derive(value.srid, deriveFrom);
@@ -1182,10 +1356,14 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
         }
         if(recurseUL) {
             if(recurse) {
-                ul->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch);
+                ul->collect(value, focus, scene, deriveFrom, allowDerive, allowFetch && recurseFetch, predicted);
             }
         } else if(ul.get()) {
-            ul->reset(false);
+            // retain descendents needed for the predicted scene
+            if(predicted && shouldRecurse(*predicted, ul->level, ul->bounds))
+                ul->prefetch(value, *predicted);
+            else
+                ul->reset(false);
             if (recurse) {
                 if (!ul->tile || (deriveFrom.tile && ul->sourceVersion < getDerivedSourceVersion(*ul, deriveFrom)))
                     ul->derive(value.srid, deriveFrom);
@@ -1212,6 +1390,7 @@ bool ElMgrTerrainRenderService::QuadNode::collect(ElMgrTerrainRenderService::Wor
                   service.fetchOptions.legacyElevationApi,
                   service.fetchOptions.constrainQueryRes,
                   service.fetchOptions.fillWithHiRes,
+                  service.fetchOptions.compactVertices,
                   service.meshAllocator,
                   service.tileAllocator);
             this->derived = false;
@@ -1240,6 +1419,7 @@ void ElMgrTerrainRenderService::QuadNode::derive(const int srid_, const DeriveSo
         service.numPosts,
         service.edgeIndices,
         *deriveFrom.tile,
+        service.fetchOptions.compactVertices,
         service.meshAllocator,
         service.tileAllocator);
 
@@ -1257,6 +1437,44 @@ void ElMgrTerrainRenderService::QuadNode::derive(const int srid_, const DeriveSo
     }
 }
 
+void ElMgrTerrainRenderService::QuadNode::prefetch(const ElMgrTerrainRenderService::WorldTerrain &value, const MapSceneModel2 &predicted) NOTHROWS
+{
+    const double centerX = (this->bounds.minX+this->bounds.maxX)/2.0;
+    const double centerY = (this->bounds.minY+this->bounds.maxY)/2.0;
+
+    struct {
+        std::shared_ptr<QuadNode> &node;
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+    } children[4u] =
+    {
+        { ll, this->bounds.minX, this->bounds.minY, centerX, centerY },
+        { lr, centerX, this->bounds.minY, this->bounds.maxX, centerY },
+        { ur, centerX, centerY, this->bounds.maxX, this->bounds.maxY },
+        { ul, this->bounds.minX, centerY, centerX, this->bounds.maxY },
+    };
+
+    // as with `collect`, all children are fetched and recursion only
+    // proceeds through children that have data
+    for(std::size_t i = 0u; i < 4u; i++) {
+        std::shared_ptr<QuadNode> &child = children[i].node;
+        if(!child.get()) {
+            child.reset(new QuadNode(service, self, this->srid, children[i].minX, children[i].minY, children[i].maxX, children[i].maxY));
+            child->self = child;
+        }
+        if(needsFetch(child, value.srid, value.sourceVersion)) {
+            if(!child->queued)
+                service.enqueue(child, true);
+        } else if(shouldRecurse(predicted, child->level, child->bounds)) {
+            child->prefetch(value, predicted);
+        } else {
+            child->reset(false);
+        }
+    }
+}
+
 void ElMgrTerrainRenderService::QuadNode::reset(const bool data) NOTHROWS
 {
     Monitor::Lock qlock(service.queue.monitor);
@@ -1312,8 +1530,9 @@ void ElMgrTerrainRenderService::QuadNode::updateParentZBounds(QuadNode &node) NO
 namespace
 {
     //static GLMapView.TerrainTile fetch(double resolution, Envelope mbb, int srid, int numPostsLat, int numPostsLng, bool fetchEl)
-    TAKErr fetch(std::shared_ptr<TerrainTile> &value_, double *els, const double resolution, const Envelope2 &mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices_, const bool fetchEl, const bool legacyEl, const bool constrainQueryRes, const bool fillWithHiRes, BlockPoolAllocator &allocator, PoolAllocator<TerrainTile> &tileAllocator) NOTHROWS
+    TAKErr fetch(std::shared_ptr<TerrainTile> &value_, double *els, const double resolution, const Envelope2 &mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices_, const bool fetchEl, const bool legacyEl, const bool constrainQueryRes, const bool fillWithHiRes, const bool compactVertices, BlockPoolAllocator &allocator, PoolAllocator<TerrainTile> &tileAllocator) NOTHROWS
     {
+        TE_TRACE_SCOPE("terrain", "ElMgrTerrainRenderService::fetch");
         TAKErr code(TE_Ok);
         std::shared_ptr<TerrainTile> value;
 
@@ -1395,148 +1614,25 @@ namespace
             TE_CHECKRETURN_CODE(code);
         }
 
-        // number of edge vertices is equal to perimeter length, plus one, to
-        // close the linestring
-        const std::size_t numEdgeVertices = ((numPostsLat-1u)*2u)+((numPostsLng-1u)*2u) + 1u;
-
-        bool hasData = fetchEl && !isnan(els[0]);
-        double minEl = !hasData ? 0.0 : els[0];
-        double maxEl = !hasData ? 0.0 : els[0];
+        bool hasData = false;
         if (fetchEl) {
-            for (std::size_t i = 1; i < (numPostsLat*numPostsLng); i++) {
+            for (std::size_t i = 0; i < (numPostsLat*numPostsLng); i++)
                 hasData |= !isnan(els[i]);
-                if (els[i] < minEl)
-                    minEl = els[i];
-                if (els[i] > maxEl)
-                    maxEl = els[i];
-            }
         }
 
-        double localOriginX = (mbb.minX+mbb.maxX)/2.0;
-        double localOriginY = (mbb.minY+mbb.maxY)/2.0;
-        double localOriginZ = (minEl+maxEl)/2.0;
-
         {
             std::unique_ptr<TerrainTile, void(*)(const TerrainTile *)> tileptr(nullptr, nullptr);
             code = tileAllocator.allocate(tileptr);
             TE_CHECKRETURN_CODE(code);
 
-            value = std::move(tileptr);
+            const TerrainTileDeleter deleter{tileptr.get_deleter(), 0u};
+            value = std::shared_ptr<TerrainTile>(tileptr.release(), deleter);
         }
-        value->data.srid = 4326;
-        value->data.localFrame.setToTranslate(localOriginX, localOriginY, localOriginZ);
-
-        const float skirtHeight = 500.0;
-
-        std::size_t numSkirtIndices;
-        code = Skirt_getNumOutputIndices(&numSkirtIndices, GL_TRIANGLE_STRIP, numEdgeVertices);
-        const std::size_t numIndices = GLTexture2_getNumQuadMeshIndices(numPostsLat - 1u, numPostsLng - 1u)
-                               + 2u // degenerate link to skirt
-                               + numSkirtIndices;
-
-        const std::size_t skirtOffset = GLTexture2_getNumQuadMeshIndices(numPostsLat - 1u, numPostsLng - 1u);
 
-        const std::size_t ib_size = numIndices * sizeof(uint16_t);
-        const std::size_t vb_size = (numPostsLat*numPostsLng * 3u + Skirt_getNumOutputVertices(numEdgeVertices) * 3u) * sizeof(float);
-
-        std::unique_ptr<void, void(*)(const void *)> buf(nullptr, nullptr);
-        // allocate the mesh data from the pool
-        code = allocator.allocate(buf);
-
-        MemBuffer2 indices(static_cast<uint16_t *>(buf.get()), numIndices);
-        code = createHeightmapMeshIndices(indices, edgeIndices_, numPostsLat, numPostsLng);
+        code = createHeightmapMesh(*value, mbb, fetchEl ? els : nullptr, numPostsLat, numPostsLng, edgeIndices_, compactVertices, allocator);
         TE_CHECKRETURN_CODE(code);
-
-        // duplicate the `edgeIndices` buffer for independent position/limit
-        MemBuffer2 edgeIndices(edgeIndices_.get(), edgeIndices_.size());
-        edgeIndices.limit(edgeIndices_.limit());
-        edgeIndices.position(edgeIndices_.position());
-
-        MemBuffer2 positions(static_cast<uint8_t *>(buf.get())+ib_size, vb_size);
-        for (std::size_t postLat = 0u; postLat < numPostsLat; postLat++) {
-            // tile row
-            for(std::size_t postLng = 0u; postLng < numPostsLng; postLng++) {
-                const double lat = mbb.minY+((mbb.maxY-mbb.minY)/(numPostsLat-1))*postLat;
-                const double lng = mbb.minX+((mbb.maxX-mbb.minX)/(numPostsLng-1))*postLng;
-                const double hae = (!fetchEl || isnan(els[(postLat*numPostsLng)+postLng])) ? 0.0 : els[(postLat*numPostsLng)+postLng];
-
-                const double x = lng-localOriginX;
-                const double y = lat-localOriginY;
-                const double z = hae-localOriginZ;
-
-                code = positions.put<float>((float)x);
-                TE_CHECKBREAK_CODE(code);
-                code = positions.put<float>((float)y);
-                TE_CHECKBREAK_CODE(code);
-                code = positions.put<float>((float)z);
-                TE_CHECKBREAK_CODE(code);
-            }
-            TE_CHECKBREAK_CODE(code);
-        }
-        TE_CHECKRETURN_CODE(code);
-        positions.flip();
-
-        code = Skirt_createVertices<float, uint16_t>(positions,
-                GL_TRIANGLE_STRIP,
-                3u*sizeof(float),
-                &edgeIndices,
-                numEdgeVertices,
-                skirtHeight);
-        TE_CHECKRETURN_CODE(code);
-
-        MeshPtr terrainMesh(nullptr, nullptr);
-
-        VertexDataLayout layout;
-        layout.interleaved = true;
-        layout.attributes = TEVA_Position;
-        layout.position.offset = 0u;
-        layout.position.stride = 12u;
-        layout.position.type = TEDT_Float32;
-        Envelope2 aabb;
-        aabb.minX = mbb.minX - localOriginX;
-        aabb.minY = mbb.minY - localOriginY;
-        aabb.minZ = (minEl-skirtHeight) - localOriginZ;
-        aabb.maxX = mbb.maxX - localOriginX;
-        aabb.maxY = mbb.maxY - localOriginY;
-        aabb.maxZ = maxEl - localOriginZ;
-
-        // create the mesh
-        code = MeshBuilder_buildInterleavedMesh(
-            terrainMesh,
-            TEDM_TriangleStrip,
-            TEWO_Clockwise,
-            layout,
-            0u,
-            nullptr,
-            aabb,
-            positions.limit() / (3u * sizeof(float)),
-            positions.get(),
-            TEDT_UInt16,
-            indices.limit() / sizeof(uint16_t),
-            indices.get(),
-            std::move(buf));
-
-        TE_CHECKRETURN_CODE(code);
-
-        value->data.srid = 4326;
-        value->data.value = std::move(terrainMesh);
-        value->data.localFrame.setToTranslate(localOriginX, localOriginY, localOriginZ);
-        value->data.interpolated = true;
-        value->skirtIndexOffset = skirtOffset;
-        value->aabb_wgs84 = value->data.value->getAABB();
-        value->aabb_wgs84.minX += localOriginX;
-        value->aabb_wgs84.minY += localOriginY;
-        value->aabb_wgs84.minZ += localOriginZ;
-        value->aabb_wgs84.maxX += localOriginX;
-        value->aabb_wgs84.maxY += localOriginY;
-        value->aabb_wgs84.maxZ += localOriginZ;
         value->hasData = hasData;
 
-        value->heightmap = true;
-        value->posts_x = numPostsLng;
-        value->posts_y = numPostsLat;
-        value->invert_y_axis = true;
-
         if(srid != value->data.srid) {
             VertexDataLayout layout_update = value->data.value->getVertexDataLayout();
             MeshTransformOptions srcOpts;
@@ -1545,6 +1641,8 @@ namespace
             srcOpts.layout = VertexDataLayoutPtr(&layout_update, Memory_leaker_const<VertexDataLayout>);
             MeshTransformOptions dstOpts;
             dstOpts.srid = srid;
+            // quantization is relative to the source AABB
+            dstOpts.layout = VertexDataLayoutPtr(new VertexDataLayout(getTransformedLayout()), Memory_deleter_const<VertexDataLayout>);
 
             MeshPtr transformed(nullptr, nullptr);
             MeshTransformOptions transformedOpts;
@@ -1571,6 +1669,7 @@ namespace
             srcOpts.localFrame = Matrix2Ptr(&node.localFrame, Memory_leaker_const<Matrix2>);
             MeshTransformOptions dstOpts;
             dstOpts.srid = 4978;
+            dstOpts.layout = VertexDataLayoutPtr(new VertexDataLayout(getTransformedLayout()), Memory_deleter_const<VertexDataLayout>);
             code = Mesh_transform(transformed, &transformedOpts, *node.value, srcOpts, dstOpts, nullptr);
             TE_CHECKRETURN_CODE(code);
 
@@ -1584,6 +1683,7 @@ namespace
             value->data_proj.value.reset();
             value->data_proj.srid = -1;
         }
+        accountTerrainTile(value);
         value_ = value;
         return code;
     }
@@ -1624,143 +1724,36 @@ namespace
         (tile).data.localFrame.transform(&p, p);
         return p.z;
     }
-    TAKErr derive(std::shared_ptr<TerrainTile>& value_, const Envelope2& mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2& edgeIndices_, const TerrainTile& deriveFrom, BlockPoolAllocator& allocator, PoolAllocator<TerrainTile>& tileAllocator) NOTHROWS
+    TAKErr derive(std::shared_ptr<TerrainTile>& value_, const Envelope2& mbb, const int srid, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2& edgeIndices_, const TerrainTile& deriveFrom, const bool compactVertices, BlockPoolAllocator& allocator, PoolAllocator<TerrainTile>& tileAllocator) NOTHROWS
     {
         TAKErr code(TE_Ok);
         std::shared_ptr<TerrainTile> value;
 
-        // number of edge vertices is equal to perimeter length, plus one, to
-        // close the linestring
-        const std::size_t numEdgeVertices = ((numPostsLat-1u)*2u)+((numPostsLng-1u)*2u) + 1u;
-
-        double localOriginX = (mbb.minX+mbb.maxX)/2.0;
-        double localOriginY = (mbb.minY+mbb.maxY)/2.0;
-        double localOriginZ = (deriveFrom.aabb_wgs84.minZ+deriveFrom.aabb_wgs84.maxZ)/2.0;
-
         {
             std::unique_ptr<TerrainTile, void(*)(const TerrainTile *)> tileptr(nullptr, nullptr);
             code = tileAllocator.allocate(tileptr);
             TE_CHECKRETURN_CODE(code);
 
-            value = std::move(tileptr);
+            const TerrainTileDeleter deleter{tileptr.get_deleter(), 0u};
+            value = std::shared_ptr<TerrainTile>(tileptr.release(), deleter);
         }
-        value->data.srid = 4326;
-        value->data.localFrame.setToTranslate(localOriginX, localOriginY, localOriginZ);
-
-        const float skirtHeight = 500.0;
-
-        std::size_t numSkirtIndices;
-        code = Skirt_getNumOutputIndices(&numSkirtIndices, GL_TRIANGLE_STRIP, numEdgeVertices);
-        const std::size_t numIndices = GLTexture2_getNumQuadMeshIndices(numPostsLat - 1u, numPostsLng - 1u)
-                               + 2u // degenerate link to skirt
-                               + numSkirtIndices;
-
-        const std::size_t skirtOffset = GLTexture2_getNumQuadMeshIndices(numPostsLat - 1u, numPostsLng - 1u);
-
-        const std::size_t ib_size = numIndices * sizeof(uint16_t);
-        const std::size_t vb_size = (numPostsLat*numPostsLng * 3u + Skirt_getNumOutputVertices(numEdgeVertices) * 3u) * sizeof(float);
-
-        std::unique_ptr<void, void(*)(const void *)> buf(nullptr, nullptr);
-        // allocate the mesh data from the pool
-        code = allocator.allocate(buf);
 
-        MemBuffer2 indices(static_cast<uint16_t *>(buf.get()), numIndices);
-        code = createHeightmapMeshIndices(indices, edgeIndices_, numPostsLat, numPostsLng);
-        TE_CHECKRETURN_CODE(code);
-
-        // duplicate the `edgeIndices` buffer for independent position/limit
-        MemBuffer2 edgeIndices(edgeIndices_.get(), edgeIndices_.size());
-        edgeIndices.limit(edgeIndices_.limit());
-        edgeIndices.position(edgeIndices_.position());
-
-        double minEl = deriveFrom.hasData ? getHeightMapElevation(deriveFrom, mbb.minY, mbb.minX) : 0.0;
-        double maxEl = deriveFrom.hasData ? getHeightMapElevation(deriveFrom, mbb.minY, mbb.minX) : 0.0;
-
-        MemBuffer2 positions(static_cast<uint8_t *>(buf.get())+ib_size, vb_size);
-        for (std::size_t postLat = 0u; postLat < numPostsLat; postLat++) {
-            // tile row
-            for(std::size_t postLng = 0u; postLng < numPostsLng; postLng++) {
-                const double lat = mbb.minY+((mbb.maxY-mbb.minY)/(numPostsLat-1))*postLat;
-                const double lng = mbb.minX+((mbb.maxX-mbb.minX)/(numPostsLng-1))*postLng;
-                const double hae = deriveFrom.hasData ? getHeightMapElevation(deriveFrom, lat, lng) : 0.0;
-
-                const double x = lng-localOriginX;
-                const double y = lat-localOriginY;
-                const double z = hae-localOriginZ;
-
-                code = positions.put<float>((float)x);
-                TE_CHECKBREAK_CODE(code);
-                code = positions.put<float>((float)y);
-                TE_CHECKBREAK_CODE(code);
-                code = positions.put<float>((float)z);
-                TE_CHECKBREAK_CODE(code);
+        std::vector<double> els;
+        if (deriveFrom.hasData) {
+            els.reserve(numPostsLat*numPostsLng);
+            for (std::size_t postLat = 0u; postLat < numPostsLat; postLat++) {
+                for(std::size_t postLng = 0u; postLng < numPostsLng; postLng++) {
+                    const double lat = mbb.minY+((mbb.maxY-mbb.minY)/(numPostsLat-1))*postLat;
+                    const double lng = mbb.minX+((mbb.maxX-mbb.minX)/(numPostsLng-1))*postLng;
+                    els.push_back(getHeightMapElevation(deriveFrom, lat, lng));
+                }
             }
-            TE_CHECKBREAK_CODE(code);
         }
-        TE_CHECKRETURN_CODE(code);
-        positions.flip();
-
-        code = Skirt_createVertices<float, uint16_t>(positions,
-                GL_TRIANGLE_STRIP,
-                3u*sizeof(float),
-                &edgeIndices,
-                numEdgeVertices,
-                skirtHeight);
-        TE_CHECKRETURN_CODE(code);
-
-        MeshPtr terrainMesh(nullptr, nullptr);
-
-        VertexDataLayout layout;
-        layout.interleaved = true;
-        layout.attributes = TEVA_Position;
-        layout.position.offset = 0u;
-        layout.position.stride = 12u;
-        layout.position.type = TEDT_Float32;
-        Envelope2 aabb;
-        aabb.minX = mbb.minX - localOriginX;
-        aabb.minY = mbb.minY - localOriginY;
-        aabb.minZ = (minEl-skirtHeight) - localOriginZ;
-        aabb.maxX = mbb.maxX - localOriginX;
-        aabb.maxY = mbb.maxY - localOriginY;
-        aabb.maxZ = maxEl - localOriginZ;
-
-        // create the mesh
-        code = MeshBuilder_buildInterleavedMesh(
-            terrainMesh,
-            TEDM_TriangleStrip,
-            TEWO_Clockwise,
-            layout,
-            0u,
-            nullptr,
-            aabb,
-            positions.limit() / (3u * sizeof(float)),
-            positions.get(),
-            TEDT_UInt16,
-            indices.limit() / sizeof(uint16_t),
-            indices.get(),
-            std::move(buf));
 
+        code = createHeightmapMesh(*value, mbb, els.empty() ? nullptr : els.data(), numPostsLat, numPostsLng, edgeIndices_, compactVertices, allocator);
         TE_CHECKRETURN_CODE(code);
-
-        value->data.srid = 4326;
-        value->data.value = std::move(terrainMesh);
-        value->data.localFrame.setToTranslate(localOriginX, localOriginY, localOriginZ);
-        value->data.interpolated = true;
-        value->skirtIndexOffset = skirtOffset;
-        value->aabb_wgs84 = value->data.value->getAABB();
-        value->aabb_wgs84.minX += localOriginX;
-        value->aabb_wgs84.minY += localOriginY;
-        value->aabb_wgs84.minZ += localOriginZ;
-        value->aabb_wgs84.maxX += localOriginX;
-        value->aabb_wgs84.maxY += localOriginY;
-        value->aabb_wgs84.maxZ += localOriginZ;
         value->hasData = deriveFrom.hasData;
 
-        value->heightmap = true;
-        value->posts_x = numPostsLng;
-        value->posts_y = numPostsLat;
-        value->invert_y_axis = true;
-
         if(srid != value->data.srid) {
             VertexDataLayout layout_update = value->data.value->getVertexDataLayout();
             MeshTransformOptions srcOpts;
@@ -1769,6 +1762,8 @@ namespace
             srcOpts.layout = VertexDataLayoutPtr(&layout_update, Memory_leaker_const<VertexDataLayout>);
             MeshTransformOptions dstOpts;
             dstOpts.srid = srid;
+            // quantization is relative to the source AABB
+            dstOpts.layout = VertexDataLayoutPtr(new VertexDataLayout(getTransformedLayout()), Memory_deleter_const<VertexDataLayout>);
 
             MeshPtr transformed(nullptr, nullptr);
             MeshTransformOptions transformedOpts;
@@ -1795,6 +1790,7 @@ namespace
             srcOpts.localFrame = Matrix2Ptr(&node.localFrame, Memory_leaker_const<Matrix2>);
             MeshTransformOptions dstOpts;
             dstOpts.srid = 4978;
+            dstOpts.layout = VertexDataLayoutPtr(new VertexDataLayout(getTransformedLayout()), Memory_deleter_const<VertexDataLayout>);
             code = Mesh_transform(transformed, &transformedOpts, *node.value, srcOpts, dstOpts, nullptr);
             TE_CHECKRETURN_CODE(code);
 
@@ -1809,10 +1805,193 @@ namespace
             value->data_proj.srid = -1;
         }
 
+        accountTerrainTile(value);
         value_ = value;
         return code;
     }
 
+    TAKErr createHeightmapMesh(TerrainTile &value, const Envelope2 &mbb, const double *els, const std::size_t numPostsLat, const std::size_t numPostsLng, const MemBuffer2 &edgeIndices_, const bool compactVertices, BlockPoolAllocator &allocator) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+
+        const std::size_t numEdgeVertices = getNumEdgeVertices(numPostsLat, numPostsLng);
+
+        // missing elevation values are treated as zero
+        double minEl = 0.0;
+        double maxEl = 0.0;
+        if (els) {
+            bool first = true;
+            for (std::size_t i = 0; i < (numPostsLat*numPostsLng); i++) {
+                const double el = isnan(els[i]) ? 0.0 : els[i];
+                if (first || el < minEl)
+                    minEl = el;
+                if (first || el > maxEl)
+                    maxEl = el;
+                first = false;
+            }
+        }
+
+        const double localOriginX = (mbb.minX+mbb.maxX)/2.0;
+        const double localOriginY = (mbb.minY+mbb.maxY)/2.0;
+        const double localOriginZ = (minEl+maxEl)/2.0;
+
+        const float skirtHeight = 500.0;
+
+        Envelope2 aabb;
+        aabb.minX = mbb.minX - localOriginX;
+        aabb.minY = mbb.minY - localOriginY;
+        aabb.minZ = (minEl-skirtHeight) - localOriginZ;
+        aabb.maxX = mbb.maxX - localOriginX;
+        aabb.maxY = mbb.maxY - localOriginY;
+        aabb.maxZ = maxEl - localOriginZ;
+
+        // grid and skirt topology is identical for all tiles of the same
+        // dimensions; the mesh references the shared indices
+        const QuadMeshIndices *gridIndices;
+        code = QuadMeshIndices_get(&gridIndices, numPostsLng - 1u, numPostsLat - 1u, true);
+        TE_CHECKRETURN_CODE(code);
+
+        const std::size_t vertexSize = 3u * (compactVertices ? sizeof(uint16_t) : sizeof(float));
+        const std::size_t vb_size = (numPostsLat*numPostsLng + Skirt_getNumOutputVertices(numEdgeVertices)) * vertexSize;
+
+        std::unique_ptr<void, void(*)(const void *)> buf(nullptr, nullptr);
+        // allocate the mesh data from the pool
+        code = allocator.allocate(buf);
+        TE_CHECKRETURN_CODE(code);
+
+        // duplicate the `edgeIndices` buffer for independent position/limit
+        MemBuffer2 edgeIndices(edgeIndices_.get(), edgeIndices_.size());
+        edgeIndices.limit(edgeIndices_.limit());
+        edgeIndices.position(edgeIndices_.position());
+
+        // compact vertices are quantized over the AABB; the quantization
+        // scale and offset are folded into the local frame so that
+        // consumers applying the local frame observe no difference
+        Matrix2 localFrame;
+        localFrame.setToTranslate(localOriginX, localOriginY, localOriginZ);
+        TAK::Engine::Math::Point2<double> quantizeScale(1.0, 1.0, 1.0);
+        if (compactVertices) {
+            quantizeScale.x = (aabb.maxX-aabb.minX) / 65535.0;
+            quantizeScale.y = (aabb.maxY-aabb.minY) / 65535.0;
+            quantizeScale.z = (aabb.maxZ-aabb.minZ) / 65535.0;
+            localFrame.translate(aabb.minX, aabb.minY, aabb.minZ);
+            localFrame.scale(quantizeScale.x, quantizeScale.y, quantizeScale.z);
+        }
+
+        MemBuffer2 positions(static_cast<uint8_t *>(buf.get()), vb_size);
+        for (std::size_t postLat = 0u; postLat < numPostsLat; postLat++) {
+            // tile row
+            for(std::size_t postLng = 0u; postLng < numPostsLng; postLng++) {
+                const double lat = mbb.minY+((mbb.maxY-mbb.minY)/(numPostsLat-1))*postLat;
+                const double lng = mbb.minX+((mbb.maxX-mbb.minX)/(numPostsLng-1))*postLng;
+                const double hae = (!els || isnan(els[(postLat*numPostsLng)+postLng])) ? 0.0 : els[(postLat*numPostsLng)+postLng];
+
+                const double x = lng-localOriginX;
+                const double y = lat-localOriginY;
+                const double z = hae-localOriginZ;
+
+                if (compactVertices) {
+                    code = positions.put<uint16_t>((uint16_t)MathUtils_clamp(round((x-aabb.minX)/quantizeScale.x), 0.0, 65535.0));
+                    TE_CHECKBREAK_CODE(code);
+                    code = positions.put<uint16_t>((uint16_t)MathUtils_clamp(round((y-aabb.minY)/quantizeScale.y), 0.0, 65535.0));
+                    TE_CHECKBREAK_CODE(code);
+                    code = positions.put<uint16_t>((uint16_t)MathUtils_clamp(round((z-aabb.minZ)/quantizeScale.z), 0.0, 65535.0));
+                    TE_CHECKBREAK_CODE(code);
+                } else {
+                    code = positions.put<float>((float)x);
+                    TE_CHECKBREAK_CODE(code);
+                    code = positions.put<float>((float)y);
+                    TE_CHECKBREAK_CODE(code);
+                    code = positions.put<float>((float)z);
+                    TE_CHECKBREAK_CODE(code);
+                }
+            }
+            TE_CHECKBREAK_CODE(code);
+        }
+        TE_CHECKRETURN_CODE(code);
+        positions.flip();
+
+        if (compactVertices) {
+            // the AABB includes the skirt, so the quantized skirt height
+            // (rounded down) never drops a vertex below zero
+            code = Skirt_createVertices<uint16_t, uint16_t>(positions,
+                    GL_TRIANGLE_STRIP,
+                    vertexSize,
+                    &edgeIndices,
+                    numEdgeVertices,
+                    (uint16_t)(skirtHeight/quantizeScale.z));
+        } else {
+            code = Skirt_createVertices<float, uint16_t>(positions,
+                    GL_TRIANGLE_STRIP,
+                    vertexSize,
+                    &edgeIndices,
+                    numEdgeVertices,
+                    skirtHeight);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        MeshPtr terrainMesh(nullptr, nullptr);
+
+        VertexDataLayout layout;
+        layout.interleaved = true;
+        layout.attributes = TEVA_Position;
+        layout.position.offset = 0u;
+        layout.position.stride = vertexSize;
+        layout.position.type = compactVertices ? TEDT_UInt16 : TEDT_Float32;
+
+        Envelope2 meshAabb(aabb);
+        if (compactVertices)
+            meshAabb = Envelope2(0.0, 0.0, 0.0, 65535.0, 65535.0, 65535.0);
+
+        // create the mesh
+        code = MeshBuilder_buildInterleavedMesh(
+            terrainMesh,
+            TEDM_TriangleStrip,
+            TEWO_Clockwise,
+            layout,
+            0u,
+            nullptr,
+            meshAabb,
+            positions.limit() / vertexSize,
+            positions.get(),
+            TEDT_UInt16,
+            gridIndices->numIndices,
+            gridIndices->indices,
+            std::move(buf));
+        TE_CHECKRETURN_CODE(code);
+
+        value.data.srid = 4326;
+        value.data.value = std::move(terrainMesh);
+        value.data.localFrame = localFrame;
+        value.data.interpolated = true;
+        value.skirtIndexOffset = gridIndices->skirtOffset;
+        value.aabb_wgs84 = aabb;
+        value.aabb_wgs84.minX += localOriginX;
+        value.aabb_wgs84.minY += localOriginY;
+        value.aabb_wgs84.minZ += localOriginZ;
+        value.aabb_wgs84.maxX += localOriginX;
+        value.aabb_wgs84.maxY += localOriginY;
+        value.aabb_wgs84.maxZ += localOriginZ;
+
+        value.heightmap = true;
+        value.posts_x = numPostsLng;
+        value.posts_y = numPostsLat;
+        value.invert_y_axis = true;
+
+        return code;
+    }
+    VertexDataLayout getTransformedLayout() NOTHROWS
+    {
+        // transformed meshes are not quantized
+        VertexDataLayout layout;
+        layout.interleaved = true;
+        layout.attributes = TEVA_Position;
+        layout.position.offset = 0u;
+        layout.position.stride = 12u;
+        layout.position.type = TEDT_Float32;
+        return layout;
+    }
+
     bool intersects(const Frustum2& frustum, const TAK::Engine::Feature::Envelope2& aabbWCS, const int srid, const double lng) NOTHROWS
     {
         return (frustum.intersects(AABB(TAK::Engine::Math::Point2<double>(aabbWCS.minX, aabbWCS.minY, aabbWCS.minZ), TAK::Engine::Math::Point2<double>(aabbWCS.maxX, aabbWCS.maxY, aabbWCS.maxZ))) ||
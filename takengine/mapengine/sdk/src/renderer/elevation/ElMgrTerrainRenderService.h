@@ -1,17 +1,18 @@
 #ifndef TAK_ENGINE_RENDERER_ELEVATION_ELMGRTERRAINRENDERSERVICE_H_INCLUDED
 #define TAK_ENGINE_RENDERER_ELEVATION_ELMGRTERRAINRENDERSERVICE_H_INCLUDED
 
+#include "core/CameraMotionPredictor.h"
 #include "core/MapSceneModel2.h"
 #include "core/RenderContext.h"
 #include "feature/Envelope2.h"
 #include "renderer/elevation/TerrainRenderService.h"
 #include "thread/Monitor.h"
 #include "thread/Thread.h"
-#include "thread/ThreadPool.h"
 #include "util/BlockPoolAllocator.h"
 #include "util/Error.h"
 #include "util/MemBuffer2.h"
 #include "util/PoolAllocator.h"
+#include "util/Work.h"
 
 namespace TAK {
     namespace Engine {
@@ -22,6 +23,7 @@ namespace TAK {
                 private :
                     class QuadNode;
                     class SourceRefresh;
+                    class MemoryTrimmer;
                     struct WorldTerrain
                     {
                         int srid {-1};
@@ -38,6 +40,9 @@ namespace TAK {
                         int srid {-1};
                         int sceneVersion {-1};
                         bool derive {false};
+                        /** the scene predicted from camera motion, valid if `predict` is `true` */
+                        TAK::Engine::Core::MapSceneModel2 predicted;
+                        bool predict {false};
                     };
                 public :
                     ElMgrTerrainRenderService(TAK::Engine::Core::RenderContext &ctx) NOTHROWS;
@@ -75,13 +80,35 @@ namespace TAK {
                     Util::TAKErr start() NOTHROWS;
                     Util::TAKErr stop() NOTHROWS;
                 private :
-                    Util::TAKErr enqueue(const std::shared_ptr<QuadNode> &node) NOTHROWS;
+                    /**
+                     * @param prefetch  If `true`, the node is only needed for
+                     *                  the predicted scene and is fetched
+                     *                  after nodes for the current scene
+                     */
+                    Util::TAKErr enqueue(const std::shared_ptr<QuadNode> &node, const bool prefetch = false) NOTHROWS;
+                    /**
+                     * Cancels queued requests that are no longer in view and
+                     * orders the remainder for fetch. Nodes for the current
+                     * scene are fetched before prefetch nodes; within each,
+                     * nodes are fetched in order of decreasing screen-space
+                     * error, weighted by proximity to the camera focus.
+                     * Must be invoked while holding `queue.monitor`.
+                     *
+                     * @param predicted The predicted scene; if `nullptr`,
+                     *                  all prefetch requests are canceled
+                     */
+                    void prioritizeQueue(const TAK::Engine::Core::MapSceneModel2 &scene, const TAK::Engine::Core::MapSceneModel2 *predicted) NOTHROWS;
                 private :
+                    /** services the fetch queue until empty or terminated */
                     static void *fetchWorkerThread(void *);
                     static void *requestWorkerThread(void *);
                 private :
                     struct {
-                        Thread::ThreadPoolPtr worker {Thread::ThreadPoolPtr(nullptr, nullptr)};
+                        Util::SharedWorkerPtr worker;
+                        /** number of fetch drains scheduled on `worker` */
+                        std::size_t activeFetchers {0u};
+                        /** maximum number of concurrent fetch drains */
+                        std::size_t maxFetchers {1u};
                         std::vector<std::shared_ptr<QuadNode>> entries;
                         bool sorted {false};
                         mutable Thread::Monitor monitor {Thread::TEMT_Recursive};
@@ -90,7 +117,12 @@ namespace TAK {
 
                     Request request;
 
+                    TAK::Engine::Core::CameraMotionPredictor motionPredictor;
+                    /** prediction interval for terrain prefetch, in milliseconds; prefetch is disabled if not positive */
+                    int64_t prefetchHorizon;
+
                     std::unique_ptr<SourceRefresh> sourceRefresh;
+                    std::unique_ptr<MemoryTrimmer> memoryTrimmer;
 
                     std::shared_ptr<QuadNode> east;
                     std::shared_ptr<QuadNode> west;
@@ -135,6 +167,8 @@ namespace TAK {
                         bool legacyElevationApi;
                         bool constrainQueryRes;
                         bool fillWithHiRes;
+                        /** if true, tile positions are quantized to 16 bits */
+                        bool compactVertices;
                     } fetchOptions;
 
                     Util::MemBuffer2 edgeIndices;
@@ -88,24 +88,20 @@ using namespace TAK::Engine::Util;
     "  vEl = (uLocalFrame * vec4(aVertexCoords.xyz, 1.0)).z;\n" \
     "}"
 
-    // hsv2rgb derived from https://www.laurivan.com/rgb-to-hsv-to-rgb-for-shaders/
+#define COLOR_RAMP_SIZE 256u
+#define COLOR_RAMP_SIZE_STR "256"
+
 #define SHADER_FSH \
     "precision mediump float;\n" \
     "uniform float uMinEl;\n" \
     "uniform float uMaxEl;\n" \
-    "uniform float uSaturation;\n" \
-    "uniform float uValue;\n" \
     "uniform float uAlpha;\n" \
+    "uniform sampler2D uColorRamp;\n" \
     "varying float vEl;\n" \
-    "vec3 hsv2rgb(vec3 hsv) {\n" \
-    "    vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);\n" \
-    "    vec3 p = abs(fract(hsv.xxx + K.xyz) * 6.0 - K.www);\n" \
-    "    return hsv.z * mix(K.xxx, clamp(p - K.xxx, 0.0, 1.0), hsv.y);" \
-    "}\n" \
     "void main(void) {\n" \
-    "  float hue = (1.0 - (clamp(vEl, uMinEl, uMaxEl)-uMinEl)/(uMaxEl-uMinEl)) * 2.0 / 3.0;\n" \
-    "  vec3 hsv = vec3(hue, uSaturation, uValue);\n" \
-    "  gl_FragColor = vec4(hsv2rgb(hsv).rgb, uAlpha);\n" \
+    "  float t = (clamp(vEl, uMinEl, uMaxEl)-uMinEl)/(uMaxEl-uMinEl);\n" \
+    "  vec4 color = texture2D(uColorRamp, vec2((t*" COLOR_RAMP_SIZE_STR ".0-t+0.5)/" COLOR_RAMP_SIZE_STR ".0, 0.5));\n" \
+    "  gl_FragColor = vec4(color.rgb, color.a*uAlpha);\n" \
     "}"
 
 namespace
@@ -116,9 +112,8 @@ namespace
         GLint uLocalFrame{ -1 };
         GLint uMinEl{ -1 };
         GLint uMaxEl{ -1 };
-        GLint uSaturation{ -1 };
-        GLint uValue{ -1 };
         GLint uAlpha{ -1 };
+        GLint uColorRamp{ -1 };
     };
 
     struct ShadersImpl
@@ -171,9 +166,8 @@ namespace
         s.base.base.aVertexCoords = glGetAttribLocation(s.base.base.handle, "aVertexCoords");
         s.uMinEl = glGetUniformLocation(s.base.base.handle, "uMinEl");
         s.uMaxEl = glGetUniformLocation(s.base.base.handle, "uMaxEl");
-        s.uSaturation = glGetUniformLocation(s.base.base.handle, "uSaturation");
-        s.uValue = glGetUniformLocation(s.base.base.handle, "uValue");
         s.uAlpha = glGetUniformLocation(s.base.base.handle, "uAlpha");
+        s.uColorRamp = glGetUniformLocation(s.base.base.handle, "uColorRamp");
         return TE_Ok;
     }
     TAKErr createShaders(const RenderContext &ctx, ShadersImpl& s) NOTHROWS
@@ -294,6 +288,49 @@ namespace
         return (T(0) < val) - (val < T(0));
     }
 
+    // hsv2rgb derived from https://www.laurivan.com/rgb-to-hsv-to-rgb-for-shaders/
+    uint32_t hsv2argb(const float h, const float s, const float v) NOTHROWS
+    {
+        uint32_t argb = 0xFF000000u;
+        const float K[4u] = { 1.f, 2.f / 3.f, 1.f / 3.f, 3.f };
+        for (std::size_t i = 0u; i < 3u; i++) {
+            const float f = h + K[i];
+            const float p = fabsf((f - floorf(f)) * 6.f - K[3u]);
+            const float c = v * (1.f + ((std::min(std::max(p - 1.f, 0.f), 1.f) - 1.f) * s));
+            argb |= (uint32_t)(c * 255.f + 0.5f) << (16u - 8u*i);
+        }
+        return argb;
+    }
+    /**
+     * Resamples the ramp, or the default hue ramp if empty, into
+     * `COLOR_RAMP_SIZE` RGBA texels.
+     */
+    void createColorRamp(uint8_t *rgba, const std::vector<uint32_t> &ramp, const float saturation, const float value) NOTHROWS
+    {
+        for (std::size_t i = 0u; i < COLOR_RAMP_SIZE; i++) {
+            const float t = (float)i / (float)(COLOR_RAMP_SIZE - 1u);
+            uint32_t argb[2u];
+            float weight = 0.f;
+            if (ramp.empty()) {
+                argb[0u] = hsv2argb((1.f - t) * 2.f / 3.f, saturation, value);
+                argb[1u] = argb[0u];
+            } else {
+                const float x = t * (float)(ramp.size() - 1u);
+                const std::size_t idx = std::min((std::size_t)x, ramp.size() - 1u);
+                argb[0u] = ramp[idx];
+                argb[1u] = ramp[std::min(idx + 1u, ramp.size() - 1u)];
+                weight = x - (float)idx;
+            }
+            // ARGB -> RGBA
+            const unsigned shifts[4u] = { 16u, 8u, 0u, 24u };
+            for (std::size_t j = 0u; j < 4u; j++) {
+                const float a = (float)((argb[0u] >> shifts[j]) & 0xFFu);
+                const float b = (float)((argb[1u] >> shifts[j]) & 0xFFu);
+                rgba[i * 4u + j] = (uint8_t)(a + (b - a) * weight + 0.5f);
+            }
+        }
+    }
+
     bool intersects(const GLGlobeBase &view, const bool handleIdlCrossing, const Frustum2 &frustum, const Envelope2 &aabbWCS) NOTHROWS
     {
         typedef TAK::Engine::Math::Point2<double> PointD;
@@ -316,6 +353,8 @@ GLElevationHeatMapLayer::GLElevationHeatMapLayer(ElevationHeatMapLayer &subject)
     range.dynamic_ = subject_.isDynamicRange();
     if (!range.dynamic_)
         subject_.getAbsoluteRange(&range.absolute.min_, &range.absolute.max_);
+    STLVectorAdapter<uint32_t> argb_a(colorRamp.argb_);
+    subject_.getColorRamp(argb_a);
 }
 GLElevationHeatMapLayer::~GLElevationHeatMapLayer() NOTHROWS
 {}
@@ -402,10 +441,15 @@ void GLElevationHeatMapLayer::draw(const GLGlobeBase& view, const int renderPass
     }
     glUniform1f(s.uMinEl, (float)minEl);
     glUniform1f(s.uMaxEl, (float)maxEl);
-    glUniform1f(s.uSaturation, saturation_);
-    glUniform1f(s.uValue, value_);
     glUniform1f(s.uAlpha, alpha_);
 
+    // the ramp is sampled from the unit following the terrain texture
+    validateColorRamp();
+    glActiveTexture(GL_TEXTURE0 + ctx.textureUnit + 1);
+    glBindTexture(GL_TEXTURE_2D, colorRamp.texture_);
+    glActiveTexture(GL_TEXTURE0 + ctx.textureUnit);
+    glUniform1i(s.uColorRamp, ctx.textureUnit + 1);
+
     Matrix2 proj;
     glOrtho(proj, (float)view.renderPass->left, (float)view.renderPass->right, (float)view.renderPass->bottom, (float)view.renderPass->top, (float)view.renderPass->scene.camera.near, (float)view.renderPass->scene.camera.far);
 
@@ -420,13 +464,46 @@ void GLElevationHeatMapLayer::draw(const GLGlobeBase& view, const int renderPass
         GLTerrainTile_drawTerrainTiles(ctx, &pass, 1u, &gltt, 1u);
     }
     GLTerrainTile_end(ctx);
+    glActiveTexture(GL_TEXTURE0 + ctx.textureUnit + 1);
+    glBindTexture(GL_TEXTURE_2D, GL_NONE);
+    glActiveTexture(GL_TEXTURE0 + ctx.textureUnit);
     view.getTerrainRenderService().unlock(terrainTiles_a);
 
     glDisable(GL_BLEND);
 }
+void GLElevationHeatMapLayer::validateColorRamp() NOTHROWS
+{
+    Lock lock(colorRamp.mutex_);
+    if (colorRamp.texture_ && !colorRamp.dirty_)
+        return;
+
+    uint8_t rgba[COLOR_RAMP_SIZE * 4u];
+    createColorRamp(rgba, colorRamp.argb_, saturation_, value_);
+    colorRamp.dirty_ = false;
+
+    GLint binding;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &binding);
+    if (!colorRamp.texture_) {
+        glGenTextures(1u, &colorRamp.texture_);
+        glBindTexture(GL_TEXTURE_2D, colorRamp.texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, COLOR_RAMP_SIZE, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, colorRamp.texture_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, COLOR_RAMP_SIZE, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    }
+    glBindTexture(GL_TEXTURE_2D, binding);
+}
 void GLElevationHeatMapLayer::release() NOTHROWS
 {
-    // nothing to release
+    Lock lock(colorRamp.mutex_);
+    if (colorRamp.texture_) {
+        glDeleteTextures(1u, &colorRamp.texture_);
+        colorRamp.texture_ = GL_NONE;
+    }
 }
 int GLElevationHeatMapLayer::getRenderPass() NOTHROWS
 {
@@ -446,6 +523,13 @@ void GLElevationHeatMapLayer::start() NOTHROWS
     if (!range.dynamic_)
         subject_.getAbsoluteRange(&range.absolute.min_, &range.absolute.max_);
     visible_ = subject_.isVisible();
+    {
+        Lock lock(colorRamp.mutex_);
+        colorRamp.argb_.clear();
+        STLVectorAdapter<uint32_t> argb_a(colorRamp.argb_);
+        subject_.getColorRamp(argb_a);
+        colorRamp.dirty_ = true;
+    }
 }
 void GLElevationHeatMapLayer::stop() NOTHROWS
 {
@@ -455,9 +539,19 @@ void GLElevationHeatMapLayer::stop() NOTHROWS
 }
 TAKErr GLElevationHeatMapLayer::onColorChanged(const ElevationHeatMapLayer& subject, const float saturation, const float value, const float alpha) NOTHROWS
 {
+    Lock lock(colorRamp.mutex_);
     saturation_ = saturation;
     value_ = value;
     alpha_ = alpha;
+    // the default ramp is derived from the saturation and value
+    colorRamp.dirty_ = true;
+    return TE_Ok;
+}
+TAKErr GLElevationHeatMapLayer::onColorRampChanged(const ElevationHeatMapLayer& subject, const uint32_t *argb, const std::size_t count) NOTHROWS
+{
+    Lock lock(colorRamp.mutex_);
+    colorRamp.argb_.assign(argb, argb + count);
+    colorRamp.dirty_ = true;
     return TE_Ok;
 }
 TAKErr GLElevationHeatMapLayer::onRangeChanged(const ElevationHeatMapLayer& subject, const double min, const double max, const bool dynamicRange) NOTHROWS
@@ -1,8 +1,12 @@
 #ifndef TAK_ENGINE_RENDERER_ELEVATION_GLELEVATIONHEATMAPLAYER_H_INCLUDED
 #define TAK_ENGINE_RENDERER_ELEVATION_GLELEVATIONHEATMAPLAYER_H_INCLUDED
 
+#include <vector>
+
 #include "elevation/ElevationHeatMapLayer.h"
+#include "renderer/GL.h"
 #include "renderer/core/GLLayer2.h"
+#include "thread/Mutex.h"
 
 namespace TAK {
     namespace Engine {
@@ -26,8 +30,12 @@ namespace TAK {
                 public : // ElevationHeatMapLayer::HeatMapListener
                     virtual Util::TAKErr onColorChanged(const TAK::Engine::Elevation::ElevationHeatMapLayer& subject, const float saturation, const float value, const float alpha) NOTHROWS;
                     virtual Util::TAKErr onRangeChanged(const TAK::Engine::Elevation::ElevationHeatMapLayer& subject, const double max, const double min, const bool dynamicRange) NOTHROWS;
+                    virtual Util::TAKErr onColorRampChanged(const TAK::Engine::Elevation::ElevationHeatMapLayer& subject, const uint32_t *argb, const std::size_t count) NOTHROWS;
                 public : // Layer2::VisibilityListener
                     virtual Util::TAKErr layerVisibilityChanged(const TAK::Engine::Core::Layer2 &layer, const bool visible) NOTHROWS;
+                private :
+                    /** (re)uploads the color ramp texture if it has changed */
+                    void validateColorRamp() NOTHROWS;
                 private :
                     TAK::Engine::Elevation::ElevationHeatMapLayer &subject_;
                     float saturation_;
@@ -41,6 +49,17 @@ namespace TAK {
                         bool dynamic_{ false };
                     } range;
                     bool visible_;
+                    /**
+                     * Elevations are colorized in the fragment shader via a
+                     * lookup into the ramp texture; changes to the range or
+                     * ramp do not require the terrain to be re-sampled.
+                     */
+                    struct {
+                        std::vector<uint32_t> argb_;
+                        GLuint texture_{ GL_NONE };
+                        bool dirty_{ true };
+                        Thread::Mutex mutex_;
+                    } colorRamp;
                 };
 
             }
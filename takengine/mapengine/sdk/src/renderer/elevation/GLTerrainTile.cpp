@@ -3,8 +3,11 @@
 #include "elevation/ElevationManager.h"
 #include "math/Ellipsoid2.h"
 #include "renderer/GLMatrix.h"
+#include "renderer/GLPerformanceCounters.h"
 #include "renderer/GLSLUtil.h"
 #include "thread/Mutex.h"
+#include "util/ConfigOptions.h"
+#include "util/MathUtils.h"
 
 using namespace TAK::Engine::Renderer::Elevation;
 
@@ -239,22 +242,59 @@ using namespace TAK::Engine::Util;
     "void main(void) {\n" \
     "  vFragColor = PackDepth(vDepth);\n" \
     "}"
+// packs the window depth; the far plane is pulled in so that it does not wrap
+#define OCCLUSION_FRAG_SHADER_SRC \
+    "#version 300 es\n" \
+    "precision highp float;\n" \
+    "out vec4 vFragColor;\n" \
+    PACK_DEPTH_FN_SRC \
+    "void main(void) {\n" \
+    "  vFragColor = PackDepth(min(gl_FragCoord.z, 0.99999));\n" \
+    "}"
+
+// heightmap displacement. Replaces the `aVertexCoords` attribute declaration
+// of a mesh vertex shader; `aGridCoords` is the quantized grid position and
+// the heightmap texel of the vertex. Heights are 16-bit, split over the
+// luminance (low) and alpha (high) channels. Grid posts that are dropped by
+// the next coarser level morph towards the average of their neighbors.
+#define HEIGHTMAP_VERT_FN_SRC(attributeQualifier, textureFn) \
+    "uniform highp sampler2D uHeightmap;\n" \
+    "uniform vec2 uHeightmapSize;\n" \
+    "uniform float uGridRows;\n" \
+    "uniform float uMorph;\n" \
+    attributeQualifier " vec4 aGridCoords;\n" \
+    "float heightmapTexel(vec2 st) {\n" \
+    "  vec4 c = floor(" textureFn "(uHeightmap, (st + 0.5) / uHeightmapSize) * 255.0 + 0.5);\n" \
+    "  return c.a*256.0 + c.r;\n" \
+    "}\n" \
+    "vec3 heightmapVertex() {\n" \
+    "  vec2 st = aGridCoords.zw;\n" \
+    "  float z = heightmapTexel(st);\n" \
+    "  vec2 d = mod(st, 2.0) * step(st.y, uGridRows - 0.5);\n" \
+    "  float coarse = 0.25 * (heightmapTexel(st - d) + heightmapTexel(st + vec2(d.x, -d.y)) + heightmapTexel(st + vec2(-d.x, d.y)) + heightmapTexel(st + d));\n" \
+    "  return vec3(aGridCoords.xy, mix(z, coarse, uMorph));\n" \
+    "}\n" \
+    "#define aVertexCoords heightmapVertex()\n"
 
 namespace
 {
     TAKErr lla2ecef_transform(Matrix2 *value, const Projection2 &ecef, const Matrix2 *localFrame) NOTHROWS;
     void setOrtho(Matrix2 *value, const double left, const double right, const double bottom, const double top, const double zNear, const double zFar) NOTHROWS;
-    void drawTerrainTilesImpl(const GLGlobeBase::State *renderPasses, const std::size_t numRenderPasses, const TerrainTileShader &shader, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTexture2 &texture, const GLTerrainTile *terrainTiles, const std::size_t numTiles, const float r, const float g, const float b, const float a) NOTHROWS;
+    void drawTerrainTilesImpl(const GLGlobeBase::State *renderPasses, const std::size_t numRenderPasses, TerrainTileRenderContext &ctx, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTexture2 &texture, const GLTerrainTile *terrainTiles, const std::size_t numTiles, const float r, const float g, const float b, const float a) NOTHROWS;
     void glUniformMatrix4(GLint location, const Matrix2 &matrix) NOTHROWS;
     void glUniformMatrix4v(GLint location, const Matrix2 *matrix, const std::size_t count) NOTHROWS;
-    void drawTerrainTileImpl(const Matrix2 &lla2tex, const TerrainTileShader &shader, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTerrainTile &gltile, const bool drawSkirt, const float r, const float g, const float b, const float a) NOTHROWS;
+    void drawTerrainTileImpl(const Matrix2 &lla2tex, TerrainTileRenderContext &ctx, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTerrainTile &gltile, const bool drawSkirt, const float r, const float g, const float b, const float a) NOTHROWS;
+    const TerrainTileShader &useShader(TerrainTileRenderContext &ctx, const GLTerrainTile &gltile) NOTHROWS;
+    float computeMorph(const TerrainTileRenderContext &ctx, const TerrainTile &tile) NOTHROWS;
     void glSceneModel(MapSceneModel2 &scene) NOTHROWS;
     TAKErr createTerrainTileShader(TerrainTileShader *value, const char *vertShaderSrc, const char *fragShaderSrc) NOTHROWS;
+    TAKErr createHeightmapShader(TerrainTileShader *value, const char *vertShaderSrc, const char *fragShaderSrc) NOTHROWS;
     TAKErr createTerrainTileShaders(TerrainTileShaders *value,
                                   const char *hiVertShaderSrc, const char *mdVertShaderSrc, const char *loVertShaderSrc,
                                   const char *fragShaderSrc) NOTHROWS;
 
     std::map<const RenderContext *, std::map<int, TerrainTileShaders>> colorShaders;
+    std::map<const RenderContext *, std::map<int, TerrainTileShaders>> occlusionShaders;
 
 }
 
@@ -337,12 +377,18 @@ TerrainTileRenderContext TAK::Engine::Renderer::Elevation::GLTerrainTile_begin(c
                                 shaders.hi :
                                 (gsd <= shaders.md_threshold) ?
                                 shaders.md : shaders.lo;
+    ctx.heightmapShader = (gsd <= shaders.hi_threshold) ?
+                                shaders.heightmap.hi :
+                                (gsd <= shaders.md_threshold) ?
+                                shaders.heightmap.md : shaders.heightmap.lo;
 
     glUseProgram(ctx.shader.base.handle);
+    ctx.program = ctx.shader.base.handle;
     GLint activeTexture;
     glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+    ctx.textureUnit = activeTexture - GL_TEXTURE0;
 
-    glUniform1i(ctx.shader.base.uTexture, activeTexture - GL_TEXTURE0);
+    glUniform1i(ctx.shader.base.uTexture, ctx.textureUnit);
     glUniform1f(ctx.shader.uTexWidth, 1.f);
     glUniform1f(ctx.shader.uTexHeight, 1.f);
 
@@ -459,6 +505,15 @@ TerrainTileRenderContext TAK::Engine::Renderer::Elevation::GLTerrainTile_begin(c
         ctx.hasSecondary = true;
     }
 
+    if(ctx.heightmapShader.base.handle) {
+        scene.projection->inverse(&ctx.morph.camera, scene.camera.location);
+        if(scene.camera.mode == MapCamera2::Perspective)
+            ctx.morph.gsdPerMeter = MapSceneModel2_gsd(1.0, scene.camera.fov, scene.height);
+        else
+            ctx.morph.gsd = scene.gsd;
+        ctx.morph.threshold = ConfigOptions_getDoubleOptionOrDefault("terrain.heightmap-morph-pixels", 8.0);
+    }
+
     glEnableVertexAttribArray(ctx.shader.base.aVertexCoords);
 
     return ctx;
@@ -467,9 +522,11 @@ void TAK::Engine::Renderer::Elevation::GLTerrainTile_bindTexture(TerrainTileRend
 {
     if (ctx.texid != texid) {
         glBindTexture(GL_TEXTURE_2D, texid);
-        glUniform1f(ctx.shader.uTexWidth, static_cast<float>(texWidth));
-        glUniform1f(ctx.shader.uTexHeight, static_cast<float>(texHeight));
+        glUniform1f(ctx.program == ctx.shader.base.handle ? ctx.shader.uTexWidth : ctx.heightmapShader.uTexWidth, static_cast<float>(texWidth));
+        glUniform1f(ctx.program == ctx.shader.base.handle ? ctx.shader.uTexHeight : ctx.heightmapShader.uTexHeight, static_cast<float>(texHeight));
         ctx.texid = texid;
+        ctx.texWidth = texWidth;
+        ctx.texHeight = texHeight;
     }
 }
 void TAK::Engine::Renderer::Elevation::GLTerrainTile_setElevationScale(TerrainTileRenderContext &ctx, const float elevationScale) NOTHROWS
@@ -484,24 +541,31 @@ void TAK::Engine::Renderer::Elevation::GLTerrainTile_drawTerrainTiles(TerrainTil
     GLTexture2 *tex = nullptr;
 
     // primary first pass
-    drawTerrainTilesImpl(states, numStates, ctx.shader, ctx.mvp.primary, ctx.localFrame.primary, ctx.numLocalFrames, *tex, terrainTile, numTiles, r, g, b, a);
+    drawTerrainTilesImpl(states, numStates, ctx, ctx.mvp.primary, ctx.localFrame.primary, ctx.numLocalFrames, *tex, terrainTile, numTiles, r, g, b, a);
     if(ctx.hasSecondary)
-        drawTerrainTilesImpl(states, numStates, ctx.shader, ctx.mvp.secondary, ctx.localFrame.secondary, ctx.numLocalFrames, *tex, terrainTile, numTiles, r, g, b, a);
+        drawTerrainTilesImpl(states, numStates, ctx, ctx.mvp.secondary, ctx.localFrame.secondary, ctx.numLocalFrames, *tex, terrainTile, numTiles, r, g, b, a);
 }
 void TAK::Engine::Renderer::Elevation::GLTerrainTile_drawTerrainTiles(TerrainTileRenderContext& ctx, const Matrix2& lla2tex, const GLTerrainTile* terrainTiles, const std::size_t numTiles, const float r, const float g, const float b, const float a) NOTHROWS
 {
     // draw terrain tiles
     for (std::size_t idx = 0u; idx < numTiles; idx++) {
         auto tile = terrainTiles[idx];
-        drawTerrainTileImpl(lla2tex, ctx.shader, ctx.mvp.primary, ctx.localFrame.primary, ctx.numLocalFrames, tile, a == 1.f, r, g, b, a);
+        drawTerrainTileImpl(lla2tex, ctx, ctx.mvp.primary, ctx.localFrame.primary, ctx.numLocalFrames, tile, a == 1.f, r, g, b, a);
         if(ctx.hasSecondary)
-            drawTerrainTileImpl(lla2tex, ctx.shader, ctx.mvp.secondary, ctx.localFrame.secondary, ctx.numLocalFrames, tile, a == 1.f, r, g, b, a);
+            drawTerrainTileImpl(lla2tex, ctx, ctx.mvp.secondary, ctx.localFrame.secondary, ctx.numLocalFrames, tile, a == 1.f, r, g, b, a);
     }
 }
 
 void TAK::Engine::Renderer::Elevation::GLTerrainTile_end(TerrainTileRenderContext &ctx) NOTHROWS
 {
-    glDisableVertexAttribArray(ctx.shader.base.aVertexCoords);
+    if(ctx.program == ctx.shader.base.handle) {
+        glDisableVertexAttribArray(ctx.shader.base.aVertexCoords);
+    } else {
+        glDisableVertexAttribArray(ctx.heightmapShader.base.aVertexCoords);
+        glActiveTexture(GL_TEXTURE0 + ctx.textureUnit + 1);
+        glBindTexture(GL_TEXTURE_2D, GL_NONE);
+        glActiveTexture(GL_TEXTURE0 + ctx.textureUnit);
+    }
     glUseProgram(0);
 }
 
@@ -517,6 +581,9 @@ TerrainTileShaders TAK::Engine::Renderer::Elevation::GLTerrainTile_getColorShade
     shaders.hi.base.handle = GL_NONE;
     shaders.md.base.handle = GL_NONE;
     shaders.lo.base.handle = GL_NONE;
+    shaders.heightmap.hi.base.handle = GL_NONE;
+    shaders.heightmap.md.base.handle = GL_NONE;
+    shaders.heightmap.lo.base.handle = GL_NONE;
 
     switch (srid) {
         case 4978 :
@@ -563,6 +630,9 @@ TerrainTileShaders TAK::Engine::Renderer::Elevation::GLTerrainTile_getDepthShade
     shaders.hi.base.handle = GL_NONE;
     shaders.md.base.handle = GL_NONE;
     shaders.lo.base.handle = GL_NONE;
+    shaders.heightmap.hi.base.handle = GL_NONE;
+    shaders.heightmap.md.base.handle = GL_NONE;
+    shaders.heightmap.lo.base.handle = GL_NONE;
 
     switch (srid) {
         case 4978 :
@@ -597,6 +667,70 @@ TerrainTileShaders TAK::Engine::Renderer::Elevation::GLTerrainTile_getDepthShade
     }
     return shaders;
 }
+TerrainTileShaders TAK::Engine::Renderer::Elevation::GLTerrainTile_getOcclusionShader(const TAK::Engine::Core::RenderContext &ctx, const int srid) NOTHROWS
+{
+    static Mutex m;
+    Lock lock(m);
+    auto entry = occlusionShaders[&ctx].find(srid);
+    if(entry != occlusionShaders[&ctx].end())
+        return entry->second;
+
+    TerrainTileShaders shaders;
+    shaders.hi.base.handle = GL_NONE;
+    shaders.md.base.handle = GL_NONE;
+    shaders.lo.base.handle = GL_NONE;
+    shaders.heightmap.hi.base.handle = GL_NONE;
+    shaders.heightmap.md.base.handle = GL_NONE;
+    shaders.heightmap.lo.base.handle = GL_NONE;
+
+    switch (srid) {
+        case 4978 :
+        {
+            createTerrainTileShaders(&shaders,
+                    DEPTH_PLANAR_VERT_SHADER_SRC, DEPTH_ECEF_VERT_MD_SHADER_SRC, DEPTH_ECEF_VERT_LO_SHADER_SRC,
+                    OCCLUSION_FRAG_SHADER_SRC);
+#ifndef __ANDROID__
+            shaders.hi_threshold = 1.5;
+            shaders.md_threshold = 100.0;
+#else
+            shaders.hi_threshold = 1.5;
+            shaders.md_threshold = 0.0;
+#endif
+            occlusionShaders[&ctx][srid] = shaders;
+            break;
+        }
+        case 4326 :
+        {
+            createTerrainTileShaders(&shaders,
+                    DEPTH_PLANAR_VERT_SHADER_SRC, DEPTH_PLANAR_VERT_SHADER_SRC, DEPTH_PLANAR_VERT_SHADER_SRC,
+                    OCCLUSION_FRAG_SHADER_SRC);
+            shaders.hi_threshold = 0.0;
+            shaders.md_threshold = 0.0;
+            occlusionShaders[&ctx][srid] = shaders;
+            break;
+        }
+        default :
+        {
+            break;
+        }
+    }
+    return shaders;
+}
+GLenum TAK::Engine::Renderer::Elevation::GLTerrainTile_getPositionType(const TerrainTile &tile) NOTHROWS
+{
+    if(tile.data.value && tile.data.value->getVertexDataLayout().position.type == TEDT_UInt16)
+        return GL_UNSIGNED_SHORT;
+    return GL_FLOAT;
+}
+bool TAK::Engine::Renderer::Elevation::GLTerrainTile_isHeightmapEnabled() NOTHROWS
+{
+    if(!ConfigOptions_getIntOptionOrDefault("terrain.gpu-heightmap", 0))
+        return false;
+    // vertex texture fetch is optional for GLES 2.0
+    GLint maxVertexTextureUnits = 0;
+    glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &maxVertexTextureUnits);
+    return maxVertexTextureUnits > 0;
+}
 
 namespace
 {
@@ -670,7 +804,7 @@ namespace
         return code;
     }
 
-    void drawTerrainTilesImpl(const GLGlobeBase::State *renderPasses, const std::size_t numRenderPasses, const TerrainTileShader &shader, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTexture2 &ignored0, const GLTerrainTile *terrainTiles, const std::size_t numTiles, const float r, const float g, const float b, const float a) NOTHROWS
+    void drawTerrainTilesImpl(const GLGlobeBase::State *renderPasses, const std::size_t numRenderPasses, TerrainTileRenderContext &ctx, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTexture2 &ignored0, const GLTerrainTile *terrainTiles, const std::size_t numTiles, const float r, const float g, const float b, const float a) NOTHROWS
     {
         // draw terrain tiles
         for (std::size_t idx = 0u; idx < numTiles; idx++) {
@@ -688,7 +822,7 @@ namespace
                     lla2tex.concatenate(s.scene.forwardTransform);
                     if(swapHemi)
                         lla2tex.translate(s.drawLng > 0.0 ? 360.0 : -360.0, 0.0, 0.0);
-                    drawTerrainTileImpl(lla2tex, shader, mvp, local, numLocal, tile, a == 1.f, r, g, b, a);
+                    drawTerrainTileImpl(lla2tex, ctx, mvp, local, numLocal, tile, a == 1.f, r, g, b, a);
                 }
             }
         }
@@ -722,13 +856,14 @@ namespace
         glUniformMatrix4fv(location, static_cast<GLsizei>(limit), false, matrixF);
     }
 
-    void drawTerrainTileImpl(const Matrix2 &lla2tex, const TerrainTileShader &shader, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTerrainTile &gltile, const bool drawSkirt, const float r, const float g, const float b, const float a) NOTHROWS
+    void drawTerrainTileImpl(const Matrix2 &lla2tex, TerrainTileRenderContext &ctx, const Matrix2 &mvp, const Matrix2 *local, const std::size_t numLocal, const GLTerrainTile &gltile, const bool drawSkirt, const float r, const float g, const float b, const float a) NOTHROWS
     {
         if(!gltile.tile)
             return;
 
         TAKErr code(TE_Ok);
         const TerrainTile &tile = *gltile.tile;
+        const TerrainTileShader &shader = useShader(ctx, gltile);
 
         int drawMode;
         switch (tile.data.value->getDrawMode()) {
@@ -805,12 +940,27 @@ namespace
         // render offscreen texture
         const VertexDataLayout &layout = tile.data.value->getVertexDataLayout();
 
-        if(gltile.vbo) {
+        if(shader.uHeightmap >= 0) {
+            // shared grid, displaced by the heightmap
+            glActiveTexture(GL_TEXTURE0 + ctx.textureUnit + 1);
+            glBindTexture(GL_TEXTURE_2D, gltile.heightmap);
+            glActiveTexture(GL_TEXTURE0 + ctx.textureUnit);
+            const std::size_t heightmapRows = (tile.data.value->getNumVertices() + tile.posts_x - 1u) / tile.posts_x;
+            glUniform2f(shader.uHeightmapSize, static_cast<float>(tile.posts_x), static_cast<float>(heightmapRows));
+            glUniform1f(shader.uGridRows, static_cast<float>(tile.posts_y));
+            glUniform1f(shader.uMorph, computeMorph(ctx, tile));
+
+            glBindBuffer(GL_ARRAY_BUFFER, gltile.vbo);
+            glVertexAttribPointer(shader.base.aVertexCoords, 4u, GL_UNSIGNED_SHORT, false, 4u*sizeof(uint16_t), (void *)0);
+            glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+        } else if(gltile.vbo && !gltile.heightmap) {
             // VBO
             glBindBuffer(GL_ARRAY_BUFFER, gltile.vbo);
-            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GL_FLOAT, false, static_cast<GLsizei>(layout.position.stride), (void *)layout.position.offset);
+            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GLTerrainTile_getPositionType(tile), false, static_cast<GLsizei>(layout.position.stride), (void *)layout.position.offset);
             glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
         } else {
+            // the mesh is not resident or the VBO is the shared heightmap
+            // grid, which the shader cannot displace
             const void *vertexCoords;
             code = tile.data.value->getVertices(&vertexCoords, TEVA_Position);
             if (code != TE_Ok) {
@@ -818,7 +968,7 @@ namespace
                 return;
             }
 
-            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GL_FLOAT, false, static_cast<GLsizei>(layout.position.stride), static_cast<const uint8_t *>(vertexCoords) + layout.position.offset);
+            glVertexAttribPointer(shader.base.aVertexCoords, 3u, GLTerrainTile_getPositionType(tile), false, static_cast<GLsizei>(layout.position.stride), static_cast<const uint8_t *>(vertexCoords) + layout.position.offset);
         }
 
         if (tile.data.value->isIndexed()) {
@@ -844,17 +994,59 @@ namespace
             if(gltile.ibo) {
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gltile.ibo);
                 glDrawElements(drawMode, static_cast<GLsizei>(numIndices), glIndexType, (void *)tile.data.value->getIndexOffset());
+                GLPerformanceCounters_draw(drawMode, numIndices);
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
             } else {
                 glDrawElements(drawMode, static_cast<GLsizei>(numIndices), glIndexType, static_cast<const uint8_t *>(tile.data.value->getIndices()) + tile.data.value->getIndexOffset());
+                GLPerformanceCounters_draw(drawMode, numIndices);
             }
         } else {
             glDrawArrays(drawMode, 0u, static_cast<GLsizei>(tile.data.value->getNumVertices()));
+            GLPerformanceCounters_draw(drawMode, tile.data.value->getNumVertices());
         }
 
         if (hasWinding)
             glDisable(GL_CULL_FACE);
     }
+    const TerrainTileShader &useShader(TerrainTileRenderContext &ctx, const GLTerrainTile &gltile) NOTHROWS
+    {
+        const bool heightmap = gltile.heightmap && ctx.heightmapShader.base.handle;
+        const TerrainTileShader &shader = heightmap ? ctx.heightmapShader : ctx.shader;
+        if(ctx.program == shader.base.handle)
+            return shader;
+
+        // switch programs, carrying over the uniforms common to both
+        glDisableVertexAttribArray(heightmap ? ctx.shader.base.aVertexCoords : ctx.heightmapShader.base.aVertexCoords);
+        glUseProgram(shader.base.handle);
+        glUniform1i(shader.base.uTexture, ctx.textureUnit);
+        glUniform1f(shader.uTexWidth, static_cast<float>(ctx.texWidth));
+        glUniform1f(shader.uTexHeight, static_cast<float>(ctx.texHeight));
+        glUniform1f(shader.uElevationScale, ctx.elevationScale);
+        if(heightmap)
+            glUniform1i(shader.uHeightmap, ctx.textureUnit + 1);
+        glEnableVertexAttribArray(shader.base.aVertexCoords);
+        ctx.program = shader.base.handle;
+        return shader;
+    }
+    float computeMorph(const TerrainTileRenderContext &ctx, const TerrainTile &tile) NOTHROWS
+    {
+        if(ctx.morph.threshold <= 0.0 || tile.posts_y < 2u)
+            return 0.f;
+        const TAK::Engine::Feature::Envelope2 &aabb = tile.aabb_wgs84;
+        const GeoPoint2 center((aabb.minY+aabb.maxY)/2.0, (aabb.minX+aabb.maxX)/2.0);
+
+        // screen space post spacing at the tile center
+        const double spacing = (aabb.maxY-aabb.minY) / (double)(tile.posts_y-1u) * GeoPoint2_approximateMetersPerDegreeLatitude(center.latitude);
+        const double dh = GeoPoint2_distance(ctx.morph.camera, center, true);
+        const double dv = isnan(ctx.morph.camera.altitude) ? 0.0 : ctx.morph.camera.altitude - (aabb.minZ+aabb.maxZ)/2.0;
+        const double gsd = ctx.morph.gsd + ctx.morph.gsdPerMeter*sqrt(dh*dh + dv*dv);
+        if(gsd <= 0.0)
+            return 0.f;
+        const double pixels = spacing / gsd;
+
+        // no morph at or above the threshold, fully morphed at half
+        return static_cast<float>(MathUtils_clamp(2.0 - 2.0*pixels/ctx.morph.threshold, 0.0, 1.0));
+    }
     void glSceneModel(MapSceneModel2 &scene) NOTHROWS
     {
             const std::size_t vflipHeight = scene.height;
@@ -890,12 +1082,33 @@ namespace
         value->uElevationScale = glGetUniformLocation(value->base.handle, "uElevationScale");
         value->uLocalTransform = glGetUniformLocation(value->base.handle, "uLocalTransform");
         value->base.aVertexCoords = glGetAttribLocation(value->base.handle, "aVertexCoords");
+        value->uHeightmap = glGetUniformLocation(value->base.handle, "uHeightmap");
+        value->uHeightmapSize = glGetUniformLocation(value->base.handle, "uHeightmapSize");
+        value->uGridRows = glGetUniformLocation(value->base.handle, "uGridRows");
+        value->uMorph = glGetUniformLocation(value->base.handle, "uMorph");
+        if(value->uHeightmap >= 0)
+            value->base.aVertexCoords = glGetAttribLocation(value->base.handle, "aGridCoords");
         // fragment shader handles
         value->base.uTexture = glGetUniformLocation(value->base.handle, "uTexture");
         value->base.uColor = glGetUniformLocation(value->base.handle, "uColor");
 
         return code;
     }
+    TAKErr createHeightmapShader(TerrainTileShader *value, const char *vertShaderSrc, const char *fragShaderSrc) NOTHROWS
+    {
+        // substitute the vertex attribute with the heightmap displacement
+        static const char *attributeDecls[2u] = {"attribute vec3 aVertexCoords;\n", "in vec3 aVertexCoords;\n"};
+        static const char *heightmapDecls[2u] = {HEIGHTMAP_VERT_FN_SRC("attribute", "texture2D"), HEIGHTMAP_VERT_FN_SRC("in", "texture")};
+        std::string src(vertShaderSrc);
+        for(std::size_t i = 0u; i < 2u; i++) {
+            const std::size_t pos = src.find(attributeDecls[i]);
+            if(pos == std::string::npos)
+                continue;
+            src.replace(pos, strlen(attributeDecls[i]), heightmapDecls[i]);
+            return createTerrainTileShader(value, src.c_str(), fragShaderSrc);
+        }
+        return TE_InvalidArg;
+    }
     TAKErr createTerrainTileShaders(TerrainTileShaders *value,
                                   const char *hiVertShaderSrc, const char *mdVertShaderSrc, const char *loVertShaderSrc,
                                   const char *fragShaderSrc) NOTHROWS
@@ -914,6 +1127,25 @@ namespace
             TE_CHECKRETURN_CODE(code);
         }
 
+        // heightmap displacement variants are optional; tiles fall back on
+        // the mesh shaders
+        if(GLTerrainTile_isHeightmapEnabled()) {
+            TerrainTileShaders heightmap;
+            heightmap.hi.base.handle = GL_NONE;
+            heightmap.md.base.handle = GL_NONE;
+            heightmap.lo.base.handle = GL_NONE;
+            if((!hiVertShaderSrc || createHeightmapShader(&heightmap.hi, hiVertShaderSrc, fragShaderSrc) == TE_Ok) &&
+               (!mdVertShaderSrc || createHeightmapShader(&heightmap.md, mdVertShaderSrc, fragShaderSrc) == TE_Ok) &&
+               (!loVertShaderSrc || createHeightmapShader(&heightmap.lo, loVertShaderSrc, fragShaderSrc) == TE_Ok)) {
+
+                value->heightmap.hi = heightmap.hi;
+                value->heightmap.md = heightmap.md;
+                value->heightmap.lo = heightmap.lo;
+            } else {
+                Logger_log(TELL_Warning, "GLTerrainTile: failed to create heightmap shaders");
+            }
+        }
+
         return code;
     }
 }
@@ -151,6 +151,26 @@ namespace TAK {
 
                 TerrainTileShaders GLTerrainTile_getColorShader(const TAK::Engine::Core::RenderContext &ctx, const int srid) NOTHROWS;
                 TerrainTileShaders GLTerrainTile_getDepthShader(const TAK::Engine::Core::RenderContext &ctx, const int srid) NOTHROWS;
+                /**
+                 * Returns shaders that encode the window depth of the
+                 * terrain surface into RGBA, for CPU readback.
+                 */
+                TerrainTileShaders GLTerrainTile_getOcclusionShader(const TAK::Engine::Core::RenderContext &ctx, const int srid) NOTHROWS;
+                /**
+                 * Returns the GL type of the tile's vertex positions.
+                 * Compact tiles store quantized positions that are
+                 * dequantized by the tile's local frame; the values must
+                 * not be normalized.
+                 */
+                GLenum GLTerrainTile_getPositionType(const TerrainTile &tile) NOTHROWS;
+                /**
+                 * Returns `true` if tiles may be drawn by displacing a shared
+                 * grid by a per-tile heightmap texture. Heightmap
+                 * displacement is enabled via the `terrain.gpu-heightmap`
+                 * option and requires vertex texture fetch. Must be invoked
+                 * on the GL thread.
+                 */
+                bool GLTerrainTile_isHeightmapEnabled() NOTHROWS;
             }
         }
     }
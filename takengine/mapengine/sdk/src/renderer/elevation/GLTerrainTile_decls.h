@@ -1,6 +1,7 @@
 #ifndef TAK_ENGINE_RENDERER_ELEVATION_GLTERRAINTILE_DECLS_H
 #define TAK_ENGINE_RENDERER_ELEVATION_GLTERRAINTILE_DECLS_H
 
+#include "core/GeoPoint2.h"
 #include "port/Platform.h"
 #include "renderer/GL.h"
 #include "renderer/Shader.h"
@@ -18,17 +19,39 @@ namespace TAK {
                 {
                     /** The terrain tile */
                     std::shared_ptr<const TAK::Engine::Renderer::Elevation::TerrainTile> tile;
-                    /** Optionally allocated VBO containing the tile data */
+                    /**
+                     * Optionally allocated VBO containing the tile data. If
+                     * `heightmap` is allocated, the VBO is the grid shared
+                     * with other tiles of the same dimensions.
+                     */
                     GLuint vbo {GL_NONE};
                     /** Optionally allocated IBO containing the tile data (if indexed) */
                     GLuint ibo {GL_NONE};
+                    /**
+                     * If `true`, `ibo` is shared with other tiles and is
+                     * reference counted by the owning renderer
+                     */
+                    bool sharedIbo {false};
+                    /**
+                     * Optionally allocated texture containing the quantized
+                     * height of each tile vertex, for displacement of the
+                     * shared grid in `vbo`
+                     */
+                    GLuint heightmap {GL_NONE};
                 };
 
                 struct TerrainTileRenderContext
                 {
                     // render state
                     TerrainTileShader shader;
+                    /** heightmap displacement variant of `shader`, handle is `GL_NONE` if unavailable */
+                    TerrainTileShader heightmapShader;
+                    /** the active program, one of `shader` or `heightmapShader` */
+                    GLuint program {GL_NONE};
                     GLuint texid {GL_NONE};
+                    std::size_t texWidth {1u};
+                    std::size_t texHeight {1u};
+                    GLint textureUnit {0};
 
                     // transforms
                     struct {
@@ -42,6 +65,16 @@ namespace TAK {
                     } mvp;
                     bool hasSecondary {false};
                     float elevationScale {1.f};
+
+                    // heightmap LOD morph
+                    struct {
+                        TAK::Engine::Core::GeoPoint2 camera;
+                        /** ground sample distance, meters per pixel, is `gsd + gsdPerMeter*range` */
+                        double gsd {0.0};
+                        double gsdPerMeter {0.0};
+                        /** post spacing, in pixels, below which posts morph towards the next coarser level */
+                        double threshold {0.0};
+                    } morph;
                 };
             }
         }
@@ -16,6 +16,12 @@ namespace TAK {
                 struct ENGINE_API TerrainTile : TAK::Engine::Util::Allocatable<TerrainTile>
                 {
                     std::size_t skirtIndexOffset{0};
+                    /**
+                     * The tile mesh. Positions may be 32-bit float or, for
+                     * compact tiles, unsigned 16-bit values quantized over
+                     * the mesh AABB; in either case `data.localFrame`
+                     * transforms positions to the mesh SRID.
+                     */
                     TAK::Engine::Elevation::ElevationChunk::Data data;
                     /** WGS84 AABB, x=longtitude, y=latitude, z=hae */
                     TAK::Engine::Feature::Envelope2 aabb_wgs84;
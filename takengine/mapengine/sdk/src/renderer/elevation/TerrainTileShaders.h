@@ -16,6 +16,11 @@ namespace TAK {
                     int uTexWidth;
                     int uTexHeight;
                     int uElevationScale;
+                    // heightmap displacement; `-1` for mesh shaders
+                    int uHeightmap {-1};
+                    int uHeightmapSize {-1};
+                    int uGridRows {-1};
+                    int uMorph {-1};
                 };
 
                 struct TerrainTileShaders
@@ -23,6 +28,16 @@ namespace TAK {
                     TerrainTileShader hi;
                     TerrainTileShader md;
                     TerrainTileShader lo;
+                    /**
+                     * Variants of `hi`, `md` and `lo` that displace a shared
+                     * grid by the tile heightmap texture. Handles are
+                     * `GL_NONE` if heightmap displacement is not enabled.
+                     */
+                    struct {
+                        TerrainTileShader hi;
+                        TerrainTileShader md;
+                        TerrainTileShader lo;
+                    } heightmap;
                     /** if `drawMapResolution` <= threshold, use `hi` */
                     double hi_threshold;
                     /** if `drawMapResolution` <= threshold, use `md` */
@@ -13,7 +13,9 @@
 #include "renderer/feature/GLBatchMultiPolygon2.h"
 #include "renderer/feature/GLBatchPoint2.h"
 #include "renderer/feature/GLBatchPolygon2.h"
+#include "util/AllocationTagging.h"
 #include "util/Memory.h"
+#include "util/Trace.h"
 
 
 using namespace TAK::Engine::Renderer::Feature;
@@ -170,6 +172,8 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer::setBackgroundThreadName(WorkerTh
 
 TAKErr GLBatchGeometryFeatureDataStoreRenderer::query(QueryContext &ctx, const ViewState &state) NOTHROWS
 {
+    TE_TRACE_SCOPE("feature", "GLBatchGeometryFeatureDataStoreRenderer::query");
+    TE_ALLOCATION_TAG(TEAT_FeatureQuery);
     TAKErr code;
 
     code = TE_Ok;
@@ -566,9 +570,7 @@ namespace
                 entry = styleMap.find(styleString);
                 if (entry == styleMap.end()) {
                     StylePtr_const parsed(nullptr, nullptr);
-                    try {
-                        parsed = StylePtr_const(atakmap::feature::Style::parseStyle(styleString), atakmap::feature::Style::destructStyle);
-                    } catch (...) {}
+                    atakmap::feature::Style_parseStyleShared(parsed, styleString);
                     if (parsed.get()) {
                         value = std::move(parsed);
                         styleMap.insert(std::pair<std::string, std::shared_ptr<const atakmap::feature::Style>>(styleString, value));
@@ -2,9 +2,16 @@
 
 #include "renderer/feature/GLBatchGeometryFeatureDataStoreRenderer2.h"
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "feature/FeatureCursor2.h"
+#include "feature/Point.h"
 #include "port/STLListAdapter.h"
 #include "port/STLVectorAdapter.h"
+#include "port/Platform.h"
 #include "port/StringBuilder.h"
 #include "raster/osm/OSMUtils.h"
 #include "renderer/feature/GLBatchGeometryCollection3.h"
@@ -14,7 +21,9 @@
 #include "renderer/feature/GLBatchMultiPolygon3.h"
 #include "renderer/feature/GLBatchPoint3.h"
 #include "renderer/feature/GLBatchPolygon3.h"
+#include "util/AllocationTagging.h"
 #include "util/Memory.h"
+#include "util/Trace.h"
 
 
 using namespace TAK::Engine::Renderer::Feature;
@@ -32,12 +41,33 @@ using namespace atakmap::renderer;
 using namespace atakmap::util;
 
 #define STALE_LIMIT 5
+// pad for strokes extending past the geometry, in pixels
+#define DIRTY_REGION_MARGIN 32.0
+// regions beyond this count are merged
+#define MAX_DIRTY_REGIONS 64u
+// ID-buffer picks not delivered within this period fall back to the CPU, in
+// milliseconds
+#define PICK_TIMEOUT 250LL
+// over-fetch on each side of the view, as a fraction of the view extent
+#define QUERY_MARGIN 0.25
 
 namespace
 {
     double distance(double x1, double y1, double x2, double y2);
     TAKErr getStyle(std::shared_ptr<const Style> &value, FeatureCursor2 &cursor, std::map<std::string, std::shared_ptr<const Style>> &styleMap) NOTHROWS;
     void releaseGLBatchGeometryRunnable(void *) NOTHROWS;
+    void markDirty(GLDirtyRegion &value, const Envelope2 &bounds, const double margin) NOTHROWS;
+    void pickCallback(void *opaque, const TAKErr code, const std::vector<int64_t> &fids) NOTHROWS;
+    /** conservatively tests the bounds against the region of the view state */
+    bool intersects(const TAK::Engine::Renderer::Core::GLGlobeBase::State &state, const Envelope2 &bounds) NOTHROWS;
+
+    struct PickResult
+    {
+        Monitor monitor;
+        bool done {false};
+        TAKErr code {TE_Ok};
+        std::vector<int64_t> fids;
+    };
 
     struct FeatureResult
     {
@@ -69,11 +99,18 @@ namespace
     public :
         std::list<FeatureResult> pendingData;
         int64_t queryCount;
+        /** surface regions changed by the query */
+        GLDirtyRegion dirty;
+        /** `true` if the query results were delivered to the back buffer */
+        bool batched;
     };
 }
 
 GLBatchGeometryFeatureDataStoreRendererOptions2::GLBatchGeometryFeatureDataStoreRendererOptions2() NOTHROWS
-    : skipSameLodOptimization(false) { }
+    : skipSameLodOptimization(false),
+      skipIncrementalUpdates(false),
+      idBufferPicking(false),
+      clusterPoints(false) { }
 
 GLBatchGeometryFeatureDataStoreRenderer2::GLBatchGeometryFeatureDataStoreRenderer2(TAK::Engine::Core::RenderContext &surface_, FeatureDataStore2 &subject_) NOTHROWS :
     GLAsynchronousMapRenderable3(),
@@ -86,6 +123,8 @@ GLBatchGeometryFeatureDataStoreRenderer2::GLBatchGeometryFeatureDataStoreRendere
     renderHeightPump(0.0f)
 {
     hittest.reset(new HitTestImpl(*this));
+    batchRenderer1->setIncrementalUpdates(!options.skipIncrementalUpdates);
+    batchRenderer2->setIncrementalUpdates(!options.skipIncrementalUpdates);
 }
 
 GLBatchGeometryFeatureDataStoreRenderer2::GLBatchGeometryFeatureDataStoreRenderer2(TAK::Engine::Core::RenderContext &surface_, FeatureDataStore2 &subject_, const GLBatchGeometryRenderer3::CachePolicy &cachePolicy) NOTHROWS  :
@@ -99,6 +138,8 @@ GLBatchGeometryFeatureDataStoreRenderer2::GLBatchGeometryFeatureDataStoreRendere
     renderHeightPump(0.0f)
 {
     hittest.reset(new HitTestImpl(*this));
+    batchRenderer1->setIncrementalUpdates(!options.skipIncrementalUpdates);
+    batchRenderer2->setIncrementalUpdates(!options.skipIncrementalUpdates);
 }
 
 GLBatchGeometryFeatureDataStoreRenderer2::GLBatchGeometryFeatureDataStoreRenderer2(TAK::Engine::Core::RenderContext &surface_, FeatureDataStore2 &subject_, const GLBatchGeometryRenderer3::CachePolicy &cachePolicy, const GLBatchGeometryFeatureDataStoreRendererOptions2 &opts) NOTHROWS :
@@ -113,6 +154,10 @@ GLBatchGeometryFeatureDataStoreRenderer2::GLBatchGeometryFeatureDataStoreRendere
     renderHeightPump(0.0f)
 {
     hittest.reset(new HitTestImpl(*this));
+    batchRenderer1->setIncrementalUpdates(!options.skipIncrementalUpdates);
+    batchRenderer2->setIncrementalUpdates(!options.skipIncrementalUpdates);
+    if (options.clusterPoints)
+        clusterer.reset(new PointClusterer(options.clusterOptions));
 }
 
 /**************************************************************************/
@@ -127,6 +172,10 @@ void GLBatchGeometryFeatureDataStoreRenderer2::draw(const GLMapView2 &view, cons
     if(renderPass&GLMapView2::Sprites)
         renderHeightPump = (float)(view.top - view.bottom);
 
+    // deliver picks issued by either renderer
+    batchRenderer1->processPendingPicks(false);
+    batchRenderer2->processPendingPicks(false);
+
     // XXX - layer visibility
 
     GLAsynchronousMapRenderable3::draw(view, renderPass);
@@ -169,6 +218,8 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::getRenderables(Collection<GLMap
 TAKErr GLBatchGeometryFeatureDataStoreRenderer2::resetQueryContext(QueryContext &ctx) NOTHROWS
 {
     static_cast<QueryContextImpl &>(ctx).pendingData.clear();
+    static_cast<QueryContextImpl &>(ctx).dirty.clear();
+    static_cast<QueryContextImpl &>(ctx).batched = false;
     return TE_Ok;
 }
 
@@ -180,7 +231,9 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::createQueryContext(QueryContext
 
 TAKErr GLBatchGeometryFeatureDataStoreRenderer2::updateRenderableLists(QueryContext &ctx) NOTHROWS
 {
-    // XXX - check for cancellation
+    // the back buffer is not populated if the query was cancelled or failed
+    if (!static_cast<QueryContextImpl &>(ctx).batched)
+        return TE_Done;
     GLBatchGeometryRenderer3 *swap = back;
     back = front;
     front = swap;
@@ -189,6 +242,19 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::updateRenderableLists(QueryCont
     return TE_Ok;
 }
 
+TAKErr GLBatchGeometryFeatureDataStoreRenderer2::getSurfaceDirtyRegion(GLDirtyRegion &value, QueryContext &ctx) NOTHROWS
+{
+    value = static_cast<QueryContextImpl &>(ctx).dirty;
+    if (value.size() > MAX_DIRTY_REGIONS)
+        value.compact();
+    return TE_Ok;
+}
+
+double GLBatchGeometryFeatureDataStoreRenderer2::getQueryMargin() const NOTHROWS
+{
+    return QUERY_MARGIN;
+}
+
 TAKErr GLBatchGeometryFeatureDataStoreRenderer2::getBackgroundThreadName(TAK::Engine::Port::String &value) NOTHROWS
 {
     StringBuilder strm;
@@ -201,6 +267,8 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::getBackgroundThreadName(TAK::En
 
 TAKErr GLBatchGeometryFeatureDataStoreRenderer2::query(QueryContext &ctx, const GLMapView2::State &state) NOTHROWS
 {
+    TE_TRACE_SCOPE("feature", "GLBatchGeometryFeatureDataStoreRenderer2::query");
+    TE_ALLOCATION_TAG(TEAT_FeatureQuery);
     TAKErr code(TE_Ok);
 
     const bool crossIdl = (state.westBound > state.eastBound);
@@ -218,12 +286,23 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::query(QueryContext &ctx, const
         stateW.westBound = -180;
 
         code = this->queryImpl(ctx, stateE);
+        if (code == TE_Canceled)
+            return code;
         TE_CHECKRETURN_CODE(code);
 
         code = this->queryImpl(ctx, stateW);
+        if (code == TE_Canceled)
+            return code;
         TE_CHECKRETURN_CODE(code);
     } else {
         code = this->queryImpl(ctx, state);
+        if (code == TE_Canceled)
+            return code;
+        TE_CHECKRETURN_CODE(code);
+    }
+
+    if (this->clusterer) {
+        code = this->applyClustering(ctx, state);
         TE_CHECKRETURN_CODE(code);
     }
 
@@ -259,6 +338,7 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::query(QueryContext &ctx, const
 
     STLVectorAdapter<std::shared_ptr<GLBatchGeometry3>> adapter(update);
     code = back->setBatch(adapter);
+    static_cast<QueryContextImpl &>(ctx).batched = true;
 
     return TE_Ok;
 }
@@ -270,6 +350,7 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
     code = TE_Ok;
 
     std::list<FeatureResult> &result = static_cast<QueryContextImpl &>(ctx).pendingData;
+    GLDirtyRegion &dirty = static_cast<QueryContextImpl &>(ctx).dirty;
     static_cast<QueryContextImpl &>(ctx).queryCount++;
 
     const int lod = OSMUtils::mapnikTileLevel(state.drawMapResolution);
@@ -302,6 +383,9 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
 
     params.ignoredFields = FeatureDataStore2::FeatureQueryParameters::AttributesField;
 
+    // margin for dirty regions, in degrees
+    const double dirtyMargin = (state.drawMapResolution * DIRTY_REGION_MARGIN) / 111319.49;
+
     try {
         std::map<std::string, std::shared_ptr<const atakmap::feature::Style>> styleMap;
 
@@ -315,9 +399,24 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
         // release entries
         std::unique_ptr<std::vector< std::shared_ptr<GLBatchGeometry3>>> releaseGeometry(new std::vector< std::shared_ptr<GLBatchGeometry3>>());
 
-        code = this->dataStore.queryFeatures(cursor, params);
+        code = TE_Done;
+        if (this->options.tileCache) {
+            const Envelope2 region(state.westBound, state.southBound, 0.0, state.eastBound, state.northBound, 0.0);
+            code = this->options.tileCache->query(cursor, this->dataStore, region, lod);
+        }
+        // query the store directly if tiles are not in use or not available
+        // for the region
+        if (code != TE_Ok)
+            code = this->dataStore.queryFeatures(cursor, params);
         TE_CHECKRETURN_CODE(code);
         do {
+            // abandon the query if the view has moved on; features not yet
+            // delivered are picked up by the query for the latest state
+            if (ctx.isCancelled()) {
+                code = TE_Canceled;
+                break;
+            }
+
             code = cursor->moveToNext();
             TE_CHECKBREAK_CODE(code);
 
@@ -331,6 +430,10 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
             std::map<int64_t, GLGeometryRecord>::iterator glitemEntry;
             glitemEntry = this->glSpatialItems.find(featureId);
             if (glitemEntry != this->glSpatialItems.end()) {
+                // features spanning multiple tiles are reported once per tile
+                if (glitemEntry->second.touched == static_cast<QueryContextImpl &>(ctx).queryCount)
+                    continue;
+
                 glitem = glitemEntry->second.geometry;
 
                 // the feature is being used on this pump, mark it as touched
@@ -359,6 +462,8 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
             int type;
             GLBatchGeometry3::BlobPtr blob(nullptr, nullptr);
             GeometryPtr_const geomPtr(nullptr, nullptr);
+            Envelope2 bounds;
+            bool hasBounds = false;
 
             if (cursor->getGeomCoding() == FeatureDefinition2::GeomBlob) {
                 FeatureDefinition2::RawData  rawGeometry;
@@ -391,9 +496,21 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
                 default:
                     continue;
                 }
-                // skip the SRID and MBR
-                code = blob->skip(36);
+                // skip the SRID
+                code = blob->skip(4);
+                TE_CHECKBREAK_CODE(code);
+                // MBR
+                code = blob->readDouble(&bounds.minX);
+                TE_CHECKBREAK_CODE(code);
+                code = blob->readDouble(&bounds.minY);
+                TE_CHECKBREAK_CODE(code);
+                code = blob->readDouble(&bounds.maxX);
+                TE_CHECKBREAK_CODE(code);
+                code = blob->readDouble(&bounds.maxY);
                 TE_CHECKBREAK_CODE(code);
+                bounds.minZ = 0.0;
+                bounds.maxZ = 0.0;
+                hasBounds = true;
 
                 // marker byte
                 code = blob->readByte(&b);
@@ -433,6 +550,12 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
                 } else {
                     return TE_IllegalState;
                 }
+
+                try {
+                    const atakmap::feature::Envelope env = geomPtr->getEnvelope();
+                    bounds = Envelope2(env.minX, env.minY, 0.0, env.maxX, env.maxY, 0.0);
+                    hasBounds = true;
+                } catch (...) {}
             }
 
             if (glitem.get()) {
@@ -544,8 +667,22 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
                 else
                     glitem->init(featureId, name, GeometryPtr_const(nullptr, Memory_leaker_const<Geometry>), altitudeMode, extrude, style);
 
-                this->glSpatialItems[featureId] = { glitem, static_cast<QueryContextImpl &>(ctx).queryCount };
+                // replacing a feature of a different geometry type
+                if (glitemEntry != this->glSpatialItems.end() && glitemEntry->second.hasBounds)
+                    markDirty(dirty, glitemEntry->second.bounds, dirtyMargin);
+                if (hasBounds)
+                    markDirty(dirty, bounds, dirtyMargin);
+
+                this->glSpatialItems[featureId] = { glitem, static_cast<QueryContextImpl &>(ctx).queryCount, false, bounds, hasBounds, style };
             } else if (glitem->version != featureVersion || lod != glitem->lod) {
+                // both the previous and updated geometry are redrawn
+                if (glitemEntry->second.hasBounds)
+                    markDirty(dirty, glitemEntry->second.bounds, dirtyMargin);
+                if (hasBounds)
+                    markDirty(dirty, bounds, dirtyMargin);
+                glitemEntry->second.bounds = bounds;
+                glitemEntry->second.hasBounds = hasBounds;
+
                 r.altModeUpdate = cursor->getAltitudeMode();
                 r.extrudeUpdate = cursor->getExtrude();
 
@@ -574,6 +711,7 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
                     TE_CHECKBREAK_CODE(code);
                     if (style.get())
                         r.styleUpdate = style;
+                    glitemEntry->second.style = style;
                 }
             }
 
@@ -587,6 +725,8 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
         } while (true);
         if (code == TE_Done)
             code = TE_Ok;
+        else if (code == TE_Canceled)
+            return code;
         TE_CHECKRETURN_CODE(code);
 
         cursor.reset();
@@ -611,10 +751,12 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
         auto stale = glSpatialItems.begin();
         
         while (stale != glSpatialItems.end()) {
-            bool visible = stale->second.touched == queryCount;
+            bool visible = stale->second.touched == queryCount && !stale->second.clustered;
             if (visible != stale->second.visible) {
                 stale->second.visible = visible;
                 stale->second.geometry->setVisible(visible);
+                if (stale->second.hasBounds)
+                    markDirty(dirty, stale->second.bounds, dirtyMargin);
             }
             if ((queryCount - stale->second.touched) > STALE_LIMIT) {
                 releaseGeometry->push_back(stale->second.geometry);
@@ -643,9 +785,144 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::queryImpl(QueryContext &ctx, co
     }
 }
 
+TAKErr GLBatchGeometryFeatureDataStoreRenderer2::applyClustering(QueryContext &ctx, const GLMapView2::State &state) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    std::list<FeatureResult> &result = static_cast<QueryContextImpl &>(ctx).pendingData;
+    const int lod = OSMUtils::mapnikTileLevel(state.drawMapResolution);
+
+    // the clustered set tracks the points of the current query; only points
+    // that were added, moved or removed invalidate the clusters
+    std::unordered_map<int64_t, std::list<FeatureResult>::iterator> points;
+    for (auto it = result.begin(); it != result.end(); it++) {
+        if (!dynamic_cast<const GLBatchPoint3 *>(it->target.get()))
+            continue;
+        const int64_t fid = it->target->featureId;
+        auto record = this->glSpatialItems.find(fid);
+        if (record == this->glSpatialItems.end() || !record->second.hasBounds)
+            continue;
+        if (this->clusterer->insert(fid, record->second.bounds.minY, record->second.bounds.minX) != TE_Ok)
+            continue;
+        points[fid] = it;
+    }
+    for (auto it = this->glSpatialItems.begin(); it != this->glSpatialItems.end(); it++) {
+        if (points.find(it->first) == points.end())
+            this->clusterer->remove(it->first);
+    }
+
+    std::vector<PointClusterer::Cluster> clusters;
+    const Envelope2 region(state.westBound, state.southBound, 0.0, state.eastBound, state.northBound, 0.0);
+    code = this->clusterer->getClusters(clusters, region, lod);
+    TE_CHECKRETURN_CODE(code);
+
+    std::unique_ptr<std::vector<std::shared_ptr<GLBatchGeometry3>>> releaseGeometry(new std::vector<std::shared_ptr<GLBatchGeometry3>>());
+    std::map<int64_t, ClusterRecord> clusterItems;
+    std::unordered_set<int64_t> clustered;
+    std::vector<int64_t> leaves;
+    for (std::size_t i = 0u; i < clusters.size(); i++) {
+        const PointClusterer::Cluster &cluster = clusters[i];
+        if (cluster.count < 2u)
+            continue;
+
+        leaves.clear();
+        code = this->clusterer->getLeaves(leaves, cluster.id, lod);
+        TE_CHECKBREAK_CODE(code);
+        for (std::size_t j = 0u; j < leaves.size(); j++) {
+            auto leaf = points.find(leaves[j]);
+            if (leaf == points.end())
+                continue;
+            result.erase(leaf->second);
+            points.erase(leaf);
+            clustered.insert(leaves[j]);
+        }
+
+        StringBuilder label;
+        label << cluster.count;
+
+        FeatureResult r;
+        ClusterRecord item;
+        auto existing = this->clusterItems.find(cluster.id);
+        if (existing == this->clusterItems.end()) {
+            std::shared_ptr<const Style> style;
+            auto seed = this->glSpatialItems.find(cluster.id);
+            if (seed != this->glSpatialItems.end())
+                style = seed->second.style;
+
+            item.geometry.reset(new GLBatchPoint3(this->surface));
+            item.geometry->init(cluster.id, label.c_str(),
+                                GeometryPtr_const(new Point(cluster.longitude, cluster.latitude), Memory_deleter_const<Geometry>),
+                                TEAM_ClampToGround, 0.0, style);
+        } else {
+            item = existing->second;
+            this->clusterItems.erase(existing);
+            if (item.longitude != cluster.longitude || item.latitude != cluster.latitude)
+                r.geomUpdate = GeometryPtr_const(new Point(cluster.longitude, cluster.latitude), Memory_deleter_const<Geometry>);
+            if (item.count != cluster.count)
+                r.nameUpdate.reset(new TAK::Engine::Port::String(label.c_str()));
+        }
+        item.count = cluster.count;
+        item.longitude = cluster.longitude;
+        item.latitude = cluster.latitude;
+
+        r.target = item.geometry;
+        result.push_back(std::move(r));
+        clusterItems[cluster.id] = item;
+    }
+
+    // clusters that are no longer present
+    for (auto it = this->clusterItems.begin(); it != this->clusterItems.end(); it++)
+        releaseGeometry->push_back(it->second.geometry);
+    this->clusterItems.swap(clusterItems);
+    if (!releaseGeometry->empty())
+        surface.queueEvent(releaseGLBatchGeometryRunnable, std::unique_ptr<void, void(*)(const void *)>(releaseGeometry.release(), Memory_leaker_const<void>));
+    TE_CHECKRETURN_CODE(code);
+
+    // hide the labels of the clustered points
+    for (auto it = this->glSpatialItems.begin(); it != this->glSpatialItems.end(); it++) {
+        GLGeometryRecord &record = it->second;
+        const bool isClustered = clustered.find(it->first) != clustered.end();
+        if (record.clustered == isClustered)
+            continue;
+        record.clustered = isClustered;
+        const bool visible = (record.touched == static_cast<QueryContextImpl &>(ctx).queryCount) && !isClustered;
+        if (visible != record.visible) {
+            record.visible = visible;
+            record.geometry->setVisible(visible);
+        }
+    }
+
+    return code;
+}
+
 void GLBatchGeometryFeatureDataStoreRenderer2::onDataStoreContentChanged(FeatureDataStore2 &data_store) NOTHROWS
 {
-    this->invalidate();
+    // the surface is not marked dirty here; the query reports the regions of
+    // the changed features
+    if (this->options.tileCache)
+        this->options.tileCache->clear();
+
+    Monitor::Lock lock(monitor_);
+    invalid_ = true;
+    surface.requestRefresh();
+}
+
+void GLBatchGeometryFeatureDataStoreRenderer2::onDataStoreContentChanged(FeatureDataStore2 &data_store, const FeatureDataStore2::ContentChange &change) NOTHROWS
+{
+    if (change.unbounded || !change.hasBounds) {
+        onDataStoreContentChanged(data_store);
+        return;
+    }
+
+    // features outside of the queried region are picked up by the query
+    // that follows the next change in view
+    if (this->options.tileCache)
+        this->options.tileCache->clear();
+
+    Monitor::Lock lock(monitor_);
+    if (!intersects(prepared_state_, change.bounds) && !intersects(target_state_, change.bounds))
+        return;
+    invalid_ = true;
+    surface.requestRefresh();
 }
 
 /**************************************************************************/
@@ -656,12 +933,50 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::hitTest2(Collection<int64_t> &f
     TAKErr code(TE_Ok);
     Point touchPt(touch.longitude, touch.latitude);
 
+    // the pick is serviced by the GL thread; it cannot be awaited there
+    bool picked = false;
+    if (options.idBufferPicking && !surface.isRenderThread()) {
+        std::shared_ptr<PickResult> pick(new PickResult());
+        {
+            ReadLock rlock(renderables_mutex_);
+            code = rlock.status;
+            TE_CHECKRETURN_CODE(code);
+
+            std::unique_ptr<std::shared_ptr<PickResult>> opaque(new std::shared_ptr<PickResult>(pick));
+            code = this->front->requestPick(pickCallback, opaque.get(), screenX, renderHeightPump-screenY, static_cast<int>(radius));
+            if (code == TE_Ok)
+                opaque.release();
+        }
+        if (code == TE_Ok) {
+            surface.requestRefresh();
+
+            Monitor::Lock lock(pick->monitor);
+            code = lock.status;
+            TE_CHECKRETURN_CODE(code);
+
+            const int64_t timeout = Platform_systime_millis() + PICK_TIMEOUT;
+            while (!pick->done) {
+                const int64_t remaining = timeout - Platform_systime_millis();
+                if (remaining <= 0LL)
+                    break;
+                lock.wait(remaining);
+            }
+            if (pick->done && pick->code == TE_Ok) {
+                for (auto it = pick->fids.begin(); it != pick->fids.end() && fids.size() < limit; it++)
+                    fids.add(*it);
+                picked = true;
+            }
+        }
+    }
+    if (fids.size() >= limit)
+        return TE_Ok;
+
     // lock the features for read
     ReadLock rlock(renderables_mutex_);
     code = rlock.status;
     TE_CHECKRETURN_CODE(code);
 
-    // do hit test
+    // do hit test; if picked, only the geometries not covered by the pick
     this->front->hitTest2(
         fids,
         touchPt,
@@ -670,7 +985,8 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::hitTest2(Collection<int64_t> &f
         resolution,
         static_cast<int>(radius),
         static_cast<int>(limit),
-        FeatureDataStore2::FEATURE_ID_NONE);
+        FeatureDataStore2::FEATURE_ID_NONE,
+        picked);
 
     return TE_Ok;
 }
@@ -686,6 +1002,25 @@ TAKErr GLBatchGeometryFeatureDataStoreRenderer2::HitTestImpl::hitTest(Collection
 
 namespace
 {
+    void pickCallback(void *opaque, const TAKErr code, const std::vector<int64_t> &fids) NOTHROWS
+    {
+        std::unique_ptr<std::shared_ptr<PickResult>> result(static_cast<std::shared_ptr<PickResult> *>(opaque));
+        PickResult &pick = **result;
+        Monitor::Lock lock(pick.monitor);
+        pick.code = code;
+        pick.fids = fids;
+        pick.done = true;
+        lock.broadcast();
+    }
+
+    bool intersects(const TAK::Engine::Renderer::Core::GLGlobeBase::State &state, const Envelope2 &bounds) NOTHROWS
+    {
+        if (state.crossesIDL || state.poleInView)
+            return true;
+        return bounds.minX <= state.eastBound && bounds.maxX >= state.westBound &&
+               bounds.minY <= state.northBound && bounds.maxY >= state.southBound;
+    }
+
     double distance(double x1, double y1, double x2, double y2)
     {
         double dx = (x1 - x2);
@@ -708,9 +1043,7 @@ namespace
                 entry = styleMap.find(styleString);
                 if (entry == styleMap.end()) {
                     StylePtr_const parsed(nullptr, nullptr);
-                    try {
-                        parsed = StylePtr_const(atakmap::feature::Style::parseStyle(styleString), atakmap::feature::Style::destructStyle);
-                    } catch (...) {}
+                    atakmap::feature::Style_parseStyleShared(parsed, styleString);
                     if (parsed.get()) {
                         value = std::move(parsed);
                         styleMap.insert(std::pair<std::string, std::shared_ptr<const atakmap::feature::Style>>(styleString, value));
@@ -754,7 +1087,21 @@ namespace
         }
     }
 
+    void markDirty(GLDirtyRegion &value, const Envelope2 &bounds, const double margin) NOTHROWS
+    {
+        // longitudinal margin grows toward the poles
+        const double lat = std::min(std::max(fabs(bounds.minY), fabs(bounds.maxY)), 85.0);
+        const double marginX = margin / cos(lat*M_PI/180.0);
+        value.push_back(Envelope2(std::max(bounds.minX - marginX, -180.0),
+                                  std::max(bounds.minY - margin, -90.0),
+                                  0.0,
+                                  std::min(bounds.maxX + marginX, 180.0),
+                                  std::min(bounds.maxY + margin, 90.0),
+                                  0.0));
+    }
+
     QueryContextImpl::QueryContextImpl() :
-        queryCount(0LL)
+        queryCount(0LL),
+        batched(false)
     {}
 }
@@ -5,8 +5,11 @@
 #include <map>
 #include <memory>
 
+#include "feature/Envelope2.h"
 #include "feature/FeatureDataStore2.h"
+#include "feature/FeatureTileCache.h"
 #include "feature/HitTestService2.h"
+#include "feature/PointClusterer.h"
 #include "renderer/GLRenderContext.h"
 #include "renderer/core/GLAsynchronousMapRenderable3.h"
 #include "renderer/feature/GLBatchGeometryRenderer3.h"
@@ -20,6 +23,36 @@ namespace TAK {
                     GLBatchGeometryFeatureDataStoreRendererOptions2() NOTHROWS;
                     
                     bool skipSameLodOptimization;
+                    /**
+                     * If `false`, query results that only change existing
+                     * features patch the affected ranges of the line and
+                     * point buffers rather than rebuilding them.
+                     */
+                    bool skipIncrementalUpdates;
+                    /**
+                     * If `true`, hit tests that are not invoked on the GL
+                     * thread pick the batched lines and points from an ID
+                     * buffer drawn about the touch location, rather than
+                     * testing each candidate geometry. The remaining
+                     * geometries are still tested on the CPU.
+                     */
+                    bool idBufferPicking;
+                    /**
+                     * If non-`nullptr`, features are queried through the
+                     * tiles of the cache at the current level of detail,
+                     * rather than from the store directly. The cache is
+                     * cleared when the content of the store changes.
+                     */
+                    std::shared_ptr<TAK::Engine::Feature::FeatureTileCache> tileCache;
+                    /**
+                     * If `true`, the points queried for the view are
+                     * clustered at the current level of detail. Each
+                     * cluster is drawn as a single point, labeled with the
+                     * number of points and styled as the point seeding the
+                     * cluster; hit tests on a cluster report that point.
+                     */
+                    bool clusterPoints;
+                    TAK::Engine::Feature::PointClusterer::Options clusterOptions;
                 };
                 
                 class ENGINE_API GLBatchGeometryFeatureDataStoreRenderer2 :
@@ -29,6 +62,7 @@ namespace TAK {
                 {
                 private:
                     struct GLGeometryRecord;
+                    struct ClusterRecord;
                     class HitTestImpl;
                 public:
                     GLBatchGeometryFeatureDataStoreRenderer2(TAK::Engine::Core::RenderContext &surface, TAK::Engine::Feature::FeatureDataStore2 &subject) NOTHROWS;
@@ -47,12 +81,18 @@ namespace TAK {
                     virtual Util::TAKErr createQueryContext(QueryContextPtr &value) NOTHROWS;
                     virtual Util::TAKErr resetQueryContext(QueryContext &pendingData) NOTHROWS;
                     virtual Util::TAKErr updateRenderableLists(QueryContext &pendingData) NOTHROWS;
+                    virtual Util::TAKErr getSurfaceDirtyRegion(TAK::Engine::Renderer::Core::GLDirtyRegion &value, QueryContext &pendingData) NOTHROWS;
+                    virtual double getQueryMargin() const NOTHROWS;
                     virtual Util::TAKErr getBackgroundThreadName(Port::String &value) NOTHROWS;
                     virtual Util::TAKErr query(QueryContext &result, const TAK::Engine::Renderer::Core::GLMapView2::State &state) NOTHROWS;
                 private:
                     Util::TAKErr queryImpl(QueryContext &result, const TAK::Engine::Renderer::Core::GLMapView2::State &state) NOTHROWS;
+                    /** replaces the point results of the query that are clustered with their clusters */
+                    Util::TAKErr applyClustering(QueryContext &result, const TAK::Engine::Renderer::Core::GLMapView2::State &state) NOTHROWS;
                 public: // FeatureDataStore2.OnDataStoreContentChangedListener
                     virtual void onDataStoreContentChanged(TAK::Engine::Feature::FeatureDataStore2 &data_store) NOTHROWS;
+                    /** refreshes only if the change intersects the region queried or being queried */
+                    virtual void onDataStoreContentChanged(TAK::Engine::Feature::FeatureDataStore2 &data_store, const TAK::Engine::Feature::FeatureDataStore2::ContentChange &change) NOTHROWS;
 
                     /**************************************************************************/
                     // Hit Test Service
@@ -73,6 +113,11 @@ namespace TAK {
 
                     std::map<int64_t, GLGeometryRecord> glSpatialItems;
 
+                    /** `nullptr` if clustering is disabled */
+                    std::unique_ptr<TAK::Engine::Feature::PointClusterer> clusterer;
+                    /** keyed on the ID of the seed point */
+                    std::map<int64_t, ClusterRecord> clusterItems;
+
                     TAK::Engine::Feature::FeatureDataStore2 &dataStore;
 
                 protected:
@@ -87,6 +132,20 @@ namespace TAK {
                     std::shared_ptr<GLBatchGeometry3> geometry;
                     int64_t touched {0};
                     bool visible {false};
+                    /** geometry bounds, WGS84; valid if `hasBounds` */
+                    TAK::Engine::Feature::Envelope2 bounds;
+                    bool hasBounds {false};
+                    std::shared_ptr<const atakmap::feature::Style> style;
+                    /** `true` if the point is drawn as part of a cluster */
+                    bool clustered {false};
+                };
+
+                struct GLBatchGeometryFeatureDataStoreRenderer2::ClusterRecord
+                {
+                    std::shared_ptr<GLBatchGeometry3> geometry;
+                    std::size_t count {0u};
+                    double longitude {0.0};
+                    double latitude {0.0};
                 };
 
                 class GLBatchGeometryFeatureDataStoreRenderer2::HitTestImpl : public TAK::Engine::Feature::HitTestService2
@@ -9,6 +9,7 @@
 #include "renderer/feature/GLBatchPoint.h"
 #include "renderer/feature/GLBatchPolygon.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "renderer/GLPerformanceCounters.h"
 #include "renderer/GLRenderBatch.h"
 #include "renderer/RendererUtils.h"
 
@@ -661,6 +662,7 @@ void GLBatchGeometryRenderer::renderLinesBuffers(VectorProgram *vectorProgram, c
 
     glEnableVertexAttribArray(vectorProgram->aVertexCoordsHandle);
     glDrawArrays(mode, 0, numPoints);
+    TAK::Engine::Renderer::GLPerformanceCounters_draw(mode, numPoints);
     glDisableVertexAttribArray(vectorProgram->aVertexCoordsHandle);
 }
 
@@ -841,6 +843,7 @@ void GLBatchGeometryRenderer::renderPointsBuffers(const GLMapView *view) {
         //       one, meaning that all icons except the last would require
         //       6 vertices
         glDrawArrays(GL_TRIANGLES, off * 6, std::min(remaining, iconsPerPass) * 6);
+        TAK::Engine::Renderer::GLPerformanceCounters_draw(GL_TRIANGLES, std::min(remaining, iconsPerPass) * 6);
 
         remaining -= iconsPerPass;
         off += iconsPerPass;
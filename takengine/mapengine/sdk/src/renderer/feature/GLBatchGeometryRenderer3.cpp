@@ -25,9 +25,12 @@
 #include "renderer/feature/GLBatchPoint3.h"
 #include "renderer/feature/GLGeometry.h"
 #include "renderer/GLMatrix.h"
+#include "renderer/GLPerformanceCounters.h"
+#include "thread/Lock.h"
 #include "util/ConfigOptions.h"
 #include "util/Distance.h"
 #include "util/Logging.h"
+#include "util/ScratchArena.h"
 
 #include "port/STLVectorAdapter.h"
 
@@ -35,6 +38,7 @@ using namespace TAK::Engine::Renderer::Feature;
 
 using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Renderer::Core;
+using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Math;
 
@@ -73,48 +77,96 @@ using namespace atakmap::util::distance;
     "  gl_FragColor = uColor * texture2D(uTexture, atlasTexPos);\n" \
     "}"
 
+#define POINT_INSTANCED_VSH \
+    "#version 300 es\n" \
+    "precision highp float;\n" \
+    "uniform mat4 u_projection;\n" \
+    "uniform mat4 u_modelView;\n" \
+    "uniform float u_mapRotation;\n" \
+    "uniform int u_idBase;\n" \
+    "in vec2 a_corner;\n" \
+    "in vec3 a_position;\n" \
+    "in vec4 a_texRect;\n" \
+    "in vec2 a_size;\n" \
+    "in vec2 a_offset;\n" \
+    "in vec2 a_rotation;\n" \
+    "in vec4 a_color;\n" \
+    "out vec2 v_texCoord;\n" \
+    "out vec4 v_color;\n" \
+    "flat out vec4 f_id;\n" \
+    "void main() {\n" \
+    "  float theta = radians(a_rotation.x + a_rotation.y*u_mapRotation);\n" \
+    "  vec2 c = a_corner*a_size;\n" \
+    "  vec2 r = vec2(c.x*cos(theta) - c.y*sin(theta), c.x*sin(theta) + c.y*cos(theta));\n" \
+    "  vec4 p = u_modelView * vec4(a_position, 1.0);\n" \
+    "  p.xy += (r + a_offset)*p.w;\n" \
+    "  gl_Position = u_projection * p;\n" \
+    "  v_texCoord = vec2(mix(a_texRect.x, a_texRect.z, a_corner.x + 0.5), mix(a_texRect.w, a_texRect.y, a_corner.y + 0.5));\n" \
+    "  v_color = a_color;\n" \
+    "  int id = u_idBase + gl_InstanceID;\n" \
+    "  f_id = vec4((ivec4(id>>24, id>>16, id>>8, id)&0xFF)) / 255.0;\n" \
+    "}"
+
+#define POINT_INSTANCED_FSH \
+    "#version 300 es\n" \
+    "precision mediump float;\n" \
+    "uniform sampler2D u_texture;\n" \
+    "uniform bool u_idPass;\n" \
+    "in vec2 v_texCoord;\n" \
+    "in vec4 v_color;\n" \
+    "flat in vec4 f_id;\n" \
+    "out vec4 v_FragColor;\n" \
+    "void main(void) {\n" \
+    "  v_FragColor = v_color * texture(u_texture, v_texCoord);\n" \
+    "  if (u_idPass) {\n" \
+    "    if (v_FragColor.a <= 0.0) discard;\n" \
+    "    v_FragColor = f_id;\n" \
+    "  }\n" \
+    "}"
+
 #define LINE_VSH \
     "#version 300 es\n" \
     "precision highp float;\n" \
     "const float c_smoothBuffer = 2.0;\n" \
     "uniform mat4 u_mvp;\n" \
     "uniform mediump vec2 u_viewportSize;\n" \
+    "uniform int u_idBase;\n" \
+    "in vec2 a_corner;\n" \
     "in vec3 a_vertexCoord0;\n" \
     "in vec3 a_vertexCoord1;\n" \
-    "in vec2 a_texCoord;\n" \
     "in vec4 a_color;\n" \
-    "in float a_normal;\n" \
-    "in float a_dir;\n" \
     "in int a_pattern;\n" \
     "in int a_factor;\n" \
     "in float a_halfStrokeWidth;\n" \
     "out vec4 v_color;\n" \
     "flat out float f_dist;\n" \
-    "out float v_mix;\n" \
+    "out float v_along;\n" \
     "flat out int f_pattern;\n" \
     "out vec2 v_normal;\n" \
     "flat out float f_halfStrokeWidth;\n" \
     "flat out int f_factor;\n" \
+    "flat out vec4 f_id;\n" \
     "void main(void) {\n" \
-    "  gl_Position = u_mvp * vec4(a_vertexCoord0.xyz, 1.0);\n" \
-    "  vec4 next_gl_Position = u_mvp * vec4(a_vertexCoord1.xyz, 1.0);\n" \
-    "  vec4 p0 = (gl_Position / gl_Position.w)*vec4(u_viewportSize, 1.0, 1.0);\n" \
-    "  vec4 p1 = (next_gl_Position / next_gl_Position.w)*vec4(u_viewportSize, 1.0, 1.0);\n" \
-    "  v_mix = a_dir;\n" \
-    "  float dist = distance(p0.xy, p1.xy);\n" \
-    "  float dx = p1.x - p0.x;\n" \
-    "  float dy = p1.y - p0.y;\n" \
-    "  float normalDir = (2.0*a_normal) - 1.0;\n" \
-    "  float adjX = normalDir*(dx/dist)*((a_halfStrokeWidth+c_smoothBuffer)/u_viewportSize.y);\n" \
-    "  float adjY = normalDir*(dy/dist)*((a_halfStrokeWidth+c_smoothBuffer)/u_viewportSize.x);\n" \
-    "  gl_Position.x = gl_Position.x - adjY;\n" \
-    "  gl_Position.y = gl_Position.y + adjX;\n" \
+    "  vec4 pos = u_mvp * vec4(mix(a_vertexCoord0, a_vertexCoord1, a_corner.x), 1.0);\n" \
+    "  vec4 other = u_mvp * vec4(mix(a_vertexCoord1, a_vertexCoord0, a_corner.x), 1.0);\n" \
+    "  vec2 p0 = (pos.xy / pos.w)*u_viewportSize;\n" \
+    "  vec2 p1 = (other.xy / other.w)*u_viewportSize;\n" \
+    "  float dist = distance(p0, p1);\n" \
+    "  vec2 dir = (dist > 0.0) ? (p1 - p0) / dist : vec2(1.0, 0.0);\n" \
+    "  float extent = a_halfStrokeWidth + c_smoothBuffer;\n" \
+    "  float normalDir = (2.0*a_corner.y) - 1.0;\n" \
+    "  v_normal = normalDir*vec2(-dir.y, dir.x)*extent;\n" \
+    "  vec2 offset = v_normal - dir*extent;\n" \
+    "  gl_Position = pos;\n" \
+    "  gl_Position.xy += (offset / u_viewportSize)*pos.w;\n" \
+    "  v_along = mix(-extent, dist + extent, a_corner.x);\n" \
     "  v_color = a_color;\n" \
-    "  v_normal = vec2(-normalDir*(dy/dist)*(a_halfStrokeWidth+c_smoothBuffer), normalDir*(dx/dist)*(a_halfStrokeWidth+c_smoothBuffer));\n" \
     "  f_pattern = a_pattern;\n" \
     "  f_factor = a_factor;\n" \
     "  f_dist = dist;\n" \
     "  f_halfStrokeWidth = a_halfStrokeWidth;\n" \
+    "  int id = u_idBase + gl_InstanceID;\n" \
+    "  f_id = vec4((ivec4(id>>24, id>>16, id>>8, id)&0xFF)) / 255.0;\n" \
     "}"
 
 #define LINE_FSH \
@@ -122,21 +174,28 @@ using namespace atakmap::util::distance;
     "precision mediump float;\n" \
     "uniform mediump vec2 u_viewportSize;\n" \
     "in vec4 v_color;\n" \
-    "in float v_mix;\n" \
+    "in float v_along;\n" \
     "flat in int f_pattern;\n" \
     "flat in int f_factor;\n" \
     "flat in float f_dist;\n" \
     "in vec2 v_normal;\n" \
     "flat in float f_halfStrokeWidth;\n" \
+    "flat in vec4 f_id;\n" \
+    "uniform bool u_idPass;\n" \
     "out vec4 v_FragColor;\n" \
     "void main(void) {\n" \
-    "  float d = (f_dist*v_mix);\n" \
+    "  float d = clamp(f_dist - v_along, 0.0, f_dist);\n" \
     "  int idist = int(d);\n" \
     "  float b0 = float((f_pattern>>((idist/f_factor)%16))&0x1);\n" \
     "  float b1 = float((f_pattern>>(((idist+1)/f_factor)%16))&0x1);\n" \
     "  float alpha = mix(b0, b1, fract(d));\n" \
-    "  float antiAlias = smoothstep(-1.0, 0.25, f_halfStrokeWidth-length(v_normal));\n" \
+    "  float cap = max(max(-v_along, v_along - f_dist), 0.0);\n" \
+    "  float antiAlias = smoothstep(-1.0, 0.25, f_halfStrokeWidth-length(vec2(cap, length(v_normal))));\n" \
     "  v_FragColor = vec4(v_color.rgb, antiAlias*alpha);\n" \
+    "  if (u_idPass) {\n" \
+    "    if (antiAlias < 0.5) discard;\n" \
+    "    v_FragColor = f_id;\n" \
+    "  }\n" \
     "}"
 
 #define PRE_FORWARD_LINES_POINT_RATIO_THRESHOLD 3
@@ -147,6 +206,9 @@ using namespace atakmap::util::distance;
 
 #define POINT_VERTEX_SIZE 20u // { float x, float y, float z, float u, float v }
 #define POINT_VERTICES_PER_SPRITE 6u
+// { float x, float y, float z, float u0, float v0, float u1, float v1, float width, float height,
+//   float offsetX, float offsetY, float rotation, float absoluteRotation, uint8_t r, g, b, a }
+#define POINT_INSTANCE_SIZE 56u
 
 #ifdef MSVC
 #define FORCE_LINEWIDTH_EMULATION 1
@@ -168,14 +230,28 @@ using namespace atakmap::util::distance;
      uint8_t g;
      uint8_t b;
      uint8_t a;
-     uint8_t normalDir; // 1
-     uint8_t halfWidthPixels; // 1
      uint32_t pattern; // 4
+     uint8_t halfWidthPixels; // 1
      uint8_t patternLen; // 1
-     uint8_t dir; // 1
+     uint8_t pad[2]; // 2
  }
  */
-#define LINES_VERTEX_SIZE (12u+12u+4u+1u+1u+4u+1u+1u)
+#define LINES_SEGMENT_SIZE (12u+12u+4u+4u+1u+1u+2u)
+#define VERTEX_BUF_SIZE 0xFFFFu
+// every line buffer, excepting the last, is filled to capacity
+#define LINES_SEGMENTS_PER_BUFFER (VERTEX_BUF_SIZE/LINES_SEGMENT_SIZE)
+// batches are rebuilt, rather than patched, once the view center drifts this
+// far from the batch centroid, in degrees
+#define MAX_PATCH_CENTROID_DRIFT 1.0
+// { endpoint, normal } for the two triangles of each segment
+#define LINES_VERTICES_PER_SEGMENT 6u
+// maximum pick tile dimension, in pixels
+#define MAX_PICK_TILE_SIZE 65u
+// pick IDs with this bit set are point instances, encoded as
+// (buffer << PICK_ID_POINT_BUFFER_SHIFT) | instance; other pick IDs are the
+// sprite line segment index plus one. zero is reserved for the background
+#define PICK_ID_POINT 0x80000000u
+#define PICK_ID_POINT_BUFFER_SHIFT 16u
 
 namespace
 {
@@ -250,6 +326,39 @@ namespace
      *                          consumed. </param>
      */
     void expandLineStringToLines(const std::size_t size, const float *linestrip , const std::size_t linestripPosition, float *lines, const std::size_t linesPosition, const std::size_t count, Matrix2 *xform) NOTHROWS;
+
+    /** returns the number of segments the line encodes into the line buffers */
+    std::size_t getLineSegmentCount(const GLBatchLineString3 &line) NOTHROWS;
+    /** encodes segment `j` of stroke `stroke` of the line; see `LINES_SEGMENT_SIZE` */
+    void putLineSegment(MemBuffer2 &vbuf, const GLBatchLineString3 &line, const std::size_t stroke, const std::size_t j);
+    /** encodes the point instance; see `POINT_INSTANCE_SIZE` */
+    void putPointInstance(MemBuffer2 &ibuf, const GLBatchPoint3 &point, TAK::Engine::Renderer::GLTextureAtlas2 &iconAtlas, const Point2<double> &centroidProj);
+    /** uploads the staged line segments, ending at global segment index `end` */
+    void flushLineSegments(const std::vector<GLuint> &vbos, MemBuffer2 &vbuf, const std::size_t end) NOTHROWS;
+
+    inline std::size_t getBufferRecordCount(const GLBatchLineString3 &line) NOTHROWS
+    {
+        return getLineSegmentCount(line);
+    }
+    inline std::size_t getBufferRecordCount(const GLBatchPoint3 &point) NOTHROWS
+    {
+        return 1u;
+    }
+    /** returns `true` if the records describe the geometries, in order */
+    template<class Record, class Container>
+    bool matchesBufferRecords(const std::vector<Record> &records, const Container &geoms) NOTHROWS
+    {
+        if (records.size() != geoms.size())
+            return false;
+        auto record = records.begin();
+        for (auto it = geoms.begin(); it != geoms.end(); it++, record++) {
+            if (record->geometry != *it || record->featureId != (*it)->featureId)
+                return false;
+            if (record->count != getBufferRecordCount(**it))
+                return false;
+        }
+        return true;
+    }
 }
 
 GLBatchGeometryRenderer3::GLBatchGeometryRenderer3(const CachePolicy &cachePolicy_) NOTHROWS :
@@ -258,7 +367,10 @@ GLBatchGeometryRenderer3::GLBatchGeometryRenderer3(const CachePolicy &cachePolic
     fadingLabelsCount(0),
     drawResolution(50.0),
     batchTerrainVersion(-1),
-    rebuildBatchBuffers(0)
+    rebuildBatchBuffers(0),
+    patchBatchBuffers(0),
+    incrementalUpdates(false),
+    pickFbo(nullptr, nullptr)
 {
     Port::String opt;
     TAKErr code;
@@ -276,7 +388,10 @@ GLBatchGeometryRenderer3::GLBatchGeometryRenderer3(const CachePolicy &cachePolic
         drawResolution = atof(opt);
 
     pointShader.base.handle = 0u;
+    pointInstanceShader.base.handle = 0u;
+    pointQuadVbo = GL_NONE;
     lineShader.base.handle = 0u;
+    lineQuadVbo = GL_NONE;
 }
 
 GLBatchGeometryRenderer3::GLBatchGeometryRenderer3() NOTHROWS :
@@ -284,7 +399,10 @@ GLBatchGeometryRenderer3::GLBatchGeometryRenderer3() NOTHROWS :
     fadingLabelsCount(0),
     drawResolution(50.0),
     batchTerrainVersion(-1),
-    rebuildBatchBuffers(0)
+    rebuildBatchBuffers(0),
+    patchBatchBuffers(0),
+    incrementalUpdates(false),
+    pickFbo(nullptr, nullptr)
 {
     Port::String opt;
     TAKErr code;
@@ -298,7 +416,10 @@ GLBatchGeometryRenderer3::GLBatchGeometryRenderer3() NOTHROWS :
         fadingLabelsCount = atoi(opt);
 
     pointShader.base.handle = 0u;
+    pointInstanceShader.base.handle = 0u;
+    pointQuadVbo = GL_NONE;
     lineShader.base.handle = 0u;
+    lineQuadVbo = GL_NONE;
 }
 
 TAKErr GLBatchGeometryRenderer3::hitTest(int64_t *result, const Point &loc, const double screen_x, const double screen_y, const double thresholdMeters, const int64_t noid) const NOTHROWS
@@ -318,6 +439,12 @@ TAKErr GLBatchGeometryRenderer3::hitTest(int64_t *result, const Point &loc, cons
 
 TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point &loc,  const double screen_x, const double screen_y,
     const double resolution, const int radius, const int limit, const int64_t noid) const NOTHROWS
+{
+    return hitTest2(fids, loc, screen_x, screen_y, resolution, radius, limit, noid, false);
+}
+
+TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point &loc,  const double screen_x, const double screen_y,
+    const double resolution, const int radius, const int limit, const int64_t noid, const bool excludePickable) const NOTHROWS
 {
     TAKErr code(TE_Ok);
 
@@ -378,7 +505,8 @@ TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point
         TE_CHECKRETURN_CODE(code);
     }
 
-    {
+    // batched points are covered by the ID-buffer pick
+    if (!excludePickable) {
 #ifdef __APPLE__
         auto pointIter = this->batchPoints.rbegin();
         do {
@@ -398,6 +526,12 @@ TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point
 #else
         for (auto pointIter = this->batchPoints.rbegin(); pointIter != this->batchPoints.rend(); pointIter++) {
             GLBatchPoint3 *item = *pointIter;
+            // batched points are not individually transformed when drawn;
+            // compute the screen location from the last draw's transform
+            Math::Point2<double> itemScreen;
+            batchPointsTransform.transform(&itemScreen, item->posProjected);
+            itemScreen.x += item->iconOffsetX;
+            itemScreen.y -= item->iconOffsetY;
             Envelope iconHitBox = screen_hit_box;
             double iconSize = 0;
             if (item->textureId) {
@@ -413,7 +547,7 @@ TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point
             }
             if (atakmap::math::Rectangle<double>::contains(iconHitBox.minX, iconHitBox.minY,
                                                            iconHitBox.maxX, iconHitBox.maxY,
-                                                           item->screen_x, item->screen_y)) {
+                                                           itemScreen.x, itemScreen.y)) {
 
                 code = fids.add(item->featureId);
                 TE_CHECKBREAK_CODE(code);
@@ -423,7 +557,8 @@ TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point
         }
 #endif
         TE_CHECKRETURN_CODE(code);
-
+    }
+    {
         for (auto drawPointIter = this->draw_points_.rbegin(); drawPointIter != this->draw_points_.rend(); drawPointIter++) {
             GLBatchPoint3 *item = *drawPointIter;
             Envelope iconHitBox = screen_hit_box;
@@ -467,7 +602,8 @@ TAKErr GLBatchGeometryRenderer3::hitTest2(Collection<int64_t> &fids, const Point
     } while (true);
     TE_CHECKRETURN_CODE(code);
 
-    auto sprLineIter = this->spriteLines.rbegin();
+    // batched sprite lines are covered by the ID-buffer pick
+    auto sprLineIter = excludePickable ? this->spriteLines.rend() : this->spriteLines.rbegin();
     do {
         int64_t fid;
         code = hitTestSpriteLineStrings<std::list<GLBatchLineString3 *>::const_reverse_iterator>(&fid, sprLineIter, this->spriteLines.rend(),
@@ -598,8 +734,7 @@ TAKErr GLBatchGeometryRenderer3::setBatch(Collection<GLBatchGeometry3 *> &value)
     if(!initMbb)
         surfaceCoverage.push_back(mbb);
 
-    batchState.sprites.srid = -1;
-    batchState.surface.srid = -1;
+    this->validateBatchBuffers();
 
     return code;
 }
@@ -682,8 +817,7 @@ TAKErr GLBatchGeometryRenderer3::setBatch(Collection<SharedGLBatchGeometryPtr> &
     if(!initMbb)
         surfaceCoverage.push_back(mbb);
 
-    batchState.surface.srid = -1;
-    batchState.sprites.srid = -1;
+    this->validateBatchBuffers();
 
     return code;
 }
@@ -1000,6 +1134,37 @@ TAKErr GLBatchGeometryRenderer3::extrudePoints() NOTHROWS {
     return code;
 }
 
+void GLBatchGeometryRenderer3::setIncrementalUpdates(const bool value) NOTHROWS
+{
+    incrementalUpdates = value;
+}
+
+void GLBatchGeometryRenderer3::validateBatchBuffers() NOTHROWS
+{
+    patchBatchBuffers = 0;
+    if (incrementalUpdates) {
+        // buffers are patched when the batch retains the same geometries, in
+        // the same order, with the same buffer footprint
+        if (matchesBufferRecords(surfaceLineRecords, surfaceLines))
+            patchBatchBuffers |= GLGlobeBase::Surface;
+        bool sprites = matchesBufferRecords(spriteLineRecords, spriteLines) &&
+                       matchesBufferRecords(pointRecords, batchPoints);
+        for (std::size_t i = 0u; sprites && i < pointRecords.size(); i++) {
+            const BufferRecord &record = pointRecords[i];
+            sprites = (record.buffer < pointsBuffers.size()) &&
+                      (pointsBuffers[record.buffer].texid == batchPoints[i]->textureId);
+        }
+        if (sprites)
+            patchBatchBuffers |= GLGlobeBase::Sprites;
+    }
+
+    // force rebuild of the buffers that cannot be patched
+    if (!(patchBatchBuffers&GLGlobeBase::Surface))
+        batchState.surface.srid = -1;
+    if (!(patchBatchBuffers&GLGlobeBase::Sprites))
+        batchState.sprites.srid = -1;
+}
+
 void GLBatchGeometryRenderer3::draw(const GLGlobeBase &view, const int renderPass) NOTHROWS
 {
     const bool depthEnabled = glIsEnabled(GL_DEPTH_TEST) != 0;
@@ -1010,6 +1175,23 @@ void GLBatchGeometryRenderer3::draw(const GLGlobeBase &view, const int renderPas
     
     const int terrainVersion = view.getTerrainVersion();
 
+    this->processPendingPicks(false);
+
+    // patched batches retain their centroid; recenter once the view has
+    // moved far enough to impact precision
+    if (surface && (patchBatchBuffers&GLGlobeBase::Surface) &&
+        (fabs(view.renderPass->drawLat-batchState.surface.centroid.latitude) > MAX_PATCH_CENTROID_DRIFT ||
+         fabs(view.renderPass->drawLng-batchState.surface.centroid.longitude) > MAX_PATCH_CENTROID_DRIFT)) {
+
+        batchState.surface.srid = -1;
+    }
+    if (sprites && (patchBatchBuffers&GLGlobeBase::Sprites) &&
+        (fabs(view.renderPass->drawLat-batchState.sprites.centroid.latitude) > MAX_PATCH_CENTROID_DRIFT ||
+         fabs(view.renderPass->drawLng-batchState.sprites.centroid.longitude) > MAX_PATCH_CENTROID_DRIFT)) {
+
+        batchState.sprites.srid = -1;
+    }
+
     // match batches as dirty
     if (surface && batchState.surface.srid != view.renderPass->drawSrid) {
         // reset relative to center
@@ -1046,10 +1228,13 @@ void GLBatchGeometryRenderer3::draw(const GLGlobeBase &view, const int renderPas
 
     if (surface)
         drawSurface(view);
-    if (sprites)
+    if (sprites) {
         drawSprites(view);
+        drawPicks(view);
+    }
 
     rebuildBatchBuffers &= ~renderPass;
+    patchBatchBuffers &= ~renderPass;
 
     if (depthEnabled)
         glEnable(GL_DEPTH_TEST);
@@ -1057,7 +1242,7 @@ void GLBatchGeometryRenderer3::draw(const GLGlobeBase &view, const int renderPas
 
 void GLBatchGeometryRenderer3::drawSurface(const GLGlobeBase &view) NOTHROWS
 {
-    if (!(rebuildBatchBuffers&GLGlobeBase::Surface) && !surfaceCoverage.intersects(TAK::Engine::Feature::Envelope2(view.renderPass->westBound, view.renderPass->southBound, 0.0, view.renderPass->eastBound, view.renderPass->northBound, 0.0)))
+    if (!(rebuildBatchBuffers&GLGlobeBase::Surface) && !(patchBatchBuffers&GLGlobeBase::Surface) && !surfaceCoverage.intersects(TAK::Engine::Feature::Envelope2(view.renderPass->westBound, view.renderPass->southBound, 0.0, view.renderPass->eastBound, view.renderPass->northBound, 0.0)))
         return;
 
     const bool is3D = view.renderPass->scene.projection->is3D();
@@ -1122,11 +1307,14 @@ void GLBatchGeometryRenderer3::drawSurface(const GLGlobeBase &view) NOTHROWS
     // lines
     if (!this->surfaceLines.empty())
     {
-        if (rebuildBatchBuffers&GLGlobeBase::Surface) {
+        bool rebuild = !!(rebuildBatchBuffers&GLGlobeBase::Surface);
+        if (!rebuild && (patchBatchBuffers&GLGlobeBase::Surface))
+            this->patchLineBuffers(&rebuild, surfaceLineRecords, surfaceLineBuffers, view, batchState.surface);
+        if (rebuild) {
             for (auto it = surfaceLineBuffers.begin(); it != surfaceLineBuffers.end(); it++)
                 glDeleteBuffers(1u, &(*it).vbo);
             surfaceLineBuffers.clear();
-            this->buildLineBuffers(surfaceLineBuffers, view, batchState.surface, surfaceLines);
+            this->buildLineBuffers(surfaceLineBuffers, surfaceLineRecords, view, batchState.surface, surfaceLines);
         }
 
         this->drawLineBuffers(view, batchState.surface, surfaceLineBuffers);
@@ -1179,6 +1367,18 @@ void GLBatchGeometryRenderer3::drawSprites(const GLGlobeBase &view) NOTHROWS
             node++;
         }
     }
+    // compaction relocates icons within the atlas; re-resolve the textures
+    // of the batched points so that batches stay grouped by texture
+    GLTextureAtlas2 *iconAtlas;
+    if (GLMapRenderGlobals_getIconAtlas2(&iconAtlas, view.context) == TE_Ok) {
+        iconAtlas->compact();
+        for (auto it = this->batchPoints.begin(); it != this->batchPoints.end(); it++) {
+            if ((*it)->validateTexture()) {
+                resortBatchPoints = true;
+                rebuildBatchBuffers |= GLGlobeBase::Sprites;
+            }
+        }
+    }
     if(resortBatchPoints) {
         BatchPointComparator cmp;
         std::sort(this->batchPoints.begin(), this->batchPoints.end(), cmp);
@@ -1229,25 +1429,42 @@ void GLBatchGeometryRenderer3::drawSprites(const GLGlobeBase &view) NOTHROWS
 
     // lines
     if (!this->spriteLines.empty()) {
-        if (rebuildBatchBuffers&GLGlobeBase::Sprites) {
+        bool rebuild = !!(rebuildBatchBuffers&GLGlobeBase::Sprites);
+        if (!rebuild && (patchBatchBuffers&GLGlobeBase::Sprites))
+            this->patchLineBuffers(&rebuild, spriteLineRecords, spriteLineBuffers, view, batchState.sprites);
+        if (rebuild) {
             for (auto it = spriteLineBuffers.begin(); it != spriteLineBuffers.end(); it++)
                 glDeleteBuffers(1u, &(*it).vbo);
             spriteLineBuffers.clear();
-            this->buildLineBuffers(spriteLineBuffers, view, batchState.sprites, spriteLines);
+            this->buildLineBuffers(spriteLineBuffers, spriteLineRecords, view, batchState.sprites, spriteLines);
         }
 
         this->drawLineBuffers(view, batchState.sprites, spriteLineBuffers);
     }
 
     if (!this->batchPoints.empty() || !this->pointsBuffers.empty()) {
-        if (rebuildBatchBuffers&GLGlobeBase::Sprites) {
+        bool rebuild = !!(rebuildBatchBuffers&GLGlobeBase::Sprites);
+#if TE_GLES_VERSION >= 3
+        if (!rebuild && (patchBatchBuffers&GLGlobeBase::Sprites))
+            this->patchPointInstanceBuffers(&rebuild, view, batchState.sprites);
+#endif
+        if (rebuild) {
             for (auto it = pointsBuffers.begin(); it != pointsBuffers.end(); it++)
                 glDeleteBuffers(1u, &(*it).vbo);
             pointsBuffers.clear();
+#if TE_GLES_VERSION >= 3
+            this->buildPointInstanceBuffers(pointsBuffers, pointRecords, view, batchState.sprites, batchPoints);
+#else
             this->buildPointsBuffers(pointsBuffers, view, batchState.sprites, batchPoints);
+#endif
         }
-        // render points with icons// render points with icons
+        // render points with icons
+#if TE_GLES_VERSION >= 3
+        this->batchDrawPointInstances(view, batchState.sprites);
+#else
         this->batchDrawPoints(view, batchState.sprites);
+#endif
+        batchPointsTransform = view.renderPass->scene.forwardTransform;
     }
     if (!this->draw_points_.empty()) {
         this->drawPoints(view);
@@ -1259,16 +1476,35 @@ int GLBatchGeometryRenderer3::getRenderPass() NOTHROWS
     return GLGlobeBase::Surface | GLGlobeBase::Sprites;
 }
 
-TAKErr GLBatchGeometryRenderer3::buildLineBuffers(std::vector<LinesBuffer> &linesBuf, const GLGlobeBase &view, const BatchState &ctx, const std::list<GLBatchLineString3 *> &lines) NOTHROWS {
+TAKErr GLBatchGeometryRenderer3::buildLineBuffers(std::vector<LinesBuffer> &linesBuf, std::vector<BufferRecord> &records, const GLGlobeBase &view, const BatchState &ctx, const std::list<GLBatchLineString3 *> &lines) NOTHROWS {
     TAKErr code(TE_Ok);
 
+    // drawn picks resolve against the records being replaced
+    this->processPendingPicks(true);
+
+    records.clear();
+    records.reserve(lines.size());
+    std::size_t segments = 0u;
+
     try {
-#define VERTEX_BUF_SIZE 0xFFFFu
-        uint8_t buf[VERTEX_BUF_SIZE];
+        // staging buffer is drawn from the view's frame arena rather than the stack
+        Util::ScratchArenaScope scratch(view.getFrameArena());
+        uint8_t *buf = static_cast<uint8_t *>(scratch.arena.allocate(VERTEX_BUF_SIZE));
+        if (!buf)
+            return TE_OutOfMemory;
 
         MemBuffer2 vbuf(buf, VERTEX_BUF_SIZE);
         for (auto g = lines.begin(); g != lines.end(); g++) {
             GLBatchLineString3 &line = **g;
+            BufferRecord record;
+            record.geometry = &line;
+            record.featureId = line.featureId;
+            record.version = line.version;
+            record.lod = line.lod;
+            record.first = segments;
+            record.count = getLineSegmentCount(line);
+            record.buffer = 0u;
+            records.push_back(record);
             if (line.numPoints < 2u)
                 continue;
 
@@ -1281,7 +1517,7 @@ TAKErr GLBatchGeometryRenderer3::buildLineBuffers(std::vector<LinesBuffer> &line
 
             for (std::size_t i = 0u; i < line.stroke.size(); i++) {
                 for (std::size_t j = 0u; j < (line.numPoints-1u); j++) {
-                    if (vbuf.remaining() < (6u * LINES_VERTEX_SIZE)) {
+                    if (vbuf.remaining() < LINES_SEGMENT_SIZE) {
                         LinesBuffer b;
                         glGenBuffers(1u, &b.vbo);
                         if (!b.vbo)
@@ -1289,38 +1525,13 @@ TAKErr GLBatchGeometryRenderer3::buildLineBuffers(std::vector<LinesBuffer> &line
                         glBindBuffer(GL_ARRAY_BUFFER, b.vbo);
                         glBufferData(GL_ARRAY_BUFFER, vbuf.position(), vbuf.get(), GL_STATIC_DRAW);
                         glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-                        b.count = static_cast<GLsizei>(vbuf.position()) / LINES_VERTEX_SIZE;
+                        b.count = static_cast<GLsizei>(vbuf.position()) / LINES_SEGMENT_SIZE;
                         linesBuf.push_back(b);
                         vbuf.reset();
                     }
 
-                    Point2<float> a(line.projectedVertices[j * 3u], line.projectedVertices[j * 3u+1u], line.projectedVertices[j * 3u+2]);
-                    Point2<float> b(line.projectedVertices[(j+1) * 3u], line.projectedVertices[(j+1) * 3u+1u], line.projectedVertices[(j+1) * 3u+2]);
-#define bls3_vertex(v1, v2, n, dir) \
-    vbuf.put<float>(v1.x); \
-    vbuf.put<float>(v1.y); \
-    vbuf.put<float>(v1.z); \
-    vbuf.put<float>(v2.x); \
-    vbuf.put<float>(v2.y); \
-    vbuf.put<float>(v2.z); \
-    vbuf.put<uint8_t>((line.stroke[i].color.argb>>16u)&0xFF); \
-    vbuf.put<uint8_t>((line.stroke[i].color.argb>>8u)&0xFF); \
-    vbuf.put<uint8_t>(line.stroke[i].color.argb&0xFF); \
-    vbuf.put<uint8_t>((line.stroke[i].color.argb>>24u)&0xFF); \
-    vbuf.put<uint8_t>(n); \
-    vbuf.put<uint8_t>(static_cast<uint8_t>(std::min(line.stroke[i].width/4.0f*GLMapRenderGlobals_getRelativeDisplayDensity(), 255.0f))); \
-    vbuf.put<uint8_t>(dir); \
-    vbuf.put<uint32_t>(line.stroke[i].factor ? static_cast<uint16_t>(line.stroke[i].pattern) : 0xFFFFu); \
-    vbuf.put<uint8_t>(line.stroke[i].factor ? static_cast<uint8_t>(line.stroke[i].factor) : 0x1u);
-
-                    bls3_vertex(a, b, 0xFFu, 0xFFu);
-                    bls3_vertex(b, a, 0xFFu, 0x00u);
-                    bls3_vertex(a, b, 0x00u, 0xFFu);
-
-                    bls3_vertex(a, b, 0xFFu, 0xFFu);
-                    bls3_vertex(b, a, 0xFFu, 0x00u);
-                    bls3_vertex(b, a, 0x00u, 0x00u);
-#undef bls3_vertex
+                    putLineSegment(vbuf, line, i, j);
+                    segments++;
                 }
             }
         }
@@ -1335,7 +1546,7 @@ TAKErr GLBatchGeometryRenderer3::buildLineBuffers(std::vector<LinesBuffer> &line
             glBindBuffer(GL_ARRAY_BUFFER, b.vbo);
             glBufferData(GL_ARRAY_BUFFER, vbuf.position(), vbuf.get(), GL_STATIC_DRAW);
             glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
-            b.count = static_cast<GLsizei>(vbuf.position()) / LINES_VERTEX_SIZE;
+            b.count = static_cast<GLsizei>(vbuf.position()) / LINES_SEGMENT_SIZE;
             linesBuf.push_back(b);
             vbuf.reset();
         }
@@ -1346,7 +1557,80 @@ TAKErr GLBatchGeometryRenderer3::buildLineBuffers(std::vector<LinesBuffer> &line
 
     return code;
 }
-TAKErr GLBatchGeometryRenderer3::drawLineBuffers(const GLGlobeBase &view, const BatchState &ctx, const std::vector<LinesBuffer> &buf) NOTHROWS {
+TAKErr GLBatchGeometryRenderer3::patchLineBuffers(bool *rebuild, std::vector<BufferRecord> &records, const std::vector<LinesBuffer> &bufs, const GLGlobeBase &view, const BatchState &ctx) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    std::size_t dirty = 0u;
+    for (auto it = records.begin(); it != records.end(); it++) {
+        if ((*it).version != (*it).geometry->version || (*it).lod != (*it).geometry->lod)
+            dirty++;
+    }
+    if (!dirty)
+        return code;
+    // wholesale changes are serviced more efficiently by a rebuild
+    if ((dirty*2u) > records.size()) {
+        *rebuild = true;
+        return code;
+    }
+
+    std::size_t capacity = 0u;
+    std::vector<GLuint> vbos;
+    vbos.reserve(bufs.size());
+    for (auto it = bufs.begin(); it != bufs.end(); it++) {
+        capacity += (*it).count;
+        vbos.push_back((*it).vbo);
+    }
+
+    try {
+        // staging buffer is drawn from the view's frame arena rather than the stack
+        Util::ScratchArenaScope scratch(view.getFrameArena());
+        uint8_t *buf = static_cast<uint8_t *>(scratch.arena.allocate(VERTEX_BUF_SIZE));
+        if (!buf)
+            return TE_OutOfMemory;
+
+        MemBuffer2 vbuf(buf, VERTEX_BUF_SIZE);
+        for (auto it = records.begin(); it != records.end(); it++) {
+            BufferRecord &record = *it;
+            auto &line = static_cast<GLBatchLineString3 &>(*record.geometry);
+            if (record.version == line.version && record.lod == line.lod)
+                continue;
+            // the buffer layout is fixed; segment count changes require a rebuild
+            if (getLineSegmentCount(line) != record.count || (record.first+record.count) > capacity) {
+                *rebuild = true;
+                return code;
+            }
+            record.version = line.version;
+            record.lod = line.lod;
+            if (!record.count)
+                continue;
+
+            // project the line vertices, applying the batch centroid
+            line.projectedVerticesSrid = -1;
+            line.projectedCentroid = ctx.centroidProj;
+            const float *ignored;
+            code = line.projectVertices(&ignored, view, GLGeometry::VERTICES_PROJECTED);
+            TE_CHECKBREAK_CODE(code);
+
+            std::size_t segment = record.first;
+            for (std::size_t i = 0u; i < line.stroke.size(); i++) {
+                for (std::size_t j = 0u; j < (line.numPoints-1u); j++) {
+                    putLineSegment(vbuf, line, i, j);
+                    segment++;
+                    if (!(segment%LINES_SEGMENTS_PER_BUFFER) || vbuf.remaining() < LINES_SEGMENT_SIZE)
+                        flushLineSegments(vbos, vbuf, segment);
+                }
+            }
+            flushLineSegments(vbos, vbuf, segment);
+        }
+    } catch (std::out_of_range &e) {
+        code = TE_Err;
+        Util::Logger_log(Util::LogLevel::TELL_Error, "Error patching lines: %s", e.what());
+    }
+
+    return code;
+}
+TAKErr GLBatchGeometryRenderer3::drawLineBuffers(const GLGlobeBase &view, const BatchState &ctx, const std::vector<LinesBuffer> &buf, const bool idPass) NOTHROWS {
     TAKErr code(TE_Ok);
 
     if (!this->lineShader.base.handle) {
@@ -1368,17 +1652,19 @@ TAKErr GLBatchGeometryRenderer3::drawLineBuffers(const GLGlobeBase &view, const
         glUseProgram(lineShader.base.handle);
         lineShader.u_mvp = glGetUniformLocation(lineShader.base.handle, "u_mvp");
         lineShader.u_viewportSize = glGetUniformLocation(lineShader.base.handle, "u_viewportSize");
+        lineShader.a_corner = glGetAttribLocation(lineShader.base.handle, "a_corner");
         lineShader.a_vertexCoord0 = glGetAttribLocation(lineShader.base.handle, "a_vertexCoord0");
         lineShader.a_vertexCoord1 = glGetAttribLocation(lineShader.base.handle, "a_vertexCoord1");
         lineShader.a_color = glGetAttribLocation(lineShader.base.handle, "a_color");
-        lineShader.a_normal = glGetAttribLocation(lineShader.base.handle, "a_normal");
         lineShader.a_halfStrokeWidth = glGetAttribLocation(lineShader.base.handle, "a_halfStrokeWidth");
-        lineShader.a_dir = glGetAttribLocation(lineShader.base.handle, "a_dir");
         lineShader.a_pattern = glGetAttribLocation(lineShader.base.handle, "a_pattern");
         lineShader.a_factor = glGetAttribLocation(lineShader.base.handle, "a_factor");
+        lineShader.u_idPass = glGetUniformLocation(lineShader.base.handle, "u_idPass");
+        lineShader.u_idBase = glGetUniformLocation(lineShader.base.handle, "u_idBase");
     }
 
     glUseProgram(lineShader.base.handle);
+    glUniform1i(lineShader.u_idPass, idPass ? 1 : 0);
 
     // MVP
     {
@@ -1405,40 +1691,73 @@ TAKErr GLBatchGeometryRenderer3::drawLineBuffers(const GLGlobeBase &view, const
         glUniform2f(lineShader.u_viewportSize, (float)viewport[2] / 2.0f, (float)viewport[3] / 2.0f);
     }
 
-    glEnableVertexAttribArray(lineShader.a_vertexCoord0);
-    glEnableVertexAttribArray(lineShader.a_vertexCoord1);
-    glEnableVertexAttribArray(lineShader.a_color);
-    glEnableVertexAttribArray(lineShader.a_normal);
-    glEnableVertexAttribArray(lineShader.a_halfStrokeWidth);
-    glEnableVertexAttribArray(lineShader.a_dir);
-    glEnableVertexAttribArray(lineShader.a_pattern);
-    glEnableVertexAttribArray(lineShader.a_factor);
+#if TE_GLES_VERSION >= 3
+    if (!lineQuadVbo) {
+        // { endpoint, normal }; endpoint 0 is the segment start
+        const uint8_t quad[LINES_VERTICES_PER_SEGMENT*2u] =
+        {
+            0x00u, 0xFFu,
+            0xFFu, 0xFFu,
+            0x00u, 0x00u,
+
+            0x00u, 0xFFu,
+            0xFFu, 0xFFu,
+            0xFFu, 0x00u,
+        };
+        glGenBuffers(1u, &lineQuadVbo);
+        if (!lineQuadVbo)
+            return TE_OutOfMemory;
+        glBindBuffer(GL_ARRAY_BUFFER, lineQuadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindBuffer(GL_ARRAY_BUFFER, lineQuadVbo);
+    glVertexAttribPointer(lineShader.a_corner, 2u, GL_UNSIGNED_BYTE, true, 2u, (const void *)0);
+    glEnableVertexAttribArray(lineShader.a_corner);
+
+    const GLint segmentAttribs[6u] =
+    {
+        lineShader.a_vertexCoord0,
+        lineShader.a_vertexCoord1,
+        lineShader.a_color,
+        lineShader.a_pattern,
+        lineShader.a_halfStrokeWidth,
+        lineShader.a_factor,
+    };
+    for (std::size_t i = 0u; i < 6u; i++) {
+        glEnableVertexAttribArray(segmentAttribs[i]);
+        glVertexAttribDivisor(segmentAttribs[i], 1u);
+    }
+
+    if (!idPass) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
 
     for (auto it = buf.begin(); it != buf.end(); it++) {
+        // every buffer, excepting the last, is filled to capacity
+        glUniform1i(lineShader.u_idBase, static_cast<GLint>((it - buf.begin())*LINES_SEGMENTS_PER_BUFFER + 1u));
         glBindBuffer(GL_ARRAY_BUFFER, (*it).vbo);
-        glVertexAttribPointer(lineShader.a_vertexCoord0, 3u, GL_FLOAT, false, LINES_VERTEX_SIZE, (const void *)0);
-        glVertexAttribPointer(lineShader.a_vertexCoord1, 3u, GL_FLOAT, false, LINES_VERTEX_SIZE, (const void *)12u);
-        glVertexAttribPointer(lineShader.a_color, 4u, GL_UNSIGNED_BYTE, true, LINES_VERTEX_SIZE, (const void *)24u);
-        glVertexAttribPointer(lineShader.a_normal, 1u, GL_UNSIGNED_BYTE, true, LINES_VERTEX_SIZE, (const void *)28u);
-        glVertexAttribPointer(lineShader.a_halfStrokeWidth, 1u, GL_UNSIGNED_BYTE, false, LINES_VERTEX_SIZE, (const void *)29u);
-        glVertexAttribPointer(lineShader.a_dir, 1u, GL_UNSIGNED_BYTE, true, LINES_VERTEX_SIZE, (const void *)30u);
-        glVertexAttribPointer(lineShader.a_pattern, 1u, GL_UNSIGNED_INT, false, LINES_VERTEX_SIZE, (const void *)31u);
-        glVertexAttribPointer(lineShader.a_factor, 1u, GL_UNSIGNED_BYTE, false, LINES_VERTEX_SIZE, (const void *)35u);
-        glDrawArrays(GL_TRIANGLES, 0u, (*it).count);
+        glVertexAttribPointer(lineShader.a_vertexCoord0, 3u, GL_FLOAT, false, LINES_SEGMENT_SIZE, (const void *)0);
+        glVertexAttribPointer(lineShader.a_vertexCoord1, 3u, GL_FLOAT, false, LINES_SEGMENT_SIZE, (const void *)12u);
+        glVertexAttribPointer(lineShader.a_color, 4u, GL_UNSIGNED_BYTE, true, LINES_SEGMENT_SIZE, (const void *)24u);
+        glVertexAttribIPointer(lineShader.a_pattern, 1u, GL_UNSIGNED_INT, LINES_SEGMENT_SIZE, (const void *)28u);
+        glVertexAttribPointer(lineShader.a_halfStrokeWidth, 1u, GL_UNSIGNED_BYTE, false, LINES_SEGMENT_SIZE, (const void *)32u);
+        glVertexAttribIPointer(lineShader.a_factor, 1u, GL_UNSIGNED_BYTE, LINES_SEGMENT_SIZE, (const void *)33u);
+        glDrawArraysInstanced(GL_TRIANGLES, 0u, LINES_VERTICES_PER_SEGMENT, (*it).count);
+        GLPerformanceCounters_draw(GL_TRIANGLES, LINES_VERTICES_PER_SEGMENT, (*it).count);
     }
     glDisable(GL_BLEND);
 
-    glDisableVertexAttribArray(lineShader.a_vertexCoord0);
-    glDisableVertexAttribArray(lineShader.a_vertexCoord1);
-    glDisableVertexAttribArray(lineShader.a_color);
-    glDisableVertexAttribArray(lineShader.a_normal);
-    glDisableVertexAttribArray(lineShader.a_halfStrokeWidth);
-    glDisableVertexAttribArray(lineShader.a_dir);
-    glDisableVertexAttribArray(lineShader.a_pattern);
-    glDisableVertexAttribArray(lineShader.a_factor);
+    // divisors are VAO state; restore the defaults for the other renderers
+    for (std::size_t i = 0u; i < 6u; i++) {
+        glVertexAttribDivisor(segmentAttribs[i], 0u);
+        glDisableVertexAttribArray(segmentAttribs[i]);
+    }
+    glDisableVertexAttribArray(lineShader.a_corner);
+#else
+    code = TE_Unsupported;
+#endif
 
     glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
     glUseProgram(GL_NONE);
@@ -1450,8 +1769,11 @@ TAKErr GLBatchGeometryRenderer3::buildPointsBuffers(std::vector<PointsBuffer> &l
     TAKErr code(TE_Ok);
 
     try {
-#define VERTEX_BUF_SIZE 0xFFFFu
-        uint8_t buf[VERTEX_BUF_SIZE];
+        // staging buffer is drawn from the view's frame arena rather than the stack
+        Util::ScratchArenaScope scratch(view.getFrameArena());
+        uint8_t *buf = static_cast<uint8_t *>(scratch.arena.allocate(VERTEX_BUF_SIZE));
+        if (!buf)
+            return TE_OutOfMemory;
 
         MemBuffer2 vbuf(buf, VERTEX_BUF_SIZE);
         GLuint lastTexId = (points.empty()) ? GL_NONE : points[0]->textureId;
@@ -1467,7 +1789,7 @@ TAKErr GLBatchGeometryRenderer3::buildPointsBuffers(std::vector<PointsBuffer> &l
                 glBufferData(GL_ARRAY_BUFFER, vbuf.position(), vbuf.get(), GL_STATIC_DRAW);
                 glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
                 b.count = static_cast<GLsizei>(vbuf.position()) / POINT_VERTEX_SIZE;
-                b.texid = point.textureId;
+                b.texid = lastTexId;
                 linesBuf.push_back(b);
                 vbuf.reset();
             }
@@ -1478,16 +1800,15 @@ TAKErr GLBatchGeometryRenderer3::buildPointsBuffers(std::vector<PointsBuffer> &l
             auto relativeScaling = static_cast<float>(1.0f / /*view.pixelDensity*/1.0);
 
             int textureSize = static_cast<int>(std::ceil(point.iconAtlas->getTextureSize() * relativeScaling));
-            std::size_t iconSize;
-            point.iconAtlas->getImageWidth(&iconSize, point.textureKey);
-            int iconIndex = point.textureIndex;
+            std::size_t iconXi;
+            point.iconAtlas->getImageTextureOffsetX(&iconXi, point.textureKey);
+            std::size_t iconYi;
+            point.iconAtlas->getImageTextureOffsetY(&iconYi, point.textureKey);
 
             auto fTextureSize = static_cast<float>(textureSize);
 
-            int numIconsX = (int)(textureSize / iconSize);
-
-            auto iconX = static_cast<float>((iconIndex % numIconsX) * iconSize);
-            auto iconY = static_cast<float>((iconIndex / numIconsX) * iconSize);
+            auto iconX = static_cast<float>(iconXi);
+            auto iconY = static_cast<float>(iconYi);
 
             vbuf.put<float>(static_cast<float>(point.posProjected.x-ctx.centroidProj.x));
             vbuf.put<float>(static_cast<float>(point.posProjected.y-ctx.centroidProj.y));
@@ -1620,6 +1941,7 @@ TAKErr GLBatchGeometryRenderer3::batchDrawPoints(const GLGlobeBase &view, const
             glVertexAttribPointer(pointShader.aTextureCoordsHandle, 2u, GL_FLOAT, false, POINT_VERTEX_SIZE, (const void *)(0 + 12u));
 
             glDrawArrays(GL_POINTS, 0, buf.count);
+            GLPerformanceCounters_draw(GL_POINTS, buf.count);
         }
 
         glDisableVertexAttribArray(pointShader.aVertexCoordsHandle);
@@ -1639,7 +1961,268 @@ TAKErr GLBatchGeometryRenderer3::batchDrawPoints(const GLGlobeBase &view, const
 
     return code;
 }
+TAKErr GLBatchGeometryRenderer3::buildPointInstanceBuffers(std::vector<PointsBuffer> &bufs, std::vector<BufferRecord> &records, const GLGlobeBase &view, const BatchState &ctx, const std::vector<GLBatchPoint3 *> &points) NOTHROWS {
+    TAKErr code(TE_Ok);
+
+    // drawn picks resolve against the records being replaced
+    this->processPendingPicks(true);
+
+    records.clear();
+    records.reserve(points.size());
+
+    try {
+#define INSTANCE_BUF_SIZE (POINT_INSTANCE_SIZE*1024u)
+        // staging buffer is drawn from the view's frame arena rather than the stack
+        Util::ScratchArenaScope scratch(view.getFrameArena());
+        uint8_t *buf = static_cast<uint8_t *>(scratch.arena.allocate(INSTANCE_BUF_SIZE));
+        if (!buf)
+            return TE_OutOfMemory;
+
+        MemBuffer2 ibuf(buf, INSTANCE_BUF_SIZE);
+        GLuint lastTexId = (points.empty()) ? GL_NONE : points[0]->textureId;
+        for (auto g = points.begin(); g != points.end(); g++) {
+            GLBatchPoint3 &point = **g;
+
+            if (ibuf.remaining() < POINT_INSTANCE_SIZE || point.textureId != lastTexId) {
+                PointsBuffer b;
+                glGenBuffers(1u, &b.vbo);
+                if (!b.vbo)
+                    return TE_OutOfMemory;
+                glBindBuffer(GL_ARRAY_BUFFER, b.vbo);
+                glBufferData(GL_ARRAY_BUFFER, ibuf.position(), ibuf.get(), GL_STATIC_DRAW);
+                glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+                b.count = static_cast<GLsizei>(ibuf.position()) / POINT_INSTANCE_SIZE;
+                b.texid = lastTexId;
+                bufs.push_back(b);
+                ibuf.reset();
+            }
+
+            lastTexId = point.textureId;
+            point.validateProjectedLocation(view);
+
+            BufferRecord record;
+            record.geometry = &point;
+            record.featureId = point.featureId;
+            record.version = point.version;
+            record.lod = point.lod;
+            record.first = ibuf.position() / POINT_INSTANCE_SIZE;
+            record.count = 1u;
+            record.buffer = bufs.size();
+            records.push_back(record);
+
+            putPointInstance(ibuf, point, *point.iconAtlas, ctx.centroidProj);
+        }
+        TE_CHECKRETURN_CODE(code);
+
+        // flush the remaining record
+        if (ibuf.position()) {
+            PointsBuffer b;
+            glGenBuffers(1u, &b.vbo);
+            if (!b.vbo)
+                return TE_OutOfMemory;
+            glBindBuffer(GL_ARRAY_BUFFER, b.vbo);
+            glBufferData(GL_ARRAY_BUFFER, ibuf.position(), ibuf.get(), GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+            b.count = static_cast<GLsizei>(ibuf.position()) / POINT_INSTANCE_SIZE;
+            b.texid = lastTexId;
+            bufs.push_back(b);
+            ibuf.reset();
+        }
+#undef INSTANCE_BUF_SIZE
+    } catch (std::out_of_range &e) {
+        code = TE_Err;
+        Util::Logger_log(Util::LogLevel::TELL_Error, "Error building point instance buffers: %s", e.what());
+    }
+
+    return code;
+}
+TAKErr GLBatchGeometryRenderer3::patchPointInstanceBuffers(bool *rebuild, const GLGlobeBase &view, const BatchState &ctx) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    std::size_t dirty = 0u;
+    for (auto it = pointRecords.begin(); it != pointRecords.end(); it++) {
+        if ((*it).version != (*it).geometry->version)
+            dirty++;
+    }
+    if (!dirty)
+        return code;
+    // wholesale changes are serviced more efficiently by a rebuild
+    if ((dirty*2u) > pointRecords.size()) {
+        *rebuild = true;
+        return code;
+    }
+
+    try {
+        uint8_t instance[POINT_INSTANCE_SIZE];
+        for (auto it = pointRecords.begin(); it != pointRecords.end(); it++) {
+            BufferRecord &record = *it;
+            auto &point = static_cast<GLBatchPoint3 &>(*record.geometry);
+            if (record.version == point.version)
+                continue;
+            // instances are grouped by texture
+            if (record.buffer >= pointsBuffers.size() || pointsBuffers[record.buffer].texid != point.textureId) {
+                *rebuild = true;
+                return code;
+            }
+            record.version = point.version;
+
+            point.validateProjectedLocation(view);
+
+            MemBuffer2 ibuf(instance, POINT_INSTANCE_SIZE);
+            putPointInstance(ibuf, point, *point.iconAtlas, ctx.centroidProj);
+            glBindBuffer(GL_ARRAY_BUFFER, pointsBuffers[record.buffer].vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, record.first*POINT_INSTANCE_SIZE, POINT_INSTANCE_SIZE, instance);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+    } catch (std::out_of_range &e) {
+        code = TE_Err;
+        Util::Logger_log(Util::LogLevel::TELL_Error, "Error patching point instance buffers: %s", e.what());
+    }
+
+    return code;
+}
+TAKErr GLBatchGeometryRenderer3::batchDrawPointInstances(const GLGlobeBase &view, const BatchState &ctx, const bool idPass) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+#if TE_GLES_VERSION >= 3
+    this->state.texId = 0;
 
+    if (pointInstanceShader.base.handle == 0) {
+        int vertShader = GL_NONE;
+        code = GLSLUtil_loadShader(&vertShader, POINT_INSTANCED_VSH, GL_VERTEX_SHADER);
+        TE_CHECKRETURN_CODE(code);
+
+        int fragShader = GL_NONE;
+        code = GLSLUtil_loadShader(&fragShader, POINT_INSTANCED_FSH, GL_FRAGMENT_SHADER);
+        TE_CHECKRETURN_CODE(code);
+
+        ShaderProgram prog{ 0u, 0u, 0u };
+        code = GLSLUtil_createProgram(&prog, vertShader, fragShader);
+        glDeleteShader(prog.fragShader);
+        glDeleteShader(prog.vertShader);
+        TE_CHECKRETURN_CODE(code);
+
+        pointInstanceShader.base.handle = prog.program;
+        glUseProgram(pointInstanceShader.base.handle);
+
+        pointInstanceShader.u_projection = glGetUniformLocation(pointInstanceShader.base.handle, "u_projection");
+        pointInstanceShader.u_modelView = glGetUniformLocation(pointInstanceShader.base.handle, "u_modelView");
+        pointInstanceShader.u_texture = glGetUniformLocation(pointInstanceShader.base.handle, "u_texture");
+        pointInstanceShader.u_mapRotation = glGetUniformLocation(pointInstanceShader.base.handle, "u_mapRotation");
+        pointInstanceShader.a_corner = glGetAttribLocation(pointInstanceShader.base.handle, "a_corner");
+        pointInstanceShader.a_position = glGetAttribLocation(pointInstanceShader.base.handle, "a_position");
+        pointInstanceShader.a_texRect = glGetAttribLocation(pointInstanceShader.base.handle, "a_texRect");
+        pointInstanceShader.a_size = glGetAttribLocation(pointInstanceShader.base.handle, "a_size");
+        pointInstanceShader.a_offset = glGetAttribLocation(pointInstanceShader.base.handle, "a_offset");
+        pointInstanceShader.a_rotation = glGetAttribLocation(pointInstanceShader.base.handle, "a_rotation");
+        pointInstanceShader.a_color = glGetAttribLocation(pointInstanceShader.base.handle, "a_color");
+        pointInstanceShader.u_idPass = glGetUniformLocation(pointInstanceShader.base.handle, "u_idPass");
+        pointInstanceShader.u_idBase = glGetUniformLocation(pointInstanceShader.base.handle, "u_idBase");
+    } else {
+        glUseProgram(pointInstanceShader.base.handle);
+    }
+    glUniform1i(pointInstanceShader.u_idPass, idPass ? 1 : 0);
+
+    if (!pointQuadVbo) {
+        // triangle strip about the icon center
+        const float quad[8u] =
+        {
+            -0.5f, -0.5f,
+            0.5f, -0.5f,
+            -0.5f, 0.5f,
+            0.5f, 0.5f,
+        };
+        glGenBuffers(1u, &pointQuadVbo);
+        if (!pointQuadVbo)
+            return TE_OutOfMemory;
+        glBindBuffer(GL_ARRAY_BUFFER, pointQuadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    }
+
+    if (!idPass) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+
+    float scratchMatrix[16];
+    atakmap::renderer::GLMatrix::orthoM(scratchMatrix, (float)view.renderPass->left, (float)view.renderPass->right, (float)view.renderPass->bottom, (float)view.renderPass->top, (float)view.renderPass->scene.camera.near, (float)view.renderPass->scene.camera.far);
+    glUniformMatrix4fv(pointInstanceShader.u_projection, 1, false, scratchMatrix);
+
+    // concatenate the local frame in double precision; see `batchDrawPoints`
+    Matrix2 modelView(view.renderPass->scene.forwardTransform);
+    modelView.concatenate(ctx.localFrame);
+    double modelViewMxD[16];
+    modelView.get(modelViewMxD, Matrix2::COLUMN_MAJOR);
+    float modelViewMxF[16];
+    for (std::size_t i = 0u; i < 16u; i++) modelViewMxF[i] = (float)modelViewMxD[i];
+    glUniformMatrix4fv(pointInstanceShader.u_modelView, 1, false, modelViewMxF);
+
+    // absolute icon rotation follows the map
+    glUniform1f(pointInstanceShader.u_mapRotation, static_cast<float>(view.renderPass->drawRotation));
+
+    glActiveTexture(this->state.textureUnit);
+    glUniform1i(pointInstanceShader.u_texture, this->state.textureUnit - GL_TEXTURE0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, pointQuadVbo);
+    glVertexAttribPointer(pointInstanceShader.a_corner, 2u, GL_FLOAT, false, 8u, (const void *)nullptr);
+    glEnableVertexAttribArray(pointInstanceShader.a_corner);
+
+    const GLint instanceAttribs[6u] =
+    {
+        pointInstanceShader.a_position,
+        pointInstanceShader.a_texRect,
+        pointInstanceShader.a_size,
+        pointInstanceShader.a_offset,
+        pointInstanceShader.a_rotation,
+        pointInstanceShader.a_color,
+    };
+    for (std::size_t i = 0u; i < 6u; i++) {
+        glEnableVertexAttribArray(instanceAttribs[i]);
+        glVertexAttribDivisor(instanceAttribs[i], 1u);
+    }
+
+    for (std::size_t i = 0u; i < pointsBuffers.size(); i++) {
+        const PointsBuffer &buf = pointsBuffers[i];
+        this->state.texId = buf.texid;
+        if (!this->state.texId)
+            continue;
+
+        glUniform1i(pointInstanceShader.u_idBase, static_cast<GLint>(PICK_ID_POINT | (static_cast<uint32_t>(i) << PICK_ID_POINT_BUFFER_SHIFT)));
+
+        glBindTexture(GL_TEXTURE_2D, this->state.texId);
+
+        glBindBuffer(GL_ARRAY_BUFFER, buf.vbo);
+        glVertexAttribPointer(pointInstanceShader.a_position, 3u, GL_FLOAT, false, POINT_INSTANCE_SIZE, (const void *)nullptr);
+        glVertexAttribPointer(pointInstanceShader.a_texRect, 4u, GL_FLOAT, false, POINT_INSTANCE_SIZE, (const void *)(0 + 12u));
+        glVertexAttribPointer(pointInstanceShader.a_size, 2u, GL_FLOAT, false, POINT_INSTANCE_SIZE, (const void *)(0 + 28u));
+        glVertexAttribPointer(pointInstanceShader.a_offset, 2u, GL_FLOAT, false, POINT_INSTANCE_SIZE, (const void *)(0 + 36u));
+        glVertexAttribPointer(pointInstanceShader.a_rotation, 2u, GL_FLOAT, false, POINT_INSTANCE_SIZE, (const void *)(0 + 44u));
+        glVertexAttribPointer(pointInstanceShader.a_color, 4u, GL_UNSIGNED_BYTE, true, POINT_INSTANCE_SIZE, (const void *)(0 + 52u));
+
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, buf.count);
+        GLPerformanceCounters_draw(GL_TRIANGLE_STRIP, 4u, buf.count);
+    }
+
+    // divisors are VAO state; restore the defaults for the other renderers
+    for (std::size_t i = 0u; i < 6u; i++) {
+        glVertexAttribDivisor(instanceAttribs[i], 0u);
+        glDisableVertexAttribArray(instanceAttribs[i]);
+    }
+    glDisableVertexAttribArray(pointInstanceShader.a_corner);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisable(GL_BLEND);
+
+    if (this->state.texId != 0) {
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+#else
+    code = TE_Unsupported;
+#endif
+    return code;
+}
 
 TAKErr GLBatchGeometryRenderer3::drawPoints(const TAK::Engine::Renderer::Core::GLGlobeBase &view) NOTHROWS
 {
@@ -1659,6 +2242,238 @@ TAKErr GLBatchGeometryRenderer3::renderPointsBuffers(const GLGlobeBase &view, GL
     return TE_Ok;
 }
 
+TAKErr GLBatchGeometryRenderer3::requestPick(PickCallback callback, void *opaque, const float x, const float y, const int radius) NOTHROWS
+{
+    if (!callback)
+        return TE_InvalidArg;
+    if (radius < 0)
+        return TE_InvalidArg;
+#if TE_GLES_VERSION >= 3
+    PickRequest request;
+    request.callback = callback;
+    request.opaque = opaque;
+    request.x = x;
+    request.y = y;
+    request.tileSize = std::min(static_cast<std::size_t>(radius)*2u + 1u, static_cast<std::size_t>(MAX_PICK_TILE_SIZE));
+
+    Lock lock(pickMutex);
+    TE_CHECKRETURN_CODE(lock.status);
+    pickRequests.push_back(request);
+    return TE_Ok;
+#else
+    return TE_Unsupported;
+#endif
+}
+
+void GLBatchGeometryRenderer3::processPendingPicks(const bool wait) NOTHROWS
+{
+#if TE_GLES_VERSION >= 3
+    // picks complete in the order they were drawn
+    while (!pendingPicks.empty()) {
+        GLsync fence = pendingPicks.front().fence;
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000u : 0u);
+        } while (wait && status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_TIMEOUT_EXPIRED)
+            break;
+
+        PendingPick pick(pendingPicks.front());
+        pendingPicks.erase(pendingPicks.begin());
+        deliverPick(pick, (status == GL_WAIT_FAILED) ? TE_Err : TE_Ok);
+    }
+#endif
+}
+
+TAKErr GLBatchGeometryRenderer3::drawPicks(const GLGlobeBase &view) NOTHROWS
+{
+    std::vector<PickRequest> requests;
+    {
+        Lock lock(pickMutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        requests.swap(pickRequests);
+    }
+    if (requests.empty())
+        return TE_Ok;
+
+    TAKErr code(TE_Ok);
+#if TE_GLES_VERSION >= 3
+    if (!pickFbo.get()) {
+        GLOffscreenFramebuffer::Options opts;
+        opts.colorFormat = GL_RGBA;
+        opts.colorInternalFormat = GL_RGBA8;
+        opts.colorType = GL_UNSIGNED_BYTE;
+        opts.bufferMask = GL_COLOR_BUFFER_BIT;
+        code = GLOffscreenFramebuffer_create(pickFbo, MAX_PICK_TILE_SIZE, MAX_PICK_TILE_SIZE, opts);
+    }
+    if (code != TE_Ok) {
+        const std::vector<int64_t> none;
+        for (auto it = requests.begin(); it != requests.end(); it++)
+            (*it).callback((*it).opaque, TE_Unsupported, none);
+        return code;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint boundFbo;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFbo);
+    GLfloat clearColor[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+    const bool depthEnabled = glIsEnabled(GL_DEPTH_TEST) != 0;
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+
+    pickFbo->bind(false);
+    for (auto it = requests.begin(); it != requests.end(); it++) {
+        PendingPick pick;
+        pick.request = *it;
+        pick.fence = nullptr;
+        if (pickPbos.empty()) {
+            pick.pbo = GL_NONE;
+            glGenBuffers(1u, &pick.pbo);
+            if (!pick.pbo) {
+                (*it).callback((*it).opaque, TE_OutOfMemory, std::vector<int64_t>());
+                continue;
+            }
+        } else {
+            pick.pbo = pickPbos.back();
+            pickPbos.pop_back();
+        }
+
+        const auto tileSize = static_cast<GLsizei>(pick.request.tileSize);
+        glScissor(0, 0, tileSize, tileSize);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // offset the viewport so that the pick location is the tile center;
+        // the viewport dimensions are retained for the line extrusion
+        glViewport(-static_cast<GLint>(pick.request.x) + tileSize/2, -static_cast<GLint>(pick.request.y) + tileSize/2, viewport[2], viewport[3]);
+
+        if (!this->spriteLineBuffers.empty())
+            this->drawLineBuffers(view, batchState.sprites, spriteLineBuffers, true);
+        if (!this->pointsBuffers.empty())
+            this->batchDrawPointInstances(view, batchState.sprites, true);
+
+        // with a pack buffer bound, the pixels are read back asynchronously
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pick.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, tileSize*tileSize*4u, nullptr, GL_STREAM_READ);
+        glReadPixels(0, 0, tileSize, tileSize, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+
+        pick.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        pendingPicks.push_back(pick);
+    }
+
+    // restore GL state
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFbo);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+    if (depthEnabled)
+        glEnable(GL_DEPTH_TEST);
+
+    // the readback is delivered on a subsequent frame
+    view.context.requestRefresh();
+#else
+    code = TE_Unsupported;
+    const std::vector<int64_t> none;
+    for (auto it = requests.begin(); it != requests.end(); it++)
+        (*it).callback((*it).opaque, code, none);
+#endif
+    return code;
+}
+
+bool GLBatchGeometryRenderer3::resolvePickId(int64_t *fid, const uint32_t id) const NOTHROWS
+{
+    if (id & PICK_ID_POINT) {
+        const std::size_t buffer = (id&~PICK_ID_POINT) >> PICK_ID_POINT_BUFFER_SHIFT;
+        const std::size_t instance = id & ((1u << PICK_ID_POINT_BUFFER_SHIFT) - 1u);
+        // records are ordered by buffer, then instance
+        auto it = std::lower_bound(pointRecords.begin(), pointRecords.end(), std::make_pair(buffer, instance),
+            [](const BufferRecord &a, const std::pair<std::size_t, std::size_t> &b)
+            {
+                return (a.buffer < b.first) || (a.buffer == b.first && a.first < b.second);
+            });
+        if (it == pointRecords.end() || (*it).buffer != buffer || (*it).first != instance)
+            return false;
+        *fid = (*it).featureId;
+        return true;
+    } else if (id) {
+        const std::size_t segment = id - 1u;
+        // records are ordered by first segment
+        auto it = std::upper_bound(spriteLineRecords.begin(), spriteLineRecords.end(), segment,
+            [](const std::size_t a, const BufferRecord &b)
+            {
+                return a < b.first;
+            });
+        if (it == spriteLineRecords.begin())
+            return false;
+        it--;
+        if (segment >= ((*it).first + (*it).count))
+            return false;
+        *fid = (*it).featureId;
+        return true;
+    } else {
+        return false;
+    }
+}
+
+void GLBatchGeometryRenderer3::deliverPick(PendingPick &pick, TAKErr code) NOTHROWS
+{
+    std::vector<int64_t> fids;
+#if TE_GLES_VERSION >= 3
+    if (code == TE_Ok) {
+        const std::size_t tileSize = pick.request.tileSize;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pick.pbo);
+        const auto *pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, tileSize*tileSize*4u, GL_MAP_READ_BIT));
+        if (pixels) {
+            // { squared distance from center, ID }
+            std::vector<std::pair<std::size_t, uint32_t>> hits;
+            const std::size_t center = tileSize / 2u;
+            for (std::size_t y = 0u; y < tileSize; y++) {
+                for (std::size_t x = 0u; x < tileSize; x++) {
+                    const uint8_t *rgba = pixels + ((y*tileSize) + x)*4u;
+                    const uint32_t id = (static_cast<uint32_t>(rgba[0]) << 24u) | (static_cast<uint32_t>(rgba[1]) << 16u) | (static_cast<uint32_t>(rgba[2]) << 8u) | static_cast<uint32_t>(rgba[3]);
+                    if (!id)
+                        continue;
+                    const std::size_t dx = (x > center) ? (x - center) : (center - x);
+                    const std::size_t dy = (y > center) ? (y - center) : (center - y);
+                    const std::size_t d2 = dx*dx + dy*dy;
+                    // restrict the hits to the pick radius
+                    if (d2 <= center*center)
+                        hits.push_back(std::make_pair(d2, id));
+                }
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+            std::stable_sort(hits.begin(), hits.end(),
+                [](const std::pair<std::size_t, uint32_t> &a, const std::pair<std::size_t, uint32_t> &b)
+                {
+                    return a.first < b.first;
+                });
+            for (auto it = hits.begin(); it != hits.end(); it++) {
+                int64_t fid;
+                if (!resolvePickId(&fid, (*it).second))
+                    continue;
+                if (std::find(fids.begin(), fids.end(), fid) == fids.end())
+                    fids.push_back(fid);
+            }
+        } else {
+            code = TE_Err;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, GL_NONE);
+    }
+
+    if (pick.fence)
+        glDeleteSync(pick.fence);
+    pick.fence = nullptr;
+#endif
+    pickPbos.push_back(pick.pbo);
+
+    pick.request.callback(pick.request.opaque, code, fids);
+}
+
 void GLBatchGeometryRenderer3::start() NOTHROWS
 {}
 
@@ -1667,6 +2482,27 @@ void GLBatchGeometryRenderer3::stop() NOTHROWS
 
 void GLBatchGeometryRenderer3::release() NOTHROWS
 {
+    // outstanding picks are canceled
+    {
+        std::vector<PickRequest> requests;
+        {
+            Lock lock(pickMutex);
+            requests.swap(pickRequests);
+        }
+        const std::vector<int64_t> none;
+        for (auto it = requests.begin(); it != requests.end(); it++)
+            (*it).callback((*it).opaque, TE_Canceled, none);
+        while (!pendingPicks.empty()) {
+            PendingPick pick(pendingPicks.front());
+            pendingPicks.erase(pendingPicks.begin());
+            deliverPick(pick, TE_Canceled);
+        }
+        if (!pickPbos.empty())
+            glDeleteBuffers(static_cast<GLsizei>(pickPbos.size()), pickPbos.data());
+        pickPbos.clear();
+        pickFbo.reset();
+    }
+
     this->surfaceLines.clear();
     this->spriteLines.clear();
     this->surfacePolys.clear();
@@ -1694,6 +2530,18 @@ void GLBatchGeometryRenderer3::release() NOTHROWS
     for (auto it = pointsBuffers.begin(); it != pointsBuffers.end(); it++)
         glDeleteBuffers(1u, &(*it).vbo);
     pointsBuffers.clear();
+    surfaceLineRecords.clear();
+    spriteLineRecords.clear();
+    pointRecords.clear();
+    patchBatchBuffers = 0;
+    if (pointQuadVbo) {
+        glDeleteBuffers(1u, &pointQuadVbo);
+        pointQuadVbo = GL_NONE;
+    }
+    if (lineQuadVbo) {
+        glDeleteBuffers(1u, &lineQuadVbo);
+        lineQuadVbo = GL_NONE;
+    }
 }
 
 GLBatchGeometryRenderer3::CachePolicy::CachePolicy() NOTHROWS :
@@ -1959,4 +2807,70 @@ namespace
             }
         }
     }
+
+    std::size_t getLineSegmentCount(const GLBatchLineString3 &line) NOTHROWS
+    {
+        return (line.numPoints < 2u) ? 0u : (line.numPoints-1u)*line.stroke.size();
+    }
+    void putLineSegment(MemBuffer2 &vbuf, const GLBatchLineString3 &line, const std::size_t stroke, const std::size_t j)
+    {
+        const std::size_t i = stroke;
+        Point2<float> a(line.projectedVertices[j * 3u], line.projectedVertices[j * 3u+1u], line.projectedVertices[j * 3u+2]);
+        Point2<float> b(line.projectedVertices[(j+1) * 3u], line.projectedVertices[(j+1) * 3u+1u], line.projectedVertices[(j+1) * 3u+2]);
+        // the segment is extruded in the vertex shader; see `LINES_VERTICES_PER_SEGMENT`
+        vbuf.put<float>(a.x);
+        vbuf.put<float>(a.y);
+        vbuf.put<float>(a.z);
+        vbuf.put<float>(b.x);
+        vbuf.put<float>(b.y);
+        vbuf.put<float>(b.z);
+        vbuf.put<uint8_t>((line.stroke[i].color.argb>>16u)&0xFF);
+        vbuf.put<uint8_t>((line.stroke[i].color.argb>>8u)&0xFF);
+        vbuf.put<uint8_t>(line.stroke[i].color.argb&0xFF);
+        vbuf.put<uint8_t>((line.stroke[i].color.argb>>24u)&0xFF);
+        vbuf.put<uint32_t>(line.stroke[i].factor ? static_cast<uint16_t>(line.stroke[i].pattern) : 0xFFFFu);
+        vbuf.put<uint8_t>(static_cast<uint8_t>(std::min(line.stroke[i].width/4.0f*GLMapRenderGlobals_getRelativeDisplayDensity(), 255.0f)));
+        vbuf.put<uint8_t>(line.stroke[i].factor ? static_cast<uint8_t>(line.stroke[i].factor) : 0x1u);
+        vbuf.put<uint16_t>(0u);
+    }
+    void putPointInstance(MemBuffer2 &ibuf, const GLBatchPoint3 &point, TAK::Engine::Renderer::GLTextureAtlas2 &iconAtlas, const Point2<double> &centroidProj)
+    {
+        std::size_t iconX, iconY, iconW, iconH;
+        iconAtlas.getImageTextureOffsetX(&iconX, point.textureKey);
+        iconAtlas.getImageTextureOffsetY(&iconY, point.textureKey);
+        iconAtlas.getImageWidth(&iconW, point.textureKey);
+        iconAtlas.getImageHeight(&iconH, point.textureKey);
+        const auto textureSize = static_cast<float>(iconAtlas.getTextureSize());
+
+        ibuf.put<float>(static_cast<float>(point.posProjected.x-centroidProj.x));
+        ibuf.put<float>(static_cast<float>(point.posProjected.y-centroidProj.y));
+        ibuf.put<float>(static_cast<float>(point.posProjected.z-centroidProj.z));
+        // texture rect, matching `GLBatchPoint3::draw`
+        ibuf.put<float>(static_cast<float>(iconX) / textureSize);
+        ibuf.put<float>(static_cast<float>(iconY) / textureSize);
+        ibuf.put<float>(static_cast<float>(iconX + iconW - 1u) / textureSize);
+        ibuf.put<float>(static_cast<float>(iconY + iconH - 1u) / textureSize);
+        ibuf.put<float>(static_cast<float>(iconW));
+        ibuf.put<float>(static_cast<float>(iconH));
+        // GL LL origin
+        ibuf.put<float>(point.iconOffsetX);
+        ibuf.put<float>(-point.iconOffsetY);
+        ibuf.put<float>(point.iconRotation);
+        ibuf.put<float>(point.absoluteIconRotation ? 1.0f : 0.0f);
+        ibuf.put<uint8_t>(static_cast<uint8_t>(point.colorR*255.0f));
+        ibuf.put<uint8_t>(static_cast<uint8_t>(point.colorG*255.0f));
+        ibuf.put<uint8_t>(static_cast<uint8_t>(point.colorB*255.0f));
+        ibuf.put<uint8_t>(static_cast<uint8_t>(point.colorA*255.0f));
+    }
+    void flushLineSegments(const std::vector<GLuint> &vbos, MemBuffer2 &vbuf, const std::size_t end) NOTHROWS
+    {
+        if (!vbuf.position())
+            return;
+        // staged segments never span a buffer boundary
+        const std::size_t start = end - (vbuf.position() / LINES_SEGMENT_SIZE);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[start / LINES_SEGMENTS_PER_BUFFER]);
+        glBufferSubData(GL_ARRAY_BUFFER, (start % LINES_SEGMENTS_PER_BUFFER) * LINES_SEGMENT_SIZE, vbuf.position(), vbuf.get());
+        glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+        vbuf.reset();
+    }
 }
@@ -9,9 +9,11 @@
 #include "renderer/feature/GLBatchPolygon3.h"
 #include "renderer/feature/GLBatchLineString3.h"
 #include "renderer/feature/GLBatchPointBuffer.h"
+#include "renderer/GLOffscreenFramebuffer.h"
 
 #include "core/GeoPoint2.h"
 #include "port/Collection.h"
+#include "thread/Mutex.h"
 #include "util/Error.h"
 #include "util/MemBuffer2.h"
 
@@ -24,6 +26,21 @@ namespace TAK {
                 {
                 public:
                     typedef std::shared_ptr<GLBatchGeometry3> SharedGLBatchGeometryPtr;
+                public:
+                    /**
+                     * Receives the result of an ID-buffer pick on the GL
+                     * thread.
+                     *
+                     * @param opaque    The opaque pointer supplied with the
+                     *                  request
+                     * @param code      `TE_Ok` on success, `TE_Unsupported`
+                     *                  if picking is not available,
+                     *                  `TE_Canceled` if the renderer was
+                     *                  released first
+                     * @param fids      The picked feature IDs, nearest the
+                     *                  pick location first
+                     */
+                    typedef void (*PickCallback)(void *opaque, const Util::TAKErr code, const std::vector<int64_t> &fids);
                 public:
                     struct ENGINE_API CachePolicy {
                         enum
@@ -83,6 +100,7 @@ namespace TAK {
                     struct LinesBuffer
                     {
                         GLuint vbo;
+                        /** number of segments */
                         GLsizei count;
                     };
                     struct PointsBuffer
@@ -91,6 +109,34 @@ namespace TAK {
                         GLuint vbo;
                         GLsizei count;
                     };
+                    /** location of a batched geometry's data within the GL buffers */
+                    struct BufferRecord
+                    {
+                        GLBatchGeometry3 *geometry;
+                        int64_t featureId;
+                        int64_t version;
+                        int lod;
+                        /** global segment index for lines; instance index within `buffer` for points */
+                        std::size_t first;
+                        std::size_t count;
+                        std::size_t buffer;
+                    };
+                    struct PickRequest
+                    {
+                        PickCallback callback;
+                        void *opaque;
+                        float x;
+                        float y;
+                        std::size_t tileSize;
+                    };
+                    struct PendingPick
+                    {
+                        PickRequest request;
+                        GLuint pbo;
+#if TE_GLES_VERSION >= 3
+                        GLsync fence;
+#endif
+                    };
                     struct BatchState {
                         TAK::Engine::Core::GeoPoint2 centroid;
                         Math::Point2<double> centroidProj;
@@ -122,6 +168,10 @@ namespace TAK {
                     std::vector<LinesBuffer> spriteLineBuffers;
 
                     std::vector<PointsBuffer> pointsBuffers;
+
+                    std::vector<BufferRecord> surfaceLineRecords;
+                    std::vector<BufferRecord> spriteLineRecords;
+                    std::vector<BufferRecord> pointRecords;
                     //Util::MemBuffer2 pointsBuffer;
 
                     BatchPipelineState state;
@@ -143,21 +193,46 @@ namespace TAK {
                         GLint uPointSizeHandle;
                     } pointShader;
 
+                    struct
+                    {
+                        Renderer::Shader2 base;
+                        GLint u_projection;
+                        GLint u_modelView;
+                        GLint u_texture;
+                        GLint u_mapRotation;
+                        GLint a_corner;
+                        GLint a_position;
+                        GLint a_texRect;
+                        GLint a_size;
+                        GLint a_offset;
+                        GLint a_rotation;
+                        GLint a_color;
+                        GLint u_idPass;
+                        GLint u_idBase;
+                    } pointInstanceShader;
+                    /** unit quad, sourced per-vertex by all point instances */
+                    GLuint pointQuadVbo;
+                    /** scene transform of the last batched point draw, for hit-testing */
+                    Math::Matrix2 batchPointsTransform;
+
                     struct
                     {
                         Renderer::Shader2 base;
                         GLint u_mvp;
                         GLint u_viewportSize;
+                        GLint a_corner;
                         GLint a_vertexCoord0;
                         GLint a_vertexCoord1;
                         GLint a_texCoord;
                         GLint a_color;
-                        GLint a_normal;
                         GLint a_halfStrokeWidth;
-                        GLint a_dir;
                         GLint a_pattern;
                         GLint a_factor;
+                        GLint u_idPass;
+                        GLint u_idBase;
                     } lineShader;
+                    /** segment extrusion template, sourced per-vertex by all line segments */
+                    GLuint lineQuadVbo;
 
                     bool labelBackgrounds;
                     size_t fadingLabelsCount;
@@ -171,6 +246,18 @@ namespace TAK {
                     } batchState;
                     int batchTerrainVersion;
                     int rebuildBatchBuffers;
+                    /** render passes whose buffers may be patched in place, rather than rebuilt */
+                    int patchBatchBuffers;
+                    bool incrementalUpdates;
+
+                    /** picks awaiting the next sprite pass; guarded by `pickMutex` */
+                    std::vector<PickRequest> pickRequests;
+                    Thread::Mutex pickMutex;
+                    /** picks drawn, awaiting readback; GL thread only */
+                    std::vector<PendingPick> pendingPicks;
+                    /** pixel pack buffers available for reuse */
+                    std::vector<GLuint> pickPbos;
+                    GLOffscreenFramebufferPtr pickFbo;
                 public:
                     GLBatchGeometryRenderer3() NOTHROWS;
                     GLBatchGeometryRenderer3(const CachePolicy &cachePolicy) NOTHROWS;
@@ -178,9 +265,56 @@ namespace TAK {
                     virtual Util::TAKErr hitTest(int64_t *fid, const atakmap::feature::Point &loc, const double screen_x, const double screen_y, const double thresholdMeters, int64_t noid) const NOTHROWS;
                     virtual Util::TAKErr hitTest2(Port::Collection<int64_t> &fids, const atakmap::feature::Point &loc, const double screen_x, const double screen_y, const double resoution, const int radius, const int limit, int64_t noid) const NOTHROWS;
 
+                    /**
+                     * Hit-tests the geometries that are not covered by
+                     * `requestPick`. If `excludePickable` is `false`, all
+                     * geometries are tested, as with `hitTest2`.
+                     */
+                    Util::TAKErr hitTest2(Port::Collection<int64_t> &fids, const atakmap::feature::Point &loc, const double screen_x, const double screen_y, const double resoution, const int radius, const int limit, int64_t noid, const bool excludePickable) const NOTHROWS;
+
+                    /**
+                     * Requests an ID-buffer pick of the batched sprite
+                     * lines and points about the specified location. The
+                     * geometries are drawn with their feature IDs into a
+                     * small offscreen target during the next sprite pass and
+                     * the pixels are read back asynchronously. The callback
+                     * is invoked on the GL thread once the readback has
+                     * completed, typically one or two frames later.
+                     *
+                     * <P>Surface geometries, polygons, labels and points that
+                     * are not batched are not picked; see `hitTest2`.
+                     *
+                     * <P>May be invoked from any thread.
+                     *
+                     * @param x         The x location, in GL pixel space
+                     * @param y         The y location, in GL pixel space
+                     *                  (bottom = 0)
+                     * @param radius    The pick radius, in pixels
+                     *
+                     * @return  TE_Ok if the pick was queued; the callback is
+                     *          only invoked if the pick was queued
+                     */
+                    Util::TAKErr requestPick(PickCallback callback, void *opaque, const float x, const float y, const int radius) NOTHROWS;
+                    /**
+                     * Delivers the picks whose readback has completed. Must
+                     * be invoked on the GL thread.
+                     *
+                     * @param wait  If `true`, blocks until all drawn picks
+                     *              have been delivered
+                     */
+                    void processPendingPicks(const bool wait) NOTHROWS;
+
                     Util::TAKErr setBatch(Port::Collection<GLBatchGeometry3 *> &geoms) NOTHROWS;
                     Util::TAKErr setBatch(Port::Collection<SharedGLBatchGeometryPtr> &value) NOTHROWS;
 
+                    /**
+                     * If `true`, a batch that contains the same geometries,
+                     * in the same order, as the previous batch updates only
+                     * the buffer data of geometries whose version or level
+                     * of detail has changed. Defaults to `false`.
+                     */
+                    void setIncrementalUpdates(const bool value) NOTHROWS;
+
                     virtual void draw(const TAK::Engine::Renderer::Core::GLGlobeBase &view, const int renderPass) NOTHROWS;
 
                 private:
@@ -192,14 +326,27 @@ namespace TAK {
 
                     Util::TAKErr createLabels() NOTHROWS;
 
+                    /** marks the batch buffers for patching or rebuild following `setBatch` */
+                    void validateBatchBuffers() NOTHROWS;
+                    Util::TAKErr patchLineBuffers(bool *rebuild, std::vector<BufferRecord> &records, const std::vector<LinesBuffer> &bufs, const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx) NOTHROWS;
+                    Util::TAKErr patchPointInstanceBuffers(bool *rebuild, const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx) NOTHROWS;
+
                     Util::TAKErr extrudePoints() NOTHROWS;
 
                     Util::TAKErr batchDrawLollipops(const TAK::Engine::Renderer::Core::GLGlobeBase &view) NOTHROWS;
-                    Util::TAKErr buildLineBuffers(std::vector<LinesBuffer> &bufs, const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const std::list<GLBatchLineString3 *> &lines) NOTHROWS;
-                    Util::TAKErr drawLineBuffers(const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const std::vector<LinesBuffer> &bufs) NOTHROWS;
+                    Util::TAKErr buildLineBuffers(std::vector<LinesBuffer> &bufs, std::vector<BufferRecord> &records, const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const std::list<GLBatchLineString3 *> &lines) NOTHROWS;
+                    Util::TAKErr drawLineBuffers(const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const std::vector<LinesBuffer> &bufs, const bool idPass = false) NOTHROWS;
 
                     Util::TAKErr buildPointsBuffers(std::vector<PointsBuffer> &bufs, const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const std::vector<GLBatchPoint3 *> &lines) NOTHROWS;
                     Util::TAKErr batchDrawPoints(const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx) NOTHROWS;
+                    Util::TAKErr buildPointInstanceBuffers(std::vector<PointsBuffer> &bufs, std::vector<BufferRecord> &records, const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const std::vector<GLBatchPoint3 *> &points) NOTHROWS;
+                    Util::TAKErr batchDrawPointInstances(const TAK::Engine::Renderer::Core::GLGlobeBase &view, const BatchState &ctx, const bool idPass = false) NOTHROWS;
+
+                    /** draws the queued picks; invoked following the sprite pass */
+                    Util::TAKErr drawPicks(const TAK::Engine::Renderer::Core::GLGlobeBase &view) NOTHROWS;
+                    /** resolves a pick ID, as drawn by the ID pass, to the feature ID */
+                    bool resolvePickId(int64_t *fid, const uint32_t id) const NOTHROWS;
+                    void deliverPick(PendingPick &pick, Util::TAKErr code) NOTHROWS;
 
                     Util::TAKErr drawPoints(const TAK::Engine::Renderer::Core::GLGlobeBase &view) NOTHROWS;
 
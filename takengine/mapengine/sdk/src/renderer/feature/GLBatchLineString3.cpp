@@ -5,6 +5,7 @@
 
 #include "renderer/GLES20FixedPipeline.h"
 
+#include "feature/GeometryFactory.h"
 #include "feature/Style.h"
 #include "feature/LineString.h"
 
@@ -133,56 +134,29 @@ TAKErr GLBatchLineString3::setGeometryImpl(BlobPtr &&blob, const int type) NOTHR
 {
     TAKErr code(TE_Ok);
 
-    bool compressed = ((type / 1000000) == 1);
-    int hi = ((type / 1000) % 1000);
-    int dim;
-    if (hi == 0)
-    {
-        dim = 2;
-    }
-    else if (hi == 1 || hi == 2)
-    {
-        dim = 3;
-    }
-    else if (hi == 3)
-    {
-        dim = 4;
-    }
-    else
-    {
-        return TE_IllegalState;
-    }
-
-    int num_points;
-    code = blob->readInt(&num_points);
+    // view the points in place, rather than reading through the blob
+    const uint8_t *data;
+    std::size_t dataLen;
+    code = blob->peek(&data, &dataLen);
     TE_CHECKRETURN_CODE(code);
-    std::size_t maxPoints;
-    if (!compressed)
-    {
-        std::size_t remaining;
-        code = blob->remaining(&remaining);
-        TE_CHECKRETURN_CODE(code);
-        maxPoints = remaining / (dim * 8);
-    }
-    else
-    {
-        std::size_t remaining;
-        code = blob->remaining(&remaining);
-        TE_CHECKRETURN_CODE(code);
-        maxPoints = 1 + ((remaining - (dim * 8)) / (dim * 4));
-    }
 
+    LineStringView view;
+    std::size_t viewLen;
+    code = GeometryFactory_getLineStringView(view, &viewLen, data, dataLen, type, blob->getSourceEndian());
+    if (code == TE_InvalidArg)
+        return TE_IllegalState;
     // XXX - really not sure why this is happening, but sometimes the
     //       simplified geometry appears to come back with a bad number of
     //       points and point data. if we detect this situation, report it
     //       and quietly retain the previous (valid) geometry
-    if (static_cast<std::size_t>(num_points) > maxPoints)
+    if (code == TE_EOF)
     {
 //        Log->w(TAG, "Invalid simplified geometry for " + name + "; field=" + numPoints + " available=" + maxPoints);
         return TE_Ok;
     }
+    TE_CHECKRETURN_CODE(code);
 
-    this->numPoints = static_cast<std::size_t>(num_points);
+    this->numPoints = view.numPoints;
 
     if (!this->points.get() || this->pointsLength < (this->numPoints * 3))
     {
@@ -194,161 +168,30 @@ TAKErr GLBatchLineString3::setGeometryImpl(BlobPtr &&blob, const int type) NOTHR
         this->projectedVerticesLength = (this->numPoints * 3);
     }
 
-    double x;
-    double y;
-    int skip = (dim - 2) * (compressed ? 4 : 8);
-    if (dim == 2 && !compressed)
+    LineStringView_getPoints(this->points.get(), view);
+    if (this->numPoints)
     {
-        code = blob->readDouble(&x);
-        TE_CHECKRETURN_CODE(code);
-        code = blob->readDouble(&y);
-        TE_CHECKRETURN_CODE(code);
-
-        mbb.minX = x;
-        mbb.maxX = x;
-        mbb.minY = y;
-        mbb.maxY = y;
-
-        this->points[0] = x;
-        this->points[1] = y;
-        this->points[2] = 0.0f;
-
-        for (std::size_t i = 1; i < this->numPoints; i++)
-        {
-            code = blob->readDouble(&x);
-            TE_CHECKBREAK_CODE(code);
-            code = blob->readDouble(&y);
-            TE_CHECKBREAK_CODE(code);
-            this->points[i * 3] = x;
-            this->points[i * 3 + 1] = y;
-            this->points[i * 3 + 2] = 0.0f;
-
-            if (x < this->mbb.minX)
-                this->mbb.minX = x;
-            else if (x > this->mbb.maxX)
-                this->mbb.maxX = x;
-            if (y < this->mbb.minY)
-                this->mbb.minY = y;
-            else if (y > this->mbb.maxY)
-                this->mbb.maxY = y;
-        }
-        TE_CHECKRETURN_CODE(code);
+        mbb.minX = this->points[0];
+        mbb.maxX = this->points[0];
+        mbb.minY = this->points[1];
+        mbb.maxY = this->points[1];
     }
-    else if (dim == 3 && !compressed)
+    for (std::size_t i = 1; i < this->numPoints; i++)
     {
-        code = blob->readDouble(&x);
-        TE_CHECKRETURN_CODE(code);
-        code = blob->readDouble(&y);
-        TE_CHECKRETURN_CODE(code);
-        double z;
-        code = blob->readDouble(&z);
-        TE_CHECKRETURN_CODE(code);
-
-        mbb.minX = x;
-        mbb.maxX = x;
-        mbb.minY = y;
-        mbb.maxY = y;
-
-        this->points[0] = x;
-        this->points[1] = y;
-        this->points[2] = z;
-
-        for (std::size_t i = 1; i < this->numPoints; i++)
-        {
-            code = blob->readDouble(&x);
-            TE_CHECKBREAK_CODE(code);
-            code = blob->readDouble(&y);
-            TE_CHECKBREAK_CODE(code);
-            code = blob->readDouble(&z);
-            TE_CHECKBREAK_CODE(code);
-            this->points[i * 3] = x;
-            this->points[i * 3 + 1] = y;
-            this->points[i * 3 + 2] = z;
-
-            if (x < this->mbb.minX)
-                this->mbb.minX = x;
-            else if (x > this->mbb.maxX)
-                this->mbb.maxX = x;
-            if (y < this->mbb.minY)
-                this->mbb.minY = y;
-            else if (y > this->mbb.maxY)
-                this->mbb.maxY = y;
-        }
-        TE_CHECKRETURN_CODE(code);
+        const double x = this->points[i * 3];
+        const double y = this->points[i * 3 + 1];
+        if (x < this->mbb.minX)
+            this->mbb.minX = x;
+        else if (x > this->mbb.maxX)
+            this->mbb.maxX = x;
+        if (y < this->mbb.minY)
+            this->mbb.minY = y;
+        else if (y > this->mbb.maxY)
+            this->mbb.maxY = y;
     }
-    else
-    {
-        code = blob->readDouble(&x);
-        TE_CHECKRETURN_CODE(code);
-        code = blob->readDouble(&y);
-        TE_CHECKRETURN_CODE(code);
-
-        mbb.minX = x;
-        mbb.maxX = x;
-        mbb.minY = y;
-        mbb.maxY = y;
-
-        this->points[0] = x;
-        this->points[1] = y;
-        this->points[2] = 0.0f;
 
-        if (!compressed)
-        {
-            for (std::size_t i = 1; i < this->numPoints; i++)
-            {
-                code = blob->readDouble(&x);
-                TE_CHECKBREAK_CODE(code);
-                code = blob->readDouble(&y);
-                TE_CHECKBREAK_CODE(code);
-
-                code = blob->skip(skip);
-                TE_CHECKBREAK_CODE(code);
-
-                points[i * 3] = x;
-                points[i * 3 + 1] = y;
-                points[i * 3 + 2] = 0.0f;
-
-                if (x < this->mbb.minX)
-                    this->mbb.minX = x;
-                else if (x > this->mbb.maxX)
-                    this->mbb.maxX = x;
-                if (y < this->mbb.minY)
-                    this->mbb.minY = y;
-                else if (y > this->mbb.maxY)
-                    this->mbb.maxY = y;
-            }
-        } else {
-            for (std::size_t i = 1; i < this->numPoints; i++)
-            {
-                float fx;
-                code = blob->readFloat(&fx);
-                TE_CHECKBREAK_CODE(code);
-                x += fx;
-
-                float fy;
-                code = blob->readFloat(&fy);
-                TE_CHECKBREAK_CODE(code);
-                y += fy;
-
-                code = blob->skip(skip);
-                TE_CHECKBREAK_CODE(code);
-
-                points[i * 3] = x;
-                points[i * 3 + 1] = y;
-                points[i * 3 + 2] = 0.0f;
-
-                if (x < this->mbb.minX)
-                    this->mbb.minX = x;
-                else if (x > this->mbb.maxX)
-                    this->mbb.maxX = x;
-                if (y < this->mbb.minY)
-                    this->mbb.minY = y;
-                else if (y > this->mbb.maxY)
-                    this->mbb.maxY = y;
-            }
-        }
-        TE_CHECKRETURN_CODE(code);
-    }
+    code = blob->skip(viewLen);
+    TE_CHECKRETURN_CODE(code);
 
     /*this->points->limit(pointsPos / 4);
 
@@ -74,6 +74,7 @@ GLBatchPoint3::GLBatchPoint3(RenderContext &surface) :
     textureKey(0LL),
     textureId(0),
     textureIndex(0),
+    textureGeneration(0u),
     texCoords(nullptr),
     verts(nullptr),
     iconAtlas(nullptr),
@@ -219,6 +220,7 @@ void GLBatchPoint3::draw(const GLGlobeBase &ortho, const int render_pass) NOTHRO
         if (this->iconUri && (this->textureKey == 0LL || this->iconDirty)) {
             this->checkIcon(this->surface);
         }
+        this->validateTexture();
 
         if (this->textureKey != 0LL) {
             glEnable(GL_BLEND);
@@ -382,7 +384,7 @@ void GLBatchPoint3::draw(const GLGlobeBase &ortho, const int render_pass) NOTHRO
 void GLBatchPoint3::release() NOTHROWS {
     this->texCoords.reset();
     this->verts.reset();
-    this->textureKey = 0LL;
+    this->setTextureKey(0LL);
     if (this->iconLoader.get())
     {
         this->iconLoader.reset();
@@ -579,9 +581,45 @@ TAKErr GLBatchPoint3::setGeometryImpl(const atakmap::feature::Geometry &geom) NO
 }
 
 bool GLBatchPoint3::hasBatchProhibitiveAttributes() const NOTHROWS {
+#if TE_GLES_VERSION >= 3
+    // icon rotation and offset are instance attributes of the batch
+    return this->rotatedLabels; // label rotation
+#else
     return this->iconRotation || // icon rotation
            this->rotatedLabels || // label rotation
            this->iconOffsetX || this->iconOffsetY; // icon offset
+#endif
+}
+
+bool GLBatchPoint3::validateTexture() NOTHROWS
+{
+    if (!this->textureKey || this->textureGeneration == this->iconAtlas->getGeneration())
+        return false;
+
+    this->textureGeneration = this->iconAtlas->getGeneration();
+    if (this->iconAtlas->getTexId(&this->textureId, this->textureKey) != TE_Ok) {
+        // the atlas was released, reload the icon
+        this->textureKey = 0LL;
+        this->textureId = 0;
+        this->textureIndex = 0;
+        return true;
+    }
+    this->iconAtlas->getIndex(&this->textureIndex, this->textureKey);
+    return true;
+}
+
+void GLBatchPoint3::setTextureKey(const int64_t key) NOTHROWS
+{
+    if (this->textureKey)
+        this->iconAtlas->releaseImage(this->textureKey);
+    this->textureKey = key;
+    this->textureId = 0;
+    this->textureIndex = 0;
+    if (key) {
+        this->iconAtlas->getTexId(&this->textureId, key);
+        this->iconAtlas->getIndex(&this->textureIndex, key);
+    }
+    this->textureGeneration = this->iconAtlas->getGeneration();
 }
 
 bool GLBatchPoint3::validateProjectedLocation(const GLGlobeBase &view) NOTHROWS
@@ -659,6 +697,7 @@ TAKErr GLBatchPoint3::batch(const GLGlobeBase &view, const int render_pass, GLRe
         if (!this->textureKey != 0LL)
             return TE_Ok;
     }
+    this->validateTexture();
 
     this->validateProjectedLocation(view);
 
@@ -702,6 +741,7 @@ TAKErr GLBatchPoint3::batch(const GLGlobeBase &view, const int render_pass, GLRe
     if (this->iconUri && (this->textureKey == 0LL || this->iconDirty)) {
         this->checkIcon(this->surface);
     }
+    this->validateTexture();
 
     if (this->textureKey != 0LL)
     {
@@ -878,9 +918,8 @@ TAKErr GLBatchPoint3::getOrFetchIcon(RenderContext &surface, GLBatchPoint3 &poin
         int64_t key = 0LL;
         point.iconAtlas->getTextureKey(&key, point.iconUri);
         if (key != 0LL) {
-            point.textureKey = key;
-            point.iconAtlas->getTexId(&point.textureId, point.textureKey);
-            point.iconAtlas->getIndex(&point.textureIndex, point.textureKey);
+            point.iconAtlas->retainImage(key);
+            point.setTextureKey(key);
             point.iconLoader.reset();
             point.iconLoaderUri = nullptr;
             point.iconDirty = false;
@@ -888,6 +927,25 @@ TAKErr GLBatchPoint3::getOrFetchIcon(RenderContext &surface, GLBatchPoint3 &poin
             return TE_Ok;
         }
 
+        // icons decoded for other points, or previously evicted from the
+        // atlas, are added directly from the loader's cache
+        {
+            AsyncBitmapLoader2 *bitmapLoader = nullptr;
+            GLMapRenderGlobals_getBitmapLoader(&bitmapLoader, point.surface);
+            std::shared_ptr<Bitmap2> bitmap;
+            if (bitmapLoader && bitmapLoader->getCachedBitmap(bitmap, point.iconUri) == TE_Ok) {
+                point.iconAtlas->addImage(&key, point.iconUri, *bitmap);
+                point.setTextureKey(key);
+                if (point.iconLoader.get()) {
+                    point.iconLoader.reset();
+                    dereferenceIconLoaderNoSync(point.iconLoaderUri);
+                }
+                point.iconLoaderUri = nullptr;
+                point.iconDirty = false;
+                return TE_Ok;
+            }
+        }
+
         if (point.iconLoader.get()) {
             Future<std::shared_ptr<Bitmap2>> bitmapFuture = point.iconLoader->getFuture();
             if (bitmapFuture.isDone()) {
@@ -924,10 +982,10 @@ TAKErr GLBatchPoint3::getOrFetchIcon(RenderContext &surface, GLBatchPoint3 &poin
                     }
                 }
 
-                point.iconAtlas->addImage(&point.textureKey, point.iconUri, *bitmap);
+                key = 0LL;
+                point.iconAtlas->addImage(&key, point.iconUri, *bitmap);
                 bitmap.reset();
-                point.iconAtlas->getTexId(&point.textureId, point.textureKey);
-                point.iconAtlas->getIndex(&point.textureIndex, point.textureKey);
+                point.setTextureKey(key);
                 point.iconLoader.reset();
                 dereferenceIconLoaderNoSync(point.iconLoaderUri);
                 point.iconLoaderUri = nullptr;
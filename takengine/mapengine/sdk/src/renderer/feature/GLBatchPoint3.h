@@ -13,6 +13,7 @@
 #include "thread/Mutex.h"
 #include "util/FutureTask.h"
 #include "util/Memory.h"
+#include "util/SlabAllocator.h"
 
 namespace TAK {
     namespace Engine {
@@ -24,6 +25,7 @@ namespace TAK {
 
                 class ENGINE_API GLBatchPoint3 : public GLBatchGeometry3
                 {
+                    TE_SLAB_ALLOCATED()
                 public:
                     struct IconLoaderEntry {
                         TAK::Engine::Renderer::AsyncBitmapLoader2::Task task;
@@ -78,6 +80,18 @@ namespace TAK {
                     virtual Util::TAKErr batchLabels(const TAK::Engine::Renderer::Core::GLGlobeBase &view, const int render_pass, GLRenderBatch2 & batch);
                 private :
                     bool validateProjectedLocation(const TAK::Engine::Renderer::Core::GLGlobeBase &view) NOTHROWS;
+                    /**
+                     * Re-resolves the texture ID and index of the icon if the
+                     * icon atlas has relocated its images. Returns `true` if
+                     * the texture was re-resolved.
+                     */
+                    bool validateTexture() NOTHROWS;
+                    /**
+                     * Sets the icon atlas key, releasing the reference held
+                     * on the previous key. The caller transfers one reference
+                     * on `key` to the point.
+                     */
+                    void setTextureKey(const int64_t key) NOTHROWS;
                 public :
                     /// <summary>
                     ///*********************************************************************** </summary>
@@ -128,6 +142,7 @@ namespace TAK {
                     int64_t textureKey;
                     int textureId;
                     int textureIndex;
+                    std::size_t textureGeneration;
                     Port::String iconLoaderUri;
                     Util::array_ptr<float> texCoords;
                     Util::array_ptr<float> verts;
@@ -417,9 +417,7 @@ TAKErr GLPersistentFeatureDataStoreRenderer::queryImpl(QueryContext &ctx, const
                         entry = styleMap.find(styleString);
                         if (entry == styleMap.end()) {
                             StylePtr_const parsed(NULL, NULL);
-                            try {
-                                parsed = StylePtr_const(atakmap::feature::Style::parseStyle(styleString), atakmap::feature::Style::destructStyle);
-                            } catch (...) {}
+                            atakmap::feature::Style_parseStyleShared(parsed, styleString);
                             if (parsed.get()) {
                                 style = std::move(parsed);
                                 styleMap.insert(std::pair<std::string, std::shared_ptr<const atakmap::feature::Style>>(styleString, style));
@@ -472,9 +470,7 @@ TAKErr GLPersistentFeatureDataStoreRenderer::queryImpl(QueryContext &ctx, const
                     entry = styleMap.find(styleString);
                     if (entry == styleMap.end()) {
                         StylePtr_const parsed(NULL, NULL);
-                        try {
-                            parsed = StylePtr_const(atakmap::feature::Style::parseStyle(styleString), atakmap::feature::Style::destructStyle);
-                        } catch (...) {}
+                        atakmap::feature::Style_parseStyleShared(parsed, styleString);
                         if (parsed.get()) {
                             style = std::move(parsed);
                             styleMap.insert(std::pair<std::string, std::shared_ptr<const atakmap::feature::Style>>(styleString, style));
@@ -1,7 +1,10 @@
 
 
-#include "thread/Lock.h"
 #include "renderer/feature/GLStyleSpi.h"
+
+#include <algorithm>
+#include <stdexcept>
+
 #include "renderer/feature/GLStyle.h"
 
 using namespace atakmap::renderer::feature;
@@ -11,41 +14,38 @@ using namespace TAK::Engine::Util;
 
 GLStyleSpi::~GLStyleSpi() { }
 
-std::list<GLStyleSpi *> GLStyleFactory::spis;
-Mutex GLStyleFactory::mutex;
+ReadCopyUpdate<std::list<GLStyleSpi *>> GLStyleFactory::spis;
 
 void GLStyleFactory::registerSpi(atakmap::renderer::feature::GLStyleSpi *spi) {
-    TAKErr code(TE_Ok);
-    LockPtr lock(NULL, NULL);
-    code = Lock_create(lock, mutex);
+    TAKErr code = spis.update([spi](std::list<GLStyleSpi *> &registry) -> TAKErr
+    {
+        registry.push_back(spi);
+        return TE_Ok;
+    });
     if (code != TE_Ok)
-        throw std::runtime_error("GLStyleFactory::unregisterSpi: failed to acquire mutex");
-    spis.push_back(spi);
+        throw std::runtime_error("GLStyleFactory::registerSpi: failed to update registry");
 }
 
 void GLStyleFactory::unregisterSpi(atakmap::renderer::feature::GLStyleSpi *spi) {
-    TAKErr code(TE_Ok);
-    LockPtr lock(NULL, NULL);
-    code = Lock_create(lock, mutex);
+    TAKErr code = spis.update([spi](std::list<GLStyleSpi *> &registry) -> TAKErr
+    {
+        std::list<GLStyleSpi *>::iterator it = std::find(registry.begin(), registry.end(), spi);
+        if (it != registry.end()) {
+            registry.erase(it);
+        }
+        return TE_Ok;
+    });
     if (code != TE_Ok)
-        throw std::runtime_error("GLStyleFactory::unregisterSpi: failed to acquire mutex");
-    std::list<GLStyleSpi *>::iterator it = std::find(spis.begin(), spis.end(), spi);
-    if (it != spis.end()) {
-        spis.erase(it);
-    }
+        throw std::runtime_error("GLStyleFactory::unregisterSpi: failed to update registry");
 }
 
 GLStyle *GLStyleFactory::create(const atakmap::renderer::feature::GLStyleSpiArg &style) {
     
-    TAKErr code(TE_Ok);
-    LockPtr lock(NULL, NULL);
-    code = Lock_create(lock, mutex);
-    if (code != TE_Ok)
-        throw std::runtime_error("GLStyleFactory::unregisterSpi: failed to acquire mutex");
+    ReadCopyUpdate<std::list<GLStyleSpi *>>::ReadGuard registry(spis);
     GLStyle *retval = NULL;
     
-    std::list<GLStyleSpi *>::iterator it = spis.begin();
-    std::list<GLStyleSpi *>::iterator end = spis.end();
+    std::list<GLStyleSpi *>::const_iterator it = registry->begin();
+    std::list<GLStyleSpi *>::const_iterator end = registry->end();
     for (; it != end; ++it) {
         if ((retval = (*it)->create(style))) {
             break;
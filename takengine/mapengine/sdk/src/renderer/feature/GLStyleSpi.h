@@ -2,7 +2,7 @@
 #define ATAKMAP_RENDERER_FEATURE_STYLE_GLSTYLESPI_H_INCLUDED
 
 #include <list>
-#include "thread/Mutex.h"
+#include "thread/ReadCopyUpdate.h"
 
 namespace atakmap {
     
@@ -36,8 +36,7 @@ namespace atakmap {
                 static GLStyle *create(const GLStyleSpiArg &style);
                 
             private:
-                static std::list<GLStyleSpi *> spis;
-                static TAK::Engine::Thread::Mutex mutex;
+                static TAK::Engine::Thread::ReadCopyUpdate<std::list<GLStyleSpi *>> spis;
             };
         }
     }
@@ -5,13 +5,28 @@
 
 #include "util/Logging.h"
 
+#include "port/Platform.h"
 #include "renderer/GL.h"
+#include "thread/Monitor.h"
+#include "util/Tasking.h"
+#include "util/Work.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <stdexcept>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TE_GDALGRAPHICUTILS_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define TE_GDALGRAPHICUTILS_NEON
+#endif
+
 using namespace atakmap::raster;
 
 using namespace atakmap::renderer::map::layer::raster::gdal;
@@ -1272,6 +1287,191 @@ namespace {
     
     /*************************************************************************/
     
+    /**
+     * Interleaves the specified component rows into 32-bit pixels. If `c3`
+     * is NULL, the fourth component is opaque.
+     */
+    void interleave4(uint8_t *dst, const uint8_t *c0, const uint8_t *c1, const uint8_t *c2, const uint8_t *c3, const std::size_t n)
+    {
+        std::size_t i = 0u;
+#if defined(TE_GDALGRAPHICUTILS_SSE2)
+        const __m128i opaque = _mm_set1_epi8((char)0xFF);
+        for (; (i + 16u) <= n; i += 16u) {
+            const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + i));
+            const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + i));
+            const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + i));
+            const __m128i v3 = c3 ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(c3 + i)) : opaque;
+            const __m128i lo01 = _mm_unpacklo_epi8(v0, v1);
+            const __m128i hi01 = _mm_unpackhi_epi8(v0, v1);
+            const __m128i lo23 = _mm_unpacklo_epi8(v2, v3);
+            const __m128i hi23 = _mm_unpackhi_epi8(v2, v3);
+            __m128i *out = reinterpret_cast<__m128i *>(dst + (i * 4u));
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(lo01, lo23));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo01, lo23));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi01, hi23));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi01, hi23));
+        }
+#elif defined(TE_GDALGRAPHICUTILS_NEON)
+        const uint8x16_t opaque = vdupq_n_u8(0xFFu);
+        for (; (i + 16u) <= n; i += 16u) {
+            uint8x16x4_t px;
+            px.val[0] = vld1q_u8(c0 + i);
+            px.val[1] = vld1q_u8(c1 + i);
+            px.val[2] = vld1q_u8(c2 + i);
+            px.val[3] = c3 ? vld1q_u8(c3 + i) : opaque;
+            vst4q_u8(dst + (i * 4u), px);
+        }
+#endif
+        for (; i < n; i++) {
+            uint8_t *d = dst + (i * 4u);
+            d[0] = c0[i];
+            d[1] = c1[i];
+            d[2] = c2[i];
+            d[3] = c3 ? c3[i] : (uint8_t)0xFF;
+        }
+    }
+    
+    /**
+     * Expands 24-bit pixels to opaque 32-bit pixels.
+     */
+    void expand3to4(uint8_t *dst, const uint8_t *src, const std::size_t n)
+    {
+        std::size_t i = 0u;
+#if defined(TE_GDALGRAPHICUTILS_NEON)
+        for (; (i + 16u) <= n; i += 16u) {
+            const uint8x16x3_t s = vld3q_u8(src + (i * 3u));
+            uint8x16x4_t px;
+            px.val[0] = s.val[0];
+            px.val[1] = s.val[1];
+            px.val[2] = s.val[2];
+            px.val[3] = vdupq_n_u8(0xFFu);
+            vst4q_u8(dst + (i * 4u), px);
+        }
+#endif
+        for (; i < n; i++) {
+            const uint8_t *s = src + (i * 3u);
+            uint8_t *d = dst + (i * 4u);
+            d[0] = s[0];
+            d[1] = s[1];
+            d[2] = s[2];
+            d[3] = (uint8_t)0xFF;
+        }
+    }
+    
+    /**
+     * Converts rows [row0, row1) of the specified data to RGBA
+     */
+    typedef void (*RowKernel)(uint8_t *dst, const uint8_t *data, int width, int height, int row0, int row1);
+    
+    /**
+     * Converts rows of band sequential or line interleaved data with
+     * `Bands` bands to RGBA. The output components are sourced from the
+     * bands at the specified indices; if `A` is negative, the output is
+     * opaque.
+     */
+    template<int Bands, int R, int G, int B, int A, bool LineInterleave>
+    void PlanarToRGBA(uint8_t *dst, const uint8_t *data, int width, int height, int row0, int row1)
+    {
+        const std::size_t w = (std::size_t)width;
+        const std::size_t bandStride = LineInterleave ? w : (w * (std::size_t)height);
+        const std::size_t rowStride = LineInterleave ? (w * Bands) : w;
+        for (int i = row0; i < row1; i++) {
+            const uint8_t *row = data + ((std::size_t)i * rowStride);
+            interleave4(dst + ((std::size_t)i * w * 4u),
+                        row + (R * bandStride),
+                        row + (G * bandStride),
+                        row + (B * bandStride),
+                        (A < 0) ? nullptr : row + ((A < 0 ? 0 : A) * bandStride),
+                        w);
+        }
+    }
+    
+    void RGB_BIPToRGBA(uint8_t *dst, const uint8_t *data, int width, int height, int row0, int row1)
+    {
+        const std::size_t w = (std::size_t)width;
+        for (int i = row0; i < row1; i++)
+            expand3to4(dst + ((std::size_t)i * w * 4u), data + ((std::size_t)i * w * 3u), w);
+    }
+    
+    /**
+     * Rows of a single conversion, claimed in slices by the calling thread
+     * and the CPU workers. A slice is only ever waited on once it has been
+     * claimed, so the conversion completes even if no worker is available.
+     */
+    struct RowSplit
+    {
+        RowKernel kernel;
+        uint8_t *dst;
+        const uint8_t *data;
+        int width;
+        int height;
+        int rowsPerSlice;
+        int slices;
+        std::atomic<int> next;
+        int pending;
+        TAK::Engine::Thread::Monitor monitor;
+    };
+    
+    bool RowSplit_runSlice(RowSplit &split)
+    {
+        const int slice = split.next.fetch_add(1);
+        if (slice >= split.slices)
+            return false;
+        const int row0 = slice * split.rowsPerSlice;
+        const int row1 = std::min(row0 + split.rowsPerSlice, split.height);
+        split.kernel(split.dst, split.data, split.width, split.height, row0, row1);
+        
+        TAK::Engine::Thread::Monitor::Lock lock(split.monitor);
+        if (--split.pending == 0)
+            lock.broadcast();
+        return true;
+    }
+    
+    TAK::Engine::Util::TAKErr RowSplit_task(bool &, const std::shared_ptr<RowSplit> &split) NOTHROWS
+    {
+        while (RowSplit_runSlice(*split))
+            ;
+        return TAK::Engine::Util::TE_Ok;
+    }
+    
+    /** minimum pixel count for which a conversion is split across threads */
+    const int ROW_SPLIT_MIN_PIXELS = 1024 * 1024;
+    /** minimum rows per slice of a split conversion */
+    const int ROW_SPLIT_MIN_ROWS = 64;
+    
+    void fillRows(RowKernel kernel, void *buffer, const uint8_t *data, int width, int height)
+    {
+        auto *dst = static_cast<uint8_t *>(buffer);
+        const int ncpu = (int)TAK::Engine::Port::Platform_processorCount();
+        const int slices = std::min(ncpu, height / ROW_SPLIT_MIN_ROWS);
+        if (((int64_t)width * (int64_t)height) < ROW_SPLIT_MIN_PIXELS || slices < 2) {
+            kernel(dst, data, width, height, 0, height);
+            return;
+        }
+        
+        std::shared_ptr<RowSplit> split(new RowSplit());
+        split->kernel = kernel;
+        split->dst = dst;
+        split->data = data;
+        split->width = width;
+        split->height = height;
+        split->rowsPerSlice = (height + slices - 1) / slices;
+        split->slices = (height + split->rowsPerSlice - 1) / split->rowsPerSlice;
+        split->next = 0;
+        split->pending = split->slices;
+        
+        for (int i = 1; i < split->slices; i++)
+            TAK::Engine::Util::Task_begin(TAK::Engine::Util::GeneralWorkers_cpu(), RowSplit_task, split);
+        while (RowSplit_runSlice(*split))
+            ;
+        
+        TAK::Engine::Thread::Monitor::Lock lock(split->monitor);
+        while (split->pending)
+            lock.wait();
+    }
+    
+    /*************************************************************************/
+    
 #define BUFFER_DECLS(scanlineSize) \
 uint8_t *pBuffer = static_cast<uint8_t *>(buffer); \
 ScopePointer<uint8_t> scanline((scanlineSize));
@@ -1328,21 +1528,7 @@ memcpy(buffer, ptr, (size));
     void MonoToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                  void *buffer, const uint8_t *data, int width, int height)
     {
-        BUFFER_DECLS(width * 4);
-        int didx = 0;
-        int sidx;
-        uint8_t p;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                p = data[didx++];
-                scanline[sidx++] = p;
-                scanline[sidx++] = p;
-                scanline[sidx++] = p;
-                scanline[sidx++] = (uint8_t)0xFF;
-            }
-            COPY_SCANLINE();
-        }
+        fillRows(PlanarToRGBA<1, 0, 0, 0, -1, false>, buffer, data, width, height);
     }
     
     void MonoToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -1571,22 +1757,7 @@ memcpy(buffer, ptr, (size));
     void MonoAlphaBSQToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                          void *buffer, const uint8_t *data, int width, int height)
     {
-        BUFFER_DECLS(width * 4);
-        int didx0 = 0;
-        int didx1 = (width * height);
-        int sidx;
-        uint8_t p;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                p = data[didx0++];
-                scanline[sidx++] = p;
-                scanline[sidx++] = p;
-                scanline[sidx++] = p;
-                scanline[sidx++] = data[didx1++];
-            }
-            COPY_SCANLINE();
-        }
+        fillRows(PlanarToRGBA<2, 0, 0, 0, 1, false>, buffer, data, width, height);
     }
     
     void MonoAlphaBSQToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -1686,24 +1857,7 @@ memcpy(buffer, ptr, (size));
     void MonoAlphaBILToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                          void *buffer, const uint8_t *data, int width, int height)
     {
-        BUFFER_DECLS(width * 4);
-        int didx0 = 0;
-        int didx1 = (width * height);
-        int sidx;
-        uint8_t p;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            didx0 = i * width * 2;
-            didx1 = didx0 + width;
-            for (int j = 0; j < width; j++) {
-                p = data[didx0++];
-                scanline[sidx++] = p;
-                scanline[sidx++] = p;
-                scanline[sidx++] = p;
-                scanline[sidx++] = data[didx1++];
-            }
-            COPY_SCANLINE();
-        }
+        fillRows(PlanarToRGBA<2, 0, 0, 0, 1, true>, buffer, data, width, height);
     }
     
     void MonoAlphaBILToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -1828,19 +1982,7 @@ memcpy(buffer, ptr, (size));
     void RGB_BIPToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                     void *buffer, const uint8_t *data, int width, int height)
     {
-        BUFFER_DECLS(width * 4);
-        int didx = 0;
-        int sidx = 0;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[didx++];
-                scanline[sidx++] = data[didx++];
-                scanline[sidx++] = data[didx++];
-                scanline[sidx++] = (uint8_t)0xFF;
-            }
-            COPY_SCANLINE();
-        }
+        fillRows(RGB_BIPToRGBA, buffer, data, width, height);
     }
     
     void RGB_BIPToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -1987,21 +2129,7 @@ memcpy(buffer, ptr, (size));
     void RGB_BSQToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                     void *buffer, const uint8_t *data, int width, int height)
     {
-        BUFFER_DECLS(width * 4);
-        int idx0 = 0;
-        int idx1 = idx0 + (width * height);
-        int idx2 = idx1 + (width * height);
-        int sidx;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[idx0++];
-                scanline[sidx++] = data[idx1++];
-                scanline[sidx++] = data[idx2++];
-                scanline[sidx++] = (uint8_t)0xFF;
-            }
-            COPY_SCANLINE();
-        }
+        fillRows(PlanarToRGBA<3, 0, 1, 2, -1, false>, buffer, data, width, height);
     }
     
     void RGB_BSQToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -2160,24 +2288,7 @@ memcpy(buffer, ptr, (size));
     void RGB_BILToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                     void *buffer, const uint8_t *data, int width, int height)
     {
-        BUFFER_DECLS(width*4);
-        int idx0 = 0;
-        int idx1;
-        int idx2;
-        int sidx;
-        for (int i = 0; i < height; i++) {
-            idx0 = i * (width * 3);
-            idx1 = idx0 + width;
-            idx2 = idx1 + width;
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[idx0++];
-                scanline[sidx++] = data[idx1++];
-                scanline[sidx++] = data[idx2++];
-                scanline[sidx++] = (uint8_t)0xFF;
-            }
-            COPY_SCANLINE();
-        }
+        fillRows(PlanarToRGBA<3, 0, 1, 2, -1, true>, buffer, data, width, height);
     }
     
     void RGB_BILToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -2466,24 +2577,7 @@ memcpy(buffer, ptr, (size));
     void RGBA_BSQToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                      void *buffer, const uint8_t *data, int width, int height)
     {
-        auto *pBuffer = static_cast<uint8_t *>(buffer);
-        ScopePointer<uint8_t> scanline(width * 4);
-        int idx0 = 0;
-        int idx1 = idx0 + (width * height);
-        int idx2 = idx1 + (width * height);
-        int idx3 = idx2 + (width * height);
-        int sidx;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[idx0++];
-                scanline[sidx++] = data[idx1++];
-                scanline[sidx++] = data[idx2++];
-                scanline[sidx++] = data[idx3++];
-            }
-            memcpy(pBuffer, scanline.ptr, scanline.capacity);
-            pBuffer += scanline.capacity;
-        }
+        fillRows(PlanarToRGBA<4, 0, 1, 2, 3, false>, buffer, data, width, height);
     }
     
     void RGBA_BSQToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -2625,28 +2719,7 @@ memcpy(buffer, ptr, (size));
     void RGBA_BILToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                      void *buffer, const uint8_t *data, int width, int height)
     {
-        auto *pBuffer = static_cast<uint8_t *>(buffer);
-        ScopePointer<uint8_t> scanline(width * 4);
-        int idx0;
-        int idx1;
-        int idx2;
-        int idx3;
-        int sidx;
-        for (int i = 0; i < height; i++) {
-            idx0 = i * (width * 3);
-            idx1 = idx0 + width;
-            idx2 = idx1 + width;
-            idx3 = idx2 + width;
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[idx0++];
-                scanline[sidx++] = data[idx1++];
-                scanline[sidx++] = data[idx2++];
-                scanline[sidx++] = data[idx3++];
-            }
-            memcpy(pBuffer, scanline.ptr, scanline.capacity);
-            pBuffer += scanline.capacity;
-        }
+        fillRows(PlanarToRGBA<4, 0, 1, 2, 3, true>, buffer, data, width, height);
     }
     
     void RGBA_BILToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -3001,24 +3074,7 @@ memcpy(buffer, ptr, (size));
     void ARGB_BSQToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                      void *buffer, const uint8_t *data, int width, int height)
     {
-        auto *pBuffer = static_cast<uint8_t *>(buffer);
-        ScopePointer<uint8_t> scanline(width * 4);
-        int idx0 = (width * height);
-        int idx1 = idx0 + (width * height);
-        int idx2 = idx1 + (width * height);
-        int idx3 = 0;
-        int sidx;
-        for (int i = 0; i < height; i++) {
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[idx0++];
-                scanline[sidx++] = data[idx1++];
-                scanline[sidx++] = data[idx2++];
-                scanline[sidx++] = data[idx3++];
-            }
-            memcpy(pBuffer, scanline.ptr, scanline.capacity);
-            pBuffer += scanline.capacity;
-        }
+        fillRows(PlanarToRGBA<4, 1, 2, 3, 0, false>, buffer, data, width, height);
     }
     
     void ARGB_BSQToBuffer__GL_RGB__GL_UNSIGNED_SHORT_5_6_5(
@@ -3298,28 +3354,7 @@ memcpy(buffer, ptr, (size));
     void ARGB_BILToBuffer__GL_RGBA__GL_UNSIGNED_BYTE(
                                                      void *buffer, const uint8_t *data, int width, int height)
     {
-        auto *pBuffer = static_cast<uint8_t *>(buffer);
-        ScopePointer<uint8_t> scanline(width*4);
-        int idx0 = 0;
-        int idx1;
-        int idx2;
-        int idx3;
-        int sidx;
-        for (int i = 0; i < height; i++) {
-            idx0 = i * (width * 4) + width;
-            idx1 = idx0 + width;
-            idx2 = idx1 + width;
-            idx3 = i * (width * 4);
-            sidx = 0;
-            for (int j = 0; j < width; j++) {
-                scanline[sidx++] = data[idx0++];
-                scanline[sidx++] = data[idx1++];
-                scanline[sidx++] = data[idx2++];
-                scanline[sidx++] = data[idx3++];
-            }
-            memcpy(pBuffer, scanline.ptr, scanline.capacity);
-            pBuffer += scanline.capacity;
-        }
+        fillRows(PlanarToRGBA<4, 1, 2, 3, 0, true>, buffer, data, width, height);
     }
     
     /*************************************************************************/
@@ -14,6 +14,7 @@
 #include "renderer/GLES20FixedPipeline.h"
 #include "util/MathUtils.h"
 #include "renderer/GLDepthSampler.h"
+#include "renderer/GLPerformanceCounters.h"
 #include "renderer/GLWorkers.h"
 #include "util/Tasking.h"
 #include "renderer/GLES20FixedPipeline.h"
@@ -119,6 +120,7 @@ namespace {
             a.colorPointer == b.colorPointer &&
             a.normals == b.normals &&
             a.lighting == b.lighting &&
+            a.instanced == b.instanced &&
             a.windingOrder == b.windingOrder;
     }
 
@@ -182,8 +184,107 @@ namespace {
     constexpr uint32_t OP_TEX_ = ((4 << 1) | PREPARE_BIT_);
     constexpr uint32_t OP_DRAWA_ = (1 << 1);
     constexpr uint32_t OP_DRAWE_ = (2 << 1);
+    constexpr uint32_t OP_DRAWAI_ = (3 << 1);
+    constexpr uint32_t OP_DRAWEI_ = (4 << 1);
 
     //
+
+    void multiplyColumnMajor(float* dst, const float* a, const float* b) NOTHROWS {
+        for (std::size_t c = 0u; c < 4u; c++) {
+            for (std::size_t r = 0u; r < 4u; r++) {
+                dst[c * 4u + r] = a[r] * b[c * 4u] +
+                    a[4u + r] * b[c * 4u + 1u] +
+                    a[8u + r] * b[c * 4u + 2u] +
+                    a[12u + r] * b[c * 4u + 3u];
+            }
+        }
+    }
+
+    /**
+     * Issues the draw call, sourcing indices from either a VBO or client memory. An instance count of zero issues a
+     * non-instanced draw.
+     */
+    void drawGeometry(GLenum draw_mode, GLsizei count, const GLBatch::Buffer* indices, GLsizei instance_count) NOTHROWS {
+        GLPerformanceCounters_draw(draw_mode, count, instance_count ? instance_count : 1);
+        if (!indices) {
+#if TE_GLES_VERSION >= 3
+            if (instance_count) {
+                glDrawArraysInstanced(draw_mode, 0, count, instance_count);
+                return;
+            }
+#endif
+            glDrawArrays(draw_mode, 0, count);
+            return;
+        }
+
+        const void* pointer = indices->u.ptr;
+        if (indices->is_vbo) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->u.vbo_id);
+            pointer = nullptr;
+        }
+#if TE_GLES_VERSION >= 3
+        if (instance_count)
+            glDrawElementsInstanced(draw_mode, count, GL_UNSIGNED_SHORT, pointer, instance_count);
+        else
+#endif
+            glDrawElements(draw_mode, count, GL_UNSIGNED_SHORT, pointer);
+        if (indices->is_vbo)
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_NONE);
+    }
+
+    /**
+     * Draws the geometry once per column-major transform. With hardware instancing the transforms are streamed as the
+     * per-instance `aInstanceTransform` attribute; otherwise each instance is drawn individually.
+     */
+    void drawInstances(GLuint& bound_array_buffer, const Shader& shader, const float* model_view,
+        GLenum draw_mode, GLsizei count, const GLBatch::Buffer* indices, const float* transforms, GLsizei instance_count) NOTHROWS {
+
+        const GLsizei matrixStride = static_cast<GLsizei>(16u * sizeof(float));
+#if TE_GLES_VERSION >= 3
+        if (shader.aInstanceTransform != -1) {
+            // transforms are sourced from the batch's client memory
+            if (bound_array_buffer) {
+                glBindBuffer(GL_ARRAY_BUFFER, GL_NONE);
+                bound_array_buffer = GL_NONE;
+            }
+            const GLuint loc = static_cast<GLuint>(shader.aInstanceTransform);
+            for (GLuint i = 0u; i < 4u; i++) {
+                glVertexAttribPointer(loc + i, 4, GL_FLOAT, false, matrixStride, transforms + (4u * i));
+                glVertexAttribDivisor(loc + i, 1u);
+            }
+            drawGeometry(draw_mode, count, indices, instance_count);
+            // divisors are VAO state; restore the defaults for the other renderers
+            for (GLuint i = 0u; i < 4u; i++)
+                glVertexAttribDivisor(loc + i, 0u);
+            return;
+        }
+#endif
+        const bool instanceAttrib = (shader.aInstanceTransform != -1);
+        const GLuint loc = instanceAttrib ? static_cast<GLuint>(shader.aInstanceTransform) : 0u;
+        if (instanceAttrib) {
+            // supply the transform as a constant attribute value per draw
+            for (GLuint i = 0u; i < 4u; i++)
+                glDisableVertexAttribArray(loc + i);
+        }
+        float mv[16];
+        for (GLsizei i = 0; i < instance_count; i++) {
+            const float* transform = transforms + (16u * i);
+            if (instanceAttrib) {
+                for (GLuint c = 0u; c < 4u; c++)
+                    glVertexAttrib4fv(loc + c, transform + (4u * c));
+            } else {
+                multiplyColumnMajor(mv, model_view, transform);
+                glUniformMatrix4fv(shader.uModelView, 1, false, mv);
+            }
+            drawGeometry(draw_mode, count, indices, 0);
+        }
+        if (instanceAttrib) {
+            for (GLuint i = 0u; i < 4u; i++)
+                glEnableVertexAttribArray(loc + i);
+        } else {
+            glUniformMatrix4fv(shader.uModelView, 1, false, model_view);
+        }
+    }
 }
 
 GLBatch::GLBatch(size_t shader_count,
@@ -376,7 +477,7 @@ TAKErr GLBatchBuilder::drawElements(GLenum draw_mode, size_t index_count, size_t
 
     this->prepareForDraw();
 
-    uint32_t instr = (draw_mode << (OPERAND_SHIFT_ + 8)) | (static_cast<uint32_t>(buffer_index) << OPERAND_SHIFT_) | OP_DRAWA_;
+    uint32_t instr = (draw_mode << (OPERAND_SHIFT_ + 8)) | (static_cast<uint32_t>(buffer_index) << OPERAND_SHIFT_) | OP_DRAWE_;
     this->instrs_.push_back(instr);
 
     instr = static_cast<uint32_t>(index_count);
@@ -385,7 +486,77 @@ TAKErr GLBatchBuilder::drawElements(GLenum draw_mode, size_t index_count, size_t
     return TE_Ok;
 }
 
-TAKErr GLBatchBuilder::prepareForDraw() NOTHROWS {
+TAKErr GLBatchBuilder::drawArraysInstanced(GLenum draw_mode, size_t vert_count, const Matrix2* transforms, size_t instance_count) NOTHROWS {
+
+    if (vert_count > std::numeric_limits<uint32_t>::max() || instance_count > std::numeric_limits<uint32_t>::max())
+        return TE_InvalidArg;
+    if (!transforms && instance_count)
+        return TE_InvalidArg;
+    if (!instance_count)
+        return TE_Ok;
+
+    TAKErr code = this->prepareForDraw(true);
+    if (code != TE_Ok)
+        return code;
+
+    const size_t raw_offset = this->appendInstanceTransforms(transforms, instance_count);
+    if (raw_offset > std::numeric_limits<uint32_t>::max())
+        return TE_OutOfMemory;
+
+    this->instrs_.push_back((draw_mode << (OPERAND_SHIFT_ + 8)) | OP_DRAWAI_);
+    this->instrs_.push_back(static_cast<uint32_t>(vert_count));
+    this->instrs_.push_back(static_cast<uint32_t>(instance_count));
+    this->instrs_.push_back(static_cast<uint32_t>(raw_offset));
+
+    return TE_Ok;
+}
+
+TAKErr GLBatchBuilder::drawElementsInstanced(GLenum draw_mode, size_t index_count, size_t buffer_index, const Matrix2* transforms, size_t instance_count) NOTHROWS {
+
+    if (index_count > std::numeric_limits<uint32_t>::max() || instance_count > std::numeric_limits<uint32_t>::max())
+        return TE_InvalidArg;
+    if (buffer_index > 0xff)
+        return TE_InvalidArg;
+    if (!transforms && instance_count)
+        return TE_InvalidArg;
+    if (!instance_count)
+        return TE_Ok;
+
+    TAKErr code = this->prepareForDraw(true);
+    if (code != TE_Ok)
+        return code;
+
+    const size_t raw_offset = this->appendInstanceTransforms(transforms, instance_count);
+    if (raw_offset > std::numeric_limits<uint32_t>::max())
+        return TE_OutOfMemory;
+
+    this->instrs_.push_back((draw_mode << (OPERAND_SHIFT_ + 8)) | (static_cast<uint32_t>(buffer_index) << OPERAND_SHIFT_) | OP_DRAWEI_);
+    this->instrs_.push_back(static_cast<uint32_t>(index_count));
+    this->instrs_.push_back(static_cast<uint32_t>(instance_count));
+    this->instrs_.push_back(static_cast<uint32_t>(raw_offset));
+
+    return TE_Ok;
+}
+
+size_t GLBatchBuilder::appendInstanceTransforms(const Matrix2* transforms, size_t instance_count) NOTHROWS {
+
+    const size_t raw_offset = this->raw_.size();
+    this->raw_.reserve(raw_offset + (instance_count * GLBatch::MATRIX_SIZE_));
+
+    double mxd[16];
+    float mxf[16];
+    for (size_t i = 0; i < instance_count; ++i) {
+        transforms[i].get(mxd, Matrix2::COLUMN_MAJOR);
+        for (std::size_t j = 0u; j < 16u; j++)
+            mxf[j] = static_cast<float>(mxd[j]);
+        this->raw_.insert(this->raw_.end(), reinterpret_cast<const uint8_t*>(mxf),
+            reinterpret_cast<const uint8_t*>(mxf) + sizeof(mxf));
+    }
+
+    return raw_offset;
+}
+
+TAKErr GLBatchBuilder::prepareForDraw(bool instanced) NOTHROWS {
 
     TAKErr code = TE_Ok;
 
@@ -411,6 +582,15 @@ TAKErr GLBatchBuilder::prepareForDraw() NOTHROWS {
             return code;
     }
 
+    // select the instanced or non-instanced variant of the current shader to match the draw
+    if (this->shader_index_ < this->shaders_.size() && this->shaders_[this->shader_index_].attrs.instanced != instanced) {
+        RenderAttributes attrs(this->shaders_[this->shader_index_].attrs);
+        attrs.instanced = instanced;
+        code = this->setShader(nullptr, attrs);
+        if (code != TE_Ok)
+            return code;
+    }
+
     // if shader switch, everything else must follow
     if (this->shader_dirty_) {
         this->lf_dirty_ = true;
@@ -618,6 +798,15 @@ TAKErr GLBatch::execute(RenderState& state, const Matrix2& forwardTransform, con
 
     const bool support_shader_swaps = (feature_bits & GLBatch::SHADER_OVERRIDE_BIT) == 0;
 
+    // the most recently applied model-view; instances drawn individually are composited against it
+    float model_view[16];
+    {
+        double mxd[16];
+        forwardTransform.get(mxd, Matrix2::COLUMN_MAJOR);
+        for (std::size_t i = 0u; i < 16u; i++)
+            model_view[i] = static_cast<float>(mxd[i]);
+    }
+
     GLenum front_face = GL_CCW;
     if (front_face != GL_NONE) {
         if (state.cull.face != GL_BACK) {
@@ -764,6 +953,7 @@ TAKErr GLBatch::execute(RenderState& state, const Matrix2& forwardTransform, con
 #endif
 
                 glUniformMatrix4fv(state.shader->uModelView, 1, false, mv);
+                memcpy(model_view, mv, sizeof(mv));
             }
                 break;
 
@@ -794,8 +984,10 @@ TAKErr GLBatch::execute(RenderState& state, const Matrix2& forwardTransform, con
                 instr = *ip++;
                 const GLsizei num_verts = instr;
                 const GLsizei vertRenderLimit = (3 * 0xFFFF);
-                for (GLint i = 0; i < num_verts; i += vertRenderLimit)
+                for (GLint i = 0; i < num_verts; i += vertRenderLimit) {
                     glDrawArrays(draw_mode, i, std::min(vertRenderLimit, num_verts - i));
+                    GLPerformanceCounters_draw(draw_mode, std::min(vertRenderLimit, num_verts - i));
+                }
             }
                 break;
             case OP_DRAWE_: {
@@ -803,8 +995,19 @@ TAKErr GLBatch::execute(RenderState& state, const Matrix2& forwardTransform, con
                 size_t buffer_index = (instr >> (OPERAND_SHIFT_)) & 0xff;
                 instr = *ip++;
                 GLsizei index_count = instr;
-                glDrawElements(draw_mode, index_count, GL_UNSIGNED_SHORT,
-                    this->buffer_begin_()[buffer_index]->u.ptr);
+                drawGeometry(draw_mode, index_count, this->buffer_begin_()[buffer_index].get(), 0);
+            }
+                break;
+            case OP_DRAWAI_:
+            case OP_DRAWEI_: {
+                const GLenum draw_mode = instr >> (OPERAND_SHIFT_ + 8);
+                const GLBatch::Buffer* indices = ((instr & OP_MASK_) == OP_DRAWEI_) ?
+                    this->buffer_begin_()[(instr >> OPERAND_SHIFT_) & 0xff].get() : nullptr;
+                const GLsizei count = static_cast<GLsizei>(*ip++);
+                const GLsizei instance_count = static_cast<GLsizei>(*ip++);
+                const float* transforms = reinterpret_cast<const float*>(this->raw_begin_() + *ip++);
+                drawInstances(bound_array_buffer, *state.shader, model_view,
+                    draw_mode, count, indices, transforms, instance_count);
             }
                 break;
             default:
@@ -273,6 +273,31 @@ namespace TAK {
                      */
                     Util::TAKErr drawElements(GLenum draw_mode, size_t index_count, size_t buffer_index) NOTHROWS;
 
+                    /**
+                     * Add an instanced draw arrays call. The geometry is drawn once per
+                     * transform, with each transform applied after the current local
+                     * frame. The draw uses the instanced variant of the current shader;
+                     * where hardware instancing is unavailable, the instances are drawn
+                     * individually.
+                     *
+                     * @param draw_mode (GL_TRIANGLES, GL_POINTS, etc...)
+                     * @param vert_count the number of verts per instance
+                     * @param transforms the per-instance transforms
+                     * @param instance_count the number of transforms
+                     */
+                    Util::TAKErr drawArraysInstanced(GLenum draw_mode, size_t vert_count, const TAK::Engine::Math::Matrix2* transforms, size_t instance_count) NOTHROWS;
+
+                    /**
+                     * Add an instanced draw elements call. See drawArraysInstanced.
+                     *
+                     * @param draw_mode (GL_TRIANGLES, GL_POINTS, etc...)
+                     * @param index_count the number of indices per instance
+                     * @param buffer_index the buffer index for the buffer containing the indices
+                     * @param transforms the per-instance transforms
+                     * @param instance_count the number of transforms
+                     */
+                    Util::TAKErr drawElementsInstanced(GLenum draw_mode, size_t index_count, size_t buffer_index, const TAK::Engine::Math::Matrix2* transforms, size_t instance_count) NOTHROWS;
+
                     /**
                      * Create the GLBatch for the current state
                      */
@@ -299,7 +324,8 @@ namespace TAK {
                     inline size_t bufferCount() const NOTHROWS { return buffers_.size(); }
 
                 private:
-                    Util::TAKErr prepareForDraw() NOTHROWS;
+                    Util::TAKErr prepareForDraw(bool instanced = false) NOTHROWS;
+                    size_t appendInstanceTransforms(const TAK::Engine::Math::Matrix2* transforms, size_t instance_count) NOTHROWS;
                     GLBatch* createBatch() NOTHROWS;
 
                     struct ShaderFrame_ {
@@ -1,5 +1,10 @@
 
 #include "renderer/model/GLC3DTRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
 #include "renderer/GLWorkers.h"
 #include "util/Tasking.h"
 #include "formats/cesium3dtiles/C3DTTileset.h"
@@ -16,11 +21,14 @@
 #include "math/Rectangle2.h"
 #include "util/MathUtils.h"
 #include "renderer/core/GLContent.h"
+#include "renderer/core/GLTerrainOcclusion.h"
 #include "math/Frustum2.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "renderer/GLPerformanceCounters.h"
 #include "renderer/model/SceneObjectControl.h"
 #include "util/URIOfflineCache.h"
 #include "util/ConfigOptions.h"
+#include "util/WorkerRegistry.h"
 #include "renderer/core/GLContent.h"
 
 /*
@@ -63,6 +71,13 @@ namespace {
     constexpr size_t loadingDescendantLimit = 20;
     constexpr bool forbidHoles = true;
     static size_t load_count = 0;
+    // bounds on the content loads each tileset has in flight
+    constexpr std::size_t maxInFlightLoads = 8u;
+    constexpr int64_t maxInFlightBytes = 32 * 1024 * 1024;
+    // assumed content size until a tileset has fetched some
+    constexpr int64_t defaultContentBytes = 1024 * 1024;
+    // levels of a tileset.json parsed per pass; deeper subtrees are parsed once traversed
+    constexpr std::size_t eagerParseDepth = 4u;
 
     int64_t getConfiguredCacheSizeLimit() NOTHROWS;
     int64_t getConfiguredCacheDurationSeconds() NOTHROWS;
@@ -101,6 +116,20 @@ namespace {
         bool canceled = false;
     };
 
+    /**
+     * Sizes of the content fetched through a tileset's loader. Content size is not known until
+     * it is fetched, so the in-flight byte budget is applied to the running average.
+     */
+    struct LoadStats {
+        std::atomic<int64_t> bytes{ 0 };
+        std::atomic<int64_t> count{ 0 };
+
+        int64_t estimate() const NOTHROWS {
+            const int64_t n = count.load(std::memory_order_relaxed);
+            return n ? std::max<int64_t>(bytes.load(std::memory_order_relaxed) / n, 1) : defaultContentBytes;
+        }
+    };
+
     struct UpdateChanges {
         std::vector<GLC3DTTile*> visible_list;
         std::vector<GLC3DTTile*> unload_list;
@@ -118,17 +147,26 @@ namespace {
     };
 
     struct CameraInfo {
-        CameraInfo(const MapSceneModel2& scene)
+        CameraInfo(const MapSceneModel2& scene, const std::shared_ptr<const TerrainOcclusion>& occlusion_, bool occlusionCurrent_)
             : frustum(scene.camera.projection, scene.camera.modelView),
             position(scene.camera.location),
+            target(scene.camera.target),
             sseDenom(tan(0.5 * scene.camera.fov * M_PI / 180.0) * 2.0),
-            viewportHeight((double)scene.height)
+            viewportHeight((double)scene.height),
+            occlusion(occlusion_),
+            occlusionCurrent(occlusionCurrent_)
         {}
 
         Frustum2 frustum;
         Point2<double> position;
+        // the view center
+        Point2<double> target;
         double sseDenom;
         double viewportHeight;
+        // terrain depth capture; may be null
+        std::shared_ptr<const TerrainOcclusion> occlusion;
+        // whether `occlusion` was captured from this camera
+        bool occlusionCurrent;
     };
 
     
@@ -156,7 +194,10 @@ namespace {
 
         void draw(const GLGlobeBase& view, const int renderPass, GLContentContext& content_context) NOTHROWS;
         void drawAABB(const GLGlobeBase& view);
-        void startLoad() NOTHROWS;
+        /**
+         * @return true if a load was started
+         */
+        bool startLoad() NOTHROWS;
         void unload() NOTHROWS;
 
         TAKErr gatherDepthSamplerDrawables(std::vector<GLDepthSamplerDrawable*>& result, int levelDepth, const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y) NOTHROWS;
@@ -174,6 +215,8 @@ namespace {
         //std::vector<GLC3DTTile*> children_;
         GLC3DTTile* first_child_;
         GLC3DTTile* last_child_;
+        // children that have not been parsed; `first_child_` has room for them
+        std::shared_ptr<const C3DTSubtree> unparsed_children_;
         GLContentHolder content_;
 
         Matrix2 transform_;
@@ -187,6 +230,11 @@ namespace {
 
         bool isRenderable() const NOTHROWS;
         double calcSSE(const CameraInfo& camera) const NOTHROWS;
+        /**
+         * The SSE, discounted by the distance from the view center relative to the distance from
+         * the camera. Higher values load first.
+         */
+        double loadPriority(const CameraInfo& camera) const NOTHROWS;
 
         inline State getState(uint64_t frame) const {
             if (last_state_frame_ == frame)
@@ -316,6 +364,8 @@ namespace {
         virtual void setParentRenderer(GLC3DTRenderer* renderer) NOTHROWS;
 
         C3DTAllocator allocator_; // allocator must come first
+        // guards `allocator_` while subtrees are expanded by the view update
+        Mutex expand_mutex_;
 
         // Non-transient state
         GLC3DTRenderer* renderer_;
@@ -327,9 +377,14 @@ namespace {
         // Only touched by the GLThread
         GLContentContext content_context_;
         MapCamera2 current_camera_;
+        std::shared_ptr<const TerrainOcclusion> current_occlusion_;
         std::unique_ptr<UpdateChanges> front_state_;
         std::unique_ptr<UpdateChanges> recycle_state_;
         Future<bool> update_task_;
+        // loads not yet started, in priority order; replaced on each view update
+        std::vector<GLC3DTTile*> load_queue_;
+        std::vector<GLC3DTTile*> loading_;
+        std::shared_ptr<LoadStats> load_stats_;
 
         // Only touched by the view update worker
         uint64_t pending_view_update_number_;
@@ -341,17 +396,39 @@ namespace {
             GLC3DTTileset* ts, 
             uint64_t update_number,
             const MapSceneModel2& sceneModel,
+            const std::shared_ptr<const TerrainOcclusion>& occlusion,
+            bool occlusionCurrent,
             std::unique_ptr<UpdateChanges>& recycle) NOTHROWS;
         static TAKErr receiveUpdateTask(bool&, std::unique_ptr<UpdateChanges>& result, GLC3DTTileset* ts) NOTHROWS;
+        /**
+         * Retires finished loads and starts queued loads while within the in-flight budget.
+         * 
+         * NOTE: Only call on the GLThread
+         */
+        void pumpLoads() NOTHROWS;
         bool updateView(const CameraInfo& camera, uint64_t update_number) NOTHROWS;
         UpdateResult updateTileIfVisible(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number) NOTHROWS;
-        UpdateResult updateTile(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number) NOTHROWS;
+        /**
+         * @param changes   receives the changes for the tile's subtree
+         * @param fanOut    if `true`, the subtrees of the first tile with multiple children are
+         *                  traversed concurrently
+         */
+        UpdateResult updateTile(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges& changes, bool fanOut) NOTHROWS;
+        UpdateResult updateChild(GLC3DTTile& child, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges& changes, bool fanOut) NOTHROWS;
+        UpdateResult updateChildrenConcurrent(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges& changes) NOTHROWS;
+        static TAKErr updateChildTask(UpdateResult& result, GLC3DTTileset* ts, GLC3DTTile* child, const CameraInfo* camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges* changes) NOTHROWS;
+        /**
+         * Parses the tile's deferred children, if any.
+         *
+         * NOTE: Only call from the view update
+         */
+        void expandChildren(GLC3DTTile& tile) NOTHROWS;
 
         UpdateResult updateChildren(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number) NOTHROWS;
         void markTileNonRendered(GLC3DTTile& tile) NOTHROWS;
         void markChildrenNonRendered(GLC3DTTile& tile) NOTHROWS;
 
-        void unloadRenderedChildren(GLC3DTTile& tile) NOTHROWS;
+        void unloadRenderedChildren(GLC3DTTile& tile, UpdateChanges& changes) NOTHROWS;
     };
 
     struct TilesetParser {
@@ -362,6 +439,11 @@ namespace {
         };
         
         TilesetParser(TAK::Engine::Core::RenderContext& ctx, const char* URI, std::shared_ptr<GLContentContext::Loader> loader);
+        /**
+         * Parses deferred children into an existing tile. `parentTile` is the tile passed to
+         * `C3DTTileset_parseChildren`.
+         */
+        TilesetParser(GLC3DTTile& parent, const C3DTTile& parentTile);
 
         inline GLC3DTTile* parent() {
             return stack.size() ? stack.back().glTile : nullptr;
@@ -371,6 +453,7 @@ namespace {
         static TAKErr visitor(void* opaque, const C3DTTileset* tileset, const C3DTTile* tile);
 
         std::unique_ptr<GLC3DTTileset> tileset;
+        GLC3DTTileset* target;
         std::vector<Frame_> stack;
     };
 
@@ -383,9 +466,9 @@ namespace {
         std::shared_ptr<const Mesh> mesh;
     };
 
-    const SharedWorkerPtr createPoolLoadWorker() {
+    const SharedWorkerPtr createPoolLoadWorker(const WorkerClass cls, const char *name) {
         SharedWorkerPtr worker;
-        Worker_createThreadPool(worker, 0, 4, 60 * 1000);
+        WorkerRegistry_borrow(worker, cls, name, 4u);
         return worker;
     }
 
@@ -399,7 +482,7 @@ namespace {
 #if 0
         return GeneralWorkers_flex();
 #else
-        static SharedWorkerPtr inst(createPoolLoadWorker());
+        static SharedWorkerPtr inst(createPoolLoadWorker(TEWC_IO, "c3dt-tileset-load"));
         return inst;
 #endif
     }
@@ -408,9 +491,8 @@ namespace {
 #if 0
         return GeneralWorkers_flex();
 #else
-        // could tileset load and texture load share a pool???
-        // XXX-- experiment with optimal config as a TODO
-        static SharedWorkerPtr inst(createPoolLoadWorker());
+        // tileset load and texture load share threads through the worker registry
+        static SharedWorkerPtr inst(createPoolLoadWorker(TEWC_CPUDecode, "c3dt-texture-load"));
         return inst;
 #endif
     }
@@ -450,7 +532,8 @@ public:
     explicit LoaderImpl(TAK::Engine::Core::RenderContext& ctx, std::shared_ptr<URIOfflineCache> cache) NOTHROWS
         : cache_(cache),
         parent_mm(std::make_shared<MaterialManager>(ctx, MaterialManager::TextureLoaderPtr(this, Memory_leaker_const<MaterialManager::TextureLoader>))),
-        cache_dur_sec_(getConfiguredCacheDurationSeconds())
+        cache_dur_sec_(getConfiguredCacheDurationSeconds()),
+        load_stats_(std::make_shared<LoadStats>())
     {}
 
     virtual ~LoaderImpl() NOTHROWS {}
@@ -473,6 +556,8 @@ public:
     std::shared_ptr<MaterialManager> parent_mm;
     std::shared_ptr<URIOfflineCache> cache_;
     int64_t cache_dur_sec_;
+    // sizes of the content fetched through this loader
+    std::shared_ptr<LoadStats> load_stats_;
 
     TAK::Engine::Thread::Mutex mutex_;
     std::unordered_map<std::string, std::weak_ptr<GLBatch::Texture>> resident_textures_;
@@ -761,6 +846,7 @@ namespace {
     GLC3DTTileset::GLC3DTTileset(TAK::Engine::Core::RenderContext& ctx, const char* baseURI, std::shared_ptr<GLContentContext::Loader> loader)
         : base_uri_(baseURI),
         content_context_(ctx, tilesetLoadWorker(), loader),
+        load_stats_(std::make_shared<LoadStats>()),
         last_completed_frame_num_(0),
         pending_view_update_number_(0) {
 
@@ -790,12 +876,14 @@ namespace {
     TAKErr GLC3DTTileset::updateViewTask(std::unique_ptr<UpdateChanges>& result, GLC3DTTileset* ts, 
         uint64_t update_number,
         const MapSceneModel2& sceneModel,
+        const std::shared_ptr<const TerrainOcclusion>& occlusion,
+        bool occlusionCurrent,
         std::unique_ptr<UpdateChanges>& recycle) NOTHROWS {
 
         if (recycle)
             ts->pending_state_ = std::move(recycle);
 
-        CameraInfo camera(sceneModel);
+        CameraInfo camera(sceneModel, occlusion, occlusionCurrent);
         bool complete = ts->updateView(camera, update_number);
         if (complete) {
 
@@ -819,15 +907,16 @@ namespace {
             ts->recycle_state_ = std::move(ts->front_state_);
             ts->front_state_ = std::move(result);
 
-            // do loads/unloads
+            // do unloads, canceling any loads in flight
             for (GLC3DTTile* tile : ts->front_state_->unload_list)
                 tile->unload();
-            for (GLC3DTTile* tile : ts->front_state_->high_priority_load)
-                tile->startLoad();
-            for (GLC3DTTile* tile : ts->front_state_->medium_priority_load)
-                tile->startLoad();
-            for (GLC3DTTile* tile : ts->front_state_->low_priority_load)
-                tile->startLoad();
+
+            // requeue; tiles that dropped out of the traversal are never started
+            ts->load_queue_.clear();
+            ts->load_queue_.insert(ts->load_queue_.end(), ts->front_state_->high_priority_load.begin(), ts->front_state_->high_priority_load.end());
+            ts->load_queue_.insert(ts->load_queue_.end(), ts->front_state_->medium_priority_load.begin(), ts->front_state_->medium_priority_load.end());
+            ts->load_queue_.insert(ts->load_queue_.end(), ts->front_state_->low_priority_load.begin(), ts->front_state_->low_priority_load.end());
+            ts->pumpLoads();
 
             changed = true;
         }
@@ -835,6 +924,24 @@ namespace {
         return TE_Ok;
     }
 
+    void GLC3DTTileset::pumpLoads() NOTHROWS {
+        // retire loads that completed, failed or were canceled
+        loading_.erase(std::remove_if(loading_.begin(), loading_.end(), [](const GLC3DTTile* tile) {
+            return tile->content_.getLoadState() != GLContentHolder::LOADING;
+        }), loading_.end());
+
+        const std::size_t budget = static_cast<std::size_t>(maxInFlightBytes / load_stats_->estimate());
+        const std::size_t limit = std::max<std::size_t>(1u, std::min(maxInFlightLoads, budget));
+
+        std::size_t next = 0u;
+        while (next < load_queue_.size() && loading_.size() < limit) {
+            GLC3DTTile* tile = load_queue_[next++];
+            if (tile->startLoad())
+                loading_.push_back(tile);
+        }
+        load_queue_.erase(load_queue_.begin(), load_queue_.begin() + next);
+    }
+
     void GLC3DTTileset::setParentTile(const GLC3DTTile* parent) NOTHROWS {
         // content should always have parent, but check anyway
         if (parent) {
@@ -851,6 +958,22 @@ namespace {
         }
     }
 
+    AABB tileAABB(const GLC3DTTile& tile) NOTHROWS;
+
+    void sortByLoadPriority(std::vector<GLC3DTTile*>& tiles, const CameraInfo& camera) NOTHROWS {
+        if (tiles.size() < 2u)
+            return;
+        std::vector<std::pair<double, GLC3DTTile*>> keyed;
+        keyed.reserve(tiles.size());
+        for (GLC3DTTile* tile : tiles)
+            keyed.push_back(std::make_pair(tile->loadPriority(camera), tile));
+        std::stable_sort(keyed.begin(), keyed.end(), [](const std::pair<double, GLC3DTTile*>& a, const std::pair<double, GLC3DTTile*>& b) {
+            return a.first > b.first;
+        });
+        for (std::size_t i = 0u; i < keyed.size(); i++)
+            tiles[i] = keyed[i].second;
+    }
+
     bool GLC3DTTileset::updateView(const CameraInfo& camera, uint64_t update_number) NOTHROWS {
 
         if (!root_tile_)
@@ -865,18 +988,34 @@ namespace {
         if (!result.canceled) {
             this->last_completed_frame_num_++;
 
+            std::size_t numDrawn = 0u;
             for (auto tile : this->pending_state_->visible_list) {
+                // tiles behind the terrain are loaded last; they are only
+                // withheld from draw once the capture matches the camera
+                const bool occluded = camera.occlusion && camera.occlusion->isOccluded(tileAABB(*tile));
+
                 // mark for needing load or verified as loaded
                 if (tile->getState(this->last_completed_frame_num_ - 1) != GLC3DTTile::RENDERED) {
-                    this->pending_state_->medium_priority_load.push_back(tile);
+                    if (occluded)
+                        this->pending_state_->low_priority_load.push_back(tile);
+                    else
+                        this->pending_state_->medium_priority_load.push_back(tile);
                 }
                 tile->setState(GLC3DTTile::RENDERED, this->last_completed_frame_num_);
+
+                if (!occluded || !camera.occlusionCurrent)
+                    this->pending_state_->visible_list[numDrawn++] = tile;
             }
+            this->pending_state_->visible_list.resize(numDrawn);
 
             for (auto tile : this->pending_state_->unload_list) {
                 tile->setState(GLC3DTTile::CULLED, this->last_completed_frame_num_);
             }
 
+            sortByLoadPriority(this->pending_state_->high_priority_load, camera);
+            sortByLoadPriority(this->pending_state_->medium_priority_load, camera);
+            sortByLoadPriority(this->pending_state_->low_priority_load, camera);
+
 #if C3DT_RENDERER_DEBUG_OUTPUT
             const char* lines =
                 "\n"
@@ -917,11 +1056,10 @@ namespace {
         return !result.canceled;
     }
 
-    bool testTileVisibility(const Frustum2& frustum, const GLC3DTTile& tile) NOTHROWS {
-
+    AABB tileAABB(const GLC3DTTile& tile) NOTHROWS {
         // this is calculated as AABB currently
         C3DTBox box = tile.boundingVolume_.object.region_aux.aux.boundingBox;
-        AABB mbb(
+        return AABB(
             Point2<double>(box.center.x - box.xDirHalfLen.x,
                 box.center.y - box.yDirHalfLen.y,
                 box.center.z - box.zDirHalfLen.z),
@@ -929,14 +1067,16 @@ namespace {
                 box.center.y + box.yDirHalfLen.y,
                 box.center.z + box.zDirHalfLen.z)
         );
+    }
 
-        return const_cast<TAK::Engine::Math::Frustum2&>(frustum).intersects(mbb);
+    bool testTileVisibility(const Frustum2& frustum, const GLC3DTTile& tile) NOTHROWS {
+        return const_cast<TAK::Engine::Math::Frustum2&>(frustum).intersects(tileAABB(tile));
     }
 
     UpdateResult GLC3DTTileset::updateTileIfVisible(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number) NOTHROWS {
         bool vis = testTileVisibility(const_cast<Frustum2&>(camera.frustum), tile);
         if (vis) {
-            return updateTile(tile, camera, ancestorMeetsSse, update_number);
+            return updateTile(tile, camera, ancestorMeetsSse, update_number, *this->pending_state_, true);
         } else {
             markTileNonRendered(tile);
             markChildrenNonRendered(tile);
@@ -949,6 +1089,10 @@ namespace {
 
         --load_count;
 
+        // a slot is free
+        if (parentTile)
+            parentTile->tileset_->pumpLoads();
+
         // nothing to do
         if (!input)
             return TE_Ok;
@@ -991,7 +1135,7 @@ namespace {
         }
     }
 
-    UpdateResult GLC3DTTileset::updateTile(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number) NOTHROWS {
+    UpdateResult GLC3DTTileset::updateTile(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges& changes, bool fanOut) NOTHROWS {
 
         // check for cancel
         if (this->updateIsCanceled(update_number)) {
@@ -1021,32 +1165,29 @@ namespace {
 
         if (proceed) {
 
-            size_t tileIndex = this->pending_state_->visible_list.size();
+            size_t tileIndex = changes.visible_list.size();
             bool addedTile = false;
             if (tile.hasPossibleContent()) {
-                this->pending_state_->visible_list.push_back(&tile);
+                changes.visible_list.push_back(&tile);
                 addedTile = true;
             }
 
+            if (tile.unparsed_children_)
+                expandChildren(tile);
+
             UpdateResult childrenResult;
             size_t numChildren = tile.childCount();
-            for (size_t i = 0; i < numChildren; ++i) {
-                GLC3DTTile& child = tile.first_child_[i];
-                if (testTileVisibility(camera.frustum, child)) {
-                    UpdateResult childResult = updateTile(child, camera, sseOK, update_number);
+            if (fanOut && numChildren > 1u) {
+                childrenResult = updateChildrenConcurrent(tile, camera, sseOK, update_number, changes);
+            } else {
+                for (size_t i = 0; i < numChildren; ++i) {
+                    UpdateResult childResult = updateChild(tile.first_child_[i], camera, sseOK, update_number, changes, fanOut);
                     childrenResult.allRenderable &= childResult.allRenderable;
                     childrenResult.canceled = childResult.canceled;
                     childrenResult.notYetRenderableCount += childResult.notYetRenderableCount;
                     childrenResult.anyRenderedPreviously |= childResult.anyRenderedPreviously;
                     if (childrenResult.canceled)
                         break;
-                } else {
-                    childrenResult.allRenderable = false;
-                    if (child.getState(this->last_completed_frame_num_) == GLC3DTTile::RENDERED) {
-                        // this tile is no longer visible-- move towards unloading
-                        this->pending_state_->unload_list.push_back(&child);
-                        unloadRenderedChildren(child);
-                    }
                 }
             }
 
@@ -1064,11 +1205,11 @@ namespace {
 
                     // unload it too if previously rendered-- no longer needed
                     if (lastTileState == GLC3DTTile::RENDERED) {
-                        this->pending_state_->unload_list.push_back(&tile);
+                        changes.unload_list.push_back(&tile);
                     }
 
-                    this->pending_state_->visible_list.erase(
-                        this->pending_state_->visible_list.begin() + tileIndex);
+                    changes.visible_list.erase(
+                        changes.visible_list.begin() + tileIndex);
                 }
             }
         }
@@ -1076,13 +1217,80 @@ namespace {
         return result;
     }
 
-    void GLC3DTTileset::unloadRenderedChildren(GLC3DTTile& tile) NOTHROWS {
+    UpdateResult GLC3DTTileset::updateChild(GLC3DTTile& child, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges& changes, bool fanOut) NOTHROWS {
+        if (testTileVisibility(camera.frustum, child))
+            return updateTile(child, camera, ancestorMeetsSse, update_number, changes, fanOut);
+
+        if (child.getState(this->last_completed_frame_num_) == GLC3DTTile::RENDERED) {
+            // this tile is no longer visible-- move towards unloading
+            changes.unload_list.push_back(&child);
+            unloadRenderedChildren(child, changes);
+        }
+        UpdateResult result;
+        result.allRenderable = false;
+        return result;
+    }
+
+    UpdateResult GLC3DTTileset::updateChildrenConcurrent(GLC3DTTile& tile, const CameraInfo& camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges& changes) NOTHROWS {
+        const size_t numChildren = tile.childCount();
+
+        // each subtree is traversed into its own changes; they are merged in child order so
+        // that the frame matches a serial traversal
+        std::vector<UpdateChanges> subtreeChanges(numChildren);
+        std::vector<UpdateResult> subtreeResults(numChildren);
+        std::vector<Future<UpdateResult>> subtrees;
+        subtrees.reserve(numChildren - 1u);
+        for (size_t i = 1u; i < numChildren; ++i)
+            subtrees.push_back(Task_begin(GeneralWorkers_cpu(), updateChildTask, this, &tile.first_child_[i], &camera, ancestorMeetsSse, update_number, &subtreeChanges[i]));
+        // the first subtree is traversed on this thread
+        updateChildTask(subtreeResults[0], this, &tile.first_child_[0], &camera, ancestorMeetsSse, update_number, &subtreeChanges[0]);
+        for (size_t i = 1u; i < numChildren; ++i) {
+            TAKErr code = TE_Ok;
+            if (subtrees[i - 1u].await(subtreeResults[i], code) != TE_Ok || code != TE_Ok)
+                subtreeResults[i].canceled = true;
+        }
+
+        UpdateResult result;
+        for (size_t i = 0; i < numChildren; ++i) {
+            result.allRenderable &= subtreeResults[i].allRenderable;
+            result.canceled |= subtreeResults[i].canceled;
+            result.notYetRenderableCount += subtreeResults[i].notYetRenderableCount;
+            result.anyRenderedPreviously |= subtreeResults[i].anyRenderedPreviously;
+
+            const UpdateChanges& subtree = subtreeChanges[i];
+            changes.visible_list.insert(changes.visible_list.end(), subtree.visible_list.begin(), subtree.visible_list.end());
+            changes.unload_list.insert(changes.unload_list.end(), subtree.unload_list.begin(), subtree.unload_list.end());
+        }
+        return result;
+    }
+
+    TAKErr GLC3DTTileset::updateChildTask(UpdateResult& result, GLC3DTTileset* ts, GLC3DTTile* child, const CameraInfo* camera, bool ancestorMeetsSse, uint64_t update_number, UpdateChanges* changes) NOTHROWS {
+        result = ts->updateChild(*child, *camera, ancestorMeetsSse, update_number, *changes, false);
+        return TE_Ok;
+    }
+
+    void GLC3DTTileset::expandChildren(GLC3DTTile& tile) NOTHROWS {
+        std::shared_ptr<const C3DTSubtree> subtree(std::move(tile.unparsed_children_));
+
+        C3DTTile parentTile;
+        parentTile.refine = tile.getRefine();
+        parentTile.unparsedChildren = subtree;
+
+        // the children are constructed in the slots reserved when the tile was parsed
+        Lock lock(expand_mutex_);
+        TilesetParser args(tile, parentTile);
+        TAKErr code = C3DTTileset_parseChildren(parentTile, base_uri_, &args, TilesetParser::visitor);
+        if (code != TE_Ok)
+            Logger_log(TELL_Warning, "GLC3DTRenderer: failed to parse subtree of %s", base_uri_.get());
+    }
+
+    void GLC3DTTileset::unloadRenderedChildren(GLC3DTTile& tile, UpdateChanges& changes) NOTHROWS {
         size_t numChildren = tile.childCount();
         for (size_t i = 0; i < numChildren; ++i) {
             GLC3DTTile& child = tile.first_child_[i];
             if (child.getState(this->last_completed_frame_num_) == GLC3DTTile::RENDERED) {
-                this->pending_state_->unload_list.push_back(&child);
-                unloadRenderedChildren(child);
+                changes.unload_list.push_back(&child);
+                unloadRenderedChildren(child, changes);
             }
         }
     }
@@ -1248,17 +1456,28 @@ namespace {
 
     void GLC3DTTileset::draw(const GLGlobeBase& view, const int renderPass) NOTHROWS {
 
+        std::shared_ptr<const TerrainOcclusion> occlusion = view.getTerrainOcclusion();
+        const bool occlusionCurrent = occlusion && occlusion->isCurrent(view.renderPass->scene);
+
+        // a capture matching the camera arrives after the camera settles;
+        // update again so that occluded tiles are withheld from draw
         if (current_camera_.location != view.renderPass->scene.camera.location ||
-            current_camera_.target != view.renderPass->scene.camera.target) {
+            current_camera_.target != view.renderPass->scene.camera.target ||
+            (occlusionCurrent && occlusion != current_occlusion_)) {
 
             current_camera_ = view.renderPass->scene.camera;
+            current_occlusion_ = occlusion;
 
             // Switch to the next view update
             this->pending_view_update_number_++;
-            this->update_task_ = Task_begin(this->view_update_worker_, updateViewTask, this, this->pending_view_update_number_, view.renderPass->scene, std::move(this->recycle_state_))
+            this->update_task_ = Task_begin(this->view_update_worker_, updateViewTask, this, this->pending_view_update_number_, view.renderPass->scene, occlusion, occlusionCurrent, std::move(this->recycle_state_))
                 .thenOn(GLWorkers_glThread(), receiveUpdateTask, this);
         }
 
+        // failed loads do not signal; retire them here
+        if (!this->load_queue_.empty())
+            this->pumpLoads();
+
         if (this->front_state_) {
             for (GLC3DTTile* tile : this->front_state_->visible_list)
                 tile->draw(view, renderPass, content_context_);
@@ -1287,6 +1506,7 @@ namespace {
         
         first_child_ = tileset->allocator_.allocTiles(tile.childCount);
         last_child_ = first_child_;
+        unparsed_children_ = tile.unparsedChildren;
 
         // pre-calculate aux for region
         if (boundingVolume_.type == C3DTVolume::Region) {
@@ -1332,7 +1552,7 @@ namespace {
 
 
         if (!wireframe_shader_.get()) {
-            Shader_get(wireframe_shader_, view.context, RenderAttributes());
+            wireframe_shader_ = Shader_get<TESF_None>(view.context);
         }
 
         glUseProgram(wireframe_shader_->handle);
@@ -1408,6 +1628,7 @@ namespace {
         glVertexAttribPointer(wireframe_shader_->aVertexCoords, 3, GL_FLOAT, false, stride, verts);
         glUniform4f(this->wireframe_shader_->uColor, 0.6f, 0.0f, 0.0f, 1.0f);
         glDrawArrays(GL_LINES, 0, count);
+        GLPerformanceCounters_draw(GL_LINES, count);
         glDisableVertexAttribArray(this->wireframe_shader_->aVertexCoords);
     }
 
@@ -1422,20 +1643,30 @@ namespace {
         return (geometric_error_ * camera.viewportHeight) / (std::max(dist, 1e-7) * camera.sseDenom);
     }
 
-    void GLC3DTTile::startLoad() NOTHROWS {
+    double GLC3DTTile::loadPriority(const CameraInfo& camera) const NOTHROWS {
+        double toCamera = 0;
+        double toCenter = 0;
+        C3DTVolume_distanceSquaredToPosition(&toCamera, boundingVolume_, camera.position);
+        C3DTVolume_distanceSquaredToPosition(&toCenter, boundingVolume_, camera.target);
+        return calcSSE(camera) / (1.0 + sqrt(toCenter / std::max(toCamera, 1e-7)));
+    }
+
+    bool GLC3DTTile::startLoad() NOTHROWS {
         GLContentHolder::LoadState loadState = content_.getLoadState();
         if (loadState == GLContentHolder::EMPTY && this->content_uri_.get()) {
             String fullURI;
             TAKErr code = URI_combine(&fullURI, tileset_->base_uri_, content_uri_);
             if (code != TE_Ok)
-                return;
+                return false;
             ++load_count;
             content_.load(tileset_->content_context_, fullURI)
                 // GeneralWorkers_immediate() will invoke on the worker it completes on (no scheduling to a queue).
                 // In this case that is the GLThread right after GLContentHolder is updated, and before it has ever had
                 // a chance to draw.
                 .thenOn(GeneralWorkers_immediate(), contentDidLoadTask, this);
+            return true;
         }
+        return false;
     }
 
     void GLC3DTTile::unload() NOTHROWS {
@@ -1487,8 +1718,15 @@ namespace {
     //
 
     TilesetParser::TilesetParser(TAK::Engine::Core::RenderContext& ctx, const char* URI, std::shared_ptr<GLContentContext::Loader> loader)
-        : tileset(new GLC3DTTileset(ctx, URI, loader)) {
+        : tileset(new GLC3DTTileset(ctx, URI, loader)),
+        target(tileset.get()) {
+        stack.reserve(24);
+    }
+
+    TilesetParser::TilesetParser(GLC3DTTile& parent, const C3DTTile& parentTile)
+        : target(parent.tileset_) {
         stack.reserve(24);
+        stack.push_back({ &parent, &parentTile });
     }
 
     TAKErr TilesetParser::handle(const C3DTTile& tile) {
@@ -1500,11 +1738,11 @@ namespace {
 
         GLC3DTTile* par = parent();
         GLC3DTTile* glTile = nullptr;
-        if (!tileset->root_tile_) {
-            tileset->root_tile_.reset(new GLC3DTTile(tileset.get(), tile, par));
-            glTile = tileset->root_tile_.get();
+        if (!target->root_tile_) {
+            target->root_tile_.reset(new GLC3DTTile(target, tile, par));
+            glTile = target->root_tile_.get();
         } else if (par) {
-            ::new(static_cast<void*>(par->last_child_)) GLC3DTTile(tileset.get(), tile, par);
+            ::new(static_cast<void*>(par->last_child_)) GLC3DTTile(target, tile, par);
             glTile = par->last_child_;
             ++par->last_child_;
         }
@@ -1733,6 +1971,24 @@ namespace {
 
         RenderContext& cxt;
     };
+
+    /**
+     * A unique mesh within a B3DM and the local frames of every child node that references identical geometry. The
+     * vertex, index and texture resources are shared across all instances.
+     */
+    struct B3DMMeshDraw {
+        std::shared_ptr<const Mesh> mesh;
+        std::size_t hash;
+        VertexStreamConfig streams[3];
+        size_t num_streams;
+        GLBatch::TexturePtr textures[GLBatchBuilder::MAX_TEXTURE_SLOTS];
+        size_t num_textures;
+        GLenum draw_mode;
+        size_t count;
+        size_t index_buffer_index;
+        std::vector<Matrix2> instances;
+        bool transformed;
+    };
 }
 
 TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMapRenderable2Ptr& output, TAK::Engine::Core::RenderContext& ctx, ScenePtr &scenePtr, const String& baseURI, const char* URI, bool isStreaming) NOTHROWS {
@@ -1757,11 +2013,38 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
     if (!iter)
         return TE_Err;
 
+    std::vector<B3DMMeshDraw> draws;
+    std::unordered_multimap<std::size_t, size_t> drawsByHash;
+
     while (iter->get(item) == TE_Ok) {
         if (item && item->hasMesh()) { // should be the case
             std::shared_ptr<const Mesh> mesh;
             item->loadMesh(mesh);
-            
+            if (!mesh) {
+                iter->next();
+                continue;
+            }
+
+            // identical geometry is uploaded once and drawn as instances
+            std::size_t meshHash = 0u;
+            Mesh_hash(&meshHash, *mesh);
+            const Matrix2 *childFrame = item->getLocalFrame();
+            bool instanced = false;
+            for (auto range = drawsByHash.equal_range(meshHash); range.first != range.second; ++range.first) {
+                B3DMMeshDraw &draw = draws[range.first->second];
+                bool identical = false;
+                if (Mesh_equals(&identical, *draw.mesh, *mesh) == TE_Ok && identical) {
+                    draw.instances.push_back(childFrame ? *childFrame : Matrix2());
+                    draw.transformed |= (childFrame && !(*childFrame == Matrix2()));
+                    instanced = true;
+                    break;
+                }
+            }
+            if (instanced) {
+                iter->next();
+                continue;
+            }
+
             GLenum front_face = GL_CCW;
             
             if (mesh->getFaceWindingOrder() == TEWO_Clockwise) {
@@ -1784,7 +2067,14 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
             }
 
             const VertexDataLayout& vdl = mesh->getVertexDataLayout();
-            VertexStreamConfig streams[3];
+            B3DMMeshDraw draw;
+            draw.mesh = mesh;
+            draw.hash = meshHash;
+            draw.num_textures = 0u;
+            draw.draw_mode = draw_mode;
+            draw.instances.push_back(childFrame ? *childFrame : Matrix2());
+            draw.transformed = (childFrame && !(*childFrame == Matrix2()));
+            VertexStreamConfig (&streams)[3] = draw.streams;
             size_t streamIndex2 = 0;
 
             if (handleConfigAttr(streams[streamIndex2], vdl, vdl.position, TEVA_Position)) ++streamIndex2;
@@ -1825,9 +2115,6 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
             GLenum indexType = GL_UNSIGNED_SHORT;
             size_t indexSize = 2;
 
-            // mark buffer count to spin up load tasks for new buffers at the end of this mesh
-            size_t batchBufferIndex = batchBuilder.bufferCount();
-
             if (mesh->isIndexed()) {
                 num_indices = mesh->getNumIndices();
 #if C3DT_DEBUG_RESOURCE_RELEASE
@@ -1843,7 +2130,7 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
                 indexed = true;
             }
 
-            batchBuilder.setStreams(streams, streamIndex2);
+            draw.num_streams = streamIndex2;
             size_t textureIndex = 0;
 
             for (size_t i = 0; i < num_mats; ++i) {
@@ -1899,7 +2186,7 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
                         }
                     }
 
-                    batchBuilder.setTexture(tex);
+                    draw.textures[draw.num_textures++] = tex;
 
                     if (doTexLoad) {
                         std::shared_ptr<Bitmap2> bitmap;
@@ -1933,9 +2220,12 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
 #if 1
                             // load compressed texture
                             std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData*)> data(nullptr, nullptr);
-                            GLTexture2_createCompressedTextureData(data, *bitmap);
-                            Task_begin(GLWorkers_resourceLoad(), loadCompressedTextureTask,
-                                tex, std::move(data));
+                            if (GLTexture2_createCompressedTextureData(data, *bitmap) == TE_Ok)
+                                Task_begin(GLWorkers_resourceLoad(), loadCompressedTextureTask,
+                                    tex, std::move(data));
+                            else
+                                Task_begin(GLWorkers_resourceLoad(), loadTextureTask,
+                                    tex, bitmap);
 #else
                             // load texture with bitmap on OpenGL resourceLoad worker
                             Task_begin(GLWorkers_resourceLoad(), loadTextureTask,
@@ -1948,44 +2238,75 @@ TAKErr GLC3DTRenderer::LoaderImpl::processB3DM(TAK::Engine::Renderer::Core::GLMa
                 }
             }
 
-            if (indexed)
-                batchBuilder.drawElements(draw_mode, num_indices, indexBufferIndex);
-            else
-                batchBuilder.drawArrays(draw_mode, num_verts);
+            draw.count = indexed ? num_indices : num_verts;
+            draw.index_buffer_index = indexBufferIndex;
 
-            // draw call adds buffers?
-            for (size_t i = batchBufferIndex; i < batchBuilder.bufferCount(); ++i) {
+            if (indexed) {
+                batchBuilder.bufferAt(indexBufferIndex)->load(mesh->getIndices(),
+                    num_indices * indexSize, false);
+            }
+
+            // streams share a single interleaved buffer
+            if (streamIndex2 && streams[0].buffer) {
+                const void* verts = nullptr;
+                mesh->getVertices(&verts, TEVA_Position);
+
+                size_t bufSize = num_verts * vdl.position.stride;
+
+                if (vdl.interleaved) {
+                    VertexDataLayout_requiredInterleavedDataSize(&bufSize, vdl, num_verts);
+
+                    // glTF accessors address the whole binary buffer; skip the leading bytes
+                    // (typically indices) that no stream references
+                    size_t base = bufSize;
+                    for (size_t i = 0; i < streamIndex2; ++i)
+                        base = std::min(base, static_cast<size_t>(streams[i].offset));
+                    if (base && base < bufSize) {
+                        verts = static_cast<const uint8_t*>(verts) + base;
+                        bufSize -= base;
+                        for (size_t i = 0; i < streamIndex2; ++i)
+                            streams[i].offset -= static_cast<GLsizei>(base);
+                    }
+                }
 
+                bool use_vbo = indexed ? num_verts <= 0xFFFFu : num_verts <= (3u * 0xFFFFu);
+                use_vbo &= vdl.interleaved;
 
-                if (i == indexBufferIndex) {
-                    batchBuilder.bufferAt(i)->load(mesh->getIndices(), 
-                        num_indices * indexSize, false);
+                if (use_vbo) {
+                    Task_begin(GLWorkers_resourceLoad(), loadVBOTask,
+                        streams[0].buffer, scene, verts, bufSize);
                 } else {
-                    const void* verts = nullptr;
-                    mesh->getVertices(&verts, TEVA_Position);
-
-                    size_t bufSize = num_verts * vdl.position.stride;
-
-                    if (vdl.interleaved)
-                        VertexDataLayout_requiredInterleavedDataSize(&bufSize, vdl, num_verts);
-
-                    bool use_vbo = indexed ? num_verts <= 0xFFFFu : num_verts <= (3u * 0xFFFFu);
-                    use_vbo &= vdl.interleaved;
-
-                    if (use_vbo) {
-                        GLBatch::BufferPtr buffer = batchBuilder.bufferAt(i);
-                        Task_begin(GLWorkers_resourceLoad(), loadVBOTask,
-                            buffer, scene, verts, bufSize);
-                    } else {
-                        // safe to call from load thread (NO GL calls invoked)
-                        batchBuilder.bufferAt(i)->load(verts, bufSize, false);
-                    }
-                }                
+                    // safe to call from load thread (NO GL calls invoked)
+                    streams[0].buffer->load(verts, bufSize, false);
+                }
             }
+
+            drawsByHash.insert(std::make_pair(meshHash, draws.size()));
+            draws.push_back(std::move(draw));
         }
         iter->next();
     }
 
+    // emit the draws; geometry referenced by multiple nodes, or positioned by its node, is instanced
+    for (const B3DMMeshDraw &draw : draws) {
+        batchBuilder.setStreams(draw.streams, draw.num_streams);
+        for (size_t i = 0; i < draw.num_textures; ++i)
+            batchBuilder.setTexture(draw.textures[i], i);
+
+        const bool indexed = (draw.index_buffer_index != SIZE_MAX);
+        if (draw.instances.size() > 1u || draw.transformed) {
+            if (indexed)
+                batchBuilder.drawElementsInstanced(draw.draw_mode, draw.count, draw.index_buffer_index, draw.instances.data(), draw.instances.size());
+            else
+                batchBuilder.drawArraysInstanced(draw.draw_mode, draw.count, draw.instances.data(), draw.instances.size());
+        } else {
+            if (indexed)
+                batchBuilder.drawElements(draw.draw_mode, draw.count, draw.index_buffer_index);
+            else
+                batchBuilder.drawArrays(draw.draw_mode, draw.count);
+        }
+    }
+
     // Load shader tasks
     SharedGLBatchPtr batch;
     batchBuilder.buildShared(batch);
@@ -2024,6 +2345,12 @@ TAKErr GLC3DTRenderer::LoaderImpl::load(TAK::Engine::Renderer::Core::GLMapRender
     if (code != TE_Ok)
         return code;
 
+    const int64_t length = input->length();
+    if (length > 0) {
+        load_stats_->bytes += length;
+        ++load_stats_->count;
+    }
+
     {
         bool tryAgain = false;
         std::unique_ptr<GLC3DTTileset> tileset;
@@ -2031,10 +2358,13 @@ TAKErr GLC3DTRenderer::LoaderImpl::load(TAK::Engine::Renderer::Core::GLMapRender
         SceneInfoPtr sceneInfo;
         do {
             if (type == C3DTFileType_TilesetJSON) {
-                TilesetParser args(ctx, URI, this->makeChildContentLoader(ctx));
-                code = C3DTTileset_parse(input.get(), &args, TilesetParser::visitor);
-                if (code == TE_Ok)
+                std::shared_ptr<GLContentContext::Loader> childLoader = this->makeChildContentLoader(ctx);
+                TilesetParser args(ctx, URI, childLoader);
+                code = C3DTTileset_parse(input.get(), &args, TilesetParser::visitor, eagerParseDepth);
+                if (code == TE_Ok) {
                     tileset = std::move(args.tileset);
+                    tileset->load_stats_ = static_cast<LoaderImpl&>(*childLoader).load_stats_;
+                }
             } else if (type == C3DTFileType_B3DM) {
                 code = C3DT_parseB3DMScene(scene, sceneInfo, input.get(), baseURI, fileURI);
             } else {
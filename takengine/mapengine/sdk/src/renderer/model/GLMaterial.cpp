@@ -32,6 +32,11 @@ namespace {
 
 	TAK::Engine::Util::FutureTask<GLTexture2Ptr> handleTextureHints(TAK::Engine::Util::FutureTask<std::shared_ptr<Bitmap2>> textureTask, unsigned int hints) {
 		
+		// the context does not support any of the compressed formats
+		unsigned compression;
+		if (GLTexture2_getSupportedCompression(&compression) == TE_Ok && compression == TEGLTC_None)
+			hints |= GLMaterial::UncompressedTexture;
+
 		if (hints & GLMaterial::UncompressedTexture)
 			return textureTask
 				.thenOn(GLWorkers_resourceLoad(), loadTexture);
@@ -64,6 +69,14 @@ GLMaterial::GLMaterial(const Material &subject_, const TAK::Engine::Util::Future
     height(0u),
     hints(hints_)
 {}
+GLMaterial::GLMaterial(const Material &subject_, const std::shared_ptr<GLMaterial> &textureSource_) NOTHROWS :
+    subject(subject_),
+    texture(nullptr, nullptr),
+    textureSource(textureSource_),
+    width(0u),
+    height(0u),
+    hints(textureSource_ ? textureSource_->hints : 0u)
+{}
 
 GLMaterial::~GLMaterial() NOTHROWS
 {
@@ -76,6 +89,9 @@ const Material &GLMaterial::getSubject() const NOTHROWS
 }
 GLTexture2 *GLMaterial::getTexture() NOTHROWS
 {
+    if (textureSource)
+        return textureSource->getTexture();
+
     TAKErr code(TE_Ok);
     do {
         Lock lock(mutex);
@@ -104,11 +120,11 @@ GLTexture2 *GLMaterial::getTexture() NOTHROWS
 }
 std::size_t GLMaterial::getWidth() const NOTHROWS
 {
-    return width;
+    return textureSource ? textureSource->getWidth() : width;
 }
 std::size_t GLMaterial::getHeight() const NOTHROWS
 {
-    return height;
+    return textureSource ? textureSource->getHeight() : height;
 }
 bool GLMaterial::isTextured() const NOTHROWS
 {
@@ -116,6 +132,9 @@ bool GLMaterial::isTextured() const NOTHROWS
 }
 bool GLMaterial::isLoading() const NOTHROWS
 {
+    if (textureSource)
+        return textureSource->isLoading();
+
     TAKErr code(TE_Ok);
     do {
         Lock lock(mutex);
@@ -1,6 +1,8 @@
 #ifndef TAK_ENGINE_RENDERER_MODEL_GLMATERIAL_H_INCLUDED
 #define TAK_ENGINE_RENDERER_MODEL_GLMATERIAL_H_INCLUDED
 
+#include <memory>
+
 #include "model/Material.h"
 #include "renderer/AsyncBitmapLoader2.h"
 #include "renderer/GLTexture2.h"
@@ -23,6 +25,12 @@ namespace TAK {
                     GLMaterial(const TAK::Engine::Model::Material &subject) NOTHROWS;
                     GLMaterial(const TAK::Engine::Model::Material &subject, TAK::Engine::Renderer::GLTexture2Ptr &&texture, const std::size_t width, const std::size_t height) NOTHROWS;
                     GLMaterial(const TAK::Engine::Model::Material &subject, const TAK::Engine::Util::FutureTask<std::shared_ptr<Bitmap2>> &pendingTexture, const unsigned int hints) NOTHROWS;
+                    /**
+                     * Creates a material that renders with the texture of
+                     * `textureSource`, which may be shared by many
+                     * materials.
+                     */
+                    GLMaterial(const TAK::Engine::Model::Material &subject, const std::shared_ptr<GLMaterial> &textureSource) NOTHROWS;
 
                     ~GLMaterial() NOTHROWS;
                 private :
@@ -39,6 +47,7 @@ namespace TAK {
                     TAK::Engine::Model::Material subject;
                     TAK::Engine::Renderer::GLTexture2Ptr texture;
 					TAK::Engine::Util::FutureTask<GLTexture2Ptr> futureTexture;
+                    std::shared_ptr<GLMaterial> textureSource;
 
                     std::size_t width;
                     std::size_t height;
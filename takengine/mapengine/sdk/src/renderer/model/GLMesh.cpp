@@ -11,8 +11,10 @@
 #include "thread/Mutex.h"
 #include "thread/Lock.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "util/ConfigOptions.h"
 #include "util/MathUtils.h"
 #include "renderer/GLDepthSampler.h"
+#include "renderer/GLPerformanceCounters.h"
 #include "renderer/GLWorkers.h"
 #include "util/Tasking.h"
 #include "renderer/GLES20FixedPipeline.h"
@@ -23,6 +25,7 @@ using namespace TAK::Engine::Core;
 using namespace TAK::Engine::Feature;
 using namespace TAK::Engine::Math;
 using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Renderer::Core;
 using namespace TAK::Engine::Thread;
@@ -179,6 +182,37 @@ namespace
         return (argb >> 24u) & 0xFFu;
     }
 
+    bool isQuantizable(const VertexDataLayout &layout) NOTHROWS
+    {
+        if (!layout.interleaved || !(layout.attributes&TEVA_Position) || layout.position.type != TEDT_Float32)
+            return false;
+        if ((layout.attributes&TEVA_Normal) && layout.normal.type != TEDT_Float32)
+            return false;
+        if ((layout.attributes&TEVA_Color) && layout.color.type != TEDT_UInt8)
+            return false;
+        for (int i = 0; i < 8; i++) {
+            VertexArray texCoords;
+            if ((layout.attributes&(TEVA_TexCoord0 << i)) &&
+                (VertexDataLayout_getTexCoordArray(&texCoords, layout, i) != TE_Ok || texCoords.type != TEDT_Float32)) {
+
+                return false;
+            }
+        }
+        return true;
+    }
+
+    GLenum glType(const DataType type) NOTHROWS
+    {
+        switch (type) {
+        case TEDT_UInt8 :
+            return GL_UNSIGNED_BYTE;
+        case TEDT_UInt16 :
+            return GL_UNSIGNED_SHORT;
+        default :
+            return GL_FLOAT;
+        }
+    }
+
 	bool hasTexturedMaterial(std::vector<GLMaterial *> &materials) NOTHROWS {
 		for (size_t i = 0; i < materials.size(); ++i)
 			if (materials[i]->isTextured())
@@ -228,6 +262,9 @@ GLMesh::GLMesh(RenderContext &ctx, Matrix2Ptr_const &&localFrame, const Altitude
     allow_texture_(true),
     vbo_(GL_NONE),
     vbo_dirty_(true),
+    vbo_layout_(),
+    quantization_(),
+    quantize_(false),
     use_vbo_(false),
     lla2ecef_(nullptr, nullptr),
     matmgr_(matmgr),
@@ -241,6 +278,15 @@ GLMesh::GLMesh(RenderContext &ctx, Matrix2Ptr_const &&localFrame, const Altitude
     if (subject_.get()) {
         use_vbo_ = subject_->isIndexed() ? subject_->getNumVertices() <= 0xFFFFu : subject_->getNumVertices() <= (3u * 0xFFFFu);
         use_vbo_ &= subject_->getVertexDataLayout().interleaved;
+
+        // quantized vertex data is only uploaded to a VBO
+        vbo_layout_ = subject_->getVertexDataLayout();
+        quantize_ = use_vbo_ &&
+            isQuantizable(vbo_layout_) &&
+            ConfigOptions_getIntOptionOrDefault("glmesh.quantize-vertices", 0) &&
+            VertexDataLayout_createQuantizedInterleaved(&vbo_layout_, subject_->getVertexDataLayout().attributes) == TE_Ok;
+        if (!quantize_)
+            vbo_layout_ = subject_->getVertexDataLayout();
     }
 }
 
@@ -252,7 +298,7 @@ TAKErr GLMesh::initMaterials() NOTHROWS
     if (this->materials_.size() == (numMaterials+1u))
         return TE_Ok;
 
-    const VertexDataLayout &vertexDataLayout = this->subject_->getVertexDataLayout();
+    const VertexDataLayout &vertexDataLayout = this->vbo_layout_;
 
     this->materials_.reserve(numMaterials+1u);
     this->shader_.reserve(numMaterials+1u);
@@ -335,7 +381,7 @@ TAKErr GLMesh::resolveMaterials(bool *value) NOTHROWS
         }
 
         std::shared_ptr<const Shader> s;
-        code = getShader(s, ctx_, this->subject_->getVertexDataLayout(), *this->materials_[i]);
+        code = getShader(s, ctx_, this->vbo_layout_, *this->materials_[i]);
         TE_CHECKBREAK_CODE(code);
         this->shader_[i] = s;
 
@@ -512,6 +558,7 @@ void GLMesh::draw(const Shader2& shader, const ViewState_& viewState, RenderStat
 
     //TODO-- what is it
     glDrawArrays(GL_TRIANGLES, 0, count);
+    GLPerformanceCounters_draw(GL_TRIANGLES, count);
 
     glDisableVertexAttribArray(shader.aVertexCoords);
 }
@@ -534,6 +581,14 @@ void GLMesh::updateBindVbo() NOTHROWS {
         if (vertexDataLayout.interleaved)
             VertexDataLayout_requiredInterleavedDataSize(&bufSize, vertexDataLayout, subject_->getNumVertices());
 
+        std::unique_ptr<uint8_t[]> quantized;
+        if (quantize_) {
+            VertexDataLayout_requiredInterleavedDataSize(&bufSize, vbo_layout_, subject_->getNumVertices());
+            quantized.reset(new uint8_t[bufSize]);
+            VertexDataLayout_quantize(quantized.get(), &quantization_, vbo_layout_, buf, vertexDataLayout, subject_->getNumVertices());
+            buf = quantized.get();
+        }
+
         // upload the buffer data as static
         glBufferData(
             GL_ARRAY_BUFFER,
@@ -588,7 +643,7 @@ void GLMesh::draw(const ViewState_& viewState, RenderState& state, const int ren
     // if we have a wireframe, draw it before drawing the model
     if (!isTextured && this->wireframe_.get()) {
         if (!this->wireframe_shader_.get()) {
-            Shader_get(wireframe_shader_, ctx_, RenderAttributes());
+            wireframe_shader_ = Shader_get<TESF_None>(ctx_);
         }
 
         glUseProgram(this->wireframe_shader_->handle);
@@ -606,6 +661,7 @@ void GLMesh::draw(const ViewState_& viewState, RenderState& state, const int ren
         glVertexAttribPointer(this->wireframe_shader_->aVertexCoords, 3, GL_FLOAT, false, stride, /*this->wireframe_->get()*/verts);
         glUniform4f(this->wireframe_shader_->uColor, 0.6f, 0.0f, 0.0f, 1.0f);
         glDrawArrays(GL_LINES, 0, count);
+        GLPerformanceCounters_draw(GL_LINES, count);
         glDisableVertexAttribArray(this->wireframe_shader_->aVertexCoords);
     }
 
@@ -683,14 +739,14 @@ void GLMesh::draw(const ViewState_& viewState, RenderState& state, const int ren
 }
 void GLMesh::draw(const Shader &shader, GLMaterial &material, const bool reset)  const NOTHROWS
 {
-    const VertexDataLayout &vertexDataLayout = this->subject_->getVertexDataLayout();
+    // client arrays are only used if not quantized
+    const VertexDataLayout &vertexDataLayout = this->vbo_layout_;
 
     if(reset) {
-        // XXX - use layout attribute type
         if(use_vbo_) {
             glVertexAttribPointer(shader.aVertexCoords,
-                    3u, GL_FLOAT,
-                    false,
+                    3u, glType(vertexDataLayout.position.type),
+                    quantize_,
                     static_cast<GLsizei>(vertexDataLayout.position.stride),
                     (const void *)vertexDataLayout.position.offset);
         } else {
@@ -723,13 +779,25 @@ void GLMesh::draw(const Shader &shader, GLMaterial &material, const bool reset)
             }
         }
 
+        if(shader.quantized) {
+            glUniform3f(shader.uPositionOffset,
+                    static_cast<float>(quantization_.positionOffset[0]),
+                    static_cast<float>(quantization_.positionOffset[1]),
+                    static_cast<float>(quantization_.positionOffset[2]));
+            glUniform3f(shader.uPositionScale,
+                    static_cast<float>(quantization_.positionScale[0]),
+                    static_cast<float>(quantization_.positionScale[1]),
+                    static_cast<float>(quantization_.positionScale[2]));
+        }
+
         if(shader.lighting) {
             if(use_vbo_) {
+                // quantized normals are octahedral encoded
                 glVertexAttribPointer(
                         shader.aNormals,
-                        3,
-                        GL_FLOAT,
-                        false,
+                        quantize_ ? 2 : 3,
+                        glType(vertexDataLayout.normal.type),
+                        quantize_,
                         static_cast<GLsizei>(vertexDataLayout.normal.stride),
                         (const void *)vertexDataLayout.normal.offset);
             } else {
@@ -759,18 +827,22 @@ void GLMesh::draw(const Shader &shader, GLMaterial &material, const bool reset)
         if (texture && material.getSubject().textureCoordIndex != Material::InvalidTextureCoordIndex) {
             // XXX - tex coord scaling assumes all material textures have same size
             transform_.texture.scale((float)material.getWidth() / (float)texture->getTexWidth(), (float)material.getHeight() / (float)texture->getTexHeight(), 1.0);
+            if (quantize_) {
+                const int texCoordIndex = material.getSubject().textureCoordIndex;
+                transform_.texture.translate(quantization_.texCoordOffset[texCoordIndex][0], quantization_.texCoordOffset[texCoordIndex][1], 0.0);
+                transform_.texture.scale(quantization_.texCoordScale[texCoordIndex][0], quantization_.texCoordScale[texCoordIndex][1], 1.0);
+            }
 
             glActiveTexture(GL_TEXTURE0 + material.getSubject().textureCoordIndex);
             VertexArray layoutArray = vertexDataLayout.texCoord0;
             VertexDataLayout_getTexCoordArray(&layoutArray, vertexDataLayout, material.getSubject().textureCoordIndex);
 
-            // XXX - use attribute layout type
             if(use_vbo_) {
                 glVertexAttribPointer(
                         shader.aTextureCoords,
                         2,
-                        GL_FLOAT,
-                        false,
+                        glType(layoutArray.type),
+                        quantize_,
                         static_cast<GLsizei>(layoutArray.stride),
                         (const void *)layoutArray.offset);
             } else {
@@ -831,11 +903,13 @@ void GLMesh::draw(const Shader &shader, GLMaterial &material, const bool reset)
         glDrawElements(mode,
                 static_cast<GLsizei>(subject_->getNumIndices()),
                 GL_UNSIGNED_SHORT, subject_->getIndices());
+        GLPerformanceCounters_draw(mode, subject_->getNumIndices());
     } else {
         const std::size_t vertRenderLimit = (3u * 0xFFFFu);
         for (std::size_t i = 0; i < subject_->getNumVertices(); i += vertRenderLimit) {
             glDrawArrays(mode, static_cast<GLint>(i),
                 static_cast<GLsizei>(std::min(vertRenderLimit, subject_->getNumVertices()-i)));
+            GLPerformanceCounters_draw(mode, std::min(vertRenderLimit, subject_->getNumVertices()-i));
         }
     }
 }
@@ -890,12 +964,18 @@ void GLMesh::depthSamplerDraw(GLDepthSampler& sampler, const TAK::Engine::Core::
         this
     };
 
-    const VertexDataLayout& vertexDataLayout = this->subject_->getVertexDataLayout();
+    const VertexDataLayout& vertexDataLayout = this->vbo_layout_;
     this->prepareTransform(viewState);
+    this->updateBindVbo();
 
     // set MVP
     Matrix2 m = transform_.projection;
     m.concatenate(transform_.modelView);
+    if (quantize_) {
+        // the sampler does not dequantize
+        m.translate(quantization_.positionOffset[0], quantization_.positionOffset[1], quantization_.positionOffset[2]);
+        m.scale(quantization_.positionScale[0], quantization_.positionScale[1], quantization_.positionScale[2]);
+    }
     double mxd[16];
     m.get(mxd, Matrix2::COLUMN_MAJOR);
     float mxf[16];
@@ -914,11 +994,10 @@ void GLMesh::depthSamplerDraw(GLDepthSampler& sampler, const TAK::Engine::Core::
 
     glVertexAttribPointer(aVertCoords, 3, GL_FLOAT, false, stride, verts);*/
 
-    this->updateBindVbo();
     if (use_vbo_) {
         glVertexAttribPointer(aVertCoords,
-            3u, GL_FLOAT,
-            false,
+            3u, glType(vertexDataLayout.position.type),
+            quantize_,
             static_cast<GLsizei>(vertexDataLayout.position.stride),
             (const void*)vertexDataLayout.position.offset);
     }
@@ -956,12 +1035,14 @@ void GLMesh::depthSamplerDraw(GLDepthSampler& sampler, const TAK::Engine::Core::
         glDrawElements(mode,
             static_cast<GLsizei>(subject_->getNumIndices()),
             GL_UNSIGNED_SHORT, subject_->getIndices());
+        GLPerformanceCounters_draw(mode, subject_->getNumIndices());
     }
     else {
         const std::size_t vertRenderLimit = (3u * 0xFFFFu);
         for (std::size_t i = 0; i < subject_->getNumVertices(); i += vertRenderLimit) {
             glDrawArrays(mode, static_cast<GLint>(i),
                 static_cast<GLsizei>(std::min(vertRenderLimit, subject_->getNumVertices() - i)));
+            GLPerformanceCounters_draw(mode, std::min(vertRenderLimit, subject_->getNumVertices() - i));
         }
     }
 
@@ -1094,6 +1175,7 @@ TAKErr GLMesh::getShader(std::shared_ptr<const Shader> &value, RenderContext &ct
     attrs.colorPointer = (layout.attributes & TEVA_Color) != 0;
     attrs.normals = (layout.attributes & TEVA_Normal) != 0;
     attrs.lighting = (layout.attributes & TEVA_Normal) != 0;
+    attrs.quantized = VertexDataLayout_isQuantized(layout);
 
     Shader_get(value, ctx, attrs);
     return TE_Ok;
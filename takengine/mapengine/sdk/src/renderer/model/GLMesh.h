@@ -112,6 +112,10 @@ namespace TAK {
                     bool allow_texture_;
                     GLuint vbo_;
                     bool vbo_dirty_;
+                    /** the layout of the vertex data as drawn; quantized if `quantize_` */
+                    TAK::Engine::Model::VertexDataLayout vbo_layout_;
+                    TAK::Engine::Model::VertexQuantization quantization_;
+                    bool quantize_;
                     std::vector<std::shared_ptr<const Renderer::Shader>> shader_;
                     std::shared_ptr<const Renderer::Shader> wireframe_shader_;
                     std::shared_ptr<const Renderer::Shader2> wireframe_shader2_;
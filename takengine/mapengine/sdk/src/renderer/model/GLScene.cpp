@@ -7,6 +7,7 @@
 #include "elevation/ElevationManager.h"
 #include "feature/LineString2.h"
 #include "model/MeshTransformer.h"
+#include "renderer/core/GLTerrainOcclusion.h"
 #include "renderer/model/HitTestControl.h"
 #include "renderer/model/SceneObjectControl.h"
 #include "thread/Lock.h"
@@ -19,6 +20,9 @@
 #include "renderer/GLES20FixedPipeline.h"
 
 #define PROFILE_HIT_TESTS 0
+// time, in milliseconds, to wait for a depth sample to be delivered by the
+// draw pump before blocking the GL thread on the readback
+#define DEPTH_TEST_DELIVERY_TIMEOUT 100LL
 
 #if PROFILE_HIT_TESTS
 #include <chrono>
@@ -38,8 +42,58 @@ using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 using namespace atakmap::renderer;
 
+struct GLScene::DepthTest
+{
+    DepthTest(const MapSceneModel2 &sceneModel_, const float x_, const float y_) NOTHROWS :
+        sceneModel(sceneModel_),
+        x(x_),
+        y(y_),
+        done(false),
+        code(TE_Done),
+        z(1.0)
+    {}
+
+    const MapSceneModel2 sceneModel;
+    const float x;
+    const float y;
+
+    /** guards the result */
+    Monitor monitor;
+    bool done;
+    TAKErr code;
+    double z;
+    Matrix2 proj;
+};
+
 namespace
 {
+    /**
+     * Used only by the GL thread and shared by all scenes; samples are
+     * delivered as scenes are drawn.
+     */
+    TAK::Engine::Renderer::GLDepthSamplerPtr &sharedDepthSampler() NOTHROWS
+    {
+        static TAK::Engine::Renderer::GLDepthSamplerPtr depthSampler(nullptr, nullptr);
+        return depthSampler;
+    }
+    TAKErr unprojectDepthSample(GeoPoint2 &value, const MapSceneModel2 &sceneModel, const Matrix2 &projection, const float x, const float y, const double z) NOTHROWS
+    {
+        TAK::Engine::Math::Point2<double> point(x, y, 0);
+        projection.transform(&point, point);
+        point.z = z;
+
+        Matrix2 mat;
+        if (projection.createInverse(&mat) != TE_Ok)
+            return TE_Done;
+
+        mat.transform(&point, point);
+
+        // ortho -> projection
+        sceneModel.inverseTransform.transform(&point, point);
+        // projection -> LLA
+        return sceneModel.projection->inverse(&value, point);
+    }
+
     TAKErr buildNodeList(std::list<std::shared_ptr<SceneNode>> &value, SceneNode &node) NOTHROWS
     {
         TAKErr code(TE_Ok);
@@ -130,6 +184,13 @@ int GLScene::getRenderPass() NOTHROWS
 }
 void GLScene::draw(const GLGlobeBase &view, const int renderPass) NOTHROWS
 {
+    // deliver any hit test readbacks that have completed
+    {
+        GLDepthSamplerPtr &depthSampler = sharedDepthSampler();
+        if (depthSampler)
+            depthSampler->processPendingSamples(false);
+    }
+
     // init tile grid, if necessary
     SceneInfo locationUpdate;
     bool updateLocation = false;
@@ -161,6 +222,8 @@ void GLScene::draw(const GLGlobeBase &view, const int renderPass) NOTHROWS
 
     if(!this->loader_.get())
         this->loader_.reset(new GLSceneNodeLoader(3u));
+    // queued loads are prioritized by their size on screen
+    this->loader_->setView(view.renderPass->scene);
 
     // XXX - can tile AOI be quickly computed???
 
@@ -175,6 +238,12 @@ void GLScene::draw(const GLGlobeBase &view, const int renderPass) NOTHROWS
         indicator.setIcon(*locationUpdate.location, modelIcon);
     }
 
+    // the x-ray pass draws content hidden by the terrain
+    std::shared_ptr<const TerrainOcclusion> occlusion;
+    if (!xray_color_ && (renderPass&GLMapView2::Sprites))
+        occlusion = view.getTerrainOcclusion();
+    const bool occlusionCurrent = occlusion && occlusion->isCurrent(view.renderPass->scene);
+
     std::map<SceneNode *, std::shared_ptr<GLSceneNode>>::iterator it;
     std::list<GLSceneNode *> drawable;
     for (it = node_renderers_.begin(); it != node_renderers_.end(); it++) {
@@ -200,13 +269,16 @@ void GLScene::draw(const GLGlobeBase &view, const int renderPass) NOTHROWS
                     tile.release();
             } else {
                 const bool prefetch = (renderable == GLSceneNode::RenderVisibility::Prefetch);
+                // occluded nodes are loaded at prefetch priority; a stale
+                // capture does not prevent drawing
+                const bool occluded = !prefetch && occlusion && tile.isOccluded(view, *occlusion);
 
                 if (!tile.isLoaded(view)) {
                     bool queued;
-                    if ((loader_->isQueued(&queued, tile, prefetch) == TE_Ok) && !queued) {
+                    if ((loader_->isQueued(&queued, tile, prefetch || occluded) == TE_Ok) && !queued) {
                         GLSceneNode::LoadContext loadContext;
                         if (tile.prepareLoadContext(&loadContext, view) == TE_Ok)
-                            loader_->enqueue(it->second, std::move(loadContext), prefetch);
+                            loader_->enqueue(it->second, std::move(loadContext), prefetch || occluded);
                     }
                 } else {
                     // if any tiles are drawing, don't draw indicator
@@ -214,7 +286,7 @@ void GLScene::draw(const GLGlobeBase &view, const int renderPass) NOTHROWS
                 }
 
                 // draw
-                if (!prefetch)
+                if (!prefetch && !(occluded && occlusionCurrent))
                     drawable.push_back(&tile);
             }
         } else {
@@ -342,15 +414,45 @@ TAKErr GLScene::hitTest(TAK::Engine::Core::GeoPoint2 *value, const TAK::Engine::
         return TE_InvalidArg;
 
 #if 1 // Flip this to compare CPU hit tests
-    GeoPoint2 hitGeo;
-    TAKErr awaitCode = Task_begin(GLWorkers_glThread(), depthTestTask, this, scene, x, y)
-        .await(hitGeo, code);
+    std::shared_ptr<DepthTest> request(std::make_shared<DepthTest>(scene, x, y));
+    bool issued;
+    TAKErr awaitCode = Task_begin(GLWorkers_glThread(), depthTestTask, this, request)
+        .await(issued, code);
     
     if (awaitCode != TE_Ok)
         return awaitCode;
 
-    if (code == TE_Ok)
-        *value = hitGeo;
+    if (code == TE_Ok) {
+        // the readback is delivered by the draw pump once the GPU has
+        // completed, typically a frame or two later. If the scene is not
+        // being drawn, block the GL thread on the readback instead.
+        bool delivered;
+        {
+            Monitor::Lock lock(request->monitor);
+            if (!request->done)
+                lock.wait(DEPTH_TEST_DELIVERY_TIMEOUT);
+            delivered = request->done;
+        }
+        if (!delivered) {
+            bool flushed;
+            TAKErr flushCode;
+            awaitCode = Task_begin(GLWorkers_glThread(), flushDepthTestsTask)
+                .await(flushed, flushCode);
+            if (awaitCode != TE_Ok)
+                return awaitCode;
+        }
+
+        Monitor::Lock lock(request->monitor);
+        while (!request->done)
+            lock.wait();
+        code = request->code;
+        if (code == TE_Ok) {
+            GeoPoint2 hitGeo;
+            code = unprojectDepthSample(hitGeo, scene, request->proj, x, y, request->z);
+            if (code == TE_Ok)
+                *value = hitGeo;
+        }
+    }
 #else
     code = TE_Unsupported;
 #endif
@@ -422,46 +524,55 @@ TAKErr GLScene::hitTest(TAK::Engine::Core::GeoPoint2 *value, const TAK::Engine::
 }
 
 
-TAKErr GLScene::depthTestTask(TAK::Engine::Core::GeoPoint2& value, GLScene* scene, const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y) NOTHROWS {
+TAKErr GLScene::depthTestTask(bool &value, GLScene* scene, const std::shared_ptr<DepthTest> &request) NOTHROWS {
 
     TAKErr code = TE_Done;
+    value = false;
 
-    // Used only by the glThread and therefore statically cached for reuse, but as depth sampling grows in scope
-    // in the renderer, should be moved to a shared place.
-    static GLDepthSamplerPtr depth_sampler_(nullptr, nullptr);
-
-    if (!depth_sampler_) {
+    GLDepthSamplerPtr &depthSampler = sharedDepthSampler();
+    if (!depthSampler) {
         // For now, use (ENCODED_DEPTH_ENCODED_ID) method, since seems to get a 16-bit only depth buffer
         // the other way
-        code = GLDepthSampler_create(depth_sampler_, scene->ctx_, GLDepthSampler::ENCODED_DEPTH_ENCODED_ID);
+        code = GLDepthSampler_create(depthSampler, scene->ctx_, GLDepthSampler::ENCODED_DEPTH_ENCODED_ID);
         if (code != TE_Ok)
             return code;
     }
 
-    float screenY = y;
-    double pointZ = 0.0;
-    Matrix2 projection;
-
-    code = depth_sampler_->performDepthSample(&pointZ, &projection, nullptr, *scene, sceneModel, x, screenY);
+    // the callback takes ownership of the reference
+    std::unique_ptr<std::shared_ptr<DepthTest>> opaque(new std::shared_ptr<DepthTest>(request));
+    code = depthSampler->requestDepthSample(depthSampleDelivered, opaque.get(), *scene, request->sceneModel, request->x, request->y, 1u, true, false);
     if (code != TE_Ok)
         return code;
+    opaque.release();
 
-    TAK::Engine::Math::Point2<double> point(x, screenY, 0);
-    projection.transform(&point, point);
-    point.z = pointZ;
-
-    Matrix2 mat;
-    if (projection.createInverse(&mat) != TE_Ok)
-        return TE_Done;
+    value = true;
+    return code;
+}
 
-    mat.transform(&point, point);
+TAKErr GLScene::flushDepthTestsTask(bool &value) NOTHROWS {
+    GLDepthSamplerPtr &depthSampler = sharedDepthSampler();
+    if (depthSampler)
+        depthSampler->processPendingSamples(true);
+    value = true;
+    return TE_Ok;
+}
 
-    // ortho -> projection
-    sceneModel.inverseTransform.transform(&point, point);
-    // projection -> LLA
-    code = sceneModel.projection->inverse(&value, point);
+void GLScene::depthSampleDelivered(void *opaque, const TAKErr code, const GLDepthSampler::Sample &sample) NOTHROWS {
+    std::unique_ptr<std::shared_ptr<DepthTest>> request(static_cast<std::shared_ptr<DepthTest> *>(opaque));
 
-    return code;
+    Monitor::Lock lock((*request)->monitor);
+    (*request)->code = code;
+    if (code == TE_Ok) {
+        // clip space Z is `1.0` where nothing was drawn
+        if (sample.z.empty() || sample.z[0] >= 1.0) {
+            (*request)->code = TE_Done;
+        } else {
+            (*request)->z = sample.z[0];
+            (*request)->proj = sample.proj;
+        }
+    }
+    (*request)->done = true;
+    lock.broadcast();
 }
 
 TAKErr GLScene::gatherDepthSamplerDrawables(std::vector<GLDepthSamplerDrawable*>& result, int levelDepth, const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y) NOTHROWS {
@@ -546,7 +657,8 @@ void *GLScene::initializeThread(void *opaque)
             }
             bool optimizedExists;
             if (IO_exists(&optimizedExists, optimizedPath) == TE_Ok && optimizedExists) {
-                code = SceneFactory_decode(scene, optimizedPath, true);
+                // mapped in place; a stale cache is replaced below
+                code = SceneFactory_decodeCached(scene, optimizedPath, glscene->info_.uri);
                 if (code == TE_Ok)
                     break;
             }
@@ -561,7 +673,7 @@ void *GLScene::initializeThread(void *opaque)
                 if (IO_getParentFile(resourceDir, optimizedPath) != TE_Ok)
                     break;
                 IO_mkdirs(resourceDir);
-                SceneFactory_encode(optimizedPath, *scene); 
+                SceneFactory_encode(optimizedPath, *scene, glscene->info_.uri);
             }
         } while (false);
         glscene->indicator.clearProgress();
@@ -49,7 +49,12 @@ namespace TAK {
                 private :
                     static void *initializeThread(void *opaque);
                 private:
-                    static Util::TAKErr depthTestTask(TAK::Engine::Core::GeoPoint2& value, GLScene* scene, const TAK::Engine::Core::MapSceneModel2& sceneModel, float x, float y) NOTHROWS;
+                    struct DepthTest;
+                    /** issues an asynchronous depth sample for `request`; `value` is `true` if issued */
+                    static Util::TAKErr depthTestTask(bool &value, GLScene* scene, const std::shared_ptr<DepthTest> &request) NOTHROWS;
+                    /** blocks the GL thread until all issued depth samples are delivered */
+                    static Util::TAKErr flushDepthTestsTask(bool &value) NOTHROWS;
+                    static void depthSampleDelivered(void *opaque, const Util::TAKErr code, const GLDepthSampler::Sample &sample) NOTHROWS;
                 private :
                     TAK::Engine::Core::RenderContext &ctx_;
                     std::map<std::string, void *> controls_;
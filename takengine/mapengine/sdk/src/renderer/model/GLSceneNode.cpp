@@ -3,8 +3,11 @@
 #include "core/ProjectionFactory3.h"
 #include "math/Utils.h"
 #include "model/MeshTransformer.h"
+#include "renderer/core/GLTerrainOcclusion.h"
 #include "renderer/model/GLMesh.h"
 #include "thread/Lock.h"
+#include "util/AllocationTagging.h"
+#include "util/MemoryAccounting.h"
 
 #define SUPPORT_ECEF_RENDER 1
 
@@ -202,6 +205,8 @@ namespace
 
 class GLSceneNode::LODMeshes
 {
+public :
+    ~LODMeshes() NOTHROWS;
 public :
     void release() NOTHROWS;
     void draw(const GLGlobeBase &view, RenderState &state, const int renderPass, const ColorControl::Mode colorMode, const unsigned int color) NOTHROWS;
@@ -214,6 +219,8 @@ public :
     std::size_t locks{ 0 };
     std::vector<std::shared_ptr<GLMesh>> data;
     std::list<GLMaterial *> prefetch;
+    /** bytes recorded against `TEMC_Mesh` */
+    std::size_t accountedSize{ 0u };
 };
 
 GLSceneNode::GLSceneNode(RenderContext &ctx_, SceneNodePtr &&subject_, const TAK::Engine::Model::SceneInfo &info_) NOTHROWS :
@@ -241,10 +248,26 @@ GLSceneNode::GLSceneNode(RenderContext &ctx_, const std::shared_ptr<SceneNode> &
     color(0xFFFFFFFFu)
 {
     refreshAABB(subject->getAABB());
+
+    // LODs without a nominal resolution are selected by the on-screen size
+    // of the node; the most detailed LOD is used once the node spans
+    // `lodReferencePixels`
+    if (!(info.resolution > 0.0) && subject->getNumLODs() > 1u) {
+        const double lodReferencePixels = 1024.0;
+        const double metersPerDegree = 111319.49;
+        const double extent = atakmap::math::max<double>(
+                (mbb.maxX-mbb.minX)*metersPerDegree*cos((mbb.minY+mbb.maxY)/2.0*M_PI/180.0),
+                (mbb.maxY-mbb.minY)*metersPerDegree,
+                (mbb.maxZ-mbb.minZ)
+            );
+        if (extent > 0.0)
+            info.resolution = extent / lodReferencePixels;
+    }
 }
 
 TAKErr GLSceneNode::asyncLoad(GLSceneNode::LoadContext &loadContext, bool *cancelToken) NOTHROWS
 {
+    TE_ALLOCATION_TAG(TEAT_MeshLoad);
     TAKErr code(TE_Ok);
     const std::size_t lodIdx = ((std::size_t)(intptr_t)loadContext.opaque.get());
 
@@ -444,6 +467,32 @@ GLSceneNode::RenderVisibility GLSceneNode::isRenderable(const GLGlobeBase &view)
         return RenderVisibility::None;
     return intersects ? RenderVisibility::Prefetch : RenderVisibility::None;
 }
+bool GLSceneNode::isOccluded(const GLGlobeBase &view, const TerrainOcclusion &occlusion) const NOTHROWS
+{
+    const MapSceneModel2 &scene = view.renderPass->scene;
+    if (!scene.projection)
+        return false;
+
+    double zOff = 0.0;
+    if (info.altitudeMode != TEAM_Absolute)
+        view.getTerrainMeshElevation(&zOff, (mbb.maxY + mbb.minY) / 2.0, (mbb.maxX + mbb.minX) / 2.0);
+
+    // project the corners and the top center; the latter bounds the
+    // curvature of the top face under ECEF
+    GeoPoint2 lla[9u];
+    for (std::size_t i = 0u; i < 8u; i++) {
+        lla[i] = GeoPoint2((i & 0x2u) ? mbb.maxY : mbb.minY,
+                           (i & 0x1u) ? mbb.maxX : mbb.minX,
+                           ((i & 0x4u) ? mbb.maxZ : mbb.minZ) + zOff,
+                           AltitudeReference::HAE);
+    }
+    lla[8u] = GeoPoint2((mbb.maxY + mbb.minY) / 2.0, (mbb.maxX + mbb.minX) / 2.0, mbb.maxZ + zOff, AltitudeReference::HAE);
+
+    TAK::Engine::Math::Point2<double> xyz[9u];
+    if (Projection2_forward(xyz, *scene.projection, lla, 9u) != TE_Ok)
+        return false;
+    return occlusion.isOccluded(AABB(xyz, 9u));
+}
 TAKErr GLSceneNode::unloadLODs() NOTHROWS
 {
     TAKErr code(TE_Ok);
@@ -835,13 +884,23 @@ GLSceneNode::LoadContext::LoadContext() NOTHROWS :
 }
 
 GLSceneNode::LoadContext::LoadContext(const LoadContext &other) NOTHROWS = default;
+GLSceneNode::LoadContext &GLSceneNode::LoadContext::operator=(const LoadContext &other) NOTHROWS = default;
    
+GLSceneNode::LODMeshes::~LODMeshes() NOTHROWS
+{
+    if (accountedSize)
+        MemoryAccounting_release(TEMC_Mesh, accountedSize);
+}
 void GLSceneNode::LODMeshes::release() NOTHROWS
 {
     // release and clear meshes
     for(std::size_t i = 0u; i < data.size(); i++)
         data[i]->release();
     data.clear();
+    if (accountedSize) {
+        MemoryAccounting_release(TEMC_Mesh, accountedSize);
+        accountedSize = 0u;
+    }
 
     // unload and clear texture prefetch
     std::list<GLMaterial *>::iterator mat;
@@ -877,10 +936,21 @@ void GLSceneNode::LODMeshes::setData(std::vector<std::unique_ptr<GLMesh>> &mesh_
 {
     this->data.clear();
     this->data.reserve(mesh_data.size());
-    for (std::size_t i = 0u; i < mesh_data.size(); i++)
+    std::size_t size = 0u;
+    for (std::size_t i = 0u; i < mesh_data.size(); i++) {
+        std::size_t meshSize;
+        if (Mesh_getDataSize(&meshSize, mesh_data[i]->getSubject()) == TE_Ok)
+            size += meshSize;
         this->data.push_back(std::move(mesh_data[i]));
+    }
     mesh_data.clear();
 
+    if (accountedSize)
+        MemoryAccounting_release(TEMC_Mesh, accountedSize);
+    accountedSize = size;
+    if (accountedSize)
+        MemoryAccounting_allocate(TEMC_Mesh, accountedSize);
+
 #if 0
     if(this.data != null) {
         this.ctrl = new ColorControl[this.data.length];
@@ -41,6 +41,7 @@ namespace TAK {
                     {
                         LoadContext() NOTHROWS;
                         LoadContext(const LoadContext &other) NOTHROWS;
+                        LoadContext &operator=(const LoadContext &other) NOTHROWS;
 
                         /** content centroid */
                         TAK::Engine::Core::GeoPoint2 centroid;
@@ -71,6 +72,11 @@ namespace TAK {
                     Util::TAKErr prepareLoadContext(LoadContext *ctx, const Core::GLGlobeBase &view) const NOTHROWS;
                     Util::TAKErr prepareLoadContext(LoadContext* ctx, const TAK::Engine::Core::MapSceneModel2& scene, double drawMapResolution) const NOTHROWS;
                     RenderVisibility isRenderable(const Core::GLGlobeBase &view) const NOTHROWS;
+                    /**
+                     * Returns `true` if the node's bounds are entirely
+                     * behind the terrain in the specified capture.
+                     */
+                    bool isOccluded(const Core::GLGlobeBase &view, const Core::TerrainOcclusion &occlusion) const NOTHROWS;
                     Util::TAKErr unloadLODs() NOTHROWS;
                     bool hasLODs() const NOTHROWS;
                     Util::TAKErr hitTest(TAK::Engine::Core::GeoPoint2 *value, const TAK::Engine::Core::MapSceneModel2 &sceneModel, const float x, const float y) NOTHROWS;
@@ -1,13 +1,20 @@
 #include "renderer/model/GLSceneNodeLoader.h"
 
 #include <algorithm>
-#include <atomic>
+#include <cmath>
+
+#include "util/Logging2.h"
+#include "util/WorkerRegistry.h"
 
 using namespace TAK::Engine::Renderer::Model;
 
+using namespace TAK::Engine::Core;
 using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Util;
 
+// a queued node preempts a running load if it is this many times as large on screen
+#define PREEMPT_PRIORITY_RATIO 4.0
+
 namespace {
     template <typename T, typename E>
     inline typename std::deque<T>::iterator findNode(std::deque<T> &q, const E *node) {
@@ -19,79 +26,122 @@ namespace {
         }
         return it;
     }
+
+    /** Runs a loader on a borrowed worker thread */
+    class LoadWork : public Work
+    {
+    public :
+        LoadWork(void *(*entry_)(void *), void *opaque_) NOTHROWS :
+            entry(entry_),
+            opaque(opaque_)
+        {}
+    protected :
+        TAKErr onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS override
+        {
+            lockPtr.reset();
+            entry(opaque);
+            return TE_Ok;
+        }
+    private :
+        void *(*entry)(void *);
+        void *opaque;
+    };
 }
 
-GLSceneNodeLoader::QueueNode::QueueNode(GLSceneNode *node_, GLSceneNode::LoadContext &&ctx_) NOTHROWS 
+GLSceneNodeLoader::QueueNode::QueueNode(GLSceneNode *node_, GLSceneNode::LoadContext &&ctx_) NOTHROWS
     : node(node_),
-    ctx(std::move(ctx_))
+    ctx(std::move(ctx_)),
+    priority(0.0)
 {}
 
 bool GLSceneNodeLoader::QueueNode::operator<(const QueueNode &rhs) const NOTHROWS
 {
-    return ctx.gsd < rhs.ctx.gsd;
+    return priority > rhs.priority;
 }
 
-GLSceneNodeLoader::GLSceneNodeLoader(const std::size_t numThreads) NOTHROWS 
-    : threadPool(nullptr, nullptr),
-    numThreads(numThreads),
+GLSceneNodeLoader::GLSceneNodeLoader(const std::size_t numThreads) NOTHROWS
+    : numThreads(numThreads ? numThreads : 1u),
+    activeLoaders(0u),
     prefetchDirty(false),
     queueDirty(false),
     shutdown(false)
-{}
+{
+    view.valid = false;
+    view.fov = 0.0;
+    view.height = 0u;
+}
 
 GLSceneNodeLoader::~GLSceneNodeLoader() NOTHROWS
 {
-    shutdown = true;
-
     {
         Monitor::Lock lock(monitor);
-        if (lock.status == TE_Ok)
-            lock.broadcast();
+        if (lock.status == TE_Ok) {
+            shutdown = true;
+            queuedNodes.clear();
+            prefetchNodes.clear();
+            for (auto it = executingNodes.begin(); it != executingNodes.end(); ++it) {
+                it->second.cancelToken = true;
+                it->second.preempted = false;
+            }
+            // wait for the loaders to return their threads
+            while (activeLoaders)
+                lock.wait();
+        }
     }
 
-    if (threadPool.get())
-        threadPool.reset();
+    worker.reset();
 }
-                
+
 TAKErr GLSceneNodeLoader::enqueue(const std::shared_ptr<GLSceneNode> &node, GLSceneNode::LoadContext &&ctx, const bool prefetch) NOTHROWS
 {
     TAKErr code(TE_Ok);
 
     Monitor::Lock lock(monitor);
-    code = lock.status; 
+    code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
+    if (this->shutdown)
+        return TE_IllegalState;
     if (this->executingNodes.find(node.get()) != this->executingNodes.end())
         return code;
 
-    std::deque<QueueNode> *queueTo = nullptr;
+    std::deque<QueueNode> &queueTo = prefetch ? this->prefetchNodes : this->queuedNodes;
+    std::deque<QueueNode> &other = prefetch ? this->queuedNodes : this->prefetchNodes;
 
-    auto it = findNode(this->queuedNodes, node.get());
-    if (it != this->queuedNodes.end() && prefetch) {
-        this->queuedNodes.erase(it);
-        queueTo = &this->prefetchNodes;
-        this->prefetchDirty = true;
-    } else if ((it = findNode(this->prefetchNodes, node.get())) != this->prefetchNodes.end() && !prefetch) {
-        this->prefetchNodes.erase(it);
-        queueTo = &this->queuedNodes;
-        this->prefetchDirty = true;
-    } else if (prefetch) {
-        queueTo = &this->prefetchNodes;
+    auto it = findNode(other, node.get());
+    if (it != other.end())
+        other.erase(it);
+
+    QueueNode entry(node.get(), std::move(ctx));
+    entry.priority = computePriority(entry.ctx);
+
+    // replace any stale request for the node
+    it = findNode(queueTo, node.get());
+    if (it != queueTo.end())
+        *it = std::move(entry);
+    else
+        queueTo.push_back(std::move(entry));
+    if (prefetch)
         this->prefetchDirty = true;
-    } else { // !prefetch
-        queueTo = &this->queuedNodes;
+    else
         this->queueDirty = true;
-    }
 
-    if (queueTo)
-        queueTo->push_back(QueueNode(node.get(), std::move(ctx)));
+    if (!this->worker) {
+        code = WorkerRegistry_borrow(this->worker, TEWC_CPUDecode, "scene-node-load", this->numThreads);
+        TE_CHECKRETURN_CODE(code);
+    }
 
-    if (!this->threadPool) {
-        code = Thread::ThreadPool_create(this->threadPool, this->numThreads, threadStart, this);
+    // start another loader if under budget, else make room
+    if (this->activeLoaders < this->numThreads) {
+        this->activeLoaders++;
+        code = this->worker->scheduleWork(std::make_shared<LoadWork>(threadStart, this));
+        if (code != TE_Ok)
+            this->activeLoaders--;
         TE_CHECKRETURN_CODE(code);
+    } else if (!prefetch) {
+        preempt();
     }
 
-    code = lock.broadcast();
     return code;
 }
 TAKErr GLSceneNodeLoader::cancel(const GLSceneNode &node) NOTHROWS
@@ -99,7 +149,7 @@ TAKErr GLSceneNodeLoader::cancel(const GLSceneNode &node) NOTHROWS
     TAKErr code(TE_Ok);
 
     Monitor::Lock lock(monitor);
-    code = lock.status; 
+    code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
     auto it = findNode(this->queuedNodes, &node);
@@ -117,7 +167,8 @@ TAKErr GLSceneNodeLoader::cancel(const GLSceneNode &node) NOTHROWS
     auto cancelIt = this->executingNodes.find(&node);
     if (cancelIt != this->executingNodes.end()) {
         //XXX-- need full barrier atomic exchange
-        cancelIt->second = true;
+        cancelIt->second.cancelToken = true;
+        cancelIt->second.preempted = false;
     }
 
     return code;
@@ -127,14 +178,15 @@ TAKErr GLSceneNodeLoader::cancelAll() NOTHROWS
     TAKErr code(TE_Ok);
 
     Monitor::Lock lock(monitor);
-    code = lock.status; 
+    code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
     this->queuedNodes.clear();
     this->prefetchNodes.clear();
     for (auto it = this->executingNodes.begin(); it != this->executingNodes.end(); ++it) {
         //XXX-- need full barrier atomic exchange
-        it->second = true;
+        it->second.cancelToken = true;
+        it->second.preempted = false;
     }
 
     return code;
@@ -144,7 +196,7 @@ TAKErr GLSceneNodeLoader::isQueued(bool *value, const GLSceneNode &node, const b
     TAKErr code(TE_Ok);
 
     Monitor::Lock lock(monitor);
-    code = lock.status; 
+    code = lock.status;
     TE_CHECKRETURN_CODE(code);
 
     if (!value)
@@ -157,64 +209,105 @@ TAKErr GLSceneNodeLoader::isQueued(bool *value, const GLSceneNode &node, const b
 
     return code;
 }
+TAKErr GLSceneNodeLoader::setView(const MapSceneModel2 &scene) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    GeoPoint2 camera;
+    if (!scene.projection || scene.projection->inverse(&camera, scene.camera.location) != TE_Ok)
+        return TE_IllegalState;
+
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+
+    if (this->view.valid &&
+        this->view.camera == camera &&
+        this->view.fov == scene.camera.fov &&
+        this->view.height == scene.height) {
+
+        return code;
+    }
+
+    this->view.valid = true;
+    this->view.camera = camera;
+    this->view.fov = scene.camera.fov;
+    this->view.height = scene.height;
+
+    // priorities are recomputed when the queues are next sorted
+    this->queueDirty = true;
+    this->prefetchDirty = true;
+    for (auto it = this->executingNodes.begin(); it != this->executingNodes.end(); ++it)
+        it->second.priority = computePriority(it->second.ctx);
+    preempt();
+
+    return code;
+}
 
-void *GLSceneNodeLoader::threadStart(void *arg) 
+void *GLSceneNodeLoader::threadStart(void *arg)
 {
     auto *loader = static_cast<GLSceneNodeLoader *>(arg);
     loader->threadImpl();
     return nullptr;
 }
 
-void GLSceneNodeLoader::threadImpl() 
+void GLSceneNodeLoader::threadImpl()
 {
     std::deque<QueueNode> *queues[] = {
            &this->queuedNodes,
            &this->prefetchNodes
     };
-    bool dirty[] = { false, false };
+    bool *dirty[] = { &this->queueDirty, &this->prefetchDirty };
 
     while (true) {
-       
+
         GLSceneNode *node = nullptr;
-        GLSceneNode::LoadContext ctx;
+        bool prefetch = false;
         bool *cancelToken = nullptr;
-        
+        GLSceneNode::LoadContext ctx;
+
         {
             Monitor::Lock lock(monitor);
             if (lock.status != TE_Ok)
                 return;
 
-            if (this->shutdown)
+            // queue is drained; return the thread to the pool. release under
+            // the lock so a concurrent `enqueue` will start a new loader
+            if (this->shutdown || (this->prefetchNodes.empty() && this->queuedNodes.empty())) {
+                this->activeLoaders--;
+                lock.broadcast();
                 break;
-
-            if (this->prefetchNodes.empty() && this->queuedNodes.empty()) {
-                lock.wait();
-                continue;
             }
 
-            dirty[0] = this->queueDirty;
-            dirty[1] = this->prefetchDirty;
-
             for (int i = 0; i < 2; i++) {
                 if (queues[i]->empty())
                     continue;
-                if (dirty[i])
-                    std::sort(queues[i]->begin(), queues[i]->end());
+                if (*dirty[i]) {
+                    for (auto it = queues[i]->begin(); it != queues[i]->end(); ++it)
+                        it->priority = computePriority(it->ctx);
+                    std::stable_sort(queues[i]->begin(), queues[i]->end());
+                    *dirty[i] = false;
+                }
 
                 node = queues[i]->front().node;
-                ctx = queues[i]->front().ctx;
+                prefetch = (i == 1);
+
+                ExecutingNode &executing = this->executingNodes[node];
+                executing.ctx = queues[i]->front().ctx;
+                executing.prefetch = prefetch;
+                executing.priority = queues[i]->front().priority;
+                executing.cancelToken = false;
+                executing.preempted = false;
+                cancelToken = &executing.cancelToken;
+                ctx = executing.ctx;
+
                 queues[i]->pop_front();
                 break;
             }
-
-            if (node == nullptr)
-                continue; // illegal state
-
-            cancelToken = &executingNodes.insert(std::make_pair(node, false)).first->second;
         }
 
         TAKErr code = node->asyncLoad(ctx, cancelToken);
-        if (code != TE_Ok) {
+        if (code != TE_Ok && code != TE_Done) {
             Logger_log(TELL_Error, "Failed to load node %s", node->info.uri.get());
         }
 
@@ -223,7 +316,59 @@ void GLSceneNodeLoader::threadImpl()
             if (lock.status != TE_Ok)
                 return;
 
-            executingNodes.erase(node);
+            auto it = this->executingNodes.find(node);
+            if (it != this->executingNodes.end()) {
+                // a preempted load yields to the more important nodes, then resumes
+                if (it->second.preempted && !this->shutdown) {
+                    std::deque<QueueNode> &requeue = it->second.prefetch ? this->prefetchNodes : this->queuedNodes;
+                    requeue.push_back(QueueNode(node, std::move(it->second.ctx)));
+                    *dirty[it->second.prefetch ? 1 : 0] = true;
+                }
+                this->executingNodes.erase(it);
+            }
         }
     }
 }
+
+double GLSceneNodeLoader::computePriority(const GLSceneNode::LoadContext &ctx) const NOTHROWS
+{
+    // without a view, nodes are started in the order they are queued
+    if (!this->view.valid || !this->view.height)
+        return 0.0;
+
+    // projected radius of the content's bounding sphere, in pixels
+    const double radius = ctx.boundingSphereRadius;
+    const double distance = std::max(GeoPoint2_slantDistance(this->view.camera, ctx.centroid), radius);
+    const double pixels = radius / MapSceneModel2_gsd(distance, this->view.fov, this->view.height);
+    return std::isnan(pixels) ? 0.0 : pixels;
+}
+
+void GLSceneNodeLoader::preempt() NOTHROWS
+{
+    if (this->executingNodes.size() < this->numThreads || this->queuedNodes.empty())
+        return;
+
+    double best = this->queuedNodes.front().priority;
+    for (auto it = this->queuedNodes.begin(); it != this->queuedNodes.end(); ++it)
+        best = std::max(best, it->priority);
+
+    // prefer to preempt prefetch loads, then the smallest on screen
+    ExecutingNode *victim = nullptr;
+    for (auto it = this->executingNodes.begin(); it != this->executingNodes.end(); ++it) {
+        ExecutingNode &candidate = it->second;
+        if (candidate.cancelToken)
+            return; // a load is already yielding
+        if (!victim ||
+            (candidate.prefetch && !victim->prefetch) ||
+            (candidate.prefetch == victim->prefetch && candidate.priority < victim->priority)) {
+
+            victim = &candidate;
+        }
+    }
+
+    if (victim && (victim->prefetch || best > PREEMPT_PRIORITY_RATIO * victim->priority)) {
+        //XXX-- need full barrier atomic exchange
+        victim->cancelToken = true;
+        victim->preempted = true;
+    }
+}
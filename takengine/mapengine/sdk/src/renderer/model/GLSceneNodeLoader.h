@@ -2,16 +2,31 @@
 #define TAK_ENGINE_RENDERER_MODEL_GLSCENENODELOADER_H_INCLUDED
 
 #include <deque>
+#include <map>
+#include "core/GeoPoint2.h"
+#include "core/MapSceneModel2.h"
 #include "port/Platform.h"
 #include "renderer/model/GLSceneNode.h"
 #include "util/Error.h"
+#include "util/Work.h"
 #include "thread/Monitor.h"
-#include "thread/ThreadPool.h"
 
 namespace TAK {
     namespace Engine {
         namespace Renderer {
             namespace Model {
+                /**
+                 * Loads scene nodes on a view borrowed from the engine-wide
+                 * CPU decode worker class.
+                 *
+                 * <P>Queued nodes are started in order of their projected
+                 * size on screen, as of the most recent view passed to
+                 * `setView`; nearby and large nodes load before distant
+                 * ones. Prefetch nodes are only started when no other
+                 * nodes are queued. If all loaders are busy and a queued
+                 * node is substantially more important than a running
+                 * load, the running load is canceled and requeued.
+                 */
                 class ENGINE_API GLSceneNodeLoader
                 {
                 public :
@@ -22,28 +37,57 @@ namespace TAK {
                     Util::TAKErr cancel(const GLSceneNode &node) NOTHROWS;
                     Util::TAKErr cancelAll() NOTHROWS;
                     Util::TAKErr isQueued(bool *value, const GLSceneNode &node, const bool prefetch) NOTHROWS;
-
+                    /**
+                     * Sets the view that loads are prioritized against. If
+                     * the camera has changed, the priorities of queued and
+                     * running loads are re-evaluated.
+                     */
+                    Util::TAKErr setView(const TAK::Engine::Core::MapSceneModel2 &scene) NOTHROWS;
                 private:
                     struct QueueNode {
                         QueueNode(GLSceneNode *node, GLSceneNode::LoadContext &&ctx) NOTHROWS;
 
+                        /** orders by descending priority */
                         bool operator<(const QueueNode &rhs) const NOTHROWS;
 
                         GLSceneNode *node;
                         GLSceneNode::LoadContext ctx;
+                        double priority;
+                    };
+                    struct ExecutingNode {
+                        GLSceneNode::LoadContext ctx;
+                        bool prefetch;
+                        double priority;
+                        /** passed to the node's load; set on cancel or preemption */
+                        bool cancelToken;
+                        /** if `true`, the node is requeued once the load yields */
+                        bool preempted;
+                    };
+                    struct View {
+                        bool valid;
+                        TAK::Engine::Core::GeoPoint2 camera;
+                        double fov;
+                        std::size_t height;
                     };
 
                     static void *threadStart(void *);
                     void threadImpl();
+                    double computePriority(const GLSceneNode::LoadContext &ctx) const NOTHROWS;
+                    /** cancels the least important running load if a queued node warrants it */
+                    void preempt() NOTHROWS;
 
-                    Thread::ThreadPoolPtr threadPool;
+                    Util::SharedWorkerPtr worker;
                     Thread::Monitor monitor;
 
                     std::deque<QueueNode> queuedNodes;
                     std::deque<QueueNode> prefetchNodes;
-                    std::map<const GLSceneNode *, bool> executingNodes;
+                    std::map<const GLSceneNode *, ExecutingNode> executingNodes;
+
+                    View view;
 
                     size_t numThreads;
+                    /** number of loader work items scheduled on the worker */
+                    size_t activeLoaders;
 
                     bool prefetchDirty;
                     bool queueDirty;
@@ -26,18 +26,81 @@ namespace
         DefaultTextureLoader(RenderContext &ctx) NOTHROWS;
     public :
         TAKErr load(TAK::Engine::Util::FutureTask<std::shared_ptr<Bitmap2>> &value, const char *uri) NOTHROWS override;
+        TAKErr getSharedKey(TAK::Engine::Port::String &value, const char *uri) NOTHROWS override;
     private :
         RenderContext &ctx;
         AsyncBitmapLoader2 *loader;
     };
 
+    typedef std::pair<std::size_t, std::shared_ptr<GLMaterial>> TextureRef;
+
+    /** textures shared by all managers, by render context and key */
+    struct SharedTextures
+    {
+        typedef std::pair<const RenderContext *, std::string> Key;
+
+        Mutex mutex;
+        std::map<Key, TextureRef> entries;
+    };
+
+    SharedTextures &sharedTextures() NOTHROWS
+    {
+        static SharedTextures registry;
+        return registry;
+    }
+
+    std::string textureKey(const char *uri, const unsigned int hints) NOTHROWS
+    {
+        // the same content may be loaded with differing compression
+        std::string key(uri);
+        key += '#';
+        key += std::to_string(hints);
+        return key;
+    }
+
+    template<typename K>
+    TAKErr acquireTexture(std::shared_ptr<GLMaterial> &value, std::map<K, TextureRef> &textures, const K &key, MaterialManager::TextureLoader &loader, const Material &m, const unsigned int hints) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        auto entry = textures.find(key);
+        if (entry == textures.end()) {
+            TAK::Engine::Util::FutureTask<std::shared_ptr<Bitmap2>> pendingTex;
+            code = loader.load(pendingTex, m.textureUri);
+            if (code != TE_Ok)
+                return code;
+
+            entry = textures.insert(std::make_pair(key, TextureRef(0u, std::shared_ptr<GLMaterial>(new GLMaterial(m, pendingTex, hints))))).first;
+        }
+        // bump the reference count
+        entry->second.first++;
+        value = entry->second.second;
+        return code;
+    }
+
+    template<typename K>
+    std::shared_ptr<GLMaterial> releaseTexture(std::map<K, TextureRef> &textures, const K &key) NOTHROWS
+    {
+        std::shared_ptr<GLMaterial> released;
+        auto entry = textures.find(key);
+        if (entry == textures.end())
+            return released;
+        // decrement the reference count; all references are unloaded, destruct
+        if (!--entry->second.first) {
+            released = std::move(entry->second.second);
+            textures.erase(entry);
+        }
+        return released;
+    }
+
+    TAKErr resolveTextureUri(std::string &value, const char *uri) NOTHROWS;
+
     void glReleaseGLMaterialTexture(void *opaque) NOTHROWS
     {
-        auto *arg = static_cast<GLMaterial *>(opaque);
-        if (arg->isLoading())
+        auto *arg = static_cast<std::shared_ptr<GLMaterial> *>(opaque);
+        if ((*arg)->isLoading())
             return; // texture was never loaded, return
 
-        GLTexture2 *tex = arg->getTexture();
+        GLTexture2 *tex = (*arg)->getTexture();
         if (tex)
             tex->release();
     }
@@ -45,6 +108,10 @@ namespace
 
 MaterialManager::TextureLoader::~TextureLoader() NOTHROWS 
 { }
+TAKErr MaterialManager::TextureLoader::getSharedKey(TAK::Engine::Port::String &value, const char *uri) NOTHROWS
+{
+    return TE_Unsupported;
+}
 
 MaterialManager::MaterialManager(RenderContext &ctx_) NOTHROWS :
     ctx(ctx_),
@@ -73,28 +140,39 @@ TAKErr MaterialManager::load(GLMaterial **value, const TAK::Engine::Model::Mater
     }
 
     TAKErr code(TE_Ok);
-    Lock lock(mutex);
-    code = lock.status;
-    TE_CHECKRETURN_CODE(code);
-
-    std::map<std::string, std::pair<std::size_t, std::unique_ptr<GLMaterial>>>::iterator entry;
-    entry = textures.find(textureUri);
-    if (entry == textures.end()) {
-        TAK::Engine::Util::FutureTask<std::shared_ptr<Bitmap2>> pendingTex;
-        code = loader->load(pendingTex, textureUri);
-
-        // unsupported, try parent
-        if (code == TE_Unsupported && this->parent)
-            return this->parent->load(value, m, hints);
-
+    {
+        Lock lock(mutex);
+        code = lock.status;
         TE_CHECKRETURN_CODE(code);
-        textures.insert(std::make_pair<std::string, std::pair<std::size_t, std::unique_ptr<GLMaterial>>>(textureUri, std::make_pair<std::size_t, std::unique_ptr<GLMaterial>>(0u, std::unique_ptr<GLMaterial>(new GLMaterial(m, pendingTex, hints)))));
-        entry = textures.find(textureUri);
+
+        // content addressable textures are shared across managers
+        TAK::Engine::Port::String sharedKey;
+        const bool shared = (loader->getSharedKey(sharedKey, textureUri) == TE_Ok && sharedKey);
+        const std::string key(textureKey(shared ? sharedKey.get() : textureUri, hints));
+
+        std::shared_ptr<GLMaterial> texture;
+        if (shared) {
+            SharedTextures &registry = sharedTextures();
+            Lock registryLock(registry.mutex);
+            code = registryLock.status;
+            TE_CHECKRETURN_CODE(code);
+
+            code = acquireTexture(texture, registry.entries, SharedTextures::Key(&ctx, key), *loader, m, hints);
+        } else {
+            code = acquireTexture(texture, textures, key, *loader, m, hints);
+        }
+        if (code == TE_Ok) {
+            // each material renders with its own properties
+            std::unique_ptr<GLMaterial> glmat(new GLMaterial(m, texture));
+            materials[glmat.get()] = std::make_pair(key, shared);
+            *value = glmat.release();
+            return code;
+        }
     }
-    // bump the reference count
-    entry->second.first++;
 
-    *value = entry->second.second.get();
+    // unsupported, try parent
+    if (code == TE_Unsupported && this->parent)
+        return this->parent->load(value, m, hints);
     return code;
 }
 void MaterialManager::unload(const GLMaterial *m)
@@ -105,7 +183,8 @@ void MaterialManager::unload(const GLMaterial *m)
         return;
     }
 
-    std::unique_ptr<GLMaterial> toDestruct;
+    std::shared_ptr<GLMaterial> toDestruct;
+    bool loadedByParent = false;
 
     do {
         TAKErr code(TE_Ok);
@@ -113,30 +192,41 @@ void MaterialManager::unload(const GLMaterial *m)
         code = lock.status;
         TE_CHECKBREAK_CODE(code);
 
-        std::map<std::string, std::pair<std::size_t, std::unique_ptr<GLMaterial>>>::iterator entry;
-        entry = textures.find(textureUri);
-        if (entry == textures.end()) {
-            Logger_log(TELL_Warning, "Invalid GLMaterial for this MaterialManager");
+        auto loaded = materials.find(m);
+        if (loaded == materials.end()) {
+            loadedByParent = !!this->parent;
+            if (!loadedByParent)
+                Logger_log(TELL_Warning, "Invalid GLMaterial for this MaterialManager");
             break;
         }
+        const std::pair<std::string, bool> key(loaded->second);
+        materials.erase(loaded);
+        delete m;
 
-        // decrement the reference count
-        entry->second.first--;
+        if (key.second) {
+            SharedTextures &registry = sharedTextures();
+            Lock registryLock(registry.mutex);
+            code = registryLock.status;
+            TE_CHECKBREAK_CODE(code);
 
-        // all references are unloaded, destruct
-        if (!entry->second.first) {
-            toDestruct = std::move(entry->second.second);
-            textures.erase(entry);
+            toDestruct = releaseTexture(registry.entries, SharedTextures::Key(&ctx, key.first));
+        } else {
+            toDestruct = releaseTexture(textures, key.first);
         }
     } while (false);
 
-    if (!toDestruct.get())
+    if (loadedByParent) {
+        this->parent->unload(m);
+        return;
+    }
+
+    if (!toDestruct)
         return;
 
     if (ctx.isRenderThread())
-        glReleaseGLMaterialTexture(toDestruct.get());
+        glReleaseGLMaterialTexture(&toDestruct);
     else
-        ctx.queueEvent(glReleaseGLMaterialTexture, std::unique_ptr<void, void(*)(const void*)>(toDestruct.release(), Memory_void_deleter_const<GLMaterial>));
+        ctx.queueEvent(glReleaseGLMaterialTexture, std::unique_ptr<void, void(*)(const void*)>(new std::shared_ptr<GLMaterial>(std::move(toDestruct)), Memory_void_deleter_const<std::shared_ptr<GLMaterial>>));
 }
 
 namespace
@@ -191,6 +281,36 @@ namespace
         if (!loader)
             return TE_IllegalState;
 
+        std::string urix;
+        TAKErr code = resolveTextureUri(urix, uri);
+        TE_CHECKRETURN_CODE(code);
+
+        AsyncBitmapLoader2::Task task;
+        code = this->loader->loadBitmapUri(task, urix.c_str());
+        TE_CHECKRETURN_CODE(code);
+
+        value = wrapBitmapLoadTask(task);
+        return code;
+    }
+    TAKErr DefaultTextureLoader::getSharedKey(TAK::Engine::Port::String &value, const char *uri) NOTHROWS
+    {
+        // mesh buffer textures are relative to the mesh
+        std::size_t bufferIndex;
+        if (Material_getBufferIndexTextureURI(&bufferIndex, uri) == TE_Ok)
+            return TE_Unsupported;
+
+        std::string urix;
+        TAKErr code = resolveTextureUri(urix, uri);
+        TE_CHECKRETURN_CODE(code);
+        value = urix.c_str();
+        return code;
+    }
+
+    TAKErr resolveTextureUri(std::string &value, const char *uri) NOTHROWS
+    {
+        if (!uri)
+            return TE_InvalidArg;
+
         std::string urix;
         if((strstr(uri, ".zip") || strstr(uri, ".kmz")) && strncmp(uri, "zip://", 6)) {
             const std::size_t len = strlen(uri);
@@ -218,11 +338,7 @@ namespace
             uri = urix.c_str();
         }
 
-        AsyncBitmapLoader2::Task task;
-        TAKErr code = this->loader->loadBitmapUri(task, uri);
-        TE_CHECKRETURN_CODE(code);
-
-        value = wrapBitmapLoadTask(task);
-        return code;
+        value = uri;
+        return TE_Ok;
     }
 }
@@ -7,6 +7,7 @@
 #include "core/MapRenderer.h"
 #include "model/Material.h"
 #include "port/Platform.h"
+#include "port/String.h"
 #include "renderer/model/GLMaterial.h"
 #include "thread/Mutex.h"
 #include "util/Error.h"
@@ -16,6 +17,18 @@ namespace TAK {
     namespace Engine {
         namespace Renderer {
             namespace Model {
+                /**
+                 * Loads `GLMaterial` instances for materials, sharing
+                 * textures between materials.
+                 *
+                 * <P>A texture is loaded once per manager for each texture
+                 * URI. If the loader provides a shared key for the URI, the
+                 * texture is further shared with every manager on the same
+                 * render context; e.g. the atlas textures of several models
+                 * from the same KMZ are decoded and uploaded once. Textures
+                 * are reference counted and released when the last material
+                 * that uses them is unloaded.
+                 */
                 class ENGINE_API MaterialManager
                 {
                 public:
@@ -31,7 +44,10 @@ namespace TAK {
                 private:
                     TAK::Engine::Core::RenderContext &ctx;
                     MaterialManager* parent;
-                    std::map<std::string, std::pair<std::size_t, std::unique_ptr<GLMaterial>>> textures;
+                    /** loader relative textures, by URI and hints */
+                    std::map<std::string, std::pair<std::size_t, std::shared_ptr<GLMaterial>>> textures;
+                    /** the texture key of each loaded, textured material; `true` if shared */
+                    std::map<const GLMaterial *, std::pair<std::string, bool>> materials;
                     TextureLoaderPtr loader;
                     Thread::Mutex mutex;
                 };
@@ -44,6 +60,17 @@ namespace TAK {
                     virtual ~TextureLoader() NOTHROWS;
                 public :
                     virtual Util::TAKErr load(TAK::Engine::Util::FutureTask<std::shared_ptr<Bitmap2>>& value, const char* uri) NOTHROWS = 0;
+                    /**
+                     * Returns a key identifying the texture content at
+                     * `uri` independent of this loader, such as the
+                     * resolved URI. Textures with equal keys are shared by
+                     * all managers on the same render context.
+                     *
+                     * <P>The default implementation returns
+                     * `TE_Unsupported`; the texture is only shared within
+                     * the manager.
+                     */
+                    virtual Util::TAKErr getSharedKey(TAK::Engine::Port::String &value, const char *uri) NOTHROWS;
                 };
             }
         }
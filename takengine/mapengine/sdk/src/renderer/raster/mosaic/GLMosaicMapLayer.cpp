@@ -5,6 +5,7 @@
 #include "port/STLSetAdapter.h"
 #include "raster/PrecisionImageryFactory.h"
 #include "raster/mosaic/MosaicDatabaseFactory2.h"
+#include "raster/mosaic/MosaicFrameIndex.h"
 #include "raster/tilereader/TileReaderFactory2.h"
 #include "renderer/core/ColorControl.h"
 #include "renderer/core/GLGlobeSurfaceRenderer.h"
@@ -310,6 +311,12 @@ Util::TAKErr GLMosaicMapLayer::createQueryContext(QueryContextPtr &value) NOTHRO
 
     TAKErr code = MosaicDatabaseFactory2_create(m->database, mosaic->getMosaicProvider());
     TE_CHECKLOGRETURN_CODE2(code, LogLevel::TELL_Error, "Failed to open mosaic %s", mosaic->getMosaicPath());
+    // answer view queries from an in-memory index of the frames, rather
+    // than issuing a database query on every view change
+    if (ConfigOptions_getIntOptionOrDefault("glmosaicmaplayer.index-frames", 1)) {
+        code = MosaicDatabase2_createIndexed(m->database, std::move(m->database));
+        TE_CHECKRETURN_CODE(code);
+    }
     code = m->database->open(mosaic->getMosaicPath());
     TE_CHECKLOGRETURN_CODE2(code, LogLevel::TELL_Error, "Failed to open mosaic %s", mosaic->getMosaicPath());
     return TE_Ok;
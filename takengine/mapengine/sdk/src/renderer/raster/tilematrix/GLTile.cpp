@@ -35,7 +35,7 @@ GLTile::GLTile(GLTiledLayerCore *core, GLTilePatch *patch, int tileX, int tileY)
       tileX(tileX),
       tileY(tileY),
       tileZ(patch->getParent()->info.level),
-      textureKey(),
+      textureKey(0u),
       borrowers(),
       tileVersion(-1),
       lastPumpDrawn(-1) {
@@ -174,7 +174,7 @@ void GLTile::unborrow() {
 bool GLTile::checkForCachedTexture() {
     if (core->textureCache == nullptr) return false;
     GLTextureCache2::EntryPtr entry(nullptr, nullptr);
-    Util::TAKErr err = core->textureCache->remove(entry, textureKey.c_str());
+    Util::TAKErr err = core->textureCache->remove(entry, textureKey);
     if (err != Util::TE_Ok) return false;
     texturePtr = std::move(entry->texture);
     textureCoordsPtr = std::move(entry->textureCoordinates);
@@ -470,7 +470,7 @@ void GLTile::release() NOTHROWS {
             GLTextureCache2::EntryPtr entry(new GLTextureCache2::Entry(std::move(texturePtr), std::move(textureCoordsPtr),
                                                                        std::move(vertexCoordsPtr), vertexCount, 0, std::move(opaque)),
                                             Util::Memory_deleter_const<GLTextureCache2::Entry>);
-            core->textureCache->put(textureKey.c_str(), std::move(entry));
+            core->textureCache->put(textureKey, std::move(entry));
         } else {
             texturePtr->release();
             texturePtr.reset();
@@ -512,10 +512,12 @@ void GLTile::resume() {
     if (state == State::SUSPENDED) state = State::UNRESOLVED;
 }
 
-std::string GLTile::getTileTextureKey(const GLTiledLayerCore &core, int zoom, int tileX, int tileY) {
-    std::stringstream ss;
-    ss << core.clientSourceUri << "{" << zoom << "," << tileX << "," << tileY << "}";
-    return ss.str();
+uint64_t GLTile::getTileTextureKey(const GLTiledLayerCore &core, int zoom, int tileX, int tileY) {
+    uint64_t key = GLTextureCache2::hashKey(core.clientSourceUri, GLTextureCache2::hashKey("GLTile"));
+    key = GLTextureCache2::hashKey(key, zoom);
+    key = GLTextureCache2::hashKey(key, tileX);
+    key = GLTextureCache2::hashKey(key, tileY);
+    return key;
 }
 
 GLTile::BitmapLoadContext::BitmapLoadContext(bool refreshOnComplete, std::shared_ptr<TAK::Engine::Raster::TileMatrix::TileMatrix> &matrix,
@@ -99,7 +99,7 @@ namespace TAK {
                         const int tileY;
                         const int tileZ;
     
-                        std::string textureKey;
+                        uint64_t textureKey;
     
                         std::set<GLTile *> borrowers;
                         std::set<BorrowRecord *> borrowRecords;
@@ -163,7 +163,7 @@ namespace TAK {
                         void suspend() override;
                         void resume() override;
 
-                        static std::string getTileTextureKey(const GLTiledLayerCore &core, int zoom, int tileX, int tileY);
+                        static uint64_t getTileTextureKey(const GLTiledLayerCore &core, int zoom, int tileX, int tileY);
 
                     private:
 
@@ -267,9 +267,9 @@ void GLTilePatch::getTiles(std::set<std::shared_ptr<GLTile>> *tiles, double minX
             int idx = ((row - gridOffsetY) * gridColumns) + (col - gridOffsetX);
             if (this->tiles_[idx].get() == nullptr) {
                 // XXX - check if texture is cached
-                std::string textureKey = GLTile::getTileTextureKey(*core_, parent_->info.level, col, row);
+                const uint64_t textureKey = GLTile::getTileTextureKey(*core_, parent_->info.level, col, row);
                 const GLTextureCache2::Entry *cacheEnt;
-                if (core_->textureCache->get(&cacheEnt, textureKey.c_str()) == TAK::Engine::Util::TE_Ok) {
+                if (core_->textureCache->get(&cacheEnt, textureKey) == TAK::Engine::Util::TE_Ok) {
                     // init tile
                     this->tiles_[idx] = std::make_shared<GLTile>(core_, this, col, row);
                     tiles->insert(this->tiles_[idx]);
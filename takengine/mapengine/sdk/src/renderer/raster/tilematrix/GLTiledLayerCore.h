@@ -106,7 +106,7 @@ namespace TAK {
                          * The bounds of the tile containing region, in the projected coordinate
                          * space of the layer.
                          */
-                        Feature::Envelope2 fullExtent;
+                        TAK::Engine::Feature::Envelope2 fullExtent;
     
                         long refreshInterval;
 
@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <iterator>
+#include <map>
 #include <sstream>
+#include <vector>
+#include "core/CameraMotionPredictor.h"
 #include "core/GeoPoint.h"
 #include "raster/DatasetDescriptor.h"
 #include "raster/osm/OSMUtils.h"
@@ -10,12 +13,14 @@
 #include "renderer/GLText2.h"
 #include "renderer/GLWireframe.h"
 #include "renderer/core/GLGlobeSurfaceRenderer.h"
+#include "renderer/core/GLMapView2.h"
 #include "renderer/map/layer/raster/gdal/GdalGraphicUtils.h"
 #include "renderer/raster/tilereader/GLTiledMapLayer2.h"
 #include "renderer/raster/tilereader/TileReadRequestPrioritizer.h"
 #include "util/BlockPoolAllocator.h"
 #include "util/ConfigOptions.h"
 #include "util/MathUtils.h"
+#include "util/Memory.h"
 
 using namespace TAK::Engine;
 using namespace TAK::Engine::Util;
@@ -26,7 +31,13 @@ using namespace TAK::Engine::Renderer;
 using namespace TAK::Engine::Renderer::Raster::TileReader;
 
 #define DEFAULT_TILE_SIZE 256u
+// prefetch reads outstanding at any time
+#define MAX_PREFETCH_REQUESTS 16u
+// prefetched tiles retained awaiting their nodes
+#define MAX_PREFETCHED_TILES 32u
 #define BITMAP_POOL_BLOCK_SIZE (DEFAULT_TILE_SIZE*DEFAULT_TILE_SIZE*4u)
+// page reads issued per frame when streaming into a page cache
+#define MAX_PAGE_READS_PER_FRAME 8u
 
 namespace {
 
@@ -48,6 +59,52 @@ namespace {
         return a;
     }
 
+    typedef std::pair<const RenderContext *, std::size_t> PageCacheKey;
+    std::map<PageCacheKey, std::weak_ptr<GLMegaTexture::PageCache>> pageCaches;
+    Thread::Mutex pageCachesMutex;
+
+    void releasePageCache(void *opaque) NOTHROWS
+    {
+        std::unique_ptr<GLMegaTexture::PageCache> cache(static_cast<GLMegaTexture::PageCache *>(opaque));
+        cache->release();
+    }
+
+    /**
+     * Returns the page cache shared by all layers with the specified tile
+     * size on the context, creating it with `capacity` pages if necessary.
+     * The page textures are deleted on the render thread once the last
+     * layer releases the cache.
+     */
+    std::shared_ptr<GLMegaTexture::PageCache> getPageCache(RenderContext &ctx, const std::size_t tileSize, const std::size_t capacity) NOTHROWS
+    {
+        Thread::Lock lock(pageCachesMutex);
+        if (lock.status != TE_Ok)
+            return std::shared_ptr<GLMegaTexture::PageCache>();
+        for (auto it = pageCaches.begin(); it != pageCaches.end();) {
+            if (it->second.expired())
+                it = pageCaches.erase(it);
+            else
+                it++;
+        }
+        const PageCacheKey key(&ctx, tileSize);
+        std::shared_ptr<GLMegaTexture::PageCache> cache(pageCaches[key].lock());
+        if (cache)
+            return cache;
+        std::unique_ptr<GLMegaTexture::PageCache> created(new(std::nothrow) GLMegaTexture::PageCache(tileSize, true, capacity));
+        if (!created)
+            return cache;
+        RenderContext *pctx = &ctx;
+        cache = std::shared_ptr<GLMegaTexture::PageCache>(created.release(), [pctx](GLMegaTexture::PageCache *p)
+        {
+            if (pctx->isRenderThread())
+                releasePageCache(p);
+            else
+                pctx->queueEvent(releasePageCache, std::unique_ptr<void, void(*)(const void *)>(p, Memory_leaker_const<void>));
+        });
+        pageCaches[key] = cache;
+        return cache;
+    }
+
     double DistanceCalculations_calculateRange(const GeoPoint2 &start, const GeoPoint2 &destination)
     {
         GeoPoint2 a(start.latitude, start.longitude, 0, AltitudeReference::HAE);
@@ -160,7 +217,7 @@ class GLQuadTileNode2::PreciseVertexResolver : public DefaultVertexResolver
         RenderRunnableOpaque(PreciseVertexResolver *owner);
     };
 
-    TAKErr preciseImageToGround(GeoPoint2 *ground, const Math::Point2<double> &image);
+    TAKErr preciseImageToGround(GeoPoint2 *ground, const Math::Point2<double> *image, const std::size_t count);
     TAKErr resolve();
     TAKErr getCacheKey(std::string *value);
     static TAKErr deserialize(MemBuffer2 &buf, SortedPointMap &precise, SortedPointSet &unresolvable);
@@ -216,6 +273,89 @@ class GLQuadTileNode2::PreciseVertexResolver : public DefaultVertexResolver
     };
 };
 
+/**
+ * Issues low priority reads for tiles expected to become visible based on
+ * recent camera motion, at the predicted level and the next coarser and finer
+ * levels. Outstanding reads are canceled when they fall outside of the latest
+ * prediction. Completed tiles are retained until the node for the tile
+ * resolves or they are evicted.
+ */
+class GLQuadTileNode2::Prefetcher : public TileReader2::AsynchronousReadRequestListener
+{
+   public:
+    Prefetcher(NodeCore &core, const int64_t horizon) NOTHROWS;
+    ~Prefetcher() NOTHROWS override;
+
+   public:
+    /**
+     * Updates the prediction for the current frame and issues and cancels
+     * reads accordingly. Must be invoked on the render thread.
+     */
+    void update(const Core::GLGlobeBase &view, const size_t level, const atakmap::math::Rectangle<double> *rois, const size_t numRois) NOTHROWS;
+    /**
+     * Transfers the data for the specified tile, if it has been prefetched.
+     */
+    bool take(Bitmap2 &value, const size_t level, const int64_t tileColumn, const int64_t tileRow) NOTHROWS;
+    /**
+     * Cancels all outstanding reads and discards all prefetched data.
+     */
+    void release() NOTHROWS;
+
+   public:
+    // TileReader2::AsynchronousReadRequestListener
+    void requestCreated(const int id) NOTHROWS override;
+    void requestStarted(const int id) NOTHROWS override;
+    void requestUpdate(const int id, const Bitmap2 &data) NOTHROWS override;
+    void requestCompleted(const int id) NOTHROWS override;
+    void requestCanceled(const int id) NOTHROWS override;
+    void requestError(const int id, const Util::TAKErr code, const char *msg) NOTHROWS override;
+
+   private:
+    void cancel(const std::vector<std::shared_ptr<TileReader2::ReadRequest>> &requests) NOTHROWS;
+
+   private:
+    struct TileKey
+    {
+        size_t level;
+        int64_t column;
+        int64_t row;
+
+        bool operator<(const TileKey &other) const NOTHROWS
+        {
+            if (level != other.level)
+                return level < other.level;
+            if (column != other.column)
+                return column < other.column;
+            return row < other.row;
+        }
+        bool operator==(const TileKey &other) const NOTHROWS
+        {
+            return level == other.level && column == other.column && row == other.row;
+        }
+    };
+    struct Pending
+    {
+        std::shared_ptr<TileReader2::ReadRequest> request;
+        Bitmap2 data;
+        bool received{false};
+    };
+    struct Fetched
+    {
+        Bitmap2 data;
+        int64_t version;
+    };
+
+    NodeCore &core;
+    TAK::Engine::Core::CameraMotionPredictor predictor;
+    const int64_t horizon;
+
+    Thread::Mutex mutex;
+    std::map<int, Pending> pending;
+    std::map<TileKey, Fetched> fetched;
+    /** fetched tiles, least recently completed first */
+    std::list<TileKey> fetchOrder;
+};
+
 struct GLQuadTileNode2::IOCallbackOpaque
 {
     enum UpdateType
@@ -242,6 +382,39 @@ struct GLQuadTileNode2::IOCallbackOpaque
         : type(type), owner(&owner), reqId(reqId)
     {}
 
+    // Used by updates staged in an upload buffer only
+    std::shared_ptr<GLTextureUploadPool> uploadPool;
+    GLTextureUploadPool::Buffer *uploadBuffer {nullptr};
+    int uploadFormat {0};
+    int uploadType {0};
+
+    IOCallbackOpaque(GLQuadTileNode2 &owner, int reqId, const Bitmap2 &data, const std::shared_ptr<GLTextureUploadPool> &pool, GLTextureUploadPool::Buffer &buffer, const Bitmap2::Format fmt, const int glFormat, const int glType) NOTHROWS
+        : type(CB_Update), owner(&owner), reqId(reqId), uploadPool(pool), uploadBuffer(&buffer), uploadFormat(glFormat), uploadType(glType)
+    {
+        bitmap.width = data.getWidth();
+        bitmap.height = data.getHeight();
+        bitmap.format = fmt;
+
+        // convert directly into the mapped buffer; the GL thread only issues
+        // the buffer-to-texture copy
+        Bitmap2 bmp(Bitmap2::DataPtr(static_cast<uint8_t *>(buffer.data), Memory_leaker_const<uint8_t>), bitmap.width, bitmap.height, fmt);
+        bmp.setRegion(data, 0, 0);
+    }
+
+    // Used by updates compressed on the reader thread only
+    std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData *)> compressed = std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData *)>(nullptr, nullptr);
+
+    IOCallbackOpaque(GLQuadTileNode2 &owner, int reqId, std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData *)> &&data) NOTHROWS
+        : type(CB_Update), owner(&owner), reqId(reqId), compressed(std::move(data))
+    {}
+
+    ~IOCallbackOpaque() NOTHROWS
+    {
+        // callbacks are always destructed on the GL thread
+        if (uploadBuffer)
+            uploadPool->recycle(*uploadBuffer);
+    }
+
     IOCallbackOpaque(GLQuadTileNode2 &owner, int reqId, const Bitmap2 &data) NOTHROWS
         : type(CB_Update), owner(&owner), reqId(reqId)
     {
@@ -334,6 +507,7 @@ GLQuadTileNode2::GLQuadTileNode2()
       queued_callbacks_(),
       centroid_(),
       centroid_proj_(),
+      page_index_{0u, 0u, 0u},
       min_lat_(0),
       min_lng_(0),
       max_lat_(0),
@@ -360,7 +534,7 @@ GLQuadTileNode2::GLQuadTileNode2()
       debug_draw_indices_(nullptr, Memory_array_deleter_const<uint16_t>),
       debug_draw_indices_capacity_(0),
       debug_draw_indices_count_(0),
-      texture_key_("")
+      texture_key_(0u)
 {}
 
 GLQuadTileNode2::~GLQuadTileNode2()
@@ -500,7 +674,7 @@ TAKErr GLQuadTileNode2::super_set(int64_t tileColumn, int64_t tileRow, size_t le
     this->tile_column_ = tileColumn;
     this->tile_row_ = tileRow;
     this->level_ = level;
-    this->texture_key_ = "";
+    this->texture_key_ = 0u;
     this->tile_version_ = -1;
 
     Bitmap2::Format tileFmt;
@@ -623,8 +797,12 @@ void GLQuadTileNode2::releaseTexture()
             Memory_deleter_const<GLTextureCache2::Entry>);
         this->core_->textureCache->put(getTextureKey(), std::move(ent));
     } else {
-        this->texture_->release();
-        this->texture_.reset();
+        if (this->core_->texturePool) {
+            this->core_->texturePool->recycle(std::move(this->texture_));
+        } else {
+            this->texture_->release();
+            this->texture_.reset();
+        }
         this->texture_coordinates_.reset();
         this->vertex_coordinates_.reset();
         this->gl_tex_coord_indices_.reset();
@@ -659,6 +837,14 @@ void GLQuadTileNode2::release() NOTHROWS
             // vertex resolver is to be released prior to I2G functions
             core_->vertexResolver->release();
             this->core_->progressiveLoading = false;
+            if (core_->uploadPool)
+                core_->uploadPool->release();
+            if (core_->texturePool)
+                core_->texturePool->release();
+            if (core_->prefetcher)
+                core_->prefetcher->release();
+            if (core_->megaTexture)
+                core_->megaTexture->release();
         }
     } else {
         this->parent_ = nullptr;
@@ -693,7 +879,7 @@ void GLQuadTileNode2::super_release()
     this->tile_column_ = -1;
     this->tile_row_ = -1;
     this->level_ = -1;
-    this->texture_key_ = "";
+    this->texture_key_ = 0u;
 
     this->texture_coords_valid_ = false;
 
@@ -816,11 +1002,19 @@ TAKErr GLQuadTileNode2::validateTexture()
 {
     if (this->texture_ == nullptr || this->texture_->getTexWidth() < this->tile_width_ || this->texture_->getTexHeight() < this->tile_height_ ||
         this->texture_->getFormat() != this->gl_tex_format_ || this->texture_->getType() != this->gl_tex_type_) {
-        if (this->texture_.get() != nullptr)
-            this->texture_->release();
-
-        this->texture_ = GLTexture2Ptr(new GLTexture2(static_cast<int>(this->tile_width_), static_cast<int>(this->tile_height_), this->gl_tex_format_, this->gl_tex_type_),
-                                      Memory_deleter_const<GLTexture2>);
+        if (this->core_->texturePool) {
+            // reuse the storage of a released tile texture, if available
+            if (this->texture_.get() != nullptr)
+                this->core_->texturePool->recycle(std::move(this->texture_));
+            this->core_->texturePool->acquire(this->texture_, this->tile_width_, this->tile_height_, this->gl_tex_format_, this->gl_tex_type_);
+        } else {
+            if (this->texture_.get() != nullptr)
+                this->texture_->release();
+            this->texture_.reset();
+        }
+        if (!this->texture_)
+            this->texture_ = GLTexture2Ptr(new GLTexture2(static_cast<int>(this->tile_width_), static_cast<int>(this->tile_height_), this->gl_tex_format_, this->gl_tex_type_),
+                                          Memory_deleter_const<GLTexture2>);
 
         this->texture_coords_valid_ = false;
         this->texture_coordinates_.reset();
@@ -861,8 +1055,9 @@ TAKErr GLQuadTileNode2::validateTexVerts()
             this->vertex_coordinates_.reset(new float[this->vertex_coordinates_capacity_]);
         }
 
-        const float x = ((float)this->tile_width_ / (float)this->texture_->getTexWidth());
-        const float y = ((float)this->tile_height_ / (float)this->texture_->getTexHeight());
+        // streamed tiles compute their coordinates into the page
+        const float x = this->texture_ ? ((float)this->tile_width_ / (float)this->texture_->getTexWidth()) : 1.0f;
+        const float y = this->texture_ ? ((float)this->tile_height_ / (float)this->texture_->getTexHeight()) : 1.0f;
 
         code = GLTexture2_createQuadMeshTexCoords(this->texture_coordinates_.get(), atakmap::math::Point<float>(0, 0),
                                                   atakmap::math::Point<float>(x, 0), atakmap::math::Point<float>(x, y),
@@ -980,6 +1175,11 @@ void GLQuadTileNode2::draw(const Renderer::Core::GLGlobeBase &view, const int re
 #endif
 
     core_->tilesThisFrame = 0;
+    if (core_->uploadPool)
+        core_->uploadPool->prepare();
+    // the reader threads select the compressed format from the detected support
+    if (core_->compressTextures)
+        GLTexture2_detectSupportedCompression();
     int64_t trw, trh;
     code = this->core_->tileReader->getWidth(&trw);
     TE_CHECKRETURN(code);
@@ -1037,6 +1237,8 @@ void GLQuadTileNode2::draw(const Renderer::Core::GLGlobeBase &view, const int re
     if (this->last_touch2_ != view.renderPass->renderPump) {
         // XXX - 
         this->core_->readRequestPrioritizer->update(poiX, poiY, this->core_->drawROI, numRois);
+        if (this->core_->prefetcher)
+            this->core_->prefetcher->update(view, std::min(level, root_->level_), this->core_->drawROI, numRois);
     }
 
     code = TE_Ok;
@@ -1069,6 +1271,13 @@ void GLQuadTileNode2::draw(const Renderer::Core::GLGlobeBase &view, const int re
     if (this->core_->tileReader.get() != nullptr)
         this->core_->tileReader->stop();
 
+    // service the page requests made by the nodes drawn this frame
+    if (this->core_->megaTexture) {
+        this->core_->megaTexture->update(MAX_PAGE_READS_PER_FRAME);
+        if (this->core_->megaTexture->isLoading())
+            this->core_->context->requestRefresh();
+    }
+
     // Log.v(TAG, "Tiles this frame: " + core->tilesThisFrame);
 
     if(!view.multiPartPass)
@@ -1190,6 +1399,11 @@ void GLQuadTileNode2::resolveTexture()
                     this->gl_tex_format_ = GL_RGBA;
             }
 
+            // compressed textures are not color-renderable
+            if (this->texture_ && this->texture_->isCompressed()) {
+                this->texture_->release();
+                this->texture_.reset();
+            }
             this->validateTexture();
             this->texture_->init();
 
@@ -1373,6 +1587,14 @@ TAKErr GLQuadTileNode2::super_resolveTexture()
             this->tile_column_,
             this->tile_row_, this));
     this->read_requests_.push_back(this->current_request_);
+    Bitmap2 prefetched;
+    if (this->core_->prefetcher && this->core_->prefetcher->take(prefetched, this->level_, this->tile_column_, this->tile_row_)) {
+        // the tile was loaded ahead of the camera, deliver it without a read
+        const int id = this->current_request_->id;
+        this->requestUpdate(id, prefetched);
+        this->requestCompleted(id);
+        return TE_Ok;
+    }
     this->core_->asyncio->asyncRead(this->current_request_);
     return TE_Ok;
 }
@@ -1601,36 +1823,44 @@ void GLQuadTileNode2::setLCS(const Renderer::Core::GLGlobeBase &view)
 
 void GLQuadTileNode2::super_drawTexture(const Renderer::Core::GLGlobeBase &view, Renderer::GLTexture2 *tex, float *texCoords)
 {
-    atakmap::renderer::GLES20FixedPipeline *fixedPipe = atakmap::renderer::GLES20FixedPipeline::getInstance();
-    fixedPipe->glPushMatrix();
-    setLCS(view);
-
     float fade = (tex == this->texture_.get() && this->core_->fadeTimerLimit > 0)
                      ? ((float)(this->core_->fadeTimerLimit - this->fade_timer_) / (float)this->core_->fadeTimerLimit)
                      : 1.0f;
 
+    drawTextureImpl(view, tex->getTexId(), texCoords, fade);
+}
+
+void GLQuadTileNode2::drawTextureImpl(const Renderer::Core::GLGlobeBase &view, const GLuint texId, const float *texCoords, const float alpha)
+{
+    atakmap::renderer::GLES20FixedPipeline *fixedPipe = atakmap::renderer::GLES20FixedPipeline::getInstance();
+    fixedPipe->glPushMatrix();
+    setLCS(view);
+
     if (gl_tex_coord_indices_ == nullptr) {
-        GLTexture2_draw(tex->getTexId(), GL_TRIANGLE_STRIP, this->gl_tex_grid_vert_count_, 2, GL_FLOAT, texCoords, 3, GL_FLOAT,
+        GLTexture2_draw(texId, GL_TRIANGLE_STRIP, this->gl_tex_grid_vert_count_, 2, GL_FLOAT, texCoords, 3, GL_FLOAT,
                         this->vertex_coordinates_.get(), this->core_->colorR, this->core_->colorG, this->core_->colorB,
-                        fade * this->core_->colorA);
+                        alpha * this->core_->colorA);
     } else {
-        GLTexture2_draw(tex->getTexId(), GL_TRIANGLE_STRIP, this->gl_tex_grid_idx_count_, 2, GL_FLOAT, texCoords, 3, GL_FLOAT,
+        GLTexture2_draw(texId, GL_TRIANGLE_STRIP, this->gl_tex_grid_idx_count_, 2, GL_FLOAT, texCoords, 3, GL_FLOAT,
                         this->vertex_coordinates_.get(), GL_UNSIGNED_SHORT, this->gl_tex_coord_indices_.get(), this->core_->colorR,
-                        this->core_->colorG, this->core_->colorB, fade * this->core_->colorA);
+                        this->core_->colorG, this->core_->colorB, alpha * this->core_->colorA);
     }
     fixedPipe->glPopMatrix();
 
     core_->tilesThisFrame++;
 }
 
-const char *GLQuadTileNode2::getTextureKey()
+uint64_t GLQuadTileNode2::getTextureKey()
 {
-    if (texture_key_.empty()) {
-        std::stringstream sstr;
-        sstr << core_->uri << "," << level_ << "," << tile_column_ << "," << tile_row_;
-        texture_key_ = sstr.str();
+    if (!texture_key_) {
+        uint64_t key = GLTextureCache2::hashKey(core_->uri.c_str(), GLTextureCache2::hashKey("GLQuadTileNode2"));
+        key = GLTextureCache2::hashKey(key, level_);
+        key = GLTextureCache2::hashKey(key, tile_column_);
+        key = GLTextureCache2::hashKey(key, tile_row_);
+        // zero is reserved to mark the key invalid
+        texture_key_ = key ? key : 1u;
     }
-    return texture_key_.c_str();
+    return texture_key_;
 }
 
 void GLQuadTileNode2::invalidateVertexCoords()
@@ -1678,6 +1908,11 @@ void GLQuadTileNode2::drawImpl(const Renderer::Core::GLGlobeBase &view)
 
 void GLQuadTileNode2::super_draw(const Renderer::Core::GLGlobeBase &view)
 {
+    if (this->core_->megaTexture) {
+        this->drawVirtual(view);
+        return;
+    }
+
     if (this->core_->textureCache != nullptr && !((this->state_ == State::RESOLVED) || this->received_update_))
         this->useCachedTexture();
 
@@ -1736,6 +1971,46 @@ void GLQuadTileNode2::super_draw(const Renderer::Core::GLGlobeBase &view)
         this->debugDraw(view);
 }
 
+void GLQuadTileNode2::drawVirtual(const Renderer::Core::GLGlobeBase &view)
+{
+    GLMegaTexture &megaTexture = *this->core_->megaTexture;
+    const std::size_t numLevels = megaTexture.getNumLevels();
+    GLMegaTexture::TileIndex key;
+    if (GLMegaTexture_getTileIndex(&key, numLevels, this->level_, this->tile_column_, this->tile_row_) != TE_Ok)
+        return;
+    megaTexture.requestTile(key);
+
+    // draw the nearest resident ancestor until the tile is paged in
+    GLMegaTexture::TileIndex resident;
+    if (megaTexture.getResidentTile(&resident, key) != TE_Ok) {
+        this->state_ = State::RESOLVING;
+        return;
+    }
+    this->state_ = (resident.level == key.level) ? State::RESOLVED : State::RESOLVING;
+
+    const bool gridChanged = !this->texture_coords_valid_;
+    if (this->validateTexVerts() != TE_Ok)
+        return;
+    if (gridChanged ||
+        resident.level != this->page_index_.level ||
+        resident.column != this->page_index_.column ||
+        resident.row != this->page_index_.row) {
+
+        this->page_texture_coordinates_.resize((this->gl_tex_grid_width_ + 1u) * (this->gl_tex_grid_height_ + 1u) * 2u);
+        if (GLMegaTexture_getTexCoords(this->page_texture_coordinates_.data(), resident, numLevels, megaTexture.getTileSize(),
+                                       this->tile_src_x_, this->tile_src_y_, this->tile_src_width_, this->tile_src_height_,
+                                       this->gl_tex_grid_width_, this->gl_tex_grid_height_) != TE_Ok) {
+            this->page_texture_coordinates_.clear();
+            return;
+        }
+        this->page_index_ = resident;
+    }
+
+    if (this->validateVertexCoords(view) != TE_Ok)
+        return;
+    drawTextureImpl(view, megaTexture.getTile(resident), this->page_texture_coordinates_.data(), 1.0f);
+}
+
 void GLQuadTileNode2::debugDraw(const Renderer::Core::GLGlobeBase &view)
 {
     this->validateVertexCoords(view);
@@ -2102,7 +2377,49 @@ void GLQuadTileNode2::rendererIORunnableImpl(IOCallbackOpaque *iocb)
                 break;
 
             case IOCallbackOpaque::UpdateType::CB_Update:
-                if (iocb->bitmap.data.get()) {
+                if (iocb->compressed) {
+                    GLTexture2Ptr compressed(nullptr, nullptr);
+                    if (GLTexture2_createCompressedTexture(compressed, *iocb->compressed) == TE_Ok) {
+                        if (this->texture_)
+                            this->texture_->release();
+                        this->texture_ = std::move(compressed);
+                        this->texture_coords_valid_ = false;
+                        this->received_update_ = true;
+                    } else {
+                        // XXX - should be packaged in read request
+                        this->core_->tileReader->getTileVersion(&this->tile_version_, this->current_request_->level, this->current_request_->tileColumn,
+                                                               this->current_request_->tileRow);
+
+                        this->state_ = State::UNRESOLVABLE;
+                    }
+                    iocb->compressed.reset();
+                    break;
+                }
+                // compressed textures cannot be partially updated
+                if (this->texture_->isCompressed()) {
+                    this->texture_->release();
+                    this->texture_.reset();
+                    this->validateTexture();
+                }
+                if (iocb->uploadBuffer) {
+                    TAKErr code(TE_IllegalState);
+                    GLTextureUploadPool::Buffer &staged = *iocb->uploadBuffer;
+                    iocb->uploadBuffer = nullptr;
+                    // the texture may have been reconfigured since the data was staged
+                    if (this->texture_->getFormat() == iocb->uploadFormat && this->texture_->getType() == iocb->uploadType)
+                        code = iocb->uploadPool->upload(*this->texture_, staged, 0, 0, iocb->bitmap.width, iocb->bitmap.height);
+                    else
+                        iocb->uploadPool->recycle(staged);
+                    if (code == TE_Ok) {
+                        this->received_update_ = true;
+                    } else {
+                        // XXX - should be packaged in read request
+                        this->core_->tileReader->getTileVersion(&this->tile_version_, this->current_request_->level, this->current_request_->tileColumn,
+                                                               this->current_request_->tileRow);
+
+                        this->state_ = State::UNRESOLVABLE;
+                    }
+                } else if (iocb->bitmap.data.get()) {
                     this->texture_->load(Bitmap2(Bitmap2::DataPtr(static_cast<uint8_t *>(iocb->bitmap.data.get()), Memory_leaker_const<uint8_t>), iocb->bitmap.width, iocb->bitmap.height, iocb->bitmap.format));
                     iocb->bitmap.data.reset();
                     this->received_update_ = true;
@@ -2169,7 +2486,45 @@ void GLQuadTileNode2::requestUpdate(const int id, const Bitmap2 &data) NOTHROWS
     TAKErr code(TE_Ok);
     TE_BEGIN_TRAP()
     {
-        queueGLCallback(new IOCallbackOpaque(*this, curid, data));
+        const int glFormat = this->gl_tex_format_;
+        const int glType = this->gl_tex_type_;
+
+        // compress full, power-of-two tiles; the texture dimensions must
+        // match the compressed storage
+        if (this->core_->compressTextures &&
+            data.getWidth() == this->tile_width_ && data.getHeight() == this->tile_height_ &&
+            data.getWidth() >= 4u && !(data.getWidth() & (data.getWidth() - 1u)) &&
+            data.getHeight() >= 4u && !(data.getHeight() & (data.getHeight() - 1u))) {
+
+            std::unique_ptr<GLCompressedTextureData, void(*)(GLCompressedTextureData *)> compressed(nullptr, nullptr);
+            int compressedFormat;
+            int compressedType;
+            if (GLTexture2_createCompressedTextureData(compressed, data) == TE_Ok &&
+                GLTexture2_getFormatAndDataType(&compressedFormat, &compressedType, compressed->cbfmt) == TE_Ok &&
+                compressedFormat == glFormat && compressedType == glType) {
+
+                queueGLCallback(new IOCallbackOpaque(*this, curid, std::move(compressed)));
+                return;
+            }
+        }
+
+        // stage the data in a mapped upload buffer if one is available
+        std::shared_ptr<GLTextureUploadPool> uploadPool(this->core_->uploadPool);
+        Bitmap2::Format uploadFmt;
+        std::size_t pixelSize;
+        GLTextureUploadPool::Buffer *staging = nullptr;
+        if (uploadPool &&
+            GLTexture2_getBitmapFormat(&uploadFmt, glFormat, glType) == TE_Ok &&
+            Bitmap2_formatPixelSize(&pixelSize, uploadFmt) == TE_Ok &&
+            (data.getWidth()*data.getHeight()*pixelSize) <= uploadPool->getBufferSize()) {
+
+            staging = uploadPool->acquire();
+        }
+
+        if (staging)
+            queueGLCallback(new IOCallbackOpaque(*this, curid, data, uploadPool, *staging, uploadFmt, glFormat, glType));
+        else
+            queueGLCallback(new IOCallbackOpaque(*this, curid, data));
     }
     TE_END_TRAP(code);
 }
@@ -2264,6 +2619,7 @@ GLQuadTileNode2::NodeCore::NodeCore(TAK::Engine::Core::RenderContext *context, c
       context(context),
       textureBorrowEnabled(false),
       textureCopyEnabled(false),
+      compressTextures(false),
       gsd(0.0),
       vertexResolver(nullptr),
       textureCache(opts.textureCache),
@@ -2316,6 +2672,33 @@ GLQuadTileNode2::NodeCore::NodeCore(TAK::Engine::Core::RenderContext *context, c
 
         this->textureBorrowEnabled = (ConfigOptions_getIntOptionOrDefault("imagery.texture-borrow", 1) != 0);
         this->textureCopyEnabled = (ConfigOptions_getIntOptionOrDefault("imagery.texture-copy", 1) != 0);
+        this->compressTextures = (ConfigOptions_getIntOptionOrDefault("imagery.compress-textures", 0) != 0);
+
+        // tiles are streamed into a fixed size page cache shared by the
+        // layers on the context, bounding GPU memory for any number of
+        // layers. the page size must match the tile size
+        const int virtualTexturePages = ConfigOptions_getIntOptionOrDefault("imagery.virtual-texture-pages", 0);
+        if (virtualTexturePages > 0 && this->context) {
+            std::size_t tileWidth, tileHeight;
+            if (this->tileReader->getTileWidth(&tileWidth) == TE_Ok && this->tileReader->getTileHeight(&tileHeight) == TE_Ok && tileWidth == tileHeight) {
+                this->pageCache = getPageCache(*this->context, tileWidth, static_cast<std::size_t>(virtualTexturePages));
+                if (this->pageCache)
+                    this->megaTexture.reset(new(std::nothrow) GLMegaTexture(this->tileReader, this->pageCache));
+            }
+        }
+        const int uploadBuffers = ConfigOptions_getIntOptionOrDefault("glquadtilenode2.upload-buffers", 4);
+        if (uploadBuffers > 0 && !this->megaTexture) {
+            std::size_t tileWidth, tileHeight;
+            if (this->tileReader->getTileWidth(&tileWidth) == TE_Ok && this->tileReader->getTileHeight(&tileHeight) == TE_Ok)
+                this->uploadPool.reset(new(std::nothrow) GLTextureUploadPool(tileWidth * tileHeight * 4u, static_cast<std::size_t>(uploadBuffers)));
+        }
+        // number of released tile textures retained for reuse
+        const int pooledTextures = ConfigOptions_getIntOptionOrDefault("glquadtilenode2.pooled-textures", 16);
+        if (pooledTextures > 0 && !this->megaTexture) {
+            std::size_t tileWidth, tileHeight;
+            if (this->tileReader->getTileWidth(&tileWidth) == TE_Ok && this->tileReader->getTileHeight(&tileHeight) == TE_Ok)
+                this->texturePool.reset(new(std::nothrow) GLTexturePool(tileWidth * tileHeight * 4u * static_cast<std::size_t>(pooledTextures)));
+        }
 
         int64_t trw, trh;
         this->status = this->tileReader->getWidth(&trw);
@@ -2359,6 +2742,10 @@ GLQuadTileNode2::NodeCore::NodeCore(TAK::Engine::Core::RenderContext *context, c
         if(this->tileReader)
             this->asyncio->setReadRequestPrioritizer(*this->tileReader, ReadRequestPrioritizerPtr(this->readRequestPrioritizer.get(), Memory_leaker_const<TileReader2::ReadRequestPrioritizer>));
 
+        const int prefetchHorizon = ConfigOptions_getIntOptionOrDefault("imagery.prefetch-horizon", 500);
+        if (prefetchHorizon > 0 && !this->megaTexture)
+            this->prefetcher.reset(new(std::nothrow) Prefetcher(*this, prefetchHorizon));
+
         // successfully initialized
         this->status = TE_Ok;
     } while (false);
@@ -2366,6 +2753,8 @@ GLQuadTileNode2::NodeCore::NodeCore(TAK::Engine::Core::RenderContext *context, c
 
 GLQuadTileNode2::NodeCore::~NodeCore() NOTHROWS
 {
+    // outstanding prefetch reads reference the reader
+    this->prefetcher.reset();
     // clear the prioritizer
     if(this->asyncio && this->tileReader)
         this->asyncio->setReadRequestPrioritizer(*this->tileReader, ReadRequestPrioritizerPtr(nullptr, Memory_leaker_const<TileReader2::ReadRequestPrioritizer>));
@@ -2782,11 +3171,48 @@ void GLQuadTileNode2::PreciseVertexResolver::nodeDestroying(GLQuadTileNode2 *nod
     }
 }
 
-TAKErr GLQuadTileNode2::PreciseVertexResolver::preciseImageToGround(GeoPoint2 *ground, const Math::Point2<double> &image)
+TAKErr GLQuadTileNode2::PreciseVertexResolver::preciseImageToGround(GeoPoint2 *ground, const Math::Point2<double> *image, const std::size_t count)
 {
-    bool isPrecise = false;
-    if (owner->imageToGround(ground, &isPrecise, image) != TE_Ok || !isPrecise)
-        return TE_Err;
+    TAKErr code(TE_Ok);
+
+    if (owner->core_->precise.get() == nullptr)
+        return TE_IllegalState;
+
+    code = owner->core_->precise->imageToGround(ground, image, count);
+    TE_CHECKRETURN_CODE(code);
+
+    // make sure each precise I2G value falls within the maximum allowed
+    // error; see GLQuadTileNode2::imageToGround
+    std::vector<GeoPoint2> imprecise(count);
+    code = owner->core_->imprecise->imageToGround(imprecise.data(), image, count);
+    TE_CHECKRETURN_CODE(code);
+
+    size_t tileWidth, tileHeight;
+    code = owner->core_->tileReader->getTileWidth(&tileWidth);
+    TE_CHECKRETURN_CODE(code);
+    code = owner->core_->tileReader->getTileHeight(&tileHeight);
+    TE_CHECKRETURN_CODE(code);
+    const double maxErrPixels = sqrt((tileWidth * tileWidth) + (tileHeight * tileHeight)) / 8.0;
+
+    for (std::size_t i = 0u; i < count; i++) {
+        if (std::isnan(ground[i].latitude) || std::isnan(ground[i].longitude))
+            continue;
+        if (std::isnan(imprecise[i].latitude) || std::isnan(imprecise[i].longitude)) {
+            ground[i] = GeoPoint2(NAN, NAN);
+            continue;
+        }
+
+        const double err = DistanceCalculations_calculateRange(ground[i], imprecise[i]);
+        const int errPixels = (int)(err / owner->core_->gsd);
+        if (errPixels > maxErrPixels) {
+            Port::String s;
+            owner->getType(s);
+            Util::Logger_log(LogLevel::TELL_Warning,
+                             "Large discrepency observed for %s imageToGround, discarding point (error=%f m, %d px)", s.get(), err,
+                             errPixels);
+            ground[i] = GeoPoint2(NAN, NAN);
+        }
+    }
 
     return TE_Ok;
 }
@@ -2871,44 +3297,55 @@ void *GLQuadTileNode2::PreciseVertexResolver::threadRun(void *opaque)
 
 void GLQuadTileNode2::PreciseVertexResolver::threadRunImpl()
 {
-    Math::Point2<int64_t> processL;
-    bool havePoint = false;
-    Math::Point2<double> processD(0, 0);
-    GeoPoint2 result;
-    bool haveResult = false;
+    // queued vertices are resolved in batches, allowing the precise
+    // projection to solve all vertices in the batch together
+    const std::size_t maxBatchSize = 64u;
+
+    std::vector<Math::Point2<int64_t>> processL;
+    std::vector<Math::Point2<double>> processD;
+    std::vector<GeoPoint2> result;
+    processL.reserve(maxBatchSize);
     while (true) {
         {
             Thread::Lock lock(this->syncOn);
 
-            if (haveResult)
-                this->precise.insert(SortedPointMap::value_type(processL, result));
-            else if (havePoint)
-                this->unresolvable.insert(processL);
-
-            if (havePoint) {
-                this->pending.erase(processL);
+            for (std::size_t i = 0u; i < processL.size(); i++) {
+                if (!std::isnan(result[i].latitude) && !std::isnan(result[i].longitude))
+                    this->precise.insert(SortedPointMap::value_type(processL[i], result[i]));
+                else
+                    this->unresolvable.insert(processL[i]);
+                this->pending.erase(processL[i]);
+            }
 
+            if (!processL.empty()) {
                 // Convert to renderthread
                 queueGLCallback(new RenderRunnableOpaque(this));
             }
 
-            havePoint = haveResult = false;
+            processL.clear();
             if (this->activeID != Thread::Thread_currentThreadID())
                 break;
             if (this->queue.size() < 1) {
                 cv.wait(lock);
                 continue;
             }
-            processL = this->queue.front();
-            this->queue.pop_front();
-            havePoint = true;
+            while (!this->queue.empty() && processL.size() < maxBatchSize) {
+                processL.push_back(this->queue.front());
+                this->queue.pop_front();
+            }
         }
 
-        processD.x = static_cast<double>(processL.x);
-        processD.y = static_cast<double>(processL.y);
-        TAKErr code = this->preciseImageToGround(&result, processD);
-        if (code == TE_Ok && !std::isnan(result.latitude) && !std::isnan(result.longitude))
-            haveResult = true;
+        processD.resize(processL.size());
+        result.resize(processL.size());
+        for (std::size_t i = 0u; i < processL.size(); i++) {
+            processD[i].x = static_cast<double>(processL[i].x);
+            processD[i].y = static_cast<double>(processL[i].y);
+        }
+        TAKErr code = this->preciseImageToGround(result.data(), processD.data(), processL.size());
+        if (code != TE_Ok) {
+            for (std::size_t i = 0u; i < result.size(); i++)
+                result[i] = GeoPoint2(NAN, NAN);
+        }
     }
 
     {
@@ -3009,3 +3446,246 @@ GLQuadTileNode2::PreciseVertexResolver::RenderRunnableOpaque::RenderRunnableOpaq
                                                                                    GLQuadTileNode2 *node, int targetGridWidth)
     : owner(owner), eventType(END_DRAW), node(node), targetGridWidth(targetGridWidth)
 {}
+
+/**********************************************************************/
+// Prefetcher
+
+GLQuadTileNode2::Prefetcher::Prefetcher(NodeCore &core_, const int64_t horizon_) NOTHROWS :
+    core(core_),
+    horizon(horizon_)
+{}
+
+GLQuadTileNode2::Prefetcher::~Prefetcher() NOTHROWS
+{
+    release();
+}
+
+void GLQuadTileNode2::Prefetcher::update(const Core::GLGlobeBase &view, const size_t level, const atakmap::math::Rectangle<double> *rois, const size_t numRois) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+
+    predictor.update(view.renderPass->scene, Port::Platform_systime_millis());
+
+    std::vector<std::shared_ptr<TileReader2::ReadRequest>> canceled;
+
+    // XXX - prediction across the IDL is not supported
+    TAK::Engine::Core::MapSceneModel2 predicted;
+    GeoPoint2 predictedFocus;
+    Math::Point2<double> poi;
+    Math::Point2<double> predictedPoi;
+    if (numRois != 1u ||
+        view.renderPass->scene.gsd <= 0.0 ||
+        predictor.predict(&predicted, horizon) != TE_Ok ||
+        predicted.projection->inverse(&predictedFocus, predicted.camera.target) != TE_Ok ||
+        core.imprecise->groundToImage(&poi, GeoPoint2(view.renderPass->drawLat, view.renderPass->drawLng)) != TE_Ok ||
+        core.imprecise->groundToImage(&predictedPoi, predictedFocus) != TE_Ok) {
+
+        // no valid prediction, anything outstanding was mispredicted
+        {
+            Thread::Lock lock(mutex);
+            for (auto &p : pending)
+                canceled.push_back(p.second.request);
+        }
+        cancel(canceled);
+        return;
+    }
+
+    int64_t trw, trh;
+    code = core.tileReader->getWidth(&trw);
+    TE_CHECKRETURN(code);
+    code = core.tileReader->getHeight(&trh);
+    TE_CHECKRETURN(code);
+
+    // the predicted ROI is the current ROI, translated to the predicted focus
+    // and scaled by the change in resolution
+    const double zoom = predicted.gsd / view.renderPass->scene.gsd;
+    const atakmap::math::Rectangle<double> &roi = rois[0];
+    const double minX = MathUtils_clamp(predictedPoi.x + (roi.x - poi.x) * zoom, 0.0, (double)trw);
+    const double minY = MathUtils_clamp(predictedPoi.y + (roi.y - poi.y) * zoom, 0.0, (double)trh);
+    const double maxX = MathUtils_clamp(predictedPoi.x + (roi.x + roi.width - poi.x) * zoom, 0.0, (double)trw);
+    const double maxY = MathUtils_clamp(predictedPoi.y + (roi.y + roi.height - poi.y) * zoom, 0.0, (double)trh);
+    if (maxX <= minX || maxY <= minY) {
+        {
+            Thread::Lock lock(mutex);
+            for (auto &p : pending)
+                canceled.push_back(p.second.request);
+        }
+        cancel(canceled);
+        return;
+    }
+
+    // select the level for the predicted resolution, consistent with `draw`
+    const double scale = core.gsd / (view.renderPass->drawMapResolution * zoom);
+    const size_t predictedLevel = std::min((size_t)ceil(std::max((log(1.0 / scale) / log(2.0)) + core.options.levelTransitionAdjustment, 0.0)), level + 1u);
+    const size_t minLevel = predictedLevel ? predictedLevel - 1u : 0u;
+    const size_t maxLevel = predictedLevel + 1u;
+
+    {
+        Thread::Lock lock(mutex);
+
+        // cancel the reads that are no longer predicted
+        for (auto &p : pending) {
+            const TileReader2::ReadRequest &request = *p.second.request;
+            if ((size_t)request.level < minLevel || (size_t)request.level > maxLevel ||
+                !atakmap::math::Rectangle<double>::intersects(minX, minY, maxX, maxY, (double)request.srcX, (double)request.srcY, (double)(request.srcX + request.srcW), (double)(request.srcY + request.srcH))) {
+                canceled.push_back(p.second.request);
+            }
+        }
+    }
+    cancel(canceled);
+
+    size_t maxReaderLevel;
+    code = core.tileReader->getMaximumNumResolutionLevels(&maxReaderLevel);
+    TE_CHECKRETURN(code);
+
+    // issue reads, predicted level first
+    const size_t levels[3u] = { predictedLevel, predictedLevel + 1u, predictedLevel - 1u };
+    for (std::size_t i = 0u; i < 3u; i++) {
+        const size_t lvl = levels[i];
+        if (lvl >= maxReaderLevel || lvl < minLevel || lvl > maxLevel)
+            continue;
+
+        int64_t minCol, minRow, maxCol, maxRow, numTilesX, numTilesY;
+        if (core.tileReader->getTileColumn(&minCol, lvl, (int64_t)minX) != TE_Ok ||
+            core.tileReader->getTileRow(&minRow, lvl, (int64_t)minY) != TE_Ok ||
+            core.tileReader->getTileColumn(&maxCol, lvl, (int64_t)maxX) != TE_Ok ||
+            core.tileReader->getTileRow(&maxRow, lvl, (int64_t)maxY) != TE_Ok ||
+            core.tileReader->getNumTilesX(&numTilesX, lvl) != TE_Ok ||
+            core.tileReader->getNumTilesY(&numTilesY, lvl) != TE_Ok) {
+
+            continue;
+        }
+        maxCol = std::min(maxCol, numTilesX - 1);
+        maxRow = std::min(maxRow, numTilesY - 1);
+
+        for (int64_t row = std::max(minRow, (int64_t)0); row <= maxRow; row++) {
+            for (int64_t col = std::max(minCol, (int64_t)0); col <= maxCol; col++) {
+                // tiles visible at the current level are requested by the nodes
+                int64_t srcX, srcY, srcW, srcH;
+                if (core.tileReader->getTileSourceX(&srcX, lvl, col) != TE_Ok ||
+                    core.tileReader->getTileSourceY(&srcY, lvl, row) != TE_Ok ||
+                    core.tileReader->getTileSourceWidth(&srcW, lvl, col) != TE_Ok ||
+                    core.tileReader->getTileSourceHeight(&srcH, lvl, row) != TE_Ok) {
+
+                    continue;
+                }
+                if (lvl == level &&
+                    atakmap::math::Rectangle<double>::intersects(roi.x, roi.y, roi.x + roi.width, roi.y + roi.height, (double)srcX, (double)srcY, (double)(srcX + srcW), (double)(srcY + srcH))) {
+                    continue;
+                }
+
+                std::shared_ptr<TileReader2::ReadRequest> request;
+                {
+                    Thread::Lock lock(mutex);
+                    if (pending.size() >= MAX_PREFETCH_REQUESTS)
+                        return;
+                    const TileKey key{ lvl, col, row };
+                    if (fetched.find(key) != fetched.end())
+                        continue;
+                    bool requested = false;
+                    for (auto &p : pending) {
+                        const TileReader2::ReadRequest &r = *p.second.request;
+                        requested |= ((size_t)r.level == lvl && r.tileColumn == col && r.tileRow == row);
+                    }
+                    if (requested)
+                        continue;
+
+                    request.reset(new(std::nothrow) TileReader2::ReadRequest(core.tileReader, static_cast<int>(lvl), col, row, this));
+                    if (!request)
+                        return;
+                    pending[request->id].request = request;
+                }
+                // prefetch tiles lie outside of the current ROI and are
+                // ordered after visible tiles by the prioritizer
+                core.asyncio->asyncRead(request);
+            }
+        }
+    }
+}
+
+bool GLQuadTileNode2::Prefetcher::take(Bitmap2 &value, const size_t level, const int64_t tileColumn, const int64_t tileRow) NOTHROWS
+{
+    Thread::Lock lock(mutex);
+    auto entry = fetched.find(TileKey{ level, tileColumn, tileRow });
+    if (entry == fetched.end())
+        return false;
+    int64_t version;
+    const bool current = (core.tileReader->getTileVersion(&version, level, tileColumn, tileRow) == TE_Ok && version == entry->second.version);
+    if (current)
+        value = entry->second.data;
+    fetchOrder.remove(entry->first);
+    fetched.erase(entry);
+    return current;
+}
+
+void GLQuadTileNode2::Prefetcher::release() NOTHROWS
+{
+    std::vector<std::shared_ptr<TileReader2::ReadRequest>> canceled;
+    {
+        Thread::Lock lock(mutex);
+        for (auto &p : pending)
+            canceled.push_back(p.second.request);
+        fetched.clear();
+        fetchOrder.clear();
+    }
+    cancel(canceled);
+    predictor.reset();
+}
+
+void GLQuadTileNode2::Prefetcher::cancel(const std::vector<std::shared_ptr<TileReader2::ReadRequest>> &requests) NOTHROWS
+{
+    // `cancel` notifies synchronously; must not be holding `mutex`
+    for (auto &request : requests)
+        request->cancel();
+}
+
+void GLQuadTileNode2::Prefetcher::requestCreated(const int id) NOTHROWS
+{}
+
+void GLQuadTileNode2::Prefetcher::requestStarted(const int id) NOTHROWS
+{}
+
+void GLQuadTileNode2::Prefetcher::requestUpdate(const int id, const Bitmap2 &data) NOTHROWS
+{
+    Thread::Lock lock(mutex);
+    auto entry = pending.find(id);
+    if (entry == pending.end())
+        return;
+    entry->second.data = data;
+    entry->second.received = true;
+}
+
+void GLQuadTileNode2::Prefetcher::requestCompleted(const int id) NOTHROWS
+{
+    Thread::Lock lock(mutex);
+    auto entry = pending.find(id);
+    if (entry == pending.end())
+        return;
+    const TileReader2::ReadRequest &request = *entry->second.request;
+    if (entry->second.received) {
+        const TileKey key{ (size_t)request.level, request.tileColumn, request.tileRow };
+        Fetched &tile = fetched[key];
+        tile.data = entry->second.data;
+        if (core.tileReader->getTileVersion(&tile.version, key.level, key.column, key.row) != TE_Ok)
+            tile.version = -1LL;
+        fetchOrder.remove(key);
+        fetchOrder.push_back(key);
+        while (fetchOrder.size() > MAX_PREFETCHED_TILES) {
+            fetched.erase(fetchOrder.front());
+            fetchOrder.pop_front();
+        }
+    }
+    pending.erase(entry);
+}
+
+void GLQuadTileNode2::Prefetcher::requestCanceled(const int id) NOTHROWS
+{
+    Thread::Lock lock(mutex);
+    pending.erase(id);
+}
+
+void GLQuadTileNode2::Prefetcher::requestError(const int id, const Util::TAKErr code, const char *msg) NOTHROWS
+{
+    Thread::Lock lock(mutex);
+    pending.erase(id);
+}
@@ -7,8 +7,11 @@
 #include "raster/RasterDataAccess2.h"
 #include "raster/tilereader/TileReader2.h"
 #include "raster/tilereader/TileReaderFactory2.h"
+#include "renderer/GLMegaTexture.h"
 #include "renderer/GLTexture2.h"
 #include "renderer/GLTextureCache2.h"
+#include "renderer/GLTexturePool.h"
+#include "renderer/GLTextureUploadPool.h"
 #include "renderer/core/GLMapRenderable2.h"
 #include "renderer/core/GLGlobeBase.h"
 #include "renderer/core/GLResolvable.h"
@@ -64,6 +67,7 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
     class VertexResolver;
     class DefaultVertexResolver;
     class PreciseVertexResolver;
+    class Prefetcher;
 
     struct GridVertex
     {
@@ -95,6 +99,8 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
 
         bool textureBorrowEnabled;
         bool textureCopyEnabled;
+        /** if `true`, tile data is compressed on the reader threads before upload */
+        bool compressTextures;
 
         /** local GSD for dataset */
         double gsd;
@@ -142,7 +148,21 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
 
         Thread::Mutex infoLock;
 
+        /** stages tile data for upload from the reader threads; may be `nullptr` */
+        std::shared_ptr<GLTextureUploadPool> uploadPool;
+        /** recycles tile textures released by nodes; may be `nullptr` */
+        std::unique_ptr<GLTexturePool> texturePool;
+
         std::unique_ptr<TileReadRequestPrioritizer> readRequestPrioritizer;
+        /** loads tiles ahead of camera motion; may be `nullptr` */
+        std::unique_ptr<Prefetcher> prefetcher;
+        /**
+         * if non-`nullptr`, tiles are streamed into `pageCache`, shared by
+         * all layers with the same tile size on the context, rather than
+         * read into per node textures
+         */
+        std::unique_ptr<GLMegaTexture> megaTexture;
+        std::shared_ptr<GLMegaTexture::PageCache> pageCache;
         Util::TAKErr status;
 
         TAK::Engine::Renderer::Core::Controls::SurfaceRendererControl *surfaceRenderer;
@@ -198,10 +218,11 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
     bool useCachedTexture();
     void resolveTexture();
     void drawTexture(const Core::GLGlobeBase &view, GLTexture2 *tex, float *texCoords);
-    const char *getTextureKey();
+    uint64_t getTextureKey();
     void invalidateVertexCoords();
     void expandTexGrid();
     void drawImpl(const Core::GLGlobeBase &view);
+    void drawVirtual(const Core::GLGlobeBase &view);
 
    private:
     Util::TAKErr super_set(int64_t tileColumn, int64_t tileRow, size_t level);
@@ -213,6 +234,7 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
     void draw(const Core::GLGlobeBase &view, const size_t level, int64_t srcX, int64_t srcY, int64_t srcW, int64_t srcH, int64_t poiX, int64_t poiY);
     void setLCS(const Core::GLGlobeBase &view);
     void super_drawTexture(const Core::GLGlobeBase &view, GLTexture2 *tex, float *texCoords);
+    void drawTextureImpl(const Core::GLGlobeBase &view, const GLuint texId, const float *texCoords, const float alpha);
     void super_invalidateVertexCoords();
     void super_draw(const Core::GLGlobeBase &view);
     void debugDraw(const Core::GLGlobeBase &view);
@@ -332,6 +354,9 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
     TAK::Engine::Core::GeoPoint2 centroid_;
     TAK::Engine::Math::Point2<double> centroid_proj_;
     std::list<std::shared_ptr<TAK::Engine::Raster::TileReader::TileReader2::ReadRequest>> read_requests_;
+    /** texture coordinates into the page of `page_index_`, when streaming */
+    std::vector<float> page_texture_coordinates_;
+    GLMegaTexture::TileIndex page_index_;
 
     double min_lat_;
     double min_lng_;
@@ -376,10 +401,10 @@ class ENGINE_API GLQuadTileNode2 : public Core::GLResolvableMapRenderable2,
 
    protected:
     /**
-     * This is the lazy loaded key for the texture to be used. It needs to be empty string when the
+     * This is the lazy loaded key for the texture to be used. It needs to be zero when the
      * value has become invalid
      */
-    std::string texture_key_;
+    uint64_t texture_key_;
 };
 
 }  // namespace TileReader
@@ -1,6 +1,7 @@
 #include "renderer/raster/tilereader/GLTileMesh.h"
 #include "renderer/GLTexture2.h"
 #include "renderer/GLES20FixedPipeline.h"
+#include "renderer/QuadMeshIndices.h"
 #include "renderer/core/GLMapView2.h"
 #include "math/Utils.h"
 #include "util/MathUtils.h"
@@ -66,7 +67,6 @@ TAK::Engine::Util::TAKErr GLTileMesh::commonInit(TAK::Engine::Math::Point2<doubl
     mesh_tex_coords_ = nullptr;
     mesh_tex_coords_size_ = 0;
     mesh_indices_ = nullptr;
-    mesh_indices_size_ = 0;
     num_coords_ = 0;
     num_indices_ = 0;
     mesh_verts_draw_version_ = 0;
@@ -133,18 +133,13 @@ void GLTileMesh::validateMesh()
         mesh_tex_coords_ = new float[mesh_tex_coords_size_];
     }
 
+    // the index topology depends only on the subdivisions; reference the
+    // shared indices rather than building a copy per tile
+    mesh_indices_ = nullptr;
     if (num_coords_ > 4) {
-        if (mesh_indices_ == nullptr || mesh_indices_size_ < num_indices_) {
-            if (mesh_indices_)
-                delete[] mesh_indices_;
-
-            mesh_indices_size_ = num_indices_;
-            mesh_indices_ = new uint16_t[mesh_indices_size_];
-        }
-    } else if (mesh_indices_) {
-        delete[] mesh_indices_;
-        mesh_indices_ = nullptr;
-        mesh_indices_size_ = 0;
+        const QuadMeshIndices *indices;
+        if (QuadMeshIndices_get(&indices, estimated_subdivisions_, estimated_subdivisions_, false) == Util::TE_Ok)
+            mesh_indices_ = indices->indices;
     }
 
     if (mesh_verts_ == nullptr || mesh_verts_size_ < (num_coords_ * 3)) {
@@ -174,10 +169,6 @@ void GLTileMesh::validateMesh()
                                        atakmap::math::Point<float>(u2, v2), atakmap::math::Point<float>(u3, v3),
                                         estimated_subdivisions_, estimated_subdivisions_);
 
-    if (mesh_indices_ != nullptr) {
-        GLTexture2_createQuadMeshIndexBuffer(mesh_indices_, estimated_subdivisions_, estimated_subdivisions_);
-    }
-
     vert_mode_ = GL_TRIANGLE_STRIP;
 
     // XXX - generate the LLA coords from the texcoords
@@ -313,11 +304,7 @@ void GLTileMesh::release() {
         mesh_tex_coords_ = nullptr;
         mesh_tex_coords_size_ = 0;
     }
-    if (mesh_indices_ != nullptr) {
-        delete[] mesh_indices_;
-        mesh_indices_ = nullptr;
-        mesh_indices_size_ = 0;
-    }
+    mesh_indices_ = nullptr;
     num_coords_ = 0;
     num_indices_ = 0;
 
@@ -22,8 +22,8 @@ namespace TAK {
                     size_t mesh_verts_size_;
                     float *mesh_tex_coords_;
                     size_t mesh_tex_coords_size_;
-                    uint16_t *mesh_indices_;
-                    size_t mesh_indices_size_;
+                    /** shared, not owned; see `QuadMeshIndices_get` */
+                    const uint16_t *mesh_indices_;
                     size_t num_coords_;
                     size_t num_indices_;
                     int mesh_verts_draw_version_;
@@ -0,0 +1,104 @@
+#include "thread/ReadCopyUpdate.h"
+
+#include <set>
+
+using namespace TAK::Engine::Thread;
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    struct ReaderRecord
+    {
+        /** the epoch observed on entry, `0` if not in a read-side section */
+        std::atomic<uint64_t> epoch {0u};
+        /** nesting depth, only accessed by the owning thread */
+        std::size_t depth {0u};
+    };
+
+    struct ReaderRegistry
+    {
+        Mutex mutex;
+        std::set<ReaderRecord *> readers;
+    };
+
+    std::atomic<uint64_t> &globalEpoch() NOTHROWS
+    {
+        // `0` is reserved to mark quiescent readers
+        static std::atomic<uint64_t> e(1u);
+        return e;
+    }
+    ReaderRegistry &registry() NOTHROWS
+    {
+        // intentionally leaked; threads may exit after static destruction
+        static ReaderRegistry *r = new ReaderRegistry();
+        return *r;
+    }
+
+    class ThreadReader
+    {
+    public :
+        ThreadReader() NOTHROWS
+        {
+            ReaderRegistry &r = registry();
+            Lock lock(r.mutex);
+            try {
+                r.readers.insert(&record);
+            } catch (...) {}
+        }
+        ~ThreadReader() NOTHROWS
+        {
+            ReaderRegistry &r = registry();
+            Lock lock(r.mutex);
+            r.readers.erase(&record);
+        }
+    public :
+        ReaderRecord record;
+    };
+
+    ReaderRecord &threadRecord() NOTHROWS
+    {
+        thread_local ThreadReader reader;
+        return reader.record;
+    }
+}
+
+void TAK::Engine::Thread::Impl::RCU_readLock() NOTHROWS
+{
+    ReaderRecord &record = threadRecord();
+    if (record.depth++)
+        return;
+    record.epoch.store(globalEpoch().load(std::memory_order_acquire), std::memory_order_relaxed);
+    // the announcement must be visible before the protected pointer is
+    // loaded; pairs with the RMW in `RCU_retire`
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+void TAK::Engine::Thread::Impl::RCU_readUnlock() NOTHROWS
+{
+    ReaderRecord &record = threadRecord();
+    if (!record.depth)
+        return;
+    if (!--record.depth)
+        record.epoch.store(0u, std::memory_order_release);
+}
+uint64_t TAK::Engine::Thread::Impl::RCU_retire() NOTHROWS
+{
+    return globalEpoch().fetch_add(1u, std::memory_order_seq_cst);
+}
+bool TAK::Engine::Thread::Impl::RCU_isReclaimable(const uint64_t epoch) NOTHROWS
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    ReaderRegistry &r = registry();
+    Lock lock(r.mutex);
+    if (lock.status != TE_Ok)
+        return false;
+    for (auto it = r.readers.begin(); it != r.readers.end(); it++) {
+        const uint64_t observed = (*it)->epoch.load(std::memory_order_acquire);
+        // a reader that entered at or before the retire epoch may still
+        // hold the retired value
+        if (observed && observed <= epoch)
+            return false;
+    }
+    return true;
+}
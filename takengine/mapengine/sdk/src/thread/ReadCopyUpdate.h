@@ -0,0 +1,196 @@
+#ifndef TAK_ENGINE_THREAD_READCOPYUPDATE_H_INCLUDED
+#define TAK_ENGINE_THREAD_READCOPYUPDATE_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "port/Platform.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Thread {
+            namespace Impl {
+                /**
+                 * Enters a read-side critical section on the calling
+                 * thread. Sections may be nested.
+                 */
+                ENGINE_API void RCU_readLock() NOTHROWS;
+                /**
+                 * Exits a read-side critical section on the calling thread.
+                 */
+                ENGINE_API void RCU_readUnlock() NOTHROWS;
+                /**
+                 * Advances the grace period. Must be invoked after the
+                 * replacement value has been published.
+                 *
+                 * @return  The epoch that the replaced value was retired in
+                 */
+                ENGINE_API uint64_t RCU_retire() NOTHROWS;
+                /**
+                 * Returns `true` if no reader that may have observed a
+                 * value retired in the specified epoch is still active.
+                 */
+                ENGINE_API bool RCU_isReclaimable(const uint64_t epoch) NOTHROWS;
+            }
+
+            /**
+             * Read-copy-update container for read-mostly data. Readers
+             * obtain an immutable snapshot without acquiring a lock or
+             * performing an atomic read-modify-write; writers copy the
+             * current value, modify the copy and publish it. Writers are
+             * serialized. Replaced values are freed once all readers that
+             * may have observed them have exited.
+             *
+             * <P>Read-side sections should be short; a reader that does
+             * not exit defers reclamation of all subsequently replaced
+             * values.
+             *
+             * example:
+             *    ReadCopyUpdate<std::set<int>>::ReadGuard values(registry);
+             *    for (auto it = values->begin(); it != values->end(); it++)
+             *        ...
+             */
+            template<class T>
+            class ReadCopyUpdate
+            {
+            public :
+                class ReadGuard;
+            public :
+                ReadCopyUpdate() NOTHROWS;
+            private :
+                ReadCopyUpdate(const ReadCopyUpdate &) NOTHROWS;
+            public :
+                /**
+                 * No read-side sections on this instance may be active.
+                 */
+                ~ReadCopyUpdate() NOTHROWS;
+            public :
+                /**
+                 * Applies the specified mutation to a copy of the current
+                 * value. The copy is published if the mutator returns
+                 * `TE_Ok`, otherwise it is discarded.
+                 *
+                 * @param mutator   Functor of signature `TAKErr(T &)`
+                 *
+                 * @return  The mutator's return code, or various codes on
+                 *          failure
+                 */
+                template<class Fn>
+                Util::TAKErr update(Fn mutator) NOTHROWS;
+            private :
+                void reclaim() NOTHROWS;
+            private :
+                struct Retired
+                {
+                    const T *value;
+                    uint64_t epoch;
+                };
+            private :
+                std::atomic<const T *> current;
+                Mutex mutex;
+                std::vector<Retired> retired;
+            };
+
+            /**
+             * RAII read-side section providing access to the current
+             * snapshot. The snapshot is not affected by concurrent updates
+             * and remains valid until the guard is destructed.
+             */
+            template<class T>
+            class ReadCopyUpdate<T>::ReadGuard
+            {
+            public :
+                ReadGuard(const ReadCopyUpdate<T> &owner) NOTHROWS;
+            private :
+                ReadGuard(const ReadGuard &) NOTHROWS;
+            public :
+                ~ReadGuard() NOTHROWS;
+            public :
+                const T &operator*() const NOTHROWS;
+                const T *operator->() const NOTHROWS;
+            private :
+                const T *value;
+            };
+
+            template<class T>
+            inline ReadCopyUpdate<T>::ReadCopyUpdate() NOTHROWS :
+                current(new T())
+            {}
+            template<class T>
+            inline ReadCopyUpdate<T>::~ReadCopyUpdate() NOTHROWS
+            {
+                for (auto it = retired.begin(); it != retired.end(); it++)
+                    delete (*it).value;
+                delete current.load(std::memory_order_relaxed);
+            }
+            template<class T>
+            template<class Fn>
+            inline Util::TAKErr ReadCopyUpdate<T>::update(Fn mutator) NOTHROWS
+            {
+                Util::TAKErr code(Util::TE_Ok);
+                Lock lock(mutex);
+                code = lock.status;
+                TE_CHECKRETURN_CODE(code);
+
+                TE_BEGIN_TRAP() {
+                    std::unique_ptr<T> next(new T(*current.load(std::memory_order_relaxed)));
+                    code = mutator(*next);
+                    if (code == Util::TE_Ok) {
+                        // reserve before publishing so the replaced value cannot be orphaned
+                        retired.reserve(retired.size() + 1u);
+
+                        Retired prev;
+                        prev.value = current.exchange(next.release(), std::memory_order_seq_cst);
+                        prev.epoch = Impl::RCU_retire();
+                        retired.push_back(prev);
+                    }
+                } TE_END_TRAP(code);
+
+                reclaim();
+                return code;
+            }
+            template<class T>
+            inline void ReadCopyUpdate<T>::reclaim() NOTHROWS
+            {
+                auto it = retired.begin();
+                while (it != retired.end()) {
+                    if (Impl::RCU_isReclaimable((*it).epoch)) {
+                        delete (*it).value;
+                        it = retired.erase(it);
+                    } else {
+                        it++;
+                    }
+                }
+            }
+
+            template<class T>
+            inline ReadCopyUpdate<T>::ReadGuard::ReadGuard(const ReadCopyUpdate<T> &owner) NOTHROWS
+            {
+                Impl::RCU_readLock();
+                value = owner.current.load(std::memory_order_seq_cst);
+            }
+            template<class T>
+            inline ReadCopyUpdate<T>::ReadGuard::~ReadGuard() NOTHROWS
+            {
+                Impl::RCU_readUnlock();
+            }
+            template<class T>
+            inline const T &ReadCopyUpdate<T>::ReadGuard::operator*() const NOTHROWS
+            {
+                return *value;
+            }
+            template<class T>
+            inline const T *ReadCopyUpdate<T>::ReadGuard::operator->() const NOTHROWS
+            {
+                return value;
+            }
+        }
+    }
+}
+
+#endif
@@ -25,6 +25,20 @@ namespace TAK {
                 TETP_Highest,
             };
 
+            /**
+             * Core class hints for heterogeneous (e.g. big.LITTLE) processors.
+             * On homogeneous processors all classes are equivalent.
+             */
+            enum ThreadCoreClass
+            {
+                /** No preference; scheduled on any core */
+                TECC_Any,
+                /** Prefer the highest capacity cores */
+                TECC_Performance,
+                /** Prefer the lowest capacity cores */
+                TECC_Efficiency,
+            };
+
             class ENGINE_API ThreadID
             {
             private :
@@ -81,7 +95,8 @@ namespace TAK {
             {
             public :
                 /**
-                 * Creates a default parameter of NULL name and TETP_Normal priority
+                 * Creates a default parameter of NULL name, TETP_Normal
+                 * priority, TECC_Any core class and no affinity
                  */
                 ThreadCreateParams() NOTHROWS;
             public :
@@ -89,6 +104,14 @@ namespace TAK {
                 Port::String name;
                 /** The desired thread priority */
                 ThreadPriority priority;
+                /** The preferred class of core to run on */
+                ThreadCoreClass coreClass;
+                /**
+                 * Bitmask of the CPUs (bit N is CPU N) the thread may run on.
+                 * If non-zero, takes precedence over `coreClass`; `0` for no
+                 * pinning.
+                 */
+                uint64_t affinityMask;
             };
 
             typedef std::unique_ptr<Thread, void(*)(const Thread *)> ThreadPtr;
@@ -122,6 +145,22 @@ namespace TAK {
              * @return  The ID of the currently executing thread.
              */
             ENGINE_API ThreadID Thread_currentThreadID() NOTHROWS;
+
+            /**
+             * Restricts the currently executing thread to the specified CPUs
+             * or core class. Intended for threads not created via
+             * `Thread_start`, such as a platform owned GL thread. Supported
+             * on Linux/Android; a no-op elsewhere.
+             *
+             * @param coreClass     The preferred class of core
+             * @param affinityMask  Bitmask of allowed CPUs; if non-zero,
+             *                      takes precedence over `coreClass`
+             *
+             * @return  TE_Ok on success (including when the request is not
+             *          applicable to the platform), TE_Err if the
+             *          affinity could not be applied
+             */
+            ENGINE_API Util::TAKErr Thread_setCurrentThreadAffinity(const ThreadCoreClass coreClass, const uint64_t affinityMask = 0ULL) NOTHROWS;
         }
     }
 }
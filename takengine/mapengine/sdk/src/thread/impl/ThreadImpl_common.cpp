@@ -6,11 +6,31 @@
 
 #include "thread/Monitor.h"
 
+#if defined(__linux__)
+#include <cstdio>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 using namespace TAK::Engine::Thread;
 using namespace TAK::Engine::Thread::Impl;
 
 using namespace TAK::Engine::Util;
 
+namespace
+{
+#if defined(__linux__)
+    struct CoreClassMasks
+    {
+        uint64_t performance;
+        uint64_t efficiency;
+    };
+
+    bool readCpuValue(unsigned long *value, const unsigned cpu, const char *attr) NOTHROWS;
+    CoreClassMasks discoverCoreClasses() NOTHROWS;
+#endif
+}
+
 /*****************************************************************************/
 // CondVar definitions
 
@@ -83,9 +103,46 @@ ThreadID Thread::getID() const NOTHROWS
 }
 
 ThreadCreateParams::ThreadCreateParams() NOTHROWS :
-    priority(TETP_Normal)
+    priority(TETP_Normal),
+    coreClass(TECC_Any),
+    affinityMask(0ULL)
 {}
 
+TAKErr TAK::Engine::Thread::Thread_setCurrentThreadAffinity(const ThreadCoreClass coreClass, const uint64_t affinityMask) NOTHROWS
+{
+#if defined(__linux__)
+    uint64_t mask = affinityMask;
+    if (!mask) {
+        static const CoreClassMasks classes = discoverCoreClasses();
+        switch (coreClass) {
+        case TECC_Performance :
+            mask = classes.performance;
+            break;
+        case TECC_Efficiency :
+            mask = classes.efficiency;
+            break;
+        default :
+            break;
+        }
+    }
+    // no preference, or homogeneous cores
+    if (!mask)
+        return TE_Ok;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned i = 0u; i < 64u; i++) {
+        if (mask & (1ULL << i))
+            CPU_SET(i, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set))
+        return TE_Err;
+    return TE_Ok;
+#else
+    return TE_Ok;
+#endif
+}
+
 ThreadIDImpl::ThreadIDImpl() NOTHROWS
 {}
 
@@ -107,3 +164,59 @@ TAKErr TAK::Engine::Thread::Thread_sleep(const int64_t milliseconds) NOTHROWS
     TE_CHECKRETURN_CODE(code);
     return code;
 }
+
+namespace
+{
+#if defined(__linux__)
+    bool readCpuValue(unsigned long *value, const unsigned cpu, const char *attr) NOTHROWS
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/%s", cpu, attr);
+        FILE *f = fopen(path, "r");
+        if (!f)
+            return false;
+        const bool read = (fscanf(f, "%lu", value) == 1);
+        fclose(f);
+        return read;
+    }
+
+    CoreClassMasks discoverCoreClasses() NOTHROWS
+    {
+        CoreClassMasks masks;
+        masks.performance = 0ULL;
+        masks.efficiency = 0ULL;
+
+        long ncpu = sysconf(_SC_NPROCESSORS_CONF);
+        if (ncpu <= 1)
+            return masks;
+        if (ncpu > 64)
+            ncpu = 64;
+
+        // prefer the scheduler's capacity, fall back on the maximum frequency
+        unsigned long capacity[64];
+        unsigned long minCapacity = ~0UL;
+        unsigned long maxCapacity = 0UL;
+        for (unsigned i = 0u; i < static_cast<unsigned>(ncpu); i++) {
+            if (!readCpuValue(&capacity[i], i, "cpu_capacity") &&
+                !readCpuValue(&capacity[i], i, "cpufreq/cpuinfo_max_freq")) {
+
+                return masks;
+            }
+            if (capacity[i] < minCapacity)
+                minCapacity = capacity[i];
+            if (capacity[i] > maxCapacity)
+                maxCapacity = capacity[i];
+        }
+        if (minCapacity == maxCapacity)
+            return masks;
+
+        for (unsigned i = 0u; i < static_cast<unsigned>(ncpu); i++) {
+            if (capacity[i] == maxCapacity)
+                masks.performance |= (1ULL << i);
+            if (capacity[i] == minCapacity)
+                masks.efficiency |= (1ULL << i);
+        }
+        return masks;
+    }
+#endif
+}
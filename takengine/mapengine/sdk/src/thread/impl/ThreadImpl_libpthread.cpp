@@ -61,6 +61,8 @@ namespace
 
         void *(*entry)(void *);
         void *opaque;
+        ThreadCoreClass coreClass;
+        uint64_t affinityMask;
     };
 
     class PThreadsThreadIDImpl : public ThreadIDImpl
@@ -119,7 +121,7 @@ namespace
         ThreadImpl() NOTHROWS;
         ~ThreadImpl() NOTHROWS;
     public:
-        virtual TAKErr start(void *(*entry)(void *), void *opaque) NOTHROWS;
+        virtual TAKErr start(void *(*entry)(void *), void *opaque, const ThreadCreateParams &params) NOTHROWS;
     public:
         virtual TAKErr join(const int64_t millis = 0LL) NOTHROWS;
         virtual TAKErr detach() NOTHROWS;
@@ -164,7 +166,7 @@ TAKErr TAK::Engine::Thread::Thread_start(ThreadPtr &value, void *(*entry)(void *
     TAKErr code(TE_Ok);
 
     std::auto_ptr<ThreadImpl> retval(new ThreadImpl());
-    code = retval->start(entry, opaque);
+    code = retval->start(entry, opaque, params);
     if (code != TE_Ok)
         return code;
 
@@ -186,7 +188,9 @@ namespace
         started(false),
         terminated(false),
         entry(NULL),
-        opaque(NULL)
+        opaque(NULL),
+        coreClass(TECC_Any),
+        affinityMask(0ULL)
     {}
 
     PThreadsThreadIDImpl::PThreadsThreadIDImpl(const pthread_t &tid_) NOTHROWS :
@@ -357,7 +361,7 @@ namespace
         join();
     }
 
-    inline TAKErr ThreadImpl::start(void *(*entry)(void *), void *opaque) NOTHROWS
+    inline TAKErr ThreadImpl::start(void *(*entry)(void *), void *opaque, const ThreadCreateParams &params) NOTHROWS
     {
         TAKErr code(TE_Ok);
 
@@ -367,6 +371,8 @@ namespace
         core.reset(new ThreadRuntimeCore());
         core->entry = entry;
         core->opaque = opaque;
+        core->coreClass = params.coreClass;
+        core->affinityMask = params.affinityMask;
         int err = pthread_create(&thread_s, NULL, threadCoreRun, new std::shared_ptr<ThreadRuntimeCore>(core));
         if (err)
             return TE_Err;
@@ -460,6 +466,9 @@ namespace
         };
 
         TerminatedSignal signal(core);
+        // affinity is best effort; the thread runs regardless
+        if (core->coreClass != TECC_Any || core->affinityMask)
+            Thread_setCurrentThreadAffinity(core->coreClass, core->affinityMask);
         core->started = true;
         return core->entry(core->opaque);
     }
@@ -0,0 +1,561 @@
+#include "util/AllocationTagging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+
+#include "thread/Monitor.h"
+#include "thread/Thread.h"
+#include "util/Logging2.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Thread;
+
+namespace
+{
+    enum {
+        NumTags = AllocationTaggingSnapshot::NumTags,
+        /** capacity of the call site table; must be a power of two */
+        CallSiteTableSize = 4096,
+        /** one in this many allocations per thread is attributed to its call site */
+        CallSiteSampleInterval = 16,
+    };
+
+    struct TagCounters
+    {
+        std::atomic<int64_t> liveBytes {0};
+        std::atomic<uint64_t> bytesAllocated {0u};
+        std::atomic<uint64_t> allocations {0u};
+        std::atomic<uint64_t> releases {0u};
+    };
+
+    struct CallSiteCounters
+    {
+        /** call site address with the tag in the upper 8 bits; 0 if unused */
+        std::atomic<uint64_t> key {0u};
+        std::atomic<uint64_t> allocations {0u};
+        std::atomic<uint64_t> bytes {0u};
+    };
+
+    struct GlobalState
+    {
+        TagCounters tags[NumTags];
+        CallSiteCounters callSites[CallSiteTableSize];
+    };
+
+    GlobalState &state() NOTHROWS
+    {
+        // allocated with malloc, as this may be first invoked from within
+        // the allocator. Intentionally leaked; charged allocations may be
+        // released after static destruction
+        static GlobalState *s = new(malloc(sizeof(GlobalState))) GlobalState();
+        return *s;
+    }
+
+    // trivially constructible and destructible, so that access from within
+    // the allocator does not itself allocate
+    thread_local int currentTag = TEAT_Untagged;
+    thread_local unsigned sampleCountdown = 0u;
+
+    const char *TagNames[NumTags] =
+    {
+        "Untagged",
+        "TileDecode",
+        "FeatureQuery",
+        "MeshLoad",
+        "NetworkReceive",
+    };
+
+    bool isValid(const int tag) NOTHROWS
+    {
+        return tag >= 0 && tag < NumTags;
+    }
+
+    int64_t now() NOTHROWS
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void recordCallSite(const int tag, const void *caller, const std::size_t size) NOTHROWS
+    {
+        const uint64_t key = ((uint64_t)(uintptr_t)caller & 0x00FFFFFFFFFFFFFFULL) | ((uint64_t)tag << 56u);
+        // Fibonacci hash of the address
+        std::size_t idx = (std::size_t)((key * 0x9E3779B97F4A7C15ULL) >> 52u) & (CallSiteTableSize - 1u);
+        GlobalState &s = state();
+        for (std::size_t probe = 0u; probe < CallSiteTableSize; probe++) {
+            CallSiteCounters &site = s.callSites[idx];
+            uint64_t existing = site.key.load(std::memory_order_relaxed);
+            if (!existing && site.key.compare_exchange_strong(existing, key, std::memory_order_relaxed))
+                existing = key;
+            if (existing == key) {
+                site.allocations.fetch_add(CallSiteSampleInterval, std::memory_order_relaxed);
+                site.bytes.fetch_add((uint64_t)size * CallSiteSampleInterval, std::memory_order_relaxed);
+                return;
+            }
+            idx = (idx + 1u) & (CallSiteTableSize - 1u);
+        }
+        // table is full; the sample is dropped
+    }
+
+    /** Logs each line written at TELL_Info */
+    class LogOutput : public DataOutput2
+    {
+    public :
+        ~LogOutput() NOTHROWS override
+        {
+            close();
+        }
+        TAKErr close() NOTHROWS override
+        {
+            if (!line.empty()) {
+                Logger_log(TELL_Info, "%s", line.c_str());
+                line.clear();
+            }
+            return TE_Ok;
+        }
+        TAKErr write(const uint8_t *buf, const std::size_t len) NOTHROWS override
+        {
+            for (std::size_t i = 0u; i < len; i++)
+                writeByte(buf[i]);
+            return TE_Ok;
+        }
+        TAKErr writeByte(const uint8_t value) NOTHROWS override
+        {
+            if (value == '\n')
+                return close();
+            line.push_back((char)value);
+            return TE_Ok;
+        }
+    private :
+        std::string line;
+    };
+
+    struct Reporter
+    {
+        Monitor monitor;
+        ThreadPtr thread {nullptr, nullptr};
+        int64_t interval {0LL};
+        bool terminate {false};
+        AllocationTaggingSnapshot last;
+    };
+
+    Reporter &reporter() NOTHROWS
+    {
+        static Reporter r;
+        return r;
+    }
+
+    void *reporterRun(void *opaque)
+    {
+        Reporter &r = *static_cast<Reporter *>(opaque);
+        Monitor::Lock lock(r.monitor);
+        AllocationTagging_getSnapshot(&r.last);
+        while (!r.terminate) {
+            lock.wait(r.interval);
+            if (r.terminate)
+                break;
+            AllocationTaggingSnapshot current;
+            AllocationTagging_getSnapshot(&current);
+            LogOutput log;
+            AllocationTagging_report(log, current, &r.last);
+            r.last = current;
+        }
+        return nullptr;
+    }
+}
+
+std::atomic<bool> TAK::Engine::Util::Impl::allocationTaggingEnabled(false);
+
+AllocationTaggingSnapshot::AllocationTaggingSnapshot() NOTHROWS :
+    timestamp(0LL),
+    numCallSites(0u)
+{
+    memset(tags, 0, sizeof(tags));
+    memset(callSites, 0, sizeof(callSites));
+}
+
+void TAK::Engine::Util::AllocationTagging_setEnabled(const bool enabled) NOTHROWS
+{
+    Impl::allocationTaggingEnabled.store(enabled, std::memory_order_relaxed);
+}
+AllocationTag TAK::Engine::Util::AllocationTagging_getTag() NOTHROWS
+{
+    return (AllocationTag)currentTag;
+}
+AllocationTag TAK::Engine::Util::AllocationTagging_setTag(const AllocationTag tag) NOTHROWS
+{
+    const AllocationTag previous = (AllocationTag)currentTag;
+    currentTag = isValid(tag) ? tag : TEAT_Untagged;
+    return previous;
+}
+int TAK::Engine::Util::AllocationTagging_recordAllocation(const std::size_t size, const void *caller) NOTHROWS
+{
+    if (!AllocationTagging_isEnabled())
+        return -1;
+    const int tag = currentTag;
+    TagCounters &c = state().tags[tag];
+    c.allocations.fetch_add(1u, std::memory_order_relaxed);
+    c.bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    c.liveBytes.fetch_add((int64_t)size, std::memory_order_relaxed);
+    if (caller) {
+        if (!sampleCountdown) {
+            sampleCountdown = CallSiteSampleInterval - 1u;
+            recordCallSite(tag, caller, size);
+        } else {
+            sampleCountdown--;
+        }
+    }
+    return tag;
+}
+void TAK::Engine::Util::AllocationTagging_recordRelease(const int tag, const std::size_t size) NOTHROWS
+{
+    if (!isValid(tag))
+        return;
+    TagCounters &c = state().tags[tag];
+    c.releases.fetch_add(1u, std::memory_order_relaxed);
+    c.liveBytes.fetch_sub((int64_t)size, std::memory_order_relaxed);
+}
+TAKErr TAK::Engine::Util::AllocationTagging_getSnapshot(AllocationTaggingSnapshot *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    GlobalState &s = state();
+    value->timestamp = now();
+    for (std::size_t i = 0u; i < NumTags; i++) {
+        AllocationTaggingSnapshot::Tag &tag = value->tags[i];
+        tag.liveBytes = s.tags[i].liveBytes.load(std::memory_order_relaxed);
+        tag.bytesAllocated = s.tags[i].bytesAllocated.load(std::memory_order_relaxed);
+        tag.allocations = s.tags[i].allocations.load(std::memory_order_relaxed);
+        tag.releases = s.tags[i].releases.load(std::memory_order_relaxed);
+    }
+
+    // select the call sites with the greatest volume; the table is scanned
+    // in place to avoid allocating
+    AllocationTaggingSnapshot::CallSite *top = value->callSites;
+    std::size_t &numTop = value->numCallSites;
+    numTop = 0u;
+    const auto byBytes = [](const AllocationTaggingSnapshot::CallSite &a, const AllocationTaggingSnapshot::CallSite &b)
+    {
+        return a.bytes > b.bytes;
+    };
+    for (std::size_t i = 0u; i < CallSiteTableSize; i++) {
+        const uint64_t key = s.callSites[i].key.load(std::memory_order_relaxed);
+        if (!key)
+            continue;
+        AllocationTaggingSnapshot::CallSite site;
+        site.address = reinterpret_cast<const void *>((uintptr_t)(key & 0x00FFFFFFFFFFFFFFULL));
+        site.tag = (AllocationTag)(key >> 56u);
+        site.allocations = s.callSites[i].allocations.load(std::memory_order_relaxed);
+        site.bytes = s.callSites[i].bytes.load(std::memory_order_relaxed);
+        if (numTop < AllocationTaggingSnapshot::MaxCallSites) {
+            top[numTop++] = site;
+            std::push_heap(top, top + numTop, byBytes);
+        } else if (site.bytes > top[0].bytes) {
+            std::pop_heap(top, top + numTop, byBytes);
+            top[numTop - 1u] = site;
+            std::push_heap(top, top + numTop, byBytes);
+        }
+    }
+    std::sort_heap(top, top + numTop, byBytes);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::AllocationTagging_report(DataOutput2 &sink, const AllocationTaggingSnapshot &current, const AllocationTaggingSnapshot *previous) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    char line[256];
+    const double seconds = previous ? (double)(current.timestamp - previous->timestamp) / 1000.0 : 0.0;
+
+    if (seconds > 0.0)
+        snprintf(line, sizeof(line), "Allocation tags over %.1fs\n%-16s %14s %14s %12s\n", seconds, "tag", "live_bytes", "bytes/s", "allocs/s");
+    else
+        snprintf(line, sizeof(line), "Allocation tags\n%-16s %14s %14s %12s\n", "tag", "live_bytes", "bytes", "allocs");
+    code = sink.write(reinterpret_cast<const uint8_t *>(line), strlen(line));
+    TE_CHECKRETURN_CODE(code);
+    for (std::size_t i = 0u; i < NumTags; i++) {
+        const AllocationTaggingSnapshot::Tag &tag = current.tags[i];
+        if (seconds > 0.0) {
+            const AllocationTaggingSnapshot::Tag &last = previous->tags[i];
+            snprintf(line, sizeof(line), "%-16s %14" PRId64 " %14.0f %12.0f\n",
+                TagNames[i],
+                tag.liveBytes,
+                (double)(tag.bytesAllocated - last.bytesAllocated) / seconds,
+                (double)(tag.allocations - last.allocations) / seconds);
+        } else {
+            snprintf(line, sizeof(line), "%-16s %14" PRId64 " %14" PRIu64 " %12" PRIu64 "\n",
+                TagNames[i],
+                tag.liveBytes,
+                tag.bytesAllocated,
+                tag.allocations);
+        }
+        code = sink.write(reinterpret_cast<const uint8_t *>(line), strlen(line));
+        TE_CHECKBREAK_CODE(code);
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    if (!current.numCallSites)
+        return code;
+    snprintf(line, sizeof(line), "Top call sites (estimated)\n%-18s %-16s %14s %12s\n", "address", "tag", "bytes", "allocs");
+    code = sink.write(reinterpret_cast<const uint8_t *>(line), strlen(line));
+    TE_CHECKRETURN_CODE(code);
+    for (std::size_t i = 0u; i < current.numCallSites; i++) {
+        const AllocationTaggingSnapshot::CallSite &site = current.callSites[i];
+        snprintf(line, sizeof(line), "%-18p %-16s %14" PRIu64 " %12" PRIu64 "\n",
+            site.address,
+            isValid(site.tag) ? TagNames[site.tag] : "?",
+            site.bytes,
+            site.allocations);
+        code = sink.write(reinterpret_cast<const uint8_t *>(line), strlen(line));
+        TE_CHECKBREAK_CODE(code);
+    }
+    return code;
+}
+TAKErr TAK::Engine::Util::AllocationTagging_setReportInterval(const int64_t millis) NOTHROWS
+{
+    Reporter &r = reporter();
+    ThreadPtr stopped(nullptr, nullptr);
+    {
+        Monitor::Lock lock(r.monitor);
+        TE_CHECKRETURN_CODE(lock.status);
+        if (r.thread) {
+            r.terminate = true;
+            lock.broadcast();
+            stopped = std::move(r.thread);
+        }
+    }
+    if (stopped)
+        stopped->join();
+
+    Monitor::Lock lock(r.monitor);
+    TE_CHECKRETURN_CODE(lock.status);
+    r.terminate = false;
+    r.interval = millis;
+    if (millis <= 0LL)
+        return TE_Ok;
+    ThreadCreateParams params;
+    params.name = "AllocationTagging-report";
+    params.priority = TETP_Low;
+    return Thread_start(r.thread, reporterRun, &r, params);
+}
+const char *TAK::Engine::Util::AllocationTag_getName(const AllocationTag tag) NOTHROWS
+{
+    return isValid(tag) ? TagNames[tag] : nullptr;
+}
+
+#ifdef TE_ALLOCATION_TAGGING_INTERPOSE
+// Replacement global allocation functions. The charged tag and size are
+// kept in a side table keyed by address rather than in a block header, so
+// that memory allocated or released through another definition of the
+// allocation functions (e.g. by a runtime library bound to its own
+// definitions) remains compatible; all definitions share malloc/free.
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TE_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define TE_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace
+{
+    enum {
+        NumStripes = 64,
+        InitialStripeCapacity = 1024,
+    };
+
+    struct LiveEntry
+    {
+        uintptr_t address;
+        std::size_t size;
+        int tag;
+    };
+
+    /** open addressed, linear probing table of charged allocations */
+    struct Stripe
+    {
+        std::mutex mutex;
+        LiveEntry *entries {nullptr};
+        std::size_t capacity {0u};
+        std::size_t count {0u};
+    };
+
+    struct LiveTable
+    {
+        Stripe stripes[NumStripes];
+        std::atomic<std::size_t> count {0u};
+    };
+
+    LiveTable &liveTable() NOTHROWS
+    {
+        // allocated with malloc and intentionally leaked; the table must be
+        // usable before static initialization and after static destruction
+        static LiveTable *t = new(malloc(sizeof(LiveTable))) LiveTable();
+        return *t;
+    }
+
+    std::size_t hashAddress(const uintptr_t address) NOTHROWS
+    {
+        return (std::size_t)(((uint64_t)address * 0x9E3779B97F4A7C15ULL) >> 32u);
+    }
+
+    bool insertEntry(LiveEntry *entries, const std::size_t capacity, const LiveEntry &entry) NOTHROWS
+    {
+        std::size_t idx = hashAddress(entry.address) & (capacity - 1u);
+        for (std::size_t i = 0u; i < capacity; i++) {
+            if (!entries[idx].address) {
+                entries[idx] = entry;
+                return true;
+            }
+            idx = (idx + 1u) & (capacity - 1u);
+        }
+        return false;
+    }
+
+    bool insertLive(void *ptr, const std::size_t size, const int tag) NOTHROWS
+    {
+        LiveEntry entry;
+        entry.address = reinterpret_cast<uintptr_t>(ptr);
+        entry.size = size;
+        entry.tag = tag;
+
+        LiveTable &t = liveTable();
+        Stripe &stripe = t.stripes[(entry.address >> 4u) % NumStripes];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        // grow at 50% load
+        if ((stripe.count + 1u) * 2u > stripe.capacity) {
+            const std::size_t capacity = stripe.capacity ? stripe.capacity * 2u : (std::size_t)InitialStripeCapacity;
+            LiveEntry *entries = static_cast<LiveEntry *>(calloc(capacity, sizeof(LiveEntry)));
+            if (!entries)
+                return false;
+            for (std::size_t i = 0u; i < stripe.capacity; i++)
+                if (stripe.entries[i].address)
+                    insertEntry(entries, capacity, stripe.entries[i]);
+            free(stripe.entries);
+            stripe.entries = entries;
+            stripe.capacity = capacity;
+        }
+        insertEntry(stripe.entries, stripe.capacity, entry);
+        stripe.count++;
+        t.count.fetch_add(1u, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool removeLive(LiveEntry *value, void *ptr) NOTHROWS
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        LiveTable &t = liveTable();
+        Stripe &stripe = t.stripes[(address >> 4u) % NumStripes];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (!stripe.count)
+            return false;
+        const std::size_t mask = stripe.capacity - 1u;
+        std::size_t idx = hashAddress(address) & mask;
+        while (stripe.entries[idx].address != address) {
+            if (!stripe.entries[idx].address)
+                return false;
+            idx = (idx + 1u) & mask;
+        }
+        *value = stripe.entries[idx];
+        stripe.entries[idx].address = 0u;
+
+        // backward shift deletion; move subsequent entries of the probe
+        // sequence into the hole
+        std::size_t hole = idx;
+        std::size_t next = (idx + 1u) & mask;
+        while (stripe.entries[next].address) {
+            const std::size_t home = hashAddress(stripe.entries[next].address) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                stripe.entries[hole] = stripe.entries[next];
+                stripe.entries[next].address = 0u;
+                hole = next;
+            }
+            next = (next + 1u) & mask;
+        }
+        stripe.count--;
+        t.count.fetch_sub(1u, std::memory_order_relaxed);
+        return true;
+    }
+
+    void *taggedAllocate(std::size_t size, const void *caller) NOTHROWS
+    {
+        if (!size)
+            size = 1u;
+        void *ptr = malloc(size);
+        if (!ptr)
+            return nullptr;
+        const int tag = AllocationTagging_recordAllocation(size, caller);
+        if (tag >= 0 && !insertLive(ptr, size, tag))
+            AllocationTagging_recordRelease(tag, size);
+        return ptr;
+    }
+
+    void taggedRelease(void *ptr) NOTHROWS
+    {
+        if (!ptr)
+            return;
+        LiveEntry entry;
+        if (liveTable().count.load(std::memory_order_relaxed) && removeLive(&entry, ptr))
+            AllocationTagging_recordRelease(entry.tag, entry.size);
+        free(ptr);
+    }
+
+    void *taggedAllocateOrThrow(const std::size_t size, const void *caller)
+    {
+        while (true) {
+            void *ptr = taggedAllocate(size, caller);
+            if (ptr)
+                return ptr;
+            std::new_handler handler = std::get_new_handler();
+            if (!handler)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    return taggedAllocateOrThrow(size, TE_RETURN_ADDRESS());
+}
+void *operator new[](std::size_t size)
+{
+    return taggedAllocateOrThrow(size, TE_RETURN_ADDRESS());
+}
+void *operator new(std::size_t size, const std::nothrow_t &) NOTHROWS
+{
+    return taggedAllocate(size, TE_RETURN_ADDRESS());
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) NOTHROWS
+{
+    return taggedAllocate(size, TE_RETURN_ADDRESS());
+}
+void operator delete(void *ptr) NOTHROWS
+{
+    taggedRelease(ptr);
+}
+void operator delete[](void *ptr) NOTHROWS
+{
+    taggedRelease(ptr);
+}
+void operator delete(void *ptr, const std::nothrow_t &) NOTHROWS
+{
+    taggedRelease(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) NOTHROWS
+{
+    taggedRelease(ptr);
+}
+void operator delete(void *ptr, std::size_t) NOTHROWS
+{
+    taggedRelease(ptr);
+}
+void operator delete[](void *ptr, std::size_t) NOTHROWS
+{
+    taggedRelease(ptr);
+}
+#endif
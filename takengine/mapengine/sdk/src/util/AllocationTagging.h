@@ -0,0 +1,173 @@
+#ifndef TAK_ENGINE_UTIL_ALLOCATIONTAGGING_H_INCLUDED
+#define TAK_ENGINE_UTIL_ALLOCATIONTAGGING_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/DataOutput2.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Subsystems that heap allocations may be attributed to. The
+             * current tag is a per-thread value, established for the
+             * duration of a subsystem entry point via `AllocationTagScope`.
+             *
+             * <P>Unlike `MemoryCategory`, which is charged explicitly for
+             * long-lived payloads, tags are charged implicitly for every
+             * allocation made by the thread, covering transient and leaked
+             * allocations.
+             */
+            enum AllocationTag
+            {
+                /** Allocations made outside of any tagged scope */
+                TEAT_Untagged,
+                /** Tile reads and bitmap decoding */
+                TEAT_TileDecode,
+                /** Feature queries issued by renderers */
+                TEAT_FeatureQuery,
+                /** Model mesh loading */
+                TEAT_MeshLoad,
+                /** Receipt of network responses */
+                TEAT_NetworkReceive,
+            };
+
+            /**
+             * Point-in-time copy of the allocation tagging counters.
+             */
+            struct ENGINE_API AllocationTaggingSnapshot
+            {
+                enum {
+                    NumTags = TEAT_NetworkReceive + 1,
+                    MaxCallSites = 32,
+                };
+
+                struct Tag
+                {
+                    /** Bytes allocated and not yet released */
+                    int64_t liveBytes;
+                    /** Total bytes allocated */
+                    uint64_t bytesAllocated;
+                    uint64_t allocations;
+                    uint64_t releases;
+                };
+
+                /**
+                 * Allocation volume attributed to a single call site. Call
+                 * sites are sampled; counts are estimates.
+                 */
+                struct CallSite
+                {
+                    /** Return address of the allocation */
+                    const void *address;
+                    AllocationTag tag;
+                    uint64_t allocations;
+                    uint64_t bytes;
+                };
+
+                AllocationTaggingSnapshot() NOTHROWS;
+
+                /** Monotonic time of the snapshot, in milliseconds */
+                int64_t timestamp;
+                Tag tags[NumTags];
+                /** Call sites in descending order of bytes allocated */
+                CallSite callSites[MaxCallSites];
+                std::size_t numCallSites;
+            };
+
+            namespace Impl {
+                extern ENGINE_API std::atomic<bool> allocationTaggingEnabled;
+            }
+
+            /**
+             * Enables or disables recording. Recording is disabled by
+             * default. Allocations made while recording is disabled are
+             * never charged, even if released while recording is enabled.
+             *
+             * <P>Allocations are recorded by the slab allocator, and, when
+             * the engine is built with `TE_ALLOCATION_TAGGING_INTERPOSE`,
+             * by replacement global `operator new`/`operator delete`.
+             */
+            ENGINE_API void AllocationTagging_setEnabled(const bool enabled) NOTHROWS;
+            inline bool AllocationTagging_isEnabled() NOTHROWS
+            {
+                return Impl::allocationTaggingEnabled.load(std::memory_order_relaxed);
+            }
+            /** Returns the tag for the current thread. */
+            ENGINE_API AllocationTag AllocationTagging_getTag() NOTHROWS;
+            /**
+             * Sets the tag for the current thread.
+             *
+             * @return  The previous tag
+             */
+            ENGINE_API AllocationTag AllocationTagging_setTag(const AllocationTag tag) NOTHROWS;
+            /**
+             * Charges an allocation to the current thread's tag. Intended
+             * for use by allocators.
+             *
+             * @param size      The size of the allocation, in bytes
+             * @param caller    The return address of the allocation, or
+             *                  `nullptr` if not known
+             *
+             * @return  The tag charged, which must be passed to
+             *          `AllocationTagging_recordRelease`, or `-1` if the
+             *          allocation was not charged
+             */
+            ENGINE_API int AllocationTagging_recordAllocation(const std::size_t size, const void *caller) NOTHROWS;
+            /**
+             * Releases the charge for an allocation previously recorded
+             * via `AllocationTagging_recordAllocation`. No-op if `tag` is
+             * `-1`.
+             */
+            ENGINE_API void AllocationTagging_recordRelease(const int tag, const std::size_t size) NOTHROWS;
+            ENGINE_API TAKErr AllocationTagging_getSnapshot(AllocationTaggingSnapshot *value) NOTHROWS;
+            /**
+             * Writes a human readable report of live bytes per tag and the
+             * top call sites. If `previous` is specified, allocation rates
+             * over the interval between the snapshots are included.
+             */
+            ENGINE_API TAKErr AllocationTagging_report(DataOutput2 &sink, const AllocationTaggingSnapshot &current, const AllocationTaggingSnapshot *previous) NOTHROWS;
+            /**
+             * Periodically logs a report, at `TELL_Info`, covering the
+             * interval since the last report. Reporting is disabled if
+             * `millis` is not positive.
+             */
+            ENGINE_API TAKErr AllocationTagging_setReportInterval(const int64_t millis) NOTHROWS;
+            ENGINE_API const char *AllocationTag_getName(const AllocationTag tag) NOTHROWS;
+
+            /**
+             * Sets the current thread's tag for the lifetime of the
+             * instance, restoring the previous tag on destruction.
+             */
+            class AllocationTagScope
+            {
+            public :
+                AllocationTagScope(const AllocationTag tag) NOTHROWS :
+                    previous(AllocationTagging_setTag(tag))
+                {}
+                ~AllocationTagScope() NOTHROWS
+                {
+                    AllocationTagging_setTag(previous);
+                }
+            private :
+                AllocationTagScope(const AllocationTagScope &) = delete;
+                AllocationTagScope &operator=(const AllocationTagScope &) = delete;
+            private :
+                AllocationTag previous;
+            };
+        }
+    }
+}
+
+#define TE_ALLOCATION_TAG_CONCAT_IMPL(a, b) a##b
+#define TE_ALLOCATION_TAG_CONCAT(a, b) TE_ALLOCATION_TAG_CONCAT_IMPL(a, b)
+
+/** Charges allocations for the remainder of the enclosing block to `tag` */
+#define TE_ALLOCATION_TAG(tag) \
+    ::TAK::Engine::Util::AllocationTagScope TE_ALLOCATION_TAG_CONCAT(te_allocation_tag_, __LINE__)(::TAK::Engine::Util::tag)
+
+#endif
@@ -0,0 +1,498 @@
+#include "util/AsyncHttpClient.h"
+
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "port/String.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "thread/Thread.h"
+#include "util/AllocationTagging.h"
+#include "util/URI.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+
+namespace
+{
+    const char * const DEFAULT_USER_AGENT = "TAK";
+
+    // curl_multi_poll and curl_multi_wakeup were introduced with libcurl
+    // 7.68.0; older versions wait without the ability to be woken
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define TE_CURL_MULTI_WAKEUP 1
+#endif
+
+    /**
+     * Waits for activity on the transfers, for at most the specified
+     * interval, or until woken by `wakeup`.
+     */
+    void waitForActivity(CURLM *multi) NOTHROWS
+    {
+        int numfds = 0;
+#ifdef TE_CURL_MULTI_WAKEUP
+        curl_multi_poll(multi, nullptr, 0u, 1000, &numfds);
+#else
+        // the wait is kept short so that submitted and canceled requests are
+        // picked up promptly. curl_multi_wait returns immediately if there
+        // is nothing to wait on
+        if (curl_multi_wait(multi, nullptr, 0u, 50, &numfds) != CURLM_OK || !numfds)
+            Thread_sleep(50LL);
+#endif
+    }
+
+    /** wakes the IO thread from `waitForActivity` */
+    void wakeup(CURLM *multi) NOTHROWS
+    {
+#ifdef TE_CURL_MULTI_WAKEUP
+        curl_multi_wakeup(multi);
+#else
+        (void)multi;
+#endif
+    }
+
+    struct Transfer
+    {
+        int64_t id;
+        std::string url;
+        AsyncHttpClient::Callback *callback;
+        CURL *easy;
+        std::vector<uint8_t> data;
+        /** validators sent with the request */
+        std::string ifNoneMatch;
+        std::string ifModifiedSince;
+        /** validators received with the response */
+        std::string etag;
+        std::string lastModified;
+        curl_slist *headers;
+        /** storage for options that curl does not copy */
+        String userAgent;
+        String username;
+        String password;
+    };
+
+    size_t writeCallback(void *data, size_t size, size_t nmemb, void *userData)
+    {
+        TE_ALLOCATION_TAG(TEAT_NetworkReceive);
+        const std::size_t len = size * nmemb;
+        auto &buffer = static_cast<Transfer *>(userData)->data;
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        buffer.insert(buffer.end(), bytes, bytes + len);
+        return len;
+    }
+
+    /** returns the value if the header line is the named header */
+    bool parseHeader(std::string &value, const char *line, const std::size_t len, const char *name)
+    {
+        const std::size_t nameLen = strlen(name);
+        if (len <= nameLen || line[nameLen] != ':')
+            return false;
+        for (std::size_t i = 0u; i < nameLen; i++)
+            if (tolower((unsigned char)line[i]) != tolower((unsigned char)name[i]))
+                return false;
+        std::size_t start = nameLen + 1u;
+        std::size_t end = len;
+        while (start < end && isspace((unsigned char)line[start]))
+            start++;
+        while (end > start && isspace((unsigned char)line[end - 1u]))
+            end--;
+        value.assign(line + start, end - start);
+        return true;
+    }
+
+    size_t headerCallback(char *data, size_t size, size_t nmemb, void *userData)
+    {
+        const std::size_t len = size * nmemb;
+        auto &transfer = *static_cast<Transfer *>(userData);
+        // a new status line begins the headers for a redirect target
+        if (len > 5u && strncmp(data, "HTTP/", 5u) == 0) {
+            transfer.etag.clear();
+            transfer.lastModified.clear();
+        } else if (!parseHeader(transfer.etag, data, len, "ETag")) {
+            parseHeader(transfer.lastModified, data, len, "Last-Modified");
+        }
+        return len;
+    }
+}
+
+class AsyncHttpClient::Impl
+{
+public :
+    Impl(const Options &opts, const std::shared_ptr<HttpProtocolHandlerClientInterface> &clientInterface) NOTHROWS;
+    ~Impl() NOTHROWS;
+public :
+    TAKErr submit(int64_t *ids, const char **urls, const Validators *validators, const std::size_t count, Callback &callback) NOTHROWS;
+    TAKErr cancel(const int64_t id) NOTHROWS;
+    std::size_t getPendingCount() const NOTHROWS;
+private :
+    static void *threadRun(void *opaque);
+    void run() NOTHROWS;
+    /** configures the easy handle for the transfer; invoked on the IO thread */
+    bool start(Transfer &transfer) NOTHROWS;
+    void complete(std::unique_ptr<Transfer> transfer, const TAKErr code, const int responseCode) NOTHROWS;
+private :
+    const Options opts;
+    std::shared_ptr<HttpProtocolHandlerClientInterface> clientInterface;
+    CURLM *multi;
+    ThreadPtr thread;
+
+    mutable Mutex mutex;
+    bool terminate;
+    int64_t nextId;
+    std::size_t pending;
+    /** requests not yet handed to the IO thread */
+    std::vector<std::unique_ptr<Transfer>> submitted;
+    std::set<int64_t> canceled;
+
+    /** requests in flight; only accessed by the IO thread */
+    std::map<int64_t, std::unique_ptr<Transfer>> active;
+};
+
+AsyncHttpClient::Options::Options() NOTHROWS :
+    maxHostConnections(6u),
+    maxConnections(0u),
+    connectTimeout(10000LL),
+    timeout(0LL)
+{}
+
+AsyncHttpClient::Validators::Validators() NOTHROWS :
+    etag(nullptr),
+    lastModified(nullptr)
+{}
+
+AsyncHttpClient::AsyncHttpClient(const Options &opts, const std::shared_ptr<HttpProtocolHandlerClientInterface> &clientInterface) NOTHROWS :
+    impl(new(std::nothrow) Impl(opts, clientInterface))
+{}
+
+AsyncHttpClient::~AsyncHttpClient() NOTHROWS
+{}
+
+TAKErr AsyncHttpClient::submit(int64_t *id, const char *url, Callback &callback) NOTHROWS
+{
+    return submit(id, &url, 1u, callback);
+}
+
+TAKErr AsyncHttpClient::submit(int64_t *ids, const char **urls, const std::size_t count, Callback &callback) NOTHROWS
+{
+    return submit(ids, urls, nullptr, count, callback);
+}
+
+TAKErr AsyncHttpClient::submit(int64_t *ids, const char **urls, const Validators *validators, const std::size_t count, Callback &callback) NOTHROWS
+{
+    if (!impl)
+        return TE_OutOfMemory;
+    return impl->submit(ids, urls, validators, count, callback);
+}
+
+TAKErr AsyncHttpClient::cancel(const int64_t id) NOTHROWS
+{
+    if (!impl)
+        return TE_OutOfMemory;
+    return impl->cancel(id);
+}
+
+std::size_t AsyncHttpClient::getPendingCount() const NOTHROWS
+{
+    return impl ? impl->getPendingCount() : 0u;
+}
+
+AsyncHttpClient::Callback::~Callback() NOTHROWS
+{}
+
+void AsyncHttpClient::Callback::validatorsReceived(const int64_t, const char *, const char *) NOTHROWS
+{}
+
+AsyncHttpClient::Impl::Impl(const Options &opts_, const std::shared_ptr<HttpProtocolHandlerClientInterface> &clientInterface_) NOTHROWS :
+    opts(opts_),
+    clientInterface(clientInterface_),
+    multi(curl_multi_init()),
+    thread(nullptr, nullptr),
+    terminate(false),
+    nextId(1LL),
+    pending(0u)
+{
+    if (!multi)
+        return;
+    // excess requests are queued by curl until a connection is available
+    if (opts.maxHostConnections)
+        curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)opts.maxHostConnections);
+    if (opts.maxConnections)
+        curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)opts.maxConnections);
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+
+    ThreadCreateParams params;
+    params.name = "AsyncHttpClient-io";
+    params.priority = TETP_Normal;
+    if (Thread_start(thread, threadRun, this, params) != TE_Ok) {
+        curl_multi_cleanup(multi);
+        multi = nullptr;
+    }
+}
+
+AsyncHttpClient::Impl::~Impl() NOTHROWS
+{
+    if (thread) {
+        {
+            Lock lock(mutex);
+            terminate = true;
+        }
+        wakeup(multi);
+        thread->join();
+        thread.reset();
+    }
+    if (multi)
+        curl_multi_cleanup(multi);
+}
+
+TAKErr AsyncHttpClient::Impl::submit(int64_t *ids, const char **urls, const Validators *validators, const std::size_t count, Callback &callback) NOTHROWS
+{
+    if (!urls)
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < count; i++)
+        if (!urls[i])
+            return TE_InvalidArg;
+    if (!multi)
+        return TE_IllegalState;
+
+    TAKErr code(TE_Ok);
+    // the batch is prepared in full before it is queued, so that a failure
+    // does not leave part of the batch outstanding
+    std::vector<std::unique_ptr<Transfer>> batch;
+    TE_BEGIN_TRAP() {
+        batch.reserve(count);
+        for (std::size_t i = 0u; i < count; i++) {
+            std::unique_ptr<Transfer> transfer(new Transfer());
+            transfer->url = urls[i];
+            transfer->callback = &callback;
+            transfer->easy = nullptr;
+            transfer->headers = nullptr;
+            if (validators && validators[i].etag)
+                transfer->ifNoneMatch = validators[i].etag;
+            if (validators && validators[i].lastModified)
+                transfer->ifModifiedSince = validators[i].lastModified;
+            batch.push_back(std::move(transfer));
+        }
+    } TE_END_TRAP(code);
+    TE_CHECKRETURN_CODE(code);
+
+    {
+        Lock lock(mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        if (terminate)
+            return TE_IllegalState;
+
+        TE_BEGIN_TRAP() {
+            submitted.reserve(submitted.size() + count);
+        } TE_END_TRAP(code);
+        TE_CHECKRETURN_CODE(code);
+        for (std::size_t i = 0u; i < count; i++) {
+            batch[i]->id = nextId++;
+            if (ids)
+                ids[i] = batch[i]->id;
+            submitted.push_back(std::move(batch[i]));
+        }
+        pending += count;
+    }
+    wakeup(multi);
+    return code;
+}
+
+TAKErr AsyncHttpClient::Impl::cancel(const int64_t id) NOTHROWS
+{
+    if (!multi)
+        return TE_IllegalState;
+    {
+        Lock lock(mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        canceled.insert(id);
+    }
+    wakeup(multi);
+    return TE_Ok;
+}
+
+std::size_t AsyncHttpClient::Impl::getPendingCount() const NOTHROWS
+{
+    Lock lock(mutex);
+    return pending;
+}
+
+void *AsyncHttpClient::Impl::threadRun(void *opaque)
+{
+    static_cast<Impl *>(opaque)->run();
+    return nullptr;
+}
+
+void AsyncHttpClient::Impl::run() NOTHROWS
+{
+    std::vector<std::unique_ptr<Transfer>> starting;
+    std::set<int64_t> canceling;
+    while (true) {
+        bool exiting;
+        {
+            Lock lock(mutex);
+            exiting = terminate;
+            starting.swap(submitted);
+            canceling.swap(canceled);
+        }
+
+        // start new requests, unless canceled before they were started
+        for (auto &transfer : starting) {
+            if (exiting || canceling.erase(transfer->id)) {
+                complete(std::move(transfer), TE_Canceled, 0);
+            } else if (!start(*transfer)) {
+                complete(std::move(transfer), TE_IO, 0);
+            } else {
+                const int64_t id = transfer->id;
+                active[id] = std::move(transfer);
+            }
+        }
+        starting.clear();
+
+        // requests in flight
+        if (exiting) {
+            while (!active.empty()) {
+                auto entry = active.begin();
+                std::unique_ptr<Transfer> transfer(std::move(entry->second));
+                active.erase(entry);
+                complete(std::move(transfer), TE_Canceled, 0);
+            }
+            break;
+        }
+        for (auto id : canceling) {
+            auto entry = active.find(id);
+            if (entry == active.end())
+                continue;
+            std::unique_ptr<Transfer> transfer(std::move(entry->second));
+            active.erase(entry);
+            complete(std::move(transfer), TE_Canceled, 0);
+        }
+        canceling.clear();
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int queued;
+        while (CURLMsg *msg = curl_multi_info_read(multi, &queued)) {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+            Transfer *done = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&done);
+            if (!done)
+                continue;
+            auto entry = active.find(done->id);
+            if (entry == active.end())
+                continue;
+            std::unique_ptr<Transfer> transfer(std::move(entry->second));
+            active.erase(entry);
+
+            long responseCode = 0;
+            curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &responseCode);
+            TAKErr code;
+            if (msg->data.result != CURLE_OK)
+                code = TE_IO;
+            else if (responseCode == 304)
+                code = TE_Done;
+            else if (responseCode == 429 || responseCode == 503)
+                code = TE_Busy;
+            else if (responseCode / 100 == 2 || (responseCode == 0 && !transfer->data.empty()))
+                // non-HTTP schemes do not report a response code
+                code = TE_Ok;
+            else
+                code = TE_IO;
+            complete(std::move(transfer), code, (int)responseCode);
+        }
+
+        waitForActivity(multi);
+    }
+}
+
+bool AsyncHttpClient::Impl::start(Transfer &transfer) NOTHROWS
+{
+    transfer.easy = curl_easy_init();
+    if (!transfer.easy)
+        return false;
+
+    CURL *easy = transfer.easy;
+    if (curl_easy_setopt(easy, CURLOPT_URL, transfer.url.c_str()) != CURLE_OK)
+        return false;
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, (void *)&transfer);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, (void *)&transfer);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, (void *)&transfer);
+    if (!transfer.ifNoneMatch.empty())
+        transfer.headers = curl_slist_append(transfer.headers, ("If-None-Match: " + transfer.ifNoneMatch).c_str());
+    if (!transfer.ifModifiedSince.empty())
+        transfer.headers = curl_slist_append(transfer.headers, ("If-Modified-Since: " + transfer.ifModifiedSince).c_str());
+    if (transfer.headers)
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.headers);
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    // wait for a multiplexed stream rather than opening another connection
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    if (opts.connectTimeout > 0LL)
+        curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, (long)opts.connectTimeout);
+    if (opts.timeout > 0LL)
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, (long)opts.timeout);
+
+    const char *userAgent = DEFAULT_USER_AGENT;
+    if (clientInterface) {
+        String host;
+        URI_parse(nullptr, nullptr, &host, nullptr, nullptr, nullptr, transfer.url.c_str());
+        if (host) {
+            clientInterface->getUserAgent(&transfer.userAgent, host);
+            if (transfer.userAgent)
+                userAgent = transfer.userAgent.get();
+            if (clientInterface->allowRedirect(host))
+                curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+            if (!clientInterface->shouldVerifySSLPeer(host))
+                curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
+            if (!clientInterface->shouldVerifySSLHost(host))
+                curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0L);
+            if (clientInterface->shouldAuthenticateHost(transfer.url.c_str(), 0) &&
+                clientInterface->getBasicAuth(&transfer.username, &transfer.password, transfer.url.c_str()) == TE_Ok) {
+
+                if (transfer.username)
+                    curl_easy_setopt(easy, CURLOPT_USERNAME, transfer.username.get());
+                if (transfer.password)
+                    curl_easy_setopt(easy, CURLOPT_PASSWORD, transfer.password.get());
+            }
+        }
+    }
+    curl_easy_setopt(easy, CURLOPT_USERAGENT, userAgent);
+
+    return curl_multi_add_handle(multi, easy) == CURLM_OK;
+}
+
+void AsyncHttpClient::Impl::complete(std::unique_ptr<Transfer> transfer, const TAKErr code, const int responseCode) NOTHROWS
+{
+    if (transfer->easy) {
+        curl_multi_remove_handle(multi, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        transfer->easy = nullptr;
+    }
+    if (transfer->headers) {
+        curl_slist_free_all(transfer->headers);
+        transfer->headers = nullptr;
+    }
+    {
+        Lock lock(mutex);
+        pending--;
+    }
+    if (code != TE_Canceled && (!transfer->etag.empty() || !transfer->lastModified.empty()))
+        transfer->callback->validatorsReceived(transfer->id,
+                                               transfer->etag.empty() ? nullptr : transfer->etag.c_str(),
+                                               transfer->lastModified.empty() ? nullptr : transfer->lastModified.c_str());
+    transfer->callback->requestCompleted(transfer->id, code, responseCode, transfer->data.empty() ? nullptr : transfer->data.data(), transfer->data.size());
+}
@@ -0,0 +1,152 @@
+#ifndef TAK_ENGINE_UTIL_ASYNCHTTPCLIENT_H_INCLUDED
+#define TAK_ENGINE_UTIL_ASYNCHTTPCLIENT_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+#include "util/HttpProtocolHandler.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Issues HTTP GET requests asynchronously. All outstanding
+             * requests are serviced concurrently by a single IO thread, so a
+             * batch of requests is in flight at once rather than one after
+             * another. Connections are kept alive and reused, and HTTP/2
+             * streams are multiplexed over a single connection per host
+             * where the server supports it.
+             *
+             * <P>This class is thread-safe.
+             */
+            class ENGINE_API AsyncHttpClient
+            {
+            public :
+                class ENGINE_API Callback;
+
+                struct ENGINE_API Options
+                {
+                    Options() NOTHROWS;
+
+                    /**
+                     * The maximum number of concurrent connections to a
+                     * single host; requests in excess are queued. `0` for no
+                     * limit.
+                     */
+                    std::size_t maxHostConnections;
+                    /**
+                     * The maximum number of concurrent connections; `0` for
+                     * no limit.
+                     */
+                    std::size_t maxConnections;
+                    /** connect timeout, in milliseconds */
+                    int64_t connectTimeout;
+                    /** overall request timeout, in milliseconds; `0` for none */
+                    int64_t timeout;
+                };
+
+                /**
+                 * Cache validators for a conditional request. A request
+                 * carrying validators completes with `TE_Done` if the server
+                 * responds 304 (Not Modified).
+                 */
+                struct ENGINE_API Validators
+                {
+                    Validators() NOTHROWS;
+
+                    /** sent as `If-None-Match`; may be `nullptr` */
+                    const char *etag;
+                    /** sent as `If-Modified-Since`; may be `nullptr` */
+                    const char *lastModified;
+                };
+            private :
+                class Impl;
+            public :
+                /**
+                 * @param opts              The client options
+                 * @param clientInterface   Supplies the User-Agent, redirect,
+                 *                          SSL verification and basic auth
+                 *                          policy for each host; may be
+                 *                          `nullptr` for defaults
+                 */
+                AsyncHttpClient(const Options &opts, const std::shared_ptr<HttpProtocolHandlerClientInterface> &clientInterface = nullptr) NOTHROWS;
+                /**
+                 * Outstanding requests are canceled; their callbacks are
+                 * invoked with `TE_Canceled` before the destructor returns.
+                 */
+                ~AsyncHttpClient() NOTHROWS;
+            private :
+                AsyncHttpClient(const AsyncHttpClient &) NOTHROWS;
+            public :
+                /**
+                 * Submits a request. The callback must remain valid until it
+                 * is invoked.
+                 *
+                 * @param id    Returns the identifier for the request
+                 */
+                TAKErr submit(int64_t *id, const char *url, Callback &callback) NOTHROWS;
+                /**
+                 * Submits a batch of requests. The requests are issued
+                 * together; the callback is invoked once per request as each
+                 * completes, in order of completion. If submission fails, none
+                 * of the requests in the batch are issued.
+                 *
+                 * @param ids   Returns the identifiers for the requests; may
+                 *              be `nullptr`
+                 */
+                TAKErr submit(int64_t *ids, const char **urls, const std::size_t count, Callback &callback) NOTHROWS;
+                /**
+                 * Submits a batch of conditional requests.
+                 *
+                 * @param validators    The validators for each request; may
+                 *                      be `nullptr`
+                 */
+                TAKErr submit(int64_t *ids, const char **urls, const Validators *validators, const std::size_t count, Callback &callback) NOTHROWS;
+                /**
+                 * Cancels the request. The request's callback is invoked with
+                 * `TE_Canceled`, unless the request has already completed.
+                 */
+                TAKErr cancel(const int64_t id) NOTHROWS;
+                /** returns the number of submitted requests not yet completed */
+                std::size_t getPendingCount() const NOTHROWS;
+            private :
+                std::shared_ptr<Impl> impl;
+            };
+
+            class ENGINE_API AsyncHttpClient::Callback
+            {
+            protected :
+                virtual ~Callback() NOTHROWS = 0;
+            public :
+                /**
+                 * Invoked on the client's IO thread when a request completes.
+                 * The response body is only valid for the duration of the
+                 * call. Implementations should not block.
+                 *
+                 * @param code          `TE_Ok` for a 2xx response, `TE_Done`
+                 *                      for a 304 response to a conditional
+                 *                      request, `TE_Busy` if the server
+                 *                      responded 429 or 503,
+                 *                      `TE_Canceled` if the request was
+                 *                      canceled and `TE_IO` otherwise
+                 * @param responseCode  The HTTP response code, `0` if no
+                 *                      response was received
+                 */
+                virtual void requestCompleted(const int64_t id, const TAKErr code, const int responseCode, const uint8_t *data, const std::size_t dataLen) NOTHROWS = 0;
+                /**
+                 * Invoked immediately before `requestCompleted` if the
+                 * response carried an `ETag` or `Last-Modified` header.
+                 * Either argument may be `nullptr`.
+                 *
+                 * <P>The default implementation does nothing.
+                 */
+                virtual void validatorsReceived(const int64_t id, const char *etag, const char *lastModified) NOTHROWS;
+            };
+        }
+    }
+}
+
+#endif
@@ -1,9 +1,11 @@
 #include "util/AttributeSet.h"
 
+#include "port/String.h"
 #include "util/Logging2.h"
 
 using namespace atakmap::util;
 
+using namespace TAK::Engine::Port;
 using namespace TAK::Engine::Util;
 
 #define MEM_FN( fn )    "atakmap::util::AttributeSet::" fn ": "
@@ -15,7 +17,7 @@ NOTHROWS
 void
 AttributeSet::clear()
 {
-    attrItems.clear();
+    entries.clear();
 }
 
 
@@ -25,10 +27,10 @@ const
 NOTHROWS
 {
     std::vector<const char*> result;
-    result.reserve(attrItems.size());
-    auto iter = attrItems.begin();
-    while (iter != attrItems.end()) {
-        result.push_back(iter->first.c_str());
+    result.reserve(entries.size());
+    auto iter = entries.begin();
+    while (iter != entries.end()) {
+        result.push_back(iter->key);
         ++iter;
     }
 
@@ -62,39 +64,15 @@ const AttributeSet&
 AttributeSet::getAttributeSet(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getAttributeSet")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != ATTRIBUTE_SET)
-    {
-        throwNotFound(attrName, "ATTRIBUTE_SET", MEM_FN("getAttributeSet"));
-    }
-
-    return *static_cast<const BasicAttrItem<std::shared_ptr<AttributeSet>, ATTRIBUTE_SET> *>(iter->second.get())->get();
+    const Entry &entry = getEntry(attrName, ATTRIBUTE_SET, "ATTRIBUTE_SET", MEM_FN("getAttributeSet"));
+    return *static_cast<const BasicAttrItem<std::shared_ptr<AttributeSet>, ATTRIBUTE_SET> *>(entry.item.get())->get();
 }
 
 void
 AttributeSet::getAttributeSet(std::shared_ptr<AttributeSet> &value, const char* attrName)
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getAttributeSet")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != ATTRIBUTE_SET)
-    {
-        throwNotFound(attrName, "ATTRIBUTE_SET", MEM_FN("getAttributeSet"));
-    }
-
-    value = static_cast<const BasicAttrItem<std::shared_ptr<AttributeSet>, ATTRIBUTE_SET> *>(iter->second.get())->get();
+    const Entry &entry = getEntry(attrName, ATTRIBUTE_SET, "ATTRIBUTE_SET", MEM_FN("getAttributeSet"));
+    value = static_cast<const BasicAttrItem<std::shared_ptr<AttributeSet>, ATTRIBUTE_SET> *>(entry.item.get())->get();
 }
 
 AttributeSet::Type
@@ -107,9 +85,9 @@ const
             "Received NULL attributeName");
     }
 
-    auto iter = attrItems.find(attrName);
+    const Entry *entry = findEntry(attrName);
 
-    if (iter == attrItems.end())
+    if (!entry)
     {
         std::ostringstream msg;
         msg << MEM_FN("getAttributeType") <<
@@ -118,7 +96,7 @@ const
         throw std::invalid_argument(msg.str());
     }
 
-    return iter->second->attrType();
+    return entry->type;
 }
 
 
@@ -126,249 +104,110 @@ AttributeSet::Blob
 AttributeSet::getBlob(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getBlob")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != BLOB)
-    {
-        throwNotFound(attrName, "BLOB", MEM_FN("getBlob"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
+    const Entry &entry = getEntry(attrName, BLOB, "BLOB", MEM_FN("getBlob"));
+    if(entry.null)
         return AttributeSet::Blob(NULL, NULL);
     else
-        return static_cast<const BasicArrayAttrItem<uint8_t, BLOB> &>(value).get();
+        return static_cast<const BasicArrayAttrItem<uint8_t, BLOB> &>(*entry.item).get();
 }
 
 
-std::pair<const AttributeSet::Blob*, const AttributeSet::Blob*>
+AttributeSet::BlobArray
 AttributeSet::getBlobArray(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getBlobArray")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != BLOB_ARRAY)
-    {
-        throwNotFound(attrName, "BLOB_ARRAY", MEM_FN("getBlobArray"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
-        return std::pair<const AttributeSet::Blob *, const AttributeSet::Blob *>(NULL, NULL);
+    const Entry &entry = getEntry(attrName, BLOB_ARRAY, "BLOB_ARRAY", MEM_FN("getBlobArray"));
+    if(entry.null)
+        return AttributeSet::BlobArray(NULL, NULL);
     else
-        return static_cast<const BlobArrayAttrItem &>(value).get();
+        return static_cast<const BlobArrayAttrItem &>(*entry.item).get();
 }
 
 
-
 double
 AttributeSet::getDouble(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getDouble")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != DOUBLE)
-    {
-        throwNotFound(attrName, "DOUBLE", MEM_FN("getDouble"));
-    }
-
-    return static_cast<const BasicAttrItem<double, DOUBLE> *>(iter->second.get())->get();
+    return getEntry(attrName, DOUBLE, "DOUBLE", MEM_FN("getDouble")).scalar.d;
 }
 
 
-
-std::pair<const double*, const double*>
+AttributeSet::DoubleArray
 AttributeSet::getDoubleArray(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getDoubleArray")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != DOUBLE_ARRAY)
-    {
-        throwNotFound(attrName, "DOUBLE_ARRAY", MEM_FN("getDoubleArray"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
-        return std::pair<const double *, const double *>(NULL, NULL);
+    const Entry &entry = getEntry(attrName, DOUBLE_ARRAY, "DOUBLE_ARRAY", MEM_FN("getDoubleArray"));
+    if(entry.null)
+        return AttributeSet::DoubleArray(NULL, NULL);
     else
-        return static_cast<const BasicArrayAttrItem<double, DOUBLE_ARRAY> &>(value).get();
+        return static_cast<const BasicArrayAttrItem<double, DOUBLE_ARRAY> &>(*entry.item).get();
 }
 
 
-
 int
 AttributeSet::getInt(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getInt")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != INT)
-    {
-        throwNotFound(attrName, "INT", MEM_FN("getInt"));
-    }
-
-    return static_cast<const BasicAttrItem<int, INT> *>(iter->second.get())->get();
+    return getEntry(attrName, INT, "INT", MEM_FN("getInt")).scalar.i;
 }
 
 
-
-std::pair<const int*, const int*>
+AttributeSet::IntArray
 AttributeSet::getIntArray(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getIntArray")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != INT_ARRAY)
-    {
-        throwNotFound(attrName, "INT_ARRAY", MEM_FN("getIntArray"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
-        return std::pair<const int *, const int *>(NULL, NULL);
+    const Entry &entry = getEntry(attrName, INT_ARRAY, "INT_ARRAY", MEM_FN("getIntArray"));
+    if(entry.null)
+        return AttributeSet::IntArray(NULL, NULL);
     else
-        return static_cast<const BasicArrayAttrItem<int, INT_ARRAY> &>(value).get();
+        return static_cast<const BasicArrayAttrItem<int, INT_ARRAY> &>(*entry.item).get();
 }
 
 
-
 int64_t
 AttributeSet::getLong(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getLong")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != LONG)
-    {
-        throwNotFound(attrName, "LONG", MEM_FN("getLong"));
-    }
-
-    return static_cast<const BasicAttrItem<int64_t, LONG> *>(iter->second.get())->get();
+    return getEntry(attrName, LONG, "LONG", MEM_FN("getLong")).scalar.l;
 }
 
 
-
-std::pair<const int64_t*, const int64_t*>
+AttributeSet::LongArray
 AttributeSet::getLongArray(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getLongArray")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != LONG_ARRAY)
-    {
-        throwNotFound(attrName, "LONG_ARRAY", MEM_FN("getLongArray"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
-        return std::pair<const int64_t *, const int64_t *>(NULL, NULL);
+    const Entry &entry = getEntry(attrName, LONG_ARRAY, "LONG_ARRAY", MEM_FN("getLongArray"));
+    if(entry.null)
+        return AttributeSet::LongArray(NULL, NULL);
     else
-        return static_cast<const BasicArrayAttrItem<int64_t, LONG_ARRAY> &>(value).get();
+        return static_cast<const BasicArrayAttrItem<int64_t, LONG_ARRAY> &>(*entry.item).get();
 }
 
 
-
 const char*
 AttributeSet::getString(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getString")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != STRING)
-    {
-        throwNotFound(attrName, "STRING", MEM_FN("getString"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
+    const Entry &entry = getEntry(attrName, STRING, "STRING", MEM_FN("getString"));
+    if(entry.null)
         return nullptr;
     else
-        return static_cast<const BasicAttrItem<std::string, STRING> &>(value).get().c_str();
+        return static_cast<const BasicAttrItem<std::string, STRING> &>(*entry.item).get().c_str();
 }
 
 
-
-std::pair<const char* const*, const char* const*>
+AttributeSet::StringArray
 AttributeSet::getStringArray(const char* attrName)
 const
 {
-    if (!attrName)
-    {
-        throw std::invalid_argument(MEM_FN("getStringArray")
-            "Received NULL attributeName");
-    }
-
-    auto iter = attrItems.find(attrName);
-
-    if (iter == attrItems.end() || iter->second->attrType() != STRING_ARRAY)
-    {
-        throwNotFound(attrName, "STRING_ARRAY", MEM_FN("getStringArray"));
-    }
-
-    const AttrItem &value = *iter->second;
-    if(value.isNull())
-        return std::pair<const char * const *, const char * const *>(NULL, NULL);
+    const Entry &entry = getEntry(attrName, STRING_ARRAY, "STRING_ARRAY", MEM_FN("getStringArray"));
+    if(entry.null)
+        return AttributeSet::StringArray(NULL, NULL);
     else
-        return static_cast<const StringArrayAttrItem &>(value).get();
+        return static_cast<const StringArrayAttrItem &>(*entry.item).get();
 }
 
 
-
 void
 AttributeSet::removeAttribute(const char* attrName)
 {
@@ -378,9 +217,9 @@ AttributeSet::removeAttribute(const char* attrName)
             "Received NULL attributeName");
     }
 
-    auto attrIter = attrItems.find(attrName);
-    if (attrIter != attrItems.end()) {
-        attrItems.erase(attrIter);
+    auto iter = std::lower_bound(entries.begin(), entries.end(), attrName, EntryLess());
+    if (iter != entries.end() && !strcmp(iter->key, attrName)) {
+        entries.erase(iter);
     }
 }
 
@@ -396,7 +235,7 @@ AttributeSet::setAttributeSet(const char* attrName,
             "Received NULL attributeName");
     }
 
-    this->attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicAttrItem<std::shared_ptr<AttributeSet>, ATTRIBUTE_SET>(std::shared_ptr<AttributeSet>(new AttributeSet(value))));
+    setItem(attrName, ATTRIBUTE_SET, std::shared_ptr<AttrItem>(new BasicAttrItem<std::shared_ptr<AttributeSet>, ATTRIBUTE_SET>(std::shared_ptr<AttributeSet>(new AttributeSet(value)))));
 }
 
 
@@ -412,9 +251,9 @@ AttributeSet::setBlob(const char* attrName,
     }
 
     if(!value.first)
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<BLOB>());
+        setItem(attrName, BLOB, std::shared_ptr<AttrItem>());
     else
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicArrayAttrItem<uint8_t, BLOB>(value.first, value.second));
+        setItem(attrName, BLOB, std::shared_ptr<AttrItem>(new BasicArrayAttrItem<uint8_t, BLOB>(value.first, value.second)));
 }
 
 
@@ -430,9 +269,9 @@ AttributeSet::setBlobArray(const char* attrName,
     }
 
     if(!value.first)
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<BLOB_ARRAY>());
+        setItem(attrName, BLOB_ARRAY, std::shared_ptr<AttrItem>());
     else
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new BlobArrayAttrItem(value.first, value.second));
+        setItem(attrName, BLOB_ARRAY, std::shared_ptr<AttrItem>(new BlobArrayAttrItem(value.first, value.second)));
 }
 
 
@@ -447,7 +286,11 @@ AttributeSet::setDouble(const char* attrName,
             "Received NULL attributeName");
     }
 
-    attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicAttrItem<double, DOUBLE>(value));
+    Entry &entry = insertEntry(attrName);
+    entry.item.reset();
+    entry.type = DOUBLE;
+    entry.null = false;
+    entry.scalar.d = value;
 }
 
 
@@ -463,9 +306,9 @@ AttributeSet::setDoubleArray(const char* attrName,
     }
 
     if(!value.first)
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<DOUBLE_ARRAY>());
+        setItem(attrName, DOUBLE_ARRAY, std::shared_ptr<AttrItem>());
     else
-        attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicArrayAttrItem<double, DOUBLE_ARRAY>(value.first, value.second));
+        setItem(attrName, DOUBLE_ARRAY, std::shared_ptr<AttrItem>(new BasicArrayAttrItem<double, DOUBLE_ARRAY>(value.first, value.second)));
 }
 
 
@@ -480,7 +323,11 @@ AttributeSet::setInt(const char* attrName,
             "Received NULL attributeName");
     }
 
-    attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicAttrItem<int, INT>(value));
+    Entry &entry = insertEntry(attrName);
+    entry.item.reset();
+    entry.type = INT;
+    entry.null = false;
+    entry.scalar.i = value;
 }
 
 
@@ -494,10 +341,11 @@ AttributeSet::setIntArray(const char* attrName,
         throw std::invalid_argument(MEM_FN("setIntArray")
             "Received NULL attributeName");
     }
+
     if(!value.first)
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<INT_ARRAY>());
+        setItem(attrName, INT_ARRAY, std::shared_ptr<AttrItem>());
     else
-        attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicArrayAttrItem<int, INT_ARRAY>(value.first, value.second));
+        setItem(attrName, INT_ARRAY, std::shared_ptr<AttrItem>(new BasicArrayAttrItem<int, INT_ARRAY>(value.first, value.second)));
 }
 
 
@@ -512,7 +360,11 @@ AttributeSet::setLong(const char* attrName,
             "Received NULL attributeName");
     }
 
-    attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicAttrItem<int64_t, LONG>(value));
+    Entry &entry = insertEntry(attrName);
+    entry.item.reset();
+    entry.type = LONG;
+    entry.null = false;
+    entry.scalar.l = value;
 }
 
 
@@ -526,10 +378,11 @@ AttributeSet::setLongArray(const char* attrName,
         throw std::invalid_argument(MEM_FN("setLongArray")
             "Received NULL attributeName");
     }
+
     if(!value.first)
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<LONG_ARRAY>());
+        setItem(attrName, LONG_ARRAY, std::shared_ptr<AttrItem>());
     else
-        attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicArrayAttrItem<int64_t, LONG_ARRAY>(value.first, value.second));
+        setItem(attrName, LONG_ARRAY, std::shared_ptr<AttrItem>(new BasicArrayAttrItem<int64_t, LONG_ARRAY>(value.first, value.second)));
 }
 
 
@@ -545,9 +398,9 @@ AttributeSet::setString(const char* attrName,
     }
 
     if (value)
-        attrItems[attrName] = std::shared_ptr<AttrItem>(new BasicAttrItem<std::string, STRING>(value));
+        setItem(attrName, STRING, std::shared_ptr<AttrItem>(new BasicAttrItem<std::string, STRING>(value)));
     else
-        attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<STRING>());
+        setItem(attrName, STRING, std::shared_ptr<AttrItem>());
 }
 
 
@@ -561,10 +414,11 @@ AttributeSet::setStringArray(const char* attrName,
         throw std::invalid_argument(MEM_FN("setStringArray")
             "Received NULL attributeName");
     }
+
     if(!value.first)
-        this->attrItems[attrName] = std::shared_ptr<AttrItem>(new NullAttrItem<STRING_ARRAY>());
+        setItem(attrName, STRING_ARRAY, std::shared_ptr<AttrItem>());
     else
-        attrItems[attrName] = std::shared_ptr<AttrItem>(new StringArrayAttrItem(value.first, value.second));
+        setItem(attrName, STRING_ARRAY, std::shared_ptr<AttrItem>(new StringArrayAttrItem(value.first, value.second)));
 }
 
 AttributeSet::StringArrayAttrItem::~StringArrayAttrItem() { }
@@ -630,6 +484,67 @@ std::pair<const AttributeSet::Blob *, const AttributeSet::Blob *> AttributeSet::
 //==================================
 
 
+const AttributeSet::Entry*
+AttributeSet::findEntry(const char* key)
+const
+NOTHROWS
+{
+    auto iter = std::lower_bound(entries.begin(), entries.end(), key, EntryLess());
+    if (iter == entries.end() || strcmp(iter->key, key))
+        return nullptr;
+    return &(*iter);
+}
+
+const AttributeSet::Entry&
+AttributeSet::getEntry(const char* attrName,
+    Type type,
+    const char* attributeType,
+    const char* errHdr)
+const
+{
+    if (!attrName)
+    {
+        throw std::invalid_argument(std::string(errHdr) +
+            "Received NULL attributeName");
+    }
+
+    const Entry *entry = findEntry(attrName);
+
+    if (!entry || entry->type != type)
+    {
+        throwNotFound(attrName, attributeType, errHdr);
+    }
+
+    return *entry;
+}
+
+AttributeSet::Entry&
+AttributeSet::insertEntry(const char* attrName)
+{
+    auto iter = std::lower_bound(entries.begin(), entries.end(), attrName, EntryLess());
+    if (iter != entries.end() && !strcmp(iter->key, attrName))
+        return *iter;
+
+    Entry entry;
+    // copies of an interned String share the interned content
+    entry.key = String_intern(attrName);
+    entry.type = INT;
+    entry.null = true;
+    entry.scalar.l = 0LL;
+    return *entries.insert(iter, entry);
+}
+
+void
+AttributeSet::setItem(const char* attrName,
+    Type type,
+    const std::shared_ptr<AttrItem>& item)
+{
+    Entry &entry = insertEntry(attrName);
+    entry.item = item;
+    entry.type = type;
+    entry.null = !item;
+}
+
 bool
 AttributeSet::invalidBlob(const Blob& blob)
 {
@@ -27,6 +27,9 @@
     - Created AttrItem base and concrete types
     - Since attr items are all immutable, copying an attribute set is trivial (relies on std::shared_ptr<>).
     - Rely on built-in copy and move constructors
+    - Keys are interned via Port::String_intern; items are stored in a
+      flat vector sorted by key. Scalar and null values are stored inline,
+      only strings, arrays and nested sets are shared.
  */
 
 
@@ -54,6 +57,7 @@
 #include <unordered_map>
 
 #include "port/Platform.h"
+#include "port/String.h"
 
 
 ////========================================================================////
@@ -129,7 +133,7 @@ class ENGINE_API AttributeSet
     containsAttribute (const char* key)
         const
         NOTHROWS
-      { return attrItems.find(key) != attrItems.end(); }
+      { return findEntry(key) != nullptr; }
 
     std::vector<const char*>
     getAttributeNames ()
@@ -425,15 +429,6 @@ class ENGINE_API AttributeSet
           virtual bool isNull() const = 0;
       };
 
-      template <int type>
-      class NullAttrItem : public AttrItem {
-      public:
-          NullAttrItem() { }
-          virtual ~NullAttrItem() { }
-          virtual Type attrType() const override { return (Type)type; }
-          bool isNull() const { return true; }
-      };
-
       template <typename T, int type>
       class BasicAttrItem : public AttrItem {
       public:
@@ -508,11 +503,72 @@ class ENGINE_API AttributeSet
           bool nullValue;
       };
 
+      //
+      // A single attribute. `key` references the interned name. INT, LONG
+      // and DOUBLE values, and null values of any type, are held in
+      // `scalar`/`null` without an item.
+      //
+      struct Entry
+        {
+          // normally interned; owns a private copy if interning failed
+          TAK::Engine::Port::String key;
+          std::shared_ptr<AttrItem> item;
+          union
+            {
+              int i;
+              int64_t l;
+              double d;
+            } scalar;
+          Type type;
+          bool null;
+        };
+
+      struct EntryLess
+        {
+          bool operator() (const Entry& a, const char* b) const NOTHROWS
+            { return strcmp(a.key, b) < 0; }
+        };
+
     //==================================
     //  PRIVATE IMPLEMENTATION
     //==================================
 
 
+    //
+    // Returns the entry for the supplied key or NULL if not present.
+    //
+    const Entry*
+    findEntry (const char* key)
+        const
+        NOTHROWS;
+
+    //
+    // Returns the entry for the supplied key if it is present and of the
+    // specified type, otherwise throws std::invalid_argument.
+    //
+    const Entry&
+    getEntry (const char* attributeName,
+              Type type,
+              const char* attributeType,
+              const char* errHdr)
+        const;
+
+    //
+    // Returns the entry for the supplied key, inserting an empty entry if
+    // the key is not present.
+    //
+    Entry&
+    insertEntry (const char* attributeName);
+
+    //
+    // Assigns the supplied item, or a null value if the item is NULL, to
+    // the entry for the supplied key.
+    //
+    void
+    setItem (const char* attributeName,
+             Type type,
+             const std::shared_ptr<AttrItem>& item);
+
     static
     bool
     invalidBlob (const Blob& blob);
@@ -532,7 +588,7 @@ class ENGINE_API AttributeSet
     //  PRIVATE REPRESENTATION
     //==================================
 
-      std::unordered_map<std::string, std::shared_ptr<AttrItem>> attrItems;
+      std::vector<Entry> entries;
   };
 
 
@@ -0,0 +1,117 @@
+#include "util/ConcurrencyLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Thread;
+
+namespace
+{
+    /** latency, relative to baseline, beyond which the limit is reduced */
+    const double LATENCY_TOLERANCE = 2.0;
+    /** rate at which the baseline follows rising latencies */
+    const double BASELINE_DECAY = 1.0 / 64.0;
+    const double ERROR_DECREASE = 0.75;
+    const double BUSY_DECREASE = 0.5;
+    const int64_t MIN_BACKOFF = 500LL;
+    const int64_t MAX_BACKOFF = 30000LL;
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(const std::size_t minLimit_, const std::size_t maxLimit_, const std::size_t initialLimit_) NOTHROWS :
+    minLimit((double)std::max(minLimit_, (std::size_t)1u)),
+    maxLimit((double)std::max(std::max(minLimit_, maxLimit_), (std::size_t)1u)),
+    limit((double)initialLimit_),
+    inFlight(0u),
+    baseline(-1.0),
+    backoff(0LL),
+    backoffUntil(0LL),
+    completed(0u),
+    decreaseWindowEnd(0u),
+    interrupted(false)
+{
+    limit = std::min(std::max(limit, minLimit), maxLimit);
+}
+
+ConcurrencyLimiter::~ConcurrencyLimiter() NOTHROWS
+{
+    interrupt();
+}
+
+TAKErr ConcurrencyLimiter::acquire() NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    Monitor::Lock lock(monitor);
+    code = lock.status;
+    TE_CHECKRETURN_CODE(code);
+    while (true) {
+        if (interrupted)
+            return TE_Interrupted;
+        const int64_t now = Port::Platform_systime_millis();
+        if (now < backoffUntil) {
+            lock.wait(backoffUntil - now);
+            continue;
+        }
+        if ((double)inFlight < std::floor(limit))
+            break;
+        lock.wait();
+    }
+    inFlight++;
+    return code;
+}
+
+void ConcurrencyLimiter::release(const TAKErr outcome, const int64_t latency) NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    if (lock.status != TE_Ok)
+        return;
+    if (inFlight)
+        inFlight--;
+    completed++;
+
+    if (outcome == TE_Busy) {
+        if (completed > decreaseWindowEnd) {
+            decrease(BUSY_DECREASE);
+            backoff = std::min(std::max(backoff * 2, MIN_BACKOFF), MAX_BACKOFF);
+            backoffUntil = Port::Platform_systime_millis() + backoff;
+        }
+    } else if (outcome != TE_Ok) {
+        if (completed > decreaseWindowEnd)
+            decrease(ERROR_DECREASE);
+    } else {
+        backoff = 0LL;
+        const double l = (double)std::max(latency, (int64_t)0);
+        if (baseline < 0.0 || l < baseline)
+            baseline = l;
+        else
+            baseline += (l - baseline) * BASELINE_DECAY;
+
+        if (l <= std::max(baseline * LATENCY_TOLERANCE, 1.0))
+            limit = std::min(limit + (1.0 / limit), maxLimit);
+        else if (completed > decreaseWindowEnd)
+            decrease(ERROR_DECREASE);
+    }
+    lock.broadcast();
+}
+
+std::size_t ConcurrencyLimiter::getLimit() const NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    return (std::size_t)limit;
+}
+
+void ConcurrencyLimiter::interrupt() NOTHROWS
+{
+    Monitor::Lock lock(monitor);
+    interrupted = true;
+    lock.broadcast();
+}
+
+void ConcurrencyLimiter::decrease(const double factor) NOTHROWS
+{
+    limit = std::max(limit * factor, minLimit);
+    // outcomes of the requests already in flight were produced under the
+    // previous limit; don't penalize them again
+    decreaseWindowEnd = completed + inFlight;
+}
@@ -0,0 +1,88 @@
+#ifndef TAK_ENGINE_UTIL_CONCURRENCYLIMITER_H_INCLUDED
+#define TAK_ENGINE_UTIL_CONCURRENCYLIMITER_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "thread/Monitor.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Bounds the number of concurrent requests to a remote service,
+             * adapting the bound to observed behavior using additive
+             * increase/multiplicative decrease (AIMD).
+             *
+             * <P>The limit grows by one for every <I>limit</I> successful
+             * requests whose latency remains within twice the baseline
+             * (minimum observed) latency. The limit is reduced when latency
+             * rises beyond that or a request fails. A <code>TE_Busy</code>
+             * outcome, indicating that the server is throttling (e.g. HTTP
+             * 429 or 503), halves the limit and additionally suspends all
+             * acquisition for an exponentially increasing backoff period.
+             * Decreases are applied at most once per window of completed
+             * requests, so that a burst of failures from requests that were
+             * in flight concurrently counts as a single congestion event.
+             */
+            class ENGINE_API ConcurrencyLimiter
+            {
+            public :
+                ConcurrencyLimiter(const std::size_t minLimit, const std::size_t maxLimit, const std::size_t initialLimit) NOTHROWS;
+                ~ConcurrencyLimiter() NOTHROWS;
+            private :
+                ConcurrencyLimiter(const ConcurrencyLimiter &) NOTHROWS;
+            public :
+                /**
+                 * Blocks until a request may be issued. Each successful call
+                 * must be paired with a call to <code>release</code>.
+                 *
+                 * @return  TE_Ok if the request may be issued,
+                 *          TE_Interrupted if the limiter was interrupted
+                 */
+                TAKErr acquire() NOTHROWS;
+                /**
+                 * Records the outcome of a request issued following
+                 * <code>acquire</code>.
+                 *
+                 * @param outcome   The result of the request
+                 * @param latency   The duration of the request, in
+                 *                  milliseconds
+                 */
+                void release(const TAKErr outcome, const int64_t latency) NOTHROWS;
+                /**
+                 * Returns the current limit on concurrent requests.
+                 */
+                std::size_t getLimit() const NOTHROWS;
+                /**
+                 * Wakes all threads blocked in <code>acquire</code>; all
+                 * subsequent calls to <code>acquire</code> fail.
+                 */
+                void interrupt() NOTHROWS;
+            private :
+                void decrease(const double factor) NOTHROWS;
+            private :
+                mutable Thread::Monitor monitor;
+                const double minLimit;
+                const double maxLimit;
+                double limit;
+                std::size_t inFlight;
+                /** baseline latency, in milliseconds; negative if no observations */
+                double baseline;
+                /** current backoff period, in milliseconds */
+                int64_t backoff;
+                /** time at which acquisition may resume */
+                int64_t backoffUntil;
+                /** number of completed requests */
+                std::size_t completed;
+                /** completion count before which further decreases are ignored */
+                std::size_t decreaseWindowEnd;
+                bool interrupted;
+            };
+        }
+    }
+}
+
+#endif
@@ -2,21 +2,23 @@
 #ifndef TAK_ENGINE_UTIL_COPYONWRITECONTAINERS_H_INCLUDED
 #define TAK_ENGINE_UTIL_COPYONWRITECONTAINERS_H_INCLUDED
 
+#include <memory>
+
 #include "util/Error.h"
-#include "thread/Mutex.h"
-#include "thread/MutexGuard.h"
+#include "thread/ReadCopyUpdate.h"
 
 namespace TAK {
     namespace Engine {
         namespace Util {
             /**
              * Provides a basic copy-on-write interface for efficient implementations of rare
-             * writes and many concurrent reads
+             * writes and many concurrent reads. The current value is published through
+             * `ReadCopyUpdate`; readers never contend with writers for a lock.
              */
             template <typename T>
             class CopyOnWrite {
             public:
-                CopyOnWrite() : item(std::make_shared<T>()) { }
+                CopyOnWrite();
                 CopyOnWrite(const CopyOnWrite &) = delete;
                 CopyOnWrite(CopyOnWrite &&) = delete;
 
@@ -32,70 +34,71 @@ namespace TAK {
                 template <typename ...Args>
                 TAK::Engine::Util::TAKErr invokeWrite(TAK::Engine::Util::TAKErr(T::*method)(Args...), Args ...args) NOTHROWS;
 
-                const std::shared_ptr<const T> &read() const NOTHROWS;
+                /**
+                 * Returns the current value. The returned value is immutable and is not
+                 * affected by subsequent writes.
+                 */
+                std::shared_ptr<const T> read() const NOTHROWS;
 
             private:
-                mutable TAK::Engine::Thread::Mutex mutex;
-                std::shared_ptr<const T> item;
-                std::shared_ptr<const T> empty;
+                TAK::Engine::Thread::ReadCopyUpdate<std::shared_ptr<const T>> item;
             };
 
             //
             // CopyOnWrite<T> impl
             //
 
+            template <typename T>
+            CopyOnWrite<T>::CopyOnWrite() {
+                item.update([](std::shared_ptr<const T> &value) -> TAK::Engine::Util::TAKErr {
+                    value = std::make_shared<T>();
+                    return TE_Ok;
+                });
+            }
+
             template <typename T>
             template <typename ...Args>
             TAK::Engine::Util::TAKErr CopyOnWrite<T>::invokeWrite(TAK::Engine::Util::TAKErr(T::*method)(Args...), Args &&...args) NOTHROWS {
-                TAK::Engine::Util::TAKErr code(mutex.lock());
-                if (code == TE_Ok) {
-                    TAK::Engine::Thread::MutexGuard guard(mutex);
-                    TE_BEGIN_TRAP() {
-                        std::shared_ptr<T> newItem;
-                        if (item) {
-                            newItem = std::make_shared<T>(*item);
-                        }
-                        else {
-                            newItem = std::make_shared<T>();
-                        }
-                        code = (newItem.get()->*method)(std::forward<Args>(args)...);
-                        TE_CHECKRETURN_CODE(code);
-                        item = std::move(newItem);
-                    } TE_END_TRAP(code);
-                }
-                return code;
+                // writers are serialized by `update`; exceptions are trapped there
+                return item.update([&](std::shared_ptr<const T> &value) -> TAK::Engine::Util::TAKErr {
+                    std::shared_ptr<T> newItem;
+                    if (value) {
+                        newItem = std::make_shared<T>(*value);
+                    }
+                    else {
+                        newItem = std::make_shared<T>();
+                    }
+                    TAK::Engine::Util::TAKErr code = (newItem.get()->*method)(std::forward<Args>(args)...);
+                    TE_CHECKRETURN_CODE(code);
+                    value = std::move(newItem);
+                    return code;
+                });
             }
 
             template <typename T>
             template <typename ...Args>
             TAK::Engine::Util::TAKErr CopyOnWrite<T>::invokeWrite(TAK::Engine::Util::TAKErr(T::*method)(Args...), Args ...args) NOTHROWS {
-                TAK::Engine::Util::TAKErr code(mutex.lock());
-                if (code == TE_Ok) {
-                    TAK::Engine::Thread::MutexGuard guard(mutex);
-                    TE_BEGIN_TRAP() {
-                        std::shared_ptr<T> newItem;
-                        if (item) {
-                            newItem = std::make_shared<T>(*item);
-                        }
-                        else {
-                            newItem = std::make_shared<T>();
-                        }
-                        code = (newItem.get()->*method)(std::forward<Args>(args)...);
-                        TE_CHECKRETURN_CODE(code);
-                        item = std::move(newItem);
-                    } TE_END_TRAP(code);
-                }
-                return code;
+                return item.update([&](std::shared_ptr<const T> &value) -> TAK::Engine::Util::TAKErr {
+                    std::shared_ptr<T> newItem;
+                    if (value) {
+                        newItem = std::make_shared<T>(*value);
+                    }
+                    else {
+                        newItem = std::make_shared<T>();
+                    }
+                    TAK::Engine::Util::TAKErr code = (newItem.get()->*method)(std::forward<Args>(args)...);
+                    TE_CHECKRETURN_CODE(code);
+                    value = std::move(newItem);
+                    return code;
+                });
             }
 
             template <typename T>
-            const std::shared_ptr<const T> &CopyOnWrite<T>::read() const NOTHROWS {
-                TAK::Engine::Util::TAKErr code(mutex.lock());
-                if (code == TE_Ok) {
-                    TAK::Engine::Thread::MutexGuard guard(mutex);
-                    return item;
-                }
-                return empty;
+            std::shared_ptr<const T> CopyOnWrite<T>::read() const NOTHROWS {
+                // the reference is acquired inside the read-side section, the
+                // value remains valid after the section exits
+                typename TAK::Engine::Thread::ReadCopyUpdate<std::shared_ptr<const T>>::ReadGuard guard(item);
+                return *guard;
             }
         }
     }
@@ -1,6 +1,13 @@
 #include "util/DataInput2.h"
 
 #include <assert.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include "util/IO.h"
 #include "util/Logging.h"
@@ -51,6 +58,14 @@ int64_t DataInput2::length() const NOTHROWS
 {
     return -1LL;
 }
+TAKErr DataInput2::readSpan(const uint8_t **value, const std::size_t len) NOTHROWS
+{
+    return TE_Unsupported;
+}
+TAKErr DataInput2::peek(const uint8_t **value, std::size_t *len) NOTHROWS
+{
+    return TE_Unsupported;
+}
 TAKErr DataInput2::readFloat(float *value) NOTHROWS
 {
     TAKErr code;
@@ -338,6 +353,29 @@ int64_t MemoryInput2::length() const NOTHROWS
 {
     return bytes.get() ? totalLen : -1LL;
 }
+TAKErr MemoryInput2::readSpan(const uint8_t **value, const std::size_t len) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (!bytes.get())
+        return TE_IllegalState;
+    const std::size_t rem = totalLen - curOffset;
+    if (len > rem)
+        return rem ? TE_IO : TE_EOF;
+    *value = bytes.get() + curOffset;
+    curOffset += len;
+    return TE_Ok;
+}
+TAKErr MemoryInput2::peek(const uint8_t **value, std::size_t *len) NOTHROWS
+{
+    if (!value || !len)
+        return TE_InvalidArg;
+    if (!bytes.get())
+        return TE_IllegalState;
+    *value = bytes.get() + curOffset;
+    *len = totalLen - curOffset;
+    return TE_Ok;
+}
 TAKErr MemoryInput2::remaining(std::size_t *value) NOTHROWS
 {
     if (!bytes.get())
@@ -353,6 +391,169 @@ TAKErr MemoryInput2::reset() NOTHROWS
     curOffset = 0;
     return TE_Ok;
 }
+TAKErr MemoryInput2::getData(const uint8_t **value) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (!bytes.get())
+        return TE_IllegalState;
+    *value = bytes.get();
+    return TE_Ok;
+}
+TAKErr MemoryInput2::tell(std::size_t *value) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (!bytes.get())
+        return TE_IllegalState;
+    *value = curOffset;
+    return TE_Ok;
+}
+
+
+MappedFileInput2::MappedFileInput2() NOTHROWS :
+    mapping_(nullptr),
+    mappingLen_(0u)
+{}
+
+MappedFileInput2::~MappedFileInput2() NOTHROWS
+{
+    closeImpl();
+}
+
+TAKErr MappedFileInput2::open(const char *filename, const MappedFileAccess access) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!filename)
+        return TE_InvalidArg;
+    int64_t len;
+    code = IO_length(&len, filename);
+    TE_CHECKRETURN_CODE(code);
+    return open(filename, 0LL, len, access);
+}
+
+TAKErr MappedFileInput2::open(const char *filename, const int64_t offset, const int64_t len, const MappedFileAccess access) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (!filename)
+        return TE_InvalidArg;
+    if (offset < 0LL || len < 0LL)
+        return TE_InvalidArg;
+    if ((uint64_t)len > SIZE_MAX)
+        return TE_OutOfMemory;
+    if (mapping_)
+        return TE_IllegalState;
+
+    if (!len) {
+        // nothing to map; content must be non-NULL to be considered open
+        static const uint8_t empty = 0u;
+        return MemoryInput2::open(&empty, 0u);
+    }
+
+#ifdef _MSC_VER
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    const int64_t granularity = sysinfo.dwAllocationGranularity;
+#else
+    const int64_t granularity = sysconf(_SC_PAGESIZE);
+#endif
+    // mappings must start at a multiple of the allocation granularity
+    const int64_t mapOffset = (offset / granularity) * granularity;
+    const std::size_t delta = (std::size_t)(offset - mapOffset);
+    const std::size_t mapLen = (std::size_t)len + delta;
+
+#ifdef _MSC_VER
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return TE_IO;
+    HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!fileMapping)
+        return TE_IO;
+    // the view retains the mapping object
+    void *mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, (DWORD)((uint64_t)mapOffset >> 32u), (DWORD)(mapOffset & 0xFFFFFFFFLL), mapLen);
+    CloseHandle(fileMapping);
+    if (!mapping)
+        return TE_IO;
+#else
+    const int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+        return TE_IO;
+    void *mapping = mmap(nullptr, mapLen, PROT_READ, MAP_PRIVATE, fd, (off_t)mapOffset);
+    // the mapping retains a reference to the file
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return TE_IO;
+#endif
+
+    mapping_ = mapping;
+    mappingLen_ = mapLen;
+
+    code = MemoryInput2::open(static_cast<const uint8_t *>(mapping) + delta, (std::size_t)len);
+    if (code != TE_Ok) {
+        closeImpl();
+        return code;
+    }
+
+    setAccessHint(access);
+    return code;
+}
+
+TAKErr MappedFileInput2::open(const uint8_t *bytes, const std::size_t len) NOTHROWS
+{
+    return TE_Unsupported;
+}
+
+TAKErr MappedFileInput2::open(std::unique_ptr<const uint8_t, void(*)(const uint8_t *)> &&bytes, const std::size_t len) NOTHROWS
+{
+    return TE_Unsupported;
+}
+
+TAKErr MappedFileInput2::close() NOTHROWS
+{
+    return closeImpl();
+}
+
+TAKErr MappedFileInput2::closeImpl() NOTHROWS
+{
+    MemoryInput2::close();
+    if (!mapping_)
+        return TE_Ok;
+
+#ifdef _MSC_VER
+    const bool unmapped = !!UnmapViewOfFile(mapping_);
+#else
+    const bool unmapped = (munmap(mapping_, mappingLen_) == 0);
+#endif
+    mapping_ = nullptr;
+    mappingLen_ = 0u;
+    return unmapped ? TE_Ok : TE_IO;
+}
+
+TAKErr MappedFileInput2::setAccessHint(const MappedFileAccess access) NOTHROWS
+{
+    if (!mapping_)
+        return TE_IllegalState;
+#ifdef _MSC_VER
+    return TE_Ok;
+#else
+    int advice;
+    switch (access) {
+        case TEMA_Normal :
+            advice = MADV_NORMAL;
+            break;
+        case TEMA_Sequential :
+            advice = MADV_SEQUENTIAL;
+            break;
+        case TEMA_Random :
+            advice = MADV_RANDOM;
+            break;
+        default :
+            return TE_InvalidArg;
+    }
+    return (madvise(mapping_, mappingLen_, advice) == 0) ? TE_Ok : TE_Err;
+#endif
+}
 
 
 ByteBufferInput2::ByteBufferInput2() NOTHROWS :
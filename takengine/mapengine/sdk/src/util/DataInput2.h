@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 #include "port/Platform.h"
@@ -51,6 +52,31 @@ namespace TAK {
                  */
                 virtual int64_t length() const NOTHROWS;
 
+                /**
+                 * Returns a view of the next `len` bytes of content and
+                 * advances past them. The view remains valid until the
+                 * input is closed. The position is not modified on failure.
+                 *
+                 * <P>The default implementation returns `TE_Unsupported`;
+                 * only inputs whose content is resident in memory provide
+                 * views.
+                 *
+                 * @return  TE_Ok on success, TE_EOF if no content remains,
+                 *          TE_IO if fewer than `len` bytes remain
+                 */
+                virtual TAKErr readSpan(const uint8_t **value, const std::size_t len) NOTHROWS;
+                /**
+                 * Returns a view of the remaining content without advancing
+                 * the position. The view remains valid until the input is
+                 * closed.
+                 *
+                 * <P>The default implementation returns `TE_Unsupported`.
+                 *
+                 * @param value Returns the view
+                 * @param len   Returns the number of bytes in the view
+                 */
+                virtual TAKErr peek(const uint8_t **value, std::size_t *len) NOTHROWS;
+
                 /*
                 * Reads 4 bytes from the source and converts them to a single precision
                 * floating point value, possibly swapping bytes depending on the configured
@@ -112,7 +138,7 @@ namespace TAK {
                  */
                 TAKEndian getSourceEndian() const NOTHROWS;
 
-            private:
+            protected :
                 bool swappingEndian;
             };
 
@@ -154,16 +180,105 @@ namespace TAK {
                 virtual TAKErr readByte(uint8_t *value) NOTHROWS override;
                 virtual TAKErr skip(const std::size_t n) NOTHROWS override;
                 virtual int64_t length() const NOTHROWS override;
+                virtual TAKErr readSpan(const uint8_t **value, const std::size_t len) NOTHROWS override;
+                virtual TAKErr peek(const uint8_t **value, std::size_t *len) NOTHROWS override;
 
                 virtual TAKErr remaining(std::size_t *value) NOTHROWS;
 
                 virtual TAKErr reset() NOTHROWS;
+
+                /*
+                 * Non-virtual equivalents of the `DataInput2` primitive
+                 * readers. Values are decoded directly from the buffer
+                 * rather than copied through `read`.
+                 */
+                TAKErr readFloat(float *value) NOTHROWS;
+                TAKErr readInt(int32_t *value) NOTHROWS;
+                TAKErr readShort(int16_t *value) NOTHROWS;
+                TAKErr readLong(int64_t *value) NOTHROWS;
+                TAKErr readDouble(double *value) NOTHROWS;
+
+                /**
+                 * Returns a pointer to the start of the content. The
+                 * pointer remains valid until the input is closed. Readers
+                 * may use the pointer to access the content in place rather
+                 * than copying it via `read`.
+                 */
+                TAKErr getData(const uint8_t **value) const NOTHROWS;
+                /**
+                 * Returns the current read position, relative to the start
+                 * of the content.
+                 */
+                TAKErr tell(std::size_t *value) const NOTHROWS;
+            private :
+                template<class T>
+                TAKErr readPrimitive(T *value) NOTHROWS;
             private:
                 std::unique_ptr<const uint8_t, void(*)(const uint8_t *)> bytes;
                 std::size_t curOffset;
                 std::size_t totalLen;
             };
 
+            /**
+             * Access pattern hints for memory mapped input.
+             */
+            enum MappedFileAccess
+            {
+                TEMA_Normal,
+                /** Content is read front to back; enables aggressive read-ahead */
+                TEMA_Sequential,
+                /** Content is read in no particular order; disables read-ahead */
+                TEMA_Random,
+            };
+
+            /**
+             * Input backed by a read-only memory mapping of a file. Content
+             * is paged in on access rather than copied through `read`. As a
+             * `MemoryInput2`, the mapped content may be accessed in place
+             * via `getData`.
+             *
+             * <P>The file must not be truncated while mapped.
+             */
+            class ENGINE_API MappedFileInput2 : public MemoryInput2
+            {
+            public:
+                MappedFileInput2() NOTHROWS;
+                virtual ~MappedFileInput2() NOTHROWS;
+
+                /**
+                 * Maps the entire file.
+                 */
+                TAKErr open(const char *filename, const MappedFileAccess access = TEMA_Normal) NOTHROWS;
+                /**
+                 * Maps the specified region of the file.
+                 *
+                 * @param offset    The offset of the region, in bytes
+                 * @param len       The length of the region, in bytes
+                 */
+                TAKErr open(const char *filename, const int64_t offset, const int64_t len, const MappedFileAccess access = TEMA_Normal) NOTHROWS;
+                /**
+                 * Always returns `TE_Unsupported`.
+                 */
+                virtual TAKErr open(const uint8_t *bytes, const std::size_t len) NOTHROWS override;
+                /**
+                 * Always returns `TE_Unsupported`.
+                 */
+                virtual TAKErr open(std::unique_ptr<const uint8_t, void(*)(const uint8_t *)> &&bytes, const std::size_t len) NOTHROWS override;
+                virtual TAKErr close() NOTHROWS override;
+
+                /**
+                 * Advises the operating system of the expected access
+                 * pattern for the mapped content. Hints are advisory and
+                 * may be ignored on some platforms.
+                 */
+                TAKErr setAccessHint(const MappedFileAccess access) NOTHROWS;
+            private :
+                TAKErr closeImpl() NOTHROWS;
+            private:
+                void *mapping_;
+                std::size_t mappingLen_;
+            };
+
             class ENGINE_API ByteBufferInput2 : public DataInput2
             {
             public:
@@ -183,6 +298,46 @@ namespace TAK {
                 atakmap::util::MemBufferT<uint8_t> *buffer_;
                 int64_t len_;
             };
+
+            inline TAKErr MemoryInput2::readFloat(float *value) NOTHROWS
+            {
+                return readPrimitive(value);
+            }
+            inline TAKErr MemoryInput2::readInt(int32_t *value) NOTHROWS
+            {
+                return readPrimitive(value);
+            }
+            inline TAKErr MemoryInput2::readShort(int16_t *value) NOTHROWS
+            {
+                return readPrimitive(value);
+            }
+            inline TAKErr MemoryInput2::readLong(int64_t *value) NOTHROWS
+            {
+                return readPrimitive(value);
+            }
+            inline TAKErr MemoryInput2::readDouble(double *value) NOTHROWS
+            {
+                return readPrimitive(value);
+            }
+            template<class T>
+            inline TAKErr MemoryInput2::readPrimitive(T *value) NOTHROWS
+            {
+                if (!bytes.get())
+                    return TE_IllegalState;
+                const std::size_t rem = totalLen - curOffset;
+                if (rem < sizeof(T))
+                    return rem ? TE_IO : TE_EOF;
+                const uint8_t *src = bytes.get() + curOffset;
+                if (swappingEndian) {
+                    uint8_t *dst = reinterpret_cast<uint8_t *>(value);
+                    for (std::size_t i = 0u; i < sizeof(T); i++)
+                        dst[i] = src[sizeof(T) - 1u - i];
+                } else {
+                    memcpy(value, src, sizeof(T));
+                }
+                curOffset += sizeof(T);
+                return TE_Ok;
+            }
         }
     }
 }
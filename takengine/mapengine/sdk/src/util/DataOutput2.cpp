@@ -1,6 +1,7 @@
 #include "util/DataOutput2.h"
 
 #include <assert.h>
+#include <new>
 
 #include "util/IO.h"
 #include "util/Logging.h"
@@ -47,6 +48,19 @@ TAKErr DataOutput2::skip(const std::size_t n) NOTHROWS
     return write(buf.get(), n);
 }
 
+TAKErr DataOutput2::writev(const Segment *segments, const std::size_t count) NOTHROWS
+{
+    if (count && !segments)
+        return TE_InvalidArg;
+    TAKErr code(TE_Ok);
+    for (std::size_t i = 0u; i < count; i++) {
+        code = write(segments[i].data, segments[i].len);
+        TE_CHECKBREAK_CODE(code);
+    }
+    TE_CHECKRETURN_CODE(code);
+    return code;
+}
+
 TAKErr DataOutput2::writeFloat(const float value) NOTHROWS
 {
     assert(sizeof(float) == 4);
@@ -109,6 +123,16 @@ void DataOutput2::setSourceEndian2(const TAKEndian e) NOTHROWS
     swappingEndian = (e != TE_PlatformEndian);
 }
 
+TAKEndian DataOutput2::getSourceEndian() const NOTHROWS
+{
+    if (!swappingEndian)
+        return TE_PlatformEndian;
+    else if (TE_PlatformEndian == TE_BigEndian)
+        return TE_LittleEndian;
+    else
+        return TE_BigEndian;
+}
+
 
 FileOutput2::FileOutput2() NOTHROWS :
     f(nullptr)
@@ -254,6 +278,25 @@ TAKErr MemoryOutput2::skip(const std::size_t n) NOTHROWS
     return TE_Ok;
 }
 
+TAKErr MemoryOutput2::writev(const Segment *segments, const std::size_t count) NOTHROWS
+{
+    if (count && !segments)
+        return TE_InvalidArg;
+    std::size_t len = 0u;
+    for (std::size_t i = 0u; i < count; i++)
+        len += segments[i].len;
+    // all or nothing
+    if (len > (totalLen - curOffset))
+        return TE_IO;
+    for (std::size_t i = 0u; i < count; i++) {
+        if (!segments[i].len)
+            continue;
+        memcpy(bytes + curOffset, segments[i].data, segments[i].len);
+        curOffset += segments[i].len;
+    }
+    return TE_Ok;
+}
+
 TAKErr MemoryOutput2::remaining(std::size_t *value) NOTHROWS
 {
     *value = totalLen - curOffset;
@@ -334,7 +377,7 @@ TAKErr DynamicOutput::close() NOTHROWS
     return TE_Ok;
 }
 
-TAKErr DynamicOutput::write(const uint8_t *buf, const std::size_t len) NOTHROWS
+TAKErr DynamicOutput::reserve(const std::size_t len) NOTHROWS
 {
     if (!buffer.get())
         return TE_IllegalState;
@@ -343,12 +386,22 @@ TAKErr DynamicOutput::write(const uint8_t *buf, const std::size_t len) NOTHROWS
     std::size_t remaining = (capacity-used);
     if (len > remaining) {
         std::size_t ncapacity = std::max(capacity * 2, used+len);
-        array_ptr<uint8_t> scratch(new uint8_t[ncapacity]);
+        array_ptr<uint8_t> scratch(new(std::nothrow) uint8_t[ncapacity]);
+        if (!scratch.get())
+            return TE_OutOfMemory;
         memcpy(scratch.get(), buffer.get(), used);
         buffer.reset(scratch.release());
         capacity = ncapacity;
         writePtr = buffer.get() + used;
     }
+    return TE_Ok;
+}
+
+TAKErr DynamicOutput::write(const uint8_t *buf, const std::size_t len) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    code = reserve(len);
+    TE_CHECKRETURN_CODE(code);
 
     if (buf)
         memcpy(writePtr, buf, len);
@@ -358,7 +411,32 @@ TAKErr DynamicOutput::write(const uint8_t *buf, const std::size_t len) NOTHROWS
 
 TAKErr DynamicOutput::writeByte(const uint8_t value) NOTHROWS
 {
-    return write(&value, 1);
+    if (!buffer.get() || static_cast<std::size_t>(writePtr - buffer.get()) == capacity) {
+        TAKErr code(TE_Ok);
+        code = reserve(1u);
+        TE_CHECKRETURN_CODE(code);
+    }
+    *writePtr++ = value;
+    return TE_Ok;
+}
+
+TAKErr DynamicOutput::writev(const Segment *segments, const std::size_t count) NOTHROWS
+{
+    if (count && !segments)
+        return TE_InvalidArg;
+    TAKErr code(TE_Ok);
+    std::size_t len = 0u;
+    for (std::size_t i = 0u; i < count; i++)
+        len += segments[i].len;
+    // expand at most once for the whole request
+    code = reserve(len);
+    TE_CHECKRETURN_CODE(code);
+    for (std::size_t i = 0u; i < count; i++) {
+        if (segments[i].data)
+            memcpy(writePtr, segments[i].data, segments[i].len);
+        writePtr += segments[i].len;
+    }
+    return TE_Ok;
 }
 
 TAKErr DynamicOutput::skip(const std::size_t n) NOTHROWS
@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "port/Platform.h"
 #include "util/Error.h"
@@ -23,6 +24,16 @@ namespace TAK {
 
             class ENGINE_API DataOutput2
             {
+            public :
+                /**
+                 * A contiguous run of bytes to be written as part of a
+                 * gather write.
+                 */
+                struct Segment
+                {
+                    const uint8_t *data;
+                    std::size_t len;
+                };
             public:
                 DataOutput2();
                 virtual ~DataOutput2();
@@ -45,6 +56,13 @@ namespace TAK {
                 */
                 virtual TAKErr skip(const std::size_t n) NOTHROWS;
 
+                /*
+                * Writes the specified segments, in order, as if by successive
+                * calls to 'write'. Implementations may service the request
+                * with a single bounds check or buffer expansion.
+                * TE_Ok is returned on success.
+                */
+                virtual TAKErr writev(const Segment *segments, const std::size_t count) NOTHROWS;
 
                 /*
                 * Reads 4 bytes from the source and converts them to a single precision
@@ -102,7 +120,13 @@ namespace TAK {
                 */
                 void setSourceEndian2(const TAKEndian e) NOTHROWS;
 
-            private:
+                /**
+                 * Returns the endian interpretation of binary quantities
+                 * written to the sink.
+                 */
+                TAKEndian getSourceEndian() const NOTHROWS;
+
+            protected :
                 bool swappingEndian;
             };
 
@@ -137,6 +161,7 @@ namespace TAK {
                 virtual TAKErr write(const uint8_t *buf, const std::size_t len) NOTHROWS override;
                 virtual TAKErr writeByte(const uint8_t value) NOTHROWS override;
                 virtual TAKErr skip(const std::size_t n) NOTHROWS override;
+                virtual TAKErr writev(const Segment *segments, const std::size_t count) NOTHROWS override;
 
                 virtual TAKErr remaining(std::size_t *value) NOTHROWS;
             private:
@@ -174,14 +199,72 @@ namespace TAK {
                 virtual TAKErr write(const uint8_t *buf, const std::size_t len) NOTHROWS override;
                 virtual TAKErr writeByte(const uint8_t value) NOTHROWS override;
                 virtual TAKErr skip(const std::size_t n) NOTHROWS override;
+                virtual TAKErr writev(const Segment *segments, const std::size_t count) NOTHROWS override;
+
+                /*
+                 * Non-virtual equivalents of the `DataOutput2` primitive
+                 * writers. Values are encoded directly into the buffer
+                 * rather than copied through `write`.
+                 */
+                TAKErr writeFloat(const float value) NOTHROWS;
+                TAKErr writeInt(const int32_t value) NOTHROWS;
+                TAKErr writeShort(const int16_t value) NOTHROWS;
+                TAKErr writeLong(const int64_t value) NOTHROWS;
+                TAKErr writeDouble(const double value) NOTHROWS;
 
                 TAKErr get(const uint8_t **buf, std::size_t *len) NOTHROWS;
                 TAKErr reset() NOTHROWS;
+            private :
+                /**
+                 * Ensures capacity for at least `len` additional bytes.
+                 */
+                TAKErr reserve(const std::size_t len) NOTHROWS;
+                template<class T>
+                TAKErr writePrimitive(const T value) NOTHROWS;
             private:
                 array_ptr<uint8_t> buffer;
                 uint8_t *writePtr;
                 std::size_t capacity;
             };
+
+            inline TAKErr DynamicOutput::writeFloat(const float value) NOTHROWS
+            {
+                return writePrimitive(value);
+            }
+            inline TAKErr DynamicOutput::writeInt(const int32_t value) NOTHROWS
+            {
+                return writePrimitive(value);
+            }
+            inline TAKErr DynamicOutput::writeShort(const int16_t value) NOTHROWS
+            {
+                return writePrimitive(value);
+            }
+            inline TAKErr DynamicOutput::writeLong(const int64_t value) NOTHROWS
+            {
+                return writePrimitive(value);
+            }
+            inline TAKErr DynamicOutput::writeDouble(const double value) NOTHROWS
+            {
+                return writePrimitive(value);
+            }
+            template<class T>
+            inline TAKErr DynamicOutput::writePrimitive(const T value) NOTHROWS
+            {
+                if (!buffer.get() || (capacity - static_cast<std::size_t>(writePtr - buffer.get())) < sizeof(T)) {
+                    const TAKErr code = reserve(sizeof(T));
+                    if (code != TE_Ok)
+                        return code;
+                }
+                const uint8_t *src = reinterpret_cast<const uint8_t *>(&value);
+                if (swappingEndian) {
+                    for (std::size_t i = 0u; i < sizeof(T); i++)
+                        writePtr[i] = src[sizeof(T) - 1u - i];
+                } else {
+                    memcpy(writePtr, src, sizeof(T));
+                }
+                writePtr += sizeof(T);
+                return TE_Ok;
+            }
         }
     }
 }
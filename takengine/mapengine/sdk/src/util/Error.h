@@ -40,10 +40,10 @@
 
 #define TE_END_TRAP(rc) \
     catch (std::bad_alloc) { \
-        rc = TE_OutOfMemory; \
+        rc = TAK::Engine::Util::TE_OutOfMemory; \
     } \
     catch(...) { \
-        rc = TE_Err; \
+        rc = TAK::Engine::Util::TE_Err; \
     }
 
 
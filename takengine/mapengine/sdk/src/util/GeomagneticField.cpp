@@ -1,5 +1,9 @@
 #include "util/GeomagneticField.h"
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include "formats/wmm/GeomagnetismHeader.h"
 #include "port/String.h"
 #include "thread/Lock.h"
@@ -13,6 +17,9 @@ using namespace TAK::Engine::Thread;
 
 namespace
 {
+    /** horizontal intensity, nT, below which declination is not interpolated */
+    const double MAGNETIC_POLE_CAUTION_H = 6000.0;
+
     struct GeomagneticFieldState
     {
         GeomagneticFieldState() NOTHROWS :
@@ -35,7 +42,35 @@ namespace
     void initWMM() NOTHROWS;
     bool isLeapYear(const std::size_t year) NOTHROWS;
     TAKErr getDayOfYear(std::size_t *value, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
+    TAKErr getTimelyModel(std::shared_ptr<MAGtype_MagneticModel> &value, uint32_t *version, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
+    TAKErr getElements(MAGtype_GeoMagneticElements *value, const MAGtype_MagneticModel &tmm, const GeoPoint2 &p) NOTHROWS;
     TAKErr GeomagneticField_getElements(MAGtype_GeoMagneticElements *value, const GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
+
+    /**
+     * Declination, degrees, of the surface for a single date, sampled every
+     * `resolution` degrees. The interpolation error of each cell is
+     * estimated as the residual at the cell center.
+     */
+    struct DeclinationGrid
+    {
+        uint32_t version {0u};
+        double resolution {0.0};
+        std::size_t rows {0u};
+        std::size_t columns {0u};
+        /** `rows*columns` posts, from (-90, -180) */
+        std::vector<double> posts;
+        /** `(rows-1)*(columns-1)` cells */
+        std::vector<float> error;
+    };
+
+    struct
+    {
+        Mutex mutex;
+        std::shared_ptr<const DeclinationGrid> value;
+    } declinationGrid;
+
+    TAKErr createDeclinationGrid(DeclinationGrid &value, const MAGtype_MagneticModel &tmm, const double resolution) NOTHROWS;
+    double interpolateDeclination(const DeclinationGrid &grid, const std::size_t row, const std::size_t col, const double u, const double v) NOTHROWS;
 }
 
 #define GET_ELEMENT_FIELD_IMPL(f) \
@@ -51,6 +86,80 @@ TAKErr TAK::Engine::Util::GeomagneticField_getDeclination(double *value, const G
     GET_ELEMENT_FIELD_IMPL(Decl);
     return TE_Ok;
 }
+TAKErr TAK::Engine::Util::GeomagneticField_getDeclination(double *value, const GeoPoint2 *points, const std::size_t count, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if(!value || (count && !points))
+        return TE_InvalidArg;
+    std::shared_ptr<MAGtype_MagneticModel> tmm;
+    uint32_t version;
+    code = getTimelyModel(tmm, &version, year, month, day);
+    TE_CHECKRETURN_CODE(code);
+    for(std::size_t i = 0u; i < count; i++) {
+        MAGtype_GeoMagneticElements elements;
+        memset(&elements, 0, sizeof(MAGtype_GeoMagneticElements));
+        code = getElements(&elements, *tmm, points[i]);
+        TE_CHECKBREAK_CODE(code);
+        value[i] = elements.Decl;
+    }
+    TE_CHECKRETURN_CODE(code);
+    return code;
+}
+TAKErr TAK::Engine::Util::GeomagneticField_getDeclinationFromGrid(double *value, double *error, const GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day, const double maxError) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if(!value)
+        return TE_InvalidArg;
+    if(isnan(p.latitude) || isnan(p.longitude) || p.latitude < -90.0 || p.latitude > 90.0)
+        return TE_InvalidArg;
+
+    std::shared_ptr<MAGtype_MagneticModel> tmm;
+    uint32_t version;
+    code = getTimelyModel(tmm, &version, year, month, day);
+    TE_CHECKRETURN_CODE(code);
+
+    std::shared_ptr<const DeclinationGrid> grid;
+    {
+        Lock lock(declinationGrid.mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
+        if(!declinationGrid.value || declinationGrid.value->version != version) {
+            // the grid is only rebuilt when the date changes
+            const double resolution = ConfigOptions_getDoubleOptionOrDefault("wmm.declination-grid-resolution", 2.0);
+            std::shared_ptr<DeclinationGrid> g(new DeclinationGrid());
+            g->version = version;
+            code = createDeclinationGrid(*g, *tmm, resolution);
+            TE_CHECKRETURN_CODE(code);
+            declinationGrid.value = g;
+        }
+        grid = declinationGrid.value;
+    }
+
+    double lng = fmod(p.longitude + 180.0, 360.0);
+    if(lng < 0.0)
+        lng += 360.0;
+    const double x = lng / grid->resolution;
+    const double y = (p.latitude + 90.0) / grid->resolution;
+    const std::size_t col = std::min(static_cast<std::size_t>(x), grid->columns - 2u);
+    const std::size_t row = std::min(static_cast<std::size_t>(y), grid->rows - 2u);
+    const double cellError = grid->error[row*(grid->columns-1u) + col];
+    if(cellError > maxError) {
+        // the field varies too rapidly, typically near the magnetic poles;
+        // evaluate the model
+        MAGtype_GeoMagneticElements elements;
+        memset(&elements, 0, sizeof(MAGtype_GeoMagneticElements));
+        code = getElements(&elements, *tmm, GeoPoint2(p.latitude, p.longitude));
+        TE_CHECKRETURN_CODE(code);
+        *value = elements.Decl;
+        if(error)
+            *error = 0.0;
+        return code;
+    }
+    *value = interpolateDeclination(*grid, row, col, x - col, y - row);
+    if(error)
+        *error = cellError;
+    return code;
+}
 TAKErr TAK::Engine::Util::GeomagneticField_getInclination(double *value, const GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS
 {
     GET_ELEMENT_FIELD_IMPL(Incl);
@@ -132,7 +241,7 @@ namespace
             *value = (*value) + 1;
         return TE_Ok;
     }
-    TAKErr GeomagneticField_getElements(MAGtype_GeoMagneticElements *value, const GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS
+    TAKErr getTimelyModel(std::shared_ptr<MAGtype_MagneticModel> &value, uint32_t *version, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS
     {
         TAKErr code(TE_Ok);
         int success;
@@ -153,46 +262,49 @@ namespace
         if (isLeapYear(year))
             days += 1.0;
 
-        std::shared_ptr<MAGtype_MagneticModel> tmm;
+        Lock lock(state.mutex);
+        code = lock.status;
+        TE_CHECKRETURN_CODE(code);
 
-        {
-            Lock lock(state.mutex);
-            code = lock.status;
-            TE_CHECKRETURN_CODE(code);
+        if(!state.loaded) {
+            initWMM();
+            state.loaded = true;
+        }
+        if(!state.model.get())
+            return TE_InvalidArg;
 
-            if(!state.loaded) {
-                initWMM();
-                state.loaded = true;
-            }
-            if(!state.model.get())
-                return TE_InvalidArg;
-
-            // initialize the 'timely' model as needed
-            auto requestedTime = static_cast <uint32_t>((year << 8u) | (dayOfYear));
-            if(requestedTime != state.timeVersion) {
-                int nMax = 0;
-                if (nMax < state.model->nMax)
-                    nMax = state.model->nMax;
-                int NumTerms = ((nMax + 1) * (nMax + 2) / 2);
-
-                std::unique_ptr<MAGtype_MagneticModel, int(*)(MAGtype_MagneticModel *)> tmmPtr(MAG_AllocateModelMemory(NumTerms), MAG_FreeMagneticModelMemory);
-
-                MAGtype_Date UserDate;
-                UserDate.DecimalYear = year + ((dayOfYear-1u) / days);
-                UserDate.Year = static_cast<int>(year);
-                UserDate.Month = static_cast<int>(month);
-                UserDate.Day = static_cast<int>(day);
-
-                success = MAG_TimelyModifyMagneticModel(UserDate, state.model.get(), tmmPtr.get()); /* Time adjust the coefficients, Equation 19, WMM Technical report */
-                if(!success)
-                    return TE_Err;
-
-                state.timeModel = std::move(tmmPtr);
-                state.timeVersion = requestedTime;
-            }
+        // initialize the 'timely' model as needed
+        auto requestedTime = static_cast <uint32_t>((year << 8u) | (dayOfYear));
+        if(requestedTime != state.timeVersion) {
+            int nMax = 0;
+            if (nMax < state.model->nMax)
+                nMax = state.model->nMax;
+            int NumTerms = ((nMax + 1) * (nMax + 2) / 2);
 
-            tmm = state.timeModel;
+            std::unique_ptr<MAGtype_MagneticModel, int(*)(MAGtype_MagneticModel *)> tmmPtr(MAG_AllocateModelMemory(NumTerms), MAG_FreeMagneticModelMemory);
+
+            MAGtype_Date UserDate;
+            UserDate.DecimalYear = year + ((dayOfYear-1u) / days);
+            UserDate.Year = static_cast<int>(year);
+            UserDate.Month = static_cast<int>(month);
+            UserDate.Day = static_cast<int>(day);
+
+            success = MAG_TimelyModifyMagneticModel(UserDate, state.model.get(), tmmPtr.get()); /* Time adjust the coefficients, Equation 19, WMM Technical report */
+            if(!success)
+                return TE_Err;
+
+            state.timeModel = std::move(tmmPtr);
+            state.timeVersion = requestedTime;
         }
+
+        value = state.timeModel;
+        *version = state.timeVersion;
+        return code;
+    }
+    TAKErr getElements(MAGtype_GeoMagneticElements *value, const MAGtype_MagneticModel &tmm, const GeoPoint2 &p) NOTHROWS
+    {
+        int success;
+
         MAGtype_CoordGeodetic CoordGeodetic;
         MAGtype_CoordSpherical CoordSpherical;
 
@@ -201,14 +313,15 @@ namespace
 
         CoordGeodetic.lambda = p.longitude;
         CoordGeodetic.phi = p.latitude;
-        CoordGeodetic.HeightAboveEllipsoid = (p.altitude / 1000.0); // meters to km
+        CoordGeodetic.HeightAboveEllipsoid = isnan(p.altitude) ? 0.0 : (p.altitude / 1000.0); // meters to km
         CoordGeodetic.UseGeoid = 0;
 
         success = MAG_GeodeticToSpherical(state.ellipsoid, CoordGeodetic, &CoordSpherical); /*Convert from geodetic to Spherical Equations: 17-18, WMM Technical report*/
         if(!success)
             return TE_Err;
 
-        success = MAG_Geomag(state.ellipsoid, CoordSpherical, CoordGeodetic, tmm.get(), value); /* Computes the geoMagnetic field elements and their time change*/
+        // XXX - `MAG_Geomag` does not modify the model
+        success = MAG_Geomag(state.ellipsoid, CoordSpherical, CoordGeodetic, const_cast<MAGtype_MagneticModel *>(&tmm), value); /* Computes the geoMagnetic field elements and their time change*/
         if(!success)
             return TE_Err;
 
@@ -221,6 +334,88 @@ namespace
             return TE_Err;
         }
 #endif
+        return TE_Ok;
+    }
+    TAKErr GeomagneticField_getElements(MAGtype_GeoMagneticElements *value, const GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        std::shared_ptr<MAGtype_MagneticModel> tmm;
+        uint32_t version;
+        code = getTimelyModel(tmm, &version, year, month, day);
+        TE_CHECKRETURN_CODE(code);
+        return getElements(value, *tmm, p);
+    }
+    TAKErr createDeclinationGrid(DeclinationGrid &value, const MAGtype_MagneticModel &tmm, const double resolution) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if(!(resolution > 0.0) || resolution > 90.0)
+            return TE_InvalidArg;
+        value.resolution = resolution;
+        value.rows = static_cast<std::size_t>(ceil(180.0 / resolution)) + 1u;
+        value.columns = static_cast<std::size_t>(ceil(360.0 / resolution)) + 1u;
+        value.posts.resize(value.rows*value.columns);
+        value.error.resize((value.rows-1u)*(value.columns-1u));
+
+        // horizontal intensity of each post
+        std::vector<double> h(value.posts.size());
+        MAGtype_GeoMagneticElements elements;
+        for(std::size_t row = 0u; row < value.rows; row++) {
+            const double lat = std::min(-90.0 + row*resolution, 90.0);
+            for(std::size_t col = 0u; col < value.columns; col++) {
+                memset(&elements, 0, sizeof(MAGtype_GeoMagneticElements));
+                code = getElements(&elements, tmm, GeoPoint2(lat, -180.0 + col*resolution));
+                TE_CHECKRETURN_CODE(code);
+                value.posts[row*value.columns + col] = elements.Decl;
+                h[row*value.columns + col] = elements.H;
+            }
+        }
+        // estimate the interpolation error as the largest residual at the
+        // cell center and edge midpoints
+        const double samples[5u][2u] = { {0.5, 0.5}, {0.5, 0.0}, {0.0, 0.5}, {1.0, 0.5}, {0.5, 1.0} };
+        for(std::size_t row = 0u; row < value.rows-1u; row++) {
+            for(std::size_t col = 0u; col < value.columns-1u; col++) {
+                const double *ch = &h[row*value.columns + col];
+                double minH = std::min(std::min(ch[0u], ch[1u]), std::min(ch[value.columns], ch[value.columns+1u]));
+                double residual = 0.0;
+                for(std::size_t i = 0u; i < 5u; i++) {
+                    const double lat = std::min(-90.0 + (row+samples[i][1u])*resolution, 90.0);
+                    memset(&elements, 0, sizeof(MAGtype_GeoMagneticElements));
+                    code = getElements(&elements, tmm, GeoPoint2(lat, -180.0 + (col+samples[i][0u])*resolution));
+                    TE_CHECKRETURN_CODE(code);
+                    double r = fabs(interpolateDeclination(value, row, col, samples[i][0u], samples[i][1u]) - elements.Decl);
+                    if(r > 180.0)
+                        r = 360.0 - r;
+                    residual = std::max(residual, r);
+                    minH = std::min(minH, elements.H);
+                }
+                // declination is unreliable and varies too rapidly to be
+                // interpolated approaching the magnetic poles (the WMM
+                // "caution zone")
+                if(minH < MAGNETIC_POLE_CAUTION_H)
+                    residual = std::numeric_limits<double>::infinity();
+                value.error[row*(value.columns-1u) + col] = static_cast<float>(residual);
+            }
+        }
         return code;
     }
+    double interpolateDeclination(const DeclinationGrid &grid, const std::size_t row, const std::size_t col, const double u, const double v) NOTHROWS
+    {
+        const double *ll = &grid.posts[row*grid.columns + col];
+        const double *ul = ll + grid.columns;
+        // unwrap relative to the lower-left post, declination is +/-180
+        double posts[4u] = { ll[0u], ll[1u], ul[0u], ul[1u] };
+        for(std::size_t i = 1u; i < 4u; i++) {
+            if(posts[i] - posts[0u] > 180.0)
+                posts[i] -= 360.0;
+            else if(posts[i] - posts[0u] < -180.0)
+                posts[i] += 360.0;
+        }
+        double decl = (posts[0u]*(1.0-u) + posts[1u]*u)*(1.0-v) +
+                      (posts[2u]*(1.0-u) + posts[3u]*u)*v;
+        if(decl > 180.0)
+            decl -= 360.0;
+        else if(decl <= -180.0)
+            decl += 360.0;
+        return decl;
+    }
 }
@@ -9,6 +9,28 @@ namespace TAK {
     namespace Engine {
         namespace Util {
             ENGINE_API TAKErr GeomagneticField_getDeclination(double *value, const Core::GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
+            /**
+             * Computes the declination for a batch of points, acquiring the
+             * model for the date once for all points.
+             */
+            ENGINE_API TAKErr GeomagneticField_getDeclination(double *value, const Core::GeoPoint2 *points, const std::size_t count, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
+            /**
+             * Returns the declination at the surface, bilinearly
+             * interpolated from a grid of the model for the date. The grid
+             * is computed on first use for a date; its resolution, in
+             * degrees, is configured via the
+             * `wmm.declination-grid-resolution` option (default `2`).
+             *
+             * <P>The interpolation error of each grid cell is estimated when
+             * the grid is computed. Points in cells whose estimate exceeds
+             * `maxError` degrees, typically near the magnetic poles, are
+             * evaluated against the model.
+             *
+             * @param error     If non-`NULL`, returns the estimated error,
+             *                  in degrees
+             * @param maxError  The maximum acceptable error, in degrees
+             */
+            ENGINE_API TAKErr GeomagneticField_getDeclinationFromGrid(double *value, double *error, const Core::GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day, const double maxError = 0.1) NOTHROWS;
             ENGINE_API TAKErr GeomagneticField_getInclination(double *value, const Core::GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
             ENGINE_API TAKErr GeomagneticField_getFieldStrength(double *value, const Core::GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
             ENGINE_API TAKErr GeomagneticField_getHorizontalStrength(double *value, const Core::GeoPoint2 &p, const std::size_t year, const std::size_t month, const std::size_t day) NOTHROWS;
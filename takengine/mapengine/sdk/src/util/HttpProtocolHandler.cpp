@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <regex>
 #include <memory>
+#include <sstream>
 #include "openssl/ssl.h"
 #include "openssl/x509v3.h"
 #include "util/HttpProtocolHandler.h"
@@ -36,8 +37,8 @@ namespace {
 
     class CURLDataInput : public DataInput2 {
     public:
-        CURLDataInput(const std::shared_ptr<HttpProtocolHandlerClientInterface> &client_iface_, const std::shared_ptr<OpenSSLX509TrustStore> &trustStore);
-        TAKErr open(const char *URI, HTTPSupport support) NOTHROWS;
+        CURLDataInput(const std::shared_ptr<HttpProtocolHandlerClientInterface> &client_iface_, const std::shared_ptr<OpenSSLX509TrustStore> &trustStore, const std::shared_ptr<void> &share);
+        TAKErr open(const char *URI, HTTPSupport support, const char *range) NOTHROWS;
         virtual ~CURLDataInput();
         virtual TAKErr close() NOTHROWS;
         virtual TAKErr read(uint8_t* buf, std::size_t* numRead, const std::size_t len) NOTHROWS;
@@ -53,6 +54,8 @@ namespace {
         mutable TAK::Engine::Thread::Mutex mutex_;
         std::shared_ptr<HttpProtocolHandlerClientInterface> client_iface_;
         std::shared_ptr<OpenSSLX509TrustStore> root_trust_store_;
+        /** the CURLSH handle; keeps the shared connection cache alive */
+        std::shared_ptr<void> share_;
         X509_STORE *store_;
         CURL *curl_easy_;
         CURLM *curl_multi_;
@@ -90,6 +93,52 @@ X509TrustStore::~X509TrustStore() NOTHROWS
 HttpProtocolHandlerClientInterface::~HttpProtocolHandlerClientInterface() NOTHROWS
 { }
 
+//
+// HttpProtocolHandler::ConnectionCache
+//
+
+class HttpProtocolHandler::ConnectionCache {
+public:
+    ConnectionCache() NOTHROWS;
+    ~ConnectionCache() NOTHROWS;
+public:
+    CURLSH *handle;
+private:
+    static void lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr);
+    static void unlock(CURL *handle, curl_lock_data data, void *userptr);
+private:
+    Thread::Mutex mutexes_[CURL_LOCK_DATA_LAST];
+};
+
+HttpProtocolHandler::ConnectionCache::ConnectionCache() NOTHROWS
+    : handle(curl_share_init())
+{
+    if (!handle)
+        return;
+    curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, lock);
+    curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, unlock);
+    curl_share_setopt(handle, CURLSHOPT_USERDATA, (void *)this);
+    curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HttpProtocolHandler::ConnectionCache::~ConnectionCache() NOTHROWS
+{
+    if (handle)
+        curl_share_cleanup(handle);
+}
+
+void HttpProtocolHandler::ConnectionCache::lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    static_cast<ConnectionCache *>(userptr)->mutexes_[data].lock();
+}
+
+void HttpProtocolHandler::ConnectionCache::unlock(CURL *handle, curl_lock_data data, void *userptr)
+{
+    static_cast<ConnectionCache *>(userptr)->mutexes_[data].unlock();
+}
+
 //
 // HttpProtocolHandler
 //
@@ -115,6 +164,18 @@ TAKErr HttpProtocolHandler::triggerRootTrustStorePopulate() NOTHROWS {
 }
 
 TAKErr HttpProtocolHandler::handleURI(DataInput2Ptr& ctx, const char* URI) NOTHROWS {
+    return open(ctx, URI, nullptr);
+}
+
+TAKErr HttpProtocolHandler::handleURIRange(DataInput2Ptr& ctx, const char* URI, const int64_t offset, const std::size_t length) NOTHROWS {
+    if (offset < 0LL || !length)
+        return TE_InvalidArg;
+    std::ostringstream range;
+    range << offset << "-" << (offset + (int64_t)length - 1LL);
+    return open(ctx, URI, range.str().c_str());
+}
+
+TAKErr HttpProtocolHandler::open(DataInput2Ptr& ctx, const char* URI, const char* range) NOTHROWS {
 
     curl_global_init(CURL_GLOBAL_DEFAULT);
 
@@ -122,6 +183,17 @@ TAKErr HttpProtocolHandler::handleURI(DataInput2Ptr& ctx, const char* URI) NOTHR
     if (support == HTTPSupport::NO_SUPPORT)
         return TE_Unsupported;
     
+    std::shared_ptr<void> share;
+    {
+        Thread::Lock lock(this->mutex_);
+        if (lock.status != TE_Ok)
+            return lock.status;
+        if (!this->connection_cache_)
+            this->connection_cache_ = std::make_shared<ConnectionCache>();
+        if (this->connection_cache_->handle)
+            share = std::shared_ptr<void>(this->connection_cache_, this->connection_cache_->handle);
+    }
+
     std::shared_ptr<OpenSSLX509TrustStore> rootTrustStore;
     if (support == HTTPSupport::HTTPS) {
         
@@ -140,8 +212,8 @@ TAKErr HttpProtocolHandler::handleURI(DataInput2Ptr& ctx, const char* URI) NOTHR
         }
     }
 
-    std::unique_ptr<CURLDataInput> result(new CURLDataInput(this->client_iface_, rootTrustStore));
-    TAKErr code = result->open(URI, support);
+    std::unique_ptr<CURLDataInput> result(new CURLDataInput(this->client_iface_, rootTrustStore, share));
+    TAKErr code = result->open(URI, support, range);
     if (code == TE_Ok) {
         ctx = DataInput2Ptr(result.release(), Memory_deleter_const<DataInput2, CURLDataInput>);
     }
@@ -233,11 +305,12 @@ namespace {
     // CURLDataInput
     //
 
-    CURLDataInput::CURLDataInput(const std::shared_ptr<HttpProtocolHandlerClientInterface>& client_iface_, const std::shared_ptr<OpenSSLX509TrustStore>& trustStore)
+    CURLDataInput::CURLDataInput(const std::shared_ptr<HttpProtocolHandlerClientInterface>& client_iface_, const std::shared_ptr<OpenSSLX509TrustStore>& trustStore, const std::shared_ptr<void> &share)
     : curl_easy_(nullptr),
     curl_multi_(nullptr),
     client_iface_(client_iface_),
     root_trust_store_(trustStore),
+    share_(share),
     store_(nullptr),
     running_(0),
     length_(0)
@@ -247,7 +320,7 @@ namespace {
         this->close();
     }
 
-    TAKErr CURLDataInput::open(const char* URI, HTTPSupport support) NOTHROWS {
+    TAKErr CURLDataInput::open(const char* URI, HTTPSupport support, const char *range) NOTHROWS {
 
         // must have a valid host
         if (URI_parse(nullptr, nullptr, &this->host_, nullptr, nullptr, nullptr, URI) != TE_Ok || this->host_.get() == nullptr)
@@ -271,6 +344,13 @@ namespace {
 
             curl_easy_setopt(curl_easy_, CURLOPT_WRITEFUNCTION, writeCallback);
             curl_easy_setopt(curl_easy_, CURLOPT_WRITEDATA, (void*)this);
+            // reuse kept-alive connections across requests
+            if (share_)
+                curl_easy_setopt(curl_easy_, CURLOPT_SHARE, share_.get());
+            curl_easy_setopt(curl_easy_, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(curl_easy_, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+            if (range)
+                curl_easy_setopt(curl_easy_, CURLOPT_RANGE, range);
 
             TAK::Engine::Port::String userAgentStr;
             const char* userAgent = ::DEFAULT_USER_AGENT;
@@ -340,9 +420,17 @@ namespace {
                 authAttempts++;
                 username = nullptr;
                 password = nullptr;
-            } else if (responseCode == 200) {
+            } else if ((!range && responseCode == 200) || (range && responseCode == 206)) {
                 connecting = false;
                 code = TE_Ok;
+            } else if (range && responseCode == 200) {
+                // the server does not support range requests
+                code = TE_Unsupported;
+                connecting = false;
+            } else if (responseCode == 429 || responseCode == 503) {
+                // the server is throttling requests
+                code = TE_Busy;
+                connecting = false;
             } else {
                 code = TE_IO;
                 connecting = false;
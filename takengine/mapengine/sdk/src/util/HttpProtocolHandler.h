@@ -132,13 +132,33 @@ namespace TAK
                 //
 
                 /**
-                 * Handle the request
+                 * Handle the request.
+                 *
+                 * Connections, DNS lookups and TLS sessions are shared by
+                 * all requests made through this handler, so consecutive
+                 * requests to the same host reuse a kept-alive connection.
+                 * HTTP/2 is negotiated for HTTPS where the server supports
+                 * it. The request fails with <code>TE_Busy</code> if the
+                 * server responds 429 or 503, indicating that the client
+                 * should back off.
                  */
                 Util::TAKErr handleURI(DataInput2Ptr &ctx, const char *URI) NOTHROWS override;
+                /**
+                 * Handle the request for a byte range of the resource, sent
+                 * as a <code>Range</code> header. The request fails with
+                 * <code>TE_Unsupported</code> if the server does not honor
+                 * the range.
+                 */
+                Util::TAKErr handleURIRange(DataInput2Ptr &ctx, const char *URI, const int64_t offset, const std::size_t length) NOTHROWS override;
+            private:
+                class ConnectionCache;
+            private:
+                Util::TAKErr open(DataInput2Ptr &ctx, const char *URI, const char *range) NOTHROWS;
             private:
                 Thread::Mutex mutex_;
                 std::shared_ptr<HttpProtocolHandlerClientInterface> client_iface_;
                 std::shared_ptr<X509TrustStore> root_trust_store_;
+                std::shared_ptr<ConnectionCache> connection_cache_;
             };
 
         }
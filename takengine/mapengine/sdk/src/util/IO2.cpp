@@ -188,6 +188,21 @@ TAKErr TAK::Engine::Util::IO_copy(DataOutput2 &dst, DataInput2 &src) NOTHROWS
 {
     TAKErr code(TE_Ok);
 
+    // memory backed input may be written directly
+    if (auto *memsrc = dynamic_cast<MemoryInput2 *>(&src)) {
+        const uint8_t *data;
+        std::size_t off;
+        std::size_t rem;
+        if (memsrc->getData(&data) == TE_Ok && memsrc->tell(&off) == TE_Ok && memsrc->remaining(&rem) == TE_Ok) {
+            if (rem) {
+                code = dst.write(data + off, rem);
+                TE_CHECKRETURN_CODE(code);
+                code = memsrc->skip(rem);
+            }
+            return code;
+        }
+    }
+
     uint8_t buf[8192];
 
     do {
@@ -613,18 +628,7 @@ TAKErr TAK::Engine::Util::IO_listZipEntries(TAK::Engine::Port::Collection<TAK::E
     TAKErr code = ZipFile::open(zipPtr, path);
     TE_CHECKRETURN_CODE(code);
 
-    code = zipPtr->gotoFirstEntry();
-    TE_CHECKRETURN_CODE(code);
-
-    do {
-        TAK::Engine::Port::String entryPath;
-        code = zipPtr->getCurrentEntryPath(entryPath);
-        TE_CHECKBREAK_CODE(code);
-        if (!filter || filter(entryPath.get()))
-            value.add(entryPath);
-    } while ((code = zipPtr->gotoNextEntry()) == TE_Ok);
-
-    return code == TE_Done ? TE_Ok : code;
+    return zipPtr->listEntries(value, nullptr, filter);
 }
 
 TAKErr TAK::Engine::Util::IO_openZipEntry(std::unique_ptr<DataInput2, void(*)(const DataInput2 *)> &dataPtr, const char *zipPath, const char *entry) NOTHROWS
@@ -691,7 +695,8 @@ TAKErr TAK::Engine::Util::IO_isFileV(bool *value, const char *vpath) NOTHROWS
             return TE_Ok;
         }
 
-        code = zipPtr->gotoEntry(split.second.c_str());
+        int64_t entrySize;
+        code = zipPtr->getEntryUncompressedSize(entrySize, split.second.c_str());
         *value = code == TE_Ok;
 
         return code == TE_Done ? TE_Ok : code;
@@ -735,8 +740,9 @@ TAKErr TAK::Engine::Util::IO_existsV(bool *value, const char *vpath) NOTHROWS
         TAKErr code = ZipFile::open(zipPtr, split.first.c_str());
         TE_CHECKRETURN_CODE(code);
 
+        int64_t entrySize;
         if (split.second != ".")
-            code = zipPtr->gotoEntry(split.second.c_str());
+            code = zipPtr->getEntryUncompressedSize(entrySize, split.second.c_str());
 
         if (value)
             *value = (code == TE_Ok);
@@ -757,11 +763,8 @@ TAKErr TAK::Engine::Util::IO_getFileSizeV(int64_t *size, const char *vpath) NOTH
         TAKErr code = ZipFile::open(zipPtr, split.first.c_str());
         TE_CHECKRETURN_CODE(code);
 
-        code = zipPtr->gotoEntry(split.second.c_str());
-        TE_CHECKRETURN_CODE(code);
-
         int64_t result = 0;
-        code = zipPtr->getCurrentEntryUncompressedSize(result);
+        code = zipPtr->getEntryUncompressedSize(result, split.second.c_str());
         TE_CHECKRETURN_CODE(code);
 
         *size = result;
@@ -0,0 +1,137 @@
+#ifndef TAK_ENGINE_UTIL_LAZYSPI_H_INCLUDED
+#define TAK_ENGINE_UTIL_LAZYSPI_H_INCLUDED
+
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/Platform.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Cheap description of an SPI, sufficient for a factory to
+             * register and filter on the SPI without instantiating it.
+             */
+            struct LazySpiDescriptor
+            {
+                /** The name (or type) of the SPI; used to match hints */
+                const char *name;
+                int priority;
+                /**
+                 * The case-insensitive URI suffixes supported by the SPI,
+                 * e.g. `.obj`. If `nullptr`, all URIs are considered a
+                 * potential match.
+                 */
+                const char *const *extensions;
+                std::size_t numExtensions;
+            };
+
+            /**
+             * Holds an SPI that is instantiated on first use. The SPI is
+             * described by the file extensions (or, more generally, URI
+             * suffixes) that it supports, allowing factories to skip the
+             * SPI without instantiating it.
+             */
+            template<class T>
+            class LazySpi
+            {
+            public :
+                typedef std::shared_ptr<T>(*Factory)();
+            public :
+                LazySpi(const LazySpiDescriptor &descriptor, const Factory factory) NOTHROWS;
+            public :
+                const char *getName() const NOTHROWS;
+                int getPriority() const NOTHROWS;
+                /**
+                 * Returns `true` if the SPI may support the URI, per its
+                 * extensions. Does not instantiate the SPI.
+                 */
+                bool matches(const char *uri) const NOTHROWS;
+                /**
+                 * Returns the SPI, instantiating it on the first call.
+                 */
+                TAKErr get(std::shared_ptr<T> &value) NOTHROWS;
+            private :
+                std::string name;
+                int priority;
+                Factory factory;
+                std::vector<std::string> extensions;
+                Thread::Mutex mutex;
+                std::shared_ptr<T> instance;
+            };
+
+            template<class T>
+            inline LazySpi<T>::LazySpi(const LazySpiDescriptor &descriptor, const Factory factory_) NOTHROWS :
+                name(descriptor.name ? descriptor.name : ""),
+                priority(descriptor.priority),
+                factory(factory_)
+            {
+                for (std::size_t i = 0u; descriptor.extensions && i < descriptor.numExtensions; i++) {
+                    if (!descriptor.extensions[i])
+                        continue;
+                    std::string ext(descriptor.extensions[i]);
+                    for (std::size_t j = 0u; j < ext.length(); j++)
+                        ext[j] = (char)tolower(ext[j]);
+                    extensions.push_back(ext);
+                }
+            }
+            template<class T>
+            inline const char *LazySpi<T>::getName() const NOTHROWS
+            {
+                return name.c_str();
+            }
+            template<class T>
+            inline int LazySpi<T>::getPriority() const NOTHROWS
+            {
+                return priority;
+            }
+            template<class T>
+            inline bool LazySpi<T>::matches(const char *uri) const NOTHROWS
+            {
+                if (extensions.empty())
+                    return true;
+                if (!uri)
+                    return false;
+                const std::size_t len = strlen(uri);
+                for (auto it = extensions.begin(); it != extensions.end(); it++) {
+                    if (it->length() > len)
+                        continue;
+                    const char *suffix = uri + (len - it->length());
+                    std::size_t i = 0u;
+                    while (i < it->length() && tolower(suffix[i]) == (*it)[i])
+                        i++;
+                    if (i == it->length())
+                        return true;
+                }
+                return false;
+            }
+            template<class T>
+            inline TAKErr LazySpi<T>::get(std::shared_ptr<T> &value) NOTHROWS
+            {
+                TAKErr code(TE_Ok);
+                Thread::Lock lock(mutex);
+                code = lock.status;
+                TE_CHECKRETURN_CODE(code);
+                if (!instance.get()) {
+                    if (!factory)
+                        return TE_IllegalState;
+                    instance = factory();
+                    if (!instance.get())
+                        return TE_Err;
+                }
+                value = instance;
+                return code;
+            }
+        }
+    }
+}
+
+#endif
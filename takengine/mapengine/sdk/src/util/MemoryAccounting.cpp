@@ -0,0 +1,95 @@
+#include "util/MemoryAccounting.h"
+
+#include <atomic>
+#include <cstring>
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    enum {
+        NumCategories = MemoryAccountingSnapshot::NumCategories,
+    };
+
+    struct CategoryCounters
+    {
+        std::atomic<int64_t> bytes {0};
+        std::atomic<int64_t> peakBytes {0};
+        std::atomic<uint64_t> allocations {0u};
+        std::atomic<uint64_t> releases {0u};
+    };
+
+    CategoryCounters *counters() NOTHROWS
+    {
+        // intentionally leaked; accounted objects may be released after
+        // static destruction
+        static CategoryCounters *c = new CategoryCounters[NumCategories];
+        return c;
+    }
+
+    const char *CategoryNames[NumCategories] =
+    {
+        "Texture",
+        "TextureCache",
+        "TerrainTile",
+        "Mesh",
+        "FeatureStore",
+        "Bitmap",
+        "TexturePool",
+        "BitmapPool",
+    };
+
+    bool isValid(const MemoryCategory category) NOTHROWS
+    {
+        return (int)category >= 0 && (int)category < NumCategories;
+    }
+}
+
+MemoryAccountingSnapshot::MemoryAccountingSnapshot() NOTHROWS
+{
+    memset(categories, 0, sizeof(categories));
+}
+
+void TAK::Engine::Util::MemoryAccounting_allocate(const MemoryCategory category, const std::size_t bytes) NOTHROWS
+{
+    if (!isValid(category))
+        return;
+    CategoryCounters &c = counters()[category];
+    c.allocations.fetch_add(1u, std::memory_order_relaxed);
+    const int64_t current = c.bytes.fetch_add((int64_t)bytes, std::memory_order_relaxed) + (int64_t)bytes;
+    int64_t peak = c.peakBytes.load(std::memory_order_relaxed);
+    while (current > peak && !c.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        ;
+}
+void TAK::Engine::Util::MemoryAccounting_release(const MemoryCategory category, const std::size_t bytes) NOTHROWS
+{
+    if (!isValid(category))
+        return;
+    CategoryCounters &c = counters()[category];
+    c.releases.fetch_add(1u, std::memory_order_relaxed);
+    c.bytes.fetch_sub((int64_t)bytes, std::memory_order_relaxed);
+}
+TAKErr TAK::Engine::Util::MemoryAccounting_getSnapshot(MemoryAccountingSnapshot *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    CategoryCounters *c = counters();
+    for (std::size_t i = 0u; i < NumCategories; i++) {
+        MemoryAccountingSnapshot::Category &category = value->categories[i];
+        category.bytes = c[i].bytes.load(std::memory_order_relaxed);
+        category.peakBytes = c[i].peakBytes.load(std::memory_order_relaxed);
+        category.allocations = c[i].allocations.load(std::memory_order_relaxed);
+        category.releases = c[i].releases.load(std::memory_order_relaxed);
+    }
+    return TE_Ok;
+}
+void TAK::Engine::Util::MemoryAccounting_resetPeaks() NOTHROWS
+{
+    CategoryCounters *c = counters();
+    for (std::size_t i = 0u; i < NumCategories; i++)
+        c[i].peakBytes.store(c[i].bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+const char *TAK::Engine::Util::MemoryCategory_getName(const MemoryCategory category) NOTHROWS
+{
+    return isValid(category) ? CategoryNames[category] : nullptr;
+}
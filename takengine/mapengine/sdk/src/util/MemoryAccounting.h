@@ -0,0 +1,84 @@
+#ifndef TAK_ENGINE_UTIL_MEMORYACCOUNTING_H_INCLUDED
+#define TAK_ENGINE_UTIL_MEMORYACCOUNTING_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Categories of memory tracked by the engine. Categories may
+             * overlap; e.g. textures retained by a texture cache are
+             * reported under both `TEMC_Texture` and `TEMC_TextureCache`.
+             */
+            enum MemoryCategory
+            {
+                /** GL texture storage */
+                TEMC_Texture,
+                /** Textures and associated data retained by texture caches */
+                TEMC_TextureCache,
+                /** Terrain tile meshes */
+                TEMC_TerrainTile,
+                /** Model meshes loaded for rendering */
+                TEMC_Mesh,
+                /** Records held by in-memory feature stores */
+                TEMC_FeatureStore,
+                /** Bitmap pixel buffers */
+                TEMC_Bitmap,
+                /** Textures retained for reuse by texture pools */
+                TEMC_TexturePool,
+                /** Pixel buffers retained for reuse by the bitmap buffer pool */
+                TEMC_BitmapPool,
+            };
+
+            /**
+             * Point-in-time copy of the engine memory counters. Byte counts
+             * are estimates of the payload, excluding allocator overhead.
+             */
+            struct ENGINE_API MemoryAccountingSnapshot
+            {
+                enum {
+                    NumCategories = TEMC_BitmapPool + 1,
+                };
+
+                struct Category
+                {
+                    /** Bytes currently accounted */
+                    int64_t bytes;
+                    /** High water mark of `bytes` since the last reset */
+                    int64_t peakBytes;
+                    uint64_t allocations;
+                    uint64_t releases;
+                };
+
+                MemoryAccountingSnapshot() NOTHROWS;
+
+                Category categories[NumCategories];
+            };
+
+            /**
+             * Records an allocation of the specified number of bytes
+             * against the category.
+             */
+            ENGINE_API void MemoryAccounting_allocate(const MemoryCategory category, const std::size_t bytes) NOTHROWS;
+            /**
+             * Records the release of the specified number of bytes
+             * previously recorded via `MemoryAccounting_allocate`.
+             */
+            ENGINE_API void MemoryAccounting_release(const MemoryCategory category, const std::size_t bytes) NOTHROWS;
+            ENGINE_API TAKErr MemoryAccounting_getSnapshot(MemoryAccountingSnapshot *value) NOTHROWS;
+            /**
+             * Resets the high water mark for each category to the current
+             * byte count.
+             */
+            ENGINE_API void MemoryAccounting_resetPeaks() NOTHROWS;
+            ENGINE_API const char *MemoryCategory_getName(const MemoryCategory category) NOTHROWS;
+        }
+    }
+}
+
+#endif
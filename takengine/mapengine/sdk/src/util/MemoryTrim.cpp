@@ -0,0 +1,82 @@
+#include "util/MemoryTrim.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Thread;
+
+namespace
+{
+    struct Registry
+    {
+        // recursive to allow trimmables to (un)register from `trim`
+        Mutex mutex {TEMT_Recursive};
+        std::vector<MemoryTrimmable *> trimmables;
+    };
+
+    Registry &registry() NOTHROWS
+    {
+        // intentionally leaked; trimmables may unregister after static
+        // destruction
+        static Registry *r = new Registry();
+        return *r;
+    }
+}
+
+MemoryTrimmable::~MemoryTrimmable() NOTHROWS
+{}
+
+TAKErr TAK::Engine::Util::MemoryTrim_registerTrimmable(MemoryTrimmable &trimmable) NOTHROWS
+{
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+    if (std::find(r.trimmables.begin(), r.trimmables.end(), &trimmable) == r.trimmables.end())
+        r.trimmables.push_back(&trimmable);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::MemoryTrim_unregisterTrimmable(const MemoryTrimmable &trimmable) NOTHROWS
+{
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+    auto entry = std::find(r.trimmables.begin(), r.trimmables.end(), &trimmable);
+    if (entry == r.trimmables.end())
+        return TE_InvalidArg;
+    r.trimmables.erase(entry);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::MemoryTrim_trim(const MemoryTrimLevel level) NOTHROWS
+{
+    if ((int)level < TETL_Moderate || (int)level > TETL_Complete)
+        return TE_InvalidArg;
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+    // iterate a copy; the list may be modified during dispatch
+    const std::vector<MemoryTrimmable *> trimmables(r.trimmables);
+    for (auto it = trimmables.begin(); it != trimmables.end(); it++) {
+        if (std::find(r.trimmables.begin(), r.trimmables.end(), *it) != r.trimmables.end())
+            (*it)->trim(level);
+    }
+    return TE_Ok;
+}
+std::size_t TAK::Engine::Util::MemoryTrimLevel_getBudget(const MemoryTrimLevel level, const std::size_t nominalSize) NOTHROWS
+{
+    switch (level) {
+    case TETL_Moderate :
+        return (nominalSize / 4u) * 3u;
+    case TETL_Low :
+        return nominalSize / 2u;
+    case TETL_Critical :
+        return nominalSize / 4u;
+    case TETL_Complete :
+    default :
+        return 0u;
+    }
+}
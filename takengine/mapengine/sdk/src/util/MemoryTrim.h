@@ -0,0 +1,66 @@
+#ifndef TAK_ENGINE_UTIL_MEMORYTRIM_H_INCLUDED
+#define TAK_ENGINE_UTIL_MEMORYTRIM_H_INCLUDED
+
+#include <cstddef>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Severity of a memory pressure notification, in increasing
+             * order. The levels loosely correspond to the Android
+             * `ComponentCallbacks2.TRIM_MEMORY_*` constants.
+             */
+            enum MemoryTrimLevel
+            {
+                /** System is beginning to run low; `RUNNING_MODERATE` */
+                TETL_Moderate,
+                /** System is running low; `RUNNING_LOW` */
+                TETL_Low,
+                /** System is close to killing processes; `RUNNING_CRITICAL` */
+                TETL_Critical,
+                /**
+                 * Application is not visible; `UI_HIDDEN` and above. All
+                 * memory that can be reloaded should be released.
+                 */
+                TETL_Complete,
+            };
+
+            /**
+             * A cache that is capable of releasing retained memory in
+             * response to memory pressure.
+             */
+            class ENGINE_API MemoryTrimmable
+            {
+            protected :
+                virtual ~MemoryTrimmable() NOTHROWS = 0;
+            public :
+                /**
+                 * Releases retained memory per the specified level.
+                 * Implementations are invoked with the registry locked on
+                 * the thread that raised the notification; any work that
+                 * must be performed on a specific thread (e.g. releasing GL
+                 * resources) should be scheduled rather than blocked on.
+                 */
+                virtual void trim(const MemoryTrimLevel level) NOTHROWS = 0;
+            };
+
+            ENGINE_API TAKErr MemoryTrim_registerTrimmable(MemoryTrimmable &trimmable) NOTHROWS;
+            ENGINE_API TAKErr MemoryTrim_unregisterTrimmable(const MemoryTrimmable &trimmable) NOTHROWS;
+            /**
+             * Notifies all registered trimmables of memory pressure.
+             */
+            ENGINE_API TAKErr MemoryTrim_trim(const MemoryTrimLevel level) NOTHROWS;
+            /**
+             * Returns the number of bytes a cache with the specified nominal
+             * size should retain when trimmed at the specified level.
+             */
+            ENGINE_API std::size_t MemoryTrimLevel_getBudget(const MemoryTrimLevel level, const std::size_t nominalSize) NOTHROWS;
+        }
+    }
+}
+
+#endif
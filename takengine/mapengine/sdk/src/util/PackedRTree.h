@@ -0,0 +1,434 @@
+#ifndef TAK_ENGINE_UTIL_PACKEDRTREE_H_INCLUDED
+#define TAK_ENGINE_UTIL_PACKEDRTREE_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Static R-tree packed into contiguous arrays using
+             * Sort-Tile-Recursive (STR) bulk loading. Each level of the tree
+             * is stored as a flat array of node bounds; the children of a
+             * node are always the next `NodeCapacity` contiguous nodes of
+             * the level below, so no child pointers are stored and
+             * traversal walks memory linearly.
+             *
+             * <P>Incremental modification is supported for compatibility
+             * with dynamic indices. Inserted values are held in an unpacked
+             * delta list and removed values are masked in place until the pending
+             * modifications exceed a fraction of the packed size, at which
+             * point the tree is rebuilt.
+             *
+             * <P>Values must be copyable, equality comparable and hashable
+             * via `std::hash`; pointers are the typical element type. A
+             * value may be present in the tree at most once.
+             *
+             * <P>This class is not thread-safe.
+             */
+            template<class T>
+            class PackedRTree
+            {
+            public :
+                struct Bounds
+                {
+                    double minX;
+                    double minY;
+                    double maxX;
+                    double maxY;
+                };
+            private :
+                enum {
+                    NodeCapacity = 16,
+                    /** sufficient for more than 2^64 values */
+                    MaxDepth = 17,
+                    MinPendingRepack = 256,
+                };
+            public :
+                PackedRTree() NOTHROWS;
+            public :
+                /**
+                 * Replaces the contents of the tree with the specified
+                 * values.
+                 */
+                TAKErr load(const T *values, const Bounds *bounds, const std::size_t count) NOTHROWS;
+                /**
+                 * Inserts the specified value. The value is immediately
+                 * visible to queries. Values with `NaN` bounds are never
+                 * matched and are discarded when the tree is packed.
+                 */
+                TAKErr insert(const T &value, const Bounds &bounds) NOTHROWS;
+                TAKErr insert(const T &value, const double minX, const double minY, const double maxX, const double maxY) NOTHROWS;
+                /**
+                 * Removes the specified value.
+                 *
+                 * @return  `true` if the value was removed, `false` if it is
+                 *          not in the tree
+                 */
+                bool remove(const T &value) NOTHROWS;
+                void clear() NOTHROWS;
+                /**
+                 * Rebuilds the packed tree, merging all pending
+                 * modifications.
+                 */
+                TAKErr pack() NOTHROWS;
+                std::size_t size() const NOTHROWS;
+                /**
+                 * Writes the values whose bounds intersect the specified
+                 * region to `results`. At most `capacity` values are
+                 * written.
+                 *
+                 * @return  The total number of intersecting values; if
+                 *          greater than `capacity`, the query may be
+                 *          reissued with a larger buffer
+                 */
+                std::size_t query(const double minX, const double minY, const double maxX, const double maxY, T *results, const std::size_t capacity) const NOTHROWS;
+                /**
+                 * Appends the values whose bounds intersect the specified
+                 * region to the container via `push_back`.
+                 */
+                template<class Container>
+                TAKErr query(Container &results, const double minX, const double minY, const double maxX, const double maxY) const NOTHROWS;
+                /**
+                 * Invokes the specified functor, of signature
+                 * `bool(const T &)`, for each value whose bounds intersect
+                 * the specified region. Iteration stops when the functor
+                 * returns `false`.
+                 */
+                template<class Fn>
+                void visit(const double minX, const double minY, const double maxX, const double maxY, Fn fn) const;
+            private :
+                bool needsRepack() const NOTHROWS;
+                void build(std::vector<T> &values, std::vector<Bounds> &bounds);
+            private :
+                static bool intersects(const Bounds &a, const double minX, const double minY, const double maxX, const double maxY) NOTHROWS;
+            private :
+                /** packed values and their bounds, in leaf order */
+                std::vector<T> values;
+                std::vector<Bounds> valueBounds;
+                /** node bounds for all levels, leaf level first */
+                std::vector<Bounds> nodes;
+                /** offset of the first node for each level, plus end offset */
+                std::vector<std::size_t> levelOffsets;
+
+                /** values inserted since the last pack */
+                std::vector<T> pending;
+                std::vector<Bounds> pendingBounds;
+                std::unordered_map<T, std::size_t> pendingIndex;
+                /** maps packed values to their leaf order index */
+                std::unordered_map<T, std::size_t> packedIndex;
+                /** number of packed values removed since the last pack */
+                std::size_t invalidated;
+            };
+
+            template<class T>
+            inline PackedRTree<T>::PackedRTree() NOTHROWS :
+                invalidated(0u)
+            {}
+            template<class T>
+            inline TAKErr PackedRTree<T>::load(const T *values_, const Bounds *bounds_, const std::size_t count) NOTHROWS
+            {
+                if (count && (!values_ || !bounds_))
+                    return TE_InvalidArg;
+                TAKErr code(TE_Ok);
+                TE_BEGIN_TRAP() {
+                    std::vector<T> v(values_, values_ + count);
+                    std::vector<Bounds> b(bounds_, bounds_ + count);
+                    build(v, b);
+                    pending.clear();
+                    pendingBounds.clear();
+                    pendingIndex.clear();
+                    invalidated = 0u;
+                } TE_END_TRAP(code);
+                return code;
+            }
+            template<class T>
+            inline TAKErr PackedRTree<T>::insert(const T &value, const Bounds &bounds) NOTHROWS
+            {
+                TAKErr code(TE_Ok);
+                TE_BEGIN_TRAP() {
+                    pendingIndex[value] = pending.size();
+                    pending.push_back(value);
+                    pendingBounds.push_back(bounds);
+                } TE_END_TRAP(code);
+                if (code != TE_Ok) {
+                    // restore consistency of the delta
+                    if (pending.size() > pendingBounds.size())
+                        pending.pop_back();
+                    pendingIndex.erase(value);
+                    return code;
+                }
+                // a failed repack leaves the value in the delta
+                if (needsRepack())
+                    pack();
+                return TE_Ok;
+            }
+            template<class T>
+            inline TAKErr PackedRTree<T>::insert(const T &value, const double minX, const double minY, const double maxX, const double maxY) NOTHROWS
+            {
+                Bounds bounds;
+                bounds.minX = minX;
+                bounds.minY = minY;
+                bounds.maxX = maxX;
+                bounds.maxY = maxY;
+                return insert(value, bounds);
+            }
+            template<class T>
+            inline bool PackedRTree<T>::remove(const T &value) NOTHROWS
+            {
+                auto entry = pendingIndex.find(value);
+                if (entry != pendingIndex.end()) {
+                    // swap-remove from the delta
+                    const std::size_t idx = entry->second;
+                    pendingIndex.erase(entry);
+                    if (idx != pending.size() - 1u) {
+                        pending[idx] = pending.back();
+                        pendingBounds[idx] = pendingBounds.back();
+                        pendingIndex.find(pending[idx])->second = idx;
+                    }
+                    pending.pop_back();
+                    pendingBounds.pop_back();
+                    return true;
+                }
+                entry = packedIndex.find(value);
+                if (entry == packedIndex.end())
+                    return false;
+                // mask the packed entry; invalid bounds never intersect and
+                // are dropped on the next pack
+                Bounds &bounds = valueBounds[entry->second];
+                bounds.minX = bounds.minY = bounds.maxX = bounds.maxY = NAN;
+                packedIndex.erase(entry);
+                invalidated++;
+                if (needsRepack())
+                    pack();
+                return true;
+            }
+            template<class T>
+            inline void PackedRTree<T>::clear() NOTHROWS
+            {
+                values.clear();
+                valueBounds.clear();
+                nodes.clear();
+                levelOffsets.clear();
+                pending.clear();
+                pendingBounds.clear();
+                pendingIndex.clear();
+                packedIndex.clear();
+                invalidated = 0u;
+            }
+            template<class T>
+            inline TAKErr PackedRTree<T>::pack() NOTHROWS
+            {
+                TAKErr code(TE_Ok);
+                TE_BEGIN_TRAP() {
+                    std::vector<T> v;
+                    std::vector<Bounds> b;
+                    const std::size_t count = values.size() + pending.size();
+                    v.reserve(count);
+                    b.reserve(count);
+                    for (std::size_t i = 0u; i < values.size(); i++) {
+                        if (std::isnan(valueBounds[i].minX))
+                            continue;
+                        v.push_back(values[i]);
+                        b.push_back(valueBounds[i]);
+                    }
+                    v.insert(v.end(), pending.begin(), pending.end());
+                    b.insert(b.end(), pendingBounds.begin(), pendingBounds.end());
+                    build(v, b);
+                    pending.clear();
+                    pendingBounds.clear();
+                    pendingIndex.clear();
+                    invalidated = 0u;
+                } TE_END_TRAP(code);
+                return code;
+            }
+            template<class T>
+            inline std::size_t PackedRTree<T>::size() const NOTHROWS
+            {
+                return values.size() - invalidated + pending.size();
+            }
+            template<class T>
+            inline std::size_t PackedRTree<T>::query(const double minX, const double minY, const double maxX, const double maxY, T *results, const std::size_t capacity) const NOTHROWS
+            {
+                std::size_t count = 0u;
+                visit(minX, minY, maxX, maxY, [&](const T &value) -> bool
+                {
+                    if (count < capacity)
+                        results[count] = value;
+                    count++;
+                    return true;
+                });
+                return count;
+            }
+            template<class T>
+            template<class Container>
+            inline TAKErr PackedRTree<T>::query(Container &results, const double minX, const double minY, const double maxX, const double maxY) const NOTHROWS
+            {
+                TAKErr code(TE_Ok);
+                TE_BEGIN_TRAP() {
+                    visit(minX, minY, maxX, maxY, [&](const T &value) -> bool
+                    {
+                        results.push_back(value);
+                        return true;
+                    });
+                } TE_END_TRAP(code);
+                return code;
+            }
+            template<class T>
+            template<class Fn>
+            inline void PackedRTree<T>::visit(const double minX, const double minY, const double maxX, const double maxY, Fn fn) const
+            {
+                if (!values.empty()) {
+                    struct NodeRef
+                    {
+                        std::size_t level;
+                        std::size_t index;
+                    };
+                    // depth first; at most `NodeCapacity` siblings are
+                    // pending per level
+                    NodeRef stack[MaxDepth*NodeCapacity];
+                    std::size_t depth = 0u;
+                    const std::size_t root = levelOffsets.size() - 2u;
+                    stack[depth++] = NodeRef{root, 0u};
+                    while (depth) {
+                        const NodeRef node = stack[--depth];
+                        const std::size_t childBegin = node.index * NodeCapacity;
+                        if (!node.level) {
+                            const std::size_t childEnd = std::min(childBegin + NodeCapacity, values.size());
+                            for (std::size_t i = childBegin; i < childEnd; i++) {
+                                if (intersects(valueBounds[i], minX, minY, maxX, maxY) && !fn(values[i]))
+                                    return;
+                            }
+                        } else {
+                            const std::size_t childLevel = node.level - 1u;
+                            const std::size_t levelBegin = levelOffsets[childLevel];
+                            const std::size_t levelSize = levelOffsets[childLevel + 1u] - levelBegin;
+                            const std::size_t childEnd = std::min(childBegin + NodeCapacity, levelSize);
+                            // push in reverse to visit in storage order
+                            for (std::size_t i = childEnd; i > childBegin; i--) {
+                                if (intersects(nodes[levelBegin + i - 1u], minX, minY, maxX, maxY))
+                                    stack[depth++] = NodeRef{childLevel, i - 1u};
+                            }
+                        }
+                    }
+                }
+
+                for (std::size_t i = 0u; i < pending.size(); i++) {
+                    if (intersects(pendingBounds[i], minX, minY, maxX, maxY) && !fn(pending[i]))
+                        return;
+                }
+            }
+            template<class T>
+            inline bool PackedRTree<T>::needsRepack() const NOTHROWS
+            {
+                const std::size_t modifications = pending.size() + invalidated;
+                return modifications > std::max((std::size_t)MinPendingRepack, values.size() / 16u);
+            }
+            template<class T>
+            inline void PackedRTree<T>::build(std::vector<T> &values_, std::vector<Bounds> &bounds_)
+            {
+                const std::size_t count = values_.size();
+
+                // STR: sort by center X, cut into vertical slices of
+                // `sliceCount` leaves, then sort each slice by center Y.
+                // Slices alternate direction so that consecutive leaves,
+                // which share a parent, remain spatially adjacent.
+                std::vector<std::size_t> order(count);
+                for (std::size_t i = 0u; i < count; i++)
+                    order[i] = i;
+                const std::size_t leafCount = (count + NodeCapacity - 1u) / NodeCapacity;
+                const std::size_t sliceCount = (std::size_t)std::ceil(std::sqrt((double)leafCount));
+                const std::size_t sliceSize = (sliceCount ? ((leafCount + sliceCount - 1u) / sliceCount) : 0u) * NodeCapacity;
+                const Bounds *b = bounds_.data();
+                std::sort(order.begin(), order.end(), [b](const std::size_t a, const std::size_t c)
+                {
+                    return (b[a].minX + b[a].maxX) < (b[c].minX + b[c].maxX);
+                });
+                for (std::size_t s = 0u; sliceSize && s * sliceSize < count; s++) {
+                    auto first = order.begin() + s * sliceSize;
+                    auto last = order.begin() + std::min((s + 1u) * sliceSize, count);
+                    if (s % 2u) {
+                        std::sort(first, last, [b](const std::size_t a, const std::size_t c)
+                        {
+                            return (b[a].minY + b[a].maxY) > (b[c].minY + b[c].maxY);
+                        });
+                    } else {
+                        std::sort(first, last, [b](const std::size_t a, const std::size_t c)
+                        {
+                            return (b[a].minY + b[a].maxY) < (b[c].minY + b[c].maxY);
+                        });
+                    }
+                }
+
+                std::vector<T> packedValues;
+                std::vector<Bounds> packedBounds;
+                packedValues.reserve(count);
+                packedBounds.reserve(count);
+                for (std::size_t i = 0u; i < count; i++) {
+                    packedValues.push_back(values_[order[i]]);
+                    packedBounds.push_back(bounds_[order[i]]);
+                }
+
+                // compute node bounds bottom up
+                std::vector<Bounds> packedNodes;
+                std::vector<std::size_t> offsets;
+                std::size_t nodeCount = 0u;
+                for (std::size_t n = leafCount; n > 1u; n = (n + NodeCapacity - 1u) / NodeCapacity)
+                    nodeCount += n;
+                nodeCount++;
+                packedNodes.reserve(nodeCount);
+
+                const Bounds *children = packedBounds.data();
+                std::size_t childCount = count;
+                do {
+                    offsets.push_back(packedNodes.size());
+                    const std::size_t levelBegin = packedNodes.size();
+                    for (std::size_t i = 0u; i < childCount; i += NodeCapacity) {
+                        Bounds mbb = children[i];
+                        const std::size_t end = std::min(i + NodeCapacity, childCount);
+                        for (std::size_t j = i + 1u; j < end; j++) {
+                            if (children[j].minX < mbb.minX) mbb.minX = children[j].minX;
+                            if (children[j].minY < mbb.minY) mbb.minY = children[j].minY;
+                            if (children[j].maxX > mbb.maxX) mbb.maxX = children[j].maxX;
+                            if (children[j].maxY > mbb.maxY) mbb.maxY = children[j].maxY;
+                        }
+                        packedNodes.push_back(mbb);
+                    }
+                    childCount = packedNodes.size() - levelBegin;
+                    children = packedNodes.data() + levelBegin;
+                } while (childCount > 1u);
+                offsets.push_back(packedNodes.size());
+
+                std::unordered_map<T, std::size_t> index;
+                index.reserve(count);
+                for (std::size_t i = 0u; i < count; i++)
+                    index[packedValues[i]] = i;
+
+                values.swap(packedValues);
+                valueBounds.swap(packedBounds);
+                packedIndex.swap(index);
+                nodes.swap(packedNodes);
+                levelOffsets.swap(offsets);
+                if (!count) {
+                    nodes.clear();
+                    levelOffsets.clear();
+                }
+            }
+            template<class T>
+            inline bool PackedRTree<T>::intersects(const Bounds &a, const double minX, const double minY, const double maxX, const double maxY) NOTHROWS
+            {
+                return a.minX <= maxX && a.maxX >= minX && a.minY <= maxY && a.maxY >= minY;
+            }
+        }
+    }
+}
+
+#endif
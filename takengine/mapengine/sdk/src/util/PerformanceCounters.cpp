@@ -0,0 +1,75 @@
+#include "util/PerformanceCounters.h"
+
+#include <atomic>
+#include <cstring>
+
+using namespace TAK::Engine::Util;
+
+namespace
+{
+    enum {
+        NumCounters = PerformanceCountersSnapshot::NumCounters,
+    };
+
+    thread_local std::shared_ptr<PerformanceCounters> current;
+
+    const char *CounterNames[NumCounters] =
+    {
+        "DrawCalls",
+        "Triangles",
+        "TextureUploadBytes",
+        "TileRequestsIssued",
+        "TileRequestsCompleted",
+        "LabelsPlaced",
+    };
+
+    bool isValid(const PerformanceCounter counter) NOTHROWS
+    {
+        return (int)counter >= 0 && (int)counter < NumCounters;
+    }
+}
+
+PerformanceCountersSnapshot::PerformanceCountersSnapshot() NOTHROWS
+{
+    memset(counters, 0, sizeof(counters));
+}
+
+PerformanceCounters::PerformanceCounters() NOTHROWS
+{
+    for (std::size_t i = 0u; i < NumCounters; i++)
+        counters[i].store(0u, std::memory_order_relaxed);
+}
+void PerformanceCounters::add(const PerformanceCounter counter, const std::size_t count) NOTHROWS
+{
+    if (!isValid(counter))
+        return;
+    counters[counter].fetch_add((uint64_t)count, std::memory_order_relaxed);
+}
+TAKErr PerformanceCounters::getSnapshot(PerformanceCountersSnapshot *value) const NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    for (std::size_t i = 0u; i < NumCounters; i++)
+        value->counters[i] = counters[i].load(std::memory_order_relaxed);
+    return TE_Ok;
+}
+
+void TAK::Engine::Util::PerformanceCounters_add(const PerformanceCounter counter, const std::size_t count) NOTHROWS
+{
+    if (current)
+        current->add(counter, count);
+}
+std::shared_ptr<PerformanceCounters> TAK::Engine::Util::PerformanceCounters_getCurrent() NOTHROWS
+{
+    return current;
+}
+std::shared_ptr<PerformanceCounters> TAK::Engine::Util::PerformanceCounters_setCurrent(const std::shared_ptr<PerformanceCounters> &counters) NOTHROWS
+{
+    std::shared_ptr<PerformanceCounters> previous(std::move(current));
+    current = counters;
+    return previous;
+}
+const char *TAK::Engine::Util::PerformanceCounter_getName(const PerformanceCounter counter) NOTHROWS
+{
+    return isValid(counter) ? CounterNames[counter] : nullptr;
+}
@@ -0,0 +1,108 @@
+#ifndef TAK_ENGINE_UTIL_PERFORMANCECOUNTERS_H_INCLUDED
+#define TAK_ENGINE_UTIL_PERFORMANCECOUNTERS_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Counters of rendering and data activity. Counters are never
+             * reset; per-interval values are obtained by differencing two
+             * snapshots.
+             */
+            enum PerformanceCounter
+            {
+                /** GL draw calls submitted */
+                TEPC_DrawCalls,
+                /** Triangles submitted, including instances */
+                TEPC_Triangles,
+                /** Bytes uploaded to GL textures */
+                TEPC_TextureUploadBytes,
+                /** Asynchronous tile read requests issued */
+                TEPC_TileRequestsIssued,
+                /** Asynchronous tile read requests completed successfully */
+                TEPC_TileRequestsCompleted,
+                /** Labels placed for rendering */
+                TEPC_LabelsPlaced,
+            };
+
+            /**
+             * Point-in-time copy of the engine performance counters.
+             */
+            struct ENGINE_API PerformanceCountersSnapshot
+            {
+                enum {
+                    NumCounters = TEPC_LabelsPlaced + 1,
+                };
+
+                PerformanceCountersSnapshot() NOTHROWS;
+
+                uint64_t counters[NumCounters];
+            };
+
+            /**
+             * A set of monotonic performance counters, typically owned by a
+             * renderer so that activity is attributed to the view that
+             * incurred it. Counters may be incremented from any thread.
+             */
+            class ENGINE_API PerformanceCounters
+            {
+            public :
+                PerformanceCounters() NOTHROWS;
+            public :
+                void add(const PerformanceCounter counter, const std::size_t count) NOTHROWS;
+                TAKErr getSnapshot(PerformanceCountersSnapshot *value) const NOTHROWS;
+            private :
+                PerformanceCounters(const PerformanceCounters &) = delete;
+                PerformanceCounters &operator=(const PerformanceCounters &) = delete;
+            private :
+                std::atomic<uint64_t> counters[PerformanceCountersSnapshot::NumCounters];
+            };
+
+            /**
+             * Increments the specified counter of the counters bound to the
+             * current thread. No-op if no counters are bound.
+             */
+            ENGINE_API void PerformanceCounters_add(const PerformanceCounter counter, const std::size_t count) NOTHROWS;
+            /** Returns the counters bound to the current thread, if any. */
+            ENGINE_API std::shared_ptr<PerformanceCounters> PerformanceCounters_getCurrent() NOTHROWS;
+            /**
+             * Binds the counters for the current thread.
+             *
+             * @return  The previously bound counters
+             */
+            ENGINE_API std::shared_ptr<PerformanceCounters> PerformanceCounters_setCurrent(const std::shared_ptr<PerformanceCounters> &counters) NOTHROWS;
+            ENGINE_API const char *PerformanceCounter_getName(const PerformanceCounter counter) NOTHROWS;
+
+            /**
+             * Binds the current thread's counters for the lifetime of the
+             * instance, restoring the previous binding on destruction.
+             */
+            class PerformanceCountersScope
+            {
+            public :
+                PerformanceCountersScope(const std::shared_ptr<PerformanceCounters> &counters) NOTHROWS :
+                    previous(PerformanceCounters_setCurrent(counters))
+                {}
+                ~PerformanceCountersScope() NOTHROWS
+                {
+                    PerformanceCounters_setCurrent(previous);
+                }
+            private :
+                PerformanceCountersScope(const PerformanceCountersScope &) = delete;
+                PerformanceCountersScope &operator=(const PerformanceCountersScope &) = delete;
+            private :
+                std::shared_ptr<PerformanceCounters> previous;
+            };
+        }
+    }
+}
+
+#endif
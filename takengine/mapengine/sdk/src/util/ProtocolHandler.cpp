@@ -33,6 +33,11 @@ namespace {
 ProtocolHandler::~ProtocolHandler() NOTHROWS
 {}
 
+TAKErr ProtocolHandler::handleURIRange(DataInput2Ptr &ctx, const char *uri, const int64_t offset, const std::size_t length) NOTHROWS
+{
+    return TE_Unsupported;
+}
+
 TAKErr TAK::Engine::Util::ProtocolHandler_registerHandler(const char *scheme, ProtocolHandler &handler) NOTHROWS
 {
     if (!scheme)
@@ -20,6 +20,12 @@ namespace TAK
                 // Return NULL if not able to handle, else return pointer to 
                 // binding-level-specific IO context.
                 virtual Util::TAKErr handleURI(Util::DataInput2Ptr &ctx, const char * uri) NOTHROWS = 0;
+                /**
+                 * Opens <code>length</code> bytes of the resource, starting
+                 * at <code>offset</code>. The default implementation returns
+                 * <code>TE_Unsupported</code>.
+                 */
+                virtual Util::TAKErr handleURIRange(Util::DataInput2Ptr &ctx, const char *uri, const int64_t offset, const std::size_t length) NOTHROWS;
             };
 
             class ENGINE_API FileProtocolHandler : public ProtocolHandler
@@ -0,0 +1,111 @@
+#include "util/ScratchArena.h"
+
+#include <algorithm>
+
+using namespace TAK::Engine::Util;
+
+ScratchArena::ScratchArena(const std::size_t blockSize_, const std::size_t retainLimit_) NOTHROWS :
+    current(0u),
+    offset(0u),
+    blockSize(blockSize_ ? blockSize_ : 1u),
+    retainLimit(retainLimit_),
+    depth(0u)
+{}
+ScratchArena::~ScratchArena() NOTHROWS
+{}
+void *ScratchArena::allocate(const std::size_t size, const std::size_t align) NOTHROWS
+{
+    // try the current block, then any retained blocks following it
+    while (current < blocks.size()) {
+        Block &block = blocks[current];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        const uintptr_t aligned = (base + offset + (align - 1u)) & ~static_cast<uintptr_t>(align - 1u);
+        const std::size_t start = static_cast<std::size_t>(aligned - base);
+        if (start <= block.size && (block.size - start) >= size) {
+            offset = start + size;
+            return block.data.get() + start;
+        }
+        if (current + 1u == blocks.size())
+            break;
+        current++;
+        offset = 0u;
+    }
+
+    // allocate a new block, oversized for large requests
+    Block block;
+    block.size = std::max(blockSize, size + align);
+    block.data.reset(new(std::nothrow) uint8_t[block.size]);
+    if (!block.data)
+        return nullptr;
+
+    const std::size_t index = blocks.empty() ? 0u : current + 1u;
+    try {
+        blocks.insert(blocks.begin() + index, std::move(block));
+    } catch (...) {
+        return nullptr;
+    }
+    current = index;
+    offset = 0u;
+
+    Block &inserted = blocks[current];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(inserted.data.get());
+    const uintptr_t aligned = (base + (align - 1u)) & ~static_cast<uintptr_t>(align - 1u);
+    offset = static_cast<std::size_t>(aligned - base) + size;
+    return inserted.data.get() + (aligned - base);
+}
+ScratchArena::Mark ScratchArena::mark() const NOTHROWS
+{
+    Mark m;
+    m.block = current;
+    m.offset = offset;
+    return m;
+}
+void ScratchArena::reset(const Mark &m) NOTHROWS
+{
+    current = m.block;
+    offset = m.offset;
+}
+std::size_t ScratchArena::capacity() const NOTHROWS
+{
+    std::size_t retval = 0u;
+    for (const auto &block : blocks)
+        retval += block.size;
+    return retval;
+}
+void ScratchArena::trim() NOTHROWS
+{
+    // release the most recently added blocks first; earliest blocks are the
+    // steady state working set. the first block is always retained.
+    std::size_t retained = blocks[0u].size;
+    std::size_t count = 1u;
+    while (count < blocks.size() && (retained + blocks[count].size) <= retainLimit) {
+        retained += blocks[count].size;
+        count++;
+    }
+    blocks.erase(blocks.begin() + count, blocks.end());
+    current = 0u;
+    offset = 0u;
+}
+
+ScratchArenaScope::ScratchArenaScope() NOTHROWS :
+    ScratchArenaScope(ScratchArena_current())
+{}
+ScratchArenaScope::ScratchArenaScope(ScratchArena &arena_) NOTHROWS :
+    arena(arena_),
+    scopeMark(arena_.mark())
+{
+    arena.depth++;
+}
+ScratchArenaScope::~ScratchArenaScope() NOTHROWS
+{
+    arena.reset(scopeMark);
+    arena.depth--;
+    if (!arena.depth && arena.capacity() > arena.retainLimit)
+        arena.trim();
+}
+
+ScratchArena &TAK::Engine::Util::ScratchArena_current() NOTHROWS
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
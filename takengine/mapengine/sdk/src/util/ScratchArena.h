@@ -0,0 +1,156 @@
+#ifndef TAK_ENGINE_UTIL_SCRATCHARENA_H_INCLUDED
+#define TAK_ENGINE_UTIL_SCRATCHARENA_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Bump allocator for short-lived, temporary memory. Allocation is
+             * a pointer increment; individual allocations are never freed.
+             * Memory is reclaimed in bulk by resetting to a previously
+             * obtained mark. Blocks are retained across resets so that
+             * repeated use does not touch the heap.
+             *
+             * <P>This class is NOT thread-safe. Use `ScratchArena_current()`
+             * to obtain the arena for the executing thread.
+             */
+            class ENGINE_API ScratchArena
+            {
+            public :
+                struct Mark
+                {
+                    std::size_t block;
+                    std::size_t offset;
+                };
+            public :
+                /**
+                 * @param blockSize     The default size of a block, in bytes
+                 * @param retainLimit   The number of bytes that are retained
+                 *                      once the outermost scope exits
+                 */
+                ScratchArena(const std::size_t blockSize = 64u*1024u, const std::size_t retainLimit = 1024u*1024u) NOTHROWS;
+                ~ScratchArena() NOTHROWS;
+            private :
+                ScratchArena(const ScratchArena &) NOTHROWS;
+            public :
+                /**
+                 * Allocates memory from the arena.
+                 *
+                 * @param size  The size, in bytes
+                 * @param align The alignment, must be a power of two
+                 *
+                 * @return  The memory or `nullptr` if allocation failed
+                 */
+                void *allocate(const std::size_t size, const std::size_t align = alignof(std::max_align_t)) NOTHROWS;
+                /**
+                 * Returns a mark that all subsequent allocations may be
+                 * released back to via `reset`.
+                 */
+                Mark mark() const NOTHROWS;
+                /**
+                 * Releases all allocations made since `mark` was obtained.
+                 */
+                void reset(const Mark &mark) NOTHROWS;
+                /**
+                 * Returns the number of bytes currently held by the arena.
+                 */
+                std::size_t capacity() const NOTHROWS;
+            private :
+                void trim() NOTHROWS;
+            private :
+                struct Block
+                {
+                    std::unique_ptr<uint8_t[]> data;
+                    std::size_t size;
+                };
+                std::vector<Block> blocks;
+                std::size_t current;
+                std::size_t offset;
+                std::size_t blockSize;
+                std::size_t retainLimit;
+                std::size_t depth;
+
+                friend class ScratchArenaScope;
+            };
+
+            /**
+             * Marks the arena on construction and resets it on destruction.
+             * Scopes nest; the outermost scope trims the arena back to its
+             * retain limit on exit.
+             */
+            class ENGINE_API ScratchArenaScope
+            {
+            public :
+                ScratchArenaScope() NOTHROWS;
+                ScratchArenaScope(ScratchArena &arena) NOTHROWS;
+                ~ScratchArenaScope() NOTHROWS;
+            private :
+                ScratchArenaScope(const ScratchArenaScope &) NOTHROWS;
+            public :
+                ScratchArena &arena;
+            private :
+                ScratchArena::Mark scopeMark;
+            };
+
+            /**
+             * STL allocator backed by a `ScratchArena`. `deallocate` is a
+             * no-op; memory is reclaimed when the enclosing
+             * `ScratchArenaScope` exits. Containers must not outlive the
+             * scope that was active when they allocated.
+             *
+             * example:
+             *    ScratchArenaScope scratch;
+             *    std::vector<int, ScratchAllocator<int>> v{ScratchAllocator<int>(scratch.arena)};
+             */
+            template<class T>
+            class ScratchAllocator
+            {
+            public :
+                typedef T value_type;
+                template<class U>
+                struct rebind { typedef ScratchAllocator<U> other; };
+            public :
+                ScratchAllocator(ScratchArena &arena_) NOTHROWS : arena(&arena_) {}
+                template<class U>
+                ScratchAllocator(const ScratchAllocator<U> &other) NOTHROWS : arena(other.arena) {}
+            public :
+                T *allocate(const std::size_t n)
+                {
+                    void *mem = arena->allocate(n * sizeof(T), alignof(T));
+                    if (!mem)
+                        throw std::bad_alloc();
+                    return static_cast<T *>(mem);
+                }
+                void deallocate(T *, const std::size_t) NOTHROWS
+                {}
+                template<class U>
+                bool operator==(const ScratchAllocator<U> &other) const NOTHROWS { return arena == other.arena; }
+                template<class U>
+                bool operator!=(const ScratchAllocator<U> &other) const NOTHROWS { return arena != other.arena; }
+            private :
+                ScratchArena *arena;
+
+                template<class U>
+                friend class ScratchAllocator;
+            };
+
+            /**
+             * Returns the scratch arena for the executing thread. Workers
+             * backed by multiple threads share a worker ID, so the arena is
+             * owned by the thread rather than worker local storage.
+             */
+            ENGINE_API ScratchArena &ScratchArena_current() NOTHROWS;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,331 @@
+#include "util/SlabAllocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "util/AllocationTagging.h"
+#include "util/BlockPoolAllocator.h"
+
+using namespace TAK::Engine::Util;
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TE_SLAB_CALLER() _ReturnAddress()
+#else
+#define TE_SLAB_CALLER() __builtin_return_address(0)
+#endif
+
+namespace
+{
+    enum {
+        NumSizeClasses = SlabAllocatorStatistics::NumSizeClasses,
+        /** the maximum number of blocks cached per class per thread */
+        MagazineSize = 32,
+        /** local statistic updates accumulated before publishing */
+        StatisticsFlushInterval = 64,
+    };
+
+    /** denotes a block serviced directly by the heap */
+    const uint32_t LargeSizeClass = 0xFFFFFFFFu;
+
+    /** nominal size of the block pool backing a single size class */
+    const std::size_t PoolSize = 256u * 1024u;
+    const std::size_t MinBlocksPerPool = 64u;
+
+    const std::size_t SizeClasses[NumSizeClasses] =
+    {
+        16u, 32u, 48u, 64u, 80u, 96u, 112u, 128u,
+        160u, 192u, 224u, 256u,
+        320u, 384u, 448u, 512u,
+        640u, 768u, 896u, 1024u,
+    };
+    const std::size_t MaxSlabSize = 1024u;
+
+    /**
+     * Prefixes every allocation. The header records how the block is
+     * returned to the pool it was obtained from so that deallocation does
+     * not need to know the size of the allocation.
+     */
+    struct BlockHeader
+    {
+        union {
+            /** pool deleter for slab blocks */
+            void(*deleter)(const void *);
+            /** requested size for blocks serviced by the heap */
+            std::size_t size;
+        };
+        uint32_t sizeClass;
+        /** allocation tag charged, or `-1` */
+        int32_t tag;
+    };
+
+    const std::size_t HeaderSize = ((sizeof(BlockHeader) + alignof(std::max_align_t) - 1u) / alignof(std::max_align_t)) * alignof(std::max_align_t);
+
+    struct ClassCounters
+    {
+        std::atomic<uint64_t> allocations {0u};
+        std::atomic<uint64_t> deallocations {0u};
+        std::atomic<uint64_t> cacheHits {0u};
+        std::atomic<uint64_t> poolAllocations {0u};
+        std::atomic<uint64_t> heapAllocations {0u};
+    };
+
+    struct GlobalState
+    {
+        std::atomic<BlockPoolAllocator *> pools[NumSizeClasses];
+        ClassCounters counters[NumSizeClasses];
+        std::atomic<uint64_t> largeAllocations {0u};
+        std::atomic<uint64_t> largeDeallocations {0u};
+        /** maps `(size+15)/16` to the size class */
+        uint8_t classIndex[MaxSlabSize/16u + 1u];
+
+        GlobalState() NOTHROWS
+        {
+            std::size_t c = 0u;
+            for (std::size_t i = 0u; i <= MaxSlabSize / 16u; i++) {
+                while (SizeClasses[c] < i * 16u)
+                    c++;
+                classIndex[i] = (uint8_t)c;
+            }
+            for (std::size_t i = 0u; i < NumSizeClasses; i++)
+                pools[i].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    GlobalState &state() NOTHROWS
+    {
+        // intentionally leaked; blocks may be released after static
+        // destruction
+        static GlobalState *s = new GlobalState();
+        return *s;
+    }
+
+    BlockPoolAllocator *pool(const std::size_t sizeClass) NOTHROWS
+    {
+        GlobalState &s = state();
+        BlockPoolAllocator *p = s.pools[sizeClass].load(std::memory_order_acquire);
+        if (p)
+            return p;
+
+        const std::size_t blockSize = HeaderSize + SizeClasses[sizeClass];
+        std::size_t numBlocks = PoolSize / blockSize;
+        if (numBlocks < MinBlocksPerPool)
+            numBlocks = MinBlocksPerPool;
+        std::unique_ptr<BlockPoolAllocator> created(new(std::nothrow) BlockPoolAllocator(blockSize, numBlocks));
+        if (!created)
+            return nullptr;
+        BlockPoolAllocator *expected = nullptr;
+        if (s.pools[sizeClass].compare_exchange_strong(expected, created.get(), std::memory_order_acq_rel))
+            return created.release();
+        // lost the race, use the installed pool
+        return expected;
+    }
+
+    void releaseBlock(BlockHeader *header) NOTHROWS
+    {
+        header->deleter(header);
+    }
+
+    /**
+     * Per-thread cache of free blocks for each size class. Blocks may be
+     * returned to any thread's magazine; on overflow, half of the cached
+     * blocks are returned to the shared pool.
+     */
+    struct Magazine
+    {
+        struct LocalCounters
+        {
+            uint32_t allocations {0u};
+            uint32_t deallocations {0u};
+            uint32_t cacheHits {0u};
+        };
+
+        BlockHeader *blocks[NumSizeClasses][MagazineSize];
+        std::size_t count[NumSizeClasses];
+        LocalCounters counters[NumSizeClasses];
+
+        Magazine() NOTHROWS
+        {
+            memset(count, 0, sizeof(count));
+        }
+
+        void flushStatistics(const std::size_t sizeClass) NOTHROWS
+        {
+            ClassCounters &global = state().counters[sizeClass];
+            LocalCounters &local = counters[sizeClass];
+            global.allocations.fetch_add(local.allocations, std::memory_order_relaxed);
+            global.deallocations.fetch_add(local.deallocations, std::memory_order_relaxed);
+            global.cacheHits.fetch_add(local.cacheHits, std::memory_order_relaxed);
+            local = LocalCounters();
+        }
+        void recordAllocation(const std::size_t sizeClass, const bool hit) NOTHROWS
+        {
+            LocalCounters &local = counters[sizeClass];
+            if (hit)
+                local.cacheHits++;
+            if (++local.allocations >= StatisticsFlushInterval)
+                flushStatistics(sizeClass);
+        }
+        void recordDeallocation(const std::size_t sizeClass) NOTHROWS
+        {
+            if (++counters[sizeClass].deallocations >= StatisticsFlushInterval)
+                flushStatistics(sizeClass);
+        }
+    };
+
+    class ThreadMagazine
+    {
+    public :
+        ThreadMagazine() NOTHROWS
+        {
+            destroyed() = false;
+        }
+        ~ThreadMagazine() NOTHROWS
+        {
+            for (std::size_t i = 0u; i < NumSizeClasses; i++) {
+                for (std::size_t j = 0u; j < magazine.count[i]; j++)
+                    releaseBlock(magazine.blocks[i][j]);
+                magazine.count[i] = 0u;
+                magazine.flushStatistics(i);
+            }
+            destroyed() = true;
+        }
+    public :
+        static bool &destroyed() NOTHROWS
+        {
+            // trivially destructible; remains valid after the magazine is
+            // destructed during thread exit
+            thread_local bool d = false;
+            return d;
+        }
+    public :
+        Magazine magazine;
+    };
+
+    Magazine *threadMagazine() NOTHROWS
+    {
+        if (ThreadMagazine::destroyed())
+            return nullptr;
+        thread_local ThreadMagazine tm;
+        return &tm.magazine;
+    }
+
+    BlockHeader *allocateBlock(const std::size_t sizeClass) NOTHROWS
+    {
+        BlockPoolAllocator *p = pool(sizeClass);
+        if (!p)
+            return nullptr;
+
+        ClassCounters &counters = state().counters[sizeClass];
+        std::unique_ptr<void, void(*)(const void *)> block(nullptr, nullptr);
+        if (p->allocate(block, false) == TE_Ok) {
+            counters.poolAllocations.fetch_add(1u, std::memory_order_relaxed);
+        } else if (p->allocate(block, true) == TE_Ok) {
+            counters.heapAllocations.fetch_add(1u, std::memory_order_relaxed);
+        } else {
+            return nullptr;
+        }
+
+        BlockHeader *header = static_cast<BlockHeader *>(block.get());
+        header->deleter = block.get_deleter();
+        header->sizeClass = (uint32_t)sizeClass;
+        block.release();
+        return header;
+    }
+}
+
+SlabAllocatorStatistics::SlabAllocatorStatistics() NOTHROWS :
+    largeAllocations(0u),
+    largeDeallocations(0u)
+{
+    memset(sizeClasses, 0, sizeof(sizeClasses));
+    for (std::size_t i = 0u; i < NumSizeClasses; i++)
+        sizeClasses[i].blockSize = SizeClasses[i];
+}
+
+void *TAK::Engine::Util::SlabAllocator_allocate(const std::size_t size) NOTHROWS
+{
+    GlobalState &s = state();
+    if (size > MaxSlabSize) {
+        void *mem = malloc(HeaderSize + size);
+        if (!mem)
+            return nullptr;
+        BlockHeader *header = static_cast<BlockHeader *>(mem);
+        header->size = size;
+        header->sizeClass = LargeSizeClass;
+        header->tag = AllocationTagging_isEnabled() ? AllocationTagging_recordAllocation(size, TE_SLAB_CALLER()) : -1;
+        s.largeAllocations.fetch_add(1u, std::memory_order_relaxed);
+        return static_cast<uint8_t *>(mem) + HeaderSize;
+    }
+
+    const std::size_t sizeClass = s.classIndex[(size + 15u) / 16u];
+    Magazine *magazine = threadMagazine();
+    BlockHeader *header;
+    if (magazine && magazine->count[sizeClass]) {
+        header = magazine->blocks[sizeClass][--magazine->count[sizeClass]];
+        magazine->recordAllocation(sizeClass, true);
+    } else {
+        header = allocateBlock(sizeClass);
+        if (!header)
+            return nullptr;
+        if (magazine)
+            magazine->recordAllocation(sizeClass, false);
+        else
+            s.counters[sizeClass].allocations.fetch_add(1u, std::memory_order_relaxed);
+    }
+    // charged at the size class granularity, matching the release
+    header->tag = AllocationTagging_isEnabled() ? AllocationTagging_recordAllocation(SizeClasses[sizeClass], TE_SLAB_CALLER()) : -1;
+    return reinterpret_cast<uint8_t *>(header) + HeaderSize;
+}
+void TAK::Engine::Util::SlabAllocator_deallocate(void *ptr) NOTHROWS
+{
+    if (!ptr)
+        return;
+    BlockHeader *header = reinterpret_cast<BlockHeader *>(static_cast<uint8_t *>(ptr) - HeaderSize);
+    GlobalState &s = state();
+    if (header->sizeClass == LargeSizeClass) {
+        AllocationTagging_recordRelease(header->tag, header->size);
+        s.largeDeallocations.fetch_add(1u, std::memory_order_relaxed);
+        free(header);
+        return;
+    }
+
+    const std::size_t sizeClass = header->sizeClass;
+    AllocationTagging_recordRelease(header->tag, SizeClasses[sizeClass]);
+    Magazine *magazine = threadMagazine();
+    if (!magazine) {
+        s.counters[sizeClass].deallocations.fetch_add(1u, std::memory_order_relaxed);
+        releaseBlock(header);
+        return;
+    }
+    if (magazine->count[sizeClass] == MagazineSize) {
+        // return the older half of the cache to the shared pool
+        const std::size_t retain = MagazineSize / 2u;
+        for (std::size_t i = 0u; i < MagazineSize - retain; i++)
+            releaseBlock(magazine->blocks[sizeClass][i]);
+        memmove(magazine->blocks[sizeClass], magazine->blocks[sizeClass] + (MagazineSize - retain), retain * sizeof(BlockHeader *));
+        magazine->count[sizeClass] = retain;
+    }
+    magazine->blocks[sizeClass][magazine->count[sizeClass]++] = header;
+    magazine->recordDeallocation(sizeClass);
+}
+TAKErr TAK::Engine::Util::SlabAllocator_getStatistics(SlabAllocatorStatistics *value) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    GlobalState &s = state();
+    for (std::size_t i = 0u; i < NumSizeClasses; i++) {
+        SlabAllocatorStatistics::SizeClass &sc = value->sizeClasses[i];
+        sc.blockSize = SizeClasses[i];
+        sc.allocations = s.counters[i].allocations.load(std::memory_order_relaxed);
+        sc.deallocations = s.counters[i].deallocations.load(std::memory_order_relaxed);
+        sc.cacheHits = s.counters[i].cacheHits.load(std::memory_order_relaxed);
+        sc.poolAllocations = s.counters[i].poolAllocations.load(std::memory_order_relaxed);
+        sc.heapAllocations = s.counters[i].heapAllocations.load(std::memory_order_relaxed);
+    }
+    value->largeAllocations = s.largeAllocations.load(std::memory_order_relaxed);
+    value->largeDeallocations = s.largeDeallocations.load(std::memory_order_relaxed);
+    return TE_Ok;
+}
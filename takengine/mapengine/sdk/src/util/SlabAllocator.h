@@ -0,0 +1,103 @@
+#ifndef TAK_ENGINE_UTIL_SLABALLOCATOR_H_INCLUDED
+#define TAK_ENGINE_UTIL_SLABALLOCATOR_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "port/Platform.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Allocation statistics for the slab allocator. Counts recorded
+             * against per-thread caches are aggregated periodically and
+             * may lag the actual allocation activity.
+             */
+            struct ENGINE_API SlabAllocatorStatistics
+            {
+                enum {
+                    NumSizeClasses = 20,
+                };
+
+                struct SizeClass
+                {
+                    /** The maximum allocation size serviced by the class, in bytes */
+                    std::size_t blockSize;
+                    uint64_t allocations;
+                    uint64_t deallocations;
+                    /** Allocations serviced by the per-thread cache */
+                    uint64_t cacheHits;
+                    /** Allocations serviced by the class's block pool */
+                    uint64_t poolAllocations;
+                    /** Allocations serviced by the heap due to pool exhaustion */
+                    uint64_t heapAllocations;
+                };
+
+                SlabAllocatorStatistics() NOTHROWS;
+
+                SizeClass sizeClasses[NumSizeClasses];
+                /** Allocations exceeding the largest size class */
+                uint64_t largeAllocations;
+                uint64_t largeDeallocations;
+            };
+
+            /**
+             * Allocates memory from the process-wide slab allocator.
+             * Requests are rounded up to one of a fixed set of size
+             * classes, each backed by a `BlockPoolAllocator`. Freed blocks
+             * are retained in a per-thread cache (magazine) and recycled
+             * without touching the shared pool. Requests larger than the
+             * largest size class are serviced by the heap.
+             *
+             * <P>Memory is aligned to `alignof(std::max_align_t)`.
+             *
+             * @return  The memory or `nullptr` if allocation failed
+             */
+            ENGINE_API void *SlabAllocator_allocate(const std::size_t size) NOTHROWS;
+            /**
+             * Releases memory obtained from `SlabAllocator_allocate`. May
+             * be invoked from any thread.
+             */
+            ENGINE_API void SlabAllocator_deallocate(void *ptr) NOTHROWS;
+            ENGINE_API TAKErr SlabAllocator_getStatistics(SlabAllocatorStatistics *value) NOTHROWS;
+        }
+    }
+}
+
+/**
+ * Declares class scoped `operator new` and `operator delete` that route
+ * allocation of instances through the slab allocator. Intended for small
+ * types that are allocated and released at high rates.
+ */
+#define TE_SLAB_ALLOCATED() \
+    public : \
+        static void *operator new(std::size_t size) \
+        { \
+            void *mem = TAK::Engine::Util::SlabAllocator_allocate(size); \
+            if (!mem) \
+                throw std::bad_alloc(); \
+            return mem; \
+        } \
+        static void *operator new(std::size_t size, const std::nothrow_t &) NOTHROWS \
+        { \
+            return TAK::Engine::Util::SlabAllocator_allocate(size); \
+        } \
+        static void *operator new(std::size_t, void *where) NOTHROWS \
+        { \
+            return where; \
+        } \
+        static void operator delete(void *ptr) NOTHROWS \
+        { \
+            TAK::Engine::Util::SlabAllocator_deallocate(ptr); \
+        } \
+        static void operator delete(void *ptr, const std::nothrow_t &) NOTHROWS \
+        { \
+            TAK::Engine::Util::SlabAllocator_deallocate(ptr); \
+        } \
+        static void operator delete(void *, void *) NOTHROWS \
+        {}
+
+#endif
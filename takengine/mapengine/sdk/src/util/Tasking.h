@@ -2,6 +2,9 @@
 #ifndef TAK_ENGINE_UTIL_TASKING_H_INCLUDED
 #define TAK_ENGINE_UTIL_TASKING_H_INCLUDED
 
+#include <atomic>
+#include <vector>
+
 #include "util/Work.h"
 
 namespace TAK {
@@ -13,12 +16,28 @@ namespace TAK {
 			template <typename T> class AsyncResult;
 			template <typename T> class AsyncPromise;
 			template <typename T> class WeakFuture;
+
+			namespace Tasking {
+				struct FutureAccess;
+			}
 			
 			template <typename Func>
 			struct TaskResultOf;
 
 			class VoidTaskResult {};
 
+			/**
+			 * The result of Task_whenAny; the value produced by the first input to complete
+			 * successfully and that input's index
+			 */
+			template <typename T>
+			struct TaskAnyResult {
+				TaskAnyResult() NOTHROWS;
+
+				std::size_t index;
+				T value;
+			};
+
 			template <typename R, typename ...Args>
 			struct TaskResultOf<TAKErr(*)(R &, Args...)> {
 				typedef R Type;
@@ -100,6 +119,7 @@ namespace TAK {
 			protected:
 				std::shared_ptr<AsyncResult<T>> impl;
 				friend class WeakFuture<T>;
+				friend struct Tasking::FutureAccess;
 			};
 
 			/**
@@ -182,6 +202,37 @@ namespace TAK {
 			template <typename Func, typename ...Args>
 			inline FutureTask<TaskResultOfT<Func>>
 				Task_begin(const SharedWorkerPtr &worker, Func func, Args &&...args) NOTHROWS;
+
+			/**
+			 * Combine futures into a future that is ready once all of the inputs are ready. No
+			 * thread waits on the inputs; the result is produced on whichever thread completes
+			 * the last input. If any input fails (or is canceled), the result fails with that
+			 * input's error as soon as it is observed.
+			 *
+			 * Continue on a specific worker with thenOn:
+			 *
+			 *    Task_whenAll(futures).thenOn(GeneralWorkers_cpu(), merge);
+			 *
+			 * @param futures the inputs
+			 *
+			 * @return a Future of the input values, in input order
+			 */
+			template <typename T>
+			inline Future<std::vector<T>>
+				Task_whenAll(const std::vector<Future<T>> &futures) NOTHROWS;
+
+			/**
+			 * Combine futures into a future that is ready once any of the inputs completes
+			 * successfully. If all inputs fail, the result fails with the error of the last
+			 * input to fail. Inputs that have not completed are not canceled.
+			 *
+			 * @param futures the inputs
+			 *
+			 * @return a Future of the first value produced and the index of its input
+			 */
+			template <typename T>
+			inline Future<TaskAnyResult<T>>
+				Task_whenAny(const std::vector<Future<T>> &futures) NOTHROWS;
 		}
 	}
 }
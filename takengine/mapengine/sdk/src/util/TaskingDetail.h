@@ -284,7 +284,9 @@ namespace TAK {
 				struct Capture<Func, C0, C1, C2, C3, C4> {
 					CAP_ST();
 					CAP_IT(0); CAP_IT(1); CAP_IT(2); CAP_IT(3); CAP_IT(4);
-					Capture(Func func, C0 c0, C1 c1, C2 c2, C3 c3, C4 c4) : func(func), c0(c0), c1(c1), c2(c2), c3(c3), c4(c4) { }
+					template <typename C0F, typename C1F, typename C2F, typename C3F, typename C4F>
+					Capture(Func func, C0F&& c0, C1F&& c1, C2F&& c2, C3F&& c3, C4F&& c4) : func(func), c0(std::forward<C0F>(c0)), c1(std::forward<C1F>(c1)), c2(std::forward<C2F>(c2)),
+					c3(std::forward<C3F>(c3)), c4(std::forward<C4F>(c4)) { }
 					TAKErr invoke(ResultType& r) NOTHROWS {
 						CAP_ID(0); CAP_ID(1); CAP_ID(2); CAP_ID(3); CAP_ID(4);
 						return func(r, a0, a1, a2, a3, a4);
@@ -296,7 +298,9 @@ namespace TAK {
 				struct Capture<Func, C0, C1, C2, C3, C4, C5> {
 					CAP_ST();
 					CAP_IT(0); CAP_IT(1); CAP_IT(2); CAP_IT(3); CAP_IT(4); CAP_IT(5);
-					Capture(Func func, C0 c0, C1 c1, C2 c2, C3 c3, C4 c4, C5 c5) : func(func), c0(c0), c1(c1), c2(c2), c3(c3), c4(c4), c5(c5) { }
+					template <typename C0F, typename C1F, typename C2F, typename C3F, typename C4F, typename C5F>
+					Capture(Func func, C0F&& c0, C1F&& c1, C2F&& c2, C3F&& c3, C4F&& c4, C5F&& c5) : func(func), c0(std::forward<C0F>(c0)), c1(std::forward<C1F>(c1)), c2(std::forward<C2F>(c2)),
+					c3(std::forward<C3F>(c3)), c4(std::forward<C4F>(c4)), c5(std::forward<C5F>(c5)) { }
 					TAKErr invoke(ResultType& r) NOTHROWS {
 						CAP_ID(0); CAP_ID(1); CAP_ID(2); CAP_ID(3); CAP_ID(4); CAP_ID(5);
 						return func(r, a0, a1, a2, a3, a4, a5);
@@ -424,6 +428,179 @@ namespace TAK {
 				}
 			};
 
+			namespace Tasking {
+				/**
+				 * Grants the combinators access to the result underlying a Future
+				 */
+				struct FutureAccess {
+					template <typename T>
+					static std::shared_ptr<AsyncResult<T>> impl(const Future<T> &future) NOTHROWS {
+						return future.impl;
+					}
+				};
+
+				/**
+				 * Result of Task_whenAll. Never scheduled; completed by its arrivals.
+				 */
+				template <typename T>
+				class AsyncAll : public AsyncResult<std::vector<T>> {
+				public:
+					explicit AsyncAll(const std::size_t count) NOTHROWS
+						: remaining(count)
+					{
+						values.reserve(count);
+						for (std::size_t i = 0u; i < count; ++i)
+							values.push_back(Defaulter<T>::value());
+					}
+
+					virtual ~AsyncAll() NOTHROWS {}
+
+					void arrive(const std::size_t index, const TAKErr err, T &value) NOTHROWS {
+						if (err != TE_Ok) {
+							complete(err);
+							return;
+						}
+
+						// each arrival owns its slot; the last to arrive publishes
+						Transfer<T>::invoke(values[index], value);
+						if (remaining.fetch_sub(1u) != 1u)
+							return;
+
+						Thread::MonitorLockPtr lockPtr(nullptr, nullptr);
+						if (this->beginWorking(lockPtr) != TE_Ok)
+							return;
+						AsyncResult<std::vector<T>>::setValue(lockPtr, std::move(values));
+						this->finishWorking(lockPtr, TE_Ok);
+					}
+
+					void complete(const TAKErr err) NOTHROWS {
+						Thread::MonitorLockPtr lockPtr(nullptr, nullptr);
+						if (this->beginWorking(lockPtr) == TE_Ok)
+							this->finishWorking(lockPtr, err);
+					}
+
+				protected:
+					virtual TAKErr onSignalWork(Thread::MonitorLockPtr &lockPtr) NOTHROWS {
+						return TE_IllegalState;
+					}
+
+				private:
+					std::vector<T> values;
+					std::atomic<std::size_t> remaining;
+				};
+
+				/**
+				 * Result of Task_whenAny. Never scheduled; completed by its arrivals.
+				 */
+				template <typename T>
+				class AsyncAny : public AsyncResult<TaskAnyResult<T>> {
+				public:
+					explicit AsyncAny(const std::size_t count) NOTHROWS
+						: remaining(count)
+					{ }
+
+					virtual ~AsyncAny() NOTHROWS {}
+
+					void arrive(const std::size_t index, const TAKErr err, T &value) NOTHROWS {
+						if (err != TE_Ok) {
+							if (remaining.fetch_sub(1u) == 1u)
+								complete(err);
+							return;
+						}
+
+						Thread::MonitorLockPtr lockPtr(nullptr, nullptr);
+						if (this->beginWorking(lockPtr) != TE_Ok)
+							return;
+						TaskAnyResult<T> result;
+						result.index = index;
+						Transfer<T>::invoke(result.value, value);
+						AsyncResult<TaskAnyResult<T>>::setValue(lockPtr, std::move(result));
+						this->finishWorking(lockPtr, TE_Ok);
+					}
+
+					void complete(const TAKErr err) NOTHROWS {
+						Thread::MonitorLockPtr lockPtr(nullptr, nullptr);
+						if (this->beginWorking(lockPtr) == TE_Ok)
+							this->finishWorking(lockPtr, err);
+					}
+
+				protected:
+					virtual TAKErr onSignalWork(Thread::MonitorLockPtr &lockPtr) NOTHROWS {
+						return TE_IllegalState;
+					}
+
+				private:
+					std::atomic<std::size_t> remaining;
+				};
+
+				/**
+				 * Attached to a combinator input; forwards the input's outcome to the
+				 * combinator once the input is done.
+				 */
+				template <typename T, typename Combinator>
+				class Arrival : public Work {
+				public:
+					Arrival(const std::shared_ptr<Combinator> &combinator, const std::shared_ptr<AsyncResult<T>> &input, const std::size_t index) NOTHROWS
+						: combinator(combinator), input(input), index(index)
+					{ }
+
+					virtual ~Arrival() NOTHROWS {}
+
+				protected:
+					virtual TAKErr onSignalWork(Thread::MonitorLockPtr &lockPtr) NOTHROWS {
+						lockPtr.reset();
+
+						// input is done; does not block
+						T value(Defaulter<T>::value());
+						TAKErr err = TE_Err;
+						TAKErr code = input->await(value, err);
+						if (code == TE_Ok)
+							code = err;
+						combinator->arrive(index, code, value);
+						return TE_Ok;
+					}
+
+					virtual TAKErr onDone(Thread::MonitorLockPtr &lockPtr, TAKErr result) NOTHROWS {
+						lockPtr.reset();
+
+						// canceled inputs preempt attached work rather than signal it
+						if (result != TE_Ok) {
+							T value(Defaulter<T>::value());
+							combinator->arrive(index, result, value);
+						}
+						combinator.reset();
+						input.reset();
+						return TE_Ok;
+					}
+
+				private:
+					std::shared_ptr<Combinator> combinator;
+					std::shared_ptr<AsyncResult<T>> input;
+					const std::size_t index;
+				};
+
+				template <typename T, typename Combinator>
+				inline TAKErr attachArrivals(const std::shared_ptr<Combinator> &combinator, const std::vector<Future<T>> &futures) NOTHROWS {
+					for (std::size_t i = 0u; i < futures.size(); ++i) {
+						std::shared_ptr<AsyncResult<T>> input(FutureAccess::impl(futures[i]));
+						if (!input)
+							return TE_IllegalState;
+						input->attachWork(std::make_shared<Arrival<T, Combinator>>(combinator, input, i));
+					}
+					return TE_Ok;
+				}
+			}
+
+			//
+			// TaskAnyResult<T> definition
+			//
+
+			template <typename T>
+			TaskAnyResult<T>::TaskAnyResult() NOTHROWS
+				: index(0u),
+				value(Tasking::Defaulter<T>::value())
+			{ }
+
 			//
 			// AsyncResult<T> definition
 			//
@@ -598,6 +775,34 @@ namespace TAK {
 				worker->scheduleWork(work);
 				return FutureTask<TaskResultOfT<Func>>(work, worker);
 			}
+
+			//
+			// Task_whenAll, Task_whenAny
+			//
+
+			template <typename T>
+			inline Future<std::vector<T>>
+				Task_whenAll(const std::vector<Future<T>> &futures) NOTHROWS {
+
+				auto all = std::make_shared<Tasking::AsyncAll<T>>(futures.size());
+				if (futures.empty())
+					all->complete(TE_Ok);
+				else if (Tasking::attachArrivals<T>(all, futures) != TE_Ok)
+					all->complete(TE_IllegalState);
+				return Future<std::vector<T>>(all);
+			}
+
+			template <typename T>
+			inline Future<TaskAnyResult<T>>
+				Task_whenAny(const std::vector<Future<T>> &futures) NOTHROWS {
+
+				auto any = std::make_shared<Tasking::AsyncAny<T>>(futures.size());
+				if (futures.empty())
+					any->complete(TE_InvalidArg);
+				else if (Tasking::attachArrivals<T>(any, futures) != TE_Ok)
+					any->complete(TE_IllegalState);
+				return Future<TaskAnyResult<T>>(any);
+			}
 		}
 	}
 }
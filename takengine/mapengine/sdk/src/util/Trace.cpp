@@ -0,0 +1,323 @@
+#include "util/Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <new>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <dlfcn.h>
+#endif
+
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Thread;
+
+#define TRACE_BUFFER_CAPACITY 8192u
+
+namespace
+{
+    struct Event
+    {
+        int64_t timestamp;
+        const char *category;
+        const char *name;
+        uint64_t value;
+        char phase;
+    };
+
+    /**
+     * Single producer ring of events. Only the owning thread writes
+     * `events` and advances `head`; readers observe `head` with acquire
+     * semantics and discard any entries that may have been overwritten
+     * while they were being read.
+     */
+    struct ThreadBuffer
+    {
+        std::atomic<uint64_t> head {0u};
+        /** index of the first event retained following Trace_clear */
+        std::atomic<uint64_t> clearMark {0u};
+        std::atomic<bool> live {true};
+        unsigned tid {0u};
+        Event events[TRACE_BUFFER_CAPACITY];
+    };
+
+    struct ThreadSlot
+    {
+        ~ThreadSlot() NOTHROWS
+        {
+            // the buffer is retained for export and may be recycled by
+            // another thread
+            if (buffer)
+                buffer->live.store(false, std::memory_order_release);
+        }
+        ThreadBuffer *buffer {nullptr};
+    };
+
+    struct Registry
+    {
+        Mutex mutex;
+        std::vector<ThreadBuffer *> buffers;
+        unsigned nextTid {1u};
+    };
+
+#ifdef __ANDROID__
+    struct ATrace
+    {
+        ATrace() NOTHROWS
+        {
+            void *libandroid = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+            if (!libandroid)
+                return;
+            beginSection = reinterpret_cast<void(*)(const char *)>(dlsym(libandroid, "ATrace_beginSection"));
+            endSection = reinterpret_cast<void(*)()>(dlsym(libandroid, "ATrace_endSection"));
+            // API 29+
+            setCounter = reinterpret_cast<void(*)(const char *, int64_t)>(dlsym(libandroid, "ATrace_setCounter"));
+            if (!beginSection || !endSection)
+                beginSection = nullptr;
+        }
+
+        void (*beginSection)(const char *) {nullptr};
+        void (*endSection)() {nullptr};
+        void (*setCounter)(const char *, int64_t) {nullptr};
+    };
+
+    const ATrace &atrace() NOTHROWS
+    {
+        static ATrace a;
+        return a;
+    }
+#endif
+
+    Registry &registry() NOTHROWS
+    {
+        // intentionally leaked; events may be recorded from worker threads
+        // after static destruction
+        static Registry *r = new Registry();
+        return *r;
+    }
+
+    ThreadBuffer *threadBuffer() NOTHROWS
+    {
+        thread_local ThreadSlot slot;
+        if (!slot.buffer) {
+            Registry &r = registry();
+            Lock lock(r.mutex);
+            if (lock.status != TE_Ok)
+                return nullptr;
+            // recycle the buffer of an exited thread before allocating
+            for (auto it = r.buffers.begin(); it != r.buffers.end(); it++) {
+                if (!(*it)->live.load(std::memory_order_acquire)) {
+                    slot.buffer = *it;
+                    slot.buffer->head.store(0u, std::memory_order_relaxed);
+                    slot.buffer->clearMark.store(0u, std::memory_order_relaxed);
+                    slot.buffer->live.store(true, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            if (!slot.buffer) {
+                slot.buffer = new(std::nothrow) ThreadBuffer();
+                if (!slot.buffer)
+                    return nullptr;
+                r.buffers.push_back(slot.buffer);
+            }
+            slot.buffer->tid = r.nextTid++;
+        }
+        return slot.buffer;
+    }
+
+    int64_t now() NOTHROWS
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(const char phase, const char *category, const char *name, const uint64_t value) NOTHROWS
+    {
+        ThreadBuffer *buffer = threadBuffer();
+        if (!buffer)
+            return;
+        const uint64_t idx = buffer->head.load(std::memory_order_relaxed);
+        Event &e = buffer->events[idx%TRACE_BUFFER_CAPACITY];
+        e.timestamp = now();
+        e.category = category;
+        e.name = name;
+        e.value = value;
+        e.phase = phase;
+        buffer->head.store(idx+1u, std::memory_order_release);
+    }
+
+    TAKErr writeJsonString(DataOutput2 &sink, const char *s) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = sink.writeByte('"');
+        TE_CHECKRETURN_CODE(code);
+        for (const char *c = s ? s : ""; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                code = sink.writeByte('\\');
+                TE_CHECKRETURN_CODE(code);
+            } else if ((unsigned char)*c < 0x20u) {
+                continue;
+            }
+            code = sink.writeByte((uint8_t)*c);
+            TE_CHECKRETURN_CODE(code);
+        }
+        return sink.writeByte('"');
+    }
+
+    TAKErr writeChromeJsonEvent(DataOutput2 &sink, const Event &e, const unsigned tid, const bool first) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        char buf[192];
+        int len = snprintf(buf, sizeof(buf), "%s{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%lld.%03d,\"cat\":",
+            first ? "" : ",\n", e.phase, tid, (long long)(e.timestamp/1000LL), (int)(e.timestamp%1000LL));
+        code = sink.write(reinterpret_cast<const uint8_t *>(buf), (std::size_t)len);
+        TE_CHECKRETURN_CODE(code);
+        code = writeJsonString(sink, e.category);
+        TE_CHECKRETURN_CODE(code);
+        code = sink.write(reinterpret_cast<const uint8_t *>(",\"name\":"), 8u);
+        TE_CHECKRETURN_CODE(code);
+        code = writeJsonString(sink, e.name);
+        TE_CHECKRETURN_CODE(code);
+        switch (e.phase) {
+        case 'C' :
+            len = snprintf(buf, sizeof(buf), ",\"args\":{\"value\":%lld}}", (long long)(int64_t)e.value);
+            break;
+        case 's' :
+        case 't' :
+            len = snprintf(buf, sizeof(buf), ",\"id\":\"0x%llx\"}", (unsigned long long)e.value);
+            break;
+        case 'f' :
+            // bind to the enclosing slice rather than the next one
+            len = snprintf(buf, sizeof(buf), ",\"id\":\"0x%llx\",\"bp\":\"e\"}", (unsigned long long)e.value);
+            break;
+        default :
+            len = snprintf(buf, sizeof(buf), "}");
+            break;
+        }
+        return sink.write(reinterpret_cast<const uint8_t *>(buf), (std::size_t)len);
+    }
+}
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            namespace Impl {
+                std::atomic<bool> traceEnabled(false);
+            }
+        }
+    }
+}
+
+void TAK::Engine::Util::Trace_setEnabled(const bool enabled) NOTHROWS
+{
+    Impl::traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+void TAK::Engine::Util::Trace_begin(const char *category, const char *name) NOTHROWS
+{
+    if (!Trace_isEnabled())
+        return;
+    record('B', category, name, 0u);
+#ifdef __ANDROID__
+    const ATrace &a = atrace();
+    if (a.beginSection)
+        a.beginSection(name);
+#endif
+}
+void TAK::Engine::Util::Trace_end(const char *category, const char *name) NOTHROWS
+{
+    // always record so that spans begun prior to disabling are closed
+    record('E', category, name, 0u);
+#ifdef __ANDROID__
+    const ATrace &a = atrace();
+    if (a.beginSection)
+        a.endSection();
+#endif
+}
+void TAK::Engine::Util::Trace_counter(const char *category, const char *name, const int64_t value) NOTHROWS
+{
+    if (!Trace_isEnabled())
+        return;
+    record('C', category, name, (uint64_t)value);
+#ifdef __ANDROID__
+    const ATrace &a = atrace();
+    if (a.setCounter)
+        a.setCounter(name, value);
+#endif
+}
+uint64_t TAK::Engine::Util::Trace_newFlowId() NOTHROWS
+{
+    static std::atomic<uint64_t> nextId(1u);
+    return nextId.fetch_add(1u, std::memory_order_relaxed);
+}
+void TAK::Engine::Util::Trace_flowBegin(const char *category, const char *name, const uint64_t id) NOTHROWS
+{
+    if (!Trace_isEnabled())
+        return;
+    record('s', category, name, id);
+}
+void TAK::Engine::Util::Trace_flowStep(const char *category, const char *name, const uint64_t id) NOTHROWS
+{
+    if (!Trace_isEnabled())
+        return;
+    record('t', category, name, id);
+}
+void TAK::Engine::Util::Trace_flowEnd(const char *category, const char *name, const uint64_t id) NOTHROWS
+{
+    if (!Trace_isEnabled())
+        return;
+    record('f', category, name, id);
+}
+TAKErr TAK::Engine::Util::Trace_export(DataOutput2 &sink, const TraceFormat format) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    if (format != TETF_ChromeJson)
+        return TE_InvalidArg;
+
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    static const char header[] = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    code = sink.write(reinterpret_cast<const uint8_t *>(header), sizeof(header)-1u);
+    TE_CHECKRETURN_CODE(code);
+
+    bool first = true;
+    std::vector<Event> events;
+    for (auto it = r.buffers.begin(); it != r.buffers.end(); it++) {
+        const ThreadBuffer &buffer = **it;
+        const uint64_t head = buffer.head.load(std::memory_order_acquire);
+        uint64_t tail = std::max(buffer.clearMark.load(std::memory_order_relaxed), (head > TRACE_BUFFER_CAPACITY) ? head-TRACE_BUFFER_CAPACITY : 0u);
+        events.clear();
+        for (uint64_t i = tail; i < head; i++)
+            events.push_back(buffer.events[i%TRACE_BUFFER_CAPACITY]);
+
+        // discard anything the writer may have overwritten during the copy
+        const uint64_t after = buffer.head.load(std::memory_order_acquire);
+        const uint64_t overwritten = (after > TRACE_BUFFER_CAPACITY) ? after-TRACE_BUFFER_CAPACITY : 0u;
+        const std::size_t skip = (overwritten > tail) ? (std::size_t)std::min<uint64_t>(overwritten-tail, events.size()) : 0u;
+
+        for (std::size_t i = skip; i < events.size(); i++) {
+            code = writeChromeJsonEvent(sink, events[i], buffer.tid, first);
+            TE_CHECKBREAK_CODE(code);
+            first = false;
+        }
+        TE_CHECKBREAK_CODE(code);
+    }
+    TE_CHECKRETURN_CODE(code);
+
+    static const char footer[] = "\n]}\n";
+    return sink.write(reinterpret_cast<const uint8_t *>(footer), sizeof(footer)-1u);
+}
+void TAK::Engine::Util::Trace_clear() NOTHROWS
+{
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    if (lock.status != TE_Ok)
+        return;
+    for (auto it = r.buffers.begin(); it != r.buffers.end(); it++)
+        (*it)->clearMark.store((*it)->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
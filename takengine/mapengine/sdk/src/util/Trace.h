@@ -0,0 +1,117 @@
+#ifndef TAK_ENGINE_UTIL_TRACE_H_INCLUDED
+#define TAK_ENGINE_UTIL_TRACE_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+
+#include "port/Platform.h"
+#include "util/DataOutput2.h"
+#include "util/Error.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Low overhead, cross-thread event tracing.
+             *
+             * Events are recorded into per-thread ring buffers without
+             * locking and may be exported as Chrome trace event JSON, which
+             * loads in both chrome://tracing and the Perfetto UI. When
+             * running on Android, spans and counters are additionally
+             * forwarded to ATrace if available.
+             *
+             * All `category` and `name` arguments must be string literals,
+             * or otherwise outlive the recorded trace; only the pointers
+             * are retained.
+             */
+
+            enum TraceFormat
+            {
+                /** Chrome trace event JSON */
+                TETF_ChromeJson,
+            };
+
+            namespace Impl {
+                extern ENGINE_API std::atomic<bool> traceEnabled;
+            }
+
+            /**
+             * Enables or disables recording. Recording is disabled by
+             * default.
+             */
+            ENGINE_API void Trace_setEnabled(const bool enabled) NOTHROWS;
+            inline bool Trace_isEnabled() NOTHROWS
+            {
+                return Impl::traceEnabled.load(std::memory_order_relaxed);
+            }
+            /** Marks the start of a span on the current thread. */
+            ENGINE_API void Trace_begin(const char *category, const char *name) NOTHROWS;
+            /** Marks the end of the innermost open span on the current thread. */
+            ENGINE_API void Trace_end(const char *category, const char *name) NOTHROWS;
+            /** Records the value of a counter track. */
+            ENGINE_API void Trace_counter(const char *category, const char *name, const int64_t value) NOTHROWS;
+            /**
+             * Returns a new, process unique id for connecting asynchronous
+             * work via flow events.
+             */
+            ENGINE_API uint64_t Trace_newFlowId() NOTHROWS;
+            /** Starts a flow; attaches to the enclosing span on the current thread. */
+            ENGINE_API void Trace_flowBegin(const char *category, const char *name, const uint64_t id) NOTHROWS;
+            /** Continues a flow from the enclosing span on the current thread. */
+            ENGINE_API void Trace_flowStep(const char *category, const char *name, const uint64_t id) NOTHROWS;
+            /** Terminates a flow at the enclosing span on the current thread. */
+            ENGINE_API void Trace_flowEnd(const char *category, const char *name, const uint64_t id) NOTHROWS;
+            /**
+             * Writes all recorded events to the specified sink. Events
+             * recorded concurrently with the export may be omitted.
+             */
+            ENGINE_API TAKErr Trace_export(DataOutput2 &sink, const TraceFormat format) NOTHROWS;
+            /** Discards all recorded events. */
+            ENGINE_API void Trace_clear() NOTHROWS;
+
+            /**
+             * Records a span for the lifetime of the instance. If tracing
+             * is not enabled at construction, no span is recorded.
+             */
+            class TraceScope
+            {
+            public :
+                TraceScope(const char *category_, const char *name_) NOTHROWS :
+                    category(Trace_isEnabled() ? category_ : nullptr),
+                    name(name_)
+                {
+                    if (category)
+                        Trace_begin(category, name);
+                }
+                ~TraceScope() NOTHROWS
+                {
+                    if (category)
+                        Trace_end(category, name);
+                }
+            private :
+                TraceScope(const TraceScope &) = delete;
+                TraceScope &operator=(const TraceScope &) = delete;
+            private :
+                const char *category;
+                const char *name;
+            };
+        }
+    }
+}
+
+#define TE_TRACE_CONCAT_IMPL(a, b) a##b
+#define TE_TRACE_CONCAT(a, b) TE_TRACE_CONCAT_IMPL(a, b)
+
+/** Records a span covering the remainder of the enclosing block */
+#define TE_TRACE_SCOPE(category, name) \
+    ::TAK::Engine::Util::TraceScope TE_TRACE_CONCAT(te_trace_scope_, __LINE__)(category, name)
+#define TE_TRACE_COUNTER(category, name, value) \
+    do { if (::TAK::Engine::Util::Trace_isEnabled()) ::TAK::Engine::Util::Trace_counter(category, name, value); } while (false)
+#define TE_TRACE_FLOW_BEGIN(category, name, id) \
+    do { if (::TAK::Engine::Util::Trace_isEnabled()) ::TAK::Engine::Util::Trace_flowBegin(category, name, id); } while (false)
+#define TE_TRACE_FLOW_STEP(category, name, id) \
+    do { if (::TAK::Engine::Util::Trace_isEnabled()) ::TAK::Engine::Util::Trace_flowStep(category, name, id); } while (false)
+#define TE_TRACE_FLOW_END(category, name, id) \
+    do { if (::TAK::Engine::Util::Trace_isEnabled()) ::TAK::Engine::Util::Trace_flowEnd(category, name, id); } while (false)
+
+#endif
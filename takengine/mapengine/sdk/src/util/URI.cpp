@@ -16,6 +16,7 @@ namespace {
         TAKErr registerProtocolHandler(std::shared_ptr<ProtocolHandler> protHandler, int priority);
         TAKErr unregisterProtocolHandler(const std::shared_ptr<ProtocolHandler>& protHandler);
         TAKErr open(DataInput2Ptr& result, const char* URI) const NOTHROWS;
+        TAKErr openRange(DataInput2Ptr& result, const char* URI, const int64_t offset, const std::size_t length) const NOTHROWS;
 
     private:
         std::multimap<int, std::shared_ptr<ProtocolHandler>, std::greater<int>> priority_sorted_;
@@ -59,6 +60,10 @@ TAKErr TAK::Engine::Util::URI_open(DataInput2Ptr& result, const char* URI) NOTHR
     return code;
 }
 
+TAKErr TAK::Engine::Util::URI_openRange(DataInput2Ptr& result, const char* URI, const int64_t offset, const std::size_t length) NOTHROWS {
+    return sharedURIFactoryRegistry().read()->openRange(result, URI, offset, length);
+}
+
 TAKErr TAK::Engine::Util::URI_registerProtocolHandler(const std::shared_ptr<ProtocolHandler>& protHandler, int priority) NOTHROWS {
     return sharedURIFactoryRegistry().invokeWrite(&URIFactoryRegistry::registerProtocolHandler, protHandler, priority);
 }
@@ -257,6 +262,17 @@ namespace {
         return code;
     }
 
+    TAKErr URIFactoryRegistry::openRange(DataInput2Ptr& result, const char* URI, const int64_t offset, const std::size_t length) const NOTHROWS {
+        TAKErr code = TE_Unsupported;
+        for (auto& entry : priority_sorted_) {
+            std::shared_ptr<ProtocolHandler> handler = entry.second;
+            code = handler->handleURIRange(result, URI, offset, length);
+            if (code != TE_Unsupported)
+                break;
+        }
+        return code;
+    }
+
     TAKErr buildImpl(
         String* result,
         const char* scheme,
@@ -11,6 +11,15 @@ namespace TAK {
              */
             ENGINE_API TAKErr URI_open(DataInput2Ptr &result, const char *URI) NOTHROWS;
 
+            /**
+             * Opens <code>length</code> bytes of the resource at the URI,
+             * starting at <code>offset</code>.
+             *
+             * @return  TE_Ok on success, TE_Unsupported if no registered
+             *          protocol handler can serve the range
+             */
+            ENGINE_API TAKErr URI_openRange(DataInput2Ptr &result, const char *URI, const int64_t offset, const std::size_t length) NOTHROWS;
+
             /**
              *
              */
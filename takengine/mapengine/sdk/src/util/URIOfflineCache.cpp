@@ -3,14 +3,19 @@
 #include "util/URI.h"
 #include "util/DataOutput2.h"
 #include "port/StringBuilder.h"
+#include "util/MemoryTrim.h"
 #include "util/Tasking.h"
 #include "thread/Mutex.h"
 #include "port/Platform.h"
 #include "db/Database2.h"
+#include "db/Statement2.h"
 #include "port/STLVectorAdapter.h"
 #include "db/Query.h"
 #include <curl/curl.h>
+#include <cstdio>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Port;
@@ -18,19 +23,28 @@ using namespace TAK::Engine::DB;
 
 namespace {
     const char* CACHE_DB_NAME = "__cachedb__";
+    // appended to the subpath for content being fetched. '%' is always
+    // followed by two hex digits in an escaped URI, so this can't collide
+    // with a cache entry
+    const char* PARTIAL_SUFFIX = "%part";
     bool notCacheDbFilter(const char* file);
     TAKErr URIToSubpath(String& result, const char *URI) NOTHROWS;
     TAKErr maintainTask(uint64_t& size, String& path, uint64_t sizeLimit) NOTHROWS;
     TAKErr ensureCacheDb(DatabasePtr& db, const char* basePath) NOTHROWS;
     TAKErr kickCacheFile(int64_t& knownSize, const DatabasePtr& db) NOTHROWS;
-    TAKErr addFileToDb(Database2* db, const char* URI, int64_t size, int64_t mtime) NOTHROWS;
+    TAKErr addFileToDb(Database2* db, const char* URI, int64_t size, int64_t mtime, int64_t atime) NOTHROWS;
     int64_t getKnownSizeFromDb(DatabasePtr& db) NOTHROWS;
+    int64_t getSizeFromDb(Database2& db, const char* URI) NOTHROWS;
     TAKErr getCacheFileLRM(String& URI, int64_t& size, const DatabasePtr& db) NOTHROWS;
 
     SharedWorkerPtr maintenanceWorker() NOTHROWS {
         return GeneralWorkers_single();
     }
 
+    SharedWorkerPtr renewWorker() NOTHROWS {
+        return GeneralWorkers_flex();
+    }
+
     struct CacheExchange {
         enum State {
             UNKNOWN,
@@ -44,7 +58,7 @@ namespace {
     };
 }
 
-struct URIOfflineCache::Impl {
+struct URIOfflineCache::Impl : public MemoryTrimmable {
 
     Impl(const char* path, size_t sizeLimit)
     : db(nullptr, nullptr) {
@@ -62,12 +76,42 @@ struct URIOfflineCache::Impl {
         this->base_path = fixedPath;
         this->size_limit = sizeLimit;
         this->last_known_size = 0;
+
+        MemoryTrim_registerTrimmable(*this);
+    }
+    ~Impl() NOTHROWS override {
+        MemoryTrim_unregisterTrimmable(*this);
+    }
+
+    void trim(const MemoryTrimLevel level) NOTHROWS override {
+        // the catalog is rebuilt by scanning the cache directory on reopen,
+        // only give up the connection under severe pressure
+        if (level < TETL_Critical)
+            return;
+        std::shared_ptr<Impl> impl(self.lock());
+        if (impl)
+            Task_begin(maintenanceWorker(), dbTrimTask_, impl);
+    }
+
+    TAKErr ensureDb() NOTHROWS {
+        if (db)
+            return TE_Ok;
+        TAKErr code = ensureCacheDb(db, base_path);
+        if (code != TE_Ok)
+            return code;
+
+        // get the sum total
+        last_known_size = getKnownSizeFromDb(db);
+        return TE_Ok;
     }
 
     TAK::Engine::Thread::Mutex mutex;
     std::unordered_map<std::string, CacheExchange> pending_exchanges;
+    // access times not yet recorded in the catalog
+    std::unordered_map<std::string, int64_t> pending_touches;
 
     DatabasePtr db;
+    std::weak_ptr<Impl> self;
     
     int64_t size_limit;
     int64_t last_known_size;
@@ -76,7 +120,9 @@ struct URIOfflineCache::Impl {
 
 URIOfflineCache::URIOfflineCache(const char* path, uint64_t sizeLimit) NOTHROWS
 : impl_(std::make_shared<Impl>(path, sizeLimit)) 
-{}
+{
+    impl_->self = impl_;
+}
 
 TAKErr URIOfflineCache::open(DataInput2Ptr& result, const char* URI, int64_t renewSeconds, bool forceRenew) NOTHROWS {
 
@@ -95,32 +141,196 @@ TAKErr URIOfflineCache::open(DataInput2Ptr& result, const char* URI, int64_t ren
     StringBuilder fullPath;
     StringBuilder_combine(fullPath, impl_->base_path, subpath);
 
-    CacheExchange filledExchange;
-    Promise<CacheExchange::State> promise;
-    bool fulfillPromise = false;
+    int64_t lastModified = 0; // stays 0 when path does not exist
+    IO_getLastModified(&lastModified, fullPath.c_str());
+    int64_t pastModify = (Platform_systime_millis() - lastModified) / 1000;
+
+    // non-exists OR stale
+    if (lastModified == 0 || pastModify >= renewSeconds || forceRenew)
+        code = exchange_(impl_, URI, subpath, renewSeconds, forceRenew, true);
+
+    if (code == TE_Ok) {
+        code = IO_openFile(result, fullPath.c_str());
+        if (code == TE_Ok)
+            touch_(impl_, subpath);
+    }
+
+    // All else fails-- just read directly
+    if (code != TE_Ok)
+        code = URI_open(result, URI);
+
+    return code;
+}
+
+TAKErr URIOfflineCache::openAsyncRenew(DataInput2Ptr& result, const char* URI, int64_t renewSeconds, int64_t maxStaleSeconds) NOTHROWS {
 
-    // serialize all exchanges
+    if (!URI)
+        return TE_InvalidArg;
+
+    String subpath;
+    TAKErr code = URIToSubpath(subpath, URI);
+    if (code != TE_Ok)
+        return code;
+    if (String_strcasecmp(subpath, CACHE_DB_NAME) == 0)
+        return URI_open(result, URI);
+
+    StringBuilder fullPath;
+    StringBuilder_combine(fullPath, impl_->base_path, subpath);
+
+    int64_t lastModified = 0;
+    IO_getLastModified(&lastModified, fullPath.c_str());
+    int64_t pastModify = (Platform_systime_millis() - lastModified) / 1000;
+
+    // serve stale content and renew in the background
+    if (lastModified != 0 && pastModify >= renewSeconds && pastModify < maxStaleSeconds) {
+        code = IO_openFile(result, fullPath.c_str());
+        if (code == TE_Ok) {
+            touch_(impl_, subpath);
+            Task_begin(renewWorker(), renewTask_, impl_, String(URI), subpath, renewSeconds);
+            return code;
+        }
+    }
+
+    return open(result, URI, renewSeconds, false);
+}
+
+TAKErr URIOfflineCache::openCached(DataInput2Ptr& result, const char* URI, int64_t renewSeconds) NOTHROWS {
+
+    if (!URI)
+        return TE_InvalidArg;
+
+    String subpath;
+    TAKErr code = URIToSubpath(subpath, URI);
+    if (code != TE_Ok)
+        return code;
+    if (String_strcasecmp(subpath, CACHE_DB_NAME) == 0)
+        return TE_InvalidArg;
+
+    StringBuilder fullPath;
+    StringBuilder_combine(fullPath, impl_->base_path, subpath);
+
+    {
+        TAK::Engine::Thread::Lock lock(impl_->mutex);
+        if (lock.status != TE_Ok)
+            return lock.status;
+
+        // content is being renewed
+        if (impl_->pending_exchanges.find(subpath.get()) != impl_->pending_exchanges.end())
+            return TE_Done;
+    }
+
+    int64_t lastModified = 0;
+    IO_getLastModified(&lastModified, fullPath.c_str());
+    if (lastModified == 0 || ((Platform_systime_millis() - lastModified) / 1000) >= renewSeconds)
+        return TE_Done;
+
+    code = IO_openFile(result, fullPath.c_str());
+    if (code == TE_Ok)
+        touch_(impl_, subpath);
+    return code;
+}
+
+TAKErr URIOfflineCache::put(const char* URI, const uint8_t* data, const std::size_t len) NOTHROWS {
+
+    if (!URI || (!data && len))
+        return TE_InvalidArg;
+
+    String subpath;
+    TAKErr code = URIToSubpath(subpath, URI);
+    if (code != TE_Ok)
+        return code;
+    if (String_strcasecmp(subpath, CACHE_DB_NAME) == 0)
+        return TE_InvalidArg;
+
+    StringBuilder fullPath;
+    StringBuilder_combine(fullPath, impl_->base_path, subpath);
+    StringBuilder partialPath;
+    StringBuilder_combine(partialPath, fullPath.c_str(), PARTIAL_SUFFIX);
+
+    // claim the entry for the duration of the write so that concurrent
+    // opens wait on the fill
+    Promise<CacheExchange::State> promise;
     {
         TAK::Engine::Thread::Lock lock(impl_->mutex);
         if (lock.status != TE_Ok)
             return lock.status;
 
-        auto it = impl_->pending_exchanges.find(subpath.get());
-        if (it != impl_->pending_exchanges.end()) {
-            if (it->second.dest != CacheExchange::FILLED) {
-                // need a fulfill after this exchange
-                fulfillPromise = true;
-                it->second = CacheExchange{
-                    CacheExchange::FILLED,
-                    promise.getFuture()
-                };
+        if (impl_->pending_exchanges.find(subpath.get()) != impl_->pending_exchanges.end())
+            return TE_Ok;
+        impl_->pending_exchanges.insert(std::pair<std::string, CacheExchange>(
+            subpath.get(),
+            CacheExchange {
+                CacheExchange::FILLED,
+                promise.getFuture()
+            }));
+    }
+
+    CacheExchange::State state = CacheExchange::UNKNOWN;
+    code = IO_mkdirs(impl_->base_path);
+    if (code == TE_Ok) {
+        FileOutput2 output;
+        code = output.open(partialPath.c_str());
+        if (code == TE_Ok)
+            code = output.write(data, len);
+        output.close();
+        if (code == TE_Ok) {
+            // readers of the previous content are unaffected by the replace
+            if (std::rename(partialPath.c_str(), fullPath.c_str()) != 0) {
+                IO_delete(fullPath.c_str());
+                if (std::rename(partialPath.c_str(), fullPath.c_str()) != 0)
+                    code = TE_IO;
             }
+        }
+        state = (code == TE_Ok) ? CacheExchange::FILLED : CacheExchange::UNKNOWN;
+        if (code != TE_Ok)
+            IO_delete(partialPath.c_str());
+    }
+
+    if (code == TE_Ok) {
+        int64_t mtime = 0;
+        IO_getLastModified(&mtime, fullPath.c_str());
+        Task_begin(maintenanceWorker(), dbAddTask_, impl_, subpath, (int64_t)len, mtime);
+    }
+
+    {
+        TAK::Engine::Thread::Lock lock(impl_->mutex);
+        if (lock.status == TE_Ok)
+            impl_->pending_exchanges.erase(subpath.get());
+    }
+    promise = state;
+
+    return code;
+}
+
+const char* URIOfflineCache::getPath() const NOTHROWS {
+    return impl_->base_path.get();
+}
+
+TAKErr URIOfflineCache::exchange_(const std::shared_ptr<Impl>& impl, const char* URI, const TAK::Engine::Port::String& subpath, int64_t renewSeconds, bool forceRenew, bool join) NOTHROWS {
+
+    StringBuilder fullPath;
+    StringBuilder_combine(fullPath, impl->base_path, subpath);
+
+    Promise<CacheExchange::State> promise;
+    CacheExchange filledExchange;
+    bool fulfillPromise = false;
+
+    // only one fetch per URI is in flight; others wait on its result
+    {
+        TAK::Engine::Thread::Lock lock(impl->mutex);
+        if (lock.status != TE_Ok)
+            return lock.status;
+
+        auto it = impl->pending_exchanges.find(subpath.get());
+        if (it != impl->pending_exchanges.end()) {
+            if (!join)
+                return TE_Busy;
             filledExchange = it->second;
         } else {
             fulfillPromise = true;
-            filledExchange = impl_->pending_exchanges
+            filledExchange = impl->pending_exchanges
                 .insert(std::pair<std::string, CacheExchange>(
-                    subpath.get(), 
+                    subpath.get(),
                     CacheExchange {
                         CacheExchange::FILLED,
                         promise.getFuture()
@@ -130,44 +340,63 @@ TAKErr URIOfflineCache::open(DataInput2Ptr& result, const char* URI, int64_t ren
 
     if (fulfillPromise) {
 
-        int64_t lastModified = 0; // stays 0 when path does not exist
-        IO_getLastModified(&lastModified, fullPath.c_str());
-        int64_t sysMilis = Platform_systime_millis();
-        
         CacheExchange::State state = CacheExchange::UNKNOWN;
-        code = IO_mkdirs(impl_->base_path);
-        
-        // non-exists OR stale
-        int64_t pastModify = (sysMilis - lastModified) / 1000;
-        if (code == TE_Ok && pastModify >= renewSeconds || forceRenew) {
+        TAKErr code = IO_mkdirs(impl->base_path);
+
+        // the content may have been renewed since the caller checked
+        int64_t lastModified = 0;
+        IO_getLastModified(&lastModified, fullPath.c_str());
+        int64_t pastModify = (Platform_systime_millis() - lastModified) / 1000;
+
+        if (code == TE_Ok && lastModified != 0 && pastModify < renewSeconds && !forceRenew) {
+            state = CacheExchange::FILLED;
+        } else if (code == TE_Ok) {
+            StringBuilder partialPath;
+            StringBuilder_combine(partialPath, fullPath.c_str(), PARTIAL_SUFFIX);
+
             DataInput2Ptr input(nullptr, nullptr);
             code = URI_open(input, URI);
-            
+
             FileOutput2 output;
             if (code == TE_Ok) {
-                code = output.open(fullPath.c_str());
+                code = output.open(partialPath.c_str());
             }
 
             if (code == TE_Ok) {
                 code = IO_copy(output, *input);
-                state = CacheExchange::FILLED;
             }
 
             output.close();
             if (input)
                 input->close();
 
-            // update maintenance catalog
-            int64_t mtime = 0;
-            int64_t size = 0;
-            IO_getLastModified(&mtime, fullPath.c_str());
-            IO_getFileSizeV(&size, fullPath.c_str());
+            // readers of the previous content are unaffected by the replace
+            if (code == TE_Ok && std::rename(partialPath.c_str(), fullPath.c_str()) != 0) {
+                IO_delete(fullPath.c_str());
+                if (std::rename(partialPath.c_str(), fullPath.c_str()) != 0)
+                    code = TE_IO;
+            }
 
-            Task_begin(maintenanceWorker(), dbAddTask_, impl_, subpath, size, mtime);
-        } else if (code == TE_Ok && lastModified != 0) {
-            state = CacheExchange::FILLED;
+            if (code == TE_Ok) {
+                state = CacheExchange::FILLED;
+
+                // update maintenance catalog
+                int64_t mtime = 0;
+                int64_t size = 0;
+                IO_getLastModified(&mtime, fullPath.c_str());
+                IO_getFileSizeV(&size, fullPath.c_str());
+
+                Task_begin(maintenanceWorker(), dbAddTask_, impl, subpath, size, mtime);
+            } else {
+                IO_delete(partialPath.c_str());
+            }
         }
 
+        {
+            TAK::Engine::Thread::Lock lock(impl->mutex);
+            if (lock.status == TE_Ok)
+                impl->pending_exchanges.erase(subpath.get());
+        }
         promise = state;
     }
 
@@ -175,85 +404,140 @@ TAKErr URIOfflineCache::open(DataInput2Ptr& result, const char* URI, int64_t ren
     TAKErr exchCode = TE_Err;
     filledExchange.result.await(state, exchCode);
 
-    if (exchCode == TE_Ok && state == CacheExchange::FILLED) {
-        {
-            TAK::Engine::Thread::Lock lock(impl_->mutex);
-            if (lock.status != TE_Ok)
-                return lock.status;
-
-            // clear from pendings
-            auto it = impl_->pending_exchanges.find(subpath.get());
-            if (it != impl_->pending_exchanges.end())
-                impl_->pending_exchanges.erase(it);
-        }
-
-        code = IO_openFile(result, fullPath.c_str());
-    }
+    return (exchCode == TE_Ok && state == CacheExchange::FILLED) ? TE_Ok : TE_Err;
+}
 
-    // All else fails-- just read directly
-    if (code != TE_Ok)
-        code = URI_open(result, URI);
+void URIOfflineCache::touch_(const std::shared_ptr<Impl>& impl, const TAK::Engine::Port::String& subpath) NOTHROWS {
+    // access times are recorded in batches
+    bool schedule;
+    {
+        TAK::Engine::Thread::Lock lock(impl->mutex);
+        if (lock.status != TE_Ok)
+            return;
 
-    return code;
+        schedule = impl->pending_touches.empty();
+        impl->pending_touches[subpath.get()] = Platform_systime_millis();
+    }
+    if (schedule)
+        Task_begin(maintenanceWorker(), dbTouchTask_, impl);
 }
 
-const char* URIOfflineCache::getPath() const NOTHROWS {
-    return impl_->base_path.get();
+TAKErr URIOfflineCache::renewTask_(bool&, const std::shared_ptr<Impl>& impl, const TAK::Engine::Port::String& URI, const TAK::Engine::Port::String& subpath, int64_t renewSeconds) NOTHROWS {
+    // don't wait on a renewal that is already in flight
+    TAKErr code = exchange_(impl, URI, subpath, renewSeconds, false, false);
+    return (code == TE_Busy) ? TE_Ok : code;
 }
 
 TAKErr URIOfflineCache::dbAddTask_(bool&, const std::shared_ptr<Impl>& impl, const TAK::Engine::Port::String& subpath, int64_t size, int64_t mtime) NOTHROWS {
-    TAKErr code = TE_Ok;
+    TAKErr code = impl->ensureDb();
+    if (code != TE_Ok)
+        return code;
 
-    if (!impl->db) {
-        code = ensureCacheDb(impl->db, impl->base_path);
-        if (code != TE_Ok)
-            return code;
+    // upsert entry; content replaced by a renewal no longer counts
+    const int64_t previousSize = getSizeFromDb(*impl->db, subpath);
+    code = addFileToDb(impl->db.get(), subpath, size, mtime, Platform_systime_millis());
+    if (code == TE_Ok)
+        impl->last_known_size += size - previousSize;
 
-        // get the sum total
-        impl->last_known_size = getKnownSizeFromDb(impl->db);
-    }
+    if (impl->last_known_size <= impl->size_limit)
+        return code;
 
-    // upsert entry
-    code = addFileToDb(impl->db.get(), subpath, size, mtime);
+    // select least recently used entries until known to be below size
+    std::vector<std::pair<std::string, int64_t>> evict;
+    {
+        QueryPtr query(nullptr, nullptr);
+        if (impl->db->query(query, "SELECT uri,size FROM cache_entries ORDER BY atime ASC") != TE_Ok)
+            return code;
 
-    QueryPtr query(nullptr, nullptr);
-    impl->db->query(query, "SELECT uri,size,mtime FROM cache_files ORDER BY mtime ASC;");
+        int64_t remaining = impl->last_known_size;
+        while (remaining > impl->size_limit && query->moveToNext() == TE_Ok) {
 
-    // kick until known to be below size
-    while (impl->last_known_size > impl->size_limit && query->moveToNext() == TE_Ok) {
+            const char* lruSubpath = "";
+            int64_t lruSize = 0;
 
-        const char* lrmSubpath = "";
-        int64_t lrmSize = 0;
+            query->getString(&lruSubpath, 0);
+            query->getLong(&lruSize, 1);
 
-        query->getString(&lrmSubpath, 0);
-        query->getLong(&lrmSize, 1);
+            // skip what was added
+            if (String_equal(subpath, lruSubpath))
+                continue;
 
-        // skip what was added
-        if (String_equal(subpath, lrmSubpath))
-            continue;
+            {
+                TAK::Engine::Thread::Lock lock(impl->mutex);
+                if (lock.status != TE_Ok)
+                    return lock.status;
 
-        {
-            TAK::Engine::Thread::Lock lock(impl->mutex);
-            if (lock.status != TE_Ok)
-                return lock.status;
+                // skip what is pending
+                if (impl->pending_exchanges.find(lruSubpath) != impl->pending_exchanges.end())
+                    continue;
+            }
 
-            // skip what is pending
-            auto it = impl->pending_exchanges.find(subpath.get());
-            if (it != impl->pending_exchanges.end())
-                continue;   
+            evict.push_back(std::make_pair(std::string(lruSubpath), lruSize));
+            remaining -= lruSize;
         }
+    }
 
+    StatementPtr stmt(nullptr, nullptr);
+    if (impl->db->compileStatement(stmt, "DELETE FROM cache_entries WHERE uri = ?") != TE_Ok)
+        return code;
+
+    Database2::Transaction transaction(*impl->db);
+    for (auto it = evict.begin(); it != evict.end(); it++) {
         StringBuilder fullPath;
-        StringBuilder_combine(fullPath, impl->base_path, lrmSubpath);
+        StringBuilder_combine(fullPath, impl->base_path, it->first.c_str());
+
+        bool exists = false;
+        IO_exists(&exists, fullPath.c_str());
+        if (exists && IO_delete(fullPath.c_str()) != TE_Ok)
+            continue;
 
-        TAKErr delCode = IO_delete(fullPath.c_str());
-        if (delCode == TE_Ok)
-            impl->last_known_size -= lrmSize;
+        stmt->clearBindings();
+        stmt->bindString(1, it->first.c_str());
+        if (stmt->execute() == TE_Ok)
+            impl->last_known_size -= it->second;
     }
+    impl->db->setTransactionSuccessful();
 
     return code;
 }
 
+TAKErr URIOfflineCache::dbTouchTask_(bool&, const std::shared_ptr<Impl>& impl) NOTHROWS {
+    std::unordered_map<std::string, int64_t> touches;
+    {
+        TAK::Engine::Thread::Lock lock(impl->mutex);
+        if (lock.status != TE_Ok)
+            return lock.status;
+        touches.swap(impl->pending_touches);
+    }
+
+    TAKErr code = impl->ensureDb();
+    if (code != TE_Ok)
+        return code;
+
+    StatementPtr stmt(nullptr, nullptr);
+    code = impl->db->compileStatement(stmt, "UPDATE cache_entries SET atime = ? WHERE uri = ?");
+    if (code != TE_Ok)
+        return code;
+
+    Database2::Transaction transaction(*impl->db);
+    for (auto it = touches.begin(); it != touches.end(); it++) {
+        stmt->clearBindings();
+        stmt->bindLong(1, it->second);
+        stmt->bindString(2, it->first.c_str());
+        stmt->execute();
+    }
+    impl->db->setTransactionSuccessful();
+
+    return TE_Ok;
+}
+
+TAKErr URIOfflineCache::dbTrimTask_(bool&, const std::shared_ptr<Impl>& impl) NOTHROWS {
+    // releases the connection and its page cache; reopened on next insert.
+    // the database is only accessed on the maintenance worker
+    impl->db.reset();
+    return TE_Ok;
+}
+
 namespace {
     TAKErr URIToSubpath(String& result, const char* URI) NOTHROWS {
 
@@ -267,9 +551,14 @@ namespace {
         return TE_Ok;
     }
 
+    struct BuildCacheContext {
+        Database2* db;
+        std::set<std::string> files;
+    };
+
     TAKErr buildCacheVisitor(void* opaque, const char* filePath) NOTHROWS {
 
-        Database2* db = static_cast<Database2*>(opaque);
+        BuildCacheContext* ctx = static_cast<BuildCacheContext*>(opaque);
 
         String fileName;
         IO_getName(fileName, filePath);
@@ -277,12 +566,35 @@ namespace {
         if (String_strcasecmp(fileName, CACHE_DB_NAME) == 0)
             return TE_Ok;
 
+        // content from an interrupted fetch
+        if (String_endsWith(fileName, PARTIAL_SUFFIX)) {
+            IO_delete(filePath);
+            return TE_Ok;
+        }
+
         int64_t size = 0;
         int64_t mtime = 0;
 
         IO_getLastModified(&mtime, filePath);
         IO_getFileSizeV(&size, filePath);
-        addFileToDb(db, fileName, size, mtime);
+
+        // retain the recorded access time for known entries
+        StringBuilder sizeStr;
+        StringBuilder mtimeStr;
+        sizeStr.append(size);
+        mtimeStr.append(mtime);
+        const char* args[] = {
+            sizeStr.c_str(),
+            mtimeStr.c_str(),
+            fileName.get()
+        };
+        unsigned long changes = 0u;
+        if (ctx->db->execute("UPDATE cache_entries SET size = ?, mtime = ? WHERE uri = ?", args, 3) != TE_Ok ||
+            Databases_lastChangeCount(&changes, *ctx->db) != TE_Ok || !changes) {
+
+            addFileToDb(ctx->db, fileName, size, mtime, mtime);
+        }
+        ctx->files.insert(fileName.get());
 
         return TE_Ok;
     }
@@ -303,31 +615,70 @@ namespace {
             if (code != TE_Ok)
                 return code;
         }
+        // tuning is best effort
+        Databases_applyProfile(*db, TEDP_TileCache);
 
-        code = db->execute("CREATE TABLE IF NOT EXISTS cache_files (uri TEXT PRIMARY KEY, size INT, mtime INT)", nullptr, 0);
+        // superseded by cache_entries, which records access time
+        code = db->execute("DROP TABLE IF EXISTS cache_files", nullptr, 0);
+        if (code != TE_Ok)
+            return code;
+        code = db->execute("CREATE TABLE IF NOT EXISTS cache_entries (uri TEXT PRIMARY KEY, size INT, mtime INT, atime INT)", nullptr, 0);
+        if (code != TE_Ok)
+            return code;
+        code = db->execute("CREATE INDEX IF NOT EXISTS cache_entries_atime_idx ON cache_entries(atime)", nullptr, 0);
         if (code != TE_Ok)
             return code;
 
-        return IO_visitFiles(buildCacheVisitor, db.get(), basePath, TELFM_ImmediateFiles);
+        BuildCacheContext ctx;
+        ctx.db = db.get();
+
+        Database2::Transaction transaction(*db);
+        code = IO_visitFiles(buildCacheVisitor, &ctx, basePath, TELFM_ImmediateFiles);
+        if (code != TE_Ok)
+            return code;
+
+        // drop entries for files removed while the cache was closed
+        std::vector<std::string> removed;
+        {
+            QueryPtr query(nullptr, nullptr);
+            code = db->query(query, "SELECT uri FROM cache_entries");
+            if (code != TE_Ok)
+                return code;
+            while (query->moveToNext() == TE_Ok) {
+                const char* uri = "";
+                if (query->getString(&uri, 0) == TE_Ok && ctx.files.find(uri) == ctx.files.end())
+                    removed.push_back(uri);
+            }
+        }
+        for (auto it = removed.begin(); it != removed.end(); it++) {
+            const char* args[] = { it->c_str() };
+            db->execute("DELETE FROM cache_entries WHERE uri = ?", args, 1);
+        }
+        db->setTransactionSuccessful();
+
+        return TE_Ok;
     }
 
-    TAKErr addFileToDb(Database2* db, const char* URI, int64_t size, int64_t mtime) NOTHROWS {
+    TAKErr addFileToDb(Database2* db, const char* URI, int64_t size, int64_t mtime, int64_t atime) NOTHROWS {
 
         StringBuilder sizeStr;
         StringBuilder mtimeStr;
+        StringBuilder atimeStr;
 
         sizeStr.append(size);
         mtimeStr.append(mtime);
+        atimeStr.append(atime);
 
         const char* args[] = {
             URI,
             sizeStr.c_str(),
-            mtimeStr.c_str()
+            mtimeStr.c_str(),
+            atimeStr.c_str()
         };
 
         
-        TAKErr code = db->execute("INSERT OR REPLACE INTO cache_files(uri,size,mtime) VALUES(?,?,?);",
-            args, 3);
+        TAKErr code = db->execute("INSERT OR REPLACE INTO cache_entries(uri,size,mtime,atime) VALUES(?,?,?,?);",
+            args, 4);
         if (code != TE_Ok)
             return code;
 
@@ -341,7 +692,7 @@ namespace {
     TAKErr getCacheFileLRM(String& URI, int64_t& size, const DatabasePtr& db) NOTHROWS {
 
         TAK::Engine::DB::QueryPtr query(nullptr, nullptr);
-        TAKErr code = db->query(query, "SELECT uri,size FROM cache_files WHERE mtime = (SELECT min(mtime) FROM cache_files)");
+        TAKErr code = db->query(query, "SELECT uri,size FROM cache_entries ORDER BY atime ASC LIMIT 1");
         if (code != TE_Ok)
             return code;
 
@@ -363,7 +714,7 @@ namespace {
     int64_t getKnownSizeFromDb(DatabasePtr& db) NOTHROWS {
 
         TAK::Engine::DB::QueryPtr query(nullptr, nullptr);
-        TAKErr code = db->query(query, "SELECT sum(size) FROM cache_files");
+        TAKErr code = db->query(query, "SELECT sum(size) FROM cache_entries");
         if (code != TE_Ok)
             return -1;
 
@@ -374,4 +725,19 @@ namespace {
         query->getLong(&sizeVal, 0);
         return sizeVal;
     }
+
+    int64_t getSizeFromDb(Database2& db, const char* URI) NOTHROWS {
+
+        TAK::Engine::DB::QueryPtr query(nullptr, nullptr);
+        if (db.compileQuery(query, "SELECT size FROM cache_entries WHERE uri = ?") != TE_Ok)
+            return 0;
+        if (query->bindString(1, URI) != TE_Ok)
+            return 0;
+        if (query->moveToNext() != TE_Ok)
+            return 0;
+
+        int64_t sizeVal = 0;
+        query->getLong(&sizeVal, 0);
+        return sizeVal;
+    }
 }
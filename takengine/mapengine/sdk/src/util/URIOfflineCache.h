@@ -14,15 +14,46 @@ namespace TAK {
             class ENGINE_API URIOfflineCache {
             public:
                 /**
-                 *
+                 * @param path      The cache directory
+                 * @param sizeLimit The disk budget, in bytes. When exceeded,
+                 *                  the least recently used content is
+                 *                  evicted.
                  */
                 URIOfflineCache(const char* path, uint64_t sizeLimit) NOTHROWS;
 
                 /**
-                 *
+                 * Opens the content for the URI, fetching it if it is not
+                 * cached or was cached more than <code>renewSeconds</code>
+                 * ago. Concurrent opens of the same URI share a single
+                 * fetch.
                  */
                 TAKErr open(DataInput2Ptr& result, const char* URI, int64_t renewSeconds, bool forceRenew = false) NOTHROWS;
 
+                /**
+                 * Opens the content for the URI. If the content was cached
+                 * more than <code>renewSeconds</code> ago, but less than
+                 * <code>maxStaleSeconds</code> ago, the cached content is
+                 * returned immediately and renewed in the background.
+                 * Otherwise behaves as <code>open</code>.
+                 */
+                TAKErr openAsyncRenew(DataInput2Ptr& result, const char* URI, int64_t renewSeconds, int64_t maxStaleSeconds) NOTHROWS;
+
+                /**
+                 * Opens the cached content for the URI without fetching.
+                 *
+                 * @return  TE_Ok on success, TE_Done if the content is not
+                 *          cached or was cached more than
+                 *          <code>renewSeconds</code> ago
+                 */
+                TAKErr openCached(DataInput2Ptr& result, const char* URI, int64_t renewSeconds) NOTHROWS;
+
+                /**
+                 * Stores content for the URI that was obtained by the
+                 * caller, e.g. as part of a larger request. The content is
+                 * ignored if the URI is currently being fetched.
+                 */
+                TAKErr put(const char* URI, const uint8_t* data, const std::size_t len) NOTHROWS;
+
                 /**
                  *
                  */
@@ -30,7 +61,12 @@ namespace TAK {
 
             private:
                 struct Impl;
+                static TAKErr exchange_(const std::shared_ptr<Impl>& impl, const char* URI, const TAK::Engine::Port::String& subpath, int64_t renewSeconds, bool forceRenew, bool join) NOTHROWS;
+                static void touch_(const std::shared_ptr<Impl>& impl, const TAK::Engine::Port::String& subpath) NOTHROWS;
+                static TAKErr renewTask_(bool&, const std::shared_ptr<Impl>& impl, const TAK::Engine::Port::String& URI, const TAK::Engine::Port::String& subpath, int64_t renewSeconds) NOTHROWS;
                 static TAKErr dbAddTask_(bool&, const std::shared_ptr<Impl>& impl, const TAK::Engine::Port::String& subpath, int64_t size, int64_t mtime) NOTHROWS;
+                static TAKErr dbTouchTask_(bool&, const std::shared_ptr<Impl>& impl) NOTHROWS;
+                static TAKErr dbTrimTask_(bool&, const std::shared_ptr<Impl>& impl) NOTHROWS;
 
             private:
                 std::shared_ptr<Impl> impl_;
@@ -1,13 +1,17 @@
 
 //#include <chrono>
+#include <atomic>
 #include <unordered_map>
 #include "thread/Thread.h"
 #include "thread/RWMutex.h"
 #include "util/Work.h"
+#include "util/WorkerMetrics.h"
+#include "util/impl/WorkerMetricsImpl.h"
 #include "port/Platform.h"
 
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util::Impl;
 
 //
 //
@@ -27,11 +31,28 @@ namespace {
 	};
 }
 
+//
+// CancellationToken
+//
+
+CancellationToken::CancellationToken() NOTHROWS : canceled_(false) {}
+
+CancellationToken::~CancellationToken() NOTHROWS
+{ }
+
+void CancellationToken::cancel() NOTHROWS {
+	canceled_ = true;
+}
+
+bool CancellationToken::isCanceled() const NOTHROWS {
+	return canceled_;
+}
+
 //
 // Work
 //
 
-Work::Work() NOTHROWS : state_(Pending), result_code_(TE_Ok) {}
+Work::Work() NOTHROWS : result_code_(TE_Ok), state_(Pending), priority_(0), deadline_(0LL), schedule_time_micros_(0LL) {}
 
 Work::~Work() NOTHROWS
 { }
@@ -76,6 +97,39 @@ TAKErr Work::awaitDone(TAKErr &err) NOTHROWS {
 	return this->awaitDone(lockPtr, err);
 }
 
+void Work::setPriority(const int priority) NOTHROWS {
+	priority_ = priority;
+}
+
+int Work::getPriority() const NOTHROWS {
+	return priority_;
+}
+
+void Work::setDeadline(const int64_t deadlineMillis) NOTHROWS {
+	deadline_ = deadlineMillis;
+}
+
+int64_t Work::getDeadline() const NOTHROWS {
+	return deadline_;
+}
+
+void Work::setCancellationToken(const std::shared_ptr<CancellationToken> &token) NOTHROWS {
+	cancel_token_ = token;
+}
+
+bool Work::preemptIfExpired() NOTHROWS {
+	TAKErr because;
+	if (cancel_token_ && cancel_token_->isCanceled())
+		because = TE_Canceled;
+	else if (deadline_ && TAK::Engine::Port::Platform_systime_millis() > deadline_)
+		because = TE_TimedOut;
+	else
+		return false;
+
+	// TE_Busy indicates the work is already underway; let it finish
+	return (preempt(because) != TE_Busy);
+}
+
 TAKErr Work::beginWorking(MonitorLockPtr &lockPtr) NOTHROWS {
 	TAKErr code = beginSync(lockPtr);
 	if (code != TE_Ok)
@@ -204,6 +258,36 @@ TAKErr TransferWork::onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS {
 	return worker->scheduleWork(this->work);
 }
 
+TAKErr TransferWork::onDone(MonitorLockPtr &lockPtr, TAKErr result) NOTHROWS {
+	lockPtr.reset(nullptr);
+	if (result != TE_Ok)
+		this->work->preempt(result);
+	return TE_Ok;
+}
+
+//
+// WorkQueue
+//
+
+TAKErr TAK::Engine::Util::WorkQueue_push(std::deque<std::shared_ptr<Work>> &queue, std::shared_ptr<Work> &&work) NOTHROWS {
+	TAKErr code(TE_Ok);
+	TE_BEGIN_TRAP() {
+		// common case is uniform priority; scan from the back so that is O(1)
+		auto it = queue.end();
+		if (work) {
+			const int priority = work->getPriority();
+			while (it != queue.begin()) {
+				auto prev = it - 1;
+				if (!*prev || (*prev)->getPriority() >= priority)
+					break;
+				it = prev;
+			}
+		}
+		queue.insert(it, std::move(work));
+	} TE_END_TRAP(code);
+	return code;
+}
+
 //
 // Worker
 //
@@ -236,6 +320,15 @@ ControlWorker::~ControlWorker() NOTHROWS
 { }
 
 namespace {
+	/**
+	 * Returns the absolute deadline `milliLimit` from now, saturating for unbounded limits
+	 * such as INT64_MAX.
+	 */
+	int64_t deadlineFor(const int64_t milliLimit) NOTHROWS {
+		const int64_t now = TAK::Engine::Port::Platform_systime_millis();
+		return (milliLimit > INT64_MAX - now) ? INT64_MAX : now + milliLimit;
+	}
+
 	class ControlQueue {
 	public:
 		struct Stats {
@@ -243,10 +336,15 @@ namespace {
 			size_t threadCount;
 		};
 
-		ControlQueue() NOTHROWS;
+		ControlQueue(const std::shared_ptr<WorkerMetricsRecorder> &metrics = std::shared_ptr<WorkerMetricsRecorder>()) NOTHROWS;
 		~ControlQueue() NOTHROWS;
 		TAKErr queueWork(std::shared_ptr<Work> &&work, Stats *optStats = nullptr) NOTHROWS;
 		TAKErr awaitWork(std::shared_ptr<Work> &workPtr, int64_t milliLimit) NOTHROWS;
+		/**
+		 * Awaits work for an attached thread. On TE_TimedOut the thread has been detached,
+		 * under the same lock hold that observed the empty queue.
+		 */
+		TAKErr awaitWorkOrDetach(std::shared_ptr<Work> &workPtr, int64_t milliLimit) NOTHROWS;
 		TAKErr takeWork(std::shared_ptr<Work> &workPtr) NOTHROWS;
 		TAKErr interrupt() NOTHROWS;
 		TAKErr cap() NOTHROWS;
@@ -254,12 +352,19 @@ namespace {
 		TAKErr attachThread() NOTHROWS;
 		TAKErr detachThread() NOTHROWS;
 
+	private:
+		TAKErr awaitWorkUntil(std::shared_ptr<Work> &workPtr, const int64_t deadline, const bool detachOnTimeout) NOTHROWS;
+		TAKErr awaitWorkImpl(std::shared_ptr<Work> &workPtr, const int64_t deadline, const bool detachOnTimeout) NOTHROWS;
+		TAKErr takeWorkImpl(std::shared_ptr<Work> &workPtr) NOTHROWS;
 	private:
 		Monitor monitor;
 		std::deque<std::shared_ptr<Work>> workQueue;
 		Stats stats;
 		bool interrupted;
 		bool capped;
+	public:
+		// null if the owning worker is not instrumented
+		const std::shared_ptr<WorkerMetricsRecorder> metrics;
 	};
 
 	class ControlWorkerImpl : public ControlWorker {
@@ -277,6 +382,45 @@ namespace {
 		std::shared_ptr<ControlQueue> controlQueue;
 	};
 
+	/**
+	 * Multi-producer, single-consumer intrusive queue (Vyukov). Producers never block;
+	 * the consumer observes an item once its producer has completed the link.
+	 */
+	class MPSCWorkQueue {
+	public:
+		MPSCWorkQueue() NOTHROWS;
+		~MPSCWorkQueue() NOTHROWS;
+		TAKErr push(std::shared_ptr<Work> &&work) NOTHROWS;
+		bool pop(std::shared_ptr<Work> &work) NOTHROWS;
+	private:
+		struct Node {
+			std::atomic<Node *> next;
+			std::shared_ptr<Work> work;
+		};
+		std::atomic<Node *> head;
+		Node *tail;
+		Node stub;
+	};
+
+	class LockFreeControlWorker : public ControlWorker {
+	public:
+		LockFreeControlWorker(const std::shared_ptr<WorkerMetricsRecorder> &metrics = std::shared_ptr<WorkerMetricsRecorder>()) NOTHROWS;
+		~LockFreeControlWorker() NOTHROWS override;
+		TAKErr scheduleWork(std::shared_ptr<Work> work) NOTHROWS override;
+		TAKErr doAnyWork(int64_t millisecondLimit) NOTHROWS override;
+		TAKErr doAllWork(int64_t millisecondLimit) NOTHROWS override;
+		TAKErr interrupt() NOTHROWS override;
+	private:
+		bool takeWork(std::shared_ptr<Work> &work) NOTHROWS;
+	private:
+		MPSCWorkQueue queue;
+		std::atomic<bool> interrupted;
+		// only touched by producers when the consumer is parked in `doAllWork`
+		std::atomic<bool> consumerWaiting;
+		Monitor waitMonitor;
+		const std::shared_ptr<WorkerMetricsRecorder> metrics;
+	};
+
 	class ThreadWorker : public Worker {
 	public:
 		static TAKErr create(std::shared_ptr<ThreadWorker> &workerPtr, const std::shared_ptr<ControlQueue> &controlQueue, 
@@ -286,7 +430,7 @@ namespace {
 		TAKErr scheduleWork(std::shared_ptr<Work> work) NOTHROWS override;
 		~ThreadWorker() NOTHROWS override;
 
-		static TAKErr spawnThread(ThreadPtr &thread, const std::shared_ptr<ControlQueue> &controlQueue, int64_t keepAliveMillis, uint64_t worker_id) NOTHROWS;
+		static TAKErr spawnThread(ThreadPtr &thread, const std::shared_ptr<ControlQueue> &controlQueue, int64_t keepAliveMillis, uint64_t worker_id, const ThreadCreateParams &params = ThreadCreateParams()) NOTHROWS;
 
 	private:
 		ThreadWorker(const std::shared_ptr<ControlQueue> &queue, int64_t keepAliveMillis, bool shouldCap, bool shouldInterrupt) NOTHROWS;
@@ -312,7 +456,8 @@ namespace {
 			size_t minThreadCount, 
 			size_t maxThreadCount,
 			int64_t keepAliveMillis,
-			const std::shared_ptr<ControlQueue> &controlQueue) NOTHROWS;
+			const std::shared_ptr<ControlQueue> &controlQueue,
+			const ThreadCreateParams &threadParams = ThreadCreateParams()) NOTHROWS;
 
 		TAKErr scheduleWork(std::shared_ptr<Work> work) NOTHROWS override;
 
@@ -320,12 +465,14 @@ namespace {
 		ThreadPoolWorker(size_t minThreadCount,
 			size_t maxThreadCount,
 			int64_t keepAliveMillis, 
-			const std::shared_ptr<ControlQueue> &queue) NOTHROWS;
+			const std::shared_ptr<ControlQueue> &queue,
+			const ThreadCreateParams &threadParams) NOTHROWS;
 
 		const std::shared_ptr<ControlQueue> controlQueue;
 		const size_t minThreadCount;
 		const size_t maxThreadCount;
 		const int64_t keepAliveMillis;
+		const ThreadCreateParams threadParams;
 	};
 
 	class OverrideWorker : public Worker {
@@ -340,14 +487,66 @@ namespace {
 		uint64_t task_num_;
 	};
 
+	class WorkStealingQueue {
+	public:
+		WorkStealingQueue(size_t dequeCount, const std::shared_ptr<WorkerMetricsRecorder> &metrics = std::shared_ptr<WorkerMetricsRecorder>()) NOTHROWS;
+		~WorkStealingQueue() NOTHROWS;
+		TAKErr queueWork(std::shared_ptr<Work> &&work) NOTHROWS;
+		TAKErr awaitWork(std::shared_ptr<Work> &workPtr, size_t dequeIndex) NOTHROWS;
+		TAKErr cap() NOTHROWS;
+	private:
+		bool tryTakeWork(std::shared_ptr<Work> &workPtr, size_t dequeIndex) NOTHROWS;
+	private:
+		struct WorkDeque {
+			Mutex mutex;
+			std::deque<std::shared_ptr<Work>> items;
+		};
+
+		std::unique_ptr<WorkDeque[]> deques;
+		const size_t dequeCount;
+		std::atomic<size_t> pendingCount;
+		std::atomic<size_t> idleCount;
+		std::atomic<size_t> nextDeque;
+		std::atomic<bool> capped;
+		Monitor idleMonitor;
+	public:
+		const std::shared_ptr<WorkerMetricsRecorder> metrics;
+	};
+
+	class WorkStealingThreadPoolWorker : public Worker {
+	public:
+		~WorkStealingThreadPoolWorker() NOTHROWS override;
+
+		static TAKErr create(std::shared_ptr<WorkStealingThreadPoolWorker> &worker, size_t threadCount) NOTHROWS;
+
+		TAKErr scheduleWork(std::shared_ptr<Work> work) NOTHROWS override;
+
+	private:
+		WorkStealingThreadPoolWorker(const std::shared_ptr<WorkStealingQueue> &queue) NOTHROWS;
+		static void *threadStart(void *threadData);
+
+		const std::shared_ptr<WorkStealingQueue> queue;
+
+		struct ThreadArgs {
+			std::shared_ptr<WorkStealingQueue> queue;
+			size_t dequeIndex;
+			uint64_t worker_id;
+		};
+	};
+
+	// identifies the deque owned by the executing thread, if it is a work-stealing pool thread
+	thread_local static const WorkStealingQueue *thread_local_steal_queue_ = nullptr;
+	thread_local static size_t thread_local_steal_index_ = 0;
+
 	//
 	// ControlQueue
 	//
 
-	ControlQueue::ControlQueue() NOTHROWS
+	ControlQueue::ControlQueue(const std::shared_ptr<WorkerMetricsRecorder> &metrics_) NOTHROWS
 		: stats{ 0, 0 },
 	    interrupted(false),
-		capped(false)
+		capped(false),
+		metrics(metrics_)
 	{}
 
 	ControlQueue::~ControlQueue() NOTHROWS
@@ -358,12 +557,16 @@ namespace {
 		TAKErr code(MonitorLock_create(lockPtr, this->monitor));
 		TE_CHECKRETURN_CODE(code);
 
-		if (this->capped)
+		if (this->capped) {
+			if (metrics)
+				metrics->recordRejected();
 			return TE_Done;
+		}
 
-		TE_BEGIN_TRAP() {
-			workQueue.push_back(std::move(work));
-		} TE_END_TRAP(code);
+		// consumers cannot dequeue until the monitor is released
+		if (metrics)
+			metrics->recordScheduled(*work);
+		code = WorkQueue_push(workQueue, std::move(work));
 		TE_CHECKRETURN_CODE(code);
 
 		if (optStats)
@@ -374,10 +577,48 @@ namespace {
 	}
 
 	TAKErr ControlQueue::awaitWork(std::shared_ptr<Work> &workPtr, int64_t milliLimit) NOTHROWS {
-
 		if (milliLimit <= 0)
 			return TE_TimedOut;
 
+		return awaitWorkUntil(workPtr, deadlineFor(milliLimit), false);
+	}
+
+	TAKErr ControlQueue::awaitWorkOrDetach(std::shared_ptr<Work> &workPtr, int64_t milliLimit) NOTHROWS {
+		// a thread that times out must not drop the lock between finding the queue empty
+		// and detaching; work queued in between would see it still counted and spawn no
+		// replacement
+		return awaitWorkUntil(workPtr, deadlineFor(milliLimit > 0 ? milliLimit : 0), true);
+	}
+
+	TAKErr ControlQueue::awaitWorkUntil(std::shared_ptr<Work> &workPtr, const int64_t deadline, const bool detachOnTimeout) NOTHROWS {
+		// the limit applies to the call as a whole; retries after preemption or a wakeup
+		// that finds no work only wait out the remainder
+
+		// expired work is preempted outside of the queue lock as preemption may schedule
+		// attached work
+		while (true) {
+			TAKErr code = awaitWorkImpl(workPtr, deadline, detachOnTimeout);
+			if (code != TE_Ok || !workPtr || !workPtr->preemptIfExpired())
+				return code;
+			if (metrics)
+				metrics->recordPreempted();
+			workPtr.reset();
+		}
+	}
+
+	TAKErr ControlQueue::takeWork(std::shared_ptr<Work> &workPtr) NOTHROWS {
+		while (true) {
+			TAKErr code = takeWorkImpl(workPtr);
+			if (code != TE_Ok || !workPtr || !workPtr->preemptIfExpired())
+				return code;
+			if (metrics)
+				metrics->recordPreempted();
+			workPtr.reset();
+		}
+	}
+
+	TAKErr ControlQueue::awaitWorkImpl(std::shared_ptr<Work> &workPtr, const int64_t deadline, const bool detachOnTimeout) NOTHROWS {
+
 		{
 			MonitorLockPtr lockPtr(nullptr, nullptr);
 			TAKErr code(MonitorLock_create(lockPtr, this->monitor));
@@ -393,12 +634,20 @@ namespace {
 					return TE_Done;
 				}
 
+				const int64_t remaining = deadline - TAK::Engine::Port::Platform_systime_millis();
+				if (remaining <= 0) {
+					if (detachOnTimeout)
+						stats.threadCount--;
+					return TE_TimedOut;
+				}
+
 				stats.waitingCount++;
-				TAKErr waitCode = lockPtr->wait(milliLimit);
+				TAKErr waitCode = lockPtr->wait(remaining);
 				stats.waitingCount--;
-				if (waitCode == TE_TimedOut)
-					return waitCode;
-				TE_CHECKRETURN_CODE(waitCode);
+				// a timed out wait re-checks the queue, which may have been filled
+				// by the time the lock was reacquired
+				if (waitCode != TE_TimedOut)
+					TE_CHECKRETURN_CODE(waitCode);
 
 				if (this->interrupted) {
 					return TE_Interrupted;
@@ -414,7 +663,7 @@ namespace {
 		return TE_Ok;
 	}
 
-	TAKErr ControlQueue::takeWork(std::shared_ptr<Work> &workPtr) NOTHROWS {
+	TAKErr ControlQueue::takeWorkImpl(std::shared_ptr<Work> &workPtr) NOTHROWS {
 		MonitorLockPtr lockPtr(nullptr, nullptr);
 		TAKErr code(MonitorLock_create(lockPtr, this->monitor));
 		TE_CHECKRETURN_CODE(code);
@@ -506,7 +755,7 @@ namespace {
 			if (code != TE_Ok)
 				return code;
 
-			work->signalWork();
+			WorkerMetrics_run(*work, this->controlQueue->metrics.get());
 
 			int64_t point = TAK::Engine::Port::Platform_systime_millis();
 			countDown -= (point - last);
@@ -529,7 +778,7 @@ namespace {
 			if (code != TE_Ok)
 				return code;
 
-			work->signalWork();
+			WorkerMetrics_run(*work, this->controlQueue->metrics.get());
 
 			int64_t point = TAK::Engine::Port::Platform_systime_millis();
 			countDown -= (point - last);
@@ -541,6 +790,178 @@ namespace {
 
 	TAKErr ControlWorkerImpl::interrupt() NOTHROWS {
 		return controlQueue->interrupt();
+	}
+
+	//
+	// MPSCWorkQueue
+	//
+
+	MPSCWorkQueue::MPSCWorkQueue() NOTHROWS
+		: head(&stub),
+		tail(&stub)
+	{
+		stub.next.store(nullptr);
+	}
+
+	MPSCWorkQueue::~MPSCWorkQueue() NOTHROWS {
+		std::shared_ptr<Work> work;
+		while (pop(work))
+			work.reset();
+		// the last node popped remains as the stub and is owned by the queue
+		if (tail != &stub)
+			delete tail;
+	}
+
+	TAKErr MPSCWorkQueue::push(std::shared_ptr<Work> &&work) NOTHROWS {
+		Node *node = new(std::nothrow) Node();
+		if (!node)
+			return TE_OutOfMemory;
+		node->next.store(nullptr, std::memory_order_relaxed);
+		node->work = std::move(work);
+
+		// serialization point for producers
+		Node *prev = head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+		return TE_Ok;
+	}
+
+	bool MPSCWorkQueue::pop(std::shared_ptr<Work> &work) NOTHROWS {
+		Node *next = tail->next.load(std::memory_order_acquire);
+		if (!next)
+			return false; // empty, or a producer is mid-link; observed on a subsequent pop
+
+		// `next` becomes the new stub; its payload is handed off
+		work = std::move(next->work);
+		Node *prev = tail;
+		tail = next;
+		if (prev != &stub)
+			delete prev;
+		return true;
+	}
+
+	//
+	// LockFreeControlWorker
+	//
+
+	LockFreeControlWorker::LockFreeControlWorker(const std::shared_ptr<WorkerMetricsRecorder> &metrics_) NOTHROWS
+		: interrupted(false),
+		consumerWaiting(false),
+		metrics(metrics_)
+	{
+		if (metrics)
+			metrics->setWorkerId(Worker_getWorkerId(*this));
+	}
+
+	LockFreeControlWorker::~LockFreeControlWorker() NOTHROWS
+	{ }
+
+	TAKErr LockFreeControlWorker::scheduleWork(std::shared_ptr<Work> work) NOTHROWS {
+		if (!work)
+			return TE_InvalidArg;
+		// the schedule time must be written before the item is published
+		if (metrics)
+			metrics->recordScheduled(*work);
+		TAKErr code = queue.push(std::move(work));
+		TE_CHECKRETURN_CODE(code);
+
+		// pairs with the fence in `doAllWork`; either the consumer observes the pushed item or
+		// the producer observes the waiting consumer
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (consumerWaiting.load()) {
+			MonitorLockPtr lockPtr(nullptr, nullptr);
+			code = MonitorLock_create(lockPtr, waitMonitor);
+			TE_CHECKRETURN_CODE(code);
+			code = lockPtr->signal();
+		}
+		return code;
+	}
+
+	bool LockFreeControlWorker::takeWork(std::shared_ptr<Work> &work) NOTHROWS {
+		while (queue.pop(work)) {
+			if (work && !work->preemptIfExpired())
+				return true;
+			if (work && metrics)
+				metrics->recordPreempted();
+			work.reset();
+		}
+		return false;
+	}
+
+	TAKErr LockFreeControlWorker::doAnyWork(int64_t millisecondLimit) NOTHROWS {
+		int64_t last = TAK::Engine::Port::Platform_systime_millis();
+		int64_t countDown = millisecondLimit;
+
+		CurrentWorkerScope currentWorkerScope(Worker_getWorkerId(*this));
+
+		while (countDown > 0) {
+			if (interrupted)
+				return TE_Interrupted;
+
+			std::shared_ptr<Work> work;
+			if (!takeWork(work))
+				return TE_Done;
+
+			WorkerMetrics_run(*work, metrics.get());
+
+			int64_t point = TAK::Engine::Port::Platform_systime_millis();
+			countDown -= (point - last);
+			last = point;
+		}
+
+		return TE_TimedOut;
+	}
+
+	TAKErr LockFreeControlWorker::doAllWork(int64_t millisecondLimit) NOTHROWS {
+		int64_t last = TAK::Engine::Port::Platform_systime_millis();
+		int64_t countDown = millisecondLimit;
+
+		CurrentWorkerScope currentWorkerScope(Worker_getWorkerId(*this));
+
+		while (countDown > 0) {
+			if (interrupted)
+				return TE_Interrupted;
+
+			std::shared_ptr<Work> work;
+			if (takeWork(work)) {
+				WorkerMetrics_run(*work, metrics.get());
+			} else {
+				MonitorLockPtr lockPtr(nullptr, nullptr);
+				TAKErr code = MonitorLock_create(lockPtr, waitMonitor);
+				TE_CHECKRETURN_CODE(code);
+
+				// producers check `consumerWaiting` after pushing; re-check the queue after
+				// publishing the flag so a concurrent push is not missed
+				consumerWaiting = true;
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (takeWork(work)) {
+					consumerWaiting = false;
+					lockPtr.reset();
+					WorkerMetrics_run(*work, metrics.get());
+				} else if (!interrupted) {
+					code = lockPtr->wait(countDown);
+					consumerWaiting = false;
+					if (code != TE_TimedOut)
+						TE_CHECKRETURN_CODE(code);
+				} else {
+					consumerWaiting = false;
+				}
+			}
+
+			int64_t point = TAK::Engine::Port::Platform_systime_millis();
+			countDown -= (point - last);
+			last = point;
+		}
+
+		return TE_TimedOut;
+	}
+
+	TAKErr LockFreeControlWorker::interrupt() NOTHROWS {
+		interrupted = true;
+
+		MonitorLockPtr lockPtr(nullptr, nullptr);
+		TAKErr code = MonitorLock_create(lockPtr, waitMonitor);
+		TE_CHECKRETURN_CODE(code);
+		return lockPtr->broadcast();
 	}
 
 	//
@@ -572,9 +993,9 @@ namespace {
 			controlQueue->interrupt();
 	}
 
-	TAKErr ThreadWorker::spawnThread(ThreadPtr &threadPtr, const std::shared_ptr<ControlQueue> &controlQueue, int64_t keepAliveMillis, uint64_t worker_id) NOTHROWS {
+	TAKErr ThreadWorker::spawnThread(ThreadPtr &threadPtr, const std::shared_ptr<ControlQueue> &controlQueue, int64_t keepAliveMillis, uint64_t worker_id, const ThreadCreateParams &params) NOTHROWS {
 		std::unique_ptr<ThreadArgs> threadArgs(new ThreadArgs{ controlQueue, keepAliveMillis, worker_id });
-		TAKErr code = Thread_start(threadPtr, threadStart, threadArgs.get());
+		TAKErr code = Thread_start(threadPtr, threadStart, threadArgs.get(), params);
 		if (code != TE_Ok)
 			return code;
 
@@ -604,13 +1025,16 @@ namespace {
 		CurrentWorkerScope currentWorkerScope(worker_id);
 
 		std::shared_ptr<Work> work;
-		while (controlQueue->awaitWork(work, keepAliveMillis) == TE_Ok) {
+		TAKErr code;
+		while ((code = controlQueue->awaitWorkOrDetach(work, keepAliveMillis)) == TE_Ok) {
 			if (work) {
-				work->signalWork();
+				WorkerMetrics_run(*work, controlQueue->metrics.get());
 				work.reset();
 			}
 		}
-		controlQueue->detachThread();
+		// a thread that timed out was detached with the queue locked
+		if (code != TE_TimedOut)
+			controlQueue->detachThread();
 
 		return nullptr;
 	}
@@ -623,12 +1047,13 @@ namespace {
 		size_t minThreadCount,
 		size_t maxThreadCount,
 		int64_t keepAliveMillis, 
-		const std::shared_ptr<ControlQueue> &controlQueue) NOTHROWS {
+		const std::shared_ptr<ControlQueue> &controlQueue,
+		const ThreadCreateParams &threadParams) NOTHROWS {
 
-		std::shared_ptr<ThreadPoolWorker> threadWorker(new ThreadPoolWorker(minThreadCount, maxThreadCount, keepAliveMillis, controlQueue));
+		std::shared_ptr<ThreadPoolWorker> threadWorker(new ThreadPoolWorker(minThreadCount, maxThreadCount, keepAliveMillis, controlQueue, threadParams));
 		for (size_t i = 0; i < minThreadCount; ++i) {
 			ThreadPtr threadPtr(nullptr, nullptr);
-			TAKErr code = ThreadWorker::spawnThread(threadPtr, controlQueue, INT64_MAX, Worker_getWorkerId(*threadWorker));
+			TAKErr code = ThreadWorker::spawnThread(threadPtr, controlQueue, INT64_MAX, Worker_getWorkerId(*threadWorker), threadParams);
 			if (code != TE_Ok) {
 				controlQueue->interrupt();
 				return code;
@@ -642,11 +1067,13 @@ namespace {
 	ThreadPoolWorker::ThreadPoolWorker(size_t minThreadCount,
 		size_t maxThreadCount,
 		int64_t keepAliveMillis, 
-		const std::shared_ptr<ControlQueue> &controlQueue) NOTHROWS
+		const std::shared_ptr<ControlQueue> &controlQueue,
+		const ThreadCreateParams &threadParams) NOTHROWS
 		: minThreadCount(minThreadCount),
 		maxThreadCount(maxThreadCount),
 		keepAliveMillis(keepAliveMillis),
-		controlQueue(controlQueue)
+		controlQueue(controlQueue),
+		threadParams(threadParams)
 	{}
 
 	ThreadPoolWorker::~ThreadPoolWorker() NOTHROWS {
@@ -660,7 +1087,7 @@ namespace {
 			stats.waitingCount == 0 &&
 			stats.threadCount < this->maxThreadCount) {
 			ThreadPtr threadPtr(nullptr, nullptr);
-			code = ThreadWorker::spawnThread(threadPtr, this->controlQueue, this->keepAliveMillis, Worker_getWorkerId(*this));
+			code = ThreadWorker::spawnThread(threadPtr, this->controlQueue, this->keepAliveMillis, Worker_getWorkerId(*this), this->threadParams);
 			TE_CHECKRETURN_CODE(code);
 		}
 
@@ -692,6 +1119,193 @@ namespace {
 		// backing_worker_ isn't transient-- don't need lock
 		return this->backing_worker_->scheduleWork(work);
 	}
+
+	//
+	// WorkStealingQueue
+	//
+
+	WorkStealingQueue::WorkStealingQueue(size_t dequeCount_, const std::shared_ptr<WorkerMetricsRecorder> &metrics_) NOTHROWS
+		: deques(new WorkDeque[dequeCount_ ? dequeCount_ : 1u]),
+		dequeCount(dequeCount_ ? dequeCount_ : 1u),
+		pendingCount(0u),
+		idleCount(0u),
+		nextDeque(0u),
+		capped(false),
+		metrics(metrics_)
+	{}
+
+	WorkStealingQueue::~WorkStealingQueue() NOTHROWS
+	{ }
+
+	TAKErr WorkStealingQueue::queueWork(std::shared_ptr<Work> &&work) NOTHROWS {
+		if (this->capped) {
+			if (metrics)
+				metrics->recordRejected();
+			return TE_Done;
+		}
+
+		// work spawned on a pool thread stays local to that thread's deque
+		const size_t index = (thread_local_steal_queue_ == this) ?
+			thread_local_steal_index_ : (nextDeque++ % dequeCount);
+
+		TAKErr code(TE_Ok);
+		{
+			Lock lock(deques[index].mutex);
+			TE_CHECKRETURN_CODE(lock.status);
+
+			if (metrics)
+				metrics->recordScheduled(*work);
+			TE_BEGIN_TRAP() {
+				deques[index].items.push_back(std::move(work));
+			} TE_END_TRAP(code);
+			TE_CHECKRETURN_CODE(code);
+		}
+		pendingCount++;
+
+		// only touch the idle monitor if a thread may be parked. An idle thread increments
+		// `idleCount` before re-checking `pendingCount`, so one of the two sides observes the other
+		if (idleCount.load()) {
+			MonitorLockPtr lockPtr(nullptr, nullptr);
+			code = MonitorLock_create(lockPtr, this->idleMonitor);
+			TE_CHECKRETURN_CODE(code);
+			code = lockPtr->signal();
+		}
+		return code;
+	}
+
+	bool WorkStealingQueue::tryTakeWork(std::shared_ptr<Work> &workPtr, size_t dequeIndex) NOTHROWS {
+		if (!pendingCount.load())
+			return false;
+
+		// LIFO from the owned deque
+		{
+			WorkDeque &local = deques[dequeIndex];
+			Lock lock(local.mutex);
+			if (lock.status == TE_Ok && !local.items.empty()) {
+				workPtr = std::move(local.items.back());
+				local.items.pop_back();
+				pendingCount--;
+				return true;
+			}
+		}
+
+		// FIFO steal from the others, starting with the neighbor
+		for (size_t i = 1u; i < dequeCount; i++) {
+			WorkDeque &victim = deques[(dequeIndex + i) % dequeCount];
+			Lock lock(victim.mutex);
+			if (lock.status == TE_Ok && !victim.items.empty()) {
+				workPtr = std::move(victim.items.front());
+				victim.items.pop_front();
+				pendingCount--;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	TAKErr WorkStealingQueue::awaitWork(std::shared_ptr<Work> &workPtr, size_t dequeIndex) NOTHROWS {
+		while (true) {
+			if (tryTakeWork(workPtr, dequeIndex)) {
+				if (workPtr && workPtr->preemptIfExpired()) {
+					if (metrics)
+						metrics->recordPreempted();
+					workPtr.reset();
+					continue;
+				}
+				return TE_Ok;
+			}
+
+			MonitorLockPtr lockPtr(nullptr, nullptr);
+			TAKErr code(MonitorLock_create(lockPtr, this->idleMonitor));
+			TE_CHECKRETURN_CODE(code);
+
+			// capped pools drain remaining work before the threads exit
+			if (this->capped && !pendingCount.load())
+				return TE_Done;
+
+			idleCount++;
+			if (!pendingCount.load() && !this->capped)
+				code = lockPtr->wait();
+			idleCount--;
+			TE_CHECKRETURN_CODE(code);
+		}
+	}
+
+	TAKErr WorkStealingQueue::cap() NOTHROWS {
+		MonitorLockPtr lockPtr(nullptr, nullptr);
+		TAKErr code(MonitorLock_create(lockPtr, this->idleMonitor));
+		TE_CHECKRETURN_CODE(code);
+
+		this->capped = true;
+		lockPtr->broadcast();
+		return TE_Ok;
+	}
+
+	//
+	// WorkStealingThreadPoolWorker
+	//
+
+	TAKErr WorkStealingThreadPoolWorker::create(std::shared_ptr<WorkStealingThreadPoolWorker> &worker, size_t threadCount) NOTHROWS {
+		if (!threadCount)
+			return TE_InvalidArg;
+
+		std::shared_ptr<WorkStealingQueue> queue(new WorkStealingQueue(threadCount, WorkerMetrics_createRecorder()));
+		std::shared_ptr<WorkStealingThreadPoolWorker> poolWorker(new WorkStealingThreadPoolWorker(queue));
+		if (queue->metrics)
+			queue->metrics->setWorkerId(Worker_getWorkerId(*poolWorker));
+		for (size_t i = 0; i < threadCount; ++i) {
+			std::unique_ptr<ThreadArgs> threadArgs(new ThreadArgs{ queue, i, Worker_getWorkerId(*poolWorker) });
+			ThreadPtr threadPtr(nullptr, nullptr);
+			TAKErr code = Thread_start(threadPtr, threadStart, threadArgs.get());
+			if (code != TE_Ok) {
+				queue->cap();
+				return code;
+			}
+			threadPtr->detach();
+			threadArgs.release();
+		}
+
+		worker = poolWorker;
+		return TE_Ok;
+	}
+
+	WorkStealingThreadPoolWorker::WorkStealingThreadPoolWorker(const std::shared_ptr<WorkStealingQueue> &queue_) NOTHROWS
+		: queue(queue_)
+	{}
+
+	WorkStealingThreadPoolWorker::~WorkStealingThreadPoolWorker() NOTHROWS {
+		queue->cap();
+	}
+
+	TAKErr WorkStealingThreadPoolWorker::scheduleWork(std::shared_ptr<Work> work) NOTHROWS {
+		if (!work)
+			return TE_InvalidArg;
+		return queue->queueWork(std::move(work));
+	}
+
+	void *WorkStealingThreadPoolWorker::threadStart(void *opaque) {
+		std::unique_ptr<ThreadArgs> threadArgs(static_cast<ThreadArgs *>(opaque));
+		std::shared_ptr<WorkStealingQueue> queue = threadArgs->queue;
+		const size_t dequeIndex = threadArgs->dequeIndex;
+		const uint64_t worker_id = threadArgs->worker_id;
+		threadArgs.reset();
+
+		CurrentWorkerScope currentWorkerScope(worker_id);
+		thread_local_steal_queue_ = queue.get();
+		thread_local_steal_index_ = dequeIndex;
+
+		std::shared_ptr<Work> work;
+		while (queue->awaitWork(work, dequeIndex) == TE_Ok) {
+			if (work) {
+				WorkerMetrics_run(*work, queue->metrics.get());
+				work.reset();
+			}
+		}
+
+		thread_local_steal_queue_ = nullptr;
+		return nullptr;
+	}
 }
 
 uint64_t TAK::Engine::Util::Worker_getWorkerId(const Worker& worker) NOTHROWS {
@@ -763,35 +1377,63 @@ TAKErr TAK::Engine::Util::Worker_setWorkerLocalStorage(size_t slot, void* ptr) N
 
 
 TAKErr TAK::Engine::Util::Worker_createThread(SharedWorkerPtr &worker) NOTHROWS {
-	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue());
+	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue(WorkerMetrics_createRecorder()));
 	std::shared_ptr<ThreadWorker> threadWorker;
 	TAKErr code = ThreadWorker::create(threadWorker, controlQueue);
-	if (code == TE_Ok)
+	if (code == TE_Ok) {
+		if (controlQueue->metrics)
+			controlQueue->metrics->setWorkerId(Worker_getWorkerId(*threadWorker));
 		worker = threadWorker;
+	}
 	return code;
 }
 
 TAKErr TAK::Engine::Util::Worker_createFixedThreadPool(SharedWorkerPtr &worker, size_t threadCount) NOTHROWS {
-	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue());
+	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue(WorkerMetrics_createRecorder()));
 	std::shared_ptr<ThreadPoolWorker> threadWorker;
 	TAKErr code = ThreadPoolWorker::create(threadWorker, threadCount, threadCount, INT64_MAX, controlQueue);
-	if (code == TE_Ok)
+	if (code == TE_Ok) {
+		if (controlQueue->metrics)
+			controlQueue->metrics->setWorkerId(Worker_getWorkerId(*threadWorker));
 		worker = threadWorker;
+	}
 	return code;
 }
 
 TAKErr TAK::Engine::Util::Worker_createControlWorker(std::shared_ptr<ControlWorker> &controlWorker) NOTHROWS {
-	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue());
+	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue(WorkerMetrics_createRecorder()));
 	controlWorker = std::make_shared<ControlWorkerImpl>(controlQueue);
+	if (controlQueue->metrics)
+		controlQueue->metrics->setWorkerId(Worker_getWorkerId(*controlWorker));
+	return TE_Ok;
+}
+
+TAKErr TAK::Engine::Util::Worker_createLockFreeControlWorker(std::shared_ptr<ControlWorker> &controlWorker) NOTHROWS {
+	controlWorker = std::make_shared<LockFreeControlWorker>(WorkerMetrics_createRecorder());
 	return TE_Ok;
 }
 
 TAKErr TAK::Engine::Util::Worker_createThreadPool(SharedWorkerPtr &worker, size_t minThreadCount, size_t maxThreadCount, int64_t keepAliveMillis) NOTHROWS {
-	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue());
+	return Worker_createThreadPool(worker, minThreadCount, maxThreadCount, keepAliveMillis, ThreadCreateParams());
+}
+
+TAKErr TAK::Engine::Util::Worker_createThreadPool(SharedWorkerPtr &worker, size_t minThreadCount, size_t maxThreadCount, int64_t keepAliveMillis, const ThreadCreateParams &threadParams) NOTHROWS {
+	std::shared_ptr<ControlQueue> controlQueue(new ControlQueue(WorkerMetrics_createRecorder()));
 	std::shared_ptr<ThreadPoolWorker> threadWorker;
-	TAKErr code = ThreadPoolWorker::create(threadWorker, minThreadCount, maxThreadCount, INT64_MAX, controlQueue);
-	if (code == TE_Ok)
+	TAKErr code = ThreadPoolWorker::create(threadWorker, minThreadCount, maxThreadCount, keepAliveMillis, controlQueue, threadParams);
+	if (code == TE_Ok) {
+		if (controlQueue->metrics)
+			controlQueue->metrics->setWorkerId(Worker_getWorkerId(*threadWorker));
 		worker = threadWorker;
+	}
+	return code;
+}
+
+TAKErr TAK::Engine::Util::Worker_createWorkStealingThreadPool(SharedWorkerPtr &worker, size_t threadCount) NOTHROWS {
+	std::shared_ptr<WorkStealingThreadPoolWorker> poolWorker;
+	TAKErr code = WorkStealingThreadPoolWorker::create(poolWorker, threadCount);
+	if (code == TE_Ok)
+		worker = poolWorker;
 	return code;
 }
 
@@ -811,31 +1453,40 @@ TAKErr TAK::Engine::Util::Worker_createOverrideTasker(SharedWorkerPtr& result,
 //
 
 namespace {
-	SharedWorkerPtr makeFixedWorker(size_t threadCount) {
+	SharedWorkerPtr makeFixedWorker(size_t threadCount, const char *name) {
+		std::shared_ptr<Worker> result;
+		if (Worker_createThreadPool(result, threadCount, threadCount, INT64_MAX) == TE_Ok)
+			WorkerMetrics_setName(*result, name);
+		return result;
+	}
+
+	SharedWorkerPtr makeWorkStealingWorker(size_t threadCount, const char *name) {
 		std::shared_ptr<Worker> result;
-		Worker_createThreadPool(result, threadCount, threadCount, INT64_MAX);
+		if (Worker_createWorkStealingThreadPool(result, threadCount) == TE_Ok)
+			WorkerMetrics_setName(*result, name);
 		return result;
 	}
 
-	SharedWorkerPtr makeFlexWorker() {
+	SharedWorkerPtr makeFlexWorker(const char *name) {
 		std::shared_ptr<Worker> result;
-		Worker_createThreadPool(result, 0, 32, 60 * 1000);
+		if (Worker_createThreadPool(result, 0, 32, 60 * 1000) == TE_Ok)
+			WorkerMetrics_setName(*result, name);
 		return result;
 	}
 }
 
 const SharedWorkerPtr& TAK::Engine::Util::GeneralWorkers_flex() NOTHROWS {
-	static SharedWorkerPtr inst = makeFlexWorker();
+	static SharedWorkerPtr inst = makeFlexWorker("general-flex");
 	return inst;
 }
 
 const SharedWorkerPtr& TAK::Engine::Util::GeneralWorkers_single() NOTHROWS {
-	static SharedWorkerPtr inst = makeFixedWorker(1);
+	static SharedWorkerPtr inst = makeFixedWorker(1, "general-single");
 	return inst;
 }
 
 const SharedWorkerPtr& TAK::Engine::Util::GeneralWorkers_cpu() NOTHROWS {
-	static SharedWorkerPtr inst = makeFixedWorker(4);
+	static SharedWorkerPtr inst = makeWorkStealingWorker(TAK::Engine::Port::Platform_processorCount(), "general-cpu");
 	return inst;
 }
 
@@ -849,6 +1500,8 @@ class ImmediateWorker : public Worker {
 public:
 	~ImmediateWorker() NOTHROWS override { }
 	TAKErr scheduleWork(std::shared_ptr<Work> work) NOTHROWS override {
+		if (work->preemptIfExpired())
+			return TE_Ok;
 		return work->signalWork();
 	}
 };
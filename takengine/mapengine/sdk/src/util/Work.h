@@ -2,6 +2,7 @@
 #ifndef TAK_ENGINE_UTIL_WORK_H_INCLUDED
 #define TAK_ENGINE_UTIL_WORK_H_INCLUDED
 
+#include <atomic>
 #include <vector>
 #include <deque>
 #include "thread/ThreadPool.h"
@@ -10,6 +11,30 @@
 namespace TAK {
 	namespace Engine {
 		namespace Util {
+			namespace Impl {
+				class WorkerMetricsRecorder;
+			}
+
+			/**
+			 * A cancellation flag that may be shared across a group of Work. Once canceled,
+			 * any Work holding the token that has not yet started is preempted with
+			 * TE_Canceled when a Worker goes to run it.
+			 */
+			class CancellationToken {
+			public:
+				ENGINE_API CancellationToken() NOTHROWS;
+				ENGINE_API ~CancellationToken() NOTHROWS;
+
+				/**
+				 * Cancel all Work associated with the token. This cannot be undone.
+				 */
+				ENGINE_API void cancel() NOTHROWS;
+
+				ENGINE_API bool isCanceled() const NOTHROWS;
+			private:
+				std::atomic<bool> canceled_;
+			};
+
 			/**
 			 * Base for objects that represent a unit of async work.
 			 */
@@ -52,6 +77,45 @@ namespace TAK {
 				 */
 				ENGINE_API TAKErr awaitDone(TAKErr &err) NOTHROWS;
 
+				/**
+				 * Set the scheduling priority. Workers run pending work of higher priority ahead
+				 * of lower priority; equal priorities are run in the order scheduled. The default
+				 * priority is 0.
+				 *
+				 * <p>Must be set before the work is scheduled</p>
+				 */
+				ENGINE_API void setPriority(const int priority) NOTHROWS;
+
+				ENGINE_API int getPriority() const NOTHROWS;
+
+				/**
+				 * Set a deadline, as milliseconds since the epoch (see Platform_systime_millis).
+				 * Work that has not started by the deadline is preempted with TE_TimedOut when a
+				 * Worker goes to run it. A value of 0 (the default) means no deadline.
+				 *
+				 * <p>Must be set before the work is scheduled</p>
+				 */
+				ENGINE_API void setDeadline(const int64_t deadlineMillis) NOTHROWS;
+
+				ENGINE_API int64_t getDeadline() const NOTHROWS;
+
+				/**
+				 * Associate a (possibly shared) cancellation token with the work.
+				 *
+				 * <p>Must be set before the work is scheduled</p>
+				 */
+				ENGINE_API void setCancellationToken(const std::shared_ptr<CancellationToken> &token) NOTHROWS;
+
+				/**
+				 * Preempt the work if its cancellation token is canceled (TE_Canceled) or its
+				 * deadline has passed (TE_TimedOut). Workers invoke this immediately before
+				 * starting the work.
+				 *
+				 * @return true if the work will not be run, either because it was preempted
+				 *         or it was already done
+				 */
+				ENGINE_API bool preemptIfExpired() NOTHROWS;
+
 			protected:
 				/**
 				 * Enter working state if first caller.
@@ -114,8 +178,26 @@ namespace TAK {
 				mutable Thread::Monitor monitor_;
 				TAKErr result_code_;
 				unsigned int state_;
+				int priority_;
+				int64_t deadline_;
+				std::shared_ptr<CancellationToken> cancel_token_;
+				// written by an instrumented worker when queued
+				int64_t schedule_time_micros_;
+
+				friend class Impl::WorkerMetricsRecorder;
 			};
 
+			/**
+			 * Push work on to a pending work queue serviced from the front. Work is inserted
+			 * behind all work of equal or higher priority.
+			 *
+			 * @param queue the pending work queue
+			 * @param work  the work
+			 *
+			 * @return TE_Ok on success
+			 */
+			ENGINE_API TAKErr WorkQueue_push(std::deque<std::shared_ptr<Work>> &queue, std::shared_ptr<Work> &&work) NOTHROWS;
+
 			/**
 			 * Work that can have subsequent attached work
 			 */
@@ -160,6 +242,12 @@ namespace TAK {
 			protected:
 				ENGINE_API virtual TAKErr onSignalWork(Thread::MonitorLockPtr &lockPtr) NOTHROWS;
 
+				/**
+				 * Preempts the transferred work if the transfer is preempted or the work could
+				 * not be scheduled, so that anything awaiting it is released.
+				 */
+				ENGINE_API virtual TAKErr onDone(Thread::MonitorLockPtr &lockPtr, TAKErr result) NOTHROWS;
+
 			private:
 				std::shared_ptr<Work> work;
 				std::shared_ptr<Worker> worker;
@@ -281,6 +369,32 @@ namespace TAK {
 			 */
 			ENGINE_API TAKErr Worker_createThreadPool(SharedWorkerPtr &worker, size_t minThreadCount, size_t maxThreadCount, int64_t keepAliveMillis) NOTHROWS;
 
+			/**
+			 * Create a worker backed by a set of threads, each created with the specified
+			 * parameters (e.g. core class or affinity).
+			 *
+			 * @param worker OUT the resulting worker
+			 * @param threadParams the parameters used to create each pool thread
+			 *
+			 * @return TE_Ok on success
+			 */
+			ENGINE_API TAKErr Worker_createThreadPool(SharedWorkerPtr &worker, size_t minThreadCount, size_t maxThreadCount, int64_t keepAliveMillis, const Thread::ThreadCreateParams &threadParams) NOTHROWS;
+
+			/**
+			 * Create a fixed thread pool worker where each thread services its own work deque.
+			 * Work scheduled from one of the pool's threads is pushed on to that thread's deque
+			 * and popped LIFO; work scheduled from any other thread is distributed round-robin.
+			 * Idle threads steal FIFO from the other deques before parking. This avoids the single
+			 * shared queue monitor when many producers and consumers are active at once. Work
+			 * priority is not considered; deadlines and cancellation are.
+			 *
+			 * @param worker OUT the resulting worker
+			 * @param threadCount the number of desired threads
+			 *
+			 * @return TE_Ok on success
+			 */
+			ENGINE_API TAKErr Worker_createWorkStealingThreadPool(SharedWorkerPtr &worker, size_t threadCount) NOTHROWS;
+
 			/**
 			 * Create worker that may be externally controlled
 			 *
@@ -290,6 +404,19 @@ namespace TAK {
 			 */
 			ENGINE_API TAKErr Worker_createControlWorker(std::shared_ptr<ControlWorker> &controlWorker) NOTHROWS;
 
+			/**
+			 * Create worker that may be externally controlled, backed by a lock-free
+			 * multi-producer/single-consumer queue. Scheduling never blocks on the consumer
+			 * and the consumer never blocks on a producer. Work is run in the order scheduled;
+			 * priority is not considered. Only a single thread may drive the worker via
+			 * doAnyWork/doAllWork.
+			 *
+			 * @param worker OUT the resulting worker
+			 *
+			 * @return TE_Ok on success
+			 */
+			ENGINE_API TAKErr Worker_createLockFreeControlWorker(std::shared_ptr<ControlWorker> &controlWorker) NOTHROWS;
+
 			/**
 			 * A thread-pool based worker that can "flex" up and down based on need. It is best to
 			 * use this for tasks that block and wait on things (like IO), or very short lived non-taxing
@@ -306,8 +433,8 @@ namespace TAK {
 			/**
 			 * General purpose Worker for handling more expensive computation type tasks that are
 			 * bound to the CPU and therefore a backlog develops when the CPU (this worker) is busy 
-			 * doing other work. Generally, this is a fixed thread-pool with the same number of threads
-			 * as CPU cores.
+			 * doing other work. Generally, this is a fixed work-stealing thread-pool with the same
+			 * number of threads as CPU cores.
 			 */
 			ENGINE_API const SharedWorkerPtr& GeneralWorkers_cpu() NOTHROWS;
 
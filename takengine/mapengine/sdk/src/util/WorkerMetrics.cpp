@@ -0,0 +1,289 @@
+#include "util/WorkerMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <sstream>
+
+#include "thread/Lock.h"
+#include "util/impl/WorkerMetricsImpl.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util::Impl;
+
+namespace
+{
+    struct RecorderRegistry
+    {
+        Mutex mutex;
+        std::list<std::weak_ptr<WorkerMetricsRecorder>> recorders;
+    };
+
+    std::atomic<bool> &enabled() NOTHROWS
+    {
+        static std::atomic<bool> e(false);
+        return e;
+    }
+    RecorderRegistry &recorders() NOTHROWS
+    {
+        static RecorderRegistry r;
+        return r;
+    }
+    int64_t now_micros() NOTHROWS
+    {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+    std::size_t bucketOf(uint64_t sample) NOTHROWS
+    {
+        std::size_t bucket = 0u;
+        while (sample && bucket < (WorkerHistogram::NumBuckets - 1u)) {
+            sample >>= 1u;
+            bucket++;
+        }
+        return bucket;
+    }
+    template<class Fn>
+    void visitLive(Fn fn) NOTHROWS
+    {
+        RecorderRegistry &r = recorders();
+        Lock lock(r.mutex);
+        if (lock.status != TE_Ok)
+            return;
+        for (auto it = r.recorders.begin(); it != r.recorders.end();) {
+            std::shared_ptr<WorkerMetricsRecorder> recorder(it->lock());
+            if (!recorder) {
+                it = r.recorders.erase(it);
+                continue;
+            }
+            fn(*recorder);
+            it++;
+        }
+    }
+}
+
+WorkerHistogram::WorkerHistogram() NOTHROWS :
+    count(0u),
+    sum(0u),
+    max(0u)
+{
+    std::fill(buckets, buckets + NumBuckets, 0u);
+}
+
+WorkerMetricsSnapshot::WorkerMetricsSnapshot() NOTHROWS :
+    workerId(0u),
+    scheduled(0u),
+    completed(0u),
+    rejected(0u),
+    preempted(0u)
+{}
+
+void TAK::Engine::Util::WorkerMetrics_setEnabled(const bool e) NOTHROWS
+{
+    enabled() = e;
+}
+bool TAK::Engine::Util::WorkerMetrics_isEnabled() NOTHROWS
+{
+    return enabled();
+}
+TAKErr TAK::Engine::Util::WorkerMetrics_setName(const Worker &worker, const char *name) NOTHROWS
+{
+    const uint64_t id = Worker_getWorkerId(worker);
+    bool found = false;
+    visitLive([&](WorkerMetricsRecorder &recorder)
+    {
+        if (recorder.getWorkerId() == id) {
+            recorder.setName(name);
+            found = true;
+        }
+    });
+    return found ? TE_Ok : TE_InvalidArg;
+}
+TAKErr TAK::Engine::Util::WorkerMetrics_snapshot(Collection<std::shared_ptr<WorkerMetricsSnapshot>> &value) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    visitLive([&](WorkerMetricsRecorder &recorder)
+    {
+        std::shared_ptr<WorkerMetricsSnapshot> snapshot(new(std::nothrow) WorkerMetricsSnapshot());
+        if (!snapshot) {
+            code = TE_OutOfMemory;
+            return;
+        }
+        recorder.snapshot(*snapshot);
+        const TAKErr addCode = value.add(snapshot);
+        if (addCode != TE_Ok)
+            code = addCode;
+    });
+    return code;
+}
+TAKErr TAK::Engine::Util::WorkerMetrics_reset() NOTHROWS
+{
+    visitLive([](WorkerMetricsRecorder &recorder)
+    {
+        recorder.reset();
+    });
+    return TE_Ok;
+}
+
+// AtomicHistogram
+
+AtomicHistogram::AtomicHistogram() NOTHROWS
+{
+    reset();
+}
+void AtomicHistogram::record(const uint64_t sample) NOTHROWS
+{
+    buckets[bucketOf(sample)].fetch_add(1u, std::memory_order_relaxed);
+    count.fetch_add(1u, std::memory_order_relaxed);
+    sum.fetch_add(sample, std::memory_order_relaxed);
+    uint64_t m = max.load(std::memory_order_relaxed);
+    while (sample > m && !max.compare_exchange_weak(m, sample, std::memory_order_relaxed))
+        ;
+}
+void AtomicHistogram::get(WorkerHistogram &value) const NOTHROWS
+{
+    for (std::size_t i = 0u; i < WorkerHistogram::NumBuckets; i++)
+        value.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    value.count = count.load(std::memory_order_relaxed);
+    value.sum = sum.load(std::memory_order_relaxed);
+    value.max = max.load(std::memory_order_relaxed);
+}
+void AtomicHistogram::reset() NOTHROWS
+{
+    for (std::size_t i = 0u; i < WorkerHistogram::NumBuckets; i++)
+        buckets[i].store(0u, std::memory_order_relaxed);
+    count.store(0u, std::memory_order_relaxed);
+    sum.store(0u, std::memory_order_relaxed);
+    max.store(0u, std::memory_order_relaxed);
+}
+
+// WorkerMetricsRecorder
+
+WorkerMetricsRecorder::WorkerMetricsRecorder() NOTHROWS :
+    workerId(0u),
+    depth(0),
+    scheduled(0u),
+    completed(0u),
+    rejected(0u),
+    preempted(0u)
+{}
+void WorkerMetricsRecorder::setWorkerId(const uint64_t id) NOTHROWS
+{
+    workerId = id;
+}
+uint64_t WorkerMetricsRecorder::getWorkerId() const NOTHROWS
+{
+    return workerId;
+}
+void WorkerMetricsRecorder::setName(const char *name_) NOTHROWS
+{
+    Lock lock(nameMutex);
+    name = name_;
+}
+void WorkerMetricsRecorder::snapshot(WorkerMetricsSnapshot &value) const NOTHROWS
+{
+    value.workerId = workerId;
+    {
+        Lock lock(nameMutex);
+        if (name.get()) {
+            value.name = name;
+        } else {
+            std::ostringstream strm;
+            strm << "worker-" << value.workerId;
+            value.name = strm.str().c_str();
+        }
+    }
+    queueLatency.get(value.queueLatency);
+    runTime.get(value.runTime);
+    queueDepth.get(value.queueDepth);
+    value.scheduled = scheduled;
+    value.completed = completed;
+    value.rejected = rejected;
+    value.preempted = preempted;
+}
+void WorkerMetricsRecorder::reset() NOTHROWS
+{
+    queueLatency.reset();
+    runTime.reset();
+    queueDepth.reset();
+    scheduled = 0u;
+    completed = 0u;
+    rejected = 0u;
+    preempted = 0u;
+}
+void WorkerMetricsRecorder::recordScheduled(Work &work) NOTHROWS
+{
+    // depth is always tracked so that it is correct when metrics are enabled
+    // with work already pending
+    const int64_t d = depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (!enabled().load(std::memory_order_relaxed)) {
+        work.schedule_time_micros_ = 0;
+        return;
+    }
+    work.schedule_time_micros_ = now_micros();
+    scheduled.fetch_add(1u, std::memory_order_relaxed);
+    queueDepth.record(d > 0 ? static_cast<uint64_t>(d) : 0u);
+}
+void WorkerMetricsRecorder::recordRejected() NOTHROWS
+{
+    if (enabled().load(std::memory_order_relaxed))
+        rejected.fetch_add(1u, std::memory_order_relaxed);
+}
+void WorkerMetricsRecorder::recordPreempted() NOTHROWS
+{
+    depth.fetch_sub(1, std::memory_order_relaxed);
+    if (enabled().load(std::memory_order_relaxed))
+        preempted.fetch_add(1u, std::memory_order_relaxed);
+}
+int64_t WorkerMetricsRecorder::recordStarted(const Work &work) NOTHROWS
+{
+    depth.fetch_sub(1, std::memory_order_relaxed);
+    if (!enabled().load(std::memory_order_relaxed))
+        return 0;
+    const int64_t started = now_micros();
+    // work that bypassed `recordScheduled` has no queue time
+    if (work.schedule_time_micros_)
+        queueLatency.record(static_cast<uint64_t>(std::max(started - work.schedule_time_micros_, (int64_t)0)));
+    return started;
+}
+void WorkerMetricsRecorder::recordFinished(const int64_t started) NOTHROWS
+{
+    // metrics were disabled when the work started
+    if (!started)
+        return;
+    runTime.record(static_cast<uint64_t>(std::max(now_micros() - started, (int64_t)0)));
+    completed.fetch_add(1u, std::memory_order_relaxed);
+}
+
+std::shared_ptr<WorkerMetricsRecorder> TAK::Engine::Util::Impl::WorkerMetrics_createRecorder(const char *name) NOTHROWS
+{
+    std::shared_ptr<WorkerMetricsRecorder> recorder(new(std::nothrow) WorkerMetricsRecorder());
+    if (!recorder)
+        return recorder;
+    if (name)
+        recorder->setName(name);
+
+    RecorderRegistry &r = recorders();
+    Lock lock(r.mutex);
+    TAKErr code(lock.status);
+    TE_BEGIN_TRAP() {
+        if (code == TE_Ok)
+            r.recorders.push_back(recorder);
+    } TE_END_TRAP(code);
+    if (code != TE_Ok)
+        recorder.reset();
+    return recorder;
+}
+void TAK::Engine::Util::Impl::WorkerMetrics_run(Work &work, WorkerMetricsRecorder *metrics) NOTHROWS
+{
+    if (!metrics) {
+        work.signalWork();
+        return;
+    }
+    const int64_t started = metrics->recordStarted(work);
+    work.signalWork();
+    metrics->recordFinished(started);
+}
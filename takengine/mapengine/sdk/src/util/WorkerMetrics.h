@@ -0,0 +1,98 @@
+#ifndef TAK_ENGINE_UTIL_WORKERMETRICS_H_INCLUDED
+#define TAK_ENGINE_UTIL_WORKERMETRICS_H_INCLUDED
+
+#include <cstdint>
+#include <memory>
+
+#include "port/Collection.h"
+#include "port/Platform.h"
+#include "port/String.h"
+#include "util/Error.h"
+#include "util/Work.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Histogram with power-of-two bucket boundaries. Bucket `i`
+             * counts samples in the range `[2^(i-1), 2^i)`; bucket `0`
+             * counts samples of `0`.
+             */
+            struct ENGINE_API WorkerHistogram
+            {
+                enum {
+                    NumBuckets = 32,
+                };
+
+                WorkerHistogram() NOTHROWS;
+
+                uint64_t buckets[NumBuckets];
+                /** total number of samples */
+                uint64_t count;
+                /** sum of all samples */
+                uint64_t sum;
+                /** largest sample */
+                uint64_t max;
+            };
+
+            /**
+             * Point-in-time copy of the metrics recorded for a Worker.
+             */
+            struct ENGINE_API WorkerMetricsSnapshot
+            {
+                WorkerMetricsSnapshot() NOTHROWS;
+
+                /** The name of the worker */
+                Port::String name;
+                /** The ID of the worker, see Worker_getWorkerId */
+                uint64_t workerId;
+                /** Time from scheduling to start of execution, microseconds */
+                WorkerHistogram queueLatency;
+                /** Execution time, microseconds */
+                WorkerHistogram runTime;
+                /** Number of items pending, sampled on each schedule */
+                WorkerHistogram queueDepth;
+                /** Number of items accepted for scheduling */
+                uint64_t scheduled;
+                /** Number of items executed */
+                uint64_t completed;
+                /** Number of items the worker refused to schedule */
+                uint64_t rejected;
+                /** Number of items dropped prior to execution (canceled or expired) */
+                uint64_t preempted;
+            };
+
+            /**
+             * Enables or disables metrics collection. All Workers are
+             * instrumented, including those created statically before
+             * metrics are enabled; samples are only recorded while enabled.
+             * Recording is lock-free. Disabled by default.
+             */
+            ENGINE_API void WorkerMetrics_setEnabled(const bool enabled) NOTHROWS;
+            ENGINE_API bool WorkerMetrics_isEnabled() NOTHROWS;
+
+            /**
+             * Assigns the name that metrics for the worker are reported
+             * under. Workers that are not named are reported as
+             * `worker-<id>`.
+             *
+             * @return  TE_Ok on success, TE_InvalidArg if the worker is not
+             *          instrumented
+             */
+            ENGINE_API TAKErr WorkerMetrics_setName(const Worker &worker, const char *name) NOTHROWS;
+
+            /**
+             * Captures the metrics for all live, instrumented workers.
+             */
+            ENGINE_API TAKErr WorkerMetrics_snapshot(Port::Collection<std::shared_ptr<WorkerMetricsSnapshot>> &value) NOTHROWS;
+
+            /**
+             * Clears the recorded metrics for all live, instrumented
+             * workers.
+             */
+            ENGINE_API TAKErr WorkerMetrics_reset() NOTHROWS;
+        }
+    }
+}
+
+#endif
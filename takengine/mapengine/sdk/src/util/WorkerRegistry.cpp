@@ -0,0 +1,307 @@
+#include "util/WorkerRegistry.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "port/String.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/impl/WorkerMetricsImpl.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util::Impl;
+
+#define NUM_WORKER_CLASSES 3u
+#define CLASS_KEEP_ALIVE_MILLIS (60LL*1000LL)
+
+namespace
+{
+    struct WorkerClassEntry
+    {
+        std::size_t limit {0u};
+        bool coreClassSet {false};
+        ThreadCoreClass coreClass {TECC_Any};
+        SharedWorkerPtr pool;
+    };
+
+    struct Registry
+    {
+        Mutex mutex;
+        WorkerClassEntry classes[NUM_WORKER_CLASSES];
+    };
+
+    Registry &registry() NOTHROWS;
+    std::size_t defaultLimit(const WorkerClass cls) NOTHROWS;
+    ThreadCoreClass defaultCoreClass(const WorkerClass cls) NOTHROWS;
+    TAKErr getClassPool(SharedWorkerPtr &value, std::size_t *limit, const WorkerClass cls) NOTHROWS;
+
+    /**
+     * State shared between a borrowed view and the work it has in flight on
+     * the class pool.
+     */
+    struct LaneState
+    {
+        Mutex mutex;
+        std::deque<std::shared_ptr<Work>> pending;
+        std::size_t active {0u};
+        std::size_t maxConcurrency {1u};
+        SharedWorkerPtr pool;
+        String name;
+        std::shared_ptr<WorkerMetricsRecorder> metrics;
+    };
+
+    /**
+     * Runs a single item from the lane, then re-queues itself at the back of
+     * the class pool if the lane has more work. Re-queuing rather than
+     * draining keeps one busy subsystem from monopolizing the class threads.
+     */
+    class LaneWork : public Work
+    {
+    public :
+        LaneWork(const std::shared_ptr<LaneState> &lane) NOTHROWS;
+        ~LaneWork() NOTHROWS override;
+    protected :
+        TAKErr onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS override;
+    private :
+        std::shared_ptr<LaneState> lane;
+    };
+
+    class BorrowedWorker : public Worker
+    {
+    public :
+        BorrowedWorker(const std::shared_ptr<LaneState> &lane) NOTHROWS;
+        ~BorrowedWorker() NOTHROWS override;
+    public :
+        TAKErr scheduleWork(std::shared_ptr<Work> work) NOTHROWS override;
+    private :
+        std::shared_ptr<LaneState> lane;
+    };
+}
+
+TAKErr TAK::Engine::Util::WorkerRegistry_setConcurrencyLimit(const WorkerClass cls, const std::size_t threadCount) NOTHROWS
+{
+    if (static_cast<std::size_t>(cls) >= NUM_WORKER_CLASSES)
+        return TE_InvalidArg;
+    if (!threadCount)
+        return TE_InvalidArg;
+
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    WorkerClassEntry &entry = r.classes[cls];
+    if (entry.pool)
+        return TE_IllegalState;
+    entry.limit = threadCount;
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::WorkerRegistry_getConcurrencyLimit(std::size_t *value, const WorkerClass cls) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (static_cast<std::size_t>(cls) >= NUM_WORKER_CLASSES)
+        return TE_InvalidArg;
+
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    const WorkerClassEntry &entry = r.classes[cls];
+    *value = entry.limit ? entry.limit : defaultLimit(cls);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::WorkerRegistry_setCoreClass(const WorkerClass cls, const ThreadCoreClass coreClass) NOTHROWS
+{
+    if (static_cast<std::size_t>(cls) >= NUM_WORKER_CLASSES)
+        return TE_InvalidArg;
+
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    WorkerClassEntry &entry = r.classes[cls];
+    if (entry.pool)
+        return TE_IllegalState;
+    entry.coreClass = coreClass;
+    entry.coreClassSet = true;
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::WorkerRegistry_getCoreClass(ThreadCoreClass *value, const WorkerClass cls) NOTHROWS
+{
+    if (!value)
+        return TE_InvalidArg;
+    if (static_cast<std::size_t>(cls) >= NUM_WORKER_CLASSES)
+        return TE_InvalidArg;
+
+    Registry &r = registry();
+    Lock lock(r.mutex);
+    TE_CHECKRETURN_CODE(lock.status);
+
+    const WorkerClassEntry &entry = r.classes[cls];
+    *value = entry.coreClassSet ? entry.coreClass : defaultCoreClass(cls);
+    return TE_Ok;
+}
+TAKErr TAK::Engine::Util::WorkerRegistry_borrow(SharedWorkerPtr &value, const WorkerClass cls, const char *name, const std::size_t maxConcurrency) NOTHROWS
+{
+    TAKErr code(TE_Ok);
+    SharedWorkerPtr pool;
+    std::size_t limit;
+    code = getClassPool(pool, &limit, cls);
+    TE_CHECKRETURN_CODE(code);
+
+    std::shared_ptr<LaneState> lane(new LaneState());
+    lane->pool = pool;
+    lane->maxConcurrency = maxConcurrency ? std::min(maxConcurrency, limit) : limit;
+    lane->name = name;
+    lane->metrics = WorkerMetrics_createRecorder(name);
+
+    value = SharedWorkerPtr(new BorrowedWorker(lane));
+    if (lane->metrics)
+        lane->metrics->setWorkerId(Worker_getWorkerId(*value));
+    return code;
+}
+
+namespace
+{
+    Registry &registry() NOTHROWS
+    {
+        static Registry r;
+        return r;
+    }
+    std::size_t defaultLimit(const WorkerClass cls) NOTHROWS
+    {
+        const std::size_t ncpu = Platform_processorCount();
+        switch (cls) {
+        case TEWC_IO :
+            // IO blocks; oversubscribe the cores, within reason
+            return std::min(std::max(ncpu * 2u, (std::size_t)4u), (std::size_t)16u);
+        case TEWC_CPUDecode :
+            return ncpu;
+        case TEWC_GLPrep :
+            return std::max(ncpu / 2u, (std::size_t)1u);
+        default :
+            return 1u;
+        }
+    }
+    ThreadCoreClass defaultCoreClass(const WorkerClass cls) NOTHROWS
+    {
+        // core classes are applied as hard affinity on Linux; leave placement
+        // to the scheduler unless the application opts in, as pinning decode
+        // to the big cores starves it when they are busy or throttled
+        return TECC_Any;
+    }
+    TAKErr getClassPool(SharedWorkerPtr &value, std::size_t *limit, const WorkerClass cls) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (static_cast<std::size_t>(cls) >= NUM_WORKER_CLASSES)
+            return TE_InvalidArg;
+
+        Registry &r = registry();
+        Lock lock(r.mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+
+        WorkerClassEntry &entry = r.classes[cls];
+        if (!entry.limit)
+            entry.limit = defaultLimit(cls);
+        if (!entry.coreClassSet) {
+            entry.coreClass = defaultCoreClass(cls);
+            entry.coreClassSet = true;
+        }
+        if (!entry.pool) {
+            ThreadCreateParams params;
+            params.coreClass = entry.coreClass;
+            // threads idle out when no subsystem has work for the class
+            code = Worker_createThreadPool(entry.pool, 0u, entry.limit, CLASS_KEEP_ALIVE_MILLIS, params);
+            TE_CHECKRETURN_CODE(code);
+        }
+
+        value = entry.pool;
+        *limit = entry.limit;
+        return code;
+    }
+
+    LaneWork::LaneWork(const std::shared_ptr<LaneState> &lane_) NOTHROWS :
+        lane(lane_)
+    {}
+    LaneWork::~LaneWork() NOTHROWS
+    {}
+    TAKErr LaneWork::onSignalWork(MonitorLockPtr &lockPtr) NOTHROWS
+    {
+        // release the monitor for this work while the lane work runs
+        lockPtr.reset();
+
+        std::shared_ptr<Work> work;
+        while (true) {
+            {
+                Lock lock(lane->mutex);
+                TE_CHECKRETURN_CODE(lock.status);
+                if (lane->pending.empty()) {
+                    lane->active--;
+                    return TE_Ok;
+                }
+                work = std::move(lane->pending.front());
+                lane->pending.pop_front();
+            }
+            // expired work does not consume the slot
+            if (!work->preemptIfExpired())
+                break;
+            if (lane->metrics)
+                lane->metrics->recordPreempted();
+        }
+
+        WorkerMetrics_run(*work, lane->metrics.get());
+        work.reset();
+
+        {
+            Lock lock(lane->mutex);
+            TE_CHECKRETURN_CODE(lock.status);
+            if (lane->pending.empty()) {
+                lane->active--;
+                return TE_Ok;
+            }
+        }
+
+        // more work is pending; retain the slot and go to the back of the class queue
+        if (lane->pool->scheduleWork(std::make_shared<LaneWork>(lane)) != TE_Ok) {
+            Lock lock(lane->mutex);
+            TE_CHECKRETURN_CODE(lock.status);
+            lane->active--;
+        }
+        return TE_Ok;
+    }
+
+    BorrowedWorker::BorrowedWorker(const std::shared_ptr<LaneState> &lane_) NOTHROWS :
+        lane(lane_)
+    {}
+    BorrowedWorker::~BorrowedWorker() NOTHROWS
+    {}
+    TAKErr BorrowedWorker::scheduleWork(std::shared_ptr<Work> work) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (!work)
+            return TE_InvalidArg;
+        {
+            Lock lock(lane->mutex);
+            TE_CHECKRETURN_CODE(lock.status);
+
+            if (lane->metrics)
+                lane->metrics->recordScheduled(*work);
+            code = WorkQueue_push(lane->pending, std::move(work));
+            TE_CHECKRETURN_CODE(code);
+
+            if (lane->active >= lane->maxConcurrency)
+                return TE_Ok;
+            lane->active++;
+        }
+
+        code = lane->pool->scheduleWork(std::make_shared<LaneWork>(lane));
+        if (code != TE_Ok) {
+            Lock lock(lane->mutex);
+            lane->active--;
+        }
+        return code;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef TAK_ENGINE_UTIL_WORKERREGISTRY_H_INCLUDED
+#define TAK_ENGINE_UTIL_WORKERREGISTRY_H_INCLUDED
+
+#include <cstddef>
+
+#include "port/Platform.h"
+#include "thread/Thread.h"
+#include "util/Error.h"
+#include "util/Work.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            /**
+             * Engine-wide classes of work. Each class is backed by a single
+             * shared thread pool whose size reflects the hardware, not the
+             * number of subsystems that are active.
+             */
+            enum WorkerClass
+            {
+                /** Work that blocks on file or network IO */
+                TEWC_IO,
+                /** CPU bound decode, tessellation, mesh building, etc. */
+                TEWC_CPUDecode,
+                /** Preparation of data destined for upload to the GL */
+                TEWC_GLPrep,
+            };
+
+            /**
+             * Sets the global concurrency limit (number of threads) for the
+             * specified worker class. Must be invoked before the class is
+             * first used.
+             *
+             * @param cls           The worker class
+             * @param threadCount   The number of threads backing the class
+             *
+             * @return  TE_Ok on success, TE_IllegalState if the class has
+             *          already been instantiated, TE_InvalidArg if
+             *          `threadCount` is `0`
+             */
+            ENGINE_API TAKErr WorkerRegistry_setConcurrencyLimit(const WorkerClass cls, const std::size_t threadCount) NOTHROWS;
+
+            /**
+             * Returns the global concurrency limit for the specified worker
+             * class.
+             */
+            ENGINE_API TAKErr WorkerRegistry_getConcurrencyLimit(std::size_t *value, const WorkerClass cls) NOTHROWS;
+
+            /**
+             * Sets the core class that the threads backing the specified
+             * worker class prefer. Must be invoked before the class is first
+             * used. By default, no class has a preference; as the platform
+             * may only honor a preference by restricting affinity, a class
+             * should only be confined where the application knows the
+             * topology and load of the device.
+             *
+             * @return  TE_Ok on success, TE_IllegalState if the class has
+             *          already been instantiated
+             */
+            ENGINE_API TAKErr WorkerRegistry_setCoreClass(const WorkerClass cls, const Thread::ThreadCoreClass coreClass) NOTHROWS;
+
+            /**
+             * Returns the core class that the threads backing the specified
+             * worker class prefer.
+             */
+            ENGINE_API TAKErr WorkerRegistry_getCoreClass(Thread::ThreadCoreClass *value, const WorkerClass cls) NOTHROWS;
+
+            /**
+             * Borrows a view of the shared pool for the specified worker
+             * class. Work scheduled on the returned worker is run on the
+             * shared pool threads with at most `maxConcurrency` items from
+             * this view in flight at any time; excess work is queued
+             * against the view in priority order. A view that has no
+             * outstanding work does not hold any threads.
+             *
+             * @param value             Returns the worker
+             * @param cls               The worker class to borrow from
+             * @param name              The name of the borrowing subsystem
+             * @param maxConcurrency    The maximum number of work items from
+             *                          the view that may execute at once. If
+             *                          `0`, the class concurrency limit is
+             *                          used.
+             *
+             * @return  TE_Ok on success, various codes on failure
+             */
+            ENGINE_API TAKErr WorkerRegistry_borrow(SharedWorkerPtr &value, const WorkerClass cls, const char *name, const std::size_t maxConcurrency) NOTHROWS;
+        }
+    }
+}
+
+#endif
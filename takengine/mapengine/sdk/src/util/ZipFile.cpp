@@ -1,7 +1,16 @@
 
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "cpl_minizip_unzip.h" // get a few definitions for unzip
 #include "util/ZipFile.h"
+#include "thread/Lock.h"
+#include "thread/Mutex.h"
+#include "util/IO2.h"
 #include "util/Memory.h"
 #include "port/STLVectorAdapter.h"
 
@@ -57,6 +66,407 @@ extern "C" {
 using namespace TAK::Engine::Util;
 using namespace TAK::Engine;
 
+using namespace TAK::Engine::Thread;
+
+namespace
+{
+    /** maximum number of archive indices retained by the cache */
+    const std::size_t MaxCachedArchives = 8u;
+
+    uint16_t readLE16(const uint8_t *p) NOTHROWS
+    {
+        return (uint16_t)(p[0] | (p[1] << 8u));
+    }
+    uint32_t readLE32(const uint8_t *p) NOTHROWS
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8u) | ((uint32_t)p[2] << 16u) | ((uint32_t)p[3] << 24u);
+    }
+
+    TAKErr correctEntryPath(std::string &value, const char *path) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (!path)
+            return TE_InvalidArg;
+        TE_BEGIN_TRAP() {
+            value = path;
+        } TE_END_TRAP(code);
+        TE_CHECKRETURN_CODE(code);
+        for (size_t i = 0; i < value.length(); ++i) {
+            if (value[i] == '\\')
+                value[i] = '/';
+        }
+        return code;
+    }
+
+    struct ZipEntry
+    {
+        uint32_t localHeaderOffset;
+        uint32_t compressedSize;
+        uint32_t uncompressedSize;
+        uint16_t method;
+        uint16_t flags;
+    };
+
+    /**
+     * Memory mapped archive with a hashed index of its central directory.
+     * Instances are immutable once opened and may be shared between
+     * threads.
+     */
+    class ZipIndex
+    {
+    public :
+        ZipIndex() NOTHROWS;
+    public :
+        /**
+         * @return  TE_Ok on success, TE_Unsupported if the archive
+         *          requires ZIP64 extensions, TE_InvalidArg if the file
+         *          is not a valid archive
+         */
+        TAKErr open(const char *path) NOTHROWS;
+        /** @return the entry or `nullptr` if no such entry exists */
+        const ZipEntry *find(const char *entryPath) const NOTHROWS;
+        /** Returns the (possibly compressed) content of the entry */
+        TAKErr getContent(const uint8_t **value, const ZipEntry &entry) const NOTHROWS;
+    public :
+        MappedFileInput2 archive;
+        const uint8_t *data;
+        std::size_t length;
+        int64_t lastModified;
+        /** entries, in central directory order */
+        std::vector<std::pair<std::string, ZipEntry>> entries;
+        std::unordered_map<std::string, std::size_t> lookup;
+    };
+
+    ZipIndex::ZipIndex() NOTHROWS :
+        data(nullptr),
+        length(0u),
+        lastModified(0LL)
+    {}
+    TAKErr ZipIndex::open(const char *path) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        code = IO_getLastModified(&lastModified, path);
+        TE_CHECKRETURN_CODE(code);
+        code = archive.open(path, TEMA_Random);
+        TE_CHECKRETURN_CODE(code);
+        code = archive.getData(&data);
+        TE_CHECKRETURN_CODE(code);
+        length = (std::size_t)archive.length();
+
+        const std::size_t eocdLen = 22u;
+        if (length < eocdLen)
+            return TE_InvalidArg;
+
+        // find the end of central directory record, which is followed by a
+        // variable length comment
+        const uint8_t *eocd = nullptr;
+        std::size_t searchLimit = eocdLen + 0xFFFFu;
+        if (searchLimit > length)
+            searchLimit = length;
+        for (std::size_t i = eocdLen; i <= searchLimit; i++) {
+            const uint8_t *p = data + (length - i);
+            if (readLE32(p) == 0x06054b50u) {
+                eocd = p;
+                break;
+            }
+        }
+        if (!eocd)
+            return TE_InvalidArg;
+
+        const std::size_t numEntries = readLE16(eocd + 10u);
+        const uint32_t cdOffset = readLE32(eocd + 16u);
+        if (cdOffset == 0xFFFFFFFFu || numEntries == 0xFFFFu)
+            return TE_Unsupported;
+
+        TE_BEGIN_TRAP() {
+            entries.reserve(numEntries);
+            lookup.reserve(numEntries);
+            std::size_t pos = cdOffset;
+            for (std::size_t i = 0u; i < numEntries; i++) {
+                if (pos + 46u > length || readLE32(data + pos) != 0x02014b50u) {
+                    code = TE_InvalidArg;
+                    break;
+                }
+                const uint8_t *cdh = data + pos;
+                const std::size_t nameLen = readLE16(cdh + 28u);
+                const std::size_t extraLen = readLE16(cdh + 30u);
+                const std::size_t commentLen = readLE16(cdh + 32u);
+                if (pos + 46u + nameLen > length) {
+                    code = TE_InvalidArg;
+                    break;
+                }
+
+                ZipEntry entry;
+                entry.flags = readLE16(cdh + 8u);
+                entry.method = readLE16(cdh + 10u);
+                entry.compressedSize = readLE32(cdh + 20u);
+                entry.uncompressedSize = readLE32(cdh + 24u);
+                entry.localHeaderOffset = readLE32(cdh + 42u);
+                if (entry.compressedSize == 0xFFFFFFFFu || entry.uncompressedSize == 0xFFFFFFFFu || entry.localHeaderOffset == 0xFFFFFFFFu) {
+                    code = TE_Unsupported;
+                    break;
+                }
+
+                entries.push_back(std::make_pair(std::string(reinterpret_cast<const char *>(cdh + 46u), nameLen), entry));
+                // first entry wins for duplicate names, consistent with minizip
+                lookup.insert(std::make_pair(entries.back().first, entries.size() - 1u));
+                pos += 46u + nameLen + extraLen + commentLen;
+            }
+        } TE_END_TRAP(code);
+        return code;
+    }
+    const ZipEntry *ZipIndex::find(const char *entryPath) const NOTHROWS
+    {
+        std::string corrected;
+        if (correctEntryPath(corrected, entryPath) != TE_Ok)
+            return nullptr;
+        auto it = lookup.find(corrected);
+        if (it != lookup.end())
+            return &entries[it->second].second;
+#ifdef _WIN32
+        // minizip matches without regard to case on Windows
+        for (auto e = entries.begin(); e != entries.end(); e++) {
+            if (_stricmp(e->first.c_str(), corrected.c_str()) == 0)
+                return &e->second;
+        }
+#endif
+        return nullptr;
+    }
+    TAKErr ZipIndex::getContent(const uint8_t **value, const ZipEntry &entry) const NOTHROWS
+    {
+        // the local header carries its own name and extra field lengths
+        const std::size_t localOffset = entry.localHeaderOffset;
+        if (localOffset + 30u > length || readLE32(data + localOffset) != 0x04034b50u)
+            return TE_InvalidArg;
+        const std::size_t dataOffset = localOffset + 30u + readLE16(data + localOffset + 26u) + readLE16(data + localOffset + 28u);
+        if (dataOffset + entry.compressedSize > length)
+            return TE_InvalidArg;
+        *value = data + dataOffset;
+        return TE_Ok;
+    }
+
+    /**
+     * Recently opened archive indices, most recent first. Entries are
+     * revalidated against the file's modification time and length on
+     * lookup.
+     */
+    struct ZipIndexCache
+    {
+        Mutex mutex;
+        std::list<std::pair<std::string, std::shared_ptr<const ZipIndex>>> archives;
+    };
+
+    ZipIndexCache &indexCache() NOTHROWS
+    {
+        static ZipIndexCache cache;
+        return cache;
+    }
+
+    TAKErr ZipIndex_get(std::shared_ptr<const ZipIndex> &value, const char *path) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        if (!path)
+            return TE_InvalidArg;
+
+        int64_t lastModified;
+        int64_t length;
+        code = IO_getLastModified(&lastModified, path);
+        TE_CHECKRETURN_CODE(code);
+        code = IO_length(&length, path);
+        TE_CHECKRETURN_CODE(code);
+
+        ZipIndexCache &cache = indexCache();
+        {
+            Lock lock(cache.mutex);
+            TE_CHECKRETURN_CODE(lock.status);
+            for (auto it = cache.archives.begin(); it != cache.archives.end(); it++) {
+                if (it->first != path)
+                    continue;
+                if (it->second->lastModified == lastModified && (int64_t)it->second->length == length) {
+                    value = it->second;
+                    cache.archives.splice(cache.archives.begin(), cache.archives, it);
+                    return TE_Ok;
+                }
+                // stale
+                cache.archives.erase(it);
+                break;
+            }
+        }
+
+        // build outside of the lock; concurrent opens of the same archive
+        // may each build an index, the last one wins
+        std::shared_ptr<ZipIndex> index;
+        TE_BEGIN_TRAP() {
+            index = std::make_shared<ZipIndex>();
+        } TE_END_TRAP(code);
+        TE_CHECKRETURN_CODE(code);
+        code = index->open(path);
+        TE_CHECKRETURN_CODE(code);
+
+        Lock lock(cache.mutex);
+        TE_CHECKRETURN_CODE(lock.status);
+        TE_BEGIN_TRAP() {
+            for (auto it = cache.archives.begin(); it != cache.archives.end(); it++) {
+                if (it->first == path) {
+                    cache.archives.erase(it);
+                    break;
+                }
+            }
+            cache.archives.push_front(std::make_pair(std::string(path), index));
+            if (cache.archives.size() > MaxCachedArchives)
+                cache.archives.pop_back();
+        } TE_END_TRAP(code);
+        value = index;
+        return TE_Ok;
+    }
+
+    /**
+     * Stored entry content, accessed in place within the mapped archive.
+     */
+    class StoredEntryInput : public MemoryInput2
+    {
+    public :
+        StoredEntryInput(const std::shared_ptr<const ZipIndex> &archive_) NOTHROWS :
+            archive(archive_)
+        {}
+        TAKErr close() NOTHROWS override
+        {
+            const TAKErr code = MemoryInput2::close();
+            archive.reset();
+            return code;
+        }
+    private :
+        std::shared_ptr<const ZipIndex> archive;
+    };
+
+    /**
+     * Deflated entry content, inflated on read directly from the mapped
+     * archive.
+     */
+    class DeflatedEntryInput : public DataInput2
+    {
+    public :
+        DeflatedEntryInput(const std::shared_ptr<const ZipIndex> &archive_) NOTHROWS :
+            archive(archive_),
+            initialized(false),
+            finished(false),
+            uncompressedSize(0LL)
+        {
+            memset(&stream, 0, sizeof(stream));
+        }
+        ~DeflatedEntryInput() NOTHROWS override
+        {
+            close();
+        }
+        TAKErr open(const uint8_t *content, const ZipEntry &entry) NOTHROWS
+        {
+            stream.next_in = const_cast<Bytef *>(content);
+            stream.avail_in = entry.compressedSize;
+            // raw deflate; the archive carries no zlib header
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+                return TE_Err;
+            initialized = true;
+            uncompressedSize = entry.uncompressedSize;
+            return TE_Ok;
+        }
+        TAKErr close() NOTHROWS override
+        {
+            if (initialized) {
+                inflateEnd(&stream);
+                initialized = false;
+            }
+            archive.reset();
+            return TE_Ok;
+        }
+        TAKErr read(uint8_t *buf, std::size_t *numRead, const std::size_t len) NOTHROWS override
+        {
+            if (!initialized)
+                return TE_IllegalState;
+            if (finished) {
+                if (numRead)
+                    *numRead = 0u;
+                return len ? TE_EOF : TE_Ok;
+            }
+            stream.next_out = buf;
+            stream.avail_out = (uInt)len;
+            while (stream.avail_out) {
+                const int result = inflate(&stream, Z_NO_FLUSH);
+                if (result == Z_STREAM_END) {
+                    finished = true;
+                    break;
+                } else if (result != Z_OK) {
+                    return TE_IO;
+                }
+            }
+            const std::size_t n = len - stream.avail_out;
+            if (numRead)
+                *numRead = n;
+            return (!n && len) ? TE_EOF : TE_Ok;
+        }
+        TAKErr readByte(uint8_t *value) NOTHROWS override
+        {
+            std::size_t n;
+            TAKErr code = read(value, &n, 1u);
+            TE_CHECKRETURN_CODE(code);
+            return n ? TE_Ok : TE_EOF;
+        }
+        TAKErr skip(const std::size_t n) NOTHROWS override
+        {
+            uint8_t scratch[4096u];
+            std::size_t remaining = n;
+            while (remaining) {
+                std::size_t numRead;
+                TAKErr code = read(scratch, &numRead, std::min(remaining, sizeof(scratch)));
+                TE_CHECKRETURN_CODE(code);
+                remaining -= numRead;
+            }
+            return TE_Ok;
+        }
+        int64_t length() const NOTHROWS override
+        {
+            return uncompressedSize;
+        }
+    private :
+        std::shared_ptr<const ZipIndex> archive;
+        z_stream stream;
+        bool initialized;
+        bool finished;
+        int64_t uncompressedSize;
+    };
+
+    TAKErr openIndexedEntry(DataInput2Ptr &value, const std::shared_ptr<const ZipIndex> &archive, const char *entryPath) NOTHROWS
+    {
+        TAKErr code(TE_Ok);
+        const ZipEntry *entry = archive->find(entryPath);
+        if (!entry)
+            return TE_Done;
+        if (entry->flags & 0x1u)
+            return TE_Unsupported;
+        const uint8_t *content;
+        code = archive->getContent(&content, *entry);
+        TE_CHECKRETURN_CODE(code);
+
+        if (entry->method == 0u && entry->compressedSize == entry->uncompressedSize) {
+            std::unique_ptr<StoredEntryInput> result(new(std::nothrow) StoredEntryInput(archive));
+            if (!result)
+                return TE_OutOfMemory;
+            code = result->open(content, entry->compressedSize);
+            TE_CHECKRETURN_CODE(code);
+            value = DataInput2Ptr(result.release(), Memory_deleter_const<DataInput2, StoredEntryInput>);
+        } else if (entry->method == Z_DEFLATED) {
+            std::unique_ptr<DeflatedEntryInput> result(new(std::nothrow) DeflatedEntryInput(archive));
+            if (!result)
+                return TE_OutOfMemory;
+            code = result->open(content, *entry);
+            TE_CHECKRETURN_CODE(code);
+            value = DataInput2Ptr(result.release(), Memory_deleter_const<DataInput2, DeflatedEntryInput>);
+        } else {
+            return TE_Unsupported;
+        }
+        return code;
+    }
+}
+
 //
 // ZipFile::Impl
 //
@@ -72,20 +482,41 @@ struct ZipFile::Impl {
             libkml_unzClose(handle);
     }
 
-    TAKErr open(const char *path) NOTHROWS {
-        handle = libkml_unzOpen(path);
+    TAKErr open(const char *path_) NOTHROWS {
+        TAKErr code(TE_Ok);
+        TE_BEGIN_TRAP() {
+            path = path_;
+        } TE_END_TRAP(code);
+        TE_CHECKRETURN_CODE(code);
+
+        // entry lookups are serviced by the index. The minizip handle is
+        // only required to iterate or to read entries the index does not
+        // support, and is opened on first use
+        if (ZipIndex_get(index, path_) == TE_Ok)
+            return TE_Ok;
+        return openHandle();
+    }
+
+    TAKErr openHandle() NOTHROWS {
+        if (handle)
+            return TE_Ok;
+        handle = libkml_unzOpen(path.c_str());
         if (!handle)
             return TE_InvalidArg;
         return TE_Ok;
     }
 
     TAKErr gotoFirstEntry() NOTHROWS {
+        TAKErr code = openHandle();
+        TE_CHECKRETURN_CODE(code);
         if (libkml_unzGoToFirstFile(handle) != UNZ_OK)
             return TE_Err;
         return TE_Ok;
     }
 
     TAKErr gotoNextEntry() NOTHROWS {
+        TAKErr code = openHandle();
+        TE_CHECKRETURN_CODE(code);
         int result = libkml_unzGoToNextFile(handle);
         if (result == UNZ_END_OF_LIST_OF_FILE)
             return TE_Done;
@@ -98,18 +529,16 @@ struct ZipFile::Impl {
 
         TAKErr code(TE_Ok);
         std::string corrected;
+        code = correctEntryPath(corrected, path);
+        TE_CHECKRETURN_CODE(code);
 
-        TE_BEGIN_TRAP() {
-            corrected = path;
-        } TE_END_TRAP(code);
+        // avoid the linear search by minizip for entries that do not exist
+        if (index && !index->find(corrected.c_str()))
+            return TE_Done;
 
+        code = openHandle();
         TE_CHECKRETURN_CODE(code);
 
-        for (size_t i = 0; i < corrected.length(); ++i) {
-            if (corrected[i] == '\\')
-                corrected[i] = '/';
-        }
-
         int result = libkml_unzLocateFile(handle, corrected.c_str(), 0);
         if (result == UNZ_END_OF_LIST_OF_FILE)
             return TE_Done;
@@ -120,7 +549,9 @@ struct ZipFile::Impl {
         return TE_Ok;
     }
 
-	TAKErr getGlobInfo(unz_global_info &globInfo) const NOTHROWS {
+	TAKErr getGlobInfo(unz_global_info &globInfo) NOTHROWS {
+        TAKErr code = openHandle();
+        TE_CHECKRETURN_CODE(code);
 		int result = libkml_unzGetGlobalInfo(handle,
 			&globInfo);
 		if (result != UNZ_OK)
@@ -130,6 +561,8 @@ struct ZipFile::Impl {
 	}
 
     TAKErr getCurrentInfo(libkml_unz_file_info &fileInfo) const NOTHROWS {
+        if (!handle)
+            return TE_IllegalState;
         int result = libkml_unzGetCurrentFileInfo(handle,
             &fileInfo,
             nullptr,
@@ -146,6 +579,8 @@ struct ZipFile::Impl {
     }
 
     TAKErr getCurrentEntryPath(Port::String &out) const NOTHROWS {
+        if (!handle)
+            return TE_IllegalState;
         libkml_unz_file_info fileInfo;
         int result = libkml_unzGetCurrentFileInfo(handle,
             &fileInfo,
@@ -185,6 +620,8 @@ struct ZipFile::Impl {
     }
 
     TAKErr openCurrentEntry() NOTHROWS {
+        if (!handle)
+            return TE_IllegalState;
         int result = libkml_unzOpenCurrentFile(handle);
         if (result != UNZ_OK)
             return TE_IO;
@@ -193,6 +630,9 @@ struct ZipFile::Impl {
 
     TAKErr read(void *dst, size_t &resultRead, size_t byteCount) NOTHROWS {
 
+        if (!handle)
+            return TE_IllegalState;
+
         size_t left = byteCount;
         TAKErr code = TE_Ok;
         auto *pos = static_cast<uint8_t *>(dst);
@@ -224,12 +664,18 @@ struct ZipFile::Impl {
     }
 
     TAKErr closeCurrentEntry() NOTHROWS {
-        int result = libkml_unzClose(handle);
+        if (!handle)
+            return TE_IllegalState;
+        int result = libkml_unzCloseCurrentFile(handle);
         if (result != UNZ_OK)
             return TE_IO;
         return TE_Ok;
     }
     
+public:
+    std::string path;
+    /** central directory index; `nullptr` if the archive could not be indexed */
+    std::shared_ptr<const ZipIndex> index;
 private:
     unzFile handle;
 };
@@ -266,7 +712,108 @@ ZipFile::~ZipFile() NOTHROWS {
     delete impl;
 }
 
+TAKErr ZipFile::listEntries(Port::Collection<Port::String> &value, const char *path, bool(*filter)(const char *file)) const NOTHROWS {
+    TAKErr code(TE_Ok);
+    std::string prefix;
+    if (path) {
+        code = correctEntryPath(prefix, path);
+        TE_CHECKRETURN_CODE(code);
+        if (prefix == ".")
+            prefix.clear();
+        else if (!prefix.empty() && prefix.back() != '/')
+            prefix.push_back('/');
+    }
+
+    if (impl->index) {
+        const auto &entries = impl->index->entries;
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            const char *entryPath = it->first.c_str();
+            // entries under the directory, excluding the directory itself
+            if (it->first.size() == prefix.size() || it->first.compare(0, prefix.size(), prefix) != 0)
+                continue;
+            if (!filter || filter(entryPath)) {
+                code = value.add(entryPath);
+                TE_CHECKBREAK_CODE(code);
+            }
+        }
+        return code;
+    }
+
+    // not indexed; iterate a separate handle so the cursor of this
+    // instance is not disturbed
+    ZipFilePtr iter(nullptr, nullptr);
+    code = ZipFile::open(iter, impl->path.c_str());
+    TE_CHECKRETURN_CODE(code);
+    code = iter->gotoFirstEntry();
+    TE_CHECKRETURN_CODE(code);
+    do {
+        Port::String entryPath;
+        code = iter->getCurrentEntryPath(entryPath);
+        TE_CHECKBREAK_CODE(code);
+        if (strlen(entryPath.get()) == prefix.size() || strncmp(entryPath.get(), prefix.c_str(), prefix.size()) != 0)
+            continue;
+        if (!filter || filter(entryPath.get())) {
+            code = value.add(entryPath);
+            TE_CHECKBREAK_CODE(code);
+        }
+    } while ((code = iter->gotoNextEntry()) == TE_Ok);
+    return code == TE_Done ? TE_Ok : code;
+}
+
+TAKErr ZipFile::openEntry(DataInput2Ptr &dataInputPtr, const char *entryPath) const NOTHROWS {
+    if (!entryPath)
+        return TE_InvalidArg;
+    if (impl->index) {
+        TAKErr code = openIndexedEntry(dataInputPtr, impl->index, entryPath);
+        if (code != TE_Unsupported)
+            return code;
+    }
+
+    // compression method not handled by the index; read via minizip
+    ZipFilePtr zipPtr(nullptr, nullptr);
+    int64_t len(-1LL);
+    TAKErr code = ZipFile::open(zipPtr, impl->path.c_str());
+    TE_CHECKRETURN_CODE(code);
+
+    code = zipPtr->gotoEntry(entryPath);
+    TE_CHECKRETURN_CODE(code);
+
+    code = zipPtr->openCurrentEntry();
+    TE_CHECKRETURN_CODE(code);
+
+    code = zipPtr->getCurrentEntryUncompressedSize(len);
+    TE_CHECKRETURN_CODE(code);
+
+    dataInputPtr = DataInput2Ptr(new (std::nothrow) ZipFileDataInput2(std::move(zipPtr), len), Memory_deleter_const<DataInput2, ZipFileDataInput2>);
+    if (!dataInputPtr)
+        return TE_OutOfMemory;
+    return code;
+}
+
+TAKErr ZipFile::getEntryUncompressedSize(int64_t &size, const char *entryPath) const NOTHROWS {
+    if (!entryPath)
+        return TE_InvalidArg;
+    if (impl->index) {
+        const ZipEntry *entry = impl->index->find(entryPath);
+        if (!entry)
+            return TE_Done;
+        size = entry->uncompressedSize;
+        return TE_Ok;
+    }
+
+    ZipFilePtr zipPtr(nullptr, nullptr);
+    TAKErr code = ZipFile::open(zipPtr, impl->path.c_str());
+    TE_CHECKRETURN_CODE(code);
+    code = zipPtr->gotoEntry(entryPath);
+    TE_CHECKRETURN_CODE(code);
+    return zipPtr->getCurrentEntryUncompressedSize(size);
+}
+
 TAKErr ZipFile::getNumEntries(size_t &numEntries) NOTHROWS {
+    if (impl->index) {
+        numEntries = impl->index->entries.size();
+        return TE_Ok;
+    }
 	unz_global_info globInfo;
 	TAKErr code = impl->getGlobInfo(globInfo);
 	if (code == TE_Ok) {
@@ -325,22 +872,10 @@ ZipFileDataInput2::~ZipFileDataInput2() NOTHROWS
 TAKErr ZipFileDataInput2::open(DataInput2Ptr &outPtr, const char *zipFile, const char *zipEntry) NOTHROWS {
 
     ZipFilePtr zipPtr(nullptr, nullptr);
-    int64_t len(-1LL);
     TAKErr code = ZipFile::open(zipPtr, zipFile);
     TE_CHECKRETURN_CODE(code);
 
-    code = zipPtr->gotoEntry(zipEntry);
-    TE_CHECKRETURN_CODE(code);
-
-    code = zipPtr->openCurrentEntry();
-    TE_CHECKRETURN_CODE(code);
-
-    code = zipPtr->getCurrentEntryUncompressedSize(len);
-    TE_CHECKRETURN_CODE(code);
-
-    outPtr = DataInput2Ptr(new (std::nothrow) ZipFileDataInput2(std::move(zipPtr), len), Memory_deleter_const<DataInput2, ZipFileDataInput2>);
-
-    return code;
+    return zipPtr->openEntry(outPtr, zipEntry);
 }
 
 TAKErr ZipFileDataInput2::close() NOTHROWS {
@@ -17,7 +17,18 @@ namespace TAK {
             typedef std::unique_ptr<const ZipFile, void(*)(const ZipFile *)> ZipFilePtr_const;
 
             /**
+             * Read access to a ZIP archive.
              *
+             * <P>Where the archive does not require ZIP64 extensions, its
+             * central directory is indexed on open and entries are looked
+             * up by hash rather than by a linear search. Indices, along
+             * with a read-only mapping of the archive, are cached and
+             * shared between instances opened on the same path until the
+             * file is modified. Entries opened via `openEntry` are read
+             * directly from the mapping; stored entries are not copied.
+             *
+             * <P>The `gotoXXX`/`xxxCurrentEntry` cursor methods are not
+             * thread-safe.
              */
             class ENGINE_API ZipFile {
             public:
@@ -26,9 +37,33 @@ namespace TAK {
 
                 ~ZipFile() NOTHROWS;
 
+                /**
+                 * Lists the entries of the archive.
+                 *
+                 * @param path      If non-`nullptr`, only entries under the
+                 *                  specified directory of the archive are
+                 *                  listed
+                 * @param filter    If non-`nullptr`, only entries accepted
+                 *                  by the filter are listed
+                 */
                 TAKErr listEntries(Port::Collection<Port::String> &value, const char *path, bool(*filter)(const char *file) = nullptr) const NOTHROWS;
 
+                /**
+                 * Opens the specified entry. The returned input does not
+                 * depend on this instance and may outlive it.
+                 *
+                 * @return  TE_Ok on success, TE_Done if no such entry
+                 *          exists, various codes on failure
+                 */
                 TAKErr openEntry(DataInput2Ptr &dataInputPtr, const char *entryPath) const NOTHROWS;
+                /**
+                 * Returns the uncompressed size of the specified entry,
+                 * without moving the current entry.
+                 *
+                 * @return  TE_Ok on success, TE_Done if no such entry
+                 *          exists, various codes on failure
+                 */
+                TAKErr getEntryUncompressedSize(int64_t &outSize, const char *entryPath) const NOTHROWS;
 
                 static TAKErr open(ZipFilePtr &zipPtr, const char *path) NOTHROWS;
 
@@ -64,6 +99,7 @@ namespace TAK {
                 virtual int64_t length() const NOTHROWS;
             private:
                 ZipFileDataInput2(ZipFilePtr &&zipPtr, const int64_t len) NOTHROWS;
+                friend class ZipFile;
                 ZipFilePtr zip_ptr_;
                 int64_t len_;
             };
@@ -0,0 +1,89 @@
+#ifndef TAK_ENGINE_UTIL_IMPL_WORKERMETRICSIMPL_H_INCLUDED
+#define TAK_ENGINE_UTIL_IMPL_WORKERMETRICSIMPL_H_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "port/Platform.h"
+#include "port/String.h"
+#include "thread/Mutex.h"
+#include "util/Work.h"
+#include "util/WorkerMetrics.h"
+
+namespace TAK {
+    namespace Engine {
+        namespace Util {
+            namespace Impl {
+                class AtomicHistogram
+                {
+                public :
+                    AtomicHistogram() NOTHROWS;
+                public :
+                    void record(const uint64_t sample) NOTHROWS;
+                    void get(WorkerHistogram &value) const NOTHROWS;
+                    void reset() NOTHROWS;
+                private :
+                    std::atomic<uint64_t> buckets[WorkerHistogram::NumBuckets];
+                    std::atomic<uint64_t> count;
+                    std::atomic<uint64_t> sum;
+                    std::atomic<uint64_t> max;
+                };
+
+                /**
+                 * Records the scheduling metrics for a single worker. Owned
+                 * by the worker's queue; all record functions are lock-free
+                 * and discard samples while metrics are disabled.
+                 */
+                class WorkerMetricsRecorder
+                {
+                public :
+                    WorkerMetricsRecorder() NOTHROWS;
+                public :
+                    void setWorkerId(const uint64_t id) NOTHROWS;
+                    uint64_t getWorkerId() const NOTHROWS;
+                    void setName(const char *name) NOTHROWS;
+                    void snapshot(WorkerMetricsSnapshot &value) const NOTHROWS;
+                    void reset() NOTHROWS;
+                public :
+                    /** invoked once the work has been accepted by the queue */
+                    void recordScheduled(Work &work) NOTHROWS;
+                    void recordRejected() NOTHROWS;
+                    /** invoked when accepted work is dropped before it starts */
+                    void recordPreempted() NOTHROWS;
+                    /** returns the start timestamp, to be passed to `recordFinished` */
+                    int64_t recordStarted(const Work &work) NOTHROWS;
+                    void recordFinished(const int64_t started) NOTHROWS;
+                private :
+                    std::atomic<uint64_t> workerId;
+                    mutable Thread::Mutex nameMutex;
+                    Port::String name;
+                    std::atomic<int64_t> depth;
+                    AtomicHistogram queueLatency;
+                    AtomicHistogram runTime;
+                    AtomicHistogram queueDepth;
+                    std::atomic<uint64_t> scheduled;
+                    std::atomic<uint64_t> completed;
+                    std::atomic<uint64_t> rejected;
+                    std::atomic<uint64_t> preempted;
+                };
+
+                /**
+                 * Creates a recorder and registers it for snapshots. The
+                 * recorder is created regardless of whether metrics are
+                 * currently enabled so that long-lived workers are covered
+                 * once metrics are turned on.
+                 */
+                std::shared_ptr<WorkerMetricsRecorder> WorkerMetrics_createRecorder(const char *name = nullptr) NOTHROWS;
+
+                /**
+                 * Runs the work, recording start and run time to the
+                 * (optional) recorder.
+                 */
+                void WorkerMetrics_run(Work &work, WorkerMetricsRecorder *metrics) NOTHROWS;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "pch.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "formats/astc/ASTC.h"
+#include "renderer/Bitmap2.h"
+#include "util/DataOutput2.h"
+
+using namespace TAK::Engine::Formats::ASTC;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		// reference decoder for the subset of LDR ASTC 4x4 emitted by the
+		// encoder: 2D block modes with bits 1:0 non-zero, single partition,
+		// single plane, direct RGB/RGBA endpoints and bit-only weight ranges.
+		// Follows the block mode and color endpoint decoding of the Khronos
+		// Data Format Specification, section "ASTC".
+
+		unsigned getBits(const uint8_t *block, const std::size_t offset, const std::size_t count) {
+			unsigned v = 0u;
+			for (std::size_t i = 0u; i < count; i++)
+				v |= ((block[(offset + i) / 8u] >> ((offset + i) % 8u)) & 0x1u) << i;
+			return v;
+		}
+
+		struct BlockMode
+		{
+			std::size_t gridWidth;
+			std::size_t gridHeight;
+			std::size_t weightLevels;
+			bool dualPlane;
+		};
+
+		bool decodeBlockMode(BlockMode &value, const unsigned mode) {
+			// QUANT_2 ... QUANT_32, by weight range index
+			static const std::size_t levels[12] = { 2u, 3u, 4u, 5u, 6u, 8u, 10u, 12u, 16u, 20u, 24u, 32u };
+			if ((mode & 0x3u) == 0u)
+				return false;
+			const unsigned A = (mode >> 5u) & 0x3u;
+			unsigned B = (mode >> 7u) & 0x3u;
+			switch ((mode >> 2u) & 0x3u) {
+			case 0u :
+				value.gridWidth = B + 4u;
+				value.gridHeight = A + 2u;
+				break;
+			case 1u :
+				value.gridWidth = B + 8u;
+				value.gridHeight = A + 2u;
+				break;
+			case 2u :
+				value.gridWidth = A + 2u;
+				value.gridHeight = B + 8u;
+				break;
+			default :
+				B &= 0x1u;
+				if (mode & 0x100u) {
+					value.gridWidth = B + 2u;
+					value.gridHeight = A + 2u;
+				} else {
+					value.gridWidth = A + 2u;
+					value.gridHeight = B + 6u;
+				}
+				break;
+			}
+			const unsigned range = (((mode >> 4u) & 0x1u) | ((mode & 0x3u) << 1u)) - 2u + (((mode >> 9u) & 0x1u) ? 6u : 0u);
+			if (range >= 12u)
+				return false;
+			value.weightLevels = levels[range];
+			value.dualPlane = !!((mode >> 10u) & 0x1u);
+			return true;
+		}
+
+		bool isPowerOfTwo(const std::size_t v) {
+			return v && !(v & (v - 1u));
+		}
+
+		std::size_t log2(std::size_t v) {
+			std::size_t r = 0u;
+			while (v >>= 1u)
+				r++;
+			return r;
+		}
+
+		unsigned unquantizeWeight(const unsigned w, const std::size_t bits) {
+			// replicate to 6 bits, then expand [0,63] to [0,64]
+			unsigned v = 0u;
+			for (int shift = 6 - (int)bits; shift > -(int)bits; shift -= (int)bits)
+				v |= (shift >= 0) ? (w << shift) : (w >> -shift);
+			v &= 0x3Fu;
+			return (v > 32u) ? v + 1u : v;
+		}
+
+		void blueContract(int (&c)[4]) {
+			c[0] = (c[0] + c[2]) >> 1;
+			c[1] = (c[1] + c[2]) >> 1;
+		}
+
+		::testing::AssertionResult decodeBlock(uint8_t (&rgba)[64], const uint8_t *block) {
+			BlockMode mode;
+			if (!decodeBlockMode(mode, getBits(block, 0u, 11u)))
+				return ::testing::AssertionFailure() << "unsupported block mode";
+			if (mode.dualPlane)
+				return ::testing::AssertionFailure() << "unexpected dual plane";
+			if (mode.gridWidth != 4u || mode.gridHeight != 4u)
+				return ::testing::AssertionFailure() << "unexpected weight grid " << mode.gridWidth << "x" << mode.gridHeight;
+			if (!isPowerOfTwo(mode.weightLevels))
+				return ::testing::AssertionFailure() << "unsupported weight range " << mode.weightLevels;
+			if (getBits(block, 11u, 2u) != 0u)
+				return ::testing::AssertionFailure() << "unexpected partition count";
+
+			const unsigned cem = getBits(block, 13u, 4u);
+			std::size_t numValues;
+			if (cem == 8u)
+				numValues = 6u;
+			else if (cem == 12u)
+				numValues = 8u;
+			else
+				return ::testing::AssertionFailure() << "unexpected endpoint mode " << cem;
+
+			const std::size_t weightBits = log2(mode.weightLevels);
+			const std::size_t numWeightBits = 16u * weightBits;
+			if (numWeightBits < 24u || numWeightBits > 96u)
+				return ::testing::AssertionFailure() << "weight bits out of range";
+			// the endpoint range is the largest that fits the remaining bits;
+			// QUANT_256 is the maximum and encodes values as plain bytes
+			if ((128u - 17u - numWeightBits) < numValues * 8u)
+				return ::testing::AssertionFailure() << "endpoint range below QUANT_256";
+
+			int v[8];
+			for (std::size_t i = 0u; i < numValues; i++)
+				v[i] = (int)getBits(block, 17u + i * 8u, 8u);
+			int e0[4] = { v[0], v[2], v[4], (numValues == 8u) ? v[6] : 0xFF };
+			int e1[4] = { v[1], v[3], v[5], (numValues == 8u) ? v[7] : 0xFF };
+			if ((v[1] + v[3] + v[5]) < (v[0] + v[2] + v[4])) {
+				std::swap(e0, e1);
+				blueContract(e0);
+				blueContract(e1);
+			}
+
+			for (std::size_t i = 0u; i < 16u; i++) {
+				unsigned w = 0u;
+				for (std::size_t b = 0u; b < weightBits; b++)
+					w |= getBits(block, 127u - (i * weightBits + b), 1u) << b;
+				const int weight = (int)unquantizeWeight(w, weightBits);
+				for (std::size_t c = 0u; c < 4u; c++) {
+					const int c16 = ((e0[c] * 257) * (64 - weight) + (e1[c] * 257) * weight + 32) >> 6;
+					rgba[i * 4u + c] = (uint8_t)(c16 >> 8);
+				}
+			}
+			return ::testing::AssertionSuccess();
+		}
+
+		std::vector<uint8_t> compress(const Bitmap2 &bitmap) {
+			std::size_t size;
+			ASTC_getCompressedSize(&size, bitmap.getWidth(), bitmap.getHeight());
+			std::vector<uint8_t> data(size);
+			MemoryOutput2 sink;
+			sink.open(data.data(), data.size());
+			std::size_t compressedSize;
+			if (ASTC_compress(sink, &compressedSize, bitmap) != TE_Ok || compressedSize != size)
+				data.clear();
+			return data;
+		}
+
+		// colors lie on a line through RGB(A) space, which a single
+		// partition represents up to weight quantization
+		Bitmap2 createGradient(const bool opaque) {
+			Bitmap2 bitmap(8u, 8u, Bitmap2::RGBA32);
+			uint8_t *data = bitmap.getData();
+			for (std::size_t y = 0u; y < 8u; y++) {
+				for (std::size_t x = 0u; x < 8u; x++) {
+					const std::size_t t = x + y;
+					uint8_t *px = data + (y * bitmap.getStride()) + (x * 4u);
+					px[0] = (uint8_t)(32u + t * 14u);
+					px[1] = (uint8_t)(200u - t * 12u);
+					px[2] = (uint8_t)(64u + t * 8u);
+					px[3] = opaque ? 0xFFu : (uint8_t)(250u - t * 10u);
+				}
+			}
+			return bitmap;
+		}
+
+		void assertRoundTrip(const Bitmap2 &bitmap, const std::size_t expectedLevels, const int tolerance) {
+			std::vector<uint8_t> compressed = compress(bitmap);
+			ASSERT_EQ(64u, compressed.size());
+
+			for (std::size_t blockY = 0u; blockY < 2u; blockY++) {
+				for (std::size_t blockX = 0u; blockX < 2u; blockX++) {
+					const uint8_t *block = compressed.data() + (blockY * 2u + blockX) * 16u;
+					BlockMode mode;
+					ASSERT_TRUE(decodeBlockMode(mode, getBits(block, 0u, 11u)));
+					ASSERT_EQ(expectedLevels, mode.weightLevels);
+
+					uint8_t rgba[64];
+					ASSERT_TRUE(decodeBlock(rgba, block));
+					for (std::size_t y = 0u; y < 4u; y++) {
+						for (std::size_t x = 0u; x < 4u; x++) {
+							const uint8_t *src = bitmap.getData() + ((blockY * 4u + y) * bitmap.getStride()) + ((blockX * 4u + x) * 4u);
+							const uint8_t *dst = rgba + (y * 4u + x) * 4u;
+							for (std::size_t c = 0u; c < 4u; c++)
+								ASSERT_LE(abs((int)src[c] - (int)dst[c]), tolerance) << "block " << blockX << "," << blockY << " texel " << x << "," << y << " channel " << c;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	TEST(ASTCTests, testOpaqueBlockModeRoundTrip) {
+		assertRoundTrip(createGradient(true), 8u, 8);
+	}
+
+	TEST(ASTCTests, testTranslucentBlockModeRoundTrip) {
+		assertRoundTrip(createGradient(false), 4u, 16);
+	}
+
+	TEST(ASTCTests, testSolidBlockIsExact) {
+		Bitmap2 bitmap(4u, 4u, Bitmap2::RGBA32);
+		uint8_t *data = bitmap.getData();
+		for (std::size_t i = 0u; i < 16u; i++) {
+			data[i * 4u] = 0x30u;
+			data[i * 4u + 1u] = 0x80u;
+			data[i * 4u + 2u] = 0xC0u;
+			data[i * 4u + 3u] = 0xFFu;
+		}
+		std::vector<uint8_t> compressed = compress(bitmap);
+		ASSERT_EQ(16u, compressed.size());
+		uint8_t rgba[64];
+		ASSERT_TRUE(decodeBlock(rgba, compressed.data()));
+		for (std::size_t i = 0u; i < 64u; i++)
+			ASSERT_EQ(data[i], rgba[i]);
+	}
+}
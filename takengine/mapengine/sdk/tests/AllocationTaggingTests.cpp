@@ -0,0 +1,136 @@
+#include "pch.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "util/AllocationTagging.h"
+#include "util/DataOutput2.h"
+#include "util/SlabAllocator.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(AllocationTaggingTests, testScopeRestoresTag) {
+		ASSERT_EQ(TEAT_Untagged, AllocationTagging_getTag());
+		{
+			TE_ALLOCATION_TAG(TEAT_TileDecode);
+			ASSERT_EQ(TEAT_TileDecode, AllocationTagging_getTag());
+			{
+				TE_ALLOCATION_TAG(TEAT_MeshLoad);
+				ASSERT_EQ(TEAT_MeshLoad, AllocationTagging_getTag());
+			}
+			ASSERT_EQ(TEAT_TileDecode, AllocationTagging_getTag());
+		}
+		ASSERT_EQ(TEAT_Untagged, AllocationTagging_getTag());
+	}
+
+	TEST(AllocationTaggingTests, testRecordWhileDisabled) {
+		AllocationTagging_setEnabled(false);
+		ASSERT_EQ(-1, AllocationTagging_recordAllocation(64u, nullptr));
+	}
+
+	TEST(AllocationTaggingTests, testRecordAllocationRelease) {
+		AllocationTagging_setEnabled(true);
+		AllocationTaggingSnapshot before;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&before));
+
+		int tag;
+		{
+			TE_ALLOCATION_TAG(TEAT_FeatureQuery);
+			tag = AllocationTagging_recordAllocation(1000u, nullptr);
+		}
+		ASSERT_EQ((int)TEAT_FeatureQuery, tag);
+		AllocationTaggingSnapshot during;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&during));
+		ASSERT_EQ(before.tags[TEAT_FeatureQuery].liveBytes + 1000, during.tags[TEAT_FeatureQuery].liveBytes);
+		ASSERT_EQ(before.tags[TEAT_FeatureQuery].bytesAllocated + 1000u, during.tags[TEAT_FeatureQuery].bytesAllocated);
+		ASSERT_EQ(before.tags[TEAT_FeatureQuery].allocations + 1u, during.tags[TEAT_FeatureQuery].allocations);
+
+		AllocationTagging_recordRelease(tag, 1000u);
+		AllocationTaggingSnapshot after;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&after));
+		ASSERT_EQ(before.tags[TEAT_FeatureQuery].liveBytes, after.tags[TEAT_FeatureQuery].liveBytes);
+		ASSERT_EQ(before.tags[TEAT_FeatureQuery].releases + 1u, after.tags[TEAT_FeatureQuery].releases);
+		AllocationTagging_setEnabled(false);
+	}
+
+	TEST(AllocationTaggingTests, testSlabAllocationsCharged) {
+		// create the size class pool outside of the tagged scope
+		SlabAllocator_deallocate(SlabAllocator_allocate(24u));
+
+		AllocationTagging_setEnabled(true);
+		AllocationTaggingSnapshot before;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&before));
+
+		void *small;
+		void *large;
+		{
+			TE_ALLOCATION_TAG(TEAT_MeshLoad);
+			small = SlabAllocator_allocate(24u);
+			large = SlabAllocator_allocate(4096u);
+		}
+		ASSERT_NE(nullptr, small);
+		ASSERT_NE(nullptr, large);
+		AllocationTaggingSnapshot during;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&during));
+		ASSERT_EQ(before.tags[TEAT_MeshLoad].allocations + 2u, during.tags[TEAT_MeshLoad].allocations);
+		// small allocation is charged at its size class
+		ASSERT_EQ(before.tags[TEAT_MeshLoad].liveBytes + 32 + 4096, during.tags[TEAT_MeshLoad].liveBytes);
+
+		// released on a differently tagged scope; charge follows the allocation
+		SlabAllocator_deallocate(small);
+		SlabAllocator_deallocate(large);
+		AllocationTaggingSnapshot after;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&after));
+		ASSERT_EQ(before.tags[TEAT_MeshLoad].liveBytes, after.tags[TEAT_MeshLoad].liveBytes);
+		AllocationTagging_setEnabled(false);
+	}
+
+	TEST(AllocationTaggingTests, testCallSitesSampled) {
+		AllocationTagging_setEnabled(true);
+		static const int site = 0;
+		std::vector<int> tags;
+		{
+			TE_ALLOCATION_TAG(TEAT_NetworkReceive);
+			for (std::size_t i = 0u; i < 256u; i++)
+				tags.push_back(AllocationTagging_recordAllocation(128u, &site));
+		}
+		for (std::size_t i = 0u; i < tags.size(); i++)
+			AllocationTagging_recordRelease(tags[i], 128u);
+		AllocationTagging_setEnabled(false);
+
+		AllocationTaggingSnapshot snapshot;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&snapshot));
+		bool found = false;
+		for (std::size_t i = 0u; i < snapshot.numCallSites; i++) {
+			if (snapshot.callSites[i].address == &site && snapshot.callSites[i].tag == TEAT_NetworkReceive) {
+				found = true;
+				ASSERT_EQ(256u, snapshot.callSites[i].allocations);
+				ASSERT_EQ(256u * 128u, snapshot.callSites[i].bytes);
+			}
+			if (i)
+				ASSERT_TRUE(snapshot.callSites[i - 1u].bytes >= snapshot.callSites[i].bytes);
+		}
+		ASSERT_TRUE(found);
+	}
+
+	TEST(AllocationTaggingTests, testReport) {
+		AllocationTaggingSnapshot previous;
+		ASSERT_EQ(TE_Ok, AllocationTagging_getSnapshot(&previous));
+		AllocationTaggingSnapshot current = previous;
+		current.timestamp += 2000LL;
+		current.tags[TEAT_TileDecode].bytesAllocated += 4000u;
+
+		DynamicOutput output;
+		ASSERT_EQ(TE_Ok, output.open(1024u));
+		ASSERT_EQ(TE_Ok, AllocationTagging_report(output, current, &previous));
+		const uint8_t *data;
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, output.get(&data, &len));
+		const std::string report(reinterpret_cast<const char *>(data), len);
+		ASSERT_NE(std::string::npos, report.find("TileDecode"));
+		ASSERT_NE(std::string::npos, report.find("2000"));
+	}
+}
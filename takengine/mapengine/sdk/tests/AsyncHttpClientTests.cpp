@@ -0,0 +1,130 @@
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+
+#include "util/AsyncHttpClient.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		class CollectingCallback : public AsyncHttpClient::Callback
+		{
+		public:
+			struct Result
+			{
+				TAKErr code;
+				std::string body;
+			};
+		public:
+			void requestCompleted(const int64_t id, const TAKErr code, const int responseCode, const uint8_t *data, const std::size_t dataLen) NOTHROWS override
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				Result &result = results[id];
+				result.code = code;
+				if (data)
+					result.body.assign(reinterpret_cast<const char *>(data), dataLen);
+				cond.notify_all();
+			}
+			void validatorsReceived(const int64_t id, const char *etag, const char *lastModified) NOTHROWS override
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (lastModified)
+					this->lastModified[id] = lastModified;
+			}
+			bool await(const std::size_t count)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				return cond.wait_for(lock, std::chrono::seconds(10), [&]() { return results.size() >= count; });
+			}
+		public:
+			std::map<int64_t, Result> results;
+			std::map<int64_t, std::string> lastModified;
+			std::mutex mutex;
+			std::condition_variable cond;
+		};
+
+		std::string createFile(const char *name, const char *content)
+		{
+			std::string path(::testing::TempDir());
+			path += name;
+			FILE *f = fopen(path.c_str(), "wb");
+			fputs(content, f);
+			fclose(f);
+			return path;
+		}
+
+		std::string fileUrl(std::string path)
+		{
+			for (auto &c : path)
+				if (c == '\\')
+					c = '/';
+			return (path[0] == '/' ? "file://" : "file:///") + path;
+		}
+	}
+
+	TEST(AsyncHttpClientTests, testBatchCompletes) {
+		const std::string a = fileUrl(createFile("asynchttpclient_a.txt", "tile a"));
+		const std::string b = fileUrl(createFile("asynchttpclient_b.txt", "tile b"));
+
+		CollectingCallback callback;
+		AsyncHttpClient client{ AsyncHttpClient::Options() };
+		const char *urls[2] = { a.c_str(), b.c_str() };
+		int64_t ids[2];
+		ASSERT_EQ(TE_Ok, client.submit(ids, urls, 2u, callback));
+		ASSERT_TRUE(callback.await(2u));
+
+		ASSERT_EQ(TE_Ok, callback.results[ids[0]].code);
+		ASSERT_EQ("tile a", callback.results[ids[0]].body);
+		ASSERT_EQ(TE_Ok, callback.results[ids[1]].code);
+		ASSERT_EQ("tile b", callback.results[ids[1]].body);
+		ASSERT_EQ(0u, client.getPendingCount());
+	}
+
+	TEST(AsyncHttpClientTests, testFailedRequest) {
+		const std::string missing = fileUrl(::testing::TempDir() + "asynchttpclient_missing.txt");
+		CollectingCallback callback;
+		AsyncHttpClient client{ AsyncHttpClient::Options() };
+		int64_t id;
+		ASSERT_EQ(TE_Ok, client.submit(&id, missing.c_str(), callback));
+		ASSERT_TRUE(callback.await(1u));
+		ASSERT_EQ(TE_IO, callback.results[id].code);
+	}
+
+	TEST(AsyncHttpClientTests, testValidatorsReceived) {
+		const std::string a = fileUrl(createFile("asynchttpclient_validators.txt", "tile a"));
+
+		CollectingCallback callback;
+		AsyncHttpClient client{ AsyncHttpClient::Options() };
+		const char *urls[1] = { a.c_str() };
+		AsyncHttpClient::Validators validators;
+		validators.lastModified = "Thu, 01 Jan 1970 00:00:00 GMT";
+		int64_t id;
+		ASSERT_EQ(TE_Ok, client.submit(&id, urls, &validators, 1u, callback));
+		ASSERT_TRUE(callback.await(1u));
+
+		// validators are only honored for HTTP; the file is returned
+		ASSERT_EQ(TE_Ok, callback.results[id].code);
+		ASSERT_EQ("tile a", callback.results[id].body);
+		// the last modified time of the file is reported
+		ASSERT_EQ(1u, callback.lastModified.count(id));
+		ASSERT_FALSE(callback.lastModified[id].empty());
+	}
+
+	TEST(AsyncHttpClientTests, testDestructCancelsOutstanding) {
+		CollectingCallback callback;
+		{
+			AsyncHttpClient client{ AsyncHttpClient::Options() };
+			// unroutable address; the request cannot complete before the client is destroyed
+			int64_t id;
+			ASSERT_EQ(TE_Ok, client.submit(&id, "http://10.255.255.1/tile.png", callback));
+		}
+		ASSERT_EQ(1u, callback.results.size());
+		ASSERT_EQ(TE_Canceled, callback.results.begin()->second.code);
+	}
+}
@@ -0,0 +1,84 @@
+#include "pch.h"
+
+#include <string>
+
+#include "util/AttributeSet.h"
+
+using namespace atakmap::util;
+
+namespace takenginetests {
+
+	TEST(AttributeSetTests, testScalarRoundTrip) {
+		AttributeSet attrs;
+		attrs.setInt("int", 7);
+		attrs.setLong("long", 1LL << 40);
+		attrs.setDouble("double", 0.5);
+
+		ASSERT_EQ(7, attrs.getInt("int"));
+		ASSERT_EQ(1LL << 40, attrs.getLong("long"));
+		ASSERT_EQ(0.5, attrs.getDouble("double"));
+		ASSERT_EQ(AttributeSet::LONG, attrs.getAttributeType("long"));
+		ASSERT_EQ(3u, attrs.getAttributeNames().size());
+
+		// replacing an attribute changes its type
+		attrs.setString("int", "seven");
+		ASSERT_EQ(AttributeSet::STRING, attrs.getAttributeType("int"));
+		ASSERT_STREQ("seven", attrs.getString("int"));
+		ASSERT_THROW(attrs.getInt("int"), std::invalid_argument);
+		ASSERT_EQ(3u, attrs.getAttributeNames().size());
+	}
+
+	TEST(AttributeSetTests, testNullValues) {
+		AttributeSet attrs;
+		attrs.setString("string", nullptr);
+		attrs.setIntArray("ints", AttributeSet::IntArray(nullptr, nullptr));
+
+		ASSERT_TRUE(attrs.containsAttribute("string"));
+		ASSERT_EQ(nullptr, attrs.getString("string"));
+		ASSERT_EQ(nullptr, attrs.getIntArray("ints").first);
+		ASSERT_EQ(AttributeSet::INT_ARRAY, attrs.getAttributeType("ints"));
+	}
+
+	TEST(AttributeSetTests, testRemoveAndMissing) {
+		AttributeSet attrs;
+		attrs.setInt("a", 1);
+		attrs.setInt("b", 2);
+		attrs.setInt("c", 3);
+		attrs.removeAttribute("b");
+
+		ASSERT_FALSE(attrs.containsAttribute("b"));
+		ASSERT_FALSE(attrs.containsAttribute("never set"));
+		ASSERT_THROW(attrs.getInt("b"), std::invalid_argument);
+		ASSERT_THROW(attrs.getInt(nullptr), std::invalid_argument);
+		ASSERT_EQ(1, attrs.getInt("a"));
+		ASSERT_EQ(3, attrs.getInt("c"));
+	}
+
+	TEST(AttributeSetTests, testCopyIsIndependent) {
+		AttributeSet attrs;
+		const int ints[3] = { 1, 2, 3 };
+		attrs.setIntArray("ints", AttributeSet::IntArray(ints, ints + 3));
+		AttributeSet nested;
+		nested.setString("name", "nested");
+		attrs.setAttributeSet("nested", nested);
+
+		AttributeSet copy(attrs);
+		copy.setInt("ints", 4);
+
+		AttributeSet::IntArray arr = attrs.getIntArray("ints");
+		ASSERT_EQ(3, arr.second - arr.first);
+		ASSERT_EQ(2, arr.first[1]);
+		ASSERT_EQ(4, copy.getInt("ints"));
+		ASSERT_STREQ("nested", copy.getAttributeSet("nested").getString("name"));
+	}
+
+	TEST(AttributeSetTests, testStringStableAcrossInsert) {
+		AttributeSet attrs;
+		attrs.setString("m", "value");
+		const char *value = attrs.getString("m");
+		for (int i = 0; i < 100; i++)
+			attrs.setInt(std::to_string(i).c_str(), i);
+		ASSERT_EQ(value, attrs.getString("m"));
+		ASSERT_EQ(101u, attrs.getAttributeNames().size());
+	}
+}
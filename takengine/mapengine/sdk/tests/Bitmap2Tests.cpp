@@ -0,0 +1,224 @@
+#include "pch.h"
+
+#include "renderer/Bitmap2.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		// odd width exercises both the vector and scalar paths
+		const std::size_t testWidth = 37u;
+		const std::size_t testHeight = 5u;
+
+		struct Rgba
+		{
+			unsigned r, g, b, a;
+		};
+
+		Bitmap2 createBitmap(const Bitmap2::Format format) {
+			Bitmap2 bitmap(testWidth, testHeight, Bitmap2::RGBA32);
+			uint8_t *data = bitmap.getData();
+			for (std::size_t i = 0u; i < testWidth * testHeight * 4u; i++)
+				data[i] = (uint8_t)((i * 73u + 19u) ^ (i >> 3u));
+			return Bitmap2(bitmap, format);
+		}
+
+		Rgba getPixel(const Bitmap2 &bitmap, const std::size_t x, const std::size_t y) {
+			const uint8_t *px = bitmap.getData() + (y * bitmap.getStride());
+			switch (bitmap.getFormat()) {
+			case Bitmap2::ARGB32:
+				px += x * 4u;
+				return Rgba{ px[1], px[2], px[3], px[0] };
+			case Bitmap2::RGBA32:
+				px += x * 4u;
+				return Rgba{ px[0], px[1], px[2], px[3] };
+			case Bitmap2::BGRA32:
+				px += x * 4u;
+				return Rgba{ px[2], px[1], px[0], px[3] };
+			case Bitmap2::MONOCHROME:
+				px += x;
+				return Rgba{ px[0], px[0], px[0], 0xFFu };
+			case Bitmap2::MONOCHROME_ALPHA:
+				px += x * 2u;
+				return Rgba{ px[0], px[0], px[0], px[1] };
+			default:
+				return Rgba{ 0u, 0u, 0u, 0u };
+			}
+		}
+
+		unsigned premultiply(const unsigned c, const unsigned a) {
+			return (unsigned)((double)(c * a) / 255.0 + 0.5);
+		}
+	}
+
+	TEST(Bitmap2Tests, testConvert32BitFormats) {
+		const Bitmap2::Format formats[3u] = { Bitmap2::ARGB32, Bitmap2::RGBA32, Bitmap2::BGRA32 };
+		for (std::size_t i = 0u; i < 3u; i++) {
+			Bitmap2 src(createBitmap(formats[i]));
+			for (std::size_t j = 0u; j < 3u; j++) {
+				Bitmap2 dst(src, formats[j]);
+				for (std::size_t y = 0u; y < testHeight; y++) {
+					for (std::size_t x = 0u; x < testWidth; x++) {
+						const Rgba expected = getPixel(src, x, y);
+						const Rgba actual = getPixel(dst, x, y);
+						ASSERT_EQ(expected.r, actual.r);
+						ASSERT_EQ(expected.g, actual.g);
+						ASSERT_EQ(expected.b, actual.b);
+						ASSERT_EQ(expected.a, actual.a);
+					}
+				}
+			}
+		}
+	}
+
+	TEST(Bitmap2Tests, testConvertToMonochrome) {
+		const Bitmap2::Format formats[3u] = { Bitmap2::ARGB32, Bitmap2::RGBA32, Bitmap2::BGRA32 };
+		for (std::size_t i = 0u; i < 3u; i++) {
+			Bitmap2 src(createBitmap(formats[i]));
+			Bitmap2 mono(src, Bitmap2::MONOCHROME);
+			Bitmap2 monoAlpha(src, Bitmap2::MONOCHROME_ALPHA);
+			for (std::size_t y = 0u; y < testHeight; y++) {
+				for (std::size_t x = 0u; x < testWidth; x++) {
+					const Rgba px = getPixel(src, x, y);
+					const unsigned expected = (((px.r * 66u + px.g * 129u + px.b * 25u) + 128u) >> 8u) + 16u;
+					ASSERT_EQ(expected, getPixel(mono, x, y).r);
+					ASSERT_EQ(expected, getPixel(monoAlpha, x, y).r);
+					ASSERT_EQ(px.a, getPixel(monoAlpha, x, y).a);
+				}
+			}
+		}
+	}
+
+	TEST(Bitmap2Tests, testPremultiply) {
+		const Bitmap2::Format formats[3u] = { Bitmap2::ARGB32, Bitmap2::RGBA32, Bitmap2::BGRA32 };
+		for (std::size_t i = 0u; i < 3u; i++) {
+			Bitmap2 src(createBitmap(formats[i]));
+			for (std::size_t j = 0u; j < 3u; j++) {
+				BitmapPtr dst(nullptr, nullptr);
+				ASSERT_EQ(TE_Ok, Bitmap2_premultiply(dst, src, formats[j]));
+				ASSERT_EQ(formats[j], dst->getFormat());
+				for (std::size_t y = 0u; y < testHeight; y++) {
+					for (std::size_t x = 0u; x < testWidth; x++) {
+						const Rgba expected = getPixel(src, x, y);
+						const Rgba actual = getPixel(*dst, x, y);
+						ASSERT_EQ(premultiply(expected.r, expected.a), actual.r);
+						ASSERT_EQ(premultiply(expected.g, expected.a), actual.g);
+						ASSERT_EQ(premultiply(expected.b, expected.a), actual.b);
+						ASSERT_EQ(expected.a, actual.a);
+					}
+				}
+			}
+
+			// in place
+			Bitmap2 inplace(src);
+			ASSERT_EQ(TE_Ok, Bitmap2_premultiply(inplace));
+			for (std::size_t y = 0u; y < testHeight; y++) {
+				for (std::size_t x = 0u; x < testWidth; x++) {
+					const Rgba expected = getPixel(src, x, y);
+					ASSERT_EQ(premultiply(expected.g, expected.a), getPixel(inplace, x, y).g);
+				}
+			}
+		}
+	}
+
+	TEST(Bitmap2Tests, testDownsample) {
+		Bitmap2 src(createBitmap(Bitmap2::ARGB32));
+		for (int p = 0; p < 2; p++) {
+			const bool premultiplied = !!p;
+			BitmapPtr dst(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, Bitmap2_downsample(dst, src, Bitmap2::BGRA32, premultiplied));
+			ASSERT_EQ(testWidth / 2u, dst->getWidth());
+			ASSERT_EQ(testHeight / 2u, dst->getHeight());
+			for (std::size_t y = 0u; y < dst->getHeight(); y++) {
+				for (std::size_t x = 0u; x < dst->getWidth(); x++) {
+					unsigned sum[4u] = { 0u, 0u, 0u, 0u };
+					for (std::size_t i = 0u; i < 4u; i++) {
+						Rgba px = getPixel(src, (x * 2u) + (i % 2u), (y * 2u) + (i / 2u));
+						if (premultiplied) {
+							px.r = premultiply(px.r, px.a);
+							px.g = premultiply(px.g, px.a);
+							px.b = premultiply(px.b, px.a);
+						}
+						sum[0] += px.r;
+						sum[1] += px.g;
+						sum[2] += px.b;
+						sum[3] += px.a;
+					}
+					const Rgba actual = getPixel(*dst, x, y);
+					ASSERT_EQ((sum[0] + 2u) / 4u, actual.r);
+					ASSERT_EQ((sum[1] + 2u) / 4u, actual.g);
+					ASSERT_EQ((sum[2] + 2u) / 4u, actual.b);
+					ASSERT_EQ((sum[3] + 2u) / 4u, actual.a);
+				}
+			}
+		}
+	}
+
+	TEST(Bitmap2Tests, testDownsampleSinglePixelDimension) {
+		Bitmap2 src(createBitmap(Bitmap2::RGBA32));
+		BitmapPtr row(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, src.subimage(row, 0u, 0u, testWidth, 1u));
+		BitmapPtr dst(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Bitmap2_downsample(dst, *row, Bitmap2::RGBA32, false));
+		ASSERT_EQ(testWidth / 2u, dst->getWidth());
+		ASSERT_EQ(1u, dst->getHeight());
+		for (std::size_t x = 0u; x < dst->getWidth(); x++) {
+			const Rgba a = getPixel(*row, x * 2u, 0u);
+			const Rgba b = getPixel(*row, (x * 2u) + 1u, 0u);
+			ASSERT_EQ((2u * (a.r + b.r) + 2u) / 4u, getPixel(*dst, x, 0u).r);
+		}
+	}
+
+	TEST(Bitmap2Tests, testBufferPoolReuse) {
+		Bitmap2_trimBufferPool(0u);
+		Bitmap2BufferPoolStats before;
+		ASSERT_EQ(TE_Ok, Bitmap2_getBufferPoolStats(&before));
+		if (!before.maxSize)
+			return;
+
+		const uint8_t *released;
+		{
+			Bitmap2 tile(256u, 256u, Bitmap2::RGBA32);
+			released = tile.getData();
+		}
+		Bitmap2BufferPoolStats pooled;
+		ASSERT_EQ(TE_Ok, Bitmap2_getBufferPoolStats(&pooled));
+		ASSERT_EQ(1u, pooled.count);
+		ASSERT_EQ(256u * 256u * 4u, pooled.size);
+
+		// same size is recycled, regardless of format
+		Bitmap2 reused(256u, 512u, Bitmap2::RGB565);
+		ASSERT_EQ(released, reused.getData());
+		Bitmap2BufferPoolStats after;
+		ASSERT_EQ(TE_Ok, Bitmap2_getBufferPoolStats(&after));
+		ASSERT_EQ(pooled.hits + 1u, after.hits);
+		ASSERT_EQ(0u, after.size);
+	}
+
+	TEST(Bitmap2Tests, testBufferOwnershipTransfer) {
+		// buffers are plain arrays; legacy bitmaps release adopted buffers
+		// with delete[]
+		Bitmap2::DataPtr data(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Bitmap2_createBuffer(data, 256u, 256u, Bitmap2::RGBA32));
+		ASSERT_TRUE(!!data.get());
+		delete[] const_cast<uint8_t *>(data.release());
+	}
+
+	TEST(Bitmap2Tests, testBufferPoolTrim) {
+		{
+			Bitmap2 a(128u, 128u, Bitmap2::RGBA32);
+			Bitmap2 b(128u, 64u, Bitmap2::RGBA32);
+			// small buffers are not pooled
+			Bitmap2 c(16u, 16u, Bitmap2::RGBA32);
+		}
+		Bitmap2_trimBufferPool(0u);
+		Bitmap2BufferPoolStats stats;
+		ASSERT_EQ(TE_Ok, Bitmap2_getBufferPoolStats(&stats));
+		ASSERT_EQ(0u, stats.count);
+		ASSERT_EQ(0u, stats.size);
+		ASSERT_EQ(TE_InvalidArg, Bitmap2_getBufferPoolStats(nullptr));
+	}
+}
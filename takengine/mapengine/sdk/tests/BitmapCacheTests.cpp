@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include <chrono>
+#include <thread>
+
+#include "renderer/BitmapCache.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		std::shared_ptr<Bitmap2> createIcon()
+		{
+			return std::make_shared<Bitmap2>(16u, 16u, Bitmap2::RGBA32);
+		}
+	}
+
+	TEST(BitmapCacheTests, testSingleDecode) {
+		BitmapCache cache(1024u * 1024u);
+		const char *uri = "file:///icons/marker.png";
+
+		std::shared_ptr<Bitmap2> icon;
+		ASSERT_EQ(TE_Done, cache.acquire(icon, uri));
+		ASSERT_EQ(TE_Done, cache.get(icon, uri));
+
+		// a concurrent request waits for the decode
+		std::shared_ptr<Bitmap2> waited;
+		TAKErr waitedCode = TE_Err;
+		std::thread waiter([&]() { waitedCode = cache.acquire(waited, uri); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		const std::shared_ptr<Bitmap2> decoded = createIcon();
+		cache.put(uri, decoded);
+		waiter.join();
+		ASSERT_EQ(TE_Ok, waitedCode);
+		ASSERT_EQ(decoded.get(), waited.get());
+
+		ASSERT_EQ(TE_Ok, cache.get(icon, uri));
+		ASSERT_EQ(decoded.get(), icon.get());
+		ASSERT_EQ(16u * 16u * 4u, cache.getSize());
+	}
+
+	TEST(BitmapCacheTests, testAbandonRedirectsDecode) {
+		BitmapCache cache(1024u * 1024u);
+		const char *uri = "file:///icons/missing.png";
+
+		std::shared_ptr<Bitmap2> icon;
+		ASSERT_EQ(TE_Done, cache.acquire(icon, uri));
+
+		std::shared_ptr<Bitmap2> waited;
+		TAKErr waitedCode = TE_Err;
+		std::thread waiter([&]() { waitedCode = cache.acquire(waited, uri); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		cache.abandon(uri);
+		waiter.join();
+		// the blocked requester is directed to decode
+		ASSERT_EQ(TE_Done, waitedCode);
+		cache.abandon(uri);
+		ASSERT_EQ(0u, cache.getSize());
+	}
+
+	TEST(BitmapCacheTests, testLeastRecentlyUsedEviction) {
+		// budget of two icons
+		BitmapCache cache(2u * 16u * 16u * 4u);
+		std::shared_ptr<Bitmap2> icon;
+		ASSERT_EQ(TE_Done, cache.acquire(icon, "icon0"));
+		cache.put("icon0", createIcon());
+		ASSERT_EQ(TE_Done, cache.acquire(icon, "icon1"));
+		cache.put("icon1", createIcon());
+
+		// use the oldest, then exceed the budget
+		ASSERT_EQ(TE_Ok, cache.get(icon, "icon0"));
+		ASSERT_EQ(TE_Done, cache.acquire(icon, "icon2"));
+		cache.put("icon2", createIcon());
+
+		ASSERT_EQ(2u * 16u * 16u * 4u, cache.getSize());
+		ASSERT_EQ(TE_Ok, cache.get(icon, "icon0"));
+		ASSERT_EQ(TE_Done, cache.get(icon, "icon1"));
+		ASSERT_EQ(TE_Ok, cache.get(icon, "icon2"));
+
+		cache.clear();
+		ASSERT_EQ(0u, cache.getSize());
+	}
+
+	TEST(BitmapCacheTests, testOversizedNotRetained) {
+		BitmapCache cache(16u * 16u * 4u - 1u);
+		std::shared_ptr<Bitmap2> icon;
+		ASSERT_EQ(TE_Done, cache.acquire(icon, "icon"));
+		cache.put("icon", createIcon());
+		ASSERT_EQ(0u, cache.getSize());
+		ASSERT_EQ(TE_Done, cache.acquire(icon, "icon"));
+		cache.abandon("icon");
+	}
+}
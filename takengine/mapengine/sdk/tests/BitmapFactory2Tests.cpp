@@ -143,6 +143,53 @@ namespace takenginetests {
 			ASSERT_TRUE(0 == relates);
 		}
 	}
+
+	TEST_F(BitmapFactory2Tests, testBitmapDecodeTargetSizeAndRegion) {
+		const std::string resource = TAK::Engine::Tests::getResource("FLAG_B24.PNG");
+
+		BitmapPtr full(NULL, NULL);
+		ASSERT_EQ(TE_Ok, BitmapFactory2_decode(full, resource.c_str(), NULL));
+		ASSERT_NE(nullptr, full.get());
+		const std::size_t width = full->getWidth();
+		const std::size_t height = full->getHeight();
+
+		// reduced to fit within the target, preserving aspect ratio
+		BitmapDecodeOptions opts;
+		opts.targetWidth = width / 4u;
+		BitmapPtr reduced(NULL, NULL);
+		ASSERT_EQ(TE_Ok, BitmapFactory2_decode(reduced, resource.c_str(), &opts));
+		ASSERT_EQ(width / 4u, reduced->getWidth());
+		ASSERT_NEAR((double)height / 4.0, (double)reduced->getHeight(), 1.0);
+
+		// targets larger than the source do not enlarge
+		opts.targetWidth = width * 2u;
+		opts.targetHeight = height * 2u;
+		ASSERT_EQ(TE_Ok, BitmapFactory2_decode(reduced, resource.c_str(), &opts));
+		ASSERT_EQ(width, reduced->getWidth());
+		ASSERT_EQ(height, reduced->getHeight());
+
+		// region matches the corresponding pixels of the full decode
+		opts = BitmapDecodeOptions();
+		opts.regionX = width / 2u;
+		opts.regionY = height / 2u;
+		opts.regionWidth = width / 4u;
+		opts.regionHeight = height / 4u;
+		BitmapPtr region(NULL, NULL);
+		ASSERT_EQ(TE_Ok, BitmapFactory2_decode(region, resource.c_str(), &opts));
+		ASSERT_EQ(opts.regionWidth, region->getWidth());
+		ASSERT_EQ(opts.regionHeight, region->getHeight());
+		ASSERT_EQ(full->getFormat(), region->getFormat());
+		std::size_t pixelSize;
+		ASSERT_EQ(TE_Ok, Bitmap2_formatPixelSize(&pixelSize, full->getFormat()));
+		for (std::size_t y = 0u; y < region->getHeight(); y++) {
+			const uint8_t *expected = full->getData() + ((opts.regionY + y) * full->getStride()) + (opts.regionX * pixelSize);
+			ASSERT_EQ(0, memcmp(expected, region->getData() + (y * region->getStride()), region->getWidth() * pixelSize));
+		}
+
+		// region outside of the image
+		opts.regionX = width;
+		ASSERT_EQ(TE_InvalidArg, BitmapFactory2_decode(region, resource.c_str(), &opts));
+	}
 }
 
 namespace {
@@ -1,6 +1,10 @@
 #include "pch.h"
 
+#include <vector>
+
 #include "util/DataInput2.h"
+#include "util/DataOutput2.h"
+#include "util/IO2.h"
 #include "formats/cesium3dtiles/C3DTTileset.h"
 
 using namespace TAK::Engine::Util;
@@ -203,4 +207,142 @@ namespace takenginetests {
 		ASSERT_TRUE(code == TE_Err);
 		ASSERT_TRUE(visitInfo.visitCount == 0);
 	}
+
+	namespace {
+		TAKErr visitorCollect(void* opaque, const C3DTTileset* tileset, const C3DTTile* tile) {
+			static_cast<std::vector<C3DTTile>*>(opaque)->push_back(*tile);
+			return TE_Ok;
+		}
+
+		void writeFile(const std::string &path, const std::string &data) {
+			FileOutput2 out;
+			out.open(path.c_str());
+			out.write(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+			out.close();
+		}
+	}
+
+	TEST_F(C3DTTilesetTests, testDeferredChildren) {
+		std::string src = "{"
+			"\"asset\":{\"version\":\"1.0\"},"
+			"\"geometricError\":100,"
+			"\"root\":{"
+			"\"geometricError\":50,"
+			"\"refine\":\"REPLACE\","
+			"\"children\":["
+			"{\"geometricError\":25,\"content\":{\"uri\":\"a.b3dm\"},\"children\":[{\"geometricError\":0}]},"
+			"{\"geometricError\":25,\"content\":{\"uri\":\"b.b3dm\"},\"children\":[{\"geometricError\":0,\"refine\":\"ADD\"}]}"
+			"]"
+			"}"
+			"}";
+		MemoryInput2 input;
+		input.open((uint8_t*)src.c_str(), src.size());
+
+		std::vector<C3DTTile> tiles;
+		ASSERT_EQ(TE_Ok, C3DTTileset_parse(&input, &tiles, visitorCollect, 0u));
+		ASSERT_EQ(1u, tiles.size());
+		ASSERT_EQ(2u, tiles[0].childCount);
+		ASSERT_TRUE(!!tiles[0].unparsedChildren);
+
+		std::vector<C3DTTile> children;
+		ASSERT_EQ(TE_Ok, C3DTTileset_parseChildren(tiles[0], nullptr, &children, visitorCollect));
+		ASSERT_EQ(2u, children.size());
+		ASSERT_STREQ("a.b3dm", children[0].content.uri);
+		ASSERT_STREQ("b.b3dm", children[1].content.uri);
+		ASSERT_TRUE(children[1].refine == C3DTRefine::Replace);
+		ASSERT_EQ(1u, children[1].childCount);
+		ASSERT_TRUE(!!children[1].unparsedChildren);
+
+		std::vector<C3DTTile> grandchildren;
+		ASSERT_EQ(TE_Ok, C3DTTileset_parseChildren(children[1], nullptr, &grandchildren, visitorCollect));
+		ASSERT_EQ(1u, grandchildren.size());
+		ASSERT_TRUE(grandchildren[0].refine == C3DTRefine::Add);
+		ASSERT_EQ(0u, grandchildren[0].childCount);
+		ASSERT_FALSE(!!grandchildren[0].unparsedChildren);
+
+		// a full parse visits everything
+		input.open((uint8_t*)src.c_str(), src.size());
+		tiles.clear();
+		ASSERT_EQ(TE_Ok, C3DTTileset_parse(&input, &tiles, visitorCollect));
+		ASSERT_EQ(5u, tiles.size());
+		for (std::size_t i = 0u; i < tiles.size(); i++)
+			ASSERT_FALSE(!!tiles[i].unparsedChildren);
+	}
+
+	TEST_F(C3DTTilesetTests, testImplicitTiling) {
+		TAK::Engine::Port::String dir;
+		ASSERT_EQ(TE_Ok, IO_createTempDirectory(dir, "c3dt", "", nullptr));
+
+		// the root and the children at morton indices 0, 2 and 3 are available
+		std::string subtreeJson = "{"
+			"\"buffers\":[{\"byteLength\":8}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":1}],"
+			"\"tileAvailability\":{\"bitstream\":0},"
+			"\"contentAvailability\":[{\"constant\":1}],"
+			"\"childSubtreeAvailability\":{\"constant\":0}"
+			"}";
+		while (subtreeJson.size() % 8u)
+			subtreeJson.push_back(' ');
+		std::string subtree("subt\x01\0\0\0", 8u);
+		for (std::size_t i = 0u; i < 8u; i++)
+			subtree.push_back(static_cast<char>((subtreeJson.size() >> (8u * i)) & 0xFFu));
+		subtree.append("\x08\0\0\0\0\0\0\0", 8u);
+		subtree += subtreeJson;
+		subtree.append("\x1B\0\0\0\0\0\0\0", 8u);
+		const std::string subtreePath = std::string(dir.get()) + "/0.0.0.subtree";
+		writeFile(subtreePath, subtree);
+
+		std::string src = "{"
+			"\"asset\":{\"version\":\"1.1\"},"
+			"\"geometricError\":100,"
+			"\"root\":{"
+			"\"boundingVolume\":{\"region\":[0,0,4,2,0,10]},"
+			"\"geometricError\":64,"
+			"\"refine\":\"REPLACE\","
+			"\"content\":{\"uri\":\"content/{level}/{x}/{y}.b3dm\"},"
+			"\"implicitTiling\":{"
+			"\"subdivisionScheme\":\"QUADTREE\","
+			"\"subtreeLevels\":2,"
+			"\"availableLevels\":2,"
+			"\"subtrees\":{\"uri\":\"{level}.{x}.{y}.subtree\"}"
+			"}"
+			"}"
+			"}";
+		MemoryInput2 input;
+		input.open((uint8_t*)src.c_str(), src.size());
+
+		// the implicit root is deferred under the tile that declares it
+		std::vector<C3DTTile> tiles;
+		ASSERT_EQ(TE_Ok, C3DTTileset_parse(&input, &tiles, visitorCollect));
+		ASSERT_EQ(1u, tiles.size());
+		ASSERT_EQ(nullptr, tiles[0].content.uri.get());
+		ASSERT_EQ(1u, tiles[0].childCount);
+		ASSERT_TRUE(!!tiles[0].unparsedChildren);
+
+		std::vector<C3DTTile> root;
+		ASSERT_EQ(TE_Ok, C3DTTileset_parseChildren(tiles[0], dir, &root, visitorCollect));
+		ASSERT_EQ(1u, root.size());
+		ASSERT_STREQ("content/0/0/0.b3dm", root[0].content.uri);
+		ASSERT_EQ(64.0, root[0].geometricError);
+		ASSERT_EQ(4u, root[0].childCount);
+
+		std::vector<C3DTTile> children;
+		ASSERT_EQ(TE_Ok, C3DTTileset_parseChildren(root[0], dir, &children, visitorCollect));
+		ASSERT_EQ(3u, children.size());
+		ASSERT_STREQ("content/1/0/0.b3dm", children[0].content.uri);
+		ASSERT_STREQ("content/1/0/1.b3dm", children[1].content.uri);
+		ASSERT_STREQ("content/1/1/1.b3dm", children[2].content.uri);
+		ASSERT_EQ(32.0, children[2].geometricError);
+		ASSERT_TRUE(children[2].refine == C3DTRefine::Replace);
+		ASSERT_EQ(0u, children[2].childCount);
+		ASSERT_TRUE(children[2].boundingVolume.type == C3DTVolume::Region);
+		ASSERT_EQ(2.0, children[2].boundingVolume.object.region.west);
+		ASSERT_EQ(1.0, children[2].boundingVolume.object.region.south);
+		ASSERT_EQ(4.0, children[2].boundingVolume.object.region.east);
+		ASSERT_EQ(2.0, children[2].boundingVolume.object.region.north);
+		ASSERT_EQ(10.0, children[2].boundingVolume.object.region.maximumHeight);
+
+		IO_delete(subtreePath.c_str());
+		IO_delete(dir);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "pch.h"
+
+#include <vector>
+
+#include <zlib.h>
+
+#include "formats/cog/COGTileReader.h"
+#include "raster/tilereader/TileReaderFactory2.h"
+#include "util/DataOutput2.h"
+#include "util/IO2.h"
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Formats::COG;
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Raster;
+using namespace TAK::Engine::Raster::TileReader;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		const std::size_t tileSize = 16u;
+
+		struct TestImage
+		{
+			unsigned width;
+			unsigned height;
+			bool overview;
+		};
+
+		uint8_t getSample(const unsigned level, const unsigned x, const unsigned y, const unsigned s) {
+			return (uint8_t)((level * 97u) + (x * 7u) + (y * 13u) + (s * 31u));
+		}
+
+		void put16(std::vector<uint8_t> &buf, const unsigned v) {
+			buf.push_back((uint8_t)v);
+			buf.push_back((uint8_t)(v >> 8u));
+		}
+		void put32(std::vector<uint8_t> &buf, const unsigned v) {
+			put16(buf, v & 0xFFFFu);
+			put16(buf, v >> 16u);
+		}
+		void putDouble(std::vector<uint8_t> &buf, const double v) {
+			uint64_t bits;
+			memcpy(&bits, &v, sizeof(bits));
+			put32(buf, (unsigned)(bits & 0xFFFFFFFFu));
+			put32(buf, (unsigned)(bits >> 32u));
+		}
+		void putEntry(std::vector<uint8_t> &buf, const unsigned tag, const unsigned type, const unsigned count, const unsigned value) {
+			put16(buf, tag);
+			put16(buf, type);
+			put32(buf, count);
+			if (type == 3u && count == 1u) {
+				put16(buf, value);
+				put16(buf, 0u);
+			} else {
+				put32(buf, value);
+			}
+		}
+
+		// 0.01 degree pixels, with the upper-left corner at 39N 77W
+		const double pixelScale[3] = { 0.01, 0.01, 0.0 };
+		const double tiepoint[6] = { 0.0, 0.0, 0.0, -77.0, 39.0, 0.0 };
+		// geographic model, pixel-is-area, WGS 84
+		const unsigned geoKeys[16] = { 1u, 1u, 0u, 3u, 1024u, 0u, 1u, 2u, 1025u, 0u, 1u, 1u, 2048u, 0u, 1u, 4326u };
+		const unsigned geoTagsSize = sizeof(pixelScale) + sizeof(tiepoint) + (16u * 2u);
+
+		/**
+		 * Writes a little-endian, tiled RGB TIFF with the specified images;
+		 * tiles are written after all IFDs, as in a COG. If georeferenced,
+		 * the full resolution image carries the GeoTIFF tags.
+		 */
+		std::vector<uint8_t> createTiff(const std::vector<TestImage> &images, const bool deflate, const bool georeferenced = false) {
+			const unsigned samples = 3u;
+			std::vector<std::vector<std::vector<uint8_t>>> tiles(images.size());
+			for (std::size_t i = 0u; i < images.size(); i++) {
+				const unsigned across = (images[i].width + tileSize - 1u) / tileSize;
+				const unsigned down = (images[i].height + tileSize - 1u) / tileSize;
+				for (unsigned ty = 0u; ty < down; ty++) {
+					for (unsigned tx = 0u; tx < across; tx++) {
+						std::vector<uint8_t> tile(tileSize * tileSize * samples, 0u);
+						for (unsigned y = 0u; y < tileSize; y++) {
+							for (unsigned x = 0u; x < tileSize; x++) {
+								const unsigned px = tx * tileSize + x;
+								const unsigned py = ty * tileSize + y;
+								if (px >= images[i].width || py >= images[i].height)
+									continue;
+								for (unsigned s = 0u; s < samples; s++)
+									tile[((y * tileSize + x) * samples) + s] = getSample((unsigned)i, px, py, s);
+							}
+						}
+						if (deflate) {
+							// apply horizontal differencing
+							for (unsigned y = 0u; y < tileSize; y++) {
+								uint8_t *row = &tile[y * tileSize * samples];
+								for (unsigned j = (tileSize * samples) - 1u; j >= samples; j--)
+									row[j] = (uint8_t)(row[j] - row[j - samples]);
+							}
+							uLongf len = compressBound((uLong)tile.size());
+							std::vector<uint8_t> compressed(len);
+							compress(&compressed[0], &len, &tile[0], (uLong)tile.size());
+							compressed.resize(len);
+							tile.swap(compressed);
+						}
+						tiles[i].push_back(tile);
+					}
+				}
+			}
+
+			std::vector<unsigned> ifdOffsets;
+			std::vector<unsigned> arrayOffsets;
+			unsigned offset = 8u;
+			for (std::size_t i = 0u; i < images.size(); i++) {
+				const bool geoTags = georeferenced && !i;
+				ifdOffsets.push_back(offset);
+				offset += 2u + ((geoTags ? 15u : 12u) * 12u) + 4u;
+				// BitsPerSample, TileOffsets, TileByteCounts, GeoTIFF tags
+				arrayOffsets.push_back(offset);
+				offset += (samples * 2u) + (8u * (unsigned)tiles[i].size()) + (geoTags ? geoTagsSize : 0u);
+			}
+
+			std::vector<uint8_t> tiff;
+			tiff.push_back('I');
+			tiff.push_back('I');
+			put16(tiff, 42u);
+			put32(tiff, ifdOffsets[0]);
+			unsigned dataOffset = offset;
+			for (std::size_t i = 0u; i < images.size(); i++) {
+				const unsigned numTiles = (unsigned)tiles[i].size();
+				const bool geoTags = georeferenced && !i;
+				const unsigned geoOffset = arrayOffsets[i] + (samples * 2u) + (8u * numTiles);
+				put16(tiff, geoTags ? 15u : 12u);
+				putEntry(tiff, 254u, 4u, 1u, images[i].overview ? 1u : 0u);
+				putEntry(tiff, 256u, 4u, 1u, images[i].width);
+				putEntry(tiff, 257u, 4u, 1u, images[i].height);
+				putEntry(tiff, 258u, 3u, samples, arrayOffsets[i]);
+				putEntry(tiff, 259u, 3u, 1u, deflate ? 8u : 1u);
+				putEntry(tiff, 262u, 3u, 1u, 2u);
+				putEntry(tiff, 277u, 3u, 1u, samples);
+				putEntry(tiff, 317u, 3u, 1u, deflate ? 2u : 1u);
+				putEntry(tiff, 322u, 3u, 1u, tileSize);
+				putEntry(tiff, 323u, 3u, 1u, tileSize);
+				putEntry(tiff, 324u, 4u, numTiles, numTiles > 1u ? arrayOffsets[i] + (samples * 2u) : dataOffset);
+				putEntry(tiff, 325u, 4u, numTiles, numTiles > 1u ? arrayOffsets[i] + (samples * 2u) + (4u * numTiles) : (unsigned)tiles[i][0].size());
+				if (geoTags) {
+					putEntry(tiff, 33550u, 12u, 3u, geoOffset);
+					putEntry(tiff, 33922u, 12u, 6u, geoOffset + (unsigned)sizeof(pixelScale));
+					putEntry(tiff, 34735u, 3u, 16u, geoOffset + (unsigned)(sizeof(pixelScale) + sizeof(tiepoint)));
+				}
+				put32(tiff, (i + 1u) < images.size() ? ifdOffsets[i + 1u] : 0u);
+
+				for (unsigned s = 0u; s < samples; s++)
+					put16(tiff, 8u);
+				unsigned tileOffset = dataOffset;
+				for (unsigned t = 0u; t < numTiles; t++) {
+					put32(tiff, tileOffset);
+					tileOffset += (unsigned)tiles[i][t].size();
+				}
+				for (unsigned t = 0u; t < numTiles; t++)
+					put32(tiff, (unsigned)tiles[i][t].size());
+				if (geoTags) {
+					for (const double v : pixelScale)
+						putDouble(tiff, v);
+					for (const double v : tiepoint)
+						putDouble(tiff, v);
+					for (const unsigned v : geoKeys)
+						put16(tiff, v);
+				}
+				dataOffset = tileOffset;
+			}
+			for (std::size_t i = 0u; i < images.size(); i++)
+				for (std::size_t t = 0u; t < tiles[i].size(); t++)
+					tiff.insert(tiff.end(), tiles[i][t].begin(), tiles[i][t].end());
+			return tiff;
+		}
+
+		std::string writeTiff(const std::vector<uint8_t> &tiff) {
+			TAK::Engine::Port::String path;
+			IO_createTempFile(path, "cogtest", ".tif", nullptr);
+			FileOutput2 out;
+			out.open(path);
+			out.write(&tiff[0], tiff.size());
+			out.close();
+			return path.get();
+		}
+	}
+
+	TEST(COGTileReaderTests, testReadFullResolution) {
+		for (int d = 0; d < 2; d++) {
+			const std::vector<TestImage> images{ { 40u, 24u, false } };
+			const std::string path = writeTiff(createTiff(images, !!d));
+
+			TileReader2Ptr reader(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, COGTileReader_open(reader, path.c_str(), nullptr));
+			int64_t width, height;
+			ASSERT_EQ(TE_Ok, reader->getWidth(&width));
+			ASSERT_EQ(TE_Ok, reader->getHeight(&height));
+			ASSERT_EQ(40, width);
+			ASSERT_EQ(24, height);
+			Bitmap2::Format format;
+			ASSERT_EQ(TE_Ok, reader->getFormat(&format));
+			ASSERT_EQ(Bitmap2::RGB24, format);
+
+			// region spanning tile boundaries
+			std::vector<uint8_t> buf(20u * 12u * 3u);
+			ASSERT_EQ(TE_Ok, reader->read(&buf[0], 10, 8, 20, 12, 20u, 12u));
+			for (unsigned y = 0u; y < 12u; y++)
+				for (unsigned x = 0u; x < 20u; x++)
+					for (unsigned s = 0u; s < 3u; s++)
+						ASSERT_EQ(getSample(0u, x + 10u, y + 8u, s), buf[((y * 20u + x) * 3u) + s]);
+			reader.reset();
+			IO_delete(path.c_str());
+		}
+	}
+
+	TEST(COGTileReaderTests, testSubsampledReadUsesOverview) {
+		const std::vector<TestImage> images{ { 64u, 64u, false }, { 32u, 32u, true }, { 16u, 16u, true } };
+		const std::string path = writeTiff(createTiff(images, true));
+
+		TileReader2Ptr reader(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, COGTileReader_open(reader, path.c_str(), nullptr));
+		bool multiRes;
+		ASSERT_EQ(TE_Ok, reader->isMultiResolution(&multiRes));
+		ASSERT_TRUE(multiRes);
+
+		std::vector<uint8_t> buf(16u * 16u * 3u);
+		ASSERT_EQ(TE_Ok, reader->read(&buf[0], 0, 0, 64, 64, 16u, 16u));
+		for (unsigned y = 0u; y < 16u; y++)
+			for (unsigned x = 0u; x < 16u; x++)
+				ASSERT_EQ(getSample(2u, x, y, 0u), buf[(y * 16u + x) * 3u]);
+
+		ASSERT_EQ(TE_Ok, reader->read(&buf[0], 0, 0, 32, 32, 16u, 16u));
+		for (unsigned y = 0u; y < 16u; y++)
+			for (unsigned x = 0u; x < 16u; x++)
+				ASSERT_EQ(getSample(1u, x, y, 1u), buf[((y * 16u + x) * 3u) + 1u]);
+		reader.reset();
+		IO_delete(path.c_str());
+	}
+
+	TEST(COGTileReaderTests, testReadTilesMatchesTileReads) {
+		const std::vector<TestImage> images{ { 64u, 48u, false }, { 32u, 24u, true } };
+		const std::string path = writeTiff(createTiff(images, true));
+
+		TileReader2Ptr reader(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, COGTileReader_open(reader, path.c_str(), nullptr));
+
+		std::vector<TileReader2::TileRead> tiles;
+		for (std::size_t level = 0u; level < 2u; level++) {
+			int64_t numTilesX, numTilesY;
+			ASSERT_EQ(TE_Ok, reader->getNumTilesX(&numTilesX, level));
+			ASSERT_EQ(TE_Ok, reader->getNumTilesY(&numTilesY, level));
+			for (int64_t row = 0; row < numTilesY; row++) {
+				for (int64_t column = 0; column < numTilesX; column++) {
+					TileReader2::TileRead tile;
+					tile.level = level;
+					tile.tileColumn = column;
+					tile.tileRow = row;
+					tile.data = nullptr;
+					tile.code = TE_Err;
+					tiles.push_back(tile);
+				}
+			}
+		}
+
+		const std::size_t tileBytes = tileSize * tileSize * 3u;
+		std::vector<uint8_t> batch(tiles.size() * tileBytes, 0u);
+		for (std::size_t i = 0u; i < tiles.size(); i++)
+			tiles[i].data = &batch[i * tileBytes];
+		ASSERT_EQ(TE_Ok, reader->readTiles(&tiles[0], tiles.size()));
+
+		std::vector<uint8_t> single(tileBytes);
+		for (std::size_t i = 0u; i < tiles.size(); i++) {
+			ASSERT_EQ(TE_Ok, tiles[i].code);
+			ASSERT_EQ(TE_Ok, reader->read(&single[0], tiles[i].level, tiles[i].tileColumn, tiles[i].tileRow));
+			std::size_t width, height;
+			ASSERT_EQ(TE_Ok, reader->getTileWidth(&width, tiles[i].level, tiles[i].tileColumn));
+			ASSERT_EQ(TE_Ok, reader->getTileHeight(&height, tiles[i].level, tiles[i].tileRow));
+			ASSERT_EQ(0, memcmp(&single[0], tiles[i].data, width * height * 3u));
+		}
+		reader.reset();
+		IO_delete(path.c_str());
+	}
+
+	TEST(COGTileReaderTests, testNotTiffUnsupported) {
+		const std::vector<uint8_t> data(64u, 0x55u);
+		const std::string path = writeTiff(data);
+		TileReader2Ptr reader(nullptr, nullptr);
+		ASSERT_EQ(TE_Unsupported, COGTileReader_open(reader, path.c_str(), nullptr));
+		IO_delete(path.c_str());
+	}
+
+	TEST(COGTileReaderTests, testSpiSupportedExtensions) {
+		COGTileReaderSpi spi;
+		ASSERT_EQ(TE_Ok, spi.isSupported("https://example.com/imagery/scene.TIF?token=abc"));
+		ASSERT_EQ(TE_Ok, spi.isSupported("/data/scene.tiff"));
+		ASSERT_EQ(TE_Unsupported, spi.isSupported("/data/scene.jp2"));
+	}
+
+	TEST(COGTileReaderTests, testGeoTiffProjection) {
+		const std::vector<TestImage> images{ { 40u, 24u, false }, { 20u, 12u, true } };
+		const std::string path = writeTiff(createTiff(images, false, true));
+
+		TileReader2Ptr reader(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, COGTileReader_open(reader, path.c_str(), nullptr));
+		const COGTileReader &cog = static_cast<const COGTileReader &>(*reader);
+		int srid;
+		ASSERT_EQ(TE_Ok, cog.getSpatialReferenceID(&srid));
+		ASSERT_EQ(4326, srid);
+
+		DatasetProjection2Ptr projection(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, cog.getDatasetProjection(projection));
+		GeoPoint2 ground;
+		ASSERT_EQ(TE_Ok, projection->imageToGround(&ground, Point2<double>(0.0, 0.0)));
+		ASSERT_NEAR(39.0, ground.latitude, 1e-9);
+		ASSERT_NEAR(-77.0, ground.longitude, 1e-9);
+		ASSERT_EQ(TE_Ok, projection->imageToGround(&ground, Point2<double>(40.0, 24.0)));
+		ASSERT_NEAR(38.76, ground.latitude, 1e-9);
+		ASSERT_NEAR(-76.6, ground.longitude, 1e-9);
+		reader.reset();
+		IO_delete(path.c_str());
+	}
+
+	TEST(COGTileReaderTests, testNoGeoTiffTagsNotGeoreferenced) {
+		const std::vector<TestImage> images{ { 40u, 24u, false } };
+		const std::string path = writeTiff(createTiff(images, false));
+
+		TileReader2Ptr reader(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, COGTileReader_open(reader, path.c_str(), nullptr));
+		DatasetProjection2Ptr projection(nullptr, nullptr);
+		ASSERT_EQ(TE_Unsupported, static_cast<const COGTileReader &>(*reader).getDatasetProjection(projection));
+		reader.reset();
+		IO_delete(path.c_str());
+	}
+
+	TEST(COGTileReaderTests, testFactoryCreatesReader) {
+		const std::vector<TestImage> images{ { 40u, 24u, false } };
+		const std::string path = writeTiff(createTiff(images, false));
+
+		ASSERT_EQ(TE_Ok, TileReaderFactory2_isSupported(path.c_str()));
+		TileReader2Ptr reader(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, TileReaderFactory2_create(reader, path.c_str()));
+		ASSERT_NE(nullptr, dynamic_cast<COGTileReader *>(reader.get()));
+		reader.reset();
+		IO_delete(path.c_str());
+	}
+}
@@ -0,0 +1,59 @@
+#include "pch.h"
+
+#include "core/CameraMotionPredictor.h"
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		MapSceneModel2 createScene(const double lat, const double lng, const double gsd) {
+			return MapSceneModel2(96.0, 1024u, 768u, 4326, GeoPoint2(lat, lng), 512.0f, 384.0f, 0.0, 0.0, gsd);
+		}
+	}
+
+	TEST(CameraMotionPredictorTests, testStationaryCameraNotPredicted) {
+		CameraMotionPredictor predictor;
+		MapSceneModel2 predicted;
+		ASSERT_EQ(TE_Done, predictor.predict(&predicted, 500LL));
+		for (int64_t t = 0LL; t <= 200LL; t += 20LL)
+			predictor.update(createScene(35.0, -80.0, 10.0), t);
+		ASSERT_EQ(TE_Done, predictor.predict(&predicted, 500LL));
+	}
+
+	TEST(CameraMotionPredictorTests, testPanExtrapolated) {
+		CameraMotionPredictor predictor;
+		// pan east at 0.001 degrees per millisecond
+		for (int64_t t = 0LL; t <= 200LL; t += 20LL)
+			predictor.update(createScene(35.0, -80.0 + (0.001 * (double)t), 10.0), t);
+		MapSceneModel2 predicted;
+		ASSERT_EQ(TE_Ok, predictor.predict(&predicted, 500LL));
+		GeoPoint2 focus;
+		ASSERT_EQ(TE_Ok, predicted.projection->inverse(&focus, predicted.camera.target));
+		ASSERT_NEAR(35.0, focus.latitude, 1e-6);
+		ASSERT_NEAR(-79.3, focus.longitude, 1e-6);
+		ASSERT_NEAR(10.0, predicted.gsd, 1e-6);
+	}
+
+	TEST(CameraMotionPredictorTests, testZoomExtrapolated) {
+		CameraMotionPredictor predictor;
+		// resolution halves over the history
+		predictor.update(createScene(35.0, -80.0, 10.0), 0LL);
+		predictor.update(createScene(35.0, -80.0, 5.0), 200LL);
+		MapSceneModel2 predicted;
+		ASSERT_EQ(TE_Ok, predictor.predict(&predicted, 200LL));
+		ASSERT_NEAR(2.5, predicted.gsd, 1e-6);
+	}
+
+	TEST(CameraMotionPredictorTests, testHistoryExpires) {
+		CameraMotionPredictor predictor(250LL);
+		predictor.update(createScene(35.0, -80.0, 10.0), 0LL);
+		predictor.update(createScene(35.0, -79.0, 10.0), 100LL);
+		// camera has since stopped; the motion is outside of the window
+		predictor.update(createScene(35.0, -79.0, 10.0), 400LL);
+		predictor.update(createScene(35.0, -79.0, 10.0), 420LL);
+		MapSceneModel2 predicted;
+		ASSERT_EQ(TE_Done, predictor.predict(&predicted, 500LL));
+	}
+}
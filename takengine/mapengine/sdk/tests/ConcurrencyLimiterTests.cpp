@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "port/Platform.h"
+#include "util/ConcurrencyLimiter.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(ConcurrencyLimiterTests, testInitialLimitClamped) {
+		ConcurrencyLimiter a(2u, 8u, 16u);
+		ASSERT_EQ(8u, a.getLimit());
+		ConcurrencyLimiter b(2u, 8u, 0u);
+		ASSERT_EQ(2u, b.getLimit());
+	}
+
+	TEST(ConcurrencyLimiterTests, testAdditiveIncrease) {
+		ConcurrencyLimiter limiter(1u, 8u, 2u);
+		// roughly one unit of increase per limit successes
+		for (int i = 0; i < 3; i++) {
+			ASSERT_EQ(TE_Ok, limiter.acquire());
+			limiter.release(TE_Ok, 10LL);
+		}
+		ASSERT_EQ(3u, limiter.getLimit());
+		for (int i = 0; i < 100; i++) {
+			ASSERT_EQ(TE_Ok, limiter.acquire());
+			limiter.release(TE_Ok, 10LL);
+		}
+		ASSERT_EQ(8u, limiter.getLimit());
+	}
+
+	TEST(ConcurrencyLimiterTests, testDecreaseOnLatency) {
+		ConcurrencyLimiter limiter(1u, 8u, 8u);
+		ASSERT_EQ(TE_Ok, limiter.acquire());
+		limiter.release(TE_Ok, 10LL);
+		ASSERT_EQ(TE_Ok, limiter.acquire());
+		limiter.release(TE_Ok, 100LL);
+		ASSERT_EQ(6u, limiter.getLimit());
+	}
+
+	TEST(ConcurrencyLimiterTests, testDecreaseOncePerWindow) {
+		ConcurrencyLimiter limiter(1u, 8u, 8u);
+		for (int i = 0; i < 4; i++)
+			ASSERT_EQ(TE_Ok, limiter.acquire());
+		// failures of requests that were in flight together are one event
+		for (int i = 0; i < 4; i++)
+			limiter.release(TE_IO, 10LL);
+		ASSERT_EQ(6u, limiter.getLimit());
+		ASSERT_EQ(TE_Ok, limiter.acquire());
+		limiter.release(TE_IO, 10LL);
+		ASSERT_EQ(4u, limiter.getLimit());
+	}
+
+	TEST(ConcurrencyLimiterTests, testBusyBacksOff) {
+		ConcurrencyLimiter limiter(1u, 8u, 8u);
+		ASSERT_EQ(TE_Ok, limiter.acquire());
+		limiter.release(TE_Busy, 10LL);
+		ASSERT_EQ(4u, limiter.getLimit());
+		const int64_t start = TAK::Engine::Port::Platform_systime_millis();
+		ASSERT_EQ(TE_Ok, limiter.acquire());
+		ASSERT_GE(TAK::Engine::Port::Platform_systime_millis() - start, 400LL);
+		limiter.release(TE_Ok, 10LL);
+	}
+
+	TEST(ConcurrencyLimiterTests, testInterrupt) {
+		ConcurrencyLimiter limiter(1u, 1u, 1u);
+		ASSERT_EQ(TE_Ok, limiter.acquire());
+		limiter.interrupt();
+		ASSERT_EQ(TE_Interrupted, limiter.acquire());
+		limiter.release(TE_Ok, 10LL);
+	}
+}
@@ -0,0 +1,151 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "util/DataInput2.h"
+#include "util/DataOutput2.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		std::string writeTestFile(const std::size_t len) {
+			std::string path = ::testing::TempDir() + "DataInput2Tests.bin";
+			FILE *f = fopen(path.c_str(), "wb");
+			for (std::size_t i = 0u; i < len; i++)
+				fputc((int)(i % 251u), f);
+			fclose(f);
+			return path;
+		}
+	}
+
+	TEST(DataInput2Tests, testMappedFileInputRead) {
+		const std::string path = writeTestFile(10000u);
+
+		MappedFileInput2 input;
+		ASSERT_EQ(TE_Ok, input.open(path.c_str(), TEMA_Sequential));
+		ASSERT_EQ(10000LL, input.length());
+
+		std::vector<uint8_t> buf(10000u);
+		std::size_t numRead;
+		ASSERT_EQ(TE_Ok, input.read(&buf[0], &numRead, buf.size()));
+		ASSERT_EQ(10000u, numRead);
+		for (std::size_t i = 0u; i < buf.size(); i++)
+			ASSERT_EQ((uint8_t)(i % 251u), buf[i]);
+		ASSERT_EQ(TE_EOF, input.read(&buf[0], &numRead, 1u));
+		ASSERT_EQ(TE_Ok, input.close());
+	}
+
+	TEST(DataInput2Tests, testMappedFileInputUnalignedRegion) {
+		const std::string path = writeTestFile(10000u);
+
+		MappedFileInput2 input;
+		ASSERT_EQ(TE_Ok, input.open(path.c_str(), 5003LL, 100LL, TEMA_Random));
+		ASSERT_EQ(100LL, input.length());
+
+		const uint8_t *data;
+		ASSERT_EQ(TE_Ok, input.getData(&data));
+		for (std::size_t i = 0u; i < 100u; i++)
+			ASSERT_EQ((uint8_t)((5003u + i) % 251u), data[i]);
+
+		ASSERT_EQ(TE_Ok, input.skip(10u));
+		std::size_t off;
+		ASSERT_EQ(TE_Ok, input.tell(&off));
+		ASSERT_EQ(10u, off);
+	}
+
+	TEST(DataInput2Tests, testMappedFileInputEmpty) {
+		const std::string path = writeTestFile(0u);
+
+		MappedFileInput2 input;
+		ASSERT_EQ(TE_Ok, input.open(path.c_str()));
+		ASSERT_EQ(0LL, input.length());
+		uint8_t b;
+		ASSERT_EQ(TE_EOF, input.readByte(&b));
+	}
+
+	TEST(DataInput2Tests, testMappedFileInputRejectsBuffer) {
+		const uint8_t bytes[4] = { 0u, 1u, 2u, 3u };
+		MappedFileInput2 input;
+		ASSERT_EQ(TE_Unsupported, input.open(bytes, 4u));
+	}
+
+	TEST(DataInput2Tests, testMemoryInputReadSpan) {
+		const uint8_t bytes[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		MemoryInput2 input;
+		ASSERT_EQ(TE_Ok, input.open(bytes, sizeof(bytes)));
+
+		const uint8_t *span;
+		ASSERT_EQ(TE_Ok, input.readSpan(&span, 3u));
+		ASSERT_EQ(bytes, span);
+
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, input.peek(&span, &len));
+		ASSERT_EQ(bytes + 3, span);
+		ASSERT_EQ(5u, len);
+
+		// a span that cannot be satisfied does not advance
+		ASSERT_EQ(TE_IO, input.readSpan(&span, 6u));
+		ASSERT_EQ(TE_Ok, input.readSpan(&span, 5u));
+		ASSERT_EQ(bytes + 3, span);
+		ASSERT_EQ(TE_EOF, input.readSpan(&span, 1u));
+	}
+
+	TEST(DataInput2Tests, testDynamicOutputRoundTrip) {
+		const TAKEndian endians[2] = { TE_BigEndian, TE_LittleEndian };
+		for (std::size_t i = 0u; i < 2u; i++) {
+			DynamicOutput output;
+			ASSERT_EQ(TE_Ok, output.open(4u));
+			output.setSourceEndian2(endians[i]);
+			ASSERT_EQ(TE_Ok, output.writeInt(0x01020304));
+			ASSERT_EQ(TE_Ok, output.writeShort(0x0506));
+			ASSERT_EQ(TE_Ok, output.writeDouble(1.5));
+
+			const uint8_t payload[3] = { 7, 8, 9 };
+			const DataOutput2::Segment segments[2] = { { payload, 2u }, { payload + 2, 1u } };
+			ASSERT_EQ(TE_Ok, output.writev(segments, 2u));
+
+			const uint8_t *data;
+			std::size_t len;
+			ASSERT_EQ(TE_Ok, output.get(&data, &len));
+			ASSERT_EQ(17u, len);
+			ASSERT_EQ((endians[i] == TE_BigEndian) ? 0x01 : 0x04, data[0]);
+
+			MemoryInput2 input;
+			ASSERT_EQ(TE_Ok, input.open(data, len));
+			input.setSourceEndian2(endians[i]);
+			int32_t ival;
+			ASSERT_EQ(TE_Ok, input.readInt(&ival));
+			ASSERT_EQ(0x01020304, ival);
+			int16_t sval;
+			ASSERT_EQ(TE_Ok, input.readShort(&sval));
+			ASSERT_EQ(0x0506, sval);
+			double dval;
+			ASSERT_EQ(TE_Ok, input.readDouble(&dval));
+			ASSERT_EQ(1.5, dval);
+			const uint8_t *span;
+			ASSERT_EQ(TE_Ok, input.readSpan(&span, 3u));
+			ASSERT_EQ(0, memcmp(payload, span, 3u));
+			ASSERT_EQ(TE_EOF, input.readInt(&ival));
+		}
+	}
+
+	TEST(DataInput2Tests, testMemoryOutputWritevBounds) {
+		uint8_t buf[4];
+		MemoryOutput2 output;
+		ASSERT_EQ(TE_Ok, output.open(buf, sizeof(buf)));
+
+		const uint8_t payload[3] = { 1, 2, 3 };
+		const DataOutput2::Segment segments[2] = { { payload, 3u }, { payload, 3u } };
+		// rejected without partial output
+		ASSERT_EQ(TE_IO, output.writev(segments, 2u));
+		std::size_t remaining;
+		ASSERT_EQ(TE_Ok, output.remaining(&remaining));
+		ASSERT_EQ(4u, remaining);
+		ASSERT_EQ(TE_Ok, output.writev(segments, 1u));
+		ASSERT_EQ(TE_Ok, output.remaining(&remaining));
+		ASSERT_EQ(1u, remaining);
+	}
+}
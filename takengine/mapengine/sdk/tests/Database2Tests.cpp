@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include "db/Database2.h"
+#include "db/Query.h"
+#include "db/Statement2.h"
+
+using namespace TAK::Engine::DB;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(Database2Tests, testCachedStatementsAreReset) {
+		DatabasePtr db(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Databases_openDatabase(db, nullptr));
+		ASSERT_EQ(TE_Ok, db->execute("CREATE TABLE test (value INTEGER)", nullptr, 0u));
+
+		for (int32_t i = 0; i < 3; i++) {
+			StatementPtr stmt(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, db->compileStatement(stmt, "INSERT INTO test (value) VALUES (?)"));
+			if (i < 2)
+				ASSERT_EQ(TE_Ok, stmt->bindInt(1u, i + 1));
+			// bindings from the prior use are cleared
+			ASSERT_EQ(TE_Ok, stmt->execute());
+		}
+
+		for (int pass = 0; pass < 2; pass++) {
+			QueryPtr query(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, db->compileQuery(query, "SELECT count(*), sum(value) FROM test WHERE value IS NOT NULL"));
+			// a cached query is handed out from the first row
+			ASSERT_EQ(TE_Ok, query->moveToNext());
+			int32_t count = -1;
+			int32_t sum = -1;
+			ASSERT_EQ(TE_Ok, query->getInt(&count, 0u));
+			ASSERT_EQ(TE_Ok, query->getInt(&sum, 1u));
+			ASSERT_EQ(2, count);
+			ASSERT_EQ(3, sum);
+		}
+
+		// outstanding statements remain valid when the same SQL is compiled concurrently
+		QueryPtr a(nullptr, nullptr);
+		QueryPtr b(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, db->compileQuery(a, "SELECT value FROM test"));
+		ASSERT_EQ(TE_Ok, db->compileQuery(b, "SELECT value FROM test"));
+		ASSERT_EQ(TE_Ok, a->moveToNext());
+		ASSERT_EQ(TE_Ok, b->moveToNext());
+		ASSERT_EQ(TE_Ok, b->moveToNext());
+		ASSERT_EQ(TE_Ok, a->moveToNext());
+
+		// statements may outlive the database
+		db.reset();
+		a.reset();
+		b.reset();
+	}
+
+	TEST(Database2Tests, testApplyProfile) {
+		DatabasePtr db(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Databases_openDatabase(db, nullptr));
+		ASSERT_EQ(TE_Ok, Databases_applyProfile(*db, TEDP_TileCache));
+
+		const char *pragmas[3u] = { "PRAGMA page_size", "PRAGMA cache_size", "PRAGMA synchronous" };
+		const int32_t expected[3u] = { 8192, -8192, 1 };
+		for (std::size_t i = 0u; i < 3u; i++) {
+			QueryPtr query(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, db->query(query, pragmas[i]));
+			ASSERT_EQ(TE_Ok, query->moveToNext());
+			int32_t value = 0;
+			ASSERT_EQ(TE_Ok, query->getInt(&value, 0u));
+			ASSERT_EQ(expected[i], value);
+		}
+
+		ASSERT_EQ(TE_Ok, Databases_applyProfile(*db, TEDP_Default));
+	}
+}
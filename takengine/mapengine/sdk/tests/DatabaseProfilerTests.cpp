@@ -0,0 +1,78 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "db/DatabaseProfiler.h"
+#include "db/Query.h"
+#include "db/Statement2.h"
+#include "port/STLVectorAdapter.h"
+
+using namespace TAK::Engine::DB;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		const QueryProfile *findProfile(const std::vector<std::shared_ptr<QueryProfile>> &profiles, const char *sql)
+		{
+			for (std::size_t i = 0u; i < profiles.size(); i++)
+				if (!strcmp(profiles[i]->sql, sql))
+					return profiles[i].get();
+			return nullptr;
+		}
+	}
+
+	TEST(DatabaseProfilerTests, testRecordsNormalizedStatistics) {
+		ASSERT_EQ(TE_Ok, DatabaseProfiler_reset());
+		DatabaseProfiler_setSlowQueryThreshold(0LL);
+
+		DatabasePtr db(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Databases_openDatabase(db, nullptr));
+		ASSERT_EQ(TE_Ok, DatabaseProfiler_instrument(db));
+
+		ASSERT_EQ(TE_Ok, db->execute("CREATE TABLE test (value INTEGER, name TEXT)", nullptr, 0u));
+		// literals are normalized
+		ASSERT_EQ(TE_Ok, db->execute("INSERT INTO test (value, name) VALUES (1, 'a')", nullptr, 0u));
+		ASSERT_EQ(TE_Ok, db->execute("INSERT INTO  test (value, name)\n VALUES (22, 'it''s')", nullptr, 0u));
+
+		StatementPtr stmt(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, db->compileStatement(stmt, "INSERT INTO test (value, name) VALUES (?, ?)"));
+		ASSERT_EQ(TE_Ok, stmt->bindInt(1u, 3));
+		ASSERT_EQ(TE_Ok, stmt->bindString(2u, "c"));
+		ASSERT_EQ(TE_Ok, stmt->execute());
+		stmt.reset();
+
+		{
+			QueryPtr query(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, db->compileQuery(query, "SELECT value FROM test WHERE value > ?"));
+			ASSERT_EQ(TE_Ok, query->bindInt(1u, 0));
+			while (query->moveToNext() == TE_Ok)
+				;
+			// clearing bindings starts a new execution
+			ASSERT_EQ(TE_Ok, query->clearBindings());
+			ASSERT_EQ(TE_Ok, query->bindInt(1u, 2));
+			while (query->moveToNext() == TE_Ok)
+				;
+		}
+
+		std::vector<std::shared_ptr<QueryProfile>> profiles;
+		STLVectorAdapter<std::shared_ptr<QueryProfile>> profilesAdapter(profiles);
+		ASSERT_EQ(TE_Ok, DatabaseProfiler_snapshot(profilesAdapter));
+
+		const QueryProfile *insert = findProfile(profiles, "INSERT INTO test (value, name) VALUES (?, ?)");
+		ASSERT_TRUE(insert != nullptr);
+		ASSERT_EQ(3u, insert->count);
+		ASSERT_GE(insert->totalTime, insert->maxTime);
+
+		const QueryProfile *select = findProfile(profiles, "SELECT value FROM test WHERE value > ?");
+		ASSERT_TRUE(select != nullptr);
+		ASSERT_EQ(2u, select->count);
+		ASSERT_EQ(5u, select->rows);
+
+		ASSERT_EQ(TE_Ok, DatabaseProfiler_reset());
+		profiles.clear();
+		ASSERT_EQ(TE_Ok, DatabaseProfiler_snapshot(profilesAdapter));
+		ASSERT_TRUE(profiles.empty());
+	}
+}
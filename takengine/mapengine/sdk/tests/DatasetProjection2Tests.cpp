@@ -0,0 +1,44 @@
+#include "pch.h"
+
+#include "raster/DatasetProjection2.h"
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Raster;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(DatasetProjection2Tests, testBatchMatchesPointwise) {
+		const int srids[2u] = { 4326, 3857 };
+		for (std::size_t i = 0u; i < 2u; i++) {
+			DatasetProjection2Ptr proj(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, DatasetProjection2_create(proj, srids[i], 1024u, 512u,
+				GeoPoint2(39.0, -77.5), GeoPoint2(39.0, -77.0), GeoPoint2(38.5, -77.0), GeoPoint2(38.5, -77.5)));
+
+			Point2<double> img[4u];
+			img[0] = Point2<double>(0.0, 0.0);
+			img[1] = Point2<double>(1023.0, 0.0);
+			img[2] = Point2<double>(511.5, 255.5);
+			img[3] = Point2<double>(100.0, 400.0);
+
+			GeoPoint2 geo[4u];
+			ASSERT_EQ(TE_Ok, proj->imageToGround(geo, img, 4u));
+			Point2<double> roundtrip[4u];
+			ASSERT_EQ(TE_Ok, proj->groundToImage(roundtrip, geo, 4u));
+			for (std::size_t j = 0u; j < 4u; j++) {
+				GeoPoint2 expected;
+				ASSERT_EQ(TE_Ok, proj->imageToGround(&expected, img[j]));
+				ASSERT_NEAR(expected.latitude, geo[j].latitude, 1e-9);
+				ASSERT_NEAR(expected.longitude, geo[j].longitude, 1e-9);
+
+				Point2<double> expectedImg;
+				ASSERT_EQ(TE_Ok, proj->groundToImage(&expectedImg, geo[j]));
+				ASSERT_NEAR(expectedImg.x, roundtrip[j].x, 1e-6);
+				ASSERT_NEAR(expectedImg.y, roundtrip[j].y, 1e-6);
+				ASSERT_NEAR(img[j].x, roundtrip[j].x, 1e-3);
+				ASSERT_NEAR(img[j].y, roundtrip[j].y, 1e-3);
+			}
+		}
+	}
+}
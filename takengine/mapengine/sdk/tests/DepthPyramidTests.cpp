@@ -0,0 +1,49 @@
+#include "pch.h"
+
+#include "renderer/DepthPyramid.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(DepthPyramidTests, testEmptyIsRejected) {
+		DepthPyramid pyramid;
+		float depth = 0.5f;
+		ASSERT_EQ(TE_InvalidArg, pyramid.build(&depth, 0u, 1u));
+		ASSERT_EQ(TE_InvalidArg, pyramid.build(nullptr, 1u, 1u));
+		ASSERT_TRUE(isnan(pyramid.getFarthest(0, 0, 0, 0)));
+	}
+
+	TEST(DepthPyramidTests, testSinglePixel) {
+		DepthPyramid pyramid;
+		std::vector<float> depth(7u * 5u, 0.25f);
+		depth[(2u * 7u) + 3u] = 0.75f;
+		ASSERT_EQ(TE_Ok, pyramid.build(depth.data(), 7u, 5u));
+		ASSERT_EQ(7u, pyramid.getWidth());
+		ASSERT_EQ(5u, pyramid.getHeight());
+		ASSERT_EQ(0.75f, pyramid.getFarthest(3, 2, 3, 2));
+		ASSERT_EQ(0.25f, pyramid.getFarthest(2, 2, 2, 2));
+	}
+
+	TEST(DepthPyramidTests, testRectIsConservative) {
+		DepthPyramid pyramid;
+		std::vector<float> depth(64u * 48u, 0.25f);
+		depth[(47u * 64u) + 63u] = 0.9f;
+		ASSERT_EQ(TE_Ok, pyramid.build(depth.data(), 64u, 48u));
+		// the far pixel is always reported when inside the rectangle
+		ASSERT_EQ(0.9f, pyramid.getFarthest(0, 0, 63, 47));
+		ASSERT_EQ(0.9f, pyramid.getFarthest(40, 30, 63, 47));
+		// the farthest value is never less than the true farthest
+		ASSERT_GE(pyramid.getFarthest(0, 0, 10, 10), 0.25f);
+	}
+
+	TEST(DepthPyramidTests, testRectIsClamped) {
+		DepthPyramid pyramid;
+		std::vector<float> depth(16u * 16u, 0.5f);
+		ASSERT_EQ(TE_Ok, pyramid.build(depth.data(), 16u, 16u));
+		ASSERT_EQ(0.5f, pyramid.getFarthest(-4, -4, 100, 100));
+		ASSERT_TRUE(isnan(pyramid.getFarthest(16, 0, 20, 4)));
+		ASSERT_TRUE(isnan(pyramid.getFarthest(-8, -8, -1, -1)));
+	}
+}
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "renderer/DistanceField.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		// 8x8 bitmap with a 6x6 opaque square; the border of the square is
+		// black, the interior white
+		void createOutlinedSquare(Bitmap2 &value) {
+			memset(value.getData(), 0, value.getStride()*value.getHeight());
+			for (std::size_t y = 1u; y < 7u; y++) {
+				for (std::size_t x = 1u; x < 7u; x++) {
+					uint8_t *px = value.getData() + (y*value.getStride()) + (x*4u);
+					const bool outline = (x == 1u || x == 6u || y == 1u || y == 6u);
+					px[0] = px[1] = px[2] = outline ? 0x00u : 0xFFu;
+					px[3] = 0xFFu;
+				}
+			}
+		}
+		uint8_t sample(const Bitmap2 &bitmap, const std::size_t x, const std::size_t y, const std::size_t channel) {
+			return bitmap.getData()[(y*bitmap.getStride()) + (x*4u) + channel];
+		}
+	}
+
+	TEST(DistanceFieldTests, testOutputIsPadded) {
+		Bitmap2 bitmap(8u, 8u, Bitmap2::RGBA32);
+		createOutlinedSquare(bitmap);
+		BitmapPtr field(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, DistanceField_create(field, bitmap, 4u));
+		ASSERT_EQ(16u, field->getWidth());
+		ASSERT_EQ(16u, field->getHeight());
+		ASSERT_EQ(Bitmap2::RGBA32, field->getFormat());
+	}
+
+	TEST(DistanceFieldTests, testInsideAndOutside) {
+		Bitmap2 bitmap(8u, 8u, Bitmap2::RGBA32);
+		createOutlinedSquare(bitmap);
+		BitmapPtr field(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, DistanceField_create(field, bitmap, 4u));
+		// center of the square
+		ASSERT_GT(sample(*field, 7u, 7u, 3u), 128u);
+		ASSERT_GT(sample(*field, 7u, 7u, 0u), 128u);
+		// padding
+		ASSERT_LT(sample(*field, 0u, 0u, 3u), 128u);
+		ASSERT_LT(sample(*field, 0u, 0u, 0u), 128u);
+		// distance increases toward the center
+		ASSERT_LT(sample(*field, 5u, 7u, 3u), sample(*field, 6u, 7u, 3u));
+		ASSERT_LT(sample(*field, 6u, 7u, 3u), sample(*field, 7u, 7u, 3u));
+	}
+
+	TEST(DistanceFieldTests, testOutlineIsPreserved) {
+		Bitmap2 bitmap(8u, 8u, Bitmap2::RGBA32);
+		createOutlinedSquare(bitmap);
+		BitmapPtr field(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, DistanceField_create(field, bitmap, 4u));
+		// the outline is opaque, but not part of the fill
+		ASSERT_GT(sample(*field, 5u, 7u, 3u), 128u);
+		ASSERT_LT(sample(*field, 5u, 7u, 0u), 128u);
+		ASSERT_EQ(sample(*field, 5u, 7u, 0u), sample(*field, 5u, 7u, 1u));
+		ASSERT_EQ(sample(*field, 5u, 7u, 0u), sample(*field, 5u, 7u, 2u));
+	}
+
+	TEST(DistanceFieldTests, testEmptyBitmapIsRejected) {
+		Bitmap2 bitmap(0u, 0u, Bitmap2::RGBA32);
+		BitmapPtr field(nullptr, nullptr);
+		ASSERT_EQ(TE_InvalidArg, DistanceField_create(field, bitmap, 4u));
+	}
+}
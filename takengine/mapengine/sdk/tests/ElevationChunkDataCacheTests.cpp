@@ -0,0 +1,136 @@
+#include "pch.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "elevation/ElevationChunkDataCache.h"
+#include "model/MeshBuilder.h"
+
+using namespace TAK::Engine::Elevation;
+using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		std::shared_ptr<const ElevationChunk::Data> createData()
+		{
+			MeshBuilder builder(TEDM_Triangles, TEVA_Position);
+			builder.addVertex(0.0, 0.0, 10.0, nullptr, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+			builder.addVertex(1.0, 0.0, 20.0, nullptr, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+			builder.addVertex(0.0, 1.0, 30.0, nullptr, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+			MeshPtr mesh(nullptr, nullptr);
+			builder.build(mesh);
+
+			std::shared_ptr<ElevationChunk::Data> data(new ElevationChunk::Data());
+			data->value = std::move(mesh);
+			data->srid = 4326;
+			return data;
+		}
+
+		std::size_t dataSize()
+		{
+			ElevationChunkDataCache cache(1024u * 1024u);
+			std::shared_ptr<const ElevationChunk::Data> data;
+			cache.acquire(data, "dted://size");
+			cache.put("dted://size", createData());
+			return cache.getSize();
+		}
+
+		std::string createUri(const int i)
+		{
+			return "dted://n3" + std::to_string(i) + "_w077.dt2";
+		}
+	}
+
+	TEST(ElevationChunkDataCacheTests, testSingleLoad) {
+		ElevationChunkDataCache cache(1024u * 1024u);
+		const char *uri = "dted://n34_w077.dt2";
+
+		std::shared_ptr<const ElevationChunk::Data> data;
+		ASSERT_EQ(TE_Done, cache.acquire(data, uri));
+
+		// a concurrent request waits for the load
+		std::shared_ptr<const ElevationChunk::Data> waited;
+		TAKErr waitedCode = TE_Err;
+		std::thread waiter([&]() { waitedCode = cache.acquire(waited, uri); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		const std::shared_ptr<const ElevationChunk::Data> loaded = createData();
+		cache.put(uri, loaded);
+		waiter.join();
+		ASSERT_EQ(TE_Ok, waitedCode);
+		ASSERT_EQ(loaded.get(), waited.get());
+
+		ASSERT_EQ(TE_Ok, cache.acquire(data, uri));
+		ASSERT_EQ(loaded.get(), data.get());
+		ASSERT_LT(0u, cache.getSize());
+	}
+
+	TEST(ElevationChunkDataCacheTests, testAbandonRedirectsLoad) {
+		ElevationChunkDataCache cache(1024u * 1024u);
+		const char *uri = "dted://n34_w077.dt2";
+
+		std::shared_ptr<const ElevationChunk::Data> data;
+		ASSERT_EQ(TE_Done, cache.acquire(data, uri));
+		cache.abandon(uri);
+		ASSERT_EQ(TE_Done, cache.acquire(data, uri));
+		cache.abandon(uri);
+		ASSERT_EQ(0u, cache.getSize());
+	}
+
+	TEST(ElevationChunkDataCacheTests, testLeastRecentlyUsedEviction) {
+		const std::size_t size = dataSize();
+		ASSERT_LT(0u, size);
+
+		// budget of two chunks
+		ElevationChunkDataCache cache(2u * size);
+		std::shared_ptr<const ElevationChunk::Data> data;
+		for (int i = 0; i < 2; i++) {
+			ASSERT_EQ(TE_Done, cache.acquire(data, createUri(i).c_str()));
+			cache.put(createUri(i).c_str(), createData());
+		}
+		// touch the oldest; the other becomes least recently used
+		ASSERT_EQ(TE_Ok, cache.acquire(data, createUri(0).c_str()));
+		ASSERT_EQ(TE_Done, cache.acquire(data, createUri(2).c_str()));
+		cache.put(createUri(2).c_str(), createData());
+		ASSERT_EQ(2u * size, cache.getSize());
+
+		ASSERT_EQ(TE_Done, cache.acquire(data, createUri(1).c_str()));
+		cache.abandon(createUri(1).c_str());
+		ASSERT_EQ(TE_Ok, cache.acquire(data, createUri(0).c_str()));
+		ASSERT_EQ(TE_Ok, cache.acquire(data, createUri(2).c_str()));
+
+		cache.clear();
+		ASSERT_EQ(0u, cache.getSize());
+	}
+
+	TEST(ElevationChunkDataCacheTests, testPinnedNotEvicted) {
+		const std::size_t size = dataSize();
+
+		// budget of one chunk
+		ElevationChunkDataCache cache(size);
+		std::shared_ptr<const ElevationChunk::Data> data;
+		cache.pin(createUri(0).c_str());
+		for (int i = 0; i < 2; i++) {
+			ASSERT_EQ(TE_Done, cache.acquire(data, createUri(i).c_str()));
+			cache.put(createUri(i).c_str(), createData());
+		}
+		// the pinned chunk is retained although least recently used
+		ASSERT_EQ(TE_Ok, cache.acquire(data, createUri(0).c_str()));
+		ASSERT_EQ(TE_Done, cache.acquire(data, createUri(1).c_str()));
+		cache.abandon(createUri(1).c_str());
+		ASSERT_EQ(size, cache.getSize());
+
+		cache.clear();
+		ASSERT_EQ(size, cache.getSize());
+
+		// once unpinned, the chunk is subject to eviction
+		cache.unpin(createUri(0).c_str());
+		ASSERT_EQ(TE_Done, cache.acquire(data, createUri(1).c_str()));
+		cache.put(createUri(1).c_str(), createData());
+		ASSERT_EQ(TE_Done, cache.acquire(data, createUri(0).c_str()));
+		cache.abandon(createUri(0).c_str());
+		ASSERT_EQ(size, cache.getSize());
+	}
+}
@@ -1,5 +1,10 @@
 #include "pch.h"
 
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <formats/quantizedmesh/QuantizedMeshDecode.h>
 #include <formats/quantizedmesh/TerrainData.h>
 
 using namespace TAK::Engine::Util;
@@ -9,6 +14,50 @@ using namespace TAK::Engine::Tests;
 
 namespace takenginetests
 {
+    namespace
+    {
+        void putUInt16(std::vector<uint8_t> &buf, const uint16_t v)
+        {
+            buf.push_back((uint8_t)(v & 0xFFu));
+            buf.push_back((uint8_t)((v >> 8u) & 0xFFu));
+        }
+        void putUInt32(std::vector<uint8_t> &buf, const uint32_t v)
+        {
+            putUInt16(buf, (uint16_t)(v & 0xFFFFu));
+            putUInt16(buf, (uint16_t)(v >> 16u));
+        }
+        void putDouble(std::vector<uint8_t> &buf, const double v)
+        {
+            uint64_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            putUInt32(buf, (uint32_t)(bits & 0xFFFFFFFFu));
+            putUInt32(buf, (uint32_t)(bits >> 32u));
+        }
+        void putFloat(std::vector<uint8_t> &buf, const float v)
+        {
+            uint32_t bits;
+            memcpy(&bits, &v, sizeof(bits));
+            putUInt32(buf, bits);
+        }
+        void putZigZagDelta(std::vector<uint8_t> &buf, const std::vector<uint16_t> &values)
+        {
+            int previous = 0;
+            for (auto v : values) {
+                const int delta = (int)v - previous;
+                putUInt16(buf, (uint16_t)((delta << 1) ^ (delta >> 31)));
+                previous = v;
+            }
+        }
+        void putHighWaterMark(std::vector<uint8_t> &buf, const std::vector<uint16_t> &indices)
+        {
+            uint16_t highest = 0u;
+            for (auto index : indices) {
+                putUInt16(buf, (uint16_t)(highest - index));
+                if (index == highest)
+                    highest++;
+            }
+        }
+    }
 
     class ElevationMeshTileTests : public ::testing::Test
     {
@@ -44,4 +93,109 @@ namespace takenginetests
         
     }
 
+    TEST_F(ElevationMeshTileTests, ZigZagDeltaDecode)
+    {
+        std::mt19937 rng(7u);
+        std::uniform_int_distribution<int> dist(0, 32767);
+        // exercise both the vectorized body and the remainder
+        std::vector<uint16_t> values(37u);
+        for (auto &v : values)
+            v = (uint16_t)dist(rng);
+        std::vector<uint8_t> encoded;
+        putZigZagDelta(encoded, values);
+
+        std::vector<uint16_t> decoded(values.size());
+        QuantizedMesh_decodeZigZagDelta(decoded.data(), 1u, encoded.data(), values.size());
+        ASSERT_EQ(values, decoded);
+
+        std::vector<uint16_t> interleaved(values.size()*3u, 0xFFFFu);
+        QuantizedMesh_decodeZigZagDelta(interleaved.data() + 1u, 3u, encoded.data(), values.size());
+        for (std::size_t i = 0u; i < values.size(); i++) {
+            ASSERT_EQ(values[i], interleaved[i*3u+1u]);
+            ASSERT_EQ(0xFFFFu, interleaved[i*3u]);
+            ASSERT_EQ(0xFFFFu, interleaved[i*3u+2u]);
+        }
+    }
+
+    TEST_F(ElevationMeshTileTests, HighWaterMarkDecode)
+    {
+        const std::vector<uint16_t> indices{ 0u, 1u, 2u, 0u, 2u, 3u, 3u, 2u, 4u };
+        std::vector<uint8_t> encoded;
+        putHighWaterMark(encoded, indices);
+
+        std::vector<uint16_t> decoded(indices.size());
+        ASSERT_EQ(TE_Ok, QuantizedMesh_decodeHighWaterMark(decoded.data(), encoded.data(), indices.size(), 5u));
+        ASSERT_EQ(indices, decoded);
+
+        std::vector<uint32_t> decoded32(indices.size());
+        std::vector<uint8_t> encoded32;
+        for (std::size_t i = 0u; i < indices.size(); i++)
+            putUInt32(encoded32, (uint32_t)(encoded[i*2u] | (encoded[i*2u+1u] << 8u)));
+        ASSERT_EQ(TE_Ok, QuantizedMesh_decodeHighWaterMark(decoded32.data(), encoded32.data(), indices.size(), 5u));
+        for (std::size_t i = 0u; i < indices.size(); i++)
+            ASSERT_EQ(indices[i], decoded32[i]);
+
+        // references a vertex that does not exist
+        ASSERT_EQ(TE_InvalidArg, QuantizedMesh_decodeHighWaterMark(decoded.data(), encoded.data(), indices.size(), 4u));
+    }
+
+    TEST_F(ElevationMeshTileTests, ParseFromMemory)
+    {
+        // level 1 tile covering [0, 90] longitude, [0, 90] latitude
+        std::vector<uint8_t> tile;
+        for (int i = 0; i < 3; i++)
+            putDouble(tile, 0.0);
+        putFloat(tile, 100.f);
+        putFloat(tile, 200.f);
+        for (int i = 0; i < 7; i++)
+            putDouble(tile, 0.0);
+        // the tile is located by its ECEF center, 45N 45E
+        {
+            const double lat = 45.0 * M_PI / 180.0;
+            const double lng = 45.0 * M_PI / 180.0;
+            const double a = 6378137.0;
+            const double e2 = 0.00669437999014;
+            const double n = a / sqrt(1.0 - e2 * sin(lat) * sin(lat));
+            std::vector<uint8_t> center;
+            putDouble(center, n * cos(lat) * cos(lng));
+            putDouble(center, n * cos(lat) * sin(lng));
+            putDouble(center, n * (1.0 - e2) * sin(lat));
+            memcpy(tile.data(), center.data(), center.size());
+        }
+
+        const std::vector<uint16_t> u{ 0u, 32767u, 32767u, 0u };
+        const std::vector<uint16_t> v{ 0u, 0u, 32767u, 32767u };
+        const std::vector<uint16_t> h{ 0u, 32767u, 16384u, 0u };
+        putUInt32(tile, 4u);
+        putZigZagDelta(tile, u);
+        putZigZagDelta(tile, v);
+        putZigZagDelta(tile, h);
+        putUInt32(tile, 2u);
+        putHighWaterMark(tile, { 0u, 1u, 2u, 0u, 2u, 3u });
+        // west, south, east, north edges
+        putUInt32(tile, 2u); putUInt16(tile, 0u); putUInt16(tile, 3u);
+        putUInt32(tile, 2u); putUInt16(tile, 0u); putUInt16(tile, 1u);
+        putUInt32(tile, 2u); putUInt16(tile, 1u); putUInt16(tile, 2u);
+        putUInt32(tile, 2u); putUInt16(tile, 3u); putUInt16(tile, 2u);
+
+        auto td = TerrainData(1);
+        ASSERT_EQ(TE_Ok, td.parseTerrainData(tile.data(), tile.size(), 1));
+
+        TAK::Engine::Elevation::ElevationChunk::Data data;
+        ASSERT_EQ(TE_Ok, td.getMeshData(data));
+        ASSERT_TRUE(!!data.value);
+        ASSERT_EQ(4u, data.value->getNumVertices());
+        ASSERT_EQ(6u, data.value->getNumIndices());
+        ASSERT_EQ(4326, data.srid);
+
+        TAK::Engine::Math::Point2<double> p;
+        ASSERT_EQ(TE_Ok, data.value->getPosition(&p, 2u));
+        data.localFrame.transform(&p, p);
+        ASSERT_NEAR(90.0, p.x, 1e-9);
+        ASSERT_NEAR(90.0, p.y, 1e-9);
+
+        // truncated input
+        auto truncated = TerrainData(1);
+        ASSERT_NE(TE_Ok, truncated.parseTerrainData(tile.data(), tile.size() - 4u, 1));
+    }
 }
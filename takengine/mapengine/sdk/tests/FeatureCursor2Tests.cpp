@@ -0,0 +1,106 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "feature/FeatureCursor2.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		class MockCursor : public FeatureCursor2
+		{
+		public :
+			MockCursor(const std::size_t count_) NOTHROWS :
+				count(count_),
+				row(0u)
+			{}
+			~MockCursor() NOTHROWS override
+			{}
+		public :
+			TAKErr moveToNext() NOTHROWS override
+			{
+				if (row >= count)
+					return TE_Done;
+				row++;
+				blob.assign(row, static_cast<uint8_t>(row));
+				return TE_Ok;
+			}
+			TAKErr getId(int64_t *value) NOTHROWS override { *value = static_cast<int64_t>(row); return TE_Ok; }
+			TAKErr getFeatureSetId(int64_t *value) NOTHROWS override { *value = 7LL; return TE_Ok; }
+			TAKErr getVersion(int64_t *value) NOTHROWS override { *value = static_cast<int64_t>(row) * 10LL; return TE_Ok; }
+			TAKErr getRawGeometry(RawData *value) NOTHROWS override
+			{
+				value->binary.value = blob.data();
+				value->binary.len = blob.size();
+				return TE_Ok;
+			}
+			GeometryEncoding getGeomCoding() NOTHROWS override { return GeomWkb; }
+			AltitudeMode getAltitudeMode() NOTHROWS override { return TEAM_ClampToGround; }
+			double getExtrude() NOTHROWS override { return 0.0; }
+			TAKErr getName(const char **value) NOTHROWS override { *value = nullptr; return TE_Ok; }
+			StyleEncoding getStyleCoding() NOTHROWS override { return StyleOgr; }
+			TAKErr getRawStyle(RawData *value) NOTHROWS override { value->text = nullptr; return TE_Ok; }
+			TAKErr getAttributes(const atakmap::util::AttributeSet **value) NOTHROWS override { *value = nullptr; return TE_Ok; }
+			TAKErr get(const Feature2 **value) NOTHROWS override { return TE_Unsupported; }
+		private :
+			std::size_t count;
+			std::size_t row;
+			std::vector<uint8_t> blob;
+		};
+	}
+
+	TEST(FeatureCursor2Tests, testDefaultFetch) {
+		MockCursor cursor(5u);
+
+		int64_t ids[3u];
+		int64_t fsids[3u];
+		int64_t versions[3u];
+		FeatureDefinition2::RawData geometries[3u];
+		int64_t styleIds[3u];
+		DynamicOutput geometryData;
+		ASSERT_EQ(TE_Ok, geometryData.open(1u));
+
+		FeatureColumns columns;
+		columns.ids = ids;
+		columns.featureSetIds = fsids;
+		columns.versions = versions;
+		columns.geometries = geometries;
+		columns.geometryData = &geometryData;
+		columns.styleIds = styleIds;
+
+		std::size_t count;
+		ASSERT_EQ(TE_Ok, cursor.fetch(&count, columns, 3u));
+		ASSERT_EQ(3u, count);
+		for (std::size_t i = 0u; i < count; i++) {
+			ASSERT_EQ(static_cast<int64_t>(i + 1u), ids[i]);
+			ASSERT_EQ(7LL, fsids[i]);
+			ASSERT_EQ(static_cast<int64_t>(i + 1u) * 10LL, versions[i]);
+			ASSERT_EQ(-1LL, styleIds[i]);
+			// geometry is copied out of the cursor
+			ASSERT_EQ(i + 1u, geometries[i].binary.len);
+			for (std::size_t j = 0u; j < geometries[i].binary.len; j++)
+				ASSERT_EQ(static_cast<uint8_t>(i + 1u), geometries[i].binary.value[j]);
+		}
+
+		// remaining rows
+		ASSERT_EQ(TE_Ok, cursor.fetch(&count, columns, 3u));
+		ASSERT_EQ(2u, count);
+		ASSERT_EQ(5LL, ids[1u]);
+		ASSERT_EQ(5u, geometries[1u].binary.len);
+
+		ASSERT_EQ(TE_Done, cursor.fetch(&count, columns, 3u));
+		ASSERT_EQ(0u, count);
+	}
+
+	TEST(FeatureCursor2Tests, testFetchGeometryRequiresData) {
+		MockCursor cursor(1u);
+		FeatureDefinition2::RawData geometries[1u];
+		FeatureColumns columns;
+		columns.geometries = geometries;
+
+		std::size_t count;
+		ASSERT_EQ(TE_InvalidArg, cursor.fetch(&count, columns, 1u));
+	}
+}
@@ -0,0 +1,150 @@
+#include "pch.h"
+
+#include "feature/FeatureCursor2.h"
+#include "feature/FeatureTile.h"
+#include "feature/FeatureTileCache.h"
+#include "feature/GeometryFactory.h"
+#include "feature/LineString.h"
+#include "feature/LineString2.h"
+#include "feature/Point.h"
+#include "feature/Point2.h"
+#include "feature/RuntimeFeatureDataStore2.h"
+#include "raster/osm/OSMUtils.h"
+#include "util/AttributeSet.h"
+#include "util/DataOutput2.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+using namespace atakmap::raster::osm;
+
+namespace takenginetests {
+	namespace {
+		void populate(FeatureDataStore2 &store, int64_t *fsid)
+		{
+			FeatureSetPtr_const fs(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, store.insertFeatureSet(&fs, "test", "test", "tiles", 0.0, 0.0));
+			*fsid = fs->getId();
+
+			atakmap::util::AttributeSet attrs;
+			atakmap::feature::Point p(10.5, 20.25);
+			ASSERT_EQ(TE_Ok, store.insertFeature(nullptr, *fsid, "point", p, TEAM_ClampToGround, 0.0, nullptr, attrs));
+			atakmap::feature::LineString ls(atakmap::feature::Geometry::_2D);
+			ls.addPoint(10.0, 20.0);
+			ls.addPoint(11.0, 21.0);
+			ls.addPoint(12.0, 20.5);
+			ASSERT_EQ(TE_Ok, store.insertFeature(nullptr, *fsid, "line", ls, TEAM_Absolute, 5.0, nullptr, attrs));
+		}
+	}
+
+	TEST(FeatureTileTests, testRoundTrip) {
+		RuntimeFeatureDataStore2 store(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT,
+		                               FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, false);
+		int64_t fsid;
+		populate(store, &fsid);
+
+		FeatureTileKey key;
+		key.level = 4;
+		key.x = OSMUtils::mapnikTileX(key.level, 10.5);
+		key.y = OSMUtils::mapnikTileY(key.level, 20.25);
+		key.fsid = fsid;
+		key.fsVersion = 7;
+
+		FeatureCursorPtr features(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, store.queryFeatures(features));
+		DynamicOutput sink;
+		ASSERT_EQ(TE_Ok, sink.open(1024u));
+		ASSERT_EQ(TE_Ok, FeatureTile_encode(sink, key, 4096u, *features));
+		const uint8_t *buf;
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, sink.get(&buf, &len));
+		FeatureTileData data = std::make_shared<const std::vector<uint8_t>>(buf, buf + len);
+
+		FeatureTileKey decodedKey;
+		ASSERT_EQ(TE_Ok, FeatureTile_getKey(&decodedKey, &data->at(0), data->size()));
+		ASSERT_EQ(key.level, decodedKey.level);
+		ASSERT_EQ(key.x, decodedKey.x);
+		ASSERT_EQ(key.y, decodedKey.y);
+		ASSERT_EQ(key.fsid, decodedKey.fsid);
+		ASSERT_EQ(key.fsVersion, decodedKey.fsVersion);
+
+		Envelope2 bounds;
+		ASSERT_EQ(TE_Ok, FeatureTile_getBounds(&bounds, key.level, key.x, key.y));
+		const double quantum = (bounds.maxX - bounds.minX) / 4096.0;
+
+		FeatureCursorPtr decoded(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, FeatureTile_decode(decoded, data));
+
+		ASSERT_EQ(TE_Ok, decoded->moveToNext());
+		int64_t value;
+		ASSERT_EQ(TE_Ok, decoded->getFeatureSetId(&value));
+		ASSERT_EQ(fsid, value);
+		const char *name;
+		ASSERT_EQ(TE_Ok, decoded->getName(&name));
+		ASSERT_STREQ("point", name);
+		ASSERT_EQ(FeatureDefinition2::GeomBlob, decoded->getGeomCoding());
+		FeatureDefinition2::RawData raw;
+		ASSERT_EQ(TE_Ok, decoded->getRawGeometry(&raw));
+		Geometry2Ptr geom(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, GeometryFactory_fromSpatiaLiteBlob(geom, raw.binary.value, raw.binary.len));
+		ASSERT_EQ(TEGC_Point, geom->getClass());
+		ASSERT_NEAR(10.5, static_cast<const Point2 &>(*geom).x, quantum);
+		ASSERT_NEAR(20.25, static_cast<const Point2 &>(*geom).y, quantum);
+
+		// geometry beyond the tile bounds is retained
+		ASSERT_EQ(TE_Ok, decoded->moveToNext());
+		ASSERT_EQ(TE_Ok, decoded->getName(&name));
+		ASSERT_STREQ("line", name);
+		ASSERT_EQ(TEAM_Absolute, decoded->getAltitudeMode());
+		ASSERT_EQ(5.0, decoded->getExtrude());
+		ASSERT_EQ(TE_Ok, decoded->getRawGeometry(&raw));
+		ASSERT_EQ(TE_Ok, GeometryFactory_fromSpatiaLiteBlob(geom, raw.binary.value, raw.binary.len));
+		ASSERT_EQ(TEGC_LineString, geom->getClass());
+		const auto &ls = static_cast<const LineString2 &>(*geom);
+		ASSERT_EQ(3u, ls.getNumPoints());
+		double x, y;
+		ASSERT_EQ(TE_Ok, ls.getX(&x, 2u));
+		ASSERT_EQ(TE_Ok, ls.getY(&y, 2u));
+		ASSERT_NEAR(12.0, x, quantum);
+		ASSERT_NEAR(20.5, y, quantum);
+
+		ASSERT_EQ(TE_Done, decoded->moveToNext());
+	}
+
+	TEST(FeatureTileTests, testCacheQuery) {
+		RuntimeFeatureDataStore2 store(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT,
+		                               FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, false);
+		int64_t fsid;
+		populate(store, &fsid);
+
+		FeatureTileCache cache(1024u * 1024u);
+		const Envelope2 region(10.4, 20.2, 0.0, 10.6, 20.3, 0.0);
+		const int level = 4;
+
+		FeatureCursorPtr result(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, cache.query(result, store, region, level));
+		std::size_t count = 0u;
+		while (result->moveToNext() == TE_Ok)
+			count++;
+		ASSERT_EQ(2u, count);
+
+		// the tile was generated and cached for the current feature set version
+		FeatureSetPtr_const fs(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, store.getFeatureSet(fs, fsid));
+		FeatureTileKey key;
+		key.level = level;
+		key.x = OSMUtils::mapnikTileX(level, 10.5);
+		key.y = OSMUtils::mapnikTileY(level, 20.25);
+		key.fsid = fsid;
+		key.fsVersion = fs->getVersion();
+		FeatureTileData data;
+		ASSERT_EQ(TE_Ok, cache.get(data, key));
+
+		key.fsVersion++;
+		ASSERT_EQ(TE_Done, cache.get(data, key));
+
+		ASSERT_EQ(TE_Ok, cache.clear());
+		key.fsVersion--;
+		ASSERT_EQ(TE_Done, cache.get(data, key));
+	}
+}
@@ -0,0 +1,87 @@
+#include "pch.h"
+
+#include "math/Frustum2.h"
+
+using namespace TAK::Engine::Math;
+
+namespace takenginetests {
+
+	namespace {
+		// symmetric perspective looking down -Z, near 1, far 100
+		Frustum2 createFrustum() {
+			const double n = 1.0;
+			const double f = 100.0;
+			Matrix2 proj(1.0, 0.0, 0.0, 0.0,
+			             0.0, 1.0, 0.0, 0.0,
+			             0.0, 0.0, -(f + n) / (f - n), -(2.0 * f * n) / (f - n),
+			             0.0, 0.0, -1.0, 0.0);
+			Matrix2 model;
+			return Frustum2(proj, model);
+		}
+	}
+
+	TEST(Frustum2Tests, testBatchBoxesMatchSingle) {
+		Frustum2 frustum = createFrustum();
+		// odd count exercises the scalar tail
+		const double minX[] = { -1.0, 50.0, -0.5, -200.0, 0.0 };
+		const double minY[] = { -1.0, 0.0, -0.5, -200.0, 0.0 };
+		const double minZ[] = { -11.0, -11.0, 5.0, -300.0, -95.0 };
+		const double maxX[] = { 1.0, 52.0, 0.5, 200.0, 150.0 };
+		const double maxY[] = { 1.0, 2.0, 0.5, 200.0, 1.0 };
+		const double maxZ[] = { -9.0, -9.0, 6.0, -1.5, -90.0 };
+		bool result[5u];
+		frustum.intersects(result, minX, minY, minZ, maxX, maxY, maxZ, 5u);
+		for (std::size_t i = 0u; i < 5u; i++) {
+			const AABB aabb(Point2<double>(minX[i], minY[i], minZ[i]), Point2<double>(maxX[i], maxY[i], maxZ[i]));
+			ASSERT_EQ(frustum.intersects(aabb), result[i]);
+		}
+		ASSERT_TRUE(result[0]);
+		ASSERT_FALSE(result[1]);
+		ASSERT_FALSE(result[2]);
+		ASSERT_TRUE(result[3]);
+	}
+
+	TEST(Frustum2Tests, testBatchSpheresMatchSingle) {
+		Frustum2 frustum = createFrustum();
+		const double x[] = { 0.0, 50.0, 0.0 };
+		const double y[] = { 0.0, 0.0, 0.0 };
+		const double z[] = { -10.0, -10.0, 5.0 };
+		const double r[] = { 1.0, 2.0, 6.5 };
+		bool result[3u];
+		frustum.intersects(result, x, y, z, r, 3u);
+		for (std::size_t i = 0u; i < 3u; i++)
+			ASSERT_EQ(frustum.intersects(Sphere2(Point2<double>(x[i], y[i], z[i]), r[i])), result[i]);
+		ASSERT_TRUE(result[0]);
+		ASSERT_FALSE(result[1]);
+		ASSERT_TRUE(result[2]);
+	}
+
+	TEST(Frustum2Tests, testClassifyHierarchical) {
+		Frustum2 frustum = createFrustum();
+		// contained, outside, straddling the right and left planes
+		const double minX[] = { -1.0, 50.0, -20.0 };
+		const double minY[] = { -1.0, 0.0, -1.0 };
+		const double minZ[] = { -11.0, -11.0, -11.0 };
+		const double maxX[] = { 1.0, 52.0, 20.0 };
+		const double maxY[] = { 1.0, 2.0, 1.0 };
+		const double maxZ[] = { -9.0, -9.0, -9.0 };
+		uint8_t planes[3u] = { Frustum2::AllPlanes, Frustum2::AllPlanes, Frustum2::AllPlanes };
+		frustum.classify(planes, minX, minY, minZ, maxX, maxY, maxZ, 3u);
+		ASSERT_EQ(0u, planes[0]);
+		ASSERT_EQ(Frustum2::Outside, planes[1]);
+		ASSERT_EQ(0x3u, planes[2]);
+
+		// children inherit the parent masks; culled and contained parents are not retested
+		frustum.classify(planes, minX, minY, minZ, maxX, maxY, maxZ, 3u);
+		ASSERT_EQ(0u, planes[0]);
+		ASSERT_EQ(Frustum2::Outside, planes[1]);
+		ASSERT_EQ(0x3u, planes[2]);
+
+		// a child of the straddling parent that lies fully inside
+		uint8_t child = planes[2];
+		const double cminX = -1.0, cminY = -1.0, cminZ = -11.0;
+		const double cmaxX = 1.0, cmaxY = 1.0, cmaxZ = -9.0;
+		frustum.classify(&child, &cminX, &cminY, &cminZ, &cmaxX, &cmaxY, &cmaxZ, 1u);
+		ASSERT_EQ(0u, child);
+	}
+}
@@ -0,0 +1,53 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "renderer/core/GLDirtyRegion.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Renderer::Core;
+
+namespace takenginetests {
+
+	TEST(GLDirtyRegionTests, testRegionsInOneHemisphereAreReportedOnce) {
+		GLDirtyRegion dirty;
+		dirty.push_back(Envelope2(-20.0, 10.0, 0.0, -10.0, 20.0, 0.0));
+		dirty.push_back(Envelope2(10.0, 10.0, 0.0, 20.0, 20.0, 0.0));
+
+		std::vector<Envelope2> regions;
+		dirty.getRegions(regions);
+		ASSERT_EQ(2u, regions.size());
+		ASSERT_EQ(-20.0, regions[0].minX);
+		ASSERT_EQ(-10.0, regions[0].maxX);
+		ASSERT_EQ(10.0, regions[1].minX);
+		ASSERT_EQ(20.0, regions[1].maxX);
+	}
+
+	TEST(GLDirtyRegionTests, testRegionSpanningPrimeMeridianIsSplit) {
+		GLDirtyRegion dirty;
+		dirty.push_back(Envelope2(-5.0, 10.0, 0.0, 5.0, 20.0, 0.0));
+
+		std::vector<Envelope2> regions;
+		dirty.getRegions(regions);
+		ASSERT_EQ(2u, regions.size());
+		ASSERT_EQ(-5.0, regions[0].minX);
+		ASSERT_EQ(0.0, regions[0].maxX);
+		ASSERT_EQ(0.0, regions[1].minX);
+		ASSERT_EQ(5.0, regions[1].maxX);
+		ASSERT_TRUE(dirty.intersects(Envelope2(4.0, 15.0, 0.0, 6.0, 16.0, 0.0)));
+		ASSERT_FALSE(dirty.intersects(Envelope2(6.0, 15.0, 0.0, 7.0, 16.0, 0.0)));
+	}
+
+	TEST(GLDirtyRegionTests, testCompactedRegionsAreReported) {
+		GLDirtyRegion dirty;
+		dirty.push_back(Envelope2(10.0, 10.0, 0.0, 20.0, 20.0, 0.0));
+		dirty.push_back(Envelope2(30.0, 30.0, 0.0, 40.0, 40.0, 0.0));
+		dirty.compact();
+
+		std::vector<Envelope2> regions;
+		dirty.getRegions(regions);
+		ASSERT_EQ(1u, regions.size());
+		ASSERT_EQ(10.0, regions[0].minX);
+		ASSERT_EQ(40.0, regions[0].maxX);
+	}
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+
+#include "renderer/GLMegaTexture.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(GLMegaTextureTests, testNumLevelsSingleTile) {
+		ASSERT_EQ(1u, GLMegaTexture_getNumLevels(256, 256, 256u));
+		ASSERT_EQ(1u, GLMegaTexture_getNumLevels(100, 20, 256u));
+	}
+
+	TEST(GLMegaTextureTests, testNumLevelsCoversLargerDimension) {
+		ASSERT_EQ(2u, GLMegaTexture_getNumLevels(257, 10, 256u));
+		ASSERT_EQ(3u, GLMegaTexture_getNumLevels(600, 1024, 256u));
+		ASSERT_EQ(5u, GLMegaTexture_getNumLevels(4096, 4096, 256u));
+	}
+
+	TEST(GLMegaTextureTests, testTileIndexInvertsReaderLevel) {
+		GLMegaTexture::TileIndex idx;
+		// full resolution reader tile is the finest megatexture level
+		ASSERT_EQ(TE_Ok, GLMegaTexture_getTileIndex(&idx, 5u, 0u, 7, 3));
+		ASSERT_EQ(4u, idx.level);
+		ASSERT_EQ(7u, idx.column);
+		ASSERT_EQ(3u, idx.row);
+
+		ASSERT_EQ(TE_Ok, GLMegaTexture_getTileIndex(&idx, 5u, 4u, 0, 0));
+		ASSERT_EQ(0u, idx.level);
+		ASSERT_EQ(0u, idx.column);
+		ASSERT_EQ(0u, idx.row);
+	}
+
+	TEST(GLMegaTextureTests, testTileIndexClampsCoarseReaderLevels) {
+		GLMegaTexture::TileIndex idx;
+		ASSERT_EQ(TE_Ok, GLMegaTexture_getTileIndex(&idx, 3u, 5u, 0, 0));
+		ASSERT_EQ(0u, idx.level);
+		ASSERT_EQ(0u, idx.column);
+		ASSERT_EQ(0u, idx.row);
+	}
+
+	TEST(GLMegaTextureTests, testTileIndexBadArgs) {
+		GLMegaTexture::TileIndex idx;
+		ASSERT_EQ(TE_InvalidArg, GLMegaTexture_getTileIndex(nullptr, 3u, 0u, 0, 0));
+		ASSERT_EQ(TE_InvalidArg, GLMegaTexture_getTileIndex(&idx, 0u, 0u, 0, 0));
+		ASSERT_EQ(TE_InvalidArg, GLMegaTexture_getTileIndex(&idx, 3u, 0u, -1, 0));
+	}
+
+	TEST(GLMegaTextureTests, testTexCoordsFullPage) {
+		// finest level tile (1, 1) of a 2 level megatexture with 256 pixel tiles
+		const GLMegaTexture::TileIndex tile{ 1u, 1u, 1u };
+		float uv[8];
+		ASSERT_EQ(TE_Ok, GLMegaTexture_getTexCoords(uv, tile, 2u, 256u, 256, 256, 256, 256, 1u, 1u));
+		const float expected[8] = { 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+		for (std::size_t i = 0u; i < 8u; i++)
+			ASSERT_FLOAT_EQ(expected[i], uv[i]);
+	}
+
+	TEST(GLMegaTextureTests, testTexCoordsPartialEdgeTile) {
+		// source is 300x300; the edge tile holds 44 pixels of a 256 page
+		const GLMegaTexture::TileIndex tile{ 1u, 1u, 0u };
+		float uv[8];
+		ASSERT_EQ(TE_Ok, GLMegaTexture_getTexCoords(uv, tile, 2u, 256u, 256, 0, 44, 256, 1u, 1u));
+		ASSERT_FLOAT_EQ(0.f, uv[0]);
+		ASSERT_FLOAT_EQ(44.f / 256.f, uv[2]);
+		ASSERT_FLOAT_EQ(1.f, uv[7]);
+	}
+
+	TEST(GLMegaTextureTests, testTexCoordsFromAncestor) {
+		// the lower-right quadrant of the root page covers finest tile (1, 1)
+		const GLMegaTexture::TileIndex root{ 0u, 0u, 0u };
+		float uv[18];
+		ASSERT_EQ(TE_Ok, GLMegaTexture_getTexCoords(uv, root, 2u, 256u, 256, 256, 256, 256, 2u, 2u));
+		ASSERT_FLOAT_EQ(0.5f, uv[0]);
+		ASSERT_FLOAT_EQ(0.5f, uv[1]);
+		// center vertex
+		ASSERT_FLOAT_EQ(0.75f, uv[8]);
+		ASSERT_FLOAT_EQ(0.75f, uv[9]);
+		ASSERT_FLOAT_EQ(1.f, uv[16]);
+		ASSERT_FLOAT_EQ(1.f, uv[17]);
+	}
+
+	TEST(GLMegaTextureTests, testTexCoordsRegionOutsideTile) {
+		const GLMegaTexture::TileIndex tile{ 1u, 0u, 0u };
+		float uv[8];
+		ASSERT_EQ(TE_InvalidArg, GLMegaTexture_getTexCoords(uv, tile, 2u, 256u, 256, 0, 256, 256, 1u, 1u));
+		ASSERT_EQ(TE_InvalidArg, GLMegaTexture_getTexCoords(uv, tile, 2u, 256u, 0, 0, 256, 256, 0u, 1u));
+	}
+}
@@ -0,0 +1,24 @@
+#include "pch.h"
+
+#include "renderer/GLRenderBatch2.h"
+
+using namespace TAK::Engine::Renderer;
+
+namespace takenginetests {
+
+	TEST(GLRenderBatch2Tests, testSmallCapacityUsesShortIndices) {
+		ASSERT_EQ((GLenum)GL_UNSIGNED_SHORT, GLRenderBatch2_getIndexType(0xFFFFu, true));
+		ASSERT_EQ((GLenum)GL_UNSIGNED_SHORT, GLRenderBatch2_getIndexType(0xFFFFu, false));
+		ASSERT_EQ(0xFFFFu, GLRenderBatch2_getMaxVertices(0xFFFFu, GL_UNSIGNED_SHORT));
+	}
+
+	TEST(GLRenderBatch2Tests, testLargeCapacityUsesIntIndicesWhenSupported) {
+		ASSERT_EQ((GLenum)GL_UNSIGNED_INT, GLRenderBatch2_getIndexType(0x20000u, true));
+		ASSERT_EQ(0x20000u, GLRenderBatch2_getMaxVertices(0x20000u, GL_UNSIGNED_INT));
+	}
+
+	TEST(GLRenderBatch2Tests, testLargeCapacityClampsWithoutIntIndexSupport) {
+		ASSERT_EQ((GLenum)GL_UNSIGNED_SHORT, GLRenderBatch2_getIndexType(0x20000u, false));
+		ASSERT_EQ(0xFFFFu, GLRenderBatch2_getMaxVertices(0x20000u, GL_UNSIGNED_SHORT));
+	}
+}
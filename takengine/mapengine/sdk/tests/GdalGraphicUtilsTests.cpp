@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "renderer/GL.h"
+#include "renderer/map/layer/raster/gdal/GdalGraphicUtils.h"
+
+using namespace atakmap::raster::tilereader;
+using namespace atakmap::renderer::map::layer::raster::gdal;
+
+namespace takenginetests {
+	namespace {
+		/**
+		 * Fills a buffer of the specified format and interleave as RGBA and
+		 * verifies each output component against the source band at the
+		 * corresponding index (negative for opaque).
+		 */
+		void assertRGBA(const TileReader::Format format, const TileReader::Interleave interleave, const int bands, const int width, const int height, const int r, const int g, const int b, const int a)
+		{
+			std::vector<uint8_t> src((std::size_t)(width * height * bands));
+			for (std::size_t i = 0u; i < src.size(); i++)
+				src[i] = (uint8_t)((i * 31u) ^ (i >> 7u));
+			std::vector<uint8_t> dst((std::size_t)(width * height * 4));
+			GdalGraphicUtils::fillBuffer(dst.data(), src.data(), width, height, interleave, format, GL_RGBA, GL_UNSIGNED_BYTE);
+
+			const int band[4] = { r, g, b, a };
+			for (int y = 0; y < height; y++) {
+				for (int x = 0; x < width; x++) {
+					for (int c = 0; c < 4; c++) {
+						uint8_t expected = 0xFFu;
+						if (band[c] >= 0) {
+							std::size_t idx;
+							if (interleave == TileReader::BSQ)
+								idx = ((std::size_t)band[c] * width * height) + ((std::size_t)y * width) + x;
+							else if (interleave == TileReader::BIL)
+								idx = (((std::size_t)y * bands + band[c]) * width) + x;
+							else
+								idx = (((std::size_t)y * width + x) * bands) + band[c];
+							expected = src[idx];
+						}
+						ASSERT_EQ(expected, dst[(((std::size_t)y * width + x) * 4u) + c]);
+					}
+				}
+			}
+		}
+
+		void assertAllRGBA(const int width, const int height)
+		{
+			assertRGBA(TileReader::MONOCHROME, TileReader::BSQ, 1, width, height, 0, 0, 0, -1);
+			assertRGBA(TileReader::MONOCHROME_ALPHA, TileReader::BSQ, 2, width, height, 0, 0, 0, 1);
+			assertRGBA(TileReader::MONOCHROME_ALPHA, TileReader::BIL, 2, width, height, 0, 0, 0, 1);
+			assertRGBA(TileReader::RGB, TileReader::BIP, 3, width, height, 0, 1, 2, -1);
+			assertRGBA(TileReader::RGB, TileReader::BSQ, 3, width, height, 0, 1, 2, -1);
+			assertRGBA(TileReader::RGB, TileReader::BIL, 3, width, height, 0, 1, 2, -1);
+			assertRGBA(TileReader::RGBA, TileReader::BSQ, 4, width, height, 0, 1, 2, 3);
+			assertRGBA(TileReader::RGBA, TileReader::BIL, 4, width, height, 0, 1, 2, 3);
+			assertRGBA(TileReader::ARGB, TileReader::BSQ, 4, width, height, 1, 2, 3, 0);
+			assertRGBA(TileReader::ARGB, TileReader::BIL, 4, width, height, 1, 2, 3, 0);
+		}
+	}
+
+	TEST(GdalGraphicUtilsTests, testFillBufferRGBAUnaligned) {
+		// width is not a multiple of the vector width
+		assertAllRGBA(37, 5);
+	}
+
+	TEST(GdalGraphicUtilsTests, testFillBufferRGBARowSplit) {
+		// large enough to be split across threads
+		assertAllRGBA(1500, 1001);
+	}
+}
@@ -88,4 +88,45 @@ namespace takenginetests {
 		ASSERT_TRUE(slantQuick > 0);
 		ASSERT_TRUE(slantSlow > 0);
 	}
+
+	TEST(GeoPoint2Tests, testBatchMatchesPointwise) {
+		const GeoPoint2 origin(35.7303185, -78.8979835, 75.829, AltitudeReference::HAE);
+		const GeoPoint2 pts[4u] =
+		{
+			GeoPoint2(35.7244055, -78.8885789, 576.11, AltitudeReference::HAE),
+			GeoPoint2(-33.9, 151.2, 25.0, AltitudeReference::HAE),
+			GeoPoint2(60.0, 179.5),
+			GeoPoint2(0.0, 0.0),
+		};
+		GeoPoint2 origins[4u];
+		for (std::size_t i = 0u; i < 4u; i++)
+			origins[i] = GeoPoint2(pts[3u-i].latitude, pts[3u-i].longitude, 10.0, AltitudeReference::HAE);
+
+		for (int quick = 0; quick < 2; quick++) {
+			double oneToMany[4u];
+			double pairwise[4u];
+			ASSERT_EQ(TE_Ok, GeoPoint2_distance(oneToMany, origin, pts, 4u, !!quick));
+			ASSERT_EQ(TE_Ok, GeoPoint2_distance(pairwise, origins, pts, 4u, !!quick));
+			for (std::size_t i = 0u; i < 4u; i++) {
+				ASSERT_EQ(GeoPoint2_distance(origin, pts[i], !!quick), oneToMany[i]);
+				ASSERT_EQ(GeoPoint2_distance(origins[i], pts[i], !!quick), pairwise[i]);
+			}
+
+			ASSERT_EQ(TE_Ok, GeoPoint2_bearing(oneToMany, origin, pts, 4u, !!quick));
+			ASSERT_EQ(TE_Ok, GeoPoint2_bearing(pairwise, origins, pts, 4u, !!quick));
+			for (std::size_t i = 0u; i < 4u; i++) {
+				ASSERT_EQ(GeoPoint2_bearing(origin, pts[i], !!quick), oneToMany[i]);
+				ASSERT_EQ(GeoPoint2_bearing(origins[i], pts[i], !!quick), pairwise[i]);
+			}
+		}
+
+		double oneToMany[4u];
+		double pairwise[4u];
+		ASSERT_EQ(TE_Ok, GeoPoint2_slantDistance(oneToMany, origin, pts, 4u));
+		ASSERT_EQ(TE_Ok, GeoPoint2_slantDistance(pairwise, origins, pts, 4u));
+		for (std::size_t i = 0u; i < 4u; i++) {
+			ASSERT_NEAR(GeoPoint2_slantDistance(origin, pts[i]), oneToMany[i], 1e-6);
+			ASSERT_NEAR(GeoPoint2_slantDistance(origins[i], pts[i]), pairwise[i], 1e-6);
+		}
+	}
 }
@@ -12,6 +12,9 @@
 #include "renderer/Tessellate.h"
 #include <util/Memory.h>
 
+#include <cstring>
+#include <vector>
+
 
 using namespace TAK::Engine;
 using namespace TAK::Engine::Core;
@@ -582,4 +585,119 @@ namespace takenginetests {
 
 		assertEllipse(value, expectedLower, expectedUpper, 10., &distanceWGS84);
 	}
+
+	namespace {
+		template<class T>
+		void appendValue(std::vector<uint8_t> &data, const T value, const bool swap)
+		{
+			uint8_t bytes[sizeof(T)];
+			memcpy(bytes, &value, sizeof(T));
+			for (std::size_t i = 0u; i < sizeof(T); i++)
+				data.push_back(bytes[swap ? (sizeof(T) - 1u - i) : i]);
+		}
+	}
+
+	TEST_F(GeometryFactoryTests, lineStringViewXY) {
+		std::vector<uint8_t> data;
+		appendValue<int32_t>(data, 3, false);
+		for (int i = 0; i < 3; i++) {
+			appendValue<double>(data, i * 1.5, false);
+			appendValue<double>(data, i * -2.5, false);
+		}
+
+		LineStringView view;
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, GeometryFactory_getLineStringView(view, &len, data.data(), data.size(), 2, TE_PlatformEndian));
+		ASSERT_EQ(data.size(), len);
+		ASSERT_EQ(3u, view.numPoints);
+		ASSERT_FALSE(view.hasZ);
+
+		double xyz[9];
+		LineStringView_getPoints(xyz, view);
+		for (int i = 0; i < 3; i++) {
+			ASSERT_EQ(i * 1.5, xyz[i*3]);
+			ASSERT_EQ(i * -2.5, xyz[i*3+1]);
+			ASSERT_EQ(0.0, xyz[i*3+2]);
+		}
+
+		// truncated
+		ASSERT_EQ(TE_EOF, GeometryFactory_getLineStringView(view, &len, data.data(), data.size()-1u, 2, TE_PlatformEndian));
+	}
+
+	TEST_F(GeometryFactoryTests, lineStringViewXYZSwapped) {
+		const TAKEndian swapped = (TE_PlatformEndian == TE_LittleEndian) ? TE_BigEndian : TE_LittleEndian;
+		std::vector<uint8_t> data;
+		appendValue<int32_t>(data, 2, true);
+		for (int i = 0; i < 2; i++) {
+			appendValue<double>(data, 10.0 + i, true);
+			appendValue<double>(data, 20.0 + i, true);
+			appendValue<double>(data, 30.0 + i, true);
+		}
+
+		LineStringView view;
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, GeometryFactory_getLineStringView(view, &len, data.data(), data.size(), 1002, swapped));
+		ASSERT_EQ(data.size(), len);
+		ASSERT_TRUE(view.hasZ);
+
+		double xyz[6];
+		LineStringView_getPoints(xyz, view);
+		for (int i = 0; i < 2; i++) {
+			ASSERT_EQ(10.0 + i, xyz[i*3]);
+			ASSERT_EQ(20.0 + i, xyz[i*3+1]);
+			ASSERT_EQ(30.0 + i, xyz[i*3+2]);
+		}
+	}
+
+	TEST_F(GeometryFactoryTests, lineStringViewCompressedXYM) {
+		std::vector<uint8_t> data;
+		appendValue<int32_t>(data, 3, false);
+		appendValue<double>(data, 1.0, false);
+		appendValue<double>(data, 2.0, false);
+		appendValue<double>(data, 99.0, false);
+		for (int i = 1; i < 3; i++) {
+			appendValue<float>(data, 0.5f, false);
+			appendValue<float>(data, -0.25f, false);
+			appendValue<float>(data, 1.0f, false);
+		}
+
+		LineStringView view;
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, GeometryFactory_getLineStringView(view, &len, data.data(), data.size(), 1002002, TE_PlatformEndian));
+		ASSERT_EQ(data.size(), len);
+		ASSERT_TRUE(view.compressed);
+		ASSERT_FALSE(view.hasZ);
+
+		double xyz[9];
+		LineStringView_getPoints(xyz, view);
+		for (int i = 0; i < 3; i++) {
+			ASSERT_EQ(1.0 + i * 0.5, xyz[i*3]);
+			ASSERT_EQ(2.0 - i * 0.25, xyz[i*3+1]);
+			ASSERT_EQ(0.0, xyz[i*3+2]);
+		}
+	}
+
+	TEST_F(GeometryFactoryTests, polygonView) {
+		std::vector<uint8_t> data;
+		appendValue<int32_t>(data, 2, false);
+		for (int r = 0; r < 2; r++) {
+			appendValue<int32_t>(data, 4, false);
+			for (int i = 0; i < 4; i++) {
+				appendValue<double>(data, r + i, false);
+				appendValue<double>(data, r - i, false);
+			}
+		}
+
+		LineStringView rings[2];
+		std::size_t numRings;
+		std::size_t len;
+		ASSERT_EQ(TE_Ok, GeometryFactory_getPolygonView(rings, &numRings, 2u, &len, data.data(), data.size(), 3, TE_PlatformEndian));
+		ASSERT_EQ(2u, numRings);
+		ASSERT_EQ(data.size(), len);
+		double xyz[12];
+		LineStringView_getPoints(xyz, rings[1]);
+		ASSERT_EQ(1.0, xyz[0]);
+		ASSERT_EQ(4.0, xyz[9]);
+		ASSERT_EQ(-2.0, xyz[10]);
+	}
 }
\ No newline at end of file
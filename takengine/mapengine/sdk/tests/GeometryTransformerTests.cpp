@@ -0,0 +1,62 @@
+#include "pch.h"
+
+#include "feature/Envelope2.h"
+#include "feature/GeometryTransformer.h"
+#include "feature/LineString2.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(GeometryTransformerTests, testBulkMatchesGeometry) {
+		LineString2 ls;
+		ls.addPoint(-77.0, 38.9);
+		ls.addPoint(2.35, 48.85);
+		ls.addPoint(139.7, 35.7);
+
+		Geometry2Ptr xformed(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, GeometryTransformer_transform(xformed, ls, 4326, 3857));
+		const auto &xls = static_cast<const LineString2 &>(*xformed);
+		ASSERT_EQ(3u, xls.getNumPoints());
+
+		double coords[6u] = { -77.0, 38.9, 2.35, 48.85, 139.7, 35.7 };
+		ASSERT_EQ(TE_Ok, GeometryTransformer_transform(coords, 3u, 2u, 4326, 3857));
+		for (std::size_t i = 0u; i < 3u; i++) {
+			double x, y;
+			ASSERT_EQ(TE_Ok, xls.getX(&x, i));
+			ASSERT_EQ(TE_Ok, xls.getY(&y, i));
+			ASSERT_EQ(x, coords[i * 2u]);
+			ASSERT_EQ(y, coords[i * 2u + 1u]);
+		}
+
+		// round trip through the reverse transformer
+		ASSERT_EQ(TE_Ok, GeometryTransformer_transform(coords, 3u, 2u, 3857, 4326));
+		ASSERT_NEAR(-77.0, coords[0], 1e-9);
+		ASSERT_NEAR(38.9, coords[1], 1e-9);
+		ASSERT_NEAR(139.7, coords[4], 1e-9);
+		ASSERT_NEAR(35.7, coords[5], 1e-9);
+	}
+
+	TEST(GeometryTransformerTests, testBulkInvalidArgs) {
+		double coords[4u] = { 1.0, 2.0, 3.0, 4.0 };
+		ASSERT_EQ(TE_InvalidArg, GeometryTransformer_transform(coords, 1u, 4u, 4326, 3857));
+		ASSERT_EQ(TE_InvalidArg, GeometryTransformer_transform(nullptr, 1u, 2u, 4326, 3857));
+		// same SRID is a no-op
+		ASSERT_EQ(TE_Ok, GeometryTransformer_transform(coords, 2u, 2u, 4326, 4326));
+		ASSERT_EQ(1.0, coords[0]);
+		ASSERT_EQ(4.0, coords[3]);
+	}
+
+	TEST(GeometryTransformerTests, testEnvelope) {
+		Envelope2 env(-10.0, -5.0, 0.0, 10.0, 5.0, 0.0);
+		Envelope2 xformed;
+		ASSERT_EQ(TE_Ok, GeometryTransformer_transform(&xformed, env, 4326, 3857));
+		double corners[4u] = { -10.0, -5.0, 10.0, 5.0 };
+		ASSERT_EQ(TE_Ok, GeometryTransformer_transform(corners, 2u, 2u, 4326, 3857));
+		ASSERT_EQ(corners[0], xformed.minX);
+		ASSERT_EQ(corners[1], xformed.minY);
+		ASSERT_EQ(corners[2], xformed.maxX);
+		ASSERT_EQ(corners[3], xformed.maxY);
+	}
+}
@@ -0,0 +1,46 @@
+#include "pch.h"
+
+#include "feature/LineString2.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(LineString2Tests, testAddPointsAppends) {
+		LineString2 linestring;
+		linestring.setDimension(2u);
+		const double first[] = { 1.0, 2.0, 3.0, 4.0 };
+		const double second[] = { 5.0, 6.0 };
+		ASSERT_EQ(TE_Ok, linestring.addPoints(first, 2u, 2u));
+		ASSERT_EQ(TE_Ok, linestring.addPoints(second, 1u, 2u));
+		ASSERT_EQ(3u, linestring.getNumPoints());
+
+		double x;
+		ASSERT_EQ(TE_Ok, linestring.getX(&x, 0u));
+		ASSERT_EQ(1.0, x);
+		ASSERT_EQ(TE_Ok, linestring.getX(&x, 2u));
+		ASSERT_EQ(5.0, x);
+	}
+
+	TEST(LineString2Tests, testGetPointsCopiesRange) {
+		LineString2 linestring;
+		linestring.setDimension(3u);
+		const double pts[] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0 };
+		ASSERT_EQ(TE_Ok, linestring.addPoints(pts, 3u, 3u));
+
+		double out[6];
+		ASSERT_EQ(TE_Ok, linestring.getPoints(out, 1u, 2u));
+		for (std::size_t i = 0; i < 6u; i++)
+			ASSERT_EQ(pts[3u + i], out[i]);
+	}
+
+	TEST(LineString2Tests, testGetPointsRejectsBadRange) {
+		LineString2 linestring;
+		linestring.addPoint(1.0, 2.0);
+		double out[4];
+		ASSERT_EQ(TE_BadIndex, linestring.getPoints(out, 0u, 2u));
+		ASSERT_EQ(TE_BadIndex, linestring.getPoints(out, 2u, 0u));
+		ASSERT_EQ(TE_InvalidArg, linestring.getPoints(nullptr, 0u, 1u));
+	}
+}
@@ -0,0 +1,121 @@
+#include "pch.h"
+
+#include "math/Matrix2.h"
+
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		Matrix2 createAffine() {
+			Matrix2 m;
+			m.translate(1000.0, -250.0, 30.0);
+			m.rotate(0.4, 0.2, 1.0, 0.3);
+			m.scale(2.0, 3.0, 0.5);
+			return m;
+		}
+		Matrix2 createPerspective() {
+			const double n = 1.0;
+			const double f = 100.0;
+			Matrix2 m(1.5, 0.0, 0.0, 0.0,
+			          0.0, 2.0, 0.0, 0.0,
+			          0.0, 0.0, -(f + n) / (f - n), -(2.0 * f * n) / (f - n),
+			          0.0, 0.0, -1.0, 0.0);
+			m.concatenate(createAffine());
+			return m;
+		}
+		void assertMatrixNear(const Matrix2 &expected, const Matrix2 &actual, const double epsilon) {
+			double e[16u];
+			double a[16u];
+			expected.get(e);
+			actual.get(a);
+			for (std::size_t i = 0u; i < 16u; i++)
+				ASSERT_NEAR(e[i], a[i], epsilon);
+		}
+	}
+
+	TEST(Matrix2Tests, testBulkTransformMatchesSingle) {
+		const Matrix2 m = createPerspective();
+		double src[5u * 3u];
+		for (std::size_t i = 0u; i < 15u; i++)
+			src[i] = ((double)i * 1.75) - 12.0;
+		double dst[5u * 3u];
+		ASSERT_EQ(TE_Ok, m.transform(dst, src, 5u));
+		for (std::size_t i = 0u; i < 5u; i++) {
+			Point2<double> expected;
+			ASSERT_EQ(TE_Ok, m.transform(&expected, Point2<double>(src[i * 3u], src[i * 3u + 1u], src[i * 3u + 2u])));
+			ASSERT_DOUBLE_EQ(expected.x, dst[i * 3u]);
+			ASSERT_DOUBLE_EQ(expected.y, dst[i * 3u + 1u]);
+			ASSERT_DOUBLE_EQ(expected.z, dst[i * 3u + 2u]);
+		}
+	}
+
+	TEST(Matrix2Tests, testBulkTransformStrided) {
+		const Matrix2 m = createAffine();
+		// xy pairs interleaved with an attribute that must not be touched
+		float src[] = { 1.0f, 2.0f, 99.0f, -3.0f, 4.0f, 99.0f };
+		float dst[] = { 0.0f, 0.0f, 0.0f, 0.0f, 7.0f, 7.0f, 7.0f, 7.0f };
+		ASSERT_EQ(TE_Ok, m.transform(dst, src, 2u, 2u, 4u, 3u));
+		for (std::size_t i = 0u; i < 2u; i++) {
+			Point2<double> expected;
+			ASSERT_EQ(TE_Ok, m.transform(&expected, Point2<double>(src[i * 3u], src[i * 3u + 1u], 0.0)));
+			ASSERT_FLOAT_EQ((float)expected.x, dst[i * 4u]);
+			ASSERT_FLOAT_EQ((float)expected.y, dst[i * 4u + 1u]);
+		}
+		ASSERT_EQ(0.0f, dst[2u]);
+		ASSERT_EQ(7.0f, dst[6u]);
+		ASSERT_EQ(99.0f, src[2u]);
+
+		// transform in place
+		ASSERT_EQ(TE_Ok, m.transform(src, src, 2u, 2u, 3u, 3u));
+		ASSERT_EQ(dst[0u], src[0u]);
+		ASSERT_EQ(dst[5u], src[4u]);
+	}
+
+	TEST(Matrix2Tests, testBulkTransformBadArgs) {
+		const Matrix2 m;
+		double pt[4u] = { 1.0, 2.0, 3.0, 4.0 };
+		ASSERT_EQ(TE_InvalidArg, m.transform(pt, pt, 1u, 4u));
+		ASSERT_EQ(TE_InvalidArg, m.transform((double *)nullptr, pt, 1u));
+
+		// w of zero leaves the point unmodified
+		const Matrix2 degenerate(1.0, 0.0, 0.0, 0.0,
+		                         0.0, 1.0, 0.0, 0.0,
+		                         0.0, 0.0, 1.0, 0.0,
+		                         0.0, 0.0, 0.0, 0.0);
+		ASSERT_EQ(TE_Err, degenerate.transform(pt, pt, 1u));
+		ASSERT_EQ(1.0, pt[0u]);
+	}
+
+	TEST(Matrix2Tests, testMultiplyMatchesConcatenate) {
+		const Matrix2 a = createPerspective();
+		const Matrix2 b = createAffine();
+		Matrix2 expected(a);
+		expected.concatenate(b);
+		Matrix2 actual;
+		a.multiply(&actual, b);
+		ASSERT_TRUE(expected == actual);
+	}
+
+	TEST(Matrix2Tests, testAffineInverse) {
+		const Matrix2 m = createAffine();
+		ASSERT_TRUE(m.isAffine());
+		Matrix2 expected;
+		ASSERT_EQ(TE_Ok, m.createInverse(&expected));
+		Matrix2 actual;
+		ASSERT_EQ(TE_Ok, m.createAffineInverse(&actual));
+		assertMatrixNear(expected, actual, 1e-9);
+
+		// non-affine falls back to the full inverse
+		const Matrix2 p = createPerspective();
+		ASSERT_FALSE(p.isAffine());
+		ASSERT_EQ(TE_Ok, p.createInverse(&expected));
+		ASSERT_EQ(TE_Ok, p.createAffineInverse(&actual));
+		assertMatrixNear(expected, actual, 1e-9);
+
+		Matrix2 singular;
+		singular.setToScale(1.0, 0.0, 1.0);
+		ASSERT_EQ(TE_Err, singular.createAffineInverse(&actual));
+	}
+}
@@ -0,0 +1,70 @@
+#include "pch.h"
+
+#include <thread>
+#include <vector>
+
+#include "util/MemoryAccounting.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(MemoryAccountingTests, testAllocateRelease) {
+		MemoryAccountingSnapshot before;
+		ASSERT_EQ(TE_Ok, MemoryAccounting_getSnapshot(&before));
+
+		MemoryAccounting_allocate(TEMC_Mesh, 1024u);
+		MemoryAccountingSnapshot during;
+		ASSERT_EQ(TE_Ok, MemoryAccounting_getSnapshot(&during));
+		ASSERT_EQ(before.categories[TEMC_Mesh].bytes + 1024, during.categories[TEMC_Mesh].bytes);
+		ASSERT_EQ(before.categories[TEMC_Mesh].allocations + 1u, during.categories[TEMC_Mesh].allocations);
+		ASSERT_TRUE(during.categories[TEMC_Mesh].peakBytes >= during.categories[TEMC_Mesh].bytes);
+
+		MemoryAccounting_release(TEMC_Mesh, 1024u);
+		MemoryAccountingSnapshot after;
+		ASSERT_EQ(TE_Ok, MemoryAccounting_getSnapshot(&after));
+		ASSERT_EQ(before.categories[TEMC_Mesh].bytes, after.categories[TEMC_Mesh].bytes);
+		ASSERT_EQ(before.categories[TEMC_Mesh].releases + 1u, after.categories[TEMC_Mesh].releases);
+	}
+
+	TEST(MemoryAccountingTests, testResetPeaks) {
+		MemoryAccounting_allocate(TEMC_FeatureStore, 4096u);
+		MemoryAccounting_release(TEMC_FeatureStore, 4096u);
+		MemoryAccounting_resetPeaks();
+
+		MemoryAccountingSnapshot snapshot;
+		ASSERT_EQ(TE_Ok, MemoryAccounting_getSnapshot(&snapshot));
+		ASSERT_EQ(snapshot.categories[TEMC_FeatureStore].bytes, snapshot.categories[TEMC_FeatureStore].peakBytes);
+	}
+
+	TEST(MemoryAccountingTests, testConcurrentUpdates) {
+		MemoryAccountingSnapshot before;
+		ASSERT_EQ(TE_Ok, MemoryAccounting_getSnapshot(&before));
+
+		std::vector<std::thread> threads;
+		for (int i = 0; i < 4; i++) {
+			threads.push_back(std::thread([]() {
+				for (int j = 0; j < 1000; j++) {
+					MemoryAccounting_allocate(TEMC_Bitmap, 16u);
+					MemoryAccounting_release(TEMC_Bitmap, 16u);
+				}
+			}));
+		}
+		for (auto &t : threads)
+			t.join();
+
+		MemoryAccountingSnapshot after;
+		ASSERT_EQ(TE_Ok, MemoryAccounting_getSnapshot(&after));
+		ASSERT_EQ(before.categories[TEMC_Bitmap].bytes, after.categories[TEMC_Bitmap].bytes);
+		ASSERT_EQ(before.categories[TEMC_Bitmap].allocations + 4000u, after.categories[TEMC_Bitmap].allocations);
+	}
+
+	TEST(MemoryAccountingTests, testCategoryNames) {
+		ASSERT_STREQ("Texture", MemoryCategory_getName(TEMC_Texture));
+		ASSERT_STREQ("Bitmap", MemoryCategory_getName(TEMC_Bitmap));
+		ASSERT_STREQ("TexturePool", MemoryCategory_getName(TEMC_TexturePool));
+		ASSERT_STREQ("BitmapPool", MemoryCategory_getName(TEMC_BitmapPool));
+		ASSERT_EQ(nullptr, MemoryCategory_getName((MemoryCategory)MemoryAccountingSnapshot::NumCategories));
+		ASSERT_EQ(TE_InvalidArg, MemoryAccounting_getSnapshot(nullptr));
+	}
+}
@@ -0,0 +1,79 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "util/MemoryTrim.h"
+
+using namespace TAK::Engine::Util;
+
+namespace {
+	class TestTrimmable : public MemoryTrimmable {
+	public:
+		~TestTrimmable() NOTHROWS override {}
+		void trim(const MemoryTrimLevel level) NOTHROWS override {
+			levels.push_back(level);
+		}
+	public:
+		std::vector<MemoryTrimLevel> levels;
+	};
+
+	class SelfUnregisteringTrimmable : public TestTrimmable {
+	public:
+		void trim(const MemoryTrimLevel level) NOTHROWS override {
+			TestTrimmable::trim(level);
+			MemoryTrim_unregisterTrimmable(*this);
+		}
+	};
+}
+
+namespace takenginetests {
+
+	TEST(MemoryTrimTests, testTrimDispatchesToRegistered) {
+		TestTrimmable a;
+		TestTrimmable b;
+		ASSERT_EQ(TE_Ok, MemoryTrim_registerTrimmable(a));
+		ASSERT_EQ(TE_Ok, MemoryTrim_registerTrimmable(b));
+		// duplicate registration is a no-op
+		ASSERT_EQ(TE_Ok, MemoryTrim_registerTrimmable(a));
+
+		ASSERT_EQ(TE_Ok, MemoryTrim_trim(TETL_Low));
+		ASSERT_EQ(1u, a.levels.size());
+		ASSERT_EQ(TETL_Low, a.levels[0]);
+		ASSERT_EQ(1u, b.levels.size());
+
+		ASSERT_EQ(TE_Ok, MemoryTrim_unregisterTrimmable(a));
+		ASSERT_EQ(TE_InvalidArg, MemoryTrim_unregisterTrimmable(a));
+		ASSERT_EQ(TE_Ok, MemoryTrim_trim(TETL_Complete));
+		ASSERT_EQ(1u, a.levels.size());
+		ASSERT_EQ(2u, b.levels.size());
+		ASSERT_EQ(TETL_Complete, b.levels[1]);
+
+		ASSERT_EQ(TE_Ok, MemoryTrim_unregisterTrimmable(b));
+	}
+
+	TEST(MemoryTrimTests, testUnregisterDuringTrim) {
+		SelfUnregisteringTrimmable a;
+		TestTrimmable b;
+		ASSERT_EQ(TE_Ok, MemoryTrim_registerTrimmable(a));
+		ASSERT_EQ(TE_Ok, MemoryTrim_registerTrimmable(b));
+
+		ASSERT_EQ(TE_Ok, MemoryTrim_trim(TETL_Moderate));
+		ASSERT_EQ(TE_Ok, MemoryTrim_trim(TETL_Moderate));
+		ASSERT_EQ(1u, a.levels.size());
+		ASSERT_EQ(2u, b.levels.size());
+
+		ASSERT_EQ(TE_Ok, MemoryTrim_unregisterTrimmable(b));
+	}
+
+	TEST(MemoryTrimTests, testInvalidLevel) {
+		ASSERT_EQ(TE_InvalidArg, MemoryTrim_trim((MemoryTrimLevel)(TETL_Complete + 1)));
+	}
+
+	TEST(MemoryTrimTests, testBudgetDecreasesWithLevel) {
+		const std::size_t nominal = 1024u * 1024u;
+		ASSERT_EQ(768u * 1024u, MemoryTrimLevel_getBudget(TETL_Moderate, nominal));
+		ASSERT_EQ(512u * 1024u, MemoryTrimLevel_getBudget(TETL_Low, nominal));
+		ASSERT_EQ(256u * 1024u, MemoryTrimLevel_getBudget(TETL_Critical, nominal));
+		ASSERT_EQ(0u, MemoryTrimLevel_getBudget(TETL_Complete, nominal));
+	}
+}
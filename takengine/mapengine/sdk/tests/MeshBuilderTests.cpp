@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include <memory>
+#include <vector>
 
 #include <model/MeshBuilder.h>
 #include <port/Platform.h>
@@ -58,4 +59,121 @@ namespace takenginetests {
             ASSERT_EQ(expected, actual);
         }
 	}
+
+    namespace {
+        MeshPtr createQuad(const float zOffset) {
+            VertexDataLayout layout;
+            layout.attributes = TEVA_Position;
+            layout.interleaved = true;
+            layout.position.offset = 0u;
+            layout.position.stride = 12u;
+            layout.position.type = TEDT_Float32;
+
+            std::unique_ptr<void, void(*)(const void *)> data(new float[12u], Memory_void_array_deleter_const<float>);
+            for (std::size_t i = 0u; i < 12u; i++)
+                static_cast<float *>(data.get())[i] = (i % 3u == 2u) ? zOffset : (float)(i / 3u);
+            std::unique_ptr<void, void(*)(const void *)> indices(new uint16_t[6u], Memory_void_array_deleter_const<uint16_t>);
+            const uint16_t quad[6u] = { 0u, 1u, 2u, 2u, 1u, 3u };
+            memcpy(indices.get(), quad, sizeof(quad));
+
+            MeshPtr mesh(nullptr, nullptr);
+            MeshBuilder_buildInterleavedMesh(mesh, TEDM_Triangles, TEWO_CounterClockwise, layout, 0, nullptr, Envelope2(0, 0, 0, 3, 3, zOffset), 4u, std::move(data), TEDT_UInt16, 6u, std::move(indices));
+            return mesh;
+        }
+    }
+
+    TEST(MeshBuilderTests, testHashIdenticalGeometry) {
+        MeshPtr a = createQuad(0.0f);
+        MeshPtr b = createQuad(0.0f);
+        MeshPtr c = createQuad(1.0f);
+        ASSERT_TRUE(!!a);
+        ASSERT_TRUE(!!b);
+        ASSERT_TRUE(!!c);
+
+        std::size_t ahash, bhash, chash;
+        ASSERT_EQ((int)TE_Ok, (int)Mesh_hash(&ahash, *a));
+        ASSERT_EQ((int)TE_Ok, (int)Mesh_hash(&bhash, *b));
+        ASSERT_EQ((int)TE_Ok, (int)Mesh_hash(&chash, *c));
+        ASSERT_EQ(ahash, bhash);
+        ASSERT_NE(ahash, chash);
+
+        bool equal = false;
+        ASSERT_EQ((int)TE_Ok, (int)Mesh_equals(&equal, *a, *b));
+        ASSERT_TRUE(equal);
+        ASSERT_EQ((int)TE_Ok, (int)Mesh_equals(&equal, *a, *c));
+        ASSERT_FALSE(equal);
+    }
+
+    TEST(MeshBuilderTests, testAddVerticesBulk) {
+        VertexDataLayout layout;
+        layout.attributes = TEVA_Position | TEVA_TexCoord0;
+        layout.interleaved = true;
+        layout.position.offset = 0u;
+        layout.position.stride = 20u;
+        layout.position.type = TEDT_Float32;
+        layout.texCoord0.offset = 12u;
+        layout.texCoord0.stride = 20u;
+        layout.texCoord0.type = TEDT_Float32;
+
+        MeshBuilder builder(TEDM_Triangles, layout);
+        ASSERT_EQ((int)TE_Ok, (int)builder.reserveVertices(2u));
+
+        // appended in chunks, growing past the reservation
+        const std::size_t numVertices = 3000u;
+        std::vector<float> data(numVertices*5u);
+        for (std::size_t i = 0u; i < data.size(); i++)
+            data[i] = (float)i;
+        ASSERT_EQ((int)TE_Ok, (int)builder.addVertices(data.data(), 2u));
+        ASSERT_EQ((int)TE_Ok, (int)builder.addVertices(data.data() + 10u, numVertices - 3u));
+        // a single vertex following the bulk adds
+        const float *last = data.data() + (numVertices-1u)*5u;
+        ASSERT_EQ((int)TE_Ok, (int)builder.addVertex(last[0], last[1], last[2], last[3], last[4], 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f));
+
+        MeshPtr mesh(nullptr, nullptr);
+        ASSERT_EQ((int)TE_Ok, (int)builder.build(mesh));
+        ASSERT_EQ(numVertices, mesh->getNumVertices());
+        const void *blob;
+        ASSERT_EQ((int)TE_Ok, (int)mesh->getVertices(&blob, TEVA_Position));
+        for (std::size_t i = 0u; i < data.size(); i++)
+            ASSERT_EQ(data[i], static_cast<const float *>(blob)[i]);
+
+        const Envelope2 &aabb = mesh->getAABB();
+        ASSERT_EQ(0.0, aabb.minX);
+        ASSERT_EQ(2.0, aabb.minZ);
+        ASSERT_EQ((double)last[0], aabb.maxX);
+        ASSERT_EQ((double)last[2], aabb.maxZ);
+    }
+
+    TEST(MeshBuilderTests, testSetVerticesAndIndices) {
+        VertexDataLayout layout;
+        layout.attributes = TEVA_Position;
+        layout.interleaved = true;
+        layout.position.offset = 0u;
+        layout.position.stride = 12u;
+        layout.position.type = TEDT_Float32;
+
+        std::unique_ptr<float[]> positions(new float[12u]);
+        for (std::size_t i = 0u; i < 12u; i++)
+            positions[i] = (float)i;
+        const void *adopted = positions.get();
+        std::unique_ptr<uint16_t[]> quad(new uint16_t[6u]{ 0u, 1u, 2u, 2u, 1u, 3u });
+
+        MeshBuilder builder(TEDM_Triangles, layout, TEDT_UInt16);
+        ASSERT_EQ((int)TE_Ok, (int)builder.setVertices(std::unique_ptr<const void, void(*)(const void *)>(positions.release(), Memory_void_array_deleter_const<float>), 4u));
+        ASSERT_EQ((int)TE_Ok, (int)builder.setIndices(std::unique_ptr<const void, void(*)(const void *)>(quad.get(), Memory_leaker_const<void>), 6u));
+        ASSERT_EQ((int)TE_IllegalState, (int)builder.setVertices(std::unique_ptr<const void, void(*)(const void *)>(nullptr, nullptr), 0u));
+
+        MeshPtr mesh(nullptr, nullptr);
+        ASSERT_EQ((int)TE_Ok, (int)builder.build(mesh));
+        ASSERT_EQ(4u, mesh->getNumVertices());
+        ASSERT_EQ(6u, mesh->getNumIndices());
+        const void *blob;
+        ASSERT_EQ((int)TE_Ok, (int)mesh->getVertices(&blob, TEVA_Position));
+        // adopted without copying
+        ASSERT_EQ(adopted, blob);
+        for (std::size_t i = 0u; i < 6u; i++)
+            ASSERT_EQ(quad[i], static_cast<const uint16_t *>(mesh->getIndices())[i]);
+        ASSERT_EQ(9.0, mesh->getAABB().maxX);
+        ASSERT_EQ(11.0, mesh->getAABB().maxZ);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "pch.h"
+
+#include <model/MeshBuilder.h>
+#include <model/MeshSimplifier.h>
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		// non-indexed triangles over a `cells`x`cells` unit grid in the XY plane
+		MeshPtr createGrid(const std::size_t cells)
+		{
+			MeshBuilder builder(TEDM_Triangles, TEVA_Position | TEVA_TexCoord0);
+			builder.setWindingOrder(TEWO_CounterClockwise);
+			auto addVertex = [&](const std::size_t x, const std::size_t y)
+			{
+				builder.addVertex((double)x, (double)y, 0.0, (float)x / cells, (float)y / cells, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+			};
+			for (std::size_t y = 0u; y < cells; y++) {
+				for (std::size_t x = 0u; x < cells; x++) {
+					addVertex(x, y);
+					addVertex(x + 1u, y);
+					addVertex(x + 1u, y + 1u);
+					addVertex(x, y);
+					addVertex(x + 1u, y + 1u);
+					addVertex(x, y + 1u);
+				}
+			}
+			MeshPtr mesh(nullptr, nullptr);
+			builder.build(mesh);
+			return mesh;
+		}
+	}
+
+	TEST(MeshSimplifierTests, testSimplifyPlane) {
+		MeshPtr grid = createGrid(32u);
+		ASSERT_EQ(2048u, grid->getNumFaces());
+
+		MeshPtr simplified(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, MeshSimplifier_simplify(simplified, *grid, 512u));
+		ASSERT_LE(simplified->getNumFaces(), 512u);
+		ASSERT_TRUE(simplified->isIndexed());
+		ASSERT_EQ(TEDM_Triangles, simplified->getDrawMode());
+		ASSERT_EQ(TEWO_CounterClockwise, simplified->getFaceWindingOrder());
+
+		// the outline is locked
+		const Envelope2 &aabb = simplified->getAABB();
+		ASSERT_EQ(0.0, aabb.minX);
+		ASSERT_EQ(0.0, aabb.minY);
+		ASSERT_EQ(32.0, aabb.maxX);
+		ASSERT_EQ(32.0, aabb.maxY);
+	}
+
+	TEST(MeshSimplifierTests, testSimplifyUnsupportedDrawMode) {
+		MeshBuilder builder(TEDM_TriangleStrip, TEVA_Position);
+		builder.addVertex(0.0, 0.0, 0.0, nullptr, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+		builder.addVertex(1.0, 0.0, 0.0, nullptr, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+		builder.addVertex(0.0, 1.0, 0.0, nullptr, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+		MeshPtr strip(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, builder.build(strip));
+
+		MeshPtr simplified(nullptr, nullptr);
+		ASSERT_EQ(TE_Unsupported, MeshSimplifier_simplify(simplified, *strip, 1u));
+	}
+}
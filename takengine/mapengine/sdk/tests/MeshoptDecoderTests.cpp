@@ -0,0 +1,97 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "formats/gltf/MeshoptDecoder.h"
+
+using namespace TAK::Engine::Formats::GLTF;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(MeshoptDecoderTests, testDecodeAttributes) {
+		// two 4-byte vertices, delta encoded from the first vertex in the tail
+		std::vector<uint8_t> encoded;
+		encoded.push_back(0xA0u);
+		// byte 0: raw group, deltas +1, -2
+		encoded.push_back(0x03u);
+		const uint8_t raw[16u] = { 2u, 3u };
+		encoded.insert(encoded.end(), raw, raw + 16u);
+		// byte 1: 2-bit group, deltas -1 and an escaped +2
+		encoded.push_back(0x01u);
+		const uint8_t packed[4u] = { 0x70u, 0x00u, 0x00u, 0x00u };
+		encoded.insert(encoded.end(), packed, packed + 4u);
+		encoded.push_back(0x04u);
+		// bytes 2, 3: zero deltas
+		encoded.push_back(0x00u);
+		encoded.push_back(0x00u);
+		encoded.insert(encoded.end(), 28u, 0x00u);
+		const uint8_t first[4u] = { 10u, 20u, 30u, 40u };
+		encoded.insert(encoded.end(), first, first + 4u);
+
+		uint8_t decoded[8u];
+		ASSERT_EQ(TE_Ok, MeshoptDecoder_decode(decoded, 2u, 4u, &encoded[0], encoded.size(), TEMM_Attributes, TEMF_None));
+		const uint8_t expected[8u] = { 11u, 19u, 30u, 40u, 9u, 21u, 30u, 40u };
+		for (std::size_t i = 0u; i < 8u; i++)
+			ASSERT_EQ(expected[i], decoded[i]);
+
+		// truncated
+		ASSERT_EQ(TE_IllegalState, MeshoptDecoder_decode(decoded, 2u, 4u, &encoded[0], encoded.size() - 1u, TEMM_Attributes, TEMF_None));
+		// unsupported codec version
+		encoded[0] = 0xA2u;
+		ASSERT_EQ(TE_Unsupported, MeshoptDecoder_decode(decoded, 2u, 4u, &encoded[0], encoded.size(), TEMM_Attributes, TEMF_None));
+	}
+
+	TEST(MeshoptDecoderTests, testDecodeTriangles) {
+		// (0, 1, 2) as three new vertices, then (2, 1, 3) sharing the second edge
+		std::vector<uint8_t> encoded;
+		encoded.push_back(0xE1u);
+		encoded.push_back(0xF0u);
+		encoded.push_back(0x10u);
+		encoded.insert(encoded.end(), 16u, 0x00u);
+
+		uint16_t indices[6u];
+		ASSERT_EQ(TE_Ok, MeshoptDecoder_decode(indices, 6u, 2u, &encoded[0], encoded.size(), TEMM_Triangles, TEMF_None));
+		const uint16_t expected[6u] = { 0u, 1u, 2u, 2u, 1u, 3u };
+		for (std::size_t i = 0u; i < 6u; i++)
+			ASSERT_EQ(expected[i], indices[i]);
+
+		ASSERT_EQ(TE_InvalidArg, MeshoptDecoder_decode(indices, 5u, 2u, &encoded[0], encoded.size(), TEMM_Triangles, TEMF_None));
+	}
+
+	TEST(MeshoptDecoderTests, testDecodeIndices) {
+		// 5, 6, 4 as zigzag deltas against the first baseline
+		const uint8_t encoded[8u] = { 0xD1u, 20u, 4u, 6u, 0u, 0u, 0u, 0u };
+		uint32_t indices[3u];
+		ASSERT_EQ(TE_Ok, MeshoptDecoder_decode(indices, 3u, 4u, encoded, sizeof(encoded), TEMM_Indices, TEMF_None));
+		ASSERT_EQ(5u, indices[0]);
+		ASSERT_EQ(6u, indices[1]);
+		ASSERT_EQ(4u, indices[2]);
+	}
+
+	TEST(MeshoptDecoderTests, testFilters) {
+		// a single 4-byte vertex with zero deltas decodes to the tail
+		std::vector<uint8_t> encoded;
+		encoded.push_back(0xA0u);
+		encoded.insert(encoded.end(), 4u, 0x00u);
+		encoded.insert(encoded.end(), 28u, 0x00u);
+
+		// 1.5 as mantissa 3, exponent -1
+		const uint8_t exponential[4u] = { 0x03u, 0x00u, 0x00u, 0xFFu };
+		encoded.insert(encoded.end(), exponential, exponential + 4u);
+		float f;
+		ASSERT_EQ(TE_Ok, MeshoptDecoder_decode(&f, 1u, 4u, &encoded[0], encoded.size(), TEMM_Attributes, TEMF_Exponential));
+		ASSERT_EQ(1.5f, f);
+
+		// +X as an octahedral normal
+		const uint8_t octahedral[4u] = { 127u, 0u, 127u, 0u };
+		memcpy(&encoded[encoded.size() - 4u], octahedral, 4u);
+		int8_t normal[4u];
+		ASSERT_EQ(TE_Ok, MeshoptDecoder_decode(normal, 1u, 4u, &encoded[0], encoded.size(), TEMM_Attributes, TEMF_Octahedral));
+		ASSERT_EQ(127, normal[0]);
+		ASSERT_EQ(0, normal[1]);
+		ASSERT_EQ(0, normal[2]);
+
+		ASSERT_EQ(TE_InvalidArg, MeshoptDecoder_decode(normal, 1u, 4u, &encoded[0], encoded.size(), TEMM_Attributes, TEMF_Quaternion));
+	}
+}
@@ -0,0 +1,145 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "feature/LineString2.h"
+#include "raster/mosaic/MosaicFrameIndex.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Raster::Mosaic;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		class FrameVectorCursor : public MosaicDatabase2::Cursor
+		{
+		public:
+			FrameVectorCursor(const std::vector<MosaicDatabase2::Frame> &frames_) : frames(frames_), pos(0u) {}
+			~FrameVectorCursor() NOTHROWS override {}
+			TAKErr getUpperLeft(GeoPoint2 *value) NOTHROWS override { *value = row().upperLeft; return TE_Ok; }
+			TAKErr getUpperRight(GeoPoint2 *value) NOTHROWS override { *value = row().upperRight; return TE_Ok; }
+			TAKErr getLowerRight(GeoPoint2 *value) NOTHROWS override { *value = row().lowerRight; return TE_Ok; }
+			TAKErr getLowerLeft(GeoPoint2 *value) NOTHROWS override { *value = row().lowerLeft; return TE_Ok; }
+			TAKErr getMinLat(double *value) NOTHROWS override { *value = row().minLat; return TE_Ok; }
+			TAKErr getMinLon(double *value) NOTHROWS override { *value = row().minLon; return TE_Ok; }
+			TAKErr getMaxLat(double *value) NOTHROWS override { *value = row().maxLat; return TE_Ok; }
+			TAKErr getMaxLon(double *value) NOTHROWS override { *value = row().maxLon; return TE_Ok; }
+			TAKErr getPath(const char **value) NOTHROWS override { *value = row().path; return TE_Ok; }
+			TAKErr getType(const char **value) NOTHROWS override { *value = row().type; return TE_Ok; }
+			TAKErr getMinGSD(double *value) NOTHROWS override { *value = row().minGsd; return TE_Ok; }
+			TAKErr getMaxGSD(double *value) NOTHROWS override { *value = row().maxGsd; return TE_Ok; }
+			TAKErr getWidth(int *value) NOTHROWS override { *value = row().width; return TE_Ok; }
+			TAKErr getHeight(int *value) NOTHROWS override { *value = row().height; return TE_Ok; }
+			TAKErr getId(int *value) NOTHROWS override { *value = row().id; return TE_Ok; }
+			TAKErr getSrid(int *value) NOTHROWS override { *value = row().srid; return TE_Ok; }
+			TAKErr isPrecisionImagery(bool *value) NOTHROWS override { *value = row().precisionImagery; return TE_Ok; }
+			TAKErr moveToNext() NOTHROWS override
+			{
+				if (pos >= frames.size())
+					return TE_Done;
+				pos++;
+				return TE_Ok;
+			}
+		private:
+			const MosaicDatabase2::Frame &row() const { return frames[pos - 1u]; }
+		private:
+			const std::vector<MosaicDatabase2::Frame> &frames;
+			std::size_t pos;
+		};
+
+		// 1x1 degree frame with its lower-left corner at the specified location
+		MosaicDatabase2::Frame createFrame(const int id, const double lat, const double lng, const double minGsd, const double maxGsd)
+		{
+			return MosaicDatabase2::Frame(id, "frame", "cib", false,
+				GeoPoint2(lat + 1.0, lng), GeoPoint2(lat + 1.0, lng + 1.0), GeoPoint2(lat, lng + 1.0), GeoPoint2(lat, lng),
+				minGsd, maxGsd, 1024, 1024, 4326);
+		}
+
+		void setRegion(MosaicDatabase2::QueryParameters &params, const double minLat, const double minLng, const double maxLat, const double maxLng)
+		{
+			std::unique_ptr<LineString2> region(new LineString2());
+			region->addPoint(minLng, minLat);
+			region->addPoint(maxLng, maxLat);
+			params.spatialFilter = Geometry2Ptr(region.release(), Memory_deleter_const<Geometry2, LineString2>);
+		}
+
+		void buildIndex(MosaicFrameIndex &index)
+		{
+			std::vector<MosaicDatabase2::Frame> frames;
+			for (int i = 0; i < 10; i++)
+				frames.push_back(createFrame(i, 0.0, (double)i, 100.0, 10.0 * (i + 1)));
+			FrameVectorCursor cursor(frames);
+			ASSERT_EQ(TE_Ok, index.build(cursor));
+		}
+	}
+
+	TEST(MosaicFrameIndexTests, testSpatialAndGsdQuery) {
+		MosaicFrameIndex index;
+		buildIndex(index);
+		ASSERT_EQ(10u, index.size());
+
+		MosaicDatabase2::QueryParameters params;
+		setRegion(params, 0.25, 2.5, 0.75, 5.5);
+		std::vector<const MosaicDatabase2::Frame *> frames;
+		ASSERT_EQ(TE_Ok, index.query(frames, params));
+		// default order is descending maximum GSD
+		ASSERT_EQ(4u, frames.size());
+		ASSERT_EQ(5, frames[0]->id);
+		ASSERT_EQ(2, frames[3]->id);
+
+		frames.clear();
+		params.maxGsd = 40.0;
+		params.maxGsdCompare = MosaicDatabase2::QueryParameters::MaximumGsd;
+		params.order = MosaicDatabase2::QueryParameters::MaxGsdAsc;
+		ASSERT_EQ(TE_Ok, index.query(frames, params));
+		ASSERT_EQ(3u, frames.size());
+		ASSERT_EQ(3, frames[0]->id);
+		ASSERT_EQ(5, frames[2]->id);
+
+		MosaicDatabase2::CursorPtr cursor(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, index.query(cursor, params));
+		int count = 0;
+		while (cursor->moveToNext() == TE_Ok)
+			count++;
+		ASSERT_EQ(3, count);
+	}
+
+	TEST(MosaicFrameIndexTests, testDeltaQuery) {
+		MosaicFrameIndex index;
+		buildIndex(index);
+
+		MosaicFrameIndex::Selection selection;
+		MosaicDatabase2::QueryParameters params;
+		std::vector<const MosaicDatabase2::Frame *> entering;
+		std::vector<const MosaicDatabase2::Frame *> leaving;
+		setRegion(params, 0.25, 2.5, 0.75, 4.5);
+		ASSERT_EQ(TE_Ok, index.queryDelta(entering, leaving, selection, params));
+		ASSERT_EQ(3u, entering.size());
+		ASSERT_EQ(0u, leaving.size());
+
+		// pan east by one frame
+		entering.clear();
+		leaving.clear();
+		setRegion(params, 0.25, 3.5, 0.75, 5.5);
+		ASSERT_EQ(TE_Ok, index.queryDelta(entering, leaving, selection, params));
+		ASSERT_EQ(1u, entering.size());
+		ASSERT_EQ(5, entering[0]->id);
+		ASSERT_EQ(1u, leaving.size());
+		ASSERT_EQ(2, leaving[0]->id);
+
+		// no motion, no change
+		entering.clear();
+		leaving.clear();
+		ASSERT_EQ(TE_Ok, index.queryDelta(entering, leaving, selection, params));
+		ASSERT_TRUE(entering.empty());
+		ASSERT_TRUE(leaving.empty());
+
+		// a rebuild invalidates the selection
+		buildIndex(index);
+		ASSERT_EQ(TE_Ok, index.queryDelta(entering, leaving, selection, params));
+		ASSERT_EQ(3u, entering.size());
+		ASSERT_TRUE(leaving.empty());
+	}
+}
@@ -0,0 +1,102 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "elevation/MultiplexingElevationChunkCursor.h"
+#include "port/STLVectorAdapter.h"
+
+using namespace TAK::Engine::Elevation;
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		class MockCursor : public ElevationChunkCursor
+		{
+		public :
+			MockCursor(std::vector<double> resolutions_) NOTHROWS :
+				resolutions(resolutions_),
+				idx(0u),
+				advanced(0u)
+			{}
+		public :
+			TAKErr moveToNext() NOTHROWS override
+			{
+				advanced++;
+				if (idx >= resolutions.size())
+					return TE_Done;
+				idx++;
+				return TE_Ok;
+			}
+			TAKErr get(ElevationChunkPtr &value) NOTHROWS override { return TE_Unsupported; }
+			TAKErr getResolution(double *value) NOTHROWS override
+			{
+				*value = resolutions[idx - 1u];
+				return TE_Ok;
+			}
+			TAKErr isAuthoritative(bool *value) NOTHROWS override { *value = false; return TE_Ok; }
+			TAKErr getCE(double *value) NOTHROWS override { *value = NAN; return TE_Ok; }
+			TAKErr getLE(double *value) NOTHROWS override { *value = NAN; return TE_Ok; }
+			TAKErr getUri(const char **value) NOTHROWS override { *value = "mock"; return TE_Ok; }
+			TAKErr getType(const char **value) NOTHROWS override { *value = "mock"; return TE_Ok; }
+			TAKErr getBounds(const Polygon2 **value) NOTHROWS override { *value = nullptr; return TE_Ok; }
+			TAKErr getFlags(unsigned int *value) NOTHROWS override { *value = 0u; return TE_Ok; }
+		public :
+			std::vector<double> resolutions;
+			std::size_t idx;
+			std::size_t advanced;
+		};
+	}
+
+	TEST(MultiplexingElevationChunkCursorTests, testMergeOrder) {
+		std::vector<std::shared_ptr<ElevationChunkCursor>> cursors;
+		cursors.push_back(std::shared_ptr<ElevationChunkCursor>(new MockCursor({ 1.0, 4.0, 7.0 })));
+		cursors.push_back(std::shared_ptr<ElevationChunkCursor>(new MockCursor({ 2.0, 5.0 })));
+		cursors.push_back(std::shared_ptr<ElevationChunkCursor>(new MockCursor({})));
+		cursors.push_back(std::shared_ptr<ElevationChunkCursor>(new MockCursor({ 3.0, 6.0, 8.0, 9.0 })));
+		STLVectorAdapter<std::shared_ptr<ElevationChunkCursor>> cursors_a(cursors);
+
+		MultiplexingElevationChunkCursor result(cursors_a);
+		double expected = 1.0;
+		while (result.moveToNext() == TE_Ok) {
+			double res;
+			ASSERT_EQ(TE_Ok, result.getResolution(&res));
+			ASSERT_EQ(expected, res);
+			expected += 1.0;
+		}
+		ASSERT_EQ(10.0, expected);
+	}
+
+	TEST(MultiplexingElevationChunkCursorTests, testOnlyCurrentCursorAdvanced) {
+		std::vector<std::shared_ptr<ElevationChunkCursor>> cursors;
+		std::vector<MockCursor *> mocks;
+		for (std::size_t i = 0u; i < 8u; i++) {
+			std::vector<double> resolutions;
+			for (std::size_t j = 0u; j < 100u; j++)
+				resolutions.push_back((double)(i + j*8u));
+			mocks.push_back(new MockCursor(resolutions));
+			cursors.push_back(std::shared_ptr<ElevationChunkCursor>(mocks.back()));
+		}
+		STLVectorAdapter<std::shared_ptr<ElevationChunkCursor>> cursors_a(cursors);
+
+		MultiplexingElevationChunkCursor result(cursors_a);
+		// each cursor is primed to establish the order
+		for (std::size_t i = 0u; i < mocks.size(); i++)
+			ASSERT_EQ(1u, mocks[i]->advanced);
+
+		ASSERT_EQ(TE_Ok, result.moveToNext());
+		double res;
+		ASSERT_EQ(TE_Ok, result.getResolution(&res));
+		ASSERT_EQ(0.0, res);
+		// the first row does not advance any cursor
+		for (std::size_t i = 0u; i < mocks.size(); i++)
+			ASSERT_EQ(1u, mocks[i]->advanced);
+
+		// the second row only advances the cursor supplying the first
+		ASSERT_EQ(TE_Ok, result.moveToNext());
+		ASSERT_EQ(2u, mocks[0u]->advanced);
+		for (std::size_t i = 1u; i < mocks.size(); i++)
+			ASSERT_EQ(1u, mocks[i]->advanced);
+	}
+}
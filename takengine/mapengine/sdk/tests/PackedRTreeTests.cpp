@@ -0,0 +1,141 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "util/PackedRTree.h"
+
+using namespace TAK::Engine::Util;
+
+namespace {
+	typedef PackedRTree<int>::Bounds Bounds;
+
+	Bounds makeBounds(double x, double y, double w, double h) {
+		Bounds b;
+		b.minX = x;
+		b.minY = y;
+		b.maxX = x + w;
+		b.maxY = y + h;
+		return b;
+	}
+
+	bool intersects(const Bounds &b, double minX, double minY, double maxX, double maxY) {
+		return b.minX <= maxX && b.maxX >= minX && b.minY <= maxY && b.maxY >= minY;
+	}
+
+	std::vector<int> bruteForce(const std::vector<Bounds> &bounds, const std::vector<bool> &present, double minX, double minY, double maxX, double maxY) {
+		std::vector<int> result;
+		for (std::size_t i = 0u; i < bounds.size(); i++) {
+			if (present[i] && intersects(bounds[i], minX, minY, maxX, maxY))
+				result.push_back((int)i);
+		}
+		return result;
+	}
+
+	std::vector<Bounds> randomBounds(std::size_t count) {
+		srand(17);
+		std::vector<Bounds> bounds;
+		for (std::size_t i = 0u; i < count; i++)
+			bounds.push_back(makeBounds((rand() % 3600) / 10.0 - 180.0, (rand() % 1800) / 10.0 - 90.0, (rand() % 50) / 10.0, (rand() % 50) / 10.0));
+		return bounds;
+	}
+}
+
+namespace takenginetests {
+
+	TEST(PackedRTreeTests, testEmptyQuery) {
+		PackedRTree<int> tree;
+		int results[4];
+		ASSERT_EQ(0u, tree.size());
+		ASSERT_EQ(0u, tree.query(-180.0, -90.0, 180.0, 90.0, results, 4u));
+	}
+
+	TEST(PackedRTreeTests, testLoadMatchesBruteForce) {
+		std::vector<Bounds> bounds = randomBounds(5000u);
+		std::vector<int> values;
+		for (std::size_t i = 0u; i < bounds.size(); i++)
+			values.push_back((int)i);
+		std::vector<bool> present(bounds.size(), true);
+
+		PackedRTree<int> tree;
+		ASSERT_EQ(TE_Ok, tree.load(values.data(), bounds.data(), values.size()));
+		ASSERT_EQ(values.size(), tree.size());
+
+		for (int q = 0; q < 50; q++) {
+			const double minX = -180.0 + q * 7.0;
+			const double minY = -90.0 + q * 3.0;
+			std::vector<int> actual;
+			ASSERT_EQ(TE_Ok, tree.query(actual, minX, minY, minX + 20.0, minY + 10.0));
+			std::sort(actual.begin(), actual.end());
+			ASSERT_EQ(bruteForce(bounds, present, minX, minY, minX + 20.0, minY + 10.0), actual);
+		}
+	}
+
+	TEST(PackedRTreeTests, testQueryBufferReportsTotal) {
+		std::vector<Bounds> bounds;
+		std::vector<int> values;
+		for (int i = 0; i < 100; i++) {
+			bounds.push_back(makeBounds(i, 0.0, 0.5, 0.5));
+			values.push_back(i);
+		}
+		PackedRTree<int> tree;
+		ASSERT_EQ(TE_Ok, tree.load(values.data(), bounds.data(), values.size()));
+
+		int results[10];
+		ASSERT_EQ(100u, tree.query(-1.0, -1.0, 101.0, 1.0, results, 10u));
+		for (int i = 0; i < 10; i++)
+			ASSERT_TRUE(results[i] >= 0 && results[i] < 100);
+	}
+
+	TEST(PackedRTreeTests, testIncrementalModification) {
+		std::vector<Bounds> bounds = randomBounds(3000u);
+		std::vector<bool> present(bounds.size(), false);
+
+		PackedRTree<int> tree;
+		for (std::size_t i = 0u; i < bounds.size(); i++) {
+			ASSERT_EQ(TE_Ok, tree.insert((int)i, bounds[i]));
+			present[i] = true;
+		}
+		for (std::size_t i = 0u; i < bounds.size(); i += 3u) {
+			ASSERT_TRUE(tree.remove((int)i));
+			ASSERT_FALSE(tree.remove((int)i));
+			present[i] = false;
+		}
+		// reinsert with new bounds
+		for (std::size_t i = 0u; i < bounds.size(); i += 6u) {
+			bounds[i] = makeBounds(bounds[i].minY, bounds[i].minX / 2.0, 1.0, 1.0);
+			ASSERT_EQ(TE_Ok, tree.insert((int)i, bounds[i]));
+			present[i] = true;
+		}
+
+		std::size_t expected = 0u;
+		for (std::size_t i = 0u; i < present.size(); i++)
+			expected += present[i] ? 1u : 0u;
+		ASSERT_EQ(expected, tree.size());
+
+		for (int pass = 0; pass < 2; pass++) {
+			for (int q = 0; q < 40; q++) {
+				const double minX = -180.0 + q * 9.0;
+				const double minY = -90.0 + q * 4.0;
+				std::vector<int> actual;
+				ASSERT_EQ(TE_Ok, tree.query(actual, minX, minY, minX + 25.0, minY + 15.0));
+				std::sort(actual.begin(), actual.end());
+				ASSERT_EQ(bruteForce(bounds, present, minX, minY, minX + 25.0, minY + 15.0), actual);
+			}
+			ASSERT_EQ(TE_Ok, tree.pack());
+			ASSERT_EQ(expected, tree.size());
+		}
+	}
+
+	TEST(PackedRTreeTests, testClear) {
+		PackedRTree<int> tree;
+		ASSERT_EQ(TE_Ok, tree.insert(1, 0.0, 0.0, 1.0, 1.0));
+		ASSERT_EQ(TE_Ok, tree.pack());
+		ASSERT_EQ(TE_Ok, tree.insert(2, 0.0, 0.0, 1.0, 1.0));
+		tree.clear();
+		int results[2];
+		ASSERT_EQ(0u, tree.size());
+		ASSERT_EQ(0u, tree.query(0.0, 0.0, 1.0, 1.0, results, 2u));
+	}
+}
@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "renderer/GLPerformanceCounters.h"
+#include "util/PerformanceCounters.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(PerformanceCountersTests, testAdd) {
+		std::shared_ptr<PerformanceCounters> counters(std::make_shared<PerformanceCounters>());
+		PerformanceCountersScope scope(counters);
+
+		PerformanceCounters_add(TEPC_TileRequestsIssued, 3u);
+		PerformanceCounters_add(TEPC_TextureUploadBytes, 65536u);
+
+		PerformanceCountersSnapshot snapshot;
+		ASSERT_EQ(TE_Ok, counters->getSnapshot(&snapshot));
+		ASSERT_EQ(3u, snapshot.counters[TEPC_TileRequestsIssued]);
+		ASSERT_EQ(65536u, snapshot.counters[TEPC_TextureUploadBytes]);
+	}
+
+	TEST(PerformanceCountersTests, testDrawTriangles) {
+		std::shared_ptr<PerformanceCounters> counters(std::make_shared<PerformanceCounters>());
+		PerformanceCountersScope scope(counters);
+
+		GLPerformanceCounters_draw(GL_TRIANGLES, 12u);
+		GLPerformanceCounters_draw(GL_TRIANGLE_STRIP, 6u);
+		GLPerformanceCounters_draw(GL_TRIANGLE_FAN, 2u);
+		GLPerformanceCounters_draw(GL_LINES, 8u);
+		GLPerformanceCounters_draw(GL_TRIANGLE_STRIP, 4u, 10u);
+
+		PerformanceCountersSnapshot snapshot;
+		ASSERT_EQ(TE_Ok, counters->getSnapshot(&snapshot));
+		ASSERT_EQ(5u, snapshot.counters[TEPC_DrawCalls]);
+		// 4 + 4 + 0 + 0 + (2 * 10)
+		ASSERT_EQ(28u, snapshot.counters[TEPC_Triangles]);
+	}
+
+	TEST(PerformanceCountersTests, testScopesAreIsolated) {
+		std::shared_ptr<PerformanceCounters> a(std::make_shared<PerformanceCounters>());
+		std::shared_ptr<PerformanceCounters> b(std::make_shared<PerformanceCounters>());
+		{
+			PerformanceCountersScope scopeA(a);
+			PerformanceCounters_add(TEPC_LabelsPlaced, 2u);
+			{
+				PerformanceCountersScope scopeB(b);
+				PerformanceCounters_add(TEPC_LabelsPlaced, 5u);
+			}
+			ASSERT_EQ(a, PerformanceCounters_getCurrent());
+			PerformanceCounters_add(TEPC_LabelsPlaced, 1u);
+		}
+		ASSERT_FALSE(PerformanceCounters_getCurrent());
+		// no counters bound; dropped
+		PerformanceCounters_add(TEPC_LabelsPlaced, 7u);
+
+		PerformanceCountersSnapshot snapshot;
+		ASSERT_EQ(TE_Ok, a->getSnapshot(&snapshot));
+		ASSERT_EQ(3u, snapshot.counters[TEPC_LabelsPlaced]);
+		ASSERT_EQ(TE_Ok, b->getSnapshot(&snapshot));
+		ASSERT_EQ(5u, snapshot.counters[TEPC_LabelsPlaced]);
+	}
+
+	TEST(PerformanceCountersTests, testNames) {
+		ASSERT_STREQ("DrawCalls", PerformanceCounter_getName(TEPC_DrawCalls));
+		ASSERT_STREQ("LabelsPlaced", PerformanceCounter_getName(TEPC_LabelsPlaced));
+		ASSERT_EQ(nullptr, PerformanceCounter_getName((PerformanceCounter)PerformanceCountersSnapshot::NumCounters));
+		PerformanceCounters counters;
+		ASSERT_EQ(TE_InvalidArg, counters.getSnapshot(nullptr));
+	}
+}
@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "feature/PointClusterer.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		std::size_t totalCount(const std::vector<PointClusterer::Cluster> &clusters)
+		{
+			std::size_t count = 0u;
+			for (const auto &c : clusters)
+				count += c.count;
+			return count;
+		}
+	}
+
+	TEST(PointClustererTests, testDensePointsCluster) {
+		PointClusterer clusterer;
+		// 100 points within about 100m
+		for (int i = 0; i < 100; i++)
+			ASSERT_EQ(TE_Ok, clusterer.insert(i, 35.0 + (i % 10) * 0.0001, -78.0 + (i / 10) * 0.0001));
+		// an isolated point
+		ASSERT_EQ(TE_Ok, clusterer.insert(1000, 10.0, 10.0));
+
+		const Envelope2 world(-180.0, -85.0, 0.0, 180.0, 85.0, 0.0);
+		std::vector<PointClusterer::Cluster> clusters;
+		ASSERT_EQ(TE_Ok, clusterer.getClusters(clusters, world, 4));
+		ASSERT_EQ(2u, clusters.size());
+		ASSERT_EQ(101u, totalCount(clusters));
+		auto dense = std::max_element(clusters.begin(), clusters.end(), [](const PointClusterer::Cluster &a, const PointClusterer::Cluster &b) { return a.count < b.count; });
+		ASSERT_EQ(100u, dense->count);
+		ASSERT_NEAR(35.00045, dense->latitude, 1e-6);
+		ASSERT_NEAR(-77.99955, dense->longitude, 1e-6);
+
+		std::vector<int64_t> leaves;
+		ASSERT_EQ(TE_Ok, clusterer.getLeaves(leaves, dense->id, 4));
+		ASSERT_EQ(100u, leaves.size());
+
+		// beyond the maximum zoom, all points are reported
+		clusters.clear();
+		ASSERT_EQ(TE_Ok, clusterer.getClusters(clusters, world, 20));
+		ASSERT_EQ(101u, clusters.size());
+	}
+
+	TEST(PointClustererTests, testIncrementalUpdate) {
+		PointClusterer clusterer;
+		ASSERT_EQ(TE_Ok, clusterer.insert(1, 35.0, -78.0));
+		ASSERT_EQ(TE_Ok, clusterer.insert(2, 35.0001, -78.0001));
+
+		const Envelope2 region(-79.0, 34.0, 0.0, -77.0, 36.0, 0.0);
+		std::vector<PointClusterer::Cluster> clusters;
+		ASSERT_EQ(TE_Ok, clusterer.getClusters(clusters, region, 10));
+		ASSERT_EQ(1u, clusters.size());
+		ASSERT_EQ(2u, clusters[0].count);
+
+		// moving a point out of the region splits the cluster
+		ASSERT_EQ(TE_Ok, clusterer.insert(2, 40.0, -70.0));
+		clusters.clear();
+		ASSERT_EQ(TE_Ok, clusterer.getClusters(clusters, region, 10));
+		ASSERT_EQ(1u, clusters.size());
+		ASSERT_EQ(1u, clusters[0].count);
+		ASSERT_EQ(1, clusters[0].id);
+
+		ASSERT_TRUE(clusterer.remove(1));
+		ASSERT_FALSE(clusterer.remove(1));
+		clusters.clear();
+		ASSERT_EQ(TE_Ok, clusterer.getClusters(clusters, region, 10));
+		ASSERT_TRUE(clusters.empty());
+		ASSERT_EQ(1u, clusterer.size());
+	}
+
+	TEST(PointClustererTests, testRegionCrossingIDL) {
+		PointClusterer clusterer;
+		ASSERT_EQ(TE_Ok, clusterer.insert(1, 0.0, 179.5));
+		ASSERT_EQ(TE_Ok, clusterer.insert(2, 0.0, -179.5));
+		ASSERT_EQ(TE_Ok, clusterer.insert(3, 0.0, 0.0));
+
+		const Envelope2 region(179.0, -1.0, 0.0, -179.0, 1.0, 0.0);
+		std::vector<PointClusterer::Cluster> clusters;
+		ASSERT_EQ(TE_Ok, clusterer.getClusters(clusters, region, 16));
+		ASSERT_EQ(2u, clusters.size());
+	}
+}
@@ -0,0 +1,63 @@
+#include "pch.h"
+
+#include <thread>
+
+#include "db/PooledDatabase.h"
+#include "db/Query.h"
+#include "util/IO2.h"
+
+using namespace TAK::Engine::DB;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		int countRows(Database2 &db)
+		{
+			QueryPtr result(nullptr, nullptr);
+			if (db.compileQuery(result, "SELECT count(*) FROM test") != TE_Ok)
+				return -1;
+			if (result->moveToNext() != TE_Ok)
+				return -1;
+			int32_t count = -1;
+			result->getInt(&count, 0u);
+			return count;
+		}
+	}
+
+	TEST(PooledDatabaseTests, testReadersObserveCommittedState) {
+		TAK::Engine::Port::String path;
+		ASSERT_EQ(TE_Ok, IO_createTempFile(path, "pooleddb", ".sqlite", nullptr));
+		IO_delete(path);
+
+		{
+			DatabasePtr db(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, PooledDatabase_open(db, path, nullptr, 2u));
+			ASSERT_EQ(TE_Ok, db->execute("CREATE TABLE test (value INTEGER)", nullptr, 0u));
+			ASSERT_EQ(TE_Ok, db->execute("INSERT INTO test (value) VALUES (1)", nullptr, 0u));
+			ASSERT_EQ(1, countRows(*db));
+
+			// connection local results are always served by the writer
+			int64_t rowid = 0LL;
+			ASSERT_EQ(TE_Ok, Databases_lastInsertRowID(&rowid, *db));
+			ASSERT_EQ(1LL, rowid);
+
+			ASSERT_EQ(TE_Ok, db->beginTransaction());
+			ASSERT_EQ(TE_Ok, db->execute("INSERT INTO test (value) VALUES (2)", nullptr, 0u));
+			// the transaction's thread observes its own writes
+			ASSERT_EQ(2, countRows(*db));
+
+			// other threads read the committed state without blocking
+			int concurrent = -1;
+			std::thread reader([&]() { concurrent = countRows(*db); });
+			reader.join();
+			ASSERT_EQ(1, concurrent);
+
+			ASSERT_EQ(TE_Ok, db->setTransactionSuccessful());
+			ASSERT_EQ(TE_Ok, db->endTransaction());
+			ASSERT_EQ(2, countRows(*db));
+		}
+
+		IO_delete(path);
+	}
+}
@@ -0,0 +1,126 @@
+#include "pch.h"
+
+#include "core/Projection2.h"
+#include "core/ProjectionFactory3.h"
+
+using namespace TAK::Engine::Core;
+using namespace TAK::Engine::Math;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		struct Vertex
+		{
+			GeoPoint2 lla;
+			Point2<double> xyz;
+			int flags;
+		};
+
+		// exercises the default batch implementations
+		class ScaleProjection : public Projection2
+		{
+		public :
+			int getSpatialReferenceID() const NOTHROWS override { return -1; }
+			TAKErr forward(Point2<double> *proj, const GeoPoint2 &geo) const NOTHROWS override
+			{
+				if (geo.latitude > 90.0)
+					return TE_InvalidArg;
+				*proj = Point2<double>(geo.longitude * 2.0, geo.latitude * 2.0, 0.0);
+				return TE_Ok;
+			}
+			TAKErr inverse(GeoPoint2 *geo, const Point2<double> &proj) const NOTHROWS override
+			{
+				*geo = GeoPoint2(proj.y / 2.0, proj.x / 2.0);
+				return TE_Ok;
+			}
+			double getMinLatitude() const NOTHROWS override { return -90.0; }
+			double getMaxLatitude() const NOTHROWS override { return 90.0; }
+			double getMinLongitude() const NOTHROWS override { return -180.0; }
+			double getMaxLongitude() const NOTHROWS override { return 180.0; }
+			bool is3D() const NOTHROWS override { return false; }
+		};
+	}
+
+	TEST(Projection2Tests, testBatchMatchesPointwise) {
+		const int srids[3u] = { 4326, 3857, 4978 };
+		Vertex vertices[5u];
+		vertices[0].lla = GeoPoint2(0.0, 0.0);
+		vertices[1].lla = GeoPoint2(38.9, -77.0, 100.0, AltitudeReference::HAE);
+		vertices[2].lla = GeoPoint2(-33.9, 151.2, 25.0, AltitudeReference::AGL);
+		vertices[3].lla = GeoPoint2(60.0, 179.5, -10.0, AltitudeReference::HAE);
+		vertices[4].lla = GeoPoint2(-80.0, -179.5);
+
+		for (std::size_t i = 0u; i < 3u; i++) {
+			Projection2Ptr proj(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, ProjectionFactory3_create(proj, srids[i]));
+
+			// interleaved input and output
+			ASSERT_EQ(TE_Ok, Projection2_forward(&vertices[0].xyz, *proj, &vertices[0].lla, 5u, sizeof(Vertex), sizeof(Vertex)));
+			for (std::size_t j = 0u; j < 5u; j++) {
+				Point2<double> expected;
+				ASSERT_EQ(TE_Ok, proj->forward(&expected, vertices[j].lla));
+				ASSERT_EQ(expected.x, vertices[j].xyz.x);
+				ASSERT_EQ(expected.y, vertices[j].xyz.y);
+				ASSERT_EQ(expected.z, vertices[j].xyz.z);
+			}
+
+			// packed output
+			GeoPoint2 lla[5u];
+			ASSERT_EQ(TE_Ok, Projection2_inverse(lla, *proj, &vertices[0].xyz, 5u, 0u, sizeof(Vertex)));
+			for (std::size_t j = 0u; j < 5u; j++) {
+				GeoPoint2 expected;
+				ASSERT_EQ(TE_Ok, proj->inverse(&expected, vertices[j].xyz));
+				ASSERT_EQ(expected.latitude, lla[j].latitude);
+				ASSERT_EQ(expected.longitude, lla[j].longitude);
+				ASSERT_EQ(expected.altitude, lla[j].altitude);
+				ASSERT_NEAR(vertices[j].lla.latitude, lla[j].latitude, 1e-6);
+				ASSERT_NEAR(vertices[j].lla.longitude, lla[j].longitude, 1e-6);
+			}
+		}
+	}
+
+	TEST(Projection2Tests, testVirtualBatchMatchesPointwise) {
+		GeoPoint2 lla[4u];
+		lla[0] = GeoPoint2(0.0, 0.0);
+		lla[1] = GeoPoint2(38.9, -77.0, 100.0, AltitudeReference::HAE);
+		lla[2] = GeoPoint2(-33.9, 151.2, 25.0, AltitudeReference::AGL);
+		lla[3] = GeoPoint2(60.0, 179.5);
+
+		const int srids[3u] = { 4326, 3857, 4978 };
+		for (std::size_t i = 0u; i < 3u; i++) {
+			Projection2Ptr proj(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, ProjectionFactory3_create(proj, srids[i]));
+
+			Point2<double> xyz[4u];
+			ASSERT_EQ(TE_Ok, proj->forward(xyz, lla, 4u));
+			GeoPoint2 inv[4u];
+			ASSERT_EQ(TE_Ok, proj->inverse(inv, xyz, 4u));
+			for (std::size_t j = 0u; j < 4u; j++) {
+				Point2<double> expected;
+				ASSERT_EQ(TE_Ok, proj->forward(&expected, lla[j]));
+				ASSERT_EQ(expected.x, xyz[j].x);
+				ASSERT_EQ(expected.y, xyz[j].y);
+				ASSERT_EQ(expected.z, xyz[j].z);
+				GeoPoint2 expectedInv;
+				ASSERT_EQ(TE_Ok, proj->inverse(&expectedInv, xyz[j]));
+				ASSERT_EQ(expectedInv.latitude, inv[j].latitude);
+				ASSERT_EQ(expectedInv.longitude, inv[j].longitude);
+			}
+		}
+
+		ScaleProjection scale;
+		const Projection2 &proj = scale;
+		Point2<double> xyz[4u];
+		ASSERT_EQ(TE_Ok, proj.forward(xyz, lla, 4u));
+		ASSERT_EQ(-154.0, xyz[1].x);
+		ASSERT_EQ(120.0, xyz[3].y);
+		GeoPoint2 inv[4u];
+		ASSERT_EQ(TE_Ok, proj.inverse(inv, xyz, 4u));
+		ASSERT_EQ(-33.9, inv[2].latitude);
+
+		// errors from the single point implementation are propagated
+		lla[2].latitude = 91.0;
+		ASSERT_EQ(TE_InvalidArg, proj.forward(xyz, lla, 4u));
+	}
+}
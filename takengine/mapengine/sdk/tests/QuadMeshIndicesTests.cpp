@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "renderer/GLTexture2.h"
+#include "renderer/QuadMeshIndices.h"
+
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(QuadMeshIndicesTests, testMatchesQuadMeshIndexBuffer) {
+		const QuadMeshIndices *indices = nullptr;
+		ASSERT_EQ(TE_Ok, QuadMeshIndices_get(&indices, 6u, 4u, false));
+		ASSERT_NE(nullptr, indices);
+		ASSERT_EQ(GLTexture2_getNumQuadMeshIndices(6u, 4u), indices->numIndices);
+		ASSERT_EQ(indices->numIndices, indices->skirtOffset);
+		ASSERT_EQ(nullptr, indices->edgeIndices);
+
+		std::vector<uint16_t> expected(indices->numIndices);
+		GLTexture2_createQuadMeshIndexBuffer(expected.data(), 6u, 4u);
+		for (std::size_t i = 0u; i < expected.size(); i++)
+			ASSERT_EQ(expected[i], indices->indices[i]);
+	}
+
+	TEST(QuadMeshIndicesTests, testSkirt) {
+		const QuadMeshIndices *indices = nullptr;
+		ASSERT_EQ(TE_Ok, QuadMeshIndices_get(&indices, 4u, 4u, true));
+		ASSERT_EQ(GLTexture2_getNumQuadMeshIndices(4u, 4u), indices->skirtOffset);
+		ASSERT_GT(indices->numIndices, indices->skirtOffset);
+		// closed perimeter of a 5x5 post grid
+		ASSERT_EQ(17u, indices->numEdgeIndices);
+		ASSERT_EQ(indices->edgeIndices[0u], indices->edgeIndices[indices->numEdgeIndices-1u]);
+		// grid surface is identical to the skirtless topology
+		const QuadMeshIndices *surface = nullptr;
+		ASSERT_EQ(TE_Ok, QuadMeshIndices_get(&surface, 4u, 4u, false));
+		for (std::size_t i = 0u; i < surface->numIndices; i++)
+			ASSERT_EQ(surface->indices[i], indices->indices[i]);
+	}
+
+	TEST(QuadMeshIndicesTests, testShared) {
+		const QuadMeshIndices *a = nullptr;
+		const QuadMeshIndices *b = nullptr;
+		ASSERT_EQ(TE_Ok, QuadMeshIndices_get(&a, 8u, 8u, true));
+		ASSERT_EQ(TE_Ok, QuadMeshIndices_get(&b, 8u, 8u, true));
+		ASSERT_EQ(a, b);
+		ASSERT_EQ(a->indices, b->indices);
+		ASSERT_EQ(TE_Ok, QuadMeshIndices_get(&b, 8u, 8u, false));
+		ASSERT_NE(a, b);
+	}
+
+	TEST(QuadMeshIndicesTests, testBadArgs) {
+		const QuadMeshIndices *indices = nullptr;
+		ASSERT_EQ(TE_InvalidArg, QuadMeshIndices_get(nullptr, 4u, 4u, false));
+		ASSERT_EQ(TE_InvalidArg, QuadMeshIndices_get(&indices, 0u, 4u, false));
+		// exceeds 16-bit addressable vertices
+		ASSERT_EQ(TE_InvalidArg, QuadMeshIndices_get(&indices, 512u, 512u, false));
+	}
+}
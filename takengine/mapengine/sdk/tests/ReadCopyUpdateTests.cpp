@@ -0,0 +1,69 @@
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "thread/ReadCopyUpdate.h"
+
+using namespace TAK::Engine::Thread;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(ReadCopyUpdateTests, testUpdatePublished) {
+		ReadCopyUpdate<std::vector<int>> rcu;
+		ASSERT_EQ(TE_Ok, rcu.update([](std::vector<int> &v) -> TAKErr { v.push_back(1); return TE_Ok; }));
+
+		ReadCopyUpdate<std::vector<int>>::ReadGuard snapshot(rcu);
+		ASSERT_EQ(1u, snapshot->size());
+		ASSERT_EQ(1, (*snapshot)[0]);
+	}
+
+	TEST(ReadCopyUpdateTests, testFailedUpdateDiscarded) {
+		ReadCopyUpdate<std::vector<int>> rcu;
+		ASSERT_EQ(TE_InvalidArg, rcu.update([](std::vector<int> &v) -> TAKErr { v.push_back(1); return TE_InvalidArg; }));
+
+		ReadCopyUpdate<std::vector<int>>::ReadGuard snapshot(rcu);
+		ASSERT_TRUE(snapshot->empty());
+	}
+
+	TEST(ReadCopyUpdateTests, testSnapshotStableAcrossUpdate) {
+		ReadCopyUpdate<std::vector<int>> rcu;
+		ReadCopyUpdate<std::vector<int>>::ReadGuard snapshot(rcu);
+		ASSERT_EQ(TE_Ok, rcu.update([](std::vector<int> &v) -> TAKErr { v.push_back(1); return TE_Ok; }));
+		ASSERT_TRUE(snapshot->empty());
+
+		ReadCopyUpdate<std::vector<int>>::ReadGuard nested(rcu);
+		ASSERT_EQ(1u, nested->size());
+	}
+
+	TEST(ReadCopyUpdateTests, testConcurrentReaders) {
+		ReadCopyUpdate<std::vector<int>> rcu;
+		std::atomic<bool> done(false);
+		std::atomic<int> errors(0);
+
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; ++i) {
+			readers.push_back(std::thread([&]() {
+				while (!done) {
+					ReadCopyUpdate<std::vector<int>>::ReadGuard snapshot(rcu);
+					// every published value is a contiguous sequence
+					for (std::size_t j = 0u; j < snapshot->size(); j++) {
+						if ((*snapshot)[j] != (int)j)
+							errors++;
+					}
+				}
+			}));
+		}
+		for (int i = 0; i < 1000; ++i)
+			ASSERT_EQ(TE_Ok, rcu.update([](std::vector<int> &v) -> TAKErr { v.push_back((int)v.size()); return TE_Ok; }));
+		done = true;
+		for (auto &t : readers)
+			t.join();
+
+		ASSERT_EQ(0, errors.load());
+		ReadCopyUpdate<std::vector<int>>::ReadGuard snapshot(rcu);
+		ASSERT_EQ(1000u, snapshot->size());
+	}
+}
@@ -0,0 +1,185 @@
+#include "pch.h"
+
+#include <set>
+#include <vector>
+
+#include "feature/FeatureCursor2.h"
+#include "feature/LineString.h"
+#include "feature/Point.h"
+#include "feature/RuntimeFeatureDataStore2.h"
+#include "thread/Thread.h"
+#include "util/AttributeSet.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Feature;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		std::vector<int64_t> queryIds(FeatureDataStore2 &store, const FeatureDataStore2::FeatureQueryParameters &params)
+		{
+			std::vector<int64_t> fids;
+			FeatureCursorPtr result(nullptr, nullptr);
+			if (store.queryFeatures(result, params) != TE_Ok)
+				return fids;
+			while (result->moveToNext() == TE_Ok) {
+				int64_t fid;
+				result->getId(&fid);
+				fids.push_back(fid);
+			}
+			return fids;
+		}
+
+		void populate(FeatureDataStore2 &store, int64_t *fsid)
+		{
+			FeatureSetPtr_const fs(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, store.insertFeatureSet(&fs, "test", "test", "tracks", 0.0, 0.0));
+			*fsid = fs->getId();
+
+			atakmap::util::AttributeSet attrs;
+			for (int i = 0; i < 100; i++) {
+				atakmap::feature::Point p(static_cast<double>(i), static_cast<double>(i % 10));
+				ASSERT_EQ(TE_Ok, store.insertFeature(nullptr, *fsid, "track", p, TEAM_ClampToGround, 0.0, nullptr, attrs));
+			}
+		}
+
+		struct ChangeRecorder : FeatureDataStore2::OnDataStoreContentChangedListener
+		{
+			void onDataStoreContentChanged(FeatureDataStore2 &) NOTHROWS override
+			{}
+			void onDataStoreContentChanged(FeatureDataStore2 &, const FeatureDataStore2::ContentChange &change) NOTHROWS override
+			{
+				changes.push_back(change);
+			}
+			std::vector<FeatureDataStore2::ContentChange> changes;
+		};
+
+		void setRegion(FeatureDataStore2::FeatureQueryParameters &params, const double minX, const double minY, const double maxX, const double maxY)
+		{
+			auto *region = new atakmap::feature::LineString(atakmap::feature::Geometry::_2D);
+			region->addPoint(minX, minY);
+			region->addPoint(maxX, maxY);
+			params.spatialFilter = GeometryPtr_const(region, Memory_deleter_const<atakmap::feature::Geometry>);
+		}
+	}
+
+	TEST(RuntimeFeatureDataStore2Tests, testSnapshotMatchesLive) {
+		RuntimeFeatureDataStore2 live(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT | FeatureDataStore2::MODIFY_FEATURE_GEOMETRY,
+		                              FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, false);
+		RuntimeFeatureDataStore2 snapshot(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT | FeatureDataStore2::MODIFY_FEATURE_GEOMETRY,
+		                                  FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, true);
+		int64_t fsid;
+		populate(live, &fsid);
+		populate(snapshot, &fsid);
+
+		ASSERT_EQ(TE_Ok, live.setFeatureVisible(5, false));
+		ASSERT_EQ(TE_Ok, snapshot.setFeatureVisible(5, false));
+
+		FeatureDataStore2::FeatureQueryParameters all;
+		ASSERT_EQ(100u, queryIds(snapshot, all).size());
+		ASSERT_EQ(queryIds(live, all), queryIds(snapshot, all));
+
+		FeatureDataStore2::FeatureQueryParameters visible;
+		visible.visibleOnly = true;
+		ASSERT_EQ(99u, queryIds(snapshot, visible).size());
+		ASSERT_EQ(queryIds(live, visible), queryIds(snapshot, visible));
+
+		FeatureDataStore2::FeatureQueryParameters ids;
+		ids.featureIds->add(42);
+		ids.featureIds->add(7);
+		ids.featureIds->add(1000);
+		ASSERT_EQ(queryIds(live, ids), queryIds(snapshot, ids));
+		ASSERT_EQ(2u, queryIds(snapshot, ids).size());
+
+		FeatureDataStore2::FeatureQueryParameters region;
+		setRegion(region, 10.0, 0.0, 29.5, 4.5);
+		ASSERT_EQ(queryIds(live, region), queryIds(snapshot, region));
+		ASSERT_EQ(10u, queryIds(snapshot, region).size());
+	}
+
+	TEST(RuntimeFeatureDataStore2Tests, testSnapshotReflectsModifications) {
+		RuntimeFeatureDataStore2 store(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_UPDATE | FeatureDataStore2::MODIFY_FEATURE_GEOMETRY,
+		                               FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, true);
+		int64_t fsid;
+		populate(store, &fsid);
+
+		FeatureDataStore2::FeatureQueryParameters region;
+		setRegion(region, 500.0, 500.0, 501.0, 501.0);
+		ASSERT_TRUE(queryIds(store, region).empty());
+
+		// cursors opened prior to the update observe the prior version
+		FeatureDataStore2::FeatureQueryParameters ids;
+		ids.featureIds->add(3);
+		FeatureCursorPtr before(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, store.queryFeatures(before, ids));
+
+		atakmap::feature::Point moved(500.5, 500.5);
+		ASSERT_EQ(TE_Ok, store.updateFeature(3, moved));
+
+		const std::vector<int64_t> fids = queryIds(store, region);
+		ASSERT_EQ(1u, fids.size());
+		ASSERT_EQ(3, fids[0]);
+
+		ASSERT_EQ(TE_Ok, before->moveToNext());
+		int64_t version;
+		ASSERT_EQ(TE_Ok, before->getVersion(&version));
+		ASSERT_EQ(1, version);
+		const Feature2 *feature;
+		ASSERT_EQ(TE_Ok, before->get(&feature));
+		// fids are assigned from 1
+		ASSERT_EQ(2.0, feature->getGeometry()->getEnvelope().minX);
+	}
+
+	TEST(RuntimeFeatureDataStore2Tests, testContentChangeExtent) {
+		RuntimeFeatureDataStore2 store(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_UPDATE | FeatureDataStore2::MODIFY_FEATURE_GEOMETRY,
+		                               FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, false);
+		int64_t fsid;
+		populate(store, &fsid);
+
+		ChangeRecorder listener;
+		ASSERT_EQ(TE_Ok, store.addOnDataStoreContentChangedListener(&listener));
+
+		// the change covers both the prior and the new location
+		atakmap::feature::Point moved(50.5, 40.5);
+		ASSERT_EQ(TE_Ok, store.updateFeature(3, moved));
+		ASSERT_EQ(1u, listener.changes.size());
+		const FeatureDataStore2::ContentChange &change = listener.changes[0];
+		ASSERT_FALSE(change.unbounded);
+		ASSERT_TRUE(change.hasBounds);
+		ASSERT_TRUE(change.fidsComplete);
+		ASSERT_EQ(1u, change.fids.count(3));
+		ASSERT_EQ(1u, change.fsids.count(fsid));
+		ASSERT_EQ(2.0, change.bounds.minX);
+		ASSERT_EQ(2.0, change.bounds.minY);
+		ASSERT_EQ(50.5, change.bounds.maxX);
+		ASSERT_EQ(40.5, change.bounds.maxY);
+
+		ASSERT_EQ(TE_Ok, store.removeOnDataStoreContentChangedListener(&listener));
+	}
+
+	TEST(RuntimeFeatureDataStore2Tests, testContentChangeCoalescing) {
+		RuntimeFeatureDataStore2 store(FeatureDataStore2::MODIFY_FEATURESET_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_INSERT | FeatureDataStore2::MODIFY_FEATURESET_FEATURE_UPDATE | FeatureDataStore2::MODIFY_FEATURE_GEOMETRY,
+		                               FeatureDataStore2::VISIBILITY_SETTINGS_FEATURE, false);
+		int64_t fsid;
+		populate(store, &fsid);
+
+		ChangeRecorder listener;
+		ASSERT_EQ(TE_Ok, store.addOnDataStoreContentChangedListener(&listener));
+		ASSERT_EQ(TE_Ok, store.setContentChangedCoalescingWindow(500LL));
+
+		for (int i = 1; i <= 20; i++) {
+			atakmap::feature::Point moved(static_cast<double>(i), 60.0);
+			ASSERT_EQ(TE_Ok, store.updateFeature(i, moved));
+		}
+		TAK::Engine::Thread::Thread_sleep(1500LL);
+
+		// the first change is delivered immediately, the remainder together
+		ASSERT_EQ(TE_Ok, store.removeOnDataStoreContentChangedListener(&listener));
+		ASSERT_LE(listener.changes.size(), 2u);
+		std::set<int64_t> fids;
+		for (const auto &change : listener.changes)
+			fids.insert(change.fids.begin(), change.fids.end());
+		ASSERT_EQ(20u, fids.size());
+		ASSERT_EQ(60.0, listener.changes.back().bounds.maxY);
+	}
+}
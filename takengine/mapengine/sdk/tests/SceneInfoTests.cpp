@@ -42,4 +42,39 @@ namespace takenginetests {
 
 		ASSERT_FALSE(supported);
 	}
-}
\ No newline at end of file
+
+	namespace {
+		int lazyInstances = 0;
+
+		std::shared_ptr<SceneInfoSpi> createLazyTestSpi()
+		{
+			lazyInstances++;
+			return std::make_shared<TestSceneInfoSpi>();
+		}
+	}
+
+	TEST(SceneInfoTests, testLazySpiInstantiatedOnMatch) {
+		lazyInstances = 0;
+		const char *extensions[1u] = { ".LazyTest" };
+		TAK::Engine::Util::LazySpiDescriptor descriptor;
+		descriptor.name = "LazyTest";
+		descriptor.priority = 1;
+		descriptor.extensions = extensions;
+		descriptor.numExtensions = 1u;
+
+		std::shared_ptr<SceneInfoSpi> spi;
+		ASSERT_EQ(TAK::Engine::Util::TE_Ok, SceneInfoFactory_registerSpi(descriptor, createLazyTestSpi, &spi));
+		ASSERT_STREQ("LazyTest", spi->getName());
+
+		// no match on extension, the SPI is not instantiated
+		ASSERT_FALSE(SceneInfoFactory_isSupported("scene.obj", nullptr));
+		ASSERT_EQ(0, lazyInstances);
+
+		ASSERT_TRUE(SceneInfoFactory_isSupported("scene.lazytest", nullptr));
+		ASSERT_TRUE(SceneInfoFactory_isSupported("other.LAZYTEST", "LazyTest"));
+		ASSERT_EQ(1, lazyInstances);
+
+		SceneInfoFactory_unregisterSpi(spi);
+		ASSERT_FALSE(SceneInfoFactory_isSupported("scene.lazytest", nullptr));
+	}
+}
@@ -0,0 +1,109 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <string>
+
+#include "model/MeshBuilder.h"
+#include "model/Scene.h"
+#include "model/SceneBuilder.h"
+
+using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		std::string writeSourceFile(const char *content) {
+			std::string path = ::testing::TempDir() + "SceneTests.obj";
+			FILE *f = fopen(path.c_str(), "wb");
+			fputs(content, f);
+			fclose(f);
+			return path;
+		}
+		ScenePtr buildIndexedScene() {
+			MeshBuilder builder(TEDM_Triangles, TEVA_Position | TEVA_TexCoord0, TEDT_UInt16);
+			for (int i = 0; i < 4; i++)
+				builder.addVertex((double)(i % 2), (double)(i / 2), 0.0, (float)(i % 2), (float)(i / 2), 0.f, 0.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+			const std::size_t indices[6u] = { 0u, 1u, 3u, 0u, 3u, 2u };
+			for (std::size_t i = 0u; i < 6u; i++)
+				builder.addIndex(indices[i]);
+			MeshPtr mesh(nullptr, nullptr);
+			builder.build(mesh);
+
+			SceneBuilder sceneBuilder(true);
+			sceneBuilder.addMesh(std::move(mesh), nullptr);
+			ScenePtr scene(nullptr, nullptr);
+			sceneBuilder.build(scene);
+			return scene;
+		}
+		const Mesh *findMesh(std::shared_ptr<const Mesh> &mesh, SceneNode &node) {
+			if (node.hasMesh() && node.loadMesh(mesh, 0u, nullptr) == TE_Ok)
+				return mesh.get();
+			if (!node.hasChildren())
+				return nullptr;
+			Collection<std::shared_ptr<SceneNode>>::IteratorPtr iter(nullptr, nullptr);
+			if (node.getChildren(iter) != TE_Ok)
+				return nullptr;
+			do {
+				std::shared_ptr<SceneNode> child;
+				if (iter->get(child) != TE_Ok)
+					break;
+				if (findMesh(mesh, *child))
+					return mesh.get();
+			} while (iter->next() == TE_Ok);
+			return nullptr;
+		}
+	}
+
+	TEST(SceneTests, testDecodeCachedRoundTrip) {
+		const std::string source = writeSourceFile("v 0 0 0\n");
+		const std::string cache = ::testing::TempDir() + "SceneTests.tbsg";
+
+		ScenePtr scene = buildIndexedScene();
+		ASSERT_TRUE(!!scene);
+		ASSERT_EQ(TE_Ok, SceneFactory_encode(cache.c_str(), *scene, source.c_str()));
+
+		ScenePtr decoded(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, SceneFactory_decodeCached(decoded, cache.c_str(), source.c_str()));
+		std::shared_ptr<const Mesh> mesh;
+		ASSERT_NE(nullptr, findMesh(mesh, decoded->getRootNode()));
+		ASSERT_EQ(4u, mesh->getNumVertices());
+		ASSERT_EQ(6u, mesh->getNumIndices());
+		DataType indexType;
+		ASSERT_EQ(TE_Ok, mesh->getIndexType(&indexType));
+		ASSERT_EQ(TEDT_UInt16, indexType);
+		const uint16_t *indices = reinterpret_cast<const uint16_t *>(static_cast<const uint8_t *>(mesh->getIndices()) + mesh->getIndexOffset());
+		ASSERT_EQ(3u, indices[2]);
+		ASSERT_EQ(2u, indices[5]);
+		TAK::Engine::Math::Point2<double> pos;
+		ASSERT_EQ(TE_Ok, mesh->getPosition(&pos, 3u));
+		ASSERT_EQ(1.0, pos.x);
+		ASSERT_EQ(1.0, pos.y);
+
+		// the cache is also readable without validation
+		ScenePtr streamed(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, SceneFactory_decode(streamed, cache.c_str(), true));
+	}
+
+	TEST(SceneTests, testDecodeCachedStale) {
+		const std::string source = writeSourceFile("v 0 0 0\n");
+		const std::string cache = ::testing::TempDir() + "SceneTests.tbsg";
+
+		ScenePtr scene = buildIndexedScene();
+		ASSERT_TRUE(!!scene);
+		ASSERT_EQ(TE_Ok, SceneFactory_encode(cache.c_str(), *scene, source.c_str()));
+
+		// keyed on the source URI
+		ScenePtr decoded(nullptr, nullptr);
+		ASSERT_EQ(TE_Done, SceneFactory_decodeCached(decoded, cache.c_str(), cache.c_str()));
+
+		// keyed on the source content
+		writeSourceFile("v 0 0 0\nv 1 1 1\n");
+		ASSERT_EQ(TE_Done, SceneFactory_decodeCached(decoded, cache.c_str(), source.c_str()));
+
+		// not encoded from a source
+		ASSERT_EQ(TE_Ok, SceneFactory_encode(cache.c_str(), *scene));
+		ASSERT_EQ(TE_Done, SceneFactory_decodeCached(decoded, cache.c_str(), source.c_str()));
+	}
+}
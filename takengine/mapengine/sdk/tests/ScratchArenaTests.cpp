@@ -0,0 +1,67 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "util/ScratchArena.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(ScratchArenaTests, testAllocationsAreAligned) {
+		ScratchArena arena(256u);
+		ScratchArenaScope scope(arena);
+		for (std::size_t i = 0; i < 64; ++i) {
+			void *mem = arena.allocate(1u + (i % 7u), 16u);
+			ASSERT_NE(nullptr, mem);
+			ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(mem) % 16u);
+		}
+	}
+
+	TEST(ScratchArenaTests, testScopeReusesMemory) {
+		ScratchArena arena(1024u);
+		void *first;
+		{
+			ScratchArenaScope scope(arena);
+			first = arena.allocate(128u);
+			ASSERT_NE(nullptr, first);
+		}
+		{
+			ScratchArenaScope scope(arena);
+			ASSERT_EQ(first, arena.allocate(128u));
+		}
+	}
+
+	TEST(ScratchArenaTests, testNestedScopeRestoresMark) {
+		ScratchArena arena(1024u);
+		ScratchArenaScope outer(arena);
+		void *a = arena.allocate(64u);
+		void *inner;
+		{
+			ScratchArenaScope scope(arena);
+			inner = arena.allocate(64u);
+			ASSERT_NE(a, inner);
+		}
+		ASSERT_EQ(inner, arena.allocate(64u));
+	}
+
+	TEST(ScratchArenaTests, testOversizedAllocationTrimmed) {
+		ScratchArena arena(1024u, 4096u);
+		{
+			ScratchArenaScope scope(arena);
+			ASSERT_NE(nullptr, arena.allocate(512u));
+			ASSERT_NE(nullptr, arena.allocate(64u * 1024u));
+			ASSERT_GT(arena.capacity(), 4096u);
+		}
+		ASSERT_LE(arena.capacity(), 4096u);
+	}
+
+	TEST(ScratchArenaTests, testAllocatorBacksVector) {
+		ScratchArenaScope scope;
+		std::vector<int, ScratchAllocator<int>> v{ScratchAllocator<int>(scope.arena)};
+		for (int i = 0; i < 10000; ++i)
+			v.push_back(i);
+		for (int i = 0; i < 10000; ++i)
+			ASSERT_EQ(i, v[i]);
+	}
+}
@@ -0,0 +1,73 @@
+#include "pch.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "util/SlabAllocator.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		struct SlabObject
+		{
+			TE_SLAB_ALLOCATED()
+		public :
+			double values[5];
+		};
+	}
+
+	TEST(SlabAllocatorTests, testAllocationsAligned) {
+		for (std::size_t size = 1u; size <= 2048u; size += 7u) {
+			void *mem = SlabAllocator_allocate(size);
+			ASSERT_NE(nullptr, mem);
+			ASSERT_EQ(0u, ((uintptr_t)mem) % alignof(std::max_align_t));
+			memset(mem, 0xA5, size);
+			SlabAllocator_deallocate(mem);
+		}
+	}
+
+	TEST(SlabAllocatorTests, testBlockRecycledOnThread) {
+		void *first = SlabAllocator_allocate(40u);
+		ASSERT_NE(nullptr, first);
+		SlabAllocator_deallocate(first);
+
+		void *second = SlabAllocator_allocate(48u);
+		ASSERT_EQ(first, second);
+		SlabAllocator_deallocate(second);
+	}
+
+	TEST(SlabAllocatorTests, testLargeAllocationsCounted) {
+		SlabAllocatorStatistics before;
+		ASSERT_EQ(TE_Ok, SlabAllocator_getStatistics(&before));
+
+		void *mem = SlabAllocator_allocate(64u * 1024u);
+		ASSERT_NE(nullptr, mem);
+		SlabAllocator_deallocate(mem);
+
+		SlabAllocatorStatistics after;
+		ASSERT_EQ(TE_Ok, SlabAllocator_getStatistics(&after));
+		ASSERT_EQ(before.largeAllocations + 1u, after.largeAllocations);
+		ASSERT_EQ(before.largeDeallocations + 1u, after.largeDeallocations);
+	}
+
+	TEST(SlabAllocatorTests, testCrossThreadDeallocate) {
+		std::vector<SlabObject *> objs;
+		for (std::size_t i = 0u; i < 1000u; i++)
+			objs.push_back(new SlabObject());
+
+		std::thread t([&objs]() {
+			for (auto it = objs.begin(); it != objs.end(); it++)
+				delete *it;
+		});
+		t.join();
+
+		// blocks returned by the exited thread are available to the pool
+		for (std::size_t i = 0u; i < 1000u; i++)
+			objs[i] = new SlabObject();
+		for (auto it = objs.begin(); it != objs.end(); it++)
+			delete *it;
+	}
+}
@@ -514,4 +514,58 @@ namespace takenginetests {
 			ASSERT_TRUE(llIsects);
 		}
 	}
+	TEST(SpatialCalcualtor2Tests, testGEOSStorageBatchIntersects) {
+		TAKErr code(TE_Ok);
+		SpatialCalculator2 calc(SpatialCalculator2::GEOSStorage);
+
+		int64_t hfence(0LL);
+		code = calc.createPolygon(&hfence, Point2(0, 0), Point2(10, 0), Point2(10, 10), Point2(0, 10));
+		ASSERT_TRUE(TE_Ok == code);
+
+		int64_t hpoints[3];
+		const char *wkts[3] = { "POINT(5 5)", "POINT(15 5)", "POINT(0 10)" };
+		for (std::size_t i = 0u; i < 3u; i++) {
+			code = calc.createGeometryFromWkt(hpoints + i, wkts[i]);
+			ASSERT_TRUE(TE_Ok == code);
+		}
+
+		bool isects[3];
+		code = calc.intersects(isects, hfence, hpoints, 3u);
+		ASSERT_TRUE(TE_Ok == code);
+		ASSERT_TRUE(isects[0]);
+		ASSERT_FALSE(isects[1]);
+		ASSERT_TRUE(isects[2]);
+
+		bool contained[3];
+		code = calc.contains(contained, hfence, hpoints, 3u);
+		ASSERT_TRUE(TE_Ok == code);
+		ASSERT_TRUE(contained[0]);
+		ASSERT_FALSE(contained[1]);
+		ASSERT_FALSE(contained[2]);
+	}
+
+	TEST(SpatialCalcualtor2Tests, testGEOSStorageBatchRollback) {
+		TAKErr code(TE_Ok);
+		SpatialCalculator2 calc(SpatialCalculator2::GEOSStorage);
+
+		int64_t hfence(0LL);
+		code = calc.createPolygon(&hfence, Point2(0, 0), Point2(10, 0), Point2(10, 10), Point2(0, 10));
+		ASSERT_TRUE(TE_Ok == code);
+		int64_t hpoint(0LL);
+		code = calc.createGeometryFromWkt(&hpoint, "POINT(5 5)");
+		ASSERT_TRUE(TE_Ok == code);
+
+		calc.beginBatch();
+		code = calc.updateDifference(hfence, hfence, hfence);
+		ASSERT_TRUE(TE_Ok == code);
+		bool isect;
+		code = calc.intersects(&isect, hfence, hpoint);
+		ASSERT_TRUE(TE_Ok == code);
+		ASSERT_FALSE(isect);
+		calc.endBatch(false);
+
+		code = calc.intersects(&isect, hfence, hpoint);
+		ASSERT_TRUE(TE_Ok == code);
+		ASSERT_TRUE(isect);
+	}
 }
@@ -0,0 +1,92 @@
+#include "pch.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "port/String.h"
+
+using namespace TAK::Engine::Port;
+
+namespace takenginetests {
+
+	TEST(StringTests, testInlineAndHeapCopies) {
+		const std::string shortStr(String::InlineCapacity, 'a');
+		const std::string longStr(String::InlineCapacity + 1u, 'b');
+
+		String s(shortStr.c_str());
+		String l(longStr.c_str());
+		String sc(s);
+		String lc(l);
+		ASSERT_STREQ(shortStr.c_str(), sc.get());
+		ASSERT_STREQ(longStr.c_str(), lc.get());
+		ASSERT_NE(s.get(), sc.get());
+		ASSERT_NE(l.get(), lc.get());
+		ASSERT_TRUE(s == sc);
+		ASSERT_TRUE(l == lc);
+	}
+
+	TEST(StringTests, testNullAndEmpty) {
+		String n;
+		String e("");
+		ASSERT_EQ(nullptr, n.get());
+		ASSERT_STREQ("", e.get());
+		ASSERT_FALSE(n == e);
+		ASSERT_TRUE(n == String());
+	}
+
+	TEST(StringTests, testMoveSurvivesRelocation) {
+		std::vector<String> strs;
+		for (int i = 0; i < 100; i++)
+			strs.push_back(String(std::to_string(i).c_str()));
+		for (int i = 0; i < 100; i++)
+			ASSERT_STREQ(std::to_string(i).c_str(), strs[i].get());
+
+		String moved(std::move(strs[0]));
+		ASSERT_STREQ("0", moved.get());
+		ASSERT_EQ(nullptr, static_cast<const char *>(strs[0]));
+	}
+
+	TEST(StringTests, testAssignFromOwnContent) {
+		const std::string longStr(64u, 'c');
+		String s(longStr.c_str());
+		s = s.get() + 1;
+		ASSERT_STREQ(longStr.c_str() + 1, s.get());
+		String t("inline");
+		t = t.get() + 2;
+		ASSERT_STREQ("line", t.get());
+	}
+
+	TEST(StringTests, testInterned) {
+		const String a = String_intern("interned key");
+		const String b = String_intern(std::string("interned key").c_str());
+		const String c = String_intern("other key");
+		ASSERT_TRUE(a.isInterned());
+		ASSERT_EQ(a.get(), b.get());
+		ASSERT_TRUE(a == b);
+		ASSERT_FALSE(a == c);
+		ASSERT_TRUE(a == String("interned key"));
+
+		// hash is consistent with equality across interned and private copies
+		StringHash hash;
+		ASSERT_EQ(hash(a), hash(String("interned key")));
+
+		// modification detaches from the shared content
+		String copy(a);
+		ASSERT_EQ(a.get(), static_cast<const char *>(copy));
+		copy[0] = 'I';
+		ASSERT_FALSE(copy.isInterned());
+		ASSERT_STREQ("interned key", a.get());
+		ASSERT_STREQ("Interned key", copy.get());
+	}
+
+	TEST(StringTests, testHashedContainer) {
+		std::unordered_map<String, int, StringHash> m;
+		m[String_intern("a")] = 1;
+		m["b"] = 2;
+		ASSERT_EQ(1, m["a"]);
+		ASSERT_EQ(2, m[String_intern("b")]);
+		ASSERT_EQ(2u, m.size());
+	}
+}
@@ -0,0 +1,30 @@
+#include "pch.h"
+
+#include "feature/Style.h"
+
+using namespace TAK::Engine::Util;
+
+using namespace atakmap::feature;
+
+namespace takenginetests {
+
+	TEST(StyleTests, testParseStyleSharedReturnsSameInstance) {
+		StylePtr_Const a(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Style_parseStyleShared(a, "PEN(c:#FF0000FF,w:2px)"));
+		ASSERT_NE(nullptr, a.get());
+		StylePtr_Const b(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Style_parseStyleShared(b, "PEN(c:#FF0000FF,w:2px)"));
+		ASSERT_EQ(a.get(), b.get());
+		ASSERT_EQ(TESC_BasicStrokeStyle, b->getClass());
+
+		StylePtr_Const c(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, Style_parseStyleShared(c, "BRUSH(fc:#00FF00FF)"));
+		ASSERT_NE(a.get(), c.get());
+		ASSERT_EQ(TESC_BasicFillStyle, c->getClass());
+	}
+
+	TEST(StyleTests, testParseStyleSharedNull) {
+		StylePtr_Const a(nullptr, nullptr);
+		ASSERT_EQ(TE_InvalidArg, Style_parseStyleShared(a, nullptr));
+	}
+}
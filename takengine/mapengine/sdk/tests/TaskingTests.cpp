@@ -32,6 +32,13 @@ namespace {
 		output = a + b;
 		return TE_Ok;
 	}
+
+	TAKErr sumStep(int &output, const std::vector<int> &input) {
+		output = 0;
+		for (int v : input)
+			output += v;
+		return TE_Ok;
+	}
 }
 
 namespace takenginetests {
@@ -134,4 +141,71 @@ namespace takenginetests {
 		ASSERT_TRUE(err == TE_Ok);
 		ASSERT_EQ(v, 92);
 	}
-}
\ No newline at end of file
+
+	TEST(TaskingTests, testWhenAllContinuesOnWorker) {
+		std::vector<Future<int>> futures;
+		for (int i = 0; i < 100; ++i)
+			futures.push_back(Task_begin(GeneralWorkers_flex(), value42).then(add1));
+
+		Future<int> f = Task_whenAll(futures)
+			.thenOn(GeneralWorkers_single(), sumStep);
+
+		int v = 0;
+		TAKErr err = TE_Err;
+		TAKErr code = f.await(v, err);
+		ASSERT_TRUE(code == TE_Ok);
+		ASSERT_TRUE(err == TE_Ok);
+		ASSERT_EQ(v, 4300);
+	}
+
+	TEST(TaskingTests, testWhenAllFailsWithInputError) {
+		std::vector<Future<int>> futures;
+		futures.push_back(Task_begin(GeneralWorkers_flex(), value42));
+		futures.push_back(Task_begin(GeneralWorkers_flex(), value42).then(errorStep, TE_InvalidArg));
+
+		std::vector<int> v;
+		TAKErr err = TE_Ok;
+		TAKErr code = Task_whenAll(futures).await(v, err);
+		ASSERT_TRUE(code == TE_Ok);
+		ASSERT_TRUE(err == TE_InvalidArg);
+	}
+
+	TEST(TaskingTests, testWhenAnyFirstSuccess) {
+		std::shared_ptr<ControlWorker> never;
+		ASSERT_EQ(TE_Ok, Worker_createControlWorker(never));
+
+		std::vector<Future<int>> futures;
+		futures.push_back(Task_begin(never, value42));
+		futures.push_back(Task_begin(GeneralWorkers_immediate(), value42).then(middleErrStep));
+		futures.push_back(Task_begin(GeneralWorkers_flex(), value42).then(add1));
+
+		TaskAnyResult<int> v;
+		TAKErr err = TE_Err;
+		TAKErr code = Task_whenAny(futures).await(v, err);
+		ASSERT_TRUE(code == TE_Ok);
+		ASSERT_TRUE(err == TE_Ok);
+		ASSERT_EQ(v.index, 2u);
+		ASSERT_EQ(v.value, 43);
+	}
+
+	TEST(TaskingTests, testCancelReleasesContinuations) {
+		std::shared_ptr<ControlWorker> never;
+		ASSERT_EQ(TE_Ok, Worker_createControlWorker(never));
+
+		FutureTask<int> head = Task_begin(never, value42);
+		std::vector<Future<int>> futures;
+		futures.push_back(head.then(add1).then(add1));
+		Future<std::vector<int>> all = Task_whenAll(futures);
+		head.cancel();
+
+		int v = 0;
+		TAKErr err = TE_Ok;
+		ASSERT_TRUE(futures[0].await(v, err) == TE_Ok);
+		ASSERT_TRUE(err == TE_Canceled);
+
+		std::vector<int> values;
+		err = TE_Ok;
+		ASSERT_TRUE(all.await(values, err) == TE_Ok);
+		ASSERT_TRUE(err == TE_Canceled);
+	}
+}
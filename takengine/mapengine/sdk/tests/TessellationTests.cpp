@@ -7,6 +7,7 @@
 #include <renderer/Tessellate.h>
 #include <renderer/GLTriangulate.h>
 #include <util/Memory.h>
+#include <util/ScratchArena.h>
 
 
 using namespace TAK::Engine;
@@ -255,6 +256,86 @@ namespace takenginetests {
 		code = Tessellate_polygon<double>(result, &resultCount, src, 3u, 0.0, Tessellate_WGS84Algorithm());
 		ASSERT_EQ((int)TE_Ok, (int)code);
 	}
+
+	TEST_F(TessellationTests, tessellate_polygon_WithHole) {
+		// exterior ring followed by a hole
+		double pts[16] = {
+			0.0, 0.0, 10.0, 0.0, 10.0, 10.0, 0.0, 10.0,
+			2.0, 2.0, 2.0, 8.0, 8.0, 8.0, 8.0, 2.0,
+		};
+		int counts[2] = { 4, 4 };
+		int startIndices[2] = { 0, 4 };
+
+		VertexDataPtr result(nullptr, nullptr);
+		VertexData src;
+		src.data = pts;
+		src.size = 2u;
+		src.stride = 16u;
+		std::size_t resultCount;
+		TAKErr code = Tessellate_polygon<double>(result, &resultCount, src, counts, startIndices, 2, 0.0, Tessellate_CartesianAlgorithm());
+
+		ASSERT_EQ((int)TE_Ok, (int)code);
+		// ear clipping does not introduce vertices; each hole adds two triangles
+		ASSERT_EQ((size_t)24u, resultCount);
+
+		const double *tris = static_cast<const double *>(result->data);
+		double area = 0.0;
+		for (std::size_t i = 0u; i < resultCount; i += 3u) {
+			const double *a = tris + (i*2u);
+			const double *b = a + 2u;
+			const double *c = b + 2u;
+			area += fabs((a[0] - c[0]) * (b[1] - a[1]) - (a[0] - b[0]) * (c[1] - a[1])) / 2.0;
+		}
+		ASSERT_NEAR(64.0, area, 1e-9);
+	}
+
+	TEST_F(TessellationTests, tessellate_polygon_SelfIntersecting) {
+		// bowtie; falls back on the GLU tessellator
+		double pts[8] = { 0.0, 0.0, 10.0, 10.0, 10.0, 0.0, 0.0, 10.0 };
+
+		VertexDataPtr result(nullptr, nullptr);
+		VertexData src;
+		src.data = pts;
+		src.size = 2u;
+		src.stride = 16u;
+		std::size_t resultCount;
+		TAKErr code = Tessellate_polygon<double>(result, &resultCount, src, 4u, 0.0, Tessellate_CartesianAlgorithm());
+
+		ASSERT_EQ((int)TE_Ok, (int)code);
+		ASSERT_EQ((size_t)6u, resultCount);
+	}
+	TEST_F(TessellationTests, tessellate_linestring_CartesianArena) {
+		double pts[6] = { 0.0, 0.0, 10.0, 0.0, 10.0, 5.0 };
+
+		VertexData src;
+		src.data = pts;
+		src.size = 2u;
+		src.stride = 16u;
+
+		VertexDataPtr heap(nullptr, nullptr);
+		std::size_t heapCount;
+		TAKErr code = Tessellate_linestring<double>(heap, &heapCount, src, 3u, 2.0, Tessellate_CartesianAlgorithm());
+		ASSERT_EQ((int)TE_Ok, (int)code);
+		// 5 points between the first pair, 2 between the second
+		ASSERT_EQ((size_t)10u, heapCount);
+
+		ScratchArena arena;
+		ScratchArenaScope scope(arena);
+		VertexDataPtr scratch(nullptr, nullptr);
+		std::size_t scratchCount;
+		code = Tessellate_linestring<double>(scratch, &scratchCount, src, 3u, 2.0, Tessellate_CartesianAlgorithm(), arena);
+		ASSERT_EQ((int)TE_Ok, (int)code);
+		ASSERT_EQ(heapCount, scratchCount);
+
+		const double *a = static_cast<const double *>(heap->data);
+		const double *b = static_cast<const double *>(scratch->data);
+		for (std::size_t i = 0u; i < heapCount*2u; i++)
+			ASSERT_EQ(a[i], b[i]);
+		ASSERT_NEAR(10.0/6.0, a[2], 1e-12);
+		ASSERT_EQ(10.0, a[18]);
+		ASSERT_EQ(5.0, a[19]);
+	}
+
 #if 0
 	// benchmarking utility ~125k points, ~80ms
 	TEST_F(TessellationTests, tessellate_QuadThreshold) {
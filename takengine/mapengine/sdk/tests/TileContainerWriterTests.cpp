@@ -0,0 +1,141 @@
+#include "pch.h"
+
+#include <mutex>
+#include <vector>
+
+#include "port/Platform.h"
+#include "raster/tilematrix/TileContainerWriter.h"
+#include "thread/Thread.h"
+
+using namespace TAK::Engine::Util;
+using namespace TAK::Engine::Raster::TileMatrix;
+
+namespace takenginetests {
+	namespace {
+		class TestContainer : public TileContainer {
+		public:
+			TestContainer() : result(TE_Ok), durability(TECD_Full) {}
+			virtual ~TestContainer() NOTHROWS {}
+			virtual const char* getName() const NOTHROWS { return "test"; }
+			virtual int getSRID() const NOTHROWS { return 3857; }
+			virtual TAKErr getZoomLevel(TAK::Engine::Port::Collection<ZoomLevel>& value) const NOTHROWS { return TE_Ok; }
+			virtual double getOriginX() const NOTHROWS { return 0.0; }
+			virtual double getOriginY() const NOTHROWS { return 0.0; }
+			virtual TAKErr getTile(TAK::Engine::Renderer::BitmapPtr& result, const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS { return TE_Unsupported; }
+			virtual TAKErr getTileData(std::unique_ptr<const uint8_t, void(*)(const uint8_t*)>& value, std::size_t* len,
+				const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS { return TE_Unsupported; }
+			virtual TAKErr getBounds(TAK::Engine::Feature::Envelope2 *value) const NOTHROWS { return TE_Unsupported; }
+			virtual TAKErr isReadOnly(bool* value) NOTHROWS { *value = false; return TE_Ok; }
+			virtual TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t* value, const std::size_t len, const int64_t expiration) NOTHROWS
+			{
+				TileWrite tile{ level, x, y, value, len, expiration };
+				return setTiles(&tile, 1u, TECD_Full);
+			}
+			virtual TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const TAK::Engine::Renderer::Bitmap2* data, const int64_t expiration) NOTHROWS { return TE_Unsupported; }
+			virtual bool hasTileExpirationMetadata() NOTHROWS { return false; }
+			virtual int64_t getTileExpiration(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS { return -1LL; }
+			virtual TAKErr setTiles(const TileWrite *tiles, const std::size_t count, const TileContainerDurability durability_) NOTHROWS
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				batches.push_back(count);
+				for (std::size_t i = 0u; i < count; i++)
+					data.push_back(std::vector<uint8_t>(tiles[i].data, tiles[i].data + tiles[i].len));
+				durability = durability_;
+				return result;
+			}
+			std::size_t getNumTiles()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				return data.size();
+			}
+		public:
+			std::mutex mutex;
+			std::vector<std::size_t> batches;
+			std::vector<std::vector<uint8_t>> data;
+			TAKErr result;
+			TileContainerDurability durability;
+		};
+	}
+
+	TEST(TileContainerWriterTests, testBatchedByCount) {
+		TestContainer container;
+		TileContainerWriterOptions opts;
+		opts.batchSize = 4u;
+		opts.maxBatchLatency = 60000LL;
+		opts.durability = TECD_Off;
+		{
+			TileContainerWriter writer(container, opts);
+			for (std::size_t i = 0u; i < 10u; i++) {
+				const uint8_t tile = (uint8_t)i;
+				ASSERT_EQ(TE_Ok, writer.setTile(0u, i, 0u, &tile, 1u, 0LL));
+			}
+			ASSERT_EQ(TE_Ok, writer.flush());
+		}
+		ASSERT_EQ(10u, container.data.size());
+		ASSERT_GE(container.batches.size(), 3u);
+		for (std::size_t i = 0u; i < container.batches.size(); i++)
+			ASSERT_LE(container.batches[i], 4u);
+		for (std::size_t i = 0u; i < 10u; i++)
+			ASSERT_EQ((uint8_t)i, container.data[i][0]);
+		ASSERT_EQ(TECD_Off, container.durability);
+	}
+
+	TEST(TileContainerWriterTests, testBatchedByLatency) {
+		TestContainer container;
+		TileContainerWriterOptions opts;
+		opts.batchSize = 100u;
+		opts.maxBatchLatency = 50LL;
+		TileContainerWriter writer(container, opts);
+		const uint8_t tile[3u] = { 1u, 2u, 3u };
+		for (std::size_t i = 0u; i < 3u; i++)
+			ASSERT_EQ(TE_Ok, writer.setTile(0u, i, 0u, tile, 3u, 0LL));
+		// tiles are written without a flush once the latency elapses
+		const int64_t start = TAK::Engine::Port::Platform_systime_millis();
+		while (container.getNumTiles() < 3u && (TAK::Engine::Port::Platform_systime_millis() - start) < 5000LL)
+			TAK::Engine::Thread::Thread_sleep(10LL);
+		ASSERT_EQ(3u, container.getNumTiles());
+	}
+
+	TEST(TileContainerWriterTests, testDataCopied) {
+		TestContainer container;
+		TileContainerWriter writer(container);
+		std::vector<uint8_t> tile(16u, 0xAAu);
+		ASSERT_EQ(TE_Ok, writer.setTile(1u, 2u, 3u, &tile[0], tile.size(), 0LL));
+		std::fill(tile.begin(), tile.end(), 0x55u);
+		ASSERT_EQ(TE_Ok, writer.flush());
+		ASSERT_EQ(1u, container.data.size());
+		ASSERT_EQ(std::vector<uint8_t>(16u, 0xAAu), container.data[0]);
+	}
+
+	TEST(TileContainerWriterTests, testFlushReportsError) {
+		TestContainer container;
+		container.result = TE_IO;
+		TileContainerWriter writer(container);
+		const uint8_t tile = 0u;
+		ASSERT_EQ(TE_Ok, writer.setTile(0u, 0u, 0u, &tile, 1u, 0LL));
+		ASSERT_EQ(TE_IO, writer.flush());
+		// the error is cleared by the flush that reported it
+		ASSERT_EQ(TE_Ok, writer.flush());
+	}
+
+	TEST(TileContainerWriterTests, testDefaultSetTilesWritesEachTile) {
+		class SingleTileContainer : public TestContainer {
+		public:
+			virtual TAKErr setTiles(const TileWrite *tiles, const std::size_t count, const TileContainerDurability durability) NOTHROWS
+			{
+				return TileContainer::setTiles(tiles, count, durability);
+			}
+			virtual TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t* value, const std::size_t len, const int64_t expiration) NOTHROWS
+			{
+				data.push_back(std::vector<uint8_t>(value, value + len));
+				return TE_Ok;
+			}
+		};
+		SingleTileContainer container;
+		const uint8_t tile[2u] = { 7u, 9u };
+		const TileWrite writes[2u] = { { 0u, 0u, 0u, tile, 1u, 0LL }, { 0u, 1u, 0u, tile + 1u, 1u, 0LL } };
+		ASSERT_EQ(TE_Ok, container.setTiles(writes, 2u, TECD_Normal));
+		ASSERT_EQ(2u, container.data.size());
+		ASSERT_EQ(9u, container.data[1][0]);
+	}
+}
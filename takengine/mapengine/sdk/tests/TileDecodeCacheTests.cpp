@@ -0,0 +1,104 @@
+#include "pch.h"
+
+#include <chrono>
+#include <thread>
+
+#include "raster/tilereader/TileDecodeCache.h"
+
+using namespace TAK::Engine::Raster::TileReader;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		TileDecodeCache::Key createKey(const int64_t column)
+		{
+			TileDecodeCache::Key key;
+			key.uri = "file:///tiles.mbtiles";
+			key.level = 3u;
+			key.column = column;
+			key.row = 2;
+			key.width = 16u;
+			key.height = 16u;
+			key.format = Bitmap2::RGBA32;
+			return key;
+		}
+
+		std::shared_ptr<const Bitmap2> createTile()
+		{
+			return std::make_shared<const Bitmap2>(16u, 16u, Bitmap2::RGBA32);
+		}
+	}
+
+	TEST(TileDecodeCacheTests, testSingleDecode) {
+		TileDecodeCache cache(1024u * 1024u, 60000LL);
+		const TileDecodeCache::Key key = createKey(1);
+
+		std::shared_ptr<const Bitmap2> tile;
+		ASSERT_EQ(TE_Done, cache.acquire(tile, key));
+
+		// a concurrent request waits for the decode
+		std::shared_ptr<const Bitmap2> waited;
+		TAKErr waitedCode = TE_Err;
+		std::thread waiter([&]() { waitedCode = cache.acquire(waited, key); });
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		const std::shared_ptr<const Bitmap2> decoded = createTile();
+		cache.put(key, decoded);
+		waiter.join();
+		ASSERT_EQ(TE_Ok, waitedCode);
+		ASSERT_EQ(decoded.get(), waited.get());
+
+		ASSERT_EQ(TE_Ok, cache.acquire(tile, key));
+		ASSERT_EQ(decoded.get(), tile.get());
+		ASSERT_EQ(16u * 16u * 4u, cache.getSize());
+
+		// a different version is a different tile
+		TileDecodeCache::Key updated = key;
+		updated.version = 1;
+		ASSERT_EQ(TE_Done, cache.acquire(tile, updated));
+		cache.abandon(updated);
+	}
+
+	TEST(TileDecodeCacheTests, testAbandonRedirectsDecode) {
+		TileDecodeCache cache(1024u * 1024u, 60000LL);
+		const TileDecodeCache::Key key = createKey(1);
+
+		std::shared_ptr<const Bitmap2> tile;
+		ASSERT_EQ(TE_Done, cache.acquire(tile, key));
+		cache.abandon(key);
+		ASSERT_EQ(TE_Done, cache.acquire(tile, key));
+		cache.abandon(key);
+		ASSERT_EQ(0u, cache.getSize());
+	}
+
+	TEST(TileDecodeCacheTests, testEviction) {
+		// budget of two tiles
+		TileDecodeCache cache(2u * 16u * 16u * 4u, 60000LL);
+		std::shared_ptr<const Bitmap2> tile;
+		for (int64_t i = 0; i < 3; i++) {
+			ASSERT_EQ(TE_Done, cache.acquire(tile, createKey(i)));
+			cache.put(createKey(i), createTile());
+		}
+		ASSERT_EQ(2u * 16u * 16u * 4u, cache.getSize());
+		// oldest is evicted
+		ASSERT_EQ(TE_Done, cache.acquire(tile, createKey(0)));
+		cache.abandon(createKey(0));
+		ASSERT_EQ(TE_Ok, cache.acquire(tile, createKey(2)));
+
+		cache.clear();
+		ASSERT_EQ(0u, cache.getSize());
+	}
+
+	TEST(TileDecodeCacheTests, testExpiration) {
+		TileDecodeCache cache(1024u * 1024u, 10LL);
+		const TileDecodeCache::Key key = createKey(1);
+		std::shared_ptr<const Bitmap2> tile;
+		ASSERT_EQ(TE_Done, cache.acquire(tile, key));
+		cache.put(key, createTile());
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		ASSERT_EQ(TE_Done, cache.acquire(tile, key));
+		cache.abandon(key);
+		ASSERT_EQ(0u, cache.getSize());
+	}
+}
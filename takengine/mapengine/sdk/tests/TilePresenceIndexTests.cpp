@@ -0,0 +1,114 @@
+#include "pch.h"
+
+#include <set>
+#include <tuple>
+
+#include "raster/tilematrix/TilePresenceIndex.h"
+#include "util/Memory.h"
+
+using namespace TAK::Engine::Util;
+using namespace TAK::Engine::Raster::TileMatrix;
+
+namespace takenginetests {
+	namespace {
+		typedef std::tuple<std::size_t, std::size_t, std::size_t> TileIndex;
+
+		class TestContainer : public TileContainer {
+		public:
+			TestContainer() : reads(0u) {}
+			virtual ~TestContainer() NOTHROWS {}
+			virtual const char* getName() const NOTHROWS { return "test"; }
+			virtual int getSRID() const NOTHROWS { return 3857; }
+			virtual TAKErr getZoomLevel(TAK::Engine::Port::Collection<ZoomLevel>& value) const NOTHROWS { return TE_Ok; }
+			virtual double getOriginX() const NOTHROWS { return 0.0; }
+			virtual double getOriginY() const NOTHROWS { return 0.0; }
+			virtual TAKErr getTile(TAK::Engine::Renderer::BitmapPtr& result, const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS { return TE_Unsupported; }
+			virtual TAKErr getTileData(std::unique_ptr<const uint8_t, void(*)(const uint8_t*)>& value, std::size_t* len,
+				const std::size_t zoom, const std::size_t x, const std::size_t y) NOTHROWS
+			{
+				reads++;
+				if (tiles.find(TileIndex(zoom, x, y)) == tiles.end())
+					return TE_Done;
+				value = std::unique_ptr<const uint8_t, void(*)(const uint8_t*)>(new uint8_t[1u] { (uint8_t)x }, Memory_array_deleter_const<uint8_t>);
+				*len = 1u;
+				return TE_Ok;
+			}
+			virtual TAKErr getBounds(TAK::Engine::Feature::Envelope2 *value) const NOTHROWS { return TE_Unsupported; }
+			virtual TAKErr isReadOnly(bool* value) NOTHROWS { *value = false; return TE_Ok; }
+			virtual TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const uint8_t* value, const std::size_t len, const int64_t expiration) NOTHROWS
+			{
+				tiles.insert(TileIndex(level, x, y));
+				return TE_Ok;
+			}
+			virtual TAKErr setTile(const std::size_t level, const std::size_t x, const std::size_t y, const TAK::Engine::Renderer::Bitmap2* data, const int64_t expiration) NOTHROWS { return TE_Unsupported; }
+			virtual bool hasTileExpirationMetadata() NOTHROWS { return false; }
+			virtual int64_t getTileExpiration(const std::size_t level, const std::size_t x, const std::size_t y) NOTHROWS { return -1LL; }
+		public:
+			std::set<TileIndex> tiles;
+			std::size_t reads;
+		};
+
+		TAKErr buildIndex(TilePresenceIndex &index, TileContainer &container, void *opaque) {
+			const std::set<TileIndex> &tiles = static_cast<TestContainer &>(container).tiles;
+			for (auto it = tiles.begin(); it != tiles.end(); it++)
+				index.add(std::get<0>(*it), std::get<1>(*it), std::get<2>(*it));
+			return TE_Ok;
+		}
+
+		TAKErr failIndex(TilePresenceIndex &index, TileContainer &container, void *opaque) {
+			return TE_IO;
+		}
+	}
+
+	TEST(TilePresenceIndexTests, testAddRemoveContains) {
+		TilePresenceIndex index;
+		ASSERT_FALSE(index.contains(3u, 1u, 2u));
+		index.add(3u, 1u, 2u);
+		index.add(3u, 1u, 2u);
+		index.add(20u, 1000000u, 524287u);
+		ASSERT_TRUE(index.contains(3u, 1u, 2u));
+		ASSERT_FALSE(index.contains(3u, 2u, 1u));
+		ASSERT_FALSE(index.contains(4u, 1u, 2u));
+		ASSERT_TRUE(index.contains(20u, 1000000u, 524287u));
+		ASSERT_EQ(2u, index.size());
+		index.remove(3u, 1u, 2u);
+		ASSERT_FALSE(index.contains(3u, 1u, 2u));
+		ASSERT_EQ(1u, index.size());
+		index.clear();
+		ASSERT_EQ(0u, index.size());
+	}
+
+	TEST(TilePresenceIndexTests, testMissesSkipContainer) {
+		TestContainer *impl = new TestContainer();
+		impl->tiles.insert(TileIndex(2u, 1u, 1u));
+		TileContainerPtr container(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, TileContainer_createIndexed(container, TileContainerPtr(impl, Memory_deleter_const<TileContainer, TestContainer>), buildIndex, nullptr));
+
+		std::unique_ptr<const uint8_t, void(*)(const uint8_t*)> data(nullptr, nullptr);
+		std::size_t len;
+		ASSERT_EQ(TE_Done, container->getTileData(data, &len, 2u, 0u, 1u));
+		ASSERT_EQ(TE_Done, container->getTileData(data, &len, 7u, 3u, 3u));
+		ASSERT_EQ(0u, impl->reads);
+		ASSERT_EQ(TE_Ok, container->getTileData(data, &len, 2u, 1u, 1u));
+		ASSERT_EQ(1u, impl->reads);
+
+		// writes through the container are indexed
+		const uint8_t tile = 0u;
+		ASSERT_EQ(TE_Ok, container->setTile(2u, 0u, 1u, &tile, 1u, 0LL));
+		const TileWrite writes[1u] = { { 3u, 4u, 5u, &tile, 1u, 0LL } };
+		ASSERT_EQ(TE_Ok, container->setTiles(writes, 1u, TECD_Normal));
+		ASSERT_EQ(TE_Ok, container->getTileData(data, &len, 2u, 0u, 1u));
+		ASSERT_EQ(TE_Ok, container->getTileData(data, &len, 3u, 4u, 5u));
+		ASSERT_EQ(3u, impl->reads);
+	}
+
+	TEST(TilePresenceIndexTests, testBuildFailurePassesThrough) {
+		TestContainer *impl = new TestContainer();
+		TileContainerPtr container(nullptr, nullptr);
+		ASSERT_EQ(TE_Ok, TileContainer_createIndexed(container, TileContainerPtr(impl, Memory_deleter_const<TileContainer, TestContainer>), failIndex, nullptr));
+		std::unique_ptr<const uint8_t, void(*)(const uint8_t*)> data(nullptr, nullptr);
+		std::size_t len;
+		ASSERT_EQ(TE_Done, container->getTileData(data, &len, 0u, 0u, 0u));
+		ASSERT_EQ(1u, impl->reads);
+	}
+}
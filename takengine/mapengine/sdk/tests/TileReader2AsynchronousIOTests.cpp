@@ -0,0 +1,160 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "raster/tilereader/TileReader2.h"
+
+using namespace TAK::Engine::Raster::TileReader;
+using namespace TAK::Engine::Renderer;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		class TestReader : public TileReader2
+		{
+		public :
+			TestReader(const bool blocking_) NOTHROWS :
+				TileReader2("test"),
+				blocking(blocking_),
+				released(false)
+			{}
+		public :
+			TAKErr getWidth(int64_t *value) NOTHROWS override { *value = 256; return TE_Ok; }
+			TAKErr getHeight(int64_t *value) NOTHROWS override { *value = 256; return TE_Ok; }
+			TAKErr getTileWidth(size_t *value) NOTHROWS override { *value = 256u; return TE_Ok; }
+			TAKErr getTileHeight(size_t *value) NOTHROWS override { *value = 256u; return TE_Ok; }
+			TAKErr read(uint8_t *buf, const int64_t srcX, const int64_t srcY, const int64_t srcW, const int64_t srcH,
+			            const size_t dstW, const size_t dstH) NOTHROWS override
+			{
+				if (blocking) {
+					std::unique_lock<std::mutex> lock(mutex);
+					cv.wait(lock, [this]() { return released; });
+				}
+				return TE_Ok;
+			}
+			TAKErr getFormat(Bitmap2::Format *format) NOTHROWS override { *format = Bitmap2::RGBA32; return TE_Ok; }
+		public :
+			void unblock() NOTHROWS
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				released = true;
+				cv.notify_all();
+			}
+		private :
+			const bool blocking;
+			bool released;
+			std::mutex mutex;
+			std::condition_variable cv;
+		};
+
+		class BatchingReader : public TestReader
+		{
+		public :
+			BatchingReader() NOTHROWS :
+				TestReader(true),
+				maxBatch(0u)
+			{}
+		public :
+			TAKErr getWidth(int64_t *value) NOTHROWS override { *value = 1024; return TE_Ok; }
+			TAKErr getHeight(int64_t *value) NOTHROWS override { *value = 1024; return TE_Ok; }
+			TAKErr readTiles(TileRead *tiles, const size_t count) NOTHROWS override
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					maxBatch = std::max(maxBatch, count);
+				}
+				return TileReader2::readTiles(tiles, count);
+			}
+		public :
+			std::size_t getMaxBatch() NOTHROWS
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				return maxBatch;
+			}
+		private :
+			std::size_t maxBatch;
+			std::mutex mutex;
+		};
+
+		class CompletionCounter : public TileReader2::AsynchronousReadRequestListener
+		{
+		public :
+			void requestCreated(const int id) NOTHROWS override {}
+			void requestStarted(const int id) NOTHROWS override {}
+			void requestUpdate(const int id, const Bitmap2 &data) NOTHROWS override {}
+			void requestCompleted(const int id) NOTHROWS override
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				completed++;
+				cv.notify_all();
+			}
+			void requestCanceled(const int id) NOTHROWS override {}
+			void requestError(const int id, const TAKErr code, const char *msg) NOTHROWS override {}
+		public :
+			bool await(const std::size_t count, const int64_t millis) NOTHROWS
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				return cv.wait_for(lock, std::chrono::milliseconds(millis), [&]() { return completed >= count; });
+			}
+		private :
+			std::size_t completed{0u};
+			std::mutex mutex;
+			std::condition_variable cv;
+		};
+	}
+
+	TEST(TileReader2AsynchronousIOTests, testSlowReaderDoesNotStarveOthers) {
+		TileReader2::AsynchronousIO io;
+		std::shared_ptr<TestReader> slow(new TestReader(true));
+		std::shared_ptr<TestReader> fast(new TestReader(false));
+		CompletionCounter slowListener;
+		CompletionCounter fastListener;
+
+		// request IDs are per reader; advance the fast reader's IDs so that
+		// ordering by ID alone would favor the slow reader
+		for (int i = 0; i < 64; i++)
+			TileReader2::ReadRequest(fast, 0, 0, 0, &fastListener);
+
+		// saturate the IO threads with requests for the slow reader
+		std::vector<std::shared_ptr<TileReader2::ReadRequest>> requests;
+		for (int i = 0; i < 16; i++) {
+			requests.push_back(std::make_shared<TileReader2::ReadRequest>(slow, 0, 0, 0, &slowListener));
+			ASSERT_EQ(TE_Ok, io.asyncRead(requests.back()));
+		}
+		for (int i = 0; i < 4; i++) {
+			requests.push_back(std::make_shared<TileReader2::ReadRequest>(fast, 0, 0, 0, &fastListener));
+			ASSERT_EQ(TE_Ok, io.asyncRead(requests.back()));
+		}
+
+		// the fast reader completes while the slow reader is blocked
+		ASSERT_TRUE(fastListener.await(4u, 5000LL));
+
+		slow->unblock();
+		ASSERT_TRUE(slowListener.await(16u, 5000LL));
+		io.release();
+	}
+
+	TEST(TileReader2AsynchronousIOTests, testQueuedTileRequestsAreBatched) {
+		TileReader2::AsynchronousIO io;
+		std::shared_ptr<BatchingReader> reader(new BatchingReader());
+		CompletionCounter listener;
+
+		// the first request blocks the reader while the remainder are queued
+		std::vector<std::shared_ptr<TileReader2::ReadRequest>> requests;
+		for (int64_t i = 0; i < 8; i++) {
+			requests.push_back(std::make_shared<TileReader2::ReadRequest>(reader, 0, i % 4, i / 4, &listener));
+			ASSERT_EQ(TE_Ok, io.asyncRead(requests.back()));
+		}
+
+		reader->unblock();
+		ASSERT_TRUE(listener.await(8u, 5000LL));
+		ASSERT_GT(reader->getMaxBatch(), 1u);
+		io.release();
+	}
+}
@@ -0,0 +1,83 @@
+#include "pch.h"
+
+#include <string>
+#include <thread>
+
+#include "util/DataOutput2.h"
+#include "util/Trace.h"
+
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	namespace {
+		std::string exportTrace() {
+			DynamicOutput output;
+			if (output.open(4096u) != TE_Ok)
+				return std::string();
+			if (Trace_export(output, TETF_ChromeJson) != TE_Ok)
+				return std::string();
+			const uint8_t *data;
+			std::size_t len;
+			if (output.get(&data, &len) != TE_Ok)
+				return std::string();
+			return std::string(reinterpret_cast<const char *>(data), len);
+		}
+	}
+
+	TEST(TraceTests, testDisabledRecordsNothing) {
+		Trace_setEnabled(false);
+		Trace_clear();
+		{
+			TE_TRACE_SCOPE("test", "TraceTests.disabled");
+		}
+		const std::string json = exportTrace();
+		ASSERT_EQ(std::string::npos, json.find("TraceTests.disabled"));
+	}
+
+	TEST(TraceTests, testScopeAndCounterExported) {
+		Trace_clear();
+		Trace_setEnabled(true);
+		{
+			TE_TRACE_SCOPE("test", "TraceTests.scope");
+			TE_TRACE_COUNTER("test", "TraceTests.counter", 42);
+		}
+		Trace_setEnabled(false);
+		const std::string json = exportTrace();
+		ASSERT_NE(std::string::npos, json.find("\"ph\":\"B\",\"pid\":1"));
+		ASSERT_NE(std::string::npos, json.find("\"name\":\"TraceTests.scope\""));
+		ASSERT_NE(std::string::npos, json.find("\"args\":{\"value\":42}"));
+		ASSERT_EQ(0u, json.find("{\"displayTimeUnit\""));
+	}
+
+	TEST(TraceTests, testFlowAcrossThreads) {
+		Trace_clear();
+		Trace_setEnabled(true);
+		const uint64_t id = Trace_newFlowId();
+		{
+			TE_TRACE_SCOPE("test", "TraceTests.issue");
+			TE_TRACE_FLOW_BEGIN("test", "TraceTests.flow", id);
+		}
+		std::thread worker([id]() {
+			TE_TRACE_SCOPE("test", "TraceTests.complete");
+			TE_TRACE_FLOW_END("test", "TraceTests.flow", id);
+		});
+		worker.join();
+		Trace_setEnabled(false);
+		const std::string json = exportTrace();
+		ASSERT_NE(std::string::npos, json.find("\"ph\":\"s\""));
+		ASSERT_NE(std::string::npos, json.find("\"ph\":\"f\""));
+		ASSERT_NE(std::string::npos, json.find("\"bp\":\"e\""));
+	}
+
+	TEST(TraceTests, testClearDiscardsEvents) {
+		Trace_setEnabled(true);
+		{
+			TE_TRACE_SCOPE("test", "TraceTests.cleared");
+		}
+		Trace_setEnabled(false);
+		Trace_clear();
+		const std::string json = exportTrace();
+		ASSERT_EQ(std::string::npos, json.find("TraceTests.cleared"));
+	}
+}
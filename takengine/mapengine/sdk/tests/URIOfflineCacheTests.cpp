@@ -1,8 +1,16 @@
 #include "pch.h"
 
+#include <atomic>
 #include <cmath>
+#include <thread>
+#include <vector>
 
+#include <port/Platform.h>
+#include <thread/Thread.h>
+#include <util/IO2.h>
 #include <util/Memory.h>
+#include <util/ProtocolHandler.h>
+#include <util/URI.h>
 #include <util/URIOfflineCache.h>
 
 using namespace TAK::Engine;
@@ -11,6 +19,54 @@ using namespace TAK::Engine::Util;
 using namespace TAK::Engine::Tests;
 
 namespace takenginetests {
+	namespace {
+		const uint8_t content[] = { 'c', 'o', 'n', 't', 'e', 'n', 't' };
+
+		class CountingProtocolHandler : public ProtocolHandler
+		{
+		public:
+			CountingProtocolHandler() : opens(0) {}
+			~CountingProtocolHandler() NOTHROWS override {}
+			TAKErr handleURI(DataInput2Ptr &ctx, const char *uri) NOTHROWS override
+			{
+				if (strncmp(uri, "counting:", 9) != 0)
+					return TE_Unsupported;
+				opens++;
+				// hold the fetch open so that concurrent opens overlap
+				TAK::Engine::Thread::Thread_sleep(100LL);
+				std::unique_ptr<MemoryInput2> input(new MemoryInput2());
+				input->open(content, sizeof(content));
+				ctx = DataInput2Ptr(input.release(), Memory_deleter_const<DataInput2, MemoryInput2>);
+				return TE_Ok;
+			}
+		public:
+			std::atomic<int> opens;
+		};
+
+		std::string createCacheDir(const char *name)
+		{
+			TAK::Engine::Port::String path;
+			IO_createTempFile(path, name, "", nullptr);
+			IO_delete(path);
+			IO_mkdirs(path);
+			return path.get();
+		}
+
+		bool isCached(URIOfflineCache &cache, const char *URI)
+		{
+			DataInput2Ptr input(nullptr, nullptr);
+			return cache.openCached(input, URI, 3600) == TE_Ok;
+		}
+
+		// checks the file on disk without touching the entry
+		bool isOnDisk(URIOfflineCache &cache, const char *name)
+		{
+			bool exists = false;
+			IO_exists(&exists, (std::string(cache.getPath()) + name).c_str());
+			return exists;
+		}
+	}
+
 	class URIOfflineCacheTests : public ::testing::Test
 	{
 	protected:
@@ -26,4 +82,83 @@ namespace takenginetests {
 		}
 	};
 
-}
\ No newline at end of file
+	TEST_F(URIOfflineCacheTests, testConcurrentOpensShareFetch) {
+		auto handler = std::make_shared<CountingProtocolHandler>();
+		URI_registerProtocolHandler(handler, 100);
+		{
+			URIOfflineCache cache(createCacheDir("urioc").c_str(), 1024u * 1024u);
+			std::vector<std::thread> threads;
+			std::atomic<int> succeeded(0);
+			for (int i = 0; i < 4; i++) {
+				threads.push_back(std::thread([&]() {
+					DataInput2Ptr input(nullptr, nullptr);
+					if (cache.open(input, "counting://host/tile", 3600) != TE_Ok)
+						return;
+					uint8_t buf[sizeof(content)];
+					std::size_t numRead;
+					if (input->read(buf, &numRead, sizeof(buf)) == TE_Ok && numRead == sizeof(content) && !memcmp(buf, content, numRead))
+						succeeded++;
+				}));
+			}
+			for (auto &t : threads)
+				t.join();
+			ASSERT_EQ(4, succeeded.load());
+			ASSERT_EQ(1, handler->opens.load());
+
+			// served from the cache
+			DataInput2Ptr input(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, cache.open(input, "counting://host/tile", 3600));
+			ASSERT_EQ(1, handler->opens.load());
+		}
+		URI_unregisterProtocolHandler(handler);
+	}
+
+	TEST_F(URIOfflineCacheTests, testEvictsLeastRecentlyUsed) {
+		URIOfflineCache cache(createCacheDir("urioc").c_str(), 250u);
+		std::vector<uint8_t> data(100u, 0xAAu);
+		ASSERT_EQ(TE_Ok, cache.put("test://a", &data[0], data.size()));
+		TAK::Engine::Thread::Thread_sleep(20LL);
+		ASSERT_EQ(TE_Ok, cache.put("test://b", &data[0], data.size()));
+		TAK::Engine::Thread::Thread_sleep(20LL);
+		// access 'a' so that 'b' is the least recently used
+		ASSERT_TRUE(isCached(cache, "test://a"));
+		TAK::Engine::Thread::Thread_sleep(20LL);
+		ASSERT_EQ(TE_Ok, cache.put("test://c", &data[0], data.size()));
+
+		const int64_t start = TAK::Engine::Port::Platform_systime_millis();
+		while (isOnDisk(cache, "test%3A%2F%2Fb") && (TAK::Engine::Port::Platform_systime_millis() - start) < 5000LL)
+			TAK::Engine::Thread::Thread_sleep(10LL);
+		ASSERT_FALSE(isOnDisk(cache, "test%3A%2F%2Fb"));
+		ASSERT_TRUE(isOnDisk(cache, "test%3A%2F%2Fa"));
+		ASSERT_TRUE(isOnDisk(cache, "test%3A%2F%2Fc"));
+	}
+
+	TEST_F(URIOfflineCacheTests, testAsyncRenewServesStale) {
+		auto handler = std::make_shared<CountingProtocolHandler>();
+		URI_registerProtocolHandler(handler, 100);
+		{
+			URIOfflineCache cache(createCacheDir("urioc").c_str(), 1024u * 1024u);
+			const uint8_t stale[] = { 's', 't', 'a', 'l', 'e' };
+			ASSERT_EQ(TE_Ok, cache.put("counting://host/renew", stale, sizeof(stale)));
+			TAK::Engine::Thread::Thread_sleep(1100LL);
+
+			// stale content is returned without waiting on the fetch
+			DataInput2Ptr input(nullptr, nullptr);
+			ASSERT_EQ(TE_Ok, cache.openAsyncRenew(input, "counting://host/renew", 1, 3600));
+			uint8_t buf[16];
+			std::size_t numRead;
+			ASSERT_EQ(TE_Ok, input->read(buf, &numRead, sizeof(buf)));
+			ASSERT_EQ(sizeof(stale), numRead);
+			input.reset();
+
+			const int64_t start = TAK::Engine::Port::Platform_systime_millis();
+			while (cache.openCached(input, "counting://host/renew", 1) != TE_Ok && (TAK::Engine::Port::Platform_systime_millis() - start) < 5000LL)
+				TAK::Engine::Thread::Thread_sleep(10LL);
+			ASSERT_EQ(1, handler->opens.load());
+			ASSERT_TRUE(!!input);
+			ASSERT_EQ(TE_Ok, input->read(buf, &numRead, sizeof(buf)));
+			ASSERT_EQ(sizeof(content), numRead);
+		}
+		URI_unregisterProtocolHandler(handler);
+	}
+}
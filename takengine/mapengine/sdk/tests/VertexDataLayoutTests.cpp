@@ -0,0 +1,93 @@
+#include "pch.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "model/VertexDataLayout.h"
+
+using namespace TAK::Engine::Model;
+using namespace TAK::Engine::Port;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+
+	TEST(VertexDataLayoutTests, testQuantizedLayoutSize) {
+		VertexDataLayout layout;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_createQuantizedInterleaved(&layout, TEVA_Position | TEVA_Normal | TEVA_TexCoord0 | TEVA_Color));
+		ASSERT_TRUE(VertexDataLayout_isQuantized(layout));
+		// position 6+2, texcoord 4, normal 2+2, color 4
+		ASSERT_EQ(20u, layout.position.stride);
+		ASSERT_EQ(0u, layout.position.offset);
+		ASSERT_EQ(8u, layout.texCoord0.offset);
+		ASSERT_EQ(12u, layout.normal.offset);
+		ASSERT_EQ(16u, layout.color.offset);
+
+		std::size_t size;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_requiredInterleavedDataSize(&size, layout, 2u));
+		ASSERT_EQ(40u, size);
+		ASSERT_EQ(TE_Ok, VertexDataLayout_requiredDataSize(&size, layout, TEVA_Normal, 2u));
+		ASSERT_EQ(34u, size);
+
+		VertexDataLayout defaultLayout;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_createDefaultInterleaved(&defaultLayout, TEVA_Position | TEVA_Normal | TEVA_TexCoord0 | TEVA_Color));
+		ASSERT_FALSE(VertexDataLayout_isQuantized(defaultLayout));
+		ASSERT_EQ(36u, defaultLayout.position.stride);
+	}
+
+	TEST(VertexDataLayoutTests, testQuantizeRoundTrip) {
+		VertexDataLayout srcLayout;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_createDefaultInterleaved(&srcLayout, TEVA_Position | TEVA_Normal | TEVA_TexCoord0));
+		VertexDataLayout dstLayout;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_createQuantizedInterleaved(&dstLayout, srcLayout.attributes));
+
+		const float vertices[3][8] = {
+			// x, y, z, u, v, nx, ny, nz
+			{ -10.f, 5.f, 100.f, 0.f, 0.f, 0.f, 0.f, 1.f },
+			{ 30.f, 5.5f, 120.f, 2.f, 0.5f, 0.f, -0.6f, -0.8f },
+			{ 12.5f, 7.f, 110.f, 1.f, 1.f, 1.f, 0.f, 0.f },
+		};
+		ASSERT_EQ(32u, srcLayout.position.stride);
+
+		std::size_t size;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_requiredInterleavedDataSize(&size, dstLayout, 3u));
+		std::vector<uint8_t> dst(size);
+		VertexQuantization quantization;
+		ASSERT_EQ(TE_Ok, VertexDataLayout_quantize(&dst[0], &quantization, dstLayout, vertices, srcLayout, 3u));
+
+		ASSERT_EQ(-10.0, quantization.positionOffset[0]);
+		ASSERT_EQ(40.0, quantization.positionScale[0]);
+		ASSERT_EQ(2.0, quantization.texCoordScale[0][0]);
+
+		for (std::size_t i = 0u; i < 3u; i++) {
+			uint16_t q[3];
+			memcpy(q, &dst[i*dstLayout.position.stride + dstLayout.position.offset], sizeof(q));
+			for (std::size_t j = 0u; j < 3u; j++)
+				ASSERT_NEAR(vertices[i][j], quantization.positionOffset[j] + quantization.positionScale[j] * (q[j] / 65535.0), 1e-3);
+
+			uint16_t uv[2];
+			memcpy(uv, &dst[i*dstLayout.texCoord0.stride + dstLayout.texCoord0.offset], sizeof(uv));
+			for (std::size_t j = 0u; j < 2u; j++)
+				ASSERT_NEAR(vertices[i][3u+j], quantization.texCoordOffset[0][j] + quantization.texCoordScale[0][j] * (uv[j] / 65535.0), 1e-4);
+
+			// decode the octahedral normal
+			const uint8_t *e = &dst[i*dstLayout.normal.stride + dstLayout.normal.offset];
+			double n[3];
+			n[0] = e[0] / 255.0 * 2.0 - 1.0;
+			n[1] = e[1] / 255.0 * 2.0 - 1.0;
+			n[2] = 1.0 - fabs(n[0]) - fabs(n[1]);
+			if (n[2] < 0.0) {
+				const double x = n[0];
+				n[0] = (1.0 - fabs(n[1])) * (x >= 0.0 ? 1.0 : -1.0);
+				n[1] = (1.0 - fabs(x)) * (n[1] >= 0.0 ? 1.0 : -1.0);
+			}
+			const double len = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+			for (std::size_t j = 0u; j < 3u; j++)
+				ASSERT_NEAR(vertices[i][5u+j], n[j] / len, 0.02);
+		}
+
+		// source must be float
+		srcLayout.position.type = TEDT_Int16;
+		ASSERT_EQ(TE_InvalidArg, VertexDataLayout_quantize(&dst[0], &quantization, dstLayout, vertices, srcLayout, 3u));
+	}
+}
@@ -0,0 +1,85 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "elevation/Viewshed.h"
+
+using namespace TAK::Engine::Elevation;
+using namespace TAK::Engine::Util;
+
+namespace takenginetests {
+	namespace {
+		std::vector<double> createDistances(const std::size_t count, const double spacing)
+		{
+			std::vector<double> distances(count);
+			for (std::size_t i = 0u; i < count; i++)
+				distances[i] = (i + 1u) * spacing;
+			return distances;
+		}
+	}
+
+	TEST(ViewshedTests, testFlatVisible) {
+		ViewshedParameters params;
+		params.earthCurvature = false;
+		const std::vector<double> els(100u, 10.0);
+		const std::vector<double> distances = createDistances(els.size(), 30.0);
+
+		std::vector<uint8_t> visibility(els.size());
+		Viewshed_sweep(visibility.data(), els.data(), distances.data(), els.size(), 10.0, params);
+		for (std::size_t i = 0u; i < visibility.size(); i++)
+			ASSERT_EQ(TEVV_Visible, visibility[i]);
+	}
+
+	TEST(ViewshedTests, testRidgeOccludes) {
+		ViewshedParameters params;
+		params.earthCurvature = false;
+		params.observerHeight = 2.0;
+		std::vector<double> els(100u, 0.0);
+		els[10u] = 50.0;
+		const std::vector<double> distances = createDistances(els.size(), 30.0);
+
+		std::vector<uint8_t> visibility(els.size());
+		Viewshed_sweep(visibility.data(), els.data(), distances.data(), els.size(), 0.0, params);
+		for (std::size_t i = 0u; i <= 10u; i++)
+			ASSERT_EQ(TEVV_Visible, visibility[i]);
+		for (std::size_t i = 11u; i < visibility.size(); i++)
+			ASSERT_EQ(TEVV_Hidden, visibility[i]);
+
+		// a sufficiently tall target clears the ridge
+		params.targetHeight = 1000.0;
+		Viewshed_sweep(visibility.data(), els.data(), distances.data(), els.size(), 0.0, params);
+		ASSERT_EQ(TEVV_Visible, visibility.back());
+	}
+
+	TEST(ViewshedTests, testEarthCurvatureHidesHorizon) {
+		ViewshedParameters params;
+		params.observerHeight = 2.0;
+		params.refraction = 0.0;
+		// horizon for a 2m observer is ~5km
+		const std::vector<double> els(200u, 0.0);
+		const std::vector<double> distances = createDistances(els.size(), 100.0);
+
+		std::vector<uint8_t> visibility(els.size());
+		params.earthCurvature = false;
+		Viewshed_sweep(visibility.data(), els.data(), distances.data(), els.size(), 0.0, params);
+		ASSERT_EQ(TEVV_Visible, visibility.back());
+
+		params.earthCurvature = true;
+		Viewshed_sweep(visibility.data(), els.data(), distances.data(), els.size(), 0.0, params);
+		ASSERT_EQ(TEVV_Visible, visibility[9u]);
+		ASSERT_EQ(TEVV_Hidden, visibility.back());
+	}
+
+	TEST(ViewshedTests, testNoDataDoesNotOcclude) {
+		ViewshedParameters params;
+		params.earthCurvature = false;
+		std::vector<double> els(10u, 0.0);
+		els[4u] = NAN;
+		const std::vector<double> distances = createDistances(els.size(), 30.0);
+
+		std::vector<uint8_t> visibility(els.size());
+		Viewshed_sweep(visibility.data(), els.data(), distances.data(), els.size(), 0.0, params);
+		ASSERT_EQ(TEVV_NoData, visibility[4u]);
+		ASSERT_EQ(TEVV_Visible, visibility.back());
+	}
+}
@@ -0,0 +1,239 @@
+#include "pch.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "port/Platform.h"
+#include "port/STLVectorAdapter.h"
+#include "thread/Thread.h"
+#include "util/Work.h"
+#include "util/WorkerMetrics.h"
+
+using namespace TAK::Engine::Util;
+
+namespace {
+	class CountingWork : public Work {
+	public:
+		CountingWork(std::atomic<int> &counter_, const SharedWorkerPtr &spawnWorker_ = SharedWorkerPtr(), int spawnCount_ = 0) NOTHROWS
+			: counter(counter_), spawnWorker(spawnWorker_), spawnCount(spawnCount_)
+		{}
+	protected:
+		TAKErr onSignalWork(TAK::Engine::Thread::MonitorLockPtr &lockPtr) NOTHROWS override {
+			lockPtr.reset();
+			counter++;
+			for (int i = 0; i < spawnCount; ++i)
+				spawnWorker->scheduleWork(std::make_shared<CountingWork>(counter));
+			return TE_Ok;
+		}
+	private:
+		std::atomic<int> &counter;
+		SharedWorkerPtr spawnWorker;
+		int spawnCount;
+	};
+
+	class RecordingWork : public Work {
+	public:
+		RecordingWork(std::vector<int> &order_, const int id_) NOTHROWS
+			: order(order_), id(id_)
+		{}
+	protected:
+		TAKErr onSignalWork(TAK::Engine::Thread::MonitorLockPtr &lockPtr) NOTHROWS override {
+			order.push_back(id);
+			return TE_Ok;
+		}
+	private:
+		std::vector<int> &order;
+		const int id;
+	};
+}
+
+namespace takenginetests {
+
+	TEST(WorkTests, testWorkStealingPoolRunsAllWork) {
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_Ok, Worker_createWorkStealingThreadPool(worker, 4));
+
+		std::atomic<int> counter(0);
+		std::vector<std::shared_ptr<Work>> work;
+		for (size_t i = 0; i < 1000; ++i) {
+			work.push_back(std::make_shared<CountingWork>(counter));
+			ASSERT_EQ(TE_Ok, worker->scheduleWork(work.back()));
+		}
+
+		for (auto &w : work) {
+			TAKErr err = TE_Err;
+			ASSERT_EQ(TE_Ok, w->awaitDone(err));
+			ASSERT_EQ(TE_Ok, err);
+		}
+		ASSERT_EQ(1000, counter.load());
+	}
+
+	TEST(WorkTests, testWorkStealingPoolRunsNestedWork) {
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_Ok, Worker_createWorkStealingThreadPool(worker, 4));
+
+		std::atomic<int> counter(0);
+		std::vector<std::shared_ptr<Work>> work;
+		for (size_t i = 0; i < 100; ++i) {
+			work.push_back(std::make_shared<CountingWork>(counter, worker, 9));
+			ASSERT_EQ(TE_Ok, worker->scheduleWork(work.back()));
+		}
+		for (auto &w : work) {
+			TAKErr err = TE_Err;
+			ASSERT_EQ(TE_Ok, w->awaitDone(err));
+		}
+
+		// nested work is scheduled on pool threads; wait for it to be drained
+		for (int i = 0; i < 500 && counter.load() < 1000; ++i)
+			TAK::Engine::Thread::Thread_sleep(10);
+		ASSERT_EQ(1000, counter.load());
+	}
+
+	TEST(WorkTests, testWorkStealingPoolRejectsZeroThreads) {
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_InvalidArg, Worker_createWorkStealingThreadPool(worker, 0));
+		ASSERT_FALSE(!!worker);
+	}
+
+	TEST(WorkTests, testThreadPoolRunsWorkScheduledAtKeepAliveExpiry) {
+		// with a single thread, work queued while the idle thread is timing out must either
+		// be taken by it or find it detached and spawn a replacement
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_Ok, Worker_createThreadPool(worker, 0u, 1u, 1LL));
+
+		const int count = 10000;
+		std::atomic<int> counter(0);
+		for (int i = 0; i < count; ++i) {
+			std::shared_ptr<Work> work(std::make_shared<CountingWork>(counter));
+			ASSERT_EQ(TE_Ok, worker->scheduleWork(work));
+
+			// bounded wait, as stranded work would otherwise block forever
+			const int64_t deadline = TAK::Engine::Port::Platform_systime_millis() + 1000LL;
+			bool done = false;
+			while (work->isDone(done) == TE_Ok && !done && TAK::Engine::Port::Platform_systime_millis() < deadline)
+				std::this_thread::yield();
+			ASSERT_TRUE(done) << "work " << i << " stranded";
+
+			// sweep the next schedule across the expiry of the idle thread; sleeps are too
+			// coarse to hit the window
+			const auto idleStart = std::chrono::steady_clock::now();
+			while (std::chrono::steady_clock::now() - idleStart < std::chrono::microseconds(900 + (i % 400)))
+				;
+		}
+		ASSERT_EQ(count, counter.load());
+	}
+
+	TEST(WorkTests, testControlWorkerRunsByPriority) {
+		std::shared_ptr<ControlWorker> worker;
+		ASSERT_EQ(TE_Ok, Worker_createControlWorker(worker));
+
+		std::vector<int> order;
+		const int priorities[] = { 0, 5, 0, 10, 5 };
+		for (int i = 0; i < 5; ++i) {
+			std::shared_ptr<Work> w(std::make_shared<RecordingWork>(order, i));
+			w->setPriority(priorities[i]);
+			ASSERT_EQ(TE_Ok, worker->scheduleWork(w));
+		}
+		worker->doAnyWork(1000);
+
+		const std::vector<int> expected = { 3, 1, 4, 0, 2 };
+		ASSERT_EQ(expected, order);
+	}
+
+	TEST(WorkTests, testCanceledAndExpiredWorkIsPreempted) {
+		std::shared_ptr<ControlWorker> worker;
+		ASSERT_EQ(TE_Ok, Worker_createControlWorker(worker));
+
+		std::vector<int> order;
+		std::shared_ptr<CancellationToken> token(std::make_shared<CancellationToken>());
+
+		std::shared_ptr<Work> canceled(std::make_shared<RecordingWork>(order, 0));
+		canceled->setCancellationToken(token);
+		std::shared_ptr<Work> expired(std::make_shared<RecordingWork>(order, 1));
+		expired->setDeadline(1LL);
+		std::shared_ptr<Work> live(std::make_shared<RecordingWork>(order, 2));
+		live->setCancellationToken(std::make_shared<CancellationToken>());
+
+		ASSERT_EQ(TE_Ok, worker->scheduleWork(canceled));
+		ASSERT_EQ(TE_Ok, worker->scheduleWork(expired));
+		ASSERT_EQ(TE_Ok, worker->scheduleWork(live));
+		token->cancel();
+		worker->doAnyWork(1000);
+
+		ASSERT_EQ(std::vector<int>(1u, 2), order);
+
+		TAKErr err = TE_Ok;
+		ASSERT_EQ(TE_Ok, canceled->awaitDone(err));
+		ASSERT_EQ(TE_Canceled, err);
+		ASSERT_EQ(TE_Ok, expired->awaitDone(err));
+		ASSERT_EQ(TE_TimedOut, err);
+	}
+
+	TEST(WorkTests, testLockFreeControlWorkerDrainsAllProducers) {
+		std::shared_ptr<ControlWorker> worker;
+		ASSERT_EQ(TE_Ok, Worker_createLockFreeControlWorker(worker));
+
+		SharedWorkerPtr producers;
+		ASSERT_EQ(TE_Ok, Worker_createFixedThreadPool(producers, 4));
+
+		std::atomic<int> counter(0);
+		std::vector<std::shared_ptr<Work>> posters;
+		for (int i = 0; i < 8; ++i) {
+			// each poster schedules 100 items on to the control worker
+			posters.push_back(std::make_shared<CountingWork>(counter, worker, 100));
+			ASSERT_EQ(TE_Ok, producers->scheduleWork(posters.back()));
+		}
+		for (auto &p : posters) {
+			TAKErr err = TE_Err;
+			ASSERT_EQ(TE_Ok, p->awaitDone(err));
+		}
+		worker->doAnyWork(INT64_MAX);
+		ASSERT_EQ(808, counter.load());
+	}
+
+	TEST(WorkTests, testControlWorkerMetrics) {
+		// workers created before metrics are enabled are instrumented
+		std::shared_ptr<ControlWorker> worker;
+		ASSERT_EQ(TE_Ok, Worker_createControlWorker(worker));
+		ASSERT_EQ(TE_Ok, WorkerMetrics_setName(*worker, "metrics-test"));
+		WorkerMetrics_setEnabled(true);
+
+		std::vector<int> order;
+		std::shared_ptr<Work> expired(std::make_shared<RecordingWork>(order, 0));
+		expired->setDeadline(1LL);
+		ASSERT_EQ(TE_Ok, worker->scheduleWork(expired));
+		for (int i = 1; i < 4; ++i)
+			ASSERT_EQ(TE_Ok, worker->scheduleWork(std::make_shared<RecordingWork>(order, i)));
+		worker->doAnyWork(1000);
+		WorkerMetrics_setEnabled(false);
+
+		std::vector<std::shared_ptr<WorkerMetricsSnapshot>> snapshots;
+		TAK::Engine::Port::STLVectorAdapter<std::shared_ptr<WorkerMetricsSnapshot>> snapshotsAdapter(snapshots);
+		ASSERT_EQ(TE_Ok, WorkerMetrics_snapshot(snapshotsAdapter));
+
+		const WorkerMetricsSnapshot *metrics = nullptr;
+		for (const auto &snapshot : snapshots) {
+			if (snapshot->workerId == Worker_getWorkerId(*worker))
+				metrics = snapshot.get();
+		}
+		ASSERT_TRUE(!!metrics);
+		ASSERT_STREQ("metrics-test", metrics->name);
+		ASSERT_EQ(4u, metrics->scheduled);
+		ASSERT_EQ(3u, metrics->completed);
+		ASSERT_EQ(1u, metrics->preempted);
+		ASSERT_EQ(3u, metrics->runTime.count);
+		ASSERT_EQ(3u, metrics->queueLatency.count);
+		ASSERT_EQ(4u, metrics->queueDepth.max);
+
+		// nothing is recorded while disabled
+		ASSERT_EQ(TE_Ok, worker->scheduleWork(std::make_shared<RecordingWork>(order, 4)));
+		worker->doAnyWork(1000);
+		snapshots.clear();
+		ASSERT_EQ(TE_Ok, WorkerMetrics_snapshot(snapshotsAdapter));
+		for (const auto &snapshot : snapshots) {
+			if (snapshot->workerId == Worker_getWorkerId(*worker))
+				ASSERT_EQ(4u, snapshot->scheduled);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "thread/Thread.h"
+#include "util/WorkerRegistry.h"
+
+using namespace TAK::Engine::Util;
+
+namespace {
+	class ConcurrencyProbeWork : public Work {
+	public:
+		ConcurrencyProbeWork(std::atomic<int> &active_, std::atomic<int> &peak_) NOTHROWS
+			: active(active_), peak(peak_)
+		{}
+	protected:
+		TAKErr onSignalWork(TAK::Engine::Thread::MonitorLockPtr &lockPtr) NOTHROWS override {
+			lockPtr.reset();
+			const int n = ++active;
+			int p = peak.load();
+			while (n > p && !peak.compare_exchange_weak(p, n))
+				;
+			TAK::Engine::Thread::Thread_sleep(2);
+			active--;
+			return TE_Ok;
+		}
+	private:
+		std::atomic<int> &active;
+		std::atomic<int> &peak;
+	};
+}
+
+namespace takenginetests {
+
+	TEST(WorkerRegistryTests, testBorrowedWorkerHonorsConcurrency) {
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_Ok, WorkerRegistry_borrow(worker, TEWC_IO, "test", 2u));
+
+		std::atomic<int> active(0);
+		std::atomic<int> peak(0);
+		std::vector<std::shared_ptr<Work>> work;
+		for (size_t i = 0; i < 32; ++i) {
+			work.push_back(std::make_shared<ConcurrencyProbeWork>(active, peak));
+			ASSERT_EQ(TE_Ok, worker->scheduleWork(work.back()));
+		}
+		for (auto &w : work) {
+			TAKErr err = TE_Err;
+			ASSERT_EQ(TE_Ok, w->awaitDone(err));
+			ASSERT_EQ(TE_Ok, err);
+		}
+		ASSERT_LE(peak.load(), 2);
+		ASSERT_GE(peak.load(), 1);
+	}
+
+	TEST(WorkerRegistryTests, testConcurrencyLimitFixedOnceUsed) {
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_Ok, WorkerRegistry_borrow(worker, TEWC_GLPrep, "test", 0u));
+
+		std::size_t limit = 0u;
+		ASSERT_EQ(TE_Ok, WorkerRegistry_getConcurrencyLimit(&limit, TEWC_GLPrep));
+		ASSERT_GE(limit, 1u);
+		ASSERT_EQ(TE_IllegalState, WorkerRegistry_setConcurrencyLimit(TEWC_GLPrep, limit + 1u));
+		ASSERT_EQ(TE_InvalidArg, WorkerRegistry_setConcurrencyLimit(TEWC_IO, 0u));
+	}
+
+	TEST(WorkerRegistryTests, testCoreClassFixedOnceUsed) {
+		SharedWorkerPtr worker;
+		ASSERT_EQ(TE_Ok, WorkerRegistry_borrow(worker, TEWC_CPUDecode, "test", 0u));
+
+		TAK::Engine::Thread::ThreadCoreClass coreClass = TAK::Engine::Thread::TECC_Any;
+		ASSERT_EQ(TE_Ok, WorkerRegistry_getCoreClass(&coreClass, TEWC_CPUDecode));
+		ASSERT_EQ(TAK::Engine::Thread::TECC_Any, coreClass);
+		ASSERT_EQ(TE_IllegalState, WorkerRegistry_setCoreClass(TEWC_CPUDecode, TAK::Engine::Thread::TECC_Performance));
+	}
+}
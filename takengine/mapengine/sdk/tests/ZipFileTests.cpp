@@ -1,5 +1,8 @@
 #include "pch.h"
 
+#include <vector>
+
+#include "port/STLVectorAdapter.h"
 #include "util/ZipFile.h"
 
 using namespace TAK::Engine::Util;
@@ -53,4 +56,78 @@ namespace takenginetests {
 		code = zipPtr->gotoNextEntry();
 		ASSERT_EQ((int)code, (int)TE_Done);
 	}
+
+	TEST(ZipFileTests, testOpenEntry) {
+		ZipFilePtr zipPtr(nullptr, nullptr);
+		std::string resource = TAK::Engine::Tests::getResource("test.zip");
+		TAKErr code = ZipFile::open(zipPtr, resource.c_str());
+		ASSERT_EQ((int)code, (int)TE_Ok);
+
+		int64_t size = -1LL;
+		code = zipPtr->getEntryUncompressedSize(size, "0/test.txt");
+		ASSERT_EQ((int)code, (int)TE_Ok);
+
+		DataInput2Ptr entryPtr(nullptr, nullptr);
+		code = zipPtr->openEntry(entryPtr, "0\\test.txt");
+		ASSERT_EQ((int)code, (int)TE_Ok);
+		ASSERT_EQ(size, entryPtr->length());
+
+		// entry remains readable after the archive is closed
+		zipPtr.reset();
+		std::vector<uint8_t> content((std::size_t)size + 1u);
+		std::size_t numRead = 0u;
+		code = entryPtr->read(content.data(), &numRead, content.size());
+		ASSERT_EQ((int)code, (int)TE_Ok);
+		ASSERT_EQ((std::size_t)size, numRead);
+	}
+
+	TEST(ZipFileTests, testOpenEntryNonExisting) {
+		ZipFilePtr zipPtr(nullptr, nullptr);
+		std::string resource = TAK::Engine::Tests::getResource("test.zip");
+		TAKErr code = ZipFile::open(zipPtr, resource.c_str());
+		ASSERT_EQ((int)code, (int)TE_Ok);
+
+		DataInput2Ptr entryPtr(nullptr, nullptr);
+		code = zipPtr->openEntry(entryPtr, "NOEXIST");
+		ASSERT_EQ((int)code, (int)TE_Done);
+
+		int64_t size;
+		code = zipPtr->getEntryUncompressedSize(size, "NOEXIST");
+		ASSERT_EQ((int)code, (int)TE_Done);
+	}
+
+	TEST(ZipFileTests, testListEntries) {
+		ZipFilePtr zipPtr(nullptr, nullptr);
+		std::string resource = TAK::Engine::Tests::getResource("test.zip");
+		TAKErr code = ZipFile::open(zipPtr, resource.c_str());
+		ASSERT_EQ((int)code, (int)TE_Ok);
+
+		std::vector<TAK::Engine::Port::String> all;
+		TAK::Engine::Port::STLVectorAdapter<TAK::Engine::Port::String> allAdapter(all);
+		code = zipPtr->listEntries(allAdapter, nullptr);
+		ASSERT_EQ((int)code, (int)TE_Ok);
+		ASSERT_EQ(3u, all.size());
+		ASSERT_STREQ("0/", all[0].get());
+		ASSERT_STREQ("0/test.txt", all[1].get());
+		ASSERT_STREQ("test1.txt", all[2].get());
+
+		std::vector<TAK::Engine::Port::String> dir;
+		TAK::Engine::Port::STLVectorAdapter<TAK::Engine::Port::String> dirAdapter(dir);
+		code = zipPtr->listEntries(dirAdapter, "0");
+		ASSERT_EQ((int)code, (int)TE_Ok);
+		ASSERT_EQ(1u, dir.size());
+		ASSERT_STREQ("0/test.txt", dir[0].get());
+	}
+
+	TEST(ZipFileTests, testReopenSharesIndex) {
+		std::string resource = TAK::Engine::Tests::getResource("test.zip");
+		for (int i = 0; i < 16; i++) {
+			ZipFilePtr zipPtr(nullptr, nullptr);
+			TAKErr code = ZipFile::open(zipPtr, resource.c_str());
+			ASSERT_EQ((int)code, (int)TE_Ok);
+			int64_t size;
+			code = zipPtr->getEntryUncompressedSize(size, "test1.txt");
+			ASSERT_EQ((int)code, (int)TE_Ok);
+		}
+	}
 }
\ No newline at end of file